@@ -35,10 +35,18 @@
 #include "contour_generator.h"
 #include "segment_merger.h"
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 #include "gdal.h"
 #include "gdal_alg.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "ogr_srs_api.h"
 #include "ogr_geometry.h"
@@ -196,6 +204,384 @@ private:
     void *data_;
 };
 
+/************************************************************************/
+/* ==================================================================== */
+/*      Generation of the contour lines by bands of lines.              */
+/*                                                                      */
+/*      With NUM_THREADS, the raster is cut into bands of lines whose   */
+/*      marching squares pass is run by worker threads, each with its   */
+/*      own segment merger.  The pieces of lines ending on the boundary */
+/*      between two bands are then joined by the calling thread, which  */
+/*      is also the only one writing to the layer.                      */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace marching_squares {
+
+// Line writer keeping the lines of a band in memory
+struct ContourPieceCollector
+{
+    struct Piece
+    {
+        double level;
+        LineString ls;
+    };
+
+    void addLine( double level, LineString& ls, bool /*closed*/ )
+    {
+        pieces.push_back( Piece{ level, LineString() } );
+        pieces.back().ls.swap( ls );
+    }
+
+    std::vector<Piece> pieces = {};
+};
+
+struct ContourBandContext
+{
+    GDALRasterBandH band = nullptr;
+    bool hasNoData = false;
+    double noDataValue = 0.0;
+    void* levelGenerator = nullptr;  // Shared, only read.
+
+    std::mutex ioMutex = {};
+    std::mutex mutex = {};
+    bool stop = false;
+};
+
+struct ContourBandJob
+{
+    ContourBandContext* context = nullptr;
+    int startLine = 0;
+    int lineCount = 0;
+    std::vector<ContourPieceCollector::Piece> pieces = {};
+    CPLErr err = CE_None;
+    bool done = false;
+};
+
+template <typename LevelGenerator>
+static void contourBandJobFunc( void* data )
+{
+    ContourBandJob* job = static_cast<ContourBandJob*>( data );
+    ContourBandContext* context = job->context;
+    LevelGenerator& levels =
+        *static_cast<LevelGenerator*>( context->levelGenerator );
+
+    {
+        std::lock_guard<std::mutex> lock( context->mutex );
+        if ( context->stop )
+            job->err = CE_Failure;
+    }
+
+    if ( job->err == CE_None )
+    {
+        try
+        {
+            const int width = GDALGetRasterBandXSize( context->band );
+            const int height = GDALGetRasterBandYSize( context->band );
+            // The line above the band is needed for its first squares.
+            const int firstLine = std::max( 0, job->startLine - 1 );
+            const int readLines = job->startLine + job->lineCount - firstLine;
+            std::vector<double> lines( size_t(width) * readLines );
+            {
+                std::lock_guard<std::mutex> lock( context->ioMutex );
+                job->err = GDALRasterIO( context->band, GF_Read, 0, firstLine,
+                                         width, readLines, &lines[0],
+                                         width, readLines, GDT_Float64, 0, 0 );
+            }
+            if ( job->err == CE_None )
+            {
+                ContourPieceCollector collector;
+                {
+                    SegmentMerger<ContourPieceCollector, LevelGenerator>
+                        merger( collector, levels, /* polygonize */ false );
+                    ContourGenerator<decltype(merger), LevelGenerator>
+                        cg( width, height, context->hasNoData,
+                            context->noDataValue, merger, levels );
+                    const double* line = &lines[0];
+                    if ( job->startLine > 0 )
+                    {
+                        cg.setStartLine( job->startLine, line );
+                        line += width;
+                    }
+                    for ( int i = 0; i < job->lineCount; i++, line += width )
+                        cg.feedLine( line );
+                }
+                job->pieces.swap( collector.pieces );
+            }
+        }
+        catch ( const std::exception& e )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined, "%s", e.what() );
+            job->err = CE_Failure;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock( context->mutex );
+    job->done = true;
+}
+
+// Join the pieces of lines of consecutive bands, and write the complete
+// lines.  A piece is left pending while one of its ends lies on the bottom
+// boundary of the last band added.
+template <typename LineWriter>
+class ContourBandStitcher
+{
+public:
+    explicit ContourBandStitcher( LineWriter& writer ) : writer_( writer ) {}
+
+    // Add the pieces of the next band. topY and bottomY are the ordinates of
+    // the boundaries with the previous and next bands, or NaN if there is
+    // no such band.
+    void addBand( std::vector<ContourPieceCollector::Piece>& pieces,
+                  double topY, double bottomY )
+    {
+        std::vector<ContourPieceCollector::Piece> chains;
+        chains.swap( pending_ );
+        for ( auto& piece : pieces )
+        {
+            chains.push_back( ContourPieceCollector::Piece{ piece.level,
+                                                             LineString() } );
+            chains.back().ls.swap( piece.ls );
+        }
+        pieces.clear();
+
+        const size_t count = chains.size();
+        std::vector<size_t> parent( count );
+        std::vector<Point> fronts( count );
+        std::vector<Point> backs( count );
+        std::vector<bool> closed( count );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            parent[i] = i;
+            fronts[i] = chains[i].ls.front();
+            backs[i] = chains[i].ls.back();
+            closed[i] = fronts[i] == backs[i];
+        }
+
+        // Join the ends lying on the top boundary.
+        std::map<std::pair<double, double>, size_t> openEnds;
+        for ( size_t i = 0; i < count; i++ )
+        {
+            if ( closed[i] )
+                continue;
+            for ( const Point& end : { fronts[i], backs[i] } )
+            {
+                if ( !(end.y == topY) )
+                    continue;
+                const auto key = std::make_pair( chains[i].level, end.x );
+                auto it = openEnds.find( key );
+                if ( it == openEnds.end() )
+                {
+                    openEnds[key] = i;
+                    continue;
+                }
+                const size_t root = findRoot_( parent, i );
+                const size_t other = findRoot_( parent, it->second );
+                openEnds.erase( it );
+                if ( root == other )
+                {
+                    closed[root] = true;
+                    continue;
+                }
+                join_( chains[root].ls, chains[other].ls, end );
+                parent[other] = root;
+            }
+        }
+
+        for ( size_t i = 0; i < count; i++ )
+        {
+            if ( parent[i] != i )
+                continue;
+            LineString& ls = chains[i].ls;
+            const bool isClosed = closed[i] || ls.front() == ls.back();
+            if ( !isClosed &&
+                 (ls.front().y == bottomY || ls.back().y == bottomY) )
+            {
+                pending_.push_back( ContourPieceCollector::Piece{
+                    chains[i].level, LineString() } );
+                pending_.back().ls.swap( ls );
+            }
+            else
+                writer_.addLine( chains[i].level, ls, isClosed );
+        }
+    }
+
+    // Write the lines still pending.
+    void finish()
+    {
+        for ( auto& piece : pending_ )
+            writer_.addLine( piece.level, piece.ls, false );
+        pending_.clear();
+    }
+
+    ContourBandStitcher( const ContourBandStitcher& ) = delete;
+    ContourBandStitcher& operator=( const ContourBandStitcher& ) = delete;
+
+private:
+    LineWriter& writer_;
+    std::vector<ContourPieceCollector::Piece> pending_ = {};
+
+    static size_t findRoot_( std::vector<size_t>& parent, size_t i )
+    {
+        while ( parent[i] != i )
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Append other to ls, both having the end p in common.
+    static void join_( LineString& ls, LineString& other, const Point& p )
+    {
+        if ( ls.back() == p )
+        {
+            ls.pop_back();
+            if ( other.front() == p )
+                ls.splice( ls.end(), other );
+            else
+                ls.insert( ls.end(), other.rbegin(), other.rend() );
+        }
+        else
+        {
+            ls.pop_front();
+            if ( other.back() == p )
+                ls.splice( ls.begin(), other );
+            else
+                ls.insert( ls.begin(), other.rbegin(), other.rend() );
+        }
+        other.clear();
+    }
+};
+
+// Generate the contour lines of the band by bands of lines, with
+// threadCount worker threads.
+template <typename LevelGenerator>
+static CPLErr contourGenerateBands( GDALRasterBandH band,
+                                    bool hasNoData, double noDataValue,
+                                    GDALRingAppender& appender,
+                                    LevelGenerator& levels,
+                                    int threadCount,
+                                    GDALProgressFunc pfnProgress,
+                                    void* pProgressArg )
+{
+    const int width = GDALGetRasterBandXSize( band );
+    const int height = GDALGetRasterBandYSize( band );
+    if ( width == 0 || height == 0 )
+        return CE_None;
+
+    // Bands of at most 256 lines and around 32 MB.
+    const int bandHeight = static_cast<int>( std::max( GIntBig(1),
+        std::min( GIntBig(256), GIntBig(32 * 1024 * 1024) / (8 * GIntBig(width)) ) ) );
+    const int bandCount = (height + bandHeight - 1) / bandHeight;
+    const int maxJobsInFlight = 2 * threadCount;
+
+    CPLWorkerThreadPool* pool = CPLGetGlobalWorkerThreadPool( threadCount );
+    if ( pool == nullptr )
+        return CE_Failure;
+    auto jobQueue = pool->CreateJobQueue();
+
+    ContourBandContext context;
+    context.band = band;
+    context.hasNoData = hasNoData;
+    context.noDataValue = noDataValue;
+    context.levelGenerator = &levels;
+
+    ContourBandStitcher<GDALRingAppender> stitcher( appender );
+    std::vector<std::unique_ptr<ContourBandJob>> jobs( bandCount );
+    CPLErr err = CE_None;
+    int nextJob = 0;
+
+    for ( int bandIdx = 0; err == CE_None && bandIdx < bandCount; bandIdx++ )
+    {
+        for ( ; nextJob < bandCount && nextJob < bandIdx + maxJobsInFlight;
+              nextJob++ )
+        {
+            jobs[nextJob].reset( new ContourBandJob() );
+            ContourBandJob* newJob = jobs[nextJob].get();
+            newJob->context = &context;
+            newJob->startLine = nextJob * bandHeight;
+            newJob->lineCount =
+                std::min( bandHeight, height - newJob->startLine );
+            if ( !jobQueue->SubmitJob( contourBandJobFunc<LevelGenerator>,
+                                       newJob ) )
+                contourBandJobFunc<LevelGenerator>( newJob );
+        }
+
+        ContourBandJob* job = jobs[bandIdx].get();
+        {
+            // Wait until the jobs still running are the later ones; a
+            // worker thread runs queued jobs meanwhile.
+            std::unique_lock<std::mutex> lock( context.mutex );
+            while ( !job->done )
+            {
+                int laterJobs = 0;
+                for ( int i = bandIdx + 1; i < nextJob; i++ )
+                {
+                    if ( !jobs[i]->done )
+                        laterJobs++;
+                }
+                lock.unlock();
+                jobQueue->WaitCompletion( laterJobs );
+                lock.lock();
+            }
+        }
+
+        err = job->err;
+        if ( err == CE_None )
+        {
+            const int startLine = job->startLine;
+            const int endLine = startLine + job->lineCount;
+            stitcher.addBand( job->pieces,
+                              bandIdx == 0 ? NaN : startLine - .5,
+                              bandIdx == bandCount - 1 ? NaN : endLine - .5 );
+        }
+        jobs[bandIdx].reset();
+
+        if ( err == CE_None &&
+             !pfnProgress( (bandIdx + 1) / static_cast<double>( bandCount ),
+                           "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            err = CE_Failure;
+        }
+    }
+
+    if ( err != CE_None )
+    {
+        std::lock_guard<std::mutex> lock( context.mutex );
+        context.stop = true;
+    }
+    jobQueue->WaitCompletion();
+
+    if ( err == CE_None )
+        stitcher.finish();
+    return err;
+}
+
+// Generate the contour lines, by bands of lines when threadCount > 1.
+template <typename LevelGenerator>
+static CPLErr contourGenerateLines( GDALRasterBandH band,
+                                    bool hasNoData, double noDataValue,
+                                    GDALRingAppender& appender,
+                                    LevelGenerator& levels,
+                                    int threadCount,
+                                    GDALProgressFunc pfnProgress,
+                                    void* pProgressArg )
+{
+    if ( threadCount > 1 )
+        return contourGenerateBands( band, hasNoData, noDataValue, appender,
+                                     levels, threadCount,
+                                     pfnProgress, pProgressArg );
+
+    SegmentMerger<GDALRingAppender, LevelGenerator> writer(appender, levels, /* polygonize */ false);
+    ContourGeneratorFromRaster<decltype(writer), LevelGenerator> cg( band, hasNoData, noDataValue, writer, levels );
+    cg.process( pfnProgress, pProgressArg );
+    return CE_None;
+}
+
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*                   Additional C Callable Functions                    */
@@ -517,6 +903,14 @@ an averaged value from the two nearby points (in this case (12+3+5)/3).
  *
  * If YES, contour polygons will be created, rather than polygon lines.
  *
+ *   NUM_THREADS=d|ALL_CPUS
+ *
+ * (GDAL >= 3.1) Number of worker threads generating the contour lines by
+ * bands of raster lines, the pieces of lines being joined at the band
+ * boundaries.  The order of the features in the layer then differs from the
+ * single threaded mode.  Not used with POLYGONIZE=YES.  Defaults to the
+ * value of the GDAL_NUM_THREADS configuration option, or 1.
+ *
  *
  * @return CE_None on success or CE_Failure if an error occurs.
  */
@@ -600,6 +994,8 @@ CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
 
     bool polygonize = CPLFetchBool( options, "POLYGONIZE", false );
 
+    const int threadCount = CPLGetNumThreads( options );
+
     using namespace marching_squares;
 
     OGRContourWriterInfo oCWI;
@@ -619,6 +1015,7 @@ CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
         GDALGetGeoTransform( hSrcDS, oCWI.adfGeoTransform );
     oCWI.nNextID = 0;
 
+    CPLErr eErr = CE_None;
     try
     {
         if ( polygonize )
@@ -651,21 +1048,15 @@ CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
             GDALRingAppender appender(OGRContourWriter, &oCWI);
             if ( ! fixedLevels.empty() ) {
                 FixedLevelRangeIterator levels( &fixedLevels[0], fixedLevels.size() );
-                SegmentMerger<GDALRingAppender, FixedLevelRangeIterator> writer(appender, levels, /* polygonize */ false);
-                ContourGeneratorFromRaster<decltype(writer), FixedLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                cg.process( pfnProgress, pProgressArg );
+                eErr = contourGenerateLines( hBand, useNoData, noDataValue, appender, levels, threadCount, pfnProgress, pProgressArg );
             }
             else if ( expBase > 0.0 ) {
                 ExponentialLevelRangeIterator levels( expBase );
-                SegmentMerger<GDALRingAppender, ExponentialLevelRangeIterator> writer(appender, levels, /* polygonize */ false);
-                ContourGeneratorFromRaster<decltype(writer), ExponentialLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                cg.process( pfnProgress, pProgressArg );
+                eErr = contourGenerateLines( hBand, useNoData, noDataValue, appender, levels, threadCount, pfnProgress, pProgressArg );
             }
             else {
                 IntervalLevelRangeIterator levels( contourBase, contourInterval );
-                SegmentMerger<GDALRingAppender, IntervalLevelRangeIterator> writer(appender, levels, /* polygonize */ false);
-                ContourGeneratorFromRaster<decltype(writer), IntervalLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                cg.process( pfnProgress, pProgressArg );
+                eErr = contourGenerateLines( hBand, useNoData, noDataValue, appender, levels, threadCount, pfnProgress, pProgressArg );
             }
         }
     }
@@ -674,7 +1065,7 @@ CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
         CPLError(CE_Failure, CPLE_AppDefined, "%s", e.what());
         return CE_Failure;
     }
-    return CE_None;
+    return eErr;
 }
 
 /************************************************************************/
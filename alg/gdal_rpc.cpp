@@ -36,10 +36,14 @@
 #include <cstring>
 
 #include <algorithm>
+#include <memory>
+#include <new>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_mem_cache.h"
 #include "cpl_minixml.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
@@ -66,6 +70,7 @@ CPL_C_END
 
 constexpr int MAX_ABS_VALUE_WARNINGS = 20;
 constexpr double DEFAULT_PIX_ERR_THRESHOLD = 0.1;
+constexpr int RPC_DEM_TILE_SIZE = 256;
 
 /************************************************************************/
 /*                            RPCInfoToMD()                             */
@@ -212,6 +217,25 @@ typedef enum {
   /*! Cubic Convolution Approximation (4x4 kernel) */  DRA_Cubic=2
 } DEMResampleAlg;
 
+/************************************************************************/
+/*                          GDALRPCDEMTileCache                         */
+/************************************************************************/
+
+// In-memory cache of RPC_DEM_TILE_SIZE x RPC_DEM_TILE_SIZE tiles of the DEM,
+// read on demand and recycled in least-recently-used order.
+struct GDALRPCDEMTileCache
+{
+    typedef std::shared_ptr<std::vector<double>> TilePtr;
+
+    explicit GDALRPCDEMTileCache( size_t nMaxTiles ) :
+        oCache(nMaxTiles, 0) {}
+
+    lru11::Cache<GIntBig, TilePtr> oCache;
+    // Shortcut for the tile of the previous extraction.
+    GIntBig nLastKey = -1;
+    TilePtr poLastTile{};
+};
+
 typedef struct {
 
     GDALTransformerInfo sTI;
@@ -238,16 +262,7 @@ typedef struct {
     int         bApplyDEMVDatumShift;
 
     GDALDataset *poDS;
-    double     *padfDEMBuffer;
-    int         nDEMExtractions;
-    int         nBufferMaxRadius;
-    int         nHitsInBuffer;
-    int         nBufferX;
-    int         nBufferY;
-    int         nBufferWidth;
-    int         nBufferHeight;
-    int         nLastQueriedX;
-    int         nLastQueriedY;
+    GDALRPCDEMTileCache *poDEMTileCache;
 
     OGRCoordinateTransformation *poCT;
 
@@ -722,6 +737,9 @@ retry:
  * transformation function is assumed to be height above ground. This option
  * should be used in replacement of RPC_HEIGHT to provide a way of defining
  * a non uniform ground for the target scene (GDAL >= 1.8.0)
+ * Starting with GDAL 3.1, the DEM is read by tiles of 256x256 pixels that are
+ * kept in a cache whose size in megabytes can be set with the
+ * GDAL_RPC_DEM_CACHE_SIZE configuration option (defaults to 32).
  *
  * <li> RPC_DEMINTERPOLATION: the DEM interpolation (near, bilinear or cubic)
  *
@@ -1064,7 +1082,7 @@ void GDALDestroyRPCTransformer( void *pTransformAlg )
 
     if( psTransform->poDS )
         GDALClose(psTransform->poDS);
-    CPLFree(psTransform->padfDEMBuffer);
+    delete psTransform->poDEMTileCache;
     if( psTransform->poCT )
         OCTDestroyCoordinateTransformation(
             reinterpret_cast<OGRCoordinateTransformationH>(psTransform->poCT));
@@ -1353,6 +1371,53 @@ double BiCubicKernel( double dfVal )
         0.16666666666666666667 * (a - (4.0 * b) + (6.0 * c) - (4.0 * d));
 }
 
+/************************************************************************/
+/*                           GDALRPCGetDEMTile()                        */
+/************************************************************************/
+
+static const double* GDALRPCGetDEMTile( GDALRPCTransformInfo *psTransform,
+                                        int nTileX, int nTileY,
+                                        int nTileWidth, int nTileHeight )
+{
+    GDALRPCDEMTileCache* poCache = psTransform->poDEMTileCache;
+    const int nTilesPerRow = DIV_ROUND_UP(psTransform->poDS->GetRasterXSize(),
+                                          RPC_DEM_TILE_SIZE);
+    const GIntBig nKey = static_cast<GIntBig>(nTileY) * nTilesPerRow + nTileX;
+    if( nKey == poCache->nLastKey )
+        return poCache->poLastTile->data();
+
+    GDALRPCDEMTileCache::TilePtr poTile;
+    if( !poCache->oCache.tryGet(nKey, poTile) )
+    {
+        try
+        {
+            poTile = std::make_shared<std::vector<double>>(
+                static_cast<size_t>(nTileWidth) * nTileHeight);
+        }
+        catch( const std::bad_alloc& )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate DEM tile");
+            return nullptr;
+        }
+#ifdef DEBUG_VERBOSE_EXTRACT_DEM
+        CPLDebug("RPC", "Reading DEM tile %d,%d", nTileX, nTileY);
+#endif
+        if( psTransform->poDS->GetRasterBand(1)->RasterIO(GF_Read,
+                nTileX * RPC_DEM_TILE_SIZE, nTileY * RPC_DEM_TILE_SIZE,
+                nTileWidth, nTileHeight,
+                poTile->data(), nTileWidth, nTileHeight,
+                GDT_Float64, 0, 0, nullptr) != CE_None )
+        {
+            return nullptr;
+        }
+        poCache->oCache.insert(nKey, poTile);
+    }
+    poCache->nLastKey = nKey;
+    poCache->poLastTile = poTile;
+    return poTile->data();
+}
+
 /************************************************************************/
 /*                        GDALRPCExtractDEMWindow()                     */
 /************************************************************************/
@@ -1361,8 +1426,7 @@ static bool GDALRPCExtractDEMWindow( GDALRPCTransformInfo *psTransform,
                                      int nX, int nY, int nWidth, int nHeight,
                                      double* padfOut )
 {
-    psTransform->nDEMExtractions++;
-    if( psTransform->padfDEMBuffer == nullptr )
+    if( psTransform->poDEMTileCache == nullptr )
     {
         // Should only happen in case of failed memory allocation.
         return psTransform->poDS->GetRasterBand(1)->
@@ -1372,101 +1436,41 @@ static bool GDALRPCExtractDEMWindow( GDALRPCTransformInfo *psTransform,
                                            nullptr) == CE_None;
     }
 
-    // Instead of reading just nWidth * nHeight pixels (with those being <= 4),
-    // target a larger buffer since small extractions can be costly, particular
-    // with VRT.
-    if( !(nX >= psTransform->nBufferX &&
-          nX + nWidth <= psTransform->nBufferX + psTransform->nBufferWidth &&
-          nY >= psTransform->nBufferY &&
-          nY + nHeight <= psTransform->nBufferY + psTransform->nBufferHeight ) )
+    // Small extractions can be costly, particularly with VRT, so the DEM is
+    // read by whole tiles that are kept in a cache, and the window is
+    // assembled from the (up to 4 for small windows) tiles it intersects.
+    const int nRasterXSize = psTransform->poDS->GetRasterXSize();
+    const int nRasterYSize = psTransform->poDS->GetRasterYSize();
+    for( int iY = nY; iY < nY + nHeight; )
     {
-#ifdef DEBUG_VERBOSE_EXTRACT_DEM
-        CPLDebug("RPC", "Current request: %d,%d-%dx%d",
-                  nX, nY, nWidth, nHeight);
-        CPLDebug("RPC", "Hits in last DEM buffer: %d (%d pixels)",
-                 psTransform->nHitsInBuffer,
-                 psTransform->nBufferWidth * psTransform->nBufferHeight);
-        CPLDebug("RPC", "Last DEM buffer: %d,%d-%dx%d",
-                 psTransform->nBufferX,
-                 psTransform->nBufferY,
-                 psTransform->nBufferWidth,
-                 psTransform->nBufferHeight);
-#endif
-        const int nRasterXSize = psTransform->poDS->GetRasterXSize();
-        const int nRasterYSize = psTransform->poDS->GetRasterYSize();
-        // If we have only queried a few points, no need to extract on a large
-        // window We will progressively extend the window up to its maximum size
-        // if we extract a significant number of points.
-        int nRadius = psTransform->nBufferMaxRadius;
-        if( psTransform->nDEMExtractions <
-            psTransform->nBufferMaxRadius * psTransform->nBufferMaxRadius )
-        {
-            nRadius = static_cast<int> (
-                  sqrt(static_cast<double>(psTransform->nDEMExtractions)) );
-            CPLAssert( nRadius <= psTransform->nBufferMaxRadius );
-        }
-        // Check if there's some overlap between consecutive requests to decide
-        // if we must have a buffer around the interest window.
-        const int nDiffX = nX - psTransform->nLastQueriedX;
-        const int nDiffY = nY - psTransform->nLastQueriedY;
-        if( psTransform->nLastQueriedX >= 0 &&
-            (nDiffX > nRadius || -nDiffX > nRadius ||
-             nDiffY > nRadius || -nDiffY > nRadius) )
+        const int nTileY = iY / RPC_DEM_TILE_SIZE;
+        const int nTileYOff = nTileY * RPC_DEM_TILE_SIZE;
+        const int nTileHeight =
+            std::min(RPC_DEM_TILE_SIZE, nRasterYSize - nTileYOff);
+        const int nRows = std::min(nY + nHeight, nTileYOff + nTileHeight) - iY;
+        for( int iX = nX; iX < nX + nWidth; )
         {
-            nRadius = 0;
-        }
-        psTransform->nBufferX = nX - nRadius;
-        if( psTransform->nBufferX < 0 )
-            psTransform->nBufferX = 0;
-        psTransform->nBufferY = nY - nRadius;
-        if( psTransform->nBufferY < 0 )
-            psTransform->nBufferY = 0;
-        psTransform->nBufferWidth = nWidth + 2 * nRadius;
-        if( psTransform->nBufferX + psTransform->nBufferWidth > nRasterXSize )
-            psTransform->nBufferWidth = nRasterXSize - psTransform->nBufferX;
-        psTransform->nBufferHeight = nHeight + 2 * nRadius;
-        if( psTransform->nBufferY + psTransform->nBufferHeight > nRasterYSize )
-            psTransform->nBufferHeight = nRasterYSize - psTransform->nBufferY;
-#ifdef DEBUG_VERBOSE_EXTRACT_DEM
-        CPLDebug("RPC", "New DEM buffer: %d,%d-%dx%d",
-                 psTransform->nBufferX,
-                 psTransform->nBufferY,
-                 psTransform->nBufferWidth,
-                 psTransform->nBufferHeight);
-#endif
-        CPLErr eErr = psTransform->poDS->GetRasterBand(1)->RasterIO(GF_Read,
-                        psTransform->nBufferX, psTransform->nBufferY,
-                        psTransform->nBufferWidth, psTransform->nBufferHeight,
-                        psTransform->padfDEMBuffer,
-                        psTransform->nBufferWidth, psTransform->nBufferHeight,
-                        GDT_Float64, 0, 0, nullptr);
-        if( eErr != CE_None )
-        {
-            psTransform->nBufferX = -1;
-            psTransform->nBufferY = -1;
-            psTransform->nBufferWidth = -1;
-            psTransform->nBufferHeight = -1;
-            return false;
+            const int nTileX = iX / RPC_DEM_TILE_SIZE;
+            const int nTileXOff = nTileX * RPC_DEM_TILE_SIZE;
+            const int nTileWidth =
+                std::min(RPC_DEM_TILE_SIZE, nRasterXSize - nTileXOff);
+            const int nCols =
+                std::min(nX + nWidth, nTileXOff + nTileWidth) - iX;
+            const double* padfTile = GDALRPCGetDEMTile(
+                psTransform, nTileX, nTileY, nTileWidth, nTileHeight);
+            if( padfTile == nullptr )
+                return false;
+            for( int i = 0; i < nRows; i++ )
+            {
+                memcpy( padfOut + static_cast<size_t>(iY - nY + i) * nWidth +
+                            (iX - nX),
+                        padfTile + static_cast<size_t>(iY - nTileYOff + i) *
+                            nTileWidth + (iX - nTileXOff),
+                        nCols * sizeof(double) );
+            }
+            iX += nCols;
         }
-#ifdef DEBUG_VERBOSE_EXTRACT_DEM
-         psTransform->nHitsInBuffer = 1;
-#endif
-    }
-    else
-    {
-#ifdef DEBUG_VERBOSE
-        psTransform->nHitsInBuffer++;
-#endif
-    }
-    psTransform->nLastQueriedX = nX;
-    psTransform->nLastQueriedY = nY;
-
-    for( int i=0; i<nHeight; i++)
-    {
-        memcpy( padfOut + i * nWidth,
-                psTransform->padfDEMBuffer + (nY - psTransform->nBufferY + i) *
-                    psTransform->nBufferWidth + nX - psTransform->nBufferX,
-                nWidth * sizeof(double) );
+        iY += nRows;
     }
 
     return true;
@@ -1643,7 +1647,7 @@ static bool RPCIsValidLongLat( const GDALRPCTransformInfo *psTransform,
 /************************************************************************/
 
 static int
-GDALRPCTransformWholeLineWithDEM( const GDALRPCTransformInfo *psTransform,
+GDALRPCTransformWholeLineWithDEM( GDALRPCTransformInfo *psTransform,
                                   int nPointCount,
                                   double *padfX, double *padfY, double *padfZ,
                                   int *panSuccess,
@@ -1658,11 +1662,8 @@ GDALRPCTransformWholeLineWithDEM( const GDALRPCTransformInfo *psTransform,
             panSuccess[i] = FALSE;
         return FALSE;
     }
-    CPLErr eErr = psTransform->poDS->GetRasterBand(1)->
-        RasterIO(GF_Read, nXLeft, nYTop, nXWidth, nYHeight,
-                 padfDEMBuffer, nXWidth, nYHeight,
-                 GDT_Float64, 0, 0, nullptr);
-    if( eErr != CE_None )
+    if( !GDALRPCExtractDEMWindow( psTransform, nXLeft, nYTop,
+                                  nXWidth, nYHeight, padfDEMBuffer ) )
     {
         for( int i = 0; i < nPointCount; i++ )
             panSuccess[i] = FALSE;
@@ -1896,20 +1897,14 @@ static bool GDALRPCOpenDEM( GDALRPCTransformInfo* psTransform )
     if( psTransform->poDS != nullptr &&
         psTransform->poDS->GetRasterCount() >= 1 )
     {
-        psTransform->nBufferMaxRadius =
-            atoi(CPLGetConfigOption("GDAL_RPC_DEM_BUFFER_MAX_RADIUS", "2"));
-        psTransform->nHitsInBuffer = 0;
-        const int nMaxWindowSize = 4;
-        psTransform->padfDEMBuffer = static_cast<double*>(VSIMalloc(
-            (nMaxWindowSize + 2 * psTransform->nBufferMaxRadius) *
-            (nMaxWindowSize + 2 * psTransform->nBufferMaxRadius) *
-            sizeof(double) ));
-        psTransform->nBufferX = -1;
-        psTransform->nBufferY = -1;
-        psTransform->nBufferWidth = -1;
-        psTransform->nBufferHeight = -1;
-        psTransform->nLastQueriedX = -1;
-        psTransform->nLastQueriedY = -1;
+        // Size of the DEM tile cache, in megabytes.
+        const int nCacheSizeMB = std::max(1,
+            atoi(CPLGetConfigOption("GDAL_RPC_DEM_CACHE_SIZE", "32")));
+        const size_t nMaxTiles = std::max(static_cast<size_t>(1),
+            static_cast<size_t>(nCacheSizeMB) * 1024 * 1024 /
+            (RPC_DEM_TILE_SIZE * RPC_DEM_TILE_SIZE * sizeof(double)));
+        psTransform->poDEMTileCache =
+            new (std::nothrow) GDALRPCDEMTileCache(nMaxTiles);
         auto poDSSpaRefSrc = psTransform->poDS->GetSpatialRef();
         if( poDSSpaRefSrc )
         {
@@ -32,6 +32,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <map>
 #include <utility>
 
@@ -41,6 +42,7 @@
 #include "cpl_minixml.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_alg.h"
 #include "gdal_alg_priv.h"
@@ -67,6 +69,9 @@ typedef struct
     int       nGCPCount;
     GDAL_GCP *pasGCPList;
 
+    // Number of threads used by each of the forward and reverse solves.
+    int       nSolveThreads;
+
     volatile int nRefCount;
 
 } TPSTransformInfo;
@@ -127,6 +132,11 @@ void* GDALCreateSimilarTPSTransformer( void *hTransformArg,
  * for large numbers of GCPs.  For instance, for reference, it takes on the
  * order of 10s for 400 GCPs on a 2GHz Athlon processor.
  *
+ * Starting with GDAL 3.1, when the GDAL_NUM_THREADS configuration option is
+ * set to a number of threads or ALL_CPUS, and there are more than 100 GCPs,
+ * the forward and reverse systems are solved in parallel, and the row
+ * updates of each solve are spread over the remaining threads.
+ *
  * TPS Transformers are serializable.
  *
  * The GDAL Thin Plate Spline transformer is based on code provided by
@@ -150,7 +160,8 @@ void *GDALCreateTPSTransformer( int nGCPCount, const GDAL_GCP *pasGCPList,
 static void GDALTPSComputeForwardInThread( void *pData )
 {
     TPSTransformInfo *psInfo = static_cast<TPSTransformInfo *>(pData);
-    psInfo->bForwardSolved = psInfo->poForward->solve() != 0;
+    psInfo->bForwardSolved =
+        psInfo->poForward->solve(psInfo->nSolveThreads) != 0;
 }
 
 void *GDALCreateTPSTransformerInt( int nGCPCount, const GDAL_GCP *pasGCPList,
@@ -259,27 +270,22 @@ void *GDALCreateTPSTransformerInt( int nGCPCount, const GDAL_GCP *pasGCPList,
 
     int nThreads = 1;
     if( nGCPCount > 100 )
-    {
-        const char* pszWarpThreads =
-            CSLFetchNameValue(papszOptions, "NUM_THREADS");
-        if( pszWarpThreads == nullptr )
-            pszWarpThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
-        if( EQUAL(pszWarpThreads, "ALL_CPUS") )
-            nThreads = CPLGetNumCPUs();
-        else
-            nThreads = atoi(pszWarpThreads);
-    }
+        nThreads = CPLGetNumThreads(papszOptions);
 
     if( nThreads > 1 )
     {
-        // Compute direct and reverse transforms in parallel.
+        // Compute direct and reverse transforms in parallel, and share
+        // the remaining threads between both linear system solves.
+        psInfo->nSolveThreads = std::max(1, nThreads / 2);
         CPLJoinableThread* hThread =
             CPLCreateJoinableThread(GDALTPSComputeForwardInThread, psInfo);
-        psInfo->bReverseSolved = psInfo->poReverse->solve() != 0;
+        psInfo->bReverseSolved =
+            psInfo->poReverse->solve(psInfo->nSolveThreads) != 0;
         if( hThread != nullptr )
             CPLJoinThread(hThread);
         else
-            psInfo->bForwardSolved = psInfo->poForward->solve() != 0;
+            psInfo->bForwardSolved =
+                psInfo->poForward->solve(nThreads) != 0;
     }
     else
     {
@@ -38,7 +38,10 @@
 
 #include "proj.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <vector>
 
 CPL_CVSID("$Id: gdalapplyverticalshiftgrid.cpp aa2b46947ceef81934fef5a0fd4da1862ce71245 2019-05-23 21:34:37 +0200 Even Rouault $")
 
@@ -55,6 +58,8 @@ class GDALApplyVSGDataset final: public GDALDataset
         bool         m_bInverse = false;
         double       m_dfSrcUnitToMeter = 0.0;
         double       m_dfDstUnitToMeter = 0.0;
+        // Spacing, in source pixels, of the nodes of m_poReprojectedGrid.
+        int          m_nGridStep = 1;
 
         CPL_DISALLOW_COPY_ASSIGN(GDALApplyVSGDataset)
 
@@ -65,7 +70,8 @@ class GDALApplyVSGDataset final: public GDALDataset
                              bool bInverse,
                              double dfSrcUnitToMeter,
                              double dfDstUnitToMeter,
-                             int nBlockSize );
+                             int nBlockSize,
+                             int nGridStep );
         virtual ~GDALApplyVSGDataset();
 
         virtual int        CloseDependentDatasets() override;
@@ -86,9 +92,13 @@ class GDALApplyVSGRasterBand final: public GDALRasterBand
 
         float       *m_pafSrcData = nullptr;
         float       *m_pafGridData = nullptr;
+        std::vector<float> m_afCoarseGrid{};
 
         CPL_DISALLOW_COPY_ASSIGN(GDALApplyVSGRasterBand)
 
+        CPLErr      ReadGrid( int nXOff, int nYOff,
+                              int nReqXSize, int nReqYSize );
+
     public:
         GDALApplyVSGRasterBand( GDALDataType eDT,
                                 int nBlockSize );
@@ -109,12 +119,14 @@ GDALApplyVSGDataset::GDALApplyVSGDataset( GDALDataset* poSrcDataset,
                                           bool bInverse,
                                           double dfSrcUnitToMeter,
                                           double dfDstUnitToMeter,
-                                          int nBlockSize ) :
+                                          int nBlockSize,
+                                          int nGridStep ) :
     m_poSrcDataset(poSrcDataset),
     m_poReprojectedGrid(poReprojectedGrid),
     m_bInverse(bInverse),
     m_dfSrcUnitToMeter(dfSrcUnitToMeter),
-    m_dfDstUnitToMeter(dfDstUnitToMeter)
+    m_dfDstUnitToMeter(dfDstUnitToMeter),
+    m_nGridStep(nGridStep)
 {
     m_poSrcDataset->Reference();
     m_poReprojectedGrid->Reference();
@@ -224,6 +236,88 @@ double GDALApplyVSGRasterBand::GetNoDataValue( int* pbSuccess )
     return poGDS->m_poSrcDataset->GetRasterBand(1)->GetNoDataValue(pbSuccess);
 }
 
+/************************************************************************/
+/*                              ReadGrid()                              */
+/*                                                                      */
+/*      Fills m_pafGridData with the shift values for a window of the   */
+/*      source. When the reprojected grid is sampled every              */
+/*      m_nGridStep source pixels, its nodes are bilinearly             */
+/*      interpolated.                                                   */
+/************************************************************************/
+
+CPLErr GDALApplyVSGRasterBand::ReadGrid( int nXOff, int nYOff,
+                                         int nReqXSize, int nReqYSize )
+{
+    GDALApplyVSGDataset* poGDS = reinterpret_cast<GDALApplyVSGDataset*>(poDS);
+    GDALRasterBand* poGridBand = poGDS->m_poReprojectedGrid->GetRasterBand(1);
+    const int nStep = poGDS->m_nGridStep;
+    if( nStep == 1 )
+    {
+        return poGridBand->RasterIO(GF_Read,
+                                    nXOff, nYOff,
+                                    nReqXSize, nReqYSize,
+                                    m_pafGridData,
+                                    nReqXSize, nReqYSize,
+                                    GDT_Float32,
+                                    sizeof(float),
+                                    nBlockXSize * sizeof(float),
+                                    nullptr);
+    }
+
+    // Node i of the reprojected grid is at the center of source pixel
+    // i * nStep.
+    const int nNodeXOff = nXOff / nStep;
+    const int nNodeYOff = nYOff / nStep;
+    const int nNodeXSize = (nXOff + nReqXSize - 1) / nStep + 2 - nNodeXOff;
+    const int nNodeYSize = (nYOff + nReqYSize - 1) / nStep + 2 - nNodeYOff;
+    try
+    {
+        m_afCoarseGrid.resize(static_cast<size_t>(nNodeXSize) * nNodeYSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate vertical grid buffer");
+        return CE_Failure;
+    }
+    CPLErr eErr = poGridBand->RasterIO(GF_Read,
+                                       nNodeXOff, nNodeYOff,
+                                       nNodeXSize, nNodeYSize,
+                                       &m_afCoarseGrid[0],
+                                       nNodeXSize, nNodeYSize,
+                                       GDT_Float32, 0, 0, nullptr);
+    if( eErr != CE_None )
+        return eErr;
+
+    // Interpolation weights are exact zeros on the nodes, which must not
+    // be multiplied with a missing (infinite) neighbour.
+    const auto Interpolate = [](float fA, float fB, float fT)
+        { return fT == 0.0f ? fA : (1.0f - fT) * fA + fT * fB; };
+
+    const float fInvStep = 1.0f / nStep;
+    for( int iY = 0; iY < nReqYSize; iY++ )
+    {
+        const int nY = nYOff + iY;
+        const int iNodeY = nY / nStep - nNodeYOff;
+        const float fTY = static_cast<float>(nY % nStep) * fInvStep;
+        const float* pafRow0 = &m_afCoarseGrid[
+                            static_cast<size_t>(iNodeY) * nNodeXSize];
+        const float* pafRow1 = pafRow0 + nNodeXSize;
+        float* pafOut = m_pafGridData + static_cast<size_t>(iY) * nBlockXSize;
+        for( int iX = 0; iX < nReqXSize; iX++ )
+        {
+            const int nX = nXOff + iX;
+            const int iNodeX = nX / nStep - nNodeXOff;
+            const float fTX = static_cast<float>(nX % nStep) * fInvStep;
+            pafOut[iX] = Interpolate(
+                Interpolate(pafRow0[iNodeX], pafRow0[iNodeX + 1], fTX),
+                Interpolate(pafRow1[iNodeX], pafRow1[iNodeX + 1], fTX),
+                fTY);
+        }
+    }
+    return CE_None;
+}
+
 /************************************************************************/
 /*                              IReadBlock()                            */
 /************************************************************************/
@@ -251,50 +345,63 @@ CPLErr GDALApplyVSGRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
                                                     nBlockXSize * sizeof(float),
                                                     nullptr);
     if( eErr == CE_None )
-        eErr =  poGDS->m_poReprojectedGrid->GetRasterBand(1)->RasterIO(GF_Read,
-                                                    nXOff, nYOff,
-                                                    nReqXSize, nReqYSize,
-                                                    m_pafGridData,
-                                                    nReqXSize, nReqYSize,
-                                                    GDT_Float32,
-                                                    sizeof(float),
-                                                    nBlockXSize * sizeof(float),
-                                                    nullptr);
+        eErr = ReadGrid(nXOff, nYOff, nReqXSize, nReqYSize);
     if( eErr == CE_None )
     {
         const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
         int bHasNoData = FALSE;
         float fNoDataValue = static_cast<float>(GetNoDataValue(&bHasNoData));
+        const double dfSrcUnitToMeter = poGDS->m_dfSrcUnitToMeter;
+        const double dfDstUnitToMeter = poGDS->m_dfDstUnitToMeter;
+        const double dfSign = poGDS->m_bInverse ? -1.0 : 1.0;
         for( int iY = 0; iY < nReqYSize; iY++ )
         {
+            float* pafSrc = m_pafSrcData + iY * nBlockXSize;
+            const float* pafGrid = m_pafGridData + iY * nBlockXSize;
+
+            // Missing grid values are rare: check for them first so that
+            // the computation below is a branch-free loop that compilers
+            // vectorize.
+            bool bHasInf = false;
             for( int iX = 0; iX < nReqXSize; iX ++ )
+                bHasInf |= CPLIsInf(pafGrid[iX]);
+            if( bHasInf )
             {
-                const float fSrcVal = m_pafSrcData[iY * nBlockXSize + iX];
-                const float fGridVal = m_pafGridData[iY * nBlockXSize + iX];
-                if( bHasNoData && fSrcVal == fNoDataValue )
-                {
-                }
-                else if( CPLIsInf(fGridVal) )
+                for( int iX = 0; iX < nReqXSize; iX ++ )
                 {
-                    CPLError(CE_Failure, CPLE_AppDefined,
+                    if( CPLIsInf(pafGrid[iX]) &&
+                        !(bHasNoData && pafSrc[iX] == fNoDataValue) )
+                    {
+                        CPLError(CE_Failure, CPLE_AppDefined,
                              "Missing vertical grid value at source (%d,%d)",
                              nXOff + iX, nYOff + iY);
-                    return CE_Failure;
+                        return CE_Failure;
+                    }
                 }
-                else if( poGDS->m_bInverse )
+            }
+
+            if( bHasNoData || bHasInf )
+            {
+                for( int iX = 0; iX < nReqXSize; iX ++ )
                 {
-                    m_pafSrcData[iY * nBlockXSize + iX] = static_cast<float>(
-                        (fSrcVal * poGDS->m_dfSrcUnitToMeter - fGridVal) / 
-                                                poGDS->m_dfDstUnitToMeter);
+                    const float fSrcVal = pafSrc[iX];
+                    const float fShifted = static_cast<float>(
+                        (fSrcVal * dfSrcUnitToMeter + dfSign * pafGrid[iX]) /
+                                                        dfDstUnitToMeter);
+                    pafSrc[iX] = (bHasNoData && fSrcVal == fNoDataValue) ?
+                                                        fSrcVal : fShifted;
                 }
-                else
+            }
+            else
+            {
+                for( int iX = 0; iX < nReqXSize; iX ++ )
                 {
-                    m_pafSrcData[iY * nBlockXSize + iX] = static_cast<float>(
-                        (fSrcVal * poGDS->m_dfSrcUnitToMeter + fGridVal) / 
-                                                poGDS->m_dfDstUnitToMeter);
+                    pafSrc[iX] = static_cast<float>(
+                        (pafSrc[iX] * dfSrcUnitToMeter + dfSign * pafGrid[iX]) /
+                                                        dfDstUnitToMeter);
                 }
             }
-            GDALCopyWords( m_pafSrcData + iY * nBlockXSize,
+            GDALCopyWords( pafSrc,
                                 GDT_Float32, sizeof(float),
                            static_cast<GByte*>(pData) + iY * nBlockXSize *
                                 nDTSize, eDataType, nDTSize,
@@ -305,6 +412,43 @@ CPLErr GDALApplyVSGRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
     return eErr;
 }
 
+/************************************************************************/
+/*                          GetAutoGridStep()                           */
+/*                                                                      */
+/*      Spacing, in source pixels, at which the reprojected grid can    */
+/*      be evaluated and interpolated without noticeable loss: a few    */
+/*      nodes per grid cell, measured at the center of the source.      */
+/************************************************************************/
+
+static int GetAutoGridStep( void* hTransform, int nSrcXSize, int nSrcYSize )
+{
+    double dfX = nSrcXSize / 2.0;
+    double dfY = nSrcYSize / 2.0;
+    double dfZ = 0.0;
+    int bSuccess = FALSE;
+    if( !GDALGenImgProjTransform(hTransform, TRUE, 1,
+                                 &dfX, &dfY, &dfZ, &bSuccess) || !bSuccess )
+        return 1;
+
+    double adfX[3] = { dfX, dfX + 1, dfX };
+    double adfY[3] = { dfY, dfY, dfY + 1 };
+    double adfZ[3] = { 0.0, 0.0, 0.0 };
+    int abSuccess[3] = { FALSE, FALSE, FALSE };
+    if( !GDALGenImgProjTransform(hTransform, FALSE, 3,
+                                 adfX, adfY, adfZ, abSuccess) ||
+        !abSuccess[0] || !abSuccess[1] || !abSuccess[2] )
+        return 1;
+
+    const double dfCellSize = std::min(
+        std::sqrt((adfX[1] - adfX[0]) * (adfX[1] - adfX[0]) +
+                  (adfY[1] - adfY[0]) * (adfY[1] - adfY[0])),
+        std::sqrt((adfX[2] - adfX[0]) * (adfX[2] - adfX[0]) +
+                  (adfY[2] - adfY[0]) * (adfY[2] - adfY[0])));
+    if( !(dfCellSize >= 16.0) )
+        return 1;
+    return static_cast<int>(std::min(256.0, dfCellSize / 8));
+}
+
 /************************************************************************/
 /*                      GDALApplyVerticalShiftGrid()                    */
 /************************************************************************/
@@ -364,6 +508,11 @@ CPLErr GDALApplyVSGRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
  * hGridDataset should cause I/O requests to fail. Default is NO (in which case
  * 0 will be used)
  * <li>SRC_SRS=srs_def. Override projection on hSrcDataset;
+ * <li>GRID_STEP=AUTO/integer. (GDAL &gt;= 3.1) Spacing, in source pixels, of
+ * the nodes at which hGridDataset is reprojected and resampled. Shift values
+ * between nodes are bilinearly interpolated. AUTO (the default) uses about
+ * 8 nodes per cell of hGridDataset, and 1 when RESAMPLING=NEAREST. Setting
+ * 1 evaluates hGridDataset at every source pixel.
  * </ul>
  *
  * @return a new dataset corresponding to hSrcDataset adjusted with
@@ -502,6 +651,43 @@ GDALDatasetH GDALApplyVerticalShiftGrid( GDALDatasetH hSrcDataset,
         else if( EQUAL(pszResampling, "CUBIC") )
             psWO->eResampleAlg = GRA_Cubic;
     }
+
+    // Vertical shift grids are smooth and much coarser than the datasets
+    // they are applied to, so the reprojected grid is only computed on
+    // nodes every nGridStep source pixels. GDALApplyVSGRasterBand
+    // interpolates in between.
+    int nGridStep = 1;
+    const char* pszGridStep = CSLFetchNameValueDef(papszOptions,
+                                                   "GRID_STEP", "AUTO");
+    if( EQUAL(pszGridStep, "AUTO") )
+    {
+        if( psWO->eResampleAlg != GRA_NearestNeighbour )
+            nGridStep = GetAutoGridStep(hTransform, nSrcXSize, nSrcYSize);
+    }
+    else
+    {
+        nGridStep = std::max(1, atoi(pszGridStep));
+    }
+
+    int nGridXSize = nSrcXSize;
+    int nGridYSize = nSrcYSize;
+    double adfGridNodesGT[6] = { adfSrcGT[0], adfSrcGT[1], adfSrcGT[2],
+                                 adfSrcGT[3], adfSrcGT[4], adfSrcGT[5] };
+    if( nGridStep > 1 )
+    {
+        // Node i is at the center of source pixel i * nGridStep.
+        const double dfOff = 0.5 - 0.5 * nGridStep;
+        adfGridNodesGT[0] += dfOff * (adfSrcGT[1] + adfSrcGT[2]);
+        adfGridNodesGT[1] *= nGridStep;
+        adfGridNodesGT[2] *= nGridStep;
+        adfGridNodesGT[3] += dfOff * (adfSrcGT[4] + adfSrcGT[5]);
+        adfGridNodesGT[4] *= nGridStep;
+        adfGridNodesGT[5] *= nGridStep;
+        nGridXSize = (nSrcXSize - 1) / nGridStep + 2;
+        nGridYSize = (nSrcYSize - 1) / nGridStep + 2;
+        GDALSetGenImgProjTransformerDstGeoTransform(hTransform,
+                                                    adfGridNodesGT);
+    }
     psWO->eWorkingDataType = GDT_Float32;
     int bHasNoData = FALSE;
     const double dfSrcNoData = GDALGetRasterNoDataValue(
@@ -525,9 +711,11 @@ GDALDatasetH GDALApplyVerticalShiftGrid( GDALDatasetH hSrcDataset,
 
     psWO->pfnTransformer = GDALGenImgProjTransform;
     psWO->pTransformerArg = hTransform;
+    // MAX_ERROR is expressed in source pixels
     const double dfMaxError = CPLAtof(CSLFetchNameValueDef(papszOptions,
                                                            "MAX_ERROR",
-                                                           "0.125"));
+                                                           "0.125")) /
+                                                                nGridStep;
     if( dfMaxError > 0.0 )
     {
         psWO->pTransformerArg =
@@ -544,13 +732,13 @@ GDALDatasetH GDALApplyVerticalShiftGrid( GDALDatasetH hSrcDataset,
     psWO->panDstBands[0] = 1;
 
     VRTWarpedDataset* poReprojectedGrid =
-                new VRTWarpedDataset(nSrcXSize, nSrcYSize);
+                new VRTWarpedDataset(nGridXSize, nGridYSize);
     // This takes a reference on hGridDataset
     CPLErr eErr = poReprojectedGrid->Initialize(psWO);
     CPLAssert(eErr == CE_None);
     CPL_IGNORE_RET_VAL(eErr);
     GDALDestroyWarpOptions(psWO);
-    poReprojectedGrid->SetGeoTransform(adfSrcGT);
+    poReprojectedGrid->SetGeoTransform(adfGridNodesGT);
     poReprojectedGrid->AddBand(GDT_Float32, nullptr);
 
     GDALApplyVSGDataset* poOutDS = new GDALApplyVSGDataset(
@@ -561,7 +749,8 @@ GDALDatasetH GDALApplyVerticalShiftGrid( GDALDatasetH hSrcDataset,
         dfSrcUnitToMeter,
         dfDstUnitToMeter,
         // Undocumented option. For testing only
-        atoi(CSLFetchNameValueDef(papszOptions, "BLOCKSIZE", "256")) );
+        atoi(CSLFetchNameValueDef(papszOptions, "BLOCKSIZE", "256")),
+        nGridStep );
 
     poReprojectedGrid->ReleaseRef();
 
@@ -34,6 +34,7 @@
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -257,6 +258,137 @@ static int CutlineTransformer( void *pTransformArg,
     return TRUE;
 }
 
+/************************************************************************/
+/*                    CutlineSegmentIntersectsRect()                    */
+/************************************************************************/
+
+static bool CutlineSegmentIntersectsRect( double dfX0, double dfY0,
+                                          double dfX1, double dfY1,
+                                          const OGREnvelope& sRect )
+{
+    if( std::max(dfX0, dfX1) < sRect.MinX ||
+        std::min(dfX0, dfX1) > sRect.MaxX ||
+        std::max(dfY0, dfY1) < sRect.MinY ||
+        std::min(dfY0, dfY1) > sRect.MaxY )
+        return false;
+
+    if( (dfX0 >= sRect.MinX && dfX0 <= sRect.MaxX &&
+         dfY0 >= sRect.MinY && dfY0 <= sRect.MaxY) ||
+        (dfX1 >= sRect.MinX && dfX1 <= sRect.MaxX &&
+         dfY1 >= sRect.MinY && dfY1 <= sRect.MaxY) )
+        return true;
+
+    // Liang-Barsky clipping of the segment against the rectangle.
+    const double dfDX = dfX1 - dfX0;
+    const double dfDY = dfY1 - dfY0;
+    const double adfP[4] = { -dfDX, dfDX, -dfDY, dfDY };
+    const double adfQ[4] = { dfX0 - sRect.MinX, sRect.MaxX - dfX0,
+                             dfY0 - sRect.MinY, sRect.MaxY - dfY0 };
+    double dfT0 = 0.0;
+    double dfT1 = 1.0;
+    for( int i = 0; i < 4; i++ )
+    {
+        if( adfP[i] == 0.0 )
+        {
+            if( adfQ[i] < 0.0 )
+                return false;
+            continue;
+        }
+        const double dfT = adfQ[i] / adfP[i];
+        if( adfP[i] < 0.0 )
+        {
+            if( dfT > dfT1 )
+                return false;
+            dfT0 = std::max(dfT0, dfT);
+        }
+        else
+        {
+            if( dfT < dfT0 )
+                return false;
+            dfT1 = std::min(dfT1, dfT);
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                       CutlineClipRingToEdge()                        */
+/*                                                                      */
+/*      One Sutherland-Hodgman pass: keep the part of the ring on       */
+/*      one side of the line x = dfValue (iAxis == 0) or y = dfValue.   */
+/************************************************************************/
+
+static void CutlineClipRingToEdge( const std::vector<OGRRawPoint>& aoIn,
+                                   std::vector<OGRRawPoint>& aoOut,
+                                   int iAxis, double dfValue,
+                                   bool bKeepGreater )
+{
+    aoOut.clear();
+    const size_t nPoints = aoIn.size();
+    if( nPoints == 0 )
+        return;
+
+    const auto IsIn = [iAxis, dfValue, bKeepGreater](const OGRRawPoint& oP)
+    {
+        const double dfV = iAxis == 0 ? oP.x : oP.y;
+        return bKeepGreater ? dfV >= dfValue : dfV <= dfValue;
+    };
+
+    OGRRawPoint oPrev = aoIn[nPoints - 1];
+    bool bPrevIn = IsIn(oPrev);
+    for( size_t i = 0; i < nPoints; i++ )
+    {
+        const OGRRawPoint& oCur = aoIn[i];
+        const bool bCurIn = IsIn(oCur);
+        if( bCurIn != bPrevIn )
+        {
+            OGRRawPoint oInter;
+            if( iAxis == 0 )
+            {
+                const double dfT = (dfValue - oPrev.x) / (oCur.x - oPrev.x);
+                oInter.x = dfValue;
+                oInter.y = oPrev.y + dfT * (oCur.y - oPrev.y);
+            }
+            else
+            {
+                const double dfT = (dfValue - oPrev.y) / (oCur.y - oPrev.y);
+                oInter.x = oPrev.x + dfT * (oCur.x - oPrev.x);
+                oInter.y = dfValue;
+            }
+            aoOut.push_back(oInter);
+        }
+        if( bCurIn )
+            aoOut.push_back(oCur);
+        oPrev = oCur;
+        bPrevIn = bCurIn;
+    }
+}
+
+/************************************************************************/
+/*                        CollectCutlineRings()                         */
+/************************************************************************/
+
+static void CollectCutlineRings( OGRGeometry *poGeom,
+                                 std::vector<OGRLinearRing*>& apoRings )
+{
+    const OGRwkbGeometryType eType =
+        wkbFlatten(poGeom->getGeometryType());
+    if( eType == wkbMultiPolygon )
+    {
+        OGRMultiPolygon *poMP = poGeom->toMultiPolygon();
+        for( int i = 0; i < poMP->getNumGeometries(); i++ )
+            CollectCutlineRings(poMP->getGeometryRef(i), apoRings);
+    }
+    else if( eType == wkbPolygon )
+    {
+        OGRPolygon *poPoly = poGeom->toPolygon();
+        if( poPoly->getExteriorRing() != nullptr )
+            apoRings.push_back(poPoly->getExteriorRing());
+        for( int i = 0; i < poPoly->getNumInteriorRings(); i++ )
+            apoRings.push_back(poPoly->getInteriorRing(i));
+    }
+}
+
 /************************************************************************/
 /*                       GDALWarpCutlineMasker()                        */
 /*                                                                      */
@@ -330,6 +462,102 @@ GDALWarpCutlineMasker( void *pMaskFuncArg,
         return CE_None;
     }
 
+/* -------------------------------------------------------------------- */
+/*      When the cutline extends beyond the chunk, check whether any    */
+/*      of its edges come near the chunk. If none does, the chunk is    */
+/*      entirely inside or entirely outside and nothing needs to be     */
+/*      rasterized. Otherwise, clip the rings to a rectangle slightly   */
+/*      bigger than the chunk, so that the rasterizer only has to       */
+/*      deal with the relevant edges of complex cutlines.               */
+/* -------------------------------------------------------------------- */
+    OGRPolygon oClippedPolygon;
+    OGRGeometryH hBurnGeometry = hPolygon;
+
+    const double dfMargin = psWO->dfCutlineBlendDist + 2.0;
+    OGREnvelope sChunkRect;
+    sChunkRect.MinX = nXOff - dfMargin;
+    sChunkRect.MinY = nYOff - dfMargin;
+    sChunkRect.MaxX = nXOff + nXSize + dfMargin;
+    sChunkRect.MaxY = nYOff + nYSize + dfMargin;
+
+    if( !sChunkRect.Contains(sEnvelope) )
+    {
+        std::vector<OGRLinearRing*> apoRings;
+        CollectCutlineRings(OGRGeometry::FromHandle(hPolygon), apoRings);
+
+        // Even-odd test of the chunk center, like the rasterizer does.
+        const double dfCenterX = nXOff + nXSize * 0.5;
+        const double dfCenterY = nYOff + nYSize * 0.5;
+        bool bCenterInside = false;
+        bool bEdgeNearChunk = false;
+        std::vector<OGRRawPoint> aoPoints;
+
+        for( const OGRLinearRing *poRing : apoRings )
+        {
+            const int nPoints = poRing->getNumPoints();
+            if( nPoints < 2 )
+                continue;
+            aoPoints.resize(nPoints);
+            poRing->getPoints(&aoPoints[0]);
+            for( int i = 0, j = nPoints - 1; i < nPoints; j = i++ )
+            {
+                const OGRRawPoint& oP0 = aoPoints[j];
+                const OGRRawPoint& oP1 = aoPoints[i];
+                if( (oP0.y > dfCenterY) != (oP1.y > dfCenterY) &&
+                    dfCenterX < oP0.x + (oP1.x - oP0.x) *
+                                (dfCenterY - oP0.y) / (oP1.y - oP0.y) )
+                {
+                    bCenterInside = !bCenterInside;
+                }
+                if( !bEdgeNearChunk &&
+                    CutlineSegmentIntersectsRect(oP0.x, oP0.y,
+                                                 oP1.x, oP1.y, sChunkRect) )
+                {
+                    bEdgeNearChunk = true;
+                }
+            }
+        }
+
+#ifndef HAVE_GEOS
+        // Keep reporting that blending is not available.
+        const bool bCanSkipChunk = psWO->dfCutlineBlendDist == 0.0;
+#else
+        const bool bCanSkipChunk = true;
+#endif
+        if( !bEdgeNearChunk && bCanSkipChunk )
+        {
+            if( !bCenterInside )
+                memset( pafMask, 0, sizeof(float) * nXSize * nYSize );
+            return CE_None;
+        }
+
+        std::vector<OGRRawPoint> aoClipped;
+        for( const OGRLinearRing *poRing : apoRings )
+        {
+            OGREnvelope sRingEnvelope;
+            poRing->getEnvelope(&sRingEnvelope);
+            if( poRing->getNumPoints() < 3 ||
+                !sChunkRect.Intersects(sRingEnvelope) )
+                continue;
+
+            aoPoints.resize(poRing->getNumPoints());
+            poRing->getPoints(&aoPoints[0]);
+            CutlineClipRingToEdge(aoPoints, aoClipped, 0, sChunkRect.MinX, true);
+            CutlineClipRingToEdge(aoClipped, aoPoints, 0, sChunkRect.MaxX, false);
+            CutlineClipRingToEdge(aoPoints, aoClipped, 1, sChunkRect.MinY, true);
+            CutlineClipRingToEdge(aoClipped, aoPoints, 1, sChunkRect.MaxY, false);
+            if( aoPoints.size() < 3 )
+                continue;
+
+            aoPoints.push_back(aoPoints[0]);
+            OGRLinearRing *poClippedRing = new OGRLinearRing();
+            poClippedRing->setPoints(static_cast<int>(aoPoints.size()),
+                                     &aoPoints[0]);
+            oClippedPolygon.addRingDirectly(poClippedRing);
+        }
+        hBurnGeometry = OGRGeometry::ToHandle(&oClippedPolygon);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Create a byte buffer into which we can burn the                 */
 /*      mask polygon and wrap it up as a memory dataset.                */
@@ -368,7 +596,7 @@ GDALWarpCutlineMasker( void *pMaskFuncArg,
 
     CPLErr eErr =
         GDALRasterizeGeometries( hMemDS, 1, &nTargetBand,
-                                 1, &hPolygon,
+                                 1, &hBurnGeometry,
                                  CutlineTransformer, anXYOff,
                                  &dfBurnValue, papszRasterizeOptions,
                                  nullptr, nullptr );
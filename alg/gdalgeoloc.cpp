@@ -37,9 +37,13 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <new>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_mem_cache.h"
 #include "cpl_minixml.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
@@ -65,6 +69,94 @@ const double FSHIFT = 0.5;
 const double ISHIFT = 0.5;
 const double OVERSAMPLE_FACTOR=1.3;
 
+// Geolocation arrays larger than that are not loaded in memory by default.
+constexpr double GEOLOC_MAX_IN_MEMORY_PIXELS = 16 * 1024 * 1024;
+// Size of the tiles of GDALGeoLocTileCache.
+constexpr int GEOLOC_TILE_SIZE = 256;
+// Maximum number of tiles of each GDALGeoLocTileCache.
+constexpr size_t GEOLOC_MAX_CACHED_TILES = 64;
+// Approximate memory used to build a strip of the temporary backmap.
+constexpr double GEOLOC_BACKMAP_STRIP_MEMORY = 256 * 1024 * 1024;
+
+/************************************************************************/
+/*                         GDALGeoLocTileCache                          */
+/************************************************************************/
+
+// Read-only access to the pixels of a band through an in-memory cache of
+// GEOLOC_TILE_SIZE x GEOLOC_TILE_SIZE tiles, recycled in least-recently-used
+// order.
+template<class T> class GDALGeoLocTileCache
+{
+    typedef std::shared_ptr<std::vector<T>> TilePtr;
+
+    GDALRasterBandH m_hBand;
+    int m_nXSize;
+    int m_nYSize;
+    int m_nTilesPerRow;
+    lru11::Cache<GIntBig, TilePtr> m_oCache;
+    // Shortcut for the tile of the previous access.
+    GIntBig m_nLastKey = -1;
+    TilePtr m_poLastTile{};
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALGeoLocTileCache)
+
+  public:
+    explicit GDALGeoLocTileCache( GDALRasterBandH hBand ) :
+        m_hBand(hBand),
+        m_nXSize(GDALGetRasterBandXSize(hBand)),
+        m_nYSize(GDALGetRasterBandYSize(hBand)),
+        m_nTilesPerRow(DIV_ROUND_UP(m_nXSize, GEOLOC_TILE_SIZE)),
+        m_oCache(GEOLOC_MAX_CACHED_TILES, 0) {}
+
+    bool Get( int iX, int iY, T& val );
+};
+
+template<class T>
+bool GDALGeoLocTileCache<T>::Get( int iX, int iY, T& val )
+{
+    const int nTileX = iX / GEOLOC_TILE_SIZE;
+    const int nTileY = iY / GEOLOC_TILE_SIZE;
+    const int nTileXOff = nTileX * GEOLOC_TILE_SIZE;
+    const int nTileYOff = nTileY * GEOLOC_TILE_SIZE;
+    const int nTileWidth = std::min(GEOLOC_TILE_SIZE, m_nXSize - nTileXOff);
+    const GIntBig nKey = static_cast<GIntBig>(nTileY) * m_nTilesPerRow + nTileX;
+    if( nKey != m_nLastKey )
+    {
+        TilePtr poTile;
+        if( !m_oCache.tryGet(nKey, poTile) )
+        {
+            const int nTileHeight =
+                std::min(GEOLOC_TILE_SIZE, m_nYSize - nTileYOff);
+            try
+            {
+                poTile = std::make_shared<std::vector<T>>(
+                    static_cast<size_t>(nTileWidth) * nTileHeight);
+            }
+            catch( const std::bad_alloc& )
+            {
+                CPLError(CE_Failure, CPLE_OutOfMemory,
+                         "Cannot allocate geolocation tile");
+                return false;
+            }
+            const GDALDataType eDT =
+                sizeof(T) == sizeof(float) ? GDT_Float32 : GDT_Float64;
+            if( GDALRasterIO( m_hBand, GF_Read,
+                              nTileXOff, nTileYOff, nTileWidth, nTileHeight,
+                              poTile->data(), nTileWidth, nTileHeight,
+                              eDT, 0, 0 ) != CE_None )
+            {
+                return false;
+            }
+            m_oCache.insert(nKey, poTile);
+        }
+        m_nLastKey = nKey;
+        m_poLastTile = poTile;
+    }
+    val = (*m_poLastTile)[static_cast<size_t>(iY - nTileYOff) * nTileWidth +
+                          iX - nTileXOff];
+    return true;
+}
+
 typedef struct {
     GDALTransformerInfo sTI;
 
@@ -102,6 +194,19 @@ typedef struct {
 
     char **          papszGeolocationInfo;
 
+    // When set, the geolocation arrays are not loaded in memory, but read
+    // through tile caches (or, for a regular grid, padfGeoLocX and
+    // padfGeoLocY only hold nGeoLocXSize and nGeoLocYSize values), and the
+    // backmap is built by strips into a temporary GTiff file.
+    bool             bUseTempDatasets;
+    bool             bRegularGrid;
+    GDALGeoLocTileCache<double> *poGeoLocXCache;
+    GDALGeoLocTileCache<double> *poGeoLocYCache;
+    GDALDatasetH     hBackMapDS;
+    char            *pszBackMapFilename;
+    GDALGeoLocTileCache<float> *poBackMapXCache;
+    GDALGeoLocTileCache<float> *poBackMapYCache;
+
 } GDALGeoLocTransformInfo;
 
 /************************************************************************/
@@ -131,6 +236,40 @@ static bool GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
     psTransform->nGeoLocXSize = nXSize;
     psTransform->nGeoLocYSize = nYSize;
 
+    if( psTransform->bUseTempDatasets )
+    {
+        psTransform->dfNoDataX =
+            GDALGetRasterNoDataValue( psTransform->hBand_X,
+                                      &(psTransform->bHasNoData) );
+
+        if( nYSize_XBand == 1 && nYSize_YBand == 1 )
+        {
+            // Regular grid: just keep the X coordinates of the columns and
+            // the Y coordinates of the lines.
+            psTransform->bRegularGrid = true;
+            psTransform->padfGeoLocX = static_cast<double *>(
+                VSI_MALLOC2_VERBOSE(nXSize, sizeof(double)));
+            psTransform->padfGeoLocY = static_cast<double *>(
+                VSI_MALLOC2_VERBOSE(nYSize, sizeof(double)));
+            return psTransform->padfGeoLocX != nullptr &&
+                   psTransform->padfGeoLocY != nullptr &&
+                   GDALRasterIO( psTransform->hBand_X, GF_Read,
+                                 0, 0, nXSize, 1,
+                                 psTransform->padfGeoLocX, nXSize, 1,
+                                 GDT_Float64, 0, 0 ) == CE_None &&
+                   GDALRasterIO( psTransform->hBand_Y, GF_Read,
+                                 0, 0, nYSize, 1,
+                                 psTransform->padfGeoLocY, nYSize, 1,
+                                 GDT_Float64, 0, 0 ) == CE_None;
+        }
+
+        psTransform->poGeoLocXCache =
+            new GDALGeoLocTileCache<double>(psTransform->hBand_X);
+        psTransform->poGeoLocYCache =
+            new GDALGeoLocTileCache<double>(psTransform->hBand_Y);
+        return true;
+    }
+
     psTransform->padfGeoLocY = static_cast<double *>(
         VSI_MALLOC3_VERBOSE(sizeof(double), nXSize, nYSize));
     psTransform->padfGeoLocX = static_cast<double *>(
@@ -214,6 +353,122 @@ static bool GeoLocLoadFullData( GDALGeoLocTransformInfo *psTransform )
     return true;
 }
 
+/************************************************************************/
+/*                           GeoLocGetLine()                            */
+/*                                                                      */
+/*      Fetch line iY of the geolocation arrays.  Points into the       */
+/*      in-memory arrays when they are loaded, and otherwise into       */
+/*      padfXBuf / padfYBuf which must be nGeoLocXSize long.            */
+/************************************************************************/
+
+static bool GeoLocGetLine( const GDALGeoLocTransformInfo *psTransform,
+                           int iY, double *padfXBuf, double *padfYBuf,
+                           const double **ppadfX, const double **ppadfY )
+{
+    const int nXSize = psTransform->nGeoLocXSize;
+    if( !psTransform->bUseTempDatasets )
+    {
+        *ppadfX = psTransform->padfGeoLocX + static_cast<size_t>(iY) * nXSize;
+        *ppadfY = psTransform->padfGeoLocY + static_cast<size_t>(iY) * nXSize;
+        return true;
+    }
+    if( psTransform->bRegularGrid )
+    {
+        for( int iX = 0; iX < nXSize; iX++ )
+            padfYBuf[iX] = psTransform->padfGeoLocY[iY];
+        *ppadfX = psTransform->padfGeoLocX;
+        *ppadfY = padfYBuf;
+        return true;
+    }
+    *ppadfX = padfXBuf;
+    *ppadfY = padfYBuf;
+    return GDALRasterIO( psTransform->hBand_X, GF_Read,
+                         0, iY, nXSize, 1, padfXBuf, nXSize, 1,
+                         GDT_Float64, 0, 0 ) == CE_None &&
+           GDALRasterIO( psTransform->hBand_Y, GF_Read,
+                         0, iY, nXSize, 1, padfYBuf, nXSize, 1,
+                         GDT_Float64, 0, 0 ) == CE_None;
+}
+
+/************************************************************************/
+/*                            GeoLocGetXY()                             */
+/************************************************************************/
+
+static bool GeoLocGetXY( const GDALGeoLocTransformInfo *psTransform,
+                         int iX, int iY, double *pdfX, double *pdfY )
+{
+    if( !psTransform->bUseTempDatasets )
+    {
+        const size_t nIdx =
+            static_cast<size_t>(iY) * psTransform->nGeoLocXSize + iX;
+        *pdfX = psTransform->padfGeoLocX[nIdx];
+        *pdfY = psTransform->padfGeoLocY[nIdx];
+        return true;
+    }
+    if( psTransform->bRegularGrid )
+    {
+        *pdfX = psTransform->padfGeoLocX[iX];
+        *pdfY = psTransform->padfGeoLocY[iY];
+        return true;
+    }
+    return psTransform->poGeoLocXCache->Get(iX, iY, *pdfX) &&
+           psTransform->poGeoLocYCache->Get(iX, iY, *pdfY);
+}
+
+/************************************************************************/
+/*                         GeoLocGetBackMapXY()                         */
+/************************************************************************/
+
+static bool GeoLocGetBackMapXY( const GDALGeoLocTransformInfo *psTransform,
+                                int iBMX, int iBMY, float *pfX, float *pfY )
+{
+    if( !psTransform->bUseTempDatasets )
+    {
+        const size_t nIdx =
+            static_cast<size_t>(iBMY) * psTransform->nBackMapWidth + iBMX;
+        *pfX = psTransform->pafBackMapX[nIdx];
+        *pfY = psTransform->pafBackMapY[nIdx];
+        return true;
+    }
+    return psTransform->poBackMapXCache->Get(iBMX, iBMY, *pfX) &&
+           psTransform->poBackMapYCache->Get(iBMX, iBMY, *pfY);
+}
+
+/************************************************************************/
+/*                        GeoLocCreateTempBackMap()                     */
+/************************************************************************/
+
+static bool GeoLocCreateTempBackMap( GDALGeoLocTransformInfo *psTransform )
+{
+    GDALDriverH hDriver = GDALGetDriverByName("GTiff");
+    if( hDriver == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "GDAL_GEOLOC_USE_TEMP_DATASETS needs GTiff driver" );
+        return false;
+    }
+    const CPLString osTmpFile =
+        CPLString(CPLGenerateTempFilename( "geoloc_backmap" )) + ".tif";
+    const char* const apszOptions[] = {
+        "TILED=YES",
+        "BLOCKXSIZE=256", "BLOCKYSIZE=256",
+        "SPARSE_OK=YES",
+        "BIGTIFF=IF_SAFER",
+        nullptr };
+    psTransform->hBackMapDS =
+        GDALCreate( hDriver, osTmpFile,
+                    psTransform->nBackMapWidth, psTransform->nBackMapHeight,
+                    2, GDT_Float32, const_cast<char**>(apszOptions) );
+    if( psTransform->hBackMapDS == nullptr )
+        return false;
+    // On Unix, attempt at deleting the temporary file now, so that
+    // if the process gets interrupted, it is automatically destroyed
+    // by the operating system.
+    if( VSIUnlink( osTmpFile ) != 0 )
+        psTransform->pszBackMapFilename = CPLStrdup(osTmpFile);
+    return true;
+}
+
 /************************************************************************/
 /*                       GeoLocGenerateBackMap()                        */
 /************************************************************************/
@@ -224,6 +479,30 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
     const int nXSize = psTransform->nGeoLocXSize;
     const int nYSize = psTransform->nGeoLocYSize;
     const int nMaxIter = 3;
+    const bool bUseTempDatasets = psTransform->bUseTempDatasets;
+
+    // Line buffers, and extent of the Y coordinates of each line, used to
+    // only revisit the lines that contribute to a strip of the backmap.
+    std::vector<double> adfXLine;
+    std::vector<double> adfYLine;
+    std::vector<double> adfLineMinY;
+    std::vector<double> adfLineMaxY;
+    if( bUseTempDatasets )
+    {
+        try
+        {
+            adfXLine.resize(nXSize);
+            adfYLine.resize(nXSize);
+            adfLineMinY.resize(nYSize);
+            adfLineMaxY.resize(nYSize);
+        }
+        catch( const std::bad_alloc& )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate geolocation line buffers");
+            return false;
+        }
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Scan forward map for lat/long extents.                          */
@@ -234,27 +513,46 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
     double dfMaxY = 0.0;
     bool bInit = false;
 
-    for( int i = nXSize * nYSize - 1; i >= 0; i-- )
+    for( int iY = nYSize - 1; iY >= 0; iY-- )
     {
-        if( !psTransform->bHasNoData ||
-            psTransform->padfGeoLocX[i] != psTransform->dfNoDataX )
+        const double* padfGeoLocX = nullptr;
+        const double* padfGeoLocY = nullptr;
+        if( !GeoLocGetLine( psTransform, iY, adfXLine.data(), adfYLine.data(),
+                            &padfGeoLocX, &padfGeoLocY ) )
         {
-            if( bInit )
-            {
-                dfMinX = std::min(dfMinX, psTransform->padfGeoLocX[i]);
-                dfMaxX = std::max(dfMaxX, psTransform->padfGeoLocX[i]);
-                dfMinY = std::min(dfMinY, psTransform->padfGeoLocY[i]);
-                dfMaxY = std::max(dfMaxY, psTransform->padfGeoLocY[i]);
-            }
-            else
+            return false;
+        }
+        double dfLineMinY = std::numeric_limits<double>::infinity();
+        double dfLineMaxY = -std::numeric_limits<double>::infinity();
+        for( int iX = nXSize - 1; iX >= 0; iX-- )
+        {
+            if( !psTransform->bHasNoData ||
+                padfGeoLocX[iX] != psTransform->dfNoDataX )
             {
-                bInit = true;
-                dfMinX = psTransform->padfGeoLocX[i];
-                dfMaxX = psTransform->padfGeoLocX[i];
-                dfMinY = psTransform->padfGeoLocY[i];
-                dfMaxY = psTransform->padfGeoLocY[i];
+                if( bInit )
+                {
+                    dfMinX = std::min(dfMinX, padfGeoLocX[iX]);
+                    dfMaxX = std::max(dfMaxX, padfGeoLocX[iX]);
+                    dfMinY = std::min(dfMinY, padfGeoLocY[iX]);
+                    dfMaxY = std::max(dfMaxY, padfGeoLocY[iX]);
+                }
+                else
+                {
+                    bInit = true;
+                    dfMinX = padfGeoLocX[iX];
+                    dfMaxX = padfGeoLocX[iX];
+                    dfMinY = padfGeoLocY[iX];
+                    dfMaxY = padfGeoLocY[iX];
+                }
+                dfLineMinY = std::min(dfLineMinY, padfGeoLocY[iX]);
+                dfLineMaxY = std::max(dfLineMaxY, padfGeoLocY[iX]);
             }
         }
+        if( bUseTempDatasets )
+        {
+            adfLineMinY[iY] = dfLineMinY;
+            adfLineMaxY[iY] = dfLineMaxY;
+        }
     }
 
 /* -------------------------------------------------------------------- */
@@ -263,7 +561,8 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
 /*      establish how much dead space there is in the backmap, so it    */
 /*      is approximate.                                                 */
 /* -------------------------------------------------------------------- */
-    const double dfTargetPixels = (nXSize * nYSize * OVERSAMPLE_FACTOR);
+    const double dfTargetPixels =
+        (static_cast<double>(nXSize) * nYSize * OVERSAMPLE_FACTOR);
     const double dfPixelSize = sqrt((dfMaxX - dfMinX) * (dfMaxY - dfMinY)
                               / dfTargetPixels);
 
@@ -272,7 +571,8 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
     const int nBMXSize = psTransform->nBackMapWidth =
         static_cast<int>((dfMaxX - dfMinX) / dfPixelSize + 1);
 
-    if( nBMXSize > std::numeric_limits<int>::max() / nBMYSize )
+    if( !bUseTempDatasets &&
+        nBMXSize > std::numeric_limits<int>::max() / nBMYSize )
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Int overflow : %d x %d",
                  nBMXSize, nBMYSize);
@@ -292,34 +592,92 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
     psTransform->adfBackMapGeoTransform[4] = 0.0;
     psTransform->adfBackMapGeoTransform[5] = -dfPixelSize;
 
+/* -------------------------------------------------------------------- */
+/*      The backmap is computed by strips of nStripHeight lines.  In    */
+/*      memory, there is a single strip and the buffers are the         */
+/*      backmap itself.  Otherwise, each strip is computed with         */
+/*      nMaxIter lines of margin on each side, so that hole filling     */
+/*      gives the same result as on the whole backmap, and written      */
+/*      to the temporary dataset.                                       */
+/* -------------------------------------------------------------------- */
+    int nStripHeight = nBMYSize;
+    int nMargin = 0;
+    if( bUseTempDatasets )
+    {
+        if( !GeoLocCreateTempBackMap( psTransform ) )
+            return false;
+        nMargin = nMaxIter;
+        // Bytes per backmap pixel: X, Y, weight and validity flag.
+        const double dfLineMemory = static_cast<double>(nBMXSize) *
+            (3 * sizeof(float) + sizeof(GByte));
+        nStripHeight = static_cast<int>(std::max(1.0, std::min(
+            static_cast<double>(nBMYSize),
+            GEOLOC_BACKMAP_STRIP_MEMORY / dfLineMemory - 2 * nMargin)));
+        if( nStripHeight > GEOLOC_TILE_SIZE && nStripHeight < nBMYSize )
+        {
+            nStripHeight = (nStripHeight / GEOLOC_TILE_SIZE) *
+                           GEOLOC_TILE_SIZE;
+        }
+        if( static_cast<double>(nBMXSize) *
+                std::min(nBMYSize, nStripHeight + 2 * nMargin) >
+            std::numeric_limits<int>::max() )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Int overflow : %d x %d",
+                     nBMXSize, nStripHeight + 2 * nMargin);
+            return false;
+        }
+    }
+    const int nMaxBufHeight = std::min(nBMYSize, nStripHeight + 2 * nMargin);
+
 /* -------------------------------------------------------------------- */
 /*      Allocate backmap, and initialize to nodata value (-1.0).        */
 /* -------------------------------------------------------------------- */
     GByte *pabyValidFlag = static_cast<GByte *>(
-        VSI_CALLOC_VERBOSE(nBMXSize, nBMYSize));
+        VSI_CALLOC_VERBOSE(nBMXSize, nMaxBufHeight));
 
-    psTransform->pafBackMapX = static_cast<float *>(
-        VSI_MALLOC3_VERBOSE(nBMXSize, nBMYSize, sizeof(float)));
-    psTransform->pafBackMapY = static_cast<float *>(
-        VSI_MALLOC3_VERBOSE(nBMXSize, nBMYSize, sizeof(float)));
+    float* pafBackMapX = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nBMXSize, nMaxBufHeight, sizeof(float)));
+    float* pafBackMapY = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nBMXSize, nMaxBufHeight, sizeof(float)));
+    if( !bUseTempDatasets )
+    {
+        psTransform->pafBackMapX = pafBackMapX;
+        psTransform->pafBackMapY = pafBackMapY;
+    }
 
     float *wgtsBackMap = static_cast<float *>(
-        VSI_MALLOC3_VERBOSE(nBMXSize, nBMYSize, sizeof(float)));
+        VSI_MALLOC3_VERBOSE(nBMXSize, nMaxBufHeight, sizeof(float)));
 
     if( pabyValidFlag == nullptr ||
-        psTransform->pafBackMapX == nullptr ||
-        psTransform->pafBackMapY == nullptr ||
+        pafBackMapX == nullptr ||
+        pafBackMapY == nullptr ||
         wgtsBackMap == nullptr)
     {
         CPLFree( pabyValidFlag );
         CPLFree( wgtsBackMap );
+        if( bUseTempDatasets )
+        {
+            CPLFree( pafBackMapX );
+            CPLFree( pafBackMapY );
+        }
         return false;
     }
 
-    for( int i = nBMXSize * nBMYSize - 1; i >= 0; i-- )
+    bool bOK = true;
+    for( int nStripYOff = 0;
+         bOK && nStripYOff < nBMYSize;
+         nStripYOff += nStripHeight )
     {
-        psTransform->pafBackMapX[i] = 0.0;
-        psTransform->pafBackMapY[i] = 0.0;
+    const int nStripYEnd = std::min(nBMYSize, nStripYOff + nStripHeight);
+    // Lines [nBufYOff, nBufYEnd[ of the backmap are in the buffers.
+    const int nBufYOff = std::max(0, nStripYOff - nMargin);
+    const int nBufYEnd = std::min(nBMYSize, nStripYEnd + nMargin);
+    const int nBufHeight = nBufYEnd - nBufYOff;
+
+    for( int i = nBMXSize * nBufHeight - 1; i >= 0; i-- )
+    {
+        pafBackMapX[i] = 0.0;
+        pafBackMapY[i] = 0.0;
         wgtsBackMap[i] = 0.0;
         pabyValidFlag[i] = 0;
     }
@@ -331,22 +689,41 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
 /*      valid pixels in the hole-filling loop.                          */
 /* -------------------------------------------------------------------- */
 
-    for( int iY = 0; iY < nYSize; iY++ )
+    for( int iY = 0; bOK && iY < nYSize; iY++ )
     {
+        if( bUseTempDatasets )
+        {
+            // Skip lines that do not push into the current buffers.
+            if( adfLineMinY[iY] > adfLineMaxY[iY] )
+                continue;
+            const int iBMYTop = static_cast<int>(
+                (dfMaxY - adfLineMaxY[iY]) / dfPixelSize - FSHIFT);
+            const int iBMYBottom = static_cast<int>(
+                (dfMaxY - adfLineMinY[iY]) / dfPixelSize - FSHIFT);
+            if( iBMYBottom + 1 < nBufYOff || iBMYTop >= nBufYEnd )
+                continue;
+        }
+
+        const double* padfGeoLocX = nullptr;
+        const double* padfGeoLocY = nullptr;
+        if( !GeoLocGetLine( psTransform, iY, adfXLine.data(), adfYLine.data(),
+                            &padfGeoLocX, &padfGeoLocY ) )
+        {
+            bOK = false;
+            break;
+        }
+
         for( int iX = 0; iX < nXSize; iX++ )
         {
             if( psTransform->bHasNoData &&
-                psTransform->padfGeoLocX[iX + iY * nXSize]
-                == psTransform->dfNoDataX )
+                padfGeoLocX[iX] == psTransform->dfNoDataX )
                 continue;
 
-            const int i = iX + iY * nXSize;
-
             const double dBMX = static_cast<double>(
-                    (psTransform->padfGeoLocX[i] - dfMinX) / dfPixelSize) - FSHIFT;
+                    (padfGeoLocX[iX] - dfMinX) / dfPixelSize) - FSHIFT;
 
             const double dBMY = static_cast<double>(
-                (dfMaxY - psTransform->padfGeoLocY[i]) / dfPixelSize) - FSHIFT;
+                (dfMaxY - padfGeoLocY[iX]) / dfPixelSize) - FSHIFT;
 
 
             //Get top left index by truncation
@@ -359,112 +736,120 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
             if( iBMX < -1 || iBMY < -1 || iBMX > nBMXSize || iBMY > nBMYSize )
                 continue;
 
+            // Lines of the top and bottom pixels in the buffers.
+            const int iBufY = iBMY - nBufYOff;
+            const bool bTopInBuf = iBMY >= nBufYOff && iBMY < nBufYEnd;
+            const bool bBottomInBuf =
+                iBMY + 1 >= nBufYOff && iBMY + 1 < nBufYEnd;
+
             //Check logic for top left pixel
-            if ((iBMX >= 0) && (iBMY >= 0) && (iBMX < nBMXSize) && (iBMY < nBMYSize))
+            if ((iBMX >= 0) && bTopInBuf && (iBMX < nBMXSize))
             {
                 const double tempwt = (1.0 - fracBMX) * (1.0 - fracBMY);
-                psTransform->pafBackMapX[iBMX + iBMY * nBMXSize] +=
+                pafBackMapX[iBMX + iBufY * nBMXSize] +=
                     static_cast<float>( tempwt * (
                         (iX + FSHIFT) * psTransform->dfPIXEL_STEP +
                         psTransform->dfPIXEL_OFFSET));
 
-                psTransform->pafBackMapY[iBMX + iBMY * nBMXSize] +=
+                pafBackMapY[iBMX + iBufY * nBMXSize] +=
                     static_cast<float>( tempwt * (
                         (iY + FSHIFT) * psTransform->dfLINE_STEP +
                         psTransform->dfLINE_OFFSET));
-                wgtsBackMap[iBMX + iBMY * nBMXSize] += static_cast<float>(tempwt);
+                wgtsBackMap[iBMX + iBufY * nBMXSize] += static_cast<float>(tempwt);
 
                 //For backward compatibility
-                pabyValidFlag[iBMX + iBMY * nBMXSize] = static_cast<GByte>(nMaxIter+1);
+                pabyValidFlag[iBMX + iBufY * nBMXSize] = static_cast<GByte>(nMaxIter+1);
             }
 
             //Check logic for top right pixel
-            if (((iBMX+1) >= 0) && (iBMY >= 0) && ((iBMX+1) < nBMXSize) && (iBMY < nBMYSize))
+            if (((iBMX+1) >= 0) && bTopInBuf && ((iBMX+1) < nBMXSize))
             {
                 const double tempwt = fracBMX * (1.0 - fracBMY);
 
-                psTransform->pafBackMapX[iBMX + 1 + iBMY * nBMXSize] +=
+                pafBackMapX[iBMX + 1 + iBufY * nBMXSize] +=
                     static_cast<float>( tempwt * (
                         (iX + FSHIFT) * psTransform->dfPIXEL_STEP +
                         psTransform->dfPIXEL_OFFSET));
 
-                psTransform->pafBackMapY[iBMX + 1 + iBMY * nBMXSize] +=
+                pafBackMapY[iBMX + 1 + iBufY * nBMXSize] +=
                     static_cast<float>( tempwt * (
                         (iY + FSHIFT)* psTransform->dfLINE_STEP +
                         psTransform->dfLINE_OFFSET));
-                wgtsBackMap[iBMX + 1 + iBMY * nBMXSize] +=  static_cast<float>(tempwt);
+                wgtsBackMap[iBMX + 1 + iBufY * nBMXSize] +=  static_cast<float>(tempwt);
 
                 //For backward compatibility
-                pabyValidFlag[iBMX + 1 + iBMY * nBMXSize] = static_cast<GByte>(nMaxIter+1);
+                pabyValidFlag[iBMX + 1 + iBufY * nBMXSize] = static_cast<GByte>(nMaxIter+1);
             }
 
             //Check logic for bottom right pixel
-            if (((iBMX+1) >= 0) && ((iBMY+1) >= 0) && ((iBMX+1) < nBMXSize) && ((iBMY+1) < nBMYSize))
+            if (((iBMX+1) >= 0) && bBottomInBuf && ((iBMX+1) < nBMXSize))
             {
                 const double tempwt = fracBMX * fracBMY;
-                psTransform->pafBackMapX[iBMX + 1 + (iBMY+1) * nBMXSize] +=
+                pafBackMapX[iBMX + 1 + (iBufY+1) * nBMXSize] +=
                     static_cast<float>( tempwt * (
                         (iX + FSHIFT) * psTransform->dfPIXEL_STEP +
                         psTransform->dfPIXEL_OFFSET));
 
-                psTransform->pafBackMapY[iBMX + 1 + (iBMY+1) * nBMXSize] +=
+                pafBackMapY[iBMX + 1 + (iBufY+1) * nBMXSize] +=
                     static_cast<float>( tempwt * (
                         (iY + FSHIFT) * psTransform->dfLINE_STEP +
                         psTransform->dfLINE_OFFSET));
-                wgtsBackMap[iBMX + 1 + (iBMY+1) * nBMXSize] += static_cast<float>(tempwt);
+                wgtsBackMap[iBMX + 1 + (iBufY+1) * nBMXSize] += static_cast<float>(tempwt);
 
                 //For backward compatibility
-                pabyValidFlag[iBMX + 1 + (iBMY+1) * nBMXSize] = static_cast<GByte>(nMaxIter+1);
+                pabyValidFlag[iBMX + 1 + (iBufY+1) * nBMXSize] = static_cast<GByte>(nMaxIter+1);
             }
 
             //Check logic for bottom left pixel
-            if ((iBMX >= 0) && ((iBMY+1) >= 0) && (iBMX < nBMXSize) && ((iBMY+1) < nBMYSize))
+            if ((iBMX >= 0) && bBottomInBuf && (iBMX < nBMXSize))
             {
                 const double tempwt = (1.0 - fracBMX) * fracBMY;
-                psTransform->pafBackMapX[iBMX + (iBMY+1) * nBMXSize] +=
+                pafBackMapX[iBMX + (iBufY+1) * nBMXSize] +=
                     static_cast<float>( tempwt * (
                         (iX + FSHIFT) * psTransform->dfPIXEL_STEP +
                         psTransform->dfPIXEL_OFFSET));
 
-                psTransform->pafBackMapY[iBMX + (iBMY+1) * nBMXSize] +=
+                pafBackMapY[iBMX + (iBufY+1) * nBMXSize] +=
                     static_cast<float>(tempwt * (
                         (iY + FSHIFT) * psTransform->dfLINE_STEP +
                         psTransform->dfLINE_OFFSET));
-                wgtsBackMap[iBMX + (iBMY+1) * nBMXSize] += static_cast<float>(tempwt);
+                wgtsBackMap[iBMX + (iBufY+1) * nBMXSize] += static_cast<float>(tempwt);
 
                 //For backward compatibility
-                pabyValidFlag[iBMX + (iBMY+1) * nBMXSize] = static_cast<GByte>(nMaxIter+1);
+                pabyValidFlag[iBMX + (iBufY+1) * nBMXSize] = static_cast<GByte>(nMaxIter+1);
             }
 
         }
     }
+    if( !bOK )
+        break;
 
 
     //Each pixel in the backmap may have multiple entries.
-    //We now go in average it out using the weights 
-    for(int i = nBMXSize * nBMYSize - 1; i >= 0; i-- )
+    //We now go in average it out using the weights
+    for(int i = nBMXSize * nBufHeight - 1; i >= 0; i-- )
     {
         //Setting these to -1 for backward compatibility
-        if (pabyValidFlag[i] == 0) 
+        if (pabyValidFlag[i] == 0)
         {
-            psTransform->pafBackMapX[i] = -1.0;
-            psTransform->pafBackMapY[i] = -1.0;
+            pafBackMapX[i] = -1.0;
+            pafBackMapY[i] = -1.0;
         }
         else
         {
             //Check if pixel was only touch during neighbor scan
-            //But no real weight was added as source point matched 
+            //But no real weight was added as source point matched
             //backmap grid node
             if (wgtsBackMap[i] > 0)
             {
-                psTransform->pafBackMapX[i] /= wgtsBackMap[i];
-                psTransform->pafBackMapY[i] /= wgtsBackMap[i];
+                pafBackMapX[i] /= wgtsBackMap[i];
+                pafBackMapY[i] /= wgtsBackMap[i];
                 pabyValidFlag[i] = static_cast<GByte>(nMaxIter+1);
             }
             else
             {
-                psTransform->pafBackMapX[i] = -1.0;
-                psTransform->pafBackMapY[i] = -1.0;
+                pafBackMapX[i] = -1.0;
+                pafBackMapY[i] = -1.0;
                 pabyValidFlag[i] = 0;
             }
         }
@@ -477,7 +862,7 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
     for( int iIter = 0; iIter < nMaxIter; iIter++ )
     {
         int nNumValid = 0;
-        for( int iBMY = 0; iBMY < nBMYSize; iBMY++ )
+        for( int iBMY = 0; iBMY < nBufHeight; iBMY++ )
         {
             for( int iBMX = 0; iBMX < nBMXSize; iBMX++ )
             {
@@ -497,32 +882,32 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
                 if( iBMX > 0 &&
                     pabyValidFlag[iBMX-1+iBMY*nBMXSize] > nMarkedAsGood )
                 {
-                    dfXSum += psTransform->pafBackMapX[iBMX-1+iBMY*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX-1+iBMY*nBMXSize];
+                    dfXSum += pafBackMapX[iBMX-1+iBMY*nBMXSize];
+                    dfYSum += pafBackMapY[iBMX-1+iBMY*nBMXSize];
                     nCount++;
                 }
                 // Right?
                 if( iBMX + 1 < nBMXSize &&
                     pabyValidFlag[iBMX+1+iBMY*nBMXSize] > nMarkedAsGood )
                 {
-                    dfXSum += psTransform->pafBackMapX[iBMX+1+iBMY*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+1+iBMY*nBMXSize];
+                    dfXSum += pafBackMapX[iBMX+1+iBMY*nBMXSize];
+                    dfYSum += pafBackMapY[iBMX+1+iBMY*nBMXSize];
                     nCount++;
                 }
                 // Top?
                 if( iBMY > 0 &&
                     pabyValidFlag[iBMX+(iBMY-1)*nBMXSize] > nMarkedAsGood )
                 {
-                    dfXSum += psTransform->pafBackMapX[iBMX+(iBMY-1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+(iBMY-1)*nBMXSize];
+                    dfXSum += pafBackMapX[iBMX+(iBMY-1)*nBMXSize];
+                    dfYSum += pafBackMapY[iBMX+(iBMY-1)*nBMXSize];
                     nCount++;
                 }
                 // Bottom?
-                if( iBMY + 1 < nBMYSize &&
+                if( iBMY + 1 < nBufHeight &&
                     pabyValidFlag[iBMX+(iBMY+1)*nBMXSize] > nMarkedAsGood )
                 {
-                    dfXSum += psTransform->pafBackMapX[iBMX+(iBMY+1)*nBMXSize];
-                    dfYSum += psTransform->pafBackMapY[iBMX+(iBMY+1)*nBMXSize];
+                    dfXSum += pafBackMapX[iBMX+(iBMY+1)*nBMXSize];
+                    dfYSum += pafBackMapY[iBMX+(iBMY+1)*nBMXSize];
                     nCount++;
                 }
                 // Top-left?
@@ -530,9 +915,9 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
                     pabyValidFlag[iBMX-1+(iBMY-1)*nBMXSize] > nMarkedAsGood )
                 {
                     dfXSum +=
-                        psTransform->pafBackMapX[iBMX-1+(iBMY-1)*nBMXSize];
+                        pafBackMapX[iBMX-1+(iBMY-1)*nBMXSize];
                     dfYSum +=
-                        psTransform->pafBackMapY[iBMX-1+(iBMY-1)*nBMXSize];
+                        pafBackMapY[iBMX-1+(iBMY-1)*nBMXSize];
                     nCount++;
                 }
                 // Top-right?
@@ -540,37 +925,37 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
                     pabyValidFlag[iBMX+1+(iBMY-1)*nBMXSize] > nMarkedAsGood )
                 {
                     dfXSum +=
-                        psTransform->pafBackMapX[iBMX+1+(iBMY-1)*nBMXSize];
+                        pafBackMapX[iBMX+1+(iBMY-1)*nBMXSize];
                     dfYSum +=
-                        psTransform->pafBackMapY[iBMX+1+(iBMY-1)*nBMXSize];
+                        pafBackMapY[iBMX+1+(iBMY-1)*nBMXSize];
                     nCount++;
                 }
                 // Bottom-left?
-                if( iBMX > 0 && iBMY + 1 < nBMYSize &&
+                if( iBMX > 0 && iBMY + 1 < nBufHeight &&
                     pabyValidFlag[iBMX-1+(iBMY+1)*nBMXSize] > nMarkedAsGood )
                 {
                     dfXSum +=
-                        psTransform->pafBackMapX[iBMX-1+(iBMY+1)*nBMXSize];
+                        pafBackMapX[iBMX-1+(iBMY+1)*nBMXSize];
                     dfYSum +=
-                        psTransform->pafBackMapY[iBMX-1+(iBMY+1)*nBMXSize];
+                        pafBackMapY[iBMX-1+(iBMY+1)*nBMXSize];
                     nCount++;
                 }
                 // Bottom-right?
-                if( iBMX + 1 < nBMXSize && iBMY + 1 < nBMYSize &&
+                if( iBMX + 1 < nBMXSize && iBMY + 1 < nBufHeight &&
                     pabyValidFlag[iBMX+1+(iBMY+1)*nBMXSize] > nMarkedAsGood )
                 {
                     dfXSum +=
-                        psTransform->pafBackMapX[iBMX+1+(iBMY+1)*nBMXSize];
+                        pafBackMapX[iBMX+1+(iBMY+1)*nBMXSize];
                     dfYSum +=
-                        psTransform->pafBackMapY[iBMX+1+(iBMY+1)*nBMXSize];
+                        pafBackMapY[iBMX+1+(iBMY+1)*nBMXSize];
                     nCount++;
                 }
 
                 if( nCount > 0 )
                 {
-                    psTransform->pafBackMapX[iBMX + iBMY * nBMXSize] =
+                    pafBackMapX[iBMX + iBMY * nBMXSize] =
                         static_cast<float>(dfXSum/nCount);
-                    psTransform->pafBackMapY[iBMX + iBMY * nBMXSize] =
+                    pafBackMapY[iBMX + iBMY * nBMXSize] =
                         static_cast<float>(dfYSum/nCount);
                     // Genuinely valid points will have value iMaxIter + 1.
                     // On each iteration mark newly valid points with a
@@ -581,14 +966,46 @@ static bool GeoLocGenerateBackMap( GDALGeoLocTransformInfo *psTransform )
                 }
             }
         }
-        if( nNumValid == nBMXSize * nBMYSize )
+        if( nNumValid == nBMXSize * nBufHeight )
             break;
     }
 
+    if( bUseTempDatasets )
+    {
+        // Write the strip, without its margins.
+        const size_t nOffset =
+            static_cast<size_t>(nStripYOff - nBufYOff) * nBMXSize;
+        const int nLines = nStripYEnd - nStripYOff;
+        bOK =
+            GDALRasterIO( GDALGetRasterBand(psTransform->hBackMapDS, 1),
+                          GF_Write, 0, nStripYOff, nBMXSize, nLines,
+                          pafBackMapX + nOffset, nBMXSize, nLines,
+                          GDT_Float32, 0, 0 ) == CE_None &&
+            GDALRasterIO( GDALGetRasterBand(psTransform->hBackMapDS, 2),
+                          GF_Write, 0, nStripYOff, nBMXSize, nLines,
+                          pafBackMapY + nOffset, nBMXSize, nLines,
+                          GDT_Float32, 0, 0 ) == CE_None;
+    }
+    }
+
     CPLFree( wgtsBackMap );
     CPLFree( pabyValidFlag );
 
-    return true;
+    if( bUseTempDatasets )
+    {
+        CPLFree( pafBackMapX );
+        CPLFree( pafBackMapY );
+        if( bOK )
+        {
+            GDALFlushCache( psTransform->hBackMapDS );
+            psTransform->poBackMapXCache = new GDALGeoLocTileCache<float>(
+                GDALGetRasterBand(psTransform->hBackMapDS, 1));
+            psTransform->poBackMapYCache = new GDALGeoLocTileCache<float>(
+                GDALGetRasterBand(psTransform->hBackMapDS, 2));
+        }
+    }
+
+    return bOK;
 }
 
 /************************************************************************/
@@ -646,7 +1063,16 @@ void* GDALCreateSimilarGeoLocTransformer( void *hTransformArg,
 /*                    GDALCreateGeoLocTransformer()                     */
 /************************************************************************/
 
-/** Create GeoLocation transformer */
+/** Create GeoLocation transformer.
+ *
+ * By default, the geolocation arrays and the backmap built from them are
+ * held in memory.  When the geolocation arrays have more than 16 million
+ * pixels, or when the GDAL_GEOLOC_USE_TEMP_DATASETS configuration option is
+ * set to YES, they are instead read through a cache of tiles, and the
+ * backmap is built by strips into a temporary GTiff file (in the directory
+ * pointed by CPL_TMPDIR), so that memory usage remains bounded (GDAL >= 3.1).
+ * Setting GDAL_GEOLOC_USE_TEMP_DATASETS to NO forces the in-memory mode.
+ */
 void *GDALCreateGeoLocTransformer( GDALDatasetH hBaseDS,
                                    char **papszGeolocationInfo,
                                    int bReversed )
@@ -794,7 +1220,24 @@ void *GDALCreateGeoLocTransformer( GDALDatasetH hBaseDS,
         return nullptr;
     }
 
-    if( nXSize_XBand > std::numeric_limits<int>::max() / nYSize_XBand )
+    const char* pszUseTempDatasets =
+        CPLGetConfigOption("GDAL_GEOLOC_USE_TEMP_DATASETS", nullptr);
+    if( pszUseTempDatasets )
+    {
+        psTransform->bUseTempDatasets = CPLTestBool(pszUseTempDatasets);
+    }
+    else
+    {
+        const int nYSize = (nYSize_XBand == 1) ? nXSize_YBand : nYSize_XBand;
+        psTransform->bUseTempDatasets =
+            static_cast<double>(nXSize_XBand) * nYSize >
+                GEOLOC_MAX_IN_MEMORY_PIXELS;
+    }
+    if( psTransform->bUseTempDatasets )
+    {
+        CPLDebug("GEOLOC", "Using temporary datasets for the backmap");
+    }
+    else if( nXSize_XBand > std::numeric_limits<int>::max() / nYSize_XBand )
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Int overflow : %d x %d",
                  nXSize_XBand, nYSize_XBand);
@@ -835,6 +1278,18 @@ void GDALDestroyGeoLocTransformer( void *pTransformAlg )
     CPLFree( psTransform->padfGeoLocX );
     CPLFree( psTransform->padfGeoLocY );
 
+    delete psTransform->poGeoLocXCache;
+    delete psTransform->poGeoLocYCache;
+    delete psTransform->poBackMapXCache;
+    delete psTransform->poBackMapYCache;
+    if( psTransform->hBackMapDS != nullptr )
+        GDALClose( psTransform->hBackMapDS );
+    if( psTransform->pszBackMapFilename != nullptr )
+    {
+        VSIUnlink( psTransform->pszBackMapFilename );
+        CPLFree( psTransform->pszBackMapFilename );
+    }
+
     if( psTransform->hDS_X != nullptr
         && GDALDereferenceDataset( psTransform->hDS_X ) == 0 )
             GDALClose( psTransform->hDS_X );
@@ -869,8 +1324,6 @@ int GDALGeoLocTransform( void *pTransformArg,
 /* -------------------------------------------------------------------- */
     if( !bDstToSrc )
     {
-        const int nXSize = psTransform->nGeoLocXSize;
-
         for( int i = 0; i < nPointCount; i++ )
         {
             if( padfX[i] == HUGE_VAL || padfY[i] == HUGE_VAL )
@@ -891,11 +1344,31 @@ int GDALGeoLocTransform( void *pTransformArg,
             int iY = std::max(0, static_cast<int>(dfGeoLocLine));
             iY = std::min(iY, psTransform->nGeoLocYSize-1);
 
-            double *padfGLX = psTransform->padfGeoLocX + iX + iY * nXSize;
-            double *padfGLY = psTransform->padfGeoLocY + iX + iY * nXSize;
+            // Values of the geolocation arrays at (iX, iY), (iX+1, iY),
+            // (iX, iY+1) and (iX+1, iY+1), when available.
+            const bool bHasRight = iX + 1 < psTransform->nGeoLocXSize;
+            const bool bHasBottom = iY + 1 < psTransform->nGeoLocYSize;
+            double adfGLX[4] = { 0.0, 0.0, 0.0, 0.0 };
+            double adfGLY[4] = { 0.0, 0.0, 0.0, 0.0 };
+            if( !GeoLocGetXY(psTransform, iX, iY, &adfGLX[0], &adfGLY[0]) ||
+                (bHasRight &&
+                 !GeoLocGetXY(psTransform, iX + 1, iY,
+                              &adfGLX[1], &adfGLY[1])) ||
+                (bHasBottom &&
+                 !GeoLocGetXY(psTransform, iX, iY + 1,
+                              &adfGLX[2], &adfGLY[2])) ||
+                (bHasRight && bHasBottom &&
+                 !GeoLocGetXY(psTransform, iX + 1, iY + 1,
+                              &adfGLX[3], &adfGLY[3])) )
+            {
+                panSuccess[i] = FALSE;
+                padfX[i] = HUGE_VAL;
+                padfY[i] = HUGE_VAL;
+                continue;
+            }
 
             if( psTransform->bHasNoData &&
-                padfGLX[0] == psTransform->dfNoDataX )
+                adfGLX[0] == psTransform->dfNoDataX )
             {
                 panSuccess[i] = FALSE;
                 padfX[i] = HUGE_VAL;
@@ -906,50 +1379,49 @@ int GDALGeoLocTransform( void *pTransformArg,
             // This assumes infinite extension beyond borders of available
             // data based on closest grid square.
 
-            if( iX + 1 < psTransform->nGeoLocXSize &&
-                iY + 1 < psTransform->nGeoLocYSize &&
+            if( bHasRight && bHasBottom &&
                 (!psTransform->bHasNoData ||
-                    (padfGLX[1] != psTransform->dfNoDataX &&
-                     padfGLX[nXSize] != psTransform->dfNoDataX &&
-                     padfGLX[nXSize + 1] != psTransform->dfNoDataX) ))
+                    (adfGLX[1] != psTransform->dfNoDataX &&
+                     adfGLX[2] != psTransform->dfNoDataX &&
+                     adfGLX[3] != psTransform->dfNoDataX) ))
             {
                 padfX[i] =
                     (1 - (dfGeoLocLine -iY))
-                    * (padfGLX[0] +
-                       (dfGeoLocPixel-iX) * (padfGLX[1] - padfGLX[0]))
+                    * (adfGLX[0] +
+                       (dfGeoLocPixel-iX) * (adfGLX[1] - adfGLX[0]))
                     + (dfGeoLocLine -iY)
-                    * (padfGLX[nXSize] + (dfGeoLocPixel-iX) *
-                       (padfGLX[nXSize+1] - padfGLX[nXSize]));
+                    * (adfGLX[2] + (dfGeoLocPixel-iX) *
+                       (adfGLX[3] - adfGLX[2]));
                 padfY[i] =
                     (1 - (dfGeoLocLine -iY))
-                    * (padfGLY[0] +
-                       (dfGeoLocPixel-iX) * (padfGLY[1] - padfGLY[0]))
+                    * (adfGLY[0] +
+                       (dfGeoLocPixel-iX) * (adfGLY[1] - adfGLY[0]))
                     + (dfGeoLocLine -iY)
-                    * (padfGLY[nXSize] + (dfGeoLocPixel-iX) *
-                       (padfGLY[nXSize+1] - padfGLY[nXSize]));
+                    * (adfGLY[2] + (dfGeoLocPixel-iX) *
+                       (adfGLY[3] - adfGLY[2]));
             }
-            else if( iX + 1 < psTransform->nGeoLocXSize &&
+            else if( bHasRight &&
                      (!psTransform->bHasNoData ||
-                        padfGLX[1] != psTransform->dfNoDataX) )
+                        adfGLX[1] != psTransform->dfNoDataX) )
             {
                 padfX[i] =
-                    padfGLX[0] + (dfGeoLocPixel-iX) * (padfGLX[1] - padfGLX[0]);
+                    adfGLX[0] + (dfGeoLocPixel-iX) * (adfGLX[1] - adfGLX[0]);
                 padfY[i] =
-                    padfGLY[0] + (dfGeoLocPixel-iX) * (padfGLY[1] - padfGLY[0]);
+                    adfGLY[0] + (dfGeoLocPixel-iX) * (adfGLY[1] - adfGLY[0]);
             }
-            else if( iY + 1 < psTransform->nGeoLocYSize &&
+            else if( bHasBottom &&
                      (!psTransform->bHasNoData ||
-                        padfGLX[nXSize] != psTransform->dfNoDataX) )
+                        adfGLX[2] != psTransform->dfNoDataX) )
             {
-                padfX[i] = padfGLX[0]
-                    + (dfGeoLocLine -iY) * (padfGLX[nXSize] - padfGLX[0]);
-                padfY[i] = padfGLY[0]
-                    + (dfGeoLocLine -iY) * (padfGLY[nXSize] - padfGLY[0]);
+                padfX[i] = adfGLX[0]
+                    + (dfGeoLocLine -iY) * (adfGLX[2] - adfGLX[0]);
+                padfY[i] = adfGLY[0]
+                    + (dfGeoLocLine -iY) * (adfGLY[2] - adfGLY[0]);
             }
             else
             {
-                padfX[i] = padfGLX[0];
-                padfY[i] = padfGLY[0];
+                padfX[i] = adfGLX[0];
+                padfY[i] = adfGLY[0];
             }
 
             if( psTransform->bSwapXY )
@@ -989,12 +1461,28 @@ int GDALGeoLocTransform( void *pTransformArg,
             const int iBMX = static_cast<int>(dfBMX);
             const int iBMY = static_cast<int>(dfBMY);
 
-            const int iBM = iBMX + iBMY * psTransform->nBackMapWidth;
+            // Values of the backmap at (iBMX, iBMY), (iBMX+1, iBMY),
+            // (iBMX, iBMY+1) and (iBMX+1, iBMY+1), when available.
+            float afBMX[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+            float afBMY[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+            const bool bHasRight = iBMX + 1 < psTransform->nBackMapWidth;
+            const bool bHasBottom = iBMY + 1 < psTransform->nBackMapHeight;
 
             if( iBMX < 0 || iBMY < 0
                 || iBMX >= psTransform->nBackMapWidth
                 || iBMY >= psTransform->nBackMapHeight
-                || psTransform->pafBackMapX[iBM] < 0 )
+                || !GeoLocGetBackMapXY(psTransform, iBMX, iBMY,
+                                       &afBMX[0], &afBMY[0])
+                || afBMX[0] < 0
+                || (bHasRight &&
+                    !GeoLocGetBackMapXY(psTransform, iBMX + 1, iBMY,
+                                        &afBMX[1], &afBMY[1]))
+                || (bHasBottom &&
+                    !GeoLocGetBackMapXY(psTransform, iBMX, iBMY + 1,
+                                        &afBMX[2], &afBMY[2]))
+                || (bHasRight && bHasBottom &&
+                    !GeoLocGetBackMapXY(psTransform, iBMX + 1, iBMY + 1,
+                                        &afBMX[3], &afBMY[3])) )
             {
                 panSuccess[i] = FALSE;
                 padfX[i] = HUGE_VAL;
@@ -1002,53 +1490,38 @@ int GDALGeoLocTransform( void *pTransformArg,
                 continue;
             }
 
-            float* pafBMX = psTransform->pafBackMapX + iBM;
-            float* pafBMY = psTransform->pafBackMapY + iBM;
-
-            if( iBMX + 1 < psTransform->nBackMapWidth &&
-                iBMY + 1 < psTransform->nBackMapHeight &&
-                pafBMX[1] >=0 && pafBMX[psTransform->nBackMapWidth] >= 0 &&
-                pafBMX[psTransform->nBackMapWidth+1] >= 0)
+            if( bHasRight && bHasBottom &&
+                afBMX[1] >=0 && afBMX[2] >= 0 && afBMX[3] >= 0 )
             {
                 padfX[i] =
                     (1-(dfBMY - iBMY))
-                    * (pafBMX[0] + (dfBMX - iBMX) * (pafBMX[1] - pafBMX[0]))
+                    * (afBMX[0] + (dfBMX - iBMX) * (afBMX[1] - afBMX[0]))
                     + (dfBMY - iBMY)
-                    * (pafBMX[psTransform->nBackMapWidth] +
-                       (dfBMX - iBMX) * (pafBMX[psTransform->nBackMapWidth+1] -
-                                         pafBMX[psTransform->nBackMapWidth]));
+                    * (afBMX[2] + (dfBMX - iBMX) * (afBMX[3] - afBMX[2]));
                 padfY[i] =
                     (1-(dfBMY - iBMY))
-                    * (pafBMY[0] + (dfBMX - iBMX) * (pafBMY[1] - pafBMY[0]))
+                    * (afBMY[0] + (dfBMX - iBMX) * (afBMY[1] - afBMY[0]))
                     + (dfBMY - iBMY)
-                    * (pafBMY[psTransform->nBackMapWidth] +
-                       (dfBMX - iBMX) * (pafBMY[psTransform->nBackMapWidth+1] -
-                                         pafBMY[psTransform->nBackMapWidth]));
+                    * (afBMY[2] + (dfBMX - iBMX) * (afBMY[3] - afBMY[2]));
             }
-            else if( iBMX + 1 < psTransform->nBackMapWidth &&
-                     pafBMX[1] >=0)
+            else if( bHasRight && afBMX[1] >=0 )
             {
-                padfX[i] = pafBMX[0] +
-                            (dfBMX - iBMX) * (pafBMX[1] - pafBMX[0]);
-                padfY[i] = pafBMY[0] +
-                            (dfBMX - iBMX) * (pafBMY[1] - pafBMY[0]);
+                padfX[i] = afBMX[0] +
+                            (dfBMX - iBMX) * (afBMX[1] - afBMX[0]);
+                padfY[i] = afBMY[0] +
+                            (dfBMX - iBMX) * (afBMY[1] - afBMY[0]);
             }
-            else if( iBMY + 1 < psTransform->nBackMapHeight &&
-                     pafBMX[psTransform->nBackMapWidth] >= 0 )
+            else if( bHasBottom && afBMX[2] >= 0 )
             {
-                padfX[i] =
-                    pafBMX[0] +
-                    (dfBMY - iBMY) * (pafBMX[psTransform->nBackMapWidth] -
-                                      pafBMX[0]);
-                padfY[i] =
-                    pafBMY[0] +
-                    (dfBMY - iBMY) * (pafBMY[psTransform->nBackMapWidth] -
-                                      pafBMY[0]);
+                padfX[i] = afBMX[0] +
+                            (dfBMY - iBMY) * (afBMX[2] - afBMX[0]);
+                padfY[i] = afBMY[0] +
+                            (dfBMY - iBMY) * (afBMY[2] - afBMY[0]);
             }
             else
             {
-                padfX[i] = pafBMX[0];
-                padfY[i] = pafBMY[0];
+                padfX[i] = afBMX[0];
+                padfY[i] = afBMY[0];
             }
             panSuccess[i] = TRUE;
         }
@@ -37,6 +37,7 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <utility>
@@ -73,6 +74,64 @@ static void GDALGridGetPointBounds( const void* hFeature, CPLRectObj* pBounds )
     pBounds->maxy = dfY;
 }
 
+/************************************************************************/
+/*                       GDALGridSearchEllipse()                        */
+/************************************************************************/
+
+// When a quadtree is available, collect the points whose location may be
+// inside the search ellipse centered on (dfXPoint, dfYPoint), by querying the
+// bounding box of the (possibly rotated) ellipse. The exact ellipse test must
+// still be done by the caller. On success, *ppapsPoints is set to an array
+// to be freed with CPLFree() and *pnCount to its size. Otherwise, that is
+// when there is no quadtree or the ellipse is not bounded, they are left
+// untouched and the caller should scan all the points.
+
+static void GDALGridSearchEllipse( const void* hExtraParamsIn,
+                                   double dfXPoint, double dfYPoint,
+                                   double dfRadius1, double dfRadius2,
+                                   double dfAngle,
+                                   GDALGridPoint*** ppapsPoints,
+                                   GUInt32* pnCount )
+{
+    const GDALGridExtraParameters* psExtraParams =
+        static_cast<const GDALGridExtraParameters *>(hExtraParamsIn);
+    if( psExtraParams == nullptr || psExtraParams->hQuadTree == nullptr )
+        return;
+    // With a null radius, the ellipse test degenerates and matches a whole
+    // strip, or all the points.
+    if( dfRadius1 == 0.0 || dfRadius2 == 0.0 )
+        return;
+
+    // Half sizes of the bounding box of the ellipse rotated by dfAngle.
+    const double dfCos = cos(dfAngle);
+    const double dfSin = sin(dfAngle);
+    const double dfHalfX = sqrt(dfRadius1 * dfRadius1 * dfCos * dfCos +
+                                dfRadius2 * dfRadius2 * dfSin * dfSin);
+    const double dfHalfY = sqrt(dfRadius1 * dfRadius1 * dfSin * dfSin +
+                                dfRadius2 * dfRadius2 * dfCos * dfCos);
+    // Enlarge it a bit so that points lying on the ellipse are not missed
+    // because of rounding errors.
+    const double dfMargin = 1e-9 * (fabs(dfXPoint) + fabs(dfYPoint) +
+                                    dfHalfX + dfHalfY);
+
+    CPLRectObj sAoi;
+    sAoi.minx = dfXPoint - dfHalfX - dfMargin;
+    sAoi.miny = dfYPoint - dfHalfY - dfMargin;
+    sAoi.maxx = dfXPoint + dfHalfX + dfMargin;
+    sAoi.maxy = dfYPoint + dfHalfY + dfMargin;
+    int nFeatureCount = 0;
+    GDALGridPoint** papsPoints = reinterpret_cast<GDALGridPoint **>(
+        CPLQuadTreeSearch(psExtraParams->hQuadTree, &sAoi, &nFeatureCount) );
+
+    // The GDALGridPoint structures are allocated in a single array in point
+    // order, so sorting the pointers restores the order of a full scan, and
+    // thus gives the same results, ties and summation order included.
+    std::sort(papsPoints, papsPoints + nFeatureCount);
+
+    *ppapsPoints = papsPoints;
+    *pnCount = static_cast<GUInt32>(nFeatureCount);
+}
+
 /************************************************************************/
 /*                   GDALGridInverseDistanceToAPower()                  */
 /************************************************************************/
@@ -118,7 +177,7 @@ static void GDALGridGetPointBounds( const void* hFeature, CPLRectObj* pBounds )
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -129,7 +188,7 @@ GDALGridInverseDistanceToAPower( const void *poOptionsIn, GUInt32 nPoints,
                                  const double *padfZ,
                                  double dfXPoint, double dfYPoint,
                                  double *pdfValue,
-                                 CPL_UNUSED void* hExtraParamsIn)
+                                 void* hExtraParamsIn)
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -156,8 +215,15 @@ GDALGridInverseDistanceToAPower( const void *poOptionsIn, GUInt32 nPoints,
     double dfDenominator = 0.0;
     GUInt32 n = 0;
 
-    for( GUInt32 i = 0; i < nPoints; i++ )
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
         const double dfR2 =
@@ -180,6 +246,7 @@ GDALGridInverseDistanceToAPower( const void *poOptionsIn, GUInt32 nPoints,
             if( dfR2 < 0.0000000000001 )
             {
                 *pdfValue = padfZ[i];
+                CPLFree(papsPoints);
                 return CE_None;
             }
 
@@ -192,6 +259,7 @@ GDALGridInverseDistanceToAPower( const void *poOptionsIn, GUInt32 nPoints,
                 break;
         }
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints || dfDenominator == 0.0 )
     {
@@ -533,7 +601,7 @@ GDALGridInverseDistanceToAPowerNoSearch(
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -543,7 +611,7 @@ GDALGridMovingAverage( const void *poOptionsIn, GUInt32 nPoints,
                        const double *padfX, const double *padfY,
                        const double *padfZ,
                        double dfXPoint, double dfYPoint, double *pdfValue,
-                       CPL_UNUSED void * hExtraParamsIn )
+                       void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -566,8 +634,15 @@ GDALGridMovingAverage( const void *poOptionsIn, GUInt32 nPoints,
 
     GUInt32 n = 0;  // Used after for.
 
-    for( GUInt32 i = 0; i < nPoints; i++ )
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -587,6 +662,7 @@ GDALGridMovingAverage( const void *poOptionsIn, GUInt32 nPoints,
             n++;
         }
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints || n == 0 )
     {
@@ -658,7 +734,6 @@ GDALGridNearestNeighbor( const void *poOptionsIn, GUInt32 nPoints,
     // Nearest distance will be initialized with the distance to the first
     // point in array.
     double dfNearestR = std::numeric_limits<double>::max();
-    GUInt32 i = 0;
 
     double dfSearchRadius = psExtraParams->dfInitialSearchRadius;
     if( hQuadTree != nullptr && dfRadius1 == dfRadius2 && dfSearchRadius > 0 )
@@ -710,8 +785,15 @@ GDALGridNearestNeighbor( const void *poOptionsIn, GUInt32 nPoints,
     }
     else
     {
-        while( i < nPoints )
+        GDALGridPoint** papsPoints = nullptr;
+        GUInt32 nCandidates = nPoints;
+        GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                              poOptions->dfRadius1, poOptions->dfRadius2,
+                              dfAngle, &papsPoints, &nCandidates);
+
+        for( GUInt32 k = 0; k < nCandidates; k++ )
         {
+            const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
             double dfRX = padfX[i] - dfXPoint;
             double dfRY = padfY[i] - dfYPoint;
 
@@ -734,9 +816,8 @@ GDALGridNearestNeighbor( const void *poOptionsIn, GUInt32 nPoints,
                     dfNearestValue = padfZ[i];
                 }
             }
-
-            i++;
         }
+        CPLFree(papsPoints);
     }
 
     *pdfValue = dfNearestValue;
@@ -775,7 +856,7 @@ GDALGridNearestNeighbor( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn unused.
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -785,7 +866,7 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
                            const double *padfX, const double *padfY,
                            const double *padfZ,
                            double dfXPoint, double dfYPoint, double *pdfValue,
-                           CPL_UNUSED void * hExtraParamsIn )
+                           void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -805,11 +886,17 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
     double dfMinimumValue=0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -836,9 +923,8 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
             }
             n++;
         }
-
-        i++;
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints || n == 0 )
     {
@@ -883,7 +969,7 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -893,7 +979,7 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
                            const double *padfX, const double *padfY,
                            const double *padfZ,
                            double dfXPoint, double dfYPoint, double *pdfValue,
-                           CPL_UNUSED void* hExtraParamsIn )
+                           void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -913,11 +999,17 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
     double dfMaximumValue=0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -944,9 +1036,8 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
             }
             n++;
         }
-
-        i++;
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints
          || n == 0 )
@@ -993,7 +1084,7 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1003,7 +1094,7 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
                          const double *padfX, const double *padfY,
                          const double *padfZ,
                          double dfXPoint, double dfYPoint, double *pdfValue,
-                         CPL_UNUSED void * hExtraParamsIn )
+                         void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1023,11 +1114,17 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
 
     double dfMaximumValue = 0.0;
     double dfMinimumValue = 0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -1057,9 +1154,8 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
             }
             n++;
         }
-
-        i++;
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints || n == 0 )
     {
@@ -1102,7 +1198,7 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1112,7 +1208,7 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
                          const double *padfX, const double *padfY,
                          CPL_UNUSED const double * padfZ,
                          double dfXPoint, double dfYPoint, double *pdfValue,
-                         CPL_UNUSED void * hExtraParamsIn )
+                         void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1131,11 +1227,17 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff1 = bRotated ? cos(dfAngle) : 0.0;
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -1153,9 +1255,8 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
         {
             n++;
         }
-
-        i++;
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints )
     {
@@ -1202,7 +1303,7 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1213,7 +1314,7 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
                                    CPL_UNUSED const double * padfZ,
                                    double dfXPoint, double dfYPoint,
                                    double *pdfValue,
-                                   CPL_UNUSED void * hExtraParamsIn )
+                                   void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1233,11 +1334,17 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
     double dfAccumulator = 0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -1256,9 +1363,8 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
             dfAccumulator += sqrt( dfRX * dfRX + dfRY * dfRY );
             n++;
         }
-
-        i++;
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints || n == 0 )
     {
@@ -1307,7 +1413,7 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1318,7 +1424,7 @@ GDALGridDataMetricAverageDistancePts( const void *poOptionsIn, GUInt32 nPoints,
                                       CPL_UNUSED const double * padfZ,
                                       double dfXPoint, double dfYPoint,
                                       double *pdfValue,
-                                      CPL_UNUSED void * hExtraParamsIn )
+                                      void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1337,12 +1443,18 @@ GDALGridDataMetricAverageDistancePts( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
     double dfAccumulator = 0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
+    GDALGridPoint** papsPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    GDALGridSearchEllipse(hExtraParamsIn, dfXPoint, dfYPoint,
+                          poOptions->dfRadius1, poOptions->dfRadius2, dfAngle,
+                          &papsPoints, &nCandidates);
+
     // Search for the first point within the search ellipse.
-    while( i < nPoints - 1 )
+    for( GUInt32 k = 0; k + 1 < nCandidates; k++ )
     {
+        const GUInt32 i = papsPoints ? papsPoints[k]->i : k;
         double dfRX1 = padfX[i] - dfXPoint;
         double dfRY1 = padfY[i] - dfYPoint;
 
@@ -1360,8 +1472,9 @@ GDALGridDataMetricAverageDistancePts( const void *poOptionsIn, GUInt32 nPoints,
         {
             // Search all the remaining points within the ellipse and compute
             // distances between them and the first point.
-            for( GUInt32 j = i + 1; j < nPoints; j++ )
+            for( GUInt32 l = k + 1; l < nCandidates; l++ )
             {
+                const GUInt32 j = papsPoints ? papsPoints[l]->i : l;
                 double dfRX2 = padfX[j] - dfXPoint;
                 double dfRY2 = padfY[j] - dfYPoint;
 
@@ -1387,9 +1500,8 @@ GDALGridDataMetricAverageDistancePts( const void *poOptionsIn, GUInt32 nPoints,
                 }
             }
         }
-
-        i++;
     }
+    CPLFree(papsPoints);
 
     if( n < poOptions->nMinPoints || n == 0 )
     {
@@ -1683,11 +1795,22 @@ struct GDALGridContext
     double*             padfZ;
     bool                bFreePadfXYZArrays;
 
-    CPLWorkerThreadPool *poWorkerThreadPool;
+    // Queue of jobs run by the global thread pool, and number of jobs.
+    CPLJobQueue        *poJobQueue;
+    int                 nThreads;
 };
 
 static void GDALGridContextCreateQuadTree( GDALGridContext* psContext );
 
+// Whether a quadtree of the points is worth building for an algorithm using
+// a search ellipse with those radii.
+static bool GDALGridNeedQuadTreeForEllipse( GUInt32 nPoints,
+                                            double dfRadius1,
+                                            double dfRadius2 )
+{
+    return nPoints > 100 && dfRadius1 != 0.0 && dfRadius2 != 0.0;
+}
+
 /**
  * Creates a context to do regular gridding from the scattered data.
  *
@@ -1707,6 +1830,12 @@ static void GDALGridContextCreateQuadTree( GDALGridContext* psContext );
  * instruction set. This can be disabled by setting the GDAL_USE_AVX
  * configuration option to NO.
  *
+ * When there are more than 100 points, the 'invdist' (with a search
+ * ellipse), 'average', 'nearest' and data metrics algorithms index the points
+ * in a quadtree, so that only the points within the bounding box of the
+ * search ellipse of each grid node are examined. The results are the same as
+ * with a full scan of the points.
+ *
  * It is possible to set the GDAL_NUM_THREADS
  * configuration option to parallelize the processing. The value to set is
  * the number of worker threads, or ALL_CPUS to use all the cores/CPUs of the
@@ -1858,6 +1987,8 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             else
             {
                 pfnGDALGridMethod = GDALGridInverseDistanceToAPower;
+                bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                    nPoints, poPower->dfRadius1, poPower->dfRadius2);
             }
             break;
         }
@@ -1881,6 +2012,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
                    sizeof(GDALGridMovingAverageOptions));
 
             pfnGDALGridMethod = GDALGridMovingAverage;
+            bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                nPoints,
+                static_cast<const GDALGridMovingAverageOptions *>(
+                    poOptions)->dfRadius1,
+                static_cast<const GDALGridMovingAverageOptions *>(
+                    poOptions)->dfRadius2);
             break;
         }
         case GGA_NearestNeighbor:
@@ -1890,9 +2027,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
                    sizeof(GDALGridNearestNeighborOptions));
 
             pfnGDALGridMethod = GDALGridNearestNeighbor;
-            bCreateQuadTree = (nPoints > 100 &&
-                static_cast<const GDALGridNearestNeighborOptions *>(poOptions)->dfRadius1 ==
-                static_cast<const GDALGridNearestNeighborOptions *>(poOptions)->dfRadius2);
+            bCreateQuadTree = nPoints > 100;
             break;
         }
         case GGA_MetricMinimum:
@@ -1901,6 +2036,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricMinimum;
+            bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                nPoints,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius1,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius2);
             break;
         }
         case GGA_MetricMaximum:
@@ -1909,6 +2050,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricMaximum;
+            bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                nPoints,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius1,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius2);
             break;
         }
         case GGA_MetricRange:
@@ -1917,6 +2064,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricRange;
+            bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                nPoints,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius1,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius2);
             break;
         }
         case GGA_MetricCount:
@@ -1925,6 +2078,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricCount;
+            bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                nPoints,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius1,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius2);
             break;
         }
         case GGA_MetricAverageDistance:
@@ -1933,6 +2092,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricAverageDistance;
+            bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                nPoints,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius1,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius2);
             break;
         }
         case GGA_MetricAverageDistancePts:
@@ -1941,6 +2106,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricAverageDistancePts;
+            bCreateQuadTree = GDALGridNeedQuadTreeForEllipse(
+                nPoints,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius1,
+                static_cast<const GDALGridDataMetricsOptions *>(
+                    poOptions)->dfRadius2);
             break;
         }
         case GGA_Linear:
@@ -2041,29 +2212,19 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
 /* -------------------------------------------------------------------- */
 /*  Start thread pool.                                                  */
 /* -------------------------------------------------------------------- */
-    const char* pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "ALL_CPUS");
-    int nThreads = 0;
-    if( EQUAL(pszThreads, "ALL_CPUS") )
-        nThreads = CPLGetNumCPUs();
-    else
-        nThreads = atoi(pszThreads);
-    if( nThreads > 128 )
-        nThreads = 128;
+    const int nThreads = CPLGetNumThreads(nullptr, "ALL_CPUS");
+    psContext->poJobQueue = nullptr;
+    psContext->nThreads = 0;
     if( nThreads > 1 )
     {
-        psContext->poWorkerThreadPool = new CPLWorkerThreadPool();
-        if( !psContext->poWorkerThreadPool->Setup(nThreads, nullptr, nullptr) )
-        {
-            delete psContext->poWorkerThreadPool;
-            psContext->poWorkerThreadPool = nullptr;
-        }
-        else
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poPool != nullptr )
         {
+            psContext->poJobQueue = poPool->CreateJobQueue().release();
+            psContext->nThreads = nThreads;
             CPLDebug("GDAL_GRID", "Using %d threads", nThreads);
         }
     }
-    else
-        psContext->poWorkerThreadPool = nullptr;
 
     return psContext;
 }
@@ -2145,7 +2306,7 @@ void GDALGridContextFree( GDALGridContext* psContext )
         VSIFreeAligned(psContext->sExtraParameters.pafZ);
         if( psContext->sExtraParameters.psTriangulation )
             GDALTriangulationFree(psContext->sExtraParameters.psTriangulation);
-        delete psContext->poWorkerThreadPool;
+        delete psContext->poJobQueue;
         CPLFree(psContext);
     }
 }
@@ -2293,7 +2454,7 @@ CPLErr GDALGridContextProcess(
     sJob.hCond = nullptr;
     sJob.hCondMutex = nullptr;
 
-    if( psContext->poWorkerThreadPool == nullptr )
+    if( psContext->poJobQueue == nullptr )
     {
         if( sJob.pfnRealProgress != nullptr &&
             sJob.pfnRealProgress != GDALDummyProgress )
@@ -2305,7 +2466,7 @@ CPLErr GDALGridContextProcess(
     }
     else
     {
-        int nThreads  = psContext->poWorkerThreadPool->GetThreadCount();
+        const int nThreads = psContext->nThreads;
         GDALGridJob* pasJobs = static_cast<GDALGridJob *>(
             CPLMalloc(sizeof(GDALGridJob) * nThreads) );
 
@@ -2321,8 +2482,8 @@ CPLErr GDALGridContextProcess(
         {
             memcpy(&pasJobs[i], &sJob, sizeof(GDALGridJob));
             pasJobs[i].nYStart = i;
-            psContext->poWorkerThreadPool->SubmitJob( GDALGridJobProcess,
-                                                      &pasJobs[i] );
+            psContext->poJobQueue->SubmitJob( GDALGridJobProcess,
+                                              &pasJobs[i] );
         }
 
 /* -------------------------------------------------------------------- */
@@ -2353,7 +2514,7 @@ CPLErr GDALGridContextProcess(
 /* -------------------------------------------------------------------- */
 /*      Wait for all threads to complete and finish.                    */
 /* -------------------------------------------------------------------- */
-        psContext->poWorkerThreadPool->WaitCompletion();
+        psContext->poJobQueue->WaitCompletion();
 
         CPLFree(pasJobs);
         CPLDestroyCond(sJob.hCond);
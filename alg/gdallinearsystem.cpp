@@ -38,19 +38,182 @@
 
 #include "cpl_port.h"
 #include "cpl_conv.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdallinearsystem.h"
 
 #ifdef HAVE_ARMADILLO
 #include "armadillo"
 #endif
 
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 #include <algorithm>
 
 CPL_CVSID("$Id: gdallinearsystem.cpp d6c9bd707d4c2c4ba4390e4d1352d277772ffe8c 2017-12-19 23:54:42Z Alan Thomas $")
 
-static int matrixInvert( int N, const double input[], double output[] );
+namespace {
+
+struct GDALLinearSystemEliminationJob
+{
+    double* padfAug;
+    int     nWidth;
+    int     nPivot;
+    int     nRowStart;
+    int     nRowEnd;
+};
+
+}  // namespace
+
+/************************************************************************/
+/*                    GDALLinearSystemEliminateRows()                   */
+/*                                                                      */
+/*      Subtract the multiple of the pivot row from the rows in         */
+/*      [nRowStart, nRowEnd[ that cancels their nPivot-th column.       */
+/************************************************************************/
+
+static void GDALLinearSystemEliminateRows( void* pData )
+{
+    const GDALLinearSystemEliminationJob* psJob =
+        static_cast<const GDALLinearSystemEliminationJob*>(pData);
+    const int k = psJob->nPivot;
+    const int nWidth = psJob->nWidth;
+    const double* padfPivotRow =
+        psJob->padfAug + static_cast<size_t>(k) * nWidth;
+    for( int row = psJob->nRowStart; row < psJob->nRowEnd; row++ )
+    {
+        double* padfRow = psJob->padfAug + static_cast<size_t>(row) * nWidth;
+        const double dfFactor = padfRow[k] / padfPivotRow[k];
+        if( dfFactor == 0.0 )
+            continue;
+        padfRow[k] = 0.0;
+        for( int col = k + 1; col < nWidth; col++ )
+        {
+            padfRow[col] -= dfFactor * padfPivotRow[col];
+        }
+    }
+}
+
+/************************************************************************/
+/*                      GDALLinearSystemGaussSolve()                    */
+/*                                                                      */
+/*      Gaussian elimination with partial pivoting on the augmented     */
+/*      [adfA | adfRHS] matrix, followed by back substitution.  This    */
+/*      costs about nDim^3/3 multiply-adds, instead of the 3*nDim^3/2   */
+/*      of an explicit inversion followed by a matrix product.  When a  */
+/*      job queue is given, the row updates of each elimination step    */
+/*      are split in nThreads jobs.                                     */
+/************************************************************************/
+
+static bool GDALLinearSystemGaussSolve( const int nDim, const int nRHS,
+                                        const double adfA[],
+                                        const double adfRHS[],
+                                        double adfOut[],
+                                        CPLJobQueue* poJobQueue,
+                                        int nThreads )
+{
+    const int nWidth = nDim + nRHS;
+    double* padfAug = static_cast<double*>(
+        VSI_MALLOC3_VERBOSE(nDim, nWidth, sizeof(double)));
+    if( padfAug == nullptr )
+        return false;
+
+    for( int row = 0; row < nDim; row++ )
+    {
+        double* padfRow = padfAug + static_cast<size_t>(row) * nWidth;
+        memcpy(padfRow, adfA + static_cast<size_t>(row) * nDim,
+               sizeof(double) * nDim);
+        memcpy(padfRow + nDim, adfRHS + static_cast<size_t>(row) * nRHS,
+               sizeof(double) * nRHS);
+    }
+
+    std::vector<GDALLinearSystemEliminationJob> asJobs(nThreads);
+    std::vector<void*> apJobs;
+    apJobs.reserve(nThreads);
+
+    for( int k = 0; k < nDim; k++ )
+    {
+        // Find the pivot and swap the rows.
+        int nMax = k;
+        for( int row = k + 1; row < nDim; row++ )
+        {
+            if( fabs(padfAug[static_cast<size_t>(row) * nWidth + k]) >
+                fabs(padfAug[static_cast<size_t>(nMax) * nWidth + k]) )
+            {
+                nMax = row;
+            }
+        }
+        if( padfAug[static_cast<size_t>(nMax) * nWidth + k] == 0.0 )
+        {
+            // I guess adfA is singular
+            VSIFree(padfAug);
+            return false;
+        }
+        if( nMax != k )
+        {
+            std::swap_ranges(padfAug + static_cast<size_t>(k) * nWidth + k,
+                             padfAug + static_cast<size_t>(k + 1) * nWidth,
+                             padfAug + static_cast<size_t>(nMax) * nWidth + k);
+        }
+
+        const int nRows = nDim - k - 1;
+        // Only worth dispatching when each thread gets a few hundred
+        // thousand multiply-adds.
+        const int nJobs = std::min(nThreads, std::max(1,
+            static_cast<int>(static_cast<double>(nRows) * (nWidth - k) /
+                             (256 * 1024))));
+        if( nJobs <= 1 )
+        {
+            GDALLinearSystemEliminationJob sJob;
+            sJob.padfAug = padfAug;
+            sJob.nWidth = nWidth;
+            sJob.nPivot = k;
+            sJob.nRowStart = k + 1;
+            sJob.nRowEnd = nDim;
+            GDALLinearSystemEliminateRows(&sJob);
+        }
+        else
+        {
+            apJobs.clear();
+            for( int i = 0; i < nJobs; i++ )
+            {
+                asJobs[i].padfAug = padfAug;
+                asJobs[i].nWidth = nWidth;
+                asJobs[i].nPivot = k;
+                asJobs[i].nRowStart = k + 1 +
+                    static_cast<int>(static_cast<GIntBig>(nRows) * i / nJobs);
+                asJobs[i].nRowEnd = k + 1 +
+                    static_cast<int>(
+                        static_cast<GIntBig>(nRows) * (i + 1) / nJobs);
+                apJobs.push_back(&asJobs[i]);
+            }
+            for( void* pJob: apJobs )
+            {
+                if( !poJobQueue->SubmitJob(GDALLinearSystemEliminateRows,
+                                           pJob) )
+                    GDALLinearSystemEliminateRows(pJob);
+            }
+            poJobQueue->WaitCompletion();
+        }
+    }
+
+    // Back substitution.
+    for( int row = nDim - 1; row >= 0; row-- )
+    {
+        const double* padfRow = padfAug + static_cast<size_t>(row) * nWidth;
+        for( int iRHS = 0; iRHS < nRHS; iRHS++ )
+        {
+            double dfSum = padfRow[nDim + iRHS];
+            for( int col = row + 1; col < nDim; col++ )
+                dfSum -= padfRow[col] * adfOut[col * nRHS + iRHS];
+            adfOut[row * nRHS + iRHS] = dfSum / padfRow[row];
+        }
+    }
+
+    VSIFree(padfAug);
+    return true;
+}
 
 /************************************************************************/
 /*                       GDALLinearSystemSolve()                        */
@@ -60,10 +223,13 @@ static int matrixInvert( int N, const double input[], double output[] );
 /*   arrays with the entries in row-major order.                        */
 /*   nDim is the number of rows and columns in adfA, and nRHS is the    */
 /*   number of right-hand sides (columns) in adfRHS.                    */
+/*   nThreads is the number of worker threads that may be used by the   */
+/*   fallback solver when Armadillo is not available.                   */
 /************************************************************************/
 
 bool GDALLinearSystemSolve( const int nDim, const int nRHS,
-    const double adfA[], const double adfRHS[], double adfOut[] )
+    const double adfA[], const double adfRHS[], double adfOut[],
+    int nThreads )
 {
 #ifdef HAVE_ARMADILLO
     try
@@ -101,164 +267,19 @@ bool GDALLinearSystemSolve( const int nDim, const int nRHS,
     catch(...) {}
 
 #endif
-    double* adfAInverse = new double[nDim * nDim];
-
-    if( !matrixInvert( nDim, adfA, adfAInverse ) )
-    {
-        // I guess adfA is singular
-        delete[] adfAInverse;
-        return false;
-    }
-
-    // calculate the coefficients
-    for( int iRHS = 0; iRHS < nRHS; iRHS++ )
-    {
-        for( int iEq = 0; iEq < nDim; iEq++ )
-        {
-            adfOut[iEq * nRHS + iRHS] = 0.0;
-            for( int iVar = 0; iVar < nDim; iVar++ )
-            {
-                adfOut[iEq * nRHS + iRHS] +=
-                    adfAInverse[iEq * nDim + iVar] *
-                    adfRHS[iVar * nRHS + iRHS];
-            }
-        }
-    }
-
-    delete[] adfAInverse;
-    return true;
-}
-
-static int matrixInvert( int N, const double input[], double output[] )
-{
-    // Receives an array of dimension NxN as input.  This is passed as a one-
-    // dimensional array of N-squared size.  It produces the inverse of the
-    // input matrix, returned as output, also of size N-squared.  The Gauss-
-    // Jordan Elimination method is used.  (Adapted from a BASIC routine in
-    // "Basic Scientific Subroutines Vol. 1", courtesy of Scott Edwards.)
-
-    // Array elements 0...N-1 are for the first row, N...2N-1 are for the
-    // second row, etc.
-
-    // We need to have a temporary array of size N x 2N.  We'll refer to the
-    // "left" and "right" halves of this array.
-
-#if DEBUG_VERBOSE
-    fprintf(stderr, "Matrix Inversion input matrix (N=%d)\n", N);/*ok*/
-    for( int row = 0; row < N; row++ )
-    {
-        for( int col = 0; col < N; col++ )
-        {
-            fprintf(stderr, "%5.2f ", input[row*N + col]);/*ok*/
-        }
-        fprintf(stderr, "\n");/*ok*/
-    }
-#endif
-
-    const int tempSize = 2 * N * N;
-    double* temp = new double[tempSize];
-
-    if( temp == nullptr )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "matrixInvert(): ERROR - memory allocation failed.");
-        return false;
-    }
-
-    // First create a double-width matrix with the input array on the left
-    // and the identity matrix on the right.
-
-    for( int row = 0; row < N; row++ )
+    if( nThreads > 1 && nDim > 256 )
     {
-        for( int col = 0; col<N; col++ )
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poPool )
         {
-            // Our index into the temp array is X2 because it's twice as wide
-            // as the input matrix.
-
-            temp[ 2*row*N + col ] = input[ row*N+col ];  // left = input matrix
-            temp[ 2*row*N + col + N ] = 0.0;            // right = 0
+            auto poJobQueue = poPool->CreateJobQueue();
+            return GDALLinearSystemGaussSolve( nDim, nRHS, adfA, adfRHS,
+                                               adfOut, poJobQueue.get(),
+                                               nThreads );
         }
-        temp[ 2*row*N + row + N ] = 1.0;  // 1 on the diagonal of RHS
     }
-
-    // Now perform row-oriented operations to convert the left hand side
-    // of temp to the identity matrix.  The inverse of input will then be
-    // on the right.
-
-    int max = 0;
-    int k = 0;
-    for( k = 0; k < N; k++ )
-    {
-        if( k + 1 < N )  // If not on the last row.
-        {
-            max = k;
-            for( int row = k + 1; row < N; row++ )  // Find the maximum element.
-            {
-                if( fabs( temp[row*2*N + k] ) > fabs( temp[max*2*N + k] ) )
-                {
-                    max = row;
-                }
-            }
-
-            if( max != k )  // Swap all the elements in the two rows.
-            {
-                for( int col = k; col < 2 * N; col++ )
-                {
-                    std::swap(temp[k*2*N + col], temp[max*2*N + col]);
-                }
-            }
-        }
-
-        const double ftemp = temp[k*2*N + k];
-        if( ftemp == 0.0 )  // Matrix cannot be inverted.
-        {
-            delete[] temp;
-            return false;
-        }
-
-        for( int col = k; col < 2 * N; col++ )
-        {
-            temp[k*2*N + col] /= ftemp;
-        }
-
-        const int i2 = k * 2 * N;
-        for( int row = 0; row < N; row++ )
-        {
-            if( row != k )
-            {
-                const int i1 = row * 2 * N;
-                const double ftemp2 = temp[ i1 + k ];
-                for( int col = k; col < 2*N; col++ )
-                {
-                    temp[i1 + col] -= ftemp2 * temp[i2 + col];
-                }
-            }
-        }
-    }
-
-    // Retrieve inverse from the right side of temp.
-    for( int row = 0; row < N; row++ )
-    {
-        for( int col = 0; col < N; col++ )
-        {
-            output[row*N + col] = temp[row*2*N + col + N ];
-        }
-    }
-    delete [] temp;
-
-#if DEBUG_VERBOSE
-    fprintf(stderr, "Matrix Inversion result matrix:\n");/*ok*/
-    for( int row = 0; row < N; row++ )
-    {
-        for( int col = 0; col < N; col++ )
-        {
-            fprintf(stderr, "%5.2f ", output[row*N + col]);/*ok*/
-        }
-        fprintf(stderr, "\n");/*ok*/
-    }
-#endif
-
-    return true;
+    return GDALLinearSystemGaussSolve( nDim, nRHS, adfA, adfRHS, adfOut,
+                                       nullptr, 1 );
 }
 
 /*! @endcond */
@@ -32,7 +32,8 @@
 #define GDALLINEARSYSTEM_H_INCLUDED
 
 bool GDALLinearSystemSolve( const int nDim, const int nRHS,
-    const double adfA[], const double adfRHS[], double adfOut[] );
+    const double adfA[], const double adfRHS[], double adfOut[],
+    int nThreads = 1 );
 
 #endif /* #ifndef GDALLINEARSYSTEM_H_INCLUDED */
 
@@ -39,6 +39,7 @@
 #include <new>
 
 #include "cpl_conv.h"
+#include "cpl_cpu_features.h"
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
 #include "cpl_vsi.h"
@@ -46,6 +47,7 @@
 #include "../frmts/vrt/vrtdataset.h"
 #include "gdal_priv.h"
 #include "gdal_priv_templates.hpp"
+#include "gdalpansharpen_priv.h"
 // #include "gdalsse_priv.h"
 
 // Limit types to practical use cases.
@@ -176,7 +178,7 @@ GDALPansharpenOperation::~GDALPansharpenOperation()
     GDALDestroyPansharpenOptions(psOptions);
     for( size_t i = 0; i < aVDS.size(); i++ )
         delete aVDS[i];
-    delete poThreadPool;
+    delete poJobQueue;
 }
 
 /************************************************************************/
@@ -289,6 +291,13 @@ GDALPansharpenOperation::Initialize( const GDALPansharpenOptions* psOptionsIn )
         psOptions->nBitDepth = 0;
     }
 
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+    bUseAVX = CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX", "YES")) &&
+              CPLHaveRuntimeAVX();
+    if( bUseAVX )
+        CPLDebug("PANSHARPEN", "Using AVX optimized version");
+#endif
+
     // Detect negative weights.
     for( int i = 0; i<psOptions->nInputSpectralBands; i++ )
     {
@@ -366,27 +375,16 @@ GDALPansharpenOperation::Initialize( const GDALPansharpenOptions* psOptionsIn )
     if( nThreads == -1 )
         nThreads = CPLGetNumCPUs();
     else if( nThreads == 0 )
-    {
-        const char* pszNumThreads =
-            CPLGetConfigOption("GDAL_NUM_THREADS", nullptr);
-        if( pszNumThreads )
-        {
-            if( EQUAL(pszNumThreads, "ALL_CPUS") )
-                nThreads = CPLGetNumCPUs();
-            else
-                nThreads = std::max(0, std::min(128, atoi(pszNumThreads)));
-        }
-    }
+        nThreads = CPLGetNumThreads(nullptr, nullptr);
     if( nThreads > 1 )
     {
         CPLDebug("PANSHARPEN", "Using %d threads", nThreads);
-        poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
         // coverity[tainted_data]
-        if( poThreadPool == nullptr ||
-            !poThreadPool->Setup( nThreads, nullptr, nullptr ) )
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poPool )
         {
-            delete poThreadPool;
-            poThreadPool = nullptr;
+            poJobQueue = poPool->CreateJobQueue().release();
+            nThreadCount = nThreads;
         }
     }
 
@@ -520,7 +518,10 @@ void GDALPansharpenOperation::WeightedBrovey3(
         return;
     }
 
-    for( size_t j = 0; j < nValues; j++ )
+    size_t j = WeightedBroveyFloatingPoint(pPanBuffer,
+                                           pUpsampledSpectralBuffer,
+                                           pDataBuf, nValues, nBandValues);
+    for( ; j < nValues; j++ )
     {
         double dfFactor = 0.0;
         // if( pPanBuffer[j] == 0 )
@@ -564,6 +565,14 @@ size_t GDALPansharpenOperation::WeightedBroveyPositiveWeightsInternal(
 {
     CPL_STATIC_ASSERT( NINPUT == 3 || NINPUT == 4 );
     CPL_STATIC_ASSERT( NOUTPUT == 3 || NOUTPUT == 4 );
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+    if( bUseAVX )
+    {
+        return GDALPansharpenWeightedBroveyAVX(
+            pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues,
+            nBandValues, nMaxValue, psOptions->padfWeights, NINPUT, NOUTPUT);
+    }
+#endif
     const XMMReg4Double w0 = XMMReg4Double::Load1ValHighAndLow(psOptions->padfWeights + 0);
     const XMMReg4Double w1 = XMMReg4Double::Load1ValHighAndLow(psOptions->padfWeights + 1);
     const XMMReg4Double w2 = XMMReg4Double::Load1ValHighAndLow(psOptions->padfWeights + 2);
@@ -600,12 +609,19 @@ size_t GDALPansharpenOperation::WeightedBroveyPositiveWeightsInternal(
             XMMReg4Double::NotEquals(pseudoPanchro, zero),
             XMMReg4Double::Load4Val(pPanBuffer + j) / pseudoPanchro );
 
-        val0 = XMMReg4Double::Min(val0 * factor, maxValue);
-        val1 = XMMReg4Double::Min(val1 * factor, maxValue);
-        val2 = XMMReg4Double::Min(val2 * factor, maxValue);
+        val0 *= factor;
+        val1 *= factor;
+        val2 *= factor;
         if( NOUTPUT == 4 )
+            val3 *= factor;
+        // Floating-point values are not clamped, as in WeightedBrovey3().
+        if( std::numeric_limits<T>::is_integer )
         {
-            val3 = XMMReg4Double::Min(val3 * factor, maxValue);
+            val0 = XMMReg4Double::Min(val0, maxValue);
+            val1 = XMMReg4Double::Min(val1, maxValue);
+            val2 = XMMReg4Double::Min(val2, maxValue);
+            if( NOUTPUT == 4 )
+                val3 = XMMReg4Double::Min(val3, maxValue);
         }
         val0.Store4Val(pDataBuf + 0 * nBandValues + j);
         val1.Store4Val(pDataBuf + 1 * nBandValues + j);
@@ -687,8 +703,14 @@ size_t GDALPansharpenOperation::WeightedBroveyPositiveWeightsInternal(
 }
 #endif
 
+/************************************************************************/
+/*                      WeightedBroveyFastPath()                        */
+/************************************************************************/
+
+// Dispatches to the unrolled kernels for the band layouts they handle.
+// Returns the number of values processed, 0 if the layout is not handled.
 template <class T>
-void GDALPansharpenOperation::WeightedBroveyPositiveWeights(
+size_t GDALPansharpenOperation::WeightedBroveyFastPath(
     const T* pPanBuffer,
     const T* pUpsampledSpectralBuffer,
     T* pDataBuf,
@@ -696,51 +718,111 @@ void GDALPansharpenOperation::WeightedBroveyPositiveWeights(
     size_t nBandValues,
     T nMaxValue) const
 {
-    if( psOptions->bHasNoData )
-    {
-        WeightedBroveyWithNoData<T, T>
-                                (pPanBuffer, pUpsampledSpectralBuffer,
-                                 pDataBuf, nValues, nBandValues, nMaxValue);
-        return;
-    }
-
-    if( nMaxValue == 0 )
-        nMaxValue = std::numeric_limits<T>::max();
-    size_t j;
     if( psOptions->nInputSpectralBands == 3 &&
         psOptions->nOutPansharpenedBands == 3 &&
         psOptions->panOutPansharpenedBands[0] == 0 &&
         psOptions->panOutPansharpenedBands[1] == 1 &&
         psOptions->panOutPansharpenedBands[2] == 2 )
     {
-        j = WeightedBroveyPositiveWeightsInternal<T, 3, 3>(
+        return WeightedBroveyPositiveWeightsInternal<T, 3, 3>(
             pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues,
             nBandValues, nMaxValue);
     }
-    else if( psOptions->nInputSpectralBands == 4 &&
+    if( psOptions->nInputSpectralBands == 4 &&
         psOptions->nOutPansharpenedBands == 4 &&
         psOptions->panOutPansharpenedBands[0] == 0 &&
         psOptions->panOutPansharpenedBands[1] == 1 &&
         psOptions->panOutPansharpenedBands[2] == 2 &&
         psOptions->panOutPansharpenedBands[3] == 3 )
     {
-        j = WeightedBroveyPositiveWeightsInternal<T, 4, 4>(
+        return WeightedBroveyPositiveWeightsInternal<T, 4, 4>(
             pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues,
             nBandValues, nMaxValue);
     }
-    else if( psOptions->nInputSpectralBands == 4 &&
+    if( psOptions->nInputSpectralBands == 4 &&
         psOptions->nOutPansharpenedBands == 3 &&
         psOptions->panOutPansharpenedBands[0] == 0 &&
         psOptions->panOutPansharpenedBands[1] == 1 &&
         psOptions->panOutPansharpenedBands[2] == 2 )
     {
-        j = WeightedBroveyPositiveWeightsInternal<T, 4, 3>(
+        return WeightedBroveyPositiveWeightsInternal<T, 4, 3>(
             pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues,
             nBandValues, nMaxValue);
     }
-    else
+    return 0;
+}
+
+/************************************************************************/
+/*                    WeightedBroveyFloatingPoint()                     */
+/************************************************************************/
+
+// Vectorized path of WeightedBrovey3() for Float32 and Float64 data written
+// in the working data type. The weights may be negative since the values are
+// neither clamped nor rounded. Returns the number of values processed.
+template<class WorkDataType, class OutDataType>
+size_t GDALPansharpenOperation::WeightedBroveyFloatingPoint(
+    const WorkDataType* /* pPanBuffer */,
+    const WorkDataType* /* pUpsampledSpectralBuffer */,
+    OutDataType* /* pDataBuf */,
+    size_t /* nValues */,
+    size_t /* nBandValues */) const
+{
+    return 0;
+}
+
+#if defined(__x86_64) || defined(_M_X64)
+
+template<>
+size_t GDALPansharpenOperation::WeightedBroveyFloatingPoint<float, float>(
+    const float* pPanBuffer,
+    const float* pUpsampledSpectralBuffer,
+    float* pDataBuf,
+    size_t nValues,
+    size_t nBandValues) const
+{
+    return WeightedBroveyFastPath(pPanBuffer, pUpsampledSpectralBuffer,
+                                  pDataBuf, nValues, nBandValues, 0.0f);
+}
+
+template<>
+size_t GDALPansharpenOperation::WeightedBroveyFloatingPoint<double, double>(
+    const double* pPanBuffer,
+    const double* pUpsampledSpectralBuffer,
+    double* pDataBuf,
+    size_t nValues,
+    size_t nBandValues) const
+{
+    return WeightedBroveyFastPath(pPanBuffer, pUpsampledSpectralBuffer,
+                                  pDataBuf, nValues, nBandValues, 0.0);
+}
+
+#endif
+
+template <class T>
+void GDALPansharpenOperation::WeightedBroveyPositiveWeights(
+    const T* pPanBuffer,
+    const T* pUpsampledSpectralBuffer,
+    T* pDataBuf,
+    size_t nValues,
+    size_t nBandValues,
+    T nMaxValue) const
+{
+    if( psOptions->bHasNoData )
+    {
+        WeightedBroveyWithNoData<T, T>
+                                (pPanBuffer, pUpsampledSpectralBuffer,
+                                 pDataBuf, nValues, nBandValues, nMaxValue);
+        return;
+    }
+
+    if( nMaxValue == 0 )
+        nMaxValue = std::numeric_limits<T>::max();
+    size_t j = WeightedBroveyFastPath(pPanBuffer, pUpsampledSpectralBuffer,
+                                      pDataBuf, nValues, nBandValues,
+                                      nMaxValue);
+    if( j == 0 )
     {
-        for( j = 0; j + 1 < nValues; j += 2 )
+        for( ; j + 1 < nValues; j += 2 )
         {
             double dfFactor = 0.0;
             double dfFactor2 = 0.0;
@@ -1014,6 +1096,61 @@ static void ClampValues( T* panBuffer, size_t nValues, T nMaxVal )
     }
 }
 
+/************************************************************************/
+/*                       ClampUpsampledValues()                         */
+/************************************************************************/
+
+static void ClampUpsampledValues( GByte* pabyBuffer,
+                                  GDALDataType eWorkDataType,
+                                  size_t nValues, int nBitDepth )
+{
+    if( eWorkDataType == GDT_Byte )
+    {
+        ClampValues(pabyBuffer, nValues,
+                    static_cast<GByte>((1 << nBitDepth)-1));
+    }
+    else if( eWorkDataType == GDT_UInt16 )
+    {
+        ClampValues(reinterpret_cast<GUInt16*>(pabyBuffer), nValues,
+                    static_cast<GUInt16>((1 << nBitDepth)-1));
+    }
+#ifndef LIMIT_TYPES
+    else if( eWorkDataType == GDT_UInt32 )
+    {
+        ClampValues(reinterpret_cast<GUInt32*>(pabyBuffer), nValues,
+                    (static_cast<GUInt32>((1 << nBitDepth)-1)));
+    }
+#endif
+}
+
+/************************************************************************/
+/*                     PanchroReadJobThreadFunc()                       */
+/************************************************************************/
+
+namespace {
+struct GDALPansharpenPanchroReadJob
+{
+    GDALRasterBand* poPanchroBand;
+    int             nXOff;
+    int             nYOff;
+    int             nXSize;
+    int             nYSize;
+    void           *pBuffer;
+    GDALDataType    eDT;
+    CPLErr          eErr;
+};
+} // namespace
+
+static void PanchroReadJobThreadFunc( void* pUserData )
+{
+    GDALPansharpenPanchroReadJob* psJob =
+        static_cast<GDALPansharpenPanchroReadJob*>(pUserData);
+    psJob->eErr = psJob->poPanchroBand->RasterIO(GF_Read,
+                psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+                psJob->pBuffer, psJob->nXSize, psJob->nYSize,
+                psJob->eDT, 0, 0, nullptr);
+}
+
 /************************************************************************/
 /*                         ProcessRegion()                              */
 /************************************************************************/
@@ -1071,25 +1208,71 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
         return CE_Failure;
     }
 
-    CPLErr eErr =
-        poPanchroBand->RasterIO(GF_Read,
-                nXOff, nYOff, nXSize, nYSize, pPanBuffer, nXSize, nYSize,
-                eWorkDataType, 0, 0, nullptr);
-    if( eErr != CE_None )
-    {
-        VSIFree(pUpsampledSpectralBuffer);
-        VSIFree(pPanBuffer);
-        return CE_Failure;
-    }
-
     int nTasks = 0;
-    if( poThreadPool )
+    if( poJobQueue )
     {
-        nTasks = poThreadPool->GetThreadCount();
+        nTasks = nThreadCount;
         if( nTasks > nYSize )
             nTasks = nYSize;
     }
 
+    // When the panchromatic band does not belong to a dataset from which
+    // spectral bands are read, read it in a worker thread while the
+    // spectral bands are read.
+    bool bReadPanchroInThread =
+        nTasks > 1 && poPanchroBand->GetDataset() != nullptr;
+    for( int i = 0; bReadPanchroInThread &&
+                    i < psOptions->nInputSpectralBands; i++ )
+    {
+        GDALDataset* poPanchroDS = poPanchroBand->GetDataset();
+        if( aMSBands[i]->GetDataset() == poPanchroDS ||
+            GDALRasterBand::FromHandle(
+                psOptions->pahInputSpectralBands[i])->GetDataset() ==
+                                                                poPanchroDS )
+        {
+            bReadPanchroInThread = false;
+        }
+    }
+
+    GDALPansharpenPanchroReadJob sPanchroJob;
+    sPanchroJob.poPanchroBand = poPanchroBand;
+    sPanchroJob.nXOff = nXOff;
+    sPanchroJob.nYOff = nYOff;
+    sPanchroJob.nXSize = nXSize;
+    sPanchroJob.nYSize = nYSize;
+    sPanchroJob.pBuffer = pPanBuffer;
+    sPanchroJob.eDT = eWorkDataType;
+    sPanchroJob.eErr = CE_None;
+
+    CPLErr eErr = CE_None;
+    if( bReadPanchroInThread )
+    {
+        bReadPanchroInThread =
+            poJobQueue->SubmitJob(PanchroReadJobThreadFunc, &sPanchroJob);
+    }
+    if( !bReadPanchroInThread )
+    {
+        PanchroReadJobThreadFunc(&sPanchroJob);
+        if( sPanchroJob.eErr != CE_None )
+        {
+            VSIFree(pUpsampledSpectralBuffer);
+            VSIFree(pPanBuffer);
+            return CE_Failure;
+        }
+    }
+
+    // Must be called before any early return, and before the panchromatic
+    // buffer is used.
+    const auto WaitPanchroRead = [this, &bReadPanchroInThread, &sPanchroJob]()
+    {
+        if( bReadPanchroInThread )
+        {
+            poJobQueue->WaitCompletion();
+            bReadPanchroInThread = false;
+        }
+        return sPanchroJob.eErr;
+    };
+
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
     const GDALRIOResampleAlg eResampleAlg = psOptions->eResampleAlg;
@@ -1118,6 +1301,88 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
     if( nSpectralYSize == 0 )
         nSpectralYSize = 1;
 
+    // In case NBITS was not set on the spectral bands, clamp the values
+    // if overshoot might have occurred.
+    int nBitDepth = psOptions->nBitDepth;
+    std::vector<int> anBandsToClamp;
+    if( nBitDepth && (eResampleAlg == GRIORA_Cubic ||
+                      eResampleAlg == GRIORA_CubicSpline ||
+                      eResampleAlg == GRIORA_Lanczos) )
+    {
+        for( int i = 0; i < psOptions->nInputSpectralBands; i++ )
+        {
+            GDALRasterBand* poBand = aMSBands[i];
+            int nBandBitDepth = 0;
+            const char* pszNBITS =
+                poBand->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+            if( pszNBITS )
+                nBandBitDepth = atoi(pszNBITS);
+            if( nBandBitDepth < nBitDepth )
+                anBandsToClamp.push_back(i);
+        }
+    }
+
+    GUInt32 nMaxValue = (1 << nBitDepth) - 1;
+
+    double* padfTempBuffer = nullptr;
+    GDALDataType eBufDataTypeOri = eBufDataType;
+    void* pDataBufOri = pDataBuf;
+    // CFloat64 is the query type used by gdallocationinfo...
+#ifdef LIMIT_TYPES
+    if( eBufDataType != GDT_Byte && eBufDataType != GDT_UInt16 )
+#else
+    if( eBufDataType == GDT_CFloat64 )
+#endif
+    {
+        padfTempBuffer = static_cast<double * >(
+            VSI_MALLOC3_VERBOSE(
+                nXSize, nYSize,
+                psOptions->nOutPansharpenedBands * sizeof(double)));
+        if( padfTempBuffer == nullptr )
+        {
+            CPL_IGNORE_RET_VAL(WaitPanchroRead());
+            VSIFree(pUpsampledSpectralBuffer);
+            VSIFree(pPanBuffer);
+            return CE_Failure;
+        }
+        pDataBuf = padfTempBuffer;
+        eBufDataType = GDT_Float64;
+    }
+
+    std::vector<GDALPansharpenJob> asJobs;
+    if( nTasks > 1 )
+    {
+        asJobs.resize( nTasks );
+        for( int i=0;i<nTasks;i++)
+        {
+            const size_t iStartLine =
+                (static_cast<size_t>(i) * nYSize) / nTasks;
+            const size_t iNextStartLine =
+                (static_cast<size_t>(i + 1) * nYSize) / nTasks;
+            asJobs[i].poPansharpenOperation = this;
+            asJobs[i].eWorkDataType = eWorkDataType;
+            asJobs[i].eBufDataType = eBufDataType;
+            asJobs[i].pPanBuffer =
+                pPanBuffer + iStartLine *  nXSize * nDataTypeSize;
+            asJobs[i].pUpsampledSpectralBuffer =
+                pUpsampledSpectralBuffer +
+                iStartLine * nXSize * nDataTypeSize;
+            asJobs[i].pDataBuf =
+                static_cast<GByte*>(pDataBuf) +
+                iStartLine * nXSize *
+                GDALGetDataTypeSizeBytes(eBufDataType);
+            asJobs[i].nValues =
+                (iNextStartLine - iStartLine) * nXSize;
+            asJobs[i].nBandValues = static_cast<size_t>(nXSize) * nYSize;
+            asJobs[i].nMaxValue = nMaxValue;
+            asJobs[i].eErr = CE_None;
+        }
+    }
+
+    // Whether the pansharpening has been done by the resampling jobs, on
+    // the lines each of them has just upsampled.
+    bool bPansharpenedInResampleJobs = false;
+
     // When upsampling, extract the multispectral data at
     // full resolution in a temp buffer, and then do the upsampling.
     if( nSpectralXSize < nXSize && nSpectralYSize < nYSize &&
@@ -1150,6 +1415,8 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                 psOptions->nInputSpectralBands * nDataTypeSize));
         if( pSpectralBuffer == nullptr )
         {
+            CPL_IGNORE_RET_VAL(WaitPanchroRead());
+            VSIFree(padfTempBuffer);
             VSIFree(pUpsampledSpectralBuffer);
             VSIFree(pPanBuffer);
             return CE_Failure;
@@ -1185,9 +1452,12 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                     eWorkDataType, 0, 0, nullptr);
             }
         }
+        if( WaitPanchroRead() != CE_None )
+            eErr = CE_Failure;
         if( eErr != CE_None )
         {
             VSIFree(pSpectralBuffer);
+            VSIFree(padfTempBuffer);
             VSIFree(pUpsampledSpectralBuffer);
             VSIFree(pPanBuffer);
             return CE_Failure;
@@ -1269,9 +1539,11 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                 }
             }
 
-            std::vector<GDALPansharpenResampleJob> asJobs;
-            asJobs.resize( nTasks );
-            GDALPansharpenResampleJob* pasJobs = &(asJobs[0]);
+            // Each job pansharpens the lines it has upsampled, while they
+            // are still in the cache of its core.
+            std::vector<GDALPansharpenResampleJob> asResampleJobs;
+            asResampleJobs.resize( nTasks );
+            GDALPansharpenResampleJob* pasJobs = &(asResampleJobs[0]);
             {
                 std::vector<void*> ahJobData;
                 ahJobData.resize( nTasks );
@@ -1327,6 +1599,12 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                     pasJobs[i].nBandCount = psOptions->nInputSpectralBands;
                     pasJobs[i].nBandSpace =
                         static_cast<GSpacing>(nXSize) * nYSize * nDataTypeSize;
+                    pasJobs[i].nBitDepth = nBitDepth;
+                    pasJobs[i].nBandsToClamp =
+                        static_cast<int>(anBandsToClamp.size());
+                    pasJobs[i].panBandsToClamp =
+                        anBandsToClamp.empty() ? nullptr : &anBandsToClamp[0];
+                    pasJobs[i].psPansharpenJob = &(asJobs[i]);
 #ifdef DEBUG_TIMING
                     pasJobs[i].ptv = &tv;
 #endif
@@ -1335,10 +1613,15 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
 #ifdef DEBUG_TIMING
                 gettimeofday(&tv, nullptr);
 #endif
-                poThreadPool->SubmitJobs(PansharpenResampleJobThreadFunc,
-                                         ahJobData);
-                poThreadPool->WaitCompletion();
+                for( void* pJobData: ahJobData )
+                {
+                    if( !poJobQueue->SubmitJob(
+                            PansharpenResampleJobThreadFunc, pJobData) )
+                        PansharpenResampleJobThreadFunc(pJobData);
+                }
+                poJobQueue->WaitCompletion();
             }
+            bPansharpenedInResampleJobs = true;
         }
 
         GDALClose(poMEMDS);
@@ -1376,86 +1659,32 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                     eWorkDataType, 0, 0, &sExtraArg);
             }
         }
+        if( WaitPanchroRead() != CE_None )
+            eErr = CE_Failure;
         if( eErr != CE_None )
         {
+            VSIFree(padfTempBuffer);
             VSIFree(pUpsampledSpectralBuffer);
             VSIFree(pPanBuffer);
             return CE_Failure;
         }
     }
 
-    // In case NBITS was not set on the spectral bands, clamp the values
-    // if overshoot might have occurred.
-    int nBitDepth = psOptions->nBitDepth;
-    if( nBitDepth && (eResampleAlg == GRIORA_Cubic ||
-                      eResampleAlg == GRIORA_CubicSpline ||
-                      eResampleAlg == GRIORA_Lanczos) )
+    if( bPansharpenedInResampleJobs )
     {
-        for( int i = 0; i < psOptions->nInputSpectralBands; i++ )
-        {
-            GDALRasterBand* poBand = aMSBands[i];
-            int nBandBitDepth = 0;
-            const char* pszNBITS =
-                poBand->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
-            if( pszNBITS )
-                nBandBitDepth = atoi(pszNBITS);
-            if( nBandBitDepth < nBitDepth )
-            {
-                if( eWorkDataType == GDT_Byte )
-                {
-                    ClampValues(reinterpret_cast<GByte*>(pUpsampledSpectralBuffer) + static_cast<size_t>(i) * nXSize * nYSize,
-                               static_cast<size_t>(nXSize)*nYSize,
-                               static_cast<GByte>((1 << nBitDepth)-1));
-                }
-                else if( eWorkDataType == GDT_UInt16 )
-                {
-                    ClampValues(reinterpret_cast<GUInt16*>(pUpsampledSpectralBuffer) + static_cast<size_t>(i) * nXSize * nYSize,
-                               static_cast<size_t>(nXSize)*nYSize,
-                               static_cast<GUInt16>((1 << nBitDepth)-1));
-                }
-#ifndef LIMIT_TYPES
-                else if( eWorkDataType == GDT_UInt32 )
-                {
-                    ClampValues(reinterpret_cast<GUInt32*>(pUpsampledSpectralBuffer) +
-                                static_cast<size_t>(i) * nXSize * nYSize,
-                                static_cast<size_t>(nXSize)*nYSize,
-                                (static_cast<GUInt32>((1 << nBitDepth)-1));
-                }
-#endif
-            }
-        }
+        // Already done.
     }
-
-    GUInt32 nMaxValue = (1 << nBitDepth) - 1;
-
-    double* padfTempBuffer = nullptr;
-    GDALDataType eBufDataTypeOri = eBufDataType;
-    void* pDataBufOri = pDataBuf;
-    // CFloat64 is the query type used by gdallocationinfo...
-#ifdef LIMIT_TYPES
-    if( eBufDataType != GDT_Byte && eBufDataType != GDT_UInt16 )
-#else
-    if( eBufDataType == GDT_CFloat64 )
-#endif
+    else if( nTasks > 1 )
     {
-        padfTempBuffer = static_cast<double * >(
-            VSI_MALLOC3_VERBOSE(
-                nXSize, nYSize,
-                psOptions->nOutPansharpenedBands * sizeof(double)));
-        if( padfTempBuffer == nullptr )
+        const size_t nBandValues = static_cast<size_t>(nXSize) * nYSize;
+        for( size_t i = 0; i < anBandsToClamp.size(); i++ )
         {
-            VSIFree(pUpsampledSpectralBuffer);
-            VSIFree(pPanBuffer);
-            return CE_Failure;
+            ClampUpsampledValues(
+                pUpsampledSpectralBuffer +
+                anBandsToClamp[i] * nBandValues * nDataTypeSize,
+                eWorkDataType, nBandValues, nBitDepth);
         }
-        pDataBuf = padfTempBuffer;
-        eBufDataType = GDT_Float64;
-    }
 
-    if( nTasks > 1 )
-    {
-        std::vector<GDALPansharpenJob> asJobs;
-        asJobs.resize( nTasks );
         GDALPansharpenJob* pasJobs = &(asJobs[0]);
         {
             std::vector<void*> ahJobData;
@@ -1465,26 +1694,6 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
 #endif
             for( int i=0;i<nTasks;i++)
             {
-                const size_t iStartLine =
-                    (static_cast<size_t>(i) * nYSize) / nTasks;
-                const size_t iNextStartLine =
-                    (static_cast<size_t>(i + 1) * nYSize) / nTasks;
-                pasJobs[i].poPansharpenOperation = this;
-                pasJobs[i].eWorkDataType = eWorkDataType;
-                pasJobs[i].eBufDataType = eBufDataType;
-                pasJobs[i].pPanBuffer =
-                    pPanBuffer + iStartLine *  nXSize * nDataTypeSize;
-                pasJobs[i].pUpsampledSpectralBuffer =
-                    pUpsampledSpectralBuffer +
-                    iStartLine * nXSize * nDataTypeSize;
-                pasJobs[i].pDataBuf =
-                    static_cast<GByte*>(pDataBuf) +
-                    iStartLine * nXSize *
-                    GDALGetDataTypeSizeBytes(eBufDataType);
-                pasJobs[i].nValues =
-                    (iNextStartLine - iStartLine) * nXSize;
-                pasJobs[i].nBandValues = static_cast<size_t>(nXSize) * nYSize;
-                pasJobs[i].nMaxValue = nMaxValue;
 #ifdef DEBUG_TIMING
                 pasJobs[i].ptv = &tv;
 #endif
@@ -1493,28 +1702,40 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
 #ifdef DEBUG_TIMING
             gettimeofday(&tv, nullptr);
 #endif
-            poThreadPool->SubmitJobs(PansharpenJobThreadFunc, ahJobData);
-            poThreadPool->WaitCompletion();
-        }
-
-        eErr = CE_None;
-        for( int i=0;i<nTasks;i++)
-        {
-            if( pasJobs[i].eErr != CE_None )
-                eErr = CE_Failure;
+            for( void* pJobData: ahJobData )
+            {
+                if( !poJobQueue->SubmitJob(PansharpenJobThreadFunc, pJobData) )
+                    PansharpenJobThreadFunc(pJobData);
+            }
+            poJobQueue->WaitCompletion();
         }
     }
     else
     {
+        const size_t nBandValues = static_cast<size_t>(nXSize) * nYSize;
+        for( size_t i = 0; i < anBandsToClamp.size(); i++ )
+        {
+            ClampUpsampledValues(
+                pUpsampledSpectralBuffer +
+                anBandsToClamp[i] * nBandValues * nDataTypeSize,
+                eWorkDataType, nBandValues, nBitDepth);
+        }
+
         eErr = PansharpenChunk( eWorkDataType, eBufDataType,
                                 pPanBuffer,
                                 pUpsampledSpectralBuffer,
                                 pDataBuf,
-                                static_cast<size_t>(nXSize) * nYSize,
-                                static_cast<size_t>(nXSize) * nYSize,
+                                nBandValues,
+                                nBandValues,
                                 nMaxValue);
     }
 
+    for( size_t i = 0; i < asJobs.size(); i++ )
+    {
+        if( asJobs[i].eErr != CE_None )
+            eErr = CE_Failure;
+    }
+
     if( padfTempBuffer )
     {
         GDALCopyWords64(padfTempBuffer, GDT_Float64, sizeof(double),
@@ -1577,6 +1798,31 @@ void GDALPansharpenOperation::PansharpenResampleJobThreadFunc(void* pUserData)
                              nullptr,
                              0, 0, psJob->nBandSpace,
                              &sExtraArg));
+
+    for( int i = 0; i < psJob->nBandsToClamp; i++ )
+    {
+        ClampUpsampledValues(
+            static_cast<GByte*>(psJob->pBuffer) +
+            psJob->panBandsToClamp[i] * psJob->nBandSpace,
+            psJob->eDT,
+            static_cast<size_t>(psJob->nBufXSize) * psJob->nBufYSize,
+            psJob->nBitDepth);
+    }
+
+    if( psJob->psPansharpenJob )
+    {
+        GDALPansharpenJob* psPansharpenJob = psJob->psPansharpenJob;
+        psPansharpenJob->eErr =
+            psPansharpenJob->poPansharpenOperation->PansharpenChunk(
+                psPansharpenJob->eWorkDataType,
+                psPansharpenJob->eBufDataType,
+                psPansharpenJob->pPanBuffer,
+                psPansharpenJob->pUpsampledSpectralBuffer,
+                psPansharpenJob->pDataBuf,
+                psPansharpenJob->nValues,
+                psPansharpenJob->nBandValues,
+                psPansharpenJob->nMaxValue);
+    }
 #endif
 
 #ifdef DEBUG_TIMING
@@ -176,6 +176,10 @@ typedef struct
     int          nBandCount;
     GDALRIOResampleAlg eResampleAlg;
     GSpacing     nBandSpace;
+    int          nBitDepth;
+    int          nBandsToClamp;
+    const int   *panBandsToClamp;
+    GDALPansharpenJob* psPansharpenJob;
 
 #ifdef DEBUG_TIMING
     struct timeval* ptv;
@@ -194,7 +198,9 @@ class GDALPansharpenOperation
         std::vector<GDALDataset*> aVDS{}; // to destroy
         std::vector<GDALRasterBand*> aMSBands{}; // original multispectral bands potentially warped into a VRT
         int bPositiveWeights = TRUE;
-        CPLWorkerThreadPool* poThreadPool = nullptr;
+        bool bUseAVX = false;
+        CPLJobQueue* poJobQueue = nullptr; // in the global worker thread pool
+        int nThreadCount = 0;
         int nKernelRadius = 0;
 
         static void PansharpenJobThreadFunc(void* pUserData);
@@ -248,6 +254,21 @@ class GDALPansharpenOperation
                                                      size_t nBandValues,
                                                      T nMaxValue) const;
 
+        template<class T> size_t WeightedBroveyFastPath(
+                                                     const T* pPanBuffer,
+                                                     const T* pUpsampledSpectralBuffer,
+                                                     T* pDataBuf,
+                                                     size_t nValues,
+                                                     size_t nBandValues,
+                                                     T nMaxValue) const;
+
+        template<class WorkDataType, class OutDataType> size_t WeightedBroveyFloatingPoint(
+                                                     const WorkDataType* pPanBuffer,
+                                                     const WorkDataType* pUpsampledSpectralBuffer,
+                                                     OutDataType* pDataBuf,
+                                                     size_t nValues,
+                                                     size_t nBandValues) const;
+
         template<class T, int NINPUT, int NOUTPUT> size_t WeightedBroveyPositiveWeightsInternal(
                                                      const T* pPanBuffer,
                                                      const T* pUpsampledSpectralBuffer,
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Pansharpening module
+ * Purpose:  Prototypes of the pansharpening kernels compiled with specific
+ *           instruction sets.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef GDALPANSHARPEN_PRIV_H_INCLUDED
+#define GDALPANSHARPEN_PRIV_H_INCLUDED
+
+#include "cpl_port.h"
+
+#include <cstddef>
+
+//! @cond Doxygen_Suppress
+
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+
+// Weighted Brovey kernels for the 3->3, 4->4 and 4->3 band layouts where the
+// output bands are the first input bands, without nodata. They return the
+// number of values processed, the remaining values being left to the caller.
+// Integer variants clamp to nMaxValue and round, and require positive weights.
+// Floating-point variants ignore nMaxValue.
+size_t GDALPansharpenWeightedBroveyAVX( const GByte* pPanBuffer,
+                                        const GByte* pUpsampledSpectralBuffer,
+                                        GByte* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        GByte nMaxValue,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands );
+size_t GDALPansharpenWeightedBroveyAVX( const GUInt16* pPanBuffer,
+                                        const GUInt16* pUpsampledSpectralBuffer,
+                                        GUInt16* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        GUInt16 nMaxValue,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands );
+size_t GDALPansharpenWeightedBroveyAVX( const float* pPanBuffer,
+                                        const float* pUpsampledSpectralBuffer,
+                                        float* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        float /* nMaxValue */,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands );
+size_t GDALPansharpenWeightedBroveyAVX( const double* pPanBuffer,
+                                        const double* pUpsampledSpectralBuffer,
+                                        double* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        double /* nMaxValue */,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands );
+
+#endif
+
+//! @endcond
+
+#endif // GDALPANSHARPEN_PRIV_H_INCLUDED
@@ -0,0 +1,240 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Pansharpening module
+ * Purpose:  AVX implementation of the weighted Brovey kernels.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdalpansharpen_priv.h"
+
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+#include <immintrin.h>
+
+#include <cstring>
+
+CPL_CVSID("$Id$")
+
+// The kernels below use raw intrinsics rather than XMMReg4Double, whose
+// inline methods would otherwise be emitted with AVX instructions and could
+// be picked by the linker for the SSE2 code of gdalpansharpen.cpp.
+
+/************************************************************************/
+/*                  Load4ValAVX() / Store4ValAVX()                      */
+/************************************************************************/
+
+static inline __m256d Load4ValAVX( const GByte* ptr )
+{
+    GInt32 i;
+    memcpy(&i, ptr, 4);
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(i)));
+}
+
+static inline __m256d Load4ValAVX( const GUInt16* ptr )
+{
+    return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr))));
+}
+
+static inline __m256d Load4ValAVX( const float* ptr )
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(ptr));
+}
+
+static inline __m256d Load4ValAVX( const double* ptr )
+{
+    return _mm256_loadu_pd(ptr);
+}
+
+// Values are known to be in [0, max] range, so adding 0.5 and truncating
+// rounds to the nearest integer.
+static inline void Store4ValAVX( __m256d val, GByte* ptr )
+{
+    __m128i i = _mm256_cvttpd_epi32(_mm256_add_pd(val, _mm256_set1_pd(0.5)));
+    i = _mm_packus_epi16(_mm_packus_epi32(i, i), i);
+    const GInt32 n = _mm_cvtsi128_si32(i);
+    memcpy(ptr, &n, 4);
+}
+
+static inline void Store4ValAVX( __m256d val, GUInt16* ptr )
+{
+    __m128i i = _mm256_cvttpd_epi32(_mm256_add_pd(val, _mm256_set1_pd(0.5)));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(ptr), _mm_packus_epi32(i, i));
+}
+
+static inline void Store4ValAVX( __m256d val, float* ptr )
+{
+    _mm_storeu_ps(ptr, _mm256_cvtpd_ps(val));
+}
+
+static inline void Store4ValAVX( __m256d val, double* ptr )
+{
+    _mm256_storeu_pd(ptr, val);
+}
+
+/************************************************************************/
+/*                    WeightedBroveyInternalAVX()                       */
+/************************************************************************/
+
+// Same computation, in the same order, as the scalar and SSE2 paths of
+// gdalpansharpen.cpp, so that the results are identical.
+template<class T, int NINPUT, int NOUTPUT, bool bClamp>
+static size_t WeightedBroveyInternalAVX( const T* pPanBuffer,
+                                         const T* pUpsampledSpectralBuffer,
+                                         T* pDataBuf,
+                                         size_t nValues,
+                                         size_t nBandValues,
+                                         double dfMaxValue,
+                                         const double* padfWeights )
+{
+    const __m256d w0 = _mm256_set1_pd(padfWeights[0]);
+    const __m256d w1 = _mm256_set1_pd(padfWeights[1]);
+    const __m256d w2 = _mm256_set1_pd(padfWeights[2]);
+    const __m256d w3 = _mm256_set1_pd(NINPUT == 3 ? 0.0 : padfWeights[3]);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d maxValue = _mm256_set1_pd(dfMaxValue);
+
+    size_t j = 0;  // Used after for.
+    for( ; j + 3 < nValues; j += 4 )
+    {
+        __m256d val0 = Load4ValAVX(pUpsampledSpectralBuffer + 0 * nBandValues + j);
+        __m256d val1 = Load4ValAVX(pUpsampledSpectralBuffer + 1 * nBandValues + j);
+        __m256d val2 = Load4ValAVX(pUpsampledSpectralBuffer + 2 * nBandValues + j);
+        __m256d val3 = zero;
+        if( NINPUT == 4 || NOUTPUT == 4 )
+            val3 = Load4ValAVX(pUpsampledSpectralBuffer + 3 * nBandValues + j);
+
+        __m256d pseudoPanchro = _mm256_add_pd(zero, _mm256_mul_pd(w0, val0));
+        pseudoPanchro = _mm256_add_pd(pseudoPanchro, _mm256_mul_pd(w1, val1));
+        pseudoPanchro = _mm256_add_pd(pseudoPanchro, _mm256_mul_pd(w2, val2));
+        if( NINPUT == 4 )
+            pseudoPanchro = _mm256_add_pd(pseudoPanchro, _mm256_mul_pd(w3, val3));
+
+        // factor = pseudoPanchro != 0 ? pan / pseudoPanchro : 0
+        const __m256d factor = _mm256_and_pd(
+            _mm256_cmp_pd(pseudoPanchro, zero, _CMP_NEQ_UQ),
+            _mm256_div_pd(Load4ValAVX(pPanBuffer + j), pseudoPanchro));
+
+        val0 = _mm256_mul_pd(val0, factor);
+        val1 = _mm256_mul_pd(val1, factor);
+        val2 = _mm256_mul_pd(val2, factor);
+        if( NOUTPUT == 4 )
+            val3 = _mm256_mul_pd(val3, factor);
+        if( bClamp )
+        {
+            val0 = _mm256_min_pd(val0, maxValue);
+            val1 = _mm256_min_pd(val1, maxValue);
+            val2 = _mm256_min_pd(val2, maxValue);
+            if( NOUTPUT == 4 )
+                val3 = _mm256_min_pd(val3, maxValue);
+        }
+        Store4ValAVX(val0, pDataBuf + 0 * nBandValues + j);
+        Store4ValAVX(val1, pDataBuf + 1 * nBandValues + j);
+        Store4ValAVX(val2, pDataBuf + 2 * nBandValues + j);
+        if( NOUTPUT == 4 )
+            Store4ValAVX(val3, pDataBuf + 3 * nBandValues + j);
+    }
+    return j;
+}
+
+template<class T, bool bClamp>
+static size_t WeightedBroveyAVX( const T* pPanBuffer,
+                                 const T* pUpsampledSpectralBuffer,
+                                 T* pDataBuf,
+                                 size_t nValues,
+                                 size_t nBandValues,
+                                 double dfMaxValue,
+                                 const double* padfWeights,
+                                 int nInputBands, int nOutputBands )
+{
+    if( nInputBands == 3 && nOutputBands == 3 )
+        return WeightedBroveyInternalAVX<T, 3, 3, bClamp>(
+            pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues,
+            nBandValues, dfMaxValue, padfWeights);
+    if( nInputBands == 4 && nOutputBands == 4 )
+        return WeightedBroveyInternalAVX<T, 4, 4, bClamp>(
+            pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues,
+            nBandValues, dfMaxValue, padfWeights);
+    if( nInputBands == 4 && nOutputBands == 3 )
+        return WeightedBroveyInternalAVX<T, 4, 3, bClamp>(
+            pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues,
+            nBandValues, dfMaxValue, padfWeights);
+    return 0;
+}
+
+/************************************************************************/
+/*                  GDALPansharpenWeightedBroveyAVX()                   */
+/************************************************************************/
+
+size_t GDALPansharpenWeightedBroveyAVX( const GByte* pPanBuffer,
+                                        const GByte* pUpsampledSpectralBuffer,
+                                        GByte* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        GByte nMaxValue,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands )
+{
+    return WeightedBroveyAVX<GByte, true>(
+        pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues, nBandValues,
+        nMaxValue, padfWeights, nInputBands, nOutputBands);
+}
+
+size_t GDALPansharpenWeightedBroveyAVX( const GUInt16* pPanBuffer,
+                                        const GUInt16* pUpsampledSpectralBuffer,
+                                        GUInt16* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        GUInt16 nMaxValue,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands )
+{
+    return WeightedBroveyAVX<GUInt16, true>(
+        pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues, nBandValues,
+        nMaxValue, padfWeights, nInputBands, nOutputBands);
+}
+
+size_t GDALPansharpenWeightedBroveyAVX( const float* pPanBuffer,
+                                        const float* pUpsampledSpectralBuffer,
+                                        float* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        float /* nMaxValue */,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands )
+{
+    return WeightedBroveyAVX<float, false>(
+        pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues, nBandValues,
+        0.0, padfWeights, nInputBands, nOutputBands);
+}
+
+size_t GDALPansharpenWeightedBroveyAVX( const double* pPanBuffer,
+                                        const double* pUpsampledSpectralBuffer,
+                                        double* pDataBuf,
+                                        size_t nValues, size_t nBandValues,
+                                        double /* nMaxValue */,
+                                        const double* padfWeights,
+                                        int nInputBands, int nOutputBands )
+{
+    return WeightedBroveyAVX<double, false>(
+        pPanBuffer, pUpsampledSpectralBuffer, pDataBuf, nValues, nBandValues,
+        0.0, padfWeights, nInputBands, nOutputBands);
+}
+
+#endif /* HAVE_AVX_AT_COMPILE_TIME */
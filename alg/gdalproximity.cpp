@@ -34,12 +34,15 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 
 CPL_CVSID("$Id: gdalproximity.cpp 7e07230bbff24eb333608de4dbd460b7312839d0 2017-12-11 19:08:47Z Even Rouault $")
@@ -50,6 +53,31 @@ ProcessProximityLine( GInt32 *panSrcScanline, int *panNearX, int *panNearY,
                       float *pafProximity, double *pdfSrcNoDataValue,
                       int nTargetValues, int *panTargetValues );
 
+namespace {
+
+// Parameters of the final post processing of distances.
+struct ProximityEDTParams
+{
+    int     nXSize = 0;
+    double  dfMaxDist = 0.0;
+    double  dfDistMult = 1.0;
+    const double *pdfSrcNoData = nullptr;
+    float   fNoDataValue = 0.0f;
+    bool    bFixedBufVal = false;
+    double  dfFixedBufVal = 0.0;
+};
+
+} // namespace
+
+static CPLErr
+ComputeProximityEDT( GDALRasterBandH hSrcBand,
+                     GDALRasterBandH hWorkProximityBand,
+                     GDALRasterBandH hProximityBand,
+                     const ProximityEDTParams &sParams,
+                     int nTargetValues, const int *panTargetValues,
+                     int nThreads, int nStripHeight,
+                     GDALProgressFunc pfnProgress, void *pProgressArg );
+
 /************************************************************************/
 /*                        GDALComputeProximity()                        */
 /************************************************************************/
@@ -106,6 +134,24 @@ the proximity output.
 
 If this option is set, all pixels within the MAXDIST threadhold are
 set to this fixed value instead of to a proximity distance.
+
+  ALGORITHM=[SCANLINE]/EDT
+
+Selects the method used to compute the distances.  The default SCANLINE
+algorithm propagates the nearest target found along the scanlines, which
+may slightly overestimate some distances.  EDT (GDAL >= 3.1) computes the
+exact Euclidean distances with a separable distance transform: a pass
+over the columns followed by a pass over the lines, the latter being
+processed by strips of lines.
+
+  NUM_THREADS=n or ALL_CPUS
+
+With ALGORITHM=EDT, number of worker threads among which the lines of
+each strip are split.  Defaults to 1.
+
+  STRIP_HEIGHT=n
+
+With ALGORITHM=EDT, number of lines processed at once.  Defaults to 256.
 */
 
 CPLErr CPL_STDCALL
@@ -222,6 +268,40 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
         bFixedBufVal = true;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Which algorithm should be used?                                 */
+/* -------------------------------------------------------------------- */
+    bool bEDT = false;
+    int nThreads = 1;
+    int nStripHeight = 256;
+    pszOpt = CSLFetchNameValue( papszOptions, "ALGORITHM" );
+    if( pszOpt )
+    {
+        if( EQUAL(pszOpt, "EDT") )
+            bEDT = true;
+        else if( !EQUAL(pszOpt, "SCANLINE") )
+        {
+            CPLError(
+                CE_Failure, CPLE_IllegalArg,
+                "Unrecognized ALGORITHM value '%s', should be SCANLINE or EDT.",
+                pszOpt );
+            return CE_Failure;
+        }
+    }
+    if( bEDT )
+    {
+        if( CSLFetchNameValue( papszOptions, "NUM_THREADS" ) )
+            nThreads = CPLGetNumThreads( papszOptions );
+        nStripHeight = atoi(
+            CSLFetchNameValueDef( papszOptions, "STRIP_HEIGHT", "256" ) );
+        if( nStripHeight < 1 )
+        {
+            CPLError( CE_Failure, CPLE_IllegalArg,
+                      "Invalid STRIP_HEIGHT value" );
+            return CE_Failure;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Get the target value(s).                                        */
 /* -------------------------------------------------------------------- */
@@ -256,7 +336,9 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
 /* -------------------------------------------------------------------- */
 /*      We need a signed type for the working proximity values kept     */
 /*      on disk.  If our proximity band is not signed, then create a    */
-/*      temporary file for this purpose.                                */
+/*      temporary file for this purpose.  The EDT algorithm keeps       */
+/*      column distances in pixels, which also need an integer range    */
+/*      larger than the one of the small signed types.                  */
 /* -------------------------------------------------------------------- */
     GDALRasterBandH hWorkProximityBand = hProximityBand;
     GDALDatasetH hWorkProximityDS = nullptr;
@@ -272,7 +354,9 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
 
     if( eProxType == GDT_Byte
         || eProxType == GDT_UInt16
-        || eProxType == GDT_UInt32 )
+        || eProxType == GDT_UInt32
+        || (bEDT && eProxType != GDT_Int32
+            && eProxType != GDT_Float32 && eProxType != GDT_Float64) )
     {
         GDALDriverH hDriver = GDALGetDriverByName("GTiff");
         if( hDriver == nullptr )
@@ -298,6 +382,24 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
         hWorkProximityBand = GDALGetRasterBand( hWorkProximityDS, 1 );
     }
 
+    if( bEDT )
+    {
+        ProximityEDTParams sParams;
+        sParams.nXSize = nXSize;
+        sParams.dfMaxDist = dfMaxDist;
+        sParams.dfDistMult = dfDistMult;
+        sParams.pdfSrcNoData = pdfSrcNoData;
+        sParams.fNoDataValue = fNoDataValue;
+        sParams.bFixedBufVal = bFixedBufVal;
+        sParams.dfFixedBufVal = dfFixedBufVal;
+        eErr = ComputeProximityEDT( hSrcBand, hWorkProximityBand,
+                                    hProximityBand, sParams,
+                                    nTargetValues, panTargetValues,
+                                    nThreads, nStripHeight,
+                                    pfnProgress, pProgressArg );
+        goto end;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Allocate buffer for two scanlines of distances as floats        */
 /*      (the current and last line).                                    */
@@ -592,3 +694,343 @@ ProcessProximityLine( GInt32 *panSrcScanline, int *panNearX, int *panNearY,
 
     return CE_None;
 }
+
+/************************************************************************/
+/* ==================================================================== */
+/*      Exact Euclidean distance transform.                             */
+/*                                                                      */
+/*      With ALGORITHM=EDT, the distances are computed with the         */
+/*      separable algorithm of Meijster et al. / Felzenszwalb and       */
+/*      Huttenlocher.  A first pass computes for each pixel the         */
+/*      distance to the nearest target in its column, going down the    */
+/*      image and saving the result on the work band, and then up the   */
+/*      image.  The second pass computes the exact distance along each  */
+/*      line as the lower envelope of the parabolas centered on the     */
+/*      column distances.  The lines being independent, the second      */
+/*      pass is run on strips of lines split between worker threads.    */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+struct ProximityEDTJob
+{
+    const ProximityEDTParams *psParams = nullptr;
+    const GInt32 *panSrc = nullptr;       // Source values of the lines.
+    const float  *pafColDist = nullptr;   // Column distances, < 0 if none.
+    float        *pafProximity = nullptr; // Output proximities.
+    int           nLines = 0;
+};
+
+} // namespace
+
+/************************************************************************/
+/*                         IsProximityTarget()                          */
+/************************************************************************/
+
+static bool IsProximityTarget( GInt32 nValue, int nTargetValues,
+                               const int *panTargetValues )
+{
+    if( nTargetValues == 0 )
+        return nValue != 0;
+
+    for( int i = 0; i < nTargetValues; i++ )
+    {
+        if( nValue == panTargetValues[i] )
+            return true;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                          ProximityEDTLine()                          */
+/*                                                                      */
+/*      Compute the final proximity values of one line from the         */
+/*      column distances.  panV and padfZ are work buffers of           */
+/*      nXSize and nXSize + 1 values.                                   */
+/************************************************************************/
+
+static void ProximityEDTLine( const ProximityEDTParams *psParams,
+                              const GInt32 *panSrc, const float *pafColDist,
+                              float *pafProximity, int *panV, double *padfZ )
+
+{
+    const int nXSize = psParams->nXSize;
+
+/* -------------------------------------------------------------------- */
+/*      Build the lower envelope of the parabolas                       */
+/*      (x - q)^2 + g(q)^2 of the columns having a target.              */
+/* -------------------------------------------------------------------- */
+    int k = -1;
+    for( int q = 0; q < nXSize; q++ )
+    {
+        if( pafColDist[q] < 0 )
+            continue;
+
+        const double dfFQ =
+            static_cast<double>(pafColDist[q]) * pafColDist[q] +
+            static_cast<double>(q) * q;
+        if( k < 0 )
+        {
+            k = 0;
+            panV[0] = q;
+            padfZ[0] = -HUGE_VAL;
+            padfZ[1] = HUGE_VAL;
+            continue;
+        }
+
+        double dfS = 0.0;
+        while( true )
+        {
+            const int v = panV[k];
+            const double dfFV =
+                static_cast<double>(pafColDist[v]) * pafColDist[v] +
+                static_cast<double>(v) * v;
+            dfS = (dfFQ - dfFV) / (2.0 * (q - v));
+            // padfZ[0] is -infinity, so this always stops at k == 0.
+            if( dfS > padfZ[k] )
+                break;
+            k--;
+        }
+        k++;
+        panV[k] = q;
+        padfZ[k] = dfS;
+        padfZ[k+1] = HUGE_VAL;
+    }
+
+    const double dfMaxDistSq = psParams->dfMaxDist * psParams->dfMaxDist;
+    const bool bHasTarget = k >= 0;
+    k = 0;
+
+    for( int x = 0; x < nXSize; x++ )
+    {
+        double dfDistSq = -1.0;
+        if( bHasTarget )
+        {
+            while( padfZ[k+1] < x )
+                k++;
+            const double dfDX = static_cast<double>(x) - panV[k];
+            const double dfG = pafColDist[panV[k]];
+            dfDistSq = dfDX * dfDX + dfG * dfG;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Final post processing of distances, matching the scanline       */
+/*      algorithm: targets are at a zero distance, and source nodata    */
+/*      pixels and pixels beyond MAXDIST are set to nodata.             */
+/* -------------------------------------------------------------------- */
+        if( dfDistSq == 0.0 )
+            pafProximity[x] = 0.0f;
+        else if( dfDistSq < 0.0 || dfDistSq > dfMaxDistSq ||
+                 (psParams->pdfSrcNoData != nullptr &&
+                  panSrc[x] == *(psParams->pdfSrcNoData)) )
+            pafProximity[x] = psParams->fNoDataValue;
+        else if( psParams->bFixedBufVal )
+            pafProximity[x] = static_cast<float>(psParams->dfFixedBufVal);
+        else
+            pafProximity[x] = static_cast<float>(
+                static_cast<float>(sqrt(dfDistSq)) * psParams->dfDistMult);
+    }
+}
+
+/************************************************************************/
+/*                        ProximityEDTJobFunc()                         */
+/************************************************************************/
+
+static void ProximityEDTJobFunc( void *pData )
+
+{
+    ProximityEDTJob *psJob = static_cast<ProximityEDTJob *>(pData);
+    const int nXSize = psJob->psParams->nXSize;
+    std::vector<int> anV(nXSize);
+    std::vector<double> adfZ(nXSize + 1);
+
+    for( int iLine = 0; iLine < psJob->nLines; iLine++ )
+    {
+        const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+        ProximityEDTLine( psJob->psParams, psJob->panSrc + nOffset,
+                          psJob->pafColDist + nOffset,
+                          psJob->pafProximity + nOffset,
+                          anV.data(), adfZ.data() );
+    }
+}
+
+/************************************************************************/
+/*                        ComputeProximityEDT()                         */
+/************************************************************************/
+
+static CPLErr
+ComputeProximityEDT( GDALRasterBandH hSrcBand,
+                     GDALRasterBandH hWorkProximityBand,
+                     GDALRasterBandH hProximityBand,
+                     const ProximityEDTParams &sParams,
+                     int nTargetValues, const int *panTargetValues,
+                     int nThreads, int nStripHeight,
+                     GDALProgressFunc pfnProgress, void *pProgressArg )
+
+{
+    const int nXSize = sParams.nXSize;
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+    if( nXSize == 0 || nYSize == 0 )
+        return CE_None;
+    nStripHeight = std::min(nStripHeight, nYSize);
+
+    std::unique_ptr<GInt32, CPLFreeReleaser> panSrc(
+        static_cast<GInt32 *>(VSI_MALLOC3_VERBOSE(
+            sizeof(GInt32), nXSize, nStripHeight)));
+    std::unique_ptr<float, CPLFreeReleaser> pafColDist(
+        static_cast<float *>(VSI_MALLOC3_VERBOSE(
+            sizeof(float), nXSize, nStripHeight)));
+    std::unique_ptr<float, CPLFreeReleaser> pafProximity(
+        static_cast<float *>(VSI_MALLOC3_VERBOSE(
+            sizeof(float), nXSize, nStripHeight)));
+    std::unique_ptr<int, CPLFreeReleaser> panLastDist(
+        static_cast<int *>(VSI_MALLOC2_VERBOSE(sizeof(int), nXSize)));
+    if( panSrc == nullptr || pafColDist == nullptr ||
+        pafProximity == nullptr || panLastDist == nullptr )
+        return CE_Failure;
+
+    int *panLast = panLastDist.get();
+
+/* -------------------------------------------------------------------- */
+/*      Distance to the nearest target above (or on) each pixel of      */
+/*      its column, from top to bottom.                                 */
+/* -------------------------------------------------------------------- */
+    for( int i = 0; i < nXSize; i++ )
+        panLast[i] = -1;
+
+    CPLErr eErr = CE_None;
+    for( int iLine = 0; eErr == CE_None && iLine < nYSize; iLine++ )
+    {
+        GInt32 *panLine = panSrc.get();
+        float *pafLine = pafColDist.get();
+        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iLine, nXSize, 1,
+                             panLine, nXSize, 1, GDT_Int32, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        for( int i = 0; i < nXSize; i++ )
+        {
+            if( IsProximityTarget( panLine[i], nTargetValues,
+                                   panTargetValues ) )
+                panLast[i] = 0;
+            else if( panLast[i] >= 0 )
+                panLast[i]++;
+            pafLine[i] = static_cast<float>(panLast[i]);
+        }
+
+        eErr =
+            GDALRasterIO( hWorkProximityBand, GF_Write, 0, iLine, nXSize, 1,
+                          pafLine, nXSize, 1, GDT_Float32, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        if( !pfnProgress( 0.5 * (iLine+1) / static_cast<double>(nYSize),
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+    if( eErr != CE_None )
+        return eErr;
+
+/* -------------------------------------------------------------------- */
+/*      Process strips of lines from bottom to top: finish the column   */
+/*      distances with the nearest target below each pixel, and then    */
+/*      compute the distances along the lines.                          */
+/* -------------------------------------------------------------------- */
+    std::unique_ptr<CPLJobQueue> poJobQueue;
+    if( nThreads > 1 )
+    {
+        CPLWorkerThreadPool *poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poPool == nullptr )
+            return CE_Failure;
+        poJobQueue = poPool->CreateJobQueue();
+    }
+
+    for( int i = 0; i < nXSize; i++ )
+        panLast[i] = -1;
+
+    for( int iYEnd = nYSize; eErr == CE_None && iYEnd > 0; )
+    {
+        const int iYStart = std::max(0, iYEnd - nStripHeight);
+        const int nLines = iYEnd - iYStart;
+
+        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iYStart, nXSize, nLines,
+                             panSrc.get(), nXSize, nLines, GDT_Int32, 0, 0 );
+        if( eErr == CE_None )
+            eErr = GDALRasterIO( hWorkProximityBand, GF_Read,
+                                 0, iYStart, nXSize, nLines,
+                                 pafColDist.get(), nXSize, nLines,
+                                 GDT_Float32, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        for( int iLine = nLines - 1; iLine >= 0; iLine-- )
+        {
+            const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+            const GInt32 *panLine = panSrc.get() + nOffset;
+            float *pafLine = pafColDist.get() + nOffset;
+            for( int i = 0; i < nXSize; i++ )
+            {
+                if( IsProximityTarget( panLine[i], nTargetValues,
+                                       panTargetValues ) )
+                    panLast[i] = 0;
+                else if( panLast[i] >= 0 )
+                    panLast[i]++;
+                if( panLast[i] >= 0 &&
+                    (pafLine[i] < 0 || panLast[i] < pafLine[i]) )
+                    pafLine[i] = static_cast<float>(panLast[i]);
+            }
+        }
+
+        const int nJobs = std::min(nThreads, nLines);
+        std::vector<ProximityEDTJob> asJobs(nJobs);
+        for( int iJob = 0; iJob < nJobs; iJob++ )
+        {
+            const int iFirst =
+                static_cast<int>(static_cast<GIntBig>(nLines) * iJob / nJobs);
+            const int iNext = static_cast<int>(
+                static_cast<GIntBig>(nLines) * (iJob + 1) / nJobs);
+            const size_t nOffset = static_cast<size_t>(iFirst) * nXSize;
+            asJobs[iJob].psParams = &sParams;
+            asJobs[iJob].panSrc = panSrc.get() + nOffset;
+            asJobs[iJob].pafColDist = pafColDist.get() + nOffset;
+            asJobs[iJob].pafProximity = pafProximity.get() + nOffset;
+            asJobs[iJob].nLines = iNext - iFirst;
+        }
+
+        if( poJobQueue )
+        {
+            for( auto &sJob: asJobs )
+            {
+                if( !poJobQueue->SubmitJob( ProximityEDTJobFunc, &sJob ) )
+                    ProximityEDTJobFunc( &sJob );
+            }
+            poJobQueue->WaitCompletion();
+        }
+        else
+        {
+            for( auto &sJob: asJobs )
+                ProximityEDTJobFunc( &sJob );
+        }
+
+        eErr = GDALRasterIO( hProximityBand, GF_Write,
+                             0, iYStart, nXSize, nLines,
+                             pafProximity.get(), nXSize, nLines,
+                             GDT_Float32, 0, 0 );
+
+        iYEnd = iYStart;
+        if( eErr == CE_None &&
+            !pfnProgress( 0.5 + 0.5 * (nYSize - iYEnd) /
+                                    static_cast<double>(nYSize),
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    return eErr;
+}
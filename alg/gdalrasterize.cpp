@@ -38,12 +38,17 @@
 #include <cfloat>
 #include <vector>
 #include <algorithm>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
+#include "cpl_quad_tree.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_api.h"
@@ -613,6 +618,449 @@ static CPLErr GDALRasterizeOptions( char **papszOptions,
     return CE_None;
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*      Chunked rasterization of geometries.                            */
+/*                                                                      */
+/*      When the raster is processed in several chunks of lines, the    */
+/*      pixel extent of each geometry is computed once and the          */
+/*      geometries are indexed in a quad tree, so that each chunk only  */
+/*      processes the geometries that may touch it.  The chunks can     */
+/*      also be burnt by worker threads (NUM_THREADS option), each      */
+/*      with its own chunk buffer and copy of the transformer.          */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+struct GDALRasterizeChunkContext
+{
+    GDALDataset        *poDS = nullptr;
+    int                 nBandCount = 0;
+    int                *panBandList = nullptr;
+    GDALDataType        eType = GDT_Unknown;
+    int                 nYChunkSize = 0;
+    int                 nChunks = 0;
+    int                 nGeomCount = 0;
+    OGRGeometryH       *pahGeometries = nullptr;
+    double             *padfGeomBurnValue = nullptr;
+    int                 bAllTouched = FALSE;
+    GDALBurnValueSrc    eBurnValueSource = GBV_UserBurnValue;
+    GDALRasterMergeAlg  eMergeAlg = GRMA_Replace;
+
+    // Geometries indexed by pixel extent.  When hTree is NULL, all the
+    // geometries are burnt in every chunk.
+    CPLQuadTree        *hTree = nullptr;
+    std::vector<int>    anShapeIndex{};
+    // Geometries whose extent could not be computed, burnt in every chunk.
+    std::vector<int>    anUnboundedShapes{};
+
+    // Serializes the dataset accesses of the worker threads.
+    std::mutex          oIOMutex{};
+
+    // Scheduling of the chunks between the worker threads.
+    std::mutex              oMutex{};
+    std::condition_variable oCond{};
+    int                     iNextChunk = 0;
+    int                     nChunksDone = 0;
+    bool                    bStop = false;
+    CPLErr                  eErr = CE_None;
+
+    GDALRasterizeChunkContext() = default;
+    ~GDALRasterizeChunkContext()
+    {
+        if( hTree )
+            CPLQuadTreeDestroy( hTree );
+    }
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALRasterizeChunkContext)
+};
+
+// Transformer that cannot be cloned, shared by the worker threads.
+struct GDALRasterizeSharedTransformer
+{
+    GDALTransformerFunc pfnTransformer = nullptr;
+    void               *pTransformArg = nullptr;
+    std::mutex         *poMutex = nullptr;
+};
+
+struct GDALRasterizeChunkWorker
+{
+    GDALRasterizeChunkContext *psContext = nullptr;
+    GDALTransformerFunc        pfnTransformer = nullptr;
+    void                      *pTransformArg = nullptr;
+    bool                       bOwnTransformer = false;
+    unsigned char             *pabyChunkBuf = nullptr;
+};
+
+} // namespace
+
+/************************************************************************/
+/*                   GDALRasterizeSharedTransform()                     */
+/************************************************************************/
+
+static int GDALRasterizeSharedTransform( void *pTransformArg, int bDstToSrc,
+                                         int nPointCount,
+                                         double *x, double *y, double *z,
+                                         int *panSuccess )
+{
+    GDALRasterizeSharedTransformer *psShared =
+        static_cast<GDALRasterizeSharedTransformer *>(pTransformArg);
+    std::lock_guard<std::mutex> oLock(*(psShared->poMutex));
+    return psShared->pfnTransformer( psShared->pTransformArg, bDstToSrc,
+                                     nPointCount, x, y, z, panSuccess );
+}
+
+/************************************************************************/
+/*                     GDALRasterizeBinGeometries()                     */
+/*                                                                      */
+/*      Compute the pixel extent of each geometry, and index the        */
+/*      geometries that can touch the raster in a quad tree.            */
+/************************************************************************/
+
+static void GDALRasterizeBinGeometries( GDALRasterizeChunkContext &sContext,
+                                        GDALTransformerFunc pfnTransformer,
+                                        void *pTransformArg )
+
+{
+    const int nXSize = sContext.poDS->GetRasterXSize();
+    const int nYSize = sContext.poDS->GetRasterYSize();
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = 0;
+    sGlobalBounds.miny = 0;
+    sGlobalBounds.maxx = nXSize;
+    sGlobalBounds.maxy = nYSize;
+    sContext.hTree = CPLQuadTreeCreate( &sGlobalBounds, nullptr );
+    CPLQuadTreeSetMaxDepth( sContext.hTree,
+        CPLQuadTreeGetAdvisedMaxDepth( sContext.nGeomCount ) );
+
+    sContext.anShapeIndex.resize( sContext.nGeomCount );
+
+    std::vector<double> aPointX;
+    std::vector<double> aPointY;
+    std::vector<double> aPointVariant;
+    std::vector<int> aPartSize;
+    std::vector<int> anSuccess;
+
+    for( int iShape = 0; iShape < sContext.nGeomCount; iShape++ )
+    {
+        OGRGeometry *poShape =
+            reinterpret_cast<OGRGeometry *>(sContext.pahGeometries[iShape]);
+        if( poShape == nullptr || poShape->IsEmpty() )
+            continue;
+
+        aPointX.clear();
+        aPointY.clear();
+        aPointVariant.clear();
+        aPartSize.clear();
+        GDALCollectRingsFromGeometry( poShape, aPointX, aPointY,
+                                      aPointVariant, aPartSize,
+                                      GBV_UserBurnValue );
+        if( aPointX.empty() )
+            continue;
+
+        if( pfnTransformer != nullptr )
+        {
+            anSuccess.resize( aPointX.size() );
+            pfnTransformer( pTransformArg, FALSE,
+                            static_cast<int>(aPointX.size()),
+                            &(aPointX[0]), &(aPointY[0]), nullptr,
+                            &(anSuccess[0]) );
+        }
+
+        // The rasterization does not check the transformation success, so
+        // use all the points, and burn the geometry everywhere if one
+        // of them is not a number.
+        CPLRectObj sBounds;
+        sBounds.minx = aPointX[0];
+        sBounds.maxx = aPointX[0];
+        sBounds.miny = aPointY[0];
+        sBounds.maxy = aPointY[0];
+        bool bFinite = true;
+        for( size_t i = 0; i < aPointX.size(); i++ )
+        {
+            if( !CPLIsFinite(aPointX[i]) || !CPLIsFinite(aPointY[i]) )
+            {
+                bFinite = false;
+                break;
+            }
+            sBounds.minx = std::min(sBounds.minx, aPointX[i]);
+            sBounds.maxx = std::max(sBounds.maxx, aPointX[i]);
+            sBounds.miny = std::min(sBounds.miny, aPointY[i]);
+            sBounds.maxy = std::max(sBounds.maxy, aPointY[i]);
+        }
+        if( !bFinite )
+        {
+            sContext.anUnboundedShapes.push_back( iShape );
+            continue;
+        }
+
+        // Burnt lines and columns are within one pixel of the extent.
+        sBounds.minx -= 1;
+        sBounds.miny -= 1;
+        sBounds.maxx += 1;
+        sBounds.maxy += 1;
+        if( sBounds.maxy < 0 || sBounds.miny > nYSize )
+            continue;
+
+        sContext.anShapeIndex[iShape] = iShape;
+        CPLQuadTreeInsertWithBounds( sContext.hTree,
+                                     &(sContext.anShapeIndex[iShape]),
+                                     &sBounds );
+    }
+}
+
+/************************************************************************/
+/*                         GDALRasterizeChunk()                         */
+/*                                                                      */
+/*      Read one chunk of lines, burn the geometries that may touch     */
+/*      it, and write it back.                                          */
+/************************************************************************/
+
+static CPLErr GDALRasterizeChunk( GDALRasterizeChunkContext &sContext,
+                                  int iChunk, unsigned char *pabyChunkBuf,
+                                  GDALTransformerFunc pfnTransformer,
+                                  void *pTransformArg )
+
+{
+    GDALDataset *poDS = sContext.poDS;
+    const int nXSize = poDS->GetRasterXSize();
+    const int iY = iChunk * sContext.nYChunkSize;
+    const int nThisYChunkSize =
+        std::min(sContext.nYChunkSize, poDS->GetRasterYSize() - iY);
+
+    {
+        std::lock_guard<std::mutex> oLock(sContext.oIOMutex);
+        const CPLErr eErr =
+            poDS->RasterIO( GF_Read, 0, iY, nXSize, nThisYChunkSize,
+                            pabyChunkBuf, nXSize, nThisYChunkSize,
+                            sContext.eType, sContext.nBandCount,
+                            sContext.panBandList, 0, 0, 0, nullptr );
+        if( eErr != CE_None )
+            return eErr;
+    }
+
+    std::vector<int> anShapes;
+    if( sContext.hTree != nullptr )
+    {
+        CPLRectObj sAoi;
+        sAoi.minx = -std::numeric_limits<double>::max();
+        sAoi.maxx = std::numeric_limits<double>::max();
+        sAoi.miny = iY;
+        sAoi.maxy = iY + nThisYChunkSize;
+        int nFeatureCount = 0;
+        void **pahFeatures =
+            CPLQuadTreeSearch( sContext.hTree, &sAoi, &nFeatureCount );
+        anShapes.reserve( nFeatureCount + sContext.anUnboundedShapes.size() );
+        for( int i = 0; i < nFeatureCount; i++ )
+            anShapes.push_back( *static_cast<int *>(pahFeatures[i]) );
+        CPLFree( pahFeatures );
+        anShapes.insert( anShapes.end(), sContext.anUnboundedShapes.begin(),
+                         sContext.anUnboundedShapes.end() );
+        // Burn in the order of the geometries, as without binning.
+        std::sort( anShapes.begin(), anShapes.end() );
+    }
+    else
+    {
+        anShapes.resize( sContext.nGeomCount );
+        for( int i = 0; i < sContext.nGeomCount; i++ )
+            anShapes[i] = i;
+    }
+
+    for( const int iShape: anShapes )
+    {
+        gv_rasterize_one_shape( pabyChunkBuf, 0, iY,
+                                nXSize, nThisYChunkSize,
+                                sContext.nBandCount, sContext.eType,
+                                0, 0, 0,
+                                sContext.bAllTouched,
+                                reinterpret_cast<OGRGeometry *>(
+                                    sContext.pahGeometries[iShape]),
+                                sContext.padfGeomBurnValue +
+                                    iShape * sContext.nBandCount,
+                                sContext.eBurnValueSource,
+                                sContext.eMergeAlg,
+                                pfnTransformer, pTransformArg );
+    }
+
+    std::lock_guard<std::mutex> oLock(sContext.oIOMutex);
+    return poDS->RasterIO( GF_Write, 0, iY, nXSize, nThisYChunkSize,
+                           pabyChunkBuf, nXSize, nThisYChunkSize,
+                           sContext.eType, sContext.nBandCount,
+                           sContext.panBandList, 0, 0, 0, nullptr );
+}
+
+/************************************************************************/
+/*                   GDALRasterizeChunkWorkerFunc()                     */
+/************************************************************************/
+
+static void GDALRasterizeChunkWorkerFunc( void *pData )
+
+{
+    GDALRasterizeChunkWorker *psWorker =
+        static_cast<GDALRasterizeChunkWorker *>(pData);
+    GDALRasterizeChunkContext &sContext = *(psWorker->psContext);
+
+    while( true )
+    {
+        int iChunk = 0;
+        {
+            std::lock_guard<std::mutex> oLock(sContext.oMutex);
+            if( sContext.bStop || sContext.iNextChunk == sContext.nChunks )
+                break;
+            iChunk = sContext.iNextChunk++;
+        }
+
+        const CPLErr eErr =
+            GDALRasterizeChunk( sContext, iChunk, psWorker->pabyChunkBuf,
+                                psWorker->pfnTransformer,
+                                psWorker->pTransformArg );
+
+        {
+            std::lock_guard<std::mutex> oLock(sContext.oMutex);
+            if( eErr != CE_None && sContext.eErr == CE_None )
+            {
+                sContext.eErr = eErr;
+                sContext.bStop = true;
+            }
+            sContext.nChunksDone++;
+        }
+        sContext.oCond.notify_all();
+    }
+}
+
+/************************************************************************/
+/*                     GDALRasterizeChunksThreaded()                    */
+/************************************************************************/
+
+static CPLErr GDALRasterizeChunksThreaded( GDALRasterizeChunkContext &sContext,
+                                          int nThreads, int nScanlineBytes,
+                                          GDALTransformerFunc pfnTransformer,
+                                          void *pTransformArg,
+                                          GDALProgressFunc pfnProgress,
+                                          void *pProgressArg )
+
+{
+    nThreads = std::min(nThreads, sContext.nChunks);
+
+/* -------------------------------------------------------------------- */
+/*      Give each worker a chunk buffer and a copy of the               */
+/*      transformer.  Transformers that cannot be cloned are shared     */
+/*      with their calls serialized.                                    */
+/* -------------------------------------------------------------------- */
+    std::mutex oTransformerMutex;
+    GDALRasterizeSharedTransformer sShared;
+    sShared.pfnTransformer = pfnTransformer;
+    sShared.pTransformArg = pTransformArg;
+    sShared.poMutex = &oTransformerMutex;
+
+    bool bCanClone = false;
+    if( pTransformArg != nullptr )
+    {
+        const GDALTransformerInfo *psInfo =
+            static_cast<const GDALTransformerInfo *>(pTransformArg);
+        bCanClone =
+            memcmp( psInfo->abySignature, GDAL_GTI2_SIGNATURE,
+                    strlen(GDAL_GTI2_SIGNATURE) ) == 0 &&
+            (psInfo->pfnCreateSimilar != nullptr ||
+             psInfo->pfnSerialize != nullptr);
+    }
+
+    CPLErr eErr = CE_None;
+    std::vector<GDALRasterizeChunkWorker> asWorkers(nThreads);
+    for( auto &sWorker: asWorkers )
+    {
+        sWorker.psContext = &sContext;
+        sWorker.pabyChunkBuf = static_cast<unsigned char *>(
+            VSI_MALLOC2_VERBOSE(sContext.nYChunkSize, nScanlineBytes));
+        if( sWorker.pabyChunkBuf == nullptr )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+
+        if( pfnTransformer == nullptr )
+            continue;
+        if( bCanClone )
+        {
+            sWorker.pTransformArg = GDALCloneTransformer( pTransformArg );
+            if( sWorker.pTransformArg != nullptr )
+            {
+                sWorker.pfnTransformer = pfnTransformer;
+                sWorker.bOwnTransformer = true;
+                continue;
+            }
+        }
+        sWorker.pfnTransformer = GDALRasterizeSharedTransform;
+        sWorker.pTransformArg = &sShared;
+    }
+
+    if( eErr == CE_None )
+    {
+        CPLWorkerThreadPool *poPool = CPLGetGlobalWorkerThreadPool( nThreads );
+        if( poPool == nullptr )
+        {
+            eErr = CE_Failure;
+        }
+        else
+        {
+            auto poJobQueue = poPool->CreateJobQueue();
+            for( auto &sWorker: asWorkers )
+            {
+                if( !poJobQueue->SubmitJob( GDALRasterizeChunkWorkerFunc,
+                                            &sWorker ) )
+                {
+                    GDALRasterizeChunkWorkerFunc( &sWorker );
+                }
+            }
+
+/* -------------------------------------------------------------------- */
+/*      Report progress from the calling thread, unless it is itself a  */
+/*      worker of the pool: it then runs queued jobs while waiting.     */
+/* -------------------------------------------------------------------- */
+            std::unique_lock<std::mutex> oLock(sContext.oMutex);
+            int nChunksReported = 0;
+            while( !poPool->IsWorkerThread() &&
+                   !sContext.bStop && sContext.nChunksDone < sContext.nChunks )
+            {
+                sContext.oCond.wait( oLock, [&sContext, nChunksReported]() {
+                    return sContext.bStop ||
+                           sContext.nChunksDone != nChunksReported; } );
+                if( sContext.bStop )
+                    break;
+                nChunksReported = sContext.nChunksDone;
+                oLock.unlock();
+                const bool bContinue = pfnProgress(
+                    nChunksReported / static_cast<double>(sContext.nChunks),
+                    "", pProgressArg ) != FALSE;
+                oLock.lock();
+                if( !bContinue )
+                {
+                    CPLError( CE_Failure, CPLE_UserInterrupt,
+                              "User terminated" );
+                    sContext.bStop = true;
+                    eErr = CE_Failure;
+                }
+            }
+            oLock.unlock();
+
+            poJobQueue->WaitCompletion();
+            if( eErr == CE_None )
+                eErr = sContext.eErr;
+        }
+    }
+
+    for( auto &sWorker: asWorkers )
+    {
+        VSIFree( sWorker.pabyChunkBuf );
+        if( sWorker.bOwnTransformer )
+            GDALDestroyTransformer( sWorker.pTransformArg );
+    }
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                      GDALRasterizeGeometries()                       */
 /************************************************************************/
@@ -667,12 +1115,20 @@ static CPLErr GDALRasterizeOptions( char **papszOptions,
  * used. Default size will be estimated based on the GDAL cache buffer size
  * using formula: cache_size_bytes/scanline_size_bytes, so the chunk will
  * not exceed the cache. Not used in OPTIM=RASTER mode.</li>
+ * <li>"NUM_THREADS": (GDAL >= 3.1) Number of worker threads, or ALL_CPUS,
+ * burning the chunks in parallel in OPTIM=RASTER mode. When CHUNKYSIZE is
+ * not set, the default chunk size is divided by the number of threads.
+ * Defaults to 1.</li>
  * </ul>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
  *
  * @return CE_None on success or CE_Failure on error.
  *
+ * When the raster is processed in several chunks, the geometries are
+ * indexed by their extent in pixels, so that each chunk only processes the
+ * geometries that may touch it.
+ *
  * <strong>Example</strong><br>
  * GDALRasterizeGeometries rasterize output to MEM Dataset :<br>
  * @code
@@ -841,14 +1297,23 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
         const int nScanlineBytes =
             nBandCount * poDS->GetRasterXSize() * GDALGetDataTypeSizeBytes(eType);
 
+        int nThreads = 1;
+        if( CSLFetchNameValue(papszOptions, "NUM_THREADS") != nullptr )
+            nThreads = CPLGetNumThreads(papszOptions);
+
         int nYChunkSize = 0;
         const char *pszYChunkSize = CSLFetchNameValue(papszOptions, "CHUNKYSIZE");
         if( pszYChunkSize == nullptr || ((nYChunkSize = atoi(pszYChunkSize))) == 0)
         {
-            const GIntBig nYChunkSize64 = GDALGetCacheMax64() / nScanlineBytes;
+            const GIntBig nYChunkSize64 =
+                GDALGetCacheMax64() / nScanlineBytes / nThreads;
             const int knIntMax = std::numeric_limits<int>::max();
             nYChunkSize = nYChunkSize64 > knIntMax ? knIntMax
                           : static_cast<int>(nYChunkSize64);
+            // Give some work to every thread.
+            if( nThreads > 1 )
+                nYChunkSize = std::min(nYChunkSize,
+                    (poDS->GetRasterYSize() + nThreads - 1) / nThreads);
         }
 
         if( nYChunkSize < 1 )
@@ -860,65 +1325,68 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
                   (poDS->GetRasterYSize() + nYChunkSize - 1) / nYChunkSize,
                   nYChunkSize );
 
-        pabyChunkBuf = static_cast<unsigned char *>(
-            VSI_MALLOC2_VERBOSE(nYChunkSize, nScanlineBytes));
-        if( pabyChunkBuf == nullptr )
-        {
-            if( bNeedToFreeTransformer )
-                GDALDestroyTransformer( pTransformArg );
-            return CE_Failure;
-        }
+        GDALRasterizeChunkContext sContext;
+        sContext.poDS = poDS;
+        sContext.nBandCount = nBandCount;
+        sContext.panBandList = panBandList;
+        sContext.eType = eType;
+        sContext.nYChunkSize = nYChunkSize;
+        sContext.nChunks =
+            (poDS->GetRasterYSize() + nYChunkSize - 1) / nYChunkSize;
+        sContext.nGeomCount = nGeomCount;
+        sContext.pahGeometries = pahGeometries;
+        sContext.padfGeomBurnValue = padfGeomBurnValue;
+        sContext.bAllTouched = bAllTouched;
+        sContext.eBurnValueSource = eBurnValueSource;
+        sContext.eMergeAlg = eMergeAlg;
 
-/* ==================================================================== */
-/*      Loop over image in designated chunks.                           */
-/* ==================================================================== */
         pfnProgress( 0.0, nullptr, pProgressArg );
 
-        for( int iY = 0;
-             iY < poDS->GetRasterYSize() && eErr == CE_None;
-             iY += nYChunkSize )
-        {
-            int nThisYChunkSize = nYChunkSize;
-            if( nThisYChunkSize + iY > poDS->GetRasterYSize() )
-                nThisYChunkSize = poDS->GetRasterYSize() - iY;
-
-            eErr =
-                poDS->RasterIO(GF_Read,
-                               0, iY, poDS->GetRasterXSize(), nThisYChunkSize,
-                               pabyChunkBuf,
-                               poDS->GetRasterXSize(), nThisYChunkSize,
-                               eType, nBandCount, panBandList,
-                               0, 0, 0, nullptr);
-            if( eErr != CE_None )
-                break;
+        // With a single chunk, every geometry has to be processed anyway.
+        if( sContext.nChunks > 1 )
+            GDALRasterizeBinGeometries( sContext,
+                                        pfnTransformer, pTransformArg );
 
-            for( int iShape = 0; iShape < nGeomCount; iShape++ )
+        pabyChunkBuf = nullptr;
+        if( nThreads > 1 && sContext.nChunks > 1 )
+        {
+            eErr = GDALRasterizeChunksThreaded( sContext, nThreads,
+                                                nScanlineBytes,
+                                                pfnTransformer, pTransformArg,
+                                                pfnProgress, pProgressArg );
+        }
+        else
+        {
+            pabyChunkBuf = static_cast<unsigned char *>(
+                VSI_MALLOC2_VERBOSE(nYChunkSize, nScanlineBytes));
+            if( pabyChunkBuf == nullptr )
             {
-                gv_rasterize_one_shape( pabyChunkBuf, 0, iY,
-                                        poDS->GetRasterXSize(), nThisYChunkSize,
-                                        nBandCount, eType,
-                                        0, 0, 0,
-                                        bAllTouched,
-                                        reinterpret_cast<OGRGeometry *>(
-                                                            pahGeometries[iShape]),
-                                        padfGeomBurnValue + iShape*nBandCount,
-                                        eBurnValueSource, eMergeAlg,
-                                        pfnTransformer, pTransformArg );
+                if( bNeedToFreeTransformer )
+                    GDALDestroyTransformer( pTransformArg );
+                return CE_Failure;
             }
 
-            eErr =
-                poDS->RasterIO( GF_Write, 0, iY,
-                                poDS->GetRasterXSize(), nThisYChunkSize,
-                                pabyChunkBuf,
-                                poDS->GetRasterXSize(), nThisYChunkSize,
-                                eType, nBandCount, panBandList, 0, 0, 0, nullptr);
-
-            if( !pfnProgress((iY + nThisYChunkSize) /
-                             static_cast<double>(poDS->GetRasterYSize()),
-                             "", pProgressArg ) )
+/* ==================================================================== */
+/*      Loop over image in designated chunks.                           */
+/* ==================================================================== */
+            for( int iChunk = 0;
+                 iChunk < sContext.nChunks && eErr == CE_None;
+                 iChunk++ )
             {
-                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-                eErr = CE_Failure;
+                eErr = GDALRasterizeChunk( sContext, iChunk, pabyChunkBuf,
+                                           pfnTransformer, pTransformArg );
+
+                const int iYEnd = iChunk * nYChunkSize +
+                    std::min(nYChunkSize,
+                             poDS->GetRasterYSize() - iChunk * nYChunkSize);
+                if( !pfnProgress(iYEnd /
+                                 static_cast<double>(poDS->GetRasterYSize()),
+                                 "", pProgressArg ) )
+                {
+                    CPLError( CE_Failure, CPLE_UserInterrupt,
+                              "User terminated" );
+                    eErr = CE_Failure;
+                }
             }
         }
     }
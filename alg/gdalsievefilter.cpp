@@ -33,6 +33,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 #include <utility>
@@ -40,7 +43,9 @@
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
+#include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_alg_priv.h"
 
@@ -146,6 +151,848 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
         anBigNeighbour[nPolyId2] = nPolyId1;
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*                        Strip based sieving                           */
+/*                                                                      */
+/*      When NUM_THREADS is specified, the raster is cut into strips    */
+/*      of full width that are labelled independently by worker         */
+/*      threads.  The polygon pieces of each strip get a compact id,    */
+/*      and the pieces crossing a seam are merged with a union-find.    */
+/*      Only per piece tables are kept between the passes: the pixel    */
+/*      to polygon id maps are rebuilt strip by strip when applying     */
+/*      the merges, so they never exist for the whole raster.           */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+struct SieveStripContext
+{
+    GDALRasterBandH  hSrcBand = nullptr;
+    GDALRasterBandH  hMaskBand = nullptr;
+    GDALRasterBandH  hDstBand = nullptr;
+    int              nXSize = 0;
+    int              nConnectedness = 4;
+    int              nSizeThreshold = 0;
+    int              nThreads = 1;
+
+    // Final value of each piece, used when writing the strips.
+    const std::vector<GInt32> *panPieceValue = nullptr;
+
+    // Serializes the accesses to the raster bands.
+    std::mutex              oIOMutex{};
+
+    std::mutex              oMutex{};
+    bool                    bStop = false;
+};
+
+// A candidate neighbour of a possibly small polygon piece.  nPos is the
+// rank of the pixel comparison that first met it in the scan order used
+// by the single threaded algorithm, so that ties between neighbours of
+// the same size are resolved in the same way.
+struct SieveNeighbour
+{
+    int     nPiece;
+    int     nNeighbour;
+    GIntBig nPos;
+};
+
+struct SieveStripJob
+{
+    SieveStripContext *psContext = nullptr;
+    int             iYStart = 0;
+    int             nLines = 0;
+    bool            bFirst = false;
+    bool            bLast = false;
+    int             nOffset = 0;
+
+    CPLErr          eErr = CE_None;
+    bool            bDone = false;
+
+    // Labelling results: size, value and (when it could be resolved
+    // within the strip) biggest neighbour of each piece.
+    std::vector<int>    anSize{};
+    std::vector<GInt32> anValue{};
+    std::vector<int>    anBigNeighbour{};
+
+    // Neighbours that can only be compared once the seams are merged.
+    std::vector<SieveNeighbour> asNeighbours{};
+
+    // Values and pieces of the first and last rows.
+    std::vector<GInt32> anTopVal{};
+    std::vector<GInt32> anBottomVal{};
+    std::vector<int>    anTopPiece{};
+    std::vector<int>    anBottomPiece{};
+};
+
+} // namespace
+
+/************************************************************************/
+/*                           SieveReadStrip()                           */
+/*                                                                      */
+/*      Read the strip, with masked out pixels set to the nodata        */
+/*      marker in panVal.  The original values are also returned in     */
+/*      panOrigVal if it is not NULL.                                   */
+/************************************************************************/
+
+static CPLErr SieveReadStrip( SieveStripContext *psContext,
+                              int iYStart, int nLines,
+                              GInt32 *panVal, GInt32 *panOrigVal )
+
+{
+    const int nXSize = psContext->nXSize;
+    const size_t nPixels = static_cast<size_t>(nXSize) * nLines;
+
+    GByte *pabyMask = nullptr;
+    if( psContext->hMaskBand != nullptr )
+    {
+        pabyMask = static_cast<GByte *>(
+            VSI_MALLOC2_VERBOSE(nXSize, nLines));
+        if( pabyMask == nullptr )
+            return CE_Failure;
+    }
+
+    CPLErr eErr = CE_None;
+    {
+        std::lock_guard<std::mutex> oLock(psContext->oIOMutex);
+        eErr = GDALRasterIO( psContext->hSrcBand, GF_Read,
+                             0, iYStart, nXSize, nLines,
+                             panVal, nXSize, nLines, GDT_Int32, 0, 0 );
+        if( eErr == CE_None && pabyMask != nullptr )
+            eErr = GDALRasterIO( psContext->hMaskBand, GF_Read,
+                                 0, iYStart, nXSize, nLines,
+                                 pabyMask, nXSize, nLines, GDT_Byte, 0, 0 );
+    }
+
+    if( eErr == CE_None && panOrigVal != nullptr )
+        memcpy( panOrigVal, panVal, sizeof(GInt32) * nPixels );
+
+    if( eErr == CE_None && pabyMask != nullptr )
+    {
+        for( size_t i = 0; i < nPixels; i++ )
+        {
+            if( pabyMask[i] == 0 )
+                panVal[i] = GP_NODATA_MARKER;
+        }
+    }
+
+    CPLFree( pabyMask );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          SieveLabelStrip()                           */
+/*                                                                      */
+/*      Assign to each pixel of the strip the compact id of its         */
+/*      polygon piece (-1 for nodata), and return the piece values.     */
+/*      The ids only depend on the strip content, so that the last      */
+/*      pass finds the same ones as the first.                          */
+/************************************************************************/
+
+static void SieveLabelStrip( int nConnectedness, int nXSize, int nLines,
+                             GInt32 *panVal, GInt32 *panId,
+                             std::vector<GInt32> &anPieceValue )
+
+{
+    GDALRasterPolygonEnumerator oEnum( nConnectedness );
+
+    for( int iLine = 0; iLine < nLines; iLine++ )
+    {
+        const size_t nLineOffset = static_cast<size_t>(iLine) * nXSize;
+
+        if( iLine == 0 )
+            oEnum.ProcessLine(
+                nullptr, panVal, nullptr, panId, nXSize );
+        else
+            oEnum.ProcessLine(
+                panVal + nLineOffset - nXSize, panVal + nLineOffset,
+                panId + nLineOffset - nXSize, panId + nLineOffset,
+                nXSize );
+    }
+
+    oEnum.CompleteMerges();
+
+    std::vector<int> anCompactId(oEnum.nNextPolygonId);
+    anPieceValue.clear();
+    for( int iPoly = 0; iPoly < oEnum.nNextPolygonId; iPoly++ )
+    {
+        if( oEnum.panPolyIdMap[iPoly] == iPoly )
+        {
+            anCompactId[iPoly] = static_cast<int>(anPieceValue.size());
+            anPieceValue.push_back( oEnum.panPolyValue[iPoly] );
+        }
+    }
+
+    const size_t nPixels = static_cast<size_t>(nXSize) * nLines;
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        if( panId[i] >= 0 )
+            panId[i] = anCompactId[oEnum.panPolyIdMap[panId[i]]];
+    }
+}
+
+/************************************************************************/
+/*                         SieveCheckStopped()                          */
+/************************************************************************/
+
+static bool SieveCheckStopped( SieveStripContext *psContext )
+{
+    std::lock_guard<std::mutex> oLock(psContext->oMutex);
+    return psContext->bStop;
+}
+
+/************************************************************************/
+/*                        SieveLabelStripJob()                          */
+/*                                                                      */
+/*      First pass over a strip: compute the piece sizes, and collect   */
+/*      the neighbours of the pieces that may be smaller than the       */
+/*      threshold.                                                      */
+/************************************************************************/
+
+static CPLErr SieveLabelStripJob( SieveStripJob *psJob )
+
+{
+    SieveStripContext *psContext = psJob->psContext;
+    if( SieveCheckStopped(psContext) )
+        return CE_Failure;
+
+    const int nXSize = psContext->nXSize;
+    const int nLines = psJob->nLines;
+    const int nConnectedness = psContext->nConnectedness;
+    const int nSizeThreshold = psContext->nSizeThreshold;
+    const size_t nPixels = static_cast<size_t>(nXSize) * nLines;
+
+    std::unique_ptr<GInt32, CPLFreeReleaser> panValHolder(
+        static_cast<GInt32 *>(
+            VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nLines)));
+    std::unique_ptr<GInt32, CPLFreeReleaser> panIdHolder(
+        static_cast<GInt32 *>(
+            VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nLines)));
+    if( panValHolder == nullptr || panIdHolder == nullptr )
+        return CE_Failure;
+    GInt32 *panVal = panValHolder.get();
+    GInt32 *panId = panIdHolder.get();
+
+    CPLErr eErr = SieveReadStrip( psContext, psJob->iYStart, nLines,
+                                  panVal, nullptr );
+    if( eErr != CE_None )
+        return eErr;
+
+    SieveLabelStrip( nConnectedness, nXSize, nLines, panVal, panId,
+                     psJob->anValue );
+    const int nPieces = static_cast<int>(psJob->anValue.size());
+
+/* -------------------------------------------------------------------- */
+/*      Accumulate piece sizes, and flag the pieces touching a seam.    */
+/* -------------------------------------------------------------------- */
+    psJob->anSize.assign( nPieces, 0 );
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        if( panId[i] >= 0 && psJob->anSize[panId[i]] < MY_MAX_INT )
+            psJob->anSize[panId[i]] += 1;
+    }
+
+    psJob->anTopVal.assign( panVal, panVal + nXSize );
+    psJob->anTopPiece.assign( panId, panId + nXSize );
+    psJob->anBottomVal.assign( panVal + nPixels - nXSize, panVal + nPixels );
+    psJob->anBottomPiece.assign( panId + nPixels - nXSize, panId + nPixels );
+
+    std::vector<bool> abSeam(nPieces, false);
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        if( !psJob->bFirst && psJob->anTopPiece[iX] >= 0 )
+            abSeam[psJob->anTopPiece[iX]] = true;
+        if( !psJob->bLast && psJob->anBottomPiece[iX] >= 0 )
+            abSeam[psJob->anBottomPiece[iX]] = true;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Check the neighbours in the same order as CompareNeighbour()    */
+/*      is called by the single threaded algorithm.  The size of a      */
+/*      piece that does not touch a seam is final, so the biggest of    */
+/*      such neighbours is tracked directly.  Anything involving        */
+/*      seam pieces is kept for later.                                  */
+/* -------------------------------------------------------------------- */
+    std::vector<int> &anBig = psJob->anBigNeighbour;
+    anBig.assign( nPieces, -1 );
+    std::vector<GIntBig> anBigPos(nPieces, 0);
+    std::vector<bool> abHasSeamNeighbour(nPieces, false);
+
+    const auto Compare = [&]( int nPiece, int nOther, GIntBig nPos )
+    {
+        if( psJob->anSize[nPiece] >= nSizeThreshold )
+            return;
+
+        if( abSeam[nPiece] || abSeam[nOther] )
+        {
+            SieveNeighbour sNeighbour;
+            sNeighbour.nPiece = nPiece;
+            sNeighbour.nNeighbour = nOther;
+            sNeighbour.nPos = nPos;
+            psJob->asNeighbours.push_back( sNeighbour );
+            abHasSeamNeighbour[nPiece] = true;
+        }
+        else if( anBig[nPiece] == -1 ||
+                 psJob->anSize[anBig[nPiece]] < psJob->anSize[nOther] )
+        {
+            anBig[nPiece] = nOther;
+            anBigPos[nPiece] = nPos;
+        }
+    };
+
+    const auto ComparePair = [&]( size_t i, size_t j, GIntBig nPos )
+    {
+        const int nId1 = panId[i];
+        const int nId2 = panId[j];
+        if( nId1 < 0 || nId2 < 0 || nId1 == nId2 )
+            return;
+        Compare( nId1, nId2, nPos );
+        Compare( nId2, nId1, nPos );
+    };
+
+    for( int iLine = 0; iLine < nLines; iLine++ )
+    {
+        const size_t nLineOffset = static_cast<size_t>(iLine) * nXSize;
+        const GIntBig nRowPos =
+            (static_cast<GIntBig>(psJob->iYStart) + iLine) * nXSize;
+
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const size_t i = nLineOffset + iX;
+            const GIntBig nPos = (nRowPos + iX) * 4;
+
+            if( iLine > 0 )
+            {
+                ComparePair( i, i - nXSize, nPos );
+
+                if( iX > 0 && nConnectedness == 8 )
+                    ComparePair( i, i - nXSize - 1, nPos + 1 );
+
+                if( iX < nXSize-1 && nConnectedness == 8 )
+                    ComparePair( i, i - nXSize + 1, nPos + 2 );
+            }
+
+            if( iX > 0 )
+                ComparePair( i, i - 1, nPos + 3 );
+        }
+
+        if( iLine % 64 == 63 && SieveCheckStopped(psContext) )
+            return CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Pieces with neighbours on a seam are resolved globally: hand    */
+/*      over their best local neighbour too.  Only keep the first       */
+/*      occurrence of each neighbour.                                   */
+/* -------------------------------------------------------------------- */
+    for( int iPiece = 0; iPiece < nPieces; iPiece++ )
+    {
+        if( !abHasSeamNeighbour[iPiece] )
+            continue;
+        if( anBig[iPiece] >= 0 )
+        {
+            SieveNeighbour sNeighbour;
+            sNeighbour.nPiece = iPiece;
+            sNeighbour.nNeighbour = anBig[iPiece];
+            sNeighbour.nPos = anBigPos[iPiece];
+            psJob->asNeighbours.push_back( sNeighbour );
+            anBig[iPiece] = -1;
+        }
+    }
+
+    std::vector<SieveNeighbour> &asNeighbours = psJob->asNeighbours;
+    std::sort( asNeighbours.begin(), asNeighbours.end(),
+               []( const SieveNeighbour& a, const SieveNeighbour& b )
+               {
+                   if( a.nPiece != b.nPiece )
+                       return a.nPiece < b.nPiece;
+                   if( a.nNeighbour != b.nNeighbour )
+                       return a.nNeighbour < b.nNeighbour;
+                   return a.nPos < b.nPos;
+               } );
+    asNeighbours.erase(
+        std::unique( asNeighbours.begin(), asNeighbours.end(),
+                     []( const SieveNeighbour& a, const SieveNeighbour& b )
+                     {
+                         return a.nPiece == b.nPiece &&
+                                a.nNeighbour == b.nNeighbour;
+                     } ),
+        asNeighbours.end() );
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                        SieveWriteStripJob()                          */
+/*                                                                      */
+/*      Last pass over a strip: label it again, and write the final     */
+/*      value of the piece of each pixel.                               */
+/************************************************************************/
+
+static CPLErr SieveWriteStripJob( SieveStripJob *psJob )
+
+{
+    SieveStripContext *psContext = psJob->psContext;
+    if( SieveCheckStopped(psContext) )
+        return CE_Failure;
+
+    const int nXSize = psContext->nXSize;
+    const int nLines = psJob->nLines;
+    const size_t nPixels = static_cast<size_t>(nXSize) * nLines;
+
+    std::unique_ptr<GInt32, CPLFreeReleaser> panValHolder(
+        static_cast<GInt32 *>(
+            VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nLines)));
+    std::unique_ptr<GInt32, CPLFreeReleaser> panIdHolder(
+        static_cast<GInt32 *>(
+            VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nLines)));
+    std::unique_ptr<GInt32, CPLFreeReleaser> panWriteValHolder(
+        static_cast<GInt32 *>(
+            VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nLines)));
+    if( panValHolder == nullptr || panIdHolder == nullptr ||
+        panWriteValHolder == nullptr )
+        return CE_Failure;
+    GInt32 *panVal = panValHolder.get();
+    GInt32 *panId = panIdHolder.get();
+    GInt32 *panWriteVal = panWriteValHolder.get();
+
+    CPLErr eErr = SieveReadStrip( psContext, psJob->iYStart, nLines,
+                                  panVal, panWriteVal );
+    if( eErr != CE_None )
+        return eErr;
+
+    std::vector<GInt32> anPieceValue;
+    SieveLabelStrip( psContext->nConnectedness, nXSize, nLines,
+                     panVal, panId, anPieceValue );
+
+    const GInt32 *panNewValue = psContext->panPieceValue->data() +
+                                psJob->nOffset;
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        if( panId[i] >= 0 )
+            panWriteVal[i] = panNewValue[panId[i]];
+    }
+
+    std::lock_guard<std::mutex> oLock(psContext->oIOMutex);
+    return GDALRasterIO( psContext->hDstBand, GF_Write,
+                         0, psJob->iYStart, nXSize, nLines,
+                         panWriteVal, nXSize, nLines, GDT_Int32, 0, 0 );
+}
+
+/************************************************************************/
+/*                         SieveStripJobFunc()                          */
+/************************************************************************/
+
+template<CPLErr (*pfnProcess)(SieveStripJob *)>
+static void SieveStripJobFunc( void *pData )
+
+{
+    SieveStripJob *psJob = static_cast<SieveStripJob *>(pData);
+    SieveStripContext *psContext = psJob->psContext;
+
+    const CPLErr eErr = pfnProcess(psJob);
+
+    std::lock_guard<std::mutex> oLock(psContext->oMutex);
+    psJob->eErr = eErr;
+    psJob->bDone = true;
+}
+
+/************************************************************************/
+/*                          SieveRunStrips()                            */
+/*                                                                      */
+/*      Run a job on each strip with the worker threads, and hand       */
+/*      over the completed jobs to pfnConsume in strip order.           */
+/************************************************************************/
+
+static CPLErr
+SieveRunStrips( CPLJobQueue *poJobQueue, SieveStripContext &oContext,
+                int nYSize, int nStripHeight, CPLThreadFunc pfnJobFunc,
+                const std::function<CPLErr(SieveStripJob *)> &pfnConsume,
+                const std::vector<int> &anOffsets,
+                double dfProgressStart, double dfProgressEnd,
+                GDALProgressFunc pfnProgress, void *pProgressArg )
+
+{
+    const int nStrips =
+        nYSize / nStripHeight + ((nYSize % nStripHeight) != 0 ? 1 : 0);
+    const int nMaxJobsInFlight = 2 * oContext.nThreads;
+    std::vector<std::unique_ptr<SieveStripJob>> apoJobs(nStrips);
+
+    oContext.bStop = false;
+    CPLErr eErr = CE_None;
+    int iNextJob = 0;
+
+    for( int iStrip = 0; eErr == CE_None && iStrip < nStrips; iStrip++ )
+    {
+        for( ; iNextJob < nStrips && iNextJob < iStrip + nMaxJobsInFlight;
+             iNextJob++ )
+        {
+            apoJobs[iNextJob].reset(new SieveStripJob());
+            SieveStripJob *psNewJob = apoJobs[iNextJob].get();
+            psNewJob->psContext = &oContext;
+            psNewJob->iYStart = iNextJob * nStripHeight;
+            psNewJob->nLines =
+                std::min(nStripHeight, nYSize - psNewJob->iYStart);
+            psNewJob->bFirst = iNextJob == 0;
+            psNewJob->bLast = iNextJob == nStrips - 1;
+            if( !anOffsets.empty() )
+                psNewJob->nOffset = anOffsets[iNextJob];
+            if( !poJobQueue->SubmitJob( pfnJobFunc, psNewJob ) )
+                pfnJobFunc( psNewJob );
+        }
+
+        SieveStripJob *psJob = apoJobs[iStrip].get();
+        {
+            // Wait until the jobs still running are the later ones; a
+            // worker thread runs queued jobs meanwhile.
+            std::unique_lock<std::mutex> oLock(oContext.oMutex);
+            while( !psJob->bDone )
+            {
+                int nLaterJobs = 0;
+                for( int i = iStrip + 1; i < iNextJob; i++ )
+                {
+                    if( !apoJobs[i]->bDone )
+                        nLaterJobs++;
+                }
+                oLock.unlock();
+                poJobQueue->WaitCompletion(nLaterJobs);
+                oLock.lock();
+            }
+        }
+
+        eErr = psJob->eErr;
+        if( eErr == CE_None )
+            eErr = pfnConsume(psJob);
+        apoJobs[iStrip].reset();
+
+        if( eErr == CE_None &&
+            !pfnProgress( dfProgressStart + (dfProgressEnd - dfProgressStart) *
+                              ((iStrip + 1) / static_cast<double>(nStrips)),
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> oLock(oContext.oMutex);
+        oContext.bStop = true;
+    }
+    poJobQueue->WaitCompletion();
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                           SieveFindRoot()                            */
+/************************************************************************/
+
+static int SieveFindRoot( std::vector<int> &anParent, int i )
+{
+    while( anParent[i] != i )
+    {
+        anParent[i] = anParent[anParent[i]];
+        i = anParent[i];
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                        GDALSieveFilterStrips()                       */
+/************************************************************************/
+
+static CPLErr
+GDALSieveFilterStrips( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
+                       GDALRasterBandH hDstBand,
+                       int nSizeThreshold, int nConnectedness,
+                       int nThreads, int nStripHeight,
+                       GDALProgressFunc pfnProgress,
+                       void * pProgressArg )
+
+{
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+
+    CPLWorkerThreadPool *poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+    if( poPool == nullptr )
+        return CE_Failure;
+    auto poJobQueue = poPool->CreateJobQueue();
+
+    SieveStripContext oContext;
+    oContext.hSrcBand = hSrcBand;
+    oContext.hMaskBand = hMaskBand;
+    oContext.hDstBand = hDstBand;
+    oContext.nXSize = nXSize;
+    oContext.nConnectedness = nConnectedness;
+    oContext.nSizeThreshold = nSizeThreshold;
+    oContext.nThreads = nThreads;
+
+/* ==================================================================== */
+/*      First pass: label the strips, and merge the pieces crossing     */
+/*      the seams.  Sizes are accumulated on the union-find roots.      */
+/* ==================================================================== */
+    std::vector<int>            anSize;
+    std::vector<GInt32>         anValue;
+    std::vector<int>            anParent;
+    std::vector<int>            anBigNeighbour;
+    std::vector<SieveNeighbour> asNeighbours;
+    std::vector<int>            anOffsets;
+
+    std::vector<GInt32> anPrevBottomVal;
+    std::vector<int>    anPrevBottomPiece;
+
+    const auto Union = [&]( int i, int j )
+    {
+        int iRoot = SieveFindRoot(anParent, i);
+        int jRoot = SieveFindRoot(anParent, j);
+        if( iRoot == jRoot )
+            return;
+        if( jRoot < iRoot )
+            std::swap(iRoot, jRoot);
+        anParent[jRoot] = iRoot;
+        anSize[iRoot] = static_cast<int>(std::min(
+            static_cast<GIntBig>(MY_MAX_INT),
+            static_cast<GIntBig>(anSize[iRoot]) + anSize[jRoot]));
+    };
+
+    const auto AddNeighbour = [&]( int nPiece, int nOther, GIntBig nPos )
+    {
+        if( anSize[nPiece] >= nSizeThreshold )
+            return;
+        SieveNeighbour sNeighbour;
+        sNeighbour.nPiece = nPiece;
+        sNeighbour.nNeighbour = nOther;
+        sNeighbour.nPos = nPos;
+        asNeighbours.push_back( sNeighbour );
+    };
+
+    const auto ConsumeLabels = [&]( SieveStripJob *psJob )
+    {
+        const GIntBig nTotal =
+            static_cast<GIntBig>(anSize.size()) + psJob->anSize.size();
+        if( nTotal > MY_MAX_INT )
+        {
+            CPLError( CE_Failure, CPLE_NotSupported,
+                      "Too many polygons in GDALSieveFilter()" );
+            return CE_Failure;
+        }
+
+        const int nOffset = static_cast<int>(anSize.size());
+        anOffsets.push_back( nOffset );
+        const int nPieces = static_cast<int>(psJob->anSize.size());
+        for( int i = 0; i < nPieces; i++ )
+        {
+            anSize.push_back( psJob->anSize[i] );
+            anValue.push_back( psJob->anValue[i] );
+            anParent.push_back( nOffset + i );
+            anBigNeighbour.push_back( psJob->anBigNeighbour[i] >= 0 ?
+                nOffset + psJob->anBigNeighbour[i] : -1 );
+        }
+        for( const auto& sNeighbour: psJob->asNeighbours )
+        {
+            SieveNeighbour sGlobal = sNeighbour;
+            sGlobal.nPiece += nOffset;
+            sGlobal.nNeighbour += nOffset;
+            asNeighbours.push_back( sGlobal );
+        }
+
+        if( !psJob->bFirst )
+        {
+/* -------------------------------------------------------------------- */
+/*      Pixels on both sides of the seam with the same value belong     */
+/*      to the same polygon.  Other pairs are neighbours.               */
+/* -------------------------------------------------------------------- */
+            const GIntBig nRowPos =
+                static_cast<GIntBig>(psJob->iYStart) * nXSize;
+            const auto SeamPair = [&]( int iAbove, int iBelow, GIntBig nPos )
+            {
+                const int nAbove = anPrevBottomPiece[iAbove];
+                const int nBelow = psJob->anTopPiece[iBelow];
+                if( nAbove < 0 || nBelow < 0 )
+                    return;
+                if( anPrevBottomVal[iAbove] == psJob->anTopVal[iBelow] )
+                {
+                    Union( nAbove, nOffset + nBelow );
+                }
+                else
+                {
+                    AddNeighbour( nOffset + nBelow, nAbove, nPos );
+                    AddNeighbour( nAbove, nOffset + nBelow, nPos );
+                }
+            };
+
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                const GIntBig nPos = (nRowPos + iX) * 4;
+                SeamPair( iX, iX, nPos );
+                if( iX > 0 && nConnectedness == 8 )
+                    SeamPair( iX - 1, iX, nPos + 1 );
+                if( iX < nXSize-1 && nConnectedness == 8 )
+                    SeamPair( iX + 1, iX, nPos + 2 );
+            }
+        }
+
+        anPrevBottomVal = std::move(psJob->anBottomVal);
+        anPrevBottomPiece = std::move(psJob->anBottomPiece);
+        for( int& nPiece: anPrevBottomPiece )
+        {
+            if( nPiece >= 0 )
+                nPiece += nOffset;
+        }
+
+        return CE_None;
+    };
+
+    CPLErr eErr = SieveRunStrips(
+        poJobQueue.get(), oContext, nYSize, nStripHeight,
+        SieveStripJobFunc<SieveLabelStripJob>, ConsumeLabels,
+        std::vector<int>(), 0.0, 0.5, pfnProgress, pProgressArg );
+    if( eErr != CE_None )
+        return eErr;
+
+    anPrevBottomVal.clear();
+    anPrevBottomPiece.clear();
+
+    const int nPieces = static_cast<int>(anSize.size());
+
+/* -------------------------------------------------------------------- */
+/*      Resolve the neighbours involving seam pieces now that the       */
+/*      polygon sizes are known.                                        */
+/* -------------------------------------------------------------------- */
+    std::vector<GIntBig> anBigNeighbourPos;
+    for( const auto& sNeighbour: asNeighbours )
+    {
+        const int nRoot = SieveFindRoot(anParent, sNeighbour.nPiece);
+        const int nOther = SieveFindRoot(anParent, sNeighbour.nNeighbour);
+        if( nRoot == nOther || anSize[nRoot] >= nSizeThreshold )
+            continue;
+
+        if( anBigNeighbourPos.empty() )
+            anBigNeighbourPos.resize( nPieces, 0 );
+
+        const int nBig = anBigNeighbour[nRoot];
+        if( nBig == -1 ||
+            anSize[nBig] < anSize[nOther] ||
+            (anSize[nBig] == anSize[nOther] &&
+             sNeighbour.nPos < anBigNeighbourPos[nRoot]) )
+        {
+            anBigNeighbour[nRoot] = nOther;
+            anBigNeighbourPos[nRoot] = sNeighbour.nPos;
+        }
+    }
+    asNeighbours.clear();
+    asNeighbours.shrink_to_fit();
+    anBigNeighbourPos.clear();
+    anBigNeighbourPos.shrink_to_fit();
+
+/* -------------------------------------------------------------------- */
+/*      If our biggest neighbour is still smaller than the              */
+/*      threshold, then try tracking to that polygons biggest           */
+/*      neighbour, and so forth.                                        */
+/* -------------------------------------------------------------------- */
+    int nFailedMerges = 0;
+    int nIsolatedSmall = 0;
+    int nSieveTargets = 0;
+
+    for( int iPoly = 0; iPoly < nPieces; iPoly++ )
+    {
+        if( SieveFindRoot(anParent, iPoly) != iPoly )
+            continue;
+
+        // Don't try to merge polygons larger than the threshold.
+        if( anSize[iPoly] >= nSizeThreshold )
+        {
+            anBigNeighbour[iPoly] = -1;
+            continue;
+        }
+
+        nSieveTargets++;
+
+        // if we have no neighbours but we are small, what shall we do?
+        if( anBigNeighbour[iPoly] == -1 )
+        {
+            nIsolatedSmall++;
+            continue;
+        }
+
+        std::set<int> oSetVisitedPoly;
+        oSetVisitedPoly.insert(iPoly);
+
+        // Walk through our neighbours until we find a polygon large enough.
+        int iFinalId = iPoly;
+        bool bFoundBigEnoughPoly = false;
+        while( true )
+        {
+            iFinalId = anBigNeighbour[iFinalId];
+            if( iFinalId < 0 )
+            {
+                break;
+            }
+            // If the biggest neighbour is larger than the threshold
+            // then we are golden.
+            if( anSize[iFinalId] >= nSizeThreshold )
+            {
+                bFoundBigEnoughPoly = true;
+                break;
+            }
+            // Check that we don't cycle on an already visited polygon.
+            if( oSetVisitedPoly.find(iFinalId) != oSetVisitedPoly.end() )
+                break;
+            oSetVisitedPoly.insert(iFinalId);
+        }
+
+        if( !bFoundBigEnoughPoly )
+        {
+            nFailedMerges++;
+            anBigNeighbour[iPoly] = -1;
+            continue;
+        }
+
+        // Map the whole intermediate chain to it.
+        int iPolyCur = iPoly;
+        while( anBigNeighbour[iPolyCur] != iFinalId )
+        {
+            int iNextPoly = anBigNeighbour[iPolyCur];
+            anBigNeighbour[iPolyCur] = iFinalId;
+            iPolyCur = iNextPoly;
+        }
+    }
+
+    CPLDebug( "GDALSieveFilter",
+              "Small Polygons: %d, Isolated: %d, Unmergable: %d",
+              nSieveTargets, nIsolatedSmall, nFailedMerges );
+
+/* -------------------------------------------------------------------- */
+/*      Compute the final value of every piece.  Merge targets are      */
+/*      large polygons, whose value is left untouched.                  */
+/* -------------------------------------------------------------------- */
+    for( int iPiece = 0; iPiece < nPieces; iPiece++ )
+    {
+        const int nTarget =
+            anBigNeighbour[SieveFindRoot(anParent, iPiece)];
+        if( nTarget >= 0 )
+            anValue[iPiece] = anValue[nTarget];
+    }
+
+    std::vector<int>().swap(anSize);
+    std::vector<int>().swap(anParent);
+    std::vector<int>().swap(anBigNeighbour);
+
+/* ==================================================================== */
+/*      Last pass, writing the strips.                                  */
+/* ==================================================================== */
+    oContext.panPieceValue = &anValue;
+
+    return SieveRunStrips(
+        poJobQueue.get(), oContext, nYSize, nStripHeight,
+        SieveStripJobFunc<SieveWriteStripJob>,
+        []( SieveStripJob * ) { return CE_None; },
+        anOffsets, 0.5, 1.0, pfnProgress, pProgressArg );
+}
+
 /************************************************************************/
 /*                          GDALSieveFilter()                           */
 /************************************************************************/
@@ -177,6 +1024,13 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
  * extremely noisy rasters with many one pixel polygons will end up being
  * expensive (in memory) to process.
  *
+ * When the NUM_THREADS option is set, the raster is instead processed by
+ * strips in worker threads, and polygons are merged across the strip
+ * boundaries.  Only the final polygon pieces are then accounted (roughly
+ * 16 bytes each), rather than every polygon fragment met during the
+ * enumeration, and the pixel to polygon maps only exist for the strips
+ * being processed.  The result is the same as with the default algorithm.
+ *
  * @param hSrcBand the source raster band to be processed.
  * @param hMaskBand an optional mask band.  All pixels in the mask band with a
  * value other than zero will be considered suitable for inclusion in polygons.
@@ -187,8 +1041,13 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
  * @param nConnectedness either 4 indicating that diagonal pixels are not
  * considered directly adjacent for polygon membership purposes or 8
  * indicating they are.
- * @param papszOptions algorithm options in name=value list form.  None
- * currently supported.
+ * @param papszOptions algorithm options in name=value list form.
+ * <ul>
+ * <li>NUM_THREADS=number_of_threads or ALL_CPUS: (GDAL >= 3.1) process
+ * the raster by strips with that number of worker threads.</li>
+ * <li>STRIP_HEIGHT=number_of_lines: (GDAL >= 3.1) height of the strips
+ * when NUM_THREADS is set.  Defaults to 256.</li>
+ * </ul>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
  * @param pProgressArg callback argument passed to pfnProgress.
@@ -200,7 +1059,7 @@ CPLErr CPL_STDCALL
 GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
                  GDALRasterBandH hDstBand,
                  int nSizeThreshold, int nConnectedness,
-                 CPL_UNUSED char **papszOptions,
+                 char **papszOptions,
                  GDALProgressFunc pfnProgress,
                  void * pProgressArg )
 {
@@ -210,6 +1069,30 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
     if( pfnProgress == nullptr )
         pfnProgress = GDALDummyProgress;
 
+/* -------------------------------------------------------------------- */
+/*      Use the strip based algorithm if multithreading was requested.  */
+/* -------------------------------------------------------------------- */
+    const char* pszNumThreads = CSLFetchNameValue(papszOptions, "NUM_THREADS");
+    if( pszNumThreads != nullptr && GDALGetRasterBandYSize(hSrcBand) > 0 )
+    {
+        const int nThreads = CPLGetNumThreads(papszOptions);
+
+        const int nStripHeight = atoi(
+            CSLFetchNameValueDef(papszOptions, "STRIP_HEIGHT", "256"));
+        if( nStripHeight < 1 )
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "Invalid value for STRIP_HEIGHT: %s",
+                     CSLFetchNameValue(papszOptions, "STRIP_HEIGHT"));
+            return CE_Failure;
+        }
+
+        return GDALSieveFilterStrips( hSrcBand, hMaskBand, hDstBand,
+                                      nSizeThreshold, nConnectedness,
+                                      nThreads, nStripHeight,
+                                      pfnProgress, pProgressArg );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Allocate working buffers.                                       */
 /* -------------------------------------------------------------------- */
@@ -42,6 +42,11 @@
 #include <cstring>
 
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -936,6 +941,240 @@ GDALSuggestedWarpOutput2( GDALDatasetH hSrcDS,
 /* ==================================================================== */
 /************************************************************************/
 
+/************************************************************************/
+/*                        GDALGenImgProjDstGrid                         */
+/************************************************************************/
+
+// Lattice of destination pixel/line coordinates every nStep pixels,
+// transformed exactly to source pixel/line coordinates. It is shared by a
+// transformer and its clones, so that all the chunks and threads of a warp
+// reuse the nodes already computed. Nodes are computed lazily, the first
+// time a point of one of their cells is transformed.
+struct GDALGenImgProjDstGridCache
+{
+    struct Node
+    {
+        double dfX;
+        double dfY;
+        bool   bOK;
+    };
+
+    explicit GDALGenImgProjDstGridCache( int nStepIn ): nStep(nStepIn) {}
+    ~GDALGenImgProjDstGridCache();
+
+    GDALGenImgProjDstGridCache(const GDALGenImgProjDstGridCache&) = delete;
+    GDALGenImgProjDstGridCache& operator= (const GDALGenImgProjDstGridCache&) = delete;
+
+    const int                          nStep;
+    std::mutex                         oMutex{};
+    std::unordered_map<GUInt64, Node>  oMapNodes{};
+
+    // Persistence in DST_COORD_GRID_FILE.
+    CPLString                          osFilename{};
+    CPLString                          osSignature{};
+    bool                               bDirty = false;
+
+    void Load();
+    void Save();
+};
+
+// Per transformer state: the shared lattice, and scratch buffers reused
+// from one call to the other.
+struct GDALGenImgProjDstGrid
+{
+    std::shared_ptr<GDALGenImgProjDstGridCache> poCache{};
+
+    std::vector<GUInt64> anKeys{};
+    std::vector<int>     anIndices{};
+    std::vector<double>  adfX{};
+    std::vector<double>  adfY{};
+    std::vector<double>  adfZ{};
+    std::vector<int>     anSuccess{};
+};
+
+static GDALGenImgProjDstGrid* GDALCreateGenImgProjDstGrid( int nStep )
+{
+    GDALGenImgProjDstGrid* psGrid = new GDALGenImgProjDstGrid();
+    psGrid->poCache = std::make_shared<GDALGenImgProjDstGridCache>(nStep);
+    return psGrid;
+}
+
+static GUInt64 GDALGenImgProjGridKey( int iX, int iY )
+{
+    return (static_cast<GUInt64>(static_cast<GUInt32>(iX)) << 32) |
+           static_cast<GUInt32>(iY);
+}
+
+/************************************************************************/
+/*                 GDALGenImgProjDstGridCache::Load()                   */
+/************************************************************************/
+
+// File layout of DST_COORD_GRID_FILE (little endian):
+//   8 bytes  signature "GDALDCG1"
+//   int32    lattice step, in destination pixels
+//   uint32   length of the transformer signature, then its bytes
+//   uint64   number of nodes, then for each node:
+//            int32 node x index, int32 node y index,
+//            float64 source x, float64 source y (NaN if failed)
+
+constexpr const char GDAL_DST_COORD_GRID_MAGIC[] = "GDALDCG1";
+constexpr size_t GDAL_DST_COORD_GRID_NODE_SIZE = 2 * 4 + 2 * 8;
+
+void GDALGenImgProjDstGridCache::Load()
+{
+    GByte* pabyData = nullptr;
+    vsi_l_offset nSize = 0;
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    const int bIngested =
+        VSIIngestFile(nullptr, osFilename, &pabyData, &nSize, -1);
+    CPLPopErrorHandler();
+    CPLErrorReset();
+    if( !bIngested )
+        return;
+
+    const size_t nHeaderSize = 8 + 4 + 4;
+    bool bOK = nSize >= nHeaderSize &&
+               memcmp(pabyData, GDAL_DST_COORD_GRID_MAGIC, 8) == 0;
+    GInt32 nFileStep = 0;
+    GUInt32 nSignatureLen = 0;
+    if( bOK )
+    {
+        memcpy(&nFileStep, pabyData + 8, 4);
+        CPL_LSBPTR32(&nFileStep);
+        memcpy(&nSignatureLen, pabyData + 12, 4);
+        CPL_LSBPTR32(&nSignatureLen);
+        bOK = nFileStep == nStep &&
+              nSignatureLen == osSignature.size() &&
+              nSize >= nHeaderSize + nSignatureLen + 8 &&
+              memcmp(pabyData + nHeaderSize, osSignature.c_str(),
+                     nSignatureLen) == 0;
+    }
+    GUInt64 nNodes = 0;
+    const GByte* pabyNodes = pabyData + nHeaderSize + nSignatureLen + 8;
+    if( bOK )
+    {
+        memcpy(&nNodes, pabyNodes - 8, 8);
+        CPL_LSBPTR64(&nNodes);
+        bOK = nNodes <= (nSize - (nHeaderSize + nSignatureLen + 8)) /
+                            GDAL_DST_COORD_GRID_NODE_SIZE;
+    }
+    if( !bOK )
+    {
+        CPLDebug("GDAL", "Ignoring %s: not matching this transformer",
+                 osFilename.c_str());
+        CPLFree(pabyData);
+        return;
+    }
+
+    oMapNodes.reserve(static_cast<size_t>(nNodes));
+    for( GUInt64 i = 0; i < nNodes; i++ )
+    {
+        const GByte* pabyNode = pabyNodes + i * GDAL_DST_COORD_GRID_NODE_SIZE;
+        GInt32 iX = 0;
+        GInt32 iY = 0;
+        Node sNode;
+        memcpy(&iX, pabyNode, 4);
+        CPL_LSBPTR32(&iX);
+        memcpy(&iY, pabyNode + 4, 4);
+        CPL_LSBPTR32(&iY);
+        memcpy(&sNode.dfX, pabyNode + 8, 8);
+        CPL_LSBPTR64(&sNode.dfX);
+        memcpy(&sNode.dfY, pabyNode + 16, 8);
+        CPL_LSBPTR64(&sNode.dfY);
+        sNode.bOK = !CPLIsNan(sNode.dfX);
+        oMapNodes[GDALGenImgProjGridKey(iX, iY)] = sNode;
+    }
+    CPLFree(pabyData);
+    CPLDebug("GDAL", "Loaded " CPL_FRMT_GUIB " lattice nodes from %s",
+             nNodes, osFilename.c_str());
+}
+
+/************************************************************************/
+/*                 GDALGenImgProjDstGridCache::Save()                   */
+/************************************************************************/
+
+void GDALGenImgProjDstGridCache::Save()
+{
+    std::vector<GByte> abyData(8);
+    memcpy(&abyData[0], GDAL_DST_COORD_GRID_MAGIC, 8);
+    const auto AppendInt32 = [&abyData](GUInt32 nVal)
+    {
+        CPL_LSBPTR32(&nVal);
+        const GByte* pabyVal = reinterpret_cast<const GByte*>(&nVal);
+        abyData.insert(abyData.end(), pabyVal, pabyVal + 4);
+    };
+    const auto AppendFloat64 = [&abyData](double dfVal)
+    {
+        CPL_LSBPTR64(&dfVal);
+        const GByte* pabyVal = reinterpret_cast<const GByte*>(&dfVal);
+        abyData.insert(abyData.end(), pabyVal, pabyVal + 8);
+    };
+
+    AppendInt32(static_cast<GUInt32>(nStep));
+    AppendInt32(static_cast<GUInt32>(osSignature.size()));
+    abyData.insert(abyData.end(), osSignature.begin(), osSignature.end());
+    GUInt64 nNodes = oMapNodes.size();
+    CPL_LSBPTR64(&nNodes);
+    const GByte* pabyNodes = reinterpret_cast<const GByte*>(&nNodes);
+    abyData.insert(abyData.end(), pabyNodes, pabyNodes + 8);
+    abyData.reserve(abyData.size() +
+                    oMapNodes.size() * GDAL_DST_COORD_GRID_NODE_SIZE);
+    for( const auto& oIter: oMapNodes )
+    {
+        AppendInt32(static_cast<GUInt32>(oIter.first >> 32));
+        AppendInt32(static_cast<GUInt32>(oIter.first));
+        AppendFloat64(oIter.second.bOK ? oIter.second.dfX :
+                      std::numeric_limits<double>::quiet_NaN());
+        AppendFloat64(oIter.second.dfY);
+    }
+
+    // Write to a temporary file first, so that concurrent runs only ever
+    // see complete files.
+    const CPLString osTmpFilename(
+        CPLSPrintf("%s.%p.tmp", osFilename.c_str(), this));
+    VSILFILE* fp = VSIFOpenL(osTmpFilename, "wb");
+    bool bOK = fp != nullptr &&
+               VSIFWriteL(&abyData[0], abyData.size(), 1, fp) == 1;
+    if( fp != nullptr && VSIFCloseL(fp) != 0 )
+        bOK = false;
+    if( bOK )
+        bOK = VSIRename(osTmpFilename, osFilename) == 0;
+    if( !bOK )
+    {
+        VSIUnlink(osTmpFilename);
+        CPLError(CE_Warning, CPLE_FileIO, "Cannot write %s",
+                 osFilename.c_str());
+    }
+}
+
+/************************************************************************/
+/*                    ~GDALGenImgProjDstGridCache()                     */
+/************************************************************************/
+
+GDALGenImgProjDstGridCache::~GDALGenImgProjDstGridCache()
+{
+    if( bDirty && !osFilename.empty() )
+        Save();
+}
+
+// Return the cell of the lattice containing a destination point, or false
+// if the point must be transformed exactly.
+static bool GDALGenImgProjGridCell( int nStep, double dfX, double dfY,
+                                    const double* pdfZ,
+                                    int* piCellX, int* piCellY )
+{
+    if( pdfZ != nullptr && *pdfZ != 0.0 )
+        return false;
+    const double dfCellX = floor(dfX / nStep);
+    const double dfCellY = floor(dfY / nStep);
+    // Also rejects NaN and HUGE_VAL.
+    if( !(fabs(dfCellX) < 1e8) || !(fabs(dfCellY) < 1e8) )
+        return false;
+    *piCellX = static_cast<int>(dfCellX);
+    *piCellY = static_cast<int>(dfCellY);
+    return true;
+}
+
 typedef struct {
 
     GDALTransformerInfo sTI;
@@ -955,8 +1194,41 @@ typedef struct {
     void     *pDstTransformArg;
     GDALTransformerFunc pDstTransformer;
 
+    // Only set when the DST_COORD_GRID_STEP option is used.
+    GDALGenImgProjDstGrid *psDstGrid;
+
 } GDALGenImgProjTransformInfo;
 
+/************************************************************************/
+/*                   GDALGenImgProjSetupDstGrid()                       */
+/************************************************************************/
+
+// Install the lattice of DST_COORD_GRID_STEP on a fully initialized
+// transformer, loading it from pszFilename (DST_COORD_GRID_FILE) if this
+// file was created by an identical transformer.
+static void GDALGenImgProjSetupDstGrid( GDALGenImgProjTransformInfo *psInfo,
+                                        int nStep, const char* pszFilename )
+{
+    CPLAssert( psInfo->psDstGrid == nullptr );
+    GDALGenImgProjDstGrid* psGrid = GDALCreateGenImgProjDstGrid(nStep);
+    if( pszFilename != nullptr && pszFilename[0] != '\0' )
+    {
+        // The serialized transformer (SRS, geotransforms, GCPs, ...)
+        // identifies the transformation the file was computed with.
+        CPLXMLNode* psTree = GDALSerializeGenImgProjTransformer(psInfo);
+        char* pszSignature = psTree ? CPLSerializeXMLTree(psTree) : nullptr;
+        CPLDestroyXMLNode(psTree);
+        if( pszSignature != nullptr )
+        {
+            psGrid->poCache->osFilename = pszFilename;
+            psGrid->poCache->osSignature = pszSignature;
+            psGrid->poCache->Load();
+        }
+        CPLFree(pszSignature);
+    }
+    psInfo->psDstGrid = psGrid;
+}
+
 /************************************************************************/
 /*                GDALCreateSimilarGenImgProjTransformer()              */
 /************************************************************************/
@@ -1015,6 +1287,22 @@ GDALCreateSimilarGenImgProjTransformer( void *hTransformArg,
         psClonedInfo->pDstTransformArg =
             GDALCloneTransformer( psInfo->pDstTransformArg );
 
+    if( psInfo->psDstGrid )
+    {
+        // The lattice holds source pixel coordinates, so it can only be
+        // shared if the source pixel space is unchanged.
+        if( dfRatioX == 1.0 && dfRatioY == 1.0 )
+        {
+            psClonedInfo->psDstGrid = new GDALGenImgProjDstGrid();
+            psClonedInfo->psDstGrid->poCache = psInfo->psDstGrid->poCache;
+        }
+        else
+        {
+            psClonedInfo->psDstGrid = GDALCreateGenImgProjDstGrid(
+                psInfo->psDstGrid->poCache->nStep);
+        }
+    }
+
     return psClonedInfo;
 }
 
@@ -1443,6 +1731,22 @@ bool GDALComputeAreaOfInterest(OGRSpatialReference* poSRS,
  * (GDAL &gt;= 2.5) Area of interest, used to compute the best coordinate operation
  * between the source and target SRS. If not specified, the bounding box of the
  * source raster will be used.
+ * <li> DST_COORD_GRID_STEP=step_in_pixels. (GDAL &gt;= 3.1) Compute
+ * destination to source transformations by bilinear interpolation in a
+ * lattice of points transformed exactly every step_in_pixels destination
+ * pixels. The lattice nodes are computed lazily and shared with the clones of
+ * the transformer, so the chunks and threads of a warp reuse them, and
+ * repeated warps to the same destination grid with the same transformer skip
+ * most of the coordinate reprojections. This adds an interpolation error,
+ * like an approximate transformer but without error control, so the step
+ * should be small compared to the scale of the non-linearities of the
+ * transformation. Disabled by default.
+ * <li> DST_COORD_GRID_FILE=filename. (GDAL &gt;= 3.1) Only used together with
+ * DST_COORD_GRID_STEP. File where the lattice is saved when the transformer
+ * (and all its clones) are destroyed, and from which it is reloaded by later
+ * transformers with the same step, SRS, geotransforms and other parameters,
+ * avoiding to recompute the coordinate reprojections. A file created by a
+ * different transformation is ignored and overwritten.
  * </ul>
  *
  * The use case for the *_APPROX_ERROR_* options is when defining an approximate
@@ -1994,6 +2298,18 @@ GDALCreateGenImgProjTransformer2( GDALDatasetH hSrcDS, GDALDatasetH hDstDS,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Lattice of cached destination to source transformations.        */
+/* -------------------------------------------------------------------- */
+    const char* pszGridStep =
+        CSLFetchNameValue( papszOptions, "DST_COORD_GRID_STEP" );
+    if( pszGridStep != nullptr && atoi(pszGridStep) > 0 )
+    {
+        GDALGenImgProjSetupDstGrid(
+            psInfo, atoi(pszGridStep),
+            CSLFetchNameValue( papszOptions, "DST_COORD_GRID_FILE" ));
+    }
+
     return psInfo;
 }
 
@@ -2274,34 +2590,24 @@ void GDALDestroyGenImgProjTransformer( void *hTransformArg )
     if( psInfo->pReprojectArg != nullptr )
         GDALDestroyTransformer( psInfo->pReprojectArg );
 
+    delete psInfo->psDstGrid;
+
     CPLFree( psInfo );
 }
 
-/************************************************************************/
-/*                      GDALGenImgProjTransform()                       */
-/************************************************************************/
-
-/**
- * Perform general image reprojection transformation.
- *
- * Actually performs the transformation setup in
- * GDALCreateGenImgProjTransformer().  This function matches the signature
- * required by the GDALTransformerFunc(), and more details on the arguments
- * can be found in that topic.
- */
-
 #ifdef DEBUG_APPROX_TRANSFORMER
 int countGDALGenImgProjTransform = 0;
 #endif
 
-int GDALGenImgProjTransform( void *pTransformArgIn, int bDstToSrc,
-                             int nPointCount,
-                             double *padfX, double *padfY, double *padfZ,
-                             int *panSuccess )
-{
-    GDALGenImgProjTransformInfo *psInfo =
-        static_cast<GDALGenImgProjTransformInfo *>(pTransformArgIn);
+/************************************************************************/
+/*                    GDALGenImgProjTransformExact()                    */
+/************************************************************************/
 
+static int GDALGenImgProjTransformExact( GDALGenImgProjTransformInfo *psInfo,
+                                         int bDstToSrc, int nPointCount,
+                                         double *padfX, double *padfY,
+                                         double *padfZ, int *panSuccess )
+{
 #ifdef DEBUG_APPROX_TRANSFORMER
     CPLAssert(nPointCount > 0);
     countGDALGenImgProjTransform += nPointCount;
@@ -2415,6 +2721,197 @@ int GDALGenImgProjTransform( void *pTransformArgIn, int bDstToSrc,
     return TRUE;
 }
 
+/************************************************************************/
+/*                 GDALGenImgProjTransformWithDstGrid()                 */
+/************************************************************************/
+
+// Destination to source transformation, by bilinear interpolation in the
+// lattice of DST_COORD_GRID_STEP. Points whose cell has a corner that could
+// not be transformed are transformed exactly.
+static int GDALGenImgProjTransformWithDstGrid(
+    GDALGenImgProjTransformInfo *psInfo, int nPointCount,
+    double *padfX, double *padfY, double *padfZ, int *panSuccess )
+{
+    GDALGenImgProjDstGrid* psGrid = psInfo->psDstGrid;
+    GDALGenImgProjDstGridCache* poCache = psGrid->poCache.get();
+    const int nStep = poCache->nStep;
+
+/* -------------------------------------------------------------------- */
+/*      Collect the nodes not computed yet, and compute them in a       */
+/*      single call.                                                    */
+/* -------------------------------------------------------------------- */
+    psGrid->anKeys.clear();
+    {
+        std::lock_guard<std::mutex> oLock(poCache->oMutex);
+        for( int i = 0; i < nPointCount; i++ )
+        {
+            int iCellX = 0;
+            int iCellY = 0;
+            if( !GDALGenImgProjGridCell(nStep, padfX[i], padfY[i],
+                                        padfZ ? padfZ + i : nullptr,
+                                        &iCellX, &iCellY) )
+                continue;
+            for( int j = 0; j < 4; j++ )
+            {
+                const GUInt64 nKey =
+                    GDALGenImgProjGridKey(iCellX + (j & 1), iCellY + (j >> 1));
+                if( poCache->oMapNodes.find(nKey) == poCache->oMapNodes.end() )
+                    psGrid->anKeys.push_back(nKey);
+            }
+        }
+    }
+
+    if( !psGrid->anKeys.empty() )
+    {
+        std::sort(psGrid->anKeys.begin(), psGrid->anKeys.end());
+        psGrid->anKeys.erase(
+            std::unique(psGrid->anKeys.begin(), psGrid->anKeys.end()),
+            psGrid->anKeys.end());
+
+        const int nNodes = static_cast<int>(psGrid->anKeys.size());
+        psGrid->adfX.resize(nNodes);
+        psGrid->adfY.resize(nNodes);
+        psGrid->adfZ.assign(nNodes, 0.0);
+        psGrid->anSuccess.resize(nNodes);
+        for( int i = 0; i < nNodes; i++ )
+        {
+            const GUInt64 nKey = psGrid->anKeys[i];
+            psGrid->adfX[i] = static_cast<double>(
+                static_cast<GInt32>(static_cast<GUInt32>(nKey >> 32))) * nStep;
+            psGrid->adfY[i] = static_cast<double>(
+                static_cast<GInt32>(static_cast<GUInt32>(nKey))) * nStep;
+        }
+
+        // The per-point success flags are what matter here.
+        CPL_IGNORE_RET_VAL(GDALGenImgProjTransformExact(
+            psInfo, TRUE, nNodes, &psGrid->adfX[0], &psGrid->adfY[0],
+            &psGrid->adfZ[0], &psGrid->anSuccess[0]));
+
+        std::lock_guard<std::mutex> oLock(poCache->oMutex);
+        for( int i = 0; i < nNodes; i++ )
+        {
+            GDALGenImgProjDstGridCache::Node& sNode =
+                poCache->oMapNodes[psGrid->anKeys[i]];
+            sNode.dfX = psGrid->adfX[i];
+            sNode.dfY = psGrid->adfY[i];
+            sNode.bOK = psGrid->anSuccess[i] != 0;
+        }
+        poCache->bDirty = true;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Interpolate the points.                                         */
+/* -------------------------------------------------------------------- */
+    psGrid->anIndices.clear();
+    {
+        std::lock_guard<std::mutex> oLock(poCache->oMutex);
+        for( int i = 0; i < nPointCount; i++ )
+        {
+            int iCellX = 0;
+            int iCellY = 0;
+            if( !GDALGenImgProjGridCell(nStep, padfX[i], padfY[i],
+                                        padfZ ? padfZ + i : nullptr,
+                                        &iCellX, &iCellY) )
+            {
+                psGrid->anIndices.push_back(i);
+                continue;
+            }
+
+            const GDALGenImgProjDstGridCache::Node* apsNodes[4] = {};
+            bool bOK = true;
+            for( int j = 0; bOK && j < 4; j++ )
+            {
+                auto oIter = poCache->oMapNodes.find(
+                    GDALGenImgProjGridKey(iCellX + (j & 1), iCellY + (j >> 1)));
+                bOK = oIter != poCache->oMapNodes.end() && oIter->second.bOK;
+                if( bOK )
+                    apsNodes[j] = &(oIter->second);
+            }
+            if( !bOK )
+            {
+                psGrid->anIndices.push_back(i);
+                continue;
+            }
+
+            const double dfFracX = padfX[i] / nStep - iCellX;
+            const double dfFracY = padfY[i] / nStep - iCellY;
+            const double dfTopX = apsNodes[0]->dfX +
+                (apsNodes[1]->dfX - apsNodes[0]->dfX) * dfFracX;
+            const double dfTopY = apsNodes[0]->dfY +
+                (apsNodes[1]->dfY - apsNodes[0]->dfY) * dfFracX;
+            const double dfBottomX = apsNodes[2]->dfX +
+                (apsNodes[3]->dfX - apsNodes[2]->dfX) * dfFracX;
+            const double dfBottomY = apsNodes[2]->dfY +
+                (apsNodes[3]->dfY - apsNodes[2]->dfY) * dfFracX;
+            padfX[i] = dfTopX + (dfBottomX - dfTopX) * dfFracY;
+            padfY[i] = dfTopY + (dfBottomY - dfTopY) * dfFracY;
+            panSuccess[i] = TRUE;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Transform exactly the remaining points.                         */
+/* -------------------------------------------------------------------- */
+    const int nRemaining = static_cast<int>(psGrid->anIndices.size());
+    if( nRemaining == 0 )
+        return TRUE;
+
+    psGrid->adfX.resize(nRemaining);
+    psGrid->adfY.resize(nRemaining);
+    psGrid->adfZ.resize(nRemaining);
+    psGrid->anSuccess.resize(nRemaining);
+    for( int i = 0; i < nRemaining; i++ )
+    {
+        const int iPoint = psGrid->anIndices[i];
+        psGrid->adfX[i] = padfX[iPoint];
+        psGrid->adfY[i] = padfY[iPoint];
+        psGrid->adfZ[i] = padfZ ? padfZ[iPoint] : 0.0;
+    }
+    const int bRet = GDALGenImgProjTransformExact(
+        psInfo, TRUE, nRemaining, &psGrid->adfX[0], &psGrid->adfY[0],
+        &psGrid->adfZ[0], &psGrid->anSuccess[0]);
+    for( int i = 0; i < nRemaining; i++ )
+    {
+        const int iPoint = psGrid->anIndices[i];
+        padfX[iPoint] = psGrid->adfX[i];
+        padfY[iPoint] = psGrid->adfY[i];
+        if( padfZ )
+            padfZ[iPoint] = psGrid->adfZ[i];
+        panSuccess[iPoint] = psGrid->anSuccess[i];
+    }
+    return bRet;
+}
+
+/************************************************************************/
+/*                      GDALGenImgProjTransform()                       */
+/************************************************************************/
+
+/**
+ * Perform general image reprojection transformation.
+ *
+ * Actually performs the transformation setup in
+ * GDALCreateGenImgProjTransformer().  This function matches the signature
+ * required by the GDALTransformerFunc(), and more details on the arguments
+ * can be found in that topic.
+ */
+
+int GDALGenImgProjTransform( void *pTransformArgIn, int bDstToSrc,
+                             int nPointCount,
+                             double *padfX, double *padfY, double *padfZ,
+                             int *panSuccess )
+{
+    GDALGenImgProjTransformInfo *psInfo =
+        static_cast<GDALGenImgProjTransformInfo *>(pTransformArgIn);
+
+    if( bDstToSrc && psInfo->psDstGrid != nullptr )
+        return GDALGenImgProjTransformWithDstGrid( psInfo, nPointCount,
+                                                   padfX, padfY, padfZ,
+                                                   panSuccess );
+
+    return GDALGenImgProjTransformExact( psInfo, bDstToSrc, nPointCount,
+                                         padfX, padfY, padfZ, panSuccess );
+}
+
 /************************************************************************/
 /*                 GDALSerializeGenImgProjTransformer()                 */
 /************************************************************************/
@@ -2536,6 +3033,17 @@ GDALSerializeGenImgProjTransformer( void *pTransformArg )
             CPLAddXMLChild( psTransformerContainer, psTransformer );
     }
 
+    if( psInfo->psDstGrid != nullptr )
+    {
+        CPLCreateXMLElementAndValue(
+            psTree, "DstCoordGridStep",
+            CPLSPrintf("%d", psInfo->psDstGrid->poCache->nStep) );
+        if( !psInfo->psDstGrid->poCache->osFilename.empty() )
+            CPLCreateXMLElementAndValue(
+                psTree, "DstCoordGridFile",
+                psInfo->psDstGrid->poCache->osFilename );
+    }
+
     return psTree;
 }
 
@@ -2669,6 +3177,12 @@ void *GDALDeserializeGenImgProjTransformer( CPLXMLNode *psTree )
                                     &psInfo->pReprojectArg );
     }
 
+    const int nGridStep = atoi(CPLGetXMLValue( psTree, "DstCoordGridStep", "0" ));
+    if( nGridStep > 0 )
+        GDALGenImgProjSetupDstGrid(
+            psInfo, nGridStep,
+            CPLGetXMLValue( psTree, "DstCoordGridFile", nullptr ));
+
     return psInfo;
 }
 
@@ -2687,6 +3201,10 @@ struct GDALReprojectionTransformInfo
     OGRCoordinateTransformation *poForwardTransform = nullptr;
     OGRCoordinateTransformation *poReverseTransform = nullptr;
 
+    // Scratch buffer for the coordinate epoch, reused from one call to the
+    // other.
+    std::vector<double> adfTime{};
+
     GDALReprojectionTransformInfo(): sTI()
     {
         memset(&sTI, 0, sizeof(sTI));
@@ -2931,12 +3449,11 @@ int GDALReprojectionTransform( void *pTransformArg, int bDstToSrc,
         static_cast<GDALReprojectionTransformInfo *>(pTransformArg);
     int bSuccess;
 
-    std::vector<double> adfTime;
     double* padfT = nullptr;
     if( psInfo->dfTime != 0.0 && nPointCount > 0 )
     {
-        adfTime.resize( nPointCount, psInfo->dfTime );
-        padfT = &adfTime[0];
+        psInfo->adfTime.assign( nPointCount, psInfo->dfTime );
+        padfT = &psInfo->adfTime[0];
     }
 
     if( bDstToSrc )
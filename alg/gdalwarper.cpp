@@ -1110,7 +1110,10 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * destination (INIT_DEST) and all other processing, and so should be used
  * carefully.  Mostly useful to short circuit a lot of extra work in mosaicing
  * situations. Starting with GDAL 2.4, gdalwarp will automatically enable this
- * option when it is assumed to be safe to do so.</li>
+ * option when it is assumed to be safe to do so. Starting with GDAL 3.1, chunks
+ * whose input window only contains empty blocks, as reported by
+ * GDALGetDataCoverageStatus(), are also skipped when those would be read as
+ * nodata or transparent pixels.</li>
  *
  * <li>UNIFIED_SRC_NODATA=YES/NO: By default nodata masking values considered
  * independently for each band.  However, sometimes it is desired to treat all
@@ -1147,6 +1150,17 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * set the number of threads to use to parallelize the computation part of the
  * warping. If not set, computation will be done in a single thread.</li>
  *
+ * <li>NUM_CHUNK_THREADS: (GDAL >= 3.1) Can be set to a numeric value or
+ * ALL_CPUS to set the number of chunks that GDALWarpOperation::ChunkAndWarpMulti()
+ * warps concurrently. Each thread reads the source through its own handle on
+ * the source dataset, and the warped chunks are written to the destination in
+ * order by the calling thread. Memory usage can reach twice this number times
+ * the warp memory limit. NUM_THREADS still applies to the computation of each
+ * chunk. This is ignored, and the default interleaving of I/O and computation
+ * is used, when the source dataset cannot be reopened (e.g. in-memory datasets),
+ * when a destination alpha band is used, or when custom mask or chunk processing
+ * callbacks are installed.</li>
+ *
  * <li>STREAMABLE_OUTPUT: (GDAL >= 2.0) This defaults to FALSE, but may
  * be set to TRUE typically when writing to a streamed file. The
  * gdalwarp utility automatically sets this option when writing to
@@ -1155,6 +1169,15 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * not currently supported by the warping algorithm in a streamable
  * compatible way.</li>
  *
+ * <li>TILE_ORDERED_OUTPUT: (GDAL >= 3.1) This defaults to FALSE. If set to
+ * TRUE, the destination window is cut in chunks aligned on the blocks of
+ * the destination dataset and processed tile row by tile row, and each
+ * completed tile row is flushed to the destination before the next one
+ * is warped. Tiled compressed GeoTIFF files are thus written in file order,
+ * in a single pass, without any tile being written twice. The gdalwarp
+ * utility automatically sets this option when creating a tiled compressed
+ * GeoTIFF file from a single source dataset.</li>
+ *
  * <li>SRC_COORD_PRECISION: (GDAL >= 2.0). Advanced setting. This
  * defaults to 0, to indicate that no rounding of computing source
  * image coordinates corresponding to the target image must be
@@ -477,12 +477,29 @@ private:
 
     void           *psThreadData;
 
+    // Destination tiles flushed tile row by tile row, in file order, when
+    // the TILE_ORDERED_OUTPUT warp option is in effect. nFlushBlockYSize
+    // is 0 otherwise.
+    int             nFlushBlockXSize;
+    int             nFlushBlockYSize;
+    int             nFlushFirstBlockX;
+    int             nFlushLastBlockX;
+    int             nFlushNextBlockY;
+    int             nFlushYEnd;
+
     void            WipeChunkList();
     CPLErr          CollectChunkListInternal( int nDstXOff, int nDstYOff,
                                       int nDstXSize, int nDstYSize );
     void            CollectChunkList( int nDstXOff, int nDstYOff,
                                       int nDstXSize, int nDstYSize );
     void            ReportTiming( const char * );
+    void            SetupTileOrderedFlush( int nDstXOff, int nDstYOff,
+                                           int nDstXSize, int nDstYSize );
+    CPLErr          FlushCompletedTileRows( int nDstXOff, int nDstYOff,
+                                            int nDstXSize, int nDstYSize );
+    bool            ChunkAndWarpPipelined( int nThreads,
+                                           int nDstXSize, int nDstYSize,
+                                           CPLErr *peErr );
 
 public:
                     GDALWarpOperation();
@@ -40,6 +40,9 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <new>
 #include <vector>
 
@@ -49,6 +52,7 @@
 #include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
+#include "cpl_trace.h"
 #include "cpl_vsi.h"
 #include "cpl_worker_thread_pool.h"
 #include "gdal.h"
@@ -185,6 +189,12 @@ static CPLErr GWKAverageOrMode( GDALWarpKernel * );
 static CPLErr GWKCubicNoMasksOrDstDensityOnlyUShort( GDALWarpKernel * );
 static CPLErr GWKCubicSplineNoMasksOrDstDensityOnlyUShort( GDALWarpKernel * );
 static CPLErr GWKBilinearNoMasksOrDstDensityOnlyUShort( GDALWarpKernel * );
+static CPLErr GWKBilinearSrcMaskIsValidityShort( GDALWarpKernel * );
+static CPLErr GWKBilinearSrcMaskIsValidityUShort( GDALWarpKernel * );
+static CPLErr GWKBilinearSrcMaskIsValidityFloat( GDALWarpKernel * );
+static CPLErr GWKCubicSrcMaskIsValidityShort( GDALWarpKernel * );
+static CPLErr GWKCubicSrcMaskIsValidityUShort( GDALWarpKernel * );
+static CPLErr GWKCubicSrcMaskIsValidityFloat( GDALWarpKernel * );
 
 /************************************************************************/
 /*                           GWKJobStruct                               */
@@ -207,22 +217,17 @@ struct _GWKJobStruct
     void           (*pfnFunc)(void*); // used by GWKRun() to assign the proper pTransformerArg
 } ;
 
-struct GWKThreadInitData
-{
-    GDALTransformerFunc pfnTransformerInit = nullptr;
-    void               *pTransformerArgInit = nullptr;
-
-    void               *pTransformerArg = nullptr;
-    GIntBig             nThreadId = 0;
-};
-
 struct GWKThreadData
 {
-    CPLWorkerThreadPool* poThreadPool = nullptr;
+    CPLWorkerThreadPool* poPool = nullptr; // the global worker thread pool
+    std::unique_ptr<CPLJobQueue> poJobQueue{};
+    int nThreads = 0;
     GWKJobStruct* pasThreadJob = nullptr;
     CPLCond* hCond = nullptr;
     CPLMutex* hCondMutex = nullptr;
+    GDALTransformerFunc pfnTransformer = nullptr;
     void* pTransformerArgInput = nullptr; // owned by calling layer. Not to be destroyed
+    std::mutex mutexTransformerArg{};
     std::map<GIntBig, void*> mapThreadToTransformerArg{};
 };
 
@@ -289,16 +294,15 @@ static CPLErr GWKGenericMonoThread( GDALWarpKernel *poWK,
 }
 
 /************************************************************************/
-/*                     GWKThreadInitTransformer()                       */
+/*                        GWKCloneTransformer()                         */
 /************************************************************************/
 
-static void GWKThreadInitTransformer(void* pData)
+// Clone the transformer for use by the current thread.
+static void* GWKCloneTransformer( GDALTransformerFunc pfnTransformer,
+                                  void* pTransformerArg )
 {
-    GWKThreadInitData* psInitData = static_cast<GWKThreadInitData*>(pData);
-    if( psInitData->pTransformerArg == nullptr )
-        psInitData->pTransformerArg =
-            GDALCloneTransformer(psInitData->pTransformerArgInit);
-    if( psInitData->pTransformerArg != nullptr )
+    void* pTransformerArgClone = GDALCloneTransformer(pTransformerArg);
+    if( pTransformerArgClone != nullptr )
     {
         // In case of lazy opening (for example RPCDEM), do a dummy
         // transformation to be sure that the DEM is really opened with the
@@ -308,11 +312,11 @@ static void GWKThreadInitTransformer(void* pData)
         double dfZ = 0.0;
         int bSuccess = FALSE;
         CPLPushErrorHandler(CPLQuietErrorHandler);
-        psInitData->pfnTransformerInit(psInitData->pTransformerArg, TRUE, 1,
-                                  &dfX, &dfY, &dfZ, &bSuccess );
+        pfnTransformer(pTransformerArgClone, TRUE, 1,
+                       &dfX, &dfY, &dfZ, &bSuccess );
         CPLPopErrorHandler();
     }
-    psInitData->nThreadId = CPLGetPID();
+    return pTransformerArgClone;
 }
 
 /************************************************************************/
@@ -323,32 +327,18 @@ void* GWKThreadsCreate( char** papszWarpOptions,
                         GDALTransformerFunc pfnTransformer,
                         void* pTransformerArg )
 {
-    const char* pszWarpThreads =
-        CSLFetchNameValue(papszWarpOptions, "NUM_THREADS");
-    if( pszWarpThreads == nullptr )
-        pszWarpThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
-
-    int nThreads = 0;
-    if( EQUAL(pszWarpThreads, "ALL_CPUS") )
-        nThreads = CPLGetNumCPUs();
-    else
-        nThreads = atoi(pszWarpThreads);
+    int nThreads = CPLGetNumThreads(papszWarpOptions);
     if( nThreads <= 1 )
         nThreads = 0;
-    if( nThreads > 128 )
-        nThreads = 128;
 
     GWKThreadData* psThreadData = new GWKThreadData();
+    CPLWorkerThreadPool* poPool =
+        nThreads ? CPLGetGlobalWorkerThreadPool(nThreads) : nullptr;
     CPLCond* hCond = nullptr;
-    if( nThreads )
+    if( poPool )
         hCond = CPLCreateCond();
-    if( nThreads && hCond )
+    if( poPool && hCond )
     {
-/* -------------------------------------------------------------------- */
-/*      Duplicate pTransformerArg per thread.                           */
-/* -------------------------------------------------------------------- */
-        bool bTransformerCloningSuccess = true;
-
         psThreadData->hCond = hCond;
         psThreadData->pasThreadJob = static_cast<GWKJobStruct *>(
             VSI_CALLOC_VERBOSE(sizeof(GWKJobStruct), nThreads));
@@ -366,72 +356,42 @@ void* GWKThreadsCreate( char** papszWarpOptions,
         }
         CPLReleaseMutex(psThreadData->hCondMutex);
 
-        std::vector<std::unique_ptr<GWKThreadInitData>> apoInitData;
-        std::vector<void*> apInitData;
         for( int i = 0; i < nThreads; i++ )
         {
             psThreadData->pasThreadJob[i].hCond = psThreadData->hCond;
             psThreadData->pasThreadJob[i].hCondMutex = psThreadData->hCondMutex;
-
-            std::unique_ptr<GWKThreadInitData> poInitData(new GWKThreadInitData());
-            poInitData->pfnTransformerInit = pfnTransformer;
-            poInitData->pTransformerArgInit = pTransformerArg;
-            if( i == 0 )
-                poInitData->pTransformerArg = pTransformerArg;
-            else
-                poInitData->pTransformerArg = nullptr;
-            apoInitData.push_back(std::move(poInitData));
-            apInitData.push_back(apoInitData.back().get());
-        }
-
-        psThreadData->poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
-        if( psThreadData->poThreadPool == nullptr ||
-            !psThreadData->poThreadPool->Setup(nThreads,
-                                          GWKThreadInitTransformer,
-                                          &apInitData[0]) )
-        {
-            GWKThreadsEnd(psThreadData);
-            return nullptr;
-        }
-
-        for( int i = 1; i < nThreads; i++ )
-        {
-            if( apoInitData[i]->pTransformerArg == nullptr )
-            {
-                CPLDebug("WARP", "Cannot deserialize transformer");
-                bTransformerCloningSuccess = false;
-                break;
-            }
         }
 
-        if( bTransformerCloningSuccess )
+/* -------------------------------------------------------------------- */
+/*      The pool threads are shared with other users, so each of them   */
+/*      clones pTransformerArg the first time it runs one of our jobs.  */
+/*      Check here that the transformer can be cloned.                  */
+/* -------------------------------------------------------------------- */
+        void* pTransformerArgClone = GDALCloneTransformer(pTransformerArg);
+        if( pTransformerArgClone != nullptr )
         {
+            GDALDestroyTransformer(pTransformerArgClone);
+            psThreadData->poPool = poPool;
+            psThreadData->poJobQueue = poPool->CreateJobQueue();
+            psThreadData->nThreads = nThreads;
+            psThreadData->pfnTransformer = pfnTransformer;
             psThreadData->pTransformerArgInput = pTransformerArg;
-            for( int i = 0; i < nThreads; i++ )
-            {
-                const auto nThreadId = apoInitData[i]->nThreadId;
-                CPLAssert(psThreadData->mapThreadToTransformerArg.find(nThreadId) ==
-                    psThreadData->mapThreadToTransformerArg.end());
-                psThreadData->mapThreadToTransformerArg[nThreadId] =
-                    apoInitData[i]->pTransformerArg;
-            }
+            psThreadData->mapThreadToTransformerArg[CPLGetPID()] =
+                pTransformerArg;
         }
         else
         {
-            for( int i = 1; i < nThreads; i++ )
-            {
-                if( apoInitData[i]->pTransformerArg )
-                    GDALDestroyTransformer(apoInitData[i]->pTransformerArg);
-            }
             CPLFree(psThreadData->pasThreadJob);
             psThreadData->pasThreadJob = nullptr;
-            delete psThreadData->poThreadPool;
-            psThreadData->poThreadPool = nullptr;
 
             CPLDebug("WARP", "Cannot duplicate transformer function. "
                      "Falling back to mono-thread computation");
         }
     }
+    else if( hCond )
+    {
+        CPLDestroyCond(hCond);
+    }
 
     return psThreadData;
 }
@@ -446,14 +406,14 @@ void GWKThreadsEnd( void* psThreadDataIn )
         return;
 
     GWKThreadData* psThreadData = static_cast<GWKThreadData *>(psThreadDataIn);
-    if( psThreadData->poThreadPool )
+    if( psThreadData->poJobQueue )
     {
+        psThreadData->poJobQueue.reset();
         for( auto& pair: psThreadData->mapThreadToTransformerArg )
         {
             if( pair.second != psThreadData->pTransformerArgInput )
                 GDALDestroyTransformer(pair.second);
         }
-        delete psThreadData->poThreadPool;
     }
     CPLFree(psThreadData->pasThreadJob);
     if( psThreadData->hCond )
@@ -472,11 +432,34 @@ static void ThreadFuncAdapter(void* pData)
     // Assign the pTransformerArg created in the current thread to this job
     // This workarounds the PROJ bug fixed in https://github.com/OSGeo/PROJ/pull/1726
     GWKJobStruct* psJob = static_cast<GWKJobStruct *>(pData);
-    const GWKThreadData* psThreadData =
-        static_cast<const GWKThreadData*>(psJob->poWK->psThreadData);
-    auto oIter = psThreadData->mapThreadToTransformerArg.find(CPLGetPID());
-    CPLAssert(oIter != psThreadData->mapThreadToTransformerArg.end());
-    psJob->pTransformerArg = oIter->second;
+    GWKThreadData* psThreadData =
+        static_cast<GWKThreadData*>(psJob->poWK->psThreadData);
+    const GIntBig nThreadId = CPLGetPID();
+    void* pTransformerArg = nullptr;
+    {
+        std::lock_guard<std::mutex> oLock(psThreadData->mutexTransformerArg);
+        auto oIter = psThreadData->mapThreadToTransformerArg.find(nThreadId);
+        if( oIter != psThreadData->mapThreadToTransformerArg.end() )
+            pTransformerArg = oIter->second;
+    }
+    if( pTransformerArg == nullptr )
+    {
+        pTransformerArg = GWKCloneTransformer(
+            psThreadData->pfnTransformer, psThreadData->pTransformerArgInput);
+        if( pTransformerArg == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot duplicate transformer function");
+            CPLAcquireMutex(psJob->hCondMutex, 1000.0);
+            *(psJob->pbStop) = TRUE;
+            CPLCondSignal(psJob->hCond);
+            CPLReleaseMutex(psJob->hCondMutex);
+            return;
+        }
+        std::lock_guard<std::mutex> oLock(psThreadData->mutexTransformerArg);
+        psThreadData->mapThreadToTransformerArg[nThreadId] = pTransformerArg;
+    }
+    psJob->pTransformerArg = pTransformerArg;
     psJob->pfnFunc(pData);
 }
 
@@ -492,6 +475,9 @@ static CPLErr GWKRun( GDALWarpKernel *poWK,
 {
     const int nDstYSize = poWK->nDstYSize;
 
+    CPLTraceScope oTrace("warp", pszFuncName, "pixels",
+                         static_cast<GIntBig>(poWK->nDstXSize) * nDstYSize);
+
     CPLDebug("GDAL", "GDALWarpKernel()::%s() "
              "Src=%d,%d,%dx%d Dst=%d,%d,%dx%d",
              pszFuncName,
@@ -508,17 +494,18 @@ static CPLErr GWKRun( GDALWarpKernel *poWK,
 
     GWKThreadData* psThreadData =
         static_cast<GWKThreadData*>(poWK->psThreadData);
-    if( psThreadData == nullptr || psThreadData->poThreadPool == nullptr )
+    if( psThreadData == nullptr || psThreadData->poJobQueue == nullptr )
     {
         return GWKGenericMonoThread(poWK, pfnFunc);
     }
 
     int nThreads =
-        std::min(psThreadData->poThreadPool->GetThreadCount(), nDstYSize / 2);
+        std::min(psThreadData->nThreads, nDstYSize / 2);
     // Config option mostly useful for tests to be able to test multithreading
     // with small rasters
-    const int nWarpChunkSize = atoi(
-        CPLGetConfigOption("WARP_THREAD_CHUNK_SIZE", "65536"));
+    static const CPLCachedConfigOption oWarpChunkSize(
+        "WARP_THREAD_CHUNK_SIZE", "65536");
+    const int nWarpChunkSize = oWarpChunkSize.GetInt();
     if( nWarpChunkSize > 0 )
     {
         GIntBig nChunks =
@@ -534,8 +521,6 @@ static CPLErr GWKRun( GDALWarpKernel *poWK,
     volatile int bStop = FALSE;
     volatile int nCounter = 0;
 
-    CPLAcquireMutex(psThreadData->hCondMutex, 1000);
-
 /* -------------------------------------------------------------------- */
 /*      Submit jobs                                                     */
 /* -------------------------------------------------------------------- */
@@ -554,18 +539,37 @@ static CPLErr GWKRun( GDALWarpKernel *poWK,
         else
             psThreadData->pasThreadJob[i].pfnProgress = nullptr;
         psThreadData->pasThreadJob[i].pfnFunc = pfnFunc;
-        psThreadData->poThreadPool->SubmitJob( ThreadFuncAdapter,
-                            static_cast<void*>(&psThreadData->pasThreadJob[i]) );
+    }
+    for( int i = 0; i < nThreads; i++ )
+    {
+        if( !psThreadData->poJobQueue->SubmitJob( ThreadFuncAdapter,
+                        static_cast<void*>(&psThreadData->pasThreadJob[i]) ) )
+        {
+            ThreadFuncAdapter(&psThreadData->pasThreadJob[i]);
+        }
     }
 
 /* -------------------------------------------------------------------- */
-/*      Report progress.                                                */
+/*      Report progress. When this warp itself runs in a job of the     */
+/*      pool, the thread helps the pool instead of blocking, and the    */
+/*      progress is reported as jobs complete.                          */
 /* -------------------------------------------------------------------- */
     if( poWK->pfnProgress != GDALDummyProgress )
     {
-        while( nCounter < nDstYSize )
+        const bool bWorkerThread = psThreadData->poPool->IsWorkerThread();
+        CPLAcquireMutex(psThreadData->hCondMutex, 1000);
+        while( nCounter < nDstYSize && !bStop )
         {
-            CPLCondWait(psThreadData->hCond, psThreadData->hCondMutex);
+            if( bWorkerThread )
+            {
+                CPLReleaseMutex(psThreadData->hCondMutex);
+                psThreadData->poJobQueue->WaitEvent();
+                CPLAcquireMutex(psThreadData->hCondMutex, 1000);
+            }
+            else
+            {
+                CPLCondWait(psThreadData->hCond, psThreadData->hCondMutex);
+            }
 
             if( !poWK->pfnProgress(
                     poWK->dfProgressBase + poWK->dfProgressScale *
@@ -577,16 +581,15 @@ static CPLErr GWKRun( GDALWarpKernel *poWK,
                 break;
             }
         }
+        /* Release mutex before joining threads, otherwise they will */
+        /* dead-lock forever in GWKProgressThread() */
+        CPLReleaseMutex(psThreadData->hCondMutex);
     }
 
-    /* Release mutex before joining threads, otherwise they will dead-lock */
-    /* forever in GWKProgressThread() */
-    CPLReleaseMutex(psThreadData->hCondMutex);
-
 /* -------------------------------------------------------------------- */
 /*      Wait for all jobs to complete.                                  */
 /* -------------------------------------------------------------------- */
-    psThreadData->poThreadPool->WaitCompletion();
+    psThreadData->poJobQueue->WaitCompletion();
 
     return !bStop ? CE_None : CE_Failure;
 }
@@ -1293,6 +1296,39 @@ CPLErr GDALWarpKernel::PerformWarp()
         return GWKCubicNoMasksOrDstDensityOnlyDouble( this );
 #endif
 
+    // Source validity described by bit masks only (typically nodata).
+    const bool bSrcMaskIsValidity = pafUnifiedSrcDensity == nullptr;
+
+    if( eWorkingDataType == GDT_Int16
+        && eResample == GRA_Bilinear
+        && bSrcMaskIsValidity )
+        return GWKBilinearSrcMaskIsValidityShort( this );
+
+    if( eWorkingDataType == GDT_UInt16
+        && eResample == GRA_Bilinear
+        && bSrcMaskIsValidity )
+        return GWKBilinearSrcMaskIsValidityUShort( this );
+
+    if( eWorkingDataType == GDT_Float32
+        && eResample == GRA_Bilinear
+        && bSrcMaskIsValidity )
+        return GWKBilinearSrcMaskIsValidityFloat( this );
+
+    if( eWorkingDataType == GDT_Int16
+        && eResample == GRA_Cubic
+        && bSrcMaskIsValidity )
+        return GWKCubicSrcMaskIsValidityShort( this );
+
+    if( eWorkingDataType == GDT_UInt16
+        && eResample == GRA_Cubic
+        && bSrcMaskIsValidity )
+        return GWKCubicSrcMaskIsValidityUShort( this );
+
+    if( eWorkingDataType == GDT_Float32
+        && eResample == GRA_Cubic
+        && bSrcMaskIsValidity )
+        return GWKCubicSrcMaskIsValidityFloat( this );
+
     if( eResample == GRA_Average )
         return GWKAverageOrMode( this );
 
@@ -4695,6 +4731,22 @@ static CPLErr GWKOpenCLCase( GDALWarpKernel *poWK )
 }
 #endif /* defined(HAVE_OPENCL) */
 
+/************************************************************************/
+/*                     GDALDestroyOpenCLWarpCache()                     */
+/*                                                                      */
+/*      Releases the OpenCL context and programs that GWKOpenCLCase()   */
+/*      keeps across chunks. Called by GDALDestroyDriverManager().      */
+/************************************************************************/
+
+void GDALDestroyOpenCLWarpCache();
+
+void GDALDestroyOpenCLWarpCache()
+{
+#if defined(HAVE_OPENCL)
+    GDALWarpKernelOpenCL_destroyCache();
+#endif
+}
+
 /************************************************************************/
 /*                     GWKCheckAndComputeSrcOffsets()                   */
 /************************************************************************/
@@ -5242,6 +5294,385 @@ static CPLErr GWKRealCase( GDALWarpKernel *poWK )
     return GWKRun( poWK, "GWKRealCase", GWKRealCaseThread );
 }
 
+/************************************************************************/
+/*                   GWKResampleSrcMaskIsValidity()                     */
+/*                                                                      */
+/*      Bilinear and cubic resampling of a source whose validity is     */
+/*      only described by per-band and/or unified bit masks (typically  */
+/*      source nodata), with direct typed access to the source and      */
+/*      destination buffers.  Results are the same as the ones of       */
+/*      GWKRealCase(), which is used for the cases not handled here.    */
+/************************************************************************/
+
+static CPL_INLINE bool GWKIsSrcPixelValid( const GUInt32* panUnifiedSrcValid,
+                                           const GUInt32* panBandSrcValid,
+                                           GPtrDiff_t iSrcOffset )
+{
+    if( panUnifiedSrcValid != nullptr &&
+        !(panUnifiedSrcValid[iSrcOffset>>5] & (0x01 << (iSrcOffset & 0x1f))) )
+        return false;
+    if( panBandSrcValid != nullptr &&
+        !(panBandSrcValid[iSrcOffset>>5] & (0x01 << (iSrcOffset & 0x1f))) )
+        return false;
+    return true;
+}
+
+template<class T>
+static bool GWKBilinearResampleSrcMaskIsValidity4SampleT(
+    GDALWarpKernel *poWK, int iBand, double dfSrcX, double dfSrcY,
+    double *pdfDensity, double *pdfValue )
+{
+    const int nSrcXSize = poWK->nSrcXSize;
+    const int nSrcYSize = poWK->nSrcYSize;
+    const T* pSrc = reinterpret_cast<const T*>(poWK->papabySrcImage[iBand]);
+    const GUInt32* panUnifiedSrcValid = poWK->panUnifiedSrcValid;
+    const GUInt32* panBandSrcValid = poWK->papanBandSrcValid != nullptr ?
+        poWK->papanBandSrcValid[iBand] : nullptr;
+
+    int iSrcX = static_cast<int>(floor(dfSrcX - 0.5));
+    int iSrcY = static_cast<int>(floor(dfSrcY - 0.5));
+    double dfRatioX = 1.5 - (dfSrcX - iSrcX);
+    double dfRatioY = 1.5 - (dfSrcY - iSrcY);
+
+    if( iSrcX == -1 )
+    {
+        iSrcX = 0;
+        dfRatioX = 1;
+    }
+    if( iSrcY == -1 )
+    {
+        iSrcY = 0;
+        dfRatioY = 1;
+    }
+
+    const double adfRatioX[2] = { dfRatioX, 1.0 - dfRatioX };
+    const double adfRatioY[2] = { dfRatioY, 1.0 - dfRatioY };
+    double dfAccumulator = 0.0;
+    double dfAccumulatorDivisor = 0.0;
+
+    for( int j = 0; j < 2; j++ )
+    {
+        if( iSrcY + j >= nSrcYSize )
+            break;
+        const GPtrDiff_t iRowOffset =
+            iSrcX + static_cast<GPtrDiff_t>(iSrcY + j) * nSrcXSize;
+        for( int i = 0; i < 2; i++ )
+        {
+            if( iSrcX + i >= nSrcXSize ||
+                !GWKIsSrcPixelValid(panUnifiedSrcValid, panBandSrcValid,
+                                    iRowOffset + i) )
+                continue;
+
+            const double dfMult = adfRatioX[i] * adfRatioY[j];
+            dfAccumulatorDivisor += dfMult;
+            dfAccumulator += pSrc[iRowOffset + i] * dfMult;
+        }
+    }
+
+    // Valid samples have a density of 1, so the accumulated density is
+    // the accumulated divisor.
+    if( dfAccumulatorDivisor == 1.0 )
+    {
+        *pdfValue = dfAccumulator;
+        *pdfDensity = 1.0;
+        return false;
+    }
+    else if( dfAccumulatorDivisor < 0.00001 )
+    {
+        *pdfValue = 0.0;
+        *pdfDensity = 0.0;
+        return false;
+    }
+
+    *pdfValue = dfAccumulator / dfAccumulatorDivisor;
+    *pdfDensity = 1.0;
+    return true;
+}
+
+template<class T>
+static bool GWKCubicResampleSrcMaskIsValidity4SampleT(
+    GDALWarpKernel *poWK, int iBand, double dfSrcX, double dfSrcY,
+    double *pdfDensity, double *pdfValue )
+{
+    const int iSrcX = static_cast<int>(dfSrcX - 0.5);
+    const int iSrcY = static_cast<int>(dfSrcY - 0.5);
+
+    // Get the bilinear interpolation at the image borders.
+    if( iSrcX - 1 < 0 || iSrcX + 2 >= poWK->nSrcXSize
+        || iSrcY - 1 < 0 || iSrcY + 2 >= poWK->nSrcYSize )
+        return GWKBilinearResampleSrcMaskIsValidity4SampleT<T>(
+            poWK, iBand, dfSrcX, dfSrcY, pdfDensity, pdfValue);
+
+    const int nSrcXSize = poWK->nSrcXSize;
+    const T* pSrc = reinterpret_cast<const T*>(poWK->papabySrcImage[iBand]);
+    const GUInt32* panUnifiedSrcValid = poWK->panUnifiedSrcValid;
+    const GUInt32* panBandSrcValid = poWK->papanBandSrcValid != nullptr ?
+        poWK->papanBandSrcValid[iBand] : nullptr;
+    const GPtrDiff_t iSrcOffset =
+        iSrcX + static_cast<GPtrDiff_t>(iSrcY) * nSrcXSize;
+
+    double adfCoeffsX[4] = {};
+    GWKCubicComputeWeights(dfSrcX - 0.5 - iSrcX, adfCoeffsX);
+
+    double adfValue[4] = {};
+    for( int j = -1; j < 3; j++ )
+    {
+        const GPtrDiff_t iRowOffset = iSrcOffset + j * nSrcXSize - 1;
+        double adfRow[4];
+        for( int i = 0; i < 4; i++ )
+        {
+            // As GWKCubicResample4Sample(), fallback to bilinear
+            // interpolation as soon as one pixel of the kernel is invalid.
+            if( !GWKIsSrcPixelValid(panUnifiedSrcValid, panBandSrcValid,
+                                    iRowOffset + i) )
+                return GWKBilinearResampleSrcMaskIsValidity4SampleT<T>(
+                    poWK, iBand, dfSrcX, dfSrcY, pdfDensity, pdfValue);
+            adfRow[i] = pSrc[iRowOffset + i];
+        }
+        adfValue[j + 1] = CONVOL4(adfCoeffsX, adfRow);
+    }
+
+    double adfCoeffsY[4] = {};
+    GWKCubicComputeWeights(dfSrcY - 0.5 - iSrcY, adfCoeffsY);
+
+    const double dfDensityX =
+        adfCoeffsX[0] + adfCoeffsX[1] + adfCoeffsX[2] + adfCoeffsX[3];
+    const double adfDensity[4] = { dfDensityX, dfDensityX,
+                                   dfDensityX, dfDensityX };
+    *pdfDensity = CONVOL4(adfCoeffsY, adfDensity);
+    *pdfValue = CONVOL4(adfCoeffsY, adfValue);
+
+    return true;
+}
+
+// Write an opaque sample with the rounding, clamping and destination
+// nodata avoidance of GWKSetPixelValueReal().
+template<class T>
+static CPL_INLINE void GWKSetOpaquePixelValueT( GDALWarpKernel *poWK,
+                                                int iBand,
+                                                GPtrDiff_t iDstOffset,
+                                                double dfValue )
+{
+    GWKSetPixelValueRealT( poWK, iBand, iDstOffset, 1.0,
+                           GWKClampValueT<T>(dfValue) );
+}
+
+template<>
+CPL_INLINE void GWKSetOpaquePixelValueT<float>( GDALWarpKernel *poWK,
+                                                int iBand,
+                                                GPtrDiff_t iDstOffset,
+                                                double dfValue )
+{
+    reinterpret_cast<float*>(poWK->papabyDstImage[iBand])[iDstOffset] =
+        static_cast<float>(dfValue);
+}
+
+template<class T, GDALResampleAlg eResample>
+static void GWKResampleSrcMaskIsValidityThread( void* pData )
+
+{
+    GWKJobStruct* psJob = static_cast<GWKJobStruct*>(pData);
+    GDALWarpKernel *poWK = psJob->poWK;
+
+    CPLAssert(eResample == GRA_Bilinear || eResample == GRA_Cubic);
+    CPLAssert(poWK->pafUnifiedSrcDensity == nullptr);
+
+    const int nDstXSize = poWK->nDstXSize;
+    const int nSrcXSize = poWK->nSrcXSize;
+    const int nSrcYSize = poWK->nSrcYSize;
+
+    // Downsampling uses the full filter footprint of GWKResample().
+    if( poWK->dfXScale < 0.95 || poWK->dfYScale < 0.95 ||
+        nSrcXSize == 1 || nSrcYSize == 1 )
+    {
+        GWKRealCaseThread(pData);
+        return;
+    }
+
+    const int iYMin = psJob->iYMin;
+    const int iYMax = psJob->iYMax;
+
+/* -------------------------------------------------------------------- */
+/*      Allocate x,y,z coordinate arrays for transformation ... one     */
+/*      scanlines worth of positions.                                   */
+/* -------------------------------------------------------------------- */
+
+    // For x, 2 *, because we cache the precomputed values at the end.
+    double *padfX =
+        static_cast<double *>(CPLMalloc(2 * sizeof(double) * nDstXSize));
+    double *padfY =
+        static_cast<double *>(CPLMalloc(sizeof(double) * nDstXSize));
+    double *padfZ =
+        static_cast<double *>(CPLMalloc(sizeof(double) * nDstXSize));
+    int *pabSuccess = static_cast<int *>(CPLMalloc(sizeof(int) * nDstXSize));
+
+    const double dfSrcCoordPrecision = CPLAtof(
+        CSLFetchNameValueDef(poWK->papszWarpOptions,
+                             "SRC_COORD_PRECISION", "0"));
+    const double dfErrorThreshold = CPLAtof(
+        CSLFetchNameValueDef(poWK->papszWarpOptions, "ERROR_THRESHOLD", "0"));
+
+    // Precompute values.
+    for( int iDstX = 0; iDstX < nDstXSize; iDstX++ )
+        padfX[nDstXSize + iDstX] = iDstX + 0.5 + poWK->nDstXOff;
+
+/* ==================================================================== */
+/*      Loop over output lines.                                         */
+/* ==================================================================== */
+    for( int iDstY = iYMin; iDstY < iYMax; iDstY++ )
+    {
+/* -------------------------------------------------------------------- */
+/*      Setup points to transform to source image space.                */
+/* -------------------------------------------------------------------- */
+        memcpy( padfX, padfX + nDstXSize, sizeof(double) * nDstXSize );
+        const double dfY = iDstY + 0.5 + poWK->nDstYOff;
+        for( int iDstX = 0; iDstX < nDstXSize; iDstX++ )
+            padfY[iDstX] = dfY;
+        memset( padfZ, 0, sizeof(double) * nDstXSize );
+
+/* -------------------------------------------------------------------- */
+/*      Transform the points from destination pixel/line coordinates    */
+/*      to source pixel/line coordinates.                               */
+/* -------------------------------------------------------------------- */
+        poWK->pfnTransformer( psJob->pTransformerArg, TRUE, nDstXSize,
+                              padfX, padfY, padfZ, pabSuccess );
+        if( dfSrcCoordPrecision > 0.0 )
+        {
+            GWKRoundSourceCoordinates(nDstXSize, padfX, padfY, padfZ,
+                                      pabSuccess,
+                                      dfSrcCoordPrecision,
+                                      dfErrorThreshold,
+                                      poWK->pfnTransformer,
+                                      psJob->pTransformerArg,
+                                      0.5 + poWK->nDstXOff,
+                                      iDstY + 0.5 + poWK->nDstYOff);
+        }
+
+/* ==================================================================== */
+/*      Loop over pixels in output scanline.                            */
+/* ==================================================================== */
+        for( int iDstX = 0; iDstX < nDstXSize; iDstX++ )
+        {
+            GPtrDiff_t iSrcOffset = 0;
+            if( !GWKCheckAndComputeSrcOffsets(pabSuccess, iDstX, padfX, padfY,
+                                    poWK, nSrcXSize, nSrcYSize, iSrcOffset) )
+                continue;
+
+            if( poWK->panUnifiedSrcValid != nullptr
+                && !(poWK->panUnifiedSrcValid[iSrcOffset>>5]
+                     & (0x01 << (iSrcOffset & 0x1f))) )
+                continue;
+
+/* ==================================================================== */
+/*      Loop processing each band.                                      */
+/* ==================================================================== */
+            bool bHasFoundDensity = false;
+
+            const GPtrDiff_t iDstOffset = iDstX + static_cast<GPtrDiff_t>(iDstY) * nDstXSize;
+            for( int iBand = 0; iBand < poWK->nBands; iBand++ )
+            {
+                double dfBandDensity = 0.0;
+                double dfValue = 0.0;
+                if( eResample == GRA_Bilinear )
+                    GWKBilinearResampleSrcMaskIsValidity4SampleT<T>(
+                        poWK, iBand,
+                        padfX[iDstX]-poWK->nSrcXOff,
+                        padfY[iDstX]-poWK->nSrcYOff,
+                        &dfBandDensity, &dfValue );
+                else
+                    GWKCubicResampleSrcMaskIsValidity4SampleT<T>(
+                        poWK, iBand,
+                        padfX[iDstX]-poWK->nSrcXOff,
+                        padfY[iDstX]-poWK->nSrcYOff,
+                        &dfBandDensity, &dfValue );
+
+                // If we didn't find any valid inputs skip to next band.
+                if( dfBandDensity < BAND_DENSITY_THRESHOLD )
+                    continue;
+
+                bHasFoundDensity = true;
+
+                if( dfBandDensity < 0.9999 )
+                    GWKSetPixelValueReal(poWK, iBand, iDstOffset,
+                                         dfBandDensity, dfValue);
+                else
+                    GWKSetOpaquePixelValueT<T>(poWK, iBand, iDstOffset,
+                                               dfValue);
+            }
+
+            if( !bHasFoundDensity )
+              continue;
+
+/* -------------------------------------------------------------------- */
+/*      Update destination density/validity masks.                      */
+/* -------------------------------------------------------------------- */
+            GWKOverlayDensity( poWK, iDstOffset, 1.0 );
+
+            if( poWK->panDstValid != nullptr )
+            {
+                poWK->panDstValid[iDstOffset>>5] |=
+                    0x01 << (iDstOffset & 0x1f);
+            }
+        }  // Next iDstX.
+
+/* -------------------------------------------------------------------- */
+/*      Report progress to the user, and optionally cancel out.         */
+/* -------------------------------------------------------------------- */
+        if( psJob->pfnProgress && psJob->pfnProgress(psJob) )
+            break;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Cleanup and return.                                             */
+/* -------------------------------------------------------------------- */
+    CPLFree( padfX );
+    CPLFree( padfY );
+    CPLFree( padfZ );
+    CPLFree( pabSuccess );
+}
+
+static CPLErr GWKBilinearSrcMaskIsValidityShort( GDALWarpKernel *poWK )
+{
+    return GWKRun(
+        poWK, "GWKBilinearSrcMaskIsValidityShort",
+        GWKResampleSrcMaskIsValidityThread<GInt16, GRA_Bilinear>);
+}
+
+static CPLErr GWKBilinearSrcMaskIsValidityUShort( GDALWarpKernel *poWK )
+{
+    return GWKRun(
+        poWK, "GWKBilinearSrcMaskIsValidityUShort",
+        GWKResampleSrcMaskIsValidityThread<GUInt16, GRA_Bilinear>);
+}
+
+static CPLErr GWKBilinearSrcMaskIsValidityFloat( GDALWarpKernel *poWK )
+{
+    return GWKRun(
+        poWK, "GWKBilinearSrcMaskIsValidityFloat",
+        GWKResampleSrcMaskIsValidityThread<float, GRA_Bilinear>);
+}
+
+static CPLErr GWKCubicSrcMaskIsValidityShort( GDALWarpKernel *poWK )
+{
+    return GWKRun(
+        poWK, "GWKCubicSrcMaskIsValidityShort",
+        GWKResampleSrcMaskIsValidityThread<GInt16, GRA_Cubic>);
+}
+
+static CPLErr GWKCubicSrcMaskIsValidityUShort( GDALWarpKernel *poWK )
+{
+    return GWKRun(
+        poWK, "GWKCubicSrcMaskIsValidityUShort",
+        GWKResampleSrcMaskIsValidityThread<GUInt16, GRA_Cubic>);
+}
+
+static CPLErr GWKCubicSrcMaskIsValidityFloat( GDALWarpKernel *poWK )
+{
+    return GWKRun(
+        poWK, "GWKCubicSrcMaskIsValidityFloat",
+        GWKResampleSrcMaskIsValidityThread<float, GRA_Cubic>);
+}
+
 /************************************************************************/
 /*                GWKResampleNoMasksOrDstDensityOnlyThreadInternal()    */
 /************************************************************************/
@@ -5735,6 +6166,249 @@ static CPLErr GWKAverageOrMode( GDALWarpKernel *poWK )
     return GWKRun( poWK, "GWKAverageOrMode", GWKAverageOrModeThread );
 }
 
+/************************************************************************/
+/*                      GWKAverageOrModeWindow()                        */
+/*                                                                      */
+/*      Fast path of GWKAverageOrModeThread() for a band that has no    */
+/*      validity mask and no source density, so that all the pixels of */
+/*      the source window are used. Gives the same results as the       */
+/*      generic path, without the per pixel GWKGetPixelValue() calls.   */
+/************************************************************************/
+
+// Adds the values of a row to the accumulator, in order, so that floating
+// point sums are the same as the ones of the generic path.
+template<class T, class Acc>
+static inline void GWKAccumulateRow( const T* pSrc, int nCount, Acc& acc )
+{
+    for( int i = 0; i < nCount; i++ )
+        acc += pSrc[i];
+}
+
+#if defined(__x86_64) || defined(_M_X64)
+template<>
+inline void GWKAccumulateRow( const GByte* pabySrc, int nCount, GIntBig& acc )
+{
+    int i = 0;
+    const __m128i xmm_zero = _mm_setzero_si128();
+    __m128i xmm_sum = xmm_zero;
+    for( ; i + 16 <= nCount; i += 16 )
+    {
+        const __m128i xmm_val = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pabySrc + i));
+        xmm_sum = _mm_add_epi64(xmm_sum, _mm_sad_epu8(xmm_val, xmm_zero));
+    }
+    acc += _mm_cvtsi128_si64(xmm_sum) +
+           _mm_cvtsi128_si64(_mm_unpackhi_epi64(xmm_sum, xmm_sum));
+    for( ; i < nCount; i++ )
+        acc += pabySrc[i];
+}
+#endif
+
+template<class T, bool bIsInteger = std::numeric_limits<T>::is_integer>
+struct GWKMinMaxRow
+{
+    // Integer values: exact, so compare them in their own type.
+    static inline void Process( const T* pSrc, int nCount,
+                                double& dfMin, double& dfMax )
+    {
+        T nMin = pSrc[0];
+        T nMax = pSrc[0];
+        for( int i = 1; i < nCount; i++ )
+        {
+            nMin = std::min(nMin, pSrc[i]);
+            nMax = std::max(nMax, pSrc[i]);
+        }
+        dfMin = std::min(dfMin, static_cast<double>(nMin));
+        dfMax = std::max(dfMax, static_cast<double>(nMax));
+    }
+};
+
+template<class T>
+struct GWKMinMaxRow<T, false>
+{
+    // Same comparisons as the generic path, for NaN and infinities.
+    static inline void Process( const T* pSrc, int nCount,
+                                double& dfMin, double& dfMax )
+    {
+        for( int i = 0; i < nCount; i++ )
+        {
+            const double dfVal = pSrc[i];
+            if( dfMin > dfVal )
+                dfMin = dfVal;
+            if( dfMax < dfVal )
+                dfMax = dfVal;
+        }
+    }
+};
+
+template<class T, class Acc>
+static bool GWKAverageOrModeWindow( const T* pSrc, int nSrcXSize,
+                                    int iSrcXMin, int iSrcXMax,
+                                    int iSrcYMin, int iSrcYMax,
+                                    int nAlgo, float quant,
+                                    int* panVals, int nBinsOffset,
+                                    std::vector<double>& adfVals,
+                                    double* pdfValue )
+{
+    const int nWidth = iSrcXMax - iSrcXMin;
+    if( nWidth <= 0 || iSrcYMax <= iSrcYMin )
+        return false;
+    const int nCount = nWidth * (iSrcYMax - iSrcYMin);
+    const T* pSrcFirst =
+        pSrc + iSrcXMin + static_cast<GPtrDiff_t>(iSrcYMin) * nSrcXSize;
+
+    if( nAlgo == GWKAOM_Average )
+    {
+        Acc acc = 0;
+        for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+        {
+            GWKAccumulateRow(pSrcFirst +
+                    static_cast<GPtrDiff_t>(iSrcY - iSrcYMin) * nSrcXSize,
+                    nWidth, acc);
+        }
+        *pdfValue = static_cast<double>(acc) / nCount;
+    }
+    else if( nAlgo == GWKAOM_Max || nAlgo == GWKAOM_Min )
+    {
+        double dfMin = std::numeric_limits<double>::max();
+        double dfMax = std::numeric_limits<double>::lowest();
+        for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+        {
+            GWKMinMaxRow<T>::Process(pSrcFirst +
+                    static_cast<GPtrDiff_t>(iSrcY - iSrcYMin) * nSrcXSize,
+                    nWidth, dfMin, dfMax);
+        }
+        *pdfValue = nAlgo == GWKAOM_Max ? dfMax : dfMin;
+    }
+    else if( nAlgo == GWKAOM_Imode )
+    {
+        // panVals is all zeroes on entry, and left so by clearing the bins
+        // used, which is much cheaper than clearing all of them every time
+        // for 16 bit types.
+        int nMaxVal = 0;
+        int iMaxInd = 0;
+        for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+        {
+            const T* pSrcLine = pSrcFirst +
+                    static_cast<GPtrDiff_t>(iSrcY - iSrcYMin) * nSrcXSize;
+            for( int i = 0; i < nWidth; i++ )
+            {
+                const int nVal = static_cast<int>(pSrcLine[i]);
+                if( ++panVals[nVal + nBinsOffset] > nMaxVal )
+                {
+                    iMaxInd = nVal;
+                    nMaxVal = panVals[nVal + nBinsOffset];
+                }
+            }
+        }
+        for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+        {
+            const T* pSrcLine = pSrcFirst +
+                    static_cast<GPtrDiff_t>(iSrcY - iSrcYMin) * nSrcXSize;
+            for( int i = 0; i < nWidth; i++ )
+                panVals[static_cast<int>(pSrcLine[i]) + nBinsOffset] = 0;
+        }
+        *pdfValue = iMaxInd;
+    }
+    else if( nAlgo == GWKAOM_Quant )
+    {
+        const int quantIdx = static_cast<int>(
+            std::ceil(quant * static_cast<size_t>(nCount) - 1));
+        if( sizeof(T) == 1 && nCount >= 256 )
+        {
+            // Histogram based selection for large byte windows.
+            int anHist[256] = {};
+            for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+            {
+                const T* pSrcLine = pSrcFirst +
+                    static_cast<GPtrDiff_t>(iSrcY - iSrcYMin) * nSrcXSize;
+                for( int i = 0; i < nWidth; i++ )
+                    anHist[static_cast<GByte>(pSrcLine[i])]++;
+            }
+            int nCumulated = 0;
+            int iBin = 0;
+            for( ; iBin < 255; iBin++ )
+            {
+                nCumulated += anHist[iBin];
+                if( nCumulated > quantIdx )
+                    break;
+            }
+            *pdfValue = iBin;
+        }
+        else
+        {
+            adfVals.resize(nCount);
+            int iVal = 0;
+            for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+            {
+                const T* pSrcLine = pSrcFirst +
+                    static_cast<GPtrDiff_t>(iSrcY - iSrcYMin) * nSrcXSize;
+                for( int i = 0; i < nWidth; i++ )
+                    adfVals[iVal++] = pSrcLine[i];
+            }
+            std::nth_element(adfVals.begin(), adfVals.begin() + quantIdx,
+                             adfVals.end());
+            *pdfValue = adfVals[quantIdx];
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+static bool GWKAverageOrModeWindow( const GDALWarpKernel* poWK, int iBand,
+                                    int iSrcXMin, int iSrcXMax,
+                                    int iSrcYMin, int iSrcYMax,
+                                    int nAlgo, float quant,
+                                    int* panVals, int nBinsOffset,
+                                    std::vector<double>& adfVals,
+                                    double* pdfValue )
+{
+    const GByte* pabySrc = poWK->papabySrcImage[iBand];
+    const int nSrcXSize = poWK->nSrcXSize;
+    switch( poWK->eWorkingDataType )
+    {
+      case GDT_Byte:
+        return GWKAverageOrModeWindow<GByte, GIntBig>(
+            pabySrc, nSrcXSize, iSrcXMin, iSrcXMax, iSrcYMin, iSrcYMax,
+            nAlgo, quant, panVals, nBinsOffset, adfVals, pdfValue);
+      case GDT_Int16:
+        return GWKAverageOrModeWindow<GInt16, GIntBig>(
+            reinterpret_cast<const GInt16*>(pabySrc), nSrcXSize,
+            iSrcXMin, iSrcXMax, iSrcYMin, iSrcYMax,
+            nAlgo, quant, panVals, nBinsOffset, adfVals, pdfValue);
+      case GDT_UInt16:
+        return GWKAverageOrModeWindow<GUInt16, GIntBig>(
+            reinterpret_cast<const GUInt16*>(pabySrc), nSrcXSize,
+            iSrcXMin, iSrcXMax, iSrcYMin, iSrcYMax,
+            nAlgo, quant, panVals, nBinsOffset, adfVals, pdfValue);
+      case GDT_Int32:
+        return GWKAverageOrModeWindow<GInt32, GIntBig>(
+            reinterpret_cast<const GInt32*>(pabySrc), nSrcXSize,
+            iSrcXMin, iSrcXMax, iSrcYMin, iSrcYMax,
+            nAlgo, quant, panVals, nBinsOffset, adfVals, pdfValue);
+      case GDT_UInt32:
+        return GWKAverageOrModeWindow<GUInt32, GIntBig>(
+            reinterpret_cast<const GUInt32*>(pabySrc), nSrcXSize,
+            iSrcXMin, iSrcXMax, iSrcYMin, iSrcYMax,
+            nAlgo, quant, panVals, nBinsOffset, adfVals, pdfValue);
+      case GDT_Float32:
+        return GWKAverageOrModeWindow<float, double>(
+            reinterpret_cast<const float*>(pabySrc), nSrcXSize,
+            iSrcXMin, iSrcXMax, iSrcYMin, iSrcYMax,
+            nAlgo, quant, panVals, nBinsOffset, adfVals, pdfValue);
+      case GDT_Float64:
+        return GWKAverageOrModeWindow<double, double>(
+            reinterpret_cast<const double*>(pabySrc), nSrcXSize,
+            iSrcXMin, iSrcXMax, iSrcYMin, iSrcYMax,
+            nAlgo, quant, panVals, nBinsOffset, adfVals, pdfValue);
+      default:
+        return false;
+    }
+}
+
 // Overall logic based on GWKGeneralCaseThread().
 static void GWKAverageOrModeThread( void* pData)
 {
@@ -5858,6 +6532,16 @@ static void GWKAverageOrModeThread( void* pData)
     CPLDebug("GDAL",
              "GDALWarpKernel():GWKAverageOrModeThread() using algo %d", nAlgo);
 
+    // Without source validity or density, bands that have no validity mask
+    // of their own can use GWKAverageOrModeWindow().
+    const bool bFastPath =
+        nAlgo != GWKAOM_Fmode && !bIsComplex &&
+        poWK->panUnifiedSrcValid == nullptr &&
+        poWK->pafUnifiedSrcDensity == nullptr;
+    // Whether panVals may have non zero bins.
+    bool bValsDirty = true;
+    std::vector<double> adfQuantVals;
+
 /* -------------------------------------------------------------------- */
 /*      Allocate x,y,z coordinate arrays for transformation ... two     */
 /*      scanlines worth of positions.                                   */
@@ -5997,8 +6681,28 @@ static void GWKAverageOrModeThread( void* pData)
 
                 // Loop over source lines and pixels - 3 possible algorithms.
 
+                if( bFastPath &&
+                    (poWK->papanBandSrcValid == nullptr ||
+                     poWK->papanBandSrcValid[iBand] == nullptr) )
+                {
+                    if( nAlgo == GWKAOM_Imode && bValsDirty )
+                    {
+                        memset(panVals, 0, nBins*sizeof(int));
+                        bValsDirty = false;
+                    }
+                    if( GWKAverageOrModeWindow(poWK, iBand,
+                                               iSrcXMin, iSrcXMax,
+                                               iSrcYMin, iSrcYMax,
+                                               nAlgo, quant,
+                                               panVals, nBinsOffset,
+                                               adfQuantVals, &dfValueReal) )
+                    {
+                        dfBandDensity = 1;
+                        bHasFoundDensity = true;
+                    }
+                }
                 // poWK->eResample == GRA_Average.
-                if( nAlgo == GWKAOM_Average )
+                else if( nAlgo == GWKAOM_Average )
                 {
                     // This code adapted from GDALDownsampleChunk32R_AverageT()
                     // in gcore/overview.cpp.
@@ -6120,6 +6824,7 @@ static void GWKAverageOrModeThread( void* pData)
                         int iMaxInd = -1;
 
                         memset(panVals, 0, nBins*sizeof(int));
+                        bValsDirty = true;
 
                         for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
                         {
@@ -6156,7 +6861,8 @@ static void GWKAverageOrModeThread( void* pData)
                             }
                         }
 
-                        if( iMaxInd != -1 )
+                        // Not iMaxInd != -1, which is a valid Int16 value.
+                        if( nMaxVal > 0 )
                         {
                             dfValueReal = iMaxInd;
                             dfBandDensity = 1;
@@ -39,6 +39,9 @@
 #include <limits.h>
 #include <float.h>
 #include <limits>
+#include <map>
+#include <string>
+#include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "gdalwarpkernel_opencl.h"
 
@@ -378,6 +381,125 @@ static cl_device_id get_device(OCLVendor *peVendor)
     return preferred_device_id;
 }
 
+/*
+ Process-wide cache of the selected device, of its context and of the programs
+ built for it. Selecting the device, creating the context and compiling the
+ kernel cost much more than warping a typical chunk, while the compiler
+ arguments only depend on the chunk dimensions and the warp options, which
+ repeat from one chunk (and one warp operation) to the next.
+ */
+#define MAX_CACHED_PROGRAMS 32
+
+static CPLMutex *hCLCacheMutex = nullptr;
+static bool bCLCacheInitialized = false;
+static cl_device_id hCachedDevice = nullptr;
+static OCLVendor eCachedVendor = VENDOR_OTHER;
+static cl_context hCachedContext = nullptr;
+static std::map<std::string, cl_program> oCachedPrograms;
+
+/*
+ Returns the cached device and context, selecting and creating them on the
+ first call. The caller gets its own reference on the context.
+
+ Returns false if no suitable OpenCL device is available.
+ */
+static bool get_cached_context(cl_device_id *pDevice, OCLVendor *peVendor,
+                               cl_context *pContext)
+{
+    CPLMutexHolderD(&hCLCacheMutex);
+    if( !bCLCacheInitialized )
+    {
+        bCLCacheInitialized = true;
+
+        cl_device_id device = get_device(&eCachedVendor);
+        if( device == nullptr )
+            return false;
+
+        cl_bool bool_flag = CL_FALSE;
+        size_t sz = 0;
+        cl_int err = clGetDeviceInfo(device, CL_DEVICE_IMAGE_SUPPORT,
+                                     sizeof(cl_bool), &bool_flag, &sz);
+        if( err != CL_SUCCESS || !bool_flag )
+        {
+            CPLDebug( "OpenCL", "No image support on selected device." );
+            return false;
+        }
+
+        hCachedContext = clCreateContext(nullptr, 1, &device,
+                                         nullptr, nullptr, &err);
+        if( err != CL_SUCCESS )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Error at file %s line %d: %s", __FILE__, __LINE__,
+                     getCLErrorString(err));
+            hCachedContext = nullptr;
+            return false;
+        }
+        hCachedDevice = device;
+    }
+    if( hCachedContext == nullptr )
+        return false;
+
+    clRetainContext(hCachedContext);
+    *pDevice = hCachedDevice;
+    *peVendor = eCachedVendor;
+    *pContext = hCachedContext;
+    return true;
+}
+
+/*
+ Returns a new reference on the cached program built with the given key, or
+ NULL if it has not been built yet.
+ */
+static cl_program get_cached_program(const std::string& osKey)
+{
+    CPLMutexHolderD(&hCLCacheMutex);
+    auto oIter = oCachedPrograms.find(osKey);
+    if( oIter == oCachedPrograms.end() )
+        return nullptr;
+    clRetainProgram(oIter->second);
+    return oIter->second;
+}
+
+/*
+ Keeps a reference on a successfully built program for later chunks.
+ */
+static void add_cached_program(const std::string& osKey, cl_program program)
+{
+    CPLMutexHolderD(&hCLCacheMutex);
+    if( oCachedPrograms.find(osKey) != oCachedPrograms.end() )
+        return;
+    if( oCachedPrograms.size() >= MAX_CACHED_PROGRAMS )
+    {
+        for( auto& oIter: oCachedPrograms )
+            clReleaseProgram(oIter.second);
+        oCachedPrograms.clear();
+    }
+    clRetainProgram(program);
+    oCachedPrograms[osKey] = program;
+}
+
+/*
+ Releases the cached programs and context. Called by GDALDestroyDriverManager().
+ */
+void GDALWarpKernelOpenCL_destroyCache()
+{
+    {
+        CPLMutexHolderD(&hCLCacheMutex);
+        for( auto& oIter: oCachedPrograms )
+            clReleaseProgram(oIter.second);
+        oCachedPrograms.clear();
+        if( hCachedContext != nullptr )
+            clReleaseContext(hCachedContext);
+        hCachedContext = nullptr;
+        hCachedDevice = nullptr;
+        bCLCacheInitialized = false;
+    }
+    if( hCLCacheMutex != nullptr )
+        CPLDestroyMutex(hCLCacheMutex);
+    hCLCacheMutex = nullptr;
+}
+
 /*
  Given that not all OpenCL devices support the same image formats, we need to
  make do with what we have. This leads to wasted space, but as OpenCL matures
@@ -613,6 +735,7 @@ cl_kernel get_kernel(struct oclWarper *warper, char useVec,
     cl_program program;
     cl_kernel kernel;
     cl_int err = CL_SUCCESS;
+    std::string osKey;
 #define PROGBUF_SIZE 128000
     char *buffer = static_cast<char *>(CPLCalloc(PROGBUF_SIZE, sizeof(char)));
     char *progBuf = static_cast<char *>(CPLCalloc(PROGBUF_SIZE, sizeof(char)));
@@ -1310,21 +1433,6 @@ cl_kernel get_kernel(struct oclWarper *warper, char useVec,
         dVecf = "float4";
     }
 
-    //Assemble the kernel from parts. The compiler is unable to handle multiple
-    //kernels in one string with more than a few __constant modifiers each.
-    if (warper->resampAlg == OCL_Bilinear)
-        snprintf(progBuf, PROGBUF_SIZE, "%s\n%s", kernGenFuncs, kernBilinear);
-    else if (warper->resampAlg == OCL_Cubic)
-        snprintf(progBuf, PROGBUF_SIZE, "%s\n%s", kernGenFuncs, kernCubic);
-    else
-        snprintf(progBuf, PROGBUF_SIZE, "%s\n%s", kernGenFuncs, kernResampler);
-
-    //Actually make the program from assembled source
-    program = clCreateProgramWithSource(warper->context, 1,
-                                        const_cast<const char**>(reinterpret_cast<char**>(&progBuf)),
-                                        nullptr, &err);
-    handleErrGoto(err, error_final);
-
     //Assemble the compiler arg string for speed. All invariants should be defined here.
     snprintf(buffer, PROGBUF_SIZE,
              "-cl-fast-relaxed-math -Werror -D FALSE=0 -D TRUE=1 "
@@ -1347,6 +1455,29 @@ cl_kernel get_kernel(struct oclWarper *warper, char useVec,
             dVecf, dUseVec, warper->resampAlg == OCL_CubicSpline,
             warper->nBandSrcValidCL != nullptr, warper->coordMult);
 
+    //The source only depends on the resampling kernel, and everything else
+    //is in the compiler args, so reuse a program built for a previous chunk.
+    osKey = CPLSPrintf("%d ", static_cast<int>(warper->resampAlg));
+    osKey += buffer;
+    program = get_cached_program(osKey);
+    if( program != nullptr )
+        goto create_kernel;
+
+    //Assemble the kernel from parts. The compiler is unable to handle multiple
+    //kernels in one string with more than a few __constant modifiers each.
+    if (warper->resampAlg == OCL_Bilinear)
+        snprintf(progBuf, PROGBUF_SIZE, "%s\n%s", kernGenFuncs, kernBilinear);
+    else if (warper->resampAlg == OCL_Cubic)
+        snprintf(progBuf, PROGBUF_SIZE, "%s\n%s", kernGenFuncs, kernCubic);
+    else
+        snprintf(progBuf, PROGBUF_SIZE, "%s\n%s", kernGenFuncs, kernResampler);
+
+    //Actually make the program from assembled source
+    program = clCreateProgramWithSource(warper->context, 1,
+                                        const_cast<const char**>(reinterpret_cast<char**>(&progBuf)),
+                                        nullptr, &err);
+    handleErrGoto(err, error_final);
+
     (*clErr) = err = clBuildProgram(program, 1, &(warper->dev), buffer, nullptr, nullptr);
 
     //Detailed debugging info
@@ -1376,6 +1507,9 @@ cl_kernel get_kernel(struct oclWarper *warper, char useVec,
         goto error_free_program;
     }
 
+    add_cached_program(osKey, program);
+
+create_kernel:
     kernel = clCreateKernel(program, "resamp", &err);
     handleErrGoto(err, error_free_program);
 
@@ -2051,23 +2185,15 @@ struct oclWarper* GDALWarpKernelOpenCL_createEnv(int srcWidth, int srcHeight,
     size_t maxWidth = 0, maxHeight = 0;
     cl_int err = CL_SUCCESS;
     size_t fmtSize, sz;
-    cl_device_id device;
-    cl_bool bool_flag;
+    cl_device_id device = nullptr;
+    cl_context context = nullptr;
     OCLVendor eCLVendor = VENDOR_OTHER;
 
-    // Do we have a suitable OpenCL device?
-    device = get_device(&eCLVendor);
-    if( device == nullptr )
+    // Do we have a suitable OpenCL device? The device and its context are
+    // shared by all the warpers of the process.
+    if( !get_cached_context(&device, &eCLVendor, &context) )
         return nullptr;
 
-    err = clGetDeviceInfo(device, CL_DEVICE_IMAGE_SUPPORT,
-                          sizeof(cl_bool), &bool_flag, &sz);
-    if( err != CL_SUCCESS || !bool_flag )
-    {
-        CPLDebug( "OpenCL", "No image support on selected device." );
-        return nullptr;
-    }
-
     // Set up warper environment.
     warper = static_cast<struct oclWarper *>(CPLCalloc(1, sizeof(struct oclWarper)));
 
@@ -2101,9 +2227,7 @@ struct oclWarper* GDALWarpKernelOpenCL_createEnv(int srcWidth, int srcHeight,
     warper->kern4 = nullptr;
 
     warper->dev = device;
-
-    warper->context = clCreateContext(nullptr, 1, &(warper->dev), nullptr, nullptr, &err);
-    handleErrGoto(err, error_label);
+    warper->context = context;
 #if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) || defined(__clang__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -190,6 +190,8 @@ cl_int GDALWarpKernelOpenCL_getRow(struct oclWarper *warper,
 
 cl_int GDALWarpKernelOpenCL_deleteEnv(struct oclWarper *warper);
 
+void GDALWarpKernelOpenCL_destroyCache(void);
+
 #ifdef __cplusplus /* If this is a C++ compiler, end C linkage */
 }
 #endif
@@ -37,10 +37,12 @@
 #include <cstring>
 
 #include <algorithm>
+#include <condition_variable>
 #include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "cpl_config.h"
 #include "cpl_conv.h"
@@ -48,7 +50,9 @@
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
+#include "gdal_alg_priv.h"
 #include "gdal_priv.h"
 #include "ogr_api.h"
 #include "ogr_core.h"
@@ -175,7 +179,13 @@ GDALWarpOperation::GDALWarpOperation() :
     pasChunkList(nullptr),
     bReportTimings(FALSE),
     nLastTimeReported(0),
-    psThreadData(nullptr)
+    psThreadData(nullptr),
+    nFlushBlockXSize(0),
+    nFlushBlockYSize(0),
+    nFlushFirstBlockX(0),
+    nFlushLastBlockX(0),
+    nFlushNextBlockY(0),
+    nFlushYEnd(0)
 {}
 
 /************************************************************************/
@@ -837,6 +847,8 @@ void GDALWarpOperation::CollectChunkList(
         qsort(pasChunkList, nChunkListCount, sizeof(GDALWarpChunk),
               OrderWarpChunk);
 
+    SetupTileOrderedFlush( nDstXOff, nDstYOff, nDstXSize, nDstYSize );
+
 /* -------------------------------------------------------------------- */
 /*      Find the global source window.                                  */
 /* -------------------------------------------------------------------- */
@@ -985,6 +997,88 @@ CPLErr GDALChunkAndWarpImage( GDALWarpOperationH hOperation,
         ChunkAndWarpImage( nDstXOff, nDstYOff, nDstXSize, nDstYSize );
 }
 
+/************************************************************************/
+/*                       GDALWarpReadDstBuffer()                        */
+/************************************************************************/
+
+// Read the existing destination imagery of a chunk into pDstBuffer, so
+// that the warped data can be overlaid on it.
+static CPLErr GDALWarpReadDstBuffer( const GDALWarpOptions *psOptions,
+                                     int nDstXOff, int nDstYOff,
+                                     int nDstXSize, int nDstYSize,
+                                     void *pDstBuffer )
+{
+    GDALDataset* poDstDS = reinterpret_cast<GDALDataset*>(psOptions->hDstDS);
+    if( psOptions->nBandCount == 1 )
+    {
+        // Particular case to simplify the stack a bit.
+        // TODO(rouault): Need an explanation of what and why r34502 helps.
+        return poDstDS->GetRasterBand(psOptions->panDstBands[0])->RasterIO(
+            GF_Read,
+            nDstXOff, nDstYOff, nDstXSize, nDstYSize,
+            pDstBuffer, nDstXSize, nDstYSize,
+            psOptions->eWorkingDataType,
+            0, 0, nullptr);
+    }
+
+    return poDstDS->RasterIO(
+        GF_Read,
+        nDstXOff, nDstYOff, nDstXSize, nDstYSize,
+        pDstBuffer, nDstXSize, nDstYSize,
+        psOptions->eWorkingDataType,
+        psOptions->nBandCount,
+        psOptions->panDstBands,
+        0, 0, 0, nullptr);
+}
+
+/************************************************************************/
+/*                       GDALWarpWriteDstBuffer()                       */
+/************************************************************************/
+
+// Write a warped chunk to the destination dataset, and flush it if the
+// WRITE_FLUSH warp option is set.
+static CPLErr GDALWarpWriteDstBuffer( const GDALWarpOptions *psOptions,
+                                      int nDstXOff, int nDstYOff,
+                                      int nDstXSize, int nDstYSize,
+                                      void *pDstBuffer )
+{
+    GDALDataset* poDstDS = reinterpret_cast<GDALDataset*>(psOptions->hDstDS);
+    CPLErr eErr = CE_None;
+    if( psOptions->nBandCount == 1 )
+    {
+        // Particular case to simplify the stack a bit.
+        eErr = poDstDS->GetRasterBand(psOptions->panDstBands[0])->RasterIO(
+              GF_Write,
+              nDstXOff, nDstYOff, nDstXSize, nDstYSize,
+              pDstBuffer, nDstXSize, nDstYSize,
+              psOptions->eWorkingDataType,
+              0, 0, nullptr );
+    }
+    else
+    {
+        eErr = poDstDS->RasterIO( GF_Write,
+                                nDstXOff, nDstYOff, nDstXSize, nDstYSize,
+                                pDstBuffer, nDstXSize, nDstYSize,
+                                psOptions->eWorkingDataType,
+                                psOptions->nBandCount,
+                                psOptions->panDstBands,
+                                0, 0, 0, nullptr );
+    }
+
+    if( eErr == CE_None &&
+        CPLFetchBool( psOptions->papszWarpOptions, "WRITE_FLUSH", false ) )
+    {
+        const CPLErr eOldErr = CPLGetLastErrorType();
+        const CPLString osLastErrMsg = CPLGetLastErrorMsg();
+        GDALFlushCache( psOptions->hDstDS );
+        const CPLErr eNewErr = CPLGetLastErrorType();
+        if( eNewErr != eOldErr ||
+            osLastErrMsg.compare(CPLGetLastErrorMsg()) != 0 )
+            eErr = CE_Failure;
+    }
+    return eErr;
+}
+
 /************************************************************************/
 /*                          ChunkThreadMain()                           */
 /************************************************************************/
@@ -1048,6 +1142,358 @@ static void ChunkThreadMain( void *pThreadData )
     }
 }
 
+/************************************************************************/
+/*                     GDALWarpGetChunkThreadCount()                    */
+/************************************************************************/
+
+// Number of chunks warped concurrently, from the NUM_CHUNK_THREADS warp
+// option.  Returns 1 (legacy two-thread scheme) when unset.
+static int GDALWarpGetChunkThreadCount( CSLConstList papszWarpOptions )
+{
+    const char* pszNumThreads =
+        CSLFetchNameValue(papszWarpOptions, "NUM_CHUNK_THREADS");
+    if( pszNumThreads == nullptr )
+        return 1;
+    int nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : atoi(pszNumThreads);
+    return std::max(1, std::min(128, nThreads));
+}
+
+/************************************************************************/
+/*                    GDALWarpReopenSourceDataset()                     */
+/************************************************************************/
+
+// Open a private handle on the source dataset, so that several chunks can
+// read it at the same time.  Returns nullptr if the dataset cannot be
+// reopened identically (in-memory or anonymous datasets, etc.).
+static GDALDataset* GDALWarpReopenSourceDataset( GDALDataset* poSrcDS )
+{
+    if( poSrcDS == nullptr || poSrcDS->GetDriver() == nullptr ||
+        poSrcDS->GetAccess() != GA_ReadOnly ||
+        poSrcDS->GetDescription()[0] == '\0' )
+        return nullptr;
+
+    const char* const apszAllowedDrivers[] =
+        { poSrcDS->GetDriver()->GetDescription(), nullptr };
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    GDALDataset* poNewDS = GDALDataset::FromHandle(
+        GDALOpenEx( poSrcDS->GetDescription(),
+                    GDAL_OF_RASTER | GDAL_OF_INTERNAL,
+                    apszAllowedDrivers,
+                    poSrcDS->GetOpenOptions(), nullptr ));
+    CPLPopErrorHandler();
+    if( poNewDS != nullptr &&
+        (poNewDS->GetRasterXSize() != poSrcDS->GetRasterXSize() ||
+         poNewDS->GetRasterYSize() != poSrcDS->GetRasterYSize() ||
+         poNewDS->GetRasterCount() != poSrcDS->GetRasterCount()) )
+    {
+        GDALClose(poNewDS);
+        poNewDS = nullptr;
+    }
+    return poNewDS;
+}
+
+/************************************************************************/
+/*                       ChunkAndWarpPipelined()                        */
+/************************************************************************/
+
+namespace {
+
+// State shared between the calling thread and the workers of
+// ChunkAndWarpPipelined().
+struct GDALWarpPipelineContext
+{
+    std::mutex                       oMutex{};
+    std::condition_variable          oCond{};
+    std::vector<GDALWarpOperation*>  apoFreeOperations{};
+    int                              nRunningJobs = 0;
+    bool                             bStop = false;
+
+    // Serializes the accesses to the destination dataset.
+    std::mutex                       oDstMutex{};
+};
+
+struct GDALWarpPipelineJob
+{
+    GDALWarpPipelineContext *psContext = nullptr;
+    const GDALWarpChunk     *psChunk = nullptr;
+    void                    *pDstBuffer = nullptr;
+    CPLErr                   eErr = CE_None;
+    bool                     bDone = false;
+};
+
+struct GDALWarpPipelineWorker
+{
+    GDALWarpOperation *poOperation = nullptr;
+    GDALDataset       *poSrcDS = nullptr;
+    void              *pTransformerArg = nullptr;
+};
+
+} // namespace
+
+// Progress function installed on the worker operations: it only serves to
+// interrupt the kernels once the calling thread has requested to stop.
+static int CPL_STDCALL GDALWarpPipelineProgress( double, const char *,
+                                                 void *pProgressArg )
+{
+    GDALWarpPipelineContext* psContext =
+        static_cast<GDALWarpPipelineContext*>(pProgressArg);
+    std::lock_guard<std::mutex> oLock(psContext->oMutex);
+    return !psContext->bStop;
+}
+
+static void GDALWarpPipelineJobFunc( void *pData )
+{
+    GDALWarpPipelineJob* psJob = static_cast<GDALWarpPipelineJob*>(pData);
+    GDALWarpPipelineContext* psContext = psJob->psContext;
+    const GDALWarpChunk* psChunk = psJob->psChunk;
+
+    GDALWarpOperation* poOperation = nullptr;
+    bool bStop = false;
+    {
+        std::lock_guard<std::mutex> oLock(psContext->oMutex);
+        bStop = psContext->bStop;
+        // No more jobs than operations are running, so one is free.
+        poOperation = psContext->apoFreeOperations.back();
+        psContext->apoFreeOperations.pop_back();
+    }
+
+    const GDALWarpOptions* psWO = poOperation->GetOptions();
+    void* pDstBuffer = nullptr;
+    CPLErr eErr = bStop ? CE_Failure : CE_None;
+    if( eErr == CE_None )
+    {
+        int bInitialized = FALSE;
+        pDstBuffer = poOperation->CreateDestinationBuffer(
+            psChunk->dsx, psChunk->dsy, &bInitialized);
+        if( pDstBuffer == nullptr )
+            eErr = CE_Failure;
+        else if( !bInitialized )
+        {
+            std::lock_guard<std::mutex> oLock(psContext->oDstMutex);
+            eErr = GDALWarpReadDstBuffer( psWO, psChunk->dx, psChunk->dy,
+                                          psChunk->dsx, psChunk->dsy,
+                                          pDstBuffer );
+        }
+    }
+
+    if( eErr == CE_None )
+    {
+        eErr = poOperation->WarpRegionToBuffer(
+            psChunk->dx, psChunk->dy, psChunk->dsx, psChunk->dsy,
+            pDstBuffer, psWO->eWorkingDataType,
+            psChunk->sx, psChunk->sy, psChunk->ssx, psChunk->ssy,
+            psChunk->sExtraSx, psChunk->sExtraSy,
+            0.0, 1.0);
+    }
+
+    if( eErr != CE_None && pDstBuffer != nullptr )
+    {
+        GDALWarpOperation::DestroyDestinationBuffer(pDstBuffer);
+        pDstBuffer = nullptr;
+    }
+
+    std::lock_guard<std::mutex> oLock(psContext->oMutex);
+    psContext->apoFreeOperations.push_back(poOperation);
+    psJob->pDstBuffer = pDstBuffer;
+    psJob->eErr = eErr;
+    psJob->bDone = true;
+    psContext->nRunningJobs--;
+    psContext->oCond.notify_all();
+}
+
+// Warp the collected chunks with nThreads worker threads, each one owning
+// its own source dataset handle and transformer, while the calling thread
+// writes the completed chunks in order.  Returns false, without having
+// warped anything, if this mode cannot be used with the current options,
+// in which case the caller falls back to the two-thread scheme.
+bool GDALWarpOperation::ChunkAndWarpPipelined( int nThreads,
+                                               int nDstXSize, int nDstYSize,
+                                               CPLErr *peErr )
+{
+    // Those callbacks and the destination alpha band may carry state that
+    // is not safe to share between concurrent chunks.
+    if( psOptions->hDstDS == nullptr ||
+        psOptions->nDstAlphaBand > 0 ||
+        psOptions->pfnSrcDensityMaskFunc != nullptr ||
+        psOptions->pfnDstDensityMaskFunc != nullptr ||
+        psOptions->pfnSrcValidityMaskFunc != nullptr ||
+        psOptions->papfnSrcPerBandValidityMaskFunc != nullptr ||
+        psOptions->pfnDstValidityMaskFunc != nullptr ||
+        psOptions->pfnPreWarpChunkProcessor != nullptr ||
+        psOptions->pfnPostWarpChunkProcessor != nullptr ||
+        psOptions->pTransformerArg == nullptr )
+    {
+        return false;
+    }
+
+    nThreads = std::min(nThreads, nChunkListCount);
+
+    GDALWarpPipelineContext sContext;
+    std::vector<GDALWarpPipelineWorker> asWorkers;
+    const auto CleanupWorkers = [&asWorkers]()
+    {
+        for( auto& sWorker: asWorkers )
+        {
+            delete sWorker.poOperation;
+            if( sWorker.pTransformerArg )
+                GDALDestroyTransformer(sWorker.pTransformerArg);
+            if( sWorker.poSrcDS )
+                GDALClose(sWorker.poSrcDS);
+        }
+        asWorkers.clear();
+    };
+
+/* -------------------------------------------------------------------- */
+/*      Setup one warp operation per thread.                            */
+/* -------------------------------------------------------------------- */
+    GDALDataset* poSrcDS = GDALDataset::FromHandle(psOptions->hSrcDS);
+    bool bOK = true;
+    for( int i = 0; bOK && i < nThreads; i++ )
+    {
+        GDALWarpPipelineWorker sWorker;
+        sWorker.poSrcDS = GDALWarpReopenSourceDataset(poSrcDS);
+        if( sWorker.poSrcDS != nullptr )
+            sWorker.pTransformerArg =
+                GDALCloneTransformer(psOptions->pTransformerArg);
+        if( sWorker.pTransformerArg != nullptr )
+        {
+            GDALWarpOptions* psWO = GDALCloneWarpOptions(psOptions);
+            psWO->hSrcDS = GDALDataset::ToHandle(sWorker.poSrcDS);
+            psWO->pTransformerArg = sWorker.pTransformerArg;
+            psWO->pfnProgress = GDALWarpPipelineProgress;
+            psWO->pProgressArg = &sContext;
+            sWorker.poOperation = new GDALWarpOperation();
+            bOK = sWorker.poOperation->Initialize(psWO) == CE_None;
+            GDALDestroyWarpOptions(psWO);
+        }
+        else
+        {
+            bOK = false;
+        }
+        asWorkers.push_back(sWorker);
+    }
+
+    CPLWorkerThreadPool* poPool =
+        bOK ? CPLGetGlobalWorkerThreadPool(nThreads) : nullptr;
+    if( poPool == nullptr )
+    {
+        CPLDebug("WARP", "Cannot use NUM_CHUNK_THREADS on this warp. "
+                 "Falling back to ChunkAndWarpMulti() default behavior");
+        CleanupWorkers();
+        return false;
+    }
+
+    for( auto& sWorker: asWorkers )
+        sContext.apoFreeOperations.push_back(sWorker.poOperation);
+
+    CPLDebug("WARP", "Warping %d chunks with %d threads",
+             nChunkListCount, nThreads);
+    auto poJobQueue = poPool->CreateJobQueue();
+    const bool bWorkerThread = poPool->IsWorkerThread();
+
+/* -------------------------------------------------------------------- */
+/*      Keep up to two chunks per thread in flight, and write them      */
+/*      back in order as they complete. At most nThreads of them are    */
+/*      warped at once, one per worker operation, as the global pool    */
+/*      may have more threads.                                          */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALWarpPipelineJob> asJobs(nChunkListCount);
+    const int nMaxInFlight = 2 * nThreads;
+    const double dfTotalPixels = static_cast<double>(nDstXSize) * nDstYSize;
+    double dfPixelsWritten = 0.0;
+    int nSubmitted = 0;
+    CPLErr eErr = CE_None;
+
+    for( int iChunk = 0; iChunk < nChunkListCount; iChunk++ )
+    {
+        GDALWarpPipelineJob& sJob = asJobs[iChunk];
+        std::unique_lock<std::mutex> oLock(sContext.oMutex);
+        while( true )
+        {
+            while( nSubmitted < nChunkListCount &&
+                   nSubmitted - iChunk < nMaxInFlight &&
+                   sContext.nRunningJobs < nThreads )
+            {
+                GDALWarpPipelineJob& sNewJob = asJobs[nSubmitted];
+                sNewJob.psContext = &sContext;
+                sNewJob.psChunk = pasChunkList + nSubmitted;
+                sContext.nRunningJobs++;
+                oLock.unlock();
+                if( !poJobQueue->SubmitJob(GDALWarpPipelineJobFunc,
+                                           &sNewJob) )
+                {
+                    GDALWarpPipelineJobFunc(&sNewJob);
+                }
+                oLock.lock();
+                nSubmitted++;
+            }
+            if( sJob.bDone )
+                break;
+            if( bWorkerThread )
+            {
+                // Help the pool rather than blocking one of its threads.
+                oLock.unlock();
+                poJobQueue->WaitEvent();
+                oLock.lock();
+            }
+            else
+            {
+                sContext.oCond.wait(oLock);
+            }
+        }
+        oLock.unlock();
+
+        const GDALWarpChunk* psChunk = sJob.psChunk;
+        eErr = sJob.eErr;
+        if( eErr == CE_None )
+        {
+            std::lock_guard<std::mutex> oLock(sContext.oDstMutex);
+            eErr = GDALWarpWriteDstBuffer( psOptions, psChunk->dx, psChunk->dy,
+                                           psChunk->dsx, psChunk->dsy,
+                                           sJob.pDstBuffer );
+            if( eErr == CE_None && nFlushBlockYSize > 0 )
+                eErr = FlushCompletedTileRows( psChunk->dx, psChunk->dy,
+                                               psChunk->dsx, psChunk->dsy );
+        }
+        if( sJob.pDstBuffer )
+        {
+            DestroyDestinationBuffer(sJob.pDstBuffer);
+            sJob.pDstBuffer = nullptr;
+        }
+
+        if( eErr == CE_None )
+        {
+            dfPixelsWritten += psChunk->dsx * static_cast<double>(psChunk->dsy);
+            if( !psOptions->pfnProgress(dfPixelsWritten / dfTotalPixels, "",
+                                        psOptions->pProgressArg) )
+            {
+                CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+                eErr = CE_Failure;
+            }
+        }
+        if( eErr != CE_None )
+            break;
+    }
+
+    if( eErr != CE_None )
+    {
+        std::lock_guard<std::mutex> oLock(sContext.oMutex);
+        sContext.bStop = true;
+    }
+    poJobQueue->WaitCompletion();
+
+    for( auto& sJob: asJobs )
+    {
+        if( sJob.pDstBuffer )
+            DestroyDestinationBuffer(sJob.pDstBuffer);
+    }
+    CleanupWorkers();
+
+    *peErr = eErr;
+    return true;
+}
+
 /************************************************************************/
 /*                         ChunkAndWarpMulti()                          */
 /************************************************************************/
@@ -1091,6 +1537,24 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
 /* -------------------------------------------------------------------- */
     CollectChunkList( nDstXOff, nDstYOff, nDstXSize, nDstYSize );
 
+/* -------------------------------------------------------------------- */
+/*      Warp several chunks concurrently if requested.                  */
+/* -------------------------------------------------------------------- */
+    const int nChunkThreads =
+        GDALWarpGetChunkThreadCount(psOptions->papszWarpOptions);
+    if( nChunkThreads > 1 && nChunkListCount > 1 )
+    {
+        CPLErr eErr = CE_None;
+        if( ChunkAndWarpPipelined(nChunkThreads, nDstXSize, nDstYSize,
+                                  &eErr) )
+        {
+            CPLDestroyCond(hCond);
+            CPLDestroyMutex(hCondMutex);
+            WipeChunkList();
+            return eErr;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Process them one at a time, updating the progress               */
 /*      information for each region.                                    */
@@ -1231,6 +1695,157 @@ void GDALWarpOperation::WipeChunkList()
     pasChunkList = nullptr;
     nChunkListCount = 0;
     nChunkListMax = 0;
+    nFlushBlockYSize = 0;
+}
+
+/************************************************************************/
+/*                       SetupTileOrderedFlush()                        */
+/************************************************************************/
+
+// With TILE_ORDERED_OUTPUT, the chunks are aligned on the destination
+// blocks and sorted by tile row, so each tile is entirely written by a
+// single chunk. The completed tile rows can then be flushed in file order.
+// This requires the warped window itself to be aligned on the blocks.
+void GDALWarpOperation::SetupTileOrderedFlush( int nDstXOff, int nDstYOff,
+                                               int nDstXSize, int nDstYSize )
+{
+    nFlushBlockYSize = 0;
+    if( psOptions->hDstDS == nullptr ||
+        GDALGetRasterCount(psOptions->hDstDS) == 0 ||
+        !CPLFetchBool( psOptions->papszWarpOptions, "TILE_ORDERED_OUTPUT",
+                       false ) )
+        return;
+
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    GDALGetBlockSize(GDALGetRasterBand(psOptions->hDstDS, 1),
+                     &nBlockXSize, &nBlockYSize);
+    const int nRasterXSize = GDALGetRasterXSize(psOptions->hDstDS);
+    const int nRasterYSize = GDALGetRasterYSize(psOptions->hDstDS);
+    const int nDstXEnd = nDstXOff + nDstXSize;
+    const int nDstYEnd = nDstYOff + nDstYSize;
+    if( nBlockXSize <= 0 || nBlockYSize <= 0 ||
+        (nDstXOff % nBlockXSize) != 0 || (nDstYOff % nBlockYSize) != 0 ||
+        ((nDstXEnd % nBlockXSize) != 0 && nDstXEnd != nRasterXSize) ||
+        ((nDstYEnd % nBlockYSize) != 0 && nDstYEnd != nRasterYSize) )
+    {
+        CPLDebug("WARP", "TILE_ORDERED_OUTPUT: warped window is not aligned "
+                 "on destination blocks. Tiles will not be flushed in order");
+        return;
+    }
+
+    nFlushBlockXSize = nBlockXSize;
+    nFlushBlockYSize = nBlockYSize;
+    nFlushFirstBlockX = nDstXOff / nBlockXSize;
+    nFlushLastBlockX = DIV_ROUND_UP(nDstXEnd, nBlockXSize) - 1;
+    nFlushNextBlockY = nDstYOff / nBlockYSize;
+    nFlushYEnd = nDstYEnd;
+}
+
+/************************************************************************/
+/*                       FlushCompletedTileRows()                       */
+/************************************************************************/
+
+// Called once the indicated chunk has been written: flushes the tile rows
+// above the next chunk to warp, which cannot be written anymore.
+CPLErr GDALWarpOperation::FlushCompletedTileRows( int nDstXOff, int nDstYOff,
+                                                  int nDstXSize,
+                                                  int nDstYSize )
+{
+    // Locate the chunk in the list, sorted by OrderWarpChunk().
+    GDALWarpChunk sKey;
+    memset(&sKey, 0, sizeof(sKey));
+    sKey.dx = nDstXOff;
+    sKey.dy = nDstYOff;
+    GDALWarpChunk* psEnd = pasChunkList + nChunkListCount;
+    GDALWarpChunk* psChunk = std::lower_bound(pasChunkList, psEnd, sKey,
+        [](const GDALWarpChunk& a, const GDALWarpChunk& b)
+        { return OrderWarpChunk(&a, &b) < 0; });
+    if( psChunk == psEnd || psChunk->dx != nDstXOff ||
+        psChunk->dy != nDstYOff || psChunk->dsx != nDstXSize ||
+        psChunk->dsy != nDstYSize )
+        return CE_None;
+
+    const int nNextY = (psChunk + 1 < psEnd) ? psChunk[1].dy : nFlushYEnd;
+    const int nCompletedBlockY =
+        nNextY >= nFlushYEnd ? DIV_ROUND_UP(nFlushYEnd, nFlushBlockYSize) :
+                               nNextY / nFlushBlockYSize;
+
+    GDALDataset* poDstDS = GDALDataset::FromHandle(psOptions->hDstDS);
+    const int nBands = poDstDS->GetRasterCount();
+    CPLErr eErr = CE_None;
+    for( ; nFlushNextBlockY < nCompletedBlockY && eErr == CE_None;
+         nFlushNextBlockY++ )
+    {
+        for( int iBlockX = nFlushFirstBlockX;
+             iBlockX <= nFlushLastBlockX && eErr == CE_None; iBlockX++ )
+        {
+            for( int iBand = 1; iBand <= nBands && eErr == CE_None; iBand++ )
+            {
+                eErr = poDstDS->GetRasterBand(iBand)->FlushBlock(
+                    iBlockX, nFlushNextBlockY);
+            }
+        }
+    }
+    return eErr;
+}
+
+/************************************************************************/
+/*                    GDALWarpSourceWindowIsEmpty()                     */
+/*                                                                      */
+/*      Returns whether GDALGetDataCoverageStatus() reports a source    */
+/*      window as entirely empty, and the value empty areas are read    */
+/*      as (the band nodata value, or 0) makes every pixel invalid:     */
+/*      either a transparent source alpha band, or the source nodata   */
+/*      value of every band.                                            */
+/************************************************************************/
+
+static bool GDALWarpSourceWindowIsEmpty( const GDALWarpOptions* psOptions,
+                                         int nSrcXOff, int nSrcYOff,
+                                         int nSrcXSize, int nSrcYSize )
+{
+    const auto IsEmpty = [=](GDALRasterBandH hBand)
+    {
+        return GDALGetDataCoverageStatus(
+                    hBand, nSrcXOff, nSrcYOff, nSrcXSize, nSrcYSize,
+                    GDAL_DATA_COVERAGE_STATUS_DATA, nullptr) ==
+                                            GDAL_DATA_COVERAGE_STATUS_EMPTY;
+    };
+    const auto GetEmptyValue = [](GDALRasterBandH hBand)
+    {
+        int bHasNoData = FALSE;
+        const double dfNoData = GDALGetRasterNoDataValue(hBand, &bHasNoData);
+        return bHasNoData ? dfNoData : 0.0;
+    };
+
+    if( psOptions->hSrcDS == nullptr || psOptions->pfnPreWarpChunkProcessor )
+        return false;
+
+    if( psOptions->nSrcAlphaBand > 0 )
+    {
+        GDALRasterBandH hAlphaBand =
+            GDALGetRasterBand(psOptions->hSrcDS, psOptions->nSrcAlphaBand);
+        if( hAlphaBand != nullptr && GetEmptyValue(hAlphaBand) == 0.0 &&
+            IsEmpty(hAlphaBand) )
+            return true;
+    }
+
+    if( psOptions->padfSrcNoDataReal == nullptr || psOptions->nBandCount == 0 )
+        return false;
+    for( int i = 0; i < psOptions->nBandCount; i++ )
+    {
+        GDALRasterBandH hBand =
+            GDALGetRasterBand(psOptions->hSrcDS, psOptions->panSrcBands[i]);
+        if( hBand == nullptr )
+            return false;
+        const double dfEmptyValue = GetEmptyValue(hBand);
+        if( dfEmptyValue != psOptions->padfSrcNoDataReal[i] ||
+            (psOptions->padfSrcNoDataImag != nullptr &&
+             psOptions->padfSrcNoDataImag[i] != 0.0) ||
+            !IsEmpty(hBand) )
+            return false;
+    }
+    return true;
 }
 
 /************************************************************************/
@@ -1274,6 +1889,16 @@ CPLErr GDALWarpOperation::CollectChunkListInternal(
         && CPLFetchBool( psOptions->papszWarpOptions, "SKIP_NOSOURCE", false ))
         return CE_None;
 
+/* -------------------------------------------------------------------- */
+/*      Same if the source window only contains holes of a sparse       */
+/*      dataset that would be read as invalid pixels.                   */
+/* -------------------------------------------------------------------- */
+    if( nSrcXSize > 0 && nSrcYSize > 0 &&
+        CPLFetchBool( psOptions->papszWarpOptions, "SKIP_NOSOURCE", false ) &&
+        GDALWarpSourceWindowIsEmpty( psOptions, nSrcXOff, nSrcYOff,
+                                     nSrcXSize, nSrcYSize ) )
+        return CE_None;
+
 /* -------------------------------------------------------------------- */
 /*      Based on the types of masks in use, how many bits will each     */
 /*      source pixel cost us?                                           */
@@ -1357,7 +1982,11 @@ CPLErr GDALWarpOperation::CollectChunkListInternal(
          CPLFetchBool( psOptions->papszWarpOptions, "SRC_FILL_RATIO_HEURISTICS",
                        true )) )
     {
-        int bStreamableOutput =
+        // TILE_ORDERED_OUTPUT uses the same aligned cutting by tile rows.
+        const bool bTileOrderedOutput =
+            CPLFetchBool( psOptions->papszWarpOptions, "TILE_ORDERED_OUTPUT",
+                          false );
+        int bStreamableOutput = bTileOrderedOutput ||
             CPLFetchBool( psOptions->papszWarpOptions, "STREAMABLE_OUTPUT",
                           false );
         const bool bOptimizeSize =
@@ -1376,7 +2005,8 @@ CPLErr GDALWarpOperation::CollectChunkListInternal(
               (nDstXSize / 2 >= nBlockXSize || nDstYSize == 1)) ||
              (bStreamableOutput &&
               nDstXSize / 2 >= nBlockXSize &&
-              nDstYSize == nBlockYSize)) )
+              (nDstYSize == nBlockYSize ||
+               (bTileOrderedOutput && nDstYSize < nBlockYSize)))) )
         {
             bHasDivided = true;
             int nChunk1 = nDstXSize / 2;
@@ -1554,33 +2184,11 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
 /*      If we aren't doing fixed initialization of the output buffer    */
 /*      then read it from disk so we can overlay on existing imagery.   */
 /* -------------------------------------------------------------------- */
-    GDALDataset* poDstDS = reinterpret_cast<GDALDataset*>(psOptions->hDstDS);
     if( !bDstBufferInitialized )
     {
-        CPLErr eErr = CE_None;
-        if( psOptions->nBandCount == 1 )
-        {
-            // Particular case to simplify the stack a bit.
-            // TODO(rouault): Need an explanation of what and why r34502 helps.
-            eErr = poDstDS->GetRasterBand(psOptions->panDstBands[0])->RasterIO(
-                GF_Read,
-                nDstXOff, nDstYOff, nDstXSize, nDstYSize,
-                pDstBuffer, nDstXSize, nDstYSize,
-                psOptions->eWorkingDataType,
-                0, 0, nullptr);
-        }
-        else
-        {
-            eErr = poDstDS->RasterIO(
-                GF_Read,
-                nDstXOff, nDstYOff, nDstXSize, nDstYSize,
-                pDstBuffer, nDstXSize, nDstYSize,
-                psOptions->eWorkingDataType,
-                psOptions->nBandCount,
-                psOptions->panDstBands,
-                0, 0, 0, nullptr);
-        }
-
+        const CPLErr eErr =
+            GDALWarpReadDstBuffer( psOptions, nDstXOff, nDstYOff,
+                                   nDstXSize, nDstYSize, pDstBuffer );
         if( eErr != CE_None )
         {
             DestroyDestinationBuffer(pDstBuffer);
@@ -1605,38 +2213,11 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
 /* -------------------------------------------------------------------- */
     if( eErr == CE_None )
     {
-        if( psOptions->nBandCount == 1 )
-        {
-            // Particular case to simplify the stack a bit.
-            eErr = poDstDS->GetRasterBand(psOptions->panDstBands[0])->RasterIO(
-                  GF_Write,
-                  nDstXOff, nDstYOff, nDstXSize, nDstYSize,
-                  pDstBuffer, nDstXSize, nDstYSize,
-                  psOptions->eWorkingDataType,
-                  0, 0, nullptr );
-        }
-        else
-        {
-            eErr = poDstDS->RasterIO( GF_Write,
-                                    nDstXOff, nDstYOff, nDstXSize, nDstYSize,
-                                    pDstBuffer, nDstXSize, nDstYSize,
-                                    psOptions->eWorkingDataType,
-                                    psOptions->nBandCount,
-                                    psOptions->panDstBands,
-                                    0, 0, 0, nullptr );
-        }
-
-        if( eErr == CE_None &&
-            CPLFetchBool( psOptions->papszWarpOptions, "WRITE_FLUSH", false ) )
-        {
-            const CPLErr eOldErr = CPLGetLastErrorType();
-            const CPLString osLastErrMsg = CPLGetLastErrorMsg();
-            GDALFlushCache( psOptions->hDstDS );
-            const CPLErr eNewErr = CPLGetLastErrorType();
-            if( eNewErr != eOldErr ||
-                osLastErrMsg.compare(CPLGetLastErrorMsg()) != 0 )
-                eErr = CE_Failure;
-        }
+        eErr = GDALWarpWriteDstBuffer( psOptions, nDstXOff, nDstYOff,
+                                       nDstXSize, nDstYSize, pDstBuffer );
+        if( eErr == CE_None && nFlushBlockYSize > 0 )
+            eErr = FlushCompletedTileRows( nDstXOff, nDstYOff,
+                                           nDstXSize, nDstYSize );
         ReportTiming( "Output buffer write" );
     }
 
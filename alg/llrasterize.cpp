@@ -42,11 +42,6 @@
 
 CPL_CVSID("$Id: llrasterize.cpp 932fc9a9e36f82efdf1a22175e39ffe8ef03b46f 2019-02-21 22:11:37 +0100 Even Rouault $")
 
-static int llCompareInt(const void *a, const void *b)
-{
-    return *static_cast<const int*>(a) - *static_cast<const int*>(b);
-}
-
 /************************************************************************/
 /*                       dllImageFilledPolygon()                        */
 /*                                                                      */
@@ -147,9 +142,6 @@ No known bug
         int part = 0;
         int ints = 0;
 
-        // Initialize polyInts, otherwise it can sometimes causes a seg fault.
-        memset(polyInts, -1, sizeof(int) * n);
-
         for( int i = 0; i < n; i++ )
         {
             if( i == partoffset + panPartSize[part] )
@@ -225,14 +217,12 @@ No known bug
             }
         }
 
-        // It would be more efficient to do this inline, to avoid
-        // a function call for each comparison.
-        // NOTE - mloskot: make llCompareInt a functor and use std
-        // algorithm and it will be optimized and expanded
-        // automatically in compile-time, with modularity preserved.
-        //
-        // TODO(schwehr): Use std::sort.
-        qsort(polyInts, ints, sizeof(int), llCompareInt);
+        // Only the intersections found on this line are used, so there is
+        // no need to reset the whole buffer for each line.  With an odd
+        // number of intersections, the last span ends before the raster.
+        polyInts[ints] = -1;
+
+        std::sort(polyInts, polyInts + ints);
 
         for( int i = 0; i < ints; i += 2 )
         {
@@ -71,6 +71,14 @@ public:
         }
         return CE_None;
     }
+    // Start at line lineIdx rather than at the first line, previousLine
+    // being the content of line lineIdx - 1. This allows processing bands
+    // of lines independently.
+    void setStartLine( size_t lineIdx, const double* previousLine )
+    {
+        lineIdx_ = lineIdx;
+        std::copy( previousLine, previousLine + width_, previousLine_.begin() );
+    }
 private:
     size_t width_;
     size_t height_;
@@ -35,7 +35,10 @@
 #include <string.h>
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include "gdal_alg_priv.h"
@@ -47,6 +50,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 
 CPL_CVSID("$Id: polygonize.cpp fe2d81c8819bf9794bce0210098e637565728350 2018-05-06 00:49:51 +0200 Even Rouault $")
 
@@ -327,12 +331,11 @@ static void AddEdges( GInt32 *panThisLineId, GInt32 *panLastLineId,
 }
 
 /************************************************************************/
-/*                         EmitPolygonToLayer()                         */
+/*                         RPolygonToGeometry()                         */
 /************************************************************************/
 
-static CPLErr
-EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
-                    RPolygon *poRPoly, double *padfGeoTransform )
+static OGRGeometryH
+RPolygonToGeometry( RPolygon *poRPoly, double *padfGeoTransform )
 
 {
 /* -------------------------------------------------------------------- */
@@ -374,6 +377,20 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
         OGR_G_AddGeometryDirectly( hPolygon, hRing );
     }
 
+    return hPolygon;
+}
+
+/************************************************************************/
+/*                        WritePolygonFeature()                         */
+/*                                                                      */
+/*      Write a feature for the polygon, whose ownership is taken.      */
+/************************************************************************/
+
+static CPLErr
+WritePolygonFeature( OGRLayerH hOutLayer, int iPixValField,
+                     OGRGeometryH hPolygon, double dfPolyValue )
+
+{
 /* -------------------------------------------------------------------- */
 /*      Create the feature object.                                      */
 /* -------------------------------------------------------------------- */
@@ -382,7 +399,7 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
     OGR_F_SetGeometryDirectly( hFeat, hPolygon );
 
     if( iPixValField >= 0 )
-        OGR_F_SetFieldDouble( hFeat, iPixValField, poRPoly->dfPolyValue );
+        OGR_F_SetFieldDouble( hFeat, iPixValField, dfPolyValue );
 
 /* -------------------------------------------------------------------- */
 /*      Write the to the layer.                                         */
@@ -397,6 +414,21 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
     return eErr;
 }
 
+/************************************************************************/
+/*                         EmitPolygonToLayer()                         */
+/************************************************************************/
+
+static CPLErr
+EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
+                    RPolygon *poRPoly, double *padfGeoTransform )
+
+{
+    return WritePolygonFeature( hOutLayer, iPixValField,
+                                RPolygonToGeometry( poRPoly,
+                                                    padfGeoTransform ),
+                                poRPoly->dfPolyValue );
+}
+
 /************************************************************************/
 /*                          GPMaskImageData()                           */
 /*                                                                      */
@@ -426,6 +458,684 @@ GPMaskImageData( GDALRasterBandH hMaskBand, GByte* pabyMaskLine,
     return CE_None;
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*                      Strip based polygonization                      */
+/*                                                                      */
+/*      When NUM_THREADS is specified, the raster is cut into strips    */
+/*      of full width that are polygonized independently by worker      */
+/*      threads.  Polygons lying entirely within a strip are turned     */
+/*      into geometries by the workers.  Pieces touching a strip        */
+/*      boundary are handed back to the calling thread, which stitches  */
+/*      them across the seams with a union-find over the piece ids and  */
+/*      emits them as soon as they can no longer grow.                  */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+struct GPStripContext
+{
+    GDALRasterBandH  hSrcBand = nullptr;
+    GDALRasterBandH  hMaskBand = nullptr;
+    GDALDataType     eDT = GDT_Int32;
+    int              nXSize = 0;
+    int              nConnectedness = 4;
+    double          *padfGeoTransform = nullptr;
+
+    // Serializes the accesses to the source bands and to the output layer.
+    std::mutex              oIOMutex{};
+
+    std::mutex              oMutex{};
+    bool                    bStop = false;
+};
+
+template<class DataType> struct GPStripJob
+{
+    GPStripContext *psContext = nullptr;
+    int             iYStart = 0;
+    int             nLines = 0;
+    bool            bFirst = false;
+    bool            bLast = false;
+
+    CPLErr          eErr = CE_None;
+    bool            bDone = false;
+
+    // Geometries and values of the polygons lying entirely within the strip.
+    std::vector<std::pair<OGRGeometryH, double>> aoClosed{};
+
+    // Pieces of polygons touching the top or bottom row of the strip.
+    std::vector<std::unique_ptr<RPolygon>> apoOpen{};
+    std::vector<bool>     abOpenTouchBottom{};
+
+    // Values of the first and last rows, and index in apoOpen of the
+    // piece each of their pixels belongs to (-1 for nodata).
+    std::vector<DataType> anTopVal{};
+    std::vector<DataType> anBottomVal{};
+    std::vector<int>      anTopPiece{};
+    std::vector<int>      anBottomPiece{};
+
+    GPStripJob() = default;
+    ~GPStripJob()
+    {
+        for( auto& oClosed: aoClosed )
+            OGR_G_DestroyGeometry( oClosed.first );
+    }
+
+    CPL_DISALLOW_COPY_ASSIGN(GPStripJob)
+};
+
+} // namespace
+
+/************************************************************************/
+/*                         GPPolygonizeStrip()                          */
+/*                                                                      */
+/*      Run the two passes of GDALPolygonizeT() over a single strip.    */
+/*      Edges along the strip boundaries are left to the stitching      */
+/*      done by the calling thread, as only it knows whether the        */
+/*      pixels on both sides belong to the same polygon.                */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static CPLErr GPPolygonizeStrip( GPStripJob<DataType>* psJob )
+
+{
+    GPStripContext* psContext = psJob->psContext;
+    {
+        std::lock_guard<std::mutex> oLock(psContext->oMutex);
+        if( psContext->bStop )
+            return CE_Failure;
+    }
+
+    const int nXSize = psContext->nXSize;
+    const int nLines = psJob->nLines;
+    const int iYStart = psJob->iYStart;
+    const size_t nPixels = static_cast<size_t>(nXSize) * nLines;
+
+/* -------------------------------------------------------------------- */
+/*      Read the strip at once, so that the second pass does not        */
+/*      need to go back to the source band.                             */
+/* -------------------------------------------------------------------- */
+    std::unique_ptr<DataType, CPLFreeReleaser> panStripValHolder(
+        static_cast<DataType *>(
+            VSI_MALLOC3_VERBOSE(sizeof(DataType), nXSize, nLines)));
+    std::unique_ptr<GInt32, CPLFreeReleaser> panLineIdHolder(
+        static_cast<GInt32 *>(
+            VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize + 2, 2)));
+    std::unique_ptr<GByte, CPLFreeReleaser> pabyMaskHolder(
+        psContext->hMaskBand != nullptr
+        ? static_cast<GByte *>(VSI_MALLOC2_VERBOSE(nXSize, nLines))
+        : nullptr);
+
+    if( panStripValHolder == nullptr || panLineIdHolder == nullptr ||
+        (psContext->hMaskBand != nullptr && pabyMaskHolder == nullptr) )
+        return CE_Failure;
+
+    DataType *panStripVal = panStripValHolder.get();
+    GInt32 *panLastLineId = panLineIdHolder.get();
+    GInt32 *panThisLineId = panLastLineId + nXSize + 2;
+    GByte *pabyMask = pabyMaskHolder.get();
+
+    CPLErr eErr = CE_None;
+    {
+        std::lock_guard<std::mutex> oLock(psContext->oIOMutex);
+        eErr = GDALRasterIO( psContext->hSrcBand, GF_Read,
+                             0, iYStart, nXSize, nLines,
+                             panStripVal, nXSize, nLines, psContext->eDT,
+                             0, 0 );
+        if( eErr == CE_None && pabyMask != nullptr )
+            eErr = GDALRasterIO( psContext->hMaskBand, GF_Read,
+                                 0, iYStart, nXSize, nLines,
+                                 pabyMask, nXSize, nLines, GDT_Byte, 0, 0 );
+    }
+    if( eErr != CE_None )
+        return eErr;
+
+    if( pabyMask != nullptr )
+    {
+        for( size_t i = 0; i < nPixels; i++ )
+        {
+            if( pabyMask[i] == 0 )
+                panStripVal[i] = GP_NODATA_MARKER;
+        }
+        pabyMaskHolder.reset();
+    }
+
+/* -------------------------------------------------------------------- */
+/*      First pass: build the polygon id map of the strip, and          */
+/*      remember the ids of its first and last rows.                    */
+/* -------------------------------------------------------------------- */
+    GDALRasterPolygonEnumeratorT<DataType,
+                                 EqualityTest> oFirstEnum(
+                                     psContext->nConnectedness);
+
+    psJob->anTopPiece.resize(nXSize);
+    psJob->anBottomPiece.resize(nXSize);
+
+    for( int iLine = 0; iLine < nLines; iLine++ )
+    {
+        DataType *panThisLineVal =
+            panStripVal + static_cast<size_t>(iLine) * nXSize;
+
+        if( iLine == 0 )
+        {
+            oFirstEnum.ProcessLine(
+                nullptr, panThisLineVal, nullptr, panThisLineId, nXSize );
+            std::copy( panThisLineId, panThisLineId + nXSize,
+                       psJob->anTopPiece.begin() );
+        }
+        else
+        {
+            oFirstEnum.ProcessLine(
+                panThisLineVal - nXSize, panThisLineVal,
+                panLastLineId, panThisLineId,
+                nXSize );
+        }
+
+        std::swap(panLastLineId, panThisLineId);
+    }
+    std::copy( panLastLineId, panLastLineId + nXSize,
+               psJob->anBottomPiece.begin() );
+
+    oFirstEnum.CompleteMerges();
+
+    psJob->anTopVal.assign( panStripVal, panStripVal + nXSize );
+    psJob->anBottomVal.assign( panStripVal + nPixels - nXSize,
+                               panStripVal + nPixels );
+
+/* -------------------------------------------------------------------- */
+/*      Flag the polygons touching a boundary shared with another       */
+/*      strip: bit 0 for the top one, bit 1 for the bottom one.         */
+/* -------------------------------------------------------------------- */
+    const int nPolys = oFirstEnum.nNextPolygonId;
+    std::vector<GByte> abyTouch(nPolys, 0);
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        int &nTopId = psJob->anTopPiece[iX];
+        if( nTopId != -1 )
+        {
+            nTopId = oFirstEnum.panPolyIdMap[nTopId];
+            if( !psJob->bFirst )
+                abyTouch[nTopId] |= 1;
+        }
+        int &nBottomId = psJob->anBottomPiece[iX];
+        if( nBottomId != -1 )
+        {
+            nBottomId = oFirstEnum.panPolyIdMap[nBottomId];
+            if( !psJob->bLast )
+                abyTouch[nBottomId] |= 2;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Second pass, collecting the polygon edges.  When there is a     */
+/*      strip above, the previous line ids are made equal to the ones   */
+/*      of the first row so that no edge is generated along the top     */
+/*      boundary, and the line below the last row is skipped when       */
+/*      there is a strip below.                                         */
+/* -------------------------------------------------------------------- */
+    panThisLineId[0] = -1;
+    panThisLineId[nXSize+1] = -1;
+
+    for( int iX = 0; iX < nXSize+2; iX++ )
+        panLastLineId[iX] = -1;
+
+    GDALRasterPolygonEnumeratorT<DataType,
+                                 EqualityTest> oSecondEnum(
+                                     psContext->nConnectedness);
+    std::vector<RPolygon *> apoPoly(nPolys, nullptr);
+
+    const int nEdgeLines = psJob->bLast ? nLines + 1 : nLines;
+    for( int iLine = 0; eErr == CE_None && iLine < nEdgeLines; iLine++ )
+    {
+        const int iY = iYStart + iLine;
+        DataType *panThisLineVal =
+            panStripVal + static_cast<size_t>(iLine) * nXSize;
+
+        if( iLine == nLines )
+        {
+            for( int iX = 0; iX < nXSize+2; iX++ )
+                panThisLineId[iX] = -1;
+        }
+        else if( iLine == 0 )
+        {
+            oSecondEnum.ProcessLine(
+                nullptr, panThisLineVal, nullptr, panThisLineId+1, nXSize );
+            if( !psJob->bFirst )
+                memcpy( panLastLineId, panThisLineId,
+                        sizeof(GInt32) * (nXSize + 2) );
+        }
+        else
+        {
+            oSecondEnum.ProcessLine(
+                panThisLineVal - nXSize, panThisLineVal,
+                panLastLineId+1,  panThisLineId+1,
+                nXSize );
+        }
+
+        for( int iX = 0; iX < nXSize+1; iX++ )
+        {
+            AddEdges( panThisLineId, panLastLineId,
+                      oFirstEnum.panPolyIdMap, oFirstEnum.panPolyValue,
+                      apoPoly.data(), iX, iY );
+        }
+
+        if( iLine % 8 == 7 )
+        {
+            for( int iPoly = 0; iPoly < nPolys; iPoly++ )
+            {
+                if( apoPoly[iPoly] && abyTouch[iPoly] == 0 &&
+                    apoPoly[iPoly]->nLastLineUpdated < iY-1 )
+                {
+                    psJob->aoClosed.emplace_back(
+                        RPolygonToGeometry( apoPoly[iPoly],
+                                            psContext->padfGeoTransform ),
+                        apoPoly[iPoly]->dfPolyValue );
+
+                    delete apoPoly[iPoly];
+                    apoPoly[iPoly] = nullptr;
+                }
+            }
+
+            std::lock_guard<std::mutex> oLock(psContext->oMutex);
+            if( psContext->bStop )
+                eErr = CE_Failure;
+        }
+
+        std::swap(panLastLineId, panThisLineId);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Turn the remaining complete polygons into geometries, and       */
+/*      hand over the others for stitching.                             */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anPieceIndex(nPolys, -1);
+    for( int iPoly = 0; iPoly < nPolys; iPoly++ )
+    {
+        if( eErr == CE_None && abyTouch[iPoly] != 0 )
+        {
+            if( apoPoly[iPoly] == nullptr )
+                apoPoly[iPoly] = new RPolygon(oFirstEnum.panPolyValue[iPoly]);
+
+            anPieceIndex[iPoly] = static_cast<int>(psJob->apoOpen.size());
+            psJob->apoOpen.emplace_back( apoPoly[iPoly] );
+            psJob->abOpenTouchBottom.push_back( (abyTouch[iPoly] & 2) != 0 );
+            apoPoly[iPoly] = nullptr;
+        }
+        else if( eErr == CE_None && apoPoly[iPoly] != nullptr )
+        {
+            psJob->aoClosed.emplace_back(
+                RPolygonToGeometry( apoPoly[iPoly],
+                                    psContext->padfGeoTransform ),
+                apoPoly[iPoly]->dfPolyValue );
+        }
+
+        delete apoPoly[iPoly];
+    }
+
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        int &nTopId = psJob->anTopPiece[iX];
+        if( nTopId != -1 )
+            nTopId = anPieceIndex[nTopId];
+        int &nBottomId = psJob->anBottomPiece[iX];
+        if( nBottomId != -1 )
+            nBottomId = anPieceIndex[nBottomId];
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          GPStripJobFunc()                            */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static void GPStripJobFunc( void *pData )
+
+{
+    GPStripJob<DataType>* psJob = static_cast<GPStripJob<DataType>*>(pData);
+    GPStripContext* psContext = psJob->psContext;
+
+    const CPLErr eErr = GPPolygonizeStrip<DataType, EqualityTest>(psJob);
+
+    std::lock_guard<std::mutex> oLock(psContext->oMutex);
+    psJob->eErr = eErr;
+    psJob->bDone = true;
+}
+
+/************************************************************************/
+/*                           GPFindRoot()                               */
+/************************************************************************/
+
+static int GPFindRoot( std::vector<int>& anParent, int i )
+{
+    while( anParent[i] != i )
+    {
+        anParent[i] = anParent[anParent[i]];
+        i = anParent[i];
+    }
+    return i;
+}
+
+static void GPUnion( std::vector<int>& anParent, int i, int j )
+{
+    const int iRoot = GPFindRoot(anParent, i);
+    const int jRoot = GPFindRoot(anParent, j);
+    if( iRoot < jRoot )
+        anParent[jRoot] = iRoot;
+    else if( jRoot < iRoot )
+        anParent[iRoot] = jRoot;
+}
+
+/************************************************************************/
+/*                       GDALPolygonizeStripsT()                        */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static CPLErr
+GDALPolygonizeStripsT( GDALRasterBandH hSrcBand,
+                       GDALRasterBandH hMaskBand,
+                       OGRLayerH hOutLayer, int iPixValField,
+                       int nConnectedness, int nThreads, int nStripHeight,
+                       double *padfGeoTransform,
+                       GDALProgressFunc pfnProgress,
+                       void * pProgressArg,
+                       GDALDataType eDT )
+
+{
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+    const int nStrips =
+        nYSize / nStripHeight + ((nYSize % nStripHeight) != 0 ? 1 : 0);
+
+    CPLWorkerThreadPool *poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+    if( poPool == nullptr )
+        return CE_Failure;
+    auto poJobQueue = poPool->CreateJobQueue();
+
+    GPStripContext oContext;
+    oContext.hSrcBand = hSrcBand;
+    oContext.hMaskBand = hMaskBand;
+    oContext.eDT = eDT;
+    oContext.nXSize = nXSize;
+    oContext.nConnectedness = nConnectedness;
+    oContext.padfGeoTransform = padfGeoTransform;
+
+    // Pieces of the polygons that are still open, with the union-find
+    // linking the pieces that belong to the same polygon.
+    std::vector<std::unique_ptr<RPolygon>> apoPieces;
+    std::vector<int>  anParent;
+    std::vector<int>  anPieceStrip;
+    std::vector<bool> abPieceTouchBottom;
+
+    // Last row of the previous strip.
+    std::vector<DataType> anPrevBottomVal;
+    std::vector<int>      anPrevBottomPiece;
+
+    EqualityTest eq;
+    std::vector<std::unique_ptr<GPStripJob<DataType>>> apoJobs(nStrips);
+    const int nMaxJobsInFlight = 2 * nThreads;
+    int iNextJob = 0;
+    CPLErr eErr = CE_None;
+
+    const auto WriteFeature = [&]( OGRGeometryH hPolygon, double dfValue )
+    {
+        std::lock_guard<std::mutex> oLock(oContext.oIOMutex);
+        return WritePolygonFeature( hOutLayer, iPixValField,
+                                    hPolygon, dfValue );
+    };
+
+    for( int iStrip = 0; eErr == CE_None && iStrip < nStrips; iStrip++ )
+    {
+/* -------------------------------------------------------------------- */
+/*      Keep the workers busy, and wait for the current strip.          */
+/* -------------------------------------------------------------------- */
+        for( ; iNextJob < nStrips && iNextJob < iStrip + nMaxJobsInFlight;
+             iNextJob++ )
+        {
+            apoJobs[iNextJob].reset(new GPStripJob<DataType>());
+            GPStripJob<DataType>* psNewJob = apoJobs[iNextJob].get();
+            psNewJob->psContext = &oContext;
+            psNewJob->iYStart = iNextJob * nStripHeight;
+            psNewJob->nLines =
+                std::min(nStripHeight, nYSize - psNewJob->iYStart);
+            psNewJob->bFirst = iNextJob == 0;
+            psNewJob->bLast = iNextJob == nStrips - 1;
+            if( !poJobQueue->SubmitJob(
+                    GPStripJobFunc<DataType, EqualityTest>, psNewJob ) )
+                GPStripJobFunc<DataType, EqualityTest>( psNewJob );
+        }
+
+        GPStripJob<DataType>* psJob = apoJobs[iStrip].get();
+        {
+            // Wait until the jobs still running are the later ones; a
+            // worker thread runs queued jobs meanwhile.
+            std::unique_lock<std::mutex> oLock(oContext.oMutex);
+            while( !psJob->bDone )
+            {
+                int nLaterJobs = 0;
+                for( int i = iStrip + 1; i < iNextJob; i++ )
+                {
+                    if( !apoJobs[i]->bDone )
+                        nLaterJobs++;
+                }
+                oLock.unlock();
+                poJobQueue->WaitCompletion(nLaterJobs);
+                oLock.lock();
+            }
+        }
+        eErr = psJob->eErr;
+
+/* -------------------------------------------------------------------- */
+/*      Write the polygons that lie entirely within the strip.          */
+/* -------------------------------------------------------------------- */
+        for( auto& oClosed: psJob->aoClosed )
+        {
+            if( eErr == CE_None )
+                eErr = WriteFeature( oClosed.first, oClosed.second );
+            else
+                OGR_G_DestroyGeometry( oClosed.first );
+        }
+        psJob->aoClosed.clear();
+        if( eErr != CE_None )
+            break;
+
+/* -------------------------------------------------------------------- */
+/*      Register the pieces touching the strip boundaries.              */
+/* -------------------------------------------------------------------- */
+        const int nBase = static_cast<int>(apoPieces.size());
+        for( size_t i = 0; i < psJob->apoOpen.size(); i++ )
+        {
+            anParent.push_back( static_cast<int>(apoPieces.size()) );
+            apoPieces.emplace_back( std::move(psJob->apoOpen[i]) );
+            anPieceStrip.push_back( iStrip );
+            abPieceTouchBottom.push_back( psJob->abOpenTouchBottom[i] );
+        }
+
+        if( !psJob->bFirst )
+        {
+/* -------------------------------------------------------------------- */
+/*      Merge the pieces on both sides of the seam, with the same       */
+/*      rules as GDALRasterPolygonEnumeratorT::ProcessLine().           */
+/* -------------------------------------------------------------------- */
+            const DataType *panLastVal = &anPrevBottomVal[0];
+            const DataType *panThisVal = &psJob->anTopVal[0];
+            const int *panLast = &anPrevBottomPiece[0];
+
+            for( int i = 0; i < nXSize; i++ )
+            {
+                if( panThisVal[i] == GP_NODATA_MARKER )
+                    continue;
+
+                const int nThis = nBase + psJob->anTopPiece[i];
+
+                if( i > 0 && eq(panThisVal[i], panThisVal[i-1]) )
+                {
+                    if( eq(panLastVal[i], panThisVal[i]) )
+                        GPUnion( anParent, panLast[i], nThis );
+
+                    if( nConnectedness == 8
+                        && eq(panLastVal[i-1], panThisVal[i]) )
+                        GPUnion( anParent, panLast[i-1], nThis );
+
+                    if( nConnectedness == 8 && i < nXSize-1
+                        && eq(panLastVal[i+1], panThisVal[i]) )
+                        GPUnion( anParent, panLast[i+1], nThis );
+                }
+                else if( eq(panLastVal[i], panThisVal[i]) )
+                {
+                    GPUnion( anParent, panLast[i], nThis );
+                }
+                else if( i > 0 && nConnectedness == 8
+                         && eq(panLastVal[i-1], panThisVal[i]) )
+                {
+                    GPUnion( anParent, panLast[i-1], nThis );
+
+                    if( i < nXSize-1 &&
+                        eq(panLastVal[i+1], panThisVal[i]) )
+                        GPUnion( anParent, panLast[i+1], nThis );
+                }
+                else if( i < nXSize-1 && nConnectedness == 8
+                         && eq(panLastVal[i+1], panThisVal[i]) )
+                {
+                    GPUnion( anParent, panLast[i+1], nThis );
+                }
+            }
+
+/* -------------------------------------------------------------------- */
+/*      Add the edges along the seam between different polygons.        */
+/* -------------------------------------------------------------------- */
+            const int iY = psJob->iYStart;
+            for( int i = 0; i < nXSize; i++ )
+            {
+                const int nAbove = panLast[i];
+                const int nBelow =
+                    psJob->anTopPiece[i] != -1 ? nBase + psJob->anTopPiece[i]
+                                               : -1;
+                const int nAboveRoot =
+                    nAbove != -1 ? GPFindRoot(anParent, nAbove) : -1;
+                const int nBelowRoot =
+                    nBelow != -1 ? GPFindRoot(anParent, nBelow) : -1;
+                if( nAboveRoot == nBelowRoot )
+                    continue;
+
+                if( nBelow != -1 )
+                    apoPieces[nBelow]->AddSegment( i, iY, i+1, iY );
+                if( nAbove != -1 )
+                    apoPieces[nAbove]->AddSegment( i, iY, i+1, iY );
+            }
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Polygons are complete once none of their pieces touches the     */
+/*      bottom of the current strip.  Emit them, and compact the        */
+/*      state of the open ones.                                         */
+/* -------------------------------------------------------------------- */
+        const int nPieces = static_cast<int>(apoPieces.size());
+        std::vector<int> anRoot(nPieces);
+        std::vector<bool> abRootOpen(nPieces, false);
+        for( int i = 0; i < nPieces; i++ )
+        {
+            anRoot[i] = GPFindRoot(anParent, i);
+            if( !psJob->bLast && anPieceStrip[i] == iStrip &&
+                abPieceTouchBottom[i] )
+                abRootOpen[anRoot[i]] = true;
+        }
+
+        std::map<int, std::vector<int>> oMapClosed;
+        for( int i = 0; i < nPieces; i++ )
+        {
+            if( !abRootOpen[anRoot[i]] )
+                oMapClosed[anRoot[i]].push_back(i);
+        }
+
+        for( const auto& oIter: oMapClosed )
+        {
+            // Start with the piece reaching the topmost row, whose first
+            // string is therefore part of the outer ring.
+            const std::vector<int>& anMembers = oIter.second;
+            int iFirst = -1;
+            for( int iPiece: anMembers )
+            {
+                if( apoPieces[iPiece]->aanXY.empty() )
+                    continue;
+                if( iFirst < 0 || apoPieces[iPiece]->aanXY[0][1] <
+                                  apoPieces[iFirst]->aanXY[0][1] )
+                    iFirst = iPiece;
+            }
+            if( iFirst < 0 || eErr != CE_None )
+                continue;
+
+            RPolygon *poMerged = apoPieces[iFirst].get();
+            for( int iPiece: anMembers )
+            {
+                if( iPiece == iFirst )
+                    continue;
+                for( auto& anString: apoPieces[iPiece]->aanXY )
+                    poMerged->aanXY.emplace_back( std::move(anString) );
+            }
+
+            eErr = WriteFeature(
+                RPolygonToGeometry( poMerged, padfGeoTransform ),
+                poMerged->dfPolyValue );
+        }
+
+        std::vector<int> anNewIndex(nPieces, -1);
+        int nNewPieces = 0;
+        for( int i = 0; i < nPieces; i++ )
+        {
+            if( abRootOpen[anRoot[i]] )
+            {
+                anNewIndex[i] = nNewPieces;
+                if( nNewPieces != i )
+                    apoPieces[nNewPieces] = std::move(apoPieces[i]);
+                anPieceStrip[nNewPieces] = anPieceStrip[i];
+                abPieceTouchBottom[nNewPieces] = abPieceTouchBottom[i];
+                nNewPieces++;
+            }
+        }
+        for( int i = 0; i < nPieces; i++ )
+        {
+            if( anNewIndex[i] >= 0 )
+                anParent[anNewIndex[i]] = anNewIndex[anRoot[i]];
+        }
+        apoPieces.resize(nNewPieces);
+        anParent.resize(nNewPieces);
+        anPieceStrip.resize(nNewPieces);
+        abPieceTouchBottom.resize(nNewPieces);
+
+        anPrevBottomVal = std::move(psJob->anBottomVal);
+        anPrevBottomPiece = std::move(psJob->anBottomPiece);
+        for( int& nPiece: anPrevBottomPiece )
+        {
+            if( nPiece != -1 )
+                nPiece = anNewIndex[nBase + nPiece];
+        }
+
+        apoJobs[iStrip].reset();
+
+/* -------------------------------------------------------------------- */
+/*      Report progress, and support interrupts.                        */
+/* -------------------------------------------------------------------- */
+        if( eErr == CE_None
+            && !pfnProgress( (iStrip + 1) / static_cast<double>(nStrips),
+                             "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> oLock(oContext.oMutex);
+        oContext.bStop = true;
+    }
+    poJobQueue->WaitCompletion();
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                           GDALPolygonizeT()                          */
 /************************************************************************/
@@ -461,6 +1171,54 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
         return CE_Failure;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Get the geotransform, if there is one, so we can convert the    */
+/*      vectors into georeferenced coordinates.                         */
+/* -------------------------------------------------------------------- */
+    double adfGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+
+    const char* pszDatasetForGeoRef = CSLFetchNameValue(papszOptions,
+                                                        "DATASET_FOR_GEOREF");
+    if( pszDatasetForGeoRef )
+    {
+        GDALDatasetH hSrcDS = GDALOpen(pszDatasetForGeoRef, GA_ReadOnly);
+        if( hSrcDS )
+        {
+            GDALGetGeoTransform( hSrcDS, adfGeoTransform );
+            GDALClose(hSrcDS);
+        }
+    }
+    else
+    {
+        GDALDatasetH hSrcDS = GDALGetBandDataset( hSrcBand );
+        if( hSrcDS )
+            GDALGetGeoTransform( hSrcDS, adfGeoTransform );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Use the strip based algorithm if multithreading was requested.  */
+/* -------------------------------------------------------------------- */
+    const char* pszNumThreads = CSLFetchNameValue(papszOptions, "NUM_THREADS");
+    if( pszNumThreads != nullptr )
+    {
+        const int nThreads = CPLGetNumThreads(papszOptions);
+
+        int nStripHeight = atoi(
+            CSLFetchNameValueDef(papszOptions, "STRIP_HEIGHT", "256"));
+        if( nStripHeight < 1 )
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "Invalid value for STRIP_HEIGHT: %s",
+                     CSLFetchNameValue(papszOptions, "STRIP_HEIGHT"));
+            return CE_Failure;
+        }
+
+        return GDALPolygonizeStripsT<DataType, EqualityTest>(
+            hSrcBand, hMaskBand, hOutLayer, iPixValField,
+            nConnectedness, nThreads, nStripHeight, adfGeoTransform,
+            pfnProgress, pProgressArg, eDT);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Allocate working buffers.                                       */
 /* -------------------------------------------------------------------- */
@@ -493,30 +1251,6 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
         return CE_Failure;
     }
 
-/* -------------------------------------------------------------------- */
-/*      Get the geotransform, if there is one, so we can convert the    */
-/*      vectors into georeferenced coordinates.                         */
-/* -------------------------------------------------------------------- */
-    double adfGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
-
-    const char* pszDatasetForGeoRef = CSLFetchNameValue(papszOptions,
-                                                        "DATASET_FOR_GEOREF");
-    if( pszDatasetForGeoRef )
-    {
-        GDALDatasetH hSrcDS = GDALOpen(pszDatasetForGeoRef, GA_ReadOnly);
-        if( hSrcDS )
-        {
-            GDALGetGeoTransform( hSrcDS, adfGeoTransform );
-            GDALClose(hSrcDS);
-        }
-    }
-    else
-    {
-        GDALDatasetH hSrcDS = GDALGetBandDataset( hSrcBand );
-        if( hSrcDS )
-            GDALGetGeoTransform( hSrcDS, adfGeoTransform );
-    }
-
 /* -------------------------------------------------------------------- */
 /*      The first pass over the raster is only used to build up the     */
 /*      polygon id map so we will know in advance what polygons are     */
@@ -814,6 +1548,16 @@ GBool GDALFloatEquals( float A, float B )
  * <dl>
  * <dt>"8CONNECTED":</dt> May be set to "8" to use 8 connectedness.
  * Otherwise 4 connectedness will be applied to the algorithm
+ * <dt>"NUM_THREADS":</dt> (GDAL >= 3.1) May be set to a number of worker
+ * threads, or ALL_CPUS.  The raster is then cut into strips that are
+ * polygonized in parallel, and polygons are stitched across the strip
+ * boundaries.  Memory use is then bounded by the strip size and the
+ * polygons crossing the current strip boundary, rather than by the whole
+ * polygon enumeration.  Polygons are written in a different order than
+ * the default algorithm, and may have redundant vertices on the strip
+ * boundaries.
+ * <dt>"STRIP_HEIGHT":</dt> (GDAL >= 3.1) Number of lines of the strips
+ * when NUM_THREADS is set.  Defaults to 256.
  * </dl>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
@@ -890,6 +1634,16 @@ GDALPolygonize( GDALRasterBandH hSrcBand,
  * <dl>
  * <dt>"8CONNECTED":</dt> May be set to "8" to use 8 connectedness.
  * Otherwise 4 connectedness will be applied to the algorithm
+ * <dt>"NUM_THREADS":</dt> (GDAL >= 3.1) May be set to a number of worker
+ * threads, or ALL_CPUS.  The raster is then cut into strips that are
+ * polygonized in parallel, and polygons are stitched across the strip
+ * boundaries.  Memory use is then bounded by the strip size and the
+ * polygons crossing the current strip boundary, rather than by the whole
+ * polygon enumeration.  Polygons are written in a different order than
+ * the default algorithm, and may have redundant vertices on the strip
+ * boundaries.
+ * <dt>"STRIP_HEIGHT":</dt> (GDAL >= 3.1) Number of lines of the strips
+ * when NUM_THREADS is set.  Defaults to 256.
  * </dl>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
@@ -35,14 +35,17 @@
 #include <cstring>
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 
 CPL_CVSID("$Id: rasterfill.cpp 47fc5963633c59f05e820ca575bbddfe88573739 2020-01-07 21:15:46 +0100 Even Rouault $")
@@ -365,6 +368,580 @@ inline void QUAD_CHECK(double& dfQuadDist, float& fQuadValue,
     }
 }
 
+/************************************************************************/
+/*                    GDALFillNodataInterpolateLine()                   */
+/*                                                                      */
+/*      Interpolate the nodata pixels of one scanline from the "last    */
+/*      known value" information of the top down pass (which            */
+/*      includes this line) and of the bottom up pass (which stops at   */
+/*      the line below).  Lines are independent of each other, so this  */
+/*      can be run from worker threads.                                 */
+/************************************************************************/
+
+namespace {
+
+struct GDALFillNodataParams
+{
+    int         nXSize;
+    double      dfMaxSearchDist;
+    int         nMaxSearchDist;
+    GUInt32     nNoDataVal;
+    bool        bHasNoData;
+    float       fNoData;
+};
+
+struct GDALFillNodataLine
+{
+    const GDALFillNodataParams *psParams;
+    int             iY;
+    const GUInt32  *panTopDownY;
+    const float    *pafTopDownValue;
+    const GUInt32  *panLastY;
+    const float    *pafLastValue;
+    GByte          *pabyMask;
+    GByte          *pabyFiltMask;
+    float          *pafScanline;
+};
+
+} // namespace
+
+static void GDALFillNodataInterpolateLine( void *pData )
+{
+    const GDALFillNodataLine *psLine =
+        static_cast<const GDALFillNodataLine *>(pData);
+    const GDALFillNodataParams *psParams = psLine->psParams;
+
+    const int nXSize = psParams->nXSize;
+    const double dfMaxSearchDist = psParams->dfMaxSearchDist;
+    const int nMaxSearchDist = psParams->nMaxSearchDist;
+    const GUInt32 nNoDataVal = psParams->nNoDataVal;
+    const bool bHasNoData = psParams->bHasNoData;
+    const float fNoData = psParams->fNoData;
+
+    const int iY = psLine->iY;
+    const GUInt32 *panTopDownY = psLine->panTopDownY;
+    const float *pafTopDownValue = psLine->pafTopDownValue;
+    const GUInt32 *panLastY = psLine->panLastY;
+    const float *pafLastValue = psLine->pafLastValue;
+    GByte *pabyMask = psLine->pabyMask;
+    GByte *pabyFiltMask = psLine->pabyFiltMask;
+    float *pafScanline = psLine->pafScanline;
+
+    memset( pabyFiltMask, 0, nXSize );
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        int nThisMaxSearchDist = nMaxSearchDist;
+
+        // If this was a valid target - no change.
+        if( pabyMask[iX] )
+            continue;
+
+        // Quadrants 0:topleft, 1:bottomleft, 2:topright, 3:bottomright
+        double adfQuadDist[4] = {};
+        float fQuadValue[4] = {};
+
+        for( int iQuad = 0; iQuad < 4; iQuad++ )
+        {
+            adfQuadDist[iQuad] = dfMaxSearchDist + 1.0;
+            fQuadValue[iQuad] = 0.0;
+        }
+
+        // Step left and right by one pixel searching for the closest
+        // target value for each quadrant.
+        for( int iStep = 0; iStep <= nThisMaxSearchDist; iStep++ )
+        {
+            const int iLeftX = std::max(0, iX - iStep);
+            const int iRightX = std::min(nXSize - 1, iX + iStep);
+
+            // Top left includes current line.
+            QUAD_CHECK(adfQuadDist[0], fQuadValue[0],
+                       iLeftX, panTopDownY[iLeftX], iX, iY,
+                       pafTopDownValue[iLeftX], nNoDataVal );
+
+            // Bottom left.
+            QUAD_CHECK(adfQuadDist[1], fQuadValue[1],
+                       iLeftX, panLastY[iLeftX], iX, iY,
+                       pafLastValue[iLeftX], nNoDataVal );
+
+            // Top right and bottom right do no include center pixel.
+            if( iStep == 0 )
+                 continue;
+
+            // Top right includes current line.
+            QUAD_CHECK(adfQuadDist[2], fQuadValue[2],
+                       iRightX, panTopDownY[iRightX], iX, iY,
+                       pafTopDownValue[iRightX], nNoDataVal );
+
+            // Bottom right.
+            QUAD_CHECK(adfQuadDist[3], fQuadValue[3],
+                       iRightX, panLastY[iRightX], iX, iY,
+                       pafLastValue[iRightX], nNoDataVal );
+
+            // Every four steps, recompute maximum distance.
+            if( (iStep & 0x3) == 0 )
+                nThisMaxSearchDist = static_cast<int>(floor(
+                    std::max(std::max(adfQuadDist[0], adfQuadDist[1]),
+                             std::max(adfQuadDist[2], adfQuadDist[3]))));
+        }
+
+        double dfWeightSum = 0.0;
+        double dfValueSum = 0.0;
+        bool bHasSrcValues = false;
+
+        for( int iQuad = 0; iQuad < 4; iQuad++ )
+        {
+            if( adfQuadDist[iQuad] <= dfMaxSearchDist )
+            {
+                const double dfWeight = 1.0 / adfQuadDist[iQuad];
+
+                bHasSrcValues = dfWeight != 0;
+                if( !bHasNoData || fQuadValue[iQuad] != fNoData )
+                {
+                    dfWeightSum += dfWeight;
+                    dfValueSum += fQuadValue[iQuad] * dfWeight;
+                }
+            }
+        }
+
+        if( bHasSrcValues )
+        {
+            pabyMask[iX] = 255;
+            pabyFiltMask[iX] = 255;
+            if( dfWeightSum > 0.0 )
+                pafScanline[iX] = static_cast<float>(dfValueSum / dfWeightSum);
+            else
+                pafScanline[iX] = fNoData;
+        }
+    }
+}
+
+/************************************************************************/
+/*                       GDALFillNodataPushPull()                       */
+/*                                                                      */
+/*      Multi-resolution ("push-pull") interpolation.  The band is      */
+/*      loaded in memory with a weight of 1 for valid pixels and 0      */
+/*      for pixels to interpolate.  It is reduced by successive 2x2     */
+/*      weighted averages (push), and the nodata pixels of each level   */
+/*      are then blended with the bilinear interpolation of the         */
+/*      coarser level, from the coarsest level down to the full         */
+/*      resolution (pull).  The cost is linear in the number of         */
+/*      pixels, whatever the size of the gaps.                          */
+/************************************************************************/
+
+namespace {
+
+struct GDALFillNodataLevel
+{
+    int         nXSize;
+    int         nYSize;
+    float      *pafValue;
+    float      *pafWeight;
+    // Only for the full resolution level: pixels that must not be changed.
+    const GByte *pabyMask;
+};
+
+struct GDALFillNodataLevelJob
+{
+    GDALFillNodataLevel *psFine;
+    GDALFillNodataLevel *psCoarse;
+    int                  nYStart;
+    int                  nYEnd;
+};
+
+} // namespace
+
+// Compute lines [nYStart, nYEnd[ of the coarse level from the fine level.
+static void GDALFillNodataReduceJob( void *pData )
+{
+    const GDALFillNodataLevelJob *psJob =
+        static_cast<const GDALFillNodataLevelJob *>(pData);
+    const GDALFillNodataLevel *psFine = psJob->psFine;
+    GDALFillNodataLevel *psCoarse = psJob->psCoarse;
+
+    for( int iY = psJob->nYStart; iY < psJob->nYEnd; iY++ )
+    {
+        const int iFineY0 = 2 * iY;
+        const int iFineY1 = std::min(iFineY0 + 1, psFine->nYSize - 1);
+        for( int iX = 0; iX < psCoarse->nXSize; iX++ )
+        {
+            const int iFineX0 = 2 * iX;
+            const int iFineX1 = std::min(iFineX0 + 1, psFine->nXSize - 1);
+            double dfWeightSum = 0.0;
+            double dfValueSum = 0.0;
+            for( int iFineY = iFineY0; iFineY <= iFineY1; iFineY++ )
+            {
+                for( int iFineX = iFineX0; iFineX <= iFineX1; iFineX++ )
+                {
+                    const size_t iOffset =
+                        static_cast<size_t>(iFineY) * psFine->nXSize + iFineX;
+                    const double dfWeight = psFine->pafWeight[iOffset];
+                    if( dfWeight > 0.0 )
+                    {
+                        dfWeightSum += dfWeight;
+                        dfValueSum += dfWeight * psFine->pafValue[iOffset];
+                    }
+                }
+            }
+            const size_t iOffset =
+                static_cast<size_t>(iY) * psCoarse->nXSize + iX;
+            if( dfWeightSum > 0.0 )
+            {
+                psCoarse->pafValue[iOffset] =
+                    static_cast<float>(dfValueSum / dfWeightSum);
+                psCoarse->pafWeight[iOffset] =
+                    static_cast<float>(std::min(1.0, dfWeightSum));
+            }
+            else
+            {
+                psCoarse->pafValue[iOffset] = 0.0f;
+                psCoarse->pafWeight[iOffset] = 0.0f;
+            }
+        }
+    }
+}
+
+// Blend lines [nYStart, nYEnd[ of the fine level with the bilinear
+// interpolation of the coarse level.
+static void GDALFillNodataExpandJob( void *pData )
+{
+    const GDALFillNodataLevelJob *psJob =
+        static_cast<const GDALFillNodataLevelJob *>(pData);
+    GDALFillNodataLevel *psFine = psJob->psFine;
+    const GDALFillNodataLevel *psCoarse = psJob->psCoarse;
+
+    for( int iY = psJob->nYStart; iY < psJob->nYEnd; iY++ )
+    {
+        // Position of the center of the fine pixel in the coarse level.
+        const double dfCoarseY = 0.5 * iY - 0.25;
+        const int iCoarseY = static_cast<int>(floor(dfCoarseY));
+        const double dfDY = dfCoarseY - iCoarseY;
+        const int aiCoarseY[2] = {
+            std::max(0, iCoarseY),
+            std::min(psCoarse->nYSize - 1, iCoarseY + 1) };
+        const double adfWeightY[2] = { 1.0 - dfDY, dfDY };
+
+        for( int iX = 0; iX < psFine->nXSize; iX++ )
+        {
+            const size_t iOffset =
+                static_cast<size_t>(iY) * psFine->nXSize + iX;
+            const double dfWeight = psFine->pafWeight[iOffset];
+            if( dfWeight >= 1.0 ||
+                (psFine->pabyMask != nullptr && psFine->pabyMask[iOffset]) )
+                continue;
+
+            const double dfCoarseX = 0.5 * iX - 0.25;
+            const int iCoarseX = static_cast<int>(floor(dfCoarseX));
+            const double dfDX = dfCoarseX - iCoarseX;
+            const int aiCoarseX[2] = {
+                std::max(0, iCoarseX),
+                std::min(psCoarse->nXSize - 1, iCoarseX + 1) };
+            const double adfWeightX[2] = { 1.0 - dfDX, dfDX };
+
+            double dfInterpWeightSum = 0.0;
+            double dfInterpValueSum = 0.0;
+            for( int j = 0; j < 2; j++ )
+            {
+                for( int i = 0; i < 2; i++ )
+                {
+                    const size_t iCoarseOffset =
+                        static_cast<size_t>(aiCoarseY[j]) * psCoarse->nXSize +
+                        aiCoarseX[i];
+                    if( psCoarse->pafWeight[iCoarseOffset] > 0.0f )
+                    {
+                        const double dfInterpWeight =
+                            adfWeightY[j] * adfWeightX[i];
+                        dfInterpWeightSum += dfInterpWeight;
+                        dfInterpValueSum += dfInterpWeight *
+                            psCoarse->pafValue[iCoarseOffset];
+                    }
+                }
+            }
+            if( dfInterpWeightSum > 0.0 )
+            {
+                psFine->pafValue[iOffset] = static_cast<float>(
+                    dfWeight * psFine->pafValue[iOffset] +
+                    (1.0 - dfWeight) * dfInterpValueSum / dfInterpWeightSum);
+                psFine->pafWeight[iOffset] = 1.0f;
+            }
+        }
+    }
+}
+
+// Run pfnJob over all the lines of the level of size nYSize, splitting
+// them among nThreads worker threads if there is a job queue.
+static void GDALFillNodataRunLevelJob( CPLJobQueue *poJobQueue, int nThreads,
+                                       CPLThreadFunc pfnJob,
+                                       GDALFillNodataLevel *psFine,
+                                       GDALFillNodataLevel *psCoarse,
+                                       int nYSize )
+{
+    const int nJobs = poJobQueue == nullptr ? 1 :
+        std::max(1, std::min(nYSize, 4 * nThreads));
+    std::vector<GDALFillNodataLevelJob> asJobs(nJobs);
+    for( int i = 0; i < nJobs; i++ )
+    {
+        asJobs[i].psFine = psFine;
+        asJobs[i].psCoarse = psCoarse;
+        asJobs[i].nYStart =
+            static_cast<int>(static_cast<GIntBig>(nYSize) * i / nJobs);
+        asJobs[i].nYEnd =
+            static_cast<int>(static_cast<GIntBig>(nYSize) * (i + 1) / nJobs);
+    }
+    if( nJobs == 1 )
+    {
+        pfnJob(&asJobs[0]);
+        return;
+    }
+    for( int i = 0; i < nJobs; i++ )
+    {
+        if( !poJobQueue->SubmitJob(pfnJob, &asJobs[i]) )
+            pfnJob(&asJobs[i]);
+    }
+    poJobQueue->WaitCompletion();
+}
+
+static CPLErr
+GDALFillNodataPushPull( GDALRasterBandH hTargetBand,
+                        GDALRasterBandH hMaskBand,
+                        double dfMaxSearchDist,
+                        int nSmoothingIterations,
+                        bool bHasNoData, float fNoData,
+                        int nThreads,
+                        GDALDriverH hDriver,
+                        char **papszWorkFileOptions,
+                        GDALProgressFunc pfnProgress,
+                        void * pProgressArg )
+{
+    const int nXSize = GDALGetRasterBandXSize(hTargetBand);
+    const int nYSize = GDALGetRasterBandYSize(hTargetBand);
+
+    // If there are smoothing iterations, reserve 10% of the progress for them.
+    const double dfProgressRatio = nSmoothingIterations > 0 ? 0.9 : 1.0;
+
+/* -------------------------------------------------------------------- */
+/*      Load the band and mask in memory.                               */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALFillNodataLevel> asLevels;
+    GDALFillNodataLevel sLevel;
+    sLevel.nXSize = nXSize;
+    sLevel.nYSize = nYSize;
+    sLevel.pafValue = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nYSize, sizeof(float)));
+    sLevel.pafWeight = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nYSize, sizeof(float)));
+    GByte *pabyMask =
+        static_cast<GByte *>(VSI_MALLOC2_VERBOSE(nXSize, nYSize));
+    sLevel.pabyMask = pabyMask;
+    asLevels.push_back(sLevel);
+
+    CPLErr eErr = CE_None;
+    if( sLevel.pafValue == nullptr || sLevel.pafWeight == nullptr ||
+        pabyMask == nullptr )
+    {
+        eErr = CE_Failure;
+    }
+
+    for( int iY = 0; iY < nYSize && eErr == CE_None; iY++ )
+    {
+        const size_t nOffset = static_cast<size_t>(iY) * nXSize;
+        eErr =
+            GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
+                          pabyMask + nOffset, nXSize, 1, GDT_Byte, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        eErr =
+            GDALRasterIO( hTargetBand, GF_Read, 0, iY, nXSize, 1,
+                          sLevel.pafValue + nOffset, nXSize, 1,
+                          GDT_Float32, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const bool bValid =
+                pabyMask[nOffset + iX] != 0 &&
+                (!bHasNoData || sLevel.pafValue[nOffset + iX] != fNoData);
+            sLevel.pafWeight[nOffset + iX] = bValid ? 1.0f : 0.0f;
+        }
+
+        if( !pfnProgress( dfProgressRatio * 0.3 * (iY + 1) / nYSize,
+                          "Filling...", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Build the pyramid, stopping at the level whose pixels are       */
+/*      larger than the search distance.                                */
+/* -------------------------------------------------------------------- */
+    std::unique_ptr<CPLJobQueue> poJobQueue;
+    if( eErr == CE_None && nThreads > 1 )
+    {
+        CPLWorkerThreadPool* poThreadPool =
+            CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poThreadPool != nullptr )
+            poJobQueue = poThreadPool->CreateJobQueue();
+    }
+
+    while( eErr == CE_None &&
+           (asLevels.back().nXSize > 1 || asLevels.back().nYSize > 1) &&
+           ldexp(1.0, static_cast<int>(asLevels.size())) <= dfMaxSearchDist )
+    {
+        GDALFillNodataLevel sCoarse;
+        sCoarse.nXSize = (asLevels.back().nXSize + 1) / 2;
+        sCoarse.nYSize = (asLevels.back().nYSize + 1) / 2;
+        sCoarse.pafValue = static_cast<float *>(
+            VSI_MALLOC3_VERBOSE(sCoarse.nXSize, sCoarse.nYSize,
+                                sizeof(float)));
+        sCoarse.pafWeight = static_cast<float *>(
+            VSI_MALLOC3_VERBOSE(sCoarse.nXSize, sCoarse.nYSize,
+                                sizeof(float)));
+        sCoarse.pabyMask = nullptr;
+        asLevels.push_back(sCoarse);
+        if( sCoarse.pafValue == nullptr || sCoarse.pafWeight == nullptr )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+
+        GDALFillNodataRunLevelJob( poJobQueue.get(), nThreads,
+                                   GDALFillNodataReduceJob,
+                                   &asLevels[asLevels.size() - 2],
+                                   &asLevels.back(), sCoarse.nYSize );
+    }
+
+    if( eErr == CE_None &&
+        !pfnProgress( dfProgressRatio * 0.4, "Filling...", pProgressArg ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        eErr = CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Fill each level from the coarser one.                           */
+/* -------------------------------------------------------------------- */
+    for( size_t iLevel = asLevels.size() - 1;
+         eErr == CE_None && iLevel > 0; iLevel-- )
+    {
+        GDALFillNodataRunLevelJob( poJobQueue.get(), nThreads,
+                                   GDALFillNodataExpandJob,
+                                   &asLevels[iLevel - 1], &asLevels[iLevel],
+                                   asLevels[iLevel - 1].nYSize );
+    }
+
+    if( eErr == CE_None &&
+        !pfnProgress( dfProgressRatio * 0.7, "Filling...", pProgressArg ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        eErr = CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Create a mask file for the smoothing passes, if needed.         */
+/* -------------------------------------------------------------------- */
+    const CPLString osFiltMaskTmpFile =
+        CPLGenerateTempFilename("") + CPLString("fill_filtmask_work.tif");
+    GDALDatasetH hFiltMaskDS = nullptr;
+    GDALRasterBandH hFiltMaskBand = nullptr;
+    GByte *pabyFiltMask = nullptr;
+    if( eErr == CE_None && nSmoothingIterations > 0 )
+    {
+        hFiltMaskDS =
+            GDALCreate( hDriver, osFiltMaskTmpFile, nXSize, nYSize, 1,
+                        GDT_Byte, papszWorkFileOptions );
+        pabyFiltMask = static_cast<GByte *>(VSI_MALLOC_VERBOSE(nXSize));
+        if( hFiltMaskDS == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                "Could not create mask work file. Check driver capabilities.");
+            eErr = CE_Failure;
+        }
+        else if( pabyFiltMask == nullptr )
+        {
+            eErr = CE_Failure;
+        }
+        else
+        {
+            hFiltMaskBand = GDALGetRasterBand( hFiltMaskDS, 1 );
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write out the interpolated values, and the pixels to filter.    */
+/* -------------------------------------------------------------------- */
+    for( int iY = 0; iY < nYSize && eErr == CE_None; iY++ )
+    {
+        const size_t nOffset = static_cast<size_t>(iY) * nXSize;
+        eErr =
+            GDALRasterIO( hTargetBand, GF_Write, 0, iY, nXSize, 1,
+                          sLevel.pafValue + nOffset, nXSize, 1,
+                          GDT_Float32, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        if( hFiltMaskBand != nullptr )
+        {
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                pabyFiltMask[iX] =
+                    (pabyMask[nOffset + iX] == 0 &&
+                     sLevel.pafWeight[nOffset + iX] > 0.0f) ? 255 : 0;
+            }
+            eErr =
+                GDALRasterIO( hFiltMaskBand, GF_Write, 0, iY, nXSize, 1,
+                              pabyFiltMask, nXSize, 1, GDT_Byte, 0, 0 );
+            if( eErr != CE_None )
+                break;
+        }
+
+        if( !pfnProgress(
+                dfProgressRatio * (0.7 + 0.3 * (iY + 1) / nYSize),
+                "Filling...", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    for( size_t iLevel = 0; iLevel < asLevels.size(); iLevel++ )
+    {
+        CPLFree(asLevels[iLevel].pafValue);
+        CPLFree(asLevels[iLevel].pafWeight);
+    }
+    CPLFree(pabyMask);
+    CPLFree(pabyFiltMask);
+    poJobQueue.reset();
+
+/* -------------------------------------------------------------------- */
+/*      Smoothing passes, as with the default algorithm.                */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None && hFiltMaskBand != nullptr )
+    {
+        // Force masks to be to flushed and recomputed.
+        GDALFlushRasterCache( hMaskBand );
+
+        void *pScaledProgress =
+            GDALCreateScaledProgress( dfProgressRatio, 1.0, pfnProgress, pProgressArg );
+
+        eErr = GDALMultiFilter( hTargetBand, hMaskBand, hFiltMaskBand,
+                                nSmoothingIterations,
+                                GDALScaledProgress, pScaledProgress );
+
+        GDALDestroyScaledProgress( pScaledProgress );
+    }
+
+    if( hFiltMaskDS != nullptr )
+    {
+        GDALClose( hFiltMaskDS );
+        GDALDeleteDataset( hDriver, osFiltMaskTmpFile );
+    }
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                           GDALFillNodata()                           */
 /************************************************************************/
@@ -401,6 +978,20 @@ inline void QUAD_CHECK(double& dfQuadDist, float& fQuadValue,
  * <li>NODATA=value (starting with GDAL 2.4).
  * Source pixels at that value will be ignored by the interpolator. Warning:
  * currently this will not be honored by smoothing passes.</li>
+ * <li>ALGORITHM=INV_DIST/PUSH_PULL (GDAL >= 3.1). INV_DIST (default) is the
+ * four direction search described above. PUSH_PULL builds a pyramid of the
+ * band by averaging the valid pixels of 2x2 blocks, and then fills the
+ * nodata pixels of each level from a bilinear interpolation of the coarser
+ * level, down to the full resolution. Its cost is linear in the number of
+ * pixels, whatever the size of the gaps, but the band is loaded in memory.
+ * The pyramid stops at the level whose pixels are larger than
+ * dfMaxSearchDist, so that only the pixels roughly within that distance of
+ * valid pixels get filled.</li>
+ * <li>NUM_THREADS=number_of_threads or ALL_CPUS (GDAL >= 3.1). With
+ * INV_DIST, the interpolation of the lines is split among the worker
+ * threads, by batches of lines. With PUSH_PULL, the lines of each level of
+ * the pyramid are. The smoothing passes remain single threaded. Defaults
+ * to 1.</li>
  * </ul>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
@@ -454,6 +1045,22 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
         fNoData = static_cast<float>(CPLAtof(pszNoData));
     }
 
+    const char* pszAlgorithm =
+        CSLFetchNameValueDef(papszOptions, "ALGORITHM", "INV_DIST");
+    const bool bPushPull = EQUAL(pszAlgorithm, "PUSH_PULL");
+    if( !bPushPull && !EQUAL(pszAlgorithm, "INV_DIST") )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "Invalid value for ALGORITHM: %s", pszAlgorithm);
+        return CE_Failure;
+    }
+
+    // Only the NUM_THREADS option enables the parallel passes, not
+    // GDAL_NUM_THREADS.
+    const int nThreads =
+        CSLFetchNameValue(papszOptions, "NUM_THREADS") != nullptr ?
+        CPLGetNumThreads(papszOptions) : 1;
+
 /* -------------------------------------------------------------------- */
 /*      Initialize progress counter.                                    */
 /* -------------------------------------------------------------------- */
@@ -496,6 +1103,17 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
                 papszWorkFileOptions, "BIGTIFF", "IF_SAFER");
     }
 
+    if( bPushPull )
+    {
+        const CPLErr eErr =
+            GDALFillNodataPushPull( hTargetBand, hMaskBand, dfMaxSearchDist,
+                                    nSmoothingIterations, bHasNoData, fNoData,
+                                    nThreads, hDriver, papszWorkFileOptions,
+                                    pfnProgress, pProgressArg );
+        CSLDestroy(papszWorkFileOptions);
+        return eErr;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Create a work file to hold the Y "last value" indices.          */
 /* -------------------------------------------------------------------- */
@@ -556,31 +1174,68 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
     GDALRasterBandH hFiltMaskBand = GDALGetRasterBand( hFiltMaskDS, 1 );
 
 /* -------------------------------------------------------------------- */
-/*      Allocate buffers for last scanline and this scanline.           */
+/*      Start worker threads for the interpolation of the bottom up     */
+/*      pass, which then processes batches of several lines.            */
+/* -------------------------------------------------------------------- */
+    std::unique_ptr<CPLJobQueue> poJobQueue;
+    int nBatchLines = 1;
+    if( nThreads > 1 )
+    {
+        CPLWorkerThreadPool* poThreadPool =
+            CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poThreadPool != nullptr )
+        {
+            poJobQueue = poThreadPool->CreateJobQueue();
+            nBatchLines = std::min(nYSize, 4 * nThreads);
+        }
+    }
+    nBatchLines = std::max(1, nBatchLines);
+
+    GDALFillNodataParams sParams;
+    sParams.nXSize = nXSize;
+    sParams.dfMaxSearchDist = dfMaxSearchDist;
+    sParams.nMaxSearchDist = nMaxSearchDist;
+    sParams.nNoDataVal = nNoDataVal;
+    sParams.bHasNoData = bHasNoData;
+    sParams.fNoData = fNoData;
+
+    std::vector<GDALFillNodataLine> asLines(nBatchLines);
+
+/* -------------------------------------------------------------------- */
+/*      Allocate buffers for last scanline and this scanline, and for   */
+/*      the lines of a batch of the bottom up pass.                     */
 /* -------------------------------------------------------------------- */
 
     GUInt32 *panLastY =
         static_cast<GUInt32 *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(GUInt32)));
     GUInt32 *panThisY =
         static_cast<GUInt32 *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(GUInt32)));
-    GUInt32 *panTopDownY =
-        static_cast<GUInt32 *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(GUInt32)));
+    GUInt32 *panTopDownY = static_cast<GUInt32 *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nBatchLines, sizeof(GUInt32)));
+    GUInt32 *panBatchY = static_cast<GUInt32 *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nBatchLines + 1, sizeof(GUInt32)));
     float *pafLastValue =
         static_cast<float *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
     float *pafThisValue =
         static_cast<float *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
-    float *pafTopDownValue =
-        static_cast<float *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
-    float *pafScanline =
-        static_cast<float *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
-    GByte *pabyMask = static_cast<GByte *>(VSI_CALLOC_VERBOSE(nXSize, 1));
-    GByte *pabyFiltMask = static_cast<GByte *>(VSI_CALLOC_VERBOSE(nXSize, 1));
+    float *pafTopDownValue = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nBatchLines, sizeof(float)));
+    float *pafBatchValue = static_cast<float *>(
+        VSI_CALLOC_VERBOSE(static_cast<size_t>(nXSize) * (nBatchLines + 1),
+                           sizeof(float)));
+    float *pafScanline = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nBatchLines, sizeof(float)));
+    GByte *pabyMask =
+        static_cast<GByte *>(VSI_MALLOC2_VERBOSE(nXSize, nBatchLines));
+    GByte *pabyFiltMask =
+        static_cast<GByte *>(VSI_MALLOC2_VERBOSE(nXSize, nBatchLines));
 
     CPLErr eErr = CE_None;
 
     if( panLastY == nullptr || panThisY == nullptr || panTopDownY == nullptr ||
+        panBatchY == nullptr ||
         pafLastValue == nullptr || pafThisValue == nullptr ||
-        pafTopDownValue == nullptr ||
+        pafTopDownValue == nullptr || pafBatchValue == nullptr ||
         pafScanline == nullptr || pabyMask == nullptr || pabyFiltMask == nullptr )
     {
         eErr = CE_Failure;
@@ -674,65 +1329,103 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
 
     for( int iX = 0; iX < nXSize; iX++ )
     {
-        panLastY[iX] = nNoDataVal;
+        panBatchY[iX] = nNoDataVal;
     }
 
 /* ==================================================================== */
 /*      Now we will do collect similar this/last information from       */
 /*      bottom to top and use it in combination with the top to         */
 /*      bottom search info to interpolate.                              */
+/*                                                                      */
+/*      Lines are processed by batches: the this/last information is    */
+/*      collected sequentially for all the lines of a batch, which are  */
+/*      then interpolated independently from each other, in worker      */
+/*      threads if NUM_THREADS is set.  Slot i+1 of the panBatchY and   */
+/*      pafBatchValue buffers holds the information of the i-th line    */
+/*      of the batch, and slot 0 that of the line below the batch.      */
 /* ==================================================================== */
-    for( int iY = nYSize-1; iY >= 0 && eErr == CE_None; iY-- )
+    for( int iYBatch = nYSize-1; iYBatch >= 0 && eErr == CE_None;
+         iYBatch -= nBatchLines )
     {
-        eErr =
-            GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
-                          pabyMask, nXSize, 1, GDT_Byte, 0, 0 );
+        const int nLines = std::min(nBatchLines, iYBatch + 1);
 
-        if( eErr != CE_None )
-            break;
+        for( int iLine = 0; iLine < nLines && eErr == CE_None; iLine++ )
+        {
+            const int iY = iYBatch - iLine;
+            const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+            GByte *pabyLineMask = pabyMask + nOffset;
+            float *pafLineScanline = pafScanline + nOffset;
+            const GUInt32 *panLineLastY = panBatchY + nOffset;
+            const float *pafLineLastValue = pafBatchValue + nOffset;
+            GUInt32 *panLineThisY = panBatchY + nOffset + nXSize;
+            float *pafLineThisValue = pafBatchValue + nOffset + nXSize;
 
-        eErr =
-            GDALRasterIO( hTargetBand, GF_Read, 0, iY, nXSize, 1,
-                          pafScanline, nXSize, 1, GDT_Float32, 0, 0 );
+            eErr =
+                GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
+                              pabyLineMask, nXSize, 1, GDT_Byte, 0, 0 );
 
-        if( eErr != CE_None )
-            break;
+            if( eErr != CE_None )
+                break;
+
+            eErr =
+                GDALRasterIO( hTargetBand, GF_Read, 0, iY, nXSize, 1,
+                              pafLineScanline, nXSize, 1, GDT_Float32, 0, 0 );
+
+            if( eErr != CE_None )
+                break;
 
 /* -------------------------------------------------------------------- */
 /*      Figure out the most recent pixel for each column.               */
 /* -------------------------------------------------------------------- */
 
-        for( int iX = 0; iX < nXSize; iX++ )
-        {
-            if( pabyMask[iX] )
-            {
-                pafThisValue[iX] = pafScanline[iX];
-                panThisY[iX] = iY;
-            }
-            else if( panLastY[iX] - iY <= dfMaxSearchDist )
-            {
-                pafThisValue[iX] = pafLastValue[iX];
-                panThisY[iX] = panLastY[iX];
-            }
-            else
+            for( int iX = 0; iX < nXSize; iX++ )
             {
-                panThisY[iX] = nNoDataVal;
+                if( pabyLineMask[iX] )
+                {
+                    pafLineThisValue[iX] = pafLineScanline[iX];
+                    panLineThisY[iX] = iY;
+                }
+                else if( panLineLastY[iX] - iY <= dfMaxSearchDist )
+                {
+                    pafLineThisValue[iX] = pafLineLastValue[iX];
+                    panLineThisY[iX] = panLineLastY[iX];
+                }
+                else
+                {
+                    panLineThisY[iX] = nNoDataVal;
+                }
             }
-        }
 
 /* -------------------------------------------------------------------- */
 /*      Load the last y and corresponding value from the top down pass. */
 /* -------------------------------------------------------------------- */
-        eErr =
-            GDALRasterIO( hYBand, GF_Read, 0, iY, nXSize, 1,
-                          panTopDownY, nXSize, 1, GDT_UInt32, 0, 0 );
+            eErr =
+                GDALRasterIO( hYBand, GF_Read, 0, iY, nXSize, 1,
+                              panTopDownY + nOffset, nXSize, 1,
+                              GDT_UInt32, 0, 0 );
 
-        if( eErr != CE_None )
-            break;
+            if( eErr != CE_None )
+                break;
 
-        eErr =
-            GDALRasterIO( hValBand, GF_Read, 0, iY, nXSize, 1,
-                          pafTopDownValue, nXSize, 1, GDT_Float32, 0, 0 );
+            eErr =
+                GDALRasterIO( hValBand, GF_Read, 0, iY, nXSize, 1,
+                              pafTopDownValue + nOffset, nXSize, 1,
+                              GDT_Float32, 0, 0 );
+
+            if( eErr != CE_None )
+                break;
+
+            GDALFillNodataLine& sLine = asLines[iLine];
+            sLine.psParams = &sParams;
+            sLine.iY = iY;
+            sLine.panTopDownY = panTopDownY + nOffset;
+            sLine.pafTopDownValue = pafTopDownValue + nOffset;
+            sLine.panLastY = panLineLastY;
+            sLine.pafLastValue = pafLineLastValue;
+            sLine.pabyMask = pabyLineMask;
+            sLine.pabyFiltMask = pabyFiltMask + nOffset;
+            sLine.pafScanline = pafLineScanline;
+        }
 
         if( eErr != CE_None )
             break;
@@ -740,128 +1433,67 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
 /* -------------------------------------------------------------------- */
 /*      Attempt to interpolate any pixels that are nodata.              */
 /* -------------------------------------------------------------------- */
-        memset( pabyFiltMask, 0, nXSize );
-        for( int iX = 0; iX < nXSize; iX++ )
+        if( poJobQueue != nullptr && nLines > 1 )
         {
-            int nThisMaxSearchDist = nMaxSearchDist;
-
-            // If this was a valid target - no change.
-            if( pabyMask[iX] )
-                continue;
-
-            // Quadrants 0:topleft, 1:bottomleft, 2:topright, 3:bottomright
-            double adfQuadDist[4] = {};
-            float fQuadValue[4] = {};
-
-            for( int iQuad = 0; iQuad < 4; iQuad++ )
-            {
-                adfQuadDist[iQuad] = dfMaxSearchDist + 1.0;
-                fQuadValue[iQuad] = 0.0;
-            }
-
-            // Step left and right by one pixel searching for the closest
-            // target value for each quadrant.
-            for( int iStep = 0; iStep <= nThisMaxSearchDist; iStep++ )
-            {
-                const int iLeftX = std::max(0, iX - iStep);
-                const int iRightX = std::min(nXSize - 1, iX + iStep);
-
-                // Top left includes current line.
-                QUAD_CHECK(adfQuadDist[0], fQuadValue[0],
-                           iLeftX, panTopDownY[iLeftX], iX, iY,
-                           pafTopDownValue[iLeftX], nNoDataVal );
-
-                // Bottom left.
-                QUAD_CHECK(adfQuadDist[1], fQuadValue[1],
-                           iLeftX, panLastY[iLeftX], iX, iY,
-                           pafLastValue[iLeftX], nNoDataVal );
-
-                // Top right and bottom right do no include center pixel.
-                if( iStep == 0 )
-                     continue;
-
-                // Top right includes current line.
-                QUAD_CHECK(adfQuadDist[2], fQuadValue[2],
-                           iRightX, panTopDownY[iRightX], iX, iY,
-                           pafTopDownValue[iRightX], nNoDataVal );
-
-                // Bottom right.
-                QUAD_CHECK(adfQuadDist[3], fQuadValue[3],
-                           iRightX, panLastY[iRightX], iX, iY,
-                           pafLastValue[iRightX], nNoDataVal );
-
-                // Every four steps, recompute maximum distance.
-                if( (iStep & 0x3) == 0 )
-                    nThisMaxSearchDist = static_cast<int>(floor(
-                        std::max(std::max(adfQuadDist[0], adfQuadDist[1]),
-                                 std::max(adfQuadDist[2], adfQuadDist[3]))));
-            }
-
-            double dfWeightSum = 0.0;
-            double dfValueSum = 0.0;
-            bool bHasSrcValues = false;
-
-            for( int iQuad = 0; iQuad < 4; iQuad++ )
-            {
-                if( adfQuadDist[iQuad] <= dfMaxSearchDist )
-                {
-                    const double dfWeight = 1.0 / adfQuadDist[iQuad];
-
-                    bHasSrcValues = dfWeight != 0;
-                    if( !bHasNoData || fQuadValue[iQuad] != fNoData )
-                    {
-                        dfWeightSum += dfWeight;
-                        dfValueSum += fQuadValue[iQuad] * dfWeight;
-                    }
-                }
-            }
-
-            if( bHasSrcValues )
+            for( int iLine = 0; iLine < nLines; iLine++ )
             {
-                pabyMask[iX] = 255;
-                pabyFiltMask[iX] = 255;
-                if( dfWeightSum > 0.0 )
-                    pafScanline[iX] = static_cast<float>(dfValueSum / dfWeightSum);
-                else
-                    pafScanline[iX] = fNoData;
+                if( !poJobQueue->SubmitJob( GDALFillNodataInterpolateLine,
+                                            &asLines[iLine] ) )
+                    GDALFillNodataInterpolateLine( &asLines[iLine] );
             }
+            poJobQueue->WaitCompletion();
+        }
+        else
+        {
+            for( int iLine = 0; iLine < nLines; iLine++ )
+                GDALFillNodataInterpolateLine( &asLines[iLine] );
         }
 
 /* -------------------------------------------------------------------- */
 /*      Write out the updated data and mask information.                */
 /* -------------------------------------------------------------------- */
-        eErr =
-            GDALRasterIO( hTargetBand, GF_Write, 0, iY, nXSize, 1,
-                          pafScanline, nXSize, 1, GDT_Float32, 0, 0 );
+        for( int iLine = 0; iLine < nLines && eErr == CE_None; iLine++ )
+        {
+            const int iY = iYBatch - iLine;
+            const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
 
-        if( eErr != CE_None )
-            break;
+            eErr =
+                GDALRasterIO( hTargetBand, GF_Write, 0, iY, nXSize, 1,
+                              pafScanline + nOffset, nXSize, 1,
+                              GDT_Float32, 0, 0 );
 
-        eErr =
-            GDALRasterIO( hFiltMaskBand, GF_Write, 0, iY, nXSize, 1,
-                          pabyFiltMask, nXSize, 1, GDT_Byte, 0, 0 );
+            if( eErr != CE_None )
+                break;
 
-        if( eErr != CE_None )
-            break;
+            eErr =
+                GDALRasterIO( hFiltMaskBand, GF_Write, 0, iY, nXSize, 1,
+                              pabyFiltMask + nOffset, nXSize, 1,
+                              GDT_Byte, 0, 0 );
 
-/* -------------------------------------------------------------------- */
-/*      Flip this/last buffers.                                         */
-/* -------------------------------------------------------------------- */
-        std::swap(pafThisValue, pafLastValue);
-        std::swap(panThisY, panLastY);
+            if( eErr != CE_None )
+                break;
 
 /* -------------------------------------------------------------------- */
 /*      report progress.                                                */
 /* -------------------------------------------------------------------- */
-        if( eErr == CE_None &&
-            !pfnProgress(
-                dfProgressRatio*(0.5+0.5*(nYSize-iY) /
-                                 static_cast<double>(nYSize)),
-                "Filling...", pProgressArg) )
-        {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
+            if( !pfnProgress(
+                    dfProgressRatio*(0.5+0.5*(nYSize-iY) /
+                                     static_cast<double>(nYSize)),
+                    "Filling...", pProgressArg) )
+            {
+                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+                eErr = CE_Failure;
+            }
         }
+
+/* -------------------------------------------------------------------- */
+/*      Move the information of the last line of the batch to slot 0.   */
+/* -------------------------------------------------------------------- */
+        memcpy( panBatchY, panBatchY + static_cast<size_t>(nLines) * nXSize,
+                nXSize * sizeof(GUInt32) );
+        memcpy( pafBatchValue,
+                pafBatchValue + static_cast<size_t>(nLines) * nXSize,
+                nXSize * sizeof(float) );
     }
 
 /* ==================================================================== */
@@ -891,9 +1523,11 @@ end:
     CPLFree(panLastY);
     CPLFree(panThisY);
     CPLFree(panTopDownY);
+    CPLFree(panBatchY);
     CPLFree(pafLastValue);
     CPLFree(pafThisValue);
     CPLFree(pafTopDownValue);
+    CPLFree(pafBatchValue);
     CPLFree(pafScanline);
     CPLFree(pabyMask);
     CPLFree(pabyFiltMask);
@@ -433,7 +433,7 @@ static void VizGeorefSpline2DBase_func4( double* res,
 }
 #endif // defined(USE_OPTIMIZED_VizGeorefSpline2DBase_func4)
 
-int VizGeorefSpline2D::solve()
+int VizGeorefSpline2D::solve( int nThreads )
 {
     // No points at all.
     if( _nof_points < 1 )
@@ -621,7 +621,8 @@ int VizGeorefSpline2D::solve()
 
     double* adfCoef = static_cast<double*>(VSICalloc( _nof_eqs * _nof_vars, sizeof(double) ));
 
-    if( !GDALLinearSystemSolve( _nof_eqs, _nof_vars, _AA, adfRHS, adfCoef ) )
+    if( !GDALLinearSystemSolve( _nof_eqs, _nof_vars, _AA, adfRHS, adfCoef,
+                                nThreads ) )
     {
         VSIFree(adfRHS);
         VSIFree(adfCoef);
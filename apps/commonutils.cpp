@@ -28,15 +28,26 @@
 
 #include "commonutils.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <mutex>
 
 #include <string>
 
 #include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
 CPL_CVSID("$Id: commonutils.cpp 10d2cf3c7944c209da6b9bfa391b0ea0b6222ed8 2018-09-11 08:31:42 +0200 Even Rouault $")
 
 /* -------------------------------------------------------------------- */
@@ -152,6 +163,27 @@ CPLString GetOutputDriverForRaster(const char* pszDestFilename)
     return osFormat;
 }
 
+/* -------------------------------------------------------------------- */
+/*                             GetPeakRSS()                             */
+/* -------------------------------------------------------------------- */
+
+GIntBig GetPeakRSS()
+{
+#ifndef _WIN32
+    struct rusage sUsage;
+    if( getrusage(RUSAGE_SELF, &sUsage) != 0 )
+        return -1;
+#ifdef __APPLE__
+    // Bytes on macOS, kilobytes elsewhere.
+    return static_cast<GIntBig>(sUsage.ru_maxrss);
+#else
+    return static_cast<GIntBig>(sUsage.ru_maxrss) * 1024;
+#endif
+#else
+    return -1;
+#endif
+}
+
 /* -------------------------------------------------------------------- */
 /*                        EarlySetConfigOptions()                       */
 /* -------------------------------------------------------------------- */
@@ -177,3 +209,174 @@ void EarlySetConfigOptions( int argc, char ** argv )
         }
     }
 }
+
+/* -------------------------------------------------------------------- */
+/*                    GDALConcurrentDatasetOpener                       */
+/* -------------------------------------------------------------------- */
+
+namespace {
+
+struct GDALOpenJobError
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+};
+
+struct GDALOpenJob
+{
+    CPLString           osFilename{};
+    int                 nOpenFlags = 0;
+    CSLConstList        papszOpenOptions = nullptr;
+    std::mutex         *poMutex = nullptr;
+    GDALDatasetH        hDS = nullptr;
+    std::vector<GDALOpenJobError> aoErrors{};
+    bool                bSubmitted = false;
+    bool                bDone = false;
+    bool                bRetrieved = false;
+};
+
+} // namespace
+
+struct GDALConcurrentDatasetOpener::Private
+{
+    int                 nOpenFlags = 0;
+    CPLStringList       aosOpenOptions{};
+    // Jobs run by the global worker thread pool.
+    std::unique_ptr<CPLJobQueue> poJobQueue{};
+    // Number of datasets opened ahead of the one retrieved.
+    int                 nMaxJobsAhead = 0;
+    std::vector<std::unique_ptr<GDALOpenJob>> apoJobs{};
+    std::mutex          oMutex{};
+};
+
+static void CPL_STDCALL GDALOpenJobErrorHandler( CPLErr eErrClass,
+                                                 CPLErrorNum nErrNo,
+                                                 const char* pszMsg )
+{
+    GDALOpenJob* psJob = static_cast<GDALOpenJob*>(CPLGetErrorHandlerUserData());
+    psJob->aoErrors.push_back(GDALOpenJobError{eErrClass, nErrNo, pszMsg});
+}
+
+static void GDALOpenJobThreadFunc( void* pData )
+{
+    GDALOpenJob* psJob = static_cast<GDALOpenJob*>(pData);
+    // Errors are emitted again by the thread retrieving the dataset.
+    CPLPushErrorHandlerEx(GDALOpenJobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    GDALDatasetH hDS = GDALOpenEx(psJob->osFilename, psJob->nOpenFlags,
+                                  nullptr, psJob->papszOpenOptions, nullptr);
+    CPLPopErrorHandler();
+    std::lock_guard<std::mutex> oLock(*psJob->poMutex);
+    psJob->hDS = hDS;
+    psJob->bDone = true;
+}
+
+GDALConcurrentDatasetOpener::GDALConcurrentDatasetOpener(
+    int nOpenFlags, CSLConstList papszOpenOptions, int nThreads ) :
+    m_poPrivate(new Private())
+{
+    m_poPrivate->nOpenFlags = nOpenFlags;
+    m_poPrivate->aosOpenOptions = CSLDuplicate(papszOpenOptions);
+    if( nThreads < 0 )
+        nThreads = CPLGetNumThreads();
+    if( nThreads > 1 )
+    {
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poPool != nullptr )
+        {
+            m_poPrivate->poJobQueue = poPool->CreateJobQueue();
+            m_poPrivate->nMaxJobsAhead = 4 * nThreads;
+        }
+    }
+}
+
+GDALConcurrentDatasetOpener::~GDALConcurrentDatasetOpener()
+{
+    if( m_poPrivate->poJobQueue )
+        m_poPrivate->poJobQueue->WaitCompletion();
+    for( const auto& poJob: m_poPrivate->apoJobs )
+    {
+        if( !poJob->bRetrieved && poJob->hDS )
+            GDALClose(poJob->hDS);
+    }
+}
+
+int GDALConcurrentDatasetOpener::Add( const char* pszFilename )
+{
+    std::unique_ptr<GDALOpenJob> poJob(new GDALOpenJob());
+    poJob->osFilename = pszFilename;
+    poJob->nOpenFlags = m_poPrivate->nOpenFlags;
+    poJob->papszOpenOptions = m_poPrivate->aosOpenOptions.List();
+    poJob->poMutex = &m_poPrivate->oMutex;
+    m_poPrivate->apoJobs.push_back(std::move(poJob));
+    return static_cast<int>(m_poPrivate->apoJobs.size()) - 1;
+}
+
+GDALDatasetH GDALConcurrentDatasetOpener::Get( int nIndex )
+{
+    const int nJobs = static_cast<int>(m_poPrivate->apoJobs.size());
+    if( nIndex < 0 || nIndex >= nJobs )
+        return nullptr;
+    GDALOpenJob* psJob = m_poPrivate->apoJobs[nIndex].get();
+    if( psJob->bRetrieved )
+        return nullptr;
+
+    if( m_poPrivate->poJobQueue == nullptr )
+    {
+        psJob->bRetrieved = true;
+        return GDALOpenEx(psJob->osFilename, psJob->nOpenFlags,
+                          nullptr, psJob->papszOpenOptions, nullptr);
+    }
+
+    // Keep the next datasets opening, including the requested one.
+    const int nLast = std::min(nJobs - 1,
+                               nIndex + m_poPrivate->nMaxJobsAhead);
+    for( int i = nIndex; i <= nLast; i++ )
+    {
+        GDALOpenJob* psNextJob = m_poPrivate->apoJobs[i].get();
+        if( psNextJob->bSubmitted || psNextJob->bRetrieved )
+            continue;
+        if( !m_poPrivate->poJobQueue->SubmitJob(GDALOpenJobThreadFunc,
+                                                psNextJob) )
+        {
+            break;
+        }
+        psNextJob->bSubmitted = true;
+    }
+
+    psJob->bRetrieved = true;
+    if( !psJob->bSubmitted )
+    {
+        return GDALOpenEx(psJob->osFilename, psJob->nOpenFlags,
+                          nullptr, psJob->papszOpenOptions, nullptr);
+    }
+
+    GDALDatasetH hDS = nullptr;
+    {
+        // Waiting on the job queue, instead of a condition, runs queued
+        // jobs meanwhile when called from a worker thread
+        std::unique_lock<std::mutex> oLock(m_poPrivate->oMutex);
+        while( !psJob->bDone )
+        {
+            int nLater = 0;
+            for( const auto& poOther: m_poPrivate->apoJobs )
+            {
+                if( poOther.get() != psJob && poOther->bSubmitted &&
+                    !poOther->bDone )
+                    nLater++;
+            }
+            oLock.unlock();
+            m_poPrivate->poJobQueue->WaitCompletion(nLater);
+            oLock.lock();
+        }
+        hDS = psJob->hDS;
+    }
+    for( const auto& oError: psJob->aoErrors )
+    {
+        CPLError( oError.eErrClass, oError.nErrNo, "%s",
+                  oError.osMsg.c_str() );
+    }
+    psJob->aoErrors.clear();
+    return hDS;
+}
@@ -84,12 +84,54 @@ CPL_C_END
 #ifdef __cplusplus
 
 #include "cpl_string.h"
+#include "gdal.h"
+#include <memory>
 #include <vector>
 
 std::vector<CPLString> CPL_DLL GetOutputDriversFor(const char* pszDestFilename,
                                                    int nFlagRasterVector);
 CPLString CPL_DLL GetOutputDriverForRaster(const char* pszDestFilename);
 
+// Peak resident set size of the process in bytes, or -1 if unknown on
+// this platform. For the benchmark reports of the test utilities.
+GIntBig CPL_DLL GetPeakRSS();
+
+/************************************************************************/
+/*                    GDALConcurrentDatasetOpener                       */
+/************************************************************************/
+
+// Opens a list of datasets ahead of their use, with a pool of threads, so
+// that the latency of opening remote files is not paid once per file.
+// Datasets are retrieved in the order they were added, and the errors
+// emitted while opening one are emitted again by the calling thread when
+// it is retrieved.
+class CPL_DLL GDALConcurrentDatasetOpener
+{
+        struct Private;
+        std::unique_ptr<Private> m_poPrivate;
+
+        GDALConcurrentDatasetOpener(const GDALConcurrentDatasetOpener&) = delete;
+        GDALConcurrentDatasetOpener& operator=(const GDALConcurrentDatasetOpener&) = delete;
+
+    public:
+        // nThreads < 0 means the value of the GDAL_NUM_THREADS config
+        // option, which defaults to 1, i.e. no thread.
+        GDALConcurrentDatasetOpener(int nOpenFlags,
+                                    CSLConstList papszOpenOptions,
+                                    int nThreads = -1);
+        // Closes the datasets opened and not retrieved.
+        ~GDALConcurrentDatasetOpener();
+
+        // Returns the index of the dataset, between 0 and the number of
+        // datasets added minus one.
+        int Add(const char* pszFilename);
+
+        // Returns the dataset of the given index, to be closed by the
+        // caller, or null if it could not be opened. Indices must be
+        // retrieved in increasing order.
+        GDALDatasetH Get(int nIndex);
+};
+
 #endif /* __cplusplus */
 
 #endif /* COMMONUTILS_H_INCLUDED */
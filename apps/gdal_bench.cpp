@@ -0,0 +1,1154 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Benchmarks of raster and vector hot paths, with JSON output.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "commonutils.h"
+#include "cpl_conv.h"
+#include "cpl_json.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "gdal.h"
+#include "gdal_alg.h"
+#include "gdal_priv.h"
+#include "gdal_utils.h"
+#include "gdalwarper.h"
+#include "ogr_feature.h"
+#include "ogr_geometry.h"
+#include "ogrsf_frmts.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage( const char* pszErrorMsg = nullptr )
+{
+    printf("Usage: gdal_bench [-list] [-filter substring]* [-min_time seconds]\n"
+           "                  [-min_iterations n] [-o output.json] [-q]\n"
+           "\n"
+           "  -list : list the benchmarks and exit.\n"
+           "  -filter : only run the benchmarks whose name contains substring.\n"
+           "  -min_time : minimum time spent in each benchmark (default: 1).\n"
+           "  -min_iterations : minimum number of timed runs (default: 3).\n"
+           "  -o : JSON output file (default: standard output).\n"
+           "  -q : do not report progress on the standard error.\n");
+
+    if( pszErrorMsg != nullptr )
+        fprintf(stderr, "\nFAILURE: %s\n", pszErrorMsg);
+
+    exit(1);
+}
+
+namespace {
+
+/************************************************************************/
+/*                              BenchCase                               */
+/************************************************************************/
+
+// A benchmark. oSetup is run once before the timed runs of oRun, and
+// oTeardown once after. They return false if the benchmark cannot be run,
+// for example when a driver is missing.
+struct BenchCase
+{
+    std::string             osName{};
+    std::string             osGroup{};  // "micro" or "macro"
+    std::string             osUnit{};   // what dfItems counts
+    double                  dfItems = 0.0;  // processed by one run
+    std::function<bool()>   oSetup{};
+    std::function<bool()>   oRun{};
+    std::function<void()>   oTeardown{};
+};
+
+// Deterministic pseudo random generator, so that runs are reproducible.
+struct BenchRandom
+{
+    GUInt32 nState;
+    explicit BenchRandom( GUInt32 nSeed ) : nState(nSeed) {}
+    int Next( int nMax )
+    {
+        nState = nState * 1103515245U + 12345U;
+        return static_cast<int>((nState >> 8) % static_cast<GUInt32>(nMax));
+    }
+};
+
+const char* const pszBenchDir = "/vsimem/gdal_bench";
+
+/************************************************************************/
+/*                          CreatePatternMEM()                          */
+/************************************************************************/
+
+// In-memory dataset filled with a smooth pattern plus some noise, so that
+// compression and resampling behave as on real imagery.
+GDALDatasetH CreatePatternMEM( int nXSize, int nYSize, int nBands,
+                               GDALDataType eType )
+{
+    GDALDriverH hMEM = GDALGetDriverByName("MEM");
+    if( hMEM == nullptr )
+        return nullptr;
+    GDALDatasetH hDS = GDALCreate(hMEM, "", nXSize, nYSize, nBands, eType,
+                                  nullptr);
+    if( hDS == nullptr )
+        return nullptr;
+    double adfGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, -1.0 };
+    GDALSetGeoTransform(hDS, adfGeoTransform);
+
+    BenchRandom oRandom(nXSize + nYSize);
+    std::vector<float> afLine(nXSize);
+    for( int iBand = 0; iBand < nBands; iBand++ )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, iBand + 1);
+        for( int iLine = 0; iLine < nYSize; iLine++ )
+        {
+            for( int iCol = 0; iCol < nXSize; iCol++ )
+            {
+                afLine[iCol] = static_cast<float>(
+                    100.0 + 60.0 * std::sin(iCol * 0.01 + iBand) *
+                        std::cos(iLine * 0.013) +
+                    oRandom.Next(32));
+            }
+            if( GDALRasterIO(hBand, GF_Write, 0, iLine, nXSize, 1,
+                             &afLine[0], nXSize, 1, GDT_Float32,
+                             0, 0) != CE_None )
+            {
+                GDALClose(hDS);
+                return nullptr;
+            }
+        }
+    }
+    return hDS;
+}
+
+/************************************************************************/
+/*                        AddCopyWordsBenches()                         */
+/************************************************************************/
+
+void AddCopyWordsBenches( std::vector<BenchCase>& aoCases )
+{
+    constexpr int nWords = 1024 * 1024;
+    const GDALDataType aeTypes[] = { GDT_Byte, GDT_UInt16, GDT_Int16,
+                                     GDT_UInt32, GDT_Int32, GDT_Float32,
+                                     GDT_Float64 };
+    auto poSrc = std::make_shared<std::vector<GByte>>();
+    auto poDst = std::make_shared<std::vector<GByte>>();
+    auto oSetup = [poSrc, poDst]()
+    {
+        if( poSrc->empty() )
+        {
+            // Values in [0,250], valid for every type.
+            std::vector<double> adfValues(nWords);
+            for( int i = 0; i < nWords; i++ )
+                adfValues[i] = (i * 7) % 251;
+            // Large enough for the strided variants.
+            poSrc->resize(static_cast<size_t>(nWords) * 8 * 4);
+            poDst->resize(static_cast<size_t>(nWords) * 8 * 4);
+            // Stored as Float64, converted by each benchmark's setup.
+            memcpy(&(*poSrc)[0], &adfValues[0], adfValues.size() * 8);
+        }
+        return true;
+    };
+
+    for( const GDALDataType eSrcType : aeTypes )
+    {
+        for( const GDALDataType eDstType : aeTypes )
+        {
+            BenchCase oCase;
+            oCase.osName = CPLSPrintf("copywords/%s/%s",
+                                      GDALGetDataTypeName(eSrcType),
+                                      GDALGetDataTypeName(eDstType));
+            oCase.osGroup = "micro";
+            oCase.osUnit = "words";
+            oCase.dfItems = nWords;
+            auto poTypedSrc = std::make_shared<std::vector<GByte>>();
+            oCase.oSetup = [oSetup, poSrc, poTypedSrc, eSrcType]()
+            {
+                oSetup();
+                const int nSize = GDALGetDataTypeSizeBytes(eSrcType);
+                poTypedSrc->resize(static_cast<size_t>(nWords) * nSize);
+                GDALCopyWords(&(*poSrc)[0], GDT_Float64, 8,
+                              &(*poTypedSrc)[0], eSrcType, nSize, nWords);
+                return true;
+            };
+            oCase.oRun = [poTypedSrc, poDst, eSrcType, eDstType]()
+            {
+                GDALCopyWords(&(*poTypedSrc)[0], eSrcType,
+                              GDALGetDataTypeSizeBytes(eSrcType),
+                              &(*poDst)[0], eDstType,
+                              GDALGetDataTypeSizeBytes(eDstType), nWords);
+                return true;
+            };
+            oCase.oTeardown = [poTypedSrc]()
+            {
+                std::vector<GByte>().swap(*poTypedSrc);
+            };
+            aoCases.push_back(oCase);
+        }
+    }
+
+    // Pixel interleaving and deinterleaving of 4 bands.
+    for( const GDALDataType eType : { GDT_Byte, GDT_Float32 } )
+    {
+        for( const bool bInterleave : { true, false } )
+        {
+            BenchCase oCase;
+            oCase.osName = CPLSPrintf("copywords/%s/%s_x4",
+                                      bInterleave ? "interleave" :
+                                                    "deinterleave",
+                                      GDALGetDataTypeName(eType));
+            oCase.osGroup = "micro";
+            oCase.osUnit = "words";
+            oCase.dfItems = nWords;
+            oCase.oSetup = oSetup;
+            oCase.oRun = [poSrc, poDst, eType, bInterleave]()
+            {
+                const int nSize = GDALGetDataTypeSizeBytes(eType);
+                GDALCopyWords(&(*poSrc)[0], eType,
+                              bInterleave ? nSize : 4 * nSize,
+                              &(*poDst)[0], eType,
+                              bInterleave ? 4 * nSize : nSize, nWords);
+                return true;
+            };
+            aoCases.push_back(oCase);
+        }
+    }
+}
+
+/************************************************************************/
+/*                           AddWarpBenches()                           */
+/************************************************************************/
+
+struct WarpFixture
+{
+    GDALDatasetH        hSrcDS = nullptr;
+    GDALDatasetH        hDstDS = nullptr;
+    GDALWarpOptions    *psWO = nullptr;
+    std::unique_ptr<GDALWarpOperation> poOperation{};
+
+    ~WarpFixture() { Clear(); }
+    void Clear()
+    {
+        poOperation.reset();
+        if( psWO )
+        {
+            GDALDestroyGenImgProjTransformer(psWO->pTransformerArg);
+            GDALDestroyWarpOptions(psWO);
+            psWO = nullptr;
+        }
+        if( hDstDS )
+            GDALClose(hDstDS);
+        if( hSrcDS )
+            GDALClose(hSrcDS);
+        hSrcDS = nullptr;
+        hDstDS = nullptr;
+    }
+};
+
+void AddWarpBenches( std::vector<BenchCase>& aoCases )
+{
+    constexpr int nSrcSize = 2048;
+    constexpr int nDstSize = 1536;
+    const GDALDataType aeTypes[] = { GDT_Byte, GDT_UInt16, GDT_Float32 };
+    const struct { const char* pszName; GDALResampleAlg eAlg; } asAlgs[] = {
+        { "near", GRA_NearestNeighbour },
+        { "bilinear", GRA_Bilinear },
+        { "cubic", GRA_Cubic },
+        { "cubicspline", GRA_CubicSpline },
+        { "lanczos", GRA_Lanczos },
+        { "average", GRA_Average },
+        { "mode", GRA_Mode } };
+
+    for( const GDALDataType eType : aeTypes )
+    {
+        for( const auto& sAlg : asAlgs )
+        {
+            auto poFixture = std::make_shared<WarpFixture>();
+            const GDALResampleAlg eAlg = sAlg.eAlg;
+
+            BenchCase oCase;
+            oCase.osName = CPLSPrintf("warp/%s/%s", sAlg.pszName,
+                                      GDALGetDataTypeName(eType));
+            oCase.osGroup = "micro";
+            oCase.osUnit = "pixels";
+            oCase.dfItems = static_cast<double>(nDstSize) * nDstSize;
+            oCase.oSetup = [poFixture, eType, eAlg]()
+            {
+                poFixture->hSrcDS =
+                    CreatePatternMEM(nSrcSize, nSrcSize, 1, eType);
+                poFixture->hDstDS = GDALCreate(GDALGetDriverByName("MEM"),
+                    "", nDstSize, nDstSize, 1, eType, nullptr);
+                if( poFixture->hSrcDS == nullptr ||
+                    poFixture->hDstDS == nullptr )
+                    return false;
+                // Downsampling with a slight rotation, to avoid the
+                // special cases of pure scaling.
+                double adfGeoTransform[6] = {
+                    0.0, nSrcSize * 0.95 / nDstSize, 0.01,
+                    0.0, 0.01, -nSrcSize * 0.95 / nDstSize };
+                GDALSetGeoTransform(poFixture->hDstDS, adfGeoTransform);
+
+                GDALWarpOptions* psWO = GDALCreateWarpOptions();
+                poFixture->psWO = psWO;
+                psWO->hSrcDS = poFixture->hSrcDS;
+                psWO->hDstDS = poFixture->hDstDS;
+                psWO->eResampleAlg = eAlg;
+                psWO->nBandCount = 1;
+                psWO->panSrcBands =
+                    static_cast<int*>(CPLMalloc(sizeof(int)));
+                psWO->panSrcBands[0] = 1;
+                psWO->panDstBands =
+                    static_cast<int*>(CPLMalloc(sizeof(int)));
+                psWO->panDstBands[0] = 1;
+                psWO->pfnTransformer = GDALGenImgProjTransform;
+                psWO->pTransformerArg = GDALCreateGenImgProjTransformer2(
+                    poFixture->hSrcDS, poFixture->hDstDS, nullptr);
+                if( psWO->pTransformerArg == nullptr )
+                    return false;
+                poFixture->poOperation.reset(new GDALWarpOperation());
+                return poFixture->poOperation->Initialize(psWO) == CE_None;
+            };
+            oCase.oRun = [poFixture]()
+            {
+                return poFixture->poOperation->ChunkAndWarpImage(
+                    0, 0, nDstSize, nDstSize) == CE_None;
+            };
+            oCase.oTeardown = [poFixture]() { poFixture->Clear(); };
+            aoCases.push_back(oCase);
+        }
+    }
+}
+
+/************************************************************************/
+/*                         AddOverviewBenches()                         */
+/************************************************************************/
+
+void AddOverviewBenches( std::vector<BenchCase>& aoCases )
+{
+    constexpr int nSize = 4096;
+    const char* const apszMethods[] = { "NEAREST", "AVERAGE", "GAUSS",
+                                        "CUBIC", "BILINEAR", "LANCZOS",
+                                        "MODE" };
+    for( const GDALDataType eType : { GDT_Byte, GDT_Float32 } )
+    {
+        for( const char* pszMethod : apszMethods )
+        {
+            struct Fixture
+            {
+                GDALDatasetH hSrcDS = nullptr;
+                std::vector<GDALDatasetH> ahOvrDS{};
+                ~Fixture() { Clear(); }
+                void Clear()
+                {
+                    for( GDALDatasetH hDS : ahOvrDS )
+                        GDALClose(hDS);
+                    ahOvrDS.clear();
+                    if( hSrcDS )
+                        GDALClose(hSrcDS);
+                    hSrcDS = nullptr;
+                }
+            };
+            auto poFixture = std::make_shared<Fixture>();
+
+            BenchCase oCase;
+            oCase.osName = CPLSPrintf("overview/%s/%s",
+                                      CPLString(pszMethod).tolower().c_str(),
+                                      GDALGetDataTypeName(eType));
+            oCase.osGroup = "micro";
+            oCase.osUnit = "pixels";
+            oCase.dfItems = static_cast<double>(nSize) * nSize;
+            oCase.oSetup = [poFixture, eType]()
+            {
+                poFixture->hSrcDS = CreatePatternMEM(nSize, nSize, 1, eType);
+                if( poFixture->hSrcDS == nullptr )
+                    return false;
+                for( int nFactor = 2; nFactor <= 8; nFactor *= 2 )
+                {
+                    GDALDatasetH hOvrDS = GDALCreate(
+                        GDALGetDriverByName("MEM"), "", nSize / nFactor,
+                        nSize / nFactor, 1, eType, nullptr);
+                    if( hOvrDS == nullptr )
+                        return false;
+                    poFixture->ahOvrDS.push_back(hOvrDS);
+                }
+                return true;
+            };
+            oCase.oRun = [poFixture, pszMethod]()
+            {
+                std::vector<GDALRasterBandH> ahOvrBands;
+                for( GDALDatasetH hDS : poFixture->ahOvrDS )
+                    ahOvrBands.push_back(GDALGetRasterBand(hDS, 1));
+                return GDALRegenerateOverviews(
+                    GDALGetRasterBand(poFixture->hSrcDS, 1),
+                    static_cast<int>(ahOvrBands.size()), &ahOvrBands[0],
+                    pszMethod, nullptr, nullptr) == CE_None;
+            };
+            oCase.oTeardown = [poFixture]() { poFixture->Clear(); };
+            aoCases.push_back(oCase);
+        }
+    }
+}
+
+/************************************************************************/
+/*                       AddBlockCacheBenches()                         */
+/************************************************************************/
+
+struct BlockCacheThread
+{
+    GDALDatasetH    hDS = nullptr;
+    int             nSeed = 0;
+    int             nReads = 0;
+    bool            bOK = true;
+};
+
+void BlockCacheThreadFunc( void* pData )
+{
+    BlockCacheThread* psThread = static_cast<BlockCacheThread*>(pData);
+    GDALRasterBandH hBand = GDALGetRasterBand(psThread->hDS, 1);
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    GDALGetBlockSize(hBand, &nBlockXSize, &nBlockYSize);
+    const int nXBlocks = GDALGetRasterBandXSize(hBand) / nBlockXSize;
+    const int nYBlocks = GDALGetRasterBandYSize(hBand) / nBlockYSize;
+    std::vector<GByte> abyBlock(static_cast<size_t>(nBlockXSize) *
+                                nBlockYSize);
+    BenchRandom oRandom(psThread->nSeed);
+    for( int i = 0; i < psThread->nReads && psThread->bOK; i++ )
+    {
+        psThread->bOK = GDALReadBlock(hBand, oRandom.Next(nXBlocks),
+                                      oRandom.Next(nYBlocks),
+                                      &abyBlock[0]) == CE_None;
+    }
+}
+
+void AddBlockCacheBenches( std::vector<BenchCase>& aoCases )
+{
+    constexpr int nReadsPerThread = 1024;
+    const std::string osFilename = std::string(pszBenchDir) + "/cache.tif";
+
+    for( const int nThreads : { 1, 2, 4, 8 } )
+    {
+        struct Fixture
+        {
+            std::vector<BlockCacheThread> asThreads{};
+            GIntBig nOldCacheMax = 0;
+        };
+        auto poFixture = std::make_shared<Fixture>();
+
+        BenchCase oCase;
+        oCase.osName = CPLSPrintf("blockcache/threads_%d", nThreads);
+        oCase.osGroup = "micro";
+        oCase.osUnit = "blocks";
+        oCase.dfItems = static_cast<double>(nThreads) * nReadsPerThread;
+        oCase.oSetup = [poFixture, nThreads, osFilename]()
+        {
+            VSIStatBufL sStat;
+            if( VSIStatL(osFilename.c_str(), &sStat) != 0 )
+            {
+                // 64 MB of 256x256 tiles, for a 16 MB cache.
+                GDALDatasetH hMEM = CreatePatternMEM(8192, 8192, 1, GDT_Byte);
+                GDALDriverH hGTiff = GDALGetDriverByName("GTiff");
+                if( hMEM == nullptr || hGTiff == nullptr )
+                {
+                    if( hMEM )
+                        GDALClose(hMEM);
+                    return false;
+                }
+                const char* const apszOptions[] = { "TILED=YES", nullptr };
+                GDALDatasetH hDS = GDALCreateCopy(
+                    hGTiff, osFilename.c_str(), hMEM,
+                    FALSE, const_cast<char**>(apszOptions), nullptr, nullptr);
+                GDALClose(hMEM);
+                if( hDS == nullptr )
+                    return false;
+                GDALClose(hDS);
+            }
+            poFixture->nOldCacheMax = GDALGetCacheMax64();
+            GDALSetCacheMax64(16 * 1024 * 1024);
+            for( int i = 0; i < nThreads; i++ )
+            {
+                BlockCacheThread sThread;
+                sThread.hDS = GDALOpen(osFilename.c_str(), GA_ReadOnly);
+                sThread.nSeed = i + 1;
+                sThread.nReads = nReadsPerThread;
+                if( sThread.hDS == nullptr )
+                    return false;
+                poFixture->asThreads.push_back(sThread);
+            }
+            return true;
+        };
+        oCase.oRun = [poFixture]()
+        {
+            std::vector<CPLJoinableThread*> ahThreads;
+            for( auto& sThread : poFixture->asThreads )
+                ahThreads.push_back(
+                    CPLCreateJoinableThread(BlockCacheThreadFunc, &sThread));
+            bool bOK = true;
+            for( size_t i = 0; i < ahThreads.size(); i++ )
+            {
+                if( ahThreads[i] )
+                    CPLJoinThread(ahThreads[i]);
+                else
+                    BlockCacheThreadFunc(&poFixture->asThreads[i]);
+                bOK &= poFixture->asThreads[i].bOK;
+            }
+            return bOK;
+        };
+        oCase.oTeardown = [poFixture]()
+        {
+            for( auto& sThread : poFixture->asThreads )
+                GDALClose(sThread.hDS);
+            poFixture->asThreads.clear();
+            if( poFixture->nOldCacheMax > 0 )
+                GDALSetCacheMax64(poFixture->nOldCacheMax);
+        };
+        aoCases.push_back(oCase);
+    }
+}
+
+/************************************************************************/
+/*                           AddWKBBenches()                            */
+/************************************************************************/
+
+OGRGeometry* CreateBenchGeometry( const std::string& osKind )
+{
+    if( osKind == "linestring25d" )
+    {
+        OGRLineString* poLS = new OGRLineString();
+        for( int i = 0; i < 10000; i++ )
+            poLS->addPoint(i * 0.5, std::sin(i * 0.01), i * 0.1);
+        return poLS;
+    }
+    if( osKind == "polygon" )
+    {
+        OGRPolygon* poPoly = new OGRPolygon();
+        OGRLinearRing* poRing = new OGRLinearRing();
+        for( int i = 0; i < 10000; i++ )
+            poRing->addPoint(std::cos(i * 2 * M_PI / 10000),
+                             std::sin(i * 2 * M_PI / 10000));
+        poRing->closeRings();
+        poPoly->addRingDirectly(poRing);
+        return poPoly;
+    }
+    OGRMultiPolygon* poMP = new OGRMultiPolygon();
+    for( int j = 0; j < 100; j++ )
+    {
+        OGRPolygon* poPoly = new OGRPolygon();
+        OGRLinearRing* poRing = new OGRLinearRing();
+        for( int i = 0; i < 100; i++ )
+            poRing->addPoint(j * 3 + std::cos(i * 2 * M_PI / 100),
+                             std::sin(i * 2 * M_PI / 100));
+        poRing->closeRings();
+        poPoly->addRingDirectly(poRing);
+        poMP->addGeometryDirectly(poPoly);
+    }
+    return poMP;
+}
+
+void AddWKBBenches( std::vector<BenchCase>& aoCases )
+{
+    for( const char* pszKind : { "linestring25d", "polygon", "multipolygon" } )
+    {
+        struct Fixture
+        {
+            std::unique_ptr<OGRGeometry> poGeom{};
+            std::vector<GByte> abyWKB{};
+        };
+        auto poFixture = std::make_shared<Fixture>();
+        const std::string osKind(pszKind);
+        auto oSetup = [poFixture, osKind]()
+        {
+            poFixture->poGeom.reset(CreateBenchGeometry(osKind));
+            poFixture->abyWKB.resize(poFixture->poGeom->WkbSize());
+            return poFixture->poGeom->exportToWkb(
+                wkbNDR, &poFixture->abyWKB[0], wkbVariantIso) == OGRERR_NONE;
+        };
+        auto oTeardown = [poFixture]()
+        {
+            poFixture->poGeom.reset();
+            std::vector<GByte>().swap(poFixture->abyWKB);
+        };
+        const double dfPoints =
+            osKind == "multipolygon" ? 100 * 101 : 10000 + (osKind == "polygon");
+
+        BenchCase oParse;
+        oParse.osName = "wkb/parse/" + osKind;
+        oParse.osGroup = "micro";
+        oParse.osUnit = "points";
+        oParse.dfItems = dfPoints;
+        oParse.oSetup = oSetup;
+        oParse.oRun = [poFixture]()
+        {
+            OGRGeometry* poGeom = nullptr;
+            const OGRErr eErr = OGRGeometryFactory::createFromWkb(
+                &poFixture->abyWKB[0], nullptr, &poGeom,
+                static_cast<int>(poFixture->abyWKB.size()), wkbVariantIso);
+            delete poGeom;
+            return eErr == OGRERR_NONE;
+        };
+        oParse.oTeardown = oTeardown;
+        aoCases.push_back(oParse);
+
+        BenchCase oExport(oParse);
+        oExport.osName = "wkb/export/" + osKind;
+        oExport.oRun = [poFixture]()
+        {
+            return poFixture->poGeom->exportToWkb(
+                wkbNDR, &poFixture->abyWKB[0], wkbVariantIso) == OGRERR_NONE;
+        };
+        aoCases.push_back(oExport);
+    }
+}
+
+/************************************************************************/
+/*                           AddSWQBenches()                            */
+/************************************************************************/
+
+void AddSWQBenches( std::vector<BenchCase>& aoCases )
+{
+    constexpr int nFeatures = 100000;
+    const struct { const char* pszName; const char* pszExpr; } asExprs[] = {
+        { "integer_range", "a > 500 AND a < 1000" },
+        { "like", "c LIKE 'value_1%'" },
+        { "in_or_between", "a IN (1, 5, 10, 50, 100) OR b BETWEEN 0.25 AND 0.5" },
+        { "string_equal", "c = 'value_42' AND a % 7 = 0" } };
+
+    struct Fixture
+    {
+        OGRFeatureDefn* poDefn = nullptr;
+        std::vector<std::unique_ptr<OGRFeature>> apoFeatures{};
+        ~Fixture() { Clear(); }
+        void Clear()
+        {
+            apoFeatures.clear();
+            if( poDefn )
+                poDefn->Release();
+            poDefn = nullptr;
+        }
+    };
+    auto poFixture = std::make_shared<Fixture>();
+
+    for( const auto& sExpr : asExprs )
+    {
+        const std::string osExpr(sExpr.pszExpr);
+        auto poQuery = std::make_shared<std::unique_ptr<OGRFeatureQuery>>();
+
+        BenchCase oCase;
+        oCase.osName = std::string("swq/") + sExpr.pszName;
+        oCase.osGroup = "micro";
+        oCase.osUnit = "features";
+        oCase.dfItems = nFeatures;
+        oCase.oSetup = [poFixture, poQuery, osExpr]()
+        {
+            if( poFixture->poDefn == nullptr )
+            {
+                poFixture->poDefn = new OGRFeatureDefn("bench");
+                poFixture->poDefn->Reference();
+                OGRFieldDefn oFieldA("a", OFTInteger);
+                poFixture->poDefn->AddFieldDefn(&oFieldA);
+                OGRFieldDefn oFieldB("b", OFTReal);
+                poFixture->poDefn->AddFieldDefn(&oFieldB);
+                OGRFieldDefn oFieldC("c", OFTString);
+                poFixture->poDefn->AddFieldDefn(&oFieldC);
+                for( int i = 0; i < nFeatures; i++ )
+                {
+                    std::unique_ptr<OGRFeature> poFeature(
+                        new OGRFeature(poFixture->poDefn));
+                    poFeature->SetField(0, i % 2000);
+                    poFeature->SetField(1, (i % 1000) / 1000.0);
+                    poFeature->SetField(2, CPLSPrintf("value_%d", i % 500));
+                    poFixture->apoFeatures.push_back(std::move(poFeature));
+                }
+            }
+            poQuery->reset(new OGRFeatureQuery());
+            return (*poQuery)->Compile(poFixture->poDefn,
+                                       osExpr.c_str()) == OGRERR_NONE;
+        };
+        oCase.oRun = [poFixture, poQuery]()
+        {
+            int nMatches = 0;
+            for( auto& poFeature : poFixture->apoFeatures )
+                nMatches += (*poQuery)->Evaluate(poFeature.get()) ? 1 : 0;
+            return nMatches >= 0;
+        };
+        oCase.oTeardown = [poQuery]() { poQuery->reset(); };
+        aoCases.push_back(oCase);
+    }
+}
+
+/************************************************************************/
+/*                  AddRandomTileReadBench() (macro)                    */
+/************************************************************************/
+
+// Random reads of 256x256 tiles at all the resolutions of a tiled, DEFLATE
+// compressed GeoTIFF file whose overviews are stored before the full
+// resolution image, as in a cloud optimized GeoTIFF.
+void AddRandomTileReadBench( std::vector<BenchCase>& aoCases )
+{
+    constexpr int nSize = 8192;
+    constexpr int nReads = 256;
+    const std::string osFilename = std::string(pszBenchDir) + "/cog.tif";
+
+    BenchCase oCase;
+    oCase.osName = "scenario/cog_random_tile_read";
+    oCase.osGroup = "macro";
+    oCase.osUnit = "tiles";
+    oCase.dfItems = nReads;
+    oCase.oSetup = [osFilename]()
+    {
+        GDALDriverH hGTiff = GDALGetDriverByName("GTiff");
+        if( hGTiff == nullptr )
+            return false;
+        const std::string osTmp = std::string(pszBenchDir) + "/cog_tmp.tif";
+        const char* const apszOptions[] = {
+            "TILED=YES", "COMPRESS=DEFLATE", "COPY_SRC_OVERVIEWS=YES",
+            nullptr };
+        GDALDatasetH hMEM = CreatePatternMEM(nSize, nSize, 3, GDT_Byte);
+        if( hMEM == nullptr )
+            return false;
+        GDALDatasetH hTmp = GDALCreateCopy(
+            hGTiff, osTmp.c_str(), hMEM, FALSE,
+            const_cast<char**>(apszOptions), nullptr, nullptr);
+        GDALClose(hMEM);
+        if( hTmp == nullptr )
+            return false;
+        int anLevels[] = { 2, 4, 8, 16, 32 };
+        bool bOK = GDALBuildOverviews(hTmp, "AVERAGE", 5, anLevels, 0,
+                                      nullptr, nullptr, nullptr) == CE_None;
+        GDALDatasetH hDS = bOK ?
+            GDALCreateCopy(hGTiff, osFilename.c_str(), hTmp, FALSE,
+                           const_cast<char**>(apszOptions), nullptr, nullptr) :
+            nullptr;
+        GDALClose(hTmp);
+        VSIUnlink(osTmp.c_str());
+        if( hDS == nullptr )
+            return false;
+        GDALClose(hDS);
+        return true;
+    };
+    oCase.oRun = [osFilename]()
+    {
+        GDALDatasetH hDS = GDALOpen(osFilename.c_str(), GA_ReadOnly);
+        if( hDS == nullptr )
+            return false;
+        BenchRandom oRandom(42);
+        std::vector<GByte> abyTile(256 * 256 * 3);
+        const int anBandMap[] = { 1, 2, 3 };
+        bool bOK = true;
+        for( int i = 0; bOK && i < nReads; i++ )
+        {
+            GDALRasterBandH hBand = GDALGetRasterBand(hDS, 1);
+            const int iOvr = oRandom.Next(GDALGetOverviewCount(hBand) + 1) - 1;
+            int nXSize = GDALGetRasterXSize(hDS);
+            int nYSize = GDALGetRasterYSize(hDS);
+            if( iOvr >= 0 )
+            {
+                nXSize = GDALGetRasterBandXSize(GDALGetOverview(hBand, iOvr));
+                nYSize = GDALGetRasterBandYSize(GDALGetOverview(hBand, iOvr));
+            }
+            const int nTileXSize = std::min(256, nXSize);
+            const int nTileYSize = std::min(256, nYSize);
+            const int nXOff =
+                oRandom.Next(DIV_ROUND_UP(nXSize, 256)) * 256;
+            const int nYOff =
+                oRandom.Next(DIV_ROUND_UP(nYSize, 256)) * 256;
+            const int nReqXSize = std::min(nTileXSize, nXSize - nXOff);
+            const int nReqYSize = std::min(nTileYSize, nYSize - nYOff);
+            for( int iBand = 0; bOK && iBand < 3; iBand++ )
+            {
+                GDALRasterBandH hReadBand =
+                    GDALGetRasterBand(hDS, anBandMap[iBand]);
+                if( iOvr >= 0 )
+                    hReadBand = GDALGetOverview(hReadBand, iOvr);
+                bOK = GDALRasterIO(hReadBand, GF_Read, nXOff, nYOff,
+                                   nReqXSize, nReqYSize,
+                                   &abyTile[iBand * 256 * 256],
+                                   nReqXSize, nReqYSize, GDT_Byte,
+                                   0, 0) == CE_None;
+            }
+        }
+        GDALClose(hDS);
+        return bOK;
+    };
+    oCase.oTeardown = [osFilename]() { VSIUnlink(osFilename.c_str()); };
+    aoCases.push_back(oCase);
+}
+
+/************************************************************************/
+/*                   AddVectorScenarioBenches() (macro)                 */
+/************************************************************************/
+
+// Create a vector file of nFeatures points or small squares.
+bool CreateVectorFile( const char* pszDriver, const std::string& osFilename,
+                       int nFeatures, bool bPolygons )
+{
+    GDALDriver* poDriver =
+        GetGDALDriverManager()->GetDriverByName(pszDriver);
+    if( poDriver == nullptr )
+        return false;
+    std::unique_ptr<GDALDataset> poDS(poDriver->Create(
+        osFilename.c_str(), 0, 0, 0, GDT_Unknown, nullptr));
+    if( poDS == nullptr )
+        return false;
+    OGRLayer* poLayer = poDS->CreateLayer(
+        "bench", nullptr, bPolygons ? wkbPolygon : wkbPoint, nullptr);
+    if( poLayer == nullptr )
+        return false;
+    OGRFieldDefn oFieldId("id", OFTInteger);
+    OGRFieldDefn oFieldValue("value", OFTReal);
+    OGRFieldDefn oFieldName("name", OFTString);
+    oFieldName.SetWidth(32);
+    if( poLayer->CreateField(&oFieldId) != OGRERR_NONE ||
+        poLayer->CreateField(&oFieldValue) != OGRERR_NONE ||
+        poLayer->CreateField(&oFieldName) != OGRERR_NONE )
+        return false;
+
+    if( poLayer->StartTransaction() != OGRERR_NONE )
+        return false;
+    OGRFeature oFeature(poLayer->GetLayerDefn());
+    for( int i = 0; i < nFeatures; i++ )
+    {
+        const double dfX = (i % 1000) * 10.0;
+        const double dfY = (i / 1000) * 10.0;
+        oFeature.SetFID(OGRNullFID);
+        oFeature.SetField(0, i);
+        oFeature.SetField(1, i * 0.25);
+        oFeature.SetField(2, CPLSPrintf("feature_%d", i));
+        if( bPolygons )
+        {
+            OGRPolygon* poPoly = new OGRPolygon();
+            OGRLinearRing* poRing = new OGRLinearRing();
+            poRing->addPoint(dfX, dfY);
+            poRing->addPoint(dfX, dfY + 8);
+            poRing->addPoint(dfX + 8, dfY + 8);
+            poRing->addPoint(dfX + 8, dfY);
+            poRing->addPoint(dfX, dfY);
+            poPoly->addRingDirectly(poRing);
+            oFeature.SetGeometryDirectly(poPoly);
+        }
+        else
+        {
+            oFeature.SetGeometryDirectly(new OGRPoint(dfX, dfY));
+        }
+        if( poLayer->CreateFeature(&oFeature) != OGRERR_NONE )
+            return false;
+    }
+    return poLayer->CommitTransaction() == OGRERR_NONE;
+}
+
+void AddVectorScenarioBenches( std::vector<BenchCase>& aoCases )
+{
+    constexpr int nFeatures = 100000;
+
+    {
+        const std::string osSrc = std::string(pszBenchDir) + "/src.gpkg";
+        const std::string osDst = std::string(pszBenchDir) + "/dst.gpkg";
+        BenchCase oCase;
+        oCase.osName = "scenario/ogr2ogr_gpkg_to_gpkg";
+        oCase.osGroup = "macro";
+        oCase.osUnit = "features";
+        oCase.dfItems = nFeatures;
+        oCase.oSetup = [osSrc]()
+        {
+            return CreateVectorFile("GPKG", osSrc, nFeatures, false);
+        };
+        oCase.oRun = [osSrc, osDst]()
+        {
+            GDALDatasetH hSrcDS = GDALOpenEx(osSrc.c_str(), GDAL_OF_VECTOR,
+                                             nullptr, nullptr, nullptr);
+            if( hSrcDS == nullptr )
+                return false;
+            const char* const apszArgs[] = { "-f", "GPKG", nullptr };
+            GDALVectorTranslateOptions* psOptions =
+                GDALVectorTranslateOptionsNew(
+                    const_cast<char**>(apszArgs), nullptr);
+            GDALDatasetH hDstDS = GDALVectorTranslate(
+                osDst.c_str(), nullptr, 1, &hSrcDS, psOptions, nullptr);
+            GDALVectorTranslateOptionsFree(psOptions);
+            const bool bOK = hDstDS != nullptr;
+            if( hDstDS )
+                GDALClose(hDstDS);
+            GDALClose(hSrcDS);
+            VSIUnlink(osDst.c_str());
+            return bOK;
+        };
+        oCase.oTeardown = [osSrc]() { VSIUnlink(osSrc.c_str()); };
+        aoCases.push_back(oCase);
+    }
+
+    {
+        const std::string osShp = std::string(pszBenchDir) + "/scan.shp";
+        BenchCase oCase;
+        oCase.osName = "scenario/shapefile_scan";
+        oCase.osGroup = "macro";
+        oCase.osUnit = "features";
+        oCase.dfItems = nFeatures;
+        oCase.oSetup = [osShp]()
+        {
+            return CreateVectorFile("ESRI Shapefile", osShp, nFeatures, true);
+        };
+        oCase.oRun = [osShp]()
+        {
+            std::unique_ptr<GDALDataset> poDS(GDALDataset::Open(
+                osShp.c_str(), GDAL_OF_VECTOR));
+            if( poDS == nullptr || poDS->GetLayerCount() != 1 )
+                return false;
+            OGRLayer* poLayer = poDS->GetLayer(0);
+            GIntBig nCount = 0;
+            OGREnvelope sEnvelope;
+            while( true )
+            {
+                std::unique_ptr<OGRFeature> poFeature(
+                    poLayer->GetNextFeature());
+                if( poFeature == nullptr )
+                    break;
+                OGRGeometry* poGeom = poFeature->GetGeometryRef();
+                if( poGeom )
+                    poGeom->getEnvelope(&sEnvelope);
+                nCount++;
+            }
+            return nCount == nFeatures;
+        };
+        oCase.oTeardown = [osShp]()
+        {
+            GDALDriverH hDriver = GDALGetDriverByName("ESRI Shapefile");
+            if( hDriver )
+                GDALDeleteDataset(hDriver, osShp.c_str());
+        };
+        aoCases.push_back(oCase);
+    }
+}
+
+/************************************************************************/
+/*                              RunCase()                               */
+/************************************************************************/
+
+CPLJSONObject RunCase( BenchCase& oCase, double dfMinTime,
+                       int nMinIterations, bool bQuiet )
+{
+    CPLJSONObject oResult;
+    oResult.Add("name", oCase.osName);
+    oResult.Add("group", oCase.osGroup);
+
+    if( !bQuiet )
+    {
+        fprintf(stderr, "%-45s ", oCase.osName.c_str());
+        fflush(stderr);
+    }
+
+    CPLErrorReset();
+    bool bOK = !oCase.oSetup || oCase.oSetup();
+    std::vector<double> adfTimes;
+    if( bOK )
+    {
+        // Warm-up run, not timed.
+        bOK = oCase.oRun();
+        double dfTotal = 0.0;
+        while( bOK &&
+               (static_cast<int>(adfTimes.size()) < nMinIterations ||
+                dfTotal < dfMinTime) )
+        {
+            const auto oStart = std::chrono::steady_clock::now();
+            bOK = oCase.oRun();
+            const std::chrono::duration<double> oElapsed =
+                std::chrono::steady_clock::now() - oStart;
+            adfTimes.push_back(oElapsed.count());
+            dfTotal += oElapsed.count();
+        }
+    }
+    if( oCase.oTeardown )
+        oCase.oTeardown();
+
+    if( !bOK )
+    {
+        const char* pszReason = CPLGetLastErrorMsg();
+        oResult.Add("skipped", true);
+        oResult.Add("reason", pszReason[0] ? pszReason :
+                                             "setup or run failed");
+        if( !bQuiet )
+            fprintf(stderr, "skipped (%s)\n",
+                    pszReason[0] ? pszReason : "setup or run failed");
+        return oResult;
+    }
+
+    std::vector<double> adfSorted(adfTimes);
+    std::sort(adfSorted.begin(), adfSorted.end());
+    const size_t nCount = adfSorted.size();
+    const double dfMedian = (nCount % 2) ?
+        adfSorted[nCount / 2] :
+        (adfSorted[nCount / 2 - 1] + adfSorted[nCount / 2]) / 2;
+    double dfSum = 0.0;
+    for( const double dfTime : adfTimes )
+        dfSum += dfTime;
+    const double dfMean = dfSum / nCount;
+    double dfVariance = 0.0;
+    for( const double dfTime : adfTimes )
+        dfVariance += (dfTime - dfMean) * (dfTime - dfMean);
+
+    oResult.Add("iterations", static_cast<int>(nCount));
+    oResult.Add("min_s", adfSorted.front());
+    oResult.Add("median_s", dfMedian);
+    oResult.Add("mean_s", dfMean);
+    oResult.Add("max_s", adfSorted.back());
+    oResult.Add("stddev_s", std::sqrt(dfVariance / nCount));
+    oResult.Add("items", oCase.dfItems);
+    oResult.Add("unit", oCase.osUnit);
+    if( dfMedian > 0 )
+        oResult.Add("items_per_s", oCase.dfItems / dfMedian);
+
+    if( !bQuiet )
+        fprintf(stderr, "%10.3f ms  %12.4g %s/s\n", dfMedian * 1000,
+                dfMedian > 0 ? oCase.dfItems / dfMedian : 0.0,
+                oCase.osUnit.c_str());
+    return oResult;
+}
+
+} // namespace
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char ** argv )
+{
+    EarlySetConfigOptions(argc, argv);
+
+    GDALAllRegister();
+
+    argc = GDALGeneralCmdLineProcessor( argc, &argv, 0 );
+    if( argc < 1 )
+        exit( -argc );
+
+    bool bList = false;
+    bool bQuiet = false;
+    double dfMinTime = 1.0;
+    int nMinIterations = 3;
+    const char* pszOutput = nullptr;
+    std::vector<std::string> aosFilters;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "--help") )
+            Usage();
+        else if( EQUAL(argv[i], "-list") )
+            bList = true;
+        else if( EQUAL(argv[i], "-q") || EQUAL(argv[i], "-quiet") )
+            bQuiet = true;
+        else if( EQUAL(argv[i], "-filter") && i + 1 < argc )
+            aosFilters.push_back(argv[++i]);
+        else if( EQUAL(argv[i], "-min_time") && i + 1 < argc )
+            dfMinTime = CPLAtof(argv[++i]);
+        else if( EQUAL(argv[i], "-min_iterations") && i + 1 < argc )
+            nMinIterations = std::max(1, atoi(argv[++i]));
+        else if( EQUAL(argv[i], "-o") && i + 1 < argc )
+            pszOutput = argv[++i];
+        else
+            Usage(CPLSPrintf("Unknown option name '%s'", argv[i]));
+    }
+
+    std::vector<BenchCase> aoCases;
+    AddCopyWordsBenches(aoCases);
+    AddWarpBenches(aoCases);
+    AddOverviewBenches(aoCases);
+    AddBlockCacheBenches(aoCases);
+    AddWKBBenches(aoCases);
+    AddSWQBenches(aoCases);
+    AddRandomTileReadBench(aoCases);
+    AddVectorScenarioBenches(aoCases);
+
+    std::vector<BenchCase*> apoSelected;
+    for( auto& oCase : aoCases )
+    {
+        bool bSelected = aosFilters.empty();
+        for( const auto& osFilter : aosFilters )
+        {
+            if( oCase.osName.find(osFilter) != std::string::npos )
+                bSelected = true;
+        }
+        if( bSelected )
+            apoSelected.push_back(&oCase);
+    }
+
+    if( bList )
+    {
+        for( const BenchCase* poCase : apoSelected )
+            printf("%s\n", poCase->osName.c_str());
+        CSLDestroy(argv);
+        GDALDestroyDriverManager();
+        return 0;
+    }
+
+    CPLJSONDocument oDoc;
+    CPLJSONObject oRoot = oDoc.GetRoot();
+    oRoot.Add("gdal_version", GDALVersionInfo("RELEASE_NAME"));
+    oRoot.Add("gdal_build_info", GDALVersionInfo("BUILD_INFO"));
+    oRoot.Add("num_cpus", CPLGetNumCPUs());
+    oRoot.Add("cache_max", static_cast<GInt64>(GDALGetCacheMax64()));
+    oRoot.Add("min_time_s", dfMinTime);
+    oRoot.Add("min_iterations", nMinIterations);
+    CPLJSONArray oResults;
+
+    int nFailures = 0;
+    for( BenchCase* poCase : apoSelected )
+    {
+        CPLJSONObject oResult =
+            RunCase(*poCase, dfMinTime, nMinIterations, bQuiet);
+        if( oResult.GetBool("skipped", false) )
+            nFailures++;
+        oResults.Add(oResult);
+    }
+    oRoot.Add("benchmarks", oResults);
+    const GIntBig nPeakRSS = GetPeakRSS();
+    if( nPeakRSS >= 0 )
+        oRoot.Add("peak_rss_bytes", static_cast<GInt64>(nPeakRSS));
+    VSIRmdirRecursive(pszBenchDir);
+
+    int nRet = 0;
+    if( pszOutput )
+    {
+        if( !oDoc.Save(pszOutput) )
+            nRet = 1;
+    }
+    else
+    {
+        printf("%s\n", oRoot.Format(CPLJSONObject::Pretty).c_str());
+    }
+
+    if( !bQuiet && nFailures )
+        fprintf(stderr, "%d benchmark(s) skipped.\n", nFailures);
+
+    CSLDestroy(argv);
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
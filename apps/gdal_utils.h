@@ -218,6 +218,21 @@ GDALDatasetH CPL_DLL GDALBuildVRT( const char *pszDest,
                                    int nSrcCount, GDALDatasetH *pahSrcDS, const char* const* papszSrcDSNames,
                                    const GDALBuildVRTOptions *psOptions, int *pbUsageError );
 
+/*! Options for GDALLocationInfo(). Opaque type */
+typedef struct GDALLocationInfoOptions GDALLocationInfoOptions;
+
+/** Opaque type */
+typedef struct GDALLocationInfoOptionsForBinary GDALLocationInfoOptionsForBinary;
+
+GDALLocationInfoOptions CPL_DLL *GDALLocationInfoOptionsNew(char** papszArgv,
+                                                      GDALLocationInfoOptionsForBinary* psOptionsForBinary);
+
+void CPL_DLL GDALLocationInfoOptionsFree( GDALLocationInfoOptions *psOptions );
+
+char CPL_DLL *GDALLocationInfo( GDALDatasetH hSrcDataset,
+                                int nCount, const double* padfX, const double* padfY,
+                                const GDALLocationInfoOptions *psOptions );
+
 CPL_C_END
 
 #endif /* GDAL_UTILS_H_INCLUDED */
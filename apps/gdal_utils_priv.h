@@ -138,6 +138,17 @@ struct GDALBuildVRTOptionsForBinary
     int bOverwrite;
 };
 
+struct GDALLocationInfoOptionsForBinary
+{
+    char* pszSrcFilename;
+    char** papszOpenOptions;
+    char* pszLocX;
+    char* pszLocY;
+
+    /* Read all the locations of stdin before reporting them. */
+    int bBatch;
+};
+
 CPL_C_END
 
 #endif /* #ifndef DOXYGEN_SKIP */
@@ -32,6 +32,10 @@
 #include "gdal_priv.h"
 #include "commonutils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 CPL_CVSID("$Id: gdaladdo.cpp 9bae05435e199592be48a2a6c8ef5f649fa5d113 2018-03-26 14:16:35 +0200 Even Rouault $")
 
 /************************************************************************/
@@ -43,6 +47,8 @@ static void Usage( const char* pszErrorMsg = nullptr )
 {
     printf("Usage: gdaladdo [-r {nearest,average,gauss,cubic,cubicspline,lanczos,average_mp,average_magphase,mode}]\n"
            "                [-ro] [-clean] [-q] [-oo NAME=VALUE]* [-minsize val]\n"
+           "                [-partial_refresh_srcwin xoff yoff xsize ysize]*\n"
+           "                [-partial_refresh_projwin ulx uly lrx lry]*\n"
            "                [--help-general] filename [levels]\n"
            "\n"
            "  -r : choice of resampling method (default: nearest)\n"
@@ -51,6 +57,9 @@ static void Usage( const char* pszErrorMsg = nullptr )
            "  -clean : remove all overviews\n"
            "  -q : turn off progress display\n"
            "  -b : band to create overview (if not set overviews will be created for all bands)\n"
+           "  -partial_refresh_srcwin / -partial_refresh_projwin : only refresh the\n"
+           "        existing overviews over the updated window(s), in pixels or in\n"
+           "        georeferenced coordinates.\n"
            "  filename: The file to build overviews for (or whose overviews must be removed).\n"
            "  levels: A list of integral overview levels to build. Ignored with -clean option.\n"
            "\n"
@@ -100,6 +109,132 @@ static void CPL_STDCALL GDALAddoErrorHandler( CPLErr eErr, CPLErrorNum errNum,
     aoErrors.push_back(GDALError(eErr, errNum, pszMsg));
 }
 
+/************************************************************************/
+/*                         GetRefreshedOverviews()                      */
+/************************************************************************/
+
+// Collect the existing overviews of hBand matching the requested levels, or
+// all of them if no level is requested.
+static bool GetRefreshedOverviews( GDALRasterBandH hBand,
+                                   const int* panLevels, int nLevelCount,
+                                   std::vector<GDALRasterBandH>& ahOvrBands )
+{
+    const int nXSize = GDALGetRasterBandXSize(hBand);
+    const int nYSize = GDALGetRasterBandYSize(hBand);
+    const int nOvrCount = GDALGetOverviewCount(hBand);
+    ahOvrBands.clear();
+    if( nLevelCount == 0 )
+    {
+        for( int j = 0; j < nOvrCount; j++ )
+            ahOvrBands.push_back(GDALGetOverview(hBand, j));
+        return true;
+    }
+
+    for( int i = 0; i < nLevelCount; i++ )
+    {
+        GDALRasterBandH hOvrBand = nullptr;
+        for( int j = 0; j < nOvrCount && hOvrBand == nullptr; j++ )
+        {
+            GDALRasterBandH hCandidate = GDALGetOverview(hBand, j);
+            const int nOvrXSize = GDALGetRasterBandXSize(hCandidate);
+            const int nOvrYSize = GDALGetRasterBandYSize(hCandidate);
+            if( GDALComputeOvFactor(nOvrXSize, nXSize,
+                                    nOvrYSize, nYSize) == panLevels[i] ||
+                (nOvrXSize == DIV_ROUND_UP(nXSize, panLevels[i]) &&
+                 nOvrYSize == DIV_ROUND_UP(nYSize, panLevels[i])) )
+            {
+                hOvrBand = hCandidate;
+            }
+        }
+        if( hOvrBand == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Overview level %d does not exist. "
+                     "It must be built before being refreshed.",
+                     panLevels[i]);
+            return false;
+        }
+        ahOvrBands.push_back(hOvrBand);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           PartialRefresh()                           */
+/************************************************************************/
+
+// Refresh the existing overviews over the windows, given as quadruplets of
+// xoff, yoff, xsize, ysize in pixels of the full resolution dataset.
+static bool PartialRefresh( GDALDatasetH hDataset,
+                            const std::vector<int>& anWindows,
+                            const char* pszResampling,
+                            const int* panLevels, int nLevelCount,
+                            int nBandCount, const int* panBandList,
+                            GDALProgressFunc pfnProgress )
+{
+    std::vector<int> anBands;
+    for( int i = 0; i < nBandCount; i++ )
+        anBands.push_back(panBandList[i]);
+    if( nBandCount == 0 )
+    {
+        for( int i = 0; i < GDALGetRasterCount(hDataset); i++ )
+            anBands.push_back(i + 1);
+    }
+
+    // The refreshed bands, preceded by the per-dataset mask if it has its
+    // own overviews, as when they are built.
+    std::vector<GDALRasterBandH> ahBands;
+    if( !anBands.empty() )
+    {
+        GDALRasterBandH hFirstBand = GDALGetRasterBand(hDataset, anBands[0]);
+        if( hFirstBand &&
+            GDALGetMaskFlags(hFirstBand) == GMF_PER_DATASET &&
+            GDALGetOverviewCount(GDALGetMaskBand(hFirstBand)) > 0 )
+        {
+            ahBands.push_back(GDALGetMaskBand(hFirstBand));
+        }
+    }
+    for( const int nBand : anBands )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand(hDataset, nBand);
+        if( hBand == nullptr )
+            return false;
+        ahBands.push_back(hBand);
+    }
+
+    const size_t nWindows = anWindows.size() / 4;
+    const double dfJobs = static_cast<double>(ahBands.size() * nWindows);
+    size_t iJob = 0;
+    for( GDALRasterBandH hBand : ahBands )
+    {
+        std::vector<GDALRasterBandH> ahOvrBands;
+        if( !GetRefreshedOverviews(hBand, panLevels, nLevelCount, ahOvrBands) )
+            return false;
+        if( ahOvrBands.empty() )
+        {
+            iJob += nWindows;
+            continue;
+        }
+
+        for( size_t i = 0; i < nWindows; i++, iJob++ )
+        {
+            void* pScaledProgress = GDALCreateScaledProgress(
+                iJob / dfJobs, (iJob + 1) / dfJobs, pfnProgress, nullptr);
+            const CPLErr eErr = GDALRegenerateOverviewsWindow(
+                hBand, static_cast<int>(ahOvrBands.size()), &ahOvrBands[0],
+                pszResampling,
+                anWindows[4 * i], anWindows[4 * i + 1],
+                anWindows[4 * i + 2], anWindows[4 * i + 3],
+                GDALScaledProgress, pScaledProgress);
+            GDALDestroyScaledProgress(pScaledProgress);
+            if( eErr != CE_None )
+                return false;
+        }
+    }
+    pfnProgress(1.0, nullptr, nullptr);
+    return true;
+}
+
 /************************************************************************/
 /*                                main()                                */
 /************************************************************************/
@@ -141,6 +276,8 @@ MAIN_START(nArgc, papszArgv)
     int nBandCount = 0;
     char **papszOpenOptions = nullptr;
     int nMinSize = 256;
+    std::vector<int> anRefreshSrcWins;
+    std::vector<double> adfRefreshProjWins;
 
 /* -------------------------------------------------------------------- */
 /*      Parse command line.                                              */
@@ -206,6 +343,18 @@ MAIN_START(nArgc, papszArgv)
             CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
             nMinSize = atoi(papszArgv[++iArg]);
         }
+        else if( EQUAL(papszArgv[iArg], "-partial_refresh_srcwin") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(4);
+            for( int i = 0; i < 4; i++ )
+                anRefreshSrcWins.push_back(atoi(papszArgv[++iArg]));
+        }
+        else if( EQUAL(papszArgv[iArg], "-partial_refresh_projwin") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(4);
+            for( int i = 0; i < 4; i++ )
+                adfRefreshProjWins.push_back(CPLAtofM(papszArgv[++iArg]));
+        }
         else if( papszArgv[iArg][0] == '-' )
         {
             Usage(CPLSPrintf("Unknown option name '%s'", papszArgv[iArg]));
@@ -279,6 +428,63 @@ MAIN_START(nArgc, papszArgv)
             nResultStatus = 200;
         }
     }
+    else if( !anRefreshSrcWins.empty() || !adfRefreshProjWins.empty() )
+    {
+/* -------------------------------------------------------------------- */
+/*      Refresh the existing overviews over the updated windows.        */
+/* -------------------------------------------------------------------- */
+        const int nXSize = GDALGetRasterXSize(hDataset);
+        const int nYSize = GDALGetRasterYSize(hDataset);
+        double adfGeoTransform[6] = {};
+        double adfInvGeoTransform[6] = {};
+        if( !adfRefreshProjWins.empty() &&
+            (GDALGetGeoTransform(hDataset, adfGeoTransform) != CE_None ||
+             !GDALInvGeoTransform(adfGeoTransform, adfInvGeoTransform)) )
+        {
+            fprintf(stderr, "-partial_refresh_projwin requires a dataset "
+                    "with a valid geotransform.\n");
+            nResultStatus = 1;
+        }
+        for( size_t i = 0;
+             nResultStatus == 0 && i < adfRefreshProjWins.size(); i += 4 )
+        {
+            double dfX1 = 0.0;
+            double dfY1 = 0.0;
+            double dfX2 = 0.0;
+            double dfY2 = 0.0;
+            GDALApplyGeoTransform(adfInvGeoTransform,
+                                  adfRefreshProjWins[i],
+                                  adfRefreshProjWins[i + 1], &dfX1, &dfY1);
+            GDALApplyGeoTransform(adfInvGeoTransform,
+                                  adfRefreshProjWins[i + 2],
+                                  adfRefreshProjWins[i + 3], &dfX2, &dfY2);
+            const double dfXOff =
+                std::max(0.0, std::floor(std::min(dfX1, dfX2)));
+            const double dfYOff =
+                std::max(0.0, std::floor(std::min(dfY1, dfY2)));
+            const double dfXEnd = std::min(static_cast<double>(nXSize),
+                                           std::ceil(std::max(dfX1, dfX2)));
+            const double dfYEnd = std::min(static_cast<double>(nYSize),
+                                           std::ceil(std::max(dfY1, dfY2)));
+            // Windows outside of the raster have nothing to refresh.
+            if( dfXOff < dfXEnd && dfYOff < dfYEnd )
+            {
+                anRefreshSrcWins.push_back(static_cast<int>(dfXOff));
+                anRefreshSrcWins.push_back(static_cast<int>(dfYOff));
+                anRefreshSrcWins.push_back(static_cast<int>(dfXEnd - dfXOff));
+                anRefreshSrcWins.push_back(static_cast<int>(dfYEnd - dfYOff));
+            }
+        }
+
+        if( nResultStatus == 0 &&
+            !PartialRefresh(hDataset, anRefreshSrcWins, pszResampling,
+                            anLevels, nLevelCount, nBandCount, panBandList,
+                            pfnProgress) )
+        {
+            printf("Overview refresh failed.\n");
+            nResultStatus = 100;
+        }
+    }
     else
     {
 /* -------------------------------------------------------------------- */
@@ -33,6 +33,7 @@
 #include "cpl_port.h"
 #include "gdal_utils.h"
 #include "gdal_utils_priv.h"
+#include "commonutils.h"
 
 #include <cmath>
 #include <cstdio>
@@ -1256,6 +1257,11 @@ GDALDataset* VRTBuilder::Build(GDALProgressFunc pfnProgress, void * pProgressDat
         }
     }
 
+    // The input datasets are opened ahead by several threads if
+    // GDAL_NUM_THREADS is set, and analysed in order by this thread.
+    GDALConcurrentDatasetOpener oOpener(GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR,
+                                        papszOpenOptions);
+    int nFilesAdded = 0;
     int nCountValid = 0;
     for(int i=0; ppszInputFilenames != nullptr && i<nInputFiles;i++)
     {
@@ -1266,11 +1272,12 @@ GDALDataset* VRTBuilder::Build(GDALProgressFunc pfnProgress, void * pProgressDat
             return nullptr;
         }
 
+        // nInputFiles is increased by AnalyseRaster() for subdatasets.
+        for( ; pahSrcDS == nullptr && nFilesAdded < nInputFiles; nFilesAdded++ )
+            oOpener.Add(ppszInputFilenames[nFilesAdded]);
+
         GDALDatasetH hDS =
-            (pahSrcDS) ? pahSrcDS[i] :
-                GDALOpenEx( ppszInputFilenames[i],
-                            GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR, nullptr,
-                            papszOpenOptions, nullptr );
+            (pahSrcDS) ? pahSrcDS[i] : oOpener.Get(i);
         pasDatasetProperties[i].isFileOK = FALSE;
 
         if (hDS)
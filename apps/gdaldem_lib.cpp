@@ -102,11 +102,16 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 
@@ -278,6 +283,374 @@ GInt32 INTERPOL(GInt32 a, GInt32 b, int bSrcHasNoData, GInt32 fSrcNoDataValue)
 /*                  GDALGeneric3x3Processing()                          */
 /************************************************************************/
 
+template<class T>
+struct GDALGeneric3x3Context
+{
+    GDALRasterBandH hSrcBand = nullptr;
+    GDALDataType    eReadDT = GDT_Unknown;
+    int             nXSize = 0;
+    int             nYSize = 0;
+    bool            bSrcHasNoData = false;
+    T               fSrcNoDataValue = 0;
+    bool            bIsSrcNoDataNan = false;
+    float           fDstNoDataValue = 0.0f;
+    typename GDALGeneric3x3ProcessingAlg<T>::type pfnAlg = nullptr;
+    typename GDALGeneric3x3ProcessingAlg_multisample<T>::type
+                    pfnAlg_multisample = nullptr;
+    void           *pData = nullptr;
+    bool            bComputeAtEdges = false;
+
+    std::mutex      oIOMutex{};
+    std::mutex      oMutex{};
+    bool            bStop = false;
+};
+
+// Output lines [nYStart, nYEnd[ computed from the source lines
+// [nYStart - 1, nYEnd + 1[ clamped to the raster.
+template<class T>
+struct GDALGeneric3x3Job
+{
+    GDALGeneric3x3Context<T>* psContext = nullptr;
+    int             nYStart = 0;
+    int             nYEnd = 0;
+    std::vector<float> afOutput{};
+    CPLErr          eErr = CE_None;
+    bool            bDone = false;
+};
+
+template<class T>
+static bool GDALGeneric3x3LineHasNoData( const GDALGeneric3x3Context<T>& sCtxt,
+                                         const T* pafLine )
+{
+    for( int iX = 0; iX < sCtxt.nXSize; iX++ )
+    {
+        if( std::numeric_limits<T>::is_integer )
+        {
+            if( pafLine[iX] == sCtxt.fSrcNoDataValue )
+                return true;
+        }
+        else if( sCtxt.bIsSrcNoDataNan )
+        {
+            if( CPLIsNan(static_cast<double>(pafLine[iX])) )
+                return true;
+        }
+        else if( ARE_REAL_EQUAL(pafLine[iX], sCtxt.fSrcNoDataValue) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// First line of the raster, extrapolated from the first two lines.
+template<class T>
+static void GDALGeneric3x3FirstLine( const GDALGeneric3x3Context<T>& sCtxt,
+                                     const T* pafLine1, const T* pafLine2,
+                                     float* pafOutputBuf )
+{
+    const int nXSize = sCtxt.nXSize;
+    const bool bSrcHasNoData = sCtxt.bSrcHasNoData;
+    const T fSrcNoDataValue = sCtxt.fSrcNoDataValue;
+    for( int j = 0; j < nXSize; j++ )
+    {
+        int jmin = (j == 0) ? j : j - 1;
+        int jmax = (j == nXSize - 1) ? j : j + 1;
+
+        T afWin[9] = {
+            INTERPOL(pafLine1[jmin], pafLine2[jmin],
+                     bSrcHasNoData, fSrcNoDataValue),
+            INTERPOL(pafLine1[j],    pafLine2[j],
+                     bSrcHasNoData, fSrcNoDataValue),
+            INTERPOL(pafLine1[jmax], pafLine2[jmax],
+                     bSrcHasNoData, fSrcNoDataValue),
+            pafLine1[jmin],
+            pafLine1[j],
+            pafLine1[jmax],
+            pafLine2[jmin],
+            pafLine2[j],
+            pafLine2[jmax]
+        };
+        pafOutputBuf[j] = ComputeVal(
+            bSrcHasNoData,
+            fSrcNoDataValue,
+            sCtxt.bIsSrcNoDataNan,
+            afWin, sCtxt.fDstNoDataValue,
+            sCtxt.pfnAlg, sCtxt.pData, sCtxt.bComputeAtEdges);
+    }
+}
+
+// Last line of the raster, extrapolated from the last two lines.
+template<class T>
+static void GDALGeneric3x3LastLine( const GDALGeneric3x3Context<T>& sCtxt,
+                                    const T* pafLine1, const T* pafLine2,
+                                    float* pafOutputBuf )
+{
+    const int nXSize = sCtxt.nXSize;
+    const bool bSrcHasNoData = sCtxt.bSrcHasNoData;
+    const T fSrcNoDataValue = sCtxt.fSrcNoDataValue;
+    for( int j = 0; j < nXSize; j++ )
+    {
+        int jmin = (j == 0) ? j : j - 1;
+        int jmax = (j == nXSize - 1) ? j : j + 1;
+
+        T afWin[9] = {
+            pafLine1[jmin],
+            pafLine1[j],
+            pafLine1[jmax],
+            pafLine2[jmin],
+            pafLine2[j],
+            pafLine2[jmax],
+            INTERPOL(pafLine2[jmin], pafLine1[jmin],
+                     bSrcHasNoData, fSrcNoDataValue),
+            INTERPOL(pafLine2[j],    pafLine1[j],
+                     bSrcHasNoData, fSrcNoDataValue),
+            INTERPOL(pafLine2[jmax], pafLine1[jmax],
+                     bSrcHasNoData, fSrcNoDataValue),
+        };
+
+        pafOutputBuf[j] = ComputeVal(
+            bSrcHasNoData,
+            fSrcNoDataValue,
+            sCtxt.bIsSrcNoDataNan,
+            afWin, sCtxt.fDstNoDataValue,
+            sCtxt.pfnAlg, sCtxt.pData, sCtxt.bComputeAtEdges);
+    }
+}
+
+// Line between the first and last lines of the raster. The three lines of
+// the window start at the given offsets of pafThreeLineWin.
+template<class T>
+static void GDALGeneric3x3Line( const GDALGeneric3x3Context<T>& sCtxt,
+                                const T* pafThreeLineWin,
+                                int nLine1Off, int nLine2Off, int nLine3Off,
+                                bool bOneOfThreeLinesHasNoData,
+                                float* pafOutputBuf )
+{
+    const int nXSize = sCtxt.nXSize;
+    const bool bSrcHasNoData = sCtxt.bSrcHasNoData;
+    const T fSrcNoDataValue = sCtxt.fSrcNoDataValue;
+    const bool bIsSrcNoDataNan = sCtxt.bIsSrcNoDataNan;
+    const float fDstNoDataValue = sCtxt.fDstNoDataValue;
+    const auto pfnAlg = sCtxt.pfnAlg;
+    void* pData = sCtxt.pData;
+    const bool bComputeAtEdges = sCtxt.bComputeAtEdges;
+
+    if( bComputeAtEdges && nXSize >= 2 )
+    {
+        int j = 0;
+        T afWin[9] = {
+            INTERPOL(pafThreeLineWin[nLine1Off + j],
+                     pafThreeLineWin[nLine1Off + j+1],
+                     bSrcHasNoData, fSrcNoDataValue),
+            pafThreeLineWin[nLine1Off + j],
+            pafThreeLineWin[nLine1Off + j+1],
+            INTERPOL(pafThreeLineWin[nLine2Off + j],
+                     pafThreeLineWin[nLine2Off + j+1],
+                     bSrcHasNoData, fSrcNoDataValue),
+            pafThreeLineWin[nLine2Off + j],
+            pafThreeLineWin[nLine2Off + j+1],
+            INTERPOL(pafThreeLineWin[nLine3Off + j],
+                     pafThreeLineWin[nLine3Off + j+1],
+                     bSrcHasNoData, fSrcNoDataValue),
+            pafThreeLineWin[nLine3Off + j],
+            pafThreeLineWin[nLine3Off + j+1]
+        };
+
+        pafOutputBuf[j] =
+            ComputeVal(
+                bOneOfThreeLinesHasNoData,
+                fSrcNoDataValue,
+                bIsSrcNoDataNan,
+                afWin, fDstNoDataValue,
+                pfnAlg, pData, bComputeAtEdges);
+    }
+    else
+    {
+        // Exclude the edges
+        pafOutputBuf[0] = fDstNoDataValue;
+    }
+
+    int j = 1;
+    if( sCtxt.pfnAlg_multisample && !bOneOfThreeLinesHasNoData )
+    {
+        j = sCtxt.pfnAlg_multisample(pafThreeLineWin,
+                                     nLine1Off,
+                                     nLine2Off,
+                                     nLine3Off,
+                                     nXSize,
+                                     pData,
+                                     pafOutputBuf);
+    }
+
+    for( ; j < nXSize - 1; j++ )
+    {
+        T afWin[9] = {
+            pafThreeLineWin[nLine1Off + j-1],
+            pafThreeLineWin[nLine1Off + j],
+            pafThreeLineWin[nLine1Off + j+1],
+            pafThreeLineWin[nLine2Off + j-1],
+            pafThreeLineWin[nLine2Off + j],
+            pafThreeLineWin[nLine2Off + j+1],
+            pafThreeLineWin[nLine3Off + j-1],
+            pafThreeLineWin[nLine3Off + j],
+            pafThreeLineWin[nLine3Off + j+1]
+        };
+
+        pafOutputBuf[j] =
+            ComputeVal(
+                bOneOfThreeLinesHasNoData,
+                fSrcNoDataValue,
+                bIsSrcNoDataNan,
+                afWin, fDstNoDataValue,
+                pfnAlg, pData, bComputeAtEdges);
+    }
+
+    if( bComputeAtEdges && nXSize >= 2 )
+    {
+        j = nXSize - 1;
+
+        T afWin[9] = {
+            pafThreeLineWin[nLine1Off + j-1],
+            pafThreeLineWin[nLine1Off + j],
+            INTERPOL(pafThreeLineWin[nLine1Off + j],
+                     pafThreeLineWin[nLine1Off + j-1],
+                     bSrcHasNoData, fSrcNoDataValue),
+            pafThreeLineWin[nLine2Off + j-1],
+            pafThreeLineWin[nLine2Off + j],
+            INTERPOL(pafThreeLineWin[nLine2Off + j],
+                     pafThreeLineWin[nLine2Off + j-1],
+                     bSrcHasNoData, fSrcNoDataValue),
+            pafThreeLineWin[nLine3Off + j-1],
+            pafThreeLineWin[nLine3Off + j],
+            INTERPOL(pafThreeLineWin[nLine3Off + j],
+                     pafThreeLineWin[nLine3Off + j-1],
+                     bSrcHasNoData, fSrcNoDataValue)
+        };
+
+        pafOutputBuf[j] =
+            ComputeVal(
+                bOneOfThreeLinesHasNoData,
+                fSrcNoDataValue,
+                bIsSrcNoDataNan,
+                afWin, fDstNoDataValue,
+                pfnAlg, pData, bComputeAtEdges);
+    }
+    else
+    {
+        // Exclude the edges
+        if( nXSize > 1 )
+            pafOutputBuf[nXSize - 1] = fDstNoDataValue;
+    }
+}
+
+template<class T>
+static CPLErr GDALGeneric3x3ComputeJob( GDALGeneric3x3Job<T>* psJob )
+{
+    const GDALGeneric3x3Context<T>& sCtxt = *(psJob->psContext);
+    const int nXSize = sCtxt.nXSize;
+    const int nYSize = sCtxt.nYSize;
+    const int nReadStart = std::max(0, psJob->nYStart - 1);
+    const int nReadEnd = std::min(nYSize, psJob->nYEnd + 1);
+    const int nReadLines = nReadEnd - nReadStart;
+
+    std::vector<T> afLines;
+    try
+    {
+        // A few extra values for the reads of the SSE2 code.
+        afLines.resize(static_cast<size_t>(nReadLines) * nXSize + 4);
+        psJob->afOutput.resize(
+            static_cast<size_t>(psJob->nYEnd - psJob->nYStart) * nXSize);
+    }
+    catch( const std::exception& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate buffers for lines %d to %d",
+                 psJob->nYStart, psJob->nYEnd - 1);
+        return CE_Failure;
+    }
+
+    {
+        std::lock_guard<std::mutex> oLock(psJob->psContext->oIOMutex);
+        if( GDALRasterIO( sCtxt.hSrcBand, GF_Read,
+                          0, nReadStart, nXSize, nReadLines,
+                          &afLines[0], nXSize, nReadLines,
+                          sCtxt.eReadDT, 0, 0 ) != CE_None )
+        {
+            return CE_Failure;
+        }
+    }
+
+    // In case none of the 3 lines have nodata values, then no need to
+    // check it in ComputeVal()
+    std::vector<bool> abLineHasNoDataValue(nReadLines, sCtxt.bSrcHasNoData);
+    if( sCtxt.bSrcHasNoData )
+    {
+        for( int i = 0; i < nReadLines; i++ )
+        {
+            abLineHasNoDataValue[i] = GDALGeneric3x3LineHasNoData(
+                sCtxt, &afLines[static_cast<size_t>(i) * nXSize]);
+        }
+    }
+
+    for( int i = psJob->nYStart; i < psJob->nYEnd; i++ )
+    {
+        float* pafOutputBuf = &psJob->afOutput[
+                        static_cast<size_t>(i - psJob->nYStart) * nXSize];
+        const int iLine = i - nReadStart;
+        if( i == 0 || i == nYSize - 1 )
+        {
+            if( sCtxt.bComputeAtEdges && nXSize >= 2 && nYSize >= 2 )
+            {
+                if( i == 0 )
+                    GDALGeneric3x3FirstLine(sCtxt,
+                        &afLines[0], &afLines[nXSize], pafOutputBuf);
+                else
+                    GDALGeneric3x3LastLine(sCtxt,
+                        &afLines[static_cast<size_t>(iLine - 1) * nXSize],
+                        &afLines[static_cast<size_t>(iLine) * nXSize],
+                        pafOutputBuf);
+            }
+            else
+            {
+                // Exclude the edges
+                for( int j = 0; j < nXSize; j++ )
+                    pafOutputBuf[j] = sCtxt.fDstNoDataValue;
+            }
+            continue;
+        }
+
+        GDALGeneric3x3Line(sCtxt, &afLines[0],
+                           (iLine - 1) * nXSize,
+                           iLine * nXSize,
+                           (iLine + 1) * nXSize,
+                           abLineHasNoDataValue[iLine - 1] ||
+                           abLineHasNoDataValue[iLine] ||
+                           abLineHasNoDataValue[iLine + 1],
+                           pafOutputBuf);
+    }
+    return CE_None;
+}
+
+template<class T>
+static void GDALGeneric3x3JobFunc( void* pData )
+{
+    GDALGeneric3x3Job<T>* psJob = static_cast<GDALGeneric3x3Job<T>*>(pData);
+    GDALGeneric3x3Context<T>* psContext = psJob->psContext;
+
+    bool bStop = false;
+    {
+        std::lock_guard<std::mutex> oLock(psContext->oMutex);
+        bStop = psContext->bStop;
+    }
+    const CPLErr eErr = bStop ? CE_Failure : GDALGeneric3x3ComputeJob(psJob);
+
+    std::lock_guard<std::mutex> oLock(psContext->oMutex);
+    psJob->eErr = eErr;
+    psJob->bDone = true;
+}
+
+// The output is computed by bands of lines, with several threads if
+// GDAL_NUM_THREADS is set, and written in order by the calling thread.
 template<class T>
 static
 CPLErr GDALGeneric3x3Processing(
@@ -305,29 +678,23 @@ CPLErr GDALGeneric3x3Processing(
     const int nXSize = GDALGetRasterBandXSize(hSrcBand);
     const int nYSize = GDALGetRasterBandYSize(hSrcBand);
 
-    // 1 line destination buffer.
-    float *pafOutputBuf = static_cast<float *>(
-        VSI_MALLOC2_VERBOSE(sizeof(float), nXSize));
-    // 3 line rotating source buffer.
-    T *pafThreeLineWin  = static_cast<T *>(
-        VSI_MALLOC2_VERBOSE(3 * sizeof(T), nXSize + 1));
-    if( pafOutputBuf == nullptr || pafThreeLineWin == nullptr )
-    {
-        VSIFree(pafOutputBuf);
-        VSIFree(pafThreeLineWin);
-        return CE_Failure;
-    }
+    GDALGeneric3x3Context<T> sContext;
+    sContext.hSrcBand = hSrcBand;
+    sContext.nXSize = nXSize;
+    sContext.nYSize = nYSize;
+    sContext.pfnAlg = pfnAlg;
+    sContext.pfnAlg_multisample = pfnAlg_multisample;
+    sContext.pData = pData;
+    sContext.bComputeAtEdges = bComputeAtEdges;
 
-    GDALDataType eReadDT;
     int bSrcHasNoData = FALSE;
     const double dfNoDataValue =
         GDALGetRasterNoDataValue(hSrcBand, &bSrcHasNoData);
 
-    int bIsSrcNoDataNan = FALSE;
     T fSrcNoDataValue = 0;
     if( std::numeric_limits<T>::is_integer )
     {
-        eReadDT = GDT_Int32;
+        sContext.eReadDT = GDT_Int32;
         if( bSrcHasNoData )
         {
             GDALDataType eSrcDT = GDALGetRasterDataType( hSrcBand );
@@ -354,20 +721,24 @@ CPLErr GDALGeneric3x3Processing(
     }
     else
     {
-        eReadDT = GDT_Float32;
+        sContext.eReadDT = GDT_Float32;
         fSrcNoDataValue = static_cast<T>(dfNoDataValue);
-        bIsSrcNoDataNan = bSrcHasNoData && CPLIsNan(dfNoDataValue);
+        sContext.bIsSrcNoDataNan = bSrcHasNoData && CPLIsNan(dfNoDataValue);
     }
+    sContext.bSrcHasNoData = CPL_TO_BOOL(bSrcHasNoData);
+    sContext.fSrcNoDataValue = fSrcNoDataValue;
 
     int bDstHasNoData = FALSE;
-    float fDstNoDataValue =
+    sContext.fDstNoDataValue =
         static_cast<float>(GDALGetRasterNoDataValue(hDstBand, &bDstHasNoData));
     if( !bDstHasNoData )
-        fDstNoDataValue = 0.0;
+        sContext.fDstNoDataValue = 0.0;
 
-    int nLine1Off = 0;
-    int nLine2Off = nXSize;
-    int nLine3Off = 2*nXSize;
+    if( nXSize == 0 || nYSize == 0 )
+    {
+        pfnProgress( 1.0, nullptr, pProgressData );
+        return CE_None;
+    }
 
     // Move a 3x3 pafWindow over each cell
     // (where the cell in question is #4)
@@ -376,347 +747,92 @@ CPLErr GDALGeneric3x3Processing(
     //      3 4 5
     //      6 7 8
 
-    /* Preload the first 2 lines */
-
-    bool abLineHasNoDataValue[3] = {
-        CPL_TO_BOOL(bSrcHasNoData),
-        CPL_TO_BOOL(bSrcHasNoData),
-        CPL_TO_BOOL(bSrcHasNoData)
-    };
-
-    // Create an extra scope for VC12 to ignore i.
+    const int nThreads = CPLGetNumThreads();
+    // Bands of at most 256 lines and around 32 MB.
+    const int nBandHeight = static_cast<int>(std::max(GIntBig(1),
+        std::min(GIntBig(256),
+                 GIntBig(32 * 1024 * 1024) /
+                    (static_cast<GIntBig>(sizeof(T) + sizeof(float)) *
+                     nXSize))));
+    const int nBandCount = (nYSize + nBandHeight - 1) / nBandHeight;
+    const int nMaxJobsInFlight = 2 * nThreads;
+
+    CPLWorkerThreadPool* poPool =
+        nThreads > 1 && nBandCount > 1 ?
+            CPLGetGlobalWorkerThreadPool(nThreads) : nullptr;
+    std::unique_ptr<CPLJobQueue> poJobQueue;
+    if( poPool )
+        poJobQueue = poPool->CreateJobQueue();
+    const bool bUsePool = poJobQueue != nullptr;
+
+    std::vector<std::unique_ptr<GDALGeneric3x3Job<T>>> apoJobs(nBandCount);
+    CPLErr eErr = CE_None;
+    int iNextJob = 0;
+    for( int iBand = 0; eErr == CE_None && iBand < nBandCount; iBand++ )
     {
-      for( int i = 0; i < 2 && i < nYSize; i++ )
-      {
-        if( GDALRasterIO( hSrcBand,
-                          GF_Read,
-                          0, i,
-                          nXSize, 1,
-                          pafThreeLineWin + i * nXSize,
-                          nXSize, 1,
-                          eReadDT,
-                          0, 0) != CE_None )
+        for( ; iNextJob < nBandCount &&
+               iNextJob < iBand + (bUsePool ? nMaxJobsInFlight : 1);
+             iNextJob++ )
         {
-            CPLFree(pafOutputBuf);
-            CPLFree(pafThreeLineWin);
-
-            return CE_Failure;
-        }
-        if( std::numeric_limits<T>::is_integer && bSrcHasNoData )
-        {
-            abLineHasNoDataValue[i] = false;
-            for( int iX = 0; iX < nXSize; iX++ )
+            apoJobs[iNextJob].reset(new GDALGeneric3x3Job<T>());
+            GDALGeneric3x3Job<T>* psNewJob = apoJobs[iNextJob].get();
+            psNewJob->psContext = &sContext;
+            psNewJob->nYStart = iNextJob * nBandHeight;
+            psNewJob->nYEnd = std::min(nYSize, psNewJob->nYStart + nBandHeight);
+            if( !bUsePool ||
+                !poJobQueue->SubmitJob(GDALGeneric3x3JobFunc<T>, psNewJob) )
             {
-                if( pafThreeLineWin[i * nXSize + iX] == fSrcNoDataValue )
-                {
-                    abLineHasNoDataValue[i] = true;
-                    break;
-                }
+                GDALGeneric3x3JobFunc<T>(psNewJob);
             }
         }
-      }
-    }  // End extra scope for VC12
-
-    CPLErr eErr = CE_None;
-    if( bComputeAtEdges && nXSize >= 2 && nYSize >= 2 )
-    {
-        for( int j = 0; j < nXSize; j++ )
-        {
-            int jmin = (j == 0) ? j : j - 1;
-            int jmax = (j == nXSize - 1) ? j : j + 1;
-
-            T afWin[9] = {
-                INTERPOL(pafThreeLineWin[jmin], pafThreeLineWin[nXSize + jmin],
-                         bSrcHasNoData, fSrcNoDataValue),
-                INTERPOL(pafThreeLineWin[j],    pafThreeLineWin[nXSize + j],
-                         bSrcHasNoData, fSrcNoDataValue),
-                INTERPOL(pafThreeLineWin[jmax], pafThreeLineWin[nXSize + jmax],
-                         bSrcHasNoData, fSrcNoDataValue),
-                pafThreeLineWin[jmin],
-                pafThreeLineWin[j],
-                pafThreeLineWin[jmax],
-                pafThreeLineWin[nXSize + jmin],
-                pafThreeLineWin[nXSize + j],
-                pafThreeLineWin[nXSize + jmax]
-            };
-            pafOutputBuf[j] = ComputeVal(
-                CPL_TO_BOOL(bSrcHasNoData),
-                fSrcNoDataValue,
-                CPL_TO_BOOL(bIsSrcNoDataNan),
-                afWin, fDstNoDataValue,
-                pfnAlg, pData, bComputeAtEdges);
-        }
-        eErr = GDALRasterIO(hDstBand, GF_Write,
-                    0, 0, nXSize, 1,
-                    pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
-    }
-    else
-    {
-        // Exclude the edges
-        for( int j = 0; j < nXSize; j++ )
-        {
-            pafOutputBuf[j] = fDstNoDataValue;
-        }
-        eErr = GDALRasterIO(hDstBand, GF_Write,
-                    0, 0, nXSize, 1,
-                    pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
 
-        if( eErr == CE_None && nYSize > 1 )
+        GDALGeneric3x3Job<T>* psJob = apoJobs[iBand].get();
         {
-            eErr = GDALRasterIO(hDstBand, GF_Write,
-                        0, nYSize - 1, nXSize, 1,
-                        pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
-        }
-    }
-    if( eErr != CE_None )
-    {
-        CPLFree(pafOutputBuf);
-        CPLFree(pafThreeLineWin);
-
-        return eErr;
-    }
-
-    int i = 1;  // Used after for.
-    for( ; i < nYSize-1; i++ )
-    {
-        /* Read third line of the line buffer */
-        eErr = GDALRasterIO(   hSrcBand,
-                        GF_Read,
-                        0, i+1,
-                        nXSize, 1,
-                        pafThreeLineWin + nLine3Off,
-                        nXSize, 1,
-                        eReadDT,
-                        0, 0);
-        if( eErr != CE_None )
-        {
-            CPLFree(pafOutputBuf);
-            CPLFree(pafThreeLineWin);
-
-            return eErr;
-        }
-
-        // In case none of the 3 lines have nodata values, then no need to
-        // check it in ComputeVal()
-        bool bOneOfThreeLinesHasNoData = CPL_TO_BOOL(bSrcHasNoData);
-        if( std::numeric_limits<T>::is_integer && bSrcHasNoData )
-        {
-            bool bLastLineHasNoDataValue = false;
-            int iX = 0;
-            for( ; iX + 3 < nXSize; iX +=4 )
+            // Wait until the jobs still running are the later ones; a
+            // worker thread runs queued jobs meanwhile.
+            std::unique_lock<std::mutex> oLock(sContext.oMutex);
+            while( !psJob->bDone )
             {
-                if( pafThreeLineWin[nLine3Off + iX] == fSrcNoDataValue ||
-                    pafThreeLineWin[nLine3Off + iX + 1] == fSrcNoDataValue ||
-                    pafThreeLineWin[nLine3Off + iX + 2] == fSrcNoDataValue ||
-                    pafThreeLineWin[nLine3Off + iX + 3] == fSrcNoDataValue )
+                int nLaterJobs = 0;
+                for( int i = iBand + 1; i < iNextJob; i++ )
                 {
-                    bLastLineHasNoDataValue = true;
-                    break;
+                    if( !apoJobs[i]->bDone )
+                        nLaterJobs++;
                 }
+                oLock.unlock();
+                poJobQueue->WaitCompletion(nLaterJobs);
+                oLock.lock();
             }
-            if( !bLastLineHasNoDataValue )
-            {
-                for( ; iX < nXSize; iX++ )
-                {
-                    if( pafThreeLineWin[nLine3Off + iX] == fSrcNoDataValue )
-                    {
-                        bLastLineHasNoDataValue = true;
-                    }
-                }
-            }
-            abLineHasNoDataValue[nLine3Off / nXSize] = bLastLineHasNoDataValue;
-
-            bOneOfThreeLinesHasNoData = abLineHasNoDataValue[0] ||
-                                abLineHasNoDataValue[1] ||
-                                abLineHasNoDataValue[2];
-        }
-
-        if( bComputeAtEdges && nXSize >= 2 )
-        {
-            int j = 0;
-            T afWin[9] = {
-                INTERPOL(pafThreeLineWin[nLine1Off + j],
-                         pafThreeLineWin[nLine1Off + j+1],
-                         bSrcHasNoData, fSrcNoDataValue),
-                pafThreeLineWin[nLine1Off + j],
-                pafThreeLineWin[nLine1Off + j+1],
-                INTERPOL(pafThreeLineWin[nLine2Off + j],
-                         pafThreeLineWin[nLine2Off + j+1],
-                         bSrcHasNoData, fSrcNoDataValue),
-                pafThreeLineWin[nLine2Off + j],
-                pafThreeLineWin[nLine2Off + j+1],
-                INTERPOL(pafThreeLineWin[nLine3Off + j],
-                         pafThreeLineWin[nLine3Off + j+1],
-                         bSrcHasNoData, fSrcNoDataValue),
-                pafThreeLineWin[nLine3Off + j],
-                pafThreeLineWin[nLine3Off + j+1]
-            };
-
-            pafOutputBuf[j] =
-                ComputeVal(
-                    CPL_TO_BOOL(bOneOfThreeLinesHasNoData),
-                    fSrcNoDataValue,
-                    CPL_TO_BOOL(bIsSrcNoDataNan),
-                    afWin, fDstNoDataValue,
-                    pfnAlg, pData, bComputeAtEdges);
-        }
-        else
-        {
-            // Exclude the edges
-            pafOutputBuf[0] = fDstNoDataValue;
-        }
-
-        int j = 1;
-        if( pfnAlg_multisample && !bOneOfThreeLinesHasNoData )
-        {
-            j = pfnAlg_multisample(pafThreeLineWin,
-                                   nLine1Off,
-                                   nLine2Off,
-                                   nLine3Off,
-                                   nXSize,
-                                   pData,
-                                   pafOutputBuf);
-        }
-
-        for( ; j < nXSize - 1; j++ )
-        {
-            T afWin[9] = {
-                pafThreeLineWin[nLine1Off + j-1],
-                pafThreeLineWin[nLine1Off + j],
-                pafThreeLineWin[nLine1Off + j+1],
-                pafThreeLineWin[nLine2Off + j-1],
-                pafThreeLineWin[nLine2Off + j],
-                pafThreeLineWin[nLine2Off + j+1],
-                pafThreeLineWin[nLine3Off + j-1],
-                pafThreeLineWin[nLine3Off + j],
-                pafThreeLineWin[nLine3Off + j+1]
-            };
-
-            pafOutputBuf[j] =
-                ComputeVal(
-                    CPL_TO_BOOL(bOneOfThreeLinesHasNoData),
-                    fSrcNoDataValue,
-                    CPL_TO_BOOL(bIsSrcNoDataNan),
-                    afWin, fDstNoDataValue,
-                    pfnAlg, pData, bComputeAtEdges);
-        }
-
-        if( bComputeAtEdges && nXSize >= 2 )
-        {
-            j = nXSize - 1;
-
-            T afWin[9] = {
-                pafThreeLineWin[nLine1Off + j-1],
-                pafThreeLineWin[nLine1Off + j],
-                INTERPOL(pafThreeLineWin[nLine1Off + j],
-                         pafThreeLineWin[nLine1Off + j-1],
-                         bSrcHasNoData, fSrcNoDataValue),
-                pafThreeLineWin[nLine2Off + j-1],
-                pafThreeLineWin[nLine2Off + j],
-                INTERPOL(pafThreeLineWin[nLine2Off + j],
-                         pafThreeLineWin[nLine2Off + j-1],
-                         bSrcHasNoData, fSrcNoDataValue),
-                pafThreeLineWin[nLine3Off + j-1],
-                pafThreeLineWin[nLine3Off + j],
-                INTERPOL(pafThreeLineWin[nLine3Off + j],
-                         pafThreeLineWin[nLine3Off + j-1],
-                         bSrcHasNoData, fSrcNoDataValue)
-            };
-
-            pafOutputBuf[j] =
-                ComputeVal(
-                    CPL_TO_BOOL(bOneOfThreeLinesHasNoData),
-                    fSrcNoDataValue,
-                    CPL_TO_BOOL(bIsSrcNoDataNan),
-                    afWin, fDstNoDataValue,
-                    pfnAlg, pData, bComputeAtEdges);
-        }
-        else
-        {
-            // Exclude the edges
-            if( nXSize > 1 )
-                pafOutputBuf[nXSize - 1] = fDstNoDataValue;
         }
 
-        /* -----------------------------------------
-         * Write Line to Raster
-         */
-        eErr = GDALRasterIO(hDstBand, GF_Write, 0, i, nXSize, 1,
-                            pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
-        if( eErr != CE_None )
+        eErr = psJob->eErr;
+        if( eErr == CE_None )
         {
-            CPLFree(pafOutputBuf);
-            CPLFree(pafThreeLineWin);
-
-            return eErr;
+            /* -----------------------------------------
+             * Write Lines to Raster
+             */
+            const int nLines = psJob->nYEnd - psJob->nYStart;
+            eErr = GDALRasterIO(hDstBand, GF_Write,
+                                0, psJob->nYStart, nXSize, nLines,
+                                &psJob->afOutput[0], nXSize, nLines,
+                                GDT_Float32, 0, 0);
         }
-
-        if( !pfnProgress( 1.0 * (i+1) / nYSize, nullptr, pProgressData ) )
+        if( eErr == CE_None &&
+            !pfnProgress( 1.0 * psJob->nYEnd / nYSize, nullptr, pProgressData ) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
             eErr = CE_Failure;
-
-            CPLFree(pafOutputBuf);
-            CPLFree(pafThreeLineWin);
-
-            return eErr;
         }
-
-        const int nTemp = nLine1Off;
-        nLine1Off = nLine2Off;
-        nLine2Off = nLine3Off;
-        nLine3Off = nTemp;
+        apoJobs[iBand].reset();
     }
 
-    if( bComputeAtEdges && nXSize >= 2 && nYSize >= 2 )
+    if( eErr != CE_None )
     {
-        for( int j = 0; j < nXSize; j++ )
-        {
-            int jmin = (j == 0) ? j : j - 1;
-            int jmax = (j == nXSize - 1) ? j : j + 1;
-
-            T afWin[9] = {
-                pafThreeLineWin[nLine1Off + jmin],
-                pafThreeLineWin[nLine1Off + j],
-                pafThreeLineWin[nLine1Off + jmax],
-                pafThreeLineWin[nLine2Off + jmin],
-                pafThreeLineWin[nLine2Off + j],
-                pafThreeLineWin[nLine2Off + jmax],
-                INTERPOL(pafThreeLineWin[nLine2Off + jmin],
-                         pafThreeLineWin[nLine1Off + jmin],
-                         bSrcHasNoData, fSrcNoDataValue),
-                INTERPOL(pafThreeLineWin[nLine2Off + j],
-                         pafThreeLineWin[nLine1Off + j],
-                         bSrcHasNoData, fSrcNoDataValue),
-                INTERPOL(pafThreeLineWin[nLine2Off + jmax],
-                         pafThreeLineWin[nLine1Off + jmax],
-                         bSrcHasNoData, fSrcNoDataValue),
-            };
-
-            pafOutputBuf[j] = ComputeVal(
-                CPL_TO_BOOL(bSrcHasNoData),
-                fSrcNoDataValue,
-                CPL_TO_BOOL(bIsSrcNoDataNan),
-                afWin, fDstNoDataValue,
-                pfnAlg, pData, bComputeAtEdges);
-        }
-        eErr = GDALRasterIO(hDstBand, GF_Write,
-                            0, i, nXSize, 1,
-                            pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
-        if( eErr != CE_None )
-        {
-            CPLFree(pafOutputBuf);
-            CPLFree(pafThreeLineWin);
-
-            return eErr;
-        }
+        std::lock_guard<std::mutex> oLock(sContext.oMutex);
+        sContext.bStop = true;
     }
-
-    pfnProgress( 1.0, nullptr, pProgressData );
-    eErr = CE_None;
-
-    CPLFree(pafOutputBuf);
-    CPLFree(pafThreeLineWin);
+    if( bUsePool )
+        poJobQueue->WaitCompletion();
 
     return eErr;
 }
@@ -1106,6 +1222,203 @@ int GDALHillshadeAlg_same_res_multisample( const T* pafThreeLineWin,
 }
 #endif
 
+#ifdef HAVE_16_SSE_REG
+
+/* -------------------------------------------------------------------- */
+/*      SSE2 helpers for the Float32 multisample algorithms. They do    */
+/*      the same operations, in the same order, as the scalar code, so  */
+/*      that the results are identical.                                 */
+/* -------------------------------------------------------------------- */
+
+// Loads the 3x3 windows of the 4 pixels starting at j.
+static inline void GDALLoadWindows4( const float* pafThreeLineWin,
+                                     int nLine1Off, int nLine2Off,
+                                     int nLine3Off, int j, __m128 aWin[9] )
+{
+    const float* firstLine  = pafThreeLineWin + nLine1Off + j-1;
+    const float* secondLine = pafThreeLineWin + nLine2Off + j-1;
+    const float* thirdLine  = pafThreeLineWin + nLine3Off + j-1;
+    for( int k = 0; k < 3; k++ )
+    {
+        aWin[k] = _mm_loadu_ps(firstLine + k);
+        aWin[3 + k] = _mm_loadu_ps(secondLine + k);
+        aWin[6 + k] = _mm_loadu_ps(thirdLine + k);
+    }
+}
+
+// Float32 parts of the gradients of Gradient<float, alg>::calc(), before
+// their multiplication by the inverse of the resolution.
+template<GradientAlg alg>
+static inline void GDALGradient4( const __m128 aWin[9],
+                                  __m128& x, __m128& y )
+{
+    if( alg == HORN )
+    {
+        x = _mm_sub_ps(
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(aWin[0], aWin[3]), aWin[3]),
+                       aWin[6]),
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(aWin[2], aWin[5]), aWin[5]),
+                       aWin[8]));
+        y = _mm_sub_ps(
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(aWin[6], aWin[7]), aWin[7]),
+                       aWin[8]),
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(aWin[0], aWin[1]), aWin[1]),
+                       aWin[2]));
+    }
+    else // ZEVENBERGEN_THORNE
+    {
+        x = _mm_sub_ps(aWin[3], aWin[5]);
+        y = _mm_sub_ps(aWin[7], aWin[1]);
+    }
+}
+
+// Converts the low and high halves of a Float32 register to Float64.
+static inline __m128d GDALLowToDouble( __m128 v )
+{
+    return _mm_cvtps_pd(v);
+}
+
+static inline __m128d GDALHighToDouble( __m128 v )
+{
+    return _mm_cvtps_pd(_mm_movehl_ps(v, v));
+}
+
+static inline __m128 GDALToFloat( __m128d lo, __m128d hi )
+{
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+// Same as ApproxADivByInvSqrtB()
+static inline __m128d GDALApproxADivByInvSqrtB( __m128d a, __m128d b )
+{
+    const __m128d reg_half = _mm_set1_pd(0.5);
+    const __m128d regB_half = _mm_mul_pd(b, reg_half);
+    // Compute rough approximation of 1 / sqrt(b) with _mm_rsqrt_ps
+    __m128d regB = _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(b)));
+    // And perform one step of Newton-Raphson approximation to improve it
+    regB = _mm_mul_pd(regB, _mm_sub_pd(_mm_set1_pd(1.5),
+                                       _mm_mul_pd(regB_half,
+                                                  _mm_mul_pd(regB, regB))));
+    return _mm_mul_pd(a, regB);
+}
+
+// Same as GDALHillshadeAlg<float, alg>()
+static inline __m128d GDALHillshade2( const GDALHillshadeAlgData* psData,
+                                      __m128d x, __m128d y )
+{
+    const __m128d xx_plus_yy = _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y));
+    const __m128d cang_mul_254 = GDALApproxADivByInvSqrtB(
+        _mm_sub_pd(_mm_set1_pd(psData->sin_altRadians_mul_254),
+                   _mm_sub_pd(
+                     _mm_mul_pd(y, _mm_set1_pd(
+                         psData->cos_az_mul_cos_alt_mul_z_mul_254)),
+                     _mm_mul_pd(x, _mm_set1_pd(
+                         psData->sin_az_mul_cos_alt_mul_z_mul_254)))),
+        _mm_add_pd(_mm_set1_pd(1.0),
+                   _mm_mul_pd(_mm_set1_pd(psData->square_z), xx_plus_yy)));
+    // cang_mul_254 <= 0.0 ? 1.0 : 1.0 + cang_mul_254, NaN being kept.
+    const __m128d reg_one = _mm_set1_pd(1.0);
+    return _mm_max_pd(reg_one, _mm_add_pd(reg_one, cang_mul_254));
+}
+
+template<GradientAlg alg>
+static
+int GDALHillshadeAlg_multisample_float( const float* pafThreeLineWin,
+                                        int nLine1Off,
+                                        int nLine2Off,
+                                        int nLine3Off,
+                                        int nXSize,
+                                        void* pData,
+                                        float* pafOutputBuf )
+{
+    const GDALHillshadeAlgData* psData =
+        static_cast<const GDALHillshadeAlgData*>(pData);
+    const __m128d reg_inv_ewres = _mm_set1_pd(psData->inv_ewres);
+    const __m128d reg_inv_nsres = _mm_set1_pd(psData->inv_nsres);
+
+    int j = 1;  // Used after for.
+    for( ; j < nXSize - 4; j += 4 )
+    {
+        __m128 aWin[9];
+        GDALLoadWindows4(pafThreeLineWin, nLine1Off, nLine2Off, nLine3Off,
+                         j, aWin);
+        __m128 x, y;
+        GDALGradient4<alg>(aWin, x, y);
+        const __m128d res0 = GDALHillshade2(psData,
+            _mm_mul_pd(GDALLowToDouble(x), reg_inv_ewres),
+            _mm_mul_pd(GDALLowToDouble(y), reg_inv_nsres));
+        const __m128d res1 = GDALHillshade2(psData,
+            _mm_mul_pd(GDALHighToDouble(x), reg_inv_ewres),
+            _mm_mul_pd(GDALHighToDouble(y), reg_inv_nsres));
+        _mm_storeu_ps(pafOutputBuf + j, GDALToFloat(res0, res1));
+    }
+    return j;
+}
+
+// Same as GDALHillshadeAlg_same_res<float>()
+static
+int GDALHillshadeAlg_same_res_multisample_float( const float* pafThreeLineWin,
+                                                 int nLine1Off,
+                                                 int nLine2Off,
+                                                 int nLine3Off,
+                                                 int nXSize,
+                                                 void* pData,
+                                                 float* pafOutputBuf )
+{
+    const GDALHillshadeAlgData* psData =
+        static_cast<const GDALHillshadeAlgData*>(pData);
+    const __m128d reg_fact_x =
+        _mm_set1_pd(psData->sin_az_mul_cos_alt_mul_z_mul_254_mul_inv_res);
+    const __m128d reg_fact_y =
+        _mm_set1_pd(psData->cos_az_mul_cos_alt_mul_z_mul_254_mul_inv_res);
+    const __m128d reg_constant_num =
+        _mm_set1_pd(psData->sin_altRadians_mul_254);
+    const __m128d reg_constant_denom =
+        _mm_set1_pd(psData->square_z_mul_square_inv_res);
+    const __m128d reg_one = _mm_set1_pd(1.0);
+
+    int j = 1;  // Used after for.
+    for( ; j < nXSize - 4; j += 4 )
+    {
+        __m128 aWin[9];
+        GDALLoadWindows4(pafThreeLineWin, nLine1Off, nLine2Off, nLine3Off,
+                         j, aWin);
+        __m128 accX = _mm_sub_ps(aWin[0], aWin[8]);
+        const __m128 six_minus_two = _mm_sub_ps(aWin[6], aWin[2]);
+        __m128 accY = accX;
+        const __m128 three_minus_five = _mm_sub_ps(aWin[3], aWin[5]);
+        const __m128 one_minus_seven = _mm_sub_ps(aWin[1], aWin[7]);
+        accX = _mm_add_ps(accX, three_minus_five);
+        accY = _mm_add_ps(accY, one_minus_seven);
+        accX = _mm_add_ps(accX, three_minus_five);
+        accY = _mm_add_ps(accY, one_minus_seven);
+        accX = _mm_add_ps(accX, six_minus_two);
+        accY = _mm_sub_ps(accY, six_minus_two);
+
+        __m128d res[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m128d x = k == 0 ? GDALLowToDouble(accX) :
+                                       GDALHighToDouble(accX);
+            const __m128d y = k == 0 ? GDALLowToDouble(accY) :
+                                       GDALHighToDouble(accY);
+            const __m128d xx_plus_yy =
+                _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y));
+            const __m128d cang_mul_254 = GDALApproxADivByInvSqrtB(
+                _mm_add_pd(reg_constant_num,
+                           _mm_add_pd(_mm_mul_pd(x, reg_fact_x),
+                                      _mm_mul_pd(y, reg_fact_y))),
+                _mm_add_pd(reg_one,
+                           _mm_mul_pd(reg_constant_denom, xx_plus_yy)));
+            res[k] = _mm_max_pd(reg_one, _mm_add_pd(reg_one, cang_mul_254));
+        }
+        _mm_storeu_ps(pafOutputBuf + j, GDALToFloat(res[0], res[1]));
+    }
+    return j;
+}
+
+#endif // HAVE_16_SSE_REG
+
 static const double INV_SQUARE_OF_HALF_PI = 1.0 / ((M_PI*M_PI)/4);
 
 template<class T, GradientAlg alg>
@@ -1263,6 +1576,95 @@ float GDALHillshadeMultiDirectionalAlg (const T* afWin,
     return static_cast<float>(cang);
 }
 
+#ifdef HAVE_16_SSE_REG
+// Same as GDALHillshadeMultiDirectionalAlg<float, alg>()
+template<GradientAlg alg>
+static
+int GDALHillshadeMultiDirectionalAlg_multisample_float(
+                                        const float* pafThreeLineWin,
+                                        int nLine1Off,
+                                        int nLine2Off,
+                                        int nLine3Off,
+                                        int nXSize,
+                                        void* pData,
+                                        float* pafOutputBuf )
+{
+    const GDALHillshadeMultiDirectionalAlgData* psData =
+            static_cast<const GDALHillshadeMultiDirectionalAlgData*>(pData);
+    const __m128d reg_inv_ewres = _mm_set1_pd(psData->inv_ewres);
+    const __m128d reg_inv_nsres = _mm_set1_pd(psData->inv_nsres);
+    const __m128d reg_sin127 = _mm_set1_pd(psData->sin_altRadians_mul_127);
+    const __m128d reg_cos127 = _mm_set1_pd(psData->cos_alt_mul_z_mul_127);
+    const __m128d reg_cos225_127 =
+        _mm_set1_pd(psData->cos225_az_mul_cos_alt_mul_z_mul_127);
+    const __m128d reg_square_z = _mm_set1_pd(psData->square_z);
+    const __m128d reg_flat =
+        _mm_set1_pd(1.0 + psData->sin_altRadians_mul_254);
+    const __m128d reg_zero = _mm_setzero_pd();
+    const __m128d reg_half = _mm_set1_pd(0.5);
+    const __m128d reg_one = _mm_set1_pd(1.0);
+
+    // val <= 0.0 ? 0.0 : val
+    const auto Clamp = [reg_zero](__m128d val)
+        { return _mm_andnot_pd(_mm_cmple_pd(val, reg_zero), val); };
+
+    int j = 1;  // Used after for.
+    for( ; j < nXSize - 4; j += 4 )
+    {
+        __m128 aWin[9];
+        GDALLoadWindows4(pafThreeLineWin, nLine1Off, nLine2Off, nLine3Off,
+                         j, aWin);
+        __m128 fx, fy;
+        GDALGradient4<alg>(aWin, fx, fy);
+
+        __m128d res[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m128d x = _mm_mul_pd(
+                k == 0 ? GDALLowToDouble(fx) : GDALHighToDouble(fx),
+                reg_inv_ewres);
+            const __m128d y = _mm_mul_pd(
+                k == 0 ? GDALLowToDouble(fy) : GDALHighToDouble(fy),
+                reg_inv_nsres);
+            const __m128d xx = _mm_mul_pd(x, x);
+            const __m128d yy = _mm_mul_pd(y, y);
+            const __m128d xx_plus_yy = _mm_add_pd(xx, yy);
+
+            const __m128d val225_mul_127 = Clamp(_mm_add_pd(reg_sin127,
+                _mm_mul_pd(_mm_sub_pd(x, y), reg_cos225_127)));
+            const __m128d val270_mul_127 = Clamp(_mm_sub_pd(reg_sin127,
+                _mm_mul_pd(x, reg_cos127)));
+            const __m128d val315_mul_127 = Clamp(_mm_add_pd(reg_sin127,
+                _mm_mul_pd(_mm_add_pd(x, y), reg_cos225_127)));
+            const __m128d val360_mul_127 = Clamp(_mm_sub_pd(reg_sin127,
+                _mm_mul_pd(y, reg_cos127)));
+
+            const __m128d weight_225 = _mm_sub_pd(
+                _mm_mul_pd(reg_half, xx_plus_yy), _mm_mul_pd(x, y));
+            const __m128d weight_270 = xx;
+            const __m128d weight_315 = _mm_sub_pd(xx_plus_yy, weight_225);
+            const __m128d weight_360 = yy;
+            const __m128d sum = _mm_add_pd(_mm_add_pd(_mm_add_pd(
+                _mm_mul_pd(weight_225, val225_mul_127),
+                _mm_mul_pd(weight_270, val270_mul_127)),
+                _mm_mul_pd(weight_315, val315_mul_127)),
+                _mm_mul_pd(weight_360, val360_mul_127));
+            const __m128d cang_mul_127 = GDALApproxADivByInvSqrtB(
+                _mm_div_pd(sum, xx_plus_yy),
+                _mm_add_pd(reg_one, _mm_mul_pd(reg_square_z, xx_plus_yy)));
+            const __m128d cang = _mm_add_pd(reg_one, cang_mul_127);
+
+            // Flat areas.
+            const __m128d mask_flat = _mm_cmpeq_pd(xx_plus_yy, reg_zero);
+            res[k] = _mm_or_pd(_mm_and_pd(mask_flat, reg_flat),
+                               _mm_andnot_pd(mask_flat, cang));
+        }
+        _mm_storeu_ps(pafOutputBuf + j, GDALToFloat(res[0], res[1]));
+    }
+    return j;
+}
+#endif // HAVE_16_SSE_REG
+
 static
 void* GDALCreateHillshadeMultiDirectionalData( double* adfGeoTransform,
                                                double z,
@@ -1342,6 +1744,58 @@ float GDALSlopeZevenbergenThorneAlg( const T* afWin,
     return static_cast<float>(100*(sqrt(key) / (2*psData->scale)));
 }
 
+#ifdef HAVE_16_SSE_REG
+// Same as GDALSlopeHornAlg<float>() and GDALSlopeZevenbergenThorneAlg<float>()
+// for slopes in percent. There is no SSE2 arc tangent for the slopes in
+// degrees.
+template<GradientAlg alg>
+static
+int GDALSlopePercentAlg_multisample_float( const float* pafThreeLineWin,
+                                           int nLine1Off,
+                                           int nLine2Off,
+                                           int nLine3Off,
+                                           int nXSize,
+                                           void* pData,
+                                           float* pafOutputBuf )
+{
+    const GDALSlopeAlgData* psData = static_cast<const GDALSlopeAlgData*>(pData);
+    const __m128d reg_ewres = _mm_set1_pd(psData->ewres);
+    const __m128d reg_nsres = _mm_set1_pd(psData->nsres);
+    const __m128d reg_denom =
+        _mm_set1_pd((alg == HORN ? 8 : 2) * psData->scale);
+    const __m128d reg_hundred = _mm_set1_pd(100.0);
+
+    int j = 1;  // Used after for.
+    for( ; j < nXSize - 4; j += 4 )
+    {
+        __m128 aWin[9];
+        GDALLoadWindows4(pafThreeLineWin, nLine1Off, nLine2Off, nLine3Off,
+                         j, aWin);
+        __m128 fx, fy;
+        // GDALSlopeZevenbergenThorneAlg() and GDALSlopeHornAlg() use the
+        // same sums as Gradient.
+        GDALGradient4<alg>(aWin, fx, fy);
+
+        __m128d res[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m128d dx = _mm_div_pd(
+                k == 0 ? GDALLowToDouble(fx) : GDALHighToDouble(fx),
+                reg_ewres);
+            const __m128d dy = _mm_div_pd(
+                k == 0 ? GDALLowToDouble(fy) : GDALHighToDouble(fy),
+                reg_nsres);
+            const __m128d key = _mm_add_pd(_mm_mul_pd(dx, dx),
+                                           _mm_mul_pd(dy, dy));
+            res[k] = _mm_mul_pd(reg_hundred,
+                                _mm_div_pd(_mm_sqrt_pd(key), reg_denom));
+        }
+        _mm_storeu_ps(pafOutputBuf + j, GDALToFloat(res[0], res[1]));
+    }
+    return j;
+}
+#endif // HAVE_16_SSE_REG
+
 static
 void* GDALCreateSlopeData( double* adfGeoTransform,
                            double scale,
@@ -3490,6 +3944,7 @@ GDALDatasetH GDALDEMProcessing( const char *pszDest,
     void* pData = nullptr;
     GDALGeneric3x3ProcessingAlg<float>::type pfnAlgFloat = nullptr;
     GDALGeneric3x3ProcessingAlg<GInt32>::type pfnAlgInt32 = nullptr;
+    GDALGeneric3x3ProcessingAlg_multisample<float>::type pfnAlgFloat_multisample = nullptr;
     GDALGeneric3x3ProcessingAlg_multisample<GInt32>::type pfnAlgInt32_multisample = nullptr;
 
     if( eUtilityMode == HILL_SHADE && psOptions->bMultiDirectional )
@@ -3505,11 +3960,19 @@ GDALDatasetH GDALDEMProcessing( const char *pszDest,
         {
             pfnAlgFloat = GDALHillshadeMultiDirectionalAlg<float, ZEVENBERGEN_THORNE>;
             pfnAlgInt32 = GDALHillshadeMultiDirectionalAlg<GInt32, ZEVENBERGEN_THORNE>;
+#ifdef HAVE_16_SSE_REG
+            pfnAlgFloat_multisample =
+                GDALHillshadeMultiDirectionalAlg_multisample_float<ZEVENBERGEN_THORNE>;
+#endif
         }
         else
         {
             pfnAlgFloat = GDALHillshadeMultiDirectionalAlg<float, HORN>;
             pfnAlgInt32 = GDALHillshadeMultiDirectionalAlg<GInt32, HORN>;
+#ifdef HAVE_16_SSE_REG
+            pfnAlgFloat_multisample =
+                GDALHillshadeMultiDirectionalAlg_multisample_float<HORN>;
+#endif
         }
     }
     else if( eUtilityMode == HILL_SHADE )
@@ -3538,6 +4001,10 @@ GDALDatasetH GDALDEMProcessing( const char *pszDest,
             {
                 pfnAlgFloat = GDALHillshadeAlg<float, ZEVENBERGEN_THORNE>;
                 pfnAlgInt32 = GDALHillshadeAlg<GInt32, ZEVENBERGEN_THORNE>;
+#ifdef HAVE_16_SSE_REG
+                pfnAlgFloat_multisample =
+                    GDALHillshadeAlg_multisample_float<ZEVENBERGEN_THORNE>;
+#endif
             }
         }
         else
@@ -3559,6 +4026,8 @@ GDALDatasetH GDALDEMProcessing( const char *pszDest,
                     pfnAlgFloat = GDALHillshadeAlg_same_res<float>;
                     pfnAlgInt32 = GDALHillshadeAlg_same_res<GInt32>;
 #ifdef HAVE_16_SSE_REG
+                    pfnAlgFloat_multisample =
+                                GDALHillshadeAlg_same_res_multisample_float;
                     pfnAlgInt32_multisample =
                                 GDALHillshadeAlg_same_res_multisample<GInt32>;
 #endif
@@ -3567,6 +4036,10 @@ GDALDatasetH GDALDEMProcessing( const char *pszDest,
                 {
                     pfnAlgFloat = GDALHillshadeAlg<float, HORN>;
                     pfnAlgInt32 = GDALHillshadeAlg<GInt32, HORN>;
+#ifdef HAVE_16_SSE_REG
+                    pfnAlgFloat_multisample =
+                                GDALHillshadeAlg_multisample_float<HORN>;
+#endif
                 }
             }
         }
@@ -3581,11 +4054,21 @@ GDALDatasetH GDALDEMProcessing( const char *pszDest,
         {
             pfnAlgFloat = GDALSlopeZevenbergenThorneAlg<float>;
             pfnAlgInt32 = GDALSlopeZevenbergenThorneAlg<GInt32>;
+#ifdef HAVE_16_SSE_REG
+            if( psOptions->slopeFormat != 1 )
+                pfnAlgFloat_multisample =
+                    GDALSlopePercentAlg_multisample_float<ZEVENBERGEN_THORNE>;
+#endif
         }
         else
         {
             pfnAlgFloat = GDALSlopeHornAlg<float>;
             pfnAlgInt32 = GDALSlopeHornAlg<GInt32>;
+#ifdef HAVE_16_SSE_REG
+            if( psOptions->slopeFormat != 1 )
+                pfnAlgFloat_multisample =
+                    GDALSlopePercentAlg_multisample_float<HORN>;
+#endif
         }
     }
 
@@ -3838,7 +4321,7 @@ GDALDatasetH GDALDEMProcessing( const char *pszDest,
         {
             GDALGeneric3x3Processing<float>(hSrcBand, hDstBand,
                                             pfnAlgFloat,
-                                            nullptr,
+                                            pfnAlgFloat_multisample,
                                             pData,
                                             psOptions->bComputeAtEdges,
                                             pfnProgress, pProgressData);
@@ -28,11 +28,11 @@
  ****************************************************************************/
 
 #include "cpl_string.h"
-#include "cpl_minixml.h"
 #include "gdal_version.h"
 #include "gdal.h"
 #include "commonutils.h"
-#include "ogr_spatialref.h"
+#include "gdal_utils_priv.h"
+
 #include <vector>
 
 CPL_CVSID("$Id: gdallocationinfo.cpp af0ad2ff6d6f6e38e0a7720f5664fa540ed3b836 2019-06-27 11:19:31 +0200 Even Rouault $")
@@ -51,7 +51,7 @@ Usage:
 \verbatim
 Usage: gdallocationinfo [--help-general] [-xml] [-lifonly] [-valonly]
                         [-b band]* [-overview overview_level]
-                        [-l_srs srs_def] [-geoloc] [-wgs84]
+                        [-l_srs srs_def] [-geoloc] [-wgs84] [-batch]
                         [-oo NAME=VALUE]* srcfile [x y]
 \endverbatim
 
@@ -93,6 +93,13 @@ pixel/line) must still be given with respect to the base band.</dd>
 <dt> <b>-wgs84</b>:</dt>
 <dd> Indicates input x,y points are WGS84 long, lat.</dd>
 
+<dt> <b>-batch</b>:</dt>
+<dd>(GDAL &gt;= 3.1) Read all the x,y points of stdin before reporting them.
+The points are transformed at once and sorted by block of the raster,
+so that each block is read a single time, which is much faster
+to sample many points of a tiled or remote raster. The reports are
+written in the order of the input points, once the end of stdin is reached.</dd>
+
 <dt> <b>-oo</b> <em>NAME=VALUE</em>:</dt>
 <dd>(starting with GDAL 2.0) Dataset open option (format specific)</dd>
 
@@ -134,6 +141,9 @@ identified for the pixel.
 It is anticipated that additional reporting capabilities will be added to
 gdallocationinfo in the future.
 
+Starting with GDAL 3.1, this utility is also callable from C with
+GDALLocationInfo().
+
 <p>
 \section gdallocationinfo_example EXAMPLE
 
@@ -176,37 +186,37 @@ static void Usage()
 {
     printf( "Usage: gdallocationinfo [--help-general] [-xml] [-lifonly] [-valonly]\n"
             "                        [-b band]* [-overview overview_level]\n"
-            "                        [-l_srs srs_def] [-geoloc] [-wgs84]\n"
+            "                        [-l_srs srs_def] [-geoloc] [-wgs84] [-batch]\n"
             "                        [-oo NAME=VALUE]* srcfile x y\n"
             "\n" );
     exit( 1 );
 }
 
 /************************************************************************/
-/*                             SanitizeSRS                              */
+/*                 GDALLocationInfoOptionsForBinaryNew()                */
 /************************************************************************/
 
-static char *SanitizeSRS( const char *pszUserInput )
-
+static GDALLocationInfoOptionsForBinary *GDALLocationInfoOptionsForBinaryNew(void)
 {
-    CPLErrorReset();
+    return static_cast<GDALLocationInfoOptionsForBinary *>(
+        CPLCalloc(1, sizeof(GDALLocationInfoOptionsForBinary)));
+}
 
-    OGRSpatialReferenceH hSRS = OSRNewSpatialReference( nullptr );
+/************************************************************************/
+/*                 GDALLocationInfoOptionsForBinaryFree()               */
+/************************************************************************/
 
-    char *pszResult = nullptr;
-    if( OSRSetFromUserInput( hSRS, pszUserInput ) == OGRERR_NONE )
-        OSRExportToWkt( hSRS, &pszResult );
-    else
+static void GDALLocationInfoOptionsForBinaryFree(
+    GDALLocationInfoOptionsForBinary* psOptionsForBinary )
+{
+    if( psOptionsForBinary )
     {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                  "Translating source or target SRS failed:\n%s",
-                  pszUserInput );
-        exit( 1 );
+        CPLFree(psOptionsForBinary->pszSrcFilename);
+        CSLDestroy(psOptionsForBinary->papszOpenOptions);
+        CPLFree(psOptionsForBinary->pszLocX);
+        CPLFree(psOptionsForBinary->pszLocY);
+        CPLFree(psOptionsForBinary);
     }
-
-    OSRDestroySpatialReference( hSRS );
-
-    return pszResult;
 }
 
 /************************************************************************/
@@ -216,23 +226,11 @@ static char *SanitizeSRS( const char *pszUserInput )
 MAIN_START(argc, argv)
 
 {
-    const char         *pszLocX = nullptr, *pszLocY = nullptr;
-    const char         *pszSrcFilename = nullptr;
-    char               *pszSourceSRS = nullptr;
-    std::vector<int>   anBandList;
-    bool               bAsXML = false, bLIFOnly = false;
-    bool               bQuiet = false, bValOnly = false;
-    int                nOverview = -1;
-    char             **papszOpenOptions = nullptr;
-
     GDALAllRegister();
     argc = GDALGeneralCmdLineProcessor( argc, &argv, 0 );
     if( argc < 1 )
         exit( -argc );
 
-/* -------------------------------------------------------------------- */
-/*      Parse arguments.                                                */
-/* -------------------------------------------------------------------- */
     for( int i = 1; i < argc; i++ )
     {
         if( EQUAL(argv[i], "--utility_version") )
@@ -243,410 +241,97 @@ MAIN_START(argc, argv)
             CSLDestroy(argv);
             return 0;
         }
-        else if( i < argc-1 && EQUAL(argv[i],"-b") )
-        {
-            anBandList.push_back( atoi(argv[++i]) );
-        }
-        else if( i < argc-1 && EQUAL(argv[i],"-overview") )
-        {
-            nOverview = atoi(argv[++i]) - 1;
-        }
-        else if( i < argc-1 && EQUAL(argv[i],"-l_srs") )
-        {
-            CPLFree(pszSourceSRS);
-            // coverity[tainted_data]
-            pszSourceSRS = SanitizeSRS(argv[++i]);
-        }
-        else if( EQUAL(argv[i],"-geoloc") )
-        {
-            CPLFree(pszSourceSRS);
-            pszSourceSRS = CPLStrdup("-geoloc");
-        }
-        else if( EQUAL(argv[i],"-wgs84") )
-        {
-            CPLFree(pszSourceSRS);
-            pszSourceSRS = SanitizeSRS("WGS84");
-        }
-        else if( EQUAL(argv[i],"-xml") )
-        {
-            bAsXML = true;
-        }
-        else if( EQUAL(argv[i],"-lifonly") )
-        {
-            bLIFOnly = true;
-            bQuiet = true;
-        }
-        else if( EQUAL(argv[i],"-valonly") )
-        {
-            bValOnly = true;
-            bQuiet = true;
-        }
-        else if( i < argc-1 && EQUAL(argv[i], "-oo") )
-        {
-            papszOpenOptions = CSLAddString( papszOpenOptions,
-                                                argv[++i] );
-        }
-        else if( argv[i][0] == '-' && !isdigit(argv[i][1]) )
-            Usage();
-
-        else if( pszSrcFilename == nullptr )
-            pszSrcFilename = argv[i];
-
-        else if( pszLocX == nullptr )
-            pszLocX = argv[i];
+    }
 
-        else if( pszLocY == nullptr )
-            pszLocY = argv[i];
+/* -------------------------------------------------------------------- */
+/*      Parse arguments.                                                */
+/* -------------------------------------------------------------------- */
+    GDALLocationInfoOptionsForBinary* psOptionsForBinary =
+        GDALLocationInfoOptionsForBinaryNew();
 
-        else
-            Usage();
-    }
+    GDALLocationInfoOptions *psOptions =
+        GDALLocationInfoOptionsNew(argv + 1, psOptionsForBinary);
+    if( psOptions == nullptr )
+        Usage();
 
-    if( pszSrcFilename == nullptr || (pszLocX != nullptr && pszLocY == nullptr) )
+    const char* pszLocX = psOptionsForBinary->pszLocX;
+    const char* pszLocY = psOptionsForBinary->pszLocY;
+    if( psOptionsForBinary->pszSrcFilename == nullptr ||
+        (pszLocX != nullptr && pszLocY == nullptr) )
         Usage();
 
 /* -------------------------------------------------------------------- */
 /*      Open source file.                                               */
 /* -------------------------------------------------------------------- */
     GDALDatasetH hSrcDS
-        = GDALOpenEx( pszSrcFilename, GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR,
+        = GDALOpenEx( psOptionsForBinary->pszSrcFilename,
+                      GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR,
                       nullptr,
-                      papszOpenOptions, nullptr );
+                      psOptionsForBinary->papszOpenOptions, nullptr );
     if( hSrcDS == nullptr )
         exit( 1 );
 
 /* -------------------------------------------------------------------- */
-/*      Setup coordinate transformation, if required                    */
+/*      Report the location of the command line, the points of stdin    */
+/*      one at a time, or all of them at once in batch mode.            */
 /* -------------------------------------------------------------------- */
-    OGRSpatialReferenceH hSrcSRS = nullptr;
-    OGRCoordinateTransformationH hCT = nullptr;
-    if( pszSourceSRS != nullptr && !EQUAL(pszSourceSRS,"-geoloc") )
-    {
-
-        hSrcSRS = OSRNewSpatialReference( pszSourceSRS );
-        OSRSetAxisMappingStrategy(hSrcSRS, OAMS_TRADITIONAL_GIS_ORDER);
-        auto hTrgSRS = GDALGetSpatialRef( hSrcDS );
-        if( !hTrgSRS )
-            exit(1);
-
-        hCT = OCTNewCoordinateTransformation( hSrcSRS, hTrgSRS );
-        if( hCT == nullptr )
-            exit( 1 );
-    }
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+    double dfGeoX = 0.0;
+    double dfGeoY = 0.0;
+    int nRet = 0;
 
-/* -------------------------------------------------------------------- */
-/*      If no bands were requested, we will query them all.             */
-/* -------------------------------------------------------------------- */
-    if( anBandList.empty() )
-    {
-        for( int i = 0; i < GDALGetRasterCount( hSrcDS ); i++ )
-            anBandList.push_back( i+1 );
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Turn the location into a pixel and line location.               */
-/* -------------------------------------------------------------------- */
-    int inputAvailable = 1;
-    double dfGeoX;
-    double dfGeoY;
-    CPLString osXML;
-
-    if( pszLocX == nullptr && pszLocY == nullptr )
-    {
-        if (fscanf(stdin, "%lf %lf", &dfGeoX, &dfGeoY) != 2)
-        {
-            inputAvailable = 0;
-        }
-    }
-    else
+    if( pszLocX != nullptr )
     {
-        dfGeoX = CPLAtof(pszLocX);
-        dfGeoY = CPLAtof(pszLocY);
+        adfX.push_back( CPLAtof(pszLocX) );
+        adfY.push_back( CPLAtof(pszLocY) );
     }
 
-    while (inputAvailable)
+    while( true )
     {
-        int iPixel, iLine;
-
-        if (hCT)
-        {
-            if( !OCTTransform( hCT, 1, &dfGeoX, &dfGeoY, nullptr ) )
-                exit( 1 );
-        }
-
-        if( pszSourceSRS != nullptr )
-        {
-            double adfGeoTransform[6] = {};
-            if( GDALGetGeoTransform( hSrcDS, adfGeoTransform ) != CE_None )
-            {
-                CPLError(CE_Failure, CPLE_AppDefined, "Cannot get geotransform");
-                exit( 1 );
-            }
-
-            double adfInvGeoTransform[6] = {};
-            if( !GDALInvGeoTransform( adfGeoTransform, adfInvGeoTransform ) )
-            {
-                CPLError(CE_Failure, CPLE_AppDefined, "Cannot invert geotransform");
-                exit( 1 );
-            }
-
-            iPixel = static_cast<int>(floor(
-                adfInvGeoTransform[0]
-                + adfInvGeoTransform[1] * dfGeoX
-                + adfInvGeoTransform[2] * dfGeoY));
-            iLine = static_cast<int>(floor(
-                adfInvGeoTransform[3]
-                + adfInvGeoTransform[4] * dfGeoX
-                + adfInvGeoTransform[5] * dfGeoY));
-        }
-        else
-        {
-            iPixel = static_cast<int>(floor(dfGeoX));
-            iLine  = static_cast<int>(floor(dfGeoY));
-        }
-
-    /* -------------------------------------------------------------------- */
-    /*      Prepare report.                                                 */
-    /* -------------------------------------------------------------------- */
-        CPLString osLine;
-
-        if( bAsXML )
-        {
-            osLine.Printf( "<Report pixel=\"%d\" line=\"%d\">",
-                          iPixel, iLine );
-            osXML += osLine;
-        }
-        else if( !bQuiet )
-        {
-            printf( "Report:\n" );
-            printf( "  Location: (%dP,%dL)\n", iPixel, iLine );
-        }
-
-        bool bPixelReport = true;
-
-        if( iPixel < 0 || iLine < 0
-            || iPixel >= GDALGetRasterXSize( hSrcDS )
-            || iLine  >= GDALGetRasterYSize( hSrcDS ) )
-        {
-            if( bAsXML )
-                osXML += "<Alert>Location is off this file! No further details to report.</Alert>";
-            else if( bValOnly )
-                printf("\n");
-            else if( !bQuiet )
-                printf( "\nLocation is off this file! No further details to report.\n");
-            bPixelReport = false;
-        }
-
-    /* -------------------------------------------------------------------- */
-    /*      Process each band.                                              */
-    /* -------------------------------------------------------------------- */
-        for( int i = 0; bPixelReport && i < static_cast<int>(anBandList.size());
-             i++ )
+        if( pszLocX == nullptr )
         {
-            GDALRasterBandH hBand = GDALGetRasterBand( hSrcDS, anBandList[i] );
-
-            int iPixelToQuery = iPixel;
-            int iLineToQuery = iLine;
-
-            if (nOverview >= 0 && hBand != nullptr)
-            {
-                GDALRasterBandH hOvrBand = GDALGetOverview(hBand, nOverview);
-                if (hOvrBand != nullptr)
-                {
-                    int nOvrXSize = GDALGetRasterBandXSize(hOvrBand);
-                    int nOvrYSize = GDALGetRasterBandYSize(hOvrBand);
-                    iPixelToQuery = static_cast<int>(
-                        0.5 +
-                        1.0 * iPixel / GDALGetRasterXSize(hSrcDS) * nOvrXSize);
-                    iLineToQuery = static_cast<int>(
-                        0.5 +
-                        1.0 * iLine / GDALGetRasterYSize(hSrcDS) * nOvrYSize);
-                    if (iPixelToQuery >= nOvrXSize)
-                        iPixelToQuery = nOvrXSize - 1;
-                    if (iLineToQuery >= nOvrYSize)
-                        iLineToQuery = nOvrYSize - 1;
-                }
-                else
-                {
-                    CPLError(CE_Failure, CPLE_AppDefined,
-                             "Cannot get overview %d of band %d",
-                             nOverview + 1, anBandList[i] );
-                }
-                hBand = hOvrBand;
-            }
-
-            if (hBand == nullptr)
-                continue;
-
-            if( bAsXML )
+            if( fscanf(stdin, "%lf %lf", &dfGeoX, &dfGeoY) == 2 )
             {
-                osLine.Printf( "<BandReport band=\"%d\">", anBandList[i] );
-                osXML += osLine;
+                adfX.push_back( dfGeoX );
+                adfY.push_back( dfGeoY );
+                if( psOptionsForBinary->bBatch )
+                    continue;
             }
-            else if( !bQuiet )
-            {
-                printf( "  Band %d:\n", anBandList[i] );
-            }
-
-    /* -------------------------------------------------------------------- */
-    /*      Request location info for this location.  It is possible        */
-    /*      only the VRT driver actually supports this.                     */
-    /* -------------------------------------------------------------------- */
-            CPLString osItem;
-
-            osItem.Printf( "Pixel_%d_%d", iPixelToQuery, iLineToQuery );
-
-            const char *pszLI = GDALGetMetadataItem( hBand, osItem, "LocationInfo");
-
-            if( pszLI != nullptr )
-            {
-                if( bAsXML )
-                    osXML += pszLI;
-                else if( !bQuiet )
-                    printf( "    %s\n", pszLI );
-                else if( bLIFOnly )
-                {
-                    /* Extract all files, if any. */
-
-                    CPLXMLNode *psRoot = CPLParseXMLString( pszLI );
-
-                    if( psRoot != nullptr
-                        && psRoot->psChild != nullptr
-                        && psRoot->eType == CXT_Element
-                        && EQUAL(psRoot->pszValue,"LocationInfo") )
-                    {
-                        for( CPLXMLNode *psNode = psRoot->psChild;
-                             psNode != nullptr;
-                             psNode = psNode->psNext )
-                        {
-                            if( psNode->eType == CXT_Element
-                                && EQUAL(psNode->pszValue,"File")
-                                && psNode->psChild != nullptr )
-                            {
-                                char* pszUnescaped = CPLUnescapeString(
-                                    psNode->psChild->pszValue, nullptr, CPLES_XML);
-                                printf( "%s\n", pszUnescaped );
-                                CPLFree(pszUnescaped);
-                            }
-                        }
-                    }
-                    CPLDestroyXMLNode( psRoot );
-                }
-            }
-
-    /* -------------------------------------------------------------------- */
-    /*      Report the pixel value of this band.                            */
-    /* -------------------------------------------------------------------- */
-            double adfPixel[2];
-
-            if( GDALRasterIO( hBand, GF_Read, iPixelToQuery, iLineToQuery, 1, 1,
-                              adfPixel, 1, 1, GDT_CFloat64, 0, 0) == CE_None )
-            {
-                CPLString osValue;
-
-                if( GDALDataTypeIsComplex( GDALGetRasterDataType( hBand ) ) )
-                    osValue.Printf( "%.15g+%.15gi", adfPixel[0], adfPixel[1] );
-                else
-                    osValue.Printf( "%.15g", adfPixel[0] );
-
-                if( bAsXML )
-                {
-                    osXML += "<Value>";
-                    osXML += osValue;
-                    osXML += "</Value>";
-                }
-                else if( !bQuiet )
-                    printf( "    Value: %s\n", osValue.c_str() );
-                else if( bValOnly )
-                    printf( "%s\n", osValue.c_str() );
-
-                // Report unscaled if we have scale/offset values.
-                int bSuccess;
-
-                double dfOffset = GDALGetRasterOffset( hBand, &bSuccess );
-                // TODO: Should we turn on checking of bSuccess?
-                // Alternatively, delete these checks and put a comment as to
-                // why checking bSuccess does not matter.
-#if 0
-                if (bSuccess == FALSE)
-                {
-                    CPLError( CE_Debug, CPLE_AppDefined,
-                              "Unable to get raster offset." );
-                }
-#endif
-                double dfScale  = GDALGetRasterScale( hBand, &bSuccess );
-#if 0
-                if (bSuccess == FALSE)
-                {
-                    CPLError( CE_Debug, CPLE_AppDefined,
-                              "Unable to get raster scale." );
-                }
-#endif
-                if( dfOffset != 0.0 || dfScale != 1.0 )
-                {
-                    adfPixel[0] = adfPixel[0] * dfScale + dfOffset;
-                    adfPixel[1] = adfPixel[1] * dfScale + dfOffset;
-
-                    if( GDALDataTypeIsComplex( GDALGetRasterDataType( hBand ) ) )
-                        osValue.Printf( "%.15g+%.15gi", adfPixel[0], adfPixel[1] );
-                    else
-                        osValue.Printf( "%.15g", adfPixel[0] );
-
-                    if( bAsXML )
-                    {
-                        osXML += "<DescaledValue>";
-                        osXML += osValue;
-                        osXML += "</DescaledValue>";
-                    }
-                    else if( !bQuiet )
-                        printf( "    Descaled Value: %s\n", osValue.c_str() );
-                }
-            }
-
-            if( bAsXML )
-                osXML += "</BandReport>";
+            else if( adfX.empty() )
+                break;
         }
 
-        osXML += "</Report>";
-
-        if( (pszLocX != nullptr && pszLocY != nullptr)  ||
-            (fscanf(stdin, "%lf %lf", &dfGeoX, &dfGeoY) != 2) )
+        char* pszReport = GDALLocationInfo(
+            hSrcDS, static_cast<int>(adfX.size()), adfX.data(), adfY.data(),
+            psOptions );
+        if( pszReport == nullptr )
         {
-            inputAvailable = 0;
+            nRet = 1;
+            break;
         }
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Finalize xml report and print.                                  */
-/* -------------------------------------------------------------------- */
-    if( bAsXML )
-    {
-        CPLXMLNode *psRoot = CPLParseXMLString( osXML );
-        char *pszFormattedXML = CPLSerializeXMLTree( psRoot );
-        CPLDestroyXMLNode( psRoot );
+        printf( "%s", pszReport );
+        CPLFree( pszReport );
 
-        printf( "%s", pszFormattedXML );
-        CPLFree( pszFormattedXML );
+        if( pszLocX != nullptr || psOptionsForBinary->bBatch )
+            break;
+        adfX.clear();
+        adfY.clear();
     }
 
 /* -------------------------------------------------------------------- */
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
-    if (hCT) {
-        OSRDestroySpatialReference( hSrcSRS );
-        OCTDestroyCoordinateTransformation( hCT );
-    }
+    GDALLocationInfoOptionsFree( psOptions );
+    GDALLocationInfoOptionsForBinaryFree( psOptionsForBinary );
 
-    if (hSrcDS)
-        GDALClose(hSrcDS);
+    GDALClose(hSrcDS);
 
     GDALDumpOpenDatasets( stderr );
     GDALDestroyDriverManager();
-    CPLFree(pszSourceSRS);
-    CSLDestroy(papszOpenOptions);
 
     CSLDestroy( argv );
 
-    return 0;
+    return nRet;
 }
 MAIN_END
@@ -0,0 +1,767 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Raster query library: reports the values of a set of pixels,
+ *           reading each block of the raster once.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "gdal_utils.h"
+#include "gdal_utils_priv.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include <algorithm>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_minixml.h"
+#include "cpl_string.h"
+#include "gdal.h"
+#include "ogr_srs_api.h"
+
+CPL_CVSID("$Id$")
+
+// Largest window, in pixels, read at once for the points of a block.
+// Beyond that (e.g. for huge blocks of untiled rasters), the points are
+// read one by one, still in block order.
+constexpr int MAX_WINDOW_PIXELS = 1024 * 1024;
+
+struct GDALLocationInfoOptions
+{
+    bool bAsXML;
+    bool bLIFOnly;
+    bool bValOnly;
+    bool bQuiet;
+    std::vector<int> anBandList;
+    int nOverview;
+
+    /* WKT of the SRS of the input coordinates, "-geoloc" if they are */
+    /* georeferenced coordinates of the dataset, or empty for pixel/line. */
+    CPLString osSourceSRS;
+
+    /* Coordinate transformation of the last call, reused as long as the */
+    /* dataset has the same SRS. */
+    OGRSpatialReferenceH hSrcSRS;
+    mutable OGRSpatialReferenceH hCachedTargetSRS;
+    mutable OGRCoordinateTransformationH hCachedCT;
+};
+
+/************************************************************************/
+/*                      GDALLocationInfoGetCT()                         */
+/************************************************************************/
+
+static OGRCoordinateTransformationH
+GDALLocationInfoGetCT( GDALDatasetH hSrcDS,
+                       const GDALLocationInfoOptions* psOptions )
+{
+    OGRSpatialReferenceH hTrgSRS = GDALGetSpatialRef( hSrcDS );
+    if( hTrgSRS == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Dataset has no coordinate system");
+        return nullptr;
+    }
+
+    if( psOptions->hCachedCT != nullptr &&
+        OSRIsSame(psOptions->hCachedTargetSRS, hTrgSRS) )
+    {
+        return psOptions->hCachedCT;
+    }
+
+    OCTDestroyCoordinateTransformation( psOptions->hCachedCT );
+    OSRDestroySpatialReference( psOptions->hCachedTargetSRS );
+    psOptions->hCachedTargetSRS = OSRClone( hTrgSRS );
+    psOptions->hCachedCT =
+        OCTNewCoordinateTransformation( psOptions->hSrcSRS, hTrgSRS );
+    return psOptions->hCachedCT;
+}
+
+/************************************************************************/
+/*                     GDALLocationInfoReadValues()                     */
+/*                                                                      */
+/*      Reads the values of the points of a band, sorted by block so    */
+/*      that each block is read only once.                              */
+/************************************************************************/
+
+static void GDALLocationInfoReadValues( GDALRasterBandH hBand,
+                                        const std::vector<int>& anPixel,
+                                        const std::vector<int>& anLine,
+                                        const std::vector<int>& anPoints,
+                                        int iBand, int nBands,
+                                        std::vector<double>& adfValues,
+                                        std::vector<bool>& abValid )
+{
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    GDALGetBlockSize( hBand, &nBlockXSize, &nBlockYSize );
+    nBlockXSize = std::max(1, nBlockXSize);
+    nBlockYSize = std::max(1, nBlockYSize);
+
+    std::vector<int> anSorted(anPoints);
+    std::sort(anSorted.begin(), anSorted.end(),
+        [&anPixel, &anLine, nBlockXSize, nBlockYSize](int a, int b)
+        {
+            const int nBlockYA = anLine[a] / nBlockYSize;
+            const int nBlockYB = anLine[b] / nBlockYSize;
+            if( nBlockYA != nBlockYB )
+                return nBlockYA < nBlockYB;
+            const int nBlockXA = anPixel[a] / nBlockXSize;
+            const int nBlockXB = anPixel[b] / nBlockXSize;
+            if( nBlockXA != nBlockXB )
+                return nBlockXA < nBlockXB;
+            if( anLine[a] != anLine[b] )
+                return anLine[a] < anLine[b];
+            return anPixel[a] < anPixel[b];
+        });
+
+    std::vector<double> adfWindow;
+    size_t iStart = 0;
+    while( iStart < anSorted.size() )
+    {
+        const int nBlockX = anPixel[anSorted[iStart]] / nBlockXSize;
+        const int nBlockY = anLine[anSorted[iStart]] / nBlockYSize;
+        int nMinX = anPixel[anSorted[iStart]];
+        int nMaxX = nMinX;
+        const int nMinY = anLine[anSorted[iStart]];
+        int nMaxY = nMinY;
+        size_t iEnd = iStart + 1;
+        for( ; iEnd < anSorted.size(); ++iEnd )
+        {
+            const int iPoint = anSorted[iEnd];
+            if( anPixel[iPoint] / nBlockXSize != nBlockX ||
+                anLine[iPoint] / nBlockYSize != nBlockY )
+                break;
+            nMinX = std::min(nMinX, anPixel[iPoint]);
+            nMaxX = std::max(nMaxX, anPixel[iPoint]);
+            nMaxY = anLine[iPoint];
+        }
+
+        const int nWinXSize = nMaxX - nMinX + 1;
+        const int nWinYSize = nMaxY - nMinY + 1;
+        bool bWindowRead = false;
+        if( iEnd - iStart > 1 &&
+            static_cast<GIntBig>(nWinXSize) * nWinYSize <= MAX_WINDOW_PIXELS )
+        {
+            adfWindow.resize(static_cast<size_t>(nWinXSize) * nWinYSize * 2);
+            bWindowRead =
+                GDALRasterIO( hBand, GF_Read, nMinX, nMinY,
+                              nWinXSize, nWinYSize,
+                              &adfWindow[0], nWinXSize, nWinYSize,
+                              GDT_CFloat64, 0, 0 ) == CE_None;
+        }
+
+        for( size_t i = iStart; i < iEnd; ++i )
+        {
+            const int iPoint = anSorted[i];
+            double* padfValue = &adfValues[
+                (static_cast<size_t>(iPoint) * nBands + iBand) * 2];
+            if( bWindowRead )
+            {
+                const size_t nOffset =
+                    (static_cast<size_t>(anLine[iPoint] - nMinY) * nWinXSize +
+                     (anPixel[iPoint] - nMinX)) * 2;
+                padfValue[0] = adfWindow[nOffset];
+                padfValue[1] = adfWindow[nOffset + 1];
+                abValid[static_cast<size_t>(iPoint) * nBands + iBand] = true;
+            }
+            else if( GDALRasterIO( hBand, GF_Read,
+                                   anPixel[iPoint], anLine[iPoint], 1, 1,
+                                   padfValue, 1, 1, GDT_CFloat64,
+                                   0, 0 ) == CE_None )
+            {
+                abValid[static_cast<size_t>(iPoint) * nBands + iBand] = true;
+            }
+        }
+
+        iStart = iEnd;
+    }
+}
+
+/************************************************************************/
+/*                          GDALLocationInfo()                          */
+/************************************************************************/
+
+/**
+ * Reports information about a set of pixels of a raster dataset.
+ *
+ * This is the equivalent of the <a href="gdallocationinfo.html">gdallocationinfo</a> utility.
+ *
+ * The points are located in the coordinate system selected by the -l_srs,
+ * -geoloc or -wgs84 options, and default to pixel/line coordinates.
+ * They are transformed at once, sorted by block of the raster so that each
+ * block is read a single time, and reported in their original order.
+ *
+ * GDALLocationInfoOptions* must be allocated and freed with
+ * GDALLocationInfoOptionsNew() and GDALLocationInfoOptionsFree() respectively.
+ * The options may keep the coordinate transformation of the last call, so
+ * they should not be used by several threads at the same time.
+ *
+ * @param hSrcDataset the dataset handle.
+ * @param nCount number of points.
+ * @param padfX array of nCount X coordinates.
+ * @param padfY array of nCount Y coordinates.
+ * @param psOptionsIn the options struct returned by GDALLocationInfoOptionsNew() or NULL.
+ * @return the report of the points (must be freed with CPLFree()), or NULL in case of error.
+ *
+ * @since GDAL 3.1
+ */
+
+char *GDALLocationInfo( GDALDatasetH hSrcDataset,
+                        int nCount, const double* padfX, const double* padfY,
+                        const GDALLocationInfoOptions *psOptionsIn )
+{
+    if( hSrcDataset == nullptr || nCount < 0 ||
+        (nCount > 0 && (padfX == nullptr || padfY == nullptr)) )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "GDALLocationInfo(): invalid arguments");
+        return nullptr;
+    }
+
+    GDALLocationInfoOptions* psOptionsToFree = nullptr;
+    const GDALLocationInfoOptions* psOptions = psOptionsIn;
+    if( psOptions == nullptr )
+    {
+        psOptionsToFree = GDALLocationInfoOptionsNew(nullptr, nullptr);
+        psOptions = psOptionsToFree;
+    }
+
+    const bool bAsXML = psOptions->bAsXML;
+    const bool bLIFOnly = psOptions->bLIFOnly;
+    const bool bValOnly = psOptions->bValOnly;
+    const bool bQuiet = psOptions->bQuiet;
+    const int nOverview = psOptions->nOverview;
+
+    std::vector<int> anBandList(psOptions->anBandList);
+    if( anBandList.empty() )
+    {
+        for( int i = 0; i < GDALGetRasterCount( hSrcDataset ); i++ )
+            anBandList.push_back( i+1 );
+    }
+    const int nBands = static_cast<int>(anBandList.size());
+
+/* -------------------------------------------------------------------- */
+/*      Turn the locations into pixel and line locations.               */
+/* -------------------------------------------------------------------- */
+    std::vector<double> adfX(padfX, padfX + nCount);
+    std::vector<double> adfY(padfY, padfY + nCount);
+    if( !psOptions->osSourceSRS.empty() &&
+        psOptions->osSourceSRS != "-geoloc" && nCount > 0 )
+    {
+        OGRCoordinateTransformationH hCT =
+            GDALLocationInfoGetCT( hSrcDataset, psOptions );
+        if( hCT == nullptr )
+        {
+            GDALLocationInfoOptionsFree(psOptionsToFree);
+            return nullptr;
+        }
+
+        std::vector<int> abSuccess(nCount);
+        OCTTransformEx( hCT, nCount, &adfX[0], &adfY[0], nullptr,
+                        &abSuccess[0] );
+        for( int i = 0; i < nCount; i++ )
+        {
+            if( !abSuccess[i] )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Cannot transform point (%.15g,%.15g)",
+                         padfX[i], padfY[i]);
+                GDALLocationInfoOptionsFree(psOptionsToFree);
+                return nullptr;
+            }
+        }
+    }
+
+    double adfInvGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    if( !psOptions->osSourceSRS.empty() )
+    {
+        double adfGeoTransform[6] = {};
+        if( GDALGetGeoTransform( hSrcDataset, adfGeoTransform ) != CE_None )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Cannot get geotransform");
+            GDALLocationInfoOptionsFree(psOptionsToFree);
+            return nullptr;
+        }
+
+        if( !GDALInvGeoTransform( adfGeoTransform, adfInvGeoTransform ) )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Cannot invert geotransform");
+            GDALLocationInfoOptionsFree(psOptionsToFree);
+            return nullptr;
+        }
+    }
+
+    const int nRasterXSize = GDALGetRasterXSize( hSrcDataset );
+    const int nRasterYSize = GDALGetRasterYSize( hSrcDataset );
+    std::vector<int> anPixel(nCount);
+    std::vector<int> anLine(nCount);
+    std::vector<bool> abInside(nCount);
+    std::vector<int> anInside;
+    for( int i = 0; i < nCount; i++ )
+    {
+        const double dfPixel = floor(
+            adfInvGeoTransform[0]
+            + adfInvGeoTransform[1] * adfX[i]
+            + adfInvGeoTransform[2] * adfY[i]);
+        const double dfLine = floor(
+            adfInvGeoTransform[3]
+            + adfInvGeoTransform[4] * adfX[i]
+            + adfInvGeoTransform[5] * adfY[i]);
+        // Clamp so that far away points do not overflow.
+        anPixel[i] = static_cast<int>(
+            std::max(-1.0, std::min(dfPixel, 1.0 * INT_MAX)));
+        anLine[i] = static_cast<int>(
+            std::max(-1.0, std::min(dfLine, 1.0 * INT_MAX)));
+        abInside[i] = anPixel[i] >= 0 && anLine[i] >= 0 &&
+                      anPixel[i] < nRasterXSize && anLine[i] < nRasterYSize;
+        if( abInside[i] )
+            anInside.push_back(i);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Select the band or overview to query of each band, and read     */
+/*      the values of all the points.                                   */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALRasterBandH> ahBands(nBands);
+    std::vector<int> anQueryPixel(static_cast<size_t>(nCount) * nBands);
+    std::vector<int> anQueryLine(static_cast<size_t>(nCount) * nBands);
+    std::vector<double> adfValues(static_cast<size_t>(nCount) * nBands * 2);
+    std::vector<bool> abValid(static_cast<size_t>(nCount) * nBands);
+    std::vector<int> anBandPixel(nCount);
+    std::vector<int> anBandLine(nCount);
+    for( int iBand = 0; iBand < nBands; iBand++ )
+    {
+        GDALRasterBandH hBand =
+            GDALGetRasterBand( hSrcDataset, anBandList[iBand] );
+
+        int nOvrXSize = 0;
+        int nOvrYSize = 0;
+        if (nOverview >= 0 && hBand != nullptr)
+        {
+            GDALRasterBandH hOvrBand = GDALGetOverview(hBand, nOverview);
+            if (hOvrBand != nullptr)
+            {
+                nOvrXSize = GDALGetRasterBandXSize(hOvrBand);
+                nOvrYSize = GDALGetRasterBandYSize(hOvrBand);
+            }
+            else if( !anInside.empty() )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Cannot get overview %d of band %d",
+                         nOverview + 1, anBandList[iBand] );
+            }
+            hBand = hOvrBand;
+        }
+
+        ahBands[iBand] = hBand;
+        if (hBand == nullptr)
+            continue;
+
+        for( const int i: anInside )
+        {
+            int iPixelToQuery = anPixel[i];
+            int iLineToQuery = anLine[i];
+            if( nOverview >= 0 )
+            {
+                iPixelToQuery = static_cast<int>(
+                    0.5 + 1.0 * anPixel[i] / nRasterXSize * nOvrXSize);
+                iLineToQuery = static_cast<int>(
+                    0.5 + 1.0 * anLine[i] / nRasterYSize * nOvrYSize);
+                if (iPixelToQuery >= nOvrXSize)
+                    iPixelToQuery = nOvrXSize - 1;
+                if (iLineToQuery >= nOvrYSize)
+                    iLineToQuery = nOvrYSize - 1;
+            }
+            anBandPixel[i] = iPixelToQuery;
+            anBandLine[i] = iLineToQuery;
+            anQueryPixel[static_cast<size_t>(i) * nBands + iBand] =
+                iPixelToQuery;
+            anQueryLine[static_cast<size_t>(i) * nBands + iBand] =
+                iLineToQuery;
+        }
+
+        GDALLocationInfoReadValues( hBand, anBandPixel, anBandLine, anInside,
+                                    iBand, nBands, adfValues, abValid );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Prepare the reports, in the order of the input points.          */
+/* -------------------------------------------------------------------- */
+    CPLString osText;
+    CPLString osXML;
+    CPLString osLine;
+    for( int iPoint = 0; iPoint < nCount; iPoint++ )
+    {
+        const int iPixel = anPixel[iPoint];
+        const int iLine = anLine[iPoint];
+
+        if( bAsXML )
+        {
+            osLine.Printf( "<Report pixel=\"%d\" line=\"%d\">",
+                          iPixel, iLine );
+            osXML += osLine;
+        }
+        else if( !bQuiet )
+        {
+            osText += "Report:\n";
+            osLine.Printf( "  Location: (%dP,%dL)\n", iPixel, iLine );
+            osText += osLine;
+        }
+
+        if( !abInside[iPoint] )
+        {
+            if( bAsXML )
+                osXML += "<Alert>Location is off this file! No further details to report.</Alert>";
+            else if( bValOnly )
+                osText += "\n";
+            else if( !bQuiet )
+                osText += "\nLocation is off this file! No further details to report.\n";
+        }
+
+    /* -------------------------------------------------------------------- */
+    /*      Process each band.                                              */
+    /* -------------------------------------------------------------------- */
+        for( int iBand = 0; abInside[iPoint] && iBand < nBands; iBand++ )
+        {
+            GDALRasterBandH hBand = ahBands[iBand];
+            if (hBand == nullptr)
+                continue;
+
+            const size_t iValue = static_cast<size_t>(iPoint) * nBands + iBand;
+
+            if( bAsXML )
+            {
+                osLine.Printf( "<BandReport band=\"%d\">", anBandList[iBand] );
+                osXML += osLine;
+            }
+            else if( !bQuiet )
+            {
+                osLine.Printf( "  Band %d:\n", anBandList[iBand] );
+                osText += osLine;
+            }
+
+    /* -------------------------------------------------------------------- */
+    /*      Request location info for this location.  It is possible        */
+    /*      only the VRT driver actually supports this.                     */
+    /* -------------------------------------------------------------------- */
+            CPLString osItem;
+
+            osItem.Printf( "Pixel_%d_%d",
+                           anQueryPixel[iValue], anQueryLine[iValue] );
+
+            const char *pszLI = GDALGetMetadataItem( hBand, osItem, "LocationInfo");
+
+            if( pszLI != nullptr )
+            {
+                if( bAsXML )
+                    osXML += pszLI;
+                else if( !bQuiet )
+                {
+                    osText += "    ";
+                    osText += pszLI;
+                    osText += "\n";
+                }
+                else if( bLIFOnly )
+                {
+                    /* Extract all files, if any. */
+
+                    CPLXMLNode *psRoot = CPLParseXMLString( pszLI );
+
+                    if( psRoot != nullptr
+                        && psRoot->psChild != nullptr
+                        && psRoot->eType == CXT_Element
+                        && EQUAL(psRoot->pszValue,"LocationInfo") )
+                    {
+                        for( CPLXMLNode *psNode = psRoot->psChild;
+                             psNode != nullptr;
+                             psNode = psNode->psNext )
+                        {
+                            if( psNode->eType == CXT_Element
+                                && EQUAL(psNode->pszValue,"File")
+                                && psNode->psChild != nullptr )
+                            {
+                                char* pszUnescaped = CPLUnescapeString(
+                                    psNode->psChild->pszValue, nullptr, CPLES_XML);
+                                osText += pszUnescaped;
+                                osText += "\n";
+                                CPLFree(pszUnescaped);
+                            }
+                        }
+                    }
+                    CPLDestroyXMLNode( psRoot );
+                }
+            }
+
+    /* -------------------------------------------------------------------- */
+    /*      Report the pixel value of this band.                            */
+    /* -------------------------------------------------------------------- */
+            if( abValid[iValue] )
+            {
+                double adfPixel[2] = { adfValues[iValue * 2],
+                                       adfValues[iValue * 2 + 1] };
+                CPLString osValue;
+
+                const bool bIsComplex = CPL_TO_BOOL(
+                    GDALDataTypeIsComplex( GDALGetRasterDataType( hBand ) ));
+                if( bIsComplex )
+                    osValue.Printf( "%.15g+%.15gi", adfPixel[0], adfPixel[1] );
+                else
+                    osValue.Printf( "%.15g", adfPixel[0] );
+
+                if( bAsXML )
+                {
+                    osXML += "<Value>";
+                    osXML += osValue;
+                    osXML += "</Value>";
+                }
+                else if( !bQuiet )
+                {
+                    osText += "    Value: ";
+                    osText += osValue;
+                    osText += "\n";
+                }
+                else if( bValOnly )
+                {
+                    osText += osValue;
+                    osText += "\n";
+                }
+
+                // Report unscaled if we have scale/offset values.
+                const double dfOffset = GDALGetRasterOffset( hBand, nullptr );
+                const double dfScale  = GDALGetRasterScale( hBand, nullptr );
+                if( dfOffset != 0.0 || dfScale != 1.0 )
+                {
+                    adfPixel[0] = adfPixel[0] * dfScale + dfOffset;
+                    adfPixel[1] = adfPixel[1] * dfScale + dfOffset;
+
+                    if( bIsComplex )
+                        osValue.Printf( "%.15g+%.15gi", adfPixel[0], adfPixel[1] );
+                    else
+                        osValue.Printf( "%.15g", adfPixel[0] );
+
+                    if( bAsXML )
+                    {
+                        osXML += "<DescaledValue>";
+                        osXML += osValue;
+                        osXML += "</DescaledValue>";
+                    }
+                    else if( !bQuiet )
+                    {
+                        osText += "    Descaled Value: ";
+                        osText += osValue;
+                        osText += "\n";
+                    }
+                }
+            }
+
+            if( bAsXML )
+                osXML += "</BandReport>";
+        }
+
+        if( bAsXML )
+            osXML += "</Report>";
+    }
+
+    GDALLocationInfoOptionsFree(psOptionsToFree);
+
+/* -------------------------------------------------------------------- */
+/*      Finalize xml report.                                            */
+/* -------------------------------------------------------------------- */
+    if( bAsXML )
+    {
+        CPLXMLNode *psRoot = CPLParseXMLString( osXML );
+        char *pszFormattedXML = CPLSerializeXMLTree( psRoot );
+        CPLDestroyXMLNode( psRoot );
+        return pszFormattedXML ? pszFormattedXML : CPLStrdup("");
+    }
+
+    return CPLStrdup(osText);
+}
+
+/************************************************************************/
+/*                     GDALLocationInfoOptionsNew()                     */
+/************************************************************************/
+
+/**
+ * Allocates a GDALLocationInfoOptions struct.
+ *
+ * @param papszArgv NULL terminated list of options (potentially including filename, x and y too), or NULL.
+ *                  The accepted options are the ones of the <a href="gdallocationinfo.html">gdallocationinfo</a> utility.
+ * @param psOptionsForBinary (output) may be NULL (and should generally be NULL),
+ *                           otherwise (gdallocationinfo.cpp use case) must be allocated with
+ *                           GDALLocationInfoOptionsForBinaryNew() prior to this function. Will be
+ *                           filled with potentially present filename, open options, location...
+ * @return pointer to the allocated GDALLocationInfoOptions struct. Must be freed with GDALLocationInfoOptionsFree().
+ *
+ * @since GDAL 3.1
+ */
+
+GDALLocationInfoOptions *GDALLocationInfoOptionsNew(
+    char** papszArgv,
+    GDALLocationInfoOptionsForBinary* psOptionsForBinary )
+{
+    GDALLocationInfoOptions *psOptions = new GDALLocationInfoOptions;
+
+    psOptions->bAsXML = false;
+    psOptions->bLIFOnly = false;
+    psOptions->bValOnly = false;
+    psOptions->bQuiet = false;
+    psOptions->nOverview = -1;
+    psOptions->hSrcSRS = nullptr;
+    psOptions->hCachedTargetSRS = nullptr;
+    psOptions->hCachedCT = nullptr;
+
+/* -------------------------------------------------------------------- */
+/*      Parse arguments.                                                */
+/* -------------------------------------------------------------------- */
+    const int argc = CSLCount(papszArgv);
+    for( int i = 0; papszArgv != nullptr && i < argc; i++ )
+    {
+        if( i < argc-1 && EQUAL(papszArgv[i],"-b") )
+        {
+            psOptions->anBandList.push_back( atoi(papszArgv[++i]) );
+        }
+        else if( i < argc-1 && EQUAL(papszArgv[i],"-overview") )
+        {
+            psOptions->nOverview = atoi(papszArgv[++i]) - 1;
+        }
+        else if( (i < argc-1 && EQUAL(papszArgv[i],"-l_srs")) ||
+                 EQUAL(papszArgv[i],"-wgs84") )
+        {
+            const char* pszSRS =
+                EQUAL(papszArgv[i],"-wgs84") ? "WGS84" : papszArgv[++i];
+            OGRSpatialReferenceH hSRS = OSRNewSpatialReference( nullptr );
+            char *pszWKT = nullptr;
+            if( OSRSetFromUserInput( hSRS, pszSRS ) != OGRERR_NONE ||
+                OSRExportToWkt( hSRS, &pszWKT ) != OGRERR_NONE )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "Translating source or target SRS failed:\n%s",
+                          pszSRS );
+                OSRDestroySpatialReference( hSRS );
+                CPLFree( pszWKT );
+                GDALLocationInfoOptionsFree(psOptions);
+                return nullptr;
+            }
+            OSRSetAxisMappingStrategy(hSRS, OAMS_TRADITIONAL_GIS_ORDER);
+            OSRDestroySpatialReference( psOptions->hSrcSRS );
+            psOptions->hSrcSRS = hSRS;
+            psOptions->osSourceSRS = pszWKT;
+            CPLFree( pszWKT );
+        }
+        else if( EQUAL(papszArgv[i],"-geoloc") )
+        {
+            OSRDestroySpatialReference( psOptions->hSrcSRS );
+            psOptions->hSrcSRS = nullptr;
+            psOptions->osSourceSRS = "-geoloc";
+        }
+        else if( EQUAL(papszArgv[i],"-xml") )
+        {
+            psOptions->bAsXML = true;
+        }
+        else if( EQUAL(papszArgv[i],"-lifonly") )
+        {
+            psOptions->bLIFOnly = true;
+            psOptions->bQuiet = true;
+        }
+        else if( EQUAL(papszArgv[i],"-valonly") )
+        {
+            psOptions->bValOnly = true;
+            psOptions->bQuiet = true;
+        }
+        else if( EQUAL(papszArgv[i],"-batch") )
+        {
+            if( psOptionsForBinary )
+                psOptionsForBinary->bBatch = TRUE;
+        }
+        else if( i < argc-1 && EQUAL(papszArgv[i], "-oo") )
+        {
+            i++;
+            if( psOptionsForBinary )
+            {
+                psOptionsForBinary->papszOpenOptions = CSLAddString(
+                    psOptionsForBinary->papszOpenOptions, papszArgv[i] );
+            }
+        }
+        else if( papszArgv[i][0] == '-' && !isdigit(papszArgv[i][1]) &&
+                 papszArgv[i][1] != '.' )
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Unknown option name '%s'", papszArgv[i]);
+            GDALLocationInfoOptionsFree(psOptions);
+            return nullptr;
+        }
+        else if( psOptionsForBinary &&
+                 psOptionsForBinary->pszSrcFilename == nullptr )
+        {
+            psOptionsForBinary->pszSrcFilename = CPLStrdup(papszArgv[i]);
+        }
+        else if( psOptionsForBinary &&
+                 psOptionsForBinary->pszLocX == nullptr )
+        {
+            psOptionsForBinary->pszLocX = CPLStrdup(papszArgv[i]);
+        }
+        else if( psOptionsForBinary &&
+                 psOptionsForBinary->pszLocY == nullptr )
+        {
+            psOptionsForBinary->pszLocY = CPLStrdup(papszArgv[i]);
+        }
+        else
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Too many command options '%s'", papszArgv[i]);
+            GDALLocationInfoOptionsFree(psOptions);
+            return nullptr;
+        }
+    }
+
+    return psOptions;
+}
+
+/************************************************************************/
+/*                     GDALLocationInfoOptionsFree()                    */
+/************************************************************************/
+
+/**
+ * Frees the GDALLocationInfoOptions struct.
+ *
+ * @param psOptions the options struct for GDALLocationInfo().
+ *
+ * @since GDAL 3.1
+ */
+
+void GDALLocationInfoOptionsFree( GDALLocationInfoOptions *psOptions )
+{
+    if( psOptions != nullptr )
+    {
+        OCTDestroyCoordinateTransformation( psOptions->hCachedCT );
+        OSRDestroySpatialReference( psOptions->hCachedTargetSRS );
+        OSRDestroySpatialReference( psOptions->hSrcSRS );
+
+        delete psOptions;
+    }
+}
@@ -37,6 +37,8 @@
 #include "commonutils.h"
 
 #include <cmath>
+#include <memory>
+#include <vector>
 
 CPL_CVSID("$Id: gdaltindex.cpp 8e5eeb35bf76390e3134a4ea7076dab7d478ea0e 2018-11-14 22:55:13 +0100 Even Rouault $")
 
@@ -443,46 +445,62 @@ MAIN_START(argc, argv)
     }
 
 /* -------------------------------------------------------------------- */
-/*      loop over GDAL files, processing.                               */
+/*      Find the files that are not already in the tileindex, and       */
+/*      start opening them (with several threads if GDAL_NUM_THREADS    */
+/*      is set).                                                        */
 /* -------------------------------------------------------------------- */
-    for( ; iArg < argc; iArg++ )
+    std::unique_ptr<GDALConcurrentDatasetOpener> poOpener(
+        new GDALConcurrentDatasetOpener(GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR,
+                                        nullptr));
+    std::vector<int> anOpenerIndex(argc, -1);
+    std::vector<CPLString> aosFileNameToWrite(argc);
+    for( int i = iArg; i < argc; i++ )
     {
-        char *fileNameToWrite = nullptr;
         VSIStatBuf sStatBuf;
 
         // Make sure it is a file before building absolute path name.
-        if( write_absolute_path && CPLIsFilenameRelative( argv[iArg] ) &&
-            VSIStat( argv[iArg], &sStatBuf ) == 0 )
+        if( write_absolute_path && CPLIsFilenameRelative( argv[i] ) &&
+            VSIStat( argv[i], &sStatBuf ) == 0 )
         {
-            fileNameToWrite =
-                CPLStrdup(CPLProjectRelativeFilename(current_path, argv[iArg]));
+            aosFileNameToWrite[i] =
+                CPLProjectRelativeFilename(current_path, argv[i]);
         }
         else
         {
-            fileNameToWrite = CPLStrdup(argv[iArg]);
+            aosFileNameToWrite[i] = argv[i];
         }
 
         // Checks that file is not already in tileindex.
+        bool bAlreadyInIndex = false;
+        for( int j = 0; j < nExistingFiles; j++ )
         {
-            int i = 0;  // Used after for.
-            for( ; i < nExistingFiles; i++ )
+            if (EQUAL(aosFileNameToWrite[i], existingFilesTab[j]))
             {
-                if (EQUAL(fileNameToWrite, existingFilesTab[i]))
-                {
-                    fprintf(stderr,
-                            "File %s is already in tileindex. Skipping it.\n",
-                            fileNameToWrite);
-                    break;
-                }
-            }
-            if (i != nExistingFiles)
-            {
-                CPLFree(fileNameToWrite);
-                continue;
+                bAlreadyInIndex = true;
+                break;
             }
         }
+        if( !bAlreadyInIndex )
+            anOpenerIndex[i] = poOpener->Add(argv[i]);
+    }
 
-        GDALDatasetH hDS = GDALOpen( argv[iArg], GA_ReadOnly );
+/* -------------------------------------------------------------------- */
+/*      loop over GDAL files, processing.                               */
+/* -------------------------------------------------------------------- */
+    for( ; iArg < argc; iArg++ )
+    {
+        char *fileNameToWrite = CPLStrdup(aosFileNameToWrite[iArg]);
+
+        if( anOpenerIndex[iArg] < 0 )
+        {
+            fprintf(stderr,
+                    "File %s is already in tileindex. Skipping it.\n",
+                    fileNameToWrite);
+            CPLFree(fileNameToWrite);
+            continue;
+        }
+
+        GDALDatasetH hDS = poOpener->Get(anOpenerIndex[iArg]);
         if( hDS == nullptr )
         {
             fprintf( stderr, "Unable to open %s, skipping.\n",
@@ -720,6 +738,9 @@ MAIN_START(argc, argv)
         GDALClose( hDS );
     }
 
+    // Closes the datasets opened ahead and not processed.
+    poOpener.reset();
+
     CPLFree(current_path);
 
     if (nExistingFiles)
@@ -29,8 +29,15 @@
 #include "gdal.h"
 #include "cpl_string.h"
 #include "cpl_conv.h"
+#include "cpl_json.h"
+#include "commonutils.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
 
 CPL_CVSID("$Id: gdaltorture.cpp a8cbfe1bffcda65bd06767f0b5f4f90996e04d61 2018-01-26 16:59:17Z Kurt Schwehr $")
 
@@ -41,7 +48,14 @@ CPL_CVSID("$Id: gdaltorture.cpp a8cbfe1bffcda65bd06767f0b5f4f90996e04d61 2018-01
 static void Usage()
 
 {
-    printf("Usage: gdaltorture [-r] [-u] [-rw] files*\n");
+    printf("Usage: gdaltorture [-r] [-u] [-rw] [-benchmark report.json] "
+           "[-loops n] files*\n"
+           "\n"
+           "  -benchmark : time opening, the API calls and RasterIO at "
+           "several window\n"
+           "               sizes, and write them with the peak memory use "
+           "in a JSON report.\n"
+           "  -loops : number of timed runs of each operation (default: 1).\n");
     exit(1);
 }
 
@@ -128,19 +142,170 @@ static void TortureBand( GDALRasterBandH hBand, int /* bReadWriteOperations */,
     // GDALCreateMaskBand
 }
 
+/************************************************************************/
+/*                         BenchmarkOperation()                         */
+/************************************************************************/
+
+// Runs oFunc nLoops times, and appends its timings to oOperations. oFunc
+// returns the number of items it processed, or -1 on failure.
+static void BenchmarkOperation( CPLJSONArray& oOperations,
+                                const char* pszOperation, int nLoops,
+                                const std::function<GIntBig()>& oFunc )
+{
+    std::vector<double> adfTimes;
+    GIntBig nItems = 0;
+    for( int iLoop = 0; iLoop < nLoops; iLoop++ )
+    {
+        const auto oStart = std::chrono::steady_clock::now();
+        nItems = oFunc();
+        const std::chrono::duration<double> oElapsed =
+            std::chrono::steady_clock::now() - oStart;
+        if( nItems < 0 )
+            return;
+        adfTimes.push_back(oElapsed.count());
+    }
+    std::sort(adfTimes.begin(), adfTimes.end());
+    const size_t nCount = adfTimes.size();
+
+    CPLJSONObject oOperation;
+    oOperation.Add("name", pszOperation);
+    oOperation.Add("iterations", static_cast<int>(nCount));
+    oOperation.Add("min_s", adfTimes.front());
+    oOperation.Add("median_s", (nCount % 2) ?
+        adfTimes[nCount / 2] :
+        (adfTimes[nCount / 2 - 1] + adfTimes[nCount / 2]) / 2);
+    oOperation.Add("max_s", adfTimes.back());
+    oOperation.Add("items", static_cast<GInt64>(nItems));
+    oOperations.Add(oOperation);
+}
+
+/************************************************************************/
+/*                          BenchmarkRasterIO()                         */
+/************************************************************************/
+
+// Reads of centered windows of the first band, and a decimated read of
+// the whole band that may be served by overviews. The block cache is
+// flushed before each run, so that the driver is timed.
+static void BenchmarkRasterIO( GDALDatasetH hDS, CPLJSONArray& oOperations,
+                               int nLoops )
+{
+    GDALRasterBandH hBand = GDALGetRasterBand(hDS, 1);
+    if( hBand == nullptr )
+        return;
+    const int nXSize = GDALGetRasterBandXSize(hBand);
+    const int nYSize = GDALGetRasterBandYSize(hBand);
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    GDALGetBlockSize(hBand, &nBlockXSize, &nBlockYSize);
+    const GDALDataType eDT = GDALGetRasterDataType(hBand);
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+
+    const auto ReadWindow =
+        [hBand, eDT, nDTSize](int nXOff, int nYOff, int nWinXSize,
+                              int nWinYSize, int nBufXSize, int nBufYSize)
+    {
+        GDALFlushRasterCache(hBand);
+        void* pBuffer = VSI_MALLOC3_VERBOSE(nBufXSize, nBufYSize, nDTSize);
+        if( pBuffer == nullptr )
+            return static_cast<GIntBig>(-1);
+        const CPLErr eErr =
+            GDALRasterIO(hBand, GF_Read, nXOff, nYOff, nWinXSize, nWinYSize,
+                         pBuffer, nBufXSize, nBufYSize, eDT, 0, 0);
+        VSIFree(pBuffer);
+        return eErr == CE_None ?
+            static_cast<GIntBig>(nBufXSize) * nBufYSize :
+            static_cast<GIntBig>(-1);
+    };
+
+    // Window sizes clamped to the raster size, without duplicates.
+    std::vector<std::pair<int, int>> aoWindows;
+    for( const int nSize : { 1, std::max(nBlockXSize, nBlockYSize),
+                             256, 1024, 4096 } )
+    {
+        const std::pair<int, int> oWindow(std::min(nSize, nXSize),
+                                          std::min(nSize, nYSize));
+        if( oWindow.first > 0 && oWindow.second > 0 &&
+            std::find(aoWindows.begin(), aoWindows.end(), oWindow) ==
+                aoWindows.end() )
+            aoWindows.push_back(oWindow);
+    }
+    std::sort(aoWindows.begin(), aoWindows.end());
+    for( const auto& oWindow : aoWindows )
+    {
+        const int nWinXSize = oWindow.first;
+        const int nWinYSize = oWindow.second;
+        const int nXOff = (nXSize - nWinXSize) / 2;
+        const int nYOff = (nYSize - nWinYSize) / 2;
+        BenchmarkOperation(oOperations,
+                           CPLSPrintf("rasterio_%dx%d", nWinXSize, nWinYSize),
+                           nLoops,
+            [&ReadWindow, nXOff, nYOff, nWinXSize, nWinYSize]()
+            {
+                return ReadWindow(nXOff, nYOff, nWinXSize, nWinYSize,
+                                  nWinXSize, nWinYSize);
+            });
+    }
+
+    if( nXSize > 256 || nYSize > 256 )
+    {
+        const double dfRatio =
+            std::max(nXSize, nYSize) / 256.0;
+        const int nBufXSize =
+            std::max(1, static_cast<int>(nXSize / dfRatio));
+        const int nBufYSize =
+            std::max(1, static_cast<int>(nYSize / dfRatio));
+        BenchmarkOperation(oOperations, "rasterio_decimated_256", nLoops,
+            [&ReadWindow, nXSize, nYSize, nBufXSize, nBufYSize]()
+            {
+                return ReadWindow(0, 0, nXSize, nYSize,
+                                  nBufXSize, nBufYSize);
+            });
+    }
+}
+
 /************************************************************************/
 /*                              TortureDS()                             */
 /************************************************************************/
 
-static void TortureDS( const char *pszTarget, bool bReadWriteOperations )
+static void TortureDS( const char *pszTarget, bool bReadWriteOperations,
+                       CPLJSONArray* poReport, int nLoops )
 {
     // hDS = GDALOpen(pszTarget, GA_Update);
     // GDALClose(hDS);
 
-    GDALDatasetH hDS = GDALOpen(pszTarget, GA_ReadOnly);
+    CPLJSONArray oOperations;
+    GDALDatasetH hDS = nullptr;
+    if( poReport )
+    {
+        // The datasets of the previous runs are closed once done, so that
+        // closing is not timed.
+        std::vector<GDALDatasetH> ahDS;
+        BenchmarkOperation(oOperations, "open", nLoops,
+            [pszTarget, &ahDS]()
+            {
+                GDALDatasetH hNewDS = GDALOpen(pszTarget, GA_ReadOnly);
+                if( hNewDS == nullptr )
+                    return static_cast<GIntBig>(-1);
+                ahDS.push_back(hNewDS);
+                return static_cast<GIntBig>(1);
+            });
+        if( !ahDS.empty() )
+        {
+            hDS = ahDS.back();
+            ahDS.pop_back();
+        }
+        for( GDALDatasetH hPrevDS : ahDS )
+            GDALClose(hPrevDS);
+    }
+    else
+    {
+        hDS = GDALOpen(pszTarget, GA_ReadOnly);
+    }
     if( hDS == nullptr )
         return;
 
+    const auto oStart = std::chrono::steady_clock::now();
+
     // GDALGetMetadata(GDALMajorObjectH, const char *);
     // GDALSetMetadata(GDALMajorObjectH, char **, const char *);
     // GDALGetMetadataItem(GDALMajorObjectH, const char *, const char *);
@@ -185,6 +350,37 @@ static void TortureDS( const char *pszTarget, bool bReadWriteOperations )
         TortureBand(hBand, bReadWriteOperations, 0);
     }
 
+    if( poReport )
+    {
+        // The API sweep above computes statistics, so it is timed once.
+        const std::chrono::duration<double> oElapsed =
+            std::chrono::steady_clock::now() - oStart;
+        CPLJSONObject oOperation;
+        oOperation.Add("name", "torture");
+        oOperation.Add("iterations", 1);
+        oOperation.Add("min_s", oElapsed.count());
+        oOperation.Add("median_s", oElapsed.count());
+        oOperation.Add("max_s", oElapsed.count());
+        oOperation.Add("items", nBands);
+        oOperations.Add(oOperation);
+
+        BenchmarkRasterIO(hDS, oOperations, nLoops);
+
+        CPLJSONObject oDataset;
+        oDataset.Add("name", pszTarget);
+        GDALDriverH hDriver = GDALGetDatasetDriver(hDS);
+        if( hDriver )
+            oDataset.Add("driver", GDALGetDriverShortName(hDriver));
+        oDataset.Add("width", nXSize);
+        oDataset.Add("height", nYSize);
+        oDataset.Add("bands", nBands);
+        oDataset.Add("operations", oOperations);
+        const GIntBig nPeakRSS = GetPeakRSS();
+        if( nPeakRSS >= 0 )
+            oDataset.Add("peak_rss_bytes", static_cast<GInt64>(nPeakRSS));
+        poReport->Add(oDataset);
+    }
+
     GDALClose(hDS);
 }
 
@@ -195,14 +391,15 @@ static void TortureDS( const char *pszTarget, bool bReadWriteOperations )
 static void ProcessTortureTarget( const char *pszTarget,
                                   char **papszSiblingList,
                                   bool bRecursive, bool bReportFailures,
-                                  bool bReadWriteOperations )
+                                  bool bReadWriteOperations,
+                                  CPLJSONArray* poReport, int nLoops )
 {
     GDALDriverH hDriver = GDALIdentifyDriver(pszTarget, papszSiblingList);
 
     if( hDriver != nullptr )
     {
         printf("%s: %s\n", pszTarget, GDALGetDriverShortName(hDriver));
-        TortureDS(pszTarget, bReadWriteOperations);
+        TortureDS(pszTarget, bReadWriteOperations, poReport, nLoops);
     }
     else if( bReportFailures )
     {
@@ -228,7 +425,8 @@ static void ProcessTortureTarget( const char *pszTarget,
             CPLFormFilename(pszTarget, papszSiblingList[i], nullptr);
 
         ProcessTortureTarget(osSubTarget, papszSiblingList,
-                             bRecursive, bReportFailures, bReadWriteOperations);
+                             bRecursive, bReportFailures, bReadWriteOperations,
+                             poReport, nLoops);
     }
     CSLDestroy(papszSiblingList);
 }
@@ -257,6 +455,8 @@ int main( int argc, char **argv )
     bool bRecursive = false;
     bool bReportFailures = false;
     bool bReadWriteOperations = false;
+    const char* pszBenchmarkReport = nullptr;
+    int nLoops = 1;
 
     while( argc > 0 && papszArgv[0][0] == '-' )
     {
@@ -266,6 +466,18 @@ int main( int argc, char **argv )
             bReportFailures = true;
         else if( EQUAL(papszArgv[0], "-rw") )
             bReadWriteOperations = true;
+        else if( EQUAL(papszArgv[0], "-benchmark") && argc > 1 )
+        {
+            pszBenchmarkReport = papszArgv[1];
+            papszArgv++;
+            argc--;
+        }
+        else if( EQUAL(papszArgv[0], "-loops") && argc > 1 )
+        {
+            nLoops = std::max(1, atoi(papszArgv[1]));
+            papszArgv++;
+            argc--;
+        }
         else
             Usage();
 
@@ -276,19 +488,39 @@ int main( int argc, char **argv )
 /* -------------------------------------------------------------------- */
 /*      Process given files.                                            */
 /* -------------------------------------------------------------------- */
+    CPLJSONDocument oDoc;
+    CPLJSONArray oDatasets;
     while( argc > 0 )
     {
         ProcessTortureTarget(papszArgv[0], nullptr,
-                             bRecursive, bReportFailures, bReadWriteOperations);
+                             bRecursive, bReportFailures, bReadWriteOperations,
+                             pszBenchmarkReport ? &oDatasets : nullptr,
+                             nLoops);
         argc--;
         papszArgv++;
     }
 
+    int nRet = 0;
+    if( pszBenchmarkReport )
+    {
+        CPLJSONObject oRoot = oDoc.GetRoot();
+        oRoot.Add("gdal_version", GDALVersionInfo("RELEASE_NAME"));
+        oRoot.Add("gdal_build_info", GDALVersionInfo("BUILD_INFO"));
+        oRoot.Add("cache_max", static_cast<GInt64>(GDALGetCacheMax64()));
+        oRoot.Add("loops", nLoops);
+        oRoot.Add("datasets", oDatasets);
+        const GIntBig nPeakRSS = GetPeakRSS();
+        if( nPeakRSS >= 0 )
+            oRoot.Add("peak_rss_bytes", static_cast<GInt64>(nPeakRSS));
+        if( !oDoc.Save(pszBenchmarkReport) )
+            nRet = 1;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
     CSLDestroy(argv);
     GDALDestroyDriverManager();
 
-    return 0;
+    return nRet;
 }
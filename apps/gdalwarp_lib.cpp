@@ -1943,6 +1943,31 @@ GDALDatasetH GDALWarp( const char *pszDest, GDALDatasetH hDstDS, int nSrcCount,
             }
         }
 
+/* -------------------------------------------------------------------- */
+/*      When creating a tiled compressed GeoTIFF file from a single     */
+/*      source, warp and flush it tile row by tile row so that tiles    */
+/*      are written once and in file order.                             */
+/* -------------------------------------------------------------------- */
+        if( psOptions->bCreateOutput && iSrc == 0 && nSrcCount == 1 &&
+            psOptions->pszFormat != nullptr &&
+            EQUAL(psOptions->pszFormat, "GTiff") &&
+            CPLFetchBool(psOptions->papszCreateOptions, "TILED", false) &&
+            CSLFetchNameValue(psOptions->papszCreateOptions,
+                              "COMPRESS") != nullptr &&
+            !EQUAL(CSLFetchNameValue(psOptions->papszCreateOptions,
+                                     "COMPRESS"), "NONE") &&
+            CSLFetchNameValue(psWO->papszWarpOptions,
+                              "TILE_ORDERED_OUTPUT") == nullptr &&
+            CSLFetchNameValue(psWO->papszWarpOptions,
+                              "STREAMABLE_OUTPUT") == nullptr &&
+            CSLFetchNameValue(psWO->papszWarpOptions,
+                              "OPTIMIZE_SIZE") == nullptr )
+        {
+            CPLDebug("GDALWARP", "Defining TILE_ORDERED_OUTPUT=YES");
+            psWO->papszWarpOptions = CSLSetNameValue(
+                psWO->papszWarpOptions, "TILE_ORDERED_OUTPUT", "YES");
+        }
+
 /* -------------------------------------------------------------------- */
 /*      In some cases, RPC evaluation can find valid input pixel for    */
 /*      output pixels that are outside the footprint of the source      */
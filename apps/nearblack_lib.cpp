@@ -38,14 +38,21 @@
 
 #include <algorithm>
 #include <memory>
+#include <new>
 #include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define HAVE_SSE2
+#include "emmintrin.h"
+#endif
+
 CPL_CVSID("$Id: nearblack_lib.cpp 88eda08930b6dafb9ea1374ba19e0b1cf5ded3d3 2018-08-11 20:16:37 +0200 Even Rouault $")
 
 typedef std::vector<int> Color;
@@ -73,11 +80,316 @@ struct GDALNearblackOptions
     char** papszCreationOptions;
 };
 
-static void ProcessLine( GByte *pabyLine, GByte *pabyMask, int iStart,
-                         int iEnd, int nSrcBands, int nDstBands, int nNearDist,
-                         int nMaxNonBlack, bool bNearWhite, Colors *poColors,
-                         int *panLastLineCounts, bool bDoHorizontalCheck,
-                         bool bDoVerticalCheck, bool bBottomUp );
+/************************************************************************/
+/*                          Swath processing.                           */
+/*                                                                      */
+/*      The image is processed by swaths of lines, stored band after    */
+/*      band, in a top-down pass and then a bottom-up pass. Within a    */
+/*      swath, the classification of the pixels and the horizontal      */
+/*      checks are done by bands of lines, and the vertical checks,     */
+/*      which carry per-column state from line to line, by blocks of    */
+/*      columns. Those jobs are run by GDAL_NUM_THREADS threads.        */
+/************************************************************************/
+
+namespace {
+
+struct NearblackSwath
+{
+    int             nXSize = 0;
+    int             nLines = 0;
+    int             nSrcBands = 0;
+    int             nDstBands = 0;
+    int             nNearDist = 0;
+    int             nMaxNonBlack = 0;
+    GByte           nReplaceValue = 0;
+    // Whether a pixel set to nReplaceValue is not near any of the colors.
+    GByte           bReplacedIsNonBlack = FALSE;
+    bool            bBottomUp = false;
+    const Colors   *poColors = nullptr;
+    int            *panLastLineCounts = nullptr;
+
+    std::vector<GByte> abyPixels{};    // nDstBands planes of nLines lines
+    std::vector<GByte> abyMask{};      // empty if no mask band is set
+    std::vector<GByte> abyNonBlack{};  // 1 if the pixel is not near a color
+    // Value of panLastLineCounts after the vertical check of each line.
+    std::vector<int> anLineCounts{};
+
+    GByte          *GetBand( int iBand )
+        { return &abyPixels[static_cast<size_t>(iBand) * nLines * nXSize]; }
+    void            Replace( size_t nIdx );
+};
+
+struct NearblackJob
+{
+    NearblackSwath *psSwath = nullptr;
+    int             nStart = 0;  // first line or column
+    int             nEnd = 0;
+};
+
+} // namespace
+
+void NearblackSwath::Replace( size_t nIdx )
+{
+    const size_t nPlaneSize = static_cast<size_t>(nLines) * nXSize;
+    for( int iBand = 0; iBand < nSrcBands; iBand++ )
+        abyPixels[iBand * nPlaneSize + nIdx] = nReplaceValue;
+
+    /***** alpha *****/
+    if( nDstBands > nSrcBands )
+        abyPixels[(nDstBands - 1) * nPlaneSize + nIdx] = 0;
+
+    /***** mask *****/
+    if( !abyMask.empty() )
+        abyMask[nIdx] = 0;
+
+    abyNonBlack[nIdx] = bReplacedIsNonBlack;
+}
+
+/************************************************************************/
+/*                       NearblackMarkOutside()                         */
+/*                                                                      */
+/*      Set pabyOutside[i] to 1 for the values of pabyBand outside of   */
+/*      [nLow, nHigh], with 0 <= nLow <= nHigh <= 255.                  */
+/************************************************************************/
+
+static void NearblackMarkOutside( const GByte* pabyBand, size_t nCount,
+                                  int nLow, int nHigh, GByte* pabyOutside )
+{
+    size_t i = 0;
+#ifdef HAVE_SSE2
+    const __m128i xmmLow = _mm_set1_epi8(static_cast<char>(nLow));
+    const __m128i xmmHigh = _mm_set1_epi8(static_cast<char>(nHigh));
+    const __m128i xmmOne = _mm_set1_epi8(1);
+    for( ; i + 16 <= nCount; i += 16 )
+    {
+        const __m128i xmmPix = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pabyBand + i));
+        // A value is within the range if clamping it does not change it.
+        const __m128i xmmInside = _mm_cmpeq_epi8(
+            _mm_min_epu8(_mm_max_epu8(xmmPix, xmmLow), xmmHigh), xmmPix);
+        __m128i xmmOutside = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pabyOutside + i));
+        xmmOutside = _mm_or_si128(xmmOutside,
+                                  _mm_andnot_si128(xmmInside, xmmOne));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pabyOutside + i),
+                         xmmOutside);
+    }
+#endif
+    for( ; i < nCount; i++ )
+    {
+        if( pabyBand[i] < nLow || pabyBand[i] > nHigh )
+            pabyOutside[i] = 1;
+    }
+}
+
+/************************************************************************/
+/*                        NearblackClassifyJob()                        */
+/*                                                                      */
+/*      A pixel is non black if, for each color, one of its bands is    */
+/*      farther than nNearDist from the value of the color.             */
+/************************************************************************/
+
+static void NearblackClassifyJob( void* pData )
+{
+    NearblackJob* psJob = static_cast<NearblackJob*>(pData);
+    NearblackSwath* psSwath = psJob->psSwath;
+    const size_t nOffset = static_cast<size_t>(psJob->nStart) * psSwath->nXSize;
+    const size_t nCount =
+        static_cast<size_t>(psJob->nEnd - psJob->nStart) * psSwath->nXSize;
+    GByte* pabyNonBlack = &psSwath->abyNonBlack[nOffset];
+
+    memset(pabyNonBlack, 1, nCount);
+    std::vector<GByte> abyOutside(nCount);
+    for( const Color& oColor : *(psSwath->poColors) )
+    {
+        std::fill(abyOutside.begin(), abyOutside.end(), 0);
+        bool bAllOutside = false;
+        for( int iBand = 0; iBand < psSwath->nSrcBands; iBand++ )
+        {
+            const int nLow = oColor[iBand] - psSwath->nNearDist;
+            const int nHigh = oColor[iBand] + psSwath->nNearDist;
+            if( nLow > nHigh || nLow > 255 || nHigh < 0 )
+            {
+                bAllOutside = true;
+                break;
+            }
+            NearblackMarkOutside(psSwath->GetBand(iBand) + nOffset, nCount,
+                                 std::max(nLow, 0), std::min(nHigh, 255),
+                                 &abyOutside[0]);
+        }
+        if( bAllOutside )
+            continue;
+
+        for( size_t i = 0; i < nCount; i++ )
+            pabyNonBlack[i] &= abyOutside[i];
+    }
+}
+
+/************************************************************************/
+/*                        NearblackVerticalJob()                        */
+/************************************************************************/
+
+static void NearblackVerticalJob( void* pData )
+{
+    NearblackJob* psJob = static_cast<NearblackJob*>(pData);
+    NearblackSwath* psSwath = psJob->psSwath;
+    const int nXSize = psSwath->nXSize;
+    const int nMaxNonBlack = psSwath->nMaxNonBlack;
+    int* panLastLineCounts = psSwath->panLastLineCounts;
+
+    for( int iLine = 0; iLine < psSwath->nLines; iLine++ )
+    {
+        const int iRow =
+            psSwath->bBottomUp ? psSwath->nLines - 1 - iLine : iLine;
+        const size_t nRowOffset = static_cast<size_t>(iRow) * nXSize;
+        for( int i = psJob->nStart; i < psJob->nEnd; i++ )
+        {
+            // are we already terminated for this column?
+            if( panLastLineCounts[i] <= nMaxNonBlack )
+            {
+                if( psSwath->abyNonBlack[nRowOffset + i] )
+                    panLastLineCounts[i]++;
+
+                /***** replace the pixel values *****/
+                if( panLastLineCounts[i] <= nMaxNonBlack )
+                    psSwath->Replace(nRowOffset + i);
+            }
+            psSwath->anLineCounts[nRowOffset + i] = panLastLineCounts[i];
+        }
+    }
+}
+
+/************************************************************************/
+/*                            ProcessLine()                             */
+/*                                                                      */
+/*      Horizontal check of a line of a swath, from iStart to iEnd      */
+/*      excluded, after the vertical check of the line.                 */
+/************************************************************************/
+
+static void ProcessLine( NearblackSwath* psSwath, int iRow,
+                         int iStart, int iEnd )
+{
+    const size_t nRowOffset = static_cast<size_t>(iRow) * psSwath->nXSize;
+    const int* panLastLineCounts = &psSwath->anLineCounts[nRowOffset];
+
+    /***** on a bottom up pass assume nMaxNonBlack is 0 *****/
+
+    const int nMaxNonBlack = psSwath->bBottomUp ? 0 : psSwath->nMaxNonBlack;
+
+    int nNonBlackPixels = 0;
+    const int iDir = iStart < iEnd ? 1 : -1;
+    bool bDoTest = true;
+
+    for( int i = iStart; i != iEnd; i += iDir )
+    {
+        /***** not seen any valid data? *****/
+
+        if( bDoTest )
+        {
+            if( psSwath->abyNonBlack[nRowOffset + i] )
+            {
+                /***** use nNonBlackPixels in grey areas  *****/
+                /***** from the vertical pass's grey areas ****/
+
+                if( panLastLineCounts[i] <= nMaxNonBlack )
+                    nNonBlackPixels = panLastLineCounts[i];
+                else
+                    nNonBlackPixels++;
+            }
+
+            if( nNonBlackPixels > nMaxNonBlack )
+            {
+                bDoTest = false;
+                continue;
+            }
+
+            /***** replace the pixel values *****/
+
+            psSwath->Replace(nRowOffset + i);
+        }
+
+        /***** seen valid data but test if the *****/
+        /***** vertical pass saw any non valid data *****/
+
+        else if( panLastLineCounts[i] == 0 )
+        {
+            bDoTest = true;
+            nNonBlackPixels = 0;
+        }
+    }
+}
+
+/************************************************************************/
+/*                       NearblackHorizontalJob()                       */
+/************************************************************************/
+
+static void NearblackHorizontalJob( void* pData )
+{
+    NearblackJob* psJob = static_cast<NearblackJob*>(pData);
+    NearblackSwath* psSwath = psJob->psSwath;
+    const int nXSize = psSwath->nXSize;
+    for( int iRow = psJob->nStart; iRow < psJob->nEnd; iRow++ )
+    {
+        ProcessLine(psSwath, iRow, 0, nXSize - 1);
+        ProcessLine(psSwath, iRow, nXSize - 1, 0);
+    }
+}
+
+/************************************************************************/
+/*                         NearblackRunJobs()                           */
+/*                                                                      */
+/*      Run pfnFunc on nSize lines or columns of the swath, split in    */
+/*      one job per thread, in nAlign multiples.                        */
+/************************************************************************/
+
+static void NearblackRunJobs( CPLJobQueue* poQueue, int nThreads,
+                              CPLThreadFunc pfnFunc,
+                              NearblackSwath* psSwath, int nSize, int nAlign )
+{
+    if( poQueue == nullptr )
+        nThreads = 1;
+    int nChunk = (nSize + nThreads - 1) / nThreads;
+    nChunk = ((nChunk + nAlign - 1) / nAlign) * nAlign;
+    std::vector<NearblackJob> asJobs;
+    for( int nStart = 0; nStart < nSize; nStart += nChunk )
+    {
+        NearblackJob sJob;
+        sJob.psSwath = psSwath;
+        sJob.nStart = nStart;
+        sJob.nEnd = std::min(nSize, nStart + nChunk);
+        asJobs.push_back(sJob);
+    }
+
+    if( poQueue == nullptr || asJobs.size() == 1 )
+    {
+        for( auto& sJob : asJobs )
+            pfnFunc(&sJob);
+        return;
+    }
+
+    for( auto& sJob : asJobs )
+    {
+        if( !poQueue->SubmitJob(pfnFunc, &sJob) )
+            pfnFunc(&sJob);
+    }
+    poQueue->WaitCompletion();
+}
+
+/************************************************************************/
+/*                        NearblackProcessSwath()                       */
+/************************************************************************/
+
+static void NearblackProcessSwath( CPLJobQueue* poQueue, int nThreads,
+                                   NearblackSwath* psSwath )
+{
+    NearblackRunJobs(poQueue, nThreads, NearblackClassifyJob, psSwath,
+                     psSwath->nLines, 1);
+    // Blocks of columns are multiples of 64 to avoid false sharing.
+    NearblackRunJobs(poQueue, nThreads, NearblackVerticalJob, psSwath,
+                     psSwath->nXSize, 64);
+    NearblackRunJobs(poQueue, nThreads, NearblackHorizontalJob, psSwath,
+                     psSwath->nLines, 1);
+}
 
 /************************************************************************/
 /*                            GDALNearblack()                           */
@@ -337,29 +649,82 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
     }
 
 /* -------------------------------------------------------------------- */
-/*      Allocate a line buffer.                                         */
+/*      Allocate a swath buffer.                                        */
 /* -------------------------------------------------------------------- */
+    const int nThreads = CPLGetNumThreads();
+    std::unique_ptr<CPLJobQueue> poQueue;
+    if( nThreads > 1 )
+    {
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poPool != nullptr )
+            poQueue = poPool->CreateJobQueue();
+    }
 
-    GByte *pabyLine = static_cast<GByte *>(CPLMalloc(nXSize * nDstBands));
+    // Swaths of at most 256 lines and around 32 MB.
+    const GIntBig nBytesPerLine = static_cast<GIntBig>(nXSize) *
+        (nDstBands + 2 + sizeof(int));
+    const int nSwathLines = static_cast<int>(std::max(GIntBig(1),
+        std::min(std::min(GIntBig(256), static_cast<GIntBig>(nYSize)),
+                 GIntBig(32 * 1024 * 1024) / nBytesPerLine)));
+
+    NearblackSwath sSwath;
+    sSwath.nXSize = nXSize;
+    sSwath.nSrcBands = nBands;
+    sSwath.nDstBands = nDstBands;
+    sSwath.nNearDist = nNearDist;
+    sSwath.nMaxNonBlack = nMaxNonBlack;
+    sSwath.nReplaceValue = bNearWhite ? 255 : 0;
+    sSwath.poColors = &oColors;
+
+    // Class of the replaced pixels, for the checks after the replacement.
+    {
+        NearblackSwath sReplaced(sSwath);
+        sReplaced.nXSize = 1;
+        sReplaced.nLines = 1;
+        sReplaced.abyPixels.assign(nDstBands, sSwath.nReplaceValue);
+        sReplaced.abyNonBlack.resize(1);
+        NearblackJob sJob;
+        sJob.psSwath = &sReplaced;
+        sJob.nEnd = 1;
+        NearblackClassifyJob(&sJob);
+        sSwath.bReplacedIsNonBlack = sReplaced.abyNonBlack[0];
+    }
 
-    GByte *pabyMask = nullptr;
-    if( bSetMask )
-        pabyMask = static_cast<GByte *>(CPLMalloc(nXSize));
+    try
+    {
+        const size_t nSwathSize = static_cast<size_t>(nSwathLines) * nXSize;
+        sSwath.abyPixels.resize(nSwathSize * nDstBands);
+        if( bSetMask )
+            sSwath.abyMask.resize(nSwathSize);
+        sSwath.abyNonBlack.resize(nSwathSize);
+        sSwath.anLineCounts.resize(nSwathSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate swath buffer");
+        if( bCloseOutDSOnError )
+            GDALClose(hDstDS);
+        return nullptr;
+    }
 
-    int *panLastLineCounts = static_cast<int *>(CPLCalloc(sizeof(int), nXSize));
+    std::vector<int> anLastLineCounts(nXSize);
+    sSwath.panLastLineCounts = &anLastLineCounts[0];
 
 /* -------------------------------------------------------------------- */
-/*      Processing data one line at a time.                             */
+/*      Processing data one swath at a time.                            */
 /* -------------------------------------------------------------------- */
-    int iLine;
-
-    for( iLine = 0; iLine < nYSize; iLine++ )
+    for( int iLine = 0; iLine < nYSize; iLine += nSwathLines )
     {
+        const int nLines = std::min(nSwathLines, nYSize - iLine);
+        const size_t nSwathSize = static_cast<size_t>(nLines) * nXSize;
+        sSwath.nLines = nLines;
+        sSwath.bBottomUp = false;
+
         CPLErr eErr =
-            GDALDatasetRasterIO(hSrcDataset, GF_Read, 0, iLine, nXSize, 1,
-                                pabyLine, nXSize, 1, GDT_Byte,
-                                nBands, nullptr, nDstBands,
-                                nXSize * nDstBands, 1);
+            GDALDatasetRasterIO(hSrcDataset, GF_Read, 0, iLine, nXSize, nLines,
+                                &sSwath.abyPixels[0], nXSize, nLines, GDT_Byte,
+                                nBands, nullptr, 1, nXSize, nSwathSize);
         if( eErr != CE_None )
         {
             if( bCloseOutDSOnError )
@@ -370,39 +735,20 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
 
         if( bSetAlpha )
         {
-            for( int iCol = 0; iCol < nXSize; iCol++ )
-            {
-                pabyLine[iCol * nDstBands + nDstBands - 1] = 255;
-            }
+            memset(sSwath.GetBand(nDstBands - 1), 255, nSwathSize);
         }
 
         if( bSetMask )
         {
-            for( int iCol = 0; iCol < nXSize; iCol ++ )
-            {
-                pabyMask[iCol] = 255;
-            }
+            memset(&sSwath.abyMask[0], 255, nSwathSize);
         }
 
-        ProcessLine(pabyLine, pabyMask, 0, nXSize-1, nBands, nDstBands,
-                    nNearDist, nMaxNonBlack, bNearWhite, &oColors,
-                    panLastLineCounts,
-                    true, // bDoHorizontalCheck
-                    true, // bDoVerticalCheck
-                    false // bBottomUp
-                    );
-        ProcessLine(pabyLine, pabyMask, nXSize-1, 0, nBands, nDstBands,
-                    nNearDist, nMaxNonBlack, bNearWhite, &oColors,
-                    panLastLineCounts,
-                    true,  // bDoHorizontalCheck
-                    false, // bDoVerticalCheck
-                    false  // bBottomUp
-                    );
-
-        eErr = GDALDatasetRasterIO(hDstDS, GF_Write, 0, iLine, nXSize, 1,
-                                   pabyLine, nXSize, 1, GDT_Byte,
-                                   nDstBands, nullptr, nDstBands,
-                                   nXSize * nDstBands, 1);
+        NearblackProcessSwath(poQueue.get(), nThreads, &sSwath);
+
+        eErr = GDALDatasetRasterIO(hDstDS, GF_Write, 0, iLine, nXSize, nLines,
+                                   &sSwath.abyPixels[0], nXSize, nLines,
+                                   GDT_Byte, nDstBands, nullptr,
+                                   1, nXSize, nSwathSize);
 
         if( eErr != CE_None )
         {
@@ -412,12 +758,12 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
             break;
         }
 
-        /***** write out the mask band line *****/
+        /***** write out the mask band lines *****/
 
         if( bSetMask )
         {
-            eErr = GDALRasterIO (hMaskBand, GF_Write, 0, iLine, nXSize, 1,
-                                 pabyMask, nXSize, 1, GDT_Byte,
+            eErr = GDALRasterIO (hMaskBand, GF_Write, 0, iLine, nXSize, nLines,
+                                 &sSwath.abyMask[0], nXSize, nLines, GDT_Byte,
                                  0, 0);
             if( eErr != CE_None )
             {
@@ -431,8 +777,8 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
         }
 
         if( !(psOptions->pfnProgress(
-                  0.5 * ((iLine+1) / static_cast<double>(nYSize)), nullptr,
-                  psOptions->pProgressData)) )
+                  0.5 * ((iLine+nLines) / static_cast<double>(nYSize)),
+                  nullptr, psOptions->pProgressData)) )
         {
             if( bCloseOutDSOnError )
                 GDALClose(hDstDS);
@@ -444,15 +790,21 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
 /* -------------------------------------------------------------------- */
 /*      Now process from the bottom back up                            .*/
 /* -------------------------------------------------------------------- */
-    memset(panLastLineCounts, 0, sizeof(int) * nXSize);
+    std::fill(anLastLineCounts.begin(), anLastLineCounts.end(), 0);
 
-    for( iLine = nYSize-1; hDstDS != nullptr && iLine >= 0; iLine-- )
+    for( int iLineEnd = nYSize; hDstDS != nullptr && iLineEnd > 0;
+         iLineEnd -= nSwathLines )
     {
+        const int nLines = std::min(nSwathLines, iLineEnd);
+        const int iLine = iLineEnd - nLines;
+        const size_t nSwathSize = static_cast<size_t>(nLines) * nXSize;
+        sSwath.nLines = nLines;
+        sSwath.bBottomUp = true;
+
         CPLErr eErr =
-            GDALDatasetRasterIO(hDstDS, GF_Read, 0, iLine, nXSize, 1,
-                                pabyLine, nXSize, 1, GDT_Byte,
-                                nDstBands, nullptr, nDstBands,
-                                nXSize * nDstBands, 1 );
+            GDALDatasetRasterIO(hDstDS, GF_Read, 0, iLine, nXSize, nLines,
+                                &sSwath.abyPixels[0], nXSize, nLines, GDT_Byte,
+                                nDstBands, nullptr, 1, nXSize, nSwathSize);
         if( eErr != CE_None )
         {
             if( bCloseOutDSOnError )
@@ -461,12 +813,12 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
             break;
         }
 
-        /***** read the mask band line back in *****/
+        /***** read the mask band lines back in *****/
 
         if( bSetMask )
         {
-            eErr = GDALRasterIO(hMaskBand, GF_Read, 0, iLine, nXSize, 1,
-                                pabyMask, nXSize, 1, GDT_Byte,
+            eErr = GDALRasterIO(hMaskBand, GF_Read, 0, iLine, nXSize, nLines,
+                                &sSwath.abyMask[0], nXSize, nLines, GDT_Byte,
                                 0, 0);
             if( eErr != CE_None )
             {
@@ -477,25 +829,12 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
             }
         }
 
-        ProcessLine(pabyLine, pabyMask, 0, nXSize-1, nBands, nDstBands,
-                    nNearDist, nMaxNonBlack, bNearWhite, &oColors,
-                    panLastLineCounts,
-                    true, // bDoHorizontalCheck
-                    true, // bDoVerticalCheck
-                    true  // bBottomUp
-                    );
-        ProcessLine(pabyLine, pabyMask, nXSize-1, 0, nBands, nDstBands,
-                    nNearDist, nMaxNonBlack, bNearWhite, &oColors,
-                    panLastLineCounts,
-                    true,  // bDoHorizontalCheck
-                    false, // bDoVerticalCheck
-                    true   // bBottomUp
-                    );
-
-        eErr = GDALDatasetRasterIO(hDstDS, GF_Write, 0, iLine, nXSize, 1,
-                                   pabyLine, nXSize, 1, GDT_Byte,
-                                   nDstBands, nullptr, nDstBands,
-                                   nXSize * nDstBands, 1);
+        NearblackProcessSwath(poQueue.get(), nThreads, &sSwath);
+
+        eErr = GDALDatasetRasterIO(hDstDS, GF_Write, 0, iLine, nXSize, nLines,
+                                   &sSwath.abyPixels[0], nXSize, nLines,
+                                   GDT_Byte, nDstBands, nullptr,
+                                   1, nXSize, nSwathSize);
         if( eErr != CE_None )
         {
             if( bCloseOutDSOnError )
@@ -504,12 +843,12 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
             break;
         }
 
-        /***** write out the mask band line *****/
+        /***** write out the mask band lines *****/
 
         if( bSetMask )
         {
-            eErr = GDALRasterIO (hMaskBand, GF_Write, 0, iLine, nXSize, 1,
-                                 pabyMask, nXSize, 1, GDT_Byte,
+            eErr = GDALRasterIO (hMaskBand, GF_Write, 0, iLine, nXSize, nLines,
+                                 &sSwath.abyMask[0], nXSize, nLines, GDT_Byte,
                                  0, 0);
             if( eErr != CE_None )
             {
@@ -530,196 +869,9 @@ GDALDatasetH CPL_DLL GDALNearblack( const char *pszDest, GDALDatasetH hDstDS,
         }
     }
 
-    CPLFree(pabyLine);
-    if( bSetMask )
-        CPLFree(pabyMask);
-
-    CPLFree( panLastLineCounts );
-
     return hDstDS;
 }
 
-/************************************************************************/
-/*                            ProcessLine()                             */
-/*                                                                      */
-/*      Process a single scanline of image data.                        */
-/************************************************************************/
-
-static void ProcessLine( GByte *pabyLine, GByte *pabyMask, int iStart,
-                         int iEnd, int nSrcBands, int nDstBands, int nNearDist,
-                         int nMaxNonBlack, bool bNearWhite, Colors *poColors,
-                         int *panLastLineCounts, bool bDoHorizontalCheck,
-                         bool bDoVerticalCheck, bool bBottomUp )
-{
-    const GByte nReplacevalue = bNearWhite ? 255 : 0;
-
-    /* -------------------------------------------------------------------- */
-    /*      Vertical checking.                                              */
-    /* -------------------------------------------------------------------- */
-
-    if( bDoVerticalCheck )
-    {
-        const int nXSize = std::max(iStart + 1, iEnd + 1);
-
-        for( int i = 0; i < nXSize; i++ )
-        {
-            // are we already terminated for this column?
-            if( panLastLineCounts[i] > nMaxNonBlack )
-                continue;
-
-            /***** is the pixel valid data? ****/
-
-            bool bIsNonBlack = false;
-
-            /***** loop over the colors *****/
-
-            for( int iColor = 0; iColor < static_cast<int>(poColors->size() );
-                 iColor++) {
-
-                Color oColor = (*poColors)[iColor];
-
-                bIsNonBlack = false;
-
-                /***** loop over the bands *****/
-
-                for( int iBand = 0; iBand < nSrcBands; iBand++ )
-                {
-                    const int nPix = pabyLine[i * nDstBands + iBand];
-
-                    if( oColor[iBand] - nPix > nNearDist ||
-                        nPix > nNearDist + oColor[iBand] )
-                    {
-                        bIsNonBlack = true;
-                        break;
-                    }
-                }
-
-                if( !bIsNonBlack )
-                    break;
-            }
-
-            if( bIsNonBlack )
-            {
-                panLastLineCounts[i]++;
-
-                if( panLastLineCounts[i] > nMaxNonBlack )
-                    continue;
-            }
-            //else
-            //  panLastLineCounts[i] = 0; // not sure this even makes sense
-
-            /***** replace the pixel values *****/
-            for( int iBand = 0; iBand < nSrcBands; iBand++ )
-                pabyLine[i * nDstBands + iBand] = nReplacevalue;
-
-            /***** alpha *****/
-            if( nDstBands > nSrcBands )
-                pabyLine[i * nDstBands + nDstBands - 1] = 0;
-
-            /***** mask *****/
-            if (pabyMask != nullptr)
-                pabyMask[i] = 0;
-        }
-    }
-
-    /* -------------------------------------------------------------------- */
-    /*      Horizontal Checking.                                            */
-    /* -------------------------------------------------------------------- */
-
-    if( bDoHorizontalCheck )
-    {
-        int nNonBlackPixels = 0;
-
-        /***** on a bottom up pass assume nMaxNonBlack is 0 *****/
-
-        if( bBottomUp )
-            nMaxNonBlack = 0;
-
-        const int iDir = iStart < iEnd ? 1 : -1;
-
-        bool bDoTest = TRUE;
-
-        for( int i = iStart; i != iEnd; i += iDir )
-        {
-            /***** not seen any valid data? *****/
-
-            if( bDoTest )
-            {
-                /***** is the pixel valid data? ****/
-
-                bool bIsNonBlack = false;
-
-                /***** loop over the colors *****/
-
-                for( int iColor = 0;
-                     iColor < static_cast<int>(poColors->size()); iColor++ ) {
-
-                    Color oColor = (*poColors)[iColor];
-
-                    bIsNonBlack = false;
-
-                    /***** loop over the bands *****/
-
-                    for( int iBand = 0; iBand < nSrcBands; iBand++ )
-                    {
-                        const int nPix = pabyLine[i * nDstBands + iBand];
-
-                        if( oColor[iBand] - nPix > nNearDist ||
-                            nPix > nNearDist + oColor[iBand] )
-                        {
-                            bIsNonBlack = true;
-                            break;
-                        }
-                    }
-
-                    if( bIsNonBlack == false )
-                        break;
-                }
-
-                if( bIsNonBlack )
-                {
-                    /***** use nNonBlackPixels in grey areas  *****/
-                    /***** from the vertical pass's grey areas ****/
-
-                    if( panLastLineCounts[i] <= nMaxNonBlack )
-                        nNonBlackPixels = panLastLineCounts[i];
-                    else
-                        nNonBlackPixels++;
-                }
-
-                if( nNonBlackPixels > nMaxNonBlack ) {
-                    bDoTest = false;
-                    continue;
-                }
-
-                /***** replace the pixel values *****/
-
-                for( int iBand = 0; iBand < nSrcBands; iBand++ )
-                    pabyLine[i * nDstBands + iBand] = nReplacevalue;
-
-                /***** alpha *****/
-
-                if( nDstBands > nSrcBands )
-                    pabyLine[i * nDstBands + nDstBands - 1] = 0;
-
-                /***** mask *****/
-
-                if (pabyMask != nullptr)
-                    pabyMask[i] = 0;
-            }
-
-            /***** seen valid data but test if the *****/
-            /***** vertical pass saw any non valid data *****/
-
-            else if( panLastLineCounts[i] == 0 )
-            {
-                bDoTest = true;
-                nNonBlackPixels = 0;
-            }
-        }
-    }
-}
-
 /************************************************************************/
 /*                            IsInt()                                   */
 /************************************************************************/
@@ -90,6 +90,7 @@ static void Usage( const char* pszAdditionalMsg = nullptr, bool bShort = true )
         "               [-clipdstwhere expression]\n"
         "               [-wrapdateline][-datelineoffset val]\n"
         "               [[-simplify tolerance] | [-segmentize max_dist]]\n"
+        "               [-makevalid]\n"
         "               [-addfields] [-unsetFid]\n"
         "               [-relaxedFieldNameMatch] [-forceNullable] [-unsetDefault]\n"
         "               [-fieldTypeToString All|(type1[,type2]*)] [-unsetFieldWidth]\n"
@@ -149,6 +150,7 @@ static void Usage( const char* pszAdditionalMsg = nullptr, bool bShort = true )
         " -simplify tolerance: distance tolerance for simplification.\n"
         " -segmentize max_dist: maximum distance between 2 nodes.\n"
         "                       Used to create intermediate points\n"
+        " -makevalid: make geometries valid, using GEOS MakeValid\n"
         " -dsco NAME=VALUE: Dataset creation option (format specific)\n"
         " -lco  NAME=VALUE: Layer creation option (format specific)\n"
         " -oo   NAME=VALUE: Input dataset open option (format specific)\n"
@@ -34,12 +34,17 @@
 
 #include <cassert>
 #include <climits>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_set>
 #include <string>
@@ -52,6 +57,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_alg.h"
 #include "gdal_priv.h"
@@ -193,6 +199,9 @@ struct GDALVectorTranslateOptions
     /*! the parameter to geometric operation */
     double dfGeomOpParam;
 
+    /*! whether to make geometries valid with OGRGeometry::MakeValid() */
+    bool bMakeValid;
+
     /*! list of field types to convert to a field of type string in the destination layer.
         Valid types are: Integer, Integer64, Real, String, Date, Time, DateTime, Binary,
         IntegerList, Integer64List, RealList, StringList. Special value "All" can be
@@ -426,6 +435,7 @@ public:
     int                           m_nCoordDim;
     GeomOperation                 m_eGeomOp;
     double                        m_dfGeomOpParam;
+    bool                          m_bMakeValid;
     OGRGeometry                  *m_poClipSrc;
     OGRGeometry                  *m_poClipDst;
     bool                          m_bExplodeCollections;
@@ -2525,6 +2535,7 @@ GDALDatasetH GDALVectorTranslate( const char *pszDest, GDALDatasetH hDstDS, int
     oTranslator.m_nCoordDim = psOptions->nCoordDim;
     oTranslator.m_eGeomOp = psOptions->eGeomOp;
     oTranslator.m_dfGeomOpParam = psOptions->dfGeomOpParam;
+    oTranslator.m_bMakeValid = psOptions->bMakeValid;
     oTranslator.m_poClipSrc = reinterpret_cast<OGRGeometry*>(psOptions->hClipSrc);
     oTranslator.m_poClipDst = reinterpret_cast<OGRGeometry*>(psOptions->hClipDst);
     oTranslator.m_bExplodeCollections = psOptions->bExplodeCollections;
@@ -4459,6 +4470,161 @@ static bool SetupCT( TargetLayerInfo* psInfo,
     return true;
 }
 
+/************************************************************************/
+/*                           OGR2OGRBatch                               */
+/************************************************************************/
+
+// Error emitted by a pipeline thread, re-emitted by the writing thread.
+struct OGR2OGRBatchError
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+};
+
+// Source features read ahead, with their geometries already processed.
+struct OGR2OGRBatch
+{
+    std::vector<OGRFeatureUniquePtr> apoFeatures{};
+    std::vector<OGRErr> aeCTErrors{};
+    std::vector<bool>   abClippedOut{};  // empty intersection with -clipsrc
+    std::vector<OGR2OGRBatchError> aoErrors{};
+    bool                bEnd = false;      // no more batch after this one
+    bool                bFailure = false;  // reading ended on an error
+};
+
+static void CPL_STDCALL OGR2OGRBatchErrorHandler( CPLErr eErrClass,
+                                                  CPLErrorNum nErrNo,
+                                                  const char* pszMsg )
+{
+    auto paoErrors = static_cast<std::vector<OGR2OGRBatchError>*>(
+                                            CPLGetErrorHandlerUserData());
+    paoErrors->push_back(OGR2OGRBatchError{eErrClass, nErrNo, pszMsg});
+}
+
+/************************************************************************/
+/*                         OGR2OGRBatchQueue                            */
+/************************************************************************/
+
+// Bounded queue of batches between two stages of the pipeline.
+class OGR2OGRBatchQueue
+{
+    static constexpr size_t MAX_BATCHES = 2;
+
+    std::mutex                    m_oMutex{};
+    std::condition_variable       m_oCond{};
+    std::deque<std::unique_ptr<OGR2OGRBatch>> m_apoBatches{};
+    bool                          m_bStop = false;
+
+  public:
+    // Waits for room in the queue. Returns false if the pipeline is stopped.
+    bool Push( std::unique_ptr<OGR2OGRBatch>&& poBatch )
+    {
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        m_oCond.wait(oLock, [this]()
+            { return m_bStop || m_apoBatches.size() < MAX_BATCHES; });
+        if( m_bStop )
+            return false;
+        m_apoBatches.push_back(std::move(poBatch));
+        m_oCond.notify_all();
+        return true;
+    }
+
+    // Waits for a batch. Returns null if the pipeline is stopped.
+    std::unique_ptr<OGR2OGRBatch> Pop()
+    {
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        m_oCond.wait(oLock, [this]()
+            { return m_bStop || !m_apoBatches.empty(); });
+        if( m_bStop )
+            return nullptr;
+        std::unique_ptr<OGR2OGRBatch> poBatch(std::move(m_apoBatches.front()));
+        m_apoBatches.pop_front();
+        m_oCond.notify_all();
+        return poBatch;
+    }
+
+    void Stop()
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        m_bStop = true;
+        m_oCond.notify_all();
+    }
+};
+
+/************************************************************************/
+/*                          OGR2OGRPipeline                             */
+/************************************************************************/
+
+// A thread reads the source batches, another one processes their
+// geometries (itself with several threads), while the calling thread
+// writes the features of the previous batches.
+struct OGR2OGRPipeline
+{
+    std::function<void(OGR2OGRBatch&, GIntBig)> pfnRead{};
+    std::function<void(OGR2OGRBatch&)> pfnProcess{};
+    GIntBig             nAlreadyRead = 0;
+    OGR2OGRBatchQueue   oReadQueue{};
+    OGR2OGRBatchQueue   oProcessedQueue{};
+    // Not the global pool: both stages block on the queues for as long as
+    // the layer is translated.
+    CPLWorkerThreadPool oPool{};
+
+    OGR2OGRPipeline() = default;
+    ~OGR2OGRPipeline()
+    {
+        oReadQueue.Stop();
+        oProcessedQueue.Stop();
+        oPool.WaitCompletion();
+    }
+
+    CPL_DISALLOW_COPY_ASSIGN(OGR2OGRPipeline)
+};
+
+static void OGR2OGRReaderThreadFunc( void* pData )
+{
+    OGR2OGRPipeline* psPipeline = static_cast<OGR2OGRPipeline*>(pData);
+    std::vector<OGR2OGRBatchError> aoErrors;
+    CPLPushErrorHandlerEx(OGR2OGRBatchErrorHandler, &aoErrors);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    CPLErrorReset();
+    GIntBig nRead = psPipeline->nAlreadyRead;
+    while( true )
+    {
+        std::unique_ptr<OGR2OGRBatch> poBatch(new OGR2OGRBatch());
+        psPipeline->pfnRead(*poBatch, nRead);
+        nRead += static_cast<GIntBig>(poBatch->apoFeatures.size());
+        poBatch->aoErrors = std::move(aoErrors);
+        aoErrors.clear();
+        const bool bEnd = poBatch->bEnd;
+        if( !psPipeline->oReadQueue.Push(std::move(poBatch)) || bEnd )
+            break;
+    }
+    CPLPopErrorHandler();
+}
+
+static void OGR2OGRProcessThreadFunc( void* pData )
+{
+    OGR2OGRPipeline* psPipeline = static_cast<OGR2OGRPipeline*>(pData);
+    std::vector<OGR2OGRBatchError> aoErrors;
+    CPLPushErrorHandlerEx(OGR2OGRBatchErrorHandler, &aoErrors);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    while( true )
+    {
+        std::unique_ptr<OGR2OGRBatch> poBatch(psPipeline->oReadQueue.Pop());
+        if( poBatch == nullptr )
+            break;
+        psPipeline->pfnProcess(*poBatch);
+        poBatch->aoErrors.insert(poBatch->aoErrors.end(),
+                                 aoErrors.begin(), aoErrors.end());
+        aoErrors.clear();
+        const bool bEnd = poBatch->bEnd;
+        if( !psPipeline->oProcessedQueue.Push(std::move(poBatch)) || bEnd )
+            break;
+    }
+    CPLPopErrorHandler();
+}
+
 /************************************************************************/
 /*                     LayerTranslator::Translate()                     */
 /************************************************************************/
@@ -4483,6 +4649,16 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
     const int nSrcGeomFieldCount = poSrcLayer->GetLayerDefn()->GetGeomFieldCount();
     const int nDstGeomFieldCount = poDstLayer->GetLayerDefn()->GetGeomFieldCount();
     const bool bExplodeCollections = m_bExplodeCollections && nDstGeomFieldCount <= 1;
+    // When no geometry processing is requested, geometries whose parsing
+    // has been deferred by the source driver are copied as WKB, so that
+    // drivers able to write WKB directly never need to parse them.
+    const bool bGeomPassThrough =
+        !bExplodeCollections && iSrcZField == -1 &&
+        m_nCoordDim == COORD_DIM_UNCHANGED &&
+        m_eGeomOp == GEOMOP_NONE && !m_bMakeValid &&
+        m_poClipSrc == nullptr && m_poClipDst == nullptr &&
+        eGType == GEOMTYPE_UNCHANGED &&
+        m_eGeomTypeConversion == GTC_DEFAULT;
 
     if( poOutputSRS == nullptr && !m_bNullifyOutputSRS )
     {
@@ -4517,6 +4693,134 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
     bool bRet = true;
     CPLErrorReset();
     OGRGeometryFactory::TransformWithOptionsCache transformWithOptionsCache;
+
+    // When the geometry processing is limited to -segmentize, -simplify,
+    // -makevalid, -clipsrc and reprojection, source features are read ahead
+    // by batches whose geometries are processed at once, with several
+    // threads if GDAL_NUM_THREADS is set. Unless the source and target
+    // datasets are the same one, or OGR2OGR_PIPELINE=NO, reading,
+    // processing and writing are then done in parallel by different threads.
+    // The order of the features is preserved.
+    const int nCTThreads = CPLGetNumThreads();
+    const bool bBatchCTCandidate =
+        nCTThreads > 1 && poFeatureIn == nullptr &&
+        psOptions->nFIDToFetch == OGRNullFID &&
+        !bExplodeCollections && iSrcZField == -1 &&
+        m_nCoordDim == COORD_DIM_UNCHANGED &&
+        nSrcGeomFieldCount == 1 && nDstGeomFieldCount == 1;
+    const bool bPipelineCandidate =
+        bBatchCTCandidate && m_poSrcDS != m_poODS &&
+        CPLTestBool(CPLGetConfigOption("OGR2OGR_PIPELINE", "YES"));
+    CPLStringList aosBatchGeomOpOptions;
+    if( m_eGeomOp == GEOMOP_SEGMENTIZE && m_dfGeomOpParam > 0 )
+        aosBatchGeomOpOptions.SetNameValue("SEGMENTIZE",
+                                           CPLSPrintf("%.18g", m_dfGeomOpParam));
+    else if( m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY &&
+             m_dfGeomOpParam > 0 )
+        aosBatchGeomOpOptions.SetNameValue("SIMPLIFY_PRESERVE_TOPOLOGY",
+                                           CPLSPrintf("%.18g", m_dfGeomOpParam));
+    if( m_bMakeValid )
+        aosBatchGeomOpOptions.SetNameValue("MAKE_VALID", "YES");
+    aosBatchGeomOpOptions.SetNameValue("NUM_THREADS",
+                                       CPLSPrintf("%d", nCTThreads));
+    const bool bBatchGeomOp = bBatchCTCandidate &&
+        (m_eGeomOp != GEOMOP_NONE || m_bMakeValid);
+    const bool bBatchClip = bBatchCTCandidate && m_poClipSrc != nullptr;
+    bool bBatchCT = false;
+    bool bBatchSetupCTDone = false;
+
+    // Read at most one batch of features, nAlreadyRead being the number of
+    // features read before it.
+    const auto ReadBatch = [&](OGR2OGRBatch& oBatch, GIntBig nAlreadyRead)
+    {
+        size_t nBatchSize = 256 * static_cast<size_t>(nCTThreads);
+        if( m_nLimit >= 0 )
+            nBatchSize = static_cast<size_t>(std::max(GIntBig(0),
+                std::min(static_cast<GIntBig>(nBatchSize),
+                         m_nLimit - nAlreadyRead)));
+        while( oBatch.apoFeatures.size() < nBatchSize )
+        {
+            OGRFeature* poBatchFeature = poSrcLayer->GetNextFeature();
+            if( poBatchFeature == nullptr )
+            {
+                oBatch.bEnd = true;
+                oBatch.bFailure = CPLGetLastErrorType() == CE_Failure;
+                break;
+            }
+            oBatch.apoFeatures.emplace_back(poBatchFeature);
+        }
+        if( m_nLimit >= 0 &&
+            nAlreadyRead + static_cast<GIntBig>(oBatch.apoFeatures.size()) >=
+                                                                    m_nLimit )
+        {
+            oBatch.bEnd = true;
+        }
+        oBatch.aeCTErrors.assign(oBatch.apoFeatures.size(), OGRERR_NONE);
+        oBatch.abClippedOut.assign(oBatch.apoFeatures.size(), false);
+    };
+
+    // Apply the geometry operations, -clipsrc and the reprojection to the
+    // features of a batch. SetupCT() must have been run before.
+    const auto ProcessBatch = [&](OGR2OGRBatch& oBatch)
+    {
+        if( oBatch.apoFeatures.empty() )
+            return;
+
+        if( bBatchGeomOp || bBatchClip )
+        {
+            // processGeometries() and Intersection() may replace the
+            // geometries.
+            std::vector<OGRGeometry*> apoGeoms;
+            for( const auto& poBatchFeature: oBatch.apoFeatures )
+                apoGeoms.push_back(poBatchFeature->StealGeometry());
+            if( bBatchGeomOp )
+            {
+                OGRGeometryFactory::processGeometries(
+                    static_cast<int>(apoGeoms.size()), apoGeoms.data(),
+                    aosBatchGeomOpOptions.List());
+            }
+            if( bBatchClip )
+            {
+                for( size_t i = 0; i < apoGeoms.size(); i++ )
+                {
+                    if( apoGeoms[i] == nullptr )
+                        continue;
+                    OGRGeometry* poClipped =
+                        apoGeoms[i]->Intersection(m_poClipSrc);
+                    delete apoGeoms[i];
+                    apoGeoms[i] = nullptr;
+                    if( poClipped == nullptr || poClipped->IsEmpty() )
+                    {
+                        delete poClipped;
+                        oBatch.abClippedOut[i] = true;
+                    }
+                    else
+                    {
+                        apoGeoms[i] = poClipped;
+                    }
+                }
+            }
+            for( size_t i = 0; i < oBatch.apoFeatures.size(); i++ )
+                oBatch.apoFeatures[i]->SetGeometryDirectly(apoGeoms[i]);
+        }
+
+        if( bBatchCT )
+        {
+            std::vector<OGRGeometry*> apoGeoms;
+            for( const auto& poBatchFeature: oBatch.apoFeatures )
+                apoGeoms.push_back(poBatchFeature->GetGeometryRef());
+            OGRGeometryFactory::transformGeometries(
+                static_cast<int>(apoGeoms.size()), apoGeoms.data(),
+                psInfo->papoCT[0], nullptr, oBatch.aeCTErrors.data());
+        }
+    };
+
+    std::unique_ptr<OGR2OGRBatch> poBatch;
+    size_t iBatch = 0;
+    bool bBatchEnd = false;
+    bool bBatchFailure = false;
+    // Must be destroyed before the above lambdas and batch.
+    std::unique_ptr<OGR2OGRPipeline> poPipeline;
     while( true )
     {
         if( m_nLimit >= 0 && psInfo->nFeaturesRead >= m_nLimit )
@@ -4524,23 +4828,127 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
             break;
         }
 
+        bool bGeomReprojectedInBatch = false;
+        bool bGeomProcessedInBatch = false;
+        bool bGeomClippedInBatch = false;
+        bool bGeomClippedOutInBatch = false;
+        OGRErr eBatchCTErr = OGRERR_NONE;
         if( poFeatureIn != nullptr )
             poFeature = poFeatureIn;
         else if( psOptions->nFIDToFetch != OGRNullFID )
             poFeature = poSrcLayer->GetFeature(psOptions->nFIDToFetch);
+        else if( bBatchCTCandidate )
+        {
+            if( poBatch == nullptr || iBatch == poBatch->apoFeatures.size() )
+            {
+                iBatch = 0;
+                if( bBatchEnd )
+                {
+                    poBatch.reset();
+                }
+                else if( poPipeline )
+                {
+                    poBatch = poPipeline->oProcessedQueue.Pop();
+                    if( poBatch )
+                    {
+                        for( const auto& oError: poBatch->aoErrors )
+                        {
+                            CPLError( oError.eErrClass, oError.nErrNo, "%s",
+                                      oError.osMsg.c_str() );
+                        }
+                    }
+                    else
+                    {
+                        bBatchEnd = true;
+                    }
+                }
+                else
+                {
+                    poBatch.reset(new OGR2OGRBatch());
+                    ReadBatch(*poBatch, psInfo->nFeaturesRead);
+
+                    if( !poBatch->apoFeatures.empty() )
+                    {
+                        if( psInfo->nFeaturesRead == 0 &&
+                            !SetupCT( psInfo, poSrcLayer, m_bTransform,
+                                      m_bWrapDateline, m_osDateLineOffset,
+                                      m_poUserSourceSRS,
+                                      poBatch->apoFeatures[0].get(),
+                                      poOutputSRS, m_poGCPCoordTrans) )
+                        {
+                            return false;
+                        }
+                        bBatchSetupCTDone = true;
+
+                        // transformWithOptions() has special processing of
+                        // reprojection to WGS84 that is not done here.
+                        OGRCoordinateTransformation* poCT = psInfo->papoCT[0];
+                        bBatchCT = !psInfo->bPerFeatureCT && poCT != nullptr &&
+                                   psInfo->papapszTransformOptions[0] == nullptr;
+                        if( bBatchCT && poCT->GetSourceCS() != nullptr &&
+                            poCT->GetTargetCS() != nullptr )
+                        {
+                            OGRSpatialReference oSRSWGS84;
+                            oSRSWGS84.SetWellKnownGeogCS( "WGS84" );
+                            oSRSWGS84.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+                            bBatchCT = !poCT->GetTargetCS()->IsSame(&oSRSWGS84);
+                        }
+                        ProcessBatch(*poBatch);
+                    }
+
+                    if( !poBatch->bEnd && bPipelineCandidate )
+                    {
+                        poPipeline.reset(new OGR2OGRPipeline());
+                        poPipeline->pfnRead = ReadBatch;
+                        poPipeline->pfnProcess = ProcessBatch;
+                        poPipeline->nAlreadyRead = psInfo->nFeaturesRead +
+                            static_cast<GIntBig>(poBatch->apoFeatures.size());
+                        if( !poPipeline->oPool.Setup(2, nullptr, nullptr) ||
+                            !poPipeline->oPool.SubmitJob(
+                                OGR2OGRReaderThreadFunc, poPipeline.get()) ||
+                            !poPipeline->oPool.SubmitJob(
+                                OGR2OGRProcessThreadFunc, poPipeline.get()) )
+                        {
+                            return false;
+                        }
+                        CPLDebug("GDALVectorTranslate",
+                                 "Using reading and processing threads for "
+                                 "layer %s", poSrcLayer->GetName());
+                    }
+                }
+                if( poBatch )
+                {
+                    bBatchEnd = poBatch->bEnd;
+                    bBatchFailure = poBatch->bFailure;
+                }
+            }
+
+            poFeature = nullptr;
+            if( poBatch && iBatch < poBatch->apoFeatures.size() )
+            {
+                poFeature = poBatch->apoFeatures[iBatch].release();
+                bGeomReprojectedInBatch = bBatchCT;
+                bGeomProcessedInBatch = bBatchGeomOp;
+                bGeomClippedInBatch = bBatchClip;
+                bGeomClippedOutInBatch = poBatch->abClippedOut[iBatch];
+                eBatchCTErr = poBatch->aeCTErrors[iBatch];
+                iBatch++;
+            }
+        }
         else
             poFeature = poSrcLayer->GetNextFeature();
 
         if( poFeature == nullptr )
         {
-            if( CPLGetLastErrorType() == CE_Failure )
+            if( CPLGetLastErrorType() == CE_Failure || bBatchFailure )
             {
                 bRet = false;
             }
             break;
         }
 
-        if( psInfo->nFeaturesRead == 0 || psInfo->bPerFeatureCT )
+        if( (psInfo->nFeaturesRead == 0 && !bBatchSetupCTDone) ||
+            psInfo->bPerFeatureCT )
         {
             if( !SetupCT( psInfo, poSrcLayer, m_bTransform, m_bWrapDateline,
                           m_osDateLineOffset, m_poUserSourceSRS,
@@ -4606,7 +5014,13 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
             /* Optimization to avoid duplicating the source geometry in the */
             /* target feature : we steal it from the source feature for now... */
             OGRGeometry* poStolenGeometry = nullptr;
-            if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
+            if( bGeomPassThrough && nSrcGeomFieldCount == 1 &&
+                nDstGeomFieldCount == 1 &&
+                poFeature->GetGeomFieldLazyWKB(0, nullptr) != nullptr )
+            {
+                // SetFrom() will copy the unparsed WKB.
+            }
+            else if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
                 (nDstGeomFieldCount == 1 ||
                  (nDstGeomFieldCount == 0 && m_poClipSrc)) )
             {
@@ -4619,6 +5033,12 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
                     psInfo->iRequestedSrcGeomField);
             }
 
+            if( bGeomClippedOutInBatch )
+            {
+                delete poStolenGeometry;
+                goto end_loop;
+            }
+
             if( nDstGeomFieldCount == 0 && poStolenGeometry && m_poClipSrc )
             {
                 OGRGeometry* poClipped = poStolenGeometry->Intersection(m_poClipSrc);
@@ -4679,6 +5099,14 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
 
             for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
             {
+                if( bGeomPassThrough &&
+                    psInfo->papoCT[iGeom] == nullptr &&
+                    psInfo->papapszTransformOptions[iGeom] == nullptr &&
+                    poDstFeature->GetGeomFieldLazyWKB(iGeom, nullptr) != nullptr )
+                {
+                    continue;
+                }
+
                 OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
                 if (poDstGeometry == nullptr)
                     continue;
@@ -4724,7 +5152,11 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
                     poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
                 }
 
-                if (m_eGeomOp == GEOMOP_SEGMENTIZE)
+                if( bGeomProcessedInBatch )
+                {
+                    // Already done by processGeometries()
+                }
+                else if (m_eGeomOp == GEOMOP_SEGMENTIZE)
                 {
                     if (m_dfGeomOpParam > 0)
                         poDstGeometry->segmentize(m_dfGeomOpParam);
@@ -4742,7 +5174,18 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
                     }
                 }
 
-                if (m_poClipSrc)
+                if( m_bMakeValid && !bGeomProcessedInBatch &&
+                    !poDstGeometry->IsValid() )
+                {
+                    OGRGeometry* poValidGeom = poDstGeometry->MakeValid();
+                    if( poValidGeom )
+                    {
+                        delete poDstGeometry;
+                        poDstGeometry = poValidGeom;
+                    }
+                }
+
+                if (m_poClipSrc && !bGeomClippedInBatch)
                 {
                     OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
                     delete poDstGeometry;
@@ -4759,9 +5202,18 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
 
                 if( poCT != nullptr || papszTransformOptions != nullptr)
                 {
-                    OGRGeometry* poReprojectedGeom =
-                        OGRGeometryFactory::transformWithOptions(
-                            poDstGeometry, poCT, papszTransformOptions, transformWithOptionsCache);
+                    OGRGeometry* poReprojectedGeom = nullptr;
+                    if( bGeomReprojectedInBatch )
+                    {
+                        if( eBatchCTErr == OGRERR_NONE )
+                            std::swap(poReprojectedGeom, poDstGeometry);
+                    }
+                    else
+                    {
+                        poReprojectedGeom =
+                            OGRGeometryFactory::transformWithOptions(
+                                poDstGeometry, poCT, papszTransformOptions, transformWithOptionsCache);
+                    }
                     if( poReprojectedGeom == nullptr )
                     {
                         if( psOptions->nGroupTransactions )
@@ -5009,6 +5461,7 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
     psOptions->eGeomTypeConversion = GTC_DEFAULT;
     psOptions->eGeomOp = GEOMOP_NONE;
     psOptions->dfGeomOpParam = 0;
+    psOptions->bMakeValid = false;
     psOptions->papszFieldTypesToString = nullptr;
     psOptions->papszMapFieldType = nullptr;
     psOptions->bUnsetFieldWidth = false;
@@ -5320,6 +5773,10 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
             psOptions->eGeomOp = GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY;
             psOptions->dfGeomOpParam = CPLAtof(papszArgv[++i]);
         }
+        else if( EQUAL(papszArgv[i],"-makevalid") )
+        {
+            psOptions->bMakeValid = true;
+        }
         else if( i+1 < nArgc && EQUAL(papszArgv[i],"-fieldTypeToString") )
         {
             CSLDestroy(psOptions->papszFieldTypesToString);
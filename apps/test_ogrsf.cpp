@@ -28,6 +28,7 @@
  ****************************************************************************/
 
 #include "cpl_conv.h"
+#include "cpl_json.h"
 #include "cpl_multiproc.h"
 #include "gdal_version.h"
 #include "ogr_api.h"
@@ -36,7 +37,10 @@
 #include "commonutils.h"
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
 #include <limits>
+#include <vector>
 
 CPL_CVSID("$Id: test_ogrsf.cpp 765f9701959517cb9c13deea90566e390f72c718 2019-01-24 00:26:25 +0100 Even Rouault $")
 
@@ -54,6 +58,7 @@ bool bAllDrivers = false;
 const char *pszLogFilename = nullptr;
 char **papszDSCO = nullptr;
 char **papszLCO = nullptr;
+const char *pszBenchmarkReport = nullptr;
 
 typedef struct
 {
@@ -72,6 +77,7 @@ static int TestInterleavedReading( const char *pszDataSource,
                                    char **papszLayers );
 static int TestDSErrorConditions( GDALDataset * poDS );
 static int TestVirtualIO( GDALDataset* poDS );
+static int BenchmarkDataset();
 
 static const char* Log(const char* pszMsg, int nLineNumber)
 {
@@ -189,6 +195,10 @@ MAIN_START(nArgc, papszArgv)
         {
             bAllDrivers = true;
         }
+        else if( EQUAL(papszArgv[iArg], "-benchmark") && iArg + 1 < nArgc )
+        {
+            pszBenchmarkReport = papszArgv[++iArg];
+        }
         else if( papszArgv[iArg][0] == '-' )
         {
             Usage();
@@ -214,7 +224,20 @@ MAIN_START(nArgc, papszArgv)
         exit(1);
     }
 
-    if( nThreads == 1 )
+    if( pszBenchmarkReport != nullptr &&
+        (pszDataSource == nullptr || nThreads != 1) )
+    {
+        fprintf(stderr,
+                "-benchmark must be used with a datasource name and "
+                "without -threads.\n");
+        exit(1);
+    }
+
+    if( pszBenchmarkReport != nullptr )
+    {
+        bRet = BenchmarkDataset();
+    }
+    else if( nThreads == 1 )
     {
         ThreadContext sContext;
         ThreadFunction(&sContext);
@@ -1022,11 +1045,16 @@ static void Usage()
 
 {
     printf("Usage: test_ogrsf [-ro] [-q] [-threads N] [-loops M] [-fsf]\n"
+           "                  [-benchmark report.json]\n"
            "                  (datasource_name | [-driver driver_name] [[-dsco NAME=VALUE] ...] [[-lco NAME=VALUE] ...] | -all_drivers) \n"
            "                  [[layer1_name, layer2_name, ...] | [-sql statement] [-dialect dialect]]\n"
            "                   [[-oo NAME=VALUE] ...]\n");
     printf("\n");
     printf("-fsf : full spatial filter testing (slow)\n");
+    printf("-benchmark : instead of testing, time the read operations "
+           "(-loops times each)\n"
+           "             and write them with the peak memory use in a "
+           "JSON report.\n");
     exit(1);
 }
 
@@ -3851,3 +3879,259 @@ static int TestVirtualIO( GDALDataset * poDS )
 
     return bRet;
 }
+
+/************************************************************************/
+/*                        BenchmarkOperation()                          */
+/************************************************************************/
+
+// Runs oFunc nLoops times, and appends its timings to oOperations. oFunc
+// returns the number of items it processed, or -1 if the operation is not
+// supported.
+static void BenchmarkOperation( CPLJSONArray& oOperations,
+                                const char* pszLayerName,
+                                const char* pszOperation,
+                                const std::function<GIntBig()>& oFunc )
+{
+    std::vector<double> adfTimes;
+    GIntBig nItems = 0;
+    for( int iLoop = 0; iLoop < std::max(1, nLoops); iLoop++ )
+    {
+        const auto oStart = std::chrono::steady_clock::now();
+        nItems = oFunc();
+        const std::chrono::duration<double> oElapsed =
+            std::chrono::steady_clock::now() - oStart;
+        if( nItems < 0 )
+            return;
+        adfTimes.push_back(oElapsed.count());
+    }
+    std::sort(adfTimes.begin(), adfTimes.end());
+    const size_t nCount = adfTimes.size();
+    const double dfMedian = (nCount % 2) ?
+        adfTimes[nCount / 2] :
+        (adfTimes[nCount / 2 - 1] + adfTimes[nCount / 2]) / 2;
+
+    CPLJSONObject oOperation;
+    oOperation.Add("name", pszOperation);
+    oOperation.Add("iterations", static_cast<int>(nCount));
+    oOperation.Add("min_s", adfTimes.front());
+    oOperation.Add("median_s", dfMedian);
+    oOperation.Add("max_s", adfTimes.back());
+    oOperation.Add("items", static_cast<GInt64>(nItems));
+    const GIntBig nPeakRSS = GetPeakRSS();
+    if( nPeakRSS >= 0 )
+        oOperation.Add("peak_rss_bytes", static_cast<GInt64>(nPeakRSS));
+    oOperations.Add(oOperation);
+
+    if( bVerbose )
+        printf("INFO: %s: %s: %.3f ms, " CPL_FRMT_GIB " items.\n",
+               pszLayerName, pszOperation, dfMedian * 1000, nItems);
+}
+
+/************************************************************************/
+/*                          BenchmarkLayer()                            */
+/************************************************************************/
+
+static CPLJSONObject BenchmarkLayer( OGRLayer* poLayer )
+{
+    CPLJSONObject oLayer;
+    oLayer.Add("name", poLayer->GetName());
+    CPLJSONArray oOperations;
+
+    BenchmarkOperation(oOperations, poLayer->GetName(), "feature_count",
+        [poLayer]()
+        {
+            return poLayer->GetFeatureCount(TRUE);
+        });
+
+    // Sample of up to 100 FIDs, by reservoir sampling with a fixed seed,
+    // for the random reads.
+    static const size_t nMaxFIDs = 100;
+    std::vector<GIntBig> anFIDs;
+    GUInt32 nRandomState = 1;
+    BenchmarkOperation(oOperations, poLayer->GetName(), "sequential_scan",
+        [poLayer, &anFIDs, &nRandomState]()
+        {
+            const bool bSample = anFIDs.empty();
+            GIntBig nFeatures = 0;
+            poLayer->ResetReading();
+            OGRFeature* poFeature = nullptr;
+            while( (poFeature = poLayer->GetNextFeature()) != nullptr )
+            {
+                if( bSample && poFeature->GetFID() != OGRNullFID )
+                {
+                    if( anFIDs.size() < nMaxFIDs )
+                    {
+                        anFIDs.push_back(poFeature->GetFID());
+                    }
+                    else
+                    {
+                        nRandomState = nRandomState * 1103515245U + 12345U;
+                        const GUIntBig nIdx = (nRandomState >> 8) %
+                            static_cast<GUIntBig>(nFeatures + 1);
+                        if( nIdx < nMaxFIDs )
+                            anFIDs[static_cast<size_t>(nIdx)] =
+                                poFeature->GetFID();
+                    }
+                }
+                nFeatures++;
+                OGRFeature::DestroyFeature(poFeature);
+            }
+            return nFeatures;
+        });
+
+    // Spatial filter on the central quarter of the extent.
+    OGREnvelope sExtent;
+    if( poLayer->GetGeomType() != wkbNone &&
+        poLayer->GetExtent(&sExtent, TRUE) == OGRERR_NONE )
+    {
+        const double dfDX = (sExtent.MaxX - sExtent.MinX) / 4;
+        const double dfDY = (sExtent.MaxY - sExtent.MinY) / 4;
+        BenchmarkOperation(oOperations, poLayer->GetName(), "spatial_filter",
+            [poLayer, &sExtent, dfDX, dfDY]()
+            {
+                poLayer->SetSpatialFilterRect(sExtent.MinX + dfDX,
+                                              sExtent.MinY + dfDY,
+                                              sExtent.MaxX - dfDX,
+                                              sExtent.MaxY - dfDY);
+                GIntBig nFeatures = 0;
+                poLayer->ResetReading();
+                OGRFeature* poFeature = nullptr;
+                while( (poFeature = poLayer->GetNextFeature()) != nullptr )
+                {
+                    nFeatures++;
+                    OGRFeature::DestroyFeature(poFeature);
+                }
+                poLayer->SetSpatialFilter(nullptr);
+                return nFeatures;
+            });
+    }
+
+    if( !anFIDs.empty() )
+    {
+        BenchmarkOperation(oOperations, poLayer->GetName(),
+                           "random_get_feature",
+            [poLayer, &anFIDs]()
+            {
+                GIntBig nFeatures = 0;
+                for( const GIntBig nFID : anFIDs )
+                {
+                    OGRFeature* poFeature = poLayer->GetFeature(nFID);
+                    if( poFeature == nullptr )
+                        return static_cast<GIntBig>(-1);
+                    nFeatures++;
+                    OGRFeature::DestroyFeature(poFeature);
+                }
+                return nFeatures;
+            });
+    }
+
+    oLayer.Add("random_read", poLayer->TestCapability(OLCRandomRead) != 0);
+    oLayer.Add("fast_feature_count",
+               poLayer->TestCapability(OLCFastFeatureCount) != 0);
+    oLayer.Add("fast_spatial_filter",
+               poLayer->TestCapability(OLCFastSpatialFilter) != 0);
+    oLayer.Add("operations", oOperations);
+    return oLayer;
+}
+
+/************************************************************************/
+/*                         BenchmarkDataset()                           */
+/************************************************************************/
+
+static int BenchmarkDataset()
+{
+    CPLJSONDocument oDoc;
+    CPLJSONObject oRoot = oDoc.GetRoot();
+    oRoot.Add("gdal_version", GDALVersionInfo("RELEASE_NAME"));
+    oRoot.Add("gdal_build_info", GDALVersionInfo("BUILD_INFO"));
+    oRoot.Add("datasource", pszDataSource);
+    oRoot.Add("loops", std::max(1, nLoops));
+
+    // The datasets of the previous loops are closed at the end, so that
+    // closing is not timed.
+    CPLJSONArray oOperations;
+    std::vector<GDALDataset*> apoDS;
+    BenchmarkOperation(oOperations, pszDataSource, "open",
+        [&apoDS]()
+        {
+            GDALDataset* poNewDS = static_cast<GDALDataset *>(GDALOpenEx(
+                pszDataSource, GDAL_OF_READONLY | GDAL_OF_VECTOR,
+                nullptr, papszOpenOptions, nullptr));
+            if( poNewDS == nullptr )
+                return static_cast<GIntBig>(-1);
+            apoDS.push_back(poNewDS);
+            return static_cast<GIntBig>(1);
+        });
+    GDALDataset* poDS = nullptr;
+    if( !apoDS.empty() )
+    {
+        poDS = apoDS.back();
+        apoDS.pop_back();
+    }
+    for( GDALDataset* poPrevDS : apoDS )
+        GDALClose(poPrevDS);
+    if( poDS == nullptr )
+    {
+        printf("FAILURE: Unable to open datasource `%s'.\n", pszDataSource);
+        return FALSE;
+    }
+    oRoot.Add("driver", poDS->GetDriver()->GetDescription());
+
+    CPLJSONArray oLayers;
+    if( pszSQLStatement != nullptr )
+    {
+        OGRLayer* poResultSet = nullptr;
+        BenchmarkOperation(oOperations, pszDataSource, "execute_sql",
+            [poDS, &poResultSet]()
+            {
+                if( poResultSet != nullptr )
+                    poDS->ReleaseResultSet(poResultSet);
+                poResultSet = poDS->ExecuteSQL(pszSQLStatement, nullptr,
+                                               pszDialect);
+                return static_cast<GIntBig>(poResultSet != nullptr ? 1 : -1);
+            });
+        if( poResultSet != nullptr )
+        {
+            oLayers.Add(BenchmarkLayer(poResultSet));
+            poDS->ReleaseResultSet(poResultSet);
+        }
+    }
+    else if( papszLayers != nullptr )
+    {
+        for( char** papszIter = papszLayers; *papszIter; papszIter++ )
+        {
+            OGRLayer* poLayer = poDS->GetLayerByName(*papszIter);
+            if( poLayer == nullptr )
+            {
+                printf("FAILURE: Couldn't fetch requested layer %s!\n",
+                       *papszIter);
+                GDALClose(poDS);
+                return FALSE;
+            }
+            oLayers.Add(BenchmarkLayer(poLayer));
+        }
+    }
+    else
+    {
+        for( int iLayer = 0; iLayer < poDS->GetLayerCount(); iLayer++ )
+        {
+            OGRLayer* poLayer = poDS->GetLayer(iLayer);
+            if( poLayer != nullptr )
+                oLayers.Add(BenchmarkLayer(poLayer));
+        }
+    }
+    GDALClose(poDS);
+
+    oRoot.Add("operations", oOperations);
+    oRoot.Add("layers", oLayers);
+    const GIntBig nPeakRSS = GetPeakRSS();
+    if( nPeakRSS >= 0 )
+        oRoot.Add("peak_rss_bytes", static_cast<GInt64>(nPeakRSS));
+
+    if( !oDoc.Save(pszBenchmarkReport) )
+    {
+        printf("FAILURE: Cannot write %s.\n", pszBenchmarkReport);
+        return FALSE;
+    }
+    return TRUE;
+}
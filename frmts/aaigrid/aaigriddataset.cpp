@@ -125,6 +125,40 @@ AAIGRasterBand::AAIGRasterBand( AAIGDataset *poDSIn, int nDataStart ) :
 
 AAIGRasterBand::~AAIGRasterBand() { CPLFree(panLineOffset); }
 
+/************************************************************************/
+/*                           AAIGParseInt32()                           */
+/*                                                                      */
+/*      Same result as atoi() on a token of nLen characters, without    */
+/*      the overhead of the C library for the common short values.      */
+/************************************************************************/
+
+static GInt32 AAIGParseInt32( const char *pszToken, int nLen )
+
+{
+    int i = 0;
+    bool bNegative = false;
+    if( pszToken[0] == '-' || pszToken[0] == '+' )
+    {
+        bNegative = pszToken[0] == '-';
+        i = 1;
+    }
+
+    // Up to 9 digits cannot overflow.
+    if( nLen - i > 9 )
+        return static_cast<GInt32>(atoi(pszToken));
+
+    GInt32 nValue = 0;
+    for( ; i < nLen; i++ )
+    {
+        const unsigned nDigit = static_cast<unsigned char>(pszToken[i]) - '0';
+        if( nDigit > 9 )
+            break;
+        nValue = nValue * 10 + static_cast<GInt32>(nDigit);
+    }
+
+    return bNegative ? -nValue : nValue;
+}
+
 /************************************************************************/
 /*                             IReadBlock()                             */
 /************************************************************************/
@@ -200,7 +234,7 @@ CPLErr AAIGRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
                     DoubleToFloatClamp(CPLAtofM(szToken));
             else
                 reinterpret_cast<GInt32 *>(pImage)[iPixel] =
-                    static_cast<GInt32>(atoi(szToken));
+                    AAIGParseInt32(szToken, iTokenChar);
         }
 
         iPixel++;
@@ -257,7 +291,8 @@ AAIGDataset::AAIGDataset() :
     papszPrj(nullptr),
     pszProjection(CPLStrdup("")),
     nBufferOffset(0),
-    nOffsetInBuffer(256),
+    nOffsetInBuffer(static_cast<int>(sizeof(achReadBuf))),
+    nBufferSize(0),
     eDataType(GDT_Int32),
     bNoDataSet(false),
     dfNoDataValue(-9999.0)
@@ -305,29 +340,38 @@ GUIntBig AAIGDataset::Tell() const { return nBufferOffset + nOffsetInBuffer; }
 int AAIGDataset::Seek( GUIntBig nNewOffset )
 
 {
+    // Scanlines are usually read in sequence, so the start of the next one
+    // is generally already in the buffer.
+    if( nNewOffset >= nBufferOffset &&
+        nNewOffset < nBufferOffset + nBufferSize )
+    {
+        nOffsetInBuffer = static_cast<int>(nNewOffset - nBufferOffset);
+        return 0;
+    }
+
     nOffsetInBuffer = sizeof(achReadBuf);
+    nBufferSize = 0;
     return VSIFSeekL(fp, nNewOffset, SEEK_SET);
 }
 
 /************************************************************************/
-/*                                Getc()                                */
+/*                         FillBufferAndGetc()                          */
 /*                                                                      */
-/*      Read a single character from the input file (efficiently we     */
-/*      hope).                                                          */
+/*      Refill the read buffer from the input file and return its       */
+/*      first character. Getc() only calls this when the buffer is      */
+/*      exhausted.                                                      */
 /************************************************************************/
 
-char AAIGDataset::Getc()
+char AAIGDataset::FillBufferAndGetc()
 
 {
-    if( nOffsetInBuffer < static_cast<int>(sizeof(achReadBuf)) )
-        return achReadBuf[nOffsetInBuffer++];
-
     nBufferOffset = VSIFTellL(fp);
     const int nRead =
         static_cast<int>(VSIFReadL(achReadBuf, 1, sizeof(achReadBuf), fp));
     for( unsigned int i = nRead; i < sizeof(achReadBuf); i++ )
         achReadBuf[i] = '\0';
 
+    nBufferSize = nRead;
     nOffsetInBuffer = 0;
 
     return achReadBuf[nOffsetInBuffer++];
@@ -787,12 +831,16 @@ GDALDataset *AAIGDataset::CommonOpen( GDALOpenInfo *poOpenInfo,
             return nullptr;
         }
 
-        // Scan for dot in subsequent chunks of data.
-        while( !VSIFEofL(poDS->fp) )
+        // Scan for dot in subsequent chunks of data, and stop at the first
+        // one found.
+        while( poDS->eDataType != GDT_Float32 && !VSIFEofL(poDS->fp) )
         {
-            CPL_IGNORE_RET_VAL(VSIFReadL(pabyChunk, nChunkSize, 1, poDS->fp));
+            const size_t nRead =
+                VSIFReadL(pabyChunk, 1, nChunkSize, poDS->fp);
+            if( nRead == 0 )
+                break;
 
-            for( int i = 0; i < static_cast<int>(nChunkSize); i++)
+            for( size_t i = 0; i < nRead; i++)
             {
                 GByte ch = pabyChunk[i];
                 if (ch == '.' || ch == ',' || ch == 'e' || ch == 'E')
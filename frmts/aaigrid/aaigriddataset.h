@@ -87,11 +87,15 @@ class AAIGDataset : public GDALPamDataset
     CPLString   osPrjFilename;
     char        *pszProjection;
 
-    unsigned char achReadBuf[256];
+    unsigned char achReadBuf[65536];
     GUIntBig    nBufferOffset;
     int         nOffsetInBuffer;
+    int         nBufferSize;  // Number of bytes of achReadBuf loaded.
 
-    char        Getc();
+    char        FillBufferAndGetc();
+    char        Getc()
+        { return nOffsetInBuffer < static_cast<int>(sizeof(achReadBuf)) ?
+                    achReadBuf[nOffsetInBuffer++] : FillBufferAndGetc(); }
     GUIntBig    Tell() const;
     int         Seek( GUIntBig nOffset );
 
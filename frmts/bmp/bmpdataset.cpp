@@ -1598,6 +1598,7 @@ void GDALRegister_BMP()
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC,
                                "frmt_bmp.html" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "bmp" );
+    poDriver->SetMetadataItem( GDAL_DMD_SIGNATURES, "424D" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES, "Byte" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
 "<CreationOptionList>"
@@ -62,8 +62,14 @@ static char *szConfiguredFormats = "GDAL_FORMATS";
 void CPL_STDCALL GDALAllRegister()
 
 {
+    GDALDriverManager *poDriverManager = GetGDALDriverManager();
+
     // AutoLoadDrivers is a no-op if compiled with GDAL_NO_AUTOLOAD defined.
-    GetGDALDriverManager()->AutoLoadDrivers();
+    poDriverManager->AutoLoadDrivers();
+
+    // Drivers that declare signatures in GDAL_DMD_SIGNATURES are registered
+    // as stubs, and really registered when first used, since GDALOpenEx()
+    // can skip them on most files without loading them.
 
 #ifdef FRMT_vrt
     GDALRegister_VRT();
@@ -71,17 +77,22 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_gtiff
-    GDALRegister_GTiff();
+    poDriverManager->RegisterDeferredDriver( "GTiff", GDALRegister_GTiff,
+                                             true, false, "4949 4D4D" );
 #endif
 
 #ifdef FRMT_nitf
-    GDALRegister_NITF();
+    poDriverManager->RegisterDeferredDriver(
+        "NITF", GDALRegister_NITF, true, false,
+        "4E495446 4E534946" );
     GDALRegister_RPFTOC();
     GDALRegister_ECRGTOC();
 #endif
 
 #ifdef FRMT_hfa
-    GDALRegister_HFA();
+    poDriverManager->RegisterDeferredDriver(
+        "HFA", GDALRegister_HFA, true, false,
+        "454846415F4845414445525F544147" );
 #endif
 
 #ifdef FRMT_ceos2
@@ -123,7 +134,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_png
-    GDALRegister_PNG();
+    poDriverManager->RegisterDeferredDriver( "PNG", GDALRegister_PNG,
+                                             true, false, "89504E47" );
 #endif
 
 #ifdef FRMT_dds
@@ -135,7 +147,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_jpeg
-    GDALRegister_JPEG();
+    poDriverManager->RegisterDeferredDriver( "JPEG", GDALRegister_JPEG,
+                                             true, false, "FFD8FF" );
 #endif
 
 #ifdef FRMT_mem
@@ -151,8 +164,12 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_gif
-    GDALRegister_GIF();
-    GDALRegister_BIGGIF();
+    poDriverManager->RegisterDeferredDriver(
+        "GIF", GDALRegister_GIF, true, false,
+        "474946383761 474946383961" );
+    poDriverManager->RegisterDeferredDriver(
+        "BIGGIF", GDALRegister_BIGGIF, true, false,
+        "474946383761 474946383961" );
 #endif
 
 #ifdef FRMT_envisat
@@ -172,7 +189,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_bmp
-    GDALRegister_BMP();
+    poDriverManager->RegisterDeferredDriver( "BMP", GDALRegister_BMP,
+                                             true, false, "424D" );
 #endif
 
 #ifdef FRMT_dimap
@@ -192,7 +210,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_pcidsk
-    GDALRegister_PCIDSK();
+    poDriverManager->RegisterDeferredDriver( "PCIDSK", GDALRegister_PCIDSK,
+                                             true, true, "50434944534B2020" );
 #endif
 
 #ifdef FRMT_pcraster
@@ -364,7 +383,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_webp
-    GDALRegister_WEBP();
+    poDriverManager->RegisterDeferredDriver( "WEBP", GDALRegister_WEBP,
+                                             true, false, "52494646" );
 #endif
 
 #ifdef FRMT_pdf
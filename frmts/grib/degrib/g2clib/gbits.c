@@ -40,6 +40,28 @@ int gbits(unsigned char *in,g2int in_length,g2int *iout,g2int iskip,g2int nbyte,
       if( n> 0 && (nbyte + nskip > INT_MAX / n ||
                    iskip > INT_MAX - n*(nbyte + nskip)) )
           return -1;
+
+//     Fast path for contiguous values of up to 24 bits lying entirely in
+//     the input: keep the pending bits in an accumulator instead of
+//     recomputing the byte index and masks of each value.
+      if( nskip == 0 && nbyte > 0 && nbyte <= 24 && n > 0 && iskip >= 0 &&
+          (in_length == G2_UNKNOWN_SIZE ||
+           (iskip + n*nbyte - 1) / 8 < in_length) )
+      {
+         const unsigned char *pin = in + iskip/8;
+         const unsigned mask = (1U << nbyte) - 1;
+         unsigned acc = (unsigned)*pin++ & (unsigned)ones[7-iskip%8];
+         int nacc = 8 - iskip%8;
+         for (i=0;i<n;i++) {
+            while (nacc < nbyte) {
+               acc = (acc << 8) | (unsigned)*pin++;
+               nacc += 8;
+            }
+            nacc -= nbyte;
+            iout[i] = (g2int)((acc >> nacc) & mask);
+         }
+         return 0;
+      }
       for (i=0;i<n;i++) {
          bitcnt = nbyte;
          l_index=nbit/8;
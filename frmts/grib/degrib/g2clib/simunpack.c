@@ -3,12 +3,41 @@
 #include <stdlib.h>
 #include "grib2.h"
 
+#if defined(__x86_64) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 static float DoubleToFloatClamp(double val) {
    if (val >= FLT_MAX) return FLT_MAX;
    if (val <= -FLT_MAX) return -FLT_MAX;
    return (float)val;
 }
 
+void simscale(const g2int *ifld,g2int ndpts,g2float ref,g2float bscale,
+              g2float dscale,g2float *fld)
+//
+//  Scale unpacked integer values back to their original form, as
+//  fld[j] = ((ifld[j]*bscale)+ref)*dscale. The SSE2 path computes the same
+//  single precision operations in the same order, four values at a time.
+//
+{
+      g2int j = 0;
+#if defined(__x86_64) || defined(_M_X64)
+      const __m128 v_bscale = _mm_set1_ps(bscale);
+      const __m128 v_ref = _mm_set1_ps(ref);
+      const __m128 v_dscale = _mm_set1_ps(dscale);
+      for (;j+3<ndpts;j+=4) {
+         const __m128 v = _mm_cvtepi32_ps(
+             _mm_loadu_si128((const __m128i *)(ifld+j)));
+         _mm_storeu_ps(fld+j, _mm_mul_ps(
+             _mm_add_ps(_mm_mul_ps(v, v_bscale), v_ref), v_dscale));
+      }
+#endif
+      for (;j<ndpts;j++) {
+        fld[j]=(((g2float)ifld[j]*bscale)+ref)*dscale;
+      }
+}
+
 g2int simunpack(unsigned char *cpack,g2int cpack_length,g2int *idrstmpl,g2int ndpts,g2float *fld)
 ////$$$  SUBPROGRAM DOCUMENTATION BLOCK
 //                .      .    .                                       .
@@ -67,9 +96,7 @@ g2int simunpack(unsigned char *cpack,g2int cpack_length,g2int *idrstmpl,g2int nd
 //
       if (nbits != 0) {
          gbits(cpack,cpack_length,ifld,0,nbits,0,ndpts);
-         for (j=0;j<ndpts;j++) {
-           fld[j]=(((g2float)ifld[j]*bscale)+ref)*dscale;
-         }
+         simscale(ifld,ndpts,ref,bscale,dscale,fld);
       }
       else {
          for (j=0;j<ndpts;j++) {
@@ -43,6 +43,7 @@
 #endif
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -103,7 +104,8 @@ GRIBRasterBand::GRIBRasterBand( GRIBDataset *poDSIn, int nBandIn,
     m_nGribVersion(psInv->GribVersion),
     m_bHasLookedForNoData(false),
     m_dfNoData(0.0),
-    m_bHasNoData(false)
+    m_bHasNoData(false),
+    m_bPDSTemplateDeferred(false)
 
 {
     poDS = poDSIn;
@@ -583,6 +585,48 @@ void GRIBRasterBand::FindNoDataGrib2(bool bSeekToStart)
     }
 }
 
+/************************************************************************/
+/*                      LoadDeferredPDSTemplate()                       */
+/************************************************************************/
+
+void GRIBRasterBand::LoadDeferredPDSTemplate()
+{
+    if( !m_bPDSTemplateDeferred )
+        return;
+    m_bPDSTemplateDeferred = false;
+
+    CPLMutexHolderD(&hGRIBMutex);
+    // This metadata comes from the file, so must not cause the .aux.xml
+    // to be written.
+    GRIBDataset *poGDS = static_cast<GRIBDataset *>(poDS);
+    const int nOldPamFlags = poGDS->nPamFlags;
+    FindPDSTemplate();
+    poGDS->nPamFlags = nOldPamFlags;
+}
+
+/************************************************************************/
+/*                            GetMetadata()                             */
+/************************************************************************/
+
+char **GRIBRasterBand::GetMetadata( const char *pszDomain )
+{
+    if( pszDomain == nullptr || pszDomain[0] == '\0' )
+        LoadDeferredPDSTemplate();
+    return GDALPamRasterBand::GetMetadata(pszDomain);
+}
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/************************************************************************/
+
+const char *GRIBRasterBand::GetMetadataItem( const char *pszName,
+                                             const char *pszDomain )
+{
+    if( pszDomain == nullptr || pszDomain[0] == '\0' )
+        LoadDeferredPDSTemplate();
+    return GDALPamRasterBand::GetMetadataItem(pszName, pszDomain);
+}
+
 /************************************************************************/
 /*                         GetDescription()                             */
 /************************************************************************/
@@ -928,6 +972,168 @@ int GRIBDataset::Identify( GDALOpenInfo *poOpenInfo )
     return FALSE;
 }
 
+/************************************************************************/
+/*                          InventoryWrapper()                          */
+/************************************************************************/
+
+namespace gdal {
+namespace grib {
+
+static const char* const szIndexSignature = "GDAL_GRIB_INDEX 1";
+
+InventoryWrapper::InventoryWrapper( const char* pszIndexFilename,
+                                    GUIntBig nFileSize, GIntBig nMTime )
+    : inv_(nullptr), inv_len_(0), num_messages_(0), result_(0)
+{
+    VSILFILE* fp = VSIFOpenL(pszIndexFilename, "rb");
+    if( fp == nullptr )
+        return;
+
+    // Header: signature, size and modification time of the GRIB file,
+    // number of messages and of inventory entries.
+    const char* pszLine = CPLReadLineL(fp);
+    bool bOK = pszLine != nullptr && strcmp(pszLine, szIndexSignature) == 0;
+    if( bOK )
+    {
+        pszLine = CPLReadLineL(fp);
+        char** papszTokens =
+            pszLine ? CSLTokenizeString2(pszLine, " ", 0) : nullptr;
+        bOK = CSLCount(papszTokens) == 4 &&
+              CPLScanUIntBig(papszTokens[0],
+                  static_cast<int>(strlen(papszTokens[0]))) == nFileSize &&
+              CPLAtoGIntBig(papszTokens[1]) == nMTime;
+        if( bOK )
+        {
+            num_messages_ = atoi(papszTokens[2]);
+            const int nEntries = atoi(papszTokens[3]);
+            bOK = num_messages_ > 0 && nEntries > 0 &&
+                  nEntries <= 10 * 1000 * 1000;
+            if( bOK )
+            {
+                inv_ = static_cast<inventoryType *>(
+                    VSI_CALLOC_VERBOSE(nEntries, sizeof(inventoryType)));
+                bOK = inv_ != nullptr;
+            }
+            if( bOK )
+                inv_len_ = static_cast<uInt4>(nEntries);
+        }
+        CSLDestroy(papszTokens);
+    }
+
+    // One line per entry, with tab separated, escaped, fields.
+    for( uInt4 i = 0; bOK && i < inv_len_; i++ )
+    {
+        pszLine = CPLReadLineL(fp);
+        char** papszTokens = pszLine ?
+            CSLTokenizeString2(pszLine, "\t", CSLT_ALLOWEMPTYTOKENS) :
+            nullptr;
+        bOK = CSLCount(papszTokens) == 12;
+        if( bOK )
+        {
+            inventoryType* psInv = inv_ + i;
+            psInv->GribVersion = static_cast<sChar>(atoi(papszTokens[0]));
+            psInv->start = CPLScanUIntBig(papszTokens[1],
+                static_cast<int>(strlen(papszTokens[1])));
+            psInv->msgNum =
+                static_cast<unsigned short>(atoi(papszTokens[2]));
+            psInv->subgNum =
+                static_cast<unsigned short>(atoi(papszTokens[3]));
+            psInv->refTime = CPLAtof(papszTokens[4]);
+            psInv->validTime = CPLAtof(papszTokens[5]);
+            psInv->foreSec = CPLAtof(papszTokens[6]);
+            char** ppszStrings[] = { &psInv->element, &psInv->comment,
+                                     &psInv->unitName, &psInv->shortFstLevel,
+                                     &psInv->longFstLevel };
+            for( int j = 0; j < 5; j++ )
+            {
+                // Freed with free() by GRIB2InventoryFree()
+                char* pszUnescaped = CPLUnescapeString(
+                    papszTokens[7 + j], nullptr, CPLES_BackslashQuotable);
+                *(ppszStrings[j]) = strdup(pszUnescaped);
+                CPLFree(pszUnescaped);
+            }
+        }
+        CSLDestroy(papszTokens);
+    }
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+
+    if( bOK )
+    {
+        result_ = static_cast<int>(inv_len_);
+    }
+    else
+    {
+        CPLDebug("GRIB", "Ignoring invalid or outdated index %s",
+                 pszIndexFilename);
+        for( uInt4 i = 0; i < inv_len_; i++ )
+            GRIB2InventoryFree(inv_ + i);
+        free(inv_);
+        inv_ = nullptr;
+        inv_len_ = 0;
+        num_messages_ = 0;
+    }
+}
+
+/************************************************************************/
+/*                             WriteIndex()                             */
+/************************************************************************/
+
+bool InventoryWrapper::WriteIndex( const char* pszIndexFilename,
+                                   GUIntBig nFileSize, GIntBig nMTime ) const
+{
+    if( inv_ == nullptr || inv_len_ == 0 )
+        return false;
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    VSILFILE* fp = VSIFOpenL(pszIndexFilename, "wb");
+    CPLPopErrorHandler();
+    if( fp == nullptr )
+    {
+        CPLDebug("GRIB", "Cannot create index %s", pszIndexFilename);
+        return false;
+    }
+
+    bool bOK = VSIFPrintfL(fp, "%s\n" CPL_FRMT_GUIB " " CPL_FRMT_GIB " %d %u\n",
+                           szIndexSignature, nFileSize, nMTime,
+                           num_messages_, inv_len_) > 0;
+    for( uInt4 i = 0; bOK && i < inv_len_; i++ )
+    {
+        const inventoryType* psInv = inv_ + i;
+        CPLString osLine;
+        osLine.Printf("%d\t" CPL_FRMT_GUIB "\t%d\t%d\t%.17g\t%.17g\t%.17g",
+                      psInv->GribVersion,
+                      static_cast<GUIntBig>(psInv->start),
+                      psInv->msgNum, psInv->subgNum,
+                      psInv->refTime, psInv->validTime, psInv->foreSec);
+        const char* const apszStrings[] = { psInv->element, psInv->comment,
+                                            psInv->unitName,
+                                            psInv->shortFstLevel,
+                                            psInv->longFstLevel };
+        for( const char* pszString : apszStrings )
+        {
+            char* pszEscaped = CPLEscapeString(
+                CPLString(pszString ? pszString : "").replaceAll('\t', ' '),
+                -1, CPLES_BackslashQuotable);
+            osLine += '\t';
+            osLine += pszEscaped;
+            CPLFree(pszEscaped);
+        }
+        osLine += '\n';
+        bOK = VSIFWriteL(osLine.c_str(), osLine.size(), 1, fp) == 1;
+    }
+    if( VSIFCloseL(fp) != 0 )
+        bOK = false;
+    if( !bOK )
+    {
+        CPLDebug("GRIB", "Cannot write index %s", pszIndexFilename);
+        VSIUnlink(pszIndexFilename);
+    }
+    return bOK;
+}
+
+}  // namespace grib
+}  // namespace gdal
+
 /************************************************************************/
 /*                                Open()                                */
 /************************************************************************/
@@ -1000,8 +1206,31 @@ GDALDataset *GRIBDataset::Open( GDALOpenInfo *poOpenInfo )
 
     VSIFSeekL(poDS->fp, 0, SEEK_SET);
 
-    // Contains an GRIB2 message inventory of the file.
-    gdal::grib::InventoryWrapper oInventories(poDS->fp);
+    // Contains an GRIB2 message inventory of the file, possibly loaded from
+    // a sidecar index, which saves scanning the whole file.
+    const bool bUseIndex = CPLTestBool(CPLGetConfigOption("GRIB_INDEX", "NO"));
+    const CPLString osIndexFilename =
+        CPLString(poOpenInfo->pszFilename) + ".gdalidx";
+    VSIStatBufL sStat;
+    if( bUseIndex && VSIStatL(poOpenInfo->pszFilename, &sStat) != 0 )
+        memset(&sStat, 0, sizeof(sStat));
+    std::unique_ptr<gdal::grib::InventoryWrapper> poInventories;
+    bool bFromIndex = false;
+    if( bUseIndex && sStat.st_size > 0 )
+    {
+        poInventories.reset(new gdal::grib::InventoryWrapper(
+            osIndexFilename, static_cast<GUIntBig>(sStat.st_size),
+            static_cast<GIntBig>(sStat.st_mtime)));
+        bFromIndex = poInventories->result() > 0;
+        if( bFromIndex )
+            CPLDebug("GRIB", "Using index %s", osIndexFilename.c_str());
+    }
+    if( !bFromIndex )
+    {
+        VSIFSeekL(poDS->fp, 0, SEEK_SET);
+        poInventories.reset(new gdal::grib::InventoryWrapper(poDS->fp));
+    }
+    gdal::grib::InventoryWrapper& oInventories = *poInventories;
 
     if( oInventories.result() <= 0 )
     {
@@ -1031,26 +1260,31 @@ GDALDataset *GRIBDataset::Open( GDALOpenInfo *poOpenInfo )
 
         // GRIB messages can be preceded by "garbage". GRIB2Inventory()
         // does not return the offset to the real start of the message
-        GByte abyHeader[1024 + 1];
-        VSIFSeekL( poDS->fp, psInv->start, SEEK_SET );
-        size_t nRead = VSIFReadL( abyHeader, 1, sizeof(abyHeader)-1, poDS->fp );
-        abyHeader[nRead] = 0;
-        // Find the real offset of the fist message
-        const char *pasHeader = reinterpret_cast<char *>(abyHeader);
-        int nOffsetFirstMessage = 0;
-        for(int j = 0; j < poOpenInfo->nHeaderBytes - 3; j++)
+        // The index already contains the fixed up offsets.
+        if( !bFromIndex )
         {
-            if(STARTS_WITH_CI(pasHeader + j, "GRIB")
+            GByte abyHeader[1024 + 1];
+            VSIFSeekL( poDS->fp, psInv->start, SEEK_SET );
+            size_t nRead =
+                VSIFReadL( abyHeader, 1, sizeof(abyHeader)-1, poDS->fp );
+            abyHeader[nRead] = 0;
+            // Find the real offset of the fist message
+            const char *pasHeader = reinterpret_cast<char *>(abyHeader);
+            int nOffsetFirstMessage = 0;
+            for(int j = 0; j < poOpenInfo->nHeaderBytes - 3; j++)
+            {
+                if(STARTS_WITH_CI(pasHeader + j, "GRIB")
 #ifdef ENABLE_TDLP
-               || STARTS_WITH_CI(pasHeader + j, "TDLP")
+                   || STARTS_WITH_CI(pasHeader + j, "TDLP")
 #endif
-            )
-            {
-                nOffsetFirstMessage = j;
-                break;
+                )
+                {
+                    nOffsetFirstMessage = j;
+                    break;
+                }
             }
+            psInv->start += nOffsetFirstMessage;
         }
-        psInv->start += nOffsetFirstMessage;
 
         if (bandNr == 1)
         {
@@ -1101,13 +1335,26 @@ GDALDataset *GRIBDataset::Open( GDALOpenInfo *poOpenInfo )
             gribBand = new GRIBRasterBand(poDS, bandNr, psInv);
             if( CPLTestBool(CPLGetConfigOption("GRIB_PDS_ALL_BANDS", "ON")) )
             {
+                // With an index, avoid reading each message at opening.
                 if( psInv->GribVersion == 2 )
-                    gribBand->FindPDSTemplate();
+                {
+                    if( bFromIndex )
+                        gribBand->m_bPDSTemplateDeferred = true;
+                    else
+                        gribBand->FindPDSTemplate();
+                }
             }
         }
         poDS->SetBand(bandNr, gribBand);
     }
 
+    if( bUseIndex && !bFromIndex && sStat.st_size > 0 )
+    {
+        oInventories.WriteIndex(osIndexFilename,
+                                static_cast<GUIntBig>(sStat.st_size),
+                                static_cast<GIntBig>(sStat.st_mtime));
+    }
+
     // Initialize any PAM information.
     poDS->SetDescription(poOpenInfo->pszFilename);
 
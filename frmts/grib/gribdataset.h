@@ -125,6 +125,10 @@ public:
 
     virtual double GetNoDataValue( int *pbSuccess = nullptr ) override;
 
+    virtual char **GetMetadata( const char *pszDomain = "" ) override;
+    virtual const char *GetMetadataItem( const char *pszName,
+                                         const char *pszDomain = "" ) override;
+
     void    FindPDSTemplate();
 
     void    UncacheData();
@@ -132,6 +136,7 @@ public:
 private:
     CPLErr       LoadData();
     void    FindNoDataGrib2(bool bSeekToStart = true);
+    void    LoadDeferredPDSTemplate();
 
     static void ReadGribData( VSILFILE *, vsi_l_offset, int, double **,
                               grib_MetaData ** );
@@ -149,6 +154,9 @@ private:
     bool    m_bHasLookedForNoData;
     double  m_dfNoData;
     bool    m_bHasNoData;
+
+    // FindPDSTemplate() is run on first metadata request.
+    bool    m_bPDSTemplateDeferred;
 };
 
 namespace gdal {
@@ -164,6 +172,16 @@ class InventoryWrapper {
                                0 /* all messages */, &num_messages_);
     }
 
+    // Loads the inventory from a sidecar index written by WriteIndex()
+    // for the GRIB file of the given size and modification time.
+    InventoryWrapper(const char* pszIndexFilename,
+                     GUIntBig nFileSize, GIntBig nMTime);
+
+    // Writes the inventory, with the start of messages as fixed up by
+    // the caller, to a sidecar index.
+    bool WriteIndex(const char* pszIndexFilename,
+                    GUIntBig nFileSize, GIntBig nMTime) const;
+
     ~InventoryWrapper() {
         if (inv_ == nullptr) return;
         for (uInt4 i = 0; i < inv_len_; i++) {
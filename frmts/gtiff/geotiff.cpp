@@ -55,6 +55,8 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -80,6 +82,7 @@
 #include "gdal_pam.h"
 #include "gdal_priv.h"
 #include "gdal_priv_templates.hpp"
+#include "gdal_proxy.h"
 #include "geo_normalize.h"
 #include "geotiff.h"
 #include "geovalues.h"
@@ -106,8 +109,6 @@
 CPL_CVSID("$Id: geotiff.cpp 8b99fd4d3ad3db542705722876fcf484486f46d6 2019-12-17 14:27:30 +0100 Even Rouault $")
 
 static bool bGlobalInExternalOvr = false;
-static std::mutex gMutexThreadPool;
-CPLWorkerThreadPool *gpoCompressThreadPool = nullptr;
 
 // Only libtiff 4.0.4 can handle between 32768 and 65535 directories.
 #if TIFFLIB_VERSION >= 20120922
@@ -239,6 +240,35 @@ typedef struct
     GPtrDiff_t    nCompressedBufferSize;
     bool          bReady;
 } GTiffCompressionJob;
+
+typedef struct
+{
+    int           nBlockId;
+    int           nBlockXOff;
+    int           nBlockYOff;
+    int           nBand;  // 0 for all bands of a pixel-interleaved block.
+    int           nHeight;
+    GByte        *pabyRawBuffer;
+    GPtrDiff_t    nRawBufferSize;
+    GByte        *pabyDecompressedBuffer;
+    GPtrDiff_t    nReqSize;
+    bool          bOK;
+} GTiffDecompressionJob;
+
+struct GTiffDecompressionContext
+{
+    GTiffDataset          *poDS = nullptr;
+    bool                   bTIFFIsBigEndian = false;
+    uint16                 nPredictor = PREDICTOR_NONE;
+    int                    nJPEGColorMode = -1;
+    uint16                 nYCbCrSubsamplingHoriz = 0;
+    uint16                 nYCbCrSubsamplingVert = 0;
+    uint32                 nJPEGTableSize = 0;
+    void                  *pJPEGTable = nullptr;
+    GTiffDecompressionJob *pasJobs = nullptr;
+    int                    nJobs = 0;
+    std::atomic<int>       nNextJob{0};
+};
 #if !defined(__MINGW32__)
 }
 #endif
@@ -278,6 +308,7 @@ class GTiffDataset final : public GDALPamDataset
 
     bool        bScanDeferred;
     void        ScanDirectories();
+    void        LoadDeferredOverviews();
 
     toff_t      nDirOffset;
     bool        bBase;
@@ -333,6 +364,19 @@ class GTiffDataset final : public GDALPamDataset
     int         nOverviewCount;
     GTiffDataset **papoOverviewDS;
 
+    // Overviews whose opening is deferred until they are accessed through
+    // GetOverviewDS(). Only used for read-only datasets, in which case
+    // this has nOverviewCount elements.
+    struct GTiffDeferredOverview
+    {
+        toff_t        nDirOffset = 0;  // 0 once the opening has been tried.
+        int           nXSize = 0;
+        int           nYSize = 0;
+        GTiffDataset *poMaskDS = nullptr;  // Owned until the overview opens.
+    };
+    std::vector<GTiffDeferredOverview> m_aoDeferredOverviews{};
+    GTiffDataset *GetOverviewDS( int i );
+
     // If > 0, the implicit JPEG overviews are visible through
     // GetOverviewCount().
     int         nJPEGOverviewVisibilityCounter;
@@ -451,6 +495,9 @@ class GTiffDataset final : public GDALPamDataset
     CPLString     osGeorefFilename{};
 
     bool          bDirectIO;
+    bool          bDirectIOIfLargeRequest;
+    bool          UseDirectIO( GDALRWFlag eRWFlag, int nXSize, int nYSize,
+                               int nBandCount );
 
     VirtualMemIOEnum eVirtualMemIOUsage;
     CPLVirtualMem* psVirtualMemIOMapping;
@@ -466,7 +513,8 @@ class GTiffDataset final : public GDALPamDataset
     void           DiscardLsb(GByte* pabyBuffer, GPtrDiff_t nBytes, int iBand) const;
     void           GetDiscardLsbOption( char** papszOptions );
 
-    CPLWorkerThreadPool *poCompressThreadPool;
+    // Compression jobs of this dataset, run by the global thread pool.
+    std::unique_ptr<CPLJobQueue> poCompressQueue{};
     std::vector<GTiffCompressionJob> asCompressionJobs{};
     CPLMutex      *hCompressThreadPoolMutex;
     void           InitCompressionThreads( char** papszOptions );
@@ -479,6 +527,18 @@ class GTiffDataset final : public GDALPamDataset
     bool           SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
                                          GPtrDiff_t cc, int nHeight) ;
 
+    int            m_nDecompressionThreads = 0;
+    void           InitDecompressionThreads( char** papszOptions );
+    bool           IsMultiThreadedDecompressionPossible() const;
+    bool           DecompressBlock( const GTiffDecompressionContext* psContext,
+                                    GTiffDecompressionJob* psJob ) const;
+    static void    RunDecompressionJobs( GTiffDecompressionContext* psContext );
+    static void    ThreadDecompressionFunc( void* pData );
+    void           DecompressBlocksMultiThreaded( int nXOff, int nYOff,
+                                                  int nXSize, int nYSize,
+                                                  int nBandCount,
+                                                  const int* panBandMap );
+
     int            GuessJPEGQuality( bool& bOutHasQuantizationTable,
                                      bool& bOutHasHuffmanTable );
 
@@ -625,6 +685,39 @@ class GTiffDataset final : public GDALPamDataset
 /* ==================================================================== */
 /************************************************************************/
 
+// Decoding of a block of an implicit JPEG overview by a worker thread.
+typedef struct
+{
+    int           nBlockXOff;
+    int           nBlockYOff;
+    int           nBand;  // 0 for all bands of a pixel-interleaved block.
+    GByte        *pabyJPEG;  // JPEG tables followed by the tile content.
+    size_t        nJPEGSize;
+    int           nReqXOff;
+    int           nReqYOff;
+    int           nReqXSize;
+    int           nReqYSize;
+    int           nBufXSize;
+    int           nBufYSize;
+    GByte        *pabyDecodedBuffer;
+    bool          bOK;
+} GTiffJPEGOverviewJob;
+
+class GTiffJPEGOverviewBand;
+
+struct GTiffJPEGOverviewContext
+{
+    GTiffJPEGOverviewBand *poBand = nullptr;
+    GDALDataType           eDataType = GDT_Byte;
+    int                    nBlockXSize = 0;
+    int                    nBlockYSize = 0;
+    int                    nJobBands = 0;
+    bool                   bNoJPEGToRGB = false;
+    GTiffJPEGOverviewJob  *pasJobs = nullptr;
+    int                    nJobs = 0;
+    std::atomic<int>       nNextJob{0};
+};
+
 class GTiffJPEGOverviewDS final : public GDALDataset
 {
     CPL_DISALLOW_COPY_ASSIGN(GTiffJPEGOverviewDS)
@@ -642,6 +735,15 @@ class GTiffJPEGOverviewDS final : public GDALDataset
     // Valid block id of the parent DS that match poJPEGDS.
     int          nBlockId;
 
+    static bool  DecodeBlock( const GTiffJPEGOverviewContext* psContext,
+                              GTiffJPEGOverviewJob* psJob );
+    static void  RunDecodingJobs( GTiffJPEGOverviewContext* psContext );
+    static void  ThreadDecodingFunc( void* pData );
+    void         DecodeBlocksMultiThreaded( int nXOff, int nYOff,
+                                            int nXSize, int nYSize,
+                                            int nBandCount,
+                                            const int* panBandMap );
+
   public:
     GTiffJPEGOverviewDS( GTiffDataset* poParentDS, int nOverviewLevel,
                          const void* pJPEGTable, int nJPEGTableSize );
@@ -659,11 +761,25 @@ class GTiffJPEGOverviewDS final : public GDALDataset
 
 class GTiffJPEGOverviewBand final : public GDALRasterBand
 {
+    friend class GTiffJPEGOverviewDS;
+
+    bool    IsSingleStripAsSplit();
+    bool    GetRequestWindow( int nBlockXOff, int nBlockYOff,
+                              bool bIsSingleStripAsSplit,
+                              int nJPEGXSize, int nJPEGYSize,
+                              int& nReqXOff, int& nReqYOff,
+                              int& nReqXSize, int& nReqYSize,
+                              int& nBufXSize, int& nBufYSize );
+
   public:
     GTiffJPEGOverviewBand( GTiffJPEGOverviewDS* poDS, int nBand );
     virtual ~GTiffJPEGOverviewBand() {}
 
     virtual CPLErr IReadBlock( int, int, void * ) override;
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
 };
 
 /************************************************************************/
@@ -734,6 +850,307 @@ GTiffJPEGOverviewDS::~GTiffJPEGOverviewDS()
         VSIUnlink(osTmpFilename);
 }
 
+/************************************************************************/
+/*                            DecodeBlock()                             */
+/************************************************************************/
+
+// Decodes at the overview resolution the JPEG stream of a parent tile
+// into the band sequential buffer of psJob. Called from worker threads,
+// so the parent hTIFF and poJPEGDS must not be used.
+
+bool GTiffJPEGOverviewDS::DecodeBlock(
+    const GTiffJPEGOverviewContext* psContext, GTiffJPEGOverviewJob* psJob )
+{
+    const CPLString osJobFilename(
+        CPLSPrintf("/vsimem/gtiff/thread/jpegovr/%p", psJob));
+    CPL_IGNORE_RET_VAL(VSIFCloseL(
+        VSIFileFromMemBuffer(osJobFilename, psJob->pabyJPEG,
+                             psJob->nJPEGSize, FALSE)));
+
+    if( psContext->bNoJPEGToRGB )
+        CPLSetThreadLocalConfigOption("GDAL_JPEG_TO_RGB", "NO");
+    const char* apszDrivers[] = { "JPEG", nullptr };
+    GDALDataset* poTileDS = static_cast<GDALDataset *>( GDALOpenEx(
+        osJobFilename, GDAL_OF_RASTER | GDAL_OF_INTERNAL,
+        apszDrivers, nullptr, nullptr) );
+    if( psContext->bNoJPEGToRGB )
+        CPLSetThreadLocalConfigOption("GDAL_JPEG_TO_RGB", nullptr);
+
+    bool bOK = false;
+    if( poTileDS != nullptr &&
+        poTileDS->GetRasterCount() >= psContext->nJobBands )
+    {
+        // Same as in GTiffJPEGOverviewBand::IReadBlock()
+        CPLSetThreadLocalConfigOption( "JPEG_FORCE_INTERNAL_OVERVIEWS",
+                                       "YES");
+        GDALGetOverviewCount(GDALGetRasterBand(poTileDS, 1));
+        CPLSetThreadLocalConfigOption( "JPEG_FORCE_INTERNAL_OVERVIEWS",
+                                       nullptr);
+
+        int nReqXOff = 0;
+        int nReqYOff = 0;
+        int nReqXSize = 0;
+        int nReqYSize = 0;
+        int nBufXSize = 0;
+        int nBufYSize = 0;
+        psContext->poBand->GetRequestWindow(
+            psJob->nBlockXOff, psJob->nBlockYOff, false,
+            poTileDS->GetRasterXSize(), poTileDS->GetRasterYSize(),
+            nReqXOff, nReqYOff, nReqXSize, nReqYSize, nBufXSize, nBufYSize );
+
+        const int nDTSize = GDALGetDataTypeSizeBytes(psContext->eDataType);
+        const GSpacing nLineSpace =
+            static_cast<GSpacing>(psContext->nBlockXSize) * nDTSize;
+        bOK = poTileDS->RasterIO(GF_Read,
+                                 nReqXOff, nReqYOff, nReqXSize, nReqYSize,
+                                 psJob->pabyDecodedBuffer,
+                                 nBufXSize, nBufYSize, psContext->eDataType,
+                                 psContext->nJobBands, nullptr,
+                                 nDTSize, nLineSpace,
+                                 nLineSpace * psContext->nBlockYSize,
+                                 nullptr) == CE_None;
+    }
+    if( poTileDS != nullptr )
+        GDALClose(poTileDS);
+
+    VSIUnlink(osJobFilename);
+    return bOK;
+}
+
+/************************************************************************/
+/*                          RunDecodingJobs()                           */
+/************************************************************************/
+
+void GTiffJPEGOverviewDS::RunDecodingJobs(
+                                    GTiffJPEGOverviewContext* psContext )
+{
+    // Blocks that fail to decode are left to IReadBlock(), which will
+    // emit the appropriate error.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    while( true )
+    {
+        const int iJob = psContext->nNextJob++;
+        if( iJob >= psContext->nJobs )
+            break;
+        GTiffJPEGOverviewJob* psJob = &psContext->pasJobs[iJob];
+        psJob->bOK = DecodeBlock(psContext, psJob);
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                         ThreadDecodingFunc()                         */
+/************************************************************************/
+
+void GTiffJPEGOverviewDS::ThreadDecodingFunc( void* pData )
+{
+    RunDecodingJobs(static_cast<GTiffJPEGOverviewContext *>(pData));
+}
+
+/************************************************************************/
+/*                     DecodeBlocksMultiThreaded()                      */
+/************************************************************************/
+
+// Same principle as GTiffDataset::DecompressBlocksMultiThreaded(): the
+// tiles of the parent dataset intersecting the window, whose overview
+// blocks are not yet cached, are decoded in parallel with DCT scaling, and
+// pushed into the block cache. Only done for tiled files, as strips may
+// be very large, and are generally read sequentially.
+
+void GTiffJPEGOverviewDS::DecodeBlocksMultiThreaded( int nXOff, int nYOff,
+                                                     int nXSize, int nYSize,
+                                                     int nBandCount,
+                                                     const int* panBandMap )
+{
+    const int nThreads = poParentDS->poBaseDS ?
+                            poParentDS->poBaseDS->m_nDecompressionThreads :
+                            poParentDS->m_nDecompressionThreads;
+    if( nThreads <= 1 || !poParentDS->SetDirectory() ||
+        !TIFFIsTiled(poParentDS->hTIFF) )
+        return;
+
+    GTiffJPEGOverviewBand* poBand1 =
+        cpl::down_cast<GTiffJPEGOverviewBand *>(GetRasterBand(1));
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poBand1->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const GDALDataType eDT = poBand1->GetRasterDataType();
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+
+    const int nBlocksPerRow = DIV_ROUND_UP(poParentDS->nRasterXSize,
+                                           poParentDS->nBlockXSize);
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    const GIntBig nBlocks = static_cast<GIntBig>(nBlockX2 - nBlockX1 + 1) *
+                            (nBlockY2 - nBlockY1 + 1);
+    if( nBlocks < 2 )
+        return;
+
+    const bool bPixelInterleaved =
+        nBands > 1 && poParentDS->nPlanarConfig == PLANARCONFIG_CONTIG;
+    const int nJobBands = bPixelInterleaved ? nBands : 1;
+    const GPtrDiff_t nBlockBufSize =
+        static_cast<GPtrDiff_t>(nBlockXSize) * nBlockYSize * nDTSize *
+        nJobBands;
+    if( nBlocks * (bPixelInterleaved ? 1 : nBandCount) * nBlockBufSize >
+            GDALGetCacheMax64() / 2 )
+    {
+        CPLDebug("GTiff", "Multi-threaded decoding skipped: "
+                 "block cache not big enough");
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Collect the blocks to decode, and read their JPEG streams.      */
+/* -------------------------------------------------------------------- */
+    VSILFILE* fpTIF = VSI_TIFFGetVSILFile(TIFFClientdata( poParentDS->hTIFF ));
+    std::vector<GTiffJPEGOverviewJob> asJobs;
+    bool bOK = true;
+    for( int iY = nBlockY1; bOK && iY <= nBlockY2; iY++ )
+    {
+        for( int iX = nBlockX1; bOK && iX <= nBlockX2; iX++ )
+        {
+            for( int i = 0; i < (bPixelInterleaved ? 1 : nBandCount); i++ )
+            {
+                const int nJobBand = bPixelInterleaved ? 0 : panBandMap[i];
+                GDALRasterBlock* poBlock =
+                    cpl::down_cast<GTiffJPEGOverviewBand *>(
+                        GetRasterBand(bPixelInterleaved ? 1 : nJobBand))->
+                            TryGetLockedBlockRef(iX, iY);
+                if( poBlock != nullptr )
+                {
+                    poBlock->DropLock();
+                    continue;
+                }
+
+                int l_nBlockId = iX + iY * nBlocksPerRow;
+                if( !bPixelInterleaved &&
+                    poParentDS->nPlanarConfig == PLANARCONFIG_SEPARATE )
+                {
+                    l_nBlockId += (nJobBand - 1) * poParentDS->nBlocksPerBand;
+                }
+                vsi_l_offset nOffset = 0;
+                vsi_l_offset nByteCount = 0;
+                // Sparse blocks are left to IReadBlock()
+                if( !poParentDS->IsBlockAvailable(l_nBlockId, &nOffset,
+                                                  &nByteCount) ||
+                    nByteCount < 2 || nByteCount >= 256 * 256 )
+                {
+                    continue;
+                }
+                nOffset += 2;  // Skip leading 0xFF 0xF8.
+                nByteCount -= 2;
+
+                GTiffJPEGOverviewJob sJob;
+                memset(&sJob, 0, sizeof(sJob));
+                sJob.nBlockXOff = iX;
+                sJob.nBlockYOff = iY;
+                sJob.nBand = nJobBand;
+                sJob.nJPEGSize =
+                    nJPEGTableSize + static_cast<size_t>(nByteCount);
+                sJob.pabyJPEG = static_cast<GByte*>(
+                    VSI_MALLOC_VERBOSE(sJob.nJPEGSize));
+                sJob.pabyDecodedBuffer = static_cast<GByte*>(
+                    VSI_CALLOC_VERBOSE(1, nBlockBufSize));
+                if( sJob.pabyJPEG == nullptr ||
+                    sJob.pabyDecodedBuffer == nullptr )
+                {
+                    CPLFree(sJob.pabyJPEG);
+                    CPLFree(sJob.pabyDecodedBuffer);
+                    bOK = false;
+                    break;
+                }
+                memcpy(sJob.pabyJPEG, pabyJPEGTable, nJPEGTableSize);
+                if( VSIFSeekL(fpTIF, nOffset, SEEK_SET) != 0 ||
+                    VSIFReadL(sJob.pabyJPEG + nJPEGTableSize,
+                              static_cast<size_t>(nByteCount), 1,
+                              fpTIF) != 1 )
+                {
+                    CPLFree(sJob.pabyJPEG);
+                    CPLFree(sJob.pabyDecodedBuffer);
+                    continue;
+                }
+                asJobs.push_back(sJob);
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Decode them in the worker threads and the calling one.          */
+/* -------------------------------------------------------------------- */
+    if( bOK && asJobs.size() >= 2 )
+    {
+        GTiffJPEGOverviewContext sContext;
+        sContext.poBand = poBand1;
+        sContext.eDataType = eDT;
+        sContext.nBlockXSize = nBlockXSize;
+        sContext.nBlockYSize = nBlockYSize;
+        sContext.nJobBands = nJobBands;
+        sContext.bNoJPEGToRGB = bPixelInterleaved && nBands == 4;
+        sContext.pasJobs = &asJobs[0];
+        sContext.nJobs = static_cast<int>(asJobs.size());
+
+        // The calling thread is one of the nThreads decoding threads.
+        // The other ones are jobs of the global pool, shared with the
+        // other users of GDAL_NUM_THREADS, such as the compression.
+        const int nWorkers = std::min(nThreads, sContext.nJobs) - 1;
+        std::unique_ptr<CPLJobQueue> poQueue;
+        if( nWorkers > 0 )
+        {
+            CPLWorkerThreadPool* poPool =
+                CPLGetGlobalWorkerThreadPool(nThreads);
+            if( poPool != nullptr )
+                poQueue = poPool->CreateJobQueue();
+        }
+        if( poQueue != nullptr )
+        {
+            for( int i = 0; i < nWorkers; i++ )
+            {
+                if( !poQueue->SubmitJob(ThreadDecodingFunc, &sContext) )
+                    break;
+            }
+        }
+
+        RunDecodingJobs(&sContext);
+
+        if( poQueue != nullptr )
+            poQueue->WaitCompletion();
+
+/* -------------------------------------------------------------------- */
+/*      Push the decoded blocks into the block cache.                   */
+/* -------------------------------------------------------------------- */
+        const GPtrDiff_t nBandBlockSize =
+            static_cast<GPtrDiff_t>(nBlockXSize) * nBlockYSize * nDTSize;
+        for( const auto& sJob: asJobs )
+        {
+            if( !sJob.bOK )
+                continue;
+            const int nFirstBand = sJob.nBand == 0 ? 1 : sJob.nBand;
+            const int nLastBand = sJob.nBand == 0 ? nBands : sJob.nBand;
+            for( int iBand = nFirstBand; iBand <= nLastBand; iBand++ )
+            {
+                GDALRasterBlock* poBlock = GetRasterBand(iBand)->
+                    GetLockedBlockRef(sJob.nBlockXOff, sJob.nBlockYOff, TRUE);
+                if( poBlock == nullptr )
+                    continue;
+                memcpy(poBlock->GetDataRef(),
+                       sJob.pabyDecodedBuffer +
+                            (iBand - nFirstBand) * nBandBlockSize,
+                       nBandBlockSize);
+                poBlock->DropLock();
+            }
+        }
+    }
+
+    for( auto& sJob: asJobs )
+    {
+        CPLFree(sJob.pabyJPEG);
+        CPLFree(sJob.pabyDecodedBuffer);
+    }
+}
+
 /************************************************************************/
 /*                            IRasterIO()                               */
 /************************************************************************/
@@ -749,6 +1166,12 @@ CPLErr GTiffJPEGOverviewDS::IRasterIO(
     GDALRasterIOExtraArg* psExtraArg )
 
 {
+    if( eRWFlag == GF_Read )
+    {
+        DecodeBlocksMultiThreaded(nXOff, nYOff, nXSize, nYSize,
+                                  nBandCount, panBandMap);
+    }
+
     // For non-single strip JPEG-IN-TIFF, the block based strategy will
     // be the most efficient one, to avoid decompressing the JPEG content
     // for each requested band.
@@ -788,6 +1211,121 @@ GTiffJPEGOverviewBand::GTiffJPEGOverviewBand( GTiffJPEGOverviewDS* poDSIn,
     nBlockYSize = (nBlockYSize + nScaleFactor - 1) / nScaleFactor;
 }
 
+/************************************************************************/
+/*                            IRasterIO()                               */
+/************************************************************************/
+
+CPLErr GTiffJPEGOverviewBand::IRasterIO( GDALRWFlag eRWFlag,
+                                         int nXOff, int nYOff,
+                                         int nXSize, int nYSize,
+                                         void * pData,
+                                         int nBufXSize, int nBufYSize,
+                                         GDALDataType eBufType,
+                                         GSpacing nPixelSpace,
+                                         GSpacing nLineSpace,
+                                         GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read )
+    {
+        cpl::down_cast<GTiffJPEGOverviewDS *>(poDS)->
+            DecodeBlocksMultiThreaded(nXOff, nYOff, nXSize, nYSize,
+                                      1, &nBand);
+    }
+    return GDALRasterBand::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                      pData, nBufXSize, nBufYSize, eBufType,
+                                      nPixelSpace, nLineSpace, psExtraArg );
+}
+
+/************************************************************************/
+/*                        IsSingleStripAsSplit()                        */
+/************************************************************************/
+
+bool GTiffJPEGOverviewBand::IsSingleStripAsSplit()
+{
+    GTiffJPEGOverviewDS* poGDS = cpl::down_cast<GTiffJPEGOverviewDS *>(poDS);
+    int nParentBlockXSize, nParentBlockYSize;
+    poGDS->poParentDS->GetRasterBand(1)->
+        GetBlockSize(&nParentBlockXSize, &nParentBlockYSize);
+    return nParentBlockYSize == 1 &&
+           poGDS->poParentDS->nBlockYSize != nParentBlockYSize;
+}
+
+/************************************************************************/
+/*                          GetRequestWindow()                          */
+/************************************************************************/
+
+// Computes the window of the JPEG stream of the parent strip/tile, of
+// dimension nJPEGXSize x nJPEGYSize, to read at full resolution, and the
+// part of the block it fills. Returns true if the block is only partially
+// filled.
+
+bool GTiffJPEGOverviewBand::GetRequestWindow( int nBlockXOff, int nBlockYOff,
+                                              bool bIsSingleStripAsSplit,
+                                              int nJPEGXSize, int nJPEGYSize,
+                                              int& nReqXOff, int& nReqYOff,
+                                              int& nReqXSize, int& nReqYSize,
+                                              int& nBufXSize, int& nBufYSize )
+{
+    GTiffJPEGOverviewDS* poGDS = cpl::down_cast<GTiffJPEGOverviewDS *>(poDS);
+    const int nScaleFactor = 1 << poGDS->nOverviewLevel;
+
+    nReqXOff = 0;
+    nReqYOff = 0;
+    if( bIsSingleStripAsSplit )
+    {
+        nReqYOff = nBlockYOff * nScaleFactor;
+        nReqXSize = nJPEGXSize;
+        nReqYSize = nScaleFactor;
+    }
+    else
+    {
+        if( nBlockXSize == poGDS->GetRasterXSize() )
+        {
+            nReqXSize = nJPEGXSize;
+        }
+        else
+        {
+            nReqXSize = nBlockXSize * nScaleFactor;
+        }
+        nReqYSize = nBlockYSize * nScaleFactor;
+    }
+    nBufXSize = nBlockXSize;
+    nBufYSize = nBlockYSize;
+    if( nBlockXOff == DIV_ROUND_UP(poGDS->poParentDS->nRasterXSize,
+                                   poGDS->poParentDS->nBlockXSize) - 1 )
+    {
+        nReqXSize = poGDS->poParentDS->nRasterXSize -
+                            nBlockXOff * poGDS->poParentDS->nBlockXSize;
+    }
+    if( nReqXOff + nReqXSize > nJPEGXSize )
+    {
+        nReqXSize = nJPEGXSize - nReqXOff;
+    }
+    if( !bIsSingleStripAsSplit &&
+        nBlockYOff == DIV_ROUND_UP(poGDS->poParentDS->nRasterYSize,
+                                   poGDS->poParentDS->nBlockYSize) - 1 )
+    {
+        nReqYSize = poGDS->poParentDS->nRasterYSize -
+                            nBlockYOff * poGDS->poParentDS->nBlockYSize;
+    }
+    if( nReqYOff + nReqYSize > nJPEGYSize )
+    {
+        nReqYSize = nJPEGYSize - nReqYOff;
+    }
+    bool bPartial = false;
+    if( nBlockXOff * nBlockXSize > poGDS->GetRasterXSize() - nBufXSize )
+    {
+        bPartial = true;
+        nBufXSize = poGDS->GetRasterXSize() - nBlockXOff * nBlockXSize;
+    }
+    if( nBlockYOff * nBlockYSize > poGDS->GetRasterYSize() - nBufYSize )
+    {
+        bPartial = true;
+        nBufYSize = poGDS->GetRasterYSize() - nBlockYOff * nBlockYSize;
+    }
+    return bPartial;
+}
+
 /************************************************************************/
 /*                          IReadBlock()                                */
 /************************************************************************/
@@ -799,11 +1337,7 @@ CPLErr GTiffJPEGOverviewBand::IReadBlock( int nBlockXOff, int nBlockYOff,
 
     // Compute the source block ID.
     int nBlockId = 0;
-    int nParentBlockXSize, nParentBlockYSize;
-    poGDS->poParentDS->GetRasterBand(1)->
-        GetBlockSize(&nParentBlockXSize, &nParentBlockYSize);
-    const bool bIsSingleStripAsSplit = (nParentBlockYSize == 1 &&
-                           poGDS->poParentDS->nBlockYSize != nParentBlockYSize);
+    const bool bIsSingleStripAsSplit = IsSingleStripAsSplit();
     if( !bIsSingleStripAsSplit )
     {
         int l_nBlocksPerRow = DIV_ROUND_UP(poGDS->poParentDS->nRasterXSize,
@@ -1001,56 +1535,15 @@ CPLErr GTiffJPEGOverviewBand::IReadBlock( int nBlockXOff, int nBlockYOff,
         int nReqYOff = 0;
         int nReqXSize = 0;
         int nReqYSize = 0;
-        if( bIsSingleStripAsSplit )
-        {
-            nReqYOff = nBlockYOff * nScaleFactor;
-            nReqXSize = l_poDS->GetRasterXSize();
-            nReqYSize = nScaleFactor;
-        }
-        else
-        {
-            if( nBlockXSize == poGDS->GetRasterXSize() )
-            {
-                nReqXSize = l_poDS->GetRasterXSize();
-            }
-            else
-            {
-                nReqXSize = nBlockXSize * nScaleFactor;
-            }
-            nReqYSize = nBlockYSize * nScaleFactor;
-        }
-        int nBufXSize = nBlockXSize;
-        int nBufYSize = nBlockYSize;
-        if( nBlockXOff == DIV_ROUND_UP(poGDS->poParentDS->nRasterXSize,
-                                       poGDS->poParentDS->nBlockXSize) - 1 )
-        {
-            nReqXSize = poGDS->poParentDS->nRasterXSize -
-                                nBlockXOff * poGDS->poParentDS->nBlockXSize;
-        }
-        if( nReqXOff + nReqXSize > l_poDS->GetRasterXSize() )
-        {
-            nReqXSize = l_poDS->GetRasterXSize() - nReqXOff;
-        }
-        if( !bIsSingleStripAsSplit &&
-            nBlockYOff == DIV_ROUND_UP(poGDS->poParentDS->nRasterYSize,
-                                       poGDS->poParentDS->nBlockYSize) - 1 )
-        {
-            nReqYSize = poGDS->poParentDS->nRasterYSize -
-                                nBlockYOff * poGDS->poParentDS->nBlockYSize;
-        }
-        if( nReqYOff + nReqYSize > l_poDS->GetRasterYSize() )
-        {
-            nReqYSize = l_poDS->GetRasterYSize() - nReqYOff;
-        }
-        if( nBlockXOff * nBlockXSize > poGDS->GetRasterXSize() - nBufXSize )
-        {
-            memset(pImage, 0, static_cast<GPtrDiff_t>(nBlockXSize) * nBlockYSize * nDataTypeSize);
-            nBufXSize = poGDS->GetRasterXSize() - nBlockXOff * nBlockXSize;
-        }
-        if( nBlockYOff * nBlockYSize > poGDS->GetRasterYSize() - nBufYSize )
+        int nBufXSize = 0;
+        int nBufYSize = 0;
+        if( GetRequestWindow( nBlockXOff, nBlockYOff, bIsSingleStripAsSplit,
+                              l_poDS->GetRasterXSize(),
+                              l_poDS->GetRasterYSize(),
+                              nReqXOff, nReqYOff, nReqXSize, nReqYSize,
+                              nBufXSize, nBufYSize ) )
         {
             memset(pImage, 0, static_cast<GPtrDiff_t>(nBlockXSize) * nBlockYSize * nDataTypeSize);
-            nBufYSize = poGDS->GetRasterYSize() - nBlockYOff * nBlockYSize;
         }
 
         const int nSrcBand =
@@ -1083,7 +1576,7 @@ void GTIFFSetJpegQuality( GDALDatasetH hGTIFFDS, int nJpegQuality )
     GTiffDataset* const poDS = static_cast<GTiffDataset *>(hGTIFFDS);
     poDS->nJpegQuality = nJpegQuality;
 
-    poDS->ScanDirectories();
+    poDS->LoadDeferredOverviews();
 
     for( int i = 0; i < poDS->nOverviewCount; ++i )
         poDS->papoOverviewDS[i]->nJpegQuality = nJpegQuality;
@@ -1103,7 +1596,7 @@ void GTIFFSetJpegTablesMode( GDALDatasetH hGTIFFDS, int nJpegTablesMode )
     GTiffDataset* const poDS = static_cast<GTiffDataset *>(hGTIFFDS);
     poDS->nJpegTablesMode = nJpegTablesMode;
 
-    poDS->ScanDirectories();
+    poDS->LoadDeferredOverviews();
 
     for( int i = 0; i < poDS->nOverviewCount; ++i )
         poDS->papoOverviewDS[i]->nJpegTablesMode = nJpegTablesMode;
@@ -1146,6 +1639,7 @@ class GTiffRasterBand : public GDALPamRasterBand
     void*           CacheMultiRange( int nXOff, int nYOff,
                                      int nXSize, int nYSize,
                                      int nBufXSize, int nBufYSize,
+                                     int nBandCount, const int* panBandMap,
                                      GDALRasterIOExtraArg* psExtraArg );
 
 protected:
@@ -2114,6 +2608,427 @@ int GTiffDataset::HasOptimizedReadMultiRange()
     return m_nHasOptimizedReadMultiRange;
 }
 
+/************************************************************************/
+/*                      InitDecompressionThreads()                      */
+/************************************************************************/
+
+void GTiffDataset::InitDecompressionThreads( char** papszOptions )
+{
+    // Raster == tile, then no need for threads
+    if( nBlockXSize == nRasterXSize && nBlockYSize == nRasterYSize )
+        return;
+
+    const char* pszValue = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszValue == nullptr )
+        pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", nullptr);
+    if( pszValue )
+    {
+        const int nThreads = CPLGetNumThreads(papszOptions);
+        if( nThreads > 1 )
+        {
+            m_nDecompressionThreads = nThreads;
+        }
+        else if( atoi(pszValue) < 0 ||
+                 (!EQUAL(pszValue, "0") &&
+                  !EQUAL(pszValue, "1") &&
+                  !EQUAL(pszValue, "ALL_CPUS")) )
+        {
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "Invalid value for NUM_THREADS: %s", pszValue);
+        }
+    }
+}
+
+/************************************************************************/
+/*                 IsMultiThreadedDecompressionPossible()               */
+/************************************************************************/
+
+bool GTiffDataset::IsMultiThreadedDecompressionPossible() const
+{
+    static const CPLCachedConfigOption oConvertYCbCrToRGB(
+        "CONVERT_YCBCR_TO_RGB", "YES");
+
+    // Overviews and masks inherit the setting of their base dataset.
+    const int nThreads = poBaseDS ? poBaseDS->m_nDecompressionThreads :
+                                    m_nDecompressionThreads;
+    if( nThreads <= 1 || eAccess != GA_ReadOnly || bStreamingIn ||
+        bTreatAsRGBA || bTreatAsSplit || bTreatAsSplitBitmap )
+        return false;
+
+    // Only the data types handled by GTiffRasterBand itself.
+    if( !(nBitsPerSample == 8 || nBitsPerSample == 16 ||
+          nBitsPerSample == 32 || nBitsPerSample == 64) ||
+        (nBitsPerSample == 16 && nSampleFormat == SAMPLEFORMAT_IEEEFP) )
+        return false;
+
+    return nCompression == COMPRESSION_ADOBE_DEFLATE ||
+           nCompression == COMPRESSION_LZW ||
+           nCompression == COMPRESSION_PACKBITS ||
+           nCompression == COMPRESSION_LZMA ||
+           nCompression == COMPRESSION_ZSTD ||
+           nCompression == COMPRESSION_WEBP ||
+           (nCompression == COMPRESSION_JPEG && nBitsPerSample == 8 &&
+            (nPhotometric != PHOTOMETRIC_YCBCR ||
+             oConvertYCbCrToRGB.GetBool()));
+}
+
+/************************************************************************/
+/*                          DecompressBlock()                           */
+/************************************************************************/
+
+// Decodes the raw strip/tile of psJob into its decompressed buffer, by
+// writing it as the single strip of a temporary in-memory TIFF file, and
+// reading it back. Called from worker threads, so hTIFF must not be used.
+
+bool GTiffDataset::DecompressBlock( const GTiffDecompressionContext* psContext,
+                                    GTiffDecompressionJob* psJob ) const
+{
+    const CPLString osJobFilename(
+        CPLSPrintf("/vsimem/gtiff/thread/decompress/%p", psJob));
+    // A single plane of a pixel-interleaved image, or of a band of a
+    // band-interleaved one.
+    const bool bAllSamples = psJob->nBand == 0;
+
+    VSILFILE* fpTmp = VSIFOpenL(osJobFilename, "wb+");
+    if( fpTmp == nullptr )
+        return false;
+    TIFF* hTIFFTmp = VSI_TIFFOpen(osJobFilename,
+        psContext->bTIFFIsBigEndian ? "wb+" : "wl+", fpTmp);
+    if( hTIFFTmp == nullptr )
+    {
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpTmp));
+        VSIUnlink(osJobFilename);
+        return false;
+    }
+    TIFFSetField(hTIFFTmp, TIFFTAG_IMAGEWIDTH, nBlockXSize);
+    TIFFSetField(hTIFFTmp, TIFFTAG_IMAGELENGTH, psJob->nHeight);
+    TIFFSetField(hTIFFTmp, TIFFTAG_BITSPERSAMPLE, nBitsPerSample);
+    TIFFSetField(hTIFFTmp, TIFFTAG_COMPRESSION, nCompression);
+    if( psContext->nPredictor != PREDICTOR_NONE )
+        TIFFSetField(hTIFFTmp, TIFFTAG_PREDICTOR, psContext->nPredictor);
+    TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLEFORMAT, nSampleFormat);
+    TIFFSetField(hTIFFTmp, TIFFTAG_ROWSPERSTRIP, psJob->nHeight);
+    TIFFSetField(hTIFFTmp, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    if( bAllSamples )
+    {
+        TIFFSetField(hTIFFTmp, TIFFTAG_PHOTOMETRIC, nPhotometric);
+        TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLESPERPIXEL, nSamplesPerPixel);
+        if( nPhotometric == PHOTOMETRIC_YCBCR &&
+            psContext->nYCbCrSubsamplingHoriz != 0 )
+        {
+            TIFFSetField(hTIFFTmp, TIFFTAG_YCBCRSUBSAMPLING,
+                         psContext->nYCbCrSubsamplingHoriz,
+                         psContext->nYCbCrSubsamplingVert);
+        }
+    }
+    else
+    {
+        TIFFSetField(hTIFFTmp, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+        TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLESPERPIXEL, 1);
+    }
+    if( psContext->pJPEGTable != nullptr )
+    {
+        TIFFSetField(hTIFFTmp, TIFFTAG_JPEGTABLES,
+                     psContext->nJPEGTableSize, psContext->pJPEGTable);
+    }
+
+    bool bOK =
+        TIFFWriteRawStrip(hTIFFTmp, 0, psJob->pabyRawBuffer,
+                          psJob->nRawBufferSize) == psJob->nRawBufferSize;
+    XTIFFClose(hTIFFTmp);
+
+    if( bOK )
+    {
+        hTIFFTmp = VSI_TIFFOpen(osJobFilename, "r", fpTmp);
+        bOK = hTIFFTmp != nullptr;
+        if( bOK )
+        {
+            if( bAllSamples && psContext->nJPEGColorMode >= 0 )
+            {
+                TIFFSetField(hTIFFTmp, TIFFTAG_JPEGCOLORMODE,
+                             psContext->nJPEGColorMode);
+            }
+            bOK = TIFFReadEncodedStrip(hTIFFTmp, 0,
+                                       psJob->pabyDecompressedBuffer,
+                                       psJob->nReqSize) != -1;
+            XTIFFClose(hTIFFTmp);
+        }
+    }
+
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fpTmp));
+    VSIUnlink(osJobFilename);
+    return bOK;
+}
+
+/************************************************************************/
+/*                        RunDecompressionJobs()                        */
+/************************************************************************/
+
+void GTiffDataset::RunDecompressionJobs( GTiffDecompressionContext* psContext )
+{
+    // Errors are not reported from there: blocks that fail to decode are
+    // left to IReadBlock(), which will emit the appropriate error.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    while( true )
+    {
+        const int iJob = psContext->nNextJob++;
+        if( iJob >= psContext->nJobs )
+            break;
+        GTiffDecompressionJob* psJob = &psContext->pasJobs[iJob];
+        psJob->bOK = psContext->poDS->DecompressBlock(psContext, psJob);
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                      ThreadDecompressionFunc()                       */
+/************************************************************************/
+
+void GTiffDataset::ThreadDecompressionFunc( void* pData )
+{
+    RunDecompressionJobs(static_cast<GTiffDecompressionContext *>(pData));
+}
+
+/************************************************************************/
+/*                   DecompressBlocksMultiThreaded()                    */
+/************************************************************************/
+
+// Decodes in parallel the blocks intersecting the requested window that
+// are not yet in the block cache, and push them into it, so that the
+// following generic RasterIO() only has to fetch them from there.
+// I/O is done from the calling thread, decompression in worker threads.
+
+void GTiffDataset::DecompressBlocksMultiThreaded( int nXOff, int nYOff,
+                                                  int nXSize, int nYSize,
+                                                  int nBandCount,
+                                                  const int* panBandMap )
+{
+    if( !IsMultiThreadedDecompressionPossible() || !SetDirectory() )
+        return;
+
+    const bool bIsTiled = CPL_TO_BOOL( TIFFIsTiled(hTIFF) );
+    const GPtrDiff_t nBlockBufSize = static_cast<GPtrDiff_t>(
+        bIsTiled ? TIFFTileSize(hTIFF) : TIFFStripSize(hTIFF));
+    if( nBlockBufSize == 0 )
+        return;
+
+    const int nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    const GIntBig nBlocks = static_cast<GIntBig>(nBlockX2 - nBlockX1 + 1) *
+                            (nBlockY2 - nBlockY1 + 1);
+    if( nBlocks < 2 )
+        return;
+
+    const bool bPixelInterleaved =
+        nBands > 1 && nPlanarConfig == PLANARCONFIG_CONTIG;
+    const int nJobBands = bPixelInterleaved ? 1 : nBandCount;
+
+    // The decompressed blocks must all fit in the block cache, otherwise
+    // the first ones would be evicted before being used.
+    if( nBlocks * nJobBands * nBlockBufSize > GDALGetCacheMax64() / 2 )
+    {
+        CPLDebug("GTiff", "Multi-threaded decompression skipped: "
+                 "block cache not big enough");
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Collect the blocks to decompress, and read their raw data.      */
+/* -------------------------------------------------------------------- */
+    std::vector<GTiffDecompressionJob> asJobs;
+    bool bOK = true;
+    for( int iY = nBlockY1; bOK && iY <= nBlockY2; iY++ )
+    {
+        for( int iX = nBlockX1; bOK && iX <= nBlockX2; iX++ )
+        {
+            for( int i = 0; i < nJobBands; i++ )
+            {
+                const int nJobBand = bPixelInterleaved ? 0 : panBandMap[i];
+                GDALRasterBlock* poBlock = cpl::down_cast<GTiffRasterBand*>(
+                    GetRasterBand(bPixelInterleaved ? 1 : nJobBand))->
+                        TryGetLockedBlockRef(iX, iY);
+                if( poBlock != nullptr )
+                {
+                    poBlock->DropLock();
+                    continue;
+                }
+
+                int nBlockId = iX + iY * nBlocksPerRow;
+                if( nPlanarConfig == PLANARCONFIG_SEPARATE )
+                    nBlockId += (nJobBand - 1) * nBlocksPerBand;
+                vsi_l_offset nOffset = 0;
+                vsi_l_offset nSize = 0;
+                // Sparse blocks are left to IReadBlock()
+                if( nBlockId == nLoadedBlock ||
+                    !IsBlockAvailable(nBlockId, &nOffset, &nSize) ||
+                    nSize == 0 ||
+                    nSize > static_cast<vsi_l_offset>(
+                        std::numeric_limits<tmsize_t>::max()) )
+                {
+                    continue;
+                }
+
+                GTiffDecompressionJob sJob;
+                memset(&sJob, 0, sizeof(sJob));
+                sJob.nBlockId = nBlockId;
+                sJob.nBlockXOff = iX;
+                sJob.nBlockYOff = iY;
+                sJob.nBand = nJobBand;
+                sJob.nHeight = nBlockYSize;
+                sJob.nReqSize = nBlockBufSize;
+                // Same logic as in IReadBlock() for the bottom most
+                // partial tiles and strips.
+                if( iY * nBlockYSize > nRasterYSize - nBlockYSize )
+                {
+                    const int nRows = nBlockYSize - static_cast<int>(
+                        (static_cast<GIntBig>(iY + 1) * nBlockYSize)
+                            % nRasterYSize);
+                    sJob.nReqSize = (nBlockBufSize / nBlockYSize) * nRows;
+                    if( !bIsTiled )
+                        sJob.nHeight = nRows;
+                }
+                sJob.nRawBufferSize = static_cast<GPtrDiff_t>(nSize);
+                sJob.pabyRawBuffer = static_cast<GByte*>(
+                    VSI_MALLOC_VERBOSE(sJob.nRawBufferSize));
+                sJob.pabyDecompressedBuffer = static_cast<GByte*>(
+                    VSI_CALLOC_VERBOSE(1, nBlockBufSize));
+                if( sJob.pabyRawBuffer == nullptr ||
+                    sJob.pabyDecompressedBuffer == nullptr )
+                {
+                    CPLFree(sJob.pabyRawBuffer);
+                    CPLFree(sJob.pabyDecompressedBuffer);
+                    bOK = false;
+                    break;
+                }
+                // Go through libtiff so that ranges prefetched by
+                // CacheMultiRange() are used.
+                if( (bIsTiled ?
+                        TIFFReadRawTile(hTIFF, nBlockId, sJob.pabyRawBuffer,
+                                        sJob.nRawBufferSize) :
+                        TIFFReadRawStrip(hTIFF, nBlockId, sJob.pabyRawBuffer,
+                                         sJob.nRawBufferSize))
+                    != sJob.nRawBufferSize )
+                {
+                    CPLFree(sJob.pabyRawBuffer);
+                    CPLFree(sJob.pabyDecompressedBuffer);
+                    continue;
+                }
+                asJobs.push_back(sJob);
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Decompress them in the worker threads and the calling one.      */
+/* -------------------------------------------------------------------- */
+    const int nThreads = poBaseDS ? poBaseDS->m_nDecompressionThreads :
+                                    m_nDecompressionThreads;
+    if( bOK && asJobs.size() >= 2 )
+    {
+        GTiffDecompressionContext sContext;
+        sContext.poDS = this;
+        sContext.bTIFFIsBigEndian = CPL_TO_BOOL( TIFFIsBigEndian(hTIFF) );
+        sContext.pasJobs = &asJobs[0];
+        sContext.nJobs = static_cast<int>(asJobs.size());
+        if( nCompression == COMPRESSION_LZW ||
+            nCompression == COMPRESSION_ADOBE_DEFLATE ||
+            nCompression == COMPRESSION_LZMA ||
+            nCompression == COMPRESSION_ZSTD )
+        {
+            TIFFGetField( hTIFF, TIFFTAG_PREDICTOR, &sContext.nPredictor );
+        }
+        if( nCompression == COMPRESSION_JPEG )
+        {
+            if( !TIFFGetField(hTIFF, TIFFTAG_JPEGTABLES,
+                              &sContext.nJPEGTableSize,
+                              &sContext.pJPEGTable) )
+            {
+                sContext.pJPEGTable = nullptr;
+            }
+            if( nPhotometric == PHOTOMETRIC_YCBCR )
+            {
+                TIFFGetFieldDefaulted( hTIFF, TIFFTAG_YCBCRSUBSAMPLING,
+                                       &sContext.nYCbCrSubsamplingHoriz,
+                                       &sContext.nYCbCrSubsamplingVert );
+                TIFFGetField( hTIFF, TIFFTAG_JPEGCOLORMODE,
+                              &sContext.nJPEGColorMode );
+            }
+        }
+
+        // The calling thread is one of the nThreads decompressing threads.
+        // The other ones are jobs of the global pool, shared with the
+        // other users of GDAL_NUM_THREADS, such as the compression.
+        const int nWorkers = std::min(nThreads, sContext.nJobs) - 1;
+        std::unique_ptr<CPLJobQueue> poQueue;
+        if( nWorkers > 0 )
+        {
+            CPLWorkerThreadPool* poPool =
+                CPLGetGlobalWorkerThreadPool(nThreads);
+            if( poPool != nullptr )
+                poQueue = poPool->CreateJobQueue();
+        }
+        if( poQueue != nullptr )
+        {
+            for( int i = 0; i < nWorkers; i++ )
+            {
+                if( !poQueue->SubmitJob(ThreadDecompressionFunc, &sContext) )
+                    break;
+            }
+        }
+
+        RunDecompressionJobs(&sContext);
+
+        if( poQueue != nullptr )
+            poQueue->WaitCompletion();
+
+/* -------------------------------------------------------------------- */
+/*      Push the decompressed blocks into the block cache.              */
+/* -------------------------------------------------------------------- */
+        const GDALDataType eDT = GetRasterBand(1)->GetRasterDataType();
+        const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+        const GPtrDiff_t nBlockPixels =
+            static_cast<GPtrDiff_t>(nBlockXSize) * nBlockYSize;
+        for( const auto& sJob: asJobs )
+        {
+            if( !sJob.bOK )
+                continue;
+            const int nFirstBand = sJob.nBand == 0 ? 1 : sJob.nBand;
+            const int nLastBand = sJob.nBand == 0 ? nBands : sJob.nBand;
+            for( int iBand = nFirstBand; iBand <= nLastBand; iBand++ )
+            {
+                GDALRasterBlock* poBlock = GetRasterBand(iBand)->
+                    GetLockedBlockRef(sJob.nBlockXOff, sJob.nBlockYOff, TRUE);
+                if( poBlock == nullptr )
+                    continue;
+                if( sJob.nBand == 0 )
+                {
+                    GDALCopyWords64(
+                        sJob.pabyDecompressedBuffer + (iBand - 1) * nDTSize,
+                        eDT, nBands * nDTSize,
+                        poBlock->GetDataRef(), eDT, nDTSize,
+                        nBlockPixels);
+                }
+                else
+                {
+                    memcpy(poBlock->GetDataRef(),
+                           sJob.pabyDecompressedBuffer,
+                           nBlockPixels * nDTSize);
+                }
+                poBlock->DropLock();
+            }
+        }
+    }
+
+    for( auto& sJob: asJobs )
+    {
+        CPLFree(sJob.pabyRawBuffer);
+        CPLFree(sJob.pabyDecompressedBuffer);
+    }
+}
+
 /************************************************************************/
 /*                            IRasterIO()                               */
 /************************************************************************/
@@ -2158,7 +3073,7 @@ CPLErr GTiffDataset::IRasterIO( GDALRWFlag eRWFlag,
         if( nErr >= 0 )
             return static_cast<CPLErr>(nErr);
     }
-    if( bDirectIO )
+    if( UseDirectIO(eRWFlag, nXSize, nYSize, nBandCount) )
     {
         const int nErr = DirectIO(
             eRWFlag, nXOff, nYOff, nXSize, nYSize,
@@ -2172,16 +3087,24 @@ CPLErr GTiffDataset::IRasterIO( GDALRWFlag eRWFlag,
     void* pBufferedData = nullptr;
     if( eAccess == GA_ReadOnly &&
         eRWFlag == GF_Read &&
-        nPlanarConfig == PLANARCONFIG_CONTIG &&
         HasOptimizedReadMultiRange() )
     {
+        // In the band interleaved case, fetch the blocks of all requested
+        // bands at once, instead of one band after the other.
         pBufferedData = cpl::down_cast<GTiffRasterBand *>(
             GetRasterBand(1))->CacheMultiRange(nXOff, nYOff,
                                                nXSize, nYSize,
                                                nBufXSize, nBufYSize,
+                                               nBandCount, panBandMap,
                                                psExtraArg);
     }
 
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+    {
+        DecompressBlocksMultiThreaded(nXOff, nYOff, nXSize, nYSize,
+                                      nBandCount, panBandMap);
+    }
+
     ++nJPEGOverviewVisibilityCounter;
     const CPLErr eErr =
         GDALPamDataset::IRasterIO(
@@ -3703,6 +4626,31 @@ template<class FetchBuffer> CPLErr GTiffDataset::CommonDirectIO(
     return CE_None;
 }
 
+/************************************************************************/
+/*                            UseDirectIO()                             */
+/************************************************************************/
+
+// Whether a RasterIO() request should be attempted with DirectIO().
+// Unless GTIFF_DIRECT_IO is explicitly set, this is the case for read
+// requests on read-only datasets whose window is larger than the block
+// cache: going through the cache would only evict blocks that are not
+// going to be reused.
+
+bool GTiffDataset::UseDirectIO( GDALRWFlag eRWFlag, int nXSize, int nYSize,
+                                int nBandCount )
+{
+    if( bDirectIO )
+        return true;
+    if( !bDirectIOIfLargeRequest || eRWFlag != GF_Read ||
+        eAccess != GA_ReadOnly || nBands == 0 )
+        return false;
+    const GDALDataType eDataType = GetRasterBand(1)->GetRasterDataType();
+    const GIntBig nReqSize =
+        static_cast<GIntBig>(nXSize) * nYSize * nBandCount *
+        GDALGetDataTypeSizeBytes(eDataType);
+    return nReqSize > GDALGetCacheMax64();
+}
+
 /************************************************************************/
 /*                           DirectIO()                                 */
 /************************************************************************/
@@ -3750,9 +4698,12 @@ int GTiffDataset::DirectIO( GDALRWFlag eRWFlag,
     {
         bUseBandRasterIO = true;
     }
-    else
+    else if( !TIFFIsTiled( hTIFF ) )
     {
-        // For simplicity, only deals with "naturally ordered" bands.
+        // For simplicity, the strip code path only deals with "naturally
+        // ordered" bands. CommonDirectIO() can extract any subset of bands
+        // from pixel-interleaved tiles, which avoids reading each tile once
+        // per requested band.
         for( int iBand = 0; iBand < nBandCount; ++iBand )
         {
             if( panBandMap[iBand] != iBand + 1)
@@ -4025,6 +4976,7 @@ int GTiffDataset::DirectIO( GDALRWFlag eRWFlag,
 void* GTiffRasterBand::CacheMultiRange( int nXOff, int nYOff,
                                         int nXSize, int nYSize,
                                         int nBufXSize, int nBufYSize,
+                                        int nBandCount, const int* panBandMap,
                                         GDALRasterIOExtraArg* psExtraArg )
 {
     void* pBufferedData = nullptr;
@@ -4048,46 +5000,60 @@ void* GTiffRasterBand::CacheMultiRange( int nXOff, int nYOff,
     const int nBlockX2 = static_cast<int>(std::min(static_cast<double>(nRasterXSize - 1), (nBufXSize-1+0.5) * dfSrcXInc + dfXOff + EPS)) / nBlockXSize;
     const int nBlockY2 = static_cast<int>(std::min(static_cast<double>(nRasterYSize - 1), (nBufYSize-1+0.5) * dfSrcYInc + dfYOff + EPS)) / nBlockYSize;
 
+    // In the pixel interleaved case, all bands share the same blocks
+    if( poGDS->nPlanarConfig != PLANARCONFIG_SEPARATE )
+        nBandCount = 1;
+
     thandle_t th = TIFFClientdata( poGDS->hTIFF );
     if( poGDS->SetDirectory() && !VSI_TIFFHasCachedRanges(th) )
     {
         std::vector< std::pair<vsi_l_offset, size_t> > aOffsetSize;
         size_t nTotalSize = 0;
         nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+        static const CPLCachedConfigOption oMaxRawBlockCacheSize(
+            "GDAL_MAX_RAW_BLOCK_CACHE_SIZE", "10485760");
         const unsigned int nMaxRawBlockCacheSize =
-            atoi(CPLGetConfigOption("GDAL_MAX_RAW_BLOCK_CACHE_SIZE",
-                                    "10485760"));
-        for( int iY = nBlockY1; iY <= nBlockY2; iY ++)
-        {
-            for( int iX = nBlockX1; iX <= nBlockX2; iX ++)
+            oMaxRawBlockCacheSize.GetInt();
+        for( int iBand = 0; iBand < nBandCount; iBand++ )
+        {
+            const int nOtherBand =
+                poGDS->nPlanarConfig == PLANARCONFIG_SEPARATE ?
+                    panBandMap[iBand] : nBand;
+            GTiffRasterBand* poOtherBand = cpl::down_cast<GTiffRasterBand*>(
+                poGDS->GetRasterBand(nOtherBand));
+            for( int iY = nBlockY1; iY <= nBlockY2; iY ++)
             {
-                GDALRasterBlock* poBlock = TryGetLockedBlockRef(iX, iY);
-                if( poBlock != nullptr )
+                for( int iX = nBlockX1; iX <= nBlockX2; iX ++)
                 {
-                    poBlock->DropLock();
-                    continue;
-                }
-                int nBlockId = iX + iY * nBlocksPerRow;
-                if( poGDS->nPlanarConfig == PLANARCONFIG_SEPARATE )
-                    nBlockId += (nBand - 1) * poGDS->nBlocksPerBand;
-                vsi_l_offset nOffset = 0;
-                vsi_l_offset nSize = 0;
-                if( poGDS->IsBlockAvailable(nBlockId, &nOffset, &nSize) )
-                {
-                    if( nTotalSize + nSize < nMaxRawBlockCacheSize )
+                    GDALRasterBlock* poBlock =
+                        poOtherBand->TryGetLockedBlockRef(iX, iY);
+                    if( poBlock != nullptr )
                     {
+                        poBlock->DropLock();
+                        continue;
+                    }
+                    int nBlockId = iX + iY * nBlocksPerRow;
+                    if( poGDS->nPlanarConfig == PLANARCONFIG_SEPARATE )
+                        nBlockId += (nOtherBand - 1) * poGDS->nBlocksPerBand;
+                    vsi_l_offset nOffset = 0;
+                    vsi_l_offset nSize = 0;
+                    if( poGDS->IsBlockAvailable(nBlockId, &nOffset, &nSize) )
+                    {
+                        if( nTotalSize + nSize < nMaxRawBlockCacheSize )
+                        {
 #ifdef DEBUG_VERBOSE
-                        CPLDebug("GTiff",
-                                 "Precaching for block (%d, %d), "
-                                 CPL_FRMT_GUIB "-" CPL_FRMT_GUIB,
-                                 iX, iY,
-                                 nOffset,
-                                 nOffset + static_cast<size_t>(nSize) - 1);
+                            CPLDebug("GTiff",
+                                     "Precaching for block (%d, %d), "
+                                     CPL_FRMT_GUIB "-" CPL_FRMT_GUIB,
+                                     iX, iY,
+                                     nOffset,
+                                     nOffset + static_cast<size_t>(nSize) - 1);
 #endif
-                        aOffsetSize.push_back(
-                            std::pair<vsi_l_offset, size_t>
-                                (nOffset, static_cast<size_t>(nSize)) );
-                        nTotalSize += static_cast<size_t>(nSize);
+                            aOffsetSize.push_back(
+                                std::pair<vsi_l_offset, size_t>
+                                    (nOffset, static_cast<size_t>(nSize)) );
+                            nTotalSize += static_cast<size_t>(nSize);
+                        }
                     }
                 }
             }
@@ -4097,38 +5063,61 @@ void* GTiffRasterBand::CacheMultiRange( int nXOff, int nYOff,
 
         if( nTotalSize > 0 )
         {
+            // Ranges separated by less than this number of bytes are
+            // fetched as a single one, as the cost of downloading the gap
+            // is lower than the one of an extra request.
+            static const CPLCachedConfigOption oMultiRangeMaxGap(
+                "GTIFF_MULTIRANGE_MAX_GAP", "16384");
+            const vsi_l_offset nMaxGap = static_cast<vsi_l_offset>(
+                oMultiRangeMaxGap.GetBigInt());
+
+            // Coalesce adjacent, overlapping (blocks can share the same
+            // data) or nearby ranges.
+            std::vector<vsi_l_offset> anOffsets;
+            std::vector<size_t> anSizes;
+            anOffsets.push_back(aOffsetSize[0].first);
+            vsi_l_offset nChunkEnd = aOffsetSize[0].first +
+                                     aOffsetSize[0].second;
+            for( size_t i = 1; i < aOffsetSize.size(); i++ )
+            {
+                const vsi_l_offset nStart = aOffsetSize[i].first;
+                const vsi_l_offset nEnd = nStart + aOffsetSize[i].second;
+                if( nStart <= nChunkEnd + nMaxGap )
+                {
+                    nChunkEnd = std::max(nChunkEnd, nEnd);
+                }
+                else
+                {
+                    //terminate current range
+                    anSizes.push_back(
+                        static_cast<size_t>(nChunkEnd - anOffsets.back()));
+                    //start a new range
+                    anOffsets.push_back(nStart);
+                    nChunkEnd = nEnd;
+                }
+            }
+            //terminate last range
+            anSizes.push_back(
+                static_cast<size_t>(nChunkEnd - anOffsets.back()));
+
+            nTotalSize = 0;
+            for( const size_t nSize: anSizes )
+                nTotalSize += nSize;
+
             pBufferedData = VSI_MALLOC_VERBOSE(nTotalSize);
             if( pBufferedData )
             {
-                std::vector<vsi_l_offset> anOffsets;
-                std::vector<size_t> anSizes;
                 std::vector<void*> apData;
-                anOffsets.push_back(aOffsetSize[0].first);
-                apData.push_back(static_cast<GByte *>(pBufferedData));
-                size_t nChunkSize = aOffsetSize[0].second;
                 size_t nAccOffset = 0;
-                for( size_t i = 0; i < aOffsetSize.size()-1; i++ )
+                for( const size_t nSize: anSizes )
                 {
-                    if ( aOffsetSize[i].first + aOffsetSize[i].second == aOffsetSize[i+1].first ) 
-                    {
-                        nChunkSize += aOffsetSize[i+1].second;
-                    } else 
-                    {
-                        //terminate current block
-                        anSizes.push_back(nChunkSize);
-                        nAccOffset += nChunkSize;
-                        //start a new range
-                        anOffsets.push_back(aOffsetSize[i+1].first);
-                        apData.push_back(static_cast<GByte*>(pBufferedData) + nAccOffset);
-                        nChunkSize = aOffsetSize[i+1].second;
-                    }
+                    apData.push_back(
+                        static_cast<GByte*>(pBufferedData) + nAccOffset);
+                    nAccOffset += nSize;
                 }
-                //terminate last block 
-                anSizes.push_back(nChunkSize);
 
                 VSILFILE* fp = VSI_TIFFGetVSILFile(th);
 
-
                 if( VSIFReadMultiRangeL(
                                     static_cast<int>(anSizes.size()),
                                     &apData[0],
@@ -4191,7 +5180,7 @@ CPLErr GTiffRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         if( nErr >= 0 )
             return static_cast<CPLErr>(nErr);
     }
-    if( poGDS->bDirectIO )
+    if( poGDS->UseDirectIO(eRWFlag, nXSize, nYSize, 1) )
     {
         int nErr = DirectIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
                             pData, nBufXSize, nBufYSize, eBufType,
@@ -4207,7 +5196,7 @@ CPLErr GTiffRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     {
         pBufferedData = CacheMultiRange(nXOff, nYOff, nXSize, nYSize,
                                         nBufXSize, nBufYSize,
-                                        psExtraArg);
+                                        1, &nBand, psExtraArg);
     }
 
     if( poGDS->nBands != 1 &&
@@ -4240,6 +5229,12 @@ CPLErr GTiffRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         }
     }
 
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+    {
+        poGDS->DecompressBlocksMultiThreaded(nXOff, nYOff, nXSize, nYSize,
+                                             1, &nBand);
+    }
+
     ++poGDS->nJPEGOverviewVisibilityCounter;
     const CPLErr eErr =
         GDALPamRasterBand::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
@@ -5609,7 +6604,8 @@ GDALRasterBand *GTiffRasterBand::GetOverview( int i )
         if( i < 0 || i >= poGDS->nOverviewCount )
             return nullptr;
 
-        return poGDS->papoOverviewDS[i]->GetRasterBand(nBand);
+        GTiffDataset* poODS = poGDS->GetOverviewDS(i);
+        return poODS ? poODS->GetRasterBand(nBand) : nullptr;
     }
 
     GDALRasterBand* const poOvrBand = GDALRasterBand::GetOverview( i );
@@ -7412,13 +8408,13 @@ GTiffDataset::GTiffDataset() :
     bIsFinalized(false),
     bIgnoreReadErrors(false),
     bDirectIO(false),
+    bDirectIOIfLargeRequest(false),
     eVirtualMemIOUsage(VIRTUAL_MEM_IO_NO),
     psVirtualMemIOMapping(nullptr),
     eGeoTIFFKeysFlavor(GEOTIFF_KEYS_STANDARD),
     pBaseMapping(nullptr),
     nRefBaseMapping(0),
     bHasDiscardedLsb(false),
-    poCompressThreadPool(nullptr),
     hCompressThreadPoolMutex(nullptr),
     m_pTempBufferForCommonDirectIO(nullptr),
     m_nTempBufferForCommonDirectIOSize(0),
@@ -7445,7 +8441,13 @@ GTiffDataset::GTiffDataset() :
     bIgnoreReadErrors =
         CPLTestBool(CPLGetConfigOption("GTIFF_IGNORE_READ_ERRORS", "NO"));
 
-    bDirectIO = CPLTestBool(CPLGetConfigOption("GTIFF_DIRECT_IO", "NO"));
+    // By default, DirectIO() is only attempted on read-only datasets when the
+    // request is larger than the block cache.
+    const char* pszDirectIO = CPLGetConfigOption("GTIFF_DIRECT_IO", nullptr);
+    if( pszDirectIO == nullptr || EQUAL(pszDirectIO, "IF_LARGE_REQUEST") )
+        bDirectIOIfLargeRequest = true;
+    else
+        bDirectIO = CPLTestBool(pszDirectIO);
 
     const char* pszVirtualMemIO =
         CPLGetConfigOption("GTIFF_VIRTUAL_MEM_IO", "NO");
@@ -7525,17 +8527,10 @@ int GTiffDataset::Finalize()
     FlushCacheInternal( true );
 
     // Destroy compression pool.
-    if( poCompressThreadPool )
+    if( poCompressQueue )
     {
-        poCompressThreadPool->WaitCompletion();
-
-        // Save thread pool for later reuse.
-        {
-            std::lock_guard<std::mutex> oLock(gMutexThreadPool);
-            delete gpoCompressThreadPool;
-            gpoCompressThreadPool = poCompressThreadPool;
-            poCompressThreadPool = nullptr;
-        }
+        poCompressQueue->WaitCompletion();
+        poCompressQueue.reset();
 
         for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
         {
@@ -7572,6 +8567,12 @@ int GTiffDataset::Finalize()
         }
         nOverviewCount = 0;
 
+        for( auto& sOvr: m_aoDeferredOverviews )
+        {
+            delete sOvr.poMaskDS;
+        }
+        m_aoDeferredOverviews.clear();
+
         for( int i = 0; i < nJPEGOverviewCountOri; ++i )
         {
             delete papoJPEGOverviewDS[i];
@@ -8516,8 +9517,7 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
         pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", nullptr);
     if( pszValue )
     {
-        const int nThreads =
-            EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
+        const int nThreads = CPLGetNumThreads(papszOptions);
         if( nThreads > 1 )
         {
             if( nCompression == COMPRESSION_NONE ||
@@ -8530,31 +9530,11 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
             {
                 CPLDebug("GTiff", "Using %d threads for compression", nThreads);
 
-                // Try to reuse previously created thread pool
-                {
-                    std::lock_guard<std::mutex> oLock(gMutexThreadPool);
-                    if( gpoCompressThreadPool &&
-                        gpoCompressThreadPool->GetThreadCount() == nThreads )
-                    {
-                        poCompressThreadPool = gpoCompressThreadPool;
-                    }
-                    else
-                    {
-                        delete gpoCompressThreadPool;
-                    }
-                    gpoCompressThreadPool = nullptr;
-                }
-
-                if( poCompressThreadPool == nullptr )
-                {
-                    poCompressThreadPool = new CPLWorkerThreadPool();
-                    if( !poCompressThreadPool->Setup(nThreads, nullptr, nullptr) )
-                    {
-                        delete poCompressThreadPool;
-                        poCompressThreadPool = nullptr;
-                    }
-                }
-                if( poCompressThreadPool != nullptr )
+                CPLWorkerThreadPool* poPool =
+                    CPLGetGlobalWorkerThreadPool(nThreads);
+                if( poPool != nullptr )
+                    poCompressQueue = poPool->CreateJobQueue();
+                if( poCompressQueue != nullptr )
                 {
                     // Add a margin of an extra job w.r.t thread number
                     // so as to optimize compression time (enables the main
@@ -8587,7 +9567,7 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
                 }
             }
         }
-        else if( nThreads < 0 ||
+        else if( atoi(pszValue) < 0 ||
                  (!EQUAL(pszValue, "0") &&
                   !EQUAL(pszValue, "1") &&
                   !EQUAL(pszValue, "ALL_CPUS")) )
@@ -8741,7 +9721,7 @@ void GTiffDataset::WriteRawStripOrTile( int nStripOrTile,
 
 void GTiffDataset::WaitCompletionForBlock(int nBlockId)
 {
-    if( poCompressThreadPool != nullptr )
+    if( poCompressQueue != nullptr )
     {
         for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
         {
@@ -8756,7 +9736,7 @@ void GTiffDataset::WaitCompletionForBlock(int nBlockId)
                 CPLReleaseMutex(hCompressThreadPoolMutex);
                 if( !bReady )
                 {
-                    poCompressThreadPool->WaitCompletion(0);
+                    poCompressQueue->WaitCompletion(0);
                     CPLAssert( asCompressionJobs[i].bReady );
                 }
 
@@ -8786,7 +9766,7 @@ bool GTiffDataset::SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
 /* -------------------------------------------------------------------- */
 /*      Should we do compression in a worker thread ?                   */
 /* -------------------------------------------------------------------- */
-    if( !( poCompressThreadPool != nullptr &&
+    if( !( poCompressQueue != nullptr &&
            (nCompression == COMPRESSION_ADOBE_DEFLATE ||
             nCompression == COMPRESSION_LZW ||
             nCompression == COMPRESSION_PACKBITS ||
@@ -8798,7 +9778,7 @@ bool GTiffDataset::SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
 
     int nNextCompressionJobAvail = -1;
     // Wait that at least one job is finished.
-    poCompressThreadPool->WaitCompletion(
+    poCompressQueue->WaitCompletion(
         static_cast<int>(asCompressionJobs.size() - 1) );
     for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
     {
@@ -8843,7 +9823,7 @@ bool GTiffDataset::SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
         TIFFGetField( hTIFF, TIFFTAG_PREDICTOR, &psJob->nPredictor );
     }
 
-    poCompressThreadPool->SubmitJob(ThreadCompressionFunc, psJob);
+    poCompressQueue->SubmitJob(ThreadCompressionFunc, psJob);
     return true;
 }
 
@@ -9799,9 +10779,9 @@ void GTiffDataset::FlushCacheInternal( bool bFlushDirectory )
     bLoadedBlockDirty = false;
 
     // Finish compression
-    if( poCompressThreadPool )
+    if( poCompressQueue )
     {
-        poCompressThreadPool->WaitCompletion();
+        poCompressQueue->WaitCompletion();
 
         // Flush remaining data
         for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
@@ -9954,7 +10934,7 @@ CPLErr GTiffDataset::CleanOverviews()
 {
     CPLAssert( bBase );
 
-    ScanDirectories();
+    LoadDeferredOverviews();
 
     FlushDirectory();
     *ppoActiveDSRef = nullptr;
@@ -10268,7 +11248,7 @@ CPLErr GTiffDataset::CreateOverviewsFromSrcOverviews(GDALDataset* poSrcDS)
 CPLErr GTiffDataset::CreateInternalMaskOverviews(int nOvrBlockXSize,
                                                  int nOvrBlockYSize)
 {
-    ScanDirectories();
+    LoadDeferredOverviews();
 
 /* -------------------------------------------------------------------- */
 /*      Create overviews for the mask.                                  */
@@ -10356,7 +11336,7 @@ CPLErr GTiffDataset::IBuildOverviews(
     GDALProgressFunc pfnProgress, void * pProgressData )
 
 {
-    ScanDirectories();
+    LoadDeferredOverviews();
 
     // Make implicit JPEG overviews invisible, but do not destroy
     // them in case they are already used (not sure that the client
@@ -12527,6 +13507,10 @@ GDALDataset *GTiffDataset::Open( GDALOpenInfo * poOpenInfo )
     {
         poDS->InitCreationOrOpenOptions(poOpenInfo->papszOpenOptions);
     }
+    else
+    {
+        poDS->InitDecompressionThreads(poOpenInfo->papszOpenOptions);
+    }
 
     poDS->m_bLoadPam = true;
     poDS->bColorProfileMetadataChanged = false;
@@ -14811,13 +15795,146 @@ void GTiffDataset::LoadGeoreferencingAndPamIfNeeded()
                 poBand->osDescription =
                     poBand->GDALPamRasterBand::GetDescription();
 
-            GDALColorInterp ePAMColorInterp =
-                poBand->GDALPamRasterBand::GetColorInterpretation();
-            if( ePAMColorInterp != GCI_Undefined )
-                poBand->eBandInterp = ePAMColorInterp;
-        }
+            GDALColorInterp ePAMColorInterp =
+                poBand->GDALPamRasterBand::GetColorInterpretation();
+            if( ePAMColorInterp != GCI_Undefined )
+                poBand->eBandInterp = ePAMColorInterp;
+        }
+    }
+    m_bLoadPam = false;
+}
+
+/************************************************************************/
+/*                         GTiffReadIFDSummary()                        */
+/*                                                                      */
+/*      Fetch the few tags of an IFD needed by ScanDirectories(),       */
+/*      and the offset of the next IFD, without going through           */
+/*      TIFFReadDirectory(), which would parse the whole directory      */
+/*      and fetch the values of all its tags.                           */
+/************************************************************************/
+
+namespace {
+struct GTiffIFDSummary
+{
+    toff_t nNextOffset = 0;
+    uint32 nSubType = 0;
+    GUInt64 nXSize = 0;
+    GUInt64 nYSize = 0;
+    uint32 nSPP = 1;
+};
+}
+
+static bool GTiffReadIFDSummary( TIFF* hTIFF, toff_t nOffset,
+                                 GTiffIFDSummary& sIFD )
+{
+    sIFD = GTiffIFDSummary();
+
+    VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( hTIFF ));
+    const bool bSwab = CPL_TO_BOOL(TIFFIsByteSwapped(hTIFF));
+    const vsi_l_offset nCurOffset = VSIFTellL(fp);
+
+    const auto ReadU16 = [bSwab](const GByte* pabySrc)
+    {
+        GUInt16 nVal;
+        memcpy(&nVal, pabySrc, sizeof(nVal));
+        if( bSwab )
+            CPL_SWAP16PTR(&nVal);
+        return nVal;
+    };
+    const auto ReadU32 = [bSwab](const GByte* pabySrc)
+    {
+        GUInt32 nVal;
+        memcpy(&nVal, pabySrc, sizeof(nVal));
+        if( bSwab )
+            CPL_SWAP32PTR(&nVal);
+        return nVal;
+    };
+    const auto ReadU64 = [bSwab](const GByte* pabySrc)
+    {
+        GUInt64 nVal;
+        memcpy(&nVal, pabySrc, sizeof(nVal));
+        if( bSwab )
+            CPL_SWAP64PTR(&nVal);
+        return nVal;
+    };
+
+    // Figure out if this is a BigTIFF file from the header.
+    GByte abyBuffer[8] = { 0 };
+    bool bOK = VSIFSeekL(fp, 0, SEEK_SET) == 0 &&
+               VSIFReadL(abyBuffer, 1, 4, fp) == 4;
+    const bool bBigTIFF = bOK && ReadU16(abyBuffer + 2) == 43;
+    const size_t nCountSize = bBigTIFF ? 8 : 2;
+    const size_t nEntrySize = bBigTIFF ? 20 : 12;
+    const size_t nOffsetSize = bBigTIFF ? 8 : 4;
+
+    GUInt64 nEntries = 0;
+    bOK = bOK &&
+          VSIFSeekL(fp, nOffset, SEEK_SET) == 0 &&
+          VSIFReadL(abyBuffer, 1, nCountSize, fp) == nCountSize;
+    if( bOK )
+    {
+        nEntries = bBigTIFF ? ReadU64(abyBuffer) : ReadU16(abyBuffer);
+        // Same limit as libtiff for the number of entries of an IFD.
+        bOK = nEntries <= 65535;
+    }
+
+    std::vector<GByte> abyEntries;
+    if( bOK )
+    {
+        const size_t nSize =
+            static_cast<size_t>(nEntries) * nEntrySize + nOffsetSize;
+        try
+        {
+            abyEntries.resize(nSize);
+        }
+        catch( const std::exception& )
+        {
+            bOK = false;
+        }
+        bOK = bOK && VSIFReadL(&abyEntries[0], 1, nSize, fp) == nSize;
+    }
+
+    for( size_t i = 0; bOK && i < static_cast<size_t>(nEntries); ++i )
+    {
+        const GByte* pabyEntry = &abyEntries[i * nEntrySize];
+        const GUInt16 nTag = ReadU16(pabyEntry);
+        const GUInt16 nType = ReadU16(pabyEntry + 2);
+        const GUInt64 nCount =
+            bBigTIFF ? ReadU64(pabyEntry + 4) : ReadU32(pabyEntry + 4);
+        const GByte* pabyValue = pabyEntry + (bBigTIFF ? 12 : 8);
+        if( nCount != 1 )
+            continue;
+
+        GUInt64 nValue = 0;
+        if( nType == TIFF_SHORT )
+            nValue = ReadU16(pabyValue);
+        else if( nType == TIFF_LONG )
+            nValue = ReadU32(pabyValue);
+        else if( nType == TIFF_LONG8 && bBigTIFF )
+            nValue = ReadU64(pabyValue);
+        else
+            continue;
+
+        if( nTag == TIFFTAG_SUBFILETYPE )
+            sIFD.nSubType = static_cast<uint32>(nValue);
+        else if( nTag == TIFFTAG_IMAGEWIDTH )
+            sIFD.nXSize = nValue;
+        else if( nTag == TIFFTAG_IMAGELENGTH )
+            sIFD.nYSize = nValue;
+        else if( nTag == TIFFTAG_SAMPLESPERPIXEL )
+            sIFD.nSPP = static_cast<uint32>(nValue);
     }
-    m_bLoadPam = false;
+
+    if( bOK )
+    {
+        const GByte* pabyNext =
+            &abyEntries[static_cast<size_t>(nEntries) * nEntrySize];
+        sIFD.nNextOffset = bBigTIFF ? ReadU64(pabyNext) : ReadU32(pabyNext);
+    }
+
+    if( VSIFSeekL(fp, nCurOffset, SEEK_SET) != 0 )
+        bOK = false;
+    return bOK;
 }
 
 /************************************************************************/
@@ -14846,6 +15963,17 @@ void GTiffDataset::ScanDirectories()
 
     CPLDebug( "GTiff", "ScanDirectories()" );
 
+/* -------------------------------------------------------------------- */
+/*      In read-only mode, the directory chain is walked by only        */
+/*      reading the few tags we need from each IFD, and overviews are   */
+/*      only opened when they are first accessed, see GetOverviewDS().  */
+/*      This matters for files with many overview levels and large      */
+/*      strile arrays accessed through the network.                     */
+/* -------------------------------------------------------------------- */
+    const bool bLightScan = eAccess == GA_ReadOnly && !bStreamingIn;
+    std::set<toff_t> oSetVisitedIFDs;
+    toff_t nNextDir = nDirOffset;
+
 /* ==================================================================== */
 /*      Scan all directories.                                           */
 /* ==================================================================== */
@@ -14853,50 +15981,101 @@ void GTiffDataset::ScanDirectories()
     int iDirIndex = 0;
 
     FlushDirectory();
-    while( !TIFFLastDirectory( hTIFF )
-           && (iDirIndex == 0 || TIFFReadDirectory( hTIFF ) != 0) )
+    while( true )
     {
+        toff_t nThisDir = 0;
+        uint32 nSubType = 0;
+        GUInt64 nXSize = 0;
+        GUInt64 nYSize = 0;
+        uint32 nSPP = 1;
+        if( bLightScan )
+        {
+            GTiffIFDSummary sIFD;
+            if( nNextDir == 0 ||
+                !oSetVisitedIFDs.insert(nNextDir).second ||
+                !GTiffReadIFDSummary(hTIFF, nNextDir, sIFD) )
+            {
+                break;
+            }
+            nThisDir = nNextDir;
+            nNextDir = sIFD.nNextOffset;
+            nSubType = sIFD.nSubType;
+            nXSize = sIFD.nXSize;
+            nYSize = sIFD.nYSize;
+            nSPP = sIFD.nSPP;
+        }
+        else
+        {
+            if( TIFFLastDirectory( hTIFF ) ||
+                (iDirIndex != 0 && TIFFReadDirectory( hTIFF ) == 0) )
+            {
+                break;
+            }
+            nThisDir = TIFFCurrentDirOffset(hTIFF);
+            if( !TIFFGetField(hTIFF, TIFFTAG_SUBFILETYPE, &nSubType) )
+                nSubType = 0;
+        }
+
         // Only libtiff 4.0.4 can handle between 32768 and 65535 directories.
 #if !defined(SUPPORTS_MORE_THAN_32768_DIRECTORIES)
         if( iDirIndex == 32768 )
             break;
 #endif
-        toff_t nThisDir = TIFFCurrentDirOffset(hTIFF);
-        uint32 nSubType = 0;
 
-        *ppoActiveDSRef = nullptr; // Our directory no longer matches this ds.
+        if( !bLightScan )
+            *ppoActiveDSRef = nullptr; // Our directory no longer matches this ds.
 
         ++iDirIndex;
 
-        if( !TIFFGetField(hTIFF, TIFFTAG_SUBFILETYPE, &nSubType) )
-            nSubType = 0;
-
         /* Embedded overview of the main image */
         if( (nSubType & FILETYPE_REDUCEDIMAGE) != 0 &&
             (nSubType & FILETYPE_MASK) == 0 &&
             iDirIndex != 1 &&
             nOverviewCount < 30 /* to avoid DoS */ )
         {
-            GTiffDataset *poODS = new GTiffDataset();
-            poODS->ShareLockWithParentDataset(this);
-            poODS->osFilename = osFilename;
-            if( poODS->OpenOffset( hTIFF, ppoActiveDSRef, nThisDir, false,
-                                   eAccess ) != CE_None
-                || poODS->GetRasterCount() != GetRasterCount() )
+            if( bLightScan )
             {
-                delete poODS;
+                // The validity of the overview is fully checked when it is
+                // opened.
+                if( nXSize > 0 && nXSize <= INT_MAX &&
+                    nYSize > 0 && nYSize <= INT_MAX &&
+                    nSPP == nSamplesPerPixel )
+                {
+                    GTiffDeferredOverview sOvr;
+                    sOvr.nDirOffset = nThisDir;
+                    sOvr.nXSize = static_cast<int>(nXSize);
+                    sOvr.nYSize = static_cast<int>(nYSize);
+                    m_aoDeferredOverviews.push_back(sOvr);
+                    ++nOverviewCount;
+                    papoOverviewDS = static_cast<GTiffDataset **>(
+                        CPLRealloc(papoOverviewDS,
+                                   nOverviewCount * (sizeof(void*))) );
+                    papoOverviewDS[nOverviewCount-1] = nullptr;
+                }
             }
             else
             {
-                CPLDebug( "GTiff", "Opened %dx%d overview.",
-                          poODS->GetRasterXSize(), poODS->GetRasterYSize());
-                ++nOverviewCount;
-                papoOverviewDS = static_cast<GTiffDataset **>(
-                    CPLRealloc(papoOverviewDS,
-                               nOverviewCount * (sizeof(void*))) );
-                papoOverviewDS[nOverviewCount-1] = poODS;
-                poODS->poBaseDS = this;
-                poODS->bIsOverview_ = true;
+                GTiffDataset *poODS = new GTiffDataset();
+                poODS->ShareLockWithParentDataset(this);
+                poODS->osFilename = osFilename;
+                if( poODS->OpenOffset( hTIFF, ppoActiveDSRef, nThisDir, false,
+                                       eAccess ) != CE_None
+                    || poODS->GetRasterCount() != GetRasterCount() )
+                {
+                    delete poODS;
+                }
+                else
+                {
+                    CPLDebug( "GTiff", "Opened %dx%d overview.",
+                              poODS->GetRasterXSize(), poODS->GetRasterYSize());
+                    ++nOverviewCount;
+                    papoOverviewDS = static_cast<GTiffDataset **>(
+                        CPLRealloc(papoOverviewDS,
+                                   nOverviewCount * (sizeof(void*))) );
+                    papoOverviewDS[nOverviewCount-1] = poODS;
+                    poODS->poBaseDS = this;
+                    poODS->bIsOverview_ = true;
+                }
             }
         }
         // Embedded mask of the main image.
@@ -14964,21 +16143,27 @@ void GTiffDataset::ScanDirectories()
                 int i = 0;  // Used after for.
                 for( ; i < nOverviewCount; ++i )
                 {
-                    if( cpl::down_cast<GTiffDataset *>(GDALDataset::FromHandle(
-                           papoOverviewDS[i]))->poMaskDS == nullptr &&
-                        poDS->GetRasterXSize() ==
-                        papoOverviewDS[i]->GetRasterXSize() &&
-                        poDS->GetRasterYSize() ==
-                        papoOverviewDS[i]->GetRasterYSize() &&
+                    // Deferred overviews keep track of their mask until
+                    // they are opened.
+                    GTiffDataset*& poOvrMaskDS = bLightScan ?
+                        m_aoDeferredOverviews[i].poMaskDS :
+                        papoOverviewDS[i]->poMaskDS;
+                    const int nOvrXSize = bLightScan ?
+                        m_aoDeferredOverviews[i].nXSize :
+                        papoOverviewDS[i]->GetRasterXSize();
+                    const int nOvrYSize = bLightScan ?
+                        m_aoDeferredOverviews[i].nYSize :
+                        papoOverviewDS[i]->GetRasterYSize();
+                    if( poOvrMaskDS == nullptr &&
+                        poDS->GetRasterXSize() == nOvrXSize &&
+                        poDS->GetRasterYSize() == nOvrYSize &&
                         (poDS->GetRasterCount() == 1 ||
                          poDS->GetRasterCount() == GetRasterCount()))
                     {
                         CPLDebug(
                             "GTiff", "Opened band mask for %dx%d overview.",
                             poDS->GetRasterXSize(), poDS->GetRasterYSize());
-                        cpl::down_cast<GTiffDataset*>(GDALDataset::FromHandle(
-                            papoOverviewDS[i]))->
-                            poMaskDS = poDS;
+                        poOvrMaskDS = poDS;
                         poDS->bPromoteTo8Bits =
                             CPLTestBool(
                                 CPLGetConfigOption(
@@ -14996,23 +16181,33 @@ void GTiffDataset::ScanDirectories()
         }
         else if( nSubType == 0 || nSubType == FILETYPE_PAGE )
         {
-            uint32 nXSize = 0;
-            uint32 nYSize = 0;
-
-            TIFFGetField( hTIFF, TIFFTAG_IMAGEWIDTH, &nXSize );
-            TIFFGetField( hTIFF, TIFFTAG_IMAGELENGTH, &nYSize );
+            if( !bLightScan )
+            {
+                uint32 nTIFFXSize = 0;
+                uint32 nTIFFYSize = 0;
+                TIFFGetField( hTIFF, TIFFTAG_IMAGEWIDTH, &nTIFFXSize );
+                TIFFGetField( hTIFF, TIFFTAG_IMAGELENGTH, &nTIFFYSize );
+                nXSize = nTIFFXSize;
+                nYSize = nTIFFYSize;
+            }
 
             if( nXSize > INT_MAX || nYSize > INT_MAX )
             {
                 CPLDebug("GTiff",
-                         "Skipping directory with too large image: %u x %u",
+                         "Skipping directory with too large image: " CPL_FRMT_GUIB
+                         " x " CPL_FRMT_GUIB,
                          nXSize, nYSize);
             }
             else
             {
-                uint16 nSPP = 0;
-                if( !TIFFGetField(hTIFF, TIFFTAG_SAMPLESPERPIXEL, &nSPP ) )
-                    nSPP = 1;
+                if( !bLightScan )
+                {
+                    uint16 nTIFFSPP = 0;
+                    if( !TIFFGetField(hTIFF, TIFFTAG_SAMPLESPERPIXEL,
+                                      &nTIFFSPP ) )
+                        nTIFFSPP = 1;
+                    nSPP = nTIFFSPP;
+                }
 
                 CPLString osName, osDesc;
                 osName.Printf( "SUBDATASET_%d_NAME=GTIFF_DIR:%d:%s",
@@ -15021,32 +16216,43 @@ void GTiffDataset::ScanDirectories()
                             iDirIndex, iDirIndex,
                             static_cast<int>(nXSize),
                             static_cast<int>(nYSize),
-                            nSPP );
+                            static_cast<int>(nSPP) );
 
                 aosSubdatasets.AddString(osName);
                 aosSubdatasets.AddString(osDesc);
             }
         }
 
-        // Make sure we are stepping from the expected directory regardless
-        // of churn done processing the above.
-        if( TIFFCurrentDirOffset(hTIFF) != nThisDir )
-            TIFFSetSubDirectory( hTIFF, nThisDir );
-        *ppoActiveDSRef = nullptr;
+        if( !bLightScan )
+        {
+            // Make sure we are stepping from the expected directory regardless
+            // of churn done processing the above.
+            if( TIFFCurrentDirOffset(hTIFF) != nThisDir )
+                TIFFSetSubDirectory( hTIFF, nThisDir );
+            *ppoActiveDSRef = nullptr;
+        }
     }
 
-    // Nasty hack. Probably something that should be fixed in libtiff
-    // In case the last directory cycles to the first directory, we have
-    // TIFFCurrentDirOffset(hTIFF) == nDirOffset, but the TIFFReadDirectory()
-    // hasn't done its job, so SetDirectory() would be confused and think it
-    // has nothing to do. To avoid that reset to a fake offset before calling
-    // SetDirectory()
-    // This can also occur if the last directory cycles to the IFD of the
-    // mask dataset and we activate this mask dataset.
-    // So always completely reset
-    TIFFSetSubDirectory( hTIFF, 0 );
-    *ppoActiveDSRef = nullptr;
-    CPL_IGNORE_RET_VAL( SetDirectory() );
+    if( bLightScan )
+    {
+        // The directory of hTIFF has only changed if a mask was opened.
+        CPL_IGNORE_RET_VAL( SetDirectory() );
+    }
+    else
+    {
+        // Nasty hack. Probably something that should be fixed in libtiff
+        // In case the last directory cycles to the first directory, we have
+        // TIFFCurrentDirOffset(hTIFF) == nDirOffset, but the
+        // TIFFReadDirectory() hasn't done its job, so SetDirectory() would be
+        // confused and think it has nothing to do. To avoid that reset to a
+        // fake offset before calling SetDirectory()
+        // This can also occur if the last directory cycles to the IFD of the
+        // mask dataset and we activate this mask dataset.
+        // So always completely reset
+        TIFFSetSubDirectory( hTIFF, 0 );
+        *ppoActiveDSRef = nullptr;
+        CPL_IGNORE_RET_VAL( SetDirectory() );
+    }
 
     // If we have a mask for the main image, loop over the overviews, and if
     // they have a mask, let's set this mask as an overview of the main mask.
@@ -15054,16 +16260,17 @@ void GTiffDataset::ScanDirectories()
     {
         for( int i = 0; i < nOverviewCount; ++i )
         {
-            if( cpl::down_cast<GTiffDataset *>(GDALDataset::FromHandle(
-                   papoOverviewDS[i]))->poMaskDS != nullptr)
+            GTiffDataset* poOvrMaskDS = bLightScan ?
+                m_aoDeferredOverviews[i].poMaskDS :
+                papoOverviewDS[i]->poMaskDS;
+            if( poOvrMaskDS != nullptr )
             {
                 ++poMaskDS->nOverviewCount;
                 poMaskDS->papoOverviewDS = static_cast<GTiffDataset **>(
                     CPLRealloc(poMaskDS->papoOverviewDS,
                                poMaskDS->nOverviewCount * (sizeof(void*))) );
                 poMaskDS->papoOverviewDS[poMaskDS->nOverviewCount-1] =
-                    cpl::down_cast<GTiffDataset*>(GDALDataset::FromHandle(
-                        papoOverviewDS[i]))->poMaskDS;
+                    poOvrMaskDS;
             }
         }
     }
@@ -15078,6 +16285,81 @@ void GTiffDataset::ScanDirectories()
     }
 }
 
+/************************************************************************/
+/*                           GetOverviewDS()                            */
+/*                                                                      */
+/*      Return the i-th internal overview, opening it first if its      */
+/*      opening has been deferred by ScanDirectories().                 */
+/************************************************************************/
+
+GTiffDataset* GTiffDataset::GetOverviewDS( int i )
+
+{
+    if( papoOverviewDS[i] != nullptr ||
+        static_cast<size_t>(i) >= m_aoDeferredOverviews.size() ||
+        m_aoDeferredOverviews[i].nDirOffset == 0 )
+    {
+        return papoOverviewDS[i];
+    }
+
+    GTiffDeferredOverview& sOvr = m_aoDeferredOverviews[i];
+    const toff_t nOvrDirOffset = sOvr.nDirOffset;
+    // Only try once.
+    sOvr.nDirOffset = 0;
+
+    GTiffDataset *poODS = new GTiffDataset();
+    poODS->ShareLockWithParentDataset(this);
+    poODS->osFilename = osFilename;
+    if( poODS->OpenOffset( hTIFF, ppoActiveDSRef, nOvrDirOffset, false,
+                           eAccess ) != CE_None
+        || poODS->GetRasterCount() != GetRasterCount() )
+    {
+        delete poODS;
+        poODS = nullptr;
+    }
+    else
+    {
+        CPLDebug( "GTiff", "Opened %dx%d overview.",
+                  poODS->GetRasterXSize(), poODS->GetRasterYSize());
+        papoOverviewDS[i] = poODS;
+        poODS->poBaseDS = this;
+        poODS->bIsOverview_ = true;
+        poODS->poMaskDS = sOvr.poMaskDS;
+        sOvr.poMaskDS = nullptr;
+    }
+
+    CPL_IGNORE_RET_VAL( SetDirectory() );
+
+    return poODS;
+}
+
+/************************************************************************/
+/*                       LoadDeferredOverviews()                        */
+/*                                                                      */
+/*      Open all overviews, for the code paths that directly use        */
+/*      papoOverviewDS. Overviews that cannot be opened are dropped.    */
+/************************************************************************/
+
+void GTiffDataset::LoadDeferredOverviews()
+
+{
+    ScanDirectories();
+
+    if( m_aoDeferredOverviews.empty() )
+        return;
+
+    int nValidCount = 0;
+    for( int i = 0; i < nOverviewCount; ++i )
+    {
+        GTiffDataset* poODS = GetOverviewDS(i);
+        if( poODS != nullptr )
+            papoOverviewDS[nValidCount++] = poODS;
+    }
+    nOverviewCount = nValidCount;
+    // The masks of the overviews that could not be opened remain owned
+    // by m_aoDeferredOverviews.
+}
+
 static int GTiffGetLZMAPreset(char** papszOptions)
 {
     int nLZMAPreset = -1;
@@ -16647,6 +17929,344 @@ GDALDataset *GTiffDataset::Create( const char * pszFilename,
     return poDS;
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*                       GTiffResampledDataset                          */
+/* ==================================================================== */
+/************************************************************************/
+
+// Resampled view of a source dataset, at the dimensions of one of the
+// overview levels computed by GTiffSrcWithOverviewsDataset. Pixels are read
+// from the full resolution source with RasterIO() and the requested
+// resampling method, so no temporary overview file is needed.
+
+class GTiffResampledRasterBand;
+
+class GTiffResampledDataset final : public GDALDataset
+{
+    CPL_DISALLOW_COPY_ASSIGN(GTiffResampledDataset)
+
+    friend class GTiffResampledRasterBand;
+    std::unique_ptr<GTiffResampledRasterBand> m_poMaskBand{};
+
+  public:
+    GTiffResampledDataset( GDALDataset* poSrcDS,
+                           int nXSize, int nYSize,
+                           GDALRIOResampleAlg eResampleAlg );
+    virtual ~GTiffResampledDataset();
+};
+
+class GTiffResampledRasterBand final : public GDALRasterBand
+{
+    CPL_DISALLOW_COPY_ASSIGN(GTiffResampledRasterBand)
+
+    GDALRasterBand    *m_poSrcBand;
+    GDALRIOResampleAlg m_eResampleAlg;
+    bool               m_bIsMask;
+
+  protected:
+    virtual CPLErr IReadBlock( int, int, void * ) override;
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              GSpacing, GSpacing,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
+
+  public:
+    GTiffResampledRasterBand( GTiffResampledDataset* poDS, int nBand,
+                              GDALRasterBand* poSrcBand,
+                              GDALRIOResampleAlg eResampleAlg,
+                              bool bIsMask );
+
+    virtual double GetNoDataValue( int *pbSuccess = nullptr ) override;
+    virtual int GetMaskFlags() override;
+    virtual GDALRasterBand *GetMaskBand() override;
+};
+
+/************************************************************************/
+/*                       GTiffResampledDataset()                        */
+/************************************************************************/
+
+GTiffResampledDataset::GTiffResampledDataset( GDALDataset* poSrcDS,
+                                              int nXSize, int nYSize,
+                                              GDALRIOResampleAlg eResampleAlg )
+{
+    nRasterXSize = nXSize;
+    nRasterYSize = nYSize;
+    for( int i = 1; i <= poSrcDS->GetRasterCount(); ++i )
+    {
+        SetBand(i, new GTiffResampledRasterBand(
+                        this, i, poSrcDS->GetRasterBand(i), eResampleAlg,
+                        false));
+    }
+
+    // Masks are resampled with nearest neighbour so that they remain
+    // made of fully valid and fully invalid pixels.
+    GDALRasterBand* poSrcBand = poSrcDS->GetRasterBand(1);
+    if( poSrcBand->GetMaskFlags() == GMF_PER_DATASET )
+    {
+        m_poMaskBand.reset(new GTiffResampledRasterBand(
+            this, 0, poSrcBand->GetMaskBand(), GRIORA_NearestNeighbour,
+            true));
+    }
+}
+
+/************************************************************************/
+/*                      ~GTiffResampledDataset()                        */
+/************************************************************************/
+
+GTiffResampledDataset::~GTiffResampledDataset() = default;
+
+/************************************************************************/
+/*                      GTiffResampledRasterBand()                      */
+/************************************************************************/
+
+GTiffResampledRasterBand::GTiffResampledRasterBand(
+                                        GTiffResampledDataset* poDSIn,
+                                        int nBandIn,
+                                        GDALRasterBand* poSrcBand,
+                                        GDALRIOResampleAlg eResampleAlg,
+                                        bool bIsMask ) :
+    m_poSrcBand(poSrcBand),
+    m_eResampleAlg(eResampleAlg),
+    m_bIsMask(bIsMask)
+{
+    poDS = poDSIn;
+    nBand = nBandIn;
+    nRasterXSize = poDSIn->GetRasterXSize();
+    nRasterYSize = poDSIn->GetRasterYSize();
+    eDataType = poSrcBand->GetRasterDataType();
+    nBlockXSize = std::min(nRasterXSize, 256);
+    nBlockYSize = std::min(nRasterYSize, 256);
+}
+
+/************************************************************************/
+/*                             IReadBlock()                             */
+/************************************************************************/
+
+CPLErr GTiffResampledRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
+                                             void * pImage )
+{
+    const int nXOff = nBlockXOff * nBlockXSize;
+    const int nYOff = nBlockYOff * nBlockYSize;
+    const int nReqXSize = std::min(nBlockXSize, nRasterXSize - nXOff);
+    const int nReqYSize = std::min(nBlockYSize, nRasterYSize - nYOff);
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    return IRasterIO( GF_Read, nXOff, nYOff, nReqXSize, nReqYSize,
+                      pImage, nReqXSize, nReqYSize, eDataType,
+                      nDTSize, static_cast<GSpacing>(nDTSize) * nBlockXSize,
+                      &sExtraArg );
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GTiffResampledRasterBand::IRasterIO( GDALRWFlag eRWFlag,
+                                            int nXOff, int nYOff,
+                                            int nXSize, int nYSize,
+                                            void * pData,
+                                            int nBufXSize, int nBufYSize,
+                                            GDALDataType eBufType,
+                                            GSpacing nPixelSpace,
+                                            GSpacing nLineSpace,
+                                            GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag != GF_Read )
+        return CE_Failure;
+
+    // Source window, at full resolution, of the requested window.
+    const double dfXRatio =
+        static_cast<double>(m_poSrcBand->GetXSize()) / nRasterXSize;
+    const double dfYRatio =
+        static_cast<double>(m_poSrcBand->GetYSize()) / nRasterYSize;
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    sExtraArg.eResampleAlg = m_eResampleAlg;
+    sExtraArg.pfnProgress = psExtraArg->pfnProgress;
+    sExtraArg.pProgressData = psExtraArg->pProgressData;
+    sExtraArg.bFloatingPointWindowValidity = TRUE;
+    sExtraArg.dfXOff = nXOff * dfXRatio;
+    sExtraArg.dfYOff = nYOff * dfYRatio;
+    sExtraArg.dfXSize = nXSize * dfXRatio;
+    sExtraArg.dfYSize = nYSize * dfYRatio;
+
+    const int nSrcXOff = static_cast<int>(sExtraArg.dfXOff);
+    const int nSrcYOff = static_cast<int>(sExtraArg.dfYOff);
+    const int nSrcXSize = std::max(1,
+        std::min(m_poSrcBand->GetXSize(),
+                 static_cast<int>(
+                    ceil(sExtraArg.dfXOff + sExtraArg.dfXSize - 1e-10)))
+        - nSrcXOff);
+    const int nSrcYSize = std::max(1,
+        std::min(m_poSrcBand->GetYSize(),
+                 static_cast<int>(
+                    ceil(sExtraArg.dfYOff + sExtraArg.dfYSize - 1e-10)))
+        - nSrcYOff);
+
+    return m_poSrcBand->RasterIO( GF_Read, nSrcXOff, nSrcYOff,
+                                  nSrcXSize, nSrcYSize,
+                                  pData, nBufXSize, nBufYSize, eBufType,
+                                  nPixelSpace, nLineSpace, &sExtraArg );
+}
+
+/************************************************************************/
+/*                           GetNoDataValue()                           */
+/************************************************************************/
+
+double GTiffResampledRasterBand::GetNoDataValue( int *pbSuccess )
+{
+    return m_poSrcBand->GetNoDataValue(pbSuccess);
+}
+
+/************************************************************************/
+/*                            GetMaskFlags()                            */
+/************************************************************************/
+
+int GTiffResampledRasterBand::GetMaskFlags()
+{
+    if( !m_bIsMask &&
+        cpl::down_cast<GTiffResampledDataset*>(poDS)->m_poMaskBand )
+        return GMF_PER_DATASET;
+    return GDALRasterBand::GetMaskFlags();
+}
+
+/************************************************************************/
+/*                            GetMaskBand()                             */
+/************************************************************************/
+
+GDALRasterBand *GTiffResampledRasterBand::GetMaskBand()
+{
+    GTiffResampledDataset* poGDS = cpl::down_cast<GTiffResampledDataset*>(poDS);
+    if( !m_bIsMask && poGDS->m_poMaskBand )
+        return poGDS->m_poMaskBand.get();
+    return GDALRasterBand::GetMaskBand();
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                    GTiffSrcWithOverviewsDataset                      */
+/* ==================================================================== */
+/************************************************************************/
+
+// Proxy of the source dataset of CreateCopy() that exposes overviews
+// computed on the fly, for GENERATE_OVERVIEWS=YES. The power-of-two levels
+// are added until the overview fits into a single overview block.
+
+class GTiffSrcWithOverviewsRasterBand;
+
+class GTiffSrcWithOverviewsDataset final : public GDALProxyDataset
+{
+    CPL_DISALLOW_COPY_ASSIGN(GTiffSrcWithOverviewsDataset)
+
+    friend class GTiffSrcWithOverviewsRasterBand;
+    GDALDataset* m_poSrcDS;
+    std::vector<std::unique_ptr<GTiffResampledDataset>> m_apoOvrDS{};
+
+  protected:
+    virtual GDALDataset *RefUnderlyingDataset() const override
+        { return m_poSrcDS; }
+
+  public:
+    GTiffSrcWithOverviewsDataset( GDALDataset* poSrcDS,
+                                  GDALRIOResampleAlg eResampleAlg );
+};
+
+class GTiffSrcWithOverviewsRasterBand final : public GDALProxyRasterBand
+{
+    CPL_DISALLOW_COPY_ASSIGN(GTiffSrcWithOverviewsRasterBand)
+
+    GDALRasterBand* m_poSrcBand;
+
+  protected:
+    virtual GDALRasterBand* RefUnderlyingRasterBand() override
+        { return m_poSrcBand; }
+
+  public:
+    GTiffSrcWithOverviewsRasterBand( GTiffSrcWithOverviewsDataset* poDS,
+                                     int nBand );
+
+    virtual int GetOverviewCount() override;
+    virtual GDALRasterBand *GetOverview( int ) override;
+};
+
+/************************************************************************/
+/*                    GTiffSrcWithOverviewsDataset()                    */
+/************************************************************************/
+
+GTiffSrcWithOverviewsDataset::GTiffSrcWithOverviewsDataset(
+                                        GDALDataset* poSrcDS,
+                                        GDALRIOResampleAlg eResampleAlg ) :
+    m_poSrcDS(poSrcDS)
+{
+    nRasterXSize = poSrcDS->GetRasterXSize();
+    nRasterYSize = poSrcDS->GetRasterYSize();
+    SetDescription(poSrcDS->GetDescription());
+
+    int nOvrBlockXSize = 0;
+    int nOvrBlockYSize = 0;
+    GTIFFGetOverviewBlockSize(&nOvrBlockXSize, &nOvrBlockYSize);
+
+    int nOvrXSize = nRasterXSize;
+    int nOvrYSize = nRasterYSize;
+    int nOvrFactor = 1;
+    while( (nOvrXSize > nOvrBlockXSize || nOvrYSize > nOvrBlockYSize) &&
+           nOvrFactor <= INT_MAX / 2 )
+    {
+        nOvrFactor *= 2;
+        nOvrXSize = DIV_ROUND_UP(nRasterXSize, nOvrFactor);
+        nOvrYSize = DIV_ROUND_UP(nRasterYSize, nOvrFactor);
+        m_apoOvrDS.emplace_back(new GTiffResampledDataset(
+            poSrcDS, nOvrXSize, nOvrYSize, eResampleAlg));
+    }
+
+    for( int i = 1; i <= poSrcDS->GetRasterCount(); ++i )
+        SetBand(i, new GTiffSrcWithOverviewsRasterBand(this, i));
+}
+
+/************************************************************************/
+/*                  GTiffSrcWithOverviewsRasterBand()                   */
+/************************************************************************/
+
+GTiffSrcWithOverviewsRasterBand::GTiffSrcWithOverviewsRasterBand(
+                                        GTiffSrcWithOverviewsDataset* poDSIn,
+                                        int nBandIn ) :
+    m_poSrcBand(poDSIn->m_poSrcDS->GetRasterBand(nBandIn))
+{
+    poDS = poDSIn;
+    nBand = nBandIn;
+    nRasterXSize = m_poSrcBand->GetXSize();
+    nRasterYSize = m_poSrcBand->GetYSize();
+    eDataType = m_poSrcBand->GetRasterDataType();
+    m_poSrcBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+}
+
+/************************************************************************/
+/*                          GetOverviewCount()                          */
+/************************************************************************/
+
+int GTiffSrcWithOverviewsRasterBand::GetOverviewCount()
+{
+    return static_cast<int>(
+        cpl::down_cast<GTiffSrcWithOverviewsDataset*>(poDS)->
+                                                    m_apoOvrDS.size());
+}
+
+/************************************************************************/
+/*                            GetOverview()                             */
+/************************************************************************/
+
+GDALRasterBand *GTiffSrcWithOverviewsRasterBand::GetOverview( int iOvr )
+{
+    if( iOvr < 0 || iOvr >= GetOverviewCount() )
+        return nullptr;
+    return cpl::down_cast<GTiffSrcWithOverviewsDataset*>(poDS)->
+                                    m_apoOvrDS[iOvr]->GetRasterBand(nBand);
+}
+
 /************************************************************************/
 /*                             CreateCopy()                             */
 /************************************************************************/
@@ -16783,15 +18403,47 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      With GENERATE_OVERVIEWS=YES, compute the overviews on the fly   */
+/*      from the source if it has none, and write them as with          */
+/*      COPY_SRC_OVERVIEWS=YES.                                         */
+/* -------------------------------------------------------------------- */
+    const bool bGenerateOverviews =
+        CPLFetchBool(papszOptions, "GENERATE_OVERVIEWS", false);
+    const bool bCopySrcOverviews = bGenerateOverviews ||
+        CPLFetchBool(papszOptions, "COPY_SRC_OVERVIEWS", false);
+    std::unique_ptr<GDALDataset> poSrcWithOverviewsDS;
+    GDALDataset* poOvrSrcDS = poSrcDS;
+    if( bGenerateOverviews &&
+        poSrcDS->GetRasterBand(1)->GetOverviewCount() == 0 )
+    {
+        const char* pszResampling =
+            CSLFetchNameValue(papszOptions, "OVERVIEW_RESAMPLING");
+        if( pszResampling == nullptr )
+        {
+            pszResampling =
+                poPBand->GetColorTable() != nullptr ? "NEAREST" : "AVERAGE";
+        }
+        poSrcWithOverviewsDS.reset(new GTiffSrcWithOverviewsDataset(
+            poSrcDS, GDALRasterIOGetResampleAlg(pszResampling)));
+        poOvrSrcDS = poSrcWithOverviewsDS.get();
+    }
+    if( bGenerateOverviews )
+    {
+        papszCreateOptions =
+            CSLSetNameValue(papszCreateOptions, "COPY_SRC_OVERVIEWS", "YES");
+    }
+
     double dfExtraSpaceForOverviews = 0;
-    if( CPLFetchBool(papszOptions, "COPY_SRC_OVERVIEWS", false) )
+    if( bCopySrcOverviews )
     {
-        const int nSrcOverviews = poSrcDS->GetRasterBand(1)->GetOverviewCount();
+        const int nSrcOverviews =
+            poOvrSrcDS->GetRasterBand(1)->GetOverviewCount();
         if( nSrcOverviews )
         {
             for( int j = 1; j <= l_nBands; ++j )
             {
-                if( poSrcDS->GetRasterBand(j)->GetOverviewCount() !=
+                if( poOvrSrcDS->GetRasterBand(j)->GetOverviewCount() !=
                                                         nSrcOverviews )
                 {
                     CPLError(
@@ -16804,7 +18456,7 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
                 for( int i = 0; i < nSrcOverviews; ++i )
                 {
                     GDALRasterBand* poOvrBand =
-                        poSrcDS->GetRasterBand(j)->GetOverview(i);
+                        poOvrSrcDS->GetRasterBand(j)->GetOverview(i);
                     if( poOvrBand == nullptr )
                     {
                         CPLError(
@@ -16815,7 +18467,7 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
                         return nullptr;
                     }
                     GDALRasterBand* poOvrFirstBand =
-                        poSrcDS->GetRasterBand(1)->GetOverview(i);
+                        poOvrSrcDS->GetRasterBand(1)->GetOverview(i);
                     if( poOvrBand->GetXSize() != poOvrFirstBand->GetXSize() ||
                         poOvrBand->GetYSize() != poOvrFirstBand->GetYSize() )
                     {
@@ -16834,8 +18486,8 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
             {
                 dfExtraSpaceForOverviews +=
                     static_cast<double>(
-                      poSrcDS->GetRasterBand(1)->GetOverview(i)->GetXSize() ) *
-                      poSrcDS->GetRasterBand(1)->GetOverview(i)->GetYSize();
+                    poOvrSrcDS->GetRasterBand(1)->GetOverview(i)->GetXSize() ) *
+                    poOvrSrcDS->GetRasterBand(1)->GetOverview(i)->GetYSize();
             }
             dfExtraSpaceForOverviews *=
                                 l_nBands * GDALGetDataTypeSizeBytes(eType);
@@ -17691,13 +19343,13 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
         static_cast<double>(nXSize) * nYSize * nBandsWidthMask;
     double dfCurPixels = 0;
 
-    if( eErr == CE_None &&
-        CPLFetchBool(papszOptions, "COPY_SRC_OVERVIEWS", false) )
+    if( eErr == CE_None && bCopySrcOverviews )
     {
-        const int nSrcOverviews = poSrcDS->GetRasterBand(1)->GetOverviewCount();
+        const int nSrcOverviews =
+            poOvrSrcDS->GetRasterBand(1)->GetOverviewCount();
         if( nSrcOverviews )
         {
-            eErr = poDS->CreateOverviewsFromSrcOverviews(poSrcDS);
+            eErr = poDS->CreateOverviewsFromSrcOverviews(poOvrSrcDS);
 
             if( poDS->nOverviewCount != nSrcOverviews )
             {
@@ -17711,7 +19363,7 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
             for( int i = 0; i < nSrcOverviews; ++i )
             {
                 GDALRasterBand* poOvrBand =
-                    poSrcDS->GetRasterBand(1)->GetOverview(i);
+                    poOvrSrcDS->GetRasterBand(1)->GetOverview(i);
                 const double dfOvrPixels =
                     static_cast<double>(poOvrBand->GetXSize()) *
                                 poOvrBand->GetYSize();
@@ -17743,10 +19395,10 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
                 // Create a fake dataset with the source overview level so that
                 // GDALDatasetCopyWholeRaster can cope with it.
                 GDALDataset* poSrcOvrDS =
-                    GDALCreateOverviewDataset(poSrcDS, iOvrLevel, TRUE);
+                    GDALCreateOverviewDataset(poOvrSrcDS, iOvrLevel, TRUE);
 
                 GDALRasterBand* poOvrBand =
-                        poSrcDS->GetRasterBand(1)->GetOverview(iOvrLevel);
+                        poOvrSrcDS->GetRasterBand(1)->GetOverview(iOvrLevel);
                 double dfNextCurPixels =
                     dfCurPixels +
                     static_cast<double>(poOvrBand->GetXSize()) *
@@ -19043,9 +20695,6 @@ void GDALDeregister_GTiff( GDALDriver * )
         TIFFUnRegisterCODEC(pLercCodec);
     pLercCodec = nullptr;
 #endif
-
-    delete gpoCompressThreadPool;
-    gpoCompressThreadPool = nullptr;
 }
 
 /************************************************************************/
@@ -19317,6 +20966,16 @@ void GDALRegister_GTiff()
 "       <Value>BIG</Value>"
 "   </Option>"
 "   <Option name='COPY_SRC_OVERVIEWS' type='boolean' default='NO' description='Force copy of overviews of source dataset (CreateCopy())'/>"
+"   <Option name='GENERATE_OVERVIEWS' type='boolean' default='NO' description='Compute overviews of a source dataset without overviews and write them as with COPY_SRC_OVERVIEWS (CreateCopy())'/>"
+"   <Option name='OVERVIEW_RESAMPLING' type='string-select' description='Resampling method used by GENERATE_OVERVIEWS. Defaults to AVERAGE, or NEAREST for paletted sources'>"
+"       <Value>NEAREST</Value>"
+"       <Value>AVERAGE</Value>"
+"       <Value>BILINEAR</Value>"
+"       <Value>CUBIC</Value>"
+"       <Value>CUBICSPLINE</Value>"
+"       <Value>LANCZOS</Value>"
+"       <Value>MODE</Value>"
+"   </Option>"
 "   <Option name='SOURCE_ICC_PROFILE' type='string' description='ICC profile'/>"
 "   <Option name='SOURCE_PRIMARIES_RED' type='string' description='x,y,1.0 (xyY) red chromaticity'/>"
 "   <Option name='SOURCE_PRIMARIES_GREEN' type='string' description='x,y,1.0 (xyY) green chromaticity'/>"
@@ -19344,13 +21003,14 @@ void GDALRegister_GTiff()
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/tiff" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "tif" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSIONS, "tif tiff" );
+    poDriver->SetMetadataItem( GDAL_DMD_SIGNATURES, "4949 4D4D" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
                                "Byte UInt16 Int16 UInt32 Int32 Float32 "
                                "Float64 CInt16 CInt32 CFloat32 CFloat64" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osOptions );
     poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
 "<OpenOptionList>"
-"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>"
+"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression, or for decompression in read-only mode. Can be set to ALL_CPUS' default='1'/>"
 "   <Option name='GEOTIFF_KEYS_FLAVOR' type='string-select' default='STANDARD' description='Which flavor of GeoTIFF keys must be used (for writing)'>"
 "       <Value>STANDARD</Value>"
 "       <Value>ESRI_PE</Value>"
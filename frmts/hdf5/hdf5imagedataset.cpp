@@ -109,6 +109,15 @@ public:
     virtual const GDAL_GCP *GetGCPs() override;
     virtual CPLErr GetGeoTransform( double *padfTransform ) override;
 
+    virtual CPLErr IRasterIO( GDALRWFlag eRWFlag,
+                              int nXOff, int nYOff, int nXSize, int nYSize,
+                              void * pData, int nBufXSize, int nBufYSize,
+                              GDALDataType eBufType,
+                              int nBandCount, int *panBandMap,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GSpacing nBandSpace,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
+
     Hdf5ProductType GetSubdatasetType() const { return iSubdatasetType; }
     HDF5CSKProductEnum GetCSKProductType() const { return iCSKProductType; }
 
@@ -417,6 +426,116 @@ CPLErr HDF5ImageRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
     return CE_None;
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+// Requests on consecutive bands of a (band, y, x) dataset, typically the
+// extraction of time series, are read with a single hyperslab selection
+// spanning these bands, instead of one read per band and block.
+CPLErr HDF5ImageDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                    int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void * pData,
+                                    int nBufXSize, int nBufYSize,
+                                    GDALDataType eBufType,
+                                    int nBandCount, int *panBandMap,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GSpacing nBandSpace,
+                                    GDALRasterIOExtraArg* psExtraArg )
+{
+    bool bContiguousBands =
+        eRWFlag == GF_Read && eAccess == GA_ReadOnly && nBandCount > 1 &&
+        ndims == 3 && !IsComplexCSKL1A() &&
+        nXSize == nBufXSize && nYSize == nBufYSize;
+    for( int i = 1; bContiguousBands && i < nBandCount; i++ )
+        bContiguousBands = panBandMap[i] == panBandMap[0] + i;
+    if( !bContiguousBands )
+    {
+        return GDALPamDataset::IRasterIO( eRWFlag, nXOff, nYOff, nXSize,
+                                          nYSize, pData, nBufXSize, nBufYSize,
+                                          eBufType, nBandCount, panBandMap,
+                                          nPixelSpace, nLineSpace, nBandSpace,
+                                          psExtraArg );
+    }
+
+    // Read by batches of bands, to limit the size of the temporary buffer.
+    const GDALDataType eDT = GetRasterBand(1)->GetRasterDataType();
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+    const size_t nBandSize = static_cast<size_t>(nXSize) * nYSize * nDTSize;
+    const int nBandsPerBatch = static_cast<int>(
+        std::max(static_cast<size_t>(1),
+                 std::min(static_cast<size_t>(nBandCount),
+                          static_cast<size_t>(64 * 1024 * 1024) / nBandSize)));
+    GByte* pabyBuffer = static_cast<GByte*>(
+        VSI_MALLOC2_VERBOSE(nBandsPerBatch, nBandSize));
+    if( pabyBuffer == nullptr )
+        return CE_Failure;
+
+    CPLErr eErr = CE_None;
+    for( int iBand = 0; eErr == CE_None && iBand < nBandCount;
+         iBand += nBandsPerBatch )
+    {
+        const int nBandsThisBatch =
+            std::min(nBandsPerBatch, nBandCount - iBand);
+
+        // Select the bands from file space.
+        H5OFFSET_TYPE offset[3] = { static_cast<H5OFFSET_TYPE>(
+                                        panBandMap[iBand] - 1),
+                                    static_cast<H5OFFSET_TYPE>(nYOff),
+                                    static_cast<H5OFFSET_TYPE>(nXOff) };
+        hsize_t count[3] = { static_cast<hsize_t>(nBandsThisBatch),
+                             static_cast<hsize_t>(nYSize),
+                             static_cast<hsize_t>(nXSize) };
+        herr_t status = H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET,
+                                            offset, nullptr, count, nullptr);
+        if( status < 0 )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+
+        const hid_t memspace = H5Screate_simple(3, count, nullptr);
+        status = H5Dread(dataset_id, native, memspace, dataspace_id,
+                         H5P_DEFAULT, pabyBuffer);
+        H5Sclose(memspace);
+        if( status < 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "H5Dread() failed for bands %d to %d.",
+                     panBandMap[iBand],
+                     panBandMap[iBand] + nBandsThisBatch - 1);
+            eErr = CE_Failure;
+            break;
+        }
+
+        for( int k = 0; k < nBandsThisBatch; k++ )
+        {
+            for( int j = 0; j < nYSize; j++ )
+            {
+                GDALCopyWords(
+                    pabyBuffer + k * nBandSize +
+                        static_cast<size_t>(j) * nXSize * nDTSize,
+                    eDT, nDTSize,
+                    static_cast<GByte*>(pData) + (iBand + k) * nBandSpace +
+                        j * nLineSpace,
+                    eBufType, static_cast<int>(nPixelSpace), nXSize);
+            }
+        }
+        if( psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress(
+                static_cast<double>(iBand + nBandsThisBatch) / nBandCount, "",
+                psExtraArg->pProgressData) )
+        {
+            CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+            eErr = CE_Failure;
+        }
+    }
+
+    CPLFree(pabyBuffer);
+    return eErr;
+}
+
 /************************************************************************/
 /*                              Identify()                              */
 /************************************************************************/
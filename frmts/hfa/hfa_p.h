@@ -37,6 +37,8 @@
 
 #include <cstdio>
 #include <vector>
+
+class CPLWorkerThreadPool;
 #include <set>
 
 #include "cpl_error.h"
@@ -203,6 +205,11 @@ class HFABand
 
     CPLErr      GetRasterBlock( int nXBlock, int nYBlock, void * pData,
                                 int nDataSize );
+    void        GetRasterBlocks( int nBlocksToRead, const int *panXBlock,
+                                 const int *panYBlock, void * const *papData,
+                                 int nDataSize, bool *pabSuccess,
+                                 CPLWorkerThreadPool *poThreadPool,
+                                 int nThreads );
     CPLErr      SetRasterBlock( int nXBlock, int nYBlock, void * pData );
 
     const char * GetBandName();
@@ -39,11 +39,14 @@
 #  include <fcntl.h>
 #endif
 #include <algorithm>
+#include <atomic>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "hfa.h"
 #include "gdal_priv.h"
 
@@ -1200,6 +1203,43 @@ void HFABand::NullBlock( void *pData )
     }
 }
 
+#ifdef CPL_MSB
+/************************************************************************/
+/*                       SwapBlockToLocalOrder()                        */
+/************************************************************************/
+
+static void SwapBlockToLocalOrder( void *pData, int nPixels,
+                                   EPTType eDataType )
+
+{
+    if( HFAGetDataTypeBits(eDataType) == 16 )
+    {
+        for( int ii = 0; ii < nPixels; ii++ )
+            CPL_SWAP16PTR(((unsigned char *)pData) + ii * 2);
+    }
+    else if( HFAGetDataTypeBits(eDataType) == 32 )
+    {
+        for( int ii = 0; ii < nPixels; ii++ )
+            CPL_SWAP32PTR(((unsigned char *)pData) + ii * 4);
+    }
+    else if( eDataType == EPT_f64 )
+    {
+        for( int ii = 0; ii < nPixels; ii++ )
+            CPL_SWAP64PTR( ((unsigned char *) pData) + ii*8 );
+    }
+    else if( eDataType == EPT_c64 )
+    {
+        for( int ii = 0; ii < nPixels * 2; ii++ )
+            CPL_SWAP32PTR(((unsigned char *)pData) + ii * 4);
+    }
+    else if( eDataType == EPT_c128 )
+    {
+        for( int ii = 0; ii < nPixels * 2; ii++ )
+            CPL_SWAP64PTR(((unsigned char *)pData) + ii * 8 );
+    }
+}
+#endif  // def CPL_MSB
+
 /************************************************************************/
 /*                           GetRasterBlock()                           */
 /************************************************************************/
@@ -1333,34 +1373,202 @@ CPLErr HFABand::GetRasterBlock( int nXBlock, int nYBlock,
     // files.
 
 #ifdef CPL_MSB
-    if( HFAGetDataTypeBits(eDataType) == 16 )
+    SwapBlockToLocalOrder(pData, nBlockXSize * nBlockYSize, eDataType);
+#endif  // def CPL_MSB
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                          GetRasterBlocks()                           */
+/*                                                                      */
+/*      Read several blocks at once. The raw data of all the valid      */
+/*      blocks is fetched with a single VSIFReadMultiRangeL() call,     */
+/*      and the compressed blocks are then decoded by the calling       */
+/*      thread and, if provided, nThreads - 1 threads of the pool.      */
+/*      pabSuccess[i] is set to false for the blocks that could not     */
+/*      be read this way: GetRasterBlock() should be used for them,     */
+/*      and will report the appropriate error.                          */
+/************************************************************************/
+
+namespace {
+struct HFAUncompressJob
+{
+    int     iBlockIdx;
+    GByte  *pabyCData;
+    int     nSrcBytes;
+    GByte  *pabyDest;
+    bool    bOK;
+};
+
+struct HFAUncompressContext
+{
+    HFAUncompressJob       *pasJobs = nullptr;
+    int                     nJobs = 0;
+    int                     nMaxPixels = 0;
+    EPTType                 eDataType = EPT_u8;
+    std::atomic<int>        nNextJob{0};
+};
+}
+
+static void RunUncompressJobs( HFAUncompressContext *psContext )
+{
+    // Errors are not reported from there: the blocks that fail to decode
+    // are read again by the caller with GetRasterBlock().
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    while( true )
     {
-        for( int ii = 0; ii < nBlockXSize * nBlockYSize; ii++ )
-            CPL_SWAP16PTR(((unsigned char *)pData) + ii * 2);
+        const int iJob = psContext->nNextJob++;
+        if( iJob >= psContext->nJobs )
+            break;
+        HFAUncompressJob *psJob = &psContext->pasJobs[iJob];
+        psJob->bOK = UncompressBlock(psJob->pabyCData, psJob->nSrcBytes,
+                                     psJob->pabyDest, psContext->nMaxPixels,
+                                     psContext->eDataType) == CE_None;
     }
-    else if( HFAGetDataTypeBits(eDataType) == 32 )
+    CPLPopErrorHandler();
+}
+
+static void ThreadUncompressFunc( void *pData )
+{
+    RunUncompressJobs(static_cast<HFAUncompressContext *>(pData));
+}
+
+void HFABand::GetRasterBlocks( int nBlocksToRead, const int *panXBlock,
+                               const int *panYBlock, void * const *papData,
+                               int nDataSize, bool *pabSuccess,
+                               CPLWorkerThreadPool *poThreadPool,
+                               int nThreads )
+
+{
+    for( int i = 0; i < nBlocksToRead; i++ )
+        pabSuccess[i] = false;
+
+    if( LoadBlockInfo() != CE_None )
+        return;
+
+    VSILFILE *fpData = fpExternal ? fpExternal : psInfo->fp;
+
+    std::vector<void *> apRangeData;
+    std::vector<vsi_l_offset> anRangeOffsets;
+    std::vector<size_t> anRangeSizes;
+    std::vector<int> anRangeBlockIdx;
+    std::vector<HFAUncompressJob> asJobs;
+    bool bOK = true;
+
+    for( int i = 0; bOK && i < nBlocksToRead; i++ )
     {
-        for( int ii = 0; ii < nBlockXSize * nBlockYSize; ii++ )
-            CPL_SWAP32PTR(((unsigned char *)pData) + ii * 4);
+        const int iBlock = panXBlock[i] + panYBlock[i] * nBlocksPerRow;
+
+        if( (panBlockFlag[iBlock] & BFLG_VALID) == 0 )
+        {
+            NullBlock(papData[i]);
+            pabSuccess[i] = true;
+            continue;
+        }
+
+        // Same offset and size as in GetRasterBlock().
+        vsi_l_offset nOffset = 0;
+        vsi_l_offset nSize = 0;
+        if( fpExternal )
+        {
+            nOffset = nBlockStart + nBlockSize * iBlock * nLayerStackCount +
+                      nLayerStackIndex * nBlockSize;
+            nSize = nBlockSize;
+        }
+        else
+        {
+            nOffset = panBlockStart[iBlock];
+            nSize = panBlockSize[iBlock];
+        }
+        if( nSize == 0 || nSize > static_cast<vsi_l_offset>(INT_MAX) )
+            continue;
+
+        if( panBlockFlag[iBlock] & BFLG_COMPRESSED )
+        {
+            HFAUncompressJob sJob;
+            sJob.iBlockIdx = i;
+            sJob.nSrcBytes = static_cast<int>(nSize);
+            sJob.pabyCData = static_cast<GByte *>(
+                VSI_MALLOC_VERBOSE(static_cast<size_t>(nSize)));
+            sJob.pabyDest = static_cast<GByte *>(papData[i]);
+            sJob.bOK = false;
+            if( sJob.pabyCData == nullptr )
+            {
+                bOK = false;
+                break;
+            }
+            asJobs.push_back(sJob);
+            apRangeData.push_back(sJob.pabyCData);
+        }
+        else
+        {
+            if( static_cast<int>(nSize) > nDataSize )
+                continue;
+            apRangeData.push_back(papData[i]);
+        }
+        anRangeOffsets.push_back(nOffset);
+        anRangeSizes.push_back(static_cast<size_t>(nSize));
+        anRangeBlockIdx.push_back(i);
     }
-    else if( eDataType == EPT_f64 )
+
+    if( bOK && !apRangeData.empty() )
     {
-        for( int ii = 0; ii < nBlockXSize*nBlockYSize; ii++ )
-            CPL_SWAP64PTR( ((unsigned char *) pData) + ii*8 );
+        bOK = VSIFReadMultiRangeL(static_cast<int>(apRangeData.size()),
+                                  &apRangeData[0], &anRangeOffsets[0],
+                                  &anRangeSizes[0], fpData) == 0;
     }
-    else if( eDataType == EPT_c64 )
+
+    if( bOK )
     {
-        for( int ii = 0; ii < nBlockXSize * nBlockYSize * 2; ii++ )
-            CPL_SWAP32PTR(((unsigned char *)pData) + ii * 4);
+        // Uncompressed blocks are ready.
+        for( size_t i = 0; i < anRangeBlockIdx.size(); i++ )
+        {
+            const int iBlockIdx = anRangeBlockIdx[i];
+            const int iBlock =
+                panXBlock[iBlockIdx] + panYBlock[iBlockIdx] * nBlocksPerRow;
+            if( panBlockFlag[iBlock] & BFLG_COMPRESSED )
+                continue;
+#ifdef CPL_MSB
+            SwapBlockToLocalOrder(papData[iBlockIdx],
+                                  nBlockXSize * nBlockYSize, eDataType);
+#endif
+            pabSuccess[iBlockIdx] = true;
+        }
     }
-    else if( eDataType == EPT_c128 )
+
+    if( bOK && !asJobs.empty() )
     {
-        for( int ii = 0; ii < nBlockXSize * nBlockYSize * 2; ii++ )
-            CPL_SWAP64PTR(((unsigned char *)pData) + ii * 8 );
+        HFAUncompressContext sContext;
+        sContext.pasJobs = &asJobs[0];
+        sContext.nJobs = static_cast<int>(asJobs.size());
+        sContext.nMaxPixels = nBlockXSize * nBlockYSize;
+        sContext.eDataType = eDataType;
+
+        // The calling thread is one of the nThreads decoding threads.
+        const int nWorkers = std::min(nThreads, sContext.nJobs) - 1;
+        std::unique_ptr<CPLJobQueue> poQueue;
+        if( poThreadPool != nullptr && nWorkers > 0 )
+        {
+            poQueue = poThreadPool->CreateJobQueue();
+            for( int i = 0; i < nWorkers; i++ )
+            {
+                if( !poQueue->SubmitJob(ThreadUncompressFunc, &sContext) )
+                    break;
+            }
+        }
+
+        RunUncompressJobs(&sContext);
+
+        if( poQueue != nullptr )
+            poQueue->WaitCompletion();
+
+        for( const auto &sJob : asJobs )
+            pabSuccess[sJob.iBlockIdx] = sJob.bOK;
     }
-#endif  // def CPL_MSB
 
-    return CE_None;
+    for( auto &sJob : asJobs )
+        CPLFree(sJob.pabyCData);
 }
 
 /************************************************************************/
@@ -50,9 +50,11 @@
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_minixml.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_frmts.h"
 #include "gdal_pam.h"
@@ -74,6 +76,7 @@ constexpr double RAD2ARCSEC = 648000.0 / M_PI;
 int WritePeStringIfNeeded( const OGRSpatialReference *poSRS, HFAHandle hHFA );
 void ClearSR( HFAHandle hHFA );
 
+
 static const char *const apszDatumMap[] = {
     // Imagine name, WKT name.
     "NAD27", "North_American_Datum_1927",
@@ -2590,6 +2593,132 @@ CPLErr HFARasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
     return eErr;
 }
 
+/************************************************************************/
+/*                           PrefetchBlocks()                           */
+/*                                                                      */
+/*      Read at once the blocks intersecting the requested window       */
+/*      that are not yet in the block cache, decode them in             */
+/*      parallel and push them into it, so that the following           */
+/*      generic RasterIO() only has to fetch them from there.           */
+/************************************************************************/
+
+void HFARasterBand::PrefetchBlocks( int nXOff, int nYOff,
+                                    int nXSize, int nYSize )
+
+{
+    HFADataset *poHFADS = static_cast<HFADataset *>(poDS);
+    const int nThreads = poHFADS->m_nDecompressionThreads;
+    if( hHFA->eAccess != HFA_ReadOnly ||
+        (nThreads <= 1 && !poHFADS->m_bHasOptimizedReadMultiRange) )
+        return;
+
+    // Sub-byte data types are expanded by IReadBlock().
+    if( eHFADataType == EPT_u1 || eHFADataType == EPT_u2 ||
+        eHFADataType == EPT_u4 )
+        return;
+
+    HFABand *poBand = hHFA->papoBand[nBand - 1];
+    if( nThisOverview >= 0 )
+    {
+        if( nThisOverview >= poBand->nOverviews )
+            return;
+        poBand = poBand->papoOverviews[nThisOverview];
+    }
+
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    const GIntBig nBlocks = static_cast<GIntBig>(nBlockX2 - nBlockX1 + 1) *
+                            (nBlockY2 - nBlockY1 + 1);
+    if( nBlocks < 2 )
+        return;
+
+    // The decoded blocks must all fit in the block cache, otherwise the
+    // first ones would be evicted before being used.
+    const int nBlockBytes =
+        nBlockXSize * nBlockYSize * GDALGetDataTypeSizeBytes(eDataType);
+    if( nBlocks * nBlockBytes > GDALGetCacheMax64() / 2 )
+    {
+        CPLDebug("HFA", "Block prefetching skipped: "
+                 "block cache not big enough");
+        return;
+    }
+
+    std::vector<int> anXBlock;
+    std::vector<int> anYBlock;
+    for( int iY = nBlockY1; iY <= nBlockY2; iY++ )
+    {
+        for( int iX = nBlockX1; iX <= nBlockX2; iX++ )
+        {
+            GDALRasterBlock *poBlock = TryGetLockedBlockRef(iX, iY);
+            if( poBlock != nullptr )
+            {
+                poBlock->DropLock();
+                continue;
+            }
+            anXBlock.push_back(iX);
+            anYBlock.push_back(iY);
+        }
+    }
+    const int nBlocksToRead = static_cast<int>(anXBlock.size());
+    if( nBlocksToRead < 2 )
+        return;
+
+    GByte *pabyBuffer = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nBlocksToRead, nBlockBytes));
+    if( pabyBuffer == nullptr )
+        return;
+    std::vector<void *> apData(nBlocksToRead);
+    for( int i = 0; i < nBlocksToRead; i++ )
+        apData[i] = pabyBuffer + static_cast<size_t>(i) * nBlockBytes;
+    // std::vector<bool> has no data() giving a bool*.
+    std::unique_ptr<bool[]> pabSuccess(new bool[nBlocksToRead]);
+
+    poBand->GetRasterBlocks(nBlocksToRead, &anXBlock[0], &anYBlock[0],
+                            &apData[0], nBlockBytes, pabSuccess.get(),
+                            nThreads > 1 ?
+                                CPLGetGlobalWorkerThreadPool(nThreads) :
+                                nullptr,
+                            nThreads);
+
+    // Blocks that could not be read are left to IReadBlock(), which will
+    // emit the appropriate error.
+    for( int i = 0; i < nBlocksToRead; i++ )
+    {
+        if( !pabSuccess[i] )
+            continue;
+        GDALRasterBlock *poBlock =
+            GetLockedBlockRef(anXBlock[i], anYBlock[i], TRUE);
+        if( poBlock == nullptr )
+            continue;
+        memcpy(poBlock->GetDataRef(), apData[i], nBlockBytes);
+        poBlock->DropLock();
+    }
+
+    VSIFree(pabyBuffer);
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr HFARasterBand::IRasterIO( GDALRWFlag eRWFlag,
+                                 int nXOff, int nYOff, int nXSize, int nYSize,
+                                 void *pData, int nBufXSize, int nBufYSize,
+                                 GDALDataType eBufType,
+                                 GSpacing nPixelSpace, GSpacing nLineSpace,
+                                 GDALRasterIOExtraArg *psExtraArg )
+
+{
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+        PrefetchBlocks(nXOff, nYOff, nXSize, nYSize);
+
+    return GDALPamRasterBand::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                        pData, nBufXSize, nBufYSize, eBufType,
+                                        nPixelSpace, nLineSpace, psExtraArg);
+}
+
 /************************************************************************/
 /*                            IWriteBlock()                             */
 /************************************************************************/
@@ -5267,6 +5396,12 @@ GDALDataset *HFADataset::Open( GDALOpenInfo * poOpenInfo )
     poDS->hHFA = hHFA;
     poDS->eAccess = poOpenInfo->eAccess;
 
+    // Multi-block reads are decoded in parallel when requested.
+    if( CPLGetConfigOption("GDAL_NUM_THREADS", nullptr) != nullptr )
+        poDS->m_nDecompressionThreads = CPLGetNumThreads();
+    poDS->m_bHasOptimizedReadMultiRange =
+        CPL_TO_BOOL(VSIHasOptimizedReadMultiRange(poOpenInfo->pszFilename));
+
     // Establish raster info.
     HFAGetRasterInfo(hHFA, &poDS->nRasterXSize, &poDS->nRasterYSize,
                      &poDS->nBands);
@@ -6096,6 +6231,8 @@ void GDALRegister_HFA()
     poDriver->SetMetadataItem(GDAL_DMD_LONGNAME, "Erdas Imagine Images (.img)");
     poDriver->SetMetadataItem(GDAL_DMD_HELPTOPIC, "frmt_hfa.html");
     poDriver->SetMetadataItem(GDAL_DMD_EXTENSION, "img");
+    poDriver->SetMetadataItem(GDAL_DMD_SIGNATURES,
+                              "454846415F4845414445525F544147");
     poDriver->SetMetadataItem(GDAL_DMD_CREATIONDATATYPES,
                               "Byte Int16 UInt16 Int32 UInt32 Float32 Float64 "
                               "CFloat32 CFloat64");
@@ -70,6 +70,10 @@ class HFADataset final : public GDALPamDataset
     int         nGCPCount;
     GDAL_GCP    asGCPList[36];
 
+    // Number of threads decoding the blocks of a multi-block RasterIO().
+    int         m_nDecompressionThreads = 0;
+    bool        m_bHasOptimizedReadMultiRange = false;
+
     void        UseXFormStack( int nStepCount,
                                Efga_Polynomial *pasPolyListForward,
                                Efga_Polynomial *pasPolyListReverse );
@@ -155,6 +159,7 @@ class HFARasterBand final : public GDALPamRasterBand
     HFARasterBand **papoOverviewBands;
 
     CPLErr      CleanOverviews();
+    void        PrefetchBlocks( int nXOff, int nYOff, int nXSize, int nYSize );
 
     HFAHandle   hHFA;
 
@@ -174,6 +179,10 @@ class HFARasterBand final : public GDALPamRasterBand
 
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
 
     virtual const char *GetDescription() const override;
     virtual void        SetDescription( const char * ) override;
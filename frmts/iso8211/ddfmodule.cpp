@@ -38,6 +38,7 @@
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_string.h"
 #include "cpl_vsi.h"
 
 CPL_CVSID("$Id: ddfmodule.cpp 6383eae265b6c57bbffde01a0dfda37b8150ce50 2018-05-03 17:22:05 +0200 Even Rouault $")
@@ -192,6 +193,47 @@ int DDFModule::Open( const char * pszFilename, int bFailQuietly )
         return FALSE;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Records are read with many small VSIFReadL() calls, which are   */
+/*      costly on most file systems.  Unless the file is big, load it   */
+/*      with a single read and serve the records from an anonymous      */
+/*      /vsimem/ copy, so that GetFP() remains usable by callers.       */
+/* -------------------------------------------------------------------- */
+    const GIntBig nMaxInMemorySize = static_cast<GIntBig>(
+        CPLAtof(CPLGetConfigOption("ISO8211_IN_MEMORY_MAX_SIZE", "100"))
+        * 1024 * 1024 );
+    if( !STARTS_WITH(pszFilename, "/vsimem/") &&
+        sStat.st_size > 0 &&
+        static_cast<GIntBig>(sStat.st_size) <= nMaxInMemorySize )
+    {
+        const size_t nSize = static_cast<size_t>(sStat.st_size);
+        GByte *pabyData = static_cast<GByte *>( VSI_MALLOC_VERBOSE(nSize) );
+        if( pabyData != nullptr &&
+            VSIFReadL( pabyData, 1, nSize, fpDDF ) == nSize )
+        {
+            const char *pszMemFilename = CPLSPrintf("/vsimem/ddf_%p", this);
+            VSILFILE *fpMem =
+                VSIFileFromMemBuffer( pszMemFilename, pabyData,
+                                      nSize, TRUE );
+            // The open handle keeps the buffer alive once unlinked.
+            VSIUnlink( pszMemFilename );
+            if( fpMem != nullptr )
+            {
+                CPL_IGNORE_RET_VAL(VSIFCloseL( fpDDF ));
+                fpDDF = fpMem;
+            }
+            else
+            {
+                CPL_IGNORE_RET_VAL(VSIFSeekL( fpDDF, 0, SEEK_SET ));
+            }
+        }
+        else
+        {
+            VSIFree( pabyData );
+            CPL_IGNORE_RET_VAL(VSIFSeekL( fpDDF, 0, SEEK_SET ));
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Read the 24 byte leader.                                        */
 /* -------------------------------------------------------------------- */
@@ -325,6 +325,85 @@ CPLErr KEARasterBand::IReadBlock( int nBlockXOff, int nBlockYOff, void * pImage
     }
 }
 
+// reads a window of the band into a buffer of exactly that size
+void KEARasterBand::ReadWindow( int nXOff, int nYOff, int nXSize, int nYSize,
+                                void *pData )
+{
+    this->m_pImageIO->readImageBlock2Band( this->nBand, pData, nXOff, nYOff,
+                                           nXSize, nYSize, nXSize, nYSize,
+                                           this->m_eKEADataType );
+}
+
+// virtual method to read/write a window. Non resampled reads of a
+// read-only dataset that span several blocks are done with a single
+// hyperslab read, rather than one HDF5 read per block through the
+// block cache
+CPLErr KEARasterBand::IRasterIO( GDALRWFlag eRWFlag,
+                                 int nXOff, int nYOff, int nXSize, int nYSize,
+                                 void *pData, int nBufXSize, int nBufYSize,
+                                 GDALDataType eBufType,
+                                 GSpacing nPixelSpace, GSpacing nLineSpace,
+                                 GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read && this->eAccess == GA_ReadOnly &&
+        nXSize == nBufXSize && nYSize == nBufYSize &&
+        ( nXOff / nBlockXSize != (nXOff + nXSize - 1) / nBlockXSize ||
+          nYOff / nBlockYSize != (nYOff + nYSize - 1) / nBlockYSize ) )
+    {
+        const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+        const bool bDirect = eBufType == eDataType && nPixelSpace == nDTSize &&
+                             nLineSpace == nPixelSpace * nBufXSize;
+        GByte *pabyWindow = nullptr;
+        if( bDirect )
+        {
+            pabyWindow = static_cast<GByte*>(pData);
+        }
+        else if( static_cast<GIntBig>(nDTSize) * nXSize * nYSize <=
+                                                    64 * 1024 * 1024 )
+        {
+            // converted afterwards. Silently fall back to the block based
+            // path if this cannot be allocated
+            pabyWindow = static_cast<GByte*>(
+                                    VSIMalloc3(nDTSize, nXSize, nYSize));
+        }
+
+        if( pabyWindow != nullptr )
+        {
+            try
+            {
+                ReadWindow( nXOff, nYOff, nXSize, nYSize, pabyWindow );
+            }
+            catch (const kealib::KEAIOException &e)
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                        "Failed to read file: %s", e.what() );
+                if( !bDirect )
+                    CPLFree(pabyWindow);
+                return CE_Failure;
+            }
+
+            if( !bDirect )
+            {
+                for( int iLine = 0; iLine < nYSize; iLine++ )
+                {
+                    GDALCopyWords( pabyWindow +
+                                    static_cast<size_t>(iLine) * nXSize * nDTSize,
+                                   eDataType, nDTSize,
+                                   static_cast<GByte*>(pData) + iLine * nLineSpace,
+                                   eBufType, static_cast<int>(nPixelSpace),
+                                   nXSize );
+                }
+                CPLFree(pabyWindow);
+            }
+            return CE_None;
+        }
+    }
+
+    return GDALPamRasterBand::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                         pData, nBufXSize, nBufYSize, eBufType,
+                                         nPixelSpace, nLineSpace, psExtraArg );
+}
+
 // virtual method to write a block
 CPLErr KEARasterBand::IWriteBlock( int nBlockXOff, int nBlockYOff, void * pImage )
 {
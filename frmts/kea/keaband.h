@@ -115,6 +115,15 @@ protected:
     // methods for accessing data as blocks
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              GSpacing, GSpacing,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
+
+    // reads an arbitrary window into a buffer of exactly that size
+    // (overridden by overviews). Throws kealib::KEAIOException
+    virtual void ReadWindow( int nXOff, int nYOff, int nXSize, int nYSize,
+                             void *pData );
 
     // updates m_papszMetadataList
     void UpdateMetadataList();
@@ -119,6 +119,35 @@ GDALDataset *KEADataset::Open( GDALOpenInfo * poOpenInfo )
     {
         try
         {
+            // HDF5 cache settings, which can be tuned with open options.
+            // A raw data chunk cache larger than the default 1 MB helps
+            // a lot when reading large windows or many bands
+            char **papszOpenOptions = poOpenInfo->papszOpenOptions;
+            int nmdcElmts = kealib::KEA_MDC_NELMTS;
+            const char *pszValue = CSLFetchNameValue( papszOpenOptions, "MDC_NELMTS" );
+            if( pszValue != nullptr )
+                nmdcElmts = atoi( pszValue );
+
+            hsize_t nrdccNElmts = kealib::KEA_RDCC_NELMTS;
+            pszValue = CSLFetchNameValue( papszOpenOptions, "RDCC_NELMTS" );
+            if( pszValue != nullptr )
+                nrdccNElmts = static_cast<hsize_t>( CPLAtoGIntBig( pszValue ) );
+
+            hsize_t nrdccNBytes = kealib::KEA_RDCC_NBYTES;
+            pszValue = CSLFetchNameValue( papszOpenOptions, "RDCC_NBYTES" );
+            if( pszValue != nullptr )
+                nrdccNBytes = static_cast<hsize_t>( CPLAtoGIntBig( pszValue ) );
+
+            double nrdccW0 = kealib::KEA_RDCC_W0;
+            pszValue = CSLFetchNameValue( papszOpenOptions, "RDCC_W0" );
+            if( pszValue != nullptr )
+                nrdccW0 = CPLAtof( pszValue );
+
+            hsize_t nsieveBuf = kealib::KEA_SIEVE_BUF;
+            pszValue = CSLFetchNameValue( papszOpenOptions, "SIEVE_BUF" );
+            if( pszValue != nullptr )
+                nsieveBuf = static_cast<hsize_t>( CPLAtoGIntBig( pszValue ) );
+
             // try and open it in the appropriate mode
             H5::H5File *pH5File;
             if( poOpenInfo->eAccess == GA_ReadOnly )
@@ -127,9 +156,9 @@ GDALDataset *KEADataset::Open( GDALOpenInfo * poOpenInfo )
                 // /vsicurl etc
                 // do this same as libkea
                 H5::FileAccPropList keaAccessPlist = H5::FileAccPropList(H5::FileAccPropList::DEFAULT);
-                keaAccessPlist.setCache(kealib::KEA_MDC_NELMTS, kealib::KEA_RDCC_NELMTS, 
-                            kealib::KEA_RDCC_NBYTES, kealib::KEA_RDCC_W0);
-                keaAccessPlist.setSieveBufSize(kealib::KEA_SIEVE_BUF);
+                keaAccessPlist.setCache(nmdcElmts, nrdccNElmts,
+                            nrdccNBytes, nrdccW0);
+                keaAccessPlist.setSieveBufSize(nsieveBuf);
                 hsize_t blockSize = kealib::KEA_META_BLOCKSIZE;
                 keaAccessPlist.setMetaBlockSize(blockSize);
                 // but set the driver
@@ -141,7 +170,9 @@ GDALDataset *KEADataset::Open( GDALOpenInfo * poOpenInfo )
             else
             {
                 // Must be a local file
-                pH5File = kealib::KEAImageIO::openKeaH5RW( poOpenInfo->pszFilename );
+                pH5File = kealib::KEAImageIO::openKeaH5RW( poOpenInfo->pszFilename,
+                                    nmdcElmts, nrdccNElmts, nrdccNBytes, nrdccW0,
+                                    nsieveBuf );
             }
             // create the KEADataset object
             KEADataset *pDataset = new KEADataset( pH5File, poOpenInfo->eAccess );
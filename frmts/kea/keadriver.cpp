@@ -75,6 +75,21 @@ void GDALRegister_KEA()
         static_cast<int>(kealib::KEA_SIEVE_BUF),
         static_cast<int>(kealib::KEA_META_BLOCKSIZE),
         kealib::KEA_DEFLATE ) );
+    poDriver->SetMetadataItem(
+        GDAL_DMD_OPENOPTIONLIST,
+        CPLSPrintf(
+"<OpenOptionList> "
+"<Option name='MDC_NELMTS' type='int' description='Number of elements in the meta data cache' default='%d'/> "
+"<Option name='RDCC_NELMTS' type='int' description='Number of elements in the raw data chunk cache' default='%d'/> "
+"<Option name='RDCC_NBYTES' type='int' description='Total size of the raw data chunk cache, in bytes' default='%d'/> "
+"<Option name='RDCC_W0' type='float' min='0' max='1' description='Preemption policy' default='%.2f'/> "
+"<Option name='SIEVE_BUF' type='int' description='Sets the maximum size of the data sieve buffer' default='%d'/> "
+"</OpenOptionList>",
+        static_cast<int>(kealib::KEA_MDC_NELMTS),
+        static_cast<int>(kealib::KEA_RDCC_NELMTS),
+        static_cast<int>(kealib::KEA_RDCC_NBYTES),
+        kealib::KEA_RDCC_W0,
+        static_cast<int>(kealib::KEA_SIEVE_BUF) ) );
     poDriver->SetMetadataItem(GDAL_DCAP_VIRTUALIO, "YES" );
 
     poDriver->pfnOpen = KEADataset::Open;
@@ -81,6 +81,15 @@ CPLErr KEAOverview::IReadBlock( int nBlockXOff, int nBlockYOff, void * pImage )
     }
 }
 
+// overridden implementation - calls readFromOverview instead
+void KEAOverview::ReadWindow( int nXOff, int nYOff, int nXSize, int nYSize,
+                              void *pData )
+{
+    this->m_pImageIO->readFromOverview( this->nBand, this->m_nOverviewIndex,
+                                        pData, nXOff, nYOff, nXSize, nYSize,
+                                        nXSize, nYSize, this->m_eKEADataType );
+}
+
 // overridden implementation - calls writeToOverview instead
 CPLErr KEAOverview::IWriteBlock( int nBlockXOff, int nBlockYOff, void * pImage )
 {
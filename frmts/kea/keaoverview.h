@@ -57,6 +57,8 @@ protected:
     // we just override these functions from KEARasterBand
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
+    virtual void ReadWindow( int nXOff, int nYOff, int nXSize, int nYSize,
+                             void *pData ) override;
 };
 
 #endif //KEAOVERVIEW_H
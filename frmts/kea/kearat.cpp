@@ -29,6 +29,8 @@
 
 #include "kearat.h"
 
+#include <algorithm>
+
 CPL_CVSID("$Id: kearat.cpp 2519a7eb0e1649dbf8625ae8ffc7bb7c3ef9514b 2018-07-10 12:05:23 +0100 Robert Coup $")
 
 KEARasterAttributeTable::KEARasterAttributeTable(kealib::KEAAttributeTable *poKEATable,
@@ -108,78 +110,86 @@ GDALDefaultRasterAttributeTable *KEARasterAttributeTable::Clone() const
         poRAT->CreateColumn(sName, eGDALType, eGDALUsage);
         poRAT->SetRowCount(static_cast<int>(m_poKEATable->getSize()));
 
-        if( m_poKEATable->getSize() == 0 )
+        const int nRows = static_cast<int>(m_poKEATable->getSize());
+        if( nRows == 0 )
             continue;
 
+        // transfer the column a chunk of rows at a time, so that we issue
+        // reads matching the HDF5 chunking and never hold a second full
+        // copy of the column
+        const int nChunkRows = std::min(nRows,
+                                static_cast<int>(kealib::KEA_ATT_CHUNK_SIZE));
+        KEARasterAttributeTable *poThis = const_cast<KEARasterAttributeTable*>(this);
+        bool bOK = true;
+
         if( eGDALType == GFT_Integer )
         {
-            int *panColData = (int*)VSI_MALLOC2_VERBOSE(sizeof(int), m_poKEATable->getSize());
-            if( panColData == nullptr )
+            std::vector<int> anColData;
+            try
             {
-                delete poRAT;
-                return nullptr;
+                anColData.resize(nChunkRows);
             }
-
-            if( (const_cast<KEARasterAttributeTable*>(this))->
-                        ValuesIO(GF_Read, iCol, 0, static_cast<int>(m_poKEATable->getSize()), panColData ) != CE_None )
+            catch( const std::bad_alloc& )
             {
-                CPLFree(panColData);
-                delete poRAT;
-                return nullptr;
+                CPLError(CE_Failure, CPLE_OutOfMemory, "Out of memory");
+                bOK = false;
             }
-
-            for( int iRow = 0; iRow < (int)m_poKEATable->getSize(); iRow++ )
+            for( int iStart = 0; bOK && iStart < nRows; iStart += nChunkRows )
             {
-                poRAT->SetValue(iRow, iCol, panColData[iRow]);
+                const int nCount = std::min(nChunkRows, nRows - iStart);
+                bOK = poThis->ValuesIO(GF_Read, iCol, iStart, nCount,
+                                       &anColData[0]) == CE_None &&
+                      poRAT->ValuesIO(GF_Write, iCol, iStart, nCount,
+                                      &anColData[0]) == CE_None;
             }
-            CPLFree(panColData);
         }
-        if( eGDALType == GFT_Real )
+        else if( eGDALType == GFT_Real )
         {
-            double *padfColData = (double*)VSI_MALLOC2_VERBOSE(sizeof(double), m_poKEATable->getSize());
-            if( padfColData == nullptr )
+            std::vector<double> adfColData;
+            try
             {
-                delete poRAT;
-                return nullptr;
+                adfColData.resize(nChunkRows);
             }
-            if( (const_cast<KEARasterAttributeTable*>(this))->
-                        ValuesIO(GF_Read, iCol, 0, static_cast<int>(m_poKEATable->getSize()), padfColData ) != CE_None )
+            catch( const std::bad_alloc& )
             {
-                CPLFree(padfColData);
-                delete poRAT;
-                return nullptr;
+                CPLError(CE_Failure, CPLE_OutOfMemory, "Out of memory");
+                bOK = false;
             }
-
-            for( int iRow = 0; iRow < (int)m_poKEATable->getSize(); iRow++ )
+            for( int iStart = 0; bOK && iStart < nRows; iStart += nChunkRows )
             {
-                poRAT->SetValue(iRow, iCol, padfColData[iRow]);
+                const int nCount = std::min(nChunkRows, nRows - iStart);
+                bOK = poThis->ValuesIO(GF_Read, iCol, iStart, nCount,
+                                       &adfColData[0]) == CE_None &&
+                      poRAT->ValuesIO(GF_Write, iCol, iStart, nCount,
+                                      &adfColData[0]) == CE_None;
             }
-            CPLFree(padfColData);
         }
-        if( eGDALType == GFT_String )
+        else
         {
-            char **papszColData = (char**)VSI_MALLOC2_VERBOSE(sizeof(char*), m_poKEATable->getSize());
-            if( papszColData == nullptr )
-            {
-                delete poRAT;
-                return nullptr;
-            }
-
-            if( (const_cast<KEARasterAttributeTable*>(this))->
-                    ValuesIO(GF_Read, iCol, 0, static_cast<int>(m_poKEATable->getSize()), papszColData ) != CE_None )
-            {
-                CPLFree(papszColData);
-                delete poRAT;
-                return nullptr;
-            }
-
-            for( int iRow = 0; iRow < (int)m_poKEATable->getSize(); iRow++ )
+            char **papszColData = (char**)VSI_MALLOC2_VERBOSE(sizeof(char*), nChunkRows);
+            bOK = papszColData != nullptr;
+            for( int iStart = 0; bOK && iStart < nRows; iStart += nChunkRows )
             {
-                poRAT->SetValue(iRow, iCol, papszColData[iRow]);
-                CPLFree(papszColData[iRow]);
+                const int nCount = std::min(nChunkRows, nRows - iStart);
+                if( poThis->ValuesIO(GF_Read, iCol, iStart, nCount,
+                                     papszColData) != CE_None )
+                {
+                    bOK = false;
+                    break;
+                }
+                bOK = poRAT->ValuesIO(GF_Write, iCol, iStart, nCount,
+                                      papszColData) == CE_None;
+                for( int i = 0; i < nCount; i++ )
+                    CPLFree(papszColData[i]);
             }
             CPLFree(papszColData);
         }
+
+        if( !bOK )
+        {
+            delete poRAT;
+            return nullptr;
+        }
     }
 
     poRAT->SetTableType(this->GetTableType());
@@ -297,8 +307,96 @@ int KEARasterAttributeTable::GetRowCount() const
     return (int)m_poKEATable->getSize();
 }
 
+// Loads the chunk of rows of iField containing iRow into the row cache,
+// unless it is already there.
+bool KEARasterAttributeTable::LoadRowCache( int iRow, int iField )
+{
+    if( iField == m_nCacheField && iRow >= m_nCacheStartRow &&
+        iRow < m_nCacheStartRow + m_nCacheRowCount )
+        return true;
+
+    const int nRows = static_cast<int>(m_poKEATable->getSize());
+    if( iField < 0 || iField >= (int) m_aoFields.size() ||
+        iRow < 0 || iRow >= nRows )
+        return false;
+
+    InvalidateRowCache();
+
+    const int nChunkRows = static_cast<int>(kealib::KEA_ATT_CHUNK_SIZE);
+    const int nStartRow = (iRow / nChunkRows) * nChunkRows;
+    const int nCount = std::min(nChunkRows, nRows - nStartRow);
+    CPLErr eErr = CE_None;
+    try
+    {
+        switch( m_aoFields[iField].dataType )
+        {
+            case kealib::kea_att_bool:
+            case kealib::kea_att_int:
+                m_anCacheValues.resize(nCount);
+                eErr = ValuesIO(GF_Read, iField, nStartRow, nCount,
+                                &m_anCacheValues[0]);
+                break;
+            case kealib::kea_att_float:
+                m_adfCacheValues.resize(nCount);
+                eErr = ValuesIO(GF_Read, iField, nStartRow, nCount,
+                                &m_adfCacheValues[0]);
+                break;
+            case kealib::kea_att_string:
+            {
+                std::vector<std::string> aStrings;
+                m_poKEATable->getStringFields(nStartRow, nCount,
+                                          m_aoFields[iField].idx, &aStrings);
+                if( static_cast<int>(aStrings.size()) < nCount )
+                    return false;
+                m_aosCacheValues.resize(nCount);
+                for( int i = 0; i < nCount; i++ )
+                    m_aosCacheValues[i] = aStrings[i];
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    catch(const kealib::KEAException &e)
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Failed to read attribute table: %s", e.what() );
+        return false;
+    }
+    catch(const std::bad_alloc &)
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory, "Out of memory" );
+        return false;
+    }
+    if( eErr != CE_None )
+        return false;
+
+    m_nCacheField = iField;
+    m_nCacheStartRow = nStartRow;
+    m_nCacheRowCount = nCount;
+    return true;
+}
+
 const char *KEARasterAttributeTable::GetValueAsString( int iRow, int iField ) const
 {
+    KEARasterAttributeTable *poThis = const_cast<KEARasterAttributeTable*>(this);
+    if( poThis->LoadRowCache(iRow, iField) )
+    {
+        const int i = iRow - m_nCacheStartRow;
+        switch( m_aoFields[iField].dataType )
+        {
+            case kealib::kea_att_float:
+                poThis->osWorkingResult.Printf( "%.16g", m_adfCacheValues[i] );
+                break;
+            case kealib::kea_att_string:
+                poThis->osWorkingResult = m_aosCacheValues[i];
+                break;
+            default:
+                poThis->osWorkingResult.Printf( "%d", m_anCacheValues[i] );
+                break;
+        }
+        return osWorkingResult;
+    }
+
     // Get ValuesIO do do the work
     char *apszStrList[1];
     if( (const_cast<KEARasterAttributeTable*>(this))->
@@ -315,6 +413,20 @@ const char *KEARasterAttributeTable::GetValueAsString( int iRow, int iField ) co
 
 int KEARasterAttributeTable::GetValueAsInt( int iRow, int iField ) const
 {
+    if( const_cast<KEARasterAttributeTable*>(this)->LoadRowCache(iRow, iField) )
+    {
+        const int i = iRow - m_nCacheStartRow;
+        switch( m_aoFields[iField].dataType )
+        {
+            case kealib::kea_att_float:
+                return static_cast<int>(m_adfCacheValues[i]);
+            case kealib::kea_att_string:
+                return atoi(m_aosCacheValues[i]);
+            default:
+                return m_anCacheValues[i];
+        }
+    }
+
     // Get ValuesIO do do the work
     int nValue = 0;
     if( (const_cast<KEARasterAttributeTable*>(this))->
@@ -328,6 +440,20 @@ int KEARasterAttributeTable::GetValueAsInt( int iRow, int iField ) const
 
 double KEARasterAttributeTable::GetValueAsDouble( int iRow, int iField ) const
 {
+    if( const_cast<KEARasterAttributeTable*>(this)->LoadRowCache(iRow, iField) )
+    {
+        const int i = iRow - m_nCacheStartRow;
+        switch( m_aoFields[iField].dataType )
+        {
+            case kealib::kea_att_float:
+                return m_adfCacheValues[i];
+            case kealib::kea_att_string:
+                return CPLAtof(m_aosCacheValues[i]);
+            default:
+                return m_anCacheValues[i];
+        }
+    }
+
     // Get ValuesIO do do the work
     double dfValue = 0.0;
     if( (const_cast<KEARasterAttributeTable*>(this))->
@@ -359,6 +485,9 @@ void KEARasterAttributeTable::SetValue( int iRow, int iField, int nValue )
 
 CPLErr KEARasterAttributeTable::ValuesIO(GDALRWFlag eRWFlag, int iField, int iStartRow, int iLength, double *pdfData)
 {
+    if( eRWFlag == GF_Write )
+        InvalidateRowCache();
+
     /*if( ( eRWFlag == GF_Write ) && ( this->eAccess == GA_ReadOnly ) )
     {
         CPLError( CE_Failure, CPLE_NoWriteAccess,
@@ -490,6 +619,9 @@ CPLErr KEARasterAttributeTable::ValuesIO(GDALRWFlag eRWFlag, int iField, int iSt
 
 CPLErr KEARasterAttributeTable::ValuesIO(GDALRWFlag eRWFlag, int iField, int iStartRow, int iLength, int *pnData)
 {
+    if( eRWFlag == GF_Write )
+        InvalidateRowCache();
+
     /*if( ( eRWFlag == GF_Write ) && ( this->eAccess == GA_ReadOnly ) )
     {
         CPLError( CE_Failure, CPLE_NoWriteAccess,
@@ -683,6 +815,9 @@ CPLErr KEARasterAttributeTable::ValuesIO(GDALRWFlag eRWFlag, int iField, int iSt
 
 CPLErr KEARasterAttributeTable::ValuesIO(GDALRWFlag eRWFlag, int iField, int iStartRow, int iLength, char **papszStrList)
 {
+    if( eRWFlag == GF_Write )
+        InvalidateRowCache();
+
     /*if( ( eRWFlag == GF_Write ) && ( this->eAccess == GA_ReadOnly ) )
     {
         CPLError( CE_Failure, CPLE_NoWriteAccess,
@@ -834,6 +969,7 @@ void KEARasterAttributeTable::SetRowCount( int iCount )
 
     if( iCount > (int)m_poKEATable->getSize() )
     {
+        InvalidateRowCache();
         m_poKEATable->addRows(iCount - m_poKEATable->getSize());
     }
     // can't shrink
@@ -36,6 +36,8 @@
 
 #include "keaband.h"
 
+#include <vector>
+
 class KEARasterAttributeTable : public GDALDefaultRasterAttributeTable
 {
 private:
@@ -44,6 +46,19 @@ private:
     CPLString osWorkingResult;
     KEARasterBand *m_poBand;
 
+    // Window of rows of a single column kept for the GetValueAsXXX()
+    // accessors, so that row by row access does not cost one HDF5
+    // read per value. Only the vector matching the column type is used.
+    int m_nCacheField = -1;
+    int m_nCacheStartRow = 0;
+    int m_nCacheRowCount = 0;
+    std::vector<int> m_anCacheValues{};
+    std::vector<double> m_adfCacheValues{};
+    std::vector<CPLString> m_aosCacheValues{};
+
+    bool LoadRowCache( int iRow, int iField );
+    void InvalidateRowCache() { m_nCacheField = -1; m_nCacheRowCount = 0; }
+
 public:
     KEARasterAttributeTable(kealib::KEAAttributeTable *poKEATable, KEARasterBand *poBand);
     ~KEARasterAttributeTable();
@@ -79,6 +79,105 @@ GDALRasterBandH MEMCreateRasterBandEx( GDALDataset *poDS, int nBand,
                            nLineOffset, bAssumeOwnership ) );
 }
 
+/************************************************************************/
+/*                     MEMCreateDatasetFromBuffer()                     */
+/************************************************************************/
+
+/**
+ * \brief Create a MEM dataset over an externally owned buffer.
+ *
+ * No copy of the buffer is done. The bands of the dataset, and the
+ * datasets that may reference them, share the ownership of the buffer,
+ * and pfnRelease (if not NULL) is called with pReleaseUserData once the
+ * last of them is destroyed, so that the caller can release the memory.
+ *
+ * @param nXSize width of the raster.
+ * @param nYSize height of the raster.
+ * @param nBands number of bands.
+ * @param eType data type of the buffer.
+ * @param pData address of the first pixel of the first band.
+ * @param nPixelOffset offset in bytes between two pixels of a line, or 0
+ *                     for the size of eType.
+ * @param nLineOffset offset in bytes between two lines, or 0 for
+ *                    nXSize * nPixelOffset.
+ * @param nBandOffset offset in bytes between two bands, or 0 for
+ *                    nYSize * nLineOffset.
+ * @param bUpdate whether the buffer may be written.
+ * @param pfnRelease callback called when the buffer is no longer used, or
+ *                   NULL.
+ * @param pReleaseUserData user data passed to pfnRelease.
+ * @return a dataset handle, or NULL in case of error, in which case
+ *         pfnRelease has already been called.
+ * @since GDAL 3.1
+ */
+GDALDatasetH MEMCreateDatasetFromBuffer( int nXSize, int nYSize, int nBands,
+                                         GDALDataType eType, void *pData,
+                                         GSpacing nPixelOffset,
+                                         GSpacing nLineOffset,
+                                         GSpacing nBandOffset,
+                                         int bUpdate,
+                                         MEMBufferReleaseFunc pfnRelease,
+                                         void *pReleaseUserData )
+{
+    std::shared_ptr<void> poBufferOwner;
+    if( pfnRelease != nullptr )
+    {
+        poBufferOwner = std::shared_ptr<void>(pData,
+            [pfnRelease, pReleaseUserData](void*)
+            { pfnRelease(pReleaseUserData); });
+    }
+    return GDALDataset::ToHandle(
+        MEMDataset::CreateFromBuffer( nXSize, nYSize, nBands, eType,
+                                      static_cast<GByte*>(pData),
+                                      nPixelOffset, nLineOffset, nBandOffset,
+                                      bUpdate ? GA_Update : GA_ReadOnly,
+                                      poBufferOwner ));
+}
+
+/************************************************************************/
+/*                     MEMGetRasterBandDataPointer()                    */
+/************************************************************************/
+
+/**
+ * \brief Return the address of a pixel of a MEM band.
+ *
+ * This allows in-memory pipelines to access the band data without
+ * going through RasterIO(). A RasterIO() request whose buffer is the
+ * returned address, with the returned spacings and the band data type,
+ * does not copy anything.
+ *
+ * The pointer remains valid as long as the band exists. Data written
+ * through it is not seen by blocks already in the block cache, so
+ * FlushCache() should be used when mixing both access methods.
+ *
+ * @param hBand a band of a MEM dataset.
+ * @param nXOff column of the pixel.
+ * @param nYOff line of the pixel.
+ * @param pnPixelOffset if not NULL, receives the offset in bytes between
+ *                      two pixels of a line.
+ * @param pnLineOffset if not NULL, receives the offset in bytes between
+ *                     two lines.
+ * @return the address, or NULL if hBand is not a MEM band or the pixel is
+ *         outside of the raster.
+ * @since GDAL 3.1
+ */
+void *MEMGetRasterBandDataPointer( GDALRasterBandH hBand,
+                                   int nXOff, int nYOff,
+                                   GSpacing *pnPixelOffset,
+                                   GSpacing *pnLineOffset )
+{
+    VALIDATE_POINTER1( hBand, "MEMGetRasterBandDataPointer", nullptr );
+
+    MEMRasterBand* poBand =
+        dynamic_cast<MEMRasterBand*>(GDALRasterBand::FromHandle(hBand));
+    if( poBand == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Not a MEM band");
+        return nullptr;
+    }
+    return poBand->GetDataPointer(nXOff, nYOff, pnPixelOffset, pnLineOffset);
+}
+
 /************************************************************************/
 /*                           MEMRasterBand()                            */
 /************************************************************************/
@@ -163,6 +262,33 @@ MEMRasterBand::~MEMRasterBand()
         CPLDestroyXMLNode(psSavedHistograms);
 }
 
+/************************************************************************/
+/*                           GetDataPointer()                           */
+/************************************************************************/
+
+GByte *MEMRasterBand::GetDataPointer( int nXOff, int nYOff,
+                                      GSpacing *pnPixelOffset,
+                                      GSpacing *pnLineOffset )
+{
+    if( nXOff < 0 || nYOff < 0 ||
+        nXOff >= nRasterXSize || nYOff >= nRasterYSize )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "Pixel (%d,%d) outside of raster", nXOff, nYOff);
+        return nullptr;
+    }
+
+    // Blocks modified through the block cache must be in the buffer
+    FlushCache();
+
+    if( pnPixelOffset )
+        *pnPixelOffset = nPixelOffset;
+    if( pnLineOffset )
+        *pnLineOffset = nLineOffset;
+    return pabyData + nLineOffset * static_cast<size_t>(nYOff) +
+           nXOff * nPixelOffset;
+}
+
 /************************************************************************/
 /*                             IReadBlock()                             */
 /************************************************************************/
@@ -255,6 +381,31 @@ CPLErr MEMRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     // In case block based I/O has been done before.
     FlushCache();
 
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    GByte* pabyWindow = pabyData +
+        nLineOffset * static_cast<size_t>(nYOff) + nXOff * nPixelOffset;
+    if( eBufType == eDataType && nPixelSpaceBuf == nPixelOffset &&
+        (nLineSpaceBuf == nLineOffset || nYSize == 1) )
+    {
+        // The buffer is the band data itself, as returned by
+        // GetDataPointer(): nothing to do.
+        if( pData == pabyWindow )
+            return CE_None;
+
+        // Both layouts are the same contiguous area: single copy.
+        if( nPixelOffset == nDTSize &&
+            (nYSize == 1 || nLineOffset == nXSize * nPixelOffset) )
+        {
+            const size_t nBytes = static_cast<size_t>(nYSize) *
+                                  nXSize * nDTSize;
+            if( eRWFlag == GF_Read )
+                memcpy(pData, pabyWindow, nBytes);
+            else
+                memcpy(pabyWindow, pData, nBytes);
+            return CE_None;
+        }
+    }
+
     if( eRWFlag == GF_Read )
     {
         for( int iLine=0; iLine < nYSize; iLine++ )
@@ -347,6 +498,18 @@ CPLErr MEMDataset::IRasterIO( GDALRWFlag eRWFlag,
         if( iBandIndex == nBandCount )
         {
             FlushCache();
+
+            // The buffer is the band data itself, as returned by
+            // MEMGetRasterBandDataPointer(): nothing to do.
+            if( eBufType == eDT &&
+                (nLineSpaceBuf == nLineOffset || nYSize == 1) &&
+                pData == pabyData +
+                    nLineOffset * static_cast<size_t>(nYOff) +
+                    nXOff * nPixelOffset )
+            {
+                return CE_None;
+            }
+
             if( eRWFlag == GF_Read )
             {
                 for(int iLine=0;iLine<nYSize;iLine++)
@@ -433,6 +596,99 @@ CPLErr MEMDataset::IRasterIO( GDALRWFlag eRWFlag,
     return eErr;
 }
 
+/************************************************************************/
+/*                         MEMCountDataPixels()                         */
+/************************************************************************/
+
+template<class T>
+static int MEMCountDataPixels( const GByte* pabyLine, GSpacing nPixelOffset,
+                               int nXSize, const GByte* pabyEmpty )
+{
+    T tEmpty;
+    memcpy(&tEmpty, pabyEmpty, sizeof(T));
+    int nCount = 0;
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        T tVal;
+        memcpy(&tVal, pabyLine + iX * nPixelOffset, sizeof(T));
+        nCount += (tVal != tEmpty) ? 1 : 0;
+    }
+    return nCount;
+}
+
+/************************************************************************/
+/*                       IGetDataCoverageStatus()                       */
+/*                                                                      */
+/*      Pixels set to the nodata value, or to 0 when it is not set,     */
+/*      are reported as empty, as they would be read from the holes     */
+/*      of a sparse file.                                               */
+/************************************************************************/
+
+int MEMRasterBand::IGetDataCoverageStatus( int nXOff, int nYOff,
+                                           int nXSize, int nYSize,
+                                           int nMaskFlagStop,
+                                           double* pdfDataPct )
+{
+    const int nWordSize = GDALGetDataTypeSizeBytes(eDataType);
+    GByte abyEmpty[16] = {};
+    if( bNoDataSet )
+        GDALCopyWords(&dfNoData, GDT_Float64, 0,
+                      abyEmpty, eDataType, 0, 1);
+
+    int nStatus = 0;
+    GIntBig nPixelsData = 0;
+    for( int iY = 0; iY < nYSize; iY++ )
+    {
+        const GByte* pabyLine = pabyData +
+            static_cast<GPtrDiff_t>(nYOff + iY) * nLineOffset +
+            static_cast<GPtrDiff_t>(nXOff) * nPixelOffset;
+        int nLineData = 0;
+        switch( nWordSize )
+        {
+            case 1:
+                nLineData = MEMCountDataPixels<GByte>(
+                    pabyLine, nPixelOffset, nXSize, abyEmpty);
+                break;
+            case 2:
+                nLineData = MEMCountDataPixels<GUInt16>(
+                    pabyLine, nPixelOffset, nXSize, abyEmpty);
+                break;
+            case 4:
+                nLineData = MEMCountDataPixels<GUInt32>(
+                    pabyLine, nPixelOffset, nXSize, abyEmpty);
+                break;
+            case 8:
+                nLineData = MEMCountDataPixels<GUInt64>(
+                    pabyLine, nPixelOffset, nXSize, abyEmpty);
+                break;
+            default:
+                for( int iX = 0; iX < nXSize; iX++ )
+                {
+                    if( memcmp(pabyLine + iX * nPixelOffset, abyEmpty,
+                               nWordSize) != 0 )
+                        nLineData++;
+                }
+                break;
+        }
+
+        nPixelsData += nLineData;
+        if( nLineData > 0 )
+            nStatus |= GDAL_DATA_COVERAGE_STATUS_DATA;
+        if( nLineData < nXSize )
+            nStatus |= GDAL_DATA_COVERAGE_STATUS_EMPTY;
+        if( nMaskFlagStop != 0 && (nMaskFlagStop & nStatus) != 0 )
+        {
+            if( pdfDataPct )
+                *pdfDataPct = -1.0;
+            return nStatus;
+        }
+    }
+    if( pdfDataPct )
+        *pdfDataPct = 100.0 * nPixelsData /
+                        (static_cast<GIntBig>(nXSize) * nYSize);
+    return nStatus;
+}
+
 /************************************************************************/
 /*                            GetNoDataValue()                          */
 /************************************************************************/
@@ -1599,6 +1855,58 @@ GDALDataset *MEMDataset::Create( const char * /* pszFilename */,
     return poDS;
 }
 
+/************************************************************************/
+/*                          CreateFromBuffer()                          */
+/************************************************************************/
+
+MEMDataset *MEMDataset::CreateFromBuffer( int nXSize, int nYSize, int nBands,
+                                          GDALDataType eType, GByte *pabyData,
+                                          GSpacing nPixelOffset,
+                                          GSpacing nLineOffset,
+                                          GSpacing nBandOffset,
+                                          GDALAccess eAccessIn,
+                                          const std::shared_ptr<void>& poBufferOwner )
+{
+    if( pabyData == nullptr || nXSize <= 0 || nYSize <= 0 || nBands <= 0 ||
+        eType == GDT_Unknown || eType == GDT_TypeCount )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Invalid parameters for MEMDataset::CreateFromBuffer()" );
+        return nullptr;
+    }
+
+    if( nPixelOffset == 0 )
+        nPixelOffset = GDALGetDataTypeSizeBytes(eType);
+    if( nLineOffset == 0 )
+        nLineOffset = nXSize * nPixelOffset;
+    if( nBandOffset == 0 )
+        nBandOffset = nYSize * nLineOffset;
+
+    MEMDataset *poDS = new MEMDataset();
+
+    poDS->nRasterXSize = nXSize;
+    poDS->nRasterYSize = nYSize;
+    poDS->eAccess = eAccessIn;
+
+    for( int iBand = 0; iBand < nBands; iBand++ )
+    {
+        MEMRasterBand *poNewBand =
+            new MEMRasterBand( poDS, iBand+1,
+                               pabyData + iBand * nBandOffset, eType,
+                               nPixelOffset, nLineOffset, FALSE );
+        poNewBand->m_poBufferOwner = poBufferOwner;
+        poDS->SetBand( iBand+1, poNewBand );
+    }
+
+    if( nBands > 1 && nBandOffset == GDALGetDataTypeSizeBytes(eType) &&
+        nPixelOffset == nBands * nBandOffset )
+    {
+        poDS->SetMetadataItem( "INTERLEAVE", "PIXEL", "IMAGE_STRUCTURE" );
+    }
+
+    return poDS;
+}
+
 /************************************************************************/
 /*                     MEMDatasetIdentify()                             */
 /************************************************************************/
@@ -44,6 +44,24 @@ GDALRasterBandH CPL_DLL MEMCreateRasterBand( GDALDataset *, int, GByte *,
 GDALRasterBandH CPL_DLL MEMCreateRasterBandEx( GDALDataset *, int, GByte *,
                                                GDALDataType, GSpacing, GSpacing,
                                                int );
+
+/** Callback called when a buffer wrapped by a MEM dataset is no longer used */
+typedef void (*MEMBufferReleaseFunc)( void *pUserData );
+
+GDALDatasetH CPL_DLL MEMCreateDatasetFromBuffer( int nXSize, int nYSize,
+                                                 int nBands,
+                                                 GDALDataType eType,
+                                                 void *pData,
+                                                 GSpacing nPixelOffset,
+                                                 GSpacing nLineOffset,
+                                                 GSpacing nBandOffset,
+                                                 int bUpdate,
+                                                 MEMBufferReleaseFunc pfnRelease,
+                                                 void *pReleaseUserData );
+void CPL_DLL *MEMGetRasterBandDataPointer( GDALRasterBandH hBand,
+                                           int nXOff, int nYOff,
+                                           GSpacing *pnPixelOffset,
+                                           GSpacing *pnLineOffset );
 CPL_C_END
 
 /************************************************************************/
@@ -130,6 +148,13 @@ class CPL_DLL MEMDataset : public GDALDataset
     static GDALDataset *Create( const char * pszFilename,
                                 int nXSize, int nYSize, int nBands,
                                 GDALDataType eType, char ** papszParmList );
+    static MEMDataset *CreateFromBuffer( int nXSize, int nYSize, int nBands,
+                                         GDALDataType eType, GByte *pabyData,
+                                         GSpacing nPixelOffset,
+                                         GSpacing nLineOffset,
+                                         GSpacing nBandOffset,
+                                         GDALAccess eAccess,
+                                         const std::shared_ptr<void>& poBufferOwner );
 };
 
 /************************************************************************/
@@ -168,6 +193,10 @@ class CPL_DLL MEMRasterBand : public GDALPamRasterBand
 
     std::unique_ptr<GDALRasterAttributeTable> m_poRAT;
 
+    // Keeps alive an externally owned buffer, shared by all the bands
+    // wrapping it.
+    std::shared_ptr<void> m_poBufferOwner{};
+
   public:
                    MEMRasterBand( GDALDataset *poDS, int nBand,
                                   GByte *pabyData, GDALDataType eType,
@@ -185,6 +214,10 @@ class CPL_DLL MEMRasterBand : public GDALPamRasterBand
                                   GSpacing nPixelSpaceBuf,
                                   GSpacing nLineSpaceBuf,
                                   GDALRasterIOExtraArg* psExtraArg ) override;
+    virtual int    IGetDataCoverageStatus( int nXOff, int nYOff,
+                                           int nXSize, int nYSize,
+                                           int nMaskFlagStop,
+                                           double* pdfDataPct ) override;
     virtual double GetNoDataValue( int *pbSuccess = nullptr ) override;
     virtual CPLErr SetNoDataValue( double ) override;
     virtual CPLErr DeleteNoDataValue() override;
@@ -224,6 +257,9 @@ class CPL_DLL MEMRasterBand : public GDALPamRasterBand
 
     // Allow access to MEM driver's private internal memory buffer.
     GByte *GetData() const { return(pabyData); }
+
+    GByte *GetDataPointer( int nXOff, int nYOff,
+                           GSpacing *pnPixelOffset, GSpacing *pnLineOffset );
 };
 
 #endif /* ndef MEMDATASET_H_INCLUDED */
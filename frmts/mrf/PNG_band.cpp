@@ -325,7 +325,8 @@ CPLErr PNG_Band::Decompress(buf_mgr &dst, buf_mgr &src)
     return codec.DecompressPNG(dst, src);
 }
 
-CPLErr PNG_Band::Compress(buf_mgr &dst, buf_mgr &src)
+// Sets the codec state, only modifies the codec the first time it gets called
+CPLErr PNG_Band::PrepareCompress()
 {
     if (!codec.PNGColors && img.comp == IL_PPNG) { // Late set PNG palette to conserve memory
         GDALColorTable *poCT = GetColorTable();
@@ -336,7 +337,15 @@ CPLErr PNG_Band::Compress(buf_mgr &dst, buf_mgr &src)
         ResetPalette(poCT, codec);
     }
 
-    codec.deflate_flags = deflate_flags;
+    if (codec.deflate_flags != deflate_flags)
+        codec.deflate_flags = deflate_flags;
+    return CE_None;
+}
+
+CPLErr PNG_Band::Compress(buf_mgr &dst, buf_mgr &src)
+{
+    if (CE_None != PrepareCompress())
+        return CE_Failure;
     return codec.CompressPNG(dst, src);
 }
 
@@ -44,6 +44,7 @@
  */
 
 #include "marfa.h"
+#include "cpl_atomic_ops.h"
 
 CPL_CVSID("$Id: Tif_band.cpp 7e07230bbff24eb333608de4dbd460b7312839d0 2017-12-11 19:08:47Z Even Rouault $")
 
@@ -61,8 +62,9 @@ static CPLString uniq_memfname(const char *prefix)
 #else
     CPLString fname;
     VSIStatBufL statb;
-    static unsigned int cnt=0;
-    do fname.Printf("/vsimem/%s_%08x",prefix, cnt++);
+    // Pages may be compressed by multiple threads
+    static volatile int cnt=0;
+    do fname.Printf("/vsimem/%s_%08x",prefix, CPLAtomicInc(&cnt));
     while (!VSIStatL(fname, &statb));
     return fname;
 #endif
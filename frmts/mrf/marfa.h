@@ -54,11 +54,15 @@
 #include <ogr_spatialref.h>
 
 #include <limits>
+#include <list>
+#include <mutex>
 // For printing values
 #include <ostream>
 #include <iostream>
 #include <sstream>
 
+class CPLJobQueue;
+
 #define NAMESPACE_MRF_START namespace GDAL_MRF {
 #define NAMESPACE_MRF_END   }
 #define USING_NAMESPACE_MRF using namespace GDAL_MRF;
@@ -106,6 +110,7 @@ extern char const * const * ILOrder_Name;
 
 class GDALMRFDataset;
 class GDALMRFRasterBand;
+struct MRFTileQueue;
 
 typedef struct {
     char   *buffer;
@@ -429,9 +434,19 @@ protected:
 
     virtual int CloseDependentDatasets() override;
 
+    virtual void FlushCache() override;
+
     // Write a tile, the infooffset is the relative position in the index file
     virtual CPLErr WriteTile(void *buff, GUIntBig infooffset, GUIntBig size = 0);
 
+    // Pipelined writes, used when GDAL_NUM_THREADS is larger than one
+    // Pages are compressed by worker threads, then written in order
+    bool UseTileQueue();
+    // Takes ownership of the page, a null band queues an empty tile
+    CPLErr QueueTile(GDALMRFRasterBand *band, void *page, GUIntBig infooffset);
+    // Writes the compressed pages, in order, waits for all of them if requested
+    CPLErr WriteQueuedTiles(bool wait_all);
+
     // Custom CopyWholeRaster for Zen JPEG
     CPLErr ZenCopy(GDALDataset *poSrc, GDALProgressFunc pfnProgress, void * pProgressData);
 
@@ -522,6 +537,13 @@ protected:
     VF dfp;  // Data file handle
     VF ifp;  // Index file handle
 
+    // Serializes the file access, the index and data file handles are shared
+    CPLMutex *hIOMutex;
+
+    // Number of compression threads, -1 until the first write
+    int write_threads;
+    MRFTileQueue *write_queue;
+
     // statistical values
     std::vector<double> vNoData, vMin, vMax;
 };
@@ -597,6 +619,13 @@ protected:
     virtual CPLErr Compress(buf_mgr &dst, buf_mgr &src) = 0;
     virtual CPLErr Decompress(buf_mgr &dst, buf_mgr &src) = 0;
 
+    // Called from the main thread before a page is handed to a worker thread,
+    // Compress has to be reentrant after this
+    virtual CPLErr PrepareCompress() { return CE_None; }
+
+    // Worker thread function, compresses a queued page
+    static void CompressQueuedPage(void *job);
+
     // Read the index record itself, can be overwritten
     //    virtual CPLErr ReadTileIdx(const ILSize &, ILIdx &, GIntBig bias = 0);
 
@@ -651,6 +680,7 @@ public:
 protected:
     virtual CPLErr Decompress(buf_mgr &dst, buf_mgr &src) override;
     virtual CPLErr Compress(buf_mgr &dst, buf_mgr &src) override;
+    virtual CPLErr PrepareCompress() override;
 
     PNG_Codec codec;
 };
@@ -799,6 +829,30 @@ protected:
     GDALMRFRasterBand *pBand;
 };
 
+// A page being compressed by a worker thread
+typedef struct {
+    GDALMRFRasterBand *band;    // Null for an empty tile
+    MRFTileQueue *queue;
+    GUIntBig infooffset;
+    char *buffer;               // The page, followed by space for the output
+    size_t pagesize;
+    size_t bufsize;
+    char *out;                  // Compressed page, within buffer
+    size_t size;
+    CPLErr err;
+    CPLString error;
+    bool done;
+} MRFTileJob;
+
+// Compressed pages pending write, in submission order
+struct MRFTileQueue {
+    CPLJobQueue *jobqueue = nullptr;    // Compression jobs, in the global pool
+    std::mutex mutex{};
+    std::list<MRFTileJob *> jobs{};
+    bool writing = false;       // Set while the queue writes a tile
+    ~MRFTileQueue();
+};
+
 NAMESPACE_MRF_END
 
 #endif // GDAL_FRMTS_MRF_MARFA_H_INCLUDED
@@ -50,6 +50,7 @@
 
 #include "marfa.h"
 #include "cpl_multiproc.h" /* for CPLSleep() */
+#include "cpl_worker_thread_pool.h"
 #include <gdal_priv.h>
 #include <assert.h>
 
@@ -69,6 +70,12 @@ NAMESPACE_MRF_START
 #define BOOLTEST CSLTestBoolean
 #endif
 
+// Waits for the running compression jobs
+MRFTileQueue::~MRFTileQueue()
+{
+    delete jobqueue;
+}
+
 // Initialize as invalid
 GDALMRFDataset::GDALMRFDataset() :
     zslice(0),
@@ -93,7 +100,10 @@ GDALMRFDataset::GDALMRFDataset() :
     bdirty(0),
     bGeoTransformValid(TRUE),
     poColorTable(nullptr),
-    Quality(0)
+    Quality(0),
+    hIOMutex(nullptr),
+    write_threads(-1),
+    write_queue(nullptr)
 {
     //                X0   Xx   Xy  Y0    Yx   Yy
     double gt[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
@@ -160,11 +170,146 @@ GDALMRFDataset::~GDALMRFDataset()
 
     delete poColorTable;
 
+    // The queue has been written by FlushCache
+    delete write_queue;
+    if (hIOMutex)
+        CPLDestroyMutex(hIOMutex);
+
     // CPLFree ignores being called with NULL
     CPLFree(pbuffer);
     pbsize = 0;
 }
 
+void GDALMRFDataset::FlushCache()
+{
+    // The band caches might queue more pages
+    GDALPamDataset::FlushCache();
+    WriteQueuedTiles(true);
+}
+
+//
+// Checks GDAL_NUM_THREADS on the first write, a single thread keeps
+// compressing and writing the tiles synchronously
+//
+bool GDALMRFDataset::UseTileQueue()
+{
+    if (write_threads < 0) {
+        write_threads = CPLGetNumThreads();
+        if (write_threads > 1) {
+            // The global pool is shared with the other users of
+            // GDAL_NUM_THREADS
+            CPLWorkerThreadPool *pool =
+                CPLGetGlobalWorkerThreadPool(write_threads);
+            if (pool) {
+                write_queue = new MRFTileQueue();
+                write_queue->jobqueue = pool->CreateJobQueue().release();
+            }
+        }
+    }
+    return write_queue != nullptr;
+}
+
+//
+// Hands a page to the thread pool, or queues an empty tile when band is null
+// The tile record stays in line with the compressed ones, so they are
+// written in the same order as the synchronous writer would
+//
+CPLErr GDALMRFDataset::QueueTile(GDALMRFRasterBand *band, void *page, GUIntBig infooffset)
+{
+    MRFTileJob *job = new MRFTileJob();
+    job->band = band;
+    job->queue = write_queue;
+    job->infooffset = infooffset;
+    job->buffer = static_cast<char *>(page);
+    job->pagesize = band ? static_cast<size_t>(band->img.pageSizeBytes) : 0;
+    job->bufsize = job->pagesize + pbsize;
+    job->out = nullptr;
+    job->size = 0;
+    job->err = CE_None;
+    job->done = (band == nullptr);
+
+    // Codec state initialization can't happen in the workers
+    if (band && CE_None != band->PrepareCompress()) {
+        job->err = CE_Failure;
+        job->error = CPLGetLastErrorMsg();
+        job->done = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(write_queue->mutex);
+        write_queue->jobs.push_back(job);
+    }
+
+    if (!job->done &&
+        !write_queue->jobqueue->SubmitJob(GDALMRFRasterBand::CompressQueuedPage, job))
+        GDALMRFRasterBand::CompressQueuedPage(job);
+
+    return WriteQueuedTiles(false);
+}
+
+//
+// Writes the pages that are ready, in the order they were queued
+// Without wait_all, it only blocks when too many pages are pending
+//
+CPLErr GDALMRFDataset::WriteQueuedTiles(bool wait_all)
+{
+    if (!write_queue)
+        return CE_None;
+
+    CPLMutexHolderD(&hIOMutex);
+    if (write_queue->writing)
+        return CE_None;
+
+    CPLErr ret = CE_None;
+    const size_t max_pending = 2 * static_cast<size_t>(write_threads);
+    for (;;) {
+        MRFTileJob *job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(write_queue->mutex);
+            if (write_queue->jobs.empty())
+                break;
+            job = write_queue->jobs.front();
+            if (!job->done) {
+                if (!wait_all && write_queue->jobs.size() <= max_pending)
+                    break;
+                // Waiting on the job queue, instead of a condition, runs
+                // queued jobs meanwhile when called from a worker thread
+                while (!job->done) {
+                    int later = 0;
+                    for (const auto *other : write_queue->jobs)
+                        if (other != job && !other->done)
+                            later++;
+                    lock.unlock();
+                    write_queue->jobqueue->WaitCompletion(later);
+                    lock.lock();
+                }
+            }
+            write_queue->jobs.pop_front();
+        }
+
+        write_queue->writing = true;
+        CPLErr err;
+        if (CE_None != job->err) {
+            CPLError(CE_Failure, CPLE_AppDefined, "%s", job->error.c_str());
+            // Write it as an empty tile
+            WriteTile(nullptr, job->infooffset, 0);
+            err = CE_Failure;
+        }
+        else if (!job->band)
+            err = WriteTile(nullptr, job->infooffset, 0);
+        else
+            err = WriteTile(job->out, job->infooffset, job->size);
+        write_queue->writing = false;
+
+        if (CE_None != err)
+            ret = CE_Failure;
+        CPLFree(job->buffer);
+        delete job;
+    }
+
+    return ret;
+}
+
 #ifdef unused
 /*
  *\brief Called before the IRaster IO gets called
@@ -2106,6 +2251,11 @@ CPLErr GDALMRFDataset::WriteTile(void *buff, GUIntBig infooffset, GUIntBig size)
     CPLErr ret = CE_None;
     ILIdx tinfo = { 0, 0 };
 
+    CPLMutexHolderD(&hIOMutex);
+    // Queued tiles go first, so the file order matches the write order
+    if (CE_None != WriteQueuedTiles(true))
+        ret = CE_Failure;
+
     VSILFILE *l_dfp = DataFP();
     VSILFILE *l_ifp = IdxFP();
 
@@ -2164,7 +2314,7 @@ CPLErr GDALMRFDataset::WriteTile(void *buff, GUIntBig infooffset, GUIntBig size)
         }
 
         if (!new_tile)
-            return CE_None; // No reason to write
+            return ret; // No reason to write
 
         // Do we need to start a new version before writing the tile?
         if (new_version)
@@ -2286,6 +2436,11 @@ CPLErr GDALMRFDataset::GetGeoTransform(double *gt)
 CPLErr GDALMRFDataset::ReadTileIdx(ILIdx &tinfo, const ILSize &pos, const ILImage &img, const GIntBig bias)
 
 {
+    // The file handles are shared, reading threads take turns
+    CPLMutexHolderD(&hIOMutex);
+    // Pending tiles have to be in the index before reading it
+    WriteQueuedTiles(true);
+
     VSILFILE *l_ifp = IdxFP();
 
     // Initialize the tinfo structure, in case the files are missing
@@ -751,9 +751,14 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
         return CE_Failure;
     }
 
-    // This part is not thread safe, but it is what GDAL expects
-    VSIFSeekL(dfp, tinfo.offset, SEEK_SET);
-    if (1 != VSIFReadL(data, static_cast<size_t>(tinfo.size), 1, dfp)) {
+    // The data file handle is shared, only decompression runs concurrently
+    int nRead;
+    {
+        CPLMutexHolderD(&poDS->hIOMutex);
+        VSIFSeekL(dfp, tinfo.offset, SEEK_SET);
+        nRead = static_cast<int>(VSIFReadL(data, static_cast<size_t>(tinfo.size), 1, dfp));
+    }
+    if (1 != nRead) {
         CPLFree(data);
         if (poDS->no_errors) {
             return FillBlock(buffer);
@@ -867,6 +872,9 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
     if (!poDS->bCrystalized)
         poDS->Crystalize();
 
+    // Compress in a worker thread
+    const bool queued = poDS->UseTileQueue();
+
     if (1 == cstride) {     // Separate bands, we can write it as is
         // Empty page skip
 
@@ -874,7 +882,23 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
         double val = GetNoDataValue(&success);
         if (!success) val = 0.0;
         if (isAllVal(eDataType, buffer, img.pageSizeBytes, val))
-            return poDS->WriteTile(nullptr, infooffset, 0);
+            return queued ? poDS->QueueTile(nullptr, nullptr, infooffset)
+                          : poDS->WriteTile(nullptr, infooffset, 0);
+
+        if (queued) {
+            // The worker needs its own copy, followed by room for the output
+            char *page = static_cast<char *>(VSIMalloc(
+                static_cast<size_t>(img.pageSizeBytes) + poDS->pbsize));
+            if (!page) {
+                CPLError(CE_Failure, CPLE_OutOfMemory, "MRF: Can't allocate write buffer");
+                return CE_Failure;
+            }
+            memcpy(page, buffer, static_cast<size_t>(img.pageSizeBytes));
+            buf_mgr src = {page, static_cast<size_t>(img.pageSizeBytes)};
+            if (is_Endianess_Dependent(img.dt, img.comp) && (img.nbo != NET_ORDER))
+                swab_buff(src, img);
+            return poDS->QueueTile(this, page, infooffset);
+        }
 
         // Use the pbuffer to hold the compressed page before writing it
         poDS->tile = ILSize(); // Mark it corrupt
@@ -984,7 +1008,8 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
 
     if (GIntBig(empties) == AllBandMask()) {
         CPLFree(tbuffer);
-        return poDS->WriteTile(nullptr, infooffset, 0);
+        return queued ? poDS->QueueTile(nullptr, nullptr, infooffset)
+                      : poDS->WriteTile(nullptr, infooffset, 0);
     }
 
     if (poDS->bdirty != AllBandMask())
@@ -992,6 +1017,12 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
         "MRF: IWrite, band dirty mask is " CPL_FRMT_GIB " instead of " CPL_FRMT_GIB,
         poDS->bdirty, AllBandMask());
 
+    // The page is already assembled in tbuffer, the queue takes it over
+    if (queued) {
+        poDS->bdirty = 0;
+        return poDS->QueueTile(this, tbuffer, infooffset);
+    }
+
     buf_mgr src;
     src.buffer = (char *)tbuffer;
     src.size = static_cast<size_t>(img.pageSizeBytes);
@@ -1033,6 +1064,48 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
     return ret;
 }
 
+//
+// Runs in a worker thread, the page is in the job buffer and the output goes
+// right after it.  Errors are kept in the job and reported by the writer
+//
+void GDALMRFRasterBand::CompressQueuedPage(void *data)
+{
+    MRFTileJob *job = static_cast<MRFTileJob *>(data);
+    GDALMRFRasterBand *band = job->band;
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    CPLErrorReset();
+
+    buf_mgr src = {job->buffer, job->pagesize};
+    buf_mgr dst = {job->buffer + job->pagesize, job->bufsize - job->pagesize};
+    job->err = band->Compress(dst, src);
+    job->out = dst.buffer;
+    job->size = dst.size;
+
+    if (CE_None == job->err && band->deflatep) {
+        // Move the packed part at the start of the buffer, to make more space available
+        memmove(job->buffer, dst.buffer, dst.size);
+        dst.buffer = job->buffer;
+        job->out = static_cast<char *>(
+            DeflateBlock(dst, job->bufsize - dst.size, band->deflate_flags));
+        job->size = dst.size;
+        if (!job->out) {
+            CPLError(CE_Failure, CPLE_AppDefined, "MRF: Deflate error");
+            job->err = CE_Failure;
+        }
+    }
+
+    if (CE_None != job->err) {
+        job->error = CPLGetLastErrorMsg();
+        if (job->error.empty())
+            job->error = "MRF: Page compression failed";
+    }
+    CPLPopErrorHandler();
+
+    std::lock_guard<std::mutex> lock(job->queue->mutex);
+    job->done = true;
+}
+
 //
 // Tests if a given block exists without reading it
 // returns false only when it is definitely not existing
@@ -184,6 +184,10 @@ class netCDFRasterBand final: public GDALPamRasterBand
     CPLErr          CreateBandMetadata( const int *paDimIds,
                                         const int* panExtraDimGroupIds,
                                         const int* panExtraDimVarIds );
+    template <class T> void CheckValidData( T *ptrImage,
+                                            size_t nXSize, size_t nYSize,
+                                            size_t nLineStride,
+                                            bool bCheckIsNan );
     template <class T> void CheckData ( void *pImage, void *pImageNC,
                                         size_t nTmpBlockXSize,
                                         size_t nTmpBlockYSize,
@@ -193,6 +197,12 @@ class netCDFRasterBand final: public GDALPamRasterBand
                                         size_t nTmpBlockYSize,
                                         bool bCheckIsNan=false );
     void            SetBlockSize();
+    bool            CanReadLevelsAtOnce() const;
+    CPLErr          ReadLevels( int nXOff, int nYOff, int nXSize, int nYSize,
+                                int nLevels, void* pBuffer );
+#ifdef NETCDF_HAS_NC4
+    void            SetChunkCacheSize( const size_t* panChunkSize );
+#endif
 
   protected:
     CPLXMLNode *SerializeToXML( const char *pszVRTPath ) override;
@@ -604,14 +614,20 @@ void netCDFRasterBand::SetBlockSize()
     {
         size_t chunksize[MAX_NC_DIMS] = {};
         // Check for chunksize and set it as the blocksize (optimizes read).
+        // This is only possible if X is the fastest varying dimension, and
+        // Y the next one, as a block is read with a single nc_get_vara().
         status = nc_inq_var_chunking(cdfid, nZId, &nTmpFormat, chunksize);
-        if( (status == NC_NOERR) && (nTmpFormat == NC_CHUNKED) )
+        if( (status == NC_NOERR) && (nTmpFormat == NC_CHUNKED) &&
+            nBandXPos == nZDim - 1 &&
+            (nBandYPos < 0 || nBandYPos == nZDim - 2) )
         {
-            nBlockXSize = (int)chunksize[nZDim - 1];
-            if( nZDim >= 2 )
-                nBlockYSize = (int)chunksize[nZDim - 2];
+            nBlockXSize = (int)chunksize[nBandXPos];
+            if( nBandYPos >= 0 )
+                nBlockYSize = (int)chunksize[nBandYPos];
             else
                 nBlockYSize = 1;
+
+            SetChunkCacheSize(chunksize);
         }
     }
 #endif
@@ -625,6 +641,77 @@ void netCDFRasterBand::SetBlockSize()
     }
 }
 
+#ifdef NETCDF_HAS_NC4
+/************************************************************************/
+/*                         SetChunkCacheSize()                          */
+/************************************************************************/
+
+// Sets the size of the HDF5 chunk cache of the variable, from the
+// CHUNK_CACHE_SIZE open option, or by default so that it can hold a row of
+// chunks. Otherwise, when a chunk spans several bands (levels), or reading
+// pixel interleaved through several bands, the same chunk is inflated again
+// for each band.
+
+void netCDFRasterBand::SetChunkCacheSize( const size_t* panChunkSize )
+{
+    size_t nCacheSize = 0;
+    size_t nCacheNElems = 0;
+    float fPreemption = 0.0f;
+    if( nc_get_var_chunk_cache(cdfid, nZId, &nCacheSize, &nCacheNElems,
+                               &fPreemption) != NC_NOERR )
+        return;
+
+    const char* pszCacheSize =
+        CSLFetchNameValue(poDS->GetOpenOptions(), "CHUNK_CACHE_SIZE");
+    double dfChunkSize = GDALGetDataTypeSizeBytes(eDataType);
+    for( int i = 0; i < nZDim; i++ )
+        dfChunkSize *= static_cast<double>(panChunkSize[i]);
+    if( dfChunkSize <= 0 )
+        return;
+
+    double dfNewCacheSize = 0;
+    if( pszCacheSize != nullptr )
+    {
+        dfNewCacheSize = CPLAtof(pszCacheSize);
+    }
+    else
+    {
+        // Holding the decompressed chunks twice (in the chunk cache and in
+        // the block cache) is not wished beyond the size of the block cache.
+        dfNewCacheSize = std::min(
+            dfChunkSize * DIV_ROUND_UP(nRasterXSize, nBlockXSize),
+            static_cast<double>(GDALGetCacheMax64()));
+        if( dfNewCacheSize <= static_cast<double>(nCacheSize) )
+            return;
+    }
+    if( dfNewCacheSize < 0 ||
+        dfNewCacheSize > static_cast<double>(
+            std::numeric_limits<size_t>::max() / 2) )
+    {
+        if( pszCacheSize != nullptr )
+        {
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "Invalid value for CHUNK_CACHE_SIZE: %s", pszCacheSize);
+        }
+        return;
+    }
+
+    // The number of slots of the hash table should be (much) larger than
+    // the number of chunks in the cache.
+    const size_t nNewCacheSize = static_cast<size_t>(dfNewCacheSize);
+    const size_t nNewCacheNElems = std::max(nCacheNElems,
+        static_cast<size_t>(dfNewCacheSize / dfChunkSize) * 10 + 1);
+    CPLDebug("GDAL_netCDF",
+             "Setting chunk cache size of variable %d to " CPL_FRMT_GUIB
+             " bytes, " CPL_FRMT_GUIB " slots",
+             nZId, static_cast<GUIntBig>(nNewCacheSize),
+             static_cast<GUIntBig>(nNewCacheNElems));
+    int status = nc_set_var_chunk_cache(cdfid, nZId, nNewCacheSize,
+                                        nNewCacheNElems, fPreemption);
+    NCDF_ERR(status);
+}
+#endif
+
 // Constructor in create mode.
 // If nZId and following variables are not passed, the band will have 2
 // dimensions.
@@ -1512,6 +1599,48 @@ CPLErr netCDFRasterBand::CreateBandMetadata( const int *paDimIds,
     return CE_None;
 }
 
+/************************************************************************/
+/*                           CheckValidData()                           */
+/************************************************************************/
+
+// Sets to nodata the NaN values (if bCheckIsNan) and the values outside of
+// the valid range of the nXSize x nYSize buffer, of nLineStride elements per
+// line.
+template <class T>
+void netCDFRasterBand::CheckValidData( T *ptrImage,
+                                       size_t nXSize, size_t nYSize,
+                                       size_t nLineStride, bool bCheckIsNan )
+{
+    for( size_t j = 0; j < nYSize; j++ )
+    {
+        // k moves along the gdal block, skipping the out-of-range pixels.
+        size_t k = j * nLineStride;
+        for( size_t i = 0; i < nXSize; i++, k++ )
+        {
+            // Check for nodata and nan.
+            if( CPLIsEqual((double) ptrImage[k], dfNoDataValue) )
+                continue;
+            if( bCheckIsNan && CPLIsNan((double) ptrImage[k]) )
+            {
+                ptrImage[k] = (T)dfNoDataValue;
+                continue;
+            }
+            // Check for valid_range.
+            if( bValidRangeValid )
+            {
+                if( ((adfValidRange[0] != dfNoDataValue) &&
+                    (ptrImage[k] < (T)adfValidRange[0]))
+                    ||
+                    ((adfValidRange[1] != dfNoDataValue) &&
+                    (ptrImage[k] > (T)adfValidRange[1])) )
+                {
+                    ptrImage[k] = (T)dfNoDataValue;
+                }
+            }
+        }
+    }
+}
+
 /************************************************************************/
 /*                             CheckData()                              */
 /************************************************************************/
@@ -1541,35 +1670,8 @@ void netCDFRasterBand::CheckData( void *pImage, void *pImageNC,
     if( bValidRangeValid ||
         bCheckIsNan )
     {
-        T *ptrImage = static_cast<T*>(pImage);
-        for( size_t j = 0; j < nTmpBlockYSize; j++ )
-        {
-            // k moves along the gdal block, skipping the out-of-range pixels.
-            size_t k = j * nBlockXSize;
-            for( size_t i = 0; i < nTmpBlockXSize; i++, k++ )
-            {
-                // Check for nodata and nan.
-                if( CPLIsEqual((double) ptrImage[k], dfNoDataValue) )
-                    continue;
-                if( bCheckIsNan && CPLIsNan((double) ptrImage[k]) )
-                {
-                    ptrImage[k] = (T)dfNoDataValue;
-                    continue;
-                }
-                // Check for valid_range.
-                if( bValidRangeValid )
-                {
-                    if( ((adfValidRange[0] != dfNoDataValue) &&
-                        (ptrImage[k] < (T)adfValidRange[0]))
-                        ||
-                        ((adfValidRange[1] != dfNoDataValue) &&
-                        (ptrImage[k] > (T)adfValidRange[1])) )
-                    {
-                        ptrImage[k] = (T)dfNoDataValue;
-                    }
-                }
-            }
-        }
+        CheckValidData(static_cast<T*>(pImage), nTmpBlockXSize,
+                       nTmpBlockYSize, nBlockXSize, bCheckIsNan);
     }
 
     // If minimum longitude is > 180, subtract 360 from all.
@@ -1918,6 +2020,230 @@ CPLErr netCDFRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
     return CE_None;
 }
 
+/************************************************************************/
+/*                        CanReadLevelsAtOnce()                         */
+/************************************************************************/
+
+// Whether ReadLevels() can be used: the variable must be a (z, y, x) cube,
+// with the level of the band as z.
+bool netCDFRasterBand::CanReadLevelsAtOnce() const
+{
+    return nZDim == 3 && nBandXPos == 2 && nBandYPos == 1 &&
+           panBandZPos != nullptr && panBandZPos[0] == 0 &&
+           !bCheckLongitude && !GDALDataTypeIsComplex(eDataType);
+}
+
+/************************************************************************/
+/*                             ReadLevels()                             */
+/************************************************************************/
+
+// Reads the window of nLevels consecutive levels, starting with the one of
+// this band, with a single nc_get_vara() call, into a pixel packed, band
+// sequential buffer of the data type of the band, with the same checks as
+// in IReadBlock(). The bands of these levels must have the same nodata and
+// valid range as this one.
+CPLErr netCDFRasterBand::ReadLevels( int nXOff, int nYOff,
+                                     int nXSize, int nYSize,
+                                     int nLevels, void* pBuffer )
+{
+    CPLMutexHolderD(&hNCMutex);
+
+    const bool bBottomUp = static_cast<netCDFDataset *>(poDS)->bBottomUp;
+    size_t start[3] = { static_cast<size_t>(nLevel),
+                        static_cast<size_t>(bBottomUp ?
+                            nRasterYSize - nYOff - nYSize : nYOff),
+                        static_cast<size_t>(nXOff) };
+    size_t edge[3] = { static_cast<size_t>(nLevels),
+                       static_cast<size_t>(nYSize),
+                       static_cast<size_t>(nXSize) };
+
+    // Make sure we are in data mode.
+    static_cast<netCDFDataset *>(poDS)->SetDefineMode(false);
+
+    const size_t nValues = static_cast<size_t>(nLevels) * nXSize * nYSize;
+    int status = NC_EBADTYPE;
+    if( eDataType == GDT_Byte )
+    {
+        if( bSignedData )
+        {
+            status = nc_get_vara_schar(cdfid, nZId, start, edge,
+                                       static_cast<signed char *>(pBuffer));
+            if( status == NC_NOERR && bValidRangeValid )
+                CheckValidData(static_cast<signed char *>(pBuffer), nValues,
+                               1, nValues, false);
+        }
+        else
+        {
+            status = nc_get_vara_uchar(cdfid, nZId, start, edge,
+                                       static_cast<unsigned char *>(pBuffer));
+            if( status == NC_NOERR && bValidRangeValid )
+                CheckValidData(static_cast<unsigned char *>(pBuffer),
+                               nValues, 1, nValues, false);
+        }
+    }
+    else if( eDataType == GDT_Int16 )
+    {
+        status = nc_get_vara_short(cdfid, nZId, start, edge,
+                                   static_cast<short *>(pBuffer));
+        if( status == NC_NOERR && bValidRangeValid )
+            CheckValidData(static_cast<short *>(pBuffer), nValues, 1,
+                           nValues, false);
+    }
+    else if( eDataType == GDT_Int32 )
+    {
+#if SIZEOF_UNSIGNED_LONG == 4
+        status = nc_get_vara_long(cdfid, nZId, start, edge,
+                                  static_cast<long *>(pBuffer));
+        if( status == NC_NOERR && bValidRangeValid )
+            CheckValidData(static_cast<long *>(pBuffer), nValues, 1,
+                           nValues, false);
+#else
+        status = nc_get_vara_int(cdfid, nZId, start, edge,
+                                 static_cast<int *>(pBuffer));
+        if( status == NC_NOERR && bValidRangeValid )
+            CheckValidData(static_cast<int *>(pBuffer), nValues, 1,
+                           nValues, false);
+#endif
+    }
+    else if( eDataType == GDT_Float32 )
+    {
+        status = nc_get_vara_float(cdfid, nZId, start, edge,
+                                   static_cast<float *>(pBuffer));
+        if( status == NC_NOERR )
+            CheckValidData(static_cast<float *>(pBuffer), nValues, 1,
+                           nValues, true);
+    }
+    else if( eDataType == GDT_Float64 )
+    {
+        status = nc_get_vara_double(cdfid, nZId, start, edge,
+                                    static_cast<double *>(pBuffer));
+        if( status == NC_NOERR )
+            CheckValidData(static_cast<double *>(pBuffer), nValues, 1,
+                           nValues, true);
+    }
+#ifdef NETCDF_HAS_NC4
+    else if( eDataType == GDT_UInt16 )
+    {
+        status = nc_get_vara_ushort(cdfid, nZId, start, edge,
+                                    static_cast<unsigned short *>(pBuffer));
+        if( status == NC_NOERR && bValidRangeValid )
+            CheckValidData(static_cast<unsigned short *>(pBuffer), nValues,
+                           1, nValues, false);
+    }
+    else if( eDataType == GDT_UInt32 )
+    {
+        status = nc_get_vara_uint(cdfid, nZId, start, edge,
+                                  static_cast<unsigned int *>(pBuffer));
+        if( status == NC_NOERR && bValidRangeValid )
+            CheckValidData(static_cast<unsigned int *>(pBuffer), nValues,
+                           1, nValues, false);
+    }
+#endif
+
+    if( status != NC_NOERR )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "netCDF levels fetch failed: #%d (%s)", status,
+                 nc_strerror(status));
+        return CE_Failure;
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+// Requests on consecutive levels of a (z, y, x) variable, typically the
+// extraction of time series, are read with one nc_get_vara() call for
+// several bands, instead of one call per band and block.
+CPLErr netCDFDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                 int nXOff, int nYOff, int nXSize, int nYSize,
+                                 void * pData, int nBufXSize, int nBufYSize,
+                                 GDALDataType eBufType,
+                                 int nBandCount, int *panBandMap,
+                                 GSpacing nPixelSpace, GSpacing nLineSpace,
+                                 GSpacing nBandSpace,
+                                 GDALRasterIOExtraArg* psExtraArg )
+{
+    netCDFRasterBand* poFirstBand = nBandCount > 1 ?
+        cpl::down_cast<netCDFRasterBand *>(GetRasterBand(panBandMap[0])) :
+        nullptr;
+    bool bCanReadLevels =
+        eRWFlag == GF_Read && eAccess == GA_ReadOnly &&
+        nXSize == nBufXSize && nYSize == nBufYSize &&
+        poFirstBand != nullptr && poFirstBand->CanReadLevelsAtOnce();
+    for( int i = 1; bCanReadLevels && i < nBandCount; i++ )
+    {
+        netCDFRasterBand* poBand =
+            cpl::down_cast<netCDFRasterBand *>(GetRasterBand(panBandMap[i]));
+        bCanReadLevels =
+            poBand->cdfid == poFirstBand->cdfid &&
+            poBand->nZId == poFirstBand->nZId &&
+            poBand->nLevel == poFirstBand->nLevel + i &&
+            poBand->eDataType == poFirstBand->eDataType &&
+            poBand->CanReadLevelsAtOnce();
+    }
+    if( !bCanReadLevels )
+    {
+        return GDALPamDataset::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                          pData, nBufXSize, nBufYSize,
+                                          eBufType, nBandCount, panBandMap,
+                                          nPixelSpace, nLineSpace, nBandSpace,
+                                          psExtraArg );
+    }
+
+    // Read by batches of levels, to limit the size of the temporary buffer.
+    const GDALDataType eDT = poFirstBand->GetRasterDataType();
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+    const size_t nBandSize = static_cast<size_t>(nXSize) * nYSize * nDTSize;
+    const int nLevelsPerBatch = static_cast<int>(
+        std::max(static_cast<size_t>(1),
+                 std::min(static_cast<size_t>(nBandCount),
+                          static_cast<size_t>(64 * 1024 * 1024) / nBandSize)));
+    GByte* pabyBuffer = static_cast<GByte*>(
+        VSI_MALLOC2_VERBOSE(nLevelsPerBatch, nBandSize));
+    if( pabyBuffer == nullptr )
+        return CE_Failure;
+
+    CPLErr eErr = CE_None;
+    for( int iBand = 0; eErr == CE_None && iBand < nBandCount;
+         iBand += nLevelsPerBatch )
+    {
+        const int nLevels = std::min(nLevelsPerBatch, nBandCount - iBand);
+        netCDFRasterBand* poBand = cpl::down_cast<netCDFRasterBand *>(
+            GetRasterBand(panBandMap[iBand]));
+        eErr = poBand->ReadLevels(nXOff, nYOff, nXSize, nYSize,
+                                  nLevels, pabyBuffer);
+        for( int k = 0; eErr == CE_None && k < nLevels; k++ )
+        {
+            for( int j = 0; j < nYSize; j++ )
+            {
+                const int nSrcLine = bBottomUp ? nYSize - 1 - j : j;
+                GDALCopyWords(
+                    pabyBuffer + k * nBandSize +
+                        static_cast<size_t>(nSrcLine) * nXSize * nDTSize,
+                    eDT, nDTSize,
+                    static_cast<GByte*>(pData) + (iBand + k) * nBandSpace +
+                        j * nLineSpace,
+                    eBufType, static_cast<int>(nPixelSpace), nXSize);
+            }
+        }
+        if( eErr == CE_None && psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress(
+                static_cast<double>(iBand + nLevels) / nBandCount, "",
+                psExtraArg->pProgressData) )
+        {
+            CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+            eErr = CE_Failure;
+        }
+    }
+
+    CPLFree(pabyBuffer);
+    return eErr;
+}
+
 /************************************************************************/
 /*                             IWriteBlock()                            */
 /************************************************************************/
@@ -8731,6 +9057,11 @@ void GDALRegister_netCDF()
 "   <Option name='HONOUR_VALID_RANGE' type='boolean' "
     "description='Whether to set to nodata pixel values outside of the "
     "validity range' default='YES'/>"
+#ifdef NETCDF_HAS_NC4
+"   <Option name='CHUNK_CACHE_SIZE' type='int' "
+    "description='Size in bytes of the HDF5 chunk cache of each variable "
+    "(netCDF-4 files)'/>"
+#endif
 "</OpenOptionList>" );
 
 
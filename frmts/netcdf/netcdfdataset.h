@@ -920,6 +920,15 @@ class netCDFDataset final: public GDALPamDataset
 
     virtual int  TestCapability(const char* pszCap) override;
 
+    virtual CPLErr IRasterIO( GDALRWFlag eRWFlag,
+                              int nXOff, int nYOff, int nXSize, int nYSize,
+                              void * pData, int nBufXSize, int nBufYSize,
+                              GDALDataType eBufType,
+                              int nBandCount, int *panBandMap,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GSpacing nBandSpace,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
+
     virtual int  GetLayerCount() override { return nLayers; }
     virtual OGRLayer* GetLayer(int nIdx) override;
 
@@ -54,6 +54,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_frmts.h"
 #include "gdal_priv.h"
@@ -101,7 +102,9 @@ NITFDataset::NITFDataset() :
     pszGCPProjection(nullptr),
     panJPEGBlockOffset(nullptr),
     pabyJPEGBlock(nullptr),
+    iJPEGBlockCached(-1),
     nQLevel(0),
+    nJPEGDecodeThreads(0),
     nIMIndex(0),
     papszTextMDToWrite(nullptr),
     papszCgmMDToWrite(nullptr),
@@ -595,6 +598,9 @@ GDALDataset *NITFDataset::OpenInternal( GDALOpenInfo * poOpenInfo,
     poDS->osNITFFilename = pszFilename;
     poDS->nIMIndex = nIMIndex;
 
+    if( CPLGetConfigOption("GDAL_NUM_THREADS", nullptr) != nullptr )
+        poDS->nJPEGDecodeThreads = CPLGetNumThreads();
+
     if( psImage )
     {
         if (psImage->nCols <= 0 || psImage->nRows <= 0 ||
@@ -2048,8 +2054,11 @@ CPLErr NITFDataset::IRasterIO( GDALRWFlag eRWFlag,
                                         pData, nBufXSize, nBufYSize, eBufType,
                                         nBandCount, panBandMap,
                                         nPixelSpace, nLineSpace, nBandSpace, psExtraArg );
-    else
-        return GDALDataset::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+        PrefetchJPEGBlocks( nXOff, nYOff, nXSize, nYSize );
+
+    return GDALDataset::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
                                        pData, nBufXSize, nBufYSize, eBufType,
                                        nBandCount, panBandMap,
                                        nPixelSpace, nLineSpace, nBandSpace, psExtraArg );
@@ -3569,8 +3578,48 @@ CPLErr NITFDataset::ScanJPEGBlocks()
 CPLErr NITFDataset::ReadJPEGBlock( int iBlockX, int iBlockY )
 
 {
-    CPLErr eErr;
+    CPLErr eErr = InitJPEGBlockOffsets();
+    if( eErr != CE_None )
+        return eErr;
+
+/* -------------------------------------------------------------------- */
+/*    Allocate image data block (where the uncompressed image will go)  */
+/* -------------------------------------------------------------------- */
+    if( pabyJPEGBlock == nullptr )
+    {
+        /* Allocate enough memory to hold 12bit JPEG data */
+        pabyJPEGBlock = reinterpret_cast<GByte *>(
+            VSI_CALLOC_VERBOSE(psImage->nBands,
+                      psImage->nBlockWidth * psImage->nBlockHeight * 2) );
+        if (pabyJPEGBlock == nullptr)
+        {
+            return CE_Failure;
+        }
+    }
 
+/* -------------------------------------------------------------------- */
+/*      The block is decoded for all bands at once, so that the other  */
+/*      bands of the block do not need to decode it again.             */
+/* -------------------------------------------------------------------- */
+    const int iBlock = iBlockX + iBlockY * psImage->nBlocksPerRow;
+    if( iBlock == iJPEGBlockCached )
+        return CE_None;
+
+    iJPEGBlockCached = -1;
+    eErr = DecodeJPEGBlock( iBlock, pabyJPEGBlock );
+    if( eErr == CE_None )
+        iJPEGBlockCached = iBlock;
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                        InitJPEGBlockOffsets()                        */
+/************************************************************************/
+
+CPLErr NITFDataset::InitJPEGBlockOffsets()
+
+{
 /* -------------------------------------------------------------------- */
 /*      If this is our first request, do a scan for block boundaries.   */
 /* -------------------------------------------------------------------- */
@@ -3614,35 +3663,31 @@ CPLErr NITFDataset::ReadJPEGBlock( int iBlockX, int iBlockY )
 /*      Scan through the whole image data stream identifying all        */
 /*      block boundaries.                                               */
 /* -------------------------------------------------------------------- */
-            eErr = ScanJPEGBlocks();
+            const CPLErr eErr = ScanJPEGBlocks();
             if( eErr != CE_None )
                 return eErr;
         }
     }
 
-/* -------------------------------------------------------------------- */
-/*    Allocate image data block (where the uncompressed image will go)  */
-/* -------------------------------------------------------------------- */
-    if( pabyJPEGBlock == nullptr )
-    {
-        /* Allocate enough memory to hold 12bit JPEG data */
-        pabyJPEGBlock = reinterpret_cast<GByte *>(
-            VSI_CALLOC_VERBOSE(psImage->nBands,
-                      psImage->nBlockWidth * psImage->nBlockHeight * 2) );
-        if (pabyJPEGBlock == nullptr)
-        {
-            return CE_Failure;
-        }
-    }
+    return CE_None;
+}
 
-/* -------------------------------------------------------------------- */
-/*      Read JPEG Chunk.                                                */
-/* -------------------------------------------------------------------- */
-    const int iBlock = iBlockX + iBlockY * psImage->nBlocksPerRow;
+/************************************************************************/
+/*                          DecodeJPEGBlock()                           */
+/*                                                                      */
+/*      Decode a block for all bands into pabyDst. Only uses            */
+/*      members that do not change once the block offsets are known,    */
+/*      so that several blocks can be decoded at the same time.         */
+/************************************************************************/
+
+CPLErr NITFDataset::DecodeJPEGBlock( int iBlock, GByte *pabyDst )
 
+{
     if (panJPEGBlockOffset[iBlock] == -1 || panJPEGBlockOffset[iBlock] == UINT_MAX)
     {
-        memset(pabyJPEGBlock, 0, psImage->nBands*psImage->nBlockWidth*psImage->nBlockHeight*2);
+        memset(pabyDst, 0,
+               psImage->nBands * psImage->nBlockWidth * psImage->nBlockHeight *
+               GDALGetDataTypeSizeBytes(GetRasterBand(1)->GetRasterDataType()));
         return CE_None;
     }
 
@@ -3687,19 +3732,161 @@ CPLErr NITFDataset::ReadJPEGBlock( int iBlockX, int iBlockY )
     }
 
     int anBands[3] = { 1, 2, 3 };
-    eErr = poDS->RasterIO( GF_Read,
-                           0, 0,
-                           psImage->nBlockWidth, psImage->nBlockHeight,
-                           pabyJPEGBlock,
-                           psImage->nBlockWidth, psImage->nBlockHeight,
-                           GetRasterBand(1)->GetRasterDataType(), psImage->nBands, anBands,
-                           0, 0, 0, nullptr );
+    const CPLErr eErr =
+        poDS->RasterIO( GF_Read,
+                        0, 0,
+                        psImage->nBlockWidth, psImage->nBlockHeight,
+                        pabyDst,
+                        psImage->nBlockWidth, psImage->nBlockHeight,
+                        GetRasterBand(1)->GetRasterDataType(), psImage->nBands, anBands,
+                        0, 0, 0, nullptr );
 
     delete poDS;
 
     return eErr;
 }
 
+/************************************************************************/
+/*                         DecodeJPEGBlockJob()                         */
+/************************************************************************/
+
+namespace {
+struct NITFJPEGDecodeJob
+{
+    NITFDataset *poDS;
+    int          iBlock;
+    GByte       *pabyDst;
+    bool         bSuccess;
+};
+}
+
+void NITFDataset::DecodeJPEGBlockJob( void *pData )
+
+{
+    NITFJPEGDecodeJob *psJob = static_cast<NITFJPEGDecodeJob *>(pData);
+    // Errors are reported when IReadBlock() retries the block.
+    CPLErrorHandlerPusher oQuiet(CPLQuietErrorHandler);
+    psJob->bSuccess =
+        psJob->poDS->DecodeJPEGBlock(psJob->iBlock, psJob->pabyDst) == CE_None;
+}
+
+/************************************************************************/
+/*                         PrefetchJPEGBlocks()                         */
+/*                                                                      */
+/*      Decode in parallel the JPEG blocks intersecting the requested   */
+/*      window that are not yet in the block cache, and push them       */
+/*      into it for all bands, so that the following generic            */
+/*      RasterIO() only has to fetch them from there.                   */
+/************************************************************************/
+
+void NITFDataset::PrefetchJPEGBlocks( int nXOff, int nYOff,
+                                      int nXSize, int nYSize )
+
+{
+    if( nJPEGDecodeThreads <= 1 || psImage == nullptr || nBands == 0 ||
+        !(EQUAL(psImage->szIC, "C3") || EQUAL(psImage->szIC, "M3")) )
+        return;
+
+    // Bands are NITFRasterBand when there is no underlying JPEG dataset.
+    NITFRasterBand *poFirstBand =
+        static_cast<NITFRasterBand *>(GetRasterBand(1));
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poFirstBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    const GIntBig nBlocks = static_cast<GIntBig>(nBlockX2 - nBlockX1 + 1) *
+                            (nBlockY2 - nBlockY1 + 1);
+    if( nBlocks < 2 )
+        return;
+
+    // The decoded blocks must all fit in the block cache, otherwise the
+    // first ones would be evicted before being used.
+    const int nBlockBandSize =
+        nBlockXSize * nBlockYSize *
+        GDALGetDataTypeSizeBytes(poFirstBand->GetRasterDataType());
+    const int nBlockBytes = nBlockBandSize * psImage->nBands;
+    if( nBlocks * nBlockBytes > GDALGetCacheMax64() / 2 )
+    {
+        CPLDebug("NITF", "Block prefetching skipped: "
+                 "block cache not big enough");
+        return;
+    }
+
+    if( InitJPEGBlockOffsets() != CE_None )
+        return;
+
+    std::vector<int> anXBlock;
+    std::vector<int> anYBlock;
+    for( int iY = nBlockY1; iY <= nBlockY2; iY++ )
+    {
+        for( int iX = nBlockX1; iX <= nBlockX2; iX++ )
+        {
+            GDALRasterBlock *poBlock = poFirstBand->TryGetLockedBlockRef(iX, iY);
+            if( poBlock != nullptr )
+            {
+                poBlock->DropLock();
+                continue;
+            }
+            anXBlock.push_back(iX);
+            anYBlock.push_back(iY);
+        }
+    }
+    const int nBlocksToRead = static_cast<int>(anXBlock.size());
+    if( nBlocksToRead < 2 )
+        return;
+
+    CPLWorkerThreadPool *poPool =
+        CPLGetGlobalWorkerThreadPool(nJPEGDecodeThreads);
+    std::unique_ptr<CPLJobQueue> poQueue(
+        poPool ? poPool->CreateJobQueue() : nullptr);
+    if( poQueue == nullptr )
+        return;
+
+    GByte *pabyBuffer = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nBlocksToRead, nBlockBytes));
+    if( pabyBuffer == nullptr )
+        return;
+
+    std::vector<NITFJPEGDecodeJob> asJobs(nBlocksToRead);
+    for( int i = 0; i < nBlocksToRead; i++ )
+    {
+        asJobs[i].poDS = this;
+        asJobs[i].iBlock = anXBlock[i] + anYBlock[i] * psImage->nBlocksPerRow;
+        asJobs[i].pabyDst = pabyBuffer + static_cast<size_t>(i) * nBlockBytes;
+        asJobs[i].bSuccess = false;
+        if( !poQueue->SubmitJob(DecodeJPEGBlockJob, &asJobs[i]) )
+            DecodeJPEGBlockJob(&asJobs[i]);
+        // Do not let more jobs than requested threads run at once.
+        poQueue->WaitCompletion(nJPEGDecodeThreads);
+    }
+    poQueue->WaitCompletion();
+
+    // Blocks that could not be decoded are left to IReadBlock(), which
+    // will emit the appropriate error.
+    for( int i = 0; i < nBlocksToRead; i++ )
+    {
+        if( !asJobs[i].bSuccess )
+            continue;
+        for( int iBand = 0; iBand < nBands; iBand++ )
+        {
+            GDALRasterBlock *poBlock =
+                GetRasterBand(iBand + 1)->GetLockedBlockRef(
+                    anXBlock[i], anYBlock[i], TRUE);
+            if( poBlock == nullptr )
+                continue;
+            memcpy(poBlock->GetDataRef(),
+                   asJobs[i].pabyDst + static_cast<size_t>(iBand) * nBlockBandSize,
+                   nBlockBandSize);
+            poBlock->DropLock();
+        }
+    }
+
+    VSIFree(pabyBuffer);
+}
+
 /************************************************************************/
 /*                            GetFileList()                             */
 /************************************************************************/
@@ -6152,6 +6339,7 @@ void GDALRegister_NITF()
 
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "frmt_nitf.html" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "ntf" );
+    poDriver->SetMetadataItem( GDAL_DMD_SIGNATURES, "4E495446 4E534946" );
     poDriver->SetMetadataItem( GDAL_DMD_SUBDATASETS, "YES" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
                                "Byte UInt16 Int16 UInt32 Int32 Float32" );
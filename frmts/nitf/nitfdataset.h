@@ -98,11 +98,18 @@ class NITFDataset final: public GDALPamDataset
 
     GIntBig     *panJPEGBlockOffset;
     GByte       *pabyJPEGBlock;
+    int          iJPEGBlockCached;  // Index of the block in pabyJPEGBlock.
     int          nQLevel;
+    int          nJPEGDecodeThreads;
 
     int          ScanJPEGQLevel( GUIntBig *pnDataStart, bool *pbError );
     CPLErr       ScanJPEGBlocks();
+    CPLErr       InitJPEGBlockOffsets();
+    CPLErr       DecodeJPEGBlock( int iBlock, GByte *pabyDst );
+    static void  DecodeJPEGBlockJob( void *pData );
     CPLErr       ReadJPEGBlock( int, int );
+    void         PrefetchJPEGBlocks( int nXOff, int nYOff,
+                                     int nXSize, int nYSize );
     void         CheckGeoSDEInfo();
     char**       AddFile(char **papszFileList, const char* EXTENSION, const char* extension);
 
@@ -215,6 +222,10 @@ class NITFRasterBand final: public GDALPamRasterBand
 
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
 
     virtual GDALColorInterp GetColorInterpretation() override;
     virtual CPLErr SetColorInterpretation( GDALColorInterp ) override;
@@ -491,6 +491,29 @@ NITFRasterBand::~NITFRasterBand()
     VSIFree(pUnpackData);
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr NITFRasterBand::IRasterIO( GDALRWFlag eRWFlag,
+                                  int nXOff, int nYOff, int nXSize, int nYSize,
+                                  void *pData, int nBufXSize, int nBufYSize,
+                                  GDALDataType eBufType,
+                                  GSpacing nPixelSpace, GSpacing nLineSpace,
+                                  GDALRasterIOExtraArg *psExtraArg )
+
+{
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+    {
+        NITFDataset *poGDS = reinterpret_cast<NITFDataset *>( poDS );
+        poGDS->PrefetchJPEGBlocks( nXOff, nYOff, nXSize, nYSize );
+    }
+
+    return GDALPamRasterBand::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                         pData, nBufXSize, nBufYSize, eBufType,
+                                         nPixelSpace, nLineSpace, psExtraArg );
+}
+
 /************************************************************************/
 /*                             IReadBlock()                             */
 /************************************************************************/
@@ -58,6 +58,10 @@
 #include "cpl_vsi.h"
 #include "nitflib.h"
 
+#include <map>
+#include <memory>
+#include <set>
+
 CPL_CVSID("$Id: rpftocfile.cpp e84a845def3054cbbe4b8de95ad4576c0d6f630c 2018-03-17 11:38:24Z Even Rouault $")
 
 /************************************************************************/
@@ -113,6 +117,62 @@ RPFToc* RPFTOCRead(const char* pszFilename, NITFFile* psFile)
     return  RPFTOCReadFromBuffer(pszFilename, psFile->fp, pachTRE);
 }
 
+/************************************************************************/
+/*                          RPFTOCDirCache                              */
+/*                                                                      */
+/*      A TOC references thousands of frames spread over a few          */
+/*      directories. Listing each directory once is much cheaper than   */
+/*      a stat() per frame, in particular on network file systems.     */
+/*      A name missing from a listing still goes through VSIStatL(),   */
+/*      so that the result is the same as without the cache.           */
+/************************************************************************/
+
+namespace {
+class RPFTOCDirCache
+{
+    std::map<CPLString, bool> oMapDirExists{};
+    std::map<CPLString, std::unique_ptr<std::set<CPLString>>> oMapDirContent{};
+
+  public:
+    bool DirExists( const char* pszDir )
+    {
+        auto oIter = oMapDirExists.find(pszDir);
+        if( oIter != oMapDirExists.end() )
+            return oIter->second;
+        VSIStatBufL sStatBuf;
+        const bool bExists = VSIStatL(pszDir, &sStatBuf) == 0;
+        oMapDirExists[pszDir] = bExists;
+        return bExists;
+    }
+
+    bool FileExists( const char* pszFilename )
+    {
+        const CPLString osDir(CPLGetPath(pszFilename));
+        auto oIter = oMapDirContent.find(osDir);
+        if( oIter == oMapDirContent.end() )
+        {
+            std::unique_ptr<std::set<CPLString>> poContent;
+            char** papszContent = VSIReadDir(osDir);
+            if( papszContent != nullptr )
+            {
+                poContent.reset(new std::set<CPLString>());
+                for( char** papszIter = papszContent; *papszIter; ++papszIter )
+                    poContent->insert(*papszIter);
+                CSLDestroy(papszContent);
+            }
+            oIter = oMapDirContent.insert(
+                std::make_pair(osDir, std::move(poContent))).first;
+        }
+        if( oIter->second != nullptr &&
+            oIter->second->find(CPLGetFilename(pszFilename)) !=
+                                                    oIter->second->end() )
+            return true;
+        VSIStatBufL sStatBuf;
+        return VSIStatL(pszFilename, &sStatBuf) == 0;
+    }
+};
+}
+
 /* This function is directly inspired by function parse_toc coming from ogdi/driver/rpf/utils.c */
 
 RPFToc* RPFTOCReadFromBuffer(const char* pszFilename, VSILFILE* fp, const char* tocHeader)
@@ -403,6 +463,7 @@ RPFToc* RPFTOCReadFromBuffer(const char* pszFilename, VSILFILE* fp, const char*
     }
 
     int newBoundaryId = 0;
+    RPFTOCDirCache oDirCache;
 
     for( int i = 0; i < static_cast<int>( nFrameFileIndexRecords ); i++ )
     {
@@ -601,7 +662,6 @@ RPFToc* RPFTOCReadFromBuffer(const char* pszFilename, VSILFILE* fp, const char*
 
         {
             char* baseDir = CPLStrdup(CPLGetDirname(pszFilename));
-            VSIStatBufL sStatBuf;
             char* subdir = nullptr;
             if (CPLIsFilenameRelative(frameEntry->directory) == FALSE)
                 subdir = CPLStrdup(frameEntry->directory);
@@ -610,7 +670,7 @@ RPFToc* RPFTOCReadFromBuffer(const char* pszFilename, VSILFILE* fp, const char*
             else
                 subdir = CPLStrdup(CPLFormFilename(baseDir, frameEntry->directory, nullptr));
 #if !defined(_WIN32) && !defined(_WIN32_CE)
-            if( VSIStatL( subdir, &sStatBuf ) != 0 && strlen(subdir) > strlen(baseDir) && subdir[strlen(baseDir)] != 0)
+            if( !oDirCache.DirExists( subdir ) && strlen(subdir) > strlen(baseDir) && subdir[strlen(baseDir)] != 0)
             {
                 char* c = subdir + strlen(baseDir)+1;
                 while(*c)
@@ -624,7 +684,7 @@ RPFToc* RPFTOCReadFromBuffer(const char* pszFilename, VSILFILE* fp, const char*
             frameEntry->fullFilePath = CPLStrdup(CPLFormFilename(
                     subdir,
                     frameEntry->filename, nullptr));
-            if( VSIStatL( frameEntry->fullFilePath, &sStatBuf ) != 0 )
+            if( !oDirCache.FileExists( frameEntry->fullFilePath ) )
             {
 #if !defined(_WIN32) && !defined(_WIN32_CE)
                 if( strlen(frameEntry->fullFilePath) > strlen(subdir) )
@@ -637,7 +697,7 @@ RPFToc* RPFTOCReadFromBuffer(const char* pszFilename, VSILFILE* fp, const char*
                         c++;
                     }
                 }
-                if( VSIStatL( frameEntry->fullFilePath, &sStatBuf ) != 0 )
+                if( !oDirCache.FileExists( frameEntry->fullFilePath ) )
 #endif
                 {
                     frameEntry->fileExists = 0;
@@ -47,12 +47,14 @@
 #include "cpl_atomic_ops.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_frmts.h"
 #include "gdaljp2abstractdataset.h"
 #include "gdaljp2metadata.h"
 #include "vrt/vrtdataset.h"
 
 #include <algorithm>
+#include <memory>
 
 //#define DEBUG_IO
 
@@ -120,6 +122,16 @@ typedef struct
     vsi_l_offset nBaseOffset;
 } JP2OpenJPEGFile;
 
+// Codec, with its stream and image, kept by a decoding thread from one
+// tile to the next one, to avoid parsing the main header for each tile.
+typedef struct
+{
+    opj_codec_t*    pCodec;
+    opj_stream_t*   pStream;
+    opj_image_t*    psImage;
+    JP2OpenJPEGFile sJP2OpenJPEGFile;
+} JP2OpenJPEGCodecCache;
+
 /************************************************************************/
 /*                      JP2OpenJPEGDataset_Read()                       */
 /************************************************************************/
@@ -297,7 +309,8 @@ class JP2OpenJPEGDataset final: public GDALJP2AbstractDataset
 
     CPLErr      ReadBlock( int nBand, VSILFILE* fp,
                            int nBlockXOff, int nBlockYOff, void * pImage,
-                           int nBandCount, int *panBandMap );
+                           int nBandCount, int *panBandMap,
+                           JP2OpenJPEGCodecCache* psCodecCache = nullptr );
 
     int         PreloadBlocks( JP2OpenJPEGRasterBand* poBand,
                                int nXOff, int nYOff, int nXSize, int nYSize,
@@ -486,15 +499,7 @@ int JP2OpenJPEGDataset::GetNumThreads()
     if( nThreads >= 1 )
         return nThreads;
 
-    const char* pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "ALL_CPUS");
-    if (EQUAL(pszThreads, "ALL_CPUS"))
-        nThreads = CPLGetNumCPUs();
-    else
-        nThreads = atoi(pszThreads);
-    if (nThreads > 128)
-        nThreads = 128;
-    if (nThreads <= 0)
-        nThreads = 1;
+    nThreads = CPLGetNumThreads(nullptr, "ALL_CPUS");
     return nThreads;
 }
 
@@ -515,6 +520,21 @@ public:
     VOLATILE_BOOL       bSuccess;
 };
 
+static void JP2OpenJPEGFreeCodecCache( JP2OpenJPEGCodecCache* psCodecCache )
+{
+    if( psCodecCache->pCodec && psCodecCache->pStream )
+        opj_end_decompress(psCodecCache->pCodec, psCodecCache->pStream);
+    if( psCodecCache->pStream )
+        opj_stream_destroy(psCodecCache->pStream);
+    if( psCodecCache->pCodec )
+        opj_destroy_codec(psCodecCache->pCodec);
+    if( psCodecCache->psImage )
+        opj_image_destroy(psCodecCache->psImage);
+    psCodecCache->pCodec = nullptr;
+    psCodecCache->pStream = nullptr;
+    psCodecCache->psImage = nullptr;
+}
+
 void JP2OpenJPEGDataset::JP2OpenJPEGReadBlockInThread(void* userdata)
 {
     int nPair;
@@ -534,6 +554,16 @@ void JP2OpenJPEGDataset::JP2OpenJPEGReadBlockInThread(void* userdata)
         return;
     }
 
+    JP2OpenJPEGCodecCache sCodecCache;
+    memset(&sCodecCache, 0, sizeof(sCodecCache));
+#if OPJ_VERSION_MAJOR > 2 || OPJ_VERSION_MINOR >= 3
+    JP2OpenJPEGCodecCache* psCodecCache =
+        CPLTestBool(CPLGetConfigOption("USE_OPENJPEG_CODEC_REUSE", "YES")) ?
+            &sCodecCache : nullptr;
+#else
+    JP2OpenJPEGCodecCache* psCodecCache = nullptr;
+#endif
+
     while( (nPair = CPLAtomicInc(&(poJob->nCurPair))) < nPairs &&
             poJob->bSuccess )
     {
@@ -551,7 +581,8 @@ void JP2OpenJPEGDataset::JP2OpenJPEGReadBlockInThread(void* userdata)
 
         void* pDstBuffer = poBlock->GetDataRef();
         if( poGDS->ReadBlock(nBand, fp, nBlockXOff, nBlockYOff, pDstBuffer,
-                             nBandCount, panBandMap) != CE_None )
+                             nBandCount, panBandMap,
+                             psCodecCache) != CE_None )
         {
             poJob->bSuccess = false;
         }
@@ -559,6 +590,7 @@ void JP2OpenJPEGDataset::JP2OpenJPEGReadBlockInThread(void* userdata)
         poBlock->DropLock();
     }
 
+    JP2OpenJPEGFreeCodecCache(&sCodecCache);
     VSIFCloseL(fp);
     //VSIFree(pDummy);
 }
@@ -614,13 +646,13 @@ int JP2OpenJPEGDataset::PreloadBlocks(JP2OpenJPEGRasterBand* poBand,
         if( m_nBlocksToLoad > 1 )
         {
             const int l_nThreads = std::min(m_nBlocksToLoad, nMaxThreads);
-            CPLJoinableThread** pahThreads = (CPLJoinableThread**) VSI_CALLOC_VERBOSE( sizeof(CPLJoinableThread*), l_nThreads );
-            if( pahThreads == nullptr )
+            CPLWorkerThreadPool* poPool =
+                CPLGetGlobalWorkerThreadPool(nMaxThreads);
+            if( poPool == nullptr )
             {
                 m_nBlocksToLoad = 0;
                 return -1;
             }
-            int i;
 
             CPLDebug("OPENJPEG", "%d blocks to load (%d threads)", m_nBlocksToLoad, l_nThreads);
 
@@ -654,17 +686,22 @@ int JP2OpenJPEGDataset::PreloadBlocks(JP2OpenJPEGRasterBand* poBand,
             /* This is a workaround to a design defect of the block cache */
             GDALRasterBlock::FlushDirtyBlocks();
 
-            for(i=0;i<l_nThreads;i++)
+            // The jobs run in the global pool, shared with the other users
+            // of GDAL_NUM_THREADS, instead of threads created for each
+            // request, and each one keeps its codec from one tile to the
+            // next one.
+            std::unique_ptr<CPLJobQueue> poQueue = poPool->CreateJobQueue();
+            int nSubmitted = 0;
+            while( nSubmitted < l_nThreads &&
+                   poQueue->SubmitJob(JP2OpenJPEGReadBlockInThread, &oJob) )
             {
-                pahThreads[i] = CPLCreateJoinableThread(JP2OpenJPEGReadBlockInThread, &oJob);
-                if( pahThreads[i] == nullptr )
-                    oJob.bSuccess = false;
+                nSubmitted++;
             }
+            if( nSubmitted == 0 )
+                oJob.bSuccess = false;
             TemporarilyDropReadWriteLock();
-            for(i=0;i<l_nThreads;i++)
-                CPLJoinThread( pahThreads[i] );
+            poQueue->WaitCompletion();
             ReacquireReadWriteLock();
-            CPLFree(pahThreads);
             if( !oJob.bSuccess )
             {
                 m_nBlocksToLoad = 0;
@@ -792,7 +829,8 @@ static opj_stream_t* JP2OpenJPEGCreateReadStream(JP2OpenJPEGFile* psJP2OpenJPEGF
 
 CPLErr JP2OpenJPEGDataset::ReadBlock( int nBand, VSILFILE* fpIn,
                                       int nBlockXOff, int nBlockYOff, void * pImage,
-                                      int nBandCount, int* panBandMap )
+                                      int nBandCount, int* panBandMap,
+                                      JP2OpenJPEGCodecCache* psCodecCache )
 {
     CPLErr          eErr = CE_None;
     opj_codec_t*    pCodec = nullptr;
@@ -841,6 +879,15 @@ CPLErr JP2OpenJPEGDataset::ReadBlock( int nBand, VSILFILE* fpIn,
     }
     *m_pnLastLevel = iLevel;
 
+    // The codec of a decoding thread is only used for tiles of this dataset,
+    // so at the same resolution level.
+    if( psCodecCache != nullptr && psCodecCache->pCodec != nullptr )
+    {
+        pCodec = psCodecCache->pCodec;
+        pStream = psCodecCache->pStream;
+        psImage = psCodecCache->psImage;
+    }
+
     if( pCodec == nullptr )
 #endif
     {
@@ -874,9 +921,12 @@ CPLErr JP2OpenJPEGDataset::ReadBlock( int nBand, VSILFILE* fpIn,
         else
 #endif
         {
-            sJP2OpenJPEGFile.fp = fpIn;
-            sJP2OpenJPEGFile.nBaseOffset = nCodeStreamStart;
-            pStream = JP2OpenJPEGCreateReadStream(&sJP2OpenJPEGFile, nCodeStreamLength);
+            // The file must outlive the stream when it is kept by the cache.
+            JP2OpenJPEGFile* psFile = psCodecCache ?
+                &psCodecCache->sJP2OpenJPEGFile : &sJP2OpenJPEGFile;
+            psFile->fp = fpIn;
+            psFile->nBaseOffset = nCodeStreamStart;
+            pStream = JP2OpenJPEGCreateReadStream(psFile, nCodeStreamLength);
         }
         if( pStream == nullptr )
         {
@@ -1121,9 +1171,22 @@ end:
         *m_ppStream = pStream;
         *m_ppsImage = psImage;
     }
+    else if( psCodecCache != nullptr && eErr == CE_None )
+    {
+        psCodecCache->pCodec = pCodec;
+        psCodecCache->pStream = pStream;
+        psCodecCache->psImage = psImage;
+    }
     else
 #endif
     {
+        // Do not leave a failed codec for the next tile.
+        if( psCodecCache != nullptr )
+        {
+            psCodecCache->pCodec = nullptr;
+            psCodecCache->pStream = nullptr;
+            psCodecCache->psImage = nullptr;
+        }
         if( pCodec && pStream )
             opj_end_decompress(pCodec,pStream);
         if( pStream )
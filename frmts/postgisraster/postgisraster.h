@@ -44,6 +44,7 @@
 #include "cpl_quad_tree.h"
 #include <float.h>
 #include <map>
+#include <vector>
 
 //#define DEBUG_VERBOSE
 //#define DEBUG_QUERY
@@ -264,6 +265,18 @@ private:
     lru11::Cache<std::string, std::shared_ptr<GDALDataset>> oOutDBDatasetCache{8,0};
     lru11::Cache<std::string, bool> oOutDBFilenameUsable{100,0};
 
+    // Additional connections used to run several tile queries at once.
+    // Owned by the main dataset, and shared with its overviews.
+    CPLString m_osConnectionString{};
+    int m_nMaxConnections;
+    std::vector<PGconn*> m_apoPoolConnections{};
+    bool m_bServerSideResampling;
+
+    PGconn* GetPoolConnection(int iConn);
+    std::vector<PGresult*> ExecConcurrently(
+                            const std::vector<CPLString>& aosCommands,
+                            std::vector<PGconn*>& apoUsedConns);
+
     GBool ConstructOneDatasetFromTiles(PGresult *);
     GBool YieldSubdatasets(PGresult *, const char *);
     GBool SetRasterProperties(const char *);
@@ -366,6 +379,13 @@ protected:
                                          GDALDataType eBufType,
                                          int nPixelSpace,
                                          int nLineSpace);
+    CPLErr                    ServerSideResampledRasterIO(int nXOff,
+                                         int nYOff, int nXSize, int nYSize,
+                                         void * pData, int nBufXSize,
+                                         int nBufYSize, GDALDataType eBufType,
+                                         GSpacing nPixelSpace,
+                                         GSpacing nLineSpace,
+                                         GDALRasterIOExtraArg* psExtraArg);
 public:
 
     PostGISRasterRasterBand( PostGISRasterDataset * poDSIn, int nBandIn,
@@ -141,7 +141,11 @@ PostGISRasterDataset::PostGISRasterDataset() :
     bBuildQuadTreeDynamically(false),
     bTilesSameDimension(false),
     nTileWidth(0),
-    nTileHeight(0)
+    nTileHeight(0),
+    m_nMaxConnections(std::max(1, std::min(32,
+        atoi(CPLGetConfigOption("PR_NUM_CONNECTIONS", "1"))))),
+    m_bServerSideResampling(CPLTestBool(
+        CPLGetConfigOption("PR_SERVER_SIDE_RESAMPLING", "NO")))
 {
 
     adfGeoTransform[GEOTRSFRM_TOPLEFT_X] = 0.0;
@@ -268,6 +272,117 @@ PostGISRasterDataset::~PostGISRasterDataset() {
         VSIFree(papoSourcesHolders);
         papoSourcesHolders = nullptr;
     }
+
+    // The main connection belongs to the driver
+    for( size_t i = 1; i < m_apoPoolConnections.size(); i++ )
+    {
+        if( m_apoPoolConnections[i] )
+            PQfinish(m_apoPoolConnections[i]);
+    }
+}
+
+/************************************************************************/
+/*                         GetPoolConnection()                          */
+/************************************************************************/
+
+/**
+ * \brief Returns the iConn-th connection of the pool, opening it if
+ * needed. The first one is the connection of the dataset. Returns
+ * nullptr if it cannot be opened.
+ **/
+PGconn* PostGISRasterDataset::GetPoolConnection(int iConn)
+{
+    if( iConn == 0 )
+        return poConn;
+    if( poParentDS != nullptr )
+        return poParentDS->GetPoolConnection(iConn);
+    if( iConn >= m_nMaxConnections || m_osConnectionString.empty() )
+        return nullptr;
+
+    if( m_apoPoolConnections.empty() )
+    {
+        m_apoPoolConnections.resize(m_nMaxConnections);
+        m_apoPoolConnections[0] = poConn;
+    }
+    if( m_apoPoolConnections[iConn] == nullptr )
+    {
+        PGconn* poNewConn = PQconnectdb(m_osConnectionString);
+        if( poNewConn == nullptr || PQstatus(poNewConn) == CONNECTION_BAD )
+        {
+            CPLDebug("PostGIS_Raster",
+                     "Cannot open additional connection: %s",
+                     poNewConn ? PQerrorMessage(poNewConn) : "");
+            PQfinish(poNewConn);
+            // Do not retry on next requests
+            m_nMaxConnections = iConn;
+            return nullptr;
+        }
+        m_apoPoolConnections[iConn] = poNewConn;
+    }
+    return m_apoPoolConnections[iConn];
+}
+
+/************************************************************************/
+/*                          ExecConcurrently()                          */
+/************************************************************************/
+
+/**
+ * \brief Runs each command on a different connection of the pool, so
+ * that the server processes them at the same time. Commands for which
+ * no connection is available are run afterwards on the main
+ * connection. apoUsedConns receives the connection of each command,
+ * for error reporting.
+ **/
+std::vector<PGresult*> PostGISRasterDataset::ExecConcurrently(
+                                const std::vector<CPLString>& aosCommands,
+                                std::vector<PGconn*>& apoUsedConns)
+{
+    const size_t nCommands = aosCommands.size();
+    std::vector<PGresult*> apoResults(nCommands, nullptr);
+    apoUsedConns.assign(nCommands, nullptr);
+    if( nCommands == 1 )
+    {
+        apoUsedConns[0] = poConn;
+        apoResults[0] = PQexec(poConn, aosCommands[0].c_str());
+        return apoResults;
+    }
+
+    for( size_t i = 1; i < nCommands; i++ )
+    {
+        PGconn* poPoolConn = GetPoolConnection(static_cast<int>(i));
+        if( poPoolConn != nullptr &&
+            PQsendQuery(poPoolConn, aosCommands[i].c_str()) )
+        {
+            apoUsedConns[i] = poPoolConn;
+        }
+    }
+
+    // While the other queries are processed
+    apoUsedConns[0] = poConn;
+    apoResults[0] = PQexec(poConn, aosCommands[0].c_str());
+
+    for( size_t i = 1; i < nCommands; i++ )
+    {
+        if( apoUsedConns[i] == nullptr )
+            continue;
+        PGresult* poResult;
+        while( (poResult = PQgetResult(apoUsedConns[i])) != nullptr )
+        {
+            if( apoResults[i] )
+                PQclear(apoResults[i]);
+            apoResults[i] = poResult;
+        }
+    }
+
+    for( size_t i = 1; i < nCommands; i++ )
+    {
+        if( apoUsedConns[i] == nullptr )
+        {
+            apoUsedConns[i] = poConn;
+            apoResults[i] = PQexec(poConn, aosCommands[i].c_str());
+        }
+    }
+    return apoResults;
 }
 
 /************************************************************************/
@@ -3199,6 +3314,7 @@ GDALDataset* PostGISRasterDataset::Open(GDALOpenInfo* poOpenInfo) {
         poDS->pszTable = pszTable;
         poDS->pszColumn = pszColumn;
         poDS->pszWhere = pszWhere;
+        poDS->m_osConnectionString = pszConnectionString;
 
         /**
          * Fetch basic raster metadata from db
@@ -35,6 +35,10 @@
  **********************************************************************/
 #include "postgisraster.h"
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
 CPL_CVSID("$Id: postgisrasterrasterband.cpp e12a0fc61edef91a039e13c7baff2ce58288a552 2018-08-10 00:53:29 +0200 Juergen E. Fischer $")
 
 /**
@@ -124,6 +128,194 @@ static int SortTilesByPKID(const void* a, const void* b)
     return strcmp(pa->GetPKID(), pb->GetPKID());
 }
 
+/********************************************************
+ * \brief Read a downsampled region resampled by the server
+ *
+ * The tiles intersecting the region are clipped, merged and
+ * resampled to the buffer resolution with ST_Resample(), so
+ * that only nBufXSize * nBufYSize pixels are transferred.
+ * Returns CE_Failure, without emitting an error, if the
+ * request cannot be processed that way, in which case the
+ * caller should fall back to reading the tiles.
+ ********************************************************/
+CPLErr PostGISRasterRasterBand::ServerSideResampledRasterIO(int nXOff,
+    int nYOff, int nXSize, int nYSize, void * pData, int nBufXSize,
+    int nBufYSize, GDALDataType eBufType,
+    GSpacing nPixelSpace, GSpacing nLineSpace,
+    GDALRasterIOExtraArg* psExtraArg)
+{
+    PostGISRasterDataset * poRDS = cpl::down_cast<PostGISRasterDataset *>(poDS);
+    const double* padfGT = poRDS->adfGeoTransform;
+    if( padfGT[GEOTRSFRM_ROTATION_PARAM1] != 0.0 ||
+        padfGT[GEOTRSFRM_ROTATION_PARAM2] != 0.0 )
+    {
+        return CE_Failure;
+    }
+
+    const double dfULX = padfGT[GEOTRSFRM_TOPLEFT_X] +
+                                    nXOff * padfGT[GEOTRSFRM_WE_RES];
+    const double dfULY = padfGT[GEOTRSFRM_TOPLEFT_Y] +
+                                    nYOff * padfGT[GEOTRSFRM_NS_RES];
+    const double dfLRX = dfULX + nXSize * padfGT[GEOTRSFRM_WE_RES];
+    const double dfLRY = dfULY + nYSize * padfGT[GEOTRSFRM_NS_RES];
+    const double dfResX = padfGT[GEOTRSFRM_WE_RES] * nXSize / nBufXSize;
+    const double dfResY = padfGT[GEOTRSFRM_NS_RES] * nYSize / nBufYSize;
+    const CPLString osEnvelope(CPLSPrintf("%.18g,%.18g,%.18g,%.18g",
+                                          std::min(dfULX, dfLRX),
+                                          std::min(dfULY, dfLRY),
+                                          std::max(dfULX, dfLRX),
+                                          std::max(dfULY, dfLRY)));
+
+    const char* pszAlg = "NearestNeighbour";
+    if( psExtraArg != nullptr )
+    {
+        switch( psExtraArg->eResampleAlg )
+        {
+            case GRIORA_Bilinear: pszAlg = "Bilinear"; break;
+            case GRIORA_Cubic: pszAlg = "Cubic"; break;
+            case GRIORA_CubicSpline: pszAlg = "CubicSpline"; break;
+            case GRIORA_Lanczos: pszAlg = "Lanczos"; break;
+            default: break;
+        }
+    }
+
+    CPLString osSchemaI(CPLQuotedSQLIdentifier(pszSchema));
+    CPLString osTableI(CPLQuotedSQLIdentifier(pszTable));
+    CPLString osColumnI(CPLQuotedSQLIdentifier(pszColumn));
+
+    CPLString osCommand;
+    osCommand.Printf(
+        "SELECT encode(ST_AsBinary(ST_Resample(ST_Union(ST_Clip("
+        "ST_Band(%s, %d), ST_MakeEnvelope(%s, ST_SRID(%s)))), "
+        "ST_MakeEmptyRaster(%d, %d, %.18g, %.18g, %.18g, %.18g, 0, 0, %d), "
+        "'%s'), TRUE), 'hex') FROM %s.%s WHERE %s && ST_MakeEnvelope(%s)",
+        osColumnI.c_str(), nBand, osEnvelope.c_str(), osColumnI.c_str(),
+        nBufXSize, nBufYSize, dfULX, dfULY, dfResX, dfResY,
+        std::max(0, poRDS->nSrid), pszAlg,
+        osSchemaI.c_str(), osTableI.c_str(),
+        osColumnI.c_str(), osEnvelope.c_str());
+    if( poRDS->pszWhere != nullptr )
+    {
+        osCommand += " AND (";
+        osCommand += poRDS->pszWhere;
+        osCommand += ")";
+    }
+
+    PGresult * poResult = PQexec(poRDS->poConn, osCommand.c_str());
+
+#ifdef DEBUG_QUERY
+    CPLDebug("PostGIS_Raster",
+        "PostGISRasterRasterBand::ServerSideResampledRasterIO(): Query = \"%s\"",
+        osCommand.c_str());
+#endif
+
+    if (poResult == nullptr ||
+        PQresultStatus(poResult) != PGRES_TUPLES_OK ||
+        PQntuples(poResult) != 1) {
+        CPLDebug("PostGIS_Raster",
+                 "Server side resampling failed, reading tiles instead: %s",
+                 PQerrorMessage(poRDS->poConn));
+        if (poResult)
+            PQclear(poResult);
+        return CE_Failure;
+    }
+
+    NullBuffer(pData, nBufXSize, nBufYSize, eBufType,
+               static_cast<int>(nPixelSpace), static_cast<int>(nLineSpace));
+
+    // No tile in the region
+    if( PQgetisnull(poResult, 0, 0) )
+    {
+        PQclear(poResult);
+        return CE_None;
+    }
+
+    int nWKBLength = 0;
+    struct CPLFreer { void operator() (GByte* x) const { CPLFree(x); } };
+    std::unique_ptr<GByte, CPLFreer> pabyWKBAutoFreed(
+        CPLHexToBinary(PQgetvalue(poResult, 0, 0), &nWKBLength));
+    PQclear(poResult);
+    GByte* pabyWKB = pabyWKBAutoFreed.get();
+    if( nWKBLength < RASTER_HEADER_SIZE + RASTER_BAND_HEADER_FIXED_SIZE )
+        return CE_Failure;
+
+    const bool bIsLittleEndian = (pabyWKB[0] == 1);
+#ifdef CPL_LSB
+    const bool bSwap = !bIsLittleEndian;
+#else
+    const bool bSwap = bIsLittleEndian;
+#endif
+    const auto ReadUInt16 = [pabyWKB, bSwap](int nOffset)
+    {
+        GUInt16 nVal;
+        memcpy(&nVal, pabyWKB + nOffset, sizeof(nVal));
+        if( bSwap )
+            CPL_SWAP16PTR(&nVal);
+        return static_cast<int>(nVal);
+    };
+    const auto ReadDouble = [pabyWKB, bSwap](int nOffset)
+    {
+        double dfVal;
+        memcpy(&dfVal, pabyWKB + nOffset, sizeof(dfVal));
+        if( bSwap )
+            CPL_SWAPDOUBLE(&dfVal);
+        return dfVal;
+    };
+
+    // See https://trac.osgeo.org/postgis/browser/trunk/raster/doc/RFC2-WellKnownBinaryFormat
+    const int nBands = ReadUInt16(3);
+    const double dfRasterULX = ReadDouble(21);
+    const double dfRasterULY = ReadDouble(29);
+    const int nWidth = ReadUInt16(57);
+    const int nHeight = ReadUInt16(59);
+    const GByte byBandFlags = pabyWKB[RASTER_HEADER_SIZE];
+    if( nBands < 1 || (byBandFlags & 0x80) != 0 )
+        return CE_Failure;
+    // Band made only of nodata
+    if( (byBandFlags & 0x20) != 0 )
+        return CE_None;
+
+    static const int anPixTypeSize[] = { 1, 1, 1, 1, 1, 2, 2, 4, 4, 0, 4, 8 };
+    const int nPixType = byBandFlags & 0x0F;
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    if( nPixType >= static_cast<int>(CPL_ARRAYSIZE(anPixTypeSize)) ||
+        anPixTypeSize[nPixType] != nDTSize )
+    {
+        return CE_Failure;
+    }
+    const int nDataOffset =
+        RASTER_HEADER_SIZE + RASTER_BAND_HEADER_FIXED_SIZE + nDTSize;
+    if( nWKBLength < nDataOffset + nWidth * nHeight * nDTSize )
+        return CE_Failure;
+    GByte* pabyData = pabyWKB + nDataOffset;
+    if( bSwap && nDTSize > 1 )
+        GDALSwapWords(pabyData, nDTSize, nWidth * nHeight, nDTSize);
+
+    // The result is aligned on the grid of the reference raster
+    const int nDstXOff =
+        static_cast<int>(std::floor((dfRasterULX - dfULX) / dfResX + 0.5));
+    const int nDstYOff =
+        static_cast<int>(std::floor((dfRasterULY - dfULY) / dfResY + 0.5));
+    const int nSrcXStart = std::max(0, -nDstXOff);
+    const int nSrcXEnd = std::min(nWidth, nBufXSize - nDstXOff);
+    if( nSrcXEnd <= nSrcXStart )
+        return CE_None;
+    for( int iY = std::max(0, -nDstYOff);
+         iY < nHeight && nDstYOff + iY < nBufYSize; iY++ )
+    {
+        GDALCopyWords(pabyData + (static_cast<size_t>(iY) * nWidth +
+                                  nSrcXStart) * nDTSize,
+                      eDataType, nDTSize,
+                      static_cast<GByte*>(pData) +
+                        (nDstYOff + iY) * nLineSpace +
+                        (nDstXOff + nSrcXStart) * nPixelSpace,
+                      eBufType, static_cast<int>(nPixelSpace),
+                      nSrcXEnd - nSrcXStart);
+    }
+
+    return CE_None;
+}
+
 /**
  * Read/write a region of image data for this band.
  *
@@ -210,6 +402,21 @@ CPLErr PostGISRasterRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff,
 
     PostGISRasterDataset * poRDS = cpl::down_cast<PostGISRasterDataset *>(poDS);
 
+    /*******************************************************************
+     * Otherwise, let the server do the resampling if asked to, so that
+     * full resolution tiles are not transferred.
+     ******************************************************************/
+    if( (nBufXSize < nXSize || nBufYSize < nYSize) &&
+        poRDS->m_bServerSideResampling )
+    {
+        if( ServerSideResampledRasterIO(nXOff, nYOff, nXSize, nYSize,
+                pData, nBufXSize, nBufYSize, eBufType, nPixelSpace,
+                nLineSpace, psExtraArg) == CE_None )
+        {
+            return CE_None;
+        }
+    }
+
     int bSameWindowAsOtherBand =
         (nXOff == poRDS->nXOffPrev &&
          nYOff == poRDS->nYOffPrev &&
@@ -328,6 +535,7 @@ CPLErr PostGISRasterRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff,
 
     GIntBig nMemoryRequiredForTiles = 0;
     CPLString osIDsToFetch;
+    std::vector<const char*> apszIDsToFetch;
     int nTilesToFetch = 0;
     int nBandDataTypeSize = GDALGetDataTypeSize(eDataType) / 8;
 
@@ -351,6 +559,7 @@ CPLErr PostGISRasterRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff,
                 osIDsToFetch += "'";
                 osIDsToFetch += poTile->pszPKID;
                 osIDsToFetch += "'";
+                apszIDsToFetch.push_back(poTile->pszPKID);
             }
 
             double dfTileMinX, dfTileMinY, dfTileMaxX, dfTileMaxY;
@@ -454,6 +663,9 @@ CPLErr PostGISRasterRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff,
         CPLString osColumnI(CPLQuotedSQLIdentifier(pszColumn));
 
         CPLString osWHERE;
+        // When tiles are fetched by PKID, the list of tiles can be split
+        // between several queries run concurrently.
+        std::vector<CPLString> aosWHEREPerQuery;
         if (!osIDsToFetch.empty() && (poRDS->bIsFastPK || !(poRDS->HasSpatialIndex())) ) {
             if( nTilesToFetch < poRDS->m_nTiles || poRDS->bBuildQuadTreeDynamically )
             {
@@ -461,6 +673,25 @@ CPLErr PostGISRasterRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff,
                 osWHERE += " IN (";
                 osWHERE += osIDsToFetch;
                 osWHERE += ")";
+
+                const int nQueries = std::min(
+                    poRDS->m_nMaxConnections,
+                    static_cast<int>(apszIDsToFetch.size()));
+                if( nQueries > 1 )
+                {
+                    aosWHEREPerQuery.resize(nQueries);
+                    for( size_t j = 0; j < apszIDsToFetch.size(); j++ )
+                    {
+                        CPLString& osQueryWHERE = aosWHEREPerQuery[j % nQueries];
+                        osQueryWHERE += osQueryWHERE.empty() ?
+                            CPLString(poRDS->pszPrimaryKeyName) + " IN (" : CPLString(",");
+                        osQueryWHERE += "'";
+                        osQueryWHERE += apszIDsToFetch[j];
+                        osQueryWHERE += "'";
+                    }
+                    for( auto& osQueryWHERE: aosWHEREPerQuery )
+                        osQueryWHERE += ")";
+                }
             }
         }
         else
@@ -495,7 +726,15 @@ CPLErr PostGISRasterRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff,
             osWHERE += "(";
             osWHERE += poRDS->pszWhere;
             osWHERE += ")";
+            for( auto& osQueryWHERE: aosWHEREPerQuery )
+            {
+                osQueryWHERE += " AND (";
+                osQueryWHERE += poRDS->pszWhere;
+                osQueryWHERE += ")";
+            }
         }
+        if( aosWHEREPerQuery.empty() )
+            aosWHEREPerQuery.push_back(osWHERE);
 
         bool bCanUseClientSide = true;
         if( poRDS->eOutDBResolution == OutDBResolution::CLIENT_SIDE_IF_POSSIBLE )
@@ -516,65 +755,75 @@ CPLErr PostGISRasterRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff,
             osRasterToFetch = "encode(ST_AsBinary(" + osRasterToFetch + ",TRUE),'hex')";
         }
 
-        CPLString osCommand;
-        osCommand.Printf("SELECT %s, ST_Metadata(%s), %s FROM %s.%s",
-                         (poRDS->GetPrimaryKeyRef()) ? poRDS->GetPrimaryKeyRef() : "NULL",
-                         osColumnI.c_str(),
-                         osRasterToFetch.c_str(),
-                         osSchemaI.c_str(), osTableI.c_str());
-        if( !osWHERE.empty() )
+        std::vector<CPLString> aosCommands;
+        for( const auto& osQueryWHERE: aosWHEREPerQuery )
         {
-            osCommand += " WHERE " + osWHERE;
+            CPLString osCommand;
+            osCommand.Printf("SELECT %s, ST_Metadata(%s), %s FROM %s.%s",
+                             (poRDS->GetPrimaryKeyRef()) ? poRDS->GetPrimaryKeyRef() : "NULL",
+                             osColumnI.c_str(),
+                             osRasterToFetch.c_str(),
+                             osSchemaI.c_str(), osTableI.c_str());
+            if( !osQueryWHERE.empty() )
+            {
+                osCommand += " WHERE " + osQueryWHERE;
+            }
+            aosCommands.push_back(osCommand);
         }
 
-        PGresult * poResult = PQexec(poRDS->poConn, osCommand.c_str());
+        std::vector<PGconn*> apoUsedConns;
+        std::vector<PGresult*> apoResults =
+            poRDS->ExecConcurrently(aosCommands, apoUsedConns);
+
+        bool bError = false;
+        for( size_t iQuery = 0; iQuery < apoResults.size(); iQuery++ )
+        {
+            PGresult * poResult = apoResults[iQuery];
 
 #ifdef DEBUG_QUERY
-        CPLDebug("PostGIS_Raster",
-            "PostGISRasterRasterBand::IRasterIO(): Query = \"%s\" --> number of rows = %d",
-            osCommand.c_str(), poResult ? PQntuples(poResult) : 0 );
+            CPLDebug("PostGIS_Raster",
+                "PostGISRasterRasterBand::IRasterIO(): Query = \"%s\" --> number of rows = %d",
+                aosCommands[iQuery].c_str(), poResult ? PQntuples(poResult) : 0 );
 #endif
 
-        if (poResult == nullptr ||
-            PQresultStatus(poResult) != PGRES_TUPLES_OK ||
-            PQntuples(poResult) < 0) {
-
-            if (poResult)
-                PQclear(poResult);
-
-            CPLError(CE_Failure, CPLE_AppDefined,
-                "PostGISRasterRasterBand::IRasterIO(): %s",
-                PQerrorMessage(poRDS->poConn));
+            if (poResult == nullptr ||
+                PQresultStatus(poResult) != PGRES_TUPLES_OK ||
+                PQntuples(poResult) < 0) {
+
+                if (poResult)
+                    PQclear(poResult);
+
+                if( !bError )
+                {
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                        "PostGISRasterRasterBand::IRasterIO(): %s",
+                        PQerrorMessage(apoUsedConns[iQuery]));
+                }
+                bError = true;
+                continue;
+            }
 
-            // Free the object that holds pointers to matching tiles
-            CPLFree(papsMatchingTiles);
-            return CE_Failure;
-        }
+            /**
+             * Ok, we loop over the results
+             **/
+            int nTuples = PQntuples(poResult);
+            for(i = 0; !bError && i < nTuples; i++)
+            {
+                const char *pszPKID = PQgetvalue(poResult, i, 0);
+                const char* pszMetadata = PQgetvalue(poResult, i, 1);
+                const char* pszRaster = PQgetvalue(poResult, i, 2);
+                poRDS->CacheTile(pszMetadata, pszRaster, pszPKID, nBand, bAllBandCaching);
+            } // All tiles have been added to cache
 
-        /**
-         * No data. Return the buffer filled with nodata values
-         **/
-        else if (PQntuples(poResult) == 0) {
             PQclear(poResult);
+        }
 
+        if( bError )
+        {
             // Free the object that holds pointers to matching tiles
             CPLFree(papsMatchingTiles);
-            return CE_None;
+            return CE_Failure;
         }
-
-        /**
-         * Ok, we loop over the results
-         **/
-        int nTuples = PQntuples(poResult);
-        for(i = 0; i < nTuples; i++)
-        {
-            const char *pszPKID = PQgetvalue(poResult, i, 0);
-            const char* pszMetadata = PQgetvalue(poResult, i, 1);
-            const char* pszRaster = PQgetvalue(poResult, i, 2);
-            poRDS->CacheTile(pszMetadata, pszRaster, pszPKID, nBand, bAllBandCaching);
-        } // All tiles have been added to cache
-
-        PQclear(poResult);
     } // End missing tiles
 
 /* -------------------------------------------------------------------- */
@@ -2643,17 +2643,11 @@ CPLErr RMFDataset::InitCompressorData(char **papszParmList)
     if(pszNumThreads == nullptr)
         pszNumThreads = CPLGetConfigOption("GDAL_NUM_THREADS", nullptr);
 
+    // 0 (the default) compresses synchronously, without worker threads
     int nThreads = 0;
-    if(pszNumThreads != nullptr)
+    if(pszNumThreads != nullptr && !EQUAL(pszNumThreads, "0"))
     {
-        nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ?
-                            CPLGetNumCPUs() :
-                            atoi(pszNumThreads);
-    }
-
-    if(nThreads < 0)
-    {
-        nThreads = 0;
+        nThreads = CPLGetNumThreads(papszParmList);
     }
 
     poCompressData = std::make_shared<RMFCompressData>();
@@ -38,6 +38,7 @@
 
 #include <algorithm>
 #include <map>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -3388,6 +3389,128 @@ void SENTINEL2Dataset::AddL1CL2ABandMetadata(SENTINEL2Level eLevel,
     }
 }
 
+/************************************************************************/
+/*                       SENTINEL2LazyTileSource                        */
+/************************************************************************/
+
+/* VRT source over a granule tile whose existence is only checked the */
+/* first time a request intersects it, instead of at dataset opening. */
+/* A missing tile is skipped, as it used to be when building the VRT. */
+
+template<class BaseSource> class SENTINEL2LazyTileSource final:
+                                                        public BaseSource
+{
+        CPLString       m_osTile;
+        std::once_flag  m_oOnce{};
+        bool            m_bExists = false;
+
+        bool            TileExists();
+
+    public:
+        explicit SENTINEL2LazyTileSource( const CPLString& osTile ) :
+            m_osTile(osTile) {}
+
+        virtual CPLErr  RasterIO( GDALDataType eBandDataType,
+                                  int nXOff, int nYOff,
+                                  int nXSize, int nYSize,
+                                  void *pData, int nBufXSize, int nBufYSize,
+                                  GDALDataType eBufType,
+                                  GSpacing nPixelSpace, GSpacing nLineSpace,
+                                  GDALRasterIOExtraArg* psExtraArg ) override
+        {
+            if( !TileExists() )
+                return CE_None;
+            return BaseSource::RasterIO( eBandDataType,
+                                         nXOff, nYOff, nXSize, nYSize,
+                                         pData, nBufXSize, nBufYSize,
+                                         eBufType, nPixelSpace, nLineSpace,
+                                         psExtraArg );
+        }
+
+        // On failure, the VRT band falls back to computing from RasterIO()
+        virtual double GetMinimum( int nXSize, int nYSize,
+                                   int *pbSuccess ) override
+        {
+            if( !TileExists() )
+            {
+                if( pbSuccess )
+                    *pbSuccess = FALSE;
+                return 0.0;
+            }
+            return BaseSource::GetMinimum(nXSize, nYSize, pbSuccess);
+        }
+
+        virtual double GetMaximum( int nXSize, int nYSize,
+                                   int *pbSuccess ) override
+        {
+            if( !TileExists() )
+            {
+                if( pbSuccess )
+                    *pbSuccess = FALSE;
+                return 0.0;
+            }
+            return BaseSource::GetMaximum(nXSize, nYSize, pbSuccess);
+        }
+
+        virtual CPLErr ComputeRasterMinMax( int nXSize, int nYSize,
+                                            int bApproxOK,
+                                            double* adfMinMax ) override
+        {
+            if( !TileExists() )
+                return CE_Failure;
+            return BaseSource::ComputeRasterMinMax(nXSize, nYSize,
+                                                   bApproxOK, adfMinMax);
+        }
+
+        virtual CPLErr ComputeStatistics( int nXSize, int nYSize,
+                                          int bApproxOK,
+                                          double *pdfMin, double *pdfMax,
+                                          double *pdfMean, double *pdfStdDev,
+                                          GDALProgressFunc pfnProgress,
+                                          void *pProgressData ) override
+        {
+            if( !TileExists() )
+                return CE_Failure;
+            return BaseSource::ComputeStatistics(nXSize, nYSize, bApproxOK,
+                                                 pdfMin, pdfMax,
+                                                 pdfMean, pdfStdDev,
+                                                 pfnProgress, pProgressData);
+        }
+
+        virtual CPLErr GetHistogram( int nXSize, int nYSize,
+                                     double dfMin, double dfMax,
+                                     int nBuckets, GUIntBig * panHistogram,
+                                     int bIncludeOutOfRange, int bApproxOK,
+                                     GDALProgressFunc pfnProgress,
+                                     void *pProgressData ) override
+        {
+            if( !TileExists() )
+                return CE_Failure;
+            return BaseSource::GetHistogram(nXSize, nYSize, dfMin, dfMax,
+                                            nBuckets, panHistogram,
+                                            bIncludeOutOfRange, bApproxOK,
+                                            pfnProgress, pProgressData);
+        }
+};
+
+template<class BaseSource>
+bool SENTINEL2LazyTileSource<BaseSource>::TileExists()
+{
+    // Sources of a band may be read by several threads
+    std::call_once(m_oOnce, [this]()
+    {
+        VSIStatBufL sStat;
+        m_bExists = VSIStatExL(m_osTile, &sStat, VSI_STAT_EXISTS_FLAG) == 0;
+        if( !m_bExists )
+        {
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "Tile %s not found on filesystem. Skipping it",
+                     m_osTile.c_str());
+        }
+    });
+    return m_bExists;
+}
+
 /************************************************************************/
 /*                         CreateL1CL2ADataset()                        */
 /************************************************************************/
@@ -3593,13 +3716,13 @@ SENTINEL2Dataset* SENTINEL2Dataset::CreateL1CL2ADataset(
                 }
             }
 
-            bool bTileFound = false;
+            // Only the tile that gives the bit depth is accessed here, the
+            // others are checked when a request first intersects them.
             if( nValMax == 0 )
             {
                 /* It is supposed to be 12 bits, but some products have 15 bits */
                 if( SENTINEL2GetTileInfo(osTile, nullptr, nullptr, &nBits) )
                 {
-                    bTileFound = true;
                     if( nBits <= 16 )
                         nValMax = (1 << nBits) - 1;
                     else
@@ -3608,19 +3731,13 @@ SENTINEL2Dataset* SENTINEL2Dataset::CreateL1CL2ADataset(
                         nValMax = 65535;
                     }
                 }
-            }
-            else
-            {
-                VSIStatBufL sStat;
-                if( VSIStatExL(osTile, &sStat, VSI_STAT_EXISTS_FLAG) == 0 )
-                    bTileFound = true;
-            }
-            if( !bTileFound )
-            {
-                CPLError(CE_Warning, CPLE_AppDefined,
-                        "Tile %s not found on filesystem. Skipping it",
-                        osTile.c_str());
-                continue;
+                else
+                {
+                    CPLError(CE_Warning, CPLE_AppDefined,
+                            "Tile %s not found on filesystem. Skipping it",
+                            osTile.c_str());
+                    continue;
+                }
             }
 
             GDALProxyPoolDataset* proxyDS = nullptr;
@@ -3658,7 +3775,11 @@ SENTINEL2Dataset* SENTINEL2Dataset::CreateL1CL2ADataset(
 
             if( nBand != nAlphaBand )
             {
-                poBand->AddSimpleSource( proxyDS->GetRasterBand((bIsPreview || bIsTCI) ? nBand : 1),
+                VRTSimpleSource* poSource =
+                    new SENTINEL2LazyTileSource<VRTSimpleSource>(osTile);
+                poBand->ConfigureSource( poSource,
+                                        proxyDS->GetRasterBand((bIsPreview || bIsTCI) ? nBand : 1),
+                                        FALSE,
                                         0, 0,
                                         oGranuleInfo.nWidth,
                                         oGranuleInfo.nHeight,
@@ -3666,19 +3787,25 @@ SENTINEL2Dataset* SENTINEL2Dataset::CreateL1CL2ADataset(
                                         nDstYOff,
                                         oGranuleInfo.nWidth,
                                         oGranuleInfo.nHeight);
+                poBand->AddSource( poSource );
             }
             else
             {
-                poBand->AddComplexSource( proxyDS->GetRasterBand(1),
-                                          0, 0,
-                                          oGranuleInfo.nWidth,
-                                          oGranuleInfo.nHeight,
-                                          nDstXOff,
-                                          nDstYOff,
-                                          oGranuleInfo.nWidth,
-                                          oGranuleInfo.nHeight,
-                                          nValMax /* offset */,
-                                          0 /* scale */);
+                VRTComplexSource* poSource =
+                    new SENTINEL2LazyTileSource<VRTComplexSource>(osTile);
+                poBand->ConfigureSource( poSource,
+                                         proxyDS->GetRasterBand(1),
+                                         FALSE,
+                                         0, 0,
+                                         oGranuleInfo.nWidth,
+                                         oGranuleInfo.nHeight,
+                                         nDstXOff,
+                                         nDstYOff,
+                                         oGranuleInfo.nWidth,
+                                         oGranuleInfo.nHeight);
+                poSource->SetLinearScaling(nValMax /* offset */,
+                                           0 /* scale */);
+                poBand->AddSource( poSource );
             }
 
             proxyDS->Dereference();
@@ -72,6 +72,16 @@ class TileDBDataset : public GDALPamDataset
         CPLErr AddFilter( const char* pszFilterName, const int level );
         CPLErr CreateAttribute( GDALDataType eType, const CPLString& osAttrName,
                                 const int nSubRasterCount=1 );
+
+        bool   CanReadWindow( GDALRWFlag eRWFlag,
+                              int nXOff, int nYOff, int nXSize, int nYSize,
+                              int nBufXSize, int nBufYSize,
+                              int nBandCount, const int* panBandMap );
+        CPLErr ReadWindow( int nXOff, int nYOff, int nXSize, int nYSize,
+                           void* pData, GDALDataType eBufType,
+                           int nBandCount, const int* panBandMap,
+                           GSpacing nPixelSpace, GSpacing nLineSpace,
+                           GSpacing nBandSpace );
     public:
         virtual ~TileDBDataset();
 
@@ -101,6 +111,14 @@ class TileDBDataset : public GDALPamDataset
         static void             SetBlockSize( GDALRasterBand* poBand,
                                                 char ** &papszOptions );
 
+        virtual CPLErr IRasterIO( GDALRWFlag eRWFlag,
+                                  int nXOff, int nYOff, int nXSize, int nYSize,
+                                  void * pData, int nBufXSize, int nBufYSize,
+                                  GDALDataType eBufType,
+                                  int nBandCount, int *panBandMap,
+                                  GSpacing nPixelSpace, GSpacing nLineSpace,
+                                  GSpacing nBandSpace,
+                                  GDALRasterIOExtraArg* psExtraArg ) override;
 };
 
 /************************************************************************/
@@ -122,6 +140,12 @@ class TileDBRasterBand : public GDALPamRasterBand
         TileDBRasterBand( TileDBDataset *, int, CPLString = TILEDB_VALUES );
         virtual CPLErr IReadBlock( int, int, void * ) override;
         virtual CPLErr IWriteBlock( int, int, void * ) override;
+        virtual CPLErr IRasterIO( GDALRWFlag eRWFlag,
+                                  int nXOff, int nYOff, int nXSize, int nYSize,
+                                  void * pData, int nBufXSize, int nBufYSize,
+                                  GDALDataType eBufType,
+                                  GSpacing nPixelSpace, GSpacing nLineSpace,
+                                  GDALRasterIOExtraArg* psExtraArg ) override;
         virtual GDALColorInterp GetColorInterpretation() override;
 
 };
@@ -338,6 +362,34 @@ CPLErr TileDBRasterBand::IWriteBlock( CPL_UNUSED int nBlockXOff,
     return CE_None;
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr TileDBRasterBand::IRasterIO( GDALRWFlag eRWFlag,
+                                    int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void * pData,
+                                    int nBufXSize, int nBufYSize,
+                                    GDALDataType eBufType,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GDALRasterIOExtraArg* psExtraArg )
+{
+    if( poGDS->CanReadWindow( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                              nBufXSize, nBufYSize, 1, &nBand ) )
+    {
+        return poGDS->ReadWindow( nXOff, nYOff, nXSize, nYSize,
+                                  pData, eBufType, 1, &nBand,
+                                  nPixelSpace, nLineSpace, 0 );
+    }
+
+    return GDALPamRasterBand::IRasterIO( eRWFlag, nXOff, nYOff,
+                                         nXSize, nYSize,
+                                         pData, nBufXSize, nBufYSize,
+                                         eBufType, nPixelSpace, nLineSpace,
+                                         psExtraArg );
+}
+
 /************************************************************************/
 /*                       GetColorInterpretation()                       */
 /************************************************************************/
@@ -396,6 +448,189 @@ TileDBDataset::~TileDBDataset()
     CSLDestroy( papszSubDatasets );
 }
 
+/************************************************************************/
+/*                           CanReadWindow()                            */
+/************************************************************************/
+
+// Whether a request can be served by a single query over the window
+// instead of one query per block.
+
+bool TileDBDataset::CanReadWindow( GDALRWFlag eRWFlag,
+                                   int nXOff, int nYOff,
+                                   int nXSize, int nYSize,
+                                   int nBufXSize, int nBufYSize,
+                                   int nBandCount, const int* panBandMap )
+{
+    if( eRWFlag != GF_Read || eAccess != GA_ReadOnly ||
+        nXSize != nBufXSize || nYSize != nBufYSize ||
+        nBlockXSize <= 0 || nBlockYSize <= 0 )
+        return false;
+
+    // Requests within a single block go through the block cache
+    if( nXOff / nBlockXSize == (nXOff + nXSize - 1) / nBlockXSize &&
+        nYOff / nBlockYSize == (nYOff + nYSize - 1) / nBlockYSize )
+        return false;
+
+    // SetBuffer() takes a number of values as an int, twice for complex types
+    if( static_cast<GIntBig>(nXSize) * nYSize * nBandCount > INT_MAX / 2 )
+        return false;
+
+    // Each attribute or band dimension index is set once in the query
+    for( int i = 1; i < nBandCount; i++ )
+    {
+        if( panBandMap[i] <= panBandMap[i-1] )
+            return false;
+    }
+
+    // Along the band dimension, the bands must be a contiguous range
+    TileDBRasterBand* poBand =
+        static_cast<TileDBRasterBand*>( GetRasterBand( panBandMap[0] ) );
+    if( EQUAL( TILEDB_VALUES, poBand->osAttrName ) &&
+        panBandMap[nBandCount-1] - panBandMap[0] != nBandCount - 1 )
+        return false;
+
+    return true;
+}
+
+/************************************************************************/
+/*                             ReadWindow()                             */
+/************************************************************************/
+
+// The values are returned in row major order, band after band, so they
+// are read straight into the caller buffer when it has that layout.
+// Bands stored as attributes are all read by the same query.
+
+CPLErr TileDBDataset::ReadWindow( int nXOff, int nYOff,
+                                  int nXSize, int nYSize,
+                                  void* pData, GDALDataType eBufType,
+                                  int nBandCount, const int* panBandMap,
+                                  GSpacing nPixelSpace, GSpacing nLineSpace,
+                                  GSpacing nBandSpace )
+{
+    const int nDTSize = GDALGetDataTypeSizeBytes( eDataType );
+    const size_t nBandValues = static_cast<size_t>( nXSize ) * nYSize;
+    const bool bDirect = eBufType == eDataType &&
+                         nPixelSpace == nDTSize &&
+                         nLineSpace == nPixelSpace * nXSize &&
+                         ( nBandCount == 1 ||
+                           nBandSpace == nLineSpace * nYSize );
+
+    GByte* pabyValues = bDirect ? static_cast<GByte*>( pData ) :
+        static_cast<GByte*>( VSI_MALLOC3_VERBOSE( nBandValues, nBandCount,
+                                                  nDTSize ) );
+    if( pabyValues == nullptr )
+        return CE_Failure;
+
+    TileDBRasterBand* poFirstBand =
+        static_cast<TileDBRasterBand*>( GetRasterBand( panBandMap[0] ) );
+    const bool bBandDimension = EQUAL( TILEDB_VALUES, poFirstBand->osAttrName );
+
+    std::vector<uint64_t> oaSubarray;
+    if( bBandDimension )
+    {
+        oaSubarray.push_back( uint64_t( panBandMap[0] ) );
+        oaSubarray.push_back( uint64_t( panBandMap[nBandCount-1] ) );
+    }
+    oaSubarray.push_back( uint64_t( nYOff ) );
+    oaSubarray.push_back( uint64_t( nYOff + nYSize ) - 1 );
+    oaSubarray.push_back( uint64_t( nXOff ) );
+    oaSubarray.push_back( uint64_t( nXOff + nXSize ) - 1 );
+
+    CPLErr eErr = CE_None;
+    try
+    {
+        tiledb::Query query( *m_ctx, *m_array );
+        query.set_layout( TILEDB_ROW_MAJOR );
+        query.set_subarray( oaSubarray );
+
+        if( bBandDimension )
+        {
+            SetBuffer( &query, eDataType, poFirstBand->osAttrName,
+                       pabyValues, static_cast<int>( nBandValues * nBandCount ) );
+        }
+        else
+        {
+            for( int i = 0; i < nBandCount; i++ )
+            {
+                TileDBRasterBand* poBand = static_cast<TileDBRasterBand*>(
+                                            GetRasterBand( panBandMap[i] ) );
+                SetBuffer( &query, eDataType, poBand->osAttrName,
+                           pabyValues + i * nBandValues * nDTSize,
+                           static_cast<int>( nBandValues ) );
+            }
+        }
+
+        if ( bStats )
+            tiledb::Stats::enable();
+
+        auto status = query.submit();
+
+        if ( bStats )
+        {
+            tiledb::Stats::dump(stdout);
+            tiledb::Stats::disable();
+        }
+
+        if ( status == tiledb::Query::Status::FAILED )
+            eErr = CE_Failure;
+    }
+    catch(const tiledb::TileDBError& e)
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "%s", e.what() );
+        eErr = CE_Failure;
+    }
+
+    if( !bDirect )
+    {
+        for( int i = 0; eErr == CE_None && i < nBandCount; i++ )
+        {
+            for( int iY = 0; iY < nYSize; iY++ )
+            {
+                GDALCopyWords64( pabyValues +
+                                    ( i * nBandValues +
+                                      static_cast<size_t>( iY ) * nXSize ) *
+                                    nDTSize,
+                                 eDataType, nDTSize,
+                                 static_cast<GByte*>( pData ) +
+                                    i * nBandSpace + iY * nLineSpace,
+                                 eBufType, static_cast<int>( nPixelSpace ),
+                                 nXSize );
+            }
+        }
+        VSIFree( pabyValues );
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr TileDBDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                 int nXOff, int nYOff, int nXSize, int nYSize,
+                                 void * pData, int nBufXSize, int nBufYSize,
+                                 GDALDataType eBufType,
+                                 int nBandCount, int *panBandMap,
+                                 GSpacing nPixelSpace, GSpacing nLineSpace,
+                                 GSpacing nBandSpace,
+                                 GDALRasterIOExtraArg* psExtraArg )
+{
+    if( CanReadWindow( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                       nBufXSize, nBufYSize, nBandCount, panBandMap ) )
+    {
+        return ReadWindow( nXOff, nYOff, nXSize, nYSize, pData, eBufType,
+                           nBandCount, panBandMap,
+                           nPixelSpace, nLineSpace, nBandSpace );
+    }
+
+    return GDALPamDataset::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                      pData, nBufXSize, nBufYSize, eBufType,
+                                      nBandCount, panBandMap,
+                                      nPixelSpace, nLineSpace, nBandSpace,
+                                      psExtraArg );
+}
+
 /************************************************************************/
 /*                           TrySaveXML()                               */
 /************************************************************************/
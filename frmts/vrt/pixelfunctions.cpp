@@ -31,6 +31,10 @@
 #include "gdal.h"
 #include "vrtdataset.h"
 
+#include <algorithm>
+#include <new>
+#include <vector>
+
 CPL_CVSID("$Id: pixelfunctions.cpp 3b0bbf7a8a012d69a783ee1f9cfeb5c52b370021 2017-06-27 20:57:02Z Even Rouault $")
 
 static CPLErr RealPixelFunc( void **papoSources, int nSources, void *pData,
@@ -194,6 +198,64 @@ static CPLErr ImagPixelFunc( void **papoSources, int nSources, void *pData,
     return CE_None;
 }  // ImagPixelFunc
 
+/************************************************************************/
+/*                            Line helpers                              */
+/************************************************************************/
+
+// The pixel functions below process whole lines: each (real or imaginary
+// part of a) source line is converted to double with a single
+// GDALCopyWords() call, which has type specialised code paths, the
+// computation is done with plain loops over the line that the compiler
+// can vectorize, and the resulting line is written with a single
+// GDALCopyWords() call, instead of one SRCVAL() switch and one
+// GDALCopyWords() call per pixel.
+
+static bool AllocLineBuffer( std::vector<double>& adfBuffer, int nXSize,
+                             int nComponents )
+{
+    try
+    {
+        adfBuffer.resize( static_cast<size_t>(nXSize) * nComponents );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate pixel function line buffer" );
+        return false;
+    }
+    return true;
+}
+
+static void LoadSourceLine( const void *pSource, GDALDataType eSrcType,
+                            int nXSize, int iLine, bool bImag,
+                            double *padfLine )
+{
+    const int nPixelSpaceSrc = GDALGetDataTypeSizeBytes( eSrcType );
+    const GByte *pabySrc = static_cast<const GByte *>(pSource)
+        + static_cast<size_t>(nPixelSpaceSrc) * nXSize * iLine;
+    if( bImag )
+        pabySrc += nPixelSpaceSrc / 2;
+
+    GDALCopyWords( pabySrc, GDALGetNonComplexDataType( eSrcType ),
+                   nPixelSpaceSrc,
+                   padfLine, GDT_Float64, static_cast<int>(sizeof(double)),
+                   nXSize );
+}
+
+// padfLine holds nXSize values, interleaved (real, imaginary) pairs if
+// bComplex.
+static void StoreLine( const double *padfLine, bool bComplex,
+                       int nXSize, int iLine, void *pData,
+                       GDALDataType eBufType,
+                       int nPixelSpace, int nLineSpace )
+{
+    GDALCopyWords( padfLine, bComplex ? GDT_CFloat64 : GDT_Float64,
+                   static_cast<int>(sizeof(double)) * (bComplex ? 2 : 1),
+                   static_cast<GByte *>(pData)
+                       + static_cast<GPtrDiff_t>(nLineSpace) * iLine,
+                   eBufType, nPixelSpace, nXSize );
+}
+
 static CPLErr ComplexPixelFunc( void **papoSources, int nSources, void *pData,
                                 int nXSize, int nYSize,
                                 GDALDataType eSrcType, GDALDataType eBufType,
@@ -202,22 +264,24 @@ static CPLErr ComplexPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
-    const void * const pReal = papoSources[0];
-    const void * const pImag = papoSources[1];
+    std::vector<double> adfReal, adfImag, adfOut;
+    if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+        !AllocLineBuffer(adfImag, nXSize, 1) ||
+        !AllocLineBuffer(adfOut, nXSize, 2) )
+        return CE_Failure;
 
     /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double adfPixVal[2] = {
-                SRCVAL(pReal, eSrcType, ii),  // re
-                SRCVAL(pImag, eSrcType, ii)  // im
-            };
-
-            GDALCopyWords(adfPixVal, GDT_CFloat64, 0,
-                          static_cast<GByte *>(pData) + nLineSpace * iLine +
-                          iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       adfReal.data());
+        LoadSourceLine(papoSources[1], eSrcType, nXSize, iLine, false,
+                       adfImag.data());
+        for( int iCol = 0; iCol < nXSize; ++iCol ) {
+            adfOut[2 * iCol] = adfReal[iCol];
+            adfOut[2 * iCol + 1] = adfImag[iCol];
         }
+        StoreLine(adfOut.data(), true, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -232,44 +296,34 @@ static CPLErr ModulePixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const void *pReal = papoSources[0];
-        const void *pImag = static_cast<GByte *>(papoSources[0])
-                    + GDALGetDataTypeSizeBytes( eSrcType ) / 2;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfReal, adfImag;
+    if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+        (bComplex && !AllocLineBuffer(adfImag, nXSize, 1)) )
+        return CE_Failure;
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal =
-                    sqrt( dfReal * dfReal + dfImag * dfImag );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfReal = adfReal.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       padfReal);
+        if( bComplex )
+        {
+            const double *padfImag = adfImag.data();
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                           adfImag.data());
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                padfReal[iCol] = sqrt( padfReal[iCol] * padfReal[iCol] +
+                                       padfImag[iCol] * padfImag[iCol] );
             }
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfPixVal =
-                    fabs(SRCVAL(papoSources[0], eSrcType, ii));
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = fabs(padfReal[iCol]);
         }
+        StoreLine(padfReal, false, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -284,45 +338,32 @@ static CPLErr PhasePixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const void * const pReal = papoSources[0];
-        const void * const pImag = static_cast<GByte *>(papoSources[0])
-            + GDALGetDataTypeSizeBytes( eSrcType ) / 2;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfReal, adfImag;
+    if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+        (bComplex && !AllocLineBuffer(adfImag, nXSize, 1)) )
+        return CE_Failure;
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal = atan2(dfImag, dfReal);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfReal = adfReal.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       padfReal);
+        if( bComplex )
+        {
+            const double *padfImag = adfImag.data();
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                           adfImag.data());
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = atan2(padfImag[iCol], padfReal[iCol]);
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                const void * const pReal = papoSources[0];
-
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfPixVal = (dfReal < 0) ? M_PI : 0.0;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = (padfReal[iCol] < 0) ? M_PI : 0.0;
         }
+        StoreLine(padfReal, false, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -339,25 +380,24 @@ static CPLErr ConjPixelFunc( void **papoSources, int nSources, void *pData,
 
     if( GDALDataTypeIsComplex( eSrcType ) && GDALDataTypeIsComplex( eBufType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
+        std::vector<double> adfReal, adfImag, adfOut;
+        if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+            !AllocLineBuffer(adfImag, nXSize, 1) ||
+            !AllocLineBuffer(adfOut, nXSize, 2) )
+            return CE_Failure;
 
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double adfPixVal[2] = {
-                    +SRCVAL(pReal, eSrcType, ii),  // re
-                    -SRCVAL(pImag, eSrcType, ii)  // im
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                           adfReal.data());
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                           adfImag.data());
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                adfOut[2 * iCol] = +adfReal[iCol];
+                adfOut[2 * iCol + 1] = -adfImag[iCol];
             }
+            StoreLine(adfOut.data(), true, nXSize, iLine, pData, eBufType,
+                      nPixelSpace, nLineSpace);
         }
     }
     else
@@ -379,51 +419,39 @@ static CPLErr SumPixelFunc(void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources < 2 ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double adfSum[2] = { 0.0, 0.0 };
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    const void * const pReal = papoSources[iSrc];
-                    const void * const pImag =
-                        static_cast<const GByte *>(pReal) + nOffset;
-
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    adfSum[0] += SRCVAL(pReal, eSrcType, ii);
-                    adfSum[1] += SRCVAL(pImag, eSrcType, ii);
-                }
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfSrc, adfSum;
+    if( !AllocLineBuffer(adfSrc, nXSize, 1) ||
+        !AllocLineBuffer(adfSum, nXSize, bComplex ? 2 : 1) )
+        return CE_Failure;
 
-                GDALCopyWords(
-                    adfSum, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfSum = adfSum.data();
+        const double *padfSrc = adfSrc.data();
+        std::fill(adfSum.begin(), adfSum.end(), 0.0);
+
+        for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
+            LoadSourceLine(papoSources[iSrc], eSrcType, nXSize, iLine, false,
+                           adfSrc.data());
+            if( bComplex )
+            {
+                for( int iCol = 0; iCol < nXSize; ++iCol )
+                    padfSum[2 * iCol] += padfSrc[iCol];
+                LoadSourceLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                               true, adfSrc.data());
+                for( int iCol = 0; iCol < nXSize; ++iCol )
+                    padfSum[2 * iCol + 1] += padfSrc[iCol];
             }
-        }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double dfSum = 0;  // Not complex.
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    dfSum += SRCVAL(papoSources[iSrc], eSrcType, ii);
-                }
-
-                GDALCopyWords(
-                    &dfSum, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+            else
+            {
+                for( int iCol = 0; iCol < nXSize; ++iCol )
+                    padfSum[iCol] += padfSrc[iCol];
             }
         }
+
+        StoreLine(padfSum, bComplex, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -438,50 +466,37 @@ static CPLErr DiffPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal0 = papoSources[0];
-        const void * const pImag0 =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-        const void * const pReal1 = papoSources[1];
-        const void * const pImag1 =
-            static_cast<GByte *>(papoSources[1]) + nOffset;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfSrc0, adfSrc1, adfOut;
+    if( !AllocLineBuffer(adfSrc0, nXSize, 1) ||
+        !AllocLineBuffer(adfSrc1, nXSize, 1) ||
+        !AllocLineBuffer(adfOut, nXSize, bComplex ? 2 : 1) )
+        return CE_Failure;
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                double adfPixVal[2] = {
-                    SRCVAL(pReal0, eSrcType, ii)
-                    - SRCVAL(pReal1, eSrcType, ii),
-                    SRCVAL(pImag0, eSrcType, ii)
-                    - SRCVAL(pImag1, eSrcType, ii)
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        const double *padfSrc0 = adfSrc0.data();
+        const double *padfSrc1 = adfSrc1.data();
+        double *padfOut = adfOut.data();
+        // Real parts, and then imaginary parts if complex.
+        for( int iPart = 0; iPart < (bComplex ? 2 : 1); ++iPart ) {
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine,
+                           iPart == 1, adfSrc0.data());
+            LoadSourceLine(papoSources[1], eSrcType, nXSize, iLine,
+                           iPart == 1, adfSrc1.data());
+            if( bComplex )
+            {
+                for( int iCol = 0; iCol < nXSize; ++iCol )
+                    padfOut[2 * iCol + iPart] = padfSrc0[iCol] - padfSrc1[iCol];
             }
-        }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double dfPixVal = SRCVAL(papoSources[0], eSrcType, ii)
-                    - SRCVAL(papoSources[1], eSrcType, ii);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+            else
+            {
+                for( int iCol = 0; iCol < nXSize; ++iCol )
+                    padfOut[iCol] = padfSrc0[iCol] - padfSrc1[iCol];
             }
         }
+        StoreLine(padfOut, bComplex, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -496,57 +511,56 @@ static CPLErr MulPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources < 2 ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double adfPixVal[2] = { 1.0, 0.0 };
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    const void * const pReal = papoSources[iSrc];
-                    const void * const pImag =
-                        static_cast<const GByte *>(pReal) + nOffset;
-
-                    const double dfOldR = adfPixVal[0];
-                    const double dfOldI = adfPixVal[1];
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfReal, adfImag, adfOut;
+    if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+        (bComplex && !AllocLineBuffer(adfImag, nXSize, 1)) ||
+        !AllocLineBuffer(adfOut, nXSize, bComplex ? 2 : 1) )
+        return CE_Failure;
 
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    const double dfNewR = SRCVAL(pReal, eSrcType, ii);
-                    const double dfNewI = SRCVAL(pImag, eSrcType, ii);
-
-                    adfPixVal[0] = dfOldR * dfNewR - dfOldI * dfNewI;
-                    adfPixVal[1] = dfOldR * dfNewI + dfOldI * dfNewR;
-                }
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        const double *padfReal = adfReal.data();
+        const double *padfImag = adfImag.data();
+        double *padfOut = adfOut.data();
+        if( bComplex )
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                padfOut[2 * iCol] = 1.0;
+                padfOut[2 * iCol + 1] = 0.0;
             }
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double dfPixVal = 1.0;  // Not complex.
+        else
+        {
+            std::fill(adfOut.begin(), adfOut.end(), 1.0);
+        }
 
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    dfPixVal *= SRCVAL(papoSources[iSrc], eSrcType, ii);
+        for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
+            LoadSourceLine(papoSources[iSrc], eSrcType, nXSize, iLine, false,
+                           adfReal.data());
+            if( bComplex )
+            {
+                LoadSourceLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                               true, adfImag.data());
+                for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                    const double dfOldR = padfOut[2 * iCol];
+                    const double dfOldI = padfOut[2 * iCol + 1];
+                    const double dfNewR = padfReal[iCol];
+                    const double dfNewI = padfImag[iCol];
+
+                    padfOut[2 * iCol] = dfOldR * dfNewR - dfOldI * dfNewI;
+                    padfOut[2 * iCol + 1] = dfOldR * dfNewI + dfOldI * dfNewR;
                 }
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+            }
+            else
+            {
+                for( int iCol = 0; iCol < nXSize; ++iCol )
+                    padfOut[iCol] *= padfReal[iCol];
             }
         }
+
+        StoreLine(padfOut, bComplex, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -561,54 +575,49 @@ static CPLErr CMulPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfReal0, adfImag0, adfReal1, adfImag1, adfOut;
+    if( !AllocLineBuffer(adfReal0, nXSize, 1) ||
+        !AllocLineBuffer(adfReal1, nXSize, 1) ||
+        (bComplex && !AllocLineBuffer(adfImag0, nXSize, 1)) ||
+        (bComplex && !AllocLineBuffer(adfImag1, nXSize, 1)) ||
+        !AllocLineBuffer(adfOut, nXSize, 2) )
+        return CE_Failure;
+
     /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal0 = papoSources[0];
-        const void * const pImag0 =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-        const void * const pReal1 = papoSources[1];
-        const void * const pImag1 =
-            static_cast<GByte *>(papoSources[1]) + nOffset;
-
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal0 = SRCVAL(pReal0, eSrcType, ii);
-                const double dfReal1 = SRCVAL(pReal1, eSrcType, ii);
-                const double dfImag0 = SRCVAL(pImag0, eSrcType, ii);
-                const double dfImag1 = SRCVAL(pImag1, eSrcType, ii);
-                const double adfPixVal[2] = {
-                    dfReal0 * dfReal1 + dfImag0 * dfImag1,
-                    dfReal1 * dfImag0 - dfReal0 * dfImag1
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        const double *padfReal0 = adfReal0.data();
+        const double *padfReal1 = adfReal1.data();
+        double *padfOut = adfOut.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       adfReal0.data());
+        LoadSourceLine(papoSources[1], eSrcType, nXSize, iLine, false,
+                       adfReal1.data());
+        if( bComplex )
+        {
+            const double *padfImag0 = adfImag0.data();
+            const double *padfImag1 = adfImag1.data();
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                           adfImag0.data());
+            LoadSourceLine(papoSources[1], eSrcType, nXSize, iLine, true,
+                           adfImag1.data());
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                padfOut[2 * iCol] = padfReal0[iCol] * padfReal1[iCol]
+                                  + padfImag0[iCol] * padfImag1[iCol];
+                padfOut[2 * iCol + 1] = padfReal1[iCol] * padfImag0[iCol]
+                                      - padfReal0[iCol] * padfImag1[iCol];
             }
         }
-    }
-    else
-    {
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double adfPixVal[2] = {
-                    SRCVAL(papoSources[0], eSrcType, ii)
-                    * SRCVAL(papoSources[1], eSrcType, ii),
-                    0.0
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
+        else
+        {
+            // Not complex.
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                padfOut[2 * iCol] = padfReal0[iCol] * padfReal1[iCol];
+                padfOut[2 * iCol + 1] = 0.0;
             }
         }
+        StoreLine(padfOut, true, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -623,44 +632,41 @@ static CPLErr InvPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfReal, adfImag, adfOut;
+    if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+        (bComplex && !AllocLineBuffer(adfImag, nXSize, 1)) ||
+        (bComplex && !AllocLineBuffer(adfOut, nXSize, 2)) )
+        return CE_Failure;
+
     /* ---- Set pixels ---- */
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfReal = adfReal.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       padfReal);
+        if( bComplex )
+        {
+            const double *padfImag = adfImag.data();
+            double *padfOut = adfOut.data();
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                           adfImag.data());
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                const double dfReal = padfReal[iCol];
+                const double dfImag = padfImag[iCol];
                 const double dfAux = dfReal * dfReal + dfImag * dfImag;
-                const double adfPixVal[2] = { dfReal / dfAux, -dfImag / dfAux };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+                padfOut[2 * iCol] = dfReal / dfAux;
+                padfOut[2 * iCol + 1] = -dfImag / dfAux;
             }
+            StoreLine(padfOut, true, nXSize, iLine, pData, eBufType,
+                      nPixelSpace, nLineSpace);
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double dfPixVal =
-                    1.0 / SRCVAL(papoSources[0], eSrcType, ii);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            // Not complex.
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = 1.0 / padfReal[iCol];
+            StoreLine(padfReal, false, nXSize, iLine, pData, eBufType,
+                      nPixelSpace, nLineSpace);
         }
     }
 
@@ -676,44 +682,34 @@ static CPLErr IntensityPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfReal, adfImag;
+    if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+        (bComplex && !AllocLineBuffer(adfImag, nXSize, 1)) )
+        return CE_Failure;
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal = dfReal * dfReal + dfImag * dfImag;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfReal = adfReal.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       padfReal);
+        if( bComplex )
+        {
+            const double *padfImag = adfImag.data();
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                           adfImag.data());
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                padfReal[iCol] = padfReal[iCol] * padfReal[iCol] +
+                                 padfImag[iCol] * padfImag[iCol];
             }
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                double dfPixVal = SRCVAL(papoSources[0], eSrcType, ii);
-                dfPixVal *= dfPixVal;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
+        else
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] *= padfReal[iCol];
         }
+        StoreLine(padfReal, false, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -729,18 +725,19 @@ static CPLErr SqrtPixelFunc( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double dfPixVal =
-                sqrt( SRCVAL(papoSources[0], eSrcType, ii) );
+    std::vector<double> adfLine;
+    if( !AllocLineBuffer(adfLine, nXSize, 1) )
+        return CE_Failure;
 
-            GDALCopyWords(
-                &dfPixVal, GDT_Float64, 0,
-                static_cast<GByte *>(pData) + nLineSpace * iLine +
-                iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfLine = adfLine.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       padfLine);
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfLine[iCol] = sqrt(padfLine[iCol]);
+        StoreLine(padfLine, false, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -758,47 +755,36 @@ static CPLErr Log10PixelFuncHelper( void **papoSources, int nSources,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
-    if( GDALDataTypeIsComplex( eSrcType ) )
-    {
-        // Complex input datatype.
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex( eSrcType ));
+    std::vector<double> adfReal, adfImag;
+    if( !AllocLineBuffer(adfReal, nXSize, 1) ||
+        (bComplex && !AllocLineBuffer(adfImag, nXSize, 1)) )
+        return CE_Failure;
 
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal =
-                    fact * log10( sqrt( dfReal * dfReal + dfImag * dfImag ) );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfReal = adfReal.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       padfReal);
+        if( bComplex )
+        {
+            // Complex input datatype.
+            const double *padfImag = adfImag.data();
+            LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, true,
+                           adfImag.data());
+            for( int iCol = 0; iCol < nXSize; ++iCol ) {
+                padfReal[iCol] =
+                    fact * log10( sqrt( padfReal[iCol] * padfReal[iCol] +
+                                        padfImag[iCol] * padfImag[iCol] ) );
             }
         }
-    }
-    else
-    {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfPixVal =
-                    fact * log10( fabs(
-                        SRCVAL(papoSources[0], eSrcType, ii) ) );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        else
+        {
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = fact * log10( fabs( padfReal[iCol] ) );
         }
+        StoreLine(padfReal, false, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -835,18 +821,19 @@ static CPLErr PowPixelFuncHelper( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double dfPixVal =
-                pow(base, SRCVAL(papoSources[0], eSrcType, ii) / fact);
+    std::vector<double> adfLine;
+    if( !AllocLineBuffer(adfLine, nXSize, 1) )
+        return CE_Failure;
 
-            GDALCopyWords(
-                &dfPixVal, GDT_Float64, 0,
-                static_cast<GByte *>(pData) + nLineSpace * iLine +
-                iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        double *padfLine = adfLine.data();
+        LoadSourceLine(papoSources[0], eSrcType, nXSize, iLine, false,
+                       padfLine);
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfLine[iCol] = pow(base, padfLine[iCol] / fact);
+        StoreLine(padfLine, false, nXSize, iLine, pData, eBufType,
+                  nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -99,6 +99,7 @@ VRTDataset::~VRTDataset()
 
 {
     VRTDataset::FlushCache();
+    CloseSourceDatasetCaches();
     if( m_poSRS )
         m_poSRS->Release();
     if( m_poGCP_SRS )
@@ -870,11 +871,15 @@ GDALDataset *VRTDataset::OpenXML( const char *pszXML, const char *pszVRTPath,
  /* -------------------------------------------------------------------- */
  /*      Parse the XML.                                                  */
  /* -------------------------------------------------------------------- */
-    CPLXMLTreeCloser psTree(CPLParseXMLString( pszXML ));
+    // The tree is only read by the XMLInit() methods, so it can live in an
+    // arena, which is much faster for VRTs with many sources.
+    CPLXMLArena *hArena = nullptr;
+    CPLXMLNode *psTree = CPLParseXMLStringInArena( pszXML, &hArena );
+    CPLXMLArenaUniquePtr poArena(hArena);
     if( psTree == nullptr )
         return nullptr;
 
-    CPLXMLNode *psRoot = CPLGetXMLNode( psTree.get(), "=VRTDataset" );
+    CPLXMLNode *psRoot = CPLGetXMLNode( psTree, "=VRTDataset" );
     if( psRoot == nullptr )
     {
         CPLError( CE_Failure, CPLE_AppDefined,
@@ -1284,6 +1289,8 @@ int VRTDataset::CloseDependentDatasets()
     /* we would remove them from the serizalized VRT */
     FlushCache();
 
+    CloseSourceDatasetCaches();
+
     int bHasDroppedRef = GDALDataset::CloseDependentDatasets();
 
     for( int iBand = 0; iBand < nBands; iBand++ )
@@ -34,6 +34,7 @@
 #ifndef DOXYGEN_SKIP
 
 #include "cpl_hash_set.h"
+#include "cpl_quad_tree.h"
 #include "gdal_pam.h"
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -154,6 +155,8 @@ template<class T> struct VRTFlushCacheStruct
 
 class VRTWarpedDataset;
 class VRTPansharpenedDataset;
+class VRTSourceDatasetCache;
+class CPLJobQueue;
 
 class CPL_DLL VRTDataset : public GDALDataset
 {
@@ -162,6 +165,7 @@ class CPL_DLL VRTDataset : public GDALDataset
     friend struct VRTFlushCacheStruct<VRTWarpedDataset>;
     friend struct VRTFlushCacheStruct<VRTPansharpenedDataset>;
     friend class VRTSourcedRasterBand;
+    friend class VRTDerivedRasterBand;
 
     OGRSpatialReference* m_poSRS = nullptr;
 
@@ -189,6 +193,15 @@ class CPL_DLL VRTDataset : public GDALDataset
 
     std::map<CPLString, GDALDataset*> m_oMapSharedSources;
 
+    // Used by the multi-threaded VRTSourcedRasterBand::IRasterIO()
+    int                  m_nNumThreads = -1;
+    CPLJobQueue         *m_poJobQueue = nullptr;
+    std::vector<VRTSourceDatasetCache*> m_apoSourceDatasetCaches{};
+
+    int                  GetNumThreads();
+    CPLJobQueue         *GetJobQueue();
+    void                 CloseSourceDatasetCaches();
+
     VRTRasterBand*      InitBand(const char* pszSubclass, int nBand,
                                  bool bAllowPansharpened);
 
@@ -547,8 +560,28 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
     CPLString      m_osLastLocationInfo;
     char         **m_papszSourceList;
 
+    // Spatial index of the destination windows of the sources, built on
+    // first use when there are many sources.
+    CPLQuadTree   *m_hSourcesQuadTree = nullptr;
+    int            m_nSourcesInQuadTree = 0;
+    std::vector<int> m_anQuadTreeSourceIdx{};
+    std::vector<int> m_anUnindexedSources{};
+
     bool           CanUseSourcesMinMaxImplementations();
     void           CheckSource( VRTSimpleSource *poSS );
+    void           InvalidateSourcesQuadTree();
+    void           GetSourcesInWindow( int nXOff, int nYOff,
+                                       int nXSize, int nYSize,
+                                       std::vector<int>& anSources );
+    bool           MultiThreadedSourcesRasterIO(
+                                    const std::vector<int>& anSources,
+                                    int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void *pData, int nBufXSize, int nBufYSize,
+                                    GDALDataType eBufType,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GDALRasterIOExtraArg* psExtraArg,
+                                    CPLErr& eErr );
 
     CPL_DISALLOW_COPY_ASSIGN(VRTSourcedRasterBand)
 
@@ -876,6 +909,32 @@ protected:
     CPLString           m_osSourceFileNameOri;
     int                 m_nExplicitSharedStatus; // -1 unknown, 0 = unshared, 1 = shared
 
+    // Properties from the <SourceProperties> element of the VRT XML.
+    // The proxy dataset of the source is only created from them on the
+    // first access to the source band, so that opening a VRT with a huge
+    // number of sources does not allocate a dataset object per source.
+    struct DeferredProxySource
+    {
+        CPLString     osSrcDSName{};
+        int           nSrcBand = 0;
+        bool          bGetMaskBand = false;
+        bool          bShared = false;
+        int           nRasterXSize = 0;
+        int           nRasterYSize = 0;
+        GDALDataType  eDataType = GDT_Unknown;
+        int           nBlockXSize = 0;
+        int           nBlockYSize = 0;
+        CPLStringList aosOpenOptions{};
+        CPLString     osUniqueHandle{};
+        GIntBig       nResponsiblePID = 0;
+    };
+    std::unique_ptr<DeferredProxySource> m_poDeferredSource{};
+
+    bool                InstantiateSource();
+    int                 GetSrcRasterXSize();
+    int                 GetSrcRasterYSize();
+    GDALDataType        GetSrcRasterDataType();
+
     int                 NeedMaxValAdjustment() const;
 
 public:
@@ -939,7 +998,7 @@ public:
     virtual CPLErr FlushCache() override;
 
     GDALRasterBand* GetBand();
-    GDALRasterBand* GetMaskBandMainBand() { return m_poMaskBandMainBand; }
+    GDALRasterBand* GetMaskBandMainBand();
     int             IsSameExceptBandNumber( VRTSimpleSource* poOtherSource );
     CPLErr          DatasetRasterIO(
                                GDALDataType eBandDataType,
@@ -31,6 +31,7 @@
 #include "cpl_minixml.h"
 #include "cpl_string.h"
 #include "vrtdataset.h"
+#include "vrtexpression.h"
 #include "cpl_multiproc.h"
 #include "cpl_spawn.h"
 
@@ -890,6 +891,7 @@ class VRTDerivedRasterBandPrivateData
         bool      m_bExclusiveLock;
         bool      m_bFirstTime;
         std::vector< std::pair<CPLString,CPLString> > m_oFunctionArgs;
+        std::unique_ptr<VRTExpression> m_poExpression{};
 
         VRTDerivedRasterBandPrivateData():
             m_osLanguage("C"),
@@ -1593,9 +1595,12 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     }
 
     const int nBufTypeSize = GDALGetDataTypeSizeBytes(eBufType);
+    const bool bIsExpression =
+        EQUAL(m_poPrivate->m_osLanguage, "Expression");
     GDALDataType eSrcType = eSourceTransferType;
     if( eSrcType == GDT_Unknown || eSrcType >= GDT_TypeCount ) {
-        eSrcType = eBufType;
+        // Expressions are evaluated in double precision.
+        eSrcType = bIsExpression ? GDT_Float64 : eBufType;
     }
     const int nSrcTypeSize = GDALGetDataTypeSizeBytes(eSrcType);
 
@@ -1654,6 +1659,13 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return CE_Failure;
         }
     }
+    else if( bIsExpression && m_poPrivate->m_poExpression == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "VRTDerivedRasterBand::IRasterIO: "
+                  "no PixelFunctionCode expression defined." );
+        return CE_Failure;
+    }
 
     /* TODO: It would be nice to use a MallocBlock function for each
        individual buffer that would recycle blocks of memory from a
@@ -1982,6 +1994,20 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             VSIFree(pabyTmpBuffer);
         }
     }
+    else if( eErr == CE_None && bIsExpression )
+    {
+        // The evaluation is CPU bound, so use the threads of the dataset
+        // if NUM_THREADS / GDAL_NUM_THREADS allow for it.
+        VRTDataset* poVRTDS = dynamic_cast<VRTDataset*>(poDS);
+        CPLJobQueue* poJobQueue =
+            poVRTDS != nullptr && poVRTDS->GetNumThreads() > 1 ?
+                poVRTDS->GetJobQueue() : nullptr;
+        eErr = m_poPrivate->m_poExpression->Evaluate(
+            pBuffers, eSrcType, nSources,
+            pData, nBufXSize, nBufYSize,
+            eDataType, eBufType, nPixelSpace, nLineSpace,
+            poJobQueue, poJobQueue ? poVRTDS->GetNumThreads() : 1 );
+    }
     else if( eErr == CE_None && pfnPixelFunc != nullptr ) {
         eErr = pfnPixelFunc( reinterpret_cast<void **>( pBuffers ), nSources,
                              pData, nBufXSize, nBufYSize,
@@ -2030,35 +2056,64 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
     if( eErr != CE_None )
         return eErr;
 
-    // Read derived pixel function type.
-    SetPixelFunctionName( CPLGetXMLValue( psTree, "PixelFunctionType", nullptr ) );
-    if( pszFuncName == nullptr || EQUAL(pszFuncName, "") )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "PixelFunctionType missing");
-        return CE_Failure;
-    }
-
     m_poPrivate->m_osLanguage = CPLGetXMLValue( psTree,
                                                 "PixelFunctionLanguage", "C" );
     if( !EQUAL(m_poPrivate->m_osLanguage, "C") &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") &&
+        !EQUAL(m_poPrivate->m_osLanguage, "Expression") )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
                  "Unsupported PixelFunctionLanguage");
         return CE_Failure;
     }
+    const bool bIsExpression =
+        EQUAL(m_poPrivate->m_osLanguage, "Expression");
+
+    // Read derived pixel function type.
+    SetPixelFunctionName( CPLGetXMLValue( psTree, "PixelFunctionType", nullptr ) );
+    if( (pszFuncName == nullptr || EQUAL(pszFuncName, "")) && !bIsExpression )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "PixelFunctionType missing");
+        return CE_Failure;
+    }
 
     m_poPrivate->m_osCode =
                         CPLGetXMLValue( psTree, "PixelFunctionCode", "" );
     if( !m_poPrivate->m_osCode.empty() &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") && !bIsExpression )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
-                 "PixelFunctionCode can only be used with Python");
+                 "PixelFunctionCode can only be used with Python or "
+                 "Expression");
         return CE_Failure;
     }
 
+    if( bIsExpression )
+    {
+        if( m_poPrivate->m_osCode.empty() )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "PixelFunctionCode missing");
+            return CE_Failure;
+        }
+        m_poPrivate->m_poExpression.reset(new VRTExpression());
+        if( !m_poPrivate->m_poExpression->Compile(m_poPrivate->m_osCode) )
+        {
+            m_poPrivate->m_poExpression.reset();
+            return CE_Failure;
+        }
+        if( m_poPrivate->m_poExpression->GetMaxSourceIndex() > nSources )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "PixelFunctionCode references B%d, but there are only "
+                     "%d sources",
+                     m_poPrivate->m_poExpression->GetMaxSourceIndex(),
+                     nSources);
+            return CE_Failure;
+        }
+    }
+
     m_poPrivate->m_nBufferRadius =
                         atoi(CPLGetXMLValue( psTree, "BufferRadius", "0" ));
     if( m_poPrivate->m_nBufferRadius < 0 ||
@@ -399,6 +399,9 @@ void GDALRegister_VRT()
 "  <Option name='ROOT_PATH' type='string' description='Root path to evaluate "
 "relative paths inside the VRT. Mainly useful for inlined VRT, or in-memory "
 "VRT, where their own directory does not make sense'/>"
+"  <Option name='NUM_THREADS' type='string' description='Number of worker "
+"threads for reading sources in parallel. Can be set to ALL_CPUS' "
+"default='1'/>"
 "</OptionList>" );
 
     poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
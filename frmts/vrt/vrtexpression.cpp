@@ -0,0 +1,911 @@
+/******************************************************************************
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Compiled expressions for VRTDerivedRasterBand.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "vrtexpression.h"
+
+#include "cpl_error.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+CPL_CVSID("$Id$")
+
+/*! @cond Doxygen_Suppress */
+
+constexpr int VRTExpression::CHUNK_SIZE;
+
+typedef VRTExpression::Op VRTExprOp;
+typedef VRTExpression::Instr VRTExprInstr;
+
+/************************************************************************/
+/*                          VRTExprOpArity()                            */
+/************************************************************************/
+
+static int VRTExprOpArity( VRTExprOp eOp )
+{
+    switch( eOp )
+    {
+        case VRTExprOp::PUSH_CONST:
+        case VRTExprOp::PUSH_SOURCE:
+            return 0;
+        case VRTExprOp::ADD: case VRTExprOp::SUB: case VRTExprOp::MUL:
+        case VRTExprOp::DIV: case VRTExprOp::MOD: case VRTExprOp::POW:
+        case VRTExprOp::LT: case VRTExprOp::LE: case VRTExprOp::GT:
+        case VRTExprOp::GE: case VRTExprOp::EQ: case VRTExprOp::NE:
+        case VRTExprOp::AND: case VRTExprOp::OR:
+        case VRTExprOp::ATAN2: case VRTExprOp::MIN: case VRTExprOp::MAX:
+            return 2;
+        case VRTExprOp::COND:
+            return 3;
+        default:
+            break;
+    }
+    return 1;
+}
+
+/************************************************************************/
+/*                           VRTExprApplyOp()                           */
+/*                                                                      */
+/*      Apply an operator to nCount values of its operands. Each        */
+/*      case is a plain loop, which lets the compiler vectorize the     */
+/*      arithmetic ones.                                                */
+/************************************************************************/
+
+#define VRT_EXPR_UNARY(expr) \
+    { \
+        const double* padfA = papadfIn[0]; \
+        for( int i = 0; i < nCount; i++ ) \
+        { \
+            const double x = padfA[i]; \
+            padfOut[i] = (expr); \
+        } \
+        break; \
+    }
+
+#define VRT_EXPR_BINARY(expr) \
+    { \
+        const double* padfA = papadfIn[0]; \
+        const double* padfB = papadfIn[1]; \
+        for( int i = 0; i < nCount; i++ ) \
+        { \
+            const double x = padfA[i]; \
+            const double y = padfB[i]; \
+            padfOut[i] = (expr); \
+        } \
+        break; \
+    }
+
+static void VRTExprApplyOp( VRTExprOp eOp, const double* const* papadfIn,
+                            double* padfOut, int nCount )
+{
+    switch( eOp )
+    {
+        case VRTExprOp::PUSH_CONST:
+        case VRTExprOp::PUSH_SOURCE:
+            CPLAssert(false);
+            break;
+
+        case VRTExprOp::NEG:    VRT_EXPR_UNARY(-x)
+        case VRTExprOp::NOT:    VRT_EXPR_UNARY(x == 0.0 ? 1.0 : 0.0)
+        case VRTExprOp::ABS:    VRT_EXPR_UNARY(std::fabs(x))
+        case VRTExprOp::SQRT:   VRT_EXPR_UNARY(std::sqrt(x))
+        case VRTExprOp::EXP:    VRT_EXPR_UNARY(std::exp(x))
+        case VRTExprOp::LOG:    VRT_EXPR_UNARY(std::log(x))
+        case VRTExprOp::LOG10:  VRT_EXPR_UNARY(std::log10(x))
+        case VRTExprOp::SIN:    VRT_EXPR_UNARY(std::sin(x))
+        case VRTExprOp::COS:    VRT_EXPR_UNARY(std::cos(x))
+        case VRTExprOp::TAN:    VRT_EXPR_UNARY(std::tan(x))
+        case VRTExprOp::ASIN:   VRT_EXPR_UNARY(std::asin(x))
+        case VRTExprOp::ACOS:   VRT_EXPR_UNARY(std::acos(x))
+        case VRTExprOp::ATAN:   VRT_EXPR_UNARY(std::atan(x))
+        case VRTExprOp::FLOOR:  VRT_EXPR_UNARY(std::floor(x))
+        case VRTExprOp::CEIL:   VRT_EXPR_UNARY(std::ceil(x))
+        case VRTExprOp::ROUND:  VRT_EXPR_UNARY(std::round(x))
+        case VRTExprOp::ISNAN:  VRT_EXPR_UNARY(std::isnan(x) ? 1.0 : 0.0)
+
+        case VRTExprOp::ADD:    VRT_EXPR_BINARY(x + y)
+        case VRTExprOp::SUB:    VRT_EXPR_BINARY(x - y)
+        case VRTExprOp::MUL:    VRT_EXPR_BINARY(x * y)
+        case VRTExprOp::DIV:    VRT_EXPR_BINARY(x / y)
+        case VRTExprOp::MOD:    VRT_EXPR_BINARY(std::fmod(x, y))
+        case VRTExprOp::POW:    VRT_EXPR_BINARY(std::pow(x, y))
+        case VRTExprOp::LT:     VRT_EXPR_BINARY(x < y ? 1.0 : 0.0)
+        case VRTExprOp::LE:     VRT_EXPR_BINARY(x <= y ? 1.0 : 0.0)
+        case VRTExprOp::GT:     VRT_EXPR_BINARY(x > y ? 1.0 : 0.0)
+        case VRTExprOp::GE:     VRT_EXPR_BINARY(x >= y ? 1.0 : 0.0)
+        case VRTExprOp::EQ:     VRT_EXPR_BINARY(x == y ? 1.0 : 0.0)
+        case VRTExprOp::NE:     VRT_EXPR_BINARY(x != y ? 1.0 : 0.0)
+        case VRTExprOp::AND:
+            VRT_EXPR_BINARY(x != 0.0 && y != 0.0 ? 1.0 : 0.0)
+        case VRTExprOp::OR:
+            VRT_EXPR_BINARY(x != 0.0 || y != 0.0 ? 1.0 : 0.0)
+        case VRTExprOp::ATAN2:  VRT_EXPR_BINARY(std::atan2(x, y))
+        case VRTExprOp::MIN:    VRT_EXPR_BINARY(y < x ? y : x)
+        case VRTExprOp::MAX:    VRT_EXPR_BINARY(y > x ? y : x)
+
+        case VRTExprOp::COND:
+        {
+            const double* padfCond = papadfIn[0];
+            const double* padfA = papadfIn[1];
+            const double* padfB = papadfIn[2];
+            for( int i = 0; i < nCount; i++ )
+                padfOut[i] = padfCond[i] != 0.0 ? padfA[i] : padfB[i];
+            break;
+        }
+    }
+}
+
+#undef VRT_EXPR_UNARY
+#undef VRT_EXPR_BINARY
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          VRTExpressionParser                         */
+/* ==================================================================== */
+/************************************************************************/
+
+// Recursive descent parser emitting the byte code in postfix order.
+// Precedence, from lowest to highest:
+//   ?: , || , && , == != , < <= > >= , + - , * / % , unary - + ! , ^
+
+namespace {
+
+class VRTExpressionParser
+{
+        const char*                  m_pszExpr;
+        const char*                  m_pszCur;
+        std::vector<VRTExprInstr>&   m_aoCode;
+        int                          m_nDepth = 0;
+        int                          m_nMaxDepth = 0;
+        int                          m_nMaxSourceIdx = 0;
+        int                          m_nNesting = 0;
+        bool                         m_bError = false;
+
+        void SkipSpaces();
+        bool Accept( const char* pszToken );
+        void Error( const char* pszMsg );
+        void Emit( VRTExprOp eOp, int nArg = 0, double dfValue = 0.0 );
+
+        void ParseTernary();
+        void ParseOr();
+        void ParseAnd();
+        void ParseEquality();
+        void ParseRelational();
+        void ParseAdditive();
+        void ParseMultiplicative();
+        void ParseUnary();
+        void ParsePower();
+        void ParsePrimary();
+
+    public:
+        VRTExpressionParser( const char* pszExpr,
+                             std::vector<VRTExprInstr>& aoCode ) :
+            m_pszExpr(pszExpr), m_pszCur(pszExpr), m_aoCode(aoCode) {}
+
+        bool Parse();
+        int  GetMaxDepth() const { return m_nMaxDepth; }
+        int  GetMaxSourceIdx() const { return m_nMaxSourceIdx; }
+};
+
+/************************************************************************/
+/*                             SkipSpaces()                             */
+/************************************************************************/
+
+void VRTExpressionParser::SkipSpaces()
+{
+    while( *m_pszCur == ' ' || *m_pszCur == '\t' ||
+           *m_pszCur == '\n' || *m_pszCur == '\r' )
+        m_pszCur++;
+}
+
+/************************************************************************/
+/*                               Accept()                               */
+/************************************************************************/
+
+bool VRTExpressionParser::Accept( const char* pszToken )
+{
+    SkipSpaces();
+    const size_t nLen = strlen(pszToken);
+    if( strncmp(m_pszCur, pszToken, nLen) != 0 )
+        return false;
+    // Do not take the '<' of '<=', or the '!' of '!=' for instance.
+    if( nLen == 1 && m_pszCur[1] == '=' && strchr("<>!=", pszToken[0]) )
+        return false;
+    m_pszCur += nLen;
+    return true;
+}
+
+/************************************************************************/
+/*                               Error()                                */
+/************************************************************************/
+
+void VRTExpressionParser::Error( const char* pszMsg )
+{
+    if( !m_bError )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Invalid expression '%s' at offset %d: %s",
+                  m_pszExpr, static_cast<int>(m_pszCur - m_pszExpr),
+                  pszMsg );
+        m_bError = true;
+    }
+}
+
+/************************************************************************/
+/*                                Emit()                                */
+/*                                                                      */
+/*      Append an instruction. Operators whose operands are all         */
+/*      constants are evaluated right away.                             */
+/************************************************************************/
+
+void VRTExpressionParser::Emit( VRTExprOp eOp, int nArg, double dfValue )
+{
+    if( m_bError )
+        return;
+
+    const int nArity = VRTExprOpArity(eOp);
+    if( eOp != VRTExprOp::PUSH_CONST && eOp != VRTExprOp::PUSH_SOURCE &&
+        static_cast<int>(m_aoCode.size()) >= nArity )
+    {
+        bool bAllConstants = true;
+        double adfIn[3] = { 0.0, 0.0, 0.0 };
+        const double* apadfIn[3] = { &adfIn[0], &adfIn[1], &adfIn[2] };
+        const size_t nFirst = m_aoCode.size() - nArity;
+        for( int i = 0; i < nArity; i++ )
+        {
+            if( m_aoCode[nFirst + i].eOp != VRTExprOp::PUSH_CONST )
+            {
+                bAllConstants = false;
+                break;
+            }
+            adfIn[i] = m_aoCode[nFirst + i].dfValue;
+        }
+        if( bAllConstants )
+        {
+            double dfOut = 0.0;
+            VRTExprApplyOp(eOp, apadfIn, &dfOut, 1);
+            m_aoCode.resize(nFirst);
+            m_nDepth -= nArity;
+            Emit(VRTExprOp::PUSH_CONST, 0, dfOut);
+            return;
+        }
+    }
+
+    VRTExprInstr sInstr;
+    sInstr.eOp = eOp;
+    sInstr.nArg = nArg;
+    sInstr.dfValue = dfValue;
+    m_aoCode.push_back(sInstr);
+    m_nDepth += 1 - nArity;
+    m_nMaxDepth = std::max(m_nMaxDepth, m_nDepth);
+}
+
+/************************************************************************/
+/*                                Parse()                               */
+/************************************************************************/
+
+bool VRTExpressionParser::Parse()
+{
+    ParseTernary();
+    SkipSpaces();
+    if( !m_bError && *m_pszCur != '\0' )
+        Error("unexpected character");
+    return !m_bError;
+}
+
+/************************************************************************/
+/*                            ParseTernary()                            */
+/************************************************************************/
+
+void VRTExpressionParser::ParseTernary()
+{
+    // Prevent stack overflows on pathological input.
+    if( ++m_nNesting > 256 )
+    {
+        Error("too many nested sub-expressions");
+        return;
+    }
+    ParseOr();
+    if( !m_bError && Accept("?") )
+    {
+        ParseTernary();
+        if( !m_bError && !Accept(":") )
+            Error("':' expected");
+        ParseTernary();
+        Emit(VRTExprOp::COND);
+    }
+    m_nNesting--;
+}
+
+/************************************************************************/
+/*                       Binary operator levels.                        */
+/************************************************************************/
+
+void VRTExpressionParser::ParseOr()
+{
+    ParseAnd();
+    while( !m_bError && Accept("||") )
+    {
+        ParseAnd();
+        Emit(VRTExprOp::OR);
+    }
+}
+
+void VRTExpressionParser::ParseAnd()
+{
+    ParseEquality();
+    while( !m_bError && Accept("&&") )
+    {
+        ParseEquality();
+        Emit(VRTExprOp::AND);
+    }
+}
+
+void VRTExpressionParser::ParseEquality()
+{
+    ParseRelational();
+    while( !m_bError )
+    {
+        VRTExprOp eOp;
+        if( Accept("==") )
+            eOp = VRTExprOp::EQ;
+        else if( Accept("!=") )
+            eOp = VRTExprOp::NE;
+        else
+            break;
+        ParseRelational();
+        Emit(eOp);
+    }
+}
+
+void VRTExpressionParser::ParseRelational()
+{
+    ParseAdditive();
+    while( !m_bError )
+    {
+        VRTExprOp eOp;
+        if( Accept("<=") )
+            eOp = VRTExprOp::LE;
+        else if( Accept(">=") )
+            eOp = VRTExprOp::GE;
+        else if( Accept("<") )
+            eOp = VRTExprOp::LT;
+        else if( Accept(">") )
+            eOp = VRTExprOp::GT;
+        else
+            break;
+        ParseAdditive();
+        Emit(eOp);
+    }
+}
+
+void VRTExpressionParser::ParseAdditive()
+{
+    ParseMultiplicative();
+    while( !m_bError )
+    {
+        VRTExprOp eOp;
+        if( Accept("+") )
+            eOp = VRTExprOp::ADD;
+        else if( Accept("-") )
+            eOp = VRTExprOp::SUB;
+        else
+            break;
+        ParseMultiplicative();
+        Emit(eOp);
+    }
+}
+
+void VRTExpressionParser::ParseMultiplicative()
+{
+    ParseUnary();
+    while( !m_bError )
+    {
+        VRTExprOp eOp;
+        if( Accept("*") )
+            eOp = VRTExprOp::MUL;
+        else if( Accept("/") )
+            eOp = VRTExprOp::DIV;
+        else if( Accept("%") )
+            eOp = VRTExprOp::MOD;
+        else
+            break;
+        ParseUnary();
+        Emit(eOp);
+    }
+}
+
+/************************************************************************/
+/*                             ParseUnary()                             */
+/************************************************************************/
+
+void VRTExpressionParser::ParseUnary()
+{
+    if( ++m_nNesting > 256 )
+    {
+        Error("too many nested sub-expressions");
+        return;
+    }
+    if( Accept("-") )
+    {
+        ParseUnary();
+        Emit(VRTExprOp::NEG);
+    }
+    else if( Accept("+") )
+    {
+        ParseUnary();
+    }
+    else if( Accept("!") )
+    {
+        ParseUnary();
+        Emit(VRTExprOp::NOT);
+    }
+    else
+    {
+        ParsePower();
+    }
+    m_nNesting--;
+}
+
+/************************************************************************/
+/*                             ParsePower()                             */
+/************************************************************************/
+
+void VRTExpressionParser::ParsePower()
+{
+    ParsePrimary();
+    // Right associative, and binds tighter than the unary minus on its
+    // left: -B1^2 is -(B1^2), B1^-2 is B1^(-2).
+    if( !m_bError && Accept("^") )
+    {
+        ParseUnary();
+        Emit(VRTExprOp::POW);
+    }
+}
+
+/************************************************************************/
+/*                            ParsePrimary()                            */
+/************************************************************************/
+
+void VRTExpressionParser::ParsePrimary()
+{
+    static const struct
+    {
+        const char* pszName;
+        VRTExprOp   eOp;
+    } asFunctions[] = {
+        { "abs", VRTExprOp::ABS },
+        { "sqrt", VRTExprOp::SQRT },
+        { "exp", VRTExprOp::EXP },
+        { "log10", VRTExprOp::LOG10 },
+        { "log", VRTExprOp::LOG },
+        { "sin", VRTExprOp::SIN },
+        { "cos", VRTExprOp::COS },
+        { "tan", VRTExprOp::TAN },
+        { "asin", VRTExprOp::ASIN },
+        { "acos", VRTExprOp::ACOS },
+        { "atan2", VRTExprOp::ATAN2 },
+        { "atan", VRTExprOp::ATAN },
+        { "floor", VRTExprOp::FLOOR },
+        { "ceil", VRTExprOp::CEIL },
+        { "round", VRTExprOp::ROUND },
+        { "isnan", VRTExprOp::ISNAN },
+        { "pow", VRTExprOp::POW },
+        { "min", VRTExprOp::MIN },
+        { "max", VRTExprOp::MAX },
+    };
+
+    SkipSpaces();
+
+/* -------------------------------------------------------------------- */
+/*      Parenthesized sub-expression.                                   */
+/* -------------------------------------------------------------------- */
+    if( Accept("(") )
+    {
+        ParseTernary();
+        if( !m_bError && !Accept(")") )
+            Error("')' expected");
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Number.                                                         */
+/* -------------------------------------------------------------------- */
+    if( (*m_pszCur >= '0' && *m_pszCur <= '9') || *m_pszCur == '.' )
+    {
+        char* pszEnd = nullptr;
+        const double dfValue = CPLStrtod(m_pszCur, &pszEnd);
+        if( pszEnd == m_pszCur )
+        {
+            Error("invalid number");
+            return;
+        }
+        m_pszCur = pszEnd;
+        Emit(VRTExprOp::PUSH_CONST, 0, dfValue);
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Identifier: source, constant or function.                       */
+/* -------------------------------------------------------------------- */
+    const char* pszStart = m_pszCur;
+    while( (*m_pszCur >= 'a' && *m_pszCur <= 'z') ||
+           (*m_pszCur >= 'A' && *m_pszCur <= 'Z') ||
+           (*m_pszCur >= '0' && *m_pszCur <= '9') || *m_pszCur == '_' )
+        m_pszCur++;
+    const CPLString osName(pszStart, m_pszCur - pszStart);
+    if( osName.empty() )
+    {
+        Error("operand expected");
+        return;
+    }
+
+    if( (osName[0] == 'B' || osName[0] == 'b') && osName.size() > 1 &&
+        osName.size() <= 6 &&
+        strspn(osName.c_str() + 1, "0123456789") == osName.size() - 1 )
+    {
+        const int nIdx = atoi(osName.c_str() + 1);
+        if( nIdx < 1 )
+        {
+            m_pszCur = pszStart;
+            Error("source numbers start at 1");
+            return;
+        }
+        m_nMaxSourceIdx = std::max(m_nMaxSourceIdx, nIdx);
+        Emit(VRTExprOp::PUSH_SOURCE, nIdx - 1);
+        return;
+    }
+
+    if( EQUAL(osName, "pi") )
+    {
+        Emit(VRTExprOp::PUSH_CONST, 0, M_PI);
+        return;
+    }
+    if( EQUAL(osName, "nan") )
+    {
+        Emit(VRTExprOp::PUSH_CONST, 0,
+             std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+
+    for( const auto& sFunction: asFunctions )
+    {
+        if( !EQUAL(osName, sFunction.pszName) )
+            continue;
+        if( !Accept("(") )
+        {
+            Error("'(' expected after function name");
+            return;
+        }
+        const int nArity = VRTExprOpArity(sFunction.eOp);
+        for( int i = 0; i < nArity && !m_bError; i++ )
+        {
+            if( i > 0 && !Accept(",") )
+            {
+                Error("',' expected");
+                return;
+            }
+            ParseTernary();
+        }
+        if( !m_bError && !Accept(")") )
+            Error("')' expected");
+        Emit(sFunction.eOp);
+        return;
+    }
+
+    m_pszCur = pszStart;
+    Error(CPLSPrintf("unknown identifier '%s'", osName.c_str()));
+}
+
+} // namespace
+
+/************************************************************************/
+/* ==================================================================== */
+/*                            VRTExpression                             */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                              Compile()                               */
+/************************************************************************/
+
+bool VRTExpression::Compile( const char* pszExpression )
+{
+    m_osExpression = pszExpression;
+    m_aoCode.clear();
+    m_adfConstants.clear();
+    m_nMaxStackDepth = 0;
+    m_nMaxSourceIdx = 0;
+
+    VRTExpressionParser oParser(pszExpression, m_aoCode);
+    if( !oParser.Parse() )
+    {
+        m_aoCode.clear();
+        return false;
+    }
+    m_nMaxStackDepth = oParser.GetMaxDepth();
+    m_nMaxSourceIdx = oParser.GetMaxSourceIdx();
+
+    // Constants are expanded to a whole chunk once for all, so that every
+    // operand can be accessed the same way by the loops.
+    int nConstants = 0;
+    for( auto& sInstr: m_aoCode )
+    {
+        if( sInstr.eOp == Op::PUSH_CONST )
+            sInstr.nArg = nConstants++;
+    }
+    m_adfConstants.resize(static_cast<size_t>(nConstants) * CHUNK_SIZE);
+    for( const auto& sInstr: m_aoCode )
+    {
+        if( sInstr.eOp == Op::PUSH_CONST )
+        {
+            std::fill_n(m_adfConstants.begin() +
+                            static_cast<size_t>(sInstr.nArg) * CHUNK_SIZE,
+                        CHUNK_SIZE, sInstr.dfValue);
+        }
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                           EvaluateChunk()                            */
+/*                                                                      */
+/*      Run the byte code on nCount (<= CHUNK_SIZE) pixels.             */
+/*      papadfSources[i] points to the values of source i.              */
+/*      padfScratch has m_nMaxStackDepth * CHUNK_SIZE values, and       */
+/*      papadfStack m_nMaxStackDepth entries. Returns the result.       */
+/************************************************************************/
+
+const double *VRTExpression::EvaluateChunk(
+    const double* const* papadfSources, int nCount,
+    double* padfScratch, const double** papadfStack ) const
+{
+    int nDepth = 0;
+    for( const auto& sInstr: m_aoCode )
+    {
+        if( sInstr.eOp == Op::PUSH_CONST )
+        {
+            papadfStack[nDepth++] = m_adfConstants.data() +
+                static_cast<size_t>(sInstr.nArg) * CHUNK_SIZE;
+        }
+        else if( sInstr.eOp == Op::PUSH_SOURCE )
+        {
+            papadfStack[nDepth++] = papadfSources[sInstr.nArg];
+        }
+        else
+        {
+            // The result goes to the scratch area of the first operand,
+            // which is the only operand that may already use it.
+            const int nArity = VRTExprOpArity(sInstr.eOp);
+            nDepth -= nArity;
+            double* padfOut =
+                padfScratch + static_cast<size_t>(nDepth) * CHUNK_SIZE;
+            VRTExprApplyOp(sInstr.eOp, papadfStack + nDepth, padfOut, nCount);
+            papadfStack[nDepth++] = padfOut;
+        }
+    }
+    CPLAssert(nDepth == 1);
+    return papadfStack[0];
+}
+
+/************************************************************************/
+/*                           EvaluateLines()                            */
+/************************************************************************/
+
+void VRTExpression::EvaluateLines( const void* const* papSources,
+                                   GDALDataType eSrcType, int nSources,
+                                   void *pData, int nXSize,
+                                   int nYStart, int nYEnd,
+                                   GDALDataType eOutType,
+                                   GDALDataType eBufType,
+                                   GSpacing nPixelSpace,
+                                   GSpacing nLineSpace ) const
+{
+    const int nSrcTypeSize = GDALGetDataTypeSizeBytes(eSrcType);
+    const int nOutTypeSize = GDALGetDataTypeSizeBytes(eOutType);
+    const bool bDirectSources = eSrcType == GDT_Float64;
+    const int nUsedSources = std::min(nSources, m_nMaxSourceIdx);
+
+    std::vector<double> adfScratch(
+        static_cast<size_t>(m_nMaxStackDepth) * CHUNK_SIZE);
+    std::vector<double> adfSources(
+        bDirectSources ? 0 : static_cast<size_t>(nUsedSources) * CHUNK_SIZE);
+    std::vector<GByte> abyOut(
+        static_cast<size_t>(nOutTypeSize) * CHUNK_SIZE);
+    std::vector<const double*> apadfStack(m_nMaxStackDepth);
+    std::vector<const double*> apadfSources(nUsedSources);
+
+    for( int iY = nYStart; iY < nYEnd; iY++ )
+    {
+        GByte* pabyDstLine = static_cast<GByte*>(pData) + iY * nLineSpace;
+        for( int iX = 0; iX < nXSize; iX += CHUNK_SIZE )
+        {
+            const int nCount = std::min(CHUNK_SIZE, nXSize - iX);
+            const size_t nSrcOffset =
+                static_cast<size_t>(iY) * nXSize + iX;
+            for( int i = 0; i < nUsedSources; i++ )
+            {
+                if( bDirectSources )
+                {
+                    apadfSources[i] =
+                        static_cast<const double*>(papSources[i]) +
+                        nSrcOffset;
+                }
+                else
+                {
+                    double* padfSrc = adfSources.data() +
+                        static_cast<size_t>(i) * CHUNK_SIZE;
+                    GDALCopyWords(
+                        static_cast<const GByte*>(papSources[i]) +
+                            nSrcOffset * nSrcTypeSize,
+                        eSrcType, nSrcTypeSize,
+                        padfSrc, GDT_Float64, sizeof(double), nCount);
+                    apadfSources[i] = padfSrc;
+                }
+            }
+
+            const double* padfResult =
+                EvaluateChunk(apadfSources.data(), nCount,
+                              adfScratch.data(), apadfStack.data());
+
+            // Convert to the band data type first, so that the values
+            // are clamped/rounded as when reading a regular band.
+            GByte* pabyDst = pabyDstLine + iX * nPixelSpace;
+            if( eOutType == GDT_Float64 )
+            {
+                GDALCopyWords(padfResult, GDT_Float64, sizeof(double),
+                              pabyDst, eBufType,
+                              static_cast<int>(nPixelSpace), nCount);
+            }
+            else
+            {
+                GDALCopyWords(padfResult, GDT_Float64, sizeof(double),
+                              abyOut.data(), eOutType, nOutTypeSize, nCount);
+                GDALCopyWords(abyOut.data(), eOutType, nOutTypeSize,
+                              pabyDst, eBufType,
+                              static_cast<int>(nPixelSpace), nCount);
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                          VRTExpressionJob                            */
+/************************************************************************/
+
+struct VRTExpressionJob
+{
+    const VRTExpression* poExpr = nullptr;
+    const void* const*   papSources = nullptr;
+    GDALDataType         eSrcType = GDT_Unknown;
+    int                  nSources = 0;
+    void*                pData = nullptr;
+    int                  nXSize = 0;
+    int                  nYStart = 0;
+    int                  nYEnd = 0;
+    GDALDataType         eOutType = GDT_Unknown;
+    GDALDataType         eBufType = GDT_Unknown;
+    GSpacing             nPixelSpace = 0;
+    GSpacing             nLineSpace = 0;
+
+    static void Run( void* pData )
+    {
+        const VRTExpressionJob* psJob =
+            static_cast<const VRTExpressionJob*>(pData);
+        psJob->poExpr->EvaluateLines(
+            psJob->papSources, psJob->eSrcType, psJob->nSources,
+            psJob->pData, psJob->nXSize, psJob->nYStart, psJob->nYEnd,
+            psJob->eOutType, psJob->eBufType,
+            psJob->nPixelSpace, psJob->nLineSpace );
+    }
+};
+
+/************************************************************************/
+/*                              Evaluate()                              */
+/*                                                                      */
+/*      Evaluate the expression for a nXSize x nYSize buffer.           */
+/*      papSources[i] is the packed buffer of source i, in eSrcType.    */
+/*      Results are converted to eOutType (the band data type) and      */
+/*      then written in pData as eBufType. When poJobQueue is not       */
+/*      null, the lines are split among nThreads of its jobs.           */
+/************************************************************************/
+
+CPLErr VRTExpression::Evaluate( const void* const* papSources,
+                                GDALDataType eSrcType, int nSources,
+                                void *pData, int nXSize, int nYSize,
+                                GDALDataType eOutType,
+                                GDALDataType eBufType,
+                                GSpacing nPixelSpace, GSpacing nLineSpace,
+                                CPLJobQueue* poJobQueue,
+                                int nThreadsIn ) const
+{
+    if( m_aoCode.empty() )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Expression '%s' is not compiled",
+                  m_osExpression.c_str() );
+        return CE_Failure;
+    }
+    if( m_nMaxSourceIdx > nSources )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Expression '%s' references B%d, but there are only "
+                  "%d sources",
+                  m_osExpression.c_str(), m_nMaxSourceIdx, nSources );
+        return CE_Failure;
+    }
+
+    // Not worth dispatching small requests.
+    const int nThreads =
+        poJobQueue == nullptr ||
+        static_cast<GIntBig>(nXSize) * nYSize < 65536 ? 1 :
+        std::max(1, std::min(nThreadsIn, nYSize));
+
+    std::vector<VRTExpressionJob> asJobs(nThreads);
+    for( int i = 0; i < nThreads; i++ )
+    {
+        VRTExpressionJob& sJob = asJobs[i];
+        sJob.poExpr = this;
+        sJob.papSources = papSources;
+        sJob.eSrcType = eSrcType;
+        sJob.nSources = nSources;
+        sJob.pData = pData;
+        sJob.nXSize = nXSize;
+        sJob.nYStart = static_cast<int>(
+            static_cast<GIntBig>(nYSize) * i / nThreads);
+        sJob.nYEnd = static_cast<int>(
+            static_cast<GIntBig>(nYSize) * (i + 1) / nThreads);
+        sJob.eOutType = eOutType;
+        sJob.eBufType = eBufType;
+        sJob.nPixelSpace = nPixelSpace;
+        sJob.nLineSpace = nLineSpace;
+    }
+
+    if( nThreads == 1 )
+    {
+        VRTExpressionJob::Run(&asJobs[0]);
+    }
+    else
+    {
+        for( auto& sJob: asJobs )
+        {
+            if( !poJobQueue->SubmitJob(VRTExpressionJob::Run, &sJob) )
+                VRTExpressionJob::Run(&sJob);
+        }
+        poJobQueue->WaitCompletion();
+    }
+
+    return CE_None;
+}
+
+/*! @endcond */
@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Compiled expressions for VRTDerivedRasterBand.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef VRTEXPRESSION_H_INCLUDED
+#define VRTEXPRESSION_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "cpl_string.h"
+#include "gdal.h"
+
+#include <vector>
+
+class CPLJobQueue;
+
+/************************************************************************/
+/*                            VRTExpression                             */
+/************************************************************************/
+
+// Arithmetic expression over the sources of a derived band (B1, B2, ...).
+// The expression is compiled once into a stack based byte code, which is
+// then evaluated over chunks of pixels, so that each instruction is a
+// simple loop that the compiler can vectorize.
+
+class VRTExpression
+{
+  public:
+    enum class Op
+    {
+        PUSH_CONST,
+        PUSH_SOURCE,
+        NEG, NOT,
+        ABS, SQRT, EXP, LOG, LOG10, SIN, COS, TAN, ASIN, ACOS, ATAN,
+        FLOOR, CEIL, ROUND, ISNAN,
+        ADD, SUB, MUL, DIV, MOD, POW,
+        LT, LE, GT, GE, EQ, NE, AND, OR,
+        ATAN2, MIN, MAX,
+        COND
+    };
+
+    struct Instr
+    {
+        Op      eOp;
+        int     nArg;       // index of the source or of the constant chunk
+        double  dfValue;    // value of a constant
+    };
+
+    // Number of pixels processed by each instruction at once.
+    static constexpr int CHUNK_SIZE = 256;
+
+  private:
+    CPLString           m_osExpression{};
+    std::vector<Instr>  m_aoCode{};
+    std::vector<double> m_adfConstants{};
+    int                 m_nMaxStackDepth = 0;
+    int                 m_nMaxSourceIdx = 0;
+
+    friend struct VRTExpressionJob;
+
+    const double *EvaluateChunk( const double* const* papadfSources,
+                                 int nCount, double* padfScratch,
+                                 const double** papadfStack ) const;
+    void          EvaluateLines( const void* const* papSources,
+                                 GDALDataType eSrcType, int nSources,
+                                 void *pData, int nXSize,
+                                 int nYStart, int nYEnd,
+                                 GDALDataType eOutType,
+                                 GDALDataType eBufType,
+                                 GSpacing nPixelSpace,
+                                 GSpacing nLineSpace ) const;
+
+  public:
+    VRTExpression() = default;
+
+    bool                Compile( const char* pszExpression );
+    const CPLString&    GetExpression() const { return m_osExpression; }
+    int                 GetMaxSourceIndex() const { return m_nMaxSourceIdx; }
+
+    CPLErr              Evaluate( const void* const* papSources,
+                                  GDALDataType eSrcType, int nSources,
+                                  void *pData, int nXSize, int nYSize,
+                                  GDALDataType eOutType,
+                                  GDALDataType eBufType,
+                                  GSpacing nPixelSpace, GSpacing nLineSpace,
+                                  CPLJobQueue* poJobQueue,
+                                  int nThreads ) const;
+};
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
+#endif /* ndef VRTEXPRESSION_H_INCLUDED */
@@ -31,20 +31,26 @@
 #include "gdal_vrt.h"
 #include "vrtdataset.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_hash_set.h"
+#include "cpl_mem_cache.h"
 #include "cpl_minixml.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_geometry.h"
@@ -124,6 +130,252 @@ VRTSourcedRasterBand::~VRTSourcedRasterBand()
 {
     VRTSourcedRasterBand::CloseDependentDatasets();
     CSLDestroy(m_papszSourceList);
+    InvalidateSourcesQuadTree();
+}
+
+/************************************************************************/
+/*                     InvalidateSourcesQuadTree()                      */
+/************************************************************************/
+
+void VRTSourcedRasterBand::InvalidateSourcesQuadTree()
+{
+    if( m_hSourcesQuadTree )
+        CPLQuadTreeDestroy( m_hSourcesQuadTree );
+    m_hSourcesQuadTree = nullptr;
+    m_nSourcesInQuadTree = 0;
+    m_anQuadTreeSourceIdx.clear();
+    m_anUnindexedSources.clear();
+}
+
+/************************************************************************/
+/*                         GetSourcesInWindow()                         */
+/*                                                                      */
+/*      Return, in increasing order, the indices of the sources that    */
+/*      may intersect the passed window of the band.  For a few         */
+/*      sources, this is all of them.  Otherwise a quad tree of the     */
+/*      destination windows of the simple sources is built on first     */
+/*      use.                                                            */
+/************************************************************************/
+
+void VRTSourcedRasterBand::GetSourcesInWindow( int nXOff, int nYOff,
+                                               int nXSize, int nYSize,
+                                               std::vector<int>& anSources )
+{
+    anSources.clear();
+    constexpr int MIN_SOURCES_FOR_QUADTREE = 64;
+    if( nSources < MIN_SOURCES_FOR_QUADTREE )
+    {
+        for( int iSource = 0; iSource < nSources; iSource++ )
+            anSources.push_back(iSource);
+        return;
+    }
+
+    if( m_hSourcesQuadTree == nullptr || m_nSourcesInQuadTree != nSources )
+    {
+        InvalidateSourcesQuadTree();
+
+        CPLRectObj sGlobalBounds;
+        sGlobalBounds.minx = 0;
+        sGlobalBounds.miny = 0;
+        sGlobalBounds.maxx = nRasterXSize;
+        sGlobalBounds.maxy = nRasterYSize;
+        std::vector<CPLRectObj> asBounds(nSources);
+        m_anQuadTreeSourceIdx.resize(nSources);
+        for( int iSource = 0; iSource < nSources; iSource++ )
+        {
+            m_anQuadTreeSourceIdx[iSource] = -1;
+            if( !papoSources[iSource]->IsSimpleSource() )
+                continue;
+            VRTSimpleSource* const poSS =
+                static_cast<VRTSimpleSource *>( papoSources[iSource] );
+            // Sources without a destination window (its size is then -1)
+            // cover the whole band.
+            if( !(poSS->m_dfDstXSize > 0 && poSS->m_dfDstYSize > 0) )
+                continue;
+            CPLRectObj& sBounds = asBounds[iSource];
+            sBounds.minx = poSS->m_dfDstXOff;
+            sBounds.miny = poSS->m_dfDstYOff;
+            sBounds.maxx = poSS->m_dfDstXOff + poSS->m_dfDstXSize;
+            sBounds.maxy = poSS->m_dfDstYOff + poSS->m_dfDstYSize;
+            if( !(CPLIsFinite(sBounds.minx) && CPLIsFinite(sBounds.miny) &&
+                  CPLIsFinite(sBounds.maxx) && CPLIsFinite(sBounds.maxy)) )
+            {
+                continue;
+            }
+            m_anQuadTreeSourceIdx[iSource] = iSource;
+            sGlobalBounds.minx = std::min(sGlobalBounds.minx, sBounds.minx);
+            sGlobalBounds.miny = std::min(sGlobalBounds.miny, sBounds.miny);
+            sGlobalBounds.maxx = std::max(sGlobalBounds.maxx, sBounds.maxx);
+            sGlobalBounds.maxy = std::max(sGlobalBounds.maxy, sBounds.maxy);
+        }
+
+        m_hSourcesQuadTree = CPLQuadTreeCreate( &sGlobalBounds, nullptr );
+        CPLQuadTreeSetMaxDepth( m_hSourcesQuadTree,
+                                CPLQuadTreeGetAdvisedMaxDepth( nSources ) );
+        for( int iSource = 0; iSource < nSources; iSource++ )
+        {
+            if( m_anQuadTreeSourceIdx[iSource] < 0 )
+            {
+                m_anUnindexedSources.push_back(iSource);
+            }
+            else
+            {
+                CPLQuadTreeInsertWithBounds( m_hSourcesQuadTree,
+                                             &(m_anQuadTreeSourceIdx[iSource]),
+                                             &(asBounds[iSource]) );
+            }
+        }
+        m_nSourcesInQuadTree = nSources;
+    }
+
+    CPLRectObj sAoi;
+    sAoi.minx = nXOff;
+    sAoi.miny = nYOff;
+    sAoi.maxx = static_cast<double>(nXOff) + nXSize;
+    sAoi.maxy = static_cast<double>(nYOff) + nYSize;
+    int nFeatureCount = 0;
+    void** pahFeatures =
+        CPLQuadTreeSearch( m_hSourcesQuadTree, &sAoi, &nFeatureCount );
+    anSources.reserve(nFeatureCount + m_anUnindexedSources.size());
+    for( int i = 0; i < nFeatureCount; i++ )
+        anSources.push_back(*static_cast<const int*>(pahFeatures[i]));
+    CPLFree( pahFeatures );
+    anSources.insert(anSources.end(), m_anUnindexedSources.begin(),
+                     m_anUnindexedSources.end());
+    std::sort(anSources.begin(), anSources.end());
+}
+
+/************************************************************************/
+/*                        VRTSourceDatasetCache                         */
+/************************************************************************/
+
+// Datasets opened on the source filenames, for the exclusive use of one of
+// the jobs of VRTSourcedRasterBand::MultiThreadedSourcesRasterIO(), since
+// the dataset handles of the sources cannot be used concurrently.
+class VRTSourceDatasetCache
+{
+    typedef std::shared_ptr<GDALDataset> DatasetPtr;
+
+    lru11::Cache<std::string, DatasetPtr> m_oCache;
+
+  public:
+    explicit VRTSourceDatasetCache( size_t nMaxSize ) :
+        m_oCache(nMaxSize, 0) {}
+
+    GDALRasterBand* GetEquivalentBand( GDALRasterBand* poSrcBand );
+};
+
+/************************************************************************/
+/*                         GetEquivalentBand()                          */
+/*                                                                      */
+/*      Return the band of a dataset handle owned by this cache that    */
+/*      is a copy of poSrcBand.                                         */
+/************************************************************************/
+
+GDALRasterBand* VRTSourceDatasetCache::GetEquivalentBand(
+                                                GDALRasterBand* poSrcBand )
+{
+    GDALDataset* poSrcDS = poSrcBand->GetDataset();
+    if( poSrcDS == nullptr || poSrcBand->GetBand() < 1 )
+        return nullptr;
+
+    std::string osKey(poSrcDS->GetDescription());
+    for( char** papszIter = poSrcDS->GetOpenOptions();
+         papszIter && *papszIter; ++papszIter )
+    {
+        osKey += '\n';
+        osKey += *papszIter;
+    }
+
+    DatasetPtr poDS;
+    if( !m_oCache.tryGet(osKey, poDS) )
+    {
+        // Failures are silently cached: the caller then falls back to the
+        // handle of the source.
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        GDALDataset* poNewDS = static_cast<GDALDataset*>(
+            GDALOpenEx( poSrcDS->GetDescription(), GDAL_OF_RASTER, nullptr,
+                        poSrcDS->GetOpenOptions(), nullptr ) );
+        CPLPopErrorHandler();
+        if( poNewDS != nullptr )
+        {
+            poDS = DatasetPtr(poNewDS, [](GDALDataset* poDSToClose)
+                                       { GDALClose(poDSToClose); });
+        }
+        m_oCache.insert(osKey, poDS);
+    }
+    if( poDS == nullptr )
+        return nullptr;
+
+    GDALRasterBand* poBand = poDS->GetRasterBand(poSrcBand->GetBand());
+    if( poBand == nullptr ||
+        poBand->GetXSize() != poSrcBand->GetXSize() ||
+        poBand->GetYSize() != poSrcBand->GetYSize() ||
+        poBand->GetRasterDataType() != poSrcBand->GetRasterDataType() )
+    {
+        return nullptr;
+    }
+    return poBand;
+}
+
+/************************************************************************/
+/*                           GetNumThreads()                            */
+/************************************************************************/
+
+int VRTDataset::GetNumThreads()
+{
+    if( m_nNumThreads < 0 )
+    {
+        m_nNumThreads = CPLGetNumThreads(GetOpenOptions());
+    }
+    return m_nNumThreads;
+}
+
+/************************************************************************/
+/*                            GetJobQueue()                             */
+/************************************************************************/
+
+// Return the queue of the jobs of the dataset in the global worker thread
+// pool, with one source dataset cache for each of the GetNumThreads() jobs.
+CPLJobQueue* VRTDataset::GetJobQueue()
+{
+    if( m_poJobQueue == nullptr )
+    {
+        const int nThreads = GetNumThreads();
+        CPLWorkerThreadPool* poThreadPool =
+            CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poThreadPool == nullptr )
+        {
+            m_nNumThreads = 1;
+            return nullptr;
+        }
+        m_poJobQueue = poThreadPool->CreateJobQueue().release();
+
+        // Distribute the dataset pool among the jobs.
+        const int nPoolSize = std::max(
+            1, atoi(CPLGetConfigOption("GDAL_MAX_DATASET_POOL_SIZE", "100")));
+        const size_t nCacheSize =
+            static_cast<size_t>(std::max(8, nPoolSize / nThreads));
+        for( int i = 0; i < nThreads; i++ )
+        {
+            m_apoSourceDatasetCaches.push_back(
+                new VRTSourceDatasetCache(nCacheSize));
+        }
+    }
+    return m_poJobQueue;
+}
+
+/************************************************************************/
+/*                      CloseSourceDatasetCaches()                      */
+/************************************************************************/
+
+void VRTDataset::CloseSourceDatasetCaches()
+{
+    delete m_poJobQueue;
+    m_poJobQueue = nullptr;
+    for( auto poCache: m_apoSourceDatasetCaches )
+        delete poCache;
+    m_apoSourceDatasetCaches.clear();
 }
 
 /************************************************************************/
@@ -183,7 +435,9 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         psExtraArg->eResampleAlg != GRIORA_NearestNeighbour &&
         m_bNoDataValueSet )
     {
-        for( int i = 0; i < nSources; i++ )
+        std::vector<int> anSources;
+        GetSourcesInWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+        for( const int i: anSources )
         {
             bool bFallbackToBase = false;
             if( !papoSources[i]->IsSimpleSource() )
@@ -280,26 +534,41 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 
     m_nRecursionCounter++;
 
+    std::vector<int> anSources;
+    GetSourcesInWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+
+    // Read the sources in parallel if possible.
+    CPLErr eErr = CE_None;
+    if( MultiThreadedSourcesRasterIO( anSources,
+                                      nXOff, nYOff, nXSize, nYSize,
+                                      pData, nBufXSize, nBufYSize,
+                                      eBufType, nPixelSpace, nLineSpace,
+                                      psExtraArg, eErr ) )
+    {
+        m_nRecursionCounter--;
+        return eErr;
+    }
+
     GDALProgressFunc const pfnProgressGlobal = psExtraArg->pfnProgress;
     void * const pProgressDataGlobal = psExtraArg->pProgressData;
 
 /* -------------------------------------------------------------------- */
 /*      Overlay each source in turn over top this.                      */
 /* -------------------------------------------------------------------- */
-    CPLErr eErr = CE_None;
-    for( int iSource = 0; eErr == CE_None && iSource < nSources; iSource++ )
+    const int nSourcesInWindow = static_cast<int>(anSources.size());
+    for( int i = 0; eErr == CE_None && i < nSourcesInWindow; i++ )
     {
         psExtraArg->pfnProgress = GDALScaledProgress;
         psExtraArg->pProgressData =
-            GDALCreateScaledProgress( 1.0 * iSource / nSources,
-                                      1.0 * (iSource + 1) / nSources,
+            GDALCreateScaledProgress( 1.0 * i / nSourcesInWindow,
+                                      1.0 * (i + 1) / nSourcesInWindow,
                                       pfnProgressGlobal,
                                       pProgressDataGlobal );
         if( psExtraArg->pProgressData == nullptr )
             psExtraArg->pfnProgress = nullptr;
 
         eErr =
-            papoSources[iSource]->RasterIO( eDataType,
+            papoSources[anSources[i]]->RasterIO( eDataType,
                                             nXOff, nYOff, nXSize, nYSize,
                                             pData, nBufXSize, nBufYSize,
                                             eBufType, nPixelSpace, nLineSpace,
@@ -316,6 +585,272 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     return eErr;
 }
 
+/************************************************************************/
+/*                        VRTSourcesReadJob                             */
+/************************************************************************/
+
+namespace {
+struct VRTSourcesReadJob
+{
+    VRTSourceDatasetCache *poCache = nullptr;
+    std::vector<VRTSimpleSource*> apoSources{};
+    // Sources that could not be opened by the job.
+    std::vector<VRTSimpleSource*> apoUnhandledSources{};
+
+    GDALDataType eBandDataType = GDT_Unknown;
+    int nXOff = 0;
+    int nYOff = 0;
+    int nXSize = 0;
+    int nYSize = 0;
+    void *pData = nullptr;
+    int nBufXSize = 0;
+    int nBufYSize = 0;
+    GDALDataType eBufType = GDT_Unknown;
+    GSpacing nPixelSpace = 0;
+    GSpacing nLineSpace = 0;
+    GDALRasterIOExtraArg sExtraArg;
+
+    CPLErr eErr = CE_None;
+};
+} // namespace
+
+static void VRTSourcesReadJobFunc( void* pData )
+{
+    VRTSourcesReadJob* psJob = static_cast<VRTSourcesReadJob*>(pData);
+    for( auto poSource: psJob->apoSources )
+    {
+        if( psJob->eErr != CE_None )
+            break;
+        GDALRasterBand* poSrcBand = poSource->GetBand();
+        GDALRasterBand* poBand =
+            psJob->poCache->GetEquivalentBand(poSrcBand);
+        if( poBand == nullptr )
+        {
+            psJob->apoUnhandledSources.push_back(poSource);
+            continue;
+        }
+        // The source is exclusively used by this job while the main thread
+        // waits for completion, so we can temporarily substitute its band.
+        poSource->SetSrcBand(poBand);
+        psJob->eErr =
+            poSource->RasterIO( psJob->eBandDataType,
+                                psJob->nXOff, psJob->nYOff,
+                                psJob->nXSize, psJob->nYSize,
+                                psJob->pData,
+                                psJob->nBufXSize, psJob->nBufYSize,
+                                psJob->eBufType,
+                                psJob->nPixelSpace, psJob->nLineSpace,
+                                &(psJob->sExtraArg) );
+        poSource->SetSrcBand(poSrcBand);
+    }
+}
+
+/************************************************************************/
+/*                    MultiThreadedSourcesRasterIO()                    */
+/*                                                                      */
+/*      Read the sources with the thread pool of the VRT dataset.       */
+/*      Each source is read through its own dataset handle.  Sources    */
+/*      are processed by batches of consecutive sources whose           */
+/*      destination windows do not intersect, so that the result is     */
+/*      the same as when overlaying them in order.  Returns false,      */
+/*      without doing anything, when this cannot be used.               */
+/************************************************************************/
+
+bool VRTSourcedRasterBand::MultiThreadedSourcesRasterIO(
+                                        const std::vector<int>& anSources,
+                                        int nXOff, int nYOff,
+                                        int nXSize, int nYSize,
+                                        void *pData,
+                                        int nBufXSize, int nBufYSize,
+                                        GDALDataType eBufType,
+                                        GSpacing nPixelSpace,
+                                        GSpacing nLineSpace,
+                                        GDALRasterIOExtraArg* psExtraArg,
+                                        CPLErr& eErr )
+{
+    VRTDataset* poVRTDS = dynamic_cast<VRTDataset*>(poDS);
+    if( anSources.size() < 2 || poVRTDS == nullptr ||
+        poVRTDS->GetAccess() != GA_ReadOnly ||
+        poVRTDS->GetNumThreads() <= 1 )
+    {
+        return false;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Collect the sources intersecting the request, and their         */
+/*      window in the buffer.                                           */
+/* -------------------------------------------------------------------- */
+    struct SourceWindow
+    {
+        VRTSimpleSource* poSource;
+        int nOutXOff;
+        int nOutYOff;
+        int nOutXEnd;
+        int nOutYEnd;
+    };
+    std::vector<SourceWindow> asWindows;
+    for( const int iSource: anSources )
+    {
+        if( !papoSources[iSource]->IsSimpleSource() ||
+            dynamic_cast<VRTFilteredSource*>(papoSources[iSource]) )
+        {
+            return false;
+        }
+        VRTSimpleSource* const poSource =
+            static_cast<VRTSimpleSource *>( papoSources[iSource] );
+        if( poSource->GetBand() == nullptr )
+            return false;
+
+        double dfReqXOff = 0.0;
+        double dfReqYOff = 0.0;
+        double dfReqXSize = 0.0;
+        double dfReqYSize = 0.0;
+        int nReqXOff = 0;
+        int nReqYOff = 0;
+        int nReqXSize = 0;
+        int nReqYSize = 0;
+        int nOutXOff = 0;
+        int nOutYOff = 0;
+        int nOutXSize = 0;
+        int nOutYSize = 0;
+        if( poSource->GetSrcDstWindow( nXOff, nYOff, nXSize, nYSize,
+                              nBufXSize, nBufYSize,
+                              &dfReqXOff, &dfReqYOff, &dfReqXSize, &dfReqYSize,
+                              &nReqXOff, &nReqYOff, &nReqXSize, &nReqYSize,
+                              &nOutXOff, &nOutYOff, &nOutXSize, &nOutYSize ) )
+        {
+            asWindows.push_back( { poSource, nOutXOff, nOutYOff,
+                                   nOutXOff + nOutXSize,
+                                   nOutYOff + nOutYSize } );
+        }
+    }
+    if( asWindows.size() < 2 )
+        return false;
+
+    CPLJobQueue* poJobQueue = poVRTDS->GetJobQueue();
+    if( poJobQueue == nullptr )
+        return false;
+    const int nThreads = poVRTDS->GetNumThreads();
+
+    std::vector<VRTSourcesReadJob> asJobs(nThreads);
+    for( int i = 0; i < nThreads; i++ )
+    {
+        VRTSourcesReadJob& sJob = asJobs[i];
+        sJob.poCache = poVRTDS->m_apoSourceDatasetCaches[i];
+        sJob.eBandDataType = eDataType;
+        sJob.nXOff = nXOff;
+        sJob.nYOff = nYOff;
+        sJob.nXSize = nXSize;
+        sJob.nYSize = nYSize;
+        sJob.pData = pData;
+        sJob.nBufXSize = nBufXSize;
+        sJob.nBufYSize = nBufYSize;
+        sJob.eBufType = eBufType;
+        sJob.nPixelSpace = nPixelSpace;
+        sJob.nLineSpace = nLineSpace;
+        sJob.sExtraArg = *psExtraArg;
+        // Progress is reported by this thread.
+        sJob.sExtraArg.pfnProgress = nullptr;
+        sJob.sExtraArg.pProgressData = nullptr;
+    }
+
+    GDALRasterIOExtraArg sExtraArg = *psExtraArg;
+    sExtraArg.pfnProgress = nullptr;
+    sExtraArg.pProgressData = nullptr;
+
+    eErr = CE_None;
+    size_t iBatchStart = 0;
+    while( eErr == CE_None && iBatchStart < asWindows.size() )
+    {
+        // Extend the batch as long as the next source does not intersect
+        // any source of the batch.
+        size_t iBatchEnd = iBatchStart + 1;
+        for( ; iBatchEnd < asWindows.size(); iBatchEnd++ )
+        {
+            const SourceWindow& sNew = asWindows[iBatchEnd];
+            bool bIntersects = false;
+            for( size_t i = iBatchStart; i < iBatchEnd; i++ )
+            {
+                const SourceWindow& sOld = asWindows[i];
+                if( sNew.nOutXOff < sOld.nOutXEnd &&
+                    sOld.nOutXOff < sNew.nOutXEnd &&
+                    sNew.nOutYOff < sOld.nOutYEnd &&
+                    sOld.nOutYOff < sNew.nOutYEnd )
+                {
+                    bIntersects = true;
+                    break;
+                }
+            }
+            if( bIntersects )
+                break;
+        }
+
+        if( iBatchEnd - iBatchStart == 1 )
+        {
+            eErr = asWindows[iBatchStart].poSource->RasterIO(
+                                            eDataType,
+                                            nXOff, nYOff, nXSize, nYSize,
+                                            pData, nBufXSize, nBufYSize,
+                                            eBufType, nPixelSpace, nLineSpace,
+                                            &sExtraArg );
+        }
+        else
+        {
+            for( auto& sJob: asJobs )
+            {
+                sJob.apoSources.clear();
+                sJob.apoUnhandledSources.clear();
+            }
+            for( size_t i = iBatchStart; i < iBatchEnd; i++ )
+            {
+                asJobs[(i - iBatchStart) % nThreads].apoSources.push_back(
+                    asWindows[i].poSource);
+            }
+            for( auto& sJob: asJobs )
+            {
+                if( !sJob.apoSources.empty() &&
+                    !poJobQueue->SubmitJob(VRTSourcesReadJobFunc, &sJob) )
+                {
+                    VRTSourcesReadJobFunc(&sJob);
+                }
+            }
+            poJobQueue->WaitCompletion();
+
+            // Sources of the batch do not intersect, so those that could
+            // not be read by the jobs can be read afterwards.
+            for( auto& sJob: asJobs )
+            {
+                if( eErr == CE_None )
+                    eErr = sJob.eErr;
+                for( auto poSource: sJob.apoUnhandledSources )
+                {
+                    if( eErr != CE_None )
+                        break;
+                    eErr = poSource->RasterIO(
+                                            eDataType,
+                                            nXOff, nYOff, nXSize, nYSize,
+                                            pData, nBufXSize, nBufYSize,
+                                            eBufType, nPixelSpace, nLineSpace,
+                                            &sExtraArg );
+                }
+            }
+        }
+
+        iBatchStart = iBatchEnd;
+
+        if( eErr == CE_None && psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress(
+                1.0 * iBatchStart / asWindows.size(), "",
+                psExtraArg->pProgressData) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    return true;
+}
+
 /************************************************************************/
 /*                         IGetDataCoverageStatus()                     */
 /************************************************************************/
@@ -902,6 +1437,8 @@ CPLErr VRTSourcedRasterBand::GetHistogram( double dfMin, double dfMax,
 CPLErr VRTSourcedRasterBand::AddSource( VRTSource *poNewSource )
 
 {
+    InvalidateSourcesQuadTree();
+
     nSources++;
 
     papoSources = static_cast<VRTSource **>(
@@ -1049,8 +1586,8 @@ void VRTSourcedRasterBand::CheckSource( VRTSimpleSource *poSS )
     if( strcmp(poSS->GetType(), "SimpleSource") == 0 &&
         poSS->m_dfSrcXOff >= 0.0 &&
         poSS->m_dfSrcYOff >= 0.0 &&
-        poSS->m_dfSrcXOff + poSS->m_dfSrcXSize <= poSS->m_poRasterBand->GetXSize() &&
-        poSS->m_dfSrcYOff + poSS->m_dfSrcYSize <= poSS->m_poRasterBand->GetYSize() &&
+        poSS->m_dfSrcXOff + poSS->m_dfSrcXSize <= poSS->GetSrcRasterXSize() &&
+        poSS->m_dfSrcYOff + poSS->m_dfSrcYSize <= poSS->GetSrcRasterYSize() &&
         poSS->m_dfDstXOff <= 0.0 &&
         poSS->m_dfDstYOff <= 0.0 &&
         poSS->m_dfDstXOff + poSS->m_dfDstXSize >= nRasterXSize &&
@@ -1699,6 +2236,8 @@ int VRTSourcedRasterBand::CloseDependentDatasets()
     if( nSources == 0 )
         return FALSE;
 
+    InvalidateSourcesQuadTree();
+
     for( int i = 0; i < nSources; i++ )
         delete papoSources[i];
 
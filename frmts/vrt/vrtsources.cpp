@@ -135,7 +135,10 @@ VRTSimpleSource::VRTSimpleSource( const VRTSimpleSource* poSrcSource,
     m_nMaxValue(poSrcSource->m_nMaxValue),
     m_bRelativeToVRTOri(-1),
     m_nExplicitSharedStatus(poSrcSource->m_nExplicitSharedStatus)
-{}
+{
+    // The band of poSrcSource is shared, so it must have been instantiated.
+    CPLAssert( poSrcSource->m_poDeferredSource == nullptr );
+}
 
 /************************************************************************/
 /*                          ~VRTSimpleSource()                          */
@@ -192,6 +195,7 @@ void VRTSimpleSource::UnsetPreservedRelativeFilenames()
 void VRTSimpleSource::SetSrcBand( GDALRasterBand *poNewSrcBand )
 
 {
+    m_poDeferredSource.reset();
     m_poRasterBand = poNewSrcBand;
 }
 
@@ -204,6 +208,7 @@ void VRTSimpleSource::SetSrcBand( GDALRasterBand *poNewSrcBand )
 void VRTSimpleSource::SetSrcMaskBand( GDALRasterBand *poNewSrcBand )
 
 {
+    m_poDeferredSource.reset();
     m_poRasterBand = poNewSrcBand->GetMaskBand();
     m_poMaskBandMainBand = poNewSrcBand;
 }
@@ -283,7 +288,7 @@ static const char* const apszSpecialSyntax[] = {
 CPLXMLNode *VRTSimpleSource::SerializeToXML( const char *pszVRTPath )
 
 {
-    if( m_poRasterBand == nullptr )
+    if( !InstantiateSource() )
         return nullptr;
 
     GDALDataset *poDS = nullptr;
@@ -704,71 +709,65 @@ CPLErr VRTSimpleSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
     else
     {
         /* ----------------------------------------------------------------- */
-        /*      Create a proxy dataset                                       */
+        /*      Defer the creation of the proxy dataset to the first use     */
+        /*      of the source band (see InstantiateSource()).                */
         /* ----------------------------------------------------------------- */
-        CPLString osUniqueHandle( CPLSPrintf("%p", pUniqueHandle) );
-        GDALProxyPoolDataset * const proxyDS =
-            new GDALProxyPoolDataset( osSrcDSName, nRasterXSize, nRasterYSize,
-                                      GA_ReadOnly, bShared, nullptr, nullptr,
-                                      osUniqueHandle.c_str() );
-        proxyDS->SetOpenOptions(papszOpenOptions);
-        poSrcDS = proxyDS;
-
-        // Only the information of rasterBand nSrcBand will be accurate
-        // but that's OK since we only use that band afterwards.
-        //
-        // Previously this added a src band for every band <= nSrcBand, but this becomes
-        // prohibitely expensive for files with a large number of bands. This optimization
-        // only adds the desired band and the rest of the bands will simply be initialized with a nullptr.
-        // This assumes no other code here accesses any of the lower bands in the GDALProxyPoolDataset.
-        // It has been suggested that in addition, we should to try share GDALProxyPoolDataset between multiple
-        // Simple Sources, which would save on memory for papoBands. For now, that's not implemented.
-        proxyDS->AddSrcBand(nSrcBand, eDataType, nBlockXSize, nBlockYSize);
-
-        if( bGetMaskBand )
+        m_poDeferredSource.reset(new DeferredProxySource());
+        m_poDeferredSource->osSrcDSName = osSrcDSName;
+        m_poDeferredSource->nSrcBand = nSrcBand;
+        m_poDeferredSource->bGetMaskBand = bGetMaskBand;
+        m_poDeferredSource->bShared = bShared;
+        m_poDeferredSource->nRasterXSize = nRasterXSize;
+        m_poDeferredSource->nRasterYSize = nRasterYSize;
+        m_poDeferredSource->eDataType = eDataType;
+        m_poDeferredSource->nBlockXSize = nBlockXSize;
+        m_poDeferredSource->nBlockYSize = nBlockYSize;
+        m_poDeferredSource->aosOpenOptions.Assign(papszOpenOptions, TRUE);
+        papszOpenOptions = nullptr;
+        // By default, shared sources are only shared within the same VRT
+        // dataset (see the comment before the GDALProxyPoolDataset
+        // constructor). VRT_SHARE_SOURCES_ACROSS_DATASETS=YES lets all the
+        // VRT datasets opened by the same thread share the same underlying
+        // datasets, and thus their block cache.
+        if( !bShared ||
+            !CPLTestBool(CPLGetConfigOption(
+                "VRT_SHARE_SOURCES_ACROSS_DATASETS", "NO")) )
         {
-          GDALProxyPoolRasterBand *poMaskBand =
-              dynamic_cast<GDALProxyPoolRasterBand *>(
-              proxyDS->GetRasterBand(nSrcBand) );
-          if( poMaskBand == nullptr )
-          {
-              CPLError(
-                  CE_Fatal, CPLE_AssertionFailed, "dynamic_cast failed." );
-          }
-          else
-          {
-              poMaskBand->AddSrcMaskBandDescription(
-                  eDataType, nBlockXSize, nBlockYSize );
-          }
+            m_poDeferredSource->osUniqueHandle.Printf("%p", pUniqueHandle);
         }
+        m_poDeferredSource->nResponsiblePID =
+            GDALGetResponsiblePIDForCurrentThread();
     }
 
     CSLDestroy(papszOpenOptions);
 
-    if( poSrcDS == nullptr )
+    if( poSrcDS == nullptr && m_poDeferredSource == nullptr )
         return CE_Failure;
 
 /* -------------------------------------------------------------------- */
 /*      Get the raster band.                                            */
 /* -------------------------------------------------------------------- */
 
-    m_poRasterBand = poSrcDS->GetRasterBand(nSrcBand);
-    if( m_poRasterBand == nullptr )
+    if( poSrcDS != nullptr )
     {
-        poSrcDS->ReleaseRef();
-        return CE_Failure;
-    }
-    else if( bAddToMapIfOk )
-    {
-        oMapSharedSources[osSrcDSName] = poSrcDS;
-    }
-
-    if( bGetMaskBand )
-    {
-        m_poMaskBandMainBand = m_poRasterBand;
-        m_poRasterBand = m_poRasterBand->GetMaskBand();
+        m_poRasterBand = poSrcDS->GetRasterBand(nSrcBand);
         if( m_poRasterBand == nullptr )
+        {
+            poSrcDS->ReleaseRef();
             return CE_Failure;
+        }
+        else if( bAddToMapIfOk )
+        {
+            oMapSharedSources[osSrcDSName] = poSrcDS;
+        }
+
+        if( bGetMaskBand )
+        {
+            m_poMaskBandMainBand = m_poRasterBand;
+            m_poRasterBand = m_poRasterBand->GetMaskBand();
+            if( m_poRasterBand == nullptr )
+                return CE_Failure;
+        }
     }
 
 /* -------------------------------------------------------------------- */
@@ -831,6 +830,120 @@ CPLErr VRTSimpleSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
     return CE_None;
 }
 
+/************************************************************************/
+/*                         InstantiateSource()                          */
+/*                                                                      */
+/*      Create the proxy dataset of a source whose properties were      */
+/*      read by XMLInit(), if not done yet.                             */
+/************************************************************************/
+
+bool VRTSimpleSource::InstantiateSource()
+{
+    if( m_poDeferredSource == nullptr )
+        return m_poRasterBand != nullptr;
+
+    std::unique_ptr<DeferredProxySource> poDeferred(
+        std::move(m_poDeferredSource));
+
+    // Attach the proxy to the thread that opened the VRT, as it would
+    // have been if created by XMLInit().
+    const GIntBig nPIDBackup = GDALGetResponsiblePIDForCurrentThread();
+    GDALSetResponsiblePIDForCurrentThread(poDeferred->nResponsiblePID);
+    GDALProxyPoolDataset * const proxyDS =
+        new GDALProxyPoolDataset( poDeferred->osSrcDSName,
+                                  poDeferred->nRasterXSize,
+                                  poDeferred->nRasterYSize,
+                                  GA_ReadOnly, poDeferred->bShared,
+                                  nullptr, nullptr,
+                                  poDeferred->osUniqueHandle.empty() ?
+                                    nullptr :
+                                    poDeferred->osUniqueHandle.c_str() );
+    GDALSetResponsiblePIDForCurrentThread(nPIDBackup);
+    proxyDS->SetOpenOptions(poDeferred->aosOpenOptions.List());
+
+    // Only the information of rasterBand nSrcBand will be accurate
+    // but that's OK since we only use that band afterwards.
+    //
+    // Previously this added a src band for every band <= nSrcBand, but
+    // this becomes prohibitely expensive for files with a large number of
+    // bands. This optimization only adds the desired band and the rest of
+    // the bands will simply be initialized with a nullptr.
+    // This assumes no other code here accesses any of the lower bands in
+    // the GDALProxyPoolDataset.
+    // It has been suggested that in addition, we should to try share
+    // GDALProxyPoolDataset between multiple Simple Sources, which would
+    // save on memory for papoBands. For now, that's not implemented.
+    const int nSrcBand = poDeferred->nSrcBand;
+    proxyDS->AddSrcBand(nSrcBand, poDeferred->eDataType,
+                        poDeferred->nBlockXSize, poDeferred->nBlockYSize);
+
+    if( poDeferred->bGetMaskBand )
+    {
+      GDALProxyPoolRasterBand *poMaskBand =
+          dynamic_cast<GDALProxyPoolRasterBand *>(
+          proxyDS->GetRasterBand(nSrcBand) );
+      if( poMaskBand == nullptr )
+      {
+          CPLError(
+              CE_Fatal, CPLE_AssertionFailed, "dynamic_cast failed." );
+      }
+      else
+      {
+          poMaskBand->AddSrcMaskBandDescription(
+              poDeferred->eDataType,
+              poDeferred->nBlockXSize, poDeferred->nBlockYSize );
+      }
+    }
+
+    m_poRasterBand = proxyDS->GetRasterBand(nSrcBand);
+    if( m_poRasterBand == nullptr )
+    {
+        proxyDS->ReleaseRef();
+        return false;
+    }
+
+    if( poDeferred->bGetMaskBand )
+    {
+        m_poMaskBandMainBand = m_poRasterBand;
+        m_poRasterBand = m_poRasterBand->GetMaskBand();
+    }
+
+    return m_poRasterBand != nullptr;
+}
+
+/************************************************************************/
+/*                         GetSrcRasterXSize()                          */
+/************************************************************************/
+
+int VRTSimpleSource::GetSrcRasterXSize()
+{
+    if( m_poDeferredSource )
+        return m_poDeferredSource->nRasterXSize;
+    return m_poRasterBand->GetXSize();
+}
+
+/************************************************************************/
+/*                         GetSrcRasterYSize()                          */
+/************************************************************************/
+
+int VRTSimpleSource::GetSrcRasterYSize()
+{
+    if( m_poDeferredSource )
+        return m_poDeferredSource->nRasterYSize;
+    return m_poRasterBand->GetYSize();
+}
+
+/************************************************************************/
+/*                        GetSrcRasterDataType()                        */
+/************************************************************************/
+
+GDALDataType VRTSimpleSource::GetSrcRasterDataType()
+{
+    if( m_poDeferredSource )
+        return m_poDeferredSource->eDataType;
+    return m_poRasterBand->GetRasterDataType();
+}
+
 /************************************************************************/
 /*                             GetFileList()                            */
 /************************************************************************/
@@ -839,8 +952,12 @@ void VRTSimpleSource::GetFileList( char*** ppapszFileList, int *pnSize,
                                    int *pnMaxSize, CPLHashSet* hSetFiles )
 {
     const char* pszFilename = nullptr;
-    if( m_poRasterBand != nullptr && m_poRasterBand->GetDataset() != nullptr &&
-        (pszFilename = m_poRasterBand->GetDataset()->GetDescription()) != nullptr )
+    if( m_poDeferredSource != nullptr )
+        pszFilename = m_poDeferredSource->osSrcDSName.c_str();
+    else if( m_poRasterBand != nullptr &&
+             m_poRasterBand->GetDataset() != nullptr )
+        pszFilename = m_poRasterBand->GetDataset()->GetDescription();
+    if( pszFilename != nullptr )
     {
 /* -------------------------------------------------------------------- */
 /*      Is the filename even a real filesystem object?                  */
@@ -891,9 +1008,20 @@ void VRTSimpleSource::GetFileList( char*** ppapszFileList, int *pnSize,
 
 GDALRasterBand* VRTSimpleSource::GetBand()
 {
+    InstantiateSource();
     return m_poMaskBandMainBand ? nullptr : m_poRasterBand;
 }
 
+/************************************************************************/
+/*                        GetMaskBandMainBand()                         */
+/************************************************************************/
+
+GDALRasterBand* VRTSimpleSource::GetMaskBandMainBand()
+{
+    InstantiateSource();
+    return m_poMaskBandMainBand;
+}
+
 /************************************************************************/
 /*                       IsSameExceptBandNumber()                       */
 /************************************************************************/
@@ -1103,6 +1231,9 @@ VRTSimpleSource::GetSrcDstWindow( int nXOff, int nYOff, int nXSize, int nYSize,
     if( *pnReqYSize == 0 )
         *pnReqYSize = 1;
 
+    if( !InstantiateSource() )
+        return FALSE;
+
     if( *pnReqXSize > INT_MAX - *pnReqXOff ||
         *pnReqXOff + *pnReqXSize > m_poRasterBand->GetXSize() )
     {
@@ -2333,7 +2464,7 @@ CPLErr VRTComplexSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
     {
         m_bNoDataSet = TRUE;
         m_dfNoDataValue = CPLAtofM( CPLGetXMLValue(psSrc, "NODATA", "0") );
-        if( m_poRasterBand->GetRasterDataType() == GDT_Float32 )
+        if( GetSrcRasterDataType() == GDT_Float32 )
         {
             m_dfNoDataValue = GDALAdjustNoDataCloseToFloatMax(m_dfNoDataValue);
         }
@@ -1223,30 +1223,33 @@ CPLErr VRTWarpedDataset::XMLInit( CPLXMLNode *psTree, const char *pszVRTPathIn )
 /* -------------------------------------------------------------------- */
 /*      Adjust the SourceDataset in the warp options to take into       */
 /*      account that it is relative to the VRT if appropriate.          */
+/*      psTree may live in an arena (see VRTDataset::OpenXML()), so     */
+/*      it must not be modified: the adjusted path goes in a copy of    */
+/*      the warp options.                                               */
 /* -------------------------------------------------------------------- */
     const bool bRelativeToVRT =
         CPL_TO_BOOL(atoi(CPLGetXMLValue(psOptionsTree,
                             "SourceDataset.relativeToVRT", "0" )));
 
-    const char *pszRelativePath = CPLGetXMLValue(psOptionsTree,
-                                                 "SourceDataset", "" );
-    char *pszAbsolutePath = nullptr;
-
+    CPLXMLNode *psAdjustedOptionsTree = nullptr;
     if( bRelativeToVRT )
-        pszAbsolutePath =
-            CPLStrdup(CPLProjectRelativeFilename( pszVRTPathIn,
-                                                  pszRelativePath ) );
-    else
-        pszAbsolutePath = CPLStrdup(pszRelativePath);
-
-    CPLSetXMLValue( psOptionsTree, "SourceDataset", pszAbsolutePath );
-    CPLFree( pszAbsolutePath );
+    {
+        const char *pszRelativePath = CPLGetXMLValue(psOptionsTree,
+                                                     "SourceDataset", "" );
+        const CPLString osAbsolutePath(
+            CPLProjectRelativeFilename( pszVRTPathIn, pszRelativePath ) );
+        psAdjustedOptionsTree = CPLCloneXMLTree( psOptionsTree );
+        CPLSetXMLValue( psAdjustedOptionsTree, "SourceDataset",
+                        osAbsolutePath );
+    }
 
 /* -------------------------------------------------------------------- */
 /*      And instantiate the warp options, and corresponding warp        */
 /*      operation.                                                      */
 /* -------------------------------------------------------------------- */
-    GDALWarpOptions *psWO = GDALDeserializeWarpOptions( psOptionsTree );
+    GDALWarpOptions *psWO = GDALDeserializeWarpOptions(
+        psAdjustedOptionsTree ? psAdjustedOptionsTree : psOptionsTree );
+    CPLDestroyXMLNode( psAdjustedOptionsTree );
     if( psWO == nullptr )
         return CE_Failure;
 
@@ -876,6 +876,7 @@ void GDALRegister_WEBP()
     poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "WEBP" );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "frmt_webp.html" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "webp" );
+    poDriver->SetMetadataItem( GDAL_DMD_SIGNATURES, "52494646" );
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/webp" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES, "Byte" );
 
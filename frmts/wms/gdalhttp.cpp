@@ -31,6 +31,7 @@
 
 #include "wmsdriver.h"
 #include <algorithm>
+#include <mutex>
 
 CPL_CVSID("$Id: gdalhttp.cpp 15748d502551e341d73d0e388eb9f2e5209aa902 2018-10-06 19:05:17 +0200 Denis Rykov $")
 
@@ -68,6 +69,54 @@ static size_t CPLHTTPWriteFunc(void *buffer, size_t count, size_t nmemb, void *r
     return nmemb;
 }
 
+// libcurl 7.57 is needed to share the connection cache
+#if LIBCURL_VERSION_NUM >= 0x073900
+
+static std::mutex gShareMutex;
+static CURLSH *gShareHandle = nullptr;
+static std::mutex gaoShareDataMutex[CURL_LOCK_DATA_LAST];
+
+static void WMSHTTPShareLock(CURL *, curl_lock_data data,
+                             curl_lock_access, void *) {
+    gaoShareDataMutex[data].lock();
+}
+
+static void WMSHTTPShareUnlock(CURL *, curl_lock_data data, void *) {
+    gaoShareDataMutex[data].unlock();
+}
+
+// Returns the process-wide share handle through which connections, DNS
+// entries and SSL sessions are reused between requests, and thus between
+// datasets pointing to the same server.
+static CURLSH *WMSHTTPGetShareHandle() {
+    std::lock_guard<std::mutex> oLock(gShareMutex);
+    if (gShareHandle == nullptr &&
+        CPLTestBool(CPLGetConfigOption("GDAL_WMS_SHARE_CONNECTIONS", "YES"))) {
+        gShareHandle = curl_share_init();
+        if (gShareHandle != nullptr) {
+            curl_share_setopt(gShareHandle, CURLSHOPT_LOCKFUNC, WMSHTTPShareLock);
+            curl_share_setopt(gShareHandle, CURLSHOPT_UNLOCKFUNC, WMSHTTPShareUnlock);
+            curl_share_setopt(gShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+            curl_share_setopt(gShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(gShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+    }
+    return gShareHandle;
+}
+
+#endif
+
+// Releases the shared connections, when the driver is unloaded
+void WMSHTTPCleanup() {
+#if LIBCURL_VERSION_NUM >= 0x073900
+    std::lock_guard<std::mutex> oLock(gShareMutex);
+    if (gShareHandle != nullptr) {
+        curl_share_cleanup(gShareHandle);
+        gShareHandle = nullptr;
+    }
+#endif
+}
+
 // Builds a curl request
 void WMSHTTPInitializeRequest(WMSHTTPRequest *psRequest) {
     psRequest->nStatus = 0;
@@ -86,6 +135,12 @@ void WMSHTTPInitializeRequest(WMSHTTPRequest *psRequest) {
 
     curl_easy_setopt(psRequest->m_curl_handle, CURLOPT_WRITEDATA, psRequest);
     curl_easy_setopt(psRequest->m_curl_handle, CURLOPT_WRITEFUNCTION, CPLHTTPWriteFunc);
+    curl_easy_setopt(psRequest->m_curl_handle, CURLOPT_PRIVATE, psRequest);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    CURLSH *share_handle = WMSHTTPGetShareHandle();
+    if (share_handle != nullptr)
+        curl_easy_setopt(psRequest->m_curl_handle, CURLOPT_SHARE, share_handle);
+#endif
 
     psRequest->m_curl_error.resize(CURL_ERROR_SIZE + 1);
     curl_easy_setopt(psRequest->m_curl_handle, CURLOPT_ERRORBUFFER, &psRequest->m_curl_error[0]);
@@ -107,11 +162,50 @@ WMSHTTPRequest::~WMSHTTPRequest() {
         CPLFree(pabyData);
 }
 
+// Sets the output fields of a completed, or aborted, request
+static void WMSHTTPFinishRequest(CURLM *curl_multi, WMSHTTPRequest *psRequest,
+                                 int i) {
+    long response_code;
+    curl_easy_getinfo(psRequest->m_curl_handle, CURLINFO_RESPONSE_CODE, &response_code);
+    psRequest->nStatus = static_cast<int>(response_code);
+
+    char *content_type = nullptr;
+    curl_easy_getinfo(psRequest->m_curl_handle, CURLINFO_CONTENT_TYPE, &content_type);
+    psRequest->ContentType = content_type ? content_type : "";
+
+    if (psRequest->Error.empty())
+        psRequest->Error = &psRequest->m_curl_error[0];
+
+    /* In the case of a file:// URL, curl will return a status == 0, so if there's no */
+    /* error returned, patch the status code to be 200, as it would be for http:// */
+    if (psRequest->nStatus == 0 && psRequest->Error.empty() && STARTS_WITH(psRequest->URL.c_str(), "file://"))
+        psRequest->nStatus = 200;
+
+    // If there is an error with no error message, use the content if it is text
+    if (psRequest->Error.empty()
+        && psRequest->nStatus != 0
+        && psRequest->nStatus != 200
+        && strstr(psRequest->ContentType, "text")
+        && psRequest->pabyData != nullptr )
+        psRequest->Error = reinterpret_cast<const char *>(psRequest->pabyData);
+
+    CPLDebug("HTTP", "Request [%d] %s : status = %d, content type = %s, error = %s",
+             i, psRequest->URL.c_str(), psRequest->nStatus,
+             !psRequest->ContentType.empty() ? psRequest->ContentType.c_str() : "(null)",
+             !psRequest->Error.empty() ? psRequest->Error.c_str() : "(null)");
+
+    curl_multi_remove_handle(curl_multi, psRequest->m_curl_handle);
+    psRequest->m_finished = true;
+}
+
 //
 // Like CPLHTTPFetch, but multiple requests in parallel
 // By default it uses 5 connections
+// If pfnDone is set, it is called for each request as soon as it completes,
+// while the other ones are still being downloaded
 //
-CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *pasRequest, int nRequestCount) {
+CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *pasRequest, int nRequestCount,
+                         WMSHTTPRequestDoneFunc pfnDone, void *pDoneUserData) {
     CPLErr ret = CE_None;
     CURLM *curl_multi = nullptr;
     int still_running;
@@ -148,6 +242,9 @@ CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *pasRequest, int nRequestCount) {
             psResult->pabyData = nullptr;
             psResult->nDataLen = 0;
             CPLHTTPDestroyResult(psResult);
+            pasRequest[i].m_finished = true;
+            if (pfnDone != nullptr)
+                pfnDone(&pasRequest[i], pDoneUserData);
         }
         return CE_None;
     }
@@ -156,6 +253,10 @@ CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *pasRequest, int nRequestCount) {
     if (curl_multi == nullptr) {
         CPLError(CE_Fatal, CPLE_AppDefined, "CPLHTTPFetchMulti(): Unable to create CURL multi-handle.");
     }
+#if LIBCURL_VERSION_NUM >= 0x072B00
+    // Allow several HTTP/2 streams over the same connection
+    curl_multi_setopt(curl_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
 
     // add at most max_conn requests
     for (conn_i = 0; conn_i < std::min(nRequestCount, max_conn); ++conn_i) {
@@ -179,6 +280,16 @@ CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *pasRequest, int nRequestCount) {
             msg = curl_multi_info_read(curl_multi, &msgs_in_queue);
             if (msg != nullptr) {
                 if (msg->msg == CURLMSG_DONE) {
+                    char *pszPrivate = nullptr;
+                    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &pszPrivate);
+                    WMSHTTPRequest *const psDone =
+                        reinterpret_cast<WMSHTTPRequest *>(pszPrivate);
+                    if (psDone != nullptr && !psDone->m_finished) {
+                        WMSHTTPFinishRequest(curl_multi, psDone,
+                                             static_cast<int>(psDone - pasRequest));
+                        if (pfnDone != nullptr)
+                            pfnDone(psDone, pDoneUserData);
+                    }
                     // transfer completed, add more handles if available
                     if (conn_i < nRequestCount) {
                         WMSHTTPRequest *const psRequest = &pasRequest[conn_i];
@@ -229,39 +340,10 @@ CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *pasRequest, int nRequestCount) {
         ret = CE_Failure;
     }
 
+    // Requests whose completion was not notified
     for (i = 0; i < nRequestCount; ++i) {
-        WMSHTTPRequest *const psRequest = &pasRequest[i];
-
-        long response_code;
-        curl_easy_getinfo(psRequest->m_curl_handle, CURLINFO_RESPONSE_CODE, &response_code);
-        psRequest->nStatus = static_cast<int>(response_code);
-
-        char *content_type = nullptr;
-        curl_easy_getinfo(psRequest->m_curl_handle, CURLINFO_CONTENT_TYPE, &content_type);
-        psRequest->ContentType = content_type ? content_type : "";
-
-        if (psRequest->Error.empty())
-            psRequest->Error = &psRequest->m_curl_error[0];
-
-        /* In the case of a file:// URL, curl will return a status == 0, so if there's no */
-        /* error returned, patch the status code to be 200, as it would be for http:// */
-        if (psRequest->nStatus == 0 && psRequest->Error.empty() && STARTS_WITH(psRequest->URL.c_str(), "file://"))
-            psRequest->nStatus = 200;
-
-        // If there is an error with no error message, use the content if it is text
-        if (psRequest->Error.empty()
-            && psRequest->nStatus != 0
-            && psRequest->nStatus != 200
-            && strstr(psRequest->ContentType, "text")
-            && psRequest->pabyData != nullptr )
-            psRequest->Error = reinterpret_cast<const char *>(psRequest->pabyData);
-
-        CPLDebug("HTTP", "Request [%d] %s : status = %d, content type = %s, error = %s",
-                 i, psRequest->URL.c_str(), psRequest->nStatus,
-                 !psRequest->ContentType.empty() ? psRequest->ContentType.c_str() : "(null)",
-                 !psRequest->Error.empty() ? psRequest->Error.c_str() : "(null)");
-
-        curl_multi_remove_handle(curl_multi, pasRequest->m_curl_handle);
+        if (!pasRequest[i].m_finished)
+            WMSHTTPFinishRequest(curl_multi, &pasRequest[i], i);
     }
 
     curl_multi_cleanup(curl_multi);
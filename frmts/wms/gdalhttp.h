@@ -36,7 +36,7 @@
 
 struct WMSHTTPRequest {
     WMSHTTPRequest()
-        :options(nullptr), nStatus(0), pabyData(nullptr), nDataLen(0), nDataAlloc(0), m_curl_handle(nullptr), m_headers(nullptr), x(0), y(0) {}
+        :options(nullptr), nStatus(0), pabyData(nullptr), nDataLen(0), nDataAlloc(0), m_curl_handle(nullptr), m_headers(nullptr), m_finished(false), x(0), y(0) {}
     ~WMSHTTPRequest();
 
     /* Input */
@@ -57,6 +57,8 @@ struct WMSHTTPRequest {
     /* curl internal stuff */
     CURL *m_curl_handle;
     struct curl_slist* m_headers;
+    // Whether the output fields have been set
+    bool m_finished;
     // Which tile is being requested
     int x, y;
 
@@ -64,8 +66,15 @@ struct WMSHTTPRequest {
     std::vector<char> m_curl_error;
 };
 
+// Called as soon as a request completes, with its output fields set
+typedef void (*WMSHTTPRequestDoneFunc)(WMSHTTPRequest *psRequest,
+                                       void *pUserData);
+
 // Not public, only for use within WMS
 void WMSHTTPInitializeRequest(WMSHTTPRequest *psRequest);
-CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *psRequest, int nRequestCount = 1);
+CPLErr WMSHTTPFetchMulti(WMSHTTPRequest *psRequest, int nRequestCount = 1,
+                         WMSHTTPRequestDoneFunc pfnDone = nullptr,
+                         void *pDoneUserData = nullptr);
+void WMSHTTPCleanup();
 
 #endif /*  GDALHTTP_H */
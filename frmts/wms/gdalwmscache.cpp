@@ -32,6 +32,9 @@
 #include "cpl_md5.h"
 #include "wmsdriver.h"
 
+#include <climits>
+#include <memory>
+
 CPL_CVSID("$Id: gdalwmscache.cpp be1d2a671cb0636b2d346798b12e251131cde5e8 2017-12-21 13:35:54Z Even Rouault $")
 
 
@@ -200,23 +203,392 @@ private:
     long m_nMaxSize;
 };
 
+//------------------------------------------------------------------------------
+// GDALWMSPackStore
+//------------------------------------------------------------------------------
+// Tiles are appended to a single pack file, with their position recorded in
+// an append-only index file. The index is loaded in memory on opening, so
+// lookups do not touch the file system. Two generations are kept: when the
+// current one reaches half of the maximum size, the previous one is deleted
+// and a new current one is started. Tiles read from the previous generation
+// are copied to the current one, so the least recently used tiles are the
+// ones that get dropped, without scanning anything.
+// The store is shared by all the datasets of the process using the same
+// cache path, but must not be used concurrently by several processes.
+
+// Size of an index record: MD5 of the key, offset, size and time of the tile
+#define PACK_INDEX_RECORD_SIZE (32 + 8 + 4 + 8)
+
+class GDALWMSPackStore
+{
+public:
+    GDALWMSPackStore(const CPLString& soPath, GIntBig nMaxSize) :
+        m_soPath(soPath),
+        m_nMaxSize(nMaxSize)
+    {
+        VSIMkdirRecursive( m_soPath, 0744 );
+
+        // Find the two last generations
+        int nLastId = -1;
+        int nPrevId = -1;
+        char **papszList = VSIReadDir( m_soPath );
+        for( int i = 0; papszList != nullptr && papszList[i] != nullptr; ++i )
+        {
+            if( STARTS_WITH(papszList[i], "tiles") &&
+                EQUAL(CPLGetExtension(papszList[i]), "pack") )
+            {
+                const int nId = atoi(papszList[i] + strlen("tiles"));
+                if( nId > nLastId )
+                {
+                    nPrevId = nLastId;
+                    nLastId = nId;
+                }
+                else if( nId > nPrevId )
+                {
+                    nPrevId = nId;
+                }
+            }
+        }
+        CSLDestroy(papszList);
+
+        if( nPrevId >= 0 )
+            OpenGeneration( m_asGen[1], nPrevId, false );
+        if( nLastId < 0 || !OpenGeneration( m_asGen[0], nLastId, false ) )
+            OpenGeneration( m_asGen[0], nLastId + 1, true );
+    }
+
+    ~GDALWMSPackStore()
+    {
+        CloseGeneration( m_asGen[0] );
+        CloseGeneration( m_asGen[1] );
+    }
+
+    void Insert(const char *pszKey, const GByte *pabyData, size_t nSize)
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        Append( CPLMD5String(pszKey), pabyData, nSize,
+                static_cast<GIntBig>(time(nullptr)) );
+    }
+
+    bool GetTime(const char *pszKey, GIntBig *pnTime)
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        const CPLString osHash( CPLMD5String(pszKey) );
+        for( int i = 0; i < 2; ++i )
+        {
+            auto oIter = m_asGen[i].oIndex.find(osHash);
+            if( oIter != m_asGen[i].oIndex.end() )
+            {
+                *pnTime = oIter->second.nTime;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Read(const char *pszKey, std::vector<GByte> &abyData)
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        const CPLString osHash( CPLMD5String(pszKey) );
+        for( int i = 0; i < 2; ++i )
+        {
+            Generation &sGen = m_asGen[i];
+            auto oIter = sGen.oIndex.find(osHash);
+            if( oIter == sGen.oIndex.end() )
+                continue;
+            const Entry sEntry = oIter->second;
+            try
+            {
+                abyData.resize(sEntry.nSize);
+            }
+            catch( const std::exception& )
+            {
+                return false;
+            }
+            if( sEntry.nSize == 0 ||
+                VSIFSeekL( sGen.fpPack, sEntry.nOffset, SEEK_SET ) != 0 ||
+                VSIFReadL( &abyData[0], sEntry.nSize, 1, sGen.fpPack ) != 1 )
+            {
+                return false;
+            }
+            // Keep recently used tiles in the current generation
+            if( i == 1 )
+                Append( osHash, &abyData[0], abyData.size(), sEntry.nTime );
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Entry
+    {
+        vsi_l_offset nOffset;
+        GUInt32 nSize;
+        GIntBig nTime;
+    };
+
+    struct Generation
+    {
+        int nId = -1;
+        VSILFILE *fpPack = nullptr;
+        VSILFILE *fpIndex = nullptr;
+        vsi_l_offset nPackSize = 0;
+        std::map<CPLString, Entry> oIndex{};
+    };
+
+    CPLString GetFilename(int nId, const char *pszExt) const
+    {
+        return CPLFormFilename( m_soPath, CPLSPrintf("tiles%d", nId),
+                                pszExt );
+    }
+
+    bool OpenGeneration(Generation &sGen, int nId, bool bCreate)
+    {
+        const char *pszAccess = bCreate ? "wb+" : "rb+";
+        sGen.nId = nId;
+        sGen.fpPack = VSIFOpenL( GetFilename(nId, "pack"), pszAccess );
+        sGen.fpIndex = VSIFOpenL( GetFilename(nId, "idx"), pszAccess );
+        if( sGen.fpPack == nullptr || sGen.fpIndex == nullptr )
+        {
+            CloseGeneration( sGen );
+            return false;
+        }
+        VSIFSeekL( sGen.fpPack, 0, SEEK_END );
+        sGen.nPackSize = VSIFTellL( sGen.fpPack );
+
+        // Records of tiles not completely written are ignored
+        GByte abyRecord[PACK_INDEX_RECORD_SIZE];
+        vsi_l_offset nIndexSize = 0;
+        while( VSIFReadL( abyRecord, sizeof(abyRecord), 1,
+                          sGen.fpIndex ) == 1 )
+        {
+            Entry sEntry;
+            GUInt64 nOffset;
+            memcpy( &nOffset, abyRecord + 32, 8 );
+            CPL_LSBPTR64( &nOffset );
+            sEntry.nOffset = static_cast<vsi_l_offset>(nOffset);
+            memcpy( &sEntry.nSize, abyRecord + 40, 4 );
+            CPL_LSBPTR32( &sEntry.nSize );
+            memcpy( &sEntry.nTime, abyRecord + 44, 8 );
+            CPL_LSBPTR64( &sEntry.nTime );
+            if( sEntry.nOffset + sEntry.nSize > sGen.nPackSize )
+                break;
+            sGen.oIndex[CPLString(reinterpret_cast<char *>(abyRecord), 32)] =
+                sEntry;
+            nIndexSize += sizeof(abyRecord);
+        }
+        VSIFSeekL( sGen.fpIndex, nIndexSize, SEEK_SET );
+        return true;
+    }
+
+    static void CloseGeneration(Generation &sGen)
+    {
+        if( sGen.fpPack != nullptr )
+            VSIFCloseL( sGen.fpPack );
+        if( sGen.fpIndex != nullptr )
+            VSIFCloseL( sGen.fpIndex );
+        sGen.fpPack = nullptr;
+        sGen.fpIndex = nullptr;
+        sGen.nPackSize = 0;
+        sGen.oIndex.clear();
+    }
+
+    // Called with m_oMutex held
+    void Append(const CPLString &osHash, const GByte *pabyData, size_t nSize,
+                GIntBig nTime)
+    {
+        if( m_asGen[0].nPackSize + nSize > static_cast<GUIntBig>(m_nMaxSize / 2) &&
+            !m_asGen[0].oIndex.empty() )
+        {
+            Rotate();
+        }
+        Generation &sGen = m_asGen[0];
+        if( sGen.fpPack == nullptr || nSize == 0 || nSize > static_cast<size_t>(UINT_MAX) )
+            return;
+
+        Entry sEntry;
+        sEntry.nOffset = sGen.nPackSize;
+        sEntry.nSize = static_cast<GUInt32>(nSize);
+        sEntry.nTime = nTime;
+
+        GByte abyRecord[PACK_INDEX_RECORD_SIZE];
+        memcpy( abyRecord, osHash.c_str(), 32 );
+        GUInt64 nOffset = static_cast<GUInt64>(sEntry.nOffset);
+        CPL_LSBPTR64( &nOffset );
+        memcpy( abyRecord + 32, &nOffset, 8 );
+        GUInt32 nSize32 = sEntry.nSize;
+        CPL_LSBPTR32( &nSize32 );
+        memcpy( abyRecord + 40, &nSize32, 4 );
+        GIntBig nTime64 = sEntry.nTime;
+        CPL_LSBPTR64( &nTime64 );
+        memcpy( abyRecord + 44, &nTime64, 8 );
+
+        if( VSIFSeekL( sGen.fpPack, sEntry.nOffset, SEEK_SET ) != 0 ||
+            VSIFWriteL( pabyData, nSize, 1, sGen.fpPack ) != 1 ||
+            VSIFWriteL( abyRecord, sizeof(abyRecord), 1, sGen.fpIndex ) != 1 )
+        {
+            CPLError( CE_Warning, CPLE_FileIO, "Error writing to WMS cache %s",
+                      m_soPath.c_str() );
+            return;
+        }
+        sGen.nPackSize += nSize;
+        sGen.oIndex[osHash] = sEntry;
+    }
+
+    void Rotate()
+    {
+        const int nPrevId = m_asGen[1].nId;
+        CloseGeneration( m_asGen[1] );
+        if( nPrevId >= 0 )
+        {
+            VSIUnlink( GetFilename(nPrevId, "pack") );
+            VSIUnlink( GetFilename(nPrevId, "idx") );
+        }
+        std::swap( m_asGen[0], m_asGen[1] );
+        OpenGeneration( m_asGen[0], m_asGen[1].nId + 1, true );
+        CPLDebug( "WMS", "Cache %s: starting generation %d",
+                  m_soPath.c_str(), m_asGen[0].nId );
+    }
+
+    CPLString m_soPath;
+    GIntBig m_nMaxSize;
+    std::mutex m_oMutex{};
+    Generation m_asGen[2]{};  // current and previous generations
+};
+
+static std::mutex goPackStoresMutex;
+static std::map<CPLString, std::weak_ptr<GDALWMSPackStore>> goPackStores;
+
+static std::shared_ptr<GDALWMSPackStore> GetPackStore(const CPLString& soPath,
+                                                      GIntBig nMaxSize)
+{
+    std::lock_guard<std::mutex> oLock(goPackStoresMutex);
+    std::shared_ptr<GDALWMSPackStore> poStore = goPackStores[soPath].lock();
+    if( !poStore )
+    {
+        poStore = std::make_shared<GDALWMSPackStore>(soPath, nMaxSize);
+        goPackStores[soPath] = poStore;
+    }
+    return poStore;
+}
+
+// Opens a dataset from the content of a tile
+static GDALDataset* OpenFromBuffer(const std::vector<GByte>& abyData,
+                                   char **papszOpenOptions)
+{
+    GByte *pabyCopy = static_cast<GByte *>(VSI_MALLOC_VERBOSE(abyData.size()));
+    if( pabyCopy == nullptr )
+        return nullptr;
+    memcpy( pabyCopy, &abyData[0], abyData.size() );
+    CPLString soFileName;
+    soFileName.Printf( "/vsimem/wmscache/%p/tile.dat", pabyCopy );
+    VSILFILE *fp = VSIFileFromMemBuffer( soFileName, pabyCopy,
+                                         abyData.size(), TRUE );
+    if( fp == nullptr )
+    {
+        CPLFree( pabyCopy );
+        return nullptr;
+    }
+    VSIFCloseL( fp );
+    GDALDataset *poDS = reinterpret_cast<GDALDataset*>(
+                GDALOpenEx( soFileName, GDAL_OF_RASTER |
+                           GDAL_OF_READONLY | GDAL_OF_VERBOSE_ERROR, nullptr,
+                           papszOpenOptions, nullptr ) );
+    // The content remains available until the dataset is closed
+    VSIUnlink( soFileName );
+    return poDS;
+}
+
+//------------------------------------------------------------------------------
+// GDALWMSPackCache
+//------------------------------------------------------------------------------
+class GDALWMSPackCache : public GDALWMSCacheImpl
+{
+public:
+    GDALWMSPackCache(const CPLString& soPath, CPLXMLNode *pConfig) :
+        GDALWMSCacheImpl(soPath, pConfig),
+        m_nExpires(604800)   // 7 days
+    {
+        const char *pszCacheExpires = CPLGetXMLValue( pConfig, "Expires", nullptr );
+        if( pszCacheExpires != nullptr )
+        {
+            m_nExpires = atoi( pszCacheExpires );
+            CPLDebug("WMS", "Cache expires in %d sec", m_nExpires);
+        }
+        m_poStore = GetPackStore( soPath, CPLAtoGIntBig(
+            CPLGetXMLValue( pConfig, "MaxSize", "67108864" ) ) );  // 64 Mb
+    }
+
+    virtual CPLErr Insert(const char *pszKey, const CPLString &osFileName) override
+    {
+        // Warns if it fails to write, but returns success
+        vsi_l_offset nSize = 0;
+        GByte *pabyData = VSIGetMemFileBuffer( osFileName, &nSize, FALSE );
+        if( pabyData != nullptr )
+            m_poStore->Insert( pszKey, pabyData, static_cast<size_t>(nSize) );
+        return CE_None;
+    }
+
+    virtual enum GDALWMSCacheItemStatus GetItemStatus(const char *pszKey) const override
+    {
+        GIntBig nTime = 0;
+        if( m_poStore->GetTime( pszKey, &nTime ) )
+        {
+            long seconds = static_cast<long>( time( nullptr ) - nTime );
+            return seconds < m_nExpires ? CACHE_ITEM_OK : CACHE_ITEM_EXPIRED;
+        }
+        return CACHE_ITEM_NOT_FOUND;
+    }
+
+    virtual GDALDataset* GetDataset(const char *pszKey, char **papszOpenOptions) const override
+    {
+        std::vector<GByte> abyData;
+        if( !m_poStore->Read( pszKey, abyData ) )
+            return nullptr;
+        return OpenFromBuffer( abyData, papszOpenOptions );
+    }
+
+    virtual void Clean() override
+    {
+        // The size is bounded by the rotation of generations in Insert()
+    }
+
+private:
+    std::shared_ptr<GDALWMSPackStore> m_poStore{};
+    int m_nExpires;
+};
+
 //------------------------------------------------------------------------------
 // GDALWMSCache
 //------------------------------------------------------------------------------
 #define CLEAN_THREAD_RUN_TIMEOUT 120 // 3 min
+#define MAX_PENDING_WRITES_SIZE (64 * 1024 * 1024)
 
 GDALWMSCache::GDALWMSCache() :
     m_osCachePath("./gdalwmscache"),
     m_bIsCleanThreadRunning(false),
     m_nCleanThreadLastRunTime(0),
     m_poCache(nullptr),
-    m_hThread(nullptr)
+    m_hThread(nullptr),
+    m_bAsyncWrites(true),
+    m_hWriteThread(nullptr),
+    m_nPendingBytes(0),
+    m_bStopWriteThread(false)
 {
 
 }
 
 GDALWMSCache::~GDALWMSCache()
 {
+    if( m_hWriteThread )
+    {
+        {
+            std::lock_guard<std::mutex> oLock(m_oWriteMutex);
+            m_bStopWriteThread = true;
+        }
+        m_oWriteCond.notify_all();
+        CPLJoinThread(m_hWriteThread);
+    }
     if( m_hThread )
         CPLJoinThread(m_hThread);
     delete m_poCache;
@@ -247,16 +619,94 @@ CPLErr GDALWMSCache::Initialize(const char *pszUrl, CPLXMLNode *pConfig) {
     {
         m_poCache = new GDALWMSFileCache(m_osCachePath, pConfig);
     }
+    else if( EQUAL(pszType, "pack") )
+    {
+        m_poCache = new GDALWMSPackCache(m_osCachePath, pConfig);
+    }
+
+    m_bAsyncWrites = CPLTestBool( CPLGetXMLValue( pConfig, "AsyncWrites", "True" ) );
 
     return CE_None;
 }
 
+void GDALWMSCache::WriteThread( void *pData )
+{
+    GDALWMSCache *pCache = static_cast<GDALWMSCache *>(pData);
+    std::unique_lock<std::mutex> oLock(pCache->m_oWriteMutex);
+    while( true )
+    {
+        while( pCache->m_aoPendingWrites.empty() && !pCache->m_bStopWriteThread )
+            pCache->m_oWriteCond.wait(oLock);
+        if( pCache->m_aoPendingWrites.empty() )
+            break;
+
+        // Keep the tile in the queue while writing it, so that it can
+        // still be read from there
+        const CPLString osKey( pCache->m_aoPendingWrites.front().first );
+        std::vector<GByte> &abyData = pCache->m_aoPendingWrites.front().second;
+        CPLString soFileName;
+        soFileName.Printf( "/vsimem/wmscache/%p/pending.dat", &abyData[0] );
+        VSILFILE *fp = VSIFileFromMemBuffer( soFileName, &abyData[0],
+                                             abyData.size(), FALSE );
+        oLock.unlock();
+        if( fp != nullptr )
+        {
+            VSIFCloseL( fp );
+            pCache->m_poCache->Insert( osKey, soFileName );
+            VSIUnlink( soFileName );
+        }
+        oLock.lock();
+
+        pCache->m_nPendingBytes -= abyData.size();
+        pCache->m_aoPendingWrites.pop_front();
+        pCache->m_oWriteCond.notify_all();
+    }
+}
+
+bool GDALWMSCache::FindPendingWrite( const char *pszKey,
+                                     std::vector<GByte> *pabyData ) const
+{
+    std::lock_guard<std::mutex> oLock(m_oWriteMutex);
+    for( const auto& oPending : m_aoPendingWrites )
+    {
+        if( oPending.first == pszKey )
+        {
+            if( pabyData != nullptr )
+                *pabyData = oPending.second;
+            return true;
+        }
+    }
+    return false;
+}
+
 CPLErr GDALWMSCache::Insert(const char *pszKey, const CPLString &soFileName)
 {
     if( m_poCache != nullptr && pszKey != nullptr )
     {
         // Add file to cache
-        CPLErr result = m_poCache->Insert(pszKey, soFileName);
+        CPLErr result = CE_Failure;
+        vsi_l_offset nSize = 0;
+        GByte *pabyData = m_bAsyncWrites ?
+            VSIGetMemFileBuffer( soFileName, &nSize, FALSE ) : nullptr;
+        if( pabyData != nullptr && nSize > 0 )
+        {
+            // Written by a background thread, to avoid stalling the reader
+            std::unique_lock<std::mutex> oLock(m_oWriteMutex);
+            while( m_nPendingBytes > MAX_PENDING_WRITES_SIZE )
+                m_oWriteCond.wait(oLock);
+            m_aoPendingWrites.emplace_back( CPLString(pszKey),
+                std::vector<GByte>(pabyData, pabyData + nSize) );
+            m_nPendingBytes += static_cast<size_t>(nSize);
+            if( m_hWriteThread == nullptr )
+                m_hWriteThread = CPLCreateJoinableThread(WriteThread, this);
+            oLock.unlock();
+            m_oWriteCond.notify_all();
+            result = CE_None;
+        }
+        else
+        {
+            result = m_poCache->Insert(pszKey, soFileName);
+        }
         if( result == CE_None )
         {
             // Start clean thread
@@ -278,6 +728,8 @@ enum GDALWMSCacheItemStatus GDALWMSCache::GetItemStatus(const char *pszKey) cons
 {
     if( m_poCache != nullptr )
     {
+        if( m_hWriteThread != nullptr && FindPendingWrite(pszKey, nullptr) )
+            return CACHE_ITEM_OK;
         return m_poCache->GetItemStatus(pszKey);
     }
     return CACHE_ITEM_NOT_FOUND;
@@ -288,6 +740,9 @@ GDALDataset* GDALWMSCache::GetDataset(const char *pszKey,
 {
     if( m_poCache != nullptr )
     {
+        std::vector<GByte> abyData;
+        if( m_hWriteThread != nullptr && FindPendingWrite(pszKey, &abyData) )
+            return OpenFromBuffer(abyData, papszOpenOptions);
         return m_poCache->GetDataset(pszKey, papszOpenOptions);
     }
     return nullptr;
@@ -30,9 +30,41 @@
  ****************************************************************************/
 
 #include "wmsdriver.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <memory>
 
 CPL_CVSID("$Id: gdalwmsrasterband.cpp fddfceb183947474191f71cad2eadb928c14288a 2019-02-02 16:37:17 -0800 Lucian Plesea $")
 
+struct GDALWMSDecodeContext;
+
+struct GDALWMSDecodeJob
+{
+    GDALWMSDecodeContext *psContext = nullptr;
+    WMSHTTPRequest       *psRequest = nullptr;
+    std::vector<GByte>    abyTile{};  // decoded tile, for all bands
+    bool                  bDecoded = false;
+};
+
+// Tiles are decoded by the global worker thread pool while the other ones
+// are still being downloaded. Tiles that could not be decoded this way are handled as
+// before, in the calling thread, after downloading.
+struct GDALWMSDecodeContext
+{
+    GDALWMSRasterBand    *poBand = nullptr;
+    std::unique_ptr<CPLJobQueue> poQueue{};
+    WMSHTTPRequest       *pasRequests = nullptr;
+    std::vector<GDALWMSDecodeJob> asJobs{};
+    size_t                nTileBytes = 0;
+    size_t                nRemainingBytes = 0;  // memory budget for tiles
+
+    void WaitForJobs()
+    {
+        if( poQueue )
+            poQueue->WaitCompletion();
+    }
+};
+
 GDALWMSRasterBand::GDALWMSRasterBand(GDALWMSDataset *parent_dataset, int band,
                                         double scale):
     m_parent_dataset(parent_dataset),
@@ -167,11 +199,34 @@ CPLErr GDALWMSRasterBand::ReadBlocks(int x, int y, void *buffer, int bx0, int by
         }
     }
 
+    // Decode the tiles in worker threads as soon as they are downloaded
+    GDALWMSDecodeContext sDecodeContext;
+    if (!advise_read && count >= 2) {
+        const int nThreads = CPLGetNumThreads(nullptr, "ALL_CPUS");
+        CPLWorkerThreadPool *poPool =
+            nThreads > 1 ? CPLGetGlobalWorkerThreadPool(nThreads) : nullptr;
+        if (poPool != nullptr)
+            sDecodeContext.poQueue = poPool->CreateJobQueue();
+        if (sDecodeContext.poQueue) {
+            sDecodeContext.poBand = this;
+            sDecodeContext.pasRequests = &requests[0];
+            sDecodeContext.asJobs.resize(count);
+            sDecodeContext.nTileBytes =
+                static_cast<size_t>(nBlockXSize) * nBlockYSize *
+                (GDALGetDataTypeSize(eDataType) / 8) * m_parent_dataset->nBands;
+            sDecodeContext.nRemainingBytes =
+                static_cast<size_t>(GDALGetCacheMax64() / 4);
+        }
+    }
+
     // Fetch all the requests, OK to call with count of 0
-    if (WMSHTTPFetchMulti(count ? &requests[0] : nullptr, static_cast<int>(count)) != CE_None) {
+    if (WMSHTTPFetchMulti(count ? &requests[0] : nullptr, static_cast<int>(count),
+                          sDecodeContext.poQueue ? DecodeRequestDone : nullptr,
+                          &sDecodeContext) != CE_None) {
         CPLError(CE_Failure, CPLE_AppDefined, "GDALWMS: CPLHTTPFetchMulti failed.");
         ret = CE_Failure;
     }
+    sDecodeContext.WaitForJobs();
 
     for (size_t i = 0; i < count; ++i) {
         WMSHTTPRequest &request = requests[i];
@@ -202,7 +257,13 @@ CPLErr GDALWMSRasterBand::ReadBlocks(int x, int y, void *buffer, int bx0, int by
                             if (cache != nullptr)
                                 cache->Insert(request.URL, file_name);
                         } else {
-                            ret = ReadBlockFromFile(file_name, request.x,
+                            if (i < sDecodeContext.asJobs.size() &&
+                                sDecodeContext.asJobs[i].bDecoded)
+                                ret = StoreDecodedBlock(
+                                    &sDecodeContext.asJobs[i].abyTile[0],
+                                    request.x, request.y, nBand, p);
+                            else
+                                ret = ReadBlockFromFile(file_name, request.x,
                                                      request.y, nBand, p, advise_read);
                             if (ret == CE_None) {
                                 if (cache != nullptr)
@@ -262,6 +323,64 @@ CPLErr GDALWMSRasterBand::ReadBlocks(int x, int y, void *buffer, int bx0, int by
     return ret;
 }
 
+// Called in the downloading thread when a request completes
+void GDALWMSRasterBand::DecodeRequestDone(WMSHTTPRequest *psRequest,
+                                          void *pUserData) {
+    GDALWMSDecodeContext *psContext =
+        static_cast<GDALWMSDecodeContext *>(pUserData);
+    const int success = (psRequest->nStatus == 200) ||
+                        (!psRequest->Range.empty() && psRequest->nStatus == 206);
+    if (!success || psRequest->pabyData == nullptr || psRequest->nDataLen < 20)
+        return;
+    // Server exceptions are reported by the calling thread
+    const char *download_data = reinterpret_cast<char *>(psRequest->pabyData);
+    if (STARTS_WITH_CI(download_data, "<?xml ")
+        || STARTS_WITH_CI(download_data, "<!DOCTYPE ")
+        || STARTS_WITH_CI(download_data, "<ServiceException"))
+        return;
+    if (psContext->nTileBytes > psContext->nRemainingBytes)
+        return;
+
+    GDALWMSDecodeJob &job =
+        psContext->asJobs[psRequest - psContext->pasRequests];
+    try {
+        job.abyTile.resize(psContext->nTileBytes);
+    } catch (const std::exception &) {
+        return;
+    }
+    psContext->nRemainingBytes -= psContext->nTileBytes;
+    job.psContext = psContext;
+    job.psRequest = psRequest;
+    if (!psContext->poQueue->SubmitJob(DecodeThreadFunc, &job))
+        psContext->nRemainingBytes += psContext->nTileBytes;
+}
+
+void GDALWMSRasterBand::DecodeThreadFunc(void *pData) {
+    GDALWMSDecodeJob *psJob = static_cast<GDALWMSDecodeJob *>(pData);
+    GDALWMSDecodeContext *psContext = psJob->psContext;
+    WMSHTTPRequest *psRequest = psJob->psRequest;
+    GDALWMSRasterBand *poBand = psContext->poBand;
+
+    // Errors are emitted again by the calling thread if decoding fails
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    CPLString file_name(BufferToVSIFile(psRequest->pabyData, psRequest->nDataLen));
+    if (!file_name.empty()) {
+        GDALDataset *ds = reinterpret_cast<GDALDataset*>(GDALOpenEx( file_name,
+                                                        GDAL_OF_RASTER
+                                                        | GDAL_OF_READONLY,
+                                                        nullptr,
+                                                        poBand->m_parent_dataset->m_tileOO,
+                                                        nullptr ) );
+        if (ds != nullptr) {
+            psJob->bDecoded = poBand->ReadBlockFromDataset(ds,
+                psRequest->x, psRequest->y, 0, nullptr, 0,
+                &psJob->abyTile[0]) == CE_None;
+        }
+        VSIUnlink(file_name);
+    }
+    CPLPopErrorHandler();
+}
+
 CPLErr GDALWMSRasterBand::IReadBlock(int x, int y, void *buffer) {
     int bx0 = x;
     int by0 = y;
@@ -608,9 +727,12 @@ static const int * GetBandMapForExpand( int nSourceBands, int nWmsBands )
     return bandmap_selector[nWmsBands - 1][nSourceBands - 1];
 }
 
+// If tile_buffer is set, the tile is decoded in it, band after band,
+// instead of in the block cache
 CPLErr GDALWMSRasterBand::ReadBlockFromDataset(GDALDataset *ds, int x,
                                                int y, int to_buffer_band,
-                                               void *buffer, int advise_read)
+                                               void *buffer, int advise_read,
+                                               GByte *tile_buffer)
 {
     CPLErr ret = CE_None;
     GByte *color_table = nullptr;
@@ -706,7 +828,13 @@ CPLErr GDALWMSRasterBand::ReadBlockFromDataset(GDALDataset *ds, int x,
             {
                 void *p = nullptr;
                 GDALRasterBlock *b = nullptr;
-                if ((buffer != nullptr) && (ib == to_buffer_band))
+                if (tile_buffer != nullptr)
+                {
+                    p = tile_buffer + static_cast<size_t>(ib - 1) *
+                            nBlockXSize * nBlockYSize *
+                            (GDALGetDataTypeSize(eDataType) / 8);
+                }
+                else if ((buffer != nullptr) && (ib == to_buffer_band))
                 {
                     p = buffer;
                 }
@@ -921,6 +1049,47 @@ CPLErr GDALWMSRasterBand::ZeroBlock(int x, int y, int to_buffer_band, void *buff
     return ret;
 }
 
+// Copies a tile decoded by ReadBlockFromDataset() in a tile buffer to the
+// block cache
+CPLErr GDALWMSRasterBand::StoreDecodedBlock(const GByte *tile_buffer, int x,
+                                            int y, int to_buffer_band,
+                                            void *buffer) {
+    CPLErr ret = CE_None;
+    const size_t block_size = static_cast<size_t>(nBlockXSize) * nBlockYSize *
+                              (GDALGetDataTypeSize(eDataType) / 8);
+
+    for (int ib = 1; ib <= m_parent_dataset->nBands; ++ib) {
+        if (ret == CE_None) {
+            void *p = nullptr;
+            GDALRasterBlock *b = nullptr;
+            if ((buffer != nullptr) && (ib == to_buffer_band)) {
+                p = buffer;
+            } else {
+                GDALWMSRasterBand *band = static_cast<GDALWMSRasterBand *>(m_parent_dataset->GetRasterBand(ib));
+                if (m_overview >= 0) band = static_cast<GDALWMSRasterBand *>(band->GetOverview(m_overview));
+                if (!band->IsBlockInCache(x, y)) {
+                    b = band->GetLockedBlockRef(x, y, true);
+                    if (b != nullptr) {
+                        p = b->GetDataRef();
+                        if (p == nullptr) {
+                          CPLError(CE_Failure, CPLE_AppDefined, "GDALWMS: GetDataRef returned NULL.");
+                          ret = CE_Failure;
+                        }
+                    }
+                }
+            }
+            if (p != nullptr) {
+                memcpy(p, tile_buffer + (ib - 1) * block_size, block_size);
+            }
+            if (b != nullptr) {
+                b->DropLock();
+            }
+        }
+    }
+
+    return ret;
+}
+
 CPLErr GDALWMSRasterBand::ReportWMSException(const char *file_name) {
     CPLErr ret = CE_None;
     int reported_errors_count = 0;
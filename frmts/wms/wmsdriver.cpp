@@ -1025,6 +1025,7 @@ GDALDataset *GDALWMSDataset::CreateCopy( const char * pszFilename,
 
 void WMSDeregister(CPL_UNUSED GDALDriver *d) {
     GDALWMSDataset::DestroyCfgMutex();
+    WMSHTTPCleanup();
 }
 
 // Define a minidriver factory type, create one and register it
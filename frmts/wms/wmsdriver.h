@@ -36,7 +36,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <set>
 #include <vector>
 #include <utility>
@@ -266,6 +269,18 @@ protected:
 private:
     GDALWMSCacheImpl* m_poCache;
     CPLJoinableThread* m_hThread;
+
+    // Tiles waiting to be written by the writer thread
+    static void WriteThread(void *pData);
+    bool FindPendingWrite(const char *pszKey,
+                          std::vector<GByte> *pabyData) const;
+    bool m_bAsyncWrites;
+    CPLJoinableThread* m_hWriteThread;
+    mutable std::mutex m_oWriteMutex;
+    std::condition_variable m_oWriteCond;
+    std::deque<std::pair<CPLString, std::vector<GByte>>> m_aoPendingWrites;
+    size_t m_nPendingBytes;
+    bool m_bStopWriteThread;
 };
 
 /************************************************************************/
@@ -503,8 +518,13 @@ protected:
     CPLErr ReadBlockFromFile(const CPLString& soFileName, int x, int y,
                               int to_buffer_band, void *buffer, int advise_read);
     CPLErr ReadBlockFromDataset(GDALDataset *ds, int x, int y, int to_buffer_band,
-                                                   void *buffer, int advise_read);
+                                                   void *buffer, int advise_read,
+                                                   GByte *tile_buffer = nullptr);
     CPLErr ZeroBlock(int x, int y, int to_buffer_band, void *buffer);
+    CPLErr StoreDecodedBlock(const GByte *tile_buffer, int x, int y,
+                             int to_buffer_band, void *buffer);
+    static void DecodeRequestDone(WMSHTTPRequest *psRequest, void *pUserData);
+    static void DecodeThreadFunc(void *pData);
     static CPLErr ReportWMSException(const char *file_name);
 
 protected:
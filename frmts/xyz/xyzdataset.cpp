@@ -94,6 +94,18 @@ class XYZRasterBand : public GDALPamRasterBand
 
     int          nLastYOff;
 
+    // Only used if bSameNumberOfValuesPerLine: file offset and line number
+    // of the first line of the rows met so far, so that going back to a
+    // previous row does not require reading the file from its start.
+    struct RowStart
+    {
+        vsi_l_offset nOffset;
+        GIntBig      nLineNum;
+    };
+    std::vector<RowStart> asRowStart;
+
+    void         RecordRowStart( GIntBig nDataLineNum );
+
   public:
 
                 XYZRasterBand( XYZDataset *, int, GDALDataType );
@@ -109,7 +121,8 @@ class XYZRasterBand : public GDALPamRasterBand
 /************************************************************************/
 
 XYZRasterBand::XYZRasterBand( XYZDataset *poDSIn, int nBandIn, GDALDataType eDT ) :
-    nLastYOff(-1)
+    nLastYOff(-1),
+    asRowStart()
 {
     poDS = poDSIn;
     nBand = nBandIn;
@@ -120,6 +133,25 @@ XYZRasterBand::XYZRasterBand( XYZDataset *poDSIn, int nBandIn, GDALDataType eDT
     nBlockYSize = 1;
 }
 
+/************************************************************************/
+/*                           RecordRowStart()                           */
+/************************************************************************/
+
+void XYZRasterBand::RecordRowStart( GIntBig nDataLineNum )
+{
+    XYZDataset *poGDS = reinterpret_cast<XYZDataset *>( poDS );
+
+    if( nDataLineNum % nBlockXSize == 0 &&
+        nDataLineNum / nBlockXSize == static_cast<GIntBig>(asRowStart.size()) &&
+        nDataLineNum / nBlockXSize < nRasterYSize )
+    {
+        RowStart sRowStart;
+        sRowStart.nOffset = VSIFTellL(poGDS->fp);
+        sRowStart.nLineNum = poGDS->nLineNum;
+        asRowStart.push_back(sRowStart);
+    }
+}
+
 /************************************************************************/
 /*                             IReadBlock()                             */
 /************************************************************************/
@@ -146,7 +178,16 @@ CPLErr XYZRasterBand::IReadBlock( CPL_UNUSED int nBlockXOff,
 
     // Only valid if bSameNumberOfValuesPerLine.
     const GIntBig nLineInFile = static_cast<GIntBig>(nBlockYOff) * nBlockXSize;
-    if ( (poGDS->bSameNumberOfValuesPerLine && poGDS->nDataLineNum > nLineInFile) ||
+    if( poGDS->bSameNumberOfValuesPerLine &&
+        poGDS->nDataLineNum != nLineInFile &&
+        nBlockYOff < static_cast<int>(asRowStart.size()) )
+    {
+        poGDS->nDataLineNum = nLineInFile;
+        poGDS->nLineNum = asRowStart[nBlockYOff].nLineNum;
+        poGDS->bEOF = false;
+        VSIFSeekL(poGDS->fp, asRowStart[nBlockYOff].nOffset, SEEK_SET);
+    }
+    else if ( (poGDS->bSameNumberOfValuesPerLine && poGDS->nDataLineNum > nLineInFile) ||
          (!poGDS->bSameNumberOfValuesPerLine && (nLastYOff == -1 || nBlockYOff == 0)) )
     {
         poGDS->nDataLineNum = 0;
@@ -245,7 +286,9 @@ CPLErr XYZRasterBand::IReadBlock( CPL_UNUSED int nBlockXOff,
                 continue;
 
             poGDS->nDataLineNum ++;
+            RecordRowStart(poGDS->nDataLineNum);
         }
+        RecordRowStart(poGDS->nDataLineNum);
     }
 
     const double dfExpectedY
@@ -319,7 +362,8 @@ CPLErr XYZRasterBand::IReadBlock( CPL_UNUSED int nBlockXOff,
                         else if( nCol == poGDS->nZIndex)
                         {
                             nUsefulColsFound ++;
-                            dfZ = CPLAtofDelim(pszPtr, poGDS->chDecimalSep);
+                            if( pImage )
+                                dfZ = CPLAtofDelim(pszPtr, poGDS->chDecimalSep);
                         }
                     }
                     bLastWasSep = false;
@@ -299,6 +299,17 @@ typedef GIntBig GSpacing;
  */
 #define GDAL_DMD_EXTENSIONS "DMD_EXTENSIONS"
 
+/** List of (space separated) signatures of the files handled by the driver.
+ * Each signature is the hexadecimal encoding of the first bytes of a file,
+ * optionally prefixed with a decimal byte offset and a colon, e.g.
+ * "4949 4D4D" or "8:57454250". Letters are compared case insensitively.
+ * When a driver declares signatures, GDALOpenEx() and GDALIdentifyDriverEx()
+ * do not try it on files whose header matches none of them, so they must
+ * cover all the files that the driver can open.
+ * @since GDAL 3.1
+ */
+#define GDAL_DMD_SIGNATURES "DMD_SIGNATURES"
+
 /** XML snippet with creation options. */
 #define GDAL_DMD_CREATIONOPTIONLIST "DMD_CREATIONOPTIONLIST"
 
@@ -526,6 +537,11 @@ GDALDatasetH CPL_DLL CPL_STDCALL GDALOpenEx( const char* pszFilename,
                                              const char* const* papszOpenOptions,
                                              const char* const* papszSiblingFiles ) CPL_WARN_UNUSED_RESULT;
 
+GDALDatasetH CPL_DLL GDALOpenThreadSafeVectorDataset(
+                                    const char* pszFilename,
+                                    const char* const* papszAllowedDrivers,
+                                    const char* const* papszOpenOptions ) CPL_WARN_UNUSED_RESULT;
+
 int          CPL_DLL CPL_STDCALL GDALDumpOpenDatasets( FILE * );
 
 GDALDriverH CPL_DLL CPL_STDCALL GDALGetDriverByName( const char * );
@@ -710,6 +726,15 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                          const char *pszResampling,
                          GDALProgressFunc pfnProgress, void *pProgressData );
 
+CPLErr CPL_DLL
+GDALRegenerateOverviewsWindow( GDALRasterBandH hSrcBand,
+                               int nOverviewCount,
+                               GDALRasterBandH *pahOverviewBands,
+                               const char *pszResampling,
+                               int nXOff, int nYOff, int nXSize, int nYSize,
+                               GDALProgressFunc pfnProgress,
+                               void *pProgressData );
+
 int    CPL_DLL GDALDatasetGetLayerCount( GDALDatasetH );
 OGRLayerH CPL_DLL GDALDatasetGetLayer( GDALDatasetH, int );
 OGRLayerH CPL_DLL GDALDatasetGetLayerByName( GDALDatasetH, const char * );
@@ -843,6 +868,12 @@ CPLErr CPL_DLL CPL_STDCALL GDALSetRasterScale( GDALRasterBandH hBand, double dfN
 void CPL_DLL CPL_STDCALL
 GDALComputeRasterMinMax( GDALRasterBandH hBand, int bApproxOK,
                          double adfMinMax[2] );
+CPLErr CPL_DLL CPL_STDCALL
+GDALComputeRasterQuantiles( GDALRasterBandH hBand, int bApproxOK,
+                            int nQuantiles, const double* padfProbabilities,
+                            double* padfQuantiles,
+                            GDALProgressFunc pfnProgress,
+                            void *pProgressData );
 CPLErr CPL_DLL CPL_STDCALL GDALFlushRasterCache( GDALRasterBandH hBand );
 CPLErr CPL_DLL CPL_STDCALL GDALGetRasterHistogram( GDALRasterBandH hBand,
                                        double dfMin, double dfMax,
@@ -1208,6 +1239,21 @@ GIntBig CPL_DLL CPL_STDCALL GDALGetCacheUsed64(void);
 
 int CPL_DLL CPL_STDCALL GDALFlushCacheBlock(void);
 
+/** Block cache statistics, as returned by GDALGetCacheStatistics().
+ * @since GDAL 3.1 */
+typedef struct
+{
+    GIntBig nLookups;         /*!< Number of block lookups in the cache */
+    GIntBig nHits;            /*!< Number of lookups that found the block */
+    GIntBig nMisses;          /*!< Number of lookups that did not find it */
+    GIntBig nEvictions;       /*!< Number of blocks evicted by the cache */
+    GIntBig nDirtyWriteBacks; /*!< Number of dirty blocks written back */
+    GIntBig nBytesResident;   /*!< Memory currently used by cached blocks */
+} GDALCacheStatistics;
+
+void CPL_DLL GDALGetCacheStatistics( GDALCacheStatistics* psStats );
+void CPL_DLL GDALResetCacheStatistics( void );
+
 /* ==================================================================== */
 /*      GDAL virtual memory                                             */
 /* ==================================================================== */
@@ -343,6 +343,13 @@ const char CPL_DLL * PamAllocateProxy( const char * );
 const char CPL_DLL * PamDeallocateProxy( const char * );
 void CPL_DLL PamCleanProxyDB( void );
 
+// For the store of PAM information of many datasets (GDAL_PAM_STORE).
+int CPL_DLL PamStoreIsEnabled( void );
+CPLXMLNode CPL_DLL *PamStoreLoad( const char *pszKey, int *pbFound );
+void CPL_DLL PamStoreSave( const char *pszKey, const CPLXMLNode *psTree );
+void CPL_DLL PamStoreFlush( void );
+void CPL_DLL PamCleanStore( void );
+
 //! @endcond
 
 #endif /* ndef GDAL_PAM_H_INCLUDED */
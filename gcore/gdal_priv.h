@@ -66,6 +66,7 @@ class GDALAsyncReader;
 #include "cpl_multiproc.h"
 #include "cpl_atomic_ops.h"
 
+#include <atomic>
 #include <cmath>
 #include <iterator>
 #include <limits>
@@ -345,6 +346,7 @@ class CPL_DLL GDALDataset : public GDALMajorObject
     friend class GDALDefaultOverviews;
     friend class GDALProxyDataset;
     friend class GDALDriverManager;
+    friend class GDALRasterBlock;
 
     CPL_INTERNAL void AddToDatasetOpenList();
 
@@ -578,6 +580,9 @@ class CPL_DLL GDALDataset : public GDALMajorObject
     CPLErr BuildOverviews( const char *, int, int *,
                            int, int *, GDALProgressFunc, void * );
 
+    void          SetBlockCacheMax( GIntBig nMaxBytes );
+    GIntBig       GetBlockCacheMax();
+
     void ReportError(CPLErr eErrClass, CPLErrorNum err_no, const char *fmt, ...)  CPL_PRINT_FUNC_FORMAT (4, 5);
 
     char ** GetMetadata(const char * pszDomain = "") override;
@@ -870,11 +875,31 @@ class CPL_DLL GDALRasterBlock
 
     bool                 bMustDetach;
 
+    // Reference bit used by the CLOCK eviction policy. Set by Touch()
+    // without the cache lock; relaxed ordering is enough for a hint.
+    std::atomic<bool>    bTouched;
+
+    // Whether the block memory is accounted in the per-dataset or per-driver
+    // block cache quotas.
+    bool                 bInDatasetQuota;
+    bool                 bInDriverQuota;
+
     CPL_INTERNAL void        Detach_unlocked( void );
     CPL_INTERNAL void        Touch_unlocked( void );
+    CPL_INTERNAL static bool GiveSecondChance_unlocked(
+                                        GDALRasterBlock*& poTarget,
+                                        GDALRasterBlock*& poClockLimit );
 
     CPL_INTERNAL void        RecycleFor( int nXOffIn, int nYOffIn );
 
+    CPL_INTERNAL void        ChargeQuotas_unlocked( size_t nBytes );
+    CPL_INTERNAL void        DischargeQuotas_unlocked( size_t nBytes );
+    CPL_INTERNAL bool        IsOverQuota_unlocked( bool bDatasetQuota,
+                                                   GDALDataset*& poQuotaDS,
+                                                   GDALDriver*& poQuotaDriver ) const;
+    CPL_INTERNAL bool        IsInQuotaOf_unlocked( GDALDataset* poQuotaDS,
+                                                   GDALDriver* poQuotaDriver ) const;
+
   public:
                 GDALRasterBlock( GDALRasterBand *, int, int );
                 GDALRasterBlock( int nXOffIn, int nYOffIn ); /* only for lookup purpose */
@@ -949,6 +974,15 @@ class CPL_DLL GDALRasterBlock
     /* Should only be called by GDALDestroyDriverManager() */
 //! @cond Doxygen_Suppress
     CPL_INTERNAL static void DestroyRBMutex();
+
+    /* Should only be called by GDALDataset */
+    CPL_INTERNAL static void SetDatasetCacheMax( GDALDataset* poDS,
+                                                 GIntBig nMaxBytes );
+    CPL_INTERNAL static GIntBig GetDatasetCacheMax( GDALDataset* poDS );
+    CPL_INTERNAL static GIntBig ParseCacheQuota( const char* pszValue );
+
+    /* Statistics collection, see GDALGetCacheStatistics() */
+    CPL_INTERNAL static void RecordLookup( bool bHit );
 //! @endcond
 
   private:
@@ -1219,6 +1253,11 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
     virtual CPLErr SetStatistics( double dfMin, double dfMax,
                                   double dfMean, double dfStdDev );
     virtual CPLErr ComputeRasterMinMax( int, double* );
+    virtual CPLErr ComputeRasterQuantiles( int bApproxOK, int nQuantiles,
+                                           const double* padfProbabilities,
+                                           double* padfQuantiles,
+                                           GDALProgressFunc,
+                                           void *pProgressData );
 
 // Only defined when Doxygen enabled
 #ifdef DOXYGEN_SKIP
@@ -1356,6 +1395,9 @@ class CPL_DLL GDALNoDataValuesMaskBand : public GDALRasterBand
 
   protected:
     CPLErr IReadBlock( int, int, void * ) override;
+    CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                      void *, int, int, GDALDataType,
+                      GSpacing, GSpacing, GDALRasterIOExtraArg* psExtraArg ) override;
 
   public:
     explicit     GDALNoDataValuesMaskBand( GDALDataset * );
@@ -1429,6 +1471,12 @@ class CPL_DLL GDALDriver : public GDALMajorObject
     CPLErr      SetMetadataItem( const char * pszName,
                                  const char * pszValue,
                                  const char * pszDomain = "" ) override;
+    const char *GetMetadataItem( const char * pszName,
+                                 const char * pszDomain = "" ) override;
+    char      **GetMetadata( const char * pszDomain = "" ) override;
+    CPLErr      SetMetadata( char ** papszMetadata,
+                             const char * pszDomain = "" ) override;
+    char      **GetMetadataDomainList() override;
 
 /* -------------------------------------------------------------------- */
 /*      Public C++ methods.                                             */
@@ -1520,6 +1568,13 @@ class CPL_DLL GDALDriver : public GDALMajorObject
                                        const char * pszOldName );
     static CPLErr       DefaultCopyFiles( const char * pszNewName,
                                           const char * pszOldName );
+
+    bool                MatchesSignatures( const GDALOpenInfo* poOpenInfo ) const;
+
+    /** Whether this is the stub of a driver registered with
+     * GDALDriverManager::RegisterDeferredDriver() and not used yet. */
+    bool                IsDeferred() const { return m_bDeferred.load(); }
+    void                LoadDeferred();
 //! @endcond
 
     /** Convert a GDALDriver* to a GDALDriverH.
@@ -1535,6 +1590,20 @@ class CPL_DLL GDALDriver : public GDALMajorObject
         { return static_cast<GDALDriver*>(hDriver); }
 
 private:
+    // Decoded GDAL_DMD_SIGNATURES, as (byte offset, bytes) pairs.
+    std::vector<std::pair<size_t, std::string>> m_aoSignatures{};
+    bool                m_bHasSignatures = false;
+
+    void                SetSignatures( const char* pszValue );
+
+    // Deferred registration. Once loaded, the stub takes the callbacks of
+    // the driver registered by m_pfnDeferredRegister, and forwards the
+    // metadata requests to it.
+    friend class GDALDriverManager;
+    std::atomic<bool>   m_bDeferred{false};
+    void              (*m_pfnDeferredRegister)() = nullptr;
+    GDALDriver         *m_poDeferredDriver = nullptr;
+
     CPL_DISALLOW_COPY_ASSIGN(GDALDriver)
 };
 
@@ -1559,8 +1628,16 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
             { return (iDriver >= 0 && iDriver < nDrivers) ?
                   papoDrivers[iDriver] : nullptr; }
 
+    // Stub whose driver is being registered by LoadDeferredDriver().
+    GDALDriver  *poDeferredStub = nullptr;
+
     GDALDriver  *GetDriverByName_unlocked( const char * pszName )
-            { return oMapNameToDrivers[CPLString(pszName).toupper()]; }
+            { return (poDeferredStub != nullptr &&
+                      EQUAL(pszName, poDeferredStub->GetDescription())) ?
+                  nullptr : oMapNameToDrivers[CPLString(pszName).toupper()]; }
+
+    void        LoadDeferredDriver( GDALDriver* poStub );
+    friend class GDALDriver;
 
     CPL_DISALLOW_COPY_ASSIGN(GDALDriverManager)
 
@@ -1574,6 +1651,10 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
 
     int         RegisterDriver( GDALDriver * );
     void        DeregisterDriver( GDALDriver * );
+    void        RegisterDeferredDriver( const char* pszName,
+                                        void (*pfnRegister)(),
+                                        bool bRaster, bool bVector,
+                                        const char* pszSignatures );
 
     // AutoLoadDrivers is a no-op if compiled with GDAL_NO_AUTOLOAD defined.
     static void        AutoLoadDrivers();
@@ -1858,6 +1939,10 @@ template<class T> inline bool ARE_REAL_EQUAL(T fVal1, T fVal2, int ulp = 2)
 
 double GDALAdjustNoDataCloseToFloatMax(double dfVal);
 
+void GDALNoDataMaskLine( const void* pSrc, GDALDataType eWrkDT, size_t nCount,
+                         double dfNoDataValue, bool bApprox, bool bAccumulate,
+                         GByte* pabyMask );
+
 #define DIV_ROUND_UP(a, b) ( ((a) % (b)) == 0 ? ((a) / (b)) : (((a) / (b)) + 1) )
 
 // Number of data samples that will be used to compute approximate statistics
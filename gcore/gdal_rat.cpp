@@ -58,6 +58,14 @@
 
 CPL_CVSID("$Id: gdal_rat.cpp 2519a7eb0e1649dbf8625ae8ffc7bb7c3ef9514b 2018-07-10 12:05:23 +0100 Robert Coup $")
 
+// Kinds of index built by GDALDefaultRasterAttributeTable::BuildValueIndex()
+constexpr int VALUE_INDEX_NOT_BUILT = 0;
+constexpr int VALUE_INDEX_UNUSABLE = 1;   // content requires a scan
+constexpr int VALUE_INDEX_EXACT = 2;      // single MinMax column
+constexpr int VALUE_INDEX_RANGES = 3;     // disjoint Min/Max ranges
+constexpr int VALUE_INDEX_MIN_ONLY = 4;   // only a Min column
+constexpr int VALUE_INDEX_MAX_ONLY = 5;   // only a Max column
+
 /**
  * \class GDALRasterAttributeTable
  *
@@ -892,6 +900,26 @@ CPLErr GDALRasterAttributeTable::XMLInit( CPLXMLNode *psTree,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Size the table once for the leading run of consecutively        */
+/*      indexed rows, instead of growing it a row at a time.            */
+/* -------------------------------------------------------------------- */
+    int nRows = 0;
+    for( CPLXMLNode *psChild = psTree->psChild;
+         psChild != nullptr;
+         psChild = psChild->psNext)
+    {
+        if( psChild->eType == CXT_Element
+            && EQUAL(psChild->pszValue,"Row") )
+        {
+            if( atoi(CPLGetXMLValue(psChild,"index","0")) != nRows )
+                break;
+            nRows++;
+        }
+    }
+    if( nRows > 0 )
+        SetRowCount( nRows );
+
 /* -------------------------------------------------------------------- */
 /*      Row data.                                                       */
 /* -------------------------------------------------------------------- */
@@ -1669,6 +1697,8 @@ void GDALDefaultRasterAttributeTable::SetRowCount( int nNewCount )
     if( nNewCount == nRowCount )
         return;
 
+    InvalidateValueIndex();
+
     for( auto& oField: aoFields )
     {
         switch( oField.eType )
@@ -1722,6 +1752,9 @@ void GDALDefaultRasterAttributeTable::SetValue( int iRow, int iField,
         return;
     }
 
+    if( iField == nMinCol || iField == nMaxCol )
+        InvalidateValueIndex();
+
     switch( aoFields[iField].eType )
     {
       case GFT_Integer:
@@ -1790,6 +1823,9 @@ void GDALDefaultRasterAttributeTable::SetValue( int iRow, int iField,
         return;
     }
 
+    if( iField == nMinCol || iField == nMaxCol )
+        InvalidateValueIndex();
+
     switch( aoFields[iField].eType )
     {
       case GFT_Integer:
@@ -1859,6 +1895,9 @@ void GDALDefaultRasterAttributeTable::SetValue( int iRow, int iField,
         return;
     }
 
+    if( iField == nMinCol || iField == nMaxCol )
+        InvalidateValueIndex();
+
     switch( aoFields[iField].eType )
     {
       case GFT_Integer:
@@ -1961,6 +2000,90 @@ int GDALDefaultRasterAttributeTable::GetRowOfValue( double dfValue ) const
     if( nMinCol == -1 && nMaxCol == -1 )
         return -1;
 
+/* -------------------------------------------------------------------- */
+/*      Use the index over the Min/Max columns. A single lookup is      */
+/*      cheaper to do with a scan, so only build it once the table is  */
+/*      queried repeatedly.                                             */
+/* -------------------------------------------------------------------- */
+    if( nValueIndexType == VALUE_INDEX_NOT_BUILT )
+    {
+        GDALDefaultRasterAttributeTable *poThis =
+            const_cast<GDALDefaultRasterAttributeTable *>(this);
+        if( ++poThis->nRowOfValueCalls >= 2 )
+            poThis->BuildValueIndex();
+    }
+
+    if( CPLIsNan(dfValue) )
+        return GetRowOfValueLinear( dfValue );
+
+    switch( nValueIndexType )
+    {
+        case VALUE_INDEX_EXACT:
+        {
+            const auto oIter = std::lower_bound( adfValueIndex.begin(),
+                                                 adfValueIndex.end(),
+                                                 dfValue );
+            if( oIter == adfValueIndex.end() || *oIter != dfValue )
+                return -1;
+            return anValueIndexRows[oIter - adfValueIndex.begin()];
+        }
+
+        case VALUE_INDEX_RANGES:
+        {
+            // Ranges are disjoint, so the only candidate is the one with
+            // the largest minimum not greater than the value.
+            const auto oIter = std::upper_bound( adfValueIndex.begin(),
+                                                 adfValueIndex.end(),
+                                                 dfValue );
+            if( oIter == adfValueIndex.begin() )
+                return -1;
+            const int iRow =
+                anValueIndexRows[(oIter - adfValueIndex.begin()) - 1];
+            const GDALRasterAttributeField &oMax = aoFields[nMaxCol];
+            const double dfMax = oMax.eType == GFT_Integer ?
+                static_cast<double>(oMax.anValues[iRow]) :
+                oMax.adfValues[iRow];
+            return dfValue > dfMax ? -1 : iRow;
+        }
+
+        case VALUE_INDEX_MIN_ONLY:
+        {
+            // Running minimum of the Min column: the first row whose
+            // running minimum is not greater than the value.
+            const auto oIter = std::lower_bound(
+                adfValueIndex.begin(), adfValueIndex.end(), dfValue,
+                [](double dfA, double dfB) { return dfA > dfB; } );
+            if( oIter == adfValueIndex.end() )
+                return -1;
+            return static_cast<int>(oIter - adfValueIndex.begin());
+        }
+
+        case VALUE_INDEX_MAX_ONLY:
+        {
+            // Running maximum of the Max column: the first row whose
+            // running maximum is not lower than the value.
+            const auto oIter = std::lower_bound( adfValueIndex.begin(),
+                                                 adfValueIndex.end(),
+                                                 dfValue );
+            if( oIter == adfValueIndex.end() )
+                return -1;
+            return static_cast<int>(oIter - adfValueIndex.begin());
+        }
+
+        default:
+            break;
+    }
+
+    return GetRowOfValueLinear( dfValue );
+}
+
+/************************************************************************/
+/*                        GetRowOfValueLinear()                         */
+/************************************************************************/
+
+int GDALDefaultRasterAttributeTable::GetRowOfValueLinear( double dfValue ) const
+
+{
     const GDALRasterAttributeField *poMin = nullptr;
     if( nMinCol != -1 )
         poMin = &(aoFields[nMinCol]);
@@ -2010,6 +2133,129 @@ int GDALDefaultRasterAttributeTable::GetRowOfValue( double dfValue ) const
     return -1;
 }
 
+/************************************************************************/
+/*                          BuildValueIndex()                           */
+/*                                                                      */
+/*      Builds the index used by GetRowOfValue() to avoid scanning      */
+/*      the Min/Max columns. It gives the same answer as the first      */
+/*      match of the scan, and the table is left unindexed when the     */
+/*      content does not allow that (string or NaN bounds,              */
+/*      overlapping ranges).                                            */
+/************************************************************************/
+
+void GDALDefaultRasterAttributeTable::BuildValueIndex()
+
+{
+    nValueIndexType = VALUE_INDEX_UNUSABLE;
+    adfValueIndex.clear();
+    anValueIndexRows.clear();
+
+    const GDALRasterAttributeField *poMin =
+        nMinCol != -1 ? &(aoFields[nMinCol]) : nullptr;
+    const GDALRasterAttributeField *poMax =
+        nMaxCol != -1 ? &(aoFields[nMaxCol]) : nullptr;
+    if( (poMin != nullptr && poMin->eType == GFT_String) ||
+        (poMax != nullptr && poMax->eType == GFT_String) )
+        return;
+
+    const auto GetValue =
+        [](const GDALRasterAttributeField *poField, int iRow)
+        {
+            return poField->eType == GFT_Integer ?
+                static_cast<double>(poField->anValues[iRow]) :
+                poField->adfValues[iRow];
+        };
+
+    // A NaN bound matches any value in the scan.
+    for( int iRow = 0; iRow < nRowCount; iRow++ )
+    {
+        if( (poMin != nullptr && CPLIsNan(GetValue(poMin, iRow))) ||
+            (poMax != nullptr && CPLIsNan(GetValue(poMax, iRow))) )
+            return;
+    }
+
+    try
+    {
+        if( poMin != nullptr && poMax != nullptr )
+        {
+            // Sorted (minimum, row) pairs, skipping rows that cannot
+            // match anything.
+            std::vector<std::pair<double, int>> aoPairs;
+            aoPairs.reserve( nRowCount );
+            for( int iRow = 0; iRow < nRowCount; iRow++ )
+            {
+                const double dfMin = GetValue(poMin, iRow);
+                if( poMin == poMax || dfMin <= GetValue(poMax, iRow) )
+                    aoPairs.emplace_back( dfMin, iRow );
+            }
+            std::sort( aoPairs.begin(), aoPairs.end() );
+
+            if( poMin != poMax )
+            {
+                for( size_t i = 1; i < aoPairs.size(); i++ )
+                {
+                    if( GetValue(poMax, aoPairs[i-1].second) >=
+                                                        aoPairs[i].first )
+                        return;
+                }
+            }
+
+            adfValueIndex.resize( aoPairs.size() );
+            anValueIndexRows.resize( aoPairs.size() );
+            for( size_t i = 0; i < aoPairs.size(); i++ )
+            {
+                adfValueIndex[i] = aoPairs[i].first;
+                anValueIndexRows[i] = aoPairs[i].second;
+            }
+            nValueIndexType =
+                poMin == poMax ? VALUE_INDEX_EXACT : VALUE_INDEX_RANGES;
+        }
+        else
+        {
+            // Running minimum (resp. maximum) of the only bound column.
+            const GDALRasterAttributeField *poField =
+                poMin != nullptr ? poMin : poMax;
+            adfValueIndex.resize( nRowCount );
+            for( int iRow = 0; iRow < nRowCount; iRow++ )
+            {
+                const double dfVal = GetValue(poField, iRow);
+                if( iRow == 0 )
+                    adfValueIndex[iRow] = dfVal;
+                else if( poMin != nullptr )
+                    adfValueIndex[iRow] =
+                        std::min( adfValueIndex[iRow-1], dfVal );
+                else
+                    adfValueIndex[iRow] =
+                        std::max( adfValueIndex[iRow-1], dfVal );
+            }
+            nValueIndexType = poMin != nullptr ? VALUE_INDEX_MIN_ONLY :
+                                                 VALUE_INDEX_MAX_ONLY;
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        adfValueIndex.clear();
+        anValueIndexRows.clear();
+        nValueIndexType = VALUE_INDEX_UNUSABLE;
+    }
+}
+
+/************************************************************************/
+/*                        InvalidateValueIndex()                        */
+/************************************************************************/
+
+void GDALDefaultRasterAttributeTable::InvalidateValueIndex()
+
+{
+    if( nValueIndexType != VALUE_INDEX_NOT_BUILT )
+    {
+        nValueIndexType = VALUE_INDEX_NOT_BUILT;
+        adfValueIndex.clear();
+        anValueIndexRows.clear();
+    }
+    nRowOfValueCalls = 0;
+}
+
 /************************************************************************/
 /*                           GetRowOfValue()                            */
 /*                                                                      */
@@ -2115,6 +2361,10 @@ CPLErr GDALDefaultRasterAttributeTable::CreateColumn(
 
     aoFields.resize( iNewField+1 );
 
+    // A new Min/Max column may take precedence
+    bColumnsAnalysed = false;
+    InvalidateValueIndex();
+
     aoFields[iNewField].sName = pszFieldName;
 
     // color columns should be int 0..255
@@ -2185,6 +2435,12 @@ void GDALDefaultRasterAttributeTable::RemoveStatistics()
         }
     }
     aoFields = aoNewFields;
+
+    // Column indices have changed
+    bColumnsAnalysed = false;
+    nMinCol = -1;
+    nMaxCol = -1;
+    InvalidateValueIndex();
 }
 
 /************************************************************************/
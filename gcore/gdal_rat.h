@@ -360,6 +360,17 @@ class CPL_DLL GDALDefaultRasterAttributeTable : public GDALRasterAttributeTable
 
     CPLString osWorkingResult{};
 
+    // Index over the Min/Max columns built on demand by GetRowOfValue()
+    // and discarded whenever the table is modified.
+    int   nValueIndexType = 0;
+    int   nRowOfValueCalls = 0;
+    std::vector<double> adfValueIndex{};
+    std::vector<int> anValueIndexRows{};
+
+    void  BuildValueIndex();
+    void  InvalidateValueIndex();
+    int   GetRowOfValueLinear( double dfValue ) const;
+
  public:
     GDALDefaultRasterAttributeTable();
     ~GDALDefaultRasterAttributeTable() override;
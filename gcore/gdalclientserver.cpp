@@ -77,6 +77,7 @@
 #include <utility>
 #include <vector>
 
+#include "cpl_atomic_ops.h"
 #include "cpl_config.h"
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -92,6 +93,13 @@
 #include "gdal_rat.h"
 #include "gdal_version.h"
 
+#if !defined(WIN32) && defined(HAVE_MMAP)
+#define HAVE_API_PROXY_SHARED_MEMORY
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 /*!
 \page gdal_api_proxy GDAL API Proxy
 
@@ -149,6 +157,15 @@ GDAL_API_PROXY_CONN_POOL config option that is set to YES by default, and will
 keep a maximum of 4 unused connections.  GDAL_API_PROXY_CONN_POOL can be set to
 a integer value to specify the maximum number of unused connections.
 
+Starting with GDAL 3.1 (Unix only), when the server is a forked process or a
+gdalserver executable spawned in pipe mode, the pixel buffers of RasterIO(),
+ReadBlock() and WriteBlock() requests of at least 64 KB are exchanged through a
+memory segment shared by the client and the server, instead of being copied
+through the pipe. The segment is kept with the connection when it goes back to
+the pool. This can be disabled by setting
+GDAL_API_PROXY_SHARED_MEMORY=NO. TCP and Unix socket connections always copy the
+pixel buffers.
+
 \section gdal_api_proxy_limitations Limitations
 
 Datasets stored in the memory virtual file system (/vsimem) or handled by the
@@ -179,7 +196,7 @@ would deadlock the server.
 /* REMINDER: upgrade this number when the on-wire protocol changes */
 /* Note: please at least keep the version exchange protocol unchanged ! */
 #define GDAL_CLIENT_SERVER_PROTOCOL_MAJOR 3
-#define GDAL_CLIENT_SERVER_PROTOCOL_MINOR 0
+#define GDAL_CLIENT_SERVER_PROTOCOL_MINOR 1
 
 CPL_C_START
 int CPL_DLL GDALServerLoop(CPL_FILE_HANDLE fin, CPL_FILE_HANDLE fout);
@@ -203,6 +220,11 @@ struct GDALPipe
     GByte           abyRecvBuffer[BUFFER_SIZE];
     int             nRecvBufferSize;
 #endif
+    /* Segment shared with the other process for pixel payloads, if any */
+    GByte          *pabySharedMem;
+    size_t          nSharedMemSize;
+    /* Client side: whether a shared memory segment may be set up */
+    int             bSharedMemAllowed;
 };
 
 struct GDALServerSpawnedProcess
@@ -302,6 +324,7 @@ enum InstrEnum
     INSTR_Band_AdviseRead,
     INSTR_Band_DeleteNoDataValue,
     INSTR_Band_End,
+    INSTR_SetSharedMemory,
     INSTR_END
 };
 
@@ -388,6 +411,7 @@ static const char* const apszInstr[] =
     "Band_AdviseRead",
     "Band_DeleteNoDataValue",
     "Band_End",
+    "SetSharedMemory",
     "END",
 };
 #endif
@@ -744,6 +768,9 @@ static GDALPipe* GDALPipeBuild(CPLSpawnedProcess* sp)
 #ifdef BUFFER_READ
     p->nRecvBufferSize = 0;
 #endif
+    p->pabySharedMem = nullptr;
+    p->nSharedMemSize = 0;
+    p->bSharedMemAllowed = FALSE;
     return p;
 }
 
@@ -758,6 +785,9 @@ static GDALPipe* GDALPipeBuild(const CPL_SOCKET& nSocket)
 #ifdef BUFFER_READ
     p->nRecvBufferSize = 0;
 #endif
+    p->pabySharedMem = nullptr;
+    p->nSharedMemSize = 0;
+    p->bSharedMemAllowed = FALSE;
     return p;
 }
 
@@ -772,6 +802,9 @@ static GDALPipe* GDALPipeBuild(CPL_FILE_HANDLE fin, CPL_FILE_HANDLE fout)
 #ifdef BUFFER_READ
     p->nRecvBufferSize = 0;
 #endif
+    p->pabySharedMem = nullptr;
+    p->nSharedMemSize = 0;
+    p->bSharedMemAllowed = FALSE;
     return p;
 }
 
@@ -836,6 +869,10 @@ static int GDALPipeFlushBuffer(GDALPipe * p)
 static void GDALPipeFree(GDALPipe * p)
 {
     GDALPipeFlushBuffer(p);
+#ifdef HAVE_API_PROXY_SHARED_MEMORY
+    if( p->pabySharedMem != nullptr )
+        munmap(p->pabySharedMem, p->nSharedMemSize);
+#endif
     if( p->nSocket != INVALID_SOCKET )
     {
         closesocket(p->nSocket);
@@ -1506,6 +1543,160 @@ static int GDALEmitEXIT(GDALPipe* p, InstrEnum instr = INSTR_EXIT )
     return bOK;
 }
 
+/************************************************************************/
+/*                      GDALPipeMapSharedMemory()                       */
+/************************************************************************/
+
+#ifdef HAVE_API_PROXY_SHARED_MEMORY
+static GByte* GDALPipeMapSharedMemory(const char* pszFilename, size_t nSize,
+                                      bool bCreate)
+{
+    const int fd = bCreate ?
+        open(pszFilename, O_RDWR | O_CREAT | O_EXCL, 0600) :
+        open(pszFilename, O_RDWR);
+    if( fd < 0 )
+        return nullptr;
+    bool bOK;
+    if( bCreate )
+    {
+        bOK = ftruncate(fd, static_cast<off_t>(nSize)) == 0;
+    }
+    else
+    {
+        // Mapping beyond the end of the file would cause SIGBUS on access.
+        struct stat sStat;
+        bOK = fstat(fd, &sStat) == 0 &&
+              static_cast<GUIntBig>(sStat.st_size) >= nSize;
+    }
+    void* pMap = bOK ? mmap(nullptr, nSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if( pMap == MAP_FAILED )
+        return nullptr;
+    return static_cast<GByte*>(pMap);
+}
+#endif
+
+/************************************************************************/
+/*                    GDALPipeReserveSharedMemory()                     */
+/************************************************************************/
+
+/* Payloads smaller than this do not justify setting up shared memory */
+constexpr int SHARED_MEM_MIN_PAYLOAD = 65536;
+
+/* Client side: make sure that a payload of nSize bytes will go through */
+/* the shared memory segment, when the connection allows it. Must be */
+/* called before emitting the instruction that transfers the payload. */
+static void GDALPipeReserveSharedMemory(GDALPipe* p, GIntBig nSize)
+{
+#ifdef HAVE_API_PROXY_SHARED_MEMORY
+    if( !p->bSharedMemAllowed || !p->bOK ||
+        nSize < SHARED_MEM_MIN_PAYLOAD || !CPL_INT64_FITS_ON_INT32(nSize) ||
+        (p->pabySharedMem != nullptr &&
+         static_cast<size_t>(nSize) <= p->nSharedMemSize) )
+        return;
+
+    // Grow geometrically so that slowly increasing requests do not
+    // recreate the segment each time.
+    const size_t nNewSize = std::max(static_cast<size_t>(nSize),
+                                     2 * p->nSharedMemSize);
+
+    static volatile int nSharedMemCounter = 0;
+    VSIStatBufL sStat;
+    const char* pszDir =
+        (VSIStatL("/dev/shm", &sStat) == 0 && VSI_ISDIR(sStat.st_mode)) ?
+            "/dev/shm" : CPLGetConfigOption("CPL_TMPDIR", "/tmp");
+    CPLString osFilename;
+    osFilename.Printf("%s/gdal_api_proxy_%d_%d", pszDir,
+                      static_cast<int>(getpid()),
+                      CPLAtomicInc(&nSharedMemCounter));
+
+    GByte* pabyNew = GDALPipeMapSharedMemory(osFilename, nNewSize, true);
+    if( pabyNew == nullptr )
+    {
+        CPLDebug("GDAL", "Cannot create %s. Not using shared memory",
+                 osFilename.c_str());
+        unlink(osFilename.c_str());
+        p->bSharedMemAllowed = FALSE;
+        return;
+    }
+
+    int bOK = FALSE;
+    if( GDALPipeWrite(p, INSTR_SetSharedMemory) &&
+        GDALPipeWrite(p, osFilename.c_str()) &&
+        GDALPipeWrite(p, static_cast<GIntBig>(nNewSize)) &&
+        GDALSkipUntilEndOfJunkMarker(p) &&
+        GDALPipeRead(p, &bOK) )
+    {
+        GDALConsumeErrors(p);
+    }
+    // Both processes have mapped the file, which can now be removed.
+    unlink(osFilename.c_str());
+
+    // The server has released its previous mapping in all cases.
+    if( p->pabySharedMem != nullptr )
+        munmap(p->pabySharedMem, p->nSharedMemSize);
+    p->pabySharedMem = nullptr;
+    p->nSharedMemSize = 0;
+    if( !bOK )
+    {
+        munmap(pabyNew, nNewSize);
+        p->bSharedMemAllowed = FALSE;
+        return;
+    }
+    p->pabySharedMem = pabyNew;
+    p->nSharedMemSize = nNewSize;
+#else
+    CPL_IGNORE_RET_VAL(p);
+    CPL_IGNORE_RET_VAL(nSize);
+#endif
+}
+
+/************************************************************************/
+/*                      GDALPipeGetSharedMemory()                       */
+/************************************************************************/
+
+/* Returns the shared memory segment if a payload of nSize bytes goes */
+/* through it, or NULL. Both sides of the pipe take the same decision. */
+static GByte* GDALPipeGetSharedMemory(GDALPipe* p, GIntBig nSize)
+{
+    if( p->pabySharedMem != nullptr && nSize >= 0 &&
+        static_cast<GUIntBig>(nSize) <= p->nSharedMemSize )
+        return p->pabySharedMem;
+    return nullptr;
+}
+
+/************************************************************************/
+/*                        GDALPipeWritePayload()                        */
+/************************************************************************/
+
+/* Like GDALPipeWrite(p, nSize, pData), except that only the size goes */
+/* through the pipe when the payload fits in the shared memory segment. */
+static int GDALPipeWritePayload(GDALPipe* p, int nSize, const void* pData)
+{
+    GByte* pabyShared = GDALPipeGetSharedMemory(p, nSize);
+    if( pabyShared == nullptr )
+        return GDALPipeWrite(p, nSize, pData);
+    if( pData != pabyShared )
+        memcpy(pabyShared, pData, nSize);
+    return GDALPipeWrite(p, nSize);
+}
+
+/************************************************************************/
+/*                    GDALPipeReadPayload_nolength()                    */
+/************************************************************************/
+
+/* Reads a payload emitted with GDALPipeWritePayload(), whose size has */
+/* already been read. */
+static int GDALPipeReadPayload_nolength(GDALPipe* p, int nSize, void* pData)
+{
+    const GByte* pabyShared = GDALPipeGetSharedMemory(p, nSize);
+    if( pabyShared == nullptr )
+        return GDALPipeRead_nolength(p, nSize, pData);
+    memcpy(pData, pabyShared, nSize);
+    return TRUE;
+}
+
 /************************************************************************/
 /*                    GDALServerSpawnAsyncFinish()                      */
 /************************************************************************/
@@ -1546,7 +1737,8 @@ static int GDALServerSpawnAsyncFinish(GDALServerSpawnedProcess* ssp)
 /*                      GDALCheckServerVersion()                        */
 /************************************************************************/
 
-static int GDALCheckServerVersion(GDALPipe* p)
+static int GDALCheckServerVersion(GDALPipe* p,
+                                  int* pnServerProtocolMinor = nullptr)
 {
     GDALPipeWrite(p, INSTR_GetGDALVersion);
     char bIsLSB = CPL_IS_LSB;
@@ -1617,6 +1809,8 @@ static int GDALCheckServerVersion(GDALPipe* p)
     {
         CPLDebug("GDAL", "Note: client/server protocol versions differ by minor number.");
     }
+    if( pnServerProtocolMinor )
+        *pnServerProtocolMinor = nProtocolMinor;
     CPLFree(pszVersion);
     return TRUE;
 }
@@ -1858,11 +2052,19 @@ static GDALServerSpawnedProcess* GDALServerSpawnAsync()
     ssp->p = GDALPipeBuild(sp);
 
     CPLDebug("GDAL", "Create spawned process %p", ssp);
-    if( bCheckVersions && !GDALCheckServerVersion(ssp->p) )
+    int nServerProtocolMinor = GDAL_CLIENT_SERVER_PROTOCOL_MINOR;
+    if( bCheckVersions &&
+        !GDALCheckServerVersion(ssp->p, &nServerProtocolMinor) )
     {
         GDALServerSpawnAsyncFinish(ssp);
         return nullptr;
     }
+
+    // Pixel payloads can go through shared memory with a local process
+    // that understands INSTR_SetSharedMemory (protocol 3.1 or later)
+    ssp->p->bSharedMemAllowed =
+        nServerProtocolMinor >= 1 &&
+        CPLTestBool(CPLGetConfigOption("GDAL_API_PROXY_SHARED_MEMORY", "YES"));
     return ssp;
 }
 
@@ -2216,6 +2418,43 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, TRUE);
         }
+        else if( instr == INSTR_SetSharedMemory )
+        {
+            char* pszFilename = nullptr;
+            GIntBig nSize = 0;
+            if( !GDALPipeRead(p, &pszFilename) ||
+                !GDALPipeRead(p, &nSize) )
+            {
+                CPLFree(pszFilename);
+                break;
+            }
+            int bOK = FALSE;
+#ifdef HAVE_API_PROXY_SHARED_MEMORY
+            if( p->pabySharedMem != nullptr )
+                munmap(p->pabySharedMem, p->nSharedMemSize);
+            p->pabySharedMem = nullptr;
+            p->nSharedMemSize = 0;
+            // Only accept this from a parent process talking through pipes,
+            // and only map files that the client has created for that
+            // purpose. Never from a remote client.
+            if( p->nSocket == INVALID_SOCKET && pszFilename != nullptr &&
+                STARTS_WITH(CPLGetFilename(pszFilename), "gdal_api_proxy_") &&
+                nSize >= SHARED_MEM_MIN_PAYLOAD &&
+                CPL_INT64_FITS_ON_INT32(nSize) )
+            {
+                p->pabySharedMem = GDALPipeMapSharedMemory(
+                    pszFilename, static_cast<size_t>(nSize), false);
+                if( p->pabySharedMem != nullptr )
+                {
+                    p->nSharedMemSize = static_cast<size_t>(nSize);
+                    bOK = TRUE;
+                }
+            }
+#endif
+            CPLFree(pszFilename);
+            GDALEmitEndOfJunkMarker(p);
+            GDALPipeWrite(p, bOK);
+        }
         else if( instr == INSTR_Open )
         {
             int nAccess;
@@ -2905,15 +3144,20 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
             eBufType = static_cast<GDALDataType>(nBufType);
             const int nSize = nBufXSize * nBufYSize * nBandCount *
                 GDALGetDataTypeSizeBytes(eBufType);
-            if( nSize > nBufferSize )
+            void* pDst = GDALPipeGetSharedMemory(p, nSize);
+            if( pDst == nullptr )
             {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
+                if( nSize > nBufferSize )
+                {
+                    nBufferSize = nSize;
+                    pBuffer = CPLRealloc(pBuffer, nSize);
+                }
+                pDst = pBuffer;
             }
 
             CPLErr eErr = poDS->RasterIO(GF_Read,
                                          nXOff, nYOff, nXSize, nYSize,
-                                         pBuffer, nBufXSize, nBufYSize,
+                                         pDst, nBufXSize, nBufYSize,
                                          eBufType,
                                          nBandCount, panBandMap,
                                          nPixelSpace, nLineSpace, nBandSpace,
@@ -2922,7 +3166,7 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
             if( eErr != CE_Failure )
-                GDALPipeWrite(p, nSize, pBuffer);
+                GDALPipeWritePayload(p, nSize, pDst);
         }
         else if( instr == INSTR_IRasterIO_Write )
         {
@@ -2964,20 +3208,25 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
                 CPLFree(panBandMap);
                 break;
             }
-            if( nSize > nBufferSize )
-            {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
-            }
-            if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
+            void* pSrc = GDALPipeGetSharedMemory(p, nSize);
+            if( pSrc == nullptr )
             {
-                CPLFree(panBandMap);
-                break;
+                if( nSize > nBufferSize )
+                {
+                    nBufferSize = nSize;
+                    pBuffer = CPLRealloc(pBuffer, nSize);
+                }
+                if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
+                {
+                    CPLFree(panBandMap);
+                    break;
+                }
+                pSrc = pBuffer;
             }
 
             CPLErr eErr = poDS->RasterIO(GF_Write,
                                          nXOff, nYOff, nXSize, nYSize,
-                                         pBuffer, nBufXSize, nBufYSize,
+                                         pSrc, nBufXSize, nBufYSize,
                                          eBufType,
                                          nBandCount, panBandMap,
                                          nPixelSpace, nLineSpace, nBandSpace,
@@ -3203,15 +3452,20 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
             poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
             const int nSize = nBlockXSize * nBlockYSize *
                 GDALGetDataTypeSizeBytes(poBand->GetRasterDataType());
-            if( nSize > nBufferSize )
+            void* pDst = GDALPipeGetSharedMemory(p, nSize);
+            if( pDst == nullptr )
             {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
+                if( nSize > nBufferSize )
+                {
+                    nBufferSize = nSize;
+                    pBuffer = CPLRealloc(pBuffer, nSize);
+                }
+                pDst = pBuffer;
             }
-            CPLErr eErr = poBand->ReadBlock(nBlockXOff, nBlockYOff, pBuffer);
+            CPLErr eErr = poBand->ReadBlock(nBlockXOff, nBlockYOff, pDst);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
-            GDALPipeWrite(p, nSize, pBuffer);
+            GDALPipeWritePayload(p, nSize, pDst);
         }
         else if( instr == INSTR_Band_IWriteBlock )
         {
@@ -3226,15 +3480,20 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
                 GDALGetDataTypeSizeBytes(poBand->GetRasterDataType());
             if( nExpectedSize != nSize )
                 break;
-            if( nSize > nBufferSize )
+            void* pSrc = GDALPipeGetSharedMemory(p, nSize);
+            if( pSrc == nullptr )
             {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
+                if( nSize > nBufferSize )
+                {
+                    nBufferSize = nSize;
+                    pBuffer = CPLRealloc(pBuffer, nSize);
+                }
+                if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
+                    break;
+                pSrc = pBuffer;
             }
-            if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
-                break;
 
-            CPLErr eErr = poBand->WriteBlock(nBlockXOff, nBlockYOff, pBuffer);
+            CPLErr eErr = poBand->WriteBlock(nBlockXOff, nBlockYOff, pSrc);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
         }
@@ -3255,19 +3514,24 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
             eBufType = static_cast<GDALDataType>(nBufType);
             const int nSize = nBufXSize * nBufYSize *
                 GDALGetDataTypeSizeBytes(eBufType);
-            if( nSize > nBufferSize )
+            void* pDst = GDALPipeGetSharedMemory(p, nSize);
+            if( pDst == nullptr )
             {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
+                if( nSize > nBufferSize )
+                {
+                    nBufferSize = nSize;
+                    pBuffer = CPLRealloc(pBuffer, nSize);
+                }
+                pDst = pBuffer;
             }
 
             CPLErr eErr = poBand->RasterIO(GF_Read,
                                            nXOff, nYOff, nXSize, nYSize,
-                                           pBuffer, nBufXSize, nBufYSize,
+                                           pDst, nBufXSize, nBufYSize,
                                            eBufType, 0, 0, nullptr);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
-            GDALPipeWrite(p, nSize, pBuffer);
+            GDALPipeWritePayload(p, nSize, pDst);
         }
         else if( instr == INSTR_Band_IRasterIO_Write )
         {
@@ -3291,17 +3555,22 @@ static int GDALServerLoopInternal(GDALServerInstance* poSrvInstance,
                 break;
             if( nSize != nExpectedSize )
                 break;
-            if( nSize > nBufferSize )
+            void* pSrc = GDALPipeGetSharedMemory(p, nSize);
+            if( pSrc == nullptr )
             {
-                nBufferSize = nSize;
-                pBuffer = CPLRealloc(pBuffer, nSize);
+                if( nSize > nBufferSize )
+                {
+                    nBufferSize = nSize;
+                    pBuffer = CPLRealloc(pBuffer, nSize);
+                }
+                if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
+                    break;
+                pSrc = pBuffer;
             }
-            if( !GDALPipeRead_nolength(p, nSize, pBuffer) )
-                break;
 
             CPLErr eErr = poBand->RasterIO(GF_Write,
                                            nXOff, nYOff, nXSize, nYSize,
-                                           pBuffer, nBufXSize, nBufYSize,
+                                           pSrc, nBufXSize, nBufYSize,
                                            eBufType, 0, 0, nullptr);
             GDALEmitEndOfJunkMarker(p);
             GDALPipeWrite(p, eErr);
@@ -3844,6 +4113,9 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
             cpl::down_cast<GDALClientRasterBand*>(GetRasterBand(i+1))->InvalidateCachedLines();
     }
 
+    GDALPipeReserveSharedMemory(p, static_cast<GIntBig>(nBufXSize) *
+                                   nBufYSize * nBandCount * nDataTypeSize);
+
     if( !GDALPipeWrite(p, ( eRWFlag == GF_Read ) ? INSTR_IRasterIO_Read : INSTR_IRasterIO_Write ) ||
         !GDALPipeWrite(p, nXOff) ||
         !GDALPipeWrite(p, nYOff) ||
@@ -3888,15 +4160,20 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
                 return CE_Failure;
             if( bDirectCopy )
             {
-                if( !GDALPipeRead_nolength(p, nSize, pData) )
+                if( !GDALPipeReadPayload_nolength(p, nSize, pData) )
                     return CE_Failure;
             }
             else
             {
-                GByte* pBuf = static_cast<GByte*>(VSIMalloc(nSize));
+                // Reinterleave straight from the shared memory segment
+                // when the payload went through it.
+                GByte* pabyShared = GDALPipeGetSharedMemory(p, nSize);
+                GByte* pBuf = pabyShared ? pabyShared :
+                                    static_cast<GByte*>(VSIMalloc(nSize));
                 if( pBuf == nullptr )
                     return CE_Failure;
-                if( !GDALPipeRead_nolength(p, nSize, pBuf) )
+                if( pabyShared == nullptr &&
+                    !GDALPipeRead_nolength(p, nSize, pBuf) )
                 {
                     VSIFree(pBuf);
                     return CE_Failure;
@@ -3912,7 +4189,8 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
                                        nBufXSize);
                     }
                 }
-                VSIFree(pBuf);
+                if( pabyShared == nullptr )
+                    VSIFree(pBuf);
             }
         }
     }
@@ -3924,12 +4202,14 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
         int nSize = static_cast<int>(nSizeBig);
         if( bDirectCopy  )
         {
-            if( !GDALPipeWrite(p, nSize, pData) )
+            if( !GDALPipeWritePayload(p, nSize, pData) )
                 return CE_Failure;
         }
         else
         {
-            GByte* pBuf = static_cast<GByte*>(VSIMalloc(nSize));
+            GByte* pabyShared = GDALPipeGetSharedMemory(p, nSize);
+            GByte* pBuf = pabyShared ? pabyShared :
+                                static_cast<GByte*>(VSIMalloc(nSize));
             if( pBuf == nullptr )
                 return CE_Failure;
             for(int iBand=0;iBand<nBandCount;iBand++)
@@ -3943,12 +4223,11 @@ CPLErr GDALClientDataset::IRasterIO( GDALRWFlag eRWFlag,
                                    nBufXSize );
                 }
             }
-            if( !GDALPipeWrite(p, nSize, pBuf) )
-            {
+            const int bOK = GDALPipeWritePayload(p, nSize, pBuf);
+            if( pabyShared == nullptr )
                 VSIFree(pBuf);
+            if( !bOK )
                 return CE_Failure;
-            }
-            VSIFree(pBuf);
         }
 
         if( !GDALSkipUntilEndOfJunkMarker(p) )
@@ -5005,6 +5284,9 @@ CPLErr GDALClientRasterBand::IReadBlock(int nBlockXOff, int nBlockYOff, void* pI
     if( poDS != nullptr )
         cpl::down_cast<GDALClientDataset*>(poDS)->ProcessAsyncProgress();
 
+    GDALPipeReserveSharedMemory(p, static_cast<GIntBig>(nBlockXSize) *
+                nBlockYSize * GDALGetDataTypeSizeBytes(eDataType));
+
     if( !WriteInstr(INSTR_Band_IReadBlock) ||
         !GDALPipeWrite(p, nBlockXOff) ||
         !GDALPipeWrite(p, nBlockYOff) )
@@ -5018,7 +5300,7 @@ CPLErr GDALClientRasterBand::IReadBlock(int nBlockXOff, int nBlockYOff, void* pI
     int nSize;
     if( !GDALPipeRead(p, &nSize) ||
         nSize != nBlockXSize * nBlockYSize * GDALGetDataTypeSizeBytes(eDataType) ||
-        !GDALPipeRead_nolength(p, nSize, pImage) )
+        !GDALPipeReadPayload_nolength(p, nSize, pImage) )
         return CE_Failure;
 
     GDALConsumeErrors(p);
@@ -5039,10 +5321,11 @@ CPLErr GDALClientRasterBand::IWriteBlock(int nBlockXOff, int nBlockYOff, void* p
     CLIENT_ENTER();
     const int nSize =
         nBlockXSize * nBlockYSize * GDALGetDataTypeSizeBytes(eDataType);
+    GDALPipeReserveSharedMemory(p, nSize);
     if( !WriteInstr(INSTR_Band_IWriteBlock) ||
         !GDALPipeWrite(p, nBlockXOff) ||
         !GDALPipeWrite(p, nBlockYOff) ||
-        !GDALPipeWrite(p, nSize, pImage) )
+        !GDALPipeWritePayload(p, nSize, pImage) )
         return CE_Failure;
     return CPLErrOnlyRet(p);
 }
@@ -5059,6 +5342,9 @@ CPLErr GDALClientRasterBand::IRasterIO_read_internal(
 {
     CPLErr eRet = CE_Failure;
 
+    GDALPipeReserveSharedMemory(p, static_cast<GIntBig>(nBufXSize) *
+                            nBufYSize * GDALGetDataTypeSizeBytes(eBufType));
+
     if( !WriteInstr(INSTR_Band_IRasterIO_Read) ||
         !GDALPipeWrite(p, nXOff) ||
         !GDALPipeWrite(p, nYOff) ||
@@ -5084,15 +5370,18 @@ CPLErr GDALClientRasterBand::IRasterIO_read_internal(
     if( nPixelSpace == nDataTypeSize &&
         nLineSpace == static_cast<GSpacing>(nBufXSize) * nDataTypeSize )
     {
-        if( !GDALPipeRead_nolength(p, nSize, pData) )
+        if( !GDALPipeReadPayload_nolength(p, nSize, pData) )
             return CE_Failure;
     }
     else
     {
-        GByte* pBuf = static_cast<GByte*>(VSIMalloc(nSize));
+        GByte* pabyShared = GDALPipeGetSharedMemory(p, nSize);
+        GByte* pBuf = pabyShared ? pabyShared :
+                            static_cast<GByte*>(VSIMalloc(nSize));
         if( pBuf == nullptr )
             return CE_Failure;
-        if( !GDALPipeRead_nolength(p, nSize, pBuf) )
+        if( pabyShared == nullptr &&
+            !GDALPipeRead_nolength(p, nSize, pBuf) )
         {
             VSIFree(pBuf);
             return CE_Failure;
@@ -5105,7 +5394,8 @@ CPLErr GDALClientRasterBand::IRasterIO_read_internal(
                             eBufType, static_cast<int>(nPixelSpace),
                             nBufXSize );
         }
-        VSIFree(pBuf);
+        if( pabyShared == nullptr )
+            VSIFree(pBuf);
     }
 
     GDALConsumeErrors(p);
@@ -5239,6 +5529,9 @@ CPLErr GDALClientRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     {
         InvalidateCachedLines();
 
+        GDALPipeReserveSharedMemory(p, static_cast<GIntBig>(nBufXSize) *
+                            nBufYSize * GDALGetDataTypeSizeBytes(eBufType));
+
         if( !WriteInstr(INSTR_Band_IRasterIO_Write) ||
             !GDALPipeWrite(p, nXOff) ||
             !GDALPipeWrite(p, nYOff) ||
@@ -5257,12 +5550,14 @@ CPLErr GDALClientRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         if( nPixelSpace == nDataTypeSize &&
             nLineSpace == static_cast<GSpacing>(nBufXSize) * nDataTypeSize )
         {
-            if( !GDALPipeWrite(p, nSize, pData) )
+            if( !GDALPipeWritePayload(p, nSize, pData) )
                 return CE_Failure;
         }
         else
         {
-            GByte* pBuf = static_cast<GByte*>(VSIMalloc(nSize));
+            GByte* pabyShared = GDALPipeGetSharedMemory(p, nSize);
+            GByte* pBuf = pabyShared ? pabyShared :
+                                static_cast<GByte*>(VSIMalloc(nSize));
             if( pBuf == nullptr )
                 return CE_Failure;
             for(int j=0;j<nBufYSize;j++)
@@ -5273,12 +5568,11 @@ CPLErr GDALClientRasterBand::IRasterIO( GDALRWFlag eRWFlag,
                                eBufType, nDataTypeSize,
                                nBufXSize );
             }
-            if( !GDALPipeWrite(p, nSize, pBuf) )
-            {
+            const int bOK = GDALPipeWritePayload(p, nSize, pBuf);
+            if( pabyShared == nullptr )
                 VSIFree(pBuf);
+            if( !bOK )
                 return CE_Failure;
-            }
-            VSIFree(pBuf);
         }
 
         if( !GDALSkipUntilEndOfJunkMarker(p) )
@@ -6407,7 +6701,7 @@ GDALDriver* GDALGetAPIPROXYDriver()
     // If asserted, change
     // GDAL_CLIENT_SERVER_PROTOCOL_MAJOR / GDAL_CLIENT_SERVER_PROTOCOL_MINOR
     // cppcheck-suppress duplicateExpression
-    CPL_STATIC_ASSERT(INSTR_END + 1 == 81);
+    CPL_STATIC_ASSERT(INSTR_END + 1 == 82);
 
     if( atoi(pszConnPool) > 0 )
     {
@@ -49,6 +49,7 @@
 #include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
+#include "cpl_trace.h"
 #include "cpl_vsi.h"
 #include "cpl_vsi_error.h"
 #include "ogr_api.h"
@@ -87,6 +88,9 @@ GDALGetDefaultAsyncReader( GDALDataset *poDS,
                            int nBandSpace, char **papszOptions );
 CPL_C_END
 
+// See gdaldefaultasync.cpp
+void GDALAsyncReaderForgetDataset( GDALDataset* poDS );
+
 enum class GDALAllowReadWriteMutexState
 {
     RW_MUTEX_STATE_UNKNOWN,
@@ -123,6 +127,8 @@ class GDALDataset::Private
 
     GDALDataset* poParentDataset = nullptr;
 
+    bool bHasBlockCacheMax = false;
+
     Private() = default;
 };
 
@@ -283,6 +289,9 @@ GDALDataset::~GDALDataset()
             CPLDebug("GDAL", "GDALClose(%s, this=%p)", GetDescription(), this);
     }
 
+    // Close the datasets reopened on this one for asynchronous readers.
+    GDALAsyncReaderForgetDataset(this);
+
     if( bSuppressOnClose )
         VSIUnlink(GetDescription());
 
@@ -346,6 +355,9 @@ GDALDataset::~GDALDataset()
 
     CPLFree(papoBands);
 
+    if( m_poPrivate != nullptr && m_poPrivate->bHasBlockCacheMax )
+        GDALRasterBlock::SetDatasetCacheMax(this, 0);
+
     if ( m_poStyleTable )
     {
         delete m_poStyleTable;
@@ -1955,6 +1967,61 @@ CPLErr GDALDataset::BuildOverviews( const char *pszResampling,
     return eErr;
 }
 
+/************************************************************************/
+/*                          SetBlockCacheMax()                          */
+/************************************************************************/
+
+/**
+ * \brief Set the maximum block cache memory for this dataset.
+ *
+ * This sets a quota, in bytes, on the amount of memory that the blocks of
+ * the raster bands of this dataset may use in the global block cache.
+ * When the quota is exceeded, the least recently used blocks of this dataset
+ * are evicted first, even if the global limit set by GDALSetCacheMax64() is
+ * not reached. This can be used to prevent a dataset read in bulk from
+ * evicting the blocks of other datasets.
+ *
+ * Note that the blocks of overviews that are exposed as separate datasets
+ * by drivers are not counted in the quota of the main dataset.
+ *
+ * This can also be set at opening time with the CACHEMAX open option
+ * (see GDALOpenEx()).
+ *
+ * @param nMaxBytes the maximum number of bytes, or 0 to remove the quota.
+ *
+ * @since GDAL 3.1
+ */
+
+void GDALDataset::SetBlockCacheMax( GIntBig nMaxBytes )
+{
+    if( m_poPrivate == nullptr )
+        return;
+    if( nMaxBytes <= 0 && !m_poPrivate->bHasBlockCacheMax )
+        return;
+    m_poPrivate->bHasBlockCacheMax = nMaxBytes > 0;
+    GDALRasterBlock::SetDatasetCacheMax(this, nMaxBytes);
+}
+
+/************************************************************************/
+/*                          GetBlockCacheMax()                          */
+/************************************************************************/
+
+/**
+ * \brief Get the maximum block cache memory for this dataset.
+ *
+ * @return the quota in bytes set with SetBlockCacheMax(), or 0 if there is
+ * none.
+ *
+ * @since GDAL 3.1
+ */
+
+GIntBig GDALDataset::GetBlockCacheMax()
+{
+    if( m_poPrivate == nullptr || !m_poPrivate->bHasBlockCacheMax )
+        return 0;
+    return GDALRasterBlock::GetDatasetCacheMax(this);
+}
+
 /************************************************************************/
 /*                         GDALBuildOverviews()                         */
 /************************************************************************/
@@ -3115,6 +3182,25 @@ static AntiRecursionStruct& GetAntiRecursion()
 }
 #endif
 
+/************************************************************************/
+/*                     IsDriverSpecificOpenOption()                     */
+/************************************************************************/
+
+// Open options handled by GDALOpenEx() for all drivers.
+static const char* const apszGenericOpenOptions[] = {
+    "OVERVIEW_LEVEL", "CACHEMAX" };
+
+// Whether a generic open option is also declared by the driver, in which
+// case it must be left to the driver.
+static bool IsDriverSpecificOpenOption( GDALDriver* poDriver,
+                                        const char* pszOption )
+{
+    const char* pszOptionList =
+        poDriver->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST);
+    return pszOptionList != nullptr &&
+           CPLString(pszOptionList).ifind(pszOption) != std::string::npos;
+}
+
 /************************************************************************/
 /*                             GDALOpenEx()                             */
 /************************************************************************/
@@ -3186,6 +3272,10 @@ static AntiRecursionStruct& GetAntiRecursion()
  * OVERVIEW_LEVEL=level, to select a particular overview level of a dataset.
  * The level index starts at 0. The level number can be suffixed by "only" to
  * specify that only this overview level must be visible, and not sub-levels.
+ * Another generic option, CACHEMAX=value (since GDAL 3.1), sets a quota on the
+ * block cache memory used by the dataset (see GDALDataset::SetBlockCacheMax()).
+ * The value is expressed in MB, or in bytes if greater than 100000, or
+ * as a percentage of GDAL_CACHEMAX if suffixed by %.
  * Open options are validated by default, and a warning is emitted in case the
  * option is not recognized. In some scenarios, it might be not desirable (e.g.
  * when not knowing which driver will open the file), so the special open option
@@ -3299,6 +3389,11 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
 
     oOpenInfo.papszOpenOptions = papszOpenOptionsCleaned;
 
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    const bool bUseSignatures =
+        CPLTestBool(CPLGetConfigOption("GDAL_OPEN_USE_SIGNATURES", "YES"));
+#endif
+
     for( int iDriver = -1; iDriver < poDM->GetDriverCount(); ++iDriver )
     {
         GDALDriver *poDriver = nullptr;
@@ -3324,36 +3419,63 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
             (nOpenFlags & GDAL_OF_RASTER) == 0 &&
             poDriver->GetMetadataItem(GDAL_DCAP_VECTOR) == nullptr )
             continue;
+
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+        // Skip the drivers whose signatures do not match the header.
+        if( bUseSignatures && !poDriver->MatchesSignatures(&oOpenInfo) )
+            continue;
+#endif
+
+        poDriver->LoadDeferred();
         if( poDriver->pfnOpen == nullptr &&
             poDriver->pfnOpenWithDriverArg == nullptr )
         {
             continue;
         }
 
-        // Remove general OVERVIEW_LEVEL open options from list before passing
-        // it to the driver, if it isn't a driver specific option already.
+        // Remove general OVERVIEW_LEVEL and CACHEMAX open options from list
+        // before passing it to the driver, if it isn't a driver specific
+        // option already.
         char **papszTmpOpenOptions = nullptr;
         char **papszTmpOpenOptionsToValidate = nullptr;
         char **papszOptionsToValidate = const_cast<char **>(papszOpenOptions);
-        if( CSLFetchNameValue(papszOpenOptionsCleaned, "OVERVIEW_LEVEL") !=
-               nullptr &&
-            (poDriver->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST) == nullptr ||
-             CPLString(poDriver->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST))
-                    .ifind("OVERVIEW_LEVEL") == std::string::npos) )
+        for( const char* pszGenericOption : apszGenericOpenOptions )
         {
-            papszTmpOpenOptions = CSLDuplicate(papszOpenOptionsCleaned);
+            if( CSLFetchNameValue(papszOpenOptionsCleaned,
+                                  pszGenericOption) == nullptr ||
+                IsDriverSpecificOpenOption(poDriver, pszGenericOption) )
+            {
+                continue;
+            }
+            if( papszTmpOpenOptions == nullptr )
+            {
+                papszTmpOpenOptions = CSLDuplicate(papszOpenOptionsCleaned);
+                papszOptionsToValidate = CSLDuplicate(papszOptionsToValidate);
+            }
             papszTmpOpenOptions =
-                CSLSetNameValue(papszTmpOpenOptions, "OVERVIEW_LEVEL", nullptr);
+                CSLSetNameValue(papszTmpOpenOptions, pszGenericOption, nullptr);
             oOpenInfo.papszOpenOptions = papszTmpOpenOptions;
 
-            papszOptionsToValidate = CSLDuplicate(papszOptionsToValidate);
             papszOptionsToValidate =
-                CSLSetNameValue(papszOptionsToValidate, "OVERVIEW_LEVEL", nullptr);
+                CSLSetNameValue(papszOptionsToValidate, pszGenericOption,
+                                nullptr);
             papszTmpOpenOptionsToValidate = papszOptionsToValidate;
         }
 
+        // Driver names are interned, so that tracing does not depend on
+        // the lifetime of the driver.
+        const bool bTrace = CPLTraceIsEnabled() != FALSE;
+        const double dfIdentifyStart = bTrace ? CPLTraceGetTimestamp() : 0;
         const bool bIdentifyRes =
             poDriver->pfnIdentify && poDriver->pfnIdentify(&oOpenInfo) > 0;
+        if( bTrace && poDriver->pfnIdentify )
+        {
+            CPLTraceAddSpan("open", CPLTraceInternString(CPLSPrintf(
+                                "%s::Identify", poDriver->GetDescription())),
+                            dfIdentifyStart,
+                            CPLTraceGetTimestamp() - dfIdentifyStart,
+                            "result", bIdentifyRes ? 1 : 0);
+        }
         if( bIdentifyRes )
         {
             GDALValidateOpenOptions(poDriver, papszOptionsToValidate);
@@ -3368,6 +3490,7 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
         sAntiRecursion.aosDatasetNamesWithFlags.insert(dsCtxt);
 
         GDALDataset *poDS = nullptr;
+        const double dfOpenStart = bTrace ? CPLTraceGetTimestamp() : 0;
         if ( poDriver->pfnOpen != nullptr )
         {
             poDS = poDriver->pfnOpen(&oOpenInfo);
@@ -3380,6 +3503,13 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
         {
             poDS = poDriver->pfnOpenWithDriverArg(poDriver, &oOpenInfo);
         }
+        if( bTrace )
+        {
+            CPLTraceAddSpan("open", CPLTraceInternString(CPLSPrintf(
+                                "%s::Open", poDriver->GetDescription())),
+                            dfOpenStart, CPLTraceGetTimestamp() - dfOpenStart,
+                            "result", poDS != nullptr ? 1 : 0);
+        }
 
         sAntiRecursion.nRecLevel --;
         sAntiRecursion.aosDatasetNamesWithFlags.erase(dsCtxt);
@@ -3437,12 +3567,21 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
                 }
             }
 
+            // Deal with generic CACHEMAX open option, unless it is
+            // driver specific.
+            const char* pszCacheMax =
+                CSLFetchNameValue(papszOpenOptionsCleaned, "CACHEMAX");
+            if( pszCacheMax != nullptr &&
+                !IsDriverSpecificOpenOption(poDriver, "CACHEMAX") )
+            {
+                poDS->SetBlockCacheMax(
+                    GDALRasterBlock::ParseCacheQuota(pszCacheMax));
+            }
+
             // Deal with generic OVERVIEW_LEVEL open option, unless it is
             // driver specific.
             if( CSLFetchNameValue(papszOpenOptions, "OVERVIEW_LEVEL") != nullptr &&
-                (poDriver->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST) == nullptr ||
-                CPLString(poDriver->GetMetadataItem(GDAL_DMD_OPENOPTIONLIST))
-                        .ifind("OVERVIEW_LEVEL") == std::string::npos) )
+                !IsDriverSpecificOpenOption(poDriver, "OVERVIEW_LEVEL") )
             {
                 CPLString osVal(
                     CSLFetchNameValue(papszOpenOptions, "OVERVIEW_LEVEL"));
@@ -3718,6 +3857,19 @@ int CPL_STDCALL GDALDumpOpenDatasets( FILE *fp )
  * the session (GDALAsyncReader) is destroyed with EndAsyncReader().  It
  * should be deallocated by the application at that point.
  *
+ * Drivers without a specific implementation use a generic one. Starting
+ * with GDAL 3.1, it performs the request in a worker thread, on another
+ * dataset opened on the same file with the same driver and open options,
+ * so that the application can do other work, including with this dataset,
+ * while the request is processed. GetNextUpdatedRegion() then returns
+ * GARIO_PENDING until the whole buffer has been read, and LockBuffer() waits
+ * for the request to be completed. This is only done for datasets opened in
+ * read-only mode, and the dataset must not be closed before the session is
+ * ended. The number of worker threads is set with the
+ * GDAL_ASYNC_READER_NUM_THREADS configuration option (2 by default, or
+ * ALL_CPUS). Setting it to 0 makes the requests be processed synchronously
+ * within GetNextUpdatedRegion(), as in previous versions.
+ *
  * Additional information on asynchronous IO in GDAL may be found at:
  *   http://trac.osgeo.org/gdal/wiki/rfc24_progressive_data_support
  *
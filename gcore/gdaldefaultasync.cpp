@@ -1,8 +1,8 @@
 /******************************************************************************
  *
  * Project:  GDAL Core
- * Purpose:  Implementation of GDALDefaultAsyncReader and the
- *           GDALAsyncReader base class.
+ * Purpose:  Implementation of GDALDefaultAsyncReader, GDALThreadedAsyncReader
+ *           and the GDALAsyncReader base class.
  * Author:   Frank Warmerdam, warmerdam@pobox.com
  *
  ******************************************************************************
@@ -30,11 +30,19 @@
 #include "cpl_port.h"
 #include "gdal_priv.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 
 CPL_CVSID("$Id: gdaldefaultasync.cpp dca024c6230a7d7f29afd2818afdc23313a18542 2018-05-06 18:08:36 +0200 Even Rouault $")
@@ -50,6 +58,9 @@ GDALGetDefaultAsyncReader( GDALDataset* poDS,
                            int nBandSpace, char **papszOptions );
 CPL_C_END
 
+void GDALAsyncReaderForgetDataset( GDALDataset* poDS );
+void GDALDestroyAsyncReaderPool();
+
 /************************************************************************/
 /* ==================================================================== */
 /*                         GDALAsyncReader                              */
@@ -303,6 +314,412 @@ class GDALDefaultAsyncReader : public GDALAsyncReader
                                              int* pnBufYSize) override;
 };
 
+/************************************************************************/
+/* ==================================================================== */
+/*                     GDALThreadedAsyncReader                          */
+/* ==================================================================== */
+/************************************************************************/
+
+// Asynchronous reader that performs the RasterIO() request in a worker
+// thread. Datasets are not thread-safe, so the request is done on another
+// dataset opened on the same file with the same driver and open options
+// (a "worker dataset"). Worker datasets are kept once a request ends,
+// so that the next request on the same dataset does not need to reopen it.
+
+class GDALThreadedAsyncReader final : public GDALAsyncReader
+{
+  private:
+    GDALDataset            *m_poWorkerDS = nullptr;
+    std::mutex              m_oMutex{};
+    std::condition_variable m_oCond{};
+    bool                    m_bDone = false;
+    bool                    m_bCancelled = false;
+    bool                    m_bReported = false;
+    CPLErr                  m_eErr = CE_None;
+    std::string             m_osErrorMsg{};
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALThreadedAsyncReader)
+
+    static void ReadJob( void* pData );
+    static int CPL_STDCALL CancelProgress( double, const char*, void* pData );
+    bool WaitDone( double dfTimeout, std::unique_lock<std::mutex>& oLock );
+
+  public:
+    GDALThreadedAsyncReader( GDALDataset* poDS, GDALDataset* poWorkerDS,
+                             int nXOff, int nYOff,
+                             int nXSize, int nYSize,
+                             void *pBuf,
+                             int nBufXSize, int nBufYSize,
+                             GDALDataType eBufType,
+                             int nBandCount, int* panBandMap,
+                             int nPixelSpace, int nLineSpace,
+                             int nBandSpace );
+    ~GDALThreadedAsyncReader() override;
+
+    bool Start();
+
+    GDALAsyncStatusType GetNextUpdatedRegion(double dfTimeout,
+                                             int* pnBufXOff,
+                                             int* pnBufYOff,
+                                             int* pnBufXSize,
+                                             int* pnBufYSize) override;
+    int LockBuffer( double dfTimeout = -1.0 ) override;
+};
+
+static std::mutex gMutexAsyncReader;
+static CPLWorkerThreadPool* gpoAsyncReaderPool = nullptr;
+static bool gbAsyncReaderPoolFailed = false;
+// Unused worker datasets, indexed by the dataset they were opened from.
+static std::map<GDALDataset*, std::vector<GDALDataset*>>*
+                                            gpoMapFreeWorkerDatasets = nullptr;
+
+/************************************************************************/
+/*                      GDALGetAsyncReaderPool()                        */
+/************************************************************************/
+
+// Return the pool of the threads doing asynchronous requests, or nullptr
+// if asynchronous requests must be done synchronously.
+static CPLWorkerThreadPool* GDALGetAsyncReaderPool()
+{
+    std::lock_guard<std::mutex> oLock(gMutexAsyncReader);
+    if( gpoAsyncReaderPool == nullptr && !gbAsyncReaderPoolFailed )
+    {
+        const char* pszThreads =
+            CPLGetConfigOption("GDAL_ASYNC_READER_NUM_THREADS", "2");
+        int nThreads = EQUAL(pszThreads, "ALL_CPUS") ? CPLGetNumCPUs() :
+                                                       atoi(pszThreads);
+        nThreads = std::min(128, nThreads);
+        if( nThreads <= 0 )
+        {
+            gbAsyncReaderPoolFailed = true;
+            return nullptr;
+        }
+        gpoAsyncReaderPool = new CPLWorkerThreadPool();
+        if( !gpoAsyncReaderPool->Setup(nThreads, nullptr, nullptr, false) )
+        {
+            delete gpoAsyncReaderPool;
+            gpoAsyncReaderPool = nullptr;
+            gbAsyncReaderPoolFailed = true;
+        }
+    }
+    return gpoAsyncReaderPool;
+}
+
+/************************************************************************/
+/*                    GDALAcquireAsyncWorkerDataset()                   */
+/************************************************************************/
+
+// Return a worker dataset for poDS, either an unused one or a newly opened
+// one, or nullptr if poDS cannot be reopened.
+static GDALDataset* GDALAcquireAsyncWorkerDataset( GDALDataset* poDS )
+{
+    {
+        std::lock_guard<std::mutex> oLock(gMutexAsyncReader);
+        if( gpoMapFreeWorkerDatasets != nullptr )
+        {
+            auto oIter = gpoMapFreeWorkerDatasets->find(poDS);
+            if( oIter != gpoMapFreeWorkerDatasets->end() &&
+                !oIter->second.empty() )
+            {
+                GDALDataset* poWorkerDS = oIter->second.back();
+                oIter->second.pop_back();
+                return poWorkerDS;
+            }
+        }
+    }
+
+    // Datasets opened in update mode may have pending changes that a
+    // reopened dataset would not see.
+    GDALDriver* poDriver = poDS->GetDriver();
+    if( poDS->GetAccess() != GA_ReadOnly || poDriver == nullptr ||
+        poDS->GetDescription()[0] == '\0' )
+        return nullptr;
+
+    const char* const apszAllowedDrivers[] = { poDriver->GetDescription(),
+                                               nullptr };
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    GDALDataset* poWorkerDS = GDALDataset::FromHandle(
+        GDALOpenEx( poDS->GetDescription(), GDAL_OF_RASTER | GDAL_OF_INTERNAL,
+                    apszAllowedDrivers, poDS->GetOpenOptions(), nullptr ));
+    CPLPopErrorHandler();
+    if( poWorkerDS == nullptr )
+        return nullptr;
+    if( poWorkerDS->GetRasterXSize() != poDS->GetRasterXSize() ||
+        poWorkerDS->GetRasterYSize() != poDS->GetRasterYSize() ||
+        poWorkerDS->GetRasterCount() != poDS->GetRasterCount() )
+    {
+        GDALClose(poWorkerDS);
+        return nullptr;
+    }
+    return poWorkerDS;
+}
+
+/************************************************************************/
+/*                    GDALReleaseAsyncWorkerDataset()                   */
+/************************************************************************/
+
+static void GDALReleaseAsyncWorkerDataset( GDALDataset* poDS,
+                                           GDALDataset* poWorkerDS )
+{
+    {
+        std::lock_guard<std::mutex> oLock(gMutexAsyncReader);
+        if( gpoMapFreeWorkerDatasets == nullptr )
+            gpoMapFreeWorkerDatasets =
+                new std::map<GDALDataset*, std::vector<GDALDataset*>>();
+        std::vector<GDALDataset*>& apoFree = (*gpoMapFreeWorkerDatasets)[poDS];
+        // Keep at most one worker dataset per thread.
+        if( gpoAsyncReaderPool != nullptr &&
+            static_cast<int>(apoFree.size()) <
+                                    gpoAsyncReaderPool->GetThreadCount() )
+        {
+            apoFree.push_back(poWorkerDS);
+            return;
+        }
+    }
+    GDALClose(poWorkerDS);
+}
+
+/************************************************************************/
+/*                    GDALAsyncReaderForgetDataset()                    */
+/************************************************************************/
+
+// Called when a dataset is destroyed, to close its worker datasets.
+void GDALAsyncReaderForgetDataset( GDALDataset* poDS )
+{
+    std::vector<GDALDataset*> apoToClose;
+    {
+        std::lock_guard<std::mutex> oLock(gMutexAsyncReader);
+        if( gpoMapFreeWorkerDatasets == nullptr )
+            return;
+        auto oIter = gpoMapFreeWorkerDatasets->find(poDS);
+        if( oIter == gpoMapFreeWorkerDatasets->end() )
+            return;
+        apoToClose = std::move(oIter->second);
+        gpoMapFreeWorkerDatasets->erase(oIter);
+    }
+    // Outside of the lock, since this calls this function again.
+    for( GDALDataset* poWorkerDS: apoToClose )
+        GDALClose(poWorkerDS);
+}
+
+/************************************************************************/
+/*                     GDALDestroyAsyncReaderPool()                     */
+/************************************************************************/
+
+void GDALDestroyAsyncReaderPool()
+{
+    CPLWorkerThreadPool* poPool = nullptr;
+    std::map<GDALDataset*, std::vector<GDALDataset*>>* poMap = nullptr;
+    {
+        std::lock_guard<std::mutex> oLock(gMutexAsyncReader);
+        poPool = gpoAsyncReaderPool;
+        gpoAsyncReaderPool = nullptr;
+        poMap = gpoMapFreeWorkerDatasets;
+        gpoMapFreeWorkerDatasets = nullptr;
+        gbAsyncReaderPoolFailed = false;
+    }
+    delete poPool;
+    if( poMap != nullptr )
+    {
+        for( auto& oIter: *poMap )
+        {
+            for( GDALDataset* poWorkerDS: oIter.second )
+                GDALClose(poWorkerDS);
+        }
+        delete poMap;
+    }
+}
+
+/************************************************************************/
+/*                      GDALThreadedAsyncReader()                       */
+/************************************************************************/
+
+GDALThreadedAsyncReader::GDALThreadedAsyncReader( GDALDataset* poDSIn,
+                                                  GDALDataset* poWorkerDSIn,
+                                                  int nXOffIn, int nYOffIn,
+                                                  int nXSizeIn, int nYSizeIn,
+                                                  void *pBufIn,
+                                                  int nBufXSizeIn,
+                                                  int nBufYSizeIn,
+                                                  GDALDataType eBufTypeIn,
+                                                  int nBandCountIn,
+                                                  int* panBandMapIn,
+                                                  int nPixelSpaceIn,
+                                                  int nLineSpaceIn,
+                                                  int nBandSpaceIn ) :
+    m_poWorkerDS(poWorkerDSIn)
+{
+    poDS = poDSIn;
+    nXOff = nXOffIn;
+    nYOff = nYOffIn;
+    nXSize = nXSizeIn;
+    nYSize = nYSizeIn;
+    pBuf = pBufIn;
+    nBufXSize = nBufXSizeIn;
+    nBufYSize = nBufYSizeIn;
+    eBufType = eBufTypeIn;
+    nBandCount = nBandCountIn;
+    panBandMap = static_cast<int*>(CPLMalloc(sizeof(int)*nBandCountIn));
+
+    if( panBandMapIn != nullptr )
+        memcpy( panBandMap, panBandMapIn, sizeof(int)*nBandCount );
+    else
+    {
+        for( int i = 0; i < nBandCount; i++ )
+            panBandMap[i] = i+1;
+    }
+
+    nPixelSpace = nPixelSpaceIn;
+    nLineSpace = nLineSpaceIn;
+    nBandSpace = nBandSpaceIn;
+}
+
+/************************************************************************/
+/*                      ~GDALThreadedAsyncReader()                      */
+/************************************************************************/
+
+GDALThreadedAsyncReader::~GDALThreadedAsyncReader()
+
+{
+    {
+        // Interrupt the request if it is still running.
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        m_bCancelled = true;
+        WaitDone(-1.0, oLock);
+    }
+    GDALReleaseAsyncWorkerDataset( poDS, m_poWorkerDS );
+    CPLFree( panBandMap );
+}
+
+/************************************************************************/
+/*                               Start()                                */
+/************************************************************************/
+
+bool GDALThreadedAsyncReader::Start()
+{
+    CPLWorkerThreadPool* poPool = GDALGetAsyncReaderPool();
+    if( poPool == nullptr || !poPool->SubmitJob(ReadJob, this) )
+    {
+        // Mark done so that the destructor does not wait.
+        m_bDone = true;
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           CancelProgress()                           */
+/************************************************************************/
+
+int CPL_STDCALL GDALThreadedAsyncReader::CancelProgress( double,
+                                                         const char*,
+                                                         void* pData )
+{
+    GDALThreadedAsyncReader* poThis =
+        static_cast<GDALThreadedAsyncReader*>(pData);
+    std::lock_guard<std::mutex> oLock(poThis->m_oMutex);
+    return !poThis->m_bCancelled;
+}
+
+/************************************************************************/
+/*                              ReadJob()                               */
+/************************************************************************/
+
+void GDALThreadedAsyncReader::ReadJob( void* pData )
+{
+    GDALThreadedAsyncReader* poThis =
+        static_cast<GDALThreadedAsyncReader*>(pData);
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    sExtraArg.pfnProgress = CancelProgress;
+    sExtraArg.pProgressData = poThis;
+
+    // Errors are reported by GetNextUpdatedRegion() in the thread of the
+    // caller.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    CPLErrorReset();
+    const CPLErr eErr = poThis->m_poWorkerDS->RasterIO(
+        GF_Read, poThis->nXOff, poThis->nYOff,
+        poThis->nXSize, poThis->nYSize,
+        poThis->pBuf, poThis->nBufXSize, poThis->nBufYSize, poThis->eBufType,
+        poThis->nBandCount, poThis->panBandMap,
+        poThis->nPixelSpace, poThis->nLineSpace, poThis->nBandSpace,
+        &sExtraArg );
+    const std::string osErrorMsg(CPLGetLastErrorMsg());
+    CPLPopErrorHandler();
+
+    std::lock_guard<std::mutex> oLock(poThis->m_oMutex);
+    poThis->m_eErr = eErr;
+    poThis->m_osErrorMsg = osErrorMsg;
+    poThis->m_bDone = true;
+    poThis->m_oCond.notify_all();
+}
+
+/************************************************************************/
+/*                              WaitDone()                              */
+/************************************************************************/
+
+bool GDALThreadedAsyncReader::WaitDone( double dfTimeout,
+                                        std::unique_lock<std::mutex>& oLock )
+{
+    if( dfTimeout < 0 )
+        m_oCond.wait(oLock, [this]() { return m_bDone; });
+    else if( dfTimeout > 0 )
+        m_oCond.wait_for(oLock, std::chrono::duration<double>(dfTimeout),
+                         [this]() { return m_bDone; });
+    return m_bDone;
+}
+
+/************************************************************************/
+/*                        GetNextUpdatedRegion()                        */
+/************************************************************************/
+
+GDALAsyncStatusType
+GDALThreadedAsyncReader::GetNextUpdatedRegion( double dfTimeout,
+                                               int* pnBufXOff,
+                                               int* pnBufYOff,
+                                               int* pnBufXSize,
+                                               int* pnBufYSize )
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    if( !WaitDone(dfTimeout, oLock) )
+    {
+        *pnBufXOff = 0;
+        *pnBufYOff = 0;
+        *pnBufXSize = 0;
+        *pnBufYSize = 0;
+        return GARIO_PENDING;
+    }
+
+    *pnBufXOff = 0;
+    *pnBufYOff = 0;
+    *pnBufXSize = nBufXSize;
+    *pnBufYSize = nBufYSize;
+
+    if( m_eErr == CE_None )
+        return GARIO_COMPLETE;
+
+    if( !m_bReported )
+    {
+        m_bReported = true;
+        CPLError( CE_Failure, CPLE_AppDefined, "%s", m_osErrorMsg.c_str() );
+    }
+    return GARIO_ERROR;
+}
+
+/************************************************************************/
+/*                             LockBuffer()                             */
+/************************************************************************/
+
+// The buffer is only modified by the worker thread until the request is
+// complete.
+int GDALThreadedAsyncReader::LockBuffer( double dfTimeout )
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    return WaitDone(dfTimeout, oLock);
+}
+
 /************************************************************************/
 /*                     GDALGetDefaultAsyncReader()                      */
 /************************************************************************/
@@ -319,6 +736,28 @@ GDALGetDefaultAsyncReader( GDALDataset* poDS,
                              int nBandSpace, char **papszOptions)
 
 {
+/* -------------------------------------------------------------------- */
+/*      Do the request in a worker thread if possible.                  */
+/* -------------------------------------------------------------------- */
+    if( GDALGetAsyncReaderPool() != nullptr )
+    {
+        GDALDataset* poWorkerDS = GDALAcquireAsyncWorkerDataset(poDS);
+        if( poWorkerDS != nullptr )
+        {
+            GDALThreadedAsyncReader* poReader =
+                new GDALThreadedAsyncReader( poDS, poWorkerDS,
+                                             nXOff, nYOff, nXSize, nYSize,
+                                             pBuf, nBufXSize, nBufYSize,
+                                             eBufType,
+                                             nBandCount, panBandMap,
+                                             nPixelSpace, nLineSpace,
+                                             nBandSpace );
+            if( poReader->Start() )
+                return poReader;
+            delete poReader;
+        }
+    }
+
     return new GDALDefaultAsyncReader( poDS,
                                          nXOff, nYOff, nXSize, nYSize,
                                          pBuf, nBufXSize, nBufYSize, eBufType,
@@ -32,6 +32,8 @@
 #include "gdal_priv.h"
 #include "gdal_rat.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
@@ -81,6 +83,7 @@ GDALDriver::~GDALDriver()
 {
     if( pfnUnloadDriver != nullptr )
         pfnUnloadDriver( this );
+    delete m_poDeferredDriver;
 }
 
 /************************************************************************/
@@ -164,6 +167,8 @@ GDALDataset * GDALDriver::Create( const char * pszFilename,
                                   GDALDataType eType, char ** papszOptions )
 
 {
+    LoadDeferred();
+
 /* -------------------------------------------------------------------- */
 /*      Does this format support creation.                              */
 /* -------------------------------------------------------------------- */
@@ -810,6 +815,8 @@ GDALDataset *GDALDriver::CreateCopy( const char * pszFilename,
                                      void * pProgressData )
 
 {
+    LoadDeferred();
+
     if( pfnProgress == nullptr )
         pfnProgress = GDALDummyProgress;
 
@@ -1079,6 +1086,8 @@ CPLErr GDALDriver::QuietDelete( const char *pszName )
 CPLErr GDALDriver::Delete( const char * pszFilename )
 
 {
+    LoadDeferred();
+
     if( pfnDelete != nullptr )
         return pfnDelete( pszFilename );
     else if( pfnDeleteDataSource != nullptr )
@@ -1254,6 +1263,8 @@ CPLErr GDALDriver::DefaultRename( const char * pszNewName,
 CPLErr GDALDriver::Rename( const char * pszNewName, const char *pszOldName )
 
 {
+    LoadDeferred();
+
     if( pfnRename != nullptr )
         return pfnRename( pszNewName, pszOldName );
 
@@ -1379,6 +1390,8 @@ CPLErr GDALDriver::DefaultCopyFiles( const char *pszNewName,
 CPLErr GDALDriver::CopyFiles( const char *pszNewName, const char *pszOldName )
 
 {
+    LoadDeferred();
+
     if( pfnCopyFiles != nullptr )
         return pfnCopyFiles( pszNewName, pszOldName );
 
@@ -2034,6 +2047,11 @@ GDALIdentifyDriverEx( const char* pszFilename,
 
     const int nDriverCount = poDM->GetDriverCount();
 
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    const bool bUseSignatures =
+        CPLTestBool(CPLGetConfigOption("GDAL_OPEN_USE_SIGNATURES", "YES"));
+#endif
+
     // First pass: only use drivers that have a pfnIdentify implementation.
     for( int iDriver = -1; iDriver < nDriverCount; ++iDriver )
     {
@@ -2052,11 +2070,6 @@ GDALIdentifyDriverEx( const char* pszFilename,
 
         VALIDATE_POINTER1( poDriver, "GDALIdentifyDriver", nullptr );
 
-        if( poDriver->pfnIdentify == nullptr )
-        {
-            continue;
-        }
-
         if (papszAllowedDrivers != nullptr &&
             CSLFindString(papszAllowedDrivers,
                           GDALGetDriverShortName(poDriver)) == -1)
@@ -2070,6 +2083,18 @@ GDALIdentifyDriverEx( const char* pszFilename,
             poDriver->GetMetadataItem(GDAL_DCAP_VECTOR) == nullptr )
             continue;
 
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+        // Skip the drivers whose signatures do not match the header.
+        if( bUseSignatures && !poDriver->MatchesSignatures(&oOpenInfo) )
+            continue;
+#endif
+
+        poDriver->LoadDeferred();
+        if( poDriver->pfnIdentify == nullptr )
+        {
+            continue;
+        }
+
         if( poDriver->pfnIdentify( &oOpenInfo ) > 0 )
             return poDriver;
     }
@@ -2101,6 +2126,13 @@ GDALIdentifyDriverEx( const char* pszFilename,
             poDriver->GetMetadataItem(GDAL_DCAP_VECTOR) == nullptr )
             continue;
 
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+        // Skip the drivers whose signatures do not match the header.
+        if( bUseSignatures && !poDriver->MatchesSignatures(&oOpenInfo) )
+            continue;
+#endif
+
+        poDriver->LoadDeferred();
         if( poDriver->pfnIdentify != nullptr )
         {
             if( poDriver->pfnIdentify( &oOpenInfo ) == 0 )
@@ -2154,6 +2186,174 @@ CPLErr GDALDriver::SetMetadataItem( const char *pszName,
         {
             GDALMajorObject::SetMetadataItem(GDAL_DMD_EXTENSIONS, pszValue);
         }
+        else if( EQUAL(pszName, GDAL_DMD_SIGNATURES) )
+        {
+            SetSignatures(pszValue);
+        }
     }
+    LoadDeferred();
+    if( m_poDeferredDriver )
+        return m_poDeferredDriver->SetMetadataItem(pszName, pszValue,
+                                                   pszDomain);
     return GDALMajorObject::SetMetadataItem(pszName, pszValue, pszDomain);
 }
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/************************************************************************/
+
+const char *GDALDriver::GetMetadataItem( const char *pszName,
+                                         const char *pszDomain )
+
+{
+    if( m_bDeferred.load() )
+    {
+        // The stub of a deferred driver knows about the items needed by
+        // GDALOpenEx() to skip it.
+        if( (pszDomain == nullptr || pszDomain[0] == '\0') &&
+            (EQUAL(pszName, GDAL_DCAP_RASTER) ||
+             EQUAL(pszName, GDAL_DCAP_VECTOR) ||
+             EQUAL(pszName, GDAL_DCAP_GNM) ||
+             EQUAL(pszName, GDAL_DMD_SIGNATURES)) )
+        {
+            return GDALMajorObject::GetMetadataItem(pszName, pszDomain);
+        }
+        LoadDeferred();
+    }
+    if( m_poDeferredDriver )
+        return m_poDeferredDriver->GetMetadataItem(pszName, pszDomain);
+    return GDALMajorObject::GetMetadataItem(pszName, pszDomain);
+}
+
+/************************************************************************/
+/*                            GetMetadata()                             */
+/************************************************************************/
+
+char **GDALDriver::GetMetadata( const char *pszDomain )
+
+{
+    LoadDeferred();
+    if( m_poDeferredDriver )
+        return m_poDeferredDriver->GetMetadata(pszDomain);
+    return GDALMajorObject::GetMetadata(pszDomain);
+}
+
+/************************************************************************/
+/*                            SetMetadata()                             */
+/************************************************************************/
+
+CPLErr GDALDriver::SetMetadata( char **papszMetadata, const char *pszDomain )
+
+{
+    LoadDeferred();
+    if( m_poDeferredDriver )
+        return m_poDeferredDriver->SetMetadata(papszMetadata, pszDomain);
+    return GDALMajorObject::SetMetadata(papszMetadata, pszDomain);
+}
+
+/************************************************************************/
+/*                       GetMetadataDomainList()                        */
+/************************************************************************/
+
+char **GDALDriver::GetMetadataDomainList()
+
+{
+    LoadDeferred();
+    if( m_poDeferredDriver )
+        return m_poDeferredDriver->GetMetadataDomainList();
+    return GDALMajorObject::GetMetadataDomainList();
+}
+
+/************************************************************************/
+/*                            LoadDeferred()                            */
+/************************************************************************/
+
+/** Registers the driver of a stub registered with
+ * GDALDriverManager::RegisterDeferredDriver(), if not done yet. */
+void GDALDriver::LoadDeferred()
+
+{
+    if( m_bDeferred.load() )
+        GetGDALDriverManager()->LoadDeferredDriver(this);
+}
+
+/************************************************************************/
+/*                           SetSignatures()                            */
+/************************************************************************/
+
+void GDALDriver::SetSignatures( const char* pszValue )
+{
+    m_aoSignatures.clear();
+    m_bHasSignatures = false;
+    if( pszValue == nullptr )
+        return;
+
+    const CPLStringList aosTokens(CSLTokenizeString2(pszValue, " ", 0));
+    for( int i = 0; i < aosTokens.size(); i++ )
+    {
+        const char* pszToken = aosTokens[i];
+        size_t nOffset = 0;
+        const char* pszColon = strchr(pszToken, ':');
+        if( pszColon != nullptr )
+        {
+            nOffset = static_cast<size_t>(atoi(pszToken));
+            pszToken = pszColon + 1;
+        }
+        const size_t nLen = strlen(pszToken);
+        bool bValid = nLen > 0 && (nLen % 2) == 0;
+        for( size_t j = 0; bValid && j < nLen; j++ )
+            bValid = isxdigit(static_cast<unsigned char>(pszToken[j])) != 0;
+        if( !bValid )
+        {
+            // Better try the driver on all files than miss some.
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "Invalid %s in driver %s: %s", GDAL_DMD_SIGNATURES,
+                     GetDescription(), pszValue);
+            m_aoSignatures.clear();
+            return;
+        }
+        int nBytes = 0;
+        GByte* pabyBytes = CPLHexToBinary(pszToken, &nBytes);
+        m_aoSignatures.emplace_back(
+            nOffset, std::string(reinterpret_cast<char*>(pabyBytes), nBytes));
+        CPLFree(pabyBytes);
+    }
+    m_bHasSignatures = !m_aoSignatures.empty();
+}
+
+/************************************************************************/
+/*                         MatchesSignatures()                          */
+/************************************************************************/
+
+/** Returns whether the header of the file matches one of the signatures
+ * of GDAL_DMD_SIGNATURES, or cannot be checked against them, that is
+ * whether the driver must be tried on the file.
+ */
+bool GDALDriver::MatchesSignatures( const GDALOpenInfo* poOpenInfo ) const
+{
+    // Files that do not exist, directories and connection strings.
+    if( !m_bHasSignatures || poOpenInfo->nHeaderBytes <= 0 )
+        return true;
+
+    const size_t nHeaderBytes = static_cast<size_t>(poOpenInfo->nHeaderBytes);
+    for( const auto& oSignature : m_aoSignatures )
+    {
+        const size_t nOffset = oSignature.first;
+        if( nOffset >= nHeaderBytes )
+            return true;
+        // A shorter header is checked on what it contains.
+        const size_t nLen =
+            std::min(oSignature.second.size(), nHeaderBytes - nOffset);
+        const GByte* pabyHeader = poOpenInfo->pabyHeader + nOffset;
+        size_t i = 0;
+        for( ; i < nLen; i++ )
+        {
+            if( tolower(pabyHeader[i]) !=
+                    tolower(static_cast<GByte>(oSignature.second[i])) )
+                break;
+        }
+        if( i == nLen )
+            return true;
+    }
+    return false;
+}
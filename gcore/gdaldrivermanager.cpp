@@ -39,7 +39,9 @@
 #include "cpl_multiproc.h"
 #include "cpl_port.h"
 #include "cpl_string.h"
+#include "cpl_trace.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_alg.h"
 #include "gdal_alg_priv.h"
 #include "gdal.h"
@@ -146,9 +148,20 @@ GDALDriverManager::GDALDriverManager()
 void GDALDatasetPoolPreventDestroy();
 void GDALDatasetPoolForceDestroy();
 
+// See gdaldefaultasync.cpp
+void GDALDestroyAsyncReaderPool();
+
+// See alg/gdalwarpkernel.cpp
+void GDALDestroyOpenCLWarpCache();
+
 GDALDriverManager::~GDALDriverManager()
 
 {
+/* -------------------------------------------------------------------- */
+/*      Stop the threads of asynchronous readers.                       */
+/* -------------------------------------------------------------------- */
+    GDALDestroyAsyncReaderPool();
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup any open datasets.                                      */
 /* -------------------------------------------------------------------- */
@@ -222,6 +235,17 @@ GDALDriverManager::~GDALDriverManager()
 
     delete GDALGetAPIPROXYDriver();
 
+/* -------------------------------------------------------------------- */
+/*      Stop the global thread pool, now that the datasets using it     */
+/*      are closed.                                                     */
+/* -------------------------------------------------------------------- */
+    CPLDestroyGlobalWorkerThreadPool();
+
+/* -------------------------------------------------------------------- */
+/*      Release the OpenCL context and programs kept by the warper.     */
+/* -------------------------------------------------------------------- */
+    GDALDestroyOpenCLWarpCache();
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup local memory.                                           */
 /* -------------------------------------------------------------------- */
@@ -232,6 +256,11 @@ GDALDriverManager::~GDALDriverManager()
 /* -------------------------------------------------------------------- */
     PamCleanProxyDB();
 
+/* -------------------------------------------------------------------- */
+/*      Write the trace file requested with GDAL_TRACE_FILE.            */
+/* -------------------------------------------------------------------- */
+    CPLTraceStop();
+
 /* -------------------------------------------------------------------- */
 /*      Blow away all the finder hints paths.  We really should not     */
 /*      be doing all of them, but it is currently hard to keep track    */
@@ -427,6 +456,32 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
 {
     CPLMutexHolderD( &hDMMutex );
 
+/* -------------------------------------------------------------------- */
+/*      If this is the real driver of the deferred stub being loaded,   */
+/*      attach it to the stub, which keeps its place in the list.       */
+/* -------------------------------------------------------------------- */
+    if( poDeferredStub != nullptr && poDriver != poDeferredStub &&
+        EQUAL(poDriver->GetDescription(), poDeferredStub->GetDescription()) )
+    {
+        if( poDriver->pfnOpen != nullptr ||
+            poDriver->pfnOpenWithDriverArg != nullptr )
+            poDriver->SetMetadataItem( GDAL_DCAP_OPEN, "YES" );
+
+        if( poDriver->pfnCreate != nullptr )
+            poDriver->SetMetadataItem( GDAL_DCAP_CREATE, "YES" );
+
+        if( poDriver->pfnCreateCopy != nullptr )
+            poDriver->SetMetadataItem( GDAL_DCAP_CREATECOPY, "YES" );
+
+        poDeferredStub->m_poDeferredDriver = poDriver;
+        for( int i = 0; i < nDrivers; ++i )
+        {
+            if( papoDrivers[i] == poDeferredStub )
+                return i;
+        }
+        return -1;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      If it is already registered, just return the existing           */
 /*      index.                                                          */
@@ -456,6 +511,14 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
     papoDrivers[nDrivers] = poDriver;
     ++nDrivers;
 
+    if( poDriver->IsDeferred() )
+    {
+        // Capabilities have been set by RegisterDeferredDriver().
+        oMapNameToDrivers[CPLString(poDriver->GetDescription()).toupper()] =
+            poDriver;
+        return nDrivers - 1;
+    }
+
     if( poDriver->pfnOpen != nullptr ||
         poDriver->pfnOpenWithDriverArg != nullptr )
         poDriver->SetMetadataItem( GDAL_DCAP_OPEN, "YES" );
@@ -497,6 +560,129 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
     return iResult;
 }
 
+/************************************************************************/
+/*                       RegisterDeferredDriver()                       */
+/************************************************************************/
+
+/**
+ * \brief Register a driver whose registration function is only called
+ * when the driver is first used.
+ *
+ * A stub driver, that only knows about the name, the raster and vector
+ * capabilities and the GDAL_DMD_SIGNATURES of the driver, is registered in
+ * its place. GDALOpenEx() can then skip it when a file does not match its
+ * signatures without ever calling pfnRegister. Any other use of the stub,
+ * like opening a file, creating a dataset or querying other metadata,
+ * calls pfnRegister and forwards to the real driver.
+ *
+ * If the GDAL_DEFERRED_DRIVER_REGISTRATION configuration option is set to
+ * NO, pfnRegister is called immediately.
+ *
+ * @param pszName the short name of the driver, that pfnRegister registers.
+ * @param pfnRegister the registration function of the driver.
+ * @param bRaster whether the driver has the GDAL_DCAP_RASTER capability.
+ * @param bVector whether the driver has the GDAL_DCAP_VECTOR capability.
+ * @param pszSignatures the GDAL_DMD_SIGNATURES of the driver, that must be
+ * the same as the ones of the real driver.
+ *
+ * @since GDAL 3.1
+ */
+
+void GDALDriverManager::RegisterDeferredDriver( const char* pszName,
+                                                void (*pfnRegister)(),
+                                                bool bRaster, bool bVector,
+                                                const char* pszSignatures )
+
+{
+    if( !CPLTestBool(
+            CPLGetConfigOption("GDAL_DEFERRED_DRIVER_REGISTRATION", "YES")) )
+    {
+        pfnRegister();
+        return;
+    }
+
+    if( GetDriverByName( pszName ) != nullptr )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+    poDriver->SetDescription( pszName );
+    if( bRaster )
+        poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+    if( bVector )
+        poDriver->SetMetadataItem( GDAL_DCAP_VECTOR, "YES" );
+    if( pszSignatures != nullptr )
+        poDriver->SetMetadataItem( GDAL_DMD_SIGNATURES, pszSignatures );
+    poDriver->m_pfnDeferredRegister = pfnRegister;
+    poDriver->m_bDeferred.store(true);
+
+    RegisterDriver( poDriver );
+}
+
+/************************************************************************/
+/*                         LoadDeferredDriver()                         */
+/************************************************************************/
+
+void GDALDriverManager::LoadDeferredDriver( GDALDriver* poStub )
+
+{
+    CPLMutexHolderD( &hDMMutex );
+
+    if( !poStub->m_bDeferred.load() )
+        return;
+
+    CPLDebug( "GDAL", "Loading deferred driver %s",
+              poStub->GetDescription() );
+
+    GDALDriver *poOldStub = poDeferredStub;
+    poDeferredStub = poStub;
+    poStub->m_pfnDeferredRegister();
+    poDeferredStub = poOldStub;
+
+    GDALDriver *poDriver = poStub->m_poDeferredDriver;
+    if( poDriver == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Registration function of deferred driver %s did not "
+                  "register it",
+                  poStub->GetDescription() );
+    }
+    else
+    {
+        poStub->pfnOpen = poDriver->pfnOpen;
+        poStub->pfnCreate = poDriver->pfnCreate;
+        poStub->pfnDelete = poDriver->pfnDelete;
+        poStub->pfnCreateCopy = poDriver->pfnCreateCopy;
+        poStub->pDriverData = poDriver->pDriverData;
+        poStub->pfnIdentify = poDriver->pfnIdentify;
+        poStub->pfnRename = poDriver->pfnRename;
+        poStub->pfnCopyFiles = poDriver->pfnCopyFiles;
+        poStub->pfnOpenWithDriverArg = poDriver->pfnOpenWithDriverArg;
+        poStub->pfnCreateVectorOnly = poDriver->pfnCreateVectorOnly;
+        poStub->pfnDeleteDataSource = poDriver->pfnDeleteDataSource;
+
+        // The unload function is called with the stub, which is the driver
+        // known by the application.
+        poStub->pfnUnloadDriver = poDriver->pfnUnloadDriver;
+        poDriver->pfnUnloadDriver = nullptr;
+
+        const char *pszStubSignatures =
+            poStub->GDALMajorObject::GetMetadataItem( GDAL_DMD_SIGNATURES );
+        const char *pszSignatures =
+            poDriver->GetMetadataItem( GDAL_DMD_SIGNATURES );
+        if( pszStubSignatures != nullptr &&
+            (pszSignatures == nullptr ||
+             !EQUAL(pszStubSignatures, pszSignatures)) )
+        {
+            CPLDebug( "GDAL",
+                      "Signatures of deferred driver %s differ from the "
+                      "ones of its stub",
+                      poStub->GetDescription() );
+        }
+    }
+
+    poStub->m_bDeferred.store(false);
+}
+
 /************************************************************************/
 /*                         GDALRegisterDriver()                         */
 /************************************************************************/
@@ -596,7 +782,7 @@ GDALDriver * GDALDriverManager::GetDriverByName( const char * pszName )
     if( EQUAL(pszName, "CartoDB") )
         pszName = "Carto";
 
-    return oMapNameToDrivers[CPLString(pszName).toupper()];
+    return GetDriverByName_unlocked(pszName);
 }
 
 /************************************************************************/
@@ -33,6 +33,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <limits>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -40,6 +42,14 @@
 #include "gdal.h"
 #include "gdal_priv_templates.hpp"
 
+#if defined(__x86_64) || defined(_M_X64)
+#define HAVE_SSE2_NODATA_MASK
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#endif
+
 CPL_CVSID("$Id: gdalnodatamaskband.cpp 003ad4e9e410423af8b35843956f781e44a8daac 2019-02-18 15:48:35 +0100 Even Rouault $")
 
 //! @cond Doxygen_Suppress
@@ -80,12 +90,20 @@ static GDALDataType GetWorkDataType(GDALDataType eDataType)
         eWrkDT = GDT_Byte;
         break;
 
+      // 16 bit data is compared in its own type, to halve the size of the
+      // buffers compared to a promotion to 32 bit.
       case GDT_UInt16:
+        eWrkDT = GDT_UInt16;
+        break;
+
+      case GDT_Int16:
+        eWrkDT = GDT_Int16;
+        break;
+
       case GDT_UInt32:
         eWrkDT = GDT_UInt32;
         break;
 
-      case GDT_Int16:
       case GDT_Int32:
       case GDT_CInt16:
       case GDT_CInt32:
@@ -125,6 +143,16 @@ bool GDALNoDataMaskBand::IsNoDataInRange(double dfNoDataValue,
           return GDALIsValueInRange<GByte>(dfNoDataValue);
       }
 
+      case GDT_UInt16:
+      {
+          return GDALIsValueInRange<GUInt16>(dfNoDataValue);
+      }
+
+      case GDT_Int16:
+      {
+          return GDALIsValueInRange<GInt16>(dfNoDataValue);
+      }
+
       case GDT_UInt32:
       {
           return GDALIsValueInRange<GUInt32>(dfNoDataValue);
@@ -153,6 +181,452 @@ bool GDALNoDataMaskBand::IsNoDataInRange(double dfNoDataValue,
     }
 }
 
+/************************************************************************/
+/*                           IsNoDataValue()                            */
+/*                                                                      */
+/*      With bApprox, floating point values are compared with           */
+/*      ARE_REAL_EQUAL(), and a NaN nodata value matches NaN values.    */
+/*      Otherwise they are compared with ==.                            */
+/************************************************************************/
+
+template<class T> static inline bool IsNoDataValue( T tVal, T tNoData,
+                                                    bool /* bApprox */,
+                                                    bool /* bIsNoDataNan */ )
+{
+    return tVal == tNoData;
+}
+
+template<class T> static inline bool IsNoDataFloatValue( T tVal, T tNoData,
+                                                         bool bApprox,
+                                                         bool bIsNoDataNan )
+{
+    if( !bApprox )
+        return tVal == tNoData;
+    if( bIsNoDataNan )
+        return CPLIsNan(tVal);
+    return ARE_REAL_EQUAL(tVal, tNoData);
+}
+
+static inline bool IsNoDataValue( float fVal, float fNoData,
+                                  bool bApprox, bool bIsNoDataNan )
+{
+    return IsNoDataFloatValue(fVal, fNoData, bApprox, bIsNoDataNan);
+}
+
+static inline bool IsNoDataValue( double dfVal, double dfNoData,
+                                  bool bApprox, bool bIsNoDataNan )
+{
+    return IsNoDataFloatValue(dfVal, dfNoData, bApprox, bIsNoDataNan);
+}
+
+/************************************************************************/
+/*                          NoDataMaskSIMD()                            */
+/*                                                                      */
+/*      Compute the mask of the first values of a line with SSE2, or    */
+/*      AVX2 when available at build time. Return the number of values  */
+/*      processed, the remaining ones being left to the scalar code.    */
+/************************************************************************/
+
+template<class T> static size_t NoDataMaskSIMD( const T*, size_t, T,
+                                                bool, bool, bool, GByte* )
+{
+    return 0;
+}
+
+#ifdef HAVE_SSE2_NODATA_MASK
+
+// Store 0 for nodata values, whose comparison mask is all ones, and 255
+// for the others. With bAccumulate, combine with the previous mask so that
+// only values that are nodata in all the compared buffers get 0.
+static inline void StoreMask16( GByte* pabyMask, __m128i xmmEqual,
+                                bool bAccumulate )
+{
+    __m128i xmmMask = _mm_andnot_si128(xmmEqual, _mm_set1_epi8(-1));
+    if( bAccumulate )
+        xmmMask = _mm_or_si128(xmmMask, _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(pabyMask)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pabyMask), xmmMask);
+}
+
+// Pack four masks of 32 bit values into a mask of 16 bytes.
+static inline __m128i PackMask32( __m128i xmm0, __m128i xmm1,
+                                  __m128i xmm2, __m128i xmm3 )
+{
+    return _mm_packs_epi16(_mm_packs_epi32(xmm0, xmm1),
+                           _mm_packs_epi32(xmm2, xmm3));
+}
+
+#ifdef __AVX2__
+static inline void StoreMask32( GByte* pabyMask, __m256i ymmEqual,
+                                bool bAccumulate )
+{
+    __m256i ymmMask = _mm256_andnot_si256(ymmEqual, _mm256_set1_epi8(-1));
+    if( bAccumulate )
+        ymmMask = _mm256_or_si256(ymmMask, _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(pabyMask)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pabyMask), ymmMask);
+}
+
+// The AVX2 pack instructions work within 128 bit lanes, hence the
+// permutations restoring the order of the values.
+static inline __m256i PackMask32( __m256i ymm0, __m256i ymm1,
+                                  __m256i ymm2, __m256i ymm3 )
+{
+    return _mm256_permutevar8x32_epi32(
+        _mm256_packs_epi16(_mm256_packs_epi32(ymm0, ymm1),
+                           _mm256_packs_epi32(ymm2, ymm3)),
+        _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+#endif
+
+static size_t NoDataMaskSIMD( const GByte* pabySrc, size_t nCount,
+                              GByte byNoData, bool, bool, bool bAccumulate,
+                              GByte* pabyMask )
+{
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256i ymmNoData = _mm256_set1_epi8(static_cast<char>(byNoData));
+    for( ; i + 32 <= nCount; i += 32 )
+    {
+        const __m256i ymmVal = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(pabySrc + i));
+        StoreMask32(pabyMask + i, _mm256_cmpeq_epi8(ymmVal, ymmNoData),
+                    bAccumulate);
+    }
+#endif
+    const __m128i xmmNoData = _mm_set1_epi8(static_cast<char>(byNoData));
+    for( ; i + 16 <= nCount; i += 16 )
+    {
+        const __m128i xmmVal = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pabySrc + i));
+        StoreMask16(pabyMask + i, _mm_cmpeq_epi8(xmmVal, xmmNoData),
+                    bAccumulate);
+    }
+    return i;
+}
+
+static size_t NoDataMask16BitSIMD( const void* pSrc, size_t nCount,
+                                   GUInt16 nNoData, bool bAccumulate,
+                                   GByte* pabyMask )
+{
+    const GUInt16* panSrc = static_cast<const GUInt16*>(pSrc);
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256i ymmNoData = _mm256_set1_epi16(static_cast<short>(nNoData));
+    for( ; i + 32 <= nCount; i += 32 )
+    {
+        const __m256i ymm0 = _mm256_cmpeq_epi16(ymmNoData,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(panSrc + i)));
+        const __m256i ymm1 = _mm256_cmpeq_epi16(ymmNoData,
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(panSrc + i + 16)));
+        StoreMask32(pabyMask + i,
+                    _mm256_permute4x64_epi64(_mm256_packs_epi16(ymm0, ymm1),
+                                             _MM_SHUFFLE(3, 1, 2, 0)),
+                    bAccumulate);
+    }
+#endif
+    const __m128i xmmNoData = _mm_set1_epi16(static_cast<short>(nNoData));
+    for( ; i + 16 <= nCount; i += 16 )
+    {
+        const __m128i xmm0 = _mm_cmpeq_epi16(xmmNoData,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(panSrc + i)));
+        const __m128i xmm1 = _mm_cmpeq_epi16(xmmNoData,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(panSrc + i + 8)));
+        StoreMask16(pabyMask + i, _mm_packs_epi16(xmm0, xmm1), bAccumulate);
+    }
+    return i;
+}
+
+static size_t NoDataMaskSIMD( const GUInt16* panSrc, size_t nCount,
+                              GUInt16 nNoData, bool, bool, bool bAccumulate,
+                              GByte* pabyMask )
+{
+    return NoDataMask16BitSIMD(panSrc, nCount, nNoData, bAccumulate,
+                               pabyMask);
+}
+
+static size_t NoDataMaskSIMD( const GInt16* panSrc, size_t nCount,
+                              GInt16 nNoData, bool, bool, bool bAccumulate,
+                              GByte* pabyMask )
+{
+    return NoDataMask16BitSIMD(panSrc, nCount,
+                               static_cast<GUInt16>(nNoData), bAccumulate,
+                               pabyMask);
+}
+
+static size_t NoDataMask32BitSIMD( const void* pSrc, size_t nCount,
+                                   GUInt32 nNoData, bool bAccumulate,
+                                   GByte* pabyMask )
+{
+    const GUInt32* panSrc = static_cast<const GUInt32*>(pSrc);
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256i ymmNoData = _mm256_set1_epi32(static_cast<int>(nNoData));
+    for( ; i + 32 <= nCount; i += 32 )
+    {
+        __m256i aymm[4];
+        for( int j = 0; j < 4; j++ )
+        {
+            aymm[j] = _mm256_cmpeq_epi32(ymmNoData, _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(panSrc + i + j * 8)));
+        }
+        StoreMask32(pabyMask + i,
+                    PackMask32(aymm[0], aymm[1], aymm[2], aymm[3]),
+                    bAccumulate);
+    }
+#endif
+    const __m128i xmmNoData = _mm_set1_epi32(static_cast<int>(nNoData));
+    for( ; i + 16 <= nCount; i += 16 )
+    {
+        __m128i axmm[4];
+        for( int j = 0; j < 4; j++ )
+        {
+            axmm[j] = _mm_cmpeq_epi32(xmmNoData, _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(panSrc + i + j * 4)));
+        }
+        StoreMask16(pabyMask + i,
+                    PackMask32(axmm[0], axmm[1], axmm[2], axmm[3]),
+                    bAccumulate);
+    }
+    return i;
+}
+
+static size_t NoDataMaskSIMD( const GUInt32* panSrc, size_t nCount,
+                              GUInt32 nNoData, bool, bool, bool bAccumulate,
+                              GByte* pabyMask )
+{
+    return NoDataMask32BitSIMD(panSrc, nCount, nNoData, bAccumulate,
+                               pabyMask);
+}
+
+static size_t NoDataMaskSIMD( const GInt32* panSrc, size_t nCount,
+                              GInt32 nNoData, bool, bool, bool bAccumulate,
+                              GByte* pabyMask )
+{
+    return NoDataMask32BitSIMD(panSrc, nCount,
+                               static_cast<GUInt32>(nNoData), bAccumulate,
+                               pabyMask);
+}
+
+// Vector versions of IsNoDataValue(). The tolerance of ARE_REAL_EQUAL() is
+// computed in the same order, so that the results are identical.
+static inline __m128 EqualMask( __m128 xmmVal, __m128 xmmNoData,
+                                bool bApprox, bool bIsNoDataNan )
+{
+    if( bApprox && bIsNoDataNan )
+        return _mm_cmpunord_ps(xmmVal, xmmVal);
+    __m128 xmmEqual = _mm_cmpeq_ps(xmmVal, xmmNoData);
+    if( bApprox )
+    {
+        const __m128 xmmAbsMask =
+            _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 xmmDiff =
+            _mm_and_ps(_mm_sub_ps(xmmVal, xmmNoData), xmmAbsMask);
+        const __m128 xmmTolerance = _mm_mul_ps(
+            _mm_mul_ps(_mm_set1_ps(std::numeric_limits<float>::epsilon()),
+                       _mm_and_ps(_mm_add_ps(xmmVal, xmmNoData),
+                                  xmmAbsMask)),
+            _mm_set1_ps(2.0f));
+        xmmEqual = _mm_or_ps(xmmEqual, _mm_cmplt_ps(xmmDiff, xmmTolerance));
+    }
+    return xmmEqual;
+}
+
+static inline __m128d EqualMask( __m128d xmmVal, __m128d xmmNoData,
+                                 bool bApprox, bool bIsNoDataNan )
+{
+    if( bApprox && bIsNoDataNan )
+        return _mm_cmpunord_pd(xmmVal, xmmVal);
+    __m128d xmmEqual = _mm_cmpeq_pd(xmmVal, xmmNoData);
+    if( bApprox )
+    {
+        const __m128d xmmAbsMask = _mm_castsi128_pd(
+            _mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+        const __m128d xmmDiff =
+            _mm_and_pd(_mm_sub_pd(xmmVal, xmmNoData), xmmAbsMask);
+        const __m128d xmmTolerance = _mm_mul_pd(
+            _mm_mul_pd(_mm_set1_pd(std::numeric_limits<float>::epsilon()),
+                       _mm_and_pd(_mm_add_pd(xmmVal, xmmNoData),
+                                  xmmAbsMask)),
+            _mm_set1_pd(2.0));
+        xmmEqual = _mm_or_pd(xmmEqual, _mm_cmplt_pd(xmmDiff, xmmTolerance));
+    }
+    return xmmEqual;
+}
+
+#ifdef __AVX2__
+static inline __m256 EqualMask( __m256 ymmVal, __m256 ymmNoData,
+                                bool bApprox, bool bIsNoDataNan )
+{
+    if( bApprox && bIsNoDataNan )
+        return _mm256_cmp_ps(ymmVal, ymmVal, _CMP_UNORD_Q);
+    __m256 ymmEqual = _mm256_cmp_ps(ymmVal, ymmNoData, _CMP_EQ_OQ);
+    if( bApprox )
+    {
+        const __m256 ymmAbsMask =
+            _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        const __m256 ymmDiff =
+            _mm256_and_ps(_mm256_sub_ps(ymmVal, ymmNoData), ymmAbsMask);
+        const __m256 ymmTolerance = _mm256_mul_ps(
+            _mm256_mul_ps(
+                _mm256_set1_ps(std::numeric_limits<float>::epsilon()),
+                _mm256_and_ps(_mm256_add_ps(ymmVal, ymmNoData),
+                              ymmAbsMask)),
+            _mm256_set1_ps(2.0f));
+        ymmEqual = _mm256_or_ps(ymmEqual,
+                        _mm256_cmp_ps(ymmDiff, ymmTolerance, _CMP_LT_OQ));
+    }
+    return ymmEqual;
+}
+#endif
+
+static size_t NoDataMaskSIMD( const float* pafSrc, size_t nCount,
+                              float fNoData, bool bApprox, bool bIsNoDataNan,
+                              bool bAccumulate, GByte* pabyMask )
+{
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256 ymmNoData = _mm256_set1_ps(fNoData);
+    for( ; i + 32 <= nCount; i += 32 )
+    {
+        __m256i aymm[4];
+        for( int j = 0; j < 4; j++ )
+        {
+            aymm[j] = _mm256_castps_si256(EqualMask(
+                _mm256_loadu_ps(pafSrc + i + j * 8), ymmNoData,
+                bApprox, bIsNoDataNan));
+        }
+        StoreMask32(pabyMask + i,
+                    PackMask32(aymm[0], aymm[1], aymm[2], aymm[3]),
+                    bAccumulate);
+    }
+#endif
+    const __m128 xmmNoData = _mm_set1_ps(fNoData);
+    for( ; i + 16 <= nCount; i += 16 )
+    {
+        __m128i axmm[4];
+        for( int j = 0; j < 4; j++ )
+        {
+            axmm[j] = _mm_castps_si128(EqualMask(
+                _mm_loadu_ps(pafSrc + i + j * 4), xmmNoData,
+                bApprox, bIsNoDataNan));
+        }
+        StoreMask16(pabyMask + i,
+                    PackMask32(axmm[0], axmm[1], axmm[2], axmm[3]),
+                    bAccumulate);
+    }
+    return i;
+}
+
+static size_t NoDataMaskSIMD( const double* padfSrc, size_t nCount,
+                              double dfNoData, bool bApprox,
+                              bool bIsNoDataNan, bool bAccumulate,
+                              GByte* pabyMask )
+{
+    const __m128d xmmNoData = _mm_set1_pd(dfNoData);
+    size_t i = 0;
+    for( ; i + 16 <= nCount; i += 16 )
+    {
+        // Each pair of 64 bit masks is narrowed to four 32 bit masks.
+        __m128i axmm[4];
+        for( int j = 0; j < 4; j++ )
+        {
+            const __m128d xmm0 = EqualMask(
+                _mm_loadu_pd(padfSrc + i + j * 4), xmmNoData,
+                bApprox, bIsNoDataNan);
+            const __m128d xmm1 = EqualMask(
+                _mm_loadu_pd(padfSrc + i + j * 4 + 2), xmmNoData,
+                bApprox, bIsNoDataNan);
+            axmm[j] = _mm_castps_si128(
+                _mm_shuffle_ps(_mm_castpd_ps(xmm0), _mm_castpd_ps(xmm1),
+                               _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+        StoreMask16(pabyMask + i,
+                    PackMask32(axmm[0], axmm[1], axmm[2], axmm[3]),
+                    bAccumulate);
+    }
+    return i;
+}
+
+#endif // HAVE_SSE2_NODATA_MASK
+
+/************************************************************************/
+/*                          NoDataMaskLine()                            */
+/************************************************************************/
+
+template<class T> static void NoDataMaskLine( const void* pSrc, size_t nCount,
+                                              double dfNoDataValue,
+                                              bool bApprox, bool bAccumulate,
+                                              GByte* pabyMask )
+{
+    const T* paSrc = static_cast<const T*>(pSrc);
+    const T tNoData = static_cast<T>(dfNoDataValue);
+    const bool bIsNoDataNan = CPLIsNan(dfNoDataValue) != 0;
+
+    size_t i = NoDataMaskSIMD(paSrc, nCount, tNoData, bApprox, bIsNoDataNan,
+                              bAccumulate, pabyMask);
+    for( ; i < nCount; ++i )
+    {
+        const GByte byMask =
+            IsNoDataValue(paSrc[i], tNoData, bApprox, bIsNoDataNan) ? 0 : 255;
+        pabyMask[i] = bAccumulate ? static_cast<GByte>(pabyMask[i] | byMask)
+                                  : byMask;
+    }
+}
+
+/************************************************************************/
+/*                         GDALNoDataMaskLine()                         */
+/*                                                                      */
+/*      Set pabyMask[i] to 0 if the i-th value of pSrc, of type eWrkDT, */
+/*      is the nodata value, and to 255 otherwise. With bAccumulate,    */
+/*      255 values of the mask are kept, so that calls on several       */
+/*      buffers only leave 0 for values that are nodata in all of them. */
+/*      bApprox selects the floating point comparisons of               */
+/*      GDALNoDataMaskBand, see IsNoDataValue(). The nodata value must  */
+/*      be in the range of eWrkDT. pSrc may be the same as pabyMask.    */
+/************************************************************************/
+
+void GDALNoDataMaskLine( const void* pSrc, GDALDataType eWrkDT, size_t nCount,
+                         double dfNoDataValue, bool bApprox, bool bAccumulate,
+                         GByte* pabyMask )
+{
+    switch( eWrkDT )
+    {
+        case GDT_Byte:
+            NoDataMaskLine<GByte>(pSrc, nCount, dfNoDataValue,
+                                  bApprox, bAccumulate, pabyMask);
+            break;
+        case GDT_UInt16:
+            NoDataMaskLine<GUInt16>(pSrc, nCount, dfNoDataValue,
+                                    bApprox, bAccumulate, pabyMask);
+            break;
+        case GDT_Int16:
+            NoDataMaskLine<GInt16>(pSrc, nCount, dfNoDataValue,
+                                   bApprox, bAccumulate, pabyMask);
+            break;
+        case GDT_UInt32:
+            NoDataMaskLine<GUInt32>(pSrc, nCount, dfNoDataValue,
+                                    bApprox, bAccumulate, pabyMask);
+            break;
+        case GDT_Int32:
+            NoDataMaskLine<GInt32>(pSrc, nCount, dfNoDataValue,
+                                   bApprox, bAccumulate, pabyMask);
+            break;
+        case GDT_Float32:
+            NoDataMaskLine<float>(pSrc, nCount, dfNoDataValue,
+                                  bApprox, bAccumulate, pabyMask);
+            break;
+        case GDT_Float64:
+            NoDataMaskLine<double>(pSrc, nCount, dfNoDataValue,
+                                   bApprox, bAccumulate, pabyMask);
+            break;
+        default:
+            CPLAssert( false );
+            break;
+    }
+}
+
 /************************************************************************/
 /*                             IReadBlock()                             */
 /************************************************************************/
@@ -214,12 +688,14 @@ CPLErr GDALNoDataMaskBand::IRasterIO( GDALRWFlag eRWFlag,
         GByte* pabyData = static_cast<GByte*>( pData );
         const GByte byNoData = static_cast<GByte>( dfNoDataValue );
 
-        if( nPixelSpace == 1 && nLineSpace == nBufXSize )
+        if( nPixelSpace == 1 )
         {
-            const size_t nBufSize = static_cast<size_t>(nBufXSize) * nBufYSize;
-            for( size_t i = 0; i < nBufSize; ++i )
+            // The mask is computed in place.
+            for( int iY = 0; iY < nBufYSize; iY++ )
             {
-                pabyData[i] = pabyData[i] == byNoData ? 0 : 255;
+                GByte* pabyLine = pabyData + iY * nLineSpace;
+                GDALNoDataMaskLine( pabyLine, GDT_Byte, nBufXSize,
+                                    byNoData, true, false, pabyLine );
             }
         }
         else
@@ -246,10 +722,9 @@ CPLErr GDALNoDataMaskBand::IRasterIO( GDALRWFlag eRWFlag,
         {
             return GDALRasterBand::IRasterIO(
                                       eRWFlag, nXOff, nYOff, nXSize, nYSize,
-                                      pTemp, nBufXSize, nBufYSize,
-                                      eWrkDT,
-                                      nWrkDTSize, nBufXSize * nWrkDTSize,
-                                      psExtraArg );
+                                      pData, nBufXSize, nBufYSize,
+                                      eBufType,
+                                      nPixelSpace, nLineSpace, psExtraArg );
         }
 
         const CPLErr eErr =
@@ -263,104 +738,31 @@ CPLErr GDALNoDataMaskBand::IRasterIO( GDALRWFlag eRWFlag,
             return eErr;
         }
 
-        const bool bIsNoDataNan = CPLIsNan(dfNoDataValue) != 0;
-        GByte* pabyDest = static_cast<GByte*>(pData);
-
 /* -------------------------------------------------------------------- */
-/*      Process different cases.                                        */
+/*      Compute the mask directly in the output buffer if its lines     */
+/*      are contiguous, or line by line in a temporary one otherwise.   */
 /* -------------------------------------------------------------------- */
-        switch( eWrkDT )
+        GByte* pabyDest = static_cast<GByte*>(pData);
+        std::vector<GByte> abyLine;
+        if( nPixelSpace != 1 )
+            abyLine.resize(nBufXSize);
+        for( int iY = 0; iY < nBufYSize; iY++ )
         {
-            case GDT_UInt32:
-            {
-                const GUInt32 nNoData = static_cast<GUInt32>( dfNoDataValue );
-                const GUInt32* panSrc = static_cast<const GUInt32 *>(pTemp);
-
-                size_t i = 0;
-                for( int iY = 0; iY < nBufYSize; iY++ )
-                {
-                    GByte* pabyLineDest = pabyDest + iY * nLineSpace;
-                    for( int iX = 0; iX < nBufXSize; iX++ )
-                    {
-                        *pabyLineDest = panSrc[i] == nNoData ? 0 : 255;
-                        ++i;
-                        pabyLineDest += nPixelSpace;
-                    }
-                }
-            }
-            break;
-
-            case GDT_Int32:
-            {
-                const GInt32 nNoData = static_cast<GInt32>( dfNoDataValue );
-                const GInt32* panSrc = static_cast<const GInt32 *>(pTemp);
-
-                size_t i = 0;
-                for( int iY = 0; iY < nBufYSize; iY++ )
-                {
-                    GByte* pabyLineDest = pabyDest + iY * nLineSpace;
-                    for( int iX = 0; iX < nBufXSize; iX++ )
-                    {
-                        *pabyLineDest = panSrc[i] == nNoData ? 0 : 255;
-                        ++i;
-                        pabyLineDest += nPixelSpace;
-                    }
-                }
-            }
-            break;
-
-            case GDT_Float32:
+            GByte* pabyLineDest = pabyDest + iY * nLineSpace;
+            GDALNoDataMaskLine( static_cast<const GByte*>(pTemp) +
+                                    static_cast<size_t>(iY) * nBufXSize *
+                                    nWrkDTSize,
+                                eWrkDT, nBufXSize, dfNoDataValue, true, false,
+                                nPixelSpace == 1 ? pabyLineDest :
+                                                   abyLine.data() );
+            if( nPixelSpace != 1 )
             {
-                const float fNoData = static_cast<float>( dfNoDataValue );
-                const float* pafSrc = static_cast<const float *>(pTemp);
-
-                size_t i = 0;
-                for( int iY = 0; iY < nBufYSize; iY++ )
-                {
-                    GByte* pabyLineDest = pabyDest + iY * nLineSpace;
-                    for( int iX = 0; iX < nBufXSize; iX++ )
-                    {
-                        const float fVal = pafSrc[i];
-                        if( bIsNoDataNan && CPLIsNan(fVal))
-                            *pabyLineDest = 0;
-                        else if( ARE_REAL_EQUAL(fVal, fNoData) )
-                            *pabyLineDest = 0;
-                        else
-                            *pabyLineDest = 255;
-                        ++i;
-                        pabyLineDest += nPixelSpace;
-                    }
-                }
-            }
-            break;
-
-            case GDT_Float64:
-            {
-                const double* padfSrc = static_cast<const double *>(pTemp);
-
-                size_t i = 0;
-                for( int iY = 0; iY < nBufYSize; iY++ )
+                for( int iX = 0; iX < nBufXSize; iX++ )
                 {
-                    GByte* pabyLineDest = pabyDest + iY * nLineSpace;
-                    for( int iX = 0; iX < nBufXSize; iX++ )
-                    {
-                        const double dfVal = padfSrc[i];
-                        if( bIsNoDataNan && CPLIsNan(dfVal))
-                            *pabyLineDest = 0;
-                        else if( ARE_REAL_EQUAL(dfVal, dfNoDataValue) )
-                            *pabyLineDest = 0;
-                        else
-                            *pabyLineDest = 255;
-                        ++i;
-                        pabyLineDest += nPixelSpace;
-                    }
+                    *pabyLineDest = abyLine[iX];
+                    pabyLineDest += nPixelSpace;
                 }
             }
-            break;
-
-            default:
-                CPLAssert( false );
-                break;
         }
 
         VSIFree(pTemp);
@@ -32,6 +32,7 @@
 #include "cpl_port.h"
 #include "gdal_priv.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "cpl_conv.h"
@@ -39,6 +40,7 @@
 #include "cpl_string.h"
 #include "cpl_vsi.h"
 #include "gdal.h"
+#include "gdal_priv_templates.hpp"
 
 CPL_CVSID("$Id: gdalnodatavaluesmaskband.cpp 003ad4e9e410423af8b35843956f781e44a8daac 2019-02-18 15:48:35 +0100 Even Rouault $")
 
@@ -84,63 +86,30 @@ GDALNoDataValuesMaskBand::~GDALNoDataValuesMaskBand()
 }
 
 /************************************************************************/
-/*                            FillOutBuffer()                           */
+/*                          GetWorkDataType()                           */
 /************************************************************************/
 
-template<class T> static void FillOutBuffer(GPtrDiff_t nBlockOffsetPixels,
-                                            int nBands,
-                                            const void* pabySrc,
-                                            const double* padfNodataValues,
-                                            void* pImage)
-{
-    T* paNoData = static_cast<T*>(
-        CPLMalloc(nBands * sizeof(T)) );
-    for( int iBand = 0; iBand < nBands; ++iBand )
-    {
-        paNoData[iBand] = static_cast<T>(padfNodataValues[iBand]);
-    }
-
-    for( GPtrDiff_t i = 0; i < nBlockOffsetPixels; i++ )
-    {
-        int nCountNoData = 0;
-        for( int iBand = 0; iBand < nBands; ++iBand )
-        {
-            if( static_cast<const T *>(pabySrc)[i + iBand * nBlockOffsetPixels] ==
-                paNoData[iBand] )
-                ++nCountNoData;
-        }
-        static_cast<GByte *>(pImage)[i] =
-            nCountNoData == nBands ? 0 : 255;
-    }
-
-    CPLFree(paNoData);
-}
-
-/************************************************************************/
-/*                             IReadBlock()                             */
-/************************************************************************/
-
-CPLErr GDALNoDataValuesMaskBand::IReadBlock( int nXBlockOff, int nYBlockOff,
-                                             void * pImage )
-
+static GDALDataType GetWorkDataType( GDALDataType eDataType )
 {
     GDALDataType eWrkDT = GDT_Unknown;
-
-/* -------------------------------------------------------------------- */
-/*      Decide on a working type.                                       */
-/* -------------------------------------------------------------------- */
-    switch( poDS->GetRasterBand(1)->GetRasterDataType() )
+    switch( eDataType )
     {
       case GDT_Byte:
         eWrkDT = GDT_Byte;
         break;
 
       case GDT_UInt16:
+        eWrkDT = GDT_UInt16;
+        break;
+
+      case GDT_Int16:
+        eWrkDT = GDT_Int16;
+        break;
+
       case GDT_UInt32:
         eWrkDT = GDT_UInt32;
         break;
 
-      case GDT_Int16:
       case GDT_Int32:
       case GDT_CInt16:
       case GDT_CInt32:
@@ -162,109 +131,198 @@ CPLErr GDALNoDataValuesMaskBand::IReadBlock( int nXBlockOff, int nYBlockOff,
         eWrkDT = GDT_Float64;
         break;
     }
+    return eWrkDT;
+}
 
-/* -------------------------------------------------------------------- */
-/*      Read the image data.                                            */
-/* -------------------------------------------------------------------- */
-    const int nBands = poDS->GetRasterCount();
-    GByte *pabySrc = static_cast<GByte *>(
-        VSI_MALLOC3_VERBOSE( nBands * GDALGetDataTypeSizeBytes(eWrkDT),
-                             nBlockXSize, nBlockYSize ) );
-    if (pabySrc == nullptr)
+/************************************************************************/
+/*                          CanBeNoDataValue()                          */
+/*                                                                      */
+/*      Whether a value of type eWrkDT can be equal to the nodata value */
+/*      once cast to that type. NaN is never equal to anything.         */
+/************************************************************************/
+
+static bool CanBeNoDataValue( double dfNoDataValue, GDALDataType eWrkDT )
+{
+    switch( eWrkDT )
     {
-        return CE_Failure;
+      case GDT_Byte:
+        return GDALIsValueInRange<GByte>(dfNoDataValue);
+      case GDT_UInt16:
+        return GDALIsValueInRange<GUInt16>(dfNoDataValue);
+      case GDT_Int16:
+        return GDALIsValueInRange<GInt16>(dfNoDataValue);
+      case GDT_UInt32:
+        return GDALIsValueInRange<GUInt32>(dfNoDataValue);
+      case GDT_Int32:
+        return GDALIsValueInRange<GInt32>(dfNoDataValue);
+      case GDT_Float32:
+        return !CPLIsNan(dfNoDataValue) &&
+               (CPLIsInf(dfNoDataValue) ||
+                GDALIsValueInRange<float>(dfNoDataValue));
+      default:
+        return !CPLIsNan(dfNoDataValue);
+    }
+}
+
+/************************************************************************/
+/*                             IReadBlock()                             */
+/************************************************************************/
+
+CPLErr GDALNoDataValuesMaskBand::IReadBlock( int nXBlockOff, int nYBlockOff,
+                                             void * pImage )
+
+{
+    const int nXOff = nXBlockOff * nBlockXSize;
+    const int nXSizeRequest = std::min(nBlockXSize, nRasterXSize - nXOff);
+    const int nYOff = nYBlockOff * nBlockYSize;
+    const int nYSizeRequest = std::min(nBlockYSize, nRasterYSize - nYOff);
+
+    if( nBlockXSize != nXSizeRequest || nBlockYSize != nYSizeRequest )
+    {
+        memset(pImage, 0, static_cast<GPtrDiff_t>(nBlockXSize) * nBlockYSize);
     }
 
-    int nXSizeRequest = nBlockXSize;
-    if (nXBlockOff * nBlockXSize + nBlockXSize > nRasterXSize)
-        nXSizeRequest = nRasterXSize - nXBlockOff * nBlockXSize;
-    int nYSizeRequest = nBlockYSize;
-    if (nYBlockOff * nBlockYSize + nBlockYSize > nRasterYSize)
-        nYSizeRequest = nRasterYSize - nYBlockOff * nBlockYSize;
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    return IRasterIO(GF_Read, nXOff, nYOff, nXSizeRequest, nYSizeRequest,
+                     pImage, nXSizeRequest, nYSizeRequest,
+                     GDT_Byte, 1, nBlockXSize, &sExtraArg);
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
 
-    if (nXSizeRequest != nBlockXSize || nYSizeRequest != nBlockYSize)
+CPLErr GDALNoDataValuesMaskBand::IRasterIO( GDALRWFlag eRWFlag,
+                                            int nXOff, int nYOff,
+                                            int nXSize, int nYSize,
+                                            void * pData,
+                                            int nBufXSize, int nBufYSize,
+                                            GDALDataType eBufType,
+                                            GSpacing nPixelSpace,
+                                            GSpacing nLineSpace,
+                                            GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag != GF_Read )
     {
-        // memset the whole buffer to avoid Valgrind warnings in case we can't
-        // fetch a full block.
-        memset( pabySrc, 0,
-                nBands * GDALGetDataTypeSizeBytes(eWrkDT) *
-                nBlockXSize * nBlockYSize );
+        return CE_Failure;
     }
 
-    const GPtrDiff_t nBlockOffsetPixels = static_cast<GPtrDiff_t>(nBlockXSize) * nBlockYSize;
-    const GPtrDiff_t nBandOffsetByte =
-        GDALGetDataTypeSizeBytes(eWrkDT) * nBlockOffsetPixels;
-    for( int iBand = 0; iBand < nBands; ++iBand )
+    // Resampling the mask is not the same as computing the mask of the
+    // resampled bands, so leave other cases to the block based
+    // implementation.
+    const bool bResampling =
+        (nBufXSize != nXSize || nBufYSize != nYSize) &&
+        psExtraArg != nullptr &&
+        psExtraArg->eResampleAlg != GRIORA_NearestNeighbour;
+    if( eBufType != GDT_Byte || bResampling )
     {
-        const CPLErr eErr =
-            poDS->GetRasterBand(iBand + 1)->RasterIO(
-                GF_Read,
-                nXBlockOff * nBlockXSize,
-                nYBlockOff * nBlockYSize,
-                nXSizeRequest,
-                nYSizeRequest,
-                pabySrc + iBand * nBandOffsetByte,
-                nXSizeRequest,
-                nYSizeRequest,
-                eWrkDT, 0,
-                static_cast<GSpacing>(nBlockXSize) * GDALGetDataTypeSizeBytes(eWrkDT),
-                nullptr );
-        if( eErr != CE_None )
-            return eErr;
+        return GDALRasterBand::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                          pData, nBufXSize, nBufYSize,
+                                          eBufType,
+                                          nPixelSpace, nLineSpace, psExtraArg );
     }
 
+    GByte* pabyDest = static_cast<GByte*>(pData);
+    const GDALDataType eWrkDT =
+        GetWorkDataType( poDS->GetRasterBand(1)->GetRasterDataType() );
+    const int nBands = poDS->GetRasterCount();
+
 /* -------------------------------------------------------------------- */
-/*      Process different cases.                                        */
+/*      A pixel is masked only if all its bands are at their nodata     */
+/*      value, so none is if one of the values cannot be matched.       */
 /* -------------------------------------------------------------------- */
-    switch( eWrkDT )
+    for( int iBand = 0; iBand < nBands; ++iBand )
     {
-      case GDT_Byte:
-      {
-          FillOutBuffer<GByte> (nBlockOffsetPixels, nBands,
-                                pabySrc, padfNodataValues,
-                                pImage);
-      }
-      break;
+        if( !CanBeNoDataValue(padfNodataValues[iBand], eWrkDT) )
+        {
+            for( int iY = 0; iY < nBufYSize; iY++ )
+            {
+                GByte* pabyLineDest = pabyDest + iY * nLineSpace;
+                for( int iX = 0; iX < nBufXSize; iX++ )
+                {
+                    *pabyLineDest = 255;
+                    pabyLineDest += nPixelSpace;
+                }
+            }
+            return CE_None;
+        }
+    }
 
-      case GDT_UInt32:
-      {
-          FillOutBuffer<GUInt32>(nBlockOffsetPixels, nBands,
-                                 pabySrc, padfNodataValues,
-                                 pImage);
-      }
-      break;
+/* -------------------------------------------------------------------- */
+/*      Read the bands one at a time, and accumulate their masks in     */
+/*      the output buffer if its lines are contiguous, or in a          */
+/*      temporary one otherwise.                                        */
+/* -------------------------------------------------------------------- */
+    const int nWrkDTSize = GDALGetDataTypeSizeBytes(eWrkDT);
+    void *pTemp = VSI_MALLOC3_VERBOSE( nWrkDTSize, nBufXSize, nBufYSize );
+    if( pTemp == nullptr )
+    {
+        return CE_Failure;
+    }
 
-      case GDT_Int32:
-      {
-          FillOutBuffer<GInt32>(nBlockOffsetPixels, nBands,
-                                pabySrc, padfNodataValues,
-                                pImage);
-      }
-      break;
+    GByte* pabyMask = pabyDest;
+    GSpacing nMaskLineSpace = nLineSpace;
+    if( nPixelSpace != 1 )
+    {
+        pabyMask = static_cast<GByte *>(
+            VSI_MALLOC2_VERBOSE( nBufXSize, nBufYSize ));
+        if( pabyMask == nullptr )
+        {
+            VSIFree(pTemp);
+            return CE_Failure;
+        }
+        nMaskLineSpace = nBufXSize;
+    }
 
-      case GDT_Float32:
-      {
-          FillOutBuffer<float> (nBlockOffsetPixels, nBands,
-                                pabySrc, padfNodataValues,
-                                pImage);
-      }
-      break;
+    CPLErr eErr = CE_None;
+    for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
+    {
+        eErr = poDS->GetRasterBand(iBand + 1)->RasterIO(
+                GF_Read, nXOff, nYOff, nXSize, nYSize,
+                pTemp, nBufXSize, nBufYSize,
+                eWrkDT, nWrkDTSize,
+                static_cast<GSpacing>(nBufXSize) * nWrkDTSize,
+                psExtraArg );
+        if( eErr != CE_None )
+            break;
 
-      case GDT_Float64:
-      {
-          FillOutBuffer<double>(nBlockOffsetPixels, nBands,
-                                pabySrc, padfNodataValues,
-                                pImage);
-      }
-      break;
+        bool bHasNoData = false;
+        for( int iY = 0; iY < nBufYSize; iY++ )
+        {
+            GByte* pabyLineMask = pabyMask + iY * nMaskLineSpace;
+            GDALNoDataMaskLine( static_cast<const GByte*>(pTemp) +
+                                    static_cast<size_t>(iY) * nBufXSize *
+                                    nWrkDTSize,
+                                eWrkDT, nBufXSize, padfNodataValues[iBand],
+                                false, iBand > 0, pabyLineMask );
+            if( !bHasNoData )
+                bHasNoData = memchr(pabyLineMask, 0, nBufXSize) != nullptr;
+        }
 
-      default:
-        CPLAssert( false );
-        break;
+        // The next bands cannot mask pixels that are already valid.
+        if( !bHasNoData )
+            break;
     }
 
-    CPLFree( pabySrc );
+    if( eErr == CE_None && pabyMask != pabyDest )
+    {
+        for( int iY = 0; iY < nBufYSize; iY++ )
+        {
+            const GByte* pabyLineMask =
+                pabyMask + static_cast<size_t>(iY) * nBufXSize;
+            GByte* pabyLineDest = pabyDest + iY * nLineSpace;
+            for( int iX = 0; iX < nBufXSize; iX++ )
+            {
+                *pabyLineDest = pabyLineMask[iX];
+                pabyLineDest += nPixelSpace;
+            }
+        }
+    }
 
-    return CE_None;
+    if( pabyMask != pabyDest )
+        VSIFree(pabyMask);
+    VSIFree(pTemp);
+    return eErr;
 }
 //! @endcond
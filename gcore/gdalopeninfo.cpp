@@ -404,7 +404,7 @@ char** GDALOpenInfo::GetSiblingFiles()
     CPLString osDir = CPLGetDirname( pszFilename );
     const int nMaxFiles =
         atoi(CPLGetConfigOption("GDAL_READDIR_LIMIT_ON_OPEN", "1000"));
-    papszSiblingFiles = VSIReadDirEx( osDir, nMaxFiles );
+    papszSiblingFiles = VSIReadDirCached( osDir, nMaxFiles );
     if( nMaxFiles > 0 && CSLCount(papszSiblingFiles) > nMaxFiles )
     {
         CPLDebug("GDAL", "GDAL_READDIR_LIMIT_ON_OPEN reached on %s",
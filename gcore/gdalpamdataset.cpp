@@ -664,6 +664,38 @@ int GDALPamDataset::IsPamFilenameAPotentialSiblingFile()
     return bIsSiblingPamFile;
 }
 
+/************************************************************************/
+/*                           GetPamStoreKey()                           */
+/*                                                                      */
+/*      Key of a dataset in the PAM store: its absolute physical        */
+/*      filename, followed by its subdataset name if any.               */
+/************************************************************************/
+
+static CPLString GetPamStoreKey( const GDALDatasetPamInfo* psPam,
+                                 const char* pszDescription )
+{
+    CPLString osKey = psPam->osPhysicalFilename;
+    if( osKey.empty() && pszDescription != nullptr )
+        osKey = pszDescription;
+    if( osKey.empty() )
+        return osKey;
+
+    if( CPLIsFilenameRelative(osKey) && !STARTS_WITH(osKey, "/vsi") )
+    {
+        char *pszCurDir = CPLGetCurrentDir();
+        if( pszCurDir != nullptr )
+            osKey = CPLFormFilename(pszCurDir, osKey, nullptr);
+        CPLFree(pszCurDir);
+    }
+
+    if( !psPam->osSubdatasetName.empty() )
+    {
+        osKey += '\n';
+        osKey += psPam->osSubdatasetName;
+    }
+    return osKey;
+}
+
 /************************************************************************/
 /*                             TryLoadXML()                             */
 /************************************************************************/
@@ -683,6 +715,31 @@ CPLErr GDALPamDataset::TryLoadXML(char **papszSiblingFiles)
 /* -------------------------------------------------------------------- */
     nPamFlags &= ~GPF_DIRTY;
 
+/* -------------------------------------------------------------------- */
+/*      With a PAM store, its entries have precedence over .aux.xml     */
+/*      files.                                                          */
+/* -------------------------------------------------------------------- */
+    if( PamStoreIsEnabled() )
+    {
+        const CPLString osKey = GetPamStoreKey( psPam, GetDescription() );
+        int bFound = FALSE;
+        CPLXMLNode *psTree =
+            osKey.empty() ? nullptr : PamStoreLoad( osKey, &bFound );
+        if( bFound )
+        {
+            if( psTree == nullptr )
+                return TryLoadAux(papszSiblingFiles);
+
+            const CPLString osVRTPath(
+                CPLGetPath(osKey.substr(0, osKey.find('\n')).c_str()));
+            const CPLErr eErr = XMLInit( psTree, osVRTPath );
+            CPLDestroyXMLNode( psTree );
+            if( eErr != CE_None )
+                PamClear();
+            return eErr;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Try reading the file.                                           */
 /* -------------------------------------------------------------------- */
@@ -701,6 +758,16 @@ CPLErr GDALPamDataset::TryLoadXML(char **papszSiblingFiles)
     int nLastErrNo = CPLGetLastErrorNo();
     CPLString osLastErrorMsg = CPLGetLastErrorMsg();
 
+    // Without a siblings list, use the directory listing if it is cached.
+    CPLStringList aosCachedSiblingFiles;
+    if( papszSiblingFiles == nullptr && IsPamFilenameAPotentialSiblingFile() )
+    {
+        aosCachedSiblingFiles.Assign( VSIGetCachedDirListing(
+                                CPLGetDirname(psPam->pszPamFilename)), TRUE );
+        if( !aosCachedSiblingFiles.empty() )
+            papszSiblingFiles = aosCachedSiblingFiles.List();
+    }
+
     if (papszSiblingFiles != nullptr && IsPamFilenameAPotentialSiblingFile())
     {
         const int iSibling =
@@ -793,6 +860,23 @@ CPLErr GDALPamDataset::TrySaveXML()
     if( psPam == nullptr || (nPamFlags & GPF_NOSAVE) )
         return CE_None;
 
+/* -------------------------------------------------------------------- */
+/*      With a PAM store, queue the tree for writing there. A NULL      */
+/*      tree records that the dataset has no PAM information anymore,   */
+/*      so that a stale .aux.xml file is not read instead.              */
+/* -------------------------------------------------------------------- */
+    if( PamStoreIsEnabled() )
+    {
+        const CPLString osKey = GetPamStoreKey( psPam, GetDescription() );
+        if( !osKey.empty() )
+        {
+            CPLXMLNode *psTree = SerializeToXML( nullptr );
+            PamStoreSave( osKey, psTree );
+            CPLDestroyXMLNode( psTree );
+            return CE_None;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Make sure we know the filename we want to store in.             */
 /* -------------------------------------------------------------------- */
@@ -5,6 +5,8 @@
  *           The proxy db is used to associate .aux.xml files in a temp
  *           directory - used for files for which aux.xml files can't be
  *           created (i.e. read-only file systems).
+ *           Also implements the PAM store, a single indexed file holding
+ *           the PAM XML of many datasets.
  * Author:   Frank Warmerdam, warmerdam@pobox.com
  *
  ******************************************************************************
@@ -41,8 +43,12 @@
 #  include <fcntl.h>
 #endif
 
+#include <algorithm>
+#include <ctime>
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cpl_conv.h"
@@ -321,6 +327,8 @@ static void InitProxyDB()
 void PamCleanProxyDB()
 
 {
+    PamCleanStore();
+
     {
         CPLMutexHolderD( &hProxyDBLock );
 
@@ -434,3 +442,569 @@ const char *PamAllocateProxy( const char *pszOriginal )
 
     return PamGetProxy( pszOriginal );
 }
+
+/************************************************************************/
+/* ==================================================================== */
+/*                             GDALPamStore                             */
+/* ==================================================================== */
+/*                                                                      */
+/*      With the GDAL_PAM_STORE configuration option set to a file      */
+/*      name, the PAM XML of datasets is kept in that single file       */
+/*      rather than in .aux.xml side car files, which avoids a stat     */
+/*      and a small write per dataset on shared file systems.           */
+/*                                                                      */
+/*      The file is a header followed by a log of records, appended     */
+/*      under a lock file. A record is a key, the physical filename of  */
+/*      a dataset and its subdataset name, and the serialized XML of    */
+/*      its PAM information, an empty document recording a deletion.    */
+/*      An index of the latest record of each key is built on first     */
+/*      access, and extended with the records appended by other         */
+/*      processes. Writes are queued, and appended by batches of        */
+/*      GDAL_PAM_STORE_BATCH_SIZE (100 by default) datasets, or after   */
+/*      GDAL_PAM_STORE_FLUSH_DELAY seconds (10 by default), and at      */
+/*      GDALDestroyDriverManager(). The file is rewritten without the   */
+/*      superseded records when they take more than half of it.         */
+/************************************************************************/
+
+namespace {
+
+constexpr char szPamStoreMagic[] = "GDALPAMSTORE0001";
+constexpr size_t nPamStoreMagicSize = sizeof(szPamStoreMagic) - 1;
+// Magic and uint32 generation, incremented when the file is rewritten.
+constexpr size_t nPamStoreHeaderSize = nPamStoreMagicSize + 4;
+// "PAMR", uint32 key length, uint32 XML length.
+constexpr size_t nPamStoreRecordHeaderSize = 12;
+constexpr GUInt32 nPamStoreMaxKeySize = 64 * 1024;
+constexpr GUInt32 nPamStoreMaxXMLSize = 256 * 1024 * 1024;
+constexpr vsi_l_offset nPamStoreMinCompactSize = 1024 * 1024;
+
+class GDALPamStore
+{
+    struct Entry
+    {
+        vsi_l_offset nXMLOffset = 0;
+        GUInt32      nXMLSize = 0;
+        GUInt32      nRecordSize = 0;
+    };
+
+    CPLString   m_osFilename{};
+    int         m_nBatchSize = 100;
+    double      m_dfFlushDelay = 10.0;
+
+    std::unordered_map<std::string, Entry> m_oIndex{};
+    GUInt32     m_nGeneration = 0;
+    vsi_l_offset m_nIndexedSize = 0;  // 0 if nothing indexed yet
+    vsi_l_offset m_nDeadSize = 0;
+    VSILFILE   *m_fpRead = nullptr;
+
+    std::map<std::string, std::string> m_oPending{};
+    time_t      m_nFirstPendingTime = 0;
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALPamStore)
+
+    bool        Refresh( VSILFILE* fp, vsi_l_offset nFileSize );
+    bool        Compact( VSILFILE* fp );
+
+  public:
+    explicit GDALPamStore( const char* pszFilename );
+    ~GDALPamStore();
+
+    bool        Get( const std::string& osKey, std::string& osXML );
+    void        Put( const std::string& osKey, const std::string& osXML );
+    bool        Flush();
+};
+
+} // namespace
+
+static GDALPamStore *poPamStore = nullptr;
+static bool bPamStoreInitialized = false;
+static CPLMutex *hPamStoreLock = nullptr;
+
+/************************************************************************/
+/*                            GDALPamStore()                            */
+/************************************************************************/
+
+GDALPamStore::GDALPamStore( const char* pszFilename ) :
+    m_osFilename(pszFilename),
+    m_nBatchSize(std::max(1, atoi(
+        CPLGetConfigOption("GDAL_PAM_STORE_BATCH_SIZE", "100")))),
+    m_dfFlushDelay(CPLAtof(
+        CPLGetConfigOption("GDAL_PAM_STORE_FLUSH_DELAY", "10")))
+{
+}
+
+/************************************************************************/
+/*                           ~GDALPamStore()                            */
+/************************************************************************/
+
+GDALPamStore::~GDALPamStore()
+
+{
+    if( !Flush() )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Auxiliary information of %d datasets could not be "
+                  "saved in %s.",
+                  static_cast<int>(m_oPending.size()),
+                  m_osFilename.c_str() );
+    }
+    if( m_fpRead != nullptr )
+        CPL_IGNORE_RET_VAL(VSIFCloseL(m_fpRead));
+}
+
+/************************************************************************/
+/*                              Refresh()                               */
+/*                                                                      */
+/*      Index the records of fp that are not indexed yet, or all of     */
+/*      them if the file was rewritten since it was last read. Stops    */
+/*      at the first incomplete record, whose offset is then            */
+/*      m_nIndexedSize.                                                 */
+/************************************************************************/
+
+bool GDALPamStore::Refresh( VSILFILE* fp, vsi_l_offset nFileSize )
+
+{
+    GByte abyHeader[nPamStoreHeaderSize] = { 0 };
+    if( VSIFSeekL( fp, 0, SEEK_SET ) != 0 ||
+        VSIFReadL( abyHeader, 1, nPamStoreHeaderSize, fp ) !=
+                                                    nPamStoreHeaderSize ||
+        memcmp( abyHeader, szPamStoreMagic, nPamStoreMagicSize ) != 0 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "%s is not a GDAL PAM store.", m_osFilename.c_str() );
+        return false;
+    }
+
+    GUInt32 nGeneration = 0;
+    memcpy( &nGeneration, abyHeader + nPamStoreMagicSize, 4 );
+    CPL_LSBPTR32(&nGeneration);
+    if( m_nIndexedSize == 0 || nGeneration != m_nGeneration ||
+        nFileSize < m_nIndexedSize )
+    {
+        m_oIndex.clear();
+        m_nGeneration = nGeneration;
+        m_nIndexedSize = nPamStoreHeaderSize;
+        m_nDeadSize = 0;
+    }
+
+    std::string osKey;
+    vsi_l_offset nOffset = m_nIndexedSize;
+    while( nOffset + nPamStoreRecordHeaderSize <= nFileSize )
+    {
+        GByte abyRecord[nPamStoreRecordHeaderSize] = { 0 };
+        if( VSIFSeekL( fp, nOffset, SEEK_SET ) != 0 ||
+            VSIFReadL( abyRecord, 1, nPamStoreRecordHeaderSize, fp ) !=
+                                                nPamStoreRecordHeaderSize ||
+            memcmp( abyRecord, "PAMR", 4 ) != 0 )
+            break;
+
+        GUInt32 nKeySize = 0;
+        GUInt32 nXMLSize = 0;
+        memcpy( &nKeySize, abyRecord + 4, 4 );
+        CPL_LSBPTR32(&nKeySize);
+        memcpy( &nXMLSize, abyRecord + 8, 4 );
+        CPL_LSBPTR32(&nXMLSize);
+        if( nKeySize == 0 || nKeySize > nPamStoreMaxKeySize ||
+            nXMLSize > nPamStoreMaxXMLSize ||
+            nOffset + nPamStoreRecordHeaderSize + nKeySize + nXMLSize >
+                                                                nFileSize )
+            break;
+
+        osKey.resize( nKeySize );
+        if( VSIFReadL( &osKey[0], 1, nKeySize, fp ) != nKeySize )
+            break;
+
+        Entry& oEntry = m_oIndex[osKey];
+        m_nDeadSize += oEntry.nRecordSize;
+        oEntry.nXMLOffset = nOffset + nPamStoreRecordHeaderSize + nKeySize;
+        oEntry.nXMLSize = nXMLSize;
+        oEntry.nRecordSize = static_cast<GUInt32>(
+            nPamStoreRecordHeaderSize + nKeySize + nXMLSize);
+        nOffset += oEntry.nRecordSize;
+    }
+    m_nIndexedSize = nOffset;
+
+    return true;
+}
+
+/************************************************************************/
+/*                                Get()                                 */
+/*                                                                      */
+/*      Return false if the key has no record. An empty document is     */
+/*      returned for deleted entries.                                   */
+/************************************************************************/
+
+bool GDALPamStore::Get( const std::string& osKey, std::string& osXML )
+
+{
+    const auto oPendingIter = m_oPending.find(osKey);
+    if( oPendingIter != m_oPending.end() )
+    {
+        osXML = oPendingIter->second;
+        return true;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Index the records appended since the last access, by this or    */
+/*      another process.                                                */
+/* -------------------------------------------------------------------- */
+    VSIStatBufL sStat;
+    if( VSIStatL( m_osFilename, &sStat ) != 0 )
+        return false;
+
+    const vsi_l_offset nFileSize = static_cast<vsi_l_offset>(sStat.st_size);
+    if( nFileSize != m_nIndexedSize || m_fpRead == nullptr )
+    {
+        // Reopen, in case the file was replaced by a rewritten one.
+        if( m_fpRead != nullptr )
+            CPL_IGNORE_RET_VAL(VSIFCloseL(m_fpRead));
+        m_fpRead = VSIFOpenL( m_osFilename, "rb" );
+        if( m_fpRead == nullptr || !Refresh( m_fpRead, nFileSize ) )
+            return false;
+    }
+
+    const auto oIter = m_oIndex.find(osKey);
+    if( oIter == m_oIndex.end() )
+        return false;
+
+    osXML.resize( oIter->second.nXMLSize );
+    if( oIter->second.nXMLSize == 0 )
+        return true;
+    if( VSIFSeekL( m_fpRead, oIter->second.nXMLOffset, SEEK_SET ) != 0 ||
+        VSIFReadL( &osXML[0], 1, osXML.size(), m_fpRead ) != osXML.size() )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Cannot read %s.",
+                  m_osFilename.c_str() );
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                                Put()                                 */
+/************************************************************************/
+
+void GDALPamStore::Put( const std::string& osKey, const std::string& osXML )
+
+{
+    if( m_oPending.empty() )
+        m_nFirstPendingTime = time(nullptr);
+    m_oPending[osKey] = osXML;
+
+    if( static_cast<int>(m_oPending.size()) >= m_nBatchSize ||
+        difftime(time(nullptr), m_nFirstPendingTime) >= m_dfFlushDelay )
+    {
+        Flush();
+    }
+}
+
+/************************************************************************/
+/*                               Flush()                                */
+/*                                                                      */
+/*      Append the pending records. They are kept for a later attempt   */
+/*      on failure.                                                     */
+/************************************************************************/
+
+bool GDALPamStore::Flush()
+
+{
+    if( m_oPending.empty() )
+        return true;
+
+    void *hLock = CPLLockFile( m_osFilename, 10.0 );
+    if( hLock == nullptr )
+    {
+        CPLError( CE_Warning, CPLE_AppDefined,
+                  "Failed to lock %s, auxiliary information not saved yet.",
+                  m_osFilename.c_str() );
+        return false;
+    }
+
+    VSILFILE *fp = VSIFOpenL( m_osFilename, "rb+" );
+    if( fp == nullptr )
+    {
+        fp = VSIFOpenL( m_osFilename, "wb+" );
+        GByte abyHeader[nPamStoreHeaderSize] = { 0 };
+        memcpy( abyHeader, szPamStoreMagic, nPamStoreMagicSize );
+        if( fp != nullptr &&
+            VSIFWriteL( abyHeader, 1, nPamStoreHeaderSize, fp ) !=
+                                                        nPamStoreHeaderSize )
+        {
+            CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+            fp = nullptr;
+        }
+    }
+    if( fp == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Cannot open %s in update mode.",
+                  m_osFilename.c_str() );
+        CPLUnlockFile( hLock );
+        return false;
+    }
+
+    bool bOK = VSIFSeekL( fp, 0, SEEK_END ) == 0;
+    const vsi_l_offset nFileSize = VSIFTellL( fp );
+    bOK = bOK && Refresh( fp, nFileSize );
+
+    // Drop an incomplete record left by an interrupted writer.
+    if( bOK && m_nIndexedSize < nFileSize )
+        bOK = VSIFTruncateL( fp, m_nIndexedSize ) == 0;
+
+/* -------------------------------------------------------------------- */
+/*      Append all the records with a single write.                     */
+/* -------------------------------------------------------------------- */
+    std::string osBuffer;
+    if( bOK )
+    {
+        for( const auto& oPending : m_oPending )
+        {
+            GByte abyRecord[nPamStoreRecordHeaderSize] = { 'P', 'A', 'M', 'R' };
+            GUInt32 nKeySize = static_cast<GUInt32>(oPending.first.size());
+            GUInt32 nXMLSize = static_cast<GUInt32>(oPending.second.size());
+            CPL_LSBPTR32(&nKeySize);
+            CPL_LSBPTR32(&nXMLSize);
+            memcpy( abyRecord + 4, &nKeySize, 4 );
+            memcpy( abyRecord + 8, &nXMLSize, 4 );
+            osBuffer.append( reinterpret_cast<const char*>(abyRecord),
+                             nPamStoreRecordHeaderSize );
+            osBuffer += oPending.first;
+            osBuffer += oPending.second;
+        }
+        bOK = VSIFSeekL( fp, m_nIndexedSize, SEEK_SET ) == 0 &&
+              VSIFWriteL( osBuffer.data(), 1, osBuffer.size(), fp ) ==
+                                                            osBuffer.size();
+    }
+
+    if( bOK )
+    {
+        vsi_l_offset nOffset = m_nIndexedSize;
+        for( const auto& oPending : m_oPending )
+        {
+            Entry& oEntry = m_oIndex[oPending.first];
+            m_nDeadSize += oEntry.nRecordSize;
+            oEntry.nXMLOffset =
+                nOffset + nPamStoreRecordHeaderSize + oPending.first.size();
+            oEntry.nXMLSize = static_cast<GUInt32>(oPending.second.size());
+            oEntry.nRecordSize = static_cast<GUInt32>(
+                nPamStoreRecordHeaderSize + oPending.first.size() +
+                oPending.second.size());
+            nOffset += oEntry.nRecordSize;
+        }
+        m_nIndexedSize = nOffset;
+        m_oPending.clear();
+
+        if( m_nIndexedSize > nPamStoreMinCompactSize &&
+            m_nDeadSize > m_nIndexedSize / 2 )
+        {
+            Compact( fp );
+        }
+    }
+
+    if( VSIFCloseL( fp ) != 0 )
+        bOK = false;
+    CPLUnlockFile( hLock );
+
+    if( m_fpRead != nullptr )
+    {
+        CPL_IGNORE_RET_VAL(VSIFCloseL(m_fpRead));
+        m_fpRead = nullptr;
+    }
+
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Failed to write %s.",
+                  m_osFilename.c_str() );
+        // The records of the file may not have been indexed completely.
+        m_nIndexedSize = 0;
+    }
+    return bOK;
+}
+
+/************************************************************************/
+/*                              Compact()                               */
+/*                                                                      */
+/*      Rewrite the file with the latest record of each key only. The   */
+/*      caller holds the lock file.                                     */
+/************************************************************************/
+
+bool GDALPamStore::Compact( VSILFILE* fp )
+
+{
+    const CPLString osTmpFilename = m_osFilename + ".tmp";
+    VSILFILE *fpNew = VSIFOpenL( osTmpFilename, "wb" );
+    if( fpNew == nullptr )
+        return false;
+
+    GByte abyHeader[nPamStoreHeaderSize] = { 0 };
+    memcpy( abyHeader, szPamStoreMagic, nPamStoreMagicSize );
+    GUInt32 nGeneration = m_nGeneration + 1;
+    CPL_LSBPTR32(&nGeneration);
+    memcpy( abyHeader + nPamStoreMagicSize, &nGeneration, 4 );
+    bool bOK = VSIFWriteL( abyHeader, 1, nPamStoreHeaderSize, fpNew ) ==
+                                                        nPamStoreHeaderSize;
+
+    std::unordered_map<std::string, Entry> oNewIndex;
+    vsi_l_offset nOffset = nPamStoreHeaderSize;
+    std::vector<GByte> abyRecord;
+    for( const auto& oIter : m_oIndex )
+    {
+        if( !bOK )
+            break;
+        // Deletions are kept, as they also hide a .aux.xml file.
+        abyRecord.resize( oIter.second.nRecordSize );
+        const vsi_l_offset nRecordOffset =
+            oIter.second.nXMLOffset + oIter.second.nXMLSize -
+            oIter.second.nRecordSize;
+        bOK = VSIFSeekL( fp, nRecordOffset, SEEK_SET ) == 0 &&
+              VSIFReadL( abyRecord.data(), 1, abyRecord.size(), fp ) ==
+                                                        abyRecord.size() &&
+              VSIFWriteL( abyRecord.data(), 1, abyRecord.size(), fpNew ) ==
+                                                        abyRecord.size();
+        Entry oEntry( oIter.second );
+        oEntry.nXMLOffset =
+            nOffset + oIter.second.nRecordSize - oIter.second.nXMLSize;
+        oNewIndex[oIter.first] = oEntry;
+        nOffset += oIter.second.nRecordSize;
+    }
+
+    if( VSIFCloseL( fpNew ) != 0 )
+        bOK = false;
+    if( bOK )
+        bOK = VSIRename( osTmpFilename, m_osFilename ) == 0;
+    if( !bOK )
+    {
+        VSIUnlink( osTmpFilename );
+        return false;
+    }
+
+    m_oIndex = std::move(oNewIndex);
+    m_nGeneration++;
+    m_nIndexedSize = nOffset;
+    m_nDeadSize = 0;
+    return true;
+}
+
+/************************************************************************/
+/*                            InitPamStore()                            */
+/************************************************************************/
+
+static GDALPamStore *InitPamStore()
+
+{
+    if( !bPamStoreInitialized )
+    {
+        CPLMutexHolderD( &hPamStoreLock );
+        // cppcheck-suppress identicalInnerCondition
+        if( !bPamStoreInitialized )
+        {
+            const char *pszStore =
+                CPLGetConfigOption( "GDAL_PAM_STORE", nullptr );
+            if( pszStore != nullptr && pszStore[0] != '\0' )
+                poPamStore = new GDALPamStore( pszStore );
+        }
+
+        bPamStoreInitialized = true;
+    }
+    return poPamStore;
+}
+
+/************************************************************************/
+/*                          PamStoreIsEnabled()                         */
+/************************************************************************/
+
+int PamStoreIsEnabled()
+
+{
+    return InitPamStore() != nullptr;
+}
+
+/************************************************************************/
+/*                            PamStoreLoad()                            */
+/*                                                                      */
+/*      Return the PAM tree stored for pszKey. *pbFound is set to TRUE  */
+/*      if the store has an entry for the key, even if it records that  */
+/*      the dataset has no PAM information, in which case NULL is       */
+/*      returned.                                                       */
+/************************************************************************/
+
+CPLXMLNode *PamStoreLoad( const char *pszKey, int *pbFound )
+
+{
+    *pbFound = FALSE;
+    if( InitPamStore() == nullptr )
+        return nullptr;
+
+    std::string osXML;
+    {
+        CPLMutexHolderD( &hPamStoreLock );
+        if( !poPamStore->Get( pszKey, osXML ) )
+            return nullptr;
+    }
+
+    *pbFound = TRUE;
+    if( osXML.empty() )
+        return nullptr;
+    return CPLParseXMLString( osXML.c_str() );
+}
+
+/************************************************************************/
+/*                            PamStoreSave()                            */
+/*                                                                      */
+/*      Queue the PAM tree of pszKey for writing, or its deletion if    */
+/*      psTree is NULL.                                                 */
+/************************************************************************/
+
+void PamStoreSave( const char *pszKey, const CPLXMLNode *psTree )
+
+{
+    if( InitPamStore() == nullptr )
+        return;
+
+    std::string osXML;
+    if( psTree != nullptr )
+    {
+        char *pszXML = CPLSerializeXMLTree( psTree );
+        if( pszXML != nullptr )
+            osXML = pszXML;
+        CPLFree( pszXML );
+    }
+
+    CPLMutexHolderD( &hPamStoreLock );
+    poPamStore->Put( pszKey, osXML );
+}
+
+/************************************************************************/
+/*                           PamStoreFlush()                            */
+/************************************************************************/
+
+void PamStoreFlush()
+
+{
+    if( InitPamStore() == nullptr )
+        return;
+
+    CPLMutexHolderD( &hPamStoreLock );
+    poPamStore->Flush();
+}
+
+/************************************************************************/
+/*                           PamCleanStore()                            */
+/*                                                                      */
+/*      Write the pending records and release the store.                */
+/************************************************************************/
+
+void PamCleanStore()
+
+{
+    {
+        CPLMutexHolderD( &hPamStoreLock );
+
+        bPamStoreInitialized = false;
+
+        delete poPamStore;
+        poPamStore = nullptr;
+    }
+
+    CPLDestroyMutex( hPamStoreLock );
+    hPamStoreLock = nullptr;
+}
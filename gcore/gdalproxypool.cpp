@@ -30,9 +30,12 @@
 #include "cpl_port.h"
 #include "gdal_proxy.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -46,10 +49,14 @@
 
 CPL_CVSID("$Id: gdalproxypool.cpp 645329287230ee66498b50c53a59c67d93cb3af4 2019-03-14 21:44:42 +0100 Even Rouault $")
 
-/* We *must* share the same mutex as the gdaldataset.cpp file, as we are */
-/* doing GDALOpen() calls that can indirectly call GDALOpenShared() on */
-/* an auxiliary dataset ... */
-/* Then we could get dead-locks in multi-threaded use case */
+/* The list of cached datasets is split in shards, according to the hash */
+/* of their file name, each with its own mutex. Those mutexes are never */
+/* held while opening or closing a dataset: an entry being opened is */
+/* published in its shard with bOpening set, and the other threads that */
+/* want to share it wait on the condition variable of the shard until the */
+/* open has completed. The lifetime of the singleton itself is protected */
+/* by the same mutex as the gdaldataset.cpp file, as destroying it closes */
+/* datasets that can be shared ones. */
 
 /* ******************************************************************** */
 /*                         GDALDatasetPool                              */
@@ -63,23 +70,46 @@ static GDALDatasetPool* singleton = nullptr;
 
 void GDALNullifyProxyPoolSingleton() { singleton = nullptr; }
 
+/* Number of GDALOpen() and GDALClose() calls of cached datasets in */
+/* progress in the current thread. See refCountOfDisableRefCount. */
+static thread_local int tls_nDisableRefCount = 0;
+
 struct _GDALProxyPoolCacheEntry
 {
     GIntBig       responsiblePID;
     char         *pszFileName;
     char         *pszOwner;
+    char        **papszOpenOptions;
     GDALDataset  *poDS;
 
     /* Ref count of the cached dataset */
     int           refCount;
 
+    /* Set while poDS is being opened, by the thread nOpeningThread */
+    bool          bOpening;
+    GIntBig       nOpeningThread;
+
+    /* Index of the shard whose list contains this entry */
+    int           iShard;
+
     GDALProxyPoolCacheEntry* prev;
     GDALProxyPoolCacheEntry* next;
 };
 
+struct GDALProxyPoolShard
+{
+    std::mutex               oMutex{};
+    std::condition_variable  oCond{};
+    int                      currentSize = 0;
+    GDALProxyPoolCacheEntry* firstEntry = nullptr;
+    GDALProxyPoolCacheEntry* lastEntry = nullptr;
+};
+
 class GDALDatasetPool
 {
     private:
+        static constexpr int SHARD_COUNT = 8;
+
         bool bInDestruction = false;
 
         /* Ref count of the pool singleton */
@@ -88,14 +118,16 @@ class GDALDatasetPool
         /* between toplevel and inner GDALProxyPoolDataset */
         int refCount = 0;
 
+        /* Maximum and current number of entries, over all shards */
         int maxSize = 0;
-        int currentSize = 0;
-        GDALProxyPoolCacheEntry* firstEntry = nullptr;
-        GDALProxyPoolCacheEntry* lastEntry = nullptr;
+        std::atomic<int> currentSize{0};
+        GDALProxyPoolShard aoShards[SHARD_COUNT];
 
-        /* This variable prevents a dataset that is going to be opened in GDALDatasetPool::_RefDataset */
+        /* This variable, and tls_nDisableRefCount for the current thread, */
+        /* prevent a dataset that is going to be opened in GDALDatasetPool::_RefDataset */
         /* from increasing refCount if, during its opening, it creates a GDALProxyPoolDataset */
-        /* We increment it before opening or closing a cached dataset and decrement it afterwards */
+        /* tls_nDisableRefCount is incremented before opening or closing a cached dataset */
+        /* and decremented afterwards */
         /* The typical use case is a VRT made of simple sources that are VRT */
         /* We don't want the "inner" VRT to take a reference on the pool, otherwise there is */
         /* a high chance that this reference will not be dropped and the pool remain ghost */
@@ -112,12 +144,27 @@ class GDALDatasetPool
                                              bool bForceOpen,
                                              const char* pszOwner);
         void _CloseDataset(const char* pszFileName, GDALAccess eAccess,
+                           char** papszOpenOptions,
                            const char* pszOwner);
+        void _UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry);
+
+        GDALProxyPoolCacheEntry* StealUnusedEntry(int iExcludedShard);
+
+        static void MoveToFront(GDALProxyPoolShard& oShard,
+                                GDALProxyPoolCacheEntry* cur);
+        static void Unlink(GDALProxyPoolShard& oShard,
+                           GDALProxyPoolCacheEntry* cur);
+        static void Prepend(GDALProxyPoolShard& oShard,
+                            GDALProxyPoolCacheEntry* cur);
+        static void ClearEntry(GDALProxyPoolCacheEntry* cur,
+                               GDALDataset*& poDSToClose,
+                               GIntBig& nPIDToClose);
+        static void CloseWithPID(GDALDataset* poDS, GIntBig nPID);
 
 #ifdef DEBUG_PROXY_POOL
         // cppcheck-suppress unusedPrivateFunction
         void ShowContent();
-        void CheckLinks();
+        void CheckLinks(const GDALProxyPoolShard& oShard);
 #endif
 
         CPL_DISALLOW_COPY_ASSIGN(GDALDatasetPool)
@@ -133,12 +180,33 @@ class GDALDatasetPool
                                                    const char* pszOwner);
         static void UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry);
         static void CloseDataset(const char* pszFileName, GDALAccess eAccess,
+                                 char** papszOpenOptions,
                                  const char* pszOwner);
 
         static void PreventDestroy();
         static void ForceDestroy();
 };
 
+/************************************************************************/
+/*                        AreOpenOptionsEqual()                         */
+/************************************************************************/
+
+/* Open options take part in the identity of a cached dataset: the same file */
+/* opened with different open options may expose different content. */
+static bool AreOpenOptionsEqual( CSLConstList papszOptions1,
+                                 CSLConstList papszOptions2 )
+{
+    const int nCount = CSLCount(papszOptions1);
+    if( nCount != CSLCount(papszOptions2) )
+        return false;
+    for( int i = 0; i < nCount; ++i )
+    {
+        if( strcmp(papszOptions1[i], papszOptions2[i]) != 0 )
+            return false;
+    }
+    return true;
+}
+
 /************************************************************************/
 /*                         GDALDatasetPool()                            */
 /************************************************************************/
@@ -154,21 +222,25 @@ GDALDatasetPool::GDALDatasetPool(int maxSizeIn): maxSize(maxSizeIn)
 GDALDatasetPool::~GDALDatasetPool()
 {
     bInDestruction = true;
-    GDALProxyPoolCacheEntry* cur = firstEntry;
     GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-    while(cur)
+    for( GDALProxyPoolShard& oShard : aoShards )
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-        CPLFree(cur->pszFileName);
-        CPLFree(cur->pszOwner);
-        CPLAssert(cur->refCount == 0);
-        if (cur->poDS)
+        GDALProxyPoolCacheEntry* cur = oShard.firstEntry;
+        while(cur)
         {
-            GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
-            GDALClose(cur->poDS);
+            GDALProxyPoolCacheEntry* next = cur->next;
+            CPLFree(cur->pszFileName);
+            CPLFree(cur->pszOwner);
+            CSLDestroy(cur->papszOpenOptions);
+            CPLAssert(cur->refCount == 0);
+            if (cur->poDS)
+            {
+                GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
+                GDALClose(cur->poDS);
+            }
+            CPLFree(cur);
+            cur = next;
         }
-        CPLFree(cur);
-        cur = next;
     }
     GDALSetResponsiblePIDForCurrentThread(responsiblePID);
 }
@@ -180,16 +252,21 @@ GDALDatasetPool::~GDALDatasetPool()
 
 void GDALDatasetPool::ShowContent()
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
     int i = 0;
-    while(cur)
+    for( GDALProxyPoolShard& oShard : aoShards )
     {
-        printf("[%d] pszFileName=%s, owner=%s, refCount=%d, responsiblePID=%d\n",/*ok*/
-               i, cur->pszFileName,
-               cur->pszOwner ? cur->pszOwner : "(null)",
-               cur->refCount, (int)cur->responsiblePID);
-        i++;
-        cur = cur->next;
+        std::lock_guard<std::mutex> oLock(oShard.oMutex);
+        GDALProxyPoolCacheEntry* cur = oShard.firstEntry;
+        while(cur)
+        {
+            printf("[%d] shard=%d, pszFileName=%s, owner=%s, refCount=%d, responsiblePID=%d\n",/*ok*/
+                   i, cur->iShard,
+                   cur->pszFileName ? cur->pszFileName : "(null)",
+                   cur->pszOwner ? cur->pszOwner : "(null)",
+                   cur->refCount, (int)cur->responsiblePID);
+            i++;
+            cur = cur->next;
+        }
     }
 }
 
@@ -197,22 +274,139 @@ void GDALDatasetPool::ShowContent()
 /*                             CheckLinks()                             */
 /************************************************************************/
 
-void GDALDatasetPool::CheckLinks()
+void GDALDatasetPool::CheckLinks(const GDALProxyPoolShard& oShard)
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
+    GDALProxyPoolCacheEntry* cur = oShard.firstEntry;
     int i = 0;
     while(cur)
     {
-        CPLAssert(cur == firstEntry || cur->prev->next == cur);
-        CPLAssert(cur == lastEntry || cur->next->prev == cur);
+        CPLAssert(cur == oShard.firstEntry || cur->prev->next == cur);
+        CPLAssert(cur == oShard.lastEntry || cur->next->prev == cur);
+        CPLAssert(&aoShards[cur->iShard] == &oShard);
         ++i;
-        CPLAssert(cur->next != nullptr || cur == lastEntry);
+        CPLAssert(cur->next != nullptr || cur == oShard.lastEntry);
         cur = cur->next;
     }
-    CPLAssert(i == currentSize);
+    CPLAssert(i == oShard.currentSize);
 }
 #endif
 
+/************************************************************************/
+/*                       List management helpers                        */
+/*                                                                      */
+/*      They must be called with the mutex of the shard held.          */
+/************************************************************************/
+
+void GDALDatasetPool::MoveToFront(GDALProxyPoolShard& oShard,
+                                  GDALProxyPoolCacheEntry* cur)
+{
+    if (cur != oShard.firstEntry)
+    {
+        Unlink(oShard, cur);
+        Prepend(oShard, cur);
+    }
+}
+
+void GDALDatasetPool::Unlink(GDALProxyPoolShard& oShard,
+                             GDALProxyPoolCacheEntry* cur)
+{
+    if (cur->prev)
+        cur->prev->next = cur->next;
+    else
+        oShard.firstEntry = cur->next;
+    if (cur->next)
+        cur->next->prev = cur->prev;
+    else
+        oShard.lastEntry = cur->prev;
+    cur->prev = nullptr;
+    cur->next = nullptr;
+}
+
+void GDALDatasetPool::Prepend(GDALProxyPoolShard& oShard,
+                              GDALProxyPoolCacheEntry* cur)
+{
+    cur->prev = nullptr;
+    cur->next = oShard.firstEntry;
+    if (oShard.firstEntry)
+        oShard.firstEntry->prev = cur;
+    else
+        oShard.lastEntry = cur;
+    oShard.firstEntry = cur;
+}
+
+/************************************************************************/
+/*                            ClearEntry()                              */
+/************************************************************************/
+
+/* Frees the identity of an entry, that can then be recycled. Its dataset, */
+/* if any, is returned to be closed once the mutex of the shard has been */
+/* released. */
+void GDALDatasetPool::ClearEntry(GDALProxyPoolCacheEntry* cur,
+                                 GDALDataset*& poDSToClose,
+                                 GIntBig& nPIDToClose)
+{
+    poDSToClose = cur->poDS;
+    nPIDToClose = cur->responsiblePID;
+    cur->poDS = nullptr;
+    CPLFree(cur->pszFileName);
+    cur->pszFileName = nullptr;
+    CPLFree(cur->pszOwner);
+    cur->pszOwner = nullptr;
+    CSLDestroy(cur->papszOpenOptions);
+    cur->papszOpenOptions = nullptr;
+}
+
+/************************************************************************/
+/*                           CloseWithPID()                             */
+/************************************************************************/
+
+void GDALDatasetPool::CloseWithPID(GDALDataset* poDS, GIntBig nPID)
+{
+    if( poDS == nullptr )
+        return;
+
+    /* Close by pretending we are the thread that GDALOpen'ed this */
+    /* dataset */
+    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    GDALSetResponsiblePIDForCurrentThread(nPID);
+
+    tls_nDisableRefCount ++;
+    GDALClose(poDS);
+    tls_nDisableRefCount --;
+
+    GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+}
+
+/************************************************************************/
+/*                         StealUnusedEntry()                           */
+/************************************************************************/
+
+/* Unlinks the least recently used entry with a zero ref count of the other */
+/* shards, and returns it, or nullptr if there is none. It must be called */
+/* without the mutex of any shard held. */
+GDALProxyPoolCacheEntry* GDALDatasetPool::StealUnusedEntry(int iExcludedShard)
+{
+    for( int i = 1; i < SHARD_COUNT; ++i )
+    {
+        GDALProxyPoolShard& oShard = aoShards[(iExcludedShard + i) % SHARD_COUNT];
+        std::lock_guard<std::mutex> oLock(oShard.oMutex);
+        for( GDALProxyPoolCacheEntry* cur = oShard.lastEntry; cur;
+             cur = cur->prev )
+        {
+            if (cur->refCount == 0)
+            {
+                Unlink(oShard, cur);
+                oShard.currentSize --;
+#ifdef DEBUG_PROXY_POOL
+                CheckLinks(oShard);
+#endif
+                return cur;
+            }
+        }
+    }
+    return nullptr;
+}
+
 /************************************************************************/
 /*                            _RefDataset()                             */
 /************************************************************************/
@@ -227,131 +421,120 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
     if( bInDestruction )
         return nullptr;
 
-    GDALProxyPoolCacheEntry* cur = firstEntry;
     GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-    GDALProxyPoolCacheEntry* lastEntryWithZeroRefCount = nullptr;
+    const int iShard =
+        static_cast<int>(CPLHashSetHashStr(pszFileName) % SHARD_COUNT);
+    GDALProxyPoolShard& oShard = aoShards[iShard];
+    std::unique_lock<std::mutex> oLock(oShard.oMutex);
 
-    while(cur)
+    GDALProxyPoolCacheEntry* lastEntryWithZeroRefCount = nullptr;
+    for( GDALProxyPoolCacheEntry* cur = oShard.firstEntry; cur;
+         cur = cur->next )
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-
-        if (strcmp(cur->pszFileName, pszFileName) == 0 &&
+        /* Non shared requests only reuse an idle handle, so that */
+        /* concurrent readers of the same file get their own handles */
+        if (cur->pszFileName != nullptr &&
+            strcmp(cur->pszFileName, pszFileName) == 0 &&
+            AreOpenOptionsEqual(cur->papszOpenOptions, papszOpenOptions) &&
             ((bShared && cur->responsiblePID == responsiblePID &&
               ((cur->pszOwner == nullptr && pszOwner == nullptr) ||
                 (cur->pszOwner != nullptr && pszOwner != nullptr &&
                  strcmp(cur->pszOwner, pszOwner) == 0))) ||
              (!bShared && cur->refCount == 0)) )
         {
-            if (cur != firstEntry)
-            {
-                /* Move to begin */
-                if (cur->next)
-                    cur->next->prev = cur->prev;
-                else
-                    lastEntry = cur->prev;
-                cur->prev->next = cur->next;
-                cur->prev = nullptr;
-                firstEntry->prev = cur;
-                cur->next = firstEntry;
-                firstEntry = cur;
-
+            MoveToFront(oShard, cur);
 #ifdef DEBUG_PROXY_POOL
-                CheckLinks();
+            CheckLinks(oShard);
 #endif
-            }
 
             cur->refCount ++;
+
+            /* Wait for another thread to complete the opening, unless */
+            /* this is a recursive request of the opening thread */
+            const GIntBig nThisThread = CPLGetPID();
+            while( cur->bOpening && cur->nOpeningThread != nThisThread )
+                oShard.oCond.wait(oLock);
             return cur;
         }
 
         if (cur->refCount == 0)
             lastEntryWithZeroRefCount = cur;
-
-        cur = next;
     }
 
     if( !bForceOpen )
         return nullptr;
 
-    if (currentSize == maxSize)
+    GDALProxyPoolCacheEntry* cur = nullptr;
+    GDALDataset* poDSToClose = nullptr;
+    GIntBig nPIDToClose = 0;
+    if (currentSize.fetch_add(1) < maxSize)
     {
-        if (lastEntryWithZeroRefCount == nullptr)
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                     "Too many threads are running for the current value of the dataset pool size (%d).\n"
-                     "or too many proxy datasets are opened in a cascaded way.\n"
-                     "Try increasing GDAL_MAX_DATASET_POOL_SIZE.", maxSize);
-            return nullptr;
-        }
-
-        lastEntryWithZeroRefCount->pszFileName[0] = '\0';
-        if (lastEntryWithZeroRefCount->poDS)
+        cur = static_cast<GDALProxyPoolCacheEntry*>(
+            CPLCalloc(1, sizeof(GDALProxyPoolCacheEntry)));
+        cur->iShard = iShard;
+        Prepend(oShard, cur);
+        oShard.currentSize ++;
+    }
+    else
+    {
+        currentSize --;
+        if (lastEntryWithZeroRefCount != nullptr)
         {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(lastEntryWithZeroRefCount->responsiblePID);
-
-            refCountOfDisableRefCount ++;
-            GDALClose(lastEntryWithZeroRefCount->poDS);
-            refCountOfDisableRefCount --;
-
-            lastEntryWithZeroRefCount->poDS = nullptr;
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
-        }
-        CPLFree(lastEntryWithZeroRefCount->pszFileName);
-        CPLFree(lastEntryWithZeroRefCount->pszOwner);
-
-        /* Recycle this entry for the to-be-opened dataset and */
-        /* moves it to the top of the list */
-        if (lastEntryWithZeroRefCount->prev)
-            lastEntryWithZeroRefCount->prev->next = lastEntryWithZeroRefCount->next;
-        else {
-            CPLAssert(false);
+            /* Recycle this entry for the to-be-opened dataset and */
+            /* moves it to the top of the list */
+            cur = lastEntryWithZeroRefCount;
+            ClearEntry(cur, poDSToClose, nPIDToClose);
+            MoveToFront(oShard, cur);
         }
-        if (lastEntryWithZeroRefCount->next)
-            lastEntryWithZeroRefCount->next->prev = lastEntryWithZeroRefCount->prev;
         else
         {
-            CPLAssert(lastEntryWithZeroRefCount == lastEntry);
-            lastEntry->prev->next = nullptr;
-            lastEntry = lastEntry->prev;
+            oLock.unlock();
+            cur = StealUnusedEntry(iShard);
+            oLock.lock();
+            if (cur == nullptr)
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Too many threads are running for the current value of the dataset pool size (%d).\n"
+                         "or too many proxy datasets are opened in a cascaded way.\n"
+                         "Try increasing GDAL_MAX_DATASET_POOL_SIZE.", maxSize);
+                return nullptr;
+            }
+            ClearEntry(cur, poDSToClose, nPIDToClose);
+            cur->iShard = iShard;
+            Prepend(oShard, cur);
+            oShard.currentSize ++;
         }
-        lastEntryWithZeroRefCount->prev = nullptr;
-        lastEntryWithZeroRefCount->next = firstEntry;
-        firstEntry->prev = lastEntryWithZeroRefCount;
-        cur = firstEntry = lastEntryWithZeroRefCount;
-#ifdef DEBUG_PROXY_POOL
-        CheckLinks();
-#endif
     }
-    else
-    {
-        /* Prepend */
-        cur = static_cast<GDALProxyPoolCacheEntry*>(CPLMalloc(sizeof(GDALProxyPoolCacheEntry)));
-        if (lastEntry == nullptr)
-            lastEntry = cur;
-        cur->prev = nullptr;
-        cur->next = firstEntry;
-        if (firstEntry)
-            firstEntry->prev = cur;
-        firstEntry = cur;
-        currentSize ++;
 #ifdef DEBUG_PROXY_POOL
-        CheckLinks();
+    CheckLinks(oShard);
 #endif
-    }
 
     cur->pszFileName = CPLStrdup(pszFileName);
     cur->pszOwner = (pszOwner) ? CPLStrdup(pszOwner) : nullptr;
+    cur->papszOpenOptions = CSLDuplicate(papszOpenOptions);
     cur->responsiblePID = responsiblePID;
     cur->refCount = 1;
+    cur->bOpening = true;
+    cur->nOpeningThread = CPLGetPID();
+
+    /* Close the evicted dataset and open the new one without holding */
+    /* the mutex, so that other threads can use the pool meanwhile */
+    oLock.unlock();
 
-    refCountOfDisableRefCount ++;
+    CloseWithPID(poDSToClose, nPIDToClose);
+
+    tls_nDisableRefCount ++;
     int nFlag = ((eAccess == GA_Update) ? GDAL_OF_UPDATE : GDAL_OF_READONLY) | GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
     CPLConfigOptionSetter oSetter("CPL_ALLOW_VSISTDIN", "NO", true);
-    cur->poDS = GDALDataset::Open( pszFileName, nFlag, nullptr,
-                                            papszOpenOptions, nullptr );
-    refCountOfDisableRefCount --;
+    GDALDataset* poDS = GDALDataset::Open( pszFileName, nFlag, nullptr,
+                                           papszOpenOptions, nullptr );
+    tls_nDisableRefCount --;
+
+    oLock.lock();
+    cur->poDS = poDS;
+    cur->bOpening = false;
+    oLock.unlock();
+    oShard.oCond.notify_all();
 
     return cur;
 }
@@ -362,41 +545,48 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
 
 void GDALDatasetPool::_CloseDataset( const char* pszFileName,
                                      GDALAccess /* eAccess */,
+                                     char** papszOpenOptions,
                                      const char* pszOwner )
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    const int iShard =
+        static_cast<int>(CPLHashSetHashStr(pszFileName) % SHARD_COUNT);
+    GDALProxyPoolShard& oShard = aoShards[iShard];
+    GDALDataset* poDSToClose = nullptr;
+    GIntBig nPIDToClose = 0;
 
-    while(cur)
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-
-        CPLAssert(cur->pszFileName);
-        if (strcmp(cur->pszFileName, pszFileName) == 0 && cur->refCount == 0 &&
-            ((pszOwner == nullptr && cur->pszOwner == nullptr) ||
-             (pszOwner != nullptr && cur->pszOwner != nullptr &&
-              strcmp(cur->pszOwner, pszOwner) == 0)) &&
-            cur->poDS != nullptr )
+        std::lock_guard<std::mutex> oLock(oShard.oMutex);
+        for( GDALProxyPoolCacheEntry* cur = oShard.firstEntry; cur;
+             cur = cur->next )
         {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
-
-            refCountOfDisableRefCount ++;
-            GDALClose(cur->poDS);
-            refCountOfDisableRefCount --;
+            if (cur->pszFileName != nullptr &&
+                strcmp(cur->pszFileName, pszFileName) == 0 &&
+                cur->refCount == 0 &&
+                AreOpenOptionsEqual(cur->papszOpenOptions, papszOpenOptions) &&
+                ((pszOwner == nullptr && cur->pszOwner == nullptr) ||
+                 (pszOwner != nullptr && cur->pszOwner != nullptr &&
+                  strcmp(cur->pszOwner, pszOwner) == 0)) &&
+                cur->poDS != nullptr )
+            {
+                /* The entry stays in the list, available for recycling */
+                ClearEntry(cur, poDSToClose, nPIDToClose);
+                break;
+            }
+        }
+    }
 
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+    CloseWithPID(poDSToClose, nPIDToClose);
+}
 
-            cur->poDS = nullptr;
-            cur->pszFileName[0] = '\0';
-            CPLFree(cur->pszOwner);
-            cur->pszOwner = nullptr;
-            break;
-        }
+/************************************************************************/
+/*                       _UnrefDataset()                                */
+/************************************************************************/
 
-        cur = next;
-    }
+void GDALDatasetPool::_UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
+{
+    /* The shard of a referenced entry cannot change */
+    std::lock_guard<std::mutex> oLock(aoShards[cacheEntry->iShard].oMutex);
+    cacheEntry->refCount --;
 }
 
 /************************************************************************/
@@ -413,7 +603,7 @@ void GDALDatasetPool::Ref()
             l_maxSize = 100;
         singleton = new GDALDatasetPool(l_maxSize);
     }
-    if (singleton->refCountOfDisableRefCount == 0)
+    if (singleton->refCountOfDisableRefCount == 0 && tls_nDisableRefCount == 0)
       singleton->refCount++;
 }
 
@@ -446,7 +636,7 @@ void GDALDatasetPool::Unref()
         CPLAssert(false);
         return;
     }
-    if (singleton->refCountOfDisableRefCount == 0)
+    if (singleton->refCountOfDisableRefCount == 0 && tls_nDisableRefCount == 0)
     {
       singleton->refCount--;
       if (singleton->refCount == 0)
@@ -489,7 +679,6 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
                                                      bool bForceOpen,
                                                      const char* pszOwner)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
     return singleton->_RefDataset(pszFileName, eAccess, papszOpenOptions,
                                   bShared, bForceOpen, pszOwner);
 }
@@ -500,8 +689,10 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
 
 void GDALDatasetPool::UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
-    cacheEntry->refCount --;
+    if (singleton)
+        singleton->_UnrefDataset(cacheEntry);
+    else
+        cacheEntry->refCount --;
 }
 
 /************************************************************************/
@@ -509,10 +700,11 @@ void GDALDatasetPool::UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
 /************************************************************************/
 
 void GDALDatasetPool::CloseDataset(const char* pszFileName, GDALAccess eAccess,
+                                   char** papszOpenOptions,
                                    const char* pszOwner)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
-    singleton->_CloseDataset(pszFileName, eAccess, pszOwner);
+    singleton->_CloseDataset(pszFileName, eAccess, papszOpenOptions,
+                             pszOwner);
 }
 
 struct GetMetadataElt
@@ -602,6 +794,8 @@ void free_func_get_metadata_item(void* _elt)
 /* But we want to allow a same VRT referencing the same source dataset,*/
 /* for example if it has multiple bands. So in practice the value of pszOwner */
 /* is the serialized value (%p formatting) of the VRT dataset handle. */
+/* A null pszOwner lets all the proxies with a null owner, created by the */
+/* same thread and with the same open options, share the same dataset. */
 
 GDALProxyPoolDataset::GDALProxyPoolDataset(const char* pszSourceDatasetDescription,
                                    int nRasterXSizeIn, int nRasterYSizeIn,
@@ -663,7 +857,8 @@ GDALProxyPoolDataset::~GDALProxyPoolDataset()
 {
     if( !bShared )
     {
-        GDALDatasetPool::CloseDataset(GetDescription(), eAccess, m_pszOwner);
+        GDALDatasetPool::CloseDataset(GetDescription(), eAccess,
+                                      papszOpenOptions, m_pszOwner);
     }
     /* See comment in constructor */
     /* It is not really a genuine shared dataset, so we don't */
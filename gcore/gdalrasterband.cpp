@@ -39,15 +39,21 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <new>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
+#include "cpl_trace.h"
 #include "cpl_virtualmem.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_rat.h"
 #include "gdal_priv_templates.hpp"
@@ -362,6 +368,8 @@ CPLErr GDALRasterBand::RasterIO( GDALRWFlag eRWFlag,
 
     const bool bCallLeaveReadWrite = CPL_TO_BOOL(EnterReadWrite(eRWFlag));
 
+    CPLTraceScope oTrace("raster", "IRasterIO", "pixels",
+                         static_cast<GIntBig>(nBufXSize) * nBufYSize);
     CPLErr eErr;
     if( bForceCachedIO )
         eErr = GDALRasterBand::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
@@ -1198,7 +1206,10 @@ GDALRasterBlock *GDALRasterBand::TryGetLockedBlockRef( int nXBlockOff,
         return( nullptr );
     }
 
-    return poBandBlockCache->TryGetLockedBlockRef(nXBlockOff, nYBlockOff);
+    GDALRasterBlock* poBlock =
+        poBandBlockCache->TryGetLockedBlockRef(nXBlockOff, nYBlockOff);
+    GDALRasterBlock::RecordLookup(poBlock != nullptr);
+    return poBlock;
 }
 
 /************************************************************************/
@@ -1316,8 +1327,15 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
         {
             const GUInt32 nErrorCounter = CPLGetErrorCounter();
             int bCallLeaveReadWrite = EnterReadWrite(GF_Read);
-            eErr = IReadBlock(nXBlockOff,nYBlockOff,poBlock->GetDataRef());
+            {
+                CPL_TRACE_SCOPE("blockcache", "BlockCacheMiss");
+                eErr = IReadBlock(nXBlockOff,nYBlockOff,
+                                  poBlock->GetDataRef());
+            }
             if( bCallLeaveReadWrite) LeaveReadWrite();
+            if( CPLTraceIsEnabled() )
+                CPLTraceAddCounter("blockcache", "GDALCacheUsed",
+                                   GDALGetCacheUsed64());
             if( eErr != CE_None )
             {
                 poBlock->DropLock();
@@ -2881,6 +2899,395 @@ static inline void ComputeFloatNoDataValue( GDALDataType eDataType,
     }
 }
 
+/************************************************************************/
+/*                       GDALForEachSampledBlock()                      */
+/************************************************************************/
+
+namespace {
+struct GDALSampledBlockJob
+{
+    const std::function<void(size_t, const void*, int, int)>* pfnFunc;
+    GDALRasterBlock* poBlock;
+    size_t           iIndex;
+    int              nXCheck;
+    int              nYCheck;
+
+    static void Run( void* pData )
+    {
+        GDALSampledBlockJob* psJob = static_cast<GDALSampledBlockJob*>(pData);
+        (*psJob->pfnFunc)(psJob->iIndex, psJob->poBlock->GetDataRef(),
+                          psJob->nXCheck, psJob->nYCheck);
+        psJob->poBlock->DropLock();
+    }
+};
+} // namespace
+
+// Call oFunc on one block every nSampleRate blocks, with the index of the
+// call, the block data and its actual size. The blocks are fetched by the
+// calling thread, but oFunc is called from worker threads when
+// GDAL_NUM_THREADS is set, hence it must only write in per-index storage.
+static CPLErr GDALForEachSampledBlock(
+    GDALRasterBand* poBand, int nSampleRate,
+    const std::function<void(size_t, const void*, int, int)>& oFunc,
+    GDALProgressFunc pfnProgress, void* pProgressData,
+    const char* pszMessage )
+{
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nBlocksPerRow = DIV_ROUND_UP(poBand->GetXSize(), nBlockXSize);
+    const int nBlocksPerColumn = DIV_ROUND_UP(poBand->GetYSize(), nBlockYSize);
+    const int nBlocks = nBlocksPerRow * nBlocksPerColumn;
+    const size_t nCalls =
+        static_cast<size_t>(DIV_ROUND_UP(nBlocks, nSampleRate));
+
+    std::unique_ptr<CPLJobQueue> poJobQueue;
+    const int nThreads = std::min(CPLGetNumThreads(),
+                                  static_cast<int>(std::min(
+                                      nCalls, static_cast<size_t>(128))));
+    std::vector<GDALSampledBlockJob> asJobs;
+    if( nThreads > 1 )
+    {
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nThreads);
+        if( poPool != nullptr )
+        {
+            poJobQueue = poPool->CreateJobQueue();
+            asJobs.resize(nCalls);
+        }
+    }
+
+    CPLErr eErr = CE_None;
+    size_t iIndex = 0;
+    for( int iSampleBlock = 0;
+         iSampleBlock < nBlocks;
+         iSampleBlock += nSampleRate, ++iIndex )
+    {
+        const int iYBlock = iSampleBlock / nBlocksPerRow;
+        const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
+
+        GDALRasterBlock * const poBlock =
+            poBand->GetLockedBlockRef( iXBlock, iYBlock );
+        if( poBlock == nullptr )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+
+        int nXCheck = 0, nYCheck = 0;
+        poBand->GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
+
+        if( poJobQueue )
+        {
+            GDALSampledBlockJob& sJob = asJobs[iIndex];
+            sJob.pfnFunc = &oFunc;
+            sJob.poBlock = poBlock;
+            sJob.iIndex = iIndex;
+            sJob.nXCheck = nXCheck;
+            sJob.nYCheck = nYCheck;
+            if( !poJobQueue->SubmitJob(GDALSampledBlockJob::Run, &sJob) )
+                GDALSampledBlockJob::Run(&sJob);
+            // Bound the number of blocks locked, and of callbacks running,
+            // at once. The global pool may have more than nThreads threads.
+            poJobQueue->WaitCompletion(nThreads);
+        }
+        else
+        {
+            oFunc(iIndex, poBlock->GetDataRef(), nXCheck, nYCheck);
+            poBlock->DropLock();
+        }
+
+        if ( !pfnProgress( iSampleBlock / static_cast<double>(nBlocks),
+                           pszMessage, pProgressData) )
+        {
+            poBand->ReportError( CE_Failure, CPLE_UserInterrupt,
+                                 "User terminated" );
+            eErr = CE_Failure;
+            break;
+        }
+    }
+
+    if( poJobQueue )
+        poJobQueue->WaitCompletion(0);
+    return eErr;
+}
+
+/************************************************************************/
+/*                        GDALPartialResults                            */
+/************************************************************************/
+
+namespace {
+// Set of partial results of an accumulation where the order of the
+// blocks does not matter, so that GDALForEachSampledBlock() callbacks
+// running concurrently each work on their own partial result.
+template<class T> class GDALPartialResults
+{
+    std::mutex       m_oMutex{};
+    std::vector<T*>  m_apoFree{};
+
+    GDALPartialResults( const GDALPartialResults& ) = delete;
+    GDALPartialResults& operator=( const GDALPartialResults& ) = delete;
+
+  public:
+    explicit GDALPartialResults( const std::vector<T*>& apoResults ):
+        m_apoFree(apoResults) {}
+
+    T* Acquire()
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        CPLAssert( !m_apoFree.empty() );
+        T* poRet = m_apoFree.back();
+        m_apoFree.pop_back();
+        return poRet;
+    }
+
+    void Release( T* poResult )
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        m_apoFree.push_back(poResult);
+    }
+};
+} // namespace
+
+// Number of partial results needed for GDALForEachSampledBlock(): at most
+// nThreads jobs remain queued or running after each submission, plus the
+// one that the calling thread runs itself if it cannot be submitted.
+static int GDALGetPartialResultCount()
+{
+    const int nThreads = CPLGetNumThreads();
+    return nThreads > 1 ? nThreads + 1 : 1;
+}
+
+/************************************************************************/
+/*                         GetHistogramValue()                          */
+/************************************************************************/
+
+// Fetch the value of a pixel for histogram computation, that is the
+// modulus for complex types. Returns false if the value must be skipped.
+static inline bool GetHistogramValue( GDALDataType eDataType,
+                                      bool bSignedByte,
+                                      const void* pData,
+                                      GPtrDiff_t iOffset,
+                                      bool bGotNoDataValue,
+                                      double dfNoDataValue,
+                                      bool bGotFloatNoDataValue,
+                                      float fNoDataValue,
+                                      double& dfValue )
+{
+    switch( eDataType )
+    {
+      case GDT_Byte:
+      {
+        if( bSignedByte )
+            dfValue = static_cast<const signed char *>(pData)[iOffset];
+        else
+            dfValue = static_cast<const GByte *>(pData)[iOffset];
+        break;
+      }
+      case GDT_UInt16:
+        dfValue = static_cast<const GUInt16 *>(pData)[iOffset];
+        break;
+      case GDT_Int16:
+        dfValue = static_cast<const GInt16 *>(pData)[iOffset];
+        break;
+      case GDT_UInt32:
+        dfValue = static_cast<const GUInt32 *>(pData)[iOffset];
+        break;
+      case GDT_Int32:
+        dfValue = static_cast<const GInt32 *>(pData)[iOffset];
+        break;
+      case GDT_Float32:
+      {
+        const float fValue = static_cast<const float *>(pData)[iOffset];
+        if( CPLIsNan(fValue) ||
+            (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
+            return false;
+        dfValue = fValue;
+        return true;
+      }
+      case GDT_Float64:
+        dfValue = static_cast<const double *>(pData)[iOffset];
+        if( CPLIsNan(dfValue) )
+            return false;
+        break;
+      case GDT_CInt16:
+        {
+            const double dfReal =
+                static_cast<const GInt16 *>(pData)[iOffset*2];
+            const double dfImag =
+                static_cast<const GInt16 *>(pData)[iOffset*2+1];
+            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+        }
+        break;
+      case GDT_CInt32:
+        {
+            const double dfReal =
+                static_cast<const GInt32 *>(pData)[iOffset*2];
+            const double dfImag =
+                static_cast<const GInt32 *>(pData)[iOffset*2+1];
+            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+        }
+        break;
+      case GDT_CFloat32:
+        {
+            const double dfReal =
+                static_cast<const float *>(pData)[iOffset*2];
+            const double dfImag =
+                static_cast<const float *>(pData)[iOffset*2+1];
+            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
+                return false;
+            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+        }
+        break;
+      case GDT_CFloat64:
+        {
+            const double dfReal =
+                static_cast<const double *>(pData)[iOffset*2];
+            const double dfImag =
+                static_cast<const double *>(pData)[iOffset*2+1];
+            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
+                return false;
+            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+        }
+        break;
+      default:
+        CPLAssert( false );
+        return false;
+    }
+
+    return !(bGotNoDataValue && ARE_REAL_EQUAL(dfValue, dfNoDataValue));
+}
+
+/************************************************************************/
+/*                        GDALAddToHistogram()                          */
+/************************************************************************/
+
+namespace {
+// Parameters of a histogram computation.
+struct GDALHistogramParams
+{
+    GDALDataType eDataType;
+    bool         bSignedByte;
+    bool         bGotNoDataValue;
+    double       dfNoDataValue;
+    bool         bGotFloatNoDataValue;
+    float        fNoDataValue;
+    double       dfMin;
+    double       dfScale;
+    int          nBuckets;
+    bool         bIncludeOutOfRange;
+    // For 8 and 16 bit types, bucket index of each value minus
+    // nLUTMinValue, or -1 if it must be skipped.
+    const int*   panLUT;
+    int          nLUTMinValue;
+};
+} // namespace
+
+template<class T>
+static void GDALAddToHistogramLUT( const T* pData,
+                                   int nXCheck, int nLineStride, int nYCheck,
+                                   const int* panLUT,
+                                   GUIntBig* panHistogram )
+{
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        const T* pLine = pData + static_cast<GPtrDiff_t>(iY) * nLineStride;
+        int iX = 0;
+        // Unrolled so that consecutive increments of the same bucket
+        // are less likely to stall on each other.
+        for( ; iX + 3 < nXCheck; iX += 4 )
+        {
+            const int nIdx0 = panLUT[pLine[iX]];
+            const int nIdx1 = panLUT[pLine[iX + 1]];
+            const int nIdx2 = panLUT[pLine[iX + 2]];
+            const int nIdx3 = panLUT[pLine[iX + 3]];
+            if( nIdx0 >= 0 ) panHistogram[nIdx0]++;
+            if( nIdx1 >= 0 ) panHistogram[nIdx1]++;
+            if( nIdx2 >= 0 ) panHistogram[nIdx2]++;
+            if( nIdx3 >= 0 ) panHistogram[nIdx3]++;
+        }
+        for( ; iX < nXCheck; iX++ )
+        {
+            const int nIdx = panLUT[pLine[iX]];
+            if( nIdx >= 0 )
+                panHistogram[nIdx]++;
+        }
+    }
+}
+
+// Add the nXCheck x nYCheck pixels of pData to panHistogram.
+static void GDALAddToHistogram( const GDALHistogramParams& sParams,
+                                const void* pData,
+                                int nXCheck, int nLineStride, int nYCheck,
+                                GUIntBig* panHistogram )
+{
+    if( sParams.panLUT != nullptr )
+    {
+        const int* panLUT = sParams.panLUT - sParams.nLUTMinValue;
+        switch( sParams.eDataType )
+        {
+            case GDT_Byte:
+                if( sParams.bSignedByte )
+                    GDALAddToHistogramLUT(
+                        static_cast<const signed char*>(pData),
+                        nXCheck, nLineStride, nYCheck, panLUT, panHistogram);
+                else
+                    GDALAddToHistogramLUT(
+                        static_cast<const GByte*>(pData),
+                        nXCheck, nLineStride, nYCheck, panLUT, panHistogram);
+                return;
+            case GDT_UInt16:
+                GDALAddToHistogramLUT(
+                    static_cast<const GUInt16*>(pData),
+                    nXCheck, nLineStride, nYCheck, panLUT, panHistogram);
+                return;
+            case GDT_Int16:
+                GDALAddToHistogramLUT(
+                    static_cast<const GInt16*>(pData),
+                    nXCheck, nLineStride, nYCheck, panLUT, panHistogram);
+                return;
+            default:
+                CPLAssert( false );
+                return;
+        }
+    }
+
+    const int nBuckets = sParams.nBuckets;
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        for( int iX = 0; iX < nXCheck; iX++ )
+        {
+            const GPtrDiff_t iOffset =
+                iX + static_cast<GPtrDiff_t>(iY) * nLineStride;
+            double dfValue = 0.0;
+            if( !GetHistogramValue( sParams.eDataType, sParams.bSignedByte,
+                                    pData, iOffset,
+                                    sParams.bGotNoDataValue,
+                                    sParams.dfNoDataValue,
+                                    sParams.bGotFloatNoDataValue,
+                                    sParams.fNoDataValue, dfValue ) )
+                continue;
+
+            const int nIndex = static_cast<int>(
+                floor((dfValue - sParams.dfMin) * sParams.dfScale));
+
+            if( nIndex < 0 )
+            {
+                if( sParams.bIncludeOutOfRange )
+                    ++panHistogram[0];
+            }
+            else if( nIndex >= nBuckets )
+            {
+                if( sParams.bIncludeOutOfRange )
+                    ++panHistogram[nBuckets-1];
+            }
+            else
+            {
+                panHistogram[nIndex]++;
+            }
+        }
+    }
+}
+
 /************************************************************************/
 /*                            GetHistogram()                            */
 /************************************************************************/
@@ -2986,6 +3393,60 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
     const bool bSignedByte =
         pszPixelType != nullptr && EQUAL(pszPixelType, "SIGNEDBYTE");
 
+    GDALHistogramParams sParams;
+    sParams.eDataType = eDataType;
+    sParams.bSignedByte = bSignedByte;
+    sParams.bGotNoDataValue = CPL_TO_BOOL(bGotNoDataValue);
+    sParams.dfNoDataValue = dfNoDataValue;
+    sParams.bGotFloatNoDataValue = bGotFloatNoDataValue;
+    sParams.fNoDataValue = fNoDataValue;
+    sParams.dfMin = dfMin;
+    sParams.dfScale = dfScale;
+    sParams.nBuckets = nBuckets;
+    sParams.bIncludeOutOfRange = CPL_TO_BOOL(bIncludeOutOfRange);
+    sParams.panLUT = nullptr;
+    sParams.nLUTMinValue = 0;
+
+/* -------------------------------------------------------------------- */
+/*      For 8 and 16 bit types, precompute the bucket of each value.    */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anLUT;
+    int nLUTMaxValue = -1;
+    if( eDataType == GDT_Byte )
+    {
+        sParams.nLUTMinValue = bSignedByte ? -128 : 0;
+        nLUTMaxValue = bSignedByte ? 127 : 255;
+    }
+    else if( eDataType == GDT_UInt16 )
+    {
+        nLUTMaxValue = 65535;
+    }
+    else if( eDataType == GDT_Int16 )
+    {
+        sParams.nLUTMinValue = -32768;
+        nLUTMaxValue = 32767;
+    }
+    if( nLUTMaxValue >= 0 )
+    {
+        anLUT.resize(nLUTMaxValue - sParams.nLUTMinValue + 1);
+        for( int nValue = sParams.nLUTMinValue;
+             nValue <= nLUTMaxValue; nValue++ )
+        {
+            const double dfValue = nValue;
+            int nIndex = -1;
+            if( !(bGotNoDataValue && ARE_REAL_EQUAL(dfValue, dfNoDataValue)) )
+            {
+                nIndex = static_cast<int>(floor((dfValue - dfMin) * dfScale));
+                if( nIndex < 0 )
+                    nIndex = bIncludeOutOfRange ? 0 : -1;
+                else if( nIndex >= nBuckets )
+                    nIndex = bIncludeOutOfRange ? nBuckets - 1 : -1;
+            }
+            anLUT[nValue - sParams.nLUTMinValue] = nIndex;
+        }
+        sParams.panLUT = anLUT.data();
+    }
+
     if ( bApproxOK && HasArbitraryOverviews() )
     {
 /* -------------------------------------------------------------------- */
@@ -3024,121 +3485,8 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
             return eErr;
         }
 
-        // This isn't the fastest way to do this, but is easier for now.
-        for( int iY = 0; iY < nYReduced; iY++ )
-        {
-            for( int iX = 0; iX < nXReduced; iX++ )
-            {
-                const int iOffset = iX + iY * nXReduced;
-                double dfValue = 0.0;
-
-                switch( eDataType )
-                {
-                  case GDT_Byte:
-                  {
-                    if( bSignedByte )
-                        dfValue = static_cast<signed char *>(pData)[iOffset];
-                    else
-                        dfValue = static_cast<GByte *>(pData)[iOffset];
-                    break;
-                  }
-                  case GDT_UInt16:
-                    dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                    break;
-                  case GDT_Int16:
-                    dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                    break;
-                  case GDT_UInt32:
-                    dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                    break;
-                  case GDT_Int32:
-                    dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                    break;
-                  case GDT_Float32:
-                  {
-                    const float fValue = static_cast<float *>(pData)[iOffset];
-                    if( CPLIsNan(fValue) ||
-                        (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
-                        continue;
-                    dfValue = fValue;
-                    break;
-                  }
-                  case GDT_Float64:
-                    dfValue = static_cast<double *>(pData)[iOffset];
-                    if( CPLIsNan(dfValue) )
-                        continue;
-                    break;
-                  case GDT_CInt16:
-                    {
-                        const double dfReal =
-                            static_cast<GInt16 *>(pData)[iOffset*2];
-                        const double dfImag =
-                            static_cast<GInt16 *>(pData)[iOffset*2+1];
-                        if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                            continue;
-                        dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                    }
-                    break;
-                  case GDT_CInt32:
-                    {
-                        const double dfReal =
-                            static_cast<GInt32 *>(pData)[iOffset*2];
-                        const double dfImag =
-                            static_cast<GInt32 *>(pData)[iOffset*2+1];
-                        if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                            continue;
-                        dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                    }
-                    break;
-                  case GDT_CFloat32:
-                    {
-                        const double dfReal =
-                            static_cast<float *>(pData)[iOffset*2];
-                        const double dfImag =
-                            static_cast<float *>(pData)[iOffset*2+1];
-                        if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                            continue;
-                        dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                    }
-                    break;
-                  case GDT_CFloat64:
-                    {
-                        const double dfReal =
-                            static_cast<double *>(pData)[iOffset*2];
-                        const double dfImag =
-                            static_cast<double *>(pData)[iOffset*2+1];
-                        if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                            continue;
-                        dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                    }
-                    break;
-                  default:
-                    CPLAssert( false );
-                }
-
-                if( eDataType != GDT_Float32 &&
-                    bGotNoDataValue && ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                    continue;
-
-                const int nIndex =
-                    static_cast<int>(floor((dfValue - dfMin) * dfScale));
-
-                if( nIndex < 0 )
-                {
-                    if( bIncludeOutOfRange )
-                        panHistogram[0]++;
-                }
-                else if( nIndex >= nBuckets )
-                {
-                    if( bIncludeOutOfRange )
-                        ++panHistogram[nBuckets-1];
-                }
-                else
-                {
-                    ++panHistogram[nIndex];
-                }
-            }
-        }
+        GDALAddToHistogram( sParams, pData, nXReduced, nXReduced, nYReduced,
+                            panHistogram );
 
         CPLFree( pData );
     }
@@ -3167,166 +3515,51 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
         }
 
 /* -------------------------------------------------------------------- */
-/*      Read the blocks, and add to histogram.                          */
+/*      Read the blocks, and add to histogram. With several threads,    */
+/*      each one accumulates into its own histogram, and they are       */
+/*      summed at the end.                                              */
 /* -------------------------------------------------------------------- */
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        const int nPartialCount = GDALGetPartialResultCount();
+        std::vector<GUIntBig> anPartialHistograms;
+        std::vector<GUIntBig*> apanPartials;
+        apanPartials.push_back(panHistogram);
+        if( nPartialCount > 1 )
         {
-            if( !pfnProgress(
-                    iSampleBlock /
-                        (static_cast<double>(nBlocksPerRow) * nBlocksPerColumn),
-                    "Compute Histogram", pProgressData ) )
-                return CE_Failure;
-
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
-
-            void *pData = poBlock->GetDataRef();
-
-            int nXCheck = 0, nYCheck = 0;
-            GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
-
-            // this is a special case for a common situation.
-            if( eDataType == GDT_Byte && !bSignedByte
-                && dfScale == 1.0 && (dfMin >= -0.5 && dfMin <= 0.5)
-                && nYCheck == nBlockYSize && nXCheck == nBlockXSize
-                && nBuckets == 256 )
+            try
             {
-                const GPtrDiff_t nPixels = static_cast<GPtrDiff_t>(nXCheck) * nYCheck;
-                GByte *pabyData = static_cast<GByte *>(pData);
-
-                for( GPtrDiff_t i = 0; i < nPixels; i++ )
-                    if( ! (bGotNoDataValue &&
-                           (pabyData[i] == static_cast<GByte>(dfNoDataValue))))
-                    {
-                        panHistogram[pabyData[i]]++;
-                    }
-
-                poBlock->DropLock();
-                continue;  // To next sample block.
+                anPartialHistograms.resize(
+                    static_cast<size_t>(nPartialCount - 1) * nBuckets);
             }
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
+            catch( const std::exception& )
             {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const GPtrDiff_t iOffset = iX + static_cast<GPtrDiff_t>(iY) * nBlockXSize;
-                    double dfValue = 0.0;
-
-                    switch( eDataType )
-                    {
-                      case GDT_Byte:
-                      {
-                        if( bSignedByte )
-                            dfValue =
-                                static_cast<signed char *>(pData)[iOffset];
-                        else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
-                        break;
-                      }
-                      case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Float32:
-                      {
-                        const float fValue = static_cast<float *>(pData)[iOffset];
-                        if( CPLIsNan(fValue) ||
-                            (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
-                            continue;
-                        dfValue = fValue;
-                        break;
-                      }
-                      case GDT_Float64:
-                        dfValue = static_cast<double *>(pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CInt16:
-                        {
-                            double  dfReal =
-                                static_cast<GInt16 *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<GInt16 *>(pData)[iOffset*2+1];
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CInt32:
-                        {
-                            double  dfReal =
-                                static_cast<GInt32 *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<GInt32 *>(pData)[iOffset*2+1];
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CFloat32:
-                        {
-                            double  dfReal =
-                                static_cast<float *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<float *>(pData)[iOffset*2+1];
-                            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                                continue;
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CFloat64:
-                        {
-                            double  dfReal =
-                                static_cast<double *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<double *>(pData)[iOffset*2+1];
-                            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                                continue;
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      default:
-                        CPLAssert( false );
-                        return CE_Failure;
-                    }
-
-                    if( eDataType != GDT_Float32 && bGotNoDataValue &&
-                        ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                        continue;
-
-                    const int nIndex =
-                        static_cast<int>(floor((dfValue - dfMin) * dfScale));
-
-                    if( nIndex < 0 )
-                    {
-                        if( bIncludeOutOfRange )
-                            ++panHistogram[0];
-                    }
-                    else if( nIndex >= nBuckets )
-                    {
-                        if( bIncludeOutOfRange )
-                            ++panHistogram[nBuckets-1];
-                    }
-                    else
-                    {
-                        panHistogram[nIndex]++;
-                    }
-                }
+                ReportError( CE_Failure, CPLE_OutOfMemory,
+                             "Out of memory in GetHistogram()" );
+                return CE_Failure;
             }
-
-            poBlock->DropLock();
+            for( int i = 0; i < nPartialCount - 1; i++ )
+                apanPartials.push_back(
+                    &anPartialHistograms[static_cast<size_t>(i) * nBuckets]);
         }
+        GDALPartialResults<GUIntBig> oPartials(apanPartials);
+
+        const int nBlockXSizeLocal = nBlockXSize;
+        const CPLErr eErr = GDALForEachSampledBlock(
+            this, nSampleRate,
+            [&oPartials, &sParams, nBlockXSizeLocal](
+                        size_t, const void* pData, int nXCheck, int nYCheck)
+            {
+                GUIntBig* panPartial = oPartials.Acquire();
+                GDALAddToHistogram( sParams, pData,
+                                    nXCheck, nBlockXSizeLocal, nYCheck,
+                                    panPartial );
+                oPartials.Release(panPartial);
+            },
+            pfnProgress, pProgressData, "Compute Histogram" );
+        if( eErr != CE_None )
+            return eErr;
+
+        for( size_t i = 0; i < anPartialHistograms.size(); i++ )
+            panHistogram[i % nBuckets] += anPartialHistograms[i];
     }
 
     pfnProgress( 1.0, "Compute Histogram", pProgressData );
@@ -4712,100 +4945,6 @@ void ComputeStatisticsInternal<GUInt16>( int nXCheck,
 #endif // CPL_HAS_GINT64
 
 
-/************************************************************************/
-/*                          GetPixelValue()                             */
-/************************************************************************/
-
-static
-inline double GetPixelValue( GDALDataType eDataType,
-                             bool bSignedByte,
-                             const void* pData,
-                             GPtrDiff_t iOffset,
-                             bool bGotNoDataValue,
-                             double dfNoDataValue,
-                             bool bGotFloatNoDataValue,
-                             float fNoDataValue,
-                             bool& bValid )
-{
-    bValid = true;
-    double dfValue;
-    switch( eDataType )
-    {
-        case GDT_Byte:
-        {
-            if( bSignedByte )
-                dfValue = static_cast<const signed char *>(pData)[iOffset];
-            else
-                dfValue = static_cast<const GByte *>(pData)[iOffset];
-            break;
-        }
-        case GDT_UInt16:
-            dfValue = static_cast<const GUInt16 *>(pData)[iOffset];
-            break;
-        case GDT_Int16:
-            dfValue = static_cast<const GInt16 *>(pData)[iOffset];
-            break;
-        case GDT_UInt32:
-            dfValue = static_cast<const GUInt32 *>(pData)[iOffset];
-            break;
-        case GDT_Int32:
-            dfValue = static_cast<const GInt32 *>(pData)[iOffset];
-            break;
-        case GDT_Float32:
-        {
-            const float fValue = static_cast<const float *>(pData)[iOffset];
-            if( CPLIsNan(fValue) ||
-                (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
-            {
-                bValid = false;
-                return 0.0;
-            }
-            dfValue = fValue;
-            return dfValue;
-        }
-        case GDT_Float64:
-            dfValue = static_cast<const double *>(pData)[iOffset];
-            if( CPLIsNan(dfValue) )
-            {
-                bValid = false;
-                return 0.0;
-            }
-            break;
-        case GDT_CInt16:
-            dfValue = static_cast<const GInt16 *>(pData)[iOffset*2];
-            break;
-        case GDT_CInt32:
-            dfValue = static_cast<const GInt32 *>(pData)[iOffset*2];
-            break;
-        case GDT_CFloat32:
-            dfValue = static_cast<const float *>(pData)[iOffset*2];
-            if( CPLIsNan(dfValue) )
-            {
-                bValid = false;
-                return 0.0;
-            }
-            break;
-        case GDT_CFloat64:
-            dfValue = static_cast<const double *>(pData)[iOffset*2];
-            if( CPLIsNan(dfValue) )
-            {
-                bValid = false;
-                return 0.0;
-            }
-            break;
-        default:
-            dfValue = 0.0;
-            CPLAssert( false );
-    }
-
-    if( bGotNoDataValue && ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-    {
-        bValid = false;
-        return 0.0;
-    }
-    return dfValue;
-}
-
 /************************************************************************/
 /*                         SetValidPercent()                            */
 /************************************************************************/
@@ -4852,6 +4991,257 @@ void GDALRasterBand::SetValidPercent(GUIntBig nSampleCount, GUIntBig nValidCount
     }
 }
 
+/************************************************************************/
+/*                        GDALStatsAccumulator                          */
+/************************************************************************/
+
+namespace {
+// Statistics of a set of pixels. The mean and sum of squares of
+// differences to the mean (M2) of two sets can be merged with the
+// formula of Chan et al., which remains numerically stable.
+struct GDALStatsAccumulator
+{
+    GUIntBig nSampleCount = 0;
+    GUIntBig nValidCount = 0;
+    double   dfMin = 0.0;
+    double   dfMax = 0.0;
+    double   dfMean = 0.0;
+    double   dfM2 = 0.0;
+
+    void Merge( const GDALStatsAccumulator& oOther );
+};
+
+void GDALStatsAccumulator::Merge( const GDALStatsAccumulator& oOther )
+{
+    nSampleCount += oOther.nSampleCount;
+    if( oOther.nValidCount == 0 )
+        return;
+    if( nValidCount == 0 )
+    {
+        nValidCount = oOther.nValidCount;
+        dfMin = oOther.dfMin;
+        dfMax = oOther.dfMax;
+        dfMean = oOther.dfMean;
+        dfM2 = oOther.dfM2;
+        return;
+    }
+    dfMin = std::min(dfMin, oOther.dfMin);
+    dfMax = std::max(dfMax, oOther.dfMax);
+    const double dfCount = static_cast<double>(nValidCount);
+    const double dfOtherCount = static_cast<double>(oOther.nValidCount);
+    const double dfTotalCount = dfCount + dfOtherCount;
+    const double dfDelta = oOther.dfMean - dfMean;
+    dfMean += dfDelta * (dfOtherCount / dfTotalCount);
+    dfM2 += oOther.dfM2 +
+            dfDelta * dfDelta * dfCount * (dfOtherCount / dfTotalCount);
+    nValidCount += oOther.nValidCount;
+}
+
+// Nodata test of 8 and 16 bit integer values. ARE_REAL_EQUAL() can then
+// only be true for the integer closest to the nodata value.
+struct GDALStatsIntegerValidity
+{
+    bool   bHasNoData;
+    double dfNoData;
+
+    GDALStatsIntegerValidity( bool bGotNoDataValue, double dfNoDataValue ):
+        bHasNoData(false),
+        dfNoData(std::floor(dfNoDataValue + 0.5))
+    {
+        bHasNoData = bGotNoDataValue && ARE_REAL_EQUAL(dfNoData, dfNoDataValue);
+    }
+    bool operator()( double dfValue ) const
+    {
+        return !(bHasNoData && dfValue == dfNoData);
+    }
+};
+
+struct GDALStatsFloat32Validity
+{
+    bool  bHasNoData;
+    float fNoData;
+
+    bool operator()( double dfValue ) const
+    {
+        const float fValue = static_cast<float>(dfValue);
+        return !(CPLIsNan(fValue) ||
+                 (bHasNoData && ARE_REAL_EQUAL(fValue, fNoData)));
+    }
+};
+
+struct GDALStatsFloat64Validity
+{
+    bool   bHasNoData;
+    double dfNoData;
+
+    bool operator()( double dfValue ) const
+    {
+        return !(CPLIsNan(dfValue) ||
+                 (bHasNoData && ARE_REAL_EQUAL(dfValue, dfNoData)));
+    }
+};
+} // namespace
+
+/************************************************************************/
+/*                        GDALComputeBlockStats()                       */
+/************************************************************************/
+
+// Accumulate the statistics of a block of nXCheck x nYCheck pixels (of
+// which only the real part is considered for complex types). The mean and
+// M2 of the block are computed in two passes, and only if bComputeMoments.
+template<class T, int nComponents, class Validity>
+static void GDALComputeBlockStatsT( const T* pData,
+                                    int nXCheck, int nBlockXSize, int nYCheck,
+                                    const Validity& oValidity,
+                                    bool bComputeMoments,
+                                    GDALStatsAccumulator& oStats )
+{
+    GUIntBig nValidCount = 0;
+    double dfMin = std::numeric_limits<double>::infinity();
+    double dfMax = -std::numeric_limits<double>::infinity();
+    double dfSum = 0.0;
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        const T* pLine =
+            pData + static_cast<GPtrDiff_t>(iY) * nBlockXSize * nComponents;
+        for( int iX = 0; iX < nXCheck; iX++ )
+        {
+            const double dfValue = static_cast<double>(pLine[iX * nComponents]);
+            if( !oValidity(dfValue) )
+                continue;
+            nValidCount++;
+            dfMin = std::min(dfMin, dfValue);
+            dfMax = std::max(dfMax, dfValue);
+            dfSum += dfValue;
+        }
+    }
+
+    GDALStatsAccumulator oBlockStats;
+    oBlockStats.nSampleCount = static_cast<GUIntBig>(nXCheck) * nYCheck;
+    oBlockStats.nValidCount = nValidCount;
+    if( nValidCount > 0 )
+    {
+        oBlockStats.dfMin = dfMin;
+        oBlockStats.dfMax = dfMax;
+    }
+    if( bComputeMoments && nValidCount > 0 )
+    {
+        const double dfMean = dfSum / static_cast<double>(nValidCount);
+        double dfM2 = 0.0;
+        for( int iY = 0; iY < nYCheck; iY++ )
+        {
+            const T* pLine =
+                pData + static_cast<GPtrDiff_t>(iY) * nBlockXSize * nComponents;
+            for( int iX = 0; iX < nXCheck; iX++ )
+            {
+                const double dfValue =
+                    static_cast<double>(pLine[iX * nComponents]);
+                if( !oValidity(dfValue) )
+                    continue;
+                dfM2 += (dfValue - dfMean) * (dfValue - dfMean);
+            }
+        }
+        oBlockStats.dfMean = dfMean;
+        oBlockStats.dfM2 = dfM2;
+    }
+    oStats.Merge(oBlockStats);
+}
+
+static void GDALComputeBlockStats( GDALDataType eDataType, bool bSignedByte,
+                                   const void* pData,
+                                   int nXCheck, int nBlockXSize, int nYCheck,
+                                   bool bGotNoDataValue, double dfNoDataValue,
+                                   bool bGotFloatNoDataValue,
+                                   float fNoDataValue,
+                                   bool bComputeMoments,
+                                   GDALStatsAccumulator& oStats )
+{
+    const GDALStatsIntegerValidity oIntValidity(bGotNoDataValue,
+                                                dfNoDataValue);
+    const GDALStatsFloat32Validity oFloat32Validity = { bGotFloatNoDataValue,
+                                                        fNoDataValue };
+    const GDALStatsFloat64Validity oFloat64Validity = { bGotNoDataValue,
+                                                        dfNoDataValue };
+    switch( eDataType )
+    {
+        case GDT_Byte:
+            if( bSignedByte )
+                GDALComputeBlockStatsT<signed char, 1>(
+                    static_cast<const signed char*>(pData),
+                    nXCheck, nBlockXSize, nYCheck,
+                    oIntValidity, bComputeMoments, oStats);
+            else
+                GDALComputeBlockStatsT<GByte, 1>(
+                    static_cast<const GByte*>(pData),
+                    nXCheck, nBlockXSize, nYCheck,
+                    oIntValidity, bComputeMoments, oStats);
+            break;
+        case GDT_UInt16:
+            GDALComputeBlockStatsT<GUInt16, 1>(
+                static_cast<const GUInt16*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oIntValidity, bComputeMoments, oStats);
+            break;
+        case GDT_Int16:
+            GDALComputeBlockStatsT<GInt16, 1>(
+                static_cast<const GInt16*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oIntValidity, bComputeMoments, oStats);
+            break;
+        case GDT_UInt32:
+            GDALComputeBlockStatsT<GUInt32, 1>(
+                static_cast<const GUInt32*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oFloat64Validity, bComputeMoments, oStats);
+            break;
+        case GDT_Int32:
+            GDALComputeBlockStatsT<GInt32, 1>(
+                static_cast<const GInt32*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oFloat64Validity, bComputeMoments, oStats);
+            break;
+        case GDT_Float32:
+            GDALComputeBlockStatsT<float, 1>(
+                static_cast<const float*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oFloat32Validity, bComputeMoments, oStats);
+            break;
+        case GDT_Float64:
+            GDALComputeBlockStatsT<double, 1>(
+                static_cast<const double*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oFloat64Validity, bComputeMoments, oStats);
+            break;
+        case GDT_CInt16:
+            GDALComputeBlockStatsT<GInt16, 2>(
+                static_cast<const GInt16*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oIntValidity, bComputeMoments, oStats);
+            break;
+        case GDT_CInt32:
+            GDALComputeBlockStatsT<GInt32, 2>(
+                static_cast<const GInt32*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oFloat64Validity, bComputeMoments, oStats);
+            break;
+        case GDT_CFloat32:
+            GDALComputeBlockStatsT<float, 2>(
+                static_cast<const float*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oFloat64Validity, bComputeMoments, oStats);
+            break;
+        case GDT_CFloat64:
+            GDALComputeBlockStatsT<double, 2>(
+                static_cast<const double*>(pData),
+                nXCheck, nBlockXSize, nYCheck,
+                oFloat64Validity, bComputeMoments, oStats);
+            break;
+        default:
+            CPLAssert( false );
+            break;
+    }
+}
+
 /************************************************************************/
 /*                         ComputeStatistics()                          */
 /************************************************************************/
@@ -4867,6 +5257,10 @@ void GDALRasterBand::SetValidPercent(GUIntBig nSampleCount, GUIntBig nValidCount
  * Once computed, the statistics will generally be "set" back on the
  * raster band using SetStatistics().
  *
+ * Starting with GDAL 3.1, blocks are processed by several worker threads
+ * when the GDAL_NUM_THREADS configuration option is set to a number of
+ * threads or ALL_CPUS.
+ *
  * This method is the same as the C function GDALComputeRasterStatistics().
  *
  * @param bApproxOK If TRUE statistics may be computed based on overviews
@@ -4943,17 +5337,14 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
 /* -------------------------------------------------------------------- */
 /*      Read actual data and compute statistics.                        */
 /* -------------------------------------------------------------------- */
-    bool bFirstValue = true;
-    // Using Welford algorithm:
+    // The mean and the sum of square of differences to the mean (M2) are
+    // computed in two passes for each block, and the results of the blocks
+    // are merged with the parallel algorithm of Chan et al.:
     // http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
-    // to compute standard deviation in a more numerically robust way than
-    // the difference of the sum of square values with the square of the sum.
-    // dfMean and dfM2 are updated at each sample.
-    // dfM2 is the sum of square of differences to the current mean.
-    double dfMin = 0.0;
-    double dfMax = 0.0;
-    double dfMean = 0.0;
-    double dfM2 = 0.0;
+    // This computes the standard deviation in a more numerically robust way
+    // than the difference of the sum of square values with the square of
+    // the sum.
+    GDALStatsAccumulator oStats;
 
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
@@ -5011,44 +5402,11 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
             return eErr;
         }
 
-        /* this isn't the fastest way to do this, but is easier for now */
-        for( int iY = 0; iY < nYReduced; iY++ )
-        {
-            for( int iX = 0; iX < nXReduced; iX++ )
-            {
-                const int iOffset = iX + iY * nXReduced;
-                bool bValid = true;
-                double dfValue = GetPixelValue( eDataType,
-                                                bSignedByte,
-                                                pData,
-                                                iOffset,
-                                                CPL_TO_BOOL(bGotNoDataValue),
-                                                dfNoDataValue,
-                                                bGotFloatNoDataValue,
-                                                fNoDataValue,
-                                                bValid );
-                nSampleCount++;
-                if( !bValid )
-                    continue;
-
-                if( bFirstValue )
-                {
-                    dfMin = dfValue;
-                    dfMax = dfValue;
-                    bFirstValue = false;
-                }
-                else
-                {
-                    dfMin = std::min(dfMin, dfValue);
-                    dfMax = std::max(dfMax, dfValue);
-                }
-
-                nValidCount++;
-                const double dfDelta = dfValue - dfMean;
-                dfMean += dfDelta / nValidCount;
-                dfM2 += dfDelta * (dfValue - dfMean);
-            }
-        }
+        GDALComputeBlockStats( eDataType, bSignedByte, pData,
+                               nXReduced, nXReduced, nYReduced,
+                               CPL_TO_BOOL(bGotNoDataValue), dfNoDataValue,
+                               bGotFloatNoDataValue, fNoDataValue,
+                               true, oStats );
 
         CPLFree( pData );
     }
@@ -5107,60 +5465,84 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
                             static_cast<GUInt32>(dfNoDataValue + 1e-10) :
                             nMaxValueType+1;
 
-            for( int iSampleBlock = 0;
-                iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-                iSampleBlock += nSampleRate )
+            // Per block sums, so that blocks can be processed in parallel.
+            struct BlockSums
             {
-                const int iYBlock = iSampleBlock / nBlocksPerRow;
-                const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-                GDALRasterBlock * const poBlock =
-                    GetLockedBlockRef( iXBlock, iYBlock );
-                if( poBlock == nullptr )
-                    return CE_Failure;
-
-                void* const pData = poBlock->GetDataRef();
-
-                int nXCheck = 0, nYCheck = 0;
-                GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
-
-                if( eDataType == GDT_Byte )
-                {
-                    ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
-                                               nYCheck,
-                                               static_cast<const GByte*>(pData),
-                                               nNoDataValue <= nMaxValueType,
-                                               nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount,
-                                               nValidCount );
-                }
-                else
+                GUInt32 nMin;
+                GUInt32 nMax;
+                GUIntBig nSum;
+                GUIntBig nSumSquare;
+                GUIntBig nSampleCount;
+                GUIntBig nValidCount;
+            };
+            std::vector<BlockSums> asBlockSums;
+            try
+            {
+                asBlockSums.resize(static_cast<size_t>(DIV_ROUND_UP(
+                    nBlocksPerRow * nBlocksPerColumn, nSampleRate)));
+            }
+            catch( const std::exception& )
+            {
+                ReportError( CE_Failure, CPLE_OutOfMemory,
+                             "Out of memory in ComputeStatistics()" );
+                return CE_Failure;
+            }
+            const GDALDataType eDT = eDataType;
+            const int nBlockXSizeLocal = nBlockXSize;
+            const CPLErr eErr = GDALForEachSampledBlock(
+                this, nSampleRate,
+                [&asBlockSums, eDT, nBlockXSizeLocal, nMaxValueType,
+                 nNoDataValue](size_t iIndex, const void* pData,
+                               int nXCheck, int nYCheck)
                 {
-                    ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
-                                               nYCheck,
-                                               static_cast<const GUInt16*>(pData),
-                                               nNoDataValue <= nMaxValueType,
-                                               nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount,
-                                               nValidCount );
-                }
-
-                poBlock->DropLock();
+                    BlockSums& sSums = asBlockSums[iIndex];
+                    sSums.nMin = nMaxValueType;
+                    sSums.nMax = 0;
+                    sSums.nSum = 0;
+                    sSums.nSumSquare = 0;
+                    sSums.nSampleCount = 0;
+                    sSums.nValidCount = 0;
+                    if( eDT == GDT_Byte )
+                    {
+                        ComputeStatisticsInternal( nXCheck,
+                                                   nBlockXSizeLocal,
+                                                   nYCheck,
+                                                   static_cast<const GByte*>(pData),
+                                                   nNoDataValue <= nMaxValueType,
+                                                   nNoDataValue,
+                                                   sSums.nMin, sSums.nMax,
+                                                   sSums.nSum,
+                                                   sSums.nSumSquare,
+                                                   sSums.nSampleCount,
+                                                   sSums.nValidCount );
+                    }
+                    else
+                    {
+                        ComputeStatisticsInternal( nXCheck,
+                                                   nBlockXSizeLocal,
+                                                   nYCheck,
+                                                   static_cast<const GUInt16*>(pData),
+                                                   nNoDataValue <= nMaxValueType,
+                                                   nNoDataValue,
+                                                   sSums.nMin, sSums.nMax,
+                                                   sSums.nSum,
+                                                   sSums.nSumSquare,
+                                                   sSums.nSampleCount,
+                                                   sSums.nValidCount );
+                    }
+                },
+                pfnProgress, pProgressData, "Compute Statistics" );
+            if( eErr != CE_None )
+                return eErr;
 
-                if ( !pfnProgress( iSampleBlock
-                        / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                        "Compute Statistics", pProgressData) )
-                {
-                    ReportError( CE_Failure, CPLE_UserInterrupt,
-                                 "User terminated" );
-                    return CE_Failure;
-                }
+            for( const BlockSums& sSums: asBlockSums )
+            {
+                nMin = std::min(nMin, sSums.nMin);
+                nMax = std::max(nMax, sSums.nMax);
+                nSum += sSums.nSum;
+                nSumSquare += sSums.nSumSquare;
+                nSampleCount += sSums.nSampleCount;
+                nValidCount += sSums.nValidCount;
             }
 
             if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
@@ -5173,6 +5555,7 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
 /* -------------------------------------------------------------------- */
 /*      Save computed information.                                      */
 /* -------------------------------------------------------------------- */
+            double dfMean = 0.0;
             if( nValidCount )
                 dfMean = static_cast<double>(nSum) / nValidCount;
 
@@ -5226,73 +5609,43 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
         }
 #endif
 
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        // Statistics of each block, merged in order afterwards so that the
+        // result does not depend on the number of threads.
+        std::vector<GDALStatsAccumulator> aoBlockStats;
+        try
         {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock * const poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
-
-            void* const pData = poBlock->GetDataRef();
-
-            int nXCheck = 0, nYCheck = 0;
-            GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
+            aoBlockStats.resize(static_cast<size_t>(DIV_ROUND_UP(
+                nBlocksPerRow * nBlocksPerColumn, nSampleRate)));
+        }
+        catch( const std::exception& )
+        {
+            ReportError( CE_Failure, CPLE_OutOfMemory,
+                         "Out of memory in ComputeStatistics()" );
+            return CE_Failure;
+        }
+        const GDALDataType eDT = eDataType;
+        const int nBlockXSizeLocal = nBlockXSize;
+        const bool bGotNoDataValueLocal = CPL_TO_BOOL(bGotNoDataValue);
+        const CPLErr eErr = GDALForEachSampledBlock(
+            this, nSampleRate,
+            [&aoBlockStats, eDT, bSignedByte, nBlockXSizeLocal,
+             bGotNoDataValueLocal, dfNoDataValue,
+             bGotFloatNoDataValue, fNoDataValue](
+                        size_t iIndex, const void* pData,
+                        int nXCheck, int nYCheck)
             {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const GPtrDiff_t iOffset = iX + static_cast<GPtrDiff_t>(iY) * nBlockXSize;
-                    bool bValid = true;
-                    double dfValue = GetPixelValue( eDataType,
-                                                    bSignedByte,
-                                                    pData,
-                                                    iOffset,
-                                                    CPL_TO_BOOL(bGotNoDataValue),
-                                                    dfNoDataValue,
-                                                    bGotFloatNoDataValue,
-                                                    fNoDataValue,
-                                                    bValid );
-
-                    nSampleCount++;
-                    if( !bValid )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
-
-                    nValidCount++;
-                    const double dfDelta = dfValue - dfMean;
-                    dfMean += dfDelta / nValidCount;
-                    dfM2 += dfDelta * (dfValue - dfMean);
-                }
-            }
-
-            poBlock->DropLock();
+                GDALComputeBlockStats( eDT, bSignedByte, pData,
+                                       nXCheck, nBlockXSizeLocal, nYCheck,
+                                       bGotNoDataValueLocal, dfNoDataValue,
+                                       bGotFloatNoDataValue, fNoDataValue,
+                                       true, aoBlockStats[iIndex] );
+            },
+            pfnProgress, pProgressData, "Compute Statistics" );
+        if( eErr != CE_None )
+            return eErr;
 
-            if ( !pfnProgress(
-                     iSampleBlock
-                         / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                     "Compute Statistics", pProgressData) )
-            {
-                ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-                return CE_Failure;
-            }
-        }
+        for( const GDALStatsAccumulator& oBlockStats: aoBlockStats )
+            oStats.Merge(oBlockStats);
     }
 
     if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
@@ -5304,8 +5657,13 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
 /* -------------------------------------------------------------------- */
 /*      Save computed information.                                      */
 /* -------------------------------------------------------------------- */
+    nSampleCount = oStats.nSampleCount;
+    nValidCount = oStats.nValidCount;
+    const double dfMin = oStats.dfMin;
+    const double dfMax = oStats.dfMax;
+    const double dfMean = oStats.dfMean;
     const double dfStdDev =
-        nValidCount > 0 ? sqrt(dfM2 / nValidCount) : 0.0;
+        nValidCount > 0 ? sqrt(oStats.dfM2 / nValidCount) : 0.0;
 
     if( nValidCount > 0 )
     {
@@ -5407,105 +5765,714 @@ CPLErr GDALRasterBand::SetStatistics( double dfMin, double dfMax,
     CPLsnprintf( szValue, sizeof(szValue), "%.14g", dfMin );
     SetMetadataItem( "STATISTICS_MINIMUM", szValue );
 
-    CPLsnprintf( szValue, sizeof(szValue), "%.14g", dfMax );
-    SetMetadataItem( "STATISTICS_MAXIMUM", szValue );
+    CPLsnprintf( szValue, sizeof(szValue), "%.14g", dfMax );
+    SetMetadataItem( "STATISTICS_MAXIMUM", szValue );
+
+    CPLsnprintf( szValue, sizeof(szValue), "%.14g", dfMean );
+    SetMetadataItem( "STATISTICS_MEAN", szValue );
+
+    CPLsnprintf( szValue, sizeof(szValue), "%.14g", dfStdDev );
+    SetMetadataItem( "STATISTICS_STDDEV", szValue );
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                      GDALSetRasterStatistics()                       */
+/************************************************************************/
+
+/**
+ * \brief Set statistics on band.
+ *
+ * @see GDALRasterBand::SetStatistics()
+ */
+
+CPLErr CPL_STDCALL GDALSetRasterStatistics(
+        GDALRasterBandH hBand,
+        double dfMin, double dfMax, double dfMean, double dfStdDev )
+
+{
+    VALIDATE_POINTER1( hBand, "GDALSetRasterStatistics", CE_Failure );
+
+    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
+    return poBand->SetStatistics( dfMin, dfMax, dfMean, dfStdDev );
+}
+
+/************************************************************************/
+/*                        ComputeRasterMinMax()                         */
+/************************************************************************/
+
+/**
+ * \brief Compute the min/max values for a band.
+ *
+ * If approximate is OK, then the band's GetMinimum()/GetMaximum() will
+ * be trusted.  If it doesn't work, a subsample of blocks will be read to
+ * get an approximate min/max.  If the band has a nodata value it will
+ * be excluded from the minimum and maximum.
+ *
+ * If bApprox is FALSE, then all pixels will be read and used to compute
+ * an exact range.
+ *
+ * This method is the same as the C function GDALComputeRasterMinMax().
+ *
+ * @param bApproxOK TRUE if an approximate (faster) answer is OK, otherwise
+ * FALSE.
+ * @param adfMinMax the array in which the minimum (adfMinMax[0]) and the
+ * maximum (adfMinMax[1]) are returned.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
+                                            double* adfMinMax )
+{
+    double dfMin = 0.0;
+    double dfMax = 0.0;
+
+/* -------------------------------------------------------------------- */
+/*      Does the driver already know the min/max?                       */
+/* -------------------------------------------------------------------- */
+    if( bApproxOK )
+    {
+        int bSuccessMin = FALSE;
+        int bSuccessMax = FALSE;
+
+        dfMin = GetMinimum( &bSuccessMin );
+        dfMax = GetMaximum( &bSuccessMax );
+
+        if( bSuccessMin && bSuccessMax )
+        {
+            adfMinMax[0] = dfMin;
+            adfMinMax[1] = dfMax;
+            return CE_None;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      If we have overview bands, use them for min/max.                */
+/* -------------------------------------------------------------------- */
+    // cppcheck-suppress knownConditionTrueFalse
+    if ( bApproxOK && GetOverviewCount() > 0 && !HasArbitraryOverviews() )
+    {
+        GDALRasterBand *poBand =
+          GetRasterSampleOverview( GDALSTAT_APPROX_NUMSAMPLES );
+
+        if ( poBand != this )
+            return poBand->ComputeRasterMinMax( FALSE, adfMinMax );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Read actual data and compute minimum and maximum.               */
+/* -------------------------------------------------------------------- */
+    int bGotNoDataValue = FALSE;
+    const double dfNoDataValue = GetNoDataValue( &bGotNoDataValue );
+    bGotNoDataValue = bGotNoDataValue && !CPLIsNan(dfNoDataValue);
+    bool bGotFloatNoDataValue = false;
+    float fNoDataValue = 0.0f;
+    ComputeFloatNoDataValue( eDataType, dfNoDataValue, bGotNoDataValue,
+                            fNoDataValue, bGotFloatNoDataValue );
+
+    const char* pszPixelType = GetMetadataItem("PIXELTYPE", "IMAGE_STRUCTURE");
+    const bool bSignedByte =
+        pszPixelType != nullptr && EQUAL(pszPixelType, "SIGNEDBYTE");
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+
+    GDALStatsAccumulator oStats;
+    if ( bApproxOK && HasArbitraryOverviews() )
+    {
+/* -------------------------------------------------------------------- */
+/*      Figure out how much the image should be reduced to get an       */
+/*      approximate value.                                              */
+/* -------------------------------------------------------------------- */
+        double  dfReduction = sqrt(
+            static_cast<double>(nRasterXSize) * nRasterYSize /
+            GDALSTAT_APPROX_NUMSAMPLES );
+
+        int nXReduced = nRasterXSize;
+        int nYReduced = nRasterYSize;
+        if ( dfReduction > 1.0 )
+        {
+            nXReduced = static_cast<int>( nRasterXSize / dfReduction );
+            nYReduced = static_cast<int>( nRasterYSize / dfReduction );
+
+            // Catch the case of huge resizing ratios here
+            if ( nXReduced == 0 )
+                nXReduced = 1;
+            if ( nYReduced == 0 )
+                nYReduced = 1;
+        }
+
+        void * const pData =
+            CPLMalloc(
+                GDALGetDataTypeSizeBytes(eDataType) * nXReduced * nYReduced );
+
+        const CPLErr eErr = IRasterIO(
+            GF_Read, 0, 0, nRasterXSize, nRasterYSize, pData,
+            nXReduced, nYReduced, eDataType, 0, 0, &sExtraArg );
+        if ( eErr != CE_None )
+        {
+            CPLFree(pData);
+            return eErr;
+        }
+
+        GDALComputeBlockStats( eDataType, bSignedByte, pData,
+                               nXReduced, nXReduced, nYReduced,
+                               CPL_TO_BOOL(bGotNoDataValue), dfNoDataValue,
+                               bGotFloatNoDataValue, fNoDataValue,
+                               false, oStats );
+
+        CPLFree( pData );
+    }
+
+    else  // No arbitrary overviews
+    {
+        if( !InitBlockInfo() )
+            return CE_Failure;
+
+/* -------------------------------------------------------------------- */
+/*      Figure out the ratio of blocks we will read to get an           */
+/*      approximate value.                                              */
+/* -------------------------------------------------------------------- */
+        int nSampleRate = 1;
+
+        if ( bApproxOK )
+        {
+            nSampleRate = static_cast<int>(
+                std::max(1.0,
+                         sqrt(static_cast<double>(nBlocksPerRow) *
+                              nBlocksPerColumn)));
+            // We want to avoid probing only the first column of blocks for
+            // a square shaped raster, because it is not unlikely that it may
+            // be padding only (#6378).
+            if( nSampleRate == nBlocksPerRow && nBlocksPerRow > 1 )
+              nSampleRate += 1;
+        }
+
+        std::vector<GDALStatsAccumulator> aoBlockStats;
+        try
+        {
+            aoBlockStats.resize(static_cast<size_t>(DIV_ROUND_UP(
+                nBlocksPerRow * nBlocksPerColumn, nSampleRate)));
+        }
+        catch( const std::exception& )
+        {
+            ReportError( CE_Failure, CPLE_OutOfMemory,
+                         "Out of memory in ComputeRasterMinMax()" );
+            return CE_Failure;
+        }
+        const GDALDataType eDT = eDataType;
+        const int nBlockXSizeLocal = nBlockXSize;
+        const bool bGotNoDataValueLocal = CPL_TO_BOOL(bGotNoDataValue);
+        const CPLErr eErr = GDALForEachSampledBlock(
+            this, nSampleRate,
+            [&aoBlockStats, eDT, bSignedByte, nBlockXSizeLocal,
+             bGotNoDataValueLocal, dfNoDataValue,
+             bGotFloatNoDataValue, fNoDataValue](
+                        size_t iIndex, const void* pData,
+                        int nXCheck, int nYCheck)
+            {
+                GDALComputeBlockStats( eDT, bSignedByte, pData,
+                                       nXCheck, nBlockXSizeLocal, nYCheck,
+                                       bGotNoDataValueLocal, dfNoDataValue,
+                                       bGotFloatNoDataValue, fNoDataValue,
+                                       false, aoBlockStats[iIndex] );
+            },
+            GDALDummyProgress, nullptr, nullptr );
+        if( eErr != CE_None )
+            return eErr;
+
+        for( const GDALStatsAccumulator& oBlockStats: aoBlockStats )
+            oStats.Merge(oBlockStats);
+    }
+
+    if( oStats.nValidCount > 0 )
+    {
+        dfMin = oStats.dfMin;
+        dfMax = oStats.dfMax;
+    }
+
+    adfMinMax[0] = dfMin;
+    adfMinMax[1] = dfMax;
+
+    if( oStats.nValidCount == 0 )
+    {
+        ReportError(
+            CE_Failure, CPLE_AppDefined,
+            "Failed to compute min/max, no valid pixels found in sampling." );
+        return CE_Failure;
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                      GDALComputeRasterMinMax()                       */
+/************************************************************************/
+
+/**
+ * \brief Compute the min/max values for a band.
+ *
+ * @see GDALRasterBand::ComputeRasterMinMax()
+ */
+
+void CPL_STDCALL
+GDALComputeRasterMinMax( GDALRasterBandH hBand, int bApproxOK,
+                         double adfMinMax[2] )
+
+{
+    VALIDATE_POINTER0( hBand, "GDALComputeRasterMinMax" );
+
+    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
+    poBand->ComputeRasterMinMax( bApproxOK, adfMinMax );
+}
+
+/************************************************************************/
+/*                         GDALQuantileSketch                           */
+/************************************************************************/
+
+namespace {
+// Approximate quantiles sketch, after "Optimal Quantile Approximation in
+// Streams" by Karnin, Lang and Liberty (KLL). Each item of level h stands
+// for 2^h input values. When a level reaches its capacity, it is sorted
+// and every other item is promoted to the next level. The offset of the
+// promoted items alternates between the compactions of each level instead
+// of being random, so that results are reproducible. The minimum and
+// maximum are tracked exactly.
+class GDALQuantileSketch
+{
+    int                               m_nK;
+    std::vector<std::vector<double>>  m_aadfLevels;
+    std::vector<GUIntBig>             m_anCompactions;
+    size_t                            m_nLevel0Capacity = 0;
+    GUIntBig                          m_nCount = 0;
+    double                            m_dfMin = 0.0;
+    double                            m_dfMax = 0.0;
+
+    size_t GetCapacity( size_t iLevel ) const;
+    void   Compact();
+
+  public:
+    explicit GDALQuantileSketch( int nK ):
+        m_nK(nK), m_aadfLevels(1), m_anCompactions(1)
+    {
+        m_nLevel0Capacity = GetCapacity(0);
+    }
+
+    GUIntBig GetCount() const { return m_nCount; }
+
+    void Add( double dfValue )
+    {
+        if( m_nCount == 0 )
+        {
+            m_dfMin = dfValue;
+            m_dfMax = dfValue;
+        }
+        else
+        {
+            m_dfMin = std::min(m_dfMin, dfValue);
+            m_dfMax = std::max(m_dfMax, dfValue);
+        }
+        m_aadfLevels[0].push_back(dfValue);
+        m_nCount++;
+        if( m_aadfLevels[0].size() >= m_nLevel0Capacity )
+            Compact();
+    }
+
+    void Merge( const GDALQuantileSketch& oOther );
+    void GetQuantiles( int nQuantiles, const double* padfProbabilities,
+                       double* padfQuantiles ) const;
+};
+
+// The capacity of the top level is m_nK, and it decreases by a factor
+// of 2/3 for each level below.
+size_t GDALQuantileSketch::GetCapacity( size_t iLevel ) const
+{
+    const size_t nDepth = m_aadfLevels.size() - 1 - iLevel;
+    const double dfCapacity =
+        m_nK * pow(2.0 / 3.0, static_cast<double>(nDepth));
+    return std::max(static_cast<size_t>(2),
+                    static_cast<size_t>(ceil(dfCapacity)));
+}
+
+void GDALQuantileSketch::Compact()
+{
+    bool bCompacted = true;
+    while( bCompacted )
+    {
+        bCompacted = false;
+        for( size_t iLevel = 0; iLevel < m_aadfLevels.size(); iLevel++ )
+        {
+            if( m_aadfLevels[iLevel].size() < GetCapacity(iLevel) )
+                continue;
+            if( iLevel + 1 == m_aadfLevels.size() )
+            {
+                m_aadfLevels.emplace_back();
+                m_anCompactions.push_back(0);
+            }
+
+            std::vector<double>& adfLevel = m_aadfLevels[iLevel];
+            std::vector<double>& adfNextLevel = m_aadfLevels[iLevel + 1];
+            std::sort(adfLevel.begin(), adfLevel.end());
+            // With an odd number of items, the largest one stays in place.
+            const size_t nCompacted = adfLevel.size() & ~static_cast<size_t>(1);
+            const size_t nOffset =
+                static_cast<size_t>(m_anCompactions[iLevel]++ & 1);
+            for( size_t i = nOffset; i < nCompacted; i += 2 )
+                adfNextLevel.push_back(adfLevel[i]);
+            adfLevel.erase(adfLevel.begin(),
+                           adfLevel.begin() + nCompacted);
+            bCompacted = true;
+        }
+    }
+    m_nLevel0Capacity = GetCapacity(0);
+}
 
-    CPLsnprintf( szValue, sizeof(szValue), "%.14g", dfMean );
-    SetMetadataItem( "STATISTICS_MEAN", szValue );
+void GDALQuantileSketch::Merge( const GDALQuantileSketch& oOther )
+{
+    if( oOther.m_nCount == 0 )
+        return;
+    if( m_nCount == 0 )
+    {
+        m_dfMin = oOther.m_dfMin;
+        m_dfMax = oOther.m_dfMax;
+    }
+    else
+    {
+        m_dfMin = std::min(m_dfMin, oOther.m_dfMin);
+        m_dfMax = std::max(m_dfMax, oOther.m_dfMax);
+    }
+    if( oOther.m_aadfLevels.size() > m_aadfLevels.size() )
+    {
+        m_aadfLevels.resize(oOther.m_aadfLevels.size());
+        m_anCompactions.resize(oOther.m_aadfLevels.size());
+    }
+    for( size_t iLevel = 0; iLevel < oOther.m_aadfLevels.size(); iLevel++ )
+    {
+        m_aadfLevels[iLevel].insert(m_aadfLevels[iLevel].end(),
+                                    oOther.m_aadfLevels[iLevel].begin(),
+                                    oOther.m_aadfLevels[iLevel].end());
+    }
+    m_nCount += oOther.m_nCount;
+    Compact();
+}
 
-    CPLsnprintf( szValue, sizeof(szValue), "%.14g", dfStdDev );
-    SetMetadataItem( "STATISTICS_STDDEV", szValue );
+// The quantile of probability p is the smallest item such that the total
+// weight of the items lower or equal to it is at least p times the count.
+void GDALQuantileSketch::GetQuantiles( int nQuantiles,
+                                       const double* padfProbabilities,
+                                       double* padfQuantiles ) const
+{
+    std::vector<std::pair<double, GUIntBig>> aoItems;
+    for( size_t iLevel = 0; iLevel < m_aadfLevels.size(); iLevel++ )
+    {
+        const GUIntBig nWeight = static_cast<GUIntBig>(1) << iLevel;
+        for( const double dfValue: m_aadfLevels[iLevel] )
+            aoItems.emplace_back(dfValue, nWeight);
+    }
+    if( aoItems.empty() )
+        return;
+    std::sort(aoItems.begin(), aoItems.end());
 
-    return CE_None;
+    for( int i = 0; i < nQuantiles; i++ )
+    {
+        if( padfProbabilities[i] <= 0.0 )
+        {
+            padfQuantiles[i] = m_dfMin;
+            continue;
+        }
+        if( padfProbabilities[i] >= 1.0 )
+        {
+            padfQuantiles[i] = m_dfMax;
+            continue;
+        }
+        const double dfTarget = std::max(1.0,
+            padfProbabilities[i] * static_cast<double>(m_nCount));
+        GUIntBig nCumWeight = 0;
+        padfQuantiles[i] = m_dfMax;
+        for( const auto& oItem: aoItems )
+        {
+            nCumWeight += oItem.second;
+            if( static_cast<double>(nCumWeight) >= dfTarget )
+            {
+                padfQuantiles[i] = oItem.first;
+                break;
+            }
+        }
+    }
 }
 
+// Number of items of the top level of the sketch. The rank error of the
+// quantiles is then in the order of 0.5%, for a few tens of kilobytes of
+// memory.
+constexpr int QUANTILE_SKETCH_K = 1024;
+
 /************************************************************************/
-/*                      GDALSetRasterStatistics()                       */
+/*                       GDALQuantileAccumulator                        */
 /************************************************************************/
 
-/**
- * \brief Set statistics on band.
- *
- * @see GDALRasterBand::SetStatistics()
- */
+// Accumulation of the values of a band for quantile computation: exact
+// counts of each value for 8 and 16 bit integer types, and a sketch
+// otherwise. Only the real part of complex values is considered.
+struct GDALQuantileAccumulator
+{
+    std::vector<GUIntBig> anCounts{};
+    GDALQuantileSketch    oSketch{QUANTILE_SKETCH_K};
+};
 
-CPLErr CPL_STDCALL GDALSetRasterStatistics(
-        GDALRasterBandH hBand,
-        double dfMin, double dfMax, double dfMean, double dfStdDev )
+struct GDALQuantileParams
+{
+    GDALDataType eDataType;
+    bool         bSignedByte;
+    bool         bGotNoDataValue;
+    double       dfNoDataValue;
+    bool         bGotFloatNoDataValue;
+    float        fNoDataValue;
+    // Range of values counted in anCounts, if nMaxValue >= nMinValue.
+    int          nMinValue;
+    int          nMaxValue;
+};
+} // namespace
 
+template<class T, int nComponents>
+static void GDALCountValues( const T* pData,
+                             int nXCheck, int nLineStride, int nYCheck,
+                             int nMinValue, GUIntBig* panCounts )
 {
-    VALIDATE_POINTER1( hBand, "GDALSetRasterStatistics", CE_Failure );
+    GUIntBig* panCountsShifted = panCounts - nMinValue;
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        const T* pLine =
+            pData + static_cast<GPtrDiff_t>(iY) * nLineStride * nComponents;
+        for( int iX = 0; iX < nXCheck; iX++ )
+            panCountsShifted[pLine[iX * nComponents]]++;
+    }
+}
 
-    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
-    return poBand->SetStatistics( dfMin, dfMax, dfMean, dfStdDev );
+template<class T, int nComponents, class Validity>
+static void GDALAddToSketch( const T* pData,
+                             int nXCheck, int nLineStride, int nYCheck,
+                             const Validity& oValidity,
+                             GDALQuantileSketch& oSketch )
+{
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        const T* pLine =
+            pData + static_cast<GPtrDiff_t>(iY) * nLineStride * nComponents;
+        for( int iX = 0; iX < nXCheck; iX++ )
+        {
+            const double dfValue = static_cast<double>(pLine[iX * nComponents]);
+            if( oValidity(dfValue) )
+                oSketch.Add(dfValue);
+        }
+    }
+}
+
+// Add the nXCheck x nYCheck pixels of pData to oAcc.
+static void GDALAddToQuantiles( const GDALQuantileParams& sParams,
+                                const void* pData,
+                                int nXCheck, int nLineStride, int nYCheck,
+                                GDALQuantileAccumulator& oAcc )
+{
+    if( sParams.nMaxValue >= sParams.nMinValue )
+    {
+        if( oAcc.anCounts.empty() )
+            oAcc.anCounts.resize(sParams.nMaxValue - sParams.nMinValue + 1);
+        GUIntBig* panCounts = oAcc.anCounts.data();
+        const int nMinValue = sParams.nMinValue;
+        switch( sParams.eDataType )
+        {
+            case GDT_Byte:
+                if( sParams.bSignedByte )
+                    GDALCountValues<signed char, 1>(
+                        static_cast<const signed char*>(pData),
+                        nXCheck, nLineStride, nYCheck, nMinValue, panCounts);
+                else
+                    GDALCountValues<GByte, 1>(
+                        static_cast<const GByte*>(pData),
+                        nXCheck, nLineStride, nYCheck, nMinValue, panCounts);
+                break;
+            case GDT_UInt16:
+                GDALCountValues<GUInt16, 1>(
+                    static_cast<const GUInt16*>(pData),
+                    nXCheck, nLineStride, nYCheck, nMinValue, panCounts);
+                break;
+            case GDT_Int16:
+                GDALCountValues<GInt16, 1>(
+                    static_cast<const GInt16*>(pData),
+                    nXCheck, nLineStride, nYCheck, nMinValue, panCounts);
+                break;
+            case GDT_CInt16:
+                GDALCountValues<GInt16, 2>(
+                    static_cast<const GInt16*>(pData),
+                    nXCheck, nLineStride, nYCheck, nMinValue, panCounts);
+                break;
+            default:
+                CPLAssert( false );
+                break;
+        }
+        return;
+    }
+
+    const GDALStatsFloat32Validity oFloat32Validity = {
+        sParams.bGotFloatNoDataValue, sParams.fNoDataValue };
+    const GDALStatsFloat64Validity oFloat64Validity = {
+        sParams.bGotNoDataValue, sParams.dfNoDataValue };
+    switch( sParams.eDataType )
+    {
+        case GDT_UInt32:
+            GDALAddToSketch<GUInt32, 1>(
+                static_cast<const GUInt32*>(pData),
+                nXCheck, nLineStride, nYCheck,
+                oFloat64Validity, oAcc.oSketch);
+            break;
+        case GDT_Int32:
+            GDALAddToSketch<GInt32, 1>(
+                static_cast<const GInt32*>(pData),
+                nXCheck, nLineStride, nYCheck,
+                oFloat64Validity, oAcc.oSketch);
+            break;
+        case GDT_Float32:
+            GDALAddToSketch<float, 1>(
+                static_cast<const float*>(pData),
+                nXCheck, nLineStride, nYCheck,
+                oFloat32Validity, oAcc.oSketch);
+            break;
+        case GDT_Float64:
+            GDALAddToSketch<double, 1>(
+                static_cast<const double*>(pData),
+                nXCheck, nLineStride, nYCheck,
+                oFloat64Validity, oAcc.oSketch);
+            break;
+        case GDT_CInt32:
+            GDALAddToSketch<GInt32, 2>(
+                static_cast<const GInt32*>(pData),
+                nXCheck, nLineStride, nYCheck,
+                oFloat64Validity, oAcc.oSketch);
+            break;
+        case GDT_CFloat32:
+            GDALAddToSketch<float, 2>(
+                static_cast<const float*>(pData),
+                nXCheck, nLineStride, nYCheck,
+                oFloat64Validity, oAcc.oSketch);
+            break;
+        case GDT_CFloat64:
+            GDALAddToSketch<double, 2>(
+                static_cast<const double*>(pData),
+                nXCheck, nLineStride, nYCheck,
+                oFloat64Validity, oAcc.oSketch);
+            break;
+        default:
+            CPLAssert( false );
+            break;
+    }
 }
 
 /************************************************************************/
-/*                        ComputeRasterMinMax()                         */
+/*                       ComputeRasterQuantiles()                       */
 /************************************************************************/
 
 /**
- * \brief Compute the min/max values for a band.
+ * \brief Compute quantiles of the pixel values of a band.
  *
- * If approximate is OK, then the band's GetMinimum()/GetMaximum() will
- * be trusted.  If it doesn't work, a subsample of blocks will be read to
- * get an approximate min/max.  If the band has a nodata value it will
- * be excluded from the minimum and maximum.
+ * For each probability p of padfProbabilities, the returned quantile is
+ * the smallest pixel value such that a proportion of at least p of the
+ * valid pixels are lower or equal to it. For instance, probabilities of
+ * 0.02 and 0.98 return the bounds of a 2%-98% contrast stretch.
  *
- * If bApprox is FALSE, then all pixels will be read and used to compute
- * an exact range.
+ * Nodata and NaN pixels are ignored. For complex types, the real part of
+ * the values is used.
  *
- * This method is the same as the C function GDALComputeRasterMinMax().
+ * The quantiles are exact for the Byte, UInt16, Int16 and CInt16 data
+ * types. For other data types, they are computed in a single pass over the
+ * data with a bounded memory sketch, and are approximate: the rank error
+ * is typically below 0.5%, and the minimum and maximum are exact.
  *
- * @param bApproxOK TRUE if an approximate (faster) answer is OK, otherwise
- * FALSE.
- * @param adfMinMax the array in which the minimum (adfMinMax[0]) and the
- * maximum (adfMinMax[1]) are returned.
+ * If bApproxOK is TRUE, overviews or a subset of the tiles may be used, as
+ * for ComputeStatistics(). Blocks are processed by several worker threads
+ * when the GDAL_NUM_THREADS configuration option is set to a number of
+ * threads or ALL_CPUS.
  *
- * @return CE_None on success or CE_Failure on failure.
+ * This method is the same as the C function GDALComputeRasterQuantiles().
+ *
+ * @param bApproxOK If TRUE quantiles may be computed based on overviews
+ * or a subset of all tiles.
+ *
+ * @param nQuantiles Number of quantiles to compute.
+ *
+ * @param padfProbabilities Array of nQuantiles probabilities, each in the
+ * [0,1] range.
+ *
+ * @param padfQuantiles Array of nQuantiles values into which the quantiles
+ * are loaded.
+ *
+ * @param pfnProgress a function to call to report progress, or NULL.
+ *
+ * @param pProgressData application data to pass to the progress function.
+ *
+ * @return CE_None on success, or CE_Failure if an error occurs, no valid
+ * pixel is found, or processing is terminated by the user.
+ *
+ * @since GDAL 3.1
  */
 
-CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
-                                            double* adfMinMax )
+CPLErr GDALRasterBand::ComputeRasterQuantiles( int bApproxOK,
+                                               int nQuantiles,
+                                               const double* padfProbabilities,
+                                               double* padfQuantiles,
+                                               GDALProgressFunc pfnProgress,
+                                               void* pProgressData )
+
 {
-    double dfMin = 0.0;
-    double dfMax = 0.0;
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
 
-/* -------------------------------------------------------------------- */
-/*      Does the driver already know the min/max?                       */
-/* -------------------------------------------------------------------- */
-    if( bApproxOK )
+    if( nQuantiles <= 0 || padfProbabilities == nullptr ||
+        padfQuantiles == nullptr )
     {
-        int bSuccessMin = FALSE;
-        int bSuccessMax = FALSE;
-
-        dfMin = GetMinimum( &bSuccessMin );
-        dfMax = GetMaximum( &bSuccessMax );
-
-        if( bSuccessMin && bSuccessMax )
+        ReportError( CE_Failure, CPLE_IllegalArg,
+                     "Invalid arguments to ComputeRasterQuantiles()" );
+        return CE_Failure;
+    }
+    for( int i = 0; i < nQuantiles; i++ )
+    {
+        if( !(padfProbabilities[i] >= 0.0 && padfProbabilities[i] <= 1.0) )
         {
-            adfMinMax[0] = dfMin;
-            adfMinMax[1] = dfMax;
-            return CE_None;
+            ReportError( CE_Failure, CPLE_IllegalArg,
+                         "Probability %g is not in the [0,1] range",
+                         padfProbabilities[i] );
+            return CE_Failure;
         }
     }
 
 /* -------------------------------------------------------------------- */
-/*      If we have overview bands, use them for min/max.                */
+/*      If we have overview bands, use them for quantiles.              */
 /* -------------------------------------------------------------------- */
-    // cppcheck-suppress knownConditionTrueFalse
-    if ( bApproxOK && GetOverviewCount() > 0 && !HasArbitraryOverviews() )
+    if( bApproxOK && GetOverviewCount() > 0 && !HasArbitraryOverviews() )
     {
-        GDALRasterBand *poBand =
-          GetRasterSampleOverview( GDALSTAT_APPROX_NUMSAMPLES );
+        GDALRasterBand *poBand
+            = GetRasterSampleOverview( GDALSTAT_APPROX_NUMSAMPLES );
 
-        if ( poBand != this )
-            return poBand->ComputeRasterMinMax( FALSE, adfMinMax );
+        if( poBand != this )
+        {
+            return poBand->ComputeRasterQuantiles( FALSE, nQuantiles,
+                                                   padfProbabilities,
+                                                   padfQuantiles,
+                                                   pfnProgress,
+                                                   pProgressData );
+        }
     }
 
-/* -------------------------------------------------------------------- */
-/*      Read actual data and compute minimum and maximum.               */
-/* -------------------------------------------------------------------- */
+    if( !pfnProgress( 0.0, "Compute Quantiles", pProgressData ) )
+    {
+        ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+
     int bGotNoDataValue = FALSE;
     const double dfNoDataValue = GetNoDataValue( &bGotNoDataValue );
     bGotNoDataValue = bGotNoDataValue && !CPLIsNan(dfNoDataValue);
@@ -5518,17 +6485,49 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
     const bool bSignedByte =
         pszPixelType != nullptr && EQUAL(pszPixelType, "SIGNEDBYTE");
 
-    GDALRasterIOExtraArg sExtraArg;
-    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    GDALQuantileParams sParams;
+    sParams.eDataType = eDataType;
+    sParams.bSignedByte = bSignedByte;
+    sParams.bGotNoDataValue = CPL_TO_BOOL(bGotNoDataValue);
+    sParams.dfNoDataValue = dfNoDataValue;
+    sParams.bGotFloatNoDataValue = bGotFloatNoDataValue;
+    sParams.fNoDataValue = fNoDataValue;
+    sParams.nMinValue = 0;
+    sParams.nMaxValue = -1;
+    if( eDataType == GDT_Byte )
+    {
+        sParams.nMinValue = bSignedByte ? -128 : 0;
+        sParams.nMaxValue = bSignedByte ? 127 : 255;
+    }
+    else if( eDataType == GDT_UInt16 )
+    {
+        sParams.nMaxValue = 65535;
+    }
+    else if( eDataType == GDT_Int16 || eDataType == GDT_CInt16 )
+    {
+        sParams.nMinValue = -32768;
+        sParams.nMaxValue = 32767;
+    }
+
+    std::vector<GDALQuantileAccumulator> aoAccs;
+    try
+    {
+        aoAccs.resize(GDALGetPartialResultCount());
+    }
+    catch( const std::exception& )
+    {
+        ReportError( CE_Failure, CPLE_OutOfMemory,
+                     "Out of memory in ComputeRasterQuantiles()" );
+        return CE_Failure;
+    }
 
-    bool bFirstValue = true;
     if ( bApproxOK && HasArbitraryOverviews() )
     {
 /* -------------------------------------------------------------------- */
 /*      Figure out how much the image should be reduced to get an       */
 /*      approximate value.                                              */
 /* -------------------------------------------------------------------- */
-        double  dfReduction = sqrt(
+        const double dfReduction = sqrt(
             static_cast<double>(nRasterXSize) * nRasterYSize /
             GDALSTAT_APPROX_NUMSAMPLES );
 
@@ -5546,9 +6545,11 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
                 nYReduced = 1;
         }
 
-        void * const pData =
-            CPLMalloc(
-                GDALGetDataTypeSizeBytes(eDataType) * nXReduced * nYReduced );
+        void *pData =
+            VSI_MALLOC3_VERBOSE(
+                GDALGetDataTypeSizeBytes(eDataType), nXReduced, nYReduced );
+        if( pData == nullptr )
+            return CE_Failure;
 
         const CPLErr eErr = IRasterIO(
             GF_Read, 0, 0, nRasterXSize, nRasterYSize, pData,
@@ -5559,43 +6560,12 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
             return eErr;
         }
 
-        /* this isn't the fastest way to do this, but is easier for now */
-        for( int iY = 0; iY < nYReduced; iY++ )
-        {
-            for( int iX = 0; iX < nXReduced; iX++ )
-            {
-                const int iOffset = iX + iY * nXReduced;
-                bool bValid = true;
-                double dfValue = GetPixelValue( eDataType,
-                                                bSignedByte,
-                                                pData,
-                                                iOffset,
-                                                CPL_TO_BOOL(bGotNoDataValue),
-                                                dfNoDataValue,
-                                                bGotFloatNoDataValue,
-                                                fNoDataValue,
-                                                bValid );
-                if( !bValid )
-                    continue;
-
-                if( bFirstValue )
-                {
-                    dfMin = dfValue;
-                    dfMax = dfValue;
-                    bFirstValue = false;
-                }
-                else
-                {
-                    dfMin = std::min(dfMin, dfValue);
-                    dfMax = std::max(dfMax, dfValue);
-                }
-            }
-        }
+        GDALAddToQuantiles( sParams, pData, nXReduced, nXReduced, nYReduced,
+                            aoAccs[0] );
 
-        CPLFree( pData );
+        CPLFree(pData);
     }
-
-    else  // No arbitrary overviews
+    else  // No arbitrary overviews.
     {
         if( !InitBlockInfo() )
             return CE_Failure;
@@ -5605,7 +6575,6 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
 /*      approximate value.                                              */
 /* -------------------------------------------------------------------- */
         int nSampleRate = 1;
-
         if ( bApproxOK )
         {
             nSampleRate = static_cast<int>(
@@ -5619,67 +6588,88 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
               nSampleRate += 1;
         }
 
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
-        {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
+        std::vector<GDALQuantileAccumulator*> apoAccs;
+        for( auto& oAcc: aoAccs )
+            apoAccs.push_back(&oAcc);
+        GDALPartialResults<GDALQuantileAccumulator> oPartials(apoAccs);
 
-            void * const pData = poBlock->GetDataRef();
+        const int nBlockXSizeLocal = nBlockXSize;
+        const CPLErr eErr = GDALForEachSampledBlock(
+            this, nSampleRate,
+            [&oPartials, &sParams, nBlockXSizeLocal](
+                        size_t, const void* pData, int nXCheck, int nYCheck)
+            {
+                GDALQuantileAccumulator* poAcc = oPartials.Acquire();
+                GDALAddToQuantiles( sParams, pData,
+                                    nXCheck, nBlockXSizeLocal, nYCheck,
+                                    *poAcc );
+                oPartials.Release(poAcc);
+            },
+            pfnProgress, pProgressData, "Compute Quantiles" );
+        if( eErr != CE_None )
+            return eErr;
+    }
 
-            int nXCheck = 0, nYCheck = 0;
-            GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
+/* -------------------------------------------------------------------- */
+/*      Merge the partial results and extract the quantiles.            */
+/* -------------------------------------------------------------------- */
+    GUIntBig nValidCount = 0;
+    if( sParams.nMaxValue >= sParams.nMinValue )
+    {
+        std::vector<GUIntBig> anCounts(
+            sParams.nMaxValue - sParams.nMinValue + 1);
+        for( const auto& oAcc: aoAccs )
+        {
+            for( size_t i = 0; i < oAcc.anCounts.size(); i++ )
+                anCounts[i] += oAcc.anCounts[i];
+        }
+        for( int nValue = sParams.nMinValue;
+             nValue <= sParams.nMaxValue; nValue++ )
+        {
+            GUIntBig& nCount = anCounts[nValue - sParams.nMinValue];
+            if( bGotNoDataValue &&
+                ARE_REAL_EQUAL(static_cast<double>(nValue), dfNoDataValue) )
+                nCount = 0;
+            nValidCount += nCount;
+        }
 
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
+        for( int i = 0; nValidCount > 0 && i < nQuantiles; i++ )
+        {
+            const double dfTarget = std::max(1.0,
+                padfProbabilities[i] * static_cast<double>(nValidCount));
+            GUIntBig nCumCount = 0;
+            for( int nValue = sParams.nMinValue;
+                 nValue <= sParams.nMaxValue; nValue++ )
             {
-                for( int iX = 0; iX < nXCheck; iX++ )
+                nCumCount += anCounts[nValue - sParams.nMinValue];
+                if( static_cast<double>(nCumCount) >= dfTarget )
                 {
-                    const GPtrDiff_t iOffset = iX + static_cast<GPtrDiff_t>(iY) * nBlockXSize;
-                    bool bValid = true;
-                    double dfValue = GetPixelValue( eDataType,
-                                                    bSignedByte,
-                                                    pData,
-                                                    iOffset,
-                                                    CPL_TO_BOOL(bGotNoDataValue),
-                                                    dfNoDataValue,
-                                                    bGotFloatNoDataValue,
-                                                    fNoDataValue,
-                                                    bValid );
-                    if( !bValid )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
+                    padfQuantiles[i] = nValue;
+                    break;
                 }
             }
-
-            poBlock->DropLock();
         }
     }
+    else
+    {
+        for( size_t i = 1; i < aoAccs.size(); i++ )
+            aoAccs[0].oSketch.Merge(aoAccs[i].oSketch);
+        nValidCount = aoAccs[0].oSketch.GetCount();
+        aoAccs[0].oSketch.GetQuantiles(nQuantiles, padfProbabilities,
+                                       padfQuantiles);
+    }
 
-    adfMinMax[0] = dfMin;
-    adfMinMax[1] = dfMax;
-
-    if (bFirstValue)
+    if( nValidCount == 0 )
     {
         ReportError(
             CE_Failure, CPLE_AppDefined,
-            "Failed to compute min/max, no valid pixels found in sampling." );
+            "Failed to compute quantiles, no valid pixels found in sampling." );
+        return CE_Failure;
+    }
+
+    if( !pfnProgress( 1.0, "Compute Quantiles", pProgressData ) )
+    {
+        ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
         return CE_Failure;
     }
 
@@ -5687,24 +6677,31 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
 }
 
 /************************************************************************/
-/*                      GDALComputeRasterMinMax()                       */
+/*                     GDALComputeRasterQuantiles()                     */
 /************************************************************************/
 
 /**
- * \brief Compute the min/max values for a band.
+ * \brief Compute quantiles of the pixel values of a band.
  *
- * @see GDALRasterBand::ComputeRasterMinMax()
+ * @see GDALRasterBand::ComputeRasterQuantiles()
+ *
+ * @since GDAL 3.1
  */
 
-void CPL_STDCALL
-GDALComputeRasterMinMax( GDALRasterBandH hBand, int bApproxOK,
-                         double adfMinMax[2] )
+CPLErr CPL_STDCALL
+GDALComputeRasterQuantiles( GDALRasterBandH hBand, int bApproxOK,
+                            int nQuantiles, const double* padfProbabilities,
+                            double* padfQuantiles,
+                            GDALProgressFunc pfnProgress,
+                            void *pProgressData )
 
 {
-    VALIDATE_POINTER0( hBand, "GDALComputeRasterMinMax" );
+    VALIDATE_POINTER1( hBand, "GDALComputeRasterQuantiles", CE_Failure );
 
     GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
-    poBand->ComputeRasterMinMax( bApproxOK, adfMinMax );
+    return poBand->ComputeRasterQuantiles( bApproxOK, nQuantiles,
+                                           padfProbabilities, padfQuantiles,
+                                           pfnProgress, pProgressData );
 }
 
 /************************************************************************/
@@ -6822,6 +7819,9 @@ int CPL_STDCALL GDALGetDataCoverageStatus( GDALRasterBandH hBand,
  * GDAL_DATA_COVERAGE_STATUS_UNIMPLEMENTED | GDAL_DATA_COVERAGE_STATUS_DATA will
  * be returned.
  *
+ * The MEM driver, whose pixel values are already in memory, does check them
+ * (starting with GDAL 3.1).
+ *
  * The values that can be returned by the function are the following,
  * potentially combined with the binary or operator :
  * <ul>
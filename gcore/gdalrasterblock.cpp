@@ -33,14 +33,18 @@
 #include "gdal_priv.h"
 
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstring>
+#include <map>
+#include <vector>
 
 #include "cpl_atomic_ops.h"
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
+#include "cpl_trace.h"
 #include "cpl_vsi.h"
 
 CPL_CVSID("$Id: gdalrasterblock.cpp c590dcec36eb6dcd7c5451623b859e7227475b44 2019-11-13 16:36:03 +0100 Even Rouault $")
@@ -55,6 +59,36 @@ static GDALRasterBlock *poNewest = nullptr;  // Head.
 
 static int nDisableDirtyBlockFlushCounter = 0;
 
+// Statistics, only collected if GDAL_CACHE_STATISTICS=YES.
+static bool bCacheStatistics = false;
+static std::atomic<GIntBig> nStatLookups(0);
+static std::atomic<GIntBig> nStatHits(0);
+static std::atomic<GIntBig> nStatEvictions(0);
+static std::atomic<GIntBig> nStatDirtyWriteBacks(0);
+
+// Optional per-dataset and per-driver block cache quotas.
+// Protected by hRBLock.
+namespace {
+struct GDALBlockCacheQuota
+{
+    GIntBig nMax = 0;
+    GIntBig nUsed = 0;
+};
+}
+
+static std::map<GDALDataset*, GDALBlockCacheQuota>* poMapDatasetQuotas =
+                                                                    nullptr;
+// Indexed by upper-cased driver short name (from GDAL_CACHEMAX_PER_DRIVER).
+static std::map<CPLString, GDALBlockCacheQuota>* poMapDriverQuotas = nullptr;
+
+// Optional pool of the buffers of freed blocks, indexed by their size, so
+// that they can be reused by Internalize() without going through the
+// allocator. Its maximum size is set by GDAL_RB_BUFFER_POOL_SIZE, and is
+// not accounted in GDAL_CACHEMAX. Protected by hRBLock.
+static std::map<size_t, std::vector<void*>>* poMapBufferPool = nullptr;
+static GIntBig nBufferPoolMax = 0;
+static GIntBig nBufferPoolUsed = 0;
+
 #if 0
 static CPLMutex *hRBLock = nullptr;
 #define INITIALIZE_LOCK CPLMutexHolderD( &hRBLock )
@@ -65,6 +99,10 @@ static CPLMutex *hRBLock = nullptr;
 static CPLLock* hRBLock = nullptr;
 static bool bDebugContention = false;
 static bool bSleepsForBockCacheDebug = false;
+// Set from GDAL_RB_EVICTION_POLICY=CLOCK. In that mode, Touch() only sets
+// the reference bit of the block without taking hRBLock, and blocks are
+// given a second chance at eviction time if they have been referenced.
+static bool bClockEviction = false;
 static CPLLockType GetLockType()
 {
     static int nLockType = -1;
@@ -101,6 +139,145 @@ static CPLLockType GetLockType()
 
 //#define ENABLE_DEBUG
 
+/************************************************************************/
+/*                    ReadBlockCacheConfigOptions()                     */
+/************************************************************************/
+
+// Reads the configuration options that control the behaviour of the block
+// cache, once nCacheMax has been initialized.
+static void ReadBlockCacheConfigOptions()
+{
+    static bool bConfigOptionsRead = false;
+    if( bConfigOptionsRead )
+        return;
+    bConfigOptionsRead = true;
+
+    bCacheStatistics = CPLTestBool(
+        CPLGetConfigOption("GDAL_CACHE_STATISTICS", "NO"));
+
+    const char* pszBufferPoolSize =
+        CPLGetConfigOption("GDAL_RB_BUFFER_POOL_SIZE", nullptr);
+    if( pszBufferPoolSize != nullptr )
+        nBufferPoolMax = GDALRasterBlock::ParseCacheQuota(pszBufferPoolSize);
+
+    const char* pszEvictionPolicy =
+        CPLGetConfigOption("GDAL_RB_EVICTION_POLICY", "LRU");
+    if( EQUAL(pszEvictionPolicy, "CLOCK") )
+        bClockEviction = true;
+    else if( !EQUAL(pszEvictionPolicy, "LRU") )
+    {
+        CPLError(
+            CE_Warning, CPLE_NotSupported,
+            "GDAL_RB_EVICTION_POLICY=%s not supported. Falling back to LRU",
+            pszEvictionPolicy);
+    }
+
+    // Comma separated list of DRIVER=value, where value has the same
+    // syntax as the CACHEMAX open option.
+    const char* pszDriverQuotas =
+        CPLGetConfigOption("GDAL_CACHEMAX_PER_DRIVER", nullptr);
+    if( pszDriverQuotas != nullptr )
+    {
+        char** papszTokens = CSLTokenizeString2(pszDriverQuotas, ",", 0);
+        for( char** papszIter = papszTokens; papszIter && *papszIter;
+             ++papszIter )
+        {
+            char* pszKey = nullptr;
+            const char* pszValue = CPLParseNameValue(*papszIter, &pszKey);
+            const GIntBig nMax = pszKey && pszValue ?
+                GDALRasterBlock::ParseCacheQuota(pszValue) : 0;
+            if( nMax > 0 )
+            {
+                if( poMapDriverQuotas == nullptr )
+                    poMapDriverQuotas =
+                        new std::map<CPLString, GDALBlockCacheQuota>();
+                (*poMapDriverQuotas)[CPLString(pszKey).toupper()].nMax = nMax;
+            }
+            else
+            {
+                CPLError(CE_Warning, CPLE_IllegalArg,
+                         "Invalid value in GDAL_CACHEMAX_PER_DRIVER: %s",
+                         *papszIter);
+            }
+            CPLFree(pszKey);
+        }
+        CSLDestroy(papszTokens);
+    }
+}
+
+/************************************************************************/
+/*                          ReleaseBlockData()                          */
+/************************************************************************/
+
+// Free the buffer of a block, or keep it in the buffer pool if it is
+// enabled and not full.
+static void ReleaseBlockData( void* pData, GPtrDiff_t nBlockSize )
+{
+    if( pData == nullptr )
+        return;
+    if( nBufferPoolMax > 0 )
+    {
+        const size_t nSize = static_cast<size_t>(nBlockSize);
+        TAKE_LOCK;
+        if( nBufferPoolUsed + static_cast<GIntBig>(nSize) <= nBufferPoolMax )
+        {
+            if( poMapBufferPool == nullptr )
+                poMapBufferPool = new std::map<size_t, std::vector<void*>>();
+            try
+            {
+                (*poMapBufferPool)[nSize].push_back(pData);
+                nBufferPoolUsed += nSize;
+                return;
+            }
+            catch( const std::exception& )
+            {
+            }
+        }
+    }
+    VSIFreeAligned(pData);
+}
+
+/************************************************************************/
+/*                          AcquireBlockData()                          */
+/************************************************************************/
+
+// Return a buffer of the exact requested size from the buffer pool, or
+// nullptr.
+static void* AcquireBlockData( GPtrDiff_t nBlockSize )
+{
+    if( nBufferPoolMax <= 0 )
+        return nullptr;
+    const size_t nSize = static_cast<size_t>(nBlockSize);
+    TAKE_LOCK;
+    if( poMapBufferPool == nullptr )
+        return nullptr;
+    auto oIter = poMapBufferPool->find(nSize);
+    if( oIter == poMapBufferPool->end() || oIter->second.empty() )
+        return nullptr;
+    void* pData = oIter->second.back();
+    oIter->second.pop_back();
+    nBufferPoolUsed -= nSize;
+    return pData;
+}
+
+/************************************************************************/
+/*                           FreeBufferPool()                           */
+/************************************************************************/
+
+static void FreeBufferPool()
+{
+    if( poMapBufferPool == nullptr )
+        return;
+    for( auto& oIter: *poMapBufferPool )
+    {
+        for( void* pData: oIter.second )
+            VSIFreeAligned(pData);
+    }
+    delete poMapBufferPool;
+    poMapBufferPool = nullptr;
+    nBufferPoolUsed = 0;
+}
+
 /************************************************************************/
 /*                          GDALSetCacheMax()                           */
 /************************************************************************/
@@ -159,6 +336,7 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
     }
     bCacheMaxInitialized = true;
     nCacheMax = nNewSizeInBytes;
+    ReadBlockCacheConfigOptions();
 
 /* -------------------------------------------------------------------- */
 /*      Flush blocks till we are under the new limit or till we         */
@@ -306,6 +484,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
         CPLDebug( "GDAL", "GDAL_CACHEMAX = " CPL_FRMT_GIB " MB",
                   nCacheMax / (1024 * 1024));
         bCacheMaxInitialized = true;
+        ReadBlockCacheConfigOptions();
     }
     // coverity[overflow_sink]
     return nCacheMax;
@@ -375,6 +554,57 @@ int CPL_STDCALL GDALFlushCacheBlock()
     return GDALRasterBlock::FlushCacheBlock();
 }
 
+/************************************************************************/
+/*                       GDALGetCacheStatistics()                       */
+/************************************************************************/
+
+/**
+ * \brief Get statistics on the use of the block cache.
+ *
+ * Statistics are only collected when the GDAL_CACHE_STATISTICS configuration
+ * option is set to YES before the block cache is first used, in which case
+ * they are also reported as a debug message by GDALDestroyDriverManager().
+ * Otherwise only nBytesResident is set.
+ *
+ * The statistics are process-wide, and accumulated since the start of the
+ * process or the last call to GDALResetCacheStatistics().
+ *
+ * @param psStats structure to fill. Must not be NULL.
+ *
+ * @since GDAL 3.1
+ */
+
+void GDALGetCacheStatistics( GDALCacheStatistics* psStats )
+{
+    VALIDATE_POINTER0( psStats, "GDALGetCacheStatistics" );
+
+    psStats->nLookups = nStatLookups;
+    psStats->nHits = nStatHits;
+    psStats->nMisses = psStats->nLookups - psStats->nHits;
+    psStats->nEvictions = nStatEvictions;
+    psStats->nDirtyWriteBacks = nStatDirtyWriteBacks;
+    psStats->nBytesResident = nCacheUsed;
+}
+
+/************************************************************************/
+/*                      GDALResetCacheStatistics()                      */
+/************************************************************************/
+
+/**
+ * \brief Reset the counters of the block cache statistics.
+ *
+ * @see GDALGetCacheStatistics()
+ * @since GDAL 3.1
+ */
+
+void GDALResetCacheStatistics()
+{
+    nStatLookups = 0;
+    nStatHits = 0;
+    nStatEvictions = 0;
+    nStatDirtyWriteBacks = 0;
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*                           GDALRasterBlock                            */
@@ -436,9 +666,13 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
     {
         INITIALIZE_LOCK;
         poTarget = poOldest;
+        GDALRasterBlock* poClockLimit =
+            (bClockEviction && !bDirtyBlocksOnly) ? poNewest : nullptr;
 
         while( poTarget != nullptr )
         {
+            if( GiveSecondChance_unlocked(poTarget, poClockLimit) )
+                continue;
             if( !bDirtyBlocksOnly ||
                 (poTarget->GetDirty() && nDisableDirtyBlockFlushCounter == 0) )
             {
@@ -465,6 +699,9 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
         poTarget->GetBand()->UnreferenceBlock(poTarget);
     }
 
+    if( bCacheStatistics )
+        nStatEvictions.fetch_add(1, std::memory_order_relaxed);
+
     if( bSleepsForBockCacheDebug )
     {
         // coverity[tainted_data]
@@ -484,7 +721,7 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
         }
     }
 
-    VSIFreeAligned(poTarget->pData);
+    ReleaseBlockData(poTarget->pData, poTarget->GetBlockSize());
     poTarget->pData = nullptr;
     poTarget->GetBand()->AddBlockToFreeList(poTarget);
 
@@ -593,7 +830,10 @@ GDALRasterBlock::GDALRasterBlock( GDALRasterBand *poBandIn,
     poBand(poBandIn),
     poNext(nullptr),
     poPrevious(nullptr),
-    bMustDetach(true)
+    bMustDetach(true),
+    bTouched(false),
+    bInDatasetQuota(false),
+    bInDriverQuota(false)
 {
     CPLAssert( poBandIn != nullptr );
     poBand->GetBlockSize( &nXSize, &nYSize );
@@ -629,7 +869,10 @@ GDALRasterBlock::GDALRasterBlock( int nXOffIn, int nYOffIn ) :
     poBand(nullptr),
     poNext(nullptr),
     poPrevious(nullptr),
-    bMustDetach(false)
+    bMustDetach(false),
+    bTouched(false),
+    bInDatasetQuota(false),
+    bInDriverQuota(false)
 {}
 
 /************************************************************************/
@@ -655,6 +898,9 @@ void GDALRasterBlock::RecycleFor( int nXOffIn, int nYOffIn )
     nXOff = nXOffIn;
     nYOff = nYOffIn;
     bMustDetach = true;
+    bTouched.store(false, std::memory_order_relaxed);
+    bInDatasetQuota = false;
+    bInDriverQuota = false;
 }
 
 /************************************************************************/
@@ -674,7 +920,7 @@ GDALRasterBlock::~GDALRasterBlock()
 
     if( pData != nullptr )
     {
-        VSIFreeAligned( pData );
+        ReleaseBlockData( pData, GetBlockSize() );
     }
 
     CPLAssert( nLockCount <= 0 );
@@ -744,6 +990,8 @@ void GDALRasterBlock::Detach_unlocked()
 
     if( pData )
         nCacheUsed -= GetEffectiveBlockSize(GetBlockSize());
+    if( bInDatasetQuota || bInDriverQuota )
+        DischargeQuotas_unlocked(GetEffectiveBlockSize(GetBlockSize()));
 
 #ifdef ENABLE_DEBUG
     Verify();
@@ -845,6 +1093,9 @@ CPLErr GDALRasterBlock::Write()
 
     if (poBand->eFlushBlockErr == CE_None)
     {
+        if( bCacheStatistics )
+            nStatDirtyWriteBacks.fetch_add(1, std::memory_order_relaxed);
+        CPL_TRACE_SCOPE("blockcache", "BlockFlush");
         int bCallLeaveReadWrite = poBand->EnterReadWrite(GF_Write);
         CPLErr eErr = poBand->IWriteBlock( nXOff, nYOff, pData );
         if( bCallLeaveReadWrite ) poBand->LeaveReadWrite();
@@ -863,11 +1114,25 @@ CPLErr GDALRasterBlock::Write()
  *
  * This method is normally called when a block is used to keep track
  * that it has been recently used.
+ *
+ * When the GDAL_RB_EVICTION_POLICY configuration option is set to CLOCK,
+ * this method only marks the block as referenced, without taking the global
+ * block cache lock. The block is then moved to the top of the list when it
+ * is next considered for eviction (second chance / CLOCK algorithm).
+ * This reduces lock contention when many threads read from the cache.
  */
 
 void GDALRasterBlock::Touch()
 
 {
+    // With the CLOCK policy, the position in the list is only updated
+    // lazily when the block is considered for eviction.
+    if( bClockEviction )
+    {
+        bTouched.store(true, std::memory_order_relaxed);
+        return;
+    }
+
     // Can be safely tested outside the lock
     if( poNewest == this )
         return;
@@ -921,6 +1186,229 @@ void GDALRasterBlock::Touch_unlocked()
 #endif
 }
 
+/************************************************************************/
+/*                      GiveSecondChance_unlocked()                     */
+/************************************************************************/
+
+/* Used when walking the list from the oldest block for eviction with the
+ * CLOCK policy. If poTarget has been touched since it was last considered,
+ * clear its reference bit, move it to the head of the list, advance
+ * poTarget to the next eviction candidate and return true.
+ * poClockLimit is the head of the list at the start of the walk: once it is
+ * reached, reference bits are no longer honoured so that the walk always
+ * terminates, even if other threads keep touching blocks.
+ */
+bool GDALRasterBlock::GiveSecondChance_unlocked(
+                                        GDALRasterBlock*& poTarget,
+                                        GDALRasterBlock*& poClockLimit )
+{
+    if( poClockLimit == nullptr )
+        return false;
+    if( poTarget == poClockLimit )
+    {
+        poTarget->bTouched.store(false, std::memory_order_relaxed);
+        poClockLimit = nullptr;
+        return false;
+    }
+    if( !poTarget->bTouched.load(std::memory_order_relaxed) )
+        return false;
+
+    GDALRasterBlock* poBlock = poTarget;
+    poTarget = poBlock->poPrevious;
+    poBlock->bTouched.store(false, std::memory_order_relaxed);
+    poBlock->Touch_unlocked();
+    return true;
+}
+
+/************************************************************************/
+/*                          ParseCacheQuota()                           */
+/************************************************************************/
+
+/*! @cond Doxygen_Suppress */
+// Parse a per-dataset or per-driver block cache quota. The value is
+// expressed in MB, or in bytes if greater than 100000, or as a percentage
+// of GDAL_CACHEMAX if suffixed by %. Returns 0 if the value is invalid.
+GIntBig GDALRasterBlock::ParseCacheQuota( const char* pszValue )
+{
+    if( strchr(pszValue, '%') != nullptr )
+    {
+        const double dfPct = CPLAtof(pszValue);
+        if( !(dfPct > 0 && dfPct <= 100) )
+            return 0;
+        return static_cast<GIntBig>(
+            static_cast<double>(GDALGetCacheMax64()) * dfPct / 100.0);
+    }
+    GIntBig nValue = CPLAtoGIntBig(pszValue);
+    if( nValue <= 0 )
+        return 0;
+    if( nValue < 100000 )
+        nValue *= 1024 * 1024;
+    return nValue;
+}
+
+/************************************************************************/
+/*                         SetDatasetCacheMax()                         */
+/************************************************************************/
+
+// Called by GDALDataset::SetBlockCacheMax(). A value of 0 removes the quota.
+// Blocks already in the cache are only accounted for if the quota was
+// already set when they were created.
+void GDALRasterBlock::SetDatasetCacheMax( GDALDataset* poDS,
+                                          GIntBig nMaxBytes )
+{
+    {
+        INITIALIZE_LOCK;
+        if( nMaxBytes > 0 )
+        {
+            if( poMapDatasetQuotas == nullptr )
+                poMapDatasetQuotas =
+                    new std::map<GDALDataset*, GDALBlockCacheQuota>();
+            (*poMapDatasetQuotas)[poDS].nMax = nMaxBytes;
+        }
+        else if( poMapDatasetQuotas != nullptr )
+        {
+            poMapDatasetQuotas->erase(poDS);
+            if( poMapDatasetQuotas->empty() )
+            {
+                delete poMapDatasetQuotas;
+                poMapDatasetQuotas = nullptr;
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                         GetDatasetCacheMax()                         */
+/************************************************************************/
+
+GIntBig GDALRasterBlock::GetDatasetCacheMax( GDALDataset* poDS )
+{
+    INITIALIZE_LOCK;
+    if( poMapDatasetQuotas == nullptr )
+        return 0;
+    auto oIter = poMapDatasetQuotas->find(poDS);
+    return oIter == poMapDatasetQuotas->end() ? 0 : oIter->second.nMax;
+}
+/*! @endcond */
+
+/************************************************************************/
+/*                            RecordLookup()                            */
+/************************************************************************/
+
+/*! @cond Doxygen_Suppress */
+void GDALRasterBlock::RecordLookup( bool bHit )
+{
+    if( !bCacheStatistics )
+        return;
+    nStatLookups.fetch_add(1, std::memory_order_relaxed);
+    if( bHit )
+        nStatHits.fetch_add(1, std::memory_order_relaxed);
+}
+/*! @endcond */
+
+/************************************************************************/
+/*                       ChargeQuotas_unlocked()                        */
+/************************************************************************/
+
+// Account the memory of the block into the quota of its dataset and/or
+// driver, if any.
+void GDALRasterBlock::ChargeQuotas_unlocked( size_t nBytes )
+{
+    GDALDataset* poDS = poBand->GetDataset();
+    if( poDS == nullptr )
+        return;
+    if( poMapDatasetQuotas != nullptr )
+    {
+        auto oIter = poMapDatasetQuotas->find(poDS);
+        if( oIter != poMapDatasetQuotas->end() )
+        {
+            oIter->second.nUsed += nBytes;
+            bInDatasetQuota = true;
+        }
+    }
+    if( poMapDriverQuotas != nullptr && poDS->poDriver != nullptr )
+    {
+        auto oIter = poMapDriverQuotas->find(
+            CPLString(poDS->poDriver->GetDescription()).toupper());
+        if( oIter != poMapDriverQuotas->end() )
+        {
+            oIter->second.nUsed += nBytes;
+            bInDriverQuota = true;
+        }
+    }
+}
+
+/************************************************************************/
+/*                      DischargeQuotas_unlocked()                      */
+/************************************************************************/
+
+void GDALRasterBlock::DischargeQuotas_unlocked( size_t nBytes )
+{
+    GDALDataset* poDS = poBand->GetDataset();
+    if( bInDatasetQuota && poMapDatasetQuotas != nullptr )
+    {
+        auto oIter = poMapDatasetQuotas->find(poDS);
+        if( oIter != poMapDatasetQuotas->end() )
+            oIter->second.nUsed -= nBytes;
+    }
+    if( bInDriverQuota && poMapDriverQuotas != nullptr )
+    {
+        auto oIter = poMapDriverQuotas->find(
+            CPLString(poDS->poDriver->GetDescription()).toupper());
+        if( oIter != poMapDriverQuotas->end() )
+            oIter->second.nUsed -= nBytes;
+    }
+    bInDatasetQuota = false;
+    bInDriverQuota = false;
+}
+
+/************************************************************************/
+/*                       IsOverQuota_unlocked()                         */
+/************************************************************************/
+
+// Whether the dataset (bDatasetQuota = true) or driver quota this block is
+// charged to is exceeded. If so, poQuotaDS or poQuotaDriver is set to
+// identify the blocks sharing that quota.
+bool GDALRasterBlock::IsOverQuota_unlocked( bool bDatasetQuota,
+                                            GDALDataset*& poQuotaDS,
+                                            GDALDriver*& poQuotaDriver ) const
+{
+    GDALDataset* poDS = poBand->GetDataset();
+    if( bDatasetQuota )
+    {
+        if( !bInDatasetQuota || poMapDatasetQuotas == nullptr )
+            return false;
+        auto oIter = poMapDatasetQuotas->find(poDS);
+        if( oIter == poMapDatasetQuotas->end() ||
+            oIter->second.nUsed <= oIter->second.nMax )
+            return false;
+        poQuotaDS = poDS;
+        return true;
+    }
+
+    if( !bInDriverQuota || poMapDriverQuotas == nullptr )
+        return false;
+    auto oIter = poMapDriverQuotas->find(
+        CPLString(poDS->poDriver->GetDescription()).toupper());
+    if( oIter == poMapDriverQuotas->end() ||
+        oIter->second.nUsed <= oIter->second.nMax )
+        return false;
+    poQuotaDriver = poDS->poDriver;
+    return true;
+}
+
+/************************************************************************/
+/*                       IsInQuotaOf_unlocked()                         */
+/************************************************************************/
+
+bool GDALRasterBlock::IsInQuotaOf_unlocked( GDALDataset* poQuotaDS,
+                                            GDALDriver* poQuotaDriver ) const
+{
+    if( poQuotaDS != nullptr )
+        return bInDatasetQuota && poBand->GetDataset() == poQuotaDS;
+    return bInDriverQuota && poBand->GetDataset()->poDriver == poQuotaDriver;
+}
+
 /************************************************************************/
 /*                            Internalize()                             */
 /************************************************************************/
@@ -965,9 +1453,63 @@ CPLErr GDALRasterBlock::Internalize()
             TAKE_LOCK;
 
             if( bFirstIter )
+            {
                 nCacheUsed += GetEffectiveBlockSize(nSizeInBytes);
+                if( poMapDatasetQuotas || poMapDriverQuotas )
+                    ChargeQuotas_unlocked(GetEffectiveBlockSize(nSizeInBytes));
+            }
+
+            // Enforce first the per-dataset and then the per-driver quotas,
+            // by evicting the least recently used blocks charged to the
+            // same quota as this block.
+            for( int iQuota = 0; iQuota < 2 && !bLoopAgain; ++iQuota )
+            {
+                const bool bDatasetQuota = iQuota == 0;
+                GDALDataset* poQuotaDS = nullptr;
+                GDALDriver* poQuotaDriver = nullptr;
+                if( !IsOverQuota_unlocked(bDatasetQuota, poQuotaDS,
+                                          poQuotaDriver) )
+                    continue;
+
+                GDALRasterBlock *poQuotaTarget = poOldest;
+                while( poQuotaTarget != nullptr )
+                {
+                    GDALRasterBlock* poNextTarget = poQuotaTarget->poPrevious;
+                    // As in the global eviction below, only evict dirty
+                    // blocks of this dataset.
+                    if( poQuotaTarget->IsInQuotaOf_unlocked(poQuotaDS,
+                                                            poQuotaDriver) &&
+                        (!poQuotaTarget->GetDirty() ||
+                         (nDisableDirtyBlockFlushCounter == 0 &&
+                          poQuotaTarget->poBand->GetDataset() == poThisDS)) &&
+                        CPLAtomicCompareAndExchange(
+                            &(poQuotaTarget->nLockCount), 0, -1) )
+                    {
+                        poQuotaTarget->Detach_unlocked();
+                        poQuotaTarget->GetBand()->UnreferenceBlock(
+                                                            poQuotaTarget);
+                        apoBlocksToFree[nBlocksToFree++] = poQuotaTarget;
+
+                        const bool bStillOverQuota =
+                            IsOverQuota_unlocked(bDatasetQuota, poQuotaDS,
+                                                 poQuotaDriver);
+                        if( poQuotaTarget->GetDirty() || nBlocksToFree == 64 )
+                        {
+                            bLoopAgain = bStillOverQuota ||
+                                         nCacheUsed > nCurCacheMax;
+                            break;
+                        }
+                        if( !bStillOverQuota )
+                            break;
+                    }
+                    poQuotaTarget = poNextTarget;
+                }
+            }
+
             GDALRasterBlock *poTarget = poOldest;
-            while( nCacheUsed > nCurCacheMax )
+            GDALRasterBlock *poClockLimit =
+                bClockEviction ? poNewest : nullptr;
+            while( !bLoopAgain && nCacheUsed > nCurCacheMax )
             {
                 GDALRasterBlock* poDirtyBlockOtherDataset = nullptr;
                 // In this first pass, only discard dirty blocks of this
@@ -981,6 +1523,8 @@ CPLErr GDALRasterBlock::Internalize()
                 //    so gets the old value.
                 while( poTarget != nullptr )
                 {
+                    if( GiveSecondChance_unlocked(poTarget, poClockLimit) )
+                        continue;
                     if( !poTarget->GetDirty() )
                     {
                         if( CPLAtomicCompareAndExchange(
@@ -1075,6 +1619,9 @@ CPLErr GDALRasterBlock::Internalize()
 
         bFirstIter = false;
 
+        if( bCacheStatistics && nBlocksToFree > 0 )
+            nStatEvictions.fetch_add(nBlocksToFree, std::memory_order_relaxed);
+
         // Now free blocks we have detached and removed from their band.
         for( int i = 0; i < nBlocksToFree; ++i)
         {
@@ -1110,7 +1657,7 @@ CPLErr GDALRasterBlock::Internalize()
             }
             else
             {
-                VSIFreeAligned(poBlock->pData);
+                ReleaseBlockData(poBlock->pData, poBlock->GetBlockSize());
             }
             poBlock->pData = nullptr;
 
@@ -1119,9 +1666,23 @@ CPLErr GDALRasterBlock::Internalize()
     }
     while(bLoopAgain);
 
+    if( pNewData == nullptr )
+        pNewData = AcquireBlockData( nSizeInBytes );
     if( pNewData == nullptr )
     {
-        pNewData = VSI_MALLOC_ALIGNED_AUTO_VERBOSE( nSizeInBytes );
+        if( poMapBufferPool != nullptr )
+        {
+            // Buffers of other sizes in the pool might prevent the
+            // allocation from succeeding.
+            pNewData = VSIMallocAlignedAuto( nSizeInBytes );
+            if( pNewData == nullptr )
+            {
+                TAKE_LOCK;
+                FreeBufferPool();
+            }
+        }
+        if( pNewData == nullptr )
+            pNewData = VSI_MALLOC_ALIGNED_AUTO_VERBOSE( nSizeInBytes );
         if( pNewData == nullptr )
         {
             return( CE_Failure );
@@ -1180,9 +1741,30 @@ void GDALRasterBlock::MarkClean()
 /*! @cond Doxygen_Suppress */
 void GDALRasterBlock::DestroyRBMutex()
 {
+    if( bCacheStatistics )
+    {
+        GDALCacheStatistics sStats;
+        GDALGetCacheStatistics(&sStats);
+        CPLDebug("GDAL",
+                 "Block cache statistics: " CPL_FRMT_GIB " lookups, "
+                 CPL_FRMT_GIB " hits, " CPL_FRMT_GIB " misses, "
+                 CPL_FRMT_GIB " evictions, " CPL_FRMT_GIB " dirty write-backs, "
+                 CPL_FRMT_GIB " bytes resident",
+                 sStats.nLookups, sStats.nHits, sStats.nMisses,
+                 sStats.nEvictions, sStats.nDirtyWriteBacks,
+                 sStats.nBytesResident);
+    }
+
+    FreeBufferPool();
+
     if( hRBLock != nullptr )
         DESTROY_LOCK;
     hRBLock = nullptr;
+
+    delete poMapDatasetQuotas;
+    poMapDatasetQuotas = nullptr;
+    delete poMapDriverQuotas;
+    poMapDriverQuotas = nullptr;
 }
 /*! @endcond */
 
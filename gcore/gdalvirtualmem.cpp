@@ -68,6 +68,11 @@ class GDALVirtualMem
     bool bIsCompact = false;
     bool bIsBandSequential = false;
 
+    // Height of the blocks of the source, and number of following rows of
+    // blocks to fill when a page is accessed. 0 to fill pages one by one.
+    int nClusterBlockYSize = 0;
+    int nReadAheadBlocks = 0;
+
     bool IsCompact() const { return bIsCompact; }
     bool IsBandSequential() const { return bIsBandSequential; }
 
@@ -117,6 +122,12 @@ public:
                                                size_t nToEvicted,
                                                void* pUserData);
 
+    void SetTileAware( int nBlockYSize, int nReadAhead )
+        { nClusterBlockYSize = nBlockYSize; nReadAheadBlocks = nReadAhead; }
+    static void GetCluster( CPLVirtualMem* ctxt, size_t nOffset,
+                            size_t* pnClusterOffset, size_t* pnClusterSize,
+                            void* pUserData );
+
     static void Destroy(void* pUserData);
 };
 
@@ -640,6 +651,43 @@ void GDALVirtualMem::SaveFromCachePixelInterleaved(
         GF_Write, nOffset, const_cast<void *>(pPageToBeEvicted), nToEvicted);
 }
 
+/************************************************************************/
+/*                             GetCluster()                             */
+/*                                                                      */
+/*      Range of the scanlines of the row of blocks of the accessed     */
+/*      page, and of the rows to read ahead, so that the blocks are     */
+/*      decoded by a single RasterIO() request.                         */
+/************************************************************************/
+
+void GDALVirtualMem::GetCluster( CPLVirtualMem*,
+                                 size_t nOffset,
+                                 size_t* pnClusterOffset,
+                                 size_t* pnClusterSize,
+                                 void* pUserData )
+{
+    const GDALVirtualMem* psParms = static_cast<GDALVirtualMem *>(pUserData);
+    coord_type x = 0;
+    coord_type y = 0;
+    int band = 0;
+    psParms->GetXYBand(nOffset, x, y, band);
+    y = std::min(y, psParms->nBufYSize - 1);
+    band = std::min(band, psParms->nBandCount - 1);
+
+    const GIntBig nBlockYSize = psParms->nClusterBlockYSize;
+    const GIntBig nRow = (psParms->nYOff + y) / nBlockYSize;
+    const GIntBig nYStart =
+        std::max(static_cast<GIntBig>(psParms->nYOff), nRow * nBlockYSize);
+    const GIntBig nYEnd =
+        std::min( static_cast<GIntBig>(psParms->nYOff) + psParms->nBufYSize,
+                  (nRow + 1 + psParms->nReadAheadBlocks) * nBlockYSize );
+    GIntBig nStart = (nYStart - psParms->nYOff) * psParms->nLineSpace;
+    if( psParms->IsBandSequential() )
+        nStart += band * psParms->nBandSpace;
+    *pnClusterOffset = static_cast<size_t>(nStart);
+    *pnClusterSize =
+        static_cast<size_t>((nYEnd - nYStart) * psParms->nLineSpace);
+}
+
 /************************************************************************/
 /*                                Destroy()                             */
 /************************************************************************/
@@ -703,7 +751,7 @@ static CPLVirtualMem* GDALGetVirtualMem( GDALDatasetH hDS,
                                          size_t nCacheSize,
                                          size_t nPageSizeHint,
                                          int bSingleThreadUsage,
-                                         CSLConstList /*papszOptions*/ )
+                                         CSLConstList papszOptions )
 {
     CPLVirtualMem* view = nullptr;
     GDALVirtualMem* psParams = nullptr;
@@ -833,6 +881,22 @@ static CPLVirtualMem* GDALGetVirtualMem( GDALDatasetH hDS,
     {
         delete psParams;
     }
+    else if( CPLFetchBool(papszOptions, "TILE_AWARE", false) )
+    {
+        GDALRasterBandH hFirstBand =
+            hBand ? hBand :
+            GDALGetRasterBand(hDS, panBandMap ? panBandMap[0] : 1);
+        int nBlockXSize = 0;
+        int nBlockYSize = 0;
+        GDALGetBlockSize(hFirstBand, &nBlockXSize, &nBlockYSize);
+        const int nReadAhead = std::max(0,
+            atoi(CSLFetchNameValueDef(papszOptions, "READAHEAD", "0")));
+        if( nBlockYSize > 1 || nReadAhead > 0 )
+        {
+            psParams->SetTileAware(std::max(1, nBlockYSize), nReadAhead);
+            CPLVirtualMemSetClusterCallback(view, GDALVirtualMem::GetCluster);
+        }
+    }
 
     return view;
 }
@@ -948,7 +1012,16 @@ static CPLVirtualMem* GDALGetVirtualMem( GDALDatasetH hDS,
  *                           can optimize performance a bit. If set to FALSE,
  *                           CPLVirtualMemDeclareThread() must be called.
  *
- * @param papszOptions NULL terminated list of options. Unused for now.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ * <ul>
+ * <li>TILE_AWARE=YES/NO: (GDAL >= 3.1) when accessing a page, fill all the
+ * pages of the scanlines of the row of blocks that contains it with a single
+ * RasterIO() request, so that each compressed tile or strip is decoded once.
+ * Defaults to NO.</li>
+ * <li>READAHEAD=n: (GDAL >= 3.1) with TILE_AWARE=YES, number of following
+ * rows of blocks to fill as well. Defaults to 0.</li>
+ * </ul>
+ * The number of pages filled at once is limited to half of nCacheSize.
  *
  * @return a virtual memory object that must be freed by CPLVirtualMemFree(),
  *         or NULL in case of failure.
@@ -1075,7 +1148,16 @@ CPLVirtualMem* GDALDatasetGetVirtualMem( GDALDatasetH hDS,
  *                           can optimize performance a bit. If set to FALSE,
  *                           CPLVirtualMemDeclareThread() must be called.
  *
- * @param papszOptions NULL terminated list of options. Unused for now.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ * <ul>
+ * <li>TILE_AWARE=YES/NO: (GDAL >= 3.1) when accessing a page, fill all the
+ * pages of the scanlines of the row of blocks that contains it with a single
+ * RasterIO() request, so that each compressed tile or strip is decoded once.
+ * Defaults to NO.</li>
+ * <li>READAHEAD=n: (GDAL >= 3.1) with TILE_AWARE=YES, number of following
+ * rows of blocks to fill as well. Defaults to 0.</li>
+ * </ul>
+ * The number of pages filled at once is limited to half of nCacheSize.
  *
  * @return a virtual memory object that must be freed by CPLVirtualMemFree(),
  *         or NULL in case of failure.
@@ -35,13 +35,19 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
 #include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdalwarper.h"
 
@@ -1591,6 +1597,14 @@ template<> inline double GDALResampleConvolutionHorizontal<GUInt16>(
                                                   nSrcPixelCount) ;
 }
 
+template<> inline double GDALResampleConvolutionHorizontal<float>(
+    const float* pChunk, const double* padfWeightsAligned,
+    int nSrcPixelCount )
+{
+    return GDALResampleConvolutionHorizontalSSE2( pChunk, padfWeightsAligned,
+                                                  nSrcPixelCount) ;
+}
+
 /************************************************************************/
 /*              GDALResampleConvolutionHorizontalWithMaskSSE2<T>        */
 /************************************************************************/
@@ -1651,6 +1665,17 @@ template<> inline void GDALResampleConvolutionHorizontalWithMask<GUInt16>(
                                                    dfVal, dfWeightSum );
 }
 
+template<> inline void GDALResampleConvolutionHorizontalWithMask<float>(
+    const float* pChunk, const GByte* pabyMask,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double& dfVal, double &dfWeightSum )
+{
+    GDALResampleConvolutionHorizontalWithMaskSSE2( pChunk, pabyMask,
+                                                   padfWeightsAligned,
+                                                   nSrcPixelCount,
+                                                   dfVal, dfWeightSum );
+}
+
 /************************************************************************/
 /*              GDALResampleConvolutionHorizontal_3rows_SSE2<T>         */
 /************************************************************************/
@@ -1727,6 +1752,18 @@ template<> inline void GDALResampleConvolutionHorizontal_3rows<GUInt16>(
         dfRes1, dfRes2, dfRes3);
 }
 
+template<> inline void GDALResampleConvolutionHorizontal_3rows<float>(
+    const float* pChunkRow1, const float* pChunkRow2,
+    const float* pChunkRow3,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double& dfRes1, double& dfRes2, double& dfRes3 )
+{
+    GDALResampleConvolutionHorizontal_3rows_SSE2(
+        pChunkRow1, pChunkRow2, pChunkRow3,
+        padfWeightsAligned, nSrcPixelCount,
+        dfRes1, dfRes2, dfRes3);
+}
+
 /************************************************************************/
 /*     GDALResampleConvolutionHorizontalPixelCountLess8_3rows_SSE2<T>   */
 /************************************************************************/
@@ -1796,6 +1833,19 @@ GDALResampleConvolutionHorizontalPixelCountLess8_3rows<GUInt16>(
         dfRes1, dfRes2, dfRes3 );
 }
 
+template<> inline void
+GDALResampleConvolutionHorizontalPixelCountLess8_3rows<float>(
+    const float* pChunkRow1, const float* pChunkRow2,
+    const float* pChunkRow3,
+    const double* padfWeightsAligned, int nSrcPixelCount,
+    double& dfRes1, double& dfRes2, double& dfRes3 )
+{
+    GDALResampleConvolutionHorizontalPixelCountLess8_3rows_SSE2(
+        pChunkRow1, pChunkRow2, pChunkRow3,
+        padfWeightsAligned, nSrcPixelCount,
+        dfRes1, dfRes2, dfRes3 );
+}
+
 /************************************************************************/
 /*     GDALResampleConvolutionHorizontalPixelCount4_3rows_SSE2<T>       */
 /************************************************************************/
@@ -1852,6 +1902,19 @@ GDALResampleConvolutionHorizontalPixelCount4_3rows<GUInt16>(
         dfRes1, dfRes2, dfRes3 );
 }
 
+template<> inline void
+GDALResampleConvolutionHorizontalPixelCount4_3rows<float>(
+    const float* pChunkRow1, const float* pChunkRow2,
+    const float* pChunkRow3,
+    const double* padfWeightsAligned,
+    double& dfRes1, double& dfRes2, double& dfRes3 )
+{
+    GDALResampleConvolutionHorizontalPixelCount4_3rows_SSE2(
+        pChunkRow1, pChunkRow2, pChunkRow3,
+        padfWeightsAligned,
+        dfRes1, dfRes2, dfRes3 );
+}
+
 #endif  // USE_SSE2
 
 /************************************************************************/
@@ -3034,215 +3097,997 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
 }
 
 /************************************************************************/
-/*                      GDALRegenerateOverviews()                       */
+/*                    GDALOvrPromoteBit2Grayscale()                     */
 /************************************************************************/
 
-/**
- * \brief Generate downsampled overviews.
- *
- * This function will generate one or more overview images from a base image
- * using the requested downsampling algorithm.  Its primary use is for
- * generating overviews via GDALDataset::BuildOverviews(), but it can also be
- * used to generate downsampled images in one file from another outside the
- * overview architecture.
- *
- * The output bands need to exist in advance.
- *
- * The full set of resampling algorithms is documented in
- * GDALDataset::BuildOverviews().
- *
- * This function will honour properly NODATA_VALUES tuples (special dataset
- * metadata) so that only a given RGB triplet (in case of a RGB image) will be
- * considered as the nodata value and not each value of the triplet
- * independently per band.
- *
- * @param hSrcBand the source (base level) band.
- * @param nOverviewCount the number of downsampled bands being generated.
- * @param pahOvrBands the list of downsampled bands to be generated.
- * @param pszResampling Resampling algorithm (e.g. "AVERAGE").
- * @param pfnProgress progress report function.
- * @param pProgressData progress function callback data.
- * @return CE_None on success or CE_Failure on failure.
- */
-CPLErr
-GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
-                         int nOverviewCount, GDALRasterBandH *pahOvrBands,
-                         const char * pszResampling,
-                         GDALProgressFunc pfnProgress, void * pProgressData )
-
+// Special case to promote 1bit data to 8bit 0/255 values.
+static void GDALOvrPromoteBit2Grayscale( const char* pszResampling,
+                                         GDALDataType eType,
+                                         void* pData, GPtrDiff_t nCount )
 {
-    GDALRasterBand *poSrcBand = GDALRasterBand::FromHandle( hSrcBand );
-    GDALRasterBand **papoOvrBands =
-        reinterpret_cast<GDALRasterBand **>( pahOvrBands );
-
-    if( pfnProgress == nullptr )
-        pfnProgress = GDALDummyProgress;
-
-    if( EQUAL(pszResampling,"NONE") )
-        return CE_None;
-
-    int nKernelRadius = 0;
-    GDALResampleFunction pfnResampleFn
-        = GDALGetResampleFunction(pszResampling, &nKernelRadius);
-
-    if( pfnResampleFn == nullptr )
-        return CE_Failure;
-
-/* -------------------------------------------------------------------- */
-/*      Check color tables...                                           */
-/* -------------------------------------------------------------------- */
-    GDALColorTable* poColorTable = nullptr;
-
-    if( (STARTS_WITH_CI(pszResampling, "AVER")
-         || STARTS_WITH_CI(pszResampling, "MODE")
-         || STARTS_WITH_CI(pszResampling, "GAUSS")) &&
-        poSrcBand->GetColorInterpretation() == GCI_PaletteIndex )
+    if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE") )
     {
-        poColorTable = poSrcBand->GetColorTable();
-        if( poColorTable != nullptr )
+        if( eType == GDT_Float32 )
         {
-            if( poColorTable->GetPaletteInterpretation() != GPI_RGB )
+            float* pafChunk = static_cast<float*>(pData);
+            for( GPtrDiff_t i = 0; i < nCount; i++)
             {
-                CPLError(
-                    CE_Warning, CPLE_AppDefined,
-                    "Computing overviews on palette index raster bands "
-                    "with a palette whose color interpretation is not RGB "
-                    "will probably lead to unexpected results." );
-                poColorTable = nullptr;
+                if( pafChunk[i] == 1.0 )
+                    pafChunk[i] = 255.0;
             }
         }
-        else
+        else if( eType == GDT_Byte )
         {
-            CPLError( CE_Warning, CPLE_AppDefined,
-                      "Computing overviews on palette index raster bands "
-                      "without a palette will probably lead to unexpected "
-                      "results." );
+            GByte* pabyChunk = static_cast<GByte*>(pData);
+            for( GPtrDiff_t i = 0; i < nCount; i++)
+            {
+                if( pabyChunk[i] == 1 )
+                    pabyChunk[i] = 255;
+            }
+        }
+        else if( eType == GDT_UInt16 )
+        {
+            GUInt16* pasChunk = static_cast<GUInt16*>(pData);
+            for( GPtrDiff_t i = 0; i < nCount; i++)
+            {
+                if( pasChunk[i] == 1 )
+                    pasChunk[i] = 255;
+            }
+        }
+        else {
+            CPLAssert(false);
         }
     }
-    // Not ready yet
-    else if( (EQUAL(pszResampling, "CUBIC") ||
-              EQUAL(pszResampling, "CUBICSPLINE") ||
-              EQUAL(pszResampling, "LANCZOS") ||
-              EQUAL(pszResampling, "BILINEAR") )
-        && poSrcBand->GetColorInterpretation() == GCI_PaletteIndex )
-    {
-        CPLError( CE_Warning, CPLE_AppDefined,
-                  "Computing %s overviews on palette index raster bands "
-                  "will probably lead to unexpected results.", pszResampling );
-    }
-
-    // If we have a nodata mask and we are doing something more complicated
-    // than nearest neighbouring, we have to fetch to nodata mask.
-
-    GDALRasterBand* poMaskBand = nullptr;
-    int nMaskFlags = 0;
-    bool bUseNoDataMask = false;
-
-    if( !STARTS_WITH_CI(pszResampling, "NEAR") )
+    else if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE_MINISWHITE") )
     {
-        // Special case if we are the alpha band. We want it to be considered
-        // as the mask band to avoid alpha=0 to be taken into account in average
-        // computation.
-        if( poSrcBand->GetColorInterpretation() == GCI_AlphaBand )
+        if( eType == GDT_Float32 )
         {
-            poMaskBand = poSrcBand;
-            nMaskFlags = GMF_ALPHA | GMF_PER_DATASET;
+            float* pafChunk = static_cast<float*>(pData);
+            for( GPtrDiff_t i = 0; i < nCount; i++)
+            {
+                if( pafChunk[i] == 1.0 )
+                    pafChunk[i] = 0.0;
+                else if( pafChunk[i] == 0.0 )
+                    pafChunk[i] = 255.0;
+            }
         }
-        else
+        else if( eType == GDT_Byte )
         {
-            poMaskBand = poSrcBand->GetMaskBand();
-            nMaskFlags = poSrcBand->GetMaskFlags();
+            GByte* pabyChunk = static_cast<GByte*>(pData);
+            for( GPtrDiff_t i = 0; i < nCount; i++)
+            {
+                if( pabyChunk[i] == 1 )
+                    pabyChunk[i] = 0;
+                else if( pabyChunk[i] == 0 )
+                    pabyChunk[i] = 255;
+            }
+        }
+        else if( eType == GDT_UInt16 )
+        {
+            GUInt16* pasChunk = static_cast<GUInt16*>(pData);
+            for( GPtrDiff_t i = 0; i < nCount; i++)
+            {
+                if( pasChunk[i] == 1 )
+                    pasChunk[i] = 0;
+                else if( pasChunk[i] == 0 )
+                    pasChunk[i] = 255;
+            }
+        }
+        else {
+            CPLAssert(false);
         }
-
-        bUseNoDataMask = (nMaskFlags & GMF_ALL_VALID) == 0;
     }
+}
 
-/* -------------------------------------------------------------------- */
-/*      If we are operating on multiple overviews, and using            */
-/*      averaging, lets do them in cascading order to reduce the        */
-/*      amount of computation.                                          */
-/* -------------------------------------------------------------------- */
-
-    // In case the mask made be computed from another band of the dataset,
-    // we can't use cascaded generation, as the computation of the overviews
-    // of the band used for the mask band may not have yet occurred (#3033).
-    if( (STARTS_WITH_CI(pszResampling, "AVER") |
-         STARTS_WITH_CI(pszResampling, "GAUSS") ||
-         EQUAL(pszResampling, "CUBIC") ||
-         EQUAL(pszResampling, "CUBICSPLINE") ||
-         EQUAL(pszResampling, "LANCZOS") ||
-         EQUAL(pszResampling, "BILINEAR")) && nOverviewCount > 1
-         && !(bUseNoDataMask && nMaskFlags != GMF_NODATA))
-        return GDALRegenerateCascadingOverviews( poSrcBand,
-                                                 nOverviewCount, papoOvrBands,
-                                                 pszResampling,
-                                                 pfnProgress,
-                                                 pProgressData );
+namespace {
 
-/* -------------------------------------------------------------------- */
-/*      Setup one horizontal swath to read from the raw buffer.         */
-/* -------------------------------------------------------------------- */
-    int nFRXBlockSize = 0;
-    int nFRYBlockSize = 0;
-    poSrcBand->GetBlockSize( &nFRXBlockSize, &nFRYBlockSize );
+/************************************************************************/
+/*                       GDALOverviewCaptureBand                        */
+/************************************************************************/
 
-    int nFullResYChunk = 0;
-    if( nFRYBlockSize < 16 || nFRYBlockSize > 256 )
-        nFullResYChunk = 64;
-    else
-        nFullResYChunk = nFRYBlockSize;
+// Stand-in for an overview band, passed to the resampling functions when
+// they run in a worker thread. It records in memory what is written into
+// a window of the overview, so that the real write can be done later by
+// the calling thread. The recorded data can also be read back, as the
+// source of the next overview level.
+class GDALOverviewCaptureBand final: public GDALRasterBand
+{
+    CPL_DISALLOW_COPY_ASSIGN(GDALOverviewCaptureBand)
+
+    GDALRasterBand *m_poOvrBand;
+    int             m_nWinXOff;
+    int             m_nWinYOff;
+    int             m_nWinXSize;
+    int             m_nWinYSize;
+    GByte          *m_pabyData = nullptr;
+    CPLString       m_osNBITS{};
+    bool            m_bHasNBITS = false;
+    double          m_dfNoDataValue = 0.0;
+    int             m_bHasNoData = FALSE;
+
+  protected:
+    CPLErr IReadBlock( int, int, void * ) override { return CE_Failure; }
+    CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                      void *, int, int, GDALDataType,
+                      GSpacing, GSpacing,
+                      GDALRasterIOExtraArg* psExtraArg ) override;
+
+  public:
+    GDALOverviewCaptureBand( GDALRasterBand* poOvrBand,
+                             int nWinXOff, int nWinYOff,
+                             int nWinXSize, int nWinYSize );
+    ~GDALOverviewCaptureBand() override;
+
+    bool Allocate();
+    CPLErr WriteToOverview();
+
+    const char *GetMetadataItem( const char * pszName,
+                                 const char * pszDomain = "" ) override;
+    double GetNoDataValue( int *pbSuccess = nullptr ) override;
+};
+
+GDALOverviewCaptureBand::GDALOverviewCaptureBand( GDALRasterBand* poOvrBand,
+                                                  int nWinXOff, int nWinYOff,
+                                                  int nWinXSize, int nWinYSize ):
+    // Never go through the block cache: this band has no blocks.
+    GDALRasterBand(FALSE),
+    m_poOvrBand(poOvrBand),
+    m_nWinXOff(nWinXOff),
+    m_nWinYOff(nWinYOff),
+    m_nWinXSize(nWinXSize),
+    m_nWinYSize(nWinYSize)
+{
+    nRasterXSize = poOvrBand->GetXSize();
+    nRasterYSize = poOvrBand->GetYSize();
+    eDataType = poOvrBand->GetRasterDataType();
+    eAccess = GA_Update;
+    nBlockXSize = nRasterXSize;
+    nBlockYSize = 1;
+
+    // Queried by the resampling functions.
+    const char* pszNBITS =
+        poOvrBand->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+    if( pszNBITS )
+    {
+        m_bHasNBITS = true;
+        m_osNBITS = pszNBITS;
+    }
+    m_dfNoDataValue = poOvrBand->GetNoDataValue(&m_bHasNoData);
+}
 
-    GDALDataType eType = GDT_Unknown;
-    if( GDALDataTypeIsComplex( poSrcBand->GetRasterDataType() ) )
-        eType = GDT_CFloat32;
-    else
-        eType = GDALGetOvrWorkDataType( pszResampling,
-                                        poSrcBand->GetRasterDataType() );
+GDALOverviewCaptureBand::~GDALOverviewCaptureBand()
+{
+    VSIFree(m_pabyData);
+}
 
-    const int nWidth = poSrcBand->GetXSize();
-    const int nHeight = poSrcBand->GetYSize();
+bool GDALOverviewCaptureBand::Allocate()
+{
+    if( m_nWinXSize <= 0 || m_nWinYSize <= 0 )
+        return true;
+    m_pabyData = static_cast<GByte*>(
+        VSI_MALLOC3_VERBOSE(m_nWinXSize, m_nWinYSize,
+                            GDALGetDataTypeSizeBytes(eDataType)));
+    return m_pabyData != nullptr;
+}
 
-    int nMaxOvrFactor = 1;
-    for( int iOverview = 0; iOverview < nOverviewCount; ++iOverview )
+const char *GDALOverviewCaptureBand::GetMetadataItem( const char * pszName,
+                                                      const char * pszDomain )
+{
+    if( pszDomain != nullptr && EQUAL(pszDomain, "IMAGE_STRUCTURE") &&
+        EQUAL(pszName, "NBITS") )
     {
-        const int nDstWidth = papoOvrBands[iOverview]->GetXSize();
-        const int nDstHeight = papoOvrBands[iOverview]->GetYSize();
-        nMaxOvrFactor = std::max(
-            nMaxOvrFactor,
-            static_cast<int>(static_cast<double>(nWidth) / nDstWidth + 0.5) );
-        nMaxOvrFactor = std::max(
-            nMaxOvrFactor,
-            static_cast<int>(static_cast<double>(nHeight) / nDstHeight + 0.5) );
+        return m_bHasNBITS ? m_osNBITS.c_str() : nullptr;
     }
-    const int nMaxChunkYSizeQueried =
-        nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
+    return nullptr;
+}
 
-    GByte *pabyChunkNodataMask = nullptr;
-    void *pChunk =
-        VSI_MALLOC3_VERBOSE(
-            GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried, nWidth );
-    if( bUseNoDataMask )
+double GDALOverviewCaptureBand::GetNoDataValue( int *pbSuccess )
+{
+    if( pbSuccess )
+        *pbSuccess = m_bHasNoData;
+    return m_dfNoDataValue;
+}
+
+CPLErr GDALOverviewCaptureBand::IRasterIO( GDALRWFlag eRWFlag,
+                                           int nXOff, int nYOff,
+                                           int nXSize, int nYSize,
+                                           void * pData,
+                                           int nBufXSize, int nBufYSize,
+                                           GDALDataType eBufType,
+                                           GSpacing nPixelSpace,
+                                           GSpacing nLineSpace,
+                                           GDALRasterIOExtraArg* )
+{
+    if( m_pabyData == nullptr ||
+        nBufXSize != nXSize || nBufYSize != nYSize ||
+        nXOff < m_nWinXOff || nYOff < m_nWinYOff ||
+        nXOff + nXSize > m_nWinXOff + m_nWinXSize ||
+        nYOff + nYSize > m_nWinYOff + m_nWinYSize )
     {
-        pabyChunkNodataMask =
-            static_cast<GByte*>(VSI_MALLOC2_VERBOSE( nMaxChunkYSizeQueried, nWidth ));
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "GDALOverviewCaptureBand::IRasterIO(): "
+                 "unexpected request");
+        return CE_Failure;
     }
 
-    if( pChunk == nullptr || (bUseNoDataMask && pabyChunkNodataMask == nullptr))
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    for( int iLine = 0; iLine < nYSize; ++iLine )
     {
-        CPLFree(pChunk);
-        CPLFree(pabyChunkNodataMask);
-        return CE_Failure;
+        GByte* pabyBuf = static_cast<GByte*>(pData) + iLine * nLineSpace;
+        GByte* pabyWin = m_pabyData +
+            (static_cast<size_t>(nYOff - m_nWinYOff + iLine) * m_nWinXSize
+             + (nXOff - m_nWinXOff)) * nDTSize;
+        if( eRWFlag == GF_Write )
+            GDALCopyWords(pabyBuf, eBufType, static_cast<int>(nPixelSpace),
+                          pabyWin, eDataType, nDTSize,
+                          nXSize);
+        else
+            GDALCopyWords(pabyWin, eDataType, nDTSize,
+                          pabyBuf, eBufType, static_cast<int>(nPixelSpace),
+                          nXSize);
     }
+    return CE_None;
+}
 
-    int bHasNoData = FALSE;
-    const float fNoDataValue =
-        static_cast<float>( poSrcBand->GetNoDataValue(&bHasNoData) );
-    const bool bPropagateNoData =
-        CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
+CPLErr GDALOverviewCaptureBand::WriteToOverview()
+{
+    if( m_pabyData == nullptr )
+        return CE_None;
+    return m_poOvrBand->RasterIO(
+        GF_Write, m_nWinXOff, m_nWinYOff, m_nWinXSize, m_nWinYSize,
+        m_pabyData, m_nWinXSize, m_nWinYSize, eDataType,
+        0, 0, nullptr);
+}
 
+/************************************************************************/
+/*                           GDALOverviewJob                            */
+/************************************************************************/
+
+// Resampling of one source chunk. The job owns the chunk buffers, and the
+// capture bands into which the resampled data goes.
+struct GDALOverviewJob
+{
+    CPL_DISALLOW_COPY_ASSIGN(GDALOverviewJob)
+
+    std::vector<std::function<CPLErr()>> aoTasks{};
+    std::vector<void*> apBuffers{};
+    std::vector<std::unique_ptr<GDALOverviewCaptureBand>> apoCaptureBands{};
+    CPLErr eErr = CE_None;
+    bool bFinished = false;
+    std::mutex* pMutex = nullptr;
+    std::condition_variable* pCond = nullptr;
+
+    GDALOverviewJob() = default;
+    ~GDALOverviewJob()
+    {
+        for( void* pBuffer: apBuffers )
+            VSIFree(pBuffer);
+    }
+
+    void* AllocBuffer( size_t nSize1, size_t nSize2, size_t nSize3 )
+    {
+        void* pBuffer = VSI_MALLOC3_VERBOSE(nSize1, nSize2, nSize3);
+        if( pBuffer )
+            apBuffers.push_back(pBuffer);
+        return pBuffer;
+    }
+
+    GDALRasterBand* AddCaptureBand( GDALRasterBand* poOvrBand,
+                                    int nWinXOff, int nWinYOff,
+                                    int nWinXSize, int nWinYSize )
+    {
+        std::unique_ptr<GDALOverviewCaptureBand> poBand(
+            new GDALOverviewCaptureBand(poOvrBand, nWinXOff, nWinYOff,
+                                        nWinXSize, nWinYSize));
+        if( !poBand->Allocate() )
+            return nullptr;
+        apoCaptureBands.push_back(std::move(poBand));
+        return apoCaptureBands.back().get();
+    }
+
+    static void Run( void* pData )
+    {
+        GDALOverviewJob* psJob = static_cast<GDALOverviewJob*>(pData);
+        CPLErr eErr = CE_None;
+        for( size_t i = 0; eErr == CE_None && i < psJob->aoTasks.size(); ++i )
+            eErr = psJob->aoTasks[i]();
+        std::lock_guard<std::mutex> oLock(*(psJob->pMutex));
+        psJob->eErr = eErr;
+        psJob->bFinished = true;
+        psJob->pCond->notify_all();
+    }
+};
+
+/************************************************************************/
+/*                         GDALOverviewJobQueue                         */
+/************************************************************************/
+
+// Runs the resampling jobs in a pool of worker threads, while the writes
+// of their results into the overview bands are done by the calling thread,
+// in the order in which the jobs have been submitted.
+class GDALOverviewJobQueue
+{
+    CPL_DISALLOW_COPY_ASSIGN(GDALOverviewJobQueue)
+
+    std::mutex m_oMutex{};
+    std::condition_variable m_oCond{};
+    std::list<std::unique_ptr<GDALOverviewJob>> m_apoJobs{};
+    size_t m_nMaxJobs = 0;
+    CPLErr m_eErr = CE_None;
+    CPLWorkerThreadPool m_oPool{};
+
+    void FlushOldest();
+
+  public:
+    GDALOverviewJobQueue() = default;
+    ~GDALOverviewJobQueue() { m_oPool.WaitCompletion(0); }
+
+    bool Setup( int nThreads );
+    CPLErr Submit( std::unique_ptr<GDALOverviewJob>&& poJob );
+    CPLErr FlushAll();
+};
+
+bool GDALOverviewJobQueue::Setup( int nThreads )
+{
+    // Allow one job to be prepared by the calling thread while the
+    // workers are busy.
+    m_nMaxJobs = static_cast<size_t>(nThreads) + 1;
+    return m_oPool.Setup(nThreads, nullptr, nullptr, false);
+}
+
+void GDALOverviewJobQueue::FlushOldest()
+{
+    std::unique_ptr<GDALOverviewJob> poJob(std::move(m_apoJobs.front()));
+    m_apoJobs.pop_front();
+    {
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        while( !poJob->bFinished )
+            m_oCond.wait(oLock);
+    }
+    // Once something failed, only wait for the pending jobs.
+    if( m_eErr == CE_None )
+        m_eErr = poJob->eErr;
+    for( size_t i = 0; m_eErr == CE_None &&
+                       i < poJob->apoCaptureBands.size(); ++i )
+    {
+        m_eErr = poJob->apoCaptureBands[i]->WriteToOverview();
+    }
+}
+
+CPLErr GDALOverviewJobQueue::Submit( std::unique_ptr<GDALOverviewJob>&& poJob )
+{
+    poJob->pMutex = &m_oMutex;
+    poJob->pCond = &m_oCond;
+    if( !m_oPool.SubmitJob(GDALOverviewJob::Run, poJob.get()) )
+    {
+        m_eErr = CE_Failure;
+        return m_eErr;
+    }
+    m_apoJobs.push_back(std::move(poJob));
+
+    while( m_eErr == CE_None && m_apoJobs.size() >= m_nMaxJobs )
+        FlushOldest();
+    return m_eErr;
+}
+
+CPLErr GDALOverviewJobQueue::FlushAll()
+{
+    while( !m_apoJobs.empty() )
+        FlushOldest();
+    return m_eErr;
+}
+
+} // namespace
+
+/************************************************************************/
+/*                  GDALRegenerateOverviewsStreaming()                  */
+/************************************************************************/
+
+namespace {
+
+// State of the computation of one overview level, of which the source
+// (the base band or the previous level) is kept in memory as a window of
+// rows, filled as the source rows become available.
+struct GDALOverviewStreamLevel
+{
+    GDALRasterBand *poSrcBand = nullptr;
+    GDALRasterBand *poOvrBand = nullptr;
+    const char     *pszResampling = nullptr;
+    GDALDataType    eType = GDT_Unknown;
+    int             nDTSize = 0;
+    int             nSrcWidth = 0;
+    int             nSrcHeight = 0;
+    int             nDstWidth = 0;
+    int             nDstHeight = 0;
+    double          dfXRatioDstToSrc = 0.0;
+    double          dfYRatioDstToSrc = 0.0;
+    int             nFullResYChunk = 0;
+    int             nMargin = 0;
+    bool            bUseNoDataMask = false;
+    int             bHasNoData = FALSE;
+    float           fNoDataValue = 0.0f;
+    GDALColorTable *poColorTable = nullptr;
+
+    std::vector<GByte> abyWindow{};
+    std::vector<GByte> abyMaskWindow{};
+    int             nWinYOff = 0;
+    int             nWinYSize = 0;
+    int             nChunkYOff = 0;
+
+    bool   Grow( int nRows, void** ppData, GByte** ppabyMask );
+    void   Discard( int nNewWinYOff );
+};
+
+// Extend the window by nRows rows, and return where to put them.
+bool GDALOverviewStreamLevel::Grow( int nRows, void** ppData,
+                                    GByte** ppabyMask )
+{
+    const size_t nLineSize = static_cast<size_t>(nSrcWidth) * nDTSize;
+    try
+    {
+        abyWindow.resize(
+            static_cast<size_t>(nWinYSize + nRows) * nLineSize );
+        if( bUseNoDataMask )
+            abyMaskWindow.resize(
+                static_cast<size_t>(nWinYSize + nRows) * nSrcWidth );
+    }
+    catch( const std::exception& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate overview computation buffer");
+        return false;
+    }
+    *ppData = &abyWindow[static_cast<size_t>(nWinYSize) * nLineSize];
+    *ppabyMask = bUseNoDataMask ?
+        &abyMaskWindow[static_cast<size_t>(nWinYSize) * nSrcWidth] : nullptr;
+    nWinYSize += nRows;
+    return true;
+}
+
+// Drop the rows of the window before nNewWinYOff.
+void GDALOverviewStreamLevel::Discard( int nNewWinYOff )
+{
+    const int nRows = std::min(nNewWinYOff - nWinYOff, nWinYSize);
+    if( nRows <= 0 )
+        return;
+    const size_t nLineSize = static_cast<size_t>(nSrcWidth) * nDTSize;
+    abyWindow.erase(abyWindow.begin(),
+                    abyWindow.begin() + static_cast<size_t>(nRows) * nLineSize);
+    if( bUseNoDataMask )
+        abyMaskWindow.erase(
+            abyMaskWindow.begin(),
+            abyMaskWindow.begin() + static_cast<size_t>(nRows) * nSrcWidth);
+    nWinYOff += nRows;
+    nWinYSize -= nRows;
+}
+
+} // namespace
+
+// Resample all the chunks of level iLevel whose source rows are available,
+// and pass the result to the next level.
+static CPLErr
+GDALOverviewStreamLevelProcess( std::vector<GDALOverviewStreamLevel>& aoLevels,
+                                size_t iLevel,
+                                GDALResampleFunction pfnResampleFn,
+                                bool bPropagateNoData )
+{
+    GDALOverviewStreamLevel& oLevel = aoLevels[iLevel];
+    while( oLevel.nChunkYOff < oLevel.nSrcHeight )
+    {
+        const int nChunkYOff = oLevel.nChunkYOff;
+        const int nFullResYChunk =
+            std::min(oLevel.nFullResYChunk, oLevel.nSrcHeight - nChunkYOff);
+        const int nChunkYOffQueried =
+            std::max(0, nChunkYOff - oLevel.nMargin);
+        const int nChunkYEndQueried =
+            std::min(oLevel.nSrcHeight,
+                     nChunkYOff + nFullResYChunk + oLevel.nMargin);
+        if( oLevel.nWinYOff + oLevel.nWinYSize < nChunkYEndQueried )
+            break;
+        CPLAssert( nChunkYOffQueried >= oLevel.nWinYOff );
+
+        int nDstYOff = static_cast<int>(
+            0.5 + nChunkYOff / oLevel.dfYRatioDstToSrc);
+        int nDstYOff2 = static_cast<int>(
+            0.5 + (nChunkYOff + nFullResYChunk) / oLevel.dfYRatioDstToSrc);
+        if( nChunkYOff + nFullResYChunk == oLevel.nSrcHeight )
+            nDstYOff2 = oLevel.nDstHeight;
+
+        GDALOverviewCaptureBand oDstBand(oLevel.poOvrBand,
+                                         0, nDstYOff,
+                                         oLevel.nDstWidth,
+                                         nDstYOff2 - nDstYOff);
+        if( !oDstBand.Allocate() )
+            return CE_Failure;
+
+        const size_t nRowOffset =
+            static_cast<size_t>(nChunkYOffQueried - oLevel.nWinYOff);
+        CPLErr eErr = pfnResampleFn(
+            oLevel.dfXRatioDstToSrc, oLevel.dfYRatioDstToSrc,
+            0.0, 0.0,
+            oLevel.eType,
+            &oLevel.abyWindow[nRowOffset * oLevel.nSrcWidth * oLevel.nDTSize],
+            oLevel.bUseNoDataMask ?
+                &oLevel.abyMaskWindow[nRowOffset * oLevel.nSrcWidth] : nullptr,
+            0, oLevel.nSrcWidth,
+            nChunkYOffQueried, nChunkYEndQueried - nChunkYOffQueried,
+            0, oLevel.nDstWidth,
+            nDstYOff, nDstYOff2,
+            &oDstBand, oLevel.pszResampling,
+            oLevel.bHasNoData, oLevel.fNoDataValue, oLevel.poColorTable,
+            oLevel.poSrcBand->GetRasterDataType(),
+            bPropagateNoData);
+        if( eErr == CE_None )
+            eErr = oDstBand.WriteToOverview();
+
+        // The rows just computed are the source of the next level, which
+        // sees them as if they had been read back from the overview band.
+        if( eErr == CE_None && iLevel + 1 < aoLevels.size() &&
+            nDstYOff2 > nDstYOff )
+        {
+            GDALOverviewStreamLevel& oNext = aoLevels[iLevel + 1];
+            CPLAssert( oNext.nWinYOff + oNext.nWinYSize == nDstYOff );
+            void* pData = nullptr;
+            GByte* pabyMask = nullptr;
+            if( !oNext.Grow(nDstYOff2 - nDstYOff, &pData, &pabyMask) )
+                return CE_Failure;
+            eErr = oDstBand.RasterIO(
+                GF_Read, 0, nDstYOff, oLevel.nDstWidth, nDstYOff2 - nDstYOff,
+                pData, oLevel.nDstWidth, nDstYOff2 - nDstYOff, oNext.eType,
+                0, 0, nullptr );
+            if( eErr == CE_None && pabyMask )
+            {
+                GDALNoDataMaskBand oMaskBand(&oDstBand);
+                eErr = oMaskBand.RasterIO(
+                    GF_Read, 0, nDstYOff,
+                    oLevel.nDstWidth, nDstYOff2 - nDstYOff,
+                    pabyMask, oLevel.nDstWidth, nDstYOff2 - nDstYOff,
+                    GDT_Byte, 0, 0, nullptr );
+            }
+        }
+        if( eErr != CE_None )
+            return eErr;
+
+        oLevel.nChunkYOff += nFullResYChunk;
+        oLevel.Discard(oLevel.nChunkYOff - oLevel.nMargin);
+    }
+    return CE_None;
+}
+
+// Variant of GDALRegenerateCascadingOverviews() that reads the source band
+// only once, and computes each level from the rows of the previous level
+// kept in memory, instead of reading them back from the overview band.
+// *pbSupported is set to false, without doing anything, if a level would
+// need a mask that cannot be derived from the previous level.
+static CPLErr
+GDALRegenerateOverviewsStreaming( GDALRasterBand *poSrcBand,
+                                  int nOverviews, GDALRasterBand **papoOvrBands,
+                                  const char * pszResampling,
+                                  GDALProgressFunc pfnProgress,
+                                  void * pProgressData,
+                                  bool* pbSupported )
+{
+    *pbSupported = false;
+
+    int nKernelRadius = 0;
+    GDALResampleFunction pfnResampleFn
+        = GDALGetResampleFunction(pszResampling, &nKernelRadius);
+    if( pfnResampleFn == nullptr )
+        return CE_Failure;
+
+    // Put the overviews in order from largest to smallest.
+    std::vector<GDALRasterBand*> apoOvrBands(papoOvrBands,
+                                             papoOvrBands + nOverviews);
+    std::stable_sort(apoOvrBands.begin(), apoOvrBands.end(),
+        [](GDALRasterBand* poA, GDALRasterBand* poB)
+        {
+            return poA->GetXSize() * static_cast<double>(poA->GetYSize()) >
+                   poB->GetXSize() * static_cast<double>(poB->GetYSize());
+        });
+
+    std::vector<GDALOverviewStreamLevel> aoLevels(nOverviews);
+    for( int i = 0; i < nOverviews; ++i )
+    {
+        GDALOverviewStreamLevel& oLevel = aoLevels[i];
+        oLevel.poSrcBand = i == 0 ? poSrcBand : apoOvrBands[i-1];
+        oLevel.poOvrBand = apoOvrBands[i];
+        // Only do the bit2grayscale promotion on the base band.
+        oLevel.pszResampling =
+            i > 0 && STARTS_WITH_CI(pszResampling, "AVERAGE_BIT2G") ?
+                "AVERAGE" : pszResampling;
+
+        const GDALDataType eSrcDataType =
+            oLevel.poSrcBand->GetRasterDataType();
+        if( GDALDataTypeIsComplex(eSrcDataType) )
+            return CE_None;
+        oLevel.eType = GDALGetOvrWorkDataType(oLevel.pszResampling,
+                                              eSrcDataType);
+        oLevel.nDTSize = GDALGetDataTypeSizeBytes(oLevel.eType);
+
+        int nMaskFlags = oLevel.poSrcBand->GetMaskFlags();
+        if( oLevel.poSrcBand->GetColorInterpretation() == GCI_AlphaBand )
+            nMaskFlags = GMF_ALPHA | GMF_PER_DATASET;
+        oLevel.bUseNoDataMask = (nMaskFlags & GMF_ALL_VALID) == 0;
+        if( oLevel.bUseNoDataMask && nMaskFlags != GMF_NODATA )
+            return CE_None;
+
+        oLevel.bHasNoData = FALSE;
+        oLevel.fNoDataValue = static_cast<float>(
+            oLevel.poSrcBand->GetNoDataValue(&oLevel.bHasNoData) );
+
+        if( (STARTS_WITH_CI(pszResampling, "AVER") ||
+             STARTS_WITH_CI(pszResampling, "GAUSS")) &&
+            oLevel.poSrcBand->GetColorInterpretation() == GCI_PaletteIndex )
+        {
+            oLevel.poColorTable = oLevel.poSrcBand->GetColorTable();
+            if( oLevel.poColorTable != nullptr &&
+                oLevel.poColorTable->GetPaletteInterpretation() != GPI_RGB )
+            {
+                oLevel.poColorTable = nullptr;
+            }
+        }
+
+        oLevel.nSrcWidth = oLevel.poSrcBand->GetXSize();
+        oLevel.nSrcHeight = oLevel.poSrcBand->GetYSize();
+        oLevel.nDstWidth = oLevel.poOvrBand->GetXSize();
+        oLevel.nDstHeight = oLevel.poOvrBand->GetYSize();
+        oLevel.dfXRatioDstToSrc =
+            static_cast<double>(oLevel.nSrcWidth) / oLevel.nDstWidth;
+        oLevel.dfYRatioDstToSrc =
+            static_cast<double>(oLevel.nSrcHeight) / oLevel.nDstHeight;
+        const int nOvrFactor = std::max(1, std::max(
+            static_cast<int>(oLevel.dfXRatioDstToSrc + 0.5),
+            static_cast<int>(oLevel.dfYRatioDstToSrc + 0.5) ));
+        oLevel.nMargin = nKernelRadius * nOvrFactor;
+
+        int nFRXBlockSize = 0;
+        int nFRYBlockSize = 0;
+        oLevel.poSrcBand->GetBlockSize( &nFRXBlockSize, &nFRYBlockSize );
+        if( nFRYBlockSize < 16 || nFRYBlockSize > 256 )
+            oLevel.nFullResYChunk = 64;
+        else
+            oLevel.nFullResYChunk = nFRYBlockSize;
+    }
+    *pbSupported = true;
+
+    const bool bPropagateNoData =
+        CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
+
+/* -------------------------------------------------------------------- */
+/*      Read the source band once, and push the rows through all the    */
+/*      levels.                                                         */
+/* -------------------------------------------------------------------- */
+    GDALOverviewStreamLevel& oBaseLevel = aoLevels[0];
+    GDALRasterBand* poMaskBand = oBaseLevel.bUseNoDataMask ?
+        poSrcBand->GetMaskBand() : nullptr;
+    const int nWidth = oBaseLevel.nSrcWidth;
+    const int nHeight = oBaseLevel.nSrcHeight;
+    CPLErr eErr = CE_None;
+    for( int nYOff = 0; nYOff < nHeight && eErr == CE_None; )
+    {
+        if( !pfnProgress( nYOff / static_cast<double>( nHeight ),
+                          nullptr, pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+            break;
+        }
+
+        const int nRows = std::min(oBaseLevel.nFullResYChunk, nHeight - nYOff);
+        void* pData = nullptr;
+        GByte* pabyMask = nullptr;
+        if( !oBaseLevel.Grow(nRows, &pData, &pabyMask) )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+        eErr = poSrcBand->RasterIO(
+            GF_Read, 0, nYOff, nWidth, nRows,
+            pData, nWidth, nRows, oBaseLevel.eType,
+            0, 0, nullptr );
+        if( eErr == CE_None && poMaskBand )
+            eErr = poMaskBand->RasterIO(
+                GF_Read, 0, nYOff, nWidth, nRows,
+                pabyMask, nWidth, nRows, GDT_Byte,
+                0, 0, nullptr );
+        if( eErr != CE_None )
+            break;
+        GDALOvrPromoteBit2Grayscale(
+            pszResampling, oBaseLevel.eType, pData,
+            static_cast<GPtrDiff_t>(nRows) * nWidth );
+        nYOff += nRows;
+
+        for( size_t i = 0; eErr == CE_None && i < aoLevels.size(); ++i )
+        {
+            eErr = GDALOverviewStreamLevelProcess(aoLevels, i, pfnResampleFn,
+                                                  bPropagateNoData);
+        }
+    }
+
+    for( int i = 0; eErr == CE_None && i < nOverviews; ++i )
+        eErr = apoOvrBands[i]->FlushCache();
+
+    if( eErr == CE_None )
+        pfnProgress( 1.0, nullptr, pProgressData );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                      GDALRegenerateOverviews()                       */
+/************************************************************************/
+
+/**
+ * \brief Generate downsampled overviews.
+ *
+ * This function will generate one or more overview images from a base image
+ * using the requested downsampling algorithm.  Its primary use is for
+ * generating overviews via GDALDataset::BuildOverviews(), but it can also be
+ * used to generate downsampled images in one file from another outside the
+ * overview architecture.
+ *
+ * The output bands need to exist in advance.
+ *
+ * The full set of resampling algorithms is documented in
+ * GDALDataset::BuildOverviews().
+ *
+ * This function will honour properly NODATA_VALUES tuples (special dataset
+ * metadata) so that only a given RGB triplet (in case of a RGB image) will be
+ * considered as the nodata value and not each value of the triplet
+ * independently per band.
+ *
+ * When several overviews are generated with the AVERAGE, GAUSS, CUBIC,
+ * CUBICSPLINE, LANCZOS or BILINEAR methods, each level is computed from the
+ * previous one. Starting with GDAL 3.1, this is done in a single pass over
+ * the source band, the rows of the intermediate levels being kept in memory
+ * rather than read back from the overview bands (unless GDAL_NUM_THREADS is
+ * set, or the GDAL_OVR_STREAMING configuration option is set to NO).
+ *
+ * Starting with GDAL 3.1, when the GDAL_NUM_THREADS configuration option is
+ * set to a value greater than 1 (or ALL_CPUS), the resampling is done by
+ * that number of worker threads, while the source chunks are read ahead and
+ * the overview bands are written by the calling thread.
+ *
+ * @param hSrcBand the source (base level) band.
+ * @param nOverviewCount the number of downsampled bands being generated.
+ * @param pahOvrBands the list of downsampled bands to be generated.
+ * @param pszResampling Resampling algorithm (e.g. "AVERAGE").
+ * @param pfnProgress progress report function.
+ * @param pProgressData progress function callback data.
+ * @return CE_None on success or CE_Failure on failure.
+ */
+CPLErr
+GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
+                         int nOverviewCount, GDALRasterBandH *pahOvrBands,
+                         const char * pszResampling,
+                         GDALProgressFunc pfnProgress, void * pProgressData )
+
+{
+    GDALRasterBand *poSrcBand = GDALRasterBand::FromHandle( hSrcBand );
+    GDALRasterBand **papoOvrBands =
+        reinterpret_cast<GDALRasterBand **>( pahOvrBands );
+
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
+
+    if( EQUAL(pszResampling,"NONE") )
+        return CE_None;
+
+    int nKernelRadius = 0;
+    GDALResampleFunction pfnResampleFn
+        = GDALGetResampleFunction(pszResampling, &nKernelRadius);
+
+    if( pfnResampleFn == nullptr )
+        return CE_Failure;
+
+/* -------------------------------------------------------------------- */
+/*      Check color tables...                                           */
+/* -------------------------------------------------------------------- */
+    GDALColorTable* poColorTable = nullptr;
+
+    if( (STARTS_WITH_CI(pszResampling, "AVER")
+         || STARTS_WITH_CI(pszResampling, "MODE")
+         || STARTS_WITH_CI(pszResampling, "GAUSS")) &&
+        poSrcBand->GetColorInterpretation() == GCI_PaletteIndex )
+    {
+        poColorTable = poSrcBand->GetColorTable();
+        if( poColorTable != nullptr )
+        {
+            if( poColorTable->GetPaletteInterpretation() != GPI_RGB )
+            {
+                CPLError(
+                    CE_Warning, CPLE_AppDefined,
+                    "Computing overviews on palette index raster bands "
+                    "with a palette whose color interpretation is not RGB "
+                    "will probably lead to unexpected results." );
+                poColorTable = nullptr;
+            }
+        }
+        else
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Computing overviews on palette index raster bands "
+                      "without a palette will probably lead to unexpected "
+                      "results." );
+        }
+    }
+    // Not ready yet
+    else if( (EQUAL(pszResampling, "CUBIC") ||
+              EQUAL(pszResampling, "CUBICSPLINE") ||
+              EQUAL(pszResampling, "LANCZOS") ||
+              EQUAL(pszResampling, "BILINEAR") )
+        && poSrcBand->GetColorInterpretation() == GCI_PaletteIndex )
+    {
+        CPLError( CE_Warning, CPLE_AppDefined,
+                  "Computing %s overviews on palette index raster bands "
+                  "will probably lead to unexpected results.", pszResampling );
+    }
+
+    // If we have a nodata mask and we are doing something more complicated
+    // than nearest neighbouring, we have to fetch to nodata mask.
+
+    GDALRasterBand* poMaskBand = nullptr;
+    int nMaskFlags = 0;
+    bool bUseNoDataMask = false;
+
+    if( !STARTS_WITH_CI(pszResampling, "NEAR") )
+    {
+        // Special case if we are the alpha band. We want it to be considered
+        // as the mask band to avoid alpha=0 to be taken into account in average
+        // computation.
+        if( poSrcBand->GetColorInterpretation() == GCI_AlphaBand )
+        {
+            poMaskBand = poSrcBand;
+            nMaskFlags = GMF_ALPHA | GMF_PER_DATASET;
+        }
+        else
+        {
+            poMaskBand = poSrcBand->GetMaskBand();
+            nMaskFlags = poSrcBand->GetMaskFlags();
+        }
+
+        bUseNoDataMask = (nMaskFlags & GMF_ALL_VALID) == 0;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      If we are operating on multiple overviews, and using            */
+/*      averaging, lets do them in cascading order to reduce the        */
+/*      amount of computation.                                          */
+/* -------------------------------------------------------------------- */
+
+    // In case the mask made be computed from another band of the dataset,
+    // we can't use cascaded generation, as the computation of the overviews
+    // of the band used for the mask band may not have yet occurred (#3033).
+    if( (STARTS_WITH_CI(pszResampling, "AVER") |
+         STARTS_WITH_CI(pszResampling, "GAUSS") ||
+         EQUAL(pszResampling, "CUBIC") ||
+         EQUAL(pszResampling, "CUBICSPLINE") ||
+         EQUAL(pszResampling, "LANCZOS") ||
+         EQUAL(pszResampling, "BILINEAR")) && nOverviewCount > 1
+         && !(bUseNoDataMask && nMaskFlags != GMF_NODATA))
+    {
+        // Unless the resampling is done by several threads, compute all the
+        // levels in a single pass over the source band, keeping the rows
+        // of the intermediate levels in memory.
+        if( !EQUAL(pszResampling, "AVERAGE_MP") &&
+            CPLGetNumThreads() <= 1 &&
+            CPLTestBool(CPLGetConfigOption("GDAL_OVR_STREAMING", "YES")) )
+        {
+            bool bSupported = false;
+            const CPLErr eErr = GDALRegenerateOverviewsStreaming(
+                poSrcBand, nOverviewCount, papoOvrBands, pszResampling,
+                pfnProgress, pProgressData, &bSupported );
+            if( bSupported )
+                return eErr;
+        }
+        return GDALRegenerateCascadingOverviews( poSrcBand,
+                                                 nOverviewCount, papoOvrBands,
+                                                 pszResampling,
+                                                 pfnProgress,
+                                                 pProgressData );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Setup one horizontal swath to read from the raw buffer.         */
+/* -------------------------------------------------------------------- */
+    int nFRXBlockSize = 0;
+    int nFRYBlockSize = 0;
+    poSrcBand->GetBlockSize( &nFRXBlockSize, &nFRYBlockSize );
+
+    int nFullResYChunk = 0;
+    if( nFRYBlockSize < 16 || nFRYBlockSize > 256 )
+        nFullResYChunk = 64;
+    else
+        nFullResYChunk = nFRYBlockSize;
+
+    GDALDataType eType = GDT_Unknown;
+    if( GDALDataTypeIsComplex( poSrcBand->GetRasterDataType() ) )
+        eType = GDT_CFloat32;
+    else
+        eType = GDALGetOvrWorkDataType( pszResampling,
+                                        poSrcBand->GetRasterDataType() );
+
+    const int nWidth = poSrcBand->GetXSize();
+    const int nHeight = poSrcBand->GetYSize();
+
+    int nMaxOvrFactor = 1;
+    for( int iOverview = 0; iOverview < nOverviewCount; ++iOverview )
+    {
+        const int nDstWidth = papoOvrBands[iOverview]->GetXSize();
+        const int nDstHeight = papoOvrBands[iOverview]->GetYSize();
+        nMaxOvrFactor = std::max(
+            nMaxOvrFactor,
+            static_cast<int>(static_cast<double>(nWidth) / nDstWidth + 0.5) );
+        nMaxOvrFactor = std::max(
+            nMaxOvrFactor,
+            static_cast<int>(static_cast<double>(nHeight) / nDstHeight + 0.5) );
+    }
+    const int nMaxChunkYSizeQueried =
+        nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
+
+/* -------------------------------------------------------------------- */
+/*      When several threads are available, the resampling of the      */
+/*      chunks is done by worker threads, each job owning its chunk     */
+/*      buffers, while this thread reads ahead the next chunks and      */
+/*      writes the results in order.                                    */
+/* -------------------------------------------------------------------- */
+    std::unique_ptr<GDALOverviewJobQueue> poJobQueue;
+    const int nThreads = CPLGetNumThreads();
+    if( nThreads > 1 )
+    {
+        poJobQueue.reset(new GDALOverviewJobQueue());
+        if( !poJobQueue->Setup(nThreads) )
+            poJobQueue.reset();
+    }
+
+    GByte *pabyChunkNodataMask = nullptr;
+    void *pChunk = nullptr;
+    if( poJobQueue == nullptr )
+    {
+        pChunk =
+            VSI_MALLOC3_VERBOSE(
+                GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried, nWidth );
+        if( bUseNoDataMask )
+        {
+            pabyChunkNodataMask =
+                static_cast<GByte*>(VSI_MALLOC2_VERBOSE( nMaxChunkYSizeQueried, nWidth ));
+        }
+
+        if( pChunk == nullptr || (bUseNoDataMask && pabyChunkNodataMask == nullptr))
+        {
+            CPLFree(pChunk);
+            CPLFree(pabyChunkNodataMask);
+            return CE_Failure;
+        }
+    }
+
+    int bHasNoData = FALSE;
+    const float fNoDataValue =
+        static_cast<float>( poSrcBand->GetNoDataValue(&bHasNoData) );
+    const bool bPropagateNoData =
+        CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
+    const GDALDataType eSrcDataType = poSrcBand->GetRasterDataType();
+
+/* -------------------------------------------------------------------- */
+/*      Chunks that only cover holes of a sparse source read as the     */
+/*      nodata value, or 0, which all resampling methods map to the     */
+/*      same value. Those can be written directly, unless a palette    */
+/*      or a real mask band is involved.                                */
+/* -------------------------------------------------------------------- */
+    const bool bCanSkipHoles =
+        poColorTable == nullptr &&
+        (!bUseNoDataMask || nMaskFlags == GMF_NODATA) &&
+        !EQUAL(pszResampling, "AVERAGE_MP") &&
+        (poSrcBand->GetDataCoverageStatus(
+            0, 0, nWidth, nHeight, GDAL_DATA_COVERAGE_STATUS_EMPTY,
+            nullptr) & GDAL_DATA_COVERAGE_STATUS_EMPTY) != 0;
+    const double dfHoleValue =
+        bHasNoData ? poSrcBand->GetNoDataValue() : 0.0;
+    std::vector<double> adfHoleLine;
+
+/* -------------------------------------------------------------------- */
+/*      Loop over image operating on chunks.                            */
 /* -------------------------------------------------------------------- */
-/*      Loop over image operating on chunks.                            */
-/* -------------------------------------------------------------------- */
     int nChunkYOff = 0;
     CPLErr eErr = CE_None;
 
@@ -3271,6 +4116,62 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
         if( nChunkYOffQueried + nChunkYSizeQueried > nHeight )
             nChunkYSizeQueried = nHeight - nChunkYOffQueried;
 
+        if( bCanSkipHoles && eErr == CE_None &&
+            poSrcBand->GetDataCoverageStatus(
+                0, nChunkYOffQueried, nWidth, nChunkYSizeQueried,
+                GDAL_DATA_COVERAGE_STATUS_DATA, nullptr ) ==
+                                        GDAL_DATA_COVERAGE_STATUS_EMPTY )
+        {
+            for( int iOverview = 0;
+                 iOverview < nOverviewCount && eErr == CE_None;
+                 ++iOverview )
+            {
+                GDALRasterBand* poDstBand = papoOvrBands[iOverview];
+                const int nDstWidth = poDstBand->GetXSize();
+                const int nDstHeight = poDstBand->GetYSize();
+                const double dfYRatioDstToSrc =
+                    static_cast<double>(nHeight) / nDstHeight;
+                const int nDstYOff =
+                    static_cast<int>(0.5 + nChunkYOff/dfYRatioDstToSrc);
+                int nDstYOff2 = static_cast<int>(
+                    0.5 + (nChunkYOff+nFullResYChunk)/dfYRatioDstToSrc);
+                if( nChunkYOff + nFullResYChunk == nHeight )
+                    nDstYOff2 = nDstHeight;
+                if( nDstYOff2 <= nDstYOff )
+                    continue;
+
+                adfHoleLine.resize(nDstWidth, dfHoleValue);
+                for( int iDstLine = nDstYOff;
+                     iDstLine < nDstYOff2 && eErr == CE_None; ++iDstLine )
+                {
+                    eErr = poDstBand->RasterIO(
+                        GF_Write, 0, iDstLine, nDstWidth, 1,
+                        &adfHoleLine[0], nDstWidth, 1,
+                        GDT_Float64, 0, 0, nullptr );
+                }
+            }
+            continue;
+        }
+
+        std::unique_ptr<GDALOverviewJob> poJob;
+        if( poJobQueue && eErr == CE_None )
+        {
+            poJob.reset(new GDALOverviewJob());
+            pChunk = poJob->AllocBuffer(
+                GDALGetDataTypeSizeBytes(eType), nChunkYSizeQueried, nWidth );
+            pabyChunkNodataMask = bUseNoDataMask ?
+                static_cast<GByte*>(
+                    poJob->AllocBuffer(1, nChunkYSizeQueried, nWidth)) :
+                nullptr;
+            if( pChunk == nullptr ||
+                (bUseNoDataMask && pabyChunkNodataMask == nullptr) )
+            {
+                eErr = CE_Failure;
+            }
+        }
+        if( eErr != CE_None )
+            break;
+
         // Read chunk.
         if( eErr == CE_None )
             eErr = poSrcBand->RasterIO(
@@ -3284,78 +4185,9 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                 0, 0, nullptr );
 
         // Special case to promote 1bit data to 8bit 0/255 values.
-        if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE") )
-        {
-            if( eType == GDT_Float32 )
-            {
-                float* pafChunk = static_cast<float*>(pChunk);
-                for( GPtrDiff_t i = 0; i < static_cast<GPtrDiff_t>(nChunkYSizeQueried)*nWidth; i++)
-                {
-                    if( pafChunk[i] == 1.0 )
-                        pafChunk[i] = 255.0;
-                }
-            }
-            else if( eType == GDT_Byte )
-            {
-                GByte* pabyChunk = static_cast<GByte*>(pChunk);
-                for( GPtrDiff_t i = 0; i < static_cast<GPtrDiff_t>(nChunkYSizeQueried)*nWidth; i++)
-                {
-                    if( pabyChunk[i] == 1 )
-                        pabyChunk[i] = 255;
-                }
-            }
-            else if( eType == GDT_UInt16 )
-            {
-                GUInt16* pasChunk = static_cast<GUInt16*>(pChunk);
-                for( GPtrDiff_t i = 0; i < static_cast<GPtrDiff_t>(nChunkYSizeQueried)*nWidth; i++)
-                {
-                    if( pasChunk[i] == 1 )
-                        pasChunk[i] = 255;
-                }
-            }
-            else {
-                CPLAssert(false);
-            }
-        }
-        else if( EQUAL(pszResampling, "AVERAGE_BIT2GRAYSCALE_MINISWHITE") )
-        {
-            if( eType == GDT_Float32 )
-            {
-                float* pafChunk = static_cast<float*>(pChunk);
-                for( GPtrDiff_t i = 0; i < static_cast<GPtrDiff_t>(nChunkYSizeQueried)*nWidth; i++)
-                {
-                    if( pafChunk[i] == 1.0 )
-                        pafChunk[i] = 0.0;
-                    else if( pafChunk[i] == 0.0 )
-                        pafChunk[i] = 255.0;
-                }
-            }
-            else if( eType == GDT_Byte )
-            {
-                GByte* pabyChunk = static_cast<GByte*>(pChunk);
-                for( GPtrDiff_t i = 0; i < static_cast<GPtrDiff_t>(nChunkYSizeQueried)*nWidth; i++)
-                {
-                    if( pabyChunk[i] == 1 )
-                        pabyChunk[i] = 0;
-                    else if( pabyChunk[i] == 0 )
-                        pabyChunk[i] = 255;
-                }
-            }
-            else if( eType == GDT_UInt16 )
-            {
-                GUInt16* pasChunk = static_cast<GUInt16*>(pChunk);
-                for( GPtrDiff_t i = 0; i < static_cast<GPtrDiff_t>(nChunkYSizeQueried)*nWidth; i++)
-                {
-                    if( pasChunk[i] == 1 )
-                        pasChunk[i] = 0;
-                    else if( pasChunk[i] == 0 )
-                        pasChunk[i] = 255;
-                }
-            }
-            else {
-                CPLAssert(false);
-            }
-        }
+        GDALOvrPromoteBit2Grayscale(
+            pszResampling, eType, pChunk,
+            static_cast<GPtrDiff_t>(nChunkYSizeQueried) * nWidth );
 
         for( int iOverview = 0;
              iOverview < nOverviewCount && eErr == CE_None;
@@ -3389,35 +4221,66 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                 0, nDstYOff, nDstWidth, nDstYOff2 - nDstYOff );
 #endif
 
-            if( eType == GDT_Byte ||
-                eType == GDT_UInt16 ||
-                eType == GDT_Float32 )
-                eErr = pfnResampleFn(
-                    dfXRatioDstToSrc, dfYRatioDstToSrc,
-                    0.0, 0.0,
-                    eType,
-                    pChunk,
-                    pabyChunkNodataMask,
-                    0, nWidth,
-                    nChunkYOffQueried, nChunkYSizeQueried,
-                    0, nDstWidth,
-                    nDstYOff, nDstYOff2,
-                    papoOvrBands[iOverview], pszResampling,
-                    bHasNoData, fNoDataValue, poColorTable,
-                    poSrcBand->GetRasterDataType(),
-                    bPropagateNoData);
-            else
-                eErr = GDALResampleChunkC32R(
+            GDALRasterBand* poDstBand = papoOvrBands[iOverview];
+            if( poJob )
+            {
+                poDstBand = poJob->AddCaptureBand(
+                    poDstBand, 0, nDstYOff, nDstWidth, nDstYOff2 - nDstYOff );
+                if( poDstBand == nullptr )
+                {
+                    eErr = CE_Failure;
+                    break;
+                }
+            }
+
+            auto oResample = [=]()
+            {
+                if( eType == GDT_Byte ||
+                    eType == GDT_UInt16 ||
+                    eType == GDT_Float32 )
+                    return pfnResampleFn(
+                        dfXRatioDstToSrc, dfYRatioDstToSrc,
+                        0.0, 0.0,
+                        eType,
+                        pChunk,
+                        pabyChunkNodataMask,
+                        0, nWidth,
+                        nChunkYOffQueried, nChunkYSizeQueried,
+                        0, nDstWidth,
+                        nDstYOff, nDstYOff2,
+                        poDstBand, pszResampling,
+                        bHasNoData, fNoDataValue, poColorTable,
+                        eSrcDataType,
+                        bPropagateNoData);
+                return GDALResampleChunkC32R(
                     nWidth, nHeight,
                     static_cast<float*>(pChunk),
                     nChunkYOffQueried, nChunkYSizeQueried,
                     nDstYOff, nDstYOff2,
-                    papoOvrBands[iOverview], pszResampling);
+                    poDstBand, pszResampling);
+            };
+            if( poJob )
+                poJob->aoTasks.push_back(oResample);
+            else
+                eErr = oResample();
         }
+
+        if( poJob && eErr == CE_None )
+            eErr = poJobQueue->Submit(std::move(poJob));
     }
 
-    VSIFree( pChunk );
-    VSIFree( pabyChunkNodataMask );
+    if( poJobQueue )
+    {
+        const CPLErr eErrJobs = poJobQueue->FlushAll();
+        if( eErr == CE_None )
+            eErr = eErrJobs;
+        poJobQueue.reset();
+    }
+    else
+    {
+        VSIFree( pChunk );
+        VSIFree( pabyChunkNodataMask );
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Renormalized overview mean / stddev if needed.                  */
@@ -3447,6 +4310,348 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
     return eErr;
 }
 
+/************************************************************************/
+/*                    GDALRegenerateOverviewWindow()                    */
+/************************************************************************/
+
+// Recompute the pixels of poOvrBand that depend on the source pixels of
+// the [nXOff,nXEnd[x[nYOff,nYEnd[ window of poSrcBand. On return, the
+// window is the one of poOvrBand that has been rewritten.
+static CPLErr
+GDALRegenerateOverviewWindow( GDALRasterBand *poSrcBand,
+                              GDALRasterBand *poOvrBand,
+                              const char * pszResampling,
+                              int& nXOff, int& nYOff,
+                              int& nXEnd, int& nYEnd )
+{
+    int nKernelRadius = 0;
+    GDALResampleFunction pfnResampleFn
+        = GDALGetResampleFunction(pszResampling, &nKernelRadius);
+    if( pfnResampleFn == nullptr )
+        return CE_Failure;
+
+    GDALColorTable* poColorTable = nullptr;
+    if( (STARTS_WITH_CI(pszResampling, "AVER")
+         || STARTS_WITH_CI(pszResampling, "MODE")
+         || STARTS_WITH_CI(pszResampling, "GAUSS")) &&
+        poSrcBand->GetColorInterpretation() == GCI_PaletteIndex )
+    {
+        poColorTable = poSrcBand->GetColorTable();
+        if( poColorTable != nullptr &&
+            poColorTable->GetPaletteInterpretation() != GPI_RGB )
+            poColorTable = nullptr;
+    }
+
+    GDALRasterBand* poMaskBand = nullptr;
+    bool bUseNoDataMask = false;
+    if( !STARTS_WITH_CI(pszResampling, "NEAR") )
+    {
+        // As in GDALRegenerateOverviews(), an alpha band is its own mask.
+        if( poSrcBand->GetColorInterpretation() == GCI_AlphaBand )
+        {
+            poMaskBand = poSrcBand;
+            bUseNoDataMask = true;
+        }
+        else
+        {
+            poMaskBand = poSrcBand->GetMaskBand();
+            bUseNoDataMask =
+                (poSrcBand->GetMaskFlags() & GMF_ALL_VALID) == 0;
+        }
+    }
+
+    GDALDataType eType = GDT_Unknown;
+    if( GDALDataTypeIsComplex( poSrcBand->GetRasterDataType() ) )
+        eType = GDT_CFloat32;
+    else
+        eType = GDALGetOvrWorkDataType( pszResampling,
+                                        poSrcBand->GetRasterDataType() );
+    // GDALResampleChunkC32R() only processes whole lines.
+    const bool bWholeLines =
+        eType != GDT_Byte && eType != GDT_UInt16 && eType != GDT_Float32;
+
+    const int nWidth = poSrcBand->GetXSize();
+    const int nHeight = poSrcBand->GetYSize();
+    const int nDstWidth = poOvrBand->GetXSize();
+    const int nDstHeight = poOvrBand->GetYSize();
+    const double dfXRatioDstToSrc = static_cast<double>(nWidth) / nDstWidth;
+    const double dfYRatioDstToSrc = static_cast<double>(nHeight) / nDstHeight;
+
+/* -------------------------------------------------------------------- */
+/*      Destination pixels whose source footprint, enlarged by the      */
+/*      kernel, may intersect the window. Recomputing a few unchanged   */
+/*      pixels more is harmless.                                        */
+/* -------------------------------------------------------------------- */
+    const int nDstMargin = nKernelRadius + 1;
+    int nDstXOff = std::max(0,
+        static_cast<int>(nXOff / dfXRatioDstToSrc) - nDstMargin);
+    int nDstXEnd = std::min(nDstWidth,
+        static_cast<int>(std::ceil(nXEnd / dfXRatioDstToSrc)) + nDstMargin);
+    const int nDstYOff = std::max(0,
+        static_cast<int>(nYOff / dfYRatioDstToSrc) - nDstMargin);
+    const int nDstYEnd = std::min(nDstHeight,
+        static_cast<int>(std::ceil(nYEnd / dfYRatioDstToSrc)) + nDstMargin);
+    if( bWholeLines )
+    {
+        nDstXOff = 0;
+        nDstXEnd = nDstWidth;
+    }
+    nXOff = nDstXOff;
+    nYOff = nDstYOff;
+    nXEnd = nDstXEnd;
+    nYEnd = nDstYEnd;
+    if( nDstXOff >= nDstXEnd || nDstYOff >= nDstYEnd )
+        return CE_None;
+
+    // Source pixels needed so that the kernels are not truncated more
+    // than when the whole overview is computed.
+    const int nSrcXMargin =
+        nKernelRadius * static_cast<int>(std::ceil(dfXRatioDstToSrc)) + 1;
+    const int nSrcYMargin =
+        nKernelRadius * static_cast<int>(std::ceil(dfYRatioDstToSrc)) + 1;
+    const int nChunkXOff = bWholeLines ? 0 : std::max(0,
+        static_cast<int>(nDstXOff * dfXRatioDstToSrc) - nSrcXMargin);
+    const int nChunkXEnd = bWholeLines ? nWidth : std::min(nWidth,
+        static_cast<int>(std::ceil(nDstXEnd * dfXRatioDstToSrc)) +
+            nSrcXMargin);
+    const int nChunkXSize = nChunkXEnd - nChunkXOff;
+
+/* -------------------------------------------------------------------- */
+/*      Process the window by swaths of destination lines.              */
+/* -------------------------------------------------------------------- */
+    int nFRXBlockSize = 0;
+    int nFRYBlockSize = 0;
+    poSrcBand->GetBlockSize( &nFRXBlockSize, &nFRYBlockSize );
+    const int nFullResYChunk =
+        (nFRYBlockSize < 16 || nFRYBlockSize > 256) ? 64 : nFRYBlockSize;
+    const int nDstYChunk =
+        std::max(1, static_cast<int>(nFullResYChunk / dfYRatioDstToSrc));
+    const int nMaxChunkYSize =
+        static_cast<int>(std::ceil(nDstYChunk * dfYRatioDstToSrc)) +
+        2 * nSrcYMargin + 2;
+
+    void *pChunk = VSI_MALLOC3_VERBOSE(
+        GDALGetDataTypeSizeBytes(eType), nMaxChunkYSize, nChunkXSize );
+    GByte *pabyChunkNodataMask = bUseNoDataMask ?
+        static_cast<GByte*>(VSI_MALLOC2_VERBOSE(nMaxChunkYSize, nChunkXSize)) :
+        nullptr;
+    if( pChunk == nullptr ||
+        (bUseNoDataMask && pabyChunkNodataMask == nullptr) )
+    {
+        CPLFree(pChunk);
+        CPLFree(pabyChunkNodataMask);
+        return CE_Failure;
+    }
+
+    int bHasNoData = FALSE;
+    const float fNoDataValue =
+        static_cast<float>( poSrcBand->GetNoDataValue(&bHasNoData) );
+    const bool bPropagateNoData =
+        CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
+    const GDALDataType eSrcDataType = poSrcBand->GetRasterDataType();
+
+    CPLErr eErr = CE_None;
+    for( int iDstY = nDstYOff; iDstY < nDstYEnd && eErr == CE_None;
+         iDstY += nDstYChunk )
+    {
+        const int iDstY2 = std::min(nDstYEnd, iDstY + nDstYChunk);
+        const int nChunkYOff = std::max(0,
+            static_cast<int>(iDstY * dfYRatioDstToSrc) - nSrcYMargin);
+        const int nChunkYSize = std::min(nHeight,
+            static_cast<int>(std::ceil(iDstY2 * dfYRatioDstToSrc)) +
+                nSrcYMargin) - nChunkYOff;
+
+        eErr = poSrcBand->RasterIO(
+            GF_Read, nChunkXOff, nChunkYOff, nChunkXSize, nChunkYSize,
+            pChunk, nChunkXSize, nChunkYSize, eType, 0, 0, nullptr );
+        if( eErr == CE_None && bUseNoDataMask )
+            eErr = poMaskBand->RasterIO(
+                GF_Read, nChunkXOff, nChunkYOff, nChunkXSize, nChunkYSize,
+                pabyChunkNodataMask, nChunkXSize, nChunkYSize, GDT_Byte,
+                0, 0, nullptr );
+        if( eErr != CE_None )
+            break;
+
+        GDALOvrPromoteBit2Grayscale(
+            pszResampling, eType, pChunk,
+            static_cast<GPtrDiff_t>(nChunkYSize) * nChunkXSize );
+
+        if( !bWholeLines )
+            eErr = pfnResampleFn(
+                dfXRatioDstToSrc, dfYRatioDstToSrc,
+                0.0, 0.0,
+                eType,
+                pChunk,
+                pabyChunkNodataMask,
+                nChunkXOff, nChunkXSize,
+                nChunkYOff, nChunkYSize,
+                nDstXOff, nDstXEnd,
+                iDstY, iDstY2,
+                poOvrBand, pszResampling,
+                bHasNoData, fNoDataValue, poColorTable,
+                eSrcDataType,
+                bPropagateNoData);
+        else
+            eErr = GDALResampleChunkC32R(
+                nWidth, nHeight,
+                static_cast<float*>(pChunk),
+                nChunkYOff, nChunkYSize,
+                iDstY, iDstY2,
+                poOvrBand, pszResampling);
+    }
+
+    CPLFree(pChunk);
+    CPLFree(pabyChunkNodataMask);
+    return eErr;
+}
+
+/************************************************************************/
+/*                   GDALRegenerateOverviewsWindow()                    */
+/************************************************************************/
+
+/**
+ * \brief Regenerate the part of overview bands that depends on a window of
+ * the source band.
+ *
+ * This is the same as GDALRegenerateOverviews(), except that only the
+ * overview pixels computed from source pixels of the
+ * (nXOff,nYOff,nXSize,nYSize) window are recomputed and rewritten. It is
+ * typically used to refresh the overviews of a dataset of which a small
+ * region has been updated, without recomputing the whole pyramid.
+ *
+ * When GDALRegenerateOverviews() would compute each level from the
+ * previous one, the refreshed region of each level is used as the window
+ * of the next one, so the result is the same as the one of a full
+ * regeneration. The AVERAGE_MP method is not supported.
+ *
+ * @param hSrcBand the source (base level) band.
+ * @param nOverviewCount the number of downsampled bands being refreshed.
+ * @param pahOvrBands the list of downsampled bands to be refreshed.
+ * @param pszResampling Resampling algorithm (e.g. "AVERAGE").
+ * @param nXOff the pixel offset of the updated window of the source band.
+ * @param nYOff the line offset of the updated window of the source band.
+ * @param nXSize the width of the updated window.
+ * @param nYSize the height of the updated window.
+ * @param pfnProgress progress report function.
+ * @param pProgressData progress function callback data.
+ * @return CE_None on success or CE_Failure on failure.
+ *
+ * @since GDAL 3.1
+ */
+CPLErr
+GDALRegenerateOverviewsWindow( GDALRasterBandH hSrcBand,
+                               int nOverviewCount,
+                               GDALRasterBandH *pahOvrBands,
+                               const char * pszResampling,
+                               int nXOff, int nYOff, int nXSize, int nYSize,
+                               GDALProgressFunc pfnProgress,
+                               void * pProgressData )
+{
+    VALIDATE_POINTER1( hSrcBand, "GDALRegenerateOverviewsWindow", CE_Failure );
+    GDALRasterBand *poSrcBand = GDALRasterBand::FromHandle( hSrcBand );
+
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
+
+    if( EQUAL(pszResampling, "NONE") )
+        return CE_None;
+    if( EQUAL(pszResampling, "AVERAGE_MP") )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "AVERAGE_MP resampling is not supported when refreshing "
+                  "a window of overviews." );
+        return CE_Failure;
+    }
+
+    if( nXOff < 0 || nYOff < 0 || nXSize <= 0 || nYSize <= 0 ||
+        nXOff > poSrcBand->GetXSize() - nXSize ||
+        nYOff > poSrcBand->GetYSize() - nYSize )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Window %d,%d,%d,%d is not within the %dx%d raster.",
+                  nXOff, nYOff, nXSize, nYSize,
+                  poSrcBand->GetXSize(), poSrcBand->GetYSize() );
+        return CE_Failure;
+    }
+
+    // Put the overviews in order from largest to smallest.
+    std::vector<GDALRasterBand*> apoOvrBands;
+    for( int i = 0; i < nOverviewCount; ++i )
+        apoOvrBands.push_back( GDALRasterBand::FromHandle(pahOvrBands[i]) );
+    std::stable_sort(apoOvrBands.begin(), apoOvrBands.end(),
+        [](GDALRasterBand* poA, GDALRasterBand* poB)
+        {
+            return poA->GetXSize() * static_cast<double>(poA->GetYSize()) >
+                   poB->GetXSize() * static_cast<double>(poB->GetYSize());
+        });
+
+    // Same conditions as in GDALRegenerateOverviews() to compute each
+    // level from the previous one.
+    bool bCascading = false;
+    if( (STARTS_WITH_CI(pszResampling, "AVER") ||
+         STARTS_WITH_CI(pszResampling, "GAUSS") ||
+         EQUAL(pszResampling, "CUBIC") ||
+         EQUAL(pszResampling, "CUBICSPLINE") ||
+         EQUAL(pszResampling, "LANCZOS") ||
+         EQUAL(pszResampling, "BILINEAR")) && nOverviewCount > 1 )
+    {
+        const int nMaskFlags =
+            poSrcBand->GetColorInterpretation() == GCI_AlphaBand ?
+                (GMF_ALPHA | GMF_PER_DATASET) : poSrcBand->GetMaskFlags();
+        const bool bUseNoDataMask = (nMaskFlags & GMF_ALL_VALID) == 0;
+        bCascading = !(bUseNoDataMask && nMaskFlags != GMF_NODATA);
+    }
+
+    int nWinXOff = nXOff;
+    int nWinYOff = nYOff;
+    int nWinXEnd = nXOff + nXSize;
+    int nWinYEnd = nYOff + nYSize;
+    CPLErr eErr = CE_None;
+    for( int i = 0; i < nOverviewCount && eErr == CE_None; ++i )
+    {
+        if( !pfnProgress( static_cast<double>(i) / nOverviewCount,
+                          nullptr, pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            return CE_Failure;
+        }
+
+        GDALRasterBand* poBaseBand = poSrcBand;
+        if( bCascading && i > 0 )
+        {
+            poBaseBand = apoOvrBands[i-1];
+        }
+        else
+        {
+            nWinXOff = nXOff;
+            nWinYOff = nYOff;
+            nWinXEnd = nXOff + nXSize;
+            nWinYEnd = nYOff + nYSize;
+        }
+        if( nWinXOff >= nWinXEnd || nWinYOff >= nWinYEnd )
+            break;
+
+        eErr = GDALRegenerateOverviewWindow( poBaseBand, apoOvrBands[i],
+                                             pszResampling,
+                                             nWinXOff, nWinYOff,
+                                             nWinXEnd, nWinYEnd );
+
+        // Only do the bit2grayscale promotion on the base band.
+        if( bCascading &&
+            STARTS_WITH_CI( pszResampling,
+                            "AVERAGE_BIT2G" /* AVERAGE_BIT2GRAYSCALE */) )
+            pszResampling = "AVERAGE";
+    }
+
+    for( int i = 0; eErr == CE_None && i < nOverviewCount; ++i )
+        eErr = apoOvrBands[i]->FlushCache();
+
+    if( eErr == CE_None )
+        pfnProgress( 1.0, nullptr, pProgressData );
+
+    return eErr;
+}
+
 /************************************************************************/
 /*            GDALRegenerateOverviewsMultiBand()                        */
 /************************************************************************/
@@ -3479,6 +4684,9 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
  * considered as the nodata value and not each value of the triplet
  * independently per band.
  *
+ * Starting with GDAL 3.1, the GDAL_NUM_THREADS configuration option can be
+ * used to do the resampling in worker threads, as in GDALRegenerateOverviews().
+ *
  * @param nBands the number of bands, size of papoSrcBands and size of
  *               first dimension of papapoOverviewBands
  * @param papoSrcBands the list of source bands to downsample
@@ -3633,6 +4841,18 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
     const bool bPropagateNoData =
         CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
 
+    // When several threads are available, the resampling of the chunks is
+    // done by worker threads, each job owning its chunk buffers, while this
+    // thread reads ahead the next chunks and writes the results in order.
+    std::unique_ptr<GDALOverviewJobQueue> poJobQueue;
+    const int nThreads = CPLGetNumThreads();
+    if( nThreads > 1 )
+    {
+        poJobQueue.reset(new GDALOverviewJobQueue());
+        if( !poJobQueue->Setup(nThreads) )
+            poJobQueue.reset();
+    }
+
     // Second pass to do the real job.
     double dfCurPixelCount = 0;
     CPLErr eErr = CE_None;
@@ -3709,7 +4929,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
             return CE_Failure;
         }
         GByte* pabyChunkNoDataMask = nullptr;
-        for( int iBand = 0; iBand < nBands; ++iBand )
+        for( int iBand = 0; poJobQueue == nullptr && iBand < nBands; ++iBand )
         {
             papaChunk[iBand] = VSI_MALLOC3_VERBOSE(
                 nFullResXChunkQueried,
@@ -3725,7 +4945,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                 return CE_Failure;
             }
         }
-        if( bUseNoDataMask )
+        if( poJobQueue == nullptr && bUseNoDataMask )
         {
             pabyChunkNoDataMask = static_cast<GByte *>(
                 VSI_MALLOC2_VERBOSE( nFullResXChunkQueried,
@@ -3825,6 +5045,29 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                     nDstXOff, nDstYOff, nDstXCount, nDstYCount );
 #endif
 
+                std::unique_ptr<GDALOverviewJob> poJob;
+                if( poJobQueue )
+                {
+                    poJob.reset(new GDALOverviewJob());
+                    for( int iBand = 0; eErr == CE_None && iBand < nBands;
+                         ++iBand )
+                    {
+                        papaChunk[iBand] = poJob->AllocBuffer(
+                            nChunkXSizeQueried, nChunkYSizeQueried,
+                            GDALGetDataTypeSizeBytes(eWrkDataType) );
+                        if( papaChunk[iBand] == nullptr )
+                            eErr = CE_Failure;
+                    }
+                    if( eErr == CE_None && bUseNoDataMask )
+                    {
+                        pabyChunkNoDataMask = static_cast<GByte *>(
+                            poJob->AllocBuffer( 1, nChunkXSizeQueried,
+                                                nChunkYSizeQueried ) );
+                        if( pabyChunkNoDataMask == nullptr )
+                            eErr = CE_Failure;
+                    }
+                }
+
                 // Read the source buffers for all the bands.
                 for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
                 {
@@ -3861,39 +5104,78 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                 // Compute the resulting overview block.
                 for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
                 {
-                    eErr = pfnResampleFn(
-                        dfXRatioDstToSrc, dfYRatioDstToSrc,
-                        0.0, 0.0,
-                        eWrkDataType,
-                        papaChunk[iBand],
-                        pabyChunkNoDataMask,
-                        nChunkXOffQueried, nChunkXSizeQueried,
-                        nChunkYOffQueried, nChunkYSizeQueried,
-                        nDstXOff, nDstXOff + nDstXCount,
-                        nDstYOff, nDstYOff + nDstYCount,
-                        papapoOverviewBands[iBand][iOverview],
-                        pszResampling,
-                        pabHasNoData[iBand],
-                        pafNoDataValue[iBand],
-                        /*poColorTable*/ nullptr,
-                        eDataType,
-                        bPropagateNoData);
+                    GDALRasterBand* poDstBand =
+                        papapoOverviewBands[iBand][iOverview];
+                    if( poJob )
+                    {
+                        poDstBand = poJob->AddCaptureBand(
+                            poDstBand, nDstXOff, nDstYOff,
+                            nDstXCount, nDstYCount );
+                        if( poDstBand == nullptr )
+                        {
+                            eErr = CE_Failure;
+                            break;
+                        }
+                    }
+
+                    void* pChunk = papaChunk[iBand];
+                    const int bHasNoData = pabHasNoData[iBand];
+                    const float fNoDataValue = pafNoDataValue[iBand];
+                    auto oResample = [=]()
+                    {
+                        return pfnResampleFn(
+                            dfXRatioDstToSrc, dfYRatioDstToSrc,
+                            0.0, 0.0,
+                            eWrkDataType,
+                            pChunk,
+                            pabyChunkNoDataMask,
+                            nChunkXOffQueried, nChunkXSizeQueried,
+                            nChunkYOffQueried, nChunkYSizeQueried,
+                            nDstXOff, nDstXOff + nDstXCount,
+                            nDstYOff, nDstYOff + nDstYCount,
+                            poDstBand,
+                            pszResampling,
+                            bHasNoData,
+                            fNoDataValue,
+                            /*poColorTable*/ nullptr,
+                            eDataType,
+                            bPropagateNoData);
+                    };
+                    if( poJob )
+                        poJob->aoTasks.push_back(oResample);
+                    else
+                        eErr = oResample();
                 }
+
+                if( poJob && eErr == CE_None )
+                    eErr = poJobQueue->Submit(std::move(poJob));
             }
 
             dfCurPixelCount += static_cast<double>(nYCount) * nSrcWidth;
         }
 
+        // The next level is computed from this one, so all its chunks must
+        // have been written.
+        if( poJobQueue )
+        {
+            const CPLErr eErrJobs = poJobQueue->FlushAll();
+            if( eErr == CE_None )
+                eErr = eErrJobs;
+        }
+
         // Flush the data to overviews.
         for( int iBand = 0; iBand < nBands; ++iBand )
         {
-            CPLFree(papaChunk[iBand]);
+            if( poJobQueue == nullptr )
+                CPLFree(papaChunk[iBand]);
             papapoOverviewBands[iBand][iOverview]->FlushCache();
         }
         CPLFree(papaChunk);
-        CPLFree(pabyChunkNoDataMask);
+        if( poJobQueue == nullptr )
+            CPLFree(pabyChunkNoDataMask);
     }
 
+    poJobQueue.reset();
     CPLFree(pabHasNoData);
     CPLFree(pafNoDataValue);
 
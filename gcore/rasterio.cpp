@@ -40,8 +40,12 @@
 #include <cstring>
 
 #include <algorithm>
+#include <condition_variable>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_cpu_features.h"
@@ -49,6 +53,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_priv_templates.hpp"
 #include "gdal_vrt.h"
 #include "gdalwarper.h"
@@ -266,11 +271,13 @@ CPLErr GDALRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         }
     }
 
+    static const CPLCachedConfigOption oNoCostlyOverview(
+        "GDAL_NO_COSTLY_OVERVIEW", "NO");
     if( eRWFlag == GF_Read &&
         nBufXSize < nXSize / 100 && nBufYSize < nYSize / 100 &&
         nPixelSpace == nBufDataSize &&
         nLineSpace == nPixelSpace * nBufXSize &&
-        CPLTestBool(CPLGetConfigOption("GDAL_NO_COSTLY_OVERVIEW", "NO")) )
+        oNoCostlyOverview.GetBool() )
     {
         memset( pData, 0, static_cast<size_t>(nLineSpace * nBufYSize) );
         return CE_None;
@@ -2030,6 +2037,77 @@ static void inline GDALCopyWordsT_8atatime( const Tin* const CPL_RESTRICT pSrcDa
 
 #include <emmintrin.h>
 
+/************************************************************************/
+/*                       GDALCopyWordsStridedT()                        */
+/************************************************************************/
+/**
+ * Fallback of the SSE2 specializations of GDALCopyWordsT() for non packed
+ * layouts (typically pixel-interleaved buffers). Words are gathered into
+ * and/or scattered from small packed staging buffers, so that the
+ * conversion itself still goes through the vectorized packed code path.
+ */
+
+template<class Tin, class Tout>
+static void GDALCopyWordsStridedT( const Tin* const CPL_RESTRICT pSrcData,
+                                   int nSrcPixelStride,
+                                   Tout* const CPL_RESTRICT pDstData,
+                                   int nDstPixelStride,
+                                   GPtrDiff_t nWordCount )
+{
+    constexpr int knChunkSize = 256;
+    if( nWordCount < 32 || nSrcPixelStride <= 0 || nDstPixelStride <= 0 )
+    {
+        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+        return;
+    }
+
+    const bool bPackedSrc =
+        nSrcPixelStride == static_cast<int>(sizeof(Tin));
+    const bool bPackedDst =
+        nDstPixelStride == static_cast<int>(sizeof(Tout));
+    const char* const pSrcDataPtr = reinterpret_cast<const char*>(pSrcData);
+    char* const pDstDataPtr = reinterpret_cast<char*>(pDstData);
+    Tin atSrcChunk[knChunkSize];
+    Tout atDstChunk[knChunkSize];
+    for( decltype(nWordCount) n = 0; n < nWordCount; n += knChunkSize )
+    {
+        const int nChunk = static_cast<int>(
+            std::min(static_cast<GPtrDiff_t>(knChunkSize), nWordCount - n));
+
+        const Tin* pChunkSrc = atSrcChunk;
+        if( bPackedSrc )
+        {
+            pChunkSrc = pSrcData + n;
+        }
+        else
+        {
+            const char* pSrc = pSrcDataPtr + n * nSrcPixelStride;
+            for( int i = 0; i < nChunk; i++ )
+            {
+                atSrcChunk[i] = *reinterpret_cast<const Tin*>(pSrc);
+                pSrc += nSrcPixelStride;
+            }
+        }
+
+        Tout* pChunkDst = bPackedDst ? pDstData + n : atDstChunk;
+        GDALCopyWordsT(pChunkSrc, static_cast<int>(sizeof(Tin)),
+                       pChunkDst, static_cast<int>(sizeof(Tout)),
+                       static_cast<GPtrDiff_t>(nChunk));
+
+        if( !bPackedDst )
+        {
+            char* pDst = pDstDataPtr + n * nDstPixelStride;
+            for( int i = 0; i < nChunk; i++ )
+            {
+                *reinterpret_cast<Tout*>(pDst) = atDstChunk[i];
+                pDst += nDstPixelStride;
+            }
+        }
+    }
+}
+
 template<class Tout> void GDALCopyWordsByteTo16Bit(
                                 const GByte* const CPL_RESTRICT pSrcData,
                                 int nSrcPixelStride,
@@ -2061,7 +2139,7 @@ template<class Tout> void GDALCopyWordsByteTo16Bit(
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2126,7 +2204,7 @@ template<class Tout> void GDALCopyWordsByteTo32Bit(
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2194,7 +2272,7 @@ template<> void GDALCopyWordsT( const GByte* const CPL_RESTRICT pSrcData,
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2260,7 +2338,7 @@ template<> void GDALCopyWordsT( const GByte* const CPL_RESTRICT pSrcData,
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2298,7 +2376,7 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2336,7 +2414,7 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2374,7 +2452,7 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2422,7 +2500,7 @@ template<> void GDALCopyWordsT( const GUInt16* const CPL_RESTRICT pSrcData,
     }
     else
     {
-        GDALCopyWordsGenericT(pSrcData, nSrcPixelStride,
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
                               pDstData, nDstPixelStride,
                               nWordCount);
     }
@@ -2438,6 +2516,250 @@ template<> void GDALCopyWordsT( const double* const CPL_RESTRICT pSrcData,
                              pDstData, nDstPixelStride, nWordCount );
 }
 
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GByte* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                GPtrDiff_t nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        decltype(nWordCount) n = 0;
+        for (; n < nWordCount-15; n+=16)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 8) );
+            // Pack int16 to uint8 with unsigned saturation, that is clamp
+            // to [0,255]
+            xmm0 = _mm_packus_epi16(xmm0, xmm1);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm0 );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GUInt16* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                GPtrDiff_t nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        decltype(nWordCount) n = 0;
+        const __m128i xmm_zero = _mm_setzero_si128 ();
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            xmm = _mm_max_epi16(xmm, xmm_zero);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                float* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                GPtrDiff_t nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        decltype(nWordCount) n = 0;
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            // Sign extend int16 to int32: put each int16 in the upper half
+            // of a int32, and use an arithmetic right shift.
+            __m128i xmm0 = _mm_srai_epi32(_mm_unpacklo_epi16(xmm, xmm), 16);
+            __m128i xmm1 = _mm_srai_epi32(_mm_unpackhi_epi16(xmm, xmm), 16);
+            _mm_storeu_ps( pDstData + n, _mm_cvtepi32_ps(xmm0) );
+            _mm_storeu_ps( pDstData + n + 4, _mm_cvtepi32_ps(xmm1) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt16* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                double* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                GPtrDiff_t nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        decltype(nWordCount) n = 0;
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm0 = _mm_srai_epi32(_mm_unpacklo_epi16(xmm, xmm), 16);
+            __m128i xmm1 = _mm_srai_epi32(_mm_unpackhi_epi16(xmm, xmm), 16);
+            _mm_storeu_pd( pDstData + n, _mm_cvtepi32_pd(xmm0) );
+            _mm_storeu_pd( pDstData + n + 2,
+                           _mm_cvtepi32_pd(_mm_srli_si128(xmm0, 8)) );
+            _mm_storeu_pd( pDstData + n + 4, _mm_cvtepi32_pd(xmm1) );
+            _mm_storeu_pd( pDstData + n + 6,
+                           _mm_cvtepi32_pd(_mm_srli_si128(xmm1, 8)) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                GByte* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                GPtrDiff_t nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        decltype(nWordCount) n = 0;
+        for (; n < nWordCount-15; n+=16)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) );
+            __m128i xmm2 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 8) );
+            __m128i xmm3 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 12) );
+            // Signed saturation to int16 preserves the ordering, so the
+            // unsigned saturation to uint8 that follows clamps to [0,255]
+            xmm0 = _mm_packs_epi32(xmm0, xmm1);
+            xmm2 = _mm_packs_epi32(xmm2, xmm3);
+            xmm0 = _mm_packus_epi16(xmm0, xmm2);
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(pDstData + n),
+                              xmm0 );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            GDALCopyWord(pSrcData[n], pDstData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const GInt32* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                float* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                GPtrDiff_t nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        decltype(nWordCount) n = 0;
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n) );
+            __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*> (pSrcData + n + 4) );
+            _mm_storeu_ps( pDstData + n, _mm_cvtepi32_ps(xmm0) );
+            _mm_storeu_ps( pDstData + n + 4, _mm_cvtepi32_ps(xmm1) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = static_cast<float>(pSrcData[n]);
+        }
+    }
+    else
+    {
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
+template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
+                                int nSrcPixelStride,
+                                double* const CPL_RESTRICT pDstData,
+                                int nDstPixelStride,
+                                GPtrDiff_t nWordCount )
+{
+    if( nSrcPixelStride == static_cast<int>(sizeof(*pSrcData)) &&
+        nDstPixelStride == static_cast<int>(sizeof(*pDstData)) )
+    {
+        decltype(nWordCount) n = 0;
+        for (; n < nWordCount-7; n+=8)
+        {
+            __m128 xmm0 = _mm_loadu_ps( pSrcData + n );
+            __m128 xmm1 = _mm_loadu_ps( pSrcData + n + 4 );
+            _mm_storeu_pd( pDstData + n, _mm_cvtps_pd(xmm0) );
+            _mm_storeu_pd( pDstData + n + 2,
+                           _mm_cvtps_pd(_mm_movehl_ps(xmm0, xmm0)) );
+            _mm_storeu_pd( pDstData + n + 4, _mm_cvtps_pd(xmm1) );
+            _mm_storeu_pd( pDstData + n + 6,
+                           _mm_cvtps_pd(_mm_movehl_ps(xmm1, xmm1)) );
+        }
+        for( ; n < nWordCount; n++  )
+        {
+            pDstData[n] = pSrcData[n];
+        }
+    }
+    else
+    {
+        GDALCopyWordsStridedT(pSrcData, nSrcPixelStride,
+                              pDstData, nDstPixelStride,
+                              nWordCount);
+    }
+}
+
 #endif // defined(__x86_64) || defined(_M_X64)
 
 template<> void GDALCopyWordsT( const float* const CPL_RESTRICT pSrcData,
@@ -3007,6 +3329,164 @@ template<> void GDALUnrolledCopy<GByte,4,1>( GByte* CPL_RESTRICT pDest,
 }
 #endif // defined(__x86_64) || defined(_M_X64)
 
+/************************************************************************/
+/*                        GDALInterleaveWords()                         */
+/*                                                                      */
+/*      Copy nIters words of nBandCount buffers, of nWordSize bytes, to */
+/*      a buffer where the words of a pixel are contiguous and pixels   */
+/*      are nPixelSpace bytes apart.                                    */
+/************************************************************************/
+
+template<class T>
+static void GDALInterleaveWordsGeneric( const GByte* const* papabySrc,
+                                        int nBandCount,
+                                        GByte* CPL_RESTRICT pabyDest,
+                                        GPtrDiff_t nPixelSpace,
+                                        GPtrDiff_t nIters )
+{
+    for( GPtrDiff_t i = 0; i < nIters; i++ )
+    {
+        GByte* pabyPixel = pabyDest + i * nPixelSpace;
+        for( int iBand = 0; iBand < nBandCount; iBand++ )
+        {
+            memcpy( pabyPixel + iBand * sizeof(T),
+                    papabySrc[iBand] + i * sizeof(T), sizeof(T) );
+        }
+    }
+}
+
+#if (defined(__x86_64) || defined(_M_X64)) &&  !(defined(__GNUC__) && __GNUC__ < 4)
+
+#ifdef HAVE_SSSE3_AT_COMPILE_TIME
+void GDALInterleave3Byte_SSSE3( const GByte* CPL_RESTRICT pSrc0,
+                                const GByte* CPL_RESTRICT pSrc1,
+                                const GByte* CPL_RESTRICT pSrc2,
+                                GByte* CPL_RESTRICT pDest,
+                                GPtrDiff_t nIters );
+#endif
+
+static void GDALInterleave2Byte( const GByte* CPL_RESTRICT pSrc0,
+                                 const GByte* CPL_RESTRICT pSrc1,
+                                 GByte* CPL_RESTRICT pDest,
+                                 GPtrDiff_t nIters )
+{
+    decltype(nIters) i = 0;
+    for( ; i + 16 <= nIters; i += 16 )
+    {
+        const __m128i xmm0 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc0 + i) );
+        const __m128i xmm1 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc1 + i) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 2 * i),
+                          _mm_unpacklo_epi8(xmm0, xmm1) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 2 * i + 16),
+                          _mm_unpackhi_epi8(xmm0, xmm1) );
+    }
+    for( ; i < nIters; i++ )
+    {
+        pDest[2 * i] = pSrc0[i];
+        pDest[2 * i + 1] = pSrc1[i];
+    }
+}
+
+static void GDALInterleave4Byte( const GByte* CPL_RESTRICT pSrc0,
+                                 const GByte* CPL_RESTRICT pSrc1,
+                                 const GByte* CPL_RESTRICT pSrc2,
+                                 const GByte* CPL_RESTRICT pSrc3,
+                                 GByte* CPL_RESTRICT pDest,
+                                 GPtrDiff_t nIters )
+{
+    decltype(nIters) i = 0;
+    for( ; i + 16 <= nIters; i += 16 )
+    {
+        const __m128i xmm0 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc0 + i) );
+        const __m128i xmm1 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc1 + i) );
+        const __m128i xmm2 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc2 + i) );
+        const __m128i xmm3 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc3 + i) );
+        // Pairs of bands 0,1 and 2,3, then the 4 bytes of each pixel.
+        const __m128i xmm01lo = _mm_unpacklo_epi8(xmm0, xmm1);
+        const __m128i xmm01hi = _mm_unpackhi_epi8(xmm0, xmm1);
+        const __m128i xmm23lo = _mm_unpacklo_epi8(xmm2, xmm3);
+        const __m128i xmm23hi = _mm_unpackhi_epi8(xmm2, xmm3);
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 4 * i),
+                          _mm_unpacklo_epi16(xmm01lo, xmm23lo) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 4 * i + 16),
+                          _mm_unpackhi_epi16(xmm01lo, xmm23lo) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 4 * i + 32),
+                          _mm_unpacklo_epi16(xmm01hi, xmm23hi) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 4 * i + 48),
+                          _mm_unpackhi_epi16(xmm01hi, xmm23hi) );
+    }
+    for( ; i < nIters; i++ )
+    {
+        pDest[4 * i] = pSrc0[i];
+        pDest[4 * i + 1] = pSrc1[i];
+        pDest[4 * i + 2] = pSrc2[i];
+        pDest[4 * i + 3] = pSrc3[i];
+    }
+}
+
+#endif // defined(__x86_64) || defined(_M_X64)
+
+static void GDALInterleaveWords( const GByte* const* papabySrc,
+                                 int nBandCount, int nWordSize,
+                                 GByte* pabyDest, GPtrDiff_t nPixelSpace,
+                                 GPtrDiff_t nIters )
+{
+#if (defined(__x86_64) || defined(_M_X64)) &&  !(defined(__GNUC__) && __GNUC__ < 4)
+    if( nWordSize == 1 && nPixelSpace == nBandCount )
+    {
+        if( nBandCount == 2 )
+        {
+            GDALInterleave2Byte(papabySrc[0], papabySrc[1], pabyDest, nIters);
+            return;
+        }
+#ifdef HAVE_SSSE3_AT_COMPILE_TIME
+        if( nBandCount == 3 && CPLHaveRuntimeSSSE3() )
+        {
+            GDALInterleave3Byte_SSSE3(papabySrc[0], papabySrc[1],
+                                      papabySrc[2], pabyDest, nIters);
+            return;
+        }
+#endif
+        if( nBandCount == 4 )
+        {
+            GDALInterleave4Byte(papabySrc[0], papabySrc[1], papabySrc[2],
+                                papabySrc[3], pabyDest, nIters);
+            return;
+        }
+    }
+#endif
+
+    switch( nWordSize )
+    {
+        case 1:
+            GDALInterleaveWordsGeneric<GByte>(papabySrc, nBandCount,
+                                              pabyDest, nPixelSpace, nIters);
+            break;
+        case 2:
+            GDALInterleaveWordsGeneric<GUInt16>(papabySrc, nBandCount,
+                                                pabyDest, nPixelSpace, nIters);
+            break;
+        case 4:
+            GDALInterleaveWordsGeneric<GUInt32>(papabySrc, nBandCount,
+                                                pabyDest, nPixelSpace, nIters);
+            break;
+        case 8:
+            GDALInterleaveWordsGeneric<double>(papabySrc, nBandCount,
+                                               pabyDest, nPixelSpace, nIters);
+            break;
+        default:
+            for( GPtrDiff_t i = 0; i < nIters; i++ )
+            {
+                for( int iBand = 0; iBand < nBandCount; iBand++ )
+                {
+                    memcpy( pabyDest + i * nPixelSpace + iBand * nWordSize,
+                            papabySrc[iBand] + i * nWordSize, nWordSize );
+                }
+            }
+            break;
+    }
+}
+
 /************************************************************************/
 /*                         GDALFastCopy()                               */
 /************************************************************************/
@@ -3865,6 +4345,31 @@ GDALDataset::BlockBasedRasterIO( GDALRWFlag eRWFlag,
         int nChunkYSize = 0;
         int nChunkXSize = 0;
 
+/* -------------------------------------------------------------------- */
+/*      When reading into a pixel interleaved buffer of the data type   */
+/*      of the bands, lock the blocks of all bands at a block position  */
+/*      and interleave their lines, rather than doing a strided copy    */
+/*      of each band over the same destination area.                    */
+/* -------------------------------------------------------------------- */
+        const int nBufDataSize = GDALGetDataTypeSizeBytes(eBufType);
+        bool bInterleave =
+            eRWFlag == GF_Read && nBandCount > 1 &&
+            nBandSpace == nBufDataSize &&
+            nPixelSpace >= static_cast<GSpacing>(nBandCount) * nBufDataSize;
+        for( int iBand = 0; bInterleave && iBand < nBandCount; iBand++ )
+        {
+            if( GetRasterBand(panBandMap[iBand])->GetRasterDataType() !=
+                                                                eBufType )
+                bInterleave = false;
+        }
+        std::vector<GDALRasterBlock*> apoChunkBlocks;
+        std::vector<const GByte*> apabyChunkSrc;
+        if( bInterleave )
+        {
+            apoChunkBlocks.resize(nBandCount);
+            apabyChunkSrc.resize(nBandCount);
+        }
+
         for( iBufYOff = 0; iBufYOff < nBufYSize; iBufYOff += nChunkYSize )
         {
             const int nChunkYOff = iBufYOff + nYOff;
@@ -3884,6 +4389,52 @@ GDALDataset::BlockBasedRasterIO( GDALRWFlag eRWFlag,
                     + iBufXOff * nPixelSpace
                     + static_cast<GPtrDiff_t>(iBufYOff) * nLineSpace;
 
+                if( bInterleave )
+                {
+                    const int nBlockX = nChunkXOff / nBlockXSize;
+                    const int nBlockY = nChunkYOff / nBlockYSize;
+                    for( int iBand = 0; iBand < nBandCount; iBand++ )
+                    {
+                        apoChunkBlocks[iBand] =
+                            GetRasterBand(panBandMap[iBand])->
+                                GetLockedBlockRef( nBlockX, nBlockY );
+                        if( apoChunkBlocks[iBand] == nullptr )
+                        {
+                            for( int i = 0; i < iBand; i++ )
+                                apoChunkBlocks[i]->DropLock();
+                            return CE_Failure;
+                        }
+                    }
+
+                    const GPtrDiff_t nSrcOffset =
+                        (static_cast<GPtrDiff_t>(nChunkYOff % nBlockYSize) *
+                            nBlockXSize + nChunkXOff % nBlockXSize) *
+                        nBufDataSize;
+                    for( int iY = 0; iY < nChunkYSize; iY++ )
+                    {
+                        const GPtrDiff_t nLineOffset = nSrcOffset +
+                            static_cast<GPtrDiff_t>(iY) * nBlockXSize *
+                            nBufDataSize;
+                        for( int iBand = 0; iBand < nBandCount; iBand++ )
+                        {
+                            apabyChunkSrc[iBand] =
+                                static_cast<const GByte*>(
+                                    apoChunkBlocks[iBand]->GetDataRef()) +
+                                nLineOffset;
+                        }
+                        GDALInterleaveWords(
+                            apabyChunkSrc.data(), nBandCount, nBufDataSize,
+                            pabyChunkData +
+                                static_cast<GPtrDiff_t>(iY) * nLineSpace,
+                            static_cast<GPtrDiff_t>(nPixelSpace),
+                            nChunkXSize );
+                    }
+
+                    for( int iBand = 0; iBand < nBandCount; iBand++ )
+                        apoChunkBlocks[iBand]->DropLock();
+                    continue;
+                }
+
                 for( int iBand = 0; iBand < nBandCount; iBand++ )
                 {
                     GDALRasterBand *poBand = GetRasterBand(panBandMap[iBand]);
@@ -4349,6 +4900,320 @@ static void GDALCopyWholeRasterGetSwathSize(
     *pnSwathLines = nSwathLines;
 }
 
+/************************************************************************/
+/*                  GDALDatasetCopyWholeRasterThreaded()                */
+/************************************************************************/
+
+namespace {
+
+struct GDALCopyError
+{
+    CPLErr      eErrClass = CE_None;
+    CPLErrorNum nErrNo = CPLE_None;
+    CPLString   osMsg{};
+};
+
+// A swath to copy: a window of a band, or of all the bands in the
+// interleaved case.
+struct GDALCopyChunk
+{
+    int         nBand = 0;  // 0 for all the bands
+    int         iX = 0;
+    int         iY = 0;
+    int         nCols = 0;
+    int         nLines = 0;
+
+    // Set by the reading job.
+    void       *pBuffer = nullptr;
+    bool        bHasData = true;
+    CPLErr      eErr = CE_None;
+    std::vector<GDALCopyError> aoErrors{};
+    bool        bDone = false;
+};
+
+struct GDALCopyReadContext
+{
+    std::mutex  oMutex{};
+    std::condition_variable oCV{};
+    // Source datasets not used by a running job. There is one less of
+    // them than of the swaths read ahead, so a job may have to wait for one.
+    std::vector<GDALDataset*> apoFreeSrcDS{};
+    GDALDataType eDT = GDT_Unknown;
+    int         nBandCount = 0;
+    bool        bCheckHoles = false;
+};
+
+struct GDALCopyReadJob
+{
+    GDALCopyReadContext *psContext;
+    GDALCopyChunk *psChunk;
+};
+
+} // namespace
+
+static void CPL_STDCALL GDALCopyErrorHandler( CPLErr eErrClass,
+                                              CPLErrorNum nErrNo,
+                                              const char* pszMsg )
+{
+    auto paoErrors =
+        static_cast<std::vector<GDALCopyError>*>(CPLGetErrorHandlerUserData());
+    GDALCopyError oError;
+    oError.eErrClass = eErrClass;
+    oError.nErrNo = nErrNo;
+    oError.osMsg = pszMsg;
+    paoErrors->push_back(oError);
+}
+
+static void GDALCopyReadJobFunc( void* pData )
+{
+    GDALCopyReadJob* psJob = static_cast<GDALCopyReadJob*>(pData);
+    GDALCopyReadContext* psContext = psJob->psContext;
+    GDALCopyChunk* psChunk = psJob->psChunk;
+
+    GDALDataset* poSrcDS = nullptr;
+    {
+        std::unique_lock<std::mutex> oLock(psContext->oMutex);
+        while( psContext->apoFreeSrcDS.empty() )
+            psContext->oCV.wait(oLock);
+        poSrcDS = psContext->apoFreeSrcDS.back();
+        psContext->apoFreeSrcDS.pop_back();
+    }
+
+    CPLPushErrorHandlerEx(GDALCopyErrorHandler, &psChunk->aoErrors);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+
+    int nStatus = GDAL_DATA_COVERAGE_STATUS_DATA;
+    if( psContext->bCheckHoles && psChunk->nBand > 0 )
+    {
+        nStatus = poSrcDS->GetRasterBand(psChunk->nBand)->GetDataCoverageStatus(
+            psChunk->iX, psChunk->iY, psChunk->nCols, psChunk->nLines,
+            GDAL_DATA_COVERAGE_STATUS_DATA);
+    }
+    psChunk->bHasData = (nStatus & GDAL_DATA_COVERAGE_STATUS_DATA) != 0;
+    if( psChunk->bHasData )
+    {
+        int nBand = psChunk->nBand;
+        psChunk->eErr = poSrcDS->RasterIO(
+            GF_Read, psChunk->iX, psChunk->iY, psChunk->nCols, psChunk->nLines,
+            psChunk->pBuffer, psChunk->nCols, psChunk->nLines,
+            psContext->eDT,
+            nBand > 0 ? 1 : psContext->nBandCount,
+            nBand > 0 ? &nBand : nullptr,
+            0, 0, 0, nullptr );
+    }
+
+    CPLPopErrorHandler();
+
+    {
+        std::lock_guard<std::mutex> oLock(psContext->oMutex);
+        psContext->apoFreeSrcDS.push_back(poSrcDS);
+        psChunk->bDone = true;
+    }
+    psContext->oCV.notify_all();
+    delete psJob;
+}
+
+// Reads the swaths with the global worker thread pool, several swaths ahead,
+// while the calling thread writes them in order. Each job reads from its
+// own handle of the source dataset, so that different swaths and bands are
+// read in parallel. The destination dataset is only accessed by the calling
+// thread.
+static CPLErr GDALDatasetCopyWholeRasterThreaded(
+    GDALDataset* poSrcDS, GDALDataset* poDstDS, int nThreads,
+    GDALDataType eDT, bool bInterleave, bool bCheckHoles,
+    int nSwathCols, int nSwathLines, int nPixelSize,
+    GDALProgressFunc pfnProgress, void *pProgressData )
+{
+    const int nXSize = poDstDS->GetRasterXSize();
+    const int nYSize = poDstDS->GetRasterYSize();
+    const int nBandCount = poDstDS->GetRasterCount();
+
+/* -------------------------------------------------------------------- */
+/*      List the swaths, in the order of the serial implementation.     */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALCopyChunk> aoChunks;
+    for( int iBand = 0; iBand < (bInterleave ? 1 : nBandCount); iBand++ )
+    {
+        for( int iY = 0; iY < nYSize; iY += nSwathLines )
+        {
+            for( int iX = 0; iX < nXSize; iX += nSwathCols )
+            {
+                GDALCopyChunk oChunk;
+                oChunk.nBand = bInterleave ? 0 : iBand + 1;
+                oChunk.iX = iX;
+                oChunk.iY = iY;
+                oChunk.nCols = std::min(nSwathCols, nXSize - iX);
+                oChunk.nLines = std::min(nSwathLines, nYSize - iY);
+                aoChunks.push_back(oChunk);
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Open other handles of the source dataset, if it can be          */
+/*      reopened identically.                                           */
+/* -------------------------------------------------------------------- */
+    GDALCopyReadContext sContext;
+    sContext.eDT = eDT;
+    sContext.nBandCount = nBandCount;
+    sContext.bCheckHoles = bCheckHoles;
+    sContext.apoFreeSrcDS.push_back(poSrcDS);
+
+    const int nMaxReaders = static_cast<int>(
+        std::min(static_cast<size_t>(nThreads - 1), aoChunks.size()));
+    std::vector<GDALDataset*> apoReopenedDS;
+    const char* pszSrcName = poSrcDS->GetDescription();
+    GDALDriver* poSrcDriver = poSrcDS->GetDriver();
+    if( nMaxReaders > 1 && pszSrcName[0] != '\0' &&
+        poSrcDS->GetAccess() == GA_ReadOnly && poSrcDriver != nullptr &&
+        !EQUAL(poSrcDriver->GetDescription(), "MEM") )
+    {
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        while( static_cast<int>(sContext.apoFreeSrcDS.size()) < nMaxReaders )
+        {
+            GDALDataset* poOtherDS = GDALDataset::FromHandle(
+                GDALOpenEx( pszSrcName, GDAL_OF_RASTER | GDAL_OF_READONLY,
+                            nullptr, poSrcDS->GetOpenOptions(), nullptr ));
+            if( poOtherDS == nullptr )
+                break;
+            if( poOtherDS->GetDriver() != poSrcDriver ||
+                poOtherDS->GetRasterXSize() != nXSize ||
+                poOtherDS->GetRasterYSize() != nYSize ||
+                poOtherDS->GetRasterCount() != nBandCount )
+            {
+                GDALClose(poOtherDS);
+                break;
+            }
+            apoReopenedDS.push_back(poOtherDS);
+            sContext.apoFreeSrcDS.push_back(poOtherDS);
+        }
+        CPLPopErrorHandler();
+    }
+    const int nReaders = static_cast<int>(sContext.apoFreeSrcDS.size());
+
+/* -------------------------------------------------------------------- */
+/*      One swath buffer per reader, plus the one being written.        */
+/* -------------------------------------------------------------------- */
+    const size_t nBuffers =
+        std::min(static_cast<size_t>(nReaders + 1), aoChunks.size());
+    std::vector<void*> apBuffers;
+    for( size_t i = 0; i < nBuffers; i++ )
+    {
+        void* pBuffer =
+            VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize);
+        if( pBuffer == nullptr )
+            break;
+        apBuffers.push_back(pBuffer);
+    }
+
+    CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nReaders);
+    std::unique_ptr<CPLJobQueue> poQueue;
+    if( poPool != nullptr )
+        poQueue = poPool->CreateJobQueue();
+    if( apBuffers.size() < nBuffers || !poQueue )
+    {
+        for( void* pBuffer: apBuffers )
+            VSIFree(pBuffer);
+        for( GDALDataset* poOtherDS: apoReopenedDS )
+            GDALClose(poOtherDS);
+        return CE_Failure;
+    }
+
+    CPLDebug( "GDAL",
+              "GDALDatasetCopyWholeRaster(): %d reading threads, "
+              "%d swath buffers", nReaders, static_cast<int>(nBuffers) );
+
+    const auto SubmitChunk = [&sContext, &aoChunks, &poQueue](size_t iChunk,
+                                                              void* pBuffer)
+    {
+        aoChunks[iChunk].pBuffer = pBuffer;
+        GDALCopyReadJob* psJob = new GDALCopyReadJob;
+        psJob->psContext = &sContext;
+        psJob->psChunk = &aoChunks[iChunk];
+        if( !poQueue->SubmitJob(GDALCopyReadJobFunc, psJob) )
+            GDALCopyReadJobFunc(psJob);
+    };
+
+    size_t iNextChunkToSubmit = 0;
+    for( ; iNextChunkToSubmit < nBuffers; iNextChunkToSubmit++ )
+        SubmitChunk(iNextChunkToSubmit, apBuffers[iNextChunkToSubmit]);
+
+/* -------------------------------------------------------------------- */
+/*      Write the swaths in order, as soon as they are read.            */
+/* -------------------------------------------------------------------- */
+    CPLErr eErr = CE_None;
+    const double dfTotalChunks = static_cast<double>(aoChunks.size());
+    for( size_t iChunk = 0; iChunk < aoChunks.size() && eErr == CE_None;
+         iChunk++ )
+    {
+        GDALCopyChunk& oChunk = aoChunks[iChunk];
+        {
+            // Waiting on the job queue, instead of a condition, runs
+            // queued jobs meanwhile when called from a worker thread
+            std::unique_lock<std::mutex> oLock(sContext.oMutex);
+            while( !oChunk.bDone )
+            {
+                int nLater = 0;
+                for( size_t i = iChunk + 1; i < iNextChunkToSubmit; i++ )
+                {
+                    if( !aoChunks[i].bDone )
+                        nLater++;
+                }
+                oLock.unlock();
+                poQueue->WaitCompletion(nLater);
+                oLock.lock();
+            }
+        }
+
+        for( const auto& oError: oChunk.aoErrors )
+            CPLError(oError.eErrClass, oError.nErrNo, "%s",
+                     oError.osMsg.c_str());
+        oChunk.aoErrors.clear();
+
+        eErr = oChunk.eErr;
+        if( eErr == CE_None && oChunk.bHasData )
+        {
+            int nBand = oChunk.nBand;
+            eErr = poDstDS->RasterIO( GF_Write,
+                                      oChunk.iX, oChunk.iY,
+                                      oChunk.nCols, oChunk.nLines,
+                                      oChunk.pBuffer,
+                                      oChunk.nCols, oChunk.nLines,
+                                      eDT,
+                                      nBand > 0 ? 1 : nBandCount,
+                                      nBand > 0 ? &nBand : nullptr,
+                                      0, 0, 0, nullptr );
+        }
+
+        if( eErr == CE_None &&
+            !pfnProgress( (iChunk + 1) / dfTotalChunks,
+                          nullptr, pProgressData ) )
+        {
+            eErr = CE_Failure;
+            CPLError( CE_Failure, CPLE_UserInterrupt,
+                      "User terminated CreateCopy()" );
+        }
+
+        if( eErr == CE_None && iNextChunkToSubmit < aoChunks.size() )
+        {
+            SubmitChunk(iNextChunkToSubmit, oChunk.pBuffer);
+            iNextChunkToSubmit++;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Wait for the pending reads before releasing their buffers.      */
+/* -------------------------------------------------------------------- */
+    poQueue->WaitCompletion();
+
+    for( void* pBuffer: apBuffers )
+        VSIFree(pBuffer);
+    for( GDALDataset* poOtherDS: apoReopenedDS )
+        GDALClose(poOtherDS);
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                     GDALDatasetCopyWholeRaster()                     */
 /************************************************************************/
@@ -4373,6 +5238,12 @@ static void GDALCopyWholeRasterGetSwathSize(
  * achieve best compression.</li>
  * <li>"SKIP_HOLES=YES" to skip chunks for which GDALGetDataCoverageStatus()
  * returns GDAL_DATA_COVERAGE_STATUS_EMPTY (GDAL &gt;= 2.2)</li>
+ * <li>"NUM_THREADS=number|ALL_CPUS" to read the next chunks with worker
+ * threads while the current one is written (GDAL &gt;= 3.1). Defaults to the
+ * value of the GDAL_NUM_THREADS configuration option, and otherwise to 1,
+ * that is a copy by the calling thread only. When the source dataset can be
+ * reopened from its name, each worker thread reads from its own handle, so
+ * that several chunks and bands are read in parallel.</li>
  * </ul>
  * More options may be supported in the future.
  *
@@ -4501,13 +5372,25 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
     poSrcDS->AdviseRead( 0, 0, nXSize, nYSize, nXSize, nYSize, eDT,
                          nBandCount, nullptr, nullptr );
 
-/* ==================================================================== */
-/*      Band oriented (uninterleaved) case.                             */
-/* ==================================================================== */
     CPLErr eErr = CE_None;
     const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
                                         papszOptions, "SKIP_HOLES", "NO" ) );
 
+/* ==================================================================== */
+/*      Read ahead with worker threads, if requested.                   */
+/* ==================================================================== */
+    const int nThreads = CPLGetNumThreads(papszOptions);
+    if( nThreads > 1 && poSrcDS != poDstDS )
+    {
+        CPLFree( pSwathBuf );
+        return GDALDatasetCopyWholeRasterThreaded(
+            poSrcDS, poDstDS, nThreads, eDT, bInterleave, bCheckHoles,
+            nSwathCols, nSwathLines, nPixelSize, pfnProgress, pProgressData );
+    }
+
+/* ==================================================================== */
+/*      Band oriented (uninterleaved) case.                             */
+/* ==================================================================== */
     if( !bInterleave )
     {
         GDALRasterIOExtraArg sExtraArg;
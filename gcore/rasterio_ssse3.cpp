@@ -181,4 +181,68 @@ void GDALUnrolledCopy_GByte_4_1_SSSE3( GByte* CPL_RESTRICT pDest,
     }
 }
 
+void GDALInterleave3Byte_SSSE3( const GByte* CPL_RESTRICT pSrc0,
+                                const GByte* CPL_RESTRICT pSrc1,
+                                const GByte* CPL_RESTRICT pSrc2,
+                                GByte* CPL_RESTRICT pDest,
+                                GInt64 nIters );
+
+void GDALInterleave3Byte_SSSE3( const GByte* CPL_RESTRICT pSrc0,
+                                const GByte* CPL_RESTRICT pSrc1,
+                                const GByte* CPL_RESTRICT pSrc2,
+                                GByte* CPL_RESTRICT pDest,
+                                GInt64 nIters )
+{
+    // Byte k of the 48 output bytes of 16 pixels is the byte k / 3 of
+    // band k % 3.
+    const __m128i xmm_shuffle00 = _mm_setr_epi8(0,-1,-1, 1,-1,-1, 2,-1,
+                                               -1, 3,-1,-1, 4,-1,-1, 5);
+    const __m128i xmm_shuffle01 = _mm_setr_epi8(-1, 0,-1,-1, 1,-1,-1, 2,
+                                               -1,-1, 3,-1,-1, 4,-1,-1);
+    const __m128i xmm_shuffle02 = _mm_setr_epi8(-1,-1, 0,-1,-1, 1,-1,-1,
+                                                2,-1,-1, 3,-1,-1, 4,-1);
+    const __m128i xmm_shuffle10 = _mm_setr_epi8(-1,-1, 6,-1,-1, 7,-1,-1,
+                                                8,-1,-1, 9,-1,-1,10,-1);
+    const __m128i xmm_shuffle11 = _mm_setr_epi8(5,-1,-1, 6,-1,-1, 7,-1,
+                                               -1, 8,-1,-1, 9,-1,-1,10);
+    const __m128i xmm_shuffle12 = _mm_setr_epi8(-1, 5,-1,-1, 6,-1,-1, 7,
+                                               -1,-1, 8,-1,-1, 9,-1,-1);
+    const __m128i xmm_shuffle20 = _mm_setr_epi8(-1,11,-1,-1,12,-1,-1,13,
+                                               -1,-1,14,-1,-1,15,-1,-1);
+    const __m128i xmm_shuffle21 = _mm_setr_epi8(-1,-1,11,-1,-1,12,-1,-1,
+                                               13,-1,-1,14,-1,-1,15,-1);
+    const __m128i xmm_shuffle22 = _mm_setr_epi8(10,-1,-1,11,-1,-1,12,-1,
+                                               -1,13,-1,-1,14,-1,-1,15);
+    decltype(nIters) i = 0;
+    for( ; i + 16 <= nIters; i += 16 )
+    {
+        const __m128i xmm0 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc0 + i) );
+        const __m128i xmm1 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc1 + i) );
+        const __m128i xmm2 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pSrc2 + i) );
+
+        const __m128i xmmOut0 = _mm_or_si128(
+            _mm_or_si128(_mm_shuffle_epi8(xmm0, xmm_shuffle00),
+                         _mm_shuffle_epi8(xmm1, xmm_shuffle01)),
+            _mm_shuffle_epi8(xmm2, xmm_shuffle02));
+        const __m128i xmmOut1 = _mm_or_si128(
+            _mm_or_si128(_mm_shuffle_epi8(xmm0, xmm_shuffle10),
+                         _mm_shuffle_epi8(xmm1, xmm_shuffle11)),
+            _mm_shuffle_epi8(xmm2, xmm_shuffle12));
+        const __m128i xmmOut2 = _mm_or_si128(
+            _mm_or_si128(_mm_shuffle_epi8(xmm0, xmm_shuffle20),
+                         _mm_shuffle_epi8(xmm1, xmm_shuffle21)),
+            _mm_shuffle_epi8(xmm2, xmm_shuffle22));
+
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 3 * i), xmmOut0);
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 3 * i + 16), xmmOut1);
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(pDest + 3 * i + 32), xmmOut2);
+    }
+    for( ; i < nIters; i++ )
+    {
+        pDest[3 * i] = pSrc0[i];
+        pDest[3 * i + 1] = pSrc1[i];
+        pDest[3 * i + 2] = pSrc2[i];
+    }
+}
+
 #endif // HAVE_SSSE3_AT_COMPILE_TIME
@@ -196,6 +196,9 @@ RawRasterBand::~RawRasterBand()
 
     RawRasterBand::FlushCache();
 
+    if( psMMapVMem )
+        CPLVirtualMemFree(psMMapVMem);
+
     if (bOwnsFP)
     {
         if( VSIFCloseL(fpRawL) != 0 )
@@ -576,6 +579,193 @@ int RawRasterBand::CanUseDirectIO(int /* nXOff */,
     return CPLTestBool(pszGDAL_ONE_BIG_READ);
 }
 
+/************************************************************************/
+/*                            CanUseMMapIO()                            */
+/************************************************************************/
+
+// Whether the request can be served by copying from a memory mapping of
+// the file, which requires GDAL_RAW_USE_MMAP=YES, a read-only dataset on a
+// real file, and no resampling. The mapping is created on the first call.
+int RawRasterBand::CanUseMMapIO(GDALRWFlag eRWFlag,
+                                int nXSize, int nYSize,
+                                int nBufXSize, int nBufYSize,
+                                GDALRasterIOExtraArg* psExtraArg)
+{
+    if( eRWFlag != GF_Read || eAccess != GA_ReadOnly ||
+        nXSize != nBufXSize || nYSize != nBufYSize ||
+        psExtraArg->eResampleAlg != GRIORA_NearestNeighbour )
+    {
+        return FALSE;
+    }
+
+    if( psMMapVMem != nullptr )
+        return TRUE;
+    if( bMMapTried )
+        return FALSE;
+    bMMapTried = TRUE;
+
+    if( !CPLTestBool(CPLGetConfigOption("GDAL_RAW_USE_MMAP", "NO")) ||
+        nPixelOffset < 0 || nLineOffset < 0 ||
+        VSIFGetNativeFileDescriptorL(fpRawL) == nullptr ||
+        !CPLIsVirtualMemFileMapAvailable() )
+    {
+        return FALSE;
+    }
+
+    const vsi_l_offset nSize =
+        static_cast<vsi_l_offset>(nRasterYSize - 1) * nLineOffset +
+        static_cast<vsi_l_offset>(nRasterXSize - 1) * nPixelOffset +
+        GDALGetDataTypeSizeBytes(eDataType);
+    if( static_cast<size_t>(nSize) != nSize )
+        return FALSE;
+
+    // Truncated files are not an error in the regular code path.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    psMMapVMem = CPLVirtualMemFileMapNew(fpRawL, nImgOffset, nSize,
+                                         VIRTUALMEM_READONLY,
+                                         nullptr, nullptr);
+    CPLPopErrorHandler();
+    CPLErrorReset();
+    if( psMMapVMem == nullptr )
+    {
+        CPLDebug("RAW", "Cannot map band %d, using regular I/O", nBand);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/************************************************************************/
+/*                         RawCopySwapWords()                           */
+/************************************************************************/
+
+// Copy nCount pixels made of nWordCount words of nWordSize bytes, swapping
+// the byte order of each word on the fly.
+static void RawCopySwapWords( const GByte* pabySrc, int nSrcPixelStride,
+                              GByte* pabyDst, GSpacing nDstPixelStride,
+                              int nWordSize, int nWordCount, int nCount )
+{
+    for( int iWord = 0; iWord < nWordCount; iWord++ )
+    {
+        const GByte* pabySrcWord = pabySrc + iWord * nWordSize;
+        GByte* pabyDstWord = pabyDst + iWord * nWordSize;
+        switch( nWordSize )
+        {
+            case 2:
+                for( int i = 0; i < nCount; i++ )
+                {
+                    GUInt16 nVal;
+                    memcpy(&nVal, pabySrcWord +
+                           static_cast<size_t>(i) * nSrcPixelStride, 2);
+                    nVal = CPL_SWAP16(nVal);
+                    memcpy(pabyDstWord + i * nDstPixelStride, &nVal, 2);
+                }
+                break;
+            case 4:
+                for( int i = 0; i < nCount; i++ )
+                {
+                    GUInt32 nVal;
+                    memcpy(&nVal, pabySrcWord +
+                           static_cast<size_t>(i) * nSrcPixelStride, 4);
+                    nVal = CPL_SWAP32(nVal);
+                    memcpy(pabyDstWord + i * nDstPixelStride, &nVal, 4);
+                }
+                break;
+            case 8:
+                for( int i = 0; i < nCount; i++ )
+                {
+                    GUInt64 nVal;
+                    memcpy(&nVal, pabySrcWord +
+                           static_cast<size_t>(i) * nSrcPixelStride, 8);
+                    nVal = CPL_SWAP64(nVal);
+                    memcpy(pabyDstWord + i * nDstPixelStride, &nVal, 8);
+                }
+                break;
+            default:
+                for( int i = 0; i < nCount; i++ )
+                {
+                    memcpy(pabyDstWord + i * nDstPixelStride,
+                           pabySrcWord +
+                                static_cast<size_t>(i) * nSrcPixelStride,
+                           nWordSize);
+                }
+                break;
+        }
+    }
+}
+
+/************************************************************************/
+/*                            MMapRasterIO()                            */
+/************************************************************************/
+
+// Read a non-resampled window directly from the memory mapping into the
+// user buffer, without going through the block cache.
+CPLErr RawRasterBand::MMapRasterIO( int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void * pData, GDALDataType eBufType,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GDALRasterIOExtraArg* psExtraArg )
+{
+    const GByte* pabyBase = reinterpret_cast<const GByte *>(
+        CPLVirtualMemGetAddr(psMMapVMem));
+    const int nBandDataSize = GDALGetDataTypeSizeBytes(eDataType);
+    const bool bSwap = !bNativeOrder && nBandDataSize > 1;
+    const bool bComplex = CPL_TO_BOOL(GDALDataTypeIsComplex(eDataType));
+    const int nWordSize = bComplex ? nBandDataSize / 2 : nBandDataSize;
+    const int nWordCount = bComplex ? 2 : 1;
+
+    // When both swapping and type conversion are needed, lines are first
+    // swapped in a temporary buffer.
+    GByte* pabySwapped = nullptr;
+    if( bSwap && eBufType != eDataType )
+    {
+        pabySwapped = static_cast<GByte *>(VSI_MALLOC2_VERBOSE(
+            nXSize, nBandDataSize));
+        if( pabySwapped == nullptr )
+            return CE_Failure;
+    }
+
+    for( int iLine = 0; iLine < nYSize; iLine++ )
+    {
+        const GByte* pabySrc = pabyBase +
+            static_cast<size_t>(nYOff + iLine) * nLineOffset +
+            static_cast<size_t>(nXOff) * nPixelOffset;
+        GByte* pabyDst = static_cast<GByte *>(pData) +
+            static_cast<GPtrDiff_t>(iLine) * nLineSpace;
+
+        if( !bSwap )
+        {
+            GDALCopyWords(pabySrc, eDataType, nPixelOffset,
+                          pabyDst, eBufType, static_cast<int>(nPixelSpace),
+                          nXSize);
+        }
+        else if( pabySwapped == nullptr )
+        {
+            RawCopySwapWords(pabySrc, nPixelOffset, pabyDst, nPixelSpace,
+                             nWordSize, nWordCount, nXSize);
+        }
+        else
+        {
+            RawCopySwapWords(pabySrc, nPixelOffset,
+                             pabySwapped, nBandDataSize,
+                             nWordSize, nWordCount, nXSize);
+            GDALCopyWords(pabySwapped, eDataType, nBandDataSize,
+                          pabyDst, eBufType, static_cast<int>(nPixelSpace),
+                          nXSize);
+        }
+
+        if( psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress(1.0 * (iLine + 1) / nYSize, "",
+                                     psExtraArg->pProgressData) )
+        {
+            CPLFree(pabySwapped);
+            return CE_Failure;
+        }
+    }
+
+    CPLFree(pabySwapped);
+    return CE_None;
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /************************************************************************/
@@ -597,6 +787,13 @@ CPLErr RawRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 #endif
     const int nBufDataSize = GDALGetDataTypeSizeBytes(eBufType);
 
+    if( CanUseMMapIO(eRWFlag, nXSize, nYSize, nBufXSize, nBufYSize,
+                     psExtraArg) )
+    {
+        return MMapRasterIO(nXOff, nYOff, nXSize, nYSize, pData, eBufType,
+                            nPixelSpace, nLineSpace, psExtraArg);
+    }
+
     if( !CanUseDirectIO(nXOff, nYOff, nXSize, nYSize, eBufType, psExtraArg) )
     {
         return GDALRasterBand::IRasterIO(eRWFlag, nXOff, nYOff,
@@ -1128,8 +1325,11 @@ CPLErr RawDataset::IRasterIO( GDALRWFlag eRWFlag,
             RawRasterBand *poBand = dynamic_cast<RawRasterBand *>(
                 GetRasterBand(panBandMap[iBandIndex]));
             if( poBand == nullptr ||
-                !poBand->CanUseDirectIO(nXOff, nYOff,
-                                        nXSize, nYSize, eBufType, psExtraArg) )
+                (!poBand->CanUseMMapIO(eRWFlag, nXSize, nYSize,
+                                       nBufXSize, nBufYSize, psExtraArg) &&
+                 !poBand->CanUseDirectIO(nXOff, nYOff,
+                                         nXSize, nYSize, eBufType,
+                                         psExtraArg)) )
             {
                 break;
             }
@@ -100,6 +100,11 @@ protected:
 
     int         bOwnsFP{};
 
+    // Read-only memory mapping of the band, used by IRasterIO() when
+    // GDAL_RAW_USE_MMAP is set.
+    CPLVirtualMem *psMMapVMem{};
+    int         bMMapTried{};
+
     int         Seek( vsi_l_offset, int );
     size_t      Read( void *, size_t, size_t );
     size_t      Write( void *, size_t, size_t );
@@ -118,6 +123,14 @@ protected:
                                GDALDataType eBufType,
                                GDALRasterIOExtraArg* psExtraArg);
 
+    int         CanUseMMapIO(GDALRWFlag eRWFlag, int nXSize, int nYSize,
+                             int nBufXSize, int nBufYSize,
+                             GDALRasterIOExtraArg* psExtraArg);
+    CPLErr      MMapRasterIO(int nXOff, int nYOff, int nXSize, int nYSize,
+                             void * pData, GDALDataType eBufType,
+                             GSpacing nPixelSpace, GSpacing nLineSpace,
+                             GDALRasterIOExtraArg* psExtraArg);
+
 public:
 
     enum class OwnFP
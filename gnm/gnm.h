@@ -60,7 +60,8 @@ typedef enum
 {
     /** Dijkstra shortest path */           GATDijkstraShortestPath = 1,
     /** KShortest Paths        */           GATKShortestPath,
-    /** Recursive Breadth-first search */   GATConnectedComponents
+    /** Recursive Breadth-first search */   GATConnectedComponents,
+    /** Bidirectional A* shortest path, since GDAL 3.1 */ GATAStarShortestPath
 } GNMGraphAlgorithmType;
 
 #if defined(__cplusplus) && !defined(CPL_SUPRESS_CPLUSPLUS)
@@ -434,6 +435,7 @@ protected:
     virtual CPLErr LoadMetadataLayer( GDALDataset* const pDS );
     virtual CPLErr LoadGraphLayer( GDALDataset* const pDS );
     virtual CPLErr LoadGraph();
+    virtual CPLErr LoadGraphCoordinates();
     virtual CPLErr LoadFeaturesLayer( GDALDataset* const pDS );
     virtual CPLErr DeleteMetadataLayer() = 0;
     virtual CPLErr DeleteGraphLayer() = 0;
@@ -479,6 +481,7 @@ protected:
 
     GNMGraph m_oGraph;
     bool m_bIsGraphLoaded;
+    bool m_bIsGraphCoordinatesLoaded = false;
 //! @endcond
 };
 
@@ -201,6 +201,11 @@ CPLString GNMGenericNetwork::GetAlgorithmName(GNMDirection eAlgorithm,
             return CPLString("Connected");
         else
             return CPLString("Connected components");
+    case GATAStarShortestPath:
+        if(bShortName)
+            return CPLString("AStar");
+        else
+            return CPLString("Bidirectional A* shortest path");
     }
 
     return CPLString("Invalid");
@@ -294,6 +299,8 @@ CPLErr GNMGenericNetwork::ConnectFeatures(GNMGFID nSrcGFID, GNMGFID nTgtGFID,
 
     m_oGraph.AddEdge(nConGFID, nSrcGFID, nTgtGFID, eDir == GNM_EDGE_DIR_BOTH,
                      dfCost, dfInvCost);
+    // New vertices have no coordinates yet.
+    m_bIsGraphCoordinatesLoaded = false;
 
     return CE_None;
 }
@@ -419,6 +426,7 @@ CPLErr GNMGenericNetwork::DisconnectAll()
     }
 
     m_oGraph.Clear();
+    m_bIsGraphCoordinatesLoaded = false;
 
     return CE_None;
 }
@@ -808,6 +816,18 @@ OGRLayer *GNMGenericNetwork::GetPath(GNMGFID nStartFID, GNMGFID nEndFID,
             FillResultLayer(poResLayer, path, 1, bReturnVertices, bReturnEdges);
         }
         break;
+    case GATAStarShortestPath:
+        {
+            // The heuristic needs the position of the vertices. Without it
+            // this is still a valid bidirectional Dijkstra search.
+            LoadGraphCoordinates();
+
+            GNMPATH path = m_oGraph.AStarShortestPath(nStartFID, nEndFID);
+
+            // fill features in result layer
+            FillResultLayer(poResLayer, path, 1, bReturnVertices, bReturnEdges);
+        }
+        break;
     case GATKShortestPath:
         {
             int nK = atoi(CSLFetchNameValueDef(papszOptions, GNM_MD_NUM_PATHS,
@@ -1343,6 +1363,39 @@ CPLErr GNMGenericNetwork::LoadGraph()
     return CE_None;
 }
 
+CPLErr GNMGenericNetwork::LoadGraphCoordinates()
+{
+    if(m_bIsGraphCoordinatesLoaded)
+        return CE_None;
+
+    // Features of the network layers have their global identificator as FID.
+    for(size_t i = 0; i < m_apoLayers.size(); ++i)
+    {
+        OGRLayer* poLayer = m_apoLayers[i];
+        if(wkbFlatten(poLayer->GetGeomType()) != wkbPoint)
+            continue;
+
+        OGRFeature *poFeature;
+        poLayer->ResetReading();
+        while ((poFeature = poLayer->GetNextFeature()) != nullptr)
+        {
+            const OGRGeometry* poGeom = poFeature->GetGeometryRef();
+            if(poGeom != nullptr &&
+               wkbFlatten(poGeom->getGeometryType()) == wkbPoint)
+            {
+                const OGRPoint* poPoint = poGeom->toPoint();
+                m_oGraph.SetVertexCoordinates(poFeature->GetFID(),
+                                              poPoint->getX(),
+                                              poPoint->getY());
+            }
+            OGRFeature::DestroyFeature(poFeature);
+        }
+    }
+
+    m_bIsGraphCoordinatesLoaded = true;
+    return CE_None;
+}
+
 CPLErr GNMGenericNetwork::LoadFeaturesLayer(GDALDataset * const pDS)
 {
     m_poFeaturesLayer = pDS->GetLayerByName(GNM_SYSLAYER_FEATURES);
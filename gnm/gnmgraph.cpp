@@ -31,6 +31,8 @@
 #include "gnmgraph.h"
 #include "gnm_priv.h"
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <limits>
 #include <set>
 
@@ -48,12 +50,17 @@ void GNMGraph::AddVertex(GNMGFID nFID)
 
     GNMStdVertex stVertex;
     stVertex.bIsBloked = false;
+    stVertex.bHasCoordinates = false;
+    stVertex.dfX = 0.0;
+    stVertex.dfY = 0.0;
     m_mstVertices[nFID] = stVertex;
+    m_bCSRValid = false;
 }
 
 void GNMGraph::DeleteVertex(GNMGFID nFID)
 {
     m_mstVertices.erase(nFID);
+    m_bCSRValid = false;
 
     // remove all edges with this vertex
     std::vector<GNMGFID> aoIdsToErase;
@@ -95,6 +102,7 @@ void GNMGraph::AddEdge(GNMGFID nConFID, GNMGFID nSrcFID, GNMGFID nTgtFID,
     stEdge.bIsBloked = false;
 
     m_mstEdges[nConFID] = stEdge;
+    m_bCSRValid = false;
 
     if (bIsBidir)
     {
@@ -110,6 +118,7 @@ void GNMGraph::AddEdge(GNMGFID nConFID, GNMGFID nSrcFID, GNMGFID nTgtFID,
 void GNMGraph::DeleteEdge(GNMGFID nConFID)
 {
     m_mstEdges.erase(nConFID);
+    m_bCSRValid = false;
 
     // remove edge from all vertices anOutEdgeFIDs
     for(std::map<GNMGFID, GNMStdVertex>::iterator it = m_mstVertices.begin();
@@ -129,6 +138,13 @@ void GNMGraph::ChangeEdge(GNMGFID nFID, double dfCost, double dfInvCost)
     {
         it->second.dfDirCost = dfCost;
         it->second.dfInvCost = dfInvCost;
+
+        GUInt32 nIdx;
+        if (GetCSREdgeIndex(nFID, nIdx))
+        {
+            m_adfCSRCost[nIdx] = dfCost;
+            m_dfCSRHeuristicFactor = -1.0;
+        }
     }
 }
 
@@ -136,9 +152,12 @@ void GNMGraph::ChangeBlockState(GNMGFID nFID, bool bBlock)
 {
     // check vertices
     std::map<GNMGFID, GNMStdVertex>::iterator itv = m_mstVertices.find(nFID);
+    GUInt32 nIdx;
     if(itv != m_mstVertices.end())
     {
         itv->second.bIsBloked = bBlock;
+        if (GetCSRVertexIndex(nFID, nIdx))
+            m_abyCSRVertexBlocked[nIdx] = bBlock;
         return;
     }
 
@@ -147,6 +166,8 @@ void GNMGraph::ChangeBlockState(GNMGFID nFID, bool bBlock)
     if (ite != m_mstEdges.end())
     {
         ite->second.bIsBloked = bBlock;
+        if (GetCSREdgeIndex(nFID, nIdx))
+            m_abyCSREdgeBlocked[nIdx] = bBlock;
     }
 }
 
@@ -171,6 +192,25 @@ void GNMGraph::ChangeAllBlockState(bool bBlock)
     {
         ite->second.bIsBloked = bBlock;
     }
+
+    std::fill(m_abyCSRVertexBlocked.begin(), m_abyCSRVertexBlocked.end(),
+              static_cast<GByte>(bBlock));
+    std::fill(m_abyCSREdgeBlocked.begin(), m_abyCSREdgeBlocked.end(),
+              static_cast<GByte>(bBlock));
+}
+
+void GNMGraph::SetVertexCoordinates(GNMGFID nFID, double dfX, double dfY)
+{
+    std::map<GNMGFID, GNMStdVertex>::iterator it = m_mstVertices.find(nFID);
+    if (it == m_mstVertices.end())
+        return;
+
+    it->second.bHasCoordinates = true;
+    it->second.dfX = dfX;
+    it->second.dfY = dfY;
+
+    // Whether all vertices have coordinates is only known after a rebuild.
+    m_bCSRValid = false;
 }
 
 GNMPATH GNMGraph::DijkstraShortestPath( GNMGFID nStartFID, GNMGFID nEndFID,
@@ -232,7 +272,36 @@ GNMPATH GNMGraph::DijkstraShortestPath( GNMGFID nStartFID, GNMGFID nEndFID,
 
 GNMPATH GNMGraph::DijkstraShortestPath( GNMGFID nStartFID, GNMGFID nEndFID)
 {
-    return DijkstraShortestPath(nStartFID, nEndFID, m_mstEdges);
+    BuildCSR();
+
+    GUInt32 nStart, nEnd;
+    if (!GetCSRVertexIndex(nStartFID, nStart) ||
+        !GetCSRVertexIndex(nEndFID, nEnd))
+    {
+        GNMPATH oRet;
+        if (nStartFID == nEndFID)
+            oRet.push_back(std::make_pair(nStartFID, -1));
+        return oRet;
+    }
+
+    return CSRDijkstraShortestPath(nStart, nEnd, m_adfCSRCost);
+}
+
+GNMPATH GNMGraph::AStarShortestPath( GNMGFID nStartFID, GNMGFID nEndFID)
+{
+    BuildCSR();
+
+    GUInt32 nStart, nEnd;
+    if (!GetCSRVertexIndex(nStartFID, nStart) ||
+        !GetCSRVertexIndex(nEndFID, nEnd))
+    {
+        GNMPATH oRet;
+        if (nStartFID == nEndFID)
+            oRet.push_back(std::make_pair(nStartFID, -1));
+        return oRet;
+    }
+
+    return CSRAStarShortestPath(nStart, nEnd);
 }
 
 std::vector<GNMPATH> GNMGraph::KShortestPaths(GNMGFID nStartFID, GNMGFID nEndFID,
@@ -264,22 +333,27 @@ std::vector<GNMPATH> GNMGraph::KShortestPaths(GNMGFID nStartFID, GNMGFID nEndFID
     size_t i, k, l;
     GNMPATH::iterator itAk, tempIt, itR;
     std::vector<GNMPATH>::iterator itA;
-    std::map<GNMGFID, double>::iterator itDel;
+    std::map<GUInt32, double>::iterator itDel;
     GNMPATH aoRootPath, aoRootPathOther, aoSpurPath;
-    GNMGFID nSpurNode, nVertexToDel, nEdgeToDel;
+    GUInt32 nSpurNode, nEndNode, nVertexToDel, nEdgeToDel;
     double dfSumCost;
 
-    std::map<GNMGFID, GNMStdEdge> mstEdges = m_mstEdges;
+    // DijkstraShortestPath() has built the CSR graph. Costs are indexed by
+    // edge index.
+    std::vector<double> adfCost = m_adfCSRCost;
+    if (!GetCSRVertexIndex(nEndFID, nEndNode))
+        return A;
 
     for (k = 0; k < nK - 1; ++k) // -1 because we have already found one
     {
-        std::map<GNMGFID, double> mDeletedEdges; // for infinity costs assignment
+        std::map<GUInt32, double> mDeletedEdges; // for infinity costs assignment
         itAk = A[k].begin();
 
         for (i = 0; i < A[k].size() - 1; ++i) // avoid end node
         {
             // Get the current node.
-            nSpurNode = A[k][i].first;
+            if (!GetCSRVertexIndex(A[k][i].first, nSpurNode))
+                continue;
 
             // Get the root path from the 0 to the current node.
 
@@ -321,10 +395,13 @@ std::vector<GNMPATH> GNMGraph::KShortestPaths(GNMGFID nStartFID, GNMGFID nEndFID
                         (i < aoRootPathOther.size()))
                 {
                     tempIt = itA->begin() + i + 1;
-                    mDeletedEdges.insert(std::make_pair(tempIt->second,
-                                           mstEdges[tempIt->second].dfDirCost));
-                    mstEdges[tempIt->second].dfDirCost
-                                      = std::numeric_limits<double>::infinity();
+                    if (GetCSREdgeIndex(tempIt->second, nEdgeToDel))
+                    {
+                        mDeletedEdges.insert(std::make_pair(nEdgeToDel,
+                                                        adfCost[nEdgeToDel]));
+                        adfCost[nEdgeToDel]
+                                  = std::numeric_limits<double>::infinity();
+                    }
                 }
             }
 
@@ -337,20 +414,21 @@ std::vector<GNMPATH> GNMGraph::KShortestPaths(GNMGFID nStartFID, GNMGFID nEndFID
             // end()-1, because we should not remove the spur node
             for (itR = aoRootPath.begin(); itR != aoRootPath.end() - 1; ++itR)
             {
-                nVertexToDel = itR->first;
-                for (l = 0; l < m_mstVertices[nVertexToDel].anOutEdgeFIDs.size();
-                     ++l)
+                if (!GetCSRVertexIndex(itR->first, nVertexToDel))
+                    continue;
+                for (l = m_anCSROutOffsets[nVertexToDel];
+                     l < m_anCSROutOffsets[nVertexToDel + 1]; ++l)
                 {
-                    nEdgeToDel = m_mstVertices[nVertexToDel].anOutEdgeFIDs[l];
+                    nEdgeToDel = m_anCSROutEdges[l];
                     mDeletedEdges.insert(std::make_pair(nEdgeToDel,
-                                               mstEdges[nEdgeToDel].dfDirCost));
-                    mstEdges[nEdgeToDel].dfDirCost
+                                                        adfCost[nEdgeToDel]));
+                    adfCost[nEdgeToDel]
                                       = std::numeric_limits<double>::infinity();
                 }
             }
 
             // Find the new best path in the modified graph.
-            aoSpurPath = DijkstraShortestPath(nSpurNode, nEndFID, mstEdges);
+            aoSpurPath = CSRDijkstraShortestPath(nSpurNode, nEndNode, adfCost);
 
             // Firstly, restore deleted edges in order to calculate the summary
             // cost of the path correctly later, because the costs will be
@@ -360,7 +438,7 @@ std::vector<GNMPATH> GNMGraph::KShortestPaths(GNMGFID nStartFID, GNMGFID nEndFID
             for (itDel = mDeletedEdges.begin(); itDel != mDeletedEdges.end();
                  ++itDel)
             {
-                mstEdges[itDel->first].dfDirCost = itDel->second;
+                adfCost[itDel->first] = itDel->second;
             }
 
             mDeletedEdges.clear();
@@ -382,7 +460,8 @@ std::vector<GNMPATH> GNMGraph::KShortestPaths(GNMGFID nStartFID, GNMGFID nEndFID
                     // infinity, because every time we assign infinity costs for
                     // edges of old paths, we anyway have the alternative edges
                     // with non-infinity costs.
-                    dfSumCost += mstEdges[itR->second].dfDirCost;
+                    if (GetCSREdgeIndex(itR->second, nEdgeToDel))
+                        dfSumCost += adfCost[nEdgeToDel];
                 }
 
                 B.insert(std::make_pair(dfSumCost, aoRootPath));
@@ -442,6 +521,8 @@ void GNMGraph::Clear()
 {
     m_mstVertices.clear();
     m_mstEdges.clear();
+    m_bCSRValid = false;
+    BuildCSR();
 }
 
 void GNMGraph::DijkstraShortestPathTree(GNMGFID nFID,
@@ -618,4 +699,385 @@ void GNMGraph::TraceTargets(std::queue<GNMGFID> &vertexQueue,
     if (!neighbours_queue.empty())
         TraceTargets(neighbours_queue, markedVertIds, connectedIds);
 }
+
+void GNMGraph::SearchSpace::Reset(size_t nVertices)
+{
+    if (adfDist.size() != nVertices)
+    {
+        adfDist.assign(nVertices, 0.0);
+        anPredEdge.assign(nVertices, 0);
+        anReached.assign(nVertices, 0);
+        anSettled.assign(nVertices, 0);
+        nStamp = 0;
+    }
+    // Stamps avoid clearing the arrays before each search.
+    if (++nStamp == 0)
+    {
+        std::fill(anReached.begin(), anReached.end(), 0);
+        std::fill(anSettled.begin(), anSettled.end(), 0);
+        nStamp = 1;
+    }
+}
+
+void GNMGraph::BuildCSR()
+{
+    if (m_bCSRValid)
+        return;
+
+    const size_t nVertices = m_mstVertices.size();
+    const size_t nEdges = m_mstEdges.size();
+
+    // std::map iterates in identificator order, so the arrays are sorted.
+    m_anCSRVertexFIDs.clear();
+    m_anCSRVertexFIDs.reserve(nVertices);
+    m_abyCSRVertexBlocked.clear();
+    m_abyCSRVertexBlocked.reserve(nVertices);
+    m_adfCSRX.clear();
+    m_adfCSRY.clear();
+    m_bCSRHasAllCoordinates = true;
+    for (std::map<GNMGFID, GNMStdVertex>::const_iterator itv =
+             m_mstVertices.begin(); itv != m_mstVertices.end(); ++itv)
+    {
+        m_anCSRVertexFIDs.push_back(itv->first);
+        m_abyCSRVertexBlocked.push_back(itv->second.bIsBloked);
+        if (!itv->second.bHasCoordinates)
+            m_bCSRHasAllCoordinates = false;
+    }
+    if (m_bCSRHasAllCoordinates)
+    {
+        m_adfCSRX.reserve(nVertices);
+        m_adfCSRY.reserve(nVertices);
+        for (std::map<GNMGFID, GNMStdVertex>::const_iterator itv =
+                 m_mstVertices.begin(); itv != m_mstVertices.end(); ++itv)
+        {
+            m_adfCSRX.push_back(itv->second.dfX);
+            m_adfCSRY.push_back(itv->second.dfY);
+        }
+    }
+
+    m_anCSREdgeFIDs.clear();
+    m_anCSREdgeFIDs.reserve(nEdges);
+    m_anCSREdgeSrc.clear();
+    m_anCSREdgeSrc.reserve(nEdges);
+    m_anCSREdgeTgt.clear();
+    m_anCSREdgeTgt.reserve(nEdges);
+    m_adfCSRCost.clear();
+    m_adfCSRCost.reserve(nEdges);
+    m_abyCSREdgeBlocked.clear();
+    m_abyCSREdgeBlocked.reserve(nEdges);
+    m_bCSRValid = true;  // for GetCSRVertexIndex()
+    for (std::map<GNMGFID, GNMStdEdge>::const_iterator ite = m_mstEdges.begin();
+         ite != m_mstEdges.end(); ++ite)
+    {
+        GUInt32 nSrc = 0, nTgt = 0;
+        GetCSRVertexIndex(ite->second.nSrcVertexFID, nSrc);
+        GetCSRVertexIndex(ite->second.nTgtVertexFID, nTgt);
+        m_anCSREdgeFIDs.push_back(ite->first);
+        m_anCSREdgeSrc.push_back(nSrc);
+        m_anCSREdgeTgt.push_back(nTgt);
+        m_adfCSRCost.push_back(ite->second.dfDirCost);
+        m_abyCSREdgeBlocked.push_back(ite->second.bIsBloked);
+    }
+
+    // Outgoing arcs, in the order of the anOutEdgeFIDs arrays.
+    m_anCSROutOffsets.assign(nVertices + 1, 0);
+    m_anCSROutEdges.clear();
+    GUInt32 nVertex = 0;
+    for (std::map<GNMGFID, GNMStdVertex>::const_iterator itv =
+             m_mstVertices.begin(); itv != m_mstVertices.end();
+         ++itv, ++nVertex)
+    {
+        const GNMVECTOR &anOut = itv->second.anOutEdgeFIDs;
+        for (size_t i = 0; i < anOut.size(); ++i)
+        {
+            GUInt32 nEdge;
+            if (GetCSREdgeIndex(anOut[i], nEdge))
+                m_anCSROutEdges.push_back(nEdge);
+        }
+        m_anCSROutOffsets[nVertex + 1] = m_anCSROutEdges.size();
+    }
+
+    // Incoming arcs, for the backward search, by counting sort of the
+    // outgoing arcs on their target vertex.
+    m_anCSRInOffsets.assign(nVertices + 1, 0);
+    m_anCSRInEdges.resize(m_anCSROutEdges.size());
+    for (GUInt32 i = 0; i < nVertices; ++i)
+    {
+        for (size_t j = m_anCSROutOffsets[i]; j < m_anCSROutOffsets[i + 1]; ++j)
+            m_anCSRInOffsets[GetCSROppositeVertex(m_anCSROutEdges[j], i) + 1]++;
+    }
+    for (size_t i = 0; i < nVertices; ++i)
+        m_anCSRInOffsets[i + 1] += m_anCSRInOffsets[i];
+    std::vector<size_t> anFill(m_anCSRInOffsets.begin(),
+                               m_anCSRInOffsets.end() - 1);
+    for (GUInt32 i = 0; i < nVertices; ++i)
+    {
+        for (size_t j = m_anCSROutOffsets[i]; j < m_anCSROutOffsets[i + 1]; ++j)
+        {
+            const GUInt32 nEdge = m_anCSROutEdges[j];
+            m_anCSRInEdges[anFill[GetCSROppositeVertex(nEdge, i)]++] = nEdge;
+        }
+    }
+
+    m_dfCSRHeuristicFactor = -1.0;
+    m_oForwardSpace = SearchSpace();
+    m_oBackwardSpace = SearchSpace();
+}
+
+bool GNMGraph::GetCSRVertexIndex(GNMGFID nFID, GUInt32 &nIdx) const
+{
+    if (!m_bCSRValid)
+        return false;
+    std::vector<GNMGFID>::const_iterator it =
+        std::lower_bound(m_anCSRVertexFIDs.begin(), m_anCSRVertexFIDs.end(),
+                         nFID);
+    if (it == m_anCSRVertexFIDs.end() || *it != nFID)
+        return false;
+    nIdx = static_cast<GUInt32>(it - m_anCSRVertexFIDs.begin());
+    return true;
+}
+
+bool GNMGraph::GetCSREdgeIndex(GNMGFID nFID, GUInt32 &nIdx) const
+{
+    if (!m_bCSRValid)
+        return false;
+    std::vector<GNMGFID>::const_iterator it =
+        std::lower_bound(m_anCSREdgeFIDs.begin(), m_anCSREdgeFIDs.end(), nFID);
+    if (it == m_anCSREdgeFIDs.end() || *it != nFID)
+        return false;
+    nIdx = static_cast<GUInt32>(it - m_anCSREdgeFIDs.begin());
+    return true;
+}
+
+// Returns the lowest cost per distance unit of the edges, so that the
+// scaled euclidean distance never overestimates the cost of a path, or 0
+// if the heuristic cannot be used.
+double GNMGraph::GetCSRHeuristicFactor()
+{
+    if (m_dfCSRHeuristicFactor >= 0.0)
+        return m_dfCSRHeuristicFactor;
+
+    m_dfCSRHeuristicFactor = 0.0;
+    if (!m_bCSRHasAllCoordinates)
+        return m_dfCSRHeuristicFactor;
+
+    double dfFactor = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < m_adfCSRCost.size(); ++i)
+    {
+        const double dfCost = m_adfCSRCost[i];
+        if (dfCost < 0.0)
+            return m_dfCSRHeuristicFactor;
+        const GUInt32 nSrc = m_anCSREdgeSrc[i];
+        const GUInt32 nTgt = m_anCSREdgeTgt[i];
+        const double dfDist = sqrt(
+            (m_adfCSRX[nTgt] - m_adfCSRX[nSrc]) *
+                (m_adfCSRX[nTgt] - m_adfCSRX[nSrc]) +
+            (m_adfCSRY[nTgt] - m_adfCSRY[nSrc]) *
+                (m_adfCSRY[nTgt] - m_adfCSRY[nSrc]));
+        if (dfDist > 0.0 && dfCost / dfDist < dfFactor)
+            dfFactor = dfCost / dfDist;
+    }
+    if (!CPLIsInf(dfFactor) && !CPLIsNan(dfFactor))
+        m_dfCSRHeuristicFactor = dfFactor;
+    return m_dfCSRHeuristicFactor;
+}
+
+typedef std::pair<double, GUInt32> GNMHeapItem;
+typedef std::priority_queue<GNMHeapItem, std::vector<GNMHeapItem>,
+                            std::greater<GNMHeapItem> > GNMHeap;
+
+GNMPATH GNMGraph::CSRDijkstraShortestPath(GUInt32 nStart, GUInt32 nEnd,
+                                          const std::vector<double> &adfCost)
+{
+    SearchSpace &oSpace = m_oForwardSpace;
+    oSpace.Reset(m_anCSRVertexFIDs.size());
+    const GUInt32 nStamp = oSpace.nStamp;
+
+    oSpace.adfDist[nStart] = 0.0;
+    oSpace.anReached[nStart] = nStamp;
+
+    // Binary heap with lazy deletion: a vertex may be pushed several times
+    // and the outdated entries are skipped when popped.
+    GNMHeap oHeap;
+    oHeap.push(GNMHeapItem(0.0, nStart));
+    bool bFound = false;
+    while (!oHeap.empty())
+    {
+        const GUInt32 nVertex = oHeap.top().second;
+        oHeap.pop();
+        if (oSpace.anSettled[nVertex] == nStamp)
+            continue;
+        oSpace.anSettled[nVertex] = nStamp;
+        if (nVertex == nEnd)
+        {
+            bFound = true;
+            break;
+        }
+
+        const double dfMark = oSpace.adfDist[nVertex];
+        for (size_t i = m_anCSROutOffsets[nVertex];
+             i < m_anCSROutOffsets[nVertex + 1]; ++i)
+        {
+            const GUInt32 nEdge = m_anCSROutEdges[i];
+            if (m_abyCSREdgeBlocked[nEdge])
+                continue;
+
+            // We go in any edge from source to target so we take only
+            // direct cost (even if an edge is bi-directed).
+            const GUInt32 nTarget = GetCSROppositeVertex(nEdge, nVertex);
+            const double dfNewMark = dfMark + adfCost[nEdge];
+            if (oSpace.anSettled[nTarget] != nStamp &&
+                !m_abyCSRVertexBlocked[nTarget] &&
+                dfNewMark < (oSpace.anReached[nTarget] == nStamp ?
+                             oSpace.adfDist[nTarget] :
+                             std::numeric_limits<double>::infinity()))
+            {
+                oSpace.adfDist[nTarget] = dfNewMark;
+                oSpace.anPredEdge[nTarget] = nEdge;
+                oSpace.anReached[nTarget] = nStamp;
+                oHeap.push(GNMHeapItem(dfNewMark, nTarget));
+            }
+        }
+    }
+
+    GNMPATH aoShortestPath;
+    if (!bFound)
+        return aoShortestPath;
+
+    // Walk back the predecessor edges from end point to start point.
+    for (GUInt32 nVertex = nEnd; nVertex != nStart; )
+    {
+        const GUInt32 nEdge = oSpace.anPredEdge[nVertex];
+        aoShortestPath.push_back(std::make_pair(m_anCSRVertexFIDs[nVertex],
+                                                m_anCSREdgeFIDs[nEdge]));
+        nVertex = GetCSROppositeVertex(nEdge, nVertex);
+    }
+    aoShortestPath.push_back(std::make_pair(m_anCSRVertexFIDs[nStart], -1));
+    std::reverse(aoShortestPath.begin(), aoShortestPath.end());
+    return aoShortestPath;
+}
+
+GNMPATH GNMGraph::CSRAStarShortestPath(GUInt32 nStart, GUInt32 nEnd)
+{
+    GNMPATH aoShortestPath;
+    if (nStart == nEnd)
+    {
+        aoShortestPath.push_back(std::make_pair(m_anCSRVertexFIDs[nStart], -1));
+        return aoShortestPath;
+    }
+    // The end vertex cannot be entered. The start vertex may be blocked.
+    if (m_abyCSRVertexBlocked[nEnd])
+        return aoShortestPath;
+
+    const double dfFactor = GetCSRHeuristicFactor();
+    const double dfStartX = dfFactor > 0.0 ? m_adfCSRX[nStart] : 0.0;
+    const double dfStartY = dfFactor > 0.0 ? m_adfCSRY[nStart] : 0.0;
+    const double dfEndX = dfFactor > 0.0 ? m_adfCSRX[nEnd] : 0.0;
+    const double dfEndY = dfFactor > 0.0 ? m_adfCSRY[nEnd] : 0.0;
+
+    // Average of the forward and backward potentials, so that the reduced
+    // costs are the same in both directions and the usual stopping
+    // criterion of the bidirectional Dijkstra search can be used.
+    const auto Potential = [&](GUInt32 nVertex) -> double
+    {
+        if (dfFactor == 0.0)
+            return 0.0;
+        const double dfX = m_adfCSRX[nVertex];
+        const double dfY = m_adfCSRY[nVertex];
+        return 0.5 * dfFactor *
+            (sqrt((dfX - dfEndX) * (dfX - dfEndX) +
+                  (dfY - dfEndY) * (dfY - dfEndY)) -
+             sqrt((dfX - dfStartX) * (dfX - dfStartX) +
+                  (dfY - dfStartY) * (dfY - dfStartY)));
+    };
+
+    SearchSpace *apoSpace[2] = { &m_oForwardSpace, &m_oBackwardSpace };
+    GNMHeap aoHeap[2];
+    const GUInt32 anOrigin[2] = { nStart, nEnd };
+    for (int iDir = 0; iDir < 2; ++iDir)
+    {
+        SearchSpace &oSpace = *apoSpace[iDir];
+        oSpace.Reset(m_anCSRVertexFIDs.size());
+        oSpace.adfDist[anOrigin[iDir]] = 0.0;
+        oSpace.anReached[anOrigin[iDir]] = oSpace.nStamp;
+        const double dfPot = Potential(anOrigin[iDir]);
+        aoHeap[iDir].push(GNMHeapItem(iDir == 0 ? dfPot : -dfPot,
+                                      anOrigin[iDir]));
+    }
+
+    double dfBest = std::numeric_limits<double>::infinity();
+    GUInt32 nMeeting = 0;
+    while (!aoHeap[0].empty() && !aoHeap[1].empty() &&
+           aoHeap[0].top().first + aoHeap[1].top().first < dfBest)
+    {
+        const int iDir = aoHeap[0].top().first <= aoHeap[1].top().first ? 0 : 1;
+        SearchSpace &oSpace = *apoSpace[iDir];
+        const SearchSpace &oOther = *apoSpace[1 - iDir];
+        const GUInt32 nStamp = oSpace.nStamp;
+        const GUInt32 nVertex = aoHeap[iDir].top().second;
+        aoHeap[iDir].pop();
+        if (oSpace.anSettled[nVertex] == nStamp)
+            continue;
+        oSpace.anSettled[nVertex] = nStamp;
+
+        const double dfMark = oSpace.adfDist[nVertex];
+        const std::vector<size_t> &anOffsets =
+            iDir == 0 ? m_anCSROutOffsets : m_anCSRInOffsets;
+        const std::vector<GUInt32> &anEdges =
+            iDir == 0 ? m_anCSROutEdges : m_anCSRInEdges;
+        for (size_t i = anOffsets[nVertex]; i < anOffsets[nVertex + 1]; ++i)
+        {
+            const GUInt32 nEdge = anEdges[i];
+            if (m_abyCSREdgeBlocked[nEdge])
+                continue;
+            const GUInt32 nTarget = GetCSROppositeVertex(nEdge, nVertex);
+            if (oSpace.anSettled[nTarget] == nStamp ||
+                (m_abyCSRVertexBlocked[nTarget] && nTarget != nStart))
+                continue;
+            const double dfNewMark = dfMark + m_adfCSRCost[nEdge];
+            if (dfNewMark < (oSpace.anReached[nTarget] == nStamp ?
+                             oSpace.adfDist[nTarget] :
+                             std::numeric_limits<double>::infinity()))
+            {
+                oSpace.adfDist[nTarget] = dfNewMark;
+                oSpace.anPredEdge[nTarget] = nEdge;
+                oSpace.anReached[nTarget] = nStamp;
+                const double dfPot = Potential(nTarget);
+                aoHeap[iDir].push(GNMHeapItem(
+                    dfNewMark + (iDir == 0 ? dfPot : -dfPot), nTarget));
+
+                if (oOther.anReached[nTarget] == oOther.nStamp &&
+                    dfNewMark + oOther.adfDist[nTarget] < dfBest)
+                {
+                    dfBest = dfNewMark + oOther.adfDist[nTarget];
+                    nMeeting = nTarget;
+                }
+            }
+        }
+    }
+
+    if (CPLIsInf(dfBest))
+        return aoShortestPath;
+
+    // Start to meeting vertex, from the forward predecessors.
+    for (GUInt32 nVertex = nMeeting; nVertex != nStart; )
+    {
+        const GUInt32 nEdge = m_oForwardSpace.anPredEdge[nVertex];
+        aoShortestPath.push_back(std::make_pair(m_anCSRVertexFIDs[nVertex],
+                                                m_anCSREdgeFIDs[nEdge]));
+        nVertex = GetCSROppositeVertex(nEdge, nVertex);
+    }
+    aoShortestPath.push_back(std::make_pair(m_anCSRVertexFIDs[nStart], -1));
+    std::reverse(aoShortestPath.begin(), aoShortestPath.end());
+
+    // Meeting vertex to end, from the backward successors.
+    for (GUInt32 nVertex = nMeeting; nVertex != nEnd; )
+    {
+        const GUInt32 nEdge = m_oBackwardSpace.anPredEdge[nVertex];
+        nVertex = GetCSROppositeVertex(nEdge, nVertex);
+        aoShortestPath.push_back(std::make_pair(m_anCSRVertexFIDs[nVertex],
+                                                m_anCSREdgeFIDs[nEdge]));
+    }
+    return aoShortestPath;
+}
 //! @endcond
@@ -71,6 +71,9 @@ struct GNMStdVertex
 {
     GNMVECTOR anOutEdgeFIDs; /**< TODO */
     bool bIsBloked;          /**< Whether the vertex is blocked */
+    bool bHasCoordinates;    /**< Whether dfX and dfY are set */
+    double dfX;              /**< X coordinate, used by A* search */
+    double dfY;              /**< Y coordinate, used by A* search */
 };
 
 /**
@@ -82,6 +85,9 @@ struct GNMStdVertex
  * GNMGraph class to receive the results in OGRLayer form.
  * NOTE: GNMGraph holds the whole graph in memory, so it can consume
  * a lot of memory if operating huge networks.
+ * The routing methods work on a compressed sparse row copy of the graph,
+ * which is built on first use and after each change of the topology
+ * (costs and block states are updated in place).
  *
  * @since GDAL 2.1
  */
@@ -159,6 +165,19 @@ public:
      */
     virtual void ChangeAllBlockState (bool bBlock = false);
 
+    /**
+     * @brief Set the coordinates of a vertex.
+     *
+     * The coordinates are used as heuristic by AStarShortestPath(). Nothing
+     * is done if the vertex does not exist.
+     *
+     * @param nFID Vertex identificator
+     * @param dfX X coordinate
+     * @param dfY Y coordinate
+     * @since GDAL 3.1
+     */
+    virtual void SetVertexCoordinates(GNMGFID nFID, double dfX, double dfY);
+
     /**
      * @brief An implementation of Dijkstra shortest path algorithm.
      *
@@ -173,6 +192,24 @@ public:
      */
     virtual GNMPATH DijkstraShortestPath(GNMGFID nStartFID, GNMGFID nEndFID);
 
+    /**
+     * @brief A bidirectional A* shortest path search.
+     *
+     * Returns the same kind of path as DijkstraShortestPath(), with the same
+     * cost, but explores much less vertices on large networks. The euclidean
+     * distance to the end and start vertices, scaled by the lowest cost per
+     * distance unit of the edges, is used as heuristic. If some vertex has
+     * no coordinates (see SetVertexCoordinates()), this is a plain
+     * bidirectional Dijkstra search.
+     *
+     * @param nStartFID Start identificator
+     * @param nEndFID End identificator
+     * @return an array of best path included identificator of vertices and
+     * edges
+     * @since GDAL 3.1
+     */
+    virtual GNMPATH AStarShortestPath(GNMGFID nStartFID, GNMGFID nEndFID);
+
     /**
      * @brief An implementation of KShortest paths algorithm.
      *
@@ -241,9 +278,56 @@ protected:
     virtual void TraceTargets(std::queue<GNMGFID> &vertexQueue,
                                 std::set<GNMGFID> &markedVertIds,
                                 GNMPATH &connectedIds);
+
+    // Compressed sparse row graph. Vertices and edges are referred to by
+    // their index in the sorted arrays of identificators.
+    struct SearchSpace
+    {
+        std::vector<double>  adfDist;
+        std::vector<GUInt32> anPredEdge;
+        std::vector<GUInt32> anReached;   // == nStamp if adfDist is set
+        std::vector<GUInt32> anSettled;   // == nStamp if settled
+        GUInt32              nStamp = 0;
+
+        void Reset(size_t nVertices);
+    };
+
+    void BuildCSR();
+    bool GetCSRVertexIndex(GNMGFID nFID, GUInt32 &nIdx) const;
+    bool GetCSREdgeIndex(GNMGFID nFID, GUInt32 &nIdx) const;
+    GUInt32 GetCSROppositeVertex(GUInt32 nEdge, GUInt32 nVertex) const
+    {
+        return m_anCSREdgeSrc[nEdge] == nVertex ? m_anCSREdgeTgt[nEdge] :
+                                                  m_anCSREdgeSrc[nEdge];
+    }
+    double GetCSRHeuristicFactor();
+    GNMPATH CSRDijkstraShortestPath(GUInt32 nStart, GUInt32 nEnd,
+                                    const std::vector<double> &adfCost);
+    GNMPATH CSRAStarShortestPath(GUInt32 nStart, GUInt32 nEnd);
 protected:
     std::map<GNMGFID, GNMStdVertex> m_mstVertices;
     std::map<GNMGFID, GNMStdEdge>   m_mstEdges;
+
+    bool                  m_bCSRValid = false;
+    std::vector<GNMGFID>  m_anCSRVertexFIDs{};
+    std::vector<GNMGFID>  m_anCSREdgeFIDs{};
+    std::vector<GUInt32>  m_anCSREdgeSrc{};
+    std::vector<GUInt32>  m_anCSREdgeTgt{};
+    std::vector<double>   m_adfCSRCost{};
+    std::vector<GByte>    m_abyCSRVertexBlocked{};
+    std::vector<GByte>    m_abyCSREdgeBlocked{};
+    // Outgoing (resp. incoming) arcs of vertex i are the edges
+    // m_anCSROutEdges[m_anCSROutOffsets[i] .. m_anCSROutOffsets[i+1]-1]
+    std::vector<size_t>   m_anCSROutOffsets{};
+    std::vector<GUInt32>  m_anCSROutEdges{};
+    std::vector<size_t>   m_anCSRInOffsets{};
+    std::vector<GUInt32>  m_anCSRInEdges{};
+    std::vector<double>   m_adfCSRX{};
+    std::vector<double>   m_adfCSRY{};
+    bool                  m_bCSRHasAllCoordinates = false;
+    double                m_dfCSRHeuristicFactor = -1.0;  // < 0 if unknown
+    SearchSpace           m_oForwardSpace{};
+    SearchSpace           m_oBackwardSpace{};
 //! @endcond
 };
 
@@ -236,6 +236,10 @@ public:
 /*                            OGRFeatureDefn                            */
 /************************************************************************/
 
+//! @cond Doxygen_Suppress
+struct OGRFeatureDefnFieldIndex;
+//! @endcond
+
 /**
  * Definition of a feature class or feature layer.
  *
@@ -271,6 +275,10 @@ class CPL_DLL OGRFeatureDefn
     char        *pszFeatureClassName;
 
     int         bIgnoreStyle;
+
+    // Lazily built case insensitive name to index map of attribute fields.
+    OGRFeatureDefnFieldIndex *m_poFieldIndex;
+    void        InvalidateFieldIndex();
 //! @endcond
 
   public:
@@ -362,7 +370,22 @@ class CPL_DLL OGRFeature
     char                *m_pszNativeData;
     char                *m_pszNativeMediaType;
 
+    // WKB of geometry fields whose parsing is deferred until first access.
+    struct LazyGeometry
+    {
+        GByte          *pabyWKB = nullptr;
+        size_t          nWKBSize = 0;   // 0 when there is no pending WKB
+        size_t          nAllocSize = 0;
+        bool            bHasEnvelope = false;
+        OGREnvelope     sEnvelope{};
+    };
+    LazyGeometry        *m_pasLazyGeometries;
+
     bool                SetFieldInternal( int i, OGRField * puValue );
+    void                ResolveLazyGeometry( int iField ) const;
+    void                SetGeomFieldFrom( int iField,
+                                          const OGRFeature* poSrcFeature,
+                                          int iSrcField );
 
   protected:
 //! @cond Doxygen_Suppress
@@ -594,6 +617,18 @@ class CPL_DLL OGRFeature
     OGRErr              SetGeomFieldDirectly( int iField, OGRGeometry * );
     OGRErr              SetGeomField( int iField, const OGRGeometry * );
 
+    OGRErr              SetGeomFieldLazyWKB( int iField,
+                                             const GByte* pabyWKB,
+                                             size_t nWKBSize,
+                                             const OGREnvelope* psEnvelope =
+                                                                    nullptr );
+    const GByte*        GetGeomFieldLazyWKB( int iField,
+                                             size_t* pnWKBSize,
+                                             const OGREnvelope** ppsEnvelope =
+                                                            nullptr ) const;
+    bool                GetGeomFieldEnvelope( int iField,
+                                              OGREnvelope* psEnvelope ) const;
+
     OGRFeature         *Clone() const CPL_WARN_UNUSED_RESULT;
     virtual OGRBoolean  Equal( const OGRFeature * poFeature ) const;
 
@@ -719,6 +754,7 @@ class CPL_DLL OGRFeature
     OGRErr              SetFieldsFrom( const OGRFeature *, const int *, int = TRUE );
 
 //! @cond Doxygen_Suppress
+    bool                SwapContent( OGRFeature* poOther );
     OGRErr              RemapFields( OGRFeatureDefn *poNewDefn,
                                      const int *panRemapSource );
     void                AppendField();
@@ -806,6 +842,8 @@ class CPL_DLL OGRFeatureQuery
   private:
     OGRFeatureDefn *poTargetDefn;
     void           *pSWQExpr;
+    void           *pCompiledExpr;
+    bool            bCompiledExprTried;
 
     char      **FieldCollector( void *, char ** );
 
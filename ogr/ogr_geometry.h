@@ -2892,6 +2892,17 @@ class CPL_DLL OGRGeometryFactory
                                               char** papszOptions,
                                               const TransformWithOptionsCache& cache = TransformWithOptionsCache() );
 
+    static OGRErr transformGeometries( int nCount,
+                                       OGRGeometry** papoGeoms,
+                                       OGRCoordinateTransformation *poCT,
+                                       CSLConstList papszOptions = nullptr,
+                                       OGRErr* paeErrors = nullptr );
+
+    static OGRErr processGeometries( int nCount,
+                                     OGRGeometry** papoGeoms,
+                                     CSLConstList papszOptions,
+                                     OGRErr* paeErrors = nullptr );
+
     static OGRGeometry*
         approximateArcAngles( double dfX, double dfY, double dfZ,
                               double dfPrimaryRadius, double dfSecondaryAxis,
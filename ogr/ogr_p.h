@@ -94,6 +94,15 @@ void CPL_DLL OGRMakeWktCoordinateM( char *, double, double, double, double, OGRB
 void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
                       char chDecimalSep, int nPrecision = 15, char chConversionSpecifier = 'f' );
 
+#ifdef __cplusplus
+/* Same as OGRMakeWktCoordinateM(), with the OGR_WKT_ROUND setting fetched */
+/* once by the caller with OGRWktRoundEnabled(). Returns the length of the */
+/* string written. */
+bool OGRWktRoundEnabled();
+size_t OGRMakeWktCoordinateMInternal( char *, double, double, double, double,
+                                      OGRBoolean, OGRBoolean, bool bRound );
+#endif
+
 /* -------------------------------------------------------------------- */
 /*      Date-time parsing and processing functions                      */
 /* -------------------------------------------------------------------- */
@@ -175,6 +184,9 @@ OGRErr OGRReadWKBGeometryType( const unsigned char * pabyData,
 /*                            Other                                     */
 /************************************************************************/
 
+// Incremented each time OGRFieldDefn::SetName() is called
+unsigned OGRFieldDefnGetNameGeneration();
+
 void CPL_DLL OGRUpdateFieldType( OGRFieldDefn* poFDefn,
                                  OGRFieldType eNewType,
                                  OGRFieldSubType eNewSubType );
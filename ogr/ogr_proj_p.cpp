@@ -182,6 +182,8 @@ void OSRProjTLSCache::clear()
 {
     m_oCacheEPSG.clear();
     m_oCacheWKT.clear();
+    m_oCacheUserInput.clear();
+    m_oCacheIsSame.clear();
 }
 
 PJ* OSRProjTLSCache::GetPJForEPSGCode(int nCode, bool bUseNonDeprecated, bool bAddTOWGS84)
@@ -224,6 +226,35 @@ void OSRProjTLSCache::CachePJForWKT(const std::string& wkt, PJ* pj)
                     proj_clone(OSRGetProjTLSContext(), pj), OSRPJDeleter()));
 }
 
+PJ* OSRProjTLSCache::GetPJForUserInput(const std::string& key)
+{
+    try
+    {
+        const auto& cached = m_oCacheUserInput.get(key);
+        return proj_clone(OSRGetProjTLSContext(), cached.get());
+    }
+    catch( const lru11::KeyNotFound& )
+    {
+        return nullptr;
+    }
+}
+
+void OSRProjTLSCache::CachePJForUserInput(const std::string& key, PJ* pj)
+{
+    m_oCacheUserInput.insert(key, std::shared_ptr<PJ>(
+                    proj_clone(OSRGetProjTLSContext(), pj), OSRPJDeleter()));
+}
+
+bool OSRProjTLSCache::GetIsSame(const std::string& key, bool& bIsSame)
+{
+    return m_oCacheIsSame.tryGet(key, bIsSame);
+}
+
+void OSRProjTLSCache::CacheIsSame(const std::string& key, bool bIsSame)
+{
+    m_oCacheIsSame.insert(key, bIsSame);
+}
+
 /************************************************************************/
 /*                         OSRCleanupTLSContext()                       */
 /************************************************************************/
@@ -35,12 +35,14 @@
 
 #include <unordered_map>
 #include <memory>
+#include <string>
 #include <utility>
 
 /*! @cond Doxygen_Suppress */
 
 PJ_CONTEXT* OSRGetProjTLSContext();
 void OSRCleanupTLSContext();
+void OSRCTCleanCache();
 
 class OSRProjTLSCache
 {
@@ -78,6 +80,8 @@ class OSRProjTLSCache
                             std::shared_ptr<PJ>>>::iterator,
                             EPSGCacheKeyHasher>> m_oCacheEPSG{};
         lru11::Cache<std::string, std::shared_ptr<PJ>> m_oCacheWKT{};
+        lru11::Cache<std::string, std::shared_ptr<PJ>> m_oCacheUserInput{};
+        lru11::Cache<std::string, bool> m_oCacheIsSame{256};
 
     public:
         OSRProjTLSCache() = default;
@@ -89,6 +93,12 @@ class OSRProjTLSCache
 
         PJ* GetPJForWKT(const std::string& wkt);
         void CachePJForWKT(const std::string& wkt, PJ* pj);
+
+        PJ* GetPJForUserInput(const std::string& key);
+        void CachePJForUserInput(const std::string& key, PJ* pj);
+
+        bool GetIsSame(const std::string& key, bool& bIsSame);
+        void CacheIsSame(const std::string& key, bool bIsSame);
 };
 
 OSRProjTLSCache* OSRGetProjTLSCache();
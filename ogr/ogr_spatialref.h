@@ -164,6 +164,8 @@ class CPL_DLL OGRSpatialReference
                                   const char* pszCode,
                                   const char* pszURN);
 
+    OGRErr      SetFromUserInputInternal( const char *, bool* pbCacheable );
+
     static CPLString   lookupInDict( const char *pszDictFile,
                                      const char *pszCode );
 
@@ -702,6 +704,8 @@ public:
     /** Set if the transformer must emit CPLError */
     virtual void SetEmitErrors(bool /*bEmitErrors*/) {}
 
+    virtual OGRCoordinateTransformation* Clone() const;
+
     // From CT_MathTransform
 
     /**
@@ -777,6 +781,8 @@ private:
 
 public:
     OGRCoordinateTransformationOptions();
+    OGRCoordinateTransformationOptions(const OGRCoordinateTransformationOptions&);
+    OGRCoordinateTransformationOptions& operator= (const OGRCoordinateTransformationOptions&);
     ~OGRCoordinateTransformationOptions();
 
     bool SetAreaOfInterest(double dfWestLongitudeDeg,
@@ -35,6 +35,8 @@
 #include <cstring>
 #include <limits>
 #include <list>
+#include <memory>
+#include <mutex>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -87,6 +89,39 @@ OGRCoordinateTransformationOptions::OGRCoordinateTransformationOptions():
 /*                  OGRCoordinateTransformationOptions()                */
 /************************************************************************/
 
+/** \brief Copy constructor
+ *
+ * @since GDAL 3.1
+ */
+OGRCoordinateTransformationOptions::OGRCoordinateTransformationOptions(
+    const OGRCoordinateTransformationOptions& other):
+    d(new Private(*(other.d)))
+{
+}
+
+/************************************************************************/
+/*                          operator =()                                */
+/************************************************************************/
+
+/** \brief Assignment operator
+ *
+ * @since GDAL 3.1
+ */
+OGRCoordinateTransformationOptions&
+OGRCoordinateTransformationOptions::operator= (
+    const OGRCoordinateTransformationOptions& other)
+{
+    if( this != &other )
+    {
+        *d = *(other.d);
+    }
+    return *this;
+}
+
+/************************************************************************/
+/*                  OGRCoordinateTransformationOptions()                */
+/************************************************************************/
+
 /** \brief Destroys a OGRCoordinateTransformationOptions.
  *
  * @since GDAL 3.0
@@ -371,6 +406,8 @@ class OGRProjCT : public OGRCoordinateTransformation
     std::vector<Transformation> m_oTransformations{};
     int m_iCurTransformation = -1;
 
+    OGRCoordinateTransformationOptions m_options{};
+
 public:
     OGRProjCT();
     ~OGRProjCT() override;
@@ -389,6 +426,12 @@ public:
     bool GetEmitErrors() const override { return m_bEmitErrors; }
     void SetEmitErrors( bool bEmitErrors ) override
         { m_bEmitErrors = bEmitErrors; }
+
+    OGRCoordinateTransformation* Clone() const override;
+
+    static std::string GetCacheKey( const OGRSpatialReference *poSource,
+                                    const OGRSpatialReference *poTarget,
+                                    const OGRCoordinateTransformationOptions& options );
 };
 
 /************************************************************************/
@@ -436,6 +479,125 @@ void OGRCoordinateTransformation::DestroyCT( OGRCoordinateTransformation* poCT )
     delete poCT;
 }
 
+/************************************************************************/
+/*                               Clone()                                */
+/************************************************************************/
+
+/**
+ * \brief Clone a transformation object.
+ *
+ * The clone is independent from this object, and can typically be used
+ * in a thread different from the one where this object is used, since a
+ * transformation object must not be used concurrently from several threads.
+ *
+ * The default implementation returns NULL, meaning that the transformation
+ * cannot be cloned. Transformations created by
+ * OGRCreateCoordinateTransformation() can be cloned.
+ *
+ * @return a new transformation object to delete with the delete operator,
+ * or NULL.
+ * @since GDAL 3.1
+ */
+
+OGRCoordinateTransformation* OGRCoordinateTransformation::Clone() const
+{
+    return nullptr;
+}
+
+/************************************************************************/
+/*                      Coordinate transformation cache                 */
+/************************************************************************/
+
+// Creating a OGRProjCT requires researching the candidate coordinate
+// operations in the PROJ database, which is much more costly than cloning
+// an existing one. So instances are cached, keyed on the definition of the
+// source and target SRS and on everything else that Initialize() depends on.
+
+static std::mutex g_oCTCacheMutex;
+static lru11::Cache<std::string, std::shared_ptr<OGRCoordinateTransformation>>*
+                                                            g_poCTCache = nullptr;
+
+std::string OGRProjCT::GetCacheKey(
+                        const OGRSpatialReference *poSource,
+                        const OGRSpatialReference *poTarget,
+                        const OGRCoordinateTransformationOptions& oOptions )
+{
+    const auto& options = *(oOptions.d);
+    std::string osKey;
+    const char* const apszOptions[] = { "FORMAT=WKT2_2018", nullptr };
+    for( const OGRSpatialReference* poSRS: { poSource, poTarget } )
+    {
+        if( poSRS == nullptr )
+        {
+            osKey += "(null)";
+        }
+        else
+        {
+            char* pszWKT = nullptr;
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            const OGRErr eErr = poSRS->exportToWkt(&pszWKT, apszOptions);
+            CPLPopErrorHandler();
+            if( eErr != OGRERR_NONE || pszWKT == nullptr )
+            {
+                CPLFree(pszWKT);
+                return std::string();
+            }
+            osKey += pszWKT;
+            CPLFree(pszWKT);
+            for( int iAxis: poSRS->GetDataAxisToSRSAxisMapping() )
+                osKey += CPLSPrintf(",%d", iAxis);
+            const char* pszCenterLong =
+                poSRS->GetExtension("GEOGCS", "CENTER_LONG");
+            if( pszCenterLong )
+                osKey += CPLSPrintf(",CENTER_LONG=%s", pszCenterLong);
+        }
+        osKey += '\n';
+    }
+
+    if( options.bHasAreaOfInterest )
+        osKey += CPLSPrintf("AOI=%.18g,%.18g,%.18g,%.18g\n",
+                            options.dfWestLongitudeDeg,
+                            options.dfSouthLatitudeDeg,
+                            options.dfEastLongitudeDeg,
+                            options.dfNorthLatitudeDeg);
+    if( !options.osCoordOperation.empty() )
+    {
+        osKey += "CO=";
+        osKey += options.osCoordOperation;
+        osKey += options.bReverseCO ? ",reverse\n" : "\n";
+    }
+    if( options.bHasSourceCenterLong )
+        osKey += CPLSPrintf("SRC_CENTER_LONG=%.18g\n",
+                            options.dfSourceCenterLong);
+    if( options.bHasTargetCenterLong )
+        osKey += CPLSPrintf("TGT_CENTER_LONG=%.18g\n",
+                            options.dfTargetCenterLong);
+
+    for( const char* pszConfigOption: { "OGR_CT_FORCE_TRADITIONAL_GIS_ORDER",
+                                        "CENTER_LONG",
+                                        "CHECK_WITH_INVERT_PROJ",
+                                        "THRESHOLD",
+                                        "OGR_CT_OP_SELECTION",
+                                        "OSR_USE_APPROX_TMERC",
+                                        "OSR_USE_ETMERC",
+                                        "OSR_CT_USE_DEFAULT_EPSG_TOWGS84" } )
+    {
+        const char* pszValue = CPLGetConfigOption(pszConfigOption, nullptr);
+        if( pszValue )
+            osKey += CPLSPrintf("%s=%s\n", pszConfigOption, pszValue);
+    }
+    return osKey;
+}
+
+/*! @cond Doxygen_Suppress */
+void OSRCTCleanCache()
+{
+    std::lock_guard<std::mutex> oLock(g_oCTCacheMutex);
+    delete g_poCTCache;
+    g_poCTCache = nullptr;
+}
+/*! @endcond */
+
 /************************************************************************/
 /*                 OGRCreateCoordinateTransformation()                  */
 /************************************************************************/
@@ -530,6 +692,20 @@ OGRCreateCoordinateTransformation( const OGRSpatialReference *poSource,
                                    const OGRCoordinateTransformationOptions& options )
 
 {
+    const std::string osKey(
+        OGRProjCT::GetCacheKey(poSource, poTarget, options));
+    if( !osKey.empty() )
+    {
+        std::lock_guard<std::mutex> oLock(g_oCTCacheMutex);
+        std::shared_ptr<OGRCoordinateTransformation> poCachedCT;
+        if( g_poCTCache && g_poCTCache->tryGet(osKey, poCachedCT) )
+        {
+            OGRCoordinateTransformation* poCT = poCachedCT->Clone();
+            if( poCT )
+                return poCT;
+        }
+    }
+
     OGRProjCT *poCT = new OGRProjCT();
 
     if( !poCT->Initialize( poSource, poTarget, options ) )
@@ -538,6 +714,19 @@ OGRCreateCoordinateTransformation( const OGRSpatialReference *poSource,
         return nullptr;
     }
 
+    if( !osKey.empty() )
+    {
+        std::shared_ptr<OGRCoordinateTransformation> poCachedCT(poCT->Clone());
+        if( poCachedCT )
+        {
+            std::lock_guard<std::mutex> oLock(g_oCTCacheMutex);
+            if( g_poCTCache == nullptr )
+                g_poCTCache = new lru11::Cache<std::string,
+                            std::shared_ptr<OGRCoordinateTransformation>>();
+            g_poCTCache->insert(osKey, poCachedCT);
+        }
+    }
+
     return poCT;
 }
 
@@ -686,6 +875,8 @@ int OGRProjCT::Initialize( const OGRSpatialReference * poSourceIn,
             return FALSE;
     }
 
+    m_options = options;
+
     if( poSourceIn )
         poSRSSource = poSourceIn->Clone();
     if( poTargetIn )
@@ -1407,6 +1598,74 @@ OGRSpatialReference *OGRProjCT::GetTargetCS()
     return poSRSTarget;
 }
 
+/************************************************************************/
+/*                               Clone()                                */
+/************************************************************************/
+
+OGRCoordinateTransformation* OGRProjCT::Clone() const
+{
+    std::unique_ptr<OGRProjCT> poNewCT(new OGRProjCT());
+    auto ctx = OSRGetProjTLSContext();
+
+    // Duplicate the PROJ objects, which is much faster than researching
+    // the coordinate operations again.
+    bool bOK = true;
+    if( m_pj )
+    {
+        poNewCT->m_pj = proj_clone(ctx, m_pj);
+        bOK = poNewCT->m_pj != nullptr;
+    }
+    for( size_t i = 0; bOK && i < m_oTransformations.size(); ++i )
+    {
+        const auto& oTransf = m_oTransformations[i];
+        PJ* pj = oTransf.pj ? proj_clone(ctx, oTransf.pj) : nullptr;
+        if( pj == nullptr && !oTransf.osProjString.empty() )
+            pj = proj_create(ctx, oTransf.osProjString);
+        if( pj == nullptr )
+        {
+            bOK = false;
+            break;
+        }
+        poNewCT->m_oTransformations.emplace_back(
+            oTransf.minx, oTransf.miny, oTransf.maxx, oTransf.maxy,
+            pj, oTransf.osName, oTransf.osProjString, oTransf.accuracy);
+    }
+
+    if( !bOK )
+    {
+        // Some objects, like the ones instantiated from a PROJ string or
+        // by proj_create_crs_to_crs() with some PROJ versions, cannot be
+        // cloned.
+        poNewCT.reset(new OGRProjCT());
+        CPLErrorHandlerPusher oErrorHandler(CPLQuietErrorHandler);
+        if( !poNewCT->Initialize(poSRSSource, poSRSTarget, m_options) )
+            return nullptr;
+        poNewCT->m_bEmitErrors = m_bEmitErrors;
+        return poNewCT.release();
+    }
+
+    if( poSRSSource )
+        poNewCT->poSRSSource = poSRSSource->Clone();
+    poNewCT->bSourceLatLong = bSourceLatLong;
+    poNewCT->bSourceWrap = bSourceWrap;
+    poNewCT->dfSourceWrapLong = dfSourceWrapLong;
+    if( poSRSTarget )
+        poNewCT->poSRSTarget = poSRSTarget->Clone();
+    poNewCT->bTargetLatLong = bTargetLatLong;
+    poNewCT->bTargetWrap = bTargetWrap;
+    poNewCT->dfTargetWrapLong = dfTargetWrapLong;
+    poNewCT->bWebMercatorToWGS84LongLat = bWebMercatorToWGS84LongLat;
+    poNewCT->bCheckWithInvertProj = bCheckWithInvertProj;
+    poNewCT->dfThreshold = dfThreshold;
+    poNewCT->m_bReversePj = m_bReversePj;
+    poNewCT->m_bEmitErrors = m_bEmitErrors;
+    poNewCT->bNoTransform = bNoTransform;
+    poNewCT->m_eStrategy = m_eStrategy;
+    poNewCT->m_iCurTransformation = m_iCurTransformation;
+    poNewCT->m_options = m_options;
+    return poNewCT.release();
+}
+
 /************************************************************************/
 /*                             Transform()                              */
 /************************************************************************/
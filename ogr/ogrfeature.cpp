@@ -41,6 +41,7 @@
 #include <limits>
 #include <map>
 #include <new>
+#include <utility>
 #include <vector>
 
 #include "cpl_conv.h"
@@ -83,6 +84,7 @@ OGRFeature::OGRFeature( OGRFeatureDefn * poDefnIn ) :
     pauFields(nullptr),
     m_pszNativeData(nullptr),
     m_pszNativeMediaType(nullptr),
+    m_pasLazyGeometries(nullptr),
     m_pszStyleString(nullptr),
     m_poStyleTable(nullptr),
     m_pszTmpFieldValue(nullptr)
@@ -190,6 +192,17 @@ OGRFeature::~OGRFeature()
         }
     }
 
+    if( m_pasLazyGeometries != nullptr )
+    {
+        const int nGeomFieldCount = poDefn->GetGeomFieldCount();
+
+        for( int i = 0; i < nGeomFieldCount; i++ )
+        {
+            CPLFree(m_pasLazyGeometries[i].pabyWKB);
+        }
+        delete[] m_pasLazyGeometries;
+    }
+
     poDefn->Release();
 
     CPLFree(pauFields);
@@ -500,6 +513,7 @@ OGRGeometry *OGRFeature::StealGeometry()
 {
     if( GetGeomFieldCount() > 0 )
     {
+        ResolveLazyGeometry(0);
         OGRGeometry *poReturn = papoGeometries[0];
         papoGeometries[0] = nullptr;
         return poReturn;
@@ -528,6 +542,7 @@ OGRGeometry *OGRFeature::StealGeometry( int iGeomField )
 {
     if( iGeomField >= 0 && iGeomField < GetGeomFieldCount() )
     {
+        ResolveLazyGeometry(iGeomField);
         OGRGeometry *poReturn = papoGeometries[iGeomField];
         papoGeometries[iGeomField] = nullptr;
         return poReturn;
@@ -668,8 +683,9 @@ OGRGeometry *OGRFeature::GetGeomFieldRef( int iField )
 {
     if( iField < 0 || iField >= GetGeomFieldCount() )
         return nullptr;
-    else
-        return papoGeometries[iField];
+
+    ResolveLazyGeometry(iField);
+    return papoGeometries[iField];
 }
 
 /**
@@ -688,8 +704,9 @@ const OGRGeometry *OGRFeature::GetGeomFieldRef( int iField ) const
 {
     if( iField < 0 || iField >= GetGeomFieldCount() )
         return nullptr;
-    else
-        return papoGeometries[iField];
+
+    ResolveLazyGeometry(iField);
+    return papoGeometries[iField];
 }
 
 /************************************************************************/
@@ -713,6 +730,7 @@ OGRGeometry *OGRFeature::GetGeomFieldRef( const char* pszFName )
     if( iField < 0 )
         return nullptr;
 
+    ResolveLazyGeometry(iField);
     return papoGeometries[iField];
 }
 
@@ -732,6 +750,7 @@ const OGRGeometry *OGRFeature::GetGeomFieldRef( const char* pszFName ) const
     if( iField < 0 )
         return nullptr;
 
+    ResolveLazyGeometry(iField);
     return papoGeometries[iField];
 }
 
@@ -808,6 +827,9 @@ OGRErr OGRFeature::SetGeomFieldDirectly( int iField, OGRGeometry * poGeomIn )
         return OGRERR_FAILURE;
     }
 
+    if( m_pasLazyGeometries != nullptr )
+        m_pasLazyGeometries[iField].nWKBSize = 0;
+
     if( papoGeometries[iField] != poGeomIn )
     {
         delete papoGeometries[iField];
@@ -883,6 +905,9 @@ OGRErr OGRFeature::SetGeomField( int iField, const OGRGeometry * poGeomIn )
     if( iField < 0 || iField >= GetGeomFieldCount() )
         return OGRERR_FAILURE;
 
+    if( m_pasLazyGeometries != nullptr )
+        m_pasLazyGeometries[iField].nWKBSize = 0;
+
     if( papoGeometries[iField] != poGeomIn )
     {
         delete papoGeometries[iField];
@@ -898,6 +923,182 @@ OGRErr OGRFeature::SetGeomField( int iField, const OGRGeometry * poGeomIn )
     return OGRERR_NONE;
 }
 
+/************************************************************************/
+/*                        SetGeomFieldLazyWKB()                         */
+/************************************************************************/
+
+/**
+ * \brief Set feature geometry of a specified geometry field from WKB, with
+ * deferred parsing.
+ *
+ * The WKB is copied into the feature, but is only turned into a
+ * OGRGeometry the first time the geometry is needed, typically by
+ * GetGeomFieldRef(), GetGeometryRef() or StealGeometry(). Until then,
+ * GetGeomFieldLazyWKB() returns the WKB unchanged and GetGeomFieldEnvelope()
+ * returns psEnvelope, so that readers and writers able to work directly on
+ * WKB can avoid building, and then serializing again, the geometry.
+ *
+ * When parsed, the geometry is assigned the spatial reference of the
+ * geometry field definition.
+ *
+ * @param iField geometry field to set.
+ * @param pabyWKB WKB geometry, in ISO or OGC (2.5D) variant.
+ * @param nWKBSize size of pabyWKB in bytes. Must not be 0.
+ * @param psEnvelope 2D envelope of the geometry, or NULL if it is not known.
+ *
+ * @return OGRERR_NONE if successful, or OGRERR_FAILURE if the index is invalid.
+ *
+ * @since GDAL 3.1
+ */
+
+OGRErr OGRFeature::SetGeomFieldLazyWKB( int iField, const GByte* pabyWKB,
+                                        size_t nWKBSize,
+                                        const OGREnvelope* psEnvelope )
+
+{
+    if( iField < 0 || iField >= GetGeomFieldCount() || nWKBSize == 0 )
+        return OGRERR_FAILURE;
+
+    if( m_pasLazyGeometries == nullptr )
+    {
+        m_pasLazyGeometries =
+            new (std::nothrow) LazyGeometry[GetGeomFieldCount()];
+        if( m_pasLazyGeometries == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory, "Out of memory");
+            return OGRERR_NOT_ENOUGH_MEMORY;
+        }
+    }
+
+    // Keep the buffer of a previous WKB, so that features recycled by
+    // OGRLayer::GetNextFeatureInto() do not reallocate it for every row.
+    LazyGeometry& sLazy = m_pasLazyGeometries[iField];
+    if( nWKBSize > sLazy.nAllocSize )
+    {
+        GByte* pabyNew = static_cast<GByte*>(
+            VSI_REALLOC_VERBOSE(sLazy.pabyWKB, nWKBSize));
+        if( pabyNew == nullptr )
+            return OGRERR_NOT_ENOUGH_MEMORY;
+        sLazy.pabyWKB = pabyNew;
+        sLazy.nAllocSize = nWKBSize;
+    }
+    memcpy(sLazy.pabyWKB, pabyWKB, nWKBSize);
+    sLazy.nWKBSize = nWKBSize;
+    sLazy.bHasEnvelope = psEnvelope != nullptr;
+    if( psEnvelope != nullptr )
+        sLazy.sEnvelope = *psEnvelope;
+
+    delete papoGeometries[iField];
+    papoGeometries[iField] = nullptr;
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                        GetGeomFieldLazyWKB()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the WKB of a geometry field whose parsing has been deferred.
+ *
+ * @param iField geometry field to get.
+ * @param pnWKBSize pointer to the size of the WKB in bytes (may be NULL).
+ * @param ppsEnvelope pointer set to the envelope passed to
+ * SetGeomFieldLazyWKB(), or NULL if unknown (may be NULL).
+ *
+ * @return pointer to the WKB owned by the feature, or NULL if the geometry
+ * field has no pending WKB, either because it was never set with
+ * SetGeomFieldLazyWKB() or because the geometry has been parsed since.
+ *
+ * @since GDAL 3.1
+ */
+
+const GByte* OGRFeature::GetGeomFieldLazyWKB( int iField, size_t* pnWKBSize,
+                                        const OGREnvelope** ppsEnvelope ) const
+
+{
+    if( iField < 0 || iField >= GetGeomFieldCount() ||
+        m_pasLazyGeometries == nullptr ||
+        m_pasLazyGeometries[iField].nWKBSize == 0 )
+    {
+        return nullptr;
+    }
+
+    const LazyGeometry& sLazy = m_pasLazyGeometries[iField];
+    if( pnWKBSize )
+        *pnWKBSize = sLazy.nWKBSize;
+    if( ppsEnvelope )
+        *ppsEnvelope = sLazy.bHasEnvelope ? &sLazy.sEnvelope : nullptr;
+    return sLazy.pabyWKB;
+}
+
+/************************************************************************/
+/*                        GetGeomFieldEnvelope()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the 2D envelope of a geometry field.
+ *
+ * When the geometry has been set with SetGeomFieldLazyWKB() with a known
+ * envelope, it is returned without parsing the geometry.
+ *
+ * @param iField geometry field to get.
+ * @param psEnvelope the structure in which to place the results.
+ *
+ * @return true if the geometry field is set to a non-empty geometry.
+ *
+ * @since GDAL 3.1
+ */
+
+bool OGRFeature::GetGeomFieldEnvelope( int iField,
+                                       OGREnvelope* psEnvelope ) const
+
+{
+    size_t nWKBSize = 0;
+    const OGREnvelope* psLazyEnvelope = nullptr;
+    if( GetGeomFieldLazyWKB(iField, &nWKBSize, &psLazyEnvelope) != nullptr &&
+        psLazyEnvelope != nullptr )
+    {
+        *psEnvelope = *psLazyEnvelope;
+        return true;
+    }
+
+    const OGRGeometry* poGeom = GetGeomFieldRef(iField);
+    if( poGeom == nullptr || poGeom->IsEmpty() )
+        return false;
+    poGeom->getEnvelope(psEnvelope);
+    return true;
+}
+
+/************************************************************************/
+/*                        ResolveLazyGeometry()                         */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+void OGRFeature::ResolveLazyGeometry( int iField ) const
+
+{
+    if( m_pasLazyGeometries == nullptr ||
+        m_pasLazyGeometries[iField].nWKBSize == 0 )
+    {
+        return;
+    }
+
+    LazyGeometry& sLazy = m_pasLazyGeometries[iField];
+    OGRGeometry* poGeom = nullptr;
+    if( OGRGeometryFactory::createFromWkb(
+            sLazy.pabyWKB,
+            poDefn->GetGeomFieldDefn(iField)->GetSpatialRef(),
+            &poGeom, static_cast<int>(sLazy.nWKBSize)) != OGRERR_NONE )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Unable to read geometry");
+        poGeom = nullptr;
+    }
+    sLazy.nWKBSize = 0;
+    papoGeometries[iField] = poGeom;
+}
+//! @endcond
+
 /************************************************************************/
 /*                        OGR_F_SetGeomField()                          */
 /************************************************************************/
@@ -1013,7 +1214,19 @@ bool OGRFeature::CopySelfTo( OGRFeature* poNew ) const
     {
         for( int i = 0; i < poDefn->GetGeomFieldCount(); i++ )
         {
-            if( papoGeometries[i] != nullptr )
+            size_t nWKBSize = 0;
+            const OGREnvelope* psEnvelope = nullptr;
+            const GByte* pabyWKB =
+                GetGeomFieldLazyWKB(i, &nWKBSize, &psEnvelope);
+            if( pabyWKB != nullptr )
+            {
+                if( poNew->SetGeomFieldLazyWKB(i, pabyWKB, nWKBSize,
+                                               psEnvelope) != OGRERR_NONE )
+                {
+                    return false;
+                }
+            }
+            else if( papoGeometries[i] != nullptr )
             {
                 poNew->papoGeometries[i] = papoGeometries[i]->clone();
                 if( poNew->papoGeometries[i] == nullptr )
@@ -1377,13 +1590,13 @@ int OGRFeature::IsFieldSet( int iField ) const
 
           case SPF_OGR_GEOM_WKT:
           case SPF_OGR_GEOMETRY:
-            return GetGeomFieldCount() > 0 && papoGeometries[0] != nullptr;
+            return GetGeometryRef() != nullptr;
 
           case SPF_OGR_STYLE:
             return GetStyleString() != nullptr;
 
           case SPF_OGR_GEOM_AREA:
-            if( GetGeomFieldCount() == 0 || papoGeometries[0] == nullptr )
+            if( GetGeometryRef() == nullptr )
                 return FALSE;
 
             return OGR_G_Area(
@@ -1881,7 +2094,7 @@ int OGRFeature::GetFieldAsInteger( int iField ) const
         }
 
         case SPF_OGR_GEOM_AREA:
-            if( GetGeomFieldCount() == 0 || papoGeometries[0] == nullptr )
+            if( GetGeometryRef() == nullptr )
                 return 0;
             return static_cast<int>(
                 OGR_G_Area(OGRGeometry::ToHandle(papoGeometries[0])));
@@ -2008,7 +2221,7 @@ GIntBig OGRFeature::GetFieldAsInteger64( int iField ) const
             return nFID;
 
         case SPF_OGR_GEOM_AREA:
-            if( GetGeomFieldCount() == 0 || papoGeometries[0] == nullptr )
+            if( GetGeometryRef() == nullptr )
                 return 0;
             return static_cast<int>(
                 OGR_G_Area(OGRGeometry::ToHandle(papoGeometries[0])));
@@ -2126,7 +2339,7 @@ double OGRFeature::GetFieldAsDouble( int iField ) const
             return static_cast<double>(GetFID());
 
         case SPF_OGR_GEOM_AREA:
-            if( GetGeomFieldCount() == 0 || papoGeometries[0] == nullptr )
+            if( GetGeometryRef() == nullptr )
                 return 0.0;
             return
                 OGR_G_Area(OGRGeometry::ToHandle(papoGeometries[0]));
@@ -2316,7 +2529,7 @@ const char *OGRFeature::GetFieldAsString( int iField ) const
             return m_pszTmpFieldValue;
 
           case SPF_OGR_GEOMETRY:
-            if( GetGeomFieldCount() > 0 && papoGeometries[0] != nullptr )
+            if( GetGeometryRef() != nullptr )
                 return papoGeometries[0]->getGeometryName();
             else
                 return "";
@@ -2329,7 +2542,7 @@ const char *OGRFeature::GetFieldAsString( int iField ) const
 
           case SPF_OGR_GEOM_WKT:
           {
-              if( GetGeomFieldCount() == 0 || papoGeometries[0] == nullptr )
+              if( GetGeometryRef() == nullptr )
                   return "";
 
               if( papoGeometries[0]->exportToWkt( &m_pszTmpFieldValue ) ==
@@ -2340,7 +2553,7 @@ const char *OGRFeature::GetFieldAsString( int iField ) const
           }
 
           case SPF_OGR_GEOM_AREA:
-            if( GetGeomFieldCount() == 0 || papoGeometries[0] == nullptr )
+            if( GetGeometryRef() == nullptr )
                 return "";
 
             CPLsnprintf(
@@ -2392,21 +2605,18 @@ const char *OGRFeature::GetFieldAsString( int iField ) const
     }
     else if( eType == OFTReal )
     {
-        char szFormat[64] = {};
-
         if( poFDefn->GetWidth() != 0 )
         {
-            snprintf( szFormat, sizeof(szFormat), "%%.%df",
-                poFDefn->GetPrecision() );
+            CPLFormatDouble( szTempBuffer, TEMP_BUFFER_SIZE,
+                             pauFields[iField].Real, 'f',
+                             poFDefn->GetPrecision() );
         }
         else
         {
-            strcpy( szFormat, "%.15g" );
+            CPLFormatDouble( szTempBuffer, TEMP_BUFFER_SIZE,
+                             pauFields[iField].Real, 'g', 15 );
         }
 
-        CPLsnprintf( szTempBuffer, TEMP_BUFFER_SIZE,
-                  szFormat, pauFields[iField].Real );
-
         m_pszTmpFieldValue = VSI_STRDUP_VERBOSE( szTempBuffer );
         if( m_pszTmpFieldValue == nullptr )
             return "";
@@ -3879,10 +4089,23 @@ void OGRFeature::SetField( int iField, const char * pszValue )
     OGRFieldType eType = poFDefn->GetType();
     if( eType == OFTString )
     {
+        if( pszValue == nullptr )
+            pszValue = "";
         if( IsFieldSetAndNotNull(iField) )
-            CPLFree( pauFields[iField].String );
+        {
+            // Reuse the current buffer when it is large enough, which
+            // saves an allocation per row when the feature is recycled.
+            char* pszOld = pauFields[iField].String;
+            const size_t nLen = strlen(pszValue);
+            if( strlen(pszOld) >= nLen )
+            {
+                memmove( pszOld, pszValue, nLen + 1 );
+                return;
+            }
+            CPLFree( pszOld );
+        }
 
-        pauFields[iField].String = VSI_STRDUP_VERBOSE(pszValue ? pszValue : "");
+        pauFields[iField].String = VSI_STRDUP_VERBOSE(pszValue);
         if( pauFields[iField].String == nullptr )
         {
             OGR_RawField_SetUnset(&pauFields[iField]);
@@ -5339,6 +5562,7 @@ void OGRFeature::DumpReadable( FILE * fpOut, char** papszOptions ) const
             {
                 OGRGeomFieldDefn *poFDefn = poDefn->GetGeomFieldDefn(iField);
 
+                ResolveLazyGeometry(iField);
                 if( papoGeometries[iField] != nullptr )
                 {
                     fprintf( fpOut, "  " );
@@ -5709,6 +5933,32 @@ int OGR_F_Equal( OGRFeatureH hFeat, OGRFeatureH hOtherFeat )
         Equal( OGRFeature::FromHandle(hOtherFeat) );
 }
 
+/************************************************************************/
+/*                          SetGeomFieldFrom()                          */
+/*                                                                      */
+/*      Copy a geometry field of another feature, keeping its WKB       */
+/*      unparsed if it has not been parsed yet.                         */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+void OGRFeature::SetGeomFieldFrom( int iField,
+                                   const OGRFeature* poSrcFeature,
+                                   int iSrcField )
+
+{
+    size_t nWKBSize = 0;
+    const OGREnvelope* psEnvelope = nullptr;
+    const GByte* pabyWKB =
+        poSrcFeature->GetGeomFieldLazyWKB(iSrcField, &nWKBSize, &psEnvelope);
+    if( pabyWKB == nullptr ||
+        SetGeomFieldLazyWKB( iField, pabyWKB, nWKBSize,
+                             psEnvelope ) != OGRERR_NONE )
+    {
+        SetGeomField( iField, poSrcFeature->GetGeomFieldRef(iSrcField) );
+    }
+}
+//! @endcond
+
 /************************************************************************/
 /*                              SetFrom()                               */
 /************************************************************************/
@@ -5839,11 +6089,11 @@ OGRErr OGRFeature::SetFrom( const OGRFeature * poSrcFeature,
         int iSrc = poSrcFeature->GetGeomFieldIndex(
                                     poGFieldDefn->GetNameRef());
         if( iSrc >= 0 )
-            SetGeomField( 0, poSrcFeature->GetGeomFieldRef(iSrc) );
+            SetGeomFieldFrom( 0, poSrcFeature, iSrc );
         else
             // Whatever the geometry field names are.  For backward
             // compatibility.
-            SetGeomField( 0, poSrcFeature->GetGeomFieldRef(0) );
+            SetGeomFieldFrom( 0, poSrcFeature, 0 );
     }
     else
     {
@@ -5854,7 +6104,7 @@ OGRErr OGRFeature::SetFrom( const OGRFeature * poSrcFeature,
             const int iSrc =
                 poSrcFeature->GetGeomFieldIndex(poGFieldDefn->GetNameRef());
             if( iSrc >= 0 )
-                SetGeomField( i, poSrcFeature->GetGeomFieldRef(iSrc) );
+                SetGeomFieldFrom( i, poSrcFeature, iSrc );
             else
                 SetGeomField( i, nullptr );
         }
@@ -6279,6 +6529,30 @@ void OGRFeature::SetStyleTableDirectly( OGRStyleTable *poStyleTable )
 
 //! @cond Doxygen_Suppress
 
+/************************************************************************/
+/*                            SwapContent()                             */
+/*                                                                      */
+/*      Exchange the FID, fields, geometries, style and native data    */
+/*      of two features sharing the same definition.                    */
+/************************************************************************/
+
+bool OGRFeature::SwapContent( OGRFeature* poOther )
+
+{
+    if( poOther->poDefn != poDefn )
+        return false;
+
+    std::swap(nFID, poOther->nFID);
+    std::swap(papoGeometries, poOther->papoGeometries);
+    std::swap(m_pasLazyGeometries, poOther->m_pasLazyGeometries);
+    std::swap(pauFields, poOther->pauFields);
+    std::swap(m_pszNativeData, poOther->m_pszNativeData);
+    std::swap(m_pszNativeMediaType, poOther->m_pszNativeMediaType);
+    std::swap(m_pszStyleString, poOther->m_pszStyleString);
+    std::swap(m_poStyleTable, poOther->m_poStyleTable);
+    return true;
+}
+
 /************************************************************************/
 /*                            RemapFields()                             */
 /*                                                                      */
@@ -6354,6 +6628,19 @@ OGRErr OGRFeature::RemapGeomFields( OGRFeatureDefn *poNewDefn,
     if( poNewDefn == nullptr )
         poNewDefn = poDefn;
 
+    // Parse pending WKB geometries, so that only papoGeometries has to be
+    // remapped.
+    if( m_pasLazyGeometries != nullptr )
+    {
+        for( int i = 0; i < poDefn->GetGeomFieldCount(); i++ )
+        {
+            ResolveLazyGeometry(i);
+            CPLFree(m_pasLazyGeometries[i].pabyWKB);
+        }
+        delete[] m_pasLazyGeometries;
+        m_pasLazyGeometries = nullptr;
+    }
+
     OGRGeometry** papoNewGeomFields = static_cast<OGRGeometry **>(
         CPLCalloc( poNewDefn->GetGeomFieldCount(), sizeof(OGRGeometry*) ) );
 
@@ -33,6 +33,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -61,6 +63,25 @@ CPL_CVSID("$Id: ogrfeaturedefn.cpp 2346691d22966caec32267770925aa7a9d47147d 2019
  * need to be unique.
  */
 
+//! @cond Doxygen_Suppress
+/************************************************************************/
+/*                       OGRFeatureDefnFieldIndex                       */
+/************************************************************************/
+
+// Below that number of fields, a linear scan is fast enough.
+static const int FIELD_INDEX_MIN_FIELD_COUNT = 16;
+
+struct OGRFeatureDefnFieldIndex
+{
+    std::mutex                           oMutex{};
+    bool                                 bValid = false;
+    int                                  nFieldCount = 0;
+    unsigned                             nNameGeneration = 0;
+    // Upper case field name to index of the first field with that name.
+    std::unordered_map<std::string, int> oMap{};
+};
+//! @endcond
+
 OGRFeatureDefn::OGRFeatureDefn( const char * pszName ) :
     nRefCount(0),
     nFieldCount(0),
@@ -68,7 +89,8 @@ OGRFeatureDefn::OGRFeatureDefn( const char * pszName ) :
     nGeomFieldCount(1),
     papoGeomFieldDefn(nullptr),
     pszFeatureClassName(nullptr),
-    bIgnoreStyle(FALSE)
+    bIgnoreStyle(FALSE),
+    m_poFieldIndex(new OGRFeatureDefnFieldIndex())
 {
     pszFeatureClassName = CPLStrdup( pszName );
     papoGeomFieldDefn =
@@ -128,6 +150,8 @@ OGRFeatureDefn::~OGRFeatureDefn()
     }
 
     CPLFree( papoGeomFieldDefn );
+
+    delete m_poFieldIndex;
 }
 
 /************************************************************************/
@@ -399,6 +423,16 @@ OGRFieldDefnH OGR_FD_GetFieldDefn( OGRFeatureDefnH hDefn, int iField )
 
 //! @cond Doxygen_Suppress
 
+/************************************************************************/
+/*                        InvalidateFieldIndex()                        */
+/************************************************************************/
+
+void OGRFeatureDefn::InvalidateFieldIndex()
+{
+    std::lock_guard<std::mutex> oLock(m_poFieldIndex->oMutex);
+    m_poFieldIndex->bValid = false;
+}
+
 /************************************************************************/
 /*                        ReserveSpaceForFields()                       */
 /************************************************************************/
@@ -439,6 +473,8 @@ void OGRFeatureDefn::AddFieldDefn( OGRFieldDefn * poNewDefn )
 
     papoFieldDefn[nFieldCount] = new OGRFieldDefn( poNewDefn );
     nFieldCount++;
+
+    InvalidateFieldIndex();
 }
 
 /************************************************************************/
@@ -507,6 +543,8 @@ OGRErr OGRFeatureDefn::DeleteFieldDefn( int iField )
 
     nFieldCount--;
 
+    InvalidateFieldIndex();
+
     return OGRERR_NONE;
 }
 
@@ -581,6 +619,8 @@ OGRErr OGRFeatureDefn::ReorderFieldDefns( int* panMap )
     CPLFree(papoFieldDefn);
     papoFieldDefn = papoFieldDefnNew;
 
+    InvalidateFieldIndex();
+
     return OGRERR_NONE;
 }
 
@@ -1208,6 +1248,10 @@ int OGR_FD_GetReferenceCount( OGRFeatureDefnH hDefn )
  * The field index of the first field matching the passed field name (case
  * insensitively) is returned.
  *
+ * Starting with GDAL 3.1, for definitions with many fields, the lookup uses
+ * an index of the field names that is built on the first call, and rebuilt
+ * after fields have been added, deleted, reordered or renamed.
+ *
  * This method is the same as the C function OGR_FD_GetFieldIndex().
  *
  * @param pszFieldName the field name to search for.
@@ -1219,6 +1263,33 @@ int OGRFeatureDefn::GetFieldIndex( const char * pszFieldName ) const
 
 {
     GetFieldCount();
+    if( nFieldCount >= FIELD_INDEX_MIN_FIELD_COUNT )
+    {
+        std::lock_guard<std::mutex> oLock(m_poFieldIndex->oMutex);
+        const unsigned nNameGeneration = OGRFieldDefnGetNameGeneration();
+        if( !m_poFieldIndex->bValid ||
+            m_poFieldIndex->nFieldCount != nFieldCount ||
+            m_poFieldIndex->nNameGeneration != nNameGeneration )
+        {
+            m_poFieldIndex->oMap.clear();
+            for( int i = 0; i < nFieldCount; i++ )
+            {
+                const OGRFieldDefn* poFDefn = GetFieldDefn(i);
+                if( poFDefn != nullptr )
+                {
+                    m_poFieldIndex->oMap.insert(std::pair<std::string, int>(
+                        CPLString(poFDefn->GetNameRef()).toupper(), i));
+                }
+            }
+            m_poFieldIndex->nFieldCount = nFieldCount;
+            m_poFieldIndex->nNameGeneration = nNameGeneration;
+            m_poFieldIndex->bValid = true;
+        }
+        const auto oIter =
+            m_poFieldIndex->oMap.find(CPLString(pszFieldName).toupper());
+        return oIter == m_poFieldIndex->oMap.end() ? -1 : oIter->second;
+    }
+
     for( int i = 0; i < nFieldCount; i++ )
     {
         const OGRFieldDefn* poFDefn = GetFieldDefn(i);
@@ -32,9 +32,12 @@
 #include "ogr_feature.h"
 #include "swq.h"
 
+#include <climits>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <algorithm>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -57,13 +60,17 @@ const char *const SpecialFieldNames[SPECIAL_FIELD_COUNT] = {
 const swq_field_type SpecialFieldTypes[SPECIAL_FIELD_COUNT] = {
     SWQ_INTEGER, SWQ_STRING, SWQ_STRING, SWQ_STRING, SWQ_FLOAT};
 
+static void OGRFeatureQueryFreeCompiledExpr( void* pCompiledExpr );
+
 /************************************************************************/
 /*                          OGRFeatureQuery()                           */
 /************************************************************************/
 
 OGRFeatureQuery::OGRFeatureQuery() :
     poTargetDefn(nullptr),
-    pSWQExpr(nullptr)
+    pSWQExpr(nullptr),
+    pCompiledExpr(nullptr),
+    bCompiledExprTried(false)
 {}
 
 /************************************************************************/
@@ -73,6 +80,7 @@ OGRFeatureQuery::OGRFeatureQuery() :
 OGRFeatureQuery::~OGRFeatureQuery()
 
 {
+    OGRFeatureQueryFreeCompiledExpr(pCompiledExpr);
     delete static_cast<swq_expr_node *>(pSWQExpr);
 }
 
@@ -117,6 +125,9 @@ OGRFeatureQuery::Compile( OGRLayer *poLayer,
                           swq_custom_func_registrar *poCustomFuncRegistrar )
 {
     // Clear any existing expression.
+    OGRFeatureQueryFreeCompiledExpr(pCompiledExpr);
+    pCompiledExpr = nullptr;
+    bCompiledExprTried = false;
     if( pSWQExpr != nullptr )
     {
         delete static_cast<swq_expr_node *>(pSWQExpr);
@@ -323,6 +334,726 @@ static swq_expr_node *OGRFeatureFetcher( swq_expr_node *op, void *pFeatureIn )
     return poRetNode;
 }
 
+/************************************************************************/
+/*                     OGRFeatureQueryCompiledExpr                      */
+/*                                                                      */
+/*      Flattened form of an attribute filter, evaluated directly on    */
+/*      the field values of the feature, without the swq_expr_node     */
+/*      results allocated by swq_expr_node::Evaluate().                 */
+/*                                                                      */
+/*      Logical operators and comparisons of columns with constants    */
+/*      or other columns are compiled, with the same semantics as       */
+/*      SWQGeneralEvaluator(). Sub-expressions without column           */
+/*      reference are folded into constants, and any other              */
+/*      sub-expression is evaluated with swq_expr_node::Evaluate().     */
+/************************************************************************/
+
+namespace {
+
+// Result of a compiled node. As with swq_expr_node::Evaluate(), a NULL
+// operand makes logical operators and comparisons false, and an error
+// makes the whole expression false.
+constexpr int COMPILED_FALSE = 0;
+constexpr int COMPILED_TRUE = 1;
+constexpr int COMPILED_NULL = 2;
+constexpr int COMPILED_ERROR = 3;
+
+typedef enum
+{
+    CNK_CONSTANT,
+    CNK_FALLBACK,
+    CNK_AND,
+    CNK_OR,
+    CNK_NOT,
+    CNK_COMPARE_INTEGER,
+    CNK_COMPARE_REAL,
+    CNK_COMPARE_STRING
+} OGRCompiledNodeKind;
+
+struct OGRCompiledOperand
+{
+    int             iField = -1;     // feature field index, -1 for constants
+    swq_field_type  eType = SWQ_INTEGER; // type of the value as evaluated
+    GIntBig         nValue = 0;
+    double          dfValue = 0.0;
+    CPLString       osValue{};
+};
+
+struct OGRCompiledNode
+{
+    OGRCompiledNodeKind eKind = CNK_CONSTANT;
+    swq_op          eOp = SWQ_EQ;
+    // True if the node never evaluates to NULL nor to an error, in which
+    // case logical operators can skip their second operand.
+    bool            bPure = false;
+    int             nConstant = COMPILED_FALSE;
+    swq_expr_node  *poFallback = nullptr;
+    int             iFirstChild = -1;
+    int             iSecondChild = -1;
+    std::vector<OGRCompiledOperand> aoOperands{};
+};
+
+} // namespace
+
+class OGRFeatureQueryCompiledExpr
+{
+    std::vector<OGRCompiledNode> m_aoNodes{};
+    OGRFeatureDefn *m_poDefn = nullptr;
+    int             m_iRoot = -1;
+
+    int             AddConstant( const swq_expr_node* poConstant );
+    int             AddFallback( swq_expr_node* poNode );
+    int             CompileNode( swq_expr_node* poNode );
+    bool            CompileOperand( const swq_expr_node* poNode,
+                                    OGRCompiledOperand& oOperand );
+    int             CompileComparison( swq_expr_node* poNode );
+
+    int             EvaluateNode( int iNode, OGRFeature* poFeature ) const;
+    bool            EvaluateComparison( const OGRCompiledNode& oNode,
+                                        OGRFeature* poFeature ) const;
+
+  public:
+    static OGRFeatureQueryCompiledExpr* Compile( swq_expr_node* poExpr,
+                                                 OGRFeatureDefn* poDefn );
+
+    bool            Evaluate( OGRFeature* poFeature ) const
+        { return EvaluateNode(m_iRoot, poFeature) == COMPILED_TRUE; }
+};
+
+/************************************************************************/
+/*                       OGRCompiledRuntimeType()                       */
+/*                                                                      */
+/*      Type of the value node swq_expr_node::Evaluate() returns for a  */
+/*      node, which depends on OGRFeatureFetcher() for columns.         */
+/************************************************************************/
+
+static swq_field_type OGRCompiledRuntimeType( const swq_expr_node* poNode )
+{
+    if( poNode->eNodeType != SNT_COLUMN )
+        return poNode->field_type;
+
+    switch( poNode->field_type )
+    {
+        case SWQ_INTEGER:
+        case SWQ_BOOLEAN:
+            return SWQ_INTEGER;
+        case SWQ_INTEGER64:
+        case SWQ_FLOAT:
+        case SWQ_TIMESTAMP:
+        case SWQ_GEOMETRY:
+            return poNode->field_type;
+        default:
+            return SWQ_STRING;
+    }
+}
+
+/************************************************************************/
+/*                      OGRCompiledHasColumnRef()                       */
+/************************************************************************/
+
+static bool OGRCompiledHasColumnRef( const swq_expr_node* poNode )
+{
+    if( poNode->eNodeType == SNT_COLUMN )
+        return true;
+    if( poNode->eNodeType == SNT_OPERATION )
+    {
+        // Custom functions are not known to be deterministic.
+        if( poNode->nOperation == SWQ_CUSTOM_FUNC )
+            return true;
+        for( int i = 0; i < poNode->nSubExprCount; i++ )
+        {
+            if( OGRCompiledHasColumnRef(poNode->papoSubExpr[i]) )
+                return true;
+        }
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                         OGRCompiledGetDepth()                        */
+/************************************************************************/
+
+static int OGRCompiledGetDepth( const swq_expr_node* poNode )
+{
+    int nDepth = 0;
+    if( poNode->eNodeType == SNT_OPERATION )
+    {
+        for( int i = 0; i < poNode->nSubExprCount; i++ )
+            nDepth = std::max(nDepth,
+                              OGRCompiledGetDepth(poNode->papoSubExpr[i]));
+    }
+    return 1 + nDepth;
+}
+
+/************************************************************************/
+/*                              Compile()                               */
+/************************************************************************/
+
+OGRFeatureQueryCompiledExpr*
+OGRFeatureQueryCompiledExpr::Compile( swq_expr_node* poExpr,
+                                      OGRFeatureDefn* poDefn )
+{
+    // swq_expr_node::Evaluate() errors out on deeper expressions.
+    if( OGRCompiledGetDepth(poExpr) >= 32 )
+        return nullptr;
+
+    OGRFeatureQueryCompiledExpr* poCompiled = new OGRFeatureQueryCompiledExpr();
+    poCompiled->m_poDefn = poDefn;
+    poCompiled->m_iRoot = poCompiled->CompileNode(poExpr);
+
+    // Nothing gained over swq_expr_node::Evaluate().
+    if( poCompiled->m_aoNodes[poCompiled->m_iRoot].eKind == CNK_FALLBACK )
+    {
+        delete poCompiled;
+        return nullptr;
+    }
+    return poCompiled;
+}
+
+/************************************************************************/
+/*                            AddConstant()                             */
+/************************************************************************/
+
+int OGRFeatureQueryCompiledExpr::AddConstant( const swq_expr_node* poConstant )
+{
+    OGRCompiledNode oNode;
+    oNode.eKind = CNK_CONSTANT;
+    if( poConstant->is_null )
+    {
+        oNode.nConstant = COMPILED_NULL;
+    }
+    else
+    {
+        oNode.bPure = true;
+        if( poConstant->field_type == SWQ_INTEGER ||
+            poConstant->field_type == SWQ_INTEGER64 ||
+            poConstant->field_type == SWQ_BOOLEAN )
+        {
+            oNode.nConstant = poConstant->int_value != 0 ? COMPILED_TRUE :
+                                                           COMPILED_FALSE;
+        }
+    }
+    m_aoNodes.push_back(oNode);
+    return static_cast<int>(m_aoNodes.size()) - 1;
+}
+
+/************************************************************************/
+/*                            AddFallback()                             */
+/************************************************************************/
+
+int OGRFeatureQueryCompiledExpr::AddFallback( swq_expr_node* poNode )
+{
+    OGRCompiledNode oNode;
+    oNode.eKind = CNK_FALLBACK;
+    oNode.poFallback = poNode;
+    m_aoNodes.push_back(oNode);
+    return static_cast<int>(m_aoNodes.size()) - 1;
+}
+
+/************************************************************************/
+/*                            CompileNode()                             */
+/************************************************************************/
+
+int OGRFeatureQueryCompiledExpr::CompileNode( swq_expr_node* poNode )
+{
+    if( poNode->eNodeType == SNT_CONSTANT )
+        return AddConstant(poNode);
+
+    if( poNode->eNodeType == SNT_COLUMN )
+        return AddFallback(poNode);
+
+/* -------------------------------------------------------------------- */
+/*      Fold sub-expressions that do not depend on the feature, unless  */
+/*      they emit an error that must then be emitted at each            */
+/*      evaluation.                                                     */
+/* -------------------------------------------------------------------- */
+    if( !OGRCompiledHasColumnRef(poNode) )
+    {
+        const GUInt32 nErrorCounter = CPLGetErrorCounter();
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        swq_expr_node* poValue = poNode->Evaluate(OGRFeatureFetcher, nullptr);
+        CPLPopErrorHandler();
+        if( poValue == nullptr || CPLGetErrorCounter() != nErrorCounter )
+        {
+            delete poValue;
+            return AddFallback(poNode);
+        }
+        const int iNode = AddConstant(poValue);
+        delete poValue;
+        return iNode;
+    }
+
+    switch( poNode->nOperation )
+    {
+        case SWQ_AND:
+        case SWQ_OR:
+        case SWQ_NOT:
+        {
+            const int nExpectedCount = poNode->nOperation == SWQ_NOT ? 1 : 2;
+            if( poNode->nSubExprCount != nExpectedCount ||
+                poNode->field_type != SWQ_BOOLEAN )
+                return AddFallback(poNode);
+            // Other operand types do not go through the integer/boolean
+            // branch of SWQGeneralEvaluator().
+            for( int i = 0; i < nExpectedCount; i++ )
+            {
+                const swq_field_type eType =
+                    OGRCompiledRuntimeType(poNode->papoSubExpr[i]);
+                if( eType != SWQ_INTEGER && eType != SWQ_INTEGER64 &&
+                    eType != SWQ_BOOLEAN )
+                    return AddFallback(poNode);
+            }
+
+            const int iFirst = CompileNode(poNode->papoSubExpr[0]);
+            const int iSecond = nExpectedCount == 2 ?
+                CompileNode(poNode->papoSubExpr[1]) : -1;
+
+            OGRCompiledNode oNode;
+            oNode.eKind = poNode->nOperation == SWQ_AND ? CNK_AND :
+                          poNode->nOperation == SWQ_OR ? CNK_OR : CNK_NOT;
+            oNode.iFirstChild = iFirst;
+            oNode.iSecondChild = iSecond;
+            oNode.bPure = m_aoNodes[iFirst].bPure &&
+                          (iSecond < 0 || m_aoNodes[iSecond].bPure);
+            m_aoNodes.push_back(oNode);
+            return static_cast<int>(m_aoNodes.size()) - 1;
+        }
+
+        case SWQ_EQ:
+        case SWQ_NE:
+        case SWQ_GE:
+        case SWQ_LE:
+        case SWQ_LT:
+        case SWQ_GT:
+        case SWQ_IN:
+        case SWQ_BETWEEN:
+        case SWQ_ISNULL:
+        case SWQ_LIKE:
+            return CompileComparison(poNode);
+
+        default:
+            return AddFallback(poNode);
+    }
+}
+
+/************************************************************************/
+/*                           CompileOperand()                           */
+/************************************************************************/
+
+bool OGRFeatureQueryCompiledExpr::CompileOperand(
+                    const swq_expr_node* poNode, OGRCompiledOperand& oOperand )
+{
+    if( poNode->eNodeType == SNT_COLUMN )
+    {
+        if( poNode->field_type == SWQ_GEOMETRY || poNode->table_index != 0 )
+            return false;
+        oOperand.iField = OGRFeatureFetcherFixFieldIndex(m_poDefn,
+                                                         poNode->field_index);
+        oOperand.eType = OGRCompiledRuntimeType(poNode);
+        // GetFieldAsString() formats values of other field types in a
+        // buffer that the next call on the feature overwrites.
+        if( oOperand.eType == SWQ_STRING &&
+            (oOperand.iField >= m_poDefn->GetFieldCount() ||
+             m_poDefn->GetFieldDefn(oOperand.iField)->GetType() != OFTString) )
+            return false;
+        return true;
+    }
+
+    swq_expr_node* poValue = nullptr;
+    if( poNode->eNodeType == SNT_OPERATION )
+    {
+        if( OGRCompiledHasColumnRef(poNode) )
+            return false;
+        const GUInt32 nErrorCounter = CPLGetErrorCounter();
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        poValue = const_cast<swq_expr_node*>(poNode)->Evaluate(
+                                                OGRFeatureFetcher, nullptr);
+        CPLPopErrorHandler();
+        if( poValue == nullptr || CPLGetErrorCounter() != nErrorCounter )
+        {
+            delete poValue;
+            return false;
+        }
+        poNode = poValue;
+    }
+
+    bool bRet = true;
+    oOperand.iField = -1;
+    oOperand.eType = poNode->field_type;
+    if( poNode->is_null )
+    {
+        // Any NULL operand makes the comparison false. Let
+        // swq_expr_node::Evaluate() deal with this unusual case.
+        bRet = false;
+    }
+    else if( poNode->field_type == SWQ_INTEGER ||
+             poNode->field_type == SWQ_INTEGER64 ||
+             poNode->field_type == SWQ_BOOLEAN )
+    {
+        oOperand.nValue = poNode->int_value;
+    }
+    else if( poNode->field_type == SWQ_FLOAT )
+    {
+        oOperand.dfValue = poNode->float_value;
+    }
+    else if( poNode->field_type == SWQ_STRING &&
+             poNode->string_value != nullptr )
+    {
+        oOperand.osValue = poNode->string_value;
+    }
+    else
+    {
+        bRet = false;
+    }
+    delete poValue;
+    return bRet;
+}
+
+/************************************************************************/
+/*                         CompileComparison()                          */
+/************************************************************************/
+
+int OGRFeatureQueryCompiledExpr::CompileComparison( swq_expr_node* poNode )
+{
+    const int nCount = poNode->nSubExprCount;
+    const swq_op eOp = static_cast<swq_op>(poNode->nOperation);
+    if( poNode->field_type != SWQ_BOOLEAN ||
+        (eOp == SWQ_ISNULL && nCount != 1) ||
+        (eOp == SWQ_BETWEEN && nCount != 3) ||
+        (eOp == SWQ_IN && nCount < 2) ||
+        (eOp == SWQ_LIKE && nCount != 2 && nCount != 3) ||
+        (eOp != SWQ_ISNULL && eOp != SWQ_BETWEEN && eOp != SWQ_IN &&
+         eOp != SWQ_LIKE && nCount != 2) )
+    {
+        return AddFallback(poNode);
+    }
+
+    OGRCompiledNode oNode;
+    oNode.eOp = eOp;
+    oNode.bPure = true;
+    oNode.aoOperands.resize(nCount);
+    for( int i = 0; i < nCount; i++ )
+    {
+        if( !CompileOperand(poNode->papoSubExpr[i], oNode.aoOperands[i]) )
+            return AddFallback(poNode);
+    }
+
+    if( eOp == SWQ_ISNULL )
+    {
+        // Only the nullity of a column matters, whatever its type.
+        if( oNode.aoOperands[0].iField < 0 )
+            return AddFallback(poNode);
+        oNode.eKind = CNK_COMPARE_INTEGER;
+        m_aoNodes.push_back(oNode);
+        return static_cast<int>(m_aoNodes.size()) - 1;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Select the same branch as SWQGeneralEvaluator() does from the   */
+/*      types of the first two operands, and check that all operands   */
+/*      are handled by it.                                              */
+/* -------------------------------------------------------------------- */
+    const swq_field_type eType0 = oNode.aoOperands[0].eType;
+    const swq_field_type eType1 = oNode.aoOperands[1].eType;
+    if( eType0 == SWQ_FLOAT || eType1 == SWQ_FLOAT )
+    {
+        oNode.eKind = CNK_COMPARE_REAL;
+        if( eOp == SWQ_LIKE )
+            return AddFallback(poNode);
+        for( const auto& oOperand: oNode.aoOperands )
+        {
+            if( oOperand.eType != SWQ_FLOAT &&
+                !SWQ_IS_INTEGER(oOperand.eType) )
+                return AddFallback(poNode);
+        }
+    }
+    else if( SWQ_IS_INTEGER(eType0) || eType0 == SWQ_BOOLEAN )
+    {
+        oNode.eKind = CNK_COMPARE_INTEGER;
+        if( eOp == SWQ_LIKE )
+            return AddFallback(poNode);
+        for( const auto& oOperand: oNode.aoOperands )
+        {
+            if( oOperand.eType != SWQ_BOOLEAN &&
+                !SWQ_IS_INTEGER(oOperand.eType) )
+                return AddFallback(poNode);
+        }
+    }
+    else if( eType0 == SWQ_STRING )
+    {
+        oNode.eKind = CNK_COMPARE_STRING;
+        for( const auto& oOperand: oNode.aoOperands )
+        {
+            if( oOperand.eType != SWQ_STRING )
+                return AddFallback(poNode);
+        }
+    }
+    else
+    {
+        return AddFallback(poNode);
+    }
+
+    m_aoNodes.push_back(oNode);
+    return static_cast<int>(m_aoNodes.size()) - 1;
+}
+
+/************************************************************************/
+/*                            EvaluateNode()                            */
+/************************************************************************/
+
+int OGRFeatureQueryCompiledExpr::EvaluateNode( int iNode,
+                                               OGRFeature* poFeature ) const
+{
+    const OGRCompiledNode& oNode = m_aoNodes[iNode];
+    switch( oNode.eKind )
+    {
+        case CNK_CONSTANT:
+            return oNode.nConstant;
+
+        case CNK_FALLBACK:
+        {
+            swq_expr_node *poResult =
+                oNode.poFallback->Evaluate(OGRFeatureFetcher, poFeature);
+            if( poResult == nullptr )
+                return COMPILED_ERROR;
+            int nRet = COMPILED_FALSE;
+            if( poResult->is_null )
+                nRet = COMPILED_NULL;
+            else if( (poResult->field_type == SWQ_INTEGER ||
+                      poResult->field_type == SWQ_INTEGER64 ||
+                      poResult->field_type == SWQ_BOOLEAN) &&
+                     poResult->int_value != 0 )
+                nRet = COMPILED_TRUE;
+            delete poResult;
+            return nRet;
+        }
+
+        case CNK_AND:
+        case CNK_OR:
+        {
+            const int nFirst = EvaluateNode(oNode.iFirstChild, poFeature);
+            if( oNode.bPure )
+            {
+                if( oNode.eKind == CNK_AND && nFirst == COMPILED_FALSE )
+                    return COMPILED_FALSE;
+                if( oNode.eKind == CNK_OR && nFirst == COMPILED_TRUE )
+                    return COMPILED_TRUE;
+                return EvaluateNode(oNode.iSecondChild, poFeature);
+            }
+            const int nSecond = EvaluateNode(oNode.iSecondChild, poFeature);
+            if( nFirst == COMPILED_ERROR || nSecond == COMPILED_ERROR )
+                return COMPILED_ERROR;
+            if( nFirst == COMPILED_NULL || nSecond == COMPILED_NULL )
+                return COMPILED_FALSE;
+            if( oNode.eKind == CNK_AND )
+                return (nFirst == COMPILED_TRUE && nSecond == COMPILED_TRUE) ?
+                    COMPILED_TRUE : COMPILED_FALSE;
+            return (nFirst == COMPILED_TRUE || nSecond == COMPILED_TRUE) ?
+                COMPILED_TRUE : COMPILED_FALSE;
+        }
+
+        case CNK_NOT:
+        {
+            const int nFirst = EvaluateNode(oNode.iFirstChild, poFeature);
+            if( nFirst == COMPILED_ERROR )
+                return COMPILED_ERROR;
+            return nFirst == COMPILED_FALSE ? COMPILED_TRUE : COMPILED_FALSE;
+        }
+
+        case CNK_COMPARE_INTEGER:
+        case CNK_COMPARE_REAL:
+        case CNK_COMPARE_STRING:
+            return EvaluateComparison(oNode, poFeature) ? COMPILED_TRUE :
+                                                          COMPILED_FALSE;
+    }
+    return COMPILED_ERROR;
+}
+
+/************************************************************************/
+/*                       OGRCompiledCompareValues()                     */
+/************************************************************************/
+
+template<class T> static bool OGRCompiledCompareValues( swq_op eOp,
+                                                        T a, T b )
+{
+    switch( eOp )
+    {
+        case SWQ_EQ: return a == b;
+        case SWQ_NE: return a != b;
+        case SWQ_GT: return a > b;
+        case SWQ_LT: return a < b;
+        case SWQ_GE: return a >= b;
+        case SWQ_LE: return a <= b;
+        default: break;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                      OGRCompiledCompareStrings()                     */
+/************************************************************************/
+
+static bool OGRCompiledCompareStrings( swq_op eOp,
+                                       const char* pszA, const char* pszB )
+{
+    if( eOp == SWQ_EQ )
+    {
+        // When comparing timestamps, the +00 at the end might be discarded
+        // if the other member has no explicit timezone.
+        const size_t nLenA = strlen(pszA);
+        const size_t nLenB = strlen(pszB);
+        if( nLenA > 3 && nLenB > 3 )
+        {
+            if( strcmp(pszA + nLenA - 3, "+00") == 0 &&
+                pszB[nLenB - 3] == ':' )
+                return EQUALN(pszA, pszB, nLenB);
+            if( pszA[nLenA - 3] == ':' &&
+                strcmp(pszB + nLenB - 3, "+00") == 0 )
+                return EQUALN(pszA, pszB, nLenA);
+        }
+        return strcasecmp(pszA, pszB) == 0;
+    }
+    const int nCmp = strcasecmp(pszA, pszB);
+    return OGRCompiledCompareValues(eOp, nCmp, 0);
+}
+
+/************************************************************************/
+/*                         OGRCompiledGet*()                            */
+/************************************************************************/
+
+static GIntBig OGRCompiledGetInteger( const OGRCompiledOperand& oOperand,
+                                      OGRFeature* poFeature )
+{
+    if( oOperand.iField < 0 )
+        return oOperand.nValue;
+    if( oOperand.eType == SWQ_INTEGER64 )
+        return poFeature->GetFieldAsInteger64(oOperand.iField);
+    return poFeature->GetFieldAsInteger(oOperand.iField);
+}
+
+static double OGRCompiledGetReal( const OGRCompiledOperand& oOperand,
+                                  OGRFeature* poFeature )
+{
+    if( oOperand.eType == SWQ_FLOAT )
+    {
+        return oOperand.iField < 0 ? oOperand.dfValue :
+            poFeature->GetFieldAsDouble(oOperand.iField);
+    }
+    return static_cast<double>(OGRCompiledGetInteger(oOperand, poFeature));
+}
+
+static const char* OGRCompiledGetString( const OGRCompiledOperand& oOperand,
+                                         OGRFeature* poFeature )
+{
+    if( oOperand.iField < 0 )
+        return oOperand.osValue.c_str();
+    return poFeature->GetFieldAsString(oOperand.iField);
+}
+
+/************************************************************************/
+/*                         EvaluateComparison()                         */
+/************************************************************************/
+
+bool OGRFeatureQueryCompiledExpr::EvaluateComparison(
+                const OGRCompiledNode& oNode, OGRFeature* poFeature ) const
+{
+    const auto& aoOperands = oNode.aoOperands;
+    const swq_op eOp = oNode.eOp;
+
+    if( eOp == SWQ_ISNULL )
+        return !poFeature->IsFieldSetAndNotNull(aoOperands[0].iField);
+
+    for( const auto& oOperand: aoOperands )
+    {
+        if( oOperand.iField >= 0 &&
+            !poFeature->IsFieldSetAndNotNull(oOperand.iField) )
+            return false;
+    }
+
+    const size_t nCount = aoOperands.size();
+    if( oNode.eKind == CNK_COMPARE_INTEGER )
+    {
+        const GIntBig nValue = OGRCompiledGetInteger(aoOperands[0], poFeature);
+        if( eOp == SWQ_IN )
+        {
+            for( size_t i = 1; i < nCount; i++ )
+            {
+                if( nValue == OGRCompiledGetInteger(aoOperands[i], poFeature) )
+                    return true;
+            }
+            return false;
+        }
+        if( eOp == SWQ_BETWEEN )
+        {
+            return nValue >= OGRCompiledGetInteger(aoOperands[1], poFeature) &&
+                   nValue <= OGRCompiledGetInteger(aoOperands[2], poFeature);
+        }
+        return OGRCompiledCompareValues(
+            eOp, nValue, OGRCompiledGetInteger(aoOperands[1], poFeature));
+    }
+
+    if( oNode.eKind == CNK_COMPARE_REAL )
+    {
+        const double dfValue = OGRCompiledGetReal(aoOperands[0], poFeature);
+        if( eOp == SWQ_IN )
+        {
+            for( size_t i = 1; i < nCount; i++ )
+            {
+                if( dfValue == OGRCompiledGetReal(aoOperands[i], poFeature) )
+                    return true;
+            }
+            return false;
+        }
+        if( eOp == SWQ_BETWEEN )
+        {
+            return dfValue >= OGRCompiledGetReal(aoOperands[1], poFeature) &&
+                   dfValue <= OGRCompiledGetReal(aoOperands[2], poFeature);
+        }
+        return OGRCompiledCompareValues(
+            eOp, dfValue, OGRCompiledGetReal(aoOperands[1], poFeature));
+    }
+
+    const char* pszValue = OGRCompiledGetString(aoOperands[0], poFeature);
+    if( eOp == SWQ_LIKE )
+    {
+        const char chEscape =
+            nCount == 3 ?
+            OGRCompiledGetString(aoOperands[2], poFeature)[0] : '\0';
+        return CPL_TO_BOOL(swq_test_like(
+            pszValue, OGRCompiledGetString(aoOperands[1], poFeature),
+            chEscape));
+    }
+    if( eOp == SWQ_IN )
+    {
+        for( size_t i = 1; i < nCount; i++ )
+        {
+            if( strcasecmp(pszValue,
+                           OGRCompiledGetString(aoOperands[i],
+                                                poFeature)) == 0 )
+                return true;
+        }
+        return false;
+    }
+    if( eOp == SWQ_BETWEEN )
+    {
+        return strcasecmp(pszValue,
+                          OGRCompiledGetString(aoOperands[1], poFeature)) >= 0 &&
+               strcasecmp(pszValue,
+                          OGRCompiledGetString(aoOperands[2], poFeature)) <= 0;
+    }
+    return OGRCompiledCompareStrings(
+        eOp, pszValue, OGRCompiledGetString(aoOperands[1], poFeature));
+}
+
+/************************************************************************/
+/*                   OGRFeatureQueryFreeCompiledExpr()                  */
+/************************************************************************/
+
+static void OGRFeatureQueryFreeCompiledExpr( void* pCompiledExpr )
+{
+    delete static_cast<OGRFeatureQueryCompiledExpr *>(pCompiledExpr);
+}
+
 /************************************************************************/
 /*                              Evaluate()                              */
 /************************************************************************/
@@ -333,6 +1064,23 @@ int OGRFeatureQuery::Evaluate( OGRFeature *poFeature )
     if( pSWQExpr == nullptr )
         return FALSE;
 
+    // Compiled on first use, as some drivers rewrite the expression tree
+    // after Compile().
+    if( !bCompiledExprTried )
+    {
+        bCompiledExprTried = true;
+        if( CPLTestBool(CPLGetConfigOption("OGR_SQL_COMPILE_WHERE", "YES")) )
+        {
+            pCompiledExpr = OGRFeatureQueryCompiledExpr::Compile(
+                static_cast<swq_expr_node *>(pSWQExpr), poTargetDefn);
+        }
+    }
+    if( pCompiledExpr != nullptr && poFeature->GetDefnRef() == poTargetDefn )
+    {
+        return static_cast<OGRFeatureQueryCompiledExpr *>(pCompiledExpr)->
+            Evaluate(poFeature);
+    }
+
     swq_expr_node *poResult =
         static_cast<swq_expr_node *>(pSWQExpr)->
             Evaluate(OGRFeatureFetcher, poFeature);
@@ -351,6 +1099,243 @@ int OGRFeatureQuery::Evaluate( OGRFeature *poFeature )
     return bLogicalResult;
 }
 
+/************************************************************************/
+/*                          OGRGetIndexKey()                            */
+/*                                                                      */
+/*      Convert the constant of an equality test to the key of an       */
+/*      index on a field.                                               */
+/************************************************************************/
+
+static bool OGRGetIndexKey( OGRFieldDefn *poFieldDefn,
+                            swq_expr_node *poValue, OGRField& sValue )
+{
+    if( poValue->eNodeType != SNT_CONSTANT || poValue->is_null )
+        return false;
+
+    switch( poFieldDefn->GetType() )
+    {
+      case OFTInteger:
+        if( poValue->field_type == SWQ_FLOAT )
+            sValue.Integer = static_cast<int>(poValue->float_value);
+        else
+            sValue.Integer = static_cast<int>(poValue->int_value);
+        return true;
+
+      case OFTInteger64:
+        if( poValue->field_type == SWQ_FLOAT )
+            sValue.Integer64 = static_cast<GIntBig>(poValue->float_value);
+        else
+            sValue.Integer64 = poValue->int_value;
+        return true;
+
+      case OFTReal:
+        sValue.Real = poValue->float_value;
+        return true;
+
+      case OFTString:
+        sValue.String = poValue->string_value;
+        return sValue.String != nullptr;
+
+      case OFTDateTime:
+        return (poValue->field_type == SWQ_TIMESTAMP ||
+                poValue->field_type == SWQ_STRING) &&
+               poValue->string_value != nullptr &&
+               OGRParseDate(poValue->string_value, &sValue, 0);
+
+      default:
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                         OGRGetIndexBound()                           */
+/*                                                                      */
+/*      Convert the constant of a range test to a bound of an index     */
+/*      on a field.  The bound may be widened, as the features          */
+/*      returned by the index are evaluated against the expression      */
+/*      afterwards.                                                     */
+/************************************************************************/
+
+static bool OGRGetIndexBound( OGRFieldDefn *poFieldDefn,
+                              swq_expr_node *poValue, bool bLower,
+                              OGRField& sValue, bool& bIncluded )
+{
+    if( poValue->eNodeType != SNT_CONSTANT || poValue->is_null )
+        return false;
+
+    const bool bNumeric = poValue->field_type == SWQ_INTEGER ||
+                          poValue->field_type == SWQ_INTEGER64 ||
+                          poValue->field_type == SWQ_BOOLEAN ||
+                          poValue->field_type == SWQ_FLOAT;
+
+    switch( poFieldDefn->GetType() )
+    {
+      case OFTInteger:
+      case OFTInteger64:
+      {
+        if( !bNumeric )
+            return false;
+        GIntBig nValue = poValue->int_value;
+        if( poValue->field_type == SWQ_FLOAT )
+        {
+            const double dfValue = bLower ? ceil(poValue->float_value) :
+                                            floor(poValue->float_value);
+            if( CPLIsNan(dfValue) || dfValue < -9.0e18 || dfValue > 9.0e18 )
+                return false;
+            if( dfValue != poValue->float_value )
+                bIncluded = true;
+            nValue = static_cast<GIntBig>(dfValue);
+        }
+        if( poFieldDefn->GetType() == OFTInteger64 )
+        {
+            sValue.Integer64 = nValue;
+            return true;
+        }
+        if( nValue < INT_MIN || nValue > INT_MAX )
+        {
+            bIncluded = true;
+            nValue = std::max(static_cast<GIntBig>(INT_MIN),
+                              std::min(static_cast<GIntBig>(INT_MAX), nValue));
+        }
+        sValue.Integer = static_cast<int>(nValue);
+        return true;
+      }
+
+      case OFTReal:
+        if( !bNumeric )
+            return false;
+        sValue.Real = poValue->field_type == SWQ_FLOAT ?
+            poValue->float_value : static_cast<double>(poValue->int_value);
+        return !CPLIsNan(sValue.Real);
+
+      case OFTString:
+        if( poValue->field_type != SWQ_STRING )
+            return false;
+        sValue.String = poValue->string_value;
+        return sValue.String != nullptr;
+
+      case OFTDateTime:
+        return OGRGetIndexKey( poFieldDefn, poValue, sValue );
+
+      default:
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                       OGRGetRangeQueryIndex()                        */
+/*                                                                      */
+/*      Return the index that can evaluate a <, <=, >, >=, BETWEEN or   */
+/*      LIKE 'prefix%' test, and the bounds or prefix to query it       */
+/*      with, or NULL.                                                  */
+/************************************************************************/
+
+static OGRAttrIndex *OGRGetRangeQueryIndex( swq_expr_node *psExpr,
+                                            OGRLayer *poLayer,
+                                            OGRField *psMin,
+                                            bool& bHasMin, bool& bMinIncluded,
+                                            OGRField *psMax,
+                                            bool& bHasMax, bool& bMaxIncluded,
+                                            CPLString& osPrefix )
+{
+    bHasMin = false;
+    bHasMax = false;
+    bMinIncluded = false;
+    bMaxIncluded = false;
+
+    const int nOperation = psExpr->nOperation;
+    if( !( ((nOperation == SWQ_GT || nOperation == SWQ_GE ||
+             nOperation == SWQ_LT || nOperation == SWQ_LE) &&
+            psExpr->nSubExprCount == 2) ||
+           (nOperation == SWQ_BETWEEN && psExpr->nSubExprCount == 3) ||
+           (nOperation == SWQ_LIKE && (psExpr->nSubExprCount == 2 ||
+                                       psExpr->nSubExprCount == 3)) ) )
+        return nullptr;
+
+    swq_expr_node *poColumn = psExpr->papoSubExpr[0];
+    if( poColumn->eNodeType != SNT_COLUMN )
+        return nullptr;
+
+    for( int i = 1; i < psExpr->nSubExprCount; i++ )
+    {
+        if( psExpr->papoSubExpr[i]->eNodeType != SNT_CONSTANT )
+            return nullptr;
+    }
+
+    const int nIdx = OGRFeatureFetcherFixFieldIndex(
+        poLayer->GetLayerDefn(), poColumn->field_index);
+    if( nIdx < 0 || nIdx >= poLayer->GetLayerDefn()->GetFieldCount() )
+        return nullptr;
+
+    OGRAttrIndex *poIndex = poLayer->GetIndex()->GetFieldIndex(nIdx);
+    if( poIndex == nullptr || !poIndex->SupportsRangeQueries() )
+        return nullptr;
+
+    OGRFieldDefn *poFieldDefn = poLayer->GetLayerDefn()->GetFieldDefn(nIdx);
+
+    if( nOperation == SWQ_LIKE )
+    {
+        // Only the part of the pattern before the first wildcard can be
+        // looked up.
+        swq_expr_node *poPattern = psExpr->papoSubExpr[1];
+        if( poFieldDefn->GetType() != OFTString ||
+            poPattern->field_type != SWQ_STRING || poPattern->is_null ||
+            poPattern->string_value == nullptr )
+            return nullptr;
+
+        char chEscape = '\0';
+        if( psExpr->nSubExprCount == 3 )
+        {
+            swq_expr_node *poEscape = psExpr->papoSubExpr[2];
+            if( poEscape->field_type != SWQ_STRING || poEscape->is_null ||
+                poEscape->string_value == nullptr )
+                return nullptr;
+            chEscape = poEscape->string_value[0];
+        }
+
+        osPrefix.clear();
+        for( const char *pszIter = poPattern->string_value;
+             *pszIter != '\0'; pszIter++ )
+        {
+            if( chEscape != '\0' && *pszIter == chEscape )
+            {
+                pszIter++;
+                if( *pszIter == '\0' )
+                    break;
+            }
+            else if( *pszIter == '%' || *pszIter == '_' )
+            {
+                break;
+            }
+            osPrefix += *pszIter;
+        }
+        return osPrefix.empty() ? nullptr : poIndex;
+    }
+
+    if( nOperation == SWQ_GT || nOperation == SWQ_GE ||
+        nOperation == SWQ_BETWEEN )
+    {
+        bMinIncluded = nOperation != SWQ_GT;
+        if( !OGRGetIndexBound( poFieldDefn, psExpr->papoSubExpr[1], true,
+                               *psMin, bMinIncluded ) )
+            return nullptr;
+        bHasMin = true;
+    }
+
+    if( nOperation == SWQ_LT || nOperation == SWQ_LE ||
+        nOperation == SWQ_BETWEEN )
+    {
+        bMaxIncluded = nOperation != SWQ_LT;
+        if( !OGRGetIndexBound( poFieldDefn,
+                               psExpr->papoSubExpr[psExpr->nSubExprCount - 1],
+                               false, *psMax, bMaxIncluded ) )
+            return nullptr;
+        bHasMax = true;
+    }
+
+    return poIndex;
+}
+
 /************************************************************************/
 /*                            CanUseIndex()                             */
 /************************************************************************/
@@ -380,6 +1365,22 @@ int OGRFeatureQuery::CanUseIndex( swq_expr_node *psExpr,
                CanUseIndex(psExpr->papoSubExpr[1], poLayer);
     }
 
+    // Range and prefix tests.
+    {
+        OGRField sMin;
+        OGRField sMax;
+        bool bHasMin = false;
+        bool bHasMax = false;
+        bool bMinIncluded = false;
+        bool bMaxIncluded = false;
+        CPLString osPrefix;
+        if( OGRGetRangeQueryIndex(psExpr, poLayer,
+                                  &sMin, bHasMin, bMinIncluded,
+                                  &sMax, bHasMax, bMaxIncluded,
+                                  osPrefix) != nullptr )
+            return TRUE;
+    }
+
     if( !(psExpr->nOperation == SWQ_EQ || psExpr->nOperation == SWQ_IN)
         || psExpr->nSubExprCount < 2 )
         return FALSE;
@@ -391,14 +1392,21 @@ int OGRFeatureQuery::CanUseIndex( swq_expr_node *psExpr,
         || poValue->eNodeType != SNT_CONSTANT )
         return FALSE;
 
-    OGRAttrIndex *poIndex =
-        poLayer->GetIndex()->GetFieldIndex(
-            OGRFeatureFetcherFixFieldIndex(poLayer->GetLayerDefn(),
-                                           poColumn->field_index));
+    const int nIdx = OGRFeatureFetcherFixFieldIndex(
+        poLayer->GetLayerDefn(), poColumn->field_index);
+    OGRAttrIndex *poIndex = poLayer->GetIndex()->GetFieldIndex(nIdx);
     if( poIndex == nullptr )
         return FALSE;
 
-    // Have an index.
+    // Have an index, check that the values can be looked up in it.
+    OGRFieldDefn *poFieldDefn = poLayer->GetLayerDefn()->GetFieldDefn(nIdx);
+    for( int i = 1; i < psExpr->nSubExprCount; i++ )
+    {
+        OGRField sValue;
+        if( !OGRGetIndexKey(poFieldDefn, psExpr->papoSubExpr[i], sValue) )
+            return FALSE;
+    }
+
     return TRUE;
 }
 
@@ -411,9 +1419,9 @@ int OGRFeatureQuery::CanUseIndex( swq_expr_node *psExpr,
 /*      available indices, or an "OGRNullFID" terminated list of        */
 /*      FIDs if it can.                                                 */
 /*                                                                      */
-/*      For now we only support equality tests on a single indexed      */
-/*      attribute field.  Eventually we should make this support        */
-/*      multi-part queries with ranges.                                 */
+/*      Equality, IN tests and, with indices that support it, range     */
+/*      and LIKE 'prefix%' tests on indexed attribute fields can be     */
+/*      combined with AND and OR.                                       */
 /************************************************************************/
 
 static int CompareGIntBig( const void *pa, const void *pb )
@@ -604,6 +1612,33 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
         return panFIDList;
     }
 
+    // Range and prefix tests.
+    {
+        OGRField sMin;
+        OGRField sMax;
+        bool bHasMin = false;
+        bool bHasMax = false;
+        bool bMinIncluded = false;
+        bool bMaxIncluded = false;
+        CPLString osPrefix;
+        OGRAttrIndex *poIndex =
+            OGRGetRangeQueryIndex(psExpr, poLayer,
+                                  &sMin, bHasMin, bMinIncluded,
+                                  &sMax, bHasMax, bMaxIncluded,
+                                  osPrefix);
+        if( poIndex != nullptr )
+        {
+            nFIDCount = 0;
+            if( psExpr->nOperation == SWQ_LIKE )
+                return poIndex->GetPrefixMatches(osPrefix, &nFIDCount);
+            return poIndex->GetRangeMatches(bHasMin ? &sMin : nullptr,
+                                            bMinIncluded,
+                                            bHasMax ? &sMax : nullptr,
+                                            bMaxIncluded,
+                                            &nFIDCount);
+        }
+    }
+
     if( !(psExpr->nOperation == SWQ_EQ || psExpr->nOperation == SWQ_IN)
         || psExpr->nSubExprCount < 2 )
         return nullptr;
@@ -637,82 +1672,37 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
 
         for( int iIN = 1; iIN < psExpr->nSubExprCount; iIN++ )
         {
-            switch( poFieldDefn->GetType() )
+            if( !OGRGetIndexKey(poFieldDefn, psExpr->papoSubExpr[iIN],
+                                sValue) )
             {
-              case OFTInteger:
-                if( psExpr->papoSubExpr[iIN]->field_type == SWQ_FLOAT )
-                    sValue.Integer =
-                        static_cast<int>(psExpr->papoSubExpr[iIN]->float_value);
-                else
-                    sValue.Integer =
-                        static_cast<int>(psExpr->papoSubExpr[iIN]->int_value);
-                break;
-
-              case OFTInteger64:
-                if( psExpr->papoSubExpr[iIN]->field_type == SWQ_FLOAT )
-                    sValue.Integer64 = static_cast<GIntBig>(
-                        psExpr->papoSubExpr[iIN]->float_value);
-                else
-                    sValue.Integer64 = psExpr->papoSubExpr[iIN]->int_value;
-                break;
-
-              case OFTReal:
-                sValue.Real = psExpr->papoSubExpr[iIN]->float_value;
-                break;
-
-              case OFTString:
-                sValue.String = psExpr->papoSubExpr[iIN]->string_value;
-                break;
-
-              default:
-                CPLAssert(false);
+                CPLFree(panFIDs);
                 return nullptr;
             }
 
             int nFIDCount32 = static_cast<int>(nFIDCount);
             panFIDs = poIndex->GetAllMatches(&sValue, panFIDs,
                                              &nFIDCount32, &nLength);
+            if( panFIDs == nullptr )
+                return nullptr;
             nFIDCount = nFIDCount32;
         }
 
         if( nFIDCount > 1 )
         {
-            // The returned FIDs are expected to be in sorted order.
+            // The returned FIDs are expected to be in sorted order, and
+            // case insensitive string values may have matched the same
+            // features.
             qsort(panFIDs, static_cast<size_t>(nFIDCount),
                   sizeof(GIntBig), CompareGIntBig);
+            nFIDCount = std::unique(panFIDs, panFIDs + nFIDCount) - panFIDs;
+            panFIDs[nFIDCount] = OGRNullFID;
         }
         return panFIDs;
     }
 
     // Handle equality test.
-    switch( poFieldDefn->GetType() )
-    {
-      case OFTInteger:
-        if( poValue->field_type == SWQ_FLOAT )
-            sValue.Integer = static_cast<int>(poValue->float_value);
-        else
-            sValue.Integer = static_cast<int>(poValue->int_value);
-        break;
-
-      case OFTInteger64:
-        if( poValue->field_type == SWQ_FLOAT )
-            sValue.Integer64 = static_cast<GIntBig>(poValue->float_value);
-        else
-            sValue.Integer64 = poValue->int_value;
-        break;
-
-      case OFTReal:
-        sValue.Real = poValue->float_value;
-        break;
-
-      case OFTString:
-        sValue.String = poValue->string_value;
-        break;
-
-      default:
-        CPLAssert(false);
+    if( !OGRGetIndexKey(poFieldDefn, poValue, sValue) )
         return nullptr;
-    }
 
     int nLength = 0;
     int nFIDCount32 = 0;
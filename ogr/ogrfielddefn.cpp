@@ -30,6 +30,7 @@
 #include "cpl_port.h"
 #include "ogr_feature.h"
 
+#include <atomic>
 #include <cstring>
 
 #include "ogr_api.h"
@@ -154,6 +155,8 @@ void OGR_Fld_Destroy( OGRFieldDefnH hDefn )
  * @param pszNameIn the new name to apply.
  */
 
+static std::atomic<unsigned> gnNameGeneration(0);
+
 void OGRFieldDefn::SetName( const char * pszNameIn )
 
 {
@@ -161,9 +164,18 @@ void OGRFieldDefn::SetName( const char * pszNameIn )
     {
         CPLFree(pszName);
         pszName = CPLStrdup(pszNameIn);
+        // Invalidates the field index of the feature definitions.
+        ++gnNameGeneration;
     }
 }
 
+//! @cond Doxygen_Suppress
+unsigned OGRFieldDefnGetNameGeneration()
+{
+    return gnNameGeneration;
+}
+//! @endcond
+
 /************************************************************************/
 /*                          OGR_Fld_SetName()                           */
 /************************************************************************/
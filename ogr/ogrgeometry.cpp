@@ -2979,6 +2979,24 @@ GEOSGeom OGRGeometry::exportToGEOS(
         return GEOSGeomFromWKT_r(hGEOSCtxt, "POINT EMPTY");
     }
 
+    // Build points directly from their coordinates, without going through
+    // WKB, as this is the most frequent case when filtering layers against
+    // a prepared geometry.
+    if( eType == wkbPoint )
+    {
+        const OGRPoint* poPoint = toPoint();
+        const unsigned int nDim = poPoint->Is3D() ? 3 : 2;
+        GEOSCoordSequence* hSeq = GEOSCoordSeq_create_r(hGEOSCtxt, 1, nDim);
+        if( hSeq == nullptr )
+            return nullptr;
+        GEOSCoordSeq_setX_r(hGEOSCtxt, hSeq, 0, poPoint->getX());
+        GEOSCoordSeq_setY_r(hGEOSCtxt, hSeq, 0, poPoint->getY());
+        if( nDim == 3 )
+            GEOSCoordSeq_setZ_r(hGEOSCtxt, hSeq, 0, poPoint->getZ());
+        // Takes ownership of the sequence, even on failure.
+        return GEOSGeom_createPoint_r(hGEOSCtxt, hSeq);
+    }
+
     GEOSGeom hGeom = nullptr;
 
     OGRGeometry* poLinearGeom = nullptr;
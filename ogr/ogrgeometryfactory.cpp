@@ -32,7 +32,9 @@
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_quad_tree.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_geometry.h"
 #include "ogr_api.h"
 #include "ogr_core.h"
@@ -53,7 +55,9 @@
 #include <cstddef>
 
 #include <algorithm>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <new>
 #include <utility>
 #include <vector>
@@ -1356,6 +1360,244 @@ enum OrganizePolygonMethod
    METHOD_CCW_INNER_JUST_AFTER_CW_OUTER
 };
 
+// Returns whether polygon sI is inside polygon sJ, of rank j once sorted by
+// decreasing area.
+static bool OGRGeometryFactoryIsInside( const sPolyExtended& sI,
+                                        const sPolyExtended& sJ,
+                                        int j,
+                                        OrganizePolygonMethod method,
+                                        bool bUseFastVersion )
+{
+    bool b_i_inside_j = false;
+
+    if( sJ.sEnvelope.Contains(sI.sEnvelope) )
+    {
+        if( bUseFastVersion )
+        {
+            if( method == METHOD_ONLY_CCW && j == 0 )
+            {
+                // We are testing if a CCW ring is in the biggest CW
+                // ring It *must* be inside as this is the last
+                // candidate, otherwise the winding order rules is
+                // broken.
+                b_i_inside_j = true;
+            }
+            else if( sI.bIsPolygon &&
+                     sJ.bIsPolygon &&
+                     sJ.poExteriorRing->toLinearRing()->
+                             isPointOnRingBoundary(&sI.poAPoint, FALSE) )
+            {
+                OGRLinearRing* poLR_i = sI.poExteriorRing->toLinearRing();
+                OGRLinearRing* poLR_j = sJ.poExteriorRing->toLinearRing();
+
+                // If the point of i is on the boundary of j, we will
+                // iterate over the other points of i.
+                const int nPoints = poLR_i->getNumPoints();
+                int k = 1;  // Used after for.
+                OGRPoint previousPoint = sI.poAPoint;
+                for( ; k < nPoints; k++ )
+                {
+                    OGRPoint point;
+                    poLR_i->getPoint(k, &point);
+                    if( point.getX() == previousPoint.getX() &&
+                        point.getY() == previousPoint.getY() )
+                    {
+                        continue;
+                    }
+                    if( poLR_j->isPointOnRingBoundary(&point, FALSE) )
+                    {
+                        // If it is on the boundary of j, iterate again.
+                    }
+                    else if( poLR_j->isPointInRing(&point, FALSE) )
+                    {
+                        // If then point is strictly included in j, then
+                        // i is considered inside j.
+                        b_i_inside_j = true;
+                        break;
+                    }
+                    else
+                    {
+                        // If it is outside, then i cannot be inside j.
+                        break;
+                    }
+                    previousPoint = point;
+                }
+                if( !b_i_inside_j && k == nPoints && nPoints > 2 )
+                {
+                    // All points of i are on the boundary of j.
+                    // Take a point in the middle of a segment of i and
+                    // test it against j.
+                    poLR_i->getPoint(0, &previousPoint);
+                    for( k = 1; k < nPoints; k++ )
+                    {
+                        OGRPoint point;
+                        poLR_i->getPoint(k, &point);
+                        if( point.getX() == previousPoint.getX() &&
+                            point.getY() == previousPoint.getY() )
+                        {
+                            continue;
+                        }
+                        OGRPoint pointMiddle;
+                        pointMiddle.setX((point.getX() +
+                                          previousPoint.getX()) / 2);
+                        pointMiddle.setY((point.getY() +
+                                          previousPoint.getY()) / 2);
+                        if( poLR_j->isPointOnRingBoundary(&pointMiddle,
+                                                          FALSE) )
+                        {
+                            // If it is on the boundary of j, iterate
+                            // again.
+                        }
+                        else if( poLR_j->isPointInRing(&pointMiddle,
+                                                       FALSE) )
+                        {
+                            // If then point is strictly included in j,
+                            // then i is considered inside j.
+                            b_i_inside_j = true;
+                            break;
+                        }
+                        else
+                        {
+                            // If it is outside, then i cannot be inside
+                            // j.
+                            break;
+                        }
+                        previousPoint = point;
+                    }
+                }
+            }
+            // Note that isPointInRing only test strict inclusion in the
+            // ring.
+            else if( sI.bIsPolygon &&
+                     sJ.bIsPolygon &&
+                     sJ.poExteriorRing->toLinearRing()->
+                             isPointInRing(&sI.poAPoint, FALSE) )
+            {
+                b_i_inside_j = true;
+            }
+        }
+        else if( sJ.poPolygon->Contains(sI.poPolygon) )
+        {
+            b_i_inside_j = true;
+        }
+    }
+
+    return b_i_inside_j;
+}
+
+static void OGRGeometryFactoryGetEnvelope( const void* hFeature,
+                                           CPLRectObj* pBounds )
+{
+    const OGREnvelope& sEnvelope =
+        static_cast<const sPolyExtended*>(hFeature)->sEnvelope;
+    pBounds->minx = sEnvelope.MinX;
+    pBounds->miny = sEnvelope.MinY;
+    pBounds->maxx = sEnvelope.MaxX;
+    pBounds->maxy = sEnvelope.MaxY;
+}
+
+// Returns the rank of the smallest polygon enclosing polygon i, among the
+// polygons of rank [i-1 ... 0] of asPolyEx (sorted by decreasing area), or -1.
+// The candidates are the polygons of hTree whose envelope intersects the one
+// of i, tested in the same order as an exhaustive search would do.
+// *pbValidTopology is set to false if a polygon overlapping polygon i is met
+// before its enclosing polygon (only checked when !bUseFastVersion).
+static int OGRGeometryFactoryFindEnclosing( const sPolyExtended* asPolyEx,
+                                            int i,
+                                            CPLQuadTree* hTree,
+                                            OrganizePolygonMethod method,
+                                            bool bUseFastVersion,
+                                            bool* pbValidTopology )
+{
+    const sPolyExtended& sI = asPolyEx[i];
+    CPLRectObj sAoi;
+    OGRGeometryFactoryGetEnvelope(&sI, &sAoi);
+    int nHits = 0;
+    void** pahHits = CPLQuadTreeSearch(hTree, &sAoi, &nHits);
+    std::vector<int> anCandidates;
+    anCandidates.reserve(nHits);
+    for( int k = 0; k < nHits; k++ )
+    {
+        const int j = static_cast<int>(
+            static_cast<const sPolyExtended*>(pahHits[k]) - asPolyEx);
+        if( j < i )
+            anCandidates.push_back(j);
+    }
+    CPLFree(pahHits);
+    std::sort(anCandidates.begin(), anCandidates.end(), std::greater<int>());
+
+    for( const int j: anCandidates )
+    {
+        const sPolyExtended& sJ = asPolyEx[j];
+        if( method == METHOD_ONLY_CCW && sJ.bIsCW == false )
+        {
+            // In that mode, i which is CCW if we reach here can only be
+            // included in a CW polygon.
+            continue;
+        }
+
+        if( OGRGeometryFactoryIsInside(sI, sJ, j, method, bUseFastVersion) )
+            return j;
+
+        // Use Overlaps instead of Intersects to be more
+        // tolerant about touching polygons.
+        if( !bUseFastVersion &&
+            sI.sEnvelope.Intersects(sJ.sEnvelope) &&
+            sI.poPolygon->Overlaps(sJ.poPolygon) )
+        {
+            // Bad... The polygons are intersecting but no one is
+            // contained inside the other one. This is a really broken
+            // case. We just make a multipolygon with the whole set of
+            // polygons.
+            *pbValidTopology = false;
+#ifdef DEBUG
+            char* wkt1 = nullptr;
+            char* wkt2 = nullptr;
+            sI.poPolygon->exportToWkt(&wkt1);
+            sJ.poPolygon->exportToWkt(&wkt2);
+            CPLDebug( "OGR",
+                      "Bad intersection for polygons %d and %d\n"
+                      "geom %d: %s\n"
+                      "geom %d: %s",
+                      i, j, i, wkt1, j, wkt2 );
+            CPLFree(wkt1);
+            CPLFree(wkt2);
+#endif
+            return -1;
+        }
+    }
+    return -1;
+}
+
+namespace {
+struct OGROrganizePolygonsJob
+{
+    const sPolyExtended* asPolyEx = nullptr;
+    int                  iStart = 0;
+    int                  iEnd = 0;
+    CPLQuadTree*         hTree = nullptr;
+    OrganizePolygonMethod method = METHOD_NORMAL;
+    int*                 panEnclosing = nullptr;
+};
+} // namespace
+
+static void OGROrganizePolygonsJobFunc( void* pData )
+{
+    // Only used with the fast version, which cannot invalidate the topology
+    // nor emit errors.
+    const OGROrganizePolygonsJob* psJob =
+        static_cast<const OGROrganizePolygonsJob*>(pData);
+    bool bValidTopology = true;
+    for( int i = psJob->iStart; i < psJob->iEnd; i++ )
+    {
+        if( psJob->method == METHOD_ONLY_CCW && psJob->asPolyEx[i].bIsCW )
+            continue;
+        psJob->panEnclosing[i] = OGRGeometryFactoryFindEnclosing(
+            psJob->asPolyEx, i, psJob->hTree, psJob->method, true,
+            &bValidTopology);
+    }
+}
+
 /**
  * \brief Organize polygons based on geometries.
  *
@@ -1395,6 +1637,12 @@ enum OrganizePolygonMethod
  * the value of the METHOD option of papszOptions (useful to modify the behaviour of the
  * shapefile driver)
  *
+ * Starting with GDAL 3.1, the NUM_THREADS=number_of_threads/ALL_CPUS option
+ * (defaulting to the GDAL_NUM_THREADS configuration option, or 1) can be set to
+ * spread the ring inclusion tests over several threads. This is only used
+ * with more than a thousand polygons, and not in OGR_DEBUG_ORGANIZE_POLYGONS
+ * mode.
+ *
  * @param papoPolygons array of geometry pointers - should all be OGRPolygons.
  * Ownership of the geometries is passed, but not of the array itself.
  * @param nPolygonCount number of items in papoPolygons
@@ -1692,7 +1940,10 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
           outer ring
        5) Add the top-level polygons to the multipolygon
 
-       Complexity : O(nPolygonCount^2)
+       The candidate enclosing polygons of step 2 are fetched from a quad
+       tree of the envelopes, so only polygons whose envelopes intersect are
+       compared, which makes the usual cases O(nPolygonCount *
+       log(nPolygonCount)). Deeply nested rings remain quadratic.
     */
 
     /* Compute how each polygon relate to the other ones
@@ -1730,201 +1981,97 @@ OGRGeometry* OGRGeometryFactory::organizePolygons( OGRGeometry **papoPolygons,
 
     int nCountTopLevel = 1;
 
-    // STEP 2.
-    for( int i = 1;
-         !bMixedUpGeometries && bValidTopology && i<nPolygonCount;
-         i++ )
+    // STEP 2: Find the enclosing polygon of each polygon.
+    // anEnclosing[i] is the rank of the smallest polygon enclosing polygon
+    // i, or -1 if there is none.
+    std::vector<int> anEnclosing;
+    if( !bMixedUpGeometries )
     {
-        if( method == METHOD_ONLY_CCW && asPolyEx[i].bIsCW )
+        anEnclosing.resize(nPolygonCount, -1);
+
+        OGREnvelope sGlobalEnvelope;
+        for( int i = 0; i < nPolygonCount; i++ )
+            sGlobalEnvelope.Merge(asPolyEx[i].sEnvelope);
+        CPLRectObj sGlobalBounds;
+        sGlobalBounds.minx = sGlobalEnvelope.MinX;
+        sGlobalBounds.miny = sGlobalEnvelope.MinY;
+        sGlobalBounds.maxx = sGlobalEnvelope.MaxX;
+        sGlobalBounds.maxy = sGlobalEnvelope.MaxY;
+        CPLQuadTree* hTree = CPLQuadTreeCreate(&sGlobalBounds,
+                                               OGRGeometryFactoryGetEnvelope);
+        for( int i = 0; i < nPolygonCount; i++ )
+            CPLQuadTreeInsert(hTree, &asPolyEx[i]);
+
+        // The fast version only does read-only computations on the rings,
+        // so polygons can be dispatched to several threads.
+        int nThreads = 1;
+        if( bUseFastVersion )
         {
-            nCountTopLevel++;
-            asPolyEx[i].bIsTopLevel = true;
-            asPolyEx[i].poEnclosingPolygon = nullptr;
-            continue;
+            nThreads = CPLGetNumThreads(papszOptions);
+            // Not worth the overhead for a few polygons.
+            constexpr int MIN_POLYGONS_PER_THREAD = 1000;
+            nThreads = std::max(1, std::min(nThreads,
+                                    nPolygonCount / MIN_POLYGONS_PER_THREAD));
         }
 
-        int j = i - 1;  // Used after for.
-        for( ; bValidTopology && j >= 0; j-- )
+        CPLWorkerThreadPool* poPool =
+            nThreads > 1 ? CPLGetGlobalWorkerThreadPool(nThreads) : nullptr;
+        if( poPool )
         {
-            bool b_i_inside_j = false;
-
-            if( method == METHOD_ONLY_CCW && asPolyEx[j].bIsCW == false )
+            auto poJobQueue = poPool->CreateJobQueue();
+            // Use more jobs than threads to balance the load, as the bigger
+            // polygons, which come first, tend to have more candidates.
+            std::vector<OGROrganizePolygonsJob> asJobs(nThreads * 16);
+            const int nJobs = static_cast<int>(asJobs.size());
+            for( int iJob = 0; iJob < nJobs; iJob++ )
             {
-                // In that mode, i which is CCW if we reach here can only be
-                // included in a CW polygon.
-                continue;
+                auto& sJob = asJobs[iJob];
+                sJob.asPolyEx = asPolyEx;
+                sJob.iStart = static_cast<int>(
+                    static_cast<GIntBig>(nPolygonCount) * iJob / nJobs);
+                sJob.iEnd = static_cast<int>(
+                    static_cast<GIntBig>(nPolygonCount) * (iJob + 1) / nJobs);
+                sJob.hTree = hTree;
+                sJob.method = method;
+                sJob.panEnclosing = &anEnclosing[0];
+                if( !poJobQueue->SubmitJob(OGROrganizePolygonsJobFunc, &sJob) )
+                    OGROrganizePolygonsJobFunc(&sJob);
             }
-
-            if( asPolyEx[j].sEnvelope.Contains(asPolyEx[i].sEnvelope) )
+            poJobQueue->WaitCompletion();
+        }
+        else
+        {
+            for( int i = 1; bValidTopology && i < nPolygonCount; i++ )
             {
-                if( bUseFastVersion )
-                {
-                    if( method == METHOD_ONLY_CCW && j == 0 )
-                    {
-                        // We are testing if a CCW ring is in the biggest CW
-                        // ring It *must* be inside as this is the last
-                        // candidate, otherwise the winding order rules is
-                        // broken.
-                        b_i_inside_j = true;
-                    }
-                    else if( asPolyEx[i].bIsPolygon &&
-                             asPolyEx[j].bIsPolygon &&
-                             asPolyEx[j].poExteriorRing->toLinearRing()->
-                                     isPointOnRingBoundary(
-                                         &asPolyEx[i].poAPoint, FALSE) )
-                    {
-                        OGRLinearRing* poLR_i =
-                            asPolyEx[i].poExteriorRing->toLinearRing();
-                        OGRLinearRing* poLR_j =
-                            asPolyEx[j].poExteriorRing->toLinearRing();
-
-                        // If the point of i is on the boundary of j, we will
-                        // iterate over the other points of i.
-                        const int nPoints = poLR_i->getNumPoints();
-                        int k = 1;  // Used after for.
-                        OGRPoint previousPoint = asPolyEx[i].poAPoint;
-                        for( ; k < nPoints; k++ )
-                        {
-                            OGRPoint point;
-                            poLR_i->getPoint(k, &point);
-                            if( point.getX() == previousPoint.getX() &&
-                                point.getY() == previousPoint.getY() )
-                            {
-                                continue;
-                            }
-                            if( poLR_j->isPointOnRingBoundary(&point, FALSE) )
-                            {
-                                // If it is on the boundary of j, iterate again.
-                            }
-                            else if( poLR_j->isPointInRing(&point, FALSE) )
-                            {
-                                // If then point is strictly included in j, then
-                                // i is considered inside j.
-                                b_i_inside_j = true;
-                                break;
-                            }
-                            else
-                            {
-                                // If it is outside, then i cannot be inside j.
-                                break;
-                            }
-                            previousPoint = point;
-                        }
-                        if( !b_i_inside_j && k == nPoints && nPoints > 2 )
-                        {
-                            // All points of i are on the boundary of j.
-                            // Take a point in the middle of a segment of i and
-                            // test it against j.
-                            poLR_i->getPoint(0, &previousPoint);
-                            for( k = 1; k < nPoints; k++ )
-                            {
-                                OGRPoint point;
-                                poLR_i->getPoint(k, &point);
-                                if( point.getX() == previousPoint.getX() &&
-                                    point.getY() == previousPoint.getY() )
-                                {
-                                    continue;
-                                }
-                                OGRPoint pointMiddle;
-                                pointMiddle.setX((point.getX() +
-                                                  previousPoint.getX()) / 2);
-                                pointMiddle.setY((point.getY() +
-                                                  previousPoint.getY()) / 2);
-                                if( poLR_j->isPointOnRingBoundary(&pointMiddle,
-                                                                  FALSE) )
-                                {
-                                    // If it is on the boundary of j, iterate
-                                    // again.
-                                }
-                                else if( poLR_j->isPointInRing(&pointMiddle,
-                                                               FALSE) )
-                                {
-                                    // If then point is strictly included in j,
-                                    // then i is considered inside j.
-                                    b_i_inside_j = true;
-                                    break;
-                                }
-                                else
-                                {
-                                    // If it is outside, then i cannot be inside
-                                    // j.
-                                    break;
-                                }
-                                previousPoint = point;
-                            }
-                        }
-                    }
-                    // Note that isPointInRing only test strict inclusion in the
-                    // ring.
-                    else if( asPolyEx[i].bIsPolygon &&
-                             asPolyEx[j].bIsPolygon &&
-                             asPolyEx[j].poExteriorRing->toLinearRing()->
-                                     isPointInRing(&asPolyEx[i].poAPoint,
-                                                   FALSE) )
-                    {
-                        b_i_inside_j = true;
-                    }
-                }
-                else if( asPolyEx[j].poPolygon->
-                             Contains(asPolyEx[i].poPolygon) )
-                {
-                    b_i_inside_j = true;
-                }
+                if( method == METHOD_ONLY_CCW && asPolyEx[i].bIsCW )
+                    continue;
+                anEnclosing[i] = OGRGeometryFactoryFindEnclosing(
+                    asPolyEx, i, hTree, method, bUseFastVersion,
+                    &bValidTopology);
             }
+        }
 
-            if( b_i_inside_j )
-            {
-                if( asPolyEx[j].bIsTopLevel )
-                {
-                    // We are a lake.
-                    asPolyEx[i].bIsTopLevel = false;
-                    asPolyEx[i].poEnclosingPolygon = asPolyEx[j].poPolygon;
-                }
-                else
-                {
-                    // We are included in a something not toplevel (a lake),
-                    // so in OGCSF we are considered as toplevel too.
-                    nCountTopLevel++;
-                    asPolyEx[i].bIsTopLevel = true;
-                    asPolyEx[i].poEnclosingPolygon = nullptr;
-                }
-                break;
-            }
-            // Use Overlaps instead of Intersects to be more
-            // tolerant about touching polygons.
-            else if( bUseFastVersion ||
-                     !asPolyEx[i].sEnvelope.Intersects(asPolyEx[j].sEnvelope) ||
-                     !asPolyEx[i].poPolygon->Overlaps(asPolyEx[j].poPolygon) )
-            {
+        CPLQuadTreeDestroy(hTree);
+    }
 
-            }
-            else
-            {
-                // Bad... The polygons are intersecting but no one is
-                // contained inside the other one. This is a really broken
-                // case. We just make a multipolygon with the whole set of
-                // polygons.
-                bValidTopology = false;
-#ifdef DEBUG
-                char* wkt1 = nullptr;
-                char* wkt2 = nullptr;
-                asPolyEx[i].poPolygon->exportToWkt(&wkt1);
-                asPolyEx[j].poPolygon->exportToWkt(&wkt2);
-                CPLDebug( "OGR",
-                          "Bad intersection for polygons %d and %d\n"
-                          "geom %d: %s\n"
-                          "geom %d: %s",
-                          i, j, i, wkt1, j, wkt2 );
-                CPLFree(wkt1);
-                CPLFree(wkt2);
-#endif
-            }
+    // STEP 2 bis: Deduce which polygons are top-level, in decreasing area
+    // order since this depends on the status of the enclosing polygon.
+    for( int i = 1;
+         !bMixedUpGeometries && bValidTopology && i < nPolygonCount;
+         i++ )
+    {
+        const int j = anEnclosing[i];
+        if( j >= 0 && asPolyEx[j].bIsTopLevel )
+        {
+            // We are a lake.
+            asPolyEx[i].bIsTopLevel = false;
+            asPolyEx[i].poEnclosingPolygon = asPolyEx[j].poPolygon;
         }
-
-        if( j < 0 )
+        else
         {
-            // We come here because we are not included in anything.
-            // We are toplevel.
+            // We are either not included in anything, or included in
+            // something not toplevel (a lake), so in OGCSF we are
+            // considered as toplevel too.
             nCountTopLevel++;
             asPolyEx[i].bIsTopLevel = true;
             asPolyEx[i].poEnclosingPolygon = nullptr;
@@ -3869,6 +4016,324 @@ static double OGRGF_GetDefaultStepSize()
     return CPLAtofM(CPLGetConfigOption("OGR_ARC_STEPSIZE", "4"));
 }
 
+/************************************************************************/
+/*                       OGRRunGeometriesJobs()                         */
+/************************************************************************/
+
+namespace {
+
+struct OGRGeometriesJobError
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+};
+
+// Processing of one geometry. May replace it. The second argument is the
+// index of the job, between 0 and nJobs - 1.
+typedef std::function<OGRErr(OGRGeometry*&, int)> OGRGeometryJobFunc;
+
+struct OGRGeometriesJob
+{
+    OGRGeometry                **papoGeoms = nullptr;
+    int                          nCount = 0;
+    int                          iJob = 0;
+    const OGRGeometryJobFunc    *pfnFunc = nullptr;
+    OGRErr                      *paeErrors = nullptr;
+    OGRErr                       eErr = OGRERR_NONE;
+    std::vector<OGRGeometriesJobError> aoErrors{};
+};
+
+} // namespace
+
+static void CPL_STDCALL OGRGeometriesJobErrorHandler(
+    CPLErr eErrClass, CPLErrorNum nErrNo, const char* pszMsg )
+{
+    OGRGeometriesJob* psJob =
+        static_cast<OGRGeometriesJob*>(CPLGetErrorHandlerUserData());
+    psJob->aoErrors.push_back(
+        OGRGeometriesJobError{eErrClass, nErrNo, pszMsg});
+}
+
+static void OGRGeometriesJobRange( OGRGeometriesJob* psJob )
+{
+    for( int i = 0; i < psJob->nCount; i++ )
+    {
+        OGRErr eErr = OGRERR_NONE;
+        if( psJob->papoGeoms[i] != nullptr )
+            eErr = (*psJob->pfnFunc)(psJob->papoGeoms[i], psJob->iJob);
+        if( psJob->paeErrors )
+            psJob->paeErrors[i] = eErr;
+        if( eErr != OGRERR_NONE )
+            psJob->eErr = eErr;
+    }
+}
+
+static void OGRGeometriesJobThreadFunc( void* pData )
+{
+    OGRGeometriesJob* psJob = static_cast<OGRGeometriesJob*>(pData);
+    // Errors are re-emitted by the calling thread.
+    CPLPushErrorHandlerEx(OGRGeometriesJobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    OGRGeometriesJobRange(psJob);
+    CPLPopErrorHandler();
+}
+
+static int OGRGetGeometriesJobsThreadCount( int nCount,
+                                            CSLConstList papszOptions )
+{
+    const int nThreads = CPLGetNumThreads(papszOptions);
+    // Not worth the overhead for a few geometries.
+    constexpr int MIN_GEOMS_PER_THREAD = 16;
+    return std::max(1, std::min(nThreads, nCount / MIN_GEOMS_PER_THREAD));
+}
+
+// Apply pfnFunc to each geometry of papoGeoms, with nJobs jobs run by the
+// global worker thread pool and the calling thread.
+static OGRErr OGRRunGeometriesJobs( int nCount, OGRGeometry** papoGeoms,
+                                    int nJobs,
+                                    const OGRGeometryJobFunc& pfnFunc,
+                                    OGRErr* paeErrors )
+{
+    CPLWorkerThreadPool* poPool =
+        nJobs > 1 ? CPLGetGlobalWorkerThreadPool(nJobs) : nullptr;
+    if( poPool == nullptr )
+    {
+        OGRGeometriesJob sJob;
+        sJob.papoGeoms = papoGeoms;
+        sJob.nCount = nCount;
+        sJob.pfnFunc = &pfnFunc;
+        sJob.paeErrors = paeErrors;
+        OGRGeometriesJobRange(&sJob);
+        return sJob.eErr;
+    }
+
+    // Split the array in ranges of approximately the same size, the
+    // calling thread taking care of the first one.
+    std::vector<size_t> anSizes(nCount);
+    size_t nTotalSize = 0;
+    for( int i = 0; i < nCount; i++ )
+    {
+        anSizes[i] = papoGeoms[i] ? static_cast<size_t>(papoGeoms[i]->WkbSize()) : 0;
+        nTotalSize += anSizes[i];
+    }
+    std::vector<OGRGeometriesJob> asJobs(nJobs);
+    int iStart = 0;
+    size_t nCumulatedSize = 0;
+    for( int iJob = 0; iJob < nJobs; iJob++ )
+    {
+        const size_t nTargetSize = nTotalSize / nJobs * (iJob + 1);
+        int iEnd = iStart;
+        if( iJob == nJobs - 1 )
+        {
+            iEnd = nCount;
+        }
+        else
+        {
+            while( iEnd < nCount && nCumulatedSize < nTargetSize )
+            {
+                nCumulatedSize += anSizes[iEnd];
+                iEnd++;
+            }
+        }
+        auto& sJob = asJobs[iJob];
+        sJob.papoGeoms = papoGeoms + iStart;
+        sJob.nCount = iEnd - iStart;
+        sJob.iJob = iJob;
+        sJob.pfnFunc = &pfnFunc;
+        sJob.paeErrors = paeErrors ? paeErrors + iStart : nullptr;
+        iStart = iEnd;
+    }
+
+    auto poJobQueue = poPool->CreateJobQueue();
+    for( int iJob = 1; iJob < nJobs; iJob++ )
+    {
+        if( !poJobQueue->SubmitJob(OGRGeometriesJobThreadFunc, &asJobs[iJob]) )
+            OGRGeometriesJobThreadFunc(&asJobs[iJob]);
+    }
+    OGRGeometriesJobThreadFunc(&asJobs[0]);
+    poJobQueue->WaitCompletion();
+
+    OGRErr eErr = OGRERR_NONE;
+    for( const auto& sJob: asJobs )
+    {
+        for( const auto& oError: sJob.aoErrors )
+        {
+            CPLError(oError.eErrClass, oError.nErrNo, "%s",
+                     oError.osMsg.c_str());
+        }
+        if( sJob.eErr != OGRERR_NONE )
+            eErr = sJob.eErr;
+    }
+    return eErr;
+}
+
+/************************************************************************/
+/*                        transformGeometries()                         */
+/************************************************************************/
+
+/**
+ * \brief Transform an array of geometries in place.
+ *
+ * This is equivalent to calling OGRGeometry::transform() on each geometry,
+ * except that the work may be split among several threads, each thread
+ * using its own clone of poCT (see OGRCoordinateTransformation::Clone()).
+ * If poCT cannot be cloned, geometries are transformed by the calling thread.
+ * Errors emitted during the transformation are reported in the calling
+ * thread, in the order of the geometries.
+ *
+ * The recognized list of options is :
+ * <ul>
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads to use.
+ *     Defaults to the value of the GDAL_NUM_THREADS configuration option,
+ *     or 1.</li>
+ * </ul>
+ *
+ * @param nCount number of geometries.
+ * @param papoGeoms array of nCount geometries. NULL geometries are skipped.
+ * @param poCT the transformation to apply. Should not be NULL.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ * @param paeErrors array of nCount error codes set to the return value of
+ * OGRGeometry::transform() for each geometry, or NULL.
+ *
+ * @return OGRERR_NONE if all geometries were transformed, or the error
+ * code of the last geometry that could not be transformed otherwise.
+ * @since GDAL 3.1
+ */
+
+OGRErr OGRGeometryFactory::transformGeometries(
+                                    int nCount,
+                                    OGRGeometry** papoGeoms,
+                                    OGRCoordinateTransformation *poCT,
+                                    CSLConstList papszOptions,
+                                    OGRErr* paeErrors )
+{
+    if( nCount <= 0 )
+        return OGRERR_NONE;
+
+    const int nThreads = OGRGetGeometriesJobsThreadCount(nCount, papszOptions);
+
+    // The first job uses poCT, the other ones a clone of it.
+    std::vector<OGRCoordinateTransformation*> apoCT{poCT};
+    std::vector<std::unique_ptr<OGRCoordinateTransformation>> apoClonedCT;
+    for( int i = 1; i < nThreads; i++ )
+    {
+        std::unique_ptr<OGRCoordinateTransformation> poClone(poCT->Clone());
+        if( !poClone )
+            break;
+        apoCT.push_back(poClone.get());
+        apoClonedCT.push_back(std::move(poClone));
+    }
+
+    const OGRGeometryJobFunc pfnFunc = [&apoCT](OGRGeometry*& poGeom, int iJob)
+    {
+        return poGeom->transform(apoCT[iJob]);
+    };
+    return OGRRunGeometriesJobs(nCount, papoGeoms,
+                                static_cast<int>(apoCT.size()),
+                                pfnFunc, paeErrors);
+}
+
+/************************************************************************/
+/*                         processGeometries()                          */
+/************************************************************************/
+
+/**
+ * \brief Apply GEOS based operations to an array of geometries in place.
+ *
+ * The operations requested with the options are applied to each geometry,
+ * in the following order: SEGMENTIZE, SIMPLIFY or
+ * SIMPLIFY_PRESERVE_TOPOLOGY, MAKE_VALID, BUFFER and VALIDATE. The work may
+ * be split among several threads, each GEOS call using its own reentrant
+ * context. Geometries stay at their position in the array, and errors
+ * emitted during the processing are reported in the calling thread, in the
+ * order of the geometries.
+ *
+ * When an operation fails for a geometry, the geometry is left as it was
+ * after the previous operations, the following operations are skipped, and
+ * its error code is set to OGRERR_FAILURE. Geometry reprojection is done by
+ * transformGeometries().
+ *
+ * The recognized list of options is :
+ * <ul>
+ * <li>SEGMENTIZE=max_length. See OGRGeometry::segmentize().</li>
+ * <li>SIMPLIFY=tolerance. See OGRGeometry::Simplify().</li>
+ * <li>SIMPLIFY_PRESERVE_TOPOLOGY=tolerance.
+ *     See OGRGeometry::SimplifyPreserveTopology().</li>
+ * <li>MAKE_VALID=YES/NO. See OGRGeometry::MakeValid(). Geometries that are
+ *     already valid are left unchanged. Defaults to NO.</li>
+ * <li>BUFFER=distance. See OGRGeometry::Buffer().</li>
+ * <li>VALIDATE=YES/NO. Whether to check the validity of the resulting
+ *     geometries with OGRGeometry::IsValid(). The error code of invalid
+ *     geometries is set to OGRERR_CORRUPT_DATA. Defaults to NO.</li>
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads to use.
+ *     Defaults to the value of the GDAL_NUM_THREADS configuration option,
+ *     or 1.</li>
+ * </ul>
+ *
+ * @param nCount number of geometries.
+ * @param papoGeoms array of nCount geometries, owned by the caller. NULL
+ * geometries are skipped. A geometry may be replaced by a new one, in which
+ * case the old one is destroyed.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ * @param paeErrors array of nCount error codes, or NULL.
+ *
+ * @return OGRERR_NONE if all geometries were processed (and valid with
+ * VALIDATE=YES), or the error code of the last geometry that failed otherwise.
+ * @since GDAL 3.1
+ */
+
+OGRErr OGRGeometryFactory::processGeometries( int nCount,
+                                              OGRGeometry** papoGeoms,
+                                              CSLConstList papszOptions,
+                                              OGRErr* paeErrors )
+{
+    if( nCount <= 0 )
+        return OGRERR_NONE;
+
+    const char* pszSegmentize = CSLFetchNameValue(papszOptions, "SEGMENTIZE");
+    const char* pszSimplify = CSLFetchNameValue(papszOptions, "SIMPLIFY");
+    const char* pszSimplifyPT =
+        CSLFetchNameValue(papszOptions, "SIMPLIFY_PRESERVE_TOPOLOGY");
+    const bool bMakeValid = CPLFetchBool(papszOptions, "MAKE_VALID", false);
+    const char* pszBuffer = CSLFetchNameValue(papszOptions, "BUFFER");
+    const bool bValidate = CPLFetchBool(papszOptions, "VALIDATE", false);
+    const double dfSegmentize = pszSegmentize ? CPLAtof(pszSegmentize) : 0.0;
+    const double dfSimplify = pszSimplify ? CPLAtof(pszSimplify) : 0.0;
+    const double dfSimplifyPT = pszSimplifyPT ? CPLAtof(pszSimplifyPT) : 0.0;
+    const double dfBuffer = pszBuffer ? CPLAtof(pszBuffer) : 0.0;
+
+    const OGRGeometryJobFunc pfnFunc = [=](OGRGeometry*& poGeom, int)
+    {
+        const auto Replace = [&poGeom](OGRGeometry* poNewGeom)
+        {
+            if( poNewGeom == nullptr )
+                return false;
+            delete poGeom;
+            poGeom = poNewGeom;
+            return true;
+        };
+        if( dfSegmentize > 0 )
+            poGeom->segmentize(dfSegmentize);
+        if( pszSimplify && !Replace(poGeom->Simplify(dfSimplify)) )
+            return static_cast<OGRErr>(OGRERR_FAILURE);
+        if( pszSimplifyPT &&
+            !Replace(poGeom->SimplifyPreserveTopology(dfSimplifyPT)) )
+            return static_cast<OGRErr>(OGRERR_FAILURE);
+        if( bMakeValid && !poGeom->IsValid() &&
+            !Replace(poGeom->MakeValid()) )
+            return static_cast<OGRErr>(OGRERR_FAILURE);
+        if( pszBuffer && !Replace(poGeom->Buffer(dfBuffer)) )
+            return static_cast<OGRErr>(OGRERR_FAILURE);
+        if( bValidate && !poGeom->IsValid() )
+            return static_cast<OGRErr>(OGRERR_CORRUPT_DATA);
+        return static_cast<OGRErr>(OGRERR_NONE);
+    };
+    return OGRRunGeometriesJobs(
+        nCount, papoGeoms, OGRGetGeometriesJobsThreadCount(nCount, papszOptions),
+        pfnFunc, paeErrors);
+}
+
 /************************************************************************/
 /*                        approximateArcAngles()                        */
 /************************************************************************/
@@ -36,6 +36,10 @@
 #include <algorithm>
 #include <limits>
 
+#if (defined(__x86_64) || defined(_M_X64))
+#include <emmintrin.h>
+#endif
+
 CPL_CVSID("$Id: ogrlinestring.cpp b0a72128acb6b9509667ee4be06da1f28a010f42 2019-10-21 13:19:06 +0200 Even Rouault $")
 
 namespace {
@@ -49,6 +53,114 @@ int DoubleToIntClamp(double dfValue) {
   return static_cast<int>(dfValue);
 }
 
+/************************************************************************/
+/*                          GetXYEnvelope()                             */
+/*                                                                      */
+/*      Min/max of the X and Y values of a (non empty) array of points, */
+/*      with the same NaN handling as scalar "if( max < x ) max = x"    */
+/*      tests: NaN values are skipped, unless the first value is NaN.   */
+/************************************************************************/
+
+void GetXYEnvelope( const OGRRawPoint* paoPoints, int nPointCount,
+                    OGREnvelope* psEnvelope )
+{
+#if (defined(__x86_64) || defined(_M_X64))
+    // SSE2 is always available on x86_64. OGRRawPoint is a pair of
+    // contiguous doubles, so an XMM register holds (x, y).
+    // _mm_min_pd(a, b) returns b when a is NaN.
+    const double* padfXY = reinterpret_cast<const double*>(paoPoints);
+    __m128d vMin = _mm_loadu_pd(padfXY);
+    __m128d vMax = vMin;
+    __m128d vMin2 = vMin;
+    __m128d vMax2 = vMin;
+    int iPoint = 1;
+    for( ; iPoint + 1 < nPointCount; iPoint += 2 )
+    {
+        const __m128d vXY = _mm_loadu_pd(padfXY + 2 * iPoint);
+        const __m128d vXY2 = _mm_loadu_pd(padfXY + 2 * iPoint + 2);
+        vMin = _mm_min_pd(vXY, vMin);
+        vMax = _mm_max_pd(vXY, vMax);
+        vMin2 = _mm_min_pd(vXY2, vMin2);
+        vMax2 = _mm_max_pd(vXY2, vMax2);
+    }
+    if( iPoint < nPointCount )
+    {
+        const __m128d vXY = _mm_loadu_pd(padfXY + 2 * iPoint);
+        vMin = _mm_min_pd(vXY, vMin);
+        vMax = _mm_max_pd(vXY, vMax);
+    }
+    vMin = _mm_min_pd(vMin2, vMin);
+    vMax = _mm_max_pd(vMax2, vMax);
+    double adfMin[2];
+    double adfMax[2];
+    _mm_storeu_pd(adfMin, vMin);
+    _mm_storeu_pd(adfMax, vMax);
+    psEnvelope->MinX = adfMin[0];
+    psEnvelope->MinY = adfMin[1];
+    psEnvelope->MaxX = adfMax[0];
+    psEnvelope->MaxY = adfMax[1];
+#else
+    double dfMinX = paoPoints[0].x;
+    double dfMaxX = paoPoints[0].x;
+    double dfMinY = paoPoints[0].y;
+    double dfMaxY = paoPoints[0].y;
+
+    for( int iPoint = 1; iPoint < nPointCount; iPoint++ )
+    {
+        if( dfMaxX < paoPoints[iPoint].x )
+            dfMaxX = paoPoints[iPoint].x;
+        if( dfMaxY < paoPoints[iPoint].y )
+            dfMaxY = paoPoints[iPoint].y;
+        if( dfMinX > paoPoints[iPoint].x )
+            dfMinX = paoPoints[iPoint].x;
+        if( dfMinY > paoPoints[iPoint].y )
+            dfMinY = paoPoints[iPoint].y;
+    }
+
+    psEnvelope->MinX = dfMinX;
+    psEnvelope->MaxX = dfMaxX;
+    psEnvelope->MinY = dfMinY;
+    psEnvelope->MaxY = dfMaxY;
+#endif
+}
+
+/************************************************************************/
+/*                          GetMinMax()                                 */
+/************************************************************************/
+
+void GetMinMax( const double* padfVals, int nCount,
+                double& dfMin, double& dfMax )
+{
+#if (defined(__x86_64) || defined(_M_X64))
+    __m128d vMin = _mm_set1_pd(padfVals[0]);
+    __m128d vMax = vMin;
+    int i = 1;
+    for( ; i + 1 < nCount; i += 2 )
+    {
+        const __m128d vVals = _mm_loadu_pd(padfVals + i);
+        vMin = _mm_min_pd(vVals, vMin);
+        vMax = _mm_max_pd(vVals, vMax);
+    }
+    double adfMin[2];
+    double adfMax[2];
+    _mm_storeu_pd(adfMin, vMin);
+    _mm_storeu_pd(adfMax, vMax);
+    dfMin = adfMin[1] < adfMin[0] ? adfMin[1] : adfMin[0];
+    dfMax = adfMax[1] > adfMax[0] ? adfMax[1] : adfMax[0];
+#else
+    dfMin = padfVals[0];
+    dfMax = padfVals[0];
+    int i = 1;
+#endif
+    for( ; i < nCount; i++ )
+    {
+        if( dfMin > padfVals[i] )
+            dfMin = padfVals[i];
+        if( dfMax < padfVals[i] )
+            dfMax = padfVals[i];
+    }
+}
+
 }  // namespace
 
 /************************************************************************/
@@ -1922,11 +2034,12 @@ OGRErr OGRSimpleCurve::exportToWkt( char ** ppszDstText,
     if( eWkbVariant != wkbVariantIso )
         hasM = FALSE;
 
-    size_t nRetLen = 0;
+    const bool bRound = OGRWktRoundEnabled();
+    size_t nRetLen = strlen(*ppszDstText);
 
     for( int i = 0; i < nPointCount; i++ )
     {
-        if( nMaxString <= strlen(*ppszDstText+nRetLen) + 32 + nRetLen )
+        if( nMaxString <= nRetLen + 32 )
         {
             CPLDebug( "OGR",
                       "OGRSimpleCurve::exportToWkt() ... buffer overflow.\n"
@@ -1941,20 +2054,18 @@ OGRErr OGRSimpleCurve::exportToWkt( char ** ppszDstText,
         }
 
         if( i > 0 )
-            strcat( *ppszDstText + nRetLen, "," );
+            (*ppszDstText)[nRetLen++] = ',';
 
-        nRetLen += strlen(*ppszDstText + nRetLen);
-        OGRMakeWktCoordinateM( *ppszDstText + nRetLen,
-                               paoPoints[i].x,
-                               paoPoints[i].y,
-                               padfZ ? padfZ[i] : 0.0,
-                               padfM ? padfM[i] : 0.0,
-                               hasZ, hasM );
-
-        nRetLen += strlen(*ppszDstText + nRetLen);
+        nRetLen += OGRMakeWktCoordinateMInternal( *ppszDstText + nRetLen,
+                                                  paoPoints[i].x,
+                                                  paoPoints[i].y,
+                                                  padfZ ? padfZ[i] : 0.0,
+                                                  padfM ? padfM[i] : 0.0,
+                                                  hasZ, hasM, bRound );
     }
 
-    strcat( *ppszDstText+nRetLen, ")" );
+    (*ppszDstText)[nRetLen] = ')';
+    (*ppszDstText)[nRetLen + 1] = '\0';
 
     return OGRERR_NONE;
 }
@@ -2320,27 +2431,7 @@ void OGRSimpleCurve::getEnvelope( OGREnvelope * psEnvelope ) const
         return;
     }
 
-    double dfMinX = paoPoints[0].x;
-    double dfMaxX = paoPoints[0].x;
-    double dfMinY = paoPoints[0].y;
-    double dfMaxY = paoPoints[0].y;
-
-    for( int iPoint = 1; iPoint < nPointCount; iPoint++ )
-    {
-        if( dfMaxX < paoPoints[iPoint].x )
-            dfMaxX = paoPoints[iPoint].x;
-        if( dfMaxY < paoPoints[iPoint].y )
-            dfMaxY = paoPoints[iPoint].y;
-        if( dfMinX > paoPoints[iPoint].x )
-            dfMinX = paoPoints[iPoint].x;
-        if( dfMinY > paoPoints[iPoint].y )
-            dfMinY = paoPoints[iPoint].y;
-    }
-
-    psEnvelope->MinX = dfMinX;
-    psEnvelope->MaxX = dfMaxX;
-    psEnvelope->MinY = dfMinY;
-    psEnvelope->MaxY = dfMaxY;
+    GetXYEnvelope(paoPoints, nPointCount, psEnvelope);
 }
 
 /************************************************************************/
@@ -2359,19 +2450,7 @@ void OGRSimpleCurve::getEnvelope( OGREnvelope3D * psEnvelope ) const
         return;
     }
 
-    double dfMinZ = padfZ[0];
-    double dfMaxZ = padfZ[0];
-
-    for( int iPoint = 1; iPoint < nPointCount; iPoint++ )
-    {
-        if( dfMinZ > padfZ[iPoint] )
-            dfMinZ = padfZ[iPoint];
-        if( dfMaxZ < padfZ[iPoint] )
-            dfMaxZ = padfZ[iPoint];
-    }
-
-    psEnvelope->MinZ = dfMinZ;
-    psEnvelope->MaxZ = dfMaxZ;
+    GetMinMax(padfZ, nPointCount, psEnvelope->MinZ, psEnvelope->MaxZ);
 }
 
 /************************************************************************/
@@ -0,0 +1,956 @@
+/******************************************************************************
+ *
+ * Project:  Arrow driver
+ * Purpose:  Decoding and encoding of the metadata of the Arrow IPC format.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "arrowipc.h"
+
+#include "cpl_error.h"
+#include "cpl_string.h"
+
+#include <cstring>
+
+CPL_CVSID("$Id$")
+
+using FlatGeobuf::Table;
+using FlatGeobuf::Builder;
+
+namespace ArrowIPC
+{
+
+// Maximum nesting of fields.
+constexpr int MAX_FIELD_DEPTH = 32;
+
+template<class T> static T ReadLE( const GByte* pabyData )
+{
+    T nVal;
+    memcpy(&nVal, pabyData, sizeof(T));
+    SwapToLSB(&nVal);
+    return nVal;
+}
+
+template<class T> static void WriteLE( GByte* pabyData, T nVal )
+{
+    SwapToLSB(&nVal);
+    memcpy(pabyData, &nVal, sizeof(T));
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                              FieldDesc                               */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/************************************************************************/
+
+const char *FieldDesc::GetMetadataItem( const char* pszKey ) const
+{
+    for( const auto& oKV: aoMetadata )
+    {
+        if( oKV.first == pszKey )
+            return oKV.second.c_str();
+    }
+    return nullptr;
+}
+
+/************************************************************************/
+/*                           GetBufferCount()                           */
+/************************************************************************/
+
+int FieldDesc::GetBufferCount( int nVersion ) const
+{
+    // Validity and indices.
+    if( bDictionaryEncoded )
+        return 2;
+
+    switch( eType )
+    {
+        case Type::Null:
+            return 0;
+        case Type::Int:
+        case Type::FloatingPoint:
+        case Type::Bool:
+        case Type::Decimal:
+        case Type::Date:
+        case Type::Time:
+        case Type::Timestamp:
+        case Type::Interval:
+        case Type::FixedSizeBinary:
+        case Type::Duration:
+            return 2;
+        case Type::Binary:
+        case Type::Utf8:
+        case Type::LargeBinary:
+        case Type::LargeUtf8:
+            return 3;
+        case Type::List:
+        case Type::LargeList:
+        case Type::Map:
+            return 2;
+        case Type::Struct_:
+        case Type::FixedSizeList:
+            return 1;
+        case Type::Union:
+            // Versions before V5 had a validity buffer.
+            return (nVersion < nMetadataVersionV5 ? 1 : 0) +
+                   (nUnionMode == UnionMode::Dense ? 2 : 1);
+        default:
+            break;
+    }
+    return -1;
+}
+
+/************************************************************************/
+/*                         GetTotalNodeCount()                          */
+/************************************************************************/
+
+int FieldDesc::GetTotalNodeCount() const
+{
+    int nCount = 1;
+    if( !bDictionaryEncoded )
+    {
+        for( const auto& oChild: aoChildren )
+            nCount += oChild.GetTotalNodeCount();
+    }
+    return nCount;
+}
+
+/************************************************************************/
+/*                        GetTotalBufferCount()                         */
+/************************************************************************/
+
+int FieldDesc::GetTotalBufferCount( int nVersion ) const
+{
+    int nCount = GetBufferCount(nVersion);
+    if( nCount < 0 || bDictionaryEncoded )
+        return nCount;
+    for( const auto& oChild: aoChildren )
+    {
+        const int nChildCount = oChild.GetTotalBufferCount(nVersion);
+        if( nChildCount < 0 )
+            return -1;
+        nCount += nChildCount;
+    }
+    return nCount;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                               Reading                                */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                           ReadKeyValues()                            */
+/************************************************************************/
+
+void ReadKeyValues( const Table& oTable, int iField, KeyValueList& aoList )
+{
+    const uint32_t nCount = oTable.GetTableVectorSize(iField);
+    for( uint32_t i = 0; i < nCount; i++ )
+    {
+        const Table oKV = oTable.GetTableVectorItem(iField, i);
+        if( oKV.IsValid() )
+            aoList.emplace_back(oKV.GetString(KeyValue::key),
+                                oKV.GetString(KeyValue::value));
+    }
+}
+
+/************************************************************************/
+/*                             ReadField()                              */
+/************************************************************************/
+
+static bool ReadField( const Table& oField, FieldDesc& oDesc, int nDepth )
+{
+    if( nDepth > MAX_FIELD_DEPTH )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Too deeply nested fields");
+        return false;
+    }
+    if( !oField.IsValid() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid field");
+        return false;
+    }
+
+    oDesc.osName = oField.GetString(Field::name);
+    oDesc.bNullable = oField.GetBool(Field::nullable, false);
+    oDesc.eType = static_cast<Type>(
+        oField.GetScalar<GByte>(Field::type_type, 0));
+    oDesc.bDictionaryEncoded = oField.HasField(Field::dictionary);
+
+    const Table oType = oField.GetTable(Field::type);
+    switch( oDesc.eType )
+    {
+        case Type::Int:
+            oDesc.nBitWidth = oType.GetScalar<int32_t>(Int::bitWidth, 0);
+            oDesc.bSigned = oType.GetBool(Int::is_signed, false);
+            break;
+        case Type::FloatingPoint:
+            oDesc.nPrecision = oType.GetScalar<int16_t>(
+                FloatingPoint::precision, Precision::HALF);
+            break;
+        case Type::Decimal:
+            oDesc.nPrecision = oType.GetScalar<int32_t>(Decimal::precision, 0);
+            oDesc.nScale = oType.GetScalar<int32_t>(Decimal::scale, 0);
+            oDesc.nBitWidth = oType.GetScalar<int32_t>(Decimal::bitWidth, 128);
+            break;
+        case Type::Date:
+            oDesc.nUnit = oType.GetScalar<int16_t>(Date::unit,
+                                                   DateUnit::MILLISECOND);
+            break;
+        case Type::Time:
+            oDesc.nUnit = oType.GetScalar<int16_t>(Time::unit,
+                                                   TimeUnit::MILLISECOND);
+            oDesc.nBitWidth = oType.GetScalar<int32_t>(Time::bitWidth, 32);
+            break;
+        case Type::Timestamp:
+        case Type::Duration:
+            oDesc.nUnit = oType.GetScalar<int16_t>(Timestamp::unit,
+                                                   TimeUnit::SECOND);
+            if( oDesc.eType == Type::Timestamp )
+                oDesc.osTimezone = oType.GetString(Timestamp::timezone);
+            break;
+        case Type::FixedSizeBinary:
+            oDesc.nByteWidth = oType.GetScalar<int32_t>(
+                FixedSizeBinary::byteWidth, 0);
+            break;
+        case Type::FixedSizeList:
+            oDesc.nByteWidth = oType.GetScalar<int32_t>(
+                FixedSizeList::listSize, 0);
+            break;
+        case Type::Union:
+            oDesc.nUnionMode = oType.GetScalar<int16_t>(Union::mode,
+                                                        UnionMode::Sparse);
+            break;
+        default:
+            break;
+    }
+
+    const uint32_t nChildren = oField.GetTableVectorSize(Field::children);
+    for( uint32_t i = 0; i < nChildren; i++ )
+    {
+        FieldDesc oChild;
+        if( !ReadField(oField.GetTableVectorItem(Field::children, i),
+                       oChild, nDepth + 1) )
+            return false;
+        oDesc.aoChildren.push_back(std::move(oChild));
+    }
+
+    if( (oDesc.eType == Type::List || oDesc.eType == Type::LargeList ||
+         oDesc.eType == Type::FixedSizeList || oDesc.eType == Type::Map) &&
+        oDesc.aoChildren.size() != 1 && !oDesc.bDictionaryEncoded )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Field %s: list type without a single child",
+                 oDesc.osName.c_str());
+        return false;
+    }
+
+    ReadKeyValues(oField, Field::custom_metadata, oDesc.aoMetadata);
+    return true;
+}
+
+/************************************************************************/
+/*                             ReadSchema()                             */
+/************************************************************************/
+
+bool ReadSchema( const Table& oSchema, std::vector<FieldDesc>& aoFields,
+                 KeyValueList& aoMetadata )
+{
+    if( !oSchema.IsValid() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid schema");
+        return false;
+    }
+
+#ifdef CPL_MSB
+    constexpr int nNativeEndianness = Endianness::Big;
+#else
+    constexpr int nNativeEndianness = Endianness::Little;
+#endif
+    if( oSchema.GetScalar<int16_t>(Schema::endianness,
+                                   Endianness::Little) != nNativeEndianness )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Files with a non native endianness are not supported");
+        return false;
+    }
+
+    const uint32_t nFields = oSchema.GetTableVectorSize(Schema::fields);
+    for( uint32_t i = 0; i < nFields; i++ )
+    {
+        FieldDesc oField;
+        if( !ReadField(oSchema.GetTableVectorItem(Schema::fields, i),
+                       oField, 0) )
+            return false;
+        aoFields.push_back(std::move(oField));
+    }
+    ReadKeyValues(oSchema, Schema::custom_metadata, aoMetadata);
+    return true;
+}
+
+/************************************************************************/
+/*                             ReadBlocks()                             */
+/************************************************************************/
+
+bool ReadBlocks( const Table& oFooter, std::vector<Block>& aoBlocks )
+{
+    uint32_t nCount = 0;
+    const GByte* pabyBlocks =
+        oFooter.GetVector(Footer::recordBatches, nBlockSize, nCount);
+    if( pabyBlocks == nullptr && oFooter.HasField(Footer::recordBatches) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid record batch list");
+        return false;
+    }
+    for( uint32_t i = 0; i < nCount; i++ )
+    {
+        const GByte* pabyBlock = pabyBlocks + i * nBlockSize;
+        Block sBlock;
+        sBlock.nOffset = ReadLE<int64_t>(pabyBlock);
+        sBlock.nMetaDataLength = ReadLE<int32_t>(pabyBlock + 8);
+        sBlock.nBodyLength = ReadLE<int64_t>(pabyBlock + 16);
+        if( sBlock.nOffset < 0 || sBlock.nMetaDataLength <= 0 ||
+            sBlock.nBodyLength < 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid block of record batch %u", i);
+            return false;
+        }
+        aoBlocks.push_back(sBlock);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          ReadRecordBatch()                           */
+/************************************************************************/
+
+bool ReadRecordBatch( const Table& oRecordBatch, GIntBig& nLength,
+                      std::vector<FieldNode>& aoNodes,
+                      std::vector<Buffer>& aoBuffers )
+{
+    if( !oRecordBatch.IsValid() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid record batch");
+        return false;
+    }
+    if( oRecordBatch.HasField(RecordBatch::compression) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Compressed record batches are not supported");
+        return false;
+    }
+
+    nLength = oRecordBatch.GetScalar<int64_t>(RecordBatch::length, 0);
+    if( nLength < 0 )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid record batch length");
+        return false;
+    }
+
+    uint32_t nCount = 0;
+    const GByte* pabyNodes =
+        oRecordBatch.GetVector(RecordBatch::nodes, nFieldNodeSize, nCount);
+    for( uint32_t i = 0; pabyNodes && i < nCount; i++ )
+    {
+        FieldNode sNode;
+        sNode.nLength = ReadLE<int64_t>(pabyNodes + i * nFieldNodeSize);
+        sNode.nNullCount = ReadLE<int64_t>(pabyNodes + i * nFieldNodeSize + 8);
+        aoNodes.push_back(sNode);
+    }
+
+    const GByte* pabyBuffers =
+        oRecordBatch.GetVector(RecordBatch::buffers, nBufferSize, nCount);
+    for( uint32_t i = 0; pabyBuffers && i < nCount; i++ )
+    {
+        Buffer sBuffer;
+        sBuffer.nOffset = ReadLE<int64_t>(pabyBuffers + i * nBufferSize);
+        sBuffer.nLength = ReadLE<int64_t>(pabyBuffers + i * nBufferSize + 8);
+        if( sBuffer.nOffset < 0 || sBuffer.nLength < 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Invalid buffer");
+            return false;
+        }
+        aoBuffers.push_back(sBuffer);
+    }
+    return true;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                               Writing                                */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                     DecodeArrowSchemaMetadata()                      */
+/************************************************************************/
+
+KeyValueList DecodeArrowSchemaMetadata( const char* pszMetadata )
+{
+    KeyValueList aoList;
+    if( pszMetadata == nullptr )
+        return aoList;
+
+    // Native endian int32 values.
+    int32_t nPairs = 0;
+    memcpy(&nPairs, pszMetadata, sizeof(int32_t));
+    const char* pszIter = pszMetadata + sizeof(int32_t);
+    for( int32_t i = 0; i < nPairs; i++ )
+    {
+        int32_t nKeyLen = 0;
+        memcpy(&nKeyLen, pszIter, sizeof(int32_t));
+        pszIter += sizeof(int32_t);
+        std::string osKey(pszIter, nKeyLen);
+        pszIter += nKeyLen;
+        int32_t nValueLen = 0;
+        memcpy(&nValueLen, pszIter, sizeof(int32_t));
+        pszIter += sizeof(int32_t);
+        aoList.emplace_back(std::move(osKey), std::string(pszIter, nValueLen));
+        pszIter += nValueLen;
+    }
+    return aoList;
+}
+
+/************************************************************************/
+/*                          BuildKeyValues()                            */
+/************************************************************************/
+
+static uint32_t BuildKeyValues( Builder& oBuilder,
+                                const KeyValueList& aoList )
+{
+    if( aoList.empty() )
+        return 0;
+    std::vector<uint32_t> anKVs;
+    for( const auto& oKV: aoList )
+    {
+        const uint32_t nKey = oBuilder.CreateString(oKV.first);
+        const uint32_t nValue = oBuilder.CreateString(oKV.second);
+        oBuilder.StartTable();
+        oBuilder.AddOffset(KeyValue::key, nKey);
+        oBuilder.AddOffset(KeyValue::value, nValue);
+        anKVs.push_back(oBuilder.EndTable());
+    }
+    return oBuilder.CreateTableVector(anKVs);
+}
+
+/************************************************************************/
+/*                             BuildType()                              */
+/*                                                                      */
+/*      Type table of a format string of the C data interface.          */
+/************************************************************************/
+
+static bool BuildType( Builder& oBuilder, const char* pszFormat,
+                       Type& eType, uint32_t& nType )
+{
+    const auto IntType = [&oBuilder, &eType](int nBitWidth, bool bSigned)
+    {
+        eType = Type::Int;
+        oBuilder.StartTable();
+        oBuilder.AddScalar<int32_t>(Int::bitWidth, nBitWidth, 0);
+        oBuilder.AddBool(Int::is_signed, bSigned, false);
+        return oBuilder.EndTable();
+    };
+    const auto EmptyType = [&oBuilder, &eType](Type eTypeIn)
+    {
+        eType = eTypeIn;
+        oBuilder.StartTable();
+        return oBuilder.EndTable();
+    };
+
+    const size_t nLen = strlen(pszFormat);
+    if( nLen == 1 )
+    {
+        switch( pszFormat[0] )
+        {
+            case 'n': nType = EmptyType(Type::Null); return true;
+            case 'b': nType = EmptyType(Type::Bool); return true;
+            case 'c': nType = IntType(8, true); return true;
+            case 'C': nType = IntType(8, false); return true;
+            case 's': nType = IntType(16, true); return true;
+            case 'S': nType = IntType(16, false); return true;
+            case 'i': nType = IntType(32, true); return true;
+            case 'I': nType = IntType(32, false); return true;
+            case 'l': nType = IntType(64, true); return true;
+            case 'L': nType = IntType(64, false); return true;
+            case 'e': case 'f': case 'g':
+                eType = Type::FloatingPoint;
+                oBuilder.StartTable();
+                oBuilder.AddScalar<int16_t>(FloatingPoint::precision,
+                    static_cast<int16_t>(
+                        pszFormat[0] == 'e' ? Precision::HALF :
+                        pszFormat[0] == 'f' ? Precision::SINGLE :
+                                              Precision::DOUBLE),
+                    Precision::HALF);
+                nType = oBuilder.EndTable();
+                return true;
+            case 'z': nType = EmptyType(Type::Binary); return true;
+            case 'Z': nType = EmptyType(Type::LargeBinary); return true;
+            case 'u': nType = EmptyType(Type::Utf8); return true;
+            case 'U': nType = EmptyType(Type::LargeUtf8); return true;
+            default: break;
+        }
+    }
+    else if( strcmp(pszFormat, "+l") == 0 )
+    {
+        nType = EmptyType(Type::List);
+        return true;
+    }
+    else if( strcmp(pszFormat, "+L") == 0 )
+    {
+        nType = EmptyType(Type::LargeList);
+        return true;
+    }
+    else if( strcmp(pszFormat, "+s") == 0 )
+    {
+        nType = EmptyType(Type::Struct_);
+        return true;
+    }
+    else if( strcmp(pszFormat, "tdD") == 0 || strcmp(pszFormat, "tdm") == 0 )
+    {
+        eType = Type::Date;
+        oBuilder.StartTable();
+        oBuilder.AddScalar<int16_t>(Date::unit,
+            static_cast<int16_t>(pszFormat[2] == 'D' ? DateUnit::DAY :
+                                                       DateUnit::MILLISECOND),
+            DateUnit::MILLISECOND);
+        nType = oBuilder.EndTable();
+        return true;
+    }
+    else if( nLen == 3 && STARTS_WITH(pszFormat, "tt") )
+    {
+        const char* pszUnits = "smun";
+        const char* pszUnit = strchr(pszUnits, pszFormat[2]);
+        if( pszUnit )
+        {
+            const int nUnit = static_cast<int>(pszUnit - pszUnits);
+            eType = Type::Time;
+            oBuilder.StartTable();
+            oBuilder.AddScalar<int16_t>(Time::unit,
+                                        static_cast<int16_t>(nUnit),
+                                        TimeUnit::MILLISECOND);
+            oBuilder.AddScalar<int32_t>(Time::bitWidth,
+                nUnit <= TimeUnit::MILLISECOND ? 32 : 64, 32);
+            nType = oBuilder.EndTable();
+            return true;
+        }
+    }
+    else if( nLen >= 4 && STARTS_WITH(pszFormat, "ts") && pszFormat[3] == ':' )
+    {
+        const char* pszUnits = "smun";
+        const char* pszUnit = strchr(pszUnits, pszFormat[2]);
+        if( pszUnit )
+        {
+            const uint32_t nTimezone = pszFormat[4] ?
+                oBuilder.CreateString(pszFormat + 4, nLen - 4) : 0;
+            eType = Type::Timestamp;
+            oBuilder.StartTable();
+            oBuilder.AddScalar<int16_t>(Timestamp::unit,
+                static_cast<int16_t>(pszUnit - pszUnits), TimeUnit::SECOND);
+            oBuilder.AddOffset(Timestamp::timezone, nTimezone);
+            nType = oBuilder.EndTable();
+            return true;
+        }
+    }
+
+    CPLError(CE_Failure, CPLE_NotSupported,
+             "Unsupported Arrow format '%s'", pszFormat);
+    return false;
+}
+
+/************************************************************************/
+/*                             BuildField()                             */
+/************************************************************************/
+
+static bool BuildField( Builder& oBuilder, const struct ArrowSchema* psField,
+                        uint32_t& nField )
+{
+    std::vector<uint32_t> anChildren;
+    for( int64_t i = 0; i < psField->n_children; i++ )
+    {
+        uint32_t nChild = 0;
+        if( !BuildField(oBuilder, psField->children[i], nChild) )
+            return false;
+        anChildren.push_back(nChild);
+    }
+    // Readers expect the vector of children, even if empty.
+    const uint32_t nChildren = oBuilder.CreateTableVector(anChildren);
+
+    Type eType = Type::NONE;
+    uint32_t nType = 0;
+    if( !BuildType(oBuilder, psField->format, eType, nType) )
+        return false;
+
+    const uint32_t nName = oBuilder.CreateString(
+        psField->name ? psField->name : "");
+    const uint32_t nMetadata = BuildKeyValues(
+        oBuilder, DecodeArrowSchemaMetadata(psField->metadata));
+
+    oBuilder.StartTable();
+    oBuilder.AddOffset(Field::name, nName);
+    oBuilder.AddBool(Field::nullable,
+                     (psField->flags & ARROW_FLAG_NULLABLE) != 0, false);
+    oBuilder.AddScalar<GByte>(Field::type_type, static_cast<GByte>(eType), 0);
+    oBuilder.AddOffset(Field::type, nType);
+    oBuilder.AddOffset(Field::children, nChildren);
+    oBuilder.AddOffset(Field::custom_metadata, nMetadata);
+    nField = oBuilder.EndTable();
+    return true;
+}
+
+/************************************************************************/
+/*                            BuildSchema()                             */
+/************************************************************************/
+
+static bool BuildSchema( Builder& oBuilder,
+                         const struct ArrowSchema* psSchema,
+                         const KeyValueList& aoMetadata,
+                         uint32_t& nSchema )
+{
+    if( strcmp(psSchema->format, "+s") != 0 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "The schema of a record batch must be a struct");
+        return false;
+    }
+
+    std::vector<uint32_t> anFields;
+    for( int64_t i = 0; i < psSchema->n_children; i++ )
+    {
+        uint32_t nField = 0;
+        if( !BuildField(oBuilder, psSchema->children[i], nField) )
+            return false;
+        anFields.push_back(nField);
+    }
+    const uint32_t nFields = oBuilder.CreateTableVector(anFields);
+    const uint32_t nMetadata = BuildKeyValues(oBuilder, aoMetadata);
+
+    oBuilder.StartTable();
+#ifdef CPL_MSB
+    oBuilder.AddScalar<int16_t>(Schema::endianness, Endianness::Big,
+                                Endianness::Little);
+#endif
+    oBuilder.AddOffset(Schema::fields, nFields);
+    oBuilder.AddOffset(Schema::custom_metadata, nMetadata);
+    nSchema = oBuilder.EndTable();
+    return true;
+}
+
+/************************************************************************/
+/*                          EncapsulateMessage()                        */
+/************************************************************************/
+
+static void EncapsulateMessage( Builder& oBuilder, uint32_t nMessage,
+                                std::vector<GByte>& abyMessage )
+{
+    size_t nSize = 0;
+    const GByte* pabyTable = oBuilder.Finish(nMessage, nSize, false);
+    const size_t nPaddedSize =
+        (nSize + nBodyAlignment - 1) / nBodyAlignment * nBodyAlignment;
+    abyMessage.assign(2 * sizeof(uint32_t) + nPaddedSize, 0);
+    WriteLE<uint32_t>(&abyMessage[0], nContinuationMarker);
+    WriteLE<int32_t>(&abyMessage[4], static_cast<int32_t>(nPaddedSize));
+    memcpy(&abyMessage[8], pabyTable, nSize);
+}
+
+/************************************************************************/
+/*                         BuildSchemaMessage()                         */
+/************************************************************************/
+
+bool BuildSchemaMessage( const struct ArrowSchema* psSchema,
+                         const KeyValueList& aoMetadata,
+                         std::vector<GByte>& abyMessage )
+{
+    Builder oBuilder;
+    uint32_t nSchema = 0;
+    if( !BuildSchema(oBuilder, psSchema, aoMetadata, nSchema) )
+        return false;
+
+    oBuilder.StartTable();
+    oBuilder.AddScalar<int16_t>(Message::version, nMetadataVersionV5, 0);
+    oBuilder.AddScalar<GByte>(Message::header_type,
+                              static_cast<GByte>(MessageHeader::Schema), 0);
+    oBuilder.AddOffset(Message::header, nSchema);
+    EncapsulateMessage(oBuilder, oBuilder.EndTable(), abyMessage);
+    return true;
+}
+
+/************************************************************************/
+/*                            AppendArray()                             */
+/*                                                                      */
+/*      Append the field nodes and buffers of an array and its          */
+/*      children, in pre-order as the record batch lists them.          */
+/************************************************************************/
+
+static bool AppendArray( const struct ArrowSchema* psSchema,
+                         const struct ArrowArray* psArray,
+                         std::vector<FieldNode>& aoNodes,
+                         std::vector<Buffer>& aoBuffers,
+                         std::vector<GByte>& abyBody )
+{
+    if( psArray->offset != 0 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Arrays with a non-zero offset are not supported");
+        return false;
+    }
+
+    const auto AddBuffer = [&aoBuffers, &abyBody](const void* pData,
+                                                  size_t nSize)
+    {
+        Buffer sBuffer;
+        sBuffer.nOffset = static_cast<GIntBig>(abyBody.size());
+        sBuffer.nLength = static_cast<GIntBig>(nSize);
+        aoBuffers.push_back(sBuffer);
+        const size_t nPaddedSize =
+            (nSize + nBodyAlignment - 1) / nBodyAlignment * nBodyAlignment;
+        abyBody.resize(abyBody.size() + nPaddedSize, 0);
+        if( nSize )
+            memcpy(&abyBody[static_cast<size_t>(sBuffer.nOffset)],
+                   pData, nSize);
+    };
+
+    const char* pszFormat = psSchema->format;
+    const size_t nLength = static_cast<size_t>(psArray->length);
+    const GByte* const* papabyBuffers =
+        reinterpret_cast<const GByte* const*>(psArray->buffers);
+
+    // Null arrays have no buffer at all.
+    if( strcmp(pszFormat, "n") == 0 )
+    {
+        FieldNode sNode = { psArray->length, psArray->length };
+        aoNodes.push_back(sNode);
+        return true;
+    }
+
+    FieldNode sNode = { psArray->length, psArray->null_count };
+    const GByte* pabyValidity =
+        psArray->n_buffers > 0 ? papabyBuffers[0] : nullptr;
+    if( pabyValidity != nullptr && sNode.nNullCount < 0 )
+    {
+        sNode.nNullCount = 0;
+        for( size_t i = 0; i < nLength; i++ )
+        {
+            if( !(pabyValidity[i / 8] & (1 << (i % 8))) )
+                sNode.nNullCount++;
+        }
+    }
+    if( sNode.nNullCount <= 0 )
+    {
+        sNode.nNullCount = 0;
+        pabyValidity = nullptr;
+    }
+    aoNodes.push_back(sNode);
+    AddBuffer(pabyValidity, pabyValidity ? (nLength + 7) / 8 : 0);
+
+    const size_t nFormatLen = strlen(pszFormat);
+    size_t nValueSize = 0;
+    if( strcmp(pszFormat, "b") == 0 )
+    {
+        AddBuffer(papabyBuffers[1], (nLength + 7) / 8);
+        return true;
+    }
+    if( nFormatLen == 1 )
+    {
+        switch( pszFormat[0] )
+        {
+            case 'c': case 'C': nValueSize = 1; break;
+            case 's': case 'S': case 'e': nValueSize = 2; break;
+            case 'i': case 'I': case 'f': nValueSize = 4; break;
+            case 'l': case 'L': case 'g': nValueSize = 8; break;
+            default: break;
+        }
+    }
+    else if( strcmp(pszFormat, "tdD") == 0 )
+        nValueSize = 4;
+    else if( strcmp(pszFormat, "tdm") == 0 )
+        nValueSize = 8;
+    else if( nFormatLen == 3 && STARTS_WITH(pszFormat, "tt") )
+        nValueSize = (pszFormat[2] == 's' || pszFormat[2] == 'm') ? 4 : 8;
+    else if( STARTS_WITH(pszFormat, "ts") )
+        nValueSize = 8;
+    if( nValueSize )
+    {
+        AddBuffer(papabyBuffers[1], nLength * nValueSize);
+        return true;
+    }
+
+    const bool bLarge = strcmp(pszFormat, "Z") == 0 ||
+                        strcmp(pszFormat, "U") == 0 ||
+                        strcmp(pszFormat, "+L") == 0;
+    const size_t nOffsetSize = bLarge ? sizeof(int64_t) : sizeof(int32_t);
+    if( strcmp(pszFormat, "z") == 0 || strcmp(pszFormat, "u") == 0 ||
+        strcmp(pszFormat, "Z") == 0 || strcmp(pszFormat, "U") == 0 )
+    {
+        AddBuffer(papabyBuffers[1], (nLength + 1) * nOffsetSize);
+        GIntBig nDataSize = 0;
+        if( bLarge )
+            memcpy(&nDataSize, papabyBuffers[1] + nLength * nOffsetSize,
+                   sizeof(int64_t));
+        else
+        {
+            int32_t nOffset = 0;
+            memcpy(&nOffset, papabyBuffers[1] + nLength * nOffsetSize,
+                   sizeof(int32_t));
+            nDataSize = nOffset;
+        }
+        AddBuffer(papabyBuffers[2], static_cast<size_t>(nDataSize));
+        return true;
+    }
+    if( strcmp(pszFormat, "+l") == 0 || strcmp(pszFormat, "+L") == 0 )
+    {
+        AddBuffer(papabyBuffers[1], (nLength + 1) * nOffsetSize);
+        return AppendArray(psSchema->children[0], psArray->children[0],
+                           aoNodes, aoBuffers, abyBody);
+    }
+    if( strcmp(pszFormat, "+s") == 0 )
+    {
+        for( int64_t i = 0; i < psSchema->n_children; i++ )
+        {
+            if( !AppendArray(psSchema->children[i], psArray->children[i],
+                             aoNodes, aoBuffers, abyBody) )
+                return false;
+        }
+        return true;
+    }
+
+    CPLError(CE_Failure, CPLE_NotSupported,
+             "Unsupported Arrow format '%s'", pszFormat);
+    return false;
+}
+
+/************************************************************************/
+/*                      BuildRecordBatchMessage()                       */
+/************************************************************************/
+
+bool BuildRecordBatchMessage( const struct ArrowSchema* psSchema,
+                              const struct ArrowArray* psArray,
+                              const KeyValueList& aoMetadata,
+                              std::vector<GByte>& abyMessage,
+                              std::vector<GByte>& abyBody )
+{
+    std::vector<FieldNode> aoNodes;
+    std::vector<Buffer> aoBuffers;
+    abyBody.clear();
+    if( psSchema->n_children != psArray->n_children )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Array does not match the schema");
+        return false;
+    }
+    for( int64_t i = 0; i < psSchema->n_children; i++ )
+    {
+        if( !AppendArray(psSchema->children[i], psArray->children[i],
+                         aoNodes, aoBuffers, abyBody) )
+            return false;
+    }
+
+    std::vector<GByte> abyNodes(aoNodes.size() * nFieldNodeSize);
+    for( size_t i = 0; i < aoNodes.size(); i++ )
+    {
+        WriteLE<int64_t>(&abyNodes[i * nFieldNodeSize], aoNodes[i].nLength);
+        WriteLE<int64_t>(&abyNodes[i * nFieldNodeSize + 8],
+                         aoNodes[i].nNullCount);
+    }
+    std::vector<GByte> abyBuffers(aoBuffers.size() * nBufferSize);
+    for( size_t i = 0; i < aoBuffers.size(); i++ )
+    {
+        WriteLE<int64_t>(&abyBuffers[i * nBufferSize], aoBuffers[i].nOffset);
+        WriteLE<int64_t>(&abyBuffers[i * nBufferSize + 8],
+                         aoBuffers[i].nLength);
+    }
+
+    Builder oBuilder;
+    const uint32_t nNodes = oBuilder.CreateVector(
+        abyNodes.data(), aoNodes.size(), nFieldNodeSize, sizeof(int64_t));
+    const uint32_t nBuffers = oBuilder.CreateVector(
+        abyBuffers.data(), aoBuffers.size(), nBufferSize, sizeof(int64_t));
+    oBuilder.StartTable();
+    oBuilder.AddScalar<int64_t>(RecordBatch::length, psArray->length, 0);
+    oBuilder.AddOffset(RecordBatch::nodes, nNodes);
+    oBuilder.AddOffset(RecordBatch::buffers, nBuffers);
+    const uint32_t nRecordBatch = oBuilder.EndTable();
+
+    const uint32_t nMetadata = BuildKeyValues(oBuilder, aoMetadata);
+
+    oBuilder.StartTable();
+    oBuilder.AddScalar<int64_t>(Message::bodyLength,
+                                static_cast<int64_t>(abyBody.size()), 0);
+    oBuilder.AddOffset(Message::custom_metadata, nMetadata);
+    oBuilder.AddOffset(Message::header, nRecordBatch);
+    oBuilder.AddScalar<int16_t>(Message::version, nMetadataVersionV5, 0);
+    oBuilder.AddScalar<GByte>(Message::header_type,
+                              static_cast<GByte>(MessageHeader::RecordBatch),
+                              0);
+    EncapsulateMessage(oBuilder, oBuilder.EndTable(), abyMessage);
+    return true;
+}
+
+/************************************************************************/
+/*                            BuildFooter()                             */
+/************************************************************************/
+
+bool BuildFooter( const struct ArrowSchema* psSchema,
+                  const KeyValueList& aoSchemaMetadata,
+                  const std::vector<Block>& aoRecordBatches,
+                  std::vector<GByte>& abyFooter )
+{
+    Builder oBuilder;
+    uint32_t nSchema = 0;
+    if( !BuildSchema(oBuilder, psSchema, aoSchemaMetadata, nSchema) )
+        return false;
+
+    std::vector<GByte> abyBlocks(aoRecordBatches.size() * nBlockSize, 0);
+    for( size_t i = 0; i < aoRecordBatches.size(); i++ )
+    {
+        GByte* pabyBlock = &abyBlocks[i * nBlockSize];
+        WriteLE<int64_t>(pabyBlock, aoRecordBatches[i].nOffset);
+        WriteLE<int32_t>(pabyBlock + 8, aoRecordBatches[i].nMetaDataLength);
+        WriteLE<int64_t>(pabyBlock + 16, aoRecordBatches[i].nBodyLength);
+    }
+    const uint32_t nRecordBatches = oBuilder.CreateVector(
+        abyBlocks.data(), aoRecordBatches.size(), nBlockSize,
+        sizeof(int64_t));
+    const uint32_t nDictionaries =
+        oBuilder.CreateVector(nullptr, 0, nBlockSize, sizeof(int64_t));
+
+    oBuilder.StartTable();
+    oBuilder.AddOffset(Footer::schema, nSchema);
+    oBuilder.AddOffset(Footer::dictionaries, nDictionaries);
+    oBuilder.AddOffset(Footer::recordBatches, nRecordBatches);
+    oBuilder.AddScalar<int16_t>(Footer::version, nMetadataVersionV5, 0);
+    const uint32_t nFooter = oBuilder.EndTable();
+
+    size_t nSize = 0;
+    const GByte* pabyFooter = oBuilder.Finish(nFooter, nSize, false);
+    abyFooter.assign(pabyFooter, pabyFooter + nSize);
+    return true;
+}
+
+} // namespace ArrowIPC
@@ -0,0 +1,259 @@
+/******************************************************************************
+ *
+ * Project:  Arrow driver
+ * Purpose:  Low level declarations of the Arrow IPC format: message, schema
+ *           and footer tables, and their encoding with the flatbuffers
+ *           reader and builder of the FlatGeobuf driver.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef ARROWIPC_H_INCLUDED
+#define ARROWIPC_H_INCLUDED
+
+#include "cpl_port.h"
+#include "flatgeobuf.h"
+#include "ogr_recordbatch.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ArrowIPC
+{
+
+using FlatGeobuf::SwapToLSB;
+
+typedef std::vector<std::pair<std::string, std::string>> KeyValueList;
+
+/* -------------------------------------------------------------------- */
+/*      File layout: magic bytes padded to 8 bytes, the messages of the */
+/*      stream format, the Footer table, its int32 size and the magic   */
+/*      bytes again. Each message is a continuation marker, the int32   */
+/*      size of the padded Message table, the table, then the body.     */
+/* -------------------------------------------------------------------- */
+constexpr GByte abyMagicBytes[6] = { 'A', 'R', 'R', 'O', 'W', '1' };
+constexpr size_t nMagicBytesSize = sizeof(abyMagicBytes);
+constexpr size_t nFileHeaderSize = 8;
+constexpr uint32_t nContinuationMarker = 0xFFFFFFFFU;
+
+// Sanity limit on the size of Message and Footer tables.
+constexpr uint32_t nMaxMetadataSize = 256 * 1024 * 1024;
+
+constexpr int16_t nMetadataVersionV4 = 3;
+constexpr int16_t nMetadataVersionV5 = 4;
+
+// Buffers of the message bodies are aligned on this size.
+constexpr size_t nBodyAlignment = 8;
+
+/* -------------------------------------------------------------------- */
+/*      Enumerations.                                                   */
+/* -------------------------------------------------------------------- */
+enum class MessageHeader : GByte
+{
+    NONE = 0,
+    Schema,
+    DictionaryBatch,
+    RecordBatch,
+    Tensor,
+    SparseTensor
+};
+
+enum class Type : GByte
+{
+    NONE = 0,
+    Null,
+    Int,
+    FloatingPoint,
+    Binary,
+    Utf8,
+    Bool,
+    Decimal,
+    Date,
+    Time,
+    Timestamp,
+    Interval,
+    List,
+    Struct_,
+    Union,
+    FixedSizeBinary,
+    FixedSizeList,
+    Map,
+    Duration,
+    LargeBinary,
+    LargeUtf8,
+    LargeList
+};
+
+namespace Precision { enum { HALF = 0, SINGLE, DOUBLE }; }
+namespace DateUnit { enum { DAY = 0, MILLISECOND }; }
+namespace TimeUnit { enum { SECOND = 0, MILLISECOND, MICROSECOND,
+                            NANOSECOND }; }
+namespace UnionMode { enum { Sparse = 0, Dense }; }
+namespace Endianness { enum { Little = 0, Big }; }
+
+/* -------------------------------------------------------------------- */
+/*      Field ids of the tables, in schema order. Unions take two ids,  */
+/*      the type then the value.                                        */
+/* -------------------------------------------------------------------- */
+namespace Message
+{
+    enum { version = 0, header_type, header, bodyLength, custom_metadata };
+}
+
+namespace Schema
+{
+    enum { endianness = 0, fields, custom_metadata, features };
+}
+
+namespace Field
+{
+    enum { name = 0, nullable, type_type, type, dictionary, children,
+           custom_metadata };
+}
+
+namespace KeyValue
+{
+    enum { key = 0, value };
+}
+
+namespace RecordBatch
+{
+    enum { length = 0, nodes, buffers, compression };
+}
+
+namespace Footer
+{
+    enum { version = 0, schema, dictionaries, recordBatches,
+           custom_metadata };
+}
+
+namespace Int { enum { bitWidth = 0, is_signed }; }
+namespace FloatingPoint { enum { precision = 0 }; }
+namespace Decimal { enum { precision = 0, scale, bitWidth }; }
+namespace Date { enum { unit = 0 }; }
+namespace Time { enum { unit = 0, bitWidth }; }
+namespace Timestamp { enum { unit = 0, timezone }; }
+namespace FixedSizeBinary { enum { byteWidth = 0 }; }
+namespace FixedSizeList { enum { listSize = 0 }; }
+namespace Union { enum { mode = 0, typeIds }; }
+
+// Sizes of the structs stored in vectors.
+constexpr size_t nFieldNodeSize = 16;  // int64 length, int64 null_count
+constexpr size_t nBufferSize = 16;     // int64 offset, int64 length
+constexpr size_t nBlockSize = 24;      // int64 offset, int32 metaDataLength
+                                       // (+ 4 padding), int64 bodyLength
+
+struct FieldNode
+{
+    GIntBig     nLength;
+    GIntBig     nNullCount;
+};
+
+struct Buffer
+{
+    GIntBig     nOffset;
+    GIntBig     nLength;
+};
+
+struct Block
+{
+    GIntBig     nOffset;
+    int32_t     nMetaDataLength;
+    GIntBig     nBodyLength;
+};
+
+/************************************************************************/
+/*                              FieldDesc                               */
+/*                                                                      */
+/*      Decoded Field table of a schema.                                */
+/************************************************************************/
+
+struct FieldDesc
+{
+    std::string osName{};
+    bool        bNullable = true;
+    Type        eType = Type::NONE;
+    int         nBitWidth = 0;      // Int, Decimal, Time
+    bool        bSigned = false;    // Int
+    int         nPrecision = 0;     // FloatingPoint, Decimal
+    int         nScale = 0;         // Decimal
+    int         nUnit = 0;          // Date, Time, Timestamp, Duration
+    int         nByteWidth = 0;     // FixedSizeBinary, FixedSizeList size
+    int         nUnionMode = 0;
+    std::string osTimezone{};       // Timestamp
+    bool        bDictionaryEncoded = false;
+    std::vector<FieldDesc> aoChildren{};
+    KeyValueList aoMetadata{};
+
+    const char *GetMetadataItem( const char* pszKey ) const;
+
+    // Number of buffers of this field in a record batch, not counting
+    // the ones of its children.
+    int         GetBufferCount( int nVersion ) const;
+
+    // Number of field nodes and buffers, including those of the children.
+    int         GetTotalNodeCount() const;
+    int         GetTotalBufferCount( int nVersion ) const;
+};
+
+/* -------------------------------------------------------------------- */
+/*      Reading.                                                        */
+/* -------------------------------------------------------------------- */
+void        ReadKeyValues( const FlatGeobuf::Table& oTable, int iField,
+                           KeyValueList& aoList );
+bool        ReadSchema( const FlatGeobuf::Table& oSchema,
+                        std::vector<FieldDesc>& aoFields,
+                        KeyValueList& aoMetadata );
+bool        ReadBlocks( const FlatGeobuf::Table& oFooter,
+                        std::vector<Block>& aoBlocks );
+bool        ReadRecordBatch( const FlatGeobuf::Table& oRecordBatch,
+                             GIntBig& nLength,
+                             std::vector<FieldNode>& aoNodes,
+                             std::vector<Buffer>& aoBuffers );
+
+/* -------------------------------------------------------------------- */
+/*      Writing, from the schemas and arrays of the Arrow C data        */
+/*      interface. The messages are returned with their continuation    */
+/*      marker and size prefix, padded to 8 bytes.                      */
+/* -------------------------------------------------------------------- */
+bool        BuildSchemaMessage( const struct ArrowSchema* psSchema,
+                                const KeyValueList& aoMetadata,
+                                std::vector<GByte>& abyMessage );
+bool        BuildRecordBatchMessage( const struct ArrowSchema* psSchema,
+                                     const struct ArrowArray* psArray,
+                                     const KeyValueList& aoMetadata,
+                                     std::vector<GByte>& abyMessage,
+                                     std::vector<GByte>& abyBody );
+// The schema of the footer may have more complete metadata than the one
+// of the first message, written before the features.
+bool        BuildFooter( const struct ArrowSchema* psSchema,
+                         const KeyValueList& aoSchemaMetadata,
+                         const std::vector<Block>& aoRecordBatches,
+                         std::vector<GByte>& abyFooter );
+
+// Decodes the binary layout of ArrowSchema::metadata.
+KeyValueList DecodeArrowSchemaMetadata( const char* pszMetadata );
+
+} // namespace ArrowIPC
+
+#endif /* ndef ARROWIPC_H_INCLUDED */
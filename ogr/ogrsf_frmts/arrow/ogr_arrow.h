@@ -0,0 +1,276 @@
+/******************************************************************************
+ *
+ * Project:  Arrow driver
+ * Purpose:  Declarations of the Arrow IPC driver classes.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef OGR_ARROW_H_INCLUDED
+#define OGR_ARROW_H_INCLUDED
+
+#include "ogrsf_frmts.h"
+#include "ogrlayerarrow.h"
+#include "cpl_worker_thread_pool.h"
+
+#include "arrowipc.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class swq_expr_node;
+
+/************************************************************************/
+/*                            OGRArrowLayer                             */
+/************************************************************************/
+
+class OGRArrowLayer final: public OGRLayer
+{
+  public:
+    // Minimum and maximum of a numeric attribute field in a record batch,
+    // as written by this driver in the custom metadata of the batches.
+    // Strings are compared case insensitively by OGR SQL, so their byte
+    // order bounds would not help.
+    struct ColumnStats
+    {
+        enum { NONE, INTEGER, REAL } eType = NONE;
+        GIntBig         nMin = 0;
+        GIntBig         nMax = 0;
+        double          dfMin = 0.0;
+        double          dfMax = 0.0;
+    };
+
+    struct BatchInfo
+    {
+        vsi_l_offset    nBodyOffset = 0;
+        GIntBig         nBodyLength = 0;
+        GIntBig         nFirstRow = 0;
+        GIntBig         nRows = 0;
+        std::vector<ArrowIPC::FieldNode> aoNodes{};
+        std::vector<ArrowIPC::Buffer> aoBuffers{};
+        // Indexed by attribute and geometry field. Empty if unknown.
+        std::vector<ColumnStats> aoStats{};
+        std::vector<OGREnvelope> asExtents{};
+        std::vector<bool> abHasExtent{};
+    };
+
+    // Buffers of a column of a loaded record batch.
+    struct ArrayView
+    {
+        const ArrowIPC::FieldDesc *psField = nullptr;
+        GIntBig         nLength = 0;
+        const GByte    *pabyValidity = nullptr;  // null if no null value
+        const GByte    *pabyValues = nullptr;    // or offsets
+        size_t          nValuesSize = 0;
+        const GByte    *pabyData = nullptr;      // variable width bytes
+        size_t          nDataSize = 0;
+        std::vector<ArrayView> aoChildren{};
+
+        bool            IsNull( GIntBig i ) const
+            { return pabyValidity != nullptr &&
+                     (pabyValidity[i >> 3] & (1 << (i & 7))) == 0; }
+    };
+
+    struct BatchData
+    {
+        const BatchInfo *psInfo = nullptr;
+        std::vector<GByte> abyBuffer{};
+        // Indexed by top level column. Columns that are not read have a
+        // null psField.
+        std::vector<ArrayView> aoColumns{};
+    };
+
+    struct RowRange
+    {
+        std::shared_ptr<BatchData> poData{};
+        GIntBig         iStart = 0;
+        GIntBig         iEnd = 0;
+    };
+
+  private:
+    std::string         m_osFilename{};
+    OGRFeatureDefn     *m_poFeatureDefn = nullptr;
+    VSILFILE           *m_poFp = nullptr;
+
+    // Reading.
+    bool                m_bStreamFormat = false;
+    int                 m_nVersion = ArrowIPC::nMetadataVersionV5;
+    std::vector<ArrowIPC::FieldDesc> m_aoFields{};
+    struct ColumnInfo
+    {
+        int             iFirstNode = 0;
+        int             iFirstBuffer = 0;
+        int             iField = -1;
+        int             iGeomField = -1;
+    };
+    std::vector<ColumnInfo> m_aoColumns{};
+    int                 m_nNodeCount = 0;
+    int                 m_nBufferCount = 0;
+    int                 m_iFIDColumn = -1;
+    std::vector<int>    m_anFieldColumn{};
+    std::vector<int>    m_anGeomFieldColumn{};
+    std::vector<BatchInfo> m_aoBatches{};
+    GIntBig             m_nTotalRows = 0;
+    OGREnvelope         m_sExtent{};
+    bool                m_bHasExtent = false;
+
+    int                 m_nNumThreads = 1;
+    std::unique_ptr<CPLJobQueue> m_poJobQueue{};
+
+    size_t              m_iCurBatch = 0;
+    GIntBig             m_nCurRow = 0;
+    std::shared_ptr<BatchData> m_poCurData{};
+    bool                m_bEOF = false;
+    std::vector<std::unique_ptr<OGRFeature>> m_apoFeatures{};
+    size_t              m_iNextFeature = 0;
+    std::vector<struct ArrowArray> m_asArrowArrays{};
+    size_t              m_iNextArrowArray = 0;
+    std::shared_ptr<BatchData> m_poRandomData{};
+    size_t              m_iRandomBatch = 0;
+
+    // Writing.
+    bool                m_bCreate = false;
+    bool                m_bWriteStream = false;
+    int                 m_nBatchSize = 0;
+    std::string         m_osFIDColumn{};
+    std::unique_ptr<OGRArrowArrayBuilder> m_poBuilder{};
+    struct ArrowSchema  m_sSchema;
+    vsi_l_offset        m_nWriteOffset = 0;
+    std::vector<ArrowIPC::Block> m_aoBlocks{};
+    GIntBig             m_nFeatureCount = 0;
+    std::vector<ColumnStats> m_aoBatchStats{};
+    std::vector<OGREnvelope> m_asBatchExtents{};
+    std::vector<bool>   m_abHasBatchExtent{};
+    bool                m_bWriteError = false;
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRArrowLayer)
+
+    OGRArrowLayer();
+
+    bool                ReadFileTrailer( std::vector<GByte>& abyFooter );
+    bool                ReadStreamMessage( vsi_l_offset& nOffset,
+                                           std::vector<GByte>& abyMessage,
+                                           bool& bEOS );
+    bool                ReadBatchMessage( const GByte* pabyMessage,
+                                          size_t nSize,
+                                          GIntBig nBlockBodyLength,
+                                          BatchInfo& oBatch );
+    bool                ScanFileBatches(
+                                const std::vector<ArrowIPC::Block>& aoBlocks );
+    bool                ScanStreamBatches( vsi_l_offset nOffset );
+    bool                BuildLayerDefn( const ArrowIPC::KeyValueList& aoMetadata,
+                                        CSLConstList papszOpenOptions );
+    void                ReadStatistics( const char* pszJSON,
+                                        BatchInfo& oBatch ) const;
+
+    bool                BatchMatchesFilters( const BatchInfo& oBatch );
+    bool                CanExcludeBatch( const swq_expr_node* poNode,
+                                         const BatchInfo& oBatch ) const;
+    std::shared_ptr<BatchData> LoadBatch( size_t iBatch );
+    bool                NextRowRanges( GIntBig nMaxRows, size_t nMaxRanges,
+                                       bool bUseFilters,
+                                       std::vector<RowRange>& aoRanges );
+    void                RunJobs( CPLThreadFunc pfnFunc,
+                                 std::vector<void*>& apJobs );
+    void                ClearReadBuffers();
+
+    bool                WriteBytes( const void* pData, size_t nSize );
+    bool                StartWriting();
+    bool                FlushBatch();
+    void                UpdateStatistics( const OGRFeature* poFeature );
+    std::string         GetBatchStatistics() const;
+    std::string         GetGeoMetadata( bool bWithExtent ) const;
+    bool                Finalize();
+
+  protected:
+    virtual int         GetNextArrowArray( struct ArrowArrayStream* stream,
+                                           struct ArrowArray* out_array ) override;
+
+  public:
+    virtual ~OGRArrowLayer();
+
+    static OGRArrowLayer *Open( const char* pszFilename, VSILFILE* fp,
+                                CSLConstList papszOpenOptions );
+    static OGRArrowLayer *Create( const char* pszFilename,
+                                  const char* pszLayerName,
+                                  OGRSpatialReference* poSRS,
+                                  OGRwkbGeometryType eGType,
+                                  CSLConstList papszOptions );
+
+    // For the decoding jobs.
+    template<class Visitor> void
+                        DecodeRow( const BatchData& oData, GIntBig iRow,
+                                   Visitor& oVisitor ) const;
+    OGRFeature         *DecodeFeature( const BatchData& oData, GIntBig iRow,
+                                       bool bParseGeometry ) const;
+
+    virtual OGRFeatureDefn *GetLayerDefn() override { return m_poFeatureDefn; }
+    virtual const char *GetFIDColumn() override;
+
+    virtual void        ResetReading() override;
+    virtual OGRFeature *GetNextFeature() override;
+    virtual OGRFeature *GetFeature( GIntBig nFID ) override;
+    virtual GIntBig     GetFeatureCount( int bForce = TRUE ) override;
+    virtual OGRErr      GetExtent( OGREnvelope *psExtent,
+                                   int bForce = TRUE ) override;
+    virtual OGRErr      GetExtent( int iGeomField, OGREnvelope *psExtent,
+                                   int bForce ) override;
+
+    virtual OGRErr      SetIgnoredFields( const char **papszFields ) override;
+
+    virtual OGRErr      CreateField( OGRFieldDefn *poField,
+                                     int bApproxOK = TRUE ) override;
+    virtual OGRErr      ICreateFeature( OGRFeature *poFeature ) override;
+
+    virtual int         TestCapability( const char * ) override;
+};
+
+/************************************************************************/
+/*                           OGRArrowDataset                            */
+/************************************************************************/
+
+class OGRArrowDataset final: public GDALDataset
+{
+    std::unique_ptr<OGRArrowLayer> m_poLayer{};
+    bool                m_bCreate = false;
+
+  public:
+    OGRArrowDataset( const char* pszName, bool bCreate );
+
+    static int          Identify( GDALOpenInfo* poOpenInfo );
+    static GDALDataset *Open( GDALOpenInfo* poOpenInfo );
+    static GDALDataset *Create( const char *pszName, int nBands, int nXSize,
+                                int nYSize, GDALDataType eDT,
+                                char **papszOptions );
+
+    virtual int         GetLayerCount() override { return m_poLayer ? 1 : 0; }
+    virtual OGRLayer   *GetLayer( int iLayer ) override;
+    virtual int         TestCapability( const char *pszCap ) override;
+
+    virtual OGRLayer   *ICreateLayer( const char *pszName,
+                                      OGRSpatialReference *poSpatialRef = nullptr,
+                                      OGRwkbGeometryType eGType = wkbUnknown,
+                                      char ** papszOptions = nullptr ) override;
+};
+
+#endif /* ndef OGR_ARROW_H_INCLUDED */
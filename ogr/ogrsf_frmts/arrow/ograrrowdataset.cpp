@@ -0,0 +1,207 @@
+/******************************************************************************
+ *
+ * Project:  Arrow driver
+ * Purpose:  Implements OGRArrowDataset class and driver registration.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "ogr_arrow.h"
+
+CPL_CVSID("$Id$")
+
+using namespace ArrowIPC;
+
+/************************************************************************/
+/*                          OGRArrowDataset()                           */
+/************************************************************************/
+
+OGRArrowDataset::OGRArrowDataset( const char* pszName, bool bCreate ) :
+    m_bCreate(bCreate)
+{
+    SetDescription(pszName);
+}
+
+/************************************************************************/
+/*                              Identify()                              */
+/*                                                                      */
+/*      The file format starts with its magic bytes. Streams which have */
+/*      no magic bytes are only recognized by their .arrows extension.  */
+/************************************************************************/
+
+int OGRArrowDataset::Identify( GDALOpenInfo* poOpenInfo )
+{
+    if( poOpenInfo->fpL == nullptr || poOpenInfo->nHeaderBytes < 8 )
+        return FALSE;
+    if( memcmp(poOpenInfo->pabyHeader, abyMagicBytes, nMagicBytesSize) == 0 )
+        return TRUE;
+    if( !EQUAL(CPLGetExtension(poOpenInfo->pszFilename), "arrows") )
+        return FALSE;
+
+    // Continuation marker, or the size of the schema message before
+    // Arrow 0.15.
+    uint32_t nVal;
+    memcpy(&nVal, poOpenInfo->pabyHeader, sizeof(nVal));
+    SwapToLSB(&nVal);
+    return nVal == nContinuationMarker || nVal <= nMaxMetadataSize;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+GDALDataset *OGRArrowDataset::Open( GDALOpenInfo* poOpenInfo )
+{
+    if( Identify(poOpenInfo) == FALSE )
+        return nullptr;
+    if( poOpenInfo->eAccess == GA_Update )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Arrow driver does not support update");
+        return nullptr;
+    }
+
+    OGRArrowLayer* poLayer =
+        OGRArrowLayer::Open(poOpenInfo->pszFilename, poOpenInfo->fpL,
+                            poOpenInfo->papszOpenOptions);
+    poOpenInfo->fpL = nullptr;
+    if( poLayer == nullptr )
+        return nullptr;
+
+    auto poDS = new OGRArrowDataset(poOpenInfo->pszFilename, false);
+    poDS->m_poLayer.reset(poLayer);
+    return poDS;
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+GDALDataset *OGRArrowDataset::Create( const char *pszName,
+                                      int /* nBands */,
+                                      int /* nXSize */,
+                                      int /* nYSize */,
+                                      GDALDataType /* eDT */,
+                                      char ** /* papszOptions */ )
+{
+    return new OGRArrowDataset(pszName, true);
+}
+
+/************************************************************************/
+/*                              GetLayer()                              */
+/************************************************************************/
+
+OGRLayer *OGRArrowDataset::GetLayer( int iLayer )
+{
+    if( iLayer < 0 || iLayer >= GetLayerCount() )
+        return nullptr;
+    return m_poLayer.get();
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRArrowDataset::TestCapability( const char *pszCap )
+{
+    if( EQUAL(pszCap, ODsCCreateLayer) )
+        return m_bCreate && m_poLayer == nullptr;
+    return FALSE;
+}
+
+/************************************************************************/
+/*                            ICreateLayer()                            */
+/************************************************************************/
+
+OGRLayer *OGRArrowDataset::ICreateLayer( const char *pszName,
+                                         OGRSpatialReference *poSRS,
+                                         OGRwkbGeometryType eGType,
+                                         char ** papszOptions )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Data source %s opened read-only", GetDescription());
+        return nullptr;
+    }
+    if( m_poLayer )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "An Arrow file can only hold a single layer");
+        return nullptr;
+    }
+
+    m_poLayer.reset(OGRArrowLayer::Create(GetDescription(), pszName, poSRS,
+                                          eGType, papszOptions));
+    return m_poLayer.get();
+}
+
+/************************************************************************/
+/*                         RegisterOGRArrow()                           */
+/************************************************************************/
+
+void RegisterOGRArrow()
+{
+    if( GDALGetDriverByName( "Arrow" ) != nullptr )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( "Arrow" );
+    poDriver->SetMetadataItem( GDAL_DCAP_VECTOR, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "Apache Arrow IPC" );
+    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "arrow" );
+    poDriver->SetMetadataItem( GDAL_DMD_EXTENSIONS, "arrow arrows feather" );
+    poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drv_arrow.html" );
+
+    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+"<OpenOptionList>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads decoding the record batches. Integer or ALL_CPUS' default='1'/>"
+"  <Option name='FID' type='string' description='Name of the integer column to use as FID'/>"
+"</OpenOptionList>");
+
+    poDriver->SetMetadataItem( GDAL_DS_LAYER_CREATIONOPTIONLIST,
+"<LayerCreationOptionList>"
+"  <Option name='FORMAT' type='string-select' description='File or stream format. Defaults to STREAM for the .arrows extension, FILE otherwise'>"
+"    <Value>FILE</Value>"
+"    <Value>STREAM</Value>"
+"  </Option>"
+"  <Option name='BATCH_SIZE' type='int' description='Maximum number of rows per record batch' default='65536'/>"
+"  <Option name='GEOMETRY_NAME' type='string' description='Name of the geometry column' default='geometry'/>"
+"  <Option name='FID' type='string' description='Name of the FID column to create. None by default'/>"
+"</LayerCreationOptionList>");
+
+    poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATATYPES,
+                               "Integer Integer64 Real String Date Time "
+                               "DateTime Binary IntegerList Integer64List "
+                               "RealList StringList" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATASUBTYPES,
+                               "Boolean Int16 Float32" );
+
+    poDriver->pfnOpen = OGRArrowDataset::Open;
+    poDriver->pfnIdentify = OGRArrowDataset::Identify;
+    poDriver->pfnCreate = OGRArrowDataset::Create;
+
+    GetGDALDriverManager()->RegisterDriver( poDriver );
+}
@@ -0,0 +1,2844 @@
+/******************************************************************************
+ *
+ * Project:  Arrow driver
+ * Purpose:  Implements OGRArrowLayer: reading and writing of a table in the
+ *           Arrow IPC file and stream formats.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_arrow.h"
+
+#include "cpl_json.h"
+#include "cpl_time.h"
+#include "ogr_p.h"
+#include "swq.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <limits>
+
+CPL_CVSID("$Id$")
+
+using namespace ArrowIPC;
+using FlatGeobuf::Table;
+
+// Rows decoded by a job of GetNextFeature().
+constexpr GIntBig ROWS_PER_JOB = 16384;
+
+// Ranges of a record batch body closer than this are read at once.
+constexpr GIntBig MAX_READ_GAP = 4096;
+
+// Record batch blocks whose metadata is read with a single multi range read.
+constexpr size_t BLOCKS_PER_READ = 1000;
+
+constexpr int DEFAULT_BATCH_SIZE = 65536;
+
+// Keys of the schema and record batch metadata.
+static const char* const GEO_METADATA_KEY = "geo";
+static const char* const FID_METADATA_KEY = "gdal:fid";
+static const char* const STATISTICS_METADATA_KEY = "gdal:statistics";
+
+template<class T> static T ReadLE( const GByte* pabyData )
+{
+    T nVal;
+    memcpy(&nVal, pabyData, sizeof(T));
+    SwapToLSB(&nVal);
+    return nVal;
+}
+
+template<class T> static void WriteLE( GByte* pabyData, T nVal )
+{
+    SwapToLSB(&nVal);
+    memcpy(pabyData, &nVal, sizeof(T));
+}
+
+static const char* GetKeyValue( const KeyValueList& aoList,
+                                const char* pszKey )
+{
+    for( const auto& oKV: aoList )
+    {
+        if( oKV.first == pszKey )
+            return oKV.second.c_str();
+    }
+    return nullptr;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        Decoding of the values                        */
+/* ==================================================================== */
+/************************************************************************/
+
+typedef OGRArrowLayer::ArrayView ArrayView;
+
+// Values are in native order, files of the other endianness being rejected.
+template<class T> static inline T GetValue( const ArrayView& oView,
+                                            GIntBig i )
+{
+    T nVal;
+    memcpy(&nVal, oView.pabyValues + static_cast<size_t>(i) * sizeof(T),
+           sizeof(T));
+    return nVal;
+}
+
+static inline bool GetBit( const GByte* pabyBits, GIntBig i )
+{
+    return (pabyBits[i >> 3] & (1 << (i & 7))) != 0;
+}
+
+static bool HasLargeOffsets( const FieldDesc& oField )
+{
+    return oField.eType == Type::LargeBinary ||
+           oField.eType == Type::LargeUtf8 ||
+           oField.eType == Type::LargeList;
+}
+
+static bool HasOffsets( const FieldDesc& oField )
+{
+    switch( oField.eType )
+    {
+        case Type::Binary:
+        case Type::Utf8:
+        case Type::List:
+        case Type::LargeBinary:
+        case Type::LargeUtf8:
+        case Type::LargeList:
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+static inline GIntBig GetOffset( const ArrayView& oView, GIntBig i )
+{
+    return HasLargeOffsets(*oView.psField) ?
+        static_cast<GIntBig>(GetValue<int64_t>(oView, i)) :
+        static_cast<GIntBig>(GetValue<int32_t>(oView, i));
+}
+
+// Range of an item of a variable width or list array, in its data or in
+// its child array.
+static inline void GetRange( const ArrayView& oView, GIntBig i,
+                             GIntBig& nStart, GIntBig& nEnd )
+{
+    if( oView.psField->eType == Type::FixedSizeList )
+    {
+        nStart = i * oView.psField->nByteWidth;
+        nEnd = nStart + oView.psField->nByteWidth;
+        return;
+    }
+    nStart = GetOffset(oView, i);
+    nEnd = GetOffset(oView, i + 1);
+}
+
+/************************************************************************/
+/*                           GetValueSize()                             */
+/*                                                                      */
+/*      Size in bytes of the values of fixed width types, -1 for the    */
+/*      bit-packed booleans and 0 for the other types.                  */
+/************************************************************************/
+
+static int GetValueSize( const FieldDesc& oField )
+{
+    switch( oField.eType )
+    {
+        case Type::Int:
+        case Type::Decimal:
+        case Type::Time:
+            return oField.nBitWidth / 8;
+        case Type::Bool:
+            return -1;
+        case Type::FloatingPoint:
+            return oField.nPrecision == Precision::HALF ? 2 :
+                   oField.nPrecision == Precision::SINGLE ? 4 : 8;
+        case Type::Date:
+            return oField.nUnit == DateUnit::DAY ? 4 : 8;
+        case Type::Timestamp:
+        case Type::Duration:
+            return 8;
+        case Type::FixedSizeBinary:
+            return oField.nByteWidth;
+        default:
+            break;
+    }
+    return 0;
+}
+
+static GIntBig GetIntegerValue( const ArrayView& oView, GIntBig i )
+{
+    const FieldDesc& oField = *oView.psField;
+    switch( oField.nBitWidth )
+    {
+        case 8:
+            return oField.bSigned ? GetValue<int8_t>(oView, i) :
+                                    GetValue<uint8_t>(oView, i);
+        case 16:
+            return oField.bSigned ? GetValue<int16_t>(oView, i) :
+                                    GetValue<uint16_t>(oView, i);
+        case 32:
+            return oField.bSigned ? GetValue<int32_t>(oView, i) :
+                                    GetValue<uint32_t>(oView, i);
+        default:
+            // Unsigned values above the int64 range wrap.
+            return static_cast<GIntBig>(GetValue<uint64_t>(oView, i));
+    }
+}
+
+static double HalfToDouble( uint16_t nHalf )
+{
+    const int nExponent = (nHalf >> 10) & 0x1f;
+    const int nMantissa = nHalf & 0x3ff;
+    double dfVal;
+    if( nExponent == 0 )
+        dfVal = ldexp(nMantissa, -24);
+    else if( nExponent == 31 )
+        dfVal = nMantissa ? std::numeric_limits<double>::quiet_NaN() :
+                            std::numeric_limits<double>::infinity();
+    else
+        dfVal = ldexp(nMantissa + 1024, nExponent - 25);
+    return (nHalf & 0x8000) ? -dfVal : dfVal;
+}
+
+static double GetRealValue( const ArrayView& oView, GIntBig i )
+{
+    const FieldDesc& oField = *oView.psField;
+    if( oField.eType == Type::Decimal )
+    {
+        // 128 bit two's complement integer, scaled.
+        const GByte* pabyVal = oView.pabyValues + static_cast<size_t>(i) * 16;
+        uint64_t nLow;
+        int64_t nHigh;
+#ifdef CPL_MSB
+        memcpy(&nHigh, pabyVal, 8);
+        memcpy(&nLow, pabyVal + 8, 8);
+#else
+        memcpy(&nLow, pabyVal, 8);
+        memcpy(&nHigh, pabyVal + 8, 8);
+#endif
+        const double dfVal =
+            static_cast<double>(nHigh) * 18446744073709551616.0 +
+            static_cast<double>(nLow);
+        return dfVal / pow(10.0, oField.nScale);
+    }
+    if( oField.eType == Type::Int )
+        return static_cast<double>(GetIntegerValue(oView, i));
+    switch( oField.nPrecision )
+    {
+        case Precision::HALF:
+            return HalfToDouble(GetValue<uint16_t>(oView, i));
+        case Precision::SINGLE:
+            return GetValue<float>(oView, i);
+        default:
+            return GetValue<double>(oView, i);
+    }
+}
+
+static GIntBig FloorDiv( GIntBig nVal, GIntBig nDivisor )
+{
+    GIntBig nQuotient = nVal / nDivisor;
+    if( nVal % nDivisor != 0 && nVal < 0 )
+        nQuotient--;
+    return nQuotient;
+}
+
+static GIntBig GetUnitsPerSecond( int nUnit )
+{
+    switch( nUnit )
+    {
+        case TimeUnit::MILLISECOND: return 1000;
+        case TimeUnit::MICROSECOND: return 1000 * 1000;
+        case TimeUnit::NANOSECOND: return 1000 * 1000 * 1000;
+        default: return 1;
+    }
+}
+
+static void SetDateTime( OGRField& sField, GIntBig nUnits,
+                         GIntBig nUnitsPerSecond, int nTZFlag )
+{
+    const GIntBig nSeconds = FloorDiv(nUnits, nUnitsPerSecond);
+    struct tm brokendowntime;
+    CPLUnixTimeToYMDHMS(nSeconds, &brokendowntime);
+    sField.Date.Year = static_cast<GInt16>(brokendowntime.tm_year + 1900);
+    sField.Date.Month = static_cast<GByte>(brokendowntime.tm_mon + 1);
+    sField.Date.Day = static_cast<GByte>(brokendowntime.tm_mday);
+    sField.Date.Hour = static_cast<GByte>(brokendowntime.tm_hour);
+    sField.Date.Minute = static_cast<GByte>(brokendowntime.tm_min);
+    sField.Date.Second = static_cast<float>(
+        brokendowntime.tm_sec +
+        static_cast<double>(nUnits - nSeconds * nUnitsPerSecond) /
+                                                        nUnitsPerSecond);
+    sField.Date.TZFlag = static_cast<GByte>(nTZFlag);
+    sField.Date.Reserved = 0;
+}
+
+static void GetDateTimeValue( const ArrayView& oView, GIntBig i,
+                              OGRField& sField )
+{
+    const FieldDesc& oField = *oView.psField;
+    switch( oField.eType )
+    {
+        case Type::Date:
+            if( oField.nUnit == DateUnit::DAY )
+                SetDateTime(sField, GetValue<int32_t>(oView, i), 1, 0);
+            else
+                SetDateTime(sField, GetValue<int64_t>(oView, i), 1000, 0);
+            sField.Date.Hour = 0;
+            sField.Date.Minute = 0;
+            sField.Date.Second = 0.0f;
+            break;
+
+        case Type::Time:
+        {
+            const GIntBig nUnits = oField.nBitWidth == 32 ?
+                GetValue<int32_t>(oView, i) : GetValue<int64_t>(oView, i);
+            const GIntBig nPerSecond = GetUnitsPerSecond(oField.nUnit);
+            const GIntBig nSeconds = FloorDiv(nUnits, nPerSecond);
+            sField.Date.Year = 0;
+            sField.Date.Month = 0;
+            sField.Date.Day = 0;
+            sField.Date.Hour = static_cast<GByte>((nSeconds / 3600) % 24);
+            sField.Date.Minute = static_cast<GByte>((nSeconds / 60) % 60);
+            sField.Date.Second = static_cast<float>(
+                nSeconds % 60 +
+                static_cast<double>(nUnits - nSeconds * nPerSecond) /
+                                                            nPerSecond);
+            sField.Date.TZFlag = 0;
+            sField.Date.Reserved = 0;
+            break;
+        }
+
+        default:
+            // Timestamps with a time zone are instants, shown in UTC.
+            SetDateTime(sField, GetValue<int64_t>(oView, i),
+                        GetUnitsPerSecond(oField.nUnit),
+                        oField.osTimezone.empty() ? 0 : 100);
+            break;
+    }
+}
+
+/************************************************************************/
+/*                          GetOGRFieldType()                           */
+/************************************************************************/
+
+static bool GetOGRFieldType( const FieldDesc& oField, OGRFieldType& eType,
+                             OGRFieldSubType& eSubType )
+{
+    eSubType = OFSTNone;
+    if( oField.bDictionaryEncoded )
+        return false;
+
+    switch( oField.eType )
+    {
+        case Type::Int:
+            if( oField.nBitWidth != 8 && oField.nBitWidth != 16 &&
+                oField.nBitWidth != 32 && oField.nBitWidth != 64 )
+                return false;
+            eType = oField.nBitWidth == 64 ||
+                    (oField.nBitWidth == 32 && !oField.bSigned) ?
+                                                OFTInteger64 : OFTInteger;
+            if( oField.nBitWidth == 16 && oField.bSigned )
+                eSubType = OFSTInt16;
+            return true;
+        case Type::Bool:
+            eType = OFTInteger;
+            eSubType = OFSTBoolean;
+            return true;
+        case Type::FloatingPoint:
+            eType = OFTReal;
+            if( oField.nPrecision != Precision::DOUBLE )
+                eSubType = OFSTFloat32;
+            return true;
+        case Type::Decimal:
+            eType = OFTReal;
+            return oField.nBitWidth == 128;
+        case Type::Utf8:
+        case Type::LargeUtf8:
+            eType = OFTString;
+            return true;
+        case Type::Binary:
+        case Type::LargeBinary:
+        case Type::FixedSizeBinary:
+            eType = OFTBinary;
+            return true;
+        case Type::Date:
+            eType = OFTDate;
+            return true;
+        case Type::Time:
+            eType = OFTTime;
+            return oField.nBitWidth == 32 || oField.nBitWidth == 64;
+        case Type::Timestamp:
+            eType = OFTDateTime;
+            return true;
+        case Type::Duration:
+            eType = OFTInteger64;
+            return true;
+        case Type::List:
+        case Type::LargeList:
+        case Type::FixedSizeList:
+        {
+            if( oField.aoChildren.size() != 1 )
+                return false;
+            OGRFieldType eChildType;
+            if( !GetOGRFieldType(oField.aoChildren[0], eChildType, eSubType) )
+                return false;
+            switch( oField.aoChildren[0].eType )
+            {
+                case Type::Int:
+                case Type::Bool:
+                    eType = eChildType == OFTInteger ? OFTIntegerList :
+                                                       OFTInteger64List;
+                    return true;
+                case Type::FloatingPoint:
+                case Type::Decimal:
+                    eType = OFTRealList;
+                    return true;
+                case Type::Utf8:
+                case Type::LargeUtf8:
+                    eType = OFTStringList;
+                    return true;
+                default:
+                    break;
+            }
+            return false;
+        }
+        default:
+            break;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                             BuildView()                              */
+/*                                                                      */
+/*      Locates and validates the buffers of a column, and of its       */
+/*      children for lists. pabyBase holds the bytes of the body from   */
+/*      nBaseOffset.                                                    */
+/************************************************************************/
+
+static bool BuildView( const FieldDesc& oField,
+                       const OGRArrowLayer::BatchInfo& oBatch, int nVersion,
+                       int& iNode, int& iBuffer,
+                       const GByte* pabyBase, GIntBig nBaseOffset,
+                       ArrayView& oView )
+{
+    if( iNode >= static_cast<int>(oBatch.aoNodes.size()) )
+        return false;
+    const FieldNode& sNode = oBatch.aoNodes[iNode++];
+    const int nBuffers = oField.GetBufferCount(nVersion);
+    if( nBuffers < 1 ||
+        iBuffer + nBuffers > static_cast<int>(oBatch.aoBuffers.size()) )
+        return false;
+    const ArrowIPC::Buffer* pasBuffers = &oBatch.aoBuffers[iBuffer];
+    iBuffer += nBuffers;
+
+    constexpr GIntBig nMaxLength = std::numeric_limits<GIntBig>::max() / 32;
+    const GIntBig nLength = sNode.nLength;
+    if( nLength < 0 || nLength > nMaxLength ||
+        sNode.nNullCount < 0 || sNode.nNullCount > nLength )
+        return false;
+
+    const auto GetBuffer = [pasBuffers, pabyBase, nBaseOffset](
+                                    int i, size_t& nSize) -> const GByte*
+    {
+        nSize = static_cast<size_t>(pasBuffers[i].nLength);
+        return nSize ? pabyBase + (pasBuffers[i].nOffset - nBaseOffset) :
+                       nullptr;
+    };
+
+    oView.psField = &oField;
+    oView.nLength = nLength;
+
+    size_t nSize = 0;
+    const GByte* pabyValidity = GetBuffer(0, nSize);
+    if( sNode.nNullCount > 0 )
+    {
+        if( nSize < static_cast<size_t>((nLength + 7) / 8) )
+            return false;
+        oView.pabyValidity = pabyValidity;
+    }
+
+    if( oField.eType == Type::FixedSizeList )
+    {
+        oView.aoChildren.resize(1);
+        if( !BuildView(oField.aoChildren[0], oBatch, nVersion, iNode,
+                       iBuffer, pabyBase, nBaseOffset, oView.aoChildren[0]) )
+            return false;
+        return oField.nByteWidth >= 0 &&
+               (oField.nByteWidth == 0 ||
+                oView.aoChildren[0].nLength / oField.nByteWidth >= nLength);
+    }
+
+    if( HasOffsets(oField) )
+    {
+        if( nBuffers < 2 )
+            return false;
+        oView.pabyValues = GetBuffer(1, oView.nValuesSize);
+        GIntBig nLimit = 0;
+        if( oField.eType == Type::List || oField.eType == Type::LargeList )
+        {
+            oView.aoChildren.resize(1);
+            if( !BuildView(oField.aoChildren[0], oBatch, nVersion, iNode,
+                           iBuffer, pabyBase, nBaseOffset,
+                           oView.aoChildren[0]) )
+                return false;
+            nLimit = oView.aoChildren[0].nLength;
+        }
+        else
+        {
+            if( nBuffers < 3 )
+                return false;
+            oView.pabyData = GetBuffer(2, oView.nDataSize);
+            nLimit = static_cast<GIntBig>(oView.nDataSize);
+        }
+        if( nLength == 0 )
+            return true;
+
+        const size_t nOffsetSize = HasLargeOffsets(oField) ? 8 : 4;
+        if( oView.nValuesSize / nOffsetSize <
+                                static_cast<size_t>(nLength + 1) )
+            return false;
+        GIntBig nPrev = GetOffset(oView, 0);
+        if( nPrev < 0 )
+            return false;
+        for( GIntBig i = 1; i <= nLength; i++ )
+        {
+            const GIntBig nCur = GetOffset(oView, i);
+            if( nCur < nPrev )
+                return false;
+            nPrev = nCur;
+        }
+        return nPrev <= nLimit;
+    }
+
+    const int nValueSize = GetValueSize(oField);
+    if( nValueSize == 0 || nBuffers < 2 )
+        return false;
+    oView.pabyValues = GetBuffer(1, oView.nValuesSize);
+    const GIntBig nRequired =
+        nValueSize < 0 ? (nLength + 7) / 8 : nLength * nValueSize;
+    return static_cast<GIntBig>(oView.nValuesSize) >= nRequired;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                            OGRArrowLayer                             */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                           OGRArrowLayer()                            */
+/************************************************************************/
+
+OGRArrowLayer::OGRArrowLayer()
+{
+    memset(&m_sSchema, 0, sizeof(m_sSchema));
+}
+
+/************************************************************************/
+/*                           ~OGRArrowLayer()                           */
+/************************************************************************/
+
+OGRArrowLayer::~OGRArrowLayer()
+{
+    if( m_bCreate )
+        Finalize();
+    ClearReadBuffers();
+    if( m_sSchema.release )
+        m_sSchema.release(&m_sSchema);
+    if( m_poFp )
+        VSIFCloseL(m_poFp);
+    if( m_poFeatureDefn )
+        m_poFeatureDefn->Release();
+}
+
+/************************************************************************/
+/*                          ReadFileTrailer()                           */
+/************************************************************************/
+
+bool OGRArrowLayer::ReadFileTrailer( std::vector<GByte>& abyFooter )
+{
+    constexpr size_t nTrailerSize = sizeof(int32_t) + nMagicBytesSize;
+    GByte abyTrailer[nTrailerSize];
+    if( VSIFSeekL(m_poFp, 0, SEEK_END) != 0 )
+        return false;
+    const vsi_l_offset nFileSize = VSIFTellL(m_poFp);
+    if( nFileSize < nFileHeaderSize + nTrailerSize ||
+        VSIFSeekL(m_poFp, nFileSize - nTrailerSize, SEEK_SET) != 0 ||
+        VSIFReadL(abyTrailer, nTrailerSize, 1, m_poFp) != 1 ||
+        memcmp(abyTrailer + sizeof(int32_t), abyMagicBytes,
+               nMagicBytesSize) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s: missing Arrow file trailer", m_osFilename.c_str());
+        return false;
+    }
+
+    const int32_t nFooterSize = ReadLE<int32_t>(abyTrailer);
+    if( nFooterSize <= 0 ||
+        static_cast<uint32_t>(nFooterSize) > nMaxMetadataSize ||
+        static_cast<vsi_l_offset>(nFooterSize) >
+                            nFileSize - nTrailerSize - nFileHeaderSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s: invalid footer size %d", m_osFilename.c_str(),
+                 nFooterSize);
+        return false;
+    }
+
+    abyFooter.resize(nFooterSize);
+    if( VSIFSeekL(m_poFp, nFileSize - nTrailerSize - nFooterSize,
+                  SEEK_SET) != 0 ||
+        VSIFReadL(abyFooter.data(), nFooterSize, 1, m_poFp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "%s: cannot read footer",
+                 m_osFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                         ReadStreamMessage()                          */
+/*                                                                      */
+/*      Reads the Message table at nOffset, and advances nOffset to     */
+/*      its body. bEOS is set at the end of the stream.                 */
+/************************************************************************/
+
+bool OGRArrowLayer::ReadStreamMessage( vsi_l_offset& nOffset,
+                                       std::vector<GByte>& abyMessage,
+                                       bool& bEOS )
+{
+    bEOS = false;
+    GByte abyPrefix[8];
+    if( VSIFSeekL(m_poFp, nOffset, SEEK_SET) != 0 )
+        return false;
+    if( VSIFReadL(abyPrefix, 4, 1, m_poFp) != 1 )
+    {
+        // The end of stream marker is optional.
+        bEOS = true;
+        return true;
+    }
+    size_t nPrefixSize = 4;
+    int32_t nSize = ReadLE<int32_t>(abyPrefix);
+    if( static_cast<uint32_t>(nSize) == nContinuationMarker )
+    {
+        // Before V0.15, the marker was absent.
+        if( VSIFReadL(abyPrefix + 4, 4, 1, m_poFp) != 1 )
+        {
+            bEOS = true;
+            return true;
+        }
+        nPrefixSize = 8;
+        nSize = ReadLE<int32_t>(abyPrefix + 4);
+    }
+    if( nSize == 0 )
+    {
+        bEOS = true;
+        return true;
+    }
+    if( nSize < 0 || static_cast<uint32_t>(nSize) > nMaxMetadataSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s: invalid message size %d at offset " CPL_FRMT_GUIB,
+                 m_osFilename.c_str(), nSize,
+                 static_cast<GUIntBig>(nOffset));
+        return false;
+    }
+
+    abyMessage.resize(nSize);
+    if( VSIFReadL(abyMessage.data(), nSize, 1, m_poFp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "%s: cannot read message at offset " CPL_FRMT_GUIB,
+                 m_osFilename.c_str(), static_cast<GUIntBig>(nOffset));
+        return false;
+    }
+    nOffset += nPrefixSize + nSize;
+    return true;
+}
+
+/************************************************************************/
+/*                          ReadBatchMessage()                          */
+/*                                                                      */
+/*      Decodes a RecordBatch message, whose body starts at             */
+/*      oBatch.nBodyOffset.                                             */
+/************************************************************************/
+
+bool OGRArrowLayer::ReadBatchMessage( const GByte* pabyMessage, size_t nSize,
+                                      GIntBig nBlockBodyLength,
+                                      BatchInfo& oBatch )
+{
+    const Table oMessage = Table::GetRoot(pabyMessage, nSize);
+    if( !oMessage.IsValid() ||
+        static_cast<MessageHeader>(oMessage.GetScalar<GByte>(
+            Message::header_type, 0)) != MessageHeader::RecordBatch )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s: record batch %d is not a RecordBatch message",
+                 m_osFilename.c_str(),
+                 static_cast<int>(m_aoBatches.size()));
+        return false;
+    }
+
+    oBatch.nBodyLength = oMessage.GetScalar<int64_t>(Message::bodyLength, 0);
+    if( oBatch.nBodyLength < 0 ||
+        (nBlockBodyLength >= 0 && oBatch.nBodyLength > nBlockBodyLength) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s: invalid body length of record batch %d",
+                 m_osFilename.c_str(),
+                 static_cast<int>(m_aoBatches.size()));
+        return false;
+    }
+
+    if( !ReadRecordBatch(oMessage.GetTable(Message::header), oBatch.nRows,
+                         oBatch.aoNodes, oBatch.aoBuffers) )
+        return false;
+    if( static_cast<int>(oBatch.aoNodes.size()) != m_nNodeCount ||
+        static_cast<int>(oBatch.aoBuffers.size()) != m_nBufferCount )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s: record batch %d does not match the schema",
+                 m_osFilename.c_str(),
+                 static_cast<int>(m_aoBatches.size()));
+        return false;
+    }
+    for( const auto& sBuffer: oBatch.aoBuffers )
+    {
+        if( sBuffer.nLength > oBatch.nBodyLength - sBuffer.nOffset )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "%s: buffer out of the body of record batch %d",
+                     m_osFilename.c_str(),
+                     static_cast<int>(m_aoBatches.size()));
+            return false;
+        }
+    }
+
+    KeyValueList aoMetadata;
+    ReadKeyValues(oMessage, Message::custom_metadata, aoMetadata);
+    const char* pszStats = GetKeyValue(aoMetadata, STATISTICS_METADATA_KEY);
+    if( pszStats )
+        ReadStatistics(pszStats, oBatch);
+
+    oBatch.nFirstRow = m_nTotalRows;
+    m_nTotalRows += oBatch.nRows;
+    return true;
+}
+
+/************************************************************************/
+/*                          ScanFileBatches()                           */
+/*                                                                      */
+/*      The metadata of the record batches listed by the footer is      */
+/*      read in a few multi range requests, which matters on network    */
+/*      file systems.                                                   */
+/************************************************************************/
+
+bool OGRArrowLayer::ScanFileBatches( const std::vector<Block>& aoBlocks )
+{
+    std::vector<std::vector<GByte>> aabyMessages;
+    std::vector<void*> apData;
+    std::vector<vsi_l_offset> anOffsets;
+    std::vector<size_t> anSizes;
+    for( size_t iStart = 0; iStart < aoBlocks.size();
+                                            iStart += BLOCKS_PER_READ )
+    {
+        const size_t nCount =
+            std::min(BLOCKS_PER_READ, aoBlocks.size() - iStart);
+        aabyMessages.resize(nCount);
+        apData.resize(nCount);
+        anOffsets.resize(nCount);
+        anSizes.resize(nCount);
+        for( size_t i = 0; i < nCount; i++ )
+        {
+            const Block& sBlock = aoBlocks[iStart + i];
+            if( static_cast<uint32_t>(sBlock.nMetaDataLength) >
+                                                    nMaxMetadataSize + 8 )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "%s: invalid metadata length of record batch %d",
+                         m_osFilename.c_str(),
+                         static_cast<int>(iStart + i));
+                return false;
+            }
+            aabyMessages[i].resize(sBlock.nMetaDataLength);
+            apData[i] = aabyMessages[i].data();
+            anOffsets[i] = static_cast<vsi_l_offset>(sBlock.nOffset);
+            anSizes[i] = static_cast<size_t>(sBlock.nMetaDataLength);
+        }
+        if( VSIFReadMultiRangeL(static_cast<int>(nCount), apData.data(),
+                                anOffsets.data(), anSizes.data(),
+                                m_poFp) != 0 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "%s: cannot read record batch metadata",
+                     m_osFilename.c_str());
+            return false;
+        }
+
+        for( size_t i = 0; i < nCount; i++ )
+        {
+            const Block& sBlock = aoBlocks[iStart + i];
+            const GByte* pabyBlock = aabyMessages[i].data();
+            const size_t nBlockSize = aabyMessages[i].size();
+            size_t nPrefixSize = 4;
+            if( nBlockSize >= 8 &&
+                ReadLE<uint32_t>(pabyBlock) == nContinuationMarker )
+                nPrefixSize = 8;
+            const int32_t nMessageSize = nBlockSize >= nPrefixSize ?
+                ReadLE<int32_t>(pabyBlock + nPrefixSize - 4) : -1;
+            if( nMessageSize <= 0 ||
+                static_cast<size_t>(nMessageSize) > nBlockSize - nPrefixSize )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "%s: invalid metadata of record batch %d",
+                         m_osFilename.c_str(),
+                         static_cast<int>(iStart + i));
+                return false;
+            }
+
+            BatchInfo oBatch;
+            oBatch.nBodyOffset =
+                static_cast<vsi_l_offset>(sBlock.nOffset) + nBlockSize;
+            if( !ReadBatchMessage(pabyBlock + nPrefixSize, nMessageSize,
+                                  sBlock.nBodyLength, oBatch) )
+                return false;
+            m_aoBatches.push_back(std::move(oBatch));
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                         ScanStreamBatches()                          */
+/************************************************************************/
+
+bool OGRArrowLayer::ScanStreamBatches( vsi_l_offset nOffset )
+{
+    std::vector<GByte> abyMessage;
+    while( true )
+    {
+        bool bEOS = false;
+        if( !ReadStreamMessage(nOffset, abyMessage, bEOS) )
+            return false;
+        if( bEOS )
+            return true;
+
+        const Table oMessage =
+            Table::GetRoot(abyMessage.data(), abyMessage.size());
+        const auto eHeader = static_cast<MessageHeader>(
+            oMessage.GetScalar<GByte>(Message::header_type, 0));
+        const GIntBig nBodyLength =
+            oMessage.GetScalar<int64_t>(Message::bodyLength, 0);
+        if( !oMessage.IsValid() || nBodyLength < 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "%s: invalid message at offset " CPL_FRMT_GUIB,
+                     m_osFilename.c_str(), static_cast<GUIntBig>(nOffset));
+            return false;
+        }
+        if( eHeader == MessageHeader::Schema )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "%s: unexpected schema message", m_osFilename.c_str());
+            return false;
+        }
+        if( eHeader == MessageHeader::RecordBatch )
+        {
+            BatchInfo oBatch;
+            oBatch.nBodyOffset = nOffset;
+            if( !ReadBatchMessage(abyMessage.data(), abyMessage.size(), -1,
+                                  oBatch) )
+                return false;
+            m_aoBatches.push_back(std::move(oBatch));
+        }
+        // Dictionary batches are skipped: dictionary encoded columns
+        // are not exposed.
+        nOffset += static_cast<vsi_l_offset>(nBodyLength);
+    }
+}
+
+/************************************************************************/
+/*                           BuildLayerDefn()                           */
+/*                                                                      */
+/*      Geometry columns are WKB columns listed by the "geo" metadata   */
+/*      of GeoParquet, or tagged with a WKB extension type, or, if      */
+/*      there are none of those, binary columns with the usual          */
+/*      geometry column names of GDAL.                                  */
+/************************************************************************/
+
+bool OGRArrowLayer::BuildLayerDefn( const KeyValueList& aoMetadata,
+                                    CSLConstList papszOpenOptions )
+{
+    const char* pszLayerName = CPLGetBasename(m_osFilename.c_str());
+    m_poFeatureDefn = new OGRFeatureDefn(pszLayerName);
+    SetDescription(pszLayerName);
+    m_poFeatureDefn->Reference();
+    m_poFeatureDefn->SetGeomType(wkbNone);
+
+    CPLJSONDocument oGeoDoc;
+    CPLJSONObject oGeoColumns;
+    const char* pszGeo = GetKeyValue(aoMetadata, GEO_METADATA_KEY);
+    if( pszGeo && oGeoDoc.LoadMemory(pszGeo) )
+        oGeoColumns = oGeoDoc.GetRoot().GetObj("columns");
+    std::vector<CPLJSONObject> aoGeoColumns;
+    if( oGeoColumns.GetType() == CPLJSONObject::Object )
+        aoGeoColumns = oGeoColumns.GetChildren();
+
+    const auto GetGeoColumn = [&aoGeoColumns](const std::string& osName)
+                                                    -> const CPLJSONObject*
+    {
+        for( const auto& oCol: aoGeoColumns )
+        {
+            if( oCol.GetName() == osName &&
+                EQUAL(oCol.GetString("encoding", "WKB").c_str(), "WKB") )
+                return &oCol;
+        }
+        return nullptr;
+    };
+    const auto IsWKBExtension = [](const FieldDesc& oField)
+    {
+        const char* pszExt = oField.GetMetadataItem("ARROW:extension:name");
+        return pszExt != nullptr &&
+               (EQUAL(pszExt, "ogc.wkb") || EQUAL(pszExt, "geoarrow.wkb"));
+    };
+    const auto IsBinary = [](const FieldDesc& oField)
+    {
+        return !oField.bDictionaryEncoded &&
+               (oField.eType == Type::Binary ||
+                oField.eType == Type::LargeBinary);
+    };
+
+    bool bHasExplicitGeom = false;
+    for( const auto& oField: m_aoFields )
+    {
+        if( IsBinary(oField) &&
+            (GetGeoColumn(oField.osName) != nullptr || IsWKBExtension(oField)) )
+            bHasExplicitGeom = true;
+    }
+
+    const char* pszFID = CSLFetchNameValueDef(papszOpenOptions, "FID",
+        GetKeyValue(aoMetadata, FID_METADATA_KEY));
+
+    int iNode = 0;
+    int iBuffer = 0;
+    for( const auto& oField: m_aoFields )
+    {
+        const int nBuffers = oField.GetTotalBufferCount(m_nVersion);
+        if( nBuffers < 0 )
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "%s: unsupported type of field %s",
+                     m_osFilename.c_str(), oField.osName.c_str());
+            return false;
+        }
+        ColumnInfo oCol;
+        oCol.iFirstNode = iNode;
+        oCol.iFirstBuffer = iBuffer;
+        iNode += oField.GetTotalNodeCount();
+        iBuffer += nBuffers;
+        const int iCol = static_cast<int>(m_aoColumns.size());
+
+        if( pszFID && m_iFIDColumn < 0 && oField.osName == pszFID &&
+            oField.eType == Type::Int && !oField.bDictionaryEncoded &&
+            (oField.nBitWidth == 32 || oField.nBitWidth == 64) )
+        {
+            m_iFIDColumn = iCol;
+            m_aoColumns.push_back(oCol);
+            continue;
+        }
+
+        const CPLJSONObject* poGeoCol = GetGeoColumn(oField.osName);
+        if( IsBinary(oField) &&
+            (poGeoCol != nullptr || IsWKBExtension(oField) ||
+             (!bHasExplicitGeom &&
+              (EQUAL(oField.osName.c_str(), "geometry") ||
+               EQUAL(oField.osName.c_str(), "wkb_geometry")))) )
+        {
+            const CPLJSONObject oGeoCol =
+                poGeoCol ? *poGeoCol : CPLJSONObject();
+            OGRwkbGeometryType eGType = wkbUnknown;
+            CPLJSONArray oTypes = oGeoCol.GetArray("geometry_types");
+            if( !oTypes.IsValid() )
+                oTypes = oGeoCol.GetArray("geometry_type");
+            const std::string osType = oTypes.IsValid() && oTypes.Size() == 1 ?
+                oTypes[0].ToString() : oGeoCol.GetString("geometry_type");
+            if( !osType.empty() )
+                eGType = OGRFromOGCGeomType(osType.c_str());
+
+            OGRGeomFieldDefn oGeomField(oField.osName.c_str(), eGType);
+            oGeomField.SetNullable(oField.bNullable);
+
+            OGRSpatialReference* poSRS = nullptr;
+            if( poGeoCol != nullptr )
+            {
+                // A null crs is undefined, and GetObj() cannot tell it
+                // from a missing one.
+                bool bHasCRS = false;
+                for( const auto& oChild: oGeoCol.GetChildren() )
+                {
+                    if( oChild.GetName() == "crs" )
+                        bHasCRS = true;
+                }
+                const CPLJSONObject oCRS = oGeoCol.GetObj("crs");
+                std::string osCRS;
+                if( oCRS.GetType() == CPLJSONObject::String )
+                    osCRS = oCRS.ToString();
+                else if( oCRS.GetType() == CPLJSONObject::Object )
+                {
+                    // PROJJSON: its identifier is enough for the common
+                    // cases.
+                    const CPLJSONObject oId = oCRS.GetObj("id");
+                    if( oId.IsValid() )
+                        osCRS = oId.GetString("authority") + ":" +
+                                oId.GetString("code");
+                    else
+                        osCRS = oCRS.Format(CPLJSONObject::Plain);
+                }
+                else if( !bHasCRS )
+                {
+                    // A missing crs means OGC:CRS84.
+                    osCRS = "EPSG:4326";
+                }
+                if( !osCRS.empty() )
+                {
+                    poSRS = new OGRSpatialReference();
+                    poSRS->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+                    CPLPushErrorHandler(CPLQuietErrorHandler);
+                    const OGRErr eErr = poSRS->SetFromUserInput(osCRS.c_str());
+                    CPLPopErrorHandler();
+                    if( eErr != OGRERR_NONE )
+                    {
+                        CPLDebug("Arrow", "Cannot parse crs of column %s",
+                                 oField.osName.c_str());
+                        poSRS->Release();
+                        poSRS = nullptr;
+                    }
+                }
+
+                const CPLJSONArray oBBox = oGeoCol.GetArray("bbox");
+                if( m_anGeomFieldColumn.empty() && oBBox.IsValid() &&
+                    (oBBox.Size() == 4 || oBBox.Size() == 6) )
+                {
+                    const int nDim = oBBox.Size() / 2;
+                    m_sExtent.MinX = oBBox[0].ToDouble();
+                    m_sExtent.MinY = oBBox[1].ToDouble();
+                    m_sExtent.MaxX = oBBox[nDim].ToDouble();
+                    m_sExtent.MaxY = oBBox[nDim + 1].ToDouble();
+                    m_bHasExtent = true;
+                }
+            }
+            if( poSRS )
+            {
+                oGeomField.SetSpatialRef(poSRS);
+                poSRS->Release();
+            }
+
+            oCol.iGeomField = m_poFeatureDefn->GetGeomFieldCount();
+            m_poFeatureDefn->AddGeomFieldDefn(&oGeomField);
+            m_anGeomFieldColumn.push_back(iCol);
+            m_aoColumns.push_back(oCol);
+            continue;
+        }
+
+        OGRFieldType eType;
+        OGRFieldSubType eSubType;
+        if( !GetOGRFieldType(oField, eType, eSubType) )
+        {
+            CPLDebug("Arrow", "Field %s of unsupported type ignored",
+                     oField.osName.c_str());
+            m_aoColumns.push_back(oCol);
+            continue;
+        }
+        OGRFieldDefn oFieldDefn(oField.osName.c_str(), eType);
+        oFieldDefn.SetSubType(eSubType);
+        oFieldDefn.SetNullable(oField.bNullable);
+        if( oField.eType == Type::Decimal )
+        {
+            oFieldDefn.SetWidth(oField.nPrecision + 2);
+            oFieldDefn.SetPrecision(oField.nScale);
+        }
+        else if( oField.eType == Type::FixedSizeBinary )
+            oFieldDefn.SetWidth(oField.nByteWidth);
+        oCol.iField = m_poFeatureDefn->GetFieldCount();
+        m_poFeatureDefn->AddFieldDefn(&oFieldDefn);
+        m_anFieldColumn.push_back(iCol);
+        m_aoColumns.push_back(oCol);
+    }
+    m_nNodeCount = iNode;
+    m_nBufferCount = iBuffer;
+    return true;
+}
+
+/************************************************************************/
+/*                           ReadStatistics()                           */
+/*                                                                      */
+/*      {"min": {field: value}, "max": {field: value},                  */
+/*       "bbox": {geometry field: [minx, miny, maxx, maxy]}}            */
+/************************************************************************/
+
+void OGRArrowLayer::ReadStatistics( const char* pszJSON,
+                                    BatchInfo& oBatch ) const
+{
+    CPLJSONDocument oDoc;
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    const bool bOK = oDoc.LoadMemory(pszJSON);
+    CPLPopErrorHandler();
+    if( !bOK )
+    {
+        CPLDebug("Arrow", "Invalid statistics of record batch %d",
+                 static_cast<int>(m_aoBatches.size()));
+        return;
+    }
+    const CPLJSONObject oRoot = oDoc.GetRoot();
+
+    // Doubles are serialized on less than 17 significant digits, so the
+    // bounds are widened accordingly.
+    const auto Widen = [](double dfVal, double dfSign)
+    {
+        return dfVal + dfSign * fabs(dfVal) * 1e-12;
+    };
+
+    // Names are matched by iterating, as GetObj() treats '/' as a path
+    // separator.
+    oBatch.aoStats.resize(m_poFeatureDefn->GetFieldCount());
+    for( const auto& oMin: oRoot.GetObj("min").GetChildren() )
+    {
+        const int iField =
+            m_poFeatureDefn->GetFieldIndex(oMin.GetName().c_str());
+        if( iField < 0 )
+            continue;
+        CPLJSONObject oMax;
+        for( const auto& oChild: oRoot.GetObj("max").GetChildren() )
+        {
+            if( oChild.GetName() == oMin.GetName() )
+                oMax = oChild;
+        }
+        const auto IsInteger = [](const CPLJSONObject& oVal)
+        {
+            return oVal.GetType() == CPLJSONObject::Integer ||
+                   oVal.GetType() == CPLJSONObject::Long;
+        };
+        const bool bIsInteger = IsInteger(oMin) && IsInteger(oMax);
+        const bool bIsNumber =
+            (IsInteger(oMin) || oMin.GetType() == CPLJSONObject::Double) &&
+            (IsInteger(oMax) || oMax.GetType() == CPLJSONObject::Double);
+
+        ColumnStats& oStats = oBatch.aoStats[iField];
+        const OGRFieldType eType =
+            m_poFeatureDefn->GetFieldDefn(iField)->GetType();
+        if( (eType == OFTInteger || eType == OFTInteger64) && bIsInteger )
+        {
+            oStats.eType = ColumnStats::INTEGER;
+            oStats.nMin = oMin.ToLong();
+            oStats.nMax = oMax.ToLong();
+        }
+        else if( eType == OFTReal && bIsNumber )
+        {
+            oStats.eType = ColumnStats::REAL;
+            oStats.dfMin = Widen(oMin.ToDouble(), -1.0);
+            oStats.dfMax = Widen(oMax.ToDouble(), 1.0);
+        }
+    }
+
+    const int nGeomFields = m_poFeatureDefn->GetGeomFieldCount();
+    oBatch.asExtents.resize(nGeomFields);
+    oBatch.abHasExtent.resize(nGeomFields);
+    for( const auto& oBBox: oRoot.GetObj("bbox").GetChildren() )
+    {
+        const int iGeomField =
+            m_poFeatureDefn->GetGeomFieldIndex(oBBox.GetName().c_str());
+        const CPLJSONArray oArray = oBBox.ToArray();
+        if( iGeomField < 0 || !oArray.IsValid() || oArray.Size() != 4 )
+            continue;
+        OGREnvelope& sExtent = oBatch.asExtents[iGeomField];
+        sExtent.MinX = Widen(oArray[0].ToDouble(), -1.0);
+        sExtent.MinY = Widen(oArray[1].ToDouble(), -1.0);
+        sExtent.MaxX = Widen(oArray[2].ToDouble(), 1.0);
+        sExtent.MaxY = Widen(oArray[3].ToDouble(), 1.0);
+        oBatch.abHasExtent[iGeomField] = true;
+    }
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+OGRArrowLayer *OGRArrowLayer::Open( const char* pszFilename, VSILFILE* fp,
+                                    CSLConstList papszOpenOptions )
+{
+    std::unique_ptr<OGRArrowLayer> poLayer(new OGRArrowLayer());
+    poLayer->m_osFilename = pszFilename;
+    poLayer->m_poFp = fp;
+
+    GByte abyHeader[nFileHeaderSize];
+    if( VSIFSeekL(fp, 0, SEEK_SET) != 0 ||
+        VSIFReadL(abyHeader, nFileHeaderSize, 1, fp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "%s: cannot read header",
+                 pszFilename);
+        return nullptr;
+    }
+    poLayer->m_bStreamFormat =
+        memcmp(abyHeader, abyMagicBytes, nMagicBytesSize) != 0;
+
+    KeyValueList aoMetadata;
+    std::vector<Block> aoBlocks;
+    std::vector<GByte> abyBuffer;
+    vsi_l_offset nOffset = 0;
+    Table oSchema;
+    if( !poLayer->m_bStreamFormat )
+    {
+        if( !poLayer->ReadFileTrailer(abyBuffer) )
+            return nullptr;
+        const Table oFooter =
+            Table::GetRoot(abyBuffer.data(), abyBuffer.size());
+        if( !oFooter.IsValid() )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "%s: invalid footer",
+                     pszFilename);
+            return nullptr;
+        }
+        poLayer->m_nVersion = oFooter.GetScalar<int16_t>(Footer::version, 0);
+        if( !ReadBlocks(oFooter, aoBlocks) )
+            return nullptr;
+        oSchema = oFooter.GetTable(Footer::schema);
+    }
+    else
+    {
+        bool bEOS = false;
+        if( !poLayer->ReadStreamMessage(nOffset, abyBuffer, bEOS) )
+            return nullptr;
+        const Table oMessage =
+            bEOS ? Table() : Table::GetRoot(abyBuffer.data(), abyBuffer.size());
+        if( !oMessage.IsValid() ||
+            static_cast<MessageHeader>(oMessage.GetScalar<GByte>(
+                Message::header_type, 0)) != MessageHeader::Schema )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "%s: stream does not start with a schema", pszFilename);
+            return nullptr;
+        }
+        poLayer->m_nVersion = oMessage.GetScalar<int16_t>(Message::version, 0);
+        oSchema = oMessage.GetTable(Message::header);
+    }
+
+    if( poLayer->m_nVersion < nMetadataVersionV4 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: unsupported Arrow metadata version %d", pszFilename,
+                 poLayer->m_nVersion + 1);
+        return nullptr;
+    }
+    if( !ReadSchema(oSchema, poLayer->m_aoFields, aoMetadata) ||
+        !poLayer->BuildLayerDefn(aoMetadata, papszOpenOptions) )
+        return nullptr;
+
+    if( !(poLayer->m_bStreamFormat ? poLayer->ScanStreamBatches(nOffset)
+                                   : poLayer->ScanFileBatches(aoBlocks)) )
+        return nullptr;
+
+    poLayer->m_nNumThreads = CPLGetNumThreads(papszOpenOptions);
+
+    return poLayer.release();
+}
+
+/************************************************************************/
+/*                            GetFIDColumn()                            */
+/************************************************************************/
+
+const char *OGRArrowLayer::GetFIDColumn()
+{
+    if( m_bCreate || m_sSchema.release )
+        return m_osFIDColumn.c_str();
+    return m_iFIDColumn >= 0 ? m_aoFields[m_iFIDColumn].osName.c_str() : "";
+}
+
+/************************************************************************/
+/*                          ClearReadBuffers()                          */
+/************************************************************************/
+
+void OGRArrowLayer::ClearReadBuffers()
+{
+    m_poCurData.reset();
+    m_poRandomData.reset();
+    m_apoFeatures.clear();
+    m_iNextFeature = 0;
+    for( size_t i = m_iNextArrowArray; i < m_asArrowArrays.size(); i++ )
+    {
+        if( m_asArrowArrays[i].release )
+            m_asArrowArrays[i].release(&m_asArrowArrays[i]);
+    }
+    m_asArrowArrays.clear();
+    m_iNextArrowArray = 0;
+}
+
+/************************************************************************/
+/*                            ResetReading()                            */
+/************************************************************************/
+
+void OGRArrowLayer::ResetReading()
+{
+    ClearReadBuffers();
+    m_iCurBatch = 0;
+    m_nCurRow = 0;
+    m_bEOF = false;
+}
+
+/************************************************************************/
+/*                          SetIgnoredFields()                          */
+/*                                                                      */
+/*      Loaded batches only hold the columns that are not ignored.      */
+/************************************************************************/
+
+OGRErr OGRArrowLayer::SetIgnoredFields( const char **papszFields )
+{
+    const OGRErr eErr = OGRLayer::SetIgnoredFields(papszFields);
+    m_poCurData.reset();
+    m_poRandomData.reset();
+    return eErr;
+}
+
+/************************************************************************/
+/*                          CanExcludeBatch()                           */
+/*                                                                      */
+/*      Whether the statistics of a batch prove that none of its rows   */
+/*      can match the expression. NULL values never match comparisons,  */
+/*      so the bounds of the non NULL values are enough.                */
+/************************************************************************/
+
+bool OGRArrowLayer::CanExcludeBatch( const swq_expr_node* poNode,
+                                     const BatchInfo& oBatch ) const
+{
+    if( poNode->eNodeType != SNT_OPERATION )
+        return false;
+
+    if( poNode->nOperation == SWQ_AND )
+    {
+        for( int i = 0; i < poNode->nSubExprCount; i++ )
+        {
+            if( CanExcludeBatch(poNode->papoSubExpr[i], oBatch) )
+                return true;
+        }
+        return false;
+    }
+    if( poNode->nOperation == SWQ_OR )
+    {
+        for( int i = 0; i < poNode->nSubExprCount; i++ )
+        {
+            if( !CanExcludeBatch(poNode->papoSubExpr[i], oBatch) )
+                return false;
+        }
+        return poNode->nSubExprCount > 0;
+    }
+
+    if( poNode->nSubExprCount < 2 )
+        return false;
+
+    int nOperation = poNode->nOperation;
+    const swq_expr_node* poColumn = poNode->papoSubExpr[0];
+    const swq_expr_node* poValue = poNode->papoSubExpr[1];
+    if( poColumn->eNodeType == SNT_CONSTANT &&
+        poValue->eNodeType == SNT_COLUMN && poNode->nSubExprCount == 2 )
+    {
+        std::swap(poColumn, poValue);
+        switch( nOperation )
+        {
+            case SWQ_LT: nOperation = SWQ_GT; break;
+            case SWQ_LE: nOperation = SWQ_GE; break;
+            case SWQ_GT: nOperation = SWQ_LT; break;
+            case SWQ_GE: nOperation = SWQ_LE; break;
+            default: break;
+        }
+    }
+    if( poColumn->eNodeType != SNT_COLUMN || poColumn->table_index != 0 )
+        return false;
+
+/* -------------------------------------------------------------------- */
+/*      Bounds of the column: the statistics of the field, or the row   */
+/*      numbers for the FID when it is implicit.                        */
+/* -------------------------------------------------------------------- */
+    ColumnStats oStats;
+    const int nFieldCount = m_poFeatureDefn->GetFieldCount();
+    if( poColumn->field_index >= 0 && poColumn->field_index < nFieldCount &&
+        poColumn->field_index < static_cast<int>(oBatch.aoStats.size()) )
+    {
+        oStats = oBatch.aoStats[poColumn->field_index];
+    }
+    else if( poColumn->field_index == nFieldCount + SPF_FID &&
+             m_iFIDColumn < 0 && oBatch.nRows > 0 )
+    {
+        oStats.eType = ColumnStats::INTEGER;
+        oStats.nMin = oBatch.nFirstRow;
+        oStats.nMax = oBatch.nFirstRow + oBatch.nRows - 1;
+    }
+    if( oStats.eType == ColumnStats::NONE )
+        return false;
+
+    // -1: all values of the batch are below, 1: all are above, 0: unknown.
+    const auto Compare = [&oStats](const swq_expr_node* poConstant,
+                                   bool bStrict) -> int
+    {
+        if( poConstant->eNodeType != SNT_CONSTANT || poConstant->is_null )
+            return 0;
+        if( oStats.eType == ColumnStats::INTEGER &&
+            (poConstant->field_type == SWQ_INTEGER ||
+             poConstant->field_type == SWQ_INTEGER64) )
+        {
+            const GIntBig nVal = poConstant->int_value;
+            if( bStrict ? oStats.nMax < nVal : oStats.nMax <= nVal )
+                return -1;
+            if( bStrict ? oStats.nMin > nVal : oStats.nMin >= nVal )
+                return 1;
+            return 0;
+        }
+        double dfVal;
+        if( poConstant->field_type == SWQ_FLOAT )
+            dfVal = poConstant->float_value;
+        else if( poConstant->field_type == SWQ_INTEGER ||
+                 poConstant->field_type == SWQ_INTEGER64 )
+            dfVal = static_cast<double>(poConstant->int_value);
+        else
+            return 0;
+        const double dfMin = oStats.eType == ColumnStats::INTEGER ?
+            static_cast<double>(oStats.nMin) : oStats.dfMin;
+        const double dfMax = oStats.eType == ColumnStats::INTEGER ?
+            static_cast<double>(oStats.nMax) : oStats.dfMax;
+        if( bStrict ? dfMax < dfVal : dfMax <= dfVal )
+            return -1;
+        if( bStrict ? dfMin > dfVal : dfMin >= dfVal )
+            return 1;
+        return 0;
+    };
+
+    switch( nOperation )
+    {
+        case SWQ_EQ:
+            return Compare(poValue, true) != 0;
+        case SWQ_LT:
+            return Compare(poValue, false) == 1;
+        case SWQ_LE:
+            return Compare(poValue, true) == 1;
+        case SWQ_GT:
+            return Compare(poValue, false) == -1;
+        case SWQ_GE:
+            return Compare(poValue, true) == -1;
+        case SWQ_BETWEEN:
+            return poNode->nSubExprCount == 3 &&
+                   (Compare(poNode->papoSubExpr[1], true) == -1 ||
+                    Compare(poNode->papoSubExpr[2], true) == 1);
+        case SWQ_IN:
+            for( int i = 1; i < poNode->nSubExprCount; i++ )
+            {
+                if( Compare(poNode->papoSubExpr[i], true) == 0 )
+                    return false;
+            }
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                        BatchMatchesFilters()                         */
+/************************************************************************/
+
+bool OGRArrowLayer::BatchMatchesFilters( const BatchInfo& oBatch )
+{
+    if( m_poFilterGeom != nullptr && m_iGeomFieldFilter >= 0 &&
+        m_iGeomFieldFilter < static_cast<int>(oBatch.abHasExtent.size()) &&
+        oBatch.abHasExtent[m_iGeomFieldFilter] &&
+        !m_sFilterEnvelope.Intersects(oBatch.asExtents[m_iGeomFieldFilter]) )
+        return false;
+
+    if( m_poAttrQuery != nullptr )
+    {
+        const swq_expr_node* poNode =
+            static_cast<const swq_expr_node*>(m_poAttrQuery->GetSWQExpr());
+        if( poNode != nullptr && CanExcludeBatch(poNode, oBatch) )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             LoadBatch()                              */
+/*                                                                      */
+/*      Reads the buffers of the columns that are not ignored. Close    */
+/*      ranges of the body are merged, and all are fetched with a       */
+/*      single multi range read.                                        */
+/************************************************************************/
+
+std::shared_ptr<OGRArrowLayer::BatchData> OGRArrowLayer::LoadBatch(
+                                                            size_t iBatch )
+{
+    const BatchInfo& oBatch = m_aoBatches[iBatch];
+    auto poData = std::make_shared<BatchData>();
+    poData->psInfo = &oBatch;
+    poData->aoColumns.resize(m_aoColumns.size());
+
+    struct Span
+    {
+        GIntBig nStart;
+        GIntBig nEnd;
+        size_t  iCol;
+        size_t  iMerged;
+    };
+    std::vector<Span> aoSpans;
+    for( size_t iCol = 0; iCol < m_aoColumns.size(); iCol++ )
+    {
+        const ColumnInfo& oCol = m_aoColumns[iCol];
+        const bool bNeeded =
+            static_cast<int>(iCol) == m_iFIDColumn ||
+            (oCol.iField >= 0 &&
+             !m_poFeatureDefn->GetFieldDefn(oCol.iField)->IsIgnored()) ||
+            (oCol.iGeomField >= 0 &&
+             !m_poFeatureDefn->GetGeomFieldDefn(oCol.iGeomField)->IsIgnored());
+        if( !bNeeded )
+            continue;
+
+        Span sSpan{ std::numeric_limits<GIntBig>::max(), 0, iCol, 0 };
+        const int nBuffers =
+            m_aoFields[iCol].GetTotalBufferCount(m_nVersion);
+        for( int i = 0; i < nBuffers; i++ )
+        {
+            const ArrowIPC::Buffer& sBuffer =
+                oBatch.aoBuffers[oCol.iFirstBuffer + i];
+            if( sBuffer.nLength == 0 )
+                continue;
+            sSpan.nStart = std::min(sSpan.nStart, sBuffer.nOffset);
+            sSpan.nEnd = std::max(sSpan.nEnd, sBuffer.nOffset + sBuffer.nLength);
+        }
+        if( sSpan.nEnd == 0 )
+            sSpan.nStart = 0;
+        aoSpans.push_back(sSpan);
+    }
+
+    std::sort(aoSpans.begin(), aoSpans.end(),
+              [](const Span& a, const Span& b) { return a.nStart < b.nStart; });
+    std::vector<Span> aoMerged;
+    for( auto& sSpan: aoSpans )
+    {
+        if( sSpan.nEnd == 0 )
+            continue;
+        if( !aoMerged.empty() &&
+            sSpan.nStart <= aoMerged.back().nEnd + MAX_READ_GAP )
+        {
+            aoMerged.back().nEnd = std::max(aoMerged.back().nEnd, sSpan.nEnd);
+        }
+        else
+        {
+            aoMerged.push_back(sSpan);
+        }
+        sSpan.iMerged = aoMerged.size() - 1;
+    }
+
+    std::vector<size_t> anPos;
+    size_t nTotalSize = 0;
+    for( const auto& sSpan: aoMerged )
+    {
+        anPos.push_back(nTotalSize);
+        const GIntBig nSize = sSpan.nEnd - sSpan.nStart;
+        if( nSize > static_cast<GIntBig>(
+                std::numeric_limits<size_t>::max() - nTotalSize) )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "%s: record batch %d too large", m_osFilename.c_str(),
+                     static_cast<int>(iBatch));
+            return nullptr;
+        }
+        nTotalSize += static_cast<size_t>(nSize);
+    }
+    try
+    {
+        poData->abyBuffer.resize(nTotalSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "%s: cannot allocate " CPL_FRMT_GUIB " bytes for record "
+                 "batch %d", m_osFilename.c_str(),
+                 static_cast<GUIntBig>(nTotalSize),
+                 static_cast<int>(iBatch));
+        return nullptr;
+    }
+
+    if( !aoMerged.empty() )
+    {
+        std::vector<void*> apData;
+        std::vector<vsi_l_offset> anOffsets;
+        std::vector<size_t> anSizes;
+        for( size_t i = 0; i < aoMerged.size(); i++ )
+        {
+            apData.push_back(poData->abyBuffer.data() + anPos[i]);
+            anOffsets.push_back(oBatch.nBodyOffset + aoMerged[i].nStart);
+            anSizes.push_back(
+                static_cast<size_t>(aoMerged[i].nEnd - aoMerged[i].nStart));
+        }
+        if( VSIFReadMultiRangeL(static_cast<int>(apData.size()),
+                                apData.data(), anOffsets.data(),
+                                anSizes.data(), m_poFp) != 0 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "%s: cannot read record batch %d",
+                     m_osFilename.c_str(), static_cast<int>(iBatch));
+            return nullptr;
+        }
+    }
+
+    for( const auto& sSpan: aoSpans )
+    {
+        const ColumnInfo& oCol = m_aoColumns[sSpan.iCol];
+        const GByte* pabyBase = nullptr;
+        GIntBig nBaseOffset = 0;
+        if( sSpan.nEnd != 0 )
+        {
+            pabyBase = poData->abyBuffer.data() + anPos[sSpan.iMerged];
+            nBaseOffset = aoMerged[sSpan.iMerged].nStart;
+        }
+        int iNode = oCol.iFirstNode;
+        int iBuffer = oCol.iFirstBuffer;
+        ArrayView& oView = poData->aoColumns[sSpan.iCol];
+        if( !BuildView(m_aoFields[sSpan.iCol], oBatch, m_nVersion, iNode,
+                       iBuffer, pabyBase, nBaseOffset, oView) ||
+            oView.nLength < oBatch.nRows )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "%s: invalid column %s in record batch %d",
+                     m_osFilename.c_str(),
+                     m_aoFields[sSpan.iCol].osName.c_str(),
+                     static_cast<int>(iBatch));
+            return nullptr;
+        }
+    }
+    return poData;
+}
+
+/************************************************************************/
+/*                           NextRowRanges()                            */
+/*                                                                      */
+/*      Splits the next rows to read in at most nMaxRanges ranges of    */
+/*      at most nMaxRows rows, loading the batches as needed. An empty  */
+/*      list means the end of the layer.                                */
+/************************************************************************/
+
+bool OGRArrowLayer::NextRowRanges( GIntBig nMaxRows, size_t nMaxRanges,
+                                   bool bUseFilters,
+                                   std::vector<RowRange>& aoRanges )
+{
+    aoRanges.clear();
+    while( aoRanges.size() < nMaxRanges )
+    {
+        if( !m_poCurData )
+        {
+            // A batch partly read is reloaded after SetIgnoredFields().
+            while( m_nCurRow == 0 && m_iCurBatch < m_aoBatches.size() &&
+                   (m_aoBatches[m_iCurBatch].nRows == 0 ||
+                    (bUseFilters &&
+                     !BatchMatchesFilters(m_aoBatches[m_iCurBatch]))) )
+            {
+                m_iCurBatch++;
+            }
+            if( m_iCurBatch >= m_aoBatches.size() )
+                break;
+            m_poCurData = LoadBatch(m_iCurBatch);
+            if( !m_poCurData )
+                return false;
+        }
+
+        const GIntBig nRows = m_aoBatches[m_iCurBatch].nRows;
+        RowRange oRange;
+        oRange.poData = m_poCurData;
+        oRange.iStart = m_nCurRow;
+        oRange.iEnd = std::min(nRows, m_nCurRow + nMaxRows);
+        m_nCurRow = oRange.iEnd;
+        aoRanges.push_back(std::move(oRange));
+        if( m_nCurRow == nRows )
+        {
+            m_poCurData.reset();
+            m_iCurBatch++;
+            m_nCurRow = 0;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                              RunJobs()                               */
+/************************************************************************/
+
+void OGRArrowLayer::RunJobs( CPLThreadFunc pfnFunc,
+                             std::vector<void*>& apJobs )
+{
+    if( m_nNumThreads > 1 && apJobs.size() > 1 && !m_poJobQueue )
+    {
+        CPLWorkerThreadPool* poPool =
+            CPLGetGlobalWorkerThreadPool(m_nNumThreads);
+        if( poPool )
+            m_poJobQueue = poPool->CreateJobQueue();
+        else
+            m_nNumThreads = 1;
+    }
+    if( !m_poJobQueue || apJobs.size() == 1 )
+    {
+        for( void* pJob: apJobs )
+            pfnFunc(pJob);
+        return;
+    }
+
+    for( size_t i = 1; i < apJobs.size(); i++ )
+    {
+        if( !m_poJobQueue->SubmitJob(pfnFunc, apJobs[i]) )
+            pfnFunc(apJobs[i]);
+    }
+    pfnFunc(apJobs[0]);
+    m_poJobQueue->WaitCompletion();
+}
+
+/************************************************************************/
+/*                             DecodeRow()                              */
+/************************************************************************/
+
+template<class Visitor>
+void OGRArrowLayer::DecodeRow( const BatchData& oData, GIntBig iRow,
+                               Visitor& oVisitor ) const
+{
+    if( m_iFIDColumn >= 0 )
+    {
+        const ArrayView& oView = oData.aoColumns[m_iFIDColumn];
+        oVisitor.SetFID(oView.IsNull(iRow) ? OGRNullFID :
+                                             GetIntegerValue(oView, iRow));
+    }
+    else
+    {
+        oVisitor.SetFID(oData.psInfo->nFirstRow + iRow);
+    }
+
+    const int nFieldCount = static_cast<int>(m_anFieldColumn.size());
+    for( int iField = 0; iField < nFieldCount; iField++ )
+    {
+        const ArrayView& oView = oData.aoColumns[m_anFieldColumn[iField]];
+        if( oView.psField == nullptr )
+            continue;
+        if( oView.IsNull(iRow) )
+        {
+            oVisitor.SetNull(iField);
+            continue;
+        }
+
+        const FieldDesc& oField = *oView.psField;
+        switch( oField.eType )
+        {
+            case Type::Int:
+            {
+                const GIntBig nVal = GetIntegerValue(oView, iRow);
+                if( m_poFeatureDefn->GetFieldDefn(iField)->GetType() ==
+                                                                OFTInteger )
+                    oVisitor.SetInteger(iField, static_cast<int>(nVal));
+                else
+                    oVisitor.SetInteger64(iField, nVal);
+                break;
+            }
+            case Type::Bool:
+                oVisitor.SetInteger(iField, GetBit(oView.pabyValues, iRow));
+                break;
+            case Type::FloatingPoint:
+            case Type::Decimal:
+                oVisitor.SetReal(iField, GetRealValue(oView, iRow));
+                break;
+            case Type::Duration:
+                oVisitor.SetInteger64(iField,
+                                      GetValue<int64_t>(oView, iRow));
+                break;
+            case Type::Utf8:
+            case Type::LargeUtf8:
+            case Type::Binary:
+            case Type::LargeBinary:
+            {
+                GIntBig nStart, nEnd;
+                GetRange(oView, iRow, nStart, nEnd);
+                const GByte* pabyVal = oView.pabyData ?
+                    oView.pabyData + nStart : reinterpret_cast<const GByte*>("");
+                if( oField.eType == Type::Utf8 ||
+                    oField.eType == Type::LargeUtf8 )
+                    oVisitor.SetString(iField,
+                                       reinterpret_cast<const char*>(pabyVal),
+                                       static_cast<size_t>(nEnd - nStart));
+                else
+                    oVisitor.SetBinary(iField, pabyVal,
+                                       static_cast<size_t>(nEnd - nStart));
+                break;
+            }
+            case Type::FixedSizeBinary:
+                oVisitor.SetBinary(iField,
+                    oView.pabyValues + static_cast<size_t>(iRow) *
+                                                        oField.nByteWidth,
+                    oField.nByteWidth);
+                break;
+            case Type::Date:
+            case Type::Time:
+            case Type::Timestamp:
+            {
+                OGRField sField;
+                GetDateTimeValue(oView, iRow, sField);
+                oVisitor.SetField(iField, &sField);
+                break;
+            }
+            default:
+            {
+                // Lists. NULL items are read as 0 or empty strings.
+                const ArrayView& oChild = oView.aoChildren[0];
+                GIntBig nStart, nEnd;
+                GetRange(oView, iRow, nStart, nEnd);
+                const int nCount = static_cast<int>(
+                    std::min<GIntBig>(nEnd - nStart,
+                                      std::numeric_limits<int>::max()));
+                OGRField sField;
+                switch( m_poFeatureDefn->GetFieldDefn(iField)->GetType() )
+                {
+                    case OFTIntegerList:
+                    {
+                        std::vector<int> anValues(nCount);
+                        for( int i = 0; i < nCount; i++ )
+                        {
+                            if( oChild.IsNull(nStart + i) )
+                                continue;
+                            anValues[i] = oChild.psField->eType == Type::Bool ?
+                                GetBit(oChild.pabyValues, nStart + i) :
+                                static_cast<int>(
+                                    GetIntegerValue(oChild, nStart + i));
+                        }
+                        sField.IntegerList.nCount = nCount;
+                        sField.IntegerList.paList = anValues.data();
+                        oVisitor.SetField(iField, &sField);
+                        break;
+                    }
+                    case OFTInteger64List:
+                    {
+                        std::vector<GIntBig> anValues(nCount);
+                        for( int i = 0; i < nCount; i++ )
+                        {
+                            if( !oChild.IsNull(nStart + i) )
+                                anValues[i] =
+                                    GetIntegerValue(oChild, nStart + i);
+                        }
+                        sField.Integer64List.nCount = nCount;
+                        sField.Integer64List.paList = anValues.data();
+                        oVisitor.SetField(iField, &sField);
+                        break;
+                    }
+                    case OFTRealList:
+                    {
+                        std::vector<double> adfValues(nCount);
+                        for( int i = 0; i < nCount; i++ )
+                        {
+                            if( !oChild.IsNull(nStart + i) )
+                                adfValues[i] =
+                                    GetRealValue(oChild, nStart + i);
+                        }
+                        sField.RealList.nCount = nCount;
+                        sField.RealList.paList = adfValues.data();
+                        oVisitor.SetField(iField, &sField);
+                        break;
+                    }
+                    default:
+                    {
+                        std::vector<std::string> aosValues(nCount);
+                        std::vector<char*> apszValues(nCount + 1);
+                        for( int i = 0; i < nCount; i++ )
+                        {
+                            if( !oChild.IsNull(nStart + i) &&
+                                oChild.pabyData != nullptr )
+                            {
+                                GIntBig nItemStart, nItemEnd;
+                                GetRange(oChild, nStart + i, nItemStart,
+                                         nItemEnd);
+                                aosValues[i].assign(
+                                    reinterpret_cast<const char*>(
+                                        oChild.pabyData + nItemStart),
+                                    static_cast<size_t>(
+                                        nItemEnd - nItemStart));
+                            }
+                            apszValues[i] = &aosValues[i][0];
+                        }
+                        apszValues[nCount] = nullptr;
+                        sField.StringList.nCount = nCount;
+                        sField.StringList.paList = apszValues.data();
+                        oVisitor.SetField(iField, &sField);
+                        break;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    const int nGeomFieldCount = static_cast<int>(m_anGeomFieldColumn.size());
+    for( int iGeomField = 0; iGeomField < nGeomFieldCount; iGeomField++ )
+    {
+        const ArrayView& oView =
+            oData.aoColumns[m_anGeomFieldColumn[iGeomField]];
+        if( oView.psField == nullptr || oView.IsNull(iRow) )
+            continue;
+        GIntBig nStart, nEnd;
+        GetRange(oView, iRow, nStart, nEnd);
+        if( nEnd > nStart )
+            oVisitor.SetGeometryWKB(iGeomField, oView.pabyData + nStart,
+                                    static_cast<size_t>(nEnd - nStart));
+    }
+}
+
+/************************************************************************/
+/*                           FeatureVisitor                             */
+/************************************************************************/
+
+namespace {
+
+struct FeatureVisitor
+{
+    OGRFeature* m_poFeature;
+
+    void SetFID( GIntBig nFID ) { m_poFeature->SetFID(nFID); }
+    void SetNull( int iField ) { m_poFeature->SetFieldNull(iField); }
+    void SetInteger( int iField, int nVal )
+        { m_poFeature->SetField(iField, nVal); }
+    void SetInteger64( int iField, GIntBig nVal )
+        { m_poFeature->SetField(iField, nVal); }
+    void SetReal( int iField, double dfVal )
+        { m_poFeature->SetField(iField, dfVal); }
+    void SetString( int iField, const char* pszVal, size_t nLen )
+        { m_poFeature->SetField(iField, std::string(pszVal, nLen).c_str()); }
+    void SetBinary( int iField, const GByte* pabyData, size_t nLen )
+        { m_poFeature->SetField(iField, static_cast<int>(nLen), pabyData); }
+    void SetField( int iField, const OGRField* psField )
+        { m_poFeature->SetField(iField, const_cast<OGRField*>(psField)); }
+    // Parsed on first use.
+    void SetGeometryWKB( int iGeomField, const GByte* pabyWKB, size_t nLen )
+        { m_poFeature->SetGeomFieldLazyWKB(iGeomField, pabyWKB, nLen); }
+};
+
+/************************************************************************/
+/*                            ArrowVisitor                              */
+/************************************************************************/
+
+struct ArrowVisitor
+{
+    OGRArrowArrayBuilder& m_oBuilder;
+
+    void SetFID( GIntBig nFID ) { m_oBuilder.SetFID(nFID); }
+    void SetNull( int iField ) { m_oBuilder.SetNull(iField); }
+    void SetInteger( int iField, int nVal )
+        { m_oBuilder.SetInteger(iField, nVal); }
+    void SetInteger64( int iField, GIntBig nVal )
+        { m_oBuilder.SetInteger64(iField, nVal); }
+    void SetReal( int iField, double dfVal )
+        { m_oBuilder.SetReal(iField, dfVal); }
+    void SetString( int iField, const char* pszVal, size_t nLen )
+        { m_oBuilder.SetString(iField, pszVal, nLen); }
+    void SetBinary( int iField, const GByte* pabyData, size_t nLen )
+        { m_oBuilder.SetBinary(iField, pabyData, nLen); }
+    void SetField( int iField, const OGRField* psField )
+        { m_oBuilder.SetField(iField, psField); }
+    void SetGeometryWKB( int iGeomField, const GByte* pabyWKB, size_t nLen )
+        { m_oBuilder.SetGeometryWKB(iGeomField, pabyWKB, nLen); }
+};
+
+/************************************************************************/
+/*                             FeatureJob                               */
+/************************************************************************/
+
+struct FeatureJob
+{
+    const OGRArrowLayer* poLayer = nullptr;
+    OGRArrowLayer::RowRange oRange{};
+    bool        bParseGeometry = false;
+    std::vector<std::unique_ptr<OGRFeature>> apoFeatures{};
+};
+
+static void DecodeFeaturesJob( void* pData )
+{
+    FeatureJob* psJob = static_cast<FeatureJob*>(pData);
+    const OGRArrowLayer::RowRange& oRange = psJob->oRange;
+    psJob->apoFeatures.reserve(
+        static_cast<size_t>(oRange.iEnd - oRange.iStart));
+    for( GIntBig i = oRange.iStart; i < oRange.iEnd; i++ )
+    {
+        psJob->apoFeatures.emplace_back(psJob->poLayer->DecodeFeature(
+            *oRange.poData, i, psJob->bParseGeometry));
+    }
+}
+
+/************************************************************************/
+/*                              ArrowJob                                */
+/************************************************************************/
+
+struct ArrowJob
+{
+    const OGRArrowLayer* poLayer = nullptr;
+    OGRFeatureDefn* poDefn = nullptr;
+    bool        bIncludeFID = true;
+    OGRArrowLayer::RowRange oRange{};
+    struct ArrowArray sArray;
+    int         nErr = 0;
+};
+
+static void DecodeArrowJob( void* pData )
+{
+    ArrowJob* psJob = static_cast<ArrowJob*>(pData);
+    const OGRArrowLayer::RowRange& oRange = psJob->oRange;
+    memset(&psJob->sArray, 0, sizeof(psJob->sArray));
+    try
+    {
+        OGRArrowArrayBuilder oBuilder(psJob->poDefn, psJob->bIncludeFID);
+        ArrowVisitor oVisitor{ oBuilder };
+        for( GIntBig i = oRange.iStart; i < oRange.iEnd; i++ )
+        {
+            psJob->poLayer->DecodeRow(*oRange.poData, i, oVisitor);
+            oBuilder.EndRow();
+        }
+        psJob->nErr = oBuilder.Finish(&psJob->sArray) ? 0 : EOVERFLOW;
+    }
+    catch( const std::bad_alloc& )
+    {
+        psJob->nErr = ENOMEM;
+    }
+}
+
+} // namespace
+
+/************************************************************************/
+/*                           DecodeFeature()                            */
+/************************************************************************/
+
+OGRFeature *OGRArrowLayer::DecodeFeature( const BatchData& oData,
+                                          GIntBig iRow,
+                                          bool bParseGeometry ) const
+{
+    OGRFeature* poFeature = new OGRFeature(m_poFeatureDefn);
+    FeatureVisitor oVisitor{ poFeature };
+    DecodeRow(oData, iRow, oVisitor);
+    if( bParseGeometry && m_iGeomFieldFilter >= 0 &&
+        m_iGeomFieldFilter < poFeature->GetGeomFieldCount() )
+        poFeature->GetGeomFieldRef(m_iGeomFieldFilter);
+    return poFeature;
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/*                                                                      */
+/*      Rows are decoded by several jobs at once. When there is a       */
+/*      spatial filter, the jobs also parse the filtered geometry, so   */
+/*      that only the evaluation of the filters is sequential.          */
+/************************************************************************/
+
+OGRFeature *OGRArrowLayer::GetNextFeature()
+{
+    if( m_bCreate || m_poFp == nullptr )
+        return nullptr;
+
+    while( true )
+    {
+        if( m_iNextFeature < m_apoFeatures.size() )
+        {
+            std::unique_ptr<OGRFeature> poFeature(
+                std::move(m_apoFeatures[m_iNextFeature++]));
+            if( (m_poFilterGeom == nullptr ||
+                 FilterGeometry(
+                    poFeature->GetGeomFieldRef(m_iGeomFieldFilter))) &&
+                (m_poAttrQuery == nullptr ||
+                 m_poAttrQuery->Evaluate(poFeature.get())) )
+            {
+                return poFeature.release();
+            }
+            continue;
+        }
+
+        m_apoFeatures.clear();
+        m_iNextFeature = 0;
+        if( m_bEOF )
+            return nullptr;
+
+        std::vector<RowRange> aoRanges;
+        if( !NextRowRanges(ROWS_PER_JOB, m_nNumThreads, true, aoRanges) ||
+            aoRanges.empty() )
+        {
+            m_bEOF = true;
+            return nullptr;
+        }
+
+        std::vector<FeatureJob> aoJobs(aoRanges.size());
+        std::vector<void*> apJobs;
+        for( size_t i = 0; i < aoRanges.size(); i++ )
+        {
+            aoJobs[i].poLayer = this;
+            aoJobs[i].oRange = std::move(aoRanges[i]);
+            aoJobs[i].bParseGeometry = m_poFilterGeom != nullptr;
+            apJobs.push_back(&aoJobs[i]);
+        }
+        RunJobs(DecodeFeaturesJob, apJobs);
+
+        for( auto& oJob: aoJobs )
+        {
+            for( auto& poFeature: oJob.apoFeatures )
+                m_apoFeatures.push_back(std::move(poFeature));
+        }
+    }
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/*                                                                      */
+/*      Without FID column, the FID is the row number, and locates its  */
+/*      record batch.                                                   */
+/************************************************************************/
+
+OGRFeature *OGRArrowLayer::GetFeature( GIntBig nFID )
+{
+    if( m_bCreate || m_poFp == nullptr )
+        return nullptr;
+    if( m_iFIDColumn >= 0 )
+        return OGRLayer::GetFeature(nFID);
+    if( nFID < 0 || nFID >= m_nTotalRows )
+        return nullptr;
+
+    const auto oIter = std::upper_bound(
+        m_aoBatches.begin(), m_aoBatches.end(), nFID,
+        [](GIntBig nRow, const BatchInfo& oBatch)
+        { return nRow < oBatch.nFirstRow; });
+    const size_t iBatch = static_cast<size_t>(oIter - m_aoBatches.begin()) - 1;
+    if( !m_poRandomData || m_iRandomBatch != iBatch )
+    {
+        m_poRandomData = LoadBatch(iBatch);
+        m_iRandomBatch = iBatch;
+        if( !m_poRandomData )
+            return nullptr;
+    }
+    return DecodeFeature(*m_poRandomData,
+                         nFID - m_aoBatches[iBatch].nFirstRow, false);
+}
+
+/************************************************************************/
+/*                         GetNextArrowArray()                          */
+/*                                                                      */
+/*      Jobs decode row ranges straight into the columns of the         */
+/*      returned batches, without building an OGRFeature.               */
+/************************************************************************/
+
+int OGRArrowLayer::GetNextArrowArray( struct ArrowArrayStream* stream,
+                                      struct ArrowArray* out_array )
+{
+    // Filters need the full feature to be evaluated.
+    if( m_poFp == nullptr || m_bCreate ||
+        m_poAttrQuery != nullptr || m_poFilterGeom != nullptr )
+        return OGRLayer::GetNextArrowArray(stream, out_array);
+
+    memset(out_array, 0, sizeof(*out_array));
+    if( m_iNextArrowArray == m_asArrowArrays.size() )
+    {
+        m_asArrowArrays.clear();
+        m_iNextArrowArray = 0;
+
+        CSLConstList papszOptions = m_aosArrowArrayStreamOptions.List();
+        const int nMaxBatchSize =
+            OGRArrowArrayBuilder::GetMaxFeaturesInBatch(papszOptions);
+        std::vector<RowRange> aoRanges;
+        if( !NextRowRanges(nMaxBatchSize, m_nNumThreads, false, aoRanges) )
+            return EIO;
+        if( aoRanges.empty() )
+        {
+            m_bArrowArrayStreamEOF = true;
+            return 0;
+        }
+
+        std::vector<ArrowJob> aoJobs(aoRanges.size());
+        std::vector<void*> apJobs;
+        for( size_t i = 0; i < aoRanges.size(); i++ )
+        {
+            aoJobs[i].poLayer = this;
+            aoJobs[i].poDefn = m_poFeatureDefn;
+            aoJobs[i].bIncludeFID =
+                OGRArrowArrayBuilder::IncludeFID(papszOptions);
+            aoJobs[i].oRange = std::move(aoRanges[i]);
+            apJobs.push_back(&aoJobs[i]);
+        }
+        RunJobs(DecodeArrowJob, apJobs);
+
+        int nErr = 0;
+        for( auto& oJob: aoJobs )
+        {
+            if( oJob.nErr != 0 && nErr == 0 )
+                nErr = oJob.nErr;
+            if( oJob.nErr == 0 )
+                m_asArrowArrays.push_back(oJob.sArray);
+        }
+        if( nErr != 0 )
+        {
+            ClearReadBuffers();
+            if( nErr == ENOMEM )
+                CPLError(CE_Failure, CPLE_OutOfMemory,
+                         "Out of memory in GetNextArrowArray()");
+            return nErr;
+        }
+    }
+
+    // Ownership goes to the caller.
+    *out_array = m_asArrowArrays[m_iNextArrowArray];
+    memset(&m_asArrowArrays[m_iNextArrowArray], 0, sizeof(*out_array));
+    m_iNextArrowArray++;
+    return 0;
+}
+
+/************************************************************************/
+/*                          GetFeatureCount()                           */
+/************************************************************************/
+
+GIntBig OGRArrowLayer::GetFeatureCount( int bForce )
+{
+    if( m_bCreate )
+        return m_nFeatureCount;
+    if( m_poFilterGeom == nullptr && m_poAttrQuery == nullptr )
+        return m_nTotalRows;
+    return OGRLayer::GetFeatureCount(bForce);
+}
+
+/************************************************************************/
+/*                             GetExtent()                              */
+/*                                                                      */
+/*      From the bbox of the "geo" metadata, or else from the           */
+/*      statistics of the record batches.                               */
+/************************************************************************/
+
+OGRErr OGRArrowLayer::GetExtent( OGREnvelope *psExtent, int bForce )
+{
+    return GetExtent(0, psExtent, bForce);
+}
+
+OGRErr OGRArrowLayer::GetExtent( int iGeomField, OGREnvelope *psExtent,
+                                 int bForce )
+{
+    if( iGeomField < 0 || iGeomField >= m_poFeatureDefn->GetGeomFieldCount() )
+    {
+        if( iGeomField != 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid geometry field index : %d", iGeomField);
+        }
+        return OGRERR_FAILURE;
+    }
+
+    if( m_bCreate )
+    {
+        if( iGeomField != 0 || !m_sExtent.IsInit() )
+            return OGRERR_FAILURE;
+        *psExtent = m_sExtent;
+        return OGRERR_NONE;
+    }
+    if( iGeomField == 0 && m_bHasExtent )
+    {
+        *psExtent = m_sExtent;
+        return OGRERR_NONE;
+    }
+
+    OGREnvelope sExtent;
+    bool bComplete = true;
+    for( const auto& oBatch: m_aoBatches )
+    {
+        if( oBatch.nRows == 0 )
+            continue;
+        if( iGeomField >= static_cast<int>(oBatch.abHasExtent.size()) )
+        {
+            bComplete = false;
+            break;
+        }
+        if( oBatch.abHasExtent[iGeomField] )
+            sExtent.Merge(oBatch.asExtents[iGeomField]);
+    }
+    if( bComplete && sExtent.IsInit() )
+    {
+        *psExtent = sExtent;
+        return OGRERR_NONE;
+    }
+    return GetExtentInternal(iGeomField, psExtent, bForce);
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRArrowLayer::TestCapability( const char *pszCap )
+{
+    if( EQUAL(pszCap, OLCFastFeatureCount) )
+        return m_bCreate ||
+               (m_poFilterGeom == nullptr && m_poAttrQuery == nullptr);
+    if( EQUAL(pszCap, OLCFastGetExtent) )
+        return m_bCreate || m_bHasExtent;
+    if( EQUAL(pszCap, OLCRandomRead) )
+        return !m_bCreate && m_iFIDColumn < 0;
+    if( EQUAL(pszCap, OLCIgnoreFields) )
+        return !m_bCreate;
+    if( EQUAL(pszCap, OLCCreateField) )
+        return m_bCreate && m_sSchema.release == nullptr;
+    if( EQUAL(pszCap, OLCSequentialWrite) )
+        return m_bCreate;
+    if( EQUAL(pszCap, OLCStringsAsUTF8) )
+        return TRUE;
+    return FALSE;
+}
+
+/* ==================================================================== */
+/*                               Writing                                */
+/* ==================================================================== */
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+OGRArrowLayer *OGRArrowLayer::Create( const char* pszFilename,
+                                      const char* pszLayerName,
+                                      OGRSpatialReference* poSRS,
+                                      OGRwkbGeometryType eGType,
+                                      CSLConstList papszOptions )
+{
+    const char* pszFormat = CSLFetchNameValueDef(papszOptions, "FORMAT",
+        EQUAL(CPLGetExtension(pszFilename), "arrows") ? "STREAM" : "FILE");
+    if( !EQUAL(pszFormat, "FILE") && !EQUAL(pszFormat, "STREAM") )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "Invalid value for FORMAT: %s", pszFormat);
+        return nullptr;
+    }
+    const int nBatchSize = atoi(CSLFetchNameValueDef(
+        papszOptions, "BATCH_SIZE", CPLSPrintf("%d", DEFAULT_BATCH_SIZE)));
+    if( nBatchSize <= 0 )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "Invalid value for BATCH_SIZE: %d", nBatchSize);
+        return nullptr;
+    }
+
+    std::unique_ptr<OGRArrowLayer> poLayer(new OGRArrowLayer());
+    poLayer->m_osFilename = pszFilename;
+    poLayer->m_bWriteStream = EQUAL(pszFormat, "STREAM");
+    poLayer->m_nBatchSize = nBatchSize;
+    poLayer->m_osFIDColumn = CSLFetchNameValueDef(papszOptions, "FID", "");
+
+    poLayer->m_poFeatureDefn = new OGRFeatureDefn(pszLayerName);
+    poLayer->SetDescription(pszLayerName);
+    poLayer->m_poFeatureDefn->Reference();
+    poLayer->m_poFeatureDefn->SetGeomType(wkbNone);
+    if( eGType != wkbNone )
+    {
+        OGRGeomFieldDefn oGeomField(
+            CSLFetchNameValueDef(papszOptions, "GEOMETRY_NAME", "geometry"),
+            eGType);
+        if( poSRS )
+        {
+            OGRSpatialReference* poSRSClone = poSRS->Clone();
+            poSRSClone->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+            oGeomField.SetSpatialRef(poSRSClone);
+            poSRSClone->Release();
+        }
+        poLayer->m_poFeatureDefn->AddGeomFieldDefn(&oGeomField);
+    }
+
+    poLayer->m_poFp = VSIFOpenL(pszFilename, "wb");
+    if( poLayer->m_poFp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_OpenFailed,
+                 "Cannot create %s", pszFilename);
+        return nullptr;
+    }
+
+    poLayer->m_bCreate = true;
+    return poLayer.release();
+}
+
+/************************************************************************/
+/*                            CreateField()                             */
+/************************************************************************/
+
+OGRErr OGRArrowLayer::CreateField( OGRFieldDefn *poField, int bApproxOK )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateField() not supported on read-only layer");
+        return OGRERR_FAILURE;
+    }
+    if( m_sSchema.release )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateField() not supported after features have been "
+                 "written");
+        return OGRERR_FAILURE;
+    }
+    if( !m_osFIDColumn.empty() &&
+        EQUAL(poField->GetNameRef(), m_osFIDColumn.c_str()) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Field %s is the FID column", poField->GetNameRef());
+        return OGRERR_FAILURE;
+    }
+
+    OGRFieldDefn oField(poField);
+    switch( oField.GetType() )
+    {
+        case OFTInteger:
+        case OFTInteger64:
+        case OFTReal:
+        case OFTString:
+        case OFTBinary:
+        case OFTDate:
+        case OFTTime:
+        case OFTDateTime:
+        case OFTIntegerList:
+        case OFTInteger64List:
+        case OFTRealList:
+        case OFTStringList:
+            break;
+        default:
+            if( !bApproxOK )
+            {
+                CPLError(CE_Failure, CPLE_NotSupported,
+                         "Field %s of type %s not supported",
+                         oField.GetNameRef(),
+                         OGRFieldDefn::GetFieldTypeName(oField.GetType()));
+                return OGRERR_FAILURE;
+            }
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "Field %s of type %s converted to String",
+                     oField.GetNameRef(),
+                     OGRFieldDefn::GetFieldTypeName(oField.GetType()));
+            oField.SetType(OFTString);
+            oField.SetSubType(OFSTNone);
+            break;
+    }
+
+    m_poFeatureDefn->AddFieldDefn(&oField);
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                             WriteBytes()                             */
+/************************************************************************/
+
+bool OGRArrowLayer::WriteBytes( const void* pData, size_t nSize )
+{
+    if( nSize && VSIFWriteL(pData, nSize, 1, m_poFp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot write to %s",
+                 m_osFilename.c_str());
+        return false;
+    }
+    m_nWriteOffset += nSize;
+    return true;
+}
+
+/************************************************************************/
+/*                           GetGeoMetadata()                           */
+/*                                                                      */
+/*      GeoParquet "geo" metadata. The extent is only known in the      */
+/*      footer.                                                         */
+/************************************************************************/
+
+std::string OGRArrowLayer::GetGeoMetadata( bool bWithExtent ) const
+{
+    CPLJSONObject oRoot;
+    oRoot.Add("version", "0.1.0");
+    oRoot.Add("primary_column",
+              m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef());
+
+    CPLJSONObject oColumns;
+    for( int i = 0; i < m_poFeatureDefn->GetGeomFieldCount(); i++ )
+    {
+        const OGRGeomFieldDefn* poGeomField =
+            m_poFeatureDefn->GetGeomFieldDefn(i);
+        CPLJSONObject oColumn;
+        oColumn.Add("encoding", "WKB");
+
+        CPLJSONArray oTypes;
+        const OGRwkbGeometryType eGType = poGeomField->GetType();
+        const char* pszType = nullptr;
+        switch( wkbFlatten(eGType) )
+        {
+            case wkbPoint: pszType = "Point"; break;
+            case wkbLineString: pszType = "LineString"; break;
+            case wkbPolygon: pszType = "Polygon"; break;
+            case wkbMultiPoint: pszType = "MultiPoint"; break;
+            case wkbMultiLineString: pszType = "MultiLineString"; break;
+            case wkbMultiPolygon: pszType = "MultiPolygon"; break;
+            case wkbGeometryCollection: pszType = "GeometryCollection"; break;
+            default: break;
+        }
+        if( pszType )
+            oTypes.Add(std::string(pszType) + (wkbHasZ(eGType) ? " Z" : ""));
+        oColumn.Add("geometry_types", oTypes);
+
+        const OGRSpatialReference* poSRS = poGeomField->GetSpatialRef();
+        char* pszWKT = nullptr;
+        const char* const apszOptions[] = { "FORMAT=WKT2_2018", nullptr };
+        if( poSRS && poSRS->exportToWkt(&pszWKT, apszOptions) == OGRERR_NONE )
+            oColumn.Add("crs", pszWKT);
+        else
+            oColumn.AddNull("crs");
+        CPLFree(pszWKT);
+
+        if( bWithExtent && i == 0 && m_sExtent.IsInit() )
+        {
+            CPLJSONArray oBBox;
+            oBBox.Add(m_sExtent.MinX);
+            oBBox.Add(m_sExtent.MinY);
+            oBBox.Add(m_sExtent.MaxX);
+            oBBox.Add(m_sExtent.MaxY);
+            oColumn.Add("bbox", oBBox);
+        }
+        oColumns.Add(poGeomField->GetNameRef(), oColumn);
+    }
+    oRoot.Add("columns", oColumns);
+    return oRoot.Format(CPLJSONObject::Plain);
+}
+
+/************************************************************************/
+/*                           StartWriting()                             */
+/*                                                                      */
+/*      The schema is frozen and written with the first feature.       */
+/************************************************************************/
+
+bool OGRArrowLayer::StartWriting()
+{
+    const bool bIncludeFID = !m_osFIDColumn.empty();
+    if( !OGRArrowArrayBuilder::FillSchema(m_poFeatureDefn, bIncludeFID,
+                                          m_osFIDColumn.c_str(), &m_sSchema) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Cannot build schema");
+        return false;
+    }
+
+    KeyValueList aoMetadata;
+    if( m_poFeatureDefn->GetGeomFieldCount() )
+        aoMetadata.emplace_back(GEO_METADATA_KEY, GetGeoMetadata(false));
+    if( bIncludeFID )
+        aoMetadata.emplace_back(FID_METADATA_KEY, m_osFIDColumn);
+
+    std::vector<GByte> abyMessage;
+    if( !BuildSchemaMessage(&m_sSchema, aoMetadata, abyMessage) )
+        return false;
+    if( !m_bWriteStream )
+    {
+        GByte abyHeader[nFileHeaderSize] = { 0 };
+        memcpy(abyHeader, abyMagicBytes, nMagicBytesSize);
+        if( !WriteBytes(abyHeader, sizeof(abyHeader)) )
+            return false;
+    }
+    if( !WriteBytes(abyMessage.data(), abyMessage.size()) )
+        return false;
+
+    m_aoBatchStats.assign(m_poFeatureDefn->GetFieldCount(), ColumnStats());
+    m_asBatchExtents.assign(m_poFeatureDefn->GetGeomFieldCount(),
+                            OGREnvelope());
+    m_abHasBatchExtent.assign(m_poFeatureDefn->GetGeomFieldCount(), false);
+    m_poBuilder.reset(new OGRArrowArrayBuilder(m_poFeatureDefn, bIncludeFID));
+    return true;
+}
+
+/************************************************************************/
+/*                         UpdateStatistics()                           */
+/************************************************************************/
+
+void OGRArrowLayer::UpdateStatistics( const OGRFeature* poFeature )
+{
+    for( int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( !poFeature->IsFieldSetAndNotNull(i) )
+            continue;
+        ColumnStats& oStats = m_aoBatchStats[i];
+        const OGRFieldType eType =
+            m_poFeatureDefn->GetFieldDefn(i)->GetType();
+        if( eType == OFTInteger || eType == OFTInteger64 )
+        {
+            const GIntBig nVal = poFeature->GetFieldAsInteger64(i);
+            if( oStats.eType == ColumnStats::NONE )
+            {
+                oStats.eType = ColumnStats::INTEGER;
+                oStats.nMin = nVal;
+                oStats.nMax = nVal;
+            }
+            oStats.nMin = std::min(oStats.nMin, nVal);
+            oStats.nMax = std::max(oStats.nMax, nVal);
+        }
+        else if( eType == OFTReal )
+        {
+            const double dfVal = poFeature->GetFieldAsDouble(i);
+            if( CPLIsNan(dfVal) )
+                continue;
+            if( oStats.eType == ColumnStats::NONE )
+            {
+                oStats.eType = ColumnStats::REAL;
+                oStats.dfMin = dfVal;
+                oStats.dfMax = dfVal;
+            }
+            oStats.dfMin = std::min(oStats.dfMin, dfVal);
+            oStats.dfMax = std::max(oStats.dfMax, dfVal);
+        }
+    }
+
+    for( int i = 0; i < m_poFeatureDefn->GetGeomFieldCount(); i++ )
+    {
+        OGREnvelope sEnvelope;
+        if( !poFeature->GetGeomFieldEnvelope(i, &sEnvelope) )
+            continue;
+        m_asBatchExtents[i].Merge(sEnvelope);
+        m_abHasBatchExtent[i] = true;
+        if( i == 0 )
+            m_sExtent.Merge(sEnvelope);
+    }
+}
+
+/************************************************************************/
+/*                        GetBatchStatistics()                          */
+/************************************************************************/
+
+std::string OGRArrowLayer::GetBatchStatistics() const
+{
+    CPLJSONObject oRoot;
+    CPLJSONObject oMin;
+    CPLJSONObject oMax;
+    for( int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++ )
+    {
+        const ColumnStats& oStats = m_aoBatchStats[i];
+        const char* pszName = m_poFeatureDefn->GetFieldDefn(i)->GetNameRef();
+        if( oStats.eType == ColumnStats::INTEGER )
+        {
+            oMin.Add(pszName, static_cast<GInt64>(oStats.nMin));
+            oMax.Add(pszName, static_cast<GInt64>(oStats.nMax));
+        }
+        else if( oStats.eType == ColumnStats::REAL &&
+                 !CPLIsInf(oStats.dfMin) && !CPLIsInf(oStats.dfMax) )
+        {
+            oMin.Add(pszName, oStats.dfMin);
+            oMax.Add(pszName, oStats.dfMax);
+        }
+    }
+    oRoot.Add("min", oMin);
+    oRoot.Add("max", oMax);
+
+    CPLJSONObject oBBoxes;
+    for( int i = 0; i < m_poFeatureDefn->GetGeomFieldCount(); i++ )
+    {
+        if( !m_abHasBatchExtent[i] )
+            continue;
+        CPLJSONArray oBBox;
+        oBBox.Add(m_asBatchExtents[i].MinX);
+        oBBox.Add(m_asBatchExtents[i].MinY);
+        oBBox.Add(m_asBatchExtents[i].MaxX);
+        oBBox.Add(m_asBatchExtents[i].MaxY);
+        oBBoxes.Add(m_poFeatureDefn->GetGeomFieldDefn(i)->GetNameRef(),
+                    oBBox);
+    }
+    oRoot.Add("bbox", oBBoxes);
+    return oRoot.Format(CPLJSONObject::Plain);
+}
+
+/************************************************************************/
+/*                             FlushBatch()                             */
+/************************************************************************/
+
+bool OGRArrowLayer::FlushBatch()
+{
+    if( !m_poBuilder || m_poBuilder->GetRowCount() == 0 )
+        return true;
+
+    struct ArrowArray sArray;
+    if( !m_poBuilder->Finish(&sArray) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Record batch too large. Use a smaller BATCH_SIZE");
+        return false;
+    }
+    m_poBuilder.reset(
+        new OGRArrowArrayBuilder(m_poFeatureDefn, !m_osFIDColumn.empty()));
+
+    KeyValueList aoMetadata;
+    aoMetadata.emplace_back(STATISTICS_METADATA_KEY, GetBatchStatistics());
+    std::vector<GByte> abyMessage;
+    std::vector<GByte> abyBody;
+    const bool bOK = BuildRecordBatchMessage(&m_sSchema, &sArray, aoMetadata,
+                                             abyMessage, abyBody);
+    sArray.release(&sArray);
+    if( !bOK )
+        return false;
+
+    Block sBlock;
+    sBlock.nOffset = static_cast<GIntBig>(m_nWriteOffset);
+    sBlock.nMetaDataLength = static_cast<int32_t>(abyMessage.size());
+    sBlock.nBodyLength = static_cast<GIntBig>(abyBody.size());
+    if( !WriteBytes(abyMessage.data(), abyMessage.size()) ||
+        !WriteBytes(abyBody.data(), abyBody.size()) )
+        return false;
+    m_aoBlocks.push_back(sBlock);
+
+    m_aoBatchStats.assign(m_aoBatchStats.size(), ColumnStats());
+    m_asBatchExtents.assign(m_asBatchExtents.size(), OGREnvelope());
+    m_abHasBatchExtent.assign(m_abHasBatchExtent.size(), false);
+    return true;
+}
+
+/************************************************************************/
+/*                           ICreateFeature()                           */
+/************************************************************************/
+
+OGRErr OGRArrowLayer::ICreateFeature( OGRFeature *poFeature )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateFeature() not supported on read-only layer");
+        return OGRERR_FAILURE;
+    }
+    if( m_bWriteError )
+        return OGRERR_FAILURE;
+
+    // The geometry types of the "geo" metadata must hold.
+    for( int i = 0; i < m_poFeatureDefn->GetGeomFieldCount(); i++ )
+    {
+        const OGRwkbGeometryType eLayerGType =
+            m_poFeatureDefn->GetGeomFieldDefn(i)->GetType();
+        if( wkbFlatten(eLayerGType) == wkbUnknown )
+            continue;
+        OGRwkbGeometryType eGType = wkbNone;
+        size_t nWKBSize = 0;
+        const GByte* pabyWKB = poFeature->GetGeomFieldLazyWKB(i, &nWKBSize);
+        if( pabyWKB != nullptr )
+        {
+            if( nWKBSize < 5 ||
+                OGRReadWKBGeometryType(pabyWKB, wkbVariantIso,
+                                       &eGType) != OGRERR_NONE )
+                eGType = wkbUnknown;
+        }
+        else if( poFeature->GetGeomFieldRef(i) != nullptr )
+        {
+            eGType = poFeature->GetGeomFieldRef(i)->getGeometryType();
+        }
+        if( eGType != wkbNone && wkbFlatten(eGType) != wkbFlatten(eLayerGType) )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot write geometry of type %s in a layer of type %s",
+                     OGRGeometryTypeToName(eGType),
+                     OGRGeometryTypeToName(eLayerGType));
+            return OGRERR_FAILURE;
+        }
+    }
+
+    try
+    {
+        if( !m_sSchema.release && !StartWriting() )
+        {
+            m_bWriteError = true;
+            return OGRERR_FAILURE;
+        }
+
+        // Without FID column, features are identified by their row.
+        if( m_osFIDColumn.empty() || poFeature->GetFID() == OGRNullFID )
+            poFeature->SetFID(m_nFeatureCount);
+
+        UpdateStatistics(poFeature);
+        m_poBuilder->AppendFeature(poFeature);
+        m_nFeatureCount++;
+        if( m_poBuilder->GetRowCount() >= m_nBatchSize && !FlushBatch() )
+        {
+            m_bWriteError = true;
+            return OGRERR_FAILURE;
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory in CreateFeature()");
+        m_bWriteError = true;
+        return OGRERR_FAILURE;
+    }
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                              Finalize()                              */
+/*                                                                      */
+/*      Writes the last batch, the end of stream marker and, for the    */
+/*      file format, the footer that lists the record batches.          */
+/************************************************************************/
+
+bool OGRArrowLayer::Finalize()
+{
+    m_bCreate = false;
+    bool bOK = !m_bWriteError;
+
+    try
+    {
+        if( bOK && !m_sSchema.release )
+            bOK = StartWriting();
+        bOK = bOK && FlushBatch();
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Out of memory in Finalize()");
+        bOK = false;
+    }
+    m_poBuilder.reset();
+
+    if( bOK )
+    {
+        GByte abyEOS[8];
+        WriteLE<uint32_t>(abyEOS, nContinuationMarker);
+        WriteLE<uint32_t>(abyEOS + 4, 0);
+        bOK = WriteBytes(abyEOS, sizeof(abyEOS));
+    }
+
+    if( bOK && !m_bWriteStream )
+    {
+        KeyValueList aoMetadata;
+        if( m_poFeatureDefn->GetGeomFieldCount() )
+            aoMetadata.emplace_back(GEO_METADATA_KEY, GetGeoMetadata(true));
+        if( !m_osFIDColumn.empty() )
+            aoMetadata.emplace_back(FID_METADATA_KEY, m_osFIDColumn);
+        std::vector<GByte> abyFooter;
+        GByte abySize[4];
+        bOK = BuildFooter(&m_sSchema, aoMetadata, m_aoBlocks, abyFooter);
+        if( bOK )
+            WriteLE<int32_t>(abySize, static_cast<int32_t>(abyFooter.size()));
+        bOK = bOK && WriteBytes(abyFooter.data(), abyFooter.size()) &&
+              WriteBytes(abySize, sizeof(abySize)) &&
+              WriteBytes(abyMagicBytes, nMagicBytesSize);
+    }
+
+    if( VSIFCloseL(m_poFp) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Error while closing %s",
+                 m_osFilename.c_str());
+        bOK = false;
+    }
+    m_poFp = nullptr;
+    return bOK;
+}
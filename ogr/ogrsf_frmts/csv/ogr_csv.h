@@ -32,8 +32,11 @@
 #define OGR_CSV_H_INCLUDED
 
 #include "ogrsf_frmts.h"
+#include "cpl_worker_thread_pool.h"
 
+#include <memory>
 #include <set>
+#include <vector>
 
 #if defined(_MSC_VER) && _MSC_VER <= 1600 // MSVC <= 2010
 # define GDAL_OVERRIDE
@@ -94,6 +97,12 @@ class OGRCSVLayer : public OGRLayer
     bool                bHasFieldNames;
 
     OGRFeature         *GetNextUnfilteredFeature();
+    OGRFeature         *BuildFeature( char **papszTokens );
+    OGRFeature         *BuildFeature( char **papszTokens, int nFID,
+                                      bool &bWarningEmitted ) const;
+    bool                GetXYFromTokens( char **papszTokens, int nAttrCount,
+                                         double &dfX, double &dfY,
+                                         bool *pbGNIS = nullptr ) const;
 
     bool                bNew;
     bool                bInWriteMode;
@@ -144,6 +153,16 @@ class OGRCSVLayer : public OGRLayer
 
     char              **GetNextLineTokens();
 
+    // NUM_THREADS open option: records are translated by batches
+    int                 m_nNumThreads = 1;
+    std::unique_ptr<CPLJobQueue> m_poJobQueue{};
+    std::vector<OGRFeature*> m_apoBatchFeatures{};
+    size_t              m_nBatchIdx = 0;
+    int                 GetNumThreads();
+    void                ClearBatch();
+    bool                ReadBatch();
+    static void         ParsingJobThreadFunc( void* pData );
+
     static bool         Matches( const char *pszFieldName,
                                  char **papszPossibleNames );
 
@@ -374,6 +374,7 @@ void RegisterOGRCSV()
 "    <Value>AUTO</Value>"
 "  </Option>"
 "  <Option name='EMPTY_STRING_AS_NULL' type='boolean' description='Whether to consider empty strings as null fields on reading' default='NO'/>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads to use to translate records when reading. Integer value or ALL_CPUS' default='GDAL_NUM_THREADS config option or 1'/>"
 "</OpenOptionList>");
 
     poDriver->SetMetadataItem(GDAL_DCAP_VIRTUALIO, "YES");
@@ -145,52 +145,41 @@ static char **CSVSplitLine( const char *pszString, char chDelimiter,
 }
 
 /************************************************************************/
-/*                      OGRCSVReadParseLineL()                          */
+/*                         OGRCSVReadRecordL()                          */
 /*                                                                      */
-/*      Read one line, and return split into fields.  The return        */
-/*      result is a stringlist, in the sense of the CSL functions.      */
+/*      Read the text of one record, that is one line, or several       */
+/*      lines as long as the number of double quotes is odd.            */
 /************************************************************************/
 
-char **OGRCSVReadParseLineL( VSILFILE *fp, char chDelimiter,
-                             bool bDontHonourStrings,
-                             bool bKeepLeadingAndClosingQuotes,
-                             bool bMergeDelimiter )
+static bool OGRCSVReadRecordL( VSILFILE *fp, char chDelimiter,
+                               bool bDontHonourStrings, CPLString &osRecord )
 
 {
     const char *pszLine = CPLReadLineL(fp);
     if( pszLine == nullptr )
-        return nullptr;
+        return false;
 
     // Skip BOM.
     const GByte *pabyData = reinterpret_cast<const GByte *>(pszLine);
     if( pabyData[0] == 0xEF && pabyData[1] == 0xBB && pabyData[2] == 0xBF )
         pszLine += 3;
 
+    osRecord = pszLine;
+
     // Special fix to read NdfcFacilities.xls with un-balanced double quotes.
     if( chDelimiter == '\t' && bDontHonourStrings )
-    {
-        return CSLTokenizeStringComplex(pszLine, "\t", FALSE, TRUE);
-    }
-
-    // If there are no quotes, then this is the simple case.
-    // Parse, and return tokens.
-    if( strchr(pszLine,'\"') == nullptr )
-        return CSVSplitLine(pszLine, chDelimiter, bKeepLeadingAndClosingQuotes,
-                            bMergeDelimiter);
+        return true;
 
     // We must now count the quotes in our working string, and as
     // long as it is odd, keep adding new lines.
-    char *pszWorkLine = CPLStrdup(pszLine);
-
-    int i = 0;
+    size_t i = 0;
     int nCount = 0;
-    size_t nWorkLineLength = strlen(pszWorkLine);
 
     while( true )
     {
-        for( ; pszWorkLine[i] != '\0'; i++ )
+        for( ; i < osRecord.size(); i++ )
         {
-            if( pszWorkLine[i] == '\"' )
+            if( osRecord[i] == '\"' )
                 nCount++;
         }
 
@@ -201,28 +190,53 @@ char **OGRCSVReadParseLineL( VSILFILE *fp, char chDelimiter,
         if( pszLine == nullptr )
             break;
 
-        const size_t nLineLen = strlen(pszLine);
+        // The '\n' gets lost in CPLReadLine().
+        osRecord += '\n';
+        osRecord += pszLine;
+    }
 
-        char *pszWorkLineTmp = static_cast<char *>(
-            VSI_REALLOC_VERBOSE(pszWorkLine, nWorkLineLength + nLineLen + 2));
-        if( pszWorkLineTmp == nullptr )
-            break;
-        pszWorkLine = pszWorkLineTmp;
+    return true;
+}
 
-        // The '\n' gets lost in CPLReadLine().
-        strcat(pszWorkLine + nWorkLineLength, "\n");
-        strcat(pszWorkLine + nWorkLineLength, pszLine);
+/************************************************************************/
+/*                         OGRCSVSplitRecord()                          */
+/************************************************************************/
 
-        nWorkLineLength += nLineLen + 1;
+static char **OGRCSVSplitRecord( const char *pszRecord, char chDelimiter,
+                                 bool bDontHonourStrings,
+                                 bool bKeepLeadingAndClosingQuotes,
+                                 bool bMergeDelimiter )
+
+{
+    // Special fix to read NdfcFacilities.xls with un-balanced double quotes.
+    if( chDelimiter == '\t' && bDontHonourStrings )
+    {
+        return CSLTokenizeStringComplex(pszRecord, "\t", FALSE, TRUE);
     }
 
-    char **papszReturn =
-        CSVSplitLine(pszWorkLine, chDelimiter, bKeepLeadingAndClosingQuotes,
-                     bMergeDelimiter);
+    return CSVSplitLine(pszRecord, chDelimiter, bKeepLeadingAndClosingQuotes,
+                        bMergeDelimiter);
+}
 
-    CPLFree(pszWorkLine);
+/************************************************************************/
+/*                      OGRCSVReadParseLineL()                          */
+/*                                                                      */
+/*      Read one line, and return split into fields.  The return        */
+/*      result is a stringlist, in the sense of the CSL functions.      */
+/************************************************************************/
 
-    return papszReturn;
+char **OGRCSVReadParseLineL( VSILFILE *fp, char chDelimiter,
+                             bool bDontHonourStrings,
+                             bool bKeepLeadingAndClosingQuotes,
+                             bool bMergeDelimiter )
+
+{
+    CPLString osRecord;
+    if( !OGRCSVReadRecordL(fp, chDelimiter, bDontHonourStrings, osRecord) )
+        return nullptr;
+
+    return OGRCSVSplitRecord(osRecord, chDelimiter, bDontHonourStrings,
+                             bKeepLeadingAndClosingQuotes, bMergeDelimiter);
 }
 
 /************************************************************************/
@@ -339,6 +353,7 @@ void OGRCSVLayer::BuildFeatureDefn( const char *pszNfdcGeomField,
     bMergeDelimiter = CPLFetchBool(papszOpenOptions, "MERGE_SEPARATOR", false);
     bEmptyStringNull =
         CPLFetchBool(papszOpenOptions, "EMPTY_STRING_AS_NULL", false);
+    m_nNumThreads = CPLGetNumThreads(papszOpenOptions);
 
     // If this is not a new file, read ahead to establish if it is
     // already in CRLF (DOS) mode, or just a normal unix CR mode.
@@ -1038,6 +1053,314 @@ static bool OGRCSVIsFalse(const char *pszStr)
            EQUAL(pszStr, "no") || EQUAL(pszStr, "off");
 }
 
+/************************************************************************/
+/*                       OGRCSVPromoteFieldType()                       */
+/*                                                                      */
+/*      Type of a field having values of type eCurType and eNewType.    */
+/************************************************************************/
+
+static OGRFieldType OGRCSVPromoteFieldType( OGRFieldType eCurType,
+                                            OGRFieldType eNewType )
+{
+    if( eCurType == eNewType )
+        return eCurType;
+
+    // Promotion rules.
+    if( eCurType == OFTInteger )
+    {
+        if( eNewType == OFTInteger64 || eNewType == OFTReal )
+            return eNewType;
+        return OFTString;
+    }
+    else if( eCurType == OFTInteger64 )
+    {
+        if( eNewType == OFTReal )
+            return eNewType;
+        else if( eNewType != OFTInteger )
+            return OFTString;
+    }
+    else if( eCurType == OFTReal )
+    {
+        if( eNewType != OFTInteger && eNewType != OFTInteger64 )
+            return OFTString;
+    }
+    else if( eCurType == OFTDate )
+    {
+        if( eNewType == OFTDateTime )
+            return OFTDateTime;
+        return OFTString;
+    }
+    else if( eCurType == OFTDateTime )
+    {
+        if( eNewType != OFTDate )
+            return OFTString;
+    }
+    else if( eCurType == OFTTime )
+    {
+        return OFTString;
+    }
+    return eCurType;
+}
+
+/************************************************************************/
+/*                         OGRCSVAutodetectJob                          */
+/************************************************************************/
+
+namespace {
+
+// Field types deduced from the values of a range of records.
+struct OGRCSVFieldTypeStats
+{
+    std::vector<OGRFieldType> aeFieldType{};
+    std::vector<int>          abFieldBoolean{};
+    std::vector<int>          abFieldSet{};
+    std::vector<int>          anFieldWidth{};
+    std::vector<int>          anFieldPrecision{};
+    // Whether all values that are not numbers are booleans. Needed to
+    // merge the stats of a range in the ones of the previous ranges.
+    std::vector<int>          abAllNonNumericBoolean{};
+    int                       nStringFieldCount = 0;
+};
+
+struct OGRCSVAutodetectJob
+{
+    const char             *pszData = nullptr;
+    size_t                  nLen = 0;
+    bool                    bIgnoreTruncatedLastLine = false;
+    char                    chDelimiter = ',';
+    bool                    bQuotedFieldAsString = false;
+    bool                    bMergeDelimiter = false;
+    bool                    bAutodetectWidth = false;
+    bool                    bAutodetectWidthForIntOrReal = false;
+    int                     nFieldCount = 0;
+    OGRCSVFieldTypeStats    sStats{};
+};
+
+} // namespace
+
+static void OGRCSVAutodetectJobThreadFunc( void* pData )
+{
+    OGRCSVAutodetectJob* psJob = static_cast<OGRCSVAutodetectJob*>(pData);
+    const char chDelimiter = psJob->chDelimiter;
+    const bool bQuotedFieldAsString = psJob->bQuotedFieldAsString;
+    const bool bMergeDelimiter = psJob->bMergeDelimiter;
+    const bool bAutodetectWidth = psJob->bAutodetectWidth;
+    const bool bAutodetectWidthForIntOrReal =
+        psJob->bAutodetectWidthForIntOrReal;
+    const int nFieldCount = psJob->nFieldCount;
+
+    OGRCSVFieldTypeStats& sStats = psJob->sStats;
+    std::vector<OGRFieldType>& aeFieldType = sStats.aeFieldType;
+    std::vector<int>& abFieldBoolean = sStats.abFieldBoolean;
+    std::vector<int>& abFieldSet = sStats.abFieldSet;
+    std::vector<int>& anFieldWidth = sStats.anFieldWidth;
+    std::vector<int>& anFieldPrecision = sStats.anFieldPrecision;
+    std::vector<int>& abAllNonNumericBoolean = sStats.abAllNonNumericBoolean;
+    int& nStringFieldCount = sStats.nStringFieldCount;
+    aeFieldType.resize(nFieldCount);
+    abFieldBoolean.resize(nFieldCount);
+    abFieldSet.resize(nFieldCount);
+    anFieldWidth.resize(nFieldCount);
+    anFieldPrecision.resize(nFieldCount);
+    abAllNonNumericBoolean.resize(nFieldCount, TRUE);
+
+    CPLString osTmpMemFile(CPLSPrintf("/vsimem/tmp%p", psJob));
+    VSILFILE *fpMem = VSIFileFromMemBuffer(
+        osTmpMemFile,
+        reinterpret_cast<GByte *>(const_cast<char*>(psJob->pszData)),
+        psJob->nLen, FALSE);
+
+    while( !VSIFEofL(fpMem) )
+    {
+        char **papszTokens =
+            OGRCSVReadParseLineL(fpMem, chDelimiter, false,
+                                 bQuotedFieldAsString, bMergeDelimiter);
+        // Can happen if we just reach EOF while trying to read new bytes.
+        if( papszTokens == nullptr )
+            break;
+
+        // Ignore last line if it is truncated.
+        if( VSIFEofL(fpMem) && psJob->bIgnoreTruncatedLastLine )
+        {
+            CSLDestroy(papszTokens);
+            break;
+        }
+
+        for( int iField = 0;
+             iField < nFieldCount && papszTokens[iField] != nullptr; iField++ )
+        {
+            if( papszTokens[iField][0] == 0 )
+                continue;
+            if( chDelimiter == ';' )
+            {
+                char *chComma = strchr(papszTokens[iField], ',');
+                if( chComma )
+                    *chComma = '.';
+            }
+            CPLValueType eType = CPLGetValueType(papszTokens[iField]);
+            if( eType != CPL_VALUE_INTEGER && eType != CPL_VALUE_REAL &&
+                !OGRCSVIsTrue(papszTokens[iField]) &&
+                !OGRCSVIsFalse(papszTokens[iField]) )
+            {
+                abAllNonNumericBoolean[iField] = FALSE;
+            }
+
+            int nFieldWidth = 0;
+            int nFieldPrecision = 0;
+
+            if( bAutodetectWidth )
+            {
+                nFieldWidth = static_cast<int>(strlen(papszTokens[iField]));
+                if( papszTokens[iField][0] == '"' &&
+                    papszTokens[iField][nFieldWidth - 1] == '"' )
+                {
+                    nFieldWidth -= 2;
+                }
+                if( eType == CPL_VALUE_REAL &&
+                    bAutodetectWidthForIntOrReal )
+                {
+                    const char *pszDot = strchr(papszTokens[iField], '.');
+                    if( pszDot != nullptr )
+                        nFieldPrecision =
+                            static_cast<int>(strlen(pszDot + 1));
+                }
+            }
+
+            OGRFieldType eOGRFieldType;
+            bool bIsBoolean = false;
+            if( eType == CPL_VALUE_INTEGER )
+            {
+                GIntBig nVal = CPLAtoGIntBig(papszTokens[iField]);
+                if( !CPL_INT64_FITS_ON_INT32(nVal) )
+                    eOGRFieldType = OFTInteger64;
+                else
+                    eOGRFieldType = OFTInteger;
+            }
+            else if( eType == CPL_VALUE_REAL )
+            {
+                eOGRFieldType = OFTReal;
+            }
+            else if( abFieldSet[iField] &&
+                     aeFieldType[iField] == OFTString )
+            {
+                eOGRFieldType = OFTString;
+                if( abFieldBoolean[iField] )
+                {
+                    abFieldBoolean[iField] =
+                        OGRCSVIsTrue(papszTokens[iField]) ||
+                        OGRCSVIsFalse(papszTokens[iField]);
+                }
+            }
+            else
+            {
+                OGRField sWrkField;
+                CPLPushErrorHandler(CPLQuietErrorHandler);
+                const bool bSuccess = CPL_TO_BOOL(
+                    OGRParseDate(papszTokens[iField], &sWrkField, 0));
+                CPLPopErrorHandler();
+                CPLErrorReset();
+                if( bSuccess )
+                {
+                    const bool bHasDate =
+                        strchr(papszTokens[iField], '/') != nullptr ||
+                        strchr(papszTokens[iField], '-') != nullptr;
+                    const bool bHasTime =
+                        strchr(papszTokens[iField], ':') != nullptr;
+                    if( bHasDate && bHasTime )
+                        eOGRFieldType = OFTDateTime;
+                    else if( bHasDate )
+                        eOGRFieldType = OFTDate;
+                    else
+                        eOGRFieldType = OFTTime;
+                }
+                else
+                {
+                    eOGRFieldType = OFTString;
+                    bIsBoolean = OGRCSVIsTrue(papszTokens[iField]) ||
+                                 OGRCSVIsFalse(papszTokens[iField]);
+                }
+            }
+
+            if( !abFieldSet[iField] )
+            {
+                aeFieldType[iField] = eOGRFieldType;
+                abFieldSet[iField] = TRUE;
+                abFieldBoolean[iField] = bIsBoolean;
+                if( eOGRFieldType == OFTString && !bIsBoolean )
+                    nStringFieldCount++;
+            }
+            else if( aeFieldType[iField] != eOGRFieldType )
+            {
+                const OGRFieldType eNewType = OGRCSVPromoteFieldType(
+                    aeFieldType[iField], eOGRFieldType);
+                if( eNewType == OFTString &&
+                    aeFieldType[iField] != OFTString )
+                    nStringFieldCount++;
+                aeFieldType[iField] = eNewType;
+            }
+
+            if( nFieldWidth > anFieldWidth[iField] )
+                anFieldWidth[iField] = nFieldWidth;
+            if( nFieldPrecision > anFieldPrecision[iField] )
+                anFieldPrecision[iField] = nFieldPrecision;
+        }
+
+        CSLDestroy(papszTokens);
+
+        // If all fields are String and we don't need to compute width,
+        // just stop auto-detection now.
+        if( nStringFieldCount == nFieldCount && bAutodetectWidth )
+            break;
+    }
+
+    VSIFCloseL(fpMem);
+    VSIUnlink(osTmpMemFile);
+}
+
+/************************************************************************/
+/*                      OGRCSVMergeFieldTypeStats()                     */
+/*                                                                      */
+/*      Update the stats of a range of records with the ones of the     */
+/*      range that follows it, as if they had been computed at once.    */
+/************************************************************************/
+
+static void OGRCSVMergeFieldTypeStats( OGRCSVFieldTypeStats& sStats,
+                                       const OGRCSVFieldTypeStats& sNext )
+{
+    for( size_t iField = 0; iField < sStats.aeFieldType.size(); iField++ )
+    {
+        if( !sNext.abFieldSet[iField] )
+            continue;
+        if( !sStats.abFieldSet[iField] )
+        {
+            sStats.aeFieldType[iField] = sNext.aeFieldType[iField];
+            sStats.abFieldSet[iField] = TRUE;
+            sStats.abFieldBoolean[iField] = sNext.abFieldBoolean[iField];
+            sStats.abAllNonNumericBoolean[iField] =
+                sNext.abAllNonNumericBoolean[iField];
+        }
+        else
+        {
+            // A field only becomes a boolean one from its first value,
+            // and then stays one if all its other string values are
+            // booleans.
+            sStats.abFieldBoolean[iField] =
+                sStats.abFieldBoolean[iField] &&
+                sNext.abAllNonNumericBoolean[iField];
+            sStats.aeFieldType[iField] = OGRCSVPromoteFieldType(
+                sStats.aeFieldType[iField], sNext.aeFieldType[iField]);
+            sStats.abAllNonNumericBoolean[iField] =
+                sStats.abAllNonNumericBoolean[iField] &&
+                sNext.abAllNonNumericBoolean[iField];
+        }
+        sStats.anFieldWidth[iField] = std::max(sStats.anFieldWidth[iField],
+                                               sNext.anFieldWidth[iField]);
+        sStats.anFieldPrecision[iField] =
+            std::max(sStats.anFieldPrecision[iField],
+                     sNext.anFieldPrecision[iField]);
+    }
+}
+
 /************************************************************************/
 /*                        AutodetectFieldTypes()                        */
 /************************************************************************/
@@ -1086,204 +1409,77 @@ char **OGRCSVLayer::AutodetectFieldTypes(char **papszOpenOptions,
             static_cast<int>(VSIFReadL(pszData, 1, nRequested, fpCSV));
         pszData[nRead] = 0;
 
-        CPLString osTmpMemFile(CPLSPrintf("/vsimem/tmp%p", this));
-        VSILFILE *fpMem = VSIFileFromMemBuffer(
-            osTmpMemFile, reinterpret_cast<GByte *>(pszData), nRead, FALSE);
+        // Records are analyzed by ranges on several threads when the
+        // result does not depend on where the analysis stops.
+        int nThreads = 1;
+        if( !bAutodetectWidth && nRead >= 256 * 1024 )
+            nThreads = GetNumThreads();
 
-        std::vector<OGRFieldType> aeFieldType(nFieldCount);
-        std::vector<int> abFieldBoolean(nFieldCount);
-        std::vector<int> abFieldSet(nFieldCount);
-        std::vector<int> anFieldWidth(nFieldCount);
-        std::vector<int> anFieldPrecision(nFieldCount);
-        int nStringFieldCount = 0;
+        const bool bTruncated =
+            nRead > 0 && nRead == nRequested &&
+            pszData[nRead - 1] != 13 && pszData[nRead - 1] != 10;
 
-        while( !VSIFEofL(fpMem) )
+        // Split at line ends that are not inside a quoted string.
+        std::vector<OGRCSVAutodetectJob> asJobs;
+        size_t nStart = 0;
+        size_t i = 0;
+        bool bInString = false;
+        for( int iJob = 0; iJob < nThreads &&
+                           (iJob == 0 || nStart < static_cast<size_t>(nRead));
+             iJob++ )
         {
-            char **papszTokens =
-                OGRCSVReadParseLineL(fpMem, chDelimiter, false,
-                                     bQuotedFieldAsString, bMergeDelimiter);
-            // Can happen if we just reach EOF while trying to read new bytes.
-            if( papszTokens == nullptr )
-                break;
-
-            // Ignore last line if it is truncated.
-            if( VSIFEofL(fpMem) && nRead == nRequested &&
-                pszData[nRead - 1] != 13 && pszData[nRead - 1] != 10 )
+            size_t nEnd = static_cast<size_t>(nRead);
+            if( iJob + 1 < nThreads )
             {
-                CSLDestroy(papszTokens);
-                break;
-            }
-
-            for( int iField = 0;
-                 iField < nFieldCount && papszTokens[iField] != nullptr; iField++ )
-            {
-                if( papszTokens[iField][0] == 0 )
-                    continue;
-                if( chDelimiter == ';' )
-                {
-                    char *chComma = strchr(papszTokens[iField], ',');
-                    if( chComma )
-                        *chComma = '.';
-                }
-                CPLValueType eType = CPLGetValueType(papszTokens[iField]);
-
-                int nFieldWidth = 0;
-                int nFieldPrecision = 0;
-
-                if( bAutodetectWidth )
+                const size_t nTarget =
+                    static_cast<size_t>(nRead) * (iJob + 1) / nThreads;
+                for( ; i < static_cast<size_t>(nRead); i++ )
                 {
-                    nFieldWidth = static_cast<int>(strlen(papszTokens[iField]));
-                    if( papszTokens[iField][0] == '"' &&
-                        papszTokens[iField][nFieldWidth - 1] == '"' )
+                    if( pszData[i] == '"' )
+                        bInString = !bInString;
+                    else if( pszData[i] == 10 && !bInString && i >= nTarget )
                     {
-                        nFieldWidth -= 2;
-                    }
-                    if( eType == CPL_VALUE_REAL &&
-                        bAutodetectWidthForIntOrReal )
-                    {
-                        const char *pszDot = strchr(papszTokens[iField], '.');
-                        if( pszDot != nullptr )
-                            nFieldPrecision =
-                                static_cast<int>(strlen(pszDot + 1));
-                    }
-                }
-
-                OGRFieldType eOGRFieldType;
-                bool bIsBoolean = false;
-                if( eType == CPL_VALUE_INTEGER )
-                {
-                    GIntBig nVal = CPLAtoGIntBig(papszTokens[iField]);
-                    if( !CPL_INT64_FITS_ON_INT32(nVal) )
-                        eOGRFieldType = OFTInteger64;
-                    else
-                        eOGRFieldType = OFTInteger;
-                }
-                else if( eType == CPL_VALUE_REAL )
-                {
-                    eOGRFieldType = OFTReal;
-                }
-                else if( abFieldSet[iField] &&
-                         aeFieldType[iField] == OFTString )
-                {
-                    eOGRFieldType = OFTString;
-                    if( abFieldBoolean[iField] )
-                    {
-                        abFieldBoolean[iField] =
-                            OGRCSVIsTrue(papszTokens[iField]) ||
-                            OGRCSVIsFalse(papszTokens[iField]);
+                        i++;
+                        break;
                     }
                 }
-                else
-                {
-                    OGRField sWrkField;
-                    CPLPushErrorHandler(CPLQuietErrorHandler);
-                    const bool bSuccess = CPL_TO_BOOL(
-                        OGRParseDate(papszTokens[iField], &sWrkField, 0));
-                    CPLPopErrorHandler();
-                    CPLErrorReset();
-                    if( bSuccess )
-                    {
-                        const bool bHasDate =
-                            strchr(papszTokens[iField], '/') != nullptr ||
-                            strchr(papszTokens[iField], '-') != nullptr;
-                        const bool bHasTime =
-                            strchr(papszTokens[iField], ':') != nullptr;
-                        if( bHasDate && bHasTime )
-                            eOGRFieldType = OFTDateTime;
-                        else if( bHasDate )
-                            eOGRFieldType = OFTDate;
-                        else
-                            eOGRFieldType = OFTTime;
-                    }
-                    else
-                    {
-                        eOGRFieldType = OFTString;
-                        bIsBoolean = OGRCSVIsTrue(papszTokens[iField]) ||
-                                     OGRCSVIsFalse(papszTokens[iField]);
-                    }
-                }
-
-                if( !abFieldSet[iField] )
-                {
-                    aeFieldType[iField] = eOGRFieldType;
-                    abFieldSet[iField] = TRUE;
-                    abFieldBoolean[iField] = bIsBoolean;
-                    if( eOGRFieldType == OFTString && !bIsBoolean )
-                        nStringFieldCount++;
-                }
-                else if( aeFieldType[iField] != eOGRFieldType )
-                {
-                    // Promotion rules.
-                    if( aeFieldType[iField] == OFTInteger )
-                    {
-                        if( eOGRFieldType == OFTInteger64 ||
-                            eOGRFieldType == OFTReal )
-                            aeFieldType[iField] = eOGRFieldType;
-                        else
-                        {
-                            aeFieldType[iField] = OFTString;
-                            nStringFieldCount++;
-                        }
-                    }
-                    else if( aeFieldType[iField] == OFTInteger64 )
-                    {
-                        if( eOGRFieldType == OFTReal )
-                            aeFieldType[iField] = eOGRFieldType;
-                        else if( eOGRFieldType != OFTInteger )
-                        {
-                            aeFieldType[iField] = OFTString;
-                            nStringFieldCount++;
-                        }
-                    }
-                    else if( aeFieldType[iField] == OFTReal )
-                    {
-                        if( eOGRFieldType != OFTInteger &&
-                            eOGRFieldType != OFTInteger64 &&
-                            eOGRFieldType != OFTReal )
-                        {
-                            aeFieldType[iField] = OFTString;
-                            nStringFieldCount++;
-                        }
-                    }
-                    else if( aeFieldType[iField] == OFTDate )
-                    {
-                        if( eOGRFieldType == OFTDateTime )
-                            aeFieldType[iField] = OFTDateTime;
-                        else
-                        {
-                            aeFieldType[iField] = OFTString;
-                            nStringFieldCount++;
-                        }
-                    }
-                    else if( aeFieldType[iField] == OFTDateTime )
-                    {
-                        if( eOGRFieldType != OFTDate &&
-                            eOGRFieldType != OFTDateTime )
-                        {
-                            aeFieldType[iField] = OFTString;
-                            nStringFieldCount++;
-                        }
-                    }
-                    else if( aeFieldType[iField] == OFTTime )
-                    {
-                        aeFieldType[iField] = OFTString;
-                        nStringFieldCount++;
-                    }
-                }
-
-                if( nFieldWidth > anFieldWidth[iField] )
-                    anFieldWidth[iField] = nFieldWidth;
-                if( nFieldPrecision > anFieldPrecision[iField] )
-                    anFieldPrecision[iField] = nFieldPrecision;
+                nEnd = i;
             }
 
-            CSLDestroy(papszTokens);
-
-            // If all fields are String and we don't need to compute width,
-            // just stop auto-detection now.
-            if( nStringFieldCount == nFieldCount && bAutodetectWidth )
-                break;
-        }
+            OGRCSVAutodetectJob sJob;
+            sJob.pszData = pszData + nStart;
+            sJob.nLen = nEnd - nStart;
+            sJob.bIgnoreTruncatedLastLine =
+                nEnd == static_cast<size_t>(nRead) && bTruncated;
+            sJob.chDelimiter = chDelimiter;
+            sJob.bQuotedFieldAsString = bQuotedFieldAsString;
+            sJob.bMergeDelimiter = bMergeDelimiter;
+            sJob.bAutodetectWidth = bAutodetectWidth;
+            sJob.bAutodetectWidthForIntOrReal = bAutodetectWidthForIntOrReal;
+            sJob.nFieldCount = nFieldCount;
+            asJobs.push_back(sJob);
+            nStart = nEnd;
+        }
+
+        for( size_t iJob = 1; iJob < asJobs.size(); iJob++ )
+        {
+            if( !m_poJobQueue->SubmitJob(OGRCSVAutodetectJobThreadFunc,
+                                         &asJobs[iJob]) )
+                OGRCSVAutodetectJobThreadFunc(&asJobs[iJob]);
+        }
+        OGRCSVAutodetectJobThreadFunc(&asJobs[0]);
+        if( asJobs.size() > 1 )
+            m_poJobQueue->WaitCompletion();
+
+        OGRCSVFieldTypeStats& sStats = asJobs[0].sStats;
+        for( size_t iJob = 1; iJob < asJobs.size(); iJob++ )
+            OGRCSVMergeFieldTypeStats(sStats, asJobs[iJob].sStats);
+
+        const std::vector<OGRFieldType>& aeFieldType = sStats.aeFieldType;
+        const std::vector<int>& abFieldBoolean = sStats.abFieldBoolean;
+        const std::vector<int>& abFieldSet = sStats.abFieldSet;
+        const std::vector<int>& anFieldWidth = sStats.anFieldWidth;
+        const std::vector<int>& anFieldPrecision = sStats.anFieldPrecision;
 
         papszFieldTypes =
             static_cast<char **>(CPLCalloc(nFieldCount + 1, sizeof(char *)));
@@ -1339,8 +1535,6 @@ char **OGRCSVLayer::AutodetectFieldTypes(char **papszOpenOptions,
             papszFieldTypes[iField] = CPLStrdup(osFieldType);
         }
 
-        VSIFCloseL(fpMem);
-        VSIUnlink(osTmpMemFile);
     }
     VSIFree(pszData);
 
@@ -1367,6 +1561,8 @@ OGRCSVLayer::~OGRCSVLayer()
     if( bNew && bInWriteMode )
         WriteHeader();
 
+    ClearBatch();
+
     CPLFree(panGeomFieldIndex);
 
     poFeatureDefn->Release();
@@ -1383,6 +1579,8 @@ OGRCSVLayer::~OGRCSVLayer()
 void OGRCSVLayer::ResetReading()
 
 {
+    ClearBatch();
+
     if( fpCSV )
         VSIRewindL(fpCSV);
 
@@ -1425,7 +1623,9 @@ OGRFeature *OGRCSVLayer::GetFeature(GIntBig nFID)
 {
     if( nFID < 1 || fpCSV == nullptr )
         return nullptr;
-    if( nFID < nNextFID || bNeedRewindBeforeRead )
+    // Records of the current batch have already been read from the file.
+    if( nFID < nNextFID || bNeedRewindBeforeRead ||
+        m_nBatchIdx < m_apoBatchFeatures.size() )
         ResetReading();
     while( nNextFID < nFID )
     {
@@ -1448,11 +1648,259 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
     if( fpCSV == nullptr )
         return nullptr;
 
+    if( GetNumThreads() > 1 )
+    {
+        if( m_nBatchIdx == m_apoBatchFeatures.size() && !ReadBatch() )
+            return nullptr;
+        OGRFeature *poFeature = m_apoBatchFeatures[m_nBatchIdx];
+        m_apoBatchFeatures[m_nBatchIdx] = nullptr;
+        m_nBatchIdx++;
+        m_nFeaturesRead++;
+        return poFeature;
+    }
+
     // Read the CSV record.
     char **papszTokens = GetNextLineTokens();
     if( papszTokens == nullptr )
         return nullptr;
 
+    return BuildFeature(papszTokens);
+}
+
+/************************************************************************/
+/*                           GetNumThreads()                            */
+/************************************************************************/
+
+int OGRCSVLayer::GetNumThreads()
+
+{
+    if( m_nNumThreads > 1 && m_poJobQueue == nullptr )
+    {
+        CPLWorkerThreadPool* poPool =
+            CPLGetGlobalWorkerThreadPool(m_nNumThreads);
+        if( poPool )
+            m_poJobQueue = poPool->CreateJobQueue();
+        else
+            m_nNumThreads = 1;
+    }
+    return m_nNumThreads;
+}
+
+/************************************************************************/
+/*                             ClearBatch()                             */
+/************************************************************************/
+
+void OGRCSVLayer::ClearBatch()
+
+{
+    for( size_t i = m_nBatchIdx; i < m_apoBatchFeatures.size(); i++ )
+        delete m_apoBatchFeatures[i];
+    m_apoBatchFeatures.clear();
+    m_nBatchIdx = 0;
+}
+
+/************************************************************************/
+/*                         OGRCSVParsingJob                             */
+/************************************************************************/
+
+namespace {
+
+struct OGRCSVParsingJobError
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+};
+
+struct OGRCSVParsingJob
+{
+    const OGRCSVLayer              *poLayer = nullptr;
+    const std::vector<CPLString>   *paosRecords = nullptr;
+    std::vector<OGRFeature*>       *papoFeatures = nullptr;
+    int                             nFirstFID = 0;
+    size_t                          nStart = 0;
+    size_t                          nEnd = 0;
+    char                            chDelimiter = ',';
+    bool                            bDontHonourStrings = false;
+    bool                            bMergeDelimiter = false;
+    bool                            bWarningEmitted = false;
+    std::vector<OGRCSVParsingJobError> aoErrors{};
+};
+
+} // namespace
+
+static void CPL_STDCALL OGRCSVParsingJobErrorHandler(
+    CPLErr eErrClass, CPLErrorNum nErrNo, const char* pszMsg )
+{
+    OGRCSVParsingJob* psJob =
+        static_cast<OGRCSVParsingJob*>(CPLGetErrorHandlerUserData());
+    psJob->aoErrors.push_back(
+        OGRCSVParsingJobError{eErrClass, nErrNo, pszMsg});
+}
+
+void OGRCSVLayer::ParsingJobThreadFunc( void* pData )
+{
+    OGRCSVParsingJob* psJob = static_cast<OGRCSVParsingJob*>(pData);
+    // Errors are re-emitted by the calling thread.
+    CPLPushErrorHandlerEx(OGRCSVParsingJobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    for( size_t i = psJob->nStart; i < psJob->nEnd; i++ )
+    {
+        char **papszTokens = OGRCSVSplitRecord(
+            (*psJob->paosRecords)[i], psJob->chDelimiter,
+            psJob->bDontHonourStrings, false, psJob->bMergeDelimiter);
+        (*psJob->papoFeatures)[i] = psJob->poLayer->BuildFeature(
+            papszTokens, psJob->nFirstFID + static_cast<int>(i),
+            psJob->bWarningEmitted);
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                             ReadBatch()                              */
+/*                                                                      */
+/*      Read the next records of the file, and translate them into      */
+/*      features with m_nNumThreads threads. The record boundaries     */
+/*      depend on the quoting of all the previous records, so they are  */
+/*      found by the calling thread, which is cheap compared to the     */
+/*      tokenizing and the translation of the values.                   */
+/************************************************************************/
+
+bool OGRCSVLayer::ReadBatch()
+
+{
+    ClearBatch();
+
+    std::vector<CPLString> aosRecords;
+    const size_t nMaxRecords = static_cast<size_t>(m_nNumThreads) * 1000;
+    aosRecords.reserve(nMaxRecords);
+    const int nFirstFID = nNextFID;
+    CPLString osRecord;
+    while( aosRecords.size() < nMaxRecords &&
+           OGRCSVReadRecordL(fpCSV, chDelimiter, bDontHonourStrings,
+                             osRecord) )
+    {
+        // Same as GetNextLineTokens(): empty lines are skipped.
+        if( osRecord.empty() )
+            continue;
+        aosRecords.push_back(osRecord);
+    }
+    if( aosRecords.empty() )
+        return false;
+    nNextFID += static_cast<int>(aosRecords.size());
+
+    // The calling thread takes care of the first range.
+    const size_t nCount = aosRecords.size();
+    std::vector<OGRFeature*> apoFeatures(nCount);
+    std::vector<OGRCSVParsingJob> asJobs(m_nNumThreads);
+    for( int iJob = 0; iJob < m_nNumThreads; iJob++ )
+    {
+        asJobs[iJob].poLayer = this;
+        asJobs[iJob].paosRecords = &aosRecords;
+        asJobs[iJob].papoFeatures = &apoFeatures;
+        asJobs[iJob].nFirstFID = nFirstFID;
+        asJobs[iJob].nStart = nCount * iJob / m_nNumThreads;
+        asJobs[iJob].nEnd = nCount * (iJob + 1) / m_nNumThreads;
+        asJobs[iJob].chDelimiter = chDelimiter;
+        asJobs[iJob].bDontHonourStrings = bDontHonourStrings;
+        asJobs[iJob].bMergeDelimiter = bMergeDelimiter;
+        asJobs[iJob].bWarningEmitted = bWarningBadTypeOrWidth;
+    }
+    for( int iJob = 1; iJob < m_nNumThreads; iJob++ )
+    {
+        if( !m_poJobQueue->SubmitJob(ParsingJobThreadFunc, &asJobs[iJob]) )
+            ParsingJobThreadFunc(&asJobs[iJob]);
+    }
+    ParsingJobThreadFunc(&asJobs[0]);
+    m_poJobQueue->WaitCompletion();
+
+    // Each job may have emitted the warning about invalid values that is
+    // only meant to be emitted once.
+    for( const auto& sJob: asJobs )
+    {
+        if( sJob.bWarningEmitted && bWarningBadTypeOrWidth )
+            continue;
+        for( const auto& oError: sJob.aoErrors )
+        {
+            CPLError(oError.eErrClass, oError.nErrNo, "%s",
+                     oError.osMsg.c_str());
+        }
+        if( sJob.bWarningEmitted )
+            bWarningBadTypeOrWidth = true;
+    }
+
+    m_apoBatchFeatures = std::move(apoFeatures);
+    return true;
+}
+
+/************************************************************************/
+/*                          GetXYFromTokens()                           */
+/*                                                                      */
+/*      Fetch the coordinates of the point geometry of a record when    */
+/*      it comes from longitude/latitude columns.                       */
+/************************************************************************/
+
+bool OGRCSVLayer::GetXYFromTokens( char **papszTokens, int nAttrCount,
+                                   double &dfX, double &dfY,
+                                   bool *pbGNIS ) const
+{
+    if( pbGNIS )
+        *pbGNIS = false;
+
+    // http://www.faa.gov/airports/airport_safety/airportdata_5010/menu/index.cfm
+    // specific
+
+    if( iNfdcLatitudeS != -1 &&
+        iNfdcLongitudeS != -1 &&
+        nAttrCount > iNfdcLatitudeS &&
+        nAttrCount > iNfdcLongitudeS  &&
+        papszTokens[iNfdcLongitudeS][0] != 0 &&
+        papszTokens[iNfdcLatitudeS][0] != 0 )
+    {
+        dfX = CPLAtof(papszTokens[iNfdcLongitudeS]) / 3600.0 *
+            (strchr(papszTokens[iNfdcLongitudeS], 'W') ? -1.0 : 1.0);
+        dfY = CPLAtof(papszTokens[iNfdcLatitudeS]) / 3600.0 *
+            (strchr(papszTokens[iNfdcLatitudeS], 'S') ? -1.0 : 1.0);
+        return true;
+    }
+
+    // GNIS specific.
+    if( iLatitudeField != -1 &&
+        iLongitudeField != -1 &&
+        nAttrCount > iLatitudeField &&
+        nAttrCount > iLongitudeField  &&
+        papszTokens[iLongitudeField][0] != 0 &&
+        papszTokens[iLatitudeField][0] != 0 )
+    {
+        // Some records have dummy 0,0 value.
+        if( papszTokens[iLongitudeField][0] != DIGIT_ZERO ||
+            papszTokens[iLongitudeField][1] != '\0' ||
+            papszTokens[iLatitudeField][0] != DIGIT_ZERO ||
+            papszTokens[iLatitudeField][1] != '\0' )
+        {
+            dfX = CPLAtof(papszTokens[iLongitudeField]);
+            dfY = CPLAtof(papszTokens[iLatitudeField]);
+            if( pbGNIS )
+                *pbGNIS = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/************************************************************************/
+/*                            BuildFeature()                            */
+/*                                                                      */
+/*      Translate a record into a feature. Takes ownership of           */
+/*      papszTokens. This does not change the state of the layer, so    */
+/*      that records can be translated by several threads.              */
+/************************************************************************/
+
+OGRFeature *OGRCSVLayer::BuildFeature( char **papszTokens, int nFID,
+                                       bool &bWarningEmitted ) const
+
+{
     // Create the OGR feature.
     OGRFeature *poFeature = new OGRFeature(poFeatureDefn);
 
@@ -1536,14 +1984,14 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
                 {
                     poFeature->SetField(iOGRField, 0);
                 }
-                else if( !bWarningBadTypeOrWidth )
+                else if( !bWarningEmitted )
                 {
-                    bWarningBadTypeOrWidth = true;
+                    bWarningEmitted = true;
                     CPLError(
                         CE_Warning, CPLE_AppDefined,
                         "Invalid value type found in record %d for field %s. "
                         "This warning will no longer be emitted",
-                        nNextFID, poFieldDefn->GetNameRef());
+                        nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1562,31 +2010,31 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
                 if( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
                 {
                     poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                    if( !bWarningBadTypeOrWidth &&
+                    if( !bWarningEmitted &&
                         (eFieldType == OFTInteger ||
                          eFieldType == OFTInteger64) &&
                         eType == CPL_VALUE_REAL )
                     {
-                        bWarningBadTypeOrWidth = true;
+                        bWarningEmitted = true;
                         CPLError(CE_Warning, CPLE_AppDefined,
                                  "Invalid value type found in record %d for "
                                  "field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth &&
+                    else if( !bWarningEmitted &&
                              poFieldDefn->GetWidth() > 0 &&
                              static_cast<int>(strlen(papszTokens[iAttr])) >
                                  poFieldDefn->GetWidth() )
                     {
-                        bWarningBadTypeOrWidth = true;
+                        bWarningEmitted = true;
                         CPLError(CE_Warning, CPLE_AppDefined,
                                  "Value with a width greater than field width "
                                  "found in record %d for field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth &&
+                    else if( !bWarningEmitted &&
                              eType == CPL_VALUE_REAL &&
                              poFieldDefn->GetWidth() > 0)
                     {
@@ -1597,26 +2045,26 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
                                 : 0;
                         if( nPrecision > poFieldDefn->GetPrecision() )
                         {
-                            bWarningBadTypeOrWidth = true;
+                            bWarningEmitted = true;
                             CPLError(CE_Warning, CPLE_AppDefined,
                                      "Value with a precision greater than "
                                      "field precision found in record %d for "
                                      "field %s. "
                                      "This warning will no longer be emitted",
-                                     nNextFID, poFieldDefn->GetNameRef());
+                                     nFID, poFieldDefn->GetNameRef());
                         }
                     }
                 }
                 else
                 {
-                    if( !bWarningBadTypeOrWidth )
+                    if( !bWarningEmitted )
                     {
-                        bWarningBadTypeOrWidth = true;
+                        bWarningEmitted = true;
                         CPLError(
                             CE_Warning, CPLE_AppDefined,
                             "Invalid value type found in record %d for field "
                             "%s. This warning will no longer be emitted.",
-                            nNextFID, poFieldDefn->GetNameRef());
+                            nFID, poFieldDefn->GetNameRef());
                     }
                 }
             }
@@ -1626,15 +2074,15 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
             if( papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored() )
             {
                 poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                if( !bWarningBadTypeOrWidth &&
+                if( !bWarningEmitted &&
                     !poFeature->IsFieldSetAndNotNull(iOGRField) )
                 {
-                    bWarningBadTypeOrWidth = true;
+                    bWarningEmitted = true;
                     CPLError(
                         CE_Warning, CPLE_AppDefined,
                         "Invalid value type found in record %d for field %s. "
                         "This warning will no longer be emitted",
-                        nNextFID, poFieldDefn->GetNameRef());
+                        nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1647,16 +2095,16 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
             else
             {
                 poFeature->SetField(iOGRField, papszTokens[iAttr]);
-                if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
+                if( !bWarningEmitted && poFieldDefn->GetWidth() > 0 &&
                     static_cast<int>(strlen(papszTokens[iAttr])) >
                         poFieldDefn->GetWidth() )
                 {
-                    bWarningBadTypeOrWidth = true;
+                    bWarningEmitted = true;
                     CPLError(CE_Warning, CPLE_AppDefined,
                              "Value with a width greater than field width "
                              "found in record %d for field %s. "
                              "This warning will no longer be emitted",
-                             nNextFID, poFieldDefn->GetNameRef());
+                             nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1717,58 +2165,34 @@ OGRFeature *OGRCSVLayer::GetNextUnfilteredFeature()
         }
     }
 
-    // http://www.faa.gov/airports/airport_safety/airportdata_5010/menu/index.cfm
-    // specific
-
-    if( iNfdcLatitudeS != -1 &&
-        iNfdcLongitudeS != -1 &&
-        nAttrCount > iNfdcLatitudeS &&
-        nAttrCount > iNfdcLongitudeS  &&
-        papszTokens[iNfdcLongitudeS][0] != 0 &&
-        papszTokens[iNfdcLatitudeS][0] != 0 )
+    double dfLon = 0.0;
+    double dfLat = 0.0;
+    bool bGNIS = false;
+    if( GetXYFromTokens(papszTokens, nAttrCount, dfLon, dfLat, &bGNIS) &&
+        !poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
     {
-        const double dfLon =
-            CPLAtof(papszTokens[iNfdcLongitudeS]) / 3600.0 *
-            (strchr(papszTokens[iNfdcLongitudeS], 'W') ? -1.0 : 1.0);
-        const double dfLat =
-            CPLAtof(papszTokens[iNfdcLatitudeS]) / 3600.0 *
-            (strchr(papszTokens[iNfdcLatitudeS], 'S') ? -1.0 : 1.0);
-        if( !poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
+        if( bGNIS && iZField != -1 && nAttrCount > iZField &&
+            papszTokens[iZField][0] != 0 )
+            poFeature->SetGeometryDirectly(new OGRPoint(
+                dfLon, dfLat, CPLAtof(papszTokens[iZField])));
+        else
             poFeature->SetGeometryDirectly(new OGRPoint(dfLon, dfLat));
     }
 
-    // GNIS specific.
-    else if( iLatitudeField != -1 &&
-             iLongitudeField != -1 &&
-             nAttrCount > iLatitudeField &&
-             nAttrCount > iLongitudeField  &&
-             papszTokens[iLongitudeField][0] != 0 &&
-             papszTokens[iLatitudeField][0] != 0 )
-    {
-        // Some records have dummy 0,0 value.
-        if( papszTokens[iLongitudeField][0] != DIGIT_ZERO ||
-            papszTokens[iLongitudeField][1] != '\0' ||
-            papszTokens[iLatitudeField][0] != DIGIT_ZERO ||
-            papszTokens[iLatitudeField][1] != '\0' )
-        {
-            const double dfLon = CPLAtof(papszTokens[iLongitudeField]);
-            const double dfLat = CPLAtof(papszTokens[iLatitudeField]);
-            if( !poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
-            {
-                if( iZField != -1 && nAttrCount > iZField &&
-                    papszTokens[iZField][0] != 0 )
-                    poFeature->SetGeometryDirectly(new OGRPoint(
-                        dfLon, dfLat, CPLAtof(papszTokens[iZField])));
-                else
-                    poFeature->SetGeometryDirectly(new OGRPoint(dfLon, dfLat));
-            }
-        }
-    }
-
     CSLDestroy(papszTokens);
 
     // Translate the record id.
-    poFeature->SetFID(nNextFID++);
+    poFeature->SetFID(nFID);
+
+    return poFeature;
+}
+
+OGRFeature *OGRCSVLayer::BuildFeature( char **papszTokens )
+
+{
+    OGRFeature *poFeature =
+        BuildFeature(papszTokens, nNextFID, bWarningBadTypeOrWidth);
+    nNextFID++;
 
     m_nFeaturesRead++;
 
@@ -1785,11 +2209,45 @@ OGRFeature *OGRCSVLayer::GetNextFeature()
     if( bNeedRewindBeforeRead )
         ResetReading();
 
+    // When the geometry comes from longitude/latitude columns, records
+    // can be tested against the spatial filter before being translated.
+    const bool bFilterXY =
+        m_poFilterGeom != nullptr && m_iGeomFieldFilter == 0 &&
+        !bIsEurostatTSV &&
+        ((iNfdcLatitudeS != -1 && iNfdcLongitudeS != -1) ||
+         (iLatitudeField != -1 && iLongitudeField != -1)) &&
+        !poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored();
+
     // Read features till we find one that satisfies our current
     // spatial criteria.
     while( true )
     {
-        OGRFeature *poFeature = GetNextUnfilteredFeature();
+        OGRFeature *poFeature = nullptr;
+        if( bFilterXY )
+        {
+            if( fpCSV == nullptr )
+                return nullptr;
+            char **papszTokens = GetNextLineTokens();
+            if( papszTokens == nullptr )
+                return nullptr;
+            const int nAttrCount = std::min(
+                CSLCount(papszTokens),
+                nCSVFieldCount + (bHiddenWKTColumn ? 1 : 0));
+            double dfX = 0.0;
+            double dfY = 0.0;
+            if( !GetXYFromTokens(papszTokens, nAttrCount, dfX, dfY) ||
+                !FilterPoint(dfX, dfY) )
+            {
+                CSLDestroy(papszTokens);
+                nNextFID++;
+                continue;
+            }
+            poFeature = BuildFeature(papszTokens);
+        }
+        else
+        {
+            poFeature = GetNextUnfilteredFeature();
+        }
         if( poFeature == nullptr )
             return nullptr;
 
@@ -57,6 +57,14 @@ public:
     ~DXFBlockDefinition();
 
     std::vector<OGRDXFFeature *> apoFeatures;
+
+    // Features of the block with nested block references inlined, in
+    // block coordinates. Computed on first recursive insertion, the
+    // second one being used when block geometries are merged.
+    bool                         abInlinedFeaturesCached[2] = {false, false};
+    std::vector<OGRDXFFeature *> aapoInlinedFeatures[2];
+
+    bool                         HasBlockReferences() const;
 };
 
 /************************************************************************/
@@ -445,6 +453,10 @@ class OGRDXFLayer final: public OGRLayer
                                            OGRDXFFeatureQueue& apoExtraFeatures,
                                            const bool bInlineNestedBlocks,
                                            const bool bMergeGeometry );
+    bool                InlineNestedBlocks( GUInt32 nInitialErrorCounter,
+                                            const DXFBlockDefinition* poBlock,
+                                            const bool bMergeGeometry,
+                                            std::vector<OGRDXFFeature*>& apoInlinedFeatures );
     OGRDXFFeature *     InsertBlockReference( const CPLString& osBlockName,
                                               const OGRDXFInsertTransformer& oTransformer,
                                               OGRDXFFeature* const poFeature );
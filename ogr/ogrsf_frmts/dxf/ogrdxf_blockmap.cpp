@@ -257,4 +257,23 @@ DXFBlockDefinition::~DXFBlockDefinition()
         delete apoFeatures.back();
         apoFeatures.pop_back();
     }
+    for( auto& apoInlinedFeatures : aapoInlinedFeatures )
+    {
+        for( auto poFeature : apoInlinedFeatures )
+            delete poFeature;
+    }
+}
+
+/************************************************************************/
+/*                        HasBlockReferences()                          */
+/************************************************************************/
+
+bool DXFBlockDefinition::HasBlockReferences() const
+{
+    for( const auto poFeature : apoFeatures )
+    {
+        if( poFeature->IsBlockReference() )
+            return true;
+    }
+    return false;
 }
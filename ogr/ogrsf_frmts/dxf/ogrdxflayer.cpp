@@ -2811,6 +2811,87 @@ OGRDXFFeature *OGRDXFLayer::InsertBlockReference(
     return poFeature;
 }
 
+/************************************************************************/
+/*                         InlineNestedBlocks()                         */
+/*                                                                      */
+/*     Fills apoInlinedFeatures with copies of the features of the      */
+/*     given block, where the block references have been recursively   */
+/*     inserted, in the coordinate system of the block.  Returns false  */
+/*     if the operation was interrupted because of too many errors.     */
+/*     The block must already be on the block insertion stack.          */
+/************************************************************************/
+
+bool OGRDXFLayer::InlineNestedBlocks( GUInt32 nInitialErrorCounter,
+    const DXFBlockDefinition* poBlock,
+    const bool bMergeGeometry,
+    std::vector<OGRDXFFeature*>& apoInlinedFeatures )
+{
+    OGRDXFFeatureQueue apoInnerExtraFeatures;
+
+    for( unsigned int iSubFeat = 0;
+        iSubFeat < poBlock->apoFeatures.size();
+        iSubFeat++ )
+    {
+        OGRDXFFeature *poSubFeature =
+            poBlock->apoFeatures[iSubFeat]->CloneDXFFeature();
+
+        if( !poSubFeature->IsBlockReference() )
+        {
+            apoInlinedFeatures.push_back( poSubFeature );
+            continue;
+        }
+
+        // Unpack the transformation data stored in fields of this
+        // feature
+        OGRDXFInsertTransformer oInnerTransformer;
+        oInnerTransformer.dfXOffset = poSubFeature->oOriginalCoords.dfX;
+        oInnerTransformer.dfYOffset = poSubFeature->oOriginalCoords.dfY;
+        oInnerTransformer.dfZOffset = poSubFeature->oOriginalCoords.dfZ;
+        oInnerTransformer.dfAngle = poSubFeature->dfBlockAngle * M_PI / 180;
+        oInnerTransformer.dfXScale = poSubFeature->oBlockScale.dfX;
+        oInnerTransformer.dfYScale = poSubFeature->oBlockScale.dfY;
+        oInnerTransformer.dfZScale = poSubFeature->oBlockScale.dfZ;
+
+        poSubFeature->bIsBlockReference = false;
+
+        // Insert this block recursively
+        try
+        {
+            poSubFeature = InsertBlockInline(
+                nInitialErrorCounter, poSubFeature->osBlockName,
+                oInnerTransformer, poSubFeature, apoInnerExtraFeatures,
+                true, bMergeGeometry );
+        }
+        catch( const std::invalid_argument& )
+        {
+            // Block doesn't exist. Skip it and keep going
+            delete poSubFeature;
+            if( CPLGetErrorCounter() > nInitialErrorCounter + 1000 )
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if( poSubFeature )
+        {
+            apoInlinedFeatures.push_back( poSubFeature );
+        }
+        else if( CPLGetErrorCounter() > nInitialErrorCounter + 1000 )
+        {
+            return false;
+        }
+
+        while( !apoInnerExtraFeatures.empty() )
+        {
+            apoInlinedFeatures.push_back( apoInnerExtraFeatures.front() );
+            apoInnerExtraFeatures.pop();
+        }
+    }
+
+    return true;
+}
+
 /************************************************************************/
 /*                         InsertBlockInline()                          */
 /*                                                                      */
@@ -2885,173 +2966,125 @@ OGRDXFFeature *OGRDXFLayer::InsertBlockInline( GUInt32 nInitialErrorCounter,
     if( bMergeGeometry )
         poMergedGeometry = new OGRGeometryCollection();
 
-    OGRDXFFeatureQueue apoInnerExtraFeatures;
+/* -------------------------------------------------------------------- */
+/*      When inlining recursively, the nested block references are      */
+/*      only expanded once per block, in block coordinates, and the     */
+/*      result is reused by all the insertions of the block.            */
+/* -------------------------------------------------------------------- */
+    const std::vector<OGRDXFFeature *>* papoBlockFeatures =
+        &poBlock->apoFeatures;
+    std::vector<OGRDXFFeature *> apoUncachedFeatures;
+    if( bInlineRecursively && poBlock->HasBlockReferences() )
+    {
+        const int iCache = bMergeGeometry ? 1 : 0;
+        if( !poBlock->abInlinedFeaturesCached[iCache] )
+        {
+            // Do not cache a result that depends on the insertion stack
+            // (recursion detected) or that was interrupted by errors.
+            const GUInt32 nErrorCounterBefore = CPLGetErrorCounter();
+            if( InlineNestedBlocks( nInitialErrorCounter, poBlock,
+                    bMergeGeometry, apoUncachedFeatures ) &&
+                CPLGetErrorCounter() == nErrorCounterBefore )
+            {
+                poBlock->aapoInlinedFeatures[iCache].swap(
+                    apoUncachedFeatures );
+                poBlock->abInlinedFeaturesCached[iCache] = true;
+            }
+        }
+        papoBlockFeatures = poBlock->abInlinedFeaturesCached[iCache] ?
+            &poBlock->aapoInlinedFeatures[iCache] : &apoUncachedFeatures;
+    }
 
     for( unsigned int iSubFeat = 0;
-        iSubFeat < poBlock->apoFeatures.size();
+        iSubFeat < papoBlockFeatures->size();
         iSubFeat++ )
     {
         OGRDXFFeature *poSubFeature =
-            poBlock->apoFeatures[iSubFeat]->CloneDXFFeature();
+            (*papoBlockFeatures)[iSubFeat]->CloneDXFFeature();
 
-        // Does this feature represent a block reference? If so,
-        // insert that block
-        if( bInlineRecursively && poSubFeature->IsBlockReference() )
-        {
-            // Unpack the transformation data stored in fields of this
-            // feature
-            OGRDXFInsertTransformer oInnerTransformer;
-            oInnerTransformer.dfXOffset = poSubFeature->oOriginalCoords.dfX;
-            oInnerTransformer.dfYOffset = poSubFeature->oOriginalCoords.dfY;
-            oInnerTransformer.dfZOffset = poSubFeature->oOriginalCoords.dfZ;
-            oInnerTransformer.dfAngle = poSubFeature->dfBlockAngle * M_PI / 180;
-            oInnerTransformer.dfXScale = poSubFeature->oBlockScale.dfX;
-            oInnerTransformer.dfYScale = poSubFeature->oBlockScale.dfY;
-            oInnerTransformer.dfZScale = poSubFeature->oBlockScale.dfZ;
-
-            poSubFeature->bIsBlockReference = false;
-
-            // Insert this block recursively
-            try
-            {
-                poSubFeature = InsertBlockInline(
-                    nInitialErrorCounter, poSubFeature->osBlockName,
-                    oInnerTransformer, poSubFeature, apoInnerExtraFeatures,
-                    true, bMergeGeometry );
-            }
-            catch( const std::invalid_argument& )
-            {
-                // Block doesn't exist. Skip it and keep going
-                delete poSubFeature;
-                if( CPLGetErrorCounter() > nInitialErrorCounter + 1000 )
-                {
-                    break;
-                }
-                continue;
-            }
-
-            if( !poSubFeature )
-            {
-                if( CPLGetErrorCounter() > nInitialErrorCounter + 1000 )
-                {
-                    break;
-                }
-                if ( apoInnerExtraFeatures.empty() )
-                {
-                    // Block is empty. Skip it and keep going
-                    continue;
-                }
-                else
-                {
-                    // Load up the first extra feature ready for
-                    // transformation
-                    poSubFeature = apoInnerExtraFeatures.front();
-                    apoInnerExtraFeatures.pop();
-                }
-            }
-        }
-
-        // Go through the current feature and any extra features generated
-        // by the recursive insert, and apply transformations
-        while( true )
+        // Apply the transformations of this insertion
+        OGRGeometry *poSubFeatGeom = poSubFeature->GetGeometryRef();
+        if( poSubFeatGeom != nullptr )
         {
-            OGRGeometry *poSubFeatGeom = poSubFeature->GetGeometryRef();
-            if( poSubFeatGeom != nullptr )
-            {
-                // Rotation and scaling first
-                OGRDXFInsertTransformer oInnerTrans =
-                    oTransformer.GetRotateScaleTransformer();
-                poSubFeatGeom->transform( &oInnerTrans );
+            // Rotation and scaling first
+            OGRDXFInsertTransformer oInnerTrans =
+                oTransformer.GetRotateScaleTransformer();
+            poSubFeatGeom->transform( &oInnerTrans );
 
-                // Then the OCS to WCS transformation
-                poFeature->ApplyOCSTransformer( poSubFeatGeom );
+            // Then the OCS to WCS transformation
+            poFeature->ApplyOCSTransformer( poSubFeatGeom );
 
-                // Offset translation last
-                oInnerTrans = oTransformer.GetOffsetTransformer();
-                poSubFeatGeom->transform( &oInnerTrans );
-            }
-            // Transform the specially-stored data for ASM entities
-            else if( poSubFeature->poASMTransform )
-            {
-                // Rotation and scaling first
-                OGRDXFInsertTransformer oInnerTrans =
-                    oTransformer.GetRotateScaleTransformer();
-                poSubFeature->poASMTransform->ComposeWith( oInnerTrans );
+            // Offset translation last
+            oInnerTrans = oTransformer.GetOffsetTransformer();
+            poSubFeatGeom->transform( &oInnerTrans );
+        }
+        // Transform the specially-stored data for ASM entities
+        else if( poSubFeature->poASMTransform )
+        {
+            // Rotation and scaling first
+            OGRDXFInsertTransformer oInnerTrans =
+                oTransformer.GetRotateScaleTransformer();
+            poSubFeature->poASMTransform->ComposeWith( oInnerTrans );
 
-                // Then the OCS to WCS transformation
-                poFeature->ApplyOCSTransformer( poSubFeature->poASMTransform.get() );
+            // Then the OCS to WCS transformation
+            poFeature->ApplyOCSTransformer( poSubFeature->poASMTransform.get() );
 
-                // Offset translation last
-                oInnerTrans = oTransformer.GetOffsetTransformer();
-                poSubFeature->poASMTransform->ComposeWith( oInnerTrans );
+            // Offset translation last
+            oInnerTrans = oTransformer.GetOffsetTransformer();
+            poSubFeature->poASMTransform->ComposeWith( oInnerTrans );
 
-                poSubFeature->poASMTransform->SetField( poSubFeature, "ASMTransform" );
-            }
+            poSubFeature->poASMTransform->SetField( poSubFeature, "ASMTransform" );
+        }
 
-            // If we are merging features, and this is not text or a block
-            // reference, merge it into the GeometryCollection
-            if( bMergeGeometry && 
-                (poSubFeature->GetStyleString() == nullptr ||
-                    strstr(poSubFeature->GetStyleString(),"LABEL") == nullptr) &&
-                !poSubFeature->IsBlockReference() &&
-                poSubFeature->GetGeometryRef() )
+        // If we are merging features, and this is not text or a block
+        // reference, merge it into the GeometryCollection
+        if( bMergeGeometry &&
+            (poSubFeature->GetStyleString() == nullptr ||
+                strstr(poSubFeature->GetStyleString(),"LABEL") == nullptr) &&
+            !poSubFeature->IsBlockReference() &&
+            poSubFeature->GetGeometryRef() )
+        {
+            poMergedGeometry->addGeometryDirectly( poSubFeature->StealGeometry() );
+            delete poSubFeature;
+        }
+        // Import all other features, except ATTDEFs when inlining
+        // recursively
+        else if( !bInlineRecursively || poSubFeature->osAttributeTag == "" )
+        {
+            // If the subfeature is on layer 0, this is a special case: the
+            // subfeature should take on the style properties of the layer
+            // the block is being inserted onto.
+            // But don't do this if we are inserting onto a Blocks layer
+            // (that is, the owning feature has no layer).
+            if( EQUAL( poSubFeature->GetFieldAsString( "Layer" ), "0" ) &&
+                !EQUAL( poFeature->GetFieldAsString( "Layer" ), "" ) )
             {
-                poMergedGeometry->addGeometryDirectly( poSubFeature->StealGeometry() );
-                delete poSubFeature;
+                poSubFeature->SetField( "Layer",
+                    poFeature->GetFieldAsString( "Layer" ) );
             }
-            // Import all other features, except ATTDEFs when inlining
-            // recursively
-            else if( !bInlineRecursively || poSubFeature->osAttributeTag == "" )
-            {
-                // If the subfeature is on layer 0, this is a special case: the
-                // subfeature should take on the style properties of the layer
-                // the block is being inserted onto.
-                // But don't do this if we are inserting onto a Blocks layer
-                // (that is, the owning feature has no layer).
-                if( EQUAL( poSubFeature->GetFieldAsString( "Layer" ), "0" ) &&
-                    !EQUAL( poFeature->GetFieldAsString( "Layer" ), "" ) )
-                {
-                    poSubFeature->SetField( "Layer",
-                        poFeature->GetFieldAsString( "Layer" ) );
-                }
-
-                // Update the style string to replace ByBlock and ByLayer values.
-                PrepareFeatureStyle( poSubFeature, poFeature );
 
-                ACAdjustText( oTransformer.dfAngle * 180 / M_PI,
-                    oTransformer.dfXScale, oTransformer.dfYScale, poSubFeature );
+            // Update the style string to replace ByBlock and ByLayer values.
+            PrepareFeatureStyle( poSubFeature, poFeature );
 
-                if ( !EQUAL( poFeature->GetFieldAsString( "EntityHandle" ), "" ) )
-                {
-                    poSubFeature->SetField( "EntityHandle",
-                        poFeature->GetFieldAsString( "EntityHandle" ) );
-                }
+            ACAdjustText( oTransformer.dfAngle * 180 / M_PI,
+                oTransformer.dfXScale, oTransformer.dfYScale, poSubFeature );
 
-                apoExtraFeatures.push( poSubFeature );
-            }
-            else
+            if ( !EQUAL( poFeature->GetFieldAsString( "EntityHandle" ), "" ) )
             {
-                delete poSubFeature;
+                poSubFeature->SetField( "EntityHandle",
+                    poFeature->GetFieldAsString( "EntityHandle" ) );
             }
 
-            if( apoInnerExtraFeatures.empty() )
-            {
-                break;
-            }
-            else
-            {
-                poSubFeature = apoInnerExtraFeatures.front();
-                apoInnerExtraFeatures.pop();
-            }
+            apoExtraFeatures.push( poSubFeature );
+        }
+        else
+        {
+            delete poSubFeature;
         }
     }
 
-    while( !apoInnerExtraFeatures.empty() )
-    {
-        auto poFeatureToDelete = apoInnerExtraFeatures.front();
-        apoInnerExtraFeatures.pop();
+    for( auto poFeatureToDelete : apoUncachedFeatures )
         delete poFeatureToDelete;
-    }
 
     poDS->PopBlockInsertion();
 
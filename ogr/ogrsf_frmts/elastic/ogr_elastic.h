@@ -36,7 +36,10 @@
 #include "cpl_hash_set.h"
 #include "ogr_p.h"
 #include "cpl_http.h"
+#include "cpl_worker_thread_pool.h"
 
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <set>
 #include <vector>
@@ -65,6 +68,36 @@ class OGRESSortDesc
             bAsc(other.bAsc) {}
 };
 
+/************************************************************************/
+/*                          OGRElasticRequest                           */
+/************************************************************************/
+
+/* HTTP request run by a worker thread: a _bulk upload, or a page of a */
+/* slice of a sliced scroll */
+struct OGRElasticRequest
+{
+    OGRElasticDataSource *poDS = nullptr;
+    CPLString           osURL{};
+    char              **papszOptions = nullptr;
+    CPLHTTPResult      *psResult = nullptr;
+    bool                bParseJSon = false;
+    json_object        *poResponse = nullptr;
+    std::atomic<bool>   bDone{false};
+
+    ~OGRElasticRequest();
+};
+
+/************************************************************************/
+/*                         OGRElasticScrollSlice                        */
+/************************************************************************/
+
+struct OGRElasticScrollSlice
+{
+    CPLString           osScrollID{};
+    bool                bEOF = false;
+    std::unique_ptr<OGRElasticRequest> poRequest{};
+};
+
 /************************************************************************/
 /*                          OGRElasticLayer                             */
 /************************************************************************/
@@ -92,6 +125,7 @@ class OGRElasticLayer final: public OGRLayer {
 
     CPLString                            m_osBulkContent;
     int                                  m_nBulkUpload;
+    int                                  m_nBulkRequestsInFlight;
 
     CPLString                            m_osFID;
 
@@ -106,6 +140,9 @@ class OGRElasticLayer final: public OGRLayer {
     CPLString                             m_osPrecision;
 
     CPLString                             m_osScrollID;
+    std::vector<std::unique_ptr<OGRElasticScrollSlice>> m_apoScrollSlices{};
+    size_t                                m_iCurScrollSlice = 0;
+    bool                                  m_bSlicedScrollRefused = false;
     GIntBig                               m_iCurID;
     GIntBig                               m_nNextFID;
     int                                   m_iCurFeatureInPage;
@@ -122,7 +159,19 @@ class OGRElasticLayer final: public OGRLayer {
 
     bool                                  m_bAddPretty;
 
-    bool                                  PushIndex();
+    std::unique_ptr<CPLWorkerThreadPool>  m_poWorkerPool{};
+    std::deque<std::unique_ptr<OGRElasticRequest>> m_apoBulkRequests{};
+
+    bool                                  PushIndex(bool bWaitCompletion = true);
+    bool                                  WaitBulkRequests(size_t nMaxRemaining);
+    void                                  SubmitRequest(OGRElasticRequest* poRequest);
+    void                                  WaitRequest(OGRElasticRequest* poRequest);
+    static void                           RequestFunc(void* pData);
+    void                                  BuildFirstScrollRequest(CPLString& osRequest,
+                                                                  CPLString& osPostData);
+    bool                                  StartSlicedScroll();
+    json_object                          *GetNextSlicedScrollPage();
+    void                                  StopSlicedScroll();
     CPLString                             BuildMap();
 
     OGRErr                                WriteMapIfNecessary();
@@ -244,6 +293,8 @@ public:
     bool                m_bJSonField;
     bool                m_bFlattenNestedAttributes;
     int                 m_nMajorVersion;
+    int                 m_nScrollSlices;
+    int                 m_nBulkRequestsInFlight;
 
     int Open(GDALOpenInfo* poOpenInfo);
 
@@ -278,9 +329,12 @@ public:
                                    const CPLString &osVerb = CPLString());
     void                Delete(const CPLString &url);
 
+    bool                CheckUploadResult(CPLHTTPResult* psResult);
     json_object*        RunRequest(const char* pszURL,
                                    const char* pszPostContent = nullptr,
                                    const std::vector<int>& anSilentedHTTPErrors = std::vector<int>());
+    json_object*        ParseRequestResult(CPLHTTPResult* psResult,
+                                   const std::vector<int>& anSilentedHTTPErrors = std::vector<int>());
     const CPLString&    GetFID() const { return m_osFID; }
 };
 
@@ -35,6 +35,8 @@
 #include "ogrgeojsonreader.h"
 #include "swq.h"
 
+#include <algorithm>
+
 CPL_CVSID("$Id: ogrelasticdatasource.cpp 0d495f12298b17db8a9527039823210a419bc8c1 2019-06-10 13:39:10Z jbo-ads $")
 
 /************************************************************************/
@@ -51,7 +53,9 @@ OGRElasticDataSource::OGRElasticDataSource() :
     m_nFeatureCountToEstablishFeatureDefn(100),
     m_bJSonField(false),
     m_bFlattenNestedAttributes(true),
-    m_nMajorVersion(0)
+    m_nMajorVersion(0),
+    m_nScrollSlices(1),
+    m_nBulkRequestsInFlight(1)
 {
     const char* pszWriteMapIn = CPLGetConfigOption("ES_WRITEMAP", nullptr);
     if (pszWriteMapIn != nullptr) {
@@ -547,6 +551,21 @@ json_object* OGRElasticDataSource::RunRequest(const char* pszURL,
     CPLPopErrorHandler();
     CSLDestroy(papszOptions);
 
+    return ParseRequestResult(psResult, anSilentedHTTPErrors);
+}
+
+/************************************************************************/
+/*                          ParseRequestResult()                        */
+/************************************************************************/
+
+/* Takes ownership of psResult */
+json_object* OGRElasticDataSource::ParseRequestResult(
+                        CPLHTTPResult* psResult,
+                        const std::vector<int>& anSilentedHTTPErrors)
+{
+    if( psResult == nullptr )
+        return nullptr;
+
     if( psResult->pszErrBuf != nullptr )
     {
         CPLString osErrorMsg(
@@ -671,6 +690,10 @@ int OGRElasticDataSource::Open(GDALOpenInfo* poOpenInfo)
     m_bFlattenNestedAttributes = CPLFetchBool(
             poOpenInfo->papszOpenOptions, "FLATTEN_NESTED_ATTRIBUTES", true);
     m_osFID = CSLFetchNameValueDef(poOpenInfo->papszOpenOptions, "FID", "ogc_fid");
+    m_nScrollSlices = std::max(1, atoi(CSLFetchNameValueDef(
+        poOpenInfo->papszOpenOptions, "SCROLL_SLICES", "1")));
+    m_nBulkRequestsInFlight = std::max(1, atoi(CSLFetchNameValueDef(
+        poOpenInfo->papszOpenOptions, "BULK_REQUESTS_IN_FLIGHT", "1")));
 
     if( !CheckVersion() )
         return FALSE;
@@ -709,7 +732,6 @@ bool OGRElasticDataSource::UploadFile( const CPLString &url,
                                        const CPLString &data,
                                        const CPLString &osVerb )
 {
-    bool bRet = true;
     char** papszOptions = nullptr;
     if( !osVerb.empty() )
     {
@@ -732,6 +754,17 @@ bool OGRElasticDataSource::UploadFile( const CPLString &url,
 
     CPLHTTPResult* psResult = HTTPFetch(url, papszOptions);
     CSLDestroy(papszOptions);
+    return CheckUploadResult(psResult);
+}
+
+/************************************************************************/
+/*                          CheckUploadResult()                         */
+/************************************************************************/
+
+/* Takes ownership of psResult */
+bool OGRElasticDataSource::CheckUploadResult( CPLHTTPResult* psResult )
+{
+    bool bRet = true;
     if( psResult )
     {
         if( psResult->pszErrBuf != nullptr ||
@@ -124,6 +124,7 @@ void RegisterOGRElastic() {
     "  <Option name='FIELDS_WITH_RAW_VALUE' type='string' description='List of comma separated field names (of type string) that should have an additional raw/not_analyzed field, or {ALL}'/>"
     "  <Option name='BULK_INSERT' type='boolean' description='Whether to use bulk insert for feature creation' default='YES'/>"
     "  <Option name='BULK_SIZE' type='integer' description='Size in bytes of the buffer for bulk upload' default='1000000'/>"
+    "  <Option name='BULK_REQUESTS_IN_FLIGHT' type='integer' description='Maximum number of bulk upload requests in progress at the same time' default='1'/>"
     "  <Option name='DOT_AS_NESTED_FIELD' type='boolean' description='Whether to consider dot character in field name as sub-document' default='YES'/>"
     "  <Option name='IGNORE_SOURCE_ID' type='boolean' description='Whether to ignore _id field in features passed to CreateFeature()' default='NO'/>"
     "  <Option name='FID' type='string' description='Field name, with integer values, to use as FID' default='ogc_fid'/>"
@@ -143,6 +144,8 @@ void RegisterOGRElastic() {
 "  <Option name='BULK_INSERT' type='boolean' description='Whether to use bulk insert for feature creation' default='YES'/>"
 "  <Option name='BULK_SIZE' type='integer' description='Size in bytes of the buffer for bulk upload' default='1000000'/>"
 "  <Option name='FID' type='string' description='Field name, with integer values, to use as FID' default='ogc_fid'/>"
+"  <Option name='SCROLL_SLICES' type='integer' description='Number of slices of the sliced scroll used to read layers, fetched in parallel' default='1'/>"
+"  <Option name='BULK_REQUESTS_IN_FLIGHT' type='integer' description='Maximum number of bulk upload requests in progress at the same time' default='1'/>"
 "</OpenOptionList>");
 
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATATYPES,
@@ -39,6 +39,7 @@
 #include "../geojson/ogrgeojsonutils.h"
 #include "ogr_geo_utils.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <set>
 
@@ -72,6 +73,7 @@ OGRElasticLayer::OGRElasticLayer( const char* pszLayerName,
     m_papszFieldsWithRawValue(nullptr),
     m_osESSearch(pszESSearch ? pszESSearch : ""),
     m_nBulkUpload(poDS->m_nBulkUpload),
+    m_nBulkRequestsInFlight(poDS->m_nBulkRequestsInFlight),
     m_eGeomTypeMapping(ES_GEOMTYPE_AUTO),
     m_osPrecision(CSLFetchNameValueDef(papszOptions, "GEOM_PRECISION", "")),
     m_iCurID(0),
@@ -98,6 +100,10 @@ OGRElasticLayer::OGRElasticLayer( const char* pszLayerName,
     {
         m_nBulkUpload = atoi(CSLFetchNameValueDef(papszOptions, "BULK_SIZE", "1000000"));
     }
+    const char* pszBulkRequestsInFlight =
+        CSLFetchNameValue(papszOptions, "BULK_REQUESTS_IN_FLIGHT");
+    if( pszBulkRequestsInFlight )
+        m_nBulkRequestsInFlight = std::max(1, atoi(pszBulkRequestsInFlight));
 
     const char* pszStoredFields = CSLFetchNameValue(papszOptions, "STORED_FIELDS");
     if( pszStoredFields )
@@ -150,6 +156,7 @@ OGRElasticLayer* OGRElasticLayer::Clone() const
     poNew->m_bFeatureDefnFinalized = true;
     poNew->m_osBulkContent = m_osBulkContent;
     poNew->m_nBulkUpload = m_nBulkUpload;
+    poNew->m_nBulkRequestsInFlight = m_nBulkRequestsInFlight;
     poNew->m_osFID = m_osFID;
     poNew->m_aaosFieldPaths = m_aaosFieldPaths;
     poNew->m_aosMapToFieldIndex = m_aosMapToFieldIndex;
@@ -878,6 +885,8 @@ const char* OGRElasticLayer::GetFIDColumn()
 
 void OGRElasticLayer::ResetReading()
 {
+    StopSlicedScroll();
+    m_bSlicedScrollRefused = false;
     if( !m_osScrollID.empty() )
     {
         char** papszOptions = CSLAddNameValue(nullptr, "CUSTOMREQUEST", "DELETE");
@@ -985,6 +994,303 @@ CPLString OGRElasticLayer::BuildQuery(bool bCountOnly)
     return osRet;
 }
 
+/************************************************************************/
+/*                      BuildFirstScrollRequest()                       */
+/************************************************************************/
+
+void OGRElasticLayer::BuildFirstScrollRequest(CPLString& osRequest,
+                                              CPLString& osPostData)
+{
+    if( !m_osESSearch.empty() )
+    {
+        osRequest = CPLSPrintf("%s/_search?scroll=1m&size=%d",
+                       m_poDS->GetURL(), m_poDS->m_nBatchSize);
+        osPostData = m_osESSearch;
+    }
+    else if( (m_poSpatialFilter && m_osJSONFilter.empty()) || m_poJSONFilter )
+    {
+        osPostData = BuildQuery(false);
+        osRequest = CPLSPrintf("%s/%s/%s/_search?scroll=1m&size=%d",
+                    m_poDS->GetURL(), m_osIndexName.c_str(),
+                    m_osMappingName.c_str(), m_poDS->m_nBatchSize);
+    }
+    else if( !m_aoSortColumns.empty() && m_osJSONFilter.empty() )
+    {
+        osRequest = CPLSPrintf("%s/%s/%s/_search?scroll=1m&size=%d",
+                    m_poDS->GetURL(), m_osIndexName.c_str(),
+                    m_osMappingName.c_str(), m_poDS->m_nBatchSize);
+        json_object* poSort = BuildSort();
+        osPostData = CPLSPrintf(
+            "{ \"sort\": %s }",
+            json_object_to_json_string(poSort));
+        json_object_put(poSort);
+    }
+    else
+    {
+        osRequest =
+            CPLSPrintf("%s/%s/%s/_search?scroll=1m&size=%d",
+                       m_poDS->GetURL(), m_osIndexName.c_str(),
+                       m_osMappingName.c_str(), m_poDS->m_nBatchSize);
+        osPostData = m_osJSONFilter;
+    }
+}
+
+/************************************************************************/
+/*                         ~OGRElasticRequest()                         */
+/************************************************************************/
+
+OGRElasticRequest::~OGRElasticRequest()
+{
+    CSLDestroy(papszOptions);
+    if( psResult )
+        CPLHTTPDestroyResult(psResult);
+    if( poResponse )
+        json_object_put(poResponse);
+}
+
+/************************************************************************/
+/*                            RequestFunc()                             */
+/************************************************************************/
+
+void OGRElasticLayer::RequestFunc(void* pData)
+{
+    OGRElasticRequest* poRequest = static_cast<OGRElasticRequest*>(pData);
+
+    // Errors are reported by the main thread when it collects the result
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    CPLHTTPResult* psResult =
+        poRequest->poDS->HTTPFetch(poRequest->osURL, poRequest->papszOptions);
+    CPLPopErrorHandler();
+    poRequest->psResult = psResult;
+
+    // Parse the response in the worker too. In case of error, the result
+    // is kept, so that OGRElasticDataSource::ParseRequestResult() can
+    // report it.
+    if( poRequest->bParseJSon && psResult != nullptr &&
+        psResult->pszErrBuf == nullptr && psResult->pabyData != nullptr &&
+        !STARTS_WITH(reinterpret_cast<const char*>(psResult->pabyData),
+                     "{\"error\":") )
+    {
+        json_object* poObj = nullptr;
+        if( OGRJSonParse(reinterpret_cast<const char*>(psResult->pabyData),
+                         &poObj, false) &&
+            json_object_get_type(poObj) == json_type_object )
+        {
+            poRequest->poResponse = poObj;
+            CPLHTTPDestroyResult(psResult);
+            poRequest->psResult = nullptr;
+        }
+        else
+        {
+            json_object_put(poObj);
+        }
+    }
+    poRequest->bDone = true;
+}
+
+/************************************************************************/
+/*                           SubmitRequest()                            */
+/************************************************************************/
+
+// Run the request in a worker thread, or synchronously if no thread
+// pool can be set up.
+void OGRElasticLayer::SubmitRequest(OGRElasticRequest* poRequest)
+{
+    poRequest->poDS = m_poDS;
+    if( m_poWorkerPool == nullptr )
+    {
+        std::unique_ptr<CPLWorkerThreadPool> poPool(new CPLWorkerThreadPool());
+        if( poPool->Setup(std::max(m_poDS->m_nScrollSlices,
+                                   m_nBulkRequestsInFlight),
+                          nullptr, nullptr) )
+        {
+            m_poWorkerPool = std::move(poPool);
+        }
+    }
+    if( m_poWorkerPool == nullptr ||
+        !m_poWorkerPool->SubmitJob(RequestFunc, poRequest) )
+    {
+        RequestFunc(poRequest);
+    }
+}
+
+/************************************************************************/
+/*                            WaitRequest()                             */
+/************************************************************************/
+
+void OGRElasticLayer::WaitRequest(OGRElasticRequest* poRequest)
+{
+    while( !poRequest->bDone )
+        m_poWorkerPool->WaitEvent();
+}
+
+/************************************************************************/
+/*                         StartSlicedScroll()                          */
+/************************************************************************/
+
+// Open m_nScrollSlices scroll cursors, each one on a slice of the result
+// set, and request their first page.
+bool OGRElasticLayer::StartSlicedScroll()
+{
+    // Sliced scroll is available since Elasticsearch 5.0
+    if( m_poDS->m_nMajorVersion < 5 )
+        return false;
+
+    CPLString osRequest, osPostData;
+    BuildFirstScrollRequest(osRequest, osPostData);
+    json_object* poQuery = nullptr;
+    if( osPostData.empty() )
+        poQuery = json_object_new_object();
+    else if( !OGRJSonParse(osPostData, &poQuery, false) )
+        return false;
+    // Slices are read in turn, which would not respect the requested sort
+    if( poQuery == nullptr ||
+        json_object_get_type(poQuery) != json_type_object ||
+        CPL_json_object_object_get(poQuery, "sort") != nullptr ||
+        CPL_json_object_object_get(poQuery, "slice") != nullptr )
+    {
+        json_object_put(poQuery);
+        return false;
+    }
+    if( m_bAddPretty )
+        osRequest += "&pretty";
+
+    CPLDebug("ES", "Using a sliced scroll with %d slices",
+             m_poDS->m_nScrollSlices);
+    for( int i = 0; i < m_poDS->m_nScrollSlices; i++ )
+    {
+        json_object* poSlice = json_object_new_object();
+        json_object_object_add(poSlice, "id", json_object_new_int(i));
+        json_object_object_add(poSlice, "max",
+                               json_object_new_int(m_poDS->m_nScrollSlices));
+        // Replaces the slice of the previous iteration
+        json_object_object_add(poQuery, "slice", poSlice);
+
+        std::unique_ptr<OGRElasticScrollSlice> poScrollSlice(
+                                                new OGRElasticScrollSlice());
+        poScrollSlice->poRequest.reset(new OGRElasticRequest());
+        OGRElasticRequest* poRequest = poScrollSlice->poRequest.get();
+        poRequest->osURL = osRequest;
+        poRequest->bParseJSon = true;
+        poRequest->papszOptions = CSLSetNameValue(nullptr, "POSTFIELDS",
+                                        json_object_to_json_string(poQuery));
+        poRequest->papszOptions = CSLAddNameValue(poRequest->papszOptions,
+                "HEADERS", "Content-Type: application/json; charset=UTF-8");
+        SubmitRequest(poRequest);
+        m_apoScrollSlices.push_back(std::move(poScrollSlice));
+    }
+    json_object_put(poQuery);
+    m_iCurScrollSlice = 0;
+    return true;
+}
+
+/************************************************************************/
+/*                       GetNextSlicedScrollPage()                      */
+/************************************************************************/
+
+// Return the next non-empty page of the slices, taken in turn, after
+// having requested the following page of its slice.
+json_object* OGRElasticLayer::GetNextSlicedScrollPage()
+{
+    while( true )
+    {
+        OGRElasticScrollSlice* poSlice = nullptr;
+        const size_t nSlices = m_apoScrollSlices.size();
+        for( size_t i = 0; i < nSlices; i++ )
+        {
+            const size_t iSlice = (m_iCurScrollSlice + i) % nSlices;
+            if( !m_apoScrollSlices[iSlice]->bEOF )
+            {
+                poSlice = m_apoScrollSlices[iSlice].get();
+                m_iCurScrollSlice = (iSlice + 1) % nSlices;
+                break;
+            }
+        }
+        if( poSlice == nullptr )
+            return nullptr;
+
+        OGRElasticRequest* poRequest = poSlice->poRequest.get();
+        WaitRequest(poRequest);
+        json_object* poResponse = poRequest->poResponse;
+        poRequest->poResponse = nullptr;
+        if( poResponse == nullptr )
+        {
+            poResponse = m_poDS->ParseRequestResult(poRequest->psResult);
+            poRequest->psResult = nullptr;
+        }
+        poSlice->poRequest.reset();
+        if( poResponse == nullptr )
+        {
+            poSlice->bEOF = true;
+            return nullptr;
+        }
+
+        json_object* poScrollID =
+            CPL_json_object_object_get(poResponse, "_scroll_id");
+        if( poScrollID )
+        {
+            const char* pszScrollID = json_object_get_string(poScrollID);
+            if( pszScrollID )
+                poSlice->osScrollID = pszScrollID;
+        }
+
+        json_object* poHits = CPL_json_object_object_get(poResponse, "hits");
+        if( poHits != nullptr &&
+            json_object_get_type(poHits) == json_type_object )
+        {
+            poHits = CPL_json_object_object_get(poHits, "hits");
+        }
+        else
+        {
+            poHits = nullptr;
+        }
+        if( poHits == nullptr ||
+            json_object_get_type(poHits) != json_type_array ||
+            json_object_array_length(poHits) == 0 )
+        {
+            poSlice->osScrollID.clear();
+            poSlice->bEOF = true;
+            json_object_put(poResponse);
+            continue;
+        }
+
+        // Request the next page of the slice while this one is processed
+        poSlice->poRequest.reset(new OGRElasticRequest());
+        poRequest = poSlice->poRequest.get();
+        poRequest->osURL =
+            CPLSPrintf("%s/_search/scroll?scroll=1m&scroll_id=%s",
+                       m_poDS->GetURL(), poSlice->osScrollID.c_str());
+        if( m_bAddPretty )
+            poRequest->osURL += "&pretty";
+        poRequest->bParseJSon = true;
+        SubmitRequest(poRequest);
+
+        return poResponse;
+    }
+}
+
+/************************************************************************/
+/*                          StopSlicedScroll()                          */
+/************************************************************************/
+
+void OGRElasticLayer::StopSlicedScroll()
+{
+    for( auto& poSlice: m_apoScrollSlices )
+    {
+        if( poSlice->poRequest )
+            WaitRequest(poSlice->poRequest.get());
+        if( !poSlice->osScrollID.empty() )
+        {
+            char** papszOptions = CSLAddNameValue(nullptr, "CUSTOMREQUEST", "DELETE");
+            CPLHTTPResult* psResult = m_poDS->HTTPFetch((m_poDS->GetURL() + CPLString("/_search/scroll?scroll_id=") + poSlice->osScrollID).c_str(), papszOptions);
+            CSLDestroy(papszOptions);
+            CPLHTTPDestroyResult(psResult);
+        }
+    }
+    m_apoScrollSlices.clear();
+    m_iCurScrollSlice = 0;
+}
+
 /************************************************************************/
 /*                         GetNextRawFeature()                          */
 /************************************************************************/
@@ -1009,63 +1315,50 @@ OGRFeature *OGRElasticLayer::GetNextRawFeature()
     m_apoCachedFeatures.resize(0);
     m_iCurFeatureInPage = 0;
 
-    CPLString osRequest, osPostData;
-    if( m_osScrollID.empty() )
+    if( m_poDS->m_nScrollSlices > 1 && m_osScrollID.empty() &&
+        m_apoScrollSlices.empty() && !m_bSlicedScrollRefused )
     {
-        if( !m_osESSearch.empty() )
-        {
-            osRequest = CPLSPrintf("%s/_search?scroll=1m&size=%d",
-                           m_poDS->GetURL(), m_poDS->m_nBatchSize);
-            osPostData = m_osESSearch;
-        }
-        else if( (m_poSpatialFilter && m_osJSONFilter.empty()) || m_poJSONFilter )
+        m_bSlicedScrollRefused = !StartSlicedScroll();
+    }
+
+    if( !m_apoScrollSlices.empty() )
+    {
+        poResponse = GetNextSlicedScrollPage();
+        if( poResponse == nullptr )
         {
-            osPostData = BuildQuery(false);
-            osRequest = CPLSPrintf("%s/%s/%s/_search?scroll=1m&size=%d",
-                        m_poDS->GetURL(), m_osIndexName.c_str(),
-                        m_osMappingName.c_str(), m_poDS->m_nBatchSize);
+            m_bEOF = true;
+            return nullptr;
         }
-        else if( !m_aoSortColumns.empty() && m_osJSONFilter.empty() )
+    }
+    else
+    {
+        CPLString osRequest, osPostData;
+        if( m_osScrollID.empty() )
         {
-            osRequest = CPLSPrintf("%s/%s/%s/_search?scroll=1m&size=%d",
-                        m_poDS->GetURL(), m_osIndexName.c_str(),
-                        m_osMappingName.c_str(), m_poDS->m_nBatchSize);
-            json_object* poSort = BuildSort();
-            osPostData = CPLSPrintf(
-                "{ \"sort\": %s }",
-                json_object_to_json_string(poSort));
-            json_object_put(poSort);
+            BuildFirstScrollRequest(osRequest, osPostData);
         }
         else
         {
             osRequest =
-                CPLSPrintf("%s/%s/%s/_search?scroll=1m&size=%d",
-                           m_poDS->GetURL(), m_osIndexName.c_str(),
-                           m_osMappingName.c_str(), m_poDS->m_nBatchSize);
-            osPostData = m_osJSONFilter;
+                CPLSPrintf("%s/_search/scroll?scroll=1m&scroll_id=%s",
+                           m_poDS->GetURL(), m_osScrollID.c_str());
         }
-    }
-    else
-    {
-        osRequest =
-            CPLSPrintf("%s/_search/scroll?scroll=1m&scroll_id=%s",
-                       m_poDS->GetURL(), m_osScrollID.c_str());
-    }
 
-    if( m_bAddPretty )
-        osRequest += "&pretty";
-    poResponse = m_poDS->RunRequest(osRequest, osPostData);
-    if( poResponse == nullptr )
-    {
-        m_bEOF = true;
-        return nullptr;
-    }
-    json_object* poScrollID = CPL_json_object_object_get(poResponse, "_scroll_id");
-    if( poScrollID )
-    {
-        const char* pszScrollID = json_object_get_string(poScrollID);
-        if( pszScrollID )
-            m_osScrollID = pszScrollID;
+        if( m_bAddPretty )
+            osRequest += "&pretty";
+        poResponse = m_poDS->RunRequest(osRequest, osPostData);
+        if( poResponse == nullptr )
+        {
+            m_bEOF = true;
+            return nullptr;
+        }
+        json_object* poScrollID = CPL_json_object_object_get(poResponse, "_scroll_id");
+        if( poScrollID )
+        {
+            const char* pszScrollID = json_object_get_string(poScrollID);
+            if( pszScrollID )
+                m_osScrollID = pszScrollID;
+        }
     }
 
     json_object* poHits = CPL_json_object_object_get(poResponse, "hits");
@@ -2279,7 +2572,7 @@ OGRErr OGRElasticLayer::ICreateFeature(OGRFeature *poFeature)
 
         // Only push the data if we are over our bulk upload limit
         if ((int) m_osBulkContent.length() > m_nBulkUpload) {
-            if( !PushIndex() )
+            if( !PushIndex(false) )
             {
                 return OGRERR_FAILURE;
             }
@@ -2361,18 +2654,60 @@ OGRErr OGRElasticLayer::ISetFeature(OGRFeature *poFeature)
 /*                             PushIndex()                              */
 /************************************************************************/
 
-bool OGRElasticLayer::PushIndex()
+// Upload the pending bulk content. When several bulk requests may be in
+// flight, the upload is done by a worker thread, and, unless
+// bWaitCompletion is set, we only wait for enough of the previous ones to
+// complete to stay within the limit.
+bool OGRElasticLayer::PushIndex(bool bWaitCompletion)
 {
-    if( m_osBulkContent.empty() )
+    bool bRet = true;
+    if( !m_osBulkContent.empty() )
+    {
+        const CPLString osURL(CPLSPrintf("%s/_bulk", m_poDS->GetURL()));
+        if( m_nBulkRequestsInFlight <= 1 )
+        {
+            bRet = m_poDS->UploadFile(osURL, m_osBulkContent);
+        }
+        else
+        {
+            std::unique_ptr<OGRElasticRequest> poRequest(
+                                                    new OGRElasticRequest());
+            poRequest->osURL = osURL;
+            poRequest->papszOptions = CSLSetNameValue(nullptr, "POSTFIELDS",
+                                                      m_osBulkContent.c_str());
+            poRequest->papszOptions = CSLAddNameValue(poRequest->papszOptions,
+                "HEADERS", "Content-Type: application/json; charset=UTF-8");
+            SubmitRequest(poRequest.get());
+            m_apoBulkRequests.push_back(std::move(poRequest));
+        }
+        m_osBulkContent.clear();
+    }
+
+    if( !WaitBulkRequests(bWaitCompletion ? 0 :
+                            static_cast<size_t>(m_nBulkRequestsInFlight)) )
     {
-        return true;
+        bRet = false;
     }
+    return bRet;
+}
 
-    const bool bRet =
-      m_poDS->UploadFile(CPLSPrintf("%s/_bulk", m_poDS->GetURL()),
-                         m_osBulkContent);
-    m_osBulkContent.clear();
+/************************************************************************/
+/*                          WaitBulkRequests()                          */
+/************************************************************************/
 
+bool OGRElasticLayer::WaitBulkRequests(size_t nMaxRemaining)
+{
+    bool bRet = true;
+    while( m_apoBulkRequests.size() > nMaxRemaining )
+    {
+        std::unique_ptr<OGRElasticRequest> poRequest(
+                                    std::move(m_apoBulkRequests.front()));
+        m_apoBulkRequests.pop_front();
+        WaitRequest(poRequest.get());
+        if( !m_poDS->CheckUploadResult(poRequest->psResult) )
+            bRet = false;
+        poRequest->psResult = nullptr;
+    }
     return bRet;
 }
 
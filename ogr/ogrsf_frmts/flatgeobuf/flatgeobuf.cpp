@@ -0,0 +1,429 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Minimal reader and builder of the flatbuffers binary encoding.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "flatgeobuf.h"
+
+#include <algorithm>
+
+CPL_CVSID("$Id$")
+
+namespace FlatGeobuf
+{
+
+/************************************************************************/
+/*                               Table()                                */
+/************************************************************************/
+
+Table::Table( const GByte* pabyBuf, size_t nBufSize, size_t nTablePos )
+{
+    if( pabyBuf == nullptr || nTablePos > nBufSize ||
+        nBufSize - nTablePos < sizeof(int32_t) )
+        return;
+
+    const int32_t nSOffset = ReadLE<int32_t>(pabyBuf + nTablePos);
+    const GIntBig nVTablePos = static_cast<GIntBig>(nTablePos) - nSOffset;
+    if( nVTablePos < 0 ||
+        static_cast<GUIntBig>(nVTablePos) + 2 * sizeof(uint16_t) > nBufSize )
+        return;
+
+    const uint16_t nVTableSize =
+        ReadLE<uint16_t>(pabyBuf + static_cast<size_t>(nVTablePos));
+    const uint16_t nTableSize =
+        ReadLE<uint16_t>(pabyBuf + static_cast<size_t>(nVTablePos) + 2);
+    if( nVTableSize < 4 || (nVTableSize % 2) != 0 ||
+        static_cast<GUIntBig>(nVTablePos) + nVTableSize > nBufSize ||
+        nTableSize < sizeof(int32_t) ||
+        static_cast<GUIntBig>(nTablePos) + nTableSize > nBufSize )
+        return;
+
+    m_pabyBuf = pabyBuf;
+    m_nBufSize = nBufSize;
+    m_nTablePos = nTablePos;
+    m_nVTablePos = static_cast<size_t>(nVTablePos);
+    m_nVTableSize = nVTableSize;
+    m_nTableSize = nTableSize;
+}
+
+/************************************************************************/
+/*                              GetRoot()                               */
+/************************************************************************/
+
+Table Table::GetRoot( const GByte* pabyBuf, size_t nBufSize )
+{
+    if( pabyBuf == nullptr || nBufSize < sizeof(uint32_t) )
+        return Table();
+    return Table(pabyBuf, nBufSize, ReadLE<uint32_t>(pabyBuf));
+}
+
+/************************************************************************/
+/*                            GetFieldPos()                             */
+/*                                                                      */
+/*      Position in the buffer of the inline value of a field of nSize  */
+/*      bytes, or 0 if the field is absent or invalid.                  */
+/************************************************************************/
+
+size_t Table::GetFieldPos( int iField, size_t nSize ) const
+{
+    if( m_pabyBuf == nullptr || iField < 0 )
+        return 0;
+
+    const size_t nVTableIdx = 4 + 2 * static_cast<size_t>(iField);
+    if( nVTableIdx + 2 > m_nVTableSize )
+        return 0;
+
+    const uint16_t nFieldOffset =
+        ReadLE<uint16_t>(m_pabyBuf + m_nVTablePos + nVTableIdx);
+    if( nFieldOffset < sizeof(int32_t) ||
+        nFieldOffset + nSize > m_nTableSize )
+        return 0;
+
+    return m_nTablePos + nFieldOffset;
+}
+
+/************************************************************************/
+/*                          GetOffsetTarget()                           */
+/************************************************************************/
+
+bool Table::GetOffsetTarget( int iField, size_t& nPos ) const
+{
+    const size_t nFieldPos = GetFieldPos(iField, sizeof(uint32_t));
+    if( nFieldPos == 0 )
+        return false;
+
+    const uint32_t nOffset = ReadLE<uint32_t>(m_pabyBuf + nFieldPos);
+    if( nOffset == 0 || nOffset >= m_nBufSize - nFieldPos )
+        return false;
+
+    nPos = nFieldPos + nOffset;
+    return true;
+}
+
+/************************************************************************/
+/*                             GetString()                              */
+/************************************************************************/
+
+std::string Table::GetString( int iField ) const
+{
+    uint32_t nLen = 0;
+    const GByte* pabyStr = GetVector(iField, 1, nLen);
+    if( pabyStr == nullptr )
+        return std::string();
+    return std::string(reinterpret_cast<const char*>(pabyStr), nLen);
+}
+
+/************************************************************************/
+/*                              GetTable()                              */
+/************************************************************************/
+
+Table Table::GetTable( int iField ) const
+{
+    size_t nPos = 0;
+    if( !GetOffsetTarget(iField, nPos) )
+        return Table();
+    return Table(m_pabyBuf, m_nBufSize, nPos);
+}
+
+/************************************************************************/
+/*                             GetVector()                              */
+/************************************************************************/
+
+const GByte *Table::GetVector( int iField, size_t nElemSize,
+                               uint32_t& nCount ) const
+{
+    nCount = 0;
+
+    size_t nPos = 0;
+    if( !GetOffsetTarget(iField, nPos) ||
+        m_nBufSize - nPos < sizeof(uint32_t) )
+        return nullptr;
+
+    const uint32_t nLen = ReadLE<uint32_t>(m_pabyBuf + nPos);
+    nPos += sizeof(uint32_t);
+    if( static_cast<GUIntBig>(nLen) * nElemSize > m_nBufSize - nPos )
+        return nullptr;
+
+    nCount = nLen;
+    return m_pabyBuf + nPos;
+}
+
+/************************************************************************/
+/*                         GetTableVectorSize()                         */
+/************************************************************************/
+
+uint32_t Table::GetTableVectorSize( int iField ) const
+{
+    uint32_t nCount = 0;
+    GetVector(iField, sizeof(uint32_t), nCount);
+    return nCount;
+}
+
+/************************************************************************/
+/*                         GetTableVectorItem()                         */
+/************************************************************************/
+
+Table Table::GetTableVectorItem( int iField, uint32_t i ) const
+{
+    uint32_t nCount = 0;
+    const GByte* pabyOffsets = GetVector(iField, sizeof(uint32_t), nCount);
+    if( pabyOffsets == nullptr || i >= nCount )
+        return Table();
+
+    const size_t nItemPos =
+        static_cast<size_t>(pabyOffsets - m_pabyBuf) + 4 * static_cast<size_t>(i);
+    const uint32_t nOffset = ReadLE<uint32_t>(m_pabyBuf + nItemPos);
+    if( nOffset == 0 || nOffset >= m_nBufSize - nItemPos )
+        return Table();
+
+    return Table(m_pabyBuf, m_nBufSize, nItemPos + nOffset);
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                               Builder                                */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                               Clear()                                */
+/************************************************************************/
+
+void Builder::Clear()
+{
+    m_nHead = m_abyBuf.size();
+    m_nMinAlign = 1;
+    m_bInTable = false;
+    m_nTableStart = 0;
+    m_aoFields.clear();
+}
+
+/************************************************************************/
+/*                              Reserve()                               */
+/*                                                                      */
+/*      Make sure nSize bytes can be prepended, keeping the data at     */
+/*      the end of the buffer.                                          */
+/************************************************************************/
+
+void Builder::Reserve( size_t nSize )
+{
+    if( m_nHead >= nSize )
+        return;
+
+    const size_t nDataSize = m_abyBuf.size() - m_nHead;
+    size_t nNewCapacity = std::max(m_abyBuf.size() * 2,
+                                   static_cast<size_t>(1024));
+    while( nNewCapacity - nDataSize < nSize )
+        nNewCapacity *= 2;
+
+    std::vector<GByte> abyNewBuf(nNewCapacity);
+    if( nDataSize )
+        memcpy(&abyNewBuf[nNewCapacity - nDataSize], &m_abyBuf[m_nHead],
+               nDataSize);
+    m_abyBuf.swap(abyNewBuf);
+    m_nHead = nNewCapacity - nDataSize;
+}
+
+/************************************************************************/
+/*                                Pad()                                 */
+/************************************************************************/
+
+void Builder::Pad( size_t nSize )
+{
+    if( nSize == 0 )
+        return;
+    Reserve(nSize);
+    m_nHead -= nSize;
+    memset(&m_abyBuf[m_nHead], 0, nSize);
+}
+
+/************************************************************************/
+/*                              PreAlign()                              */
+/*                                                                      */
+/*      Pad so that, once nLen bytes are pushed, the data is aligned    */
+/*      on nAlign bytes from the end of the buffer.                     */
+/************************************************************************/
+
+void Builder::PreAlign( size_t nLen, size_t nAlign )
+{
+    if( nAlign > m_nMinAlign )
+        m_nMinAlign = nAlign;
+    Pad((~(GetSize() + nLen) + 1) & (nAlign - 1));
+}
+
+/************************************************************************/
+/*                             PushBytes()                              */
+/************************************************************************/
+
+void Builder::PushBytes( const void* pData, size_t nSize )
+{
+    if( nSize == 0 )
+        return;
+    Reserve(nSize);
+    m_nHead -= nSize;
+    memcpy(&m_abyBuf[m_nHead], pData, nSize);
+}
+
+/************************************************************************/
+/*                              ReferTo()                               */
+/*                                                                      */
+/*      Value of a uoffset pushed next, that points to nOffset.         */
+/************************************************************************/
+
+uint32_t Builder::ReferTo( uint32_t nOffset )
+{
+    PreAlign(sizeof(uint32_t), sizeof(uint32_t));
+    return GetSize() - nOffset + static_cast<uint32_t>(sizeof(uint32_t));
+}
+
+/************************************************************************/
+/*                            CreateString()                            */
+/************************************************************************/
+
+uint32_t Builder::CreateString( const char* pszStr, size_t nLen )
+{
+    CPLAssert(!m_bInTable);
+    PreAlign(nLen + 1, sizeof(uint32_t));
+    Pad(1);
+    PushBytes(pszStr, nLen);
+    Push(static_cast<uint32_t>(nLen));
+    return GetSize();
+}
+
+/************************************************************************/
+/*                            CreateVector()                            */
+/************************************************************************/
+
+uint32_t Builder::CreateVector( const void* pData, size_t nCount,
+                                size_t nElemSize, size_t nAlign )
+{
+    CPLAssert(!m_bInTable);
+    CPLAssert((nAlign & (nAlign - 1)) == 0);
+    PreAlign(nCount * nElemSize, sizeof(uint32_t));
+    PreAlign(nCount * nElemSize, nAlign);
+    PushBytes(pData, nCount * nElemSize);
+    Push(static_cast<uint32_t>(nCount));
+    return GetSize();
+}
+
+/************************************************************************/
+/*                         CreateTableVector()                          */
+/************************************************************************/
+
+uint32_t Builder::CreateTableVector( const std::vector<uint32_t>& anTables )
+{
+    CPLAssert(!m_bInTable);
+    PreAlign(anTables.size() * sizeof(uint32_t), sizeof(uint32_t));
+    for( size_t i = anTables.size(); i > 0; )
+    {
+        --i;
+        Push(ReferTo(anTables[i]));
+    }
+    Push(static_cast<uint32_t>(anTables.size()));
+    return GetSize();
+}
+
+/************************************************************************/
+/*                             StartTable()                             */
+/************************************************************************/
+
+void Builder::StartTable()
+{
+    CPLAssert(!m_bInTable);
+    m_bInTable = true;
+    m_nTableStart = GetSize();
+    m_aoFields.clear();
+}
+
+/************************************************************************/
+/*                             AddOffset()                              */
+/************************************************************************/
+
+void Builder::AddOffset( int iField, uint32_t nOffset )
+{
+    CPLAssert(m_bInTable);
+    if( nOffset == 0 )
+        return;
+    Push(ReferTo(nOffset));
+    m_aoFields.emplace_back(static_cast<uint16_t>(iField), GetSize());
+}
+
+/************************************************************************/
+/*                              EndTable()                              */
+/*                                                                      */
+/*      Write the offset to the vtable, then the vtable itself before   */
+/*      the table.                                                      */
+/************************************************************************/
+
+uint32_t Builder::EndTable()
+{
+    CPLAssert(m_bInTable);
+
+    Push(static_cast<int32_t>(0));
+    const uint32_t nVTableOffsetLoc = GetSize();
+
+    int nFields = 0;
+    for( const auto& oField: m_aoFields )
+        nFields = std::max(nFields, oField.first + 1);
+
+    std::vector<uint16_t> anVTable(nFields);
+    for( const auto& oField: m_aoFields )
+        anVTable[oField.first] =
+            static_cast<uint16_t>(nVTableOffsetLoc - oField.second);
+
+    for( int i = nFields - 1; i >= 0; i-- )
+        Push(anVTable[i]);
+    Push(static_cast<uint16_t>(nVTableOffsetLoc - m_nTableStart));
+    Push(static_cast<uint16_t>(4 + 2 * nFields));
+    const uint32_t nVTableLoc = GetSize();
+
+    int32_t nSOffset = static_cast<int32_t>(nVTableLoc) -
+                       static_cast<int32_t>(nVTableOffsetLoc);
+    CPL_LSBPTR32(&nSOffset);
+    memcpy(&m_abyBuf[m_abyBuf.size() - nVTableOffsetLoc], &nSOffset,
+           sizeof(nSOffset));
+
+    m_bInTable = false;
+    m_aoFields.clear();
+    return nVTableOffsetLoc;
+}
+
+/************************************************************************/
+/*                               Finish()                               */
+/************************************************************************/
+
+const GByte *Builder::Finish( uint32_t nRoot, size_t& nSize,
+                              bool bSizePrefixed )
+{
+    CPLAssert(!m_bInTable);
+    PreAlign((bSizePrefixed ? 2 : 1) * sizeof(uint32_t), m_nMinAlign);
+    Push(ReferTo(nRoot));
+    if( bSizePrefixed )
+        Push(GetSize());
+    nSize = GetSize();
+    return &m_abyBuf[m_nHead];
+}
+
+} // namespace FlatGeobuf
@@ -0,0 +1,290 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Low level declarations of the FlatGeobuf format: schema
+ *           constants, and minimal reader and builder of the flatbuffers
+ *           binary encoding used by the header and the features.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef FLATGEOBUF_H_INCLUDED
+#define FLATGEOBUF_H_INCLUDED
+
+#include "cpl_port.h"
+#include "cpl_error.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace FlatGeobuf
+{
+
+// flatbuffers scalars are little endian.
+template<class T> inline void SwapToLSB(T* pVal)
+{
+#ifdef CPL_MSB
+    GByte* pabyVal = reinterpret_cast<GByte*>(pVal);
+    for( size_t i = 0; i < sizeof(T) / 2; i++ )
+        std::swap(pabyVal[i], pabyVal[sizeof(T) - 1 - i]);
+#else
+    (void)pVal;
+#endif
+}
+
+/* -------------------------------------------------------------------- */
+/*      File layout: magic bytes, size prefixed Header table, optional  */
+/*      packed Hilbert R-tree, then size prefixed Feature tables.       */
+/* -------------------------------------------------------------------- */
+constexpr GByte abyMagicBytes[8] = { 0x66, 0x67, 0x62, 0x03,
+                                     0x66, 0x67, 0x62, 0x00 };
+constexpr size_t nMagicBytesSize = sizeof(abyMagicBytes);
+
+// Sanity limits on the size of the size prefixed tables.
+constexpr uint32_t nMaxHeaderSize = 10 * 1024 * 1024;
+constexpr uint32_t nMaxFeatureSize = 1024 * 1024 * 1024;
+
+/* -------------------------------------------------------------------- */
+/*      Enumerations. GeometryType values match OGRwkbGeometryType of   */
+/*      2D geometries.                                                  */
+/* -------------------------------------------------------------------- */
+enum class GeometryType : GByte
+{
+    Unknown = 0,
+    Point = 1,
+    LineString = 2,
+    Polygon = 3,
+    MultiPoint = 4,
+    MultiLineString = 5,
+    MultiPolygon = 6,
+    GeometryCollection = 7,
+    CircularString = 8,
+    CompoundCurve = 9,
+    CurvePolygon = 10,
+    MultiCurve = 11,
+    MultiSurface = 12,
+    Curve = 13,
+    Surface = 14,
+    PolyhedralSurface = 15,
+    TIN = 16,
+    Triangle = 17
+};
+
+enum class ColumnType : GByte
+{
+    Byte = 0,
+    UByte,
+    Bool,
+    Short,
+    UShort,
+    Int,
+    UInt,
+    Long,
+    ULong,
+    Float,
+    Double,
+    String,
+    Json,
+    DateTime,
+    Binary
+};
+
+/* -------------------------------------------------------------------- */
+/*      Field ids of the tables, in schema order.                       */
+/* -------------------------------------------------------------------- */
+namespace Column
+{
+    enum { name = 0, type, title, description, width, precision, scale,
+           nullable, unique, primary_key, metadata };
+}
+
+namespace Crs
+{
+    enum { org = 0, code, name, description, wkt, code_string };
+}
+
+namespace Header
+{
+    enum { name = 0, envelope, geometry_type, has_z, has_m, has_t, has_tm,
+           columns, features_count, index_node_size, crs, title,
+           description, metadata };
+}
+
+namespace Geometry
+{
+    enum { ends = 0, xy, z, m, t, tm, type, parts };
+}
+
+namespace Feature
+{
+    enum { geometry = 0, properties, columns };
+}
+
+/************************************************************************/
+/*                               Table                                  */
+/*                                                                      */
+/*      Read access to a table of a flatbuffers buffer. All accesses    */
+/*      are bounds checked. An invalid table behaves as a table with    */
+/*      all fields absent.                                              */
+/************************************************************************/
+
+class Table
+{
+    const GByte *m_pabyBuf = nullptr;
+    size_t       m_nBufSize = 0;
+    size_t       m_nTablePos = 0;
+    size_t       m_nVTablePos = 0;
+    uint16_t     m_nVTableSize = 0;
+    uint16_t     m_nTableSize = 0;
+
+    template<class T> static T ReadLE(const GByte* pabyData)
+    {
+        T nVal;
+        memcpy(&nVal, pabyData, sizeof(T));
+        SwapToLSB(&nVal);
+        return nVal;
+    }
+
+    size_t       GetFieldPos(int iField, size_t nSize) const;
+    bool         GetOffsetTarget(int iField, size_t& nPos) const;
+
+  public:
+    Table() = default;
+    Table(const GByte* pabyBuf, size_t nBufSize, size_t nTablePos);
+
+    // Root table of a buffer, not including the size prefix.
+    static Table GetRoot(const GByte* pabyBuf, size_t nBufSize);
+
+    bool         IsValid() const { return m_pabyBuf != nullptr; }
+    bool         HasField(int iField) const
+                    { return GetFieldPos(iField, 1) != 0; }
+
+    template<class T> T GetScalar(int iField, T nDefault) const
+    {
+        const size_t nPos = GetFieldPos(iField, sizeof(T));
+        return nPos ? ReadLE<T>(m_pabyBuf + nPos) : nDefault;
+    }
+
+    bool         GetBool(int iField, bool bDefault) const
+                    { return GetScalar<GByte>(iField, bDefault) != 0; }
+
+    // Returns an empty string if the field is absent.
+    std::string  GetString(int iField) const;
+
+    Table        GetTable(int iField) const;
+
+    // Pointer to the elements (not aligned, little endian) of a vector
+    // of scalars or structs of nElemSize bytes.
+    const GByte *GetVector(int iField, size_t nElemSize,
+                           uint32_t& nCount) const;
+
+    // Vector of tables.
+    uint32_t     GetTableVectorSize(int iField) const;
+    Table        GetTableVectorItem(int iField, uint32_t i) const;
+};
+
+/************************************************************************/
+/*                              Builder                                 */
+/*                                                                      */
+/*      Builds a flatbuffers buffer back to front, as the reference     */
+/*      implementation does: children (strings, vectors, tables) must   */
+/*      be created before the table that references them. Offsets are   */
+/*      counted from the end of the buffer.                             */
+/************************************************************************/
+
+class Builder
+{
+    std::vector<GByte> m_abyBuf{};
+    size_t       m_nHead = 0;
+    size_t       m_nMinAlign = 1;
+    bool         m_bInTable = false;
+    uint32_t     m_nTableStart = 0;
+    std::vector<std::pair<uint16_t, uint32_t>> m_aoFields{};
+
+    void         Reserve(size_t nSize);
+    void         Pad(size_t nSize);
+    void         PreAlign(size_t nLen, size_t nAlign);
+    template<class T> void Push(T nVal)
+    {
+        PreAlign(sizeof(T), sizeof(T));
+        SwapToLSB(&nVal);
+        PushBytes(&nVal, sizeof(T));
+    }
+    void         PushBytes(const void* pData, size_t nSize);
+    uint32_t     ReferTo(uint32_t nOffset);
+
+    CPL_DISALLOW_COPY_ASSIGN(Builder)
+
+  public:
+    Builder() = default;
+
+    void         Clear();
+    uint32_t     GetSize() const
+                    { return static_cast<uint32_t>(m_abyBuf.size() - m_nHead); }
+
+    uint32_t     CreateString(const char* pszStr, size_t nLen);
+    uint32_t     CreateString(const std::string& osStr)
+                    { return CreateString(osStr.c_str(), osStr.size()); }
+    // Elements must already be in little endian order.
+    uint32_t     CreateVector(const void* pData, size_t nCount,
+                              size_t nElemSize)
+                    { return CreateVector(pData, nCount, nElemSize,
+                                          nElemSize); }
+    // Vector of structs, aligned on their largest member.
+    uint32_t     CreateVector(const void* pData, size_t nCount,
+                              size_t nElemSize, size_t nAlign);
+    uint32_t     CreateVector(const std::vector<double>& adfValues)
+                    { return CreateVector(adfValues.data(),
+                                          adfValues.size(), sizeof(double)); }
+    uint32_t     CreateVector(const std::vector<uint32_t>& anValues)
+                    { return CreateVector(anValues.data(),
+                                          anValues.size(),
+                                          sizeof(uint32_t)); }
+    uint32_t     CreateTableVector(const std::vector<uint32_t>& anTables);
+
+    void         StartTable();
+    // Scalars equal to their default value are omitted unless bForce.
+    template<class T> void AddScalar(int iField, T nVal, T nDefault,
+                                     bool bForce = false)
+    {
+        if( nVal == nDefault && !bForce )
+            return;
+        Push(nVal);
+        m_aoFields.emplace_back(static_cast<uint16_t>(iField), GetSize());
+    }
+    void         AddBool(int iField, bool bVal, bool bDefault)
+                    { AddScalar<GByte>(iField, bVal, bDefault); }
+    // nOffset == 0 means absent.
+    void         AddOffset(int iField, uint32_t nOffset);
+    uint32_t     EndTable();
+
+    // Finishes the buffer, with a uint32 size prefix unless bSizePrefixed
+    // is false, and returns it.
+    const GByte *Finish(uint32_t nRoot, size_t& nSize,
+                        bool bSizePrefixed = true);
+};
+
+} // namespace FlatGeobuf
+
+#endif /* ndef FLATGEOBUF_H_INCLUDED */
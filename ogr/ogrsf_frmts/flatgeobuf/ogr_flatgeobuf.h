@@ -0,0 +1,210 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Declarations of the FlatGeobuf driver classes.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "flatgeobuf.h"
+
+#ifndef OGR_FLATGEOBUF_H_INCLUDED
+#define OGR_FLATGEOBUF_H_INCLUDED
+
+#include "ogrsf_frmts.h"
+
+#include "flatgeobuf.h"
+#include "packedrtree.h"
+
+#include <memory>
+#include <vector>
+
+/************************************************************************/
+/*                     Geometry encoding (ogrflatgeobufgeometry.cpp)    */
+/************************************************************************/
+
+FlatGeobuf::GeometryType OGRFlatGeobufGetGeometryType( OGRwkbGeometryType eGType );
+OGRwkbGeometryType OGRFlatGeobufGetOGRGeometryType( FlatGeobuf::GeometryType eType,
+                                                    bool bHasZ, bool bHasM );
+
+// eType is the type of the layer, or Unknown if the geometry table holds it.
+OGRGeometry *OGRFlatGeobufReadGeometry( const FlatGeobuf::Table& oGeometry,
+                                        FlatGeobuf::GeometryType eType,
+                                        bool bHasZ, bool bHasM );
+
+// Returns the offset of the Geometry table, or 0 if poGeom cannot be
+// encoded.
+uint32_t OGRFlatGeobufWriteGeometry( FlatGeobuf::Builder& oBuilder,
+                                     const OGRGeometry* poGeom,
+                                     bool bWriteType,
+                                     bool bHasZ, bool bHasM );
+
+/************************************************************************/
+/*                          OGRFlatGeobufLayer                          */
+/************************************************************************/
+
+class OGRFlatGeobufLayer final: public OGRLayer
+{
+    std::string         m_osFilename{};
+    OGRFeatureDefn     *m_poFeatureDefn = nullptr;
+    OGRSpatialReference *m_poSRS = nullptr;
+    VSILFILE           *m_poFp = nullptr;
+
+    FlatGeobuf::GeometryType m_eGeomType = FlatGeobuf::GeometryType::Unknown;
+    bool                m_bHasZ = false;
+    bool                m_bHasM = false;
+    std::vector<FlatGeobuf::ColumnType> m_aeColumnTypes{};
+    uint64_t            m_nFeaturesCount = 0;
+    uint16_t            m_nIndexNodeSize = 0;
+    OGREnvelope         m_sExtent{};
+    bool                m_bHasExtent = false;
+
+    // Reading.
+    vsi_l_offset        m_nIndexOffset = 0;
+    vsi_l_offset        m_nFeaturesOffset = 0;
+    vsi_l_offset        m_nFileSize = 0;
+    uint64_t            m_nFeatureIdx = 0;
+    vsi_l_offset        m_nOffset = 0;
+    std::vector<GByte>  m_abyFeatureBuf{};
+
+    // Reading using the spatial index: matching features are fetched in
+    // batches, with one VSIFReadMultiRangeL() call per batch.
+    struct BatchItem
+    {
+        uint64_t        nIndex;
+        size_t          nBufOffset;
+        size_t          nSize;
+    };
+    bool                m_bIndexSearched = false;
+    std::vector<FlatGeobuf::PackedRTree::SearchResultItem> m_aoFoundItems{};
+    size_t              m_iFoundItem = 0;
+    std::vector<GByte>  m_abyBatchBuf{};
+    std::vector<BatchItem> m_aoBatch{};
+    size_t              m_iBatchItem = 0;
+
+    // Writing.
+    struct FeatureItem
+    {
+        FlatGeobuf::NodeItem oBounds;
+        vsi_l_offset    nOffset;
+        uint32_t        nSize;
+    };
+    bool                m_bCreate = false;
+    bool                m_bWriteIndex = false;
+    bool                m_bHeaderWritten = false;
+    uint32_t            m_nHeaderSize = 0;
+    std::string         m_osTempFilename{};
+    VSILFILE           *m_poFpWrite = nullptr;
+    vsi_l_offset        m_nWriteOffset = 0;
+    std::vector<FeatureItem> m_aoItems{};
+    FlatGeobuf::Builder m_oBuilder{};
+    std::vector<GByte>  m_abyProperties{};
+    bool                m_bWriteError = false;
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRFlatGeobufLayer)
+
+    OGRFlatGeobufLayer() = default;
+
+    bool                ReadHeader( const GByte* pabyHeader, uint32_t nSize );
+    vsi_l_offset        GetFileSize();
+    bool                ReadNextRecord( const GByte*& pabyRecord,
+                                        size_t& nRecordSize,
+                                        uint64_t& nIndex );
+    bool                ReadNextSequentialRecord();
+    bool                ReadNextBatch();
+    OGRFeature         *GetNextRawFeature();
+    OGRFeature         *ParseFeature( const GByte* pabyRecord,
+                                      size_t nRecordSize, uint64_t nIndex );
+    template<class Visitor> bool
+                        ParseProperties( const GByte* pabyProperties,
+                                         uint32_t nSize, Visitor& oVisitor );
+
+    bool                WriteHeader( VSILFILE* fp, uint64_t nFeaturesCount,
+                                     const OGREnvelope& sExtent );
+    bool                WriteProperties( const OGRFeature* poFeature );
+    bool                Finalize();
+
+  protected:
+    virtual int         GetNextArrowArray( struct ArrowArrayStream* stream,
+                                           struct ArrowArray* out_array ) override;
+
+  public:
+    virtual ~OGRFlatGeobufLayer();
+
+    static OGRFlatGeobufLayer *Open( const char* pszFilename, VSILFILE* fp );
+    static OGRFlatGeobufLayer *Create( const char* pszFilename,
+                                       const char* pszLayerName,
+                                       OGRSpatialReference* poSRS,
+                                       OGRwkbGeometryType eGType,
+                                       CSLConstList papszOptions );
+
+    virtual OGRFeatureDefn *GetLayerDefn() override { return m_poFeatureDefn; }
+    virtual OGRSpatialReference *GetSpatialRef() override { return m_poSRS; }
+
+    virtual void        ResetReading() override;
+    virtual OGRFeature *GetNextFeature() override;
+    virtual OGRFeature *GetFeature( GIntBig nFID ) override;
+    virtual GIntBig     GetFeatureCount( int bForce = TRUE ) override;
+    virtual OGRErr      GetExtent( OGREnvelope *psExtent,
+                                   int bForce = TRUE ) override;
+    virtual OGRErr      GetExtent( int iGeomField, OGREnvelope *psExtent,
+                                   int bForce ) override
+                { return OGRLayer::GetExtent(iGeomField, psExtent, bForce); }
+
+    virtual OGRErr      CreateField( OGRFieldDefn *poField,
+                                     int bApproxOK = TRUE ) override;
+    virtual OGRErr      ICreateFeature( OGRFeature *poFeature ) override;
+
+    virtual int         TestCapability( const char * ) override;
+};
+
+/************************************************************************/
+/*                         OGRFlatGeobufDataset                         */
+/************************************************************************/
+
+class OGRFlatGeobufDataset final: public GDALDataset
+{
+    std::vector<std::unique_ptr<OGRFlatGeobufLayer>> m_apoLayers{};
+    bool                m_bCreate = false;
+    bool                m_bIsDir = false;
+
+  public:
+    OGRFlatGeobufDataset( const char* pszName, bool bIsDir, bool bCreate );
+
+    static int          Identify( GDALOpenInfo* poOpenInfo );
+    static GDALDataset *Open( GDALOpenInfo* poOpenInfo );
+    static GDALDataset *Create( const char *pszName, int nBands, int nXSize,
+                                int nYSize, GDALDataType eDT,
+                                char **papszOptions );
+
+    virtual int         GetLayerCount() override
+                { return static_cast<int>(m_apoLayers.size()); }
+    virtual OGRLayer   *GetLayer( int iLayer ) override;
+    virtual int         TestCapability( const char *pszCap ) override;
+
+    virtual OGRLayer   *ICreateLayer( const char *pszName,
+                                      OGRSpatialReference *poSpatialRef = nullptr,
+                                      OGRwkbGeometryType eGType = wkbUnknown,
+                                      char ** papszOptions = nullptr ) override;
+};
+
+#endif /* ndef OGR_FLATGEOBUF_H_INCLUDED */
@@ -0,0 +1,264 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Implements OGRFlatGeobufDataset class and driver registration.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "flatgeobuf.h"
+
+#include "ogr_flatgeobuf.h"
+
+CPL_CVSID("$Id$")
+
+using namespace FlatGeobuf;
+
+/************************************************************************/
+/*                        OGRFlatGeobufDataset()                        */
+/************************************************************************/
+
+OGRFlatGeobufDataset::OGRFlatGeobufDataset( const char* pszName,
+                                            bool bIsDir, bool bCreate ) :
+    m_bCreate(bCreate),
+    m_bIsDir(bIsDir)
+{
+    SetDescription(pszName);
+}
+
+/************************************************************************/
+/*                              Identify()                              */
+/************************************************************************/
+
+int OGRFlatGeobufDataset::Identify( GDALOpenInfo* poOpenInfo )
+{
+    // Directories may contain .fgb files.
+    if( poOpenInfo->bIsDirectory )
+        return -1;
+
+    if( poOpenInfo->fpL == nullptr ||
+        poOpenInfo->nHeaderBytes < static_cast<int>(nMagicBytesSize) )
+        return FALSE;
+
+    // Any version, Open() reports the unsupported ones.
+    return memcmp(poOpenInfo->pabyHeader, abyMagicBytes, 3) == 0;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+GDALDataset *OGRFlatGeobufDataset::Open( GDALOpenInfo* poOpenInfo )
+{
+    if( Identify(poOpenInfo) == FALSE )
+        return nullptr;
+    if( poOpenInfo->eAccess == GA_Update )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "FlatGeobuf driver does not support update");
+        return nullptr;
+    }
+
+    if( !poOpenInfo->bIsDirectory )
+    {
+        if( poOpenInfo->pabyHeader[3] != abyMagicBytes[3] )
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Unsupported FlatGeobuf version %d",
+                     poOpenInfo->pabyHeader[3]);
+            return nullptr;
+        }
+
+        OGRFlatGeobufLayer* poLayer =
+            OGRFlatGeobufLayer::Open(poOpenInfo->pszFilename,
+                                     poOpenInfo->fpL);
+        poOpenInfo->fpL = nullptr;
+        if( poLayer == nullptr )
+            return nullptr;
+
+        auto poDS = new OGRFlatGeobufDataset(poOpenInfo->pszFilename,
+                                             false, false);
+        poDS->m_apoLayers.emplace_back(poLayer);
+        return poDS;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Directory: one layer per .fgb file.                             */
+/* -------------------------------------------------------------------- */
+    char** papszFiles = VSIReadDir(poOpenInfo->pszFilename);
+    std::unique_ptr<OGRFlatGeobufDataset> poDS(
+        new OGRFlatGeobufDataset(poOpenInfo->pszFilename, true, false));
+    for( char** papszIter = papszFiles; papszIter && *papszIter; ++papszIter )
+    {
+        if( !EQUAL(CPLGetExtension(*papszIter), "fgb") )
+            continue;
+
+        const CPLString osFilename =
+            CPLFormFilename(poOpenInfo->pszFilename, *papszIter, nullptr);
+        GDALOpenInfo oOpenInfo(osFilename, GA_ReadOnly);
+        if( Identify(&oOpenInfo) != TRUE ||
+            oOpenInfo.pabyHeader[3] != abyMagicBytes[3] )
+            continue;
+
+        OGRFlatGeobufLayer* poLayer =
+            OGRFlatGeobufLayer::Open(osFilename, oOpenInfo.fpL);
+        oOpenInfo.fpL = nullptr;
+        if( poLayer )
+            poDS->m_apoLayers.emplace_back(poLayer);
+    }
+    CSLDestroy(papszFiles);
+
+    if( poDS->m_apoLayers.empty() )
+        return nullptr;
+    return poDS.release();
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/*                                                                      */
+/*      A .fgb name is a single layer file, anything else a directory   */
+/*      with one file per layer.                                        */
+/************************************************************************/
+
+GDALDataset *OGRFlatGeobufDataset::Create( const char *pszName,
+                                           int /* nBands */,
+                                           int /* nXSize */,
+                                           int /* nYSize */,
+                                           GDALDataType /* eDT */,
+                                           char ** /* papszOptions */ )
+{
+    const bool bIsDir = !EQUAL(CPLGetExtension(pszName), "fgb");
+    if( bIsDir )
+    {
+        VSIStatBufL sStat;
+        if( VSIStatL(pszName, &sStat) == 0 )
+        {
+            if( !VSI_ISDIR(sStat.st_mode) )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "%s is not a directory", pszName);
+                return nullptr;
+            }
+        }
+        else if( VSIMkdir(pszName, 0755) != 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot create directory %s", pszName);
+            return nullptr;
+        }
+    }
+
+    return new OGRFlatGeobufDataset(pszName, bIsDir, true);
+}
+
+/************************************************************************/
+/*                              GetLayer()                              */
+/************************************************************************/
+
+OGRLayer *OGRFlatGeobufDataset::GetLayer( int iLayer )
+{
+    if( iLayer < 0 || iLayer >= GetLayerCount() )
+        return nullptr;
+    return m_apoLayers[iLayer].get();
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRFlatGeobufDataset::TestCapability( const char *pszCap )
+{
+    if( EQUAL(pszCap, ODsCCreateLayer) )
+        return m_bCreate && (m_bIsDir || m_apoLayers.empty());
+    return FALSE;
+}
+
+/************************************************************************/
+/*                            ICreateLayer()                            */
+/************************************************************************/
+
+OGRLayer *OGRFlatGeobufDataset::ICreateLayer( const char *pszName,
+                                              OGRSpatialReference *poSRS,
+                                              OGRwkbGeometryType eGType,
+                                              char ** papszOptions )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Data source %s opened read-only", GetDescription());
+        return nullptr;
+    }
+    if( !m_bIsDir && !m_apoLayers.empty() )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "A .fgb file can only hold a single layer. "
+                 "Use a directory name to create several layers");
+        return nullptr;
+    }
+
+    const CPLString osFilename =
+        m_bIsDir ? CPLString(CPLFormFilename(GetDescription(), pszName, "fgb"))
+                 : CPLString(GetDescription());
+    OGRFlatGeobufLayer* poLayer = OGRFlatGeobufLayer::Create(
+        osFilename, pszName, poSRS, eGType, papszOptions);
+    if( poLayer == nullptr )
+        return nullptr;
+    m_apoLayers.emplace_back(poLayer);
+    return poLayer;
+}
+
+/************************************************************************/
+/*                       RegisterOGRFlatGeobuf()                        */
+/************************************************************************/
+
+void RegisterOGRFlatGeobuf()
+{
+    if( GDALGetDriverByName( "FlatGeobuf" ) != nullptr )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( "FlatGeobuf" );
+    poDriver->SetMetadataItem( GDAL_DCAP_VECTOR, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "FlatGeobuf" );
+    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "fgb" );
+    poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drv_flatgeobuf.html" );
+
+    poDriver->SetMetadataItem( GDAL_DS_LAYER_CREATIONOPTIONLIST,
+"<LayerCreationOptionList>"
+"  <Option name='SPATIAL_INDEX' type='boolean' description='Whether to create a spatial index' default='YES'/>"
+"  <Option name='INDEX_NODE_SIZE' type='int' description='Number of items per node of the spatial index' default='16'/>"
+"</LayerCreationOptionList>");
+
+    poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATATYPES,
+                               "Integer Integer64 Real String Date Time "
+                               "DateTime Binary" );
+    poDriver->SetMetadataItem( GDAL_DMD_CREATIONFIELDDATASUBTYPES,
+                               "Boolean Int16 Float32 JSON" );
+
+    poDriver->pfnOpen = OGRFlatGeobufDataset::Open;
+    poDriver->pfnIdentify = OGRFlatGeobufDataset::Identify;
+    poDriver->pfnCreate = OGRFlatGeobufDataset::Create;
+
+    GetGDALDriverManager()->RegisterDriver( poDriver );
+}
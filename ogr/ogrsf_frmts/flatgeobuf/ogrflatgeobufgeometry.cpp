@@ -0,0 +1,657 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Encoding of OGR geometries as FlatGeobuf Geometry tables.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "flatgeobuf.h"
+
+#include "ogr_flatgeobuf.h"
+
+#include <algorithm>
+
+CPL_CVSID("$Id$")
+
+using namespace FlatGeobuf;
+
+// Protection against stack overflows on corrupted files.
+constexpr int MAX_GEOMETRY_DEPTH = 32;
+
+/************************************************************************/
+/*                    OGRFlatGeobufGetGeometryType()                    */
+/************************************************************************/
+
+GeometryType OGRFlatGeobufGetGeometryType( OGRwkbGeometryType eGType )
+{
+    const OGRwkbGeometryType eFlatType = wkbFlatten(eGType);
+    if( eFlatType == wkbLinearRing )
+        return GeometryType::LineString;
+    if( eFlatType >= wkbPoint && eFlatType <= wkbTriangle )
+        return static_cast<GeometryType>(eFlatType);
+    return GeometryType::Unknown;
+}
+
+/************************************************************************/
+/*                  OGRFlatGeobufGetOGRGeometryType()                   */
+/************************************************************************/
+
+OGRwkbGeometryType OGRFlatGeobufGetOGRGeometryType( GeometryType eType,
+                                                    bool bHasZ, bool bHasM )
+{
+    return OGR_GT_SetModifier(static_cast<OGRwkbGeometryType>(eType),
+                              bHasZ, bHasM);
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                               Reading                                */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+struct GeometryArrays
+{
+    const GByte *pabyXY = nullptr;
+    const GByte *pabyZ = nullptr;
+    const GByte *pabyM = nullptr;
+    const GByte *pabyEnds = nullptr;
+    uint32_t     nPoints = 0;
+    uint32_t     nEnds = 0;
+
+    static double GetDouble( const GByte* pabyData, size_t i )
+    {
+        double dfVal;
+        memcpy(&dfVal, pabyData + i * sizeof(double), sizeof(double));
+        CPL_LSBPTR64(&dfVal);
+        return dfVal;
+    }
+
+    uint32_t GetEnd( uint32_t i ) const
+    {
+        uint32_t nEnd;
+        memcpy(&nEnd, pabyEnds + i * sizeof(uint32_t), sizeof(uint32_t));
+        CPL_LSBPTR32(&nEnd);
+        return nEnd;
+    }
+
+    bool Init( const Table& oGeometry, bool bHasZ, bool bHasM );
+    void SetPoints( OGRSimpleCurve* poCurve, uint32_t nStart,
+                    uint32_t nEnd ) const;
+    bool GetParts( std::vector<std::pair<uint32_t, uint32_t>>& aoParts ) const;
+};
+
+/************************************************************************/
+/*                       GeometryArrays::Init()                         */
+/************************************************************************/
+
+bool GeometryArrays::Init( const Table& oGeometry, bool bHasZ, bool bHasM )
+{
+    uint32_t nXY = 0;
+    pabyXY = oGeometry.GetVector(Geometry::xy, sizeof(double), nXY);
+    if( (nXY % 2) != 0 )
+        return false;
+    nPoints = nXY / 2;
+
+    if( bHasZ )
+    {
+        uint32_t nZ = 0;
+        pabyZ = oGeometry.GetVector(Geometry::z, sizeof(double), nZ);
+        if( pabyZ != nullptr && nZ != nPoints )
+            return false;
+    }
+    if( bHasM )
+    {
+        uint32_t nM = 0;
+        pabyM = oGeometry.GetVector(Geometry::m, sizeof(double), nM);
+        if( pabyM != nullptr && nM != nPoints )
+            return false;
+    }
+
+    pabyEnds = oGeometry.GetVector(Geometry::ends, sizeof(uint32_t), nEnds);
+    return true;
+}
+
+/************************************************************************/
+/*                     GeometryArrays::SetPoints()                      */
+/************************************************************************/
+
+void GeometryArrays::SetPoints( OGRSimpleCurve* poCurve, uint32_t nStart,
+                                uint32_t nEnd ) const
+{
+    const int nCount = static_cast<int>(nEnd - nStart);
+    std::vector<OGRRawPoint> aoPoints(nCount);
+    std::vector<double> adfZ(pabyZ ? nCount : 0);
+    std::vector<double> adfM(pabyM ? nCount : 0);
+    for( int i = 0; i < nCount; i++ )
+    {
+        aoPoints[i].x = GetDouble(pabyXY, 2 * (nStart + i));
+        aoPoints[i].y = GetDouble(pabyXY, 2 * (nStart + i) + 1);
+        if( pabyZ )
+            adfZ[i] = GetDouble(pabyZ, nStart + i);
+        if( pabyM )
+            adfM[i] = GetDouble(pabyM, nStart + i);
+    }
+    poCurve->setPoints(nCount, aoPoints.data(),
+                       pabyZ ? adfZ.data() : nullptr,
+                       pabyM ? adfM.data() : nullptr);
+}
+
+/************************************************************************/
+/*                      GeometryArrays::GetParts()                      */
+/*                                                                      */
+/*      [start, end) point ranges of the parts delimited by ends. No    */
+/*      ends means a single part.                                       */
+/************************************************************************/
+
+bool GeometryArrays::GetParts(
+                std::vector<std::pair<uint32_t, uint32_t>>& aoParts ) const
+{
+    if( nEnds == 0 )
+    {
+        if( nPoints > 0 )
+            aoParts.emplace_back(0, nPoints);
+        return true;
+    }
+
+    uint32_t nStart = 0;
+    for( uint32_t i = 0; i < nEnds; i++ )
+    {
+        const uint32_t nEnd = GetEnd(i);
+        if( nEnd < nStart || nEnd > nPoints )
+            return false;
+        aoParts.emplace_back(nStart, nEnd);
+        nStart = nEnd;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           ReadGeometry()                             */
+/************************************************************************/
+
+OGRGeometry *ReadGeometry( const Table& oGeometry, GeometryType eType,
+                           bool bHasZ, bool bHasM, int nDepth )
+{
+    if( nDepth > MAX_GEOMETRY_DEPTH )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Too many nested geometry parts");
+        return nullptr;
+    }
+
+    if( eType == GeometryType::Unknown )
+        eType = static_cast<GeometryType>(
+            oGeometry.GetScalar<GByte>(Geometry::type, 0));
+
+    GeometryArrays oArrays;
+    std::vector<std::pair<uint32_t, uint32_t>> aoParts;
+    if( !oArrays.Init(oGeometry, bHasZ, bHasM) || !oArrays.GetParts(aoParts) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Corrupted geometry");
+        return nullptr;
+    }
+
+    std::unique_ptr<OGRGeometry> poGeom;
+    switch( eType )
+    {
+        case GeometryType::Point:
+        {
+            auto poPoint = new OGRPoint();
+            poGeom.reset(poPoint);
+            if( oArrays.nPoints > 0 )
+            {
+                poPoint->setX(GeometryArrays::GetDouble(oArrays.pabyXY, 0));
+                poPoint->setY(GeometryArrays::GetDouble(oArrays.pabyXY, 1));
+                if( oArrays.pabyZ )
+                    poPoint->setZ(GeometryArrays::GetDouble(oArrays.pabyZ, 0));
+                if( oArrays.pabyM )
+                    poPoint->setM(GeometryArrays::GetDouble(oArrays.pabyM, 0));
+            }
+            break;
+        }
+
+        case GeometryType::MultiPoint:
+        {
+            auto poMP = new OGRMultiPoint();
+            poGeom.reset(poMP);
+            for( uint32_t i = 0; i < oArrays.nPoints; i++ )
+            {
+                auto poPoint = new OGRPoint(
+                    GeometryArrays::GetDouble(oArrays.pabyXY, 2 * i),
+                    GeometryArrays::GetDouble(oArrays.pabyXY, 2 * i + 1));
+                if( oArrays.pabyZ )
+                    poPoint->setZ(GeometryArrays::GetDouble(oArrays.pabyZ, i));
+                if( oArrays.pabyM )
+                    poPoint->setM(GeometryArrays::GetDouble(oArrays.pabyM, i));
+                poMP->addGeometryDirectly(poPoint);
+            }
+            break;
+        }
+
+        case GeometryType::LineString:
+        case GeometryType::CircularString:
+        {
+            OGRSimpleCurve* poCurve =
+                eType == GeometryType::LineString ?
+                    static_cast<OGRSimpleCurve*>(new OGRLineString()) :
+                    static_cast<OGRSimpleCurve*>(new OGRCircularString());
+            poGeom.reset(poCurve);
+            oArrays.SetPoints(poCurve, 0, oArrays.nPoints);
+            break;
+        }
+
+        case GeometryType::MultiLineString:
+        {
+            auto poMLS = new OGRMultiLineString();
+            poGeom.reset(poMLS);
+            for( const auto& oPart: aoParts )
+            {
+                auto poLS = new OGRLineString();
+                oArrays.SetPoints(poLS, oPart.first, oPart.second);
+                poMLS->addGeometryDirectly(poLS);
+            }
+            break;
+        }
+
+        case GeometryType::Polygon:
+        case GeometryType::Triangle:
+        {
+            OGRPolygon* poPoly =
+                eType == GeometryType::Polygon ? new OGRPolygon() :
+                                                 new OGRTriangle();
+            poGeom.reset(poPoly);
+            for( const auto& oPart: aoParts )
+            {
+                auto poRing = new OGRLinearRing();
+                oArrays.SetPoints(poRing, oPart.first, oPart.second);
+                if( poPoly->addRingDirectly(poRing) != OGRERR_NONE )
+                {
+                    delete poRing;
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Corrupted geometry");
+                    return nullptr;
+                }
+            }
+            break;
+        }
+
+        case GeometryType::TIN:
+        {
+            auto poTIN = new OGRTriangulatedSurface();
+            poGeom.reset(poTIN);
+            for( const auto& oPart: aoParts )
+            {
+                auto poRing = new OGRLinearRing();
+                oArrays.SetPoints(poRing, oPart.first, oPart.second);
+                auto poTriangle = new OGRTriangle();
+                if( poTriangle->addRingDirectly(poRing) != OGRERR_NONE )
+                {
+                    delete poRing;
+                    delete poTriangle;
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Corrupted geometry");
+                    return nullptr;
+                }
+                if( poTIN->addGeometryDirectly(poTriangle) != OGRERR_NONE )
+                {
+                    delete poTriangle;
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Corrupted geometry");
+                    return nullptr;
+                }
+            }
+            break;
+        }
+
+        case GeometryType::MultiPolygon:
+        case GeometryType::GeometryCollection:
+        case GeometryType::CompoundCurve:
+        case GeometryType::CurvePolygon:
+        case GeometryType::MultiCurve:
+        case GeometryType::MultiSurface:
+        case GeometryType::PolyhedralSurface:
+        {
+            poGeom.reset(OGRGeometryFactory::createGeometry(
+                static_cast<OGRwkbGeometryType>(eType)));
+            if( !poGeom )
+                return nullptr;
+
+            // Type of the parts when they do not hold it.
+            const GeometryType eDefaultPartType =
+                (eType == GeometryType::MultiPolygon ||
+                 eType == GeometryType::PolyhedralSurface) ?
+                    GeometryType::Polygon : GeometryType::Unknown;
+
+            const uint32_t nParts =
+                oGeometry.GetTableVectorSize(Geometry::parts);
+            for( uint32_t i = 0; i < nParts; i++ )
+            {
+                const Table oPart =
+                    oGeometry.GetTableVectorItem(Geometry::parts, i);
+                GeometryType ePartType = static_cast<GeometryType>(
+                    oPart.GetScalar<GByte>(Geometry::type, 0));
+                if( ePartType == GeometryType::Unknown )
+                    ePartType = eDefaultPartType;
+                if( ePartType == GeometryType::Unknown )
+                {
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Corrupted geometry");
+                    return nullptr;
+                }
+
+                OGRGeometry* poPart = ReadGeometry(oPart, ePartType,
+                                                   bHasZ, bHasM, nDepth + 1);
+                if( poPart == nullptr )
+                    return nullptr;
+
+                OGRErr eErr = OGRERR_FAILURE;
+                if( eType == GeometryType::CompoundCurve )
+                {
+                    if( OGR_GT_IsCurve(poPart->getGeometryType()) &&
+                        !OGR_GT_IsSubClassOf(poPart->getGeometryType(),
+                                             wkbCompoundCurve) )
+                        eErr = poGeom->toCompoundCurve()->addCurveDirectly(
+                            poPart->toCurve());
+                }
+                else if( eType == GeometryType::CurvePolygon )
+                {
+                    if( OGR_GT_IsCurve(poPart->getGeometryType()) )
+                        eErr = poGeom->toCurvePolygon()->addRingDirectly(
+                            poPart->toCurve());
+                }
+                else if( eType == GeometryType::PolyhedralSurface )
+                {
+                    eErr = poGeom->toPolyhedralSurface()->addGeometryDirectly(
+                        poPart);
+                }
+                else
+                {
+                    eErr = poGeom->toGeometryCollection()->addGeometryDirectly(
+                        poPart);
+                }
+                if( eErr != OGRERR_NONE )
+                {
+                    delete poPart;
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Corrupted geometry");
+                    return nullptr;
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Unsupported geometry type %d", static_cast<int>(eType));
+            return nullptr;
+        }
+    }
+
+    return poGeom.release();
+}
+
+} // namespace
+
+/************************************************************************/
+/*                     OGRFlatGeobufReadGeometry()                      */
+/************************************************************************/
+
+OGRGeometry *OGRFlatGeobufReadGeometry( const Table& oGeometry,
+                                        GeometryType eType,
+                                        bool bHasZ, bool bHasM )
+{
+    OGRGeometry* poGeom = ReadGeometry(oGeometry, eType, bHasZ, bHasM, 0);
+    if( poGeom )
+    {
+        poGeom->set3D(bHasZ);
+        poGeom->setMeasured(bHasM);
+    }
+    return poGeom;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                               Writing                                */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+struct GeometryWriter
+{
+    Builder&              m_oBuilder;
+    const bool            m_bHasZ;
+    const bool            m_bHasM;
+    std::vector<double>   m_adfXY{};
+    std::vector<double>   m_adfZ{};
+    std::vector<double>   m_adfM{};
+    std::vector<uint32_t> m_anEnds{};
+
+    GeometryWriter( Builder& oBuilder, bool bHasZ, bool bHasM ) :
+        m_oBuilder(oBuilder), m_bHasZ(bHasZ), m_bHasM(bHasM) {}
+
+    void AddPoint( const OGRPoint* poPoint );
+    void AddCurve( const OGRSimpleCurve* poCurve );
+    void EndPart() { m_anEnds.push_back(
+                        static_cast<uint32_t>(m_adfXY.size() / 2)); }
+
+    template<class T> uint32_t CreateVector( std::vector<T>& aValues )
+    {
+        if( aValues.empty() )
+            return 0;
+#ifdef CPL_MSB
+        for( auto& val: aValues )
+            SwapToLSB(&val);
+#endif
+        return m_oBuilder.CreateVector(aValues);
+    }
+
+    uint32_t Write( const OGRGeometry* poGeom, bool bWriteType, int nDepth );
+};
+
+/************************************************************************/
+/*                     GeometryWriter::AddPoint()                       */
+/************************************************************************/
+
+void GeometryWriter::AddPoint( const OGRPoint* poPoint )
+{
+    if( poPoint->IsEmpty() )
+        return;
+    m_adfXY.push_back(poPoint->getX());
+    m_adfXY.push_back(poPoint->getY());
+    if( m_bHasZ )
+        m_adfZ.push_back(poPoint->getZ());
+    if( m_bHasM )
+        m_adfM.push_back(poPoint->getM());
+}
+
+/************************************************************************/
+/*                     GeometryWriter::AddCurve()                       */
+/************************************************************************/
+
+void GeometryWriter::AddCurve( const OGRSimpleCurve* poCurve )
+{
+    const int nPoints = poCurve->getNumPoints();
+    for( int i = 0; i < nPoints; i++ )
+    {
+        m_adfXY.push_back(poCurve->getX(i));
+        m_adfXY.push_back(poCurve->getY(i));
+        if( m_bHasZ )
+            m_adfZ.push_back(poCurve->getZ(i));
+        if( m_bHasM )
+            m_adfM.push_back(poCurve->getM(i));
+    }
+}
+
+/************************************************************************/
+/*                       GeometryWriter::Write()                        */
+/************************************************************************/
+
+uint32_t GeometryWriter::Write( const OGRGeometry* poGeom, bool bWriteType,
+                                int nDepth )
+{
+    if( nDepth > MAX_GEOMETRY_DEPTH )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Too many nested geometry parts");
+        return 0;
+    }
+
+    const GeometryType eType =
+        OGRFlatGeobufGetGeometryType(poGeom->getGeometryType());
+    std::vector<uint32_t> anParts;
+
+    switch( eType )
+    {
+        case GeometryType::Point:
+            AddPoint(poGeom->toPoint());
+            break;
+
+        case GeometryType::MultiPoint:
+            for( const auto poPoint: *(poGeom->toMultiPoint()) )
+                AddPoint(poPoint);
+            break;
+
+        case GeometryType::LineString:
+        case GeometryType::CircularString:
+            AddCurve(poGeom->toSimpleCurve());
+            break;
+
+        case GeometryType::MultiLineString:
+            for( const auto poLS: *(poGeom->toMultiLineString()) )
+            {
+                AddCurve(poLS);
+                EndPart();
+            }
+            break;
+
+        case GeometryType::Polygon:
+        case GeometryType::Triangle:
+            for( const auto poRing: *(poGeom->toPolygon()) )
+            {
+                AddCurve(poRing);
+                EndPart();
+            }
+            break;
+
+        case GeometryType::TIN:
+            for( const auto poTriangle: *(poGeom->toTriangulatedSurface()) )
+            {
+                if( poTriangle->IsEmpty() )
+                    continue;
+                AddCurve(poTriangle->getExteriorRing());
+                EndPart();
+            }
+            break;
+
+        case GeometryType::MultiPolygon:
+        case GeometryType::GeometryCollection:
+        case GeometryType::CompoundCurve:
+        case GeometryType::CurvePolygon:
+        case GeometryType::MultiCurve:
+        case GeometryType::MultiSurface:
+        case GeometryType::PolyhedralSurface:
+        {
+            std::vector<const OGRGeometry*> apoParts;
+            if( eType == GeometryType::CompoundCurve )
+            {
+                for( const auto poCurve: *(poGeom->toCompoundCurve()) )
+                    apoParts.push_back(poCurve);
+            }
+            else if( eType == GeometryType::CurvePolygon )
+            {
+                for( const auto poRing: *(poGeom->toCurvePolygon()) )
+                    apoParts.push_back(poRing);
+            }
+            else if( eType == GeometryType::PolyhedralSurface )
+            {
+                for( const auto poPoly: *(poGeom->toPolyhedralSurface()) )
+                    apoParts.push_back(poPoly);
+            }
+            else
+            {
+                for( const auto poPart: *(poGeom->toGeometryCollection()) )
+                    apoParts.push_back(poPart);
+            }
+
+            for( const auto poPart: apoParts )
+            {
+                GeometryWriter oPartWriter(m_oBuilder, m_bHasZ, m_bHasM);
+                const uint32_t nPart =
+                    oPartWriter.Write(poPart, true, nDepth + 1);
+                if( nPart == 0 )
+                    return 0;
+                anParts.push_back(nPart);
+            }
+            break;
+        }
+
+        default:
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Unsupported geometry type %s",
+                     OGRGeometryTypeToName(poGeom->getGeometryType()));
+            return 0;
+        }
+    }
+
+    // A single part does not need ends.
+    if( m_anEnds.size() == 1 )
+        m_anEnds.clear();
+
+    const uint32_t nEnds = CreateVector(m_anEnds);
+    const uint32_t nXY = CreateVector(m_adfXY);
+    const uint32_t nZ = CreateVector(m_adfZ);
+    const uint32_t nM = CreateVector(m_adfM);
+    const uint32_t nParts =
+        anParts.empty() ? 0 : m_oBuilder.CreateTableVector(anParts);
+
+    m_oBuilder.StartTable();
+    m_oBuilder.AddOffset(Geometry::ends, nEnds);
+    m_oBuilder.AddOffset(Geometry::xy, nXY);
+    m_oBuilder.AddOffset(Geometry::z, nZ);
+    m_oBuilder.AddOffset(Geometry::m, nM);
+    m_oBuilder.AddOffset(Geometry::parts, nParts);
+    if( bWriteType )
+        m_oBuilder.AddScalar<GByte>(Geometry::type,
+                                    static_cast<GByte>(eType), 0);
+    return m_oBuilder.EndTable();
+}
+
+} // namespace
+
+/************************************************************************/
+/*                     OGRFlatGeobufWriteGeometry()                     */
+/************************************************************************/
+
+uint32_t OGRFlatGeobufWriteGeometry( Builder& oBuilder,
+                                     const OGRGeometry* poGeom,
+                                     bool bWriteType,
+                                     bool bHasZ, bool bHasM )
+{
+    GeometryWriter oWriter(oBuilder, bHasZ, bHasM);
+    return oWriter.Write(poGeom, bWriteType, 0);
+}
@@ -0,0 +1,1608 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Implements OGRFlatGeobufLayer class.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "flatgeobuf.h"
+
+#include "ogr_flatgeobuf.h"
+#include "ogr_p.h"
+#include "ogrlayerarrow.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+
+CPL_CVSID("$Id$")
+
+using namespace FlatGeobuf;
+
+// Limits of the batches of features fetched with VSIFReadMultiRangeL()
+// when reading through the spatial index.
+constexpr size_t MAX_BATCH_ITEMS = 1000;
+constexpr size_t MAX_BATCH_SIZE = 10 * 1024 * 1024;
+
+/************************************************************************/
+/*                            ReadValue()                               */
+/************************************************************************/
+
+template<class T> static T ReadValue( const GByte* pabyData )
+{
+    T val;
+    memcpy(&val, pabyData, sizeof(T));
+    SwapToLSB(&val);
+    return val;
+}
+
+/************************************************************************/
+/*                           AppendValue()                              */
+/************************************************************************/
+
+template<class T> static void AppendValue( std::vector<GByte>& abyBuf, T val )
+{
+    SwapToLSB(&val);
+    const GByte* pabyVal = reinterpret_cast<const GByte*>(&val);
+    abyBuf.insert(abyBuf.end(), pabyVal, pabyVal + sizeof(T));
+}
+
+static void AppendBytes( std::vector<GByte>& abyBuf, const void* pData,
+                         size_t nLen )
+{
+    AppendValue(abyBuf, static_cast<uint32_t>(nLen));
+    const GByte* pabyData = static_cast<const GByte*>(pData);
+    abyBuf.insert(abyBuf.end(), pabyData, pabyData + nLen);
+}
+
+/************************************************************************/
+/*                       ~OGRFlatGeobufLayer()                          */
+/************************************************************************/
+
+OGRFlatGeobufLayer::~OGRFlatGeobufLayer()
+{
+    if( m_bCreate )
+        Finalize();
+    if( m_poFp )
+        VSIFCloseL(m_poFp);
+    if( m_poFpWrite )
+        VSIFCloseL(m_poFpWrite);
+    if( m_poFeatureDefn )
+        m_poFeatureDefn->Release();
+    if( m_poSRS )
+        m_poSRS->Release();
+}
+
+/* ==================================================================== */
+/*                               Reading                                */
+/* ==================================================================== */
+
+/************************************************************************/
+/*                          GetOGRFieldType()                           */
+/************************************************************************/
+
+static void GetOGRFieldType( ColumnType eType, OGRFieldType& eFieldType,
+                             OGRFieldSubType& eSubType )
+{
+    eSubType = OFSTNone;
+    switch( eType )
+    {
+        case ColumnType::Byte:
+        case ColumnType::UByte:
+        case ColumnType::UShort:
+        case ColumnType::Int:
+            eFieldType = OFTInteger;
+            break;
+        case ColumnType::Bool:
+            eFieldType = OFTInteger;
+            eSubType = OFSTBoolean;
+            break;
+        case ColumnType::Short:
+            eFieldType = OFTInteger;
+            eSubType = OFSTInt16;
+            break;
+        case ColumnType::UInt:
+        case ColumnType::Long:
+            eFieldType = OFTInteger64;
+            break;
+        case ColumnType::Float:
+            eFieldType = OFTReal;
+            eSubType = OFSTFloat32;
+            break;
+        case ColumnType::ULong:
+        case ColumnType::Double:
+            eFieldType = OFTReal;
+            break;
+        case ColumnType::Json:
+            eFieldType = OFTString;
+            eSubType = OFSTJSON;
+            break;
+        case ColumnType::DateTime:
+            eFieldType = OFTDateTime;
+            break;
+        case ColumnType::Binary:
+            eFieldType = OFTBinary;
+            break;
+        case ColumnType::String:
+        default:
+            eFieldType = OFTString;
+            break;
+    }
+}
+
+/************************************************************************/
+/*                             ReadHeader()                             */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::ReadHeader( const GByte* pabyHeader, uint32_t nSize )
+{
+    const Table oHeader = Table::GetRoot(pabyHeader, nSize);
+    if( !oHeader.IsValid() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Invalid header");
+        return false;
+    }
+
+    std::string osName = oHeader.GetString(Header::name);
+    if( osName.empty() )
+        osName = CPLGetBasename(m_osFilename.c_str());
+    m_poFeatureDefn = new OGRFeatureDefn(osName.c_str());
+    SetDescription(m_poFeatureDefn->GetName());
+    m_poFeatureDefn->Reference();
+
+    const GByte nGeomType = oHeader.GetScalar<GByte>(Header::geometry_type, 0);
+    if( nGeomType > static_cast<GByte>(GeometryType::Triangle) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Unsupported geometry type %d", nGeomType);
+        return false;
+    }
+    m_eGeomType = static_cast<GeometryType>(nGeomType);
+    m_bHasZ = oHeader.GetBool(Header::has_z, false);
+    m_bHasM = oHeader.GetBool(Header::has_m, false);
+    m_poFeatureDefn->SetGeomType(
+        OGRFlatGeobufGetOGRGeometryType(m_eGeomType, m_bHasZ, m_bHasM));
+
+    uint32_t nEnvelope = 0;
+    const GByte* pabyEnvelope =
+        oHeader.GetVector(Header::envelope, sizeof(double), nEnvelope);
+    if( pabyEnvelope && nEnvelope == 4 )
+    {
+        m_sExtent.MinX = ReadValue<double>(pabyEnvelope);
+        m_sExtent.MinY = ReadValue<double>(pabyEnvelope + 8);
+        m_sExtent.MaxX = ReadValue<double>(pabyEnvelope + 16);
+        m_sExtent.MaxY = ReadValue<double>(pabyEnvelope + 24);
+        // Also false for NaN, which means an unknown extent.
+        m_bHasExtent = m_sExtent.MinX <= m_sExtent.MaxX &&
+                       m_sExtent.MinY <= m_sExtent.MaxY;
+    }
+
+    m_nFeaturesCount = oHeader.GetScalar<uint64_t>(Header::features_count, 0);
+    m_nIndexNodeSize = oHeader.GetScalar<uint16_t>(Header::index_node_size,
+                                                   nDefaultNodeSize);
+    if( m_nIndexNodeSize < 2 )
+        m_nIndexNodeSize = 0;
+
+/* -------------------------------------------------------------------- */
+/*      CRS: an authority code, or a WKT definition.                    */
+/* -------------------------------------------------------------------- */
+    const Table oCrs = oHeader.GetTable(Header::crs);
+    if( oCrs.IsValid() )
+    {
+        const std::string osOrg = oCrs.GetString(Crs::org);
+        const int nCode = oCrs.GetScalar<int32_t>(Crs::code, 0);
+        const std::string osWKT = oCrs.GetString(Crs::wkt);
+
+        m_poSRS = new OGRSpatialReference();
+        m_poSRS->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+        OGRErr eErr = OGRERR_FAILURE;
+        if( nCode > 0 && (osOrg.empty() || EQUAL(osOrg.c_str(), "EPSG")) )
+            eErr = m_poSRS->importFromEPSG(nCode);
+        if( eErr != OGRERR_NONE && !osWKT.empty() )
+            eErr = m_poSRS->importFromWkt(osWKT.c_str());
+        if( eErr != OGRERR_NONE && nCode > 0 )
+            eErr = m_poSRS->SetFromUserInput(
+                CPLSPrintf("%s:%d", osOrg.c_str(), nCode));
+        if( eErr != OGRERR_NONE )
+        {
+            m_poSRS->Release();
+            m_poSRS = nullptr;
+        }
+        else if( m_poFeatureDefn->GetGeomFieldCount() )
+        {
+            m_poFeatureDefn->GetGeomFieldDefn(0)->SetSpatialRef(m_poSRS);
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Columns.                                                        */
+/* -------------------------------------------------------------------- */
+    const uint32_t nColumns = oHeader.GetTableVectorSize(Header::columns);
+    for( uint32_t i = 0; i < nColumns; i++ )
+    {
+        const Table oColumn = oHeader.GetTableVectorItem(Header::columns, i);
+        const GByte nType = oColumn.GetScalar<GByte>(Column::type, 0);
+        if( !oColumn.IsValid() ||
+            nType > static_cast<GByte>(ColumnType::Binary) )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Invalid column %u", i);
+            return false;
+        }
+        const ColumnType eType = static_cast<ColumnType>(nType);
+
+        OGRFieldType eFieldType = OFTString;
+        OGRFieldSubType eSubType = OFSTNone;
+        GetOGRFieldType(eType, eFieldType, eSubType);
+        OGRFieldDefn oField(oColumn.GetString(Column::name).c_str(),
+                            eFieldType);
+        oField.SetSubType(eSubType);
+        const int nWidth = oColumn.GetScalar<int32_t>(Column::width, -1);
+        if( nWidth > 0 )
+            oField.SetWidth(nWidth);
+        const int nPrecision =
+            oColumn.GetScalar<int32_t>(Column::precision, -1);
+        if( nPrecision > 0 )
+            oField.SetPrecision(nPrecision);
+        oField.SetNullable(oColumn.GetBool(Column::nullable, true));
+        m_poFeatureDefn->AddFieldDefn(&oField);
+        m_aeColumnTypes.push_back(eType);
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+OGRFlatGeobufLayer *OGRFlatGeobufLayer::Open( const char* pszFilename,
+                                              VSILFILE* fp )
+{
+    std::unique_ptr<OGRFlatGeobufLayer> poLayer(new OGRFlatGeobufLayer());
+    poLayer->m_osFilename = pszFilename;
+    poLayer->m_poFp = fp;
+
+    GByte abyMagic[nMagicBytesSize];
+    uint32_t nHeaderSize = 0;
+    if( VSIFSeekL(fp, 0, SEEK_SET) != 0 ||
+        VSIFReadL(abyMagic, nMagicBytesSize, 1, fp) != 1 ||
+        memcmp(abyMagic, abyMagicBytes, 4) != 0 ||
+        VSIFReadL(&nHeaderSize, sizeof(nHeaderSize), 1, fp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s is not a FlatGeobuf v3 file", pszFilename);
+        return nullptr;
+    }
+    CPL_LSBPTR32(&nHeaderSize);
+    if( nHeaderSize < sizeof(uint32_t) || nHeaderSize > nMaxHeaderSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Invalid header size: %u", nHeaderSize);
+        return nullptr;
+    }
+
+    std::vector<GByte> abyHeader;
+    try
+    {
+        abyHeader.resize(nHeaderSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate %u bytes for header", nHeaderSize);
+        return nullptr;
+    }
+    if( VSIFReadL(abyHeader.data(), nHeaderSize, 1, fp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read header");
+        return nullptr;
+    }
+
+    if( !poLayer->ReadHeader(abyHeader.data(), nHeaderSize) )
+        return nullptr;
+
+    poLayer->m_nIndexOffset = nMagicBytesSize + sizeof(uint32_t) + nHeaderSize;
+    uint64_t nIndexSize = 0;
+    if( poLayer->m_nIndexNodeSize > 0 && poLayer->m_nFeaturesCount > 0 )
+    {
+        // Each feature takes more than a node item of the index.
+        const vsi_l_offset nFileSize = poLayer->GetFileSize();
+        if( poLayer->m_nFeaturesCount > nFileSize / nNodeItemSize )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid features count: " CPL_FRMT_GUIB,
+                     static_cast<GUIntBig>(poLayer->m_nFeaturesCount));
+            return nullptr;
+        }
+        nIndexSize = PackedRTree::Size(poLayer->m_nFeaturesCount,
+                                       poLayer->m_nIndexNodeSize);
+        if( poLayer->m_nIndexOffset + nIndexSize > nFileSize )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Truncated index");
+            return nullptr;
+        }
+    }
+    else
+    {
+        poLayer->m_nIndexNodeSize = 0;
+    }
+    poLayer->m_nFeaturesOffset = poLayer->m_nIndexOffset + nIndexSize;
+
+    return poLayer.release();
+}
+
+/************************************************************************/
+/*                            GetFileSize()                             */
+/************************************************************************/
+
+vsi_l_offset OGRFlatGeobufLayer::GetFileSize()
+{
+    if( m_nFileSize == 0 && VSIFSeekL(m_poFp, 0, SEEK_END) == 0 )
+        m_nFileSize = VSIFTellL(m_poFp);
+    return m_nFileSize;
+}
+
+/************************************************************************/
+/*                            ResetReading()                            */
+/************************************************************************/
+
+void OGRFlatGeobufLayer::ResetReading()
+{
+    m_nFeatureIdx = 0;
+    m_nOffset = 0;
+    m_bIndexSearched = false;
+    m_aoFoundItems.clear();
+    m_iFoundItem = 0;
+    m_aoBatch.clear();
+    m_abyBatchBuf.clear();
+    m_iBatchItem = 0;
+}
+
+/************************************************************************/
+/*                      ReadNextSequentialRecord()                      */
+/*                                                                      */
+/*      Reads the size prefixed feature at m_nOffset into               */
+/*      m_abyFeatureBuf.                                                */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::ReadNextSequentialRecord()
+{
+    if( m_nFeaturesCount > 0 && m_nFeatureIdx >= m_nFeaturesCount )
+        return false;
+
+    uint32_t nSize = 0;
+    if( VSIFSeekL(m_poFp, m_nFeaturesOffset + m_nOffset, SEEK_SET) != 0 ||
+        VSIFReadL(&nSize, sizeof(nSize), 1, m_poFp) != 1 )
+    {
+        // End of a stream whose features count is unknown.
+        return false;
+    }
+    CPL_LSBPTR32(&nSize);
+    if( nSize > nMaxFeatureSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Invalid feature size: %u", nSize);
+        return false;
+    }
+
+    try
+    {
+        m_abyFeatureBuf.resize(sizeof(uint32_t) + nSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate %u bytes for feature", nSize);
+        return false;
+    }
+    memcpy(m_abyFeatureBuf.data(), &nSize, sizeof(nSize));
+    CPL_LSBPTR32(m_abyFeatureBuf.data());
+    if( nSize > 0 &&
+        VSIFReadL(m_abyFeatureBuf.data() + sizeof(uint32_t), nSize, 1,
+                  m_poFp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot read feature " CPL_FRMT_GUIB,
+                 static_cast<GUIntBig>(m_nFeatureIdx));
+        return false;
+    }
+
+    m_nOffset += sizeof(uint32_t) + nSize;
+    return true;
+}
+
+/************************************************************************/
+/*                           ReadNextBatch()                            */
+/*                                                                      */
+/*      Fetches the next features found with the spatial index.         */
+/*      Features that are contiguous in the file are merged in a        */
+/*      single range.                                                   */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::ReadNextBatch()
+{
+    m_aoBatch.clear();
+    m_iBatchItem = 0;
+
+    std::vector<size_t> anBufOffsets;
+    std::vector<vsi_l_offset> anOffsets;
+    std::vector<size_t> anSizes;
+    size_t nTotalSize = 0;
+    while( m_iFoundItem < m_aoFoundItems.size() &&
+           m_aoBatch.size() < MAX_BATCH_ITEMS )
+    {
+        const auto& oItem = m_aoFoundItems[m_iFoundItem];
+        const vsi_l_offset nOffset = m_nFeaturesOffset + oItem.nOffset;
+        uint64_t nSize = oItem.nSize;
+        if( nSize == 0 )
+        {
+            // Last feature of the file.
+            const vsi_l_offset nFileSize = GetFileSize();
+            nSize = nFileSize > nOffset ? nFileSize - nOffset : 0;
+        }
+        if( nSize < sizeof(uint32_t) ||
+            nSize > sizeof(uint32_t) + nMaxFeatureSize )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid size of feature " CPL_FRMT_GUIB,
+                     static_cast<GUIntBig>(oItem.nIndex));
+            return false;
+        }
+        if( !m_aoBatch.empty() && nTotalSize + nSize > MAX_BATCH_SIZE )
+            break;
+
+        if( !anOffsets.empty() && anOffsets.back() + anSizes.back() == nOffset )
+        {
+            anSizes.back() += static_cast<size_t>(nSize);
+        }
+        else
+        {
+            anBufOffsets.push_back(nTotalSize);
+            anOffsets.push_back(nOffset);
+            anSizes.push_back(static_cast<size_t>(nSize));
+        }
+        BatchItem oBatchItem;
+        oBatchItem.nIndex = oItem.nIndex;
+        oBatchItem.nBufOffset = nTotalSize;
+        oBatchItem.nSize = static_cast<size_t>(nSize);
+        m_aoBatch.push_back(oBatchItem);
+        nTotalSize += static_cast<size_t>(nSize);
+        m_iFoundItem++;
+    }
+    if( m_aoBatch.empty() )
+        return false;
+
+    std::vector<void*> apData;
+    try
+    {
+        m_abyBatchBuf.resize(nTotalSize);
+        for( const size_t nBufOffset: anBufOffsets )
+            apData.push_back(&m_abyBatchBuf[nBufOffset]);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate memory for features");
+        m_aoBatch.clear();
+        return false;
+    }
+
+    if( VSIFReadMultiRangeL(static_cast<int>(anOffsets.size()),
+                            apData.data(), anOffsets.data(), anSizes.data(),
+                            m_poFp) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read features");
+        m_aoBatch.clear();
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           ReadNextRecord()                           */
+/*                                                                      */
+/*      Next size prefixed feature, through the spatial index if there  */
+/*      is a spatial filter.                                            */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::ReadNextRecord( const GByte*& pabyRecord,
+                                         size_t& nRecordSize,
+                                         uint64_t& nIndex )
+{
+    if( m_poFp == nullptr || m_bCreate )
+        return false;
+
+    if( m_poFilterGeom != nullptr && m_nIndexNodeSize > 0 )
+    {
+        if( !m_bIndexSearched )
+        {
+            m_bIndexSearched = true;
+            NodeItem oFilter;
+            oFilter.dfMinX = m_sFilterEnvelope.MinX;
+            oFilter.dfMinY = m_sFilterEnvelope.MinY;
+            oFilter.dfMaxX = m_sFilterEnvelope.MaxX;
+            oFilter.dfMaxY = m_sFilterEnvelope.MaxY;
+            bool bError = false;
+            m_aoFoundItems = PackedRTree::StreamSearch(
+                m_nFeaturesCount, m_nIndexNodeSize, oFilter,
+                m_poFp, m_nIndexOffset, bError);
+            m_iFoundItem = 0;
+            if( bError )
+                return false;
+        }
+
+        if( m_iBatchItem >= m_aoBatch.size() && !ReadNextBatch() )
+            return false;
+        const BatchItem& oItem = m_aoBatch[m_iBatchItem++];
+        pabyRecord = &m_abyBatchBuf[oItem.nBufOffset];
+        nRecordSize = oItem.nSize;
+        nIndex = oItem.nIndex;
+        return true;
+    }
+
+    const uint64_t nFeatureIdx = m_nFeatureIdx;
+    if( !ReadNextSequentialRecord() )
+        return false;
+    m_nFeatureIdx++;
+    pabyRecord = m_abyFeatureBuf.data();
+    nRecordSize = m_abyFeatureBuf.size();
+    nIndex = nFeatureIdx;
+    return true;
+}
+
+/************************************************************************/
+/*                          GetFeatureTable()                           */
+/************************************************************************/
+
+static bool GetFeatureTable( const GByte* pabyRecord, size_t nRecordSize,
+                             uint64_t nIndex, Table& oFeature )
+{
+    if( nRecordSize >= sizeof(uint32_t) )
+    {
+        const uint32_t nSize = ReadValue<uint32_t>(pabyRecord);
+        if( nSize <= nRecordSize - sizeof(uint32_t) )
+            oFeature = Table::GetRoot(pabyRecord + sizeof(uint32_t), nSize);
+    }
+    if( !oFeature.IsValid() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Corrupted feature " CPL_FRMT_GUIB,
+                 static_cast<GUIntBig>(nIndex));
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          ParseProperties()                           */
+/*                                                                      */
+/*      Properties are a sequence of uint16 column index and little     */
+/*      endian value. Variable width values are prefixed by their       */
+/*      uint32 size.                                                    */
+/************************************************************************/
+
+template<class Visitor>
+bool OGRFlatGeobufLayer::ParseProperties( const GByte* pabyProperties,
+                                          uint32_t nSize, Visitor& oVisitor )
+{
+    const int nFields = m_poFeatureDefn->GetFieldCount();
+    uint32_t nPos = 0;
+    while( nPos < nSize )
+    {
+        if( nSize - nPos < sizeof(uint16_t) )
+            break;
+        const uint16_t iField = ReadValue<uint16_t>(pabyProperties + nPos);
+        nPos += sizeof(uint16_t);
+        if( iField >= nFields )
+            break;
+
+        const ColumnType eType = m_aeColumnTypes[iField];
+        const GByte* pabyValue = pabyProperties + nPos;
+        size_t nValueSize = 0;
+        switch( eType )
+        {
+            case ColumnType::Byte:
+            case ColumnType::UByte:
+            case ColumnType::Bool:
+                nValueSize = 1;
+                break;
+            case ColumnType::Short:
+            case ColumnType::UShort:
+                nValueSize = 2;
+                break;
+            case ColumnType::Int:
+            case ColumnType::UInt:
+            case ColumnType::Float:
+                nValueSize = 4;
+                break;
+            case ColumnType::Long:
+            case ColumnType::ULong:
+            case ColumnType::Double:
+                nValueSize = 8;
+                break;
+            case ColumnType::String:
+            case ColumnType::Json:
+            case ColumnType::DateTime:
+            case ColumnType::Binary:
+                if( nSize - nPos < sizeof(uint32_t) )
+                    break;
+                nValueSize = sizeof(uint32_t) +
+                    static_cast<size_t>(ReadValue<uint32_t>(pabyValue));
+                break;
+        }
+        if( nValueSize == 0 || nValueSize > nSize - nPos )
+            break;
+        nPos += static_cast<uint32_t>(nValueSize);
+
+        if( m_poFeatureDefn->GetFieldDefn(iField)->IsIgnored() )
+            continue;
+
+        switch( eType )
+        {
+            case ColumnType::Byte:
+                oVisitor.SetInteger(iField, static_cast<signed char>(
+                                                    pabyValue[0]));
+                break;
+            case ColumnType::UByte:
+                oVisitor.SetInteger(iField, pabyValue[0]);
+                break;
+            case ColumnType::Bool:
+                oVisitor.SetInteger(iField, pabyValue[0] != 0);
+                break;
+            case ColumnType::Short:
+                oVisitor.SetInteger(iField, ReadValue<int16_t>(pabyValue));
+                break;
+            case ColumnType::UShort:
+                oVisitor.SetInteger(iField, ReadValue<uint16_t>(pabyValue));
+                break;
+            case ColumnType::Int:
+                oVisitor.SetInteger(iField, ReadValue<int32_t>(pabyValue));
+                break;
+            case ColumnType::UInt:
+                oVisitor.SetInteger64(iField, ReadValue<uint32_t>(pabyValue));
+                break;
+            case ColumnType::Long:
+                oVisitor.SetInteger64(iField, ReadValue<int64_t>(pabyValue));
+                break;
+            case ColumnType::ULong:
+                oVisitor.SetReal(iField, static_cast<double>(
+                                        ReadValue<uint64_t>(pabyValue)));
+                break;
+            case ColumnType::Float:
+                oVisitor.SetReal(iField, ReadValue<float>(pabyValue));
+                break;
+            case ColumnType::Double:
+                oVisitor.SetReal(iField, ReadValue<double>(pabyValue));
+                break;
+            case ColumnType::String:
+            case ColumnType::Json:
+                oVisitor.SetString(iField, reinterpret_cast<const char*>(
+                                        pabyValue + sizeof(uint32_t)),
+                                   nValueSize - sizeof(uint32_t));
+                break;
+            case ColumnType::DateTime:
+                oVisitor.SetDateTime(iField, reinterpret_cast<const char*>(
+                                        pabyValue + sizeof(uint32_t)),
+                                     nValueSize - sizeof(uint32_t));
+                break;
+            case ColumnType::Binary:
+                oVisitor.SetBinary(iField, pabyValue + sizeof(uint32_t),
+                                   nValueSize - sizeof(uint32_t));
+                break;
+        }
+    }
+
+    if( nPos != nSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Corrupted feature properties");
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           FeatureVisitor                             */
+/************************************************************************/
+
+namespace {
+
+struct FeatureVisitor
+{
+    OGRFeature* m_poFeature;
+
+    void SetInteger( int iField, int nVal )
+        { m_poFeature->SetField(iField, nVal); }
+    void SetInteger64( int iField, GIntBig nVal )
+        { m_poFeature->SetField(iField, nVal); }
+    void SetReal( int iField, double dfVal )
+        { m_poFeature->SetField(iField, dfVal); }
+    void SetString( int iField, const char* pszVal, size_t nLen )
+        { m_poFeature->SetField(iField, std::string(pszVal, nLen).c_str()); }
+    void SetDateTime( int iField, const char* pszVal, size_t nLen )
+        { SetString(iField, pszVal, nLen); }
+    void SetBinary( int iField, const GByte* pabyData, size_t nLen )
+        { m_poFeature->SetField(iField, static_cast<int>(nLen), pabyData); }
+};
+
+/************************************************************************/
+/*                            ArrowVisitor                              */
+/************************************************************************/
+
+struct ArrowVisitor
+{
+    OGRArrowArrayBuilder& m_oBuilder;
+
+    void SetInteger( int iField, int nVal )
+        { m_oBuilder.SetInteger(iField, nVal); }
+    void SetInteger64( int iField, GIntBig nVal )
+        { m_oBuilder.SetInteger64(iField, nVal); }
+    void SetReal( int iField, double dfVal )
+        { m_oBuilder.SetReal(iField, dfVal); }
+    void SetString( int iField, const char* pszVal, size_t nLen )
+        { m_oBuilder.SetString(iField, pszVal, nLen); }
+    void SetDateTime( int iField, const char* pszVal, size_t nLen )
+    {
+        OGRField sField;
+        if( OGRParseDate(std::string(pszVal, nLen).c_str(), &sField, 0) )
+            m_oBuilder.SetField(iField, &sField);
+    }
+    void SetBinary( int iField, const GByte* pabyData, size_t nLen )
+        { m_oBuilder.SetBinary(iField, pabyData, nLen); }
+};
+
+} // namespace
+
+/************************************************************************/
+/*                            ParseFeature()                            */
+/************************************************************************/
+
+OGRFeature *OGRFlatGeobufLayer::ParseFeature( const GByte* pabyRecord,
+                                              size_t nRecordSize,
+                                              uint64_t nIndex )
+{
+    Table oFeature;
+    if( !GetFeatureTable(pabyRecord, nRecordSize, nIndex, oFeature) )
+        return nullptr;
+
+    std::unique_ptr<OGRFeature> poFeature(new OGRFeature(m_poFeatureDefn));
+    poFeature->SetFID(static_cast<GIntBig>(nIndex));
+
+    if( m_poFeatureDefn->GetGeomFieldCount() &&
+        !m_poFeatureDefn->IsGeometryIgnored() )
+    {
+        const Table oGeometry = oFeature.GetTable(Feature::geometry);
+        if( oGeometry.IsValid() )
+        {
+            OGRGeometry* poGeom = OGRFlatGeobufReadGeometry(
+                oGeometry, m_eGeomType, m_bHasZ, m_bHasM);
+            if( poGeom == nullptr )
+                return nullptr;
+            poGeom->assignSpatialReference(m_poSRS);
+            poFeature->SetGeometryDirectly(poGeom);
+        }
+    }
+
+    uint32_t nPropertiesSize = 0;
+    const GByte* pabyProperties =
+        oFeature.GetVector(Feature::properties, 1, nPropertiesSize);
+    FeatureVisitor oVisitor{ poFeature.get() };
+    if( pabyProperties &&
+        !ParseProperties(pabyProperties, nPropertiesSize, oVisitor) )
+        return nullptr;
+
+    return poFeature.release();
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature *OGRFlatGeobufLayer::GetNextFeature()
+{
+    while( true )
+    {
+        const GByte* pabyRecord = nullptr;
+        size_t nRecordSize = 0;
+        uint64_t nIndex = 0;
+        if( !ReadNextRecord(pabyRecord, nRecordSize, nIndex) )
+            return nullptr;
+
+        OGRFeature* poFeature = ParseFeature(pabyRecord, nRecordSize, nIndex);
+        if( poFeature == nullptr )
+            return nullptr;
+
+        if( (m_poFilterGeom == nullptr ||
+             FilterGeometry(poFeature->GetGeometryRef())) &&
+            (m_poAttrQuery == nullptr ||
+             m_poAttrQuery->Evaluate(poFeature)) )
+        {
+            return poFeature;
+        }
+        delete poFeature;
+    }
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/*                                                                      */
+/*      The leaves of the index are in feature order, and give the      */
+/*      offset of any feature.                                          */
+/************************************************************************/
+
+OGRFeature *OGRFlatGeobufLayer::GetFeature( GIntBig nFID )
+{
+    if( m_poFp == nullptr || m_bCreate )
+        return nullptr;
+    if( m_nIndexNodeSize == 0 )
+        return OGRLayer::GetFeature(nFID);
+    if( nFID < 0 || static_cast<uint64_t>(nFID) >= m_nFeaturesCount )
+        return nullptr;
+
+    const auto aoLevelBounds =
+        PackedRTree::GenerateLevelBounds(m_nFeaturesCount, m_nIndexNodeSize);
+    const uint64_t nPos = aoLevelBounds.front().first + nFID;
+    const size_t nItems = nPos + 1 < aoLevelBounds.front().second ? 2 : 1;
+
+    GByte abyItems[2 * nNodeItemSize];
+    if( VSIFSeekL(m_poFp, m_nIndexOffset + nPos * nNodeItemSize,
+                  SEEK_SET) != 0 ||
+        VSIFReadL(abyItems, nNodeItemSize, nItems, m_poFp) != nItems )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read spatial index");
+        return nullptr;
+    }
+
+    const uint64_t nOffset = ReadValue<uint64_t>(abyItems + 32);
+    const uint64_t nEnd =
+        nItems == 2 ? ReadValue<uint64_t>(abyItems + nNodeItemSize + 32) :
+                      GetFileSize() - m_nFeaturesOffset;
+    if( nEnd <= nOffset + sizeof(uint32_t) ||
+        nEnd - nOffset > sizeof(uint32_t) + nMaxFeatureSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Invalid size of feature " CPL_FRMT_GIB, nFID);
+        return nullptr;
+    }
+
+    const size_t nSize = static_cast<size_t>(nEnd - nOffset);
+    try
+    {
+        m_abyFeatureBuf.resize(nSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate memory for feature");
+        return nullptr;
+    }
+    if( VSIFSeekL(m_poFp, m_nFeaturesOffset + nOffset, SEEK_SET) != 0 ||
+        VSIFReadL(m_abyFeatureBuf.data(), nSize, 1, m_poFp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot read feature " CPL_FRMT_GIB, nFID);
+        return nullptr;
+    }
+
+    return ParseFeature(m_abyFeatureBuf.data(), nSize, nFID);
+}
+
+/************************************************************************/
+/*                         GetNextArrowArray()                          */
+/*                                                                      */
+/*      Decodes the properties of the features straight into the        */
+/*      columns of the batch, without building an OGRFeature.           */
+/************************************************************************/
+
+int OGRFlatGeobufLayer::GetNextArrowArray( struct ArrowArrayStream* stream,
+                                           struct ArrowArray* out_array )
+{
+    // Filters need the full feature to be evaluated.
+    if( m_poFp == nullptr || m_bCreate ||
+        m_poAttrQuery != nullptr || m_poFilterGeom != nullptr )
+        return OGRLayer::GetNextArrowArray(stream, out_array);
+
+    memset(out_array, 0, sizeof(*out_array));
+    CSLConstList papszOptions = m_aosArrowArrayStreamOptions.List();
+    const int nMaxBatchSize =
+        OGRArrowArrayBuilder::GetMaxFeaturesInBatch(papszOptions);
+    const bool bReadGeometry = m_poFeatureDefn->GetGeomFieldCount() &&
+                               !m_poFeatureDefn->IsGeometryIgnored();
+
+    try
+    {
+        OGRArrowArrayBuilder oBuilder(
+            m_poFeatureDefn, OGRArrowArrayBuilder::IncludeFID(papszOptions));
+        ArrowVisitor oVisitor{ oBuilder };
+        while( oBuilder.GetRowCount() < nMaxBatchSize )
+        {
+            const GByte* pabyRecord = nullptr;
+            size_t nRecordSize = 0;
+            uint64_t nIndex = 0;
+            if( !ReadNextRecord(pabyRecord, nRecordSize, nIndex) )
+            {
+                m_bArrowArrayStreamEOF = true;
+                break;
+            }
+
+            Table oFeature;
+            if( !GetFeatureTable(pabyRecord, nRecordSize, nIndex, oFeature) )
+                return EIO;
+
+            oBuilder.SetFID(static_cast<GIntBig>(nIndex));
+
+            if( bReadGeometry )
+            {
+                const Table oGeometry = oFeature.GetTable(Feature::geometry);
+                if( oGeometry.IsValid() )
+                {
+                    std::unique_ptr<OGRGeometry> poGeom(
+                        OGRFlatGeobufReadGeometry(oGeometry, m_eGeomType,
+                                                  m_bHasZ, m_bHasM));
+                    if( !poGeom )
+                        return EIO;
+                    oBuilder.SetGeometry(0, poGeom.get());
+                }
+            }
+
+            uint32_t nPropertiesSize = 0;
+            const GByte* pabyProperties =
+                oFeature.GetVector(Feature::properties, 1, nPropertiesSize);
+            if( pabyProperties &&
+                !ParseProperties(pabyProperties, nPropertiesSize, oVisitor) )
+                return EIO;
+
+            oBuilder.EndRow();
+        }
+
+        if( oBuilder.GetRowCount() == 0 )
+            return 0;
+        return oBuilder.Finish(out_array) ? 0 : EOVERFLOW;
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory in GetNextArrowArray()");
+        return ENOMEM;
+    }
+}
+
+/************************************************************************/
+/*                          GetFeatureCount()                           */
+/************************************************************************/
+
+GIntBig OGRFlatGeobufLayer::GetFeatureCount( int bForce )
+{
+    if( !m_bCreate && m_poFilterGeom == nullptr &&
+        m_poAttrQuery == nullptr && m_nFeaturesCount > 0 )
+        return static_cast<GIntBig>(m_nFeaturesCount);
+    if( m_bCreate )
+        return static_cast<GIntBig>(m_nFeaturesCount);
+    return OGRLayer::GetFeatureCount(bForce);
+}
+
+/************************************************************************/
+/*                             GetExtent()                              */
+/************************************************************************/
+
+OGRErr OGRFlatGeobufLayer::GetExtent( OGREnvelope *psExtent, int bForce )
+{
+    if( m_bCreate )
+    {
+        if( !m_sExtent.IsInit() )
+            return OGRERR_FAILURE;
+        *psExtent = m_sExtent;
+        return OGRERR_NONE;
+    }
+    if( m_bHasExtent )
+    {
+        *psExtent = m_sExtent;
+        return OGRERR_NONE;
+    }
+    return OGRLayer::GetExtent(psExtent, bForce);
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRFlatGeobufLayer::TestCapability( const char *pszCap )
+{
+    if( EQUAL(pszCap, OLCFastFeatureCount) )
+        return m_poFilterGeom == nullptr && m_poAttrQuery == nullptr &&
+               (m_bCreate || m_nFeaturesCount > 0);
+    if( EQUAL(pszCap, OLCFastGetExtent) )
+        return m_bCreate || m_bHasExtent;
+    if( EQUAL(pszCap, OLCFastSpatialFilter) || EQUAL(pszCap, OLCRandomRead) )
+        return !m_bCreate && m_nIndexNodeSize > 0;
+    if( EQUAL(pszCap, OLCCreateField) )
+        return m_bCreate && m_nFeaturesCount == 0;
+    if( EQUAL(pszCap, OLCSequentialWrite) )
+        return m_bCreate;
+    if( EQUAL(pszCap, OLCStringsAsUTF8) )
+        return TRUE;
+    return FALSE;
+}
+
+/* ==================================================================== */
+/*                               Writing                                */
+/* ==================================================================== */
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+OGRFlatGeobufLayer *OGRFlatGeobufLayer::Create( const char* pszFilename,
+                                                const char* pszLayerName,
+                                                OGRSpatialReference* poSRS,
+                                                OGRwkbGeometryType eGType,
+                                                CSLConstList papszOptions )
+{
+    const GeometryType eGeomType = OGRFlatGeobufGetGeometryType(eGType);
+    if( eGeomType == GeometryType::Unknown && eGType != wkbNone &&
+        wkbFlatten(eGType) != wkbUnknown )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Unsupported geometry type %s",
+                 OGRGeometryTypeToName(eGType));
+        return nullptr;
+    }
+
+    const int nNodeSize = atoi(CSLFetchNameValueDef(
+        papszOptions, "INDEX_NODE_SIZE", CPLSPrintf("%d", nDefaultNodeSize)));
+    if( nNodeSize < 2 || nNodeSize > 65535 )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "Invalid value for INDEX_NODE_SIZE: %d", nNodeSize);
+        return nullptr;
+    }
+
+    std::unique_ptr<OGRFlatGeobufLayer> poLayer(new OGRFlatGeobufLayer());
+    poLayer->m_osFilename = pszFilename;
+    poLayer->m_eGeomType = eGeomType;
+    poLayer->m_bHasZ = CPL_TO_BOOL(wkbHasZ(eGType));
+    poLayer->m_bHasM = CPL_TO_BOOL(wkbHasM(eGType));
+    poLayer->m_bWriteIndex = eGType != wkbNone &&
+        CPLFetchBool(papszOptions, "SPATIAL_INDEX", true);
+    poLayer->m_nIndexNodeSize =
+        poLayer->m_bWriteIndex ? static_cast<uint16_t>(nNodeSize) : 0;
+
+    poLayer->m_poFeatureDefn = new OGRFeatureDefn(pszLayerName);
+    poLayer->SetDescription(pszLayerName);
+    poLayer->m_poFeatureDefn->Reference();
+    poLayer->m_poFeatureDefn->SetGeomType(eGType);
+    if( poSRS && eGType != wkbNone )
+    {
+        poLayer->m_poSRS = poSRS->Clone();
+        poLayer->m_poSRS->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+        poLayer->m_poFeatureDefn->GetGeomFieldDefn(0)->SetSpatialRef(
+            poLayer->m_poSRS);
+    }
+
+    poLayer->m_poFpWrite = VSIFOpenL(pszFilename, "wb");
+    if( poLayer->m_poFpWrite == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_OpenFailed,
+                 "Cannot create %s", pszFilename);
+        return nullptr;
+    }
+
+    // With a spatial index, features are written to a temporary file and
+    // copied in Hilbert order when the layer is closed.
+    if( poLayer->m_bWriteIndex )
+    {
+        if( STARTS_WITH(pszFilename, "/vsi") &&
+            !STARTS_WITH(pszFilename, "/vsimem/") )
+            poLayer->m_osTempFilename = CPLGenerateTempFilename("fgb_tmp");
+        else
+            poLayer->m_osTempFilename = CPLString(pszFilename) + "_tmp";
+        poLayer->m_poFp = VSIFOpenL(poLayer->m_osTempFilename.c_str(), "w+b");
+        if( poLayer->m_poFp == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_OpenFailed,
+                     "Cannot create %s", poLayer->m_osTempFilename.c_str());
+            return nullptr;
+        }
+    }
+
+    poLayer->m_bCreate = true;
+    return poLayer.release();
+}
+
+/************************************************************************/
+/*                            CreateField()                             */
+/************************************************************************/
+
+OGRErr OGRFlatGeobufLayer::CreateField( OGRFieldDefn *poField, int bApproxOK )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateField() not supported on read-only layer");
+        return OGRERR_FAILURE;
+    }
+    if( m_nFeaturesCount > 0 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateField() not supported after features have been "
+                 "written");
+        return OGRERR_FAILURE;
+    }
+    if( m_poFeatureDefn->GetFieldCount() >=
+                            std::numeric_limits<uint16_t>::max() )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported, "Too many fields");
+        return OGRERR_FAILURE;
+    }
+
+    OGRFieldDefn oField(poField);
+    ColumnType eType = ColumnType::String;
+    switch( oField.GetType() )
+    {
+        case OFTInteger:
+            eType = oField.GetSubType() == OFSTBoolean ? ColumnType::Bool :
+                    oField.GetSubType() == OFSTInt16 ? ColumnType::Short :
+                                                       ColumnType::Int;
+            break;
+        case OFTInteger64:
+            eType = ColumnType::Long;
+            break;
+        case OFTReal:
+            eType = oField.GetSubType() == OFSTFloat32 ? ColumnType::Float :
+                                                         ColumnType::Double;
+            break;
+        case OFTString:
+            eType = oField.GetSubType() == OFSTJSON ? ColumnType::Json :
+                                                      ColumnType::String;
+            break;
+        case OFTDate:
+        case OFTTime:
+        case OFTDateTime:
+            eType = ColumnType::DateTime;
+            break;
+        case OFTBinary:
+            eType = ColumnType::Binary;
+            break;
+        default:
+            if( !bApproxOK )
+            {
+                CPLError(CE_Failure, CPLE_NotSupported,
+                         "Field %s of type %s not supported",
+                         oField.GetNameRef(),
+                         OGRFieldDefn::GetFieldTypeName(oField.GetType()));
+                return OGRERR_FAILURE;
+            }
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "Field %s of type %s converted to String",
+                     oField.GetNameRef(),
+                     OGRFieldDefn::GetFieldTypeName(oField.GetType()));
+            oField.SetType(OFTString);
+            oField.SetSubType(OFSTNone);
+            break;
+    }
+
+    m_poFeatureDefn->AddFieldDefn(&oField);
+    m_aeColumnTypes.push_back(eType);
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            WriteHeader()                             */
+/*                                                                      */
+/*      The features count is always written, so that the header size   */
+/*      does not change when it is rewritten with the final values.     */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::WriteHeader( VSILFILE* fp, uint64_t nFeaturesCount,
+                                      const OGREnvelope& sExtent )
+{
+    Builder oBuilder;
+
+    std::vector<uint32_t> anColumns;
+    for( int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++ )
+    {
+        const OGRFieldDefn* poFieldDefn = m_poFeatureDefn->GetFieldDefn(i);
+        const uint32_t nName =
+            oBuilder.CreateString(std::string(poFieldDefn->GetNameRef()));
+        oBuilder.StartTable();
+        oBuilder.AddOffset(Column::name, nName);
+        oBuilder.AddScalar<GByte>(Column::type,
+                                  static_cast<GByte>(m_aeColumnTypes[i]), 0);
+        if( poFieldDefn->GetWidth() > 0 )
+            oBuilder.AddScalar<int32_t>(Column::width,
+                                        poFieldDefn->GetWidth(), -1);
+        if( poFieldDefn->GetPrecision() > 0 )
+            oBuilder.AddScalar<int32_t>(Column::precision,
+                                        poFieldDefn->GetPrecision(), -1);
+        oBuilder.AddBool(Column::nullable,
+                         CPL_TO_BOOL(poFieldDefn->IsNullable()), true);
+        anColumns.push_back(oBuilder.EndTable());
+    }
+    const uint32_t nColumns =
+        anColumns.empty() ? 0 : oBuilder.CreateTableVector(anColumns);
+
+    uint32_t nEnvelope = 0;
+    if( m_poFeatureDefn->GetGeomFieldCount() )
+    {
+        const double dfNaN = std::numeric_limits<double>::quiet_NaN();
+        std::vector<double> adfEnvelope{ dfNaN, dfNaN, dfNaN, dfNaN };
+        if( sExtent.IsInit() )
+            adfEnvelope = { sExtent.MinX, sExtent.MinY,
+                            sExtent.MaxX, sExtent.MaxY };
+        for( auto& dfVal: adfEnvelope )
+            SwapToLSB(&dfVal);
+        nEnvelope = oBuilder.CreateVector(adfEnvelope);
+    }
+
+    uint32_t nCrs = 0;
+    if( m_poSRS )
+    {
+        const char* pszAuthName = m_poSRS->GetAuthorityName(nullptr);
+        const char* pszAuthCode = m_poSRS->GetAuthorityCode(nullptr);
+        int nCode = 0;
+        uint32_t nOrg = 0;
+        uint32_t nWKT = 0;
+        if( pszAuthName && pszAuthCode && EQUAL(pszAuthName, "EPSG") &&
+            atoi(pszAuthCode) > 0 )
+        {
+            nCode = atoi(pszAuthCode);
+            nOrg = oBuilder.CreateString(std::string("EPSG"));
+        }
+        else
+        {
+            char* pszWKT = nullptr;
+            const char* const apszOptions[] = { "FORMAT=WKT2_2018", nullptr };
+            if( m_poSRS->exportToWkt(&pszWKT, apszOptions) == OGRERR_NONE &&
+                pszWKT )
+                nWKT = oBuilder.CreateString(pszWKT, strlen(pszWKT));
+            CPLFree(pszWKT);
+        }
+        oBuilder.StartTable();
+        oBuilder.AddOffset(Crs::org, nOrg);
+        oBuilder.AddScalar<int32_t>(Crs::code, nCode, 0);
+        oBuilder.AddOffset(Crs::wkt, nWKT);
+        nCrs = oBuilder.EndTable();
+    }
+
+    const uint32_t nName =
+        oBuilder.CreateString(std::string(m_poFeatureDefn->GetName()));
+
+    oBuilder.StartTable();
+    oBuilder.AddOffset(Header::name, nName);
+    oBuilder.AddOffset(Header::envelope, nEnvelope);
+    oBuilder.AddScalar<GByte>(Header::geometry_type,
+                              static_cast<GByte>(m_eGeomType), 0);
+    oBuilder.AddBool(Header::has_z, m_bHasZ, false);
+    oBuilder.AddBool(Header::has_m, m_bHasM, false);
+    oBuilder.AddOffset(Header::columns, nColumns);
+    oBuilder.AddScalar<uint64_t>(Header::features_count, nFeaturesCount, 0,
+                                 true);
+    oBuilder.AddScalar<uint16_t>(Header::index_node_size, m_nIndexNodeSize,
+                                 nDefaultNodeSize);
+    oBuilder.AddOffset(Header::crs, nCrs);
+    size_t nSize = 0;
+    const GByte* pabyHeader = oBuilder.Finish(oBuilder.EndTable(), nSize);
+
+    if( m_nHeaderSize != 0 && nSize != m_nHeaderSize )
+    {
+        CPLDebug("FlatGeobuf", "Header size changed: cannot rewrite it");
+        return false;
+    }
+    if( VSIFWriteL(abyMagicBytes, nMagicBytesSize, 1, fp) != 1 ||
+        VSIFWriteL(pabyHeader, nSize, 1, fp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot write header");
+        return false;
+    }
+    m_nHeaderSize = static_cast<uint32_t>(nSize);
+    return true;
+}
+
+/************************************************************************/
+/*                          WriteProperties()                           */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::WriteProperties( const OGRFeature* poFeature )
+{
+    m_abyProperties.clear();
+    for( int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( !poFeature->IsFieldSetAndNotNull(i) )
+            continue;
+
+        AppendValue(m_abyProperties, static_cast<uint16_t>(i));
+        const OGRField* psField = poFeature->GetRawFieldRef(i);
+        switch( m_aeColumnTypes[i] )
+        {
+            case ColumnType::Bool:
+                m_abyProperties.push_back(psField->Integer != 0 ? 1 : 0);
+                break;
+            case ColumnType::Short:
+                AppendValue(m_abyProperties,
+                            static_cast<int16_t>(psField->Integer));
+                break;
+            case ColumnType::Int:
+                AppendValue(m_abyProperties,
+                            static_cast<int32_t>(psField->Integer));
+                break;
+            case ColumnType::Long:
+                AppendValue(m_abyProperties,
+                            static_cast<int64_t>(psField->Integer64));
+                break;
+            case ColumnType::Float:
+                AppendValue(m_abyProperties,
+                            static_cast<float>(psField->Real));
+                break;
+            case ColumnType::Double:
+                AppendValue(m_abyProperties, psField->Real);
+                break;
+            case ColumnType::DateTime:
+            {
+                const OGRFieldType eType =
+                    m_poFeatureDefn->GetFieldDefn(i)->GetType();
+                std::string osVal;
+                if( eType == OFTDate )
+                {
+                    osVal = CPLSPrintf("%04d-%02d-%02d",
+                                       psField->Date.Year,
+                                       psField->Date.Month,
+                                       psField->Date.Day);
+                }
+                else if( eType == OFTTime )
+                {
+                    osVal = poFeature->GetFieldAsString(i);
+                }
+                else
+                {
+                    char* pszVal = OGRGetXMLDateTime(psField);
+                    osVal = pszVal;
+                    CPLFree(pszVal);
+                }
+                AppendBytes(m_abyProperties, osVal.c_str(), osVal.size());
+                break;
+            }
+            case ColumnType::Binary:
+            {
+                int nBytes = 0;
+                const GByte* pabyData =
+                    const_cast<OGRFeature*>(poFeature)->GetFieldAsBinary(
+                        i, &nBytes);
+                AppendBytes(m_abyProperties, pabyData, nBytes);
+                break;
+            }
+            default:
+            {
+                const char* pszVal =
+                    const_cast<OGRFeature*>(poFeature)->GetFieldAsString(i);
+                AppendBytes(m_abyProperties, pszVal, strlen(pszVal));
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                           ICreateFeature()                           */
+/************************************************************************/
+
+OGRErr OGRFlatGeobufLayer::ICreateFeature( OGRFeature *poFeature )
+{
+    if( !m_bCreate )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateFeature() not supported on read-only layer");
+        return OGRERR_FAILURE;
+    }
+    if( m_bWriteError )
+        return OGRERR_FAILURE;
+
+    // Streaming: the header is written before the first feature, and
+    // patched with the final count and extent when possible.
+    if( !m_bWriteIndex && !m_bHeaderWritten )
+    {
+        m_bHeaderWritten = true;
+        if( !WriteHeader(m_poFpWrite, 0, OGREnvelope()) )
+        {
+            m_bWriteError = true;
+            return OGRERR_FAILURE;
+        }
+    }
+
+    m_oBuilder.Clear();
+
+    NodeItem oBounds;
+    uint32_t nGeometry = 0;
+    const OGRGeometry* poGeom = poFeature->GetGeometryRef();
+    if( poGeom != nullptr )
+    {
+        if( m_eGeomType != GeometryType::Unknown &&
+            OGRFlatGeobufGetGeometryType(poGeom->getGeometryType()) !=
+                                                                m_eGeomType )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot write geometry of type %s in a layer of type %s",
+                     OGRGeometryTypeToName(poGeom->getGeometryType()),
+                     OGRGeometryTypeToName(m_poFeatureDefn->GetGeomType()));
+            return OGRERR_FAILURE;
+        }
+        nGeometry = OGRFlatGeobufWriteGeometry(
+            m_oBuilder, poGeom, m_eGeomType == GeometryType::Unknown,
+            m_bHasZ, m_bHasM);
+        if( nGeometry == 0 )
+            return OGRERR_FAILURE;
+
+        if( !poGeom->IsEmpty() )
+        {
+            OGREnvelope sEnvelope;
+            poGeom->getEnvelope(&sEnvelope);
+            oBounds.dfMinX = sEnvelope.MinX;
+            oBounds.dfMinY = sEnvelope.MinY;
+            oBounds.dfMaxX = sEnvelope.MaxX;
+            oBounds.dfMaxY = sEnvelope.MaxY;
+            m_sExtent.Merge(sEnvelope);
+        }
+    }
+
+    if( !WriteProperties(poFeature) )
+        return OGRERR_FAILURE;
+    const uint32_t nProperties = m_abyProperties.empty() ? 0 :
+        m_oBuilder.CreateVector(m_abyProperties.data(),
+                                m_abyProperties.size(), 1);
+
+    m_oBuilder.StartTable();
+    m_oBuilder.AddOffset(Feature::geometry, nGeometry);
+    m_oBuilder.AddOffset(Feature::properties, nProperties);
+    size_t nSize = 0;
+    const GByte* pabyFeature =
+        m_oBuilder.Finish(m_oBuilder.EndTable(), nSize);
+    if( nSize > sizeof(uint32_t) + nMaxFeatureSize )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported, "Feature too large");
+        return OGRERR_FAILURE;
+    }
+
+    VSILFILE* fp = m_bWriteIndex ? m_poFp : m_poFpWrite;
+    if( VSIFWriteL(pabyFeature, nSize, 1, fp) != 1 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot write feature");
+        m_bWriteError = true;
+        return OGRERR_FAILURE;
+    }
+
+    if( m_bWriteIndex )
+    {
+        FeatureItem oItem;
+        oItem.oBounds = oBounds;
+        oItem.nOffset = m_nWriteOffset;
+        oItem.nSize = static_cast<uint32_t>(nSize);
+        m_aoItems.push_back(oItem);
+    }
+    else
+    {
+        // Features are not reordered, so their index is known.
+        poFeature->SetFID(static_cast<GIntBig>(m_nFeaturesCount));
+    }
+    m_nWriteOffset += nSize;
+    m_nFeaturesCount++;
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                              Finalize()                              */
+/************************************************************************/
+
+bool OGRFlatGeobufLayer::Finalize()
+{
+    m_bCreate = false;
+    bool bOK = !m_bWriteError;
+
+    if( !m_bWriteIndex )
+    {
+        if( !m_bHeaderWritten )
+        {
+            bOK &= WriteHeader(m_poFpWrite, m_nFeaturesCount, m_sExtent);
+        }
+        else if( bOK && !STARTS_WITH(m_osFilename.c_str(), "/vsistdout/") &&
+                 VSIFSeekL(m_poFpWrite, 0, SEEK_SET) == 0 )
+        {
+            // Not fatal: readers then read up to the end of the file.
+            WriteHeader(m_poFpWrite, m_nFeaturesCount, m_sExtent);
+        }
+    }
+    else
+    {
+/* -------------------------------------------------------------------- */
+/*      Sort the features along the Hilbert curve, build the index      */
+/*      and copy the features in that order after it.                   */
+/* -------------------------------------------------------------------- */
+        NodeItem oExtent;
+        for( const auto& oItem: m_aoItems )
+            oExtent.Expand(oItem.oBounds);
+
+        std::vector<uint32_t> anHilbertValues;
+        std::vector<size_t> anOrder;
+        anHilbertValues.reserve(m_aoItems.size());
+        anOrder.reserve(m_aoItems.size());
+        for( size_t i = 0; i < m_aoItems.size(); i++ )
+        {
+            anHilbertValues.push_back(
+                HilbertValue(m_aoItems[i].oBounds, oExtent));
+            anOrder.push_back(i);
+        }
+        std::stable_sort(anOrder.begin(), anOrder.end(),
+                         [&anHilbertValues](size_t a, size_t b)
+                         { return anHilbertValues[a] > anHilbertValues[b]; });
+
+        std::vector<NodeItem> aoLeaves;
+        aoLeaves.reserve(m_aoItems.size());
+        uint64_t nOffset = 0;
+        for( const size_t i: anOrder )
+        {
+            NodeItem oLeaf = m_aoItems[i].oBounds;
+            oLeaf.nOffset = nOffset;
+            aoLeaves.push_back(oLeaf);
+            nOffset += m_aoItems[i].nSize;
+        }
+
+        bOK = bOK && WriteHeader(m_poFpWrite, m_nFeaturesCount, m_sExtent);
+        if( bOK && !aoLeaves.empty() )
+        {
+            const PackedRTree oTree(aoLeaves, m_nIndexNodeSize);
+            aoLeaves.clear();
+            if( !oTree.Write(m_poFpWrite) )
+            {
+                CPLError(CE_Failure, CPLE_FileIO,
+                         "Cannot write spatial index");
+                bOK = false;
+            }
+        }
+
+        std::vector<GByte> abyBuf;
+        for( size_t j = 0; bOK && j < anOrder.size(); j++ )
+        {
+            const FeatureItem& oItem = m_aoItems[anOrder[j]];
+            abyBuf.resize(oItem.nSize);
+            if( VSIFSeekL(m_poFp, oItem.nOffset, SEEK_SET) != 0 ||
+                VSIFReadL(abyBuf.data(), oItem.nSize, 1, m_poFp) != 1 ||
+                VSIFWriteL(abyBuf.data(), oItem.nSize, 1, m_poFpWrite) != 1 )
+            {
+                CPLError(CE_Failure, CPLE_FileIO, "Cannot copy features");
+                bOK = false;
+            }
+        }
+
+        VSIFCloseL(m_poFp);
+        m_poFp = nullptr;
+        VSIUnlink(m_osTempFilename.c_str());
+        m_aoItems.clear();
+    }
+
+    if( VSIFCloseL(m_poFpWrite) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Error while closing %s",
+                 m_osFilename.c_str());
+        bOK = false;
+    }
+    m_poFpWrite = nullptr;
+    return bOK;
+}
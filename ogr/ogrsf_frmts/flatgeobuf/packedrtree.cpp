@@ -0,0 +1,425 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Packed Hilbert R-tree spatial index.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "flatgeobuf.h"
+
+#include "packedrtree.h"
+
+#include "cpl_error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+CPL_CVSID("$Id$")
+
+namespace FlatGeobuf
+{
+
+/************************************************************************/
+/*                               Expand()                               */
+/************************************************************************/
+
+void NodeItem::Expand( const NodeItem& oOther )
+{
+    dfMinX = std::min(dfMinX, oOther.dfMinX);
+    dfMinY = std::min(dfMinY, oOther.dfMinY);
+    dfMaxX = std::max(dfMaxX, oOther.dfMaxX);
+    dfMaxY = std::max(dfMaxY, oOther.dfMaxY);
+}
+
+/************************************************************************/
+/*                       ReadNodeItem() / WriteNodeItem()               */
+/************************************************************************/
+
+static NodeItem ReadNodeItem( const GByte* pabyData )
+{
+    NodeItem oItem;
+    memcpy(&oItem.dfMinX, pabyData, sizeof(double));
+    memcpy(&oItem.dfMinY, pabyData + 8, sizeof(double));
+    memcpy(&oItem.dfMaxX, pabyData + 16, sizeof(double));
+    memcpy(&oItem.dfMaxY, pabyData + 24, sizeof(double));
+    memcpy(&oItem.nOffset, pabyData + 32, sizeof(uint64_t));
+    CPL_LSBPTR64(&oItem.dfMinX);
+    CPL_LSBPTR64(&oItem.dfMinY);
+    CPL_LSBPTR64(&oItem.dfMaxX);
+    CPL_LSBPTR64(&oItem.dfMaxY);
+    CPL_LSBPTR64(&oItem.nOffset);
+    return oItem;
+}
+
+static void WriteNodeItem( const NodeItem& oItem, GByte* pabyData )
+{
+    NodeItem oLSB(oItem);
+    CPL_LSBPTR64(&oLSB.dfMinX);
+    CPL_LSBPTR64(&oLSB.dfMinY);
+    CPL_LSBPTR64(&oLSB.dfMaxX);
+    CPL_LSBPTR64(&oLSB.dfMaxY);
+    CPL_LSBPTR64(&oLSB.nOffset);
+    memcpy(pabyData, &oLSB.dfMinX, sizeof(double));
+    memcpy(pabyData + 8, &oLSB.dfMinY, sizeof(double));
+    memcpy(pabyData + 16, &oLSB.dfMaxX, sizeof(double));
+    memcpy(pabyData + 24, &oLSB.dfMaxY, sizeof(double));
+    memcpy(pabyData + 32, &oLSB.nOffset, sizeof(uint64_t));
+}
+
+/************************************************************************/
+/*                            HilbertValue()                            */
+/*                                                                      */
+/*      Fast 2D Hilbert curve index, from                               */
+/*      https://github.com/rawrunprotected/hilbert_curves (public       */
+/*      domain).                                                        */
+/************************************************************************/
+
+static uint32_t HilbertValue( uint32_t x, uint32_t y )
+{
+    uint32_t a = x ^ y;
+    uint32_t b = 0xFFFF ^ a;
+    uint32_t c = 0xFFFF ^ (x | y);
+    uint32_t d = x & (y ^ 0xFFFF);
+
+    uint32_t A = a | (b >> 1);
+    uint32_t B = (a >> 1) ^ a;
+    uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+    B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+    C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+    D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+    B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+    C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+    D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+    a = A; b = B; c = C; d = D;
+    C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+    D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+    a = C ^ (C >> 1);
+    b = D ^ (D >> 1);
+
+    uint32_t i0 = x ^ y;
+    uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+    i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+    i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+    i0 = (i0 | (i0 << 2)) & 0x33333333;
+    i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+    i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+    i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+    i1 = (i1 | (i1 << 2)) & 0x33333333;
+    i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+    return (i1 << 1) | i0;
+}
+
+static uint32_t HilbertCoord( double dfVal, double dfMin, double dfSize )
+{
+    constexpr double dfHilbertMax = (1 << 16) - 1;
+    if( !(dfSize > 0) )
+        return 0;
+    const double dfCoord = std::floor(dfHilbertMax * (dfVal - dfMin) / dfSize);
+    // Also catches NaN.
+    if( !(dfCoord >= 0) )
+        return 0;
+    return dfCoord > dfHilbertMax ? static_cast<uint32_t>(dfHilbertMax) :
+                                    static_cast<uint32_t>(dfCoord);
+}
+
+uint32_t HilbertValue( const NodeItem& oItem, const NodeItem& oExtent )
+{
+    if( !oItem.IsValid() )
+        return 0;
+    const uint32_t x =
+        HilbertCoord((oItem.dfMinX + oItem.dfMaxX) / 2, oExtent.dfMinX,
+                     oExtent.dfMaxX - oExtent.dfMinX);
+    const uint32_t y =
+        HilbertCoord((oItem.dfMinY + oItem.dfMaxY) / 2, oExtent.dfMinY,
+                     oExtent.dfMaxY - oExtent.dfMinY);
+    return HilbertValue(x, y);
+}
+
+/************************************************************************/
+/*                        GenerateLevelBounds()                         */
+/************************************************************************/
+
+std::vector<std::pair<uint64_t, uint64_t>>
+PackedRTree::GenerateLevelBounds( uint64_t nNumItems, uint16_t nNodeSize )
+{
+    std::vector<std::pair<uint64_t, uint64_t>> aoLevelBounds;
+    if( nNumItems == 0 || nNodeSize < 2 )
+        return aoLevelBounds;
+
+    // Number of nodes per level, bottom-up.
+    std::vector<uint64_t> anLevelNumNodes;
+    uint64_t n = nNumItems;
+    uint64_t nNumNodes = n;
+    anLevelNumNodes.push_back(n);
+    do
+    {
+        n = (n + nNodeSize - 1) / nNodeSize;
+        nNumNodes += n;
+        anLevelNumNodes.push_back(n);
+    } while( n != 1 );
+
+    // Levels are stored top-down.
+    n = nNumNodes;
+    for( const uint64_t nLevelNumNodes: anLevelNumNodes )
+    {
+        n -= nLevelNumNodes;
+        aoLevelBounds.emplace_back(n, n + nLevelNumNodes);
+    }
+    return aoLevelBounds;
+}
+
+/************************************************************************/
+/*                                Size()                                */
+/************************************************************************/
+
+uint64_t PackedRTree::Size( uint64_t nNumItems, uint16_t nNodeSize )
+{
+    const auto aoLevelBounds = GenerateLevelBounds(nNumItems, nNodeSize);
+    if( aoLevelBounds.empty() )
+        return 0;
+    return aoLevelBounds.front().second * nNodeItemSize;
+}
+
+/************************************************************************/
+/*                            PackedRTree()                             */
+/************************************************************************/
+
+PackedRTree::PackedRTree( const std::vector<NodeItem>& aoLeaves,
+                          uint16_t nNodeSize ) :
+    m_nNumItems(aoLeaves.size()),
+    m_nNodeSize(std::max(nNodeSize, static_cast<uint16_t>(2)))
+{
+    const auto aoLevelBounds =
+        GenerateLevelBounds(m_nNumItems, m_nNodeSize);
+    if( aoLevelBounds.empty() )
+    {
+        m_aoNodeItems.resize(1);
+        return;
+    }
+
+    const uint64_t nNumNodes = aoLevelBounds.front().second;
+    m_aoNodeItems.resize(static_cast<size_t>(nNumNodes));
+    std::copy(aoLeaves.begin(), aoLeaves.end(),
+              m_aoNodeItems.begin() +
+                static_cast<size_t>(aoLevelBounds.front().first));
+
+    for( size_t i = 0; i + 1 < aoLevelBounds.size(); i++ )
+    {
+        uint64_t nPos = aoLevelBounds[i].first;
+        const uint64_t nEnd = aoLevelBounds[i].second;
+        uint64_t nNewPos = aoLevelBounds[i + 1].first;
+        while( nPos < nEnd )
+        {
+            NodeItem oNode;
+            oNode.nOffset = nPos;
+            for( uint16_t j = 0; j < m_nNodeSize && nPos < nEnd; j++ )
+                oNode.Expand(m_aoNodeItems[static_cast<size_t>(nPos++)]);
+            m_aoNodeItems[static_cast<size_t>(nNewPos++)] = oNode;
+        }
+    }
+}
+
+/************************************************************************/
+/*                               Write()                                */
+/************************************************************************/
+
+bool PackedRTree::Write( VSILFILE* fp ) const
+{
+    if( m_nNumItems == 0 )
+        return true;
+
+    constexpr size_t nItemsPerChunk = 4096;
+    std::vector<GByte> abyChunk(nItemsPerChunk * nNodeItemSize);
+    for( size_t i = 0; i < m_aoNodeItems.size(); i += nItemsPerChunk )
+    {
+        const size_t nItems =
+            std::min(nItemsPerChunk, m_aoNodeItems.size() - i);
+        for( size_t j = 0; j < nItems; j++ )
+            WriteNodeItem(m_aoNodeItems[i + j],
+                          &abyChunk[j * nNodeItemSize]);
+        if( VSIFWriteL(abyChunk.data(), nNodeItemSize, nItems, fp) != nItems )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            StreamSearch()                            */
+/*                                                                      */
+/*      Breadth-first search: all the nodes to visit at a level are     */
+/*      fetched at once, adjacent ones being merged, which keeps the    */
+/*      number of requests to remote files to one per level. Leaf       */
+/*      ranges are extended by one item so that the size of each        */
+/*      matching feature is known from the offset of the next one.      */
+/************************************************************************/
+
+std::vector<PackedRTree::SearchResultItem>
+PackedRTree::StreamSearch( uint64_t nNumItems, uint16_t nNodeSize,
+                           const NodeItem& oFilter,
+                           VSILFILE* fp, vsi_l_offset nIndexOffset,
+                           bool& bError )
+{
+    bError = false;
+    std::vector<SearchResultItem> aoResults;
+
+    const auto aoLevelBounds = GenerateLevelBounds(nNumItems, nNodeSize);
+    if( aoLevelBounds.empty() )
+        return aoResults;
+    const uint64_t nLeafNodesOffset = aoLevelBounds.front().first;
+    const uint64_t nNumNodes = aoLevelBounds.front().second;
+
+    // First child of the nodes to visit at the current level.
+    std::vector<uint64_t> anNodes{ 0 };
+    for( size_t iLevel = aoLevelBounds.size(); iLevel > 0 && !anNodes.empty(); )
+    {
+        --iLevel;
+        const bool bLeaf = iLevel == 0;
+        const uint64_t nLevelEnd = aoLevelBounds[iLevel].second;
+
+        // Contiguous [start, end) node ranges to fetch.
+        std::vector<std::pair<uint64_t, uint64_t>> aoRanges;
+        for( const uint64_t nNode: anNodes )
+        {
+            uint64_t nEnd = std::min(nNode + nNodeSize, nLevelEnd);
+            if( bLeaf && nEnd < nNumNodes )
+                nEnd++;
+            if( !aoRanges.empty() && nNode <= aoRanges.back().second )
+                aoRanges.back().second = std::max(aoRanges.back().second,
+                                                  nEnd);
+            else
+                aoRanges.emplace_back(nNode, nEnd);
+        }
+
+        std::vector<size_t> anBufOffsets;
+        std::vector<vsi_l_offset> anOffsets;
+        std::vector<size_t> anSizes;
+        size_t nTotalSize = 0;
+        for( const auto& oRange: aoRanges )
+        {
+            anBufOffsets.push_back(nTotalSize);
+            anOffsets.push_back(nIndexOffset + oRange.first * nNodeItemSize);
+            anSizes.push_back(static_cast<size_t>(
+                (oRange.second - oRange.first) * nNodeItemSize));
+            nTotalSize += anSizes.back();
+        }
+
+        std::vector<GByte> abyBuf;
+        std::vector<void*> apData;
+        try
+        {
+            abyBuf.resize(nTotalSize);
+            for( const size_t nBufOffset: anBufOffsets )
+                apData.push_back(&abyBuf[nBufOffset]);
+        }
+        catch( const std::bad_alloc& )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate memory for spatial index search");
+            bError = true;
+            return std::vector<SearchResultItem>();
+        }
+        if( VSIFReadMultiRangeL(static_cast<int>(aoRanges.size()),
+                                apData.data(), anOffsets.data(),
+                                anSizes.data(), fp) != 0 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Cannot read spatial index");
+            bError = true;
+            return std::vector<SearchResultItem>();
+        }
+
+        std::vector<uint64_t> anNextNodes;
+        size_t iRange = 0;
+        for( const uint64_t nNode: anNodes )
+        {
+            while( aoRanges[iRange].second <= nNode )
+                iRange++;
+            const GByte* pabyRange =
+                static_cast<const GByte*>(apData[iRange]);
+            const uint64_t nRangeStart = aoRanges[iRange].first;
+            const uint64_t nEnd = std::min(nNode + nNodeSize, nLevelEnd);
+            for( uint64_t nPos = nNode; nPos < nEnd; nPos++ )
+            {
+                const NodeItem oItem = ReadNodeItem(
+                    pabyRange + (nPos - nRangeStart) * nNodeItemSize);
+                if( !oFilter.Intersects(oItem) )
+                    continue;
+
+                if( bLeaf )
+                {
+                    SearchResultItem oResult;
+                    oResult.nOffset = oItem.nOffset;
+                    oResult.nIndex = nPos - nLeafNodesOffset;
+                    oResult.nSize = 0;
+                    if( nPos + 1 < nNumNodes )
+                    {
+                        const NodeItem oNext = ReadNodeItem(
+                            pabyRange + (nPos + 1 - nRangeStart) *
+                                                            nNodeItemSize);
+                        if( oNext.nOffset <= oItem.nOffset )
+                        {
+                            CPLError(CE_Failure, CPLE_AppDefined,
+                                     "Corrupted spatial index");
+                            bError = true;
+                            return std::vector<SearchResultItem>();
+                        }
+                        oResult.nSize = oNext.nOffset - oItem.nOffset;
+                    }
+                    aoResults.push_back(oResult);
+                }
+                else
+                {
+                    if( oItem.nOffset < aoLevelBounds[iLevel - 1].first ||
+                        oItem.nOffset >= aoLevelBounds[iLevel - 1].second ||
+                        (!anNextNodes.empty() &&
+                         oItem.nOffset <= anNextNodes.back()) )
+                    {
+                        CPLError(CE_Failure, CPLE_AppDefined,
+                                 "Corrupted spatial index");
+                        bError = true;
+                        return std::vector<SearchResultItem>();
+                    }
+                    anNextNodes.push_back(oItem.nOffset);
+                }
+            }
+        }
+        anNodes.swap(anNextNodes);
+    }
+
+    return aoResults;
+}
+
+} // namespace FlatGeobuf
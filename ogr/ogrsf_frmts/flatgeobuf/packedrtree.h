@@ -0,0 +1,121 @@
+/******************************************************************************
+ *
+ * Project:  FlatGeobuf driver
+ * Purpose:  Packed Hilbert R-tree spatial index.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "flatgeobuf.h"
+
+#ifndef FLATGEOBUF_PACKEDRTREE_H_INCLUDED
+#define FLATGEOBUF_PACKEDRTREE_H_INCLUDED
+
+#include "cpl_vsi.h"
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace FlatGeobuf
+{
+
+/************************************************************************/
+/*                               NodeItem                               */
+/*                                                                      */
+/*      Node of the R-tree, stored on disk as 4 little endian doubles   */
+/*      and a uint64. For leaves, nOffset is the offset of the feature  */
+/*      from the start of the feature section. For other nodes, it is   */
+/*      the index of their first child.                                 */
+/************************************************************************/
+
+struct NodeItem
+{
+    double   dfMinX = std::numeric_limits<double>::infinity();
+    double   dfMinY = std::numeric_limits<double>::infinity();
+    double   dfMaxX = -std::numeric_limits<double>::infinity();
+    double   dfMaxY = -std::numeric_limits<double>::infinity();
+    uint64_t nOffset = 0;
+
+    void     Expand(const NodeItem& oOther);
+    bool     Intersects(const NodeItem& oOther) const
+    {
+        return !(oOther.dfMinX > dfMaxX || oOther.dfMinY > dfMaxY ||
+                 oOther.dfMaxX < dfMinX || oOther.dfMaxY < dfMinY);
+    }
+    bool     IsValid() const { return dfMinX <= dfMaxX && dfMinY <= dfMaxY; }
+};
+
+constexpr size_t nNodeItemSize = 4 * sizeof(double) + sizeof(uint64_t);
+constexpr uint16_t nDefaultNodeSize = 16;
+
+// Value on the 16 bit Hilbert curve covering oExtent of the center of oItem.
+uint32_t HilbertValue(const NodeItem& oItem, const NodeItem& oExtent);
+
+/************************************************************************/
+/*                             PackedRTree                              */
+/*                                                                      */
+/*      Static R-tree of Hilbert sorted items, packed in nNodeSize      */
+/*      nodes. Levels are stored top-down, the root first and the       */
+/*      leaves, in feature order, last.                                 */
+/************************************************************************/
+
+class PackedRTree
+{
+    std::vector<NodeItem> m_aoNodeItems{};
+    uint64_t              m_nNumItems = 0;
+    uint16_t              m_nNodeSize = nDefaultNodeSize;
+
+  public:
+    struct SearchResultItem
+    {
+        uint64_t nOffset;   // from the start of the feature section
+        uint64_t nIndex;    // feature index
+        uint64_t nSize;     // 0 for the last feature of the file
+    };
+
+    // aoLeaves must already be sorted.
+    PackedRTree(const std::vector<NodeItem>& aoLeaves, uint16_t nNodeSize);
+
+    const NodeItem& GetExtent() const { return m_aoNodeItems[0]; }
+    bool            Write(VSILFILE* fp) const;
+
+    // [start, end) node indices of each level, leaves first.
+    static std::vector<std::pair<uint64_t, uint64_t>>
+                    GenerateLevelBounds(uint64_t nNumItems,
+                                        uint16_t nNodeSize);
+
+    // Size in bytes of the index.
+    static uint64_t Size(uint64_t nNumItems, uint16_t nNodeSize);
+
+    // Search of an index stored at nIndexOffset of fp. The nodes of each
+    // level are fetched with a single VSIFReadMultiRangeL() call.
+    static std::vector<SearchResultItem>
+                    StreamSearch(uint64_t nNumItems, uint16_t nNodeSize,
+                                 const NodeItem& oFilter,
+                                 VSILFILE* fp, vsi_l_offset nIndexOffset,
+                                 bool& bError);
+};
+
+} // namespace FlatGeobuf
+
+#endif /* ndef FLATGEOBUF_PACKEDRTREE_H_INCLUDED */
@@ -77,4 +77,36 @@ OGRAttrIndex::OGRAttrIndex() {}
 
 OGRAttrIndex::~OGRAttrIndex() {}
 
+/************************************************************************/
+/*                        SupportsRangeQueries()                        */
+/************************************************************************/
+
+bool OGRAttrIndex::SupportsRangeQueries()
+{
+    return false;
+}
+
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/************************************************************************/
+
+GIntBig *OGRAttrIndex::GetRangeMatches( OGRField * /* psMin */,
+                                        bool /* bMinIncluded */,
+                                        OGRField * /* psMax */,
+                                        bool /* bMaxIncluded */,
+                                        GIntBig * /* pnFIDCount */ )
+{
+    return nullptr;
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/************************************************************************/
+
+GIntBig *OGRAttrIndex::GetPrefixMatches( const char * /* pszPrefix */,
+                                         GIntBig * /* pnFIDCount */ )
+{
+    return nullptr;
+}
+
 //! @endcond
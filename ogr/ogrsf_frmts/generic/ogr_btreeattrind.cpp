@@ -0,0 +1,1452 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Generic attribute index stored as bulk loaded B+trees.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_attrind.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <string>
+#include <vector>
+
+CPL_CVSID("$Id$")
+
+//! @cond Doxygen_Suppress
+
+/*
+ * All the indexes of a layer are stored in a single .obi file, with all
+ * values in little endian order:
+ *
+ * Header:
+ *   char[8]    "OGRBTIDX"
+ *   uint32     version (1)
+ *   uint32     number of indexes
+ *   For each index:
+ *     uint8    length of the field name, followed by its bytes
+ *     uint8    key type (0 = integer, 1 = real, 2 = string)
+ *     uint64   number of entries
+ *     uint64   offset of the first page of the tree
+ *     uint32   number of pages
+ *     uint32   number of the root page, relative to the first page
+ *
+ * Followed by the pages of each tree, of OGR_BTREE_PAGE_SIZE bytes:
+ *   uint8      level (0 for leaves)
+ *   uint8      unused
+ *   uint16     number of entries
+ *   uint32     number of the next leaf (OGR_BTREE_NO_PAGE if none)
+ *   entries:   key, then FID (uint64) in leaves, or child page number
+ *              (uint32) in internal pages, whose keys are the first key of
+ *              each child.  Integer and real keys use 8 bytes, string keys
+ *              an uint8 length followed by the bytes.
+ *
+ * Leaves are written first, so page 0 is the leftmost leaf.  DateTime
+ * values are indexed as real numbers.  Strings are lower cased, as the = and LIKE
+ * operators of OGR SQL are case insensitive, and truncated to
+ * OGR_BTREE_MAX_STRING_KEY bytes: string lookups thus return candidates
+ * that the caller must still evaluate.
+ */
+
+constexpr int OGR_BTREE_PAGE_SIZE = 4096;
+constexpr int OGR_BTREE_PAGE_HEADER_SIZE = 8;
+constexpr GUInt32 OGR_BTREE_NO_PAGE = 0xFFFFFFFFU;
+constexpr size_t OGR_BTREE_MAX_STRING_KEY = 255;
+constexpr int OGR_BTREE_MAX_DEPTH = 32;
+static const char OGR_BTREE_SIGNATURE[] = "OGRBTIDX";
+
+typedef enum
+{
+    OBKT_INTEGER = 0,
+    OBKT_REAL = 1,
+    OBKT_STRING = 2
+} OGRBTreeKeyType;
+
+struct OGRBTreeKey
+{
+    GIntBig     nInt = 0;
+    double      dfReal = 0.0;
+    std::string osStr{};
+};
+
+struct OGRBTreeEntry
+{
+    OGRBTreeKey sKey{};
+    GIntBig     nFID = 0;
+};
+
+/************************************************************************/
+/*                        Little endian helpers                         */
+/************************************************************************/
+
+static void OGRBTreePutUInt16( GByte*& pabyData, GUInt16 nVal )
+{
+    CPL_LSBPTR16(&nVal);
+    memcpy(pabyData, &nVal, sizeof(nVal));
+    pabyData += sizeof(nVal);
+}
+
+static void OGRBTreePutUInt32( GByte*& pabyData, GUInt32 nVal )
+{
+    CPL_LSBPTR32(&nVal);
+    memcpy(pabyData, &nVal, sizeof(nVal));
+    pabyData += sizeof(nVal);
+}
+
+static void OGRBTreePutUInt64( GByte*& pabyData, GUIntBig nVal )
+{
+    CPL_LSBPTR64(&nVal);
+    memcpy(pabyData, &nVal, sizeof(nVal));
+    pabyData += sizeof(nVal);
+}
+
+static GUInt16 OGRBTreeGetUInt16( const GByte*& pabyData )
+{
+    GUInt16 nVal;
+    memcpy(&nVal, pabyData, sizeof(nVal));
+    CPL_LSBPTR16(&nVal);
+    pabyData += sizeof(nVal);
+    return nVal;
+}
+
+static GUInt32 OGRBTreeGetUInt32( const GByte*& pabyData )
+{
+    GUInt32 nVal;
+    memcpy(&nVal, pabyData, sizeof(nVal));
+    CPL_LSBPTR32(&nVal);
+    pabyData += sizeof(nVal);
+    return nVal;
+}
+
+static GUIntBig OGRBTreeGetUInt64( const GByte*& pabyData )
+{
+    GUIntBig nVal;
+    memcpy(&nVal, pabyData, sizeof(nVal));
+    CPL_LSBPTR64(&nVal);
+    pabyData += sizeof(nVal);
+    return nVal;
+}
+
+/************************************************************************/
+/*                          OGRBTreeAttrIndex                           */
+/*                                                                      */
+/*      B+tree index of one field.                                      */
+/************************************************************************/
+
+class OGRBTreeLayerAttrIndex;
+
+class OGRBTreeAttrIndex final: public OGRAttrIndex
+{
+    CPL_DISALLOW_COPY_ASSIGN(OGRBTreeAttrIndex)
+
+public:
+    OGRBTreeLayerAttrIndex *poLIndex;
+    int             iField;
+    CPLString       osFieldName;
+    OGRFieldType    eFieldType;
+    OGRBTreeKeyType eKeyType;
+
+    // Location of the tree in the current file.
+    GUIntBig        nEntries;
+    vsi_l_offset    nFirstPageOffset;
+    GUInt32         nPageCount;
+    GUInt32         nRootPage;
+
+    // Entries added since the tree was written, and whether the tree
+    // must be rewritten.
+    std::vector<OGRBTreeEntry> aoPending;
+    bool            bDirty;
+
+                OGRBTreeAttrIndex( OGRBTreeLayerAttrIndex *poLIndexIn,
+                                   int iFieldIn,
+                                   const OGRFieldDefn *poFieldDefn,
+                                   OGRBTreeKeyType eKeyTypeIn );
+
+    static bool GetKeyType( OGRFieldType eType,
+                            OGRBTreeKeyType *peKeyType );
+    static double DateToReal( const OGRField *psField );
+    static std::string FoldString( const char* pszStr );
+
+    bool        BuildKey( const OGRField *psKey, OGRBTreeKey& sKey ) const;
+    int         CompareKeys( const OGRBTreeKey& sA,
+                             const OGRBTreeKey& sB ) const;
+    size_t      GetKeySize( const OGRBTreeKey& sKey ) const;
+    void        EncodeKey( GByte*& pabyData, const OGRBTreeKey& sKey ) const;
+    bool        DecodeKey( const GByte*& pabyData, const GByte* pabyEnd,
+                           OGRBTreeKey& sKey ) const;
+
+    bool        ReadPage( GUInt32 nPage, GByte* pabyPage,
+                          int& nLevel, int& nCount, GUInt32& nNextPage );
+    bool        Scan( const OGRBTreeKey* psMin, bool bMinIncluded,
+                      const OGRBTreeKey* psMax, bool bMaxIncluded,
+                      const std::string* posPrefix,
+                      std::vector<GIntBig>& anFIDs );
+    bool        ReadAllEntries( std::vector<OGRBTreeEntry>& aoEntries );
+    bool        WriteTree( VSILFILE* fp,
+                           const std::vector<OGRBTreeEntry>& aoEntries,
+                           GUInt32& nNewPageCount, GUInt32& nNewRootPage );
+    GIntBig    *ToFIDList( std::vector<GIntBig>& anFIDs,
+                           GIntBig *pnFIDCount );
+
+    GIntBig     GetFirstMatch( OGRField *psKey ) override;
+    GIntBig    *GetAllMatches( OGRField *psKey ) override;
+    GIntBig    *GetAllMatches( OGRField *psKey, GIntBig* panFIDList,
+                               int* nFIDCount, int* nLength ) override;
+
+    OGRErr      AddEntry( OGRField *psKey, GIntBig nFID ) override;
+    OGRErr      RemoveEntry( OGRField *psKey, GIntBig nFID ) override;
+
+    OGRErr      Clear() override;
+
+    bool        SupportsRangeQueries() override { return true; }
+    GIntBig    *GetRangeMatches( OGRField *psMin, bool bMinIncluded,
+                                 OGRField *psMax, bool bMaxIncluded,
+                                 GIntBig *pnFIDCount ) override;
+    GIntBig    *GetPrefixMatches( const char *pszPrefix,
+                                  GIntBig *pnFIDCount ) override;
+};
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        OGRBTreeLayerAttrIndex                        */
+/* ==================================================================== */
+/************************************************************************/
+
+class OGRBTreeLayerAttrIndex final: public OGRLayerAttrIndex
+{
+    CPL_DISALLOW_COPY_ASSIGN(OGRBTreeLayerAttrIndex)
+
+public:
+    CPLString   osFilename;
+    VSILFILE   *fp;
+    std::vector<OGRBTreeAttrIndex*> apoIndexes;
+
+                OGRBTreeLayerAttrIndex();
+    virtual     ~OGRBTreeLayerAttrIndex();
+
+    /* base class virtual methods */
+    OGRErr      Initialize( const char *pszIndexPath, OGRLayer * ) override;
+    OGRErr      CreateIndex( int iField ) override;
+    OGRErr      DropIndex( int iField ) override;
+    OGRErr      IndexAllFeatures( int iField = -1 ) override;
+
+    OGRErr      AddToIndex( OGRFeature *poFeature, int iField = -1 ) override;
+    OGRErr      RemoveFromIndex( OGRFeature *poFeature ) override;
+
+    OGRAttrIndex *GetFieldIndex( int iField ) override;
+
+    /* custom to OGRBTreeLayerAttrIndex */
+    OGRErr      Load();
+    OGRErr      Flush();
+    OGRErr      Rewrite();
+};
+
+/************************************************************************/
+/*                       OGRBTreeLayerAttrIndex()                       */
+/************************************************************************/
+
+OGRBTreeLayerAttrIndex::OGRBTreeLayerAttrIndex() :
+    osFilename(),
+    fp(nullptr),
+    apoIndexes()
+{}
+
+/************************************************************************/
+/*                      ~OGRBTreeLayerAttrIndex()                       */
+/************************************************************************/
+
+OGRBTreeLayerAttrIndex::~OGRBTreeLayerAttrIndex()
+
+{
+    Flush();
+
+    if( fp != nullptr )
+        VSIFCloseL( fp );
+
+    for( OGRBTreeAttrIndex* poIndex : apoIndexes )
+        delete poIndex;
+}
+
+/************************************************************************/
+/*                             Initialize()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::Initialize( const char *pszIndexPathIn,
+                                           OGRLayer *poLayerIn )
+
+{
+    if( poLayerIn == poLayer )
+        return OGRERR_NONE;
+
+    poLayer = poLayerIn;
+    pszIndexPath = CPLStrdup( pszIndexPathIn );
+    osFilename = CPLResetExtension( pszIndexPathIn, "obi" );
+
+/* -------------------------------------------------------------------- */
+/*      If an index file already exists, load it.                       */
+/* -------------------------------------------------------------------- */
+    VSIStatBufL sStat;
+    if( VSIStatL( osFilename, &sStat ) == 0 )
+        return Load();
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                                Load()                                */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::Load()
+
+{
+    fp = VSIFOpenL( osFilename, "rb" );
+    if( fp == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_OpenFailed,
+                  "Failed to open index file %s.", osFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+
+    GByte abyHeader[16];
+    if( VSIFReadL( abyHeader, sizeof(abyHeader), 1, fp ) != 1 ||
+        memcmp( abyHeader, OGR_BTREE_SIGNATURE, 8 ) != 0 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "%s is not an OGR attribute index file.",
+                  osFilename.c_str() );
+        VSIFCloseL( fp );
+        fp = nullptr;
+        return OGRERR_FAILURE;
+    }
+    const GByte *pabyData = abyHeader + 8;
+    const GUInt32 nVersion = OGRBTreeGetUInt32( pabyData );
+    const GUInt32 nIndexCount = OGRBTreeGetUInt32( pabyData );
+    if( nVersion != 1 || nIndexCount > 10000 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Unsupported version or corrupted index file %s.",
+                  osFilename.c_str() );
+        VSIFCloseL( fp );
+        fp = nullptr;
+        return OGRERR_FAILURE;
+    }
+
+    OGRFeatureDefn *poDefn = poLayer->GetLayerDefn();
+    for( GUInt32 i = 0; i < nIndexCount; i++ )
+    {
+        GByte nNameLen = 0;
+        char szName[256];
+        GByte abyEntry[1 + 8 + 8 + 4 + 4];
+        if( VSIFReadL( &nNameLen, 1, 1, fp ) != 1 ||
+            VSIFReadL( szName, nNameLen, 1, fp ) != (nNameLen ? 1U : 0U) ||
+            VSIFReadL( abyEntry, sizeof(abyEntry), 1, fp ) != 1 )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Corrupted index file %s.", osFilename.c_str() );
+            return OGRERR_FAILURE;
+        }
+        szName[nNameLen] = '\0';
+
+        pabyData = abyEntry;
+        const int nKeyType = *pabyData;
+        pabyData++;
+        const GUIntBig nEntries = OGRBTreeGetUInt64( pabyData );
+        const GUIntBig nFirstPageOffset = OGRBTreeGetUInt64( pabyData );
+        const GUInt32 nPageCount = OGRBTreeGetUInt32( pabyData );
+        const GUInt32 nRootPage = OGRBTreeGetUInt32( pabyData );
+
+        // Indexes are matched by field name, so that they survive the
+        // reordering of fields.
+        const int iField = poDefn->GetFieldIndex( szName );
+        OGRBTreeKeyType eKeyType = OBKT_INTEGER;
+        if( iField < 0 ||
+            !OGRBTreeAttrIndex::GetKeyType(
+                poDefn->GetFieldDefn(iField)->GetType(), &eKeyType ) ||
+            static_cast<int>(eKeyType) != nKeyType ||
+            (nPageCount != 0 && nRootPage >= nPageCount) )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Skipping index of field %s in %s, which does not "
+                      "match the layer definition.",
+                      szName, osFilename.c_str() );
+            continue;
+        }
+
+        OGRBTreeAttrIndex *poIndex = new OGRBTreeAttrIndex(
+            this, iField, poDefn->GetFieldDefn(iField), eKeyType );
+        poIndex->nEntries = nEntries;
+        poIndex->nFirstPageOffset = nFirstPageOffset;
+        poIndex->nPageCount = nPageCount;
+        poIndex->nRootPage = nRootPage;
+        apoIndexes.push_back( poIndex );
+    }
+
+    CPLDebug( "OGR", "Restored %d field indexes for layer %s from %s.",
+              static_cast<int>(apoIndexes.size()), poDefn->GetName(),
+              osFilename.c_str() );
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                               Flush()                                */
+/*                                                                      */
+/*      Write the trees that have pending changes.                      */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::Flush()
+
+{
+    for( const OGRBTreeAttrIndex* poIndex : apoIndexes )
+    {
+        if( poIndex->bDirty )
+            return Rewrite();
+    }
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                              Rewrite()                               */
+/*                                                                      */
+/*      Write a new index file, copying the unchanged trees and         */
+/*      rebuilding the modified ones, and replace the current file      */
+/*      with it.                                                        */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::Rewrite()
+
+{
+    if( apoIndexes.empty() )
+    {
+        if( fp != nullptr )
+        {
+            VSIFCloseL( fp );
+            fp = nullptr;
+        }
+        VSIUnlink( osFilename );
+        return OGRERR_NONE;
+    }
+
+    const CPLString osTmpFilename( osFilename + ".tmp" );
+    VSILFILE *fpNew = VSIFOpenL( osTmpFilename, "wb" );
+    if( fpNew == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_OpenFailed,
+                  "Failed to create %s.", osTmpFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write a placeholder of the header, to know its size.            */
+/* -------------------------------------------------------------------- */
+    size_t nHeaderSize = 16;
+    for( const OGRBTreeAttrIndex* poIndex : apoIndexes )
+        nHeaderSize += 1 + std::min(poIndex->osFieldName.size(),
+                                    static_cast<size_t>(255)) +
+                       1 + 8 + 8 + 4 + 4;
+    std::vector<GByte> abyHeader( nHeaderSize );
+    bool bOK = VSIFWriteL( abyHeader.data(), nHeaderSize, 1, fpNew ) == 1;
+
+/* -------------------------------------------------------------------- */
+/*      Write the trees.                                                */
+/* -------------------------------------------------------------------- */
+    struct TreeLocation
+    {
+        GUIntBig     nEntries;
+        vsi_l_offset nFirstPageOffset;
+        GUInt32      nPageCount;
+        GUInt32      nRootPage;
+    };
+    std::vector<TreeLocation> asLocations;
+    std::vector<GByte> abyPage( OGR_BTREE_PAGE_SIZE );
+
+    for( size_t i = 0; bOK && i < apoIndexes.size(); i++ )
+    {
+        OGRBTreeAttrIndex *poIndex = apoIndexes[i];
+        TreeLocation sLoc;
+        sLoc.nFirstPageOffset = VSIFTellL( fpNew );
+
+        if( poIndex->bDirty )
+        {
+            std::vector<OGRBTreeEntry> aoEntries;
+            try
+            {
+                bOK = poIndex->ReadAllEntries( aoEntries );
+                aoEntries.insert( aoEntries.end(),
+                                  poIndex->aoPending.begin(),
+                                  poIndex->aoPending.end() );
+                std::stable_sort( aoEntries.begin(), aoEntries.end(),
+                    [poIndex](const OGRBTreeEntry& a, const OGRBTreeEntry& b)
+                    {
+                        const int nRes = poIndex->CompareKeys(a.sKey, b.sKey);
+                        return nRes < 0 || (nRes == 0 && a.nFID < b.nFID);
+                    });
+            }
+            catch( const std::bad_alloc& )
+            {
+                CPLError( CE_Failure, CPLE_OutOfMemory,
+                          "Out of memory while building index of %s",
+                          poIndex->osFieldName.c_str() );
+                bOK = false;
+            }
+            sLoc.nEntries = aoEntries.size();
+            bOK = bOK && poIndex->WriteTree( fpNew, aoEntries,
+                                             sLoc.nPageCount,
+                                             sLoc.nRootPage );
+        }
+        else
+        {
+            // Page numbers are relative to the first page of the tree, so
+            // it can be copied as it is.
+            sLoc.nEntries = poIndex->nEntries;
+            sLoc.nPageCount = poIndex->nPageCount;
+            sLoc.nRootPage = poIndex->nRootPage;
+            for( GUInt32 iPage = 0; bOK && iPage < poIndex->nPageCount;
+                 iPage++ )
+            {
+                bOK = fp != nullptr &&
+                      VSIFSeekL( fp, poIndex->nFirstPageOffset +
+                                 static_cast<vsi_l_offset>(iPage) *
+                                     OGR_BTREE_PAGE_SIZE, SEEK_SET ) == 0 &&
+                      VSIFReadL( abyPage.data(), OGR_BTREE_PAGE_SIZE, 1,
+                                 fp ) == 1 &&
+                      VSIFWriteL( abyPage.data(), OGR_BTREE_PAGE_SIZE, 1,
+                                  fpNew ) == 1;
+            }
+        }
+        asLocations.push_back( sLoc );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write the final header.                                         */
+/* -------------------------------------------------------------------- */
+    if( bOK )
+    {
+        GByte *pabyData = abyHeader.data();
+        memcpy( pabyData, OGR_BTREE_SIGNATURE, 8 );
+        pabyData += 8;
+        OGRBTreePutUInt32( pabyData, 1 );
+        OGRBTreePutUInt32( pabyData,
+                           static_cast<GUInt32>(apoIndexes.size()) );
+        for( size_t i = 0; i < apoIndexes.size(); i++ )
+        {
+            const CPLString& osName = apoIndexes[i]->osFieldName;
+            const size_t nNameLen =
+                std::min(osName.size(), static_cast<size_t>(255));
+            *pabyData = static_cast<GByte>(nNameLen);
+            pabyData++;
+            memcpy( pabyData, osName.c_str(), nNameLen );
+            pabyData += nNameLen;
+            *pabyData = static_cast<GByte>(apoIndexes[i]->eKeyType);
+            pabyData++;
+            OGRBTreePutUInt64( pabyData, asLocations[i].nEntries );
+            OGRBTreePutUInt64( pabyData, asLocations[i].nFirstPageOffset );
+            OGRBTreePutUInt32( pabyData, asLocations[i].nPageCount );
+            OGRBTreePutUInt32( pabyData, asLocations[i].nRootPage );
+        }
+        bOK = VSIFSeekL( fpNew, 0, SEEK_SET ) == 0 &&
+              VSIFWriteL( abyHeader.data(), nHeaderSize, 1, fpNew ) == 1;
+    }
+
+    if( VSIFCloseL( fpNew ) != 0 )
+        bOK = false;
+
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Failed to write index file %s.", osTmpFilename.c_str() );
+        VSIUnlink( osTmpFilename );
+        return OGRERR_FAILURE;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Replace the current file.                                       */
+/* -------------------------------------------------------------------- */
+    if( fp != nullptr )
+    {
+        VSIFCloseL( fp );
+        fp = nullptr;
+    }
+    VSIUnlink( osFilename );
+    if( VSIRename( osTmpFilename, osFilename ) != 0 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Failed to rename %s to %s.",
+                  osTmpFilename.c_str(), osFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+
+    for( size_t i = 0; i < apoIndexes.size(); i++ )
+    {
+        OGRBTreeAttrIndex *poIndex = apoIndexes[i];
+        poIndex->nEntries = asLocations[i].nEntries;
+        poIndex->nFirstPageOffset = asLocations[i].nFirstPageOffset;
+        poIndex->nPageCount = asLocations[i].nPageCount;
+        poIndex->nRootPage = asLocations[i].nRootPage;
+        poIndex->aoPending.clear();
+        poIndex->bDirty = false;
+    }
+
+    fp = VSIFOpenL( osFilename, "rb" );
+    if( fp == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_OpenFailed,
+                  "Failed to open index file %s.", osFilename.c_str() );
+        return OGRERR_FAILURE;
+    }
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                          IndexAllFeatures()                          */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::IndexAllFeatures( int iField )
+
+{
+    poLayer->ResetReading();
+
+    OGRFeature *poFeature = nullptr;
+    while( (poFeature = poLayer->GetNextFeature()) != nullptr )
+    {
+        const OGRErr eErr = AddToIndex( poFeature, iField );
+
+        delete poFeature;
+
+        if( eErr != OGRERR_NONE )
+            return eErr;
+    }
+
+    poLayer->ResetReading();
+
+    // Bulk load the trees.
+    return Flush();
+}
+
+/************************************************************************/
+/*                            CreateIndex()                             */
+/*                                                                      */
+/*      Create an index corresponding to the indicated field, but do    */
+/*      not populate it.  Use IndexAllFeatures() for that.              */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::CreateIndex( int iField )
+
+{
+    OGRFieldDefn *poFldDefn = poLayer->GetLayerDefn()->GetFieldDefn(iField);
+
+    if( GetFieldIndex(iField) != nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "It seems we already have an index for field %d/%s\n"
+                  "of layer %s.",
+                  iField, poFldDefn->GetNameRef(),
+                  poLayer->GetLayerDefn()->GetName() );
+        return OGRERR_FAILURE;
+    }
+
+    OGRBTreeKeyType eKeyType = OBKT_INTEGER;
+    if( !OGRBTreeAttrIndex::GetKeyType( poFldDefn->GetType(), &eKeyType ) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Indexing not support for the field type of field %s.",
+                  poFldDefn->GetNameRef() );
+        return OGRERR_FAILURE;
+    }
+
+    OGRBTreeAttrIndex *poIndex = new OGRBTreeAttrIndex(
+        this, iField, poFldDefn, eKeyType );
+    poIndex->bDirty = true;
+    apoIndexes.push_back( poIndex );
+
+    const OGRErr eErr = Flush();
+    if( eErr != OGRERR_NONE )
+    {
+        apoIndexes.pop_back();
+        delete poIndex;
+    }
+    return eErr;
+}
+
+/************************************************************************/
+/*                             DropIndex()                              */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::DropIndex( int iField )
+
+{
+    auto oIter = std::find_if( apoIndexes.begin(), apoIndexes.end(),
+        [iField](const OGRBTreeAttrIndex* poIndex)
+        { return poIndex->iField == iField; } );
+
+    if( oIter == apoIndexes.end() )
+    {
+        OGRFieldDefn *poFldDefn =
+            poLayer->GetLayerDefn()->GetFieldDefn(iField);
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "DROP INDEX on field (%s) that doesn't have an index.",
+                  poFldDefn->GetNameRef() );
+        return OGRERR_FAILURE;
+    }
+
+    delete *oIter;
+    apoIndexes.erase( oIter );
+
+    return Rewrite();
+}
+
+/************************************************************************/
+/*                         GetFieldAttrIndex()                          */
+/************************************************************************/
+
+OGRAttrIndex *OGRBTreeLayerAttrIndex::GetFieldIndex( int iField )
+
+{
+    for( OGRBTreeAttrIndex* poIndex : apoIndexes )
+    {
+        if( poIndex->iField == iField )
+            return poIndex;
+    }
+
+    return nullptr;
+}
+
+/************************************************************************/
+/*                             AddToIndex()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::AddToIndex( OGRFeature *poFeature,
+                                           int iTargetField )
+
+{
+    OGRErr eErr = OGRERR_NONE;
+
+    if( poFeature->GetFID() == OGRNullFID )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Attempt to index feature with no FID." );
+        return OGRERR_FAILURE;
+    }
+
+    for( size_t i = 0; i < apoIndexes.size() && eErr == OGRERR_NONE; i++ )
+    {
+        const int iField = apoIndexes[i]->iField;
+
+        if( iTargetField != -1 && iTargetField != iField )
+            continue;
+
+        if( !poFeature->IsFieldSetAndNotNull( iField ) )
+            continue;
+
+        eErr =
+            apoIndexes[i]->AddEntry( poFeature->GetRawFieldRef( iField ),
+                                     poFeature->GetFID() );
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          RemoveFromIndex()                           */
+/************************************************************************/
+
+OGRErr OGRBTreeLayerAttrIndex::RemoveFromIndex( OGRFeature * /*poFeature*/ )
+
+{
+    return OGRERR_UNSUPPORTED_OPERATION;
+}
+
+/************************************************************************/
+/*                      OGRCreateBTreeLayerIndex()                      */
+/************************************************************************/
+
+OGRLayerAttrIndex *OGRCreateBTreeLayerIndex()
+
+{
+    return new OGRBTreeLayerAttrIndex();
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          OGRBTreeAttrIndex                           */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                         OGRBTreeAttrIndex()                          */
+/************************************************************************/
+
+OGRBTreeAttrIndex::OGRBTreeAttrIndex( OGRBTreeLayerAttrIndex *poLIndexIn,
+                                      int iFieldIn,
+                                      const OGRFieldDefn *poFieldDefn,
+                                      OGRBTreeKeyType eKeyTypeIn ) :
+    poLIndex(poLIndexIn),
+    iField(iFieldIn),
+    osFieldName(poFieldDefn->GetNameRef()),
+    eFieldType(poFieldDefn->GetType()),
+    eKeyType(eKeyTypeIn),
+    nEntries(0),
+    nFirstPageOffset(0),
+    nPageCount(0),
+    nRootPage(OGR_BTREE_NO_PAGE),
+    aoPending(),
+    bDirty(false)
+{}
+
+/************************************************************************/
+/*                             GetKeyType()                             */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::GetKeyType( OGRFieldType eType,
+                                    OGRBTreeKeyType *peKeyType )
+{
+    switch( eType )
+    {
+      case OFTInteger:
+      case OFTInteger64:
+        *peKeyType = OBKT_INTEGER;
+        return true;
+
+      case OFTReal:
+      case OFTDateTime:
+        *peKeyType = OBKT_REAL;
+        return true;
+
+      case OFTString:
+        *peKeyType = OBKT_STRING;
+        return true;
+
+      default:
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                             DateToReal()                             */
+/*                                                                      */
+/*      Map a date to a real number with the same ordering as           */
+/*      OGRCompareDate(), which ignores the time zone.                  */
+/************************************************************************/
+
+double OGRBTreeAttrIndex::DateToReal( const OGRField *psField )
+{
+    return ((((static_cast<double>(psField->Date.Year) * 13 +
+               psField->Date.Month) * 32 +
+              psField->Date.Day) * 24 +
+             psField->Date.Hour) * 60 +
+            psField->Date.Minute) * 61 +
+           psField->Date.Second;
+}
+
+/************************************************************************/
+/*                             FoldString()                             */
+/************************************************************************/
+
+std::string OGRBTreeAttrIndex::FoldString( const char* pszStr )
+{
+    std::string osKey( pszStr,
+                       std::min(strlen(pszStr), OGR_BTREE_MAX_STRING_KEY) );
+    for( char& ch : osKey )
+    {
+        if( ch >= 'A' && ch <= 'Z' )
+            ch = static_cast<char>(ch - 'A' + 'a');
+    }
+    return osKey;
+}
+
+/************************************************************************/
+/*                              BuildKey()                              */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::BuildKey( const OGRField *psKey,
+                                  OGRBTreeKey& sKey ) const
+{
+    switch( eFieldType )
+    {
+      case OFTInteger:
+        sKey.nInt = psKey->Integer;
+        return true;
+
+      case OFTInteger64:
+        sKey.nInt = psKey->Integer64;
+        return true;
+
+      case OFTReal:
+        sKey.dfReal = psKey->Real;
+        // NaN compares false to everything.
+        return !CPLIsNan(sKey.dfReal);
+
+      case OFTDateTime:
+        sKey.dfReal = DateToReal( psKey );
+        return true;
+
+      case OFTString:
+        sKey.osStr = FoldString( psKey->String );
+        return true;
+
+      default:
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                            CompareKeys()                             */
+/************************************************************************/
+
+int OGRBTreeAttrIndex::CompareKeys( const OGRBTreeKey& sA,
+                                    const OGRBTreeKey& sB ) const
+{
+    switch( eKeyType )
+    {
+      case OBKT_INTEGER:
+        return sA.nInt < sB.nInt ? -1 : sA.nInt > sB.nInt ? 1 : 0;
+
+      case OBKT_REAL:
+        return sA.dfReal < sB.dfReal ? -1 : sA.dfReal > sB.dfReal ? 1 : 0;
+
+      case OBKT_STRING:
+        return sA.osStr.compare( sB.osStr );
+    }
+    return 0;
+}
+
+/************************************************************************/
+/*                        Key encoding/decoding                         */
+/************************************************************************/
+
+size_t OGRBTreeAttrIndex::GetKeySize( const OGRBTreeKey& sKey ) const
+{
+    return eKeyType == OBKT_STRING ? 1 + sKey.osStr.size() : 8;
+}
+
+void OGRBTreeAttrIndex::EncodeKey( GByte*& pabyData,
+                                   const OGRBTreeKey& sKey ) const
+{
+    if( eKeyType == OBKT_INTEGER )
+    {
+        OGRBTreePutUInt64( pabyData, static_cast<GUIntBig>(sKey.nInt) );
+    }
+    else if( eKeyType == OBKT_REAL )
+    {
+        GUIntBig nVal;
+        memcpy( &nVal, &sKey.dfReal, sizeof(nVal) );
+        OGRBTreePutUInt64( pabyData, nVal );
+    }
+    else
+    {
+        *pabyData = static_cast<GByte>(sKey.osStr.size());
+        pabyData++;
+        memcpy( pabyData, sKey.osStr.data(), sKey.osStr.size() );
+        pabyData += sKey.osStr.size();
+    }
+}
+
+bool OGRBTreeAttrIndex::DecodeKey( const GByte*& pabyData,
+                                   const GByte* pabyEnd,
+                                   OGRBTreeKey& sKey ) const
+{
+    if( eKeyType == OBKT_STRING )
+    {
+        if( pabyData >= pabyEnd || pabyData + 1 + *pabyData > pabyEnd )
+            return false;
+        const size_t nLen = *pabyData;
+        pabyData++;
+        sKey.osStr.assign( reinterpret_cast<const char*>(pabyData), nLen );
+        pabyData += nLen;
+        return true;
+    }
+
+    if( pabyData + 8 > pabyEnd )
+        return false;
+    const GUIntBig nVal = OGRBTreeGetUInt64( pabyData );
+    if( eKeyType == OBKT_INTEGER )
+        sKey.nInt = static_cast<GIntBig>(nVal);
+    else
+        memcpy( &sKey.dfReal, &nVal, sizeof(nVal) );
+    return true;
+}
+
+/************************************************************************/
+/*                              ReadPage()                              */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::ReadPage( GUInt32 nPage, GByte* pabyPage,
+                                  int& nLevel, int& nCount,
+                                  GUInt32& nNextPage )
+{
+    VSILFILE *fp = poLIndex->fp;
+    if( fp == nullptr || nPage >= nPageCount ||
+        VSIFSeekL( fp, nFirstPageOffset +
+                   static_cast<vsi_l_offset>(nPage) * OGR_BTREE_PAGE_SIZE,
+                   SEEK_SET ) != 0 ||
+        VSIFReadL( pabyPage, OGR_BTREE_PAGE_SIZE, 1, fp ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot read page %u of index of %s in %s.",
+                  nPage, osFieldName.c_str(), poLIndex->osFilename.c_str() );
+        return false;
+    }
+
+    const GByte *pabyData = pabyPage;
+    nLevel = pabyData[0];
+    pabyData += 2;
+    nCount = OGRBTreeGetUInt16( pabyData );
+    nNextPage = OGRBTreeGetUInt32( pabyData );
+    return true;
+}
+
+/************************************************************************/
+/*                                Scan()                                */
+/*                                                                      */
+/*      Collect the FIDs of the entries whose key is within the         */
+/*      bounds (which may be NULL) and, if posPrefix is set, starts     */
+/*      with it.                                                        */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::Scan( const OGRBTreeKey* psMin, bool bMinIncluded,
+                              const OGRBTreeKey* psMax, bool bMaxIncluded,
+                              const std::string* posPrefix,
+                              std::vector<GIntBig>& anFIDs )
+{
+    if( poLIndex->Flush() != OGRERR_NONE )
+        return false;
+
+    if( nPageCount == 0 )
+        return true;
+
+    std::vector<GByte> abyPage( OGR_BTREE_PAGE_SIZE );
+    const GByte *pabyEnd = abyPage.data() + OGR_BTREE_PAGE_SIZE;
+    int nLevel = 0;
+    int nCount = 0;
+    GUInt32 nNextPage = OGR_BTREE_NO_PAGE;
+    OGRBTreeKey sKey;
+
+/* -------------------------------------------------------------------- */
+/*      Descend to the leaf that may contain the first entry not        */
+/*      lower than the minimum: the last child whose first key is       */
+/*      strictly lower than it, as equal keys may span several leaves.  */
+/* -------------------------------------------------------------------- */
+    GUInt32 nPage = psMin ? nRootPage : 0;
+    for( int iDepth = 0; ; iDepth++ )
+    {
+        if( iDepth == OGR_BTREE_MAX_DEPTH ||
+            !ReadPage( nPage, abyPage.data(), nLevel, nCount, nNextPage ) )
+            return false;
+        if( nLevel == 0 )
+            break;
+
+        const GByte *pabyData = abyPage.data() + OGR_BTREE_PAGE_HEADER_SIZE;
+        GUInt32 nChild = OGR_BTREE_NO_PAGE;
+        for( int i = 0; i < nCount; i++ )
+        {
+            if( !DecodeKey( pabyData, pabyEnd, sKey ) ||
+                pabyData + 4 > pabyEnd )
+                return false;
+            const GUInt32 nCandidate = OGRBTreeGetUInt32( pabyData );
+            if( i > 0 && CompareKeys( sKey, *psMin ) >= 0 )
+                break;
+            nChild = nCandidate;
+        }
+        if( nChild == OGR_BTREE_NO_PAGE )
+            return false;
+        nPage = nChild;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Walk the leaves.                                                */
+/* -------------------------------------------------------------------- */
+    for( GUIntBig nVisited = 0; ; nVisited++ )
+    {
+        const GByte *pabyData = abyPage.data() + OGR_BTREE_PAGE_HEADER_SIZE;
+        for( int i = 0; i < nCount; i++ )
+        {
+            if( !DecodeKey( pabyData, pabyEnd, sKey ) ||
+                pabyData + 8 > pabyEnd )
+                return false;
+            const GIntBig nFID =
+                static_cast<GIntBig>(OGRBTreeGetUInt64( pabyData ));
+
+            if( psMin )
+            {
+                const int nRes = CompareKeys( sKey, *psMin );
+                if( nRes < 0 || (nRes == 0 && !bMinIncluded) )
+                    continue;
+            }
+            if( psMax )
+            {
+                const int nRes = CompareKeys( sKey, *psMax );
+                if( nRes > 0 || (nRes == 0 && !bMaxIncluded) )
+                    return true;
+            }
+            if( posPrefix &&
+                sKey.osStr.compare( 0, posPrefix->size(), *posPrefix ) != 0 )
+                return true;
+
+            anFIDs.push_back( nFID );
+        }
+
+        if( nNextPage == OGR_BTREE_NO_PAGE )
+            return true;
+        if( nVisited == nPageCount ||
+            !ReadPage( nNextPage, abyPage.data(), nLevel, nCount,
+                       nNextPage ) ||
+            nLevel != 0 )
+            return false;
+    }
+}
+
+/************************************************************************/
+/*                           ReadAllEntries()                           */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::ReadAllEntries( std::vector<OGRBTreeEntry>& aoEntries )
+{
+    if( nPageCount == 0 )
+        return true;
+
+    std::vector<GByte> abyPage( OGR_BTREE_PAGE_SIZE );
+    const GByte *pabyEnd = abyPage.data() + OGR_BTREE_PAGE_SIZE;
+    int nLevel = 0;
+    int nCount = 0;
+    GUInt32 nNextPage = 0;
+    for( GUIntBig nVisited = 0; nNextPage != OGR_BTREE_NO_PAGE; nVisited++ )
+    {
+        if( nVisited == nPageCount ||
+            !ReadPage( nNextPage, abyPage.data(), nLevel, nCount,
+                       nNextPage ) ||
+            nLevel != 0 )
+            return false;
+
+        const GByte *pabyData = abyPage.data() + OGR_BTREE_PAGE_HEADER_SIZE;
+        for( int i = 0; i < nCount; i++ )
+        {
+            OGRBTreeEntry sEntry;
+            if( !DecodeKey( pabyData, pabyEnd, sEntry.sKey ) ||
+                pabyData + 8 > pabyEnd )
+                return false;
+            sEntry.nFID = static_cast<GIntBig>(OGRBTreeGetUInt64( pabyData ));
+            aoEntries.push_back( sEntry );
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             WriteTree()                              */
+/*                                                                      */
+/*      Bulk load sorted entries at the current position of fp.         */
+/************************************************************************/
+
+bool OGRBTreeAttrIndex::WriteTree( VSILFILE* fp,
+                                   const std::vector<OGRBTreeEntry>& aoEntries,
+                                   GUInt32& nNewPageCount,
+                                   GUInt32& nNewRootPage )
+{
+    nNewPageCount = 0;
+    nNewRootPage = OGR_BTREE_NO_PAGE;
+    if( aoEntries.empty() )
+        return true;
+
+    struct Separator
+    {
+        const OGRBTreeKey *psKey;
+        GUInt32            nPage;
+    };
+    std::vector<Separator> asSeparators;
+    std::vector<GByte> abyPage( OGR_BTREE_PAGE_SIZE );
+    GUInt32 nPage = 0;
+
+    const auto WritePage = [&abyPage, fp](int nLevel, int nCount,
+                                          GUInt32 nNextPage)
+    {
+        GByte *pabyData = abyPage.data();
+        pabyData[0] = static_cast<GByte>(nLevel);
+        pabyData[1] = 0;
+        pabyData += 2;
+        OGRBTreePutUInt16( pabyData, static_cast<GUInt16>(nCount) );
+        OGRBTreePutUInt32( pabyData, nNextPage );
+        return VSIFWriteL( abyPage.data(), OGR_BTREE_PAGE_SIZE, 1, fp ) == 1;
+    };
+
+/* -------------------------------------------------------------------- */
+/*      Leaves.                                                         */
+/* -------------------------------------------------------------------- */
+    for( size_t i = 0; i < aoEntries.size(); )
+    {
+        memset( abyPage.data(), 0, OGR_BTREE_PAGE_SIZE );
+        GByte *pabyData = abyPage.data() + OGR_BTREE_PAGE_HEADER_SIZE;
+        const GByte *pabyEnd = abyPage.data() + OGR_BTREE_PAGE_SIZE;
+        asSeparators.push_back( Separator{ &aoEntries[i].sKey, nPage } );
+        int nCount = 0;
+        while( i < aoEntries.size() && nCount < 65535 &&
+               pabyData + GetKeySize(aoEntries[i].sKey) + 8 <= pabyEnd )
+        {
+            EncodeKey( pabyData, aoEntries[i].sKey );
+            OGRBTreePutUInt64( pabyData,
+                               static_cast<GUIntBig>(aoEntries[i].nFID) );
+            nCount++;
+            i++;
+        }
+        if( !WritePage( 0, nCount,
+                        i < aoEntries.size() ? nPage + 1 : OGR_BTREE_NO_PAGE ) )
+            return false;
+        nPage++;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Internal levels, until there is a single root page.             */
+/* -------------------------------------------------------------------- */
+    for( int nLevel = 1; asSeparators.size() > 1; nLevel++ )
+    {
+        if( nLevel > 255 )
+            return false;
+        std::vector<Separator> asParentSeparators;
+        for( size_t i = 0; i < asSeparators.size(); )
+        {
+            memset( abyPage.data(), 0, OGR_BTREE_PAGE_SIZE );
+            GByte *pabyData = abyPage.data() + OGR_BTREE_PAGE_HEADER_SIZE;
+            const GByte *pabyEnd = abyPage.data() + OGR_BTREE_PAGE_SIZE;
+            asParentSeparators.push_back(
+                Separator{ asSeparators[i].psKey, nPage } );
+            int nCount = 0;
+            // At least two children per page, so that the tree converges.
+            while( i < asSeparators.size() && nCount < 65535 &&
+                   (nCount < 2 ||
+                    pabyData + GetKeySize(*asSeparators[i].psKey) + 4 <=
+                                                                pabyEnd) )
+            {
+                EncodeKey( pabyData, *asSeparators[i].psKey );
+                OGRBTreePutUInt32( pabyData, asSeparators[i].nPage );
+                nCount++;
+                i++;
+            }
+            if( !WritePage( nLevel, nCount, OGR_BTREE_NO_PAGE ) )
+                return false;
+            nPage++;
+        }
+        asSeparators = std::move(asParentSeparators);
+    }
+
+    nNewPageCount = nPage;
+    nNewRootPage = asSeparators[0].nPage;
+    return true;
+}
+
+/************************************************************************/
+/*                             ToFIDList()                              */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::ToFIDList( std::vector<GIntBig>& anFIDs,
+                                       GIntBig *pnFIDCount )
+{
+    std::sort( anFIDs.begin(), anFIDs.end() );
+    anFIDs.erase( std::unique( anFIDs.begin(), anFIDs.end() ), anFIDs.end() );
+
+    GIntBig *panFIDList = static_cast<GIntBig *>(
+        VSI_MALLOC2_VERBOSE( anFIDs.size() + 1, sizeof(GIntBig) ) );
+    if( panFIDList == nullptr )
+        return nullptr;
+    if( !anFIDs.empty() )
+        memcpy( panFIDList, anFIDs.data(), anFIDs.size() * sizeof(GIntBig) );
+    panFIDList[anFIDs.size()] = OGRNullFID;
+    if( pnFIDCount )
+        *pnFIDCount = static_cast<GIntBig>(anFIDs.size());
+    return panFIDList;
+}
+
+/************************************************************************/
+/*                              AddEntry()                              */
+/*                                                                      */
+/*      Entries are accumulated in memory, and the tree is rebuilt      */
+/*      when it is next written or queried.                             */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::AddEntry( OGRField *psKey, GIntBig nFID )
+
+{
+    if( psKey == nullptr )
+        return OGRERR_FAILURE;
+
+    OGRBTreeEntry sEntry;
+    if( !BuildKey( psKey, sEntry.sKey ) )
+        return OGRERR_NONE;
+    sEntry.nFID = nFID;
+
+    try
+    {
+        aoPending.push_back( sEntry );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Out of memory while indexing %s", osFieldName.c_str() );
+        return OGRERR_NOT_ENOUGH_MEMORY;
+    }
+    bDirty = true;
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            RemoveEntry()                             */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::RemoveEntry( OGRField * /*psKey*/, GIntBig /*nFID*/ )
+
+{
+    return OGRERR_UNSUPPORTED_OPERATION;
+}
+
+/************************************************************************/
+/*                           GetFirstMatch()                            */
+/************************************************************************/
+
+GIntBig OGRBTreeAttrIndex::GetFirstMatch( OGRField *psKey )
+
+{
+    int nFIDCount = 0;
+    int nLength = 0;
+    GIntBig *panFIDs = GetAllMatches( psKey, nullptr, &nFIDCount, &nLength );
+    const GIntBig nFID = panFIDs ? panFIDs[0] : OGRNullFID;
+    CPLFree( panFIDs );
+    return nFID;
+}
+
+/************************************************************************/
+/*                           GetAllMatches()                            */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::GetAllMatches( OGRField *psKey,
+                                           GIntBig* panFIDList,
+                                           int* nFIDCount, int* nLength )
+{
+    OGRBTreeKey sKey;
+    std::vector<GIntBig> anFIDs;
+    if( BuildKey( psKey, sKey ) &&
+        !Scan( &sKey, true, &sKey, true, nullptr, anFIDs ) )
+    {
+        CPLFree( panFIDList );
+        return nullptr;
+    }
+
+    if( panFIDList == nullptr )
+    {
+        *nFIDCount = 0;
+        *nLength = 0;
+    }
+    if( anFIDs.size() >= static_cast<size_t>(INT_MAX - 1 - *nFIDCount) )
+    {
+        CPLFree( panFIDList );
+        return nullptr;
+    }
+    const int nNeeded = *nFIDCount + static_cast<int>(anFIDs.size()) + 1;
+    if( nNeeded > *nLength )
+    {
+        *nLength = nNeeded;
+        panFIDList = static_cast<GIntBig *>(
+            CPLRealloc(panFIDList, sizeof(GIntBig) * (*nLength)));
+    }
+    for( const GIntBig nFID : anFIDs )
+        panFIDList[(*nFIDCount)++] = nFID;
+    panFIDList[*nFIDCount] = OGRNullFID;
+
+    return panFIDList;
+}
+
+GIntBig *OGRBTreeAttrIndex::GetAllMatches( OGRField *psKey )
+{
+    int nFIDCount, nLength;
+    return GetAllMatches( psKey, nullptr, &nFIDCount, &nLength );
+}
+
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::GetRangeMatches( OGRField *psMin,
+                                             bool bMinIncluded,
+                                             OGRField *psMax,
+                                             bool bMaxIncluded,
+                                             GIntBig *pnFIDCount )
+{
+    OGRBTreeKey sMin;
+    OGRBTreeKey sMax;
+    if( (psMin && !BuildKey( psMin, sMin )) ||
+        (psMax && !BuildKey( psMax, sMax )) )
+        return nullptr;
+
+    // Truncated string keys lose the exclusive bounds and the upper bound.
+    if( eKeyType == OBKT_STRING )
+    {
+        bMinIncluded = true;
+        if( psMax && strlen(psMax->String) >= OGR_BTREE_MAX_STRING_KEY )
+            psMax = nullptr;
+    }
+
+    std::vector<GIntBig> anFIDs;
+    if( !Scan( psMin ? &sMin : nullptr, bMinIncluded,
+               psMax ? &sMax : nullptr, bMaxIncluded, nullptr, anFIDs ) )
+        return nullptr;
+    return ToFIDList( anFIDs, pnFIDCount );
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/************************************************************************/
+
+GIntBig *OGRBTreeAttrIndex::GetPrefixMatches( const char *pszPrefix,
+                                              GIntBig *pnFIDCount )
+{
+    if( eKeyType != OBKT_STRING )
+        return nullptr;
+
+    OGRBTreeKey sMin;
+    sMin.osStr = FoldString( pszPrefix );
+
+    std::vector<GIntBig> anFIDs;
+    if( !Scan( &sMin, true, nullptr, false, &sMin.osStr, anFIDs ) )
+        return nullptr;
+    return ToFIDList( anFIDs, pnFIDCount );
+}
+
+/************************************************************************/
+/*                               Clear()                                */
+/************************************************************************/
+
+OGRErr OGRBTreeAttrIndex::Clear()
+
+{
+    nEntries = 0;
+    nPageCount = 0;
+    nRootPage = OGR_BTREE_NO_PAGE;
+    aoPending.clear();
+    bDirty = true;
+    return poLIndex->Flush();
+}
+
+//! @endcond
@@ -33,7 +33,13 @@
 #include "cpl_string.h"
 #include "ogr_api.h"
 #include "cpl_time.h"
+#include "cpl_worker_thread_pool.h"
 #include <algorithm>
+#include <limits>
+#include <new>
+#include <queue>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 //! @cond Doxygen_Suppress
@@ -81,6 +87,49 @@ int OGRGenSQLResultsLayerHasSpecialField(swq_expr_node* expr,
     return FALSE;
 }
 
+/************************************************************************/
+/*                          OGRGenSQLJoinHash                           */
+/************************************************************************/
+
+// In-memory hash table of the features of a secondary table, keyed on the
+// field of a "primary.field = secondary.field" join condition, so that the
+// join does not issue one attribute query per primary feature.
+// As with the attribute filter it replaces, only the first secondary
+// feature for a given key is retained, and string keys are compared case
+// insensitively, as the OGR SQL = operator does.
+
+struct OGRGenSQLJoinHash
+{
+    bool        bUsable = false;
+    int         iPrimaryField = -1;
+    bool        bStringKey = false;
+    std::unordered_map<GIntBig, OGRFeature*> oMapInteger{};
+    std::unordered_map<std::string, OGRFeature*> oMapString{};
+
+    OGRGenSQLJoinHash() = default;
+    ~OGRGenSQLJoinHash() { Clear(); }
+
+    void Clear()
+    {
+        for( auto& oIter : oMapInteger )
+            delete oIter.second;
+        oMapInteger.clear();
+        for( auto& oIter : oMapString )
+            delete oIter.second;
+        oMapString.clear();
+    }
+
+    static std::string GetStringKey( const char* pszValue )
+    {
+        std::string osKey(pszValue);
+        for( char& ch : osKey )
+            ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+        return osKey;
+    }
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLJoinHash)
+};
+
 /************************************************************************/
 /*                       OGRGenSQLResultsLayer()                        */
 /************************************************************************/
@@ -100,13 +149,15 @@ OGRGenSQLResultsLayer::OGRGenSQLResultsLayer( GDALDataset *poSrcDSIn,
     nIndexSize(0),
     panFIDIndex(nullptr),
     bOrderByValid(FALSE),
+    m_apoOrderKeyFieldDefn(),
     nNextIndexFID(0),
     poSummaryFeature(nullptr),
     iFIDFieldIndex(),
     nExtraDSCount(0),
     papoExtraDS(nullptr),
     nIteratedFeatures(-1),
-    m_oDistinctList{}
+    m_oDistinctList{},
+    m_apoJoinHash()
 {
     swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfoIn);
 
@@ -512,6 +563,12 @@ OGRGenSQLResultsLayer::~OGRGenSQLResultsLayer()
 /* -------------------------------------------------------------------- */
 /*      Free various datastructures.                                    */
 /* -------------------------------------------------------------------- */
+    // Before the joined datasources are closed, as they own the layer
+    // definitions of the cached features.
+    for( OGRGenSQLJoinHash* poHash : m_apoJoinHash )
+        delete poHash;
+    m_apoJoinHash.clear();
+
     CPLFree( papoTableLayers );
     papoTableLayers = nullptr;
 
@@ -1271,6 +1328,184 @@ static CPLString GetFilterForJoin(swq_expr_node* poExpr, OGRFeature* poSrcFeat,
     return "";
 }
 
+/************************************************************************/
+/*                            GetJoinHash()                             */
+/*                                                                      */
+/*      Build on first use the hash table of the secondary table of     */
+/*      the given join, when the join condition is an equality          */
+/*      between two fields of compatible types.                         */
+/************************************************************************/
+
+OGRGenSQLJoinHash *OGRGenSQLResultsLayer::GetJoinHash( int iJoin )
+{
+    swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfo);
+
+    if( m_apoJoinHash.empty() )
+        m_apoJoinHash.resize(psSelectInfo->join_count, nullptr);
+    if( m_apoJoinHash[iJoin] != nullptr )
+        return m_apoJoinHash[iJoin]->bUsable ? m_apoJoinHash[iJoin] : nullptr;
+
+    OGRGenSQLJoinHash *poHash = new OGRGenSQLJoinHash();
+    m_apoJoinHash[iJoin] = poHash;
+
+    if( !CPLTestBool(CPLGetConfigOption("OGR_SQL_HASH_JOIN", "YES")) )
+        return nullptr;
+
+    swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
+    OGRLayer *poJoinLayer = papoTableLayers[psJoinInfo->secondary_table];
+    const swq_expr_node *poExpr = psJoinInfo->poExpr;
+
+    // Reading the secondary table would disturb the iteration of the
+    // primary one in a self join.
+    if( poJoinLayer == poSrcLayer )
+        return nullptr;
+
+    if( poExpr == nullptr ||
+        poExpr->eNodeType != SNT_OPERATION ||
+        poExpr->nOperation != SWQ_EQ ||
+        poExpr->nSubExprCount != 2 ||
+        poExpr->papoSubExpr[0]->eNodeType != SNT_COLUMN ||
+        poExpr->papoSubExpr[1]->eNodeType != SNT_COLUMN )
+        return nullptr;
+
+    const swq_expr_node *poPrimary = poExpr->papoSubExpr[0];
+    const swq_expr_node *poSecondary = poExpr->papoSubExpr[1];
+    if( poPrimary->table_index != 0 )
+        std::swap(poPrimary, poSecondary);
+    if( poPrimary->table_index != 0 ||
+        poSecondary->table_index != psJoinInfo->secondary_table )
+        return nullptr;
+
+    OGRFeatureDefn *poSrcDefn = poSrcLayer->GetLayerDefn();
+    OGRFeatureDefn *poJoinDefn = poJoinLayer->GetLayerDefn();
+    if( poPrimary->field_index < 0 ||
+        poPrimary->field_index >= poSrcDefn->GetFieldCount() ||
+        poSecondary->field_index < 0 ||
+        poSecondary->field_index >= poJoinDefn->GetFieldCount() )
+        return nullptr;
+
+    const OGRFieldType ePrimaryType =
+        poSrcDefn->GetFieldDefn(poPrimary->field_index)->GetType();
+    const OGRFieldType eSecondaryType =
+        poJoinDefn->GetFieldDefn(poSecondary->field_index)->GetType();
+    const bool bPrimaryInt =
+        ePrimaryType == OFTInteger || ePrimaryType == OFTInteger64;
+    const bool bSecondaryInt =
+        eSecondaryType == OFTInteger || eSecondaryType == OFTInteger64;
+    if( bPrimaryInt && bSecondaryInt )
+        poHash->bStringKey = false;
+    else if( ePrimaryType == OFTString && eSecondaryType == OFTString )
+        poHash->bStringKey = true;
+    else
+        return nullptr;
+
+    const GIntBig nMaxFeatures = CPLAtoGIntBig(
+        CPLGetConfigOption("OGR_SQL_HASH_JOIN_MAX_FEATURES", "1000000"));
+    const GIntBig nFeatureCount = poJoinLayer->GetFeatureCount(FALSE);
+    if( nFeatureCount > nMaxFeatures )
+        return nullptr;
+
+/* -------------------------------------------------------------------- */
+/*      Load the secondary table.                                       */
+/* -------------------------------------------------------------------- */
+    const int iSecondaryField = poSecondary->field_index;
+    GIntBig nFeatures = 0;
+
+    poJoinLayer->SetAttributeFilter( "" );
+    poJoinLayer->ResetReading();
+    OGRFeature *poJoinFeature = nullptr;
+    while( (poJoinFeature = poJoinLayer->GetNextFeature()) != nullptr )
+    {
+        if( !poJoinFeature->IsFieldSetAndNotNull(iSecondaryField) )
+        {
+            delete poJoinFeature;
+            continue;
+        }
+
+        if( ++nFeatures > nMaxFeatures )
+        {
+            CPLDebug("GenSQL", "More than " CPL_FRMT_GIB " features in %s: "
+                     "not using a hash join", nMaxFeatures,
+                     poJoinDefn->GetName());
+            delete poJoinFeature;
+            poHash->Clear();
+            poJoinLayer->ResetReading();
+            return nullptr;
+        }
+
+        // Keep the first feature of a key, as GetNextFeature() on the
+        // filtered secondary layer would return.
+        bool bInserted;
+        if( poHash->bStringKey )
+        {
+            bInserted = poHash->oMapString.insert(std::make_pair(
+                OGRGenSQLJoinHash::GetStringKey(
+                    poJoinFeature->GetFieldAsString(iSecondaryField)),
+                poJoinFeature)).second;
+        }
+        else
+        {
+            bInserted = poHash->oMapInteger.insert(std::make_pair(
+                poJoinFeature->GetFieldAsInteger64(iSecondaryField),
+                poJoinFeature)).second;
+        }
+        if( !bInserted )
+            delete poJoinFeature;
+    }
+    poJoinLayer->ResetReading();
+
+    poHash->iPrimaryField = poPrimary->field_index;
+    poHash->bUsable = true;
+    return poHash;
+}
+
+/************************************************************************/
+/*                           LookupJoinHash()                           */
+/*                                                                      */
+/*      Returns false if the hash table cannot be used for this         */
+/*      feature, in which case the attribute filter must be used.       */
+/*      The returned feature remains owned by the hash table.           */
+/************************************************************************/
+
+bool OGRGenSQLResultsLayer::LookupJoinHash( int iJoin, OGRFeature* poSrcFeat,
+                                            OGRFeature** ppoJoinFeature )
+{
+    *ppoJoinFeature = nullptr;
+
+    OGRGenSQLJoinHash *poHash = GetJoinHash(iJoin);
+    if( poHash == nullptr )
+        return false;
+
+    // If source key is null, we can't do join.
+    if( !poSrcFeat->IsFieldSetAndNotNull(poHash->iPrimaryField) )
+        return true;
+
+    if( poHash->bStringKey )
+    {
+        // The = operator has special rules for strings looking like
+        // timestamps with or without time zone: let it deal with them.
+        const char* pszValue =
+            poSrcFeat->GetFieldAsString(poHash->iPrimaryField);
+        const size_t nLen = strlen(pszValue);
+        if( nLen > 3 && (pszValue[nLen - 3] == ':' ||
+                         strcmp(pszValue + nLen - 3, "+00") == 0) )
+            return false;
+
+        auto oIter =
+            poHash->oMapString.find(OGRGenSQLJoinHash::GetStringKey(pszValue));
+        if( oIter != poHash->oMapString.end() )
+            *ppoJoinFeature = oIter->second;
+    }
+    else
+    {
+        auto oIter = poHash->oMapInteger.find(
+            poSrcFeat->GetFieldAsInteger64(poHash->iPrimaryField));
+        if( oIter != poHash->oMapInteger.end() )
+            *ppoJoinFeature = oIter->second;
+    }
+    return true;
+}
+
 /************************************************************************/
 /*                          TranslateFeature()                          */
 /************************************************************************/
@@ -1280,6 +1515,9 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
 {
     swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfo);
     std::vector<OGRFeature*> apoFeatures;
+    // Whether the secondary features must be deleted once used, which is
+    // not the case for the ones owned by a join hash table.
+    std::vector<bool> abOwnedFeatures;
 
     if( poSrcFeat == nullptr )
         return nullptr;
@@ -1302,6 +1540,14 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
         /* we have taken care of this */
         CPLAssert(psJoinInfo->secondary_table == iJoin + 1);
 
+        OGRFeature *poHashFeature = nullptr;
+        if( LookupJoinHash( iJoin, poSrcFeat, &poHashFeature ) )
+        {
+            apoFeatures.push_back( poHashFeature );
+            abOwnedFeatures.push_back( false );
+            continue;
+        }
+
         OGRLayer *poJoinLayer = papoTableLayers[psJoinInfo->secondary_table];
 
         osFilter = GetFilterForJoin(psJoinInfo->poExpr, poSrcFeat, poJoinLayer,
@@ -1312,6 +1558,7 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
         if( osFilter.empty() )
         {
             apoFeatures.push_back( nullptr );
+            abOwnedFeatures.push_back( true );
             continue;
         }
 
@@ -1322,6 +1569,7 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
             poJoinFeature = poJoinLayer->GetNextFeature();
 
         apoFeatures.push_back( poJoinFeature );
+        abOwnedFeatures.push_back( true );
     }
 
 /* -------------------------------------------------------------------- */
@@ -1541,7 +1789,8 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
             iRegularField ++;
         }
 
-        delete poJoinFeature;
+        if( abOwnedFeatures[iJoin] )
+            delete poJoinFeature;
     }
 
     return poDstFeat;
@@ -1809,8 +2058,7 @@ void OGRGenSQLResultsLayer::FreeIndexFields(OGRField *pasIndexFields,
             continue;
         }
 
-        OGRFieldDefn *poFDefn =
-            poSrcLayer->GetLayerDefn()->GetFieldDefn( psKeyDef->field_index );
+        OGRFieldDefn *poFDefn = m_apoOrderKeyFieldDefn[iKey];
 
         if( poFDefn->GetType() == OFTString )
         {
@@ -1898,6 +2146,314 @@ void OGRGenSQLResultsLayer::ReadIndexFields( OGRFeature* poSrcFeat,
     }
 }
 
+/************************************************************************/
+/*                          OGRGenSQLSortRun                            */
+/************************************************************************/
+
+// A section of the ORDER BY keys, sorted by a worker thread and written
+// to a temporary file, to be merged afterwards with the other runs.
+// Each record of the file is made of the read sequence number, the FID,
+// then for each key its raw OGRField followed, for string values, by the
+// string length and bytes.
+
+struct OGRGenSQLSortRun
+{
+    OGRGenSQLResultsLayer *poLayer = nullptr;
+
+    OGRField   *pasIndexFields = nullptr;
+    GIntBig    *panFIDList = nullptr;
+    size_t      nSize = 0;
+    GUIntBig    nFirstSeq = 0;
+
+    CPLString   osFilename{};
+    VSILFILE   *fp = nullptr;
+    bool        bOK = true;
+
+    // Current record while merging.
+    OGRField   *pasCurFields = nullptr;
+    GUIntBig    nCurSeq = 0;
+    GIntBig     nCurFID = 0;
+    size_t      nRemaining = 0;
+};
+
+/************************************************************************/
+/*                         OrderKeyHasString()                          */
+/*                                                                      */
+/*      Whether the key value owns a string that must be freed (and     */
+/*      serialized when spilling a run).                                */
+/************************************************************************/
+
+bool OGRGenSQLResultsLayer::OrderKeyHasString( int iKey,
+                                               const OGRField* psField ) const
+{
+    const swq_select *psSelectInfo =
+        static_cast<const swq_select*>(pSelectInfo);
+    const swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+
+    if( psKeyDef->field_index >= iFIDFieldIndex )
+        return SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex] ==
+                                                                SWQ_STRING;
+
+    return m_apoOrderKeyFieldDefn[iKey]->GetType() == OFTString &&
+           !OGR_RawField_IsUnset(psField) &&
+           !OGR_RawField_IsNull(psField);
+}
+
+/************************************************************************/
+/*                        GetIndexFieldsSize()                          */
+/*                                                                      */
+/*      Approximate memory used by the keys and FID of one feature.     */
+/************************************************************************/
+
+size_t OGRGenSQLResultsLayer::GetIndexFieldsSize(
+                                    const OGRField *pasIndexFields ) const
+{
+    const int nOrderItems =
+        static_cast<const swq_select*>(pSelectInfo)->order_specs;
+    size_t nSize = sizeof(OGRField) * nOrderItems + sizeof(GIntBig);
+    for( int iKey = 0; iKey < nOrderItems; iKey++ )
+    {
+        if( OrderKeyHasString(iKey, pasIndexFields + iKey) )
+            nSize += strlen(pasIndexFields[iKey].String) + 1;
+    }
+    return nSize;
+}
+
+/************************************************************************/
+/*                          SortAndWriteRun()                           */
+/************************************************************************/
+
+bool OGRGenSQLResultsLayer::SortAndWriteRun( OGRGenSQLSortRun* psRun )
+{
+    const int nOrderItems =
+        static_cast<swq_select*>(pSelectInfo)->order_specs;
+    const OGRField *pasIndexFields = psRun->pasIndexFields;
+
+    std::vector<size_t> anOrder;
+    try
+    {
+        anOrder.resize(psRun->nSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        return false;
+    }
+    for( size_t i = 0; i < psRun->nSize; i++ )
+        anOrder[i] = i;
+
+    // Stable, as SortIndexSection(), so that features with equal keys
+    // keep their source order.
+    std::stable_sort(anOrder.begin(), anOrder.end(),
+        [this, pasIndexFields, nOrderItems](size_t a, size_t b)
+        {
+            return Compare(pasIndexFields + a * nOrderItems,
+                           pasIndexFields + b * nOrderItems) < 0;
+        });
+
+    psRun->fp = VSIFOpenL(psRun->osFilename, "wb+");
+    if( psRun->fp == nullptr )
+        return false;
+
+    bool bOK = true;
+    for( size_t i = 0; bOK && i < psRun->nSize; i++ )
+    {
+        const size_t iEntry = anOrder[i];
+        const GUIntBig nSeq = psRun->nFirstSeq + iEntry;
+        const GIntBig nFID = psRun->panFIDList[iEntry];
+        bOK = VSIFWriteL(&nSeq, sizeof(nSeq), 1, psRun->fp) == 1 &&
+              VSIFWriteL(&nFID, sizeof(nFID), 1, psRun->fp) == 1;
+        for( int iKey = 0; bOK && iKey < nOrderItems; iKey++ )
+        {
+            const OGRField *psField =
+                pasIndexFields + iEntry * nOrderItems + iKey;
+            bOK = VSIFWriteL(psField, sizeof(OGRField), 1, psRun->fp) == 1;
+            if( bOK && OrderKeyHasString(iKey, psField) )
+            {
+                const GUInt32 nLen =
+                    static_cast<GUInt32>(strlen(psField->String));
+                bOK = VSIFWriteL(&nLen, sizeof(nLen), 1, psRun->fp) == 1 &&
+                      VSIFWriteL(psField->String, 1, nLen,
+                                 psRun->fp) == nLen;
+            }
+        }
+    }
+
+    FreeIndexFields( psRun->pasIndexFields, psRun->nSize );
+    psRun->pasIndexFields = nullptr;
+    CPLFree( psRun->panFIDList );
+    psRun->panFIDList = nullptr;
+
+    return bOK;
+}
+
+/************************************************************************/
+/*                        SortAndWriteRunFunc()                         */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::SortAndWriteRunFunc( void* pData )
+{
+    OGRGenSQLSortRun *psRun = static_cast<OGRGenSQLSortRun*>(pData);
+    psRun->bOK = psRun->poLayer->SortAndWriteRun(psRun);
+}
+
+/************************************************************************/
+/*                           ReadRunRecord()                            */
+/*                                                                      */
+/*      Read the next record of a run into pasCurFields. Returns        */
+/*      false at the end of the run or on error (then bOK is unset).    */
+/************************************************************************/
+
+bool OGRGenSQLResultsLayer::ReadRunRecord( OGRGenSQLSortRun* psRun )
+{
+    const int nOrderItems =
+        static_cast<swq_select*>(pSelectInfo)->order_specs;
+
+    FreeIndexFields( psRun->pasCurFields, 1, false );
+    memset( psRun->pasCurFields, 0, sizeof(OGRField) * nOrderItems );
+
+    if( psRun->nRemaining == 0 )
+        return false;
+    psRun->nRemaining--;
+
+    if( VSIFReadL(&psRun->nCurSeq, sizeof(GUIntBig), 1, psRun->fp) != 1 ||
+        VSIFReadL(&psRun->nCurFID, sizeof(GIntBig), 1, psRun->fp) != 1 )
+    {
+        psRun->bOK = false;
+        return false;
+    }
+
+    for( int iKey = 0; iKey < nOrderItems; iKey++ )
+    {
+        OGRField *psField = psRun->pasCurFields + iKey;
+        OGRField sRawField;
+        if( VSIFReadL(&sRawField, sizeof(OGRField), 1, psRun->fp) != 1 )
+        {
+            psRun->bOK = false;
+            return false;
+        }
+        if( !OrderKeyHasString(iKey, &sRawField) )
+        {
+            memcpy( psField, &sRawField, sizeof(OGRField) );
+            continue;
+        }
+
+        // The serialized pointer is meaningless: read the string itself.
+        GUInt32 nLen = 0;
+        if( VSIFReadL(&nLen, sizeof(nLen), 1, psRun->fp) != 1 )
+        {
+            psRun->bOK = false;
+            return false;
+        }
+        char *pszStr = static_cast<char*>(
+            VSI_MALLOC_VERBOSE(static_cast<size_t>(nLen) + 1));
+        if( pszStr == nullptr ||
+            VSIFReadL(pszStr, 1, nLen, psRun->fp) != nLen )
+        {
+            CPLFree(pszStr);
+            psRun->bOK = false;
+            return false;
+        }
+        pszStr[nLen] = '\0';
+        psField->String = pszStr;
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                          MergeSortedRuns()                           */
+/*                                                                      */
+/*      k-way merge of the sorted runs into panFIDIndex.                */
+/************************************************************************/
+
+bool OGRGenSQLResultsLayer::MergeSortedRuns(
+                            const std::vector<OGRGenSQLSortRun*>& apsRuns,
+                            bool& bAlreadySorted )
+{
+    const int nOrderItems =
+        static_cast<swq_select*>(pSelectInfo)->order_specs;
+
+    panFIDIndex = static_cast<GIntBig *>(
+        VSI_MALLOC_VERBOSE(sizeof(GIntBig) * nIndexSize));
+    if( panFIDIndex == nullptr )
+        return false;
+
+    // Top of the heap is the smallest key, ties being broken by the read
+    // sequence number to preserve the stability of the sort.
+    const auto cmp = [this](const OGRGenSQLSortRun* a,
+                            const OGRGenSQLSortRun* b)
+    {
+        const int nRes = Compare(a->pasCurFields, b->pasCurFields);
+        return nRes > 0 || (nRes == 0 && a->nCurSeq > b->nCurSeq);
+    };
+    std::priority_queue<OGRGenSQLSortRun*,
+                        std::vector<OGRGenSQLSortRun*>,
+                        decltype(cmp)> oHeap(cmp);
+
+    for( OGRGenSQLSortRun* psRun : apsRuns )
+    {
+        psRun->pasCurFields = static_cast<OGRField *>(
+                                CPLCalloc(sizeof(OGRField), nOrderItems));
+        psRun->nRemaining = psRun->nSize;
+        if( VSIFSeekL(psRun->fp, 0, SEEK_SET) != 0 )
+            psRun->bOK = false;
+        else if( ReadRunRecord(psRun) )
+            oHeap.push(psRun);
+    }
+
+    size_t i = 0;
+    while( !oHeap.empty() && i < nIndexSize )
+    {
+        OGRGenSQLSortRun* psRun = oHeap.top();
+        oHeap.pop();
+        if( psRun->nCurSeq != i )
+            bAlreadySorted = false;
+        panFIDIndex[i++] = psRun->nCurFID;
+        if( ReadRunRecord(psRun) )
+            oHeap.push(psRun);
+    }
+
+    bool bOK = (i == nIndexSize && oHeap.empty());
+    for( const OGRGenSQLSortRun* psRun : apsRuns )
+    {
+        if( !psRun->bOK )
+            bOK = false;
+    }
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Error while reading temporary ORDER BY sort files");
+        VSIFree(panFIDIndex);
+        panFIDIndex = nullptr;
+    }
+    return bOK;
+}
+
+/************************************************************************/
+/*                           FreeSortRuns()                             */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::FreeSortRuns(
+                                    std::vector<OGRGenSQLSortRun*>& apsRuns )
+{
+    for( OGRGenSQLSortRun* psRun : apsRuns )
+    {
+        if( psRun->pasIndexFields )
+            psRun->poLayer->FreeIndexFields( psRun->pasIndexFields,
+                                             psRun->nSize );
+        if( psRun->pasCurFields )
+            psRun->poLayer->FreeIndexFields( psRun->pasCurFields, 1 );
+        CPLFree( psRun->panFIDList );
+        if( psRun->fp )
+        {
+            VSIFCloseL(psRun->fp);
+            VSIUnlink(psRun->osFilename);
+        }
+        delete psRun;
+    }
+    apsRuns.clear();
+}
+
 /************************************************************************/
 /*                         CreateOrderByIndex()                         */
 /*                                                                      */
@@ -1907,12 +2463,14 @@ void OGRGenSQLResultsLayer::ReadIndexFields( OGRFeature* poSrcFeat,
 /*                                                                      */
 /*      This is accomplished by making one pass through all the         */
 /*      eligible source features, and capturing the order by fields     */
-/*      of all records in memory.  A quick sort is then applied to      */
+/*      of all records in memory.  A merge sort is then applied to      */
 /*      this in memory copy of the order-by fields to create the        */
 /*      required index.                                                 */
 /*                                                                      */
-/*      Keeping all the key values in memory will *not* scale up to     */
-/*      very large input datasets.                                      */
+/*      When the keys do not fit in OGR_SQL_SORT_MAX_MEMORY, they are   */
+/*      sorted by sections (potentially in GDAL_NUM_THREADS threads)    */
+/*      written to temporary files, which are then merged.  Only the    */
+/*      final FID index is kept in memory in that case.                 */
 /************************************************************************/
 
 void OGRGenSQLResultsLayer::CreateOrderByIndex()
@@ -1933,6 +2491,15 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 
     ResetReading();
 
+    m_apoOrderKeyFieldDefn.resize(nOrderItems);
+    for( int iKey = 0; iKey < nOrderItems; iKey++ )
+    {
+        const swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+        m_apoOrderKeyFieldDefn[iKey] =
+            psKeyDef->field_index >= iFIDFieldIndex ? nullptr :
+            poSrcLayer->GetLayerDefn()->GetFieldDefn(psKeyDef->field_index);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Optimize (memory-wise) ORDER BY ... LIMIT 1 [OFFSET 0] case.    */
 /* -------------------------------------------------------------------- */
@@ -1978,6 +2545,39 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
         return;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Establish the memory budget of the keys.  Beyond it, sorted     */
+/*      runs are spilled to temporary files.                            */
+/* -------------------------------------------------------------------- */
+    GIntBig nMaxMemory = 0;
+    const char* pszMaxMemory =
+        CPLGetConfigOption("OGR_SQL_SORT_MAX_MEMORY", nullptr);
+    if( pszMaxMemory != nullptr )
+        nMaxMemory = CPLAtoGIntBig(pszMaxMemory) * 1024 * 1024;
+    else
+    {
+        nMaxMemory = CPLGetUsablePhysicalRAM() / 4;
+        if( nMaxMemory <= 0 )
+            nMaxMemory = static_cast<GIntBig>(1024) * 1024 * 1024;
+    }
+
+    const int nThreads = CPLGetNumThreads();
+
+    // While a section is sorted by a worker, the next one is being
+    // read, so the budget is shared between nThreads + 1 sections.
+    size_t nMaxSectionMemory = 0;
+    if( nMaxMemory > 0 )
+    {
+        nMaxSectionMemory = static_cast<size_t>(std::min(
+            static_cast<GIntBig>(std::numeric_limits<size_t>::max() / 2),
+            std::max(static_cast<GIntBig>(1024 * 1024),
+                     nMaxMemory / (nThreads > 1 ? nThreads + 1 : 1))));
+    }
+
+    std::vector<OGRGenSQLSortRun*> apsRuns;
+    CPLJobQueue *poJobQueue = nullptr;  // in the global worker thread pool
+    bool bRunError = false;
+
 /* -------------------------------------------------------------------- */
 /*      Allocate set of key values, and the output index.               */
 /* -------------------------------------------------------------------- */
@@ -1994,10 +2594,12 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 /* -------------------------------------------------------------------- */
     OGRFeature *poSrcFeat = nullptr;
     nIndexSize = 0;
+    size_t nSectionSize = 0;
+    size_t nSectionMemory = 0;
 
     while( (poSrcFeat = poSrcLayer->GetNextFeature()) != nullptr )
     {
-        if (nIndexSize == nFeaturesAlloc)
+        if (nSectionSize == nFeaturesAlloc)
         {
             GUIntBig nNewFeaturesAlloc = static_cast<GUIntBig>(nFeaturesAlloc)
                                                         + nFeaturesAlloc / 3;
@@ -2009,10 +2611,12 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
             {
                 CPLError(CE_Failure, CPLE_AppDefined,
                          "Cannot allocate pasIndexFields");
-                FreeIndexFields( pasIndexFields, nIndexSize );
+                FreeIndexFields( pasIndexFields, nSectionSize );
                 VSIFree(panFIDList);
                 nIndexSize = 0;
                 delete poSrcFeat;
+                delete poJobQueue;
+                FreeSortRuns( apsRuns );
                 return;
             }
             OGRField* pasNewIndexFields = static_cast<OGRField *>(
@@ -2023,10 +2627,12 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
             {
                 CPLError(CE_Failure, CPLE_AppDefined,
                          "Cannot allocate pasIndexFields");
-                FreeIndexFields( pasIndexFields, nIndexSize );
+                FreeIndexFields( pasIndexFields, nSectionSize );
                 VSIFree(panFIDList);
                 nIndexSize = 0;
                 delete poSrcFeat;
+                delete poJobQueue;
+                FreeSortRuns( apsRuns );
                 return;
             }
             pasIndexFields = pasNewIndexFields;
@@ -2036,79 +2642,194 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
                                     static_cast<size_t>(nNewFeaturesAlloc)));
             if (panNewFIDList == nullptr)
             {
-                FreeIndexFields( pasIndexFields, nIndexSize );
+                FreeIndexFields( pasIndexFields, nSectionSize );
                 VSIFree(panFIDList);
                 nIndexSize = 0;
                 delete poSrcFeat;
+                delete poJobQueue;
+                FreeSortRuns( apsRuns );
                 return;
             }
             panFIDList = panNewFIDList;
 
-            memset(pasIndexFields + nFeaturesAlloc, 0,
+            memset(pasIndexFields + nFeaturesAlloc * nOrderItems, 0,
                    sizeof(OGRField) * nOrderItems *
                    static_cast<size_t>(nNewFeaturesAlloc - nFeaturesAlloc));
 
             nFeaturesAlloc = static_cast<size_t>(nNewFeaturesAlloc);
         }
 
-        ReadIndexFields( poSrcFeat, nOrderItems,
-                         pasIndexFields + nIndexSize * nOrderItems );
+        OGRField *pasFeatureFields =
+            pasIndexFields + nSectionSize * nOrderItems;
+        ReadIndexFields( poSrcFeat, nOrderItems, pasFeatureFields );
 
-        panFIDList[nIndexSize] = poSrcFeat->GetFID();
+        panFIDList[nSectionSize] = poSrcFeat->GetFID();
         delete poSrcFeat;
 
+        nSectionSize++;
         nIndexSize++;
+
+        if( nMaxSectionMemory == 0 )
+            continue;
+        nSectionMemory += GetIndexFieldsSize( pasFeatureFields );
+        if( nSectionMemory < nMaxSectionMemory )
+            continue;
+
+/* -------------------------------------------------------------------- */
+/*      Over budget: hand the section over to be sorted and spilled.    */
+/* -------------------------------------------------------------------- */
+        OGRGenSQLSortRun *psRun = new OGRGenSQLSortRun();
+        psRun->poLayer = this;
+        psRun->pasIndexFields = pasIndexFields;
+        psRun->panFIDList = panFIDList;
+        psRun->nSize = nSectionSize;
+        psRun->nFirstSeq = nIndexSize - nSectionSize;
+        psRun->osFilename = CPLGenerateTempFilename("ogr_sql_sort");
+        apsRuns.push_back(psRun);
+
+        if( apsRuns.size() == 1 )
+        {
+            CPLDebug("GenSQL", "ORDER BY keys exceed %d MB: "
+                     "sorting through temporary files",
+                     static_cast<int>(nMaxMemory / (1024 * 1024)));
+            if( nThreads > 1 )
+            {
+                CPLWorkerThreadPool *poThreadPool =
+                    CPLGetGlobalWorkerThreadPool(nThreads);
+                if( poThreadPool != nullptr )
+                    poJobQueue = poThreadPool->CreateJobQueue().release();
+            }
+        }
+
+        // The section is now owned by the run.
+        pasIndexFields = nullptr;
+        panFIDList = nullptr;
+        nSectionSize = 0;
+
+        // Bound the number of sections in flight.
+        if( poJobQueue )
+            poJobQueue->WaitCompletion(nThreads - 1);
+        if( poJobQueue == nullptr ||
+            !poJobQueue->SubmitJob(SortAndWriteRunFunc, psRun) )
+        {
+            SortAndWriteRunFunc(psRun);
+            if( !psRun->bOK )
+            {
+                bRunError = true;
+                break;
+            }
+        }
+
+        nFeaturesAlloc = 100;
+        nSectionMemory = 0;
+        pasIndexFields = static_cast<OGRField *>(
+            CPLCalloc(sizeof(OGRField), nOrderItems * nFeaturesAlloc));
+        panFIDList = static_cast<GIntBig *>(
+            CPLMalloc(sizeof(GIntBig) * nFeaturesAlloc));
     }
 
     //CPLDebug("GenSQL", "CreateOrderByIndex() = %d features", nIndexSize);
 
+    bool bAlreadySorted = true;
+
 /* -------------------------------------------------------------------- */
-/*      Initialize panFIDIndex                                          */
+/*      External sort: spill the last section and merge the runs.       */
 /* -------------------------------------------------------------------- */
-    panFIDIndex = static_cast<GIntBig *>(
-        VSI_MALLOC_VERBOSE(sizeof(GIntBig) * nIndexSize));
-    if( panFIDIndex == nullptr )
+    if( !apsRuns.empty() )
     {
-        FreeIndexFields( pasIndexFields, nIndexSize );
-        VSIFree(panFIDList);
-        nIndexSize = 0;
-        return;
+        if( !bRunError && nSectionSize > 0 )
+        {
+            OGRGenSQLSortRun *psRun = new OGRGenSQLSortRun();
+            psRun->poLayer = this;
+            psRun->pasIndexFields = pasIndexFields;
+            psRun->panFIDList = panFIDList;
+            psRun->nSize = nSectionSize;
+            psRun->nFirstSeq = nIndexSize - nSectionSize;
+            psRun->osFilename = CPLGenerateTempFilename("ogr_sql_sort");
+            apsRuns.push_back(psRun);
+            if( poJobQueue == nullptr ||
+                !poJobQueue->SubmitJob(SortAndWriteRunFunc, psRun) )
+                SortAndWriteRunFunc(psRun);
+        }
+        else
+        {
+            FreeIndexFields( pasIndexFields, nSectionSize );
+            CPLFree( panFIDList );
+        }
+
+        if( poJobQueue )
+            poJobQueue->WaitCompletion();
+        delete poJobQueue;
+
+        for( const OGRGenSQLSortRun* psRun : apsRuns )
+        {
+            if( !psRun->bOK )
+            {
+                CPLError(CE_Failure, CPLE_FileIO,
+                         "Cannot write temporary ORDER BY sort file %s",
+                         psRun->osFilename.c_str());
+                bRunError = true;
+                break;
+            }
+        }
+
+        if( bRunError || !MergeSortedRuns( apsRuns, bAlreadySorted ) )
+        {
+            FreeSortRuns( apsRuns );
+            nIndexSize = 0;
+            return;
+        }
+        FreeSortRuns( apsRuns );
     }
-    for( size_t i = 0; i < nIndexSize; i++ )
-        panFIDIndex[i] = static_cast<GIntBig>(i);
+    else
+    {
+/* -------------------------------------------------------------------- */
+/*      Initialize panFIDIndex                                          */
+/* -------------------------------------------------------------------- */
+        panFIDIndex = static_cast<GIntBig *>(
+            VSI_MALLOC_VERBOSE(sizeof(GIntBig) * nIndexSize));
+        if( panFIDIndex == nullptr )
+        {
+            FreeIndexFields( pasIndexFields, nIndexSize );
+            VSIFree(panFIDList);
+            nIndexSize = 0;
+            return;
+        }
+        for( size_t i = 0; i < nIndexSize; i++ )
+            panFIDIndex[i] = static_cast<GIntBig>(i);
 
 /* -------------------------------------------------------------------- */
 /*      Quick sort the records.                                         */
 /* -------------------------------------------------------------------- */
 
-    GIntBig *panMerged = static_cast<GIntBig *>(
-        VSI_MALLOC_VERBOSE( sizeof(GIntBig) * nIndexSize ));
-    if( panMerged == nullptr )
-    {
-        FreeIndexFields( pasIndexFields, nIndexSize );
-        VSIFree(panFIDList);
-        nIndexSize = 0;
-        VSIFree(panFIDIndex);
-        panFIDIndex = nullptr;
-        return;
-    }
+        GIntBig *panMerged = static_cast<GIntBig *>(
+            VSI_MALLOC_VERBOSE( sizeof(GIntBig) * nIndexSize ));
+        if( panMerged == nullptr )
+        {
+            FreeIndexFields( pasIndexFields, nIndexSize );
+            VSIFree(panFIDList);
+            nIndexSize = 0;
+            VSIFree(panFIDIndex);
+            panFIDIndex = nullptr;
+            return;
+        }
 
-    SortIndexSection( pasIndexFields, panMerged, 0, nIndexSize );
-    VSIFree( panMerged );
+        SortIndexSection( pasIndexFields, panMerged, 0, nIndexSize );
+        VSIFree( panMerged );
 
 /* -------------------------------------------------------------------- */
 /*      Rework the FID map to map to real FIDs.                         */
 /* -------------------------------------------------------------------- */
-    bool bAlreadySorted = true;
-    for( size_t i = 0; i < nIndexSize; i++ )
-    {
-        if (panFIDIndex[i] != static_cast<GIntBig>(i))
-            bAlreadySorted = false;
-        panFIDIndex[i] = panFIDList[panFIDIndex[i]];
-    }
+        for( size_t i = 0; i < nIndexSize; i++ )
+        {
+            if (panFIDIndex[i] != static_cast<GIntBig>(i))
+                bAlreadySorted = false;
+            panFIDIndex[i] = panFIDList[panFIDIndex[i]];
+        }
 
-    CPLFree( panFIDList );
-    FreeIndexFields( pasIndexFields, nIndexSize );
+        CPLFree( panFIDList );
+        FreeIndexFields( pasIndexFields, nIndexSize );
+    }
 
     /* If it is already sorted, then free than panFIDIndex array */
     /* so that GetNextFeature() can call a sequential GetNextFeature() */
@@ -2212,13 +2933,9 @@ int OGRGenSQLResultsLayer::Compare( const OGRField *pasFirstTuple,
     for( iKey = 0; nResult == 0 && iKey < psSelectInfo->order_specs; iKey++ )
     {
         swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
-        OGRFieldDefn *poFDefn = nullptr;
-
-        if( psKeyDef->field_index >= iFIDFieldIndex )
-            poFDefn = nullptr;
-        else
-            poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn(
-                psKeyDef->field_index );
+        // Cached by CreateOrderByIndex(), so that this can be called from
+        // the threads sorting the runs.
+        OGRFieldDefn *poFDefn = m_apoOrderKeyFieldDefn[iKey];
 
         if( OGR_RawField_IsUnset(&pasFirstTuple[iKey]) ||
             OGR_RawField_IsNull(&pasFirstTuple[iKey]) )
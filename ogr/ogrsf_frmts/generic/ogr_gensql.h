@@ -50,6 +50,9 @@
 #define ALL_FIELD_INDEX_TO_GEOM_FIELD_INDEX(poFDefn, idx) \
     ((idx) - ((poFDefn)->GetFieldCount() + SPECIAL_FIELD_COUNT))
 
+struct OGRGenSQLSortRun;
+struct OGRGenSQLJoinHash;
+
 /************************************************************************/
 /*                        OGRGenSQLResultsLayer                         */
 /************************************************************************/
@@ -72,6 +75,7 @@ class OGRGenSQLResultsLayer final: public OGRLayer
     size_t      nIndexSize;
     GIntBig    *panFIDIndex;
     int         bOrderByValid;
+    std::vector<OGRFieldDefn*> m_apoOrderKeyFieldDefn;
 
     GIntBig      nNextIndexFID;
     OGRFeature  *poSummaryFeature;
@@ -84,9 +88,14 @@ class OGRGenSQLResultsLayer final: public OGRLayer
     GIntBig     nIteratedFeatures;
     std::vector<CPLString> m_oDistinctList;
 
+    std::vector<OGRGenSQLJoinHash*> m_apoJoinHash;
+
     int         PrepareSummary();
 
     OGRFeature *TranslateFeature( OGRFeature * );
+    OGRGenSQLJoinHash *GetJoinHash( int iJoin );
+    bool        LookupJoinHash( int iJoin, OGRFeature* poSrcFeat,
+                                OGRFeature** ppoJoinFeature );
     void        CreateOrderByIndex();
     void        ReadIndexFields( OGRFeature* poSrcFeat,
                                  int nOrderItems,
@@ -98,6 +107,14 @@ class OGRGenSQLResultsLayer final: public OGRLayer
                                 size_t l_nIndexSize,
                                 bool bFreeArray = true);
     int         Compare( const OGRField *pasFirst, const OGRField *pasSecond );
+    bool        OrderKeyHasString( int iKey, const OGRField* psField ) const;
+    size_t      GetIndexFieldsSize( const OGRField *pasIndexFields ) const;
+    bool        SortAndWriteRun( OGRGenSQLSortRun* psRun );
+    static void SortAndWriteRunFunc( void* pData );
+    bool        ReadRunRecord( OGRGenSQLSortRun* psRun );
+    bool        MergeSortedRuns( const std::vector<OGRGenSQLSortRun*>& apsRuns,
+                                     bool& bAlreadySorted );
+    static void FreeSortRuns( std::vector<OGRGenSQLSortRun*>& apsRuns );
 
     void        ClearFilters();
     void        ApplyFiltersToSource();
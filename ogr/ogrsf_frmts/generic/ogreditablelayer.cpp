@@ -28,13 +28,783 @@
 
 #include "ogreditablelayer.h"
 #include "../mem/ogr_mem.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
 
+#include <algorithm>
 #include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 CPL_CVSID("$Id: ogreditablelayer.cpp 07880b5ca268a13af619c6a1774f9696cd7f6992 2019-03-28 00:41:48 +0100 Even Rouault $")
 
 //! @cond Doxygen_Suppress
 
+/************************************************************************/
+/*                       Edit journal serialization                     */
+/*                                                                      */
+/*      A journal record is the uint32 size of its payload followed by  */
+/*      the payload: the FID, the number of fields and the fields,      */
+/*      each as a tag giving its state or type followed by its value,   */
+/*      the number of geometry fields and the geometries as ISO WKB,    */
+/*      then the style string, native data and native media type.      */
+/*      Values are in the native byte order, as the journal never       */
+/*      outlives the process.                                           */
+/************************************************************************/
+
+namespace
+{
+
+constexpr GByte JOURNAL_TAG_UNSET = 0xFF;
+constexpr GByte JOURNAL_TAG_NULL = 0xFE;
+constexpr GUInt32 JOURNAL_NULL_STRING = 0xFFFFFFFFU;
+
+void JournalAddBytes( std::vector<GByte>& abyBuffer,
+                      const void* pData, size_t nSize )
+{
+    const GByte* pabyData = static_cast<const GByte*>(pData);
+    abyBuffer.insert(abyBuffer.end(), pabyData, pabyData + nSize);
+}
+
+template<class T> void JournalAdd( std::vector<GByte>& abyBuffer, T nValue )
+{
+    JournalAddBytes(abyBuffer, &nValue, sizeof(T));
+}
+
+void JournalAddString( std::vector<GByte>& abyBuffer, const char* pszValue )
+{
+    if( pszValue == nullptr )
+    {
+        JournalAdd<GUInt32>(abyBuffer, JOURNAL_NULL_STRING);
+        return;
+    }
+    const size_t nLen = strlen(pszValue);
+    JournalAdd<GUInt32>(abyBuffer, static_cast<GUInt32>(nLen));
+    JournalAddBytes(abyBuffer, pszValue, nLen);
+}
+
+void JournalSerialize( const OGRFeature* poFeature,
+                       std::vector<GByte>& abyBuffer )
+{
+    abyBuffer.clear();
+    JournalAdd<GIntBig>(abyBuffer, poFeature->GetFID());
+    const int nFields = poFeature->GetFieldCount();
+    JournalAdd<GInt32>(abyBuffer, nFields);
+    for( int i = 0; i < nFields; i++ )
+    {
+        if( !poFeature->IsFieldSet(i) )
+        {
+            JournalAdd<GByte>(abyBuffer, JOURNAL_TAG_UNSET);
+            continue;
+        }
+        if( poFeature->IsFieldNull(i) )
+        {
+            JournalAdd<GByte>(abyBuffer, JOURNAL_TAG_NULL);
+            continue;
+        }
+        const OGRFieldType eType = poFeature->GetFieldDefnRef(i)->GetType();
+        const OGRField* psField = poFeature->GetRawFieldRef(i);
+        JournalAdd<GByte>(abyBuffer, static_cast<GByte>(eType));
+        switch( eType )
+        {
+            case OFTInteger:
+                JournalAdd<GInt32>(abyBuffer, psField->Integer);
+                break;
+            case OFTInteger64:
+                JournalAdd<GIntBig>(abyBuffer, psField->Integer64);
+                break;
+            case OFTReal:
+                JournalAdd<double>(abyBuffer, psField->Real);
+                break;
+            case OFTString:
+            case OFTWideString:
+                JournalAddString(abyBuffer, psField->String);
+                break;
+            case OFTIntegerList:
+                JournalAdd<GInt32>(abyBuffer, psField->IntegerList.nCount);
+                JournalAddBytes(abyBuffer, psField->IntegerList.paList,
+                    sizeof(int) * psField->IntegerList.nCount);
+                break;
+            case OFTInteger64List:
+                JournalAdd<GInt32>(abyBuffer, psField->Integer64List.nCount);
+                JournalAddBytes(abyBuffer, psField->Integer64List.paList,
+                    sizeof(GIntBig) * psField->Integer64List.nCount);
+                break;
+            case OFTRealList:
+                JournalAdd<GInt32>(abyBuffer, psField->RealList.nCount);
+                JournalAddBytes(abyBuffer, psField->RealList.paList,
+                    sizeof(double) * psField->RealList.nCount);
+                break;
+            case OFTStringList:
+            case OFTWideStringList:
+                JournalAdd<GInt32>(abyBuffer, psField->StringList.nCount);
+                for( int j = 0; j < psField->StringList.nCount; j++ )
+                    JournalAddString(abyBuffer, psField->StringList.paList[j]);
+                break;
+            case OFTBinary:
+                JournalAdd<GInt32>(abyBuffer, psField->Binary.nCount);
+                JournalAddBytes(abyBuffer, psField->Binary.paData,
+                                psField->Binary.nCount);
+                break;
+            case OFTDate:
+            case OFTTime:
+            case OFTDateTime:
+                JournalAdd<GInt16>(abyBuffer, psField->Date.Year);
+                JournalAdd<GByte>(abyBuffer, psField->Date.Month);
+                JournalAdd<GByte>(abyBuffer, psField->Date.Day);
+                JournalAdd<GByte>(abyBuffer, psField->Date.Hour);
+                JournalAdd<GByte>(abyBuffer, psField->Date.Minute);
+                JournalAdd<GByte>(abyBuffer, psField->Date.TZFlag);
+                JournalAdd<float>(abyBuffer, psField->Date.Second);
+                break;
+        }
+    }
+
+    const int nGeomFields = poFeature->GetGeomFieldCount();
+    JournalAdd<GInt32>(abyBuffer, nGeomFields);
+    for( int i = 0; i < nGeomFields; i++ )
+    {
+        const OGRGeometry* poGeom = poFeature->GetGeomFieldRef(i);
+        if( poGeom == nullptr )
+        {
+            JournalAdd<GUInt32>(abyBuffer, 0);
+            continue;
+        }
+        const GUInt32 nWkbSize = static_cast<GUInt32>(poGeom->WkbSize());
+        JournalAdd<GUInt32>(abyBuffer, nWkbSize);
+        const size_t nPos = abyBuffer.size();
+        abyBuffer.resize(nPos + nWkbSize);
+        poGeom->exportToWkb(wkbNDR, abyBuffer.data() + nPos, wkbVariantIso);
+    }
+
+    JournalAddString(abyBuffer, poFeature->GetStyleString());
+    JournalAddString(abyBuffer, poFeature->GetNativeData());
+    JournalAddString(abyBuffer, poFeature->GetNativeMediaType());
+}
+
+/************************************************************************/
+/*                            JournalCursor                             */
+/************************************************************************/
+
+struct JournalCursor
+{
+    const GByte* pabyCur;
+    const GByte* pabyEnd;
+
+    JournalCursor( const GByte* pabyData, size_t nSize ) :
+        pabyCur(pabyData), pabyEnd(pabyData + nSize) {}
+
+    bool Read( void* pDst, size_t nSize )
+    {
+        if( static_cast<size_t>(pabyEnd - pabyCur) < nSize )
+            return false;
+        memcpy(pDst, pabyCur, nSize);
+        pabyCur += nSize;
+        return true;
+    }
+
+    const GByte* Skip( size_t nSize )
+    {
+        if( static_cast<size_t>(pabyEnd - pabyCur) < nSize )
+            return nullptr;
+        const GByte* pabyRet = pabyCur;
+        pabyCur += nSize;
+        return pabyRet;
+    }
+
+    // Returns false on error. bIsNull is set for null strings.
+    bool ReadString( std::string& osValue, bool& bIsNull )
+    {
+        GUInt32 nLen = 0;
+        if( !Read(&nLen, sizeof(nLen)) )
+            return false;
+        bIsNull = (nLen == JOURNAL_NULL_STRING);
+        osValue.clear();
+        if( bIsNull )
+            return true;
+        const GByte* pabyStr = Skip(nLen);
+        if( pabyStr == nullptr )
+            return false;
+        osValue.assign(reinterpret_cast<const char*>(pabyStr), nLen);
+        return true;
+    }
+
+    template<class T> bool ReadList( std::vector<T>& aValues )
+    {
+        GInt32 nCount = 0;
+        if( !Read(&nCount, sizeof(nCount)) || nCount < 0 ||
+            static_cast<size_t>(pabyEnd - pabyCur) / sizeof(T) <
+                                            static_cast<size_t>(nCount) )
+            return false;
+        aValues.resize(nCount);
+        return nCount == 0 || Read(aValues.data(), sizeof(T) * nCount);
+    }
+};
+
+/************************************************************************/
+/*                          JournalReadField()                          */
+/*                                                                      */
+/*      Reads the field at the cursor, and sets it as field iField of   */
+/*      poFeature, converting it to the type of the field, if           */
+/*      poFeature is not null.                                          */
+/************************************************************************/
+
+bool JournalReadField( JournalCursor& oCursor, OGRFeature* poFeature,
+                       int iField )
+{
+    GByte nTag = 0;
+    if( !oCursor.Read(&nTag, 1) )
+        return false;
+    if( nTag == JOURNAL_TAG_UNSET )
+        return true;
+    if( nTag == JOURNAL_TAG_NULL )
+    {
+        if( poFeature )
+            poFeature->SetFieldNull(iField);
+        return true;
+    }
+    switch( static_cast<OGRFieldType>(nTag) )
+    {
+        case OFTInteger:
+        {
+            GInt32 nValue = 0;
+            if( !oCursor.Read(&nValue, sizeof(nValue)) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField, nValue);
+            return true;
+        }
+        case OFTInteger64:
+        {
+            GIntBig nValue = 0;
+            if( !oCursor.Read(&nValue, sizeof(nValue)) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField, nValue);
+            return true;
+        }
+        case OFTReal:
+        {
+            double dfValue = 0;
+            if( !oCursor.Read(&dfValue, sizeof(dfValue)) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField, dfValue);
+            return true;
+        }
+        case OFTString:
+        case OFTWideString:
+        {
+            std::string osValue;
+            bool bIsNull = false;
+            if( !oCursor.ReadString(osValue, bIsNull) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField, osValue.c_str());
+            return true;
+        }
+        case OFTIntegerList:
+        {
+            std::vector<int> anValues;
+            if( !oCursor.ReadList(anValues) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField,
+                                    static_cast<int>(anValues.size()),
+                                    anValues.data());
+            return true;
+        }
+        case OFTInteger64List:
+        {
+            std::vector<GIntBig> anValues;
+            if( !oCursor.ReadList(anValues) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField,
+                                    static_cast<int>(anValues.size()),
+                                    anValues.data());
+            return true;
+        }
+        case OFTRealList:
+        {
+            std::vector<double> adfValues;
+            if( !oCursor.ReadList(adfValues) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField,
+                                    static_cast<int>(adfValues.size()),
+                                    adfValues.data());
+            return true;
+        }
+        case OFTStringList:
+        case OFTWideStringList:
+        {
+            GInt32 nCount = 0;
+            if( !oCursor.Read(&nCount, sizeof(nCount)) || nCount < 0 )
+                return false;
+            CPLStringList aosValues;
+            for( GInt32 j = 0; j < nCount; j++ )
+            {
+                std::string osValue;
+                bool bIsNull = false;
+                if( !oCursor.ReadString(osValue, bIsNull) )
+                    return false;
+                if( poFeature )
+                    aosValues.AddString(osValue.c_str());
+            }
+            if( poFeature )
+                poFeature->SetField(iField, aosValues.List());
+            return true;
+        }
+        case OFTBinary:
+        {
+            GInt32 nCount = 0;
+            if( !oCursor.Read(&nCount, sizeof(nCount)) || nCount < 0 )
+                return false;
+            const GByte* pabyData = oCursor.Skip(nCount);
+            if( pabyData == nullptr )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField, nCount, pabyData);
+            return true;
+        }
+        case OFTDate:
+        case OFTTime:
+        case OFTDateTime:
+        {
+            GInt16 nYear = 0;
+            GByte abyValues[5] = { 0, 0, 0, 0, 0 };
+            float fSecond = 0.0f;
+            if( !oCursor.Read(&nYear, sizeof(nYear)) ||
+                !oCursor.Read(abyValues, sizeof(abyValues)) ||
+                !oCursor.Read(&fSecond, sizeof(fSecond)) )
+                return false;
+            if( poFeature )
+                poFeature->SetField(iField, nYear, abyValues[0], abyValues[1],
+                                    abyValues[2], abyValues[3], fSecond,
+                                    abyValues[4]);
+            return true;
+        }
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                         JournalDeserialize()                         */
+/************************************************************************/
+
+bool JournalDeserialize( const GByte* pabyData, size_t nSize,
+                         OGRFeature* poFeature )
+{
+    JournalCursor oCursor(pabyData, nSize);
+    GIntBig nFID = 0;
+    GInt32 nFields = 0;
+    if( !oCursor.Read(&nFID, sizeof(nFID)) ||
+        !oCursor.Read(&nFields, sizeof(nFields)) || nFields < 0 )
+        return false;
+    poFeature->SetFID(nFID);
+    // Fields created after the record was written are left unset.
+    const int nTargetFields = poFeature->GetFieldCount();
+    for( GInt32 i = 0; i < nFields; i++ )
+    {
+        if( !JournalReadField(oCursor, i < nTargetFields ? poFeature : nullptr,
+                              i) )
+            return false;
+    }
+
+    GInt32 nGeomFields = 0;
+    if( !oCursor.Read(&nGeomFields, sizeof(nGeomFields)) || nGeomFields < 0 )
+        return false;
+    const int nTargetGeomFields = poFeature->GetGeomFieldCount();
+    for( GInt32 i = 0; i < nGeomFields; i++ )
+    {
+        GUInt32 nWkbSize = 0;
+        if( !oCursor.Read(&nWkbSize, sizeof(nWkbSize)) )
+            return false;
+        if( nWkbSize == 0 )
+            continue;
+        const GByte* pabyWkb = oCursor.Skip(nWkbSize);
+        if( pabyWkb == nullptr )
+            return false;
+        if( i >= nTargetGeomFields )
+            continue;
+        OGRGeometry* poGeom = nullptr;
+        if( OGRGeometryFactory::createFromWkb(pabyWkb, nullptr, &poGeom,
+                                              nWkbSize, wkbVariantIso) !=
+                                                                OGRERR_NONE )
+            return false;
+        poFeature->SetGeomFieldDirectly(i, poGeom);
+    }
+
+    std::string osValue;
+    bool bIsNull = false;
+    if( !oCursor.ReadString(osValue, bIsNull) )
+        return false;
+    poFeature->SetStyleString(bIsNull ? nullptr : osValue.c_str());
+    if( !oCursor.ReadString(osValue, bIsNull) )
+        return false;
+    poFeature->SetNativeData(bIsNull ? nullptr : osValue.c_str());
+    if( !oCursor.ReadString(osValue, bIsNull) )
+        return false;
+    poFeature->SetNativeMediaType(bIsNull ? nullptr : osValue.c_str());
+    return true;
+}
+
+/************************************************************************/
+/*                          JournalRemapFields()                        */
+/*                                                                      */
+/*      Field i of the record becomes field panMap[i] of a record with  */
+/*      nNewFieldCount fields, or is dropped if panMap[i] is negative.  */
+/************************************************************************/
+
+bool JournalRemapFields( const GByte* pabyData, size_t nSize,
+                         const std::vector<int>& anMap, int nNewFieldCount,
+                         std::vector<GByte>& abyOut )
+{
+    JournalCursor oCursor(pabyData, nSize);
+    GIntBig nFID = 0;
+    GInt32 nFields = 0;
+    if( !oCursor.Read(&nFID, sizeof(nFID)) ||
+        !oCursor.Read(&nFields, sizeof(nFields)) || nFields < 0 )
+        return false;
+    std::vector<std::pair<const GByte*, size_t>> aoSpans(
+        nNewFieldCount, std::pair<const GByte*, size_t>(nullptr, 0));
+    for( GInt32 i = 0; i < nFields; i++ )
+    {
+        const GByte* pabyStart = oCursor.pabyCur;
+        if( !JournalReadField(oCursor, nullptr, -1) )
+            return false;
+        if( i < static_cast<int>(anMap.size()) && anMap[i] >= 0 &&
+            anMap[i] < nNewFieldCount )
+        {
+            aoSpans[anMap[i]].first = pabyStart;
+            aoSpans[anMap[i]].second =
+                static_cast<size_t>(oCursor.pabyCur - pabyStart);
+        }
+    }
+
+    abyOut.clear();
+    JournalAdd<GIntBig>(abyOut, nFID);
+    JournalAdd<GInt32>(abyOut, nNewFieldCount);
+    for( const auto& oSpan: aoSpans )
+    {
+        if( oSpan.first == nullptr )
+            JournalAdd<GByte>(abyOut, JOURNAL_TAG_UNSET);
+        else
+            JournalAddBytes(abyOut, oSpan.first, oSpan.second);
+    }
+    JournalAddBytes(abyOut, oCursor.pabyCur,
+                    static_cast<size_t>(oCursor.pabyEnd - oCursor.pabyCur));
+    return true;
+}
+
+} // namespace
+
+/************************************************************************/
+/*                       OGREditableLayerJournal                        */
+/*                                                                      */
+/*      Append-only file of the created and edited features, with an    */
+/*      index from FID to the last record of each feature. The file     */
+/*      starts in /vsimem/ and moves to a temporary file on disk once   */
+/*      it grows beyond OGR_EDITABLE_LAYER_JOURNAL_MAX_MEMORY MB.       */
+/************************************************************************/
+
+class OGREditableLayerJournal
+{
+    struct Record
+    {
+        vsi_l_offset nOffset;
+        GUInt32      nSize;
+    };
+
+    CPLString           m_osFilename{};
+    VSILFILE           *m_fp = nullptr;
+    bool                m_bOnDisk = false;
+    vsi_l_offset        m_nFileSize = 0;
+    vsi_l_offset        m_nObsoleteSize = 0;
+    vsi_l_offset        m_nMaxMemorySize = 0;
+    std::unordered_map<GIntBig, Record> m_oMapFIDToRecord{};
+    std::vector<GByte>  m_abyBuffer{};
+    std::vector<GByte>  m_abyRemapBuffer{};
+
+    CPL_DISALLOW_COPY_ASSIGN(OGREditableLayerJournal)
+
+    bool                Open();
+    bool                MoveToDisk();
+    bool                Append( const std::vector<GByte>& abyPayload,
+                                GIntBig nFID );
+    bool                ReadRecord( const Record& oRecord );
+    bool                Rewrite( const std::vector<int>* panMap,
+                                 int nNewFieldCount );
+
+  public:
+    OGREditableLayerJournal();
+    ~OGREditableLayerJournal();
+
+    bool                Write( const OGRFeature* poFeature );
+    OGRFeature         *Read( GIntBig nFID, OGRFeatureDefn* poDefn );
+    bool                Contains( GIntBig nFID ) const
+                    { return m_oMapFIDToRecord.find(nFID) !=
+                                                    m_oMapFIDToRecord.end(); }
+    void                Remove( GIntBig nFID );
+    void                Clear();
+
+    // To be called once the fields of the layer have been deleted or
+    // reordered. See JournalRemapFields().
+    bool                RemapFields( const std::vector<int>& anMap,
+                                     int nNewFieldCount )
+                                { return Rewrite(&anMap, nNewFieldCount); }
+};
+
+OGREditableLayerJournal::OGREditableLayerJournal() :
+    m_nMaxMemorySize(static_cast<vsi_l_offset>(
+        std::max(0.0, CPLAtof(CPLGetConfigOption(
+            "OGR_EDITABLE_LAYER_JOURNAL_MAX_MEMORY", "100"))) * 1024 * 1024))
+{
+}
+
+OGREditableLayerJournal::~OGREditableLayerJournal()
+{
+    Clear();
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+bool OGREditableLayerJournal::Open()
+{
+    if( m_fp != nullptr )
+        return true;
+    static int nCounter = 0;
+    m_osFilename.Printf("/vsimem/ogreditablelayer_journal_%p_%d.bin", this,
+                        CPLAtomicInc(&nCounter));
+    m_bOnDisk = false;
+    m_fp = VSIFOpenL(m_osFilename, "wb+");
+    if( m_fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot create %s",
+                 m_osFilename.c_str());
+        return false;
+    }
+    m_nFileSize = 0;
+    m_nObsoleteSize = 0;
+    return true;
+}
+
+/************************************************************************/
+/*                                Clear()                               */
+/************************************************************************/
+
+void OGREditableLayerJournal::Clear()
+{
+    if( m_fp != nullptr )
+    {
+        VSIFCloseL(m_fp);
+        m_fp = nullptr;
+        VSIUnlink(m_osFilename);
+    }
+    m_oMapFIDToRecord.clear();
+    m_nFileSize = 0;
+    m_nObsoleteSize = 0;
+}
+
+/************************************************************************/
+/*                             MoveToDisk()                             */
+/************************************************************************/
+
+bool OGREditableLayerJournal::MoveToDisk()
+{
+    const CPLString osDiskFilename(
+                        CPLGenerateTempFilename("ogreditablelayer_journal"));
+    VSILFILE* fpDisk = VSIFOpenL(osDiskFilename, "wb+");
+    if( fpDisk == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot create %s",
+                 osDiskFilename.c_str());
+        return false;
+    }
+    CPLDebug("OGR", "Moving edit journal to %s", osDiskFilename.c_str());
+    vsi_l_offset nMemSize = 0;
+    const GByte* pabyData = VSIGetMemFileBuffer(m_osFilename, &nMemSize,
+                                                FALSE);
+    if( pabyData == nullptr ||
+        VSIFWriteL(pabyData, 1, static_cast<size_t>(nMemSize), fpDisk) !=
+                                            static_cast<size_t>(nMemSize) )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot write %s",
+                 osDiskFilename.c_str());
+        VSIFCloseL(fpDisk);
+        VSIUnlink(osDiskFilename);
+        return false;
+    }
+    VSIFCloseL(m_fp);
+    VSIUnlink(m_osFilename);
+    m_fp = fpDisk;
+    m_osFilename = osDiskFilename;
+    m_bOnDisk = true;
+    return true;
+}
+
+/************************************************************************/
+/*                               Append()                               */
+/************************************************************************/
+
+bool OGREditableLayerJournal::Append( const std::vector<GByte>& abyPayload,
+                                      GIntBig nFID )
+{
+    if( !Open() )
+        return false;
+    const GUInt32 nSize = static_cast<GUInt32>(abyPayload.size());
+    if( !m_bOnDisk && m_nFileSize + sizeof(nSize) + nSize > m_nMaxMemorySize &&
+        !MoveToDisk() )
+    {
+        return false;
+    }
+    if( VSIFSeekL(m_fp, m_nFileSize, SEEK_SET) != 0 ||
+        VSIFWriteL(&nSize, 1, sizeof(nSize), m_fp) != sizeof(nSize) ||
+        VSIFWriteL(abyPayload.data(), 1, nSize, m_fp) != nSize )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot write in %s",
+                 m_osFilename.c_str());
+        return false;
+    }
+    Record oRecord;
+    oRecord.nOffset = m_nFileSize + sizeof(nSize);
+    oRecord.nSize = nSize;
+    auto oIter = m_oMapFIDToRecord.find(nFID);
+    if( oIter != m_oMapFIDToRecord.end() )
+    {
+        m_nObsoleteSize += sizeof(GUInt32) + oIter->second.nSize;
+        oIter->second = oRecord;
+    }
+    else
+    {
+        m_oMapFIDToRecord[nFID] = oRecord;
+    }
+    m_nFileSize += sizeof(nSize) + nSize;
+    return true;
+}
+
+/************************************************************************/
+/*                             ReadRecord()                             */
+/************************************************************************/
+
+bool OGREditableLayerJournal::ReadRecord( const Record& oRecord )
+{
+    m_abyBuffer.resize(oRecord.nSize);
+    if( VSIFSeekL(m_fp, oRecord.nOffset, SEEK_SET) != 0 ||
+        VSIFReadL(m_abyBuffer.data(), 1, oRecord.nSize, m_fp) !=
+                                                            oRecord.nSize )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read in %s",
+                 m_osFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                              Rewrite()                               */
+/*                                                                      */
+/*      Copies the last record of each feature to a new journal, which  */
+/*      drops the obsolete records, optionally remapping the fields.    */
+/************************************************************************/
+
+bool OGREditableLayerJournal::Rewrite( const std::vector<int>* panMap,
+                                       int nNewFieldCount )
+{
+    if( m_fp == nullptr )
+        return true;
+
+    OGREditableLayerJournal oNewJournal;
+    oNewJournal.m_nMaxMemorySize = m_nMaxMemorySize;
+    for( const auto& oIter: m_oMapFIDToRecord )
+    {
+        if( !ReadRecord(oIter.second) )
+            return false;
+        if( panMap != nullptr )
+        {
+            if( !JournalRemapFields(m_abyBuffer.data(), m_abyBuffer.size(),
+                                    *panMap, nNewFieldCount,
+                                    m_abyRemapBuffer) )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Corrupted record in %s", m_osFilename.c_str());
+                return false;
+            }
+            if( !oNewJournal.Append(m_abyRemapBuffer, oIter.first) )
+                return false;
+        }
+        else if( !oNewJournal.Append(m_abyBuffer, oIter.first) )
+        {
+            return false;
+        }
+    }
+
+    Clear();
+    std::swap(m_osFilename, oNewJournal.m_osFilename);
+    std::swap(m_fp, oNewJournal.m_fp);
+    std::swap(m_bOnDisk, oNewJournal.m_bOnDisk);
+    std::swap(m_nFileSize, oNewJournal.m_nFileSize);
+    std::swap(m_nObsoleteSize, oNewJournal.m_nObsoleteSize);
+    std::swap(m_oMapFIDToRecord, oNewJournal.m_oMapFIDToRecord);
+    return true;
+}
+
+/************************************************************************/
+/*                               Write()                                */
+/************************************************************************/
+
+bool OGREditableLayerJournal::Write( const OGRFeature* poFeature )
+{
+    JournalSerialize(poFeature, m_abyBuffer);
+    if( !Append(m_abyBuffer, poFeature->GetFID()) )
+        return false;
+    // Reclaim the space of the obsolete records when they are the
+    // majority of the file.
+    if( m_nObsoleteSize > 1024 * 1024 && m_nObsoleteSize > m_nFileSize / 2 )
+        return Rewrite(nullptr, 0);
+    return true;
+}
+
+/************************************************************************/
+/*                                Read()                                */
+/************************************************************************/
+
+OGRFeature* OGREditableLayerJournal::Read( GIntBig nFID,
+                                           OGRFeatureDefn* poDefn )
+{
+    auto oIter = m_oMapFIDToRecord.find(nFID);
+    if( oIter == m_oMapFIDToRecord.end() || !ReadRecord(oIter->second) )
+        return nullptr;
+    OGRFeature* poFeature = new OGRFeature(poDefn);
+    if( !JournalDeserialize(m_abyBuffer.data(), m_abyBuffer.size(),
+                            poFeature) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Corrupted record in %s", m_osFilename.c_str());
+        delete poFeature;
+        return nullptr;
+    }
+    return poFeature;
+}
+
+/************************************************************************/
+/*                               Remove()                               */
+/************************************************************************/
+
+void OGREditableLayerJournal::Remove( GIntBig nFID )
+{
+    auto oIter = m_oMapFIDToRecord.find(nFID);
+    if( oIter != m_oMapFIDToRecord.end() )
+    {
+        m_nObsoleteSize += sizeof(GUInt32) + oIter->second.nSize;
+        m_oMapFIDToRecord.erase(oIter);
+    }
+}
+
 /************************************************************************/
 /*                  ~IOGREditableLayerSynchronizer()                    */
 /************************************************************************/
@@ -57,6 +827,7 @@ OGREditableLayer::OGREditableLayer(
     m_poEditableFeatureDefn(poDecoratedLayer->GetLayerDefn()->Clone()),
     m_nNextFID(0),
     m_poMemLayer(new OGRMemLayer( "", nullptr, wkbNone )),
+    m_poJournal(new OGREditableLayerJournal()),
     m_bStructureModified(false),
     m_bSupportsCreateGeomField(false),
     m_bSupportsCurveGeometries(false)
@@ -266,7 +1037,8 @@ OGRFeature *OGREditableLayer::GetNextFeature()
                      m_oSetEdited.find(nFID) != m_oSetEdited.end() )
             {
                 delete poSrcFeature;
-                poSrcFeature = m_poMemLayer->GetFeature(nFID);
+                poSrcFeature = m_poJournal->Read(nFID,
+                                                 m_poMemLayer->GetLayerDefn());
                 bHideDeletedFields = false;
             }
         }
@@ -274,7 +1046,8 @@ OGRFeature *OGREditableLayer::GetNextFeature()
         {
             if( m_oIter != m_oSetCreated.end() )
             {
-                poSrcFeature = m_poMemLayer->GetFeature(*m_oIter);
+                poSrcFeature = m_poJournal->Read(*m_oIter,
+                                                 m_poMemLayer->GetLayerDefn());
                 bHideDeletedFields = false;
                 ++ m_oIter;
             }
@@ -286,6 +1059,9 @@ OGRFeature *OGREditableLayer::GetNextFeature()
         OGRFeature* poRet = Translate(m_poEditableFeatureDefn, poSrcFeature,
                                       true, bHideDeletedFields);
         delete poSrcFeature;
+        // Error when reading the journal.
+        if( poRet == nullptr )
+            return nullptr;
 
         if( (m_poFilterGeom == nullptr
              || FilterGeometry( poRet->GetGeomFieldRef(m_iGeomFieldFilter) ) )
@@ -328,7 +1104,7 @@ OGRFeature *OGREditableLayer::GetFeature( GIntBig nFID )
     if( m_oSetCreated.find(nFID) != m_oSetCreated.end() ||
         m_oSetEdited.find(nFID) != m_oSetEdited.end() )
     {
-        poSrcFeature = m_poMemLayer->GetFeature(nFID);
+        poSrcFeature = m_poJournal->Read(nFID, m_poMemLayer->GetLayerDefn());
         bHideDeletedFields = false;
     }
     else if( m_oSetDeleted.find(nFID) != m_oSetDeleted.end() )
@@ -366,9 +1142,21 @@ OGRErr      OGREditableLayer::ISetFeature( OGRFeature *poFeature )
         return eErr;
     }
 
+    if( poFeature->GetFID() < OGRNullFID )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "negative FID are not supported");
+        return OGRERR_FAILURE;
+    }
     OGRFeature* poMemFeature = Translate(m_poMemLayer->GetLayerDefn(),
                                          poFeature, false, false);
-    OGRErr eErr = m_poMemLayer->SetFeature(poMemFeature);
+    if( poMemFeature->GetFID() == OGRNullFID )
+    {
+        DetectNextFID();
+        poMemFeature->SetFID( m_nNextFID ++ );
+    }
+    OGRErr eErr = m_poJournal->Write(poMemFeature) ? OGRERR_NONE :
+                                                     OGRERR_FAILURE;
     if( eErr == OGRERR_NONE )
     {
         const GIntBig nFID = poMemFeature->GetFID();
@@ -410,9 +1198,11 @@ OGRErr      OGREditableLayer::ICreateFeature( OGRFeature *poFeature )
     OGRFeature* poMemFeature = Translate(m_poMemLayer->GetLayerDefn(),
                                          poFeature, false, false);
     DetectNextFID();
-    if( poMemFeature->GetFID() < 0 )
+    if( poMemFeature->GetFID() < 0 ||
+        m_poJournal->Contains(poMemFeature->GetFID()) )
         poMemFeature->SetFID( m_nNextFID ++ );
-    OGRErr eErr = m_poMemLayer->CreateFeature(poMemFeature);
+    OGRErr eErr = m_poJournal->Write(poMemFeature) ? OGRERR_NONE :
+                                                     OGRERR_FAILURE;
     if( eErr == OGRERR_NONE )
     {
         const GIntBig nFID = poMemFeature->GetFID();
@@ -445,14 +1235,16 @@ OGRErr      OGREditableLayer::DeleteFeature( GIntBig nFID )
     else if( m_oSetCreated.find(nFID) != m_oSetCreated.end() )
     {
         m_oSetCreated.erase(nFID);
-        eErr = m_poMemLayer->DeleteFeature(nFID);
+        m_poJournal->Remove(nFID);
+        eErr = OGRERR_NONE;
     }
     // cppcheck-suppress redundantIfRemove
     else if( m_oSetEdited.find(nFID) != m_oSetEdited.end() )
     {
         m_oSetEdited.erase(nFID);
         m_oSetDeleted.insert(nFID);
-        eErr = m_poMemLayer->DeleteFeature(nFID);
+        m_poJournal->Remove(nFID);
+        eErr = OGRERR_NONE;
     }
     else
     {
@@ -623,11 +1415,19 @@ OGRErr      OGREditableLayer::GetExtent(int iGeomField, OGREnvelope *psExtent,
                                                     bForce);
         if( eErr == OGRERR_NONE )
         {
-            OGREnvelope sExtentMemLayer;
-            if( m_poMemLayer->GetExtent(iGeomField,
-                                    &sExtentMemLayer, bForce) == OGRERR_NONE )
+            for( const GIntBig nFID: m_oSetCreated )
             {
-                psExtent->Merge(sExtentMemLayer);
+                OGRFeature* poFeature = m_poJournal->Read(
+                                        nFID, m_poMemLayer->GetLayerDefn());
+                const OGRGeometry* poGeom = poFeature ?
+                            poFeature->GetGeomFieldRef(iGeomField) : nullptr;
+                if( poGeom != nullptr && !poGeom->IsEmpty() )
+                {
+                    OGREnvelope sEnvelope;
+                    poGeom->getEnvelope(&sEnvelope);
+                    psExtent->Merge(sEnvelope);
+                }
+                delete poFeature;
             }
         }
         return eErr;
@@ -720,9 +1520,16 @@ OGRErr      OGREditableLayer::DeleteField( int iField )
         osDeletedField = m_poEditableFeatureDefn->GetFieldDefn(iField)->GetNameRef();
     }
 
+    const int nOldFieldCount = m_poMemLayer->GetLayerDefn()->GetFieldCount();
     OGRErr eErr = m_poMemLayer->DeleteField(iField);
     if( eErr == OGRERR_NONE )
     {
+        std::vector<int> anMap(nOldFieldCount);
+        for( int i = 0; i < nOldFieldCount; i++ )
+            anMap[i] = (i < iField) ? i : (i == iField) ? -1 : i - 1;
+        if( !m_poJournal->RemapFields(anMap, nOldFieldCount - 1) )
+            eErr = OGRERR_FAILURE;
+
         m_poEditableFeatureDefn->DeleteFieldDefn(iField);
         m_bStructureModified = true;
         m_oSetDeletedFields.insert(osDeletedField);
@@ -743,6 +1550,15 @@ OGRErr      OGREditableLayer::ReorderFields( int* panMap )
     OGRErr eErr = m_poMemLayer->ReorderFields(panMap);
     if( eErr == OGRERR_NONE )
     {
+        // New field i is old field panMap[i].
+        const int nFieldCount =
+                        m_poMemLayer->GetLayerDefn()->GetFieldCount();
+        std::vector<int> anMap(nFieldCount, -1);
+        for( int i = 0; i < nFieldCount; i++ )
+            anMap[panMap[i]] = i;
+        if( !m_poJournal->RemapFields(anMap, nFieldCount) )
+            eErr = OGRERR_FAILURE;
+
         m_poEditableFeatureDefn->ReorderFieldDefns(panMap);
         m_bStructureModified = true;
     }
@@ -828,6 +1644,7 @@ OGRErr      OGREditableLayer::SyncToDisk()
     m_oSetEdited.clear();
     m_oSetDeleted.clear();
     m_oSetDeletedFields.clear();
+    m_poJournal->Clear();
     m_bStructureModified = false;
     return eErr;
 }
@@ -34,6 +34,7 @@
 #include "ogrlayerdecorator.h"
 #include <set>
 #include <map>
+#include <memory>
 
 class CPL_DLL IOGREditableLayerSynchronizer
 {
@@ -44,6 +45,8 @@ class CPL_DLL IOGREditableLayerSynchronizer
                                           OGRLayer** ppoDecoratedLayer) = 0;
 };
 
+class OGREditableLayerJournal;
+
 class CPL_DLL OGREditableLayer : public OGRLayerDecorator
 {
     CPL_DISALLOW_COPY_ASSIGN(OGREditableLayer)
@@ -59,7 +62,10 @@ class CPL_DLL OGREditableLayer : public OGRLayerDecorator
     std::set<GIntBig>              m_oSetDeleted{};
     std::set<GIntBig>::iterator    m_oIter{};
     std::set<CPLString>            m_oSetDeletedFields{};
+    // Only holds the layer structure. The created and edited features
+    // are stored in the journal.
     OGRLayer                      *m_poMemLayer;
+    std::unique_ptr<OGREditableLayerJournal> m_poJournal;
     bool                           m_bStructureModified;
     bool                           m_bSupportsCreateGeomField;
     bool                           m_bSupportsCurveGeometries;
@@ -33,6 +33,15 @@
 #include "ogr_attrind.h"
 #include "swq.h"
 #include "ograpispy.h"
+#include "cpl_quad_tree.h"
+#include "cpl_trace.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <memory>
+#include <vector>
 
 CPL_CVSID("$Id: ogrlayer.cpp 3613d00e9e9629493b431e463f1c3a45f2819eb0 2018-05-11 00:50:42 +0200 Even Rouault $")
 
@@ -548,10 +557,51 @@ OGRFeatureH OGR_L_GetNextFeature( OGRLayerH hLayer )
         OGRAPISpy_L_GetNextFeature(hLayer);
 #endif
 
+    CPL_TRACE_SCOPE("vector", "GetNextFeature");
     return OGRFeature::ToHandle(
                 OGRLayer::FromHandle(hLayer)->GetNextFeature());
 }
 
+/************************************************************************/
+/*                         GetNextFeatureInto()                         */
+/*                                                                      */
+/*      Default implementation on top of GetNextFeature(). Drivers      */
+/*      can override it to fill the passed feature directly.            */
+/************************************************************************/
+
+bool OGRLayer::GetNextFeatureInto( OGRFeature* poFeature )
+
+{
+    if( poFeature->GetDefnRef() != GetLayerDefn() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "GetNextFeatureInto(): the feature must have been created "
+                 "with the layer definition");
+        return false;
+    }
+
+    OGRFeature* poNextFeature = GetNextFeature();
+    if( poNextFeature == nullptr )
+        return false;
+    poFeature->SwapContent(poNextFeature);
+    delete poNextFeature;
+    return true;
+}
+
+/************************************************************************/
+/*                      OGR_L_GetNextFeatureInto()                      */
+/************************************************************************/
+
+int OGR_L_GetNextFeatureInto( OGRLayerH hLayer, OGRFeatureH hFeature )
+
+{
+    VALIDATE_POINTER1( hLayer, "OGR_L_GetNextFeatureInto", FALSE );
+    VALIDATE_POINTER1( hFeature, "OGR_L_GetNextFeatureInto", FALSE );
+
+    return OGRLayer::FromHandle(hLayer)->GetNextFeatureInto(
+                                        OGRFeature::FromHandle(hFeature));
+}
+
 /************************************************************************/
 /*                       ConvertGeomsIfNecessary()                      */
 /************************************************************************/
@@ -1300,7 +1350,8 @@ int OGRLayer::InstallFilter( OGRGeometry * poFilter )
     if( m_poFilterGeom != nullptr )
         m_poFilterGeom->getEnvelope( &m_sFilterEnvelope );
 
-    /* Compile geometry filter as a prepared geometry */
+    /* Compile geometry filter as a prepared geometry, once for all the */
+    /* features tested by FilterGeometry() */
     m_pPreparedFilterGeom = OGRCreatePreparedGeometry(m_poFilterGeom);
 
 /* -------------------------------------------------------------------- */
@@ -1466,6 +1517,35 @@ int OGRLayer::FilterGeometry( OGRGeometry *poGeometry )
 }
 //! @endcond
 
+/************************************************************************/
+/*                            FilterPoint()                             */
+/*                                                                      */
+/*      Same as FilterGeometry() on a OGRPoint(dfX, dfY), for drivers   */
+/*      that can get the coordinates of a point feature before          */
+/*      building it, and skip it entirely when it is filtered out.      */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+int OGRLayer::FilterPoint( double dfX, double dfY )
+
+{
+    if( m_poFilterGeom == nullptr )
+        return TRUE;
+
+    if( dfX < m_sFilterEnvelope.MinX || dfY < m_sFilterEnvelope.MinY ||
+        dfX > m_sFilterEnvelope.MaxX || dfY > m_sFilterEnvelope.MaxY )
+        return FALSE;
+
+    if( m_bFilterIsEnvelope &&
+        dfX >= m_sFilterEnvelope.MinX && dfY >= m_sFilterEnvelope.MinY &&
+        dfX <= m_sFilterEnvelope.MaxX && dfY <= m_sFilterEnvelope.MaxY )
+        return TRUE;
+
+    OGRPoint oPoint(dfX, dfY);
+    return FilterGeometry(&oPoint);
+}
+//! @endcond
+
 /************************************************************************/
 /*                         OGR_L_ResetReading()                         */
 /************************************************************************/
@@ -1500,7 +1580,23 @@ OGRErr OGRLayer::InitializeIndexSupport( const char *pszFilename )
     if (m_poAttrIndex != nullptr)
         return OGRERR_NONE;
 
-    m_poAttrIndex = OGRCreateDefaultLayerIndex();
+/* -------------------------------------------------------------------- */
+/*      Keep using the MapInfo .idm/.ind index when one exists, or      */
+/*      when explicitly requested, and otherwise use the B+tree .obi    */
+/*      index that supports range queries.                              */
+/* -------------------------------------------------------------------- */
+    VSIStatBufL sStat;
+    if( STARTS_WITH_CI(pszFilename, "<OGRMILayerAttrIndex>") ||
+        EQUAL(CPLGetConfigOption("OGR_ATTRIBUTE_INDEX_FORMAT", "BTREE"),
+              "MAPINFO") ||
+        VSIStatL(CPLResetExtension(pszFilename, "idm"), &sStat) == 0 )
+    {
+        m_poAttrIndex = OGRCreateDefaultLayerIndex();
+    }
+    else
+    {
+        m_poAttrIndex = OGRCreateBTreeLayerIndex();
+    }
 
     eErr = m_poAttrIndex->Initialize( pszFilename, this );
     if( eErr != OGRERR_NONE )
@@ -1989,6 +2085,415 @@ static OGRGeometry* promote_to_multi(OGRGeometry* poGeom)
         return poGeom;
 }
 
+/************************************************************************/
+/*                         OGROverlayIndex                              */
+/************************************************************************/
+
+namespace {
+
+// In-memory copy of the features of a layer, as returned under its current
+// filters, indexed by the envelope of their geometry. Once loaded, Search()
+// may be called concurrently from several threads.
+class OGROverlayIndex
+{
+    std::vector<OGRFeatureUniquePtr> m_apoFeatures{};
+    CPLQuadTree                     *m_hTree = nullptr;
+
+    CPL_DISALLOW_COPY_ASSIGN(OGROverlayIndex)
+
+  public:
+    OGROverlayIndex() = default;
+    ~OGROverlayIndex();
+
+    OGRErr      Load( OGRLayer *poLayer );
+    void        Search( const OGRGeometry *poFilter,
+                        std::vector<OGRFeature*>& apoFeatures ) const;
+
+    size_t      GetFeatureCount() const { return m_apoFeatures.size(); }
+    OGRFeature *GetFeature( size_t i ) const { return m_apoFeatures[i].get(); }
+};
+
+OGROverlayIndex::~OGROverlayIndex()
+{
+    if( m_hTree )
+        CPLQuadTreeDestroy(m_hTree);
+}
+
+OGRErr OGROverlayIndex::Load( OGRLayer *poLayer )
+{
+    OGREnvelope sGlobalEnvelope;
+    try
+    {
+        poLayer->ResetReading();
+        OGRFeature* poFeature;
+        while( (poFeature = poLayer->GetNextFeature()) != nullptr )
+        {
+            m_apoFeatures.emplace_back(poFeature);
+            // Resolve the geometry now, so that later accesses are read-only.
+            OGRGeometry *poGeom = poFeature->GetGeometryRef();
+            if( poGeom && !poGeom->IsEmpty() )
+            {
+                OGREnvelope sEnvelope;
+                poGeom->getEnvelope(&sEnvelope);
+                sGlobalEnvelope.Merge(sEnvelope);
+            }
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot load features of layer %s in memory",
+                 poLayer->GetName());
+        return OGRERR_NOT_ENOUGH_MEMORY;
+    }
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = sGlobalEnvelope.MinX;
+    sGlobalBounds.miny = sGlobalEnvelope.MinY;
+    sGlobalBounds.maxx = sGlobalEnvelope.MaxX;
+    sGlobalBounds.maxy = sGlobalEnvelope.MaxY;
+    m_hTree = CPLQuadTreeCreate(&sGlobalBounds, nullptr);
+    CPLQuadTreeSetMaxDepth(m_hTree, CPLQuadTreeGetAdvisedMaxDepth(
+        static_cast<int>(std::min<size_t>(m_apoFeatures.size(), INT_MAX))));
+    for( auto& poFeature: m_apoFeatures )
+    {
+        const OGRGeometry *poGeom = poFeature->GetGeometryRef();
+        if( poGeom == nullptr || poGeom->IsEmpty() )
+            continue;
+        OGREnvelope sEnvelope;
+        poGeom->getEnvelope(&sEnvelope);
+        CPLRectObj sRect;
+        sRect.minx = sEnvelope.MinX;
+        sRect.miny = sEnvelope.MinY;
+        sRect.maxx = sEnvelope.MaxX;
+        sRect.maxy = sEnvelope.MaxY;
+        CPLQuadTreeInsertWithBounds(m_hTree, &poFeature, &sRect);
+    }
+    return OGRERR_NONE;
+}
+
+// Returns, in layer order, the features whose geometry intersects poFilter,
+// i.e. what iterating the layer with poFilter as spatial filter would give.
+void OGROverlayIndex::Search( const OGRGeometry *poFilter,
+                              std::vector<OGRFeature*>& apoFeatures ) const
+{
+    apoFeatures.clear();
+    if( m_hTree == nullptr || poFilter->IsEmpty() )
+        return;
+
+    OGREnvelope sEnvelope;
+    poFilter->getEnvelope(&sEnvelope);
+    CPLRectObj sRect;
+    sRect.minx = sEnvelope.MinX;
+    sRect.miny = sEnvelope.MinY;
+    sRect.maxx = sEnvelope.MaxX;
+    sRect.maxy = sEnvelope.MaxY;
+    int nCount = 0;
+    void** pahHits = CPLQuadTreeSearch(m_hTree, &sRect, &nCount);
+    if( nCount == 0 )
+    {
+        CPLFree(pahHits);
+        return;
+    }
+    // Elements of m_apoFeatures are contiguous, so sorting the hits by
+    // address restores the order of the layer.
+    std::sort(pahHits, pahHits + nCount);
+
+    OGRPreparedGeometryUniquePtr poPrepared;
+    if( nCount > 1 && OGRHasPreparedGeometrySupport() )
+        poPrepared.reset(OGRCreatePreparedGeometry(poFilter));
+    for( int i = 0; i < nCount; i++ )
+    {
+        OGRFeature *poFeature =
+            static_cast<const OGRFeatureUniquePtr*>(pahHits[i])->get();
+        const OGRGeometry *poGeom = poFeature->GetGeometryRef();
+        if( poPrepared ?
+                OGRPreparedGeometryIntersects(poPrepared.get(), poGeom) :
+                poFilter->Intersects(poGeom) )
+        {
+            apoFeatures.push_back(poFeature);
+        }
+    }
+    CPLFree(pahHits);
+}
+
+/************************************************************************/
+/*                     Overlay method processing                        */
+/************************************************************************/
+
+// A feature to be written in the result layer, with the attributes of
+// poA (and of poB if not NULL) mapped with the corresponding field map.
+struct OGROverlayOutput
+{
+    CPL_DISALLOW_COPY_ASSIGN(OGROverlayOutput)
+
+    OGRFeature          *poA = nullptr;
+    const int           *panMapA = nullptr;
+    OGRFeature          *poB = nullptr;
+    const int           *panMapB = nullptr;
+    OGRGeometryUniquePtr poGeom{};
+
+    OGROverlayOutput( OGRFeature *poAIn, const int *panMapAIn,
+                      OGRFeature *poBIn, const int *panMapBIn,
+                      OGRGeometry *poGeomIn ) :
+        poA(poAIn), panMapA(panMapAIn), poB(poBIn), panMapB(panMapBIn),
+        poGeom(poGeomIn) {}
+
+    // Moved when the output vector grows.
+    OGROverlayOutput( OGROverlayOutput&& ) = default;
+    OGROverlayOutput& operator=( OGROverlayOutput&& ) = default;
+};
+
+typedef std::function<OGRErr(OGRFeature *x, OGRGeometry *x_geom,
+                             const std::vector<OGRFeature*>& apoY,
+                             std::vector<OGROverlayOutput>& aoOutputs)>
+                                                        OGROverlayFeatureFunc;
+
+// One pass of an overlay method: features x are read from poXLayer (or
+// poXIndex), the features y of the other layer intersecting x (and
+// poYFilter) are looked up in poYLayer (or poYIndex), and pfnFunc computes
+// the result features of x.
+struct OGROverlayPass
+{
+    OGRLayer               *poXLayer = nullptr;
+    const OGROverlayIndex  *poXIndex = nullptr;
+    OGRLayer               *poYLayer = nullptr;
+    const OGROverlayIndex  *poYIndex = nullptr;
+    OGRGeometry            *poYFilter = nullptr;
+    const OGREnvelope      *psSkipEnvelope = nullptr;
+    OGROverlayFeatureFunc   pfnFunc{};
+};
+
+struct OGROverlayContext
+{
+    OGRLayer           *poLayerResult = nullptr;
+    OGRFeatureDefn     *poDefnResult = nullptr;
+    bool                bSkipFailures = false;
+    bool                bPromoteToMulti = false;
+    int                 nThreads = 1;
+    GDALProgressFunc    pfnProgress = nullptr;
+    void               *pProgressArg = nullptr;
+    double              dfProgressMax = 0;
+    double              dfProgressCounter = 0;
+};
+
+struct OGROverlayError
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+
+    OGROverlayError( CPLErr eErrClassIn, CPLErrorNum nErrNoIn,
+                     const char* pszMsg ) :
+        eErrClass(eErrClassIn), nErrNo(nErrNoIn), osMsg(pszMsg) {}
+};
+
+struct OGROverlayJob
+{
+    const OGROverlayPass            *psPass = nullptr;
+    bool                             bSkipFailures = false;
+    OGRFeatureUniquePtr              poOwnedX{};
+    OGRFeature                      *poX = nullptr;
+    std::vector<OGRFeatureUniquePtr> apoOwnedY{};
+    std::vector<OGROverlayOutput>    aoOutputs{};
+    std::vector<OGROverlayError>     aoErrors{};
+    OGRErr                           eErr = OGRERR_NONE;
+};
+
+// Emulation of set_filter_from() followed by the iteration of the layer.
+static OGRGeometry *search_from( const OGROverlayIndex *poIndex,
+                                 OGRGeometry *pGeometryExistingFilter,
+                                 OGRFeature *pFeature,
+                                 std::vector<OGRFeature*>& apoFeatures )
+{
+    OGRGeometry *geom = pFeature->GetGeometryRef();
+    if (!geom) return nullptr;
+    if (pGeometryExistingFilter) {
+        if (!geom->Intersects(pGeometryExistingFilter)) return nullptr;
+        OGRGeometryUniquePtr intersection(geom->Intersection(pGeometryExistingFilter));
+        if (!intersection) return nullptr;
+        poIndex->Search(intersection.get(), apoFeatures);
+    } else {
+        poIndex->Search(geom, apoFeatures);
+    }
+    return geom;
+}
+
+static OGRErr OGROverlayProcessFeature( OGROverlayJob& sJob )
+{
+    const OGROverlayPass& sPass = *sJob.psPass;
+    OGRFeature *x = sJob.poX;
+
+    // is it worth to proceed?
+    if (sPass.psSkipEnvelope) {
+        OGRGeometry *x_geom = x->GetGeometryRef();
+        if (!x_geom) return OGRERR_NONE;
+        OGREnvelope x_env;
+        x_geom->getEnvelope(&x_env);
+        if (x_env.MaxX < sPass.psSkipEnvelope->MinX
+            || x_env.MaxY < sPass.psSkipEnvelope->MinY
+            || sPass.psSkipEnvelope->MaxX < x_env.MinX
+            || sPass.psSkipEnvelope->MaxY < x_env.MinY) {
+            return OGRERR_NONE;
+        }
+    }
+
+    // find the features of the other layer that intersect x
+    std::vector<OGRFeature*> apoY;
+    CPLErrorReset();
+    OGRGeometry *x_geom = nullptr;
+    if (sPass.poYIndex) {
+        x_geom = search_from(sPass.poYIndex, sPass.poYFilter, x, apoY);
+    } else {
+        x_geom = set_filter_from(sPass.poYLayer, sPass.poYFilter, x);
+    }
+    if (CPLGetLastErrorType() != CE_None) {
+        if (!sJob.bSkipFailures) {
+            return OGRERR_FAILURE;
+        } else {
+            CPLErrorReset();
+        }
+    }
+    if (!x_geom) {
+        return OGRERR_NONE;
+    }
+    if (!sPass.poYIndex) {
+        // the outputs may refer to those features until they are written
+        for( auto&& y: sPass.poYLayer ) {
+            apoY.push_back(y.get());
+            sJob.apoOwnedY.push_back(std::move(y));
+        }
+    }
+
+    return sPass.pfnFunc(x, x_geom, apoY, sJob.aoOutputs);
+}
+
+static void CPL_STDCALL OGROverlayErrorHandler( CPLErr eErrClass,
+                                                CPLErrorNum nErrNo,
+                                                const char* pszMsg )
+{
+    auto paoErrors = static_cast<std::vector<OGROverlayError>*>(
+        CPLGetErrorHandlerUserData());
+    paoErrors->emplace_back(eErrClass, nErrNo, pszMsg);
+}
+
+static void OGROverlayJobFunc( void* pData )
+{
+    OGROverlayJob *psJob = static_cast<OGROverlayJob*>(pData);
+    // errors are collected, to be emitted by the main thread in order
+    CPLPushErrorHandlerEx(OGROverlayErrorHandler, &psJob->aoErrors);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    psJob->eErr = OGROverlayProcessFeature(*psJob);
+    CPLPopErrorHandler();
+}
+
+// Runs a pass of an overlay method, processing the features x of the pass
+// in parallel if the features y are looked up in an index and several
+// threads are requested. Result features are written in the order of x in
+// any case.
+static OGRErr OGROverlayRunPass( OGROverlayContext& sCtx,
+                                 const OGROverlayPass& sPass )
+{
+    std::unique_ptr<CPLJobQueue> poJobQueue;
+    if (sCtx.nThreads > 1 && sPass.poYIndex) {
+        CPLWorkerThreadPool* poPool =
+            CPLGetGlobalWorkerThreadPool(sCtx.nThreads);
+        if (poPool)
+            poJobQueue = poPool->CreateJobQueue();
+    }
+    const size_t nBatchSize = poJobQueue ? static_cast<size_t>(sCtx.nThreads) * 16 : 1;
+
+    size_t iNextX = 0;
+    if (!sPass.poXIndex)
+        sPass.poXLayer->ResetReading();
+    std::vector<OGROverlayJob> asJobs;
+    while (true) {
+        asJobs.clear();
+        while (asJobs.size() < nBatchSize) {
+            OGROverlayJob sJob;
+            sJob.psPass = &sPass;
+            sJob.bSkipFailures = sCtx.bSkipFailures;
+            if (sPass.poXIndex) {
+                if (iNextX == sPass.poXIndex->GetFeatureCount()) break;
+                sJob.poX = sPass.poXIndex->GetFeature(iNextX++);
+            } else {
+                sJob.poOwnedX.reset(sPass.poXLayer->GetNextFeature());
+                if (!sJob.poOwnedX) break;
+                sJob.poX = sJob.poOwnedX.get();
+            }
+            asJobs.push_back(std::move(sJob));
+        }
+        if (asJobs.empty())
+            break;
+
+        if (poJobQueue) {
+            for( auto& sJob: asJobs ) {
+                if (!poJobQueue->SubmitJob(OGROverlayJobFunc, &sJob))
+                    OGROverlayJobFunc(&sJob);
+            }
+            poJobQueue->WaitCompletion();
+        }
+
+        for( auto& sJob: asJobs ) {
+            if (sCtx.pfnProgress) {
+                double p = sCtx.dfProgressCounter/sCtx.dfProgressMax;
+                if (p > 0) {
+                    if (!sCtx.pfnProgress(p, "", sCtx.pProgressArg)) {
+                        CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+                        return OGRERR_FAILURE;
+                    }
+                }
+                sCtx.dfProgressCounter += 1.0;
+            }
+
+            if (poJobQueue) {
+                for( const auto& oError: sJob.aoErrors )
+                    CPLError(oError.eErrClass, oError.nErrNo, "%s",
+                             oError.osMsg.c_str());
+                if (!sJob.aoErrors.empty() && sCtx.bSkipFailures &&
+                    sJob.eErr == OGRERR_NONE)
+                    CPLErrorReset();
+            } else {
+                sJob.eErr = OGROverlayProcessFeature(sJob);
+            }
+
+            for( auto& oOutput: sJob.aoOutputs ) {
+                OGRFeatureUniquePtr z(new OGRFeature(sCtx.poDefnResult));
+                z->SetFieldsFrom(oOutput.poA, oOutput.panMapA);
+                if (oOutput.poB)
+                    z->SetFieldsFrom(oOutput.poB, oOutput.panMapB);
+                if (sCtx.bPromoteToMulti)
+                    oOutput.poGeom.reset(promote_to_multi(oOutput.poGeom.release()));
+                z->SetGeometryDirectly(oOutput.poGeom.release());
+                OGRErr ret = sCtx.poLayerResult->CreateFeature(z.get());
+                if (ret != OGRERR_NONE) {
+                    if (!sCtx.bSkipFailures) {
+                        return ret;
+                    } else {
+                        CPLErrorReset();
+                    }
+                }
+            }
+            if (sJob.eErr != OGRERR_NONE)
+                return sJob.eErr;
+        }
+    }
+    return OGRERR_NONE;
+}
+
+// Reads USE_SPATIAL_INDEX and NUM_THREADS.
+static bool OGROverlayGetIndexOptions( char** papszOptions, int *pnThreads )
+{
+    const bool bUseIndex = CPLTestBool(
+        CSLFetchNameValueDef(papszOptions, "USE_SPATIAL_INDEX", "YES"));
+    *pnThreads = CPLGetNumThreads(papszOptions);
+    if (!bUseIndex)
+        *pnThreads = 1;
+    return bUseIndex;
+}
+
+} // namespace
+
 /************************************************************************/
 /*                          Intersection()                              */
 /************************************************************************/
@@ -2034,6 +2539,14 @@ static OGRGeometry* promote_to_multi(OGRGeometry* poGeom)
  *     result features with lower dimension geometry that would
  *     otherwise be added to the result layer. The default is to add
  *     but only if the result layer has an unknown geometry type.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of the method layer in memory with a spatial index, and query the
+ *     method layer with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This method is the same as the C function OGR_L_Intersection().
@@ -2068,21 +2581,22 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     int *mapInput = nullptr;
     int *mapMethod = nullptr;
     OGREnvelope sEnvelopeMethod;
     GBool bEnvelopeSet;
-    double progress_max = static_cast<double>(GetFeatureCount(FALSE));
-    double progress_counter = 0;
-    double progress_ticker = 0;
+    OGROverlayContext sCtx;
+    OGROverlayPass sPass;
+    OGROverlayIndex oMethodIndex;
     int bSkipFailures = CPLTestBool(CSLFetchNameValueDef(papszOptions, "SKIP_FAILURES", "NO"));
     int bPromoteToMulti = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PROMOTE_TO_MULTI", "NO"));
     int bUsePreparedGeometries = CPLTestBool(CSLFetchNameValueDef(papszOptions, "USE_PREPARED_GEOMETRIES", "YES"));
     if (bUsePreparedGeometries) bUsePreparedGeometries = OGRHasPreparedGeometrySupport();
     int bPretestContainment = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PRETEST_CONTAINMENT", "NO"));
     int bKeepLowerDimGeom = CPLTestBool(CSLFetchNameValueDef(papszOptions, "KEEP_LOWER_DIMENSION_GEOMETRIES", "YES"));
+    int nThreads = 1;
+    const bool bUseIndex = OGROverlayGetIndexOptions(papszOptions, &nThreads);
 
     // check for GEOS
     if (!OGRGeometryFactory::haveGEOS()) {
@@ -2098,7 +2612,6 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, true, papszOptions);
     if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
     bEnvelopeSet = pLayerMethod->GetExtent(&sEnvelopeMethod, 1) == OGRERR_NONE;
     if (bKeepLowerDimGeom) {
         // require that the result layer is of geom type unknown
@@ -2107,70 +2620,44 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
             bKeepLowerDimGeom = FALSE;
         }
     }
+    if (bUseIndex) {
+        ret = oMethodIndex.Load(pLayerMethod);
+        if (ret != OGRERR_NONE) goto done;
+    }
 
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // is it worth to proceed?
-        if (bEnvelopeSet) {
-            OGRGeometry *x_geom = x->GetGeometryRef();
-            if (x_geom) {
-                OGREnvelope x_env;
-                x_geom->getEnvelope(&x_env);
-                if (x_env.MaxX < sEnvelopeMethod.MinX
-                    || x_env.MaxY < sEnvelopeMethod.MinY
-                    || sEnvelopeMethod.MaxX < x_env.MinX
-                    || sEnvelopeMethod.MaxY < x_env.MinY) {
-                    continue;
-                }
-            } else {
-                continue;
-            }
-        }
-
-        // set up the filter for method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
+    sCtx.poLayerResult = pLayerResult;
+    sCtx.poDefnResult = pLayerResult->GetLayerDefn();
+    sCtx.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sCtx.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sCtx.nThreads = nThreads;
+    sCtx.pfnProgress = pfnProgress;
+    sCtx.pProgressArg = pProgressArg;
+    sCtx.dfProgressMax = static_cast<double>(GetFeatureCount(FALSE));
+
+    sPass.poXLayer = this;
+    sPass.poYLayer = pLayerMethod;
+    sPass.poYIndex = bUseIndex ? &oMethodIndex : nullptr;
+    sPass.poYFilter = pGeometryMethodFilter;
+    sPass.psSkipEnvelope = bEnvelopeSet ? &sEnvelopeMethod : nullptr;
+    sPass.pfnFunc = [&](OGRFeature *x, OGRGeometry *x_geom,
+                        const std::vector<OGRFeature*>& apoY,
+                        std::vector<OGROverlayOutput>& aoOutputs) -> OGRErr
+    {
         OGRPreparedGeometryUniquePtr x_prepared_geom;
         if (bUsePreparedGeometries) {
             x_prepared_geom.reset(OGRCreatePreparedGeometry(x_geom));
             if (!x_prepared_geom) {
-                goto done;
+                return OGRERR_FAILURE;
             }
         }
 
-        for( auto&& y: pLayerMethod ) {
+        for( OGRFeature *y: apoY ) {
             OGRGeometry *y_geom = y->GetGeometryRef();
             if (!y_geom) continue;
             OGRGeometryUniquePtr z_geom;
 
             if (x_prepared_geom) {
                 CPLErrorReset();
-                ret = OGRERR_NONE;
                 if (bPretestContainment && OGRPreparedGeometryContains(x_prepared_geom.get(), y_geom))
                 {
                     if (CPLGetLastErrorType() == CE_None)
@@ -2184,11 +2671,9 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
                 }
                 if (CPLGetLastErrorType() != CE_None) {
                     if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
+                        return OGRERR_FAILURE;
                     } else {
                         CPLErrorReset();
-                        ret = OGRERR_NONE;
                         continue;
                     }
                 }
@@ -2198,11 +2683,9 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
                 z_geom.reset(x_geom->Intersection(y_geom));
                 if (CPLGetLastErrorType() != CE_None || z_geom == nullptr) {
                     if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
+                        return OGRERR_FAILURE;
                     } else {
                         CPLErrorReset();
-                        ret = OGRERR_NONE;
                         continue;
                     }
                 }
@@ -2214,24 +2697,14 @@ OGRErr OGRLayer::Intersection( OGRLayer *pLayerMethod,
                     continue;
                 }
             }
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            z->SetFieldsFrom(y.get(), mapMethod);
-            if (bPromoteToMulti)
-                z_geom.reset(promote_to_multi(z_geom.release()));
-            z->SetGeometryDirectly(z_geom.release());
-            ret = pLayerResult->CreateFeature(z.get());
-
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
+            aoOutputs.emplace_back(x, mapInput, y, mapMethod, z_geom.release());
         }
-    }
+        return OGRERR_NONE;
+    };
+
+    ret = OGROverlayRunPass(sCtx, sPass);
+    if (ret != OGRERR_NONE) goto done;
+
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -2291,6 +2764,14 @@ done:
  *     result features with lower dimension geometry that would
  *     otherwise be added to the result layer. The default is to add
  *     but only if the result layer has an unknown geometry type.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of the method layer in memory with a spatial index, and query the
+ *     method layer with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This function is the same as the C++ method OGRLayer::Intersection().
@@ -2380,6 +2861,14 @@ OGRErr OGR_L_Intersection( OGRLayerH pLayerInput,
  *     result features with lower dimension geometry that would
  *     otherwise be added to the result layer. The default is to add
  *     but only if the result layer has an unknown geometry type.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of both layers in memory with a spatial index, and query the
+ *     layers with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This method is the same as the C function OGR_L_Union().
@@ -2414,19 +2903,21 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
     OGRFeatureDefn *poDefnMethod = pLayerMethod->GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     OGRGeometry *pGeometryInputFilter = nullptr;
     int *mapInput = nullptr;
     int *mapMethod = nullptr;
-    double progress_max = static_cast<double>(GetFeatureCount(FALSE)) + static_cast<double>(pLayerMethod->GetFeatureCount(FALSE));
-    double progress_counter = 0;
-    double progress_ticker = 0;
+    OGROverlayContext sCtx;
+    OGROverlayPass sPass;
+    OGROverlayIndex oInputIndex;
+    OGROverlayIndex oMethodIndex;
     int bSkipFailures = CPLTestBool(CSLFetchNameValueDef(papszOptions, "SKIP_FAILURES", "NO"));
     int bPromoteToMulti = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PROMOTE_TO_MULTI", "NO"));
     int bUsePreparedGeometries = CPLTestBool(CSLFetchNameValueDef(papszOptions, "USE_PREPARED_GEOMETRIES", "YES"));
     if (bUsePreparedGeometries) bUsePreparedGeometries = OGRHasPreparedGeometrySupport();
     int bKeepLowerDimGeom = CPLTestBool(CSLFetchNameValueDef(papszOptions, "KEEP_LOWER_DIMENSION_GEOMETRIES", "YES"));
+    int nThreads = 1;
+    const bool bUseIndex = OGROverlayGetIndexOptions(papszOptions, &nThreads);
 
     // check for GEOS
     if (!OGRGeometryFactory::haveGEOS()) {
@@ -2444,7 +2935,6 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, poDefnMethod, mapInput, mapMethod, true, papszOptions);
     if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
     if (bKeepLowerDimGeom) {
         // require that the result layer is of geom type unknown
         if (pLayerResult->GetGeomType() != wkbUnknown) {
@@ -2452,48 +2942,43 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
             bKeepLowerDimGeom = FALSE;
         }
     }
+    if (bUseIndex) {
+        // both layers are looked up, in one pass or the other
+        ret = oInputIndex.Load(this);
+        if (ret != OGRERR_NONE) goto done;
+        ret = oMethodIndex.Load(pLayerMethod);
+        if (ret != OGRERR_NONE) goto done;
+    }
 
-    // add features based on input layer
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
+    sCtx.poLayerResult = pLayerResult;
+    sCtx.poDefnResult = pLayerResult->GetLayerDefn();
+    sCtx.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sCtx.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sCtx.nThreads = nThreads;
+    sCtx.pfnProgress = pfnProgress;
+    sCtx.pProgressArg = pProgressArg;
+    sCtx.dfProgressMax = static_cast<double>(GetFeatureCount(FALSE)) + static_cast<double>(pLayerMethod->GetFeatureCount(FALSE));
 
+    // add features based on input layer
+    sPass.poXLayer = this;
+    sPass.poXIndex = bUseIndex ? &oInputIndex : nullptr;
+    sPass.poYLayer = pLayerMethod;
+    sPass.poYIndex = bUseIndex ? &oMethodIndex : nullptr;
+    sPass.poYFilter = pGeometryMethodFilter;
+    sPass.pfnFunc = [&](OGRFeature *x, OGRGeometry *x_geom,
+                        const std::vector<OGRFeature*>& apoY,
+                        std::vector<OGROverlayOutput>& aoOutputs) -> OGRErr
+    {
         OGRPreparedGeometryUniquePtr x_prepared_geom;
         if (bUsePreparedGeometries) {
             x_prepared_geom.reset(OGRCreatePreparedGeometry(x_geom));
             if (!x_prepared_geom) {
-                goto done;
+                return OGRERR_FAILURE;
             }
         }
 
         OGRGeometryUniquePtr x_geom_diff(x_geom->clone()); // this will be the geometry of the result feature
-        for( auto&& y: pLayerMethod) {
+        for( OGRFeature *y: apoY ) {
             OGRGeometry *y_geom = y->GetGeometryRef();
             if (!y_geom) { continue;}
 
@@ -2505,11 +2990,9 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
             }
             if (CPLGetLastErrorType() != CE_None) {
                 if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
+                    return OGRERR_FAILURE;
                 } else {
                     CPLErrorReset();
-                    ret = OGRERR_NONE;
                 }
             }
 
@@ -2517,11 +3000,9 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
             OGRGeometryUniquePtr poIntersection(x_geom->Intersection(y_geom));
             if (CPLGetLastErrorType() != CE_None || poIntersection == nullptr) {
                 if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
+                    return OGRERR_FAILURE;
                 } else {
                     CPLErrorReset();
-                    ret = OGRERR_NONE;
                     continue;
                 }
             }
@@ -2534,20 +3015,12 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
             }
             else
             {
-                OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-                z->SetFieldsFrom(x.get(), mapInput);
-                z->SetFieldsFrom(y.get(), mapMethod);
-                if( bPromoteToMulti )
-                    poIntersection.reset(promote_to_multi(poIntersection.release()));
-                z->SetGeometryDirectly(poIntersection.release());
-
                 if (x_geom_diff) {
                     CPLErrorReset();
                     OGRGeometryUniquePtr x_geom_diff_new(x_geom_diff->Difference(y_geom));
                     if (CPLGetLastErrorType() != CE_None || x_geom_diff_new == nullptr) {
                         if (!bSkipFailures) {
-                            ret = OGRERR_FAILURE;
-                            goto done;
+                            return OGRERR_FAILURE;
                         } else {
                             CPLErrorReset();
                         }
@@ -2556,15 +3029,7 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
                     }
                 }
 
-                ret = pLayerResult->CreateFeature(z.get());
-                if (ret != OGRERR_NONE) {
-                    if (!bSkipFailures) {
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                }
+                aoOutputs.emplace_back(x, mapInput, y, mapMethod, poIntersection.release());
             }
         }
         x_prepared_geom.reset();
@@ -2575,57 +3040,26 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
         }
         else
         {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            if( bPromoteToMulti )
-                x_geom_diff.reset(promote_to_multi(x_geom_diff.release()));
-            z->SetGeometryDirectly(x_geom_diff.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
+            aoOutputs.emplace_back(x, mapInput, nullptr, nullptr, x_geom_diff.release());
         }
-    }
+        return OGRERR_NONE;
+    };
+    ret = OGROverlayRunPass(sCtx, sPass);
+    if (ret != OGRERR_NONE) goto done;
 
     // restore filter on method layer and add features based on it
     pLayerMethod->SetSpatialFilter(pGeometryMethodFilter);
-    for( auto&& x: pLayerMethod ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on input layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(this, pGeometryInputFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
+    sPass.poXLayer = pLayerMethod;
+    sPass.poXIndex = bUseIndex ? &oMethodIndex : nullptr;
+    sPass.poYLayer = this;
+    sPass.poYIndex = bUseIndex ? &oInputIndex : nullptr;
+    sPass.poYFilter = pGeometryInputFilter;
+    sPass.pfnFunc = [&](OGRFeature *x, OGRGeometry *x_geom,
+                        const std::vector<OGRFeature*>& apoY,
+                        std::vector<OGROverlayOutput>& aoOutputs) -> OGRErr
+    {
         OGRGeometryUniquePtr x_geom_diff(x_geom->clone()); // this will be the geometry of the result feature
-        for( auto&& y: this ) {
+        for( OGRFeature *y: apoY ) {
             OGRGeometry *y_geom = y->GetGeometryRef();
             if (!y_geom) { continue;}
 
@@ -2634,11 +3068,9 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
                 OGRGeometryUniquePtr x_geom_diff_new(x_geom_diff->Difference(y_geom));
                 if (CPLGetLastErrorType() != CE_None || x_geom_diff_new == nullptr) {
                     if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
+                        return OGRERR_FAILURE;
                     } else {
                         CPLErrorReset();
-                        ret = OGRERR_NONE;
                     }
                 } else {
                     x_geom_diff.swap(x_geom_diff_new);
@@ -2652,22 +3084,13 @@ OGRErr OGRLayer::Union( OGRLayer *pLayerMethod,
         }
         else
         {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapMethod);
-            if( bPromoteToMulti )
-                x_geom_diff.reset(promote_to_multi(x_geom_diff.release()));
-            z->SetGeometryDirectly(x_geom_diff.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
+            aoOutputs.emplace_back(x, mapMethod, nullptr, nullptr, x_geom_diff.release());
         }
-    }
+        return OGRERR_NONE;
+    };
+    ret = OGROverlayRunPass(sCtx, sPass);
+    if (ret != OGRERR_NONE) goto done;
+
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -2728,6 +3151,14 @@ done:
  *     result features with lower dimension geometry that would
  *     otherwise be added to the result layer. The default is to add
  *     but only if the result layer has an unknown geometry type.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of both layers in memory with a spatial index, and query the
+ *     layers with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This function is the same as the C++ method OGRLayer::Union().
@@ -3792,6 +4223,14 @@ OGRErr OGR_L_Update( OGRLayerH pLayerInput,
  *     will be created from the fields of the input layer.
  * <li>METHOD_PREFIX=string. Set a prefix for the field names that
  *     will be created from the fields of the method layer.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of the method layer in memory with a spatial index, and query the
+ *     method layer with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This method is the same as the C function OGR_L_Clip().
@@ -3825,14 +4264,15 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
 {
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     int *mapInput = nullptr;
-    double progress_max = static_cast<double>(GetFeatureCount(FALSE));
-    double progress_counter = 0;
-    double progress_ticker = 0;
+    OGROverlayContext sCtx;
+    OGROverlayPass sPass;
+    OGROverlayIndex oMethodIndex;
     int bSkipFailures = CPLTestBool(CSLFetchNameValueDef(papszOptions, "SKIP_FAILURES", "NO"));
     int bPromoteToMulti = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PROMOTE_TO_MULTI", "NO"));
+    int nThreads = 1;
+    const bool bUseIndex = OGROverlayGetIndexOptions(papszOptions, &nThreads);
 
     // check for GEOS
     if (!OGRGeometryFactory::haveGEOS()) {
@@ -3845,41 +4285,31 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, nullptr, mapInput, nullptr, false, papszOptions);
     if (ret != OGRERR_NONE) goto done;
+    if (bUseIndex) {
+        ret = oMethodIndex.Load(pLayerMethod);
+        if (ret != OGRERR_NONE) goto done;
+    }
 
-    poDefnResult = pLayerResult->GetLayerDefn();
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
-
+    sCtx.poLayerResult = pLayerResult;
+    sCtx.poDefnResult = pLayerResult->GetLayerDefn();
+    sCtx.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sCtx.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sCtx.nThreads = nThreads;
+    sCtx.pfnProgress = pfnProgress;
+    sCtx.pProgressArg = pProgressArg;
+    sCtx.dfProgressMax = static_cast<double>(GetFeatureCount(FALSE));
+
+    sPass.poXLayer = this;
+    sPass.poYLayer = pLayerMethod;
+    sPass.poYIndex = bUseIndex ? &oMethodIndex : nullptr;
+    sPass.poYFilter = pGeometryMethodFilter;
+    sPass.pfnFunc = [&](OGRFeature *x, OGRGeometry *x_geom,
+                        const std::vector<OGRFeature*>& apoY,
+                        std::vector<OGROverlayOutput>& aoOutputs) -> OGRErr
+    {
         OGRGeometryUniquePtr geom; // this will be the geometry of the result feature
         // incrementally add area from y to geom
-        for( auto&& y: pLayerMethod ) {
+        for( OGRFeature *y: apoY ) {
             OGRGeometry *y_geom = y->GetGeometryRef();
             if (!y_geom) continue;
             if (!geom) {
@@ -3889,11 +4319,9 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
                 OGRGeometryUniquePtr geom_new(geom->Union(y_geom));
                 if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
                     if (!bSkipFailures) {
-                        ret = OGRERR_FAILURE;
-                        goto done;
+                        return OGRERR_FAILURE;
                     } else {
                         CPLErrorReset();
-                        ret = OGRERR_NONE;
                     }
                 } else {
                     geom.swap(geom_new);
@@ -3907,32 +4335,22 @@ OGRErr OGRLayer::Clip( OGRLayer *pLayerMethod,
             OGRGeometryUniquePtr poIntersection(x_geom->Intersection(geom.get()));
             if (CPLGetLastErrorType() != CE_None || poIntersection == nullptr) {
                 if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
+                    return OGRERR_FAILURE;
                 } else {
                     CPLErrorReset();
-                    ret = OGRERR_NONE;
                 }
             }
             else if( !poIntersection->IsEmpty() )
             {
-                OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-                z->SetFieldsFrom(x.get(), mapInput);
-                if( bPromoteToMulti )
-                    poIntersection.reset(promote_to_multi(poIntersection.release()));
-                z->SetGeometryDirectly(poIntersection.release());
-                ret = pLayerResult->CreateFeature(z.get());
-                if (ret != OGRERR_NONE) {
-                    if (!bSkipFailures) {
-                        goto done;
-                    } else {
-                        CPLErrorReset();
-                        ret = OGRERR_NONE;
-                    }
-                }
+                aoOutputs.emplace_back(x, mapInput, nullptr, nullptr, poIntersection.release());
             }
         }
-    }
+        return OGRERR_NONE;
+    };
+
+    ret = OGROverlayRunPass(sCtx, sPass);
+    if (ret != OGRERR_NONE) goto done;
+
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -3976,6 +4394,14 @@ done:
  *     will be created from the fields of the input layer.
  * <li>METHOD_PREFIX=string. Set a prefix for the field names that
  *     will be created from the fields of the method layer.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of the method layer in memory with a spatial index, and query the
+ *     method layer with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This function is the same as the C++ method OGRLayer::Clip().
@@ -4051,6 +4477,14 @@ OGRErr OGR_L_Clip( OGRLayerH pLayerInput,
  *     will be created from the fields of the input layer.
  * <li>METHOD_PREFIX=string. Set a prefix for the field names that
  *     will be created from the fields of the method layer.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of the method layer in memory with a spatial index, and query the
+ *     method layer with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This method is the same as the C function OGR_L_Erase().
@@ -4084,14 +4518,15 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
 {
     OGRErr ret = OGRERR_NONE;
     OGRFeatureDefn *poDefnInput = GetLayerDefn();
-    OGRFeatureDefn *poDefnResult = nullptr;
     OGRGeometry *pGeometryMethodFilter = nullptr;
     int *mapInput = nullptr;
-    double progress_max = static_cast<double>(GetFeatureCount(FALSE));
-    double progress_counter = 0;
-    double progress_ticker = 0;
+    OGROverlayContext sCtx;
+    OGROverlayPass sPass;
+    OGROverlayIndex oMethodIndex;
     int bSkipFailures = CPLTestBool(CSLFetchNameValueDef(papszOptions, "SKIP_FAILURES", "NO"));
     int bPromoteToMulti = CPLTestBool(CSLFetchNameValueDef(papszOptions, "PROMOTE_TO_MULTI", "NO"));
+    int nThreads = 1;
+    const bool bUseIndex = OGROverlayGetIndexOptions(papszOptions, &nThreads);
 
     // check for GEOS
     if (!OGRGeometryFactory::haveGEOS()) {
@@ -4105,52 +4540,40 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
     if (ret != OGRERR_NONE) goto done;
     ret = set_result_schema(pLayerResult, poDefnInput, nullptr, mapInput, nullptr, false, papszOptions);
     if (ret != OGRERR_NONE) goto done;
-    poDefnResult = pLayerResult->GetLayerDefn();
-
-    for( auto&& x: this ) {
-
-        if (pfnProgress) {
-            double p = progress_counter/progress_max;
-            if (p > progress_ticker) {
-                if (!pfnProgress(p, "", pProgressArg)) {
-                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-                    ret = OGRERR_FAILURE;
-                    goto done;
-                }
-            }
-            progress_counter += 1.0;
-        }
-
-        // set up the filter on the method layer
-        CPLErrorReset();
-        OGRGeometry *x_geom = set_filter_from(pLayerMethod, pGeometryMethodFilter, x.get());
-        if (CPLGetLastErrorType() != CE_None) {
-            if (!bSkipFailures) {
-                ret = OGRERR_FAILURE;
-                goto done;
-            } else {
-                CPLErrorReset();
-                ret = OGRERR_NONE;
-            }
-        }
-        if (!x_geom) {
-            continue;
-        }
+    if (bUseIndex) {
+        ret = oMethodIndex.Load(pLayerMethod);
+        if (ret != OGRERR_NONE) goto done;
+    }
 
+    sCtx.poLayerResult = pLayerResult;
+    sCtx.poDefnResult = pLayerResult->GetLayerDefn();
+    sCtx.bSkipFailures = CPL_TO_BOOL(bSkipFailures);
+    sCtx.bPromoteToMulti = CPL_TO_BOOL(bPromoteToMulti);
+    sCtx.nThreads = nThreads;
+    sCtx.pfnProgress = pfnProgress;
+    sCtx.pProgressArg = pProgressArg;
+    sCtx.dfProgressMax = static_cast<double>(GetFeatureCount(FALSE));
+
+    sPass.poXLayer = this;
+    sPass.poYLayer = pLayerMethod;
+    sPass.poYIndex = bUseIndex ? &oMethodIndex : nullptr;
+    sPass.poYFilter = pGeometryMethodFilter;
+    sPass.pfnFunc = [&](OGRFeature *x, OGRGeometry *x_geom,
+                        const std::vector<OGRFeature*>& apoY,
+                        std::vector<OGROverlayOutput>& aoOutputs) -> OGRErr
+    {
         OGRGeometryUniquePtr geom(x_geom->clone()); // this will be the geometry of the result feature
         // incrementally erase y from geom
-        for( auto&& y: pLayerMethod ) {
+        for( OGRFeature *y: apoY ) {
             OGRGeometry *y_geom = y->GetGeometryRef();
             if (!y_geom) continue;
             CPLErrorReset();
             OGRGeometryUniquePtr geom_new(geom->Difference(y_geom));
             if (CPLGetLastErrorType() != CE_None || geom_new == nullptr) {
                 if (!bSkipFailures) {
-                    ret = OGRERR_FAILURE;
-                    goto done;
+                    return OGRERR_FAILURE;
                 } else {
                     CPLErrorReset();
-                    ret = OGRERR_NONE;
                 }
             } else {
                 geom.swap(geom_new);
@@ -4163,22 +4586,14 @@ OGRErr OGRLayer::Erase( OGRLayer *pLayerMethod,
 
         // add a new feature if there is remaining area
         if (!geom->IsEmpty()) {
-            OGRFeatureUniquePtr z(new OGRFeature(poDefnResult));
-            z->SetFieldsFrom(x.get(), mapInput);
-            if( bPromoteToMulti )
-                geom.reset(promote_to_multi(geom.release()));
-            z->SetGeometryDirectly(geom.release());
-            ret = pLayerResult->CreateFeature(z.get());
-            if (ret != OGRERR_NONE) {
-                if (!bSkipFailures) {
-                    goto done;
-                } else {
-                    CPLErrorReset();
-                    ret = OGRERR_NONE;
-                }
-            }
+            aoOutputs.emplace_back(x, mapInput, nullptr, nullptr, geom.release());
         }
-    }
+        return OGRERR_NONE;
+    };
+
+    ret = OGROverlayRunPass(sCtx, sPass);
+    if (ret != OGRERR_NONE) goto done;
+
     if (pfnProgress && !pfnProgress(1.0, "", pProgressArg)) {
       CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
       ret = OGRERR_FAILURE;
@@ -4222,6 +4637,14 @@ done:
  *     will be created from the fields of the input layer.
  * <li>METHOD_PREFIX=string. Set a prefix for the field names that
  *     will be created from the fields of the method layer.
+ * <li>USE_SPATIAL_INDEX=YES/NO. Set to NO to not load the features
+ *     of the method layer in memory with a spatial index, and query the
+ *     method layer with a spatial filter for each feature instead.
+ *     (GDAL >= 3.1)
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ *     process the features. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1. Requires USE_SPATIAL_INDEX=YES.
+ *     (GDAL >= 3.1)
  * </ul>
  *
  * This function is the same as the C++ method OGRLayer::Erase().
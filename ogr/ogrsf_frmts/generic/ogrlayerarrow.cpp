@@ -0,0 +1,1104 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Arrow C Data Interface batch reading of OGR layers.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogrlayerarrow.h"
+#include "ogr_api.h"
+#include "cpl_time.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+CPL_CVSID("$Id$")
+
+constexpr int DEFAULT_MAX_FEATURES_IN_BATCH = 65536;
+
+/************************************************************************/
+/*                         GetArrowFormat()                             */
+/************************************************************************/
+
+static const char* GetArrowFormat( OGRFieldType eType,
+                                   OGRFieldSubType eSubType,
+                                   const char** ppszChildFormat )
+{
+    *ppszChildFormat = nullptr;
+    switch( eType )
+    {
+        case OFTInteger:
+            if( eSubType == OFSTBoolean )
+                return "b";
+            if( eSubType == OFSTInt16 )
+                return "s";
+            return "i";
+        case OFTInteger64:
+            return "l";
+        case OFTReal:
+            return eSubType == OFSTFloat32 ? "f" : "g";
+        case OFTBinary:
+            return "z";
+        case OFTDate:
+            return "tdD";
+        case OFTTime:
+            return "ttm";
+        case OFTDateTime:
+            return "tsm:";
+        case OFTIntegerList:
+            *ppszChildFormat = "i";
+            return "+l";
+        case OFTInteger64List:
+            *ppszChildFormat = "l";
+            return "+l";
+        case OFTRealList:
+            *ppszChildFormat = "g";
+            return "+l";
+        case OFTStringList:
+        case OFTWideStringList:
+            *ppszChildFormat = "u";
+            return "+l";
+        default:
+            break;
+    }
+    return "u";
+}
+
+/************************************************************************/
+/*                        GetArrowValueSize()                           */
+/************************************************************************/
+
+static int GetArrowValueSize( const char* pszFormat )
+{
+    if( strcmp(pszFormat, "b") == 0 )
+        return -1;
+    if( strcmp(pszFormat, "s") == 0 )
+        return 2;
+    if( strcmp(pszFormat, "i") == 0 || strcmp(pszFormat, "f") == 0 ||
+        strcmp(pszFormat, "tdD") == 0 || strcmp(pszFormat, "ttm") == 0 )
+        return 4;
+    if( strcmp(pszFormat, "l") == 0 || strcmp(pszFormat, "g") == 0 ||
+        strcmp(pszFormat, "tsm:") == 0 )
+        return 8;
+    return 0;
+}
+
+/************************************************************************/
+/*                        OGRArrowArrayBuilder()                        */
+/************************************************************************/
+
+OGRArrowArrayBuilder::OGRArrowArrayBuilder( OGRFeatureDefn* poDefn,
+                                            bool bIncludeFID )
+{
+    const auto AddColumn = [this](const char* pszFormat,
+                                  const char* pszChildFormat)
+    {
+        Column oCol;
+        oCol.osFormat = pszFormat;
+        oCol.nValueSize = GetArrowValueSize(pszFormat);
+        if( pszChildFormat )
+        {
+            oCol.osChildFormat = pszChildFormat;
+            oCol.nChildValueSize = GetArrowValueSize(pszChildFormat);
+            if( oCol.nChildValueSize == 0 )
+                oCol.anChildOffsets.push_back(0);
+        }
+        if( oCol.nValueSize == 0 )
+            oCol.anOffsets.push_back(0);
+        m_aoColumns.push_back(std::move(oCol));
+        return static_cast<int>(m_aoColumns.size()) - 1;
+    };
+
+    if( bIncludeFID )
+    {
+        m_nFIDColumn = AddColumn("l", nullptr);
+        m_aoColumns.back().eType = OFTInteger64;
+        m_aoColumns.back().bNullable = false;
+    }
+
+    const int nFieldCount = poDefn->GetFieldCount();
+    m_anFieldToColumn.resize(nFieldCount, -1);
+    for( int i = 0; i < nFieldCount; i++ )
+    {
+        const OGRFieldDefn* poFieldDefn = poDefn->GetFieldDefn(i);
+        if( poFieldDefn->IsIgnored() )
+            continue;
+        const char* pszChildFormat = nullptr;
+        const char* pszFormat = GetArrowFormat(poFieldDefn->GetType(),
+                                               poFieldDefn->GetSubType(),
+                                               &pszChildFormat);
+        m_anFieldToColumn[i] = AddColumn(pszFormat, pszChildFormat);
+        m_aoColumns.back().eType = poFieldDefn->GetType();
+        m_aoColumns.back().eSubType = poFieldDefn->GetSubType();
+    }
+
+    const int nGeomFieldCount = poDefn->GetGeomFieldCount();
+    m_anGeomFieldToColumn.resize(nGeomFieldCount, -1);
+    for( int i = 0; i < nGeomFieldCount; i++ )
+    {
+        if( poDefn->GetGeomFieldDefn(i)->IsIgnored() )
+            continue;
+        m_anGeomFieldToColumn[i] = AddColumn("z", nullptr);
+        m_aoColumns.back().eType = OFTBinary;
+    }
+}
+
+/************************************************************************/
+/*                             IncludeFID()                             */
+/************************************************************************/
+
+bool OGRArrowArrayBuilder::IncludeFID( CSLConstList papszOptions )
+{
+    return CPLTestBool(
+        CSLFetchNameValueDef(papszOptions, "INCLUDE_FID", "YES"));
+}
+
+/************************************************************************/
+/*                       GetMaxFeaturesInBatch()                        */
+/************************************************************************/
+
+int OGRArrowArrayBuilder::GetMaxFeaturesInBatch( CSLConstList papszOptions )
+{
+    int nMax = atoi(CSLFetchNameValueDef(papszOptions,
+                                         "MAX_FEATURES_IN_BATCH",
+                                         CPLSPrintf("%d",
+                                            DEFAULT_MAX_FEATURES_IN_BATCH)));
+    if( nMax <= 0 )
+        nMax = 1;
+    return nMax;
+}
+
+/************************************************************************/
+/*                          FillSchema()                                */
+/************************************************************************/
+
+static void OGRArrowSchemaRelease( struct ArrowSchema* schema )
+{
+    for( int64_t i = 0; i < schema->n_children; i++ )
+    {
+        struct ArrowSchema* psChild = schema->children[i];
+        if( psChild->release )
+            psChild->release(psChild);
+        delete psChild;
+    }
+    delete[] schema->children;
+    CPLFree(const_cast<char*>(schema->format));
+    CPLFree(const_cast<char*>(schema->name));
+    CPLFree(const_cast<char*>(schema->metadata));
+    schema->release = nullptr;
+}
+
+static struct ArrowSchema* OGRArrowSchemaCreate( const char* pszFormat,
+                                                 const char* pszName,
+                                                 bool bNullable )
+{
+    struct ArrowSchema* psSchema = new struct ArrowSchema;
+    memset(psSchema, 0, sizeof(*psSchema));
+    psSchema->format = CPLStrdup(pszFormat);
+    psSchema->name = CPLStrdup(pszName);
+    psSchema->flags = bNullable ? ARROW_FLAG_NULLABLE : 0;
+    psSchema->release = OGRArrowSchemaRelease;
+    return psSchema;
+}
+
+// Encode a single key/value pair with the binary layout of
+// ArrowSchema::metadata.
+static char* OGRArrowEncodeMetadata( const char* pszKey,
+                                     const char* pszValue )
+{
+    const GInt32 nKeyLen = static_cast<GInt32>(strlen(pszKey));
+    const GInt32 nValueLen = static_cast<GInt32>(strlen(pszValue));
+    const GInt32 nPairs = 1;
+    char* pszMetadata = static_cast<char*>(
+        CPLMalloc(3 * sizeof(GInt32) + nKeyLen + nValueLen));
+    char* pszIter = pszMetadata;
+    memcpy(pszIter, &nPairs, sizeof(GInt32));
+    pszIter += sizeof(GInt32);
+    memcpy(pszIter, &nKeyLen, sizeof(GInt32));
+    pszIter += sizeof(GInt32);
+    memcpy(pszIter, pszKey, nKeyLen);
+    pszIter += nKeyLen;
+    memcpy(pszIter, &nValueLen, sizeof(GInt32));
+    pszIter += sizeof(GInt32);
+    memcpy(pszIter, pszValue, nValueLen);
+    return pszMetadata;
+}
+
+bool OGRArrowArrayBuilder::FillSchema( OGRFeatureDefn* poDefn,
+                                       bool bIncludeFID,
+                                       const char* pszFIDName,
+                                       struct ArrowSchema* out_schema )
+{
+    std::vector<struct ArrowSchema*> apoChildren;
+
+    if( bIncludeFID )
+    {
+        apoChildren.push_back(OGRArrowSchemaCreate(
+            "l", (pszFIDName && pszFIDName[0]) ? pszFIDName : "OGC_FID",
+            false));
+    }
+
+    for( int i = 0; i < poDefn->GetFieldCount(); i++ )
+    {
+        const OGRFieldDefn* poFieldDefn = poDefn->GetFieldDefn(i);
+        if( poFieldDefn->IsIgnored() )
+            continue;
+        const char* pszChildFormat = nullptr;
+        const char* pszFormat = GetArrowFormat(poFieldDefn->GetType(),
+                                               poFieldDefn->GetSubType(),
+                                               &pszChildFormat);
+        struct ArrowSchema* psChild = OGRArrowSchemaCreate(
+            pszFormat, poFieldDefn->GetNameRef(), true);
+        if( pszChildFormat )
+        {
+            psChild->n_children = 1;
+            psChild->children = new struct ArrowSchema*[1];
+            psChild->children[0] =
+                OGRArrowSchemaCreate(pszChildFormat, "item", false);
+        }
+        apoChildren.push_back(psChild);
+    }
+
+    for( int i = 0; i < poDefn->GetGeomFieldCount(); i++ )
+    {
+        const OGRGeomFieldDefn* poGeomFieldDefn = poDefn->GetGeomFieldDefn(i);
+        if( poGeomFieldDefn->IsIgnored() )
+            continue;
+        const char* pszName = poGeomFieldDefn->GetNameRef();
+        struct ArrowSchema* psChild = OGRArrowSchemaCreate(
+            "z", pszName[0] ? pszName : "wkb_geometry", true);
+        psChild->metadata =
+            OGRArrowEncodeMetadata("ARROW:extension:name", "ogc.wkb");
+        apoChildren.push_back(psChild);
+    }
+
+    memset(out_schema, 0, sizeof(*out_schema));
+    out_schema->format = CPLStrdup("+s");
+    out_schema->name = CPLStrdup("");
+    out_schema->n_children = static_cast<int64_t>(apoChildren.size());
+    out_schema->children = new struct ArrowSchema*[apoChildren.size()];
+    for( size_t i = 0; i < apoChildren.size(); i++ )
+        out_schema->children[i] = apoChildren[i];
+    out_schema->release = OGRArrowSchemaRelease;
+    return true;
+}
+
+/************************************************************************/
+/*                          Append helpers                              */
+/************************************************************************/
+
+OGRArrowArrayBuilder::Column *OGRArrowArrayBuilder::GetFieldColumn( int iField )
+{
+    if( iField < 0 || iField >= static_cast<int>(m_anFieldToColumn.size()) )
+        return nullptr;
+    const int iCol = m_anFieldToColumn[iField];
+    if( iCol < 0 )
+        return nullptr;
+    Column& oCol = m_aoColumns[iCol];
+    // Only one value per row.
+    if( oCol.nLength > m_nRowCount )
+        return nullptr;
+    return &oCol;
+}
+
+void OGRArrowArrayBuilder::AppendBit( std::vector<GByte>& abyBits,
+                                      GIntBig nIdx, bool bSet )
+{
+    const size_t nByte = static_cast<size_t>(nIdx / 8);
+    if( nByte >= abyBits.size() )
+        abyBits.resize(nByte + 1, 0);
+    if( bSet )
+        abyBits[nByte] |= static_cast<GByte>(1 << (nIdx % 8));
+}
+
+void OGRArrowArrayBuilder::AppendValidity( Column& oCol, bool bValid )
+{
+    AppendBit(oCol.abyValidity, oCol.nLength, bValid);
+    if( !bValid )
+        oCol.nNullCount++;
+    oCol.nLength++;
+}
+
+template<class T> void OGRArrowArrayBuilder::AppendValue( Column& oCol,
+                                                          T nValue )
+{
+    CPLAssert( static_cast<int>(sizeof(T)) == oCol.nValueSize );
+    const size_t nOldSize = oCol.abyValues.size();
+    oCol.abyValues.resize(nOldSize + sizeof(T));
+    memcpy(&oCol.abyValues[nOldSize], &nValue, sizeof(T));
+    AppendValidity(oCol, true);
+}
+
+void OGRArrowArrayBuilder::AppendNull( Column& oCol )
+{
+    if( oCol.nValueSize > 0 )
+        oCol.abyValues.resize(oCol.abyValues.size() + oCol.nValueSize, 0);
+    else if( oCol.nValueSize < 0 )
+        AppendBit(oCol.abyValues, oCol.nLength, false);
+    else
+        oCol.anOffsets.push_back(oCol.anOffsets.back());
+    AppendValidity(oCol, false);
+}
+
+bool OGRArrowArrayBuilder::AppendBytes( std::vector<GByte>& abyData,
+                                        std::vector<GInt32>& anOffsets,
+                                        const void* pData, size_t nLen )
+{
+    const size_t nOldSize = abyData.size();
+    if( nLen > static_cast<size_t>(INT_MAX) - nOldSize )
+    {
+        if( !m_bOverflow )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Too large batch. Reduce MAX_FEATURES_IN_BATCH");
+        }
+        m_bOverflow = true;
+        return false;
+    }
+    abyData.resize(nOldSize + nLen);
+    if( nLen )
+        memcpy(&abyData[nOldSize], pData, nLen);
+    anOffsets.push_back(static_cast<GInt32>(abyData.size()));
+    return true;
+}
+
+/************************************************************************/
+/*                              SetFID()                                */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetFID( GIntBig nFID )
+{
+    if( m_nFIDColumn < 0 )
+        return;
+    Column& oCol = m_aoColumns[m_nFIDColumn];
+    if( oCol.nLength > m_nRowCount )
+        return;
+    AppendValue<GInt64>(oCol, nFID);
+}
+
+/************************************************************************/
+/*                              SetNull()                               */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetNull( int iField )
+{
+    Column* poCol = GetFieldColumn(iField);
+    if( poCol )
+        AppendNull(*poCol);
+}
+
+/************************************************************************/
+/*                             SetInteger()                             */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetInteger( int iField, int nValue )
+{
+    Column* poCol = GetFieldColumn(iField);
+    if( poCol == nullptr )
+        return;
+    switch( poCol->nValueSize )
+    {
+        case -1:
+            AppendBit(poCol->abyValues, poCol->nLength, nValue != 0);
+            AppendValidity(*poCol, true);
+            break;
+        case 2:
+            AppendValue<GInt16>(*poCol, static_cast<GInt16>(nValue));
+            break;
+        case 4:
+            if( poCol->eType == OFTReal )
+                AppendValue<float>(*poCol, static_cast<float>(nValue));
+            else
+                AppendValue<GInt32>(*poCol, nValue);
+            break;
+        default:
+            if( poCol->eType == OFTInteger64 )
+                AppendValue<GInt64>(*poCol, nValue);
+            else if( poCol->eType == OFTReal )
+                AppendValue<double>(*poCol, nValue);
+            else if( poCol->eType == OFTString )
+                SetString(iField, CPLSPrintf("%d", nValue));
+            else
+                AppendNull(*poCol);
+            break;
+    }
+}
+
+/************************************************************************/
+/*                            SetInteger64()                            */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetInteger64( int iField, GIntBig nValue )
+{
+    Column* poCol = GetFieldColumn(iField);
+    if( poCol == nullptr )
+        return;
+    if( poCol->eType == OFTInteger64 )
+        AppendValue<GInt64>(*poCol, nValue);
+    else if( poCol->eType == OFTInteger )
+        SetInteger(iField, static_cast<int>(nValue));
+    else if( poCol->eType == OFTReal )
+        SetReal(iField, static_cast<double>(nValue));
+    else if( poCol->eType == OFTString )
+        SetString(iField, CPLSPrintf(CPL_FRMT_GIB, nValue));
+    else
+        AppendNull(*poCol);
+}
+
+/************************************************************************/
+/*                              SetReal()                               */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetReal( int iField, double dfValue )
+{
+    Column* poCol = GetFieldColumn(iField);
+    if( poCol == nullptr )
+        return;
+    if( poCol->eType == OFTReal )
+    {
+        if( poCol->nValueSize == 4 )
+            AppendValue<float>(*poCol, static_cast<float>(dfValue));
+        else
+            AppendValue<double>(*poCol, dfValue);
+    }
+    else if( poCol->eType == OFTString )
+        SetString(iField, CPLSPrintf("%.15g", dfValue));
+    else
+        AppendNull(*poCol);
+}
+
+/************************************************************************/
+/*                             SetString()                              */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetString( int iField, const char* pszValue,
+                                      size_t nLen )
+{
+    Column* poCol = GetFieldColumn(iField);
+    if( poCol == nullptr )
+        return;
+    if( poCol->nValueSize != 0 || !poCol->osChildFormat.empty() )
+    {
+        // Typed column: go through the generic parsing of OGRFeature.
+        OGRFeatureDefn oDefn;
+        oDefn.Reference();
+        {
+            OGRFieldDefn oFieldDefn("", poCol->eType);
+            oFieldDefn.SetSubType(poCol->eSubType);
+            oDefn.AddFieldDefn(&oFieldDefn);
+        }
+        {
+            OGRFeature oFeature(&oDefn);
+            oFeature.SetField(0, std::string(pszValue, nLen).c_str());
+            if( oFeature.IsFieldSetAndNotNull(0) )
+                SetField(iField, oFeature.GetRawFieldRef(0));
+            else
+                AppendNull(*poCol);
+        }
+        oDefn.Dereference();
+        return;
+    }
+    if( AppendBytes(poCol->abyData, poCol->anOffsets, pszValue, nLen) )
+        AppendValidity(*poCol, true);
+    else
+        AppendNull(*poCol);
+}
+
+/************************************************************************/
+/*                             SetBinary()                              */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetBinary( int iField, const GByte* pabyData,
+                                      size_t nLen )
+{
+    Column* poCol = GetFieldColumn(iField);
+    if( poCol == nullptr )
+        return;
+    if( poCol->nValueSize != 0 || !poCol->osChildFormat.empty() )
+    {
+        AppendNull(*poCol);
+        return;
+    }
+    if( AppendBytes(poCol->abyData, poCol->anOffsets, pabyData, nLen) )
+        AppendValidity(*poCol, true);
+    else
+        AppendNull(*poCol);
+}
+
+/************************************************************************/
+/*                              SetField()                              */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetField( int iField, const OGRField* psField )
+{
+    Column* poCol = GetFieldColumn(iField);
+    if( poCol == nullptr )
+        return;
+
+    switch( poCol->eType )
+    {
+        case OFTInteger:
+            SetInteger(iField, psField->Integer);
+            break;
+
+        case OFTInteger64:
+            AppendValue<GInt64>(*poCol, psField->Integer64);
+            break;
+
+        case OFTReal:
+            SetReal(iField, psField->Real);
+            break;
+
+        case OFTBinary:
+            SetBinary(iField, psField->Binary.paData,
+                      static_cast<size_t>(psField->Binary.nCount));
+            break;
+
+        case OFTDate:
+        case OFTDateTime:
+        {
+            struct tm brokendowntime;
+            memset(&brokendowntime, 0, sizeof(brokendowntime));
+            brokendowntime.tm_year = psField->Date.Year - 1900;
+            brokendowntime.tm_mon = psField->Date.Month - 1;
+            brokendowntime.tm_mday = psField->Date.Day;
+            if( poCol->eType == OFTDate )
+            {
+                const GIntBig nDays =
+                    CPLYMDHMSToUnixTime(&brokendowntime) / 86400;
+                AppendValue<GInt32>(*poCol, static_cast<GInt32>(nDays));
+                break;
+            }
+            brokendowntime.tm_hour = psField->Date.Hour;
+            brokendowntime.tm_min = psField->Date.Minute;
+            const float fSecond = psField->Date.Second;
+            brokendowntime.tm_sec = static_cast<int>(fSecond);
+            GIntBig nVal = CPLYMDHMSToUnixTime(&brokendowntime);
+            // TZFlag values greater than 1 carry a known offset to UTC,
+            // in 15 minute increments.
+            if( psField->Date.TZFlag > 1 )
+                nVal -= (psField->Date.TZFlag - 100) * 15 * 60;
+            nVal = nVal * 1000 + static_cast<int>(
+                (fSecond - static_cast<int>(fSecond)) * 1000 + 0.5f);
+            AppendValue<GInt64>(*poCol, nVal);
+            break;
+        }
+
+        case OFTTime:
+        {
+            const float fSecond = psField->Date.Second;
+            const GInt32 nVal =
+                ((psField->Date.Hour * 60 + psField->Date.Minute) * 60) *
+                    1000 + static_cast<GInt32>(fSecond * 1000 + 0.5f);
+            AppendValue<GInt32>(*poCol, nVal);
+            break;
+        }
+
+        case OFTIntegerList:
+        case OFTInteger64List:
+        case OFTRealList:
+        {
+            const int nCount = psField->IntegerList.nCount;
+            const void* pData = psField->IntegerList.paList;
+            if( poCol->eType == OFTInteger64List )
+                pData = psField->Integer64List.paList;
+            else if( poCol->eType == OFTRealList )
+                pData = psField->RealList.paList;
+            const size_t nBytes =
+                static_cast<size_t>(nCount) * poCol->nChildValueSize;
+            const size_t nOldSize = poCol->abyChildValues.size();
+            if( poCol->nChildLength + nCount > INT_MAX )
+            {
+                m_bOverflow = true;
+                AppendNull(*poCol);
+                break;
+            }
+            poCol->abyChildValues.resize(nOldSize + nBytes);
+            if( nBytes )
+                memcpy(&poCol->abyChildValues[nOldSize], pData, nBytes);
+            poCol->nChildLength += nCount;
+            poCol->anOffsets.push_back(
+                static_cast<GInt32>(poCol->nChildLength));
+            AppendValidity(*poCol, true);
+            break;
+        }
+
+        case OFTStringList:
+        case OFTWideStringList:
+        {
+            const int nCount = psField->StringList.nCount;
+            bool bOK = poCol->nChildLength + nCount <= INT_MAX;
+            for( int i = 0; bOK && i < nCount; i++ )
+            {
+                const char* pszStr = psField->StringList.paList[i];
+                bOK = AppendBytes(poCol->abyChildData, poCol->anChildOffsets,
+                                  pszStr, strlen(pszStr));
+                if( bOK )
+                    poCol->nChildLength++;
+            }
+            if( !bOK )
+            {
+                AppendNull(*poCol);
+                break;
+            }
+            poCol->anOffsets.push_back(
+                static_cast<GInt32>(poCol->nChildLength));
+            AppendValidity(*poCol, true);
+            break;
+        }
+
+        case OFTString:
+        default:
+        {
+            const char* pszStr = psField->String;
+            if( AppendBytes(poCol->abyData, poCol->anOffsets,
+                            pszStr, strlen(pszStr)) )
+                AppendValidity(*poCol, true);
+            else
+                AppendNull(*poCol);
+            break;
+        }
+    }
+}
+
+/************************************************************************/
+/*                          Geometry setters                            */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::SetGeometryNull( int iGeomField )
+{
+    if( iGeomField < 0 ||
+        iGeomField >= static_cast<int>(m_anGeomFieldToColumn.size()) ||
+        m_anGeomFieldToColumn[iGeomField] < 0 )
+        return;
+    Column& oCol = m_aoColumns[m_anGeomFieldToColumn[iGeomField]];
+    if( oCol.nLength <= m_nRowCount )
+        AppendNull(oCol);
+}
+
+void OGRArrowArrayBuilder::SetGeometryWKB( int iGeomField,
+                                           const GByte* pabyWKB, size_t nLen )
+{
+    if( iGeomField < 0 ||
+        iGeomField >= static_cast<int>(m_anGeomFieldToColumn.size()) ||
+        m_anGeomFieldToColumn[iGeomField] < 0 )
+        return;
+    Column& oCol = m_aoColumns[m_anGeomFieldToColumn[iGeomField]];
+    if( oCol.nLength > m_nRowCount )
+        return;
+    if( AppendBytes(oCol.abyData, oCol.anOffsets, pabyWKB, nLen) )
+        AppendValidity(oCol, true);
+    else
+        AppendNull(oCol);
+}
+
+void OGRArrowArrayBuilder::SetGeometry( int iGeomField,
+                                        const OGRGeometry* poGeom )
+{
+    if( iGeomField < 0 ||
+        iGeomField >= static_cast<int>(m_anGeomFieldToColumn.size()) ||
+        m_anGeomFieldToColumn[iGeomField] < 0 )
+        return;
+    if( poGeom == nullptr )
+    {
+        SetGeometryNull(iGeomField);
+        return;
+    }
+    const size_t nSize = static_cast<size_t>(poGeom->WkbSize());
+    m_abyWKB.resize(nSize);
+    if( poGeom->exportToWkb(wkbNDR, m_abyWKB.data(), wkbVariantIso) !=
+                                                                OGRERR_NONE )
+    {
+        SetGeometryNull(iGeomField);
+        return;
+    }
+    SetGeometryWKB(iGeomField, m_abyWKB.data(), nSize);
+}
+
+/************************************************************************/
+/*                           AppendFeature()                            */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::AppendFeature( const OGRFeature* poFeature )
+{
+    SetFID(poFeature->GetFID());
+    const int nFieldCount = static_cast<int>(m_anFieldToColumn.size());
+    for( int i = 0; i < nFieldCount; i++ )
+    {
+        if( m_anFieldToColumn[i] < 0 )
+            continue;
+        if( poFeature->IsFieldSetAndNotNull(i) )
+            SetField(i, poFeature->GetRawFieldRef(i));
+    }
+    const int nGeomFieldCount = static_cast<int>(m_anGeomFieldToColumn.size());
+    for( int i = 0; i < nGeomFieldCount; i++ )
+    {
+        if( m_anGeomFieldToColumn[i] < 0 )
+            continue;
+        // WKB not parsed yet is copied as is, unless it uses the 2.5D
+        // flag of the legacy variant.
+        size_t nWKBSize = 0;
+        const GByte* pabyWKB = poFeature->GetGeomFieldLazyWKB(i, &nWKBSize);
+        if( pabyWKB != nullptr && nWKBSize >= 5 &&
+            (pabyWKB[0] == wkbNDR ? (pabyWKB[4] & 0x80) == 0
+                                  : (pabyWKB[1] & 0x80) == 0) )
+            SetGeometryWKB(i, pabyWKB, nWKBSize);
+        else
+            SetGeometry(i, poFeature->GetGeomFieldRef(i));
+    }
+    EndRow();
+}
+
+/************************************************************************/
+/*                              EndRow()                                */
+/************************************************************************/
+
+void OGRArrowArrayBuilder::EndRow()
+{
+    m_nRowCount++;
+    for( int i = 0; i < static_cast<int>(m_aoColumns.size()); i++ )
+    {
+        Column& oCol = m_aoColumns[i];
+        if( oCol.nLength >= m_nRowCount )
+            continue;
+        if( i == m_nFIDColumn )
+            AppendValue<GInt64>(oCol, OGRNullFID);
+        else
+            AppendNull(oCol);
+    }
+}
+
+/************************************************************************/
+/*                              Finish()                                */
+/************************************************************************/
+
+namespace {
+struct OGRArrowArrayHolder
+{
+    OGRArrowArrayBuilder::Column  oColumn{};
+    std::vector<const void*>      apBuffers{};
+    std::vector<struct ArrowArray*> apoChildren{};
+};
+} // namespace
+
+static void OGRArrowArrayRelease( struct ArrowArray* array )
+{
+    OGRArrowArrayHolder* psHolder =
+        static_cast<OGRArrowArrayHolder*>(array->private_data);
+    for( struct ArrowArray* psChild : psHolder->apoChildren )
+    {
+        if( psChild->release )
+            psChild->release(psChild);
+        delete psChild;
+    }
+    delete psHolder;
+    array->release = nullptr;
+}
+
+static struct ArrowArray* OGRArrowArrayCreate(
+                                    OGRArrowArrayBuilder::Column&& oColumn )
+{
+    struct ArrowArray* psArray = new struct ArrowArray;
+    memset(psArray, 0, sizeof(*psArray));
+    OGRArrowArrayHolder* psHolder = new OGRArrowArrayHolder;
+    psHolder->oColumn = std::move(oColumn);
+    OGRArrowArrayBuilder::Column& oCol = psHolder->oColumn;
+
+    // Buffers other than the validity one must not be null.
+    if( oCol.abyValues.empty() )
+        oCol.abyValues.resize(1);
+    if( oCol.abyData.empty() )
+        oCol.abyData.resize(1);
+
+    psHolder->apBuffers.push_back(
+        oCol.nNullCount ? oCol.abyValidity.data() : nullptr);
+    if( !oCol.osChildFormat.empty() )
+    {
+        psHolder->apBuffers.push_back(oCol.anOffsets.data());
+
+        OGRArrowArrayBuilder::Column oChild;
+        oChild.osFormat = oCol.osChildFormat;
+        oChild.nValueSize = oCol.nChildValueSize;
+        oChild.nLength = oCol.nChildLength;
+        oChild.abyValues = std::move(oCol.abyChildValues);
+        oChild.anOffsets = std::move(oCol.anChildOffsets);
+        oChild.abyData = std::move(oCol.abyChildData);
+        psHolder->apoChildren.push_back(OGRArrowArrayCreate(std::move(oChild)));
+    }
+    else if( oCol.nValueSize == 0 )
+    {
+        psHolder->apBuffers.push_back(oCol.anOffsets.data());
+        psHolder->apBuffers.push_back(oCol.abyData.data());
+    }
+    else
+    {
+        psHolder->apBuffers.push_back(oCol.abyValues.data());
+    }
+
+    psArray->length = oCol.nLength;
+    psArray->null_count = oCol.nNullCount;
+    psArray->n_buffers = static_cast<int64_t>(psHolder->apBuffers.size());
+    psArray->buffers = psHolder->apBuffers.data();
+    psArray->n_children = static_cast<int64_t>(psHolder->apoChildren.size());
+    psArray->children = psHolder->apoChildren.empty() ? nullptr :
+                                            psHolder->apoChildren.data();
+    psArray->release = OGRArrowArrayRelease;
+    psArray->private_data = psHolder;
+    return psArray;
+}
+
+bool OGRArrowArrayBuilder::Finish( struct ArrowArray* out_array )
+{
+    memset(out_array, 0, sizeof(*out_array));
+    if( m_bOverflow )
+        return false;
+
+    OGRArrowArrayHolder* psHolder = new OGRArrowArrayHolder;
+    psHolder->apBuffers.push_back(nullptr);
+    for( auto& oCol : m_aoColumns )
+        psHolder->apoChildren.push_back(OGRArrowArrayCreate(std::move(oCol)));
+    m_aoColumns.clear();
+
+    out_array->length = m_nRowCount;
+    out_array->null_count = 0;
+    out_array->n_buffers = 1;
+    out_array->buffers = psHolder->apBuffers.data();
+    out_array->n_children = static_cast<int64_t>(psHolder->apoChildren.size());
+    out_array->children = psHolder->apoChildren.data();
+    out_array->release = OGRArrowArrayRelease;
+    out_array->private_data = psHolder;
+    return true;
+}
+
+/************************************************************************/
+/*                          GetArrowSchema()                            */
+/************************************************************************/
+
+/** Default implementation of the ArrowArrayStream::get_schema() callback.
+ *
+ * The schema is a struct whose children are the FID column (unless the
+ * INCLUDE_FID=NO option was passed to GetArrowStream()), the non-ignored
+ * attribute fields and the non-ignored geometry fields, encoded as WKB
+ * with the "ogc.wkb" extension name.
+ *
+ * @since GDAL 3.1
+ */
+int OGRLayer::GetArrowSchema( struct ArrowArrayStream*,
+                              struct ArrowSchema* out_schema )
+{
+    const bool bIncludeFID = OGRArrowArrayBuilder::IncludeFID(
+                                        m_aosArrowArrayStreamOptions.List());
+    return OGRArrowArrayBuilder::FillSchema(GetLayerDefn(), bIncludeFID,
+                                            GetFIDColumn(), out_schema)
+                ? 0 : EINVAL;
+}
+
+/************************************************************************/
+/*                         GetNextArrowArray()                          */
+/************************************************************************/
+
+/** Default implementation of the ArrowArrayStream::get_next() callback.
+ *
+ * It collects up to MAX_FEATURES_IN_BATCH features with GetNextFeature(),
+ * so that attribute and spatial filters are honoured. Drivers may override
+ * it to fill the columns directly from their storage.
+ *
+ * @since GDAL 3.1
+ */
+int OGRLayer::GetNextArrowArray( struct ArrowArrayStream*,
+                                 struct ArrowArray* out_array )
+{
+    memset(out_array, 0, sizeof(*out_array));
+    CSLConstList papszOptions = m_aosArrowArrayStreamOptions.List();
+    const int nMaxBatchSize =
+        OGRArrowArrayBuilder::GetMaxFeaturesInBatch(papszOptions);
+    try
+    {
+        OGRArrowArrayBuilder oBuilder(
+            GetLayerDefn(), OGRArrowArrayBuilder::IncludeFID(papszOptions));
+        while( oBuilder.GetRowCount() < nMaxBatchSize )
+        {
+            OGRFeature* poFeature = GetNextFeature();
+            if( poFeature == nullptr )
+            {
+                m_bArrowArrayStreamEOF = true;
+                break;
+            }
+            oBuilder.AppendFeature(poFeature);
+            delete poFeature;
+        }
+        // No more features: a released array signals the end of stream.
+        if( oBuilder.GetRowCount() == 0 )
+            return 0;
+        return oBuilder.Finish(out_array) ? 0 : EOVERFLOW;
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory in GetNextArrowArray()");
+        return ENOMEM;
+    }
+}
+
+/************************************************************************/
+/*                     ArrowArrayStream callbacks                       */
+/************************************************************************/
+
+namespace {
+struct OGRLayerArrowArrayStreamPrivate
+{
+    OGRLayer   *poLayer = nullptr;
+    std::string osLastError{};
+};
+} // namespace
+
+int OGRLayer::StaticGetArrowSchema( struct ArrowArrayStream* stream,
+                                    struct ArrowSchema* out_schema )
+{
+    auto psPrivate =
+        static_cast<OGRLayerArrowArrayStreamPrivate*>(stream->private_data);
+    CPLErrorReset();
+    const int nRet = psPrivate->poLayer->GetArrowSchema(stream, out_schema);
+    if( nRet != 0 )
+        psPrivate->osLastError = CPLGetLastErrorMsg();
+    return nRet;
+}
+
+int OGRLayer::StaticGetNextArrowArray( struct ArrowArrayStream* stream,
+                                       struct ArrowArray* out_array )
+{
+    auto psPrivate =
+        static_cast<OGRLayerArrowArrayStreamPrivate*>(stream->private_data);
+    if( psPrivate->poLayer->m_bArrowArrayStreamEOF )
+    {
+        memset(out_array, 0, sizeof(*out_array));
+        return 0;
+    }
+    CPLErrorReset();
+    const int nRet = psPrivate->poLayer->GetNextArrowArray(stream, out_array);
+    if( nRet != 0 )
+        psPrivate->osLastError = CPLGetLastErrorMsg();
+    return nRet;
+}
+
+const char* OGRLayer::StaticGetLastErrorArrowArrayStream(
+                                            struct ArrowArrayStream* stream )
+{
+    auto psPrivate =
+        static_cast<OGRLayerArrowArrayStreamPrivate*>(stream->private_data);
+    return psPrivate->osLastError.empty() ? nullptr :
+                                            psPrivate->osLastError.c_str();
+}
+
+void OGRLayer::ReleaseArrowArrayStream( struct ArrowArrayStream* stream )
+{
+    delete static_cast<OGRLayerArrowArrayStreamPrivate*>(stream->private_data);
+    stream->private_data = nullptr;
+    stream->release = nullptr;
+}
+
+/************************************************************************/
+/*                          GetArrowStream()                            */
+/************************************************************************/
+
+/**
+ \brief Get a batch of features as an ArrowArrayStream.
+
+ The stream returns the features of the layer, starting from the first one,
+ as consecutive Arrow record batches following the
+ <a href="https://arrow.apache.org/docs/format/CDataInterface.html">Arrow C
+ Data Interface</a>: contiguous value buffers, offset based strings and
+ binaries, and geometries as WKB. This avoids the allocation of an
+ OGRFeature, of its field strings and of a geometry object for each row.
+
+ Spatial and attribute filters, and ignored fields, are honoured. The layer
+ must not be used for other reads while the stream is in use, and it must
+ outlive the stream. Each ArrowSchema and ArrowArray obtained from the
+ stream must be released by the caller, as well as the stream itself.
+
+ Options:
+ <ul>
+ <li>MAX_FEATURES_IN_BATCH=integer. Maximum number of features per record
+     batch. Defaults to 65536.</li>
+ <li>INCLUDE_FID=YES/NO. Whether the first column is the FID. Defaults to
+     YES.</li>
+ </ul>
+
+ This method is the same as the C function OGR_L_GetArrowStream().
+
+ @param out_stream Pointer to a ArrowArrayStream structure to fill.
+ @param papszOptions NULL terminated list of options, or NULL.
+ @return true in case of success.
+
+ @since GDAL 3.1
+*/
+
+bool OGRLayer::GetArrowStream( struct ArrowArrayStream* out_stream,
+                               CSLConstList papszOptions )
+{
+    memset(out_stream, 0, sizeof(*out_stream));
+    m_aosArrowArrayStreamOptions.Assign(CSLDuplicate(papszOptions), TRUE);
+    m_bArrowArrayStreamEOF = false;
+
+    ResetReading();
+
+    auto psPrivate = new OGRLayerArrowArrayStreamPrivate;
+    psPrivate->poLayer = this;
+    out_stream->get_schema = OGRLayer::StaticGetArrowSchema;
+    out_stream->get_next = OGRLayer::StaticGetNextArrowArray;
+    out_stream->get_last_error = OGRLayer::StaticGetLastErrorArrowArrayStream;
+    out_stream->release = OGRLayer::ReleaseArrowArrayStream;
+    out_stream->private_data = psPrivate;
+    return true;
+}
+
+/************************************************************************/
+/*                       OGR_L_GetArrowStream()                         */
+/************************************************************************/
+
+/**
+ \brief Get a batch of features as an ArrowArrayStream.
+
+ This function is the same as the C++ method OGRLayer::GetArrowStream().
+
+ @param hLayer Layer
+ @param out_stream Pointer to a ArrowArrayStream structure to fill.
+ @param papszOptions NULL terminated list of options, or NULL.
+ @return TRUE in case of success.
+
+ @since GDAL 3.1
+*/
+
+int OGR_L_GetArrowStream( OGRLayerH hLayer,
+                          struct ArrowArrayStream* out_stream,
+                          char** papszOptions )
+{
+    VALIDATE_POINTER1( hLayer, "OGR_L_GetArrowStream", FALSE );
+    VALIDATE_POINTER1( out_stream, "OGR_L_GetArrowStream", FALSE );
+
+    return OGRLayer::FromHandle(hLayer)->GetArrowStream(
+                                            out_stream, papszOptions);
+}
@@ -0,0 +1,141 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Helper to build Arrow C Data Interface record batches from
+ *           OGR features.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef OGRLAYERARROW_H_INCLUDED
+#define OGRLAYERARROW_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "ogrsf_frmts.h"
+#include "ogr_recordbatch.h"
+
+#include <string>
+#include <vector>
+
+/************************************************************************/
+/*                         OGRArrowArrayBuilder                         */
+/************************************************************************/
+
+// Accumulates rows into the columnar buffers of an Arrow struct array whose
+// children are the FID column (optional), the non-ignored attribute fields
+// and the non-ignored geometry fields (as WKB), in that order.
+//
+// Values of a row are set with the Set*() methods, in any order, and the row
+// is closed with EndRow(), which nulls the columns that have not been set.
+// Setting a column of an ignored field is silently a no-op, so drivers can
+// use field indices of the layer definition directly.
+
+class CPL_DLL OGRArrowArrayBuilder
+{
+  public:
+    struct Column
+    {
+        std::string             osFormat{};
+        std::string             osChildFormat{};  // for lists
+        OGRFieldType            eType = OFTString;
+        OGRFieldSubType         eSubType = OFSTNone;
+        // Size in bytes of the values: 0 for variable width or list
+        // columns, -1 for bit-packed booleans.
+        int                     nValueSize = 0;
+        int                     nChildValueSize = 0;
+        bool                    bNullable = true;
+        GIntBig                 nLength = 0;
+        GIntBig                 nNullCount = 0;
+        std::vector<GByte>      abyValidity{};
+        std::vector<GByte>      abyValues{};     // fixed width values
+        std::vector<GInt32>     anOffsets{};     // variable width and lists
+        std::vector<GByte>      abyData{};       // string and binary bytes
+        GIntBig                 nChildLength = 0;
+        std::vector<GByte>      abyChildValues{};
+        std::vector<GInt32>     anChildOffsets{};
+        std::vector<GByte>      abyChildData{};
+    };
+
+  private:
+    std::vector<Column>     m_aoColumns{};
+    std::vector<int>        m_anFieldToColumn{};
+    std::vector<int>        m_anGeomFieldToColumn{};
+    int                     m_nFIDColumn = -1;
+    GIntBig                 m_nRowCount = 0;
+    bool                    m_bOverflow = false;
+    std::vector<GByte>      m_abyWKB{};
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRArrowArrayBuilder)
+
+    Column                 *GetFieldColumn( int iField );
+    static void             AppendValidity( Column& oCol, bool bValid );
+    static void             AppendNull( Column& oCol );
+    template<class T> static void AppendValue( Column& oCol, T nValue );
+    static void             AppendBit( std::vector<GByte>& abyBits,
+                                       GIntBig nIdx, bool bSet );
+    bool                    AppendBytes( std::vector<GByte>& abyData,
+                                         std::vector<GInt32>& anOffsets,
+                                         const void* pData, size_t nLen );
+
+  public:
+    OGRArrowArrayBuilder( OGRFeatureDefn* poDefn, bool bIncludeFID );
+
+    static bool             IncludeFID( CSLConstList papszOptions );
+    static int              GetMaxFeaturesInBatch( CSLConstList papszOptions );
+    static bool             FillSchema( OGRFeatureDefn* poDefn,
+                                        bool bIncludeFID,
+                                        const char* pszFIDName,
+                                        struct ArrowSchema* out_schema );
+
+    GIntBig                 GetRowCount() const { return m_nRowCount; }
+
+    void                    SetFID( GIntBig nFID );
+    void                    SetNull( int iField );
+    void                    SetInteger( int iField, int nValue );
+    void                    SetInteger64( int iField, GIntBig nValue );
+    void                    SetReal( int iField, double dfValue );
+    void                    SetString( int iField, const char* pszValue,
+                                       size_t nLen );
+    void                    SetString( int iField, const char* pszValue )
+                                { SetString(iField, pszValue,
+                                            strlen(pszValue)); }
+    void                    SetBinary( int iField, const GByte* pabyData,
+                                       size_t nLen );
+    void                    SetField( int iField, const OGRField* psField );
+
+    void                    SetGeometryNull( int iGeomField );
+    void                    SetGeometryWKB( int iGeomField,
+                                            const GByte* pabyWKB,
+                                            size_t nLen );
+    void                    SetGeometry( int iGeomField,
+                                         const OGRGeometry* poGeom );
+
+    void                    AppendFeature( const OGRFeature* poFeature );
+    void                    EndRow();
+
+    bool                    Finish( struct ArrowArray* out_array );
+};
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
+#endif /* ndef OGRLAYERARROW_H_INCLUDED */
@@ -107,7 +107,16 @@ void OGRRegisterAllInternal()
     RegisterOGRGMT();
 #endif
 #ifdef GPKG_ENABLED
-    RegisterOGRGeoPackage();
+    // "SQLite format 3", and "-- SQL GPKG" when SQL dumps are accepted.
+#if defined(DEBUG) || defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION) || defined(ALLOW_FORMAT_DUMPS)
+    GetGDALDriverManager()->RegisterDeferredDriver(
+        "GPKG", RegisterOGRGeoPackage, true, true,
+        "53514C69746520666F726D61742033 2D2D2053514C2047504B47" );
+#else
+    GetGDALDriverManager()->RegisterDeferredDriver(
+        "GPKG", RegisterOGRGeoPackage, true, true,
+        "53514C69746520666F726D61742033" );
+#endif
 #endif
 #ifdef SQLITE_ENABLED
     RegisterOGRSQLite();
@@ -308,6 +317,12 @@ void OGRRegisterAllInternal()
 #ifdef MVT_ENABLED
     RegisterOGRMVT();
 #endif
+#ifdef FLATGEOBUF_ENABLED
+    RegisterOGRFlatGeobuf();
+#endif
+#ifdef ARROW_ENABLED
+    RegisterOGRArrow();
+#endif
 
 /* Put TIGER and AVCBIN at end since they need poOpenInfo->GetSiblingFiles() */
 #ifdef TIGER_ENABLED
@@ -175,6 +175,7 @@ int OGR_Dr_TestCapability( OGRSFDriverH hDriver, const char *pszCap )
     VALIDATE_POINTER1( pszCap, "OGR_Dr_TestCapability", 0 );
 
     GDALDriver* poDriver = reinterpret_cast<GDALDriver *>(hDriver);
+    poDriver->LoadDeferred();
     if( EQUAL(pszCap, ODrCCreateDataSource) )
     {
         return poDriver->pfnCreate != nullptr ||
@@ -0,0 +1,570 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Implements OGRThreadSafeDataSource class
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogrthreadsafedatasource.h"
+#include "cpl_error.h"
+
+CPL_CVSID("$Id$")
+
+//! @cond Doxygen_Suppress
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          OGRThreadSafeLayer                          */
+/*                                                                      */
+/*      Layer of an OGRThreadSafeDataSource, forwarding its methods     */
+/*      to the layer of the dataset of the calling thread.              */
+/* ==================================================================== */
+/************************************************************************/
+
+class OGRThreadSafeLayer final: public OGRLayer
+{
+    CPL_DISALLOW_COPY_ASSIGN(OGRThreadSafeLayer)
+
+    OGRThreadSafeDataSource *m_poDS;
+    int                 m_iLayer;
+
+    OGRLayer           *GetThreadLayer()
+        { return m_poDS->GetThreadLayer(m_iLayer); }
+
+  public:
+                        OGRThreadSafeLayer( OGRThreadSafeDataSource *poDS,
+                                            int iLayer,
+                                            const char *pszName );
+
+    virtual OGRGeometry *GetSpatialFilter() override;
+    virtual void        SetSpatialFilter( OGRGeometry * ) override;
+    virtual void        SetSpatialFilterRect( double dfMinX, double dfMinY,
+                                              double dfMaxX,
+                                              double dfMaxY ) override;
+    virtual void        SetSpatialFilter( int iGeomField,
+                                          OGRGeometry * ) override;
+    virtual void        SetSpatialFilterRect( int iGeomField,
+                                              double dfMinX, double dfMinY,
+                                              double dfMaxX,
+                                              double dfMaxY ) override;
+
+    virtual OGRErr      SetAttributeFilter( const char * ) override;
+
+    virtual void        ResetReading() override;
+    virtual OGRFeature *GetNextFeature() override;
+    virtual OGRErr      SetNextByIndex( GIntBig nIndex ) override;
+    virtual OGRFeature *GetFeature( GIntBig nFID ) override;
+    virtual bool        GetArrowStream( struct ArrowArrayStream* out_stream,
+                                        CSLConstList papszOptions ) override;
+
+    virtual OGRwkbGeometryType GetGeomType() override;
+    virtual OGRFeatureDefn *GetLayerDefn() override;
+
+    virtual OGRSpatialReference *GetSpatialRef() override;
+
+    virtual GIntBig     GetFeatureCount( int bForce = TRUE ) override;
+    virtual OGRErr      GetExtent( int iGeomField, OGREnvelope *psExtent,
+                                   int bForce = TRUE ) override;
+    virtual OGRErr      GetExtent( OGREnvelope *psExtent,
+                                   int bForce = TRUE ) override;
+
+    virtual int         TestCapability( const char * ) override;
+
+    virtual OGRStyleTable *GetStyleTable() override;
+
+    virtual const char *GetFIDColumn() override;
+    virtual const char *GetGeometryColumn() override;
+
+    virtual OGRErr      SetIgnoredFields( const char **papszFields ) override;
+
+    virtual char      **GetMetadata( const char *pszDomain = "" ) override;
+    virtual const char *GetMetadataItem( const char *pszName,
+                                         const char *pszDomain = "" ) override;
+};
+
+OGRThreadSafeLayer::OGRThreadSafeLayer( OGRThreadSafeDataSource *poDS,
+                                        int iLayer, const char *pszName ) :
+    m_poDS(poDS),
+    m_iLayer(iLayer)
+{
+    SetDescription( pszName );
+}
+
+OGRGeometry *OGRThreadSafeLayer::GetSpatialFilter()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetSpatialFilter() : nullptr;
+}
+
+void OGRThreadSafeLayer::SetSpatialFilter( OGRGeometry *poGeom )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    if( poLayer )
+        poLayer->SetSpatialFilter(poGeom);
+}
+
+void OGRThreadSafeLayer::SetSpatialFilterRect( double dfMinX, double dfMinY,
+                                               double dfMaxX, double dfMaxY )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    if( poLayer )
+        poLayer->SetSpatialFilterRect(dfMinX, dfMinY, dfMaxX, dfMaxY);
+}
+
+void OGRThreadSafeLayer::SetSpatialFilter( int iGeomField,
+                                           OGRGeometry *poGeom )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    if( poLayer )
+        poLayer->SetSpatialFilter(iGeomField, poGeom);
+}
+
+void OGRThreadSafeLayer::SetSpatialFilterRect( int iGeomField,
+                                               double dfMinX, double dfMinY,
+                                               double dfMaxX, double dfMaxY )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    if( poLayer )
+        poLayer->SetSpatialFilterRect(iGeomField,
+                                      dfMinX, dfMinY, dfMaxX, dfMaxY);
+}
+
+OGRErr OGRThreadSafeLayer::SetAttributeFilter( const char *pszFilter )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->SetAttributeFilter(pszFilter) : OGRERR_FAILURE;
+}
+
+void OGRThreadSafeLayer::ResetReading()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    if( poLayer )
+        poLayer->ResetReading();
+}
+
+OGRFeature *OGRThreadSafeLayer::GetNextFeature()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetNextFeature() : nullptr;
+}
+
+OGRErr OGRThreadSafeLayer::SetNextByIndex( GIntBig nIndex )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->SetNextByIndex(nIndex) : OGRERR_FAILURE;
+}
+
+OGRFeature *OGRThreadSafeLayer::GetFeature( GIntBig nFID )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetFeature(nFID) : nullptr;
+}
+
+bool OGRThreadSafeLayer::GetArrowStream( struct ArrowArrayStream* out_stream,
+                                         CSLConstList papszOptions )
+{
+    // The stream is bound to the layer of the calling thread.
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetArrowStream(out_stream, papszOptions)
+                   : false;
+}
+
+OGRwkbGeometryType OGRThreadSafeLayer::GetGeomType()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetGeomType() : wkbUnknown;
+}
+
+OGRFeatureDefn *OGRThreadSafeLayer::GetLayerDefn()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    if( poLayer )
+        return poLayer->GetLayerDefn();
+
+    CPLMutexHolderD(m_poDS->GetMutex());
+    return m_poDS->GetRefLayer(m_iLayer)->GetLayerDefn();
+}
+
+OGRSpatialReference *OGRThreadSafeLayer::GetSpatialRef()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetSpatialRef() : nullptr;
+}
+
+GIntBig OGRThreadSafeLayer::GetFeatureCount( int bForce )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetFeatureCount(bForce) : -1;
+}
+
+OGRErr OGRThreadSafeLayer::GetExtent( int iGeomField, OGREnvelope *psExtent,
+                                      int bForce )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetExtent(iGeomField, psExtent, bForce)
+                   : OGRERR_FAILURE;
+}
+
+OGRErr OGRThreadSafeLayer::GetExtent( OGREnvelope *psExtent, int bForce )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetExtent(psExtent, bForce) : OGRERR_FAILURE;
+}
+
+int OGRThreadSafeLayer::TestCapability( const char *pszCap )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->TestCapability(pszCap) : FALSE;
+}
+
+OGRStyleTable *OGRThreadSafeLayer::GetStyleTable()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetStyleTable() : nullptr;
+}
+
+const char *OGRThreadSafeLayer::GetFIDColumn()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetFIDColumn() : "";
+}
+
+const char *OGRThreadSafeLayer::GetGeometryColumn()
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetGeometryColumn() : "";
+}
+
+OGRErr OGRThreadSafeLayer::SetIgnoredFields( const char **papszFields )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->SetIgnoredFields(papszFields) : OGRERR_FAILURE;
+}
+
+char **OGRThreadSafeLayer::GetMetadata( const char *pszDomain )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetMetadata(pszDomain) : nullptr;
+}
+
+const char *OGRThreadSafeLayer::GetMetadataItem( const char *pszName,
+                                                 const char *pszDomain )
+{
+    OGRLayer *poLayer = GetThreadLayer();
+    return poLayer ? poLayer->GetMetadataItem(pszName, pszDomain) : nullptr;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                       OGRThreadSafeDataSource                        */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                      ~OGRThreadSafeDataSource()                      */
+/************************************************************************/
+
+OGRThreadSafeDataSource::~OGRThreadSafeDataSource()
+
+{
+    m_apoLayers.clear();
+    m_oMapThreadDS.clear();
+    m_poRefDS.reset();
+
+    if( m_hMutex )
+        CPLDestroyMutex(m_hMutex);
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+GDALDataset *OGRThreadSafeDataSource::Open(
+    const char *pszFilename,
+    const char *const *papszAllowedDrivers,
+    const char *const *papszOpenOptions )
+
+{
+    std::unique_ptr<GDALDataset> poRefDS(
+        GDALDataset::Open( pszFilename,
+                           GDAL_OF_VECTOR | GDAL_OF_READONLY |
+                           GDAL_OF_INTERNAL | GDAL_OF_VERBOSE_ERROR,
+                           papszAllowedDrivers, papszOpenOptions, nullptr ) );
+    if( poRefDS == nullptr )
+        return nullptr;
+
+    if( poRefDS->GetDriver() == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "Cannot determine the driver of %s.", pszFilename );
+        return nullptr;
+    }
+
+    OGRThreadSafeDataSource *poDS = new OGRThreadSafeDataSource();
+    poDS->m_osFilename = pszFilename;
+    poDS->m_osDriverName = poRefDS->GetDriver()->GetDescription();
+    poDS->m_aosOpenOptions.Assign(
+        CSLDuplicate(const_cast<char**>(papszOpenOptions)), TRUE );
+    poDS->SetDescription( poRefDS->GetDescription() );
+    poDS->poDriver = poRefDS->GetDriver();
+    poDS->eAccess = GA_ReadOnly;
+
+    for( int i = 0; i < poRefDS->GetLayerCount(); i++ )
+    {
+        OGRLayer *poLayer = poRefDS->GetLayer(i);
+        // Some drivers complete the layer definition on first request:
+        // do it now rather than when other threads use the dataset.
+        poLayer->GetLayerDefn();
+        poDS->m_apoLayers.emplace_back(
+            new OGRThreadSafeLayer( poDS, i, poLayer->GetDescription() ) );
+    }
+    poDS->m_poRefDS = std::move(poRefDS);
+
+    return poDS;
+}
+
+/************************************************************************/
+/*                          GetThreadDataset()                          */
+/*                                                                      */
+/*      Return the dataset of the calling thread, opening it on the     */
+/*      first call.  nullptr is returned, and remembered, if it         */
+/*      cannot be opened.                                               */
+/************************************************************************/
+
+GDALDataset *OGRThreadSafeDataSource::GetThreadDataset()
+
+{
+    const GIntBig nThreadId = CPLGetPID();
+    {
+        CPLMutexHolderD(&m_hMutex);
+        const auto oIter = m_oMapThreadDS.find(nThreadId);
+        if( oIter != m_oMapThreadDS.end() )
+            return oIter->second.get();
+    }
+
+    // Open outside of the lock, so that other threads are not blocked.
+    const char *const apszDrivers[] = { m_osDriverName.c_str(), nullptr };
+    std::unique_ptr<GDALDataset> poThreadDS(
+        GDALDataset::Open( m_osFilename.c_str(),
+                           GDAL_OF_VECTOR | GDAL_OF_READONLY |
+                           GDAL_OF_INTERNAL | GDAL_OF_VERBOSE_ERROR,
+                           apszDrivers, m_aosOpenOptions.List(), nullptr ) );
+    if( poThreadDS != nullptr &&
+        poThreadDS->GetLayerCount() != static_cast<int>(m_apoLayers.size()) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "%s has been modified since it was opened.",
+                  m_osFilename.c_str() );
+        poThreadDS.reset();
+    }
+
+    CPLMutexHolderD(&m_hMutex);
+    GDALDataset *poRet = poThreadDS.get();
+    m_oMapThreadDS[nThreadId] = std::move(poThreadDS);
+    return poRet;
+}
+
+/************************************************************************/
+/*                           GetThreadLayer()                           */
+/************************************************************************/
+
+OGRLayer *OGRThreadSafeDataSource::GetThreadLayer( int iLayer )
+
+{
+    GDALDataset *poThreadDS = GetThreadDataset();
+    return poThreadDS ? poThreadDS->GetLayer(iLayer) : nullptr;
+}
+
+/************************************************************************/
+/*                            GetRefLayer()                             */
+/*                                                                      */
+/*      To be called with the mutex held.                               */
+/************************************************************************/
+
+OGRLayer *OGRThreadSafeDataSource::GetRefLayer( int iLayer )
+
+{
+    return m_poRefDS->GetLayer(iLayer);
+}
+
+/************************************************************************/
+/*                           GetLayerCount()                            */
+/************************************************************************/
+
+int OGRThreadSafeDataSource::GetLayerCount()
+
+{
+    return static_cast<int>(m_apoLayers.size());
+}
+
+/************************************************************************/
+/*                              GetLayer()                              */
+/************************************************************************/
+
+OGRLayer *OGRThreadSafeDataSource::GetLayer( int iLayer )
+
+{
+    if( iLayer < 0 || iLayer >= GetLayerCount() )
+        return nullptr;
+    return m_apoLayers[iLayer].get();
+}
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int OGRThreadSafeDataSource::TestCapability( const char *pszCap )
+
+{
+    GDALDataset *poThreadDS = GetThreadDataset();
+    return poThreadDS ? poThreadDS->TestCapability(pszCap) : FALSE;
+}
+
+/************************************************************************/
+/*                             ExecuteSQL()                             */
+/************************************************************************/
+
+OGRLayer *OGRThreadSafeDataSource::ExecuteSQL( const char *pszStatement,
+                                               OGRGeometry *poSpatialFilter,
+                                               const char *pszDialect )
+
+{
+    GDALDataset *poThreadDS = GetThreadDataset();
+    if( poThreadDS == nullptr )
+        return nullptr;
+
+    OGRLayer *poLayer =
+        poThreadDS->ExecuteSQL(pszStatement, poSpatialFilter, pszDialect);
+    if( poLayer != nullptr )
+    {
+        CPLMutexHolderD(&m_hMutex);
+        m_oMapResultSets[poLayer] = poThreadDS;
+    }
+    return poLayer;
+}
+
+/************************************************************************/
+/*                          ReleaseResultSet()                          */
+/************************************************************************/
+
+void OGRThreadSafeDataSource::ReleaseResultSet( OGRLayer *poResultsSet )
+
+{
+    GDALDataset *poThreadDS = nullptr;
+    {
+        CPLMutexHolderD(&m_hMutex);
+        const auto oIter = m_oMapResultSets.find(poResultsSet);
+        if( oIter != m_oMapResultSets.end() )
+        {
+            poThreadDS = oIter->second;
+            m_oMapResultSets.erase(oIter);
+        }
+    }
+
+    if( poThreadDS != nullptr )
+        poThreadDS->ReleaseResultSet(poResultsSet);
+    else
+        GDALDataset::ReleaseResultSet(poResultsSet);
+}
+
+/************************************************************************/
+/*                            GetFileList()                             */
+/************************************************************************/
+
+char **OGRThreadSafeDataSource::GetFileList()
+
+{
+    CPLMutexHolderD(&m_hMutex);
+    return m_poRefDS->GetFileList();
+}
+
+/************************************************************************/
+/*                            GetMetadata()                             */
+/************************************************************************/
+
+char **OGRThreadSafeDataSource::GetMetadata( const char *pszDomain )
+
+{
+    CPLMutexHolderD(&m_hMutex);
+    return m_poRefDS->GetMetadata(pszDomain);
+}
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/************************************************************************/
+
+const char *OGRThreadSafeDataSource::GetMetadataItem( const char *pszName,
+                                                      const char *pszDomain )
+
+{
+    CPLMutexHolderD(&m_hMutex);
+    return m_poRefDS->GetMetadataItem(pszName, pszDomain);
+}
+
+//! @endcond
+
+/************************************************************************/
+/*                  GDALOpenThreadSafeVectorDataset()                   */
+/************************************************************************/
+
+/**
+ * \brief Open a vector dataset for concurrent read-only access.
+ *
+ * The returned dataset can be used by several threads at the same time,
+ * including the same layer: each thread transparently reads through its
+ * own instance of the dataset, opened with the same driver and open options
+ * on its first access to it.  The reading position, spatial and attribute
+ * filters and ignored fields of a layer thus only apply to the calling
+ * thread, and features returned to a thread reference the layer definition
+ * that GetLayerDefn() returns in that thread.  For example, each thread
+ * reading a GeoPackage uses its own SQLite connection, and each thread
+ * reading a shapefile its own .shp and .dbf file handles.
+ *
+ * Result layers of GDALDatasetExecuteSQL() must only be used and released
+ * by the thread that created them.  The datasets of the threads are kept
+ * until the returned dataset is closed with GDALClose().
+ *
+ * @param pszFilename the name of the file to access.
+ * @param papszAllowedDrivers NULL to consider all candidate vector drivers,
+ *                            or a NULL terminated list of driver short names.
+ * @param papszOpenOptions NULL, or a NULL terminated list of strings with
+ *                         open options passed to the driver.
+ *
+ * @return a dataset handle, or NULL on failure.
+ *
+ * @since GDAL 3.1
+ */
+
+GDALDatasetH GDALOpenThreadSafeVectorDataset(
+    const char *pszFilename,
+    const char *const *papszAllowedDrivers,
+    const char *const *papszOpenOptions )
+
+{
+    VALIDATE_POINTER1( pszFilename, "GDALOpenThreadSafeVectorDataset",
+                       nullptr );
+
+    return GDALDataset::ToHandle(
+        OGRThreadSafeDataSource::Open( pszFilename, papszAllowedDrivers,
+                                       papszOpenOptions ) );
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Defines OGRThreadSafeDataSource class
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef OGRTHREADSAFEDATASOURCE_H_INCLUDED
+#define OGRTHREADSAFEDATASOURCE_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "ogrsf_frmts.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class OGRThreadSafeLayer;
+
+/** OGRThreadSafeDataSource class gives concurrent read-only access to a
+ *  vector dataset.
+ *
+ *  Each thread transparently uses its own instance of the dataset, opened
+ *  on its first access, so that methods of the layers apply to a cursor
+ *  specific to the calling thread (reading position, filters, ignored
+ *  fields) and do not need to be serialized.  The features returned to a
+ *  thread reference the layer definition returned by GetLayerDefn() in
+ *  that thread.
+ *
+ *  Result sets of ExecuteSQL() must be used and released by the thread
+ *  that created them.
+ */
+class CPL_DLL OGRThreadSafeDataSource final: public GDALDataset
+{
+    CPL_DISALLOW_COPY_ASSIGN(OGRThreadSafeDataSource)
+
+    std::string         m_osFilename{};
+    std::string         m_osDriverName{};
+    CPLStringList       m_aosOpenOptions{};
+
+    // Only used, under the mutex, for the metadata of the dataset and
+    // when a thread dataset cannot be opened.
+    std::unique_ptr<GDALDataset> m_poRefDS{};
+    std::vector<std::unique_ptr<OGRThreadSafeLayer>> m_apoLayers{};
+
+    CPLMutex           *m_hMutex = nullptr;
+    std::map<GIntBig, std::unique_ptr<GDALDataset>> m_oMapThreadDS{};
+    std::map<OGRLayer*, GDALDataset*> m_oMapResultSets{};
+
+                        OGRThreadSafeDataSource() = default;
+
+  public:
+    virtual            ~OGRThreadSafeDataSource();
+
+    static GDALDataset *Open( const char *pszFilename,
+                              const char *const *papszAllowedDrivers,
+                              const char *const *papszOpenOptions );
+
+    GDALDataset        *GetThreadDataset();
+    OGRLayer           *GetThreadLayer( int iLayer );
+    OGRLayer           *GetRefLayer( int iLayer );
+    CPLMutex          **GetMutex() { return &m_hMutex; }
+
+    virtual int         GetLayerCount() override;
+    virtual OGRLayer   *GetLayer( int ) override;
+
+    virtual int         TestCapability( const char * ) override;
+
+    virtual OGRLayer   *ExecuteSQL( const char *pszStatement,
+                                    OGRGeometry *poSpatialFilter,
+                                    const char *pszDialect ) override;
+    virtual void        ReleaseResultSet( OGRLayer *poResultsSet ) override;
+
+    virtual char      **GetFileList() override;
+
+    virtual char      **GetMetadata( const char *pszDomain = "" ) override;
+    virtual const char *GetMetadataItem( const char *pszName,
+                                         const char *pszDomain = "" ) override;
+};
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
+#endif // OGRTHREADSAFEDATASOURCE_H_INCLUDED
@@ -32,6 +32,8 @@
 #include "ogrwarpedlayer.h"
 #include "ogr_p.h"
 
+#include <algorithm>
+
 CPL_CVSID("$Id: ogrunionlayer.cpp 10e54d45fee8229428eb8ab22949aa46eb9da150 2018-05-06 11:07:25 +0200 Even Rouault $")
 
 /************************************************************************/
@@ -116,6 +118,8 @@ OGRUnionLayer::OGRUnionLayer( const char* pszName,
 
 OGRUnionLayer::~OGRUnionLayer()
 {
+    StopParallelReading();
+
     if( bHasLayerOwnership )
     {
         for(int i = 0; i < nSrcLayers; i++)
@@ -208,6 +212,23 @@ void OGRUnionLayer::SetFeatureCount(int nFeatureCountIn)
     nFeatureCount = nFeatureCountIn;
 }
 
+/************************************************************************/
+/*                        SetParallelReading()                          */
+/*                                                                      */
+/*      When nThreads > 1, GetNextFeature() reads the source layers     */
+/*      concurrently in up to nThreads threads, and returns the         */
+/*      features in the order they are read. This is only safe if the   */
+/*      source layers can be read from different threads, that is if    */
+/*      they belong to different datasets.                              */
+/************************************************************************/
+
+void OGRUnionLayer::SetParallelReading(int nThreads)
+{
+    CPLAssert(poFeatureDefn == nullptr);
+
+    nParallelThreads = nThreads;
+}
+
 /************************************************************************/
 /*                         MergeFieldDefn()                             */
 /************************************************************************/
@@ -612,6 +633,8 @@ void OGRUnionLayer::ConfigureActiveLayer()
 
 void OGRUnionLayer::ResetReading()
 {
+    StopParallelReading();
+
     iCurLayer = 0;
     ConfigureActiveLayer();
     nNextFID = 0;
@@ -693,6 +716,12 @@ OGRFeature *OGRUnionLayer::GetNextFeature()
     if( iCurLayer == nSrcLayers )
         return nullptr;
 
+    if( nParallelThreads > 1 && nSrcLayers > 1 &&
+        (bParallelReadingStarted || StartParallelReading()) )
+    {
+        return GetNextFeatureParallel();
+    }
+
     while( true )
     {
         OGRFeature* poSrcFeature = papoSrcLayers[iCurLayer]->GetNextFeature();
@@ -724,6 +753,223 @@ OGRFeature *OGRUnionLayer::GetNextFeature()
     return nullptr;
 }
 
+/************************************************************************/
+/*                        StartParallelReading()                        */
+/************************************************************************/
+
+bool OGRUnionLayer::StartParallelReading()
+{
+    CPLAssert(!bParallelReadingStarted);
+
+    // The source layers are configured in this thread before any reader
+    // starts, and keep their own field map.
+    aanParallelMaps.resize(nSrcLayers);
+    for( int i = 0; i < nSrcLayers; i++ )
+    {
+        iCurLayer = i;
+        ConfigureActiveLayer();
+        const int nSrcFields =
+            papoSrcLayers[i]->GetLayerDefn()->GetFieldCount();
+        aanParallelMaps[i].assign(panMap, panMap + nSrcFields);
+    }
+    iCurLayer = 0;
+
+    // Reader jobs run in the global worker thread pool. They return
+    // instead of blocking when the queue is full, and are resubmitted
+    // once it has room, so that they never hold a pool thread while
+    // the caller is not consuming features.
+    nReaderThreads = std::min(nParallelThreads, nSrcLayers);
+    if( poReaderQueue == nullptr )
+    {
+        CPLWorkerThreadPool* poPool =
+            CPLGetGlobalWorkerThreadPool(nReaderThreads);
+        if( poPool == nullptr )
+        {
+            CPLDebug("UNION", "Cannot create reader threads. "
+                     "Reading source layers sequentially");
+            nParallelThreads = 0;
+            ResetReading();
+            return false;
+        }
+        poReaderQueue = poPool->CreateJobQueue();
+    }
+
+    nMaxQueueSize = static_cast<size_t>(100) * nReaderThreads;
+    bStopReaders = false;
+    nActiveReaders = nSrcLayers;
+    nRunningReaders = 0;
+    aoReaderJobs.clear();
+    aoReaderJobs.resize(nSrcLayers);
+    for( int i = 0; i < nSrcLayers; i++ )
+    {
+        aoReaderJobs[i].poLayer = this;
+        aoReaderJobs[i].iSrcLayer = i;
+    }
+    bParallelReadingStarted = true;
+
+    ScheduleReaders();
+
+    return true;
+}
+
+/************************************************************************/
+/*                        StopParallelReading()                         */
+/************************************************************************/
+
+void OGRUnionLayer::StopParallelReading()
+{
+    if( !bParallelReadingStarted )
+        return;
+
+    {
+        std::lock_guard<std::mutex> oLock(oQueueMutex);
+        bStopReaders = true;
+    }
+    poReaderQueue->WaitCompletion();
+
+    for( auto& oItem: aoQueue )
+        delete oItem.second;
+    aoQueue.clear();
+
+    bParallelReadingStarted = false;
+    bStopReaders = false;
+    nActiveReaders = 0;
+    nRunningReaders = 0;
+}
+
+/************************************************************************/
+/*                          ScheduleReaders()                           */
+/*                                                                      */
+/*      Submits the paused readers, while less than nReaderThreads      */
+/*      are running and the queue is not full.                          */
+/************************************************************************/
+
+void OGRUnionLayer::ScheduleReaders()
+{
+    std::vector<ReaderJob*> apsJobs;
+    {
+        std::lock_guard<std::mutex> oLock(oQueueMutex);
+        for( auto& oJob: aoReaderJobs )
+        {
+            if( bStopReaders || nRunningReaders >= nReaderThreads ||
+                aoQueue.size() >= nMaxQueueSize )
+                break;
+            if( !oJob.bRunning && !oJob.bFinished )
+            {
+                oJob.bRunning = true;
+                nRunningReaders ++;
+                apsJobs.push_back(&oJob);
+            }
+        }
+    }
+
+    for( ReaderJob* psJob: apsJobs )
+    {
+        if( !poReaderQueue->SubmitJob(ReadSourceLayerFunc, psJob) )
+            ReadSourceLayer(psJob);
+    }
+}
+
+/************************************************************************/
+/*                         ReadSourceLayerFunc()                        */
+/************************************************************************/
+
+void OGRUnionLayer::ReadSourceLayerFunc(void* pData)
+{
+    ReaderJob* psJob = static_cast<ReaderJob*>(pData);
+    psJob->poLayer->ReadSourceLayer(psJob);
+}
+
+/************************************************************************/
+/*                           ReadSourceLayer()                          */
+/*                                                                      */
+/*      Runs in a reader job. Pushes the features of a source layer     */
+/*      in the queue, and returns when it is full, to be resubmitted    */
+/*      by ScheduleReaders() later.                                     */
+/************************************************************************/
+
+void OGRUnionLayer::ReadSourceLayer(ReaderJob* psJob)
+{
+    OGRLayer* poSrcLayer = papoSrcLayers[psJob->iSrcLayer];
+
+    while( true )
+    {
+        {
+            std::lock_guard<std::mutex> oLock(oQueueMutex);
+            if( bStopReaders || aoQueue.size() >= nMaxQueueSize )
+            {
+                psJob->bRunning = false;
+                nRunningReaders --;
+                return;
+            }
+        }
+
+        OGRFeature* poSrcFeature = poSrcLayer->GetNextFeature();
+
+        std::unique_lock<std::mutex> oLock(oQueueMutex);
+        if( poSrcFeature == nullptr )
+        {
+            psJob->bRunning = false;
+            psJob->bFinished = true;
+            nRunningReaders --;
+            nActiveReaders --;
+            oLock.unlock();
+            oQueueNotEmpty.notify_one();
+            return;
+        }
+        aoQueue.push_back(std::pair<int, OGRFeature*>(psJob->iSrcLayer,
+                                                       poSrcFeature));
+        oLock.unlock();
+        oQueueNotEmpty.notify_one();
+    }
+}
+
+/************************************************************************/
+/*                       GetNextFeatureParallel()                       */
+/************************************************************************/
+
+OGRFeature *OGRUnionLayer::GetNextFeatureParallel()
+{
+    while( true )
+    {
+        std::pair<int, OGRFeature*> oItem;
+        bool bSchedule = false;
+        {
+            std::unique_lock<std::mutex> oLock(oQueueMutex);
+            oQueueNotEmpty.wait(oLock, [this]
+                { return !aoQueue.empty() || nActiveReaders == 0; });
+            if( aoQueue.empty() )
+                break;
+            oItem = aoQueue.front();
+            aoQueue.pop_front();
+            bSchedule = nRunningReaders < nReaderThreads &&
+                        nRunningReaders < nActiveReaders;
+        }
+        if( bSchedule )
+            ScheduleReaders();
+
+        OGRFeature* poSrcFeature = oItem.second;
+        OGRFeature* poFeature = TranslateFromSrcLayer(
+            oItem.first, aanParallelMaps[oItem.first].data(), poSrcFeature);
+        delete poSrcFeature;
+
+        if( (m_poFilterGeom == nullptr ||
+             FilterGeometry( poFeature->GetGeomFieldRef(m_iGeomFieldFilter) ) ) &&
+            (m_poAttrQuery == nullptr ||
+             m_poAttrQuery->Evaluate( poFeature )) )
+        {
+            return poFeature;
+        }
+
+        delete poFeature;
+    }
+
+    // All source layers have been read.
+    StopParallelReading();
+    iCurLayer = nSrcLayers;
+    return nullptr;
+}
+
 /************************************************************************/
 /*                             GetFeature()                             */
 /************************************************************************/
@@ -742,6 +988,7 @@ OGRFeature *OGRUnionLayer::GetFeature( GIntBig nFeatureId )
         OGRGeometry* poGeomSave = m_poFilterGeom;
         m_poFilterGeom = nullptr;
         SetSpatialFilter(nullptr);
+        StopParallelReading();
 
         for(int i=0;i<nSrcLayers;i++)
         {
@@ -795,6 +1042,10 @@ OGRErr OGRUnionLayer::ICreateFeature( OGRFeature* poFeature )
         return OGRERR_FAILURE;
     }
 
+    // The source layers cannot be used while the reader threads run.
+    if( bParallelReadingStarted )
+        ResetReading();
+
     const char* pszSrcLayerName = poFeature->GetFieldAsString(0);
     for(int i=0;i<nSrcLayers;i++)
     {
@@ -854,6 +1105,10 @@ OGRErr OGRUnionLayer::ISetFeature( OGRFeature* poFeature )
         return OGRERR_FAILURE;
     }
 
+    // The source layers cannot be used while the reader threads run.
+    if( bParallelReadingStarted )
+        ResetReading();
+
     const char* pszSrcLayerName = poFeature->GetFieldAsString(0);
     for(int i=0;i<nSrcLayers;i++)
     {
@@ -975,6 +1230,8 @@ GIntBig OGRUnionLayer::GetFeatureCount( int bForce )
     if( !GetAttrFilterPassThroughValue() )
         return OGRLayer::GetFeatureCount(bForce);
 
+    StopParallelReading();
+
     GIntBig nRet = 0;
     for(int i = 0; i < nSrcLayers; i++)
     {
@@ -1011,7 +1268,10 @@ OGRErr OGRUnionLayer::SetAttributeFilter( const char * pszAttributeFilterIn )
     pszAttributeFilter = pszAttributeFilterIn ?
                                 CPLStrdup(pszAttributeFilterIn) : nullptr;
 
-    if( iCurLayer >= 0 && iCurLayer < nSrcLayers)
+    // The filter of all source layers must be changed, so restart.
+    if( bParallelReadingStarted )
+        ResetReading();
+    else if( iCurLayer >= 0 && iCurLayer < nSrcLayers)
         ApplyAttributeFilterToSrcLayer(iCurLayer);
 
     return OGRERR_NONE;
@@ -1148,6 +1408,9 @@ OGRErr OGRUnionLayer::GetExtent(int iGeomField, OGREnvelope *psExtent, int bForc
         return OGRERR_FAILURE;
     }
 
+    if( bParallelReadingStarted )
+        ResetReading();
+
     int bInit = FALSE;
     for(int i = 0; i < nSrcLayers; i++)
     {
@@ -1211,6 +1474,8 @@ void OGRUnionLayer::SetSpatialFilter( int iGeomField, OGRGeometry *poGeom )
     m_iGeomFieldFilter = iGeomField;
     if( InstallFilter( poGeom ) )
         ResetReading();
+    else if( bParallelReadingStarted )
+        ResetReading();
 
     if( iCurLayer >= 0 && iCurLayer < nSrcLayers)
     {
@@ -1224,16 +1489,24 @@ void OGRUnionLayer::SetSpatialFilter( int iGeomField, OGRGeometry *poGeom )
 
 OGRFeature* OGRUnionLayer::TranslateFromSrcLayer(OGRFeature* poSrcFeature)
 {
-    CPLAssert(poSrcFeature->GetFieldCount() == 0 || panMap != nullptr);
     CPLAssert(iCurLayer >= 0 && iCurLayer < nSrcLayers);
 
+    return TranslateFromSrcLayer(iCurLayer, panMap, poSrcFeature);
+}
+
+OGRFeature* OGRUnionLayer::TranslateFromSrcLayer(int iSrcLayer,
+                                                 const int* panSrcMap,
+                                                 OGRFeature* poSrcFeature)
+{
+    CPLAssert(poSrcFeature->GetFieldCount() == 0 || panSrcMap != nullptr);
+
     OGRFeature* poFeature = new OGRFeature(poFeatureDefn);
-    poFeature->SetFrom(poSrcFeature, panMap, TRUE);
+    poFeature->SetFrom(poSrcFeature, panSrcMap, TRUE);
 
     if( !osSourceLayerFieldName.empty() &&
         !poFeatureDefn->GetFieldDefn(0)->IsIgnored() )
     {
-        poFeature->SetField(0, papoSrcLayers[iCurLayer]->GetName());
+        poFeature->SetField(0, papoSrcLayers[iSrcLayer]->GetName());
     }
 
     for(int i=0;i<poFeatureDefn->GetGeomFieldCount();i++)
@@ -1280,6 +1553,9 @@ OGRErr OGRUnionLayer::SetIgnoredFields( const char **papszFields )
 
 OGRErr OGRUnionLayer::SyncToDisk()
 {
+    if( bParallelReadingStarted )
+        ResetReading();
+
     for(int i = 0; i < nSrcLayers; i++)
     {
         if (pabModifiedLayers[i])
@@ -33,6 +33,14 @@
 #ifndef DOXYGEN_SKIP
 
 #include "ogrsf_frmts.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 /************************************************************************/
 /*                      OGRUnionLayerGeomFieldDefn                      */
@@ -102,6 +110,39 @@ class OGRUnionLayer : public OGRLayer
     int                 GetAttrFilterPassThroughValue();
     void                ConfigureActiveLayer();
     void                SetSpatialFilterToSourceLayer(OGRLayer* poSrcLayer);
+    OGRFeature         *TranslateFromSrcLayer(int iSrcLayer,
+                                              const int* panSrcMap,
+                                              OGRFeature* poSrcFeature);
+
+    // Parallel reading of the source layers.
+    struct ReaderJob
+    {
+        OGRUnionLayer  *poLayer = nullptr;
+        int             iSrcLayer = 0;
+        bool            bRunning = false;
+        bool            bFinished = false;
+    };
+
+    int                 nParallelThreads = 0;
+    std::vector<ReaderJob> aoReaderJobs{};
+    bool                bParallelReadingStarted = false;
+    std::unique_ptr<CPLJobQueue> poReaderQueue{};
+    std::vector<std::vector<int>> aanParallelMaps{};
+    std::mutex          oQueueMutex{};
+    std::condition_variable oQueueNotEmpty{};
+    std::deque<std::pair<int, OGRFeature*>> aoQueue{};
+    size_t              nMaxQueueSize = 0;
+    int                 nActiveReaders = 0;
+    int                 nRunningReaders = 0;
+    int                 nReaderThreads = 0;
+    bool                bStopReaders = false;
+
+    bool                StartParallelReading();
+    void                StopParallelReading();
+    OGRFeature         *GetNextFeatureParallel();
+    void                ScheduleReaders();
+    void                ReadSourceLayer(ReaderJob* psJob);
+    static void         ReadSourceLayerFunc(void* pData);
 
   public:
                         OGRUnionLayer( const char* pszName,
@@ -121,6 +162,7 @@ class OGRUnionLayer : public OGRLayer
     void                SetSourceLayerFieldName(const char* pszSourceLayerFieldName);
     void                SetPreserveSrcFID(int bPreserveSrcFID);
     void                SetFeatureCount(int nFeatureCount);
+    void                SetParallelReading(int nThreads);
     virtual const char  *GetName() override { return osName.c_str(); }
     virtual OGRwkbGeometryType GetGeomType() override;
 
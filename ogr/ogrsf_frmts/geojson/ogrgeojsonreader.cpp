@@ -104,6 +104,13 @@ class OGRGeoJSONReaderStreamingParser: public CPLJSonStreamingParser
         bool m_bStartFeature = false;
         bool m_bEndFeature = false;
 
+        // Offset and size of the features of the features array. Only
+        // established during the first pass.
+        std::vector<std::pair<vsi_l_offset, vsi_l_offset>> m_aoFeatureOffsetSize{};
+        GUIntBig m_nCurFeatureOffset = 0;
+        GUIntBig m_nFeaturesArrayMemberCount = 0;
+        bool m_bFeatureIndexValid = true;
+
         void AppendObject(json_object* poNewObj);
         void AnalyzeFeature();
         void TooComplex();
@@ -142,6 +149,9 @@ class OGRGeoJSONReaderStreamingParser: public CPLJSonStreamingParser
         inline void ResetFeatureDetectionState() { m_bStartFeature = false; m_bEndFeature = false; }
         inline bool IsStartFeature() const { return m_bStartFeature; }
         inline bool IsEndFeature() const { return m_bEndFeature; }
+
+        bool StealFeatureOffsetSize(
+            std::vector<std::pair<vsi_l_offset, vsi_l_offset>>& aoOut );
 };
 
 
@@ -353,6 +363,26 @@ json_object* OGRGeoJSONReaderStreamingParser::StealRootObject()
     return poRet;
 }
 
+/************************************************************************/
+/*                       StealFeatureOffsetSize()                       */
+/************************************************************************/
+
+// Returns the (offset, size) of the features found in the features array
+// during the first pass, provided that every member of the array was a
+// Feature object, so that the i-th entry is the i-th feature.
+bool OGRGeoJSONReaderStreamingParser::StealFeatureOffsetSize(
+            std::vector<std::pair<vsi_l_offset, vsi_l_offset>>& aoOut )
+{
+    aoOut.clear();
+    if( !m_bFirstPass || !m_bFeatureIndexValid ||
+        m_nFeaturesArrayMemberCount != m_aoFeatureOffsetSize.size() )
+    {
+        return false;
+    }
+    std::swap(aoOut, m_aoFeatureOffsetSize);
+    return true;
+}
+
 /************************************************************************/
 /*                          GetNextFeature()                           */
 /************************************************************************/
@@ -427,6 +457,8 @@ void OGRGeoJSONReaderStreamingParser::StartObject()
             m_abFirstMember.push_back(true);
         }
         m_bStartFeature = true;
+        if( m_bFirstPass )
+            m_nCurFeatureOffset = GetCurrentObjectCharOffset();
     }
     else if( m_poCurObj )
     {
@@ -478,6 +510,7 @@ void OGRGeoJSONReaderStreamingParser::EndObject()
 
         if( m_bFirstPass )
         {
+            bool bIsFeature = false;
             json_object* poObjTypeObj =
                 CPL_json_object_object_get(m_poCurObj, "type");
             if( poObjTypeObj &&
@@ -487,8 +520,20 @@ void OGRGeoJSONReaderStreamingParser::EndObject()
                 if( strcmp(pszObjType, "Feature") == 0 )
                 {
                     AnalyzeFeature();
+                    bIsFeature = true;
                 }
             }
+            if( bIsFeature && m_bFeatureIndexValid )
+            {
+                m_aoFeatureOffsetSize.push_back(
+                    std::pair<vsi_l_offset, vsi_l_offset>(
+                        m_nCurFeatureOffset,
+                        GetCurrentObjectCharOffset() - m_nCurFeatureOffset + 1));
+            }
+            else
+            {
+                m_bFeatureIndexValid = false;
+            }
         }
         else
         {
@@ -619,6 +664,11 @@ void OGRGeoJSONReaderStreamingParser::StartArray()
 
 void OGRGeoJSONReaderStreamingParser::StartArrayMember()
 {
+    if( m_bFirstPass && m_bInFeaturesArray && m_nDepth == 2 )
+    {
+        m_nFeaturesArrayMemberCount ++;
+    }
+
     if( m_poCurObj )
     {
         m_nCurObjMemEstimate += ESTIMATE_ARRAY_ELT_SIZE;
@@ -865,6 +915,7 @@ bool OGRGeoJSONReader::FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
     pabyBuffer_ = static_cast<GByte*>(CPLMalloc(nBufferSize_));
     int nIter = 0;
     bool bThresholdReached = false;
+    size_t nFirstSegSkip = 0;
     const GIntBig nMaxBytesFirstPass = CPLAtoGIntBig(
         CPLGetConfigOption("OGR_GEOJSON_MAX_BYTES_FIRST_PASS", "0"));
     const GIntBig nLimitFeaturesFirstPass = CPLAtoGIntBig(CPLGetConfigOption(
@@ -890,6 +941,7 @@ bool OGRGeoJSONReader::FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
         {
             bFirstSeg_ = false;
             nSkip = SkipPrologEpilogAndUpdateJSonPLikeWrapper(nRead);
+            nFirstSegSkip = nSkip;
         }
         if( bFinished && bJSonPLikeWrapper_ && nRead - nSkip > 0 )
             nRead --;
@@ -965,6 +1017,16 @@ bool OGRGeoJSONReader::FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
 
     bCanEasilyAppend_ = oParser.CanEasilyAppend();
     nTotalFeatureCount_ = poLayer->GetFeatureCount(FALSE);
+
+    // Keep the location of the features in the file, so that GetFeature()
+    // does not need to parse again the whole file to establish its index.
+    aoFeatureOffsetSize_.clear();
+    if( !bThresholdReached &&
+        oParser.StealFeatureOffsetSize(aoFeatureOffsetSize_) )
+    {
+        for( auto& oOffsetSize: aoFeatureOffsetSize_ )
+            oOffsetSize.first += nFirstSegSkip;
+    }
     nTotalOGRFeatureMemEstimate_ = oParser.GetTotalOGRFeatureMemEstimate();
 
     json_object* poRootObj = oParser.StealRootObject();
@@ -1132,6 +1194,55 @@ OGRFeature* OGRGeoJSONReader::GetFeature(OGRGeoJSONLayer* poLayer, GIntBig nFID)
 {
     CPLAssert( fp_ );
 
+    if( oMapFIDToOffsetSize_.empty() && !aoFeatureOffsetSize_.empty() )
+    {
+        // If the FIDs are the index of the features in the features array,
+        // the index established during the first pass is directly usable.
+        if( poLayer->GetFIDColumn()[0] == '\0' && !IsFeatureLevelIdAsFID() )
+        {
+            if( nFID < 0 ||
+                static_cast<GUIntBig>(nFID) >= aoFeatureOffsetSize_.size() )
+            {
+                return nullptr;
+            }
+            const auto& oOffsetSize =
+                aoFeatureOffsetSize_[static_cast<size_t>(nFID)];
+            OGRFeature* poFeat =
+                ReadFeatureAt(poLayer, oOffsetSize.first, oOffsetSize.second);
+            if( poFeat )
+                poFeat->SetFID(nFID);
+            return poFeat;
+        }
+
+        CPLDebug("GeoJSON", "Establishing index to features for first GetFeature() call");
+
+        delete poStreamingParser_;
+        poStreamingParser_ = nullptr;
+
+        // Only the features need to be parsed, from their known location.
+        GIntBig nSeqFID = 0;
+        for( const auto& oOffsetSize: aoFeatureOffsetSize_ )
+        {
+            OGRFeature* poFeat =
+                ReadFeatureAt(poLayer, oOffsetSize.first, oOffsetSize.second);
+            if( poFeat )
+            {
+                GIntBig nThisFID = poFeat->GetFID();
+                if( nThisFID < 0 )
+                {
+                    nThisFID = nSeqFID;
+                    nSeqFID++;
+                }
+                if( oMapFIDToOffsetSize_.find(nThisFID) == oMapFIDToOffsetSize_.end() )
+                {
+                    oMapFIDToOffsetSize_[nThisFID] = oOffsetSize;
+                }
+                delete poFeat;
+            }
+        }
+        aoFeatureOffsetSize_.clear();
+    }
+
     if( oMapFIDToOffsetSize_.empty() )
     {
         CPLDebug("GeoJSON", "Establishing index to features for first GetFeature() call");
@@ -1206,12 +1317,30 @@ OGRFeature* OGRGeoJSONReader::GetFeature(OGRGeoJSONLayer* poLayer, GIntBig nFID)
         return nullptr;
     }
 
-    VSIFSeekL(fp_, oIter->second.first, SEEK_SET);
-    if( oIter->second.second > 1000 * 1000 * 1000 )
+    OGRFeature* poFeat =
+        ReadFeatureAt(poLayer, oIter->second.first, oIter->second.second);
+    if( !poFeat )
     {
         return nullptr;
     }
-    size_t nSize = static_cast<size_t>(oIter->second.second);
+    poFeat->SetFID(nFID);
+    return poFeat;
+}
+
+/************************************************************************/
+/*                           ReadFeatureAt()                            */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONReader::ReadFeatureAt(OGRGeoJSONLayer* poLayer,
+                                            vsi_l_offset nOffset,
+                                            vsi_l_offset nFeatureSize)
+{
+    VSIFSeekL(fp_, nOffset, SEEK_SET);
+    if( nFeatureSize > 1000 * 1000 * 1000 )
+    {
+        return nullptr;
+    }
+    size_t nSize = static_cast<size_t>(nFeatureSize);
     char* pszBuffer = static_cast<char*>(VSIMalloc(nSize + 1));
     if( !pszBuffer )
     {
@@ -1233,11 +1362,6 @@ OGRFeature* OGRGeoJSONReader::GetFeature(OGRGeoJSONLayer* poLayer, GIntBig nFID)
     OGRFeature* poFeat = ReadFeature(poLayer, poObj, pszBuffer);
     json_object_put(poObj);
     VSIFree(pszBuffer);
-    if( !poFeat )
-    {
-        return nullptr;
-    }
-    poFeat->SetFID(nFID);
     return poFeat;
 }
 
@@ -116,6 +116,8 @@ class OGRGeoJSONBaseReader
     bool bArrayAsString_ = false;
     bool bDateAsString_ = false;
 
+    bool IsFeatureLevelIdAsFID() const { return bFeatureLevelIdAsFID_; }
+
   private:
 
     std::set<int> aoSetUndeterminedTypeFields_;
@@ -188,6 +190,13 @@ class OGRGeoJSONReader: public OGRGeoJSONBaseReader
     GUIntBig nTotalOGRFeatureMemEstimate_;
 
     std::map<GIntBig, std::pair<vsi_l_offset, vsi_l_offset>> oMapFIDToOffsetSize_;
+
+    // (offset, size) of each feature of the features array, collected
+    // during the first pass. Empty if it could not be established.
+    std::vector<std::pair<vsi_l_offset, vsi_l_offset>> aoFeatureOffsetSize_;
+
+    OGRFeature* ReadFeatureAt( OGRGeoJSONLayer* poLayer,
+                               vsi_l_offset nOffset, vsi_l_offset nSize );
     //
     // Copy operations not supported.
     //
@@ -29,13 +29,16 @@
 #include "cpl_port.h"
 #include "cpl_http.h"
 #include "cpl_vsi_error.h"
+#include "cpl_worker_thread_pool.h"
 
 #include "ogr_geojson.h"
 #include "ogrgeojsonreader.h"
 #include "ogrgeojsonwriter.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <vector>
 
 CPL_CVSID("$Id: ogrgeojsonseqdriver.cpp 057fef6f31d50e01ce841d56c10c0a71df1bad8e 2020-01-04 19:05:08 +0100 Even Rouault $")
 
@@ -95,7 +98,20 @@ class OGRGeoJSONSeqLayer final: public OGRLayer
         GIntBig m_nTotalFeatures = 0;
         GIntBig m_nNextFID = 0;
 
+        // Parallel parsing of records, when m_nNumThreads > 1
+        int m_nNumThreads = 1;
+        std::unique_ptr<CPLJobQueue> m_poJobQueue{};
+        std::vector<std::string> m_aosBatchRecords{};
+        std::vector<OGRFeature*> m_apoBatchFeatures{};
+        size_t m_nBatchIdx = 0;
+
+        bool GetNextRecord();
         json_object* GetNextObject(bool bLooseIdentification);
+        OGRFeature* BuildFeature(json_object* poObject,
+                                 const char* pszSerializedObj);
+        bool ReadBatch();
+        void ClearBatch();
+        OGRFeature* GetNextRawFeature();
 
     public:
         OGRGeoJSONSeqLayer(OGRGeoJSONSeqDataSource* poDS,
@@ -103,7 +119,7 @@ class OGRGeoJSONSeqLayer final: public OGRLayer
                            VSILFILE* fp);
         ~OGRGeoJSONSeqLayer();
 
-        bool Init(bool bLooseIdentification);
+        bool Init(bool bLooseIdentification, int nNumThreads);
 
         void ResetReading() override;
         OGRFeature* GetNextFeature() override;
@@ -272,6 +288,7 @@ OGRGeoJSONSeqLayer::OGRGeoJSONSeqLayer(OGRGeoJSONSeqDataSource* poDS,
 
 OGRGeoJSONSeqLayer::~OGRGeoJSONSeqLayer()
 {
+    ClearBatch();
     VSIFCloseL(m_fp);
     m_poFeatureDefn->Release();
 }
@@ -280,7 +297,7 @@ OGRGeoJSONSeqLayer::~OGRGeoJSONSeqLayer()
 /*                               Init()                                 */
 /************************************************************************/
 
-bool OGRGeoJSONSeqLayer::Init(bool bLooseIdentification)
+bool OGRGeoJSONSeqLayer::Init(bool bLooseIdentification, int nNumThreads)
 {
     if( STARTS_WITH(m_poDS->GetDescription(), "/vsimem/") ||
         !STARTS_WITH(m_poDS->GetDescription(), "/vsi") )
@@ -310,6 +327,19 @@ bool OGRGeoJSONSeqLayer::Init(bool bLooseIdentification)
     m_nIter = 0;
     m_oReader.FinalizeLayerDefn( this, m_osFIDColumn );
 
+    // The layer definition being established, records can be translated
+    // to features independently of each other.
+    if( nNumThreads > 1 )
+    {
+        CPLWorkerThreadPool* poPool =
+            CPLGetGlobalWorkerThreadPool(nNumThreads);
+        if( poPool )
+        {
+            m_poJobQueue = poPool->CreateJobQueue();
+            m_nNumThreads = nNumThreads;
+        }
+    }
+
     return m_nTotalFeatures > 0;
 }
 
@@ -331,13 +361,28 @@ void OGRGeoJSONSeqLayer::ResetReading()
     m_nPosInBuffer = nBufferSizeValidated;
     m_nBufferValidSize = nBufferSizeValidated;
     m_nNextFID = 0;
+    ClearBatch();
 }
 
 /************************************************************************/
-/*                           GetNextObject()                            */
+/*                             ClearBatch()                             */
 /************************************************************************/
 
-json_object* OGRGeoJSONSeqLayer::GetNextObject(bool bLooseIdentification)
+void OGRGeoJSONSeqLayer::ClearBatch()
+{
+    for( size_t i = m_nBatchIdx; i < m_apoBatchFeatures.size(); i++ )
+        delete m_apoBatchFeatures[i];
+    m_apoBatchFeatures.clear();
+    m_aosBatchRecords.clear();
+    m_nBatchIdx = 0;
+}
+
+/************************************************************************/
+/*                           GetNextRecord()                            */
+/************************************************************************/
+
+// Loads the next non-empty record in m_osFeatureBuffer.
+bool OGRGeoJSONSeqLayer::GetNextRecord()
 {
     m_osFeatureBuffer.clear();
     while( true )
@@ -347,7 +392,7 @@ json_object* OGRGeoJSONSeqLayer::GetNextObject(bool bLooseIdentification)
         {
             if( m_nBufferValidSize < m_osBuffer.size() )
             {
-                return nullptr;
+                return false;
             }
             m_nBufferValidSize = VSIFReadL(&m_osBuffer[0], 1,
                                            m_osBuffer.size(), m_fp);
@@ -371,7 +416,7 @@ json_object* OGRGeoJSONSeqLayer::GetNextObject(bool bLooseIdentification)
             }
             if( m_nPosInBuffer >= m_nBufferValidSize )
             {
-                return nullptr;
+                return false;
             }
         }
 
@@ -393,7 +438,7 @@ json_object* OGRGeoJSONSeqLayer::GetNextObject(bool bLooseIdentification)
             {
                 CPLError(CE_Failure, CPLE_NotSupported,
                             "Too large feature");
-                return nullptr;
+                return false;
             }
             m_nPosInBuffer = m_nBufferValidSize;
             if( m_nBufferValidSize == m_osBuffer.size() )
@@ -410,60 +455,47 @@ json_object* OGRGeoJSONSeqLayer::GetNextObject(bool bLooseIdentification)
         }
         if( !m_osFeatureBuffer.empty() )
         {
-            json_object* poObject = nullptr;
-            CPL_IGNORE_RET_VAL(
-                OGRJSonParse(m_osFeatureBuffer.c_str(), &poObject));
-            m_osFeatureBuffer.clear();
-            if( json_object_get_type(poObject) == json_type_object )
-            {
-                return poObject;
-            }
-            json_object_put(poObject);
-            if( bLooseIdentification )
-            {
-                return nullptr;
-            }
+            return true;
         }
     }
 }
 
 /************************************************************************/
-/*                           GetNextFeature()                           */
+/*                           GetNextObject()                            */
 /************************************************************************/
 
-OGRFeature* OGRGeoJSONSeqLayer::GetNextFeature()
+json_object* OGRGeoJSONSeqLayer::GetNextObject(bool bLooseIdentification)
 {
-    while( true )
+    while( GetNextRecord() )
     {
-        auto poObject = GetNextObject(false);
-        if( !poObject )
-            return nullptr;
-        OGRFeature* poFeature;
-        auto type = OGRGeoJSONGetType(poObject);
-        if( type == GeoJSONObject::eFeature )
+        json_object* poObject = nullptr;
+        CPL_IGNORE_RET_VAL(
+            OGRJSonParse(m_osFeatureBuffer.c_str(), &poObject));
+        m_osFeatureBuffer.clear();
+        if( json_object_get_type(poObject) == json_type_object )
         {
-            poFeature = m_oReader.ReadFeature(
-                this, poObject, m_osFeatureBuffer.c_str() );
-            json_object_put(poObject);
-        }
-        else if( type == GeoJSONObject::eFeatureCollection ||
-                 type == GeoJSONObject::eUnknown )
-        {
-            json_object_put(poObject);
-            continue;
+            return poObject;
         }
-        else
+        json_object_put(poObject);
+        if( bLooseIdentification )
         {
-            OGRGeometry* poGeom = m_oReader.ReadGeometry(poObject,
-                                                         GetSpatialRef());
-            json_object_put(poObject);
-            if( !poGeom )
-            {
-                continue;
-            }
-            poFeature = new OGRFeature(m_poFeatureDefn);
-            poFeature->SetGeometryDirectly(poGeom);
+            return nullptr;
         }
+    }
+    return nullptr;
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONSeqLayer::GetNextFeature()
+{
+    while( true )
+    {
+        OGRFeature* poFeature = GetNextRawFeature();
+        if( !poFeature )
+            return nullptr;
 
         if( poFeature->GetFID() == OGRNullFID )
         {
@@ -481,6 +513,181 @@ OGRFeature* OGRGeoJSONSeqLayer::GetNextFeature()
     }
 }
 
+/************************************************************************/
+/*                            BuildFeature()                            */
+/************************************************************************/
+
+// Translates a record into a feature, or returns nullptr if it must be
+// skipped. Does not modify the state of the layer, so that it can be called
+// from several threads at once.
+OGRFeature* OGRGeoJSONSeqLayer::BuildFeature(json_object* poObject,
+                                             const char* pszSerializedObj)
+{
+    auto type = OGRGeoJSONGetType(poObject);
+    if( type == GeoJSONObject::eFeature )
+    {
+        return m_oReader.ReadFeature(this, poObject, pszSerializedObj);
+    }
+    if( type == GeoJSONObject::eFeatureCollection ||
+        type == GeoJSONObject::eUnknown )
+    {
+        return nullptr;
+    }
+    OGRGeometry* poGeom = m_oReader.ReadGeometry(poObject,
+                                                 m_poFeatureDefn->
+                                                    GetGeomFieldDefn(0)->
+                                                        GetSpatialRef());
+    if( !poGeom )
+    {
+        return nullptr;
+    }
+    OGRFeature* poFeature = new OGRFeature(m_poFeatureDefn);
+    poFeature->SetGeometryDirectly(poGeom);
+    return poFeature;
+}
+
+/************************************************************************/
+/*                             ReadBatch()                              */
+/************************************************************************/
+
+namespace {
+
+struct OGRGeoJSONSeqJobError
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+};
+
+struct OGRGeoJSONSeqJob
+{
+    std::function<void(size_t)> *pfnFunc = nullptr;
+    size_t                       nStart = 0;
+    size_t                       nEnd = 0;
+    std::vector<OGRGeoJSONSeqJobError> aoErrors{};
+};
+
+} // namespace
+
+static void CPL_STDCALL OGRGeoJSONSeqJobErrorHandler(
+    CPLErr eErrClass, CPLErrorNum nErrNo, const char* pszMsg )
+{
+    OGRGeoJSONSeqJob* psJob =
+        static_cast<OGRGeoJSONSeqJob*>(CPLGetErrorHandlerUserData());
+    psJob->aoErrors.push_back(
+        OGRGeoJSONSeqJobError{eErrClass, nErrNo, pszMsg});
+}
+
+static void OGRGeoJSONSeqJobThreadFunc( void* pData )
+{
+    OGRGeoJSONSeqJob* psJob = static_cast<OGRGeoJSONSeqJob*>(pData);
+    // Errors are re-emitted by the calling thread.
+    CPLPushErrorHandlerEx(OGRGeoJSONSeqJobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    for( size_t i = psJob->nStart; i < psJob->nEnd; i++ )
+        (*psJob->pfnFunc)(i);
+    CPLPopErrorHandler();
+}
+
+// Reads the next records of the file and translates them to features,
+// using m_nNumThreads threads.
+bool OGRGeoJSONSeqLayer::ReadBatch()
+{
+    ClearBatch();
+
+    // Enough records for each thread to have a significant amount of work,
+    // while keeping the memory use bounded.
+    constexpr size_t MAX_BATCH_BYTES = 10 * 1024 * 1024;
+    const size_t nMaxRecords = static_cast<size_t>(m_nNumThreads) * 1000;
+    size_t nBatchBytes = 0;
+    while( m_aosBatchRecords.size() < nMaxRecords &&
+           nBatchBytes < MAX_BATCH_BYTES && GetNextRecord() )
+    {
+        nBatchBytes += m_osFeatureBuffer.size();
+        m_aosBatchRecords.push_back(m_osFeatureBuffer);
+    }
+    m_osFeatureBuffer.clear();
+    if( m_aosBatchRecords.empty() )
+        return false;
+
+    m_apoBatchFeatures.resize(m_aosBatchRecords.size());
+    std::function<void(size_t)> pfnFunc = [this](size_t i)
+    {
+        json_object* poObject = nullptr;
+        CPL_IGNORE_RET_VAL(
+            OGRJSonParse(m_aosBatchRecords[i].c_str(), &poObject));
+        if( json_object_get_type(poObject) == json_type_object )
+        {
+            m_apoBatchFeatures[i] =
+                BuildFeature(poObject, m_aosBatchRecords[i].c_str());
+        }
+        json_object_put(poObject);
+    };
+
+    // The calling thread takes care of the first range.
+    const size_t nCount = m_aosBatchRecords.size();
+    std::vector<OGRGeoJSONSeqJob> asJobs(m_nNumThreads);
+    for( int iJob = 0; iJob < m_nNumThreads; iJob++ )
+    {
+        asJobs[iJob].pfnFunc = &pfnFunc;
+        asJobs[iJob].nStart = nCount * iJob / m_nNumThreads;
+        asJobs[iJob].nEnd = nCount * (iJob + 1) / m_nNumThreads;
+    }
+    for( int iJob = 1; iJob < m_nNumThreads; iJob++ )
+    {
+        if( !m_poJobQueue->SubmitJob(OGRGeoJSONSeqJobThreadFunc, &asJobs[iJob]) )
+            OGRGeoJSONSeqJobThreadFunc(&asJobs[iJob]);
+    }
+    OGRGeoJSONSeqJobThreadFunc(&asJobs[0]);
+    m_poJobQueue->WaitCompletion();
+
+    for( const auto& sJob: asJobs )
+    {
+        for( const auto& oError: sJob.aoErrors )
+        {
+            CPLError(oError.eErrClass, oError.nErrNo, "%s",
+                     oError.osMsg.c_str());
+        }
+    }
+    m_aosBatchRecords.clear();
+    return true;
+}
+
+/************************************************************************/
+/*                         GetNextRawFeature()                          */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONSeqLayer::GetNextRawFeature()
+{
+    if( m_nNumThreads <= 1 )
+    {
+        while( true )
+        {
+            auto poObject = GetNextObject(false);
+            if( !poObject )
+                return nullptr;
+            OGRFeature* poFeature =
+                BuildFeature(poObject, m_osFeatureBuffer.c_str());
+            json_object_put(poObject);
+            if( poFeature )
+                return poFeature;
+        }
+    }
+
+    // Features are returned in the order of the records, so that
+    // sequential FIDs are the same as in the single-threaded case.
+    while( true )
+    {
+        if( m_nBatchIdx == m_apoBatchFeatures.size() && !ReadBatch() )
+            return nullptr;
+        OGRFeature* poFeature = m_apoBatchFeatures[m_nBatchIdx];
+        m_apoBatchFeatures[m_nBatchIdx] = nullptr;
+        m_nBatchIdx ++;
+        if( poFeature )
+            return poFeature;
+    }
+}
+
 /************************************************************************/
 /*                          GetFeatureCount()                           */
 /************************************************************************/
@@ -743,7 +950,8 @@ bool OGRGeoJSONSeqDataSource::Open( GDALOpenInfo* poOpenInfo,
     {
         CPLPushErrorHandler(CPLQuietErrorHandler);
     }
-    auto ret = poLayer->Init(bLooseIdentification);
+    const int nNumThreads = CPLGetNumThreads(poOpenInfo->papszOpenOptions);
+    auto ret = poLayer->Init(bLooseIdentification, nNumThreads);
     if( bLooseIdentification )
     {
         CPLPopErrorHandler();
@@ -882,6 +1090,11 @@ void RegisterOGRGeoJSONSeq()
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSIONS, "geojsonl geojsons" );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drv_geojsonseq.html" );
 
+    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+"<OpenOptionList>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads to use to parse records. Integer value or ALL_CPUS' default='GDAL_NUM_THREADS config option or 1'/>"
+"</OpenOptionList>");
+
     poDriver->SetMetadataItem( GDAL_DS_LAYER_CREATIONOPTIONLIST,
 "<LayerCreationOptionList>"
 "  <Option name='RS' type='boolean' description='whether to prefix records with RS=0x1e character' default='NO'/>"
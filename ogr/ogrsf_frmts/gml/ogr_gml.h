@@ -33,10 +33,15 @@
 #define OGR_GML_H_INCLUDED
 
 #include "ogrsf_frmts.h"
+#include "cpl_worker_thread_pool.h"
 #include "gmlreader.h"
 #include "gmlutils.h"
 
+#include <memory>
+#include <vector>
+
 class OGRGMLDataSource;
+class OGRGMLLayer;
 
 typedef enum
 {
@@ -45,6 +50,36 @@ typedef enum
     INTERLEAVED_LAYERS
 } ReadMode;
 
+typedef enum
+{
+    GMLTS_OK,
+    GMLTS_FILTERED,
+    GMLTS_GEOMETRY_ERROR,       // the feature may be skipped
+    GMLTS_FATAL_GEOMETRY_ERROR  // reading stops
+} OGRGMLTranslationStatus;
+
+// Result of the translation of a GML feature on a worker thread.
+struct OGRGMLTranslatedFeature
+{
+    OGRFeature             *poFeature = nullptr;
+    OGRGMLTranslationStatus eStatus = GMLTS_OK;
+    GIntBig                 nFID = -1;
+    bool                    bHasGMLFID = false;
+    CPLString               osGMLFID{};
+    CPLString               osErrorMsg{};
+};
+
+// Consecutive GML features translated by one worker thread.
+struct OGRGMLTranslationJob
+{
+    OGRGMLLayer            *poLayer = nullptr;
+    void                   *hSRSCache = nullptr;
+    bool                    bHasSRSName = false;
+    CPLString               osSRSName{};
+    std::vector<GMLFeature*> apoGMLFeatures{};
+    std::vector<OGRGMLTranslatedFeature> asResults{};
+};
+
 /************************************************************************/
 /*                            OGRGMLLayer                               */
 /************************************************************************/
@@ -70,6 +105,27 @@ class OGRGMLLayer final: public OGRLayer
 
     bool                bFaceHoleNegative;
 
+    GIntBig             GetNextFID( const char *pszGML_FID );
+    OGRFeature         *TranslateGMLFeature( GMLFeature *poGMLFeature,
+                                             GIntBig nFID,
+                                             const char *pszSRSName,
+                                             void *hSRSCache,
+                                             bool bApplySpatialFilter,
+                                             OGRGMLTranslationStatus &eStatus,
+                                             CPLString &osErrorMsg );
+
+    // Multi-threaded translation of features.
+    std::unique_ptr<CPLJobQueue> m_poTranslationQueue{};
+    std::vector<void*>  m_ahWorkerSRSCache{};
+    std::vector<OGRGMLTranslationJob> m_asTranslationJobs{};
+    std::vector<OGRGMLTranslatedFeature> m_asTranslated{};
+    size_t              m_iNextTranslated;
+    bool                m_bTranslationEOF;
+    bool                TranslateNextFeatures();
+    void                DiscardTranslatedFeatures();
+    OGRFeature         *GetNextTranslatedFeature();
+    static void         TranslateJobThreadFunc( void *pData );
+
   public:
                         OGRGMLLayer( const char * pszName,
                                      bool bWriter,
@@ -151,6 +207,7 @@ class OGRGMLDataSource final: public OGRDataSource
     bool                m_bGetSecondaryGeometryOption;
 
     ReadMode            eReadMode;
+    int                 m_nNumThreads;
     GMLFeature         *poStoredGMLFeature;
     OGRGMLLayer        *poLastReadLayer;
 
@@ -204,6 +261,7 @@ class OGRGMLDataSource final: public OGRDataSource
     bool                GetSecondaryGeometryOption() const { return m_bGetSecondaryGeometryOption; }
 
     ReadMode            GetReadMode() const { return eReadMode; }
+    int                 GetNumThreads() const { return m_nNumThreads; }
     void                SetStoredGMLFeature(GMLFeature* poStoredGMLFeatureIn) { poStoredGMLFeature = poStoredGMLFeatureIn; }
     GMLFeature*         PeekStoredGMLFeature() const { return  poStoredGMLFeature; }
 
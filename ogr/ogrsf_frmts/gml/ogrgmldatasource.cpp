@@ -109,6 +109,7 @@ OGRGMLDataSource::OGRGMLDataSource() :
     m_eSwapCoordinates(GML_SWAP_AUTO),
     m_bGetSecondaryGeometryOption(false),
     eReadMode(STANDARD),
+    m_nNumThreads(1),
     poStoredGMLFeature(nullptr),
     poLastReadLayer(nullptr),
     bEmptyAsNull(true)
@@ -599,6 +600,8 @@ bool OGRGMLDataSource::Open( GDALOpenInfo *poOpenInfo )
                  "Unrecognized value for GML_READ_MODE configuration option.");
     }
 
+    m_nNumThreads = CPLGetNumThreads(poOpenInfo->papszOpenOptions);
+
     m_bInvertAxisOrderIfLatLong = CPLTestBool(CSLFetchNameValueDef(
         poOpenInfo->papszOpenOptions, "INVERT_AXIS_ORDER_IF_LAT_LONG",
         CPLGetConfigOption("GML_INVERT_AXIS_ORDER_IF_LAT_LONG", "YES")));
@@ -182,6 +182,7 @@ void RegisterOGRGML()
 "  </Option>"
 "  <Option name='DOWNLOAD_SCHEMA' type='boolean' description='Whether to download the remote application schema if needed (only for WFS currently)' default='YES'/>"
 "  <Option name='REGISTRY' type='string' description='Filename of the registry with application schemas.'/>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads used to translate features in STANDARD read mode. Integer or ALL_CPUS' default='1'/>"
 "</OpenOptionList>" );
 
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
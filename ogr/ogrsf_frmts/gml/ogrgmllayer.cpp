@@ -35,6 +35,9 @@
 #include "ogr_p.h"
 #include "ogr_api.h"
 
+#include <memory>
+#include <vector>
+
 CPL_CVSID("$Id: ogrgmllayer.cpp 8e5eeb35bf76390e3134a4ea7076dab7d478ea0e 2018-11-14 22:55:13 +0100 Even Rouault $")
 
 /************************************************************************/
@@ -62,7 +65,9 @@ OGRGMLLayer::OGRGMLLayer( const char * pszName,
     // Must be in synced in OGR_G_CreateFromGML(), OGRGMLLayer::OGRGMLLayer()
     // and GMLReader::GMLReader().
     bFaceHoleNegative(CPLTestBool(
-        CPLGetConfigOption("GML_FACE_HOLE_NEGATIVE", "NO")))
+        CPLGetConfigOption("GML_FACE_HOLE_NEGATIVE", "NO"))),
+    m_iNextTranslated(0),
+    m_bTranslationEOF(false)
 {
     SetDescription(poFeatureDefn->GetName());
     poFeatureDefn->Reference();
@@ -76,12 +81,16 @@ OGRGMLLayer::OGRGMLLayer( const char * pszName,
 OGRGMLLayer::~OGRGMLLayer()
 
 {
+    DiscardTranslatedFeatures();
+
     CPLFree(pszFIDPrefix);
 
     if( poFeatureDefn )
         poFeatureDefn->Release();
 
     GML_BuildOGRGeometryFromList_DestroyCache(hCacheSRS);
+    for( size_t i = 0; i < m_ahWorkerSRSCache.size(); i++ )
+        GML_BuildOGRGeometryFromList_DestroyCache(m_ahWorkerSRSCache[i]);
 }
 
 /************************************************************************/
@@ -94,6 +103,8 @@ void OGRGMLLayer::ResetReading()
     if (bWriter)
         return;
 
+    DiscardTranslatedFeatures();
+
     if (poDS->GetReadMode() == INTERLEAVED_LAYERS ||
         poDS->GetReadMode() == SEQUENTIAL_LAYERS)
     {
@@ -132,435 +143,704 @@ static GIntBig Increment(GIntBig nVal)
 }
 
 /************************************************************************/
-/*                           GetNextFeature()                           */
+/*                             GetNextFID()                             */
 /************************************************************************/
 
-OGRFeature *OGRGMLLayer::GetNextFeature()
+/* -------------------------------------------------------------------- */
+/*      Extract the fid:                                                */
+/*      -Assumes the fids are non-negative integers with an optional    */
+/*       prefix                                                         */
+/*      -If a prefix differs from the prefix of the first feature from  */
+/*       the poDS then the fids from the poDS are ignored and are       */
+/*       assigned serially thereafter                                   */
+/* -------------------------------------------------------------------- */
+
+GIntBig OGRGMLLayer::GetNextFID( const char *pszGML_FID )
 
 {
-    if (bWriter)
+    GIntBig nFID = -1;
+    if( bInvalidFIDFound )
     {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "Cannot read features when writing a GML file");
-        return nullptr;
+        nFID = iNextGMLId;
+        iNextGMLId = Increment(iNextGMLId);
     }
-
-    if( poDS->GetLastReadLayer() != this )
+    else if( pszGML_FID == nullptr )
     {
-        if( poDS->GetReadMode() != INTERLEAVED_LAYERS )
-            ResetReading();
-        poDS->SetLastReadLayer(this);
+        bInvalidFIDFound = true;
+        nFID = iNextGMLId;
+        iNextGMLId = Increment(iNextGMLId);
     }
-
-/* ==================================================================== */
-/*      Loop till we find and translate a feature meeting all our       */
-/*      requirements.                                                   */
-/* ==================================================================== */
-    while( true )
+    else if( iNextGMLId == 0 )
     {
-        GMLFeature *poGMLFeature = poDS->PeekStoredGMLFeature();
-        if (poGMLFeature != nullptr)
+        int j = 0;
+        int i = static_cast<int>(strlen(pszGML_FID)) - 1;
+        while( i >= 0 && pszGML_FID[i] >= '0'
+                      && pszGML_FID[i] <= '9' && j < 20)
         {
-            poDS->SetStoredGMLFeature(nullptr);
+            i--;
+            j++;
         }
-        else
+        // i points the last character of the fid.
+        if( i >= 0 && j < 20 && pszFIDPrefix == nullptr)
         {
-            poGMLFeature = poDS->GetReader()->NextFeature();
-            if( poGMLFeature == nullptr )
-                return nullptr;
-
-            // We count reading low level GML features as a feature read for
-            // work checking purposes, though at least we didn't necessary
-            // have to turn it into an OGRFeature.
-            m_nFeaturesRead++;
+            pszFIDPrefix = static_cast<char *>(CPLMalloc(i + 2));
+            pszFIDPrefix[i + 1] = '\0';
+            strncpy(pszFIDPrefix, pszGML_FID, i + 1);
         }
-
-/* -------------------------------------------------------------------- */
-/*      Is it of the proper feature class?                              */
-/* -------------------------------------------------------------------- */
-
-        if( poGMLFeature->GetClass() != poFClass )
+        // pszFIDPrefix now contains the prefix or NULL if no prefix is
+        // found.
+        if( j < 20 && sscanf(pszGML_FID + i + 1, CPL_FRMT_GIB, &nFID) == 1)
         {
-            if( poDS->GetReadMode() == INTERLEAVED_LAYERS ||
-                (poDS->GetReadMode() == SEQUENTIAL_LAYERS && iNextGMLId != 0) )
-            {
-                CPLAssert(poDS->PeekStoredGMLFeature() == nullptr);
-                poDS->SetStoredGMLFeature(poGMLFeature);
-                return nullptr;
-            }
-            else
-            {
-                delete poGMLFeature;
-                continue;
-            }
+            if( iNextGMLId <= nFID )
+                iNextGMLId = Increment(nFID);
         }
-
-/* -------------------------------------------------------------------- */
-/*      Extract the fid:                                                */
-/*      -Assumes the fids are non-negative integers with an optional    */
-/*       prefix                                                         */
-/*      -If a prefix differs from the prefix of the first feature from  */
-/*       the poDS then the fids from the poDS are ignored and are       */
-/*       assigned serially thereafter                                   */
-/* -------------------------------------------------------------------- */
-        GIntBig nFID = -1;
-        const char *pszGML_FID = poGMLFeature->GetFID();
-        if( bInvalidFIDFound )
+        else
         {
+            bInvalidFIDFound = true;
             nFID = iNextGMLId;
             iNextGMLId = Increment(iNextGMLId);
         }
-        else if( pszGML_FID == nullptr )
+    }
+    else  // if( iNextGMLId != 0 ).
+    {
+        const char *pszFIDPrefix_notnull = pszFIDPrefix;
+        if (pszFIDPrefix_notnull == nullptr) pszFIDPrefix_notnull = "";
+        int nLenPrefix = static_cast<int>(strlen(pszFIDPrefix_notnull));
+
+        if( strncmp(pszGML_FID, pszFIDPrefix_notnull, nLenPrefix) == 0 &&
+            strlen(pszGML_FID + nLenPrefix) < 20 &&
+            sscanf(pszGML_FID + nLenPrefix, CPL_FRMT_GIB, &nFID) == 1 )
         {
+            // fid with the prefix. Using its numerical part.
+            if( iNextGMLId < nFID )
+                iNextGMLId = Increment(nFID);
+        }
+        else
+        {
+            // fid without the aforementioned prefix or a valid numerical
+            // part.
             bInvalidFIDFound = true;
             nFID = iNextGMLId;
             iNextGMLId = Increment(iNextGMLId);
         }
-        else if( iNextGMLId == 0 )
-        {
-            int j = 0;
-            int i = static_cast<int>(strlen(pszGML_FID)) - 1;
-            while( i >= 0 && pszGML_FID[i] >= '0'
-                          && pszGML_FID[i] <= '9' && j < 20)
-            {
-                i--;
-                j++;
-            }
-            // i points the last character of the fid.
-            if( i >= 0 && j < 20 && pszFIDPrefix == nullptr)
-            {
-                pszFIDPrefix = static_cast<char *>(CPLMalloc(i + 2));
-                pszFIDPrefix[i + 1] = '\0';
-                strncpy(pszFIDPrefix, pszGML_FID, i + 1);
-            }
-            // pszFIDPrefix now contains the prefix or NULL if no prefix is
-            // found.
-            if( j < 20 && sscanf(pszGML_FID + i + 1, CPL_FRMT_GIB, &nFID) == 1)
-            {
-                if( iNextGMLId <= nFID )
-                    iNextGMLId = Increment(nFID);
-            }
-            else
-            {
-                bInvalidFIDFound = true;
-                nFID = iNextGMLId;
-                iNextGMLId = Increment(iNextGMLId);
-            }
-        }
-        else  // if( iNextGMLId != 0 ).
-        {
-            const char *pszFIDPrefix_notnull = pszFIDPrefix;
-            if (pszFIDPrefix_notnull == nullptr) pszFIDPrefix_notnull = "";
-            int nLenPrefix = static_cast<int>(strlen(pszFIDPrefix_notnull));
+    }
 
-            if( strncmp(pszGML_FID, pszFIDPrefix_notnull, nLenPrefix) == 0 &&
-                strlen(pszGML_FID + nLenPrefix) < 20 &&
-                sscanf(pszGML_FID + nLenPrefix, CPL_FRMT_GIB, &nFID) == 1 )
-            {
-                // fid with the prefix. Using its numerical part.
-                if( iNextGMLId < nFID )
-                    iNextGMLId = Increment(nFID);
-            }
-            else
-            {
-                // fid without the aforementioned prefix or a valid numerical
-                // part.
-                bInvalidFIDFound = true;
-                nFID = iNextGMLId;
-                iNextGMLId = Increment(iNextGMLId);
-            }
-        }
+    return nFID;
+}
+
+/************************************************************************/
+/*                        TranslateGMLFeature()                         */
+/************************************************************************/
+
+/* Builds the OGR feature of a GML feature, which remains owned by the */
+/* caller. When bApplySpatialFilter is false, only read-only members of the */
+/* layer are used, so that this can be called from worker threads with a */
+/* SRS cache of their own. Returns nullptr if eStatus is not GMLTS_OK. */
+
+OGRFeature *OGRGMLLayer::TranslateGMLFeature( GMLFeature *poGMLFeature,
+                                              GIntBig nFID,
+                                              const char *pszSRSName,
+                                              void *hSRSCache,
+                                              bool bApplySpatialFilter,
+                                              OGRGMLTranslationStatus &eStatus,
+                                              CPLString &osErrorMsg )
+
+{
+    eStatus = GMLTS_OK;
+    const char *pszGML_FID = poGMLFeature->GetFID();
 
 /* -------------------------------------------------------------------- */
 /*      Does it satisfy the spatial query, if there is one?             */
 /* -------------------------------------------------------------------- */
+    OGRGeometry **papoGeometries = nullptr;
+    const CPLXMLNode *const *papsGeometry = poGMLFeature->GetGeometryList();
 
-        OGRGeometry **papoGeometries = nullptr;
-        const CPLXMLNode *const *papsGeometry = poGMLFeature->GetGeometryList();
-
-        OGRGeometry *poGeom = nullptr;
+    OGRGeometry *poGeom = nullptr;
 
-        if( poFeatureDefn->GetGeomFieldCount() > 1 )
+    if( poFeatureDefn->GetGeomFieldCount() > 1 )
+    {
+        papoGeometries = static_cast<OGRGeometry **>(CPLCalloc(
+            poFeatureDefn->GetGeomFieldCount(), sizeof(OGRGeometry *)));
+        for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
         {
-            papoGeometries = static_cast<OGRGeometry **>(CPLCalloc(
-                poFeatureDefn->GetGeomFieldCount(), sizeof(OGRGeometry *)));
-            const char *pszSRSName = poDS->GetGlobalSRSName();
-            for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
+            const CPLXMLNode *psGeom = poGMLFeature->GetGeometryRef(i);
+            if( psGeom != nullptr )
             {
-                const CPLXMLNode *psGeom = poGMLFeature->GetGeometryRef(i);
-                if( psGeom != nullptr )
+                const CPLXMLNode *myGeometryList[2] = {psGeom, nullptr};
+                poGeom = GML_BuildOGRGeometryFromList(
+                    myGeometryList, true,
+                    poDS->GetInvertAxisOrderIfLatLong(), pszSRSName,
+                    poDS->GetConsiderEPSGAsURN(),
+                    poDS->GetSwapCoordinates(),
+                    poDS->GetSecondaryGeometryOption(), hSRSCache,
+                    bFaceHoleNegative);
+
+                // Do geometry type changes if needed to match layer
+                // geometry type.
+                if (poGeom != nullptr)
                 {
-                    const CPLXMLNode *myGeometryList[2] = {psGeom, nullptr};
-                    poGeom = GML_BuildOGRGeometryFromList(
-                        myGeometryList, true,
-                        poDS->GetInvertAxisOrderIfLatLong(), pszSRSName,
-                        poDS->GetConsiderEPSGAsURN(),
-                        poDS->GetSwapCoordinates(),
-                        poDS->GetSecondaryGeometryOption(), hCacheSRS,
-                        bFaceHoleNegative);
-
-                    // Do geometry type changes if needed to match layer
-                    // geometry type.
-                    if (poGeom != nullptr)
-                    {
-                        papoGeometries[i] = OGRGeometryFactory::forceTo(
-                            poGeom,
-                            poFeatureDefn->GetGeomFieldDefn(i)->GetType());
-                        poGeom = nullptr;
-                    }
-                    else
+                    papoGeometries[i] = OGRGeometryFactory::forceTo(
+                        poGeom,
+                        poFeatureDefn->GetGeomFieldDefn(i)->GetType());
+                    poGeom = nullptr;
+                }
+                else
+                {
+                    // We assume the createFromGML() function would have
+                    // already reported the error.
+                    for(int j = 0; j < poFeatureDefn->GetGeomFieldCount();
+                        j++)
                     {
-                        // We assume the createFromGML() function would have
-                        // already reported the error.
-                        for(int j = 0; j < poFeatureDefn->GetGeomFieldCount();
-                            j++)
-                        {
-                            delete papoGeometries[j];
-                        }
-                        CPLFree(papoGeometries);
-                        delete poGMLFeature;
-                        return nullptr;
+                        delete papoGeometries[j];
                     }
+                    CPLFree(papoGeometries);
+                    eStatus = GMLTS_FATAL_GEOMETRY_ERROR;
+                    return nullptr;
                 }
             }
+        }
 
-            if( m_poFilterGeom != nullptr &&
-                m_iGeomFieldFilter >= 0 &&
-                m_iGeomFieldFilter < poFeatureDefn->GetGeomFieldCount() &&
-                papoGeometries[m_iGeomFieldFilter] &&
-                !FilterGeometry( papoGeometries[m_iGeomFieldFilter] ) )
+        if( bApplySpatialFilter && m_poFilterGeom != nullptr &&
+            m_iGeomFieldFilter >= 0 &&
+            m_iGeomFieldFilter < poFeatureDefn->GetGeomFieldCount() &&
+            papoGeometries[m_iGeomFieldFilter] &&
+            !FilterGeometry( papoGeometries[m_iGeomFieldFilter] ) )
+        {
+            for( int j = 0; j < poFeatureDefn->GetGeomFieldCount(); j++ )
             {
-                for( int j = 0; j < poFeatureDefn->GetGeomFieldCount(); j++ )
-                {
-                    delete papoGeometries[j];
-                }
-                CPLFree(papoGeometries);
-                delete poGMLFeature;
-                continue;
+                delete papoGeometries[j];
             }
+            CPLFree(papoGeometries);
+            eStatus = GMLTS_FILTERED;
+            return nullptr;
         }
-        else if (papsGeometry[0] != nullptr)
+    }
+    else if (papsGeometry[0] != nullptr)
+    {
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        poGeom = GML_BuildOGRGeometryFromList(
+            papsGeometry, true,
+            poDS->GetInvertAxisOrderIfLatLong(),
+            pszSRSName,
+            poDS->GetConsiderEPSGAsURN(),
+            poDS->GetSwapCoordinates(),
+            poDS->GetSecondaryGeometryOption(),
+            hSRSCache,
+            bFaceHoleNegative);
+        CPLPopErrorHandler();
+
+        // Do geometry type changes if needed to match layer geometry type.
+        if (poGeom != nullptr)
         {
-            const char *pszSRSName = poDS->GetGlobalSRSName();
-            CPLPushErrorHandler(CPLQuietErrorHandler);
-            poGeom = GML_BuildOGRGeometryFromList(
-                papsGeometry, true,
-                poDS->GetInvertAxisOrderIfLatLong(),
-                pszSRSName,
-                poDS->GetConsiderEPSGAsURN(),
-                poDS->GetSwapCoordinates(),
-                poDS->GetSecondaryGeometryOption(),
-                hCacheSRS,
-                bFaceHoleNegative);
-            CPLPopErrorHandler();
-
-            // Do geometry type changes if needed to match layer geometry type.
-            if (poGeom != nullptr)
-            {
-                poGeom = OGRGeometryFactory::forceTo(poGeom, GetGeomType());
-            }
-            else
-            {
-                const CPLString osLastErrorMsg(CPLGetLastErrorMsg());
-
-                const bool bGoOn = CPLTestBool(
-                    CPLGetConfigOption("GML_SKIP_CORRUPTED_FEATURES", "NO"));
-
-                CPLError(bGoOn ? CE_Warning : CE_Failure, CPLE_AppDefined,
-                         "Geometry of feature " CPL_FRMT_GIB
-                         " %scannot be parsed: %s%s",
-                         nFID, pszGML_FID ? CPLSPrintf("%s ", pszGML_FID) : "",
-                         osLastErrorMsg.c_str(),
-                         bGoOn ? ". Skipping to next feature.":
-                         ". You may set the GML_SKIP_CORRUPTED_FEATURES "
-                         "configuration option to YES to skip to the next "
-                         "feature");
-                delete poGMLFeature;
-                if( bGoOn )
-                    continue;
-                return nullptr;
-            }
+            poGeom = OGRGeometryFactory::forceTo(poGeom, GetGeomType());
+        }
+        else
+        {
+            osErrorMsg = CPLGetLastErrorMsg();
+            eStatus = GMLTS_GEOMETRY_ERROR;
+            return nullptr;
+        }
 
-            if( m_poFilterGeom != nullptr && !FilterGeometry(poGeom) )
-            {
-                delete poGMLFeature;
-                delete poGeom;
-                continue;
-            }
+        if( bApplySpatialFilter && m_poFilterGeom != nullptr &&
+            !FilterGeometry(poGeom) )
+        {
+            delete poGeom;
+            eStatus = GMLTS_FILTERED;
+            return nullptr;
         }
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Convert the whole feature into an OGRFeature.                   */
 /* -------------------------------------------------------------------- */
-        int iDstField = 0;
-        OGRFeature *poOGRFeature = new OGRFeature(poFeatureDefn);
+    int iDstField = 0;
+    OGRFeature *poOGRFeature = new OGRFeature(poFeatureDefn);
+
+    poOGRFeature->SetFID(nFID);
+    if (poDS->ExposeId())
+    {
+        if (pszGML_FID)
+            poOGRFeature->SetField(iDstField, pszGML_FID);
+        iDstField++;
+    }
+
+    const int nPropertyCount = poFClass->GetPropertyCount();
+    for( int iField = 0; iField < nPropertyCount; iField++, iDstField++ )
+    {
+        const GMLProperty *psGMLProperty =
+            poGMLFeature->GetProperty(iField);
+        if( psGMLProperty == nullptr || psGMLProperty->nSubProperties == 0 )
+            continue;
 
-        poOGRFeature->SetFID(nFID);
-        if (poDS->ExposeId())
+        if( EQUAL(psGMLProperty->papszSubProperties[0], OGR_GML_NULL) )
         {
-            if (pszGML_FID)
-                poOGRFeature->SetField(iDstField, pszGML_FID);
-            iDstField++;
+            poOGRFeature->SetFieldNull( iDstField );
+            continue;
         }
 
-        const int nPropertyCount = poFClass->GetPropertyCount();
-        for( int iField = 0; iField < nPropertyCount; iField++, iDstField++ )
+        switch( poFClass->GetProperty(iField)->GetType() )
         {
-            const GMLProperty *psGMLProperty =
-                poGMLFeature->GetProperty(iField);
-            if( psGMLProperty == nullptr || psGMLProperty->nSubProperties == 0 )
-                continue;
-
-            if( EQUAL(psGMLProperty->papszSubProperties[0], OGR_GML_NULL) )
-            {
-                poOGRFeature->SetFieldNull( iDstField );
-                continue;
-            }
-
-            switch( poFClass->GetProperty(iField)->GetType() )
-            {
-              case GMLPT_Real:
+          case GMLPT_Real:
+          {
+              poOGRFeature->SetField(
+                  iDstField, CPLAtof(psGMLProperty->papszSubProperties[0]));
+          }
+          break;
+
+          case GMLPT_IntegerList:
+          {
+              const int nCount = psGMLProperty->nSubProperties;
+              int *panIntList =
+                  static_cast<int *>(CPLMalloc(sizeof(int) * nCount));
+
+              for( int i = 0; i < nCount; i++ )
+                  panIntList[i] =
+                      atoi(psGMLProperty->papszSubProperties[i]);
+
+              poOGRFeature->SetField(iDstField, nCount, panIntList);
+              CPLFree(panIntList);
+          }
+          break;
+
+          case GMLPT_Integer64List:
+          {
+              const int nCount = psGMLProperty->nSubProperties;
+              GIntBig *panIntList = static_cast<GIntBig *>(
+                  CPLMalloc(sizeof(GIntBig) * nCount));
+
+              for( int i = 0; i < nCount; i++ )
+                  panIntList[i] =
+                      CPLAtoGIntBig(psGMLProperty->papszSubProperties[i]);
+
+              poOGRFeature->SetField(iDstField, nCount, panIntList);
+              CPLFree(panIntList);
+          }
+          break;
+
+          case GMLPT_RealList:
+          {
+              const int nCount = psGMLProperty->nSubProperties;
+              double *padfList = static_cast<double *>(
+                  CPLMalloc(sizeof(double) * nCount));
+
+              for( int i = 0; i < nCount; i++ )
+                  padfList[i] =
+                      CPLAtof(psGMLProperty->papszSubProperties[i]);
+
+              poOGRFeature->SetField(iDstField, nCount, padfList);
+              CPLFree(padfList);
+          }
+          break;
+
+          case GMLPT_StringList:
+          case GMLPT_FeaturePropertyList:
+          {
+              poOGRFeature->SetField(iDstField,
+                                     psGMLProperty->papszSubProperties);
+          }
+          break;
+
+          case GMLPT_Boolean:
+          {
+              if( strcmp(psGMLProperty->papszSubProperties[0],
+                         "true") == 0 ||
+                  strcmp(psGMLProperty->papszSubProperties[0], "1") == 0 )
+              {
+                  poOGRFeature->SetField(iDstField, 1);
+              }
+              else if( strcmp(psGMLProperty->papszSubProperties[0],
+                              "false") == 0 ||
+                       strcmp(psGMLProperty->papszSubProperties[0],
+                              "0") == 0 )
+              {
+                  poOGRFeature->SetField(iDstField, 0);
+              }
+              else
               {
                   poOGRFeature->SetField(
-                      iDstField, CPLAtof(psGMLProperty->papszSubProperties[0]));
+                      iDstField, psGMLProperty->papszSubProperties[0]);
               }
               break;
+          }
+
+          case GMLPT_BooleanList:
+          {
+              const int nCount = psGMLProperty->nSubProperties;
+              int *panIntList =
+                  static_cast<int *>(CPLMalloc(sizeof(int) * nCount));
 
-              case GMLPT_IntegerList:
+              for( int i = 0; i < nCount; i++ )
               {
-                  const int nCount = psGMLProperty->nSubProperties;
-                  int *panIntList =
-                      static_cast<int *>(CPLMalloc(sizeof(int) * nCount));
+                  panIntList[i] = (
+                      strcmp(psGMLProperty->papszSubProperties[i],
+                             "true") == 0 ||
+                      strcmp(psGMLProperty->papszSubProperties[i],
+                             "1") == 0 );
+              }
 
-                  for( int i = 0; i < nCount; i++ )
-                      panIntList[i] =
-                          atoi(psGMLProperty->papszSubProperties[i]);
+              poOGRFeature->SetField(iDstField, nCount, panIntList);
+              CPLFree(panIntList);
+              break;
+          }
 
-                  poOGRFeature->SetField(iDstField, nCount, panIntList);
-                  CPLFree(panIntList);
-              }
+          default:
+              poOGRFeature->SetField(iDstField,
+                                     psGMLProperty->papszSubProperties[0]);
               break;
+        }
+    }
 
-              case GMLPT_Integer64List:
-              {
-                  const int nCount = psGMLProperty->nSubProperties;
-                  GIntBig *panIntList = static_cast<GIntBig *>(
-                      CPLMalloc(sizeof(GIntBig) * nCount));
+    // Assign the geometry before the attribute filter because
+    // the attribute filter may use a special field like OGR_GEOMETRY.
+    if( papoGeometries != nullptr )
+    {
+        for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
+        {
+            poOGRFeature->SetGeomFieldDirectly(i, papoGeometries[i]);
+        }
+        CPLFree(papoGeometries);
+        papoGeometries = nullptr;
+    }
+    else
+    {
+        poOGRFeature->SetGeometryDirectly(poGeom);
+    }
 
-                  for( int i = 0; i < nCount; i++ )
-                      panIntList[i] =
-                          CPLAtoGIntBig(psGMLProperty->papszSubProperties[i]);
+    // Assign SRS.
+    for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
+    {
+        poGeom = poOGRFeature->GetGeomFieldRef(i);
+        if( poGeom != nullptr )
+        {
+            OGRSpatialReference *poSRS =
+                poFeatureDefn->GetGeomFieldDefn(i)->GetSpatialRef();
+            if (poSRS != nullptr)
+                poGeom->assignSpatialReference(poSRS);
+        }
+    }
 
-                  poOGRFeature->SetField(iDstField, nCount, panIntList);
-                  CPLFree(panIntList);
-              }
-              break;
+    return poOGRFeature;
+}
 
-              case GMLPT_RealList:
-              {
-                  const int nCount = psGMLProperty->nSubProperties;
-                  double *padfList = static_cast<double *>(
-                      CPLMalloc(sizeof(double) * nCount));
+/************************************************************************/
+/*                        ReportGeometryError()                         */
+/************************************************************************/
 
-                  for( int i = 0; i < nCount; i++ )
-                      padfList[i] =
-                          CPLAtof(psGMLProperty->papszSubProperties[i]);
+// Returns whether reading should go on with the next feature.
+static bool ReportGeometryError( GIntBig nFID, const char *pszGML_FID,
+                                 const char *pszErrorMsg )
+{
+    const bool bGoOn = CPLTestBool(
+        CPLGetConfigOption("GML_SKIP_CORRUPTED_FEATURES", "NO"));
+
+    CPLError(bGoOn ? CE_Warning : CE_Failure, CPLE_AppDefined,
+             "Geometry of feature " CPL_FRMT_GIB
+             " %scannot be parsed: %s%s",
+             nFID, pszGML_FID ? CPLSPrintf("%s ", pszGML_FID) : "",
+             pszErrorMsg,
+             bGoOn ? ". Skipping to next feature.":
+             ". You may set the GML_SKIP_CORRUPTED_FEATURES "
+             "configuration option to YES to skip to the next "
+             "feature");
+    return bGoOn;
+}
 
-                  poOGRFeature->SetField(iDstField, nCount, padfList);
-                  CPLFree(padfList);
-              }
-              break;
+/************************************************************************/
+/*                       TranslateJobThreadFunc()                       */
+/************************************************************************/
 
-              case GMLPT_StringList:
-              case GMLPT_FeaturePropertyList:
-              {
-                  poOGRFeature->SetField(iDstField,
-                                         psGMLProperty->papszSubProperties);
-              }
-              break;
+void OGRGMLLayer::TranslateJobThreadFunc( void *pData )
+{
+    OGRGMLTranslationJob *psJob = static_cast<OGRGMLTranslationJob *>(pData);
+    for( size_t i = 0; i < psJob->apoGMLFeatures.size(); i++ )
+    {
+        OGRGMLTranslatedFeature &sResult = psJob->asResults[i];
+        sResult.poFeature = psJob->poLayer->TranslateGMLFeature(
+            psJob->apoGMLFeatures[i], sResult.nFID,
+            psJob->bHasSRSName ? psJob->osSRSName.c_str() : nullptr,
+            psJob->hSRSCache, false, sResult.eStatus, sResult.osErrorMsg);
+        delete psJob->apoGMLFeatures[i];
+        psJob->apoGMLFeatures[i] = nullptr;
+    }
+}
 
-              case GMLPT_Boolean:
-              {
-                  if( strcmp(psGMLProperty->papszSubProperties[0],
-                             "true") == 0 ||
-                      strcmp(psGMLProperty->papszSubProperties[0], "1") == 0 )
-                  {
-                      poOGRFeature->SetField(iDstField, 1);
-                  }
-                  else if( strcmp(psGMLProperty->papszSubProperties[0],
-                                  "false") == 0 ||
-                           strcmp(psGMLProperty->papszSubProperties[0],
-                                  "0") == 0 )
-                  {
-                      poOGRFeature->SetField(iDstField, 0);
-                  }
-                  else
-                  {
-                      poOGRFeature->SetField(
-                          iDstField, psGMLProperty->papszSubProperties[0]);
-                  }
-                  break;
-              }
+/************************************************************************/
+/*                       TranslateNextFeatures()                        */
+/************************************************************************/
 
-              case GMLPT_BooleanList:
-              {
-                  const int nCount = psGMLProperty->nSubProperties;
-                  int *panIntList =
-                      static_cast<int *>(CPLMalloc(sizeof(int) * nCount));
-
-                  for( int i = 0; i < nCount; i++ )
-                  {
-                      panIntList[i] = (
-                          strcmp(psGMLProperty->papszSubProperties[i],
-                                 "true") == 0 ||
-                          strcmp(psGMLProperty->papszSubProperties[i],
-                                 "1") == 0 );
-                  }
-
-                  poOGRFeature->SetField(iDstField, nCount, panIntList);
-                  CPLFree(panIntList);
-                  break;
-              }
+// Collects the features translated by the jobs in flight into
+// m_asTranslated, then parses the next GML features and submits them to
+// the worker threads, so that their translation overlaps the parsing and
+// the consumption of the previous ones.
+// Returns false when all features have been read.
+
+constexpr int FEATURES_PER_TRANSLATION_JOB = 100;
+
+bool OGRGMLLayer::TranslateNextFeatures()
+{
+    m_asTranslated.clear();
+    m_iNextTranslated = 0;
+    if( !m_asTranslationJobs.empty() )
+    {
+        m_poTranslationQueue->WaitCompletion();
+        for( size_t i = 0; i < m_asTranslationJobs.size(); i++ )
+        {
+            m_asTranslated.insert(m_asTranslated.end(),
+                                  m_asTranslationJobs[i].asResults.begin(),
+                                  m_asTranslationJobs[i].asResults.end());
+        }
+        m_asTranslationJobs.clear();
+    }
+
+    if( m_bTranslationEOF )
+        return !m_asTranslated.empty();
+
+    const int nJobs = poDS->GetNumThreads();
+    if( m_poTranslationQueue == nullptr )
+    {
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nJobs);
+        if( poPool == nullptr )
+        {
+            m_bTranslationEOF = true;
+            return !m_asTranslated.empty();
+        }
+        m_poTranslationQueue = poPool->CreateJobQueue();
+    }
+    while( static_cast<int>(m_ahWorkerSRSCache.size()) < nJobs )
+    {
+        m_ahWorkerSRSCache.push_back(
+            GML_BuildOGRGeometryFromList_CreateCache());
+    }
 
-              default:
-                  poOGRFeature->SetField(iDstField,
-                                         psGMLProperty->papszSubProperties[0]);
-                  break;
+    // Must not be reallocated once jobs are submitted.
+    m_asTranslationJobs.resize(nJobs);
+    int iJob = 0;
+    for( ; iJob < nJobs && !m_bTranslationEOF; iJob++ )
+    {
+        OGRGMLTranslationJob &sJob = m_asTranslationJobs[iJob];
+        sJob.poLayer = this;
+        sJob.hSRSCache = m_ahWorkerSRSCache[iJob];
+        while( static_cast<int>(sJob.apoGMLFeatures.size()) <
+                                        FEATURES_PER_TRANSLATION_JOB )
+        {
+            GMLFeature *poGMLFeature = poDS->GetReader()->NextFeature();
+            if( poGMLFeature == nullptr )
+            {
+                m_bTranslationEOF = true;
+                break;
+            }
+            m_nFeaturesRead++;
+
+            if( poGMLFeature->GetClass() != poFClass )
+            {
+                delete poGMLFeature;
+                continue;
             }
+
+            OGRGMLTranslatedFeature sResult;
+            const char *pszGML_FID = poGMLFeature->GetFID();
+            sResult.bHasGMLFID = pszGML_FID != nullptr;
+            if( pszGML_FID )
+                sResult.osGMLFID = pszGML_FID;
+            sResult.nFID = GetNextFID(pszGML_FID);
+            sJob.asResults.push_back(sResult);
+            sJob.apoGMLFeatures.push_back(poGMLFeature);
         }
+        if( sJob.apoGMLFeatures.empty() )
+            break;
+
+        // The global SRS name may be set by the parser while the job runs.
+        const char *pszSRSName = poDS->GetGlobalSRSName();
+        sJob.bHasSRSName = pszSRSName != nullptr;
+        if( pszSRSName )
+            sJob.osSRSName = pszSRSName;
+        if( !m_poTranslationQueue->SubmitJob(TranslateJobThreadFunc, &sJob) )
+            TranslateJobThreadFunc(&sJob);
+    }
+    m_asTranslationJobs.resize(iJob);
 
-        delete poGMLFeature;
-        poGMLFeature = nullptr;
+    return !m_asTranslated.empty() || !m_asTranslationJobs.empty();
+}
 
-        // Assign the geometry before the attribute filter because
-        // the attribute filter may use a special field like OGR_GEOMETRY.
-        if( papoGeometries != nullptr )
+/************************************************************************/
+/*                     DiscardTranslatedFeatures()                      */
+/************************************************************************/
+
+void OGRGMLLayer::DiscardTranslatedFeatures()
+{
+    if( !m_asTranslationJobs.empty() )
+    {
+        m_poTranslationQueue->WaitCompletion();
+        for( size_t i = 0; i < m_asTranslationJobs.size(); i++ )
         {
-            for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
+            for( size_t j = 0;
+                 j < m_asTranslationJobs[i].asResults.size(); j++ )
             {
-                poOGRFeature->SetGeomFieldDirectly(i, papoGeometries[i]);
+                delete m_asTranslationJobs[i].asResults[j].poFeature;
             }
-            CPLFree(papoGeometries);
-            papoGeometries = nullptr;
+        }
+        m_asTranslationJobs.clear();
+    }
+    for( size_t i = m_iNextTranslated; i < m_asTranslated.size(); i++ )
+        delete m_asTranslated[i].poFeature;
+    m_asTranslated.clear();
+    m_iNextTranslated = 0;
+    m_bTranslationEOF = false;
+}
+
+/************************************************************************/
+/*                      GetNextTranslatedFeature()                      */
+/************************************************************************/
+
+// Multi-threaded variant of GetNextFeature(), for the STANDARD read mode
+// when the schema of the layer is known.
+
+OGRFeature *OGRGMLLayer::GetNextTranslatedFeature()
+
+{
+    while( true )
+    {
+        if( m_iNextTranslated == m_asTranslated.size() )
+        {
+            if( !TranslateNextFeatures() )
+                return nullptr;
+            continue;
+        }
+
+        OGRGMLTranslatedFeature &sResult = m_asTranslated[m_iNextTranslated++];
+        OGRFeature *poOGRFeature = sResult.poFeature;
+        sResult.poFeature = nullptr;
+        if( sResult.eStatus == GMLTS_GEOMETRY_ERROR )
+        {
+            if( ReportGeometryError(sResult.nFID,
+                                    sResult.bHasGMLFID ?
+                                        sResult.osGMLFID.c_str() : nullptr,
+                                    sResult.osErrorMsg) )
+                continue;
+            return nullptr;
+        }
+        if( poOGRFeature == nullptr )
+            return nullptr;
+
+        if( m_poFilterGeom != nullptr )
+        {
+            OGRGeometry *poGeom = nullptr;
+            if( poFeatureDefn->GetGeomFieldCount() > 1 )
+            {
+                if( m_iGeomFieldFilter >= 0 &&
+                    m_iGeomFieldFilter < poFeatureDefn->GetGeomFieldCount() )
+                {
+                    poGeom = poOGRFeature->GetGeomFieldRef(m_iGeomFieldFilter);
+                }
+            }
+            else
+            {
+                poGeom = poOGRFeature->GetGeometryRef();
+            }
+            if( poGeom != nullptr && !FilterGeometry(poGeom) )
+            {
+                delete poOGRFeature;
+                continue;
+            }
+        }
+
+        if( m_poAttrQuery != nullptr && !m_poAttrQuery->Evaluate(poOGRFeature) )
+        {
+            delete poOGRFeature;
+            continue;
+        }
+
+        return poOGRFeature;
+    }
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature *OGRGMLLayer::GetNextFeature()
+
+{
+    if (bWriter)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Cannot read features when writing a GML file");
+        return nullptr;
+    }
+
+    if( poDS->GetLastReadLayer() != this )
+    {
+        if( poDS->GetReadMode() != INTERLEAVED_LAYERS )
+            ResetReading();
+        poDS->SetLastReadLayer(this);
+    }
+
+    if( poDS->GetNumThreads() > 1 && poDS->GetReadMode() == STANDARD &&
+        poFClass != nullptr && poFClass->IsSchemaLocked() )
+    {
+        return GetNextTranslatedFeature();
+    }
+
+/* ==================================================================== */
+/*      Loop till we find and translate a feature meeting all our       */
+/*      requirements.                                                   */
+/* ==================================================================== */
+    while( true )
+    {
+        GMLFeature *poGMLFeature = poDS->PeekStoredGMLFeature();
+        if (poGMLFeature != nullptr)
+        {
+            poDS->SetStoredGMLFeature(nullptr);
         }
         else
         {
-            poOGRFeature->SetGeometryDirectly(poGeom);
+            poGMLFeature = poDS->GetReader()->NextFeature();
+            if( poGMLFeature == nullptr )
+                return nullptr;
+
+            // We count reading low level GML features as a feature read for
+            // work checking purposes, though at least we didn't necessary
+            // have to turn it into an OGRFeature.
+            m_nFeaturesRead++;
         }
 
-        // Assign SRS.
-        for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
+/* -------------------------------------------------------------------- */
+/*      Is it of the proper feature class?                              */
+/* -------------------------------------------------------------------- */
+
+        if( poGMLFeature->GetClass() != poFClass )
         {
-            poGeom = poOGRFeature->GetGeomFieldRef(i);
-            if( poGeom != nullptr )
+            if( poDS->GetReadMode() == INTERLEAVED_LAYERS ||
+                (poDS->GetReadMode() == SEQUENTIAL_LAYERS && iNextGMLId != 0) )
             {
-                OGRSpatialReference *poSRS =
-                    poFeatureDefn->GetGeomFieldDefn(i)->GetSpatialRef();
-                if (poSRS != nullptr)
-                    poGeom->assignSpatialReference(poSRS);
+                CPLAssert(poDS->PeekStoredGMLFeature() == nullptr);
+                poDS->SetStoredGMLFeature(poGMLFeature);
+                return nullptr;
+            }
+            else
+            {
+                delete poGMLFeature;
+                continue;
             }
         }
 
+        const char *pszGML_FID = poGMLFeature->GetFID();
+        const GIntBig nFID = GetNextFID(pszGML_FID);
+
+        OGRGMLTranslationStatus eStatus = GMLTS_OK;
+        CPLString osErrorMsg;
+        OGRFeature *poOGRFeature =
+            TranslateGMLFeature(poGMLFeature, nFID, poDS->GetGlobalSRSName(),
+                                hCacheSRS, true, eStatus, osErrorMsg);
+        bool bSkip = eStatus == GMLTS_FILTERED;
+        if( eStatus == GMLTS_GEOMETRY_ERROR )
+            bSkip = ReportGeometryError(nFID, pszGML_FID, osErrorMsg);
+        delete poGMLFeature;
+        if( bSkip )
+            continue;
+        if( poOGRFeature == nullptr )
+            return nullptr;
+
 /* -------------------------------------------------------------------- */
 /*      Test against the attribute query.                               */
 /* -------------------------------------------------------------------- */
@@ -344,6 +344,10 @@ class GMLASConfiguration
         /** Cache directory for cached XSD schemas. */
         CPLString       m_osXSDCacheDirectory;
 
+        /** Whether the result of schema analysis should be cached in the
+            XSD cache directory. */
+        bool            m_bCacheSchemaAnalysis;
+
         /** Whether to enable schema full checking. */
         bool            m_bSchemaFullChecking;
 
@@ -986,6 +990,14 @@ class GMLASSchemaAnalyzer
                      std::vector<PairURIFilename>& aoXSDs,
                      bool bSchemaFullChecking,
                      bool bHandleMultipleImports);
+
+        /** Restore the result of a previous Analyze() call saved with
+            SaveToCache(). Fails if the file is missing, or if one of the
+            local schemas has been modified since. */
+        bool LoadFromCache(const CPLString& osFilename,
+                           std::vector<PairURIFilename>& aoXSDs);
+        bool SaveToCache(const CPLString& osFilename,
+                         const std::vector<PairURIFilename>& aoXSDs) const;
         const std::vector<GMLASFeatureClass>& GetClasses() const
                 { return m_aoClasses; }
 
@@ -1094,6 +1106,12 @@ class OGRGMLASDataSource final: public GDALDataset
         static std::vector<PairURIFilename> BuildXSDVector(
                                             const CPLString& osXSDFilenames);
 
+        CPLString   GetSchemaAnalysisCacheFilename(
+                        const CPLString& osConfigFile,
+                        const std::vector<PairURIFilename>& aoXSDs,
+                        const std::map<CPLString,CPLString>& oMapDocNSURIToPrefix)
+                                                                        const;
+
         void        InitReaderWithFirstPassElements(GMLASReader* poReader);
 
     public:
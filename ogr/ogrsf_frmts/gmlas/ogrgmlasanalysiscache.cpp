@@ -0,0 +1,392 @@
+/******************************************************************************
+ * Project:  OGR
+ * Purpose:  OGRGMLASDriver implementation: cache of the result of the
+ *           schema analysis.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+// Must be first for DEBUG_BOOL case
+#include "ogr_gmlas.h"
+
+#include "cpl_minixml.h"
+
+CPL_CVSID("$Id$")
+
+// To be increased whenever the serialized content changes.
+static const char* const szANALYSIS_CACHE_VERSION = "1";
+
+/************************************************************************/
+/*                            Attribute helpers                         */
+/************************************************************************/
+
+static void AddAttr( CPLXMLNode* psNode, const char* pszName,
+                     const CPLString& osValue )
+{
+    if( !osValue.empty() )
+        CPLAddXMLAttributeAndValue(psNode, pszName, osValue);
+}
+
+static void AddAttr( CPLXMLNode* psNode, const char* pszName, int nValue )
+{
+    CPLAddXMLAttributeAndValue(psNode, pszName, CPLSPrintf("%d", nValue));
+}
+
+static void AddBoolAttr( CPLXMLNode* psNode, const char* pszName, bool bValue )
+{
+    if( bValue )
+        CPLAddXMLAttributeAndValue(psNode, pszName, "true");
+}
+
+static int GetIntAttr( const CPLXMLNode* psNode, const char* pszName,
+                       int nDefault )
+{
+    const char* pszValue = CPLGetXMLValue(psNode, pszName, nullptr);
+    return pszValue ? atoi(pszValue) : nDefault;
+}
+
+static bool GetBoolAttr( const CPLXMLNode* psNode, const char* pszName )
+{
+    return CPLTestBool(CPLGetXMLValue(psNode, pszName, "false"));
+}
+
+/************************************************************************/
+/*                          GetSchemaStamp()                            */
+/*                                                                      */
+/*      Size and modification time of a local schema. Remote schemas    */
+/*      are not checked, like in the XSD cache.                         */
+/************************************************************************/
+
+static bool GetSchemaStamp( const CPLString& osURL,
+                            GIntBig& nSize, GIntBig& nMTime )
+{
+    if( osURL.find("http://") == 0 || osURL.find("https://") == 0 )
+        return false;
+    VSIStatBufL sStat;
+    if( VSIStatL(osURL, &sStat) != 0 )
+        return false;
+    nSize = static_cast<GIntBig>(sStat.st_size);
+    nMTime = static_cast<GIntBig>(sStat.st_mtime);
+    return true;
+}
+
+/************************************************************************/
+/*                           SerializeField()                           */
+/************************************************************************/
+
+static CPLXMLNode* SerializeField( const GMLASField& oField )
+{
+    CPLXMLNode* psNode = CPLCreateXMLNode(nullptr, CXT_Element, "Field");
+    AddAttr(psNode, "name", oField.GetName());
+    AddAttr(psNode, "xpath", oField.GetXPath());
+    AddAttr(psNode, "type", static_cast<int>(oField.GetType()));
+    AddAttr(psNode, "typeName", oField.GetTypeName());
+    AddAttr(psNode, "geomType", static_cast<int>(oField.GetGeomType()));
+    AddAttr(psNode, "width", oField.GetWidth());
+    AddBoolAttr(psNode, "notNullable", oField.IsNotNullable());
+    AddBoolAttr(psNode, "array", oField.IsArray());
+    AddBoolAttr(psNode, "list", oField.IsList());
+    AddAttr(psNode, "category", static_cast<int>(oField.GetCategory()));
+    AddAttr(psNode, "fixedValue", oField.GetFixedValue());
+    AddAttr(psNode, "defaultValue", oField.GetDefaultValue());
+    AddAttr(psNode, "minOccurs", oField.GetMinOccurs());
+    AddAttr(psNode, "maxOccurs", oField.GetMaxOccurs());
+    AddBoolAttr(psNode, "repetitionOnSequence",
+                oField.GetRepetitionOnSequence());
+    AddBoolAttr(psNode, "includeThisEltInBlob",
+                oField.GetIncludeThisEltInBlob());
+    AddAttr(psNode, "abstractElementXPath", oField.GetAbstractElementXPath());
+    AddAttr(psNode, "relatedClassXPath", oField.GetRelatedClassXPath());
+    AddAttr(psNode, "junctionLayer", oField.GetJunctionLayer());
+    AddBoolAttr(psNode, "ignored", oField.IsIgnored());
+    AddBoolAttr(psNode, "mayAppearOutOfOrder", oField.MayAppearOutOfOrder());
+    for( const auto& osXPath: oField.GetAlternateXPaths() )
+        CPLCreateXMLElementAndValue(psNode, "AlternateXPath", osXPath);
+    if( !oField.GetDocumentation().empty() )
+        CPLCreateXMLElementAndValue(psNode, "Documentation",
+                                    oField.GetDocumentation());
+    return psNode;
+}
+
+/************************************************************************/
+/*                          DeserializeField()                          */
+/************************************************************************/
+
+static GMLASField DeserializeField( const CPLXMLNode* psNode )
+{
+    GMLASField oField;
+    oField.SetName(CPLGetXMLValue(psNode, "name", ""));
+    oField.SetXPath(CPLGetXMLValue(psNode, "xpath", ""));
+    oField.SetType(static_cast<GMLASFieldType>(
+                        GetIntAttr(psNode, "type", GMLAS_FT_STRING)),
+                   CPLGetXMLValue(psNode, "typeName", ""));
+    oField.SetGeomType(static_cast<OGRwkbGeometryType>(
+                        GetIntAttr(psNode, "geomType", wkbNone)));
+    oField.SetWidth(GetIntAttr(psNode, "width", 0));
+    oField.SetNotNullable(GetBoolAttr(psNode, "notNullable"));
+    oField.SetArray(GetBoolAttr(psNode, "array"));
+    oField.SetList(GetBoolAttr(psNode, "list"));
+    oField.SetCategory(static_cast<GMLASField::Category>(
+                        GetIntAttr(psNode, "category", GMLASField::REGULAR)));
+    oField.SetFixedValue(CPLGetXMLValue(psNode, "fixedValue", ""));
+    oField.SetDefaultValue(CPLGetXMLValue(psNode, "defaultValue", ""));
+    oField.SetMinOccurs(GetIntAttr(psNode, "minOccurs", -1));
+    oField.SetMaxOccurs(GetIntAttr(psNode, "maxOccurs", -1));
+    oField.SetRepetitionOnSequence(
+                        GetBoolAttr(psNode, "repetitionOnSequence"));
+    oField.SetIncludeThisEltInBlob(
+                        GetBoolAttr(psNode, "includeThisEltInBlob"));
+    oField.SetAbstractElementXPath(
+                        CPLGetXMLValue(psNode, "abstractElementXPath", ""));
+    oField.SetRelatedClassXPath(
+                        CPLGetXMLValue(psNode, "relatedClassXPath", ""));
+    oField.SetJunctionLayer(CPLGetXMLValue(psNode, "junctionLayer", ""));
+    if( GetBoolAttr(psNode, "ignored") )
+        oField.SetIgnored();
+    oField.SetMayAppearOutOfOrder(GetBoolAttr(psNode, "mayAppearOutOfOrder"));
+    for( const CPLXMLNode* psIter = psNode->psChild; psIter;
+                                                psIter = psIter->psNext )
+    {
+        if( psIter->eType == CXT_Element &&
+            strcmp(psIter->pszValue, "AlternateXPath") == 0 )
+        {
+            oField.AddAlternateXPath(CPLGetXMLValue(psIter, "", ""));
+        }
+    }
+    oField.SetDocumentation(CPLGetXMLValue(psNode, "Documentation", ""));
+    return oField;
+}
+
+/************************************************************************/
+/*                           SerializeClass()                           */
+/************************************************************************/
+
+static CPLXMLNode* SerializeClass( const GMLASFeatureClass& oClass )
+{
+    CPLXMLNode* psNode = CPLCreateXMLNode(nullptr, CXT_Element, "Class");
+    AddAttr(psNode, "name", oClass.GetName());
+    AddAttr(psNode, "xpath", oClass.GetXPath());
+    AddBoolAttr(psNode, "repeatedSequence", oClass.IsRepeatedSequence());
+    AddBoolAttr(psNode, "group", oClass.IsGroup());
+    AddAttr(psNode, "parentXPath", oClass.GetParentXPath());
+    AddAttr(psNode, "childXPath", oClass.GetChildXPath());
+    AddBoolAttr(psNode, "topLevelElt", oClass.IsTopLevelElt());
+    if( !oClass.GetDocumentation().empty() )
+        CPLCreateXMLElementAndValue(psNode, "Documentation",
+                                    oClass.GetDocumentation());
+    for( const auto& oField: oClass.GetFields() )
+        CPLAddXMLChild(psNode, SerializeField(oField));
+    for( const auto& oNestedClass: oClass.GetNestedClasses() )
+        CPLAddXMLChild(psNode, SerializeClass(oNestedClass));
+    return psNode;
+}
+
+/************************************************************************/
+/*                          DeserializeClass()                          */
+/************************************************************************/
+
+static GMLASFeatureClass DeserializeClass( const CPLXMLNode* psNode )
+{
+    GMLASFeatureClass oClass;
+    oClass.SetName(CPLGetXMLValue(psNode, "name", ""));
+    oClass.SetXPath(CPLGetXMLValue(psNode, "xpath", ""));
+    oClass.SetIsRepeatedSequence(GetBoolAttr(psNode, "repeatedSequence"));
+    oClass.SetIsGroup(GetBoolAttr(psNode, "group"));
+    oClass.SetParentXPath(CPLGetXMLValue(psNode, "parentXPath", ""));
+    oClass.SetChildXPath(CPLGetXMLValue(psNode, "childXPath", ""));
+    oClass.SetIsTopLevelElt(GetBoolAttr(psNode, "topLevelElt"));
+    oClass.SetDocumentation(CPLGetXMLValue(psNode, "Documentation", ""));
+    for( const CPLXMLNode* psIter = psNode->psChild; psIter;
+                                                psIter = psIter->psNext )
+    {
+        if( psIter->eType != CXT_Element )
+            continue;
+        if( strcmp(psIter->pszValue, "Field") == 0 )
+            oClass.AddField(DeserializeField(psIter));
+        else if( strcmp(psIter->pszValue, "Class") == 0 )
+            oClass.AddNestedClass(DeserializeClass(psIter));
+    }
+    return oClass;
+}
+
+/************************************************************************/
+/*                             SaveToCache()                            */
+/************************************************************************/
+
+bool GMLASSchemaAnalyzer::SaveToCache(
+                        const CPLString& osFilename,
+                        const std::vector<PairURIFilename>& aoXSDs) const
+{
+    CPLXMLNode* psRoot = CPLCreateXMLNode(nullptr, CXT_Element,
+                                          "GMLASSchemaAnalysis");
+    CPLAddXMLAttributeAndValue(psRoot, "version", szANALYSIS_CACHE_VERSION);
+    AddAttr(psRoot, "gmlVersion", m_osGMLVersionFound);
+
+    for( const auto& oXSD: aoXSDs )
+    {
+        CPLXMLNode* psXSD = CPLCreateXMLNode(psRoot, CXT_Element, "XSD");
+        AddAttr(psXSD, "uri", oXSD.first);
+        AddAttr(psXSD, "filename", oXSD.second);
+    }
+
+    for( const auto& oIter: m_oMapURIToPrefix )
+    {
+        CPLXMLNode* psNS = CPLCreateXMLNode(psRoot, CXT_Element, "Namespace");
+        AddAttr(psNS, "uri", oIter.first);
+        AddAttr(psNS, "prefix", oIter.second);
+    }
+
+    for( const auto& osURL: m_oSetSchemaURLs )
+    {
+        CPLXMLNode* psSchema = CPLCreateXMLNode(psRoot, CXT_Element, "Schema");
+        AddAttr(psSchema, "url", osURL);
+        GIntBig nSize = 0;
+        GIntBig nMTime = 0;
+        if( GetSchemaStamp(osURL, nSize, nMTime) )
+        {
+            CPLAddXMLAttributeAndValue(psSchema, "size",
+                                       CPLSPrintf(CPL_FRMT_GIB, nSize));
+            CPLAddXMLAttributeAndValue(psSchema, "mtime",
+                                       CPLSPrintf(CPL_FRMT_GIB, nMTime));
+        }
+    }
+
+    for( const auto& oClass: m_aoClasses )
+        CPLAddXMLChild(psRoot, SerializeClass(oClass));
+
+    // Write to a temporary file first, so that concurrent readers never see
+    // a partial file.
+    VSIMkdirRecursive(CPLGetPath(osFilename), 0755);
+    const CPLString osTmpFilename(osFilename + ".tmp");
+    bool bRet = CPL_TO_BOOL(CPLSerializeXMLTreeToFile(psRoot, osTmpFilename));
+    CPLDestroyXMLNode(psRoot);
+    if( bRet )
+        bRet = VSIRename(osTmpFilename, osFilename) == 0;
+    if( !bRet )
+    {
+        VSIUnlink(osTmpFilename);
+        CPLDebug("GMLAS", "Cannot write schema analysis cache %s",
+                 osFilename.c_str());
+    }
+    return bRet;
+}
+
+/************************************************************************/
+/*                            LoadFromCache()                           */
+/************************************************************************/
+
+bool GMLASSchemaAnalyzer::LoadFromCache(const CPLString& osFilename,
+                                        std::vector<PairURIFilename>& aoXSDs)
+{
+    VSIStatBufL sStat;
+    if( VSIStatL(osFilename, &sStat) != 0 )
+        return false;
+
+    CPLXMLNode* psRoot;
+    {
+        CPLErrorHandlerPusher oErrorHandler(CPLQuietErrorHandler);
+        psRoot = CPLParseXMLFile(osFilename);
+    }
+    if( psRoot == nullptr )
+        return false;
+    CPLXMLTreeCloser oCloser(psRoot);
+
+    const CPLXMLNode* psAnalysis = CPLGetXMLNode(psRoot,
+                                                 "=GMLASSchemaAnalysis");
+    if( psAnalysis == nullptr ||
+        strcmp(CPLGetXMLValue(psAnalysis, "version", ""),
+               szANALYSIS_CACHE_VERSION) != 0 )
+    {
+        return false;
+    }
+
+    std::vector<PairURIFilename> aoCachedXSDs;
+    std::map<CPLString, CPLString> oMapURIToPrefix;
+    std::set<CPLString> oSetSchemaURLs;
+    std::vector<GMLASFeatureClass> aoClasses;
+
+    for( const CPLXMLNode* psIter = psAnalysis->psChild; psIter;
+                                                psIter = psIter->psNext )
+    {
+        if( psIter->eType != CXT_Element )
+            continue;
+        if( strcmp(psIter->pszValue, "XSD") == 0 )
+        {
+            aoCachedXSDs.push_back(PairURIFilename(
+                CPLGetXMLValue(psIter, "uri", ""),
+                CPLGetXMLValue(psIter, "filename", "")));
+        }
+        else if( strcmp(psIter->pszValue, "Namespace") == 0 )
+        {
+            oMapURIToPrefix[CPLGetXMLValue(psIter, "uri", "")] =
+                CPLGetXMLValue(psIter, "prefix", "");
+        }
+        else if( strcmp(psIter->pszValue, "Schema") == 0 )
+        {
+            const CPLString osURL(CPLGetXMLValue(psIter, "url", ""));
+            const char* pszSize = CPLGetXMLValue(psIter, "size", nullptr);
+            const char* pszMTime = CPLGetXMLValue(psIter, "mtime", nullptr);
+            if( pszSize != nullptr && pszMTime != nullptr )
+            {
+                GIntBig nSize = 0;
+                GIntBig nMTime = 0;
+                if( !GetSchemaStamp(osURL, nSize, nMTime) ||
+                    nSize != CPLAtoGIntBig(pszSize) ||
+                    nMTime != CPLAtoGIntBig(pszMTime) )
+                {
+                    CPLDebug("GMLAS", "%s has changed since the analysis "
+                             "cached in %s", osURL.c_str(),
+                             osFilename.c_str());
+                    return false;
+                }
+            }
+            oSetSchemaURLs.insert(osURL);
+        }
+        else if( strcmp(psIter->pszValue, "Class") == 0 )
+        {
+            aoClasses.push_back(DeserializeClass(psIter));
+        }
+    }
+
+    if( aoCachedXSDs.size() != aoXSDs.size() || aoClasses.empty() )
+        return false;
+
+    CPLDebug("GMLAS", "Using schema analysis cached in %s",
+             osFilename.c_str());
+
+    aoXSDs = aoCachedXSDs;
+    m_osGMLVersionFound = CPLGetXMLValue(psAnalysis, "gmlVersion", "");
+    m_oMapURIToPrefix = oMapURIToPrefix;
+    m_oSetSchemaURLs = oSetSchemaURLs;
+    m_aoClasses = aoClasses;
+
+    // Same as done by Analyze() for the matchers used when reading.
+    m_oIgnoredXPathMatcher.SetDocumentMapURIToPrefix( m_oMapURIToPrefix );
+    m_oChildrenElementsConstraintsXPathMatcher.SetDocumentMapURIToPrefix(
+                                                        m_oMapURIToPrefix );
+    m_oForcedFlattenedXPathMatcher.SetDocumentMapURIToPrefix(
+                                                        m_oMapURIToPrefix );
+    m_oDisabledFlattenedXPathMatcher.SetDocumentMapURIToPrefix(
+                                                        m_oMapURIToPrefix );
+
+    return true;
+}
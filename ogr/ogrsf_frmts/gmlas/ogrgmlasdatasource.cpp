@@ -703,6 +703,61 @@ std::vector<PairURIFilename> OGRGMLASDataSource::BuildXSDVector(
     return aoXSDs;
 }
 
+/************************************************************************/
+/*                   GetSchemaAnalysisCacheFilename()                   */
+/*                                                                      */
+/*      The cached analysis is keyed on everything that can change its  */
+/*      result: the schemas, the configuration, the namespaces declared */
+/*      in the document and the GDAL version.                           */
+/************************************************************************/
+
+CPLString OGRGMLASDataSource::GetSchemaAnalysisCacheFilename(
+                const CPLString& osConfigFile,
+                const std::vector<PairURIFilename>& aoXSDs,
+                const std::map<CPLString,CPLString>& oMapDocNSURIToPrefix) const
+{
+    CPLString osKey(GDALVersionInfo("RELEASE_NAME"));
+    osKey += '\n';
+    osKey += CPLGetDirname(m_osGMLFilename);
+    osKey += '\n';
+    for( const auto& oXSD: aoXSDs )
+    {
+        osKey += oXSD.first + ' ' + oXSD.second + '\n';
+    }
+    for( const auto& oIter: oMapDocNSURIToPrefix )
+    {
+        osKey += oIter.first + ' ' + oIter.second + '\n';
+    }
+    osKey += m_bSchemaFullChecking ? "full_checking\n" : "\n";
+    osKey += m_bHandleMultipleImports ? "multiple_imports\n" : "\n";
+
+    CPL_SHA256Context ctxt;
+    CPL_SHA256Init(&ctxt);
+    CPL_SHA256Update(&ctxt, osKey.data(), osKey.size());
+    if( STARTS_WITH(osConfigFile, "<Configuration") )
+    {
+        CPL_SHA256Update(&ctxt, osConfigFile.data(), osConfigFile.size());
+    }
+    else if( !osConfigFile.empty() )
+    {
+        GByte* pabyConf = nullptr;
+        vsi_l_offset nConfSize = 0;
+        if( VSIIngestFile(nullptr, osConfigFile, &pabyConf, &nConfSize,
+                          10 * 1024 * 1024) )
+        {
+            CPL_SHA256Update(&ctxt, pabyConf, static_cast<size_t>(nConfSize));
+        }
+        CPLFree(pabyConf);
+    }
+
+    GByte abyHash[CPL_SHA256_HASH_SIZE];
+    CPL_SHA256Final(&ctxt, abyHash);
+    char* pszHash = CPLBinaryToHex(CPL_SHA256_HASH_SIZE / 2, abyHash);
+    const CPLString osBasename(CPLSPrintf("analysis_%s.xml", pszHash));
+    CPLFree(pszHash);
+    return CPLFormFilename(m_oConf.m_osXSDCacheDirectory, osBasename, nullptr);
+}
+
 /************************************************************************/
 /*                                Open()                                */
 /************************************************************************/
@@ -806,6 +861,7 @@ bool OGRGMLASDataSource::Open(GDALOpenInfo* poOpenInfo)
     }
 
     GMLASTopElementParser topElementParser;
+    std::map<CPLString, CPLString> oMapDocNSURIToPrefix;
     if( !m_osGMLFilename.empty() )
     {
         topElementParser.Parse(m_osGMLFilename, fpGML);
@@ -819,8 +875,8 @@ bool OGRGMLASDataSource::Open(GDALOpenInfo* poOpenInfo)
         {
             m_bFoundSWE = true;
         }
-        oAnalyzer.SetMapDocNSURIToPrefix(
-                                    topElementParser.GetMapDocNSURIToPrefix());
+        oMapDocNSURIToPrefix = topElementParser.GetMapDocNSURIToPrefix();
+        oAnalyzer.SetMapDocNSURIToPrefix(oMapDocNSURIToPrefix);
     }
     std::vector<PairURIFilename> aoXSDs;
     if( osXSDFilenames.empty() )
@@ -899,14 +955,29 @@ bool OGRGMLASDataSource::Open(GDALOpenInfo* poOpenInfo)
             szHANDLE_MULTIPLE_IMPORTS_OPTION,
             m_oConf.m_bHandleMultipleImports );
 
-    bool bRet = oAnalyzer.Analyze( m_oCache,
-                                   CPLGetDirname(m_osGMLFilename),
-                                   aoXSDs,
-                                   m_bSchemaFullChecking,
-                                   m_bHandleMultipleImports );
-    if( !bRet )
+    // Reuse the result of a previous analysis of the same schemas with the
+    // same configuration, if available.
+    CPLString osAnalysisCacheFilename;
+    if( m_oConf.m_bCacheSchemaAnalysis &&
+        !m_oConf.m_osXSDCacheDirectory.empty() )
     {
-        return false;
+        osAnalysisCacheFilename = GetSchemaAnalysisCacheFilename(
+                                osConfigFile, aoXSDs, oMapDocNSURIToPrefix);
+    }
+    if( osAnalysisCacheFilename.empty() || bRefreshCache ||
+        !oAnalyzer.LoadFromCache(osAnalysisCacheFilename, aoXSDs) )
+    {
+        bool bRet = oAnalyzer.Analyze( m_oCache,
+                                       CPLGetDirname(m_osGMLFilename),
+                                       aoXSDs,
+                                       m_bSchemaFullChecking,
+                                       m_bHandleMultipleImports );
+        if( !bRet )
+        {
+            return false;
+        }
+        if( !osAnalysisCacheFilename.empty() )
+            oAnalyzer.SaveToCache(osAnalysisCacheFilename, aoXSDs);
     }
 
     if( !osXSDFilenames.empty() )
@@ -29,10 +29,14 @@
 #include "ogr_geopackage.h"
 #include "memdataset.h"
 #include "gdal_alg_priv.h"
+#include "cpl_worker_thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
 
 CPL_CVSID("$Id: gdalgeopackagerasterband.cpp a694e230393890e77b19369b9bb71d99bd5c7ecc 2019-03-19 10:56:07 +0800 Chris Tapley $")
 
@@ -40,6 +44,69 @@ CPL_CVSID("$Id: gdalgeopackagerasterband.cpp a694e230393890e77b19369b9bb71d99bd5
 #define DEBUG_VERBOSE
 #endif
 
+/************************************************************************/
+/*                    Tile encoding in worker threads                   */
+/************************************************************************/
+
+struct GDALGPKGMBTilesEncodingJob
+{
+    GDALGPKGMBTilesEncodingQueue* psQueue = nullptr;
+    GDALDriver*         poDriver = nullptr;
+    GDALDataset*        poSrcDS = nullptr;     // owned MEM dataset
+    char**              papszOptions = nullptr;
+    int                 nRow = 0;
+    int                 nCol = 0;
+    GByte*              pabyBlob = nullptr;
+    vsi_l_offset        nBlobSize = 0;
+    CPLString           osError{};
+    bool                bDone = false;
+};
+
+// Tiles of a dataset are encoded by the global worker thread pool,
+// through a job queue of their own.
+struct GDALGPKGMBTilesEncodingQueue
+{
+    std::unique_ptr<CPLJobQueue> poJobQueue{};
+    std::mutex          oMutex{};
+    std::list<GDALGPKGMBTilesEncodingJob*> apsJobs{};
+};
+
+static void GDALGPKGMBTilesEncodeTile( void* pData )
+{
+    GDALGPKGMBTilesEncodingJob* psJob =
+        static_cast<GDALGPKGMBTilesEncodingJob*>(pData);
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    CPLErrorReset();
+    CPLString osMemFileName;
+    osMemFileName.Printf("/vsimem/gpkg_encode_tile_%p", psJob);
+    GDALDataset* poOutDS = psJob->poDriver->CreateCopy(
+        osMemFileName, psJob->poSrcDS, FALSE, psJob->papszOptions,
+        nullptr, nullptr);
+    if( poOutDS )
+    {
+        GDALClose( poOutDS );
+        psJob->pabyBlob =
+            VSIGetMemFileBuffer(osMemFileName, &psJob->nBlobSize, TRUE);
+    }
+    if( psJob->pabyBlob == nullptr )
+    {
+        psJob->osError = CPLGetLastErrorMsg();
+        if( psJob->osError.empty() )
+            psJob->osError = "Tile encoding failed";
+    }
+    VSIUnlink(osMemFileName);
+    CPLPopErrorHandler();
+
+    delete psJob->poSrcDS;
+    psJob->poSrcDS = nullptr;
+    CSLDestroy(psJob->papszOptions);
+    psJob->papszOptions = nullptr;
+
+    std::lock_guard<std::mutex> oLock(psJob->psQueue->oMutex);
+    psJob->bDone = true;
+}
+
 /************************************************************************/
 /*                    GDALGPKGMBTilesLikePseudoDataset()                */
 /************************************************************************/
@@ -78,7 +145,10 @@ GDALGPKGMBTilesLikePseudoDataset::GDALGPKGMBTilesLikePseudoDataset() :
     m_nAge(0),
     m_nTileInsertionCount(0),
     m_poParentDS(nullptr),
-    m_bInWriteTile(false)
+    m_bInWriteTile(false),
+    m_nEncodingThreads(-1),
+    m_psEncodingQueue(nullptr),
+    m_hInsertTileStmt(nullptr)
 {
     for( int i = 0; i < 4; i++ )
     {
@@ -98,6 +168,20 @@ GDALGPKGMBTilesLikePseudoDataset::GDALGPKGMBTilesLikePseudoDataset() :
 
 GDALGPKGMBTilesLikePseudoDataset::~GDALGPKGMBTilesLikePseudoDataset()
 {
+    // Normally already done by FlushTiles(), but the database may be
+    // closed at this point, so just discard what remains.
+    if( m_psEncodingQueue != nullptr )
+    {
+        m_psEncodingQueue->poJobQueue->WaitCompletion();
+        for( auto psJob: m_psEncodingQueue->apsJobs )
+        {
+            CPLFree(psJob->pabyBlob);
+            delete psJob;
+        }
+        delete m_psEncodingQueue;
+    }
+    if( m_hInsertTileStmt != nullptr )
+        sqlite3_finalize(m_hInsertTileStmt);
     if( m_poParentDS == nullptr && m_hTempDB != nullptr )
     {
         sqlite3_close(m_hTempDB);
@@ -169,6 +253,192 @@ CPLErr GDALGPKGMBTilesLikeRasterBand::FlushCache()
     return eErr;
 }
 
+/************************************************************************/
+/*                        SubmitTileEncoding()                          */
+/************************************************************************/
+
+// Encodes a copy of poMEMDS in a worker thread. The tile is inserted by
+// a later call to InsertEncodedTiles()
+CPLErr GDALGPKGMBTilesLikePseudoDataset::SubmitTileEncoding(
+    GDALDriver* poDriver, GDALDataset* poMEMDS, char** papszDriverOptions,
+    int nRow, int nCol )
+{
+    // poMEMDS points to m_pabyCachedTiles, which is going to be reused
+    GDALDataset* poSrcDS = MEMDataset::Create("",
+        poMEMDS->GetRasterXSize(), poMEMDS->GetRasterYSize(),
+        poMEMDS->GetRasterCount(),
+        poMEMDS->GetRasterBand(1)->GetRasterDataType(), nullptr);
+    if( poSrcDS == nullptr ||
+        GDALDatasetCopyWholeRaster(poMEMDS, poSrcDS, nullptr,
+                                   nullptr, nullptr) != CE_None )
+    {
+        delete poSrcDS;
+        return CE_Failure;
+    }
+    GDALColorTable* poCT = poMEMDS->GetRasterBand(1)->GetColorTable();
+    if( poCT != nullptr )
+        poSrcDS->GetRasterBand(1)->SetColorTable(poCT);
+
+    GDALGPKGMBTilesEncodingJob* psJob = new GDALGPKGMBTilesEncodingJob();
+    psJob->psQueue = m_psEncodingQueue;
+    psJob->poDriver = poDriver;
+    psJob->poSrcDS = poSrcDS;
+    psJob->papszOptions = CSLDuplicate(papszDriverOptions);
+    psJob->nRow = nRow;
+    psJob->nCol = nCol;
+    {
+        std::lock_guard<std::mutex> oLock(m_psEncodingQueue->oMutex);
+        m_psEncodingQueue->apsJobs.push_back(psJob);
+    }
+    if( !m_psEncodingQueue->poJobQueue->SubmitJob(GDALGPKGMBTilesEncodeTile,
+                                                  psJob) )
+    {
+        GDALGPKGMBTilesEncodeTile(psJob);
+    }
+
+    // Bound the number of tiles in flight
+    return InsertEncodedTiles(false);
+}
+
+/************************************************************************/
+/*                        InsertEncodedTiles()                          */
+/************************************************************************/
+
+// Inserts, in submission order, the tiles whose encoding is finished,
+// or all of them if bWaitAll is set.
+CPLErr GDALGPKGMBTilesLikePseudoDataset::InsertEncodedTiles(bool bWaitAll)
+{
+    if( m_psEncodingQueue == nullptr )
+        return CE_None;
+
+    CPLErr eErr = CE_None;
+    const size_t nMaxPending = 2 * static_cast<size_t>(m_nEncodingThreads);
+    while( true )
+    {
+        GDALGPKGMBTilesEncodingJob* psJob = nullptr;
+        {
+            std::unique_lock<std::mutex> oLock(m_psEncodingQueue->oMutex);
+            auto& apsJobs = m_psEncodingQueue->apsJobs;
+            if( apsJobs.empty() )
+                break;
+            psJob = apsJobs.front();
+            if( !psJob->bDone )
+            {
+                if( !bWaitAll && apsJobs.size() <= nMaxPending )
+                    break;
+                // Waiting on the job queue, instead of a condition, runs
+                // queued jobs meanwhile when called from a worker thread
+                while( !psJob->bDone )
+                {
+                    int nLater = 0;
+                    for( const auto* psOther: apsJobs )
+                    {
+                        if( psOther != psJob && !psOther->bDone )
+                            nLater++;
+                    }
+                    oLock.unlock();
+                    m_psEncodingQueue->poJobQueue->WaitCompletion(nLater);
+                    oLock.lock();
+                }
+            }
+            apsJobs.pop_front();
+        }
+
+        if( psJob->pabyBlob == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "%s",
+                     psJob->osError.c_str());
+            eErr = CE_Failure;
+        }
+        else if( InsertTile(psJob->nRow, psJob->nCol, psJob->pabyBlob,
+                            static_cast<size_t>(psJob->nBlobSize))
+                    != CE_None )
+        {
+            eErr = CE_Failure;
+        }
+        delete psJob;
+    }
+    return eErr;
+}
+
+/************************************************************************/
+/*                            InsertTile()                              */
+/************************************************************************/
+
+// Inserts an encoded tile, whose buffer ownership is taken.
+CPLErr GDALGPKGMBTilesLikePseudoDataset::InsertTile(int nRow, int nCol,
+                                                    GByte* pabyBlob,
+                                                    size_t nBlobSize)
+{
+    /* Create or commit and recreate transaction */
+    GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
+    if( poMainDS->m_nTileInsertionCount < 0 )
+    {
+        CPLFree(pabyBlob);
+        return CE_Failure;
+    }
+    if( poMainDS->m_nTileInsertionCount == 0 )
+    {
+        poMainDS->IStartTransaction();
+    }
+    else if( poMainDS->m_nTileInsertionCount == 1000 )
+    {
+        if( poMainDS->ICommitTransaction() != OGRERR_NONE )
+        {
+            poMainDS->m_nTileInsertionCount = -1;
+            CPLFree(pabyBlob);
+            return CE_Failure;
+        }
+        poMainDS->IStartTransaction();
+        poMainDS->m_nTileInsertionCount = 0;
+    }
+    poMainDS->m_nTileInsertionCount ++;
+
+    // Prepared once, and finalized by FlushTiles()
+    if( m_hInsertTileStmt == nullptr )
+    {
+        char* pszSQL = sqlite3_mprintf("INSERT OR REPLACE INTO \"%w\" "
+            "(zoom_level, tile_row, tile_column, tile_data) VALUES (?, ?, ?, ?)",
+            m_osRasterTable.c_str());
+        int rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &m_hInsertTileStmt,
+                                    nullptr);
+        if ( rc != SQLITE_OK )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "failed to prepare SQL %s: %s",
+                      pszSQL, sqlite3_errmsg(IGetDB()) );
+            sqlite3_finalize(m_hInsertTileStmt);
+            m_hInsertTileStmt = nullptr;
+            sqlite3_free(pszSQL);
+            CPLFree(pabyBlob);
+            return CE_Failure;
+        }
+        sqlite3_free(pszSQL);
+    }
+
+#ifdef DEBUG_VERBOSE
+    CPLDebug("GPKG", "Inserting tile (row=%d,col=%d) at zoom_level=%d",
+             GetRowFromIntoTopConvention(nRow), nCol, m_nZoomLevel);
+#endif
+    CPLErr eErr = CE_None;
+    sqlite3_bind_int( m_hInsertTileStmt, 1, m_nZoomLevel );
+    sqlite3_bind_int( m_hInsertTileStmt, 2, GetRowFromIntoTopConvention(nRow) );
+    sqlite3_bind_int( m_hInsertTileStmt, 3, nCol );
+    sqlite3_bind_blob( m_hInsertTileStmt, 4, pabyBlob, (int)nBlobSize, CPLFree);
+    int rc = sqlite3_step( m_hInsertTileStmt );
+    if( rc != SQLITE_DONE )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Failure when inserting tile (row=%d,col=%d) at zoom_level=%d : %s",
+                 GetRowFromIntoTopConvention(nRow), nCol, m_nZoomLevel, sqlite3_errmsg(IGetDB()));
+        eErr = CE_Failure;
+    }
+    // Releases the blob
+    sqlite3_reset( m_hInsertTileStmt );
+    sqlite3_clear_bindings( m_hInsertTileStmt );
+    return eErr;
+}
+
 /************************************************************************/
 /*                              FlushTiles()                            */
 /************************************************************************/
@@ -192,6 +462,14 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::FlushTiles()
         }
     }
 
+    if( InsertEncodedTiles(true) != CE_None )
+        eErr = CE_Failure;
+    if( m_hInsertTileStmt != nullptr )
+    {
+        sqlite3_finalize(m_hInsertTileStmt);
+        m_hInsertTileStmt = nullptr;
+    }
+
     if( poMainDS->m_nTileInsertionCount > 0 )
     {
         if( poMainDS->ICommitTransaction() != OGRERR_NONE )
@@ -875,6 +1153,9 @@ void GDALGPKGMBTilesLikePseudoDataset::GetTileOffsetAndScale(
 GByte* GDALGPKGMBTilesLikePseudoDataset::ReadTile( int nRow, int nCol, GByte *pabyData,
                                         bool *pbIsLossyFormat)
 {
+    // Tiles being encoded must be visible
+    InsertEncodedTiles(true);
+
     int nBlockXSize = 0;
     int nBlockYSize = 0;
     IGetRasterBand(1)->GetBlockSize(&nBlockXSize, &nBlockYSize);
@@ -1258,6 +1539,8 @@ static bool WEBPSupports4Bands()
 
 GIntBig GDALGPKGMBTilesLikePseudoDataset::GetTileId(int nRow, int nCol)
 {
+    InsertEncodedTiles(true);
+
     char* pszSQL = sqlite3_mprintf(
             "SELECT id FROM \"%w\" WHERE zoom_level = %d AND "
             "tile_row = %d AND tile_column = %d",
@@ -1274,6 +1557,8 @@ GIntBig GDALGPKGMBTilesLikePseudoDataset::GetTileId(int nRow, int nCol)
 
 bool GDALGPKGMBTilesLikePseudoDataset::DeleteTile(int nRow, int nCol)
 {
+    InsertEncodedTiles(true);
+
     char* pszSQL = sqlite3_mprintf("DELETE FROM \"%w\" "
         "WHERE zoom_level = %d AND tile_row = %d AND "
         "tile_column = %d",
@@ -2192,6 +2477,33 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                     CPLSPrintf("%d", nBlockYSize));
             }
         }
+        // Encode in a worker thread, except elevation tiles, whose
+        // ancillary record requires the tile id right away.
+        if( m_nEncodingThreads < 0 )
+        {
+            m_nEncodingThreads = CPLGetNumThreads();
+        }
+        if( m_nEncodingThreads > 1 && m_psEncodingQueue == nullptr )
+        {
+            CPLWorkerThreadPool* poPool =
+                CPLGetGlobalWorkerThreadPool(m_nEncodingThreads);
+            if( poPool != nullptr )
+            {
+                m_psEncodingQueue = new GDALGPKGMBTilesEncodingQueue();
+                m_psEncodingQueue->poJobQueue = poPool->CreateJobQueue();
+            }
+        }
+        if( m_psEncodingQueue != nullptr &&
+            m_eTF != GPKG_TF_PNG_16BIT && m_eTF != GPKG_TF_TIFF_32BIT_FLOAT )
+        {
+            eErr = SubmitTileEncoding(l_poDriver, poMEMDS, papszDriverOptions,
+                                      nRow, nCol);
+            CSLDestroy( papszDriverOptions );
+            CPLFree(pTempTileBuffer);
+            delete poMEMDS;
+            return eErr;
+        }
+
 #ifdef DEBUG
         VSIStatBufL sStat;
         CPLAssert(VSIStatL(osMemFileName, &sStat) != 0);
@@ -2208,57 +2520,15 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             GByte* pabyBlob =
                 VSIGetMemFileBuffer(osMemFileName, &nBlobSize, TRUE);
 
-            /* Create or commit and recreate transaction */
             GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
-            if( poMainDS->m_nTileInsertionCount == 0 )
-            {
-                poMainDS->IStartTransaction();
-            }
-            else if( poMainDS->m_nTileInsertionCount == 1000 )
-            {
-                if( poMainDS->ICommitTransaction() != OGRERR_NONE )
-                {
-                    poMainDS->m_nTileInsertionCount = -1;
-                    CPLFree(pabyBlob);
-                    VSIUnlink(osMemFileName);
-                    delete poMEMDS;
-                    return CE_Failure;
-                }
-                poMainDS->IStartTransaction();
-                poMainDS->m_nTileInsertionCount = 0;
-            }
-            poMainDS->m_nTileInsertionCount ++;
-
-            char* pszSQL = sqlite3_mprintf("INSERT OR REPLACE INTO \"%w\" "
-                "(zoom_level, tile_row, tile_column, tile_data) VALUES (%d, %d, %d, ?)",
-                m_osRasterTable.c_str(), m_nZoomLevel, GetRowFromIntoTopConvention(nRow), nCol);
-#ifdef DEBUG_VERBOSE
-            CPLDebug("GPKG", "%s", pszSQL);
-#endif
-            sqlite3_stmt* hStmt = nullptr;
-            int rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &hStmt, nullptr);
-            if ( rc != SQLITE_OK )
-            {
-                CPLError( CE_Failure, CPLE_AppDefined,
-                          "failed to prepare SQL %s: %s",
-                          pszSQL, sqlite3_errmsg(IGetDB()) );
-                CPLFree(pabyBlob);
-            }
-            else
+            eErr = InsertTile(nRow, nCol, pabyBlob,
+                              static_cast<size_t>(nBlobSize));
+            if( poMainDS->m_nTileInsertionCount < 0 )
             {
-                sqlite3_bind_blob( hStmt, 1, pabyBlob, (int)nBlobSize, CPLFree);
-                rc = sqlite3_step( hStmt );
-                if( rc == SQLITE_DONE )
-                    eErr = CE_None;
-                else
-                {
-                    CPLError(CE_Failure, CPLE_AppDefined,
-                             "Failure when inserting tile (row=%d,col=%d) at zoom_level=%d : %s",
-                             GetRowFromIntoTopConvention(nRow), nCol, m_nZoomLevel, sqlite3_errmsg(IGetDB()));
-                }
+                VSIUnlink(osMemFileName);
+                delete poMEMDS;
+                return CE_Failure;
             }
-            sqlite3_finalize(hStmt);
-            sqlite3_free(pszSQL);
 
             if( m_eTF == GPKG_TF_PNG_16BIT ||
                 m_eTF == GPKG_TF_TIFF_32BIT_FLOAT )
@@ -2270,7 +2540,7 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                 {
                     DeleteFromGriddedTileAncillary(nTileId);
 
-                    pszSQL = sqlite3_mprintf(
+                    char* pszSQL = sqlite3_mprintf(
                         "INSERT INTO gpkg_2d_gridded_tile_ancillary "
                         "(tpudt_name, tpudt_id, scale, offset, min, max, "
                         "mean, std_dev) VALUES "
@@ -2279,8 +2549,8 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
 #ifdef DEBUG_VERBOSE
                     CPLDebug("GPKG", "%s", pszSQL);
 #endif
-                    hStmt = nullptr;
-                    rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &hStmt, nullptr);
+                    sqlite3_stmt* hStmt = nullptr;
+                    int rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &hStmt, nullptr);
                     if ( rc != SQLITE_OK )
                     {
                         eErr = CE_Failure;
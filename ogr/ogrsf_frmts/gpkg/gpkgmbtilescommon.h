@@ -55,6 +55,8 @@ typedef enum
 
 GPKGTileFormat GDALGPKGMBTilesGetTileFormat(const char* pszTF );
 
+struct GDALGPKGMBTilesEncodingQueue;
+
 class GDALGPKGMBTilesLikePseudoDataset
 {
     friend class GDALGPKGMBTilesLikeRasterBand;
@@ -107,6 +109,18 @@ class GDALGPKGMBTilesLikePseudoDataset
   private:
         bool                    m_bInWriteTile;
         CPLErr                  WriteTileInternal(); /* should only be called by WriteTile() */
+
+        // Tiles encoded by worker threads, inserted in submission order
+        int                     m_nEncodingThreads;
+        GDALGPKGMBTilesEncodingQueue* m_psEncodingQueue;
+        sqlite3_stmt           *m_hInsertTileStmt;
+        CPLErr                  SubmitTileEncoding(GDALDriver* poDriver,
+                                                   GDALDataset* poMEMDS,
+                                                   char** papszDriverOptions,
+                                                   int nRow, int nCol);
+        CPLErr                  InsertEncodedTiles(bool bWaitAll);
+        CPLErr                  InsertTile(int nRow, int nCol,
+                                           GByte* pabyBlob, size_t nBlobSize);
         GIntBig                 GetTileId(int nRow, int nCol);
         bool                    DeleteTile(int nRow, int nCol);
         bool                    DeleteFromGriddedTileAncillary(GIntBig nTileId);
@@ -34,7 +34,9 @@
 #include "ogr_sqlite.h"
 #include "gpkgmbtilescommon.h"
 #include "ogrsqliteutility.h"
+#include "cpl_worker_thread_pool.h"
 
+#include <memory>
 #include <vector>
 #include <set>
 
@@ -88,6 +90,7 @@ typedef struct
 /************************************************************************/
 
 class OGRGeoPackageTableLayer;
+class OGRArrowArrayBuilder;
 
 class GDALGeoPackageDataset final : public OGRSQLiteBaseDataSource, public GDALGPKGMBTilesLikePseudoDataset
 {
@@ -112,6 +115,7 @@ class GDALGeoPackageDataset final : public OGRSQLiteBaseDataSource, public GDALG
     bool                m_bGridCellEncodingAsCO = false;
     bool                m_bHasReadMetadataFromStorage;
     bool                m_bMetadataDirty;
+    int                 m_nNumThreads = 1;
     char              **m_papszSubDatasets;
     char               *m_pszProjection;
     bool                m_bRecordInsertedInGPKGContent;
@@ -252,6 +256,7 @@ class GDALGeoPackageDataset final : public OGRSQLiteBaseDataSource, public GDALG
                                              int, int *, GDALProgressFunc, void * ) override;
 
         virtual int         GetLayerCount() override { return m_nLayers; }
+        int                 GetNumThreads() const { return m_nNumThreads; }
         int                 Open( GDALOpenInfo* poOpenInfo );
         int                 Create( const char * pszFilename,
                                     int nXSize,
@@ -369,14 +374,31 @@ class OGRGeoPackageLayer : public OGRLayer, public IOGRSQLiteGetSpatialWhere
     int                 iFIDCol;
     int                 iGeomCol;
     int                *panFieldOrdinals;
+    bool                m_bDeferGeometryParsing;
+
+    // Batch of features whose geometries are decoded by several threads,
+    // when the NUM_THREADS open option is greater than 1.
+    int                 m_nNumThreads = 0;
+    std::unique_ptr<CPLJobQueue> m_poJobQueue{};
+    std::vector<OGRFeature*> m_apoBatchFeatures{};
+    size_t              m_nBatchIdx = 0;
+    bool                m_bBatchEOF = false;
 
     void                ClearStatement();
+    void                ClearBatch();
+    bool                ReadBatch();
+    int                 GetNumThreads();
     virtual OGRErr      ResetStatement() = 0;
 
     void                BuildFeatureDefn( const char *pszLayerName,
                                            sqlite3_stmt *hStmt );
 
     OGRFeature*         TranslateFeature(sqlite3_stmt* hStmt);
+    void                TranslateFeature(sqlite3_stmt* hStmt,
+                                         OGRFeature* poFeature);
+    void                TranslateArrowRow(OGRArrowArrayBuilder& oBuilder,
+                                          sqlite3_stmt* hStmt,
+                                          int iFIDAsRegularColumnIndex);
 
   public:
 
@@ -386,6 +408,7 @@ class OGRGeoPackageLayer : public OGRLayer, public IOGRSQLiteGetSpatialWhere
     /* OGR API methods */
 
     OGRFeature*         GetNextFeature() override;
+    bool                GetNextFeatureInto( OGRFeature* poFeature ) override;
     const char*         GetFIDColumn() override;
     void                ResetReading() override;
     int                 TestCapability( const char * ) override;
@@ -463,6 +486,9 @@ class OGRGeoPackageTableLayer final : public OGRGeoPackageLayer
 
     bool                DoSpecialProcessingForColumnCreation(OGRFieldDefn* poField);
 
+    virtual int         GetNextArrowArray(struct ArrowArrayStream*,
+                                          struct ArrowArray* out_array) override;
+
     public:
                         OGRGeoPackageTableLayer( GDALGeoPackageDataset *poDS,
                                                  const char * pszTableName );
@@ -494,6 +520,7 @@ class OGRGeoPackageTableLayer final : public OGRGeoPackageLayer
     OGRErr              SetAttributeFilter( const char *pszQuery ) override;
     OGRErr              SyncToDisk() override;
     OGRFeature*         GetNextFeature() override;
+    bool                GetNextFeatureInto( OGRFeature* poFeature ) override;
     OGRFeature*         GetFeature(GIntBig nFID) override;
     OGRErr              StartTransaction() override;
     OGRErr              CommitTransaction() override;
@@ -611,6 +638,8 @@ class OGRGeoPackageSelectLayer final : public OGRGeoPackageLayer, public IOGRSQL
     virtual void        ResetReading() override;
 
     virtual OGRFeature *GetNextFeature() override;
+    virtual bool        GetNextFeatureInto( OGRFeature* poFeature ) override
+                            { return OGRLayer::GetNextFeatureInto(poFeature); }
     virtual GIntBig     GetFeatureCount( int ) override;
 
     virtual void        SetSpatialFilter( OGRGeometry * poGeom ) override { SetSpatialFilter(0, poGeom); }
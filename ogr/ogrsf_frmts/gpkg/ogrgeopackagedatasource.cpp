@@ -940,6 +940,8 @@ int GDALGeoPackageDataset::Open( GDALOpenInfo* poOpenInfo )
     SetDescription( poOpenInfo->pszFilename );
     CPLString osFilename( poOpenInfo->pszFilename );
     CPLString osSubdatasetTableName;
+
+    m_nNumThreads = CPLGetNumThreads(poOpenInfo->papszOpenOptions);
     GByte abyHeaderLetMeHerePlease[100];
     const GByte* pabyHeader = poOpenInfo->pabyHeader;
     if( STARTS_WITH_CI(poOpenInfo->pszFilename, "GPKG:") )
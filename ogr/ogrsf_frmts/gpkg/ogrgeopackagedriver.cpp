@@ -300,6 +300,15 @@ void RegisterOGRGeoPackage()
 
     poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "GeoPackage" );
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "gpkg" );
+    // "SQLite format 3"
+#ifdef ENABLE_SQL_GPKG_FORMAT
+    poDriver->SetMetadataItem( GDAL_DMD_SIGNATURES,
+                               "53514C69746520666F726D61742033 "
+                               "2D2D2053514C2047504B47" );
+#else
+    poDriver->SetMetadataItem( GDAL_DMD_SIGNATURES,
+                               "53514C69746520666F726D61742033" );
+#endif
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drv_geopackage.html" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES, "Byte Int16 UInt16 Float32" );
 
@@ -332,6 +341,7 @@ void RegisterOGRGeoPackage()
 "  <Option name='MAXY' type='float' description='Maximum Y of area of interest'/>"
 "  <Option name='USE_TILE_EXTENT' type='boolean' description='Use tile extent of content to determine area of interest' default='NO'/>"
 "  <Option name='WHERE' type='string' description='SQL WHERE clause to be appended to tile requests'/>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads to use to decode geometries when reading vector layers. Integer value or ALL_CPUS' default='GDAL_NUM_THREADS config option or 1'/>"
 COMPRESSION_OPTIONS
 "</OpenOptionList>");
 
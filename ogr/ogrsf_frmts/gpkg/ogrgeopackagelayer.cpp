@@ -30,8 +30,12 @@
 #include "ogr_geopackage.h"
 #include "ogrgeopackageutility.h"
 #include "ogrsqliteutility.h"
+#include "ogrlayerarrow.h"
 #include "ogr_p.h"
 
+#include <algorithm>
+#include <functional>
+
 CPL_CVSID("$Id: ogrgeopackagelayer.cpp 6c78501419a048320fea4e6bc86ac3c97bc54450 2018-07-24 19:46:03 +0200 Even Rouault $")
 
 /************************************************************************/
@@ -47,7 +51,9 @@ OGRGeoPackageLayer::OGRGeoPackageLayer(GDALGeoPackageDataset *poDS) :
     m_pszFidColumn(nullptr),
     iFIDCol(-1),
     iGeomCol(-1),
-    panFieldOrdinals(nullptr)
+    panFieldOrdinals(nullptr),
+    m_bDeferGeometryParsing(CPLTestBool(
+        CPLGetConfigOption("OGR_GPKG_DEFER_GEOMETRY_PARSING", "YES")))
 {}
 
 /************************************************************************/
@@ -56,6 +62,7 @@ OGRGeoPackageLayer::OGRGeoPackageLayer(GDALGeoPackageDataset *poDS) :
 
 OGRGeoPackageLayer::~OGRGeoPackageLayer()
 {
+    ClearBatch();
 
     CPLFree( m_pszFidColumn );
 
@@ -92,6 +99,193 @@ void OGRGeoPackageLayer::ClearStatement()
         sqlite3_finalize( m_poQueryStatement );
         m_poQueryStatement = nullptr;
     }
+    ClearBatch();
+}
+
+/************************************************************************/
+/*                             ClearBatch()                             */
+/************************************************************************/
+
+void OGRGeoPackageLayer::ClearBatch()
+
+{
+    for( size_t i = m_nBatchIdx; i < m_apoBatchFeatures.size(); i++ )
+        delete m_apoBatchFeatures[i];
+    m_apoBatchFeatures.clear();
+    m_nBatchIdx = 0;
+    m_bBatchEOF = false;
+}
+
+/************************************************************************/
+/*                           GetNumThreads()                            */
+/************************************************************************/
+
+int OGRGeoPackageLayer::GetNumThreads()
+
+{
+    if( m_nNumThreads == 0 )
+    {
+        m_nNumThreads = 1;
+        const int nNumThreads = m_poDS->GetNumThreads();
+        if( nNumThreads > 1 )
+        {
+            CPLWorkerThreadPool* poPool =
+                CPLGetGlobalWorkerThreadPool(nNumThreads - 1);
+            if( poPool != nullptr )
+            {
+                m_poJobQueue = poPool->CreateJobQueue();
+                m_nNumThreads = nNumThreads;
+            }
+        }
+    }
+    return m_nNumThreads;
+}
+
+/************************************************************************/
+/*                         OGRGPKGDecodingJob                           */
+/************************************************************************/
+
+namespace {
+
+struct OGRGPKGDecodingJobError
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+};
+
+struct OGRGPKGDecodingJob
+{
+    std::vector<OGRFeature*>* papoFeatures = nullptr;
+    size_t                    nStart = 0;
+    size_t                    nEnd = 0;
+    std::vector<OGRGPKGDecodingJobError> aoErrors{};
+};
+
+} // namespace
+
+static void CPL_STDCALL OGRGPKGDecodingJobErrorHandler(
+    CPLErr eErrClass, CPLErrorNum nErrNo, const char* pszMsg )
+{
+    OGRGPKGDecodingJob* psJob =
+        static_cast<OGRGPKGDecodingJob*>(CPLGetErrorHandlerUserData());
+    psJob->aoErrors.push_back(
+        OGRGPKGDecodingJobError{eErrClass, nErrNo, pszMsg});
+}
+
+static void OGRGPKGDecodingJobThreadFunc( void* pData )
+{
+    OGRGPKGDecodingJob* psJob = static_cast<OGRGPKGDecodingJob*>(pData);
+    // Errors are re-emitted by the calling thread.
+    CPLPushErrorHandlerEx(OGRGPKGDecodingJobErrorHandler, psJob);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+    for( size_t i = psJob->nStart; i < psJob->nEnd; i++ )
+    {
+        // Resolves the WKB stored by TranslateFeature()
+        (*psJob->papoFeatures)[i]->GetGeometryRef();
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                             ReadBatch()                              */
+/*                                                                      */
+/*      Fetch the next rows of the statement and decode their           */
+/*      geometries with m_nNumThreads threads. The rows are still       */
+/*      fetched by the calling thread, as the sqlite3 connection        */
+/*      cannot be shared, but the WKB decoding is what dominates the    */
+/*      cost of a full scan.                                            */
+/************************************************************************/
+
+bool OGRGeoPackageLayer::ReadBatch()
+
+{
+    m_apoBatchFeatures.clear();
+    m_nBatchIdx = 0;
+    if( m_bBatchEOF )
+    {
+        // Same as the single threaded case: the next call will restart
+        // the iteration.
+        m_bBatchEOF = false;
+        return false;
+    }
+
+    if( m_poQueryStatement == nullptr )
+    {
+        ResetStatement();
+        if (m_poQueryStatement == nullptr)
+            return false;
+    }
+
+    std::vector<OGRFeature*> apoFeatures;
+    const size_t nMaxFeatures = static_cast<size_t>(m_nNumThreads) * 1000;
+    const bool bDeferGeometryParsingBackup = m_bDeferGeometryParsing;
+    m_bDeferGeometryParsing = true;
+    bool bEOF = false;
+    while( apoFeatures.size() < nMaxFeatures )
+    {
+        if( bDoStep )
+        {
+            int rc = sqlite3_step( m_poQueryStatement );
+            if( rc != SQLITE_ROW )
+            {
+                if ( rc != SQLITE_DONE )
+                {
+                    sqlite3_reset(m_poQueryStatement);
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                            "In GetNextRawFeature(): sqlite3_step() : %s",
+                            sqlite3_errmsg(m_poDS->GetDB()) );
+                }
+
+                ClearStatement();
+                bEOF = true;
+                break;
+            }
+        }
+        else
+        {
+            bDoStep = true;
+        }
+
+        OGRFeature *poFeature = new OGRFeature( m_poFeatureDefn );
+        TranslateFeature(m_poQueryStatement, poFeature);
+        apoFeatures.push_back(poFeature);
+    }
+    m_bDeferGeometryParsing = bDeferGeometryParsingBackup;
+    if( apoFeatures.empty() )
+        return false;
+
+    // The calling thread takes care of the first range.
+    const size_t nCount = apoFeatures.size();
+    std::vector<OGRGPKGDecodingJob> asJobs(m_nNumThreads);
+    for( int iJob = 0; iJob < m_nNumThreads; iJob++ )
+    {
+        asJobs[iJob].papoFeatures = &apoFeatures;
+        asJobs[iJob].nStart = nCount * iJob / m_nNumThreads;
+        asJobs[iJob].nEnd = nCount * (iJob + 1) / m_nNumThreads;
+    }
+    for( int iJob = 1; iJob < m_nNumThreads; iJob++ )
+    {
+        if( !m_poJobQueue->SubmitJob(OGRGPKGDecodingJobThreadFunc,
+                                     &asJobs[iJob]) )
+            OGRGPKGDecodingJobThreadFunc(&asJobs[iJob]);
+    }
+    OGRGPKGDecodingJobThreadFunc(&asJobs[0]);
+    m_poJobQueue->WaitCompletion();
+
+    for( const auto& sJob: asJobs )
+    {
+        for( const auto& oError: sJob.aoErrors )
+        {
+            CPLError(oError.eErrClass, oError.nErrNo, "%s",
+                     oError.osMsg.c_str());
+        }
+    }
+
+    // Set after ClearStatement() which resets it.
+    m_apoBatchFeatures = std::move(apoFeatures);
+    m_bBatchEOF = bEOF;
+    return true;
 }
 
 /************************************************************************/
@@ -101,13 +295,51 @@ void OGRGeoPackageLayer::ClearStatement()
 OGRFeature *OGRGeoPackageLayer::GetNextFeature()
 
 {
+    if( GetNumThreads() > 1 )
+    {
+        // Features are returned in the order of the rows, and the filters
+        // are evaluated by the calling thread.
+        while( true )
+        {
+            if( m_nBatchIdx == m_apoBatchFeatures.size() && !ReadBatch() )
+                return nullptr;
+            OGRFeature* poFeature = m_apoBatchFeatures[m_nBatchIdx];
+            m_apoBatchFeatures[m_nBatchIdx] = nullptr;
+            m_nBatchIdx++;
+            if( (m_poFilterGeom == nullptr
+                || FilterGeometry( poFeature->GetGeomFieldRef(m_iGeomFieldFilter) ) )
+                && (m_poAttrQuery == nullptr
+                    || m_poAttrQuery->Evaluate( poFeature )) )
+                return poFeature;
+            delete poFeature;
+        }
+    }
+
+    OGRFeature *poFeature = new OGRFeature( m_poFeatureDefn );
+    if( OGRGeoPackageLayer::GetNextFeatureInto(poFeature) )
+        return poFeature;
+    delete poFeature;
+    return nullptr;
+}
+
+/************************************************************************/
+/*                         GetNextFeatureInto()                         */
+/************************************************************************/
+
+bool OGRGeoPackageLayer::GetNextFeatureInto( OGRFeature* poFeature )
+
+{
+    // Features are read by batches when several threads are used.
+    if( poFeature->GetDefnRef() != m_poFeatureDefn || GetNumThreads() > 1 )
+        return OGRLayer::GetNextFeatureInto(poFeature);
+
     for( ; true; )
     {
         if( m_poQueryStatement == nullptr )
         {
             ResetStatement();
             if (m_poQueryStatement == nullptr)
-                return nullptr;
+                return false;
         }
 
     /* -------------------------------------------------------------------- */
@@ -128,7 +360,7 @@ OGRFeature *OGRGeoPackageLayer::GetNextFeature()
 
                 ClearStatement();
 
-                return nullptr;
+                return false;
             }
         }
         else
@@ -136,18 +368,51 @@ OGRFeature *OGRGeoPackageLayer::GetNextFeature()
             bDoStep = true;
         }
 
-        OGRFeature *poFeature = TranslateFeature(m_poQueryStatement);
+        TranslateFeature(m_poQueryStatement, poFeature);
 
         if( (m_poFilterGeom == nullptr
             || FilterGeometry( poFeature->GetGeomFieldRef(m_iGeomFieldFilter) ) )
             && (m_poAttrQuery == nullptr
                 || m_poAttrQuery->Evaluate( poFeature )) )
-            return poFeature;
-
-        delete poFeature;
+            return true;
     }
 }
 
+/************************************************************************/
+/*                      GPkgGeometryToOGRInPlace()                      */
+/*                                                                      */
+/*      Import a GeoPackage geometry blob into an existing point or     */
+/*      line string of the same type, so that a recycled feature keeps  */
+/*      its geometry and coordinate buffer.                             */
+/************************************************************************/
+
+static bool GPkgGeometryToOGRInPlace( const GByte *pabyGpkg, size_t nGpkgLen,
+                                      OGRGeometry* poGeom )
+{
+    const OGRwkbGeometryType eGeomType = poGeom->getGeometryType();
+    if( wkbFlatten(eGeomType) != wkbPoint &&
+        wkbFlatten(eGeomType) != wkbLineString )
+        return false;
+
+    GPkgHeader oHeader;
+    if( GPkgHeaderFromWKB(pabyGpkg, nGpkgLen, &oHeader) != OGRERR_NONE ||
+        oHeader.nHeaderLen + 5 > nGpkgLen )
+        return false;
+
+    const GByte *pabyWkb = pabyGpkg + oHeader.nHeaderLen;
+    const size_t nWkbLen = nGpkgLen - oHeader.nHeaderLen;
+    OGRwkbGeometryType eWkbType = wkbUnknown;
+    if( OGRReadWKBGeometryType(pabyWkb, wkbVariantIso,
+                               &eWkbType) != OGRERR_NONE ||
+        eWkbType != eGeomType )
+        return false;
+
+    int nBytesConsumed = 0;
+    return poGeom->importFromWkb(pabyWkb, static_cast<int>(nWkbLen),
+                                 wkbVariantIso,
+                                 nBytesConsumed) == OGRERR_NONE;
+}
+
 /************************************************************************/
 /*                         TranslateFeature()                           */
 /************************************************************************/
@@ -155,11 +420,22 @@ OGRFeature *OGRGeoPackageLayer::GetNextFeature()
 OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
 
 {
-/* -------------------------------------------------------------------- */
-/*      Create a feature from the current result.                       */
-/* -------------------------------------------------------------------- */
     OGRFeature *poFeature = new OGRFeature( m_poFeatureDefn );
+    TranslateFeature( hStmt, poFeature );
+    return poFeature;
+}
+
+/************************************************************************/
+/*                         TranslateFeature()                           */
+/*                                                                      */
+/*      Fill a feature from the current result. The feature may be     */
+/*      recycled from a previous row, so every field is overwritten.    */
+/************************************************************************/
+
+void OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt,
+                                           OGRFeature* poFeature )
 
+{
 /* -------------------------------------------------------------------- */
 /*      Set FID if we have a column to set it from.                     */
 /* -------------------------------------------------------------------- */
@@ -192,19 +468,59 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
             int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomCol);
             // coverity[tainted_data_return]
             GByte *pabyGpkg = (GByte *)sqlite3_column_blob(hStmt, iGeomCol);
-            OGRGeometry *poGeom = GPkgGeometryToOGR(pabyGpkg, iGpkgSize, nullptr);
-            if ( poGeom == nullptr )
+            // Only reuse a geometry the caller has already parsed: a
+            // recycled feature may still hold the unparsed previous WKB.
+            OGRGeometry *poOldGeom =
+                poFeature->GetGeomFieldLazyWKB(0, nullptr) == nullptr ?
+                    poFeature->GetGeometryRef() : nullptr;
+            GPkgHeader oHeader;
+            if( poOldGeom != nullptr &&
+                GPkgGeometryToOGRInPlace(pabyGpkg, iGpkgSize, poOldGeom) )
+            {
+                poOldGeom->assignSpatialReference(poSrs);
+            }
+            else if( m_bDeferGeometryParsing &&
+                     GPkgHeaderFromWKB(pabyGpkg, iGpkgSize,
+                                       &oHeader) == OGRERR_NONE &&
+                     !oHeader.bEmpty && !oHeader.bExtended &&
+                     oHeader.nHeaderLen + 5 <=
+                                        static_cast<size_t>(iGpkgSize) )
             {
-                // Try also spatialite geometry blobs
-                if( OGRSQLiteLayer::ImportSpatiaLiteGeometry( pabyGpkg, iGpkgSize,
-                                                              &poGeom ) != OGRERR_NONE )
+                // Keep the WKB unparsed until the geometry is actually
+                // needed, with the envelope of the blob header if any.
+                OGREnvelope sEnvelope;
+                if( oHeader.bExtentHasXY )
                 {
-                    CPLError( CE_Failure, CPLE_AppDefined, "Unable to read geometry");
+                    sEnvelope.MinX = oHeader.MinX;
+                    sEnvelope.MaxX = oHeader.MaxX;
+                    sEnvelope.MinY = oHeader.MinY;
+                    sEnvelope.MaxY = oHeader.MaxY;
                 }
+                poFeature->SetGeomFieldLazyWKB(
+                    0, pabyGpkg + oHeader.nHeaderLen,
+                    iGpkgSize - oHeader.nHeaderLen,
+                    oHeader.bExtentHasXY ? &sEnvelope : nullptr);
             }
-            if( poGeom != nullptr )
-                poGeom->assignSpatialReference(poSrs);
-            poFeature->SetGeometryDirectly( poGeom );
+            else
+            {
+                OGRGeometry *poGeom = GPkgGeometryToOGR(pabyGpkg, iGpkgSize, nullptr);
+                if ( poGeom == nullptr )
+                {
+                    // Try also spatialite geometry blobs
+                    if( OGRSQLiteLayer::ImportSpatiaLiteGeometry( pabyGpkg, iGpkgSize,
+                                                                  &poGeom ) != OGRERR_NONE )
+                    {
+                        CPLError( CE_Failure, CPLE_AppDefined, "Unable to read geometry");
+                    }
+                }
+                if( poGeom != nullptr )
+                    poGeom->assignSpatialReference(poSrs);
+                poFeature->SetGeometryDirectly( poGeom );
+            }
+        }
+        else
+        {
+            poFeature->SetGeometryDirectly( nullptr );
         }
     }
 
@@ -215,7 +531,10 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
     {
         OGRFieldDefn *poFieldDefn = m_poFeatureDefn->GetFieldDefn( iField );
         if ( poFieldDefn->IsIgnored() )
+        {
+            poFeature->UnsetField( iField );
             continue;
+        }
 
         const int iRawField = panFieldOrdinals[iField];
 
@@ -259,6 +578,8 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
                 int nYear, nMonth, nDay;
                 if( sscanf(pszTxt, "%d-%d-%d", &nYear, &nMonth, &nDay) == 3 )
                     poFeature->SetField(iField, nYear, nMonth, nDay, 0, 0, 0, 0);
+                else
+                    poFeature->UnsetField(iField);
                 break;
             }
 
@@ -268,6 +589,8 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
                 OGRField sField;
                 if( OGRParseXMLDateTime(pszTxt, &sField) )
                     poFeature->SetField(iField, &sField);
+                else
+                    poFeature->UnsetField(iField);
                 break;
             }
 
@@ -277,11 +600,155 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
                 break;
 
             default:
+                poFeature->UnsetField( iField );
                 break;
         }
     }
+}
 
-    return poFeature;
+/************************************************************************/
+/*                         TranslateArrowRow()                          */
+/*                                                                      */
+/*      Same as TranslateFeature(), but append the current result to   */
+/*      a columnar batch, without building a feature. Geometries are    */
+/*      passed as the WKB embedded in the GeoPackage blob.              */
+/************************************************************************/
+
+void OGRGeoPackageLayer::TranslateArrowRow( OGRArrowArrayBuilder& oBuilder,
+                                            sqlite3_stmt* hStmt,
+                                            int iFIDAsRegularColumnIndex )
+
+{
+    GIntBig nFID = iNextShapeId;
+    if( iFIDCol >= 0 )
+    {
+        nFID = sqlite3_column_int64( hStmt, iFIDCol );
+        if( m_pszFidColumn == nullptr && nFID == 0 )
+        {
+            // Might be the case for views with joins.
+            nFID = iNextShapeId;
+        }
+    }
+    oBuilder.SetFID( nFID );
+    if( iFIDAsRegularColumnIndex >= 0 )
+        oBuilder.SetInteger64( iFIDAsRegularColumnIndex, nFID );
+
+    iNextShapeId++;
+
+    m_nFeaturesRead++;
+
+    if( iGeomCol >= 0 &&
+        sqlite3_column_type(hStmt, iGeomCol) != SQLITE_NULL &&
+        !m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
+    {
+        const int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomCol);
+        // coverity[tainted_data_return]
+        const GByte *pabyGpkg = static_cast<const GByte*>(
+            sqlite3_column_blob(hStmt, iGeomCol));
+        GPkgHeader oHeader;
+        if( pabyGpkg != nullptr &&
+            GPkgHeaderFromWKB(pabyGpkg, iGpkgSize, &oHeader) == OGRERR_NONE &&
+            oHeader.nHeaderLen < static_cast<size_t>(iGpkgSize) )
+        {
+            oBuilder.SetGeometryWKB( 0, pabyGpkg + oHeader.nHeaderLen,
+                                     iGpkgSize - oHeader.nHeaderLen );
+        }
+        else
+        {
+            // Try also spatialite geometry blobs
+            OGRGeometry *poGeom = nullptr;
+            if( OGRSQLiteLayer::ImportSpatiaLiteGeometry( pabyGpkg, iGpkgSize,
+                                                          &poGeom ) != OGRERR_NONE )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined, "Unable to read geometry");
+            }
+            oBuilder.SetGeometry( 0, poGeom );
+            delete poGeom;
+        }
+    }
+
+    for( int iField = 0; iField < m_poFeatureDefn->GetFieldCount(); iField++ )
+    {
+        OGRFieldDefn *poFieldDefn = m_poFeatureDefn->GetFieldDefn( iField );
+        if ( poFieldDefn->IsIgnored() || iField == iFIDAsRegularColumnIndex )
+            continue;
+
+        const int iRawField = panFieldOrdinals[iField];
+
+        if( sqlite3_column_type( hStmt, iRawField ) == SQLITE_NULL )
+            continue;
+
+        switch( poFieldDefn->GetType() )
+        {
+            case OFTInteger:
+                oBuilder.SetInteger( iField,
+                    sqlite3_column_int( hStmt, iRawField ) );
+                break;
+
+            case OFTInteger64:
+                oBuilder.SetInteger64( iField,
+                    sqlite3_column_int64( hStmt, iRawField ) );
+                break;
+
+            case OFTReal:
+                oBuilder.SetReal( iField,
+                    sqlite3_column_double( hStmt, iRawField ) );
+                break;
+
+            case OFTBinary:
+            {
+                const int nBytes = sqlite3_column_bytes( hStmt, iRawField );
+                // coverity[tainted_data_return]
+                const GByte* pabyData = reinterpret_cast<const GByte*>(
+                    sqlite3_column_blob( hStmt, iRawField ) );
+                oBuilder.SetBinary( iField, pabyData, nBytes );
+                break;
+            }
+
+            case OFTDate:
+            {
+                const char* pszTxt = reinterpret_cast<const char*>(
+                    sqlite3_column_text( hStmt, iRawField ) );
+                int nYear, nMonth, nDay;
+                if( sscanf(pszTxt, "%d-%d-%d", &nYear, &nMonth, &nDay) == 3 )
+                {
+                    OGRField sField;
+                    memset(&sField, 0, sizeof(sField));
+                    sField.Date.Year = static_cast<GInt16>(nYear);
+                    sField.Date.Month = static_cast<GByte>(nMonth);
+                    sField.Date.Day = static_cast<GByte>(nDay);
+                    oBuilder.SetField( iField, &sField );
+                }
+                break;
+            }
+
+            case OFTDateTime:
+            {
+                const char* pszTxt = reinterpret_cast<const char*>(
+                    sqlite3_column_text( hStmt, iRawField ) );
+                OGRField sField;
+                if( OGRParseXMLDateTime(pszTxt, &sField) )
+                    oBuilder.SetField( iField, &sField );
+                break;
+            }
+
+            case OFTString:
+            {
+                // sqlite3_column_bytes() must be called after
+                // sqlite3_column_text().
+                const char* pszTxt = reinterpret_cast<const char*>(
+                    sqlite3_column_text( hStmt, iRawField ) );
+                oBuilder.SetString( iField, pszTxt,
+                    sqlite3_column_bytes( hStmt, iRawField ) );
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    oBuilder.EndRow();
 }
 
 /************************************************************************/
@@ -30,9 +30,12 @@
 #include "ogr_geopackage.h"
 #include "ogrgeopackageutility.h"
 #include "ogrsqliteutility.h"
+#include "ogrlayerarrow.h"
 #include "cpl_time.h"
 #include "ogr_p.h"
 
+#include <algorithm>
+
 CPL_CVSID("$Id: ogrgeopackagetablelayer.cpp 087e15b179ac43ee1a0cff0f46d68a304848a6eb 2019-05-21 22:10:19 +0200 Even Rouault $")
 
 static const char UNSUPPORTED_OP_READ_ONLY[] =
@@ -176,7 +179,41 @@ bool OGRGeoPackageTableLayer::IsGeomFieldSet( OGRFeature *poFeature )
 {
     return
         poFeature->GetDefnRef()->GetGeomFieldCount() &&
-        poFeature->GetGeomFieldRef(0);
+        (poFeature->GetGeomFieldLazyWKB(0, nullptr) != nullptr ||
+         poFeature->GetGeomFieldRef(0));
+}
+
+//----------------------------------------------------------------------
+// GetLazyWKBPassThrough()
+//
+// Return the unparsed WKB of the geometry of a feature if it can be
+// written as such in a GeoPackage geometry blob: ISO WKB of a type that
+// needs no geometry extension, with an envelope unless it is a point.
+//
+static const GByte* GetLazyWKBPassThrough( OGRFeature* poFeature,
+                                           size_t* pnWKBSize,
+                                           const OGREnvelope** ppsEnvelope,
+                                           OGRwkbGeometryType* peType )
+{
+    const GByte* pabyWKB =
+        poFeature->GetGeomFieldLazyWKB(0, pnWKBSize, ppsEnvelope);
+    if( pabyWKB == nullptr || *pnWKBSize < 5 )
+        return nullptr;
+
+    // Reject the extended (2.5D, EWKB) type flags in the high byte.
+    const GByte byHighTypeByte =
+        pabyWKB[0] == wkbNDR ? pabyWKB[4] : pabyWKB[1];
+    if( byHighTypeByte != 0 ||
+        OGRReadWKBGeometryType(pabyWKB, wkbVariantIso,
+                               peType) != OGRERR_NONE )
+        return nullptr;
+
+    const OGRwkbGeometryType eFlatType = wkbFlatten(*peType);
+    if( eFlatType < wkbPoint || eFlatType > wkbMultiPolygon )
+        return nullptr;
+    if( eFlatType != wkbPoint && *ppsEnvelope == nullptr )
+        return nullptr;
+    return pabyWKB;
 }
 
 #define MY_CPLAssert CPLAssert
@@ -200,9 +237,28 @@ OGRErr OGRGeoPackageTableLayer::FeatureBindParameters( OGRFeature *poFeature,
     /* Bind data values to the statement, here bind the blob for geometry */
     if ( err == SQLITE_OK && poFeatureDefn->GetGeomFieldCount() )
     {
+        size_t nLazyWKBSize = 0;
+        const OGREnvelope* psLazyEnvelope = nullptr;
+        OGRwkbGeometryType eLazyType = wkbUnknown;
+        const GByte* pabyLazyWKB =
+            GetLazyWKBPassThrough(poFeature, &nLazyWKBSize,
+                                  &psLazyEnvelope, &eLazyType);
         // Non-NULL geometry.
-        OGRGeometry* poGeom = poFeature->GetGeomFieldRef(0);
-        if ( poGeom )
+        OGRGeometry* poGeom = pabyLazyWKB != nullptr ?
+                                    nullptr : poFeature->GetGeomFieldRef(0);
+        if( pabyLazyWKB )
+        {
+            // Copy the WKB read from another layer without parsing it.
+            size_t szWkb = 0;
+            GByte* pabyWkb = GPkgGeometryFromWKB(
+                pabyLazyWKB, nLazyWKBSize,
+                wkbFlatten(eLazyType) == wkbPoint ? nullptr : psLazyEnvelope,
+                m_iSrs, &szWkb);
+            err = sqlite3_bind_blob(poStmt, nColCount++, pabyWkb,
+                                    static_cast<int>(szWkb), CPLFree);
+            MY_CPLAssert( err == SQLITE_OK );
+        }
+        else if ( poGeom )
         {
             size_t szWkb = 0;
             GByte* pabyWkb = GPkgGeometryFromOGR(poGeom, m_iSrs, &szWkb);
@@ -1657,11 +1713,25 @@ void OGRGeoPackageTableLayer::CheckGeometryType( OGRFeature *poFeature )
     OGRwkbGeometryType eLayerGeomType = wkbFlatten(GetGeomType());
     if( eLayerGeomType != wkbNone && eLayerGeomType != wkbUnknown )
     {
-        OGRGeometry* poGeom = poFeature->GetGeometryRef();
-        if( poGeom != nullptr )
+        size_t nLazyWKBSize = 0;
+        const GByte* pabyLazyWKB =
+            poFeature->GetGeomFieldLazyWKB(0, &nLazyWKBSize);
+        OGRwkbGeometryType eGeomType = wkbNone;
+        if( pabyLazyWKB != nullptr )
         {
-            OGRwkbGeometryType eGeomType =
-                wkbFlatten(poGeom->getGeometryType());
+            if( OGRReadWKBGeometryType(pabyLazyWKB, wkbVariantIso,
+                                       &eGeomType) != OGRERR_NONE )
+                eGeomType = wkbNone;
+        }
+        else
+        {
+            OGRGeometry* poGeom = poFeature->GetGeometryRef();
+            if( poGeom != nullptr )
+                eGeomType = poGeom->getGeometryType();
+        }
+        if( eGeomType != wkbNone )
+        {
+            eGeomType = wkbFlatten(eGeomType);
             if( !OGR_GT_IsSubClassOf(eGeomType, eLayerGeomType) &&
                 m_eSetBadGeomTypeWarned.find(eGeomType) ==
                                         m_eSetBadGeomTypeWarned.end() )
@@ -1817,15 +1887,11 @@ OGRErr OGRGeoPackageTableLayer::ICreateFeature( OGRFeature *poFeature )
     }
 
     /* Update the layer extents with this new object */
-    if( IsGeomFieldSet(poFeature) )
+    OGREnvelope oEnv;
+    if( poFeature->GetDefnRef()->GetGeomFieldCount() &&
+        poFeature->GetGeomFieldEnvelope(0, &oEnv) )
     {
-        OGRGeometry* poGeom = poFeature->GetGeomFieldRef(0);
-        if( !poGeom->IsEmpty() )
-        {
-            OGREnvelope oEnv;
-            poGeom->getEnvelope(&oEnv);
-            UpdateExtent(&oEnv);
-        }
+        UpdateExtent(&oEnv);
     }
 
     /* Read the latest FID value */
@@ -1987,15 +2053,11 @@ OGRErr OGRGeoPackageTableLayer::ISetFeature( OGRFeature *poFeature )
     if (eErr == OGRERR_NONE)
     {
         /* Update the layer extents with this new object */
-        if( IsGeomFieldSet(poFeature) )
+        OGREnvelope oEnv;
+        if( poFeature->GetDefnRef()->GetGeomFieldCount() &&
+            poFeature->GetGeomFieldEnvelope(0, &oEnv) )
         {
-            OGRGeometry* poGeom = poFeature->GetGeomFieldRef(0);
-            if( !poGeom->IsEmpty() )
-            {
-                OGREnvelope oEnv;
-                poGeom->getEnvelope(&oEnv);
-                UpdateExtent(&oEnv);
-            }
+            UpdateExtent(&oEnv);
         }
 
         m_bContentChanged = true;
@@ -2155,6 +2217,112 @@ OGRFeature* OGRGeoPackageTableLayer::GetNextFeature()
     return poFeature;
 }
 
+/************************************************************************/
+/*                         GetNextFeatureInto()                         */
+/************************************************************************/
+
+bool OGRGeoPackageTableLayer::GetNextFeatureInto( OGRFeature* poFeature )
+{
+    if( !m_bFeatureDefnCompleted )
+        GetLayerDefn();
+    if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
+        return false;
+
+    CreateSpatialIndexIfNecessary();
+
+    if( !OGRGeoPackageLayer::GetNextFeatureInto(poFeature) )
+        return false;
+    if( m_iFIDAsRegularColumnIndex >= 0 )
+    {
+        poFeature->SetField(m_iFIDAsRegularColumnIndex, poFeature->GetFID());
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                         GetNextArrowArray()                          */
+/************************************************************************/
+
+int OGRGeoPackageTableLayer::GetNextArrowArray( struct ArrowArrayStream* stream,
+                                                struct ArrowArray* out_array )
+{
+    if( !m_bFeatureDefnCompleted )
+        GetLayerDefn();
+    if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
+    {
+        memset(out_array, 0, sizeof(*out_array));
+        return EIO;
+    }
+
+    CreateSpatialIndexIfNecessary();
+
+    // The RTree only preselects the features intersecting the envelope of
+    // the spatial filter, so let the generic implementation do the exact
+    // test. The attribute filter is already part of the SQL request.
+    if( m_poFilterGeom != nullptr || m_poAttrQuery != nullptr )
+        return OGRLayer::GetNextArrowArray(stream, out_array);
+
+    memset(out_array, 0, sizeof(*out_array));
+    CSLConstList papszOptions = m_aosArrowArrayStreamOptions.List();
+    const int nMaxBatchSize =
+        OGRArrowArrayBuilder::GetMaxFeaturesInBatch(papszOptions);
+    try
+    {
+        OGRArrowArrayBuilder oBuilder(
+            m_poFeatureDefn, OGRArrowArrayBuilder::IncludeFID(papszOptions));
+        while( oBuilder.GetRowCount() < nMaxBatchSize )
+        {
+            if( m_poQueryStatement == nullptr )
+            {
+                ResetStatement();
+                if( m_poQueryStatement == nullptr )
+                {
+                    m_bArrowArrayStreamEOF = true;
+                    break;
+                }
+            }
+
+            if( bDoStep )
+            {
+                const int rc = sqlite3_step( m_poQueryStatement );
+                if( rc != SQLITE_ROW )
+                {
+                    if ( rc != SQLITE_DONE )
+                    {
+                        sqlite3_reset(m_poQueryStatement);
+                        CPLError( CE_Failure, CPLE_AppDefined,
+                                "In GetNextArrowArray(): sqlite3_step() : %s",
+                                sqlite3_errmsg(m_poDS->GetDB()) );
+                        ClearStatement();
+                        m_bArrowArrayStreamEOF = true;
+                        return EIO;
+                    }
+                    ClearStatement();
+                    m_bArrowArrayStreamEOF = true;
+                    break;
+                }
+            }
+            else
+            {
+                bDoStep = true;
+            }
+
+            TranslateArrowRow(oBuilder, m_poQueryStatement,
+                              m_iFIDAsRegularColumnIndex);
+        }
+
+        if( oBuilder.GetRowCount() == 0 )
+            return 0;
+        return oBuilder.Finish(out_array) ? 0 : EOVERFLOW;
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory in GetNextArrowArray()");
+        return ENOMEM;
+    }
+}
+
 /************************************************************************/
 /*                        GetFeature()                                  */
 /************************************************************************/
@@ -2684,8 +2852,83 @@ typedef struct
     double  dfMinY;
     double  dfMaxX;
     double  dfMaxY;
+    GUInt32 nHilbertCode;
 } GPKGRTreeEntry;
 
+#ifndef NO_PROGRESSIVE_RTREE_INSERTION
+/************************************************************************/
+/*                          GPKGHilbertCode()                           */
+/************************************************************************/
+
+// Position along a Hilbert curve of the (nX, nY) point of a 65536x65536 grid
+static GUInt32 GPKGHilbertCode( GUInt32 nX, GUInt32 nY )
+{
+    constexpr GUInt32 N = 1U << 16;
+    GUInt32 nCode = 0;
+    for( GUInt32 s = N / 2; s > 0; s /= 2 )
+    {
+        const GUInt32 rx = (nX & s) ? 1 : 0;
+        const GUInt32 ry = (nY & s) ? 1 : 0;
+        nCode += s * s * ((3 * rx) ^ ry);
+        if( ry == 0 )
+        {
+            if( rx == 1 )
+            {
+                nX = N - 1 - nX;
+                nY = N - 1 - nY;
+            }
+            std::swap(nX, nY);
+        }
+    }
+    return nCode;
+}
+
+/************************************************************************/
+/*                     GPKGSortRTreeEntries()                           */
+/************************************************************************/
+
+// Sort entries along a Hilbert curve going through the centers of their
+// bounding boxes, so that entries that are close to each other are inserted
+// consecutively. This results in RTree nodes that overlap less, and in
+// faster insertion since the same nodes are updated in a row.
+static void GPKGSortRTreeEntries( std::vector<GPKGRTreeEntry>& aoEntries )
+{
+    if( aoEntries.size() < 2 )
+        return;
+    double dfMinX = aoEntries[0].dfMinX;
+    double dfMinY = aoEntries[0].dfMinY;
+    double dfMaxX = aoEntries[0].dfMaxX;
+    double dfMaxY = aoEntries[0].dfMaxY;
+    for( const auto& sEntry: aoEntries )
+    {
+        dfMinX = std::min(dfMinX, sEntry.dfMinX);
+        dfMinY = std::min(dfMinY, sEntry.dfMinY);
+        dfMaxX = std::max(dfMaxX, sEntry.dfMaxX);
+        dfMaxY = std::max(dfMaxY, sEntry.dfMaxY);
+    }
+    const double dfScaleX =
+        dfMaxX > dfMinX ? 65535.0 / (dfMaxX - dfMinX) : 0.0;
+    const double dfScaleY =
+        dfMaxY > dfMinY ? 65535.0 / (dfMaxY - dfMinY) : 0.0;
+    for( auto& sEntry: aoEntries )
+    {
+        const double dfX =
+            ((sEntry.dfMinX + sEntry.dfMaxX) / 2 - dfMinX) * dfScaleX;
+        const double dfY =
+            ((sEntry.dfMinY + sEntry.dfMaxY) / 2 - dfMinY) * dfScaleY;
+        // The comparisons are written so that NaN maps to 0
+        const GUInt32 nX = dfX > 0 ?
+            static_cast<GUInt32>(std::min(dfX, 65535.0)) : 0;
+        const GUInt32 nY = dfY > 0 ?
+            static_cast<GUInt32>(std::min(dfY, 65535.0)) : 0;
+        sEntry.nHilbertCode = GPKGHilbertCode(nX, nY);
+    }
+    std::sort(aoEntries.begin(), aoEntries.end(),
+              [](const GPKGRTreeEntry& a, const GPKGRTreeEntry& b)
+              { return a.nHilbertCode < b.nHilbertCode; });
+}
+#endif
+
 bool OGRGeoPackageTableLayer::CreateSpatialIndex(const char* pszTableName)
 {
     OGRErr err;
@@ -2796,10 +3039,11 @@ bool OGRGeoPackageTableLayer::CreateSpatialIndex(const char* pszTableName)
     }
     sqlite3_free(pszSQL);
 
-    // Insert entries in RTree by chunks of 100000
+    // Insert entries in RTree by chunks of 1000000, sorted in a spatially
+    // coherent order
     std::vector<GPKGRTreeEntry> aoEntries;
     GUIntBig nEntryCount = 0;
-    const size_t nChunkSize = 100000;
+    const size_t nChunkSize = 1000000;
     while( true )
     {
         int sqlite_err = sqlite3_step(hIterStmt);
@@ -2812,6 +3056,7 @@ bool OGRGeoPackageTableLayer::CreateSpatialIndex(const char* pszTableName)
             sEntry.dfMaxX = sqlite3_column_double(hIterStmt, 2);
             sEntry.dfMinY = sqlite3_column_double(hIterStmt, 3);
             sEntry.dfMaxY = sqlite3_column_double(hIterStmt, 4);
+            sEntry.nHilbertCode = 0;
             aoEntries.push_back(sEntry);
         }
         else if( sqlite_err == SQLITE_DONE )
@@ -2832,6 +3077,7 @@ bool OGRGeoPackageTableLayer::CreateSpatialIndex(const char* pszTableName)
 
         if( aoEntries.size() == nChunkSize || bFinished )
         {
+            GPKGSortRTreeEntries(aoEntries);
             for( size_t i = 0; i < aoEntries.size(); ++i )
             {
                 sqlite3_reset(hInsertStmt);
@@ -340,6 +340,45 @@ GByte* GPkgGeometryFromOGR(const OGRGeometry *poGeometry, int iSrsId,
     return pabyWkb;
 }
 
+/* Build a GeoPackage geometry blob from a non-empty ISO WKB geometry, */
+/* with a 2D envelope if psEnvelope is not NULL. */
+GByte* GPkgGeometryFromWKB(const GByte *pabyWkbIn, size_t nWkbLen,
+                           const OGREnvelope *psEnvelope, int iSrsId,
+                           size_t *pnGpkgLen)
+{
+    CPLAssert( pabyWkbIn != nullptr );
+
+    const size_t nHeaderLen = 2+1+1+4 + (psEnvelope ? 8*2*2 : 0);
+    const size_t nGpkgLen = nHeaderLen + nWkbLen;
+    GByte *pabyGpkg = (GByte *)CPLMalloc(nGpkgLen);
+    if (pnGpkgLen)
+        *pnGpkgLen = nGpkgLen;
+
+    /* Header Magic and version */
+    pabyGpkg[0] = 0x47;
+    pabyGpkg[1] = 0x50;
+    pabyGpkg[2] = 0;
+
+    /* Flags: 2D envelope or none, native byte order of header */
+    pabyGpkg[3] = static_cast<GByte>(((psEnvelope ? 1 : 0) << 1) |
+                                     CPL_IS_LSB);
+
+    memcpy(pabyGpkg+4, &iSrsId, 4);
+
+    if ( psEnvelope )
+    {
+        double *padPtr = (double*)(pabyGpkg+8);
+        padPtr[0] = psEnvelope->MinX;
+        padPtr[1] = psEnvelope->MaxX;
+        padPtr[2] = psEnvelope->MinY;
+        padPtr[3] = psEnvelope->MaxY;
+    }
+
+    memcpy(pabyGpkg + nHeaderLen, pabyWkbIn, nWkbLen);
+
+    return pabyGpkg;
+}
+
 OGRErr GPkgHeaderFromWKB(const GByte *pabyGpkg, size_t nGpkgLen, GPkgHeader *poHeader)
 {
     CPLAssert( pabyGpkg != nullptr );
@@ -53,7 +53,9 @@ KML::KML() :
     poCurrent_(nullptr),
     oCurrentParser(nullptr),
     nDataHandlerCounter(0),
-    nWithoutEventCounter(0)
+    nWithoutEventCounter(0),
+    bStreaming_(false),
+    bLoadingPlacemark_(false)
 {}
 
 KML::~KML()
@@ -97,18 +99,32 @@ bool KML::parse()
     XML_SetUserData(oParser, this);
     XML_SetElementHandler(oParser, startElement, endElement);
     XML_SetCharacterDataHandler(oParser, dataHandler);
+    XML_SetXmlDeclHandler(oParser, xmlDeclHandler);
     oCurrentParser = oParser;
     nWithoutEventCounter = 0;
+    sEncoding_.clear();
 
     int nDone = 0;
     int nLen = 0;
     char aBuf[BUFSIZ] = { 0 };
+    bool bFirstBuffer = true;
 
     do
     {
         nDataHandlerCounter = 0;
         nLen = (int)VSIFReadL( aBuf, 1, sizeof(aBuf), pKMLFile_ );
         nDone = VSIFEofL(pKMLFile_);
+        // Fragments of UTF-16 files without XML declaration could not be
+        // parsed on their own.
+        if( bFirstBuffer && nLen >= 2 &&
+            ((static_cast<GByte>(aBuf[0]) == 0xFF &&
+              static_cast<GByte>(aBuf[1]) == 0xFE) ||
+             (static_cast<GByte>(aBuf[0]) == 0xFE &&
+              static_cast<GByte>(aBuf[1]) == 0xFF)) )
+        {
+            bStreaming_ = false;
+        }
+        bFirstBuffer = false;
         if (XML_Parse(oParser, aBuf, nLen, nDone) == XML_STATUS_ERROR)
         {
             CPLError( CE_Failure, CPLE_AppDefined,
@@ -265,6 +281,13 @@ void XMLCALL KML::startElement( void* pUserData, const char* pszName,
         KMLNode* poMynew = new KMLNode();
         poMynew->setName(pszName);
         poMynew->setLevel(poKML->nDepth_);
+        if( poKML->bStreaming_ && strcmp(pszName, "Placemark") == 0 )
+        {
+            const GIntBig nOffset =
+                XML_GetCurrentByteIndex(poKML->oCurrentParser);
+            if( nOffset >= 0 )
+                poMynew->setFileOffset(static_cast<vsi_l_offset>(nOffset));
+        }
 
         for( int i = 0; ppszAttr[i]; i += 2 )
         {
@@ -510,6 +533,11 @@ void XMLCALL KML::endElement(void* pUserData, const char* pszName)
         }
         else
         {
+            if( poKML->bStreaming_ && !poKML->bLoadingPlacemark_ &&
+                poTmp->getName() == "Placemark" )
+            {
+                poKML->compactPlacemark(poTmp);
+            }
             if(poKML->poCurrent_ != nullptr)
                 poKML->poCurrent_->addChildren(poTmp);
         }
@@ -533,6 +561,138 @@ void XMLCALL KML::endElement(void* pUserData, const char* pszName)
   }
 }
 
+void XMLCALL KML::xmlDeclHandler( void* pUserData,
+                                  const char* /* pszVersion */,
+                                  const char* pszEncoding,
+                                  int /* nStandalone */ )
+{
+    KML* poKML = static_cast<KML *>(pUserData);
+    if( pszEncoding != nullptr )
+    {
+        poKML->sEncoding_ = pszEncoding;
+        if( STARTS_WITH_CI(pszEncoding, "UTF-16") )
+            poKML->bStreaming_ = false;
+    }
+}
+
+/************************************************************************/
+/*                          compactPlacemark()                          */
+/*                                                                      */
+/*      Called at the end of a Placemark in streaming mode: classify    */
+/*      it now, and only keep its type and position in the file.        */
+/************************************************************************/
+
+void KML::compactPlacemark(KMLNode* poNode)
+{
+    const GIntBig nIndex = XML_GetCurrentByteIndex(oCurrentParser);
+    if( nIndex < 0 )
+        return;
+    const vsi_l_offset nEnd = static_cast<vsi_l_offset>(nIndex) +
+                              XML_GetCurrentByteCount(oCurrentParser);
+    const vsi_l_offset nStart = poNode->getFileOffset();
+    // Placemarks whose extent is unknown, or too large to be parsed
+    // again in one go, are kept in memory.
+    if( nEnd <= nStart || nEnd - nStart > 100 * 1024 * 1024 )
+        return;
+    if( !poNode->classify(this, static_cast<int>(poNode->getLevel())) )
+        return;
+    poNode->compact(static_cast<std::size_t>(nEnd - nStart));
+}
+
+/************************************************************************/
+/*                           loadPlacemark()                            */
+/*                                                                      */
+/*      Parse again a Placemark compacted by the structural pass.       */
+/************************************************************************/
+
+KMLNode* KML::loadPlacemark( vsi_l_offset nOffset, std::size_t nSize,
+                             std::size_t nLevel )
+{
+    if( pKMLFile_ == nullptr )
+        return nullptr;
+
+    std::string osBuffer;
+    try
+    {
+        osBuffer.resize(nSize);
+    }
+    catch( const std::exception& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate %u bytes for Placemark",
+                 static_cast<unsigned>(nSize));
+        return nullptr;
+    }
+    if( VSIFSeekL(pKMLFile_, nOffset, SEEK_SET) != 0 ||
+        VSIFReadL(&osBuffer[0], 1, nSize, pKMLFile_) != nSize )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot read Placemark at offset " CPL_FRMT_GUIB,
+                 static_cast<GUIntBig>(nOffset));
+        return nullptr;
+    }
+
+    // The handlers work on the members below, which describe the layer
+    // currently selected.
+    KMLNode* poOldTrunk = poTrunk_;
+    KMLNode* poOldCurrent = poCurrent_;
+    const unsigned int nOldDepth = nDepth_;
+    poTrunk_ = nullptr;
+    poCurrent_ = nullptr;
+    nDepth_ = static_cast<unsigned int>(nLevel);
+    bLoadingPlacemark_ = true;
+
+    XML_Parser oParser = OGRCreateExpatXMLParser();
+    if( !sEncoding_.empty() )
+        XML_SetEncoding(oParser, sEncoding_.c_str());
+    XML_SetUserData(oParser, this);
+    XML_SetElementHandler(oParser, startElement, endElement);
+    XML_SetCharacterDataHandler(oParser, dataHandler);
+    oCurrentParser = oParser;
+    nDataHandlerCounter = 0;
+
+    bool bOK = true;
+    if( XML_Parse(oParser, osBuffer.data(), static_cast<int>(nSize),
+                  TRUE) == XML_STATUS_ERROR )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "XML parsing of Placemark at offset " CPL_FRMT_GUIB
+                  " failed : %s",
+                  static_cast<GUIntBig>(nOffset),
+                  XML_ErrorString(XML_GetErrorCode(oParser)) );
+        bOK = false;
+    }
+    XML_ParserFree(oParser);
+    oCurrentParser = nullptr;
+
+    KMLNode* poPlacemark = nullptr;
+    if( bOK && poCurrent_ == nullptr && poTrunk_ != nullptr &&
+        poTrunk_->getName() == "Placemark" &&
+        poTrunk_->classify(this, static_cast<int>(nLevel)) )
+    {
+        poPlacemark = poTrunk_;
+    }
+    else
+    {
+        while( poCurrent_ )
+        {
+            KMLNode* poTemp = poCurrent_->getParent();
+            delete poCurrent_;
+            if( poCurrent_ == poTrunk_ )
+                poTrunk_ = nullptr;
+            poCurrent_ = poTemp;
+        }
+        delete poTrunk_;
+    }
+
+    poTrunk_ = poOldTrunk;
+    poCurrent_ = poOldCurrent;
+    nDepth_ = nOldDepth;
+    bLoadingPlacemark_ = false;
+
+    return poPlacemark;
+}
+
 void XMLCALL KML::dataHandler(void* pUserData, const char* pszData, int nLen)
 {
     KML* poKML = static_cast<KML *>(pUserData);
@@ -694,7 +854,7 @@ Feature* KML::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
     if(poCurrent_ == nullptr)
         return nullptr;
 
-    return poCurrent_->getFeature(nNum, nLastAsked, nLastCount);
+    return poCurrent_->getFeature(nNum, nLastAsked, nLastCount, this);
 }
 
 void KML::unregisterLayerIfMatchingThisNode(KMLNode* poNode)
@@ -84,6 +84,13 @@ public:
 
     void unregisterLayerIfMatchingThisNode(KMLNode* poNode);
 
+    // Streaming mode: the Placemark subtrees are not kept after the
+    // structural pass, and are parsed again from the file when needed.
+    void setStreaming(bool bStreaming) { bStreaming_ = bStreaming; }
+    bool isStreaming() const { return bStreaming_; }
+    KMLNode* loadPlacemark(vsi_l_offset nOffset, std::size_t nSize,
+                           std::size_t nLevel);
+
 protected:
     void checkValidity();
 
@@ -92,6 +99,10 @@ protected:
     static void XMLCALL dataHandler(void *, const char *, int);
     static void XMLCALL dataHandlerValidate(void *, const char *, int);
     static void XMLCALL endElement(void *, const char *);
+    static void XMLCALL xmlDeclHandler(void *, const char *, const char *,
+                                       int);
+
+    void compactPlacemark(KMLNode* poNode);
 
     // Trunk of KMLnodes.
     KMLNode* poTrunk_;
@@ -116,6 +127,13 @@ private:
     XML_Parser oCurrentParser;
     int nDataHandlerCounter;
     int nWithoutEventCounter;
+
+    // Encoding declared by the XML declaration, used to parse Placemarks
+    // again in streaming mode.
+    std::string sEncoding_;
+    bool bStreaming_;
+    // Set while parsing a single Placemark again.
+    bool bLoadingPlacemark_;
 };
 
 #endif // HAVE_EXPAT
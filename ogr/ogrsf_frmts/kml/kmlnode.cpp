@@ -127,7 +127,9 @@ KMLNode::KMLNode() :
     eType_(Unknown),
     b25D_(false),
     nLayerNumber_(-1),
-    nNumFeatures_(-1)
+    nNumFeatures_(-1),
+    nFileOffset_(0),
+    nFileSize_(0)
 {}
 
 KMLNode::~KMLNode()
@@ -711,7 +713,27 @@ OGRGeometry* KMLNode::getGeometry(Nodetype eType)
     return poGeom;
 }
 
-Feature* KMLNode::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
+void KMLNode::compact(std::size_t nSize)
+{
+    for( kml_nodes_t::iterator itChild = pvpoChildren_->begin();
+         itChild != pvpoChildren_->end(); ++itChild)
+    {
+        delete (*itChild);
+    }
+    kml_nodes_t().swap(*pvpoChildren_);
+    for( kml_attributes_t::iterator itAttr = pvoAttributes_->begin();
+         itAttr != pvoAttributes_->end(); ++itAttr)
+    {
+        delete (*itAttr);
+    }
+    kml_attributes_t().swap(*pvoAttributes_);
+    kml_content_t().swap(*pvsContent_);
+
+    nFileSize_ = nSize;
+}
+
+Feature* KMLNode::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount,
+                             KML* poKML)
 {
     if( nNum >= getNumFeatures() )
         return nullptr;
@@ -751,6 +773,18 @@ Feature* KMLNode::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
     if(poFeat == nullptr)
         return nullptr;
 
+    // In streaming mode, parse the Placemark again from the file.
+    std::unique_ptr<KMLNode> poLoaded;
+    if( poFeat->isCompacted() )
+    {
+        poLoaded.reset(poKML->loadPlacemark(poFeat->nFileOffset_,
+                                            poFeat->nFileSize_,
+                                            poFeat->nLevel_));
+        if( poLoaded == nullptr )
+            return nullptr;
+        poFeat = poLoaded.get();
+    }
+
     // Create a feature structure
     Feature *psReturn = new Feature;
     // Build up the name
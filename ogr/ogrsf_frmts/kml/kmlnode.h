@@ -86,7 +86,15 @@ public:
     std::string getDescriptionElement() const;
 
     std::size_t getNumFeatures();
-    Feature* getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount);
+    Feature* getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount,
+                        KML* poKML);
+
+    // Streaming mode: drop the children and content of a classified
+    // Placemark, and remember where it is in the file.
+    void setFileOffset(vsi_l_offset nOffset) { nFileOffset_ = nOffset; }
+    vsi_l_offset getFileOffset() const { return nFileOffset_; }
+    void compact(std::size_t nSize);
+    bool isCompacted() const { return nFileSize_ > 0; }
 
     OGRGeometry* getGeometry(Nodetype eType = Unknown);
 
@@ -113,6 +121,9 @@ private:
     int nLayerNumber_;
     int nNumFeatures_;
 
+    vsi_l_offset nFileOffset_;
+    std::size_t nFileSize_;
+
     void unregisterLayerIfMatchingThisNode(KML* poKML);
 };
 
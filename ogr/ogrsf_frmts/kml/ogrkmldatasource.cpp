@@ -144,6 +144,22 @@ int OGRKMLDataSource::Open( const char * pszNewName, int bTestOpen )
 
     pszName_ = CPLStrdup( pszNewName );
 
+/* -------------------------------------------------------------------- */
+/*      Large files are read in streaming mode: the structural pass     */
+/*      only keeps the containers, and the Placemarks are parsed again  */
+/*      when their features are read.                                   */
+/* -------------------------------------------------------------------- */
+    VSIStatBufL sStat;
+    const double dfStreamingThreshold = CPLAtof(
+        CPLGetConfigOption("KML_STREAMING_THRESHOLD_MB", "100"));
+    if( VSIStatL(pszNewName, &sStat) == 0 &&
+        static_cast<double>(sStat.st_size) >=
+                                    dfStreamingThreshold * 1024 * 1024 )
+    {
+        CPLDebug("KML", "Using streaming mode");
+        poKMLFile_->setStreaming(true);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      If we aren't sure it is KML, validate it by start parsing       */
 /* -------------------------------------------------------------------- */
@@ -34,6 +34,8 @@
 #include "ogrsf_frmts.h"
 
 #include <map>
+#include <memory>
+#include <vector>
 
 /************************************************************************/
 /*                             OGRMemLayer                              */
@@ -41,11 +43,15 @@
 class OGRMemDataSource;
 
 class IOGRMemLayerFeatureIterator;
+class OGRMemSpatialIndex;
+class OGRMemLayerAttrIndex;
 
 class OGRMemLayer : public OGRLayer
 {
     CPL_DISALLOW_COPY_ASSIGN(OGRMemLayer)
 
+    friend class OGRMemLayerAttrIndex;
+
     typedef std::map<GIntBig, OGRFeature*>           FeatureMap;
     typedef std::map<GIntBig, OGRFeature*>::iterator FeatureIterator;
 
@@ -68,6 +74,38 @@ class OGRMemLayer : public OGRLayer
 
     bool                m_bUpdated;
 
+    // With COORDINATE_STORAGE=FLOAT32, geometries are not kept in the stored
+    // features but encoded in m_oMapEncodedGeoms, indexed by FID.
+    bool                m_bFloat32Coordinates = false;
+    std::map<GIntBig, std::vector<GByte>> m_oMapEncodedGeoms{};
+
+    void                EncodeGeometries( OGRFeature *poFeature,
+                                          std::vector<GByte>& abyEncoded );
+    void                DecodeGeometries( OGRFeature *poFeature ) const;
+
+    // Spatial indexes, per geometry field, built on the first read with a
+    // spatial filter on the field and then updated by SetFeature().
+    bool                m_bSpatialIndex = true;
+    std::vector<std::unique_ptr<OGRMemSpatialIndex>> m_apoSpatialIndexes{};
+
+    // FIDs of the features that may match the filters of the current
+    // read, when the indexes can answer them.
+    bool                m_bCandidatesComputed = false;
+    bool                m_bUseCandidates = false;
+    std::vector<GIntBig> m_anCandidateFIDs{};
+    size_t              m_iNextCandidate = 0;
+
+    OGRFeature         *GetStoredFeature( GIntBig nFID ) const;
+    bool                GetStoredEnvelope( OGRFeature *poFeature,
+                                           int iGeomField,
+                                           OGREnvelope& sEnvelope ) const;
+    OGRMemSpatialIndex *GetSpatialIndex( int iGeomField );
+    OGRMemLayerAttrIndex *GetMemAttrIndex() const;
+    void                AddToIndexes( OGRFeature *poStoredFeature,
+                                      OGRFeature *poSourceFeature );
+    void                RemoveFromIndexes( OGRFeature *poStoredFeature );
+    void                ComputeCandidates();
+
     // Only use it in the lifetime of a function where the list of features
     // doesn't change.
     IOGRMemLayerFeatureIterator* GetIterator();
@@ -108,6 +146,9 @@ class OGRMemLayer : public OGRLayer
         { m_bUpdatable = bUpdatableIn; }
     void                SetAdvertizeUTF8( bool bAdvertizeUTF8In )
         { m_bAdvertizeUTF8 = bAdvertizeUTF8In; }
+    void                SetFloat32Coordinates( bool bFloat32CoordinatesIn )
+        { m_bFloat32Coordinates = bFloat32CoordinatesIn; }
+    void                SetSpatialIndex( bool bSpatialIndexIn );
 
     bool                HasBeenUpdated() const { return m_bUpdated; }
     void                SetUpdated(bool bUpdated) { m_bUpdated = bUpdated; }
@@ -89,6 +89,21 @@ OGRMemDataSource::ICreateLayer( const char *pszLayerName,
     if( CPLFetchBool(papszOptions, "ADVERTIZE_UTF8", false) )
         poLayer->SetAdvertizeUTF8(true);
 
+    const char* pszCoordStorage =
+        CSLFetchNameValue(papszOptions, "COORDINATE_STORAGE");
+    if( pszCoordStorage != nullptr )
+    {
+        if( EQUAL(pszCoordStorage, "FLOAT32") )
+            poLayer->SetFloat32Coordinates(true);
+        else if( !EQUAL(pszCoordStorage, "DOUBLE") )
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "Unsupported value for COORDINATE_STORAGE: %s",
+                     pszCoordStorage);
+    }
+
+    if( !CPLFetchBool(papszOptions, "SPATIAL_INDEX", true) )
+        poLayer->SetSpatialIndex(false);
+
     // Add layer to data source layer list.
     papoLayers = static_cast<OGRMemLayer **>(
         CPLRealloc(papoLayers, sizeof(OGRMemLayer *) * (nLayers + 1)));
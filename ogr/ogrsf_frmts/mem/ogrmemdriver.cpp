@@ -104,6 +104,14 @@ void RegisterOGRMEM()
         "<LayerCreationOptionList>"
         "  <Option name='ADVERTIZE_UTF8' type='boolean' description='Whether "
         "the layer will contain UTF-8 strings' default='NO'/>"
+        "  <Option name='COORDINATE_STORAGE' type='string-select' "
+        "description='How geometry coordinates are stored' default='DOUBLE'>"
+        "    <Value>DOUBLE</Value>"
+        "    <Value>FLOAT32</Value>"
+        "  </Option>"
+        "  <Option name='SPATIAL_INDEX' type='boolean' description='Whether "
+        "reads with a spatial filter use an in-memory spatial index' "
+        "default='YES'/>"
         "</LayerCreationOptionList>");
 
     OGRSFDriverRegistrar::GetRegistrar()->RegisterDriver(poDriver);
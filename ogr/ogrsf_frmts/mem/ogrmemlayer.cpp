@@ -30,17 +30,23 @@
 #include "cpl_port.h"
 #include "ogr_mem.h"
 
+#include <climits>
 #include <cstddef>
 #include <cstring>
 #include <algorithm>
+#include <iterator>
 #include <map>
 #include <new>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_quad_tree.h"
 #include "cpl_vsi.h"
 #include "ogr_api.h"
+#include "ogr_attrind.h"
 #include "ogr_core.h"
 #include "ogr_feature.h"
 #include "ogr_geometry.h"
@@ -62,6 +68,927 @@ class IOGRMemLayerFeatureIterator
     virtual OGRFeature *Next() = 0;
 };
 
+/************************************************************************/
+/*                     Float32 coordinate storage                       */
+/*                                                                      */
+/*      With COORDINATE_STORAGE=FLOAT32, a geometry is stored as its    */
+/*      ISO WKB (NDR) representation, where each coordinate is          */
+/*      replaced by a float32 offset to an origin (the center of the    */
+/*      envelope of the geometry for X, Y and Z, 0 for M). The four    */
+/*      origin values, as doubles, precede the modified WKB.           */
+/************************************************************************/
+
+static const size_t ORIGIN_SIZE = 4 * sizeof(double);
+
+static bool OGRMemReadUInt32( const GByte*& pabyIn, const GByte* pabyEnd,
+                              GUInt32& nVal )
+{
+    if( pabyEnd - pabyIn < 4 )
+        return false;
+    memcpy(&nVal, pabyIn, 4);
+    CPL_LSBPTR32(&nVal);
+    pabyIn += 4;
+    return true;
+}
+
+// Code a geometry, or decode it if bDecode is true, from pabyIn to abyOut.
+// The structure (byte order, types and counts) is copied unchanged, only
+// the coordinates are converted.
+static bool OGRMemConvertWKB( const GByte*& pabyIn, const GByte* pabyEnd,
+                              const double* padfOrigin, bool bDecode,
+                              std::vector<GByte>& abyOut, int nRecLevel = 0 )
+{
+    // Same limit as in OGRGeometryFactory::createFromWkb()
+    if( nRecLevel == 32 || pabyEnd - pabyIn < 5 )
+        return false;
+    abyOut.insert(abyOut.end(), pabyIn, pabyIn + 5);
+    GUInt32 nType = 0;
+    ++pabyIn;
+    OGRMemReadUInt32(pabyIn, pabyEnd, nType);
+
+    const GUInt32 nFlatType = nType % 1000;
+    const GUInt32 nDimCode = nType / 1000;
+    const bool bHasZ = nDimCode == 1 || nDimCode == 3;
+    const bool bHasM = nDimCode == 2 || nDimCode == 3;
+    const int nDims = 2 + (bHasZ ? 1 : 0) + (bHasM ? 1 : 0);
+    const size_t nInCoordSize = bDecode ? sizeof(float) : sizeof(double);
+
+    const auto ConvertPoints = [&](GUInt32 nPoints)
+    {
+        if( static_cast<size_t>(pabyEnd - pabyIn) / nInCoordSize / nDims <
+                nPoints )
+            return false;
+        for( GUInt32 i = 0; i < nPoints; ++i )
+        {
+            for( int iDim = 0; iDim < nDims; ++iDim )
+            {
+                const double dfOrigin =
+                    padfOrigin[iDim < 2 ? iDim :
+                               (iDim == 2 && bHasZ) ? 2 : 3];
+                GByte abyVal[sizeof(double)];
+                if( bDecode )
+                {
+                    float fVal = 0.0f;
+                    memcpy(&fVal, pabyIn, sizeof(float));
+                    double dfVal = static_cast<double>(fVal) + dfOrigin;
+                    CPL_LSBPTR64(&dfVal);
+                    memcpy(abyVal, &dfVal, sizeof(double));
+                    abyOut.insert(abyOut.end(), abyVal,
+                                  abyVal + sizeof(double));
+                }
+                else
+                {
+                    double dfVal = 0.0;
+                    memcpy(&dfVal, pabyIn, sizeof(double));
+                    CPL_LSBPTR64(&dfVal);
+                    const float fVal = static_cast<float>(dfVal - dfOrigin);
+                    memcpy(abyVal, &fVal, sizeof(float));
+                    abyOut.insert(abyOut.end(), abyVal,
+                                  abyVal + sizeof(float));
+                }
+                pabyIn += nInCoordSize;
+            }
+        }
+        return true;
+    };
+
+    const auto CopyCount = [&](GUInt32& nCount)
+    {
+        const GByte* pabyCount = pabyIn;
+        if( !OGRMemReadUInt32(pabyIn, pabyEnd, nCount) )
+            return false;
+        abyOut.insert(abyOut.end(), pabyCount, pabyIn);
+        return true;
+    };
+
+    GUInt32 nCount = 0;
+    switch( nFlatType )
+    {
+        case wkbPoint:
+            return ConvertPoints(1);
+
+        case wkbLineString:
+        case wkbCircularString:
+            return CopyCount(nCount) && ConvertPoints(nCount);
+
+        case wkbPolygon:
+        case wkbTriangle:
+        {
+            if( !CopyCount(nCount) )
+                return false;
+            for( GUInt32 i = 0; i < nCount; ++i )
+            {
+                GUInt32 nPoints = 0;
+                if( !CopyCount(nPoints) || !ConvertPoints(nPoints) )
+                    return false;
+            }
+            return true;
+        }
+
+        case wkbMultiPoint:
+        case wkbMultiLineString:
+        case wkbMultiPolygon:
+        case wkbGeometryCollection:
+        case wkbCompoundCurve:
+        case wkbCurvePolygon:
+        case wkbMultiCurve:
+        case wkbMultiSurface:
+        case wkbPolyhedralSurface:
+        case wkbTIN:
+        {
+            if( !CopyCount(nCount) )
+                return false;
+            for( GUInt32 i = 0; i < nCount; ++i )
+            {
+                if( !OGRMemConvertWKB(pabyIn, pabyEnd, padfOrigin, bDecode,
+                                      abyOut, nRecLevel + 1) )
+                    return false;
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+/************************************************************************/
+/*                          EncodeGeometries()                          */
+/*                                                                      */
+/*      Move the geometries of poFeature into abyEncoded. Geometries    */
+/*      that would not be smaller once encoded are left in the feature. */
+/*      abyEncoded is left empty if no geometry has been encoded.       */
+/************************************************************************/
+
+void OGRMemLayer::EncodeGeometries( OGRFeature *poFeature,
+                                    std::vector<GByte>& abyEncoded )
+{
+    abyEncoded.clear();
+    bool bHasEncoded = false;
+    std::vector<GByte> abyWKB;
+    std::vector<GByte> abyGeom;
+    const int nGeomFieldCount = m_poFeatureDefn->GetGeomFieldCount();
+    for( int i = 0; i < nGeomFieldCount; ++i )
+    {
+        const OGRGeometry *poGeom = poFeature->GetGeomFieldRef(i);
+        abyGeom.clear();
+        if( poGeom != nullptr && !poGeom->IsEmpty() )
+        {
+            abyWKB.resize(poGeom->WkbSize());
+            OGREnvelope3D sEnvelope;
+            poGeom->getEnvelope(&sEnvelope);
+            const double adfOrigin[4] = {
+                (sEnvelope.MinX + sEnvelope.MaxX) / 2,
+                (sEnvelope.MinY + sEnvelope.MaxY) / 2,
+                (sEnvelope.MinZ + sEnvelope.MaxZ) / 2,
+                0.0 };
+            abyGeom.resize(ORIGIN_SIZE);
+            memcpy(&abyGeom[0], adfOrigin, ORIGIN_SIZE);
+            const GByte *pabyIn = abyWKB.data();
+            if( poGeom->exportToWkb(wkbNDR, &abyWKB[0],
+                                    wkbVariantIso) != OGRERR_NONE ||
+                !OGRMemConvertWKB(pabyIn, pabyIn + abyWKB.size(), adfOrigin,
+                                  false, abyGeom) ||
+                abyGeom.size() >= abyWKB.size() )
+            {
+                abyGeom.clear();
+            }
+        }
+
+        const GUInt32 nSize = static_cast<GUInt32>(abyGeom.size());
+        const GByte *pabySize = reinterpret_cast<const GByte *>(&nSize);
+        abyEncoded.insert(abyEncoded.end(), pabySize,
+                          pabySize + sizeof(nSize));
+        if( nSize )
+        {
+            abyEncoded.insert(abyEncoded.end(), abyGeom.begin(),
+                              abyGeom.end());
+            poFeature->SetGeomFieldDirectly(i, nullptr);
+            bHasEncoded = true;
+        }
+    }
+    if( !bHasEncoded )
+        abyEncoded.clear();
+}
+
+/************************************************************************/
+/*                          DecodeGeometries()                          */
+/*                                                                      */
+/*      Restore, in a clone of a stored feature, the geometries that    */
+/*      have been moved out of it by EncodeGeometries().                */
+/************************************************************************/
+
+void OGRMemLayer::DecodeGeometries( OGRFeature *poFeature ) const
+{
+    const auto oIter = m_oMapEncodedGeoms.find(poFeature->GetFID());
+    if( oIter == m_oMapEncodedGeoms.end() )
+        return;
+
+    const GByte *pabyIn = oIter->second.data();
+    const GByte *pabyEnd = pabyIn + oIter->second.size();
+    std::vector<GByte> abyWKB;
+    // Geometry fields created after the feature was stored are not in the
+    // encoded buffer.
+    const int nGeomFieldCount = m_poFeatureDefn->GetGeomFieldCount();
+    for( int i = 0; i < nGeomFieldCount && pabyIn < pabyEnd; ++i )
+    {
+        GUInt32 nSize = 0;
+        memcpy(&nSize, pabyIn, sizeof(nSize));
+        pabyIn += sizeof(nSize);
+        if( nSize == 0 )
+            continue;
+
+        double adfOrigin[4];
+        memcpy(adfOrigin, pabyIn, ORIGIN_SIZE);
+        const GByte *pabyGeom = pabyIn + ORIGIN_SIZE;
+        pabyIn += nSize;
+        abyWKB.clear();
+        OGRGeometry *poGeom = nullptr;
+        if( OGRMemConvertWKB(pabyGeom, pabyIn, adfOrigin, true, abyWKB) &&
+            OGRGeometryFactory::createFromWkb(
+                abyWKB.data(), nullptr, &poGeom,
+                static_cast<int>(abyWKB.size()),
+                wkbVariantIso) == OGRERR_NONE )
+        {
+            poGeom->assignSpatialReference(
+                m_poFeatureDefn->GetGeomFieldDefn(i)->GetSpatialRef());
+            poFeature->SetGeomFieldDirectly(i, poGeom);
+        }
+    }
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          OGRMemSpatialIndex                          */
+/*                                                                      */
+/*      Quad tree of the envelopes of the geometries of a field.        */
+/*      Replaced or deleted features leave their previous entries in    */
+/*      the tree: search results are candidates on which the spatial    */
+/*      filter is still evaluated, and the tree is rebuilt when stale   */
+/*      entries or insertions make it inefficient.                      */
+/* ==================================================================== */
+/************************************************************************/
+
+class OGRMemSpatialIndex
+{
+    CPLQuadTree        *m_hTree = nullptr;
+    OGREnvelope         m_sBounds{};
+    // Entry i of the tree is stored as the pointer value i + 1.
+    std::vector<GIntBig> m_anFIDs{};
+    size_t              m_nBuildCount = 0;
+    size_t              m_nStaleCount = 0;
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRMemSpatialIndex)
+
+    static void         ToRect( const OGREnvelope& sEnvelope,
+                                CPLRectObj& sRect )
+    {
+        sRect.minx = sEnvelope.MinX;
+        sRect.miny = sEnvelope.MinY;
+        sRect.maxx = sEnvelope.MaxX;
+        sRect.maxy = sEnvelope.MaxY;
+    }
+
+  public:
+    OGRMemSpatialIndex() = default;
+    ~OGRMemSpatialIndex();
+
+    void        Build( const std::vector<std::pair<GIntBig, OGREnvelope>>&
+                                                                aoEntries );
+    bool        Insert( GIntBig nFID, const OGREnvelope& sEnvelope );
+    bool        AddStaleEntry();
+    void        Search( const OGREnvelope& sEnvelope,
+                        std::vector<GIntBig>& anFIDs ) const;
+};
+
+OGRMemSpatialIndex::~OGRMemSpatialIndex()
+{
+    if( m_hTree )
+        CPLQuadTreeDestroy(m_hTree);
+}
+
+/************************************************************************/
+/*                               Build()                                */
+/************************************************************************/
+
+void OGRMemSpatialIndex::Build(
+    const std::vector<std::pair<GIntBig, OGREnvelope>>& aoEntries )
+{
+    for( const auto& oEntry: aoEntries )
+        m_sBounds.Merge(oEntry.second);
+    if( aoEntries.empty() )
+    {
+        m_sBounds.MinX = 0.0;
+        m_sBounds.MinY = 0.0;
+        m_sBounds.MaxX = 0.0;
+        m_sBounds.MaxY = 0.0;
+    }
+
+    CPLRectObj sGlobalBounds;
+    ToRect(m_sBounds, sGlobalBounds);
+    m_hTree = CPLQuadTreeCreate(&sGlobalBounds, nullptr);
+    CPLQuadTreeSetMaxDepth(m_hTree, CPLQuadTreeGetAdvisedMaxDepth(
+        static_cast<int>(std::min<size_t>(aoEntries.size(), INT_MAX))));
+
+    m_anFIDs.reserve(aoEntries.size());
+    for( const auto& oEntry: aoEntries )
+    {
+        CPLRectObj sRect;
+        ToRect(oEntry.second, sRect);
+        m_anFIDs.push_back(oEntry.first);
+        CPLQuadTreeInsertWithBounds(
+            m_hTree, reinterpret_cast<void*>(
+                static_cast<GUIntptr_t>(m_anFIDs.size())), &sRect);
+    }
+    m_nBuildCount = m_anFIDs.size();
+}
+
+/************************************************************************/
+/*                               Insert()                               */
+/*                                                                      */
+/*      Returns false if the index should be rebuilt instead.           */
+/************************************************************************/
+
+bool OGRMemSpatialIndex::Insert( GIntBig nFID, const OGREnvelope& sEnvelope )
+{
+    // Features outside of the global bounds would all end up in the root
+    // node, and a tree built for much fewer features is too shallow.
+    if( !m_sBounds.Contains(sEnvelope) ||
+        m_anFIDs.size() >= 2 * m_nBuildCount + 1000 )
+        return false;
+
+    try
+    {
+        m_anFIDs.push_back(nFID);
+    }
+    catch( const std::bad_alloc & )
+    {
+        return false;
+    }
+    CPLRectObj sRect;
+    ToRect(sEnvelope, sRect);
+    CPLQuadTreeInsertWithBounds(
+        m_hTree, reinterpret_cast<void*>(
+            static_cast<GUIntptr_t>(m_anFIDs.size())), &sRect);
+    return true;
+}
+
+/************************************************************************/
+/*                           AddStaleEntry()                            */
+/*                                                                      */
+/*      Account for an entry whose feature has been replaced or         */
+/*      deleted. Returns false if the index should be rebuilt.          */
+/************************************************************************/
+
+bool OGRMemSpatialIndex::AddStaleEntry()
+{
+    ++m_nStaleCount;
+    return m_nStaleCount <= m_anFIDs.size() / 2;
+}
+
+/************************************************************************/
+/*                               Search()                               */
+/*                                                                      */
+/*      Return the sorted FIDs of the entries intersecting sEnvelope.   */
+/************************************************************************/
+
+void OGRMemSpatialIndex::Search( const OGREnvelope& sEnvelope,
+                                 std::vector<GIntBig>& anFIDs ) const
+{
+    anFIDs.clear();
+    CPLRectObj sRect;
+    ToRect(sEnvelope, sRect);
+    int nCount = 0;
+    void** pahHits = CPLQuadTreeSearch(m_hTree, &sRect, &nCount);
+    anFIDs.reserve(nCount);
+    for( int i = 0; i < nCount; ++i )
+    {
+        const size_t iEntry =
+            static_cast<size_t>(reinterpret_cast<GUIntptr_t>(pahHits[i]));
+        anFIDs.push_back(m_anFIDs[iEntry - 1]);
+    }
+    CPLFree(pahHits);
+
+    // A feature updated in place may have several entries.
+    std::sort(anFIDs.begin(), anFIDs.end());
+    anFIDs.erase(std::unique(anFIDs.begin(), anFIDs.end()), anFIDs.end());
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                           OGRMemAttrIndex                            */
+/*                                                                      */
+/*      Hash index of the values of an attribute field, for equality    */
+/*      and IN tests of attribute filters.                              */
+/* ==================================================================== */
+/************************************************************************/
+
+class OGRMemAttrIndex final: public OGRAttrIndex
+{
+    CPL_DISALLOW_COPY_ASSIGN(OGRMemAttrIndex)
+
+public:
+    int             iField;
+    OGRFieldType    eFieldType;
+    std::unordered_map<std::string, std::vector<GIntBig>> oMapFIDs{};
+
+                OGRMemAttrIndex( int iFieldIn, OGRFieldType eFieldTypeIn ) :
+                    iField(iFieldIn), eFieldType(eFieldTypeIn) {}
+
+    static bool IsTypeSupported( OGRFieldType eType );
+    bool        BuildKey( const OGRField *psKey, std::string& osKey ) const;
+
+    GIntBig     GetFirstMatch( OGRField *psKey ) override;
+    GIntBig    *GetAllMatches( OGRField *psKey ) override;
+    GIntBig    *GetAllMatches( OGRField *psKey, GIntBig* panFIDList,
+                               int* nFIDCount, int* nLength ) override;
+
+    OGRErr      AddEntry( OGRField *psKey, GIntBig nFID ) override;
+    OGRErr      RemoveEntry( OGRField *psKey, GIntBig nFID ) override;
+
+    OGRErr      Clear() override;
+};
+
+/************************************************************************/
+/*                          IsTypeSupported()                           */
+/************************************************************************/
+
+bool OGRMemAttrIndex::IsTypeSupported( OGRFieldType eType )
+{
+    return eType == OFTInteger || eType == OFTInteger64 ||
+           eType == OFTReal || eType == OFTString || eType == OFTDateTime;
+}
+
+/************************************************************************/
+/*                              BuildKey()                              */
+/*                                                                      */
+/*      Keys are equal when OGR SQL considers the values equal: case    */
+/*      insensitive for strings, ignoring the time zone for dates.      */
+/************************************************************************/
+
+bool OGRMemAttrIndex::BuildKey( const OGRField *psKey,
+                                std::string& osKey ) const
+{
+    const auto AssignBytes = [&osKey](const void* pData, size_t nSize)
+    {
+        osKey.assign(static_cast<const char*>(pData), nSize);
+    };
+
+    switch( eFieldType )
+    {
+      case OFTInteger:
+      {
+          const GIntBig nVal = psKey->Integer;
+          AssignBytes(&nVal, sizeof(nVal));
+          return true;
+      }
+
+      case OFTInteger64:
+      {
+          const GIntBig nVal = psKey->Integer64;
+          AssignBytes(&nVal, sizeof(nVal));
+          return true;
+      }
+
+      case OFTReal:
+      {
+          // NaN is equal to nothing, and -0 equal to 0.
+          if( CPLIsNan(psKey->Real) )
+              return false;
+          const double dfVal = psKey->Real == 0.0 ? 0.0 : psKey->Real;
+          AssignBytes(&dfVal, sizeof(dfVal));
+          return true;
+      }
+
+      case OFTDateTime:
+      {
+          const double dfVal =
+              ((((static_cast<double>(psKey->Date.Year) * 13 +
+                  psKey->Date.Month) * 32 +
+                 psKey->Date.Day) * 24 +
+                psKey->Date.Hour) * 60 +
+               psKey->Date.Minute) * 61 +
+              psKey->Date.Second;
+          AssignBytes(&dfVal, sizeof(dfVal));
+          return true;
+      }
+
+      case OFTString:
+      {
+          osKey = psKey->String;
+          for( char& ch : osKey )
+          {
+              if( ch >= 'A' && ch <= 'Z' )
+                  ch = static_cast<char>(ch - 'A' + 'a');
+          }
+          return true;
+      }
+
+      default:
+          return false;
+    }
+}
+
+/************************************************************************/
+/*                           GetFirstMatch()                            */
+/************************************************************************/
+
+GIntBig OGRMemAttrIndex::GetFirstMatch( OGRField *psKey )
+
+{
+    std::string osKey;
+    if( !BuildKey(psKey, osKey) )
+        return OGRNullFID;
+
+    const auto oIter = oMapFIDs.find(osKey);
+    if( oIter == oMapFIDs.end() )
+        return OGRNullFID;
+
+    return *std::min_element(oIter->second.begin(), oIter->second.end());
+}
+
+/************************************************************************/
+/*                           GetAllMatches()                            */
+/************************************************************************/
+
+GIntBig *OGRMemAttrIndex::GetAllMatches( OGRField *psKey )
+{
+    int nFIDCount = 0;
+    int nLength = 0;
+    return GetAllMatches(psKey, nullptr, &nFIDCount, &nLength);
+}
+
+GIntBig *OGRMemAttrIndex::GetAllMatches( OGRField *psKey, GIntBig* panFIDList,
+                                         int* nFIDCount, int* nLength )
+{
+    if( panFIDList == nullptr )
+    {
+        panFIDList = static_cast<GIntBig *>(CPLMalloc(sizeof(GIntBig) * 2));
+        *nFIDCount = 0;
+        *nLength = 2;
+    }
+
+    std::string osKey;
+    if( BuildKey(psKey, osKey) )
+    {
+        const auto oIter = oMapFIDs.find(osKey);
+        if( oIter != oMapFIDs.end() )
+        {
+            for( const GIntBig nFID: oIter->second )
+            {
+                if( *nFIDCount >= *nLength - 1 )
+                {
+                    *nLength = (*nLength) * 2 + 10;
+                    panFIDList = static_cast<GIntBig *>(
+                        CPLRealloc(panFIDList, sizeof(GIntBig) * *nLength));
+                }
+                panFIDList[(*nFIDCount)++] = nFID;
+            }
+        }
+    }
+
+    panFIDList[*nFIDCount] = OGRNullFID;
+
+    return panFIDList;
+}
+
+/************************************************************************/
+/*                              AddEntry()                              */
+/************************************************************************/
+
+OGRErr OGRMemAttrIndex::AddEntry( OGRField *psKey, GIntBig nFID )
+
+{
+    std::string osKey;
+    if( !BuildKey(psKey, osKey) )
+        return OGRERR_NONE;
+
+    try
+    {
+        oMapFIDs[osKey].push_back(nFID);
+    }
+    catch( const std::bad_alloc & )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Cannot allocate memory");
+        return OGRERR_NOT_ENOUGH_MEMORY;
+    }
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            RemoveEntry()                             */
+/************************************************************************/
+
+OGRErr OGRMemAttrIndex::RemoveEntry( OGRField *psKey, GIntBig nFID )
+
+{
+    std::string osKey;
+    if( !BuildKey(psKey, osKey) )
+        return OGRERR_NONE;
+
+    const auto oIter = oMapFIDs.find(osKey);
+    if( oIter == oMapFIDs.end() )
+        return OGRERR_FAILURE;
+
+    std::vector<GIntBig>& anFIDs = oIter->second;
+    const auto oFIDIter = std::find(anFIDs.begin(), anFIDs.end(), nFID);
+    if( oFIDIter == anFIDs.end() )
+        return OGRERR_FAILURE;
+
+    *oFIDIter = anFIDs.back();
+    anFIDs.pop_back();
+    if( anFIDs.empty() )
+        oMapFIDs.erase(oIter);
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                               Clear()                                */
+/************************************************************************/
+
+OGRErr OGRMemAttrIndex::Clear()
+{
+    oMapFIDs.clear();
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                         OGRMemLayerAttrIndex                         */
+/*                                                                      */
+/*      Attribute indexes of a memory layer, created with               */
+/*      CREATE INDEX ON <layer> USING <field> and kept up to date by    */
+/*      the layer.                                                      */
+/* ==================================================================== */
+/************************************************************************/
+
+class OGRMemLayerAttrIndex final: public OGRLayerAttrIndex
+{
+    CPL_DISALLOW_COPY_ASSIGN(OGRMemLayerAttrIndex)
+
+    OGRMemLayer *poMemLayer;
+    std::vector<std::unique_ptr<OGRMemAttrIndex>> apoIndexes{};
+
+public:
+    explicit    OGRMemLayerAttrIndex( OGRMemLayer *poMemLayerIn );
+
+    /* base class virtual methods */
+    OGRErr      Initialize( const char *pszIndexPath, OGRLayer * ) override;
+    OGRErr      CreateIndex( int iField ) override;
+    OGRErr      DropIndex( int iField ) override;
+    OGRErr      IndexAllFeatures( int iField = -1 ) override;
+
+    OGRErr      AddToIndex( OGRFeature *poFeature, int iField = -1 ) override;
+    OGRErr      RemoveFromIndex( OGRFeature *poFeature ) override;
+
+    OGRAttrIndex *GetFieldIndex( int iField ) override;
+
+    /* custom to OGRMemLayerAttrIndex */
+    bool        HasIndexes() const { return !apoIndexes.empty(); }
+    void        FieldDeleted( int iField );
+    void        FieldsReordered( const int *panMap );
+    void        FieldTypeAltered( int iField );
+};
+
+/************************************************************************/
+/*                        OGRMemLayerAttrIndex()                        */
+/************************************************************************/
+
+OGRMemLayerAttrIndex::OGRMemLayerAttrIndex( OGRMemLayer *poMemLayerIn ) :
+    poMemLayer(poMemLayerIn)
+{
+    poLayer = poMemLayerIn;
+}
+
+/************************************************************************/
+/*                             Initialize()                             */
+/************************************************************************/
+
+OGRErr OGRMemLayerAttrIndex::Initialize( const char * /* pszIndexPath */,
+                                         OGRLayer * /* poLayer */ )
+
+{
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            CreateIndex()                             */
+/*                                                                      */
+/*      Create an index corresponding to the indicated field, but do    */
+/*      not populate it.  Use IndexAllFeatures() for that.              */
+/************************************************************************/
+
+OGRErr OGRMemLayerAttrIndex::CreateIndex( int iField )
+
+{
+    OGRFieldDefn *poFldDefn = poLayer->GetLayerDefn()->GetFieldDefn(iField);
+
+    if( GetFieldIndex(iField) != nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "It seems we already have an index for field %d/%s\n"
+                  "of layer %s.",
+                  iField, poFldDefn->GetNameRef(),
+                  poLayer->GetLayerDefn()->GetName() );
+        return OGRERR_FAILURE;
+    }
+
+    if( !OGRMemAttrIndex::IsTypeSupported( poFldDefn->GetType() ) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Indexing not support for the field type of field %s.",
+                  poFldDefn->GetNameRef() );
+        return OGRERR_FAILURE;
+    }
+
+    apoIndexes.emplace_back(
+        new OGRMemAttrIndex( iField, poFldDefn->GetType() ) );
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                             DropIndex()                              */
+/************************************************************************/
+
+OGRErr OGRMemLayerAttrIndex::DropIndex( int iField )
+
+{
+    for( auto oIter = apoIndexes.begin(); oIter != apoIndexes.end(); ++oIter )
+    {
+        if( (*oIter)->iField == iField )
+        {
+            apoIndexes.erase( oIter );
+            return OGRERR_NONE;
+        }
+    }
+
+    OGRFieldDefn *poFldDefn = poLayer->GetLayerDefn()->GetFieldDefn(iField);
+    CPLError( CE_Failure, CPLE_AppDefined,
+              "DROP INDEX on field (%s) that doesn't have an index.",
+              poFldDefn->GetNameRef() );
+    return OGRERR_FAILURE;
+}
+
+/************************************************************************/
+/*                          IndexAllFeatures()                          */
+/*                                                                      */
+/*      The stored features are indexed directly, so that the filters   */
+/*      of the layer do not apply.                                      */
+/************************************************************************/
+
+OGRErr OGRMemLayerAttrIndex::IndexAllFeatures( int iField )
+
+{
+    OGRErr eErr = OGRERR_NONE;
+    IOGRMemLayerFeatureIterator *poIter = poMemLayer->GetIterator();
+    OGRFeature *poFeature = nullptr;
+    while( eErr == OGRERR_NONE && (poFeature = poIter->Next()) != nullptr )
+    {
+        eErr = AddToIndex( poFeature, iField );
+    }
+    delete poIter;
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         GetFieldAttrIndex()                          */
+/************************************************************************/
+
+OGRAttrIndex *OGRMemLayerAttrIndex::GetFieldIndex( int iField )
+
+{
+    for( const auto& poIndex : apoIndexes )
+    {
+        if( poIndex->iField == iField )
+            return poIndex.get();
+    }
+
+    return nullptr;
+}
+
+/************************************************************************/
+/*                             AddToIndex()                             */
+/************************************************************************/
+
+OGRErr OGRMemLayerAttrIndex::AddToIndex( OGRFeature *poFeature,
+                                         int iTargetField )
+
+{
+    OGRErr eErr = OGRERR_NONE;
+
+    if( poFeature->GetFID() == OGRNullFID )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Attempt to index feature with no FID." );
+        return OGRERR_FAILURE;
+    }
+
+    for( size_t i = 0; i < apoIndexes.size() && eErr == OGRERR_NONE; i++ )
+    {
+        const int iField = apoIndexes[i]->iField;
+
+        if( iTargetField != -1 && iTargetField != iField )
+            continue;
+
+        if( !poFeature->IsFieldSetAndNotNull( iField ) )
+            continue;
+
+        eErr =
+            apoIndexes[i]->AddEntry( poFeature->GetRawFieldRef( iField ),
+                                     poFeature->GetFID() );
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          RemoveFromIndex()                           */
+/************************************************************************/
+
+OGRErr OGRMemLayerAttrIndex::RemoveFromIndex( OGRFeature *poFeature )
+
+{
+    for( const auto& poIndex : apoIndexes )
+    {
+        if( poFeature->IsFieldSetAndNotNull( poIndex->iField ) )
+        {
+            poIndex->RemoveEntry( poFeature->GetRawFieldRef( poIndex->iField ),
+                                  poFeature->GetFID() );
+        }
+    }
+
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                            FieldDeleted()                            */
+/************************************************************************/
+
+void OGRMemLayerAttrIndex::FieldDeleted( int iField )
+
+{
+    for( size_t i = 0; i < apoIndexes.size(); )
+    {
+        if( apoIndexes[i]->iField == iField )
+        {
+            apoIndexes.erase( apoIndexes.begin() + i );
+            continue;
+        }
+        if( apoIndexes[i]->iField > iField )
+            apoIndexes[i]->iField--;
+        i++;
+    }
+}
+
+/************************************************************************/
+/*                          FieldsReordered()                           */
+/*                                                                      */
+/*      panMap[i] is the previous index of the field now at i.          */
+/************************************************************************/
+
+void OGRMemLayerAttrIndex::FieldsReordered( const int *panMap )
+
+{
+    const int nFieldCount = poLayer->GetLayerDefn()->GetFieldCount();
+    for( const auto& poIndex : apoIndexes )
+    {
+        for( int i = 0; i < nFieldCount; i++ )
+        {
+            if( panMap[i] == poIndex->iField )
+            {
+                poIndex->iField = i;
+                break;
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                          FieldTypeAltered()                          */
+/*                                                                      */
+/*      Re-index the values of a field converted to another type, or    */
+/*      drop its index if the new type cannot be indexed.               */
+/************************************************************************/
+
+void OGRMemLayerAttrIndex::FieldTypeAltered( int iField )
+
+{
+    if( GetFieldIndex(iField) == nullptr )
+        return;
+
+    DropIndex( iField );
+    OGRFieldDefn *poFldDefn = poLayer->GetLayerDefn()->GetFieldDefn(iField);
+    if( OGRMemAttrIndex::IsTypeSupported( poFldDefn->GetType() ) &&
+        CreateIndex( iField ) == OGRERR_NONE &&
+        IndexAllFeatures( iField ) != OGRERR_NONE )
+    {
+        DropIndex( iField );
+    }
+}
+
 /************************************************************************/
 /*                            OGRMemLayer()                             */
 /************************************************************************/
@@ -92,6 +1019,8 @@ OGRMemLayer::OGRMemLayer( const char *pszName, OGRSpatialReference *poSRSIn,
     }
 
     m_oMapFeaturesIter = m_oMapFeatures.begin();
+
+    m_poAttrIndex = new OGRMemLayerAttrIndex(this);
 }
 
 /************************************************************************/
@@ -139,6 +1068,260 @@ void OGRMemLayer::ResetReading()
 {
     m_iNextReadFID = 0;
     m_oMapFeaturesIter = m_oMapFeatures.begin();
+
+    m_bCandidatesComputed = false;
+    m_bUseCandidates = false;
+    m_anCandidateFIDs.clear();
+    m_iNextCandidate = 0;
+}
+
+/************************************************************************/
+/*                          SetSpatialIndex()                           */
+/************************************************************************/
+
+void OGRMemLayer::SetSpatialIndex( bool bSpatialIndexIn )
+
+{
+    m_bSpatialIndex = bSpatialIndexIn;
+    if( !m_bSpatialIndex )
+        m_apoSpatialIndexes.clear();
+    ResetReading();
+}
+
+/************************************************************************/
+/*                          GetStoredFeature()                          */
+/************************************************************************/
+
+OGRFeature *OGRMemLayer::GetStoredFeature( GIntBig nFID ) const
+
+{
+    if( nFID < 0 )
+        return nullptr;
+
+    if( m_papoFeatures != nullptr )
+    {
+        if( nFID >= m_nMaxFeatureCount )
+            return nullptr;
+        return m_papoFeatures[nFID];
+    }
+
+    const auto oIter = m_oMapFeatures.find(nFID);
+    if( oIter != m_oMapFeatures.end() )
+        return oIter->second;
+    return nullptr;
+}
+
+/************************************************************************/
+/*                         GetStoredEnvelope()                          */
+/*                                                                      */
+/*      Envelope of a geometry of a stored feature, or of a feature     */
+/*      being stored. The latter is enlarged in FLOAT32 mode, as the    */
+/*      geometry read back may differ by the rounding of coordinates.   */
+/************************************************************************/
+
+bool OGRMemLayer::GetStoredEnvelope( OGRFeature *poFeature, int iGeomField,
+                                     OGREnvelope& sEnvelope ) const
+
+{
+    const OGRGeometry *poGeom = poFeature->GetGeomFieldRef(iGeomField);
+    if( poGeom == nullptr && m_bFloat32Coordinates &&
+        m_oMapEncodedGeoms.find(poFeature->GetFID()) !=
+            m_oMapEncodedGeoms.end() )
+    {
+        OGRFeature *poDecoded = poFeature->Clone();
+        DecodeGeometries(poDecoded);
+        const bool bRet =
+            GetStoredEnvelope(poDecoded, iGeomField, sEnvelope);
+        delete poDecoded;
+        return bRet;
+    }
+    if( poGeom == nullptr || poGeom->IsEmpty() )
+        return false;
+
+    poGeom->getEnvelope(&sEnvelope);
+    return true;
+}
+
+/************************************************************************/
+/*                          GetSpatialIndex()                           */
+/*                                                                      */
+/*      Return the spatial index of a geometry field, building it if    */
+/*      needed.                                                         */
+/************************************************************************/
+
+OGRMemSpatialIndex *OGRMemLayer::GetSpatialIndex( int iGeomField )
+
+{
+    if( !m_bSpatialIndex || iGeomField < 0 ||
+        iGeomField >= m_poFeatureDefn->GetGeomFieldCount() )
+        return nullptr;
+
+    try
+    {
+        if( static_cast<size_t>(iGeomField) >= m_apoSpatialIndexes.size() )
+            m_apoSpatialIndexes.resize(iGeomField + 1);
+        if( m_apoSpatialIndexes[iGeomField] == nullptr )
+        {
+            std::vector<std::pair<GIntBig, OGREnvelope>> aoEntries;
+            aoEntries.reserve(static_cast<size_t>(m_nFeatureCount));
+            IOGRMemLayerFeatureIterator *poIter = GetIterator();
+            OGRFeature *poFeature = nullptr;
+            while( (poFeature = poIter->Next()) != nullptr )
+            {
+                OGREnvelope sEnvelope;
+                if( GetStoredEnvelope(poFeature, iGeomField, sEnvelope) )
+                    aoEntries.emplace_back(poFeature->GetFID(), sEnvelope);
+            }
+            delete poIter;
+
+            std::unique_ptr<OGRMemSpatialIndex> poIndex(
+                new OGRMemSpatialIndex());
+            poIndex->Build(aoEntries);
+            m_apoSpatialIndexes[iGeomField] = std::move(poIndex);
+        }
+    }
+    catch( const std::bad_alloc & )
+    {
+        // Fall back to scanning the features.
+        return nullptr;
+    }
+
+    return m_apoSpatialIndexes[iGeomField].get();
+}
+
+/************************************************************************/
+/*                          GetMemAttrIndex()                           */
+/************************************************************************/
+
+OGRMemLayerAttrIndex *OGRMemLayer::GetMemAttrIndex() const
+
+{
+    return static_cast<OGRMemLayerAttrIndex *>(m_poAttrIndex);
+}
+
+/************************************************************************/
+/*                            AddToIndexes()                            */
+/*                                                                      */
+/*      poSourceFeature is the feature passed to SetFeature(), which    */
+/*      still has all its geometries in FLOAT32 mode.                   */
+/************************************************************************/
+
+void OGRMemLayer::AddToIndexes( OGRFeature *poStoredFeature,
+                                OGRFeature *poSourceFeature )
+
+{
+    GetMemAttrIndex()->AddToIndex(poStoredFeature);
+
+    for( size_t i = 0; i < m_apoSpatialIndexes.size(); ++i )
+    {
+        if( m_apoSpatialIndexes[i] == nullptr )
+            continue;
+
+        OGREnvelope sEnvelope;
+        if( !GetStoredEnvelope(poSourceFeature, static_cast<int>(i),
+                               sEnvelope) )
+            continue;
+        if( m_bFloat32Coordinates )
+        {
+            // Coordinates are offsets to the center of the geometry
+            // envelope, rounded to 24 significant bits.
+            const double dfMarginX = (sEnvelope.MaxX - sEnvelope.MinX) * 1e-6;
+            const double dfMarginY = (sEnvelope.MaxY - sEnvelope.MinY) * 1e-6;
+            sEnvelope.MinX -= dfMarginX;
+            sEnvelope.MaxX += dfMarginX;
+            sEnvelope.MinY -= dfMarginY;
+            sEnvelope.MaxY += dfMarginY;
+        }
+        if( !m_apoSpatialIndexes[i]->Insert(poStoredFeature->GetFID(),
+                                            sEnvelope) )
+        {
+            // Rebuilt on next use.
+            m_apoSpatialIndexes[i].reset();
+        }
+    }
+}
+
+/************************************************************************/
+/*                         RemoveFromIndexes()                          */
+/************************************************************************/
+
+void OGRMemLayer::RemoveFromIndexes( OGRFeature *poStoredFeature )
+
+{
+    GetMemAttrIndex()->RemoveFromIndex(poStoredFeature);
+
+    for( auto& poIndex: m_apoSpatialIndexes )
+    {
+        if( poIndex != nullptr && !poIndex->AddStaleEntry() )
+            poIndex.reset();
+    }
+}
+
+/************************************************************************/
+/*                         ComputeCandidates()                          */
+/*                                                                      */
+/*      Query the spatial index and the attribute indexes for the       */
+/*      features that may match the filters of the layer.               */
+/************************************************************************/
+
+void OGRMemLayer::ComputeCandidates()
+
+{
+    m_bCandidatesComputed = true;
+    m_bUseCandidates = false;
+    m_anCandidateFIDs.clear();
+    m_iNextCandidate = 0;
+
+    if( m_poFilterGeom != nullptr )
+    {
+        OGRMemSpatialIndex *poIndex = GetSpatialIndex(m_iGeomFieldFilter);
+        if( poIndex != nullptr )
+        {
+            try
+            {
+                poIndex->Search(m_sFilterEnvelope, m_anCandidateFIDs);
+                m_bUseCandidates = true;
+            }
+            catch( const std::bad_alloc & )
+            {
+                m_anCandidateFIDs.clear();
+            }
+        }
+    }
+
+    if( m_poAttrQuery != nullptr && GetMemAttrIndex()->HasIndexes() )
+    {
+        GIntBig *panFIDs = m_poAttrQuery->EvaluateAgainstIndices(this, nullptr);
+        if( panFIDs != nullptr )
+        {
+            size_t nFIDCount = 0;
+            while( panFIDs[nFIDCount] != OGRNullFID )
+                nFIDCount++;
+            try
+            {
+                if( m_bUseCandidates )
+                {
+                    std::vector<GIntBig> anIntersection;
+                    std::set_intersection(
+                        m_anCandidateFIDs.begin(), m_anCandidateFIDs.end(),
+                        panFIDs, panFIDs + nFIDCount,
+                        std::back_inserter(anIntersection));
+                    m_anCandidateFIDs.swap(anIntersection);
+                }
+                else
+                {
+                    m_anCandidateFIDs.assign(panFIDs, panFIDs + nFIDCount);
+                    m_bUseCandidates = true;
+                }
+            }
+            catch( const std::bad_alloc & )
+            {
+                m_anCandidateFIDs.clear();
+                m_bUseCandidates = false;
+            }
+            CPLFree(panFIDs);
+        }
+    }
 }
 
 /************************************************************************/
@@ -148,10 +1331,24 @@ void OGRMemLayer::ResetReading()
 OGRFeature *OGRMemLayer::GetNextFeature()
 
 {
+    if( !m_bCandidatesComputed )
+        ComputeCandidates();
+
     while( true )
     {
         OGRFeature *poFeature = nullptr;
-        if( m_papoFeatures )
+        if( m_bUseCandidates )
+        {
+            if( m_iNextCandidate >= m_anCandidateFIDs.size() )
+                return nullptr;
+            // The feature may have been deleted since the indexes were
+            // queried.
+            poFeature =
+                GetStoredFeature(m_anCandidateFIDs[m_iNextCandidate++]);
+            if( poFeature == nullptr )
+                continue;
+        }
+        else if( m_papoFeatures )
         {
             if( m_iNextReadFID >= m_nMaxFeatureCount )
                 return nullptr;
@@ -169,6 +1366,24 @@ OGRFeature *OGRMemLayer::GetNextFeature()
             break;
         }
 
+        if( m_bFloat32Coordinates )
+        {
+            // Filters must be evaluated on the decoded geometries.
+            poFeature = poFeature->Clone();
+            DecodeGeometries(poFeature);
+            if( (m_poFilterGeom == nullptr ||
+                 FilterGeometry(
+                     poFeature->GetGeomFieldRef(m_iGeomFieldFilter)) )
+                && (m_poAttrQuery == nullptr ||
+                    m_poAttrQuery->Evaluate(poFeature)) )
+            {
+                m_nFeaturesRead++;
+                return poFeature;
+            }
+            delete poFeature;
+            continue;
+        }
+
         if( (m_poFilterGeom == nullptr ||
              FilterGeometry(poFeature->GetGeomFieldRef(m_iGeomFieldFilter)) )
             && (m_poAttrQuery == nullptr ||
@@ -208,26 +1423,14 @@ OGRErr OGRMemLayer::SetNextByIndex( GIntBig nIndex )
 OGRFeature *OGRMemLayer::GetFeature( GIntBig nFeatureId )
 
 {
-    if( nFeatureId < 0 )
-        return nullptr;
-
-    OGRFeature *poFeature = nullptr;
-    if( m_papoFeatures != nullptr )
-    {
-        if( nFeatureId >= m_nMaxFeatureCount )
-            return nullptr;
-        poFeature = m_papoFeatures[nFeatureId];
-    }
-    else
-    {
-        FeatureIterator oIter = m_oMapFeatures.find(nFeatureId);
-        if( oIter != m_oMapFeatures.end() )
-            poFeature = oIter->second;
-    }
+    OGRFeature *poFeature = GetStoredFeature(nFeatureId);
     if( poFeature == nullptr )
         return nullptr;
 
-    return poFeature->Clone();
+    poFeature = poFeature->Clone();
+    if( m_bFloat32Coordinates )
+        DecodeGeometries(poFeature);
+    return poFeature;
 }
 
 /************************************************************************/
@@ -297,6 +1500,21 @@ OGRErr OGRMemLayer::ISetFeature( OGRFeature *poFeature )
     if( poFeatureCloned == nullptr )
         return OGRERR_FAILURE;
 
+    std::vector<GByte> abyEncoded;
+    if( m_bFloat32Coordinates )
+    {
+        try
+        {
+            EncodeGeometries(poFeatureCloned, abyEncoded);
+        }
+        catch( const std::bad_alloc & )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory, "Cannot allocate memory");
+            delete poFeatureCloned;
+            return OGRERR_FAILURE;
+        }
+    }
+
     if( m_papoFeatures != nullptr && nFID > 100000 &&
         nFID > m_nMaxFeatureCount + 1000 )
     {
@@ -368,6 +1586,7 @@ OGRErr OGRMemLayer::ISetFeature( OGRFeature *poFeature )
 
         if( m_papoFeatures[nFID] != nullptr )
         {
+            RemoveFromIndexes(m_papoFeatures[nFID]);
             delete m_papoFeatures[nFID];
             m_papoFeatures[nFID] = nullptr;
         }
@@ -383,6 +1602,7 @@ OGRErr OGRMemLayer::ISetFeature( OGRFeature *poFeature )
         FeatureIterator oIter = m_oMapFeatures.find(nFID);
         if( oIter != m_oMapFeatures.end() )
         {
+            RemoveFromIndexes(oIter->second);
             delete oIter->second;
             oIter->second = poFeatureCloned;
         }
@@ -413,6 +1633,28 @@ OGRErr OGRMemLayer::ISetFeature( OGRFeature *poFeature )
         }
     }
 
+    if( abyEncoded.empty() )
+    {
+        m_oMapEncodedGeoms.erase(nFID);
+    }
+    else
+    {
+        try
+        {
+            m_oMapEncodedGeoms[nFID].swap(abyEncoded);
+        }
+        catch( const std::bad_alloc & )
+        {
+            // The feature is stored, but without its geometries.
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate memory");
+            AddToIndexes(poFeatureCloned, poFeatureCloned);
+            return OGRERR_FAILURE;
+        }
+    }
+
+    AddToIndexes(poFeatureCloned, poFeature);
+
     m_bUpdated = true;
 
     return OGRERR_NONE;
@@ -476,6 +1718,7 @@ OGRErr OGRMemLayer::DeleteFeature( GIntBig nFID )
         {
             return OGRERR_FAILURE;
         }
+        RemoveFromIndexes(m_papoFeatures[nFID]);
         delete m_papoFeatures[nFID];
         m_papoFeatures[nFID] = nullptr;
     }
@@ -486,9 +1729,11 @@ OGRErr OGRMemLayer::DeleteFeature( GIntBig nFID )
         {
             return OGRERR_FAILURE;
         }
+        RemoveFromIndexes(oIter->second);
         delete oIter->second;
         m_oMapFeatures.erase(oIter);
     }
+    m_oMapEncodedGeoms.erase(nFID);
 
     m_bHasHoles = true;
     --m_nFeatureCount;
@@ -534,7 +1779,7 @@ int OGRMemLayer::TestCapability( const char *pszCap )
         return m_poFilterGeom == nullptr && m_poAttrQuery == nullptr;
 
     else if( EQUAL(pszCap, OLCFastSpatialFilter) )
-        return FALSE;
+        return m_bSpatialIndex;
 
     else if( EQUAL(pszCap, OLCDeleteFeature) )
         return m_bUpdatable;
@@ -640,6 +1885,8 @@ OGRErr OGRMemLayer::DeleteField( int iField )
 
     m_bUpdated = true;
 
+    GetMemAttrIndex()->FieldDeleted(iField);
+
     return m_poFeatureDefn->DeleteFieldDefn(iField);
 }
 
@@ -672,6 +1919,8 @@ OGRErr OGRMemLayer::ReorderFields( int *panMap )
 
     m_bUpdated = true;
 
+    GetMemAttrIndex()->FieldsReordered(panMap);
+
     return m_poFeatureDefn->ReorderFieldDefns(panMap);
 }
 
@@ -801,6 +2050,8 @@ OGRErr OGRMemLayer::AlterFieldDefn( int iField, OGRFieldDefn *poNewFieldDefn,
         poFieldDefn->SetSubType(OFSTNone);
         poFieldDefn->SetType(poNewFieldDefn->GetType());
         poFieldDefn->SetSubType(poNewFieldDefn->GetSubType());
+
+        GetMemAttrIndex()->FieldTypeAltered(iField);
     }
 
     if( nFlagsIn & ALTER_NAME_FLAG )
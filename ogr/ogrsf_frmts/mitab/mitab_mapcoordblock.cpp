@@ -36,6 +36,8 @@
 #include <climits>
 #include <cstddef>
 #include <algorithm>
+#include <exception>
+#include <vector>
 
 #include "mitab_priv.h"
 #include "mitab_utils.h"
@@ -351,29 +353,55 @@ int     TABMAPCoordBlock::ReadIntCoord(GBool bCompressed,
 int     TABMAPCoordBlock::ReadIntCoords(GBool bCompressed, int numCoordPairs,
                                         GInt32 *panXY)
 {
-    int i, numValues = numCoordPairs*2;
+    if (numCoordPairs <= 0)
+        return 0;
+    if (numCoordPairs > INT_MAX / 8)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "ReadIntCoords(): invalid number of coordinates: %d",
+                 numCoordPairs);
+        return -1;
+    }
+    const int numValues = numCoordPairs*2;
 
+    // Read all the values at once (ReadBytes() follows the chain of
+    // coordinate blocks) and decode them in place.
     if (bCompressed)
     {
-        for(i=0; i<numValues; i+=2)
+        std::vector<GInt16> anValues;
+        try
+        {
+            anValues.resize(numValues);
+        }
+        catch( const std::exception& )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "ReadIntCoords(): cannot allocate %d values", numValues);
+            return -1;
+        }
+        if (ReadBytes(numValues * 2,
+                      reinterpret_cast<GByte*>(anValues.data())) != 0)
+            return -1;
+        for(int i=0; i<numValues; i+=2)
         {
-            panXY[i]   = ReadInt16();
-            panXY[i+1] = ReadInt16();
+#ifdef CPL_MSB
+            CPL_SWAP16PTR(&anValues[i]);
+            CPL_SWAP16PTR(&anValues[i+1]);
+#endif
+            panXY[i]   = anValues[i];
+            panXY[i+1] = anValues[i+1];
             TABSaturatedAdd(panXY[i], m_nComprOrgX);
             TABSaturatedAdd(panXY[i+1], m_nComprOrgY);
-            if (CPLGetLastErrorType() == CE_Failure)
-                return -1;
         }
     }
     else
     {
-        for(i=0; i<numValues; i+=2)
-        {
-            panXY[i]   = ReadInt32();
-            panXY[i+1] = ReadInt32();
-            if (CPLGetLastErrorType() == CE_Failure)
-                return -1;
-        }
+        if (ReadBytes(numValues * 4, reinterpret_cast<GByte*>(panXY)) != 0)
+            return -1;
+#ifdef CPL_MSB
+        for(int i=0; i<numValues; i++)
+            CPL_SWAP32PTR(&panXY[i]);
+#endif
     }
 
     return 0;
@@ -187,6 +187,7 @@ int TABMAPFile::Open(const char *pszFname, TABAccess eAccess,
     fp = VSIFOpenL(pszFname, pszAccess);
 
     m_oBlockManager.Reset();
+    m_oBlockCache.Reset();
 
     if (fp != nullptr && (m_eAccessMode == TABRead || m_eAccessMode == TABReadWrite))
     {
@@ -217,6 +218,8 @@ int TABMAPFile::Open(const char *pszFname, TABAccess eAccess,
             return -1;
         }
         m_oBlockManager.SetBlockSize(cpl::down_cast<TABMAPHeaderBlock*>(poBlock)->m_nRegularBlockSize);
+        if (m_eAccessMode == TABRead)
+            m_oBlockCache.Init(fp, cpl::down_cast<TABMAPHeaderBlock*>(poBlock)->m_nRegularBlockSize);
     }
     else if (fp != nullptr && m_eAccessMode == TABWrite)
     {
@@ -481,6 +484,8 @@ int TABMAPFile::Close()
         m_poToolDefTable = nullptr;
     }
 
+    m_oBlockCache.Reset();
+
     // Close file
     if (m_fp)
         VSIFCloseL(m_fp);
@@ -698,6 +703,36 @@ TABRawBinBlock *TABMAPFile::PushBlock( int nFileOffset )
     return poBlock;
 }
 
+/************************************************************************/
+/*                       PrefetchIndexChildren()                        */
+/*                                                                      */
+/*      In read mode, load in the block cache the children of an        */
+/*      index block that match the spatial filter, so that they are     */
+/*      fetched with as few reads as possible.                          */
+/************************************************************************/
+
+void TABMAPFile::PrefetchIndexChildren( TABMAPIndexBlock *poIndex )
+
+{
+    if( poIndex == nullptr || !m_oBlockCache.IsEnabledFor(m_fp) )
+        return;
+
+    std::vector<int> anOffsets;
+    for( int iEntry = 0; iEntry < poIndex->GetNumEntries(); iEntry++ )
+    {
+        TABMAPIndexEntry *psEntry = poIndex->GetEntry( iEntry );
+        if( psEntry->XMax < m_XMinFilter
+            || psEntry->YMax < m_YMinFilter
+            || psEntry->XMin > m_XMaxFilter
+            || psEntry->YMin > m_YMaxFilter )
+            continue;
+        anOffsets.push_back( psEntry->nBlockPtr );
+    }
+
+    if( anOffsets.size() > 1 )
+        m_oBlockCache.Prefetch( anOffsets );
+}
+
 /************************************************************************/
 /*                    LoadNextMatchingObjectBlock()                     */
 /*                                                                      */
@@ -733,6 +768,7 @@ int TABMAPFile::LoadNextMatchingObjectBlock( int bFirstObject )
                 return TRUE;
             }
         }
+        PrefetchIndexChildren( m_poSpIndex );
     }
 
     while( m_poSpIndexLeaf != nullptr )
@@ -772,6 +808,7 @@ int TABMAPFile::LoadNextMatchingObjectBlock( int bFirstObject )
             return TRUE;
         else {
             /* continue processing new index block */
+            PrefetchIndexChildren( m_poSpIndexLeaf );
         }
     }
 
@@ -2479,6 +2516,7 @@ TABMAPCoordBlock *TABMAPFile::GetCoordBlock(int nFileOffset)
         m_poCurCoordBlock = new TABMAPCoordBlock(m_eAccessMode);
         m_poCurCoordBlock->InitNewBlock(m_fp, m_poHeader->m_nRegularBlockSize);
         m_poCurCoordBlock->SetMAPBlockManagerRef(&m_oBlockManager);
+        m_poCurCoordBlock->SetBlockCacheRef(&m_oBlockCache);
     }
 
     /*-----------------------------------------------------------------
@@ -2552,7 +2590,21 @@ TABRawBinBlock *TABMAPFile::GetIndexObjectBlock( int nFileOffset )
      *---------------------------------------------------------------*/
     GByte* pabyData = static_cast<GByte*>(CPLMalloc(m_poHeader->m_nRegularBlockSize));
 
-    if (VSIFSeekL(m_fp, nFileOffset, SEEK_SET) != 0
+    if (m_oBlockCache.IsEnabledFor(m_fp))
+    {
+        if (m_oBlockCache.ReadBlock(nFileOffset,
+                                    m_poHeader->m_nRegularBlockSize,
+                                    pabyData) !=
+                                        m_poHeader->m_nRegularBlockSize)
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "GetIndexBlock() failed reading %d bytes at offset %d.",
+                     m_poHeader->m_nRegularBlockSize, nFileOffset);
+            CPLFree(pabyData);
+            return nullptr;
+        }
+    }
+    else if (VSIFSeekL(m_fp, nFileOffset, SEEK_SET) != 0
         || static_cast<int>(VSIFReadL(pabyData, sizeof(GByte), m_poHeader->m_nRegularBlockSize, m_fp)) !=
                         m_poHeader->m_nRegularBlockSize )
     {
@@ -34,10 +34,12 @@
 #define MITAB_PRIV_H_INCLUDED_
 
 #include "cpl_conv.h"
+#include "cpl_mem_cache.h"
 #include "cpl_string.h"
 #include "ogr_feature.h"
 
 #include <set>
+#include <vector>
 
 class TABFile;
 class TABFeature;
@@ -790,6 +792,37 @@ class TABBinBlockManager
     void        SetName(const char* pszName);
 };
 
+/*---------------------------------------------------------------------
+ *                      class TABBinBlockCache
+ *
+ * LRU cache of the raw content of the blocks of a .MAP file opened
+ * in read-only mode, shared by the blocks of that file. Also able to
+ * prefetch a set of blocks with as few reads as possible.
+ *--------------------------------------------------------------------*/
+class TABBinBlockCache
+{
+    CPL_DISALLOW_COPY_ASSIGN(TABBinBlockCache)
+
+  protected:
+    VSILFILE    *m_fp;
+    int         m_nBlockSize;
+    int         m_nFileSize;
+    lru11::Cache<int, std::vector<GByte>> m_oCache;
+
+  public:
+    TABBinBlockCache();
+
+    void        Init(VSILFILE *fp, int nBlockSize);
+    void        Reset();
+
+    GBool       IsEnabledFor(VSILFILE *fp) const
+                        { return m_fp != nullptr && m_fp == fp; }
+    int         GetFileSize() const { return m_nFileSize; }
+
+    int         ReadBlock(int nOffset, int nSize, GByte *pabyDstBuf);
+    void        Prefetch(std::vector<int> &anOffsets);
+};
+
 /*---------------------------------------------------------------------
  *                      class TABRawBinBlock
  *
@@ -820,6 +853,8 @@ class TABRawBinBlock
 
     int         m_bModified;     /* Used only to detect changes        */
 
+    TABBinBlockCache *m_poBlockCache; /* Shared cache used in read mode */
+
   public:
     TABRawBinBlock(TABAccess eAccessMode = TABRead,
                    GBool bHardBlockSize = TRUE);
@@ -850,6 +885,8 @@ class TABRawBinBlock
                                GBool bForceReadFromFile = FALSE,
                                GBool bOffsetIsEndOfData = FALSE);
     void        SetFirstBlockPtr(int nOffset);
+    void        SetBlockCacheRef(TABBinBlockCache *poCache)
+                                            { m_poBlockCache = poCache; }
 
     int         GetNumUnusedBytes();
     int         GetFirstUnusedByteOffset();
@@ -1370,6 +1407,7 @@ class TABMAPFile
     TABAccess   m_eAccessMode;
 
     TABBinBlockManager m_oBlockManager{};
+    TABBinBlockCache   m_oBlockCache{};
 
     TABMAPHeaderBlock   *m_poHeader;
 
@@ -1429,6 +1467,7 @@ class TABMAPFile
 
     int         LoadNextMatchingObjectBlock(int bFirstObject);
     TABRawBinBlock *PushBlock( int nFileOffset );
+    void        PrefetchIndexChildren( TABMAPIndexBlock *poIndex );
 
     int         ReOpenReadWrite();
 
@@ -71,7 +71,8 @@ TABRawBinBlock::TABRawBinBlock( TABAccess eAccessMode /*= TABRead*/,
     m_nCurPos(0),
     m_nFirstBlockPtr(0),
     m_nFileSize(-1),
-    m_bModified(FALSE)
+    m_bModified(FALSE),
+    m_poBlockCache(nullptr)
 {}
 
 /**********************************************************************
@@ -105,8 +106,18 @@ int     TABRawBinBlock::ReadFromFile(VSILFILE *fpSrc, int nOffset,
 
     m_fp = fpSrc;
 
-    VSIFSeekL(fpSrc, 0, SEEK_END);
-    m_nFileSize = static_cast<int>(VSIFTellL(m_fp));
+    const bool bUseCache = m_poBlockCache != nullptr &&
+                           m_eAccess == TABRead &&
+                           m_poBlockCache->IsEnabledFor(fpSrc);
+    if (bUseCache)
+    {
+        m_nFileSize = m_poBlockCache->GetFileSize();
+    }
+    else
+    {
+        VSIFSeekL(fpSrc, 0, SEEK_END);
+        m_nFileSize = static_cast<int>(VSIFTellL(m_fp));
+    }
 
     m_nFileOffset = nOffset;
     m_nCurPos = 0;
@@ -120,8 +131,12 @@ int     TABRawBinBlock::ReadFromFile(VSILFILE *fpSrc, int nOffset,
     /*----------------------------------------------------------------
      * Read from the file
      *---------------------------------------------------------------*/
-    if (VSIFSeekL(fpSrc, nOffset, SEEK_SET) != 0 ||
-        (m_nSizeUsed = static_cast<int>(VSIFReadL(pabyBuf, sizeof(GByte), nSize, fpSrc)) ) == 0 ||
+    if (bUseCache)
+        m_nSizeUsed = m_poBlockCache->ReadBlock(nOffset, nSize, pabyBuf);
+    if ((!bUseCache &&
+         (VSIFSeekL(fpSrc, nOffset, SEEK_SET) != 0 ||
+          (m_nSizeUsed = static_cast<int>(VSIFReadL(pabyBuf, sizeof(GByte), nSize, fpSrc)) ) == 0)) ||
+        m_nSizeUsed == 0 ||
         (m_bHardBlockSize && m_nSizeUsed != nSize ) )
     {
         CPLError(CE_Failure, CPLE_FileIO,
@@ -1105,6 +1120,161 @@ TABRawBinBlock *TABCreateMAPBlockFromFile(VSILFILE *fpSrc, int nOffset,
     return poBlock;
 }
 
+/*=====================================================================
+ *                      class TABBinBlockCache
+ *====================================================================*/
+
+// Maximum number of blocks kept in memory
+constexpr size_t TAB_BLOCK_CACHE_SIZE = 1024;
+
+// Maximum number of blocks read at once by Prefetch()
+constexpr int TAB_BLOCK_PREFETCH_MAX = 64;
+
+// Blocks to prefetch separated by at most this number of blocks are read
+// together, which is cheaper than an extra seek on high latency storage.
+constexpr int TAB_BLOCK_PREFETCH_MAX_GAP = 4;
+
+/**********************************************************************
+ *                   TABBinBlockCache::TABBinBlockCache()
+ *
+ * Constructor.
+ **********************************************************************/
+TABBinBlockCache::TABBinBlockCache() :
+    m_fp(nullptr),
+    m_nBlockSize(0),
+    m_nFileSize(0),
+    m_oCache(TAB_BLOCK_CACHE_SIZE)
+{}
+
+/**********************************************************************
+ *                   TABBinBlockCache::Init()
+ *
+ * Attach the cache to a file opened in read-only mode.
+ **********************************************************************/
+void TABBinBlockCache::Init(VSILFILE *fp, int nBlockSize)
+{
+    Reset();
+
+    if (fp == nullptr || nBlockSize <= 0)
+        return;
+
+    m_fp = fp;
+    m_nBlockSize = nBlockSize;
+
+    const vsi_l_offset nCurPos = VSIFTellL(m_fp);
+    VSIFSeekL(m_fp, 0, SEEK_END);
+    m_nFileSize = static_cast<int>(VSIFTellL(m_fp));
+    VSIFSeekL(m_fp, nCurPos, SEEK_SET);
+}
+
+/**********************************************************************
+ *                   TABBinBlockCache::Reset()
+ *
+ * Detach the cache from its file and free the cached blocks.
+ **********************************************************************/
+void TABBinBlockCache::Reset()
+{
+    m_fp = nullptr;
+    m_nBlockSize = 0;
+    m_nFileSize = 0;
+    m_oCache.clear();
+}
+
+/**********************************************************************
+ *                   TABBinBlockCache::ReadBlock()
+ *
+ * Copy up to nSize bytes of the block at the specified offset to
+ * pabyDstBuf, reading it from the file if it is not cached.
+ *
+ * Returns the number of bytes copied, which may be less than nSize
+ * for the last block of the file, or 0 on error.
+ **********************************************************************/
+int TABBinBlockCache::ReadBlock(int nOffset, int nSize, GByte *pabyDstBuf)
+{
+    if (m_fp == nullptr)
+        return 0;
+
+    if (nSize == m_nBlockSize && m_oCache.contains(nOffset))
+    {
+        const std::vector<GByte> &abyBlock = m_oCache.get(nOffset);
+        memcpy(pabyDstBuf, abyBlock.data(), abyBlock.size());
+        return static_cast<int>(abyBlock.size());
+    }
+
+    if (VSIFSeekL(m_fp, nOffset, SEEK_SET) != 0)
+        return 0;
+    const int nRead = static_cast<int>(
+        VSIFReadL(pabyDstBuf, sizeof(GByte), nSize, m_fp));
+
+    if (nSize == m_nBlockSize && nRead > 0)
+    {
+        m_oCache.insert(nOffset,
+                        std::vector<GByte>(pabyDstBuf, pabyDstBuf + nRead));
+    }
+    return nRead;
+}
+
+/**********************************************************************
+ *                   TABBinBlockCache::Prefetch()
+ *
+ * Load the blocks at the specified offsets in the cache, coalescing
+ * neighbouring blocks in a single read.  anOffsets is sorted in place.
+ **********************************************************************/
+void TABBinBlockCache::Prefetch(std::vector<int> &anOffsets)
+{
+    if (m_fp == nullptr)
+        return;
+
+    std::sort(anOffsets.begin(), anOffsets.end());
+
+    std::vector<GByte> abyBuf;
+    size_t i = 0;
+    while (i < anOffsets.size())
+    {
+        if (anOffsets[i] < 0 || anOffsets[i] >= m_nFileSize ||
+            m_oCache.contains(anOffsets[i]))
+        {
+            i++;
+            continue;
+        }
+
+        // Extend the run while the next block to fetch is close enough
+        const int nStart = anOffsets[i];
+        int nEnd = nStart + m_nBlockSize;
+        size_t j = i + 1;
+        for (; j < anOffsets.size(); j++)
+        {
+            if (anOffsets[j] < nEnd)
+                continue;  // duplicate
+            if (anOffsets[j] > nEnd + TAB_BLOCK_PREFETCH_MAX_GAP * m_nBlockSize ||
+                anOffsets[j] + m_nBlockSize - nStart >
+                                    TAB_BLOCK_PREFETCH_MAX * m_nBlockSize ||
+                m_oCache.contains(anOffsets[j]))
+                break;
+            nEnd = anOffsets[j] + m_nBlockSize;
+        }
+
+        abyBuf.resize(nEnd - nStart);
+        if (VSIFSeekL(m_fp, nStart, SEEK_SET) != 0)
+            return;
+        const int nRead = static_cast<int>(
+            VSIFReadL(abyBuf.data(), sizeof(GByte), abyBuf.size(), m_fp));
+
+        // Only cache the requested blocks, not the gaps
+        for (; i < j; i++)
+        {
+            const int nBlockStart = anOffsets[i] - nStart;
+            if (nBlockStart >= nRead || m_oCache.contains(anOffsets[i]))
+                continue;
+            const int nBlockEnd =
+                std::min(nBlockStart + m_nBlockSize, nRead);
+            m_oCache.insert(anOffsets[i],
+                            std::vector<GByte>(abyBuf.data() + nBlockStart,
+                                               abyBuf.data() + nBlockEnd));
+        }
+    }
+}
+
 /*=====================================================================
  *                      class TABBinBlockManager
  *====================================================================*/
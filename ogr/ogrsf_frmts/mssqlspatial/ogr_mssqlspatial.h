@@ -33,6 +33,11 @@
 #include "ogrsf_frmts.h"
 #include "cpl_odbc.h"
 #include "cpl_error.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
 
 #ifdef SQLNCLI_VERSION
 #include <sqlncli.h>
@@ -366,6 +371,23 @@ typedef union {
 
 } BCPData;
 
+/* Feature queued for bulk copy, whose geometry is serialized by a worker */
+struct OGRMSSQLBCPPendingRow
+{
+    std::unique_ptr<OGRFeature> poFeature{};
+    bool                bUseGeometryValidation = false;
+    int                 nGeomColumnType = 0;
+    int                 nSRSId = 0;
+    /* results, valid once bDone is set */
+    GByte              *pabyGeom = nullptr;
+    int                 nGeomSize = 0;
+    bool                bGeomMadeValid = false;
+    OGRErr              eErr = OGRERR_NONE;
+    std::atomic<bool>   bDone{false};
+
+    ~OGRMSSQLBCPPendingRow() { CPLFree(pabyGeom); }
+};
+
 class OGRMSSQLSpatialTableLayer final: public OGRMSSQLSpatialLayer
 {
     bool                bUpdateAccess = true;
@@ -391,6 +413,15 @@ class OGRMSSQLSpatialTableLayer final: public OGRMSSQLSpatialLayer
     BCPData             **papstBindBuffer = nullptr;
 
     int                 bIdentityInsert = FALSE;
+
+    int                 nBCPGeomThreads = 1;
+    std::unique_ptr<CPLJobQueue> poBCPGeomQueue{};
+    std::deque<std::unique_ptr<OGRMSSQLBCPPendingRow>> apoBCPPendingRows{};
+
+    static void         SerializeGeometryBCPFunc( void* pData );
+    OGRErr              SendFeatureBCP( OGRFeature *poFeature,
+                                        OGRMSSQLBCPPendingRow *psRow );
+    OGRErr              SendPendingRowsBCP( size_t nMaxRemaining );
 #endif
 
     void                ClearStatement();
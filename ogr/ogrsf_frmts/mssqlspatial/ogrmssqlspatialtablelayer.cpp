@@ -31,6 +31,8 @@
 #include "ogr_mssqlspatial.h"
 #include "ogr_p.h"
 
+#include <algorithm>
+
 CPL_CVSID("$Id: ogrmssqlspatialtablelayer.cpp d2fd4d4bb6fb8eb665ec0acba6b082ad0ecc5d8c 2019-04-07 19:52:30 +0200 Tamas Szekeres $")
 
 #define UNSUPPORTED_OP_READ_ONLY "%s : unsupported operation on a read-only datasource."
@@ -84,6 +86,9 @@ OGRMSSQLSpatialTableLayer::OGRMSSQLSpatialTableLayer( OGRMSSQLSpatialDataSource
 {
     poDS = poDSIn;
     bUseGeometryValidation = CPLTestBool(CPLGetConfigOption("MSSQLSPATIAL_USE_GEOMETRY_VALIDATION", "YES"));
+#ifdef MSSQL_BCP_SUPPORTED
+    nBCPGeomThreads = std::max(0, atoi(CPLGetConfigOption("MSSQLSPATIAL_BCP_GEOMETRY_THREADS", "1")));
+#endif
 }
 
 /************************************************************************/
@@ -1441,6 +1446,9 @@ void OGRMSSQLSpatialTableLayer::CloseBCP()
     {
         int iCol;
 
+        /* send the rows whose geometry is being serialized */
+        SendPendingRowsBCP(0);
+
         int nRecNum = bcp_done( hDBCBCP );
         if (nRecNum == -1)
             Failed2(nRecNum);
@@ -1683,13 +1691,141 @@ OGRErr OGRMSSQLSpatialTableLayer::CreateFeatureBCP( OGRFeature *poFeature )
         }
     }
 
-    /* do bulk insert here */
+    if ( nBCPGeomThreads == 0 || nGeomColumnIndex < 0 ||
+         poFeature->GetGeometryRef() == nullptr )
+    {
+        /* send the rows queued previously, to preserve insertion order */
+        if ( SendPendingRowsBCP(0) != OGRERR_NONE )
+            return OGRERR_FAILURE;
+        return SendFeatureBCP( poFeature, nullptr );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Queue a copy of the feature, and have its geometry validated    */
+/*      and serialized by a worker thread meanwhile.                    */
+/* -------------------------------------------------------------------- */
+    if ( poBCPGeomQueue == nullptr )
+    {
+        CPLWorkerThreadPool* poPool =
+            CPLGetGlobalWorkerThreadPool(nBCPGeomThreads);
+        if ( poPool == nullptr )
+        {
+            nBCPGeomThreads = 0;
+            return SendFeatureBCP( poFeature, nullptr );
+        }
+        poBCPGeomQueue = poPool->CreateJobQueue();
+    }
+
+    std::unique_ptr<OGRMSSQLBCPPendingRow> psRow(new OGRMSSQLBCPPendingRow());
+    psRow->poFeature.reset(poFeature->Clone());
+    psRow->bUseGeometryValidation = bUseGeometryValidation;
+    psRow->nGeomColumnType = nGeomColumnType;
+    psRow->nSRSId = nSRSId;
+    if ( !poBCPGeomQueue->SubmitJob(SerializeGeometryBCPFunc, psRow.get()) )
+        SerializeGeometryBCPFunc(psRow.get());
+    apoBCPPendingRows.push_back(std::move(psRow));
+
+    /* Send the rows that are ready, and limit the number of queued ones */
+    return SendPendingRowsBCP(static_cast<size_t>(nBCPGeomThreads) * 64);
+}
+
+/************************************************************************/
+/*                      SerializeGeometryBCPFunc()                      */
+/************************************************************************/
+
+void OGRMSSQLSpatialTableLayer::SerializeGeometryBCPFunc( void* pData )
+
+{
+    OGRMSSQLBCPPendingRow* psRow = static_cast<OGRMSSQLBCPPendingRow*>(pData);
+    OGRGeometry *poGeom = psRow->poFeature->GetGeometryRef();
+
+    if (psRow->bUseGeometryValidation)
+    {
+        OGRMSSQLGeometryValidator oValidator(poGeom, psRow->nGeomColumnType);
+        if (!oValidator.IsValid())
+        {
+            oValidator.MakeValid(poGeom);
+            psRow->bGeomMadeValid = true;
+        }
+    }
+
+    OGRMSSQLGeometryWriter poWriter(poGeom, psRow->nGeomColumnType, psRow->nSRSId);
+    psRow->nGeomSize = poWriter.GetDataLen();
+    psRow->pabyGeom = (GByte *) VSI_MALLOC_VERBOSE(psRow->nGeomSize + 1);
+    if (psRow->pabyGeom == nullptr ||
+        poWriter.WriteSqlGeometry(psRow->pabyGeom, psRow->nGeomSize) != OGRERR_NONE)
+    {
+        psRow->eErr = OGRERR_FAILURE;
+    }
+
+    psRow->bDone = true;
+}
+
+/************************************************************************/
+/*                         SendPendingRowsBCP()                         */
+/************************************************************************/
+
+/* Send the queued rows whose geometry is ready, in order, and wait for */
+/* the serialization of the oldest ones until at most nMaxRemaining are */
+/* left in the queue. */
+OGRErr OGRMSSQLSpatialTableLayer::SendPendingRowsBCP( size_t nMaxRemaining )
+
+{
+    OGRErr eErr = OGRERR_NONE;
+    while ( !apoBCPPendingRows.empty() )
+    {
+        OGRMSSQLBCPPendingRow* psRow = apoBCPPendingRows.front().get();
+        if ( !psRow->bDone )
+        {
+            if ( apoBCPPendingRows.size() <= nMaxRemaining )
+                break;
+            while ( !psRow->bDone )
+                poBCPGeomQueue->WaitEvent();
+        }
+
+        if ( eErr == OGRERR_NONE )
+            eErr = SendFeatureBCP( psRow->poFeature.get(), psRow );
+        apoBCPPendingRows.pop_front();
+    }
+    return eErr;
+}
+
+/************************************************************************/
+/*                           SendFeatureBCP()                           */
+/************************************************************************/
+
+/* Send a row to the bulk copy. If psRow is not NULL, its geometry has */
+/* already been serialized. */
+OGRErr OGRMSSQLSpatialTableLayer::SendFeatureBCP( OGRFeature *poFeature,
+                                                  OGRMSSQLBCPPendingRow *psRow )
+
+{
+    int iCol;
+    int iField = 0;
 
     /* prepare data to variables */
-    iField = 0;
     for( iCol = 0; iCol < nRawColumns; iCol++ )
     {
-        if (iCol == nGeomColumnIndex)
+        if (iCol == nGeomColumnIndex && psRow != nullptr)
+        {
+            if (psRow->bGeomMadeValid)
+            {
+                CPLError(CE_Warning, CPLE_NotSupported,
+                    "Geometry with FID = " CPL_FRMT_GIB " has been modified to valid geometry.", poFeature->GetFID());
+            }
+            if (psRow->eErr != OGRERR_NONE)
+                return OGRERR_FAILURE;
+
+            /* the bind buffer takes ownership of the serialized geometry */
+            papstBindBuffer[iCol]->RawData.nSize = psRow->nGeomSize;
+            papstBindBuffer[iCol]->RawData.pData = psRow->pabyGeom;
+            psRow->pabyGeom = nullptr;
+
+            /* set data length */
+            if (Failed2( bcp_collen( hDBCBCP, (DBINT)papstBindBuffer[iCol]->RawData.nSize, iCol + 1) ))
+                return OGRERR_FAILURE;
+        }
+        else if (iCol == nGeomColumnIndex)
         {
             if (poFeature->GetGeometryRef())
             {
@@ -3225,6 +3225,43 @@ class OGRMVTWriterDataset final: public GDALDataset
                 std::set<CPLString> m_oSetFields;
         };
 
+        // Layer statistics gathered while encoding a tile on a worker
+        // thread, applied afterwards to MVTLayerProperties in tile order.
+        class MVTLayerPropertiesDelta
+        {
+            public:
+                std::vector<MVTTileLayerFeature::GeomType> m_aeGeomTypes;
+                std::vector<std::pair<std::string, MVTTileLayerValue>>
+                                                        m_aoKeyValues;
+        };
+
+        class MVTTempTileRow
+        {
+            public:
+                std::string m_osLayer;
+                std::string m_osFeature;
+                double m_dfAreaOrLength = 0.0;
+        };
+
+        // Content of a (z,x,y) tile read from the temporary DB, and result
+        // of its encoding.
+        class MVTEncodeTileJob
+        {
+            public:
+                const OGRMVTWriterDataset* m_poDS = nullptr;
+                int m_nZ = 0;
+                int m_nX = 0;
+                int m_nY = 0;
+                // Ordered by layer and idx. At most m_nMaxFeatures rows.
+                std::vector<MVTTempTileRow> m_aoRows;
+                // Only set when the feature count limit is reached:
+                // the m_nMaxFeatures largest features.
+                std::vector<MVTTempTileRow> m_aoRowsByArea;
+                std::vector<std::string> m_aosLayers;
+                std::vector<MVTLayerPropertiesDelta> m_aoLayerDeltas;
+                std::string m_osTileBuffer;
+        };
+
         std::vector<std::unique_ptr<OGRMVTWriterLayer>> m_apoLayers;
         CPLString                              m_osTempDB;
         mutable std::mutex                     m_oDBMutex;
@@ -3262,6 +3299,7 @@ class OGRMVTWriterDataset final: public GDALDataset
         double                                 m_dfTopY = 0.0;
         double                                 m_dfTileDim0 = 0.0;
         bool                                   m_bReuseTempFile = false; // debug only
+        bool                                   m_bTempDBInTransaction = false;
 
         OGRErr              PreGenerateForTile(int nZ, int nX, int nY,
                                                const CPLString& osTargetName,
@@ -3329,21 +3367,32 @@ class OGRMVTWriterDataset final: public GDALDataset
                         std::map<MVTTileLayerValue, GUInt32>& oMapValueToIdx,
                         MVTLayerProperties* poLayerProperties,
                         GUInt32 nExtent,
-                        unsigned& nFeaturesInTile);
+                        unsigned& nFeaturesInTile,
+                        MVTLayerPropertiesDelta* poLayerPropertiesDelta =
+                                                            nullptr) const;
 
-        std::string EncodeTile(
-                        int nZ, int nX, int nY,
-                        sqlite3_stmt* hStmtLayer,
-                        sqlite3_stmt* hStmtRows,
-                        std::map<CPLString, MVTLayerProperties>& oMapLayerProps,
-                        std::set<CPLString>& oSetLayers,
-                        GIntBig& nTempTilesRead);
+        bool                ReadTileRows(sqlite3_stmt* hStmt,
+                                         int nZ, int nX, int nY,
+                                         std::vector<MVTTempTileRow>& aoRows,
+                                         size_t& nBytes) const;
+
+        void                EncodeTile(MVTEncodeTileJob* poJob) const;
+
+        static void         EncodeTileJobFunc(void* pParam);
 
         std::string RecodeTileLowerResolution(
-                                int nZ, int nX, int nY,
-                                int nExtent,
-                                sqlite3_stmt* hStmtLayer,
-                                sqlite3_stmt* hStmtRows);
+                                const std::vector<MVTTempTileRow>& aoRows,
+                                GUInt32 nExtent) const;
+
+        void                ApplyLayerPropertiesDelta(
+                        const MVTEncodeTileJob& oJob,
+                        std::map<CPLString, MVTLayerProperties>& oMapLayerProps,
+                        std::set<CPLString>& oSetLayers) const;
+
+        bool                WriteTile(int nZ, int nX, int nY,
+                                      const std::string& osTileBuffer,
+                                      sqlite3_stmt* hInsertStmt,
+                                      int& nLastZ, int& nLastX);
 
         bool                CreateOutput();
 
@@ -4797,7 +4846,8 @@ void OGRMVTWriterDataset::EncodeFeature(
                         std::map<MVTTileLayerValue, GUInt32>& oMapValueToIdx,
                         MVTLayerProperties* poLayerProperties,
                         GUInt32 nExtent,
-                        unsigned& nFeaturesInTile)
+                        unsigned& nFeaturesInTile,
+                        MVTLayerPropertiesDelta* poLayerPropertiesDelta) const
 {
     size_t nUncompressedSize = 0;
     void* pCompressed = CPLZLibInflate( pabyBlob, nBlobSize,
@@ -4825,6 +4875,11 @@ void OGRMVTWriterDataset::EncodeFeature(
                 poLayerProperties->
                     m_oCountGeomType[poSrcFeature->getType()] ++;
             }
+            if( poLayerPropertiesDelta )
+            {
+                poLayerPropertiesDelta->m_aeGeomTypes.push_back(
+                                                    poSrcFeature->getType());
+            }
             bool bOK = true;
             if( nExtent < m_nExtent )
             {
@@ -4904,6 +4959,11 @@ void OGRMVTWriterDataset::EncodeFeature(
                                                     osKey,
                                                     oValue);
                         }
+                        if( poLayerPropertiesDelta )
+                        {
+                            poLayerPropertiesDelta->m_aoKeyValues.emplace_back(
+                                                            osKey, oValue);
+                        }
 
                         poFeature->addTag(oMapKeyToIdx[osKey]);
                         poFeature->addTag(oMapValueToIdx[oValue]);
@@ -4925,100 +4985,89 @@ void OGRMVTWriterDataset::EncodeFeature(
     CPLFree(pabyUncompressed);
 }
 
+/************************************************************************/
+/*                            ReadTileRows()                            */
+/************************************************************************/
+
+bool OGRMVTWriterDataset::ReadTileRows(sqlite3_stmt* hStmt,
+                                       int nZ, int nX, int nY,
+                                       std::vector<MVTTempTileRow>& aoRows,
+                                       size_t& nBytes) const
+{
+    sqlite3_bind_int(hStmt, 1, nZ);
+    sqlite3_bind_int(hStmt, 2, nX);
+    sqlite3_bind_int(hStmt, 3, nY);
+    sqlite3_bind_int(hStmt, 4, static_cast<int>(m_nMaxFeatures));
+
+    bool bRet = true;
+    int rc;
+    while( (rc = sqlite3_step(hStmt)) == SQLITE_ROW )
+    {
+        MVTTempTileRow oRow;
+        const char* pszLayerName = reinterpret_cast<const char*>(
+            sqlite3_column_text(hStmt, 0));
+        oRow.m_osLayer = pszLayerName ? pszLayerName : "";
+        const int nBlobSize = sqlite3_column_bytes(hStmt, 1);
+        const char* pabyBlob = static_cast<const char*>(
+            sqlite3_column_blob(hStmt, 1));
+        if( pabyBlob )
+            oRow.m_osFeature.assign(pabyBlob, nBlobSize);
+        oRow.m_dfAreaOrLength = sqlite3_column_double(hStmt, 2);
+        nBytes += oRow.m_osLayer.size() + oRow.m_osFeature.size();
+        aoRows.emplace_back(std::move(oRow));
+    }
+    if( rc != SQLITE_DONE )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Error while reading tile %d/%d/%d from temporary database",
+                 nZ, nX, nY);
+        bRet = false;
+    }
+    sqlite3_reset(hStmt);
+    return bRet;
+}
+
 /************************************************************************/
 /*                            EncodeTile()                              */
 /************************************************************************/
 
-std::string OGRMVTWriterDataset::EncodeTile(
-                        int nZ, int nX, int nY,
-                        sqlite3_stmt* hStmtLayer,
-                        sqlite3_stmt* hStmtRows,
-                        std::map<CPLString, MVTLayerProperties>& oMapLayerProps,
-                        std::set<CPLString>& oSetLayers,
-                        GIntBig& nTempTilesRead)
+void OGRMVTWriterDataset::EncodeTile(MVTEncodeTileJob* poJob) const
 {
     MVTTile oTargetTile;
-
-    sqlite3_bind_int(hStmtLayer, 1, nZ);
-    sqlite3_bind_int(hStmtLayer, 2, nX);
-    sqlite3_bind_int(hStmtLayer, 3, nY);
+    const auto& aoRows = poJob->m_aoRows;
 
     unsigned nFeaturesInTile = 0;
-    const GIntBig nProgressStep = std::max( static_cast<GIntBig>(1),
-                                            m_nTempTiles / 10 );
-
-    while( nFeaturesInTile < m_nMaxFeatures &&
-           sqlite3_step(hStmtLayer) == SQLITE_ROW )
+    for( size_t i = 0; i < aoRows.size() && nFeaturesInTile < m_nMaxFeatures; )
     {
-        const char* pszLayerName = reinterpret_cast<const char*>(
-            sqlite3_column_text(hStmtLayer, 0));
-        sqlite3_bind_int(hStmtRows, 1, nZ);
-        sqlite3_bind_int(hStmtRows, 2, nX);
-        sqlite3_bind_int(hStmtRows, 3, nY); 
-        sqlite3_bind_text(hStmtRows, 4, pszLayerName, -1, SQLITE_STATIC);
-
-        auto oIterMapLayerProps = oMapLayerProps.find(pszLayerName);
-        MVTLayerProperties* poLayerProperties = nullptr;
-        if( oIterMapLayerProps == oMapLayerProps.end() )
-        {
-            if( oSetLayers.size() < knMAX_COUNT_LAYERS )
-            {
-                oSetLayers.insert(pszLayerName);
-                if( oMapLayerProps.size() < knMAX_REPORT_LAYERS )
-                {
-                    MVTLayerProperties props;
-                    props.m_nMinZoom = nZ;
-                    props.m_nMaxZoom = nZ;
-                    oMapLayerProps[pszLayerName] = props;
-                    poLayerProperties = &(oMapLayerProps[pszLayerName]);
-                }
-            }
-        }
-        else
-        {
-            poLayerProperties = &(oIterMapLayerProps->second);
-        }
-        if( poLayerProperties )
-        {
-            poLayerProperties->m_nMinZoom =
-                std::min(nZ, poLayerProperties->m_nMinZoom);
-            poLayerProperties->m_nMaxZoom =
-                std::max(nZ, poLayerProperties->m_nMaxZoom);
-        }
+        const std::string& osLayerName = aoRows[i].m_osLayer;
+        poJob->m_aosLayers.push_back(osLayerName);
+        poJob->m_aoLayerDeltas.emplace_back();
+        MVTLayerPropertiesDelta* poDelta = &poJob->m_aoLayerDeltas.back();
 
         std::shared_ptr<MVTTileLayer> poTargetLayer(new MVTTileLayer());
         oTargetTile.addLayer(poTargetLayer);
-        poTargetLayer->setName(pszLayerName);
+        poTargetLayer->setName(osLayerName);
         poTargetLayer->setVersion(m_nMVTVersion);
         poTargetLayer->setExtent(m_nExtent);
 
         std::map<CPLString, GUInt32> oMapKeyToIdx;
         std::map<MVTTileLayerValue, GUInt32> oMapValueToIdx;
 
-        while( nFeaturesInTile < m_nMaxFeatures &&
-               sqlite3_step(hStmtRows) == SQLITE_ROW )
+        for( ; i < aoRows.size() && aoRows[i].m_osLayer == osLayerName; i++ )
         {
-            int nBlobSize = sqlite3_column_bytes(hStmtRows, 0);
-            const void* pabyBlob = sqlite3_column_blob(hStmtRows, 0);
-
-            EncodeFeature(pabyBlob, nBlobSize, poTargetLayer,
+            if( nFeaturesInTile >= m_nMaxFeatures )
+                continue;
+            EncodeFeature(aoRows[i].m_osFeature.data(),
+                          static_cast<int>(aoRows[i].m_osFeature.size()),
+                          poTargetLayer,
                           oMapKeyToIdx, oMapValueToIdx,
-                          poLayerProperties, m_nExtent, nFeaturesInTile);
-
-            nTempTilesRead ++;
-            if( nTempTilesRead == m_nTempTiles||
-                (nTempTilesRead % nProgressStep) == 0 )
-            {
-                const int nPct = static_cast<int>(
-                                    (100 * nTempTilesRead) / m_nTempTiles);
-                CPLDebug("MVT", "%d%%...", nPct);
-            }
+                          nullptr, m_nExtent, nFeaturesInTile, poDelta);
         }
-        sqlite3_reset(hStmtRows);
     }
 
-    sqlite3_reset(hStmtLayer);
-
+    const int nZ = poJob->m_nZ;
+    const int nX = poJob->m_nX;
+    const int nY = poJob->m_nY;
     std::string oTileBuffer(oTargetTile.write());
     size_t nSizeBefore = oTileBuffer.size();
     if( m_bGZip) 
@@ -5038,8 +5087,7 @@ std::string OGRMVTWriterDataset::EncodeTile(
     {
         nExtent /= 2;
         nSizeBefore = oTileBuffer.size();
-        oTileBuffer = RecodeTileLowerResolution(nZ, nX, nY, nExtent,
-                                                hStmtLayer, hStmtRows);
+        oTileBuffer = RecodeTileLowerResolution(aoRows, nExtent);
         bTooBigTile = oTileBuffer.size() > m_nMaxTileSize;
         CPLDebug("MVT", "Recoding tile %d/%d/%d with extent = %u. "
                  "From %u to %u bytes",
@@ -5069,17 +5117,26 @@ std::string OGRMVTWriterDataset::EncodeTile(
 
         const unsigned nTotalFeaturesInTile =
                                 std::min(m_nMaxFeatures, nFeaturesInTile);
-        char* pszSQL = sqlite3_mprintf(
-            "SELECT layer, feature FROM temp "
-            "WHERE z = %d AND x = %d AND y = %d ORDER BY "
-            "area_or_length DESC LIMIT %d",
-            nZ, nX, nY, nTotalFeaturesInTile);
-        sqlite3_stmt* hTmpStmt = nullptr;
-        CPL_IGNORE_RET_VAL(
-            sqlite3_prepare_v2( m_hDB, pszSQL, -1, &hTmpStmt, nullptr) );
-        sqlite3_free(pszSQL);
-        if( !hTmpStmt )
-            return std::string();
+
+        // Features by descending area / length. When the feature count
+        // limit is reached, they have been fetched from the temporary DB
+        // since m_aoRows does not hold all the features of the tile.
+        std::vector<const MVTTempTileRow*> apoRowsByArea;
+        if( !poJob->m_aoRowsByArea.empty() )
+        {
+            for( const auto& oRow: poJob->m_aoRowsByArea )
+                apoRowsByArea.push_back(&oRow);
+        }
+        else
+        {
+            for( const auto& oRow: aoRows )
+                apoRowsByArea.push_back(&oRow);
+            std::stable_sort(apoRowsByArea.begin(), apoRowsByArea.end(),
+                [](const MVTTempTileRow* a, const MVTTempTileRow* b)
+                { return a->m_dfAreaOrLength > b->m_dfAreaOrLength; });
+        }
+        if( apoRowsByArea.size() > nTotalFeaturesInTile )
+            apoRowsByArea.resize(nTotalFeaturesInTile);
 
         class TargetTileLayerProps
         {
@@ -5094,17 +5151,14 @@ std::string OGRMVTWriterDataset::EncodeTile(
 
         nFeaturesInTile = 0;
         const unsigned nCheckStep = std::max(1U, nTotalFeaturesInTile / 100);
-        while( sqlite3_step(hTmpStmt) == SQLITE_ROW )
+        for( const MVTTempTileRow* poRow: apoRowsByArea )
         {
-            const char* pszLayerName = reinterpret_cast<const char*>(
-                sqlite3_column_text(hTmpStmt, 0));
-            int nBlobSize = sqlite3_column_bytes(hTmpStmt, 1);
-            const void* pabyBlob = sqlite3_column_blob(hTmpStmt, 1);
+            const std::string& osLayerName = poRow->m_osLayer;
 
             std::shared_ptr<MVTTileLayer> poTargetLayer;
             std::map<CPLString, GUInt32>* poMapKeyToIdx;
             std::map<MVTTileLayerValue, GUInt32>* poMapValueToIdx;
-            auto oIter = oMapLayerNameToTargetLayer.find(pszLayerName);
+            auto oIter = oMapLayerNameToTargetLayer.find(osLayerName);
             if( oIter == oMapLayerNameToTargetLayer.end() )
             {
                 poTargetLayer =
@@ -5112,14 +5166,14 @@ std::string OGRMVTWriterDataset::EncodeTile(
                 TargetTileLayerProps props;
                 props.m_poLayer = poTargetLayer;
                 oTargetTile.addLayer(poTargetLayer);
-                poTargetLayer->setName(pszLayerName);
+                poTargetLayer->setName(osLayerName);
                 poTargetLayer->setVersion(m_nMVTVersion);
                 poTargetLayer->setExtent(nExtent);
-                oMapLayerNameToTargetLayer[pszLayerName] = props;
+                oMapLayerNameToTargetLayer[osLayerName] = props;
                 poMapKeyToIdx =
-                    &oMapLayerNameToTargetLayer[pszLayerName].m_oMapKeyToIdx;
+                    &oMapLayerNameToTargetLayer[osLayerName].m_oMapKeyToIdx;
                 poMapValueToIdx =
-                    &oMapLayerNameToTargetLayer[pszLayerName].m_oMapValueToIdx;
+                    &oMapLayerNameToTargetLayer[osLayerName].m_oMapValueToIdx;
             }
             else
             {
@@ -5128,7 +5182,9 @@ std::string OGRMVTWriterDataset::EncodeTile(
                 poMapValueToIdx = &oIter->second.m_oMapValueToIdx;
             }
 
-            EncodeFeature(pabyBlob, nBlobSize, poTargetLayer,
+            EncodeFeature(poRow->m_osFeature.data(),
+                          static_cast<int>(poRow->m_osFeature.size()),
+                          poTargetLayer,
                           *poMapKeyToIdx, *poMapValueToIdx,
                           nullptr, nExtent, nFeaturesInTile);
 
@@ -5153,11 +5209,19 @@ std::string OGRMVTWriterDataset::EncodeTile(
                      nZ, nX, nY,
                      static_cast<unsigned>(oTileBuffer.size()));
         }
-
-        sqlite3_finalize(hTmpStmt);
     }
 
-    return oTileBuffer;
+    poJob->m_osTileBuffer = std::move(oTileBuffer);
+}
+
+/************************************************************************/
+/*                         EncodeTileJobFunc()                          */
+/************************************************************************/
+
+void OGRMVTWriterDataset::EncodeTileJobFunc(void* pParam)
+{
+    MVTEncodeTileJob* poJob = static_cast<MVTEncodeTileJob*>(pParam);
+    poJob->m_poDS->EncodeTile(poJob);
 }
 
 /************************************************************************/
@@ -5165,53 +5229,37 @@ std::string OGRMVTWriterDataset::EncodeTile(
 /************************************************************************/
 
 std::string OGRMVTWriterDataset::RecodeTileLowerResolution(
-                                            int nZ, int nX, int nY,
-                                            int nExtent,
-                                            sqlite3_stmt* hStmtLayer,
-                                            sqlite3_stmt* hStmtRows)
+                                    const std::vector<MVTTempTileRow>& aoRows,
+                                    GUInt32 nExtent) const
 {
     MVTTile oTargetTile;
 
-    sqlite3_bind_int(hStmtLayer, 1, nZ);
-    sqlite3_bind_int(hStmtLayer, 2, nX);
-    sqlite3_bind_int(hStmtLayer, 3, nY);
-
     unsigned nFeaturesInTile = 0;
-    while( nFeaturesInTile < m_nMaxFeatures &&
-           sqlite3_step(hStmtLayer) == SQLITE_ROW )
+    for( size_t i = 0; i < aoRows.size() && nFeaturesInTile < m_nMaxFeatures; )
     {
-        const char* pszLayerName = reinterpret_cast<const char*>(
-            sqlite3_column_text(hStmtLayer, 0));
-        sqlite3_bind_int(hStmtRows, 1, nZ);
-        sqlite3_bind_int(hStmtRows, 2, nX);
-        sqlite3_bind_int(hStmtRows, 3, nY); 
-        sqlite3_bind_text(hStmtRows, 4, pszLayerName, -1, SQLITE_STATIC);
+        const std::string& osLayerName = aoRows[i].m_osLayer;
 
         std::shared_ptr<MVTTileLayer> poTargetLayer(new MVTTileLayer());
         oTargetTile.addLayer(poTargetLayer);
-        poTargetLayer->setName(pszLayerName);
+        poTargetLayer->setName(osLayerName);
         poTargetLayer->setVersion(m_nMVTVersion);
         poTargetLayer->setExtent(nExtent);
 
         std::map<CPLString, GUInt32> oMapKeyToIdx;
         std::map<MVTTileLayerValue, GUInt32> oMapValueToIdx;
 
-        while( nFeaturesInTile < m_nMaxFeatures &&
-               sqlite3_step(hStmtRows) == SQLITE_ROW )
+        for( ; i < aoRows.size() && aoRows[i].m_osLayer == osLayerName; i++ )
         {
-            int nBlobSize = sqlite3_column_bytes(hStmtRows, 0);
-            const void* pabyBlob = sqlite3_column_blob(hStmtRows, 0);
-
-            EncodeFeature(pabyBlob, nBlobSize, poTargetLayer,
+            if( nFeaturesInTile >= m_nMaxFeatures )
+                continue;
+            EncodeFeature(aoRows[i].m_osFeature.data(),
+                          static_cast<int>(aoRows[i].m_osFeature.size()),
+                          poTargetLayer,
                           oMapKeyToIdx, oMapValueToIdx,
                           nullptr, nExtent, nFeaturesInTile);
-
         }
-        sqlite3_reset(hStmtRows);
     }
 
-    sqlite3_reset(hStmtLayer);
-
     std::string oTileBuffer(oTargetTile.write());
     if( m_bGZip) 
         GZIPCompress(oTileBuffer);
@@ -5219,6 +5267,128 @@ std::string OGRMVTWriterDataset::RecodeTileLowerResolution(
     return oTileBuffer;
 }
 
+/************************************************************************/
+/*                     ApplyLayerPropertiesDelta()                      */
+/************************************************************************/
+
+void OGRMVTWriterDataset::ApplyLayerPropertiesDelta(
+                        const MVTEncodeTileJob& oJob,
+                        std::map<CPLString, MVTLayerProperties>& oMapLayerProps,
+                        std::set<CPLString>& oSetLayers) const
+{
+    const int nZ = oJob.m_nZ;
+    for( size_t iLayer = 0; iLayer < oJob.m_aosLayers.size(); iLayer++ )
+    {
+        const CPLString osLayerName(oJob.m_aosLayers[iLayer]);
+        auto oIterMapLayerProps = oMapLayerProps.find(osLayerName);
+        MVTLayerProperties* poLayerProperties = nullptr;
+        if( oIterMapLayerProps == oMapLayerProps.end() )
+        {
+            if( oSetLayers.size() < knMAX_COUNT_LAYERS )
+            {
+                oSetLayers.insert(osLayerName);
+                if( oMapLayerProps.size() < knMAX_REPORT_LAYERS )
+                {
+                    MVTLayerProperties props;
+                    props.m_nMinZoom = nZ;
+                    props.m_nMaxZoom = nZ;
+                    oMapLayerProps[osLayerName] = props;
+                    poLayerProperties = &(oMapLayerProps[osLayerName]);
+                }
+            }
+        }
+        else
+        {
+            poLayerProperties = &(oIterMapLayerProps->second);
+        }
+        if( poLayerProperties == nullptr )
+            continue;
+
+        poLayerProperties->m_nMinZoom =
+            std::min(nZ, poLayerProperties->m_nMinZoom);
+        poLayerProperties->m_nMaxZoom =
+            std::max(nZ, poLayerProperties->m_nMaxZoom);
+
+        const MVTLayerPropertiesDelta& oDelta = oJob.m_aoLayerDeltas[iLayer];
+        for( const auto eGeomType: oDelta.m_aeGeomTypes )
+            poLayerProperties->m_oCountGeomType[eGeomType] ++;
+        for( const auto& oKeyValue: oDelta.m_aoKeyValues )
+        {
+            UpdateLayerProperties(poLayerProperties,
+                                  oKeyValue.first, oKeyValue.second);
+        }
+    }
+}
+
+/************************************************************************/
+/*                             WriteTile()                              */
+/************************************************************************/
+
+bool OGRMVTWriterDataset::WriteTile(int nZ, int nX, int nY,
+                                    const std::string& osTileBuffer,
+                                    sqlite3_stmt* hInsertStmt,
+                                    int& nLastZ, int& nLastX)
+{
+    bool bRet = true;
+    if( osTileBuffer.empty() )
+    {
+        bRet = false;
+    }
+    else if( hInsertStmt )
+    {
+        sqlite3_bind_int(hInsertStmt, 1, nZ);
+        sqlite3_bind_int(hInsertStmt, 2, nX);
+        sqlite3_bind_int(hInsertStmt, 3, (1 << nZ) - 1 - nY);
+        sqlite3_bind_blob(hInsertStmt, 4, osTileBuffer.data(),
+                          static_cast<int>(osTileBuffer.size()),
+                          SQLITE_STATIC);
+        const int rc = sqlite3_step(hInsertStmt);
+        bRet = (rc == SQLITE_OK || rc == SQLITE_DONE);
+        sqlite3_reset(hInsertStmt);
+    }
+    else
+    {
+        CPLString osZDirname(
+            CPLFormFilename(GetDescription(),
+                            CPLSPrintf("%d", nZ), nullptr));
+        CPLString osXDirname(
+            CPLFormFilename(osZDirname, CPLSPrintf("%d", nX), nullptr));
+        if( nZ != nLastZ )
+        {
+            VSIMkdir( osZDirname, 0755 );
+            nLastZ = nZ;
+            nLastX = -1;
+        }
+        if( nX != nLastX )
+        {
+            VSIMkdir( osXDirname, 0755 );
+            nLastX = nX;
+        }
+        CPLString osTileFilename(
+            CPLFormFilename(osXDirname, CPLSPrintf("%d", nY),
+                            m_osExtension.c_str()));
+        VSILFILE* fpOut = VSIFOpenL( osTileFilename, "wb" );
+        if( fpOut )
+        {
+            const size_t nRet = VSIFWriteL(osTileBuffer.data(), 1,
+                                    osTileBuffer.size(), fpOut );
+            bRet = (nRet == osTileBuffer.size());
+            VSIFCloseL(fpOut);
+        }
+        else
+        {
+            bRet = false;
+        }
+    }
+
+    if( !bRet )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Error while writing tile %d/%d/%d", nZ, nX, nY);
+    }
+    return bRet;
+}
+
 /************************************************************************/
 /*                            CreateOutput()                            */
 /************************************************************************/
@@ -5228,6 +5398,13 @@ bool OGRMVTWriterDataset::CreateOutput()
     if( m_bThreadPoolOK )
         m_oThreadPool.WaitCompletion();
 
+    if( m_bTempDBInTransaction )
+    {
+        m_bTempDBInTransaction = false;
+        if( SQLCommand(m_hDB, "COMMIT") != OGRERR_NONE )
+            return false;
+    }
+
     std::map<CPLString, MVTLayerProperties> oMapLayerProps;
     std::set<CPLString> oSetLayers;
 
@@ -5249,29 +5426,31 @@ bool OGRMVTWriterDataset::CreateOutput()
         return false;
     }
 
-    sqlite3_stmt* hStmtLayer = nullptr;
+    sqlite3_stmt* hStmtRows = nullptr;
     CPL_IGNORE_RET_VAL(
         sqlite3_prepare_v2( m_hDB,
-            "SELECT DISTINCT layer FROM temp "
-            "WHERE z = ? AND x = ? AND y = ? ORDER BY layer",
-            -1, &hStmtLayer, nullptr) );
-    if( hStmtLayer == nullptr )
+            "SELECT layer, feature, area_or_length FROM temp "
+            "WHERE z = ? AND x = ? AND y = ? ORDER BY layer, idx LIMIT ?",
+            -1, &hStmtRows, nullptr) );
+    if( hStmtRows == nullptr )
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Prepared statement failed");
         sqlite3_finalize(hStmtZXY);
         return false;
     }
-    sqlite3_stmt* hStmtRows = nullptr;
+
+    sqlite3_stmt* hStmtRowsByArea = nullptr;
     CPL_IGNORE_RET_VAL(
         sqlite3_prepare_v2( m_hDB,
-            "SELECT feature FROM temp "
-            "WHERE z = ? AND x = ? AND y = ? AND layer = ? ORDER BY idx",
-            -1, &hStmtRows, nullptr) );
-    if( hStmtRows == nullptr )
+            "SELECT layer, feature, area_or_length FROM temp "
+            "WHERE z = ? AND x = ? AND y = ? "
+            "ORDER BY area_or_length DESC LIMIT ?",
+            -1, &hStmtRowsByArea, nullptr) );
+    if( hStmtRowsByArea == nullptr )
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Prepared statement failed");
         sqlite3_finalize(hStmtZXY);
-        sqlite3_finalize(hStmtLayer);
+        sqlite3_finalize(hStmtRows);
         return false;
     }
 
@@ -5287,101 +5466,129 @@ bool OGRMVTWriterDataset::CreateOutput()
         {
             CPLError(CE_Failure, CPLE_AppDefined, "Prepared statement failed");
             sqlite3_finalize(hStmtZXY);
-            sqlite3_finalize(hStmtLayer);
             sqlite3_finalize(hStmtRows);
+            sqlite3_finalize(hStmtRowsByArea);
             return false;
         }
+        CPL_IGNORE_RET_VAL(SQLCommand(m_hDBMBTILES, "BEGIN"));
     }
 
-    int nLastZ = -1;
-    int nLastX = -1;
-    bool bRet = true;
+    // Tiles are read from the temporary DB and written to the output by
+    // this thread, and encoded by the worker threads. While a batch of tiles
+    // is being encoded, the next one is read and the previous one written.
+    constexpr size_t knMAX_TILES_PER_BATCH = 1000;
+    constexpr size_t knMAX_BYTES_PER_BATCH = 100 * 1024 * 1024;
+    const GIntBig nProgressStep = std::max( static_cast<GIntBig>(1),
+                                            m_nTempTiles / 10 );
     GIntBig nTempTilesRead = 0;
+    GIntBig nNextProgress = nProgressStep;
+    bool bEOF = false;
 
-    while( sqlite3_step(hStmtZXY) == SQLITE_ROW )
+    const auto ReadBatch =
+        [this, hStmtZXY, hStmtRows, hStmtRowsByArea, &bEOF, &nTempTilesRead,
+         &nNextProgress, nProgressStep]
+        (std::vector<std::unique_ptr<MVTEncodeTileJob>>& apoJobs)
     {
-        int nZ = sqlite3_column_int(hStmtZXY, 0);
-        int nX = sqlite3_column_int(hStmtZXY, 1);
-        int nY = sqlite3_column_int(hStmtZXY, 2);
-
-        std::string oTileBuffer(
-            EncodeTile(nZ, nX, nY,
-                       hStmtLayer,
-                       hStmtRows,
-                       oMapLayerProps,
-                       oSetLayers,
-                       nTempTilesRead));
-
-        if( oTileBuffer.empty() )
+        size_t nBytes = 0;
+        while( !bEOF && apoJobs.size() < knMAX_TILES_PER_BATCH &&
+               nBytes < knMAX_BYTES_PER_BATCH )
         {
-            bRet = false;
-        }
-        else if( hInsertStmt )
-        {
-            sqlite3_bind_int(hInsertStmt, 1, nZ);
-            sqlite3_bind_int(hInsertStmt, 2, nX);
-            sqlite3_bind_int(hInsertStmt, 3, (1 << nZ) - 1 - nY);
-            sqlite3_bind_blob(hInsertStmt, 4, oTileBuffer.data(),
-                              static_cast<int>(oTileBuffer.size()),
-                              SQLITE_STATIC);
-            const int rc = sqlite3_step(hInsertStmt);
-            bRet = (rc == SQLITE_OK || rc == SQLITE_DONE);
-            sqlite3_reset(hInsertStmt);
-        }
-        else
-        {
-            CPLString osZDirname(
-                CPLFormFilename(GetDescription(),
-                                CPLSPrintf("%d", nZ), nullptr));
-            CPLString osXDirname(
-                CPLFormFilename(osZDirname, CPLSPrintf("%d", nX), nullptr));
-            if( nZ != nLastZ )
+            if( sqlite3_step(hStmtZXY) != SQLITE_ROW )
             {
-                VSIMkdir( osZDirname, 0755 );
-                nLastZ = nZ;
-                nLastX = -1;
+                bEOF = true;
+                break;
             }
-            if( nX != nLastX )
+            std::unique_ptr<MVTEncodeTileJob> poJob(new MVTEncodeTileJob());
+            poJob->m_poDS = this;
+            poJob->m_nZ = sqlite3_column_int(hStmtZXY, 0);
+            poJob->m_nX = sqlite3_column_int(hStmtZXY, 1);
+            poJob->m_nY = sqlite3_column_int(hStmtZXY, 2);
+            if( !ReadTileRows(hStmtRows, poJob->m_nZ, poJob->m_nX,
+                              poJob->m_nY, poJob->m_aoRows, nBytes) )
             {
-                VSIMkdir( osXDirname, 0755 );
-                nLastX = nX;
+                return false;
             }
-            CPLString osTileFilename(
-                CPLFormFilename(osXDirname, CPLSPrintf("%d", nY),
-                                m_osExtension.c_str()));
-            VSILFILE* fpOut = VSIFOpenL( osTileFilename, "wb" );
-            if( fpOut )
+            if( poJob->m_aoRows.size() >= m_nMaxFeatures &&
+                !ReadTileRows(hStmtRowsByArea, poJob->m_nZ, poJob->m_nX,
+                              poJob->m_nY, poJob->m_aoRowsByArea, nBytes) )
             {
-                const size_t nRet = VSIFWriteL(oTileBuffer.data(), 1,
-                                        oTileBuffer.size(), fpOut );
-                bRet = (nRet == oTileBuffer.size());
-                VSIFCloseL(fpOut);
+                return false;
             }
-            else
+            nTempTilesRead += poJob->m_aoRows.size();
+            if( nTempTilesRead >= nNextProgress || nTempTilesRead == m_nTempTiles )
             {
-                bRet = false;
+                const int nPct = static_cast<int>(
+                    (100 * nTempTilesRead) / std::max(m_nTempTiles,
+                                                      static_cast<GIntBig>(1)));
+                CPLDebug("MVT", "%d%%...", nPct);
+                while( nNextProgress <= nTempTilesRead )
+                    nNextProgress += nProgressStep;
             }
+            apoJobs.emplace_back(std::move(poJob));
+        }
+        return true;
+    };
+
+    const auto SubmitBatch =
+        [this](std::vector<std::unique_ptr<MVTEncodeTileJob>>& apoJobs)
+    {
+        for( auto& poJob: apoJobs )
+        {
+            if( m_bThreadPoolOK )
+                m_oThreadPool.SubmitJob(EncodeTileJobFunc, poJob.get());
+            else
+                EncodeTile(poJob.get());
         }
+    };
 
-        if( !bRet )
+    int nLastZ = -1;
+    int nLastX = -1;
+    std::vector<std::unique_ptr<MVTEncodeTileJob>> apoCurJobs;
+    std::vector<std::unique_ptr<MVTEncodeTileJob>> apoNextJobs;
+    bool bRet = ReadBatch(apoCurJobs);
+    if( bRet )
+        SubmitBatch(apoCurJobs);
+    while( bRet && !apoCurJobs.empty() )
+    {
+        bRet = ReadBatch(apoNextJobs);
+        if( m_bThreadPoolOK )
+            m_oThreadPool.WaitCompletion();
+        if( bRet )
+            SubmitBatch(apoNextJobs);
+
+        for( const auto& poJob: apoCurJobs )
         {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                     "Error while writing tile %d/%d/%d", nZ, nX, nY);
-            break;
+            ApplyLayerPropertiesDelta(*poJob, oMapLayerProps, oSetLayers);
+            if( !WriteTile(poJob->m_nZ, poJob->m_nX, poJob->m_nY,
+                           poJob->m_osTileBuffer, hInsertStmt,
+                           nLastZ, nLastX) )
+            {
+                bRet = false;
+                break;
+            }
         }
+
+        apoCurJobs = std::move(apoNextJobs);
+        apoNextJobs.clear();
     }
+    if( m_bThreadPoolOK )
+        m_oThreadPool.WaitCompletion();
+
     sqlite3_finalize(hStmtZXY);
-    sqlite3_finalize(hStmtLayer);
     sqlite3_finalize(hStmtRows);
+    sqlite3_finalize(hStmtRowsByArea);
     if( hInsertStmt )
+    {
         sqlite3_finalize(hInsertStmt);
+        if( SQLCommand(m_hDBMBTILES, "COMMIT") != OGRERR_NONE )
+            bRet = false;
+    }
 
     bRet &= GenerateMetadata(oSetLayers.size(), oMapLayerProps);
 
     return bRet;
 }
 
-
 /************************************************************************/
 /*                     SphericalMercatorToLongLat()                     */
 /************************************************************************/
@@ -6058,6 +6265,14 @@ GDALDataset* OGRMVTWriterDataset::Create( const char * pszFilename,
     }
     poDS->m_hInsertStmt = hInsertStmt;
 
+    // Inserting all features of the temporary DB in a single transaction
+    // is much faster than committing each of them.
+    if( !poDS->m_bReuseTempFile )
+    {
+        poDS->m_bTempDBInTransaction =
+            SQLCommand(hDB, "BEGIN") == OGRERR_NONE;
+    }
+
     poDS->m_nMinZoom = atoi(CSLFetchNameValueDef(papszOptions, "MINZOOM",
                                         CPLSPrintf("%d",poDS->m_nMinZoom)));
     poDS->m_nMaxZoom = atoi(CSLFetchNameValueDef(papszOptions, "MAXZOOM",
@@ -6181,13 +6396,7 @@ GDALDataset* OGRMVTWriterDataset::Create( const char * pszFilename,
         }
     }
 
-    int nThreads = CPLGetNumCPUs();
-    const char* pszNumThreads =
-            CPLGetConfigOption("GDAL_NUM_THREADS", nullptr);
-    if( pszNumThreads && CPLGetValueType(pszNumThreads) == CPL_VALUE_INTEGER )
-    {
-        nThreads = atoi(pszNumThreads);
-    }
+    const int nThreads = CPLGetNumThreads(nullptr, "ALL_CPUS");
     if( nThreads > 1 )
     {
         poDS->m_bThreadPoolOK =
@@ -34,6 +34,8 @@
 #include "oci.h"
 #include "cpl_error.h"
 
+#include <vector>
+
 /* -------------------------------------------------------------------- */
 /*      Low level Oracle spatial declarations.                          */
 /* -------------------------------------------------------------------- */
@@ -91,6 +93,10 @@ typedef struct
 
 #define DEFAULT_STRING_SIZE       4000
 
+#define DEFAULT_FETCH_ROWS        100
+// Maximum size in bytes of the column buffers of an array fetch.
+#define MAX_FETCH_BUFFER_SIZE     (16 * 1024 * 1024)
+
 /************************************************************************/
 /*                            OGROCISession                             */
 /************************************************************************/
@@ -166,7 +172,15 @@ class CPL_DLL OGROCIStatement {
 
     OGRFeatureDefn *GetResultDefn() { return poDefn; }
 
+    // Must be called before Execute().
+    void         SetFetchRows( int nRows ) { nFetchRows = MAX(1, nRows); }
+    // Only meaningful after Execute(), as it may be reduced for wide rows.
+    int          GetFetchRows() const { return nFetchRows; }
+
     char       **SimpleFetchRow();
+    // Index, in the array fetch buffers, of the row returned by the last
+    // SimpleFetchRow() call.
+    int          GetCurrentRow() const { return iCurRow; }
 
     int          GetAffectedRows() const { return nAffectedRows; }
 
@@ -179,6 +193,12 @@ class CPL_DLL OGROCIStatement {
     char         **papszCurColumn;
     char         **papszCurImage;
     sb2          *panCurColumnInd;
+    int          *panCurColumnWidth;
+
+    int           nFetchRows;
+    int           nFetchedRows;
+    int           iCurRow;
+    bool          bFetchEOF;
 
     int           nRawColumnCount;
     int           *panFieldMap;
@@ -235,10 +255,25 @@ class OGROCILayer : public OGRLayer
     OGROCIStatement    *poStatement;
 
     int                 ExecuteQuery( const char * );
+    void                CloseStatement();
 
     SDO_GEOMETRY_TYPE  *hLastGeom;
     SDO_GEOMETRY_ind   *hLastGeomInd;
 
+    // Geometry objects of the rows of the current array fetch.
+    SDO_GEOMETRY_TYPE **pahGeomBuffer;
+    SDO_GEOMETRY_ind  **pahGeomIndBuffer;
+    int                 nGeomBufferSize;
+    void                FreeGeomBuffer();
+
+    // Decoded sdo_elem_info and sdo_ordinates of hLastGeom.
+    std::vector<double> adfElemInfo;
+    std::vector<double> adfOrdinates;
+    std::vector<dvoid*> ahCollElems;
+    std::vector<dvoid*> ahCollElemInds;
+    int                 LoadCollection( OCIArray *hColl, const char *pszName,
+                                        std::vector<double>& adfValues );
+
     char               *pszGeomName;
     int                iGeomColumn;
 
@@ -252,7 +287,7 @@ class OGROCILayer : public OGRLayer
                                                   int nInterpretation,
                                                   int nStartOrdinal,
                                                   int nOrdCount);
-    int      LoadElementInfo( int iElement, int nElemCount, int nTotalOrdCount,
+    int      LoadElementInfo( int iElement,
                               int *pnEType, int *pnInterpretation,
                               int *pnStartOrdinal, int *pnElemOrdCount );
     int                 GetOrdinalPoint( int iOrdinal, int nDimension,
@@ -54,6 +54,10 @@ OGROCILayer::OGROCILayer()
     hLastGeom = nullptr;
     hLastGeomInd = nullptr;
 
+    pahGeomBuffer = nullptr;
+    pahGeomIndBuffer = nullptr;
+    nGeomBufferSize = 0;
+
     iNextShapeId = 0;
 }
 
@@ -93,11 +97,57 @@ OGROCILayer::~OGROCILayer()
 void OGROCILayer::ResetReading()
 
 {
+    CloseStatement();
+
+    iNextShapeId = 0;
+}
+
+/************************************************************************/
+/*                           CloseStatement()                           */
+/************************************************************************/
+
+void OGROCILayer::CloseStatement()
+
+{
+    FreeGeomBuffer();
+
     if( poStatement != nullptr )
         delete poStatement;
     poStatement = nullptr;
+}
 
-    iNextShapeId = 0;
+/************************************************************************/
+/*                           FreeGeomBuffer()                           */
+/*                                                                      */
+/*      Free the geometry objects of the rows of the current array      */
+/*      fetch that have not been translated.                            */
+/************************************************************************/
+
+void OGROCILayer::FreeGeomBuffer()
+
+{
+    if( pahGeomBuffer != nullptr )
+    {
+        OGROCISession      *poSession = poDS->GetSession();
+
+        for( int i = 0; i < nGeomBufferSize; i++ )
+        {
+            if( pahGeomBuffer[i] != nullptr )
+                poSession->Failed(
+                    OCIObjectFree(poSession->hEnv, poSession->hError,
+                                  (dvoid *) pahGeomBuffer[i],
+                                  (ub2)OCI_OBJECTFREE_FORCE) );
+        }
+    }
+
+    CPLFree( pahGeomBuffer );
+    pahGeomBuffer = nullptr;
+    CPLFree( pahGeomIndBuffer );
+    pahGeomIndBuffer = nullptr;
+    nGeomBufferSize = 0;
+
+    hLastGeom = nullptr;
+    hLastGeomInd = nullptr;
 }
 
 /************************************************************************/
@@ -165,8 +215,7 @@ OGRFeature *OGROCILayer::GetNextRawFeature()
     if( papszResult == nullptr )
     {
         iNextShapeId = MAX(1,iNextShapeId);
-        delete poStatement;
-        poStatement = nullptr;
+        CloseStatement();
         return nullptr;
     }
 
@@ -194,17 +243,26 @@ OGRFeature *OGROCILayer::GetNextRawFeature()
 /* -------------------------------------------------------------------- */
 /*      Translate geometry if we have it.                               */
 /* -------------------------------------------------------------------- */
-    if( iGeomColumn != -1 )
+    if( iGeomColumn != -1 && pahGeomBuffer != nullptr )
     {
+        const int iRow = poStatement->GetCurrentRow();
+        CPLAssert( iRow >= 0 && iRow < nGeomBufferSize );
+
+        hLastGeom = pahGeomBuffer[iRow];
+        hLastGeomInd = pahGeomIndBuffer[iRow];
+
         poFeature->SetGeometryDirectly( TranslateGeometry() );
 
         OGROCISession      *poSession = poDS->GetSession();
 
-        if( poFeature->GetGeometryRef() != nullptr && hLastGeom != nullptr )
+        // Let OCI allocate a new object for this row at the next fetch.
+        if( hLastGeom != nullptr )
             poSession->Failed(
                 OCIObjectFree(poSession->hEnv, poSession->hError,
                               (dvoid *) hLastGeom,
                               (ub2)OCI_OBJECTFREE_FORCE) );
+        pahGeomBuffer[iRow] = nullptr;
+        pahGeomIndBuffer[iRow] = nullptr;
 
         hLastGeom = nullptr;
         hLastGeomInd = nullptr;
@@ -235,6 +293,9 @@ int OGROCILayer::ExecuteQuery( const char *pszReqQuery )
 /*      Execute the query.                                              */
 /* -------------------------------------------------------------------- */
     poStatement = new OGROCIStatement( poSession );
+    poStatement->SetFetchRows(
+        atoi(CPLGetConfigOption("OCI_FETCH_ROWS",
+                                CPLSPrintf("%d", DEFAULT_FETCH_ROWS))) );
     if( poStatement->Execute( pszReqQuery ) != CE_None )
     {
         delete poStatement;
@@ -250,6 +311,14 @@ int OGROCILayer::ExecuteQuery( const char *pszReqQuery )
     {
         OCIDefine *hGDefine = nullptr;
 
+        // One object pointer per row of the array fetch, allocated by OCI
+        // in the object cache.
+        nGeomBufferSize = poStatement->GetFetchRows();
+        pahGeomBuffer = (SDO_GEOMETRY_TYPE **)
+            CPLCalloc(sizeof(SDO_GEOMETRY_TYPE*), nGeomBufferSize);
+        pahGeomIndBuffer = (SDO_GEOMETRY_ind **)
+            CPLCalloc(sizeof(SDO_GEOMETRY_ind*), nGeomBufferSize);
+
         if( poSession->Failed(
             OCIDefineByPos(poStatement->GetStatement(), &hGDefine,
                            poSession->hError,
@@ -261,8 +330,8 @@ int OGROCILayer::ExecuteQuery( const char *pszReqQuery )
         if( poSession->Failed(
             OCIDefineObject(hGDefine, poSession->hError,
                             poSession->hGeometryTDO,
-                            (dvoid **) &hLastGeom, (ub4 *)nullptr,
-                            (dvoid **) &hLastGeomInd, (ub4 *)nullptr ),
+                            (dvoid **) pahGeomBuffer, (ub4 *)nullptr,
+                            (dvoid **) pahGeomIndBuffer, (ub4 *)nullptr ),
             "OCIDefineObject") )
             return FALSE;
     }
@@ -286,23 +355,6 @@ OGRGeometry *OGROCILayer::TranslateGeometry()
         || hLastGeomInd->_atomic == OCI_IND_NULL )
         return nullptr;
 
-/* -------------------------------------------------------------------- */
-/*      Get the size of the sdo_elem_info and sdo_ordinates arrays.     */
-/* -------------------------------------------------------------------- */
-    int nElemCount, nOrdCount;
-
-    if( poSession->Failed(
-        OCICollSize( poSession->hEnv, poSession->hError,
-                     (OCIColl *)(hLastGeom->sdo_elem_info), &nElemCount),
-        "OCICollSize(sdo_elem_info)" ) )
-        return nullptr;
-
-    if( poSession->Failed(
-        OCICollSize( poSession->hEnv, poSession->hError,
-                     (OCIColl *)(hLastGeom->sdo_ordinates), &nOrdCount),
-        "OCICollSize(sdo_ordinates)" ) )
-        return nullptr;
-
 /* -------------------------------------------------------------------- */
 /*      Get the GType.                                                  */
 /* -------------------------------------------------------------------- */
@@ -344,6 +396,22 @@ OGRGeometry *OGROCILayer::TranslateGeometry()
             return new OGRPoint( dfX, dfY );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Convert the sdo_elem_info and sdo_ordinates arrays in one go,   */
+/*      rather than through per element OCI calls.                      */
+/* -------------------------------------------------------------------- */
+    if( hLastGeomInd->sdo_elem_info == OCI_IND_NULL
+        || hLastGeomInd->sdo_ordinates == OCI_IND_NULL )
+        return nullptr;
+
+    if( !LoadCollection( hLastGeom->sdo_elem_info, "sdo_elem_info",
+                         adfElemInfo )
+        || !LoadCollection( hLastGeom->sdo_ordinates, "sdo_ordinates",
+                            adfOrdinates ) )
+        return nullptr;
+
+    const int nElemCount = static_cast<int>(adfElemInfo.size());
+
 /* -------------------------------------------------------------------- */
 /*      If this is a sort of container geometry, create the             */
 /*      container now.                                                  */
@@ -370,9 +438,13 @@ OGRGeometry *OGROCILayer::TranslateGeometry()
         int       nInterpretation, nEType;
         int       nStartOrdinal, nElemOrdCount;
 
-        LoadElementInfo( iElement, nElemCount, nOrdCount,
-                         &nEType, &nInterpretation,
-                         &nStartOrdinal, &nElemOrdCount );
+        if( !LoadElementInfo( iElement, &nEType, &nInterpretation,
+                              &nStartOrdinal, &nElemOrdCount ) )
+        {
+            delete poCollection;
+            delete poPolygon;
+            return nullptr;
+        }
 
 /* -------------------------------------------------------------------- */
 /*      Translate this element.                                         */
@@ -464,48 +536,32 @@ OGRGeometry *OGROCILayer::TranslateGeometry()
 /************************************************************************/
 
 int
-OGROCILayer::LoadElementInfo( int iElement, int nElemCount, int nTotalOrdCount,
+OGROCILayer::LoadElementInfo( int iElement,
                               int *pnEType, int *pnInterpretation,
                               int *pnStartOrdinal, int *pnElemOrdCount )
 
 {
-    OGROCISession      *poSession = poDS->GetSession();
-    boolean bExists;
-    OCINumber *hNumber;
+    const int nElemCount = static_cast<int>(adfElemInfo.size());
+    const int nTotalOrdCount = static_cast<int>(adfOrdinates.size());
+
+    if( iElement < 0 || iElement + 2 >= nElemCount )
+    {
+        CPLDebug( "OCI", "Invalid element index %d in sdo_elem_info "
+                  "of %d values.", iElement, nElemCount );
+        return FALSE;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Get the details about element from the elem_info array.         */
 /* -------------------------------------------------------------------- */
-    OCICollGetElem(poSession->hEnv, poSession->hError,
-                   (OCIColl *)(hLastGeom->sdo_elem_info),
-                   (sb4)(iElement+0), (boolean *)&bExists,
-                   (dvoid **)&hNumber, nullptr );
-    OCINumberToInt(poSession->hError, hNumber, (uword)sizeof(ub4),
-                   OCI_NUMBER_UNSIGNED, (dvoid *) pnStartOrdinal );
-
-    OCICollGetElem(poSession->hEnv, poSession->hError,
-                   (OCIColl *)(hLastGeom->sdo_elem_info),
-                   (sb4)(iElement+1), (boolean *)&bExists,
-                   (dvoid **)&hNumber, nullptr );
-    OCINumberToInt(poSession->hError, hNumber, (uword)sizeof(ub4),
-                   OCI_NUMBER_UNSIGNED, (dvoid *) pnEType );
-
-    OCICollGetElem(poSession->hEnv, poSession->hError,
-                   (OCIColl *)(hLastGeom->sdo_elem_info),
-                   (sb4)(iElement+2), (boolean *)&bExists,
-                   (dvoid **)&hNumber, nullptr );
-    OCINumberToInt(poSession->hError, hNumber, (uword)sizeof(ub4),
-                   OCI_NUMBER_UNSIGNED, (dvoid *) pnInterpretation );
+    *pnStartOrdinal = static_cast<int>(adfElemInfo[iElement+0]);
+    *pnEType = static_cast<int>(adfElemInfo[iElement+1]);
+    *pnInterpretation = static_cast<int>(adfElemInfo[iElement+2]);
 
     if( iElement < nElemCount-3 )
     {
-        ub4 nNextStartOrdinal;
-
-        OCICollGetElem(poSession->hEnv, poSession->hError,
-                       (OCIColl *)(hLastGeom->sdo_elem_info),
-                       (sb4)(iElement+3), (boolean *)&bExists,
-                       (dvoid **)&hNumber,nullptr);
-        OCINumberToInt(poSession->hError, hNumber, (uword)sizeof(ub4),
-                       OCI_NUMBER_UNSIGNED, (dvoid *) &nNextStartOrdinal );
+        const int nNextStartOrdinal =
+            static_cast<int>(adfElemInfo[iElement+3]);
 
         *pnElemOrdCount = nNextStartOrdinal - *pnStartOrdinal;
     }
@@ -515,6 +571,71 @@ OGROCILayer::LoadElementInfo( int iElement, int nElemCount, int nTotalOrdCount,
     return TRUE;
 }
 
+/************************************************************************/
+/*                           LoadCollection()                           */
+/*                                                                      */
+/*      Convert all the numbers of a sdo_elem_info or sdo_ordinates     */
+/*      collection of hLastGeom into doubles.                           */
+/************************************************************************/
+
+int OGROCILayer::LoadCollection( OCIArray *hColl, const char *pszName,
+                                 std::vector<double>& adfValues )
+
+{
+    OGROCISession      *poSession = poDS->GetSession();
+    int nCount = 0;
+
+    adfValues.clear();
+
+    if( poSession->Failed(
+        OCICollSize( poSession->hEnv, poSession->hError,
+                     (OCIColl *) hColl, &nCount ),
+        CPLSPrintf("OCICollSize(%s)", pszName) ) )
+        return FALSE;
+
+    if( nCount <= 0 )
+        return TRUE;
+
+    if( static_cast<int>(ahCollElems.size()) < nCount )
+    {
+        ahCollElems.resize(nCount);
+        ahCollElemInds.resize(nCount);
+    }
+
+    boolean bExists = FALSE;
+    uword nElems = static_cast<uword>(nCount);
+
+    if( poSession->Failed(
+        OCICollGetElemArray( poSession->hEnv, poSession->hError,
+                             (OCIColl *) hColl, 0, &bExists,
+                             &ahCollElems[0], &ahCollElemInds[0],
+                             &nElems ),
+        CPLSPrintf("OCICollGetElemArray(%s)", pszName) ) )
+        return FALSE;
+
+    if( !bExists || nElems != static_cast<uword>(nCount) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Only %d of the %d values of %s could be read.",
+                  bExists ? static_cast<int>(nElems) : 0, nCount, pszName );
+        return FALSE;
+    }
+
+    adfValues.resize(nCount);
+    if( poSession->Failed(
+        OCINumberToRealArray( poSession->hError,
+                              (const OCINumber **) &ahCollElems[0],
+                              nElems, (uword)sizeof(double),
+                              (dvoid *) &adfValues[0] ),
+        CPLSPrintf("OCINumberToRealArray(%s)", pszName) ) )
+    {
+        adfValues.clear();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 /************************************************************************/
 /*                      TranslateGeometryElement()                      */
 /************************************************************************/
@@ -746,20 +867,6 @@ OGROCILayer::TranslateGeometryElement( int *piElement,
     {
         int nSubElementCount = nInterpretation;
         OGRLineString *poLS;
-        int nElemCount, nTotalOrdCount;
-        OGROCISession      *poSession = poDS->GetSession();
-
-        if( poSession->Failed(
-            OCICollSize( poSession->hEnv, poSession->hError,
-                         (OCIColl *)(hLastGeom->sdo_elem_info), &nElemCount),
-            "OCICollSize(sdo_elem_info)" ) )
-            return nullptr;
-
-        if( poSession->Failed(
-            OCICollSize( poSession->hEnv, poSession->hError,
-                         (OCIColl*)(hLastGeom->sdo_ordinates),&nTotalOrdCount),
-            "OCICollSize(sdo_ordinates)" ) )
-            return nullptr;
 
         if( nEType == 4 )
             poLS = new OGRLineString();
@@ -768,9 +875,9 @@ OGROCILayer::TranslateGeometryElement( int *piElement,
 
         for( *piElement += 3; nSubElementCount-- > 0;  *piElement += 3 )
         {
-            LoadElementInfo( *piElement, nElemCount, nTotalOrdCount,
-                             &nEType, &nInterpretation,
-                             &nStartOrdinal, &nElemOrdCount );
+            if( !LoadElementInfo( *piElement, &nEType, &nInterpretation,
+                                  &nStartOrdinal, &nElemOrdCount ) )
+                break;
 
             // Adjust for repeated end point except for last element.
             if( nSubElementCount > 0 )
@@ -825,32 +932,19 @@ int OGROCILayer::GetOrdinalPoint( int iOrdinal, int nDimension,
                                   double *pdfX, double *pdfY, double *pdfZ )
 
 {
-    OGROCISession      *poSession = poDS->GetSession();
-    boolean bExists;
-    OCINumber *hNumber;
-
-    OCICollGetElem( poSession->hEnv, poSession->hError,
-                    (OCIColl *)(hLastGeom->sdo_ordinates),
-                    (sb4)iOrdinal+0, (boolean *)&bExists,
-                    (dvoid **)&hNumber, nullptr );
-    OCINumberToReal(poSession->hError, hNumber,
-                    (uword)sizeof(double), (dvoid *)pdfX);
-    OCICollGetElem( poSession->hEnv, poSession->hError,
-                    (OCIColl *)(hLastGeom->sdo_ordinates),
-                    (sb4)iOrdinal + 1, (boolean *)&bExists,
-                    (dvoid **)&hNumber, nullptr );
-    OCINumberToReal(poSession->hError, hNumber,
-                    (uword)sizeof(double), (dvoid *)pdfY);
-    if( nDimension == 3 )
+    if( iOrdinal < 0 ||
+        iOrdinal + nDimension > static_cast<int>(adfOrdinates.size()) )
     {
-        OCICollGetElem( poSession->hEnv, poSession->hError,
-                        (OCIColl *)(hLastGeom->sdo_ordinates),
-                        (sb4)iOrdinal + 2, (boolean *)&bExists,
-                        (dvoid **)&hNumber, nullptr );
-        OCINumberToReal(poSession->hError, hNumber,
-                        (uword)sizeof(double), (dvoid *)pdfZ);
+        *pdfX = 0.0;
+        *pdfY = 0.0;
+        return FALSE;
     }
 
+    *pdfX = adfOrdinates[iOrdinal + 0];
+    *pdfY = adfOrdinates[iOrdinal + 1];
+    if( nDimension == 3 )
+        *pdfZ = adfOrdinates[iOrdinal + 2];
+
     return TRUE;
 }
 
@@ -30,6 +30,8 @@
 #include "ogr_oci.h"
 #include "cpl_conv.h"
 
+#include <algorithm>
+
 CPL_CVSID("$Id: ogrocistatement.cpp 579264676e187f9d14759e1bc9e30986c8b2514c 2017-12-11 20:03:03Z Even Rouault $")
 
 /************************************************************************/
@@ -47,8 +49,14 @@ OGROCIStatement::OGROCIStatement( OGROCISession *poSessionIn )
     papszCurColumn = nullptr;
     papszCurImage = nullptr;
     panCurColumnInd = nullptr;
+    panCurColumnWidth = nullptr;
     panFieldMap = nullptr;
 
+    nFetchRows = 1;
+    nFetchedRows = 0;
+    iCurRow = -1;
+    bFetchEOF = false;
+
     pszCommandText = nullptr;
     nAffectedRows = 0;
 }
@@ -89,6 +97,13 @@ void OGROCIStatement::Clean()
     CPLFree( panCurColumnInd );
     panCurColumnInd = nullptr;
 
+    CPLFree( panCurColumnWidth );
+    panCurColumnWidth = nullptr;
+
+    nFetchedRows = 0;
+    iCurRow = -1;
+    bFetchEOF = false;
+
     CPLFree( panFieldMap );
     panFieldMap = nullptr;
 
@@ -302,7 +317,7 @@ CPLErr OGROCIStatement::Execute( const char *pszSQLStatement,
     panFieldMap = (int *) CPLCalloc(sizeof(int),nRawColumnCount);
 
     papszCurColumn = (char **) CPLCalloc(sizeof(char*),nRawColumnCount+1);
-    panCurColumnInd = (sb2 *) CPLCalloc(sizeof(sb2),nRawColumnCount+1);
+    panCurColumnWidth = (int *) CPLCalloc(sizeof(int),nRawColumnCount+1);
 
 /* ==================================================================== */
 /*      Establish result column definitions, and setup parameter        */
@@ -351,10 +366,9 @@ CPLErr OGROCIStatement::Execute( const char *pszSQLStatement,
         panFieldMap[iParm] = poDefn->GetFieldCount() - 1;
 
 /* -------------------------------------------------------------------- */
-/*      Prepare a binding.                                              */
+/*      Work out the width of the buffer of the column.                 */
 /* -------------------------------------------------------------------- */
         int nBufWidth = 256, nOGRField = panFieldMap[iParm];
-        OCIDefine *hDefn = nullptr;
 
         if( oField.GetWidth() > 0 )
             /* extra space needed for the decimal separator the string
@@ -369,14 +383,51 @@ CPLErr OGROCIStatement::Execute( const char *pszSQLStatement,
         else if ( oField.GetType() == OFTDate )
             nBufWidth = 20;
 
-        papszCurColumn[nOGRField] = (char *) CPLMalloc(nBufWidth+2);
+        panCurColumnWidth[nOGRField] = nBufWidth;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Rows are fetched nFetchRows at a time, in column-wise           */
+/*      buffers. Limit the number of rows for very wide rows.           */
+/* -------------------------------------------------------------------- */
+    const int nFields = poDefn->GetFieldCount();
+    GIntBig nRowWidth = 0;
+    for( int iField = 0; iField < nFields; iField++ )
+        nRowWidth += panCurColumnWidth[iField] + static_cast<int>(sizeof(sb2));
+    if( nRowWidth > 0 )
+    {
+        nFetchRows = static_cast<int>(
+            std::max(static_cast<GIntBig>(1),
+                     std::min(static_cast<GIntBig>(nFetchRows),
+                              MAX_FETCH_BUFFER_SIZE / nRowWidth)));
+    }
+
+    panCurColumnInd = (sb2 *) CPLCalloc(sizeof(sb2),
+        static_cast<size_t>(nFields + 1) * nFetchRows);
+
+/* -------------------------------------------------------------------- */
+/*      Prepare the bindings.                                           */
+/* -------------------------------------------------------------------- */
+    for( int iParm = 0; iParm < nRawColumnCount; iParm++ )
+    {
+        const int nOGRField = panFieldMap[iParm];
+        if( nOGRField < 0 )
+            continue;
+
+        const int nBufWidth = panCurColumnWidth[nOGRField];
+        OCIDefine *hDefn = nullptr;
+
+        papszCurColumn[nOGRField] = (char *)
+            CPLMalloc(static_cast<size_t>(nBufWidth) * nFetchRows + 2);
         CPLAssert( ((long) papszCurColumn[nOGRField]) % 2 == 0 );
 
         if( poSession->Failed(
             OCIDefineByPos( hStatement, &hDefn, poSession->hError,
                             iParm+1,
                             (ub1 *) papszCurColumn[nOGRField], nBufWidth,
-                            SQLT_STR, panCurColumnInd + nOGRField,
+                            SQLT_STR,
+                            panCurColumnInd +
+                                static_cast<size_t>(nOGRField) * nFetchRows,
                             nullptr, nullptr, OCI_DEFAULT ),
             "OCIDefineByPos" ) )
             return CE_Failure;
@@ -400,20 +451,49 @@ char **OGROCIStatement::SimpleFetchRow()
             CPLCalloc(sizeof(char *), nRawColumnCount+1 );
     }
 
-    nStatus = OCIStmtFetch( hStatement, poSession->hError, 1,
-                            OCI_FETCH_NEXT, OCI_DEFAULT );
+/* -------------------------------------------------------------------- */
+/*      Fetch a new array of rows when the current one is consumed.     */
+/* -------------------------------------------------------------------- */
+    if( iCurRow + 1 >= nFetchedRows )
+    {
+        if( bFetchEOF )
+            return nullptr;
+
+        nStatus = OCIStmtFetch( hStatement, poSession->hError, nFetchRows,
+                                OCI_FETCH_NEXT, OCI_DEFAULT );
+
+        if( nStatus == OCI_NO_DATA )
+            bFetchEOF = true;
+        else if( poSession->Failed( nStatus, "OCIStmtFetch" ) )
+            return nullptr;
+
+        ub4 nRowsFetched = 0;
+        if( poSession->Failed(
+            OCIAttrGet( hStatement, OCI_HTYPE_STMT,
+                        &nRowsFetched, nullptr, OCI_ATTR_ROWS_FETCHED,
+                        poSession->hError ),
+            "OCIAttrGet(OCI_ATTR_ROWS_FETCHED)") )
+            return nullptr;
+
+        nFetchedRows = static_cast<int>(nRowsFetched);
+        iCurRow = -1;
+        if( nFetchedRows == 0 )
+        {
+            bFetchEOF = true;
+            return nullptr;
+        }
+    }
 
-    if( nStatus == OCI_NO_DATA )
-        return nullptr;
-    else if( poSession->Failed( nStatus, "OCIStmtFetch" ) )
-        return nullptr;
+    iCurRow++;
 
     for( i = 0; papszCurColumn[i] != nullptr; i++ )
     {
-        if( panCurColumnInd[i] == OCI_IND_NULL )
+        if( panCurColumnInd[static_cast<size_t>(i) * nFetchRows + iCurRow]
+                == OCI_IND_NULL )
             papszCurImage[i] = nullptr;
         else
-            papszCurImage[i] = papszCurColumn[i];
+            papszCurImage[i] = papszCurColumn[i] +
+                static_cast<size_t>(iCurRow) * panCurColumnWidth[i];
     }
 
     return papszCurImage;
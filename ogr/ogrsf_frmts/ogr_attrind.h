@@ -56,6 +56,17 @@ public:
     virtual OGRErr RemoveEntry( OGRField *psKey, GIntBig nFID ) = 0;
 
     virtual OGRErr Clear() = 0;
+
+    // Range and prefix queries. They return a sorted OGRNullFID terminated
+    // list of candidate FIDs, which may contain features that do not
+    // verify the condition (so the caller must still evaluate it), or
+    // NULL if the index cannot answer them.
+    virtual bool      SupportsRangeQueries();
+    virtual GIntBig  *GetRangeMatches( OGRField *psMin, bool bMinIncluded,
+                                       OGRField *psMax, bool bMaxIncluded,
+                                       GIntBig *pnFIDCount );
+    virtual GIntBig  *GetPrefixMatches( const char *pszPrefix,
+                                        GIntBig *pnFIDCount );
 };
 
 /************************************************************************/
@@ -90,6 +101,7 @@ public:
 };
 
 OGRLayerAttrIndex CPL_DLL *OGRCreateDefaultLayerIndex();
+OGRLayerAttrIndex CPL_DLL *OGRCreateBTreeLayerIndex();
 
 //! @endcond
 
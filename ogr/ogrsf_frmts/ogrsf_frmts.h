@@ -34,6 +34,7 @@
 #include "cpl_progress.h"
 #include "ogr_feature.h"
 #include "ogr_featurestyle.h"
+#include "ogr_recordbatch.h"
 #include "gdal_priv.h"
 
 #include <memory>
@@ -91,6 +92,14 @@ class CPL_DLL OGRLayer : public GDALMajorObject
     friend inline FeatureIterator begin(OGRLayer* poLayer);
     friend inline FeatureIterator end(OGRLayer* poLayer);
 
+    static int   StaticGetArrowSchema(struct ArrowArrayStream*,
+                                      struct ArrowSchema* out_schema);
+    static int   StaticGetNextArrowArray(struct ArrowArrayStream*,
+                                         struct ArrowArray* out_array);
+    static const char* StaticGetLastErrorArrowArrayStream(
+                                                struct ArrowArrayStream*);
+    static void  ReleaseArrowArrayStream(struct ArrowArrayStream* stream);
+
     CPL_DISALLOW_COPY_ASSIGN(OGRLayer)
 
   protected:
@@ -103,10 +112,24 @@ class CPL_DLL OGRLayer : public GDALMajorObject
                                      // filter is active.
 
     int          FilterGeometry( OGRGeometry * );
+    int          FilterPoint( double dfX, double dfY );
     //int          FilterGeometry( OGRGeometry *, OGREnvelope* psGeometryEnvelope);
     int          InstallFilter( OGRGeometry * );
 
     OGRErr       GetExtentInternal(int iGeomField, OGREnvelope *psExtent, int bForce );
+
+    // Options of the last GetArrowStream() call.
+    CPLStringList m_aosArrowArrayStreamOptions{};
+    // To be set by GetNextArrowArray() once the last feature has been read,
+    // as GetNextFeature() may restart from the beginning afterwards.
+    bool         m_bArrowArrayStreamEOF = false;
+
+    // Not forwarded by OGRLayerDecorator, so that the generic implementation
+    // goes through the GetNextFeature() of the decorating layer.
+    virtual int  GetArrowSchema(struct ArrowArrayStream*,
+                                struct ArrowSchema* out_schema);
+    virtual int  GetNextArrowArray(struct ArrowArrayStream*,
+                                   struct ArrowArray* out_array);
 //! @endcond
 
     virtual OGRErr      ISetFeature( OGRFeature *poFeature ) CPL_WARN_UNUSED_RESULT;
@@ -145,9 +168,15 @@ class CPL_DLL OGRLayer : public GDALMajorObject
 
     virtual void        ResetReading() = 0;
     virtual OGRFeature *GetNextFeature() CPL_WARN_UNUSED_RESULT = 0;
+    // Not forwarded by OGRLayerDecorator, for the same reason as
+    // GetNextArrowArray().
+    virtual bool        GetNextFeatureInto( OGRFeature* poFeature );
     virtual OGRErr      SetNextByIndex( GIntBig nIndex );
     virtual OGRFeature *GetFeature( GIntBig nFID )  CPL_WARN_UNUSED_RESULT;
 
+    virtual bool        GetArrowStream( struct ArrowArrayStream* out_stream,
+                                        CSLConstList papszOptions = nullptr );
+
     OGRErr      SetFeature( OGRFeature *poFeature )  CPL_WARN_UNUSED_RESULT;
     OGRErr      CreateFeature( OGRFeature *poFeature ) CPL_WARN_UNUSED_RESULT;
 
@@ -492,6 +521,8 @@ void CPL_DLL RegisterOGRAeronavFAA();
 void CPL_DLL RegisterOGRGeomedia();
 void CPL_DLL RegisterOGRMDB();
 void CPL_DLL RegisterOGREDIGEO();
+void CPL_DLL RegisterOGRFlatGeobuf();
+void CPL_DLL RegisterOGRArrow();
 void CPL_DLL RegisterOGRGFT();
 void CPL_DLL RegisterOGRSVG();
 void CPL_DLL RegisterOGRCouchDB();
@@ -29,12 +29,15 @@
 #include "cpl_port.h"
 #include "filegdbtable_priv.h"
 
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
 #include <algorithm>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -1859,4 +1862,294 @@ int FileGDBIndexIterator::GetMinMaxSumCount(double& dfMin, double& dfMax,
     return TRUE;
 }
 
+/************************************************************************/
+/*                      FileGDBSpatialIndexReader                       */
+/************************************************************************/
+
+/* Reader of the B-tree of a .spx file. Its keys are 64-bit signed integers */
+/* made of the grid number (2 bits), the scaled X coordinate of the cell */
+/* (31 bits) and its scaled Y coordinate (31 bits), and its values the */
+/* 1-based FID of the features whose extent intersects that cell. */
+
+class FileGDBSpatialIndexReader
+{
+        VSILFILE            *fpSpx;
+        int                  nTotalRecordCount;
+        GUInt32              nMaxPerPages;
+        GUInt32              nOffsetFirstValInPage;
+        GUInt32              nIndexDepth;
+        std::map<GUInt32, std::vector<GByte> > oMapPages;
+
+        const GByte         *ReadPage(GUInt32 nPage);
+        bool                 CollectRows(GUInt32 nPage, GUInt32 iLevel,
+                                         GInt64 nMinVal, GInt64 nMaxVal,
+                                         std::vector<int>& anRows);
+
+        CPL_DISALLOW_COPY_ASSIGN(FileGDBSpatialIndexReader)
+
+    public:
+                             FileGDBSpatialIndexReader();
+                            ~FileGDBSpatialIndexReader();
+
+        bool                 Open(const char* pszSpxName,
+                                  int nTotalRecordCountIn);
+        bool                 Search(GInt64 nMinVal, GInt64 nMaxVal,
+                                    std::vector<int>& anRows)
+                    { return CollectRows(1, 0, nMinVal, nMaxVal, anRows); }
+};
+
+/************************************************************************/
+/*                      FileGDBSpatialIndexReader()                     */
+/************************************************************************/
+
+FileGDBSpatialIndexReader::FileGDBSpatialIndexReader() :
+    fpSpx(nullptr),
+    nTotalRecordCount(0),
+    nMaxPerPages(0),
+    nOffsetFirstValInPage(0),
+    nIndexDepth(0)
+{
+}
+
+/************************************************************************/
+/*                     ~FileGDBSpatialIndexReader()                     */
+/************************************************************************/
+
+FileGDBSpatialIndexReader::~FileGDBSpatialIndexReader()
+{
+    if( fpSpx )
+        VSIFCloseL(fpSpx);
+}
+
+/************************************************************************/
+/*                               Open()                                 */
+/************************************************************************/
+
+bool FileGDBSpatialIndexReader::Open(const char* pszSpxName,
+                                     int nTotalRecordCountIn)
+{
+    nTotalRecordCount = nTotalRecordCountIn;
+    fpSpx = VSIFOpenL( pszSpxName, "rb" );
+    if( fpSpx == nullptr )
+        return false;
+
+    VSIFSeekL(fpSpx, 0, SEEK_END);
+    const vsi_l_offset nFileSize = VSIFTellL(fpSpx);
+    if( nFileSize < FGDB_PAGE_SIZE + 22 )
+        return false;
+
+    VSIFSeekL(fpSpx, nFileSize - 22, SEEK_SET);
+    GByte abyTrailer[22];
+    if( VSIFReadL( abyTrailer, 22, 1, fpSpx ) != 1 )
+        return false;
+
+    /* Keys are 64-bit integers */
+    if( abyTrailer[0] != sizeof(GInt64) )
+        return false;
+    nMaxPerPages = (FGDB_PAGE_SIZE - 12) / (4 + abyTrailer[0]);
+    nOffsetFirstValInPage = 12 + nMaxPerPages * 4;
+
+    if( GetUInt32(abyTrailer + 2, 0) != 1 )
+        return false;
+
+    nIndexDepth = GetUInt32(abyTrailer + 6, 0);
+    return nIndexDepth >= 1 && nIndexDepth <= MAX_DEPTH + 1;
+}
+
+/************************************************************************/
+/*                             ReadPage()                               */
+/************************************************************************/
+
+const GByte* FileGDBSpatialIndexReader::ReadPage(GUInt32 nPage)
+{
+    std::map<GUInt32, std::vector<GByte> >::const_iterator oIter =
+        oMapPages.find(nPage);
+    if( oIter != oMapPages.end() )
+        return oIter->second.data();
+
+    /* Inner pages are read once per column of cells, so keep them around */
+    /* but bound the memory used by that cache. */
+    if( oMapPages.size() == 1024 )
+        oMapPages.clear();
+
+    std::vector<GByte>& abyPage = oMapPages[nPage];
+    abyPage.resize(FGDB_PAGE_SIZE);
+    VSIFSeekL(fpSpx, static_cast<vsi_l_offset>(nPage - 1) * FGDB_PAGE_SIZE,
+              SEEK_SET);
+    if( VSIFReadL( abyPage.data(), FGDB_PAGE_SIZE, 1, fpSpx ) != 1 )
+    {
+        oMapPages.erase(nPage);
+        return nullptr;
+    }
+    return abyPage.data();
+}
+
+/************************************************************************/
+/*                            CollectRows()                             */
+/************************************************************************/
+
+static GInt64 GetInt64(const GByte* pBaseAddr, int iOffset)
+{
+    GInt64 nVal;
+    memcpy(&nVal, pBaseAddr + sizeof(nVal) * iOffset, sizeof(nVal));
+    CPL_LSBPTR64(&nVal);
+    return nVal;
+}
+
+bool FileGDBSpatialIndexReader::CollectRows(GUInt32 nPage, GUInt32 iLevel,
+                                            GInt64 nMinVal, GInt64 nMaxVal,
+                                            std::vector<int>& anRows)
+{
+    const GByte* pabyPage = ReadPage(nPage);
+    if( pabyPage == nullptr )
+        return false;
+
+    const GUInt32 nCount = GetUInt32(pabyPage + 4, 0);
+    if( nCount > nMaxPerPages )
+        return false;
+    const GByte* pabyVals = pabyPage + nOffsetFirstValInPage;
+
+    if( iLevel + 1 < nIndexDepth )
+    {
+        if( nCount == 0 )
+            return false;
+        /* The i-th sub-page holds the values in [val[i-1], val[i]] */
+        for( GUInt32 i = 0; i <= nCount; i++ )
+        {
+            if( i > 0 && GetInt64(pabyVals, i - 1) > nMaxVal )
+                break;
+            if( i < nCount && GetInt64(pabyVals, i) < nMinVal )
+                continue;
+            const GUInt32 nSubPage = GetUInt32(pabyPage + 8, i);
+            if( nSubPage < 2 )
+                return false;
+            /* The page buffer may be evicted from the cache by the */
+            /* recursive call, so reload it afterwards */
+            if( !CollectRows(nSubPage, iLevel + 1, nMinVal, nMaxVal, anRows) )
+                return false;
+            pabyPage = ReadPage(nPage);
+            if( pabyPage == nullptr )
+                return false;
+            pabyVals = pabyPage + nOffsetFirstValInPage;
+        }
+    }
+    else
+    {
+        for( GUInt32 i = 0; i < nCount; i++ )
+        {
+            const GInt64 nVal = GetInt64(pabyVals, i);
+            if( nVal > nMaxVal )
+                break;
+            if( nVal < nMinVal )
+                continue;
+            const GUInt32 nFID = GetUInt32(pabyPage + 12, i);
+            if( nFID < 1 || nFID > static_cast<GUInt32>(nTotalRecordCount) )
+                return false;
+            anRows.push_back(static_cast<int>(nFID) - 1);
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                 FileGDBGetSpatialIndexCandidateRows()                */
+/************************************************************************/
+
+/* Fills anRows with the sorted row numbers of the features whose extent */
+/* may intersect sFilterEnvelope, from the .spx file of the table. */
+/* This is a superset of the matching features. Returns FALSE if there is */
+/* no usable spatial index, in which case all rows must be considered. */
+
+int FileGDBGetSpatialIndexCandidateRows(FileGDBTable* poParent,
+                                        const OGREnvelope& sFilterEnvelope,
+                                        std::vector<int>& anRows)
+{
+    anRows.clear();
+
+    const FileGDBGeomField* poGeomField = poParent->GetGeomField();
+    if( poGeomField == nullptr )
+        return FALSE;
+    const std::vector<double>& adfGridRes =
+        poGeomField->GetSpatialIndexGridResolution();
+    if( adfGridRes.empty() || !(adfGridRes[0] > 0.0) )
+        return FALSE;
+
+    const char* pszSpxName = CPLFormFilename(
+        CPLGetPath(poParent->GetFilename().c_str()),
+        CPLGetBasename(poParent->GetFilename().c_str()), "spx");
+    FileGDBSpatialIndexReader oReader;
+    if( !oReader.Open(pszSpxName, poParent->GetTotalRecordCount()) )
+        return FALSE;
+
+    /* No need to look further than the extent of the layer */
+    OGREnvelope sEnvelope(sFilterEnvelope);
+    sEnvelope.MinX = std::max(sEnvelope.MinX, poGeomField->GetXMin());
+    sEnvelope.MinY = std::max(sEnvelope.MinY, poGeomField->GetYMin());
+    sEnvelope.MaxX = std::min(sEnvelope.MaxX, poGeomField->GetXMax());
+    sEnvelope.MaxY = std::min(sEnvelope.MaxY, poGeomField->GetYMax());
+    if( !(sEnvelope.MinX <= sEnvelope.MaxX &&
+          sEnvelope.MinY <= sEnvelope.MaxY) )
+    {
+        return TRUE;
+    }
+
+    /* Scaled coordinates are cell numbers shifted by 2^29 cells of the */
+    /* finest grid, so that they are positive */
+    const double dfRes0 = adfGridRes[0];
+    const double dfMaxScaled = static_cast<double>((1U << 31) - 1);
+    constexpr GUInt32 MAX_COLUMNS = 100000;
+    GUInt32 nColumns = 0;
+
+    for( size_t iGrid = 0; iGrid < adfGridRes.size() && iGrid < 3; iGrid++ )
+    {
+        const double dfRes = adfGridRes[iGrid];
+        if( !(dfRes > 0.0) )
+            continue;
+        const double dfRatio = dfRes / dfRes0;
+        /* Take one more cell on each side to be robust to rounding in */
+        /* the way the writer assigned features to cells */
+        const auto Scale = [dfRes0, dfRatio, dfMaxScaled](double dfCoord)
+        {
+            return static_cast<GUInt64>(std::min(dfMaxScaled, std::max(0.0,
+                floor((dfCoord / dfRes0 + (1 << 29)) / dfRatio))));
+        };
+        const GUInt64 nMinX = Scale(sEnvelope.MinX - dfRes);
+        const GUInt64 nMaxX = Scale(sEnvelope.MaxX + dfRes);
+        const GUInt64 nMinY = Scale(sEnvelope.MinY - dfRes);
+        const GUInt64 nMaxY = Scale(sEnvelope.MaxY + dfRes);
+
+        nColumns += static_cast<GUInt32>(nMaxX - nMinX + 1);
+        if( nColumns > MAX_COLUMNS )
+        {
+            CPLDebug("OpenFileGDB", "Too many cells to inspect in %s",
+                     pszSpxName);
+            anRows.clear();
+            return FALSE;
+        }
+
+        for( GUInt64 nX = nMinX; nX <= nMaxX; nX++ )
+        {
+            const GUInt64 nKey1 = (static_cast<GUInt64>(iGrid) << 62) |
+                                  (nX << 31) | nMinY;
+            const GUInt64 nKey2 = (static_cast<GUInt64>(iGrid) << 62) |
+                                  (nX << 31) | nMaxY;
+            GInt64 nVal1;
+            GInt64 nVal2;
+            memcpy(&nVal1, &nKey1, sizeof(nVal1));
+            memcpy(&nVal2, &nKey2, sizeof(nVal2));
+            if( !oReader.Search(std::min(nVal1, nVal2),
+                                std::max(nVal1, nVal2), anRows) )
+            {
+                CPLDebug("OpenFileGDB", "Cannot use %s", pszSpxName);
+                anRows.clear();
+                return FALSE;
+            }
+        }
+    }
+
+    std::sort(anRows.begin(), anRows.end());
+    anRows.erase(std::unique(anRows.begin(), anRows.end()), anRows.end());
+    return TRUE;
+}
+
 } /* namespace OpenFileGDB */
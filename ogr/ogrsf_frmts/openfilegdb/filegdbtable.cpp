@@ -1069,8 +1069,14 @@ int FileGDBTable::Open(const char* pszFilename,
                         nRemaining -= 5;
                         returnErrorIf(nRemaining < (GUInt32)(nToSkip * 8) );
                         nCountDoubles += nToSkip;
-                        pabyIter += nToSkip * 8;
-                        nRemaining -= nToSkip * 8;
+                        /* Those are the grid sizes of the spatial index */
+                        for( int j = 0; j < nToSkip; j++ )
+                        {
+                            double dfGridResolution;
+                            READ_DOUBLE(dfGridResolution);
+                            poField->adfSpatialIndexGridResolution.push_back(
+                                                            dfGridResolution);
+                        }
                         break;
                     }
                     else
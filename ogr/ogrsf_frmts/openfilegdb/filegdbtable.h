@@ -144,6 +144,7 @@ class FileGDBGeomField: public FileGDBField
         double            dfXMax;
         double            dfYMax;
         int               bHas3D;
+        std::vector<double> adfSpatialIndexGridResolution;
 
     public:
         explicit          FileGDBGeomField(FileGDBTable* poParent);
@@ -173,6 +174,10 @@ class FileGDBGeomField: public FileGDBField
         double             GetMTolerance() const { return dfMTolerance; }
 
         int                Has3D() const { return bHas3D; }
+
+        /* Cell size of the grids of the .spx spatial index, finest first */
+        const std::vector<double>& GetSpatialIndexGridResolution() const
+                                        { return adfSpatialIndexGridResolution; }
 };
 
 /************************************************************************/
@@ -390,6 +395,10 @@ class FileGDBOGRGeometryConverter
 
 int FileGDBDoubleDateToOGRDate(double dfVal, OGRField* psField);
 
+int FileGDBGetSpatialIndexCandidateRows(FileGDBTable* poParent,
+                                        const OGREnvelope& sFilterEnvelope,
+                                        std::vector<int>& anRows);
+
 } /* namespace OpenFileGDB */
 
 #endif /* ndef FILEGDBTABLE_H_INCLUDED */
@@ -34,7 +34,9 @@
 #include "filegdbtable.h"
 #include "swq.h"
 #include "cpl_quad_tree.h"
+#include "cpl_worker_thread_pool.h"
 
+#include <memory>
 #include <vector>
 #include <map>
 
@@ -55,6 +57,15 @@ typedef enum
     SPI_INVALID,
 } SPIState;
 
+/* Row translated by a worker thread during sequential reading */
+typedef struct
+{
+    int                 iRow;
+    OGRFeature         *poFeature; /* nullptr if rejected by the filter envelope */
+    bool                bHasBounds;
+    CPLRectObj          sBounds;
+} OGROpenFileGDBDecodedRow;
+
 class OGROpenFileGDBLayer final: public OGRLayer
 {
     friend class OGROpenFileGDBGeomFieldDefn;
@@ -75,6 +86,11 @@ class OGROpenFileGDBLayer final: public OGRLayer
     int               BuildLayerDefinition();
     int               BuildGeometryColumnGDBv10();
     OGRFeature       *GetCurrentFeature();
+    OGRFeature       *TranslateCurrentRow(FileGDBTable* poTable,
+                                          FileGDBOGRGeometryConverter* poConverter,
+                                          bool bTestFilterEnvelope,
+                                          CPLRectObj* psBounds,
+                                          bool* pbHasBounds) const;
 
     FileGDBOGRGeometryConverter* m_poGeomConverter;
 
@@ -90,11 +106,23 @@ class OGROpenFileGDBLayer final: public OGRLayer
     CPLQuadTree        *m_pQuadTree;
     void              **m_pahFilteredFeatures;
     int                 m_nFilteredFeatureCount;
+    bool                m_bFilteredFeaturesFromSPX;
     static void         GetBoundsFuncEx(const void* hFeature,
                                         CPLRectObj* pBounds,
                                         void* pQTUserData);
     void                TryToDetectMultiPatchKind();
 
+    /* Multi-threaded decoding of rows for sequential reading */
+    int                 m_nNumThreads;
+    std::unique_ptr<CPLJobQueue> m_poDecodeQueue;
+    std::vector<std::unique_ptr<FileGDBTable>> m_apoWorkerTables;
+    std::vector<std::unique_ptr<FileGDBOGRGeometryConverter>> m_apoWorkerConverters;
+    std::vector<OGROpenFileGDBDecodedRow> m_asDecodedRows;
+    size_t              m_iNextDecodedRow;
+    bool                DecodeNextRows();
+    void                DiscardDecodedRows(bool bRewind);
+    static void         DecodeRowsJobThreadFunc(void* pData);
+
 public:
 
                         OGROpenFileGDBLayer(const char* pszGDBFilename,
@@ -120,6 +148,7 @@ public:
                                    swq_expr_node* poValue);
   SPIState              GetSpatialIndexState() const { return m_eSpatialIndexState; }
   int                   IsValidLayerDefn() { return BuildLayerDefinition(); }
+  void                  SetNumThreads(int nNumThreads) { m_nNumThreads = nNumThreads; }
 
   virtual const char* GetName() override { return m_osName.c_str(); }
   virtual OGRwkbGeometryType GetGeomType() override;
@@ -158,6 +187,7 @@ class OGROpenFileGDBDataSource final: public OGRDataSource
   std::vector <OGRLayer*>        m_apoHiddenLayers;
   char                         **m_papszFiles;
   std::map<std::string, int>     m_osMapNameToIdx;
+  int                            m_nNumThreads;
 
   /* For debugging/testing */
   bool                           bLastSQLUsedOptimizedImplementation;
@@ -182,7 +212,7 @@ public:
            OGROpenFileGDBDataSource();
   virtual ~OGROpenFileGDBDataSource();
 
-  int                 Open(const char * );
+  int                 Open(const char *, char** papszOpenOptions = nullptr);
 
   virtual const char* GetName() override { return m_pszName; }
   virtual int         GetLayerCount() override { return static_cast<int>(m_apoLayers.size()); }
@@ -31,7 +31,9 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -59,6 +61,7 @@ CPL_CVSID("$Id: ogropenfilegdbdatasource.cpp a5343ed6a8af2495681940a9d1cc57c074b
 OGROpenFileGDBDataSource::OGROpenFileGDBDataSource() :
     m_pszName(nullptr),
     m_papszFiles(nullptr),
+    m_nNumThreads(1),
     bLastSQLUsedOptimizedImplementation(false)
 {}
 
@@ -94,11 +97,14 @@ int OGROpenFileGDBDataSource::FileExists(const char* pszFilename)
 /*                                Open()                                */
 /************************************************************************/
 
-int OGROpenFileGDBDataSource::Open( const char* pszFilename )
+int OGROpenFileGDBDataSource::Open( const char* pszFilename,
+                                    char** papszOpenOptionsIn )
 
 {
     FileGDBTable oTable;
 
+    m_nNumThreads = CPLGetNumThreads(papszOpenOptionsIn);
+
     m_pszName = CPLStrdup(pszFilename);
 
     m_osDirName = pszFilename;
@@ -167,6 +173,7 @@ int OGROpenFileGDBDataSource::Open( const char* pszFilename )
             const char* pszLyrName = CPLSPrintf("a%08x", nInterestTable);
             OGROpenFileGDBLayer* poLayer = new OGROpenFileGDBLayer(
                                 m_pszName, pszLyrName, "", "");
+            poLayer->SetNumThreads(m_nNumThreads);
             const char* pszTablX = CPLResetExtension(m_pszName, "gdbtablx");
             if( (!FileExists(pszTablX) &&
                  poLayer->GetLayerDefn()->GetFieldCount() == 0 &&
@@ -274,8 +281,10 @@ int OGROpenFileGDBDataSource::Open( const char* pszFilename )
                 pszLyrName = aosTableNames[nInterestTable-1].c_str();
             else
                 pszLyrName = CPLSPrintf("a%08x", nInterestTable);
-            m_apoLayers.push_back(new OGROpenFileGDBLayer(
-                m_pszName, pszLyrName, "", ""));
+            OGROpenFileGDBLayer* poLayer = new OGROpenFileGDBLayer(
+                m_pszName, pszLyrName, "", "");
+            poLayer->SetNumThreads(m_nNumThreads);
+            m_apoLayers.push_back(poLayer);
         }
         else
         {
@@ -337,12 +346,14 @@ void OGROpenFileGDBDataSource::AddLayer( const CPLString& osName,
                 }
             }
 
-            m_apoLayers.push_back(
+            OGROpenFileGDBLayer* poLayer =
                 new OGROpenFileGDBLayer(osFilename,
                                         osName,
                                         osDefinition,
                                         osDocumentation,
-                                        pszGeomName, eGeomType));
+                                        pszGeomName, eGeomType);
+            poLayer->SetNumThreads(m_nNumThreads);
+            m_apoLayers.push_back(poLayer);
         }
     }
 }
@@ -592,8 +603,10 @@ OGRLayer* OGROpenFileGDBDataSource::GetLayerByName( const char* pszName )
                         m_osDirName, CPLSPrintf("a%08x", idx), "gdbtable"));
         if( FileExists(osFilename) )
         {
-            poLayer = new OGROpenFileGDBLayer(
+            OGROpenFileGDBLayer* poGDBLayer = new OGROpenFileGDBLayer(
                                     osFilename, pszName, "", "");
+            poGDBLayer->SetNumThreads(m_nNumThreads);
+            poLayer = poGDBLayer;
             m_apoHiddenLayers.push_back(poLayer);
             return poLayer;
         }
@@ -213,7 +213,7 @@ static GDALDataset* OGROpenFileGDBDriverOpen( GDALOpenInfo* poOpenInfo )
 #endif
 
     OGROpenFileGDBDataSource* poDS = new OGROpenFileGDBDataSource();
-    if( poDS->Open( pszFilename ) )
+    if( poDS->Open( pszFilename, poOpenInfo->papszOpenOptions ) )
     {
         return poDS;
     }
@@ -243,6 +243,10 @@ void RegisterOGROpenFileGDB()
     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "gdb" );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drv_openfilegdb.html" );
     poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+"<OpenOptionList>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads used to decode rows during sequential reading. Integer or ALL_CPUS' default='1'/>"
+"</OpenOptionList>" );
 
     poDriver->pfnOpen = OGROpenFileGDBDriverOpen;
     poDriver->pfnIdentify = OGROpenFileGDBDriverIdentify;
@@ -35,7 +35,10 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -181,7 +184,10 @@ OGROpenFileGDBLayer::OGROpenFileGDBLayer( const char* pszGDBFilename,
     m_eSpatialIndexState(SPI_IN_BUILDING),
     m_pQuadTree(nullptr),
     m_pahFilteredFeatures(nullptr),
-    m_nFilteredFeatureCount(-1)
+    m_nFilteredFeatureCount(-1),
+    m_bFilteredFeaturesFromSPX(false),
+    m_nNumThreads(1),
+    m_iNextDecodedRow(0)
 {
     // TODO(rouault): What error on compiler versions?  r33032 does not say.
 
@@ -206,6 +212,7 @@ OGROpenFileGDBLayer::OGROpenFileGDBLayer( const char* pszGDBFilename,
 
 OGROpenFileGDBLayer::~OGROpenFileGDBLayer()
 {
+    DiscardDecodedRows(false);
     delete m_poLyrTable;
     if( m_poFeatureDefn )
     {
@@ -853,6 +860,7 @@ void OGROpenFileGDBLayer::ResetReading()
         if( m_eSpatialIndexState == SPI_IN_BUILDING )
             m_eSpatialIndexState = SPI_INVALID;
     }
+    DiscardDecodedRows(false);
     m_bEOF = FALSE;
     m_iCurFeat = 0;
     if( m_poIterator )
@@ -868,6 +876,8 @@ void OGROpenFileGDBLayer::SetSpatialFilter( OGRGeometry *poGeom )
     if( !BuildLayerDefinition() )
         return;
 
+    DiscardDecodedRows(true);
+
     OGRLayer::SetSpatialFilter(poGeom);
 
     if( m_bFilterIsEnvelope )
@@ -888,6 +898,14 @@ void OGROpenFileGDBLayer::SetSpatialFilter( OGRGeometry *poGeom )
         }
     }
 
+    if( m_bFilteredFeaturesFromSPX )
+    {
+        CPLFree(m_pahFilteredFeatures);
+        m_pahFilteredFeatures = nullptr;
+        m_nFilteredFeatureCount = -1;
+        m_bFilteredFeaturesFromSPX = false;
+    }
+
     if( poGeom != nullptr )
     {
         if( m_eSpatialIndexState == SPI_COMPLETED )
@@ -908,6 +926,34 @@ void OGROpenFileGDBLayer::SetSpatialFilter( OGRGeometry *poGeom )
                 std::sort(panStart, panStart + m_nFilteredFeatureCount);
             }
         }
+        else if( m_iGeomFieldIdx >= 0 &&
+                 CPLTestBool(CPLGetConfigOption(
+                            "OPENFILEGDB_USE_SPATIAL_INDEX", "YES")) )
+        {
+            /* The .spx file gives a superset of the features whose */
+            /* extent intersects the filter. The filter envelope is still */
+            /* tested on each of them. */
+            std::vector<int> anRows;
+            if( FileGDBGetSpatialIndexCandidateRows(m_poLyrTable,
+                                                    m_sFilterEnvelope,
+                                                    anRows) )
+            {
+                CPLDebug("OpenFileGDB",
+                         "%d candidate rows from spatial index",
+                         static_cast<int>(anRows.size()));
+                /* Features will not be all visited in order */
+                if( m_eSpatialIndexState == SPI_IN_BUILDING )
+                    m_eSpatialIndexState = SPI_INVALID;
+                CPLFree(m_pahFilteredFeatures);
+                m_nFilteredFeatureCount = static_cast<int>(anRows.size());
+                m_pahFilteredFeatures = static_cast<void**>(
+                    CPLMalloc(sizeof(void*) *
+                              std::max(1, m_nFilteredFeatureCount)));
+                for( int i = 0; i < m_nFilteredFeatureCount; i++ )
+                    m_pahFilteredFeatures[i] = (void*)(size_t)anRows[i];
+                m_bFilteredFeaturesFromSPX = true;
+            }
+        }
         m_poLyrTable->InstallFilterEnvelope(&m_sFilterEnvelope);
     }
     else
@@ -1435,6 +1481,8 @@ OGRErr OGROpenFileGDBLayer::SetAttributeFilter( const char* pszFilter )
     if( !BuildLayerDefinition() )
         return OGRERR_FAILURE;
 
+    DiscardDecodedRows(true);
+
     delete m_poIterator;
     m_poIterator = nullptr;
     m_bIteratorSufficientToEvaluateFilter = FALSE;
@@ -1463,50 +1511,85 @@ OGRErr OGROpenFileGDBLayer::SetAttributeFilter( const char* pszFilter )
 /***********************************************************************/
 
 OGRFeature* OGROpenFileGDBLayer::GetCurrentFeature()
+{
+    if( m_iGeomFieldIdx >= 0 && m_eSpatialIndexState == SPI_IN_BUILDING &&
+        m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
+    {
+        m_eSpatialIndexState = SPI_INVALID;
+    }
+
+    CPLRectObj sBounds;
+    bool bHasBounds = false;
+    OGRFeature* poFeature = TranslateCurrentRow(
+        m_poLyrTable, m_poGeomConverter,
+        m_poFilterGeom != nullptr && m_eSpatialIndexState != SPI_COMPLETED,
+        m_eSpatialIndexState == SPI_IN_BUILDING ? &sBounds : nullptr,
+        &bHasBounds);
+    if( bHasBounds )
+    {
+        CPLQuadTreeInsertWithBounds(m_pQuadTree,
+                                    (void*)(size_t)m_poLyrTable->GetCurRow(),
+                                    &sBounds);
+    }
+    return poFeature;
+}
+
+/***********************************************************************/
+/*                        TranslateCurrentRow()                        */
+/***********************************************************************/
+
+/* Builds the feature of the current row of poTable, which is either */
+/* m_poLyrTable or the table of a worker thread. This does not modify the */
+/* state of the layer, so it can be called concurrently. If psBounds is not */
+/* null, it receives the extent of the geometry, to be inserted in the */
+/* quadtree by the caller, even if the feature is rejected by the filter */
+/* envelope (in which case nullptr is returned). */
+
+OGRFeature* OGROpenFileGDBLayer::TranslateCurrentRow(
+                                    FileGDBTable* poTable,
+                                    FileGDBOGRGeometryConverter* poConverter,
+                                    bool bTestFilterEnvelope,
+                                    CPLRectObj* psBounds,
+                                    bool* pbHasBounds) const
 {
     OGRFeature *poFeature = nullptr;
     int iOGRIdx = 0;
-    int iRow = m_poLyrTable->GetCurRow();
-    for(int iGDBIdx=0;iGDBIdx<m_poLyrTable->GetFieldCount();iGDBIdx++)
+    int iRow = poTable->GetCurRow();
+    *pbHasBounds = false;
+    for(int iGDBIdx=0;iGDBIdx<poTable->GetFieldCount();iGDBIdx++)
     {
         if( iGDBIdx == m_iGeomFieldIdx )
         {
             if( m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
             {
-                if( m_eSpatialIndexState == SPI_IN_BUILDING )
-                    m_eSpatialIndexState = SPI_INVALID;
                 continue;
             }
 
-            const OGRField* psField = m_poLyrTable->GetFieldValue(iGDBIdx);
+            const OGRField* psField = poTable->GetFieldValue(iGDBIdx);
             if( psField != nullptr )
             {
-                if( m_eSpatialIndexState == SPI_IN_BUILDING )
+                if( psBounds != nullptr )
                 {
                     OGREnvelope sFeatureEnvelope;
-                    if( m_poLyrTable->GetFeatureExtent(psField,
-                                                       &sFeatureEnvelope) )
+                    if( poTable->GetFeatureExtent(psField,
+                                                  &sFeatureEnvelope) )
                     {
-                        CPLRectObj sBounds;
-                        sBounds.minx = sFeatureEnvelope.MinX;
-                        sBounds.miny = sFeatureEnvelope.MinY;
-                        sBounds.maxx = sFeatureEnvelope.MaxX;
-                        sBounds.maxy = sFeatureEnvelope.MaxY;
-                        CPLQuadTreeInsertWithBounds(m_pQuadTree,
-                                                    (void*)(size_t)iRow,
-                                                    &sBounds);
+                        psBounds->minx = sFeatureEnvelope.MinX;
+                        psBounds->miny = sFeatureEnvelope.MinY;
+                        psBounds->maxx = sFeatureEnvelope.MaxX;
+                        psBounds->maxy = sFeatureEnvelope.MaxY;
+                        *pbHasBounds = true;
                     }
                 }
 
-                if( m_poFilterGeom != nullptr &&
-                    m_eSpatialIndexState != SPI_COMPLETED &&
-                    !m_poLyrTable->DoesGeometryIntersectsFilterEnvelope(psField) )
+                if( bTestFilterEnvelope &&
+                    !poTable->DoesGeometryIntersectsFilterEnvelope(psField) )
                 {
                     delete poFeature;
                     return nullptr;
                 }
 
-                OGRGeometry* poGeom = m_poGeomConverter->GetAsGeometry(psField);
+                OGRGeometry* poGeom = poConverter->GetAsGeometry(psField);
                 if( poGeom != nullptr )
                 {
                     OGRwkbGeometryType eFlattenType = wkbFlatten(poGeom->getGeometryType());
@@ -1540,7 +1623,7 @@ OGRFeature* OGROpenFileGDBLayer::GetCurrentFeature()
         {
             if( !m_poFeatureDefn->GetFieldDefn(iOGRIdx)->IsIgnored() )
             {
-                const OGRField* psField = m_poLyrTable->GetFieldValue(iGDBIdx);
+                const OGRField* psField = poTable->GetFieldValue(iGDBIdx);
                 if( poFeature == nullptr )
                     poFeature = new OGRFeature(m_poFeatureDefn);
                 if( psField == nullptr )
@@ -1563,16 +1646,201 @@ OGRFeature* OGROpenFileGDBLayer::GetCurrentFeature()
     if( poFeature == nullptr )
         poFeature = new OGRFeature(m_poFeatureDefn);
 
-    if( m_poLyrTable->HasDeletedFeaturesListed() )
+    if( poTable->HasDeletedFeaturesListed() )
     {
         poFeature->SetField(poFeature->GetFieldCount() - 1,
-                            m_poLyrTable->IsCurRowDeleted());
+                            poTable->IsCurRowDeleted());
     }
 
     poFeature->SetFID(iRow + 1);
     return poFeature;
 }
 
+/***********************************************************************/
+/*                      OGROpenFileGDBDecodeJob                        */
+/***********************************************************************/
+
+namespace {
+
+// Range of rows translated by one thread.
+struct OGROpenFileGDBDecodeJob
+{
+    const OGROpenFileGDBLayer   *poLayer = nullptr;
+    FileGDBTable                *poTable = nullptr;
+    FileGDBOGRGeometryConverter *poConverter = nullptr;
+    int                          iStartRow = 0;
+    int                          iEndRow = 0;
+    bool                         bTestFilterEnvelope = false;
+    bool                         bComputeBounds = false;
+    bool                         bError = false;
+    std::vector<OGROpenFileGDBDecodedRow> asRows{};
+};
+
+} // namespace
+
+/***********************************************************************/
+/*                      DecodeRowsJobThreadFunc()                      */
+/***********************************************************************/
+
+void OGROpenFileGDBLayer::DecodeRowsJobThreadFunc( void* pData )
+{
+    OGROpenFileGDBDecodeJob* psJob =
+        static_cast<OGROpenFileGDBDecodeJob*>(pData);
+    int iRow = psJob->iStartRow;
+    while( iRow < psJob->iEndRow )
+    {
+        iRow = psJob->poTable->GetAndSelectNextNonEmptyRow(iRow);
+        if( iRow < 0 )
+        {
+            psJob->bError = CPL_TO_BOOL(psJob->poTable->HasGotError());
+            break;
+        }
+        if( iRow >= psJob->iEndRow )
+            break;
+
+        OGROpenFileGDBDecodedRow sRow;
+        sRow.iRow = iRow;
+        sRow.poFeature = psJob->poLayer->TranslateCurrentRow(
+            psJob->poTable, psJob->poConverter,
+            psJob->bTestFilterEnvelope,
+            psJob->bComputeBounds ? &sRow.sBounds : nullptr,
+            &sRow.bHasBounds);
+        psJob->asRows.push_back(sRow);
+        iRow ++;
+    }
+}
+
+/***********************************************************************/
+/*                          DecodeNextRows()                           */
+/***********************************************************************/
+
+/* Translates the next rows of a sequential read on several threads, */
+/* each one processing a consecutive range of rows with its own handle on */
+/* the table. Features are queued in m_asDecodedRows in row order, and */
+/* m_iCurFeat is advanced beyond the last row examined. */
+/* Returns false if multi-threading cannot be used. */
+
+constexpr int ROWS_PER_DECODE_JOB = 1000;
+
+bool OGROpenFileGDBLayer::DecodeNextRows()
+{
+    if( m_poDecodeQueue == nullptr )
+    {
+        for( int i = 1; i < m_nNumThreads; i++ )
+        {
+            std::unique_ptr<FileGDBTable> poTable(new FileGDBTable());
+            if( !poTable->Open(m_osGDBFilename, GetDescription()) )
+                break;
+            std::unique_ptr<FileGDBOGRGeometryConverter> poConverter;
+            if( m_iGeomFieldIdx >= 0 )
+            {
+                poConverter.reset(FileGDBOGRGeometryConverter::BuildConverter(
+                    poTable->GetGeomField()));
+            }
+            m_apoWorkerTables.push_back(std::move(poTable));
+            m_apoWorkerConverters.push_back(std::move(poConverter));
+        }
+        if( !m_apoWorkerTables.empty() )
+        {
+            CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(
+                static_cast<int>(m_apoWorkerTables.size()));
+            if( poPool )
+                m_poDecodeQueue = poPool->CreateJobQueue();
+        }
+        if( m_poDecodeQueue == nullptr )
+        {
+            m_apoWorkerTables.clear();
+            m_apoWorkerConverters.clear();
+            m_nNumThreads = 1;
+            return false;
+        }
+    }
+
+    if( m_iGeomFieldIdx >= 0 && m_eSpatialIndexState == SPI_IN_BUILDING &&
+        m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() )
+    {
+        m_eSpatialIndexState = SPI_INVALID;
+    }
+
+    const int nTotalRecordCount = m_poLyrTable->GetTotalRecordCount();
+    const int nJobs = 1 + static_cast<int>(m_apoWorkerTables.size());
+    std::vector<OGROpenFileGDBDecodeJob> asJobs(nJobs);
+    int iRow = m_iCurFeat;
+    int nJobsUsed = 0;
+    for( ; nJobsUsed < nJobs && iRow < nTotalRecordCount; nJobsUsed++ )
+    {
+        OGROpenFileGDBDecodeJob& sJob = asJobs[nJobsUsed];
+        sJob.poLayer = this;
+        if( nJobsUsed == 0 )
+        {
+            sJob.poTable = m_poLyrTable;
+            sJob.poConverter = m_poGeomConverter;
+        }
+        else
+        {
+            sJob.poTable = m_apoWorkerTables[nJobsUsed - 1].get();
+            sJob.poConverter = m_apoWorkerConverters[nJobsUsed - 1].get();
+            sJob.poTable->InstallFilterEnvelope(
+                m_poFilterGeom != nullptr ? &m_sFilterEnvelope : nullptr);
+        }
+        sJob.iStartRow = iRow;
+        sJob.iEndRow = std::min(nTotalRecordCount,
+                                iRow + ROWS_PER_DECODE_JOB);
+        sJob.bTestFilterEnvelope = m_poFilterGeom != nullptr &&
+                                   m_eSpatialIndexState != SPI_COMPLETED;
+        sJob.bComputeBounds = m_eSpatialIndexState == SPI_IN_BUILDING;
+        iRow = sJob.iEndRow;
+        if( nJobsUsed > 0 &&
+            !m_poDecodeQueue->SubmitJob(DecodeRowsJobThreadFunc, &sJob) )
+        {
+            DecodeRowsJobThreadFunc(&sJob);
+        }
+    }
+    DecodeRowsJobThreadFunc(&asJobs[0]);
+    m_poDecodeQueue->WaitCompletion();
+
+    m_asDecodedRows.clear();
+    m_iNextDecodedRow = 0;
+    m_iCurFeat = iRow;
+    for( int i = 0; i < nJobsUsed; i++ )
+    {
+        m_asDecodedRows.insert(m_asDecodedRows.end(),
+                               asJobs[i].asRows.begin(),
+                               asJobs[i].asRows.end());
+        if( asJobs[i].bError )
+        {
+            /* Stop reading after the rows decoded before the error */
+            for( int j = i + 1; j < nJobsUsed; j++ )
+            {
+                for( size_t k = 0; k < asJobs[j].asRows.size(); k++ )
+                    delete asJobs[j].asRows[k].poFeature;
+            }
+            if( m_eSpatialIndexState == SPI_IN_BUILDING )
+                m_eSpatialIndexState = SPI_INVALID;
+            m_iCurFeat = nTotalRecordCount;
+            break;
+        }
+    }
+    return true;
+}
+
+/***********************************************************************/
+/*                        DiscardDecodedRows()                         */
+/***********************************************************************/
+
+/* Drops the rows translated ahead by DecodeNextRows(). If bRewind is set, */
+/* the next sequential read restarts from the first dropped row. */
+
+void OGROpenFileGDBLayer::DiscardDecodedRows(bool bRewind)
+{
+    if( bRewind && m_iNextDecodedRow < m_asDecodedRows.size() )
+        m_iCurFeat = m_asDecodedRows[m_iNextDecodedRow].iRow;
+    for( size_t i = m_iNextDecodedRow; i < m_asDecodedRows.size(); i++ )
+        delete m_asDecodedRows[i].poFeature;
+    m_asDecodedRows.clear();
+    m_iNextDecodedRow = 0;
+}
+
 /***********************************************************************/
 /*                         GetNextFeature()                            */
 /***********************************************************************/
@@ -1632,10 +1900,45 @@ OGRFeature* OGROpenFileGDBLayer::GetNextFeature()
         {
             while( true )
             {
+                if( m_iNextDecodedRow < m_asDecodedRows.size() )
+                {
+                    OGROpenFileGDBDecodedRow& sRow =
+                        m_asDecodedRows[m_iNextDecodedRow++];
+                    if( sRow.bHasBounds &&
+                        m_eSpatialIndexState == SPI_IN_BUILDING )
+                    {
+                        CPLQuadTreeInsertWithBounds(m_pQuadTree,
+                                                    (void*)(size_t)sRow.iRow,
+                                                    &sRow.sBounds);
+                    }
+                    poFeature = sRow.poFeature;
+                    sRow.poFeature = nullptr;
+                    if( m_iNextDecodedRow == m_asDecodedRows.size() )
+                    {
+                        m_asDecodedRows.clear();
+                        m_iNextDecodedRow = 0;
+                        if( m_eSpatialIndexState == SPI_IN_BUILDING &&
+                            m_iCurFeat == m_poLyrTable->GetTotalRecordCount() )
+                        {
+                            CPLDebug("OpenFileGDB", "SPI_COMPLETED");
+                            m_eSpatialIndexState = SPI_COMPLETED;
+                        }
+                    }
+                    if( poFeature )
+                        break;
+                    continue;
+                }
                 if( m_iCurFeat == m_poLyrTable->GetTotalRecordCount() )
                 {
                     return nullptr;
                 }
+                if( m_nNumThreads > 1 &&
+                    m_poLyrTable->GetTotalRecordCount() - m_iCurFeat >
+                                                    ROWS_PER_DECODE_JOB &&
+                    DecodeNextRows() )
+                {
+                    continue;
+                }
                 m_iCurFeat = m_poLyrTable->GetAndSelectNextNonEmptyRow(m_iCurFeat);
                 if( m_iCurFeat < 0 )
                 {
@@ -1708,12 +2011,14 @@ OGRFeature* OGROpenFileGDBLayer::GetFeature( GIntBig nFeatureId )
 
 OGRErr OGROpenFileGDBLayer::SetNextByIndex( GIntBig nIndex )
 {
-    if( m_poIterator != nullptr )
+    if( m_poIterator != nullptr || m_bFilteredFeaturesFromSPX )
         return OGRLayer::SetNextByIndex(nIndex);
 
     if( !BuildLayerDefinition() )
         return OGRERR_FAILURE;
 
+    DiscardDecodedRows(false);
+
     if( m_eSpatialIndexState == SPI_IN_BUILDING )
         m_eSpatialIndexState = SPI_INVALID;
 
@@ -1773,7 +2078,8 @@ GIntBig OGROpenFileGDBLayer::GetFeatureCount( int bForce )
     {
         return m_poLyrTable->GetValidRecordCount();
     }
-    else if( m_nFilteredFeatureCount >= 0 && m_poAttrQuery == nullptr )
+    else if( m_nFilteredFeatureCount >= 0 && m_poAttrQuery == nullptr &&
+             !m_bFilteredFeaturesFromSPX )
     {
         return m_nFilteredFeatureCount;
     }
@@ -1793,8 +2099,14 @@ GIntBig OGROpenFileGDBLayer::GetFeatureCount( int bForce )
             m_nFilteredFeatureCount = 0;
         }
 
-        for(int i=0;i<m_poLyrTable->GetTotalRecordCount();i++)
+        /* Only the candidates from the .spx need to be examined */
+        const int nRowsToExamine = m_bFilteredFeaturesFromSPX ?
+            m_nFilteredFeatureCount : m_poLyrTable->GetTotalRecordCount();
+        for(int iExamined=0;iExamined<nRowsToExamine;iExamined++)
         {
+            const int i = m_bFilteredFeaturesFromSPX ?
+                static_cast<int>(reinterpret_cast<GUIntptr_t>(
+                    m_pahFilteredFeatures[iExamined])) : iExamined;
             if( !m_poLyrTable->SelectRow(i) )
             {
                 if( m_poLyrTable->HasGotError() )
@@ -35,7 +35,10 @@
 
 #include "ogrsf_frmts.h"
 #include "cpl_string.h"
+#include "cpl_virtualmem.h"
+#include "cpl_worker_thread_pool.h"
 
+#include <memory>
 #include <set>
 #include <unordered_set>
 #include <map>
@@ -274,6 +277,13 @@ typedef struct
     EMULATED_BOOL       bAttrFilterAlreadyEvaluated : 1;
 } WayFeaturePair;
 
+typedef enum
+{
+    OSM_NODE_INDEX_CUSTOM,  /* bucket/sector based index */
+    OSM_NODE_INDEX_DENSE,   /* flat array indexed by node id */
+    OSM_NODE_INDEX_SPARSE   /* in-memory sorted arrays of ids and positions */
+} OSMNodeIndexMode;
+
 #ifdef ENABLE_NODE_LOOKUP_BY_HASHING
 typedef struct
 {
@@ -359,6 +369,21 @@ class OGROSMDataSource : public OGRDataSource
 
     bool                bCustomIndexing;
     bool                bCompressNodes;
+    OSMNodeIndexMode    eNodeIndexMode;
+
+    /* OSM_NODE_INDEX_DENSE: run of consecutive nodes not yet written */
+    std::vector<LonLat> asDenseNodesBuffer;
+    GIntBig             nDenseNodesBufferStartId;
+    CPLVirtualMem      *psDenseNodesMap;
+    GIntBig             nDenseNodesMapSize;
+    bool                bDenseNodesMapFailed;
+
+    /* OSM_NODE_INDEX_SPARSE */
+    std::vector<GIntBig> anSparseNodeIds;
+    std::vector<LonLat> asSparseNodes;
+
+    int                 nNumThreads;
+    std::unique_ptr<CPLJobQueue> poNodesLookupQueue;
 
     unsigned int        nUnsortedReqIds;
     GIntBig            *panUnsortedReqIds;
@@ -430,6 +455,9 @@ class OGROSMDataSource : public OGRDataSource
     bool                FlushCurrentSectorCompressedCase();
     bool                FlushCurrentSectorNonCompressedCase();
     bool                IndexPointCustom( OSMNode* psNode );
+    bool                IndexPointDense( OSMNode* psNode );
+    bool                IndexPointSparse( OSMNode* psNode );
+    bool                FlushDenseNodesBuffer();
 
     void                IndexWay(GIntBig nWayID, bool bIsArea,
                                  unsigned int nTags, IndexedKVP* pasTags,
@@ -449,6 +477,11 @@ class OGROSMDataSource : public OGRDataSource
     void                LookupNodesCustom();
     void                LookupNodesCustomCompressedCase();
     void                LookupNodesCustomNonCompressedCase();
+    void                LookupNodesDenseOrSparse();
+    void                LookupNodesDenseNonMapped();
+    void                LookupNodesRange( unsigned int iStart,
+                                          unsigned int iEnd ) const;
+    static void         LookupNodesJobThreadFunc( void* pData );
 
     unsigned int        LookupWays( std::map< GIntBig, std::pair<int,void*> >& aoMapWays,
                                     OSMRelation* psRelation );
@@ -151,6 +151,9 @@ constexpr int MAX_ACCUMULATED_TAGS  = MAX_DELAYED_FEATURES * 5;
 constexpr int MAX_NON_REDUNDANT_VALUES = MAX_DELAYED_FEATURES * 10;
 // Max number of features that are accumulated in panUnsortedReqIds
 constexpr int MAX_ACCUMULATED_NODES = 1000000;
+// Max number of consecutive nodes buffered before being written in the
+// nodes file, in NODES_INDEX=DENSE mode.
+constexpr size_t DENSE_NODES_BUFFER_SIZE = 65536;
 
 #ifdef ENABLE_NODE_LOOKUP_BY_HASHING
 // Size of panHashedIndexes array. Must be in the list at
@@ -277,6 +280,12 @@ OGROSMDataSource::OGROSMDataSource() :
     nRelationsProcessed(0),
     bCustomIndexing(true),
     bCompressNodes(false),
+    eNodeIndexMode(OSM_NODE_INDEX_CUSTOM),
+    nDenseNodesBufferStartId(0),
+    psDenseNodesMap(nullptr),
+    nDenseNodesMapSize(0),
+    bDenseNodesMapFailed(false),
+    nNumThreads(1),
     nUnsortedReqIds(0),
     panUnsortedReqIds(nullptr),
     nReqIds(0),
@@ -387,6 +396,8 @@ OGROSMDataSource::~OGROSMDataSource()
         delete psKD;
     }
 
+    if( psDenseNodesMap )
+        CPLVirtualMemFree(psDenseNodesMap);
     if( fpNodes )
         VSIFCloseL(fpNodes);
     if( !osNodesFilename.empty() && bMustUnlinkNodesFile )
@@ -499,7 +510,13 @@ bool OGROSMDataSource::IndexPoint( OSMNode* psNode )
         return true;
 
     if( bCustomIndexing)
+    {
+        if( eNodeIndexMode == OSM_NODE_INDEX_DENSE )
+            return IndexPointDense(psNode);
+        if( eNodeIndexMode == OSM_NODE_INDEX_SPARSE )
+            return IndexPointSparse(psNode);
         return IndexPointCustom(psNode);
+    }
 
     return IndexPointSQLite(psNode);
 }
@@ -802,6 +819,120 @@ bool OGROSMDataSource::IndexPointCustom(OSMNode* psNode)
     return true;
 }
 
+/************************************************************************/
+/*                          IndexPointDense()                           */
+/************************************************************************/
+
+bool OGROSMDataSource::IndexPointDense(OSMNode* psNode)
+{
+    if( psNode->nID <= nPrevNodeId)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Non increasing node id. Use OSM_USE_CUSTOM_INDEXING=NO");
+        bStopParsing = true;
+        return false;
+    }
+    if( !VALID_ID_FOR_CUSTOM_INDEXING(psNode->nID) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Unsupported node id value (" CPL_FRMT_GIB
+                  "). Use OSM_USE_CUSTOM_INDEXING=NO",
+                  psNode->nID);
+        bStopParsing = true;
+        return false;
+    }
+
+    // Nodes are buffered as long as their ids are consecutive, so that
+    // each run is written with a single seek/write. Gaps between runs are
+    // left as holes in the file, which read back as (0,0), i.e. missing.
+    if( !asDenseNodesBuffer.empty() &&
+        (psNode->nID != nDenseNodesBufferStartId +
+                            static_cast<GIntBig>(asDenseNodesBuffer.size()) ||
+         asDenseNodesBuffer.size() >= DENSE_NODES_BUFFER_SIZE) )
+    {
+        if( !FlushDenseNodesBuffer() )
+        {
+            bStopParsing = true;
+            return false;
+        }
+    }
+    if( asDenseNodesBuffer.empty() )
+        nDenseNodesBufferStartId = psNode->nID;
+
+    LonLat sLonLat;
+    sLonLat.nLon = DBL_TO_INT(psNode->dfLon);
+    sLonLat.nLat = DBL_TO_INT(psNode->dfLat);
+    asDenseNodesBuffer.push_back(sLonLat);
+
+    nPrevNodeId = psNode->nID;
+
+    return true;
+}
+
+/************************************************************************/
+/*                        FlushDenseNodesBuffer()                       */
+/************************************************************************/
+
+bool OGROSMDataSource::FlushDenseNodesBuffer()
+{
+    if( asDenseNodesBuffer.empty() )
+        return true;
+
+    const vsi_l_offset nOffset =
+        static_cast<vsi_l_offset>(nDenseNodesBufferStartId) * sizeof(LonLat);
+    const size_t nCount = asDenseNodesBuffer.size();
+    if( VSIFSeekL(fpNodes, nOffset, SEEK_SET) != 0 ||
+        VSIFWriteL(&asDenseNodesBuffer[0], sizeof(LonLat), nCount,
+                   fpNodes) != nCount )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot write in temporary node file %s : %s",
+                  osNodesFilename.c_str(), VSIStrerror(errno));
+        return false;
+    }
+
+    nNodesFileSize = std::max(nNodesFileSize,
+        static_cast<GIntBig>(nOffset + nCount * sizeof(LonLat)));
+    asDenseNodesBuffer.clear();
+    return true;
+}
+
+/************************************************************************/
+/*                          IndexPointSparse()                          */
+/************************************************************************/
+
+bool OGROSMDataSource::IndexPointSparse(OSMNode* psNode)
+{
+    if( psNode->nID <= nPrevNodeId)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Non increasing node id. Use OSM_USE_CUSTOM_INDEXING=NO");
+        bStopParsing = true;
+        return false;
+    }
+
+    LonLat sLonLat;
+    sLonLat.nLon = DBL_TO_INT(psNode->dfLon);
+    sLonLat.nLat = DBL_TO_INT(psNode->dfLat);
+    try
+    {
+        anSparseNodeIds.push_back(psNode->nID);
+        asSparseNodes.push_back(sLonLat);
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate memory for node index. "
+                 "Use NODES_INDEX=CUSTOM or DENSE");
+        bStopParsing = true;
+        return false;
+    }
+
+    nPrevNodeId = psNode->nID;
+
+    return true;
+}
+
 /************************************************************************/
 /*                             NotifyNodes()                            */
 /************************************************************************/
@@ -1077,6 +1208,12 @@ static bool DecompressSector( const GByte* pabyIn, int nSectorSize,
 
 void OGROSMDataSource::LookupNodesCustom( )
 {
+    if( eNodeIndexMode != OSM_NODE_INDEX_CUSTOM )
+    {
+        LookupNodesDenseOrSparse();
+        return;
+    }
+
     nReqIds = 0;
 
     if( nBucketOld >= 0 )
@@ -1372,6 +1509,261 @@ void OGROSMDataSource::LookupNodesCustomNonCompressedCase()
     nReqIds = j;
 }
 
+/************************************************************************/
+/*                          LookupNodesRange()                          */
+/************************************************************************/
+
+/* Resolves panReqIds[iStart:iEnd] into pasLonLatArray[iStart:iEnd], with */
+/* (0,0) for missing nodes. Only reads the index, so disjoint ranges can */
+/* be processed concurrently. */
+void OGROSMDataSource::LookupNodesRange( unsigned int iStart,
+                                         unsigned int iEnd ) const
+{
+    if( eNodeIndexMode == OSM_NODE_INDEX_DENSE )
+    {
+        const GByte* pabyBase = static_cast<const GByte*>(
+            CPLVirtualMemGetAddr(psDenseNodesMap));
+        for( unsigned int i = iStart; i < iEnd; i++ )
+        {
+            const GIntBig nOffset = panReqIds[i] *
+                                    static_cast<GIntBig>(sizeof(LonLat));
+            if( nOffset + static_cast<GIntBig>(sizeof(LonLat)) <=
+                                                        nDenseNodesMapSize )
+            {
+                memcpy(&pasLonLatArray[i], pabyBase + nOffset,
+                       sizeof(LonLat));
+            }
+            else
+            {
+                pasLonLatArray[i].nLon = 0;
+                pasLonLatArray[i].nLat = 0;
+            }
+        }
+    }
+    else
+    {
+        // Requested ids are sorted, so each search can start from the
+        // position of the previous one.
+        std::vector<GIntBig>::const_iterator oIter = anSparseNodeIds.begin();
+        const std::vector<GIntBig>::const_iterator oEnd =
+                                                    anSparseNodeIds.end();
+        for( unsigned int i = iStart; i < iEnd; i++ )
+        {
+            oIter = std::lower_bound(oIter, oEnd, panReqIds[i]);
+            if( oIter != oEnd && *oIter == panReqIds[i] )
+            {
+                pasLonLatArray[i] =
+                    asSparseNodes[oIter - anSparseNodeIds.begin()];
+            }
+            else
+            {
+                pasLonLatArray[i].nLon = 0;
+                pasLonLatArray[i].nLat = 0;
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                      LookupNodesJobThreadFunc()                      */
+/************************************************************************/
+
+namespace {
+struct OGROSMLookupNodesJob
+{
+    const OGROSMDataSource* poDS = nullptr;
+    unsigned int            iStart = 0;
+    unsigned int            iEnd = 0;
+};
+} // namespace
+
+void OGROSMDataSource::LookupNodesJobThreadFunc( void* pData )
+{
+    OGROSMLookupNodesJob* psJob = static_cast<OGROSMLookupNodesJob*>(pData);
+    psJob->poDS->LookupNodesRange(psJob->iStart, psJob->iEnd);
+}
+
+/************************************************************************/
+/*                      LookupNodesDenseNonMapped()                     */
+/************************************************************************/
+
+/* Fallback of the dense mode when the nodes file cannot be memory mapped. */
+void OGROSMDataSource::LookupNodesDenseNonMapped()
+{
+    // To be glibc friendly, we will do reads aligned on 4096 byte offsets
+    const int knDISK_SECTOR_SIZE = 4096;
+    GByte abyDiskSector[knDISK_SECTOR_SIZE];
+    // Offset in the nodes files for which abyDiskSector was read
+    GIntBig nOldOffset = -knDISK_SECTOR_SIZE-1;
+    // Number of valid bytes in abyDiskSector
+    size_t nValidBytes = 0;
+    for( unsigned int i = 0; i < nReqIds; i++ )
+    {
+        const GIntBig nOffset = panReqIds[i] *
+                                static_cast<GIntBig>(sizeof(LonLat));
+        if( nOffset < nOldOffset ||
+            nOffset - nOldOffset >= knDISK_SECTOR_SIZE )
+        {
+            const GIntBig nAlignedNewPos = nOffset &
+                        ~(static_cast<GIntBig>(knDISK_SECTOR_SIZE)-1);
+            nValidBytes = 0;
+            if( VSIFSeekL(fpNodes, nAlignedNewPos, SEEK_SET) == 0 )
+            {
+                nValidBytes =
+                    VSIFReadL(abyDiskSector, 1, knDISK_SECTOR_SIZE, fpNodes);
+            }
+            nOldOffset = nAlignedNewPos;
+        }
+
+        const size_t nOffsetInDiskSector =
+            static_cast<size_t>(nOffset - nOldOffset);
+        if( nValidBytes < sizeof(LonLat) ||
+            nOffsetInDiskSector > nValidBytes - sizeof(LonLat) )
+        {
+            pasLonLatArray[i].nLon = 0;
+            pasLonLatArray[i].nLat = 0;
+        }
+        else
+        {
+            memcpy( &pasLonLatArray[i],
+                    abyDiskSector + nOffsetInDiskSector,
+                    sizeof(LonLat) );
+        }
+    }
+}
+
+/************************************************************************/
+/*                      LookupNodesDenseOrSparse()                      */
+/************************************************************************/
+
+void OGROSMDataSource::LookupNodesDenseOrSparse()
+{
+    nReqIds = 0;
+
+    if( eNodeIndexMode == OSM_NODE_INDEX_DENSE )
+    {
+        if( !FlushDenseNodesBuffer() )
+        {
+            bStopParsing = true;
+            return;
+        }
+
+        // (Re)map the nodes file if it has grown since the last batch.
+        if( !bDenseNodesMapFailed && nNodesFileSize > nDenseNodesMapSize )
+        {
+            if( psDenseNodesMap != nullptr )
+            {
+                CPLVirtualMemFree(psDenseNodesMap);
+                psDenseNodesMap = nullptr;
+                nDenseNodesMapSize = 0;
+            }
+            VSIFFlushL(fpNodes);
+            if( CPLIsVirtualMemFileMapAvailable() )
+            {
+                CPLPushErrorHandler(CPLQuietErrorHandler);
+                psDenseNodesMap = CPLVirtualMemFileMapNew(
+                    fpNodes, 0, static_cast<vsi_l_offset>(nNodesFileSize),
+                    VIRTUALMEM_READONLY, nullptr, nullptr);
+                CPLPopErrorHandler();
+            }
+            if( psDenseNodesMap != nullptr )
+            {
+                nDenseNodesMapSize = nNodesFileSize;
+            }
+            else
+            {
+                CPLDebug("OSM", "Cannot memory map %s. "
+                         "Using regular file reads for node lookups",
+                         osNodesFilename.c_str());
+                bDenseNodesMapFailed = true;
+            }
+        }
+    }
+
+    CPLAssert(
+        nUnsortedReqIds <= static_cast<unsigned int>(MAX_ACCUMULATED_NODES));
+
+    for( unsigned int i = 0; i < nUnsortedReqIds; i++ )
+    {
+        const GIntBig id = panUnsortedReqIds[i];
+        if( eNodeIndexMode == OSM_NODE_INDEX_DENSE &&
+            !VALID_ID_FOR_CUSTOM_INDEXING(id) )
+            continue;
+        panReqIds[nReqIds++] = id;
+    }
+
+    std::sort(panReqIds, panReqIds + nReqIds);
+
+    /* Remove duplicates */
+    unsigned int j = 0;  // Used after for.
+    for( unsigned int i = 0; i < nReqIds; i++)
+    {
+        if( !(i > 0 && panReqIds[i] == panReqIds[i-1]) )
+            panReqIds[j++] = panReqIds[i];
+    }
+    nReqIds = j;
+
+    if( eNodeIndexMode == OSM_NODE_INDEX_DENSE && psDenseNodesMap == nullptr )
+    {
+        LookupNodesDenseNonMapped();
+    }
+    else
+    {
+        // Below that number of ids, dispatching to threads is not worth it.
+        constexpr unsigned int knMIN_IDS_PER_THREAD = 10000;
+        const int nThreads = std::min(nNumThreads,
+            static_cast<int>(std::max(1U, nReqIds / knMIN_IDS_PER_THREAD)));
+        if( nThreads > 1 && poNodesLookupQueue == nullptr )
+        {
+            CPLWorkerThreadPool* poPool =
+                CPLGetGlobalWorkerThreadPool(nNumThreads);
+            if( poPool )
+                poNodesLookupQueue = poPool->CreateJobQueue();
+            else
+                nNumThreads = 1;
+        }
+        if( nThreads > 1 && poNodesLookupQueue != nullptr )
+        {
+            std::vector<OGROSMLookupNodesJob> asJobs(nThreads);
+            for( int i = 0; i < nThreads; i++ )
+            {
+                asJobs[i].poDS = this;
+                asJobs[i].iStart = static_cast<unsigned int>(
+                    static_cast<GUIntBig>(nReqIds) * i / nThreads);
+                asJobs[i].iEnd = static_cast<unsigned int>(
+                    static_cast<GUIntBig>(nReqIds) * (i + 1) / nThreads);
+            }
+            for( int i = 1; i < nThreads; i++ )
+            {
+                if( !poNodesLookupQueue->SubmitJob(LookupNodesJobThreadFunc,
+                                                   &asJobs[i]) )
+                {
+                    LookupNodesJobThreadFunc(&asJobs[i]);
+                }
+            }
+            LookupNodesJobThreadFunc(&asJobs[0]);
+            poNodesLookupQueue->WaitCompletion();
+        }
+        else
+        {
+            LookupNodesRange(0, nReqIds);
+        }
+    }
+
+    /* Remove nodes that were not found */
+    j = 0;
+    for( unsigned int i = 0; i < nReqIds; i++ )
+    {
+        if( pasLonLatArray[i].nLon || pasLonLatArray[i].nLat )
+        {
+            panReqIds[j] = panReqIds[i];
+            pasLonLatArray[j] = pasLonLatArray[i];
+            j++;
+        }
+    }
+    nReqIds = j;
+}
+
 /************************************************************************/
 /*                            WriteVarInt()                             */
 /************************************************************************/
@@ -2841,6 +3233,29 @@ int OGROSMDataSource::Open( const char * pszFilename,
     if( bCompressNodes )
         CPLDebug("OSM", "Using compression for nodes DB");
 
+    const char* pszNodesIndex = CSLFetchNameValueDef(
+            papszOpenOptionsIn, "NODES_INDEX",
+                        CPLGetConfigOption("OSM_NODES_INDEX", "CUSTOM"));
+    if( EQUAL(pszNodesIndex, "DENSE") )
+        eNodeIndexMode = OSM_NODE_INDEX_DENSE;
+    else if( EQUAL(pszNodesIndex, "SPARSE") )
+        eNodeIndexMode = OSM_NODE_INDEX_SPARSE;
+    else if( !EQUAL(pszNodesIndex, "CUSTOM") )
+    {
+        CPLError(CE_Warning, CPLE_NotSupported,
+                 "Unsupported value for NODES_INDEX: %s. Using CUSTOM",
+                 pszNodesIndex);
+    }
+    if( eNodeIndexMode != OSM_NODE_INDEX_CUSTOM )
+    {
+        if( !bCustomIndexing )
+            eNodeIndexMode = OSM_NODE_INDEX_CUSTOM;
+        else
+            CPLDebug("OSM", "Using %s nodes index", pszNodesIndex);
+    }
+
+    nNumThreads = CPLGetNumThreads(papszOpenOptionsIn);
+
     nLayers = 5;
     papoLayers = static_cast<OGROSMLayer **>(
         CPLMalloc(nLayers * sizeof(OGROSMLayer*)) );
@@ -2929,7 +3344,31 @@ int OGROSMDataSource::Open( const char * pszFilename,
         nSize = static_cast<GIntBig>(nMaxSizeForInMemoryDBInMB) * 1024 * 1024;
     }
 
-    if( bCustomIndexing )
+    if( bCustomIndexing && eNodeIndexMode == OSM_NODE_INDEX_DENSE )
+    {
+        // The nodes file is addressed by node id, so it is only sparsely
+        // populated for extracts and may be very large for a planet file:
+        // always put it on disk.
+        osNodesFilename = CPLGenerateTempFilename("osm_tmp_nodes");
+        fpNodes = VSIFOpenL(osNodesFilename, "wb+");
+        if( fpNodes == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_FileIO, "Cannot create %s",
+                     osNodesFilename.c_str());
+            return FALSE;
+        }
+
+        /* On Unix filesystems, you can remove a file even if it */
+        /* opened */
+        const char* pszVal = CPLGetConfigOption("OSM_UNLINK_TMPFILE", "YES");
+        if( EQUAL(pszVal, "YES") )
+        {
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            bMustUnlinkNodesFile = VSIUnlink( osNodesFilename ) != 0;
+            CPLPopErrorHandler();
+        }
+    }
+    else if( bCustomIndexing && eNodeIndexMode == OSM_NODE_INDEX_CUSTOM )
     {
         pabySector = static_cast<GByte *>(VSI_CALLOC_VERBOSE(1, SECTOR_SIZE));
 
@@ -3794,7 +4233,8 @@ int OGROSMDataSource::MyResetReading()
 {
     if( hDB == nullptr )
         return FALSE;
-    if( bCustomIndexing && fpNodes == nullptr )
+    if( bCustomIndexing && eNodeIndexMode != OSM_NODE_INDEX_SPARSE &&
+        fpNodes == nullptr )
         return FALSE;
 
     OSM_ResetReading(psParser);
@@ -3856,7 +4296,28 @@ int OGROSMDataSource::MyResetReading()
         nNextKeyIndex = 0;
     }
 
-    if( bCustomIndexing )
+    if( bCustomIndexing && eNodeIndexMode == OSM_NODE_INDEX_DENSE )
+    {
+        nPrevNodeId = -1;
+        asDenseNodesBuffer.clear();
+        if( psDenseNodesMap )
+        {
+            CPLVirtualMemFree(psDenseNodesMap);
+            psDenseNodesMap = nullptr;
+        }
+        nDenseNodesMapSize = 0;
+
+        VSIFSeekL(fpNodes, 0, SEEK_SET);
+        VSIFTruncateL(fpNodes, 0);
+        nNodesFileSize = 0;
+    }
+    else if( bCustomIndexing && eNodeIndexMode == OSM_NODE_INDEX_SPARSE )
+    {
+        nPrevNodeId = -INT_MAX;
+        anSparseNodeIds.clear();
+        asSparseNodes.clear();
+    }
+    else if( bCustomIndexing )
     {
         nPrevNodeId = -1;
         nBucketOld = -1;
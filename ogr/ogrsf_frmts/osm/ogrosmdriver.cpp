@@ -119,6 +119,12 @@ void RegisterOGROSM()
 "  <Option name='CONFIG_FILE' type='string' description='Configuration filename.'/>"
 "  <Option name='USE_CUSTOM_INDEXING' type='boolean' description='Whether to enable custom indexing.' default='YES'/>"
 "  <Option name='COMPRESS_NODES' type='boolean' description='Whether to compress nodes in temporary DB.' default='NO'/>"
+"  <Option name='NODES_INDEX' type='string-select' description='Structure used to index nodes when custom indexing is enabled.' default='CUSTOM'>"
+"    <Value>CUSTOM</Value>"
+"    <Value>DENSE</Value>"
+"    <Value>SPARSE</Value>"
+"  </Option>"
+"  <Option name='NUM_THREADS' type='string' description='Number of threads used to resolve node locations of ways. Integer or ALL_CPUS' default='1'/>"
 "  <Option name='MAX_TMPFILE_SIZE' type='int' description='Maximum size in MB of in-memory temporary file. If it exceeds that value, it will go to disk' default='100'/>"
 "  <Option name='INTERLEAVED_READING' type='boolean' description='Whether to enable interleaved reading.' default='NO'/>"
 "</OpenOptionList>" );
@@ -154,7 +154,7 @@ struct _OSMContext
 
     GByte         *pabyBlobHeader; // MAX_BLOB_HEADER_SIZE+EXTRA_BYTES large
 
-    CPLWorkerThreadPool* poWTP;
+    CPLJobQueue*   poJobQueue;  // in the global worker thread pool
 
     GByte         *pabyUncompressed;
     unsigned int   nUncompressedAllocated;
@@ -1646,15 +1646,19 @@ static bool RunDecompressionJobs(OSMContext* psCtxt)
     for( int i = 0; i < psCtxt->nJobs; i++ )
     {
         psCtxt->asJobs[i].pabyDstBase = pabyDstBase;
-        if( psCtxt->poWTP )
+        if( psCtxt->poJobQueue )
             ahJobs.push_back(&psCtxt->asJobs[i]);
         else
             DecompressFunction(&psCtxt->asJobs[i]);
     }
-    if( psCtxt->poWTP )
+    if( psCtxt->poJobQueue )
     {
-        psCtxt->poWTP->SubmitJobs(DecompressFunction, ahJobs);
-        psCtxt->poWTP->WaitCompletion();
+        for( void* pJob: ahJobs )
+        {
+            if( !psCtxt->poJobQueue->SubmitJob(DecompressFunction, pJob) )
+                DecompressFunction(pJob);
+        }
+        psCtxt->poJobQueue->WaitCompletion();
     }
 
     bool bRet = true;
@@ -1835,7 +1839,7 @@ bool ReadBlob( OSMContext* psCtxt, BlobType eType )
                                                     psCtxt->nTotalUncompressedSize;
                     psCtxt->asJobs[psCtxt->nJobs].nDstSize = nUncompressedSize;
                     psCtxt->nJobs ++;
-                    if( psCtxt->poWTP == nullptr || eType != BLOB_OSMDATA )
+                    if( psCtxt->poJobQueue == nullptr || eType != BLOB_OSMDATA )
                     {
                         if( !RunDecompressionJobsAndProcessAll(psCtxt, eType) )
                         {
@@ -2001,7 +2005,7 @@ static OSMRetCode PBF_ProcessBlock(OSMContext* psCtxt)
 
         nBlobCount ++;
 
-        if( eType == BLOB_OSMDATA && psCtxt->poWTP != nullptr )
+        if( eType == BLOB_OSMDATA && psCtxt->poJobQueue != nullptr )
         {
             // Accumulate BLOB_OSMDATA until we reach either the maximum
             // number of jobs or a threshold in bytes
@@ -2754,20 +2758,13 @@ OSMContext* OSM_Open( const char* pszFilename,
         OSM_Close(psCtxt);
         return nullptr;
     }
-    const char* pszNumThreads =
-                CPLGetConfigOption("GDAL_NUM_THREADS", "ALL_CPUS");
-    int nNumCPUs = CPLGetNumCPUs();
-    if( pszNumThreads && !EQUAL(pszNumThreads, "ALL_CPUS") )
-        nNumCPUs = std::max(0, std::min(2 * nNumCPUs, atoi(pszNumThreads)));
+    const int nNumCPUs = std::min(2 * CPLGetNumCPUs(),
+                                  CPLGetNumThreads(nullptr, "ALL_CPUS"));
     if( nNumCPUs > 1 )
     {
-        psCtxt->poWTP = new CPLWorkerThreadPool();
-        // coverity[tainted_data]
-        if( !psCtxt->poWTP->Setup(nNumCPUs , nullptr, nullptr) )
-        {
-            delete psCtxt->poWTP;
-            psCtxt->poWTP = nullptr;
-        }
+        CPLWorkerThreadPool* poPool = CPLGetGlobalWorkerThreadPool(nNumCPUs);
+        if( poPool )
+            psCtxt->poJobQueue = poPool->CreateJobQueue().release();
     }
 
     return psCtxt;
@@ -2800,7 +2797,7 @@ void OSM_Close(OSMContext* psCtxt)
     VSIFree(psCtxt->pasTags);
     VSIFree(psCtxt->pasMembers);
     VSIFree(psCtxt->panNodeRefs);
-    delete psCtxt->poWTP;
+    delete psCtxt->poJobQueue;
 
     VSIFCloseL(psCtxt->fp);
     VSIFree(psCtxt);
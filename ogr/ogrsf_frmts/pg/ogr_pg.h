@@ -38,6 +38,8 @@
 #include "ogrpgutility.h"
 #include "ogr_pgdump.h"
 
+#include <vector>
+
 /* These are the OIDs for some builtin types, as returned by PQftype(). */
 /* They were copied from pg_type.h in src/include/catalog/pg_type.h */
 
@@ -200,6 +202,16 @@ class OGRPGLayer : public OGRLayer
     void                SetInitialQueryCursor();
     void                CloseCursor();
 
+    /* OGR_PG_CURSOR_PREFETCH: FETCH of the next page sent while the */
+    /* current one is being translated into features */
+    bool                bPrefetchPending = false;
+    PGresult           *hPrefetchResult = nullptr;
+    void                StartPrefetch();
+    void                CompletePrefetch();
+    static void         CompletePrefetchCbk( void* pUserData );
+    void                DiscardPrefetch();
+    PGresult           *FetchNextPage();
+
     virtual CPLString   GetFromClauseForGetExtent() = 0;
     OGRErr              RunGetExtentRequest( OGREnvelope *psExtent, int bForce,
                                              CPLString osCommand, int bErrorAsDebug );
@@ -247,6 +259,16 @@ class OGRPGLayer : public OGRLayer
 /*                           OGRPGTableLayer                            */
 /************************************************************************/
 
+class OGRPGBinaryCopySender;
+
+/* Encoding of a column in the binary COPY format (PG_USE_COPY=BINARY) */
+typedef struct
+{
+    int                 nEncoding;
+    int                 nElemEncoding;  /* for arrays */
+    int                 nElemOID;       /* for arrays */
+} OGRPGBinaryCopyColumn;
+
 class OGRPGTableLayer final: public OGRPGLayer
 {
     int                 bUpdateAccess;
@@ -285,6 +307,20 @@ class OGRPGTableLayer final: public OGRPGLayer
     OGRErr              CreateFeatureViaInsert( OGRFeature *poFeature );
     CPLString           BuildCopyFields();
 
+    /* PG_USE_COPY=BINARY */
+    bool                bBinaryCopyDisabled = false;
+    bool                bBinaryCopyActive = false;
+    std::vector<OGRPGBinaryCopyColumn> aoBinaryCopyColumns{};
+    std::vector<GByte>  abyBinaryCopyBuffer{};
+    std::vector<GByte>  abyBinaryCopyRow{};
+    OGRPGBinaryCopySender *poBinaryCopySender = nullptr;
+
+    bool                PrepareBinaryCopy();
+    bool                TranslateFeatureToBinaryCopy( OGRFeature *poFeature );
+    OGRErr              FlushBinaryCopyBuffer();
+    OGRErr              CreateFeatureViaBinaryCopy( OGRFeature *poFeature,
+                                                    bool& bFallback );
+
     int                 bHasWarnedIncompatibleGeom;
     void                CheckGeomTypeCompatibility(int iGeomField, OGRGeometry* poGeom);
 
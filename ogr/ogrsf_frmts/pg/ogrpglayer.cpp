@@ -133,6 +133,8 @@ void OGRPGLayer::CloseCursor()
 {
     PGconn      *hPGConn = poDS->GetPGConn();
 
+    DiscardPrefetch();
+
     if( hCursorResult != nullptr )
     {
         OGRPGClearResult( hCursorResult );
@@ -152,6 +154,127 @@ void OGRPGLayer::CloseCursor()
     }
 }
 
+/************************************************************************/
+/*                           StartPrefetch()                            */
+/*                                                                      */
+/*      Send the FETCH of the next page of the cursor without           */
+/*      waiting for its result, so that the server and the network     */
+/*      work while the current page is translated into features.       */
+/************************************************************************/
+
+void OGRPGLayer::StartPrefetch()
+{
+    // Large objects are read with the synchronous lo_xxx() functions
+    // while translating records, which cannot be interleaved with
+    // a pending query.
+    if( bPrefetchPending || hPrefetchResult != nullptr || bWkbAsOid ||
+        !CPLTestBool(CPLGetConfigOption("OGR_PG_CURSOR_PREFETCH", "YES")) )
+        return;
+
+    PGconn      *hPGConn = poDS->GetPGConn();
+
+    // Another layer using the same connection might be waiting for its
+    // own page.
+    OGRPGCompletePendingQuery(hPGConn);
+
+    CPLString   osCommand;
+    osCommand.Printf( "FETCH %d in %s", nCursorPage, pszCursorName );
+    if( !PQsendQueryParams(hPGConn, osCommand, 0, nullptr, nullptr,
+                           nullptr, nullptr, 0) )
+    {
+        CPLDebug( "PG", "PQsendQueryParams(%s) failed: %s",
+                  osCommand.c_str(), PQerrorMessage( hPGConn ) );
+        return;
+    }
+#ifdef DEBUG
+    CPLDebug( "PG", "PQsendQueryParams(%s)", osCommand.c_str() );
+#endif
+
+    bPrefetchPending = true;
+    OGRPGSetPendingQuery(hPGConn, CompletePrefetchCbk, this);
+}
+
+/************************************************************************/
+/*                          CompletePrefetch()                          */
+/*                                                                      */
+/*      Wait for the result of the pending FETCH, and keep it in        */
+/*      hPrefetchResult.                                                */
+/************************************************************************/
+
+void OGRPGLayer::CompletePrefetch()
+{
+    if( !bPrefetchPending )
+        return;
+
+    PGconn      *hPGConn = poDS->GetPGConn();
+    OGRPGUnsetPendingQuery(hPGConn, this);
+    bPrefetchPending = false;
+
+    PGresult    *hResult;
+    while( (hResult = PQgetResult(hPGConn)) != nullptr )
+    {
+        if( hPrefetchResult == nullptr )
+            hPrefetchResult = hResult;
+        else
+            PQclear(hResult);
+    }
+
+    if( !hPrefetchResult ||
+        PQresultStatus(hPrefetchResult) == PGRES_NONFATAL_ERROR ||
+        PQresultStatus(hPrefetchResult) == PGRES_FATAL_ERROR )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "%s", PQerrorMessage( hPGConn ) );
+    }
+}
+
+void OGRPGLayer::CompletePrefetchCbk( void* pUserData )
+{
+    static_cast<OGRPGLayer*>(pUserData)->CompletePrefetch();
+}
+
+/************************************************************************/
+/*                          DiscardPrefetch()                           */
+/************************************************************************/
+
+void OGRPGLayer::DiscardPrefetch()
+{
+    if( bPrefetchPending )
+    {
+        CPLErrorHandlerPusher oErrorHandler(CPLQuietErrorHandler);
+        CompletePrefetch();
+    }
+    OGRPGClearResult( hPrefetchResult );
+}
+
+/************************************************************************/
+/*                           FetchNextPage()                            */
+/************************************************************************/
+
+PGresult* OGRPGLayer::FetchNextPage()
+{
+    PGresult    *hResult;
+    if( bPrefetchPending || hPrefetchResult != nullptr )
+    {
+        CompletePrefetch();
+        hResult = hPrefetchResult;
+        hPrefetchResult = nullptr;
+    }
+    else
+    {
+        CPLString   osCommand;
+        osCommand.Printf( "FETCH %d in %s", nCursorPage, pszCursorName );
+        hResult = OGRPG_PQexec(poDS->GetPGConn(), osCommand );
+    }
+
+    if( hResult && PQresultStatus(hResult) == PGRES_TUPLES_OK &&
+        PQntuples(hResult) == nCursorPage )
+    {
+        StartPrefetch();
+    }
+    return hResult;
+}
+
 /************************************************************************/
 /*                       InvalidateCursor()                             */
 /************************************************************************/
@@ -1446,8 +1569,7 @@ void OGRPGLayer::SetInitialQueryCursor()
     }
     OGRPGClearResult( hCursorResult );
 
-    osCommand.Printf( "FETCH %d in %s", nCursorPage, pszCursorName );
-    hCursorResult = OGRPG_PQexec(hPGConn, osCommand );
+    hCursorResult = FetchNextPage();
 
     CreateMapFromFieldNameToIndex(hCursorResult,
                                   poFeatureDefn,
@@ -1508,8 +1630,7 @@ OGRFeature *OGRPGLayer::GetNextRawFeature()
     {
         OGRPGClearResult( hCursorResult );
 
-        osCommand.Printf( "FETCH %d in %s", nCursorPage, pszCursorName );
-        hCursorResult = OGRPG_PQexec(hPGConn, osCommand );
+        hCursorResult = FetchNextPage();
 
         nResultOffset = 0;
     }
@@ -1527,6 +1648,13 @@ OGRFeature *OGRPGLayer::GetNextRawFeature()
         return nullptr;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Read what has already arrived of the next page, so that the     */
+/*      server is not blocked by a full socket buffer.                  */
+/* -------------------------------------------------------------------- */
+    if( bPrefetchPending && (nResultOffset % 64) == 0 )
+        PQconsumeInput( hPGConn );
+
 /* -------------------------------------------------------------------- */
 /*      Create a feature from the current result.                       */
 /* -------------------------------------------------------------------- */
@@ -1580,6 +1708,9 @@ OGRErr OGRPGLayer::SetNextByIndex( GIntBig nIndex )
 
     OGRPGClearResult( hCursorResult );
 
+    /* The prefetched page is not the one following the new position */
+    DiscardPrefetch();
+
     osCommand.Printf( "FETCH ABSOLUTE " CPL_FRMT_GIB " in %s", nIndex+1, pszCursorName );
     hCursorResult = OGRPG_PQexec(hPGConn, osCommand );
 
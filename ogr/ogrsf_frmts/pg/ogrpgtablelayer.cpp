@@ -33,6 +33,11 @@
 #include "cpl_string.h"
 #include "cpl_error.h"
 #include "ogr_p.h"
+#include "cpl_time.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <map>
+#include <mutex>
 
 #define PQexec this_is_an_error
 
@@ -1907,6 +1912,824 @@ OGRErr OGRPGTableLayer::CreateFeatureViaInsert( OGRFeature *poFeature )
     return OGRERR_NONE;
 }
 
+/************************************************************************/
+/*                        OGRPGBinaryCopySender                         */
+/************************************************************************/
+
+/* Sends the chunks of a binary COPY with PQputCopyData() on a worker
+   thread, so that the next rows can be formatted in the meantime. The
+   connection is not used by the calling thread until WaitCompletion()
+   has been called, since the datasource ends the COPY before issuing
+   any other statement. */
+
+class OGRPGBinaryCopySender
+{
+        CPL_DISALLOW_COPY_ASSIGN(OGRPGBinaryCopySender)
+
+        PGconn             *hPGConn;
+        CPLWorkerThreadPool oPool{};
+        bool                bUsePool = false;
+        std::mutex          oMutex{};
+        CPLString           osError{};
+
+        struct Job
+        {
+            OGRPGBinaryCopySender *poSender;
+            std::vector<GByte>     abyData;
+        };
+
+        static void         SendJob( void* pData );
+        void                Send( const std::vector<GByte>& abyData );
+
+    public:
+        explicit            OGRPGBinaryCopySender( PGconn* hPGConnIn );
+
+        void                Submit( std::vector<GByte>& abyData );
+        void                WaitCompletion();
+        CPLString           GetError();
+};
+
+OGRPGBinaryCopySender::OGRPGBinaryCopySender( PGconn* hPGConnIn ) :
+    hPGConn(hPGConnIn)
+{
+    bUsePool = oPool.Setup(1, nullptr, nullptr);
+}
+
+void OGRPGBinaryCopySender::Send( const std::vector<GByte>& abyData )
+{
+    {
+        std::lock_guard<std::mutex> oLock(oMutex);
+        if( !osError.empty() )
+            return;
+    }
+
+    const int copyResult = PQputCopyData(hPGConn,
+                            reinterpret_cast<const char*>(abyData.data()),
+                            static_cast<int>(abyData.size()));
+    if( copyResult != 1 )
+    {
+        std::lock_guard<std::mutex> oLock(oMutex);
+        osError = copyResult == 0 ? "Writing COPY data blocked." :
+                                    PQerrorMessage(hPGConn);
+    }
+}
+
+void OGRPGBinaryCopySender::SendJob( void* pData )
+{
+    Job* psJob = static_cast<Job*>(pData);
+    psJob->poSender->Send(psJob->abyData);
+    delete psJob;
+}
+
+void OGRPGBinaryCopySender::Submit( std::vector<GByte>& abyData )
+{
+    if( !bUsePool )
+    {
+        Send(abyData);
+        abyData.clear();
+        return;
+    }
+
+    // At most one chunk waiting behind the one being sent, to keep the
+    // memory use bounded when the server is slower than the formatting.
+    oPool.WaitCompletion(1);
+    Job* psJob = new Job{ this, std::vector<GByte>() };
+    psJob->abyData.swap(abyData);
+    if( !oPool.SubmitJob(SendJob, psJob) )
+        SendJob(psJob);
+}
+
+void OGRPGBinaryCopySender::WaitCompletion()
+{
+    if( bUsePool )
+        oPool.WaitCompletion();
+}
+
+CPLString OGRPGBinaryCopySender::GetError()
+{
+    std::lock_guard<std::mutex> oLock(oMutex);
+    return osError;
+}
+
+/************************************************************************/
+/*                     OGRPGBinaryCopy encodings                        */
+/************************************************************************/
+
+enum
+{
+    PG_BINARY_COPY_UNSUPPORTED = 0,
+    PG_BINARY_COPY_BOOL,
+    PG_BINARY_COPY_INT2,
+    PG_BINARY_COPY_INT4,
+    PG_BINARY_COPY_INT8,
+    PG_BINARY_COPY_FLOAT4,
+    PG_BINARY_COPY_FLOAT8,
+    PG_BINARY_COPY_TEXT,
+    PG_BINARY_COPY_JSONB,
+    PG_BINARY_COPY_BYTEA,
+    PG_BINARY_COPY_DATE,
+    PG_BINARY_COPY_TIME,
+    PG_BINARY_COPY_TIMESTAMP,
+    PG_BINARY_COPY_TIMESTAMPTZ,
+    PG_BINARY_COPY_EWKB,
+    PG_BINARY_COPY_ARRAY
+};
+
+/* Builtin scalar types whose binary representation we know how to write */
+static int OGRPGGetBinaryCopyEncoding( const char* pszTypName,
+                                       bool bIntegerDatetimes,
+                                       int* pnOID )
+{
+    static const struct
+    {
+        const char* pszTypName;
+        int         nEncoding;
+        int         nOID;
+    } asTypes[] =
+    {
+        { "bool", PG_BINARY_COPY_BOOL, BOOLOID },
+        { "int2", PG_BINARY_COPY_INT2, INT2OID },
+        { "int4", PG_BINARY_COPY_INT4, INT4OID },
+        { "int8", PG_BINARY_COPY_INT8, INT8OID },
+        { "float4", PG_BINARY_COPY_FLOAT4, FLOAT4OID },
+        { "float8", PG_BINARY_COPY_FLOAT8, FLOAT8OID },
+        { "text", PG_BINARY_COPY_TEXT, TEXTOID },
+        { "varchar", PG_BINARY_COPY_TEXT, VARCHAROID },
+        { "bpchar", PG_BINARY_COPY_TEXT, BPCHAROID },
+        { "json", PG_BINARY_COPY_TEXT, JSONOID },
+        { "jsonb", PG_BINARY_COPY_JSONB, JSONBOID },
+        { "bytea", PG_BINARY_COPY_BYTEA, BYTEAOID },
+        { "date", PG_BINARY_COPY_DATE, DATEOID },
+        { "time", PG_BINARY_COPY_TIME, TIMEOID },
+        { "timestamp", PG_BINARY_COPY_TIMESTAMP, TIMESTAMPOID },
+        { "timestamptz", PG_BINARY_COPY_TIMESTAMPTZ, TIMESTAMPTZOID },
+        { "geometry", PG_BINARY_COPY_EWKB, 0 },
+        { "geography", PG_BINARY_COPY_EWKB, 0 },
+    };
+
+    for( const auto& sType: asTypes )
+    {
+        if( EQUAL(pszTypName, sType.pszTypName) )
+        {
+            // Old servers may represent date/time values as doubles.
+            if( !bIntegerDatetimes &&
+                (sType.nEncoding == PG_BINARY_COPY_TIME ||
+                 sType.nEncoding == PG_BINARY_COPY_TIMESTAMP ||
+                 sType.nEncoding == PG_BINARY_COPY_TIMESTAMPTZ) )
+            {
+                return PG_BINARY_COPY_UNSUPPORTED;
+            }
+            if( pnOID )
+                *pnOID = sType.nOID;
+            return sType.nEncoding;
+        }
+    }
+    return PG_BINARY_COPY_UNSUPPORTED;
+}
+
+/* Whether a value of type eType can be written with nEncoding */
+static bool OGRPGIsCompatibleBinaryCopyEncoding( OGRFieldType eType,
+                                                 int nEncoding,
+                                                 int nElemEncoding )
+{
+    switch( eType )
+    {
+        case OFTInteger:
+        case OFTInteger64:
+            return nEncoding == PG_BINARY_COPY_BOOL ||
+                   nEncoding == PG_BINARY_COPY_INT2 ||
+                   nEncoding == PG_BINARY_COPY_INT4 ||
+                   nEncoding == PG_BINARY_COPY_INT8;
+        case OFTReal:
+            return nEncoding == PG_BINARY_COPY_FLOAT4 ||
+                   nEncoding == PG_BINARY_COPY_FLOAT8;
+        case OFTString:
+            return nEncoding == PG_BINARY_COPY_TEXT ||
+                   nEncoding == PG_BINARY_COPY_JSONB;
+        case OFTBinary:
+            return nEncoding == PG_BINARY_COPY_BYTEA;
+        case OFTDate:
+            return nEncoding == PG_BINARY_COPY_DATE;
+        case OFTTime:
+            return nEncoding == PG_BINARY_COPY_TIME;
+        case OFTDateTime:
+            return nEncoding == PG_BINARY_COPY_TIMESTAMP ||
+                   nEncoding == PG_BINARY_COPY_TIMESTAMPTZ;
+        case OFTIntegerList:
+        case OFTInteger64List:
+            return nEncoding == PG_BINARY_COPY_ARRAY &&
+                   OGRPGIsCompatibleBinaryCopyEncoding(OFTInteger,
+                                                       nElemEncoding, 0);
+        case OFTRealList:
+            return nEncoding == PG_BINARY_COPY_ARRAY &&
+                   OGRPGIsCompatibleBinaryCopyEncoding(OFTReal,
+                                                       nElemEncoding, 0);
+        case OFTStringList:
+            return nEncoding == PG_BINARY_COPY_ARRAY &&
+                   nElemEncoding == PG_BINARY_COPY_TEXT;
+        default:
+            break;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                         PrepareBinaryCopy()                          */
+/*                                                                      */
+/*      Determine the encoding of each column of the COPY, in the      */
+/*      order of BuildCopyFields(). Returns false if one of them       */
+/*      cannot be written in the binary format.                        */
+/************************************************************************/
+
+bool OGRPGTableLayer::PrepareBinaryCopy()
+
+{
+    aoBinaryCopyColumns.clear();
+
+    PGconn *hPGConn = poDS->GetPGConn();
+    const char* pszIntegerDatetimes =
+        PQparameterStatus(hPGConn, "integer_datetimes");
+    const bool bIntegerDatetimes =
+        pszIntegerDatetimes != nullptr && EQUAL(pszIntegerDatetimes, "on");
+
+    CPLString osCommand;
+    osCommand.Printf(
+        "SELECT a.attname, t.typname, et.typname FROM pg_attribute a "
+        "JOIN pg_type t ON t.oid = a.atttypid "
+        "LEFT JOIN pg_type et ON t.typelem = et.oid AND t.typname LIKE '\\_%%' "
+        "WHERE a.attrelid = %s::regclass AND a.attnum > 0 "
+        "AND NOT a.attisdropped",
+        OGRPGEscapeString(hPGConn, pszSqlTableName).c_str());
+    PGresult *hResult = OGRPG_PQexec(hPGConn, osCommand.c_str());
+    if( !hResult || PQresultStatus(hResult) != PGRES_TUPLES_OK )
+    {
+        OGRPGClearResult( hResult );
+        return false;
+    }
+
+    std::map<CPLString, OGRPGBinaryCopyColumn> oMapColumns;
+    for( int iRow = 0; iRow < PQntuples(hResult); iRow++ )
+    {
+        OGRPGBinaryCopyColumn sColumn;
+        sColumn.nEncoding = PG_BINARY_COPY_UNSUPPORTED;
+        sColumn.nElemEncoding = PG_BINARY_COPY_UNSUPPORTED;
+        sColumn.nElemOID = 0;
+        if( !PQgetisnull(hResult, iRow, 2) )
+        {
+            sColumn.nElemEncoding = OGRPGGetBinaryCopyEncoding(
+                PQgetvalue(hResult, iRow, 2), bIntegerDatetimes,
+                &sColumn.nElemOID);
+            if( sColumn.nElemEncoding != PG_BINARY_COPY_UNSUPPORTED &&
+                sColumn.nElemOID != 0 )
+            {
+                sColumn.nEncoding = PG_BINARY_COPY_ARRAY;
+            }
+        }
+        else
+        {
+            sColumn.nEncoding = OGRPGGetBinaryCopyEncoding(
+                PQgetvalue(hResult, iRow, 1), bIntegerDatetimes, nullptr);
+        }
+        oMapColumns[PQgetvalue(hResult, iRow, 0)] = sColumn;
+    }
+    OGRPGClearResult( hResult );
+
+    // Geometry columns first, then the FID, then the attribute fields.
+    for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
+    {
+        OGRPGGeomFieldDefn* poGeomFieldDefn =
+            poFeatureDefn->myGetGeomFieldDefn(i);
+        auto oIter = oMapColumns.find(poGeomFieldDefn->GetNameRef());
+        if( oIter == oMapColumns.end() )
+            return false;
+        const int nEncoding = oIter->second.nEncoding;
+        if( !((poGeomFieldDefn->ePostgisType == GEOM_TYPE_GEOMETRY ||
+               poGeomFieldDefn->ePostgisType == GEOM_TYPE_GEOGRAPHY) &&
+              nEncoding == PG_BINARY_COPY_EWKB) &&
+            !(poGeomFieldDefn->ePostgisType == GEOM_TYPE_WKB &&
+              nEncoding == PG_BINARY_COPY_BYTEA) )
+        {
+            CPLDebug("PG", "Binary COPY not possible for column %s",
+                     poGeomFieldDefn->GetNameRef());
+            return false;
+        }
+        aoBinaryCopyColumns.push_back(oIter->second);
+    }
+
+    int nFIDIndex = -1;
+    if( bFIDColumnInCopyFields )
+    {
+        auto oIter = oMapColumns.find(pszFIDColumn);
+        if( oIter == oMapColumns.end() ||
+            (oIter->second.nEncoding != PG_BINARY_COPY_INT4 &&
+             oIter->second.nEncoding != PG_BINARY_COPY_INT8) )
+        {
+            CPLDebug("PG", "Binary COPY not possible for column %s",
+                     pszFIDColumn);
+            return false;
+        }
+        aoBinaryCopyColumns.push_back(oIter->second);
+        nFIDIndex = poFeatureDefn->GetFieldIndex( pszFIDColumn );
+    }
+
+    for( int i = 0; i < poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( i == nFIDIndex )
+            continue;
+        OGRFieldDefn* poFieldDefn = poFeatureDefn->GetFieldDefn(i);
+        auto oIter = oMapColumns.find(poFieldDefn->GetNameRef());
+        if( oIter == oMapColumns.end() ||
+            !OGRPGIsCompatibleBinaryCopyEncoding(poFieldDefn->GetType(),
+                                            oIter->second.nEncoding,
+                                            oIter->second.nElemEncoding) )
+        {
+            CPLDebug("PG", "Binary COPY not possible for column %s",
+                     poFieldDefn->GetNameRef());
+            return false;
+        }
+        aoBinaryCopyColumns.push_back(oIter->second);
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                   Binary COPY value writing helpers                  */
+/************************************************************************/
+
+static void OGRPGAppendInt16( std::vector<GByte>& abyBuffer, GInt16 nVal )
+{
+    const GUInt16 nMSB = CPL_MSBWORD16(static_cast<GUInt16>(nVal));
+    const GByte* pabyVal = reinterpret_cast<const GByte*>(&nMSB);
+    abyBuffer.insert(abyBuffer.end(), pabyVal, pabyVal + sizeof(nMSB));
+}
+
+static void OGRPGAppendInt32( std::vector<GByte>& abyBuffer, GInt32 nVal )
+{
+    const GUInt32 nMSB = CPL_MSBWORD32(static_cast<GUInt32>(nVal));
+    const GByte* pabyVal = reinterpret_cast<const GByte*>(&nMSB);
+    abyBuffer.insert(abyBuffer.end(), pabyVal, pabyVal + sizeof(nMSB));
+}
+
+static void OGRPGAppendInt64( std::vector<GByte>& abyBuffer, GIntBig nVal )
+{
+    GUInt64 nMSB = static_cast<GUInt64>(nVal);
+    CPL_MSBPTR64(&nMSB);
+    const GByte* pabyVal = reinterpret_cast<const GByte*>(&nMSB);
+    abyBuffer.insert(abyBuffer.end(), pabyVal, pabyVal + sizeof(nMSB));
+}
+
+static void OGRPGAppendFloat32( std::vector<GByte>& abyBuffer, float fVal )
+{
+    GUInt32 nVal;
+    memcpy(&nVal, &fVal, sizeof(nVal));
+    OGRPGAppendInt32(abyBuffer, static_cast<GInt32>(nVal));
+}
+
+static void OGRPGAppendFloat64( std::vector<GByte>& abyBuffer, double dfVal )
+{
+    GUInt64 nVal;
+    memcpy(&nVal, &dfVal, sizeof(nVal));
+    OGRPGAppendInt64(abyBuffer, static_cast<GIntBig>(nVal));
+}
+
+static void OGRPGAppendBytes( std::vector<GByte>& abyBuffer,
+                              const void* pData, size_t nLen )
+{
+    OGRPGAppendInt32(abyBuffer, static_cast<GInt32>(nLen));
+    const GByte* pabyData = static_cast<const GByte*>(pData);
+    abyBuffer.insert(abyBuffer.end(), pabyData, pabyData + nLen);
+}
+
+/* Writes an integer or real value with a fixed width encoding, */
+/* including its length. Returns false if the value does not fit. */
+static bool OGRPGAppendNumber( std::vector<GByte>& abyBuffer, int nEncoding,
+                               GIntBig nVal, double dfVal )
+{
+    switch( nEncoding )
+    {
+        case PG_BINARY_COPY_BOOL:
+            OGRPGAppendInt32(abyBuffer, 1);
+            abyBuffer.push_back(nVal != 0 ? 1 : 0);
+            return true;
+        case PG_BINARY_COPY_INT2:
+            if( nVal < -32768 || nVal > 32767 )
+                return false;
+            OGRPGAppendInt32(abyBuffer, 2);
+            OGRPGAppendInt16(abyBuffer, static_cast<GInt16>(nVal));
+            return true;
+        case PG_BINARY_COPY_INT4:
+            if( nVal < INT_MIN || nVal > INT_MAX )
+                return false;
+            OGRPGAppendInt32(abyBuffer, 4);
+            OGRPGAppendInt32(abyBuffer, static_cast<GInt32>(nVal));
+            return true;
+        case PG_BINARY_COPY_INT8:
+            OGRPGAppendInt32(abyBuffer, 8);
+            OGRPGAppendInt64(abyBuffer, nVal);
+            return true;
+        case PG_BINARY_COPY_FLOAT4:
+            OGRPGAppendInt32(abyBuffer, 4);
+            OGRPGAppendFloat32(abyBuffer, static_cast<float>(dfVal));
+            return true;
+        case PG_BINARY_COPY_FLOAT8:
+            OGRPGAppendInt32(abyBuffer, 8);
+            OGRPGAppendFloat64(abyBuffer, dfVal);
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+/* Number of microseconds between 1970-01-01 and 2000-01-01, */
+/* the epoch of PostgreSQL date and time values. */
+#define PG_EPOCH_UNIX_SECONDS   CPL_STATIC_CAST(GIntBig, 946684800)
+
+static bool OGRPGAppendDateTime( std::vector<GByte>& abyBuffer, int nEncoding,
+                                 const OGRField* psField )
+{
+    const int nMilliSeconds = static_cast<int>(
+                        floor(psField->Date.Second * 1000.0f + 0.5f));
+    struct tm brokendowntime;
+    memset(&brokendowntime, 0, sizeof(brokendowntime));
+    brokendowntime.tm_year = psField->Date.Year - 1900;
+    brokendowntime.tm_mon = psField->Date.Month - 1;
+    brokendowntime.tm_mday = psField->Date.Day;
+    brokendowntime.tm_hour = psField->Date.Hour;
+    brokendowntime.tm_min = psField->Date.Minute;
+    const GIntBig nUnixTime = CPLYMDHMSToUnixTime(&brokendowntime);
+
+    switch( nEncoding )
+    {
+        case PG_BINARY_COPY_DATE:
+        {
+            OGRPGAppendInt32(abyBuffer, 4);
+            OGRPGAppendInt32(abyBuffer, static_cast<GInt32>(
+                (nUnixTime - PG_EPOCH_UNIX_SECONDS) / 86400));
+            return true;
+        }
+        case PG_BINARY_COPY_TIME:
+        {
+            OGRPGAppendInt32(abyBuffer, 8);
+            OGRPGAppendInt64(abyBuffer,
+                (static_cast<GIntBig>(psField->Date.Hour) * 3600 +
+                 psField->Date.Minute * 60) * 1000000 +
+                static_cast<GIntBig>(nMilliSeconds) * 1000);
+            return true;
+        }
+        case PG_BINARY_COPY_TIMESTAMP:
+        case PG_BINARY_COPY_TIMESTAMPTZ:
+        {
+            GIntBig nSeconds = nUnixTime - PG_EPOCH_UNIX_SECONDS;
+            if( nEncoding == PG_BINARY_COPY_TIMESTAMPTZ )
+            {
+                // Unknown or local time zone: only the server knows how to
+                // interpret the value.
+                if( psField->Date.TZFlag <= 1 )
+                    return false;
+                nSeconds -= (psField->Date.TZFlag - 100) * 15 * 60;
+            }
+            // For timestamp without time zone, as with the text format,
+            // the time zone is ignored.
+            OGRPGAppendInt32(abyBuffer, 8);
+            OGRPGAppendInt64(abyBuffer, nSeconds * 1000000 +
+                             static_cast<GIntBig>(nMilliSeconds) * 1000);
+            return true;
+        }
+        default:
+            break;
+    }
+    return false;
+}
+
+/* Writes a string, truncated to nMaxWidth characters if not 0 */
+static void OGRPGAppendString( std::vector<GByte>& abyBuffer, int nEncoding,
+                               const char* pszStr, int nMaxWidth,
+                               const char* pszFieldName )
+{
+    size_t nLen = strlen(pszStr);
+    if( nMaxWidth > 0 )
+    {
+        int iUTFChar = 0;
+        for( size_t iChar = 0; iChar < nLen; iChar++ )
+        {
+            if( (pszStr[iChar] & 0xc0) != 0x80 )
+            {
+                if( iUTFChar == nMaxWidth )
+                {
+                    CPLDebug( "PG",
+                              "Truncated %s field value, it was too long.",
+                              pszFieldName );
+                    nLen = iChar;
+                    break;
+                }
+                iUTFChar++;
+            }
+        }
+    }
+
+    if( nEncoding == PG_BINARY_COPY_JSONB )
+    {
+        // jsonb version number
+        OGRPGAppendInt32(abyBuffer, static_cast<GInt32>(nLen + 1));
+        abyBuffer.push_back(1);
+        abyBuffer.insert(abyBuffer.end(), pszStr, pszStr + nLen);
+    }
+    else
+    {
+        OGRPGAppendBytes(abyBuffer, pszStr, nLen);
+    }
+}
+
+/* Writes the header of an array of nCount elements */
+static void OGRPGAppendArrayHeader( std::vector<GByte>& abyBuffer,
+                                    int nElemOID, int nCount )
+{
+    OGRPGAppendInt32(abyBuffer, nCount > 0 ? 1 : 0); // number of dimensions
+    OGRPGAppendInt32(abyBuffer, 0); // no NULL element
+    OGRPGAppendInt32(abyBuffer, nElemOID);
+    if( nCount > 0 )
+    {
+        OGRPGAppendInt32(abyBuffer, nCount);
+        OGRPGAppendInt32(abyBuffer, 1); // lower bound
+    }
+}
+
+/* Writes a geometry as (E)WKB, with the same WKB variants as */
+/* OGRGeometryToHexEWKB() and GeometryToBYTEA() */
+static bool OGRPGAppendGeometry( std::vector<GByte>& abyBuffer,
+                                 OGRGeometry* poGeom, int nSRSId, bool bEWKB,
+                                 int nPostGISMajor, int nPostGISMinor )
+{
+    const int nWkbSize = poGeom->WkbSize();
+    const bool bWithSRID = bEWKB && nSRSId > 0;
+    const size_t nStart = abyBuffer.size();
+    abyBuffer.resize(nStart + 4 + nWkbSize + (bWithSRID ? 4 : 0));
+    GByte* pabyWKB = abyBuffer.data() + nStart + 4 + (bWithSRID ? 4 : 0);
+
+    OGRErr eErr;
+    if( (nPostGISMajor > 2 || (nPostGISMajor == 2 && nPostGISMinor >= 2)) &&
+        wkbFlatten(poGeom->getGeometryType()) == wkbPoint &&
+        poGeom->IsEmpty() )
+    {
+        eErr = poGeom->exportToWkb( wkbNDR, pabyWKB, wkbVariantIso );
+    }
+    else
+    {
+        eErr = poGeom->exportToWkb( wkbNDR, pabyWKB,
+            (nPostGISMajor < 2) ? wkbVariantPostGIS1 : wkbVariantOldOgc );
+    }
+    if( eErr != OGRERR_NONE )
+    {
+        abyBuffer.resize(nStart);
+        return false;
+    }
+
+    if( bWithSRID )
+    {
+        // Move the byte order and geometry type before the SRID, and
+        // set the SRID flag, in little endian order.
+        GByte* pabyEWKB = abyBuffer.data() + nStart + 4;
+        GUInt32 nGeomType = 0;
+        memcpy(&nGeomType, pabyWKB + 1, 4);
+        nGeomType = CPL_LSBWORD32(CPL_LSBWORD32(nGeomType) | 0x20000000 /* SRID flag */);
+        const GUInt32 nGSRSId = CPL_LSBWORD32( nSRSId );
+        pabyEWKB[0] = pabyWKB[0];
+        memcpy(pabyEWKB + 1, &nGeomType, 4);
+        memcpy(pabyEWKB + 5, &nGSRSId, 4);
+    }
+
+    const GUInt32 nLenMSB = CPL_MSBWORD32(
+        static_cast<GUInt32>(nWkbSize + (bWithSRID ? 4 : 0)));
+    memcpy(abyBuffer.data() + nStart, &nLenMSB, 4);
+    return true;
+}
+
+/************************************************************************/
+/*                    TranslateFeatureToBinaryCopy()                    */
+/*                                                                      */
+/*      Format a feature as a row of the binary COPY format in         */
+/*      abyBinaryCopyRow. Returns false if a value cannot be written   */
+/*      with the encoding of its column.                               */
+/************************************************************************/
+
+bool OGRPGTableLayer::TranslateFeatureToBinaryCopy( OGRFeature *poFeature )
+
+{
+    std::vector<GByte>& abyRow = abyBinaryCopyRow;
+    abyRow.clear();
+    OGRPGAppendInt16(abyRow,
+                     static_cast<GInt16>(aoBinaryCopyColumns.size()));
+
+    size_t iCol = 0;
+
+    /* First process geometry */
+    for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++, iCol++ )
+    {
+        OGRPGGeomFieldDefn* poGeomFieldDefn =
+            poFeatureDefn->myGetGeomFieldDefn(i);
+        OGRGeometry* poGeom = poFeature->GetGeomFieldRef(i);
+        if( poGeom == nullptr )
+        {
+            OGRPGAppendInt32(abyRow, -1);
+            continue;
+        }
+
+        CheckGeomTypeCompatibility(i, poGeom);
+
+        poGeom->closeRings();
+        poGeom->set3D(poGeomFieldDefn->GeometryTypeFlags & OGRGeometry::OGR_G_3D);
+        poGeom->setMeasured(poGeomFieldDefn->GeometryTypeFlags & OGRGeometry::OGR_G_MEASURED);
+
+        if( !OGRPGAppendGeometry(abyRow, poGeom, poGeomFieldDefn->nSRSId,
+                    aoBinaryCopyColumns[iCol].nEncoding == PG_BINARY_COPY_EWKB,
+                    poDS->sPostGISVersion.nMajor,
+                    poDS->sPostGISVersion.nMinor) )
+        {
+            // Same as the text format
+            OGRPGAppendInt32(abyRow, 0);
+        }
+    }
+
+    /* Next process the field id column */
+    int nFIDIndex = -1;
+    if( bFIDColumnInCopyFields )
+    {
+        nFIDIndex = poFeatureDefn->GetFieldIndex( pszFIDColumn );
+        if( poFeature->GetFID() == OGRNullFID )
+            OGRPGAppendInt32(abyRow, -1);
+        else if( !OGRPGAppendNumber(abyRow,
+                                    aoBinaryCopyColumns[iCol].nEncoding,
+                                    poFeature->GetFID(), 0.0) )
+            return false;
+        iCol++;
+    }
+
+    /* Now process the remaining fields */
+    for( int i = 0; i < poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( i == nFIDIndex )
+            continue;
+
+        const OGRPGBinaryCopyColumn& sColumn = aoBinaryCopyColumns[iCol];
+        iCol++;
+
+        if( !poFeature->IsFieldSetAndNotNull( i ) )
+        {
+            OGRPGAppendInt32(abyRow, -1);
+            continue;
+        }
+
+        OGRFieldDefn* poFieldDefn = poFeatureDefn->GetFieldDefn(i);
+        switch( poFieldDefn->GetType() )
+        {
+            case OFTInteger:
+            case OFTInteger64:
+            {
+                const GIntBig nVal = poFeature->GetFieldAsInteger64(i);
+                if( !OGRPGAppendNumber(abyRow, sColumn.nEncoding, nVal,
+                                       static_cast<double>(nVal)) )
+                    return false;
+                break;
+            }
+
+            case OFTReal:
+            {
+                if( !OGRPGAppendNumber(abyRow, sColumn.nEncoding, 0,
+                                       poFeature->GetFieldAsDouble(i)) )
+                    return false;
+                break;
+            }
+
+            case OFTString:
+            {
+                OGRPGAppendString(abyRow, sColumn.nEncoding,
+                                  poFeature->GetFieldAsString(i),
+                                  poFieldDefn->GetWidth(),
+                                  poFieldDefn->GetNameRef());
+                break;
+            }
+
+            case OFTBinary:
+            {
+                int nLen = 0;
+                const GByte* pabyData = poFeature->GetFieldAsBinary(i, &nLen);
+                OGRPGAppendBytes(abyRow, pabyData, nLen);
+                break;
+            }
+
+            case OFTDate:
+            case OFTTime:
+            case OFTDateTime:
+            {
+                if( !OGRPGAppendDateTime(abyRow, sColumn.nEncoding,
+                                         poFeature->GetRawFieldRef(i)) )
+                    return false;
+                break;
+            }
+
+            case OFTIntegerList:
+            case OFTInteger64List:
+            case OFTRealList:
+            case OFTStringList:
+            {
+                const OGRFieldType eType = poFieldDefn->GetType();
+                // Length of the array, written once it is known.
+                const size_t nLenOffset = abyRow.size();
+                OGRPGAppendInt32(abyRow, 0);
+                if( eType == OFTStringList )
+                {
+                    char** papszItems = poFeature->GetFieldAsStringList(i);
+                    const int nCount = CSLCount(papszItems);
+                    OGRPGAppendArrayHeader(abyRow, sColumn.nElemOID, nCount);
+                    for( int j = 0; j < nCount; j++ )
+                    {
+                        OGRPGAppendString(abyRow, sColumn.nElemEncoding,
+                                          papszItems[j], 0, nullptr);
+                    }
+                }
+                else
+                {
+                    int nCount = 0;
+                    const int* panItems = nullptr;
+                    const GIntBig* panItems64 = nullptr;
+                    const double* padfItems = nullptr;
+                    if( eType == OFTIntegerList )
+                        panItems = poFeature->GetFieldAsIntegerList(i, &nCount);
+                    else if( eType == OFTInteger64List )
+                        panItems64 = poFeature->GetFieldAsInteger64List(i, &nCount);
+                    else
+                        padfItems = poFeature->GetFieldAsDoubleList(i, &nCount);
+                    OGRPGAppendArrayHeader(abyRow, sColumn.nElemOID, nCount);
+                    for( int j = 0; j < nCount; j++ )
+                    {
+                        const GIntBig nVal = panItems ? panItems[j] :
+                                             panItems64 ? panItems64[j] : 0;
+                        const double dfVal = padfItems ? padfItems[j] :
+                                             static_cast<double>(nVal);
+                        if( !OGRPGAppendNumber(abyRow, sColumn.nElemEncoding,
+                                               nVal, dfVal) )
+                            return false;
+                    }
+                }
+                const GUInt32 nLenMSB = CPL_MSBWORD32(static_cast<GUInt32>(
+                                        abyRow.size() - nLenOffset - 4));
+                memcpy(abyRow.data() + nLenOffset, &nLenMSB, 4);
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                       FlushBinaryCopyBuffer()                        */
+/************************************************************************/
+
+OGRErr OGRPGTableLayer::FlushBinaryCopyBuffer()
+
+{
+    if( !abyBinaryCopyBuffer.empty() )
+        poBinaryCopySender->Submit(abyBinaryCopyBuffer);
+
+    const CPLString osError = poBinaryCopySender->GetError();
+    if( !osError.empty() )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "%s", osError.c_str() );
+        return OGRERR_FAILURE;
+    }
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                     CreateFeatureViaBinaryCopy()                     */
+/************************************************************************/
+
+OGRErr OGRPGTableLayer::CreateFeatureViaBinaryCopy( OGRFeature *poFeature,
+                                                    bool& bFallback )
+{
+    bFallback = false;
+    if( !TranslateFeatureToBinaryCopy(poFeature) )
+    {
+        bFallback = true;
+        return OGRERR_NONE;
+    }
+
+    abyBinaryCopyBuffer.insert(abyBinaryCopyBuffer.end(),
+                               abyBinaryCopyRow.begin(),
+                               abyBinaryCopyRow.end());
+
+    // Send by chunks of about 1 MB
+    if( abyBinaryCopyBuffer.size() >= 1024 * 1024 )
+        return FlushBinaryCopyBuffer();
+    return OGRERR_NONE;
+}
+
 /************************************************************************/
 /*                        CreateFeatureViaCopy()                        */
 /************************************************************************/
@@ -1919,6 +2742,26 @@ OGRErr OGRPGTableLayer::CreateFeatureViaCopy( OGRFeature *poFeature )
     /* Tell the datasource we are now planning to copy data */
     poDS->StartCopy( this );
 
+    if( bBinaryCopyActive )
+    {
+        bool bFallback = false;
+        OGRErr eErr = CreateFeatureViaBinaryCopy( poFeature, bFallback );
+        if( !bFallback )
+            return eErr;
+
+        /* Restart the COPY in the text format, which can represent */
+        /* any value. */
+        CPLDebug("PG", "Binary COPY not possible for feature " CPL_FRMT_GIB
+                 ". Reverting to text COPY", poFeature->GetFID());
+        bBinaryCopyDisabled = true;
+        const bool bNeedToUpdateSequenceBackup = bNeedToUpdateSequence;
+        eErr = poDS->EndCopy();
+        if( eErr != OGRERR_NONE )
+            return eErr;
+        poDS->StartCopy( this );
+        bNeedToUpdateSequence = bNeedToUpdateSequenceBackup;
+    }
+
     /* First process geometry */
     for( int i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
     {
@@ -2873,12 +3716,18 @@ OGRErr OGRPGTableLayer::StartCopy()
 
     CPLString osFields = BuildCopyFields();
 
+    const bool bBinary =
+        !bBinaryCopyDisabled &&
+        EQUAL(CPLGetConfigOption("PG_USE_COPY", ""), "BINARY") &&
+        PrepareBinaryCopy();
+
     size_t size = osFields.size() +  strlen(pszSqlTableName) + 100;
     char *pszCommand = (char *) CPLMalloc(size);
 
     snprintf( pszCommand, size,
-             "COPY %s (%s) FROM STDIN;",
-             pszSqlTableName, osFields.c_str() );
+             "COPY %s (%s) FROM STDIN%s;",
+             pszSqlTableName, osFields.c_str(),
+             bBinary ? " WITH BINARY" : "" );
 
     PGconn *hPGConn = poDS->GetPGConn();
     PGresult *hResult = OGRPG_PQexec(hPGConn, pszCommand);
@@ -2889,7 +3738,20 @@ OGRErr OGRPGTableLayer::StartCopy()
                   "%s", PQerrorMessage(hPGConn) );
     }
     else
+    {
         bCopyActive = TRUE;
+        if( bBinary )
+        {
+            /* Signature, flags and header extension length */
+            static const GByte abySignature[] =
+                { 'P', 'G', 'C', 'O', 'P', 'Y', '\n', 0xFF, '\r', '\n', '\0',
+                  0, 0, 0, 0, 0, 0, 0, 0 };
+            bBinaryCopyActive = true;
+            abyBinaryCopyBuffer.assign(abySignature,
+                                       abySignature + sizeof(abySignature));
+            poBinaryCopySender = new OGRPGBinaryCopySender(hPGConn);
+        }
+    }
 
     OGRPGClearResult( hResult );
     CPLFree( pszCommand );
@@ -2917,7 +3779,36 @@ OGRErr OGRPGTableLayer::EndCopy()
 
     bCopyActive = FALSE;
 
-    int copyResult = PQputCopyEnd(hPGConn, nullptr);
+    const char* pszCopyError = nullptr;
+    CPLString osCopyError;
+    if( bBinaryCopyActive )
+    {
+        bBinaryCopyActive = false;
+
+        /* File trailer */
+        OGRPGAppendInt16(abyBinaryCopyBuffer, -1);
+        result = FlushBinaryCopyBuffer();
+        poBinaryCopySender->WaitCompletion();
+        osCopyError = poBinaryCopySender->GetError();
+        if( result == OGRERR_NONE && !osCopyError.empty() )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined, "%s", osCopyError.c_str() );
+            result = OGRERR_FAILURE;
+        }
+        delete poBinaryCopySender;
+        poBinaryCopySender = nullptr;
+        abyBinaryCopyBuffer.clear();
+
+        /* Abort the COPY rather than committing a truncated stream */
+        if( result != OGRERR_NONE )
+        {
+            if( osCopyError.empty() )
+                osCopyError = "binary COPY data not sent";
+            pszCopyError = osCopyError.c_str();
+        }
+    }
+
+    int copyResult = PQputCopyEnd(hPGConn, pszCopyError);
 
     switch (copyResult)
     {
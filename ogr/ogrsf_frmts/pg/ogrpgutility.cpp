@@ -28,6 +28,10 @@
 
 #include "ogr_pg.h"
 #include "cpl_conv.h"
+#include "cpl_multiproc.h"
+
+#include <map>
+#include <utility>
 
 CPL_CVSID("$Id: ogrpgutility.cpp 7e07230bbff24eb333608de4dbd460b7312839d0 2017-12-11 19:08:47Z Even Rouault $")
 
@@ -38,6 +42,8 @@ CPL_CVSID("$Id: ogrpgutility.cpp 7e07230bbff24eb333608de4dbd460b7312839d0 2017-1
 PGresult *OGRPG_PQexec(PGconn *conn, const char *query, int bMultipleCommandAllowed,
                        int bErrorAsDebug)
 {
+    OGRPGCompletePendingQuery(conn);
+
     PGresult* hResult = bMultipleCommandAllowed
         ? PQexec(conn, query)
         : PQexecParams(conn, query, 0, nullptr, nullptr, nullptr, nullptr, 0);
@@ -86,6 +92,61 @@ PGresult *OGRPG_PQexec(PGconn *conn, const char *query, int bMultipleCommandAllo
     return hResult;
 }
 
+/************************************************************************/
+/*                        Pending queries                               */
+/************************************************************************/
+
+static CPLMutex* hPendingQueryMutex = nullptr;
+static std::map<PGconn*, std::pair<OGRPGPendingQueryCompleteFunc, void*>>
+                                                        oMapPendingQueries;
+
+/************************************************************************/
+/*                        OGRPGSetPendingQuery()                        */
+/************************************************************************/
+
+void OGRPGSetPendingQuery( PGconn *conn,
+                           OGRPGPendingQueryCompleteFunc pfnComplete,
+                           void* pUserData )
+{
+    CPLMutexHolderD(&hPendingQueryMutex);
+    oMapPendingQueries[conn] = std::make_pair(pfnComplete, pUserData);
+}
+
+/************************************************************************/
+/*                       OGRPGUnsetPendingQuery()                       */
+/************************************************************************/
+
+void OGRPGUnsetPendingQuery( PGconn *conn, void* pUserData )
+{
+    CPLMutexHolderD(&hPendingQueryMutex);
+    auto oIter = oMapPendingQueries.find(conn);
+    if( oIter != oMapPendingQueries.end() &&
+        oIter->second.second == pUserData )
+    {
+        oMapPendingQueries.erase(oIter);
+    }
+}
+
+/************************************************************************/
+/*                     OGRPGCompletePendingQuery()                      */
+/************************************************************************/
+
+void OGRPGCompletePendingQuery( PGconn *conn )
+{
+    std::pair<OGRPGPendingQueryCompleteFunc, void*> oPending(nullptr, nullptr);
+    {
+        CPLMutexHolderD(&hPendingQueryMutex);
+        if( oMapPendingQueries.empty() )
+            return;
+        auto oIter = oMapPendingQueries.find(conn);
+        if( oIter == oMapPendingQueries.end() )
+            return;
+        oPending = oIter->second;
+        oMapPendingQueries.erase(oIter);
+    }
+    oPending.first(oPending.second);
+}
+
 /************************************************************************/
 /*                       OGRPG_Check_Table_Exists()                     */
 /************************************************************************/
@@ -36,6 +36,18 @@ PGresult *OGRPG_PQexec(PGconn *conn, const char *query,
                        int bMultipleCommandAllowed = FALSE,
                        int bErrorAsDebug = FALSE);
 
+/* A query sent with PQsendQuery() whose result has not been read yet */
+/* must be completed before any other command is run on the connection. */
+/* OGRPG_PQexec() calls the callback registered for the connection */
+/* before running its own command. */
+typedef void (*OGRPGPendingQueryCompleteFunc)( void* pUserData );
+
+void OGRPGSetPendingQuery( PGconn *conn,
+                           OGRPGPendingQueryCompleteFunc pfnComplete,
+                           void* pUserData );
+void OGRPGUnsetPendingQuery( PGconn *conn, void* pUserData );
+void OGRPGCompletePendingQuery( PGconn *conn );
+
 /************************************************************************/
 /*                            OGRPGClearResult                          */
 /*                                                                      */
@@ -212,6 +212,11 @@ int OGRS57DataSource::Open( const char * pszFilename )
             CSLSetNameValue( papszReaderOptions, S57O_RECODE_BY_DSSI,
                              GetOption(S57O_RECODE_BY_DSSI) );
 
+    if( GetOption(S57O_NUM_THREADS) != nullptr )
+        papszReaderOptions =
+            CSLSetNameValue( papszReaderOptions, S57O_NUM_THREADS,
+                             GetOption(S57O_NUM_THREADS) );
+
     S57Reader *poModule = new S57Reader( pszFilename );
     bool bRet = poModule->SetOptions( papszReaderOptions );
     CSLDestroy( papszReaderOptions );
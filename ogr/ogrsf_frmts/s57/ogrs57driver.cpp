@@ -188,6 +188,7 @@ void RegisterOGRS57()
         "  <Option name='" S57O_LNAM_REFS "' type='boolean' description='Should LNAM and LNAM_REFS fields be attached to features capturing the feature to feature relationships in the FFPT group of the S-57 file' default='YES'/>"
         "  <Option name='" S57O_RETURN_LINKAGES "' type='boolean' description='Should additional attributes relating features to their underlying geometric primitives be attached' default='NO'/>"
         "  <Option name='" S57O_RECODE_BY_DSSI "' type='boolean' description='Should attribute values be recoded to UTF-8 from the character encoding specified in the S57 DSSI record.' default='NO'/>"
+        "  <Option name='" S57O_NUM_THREADS "' type='string' description='Number of threads assembling the line and area geometries. Integer or ALL_CPUS' default='1'/>"
         "</OpenOptionList>");
     poDriver->SetMetadataItem(
         GDAL_DMD_CREATIONOPTIONLIST,
@@ -33,6 +33,7 @@
 #ifndef S57_H_INCLUDED
 #define S57_H_INCLUDED
 
+#include <map>
 #include <vector>
 #include "ogr_feature.h"
 #include "iso8211.h"
@@ -55,6 +56,7 @@ char **S57FileCollector( const char * pszDataset );
 #define S57O_RETURN_LINKAGES "RETURN_LINKAGES"
 #define S57O_RETURN_DSID     "RETURN_DSID"
 #define S57O_RECODE_BY_DSSI  "RECODE_BY_DSSI"
+#define S57O_NUM_THREADS     "NUM_THREADS"
 
 #define S57M_UPDATES                    0x01
 #define S57M_LNAM_REFS                  0x02
@@ -241,6 +243,9 @@ public:
 /*                              S57Reader                               */
 /************************************************************************/
 
+class CPLJobQueue;
+struct S57GeometryJob;
+
 class CPL_DLL S57Reader
 {
     S57ClassRegistrar  *poRegistrar;
@@ -289,10 +294,60 @@ class CPL_DLL S57Reader
     int                 Nall;               // see RecodeByDSSI() function
     bool                needAallNallSetup;  // see RecodeByDSSI() function
 
+    // Vector primitives decoded once the module is ingested and updated,
+    // so that geometries can be assembled without the DDF records.
+    struct S57DecodedNode
+    {
+        int             nRCID;
+        double          dfX;
+        double          dfY;
+        double          dfZ;
+    };
+
+    struct S57DecodedEdge
+    {
+        int             nRCID;
+        int             nVRPTCount;     // number of node pointers found
+        int             nStartNode;
+        int             nEndNode;
+        bool            bSimple;        // at most one SG2D and no AR2D field
+        size_t          nFirstVertex;
+        int             nVertexCount;
+    };
+
+    bool                bPrimitivesDecoded;
+    std::vector<S57DecodedNode> asVINodes;
+    std::vector<S57DecodedNode> asVCNodes;
+    std::vector<S57DecodedEdge> asEdges;
+    std::vector<double> adfEdgeX;
+    std::vector<double> adfEdgeY;
+
+    int                 nNumThreads;
+    CPLJobQueue        *poJobQueue;  // in the global worker thread pool
+    // Features assembled ahead by ReadNextFeature(), by feature index.
+    std::map<int, OGRFeature *> oMapPreparedFeatures;
+
+    void                DecodePrimitives();
+    void                ClearDecodedPrimitives();
+    void                ClearPreparedFeatures();
+    const S57DecodedNode *FindDecodedNode( int nRCNM, int nRCID ) const;
+    const S57DecodedEdge *FindDecodedEdge( int nRCID ) const;
+    bool                DecodePoint( DDFRecord *, double *, double *,
+                                     double * );
+
+    bool                PrepareGeometryJob( DDFRecord *, OGRFeature *,
+                                            S57GeometryJob * );
+    void                AssembleJobLineGeometry( S57GeometryJob * ) const;
+    void                AssembleJobAreaGeometry( S57GeometryJob * ) const;
+    void                FinishGeometryJob( S57GeometryJob * );
+    static void         GeometryJobFunc( void * );
+    void                PrefetchFeatures( OGRFeatureDefn * );
+
     void                ClearPendingMultiPoint();
     OGRFeature         *NextPendingMultiPoint();
 
-    OGRFeature         *AssembleFeature( DDFRecord  *, OGRFeatureDefn * );
+    OGRFeature         *AssembleFeature( DDFRecord  *, OGRFeatureDefn *,
+                                         S57GeometryJob * = nullptr );
 
     void                ApplyObjectClassAttributes( DDFRecord *, OGRFeature *);
     // cppcheck-suppress functionStatic
@@ -318,6 +373,8 @@ class CPL_DLL S57Reader
     bool                bMissingWarningIssued;
     bool                bAttrWarningIssued;
 
+    CPL_DISALLOW_COPY_ASSIGN(S57Reader)
+
   public:
     explicit            S57Reader( const char * );
                        ~S57Reader();
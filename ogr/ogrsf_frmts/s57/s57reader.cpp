@@ -29,6 +29,7 @@
 
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "s57.h"
 
@@ -39,6 +40,32 @@
 
 CPL_CVSID("$Id: s57reader.cpp 9dedf5b8948aeaec5518e1f4210f98a378c3d975 2019-03-17 13:17:53 +0100 Even Rouault $")
 
+/************************************************************************/
+/*                            S57GeometryJob                            */
+/*                                                                      */
+/*      Line or area geometry of a feature, assembled from the decoded  */
+/*      primitives only so that several of them can be built at once.   */
+/*      Warnings are collected and issued by the reading thread.        */
+/************************************************************************/
+
+struct S57GeometryJob
+{
+    struct Edge
+    {
+        int         nRCID;
+        bool        bReverse;
+        bool        bFirstOfField;
+    };
+
+    const S57Reader *poReader = nullptr;
+    OGRFeature     *poFeature = nullptr;
+    int             nPRIM = 0;
+    int             nFeatureRCID = 0;
+    std::vector<Edge> asEdges{};
+    OGRGeometry    *poGeometry = nullptr;
+    std::vector<CPLString> aosWarnings{};
+};
+
 /**
 * Recode the given string from a source encoding to UTF-8 encoding.  The source
 * encoding is established by inspecting the AALL and NALL fields of the S57
@@ -174,6 +201,9 @@ S57Reader::S57Reader( const char * pszFilename ) :
     Aall(0),  // See RecodeByDSSI() function.
     Nall(0),  // See RecodeByDSSI() function.
     needAallNallSetup(true),  // See RecodeByDSSI() function.
+    bPrimitivesDecoded(false),
+    nNumThreads(1),
+    poJobQueue(nullptr),
     bMissingWarningIssued(false),
     bAttrWarningIssued(false)
 {
@@ -189,6 +219,8 @@ S57Reader::~S57Reader()
 {
     Close();
 
+    delete poJobQueue;
+
     CPLFree( pszModuleName );
     CSLDestroy( papszOptions );
 
@@ -276,6 +308,8 @@ void S57Reader::Close()
         }
 
         ClearPendingMultiPoint();
+        ClearPreparedFeatures();
+        ClearDecodedPrimitives();
 
         delete poModule;
         poModule = nullptr;
@@ -413,6 +447,12 @@ bool S57Reader::SetOptions( char ** papszOptionsIn )
     else
         nOptionFlags &= ~S57M_RECODE_BY_DSSI;
 
+    // S57O_NUM_THREADS is the NUM_THREADS option.
+    nNumThreads = CPLGetNumThreads(papszOptions);
+
+    // Features assembled ahead may depend on the previous options.
+    ClearPreparedFeatures();
+
     return true;
 }
 
@@ -747,7 +787,33 @@ OGRFeature * S57Reader::ReadNextFeature( OGRFeatureDefn * poTarget )
             continue;
         }
 
-        OGRFeature *poFeature = ReadFeature( nNextFEIndex++, poTarget );
+/* -------------------------------------------------------------------- */
+/*      With several threads, features are assembled by batches whose   */
+/*      line and area geometries are built in parallel.                 */
+/* -------------------------------------------------------------------- */
+        auto oIter = oMapPreparedFeatures.end();
+        if( nNumThreads > 1 )
+        {
+            oIter = oMapPreparedFeatures.find( nNextFEIndex );
+            if( oIter == oMapPreparedFeatures.end() )
+            {
+                PrefetchFeatures( poTarget );
+                oIter = oMapPreparedFeatures.find( nNextFEIndex );
+            }
+        }
+
+        OGRFeature *poFeature = nullptr;
+        if( oIter != oMapPreparedFeatures.end() )
+        {
+            poFeature = oIter->second;
+            oMapPreparedFeatures.erase( oIter );
+            nNextFEIndex++;
+        }
+        else
+        {
+            poFeature = ReadFeature( nNextFEIndex++, poTarget );
+        }
+
         if( poFeature != nullptr )
         {
             if( (nOptionFlags & S57M_SPLIT_MULTIPOINT)
@@ -805,9 +871,13 @@ OGRFeature *S57Reader::ReadFeature( int nFeatureId, OGRFeatureDefn *poTarget )
 /************************************************************************/
 
 OGRFeature *S57Reader::AssembleFeature( DDFRecord * poRecord,
-                                        OGRFeatureDefn * poTarget )
+                                        OGRFeatureDefn * poTarget,
+                                        S57GeometryJob * psJob )
 
 {
+    if( !bPrimitivesDecoded )
+        DecodePrimitives();
+
 /* -------------------------------------------------------------------- */
 /*      Find the feature definition to use.  Currently this is based    */
 /*      on the primitive, but eventually this should be based on the    */
@@ -883,13 +953,32 @@ OGRFeature *S57Reader::AssembleFeature( DDFRecord * poRecord,
         else
             AssemblePointGeometry( poRecord, poFeature );
     }
-    else if( nPRIM == PRIM_L )
-    {
-        AssembleLineGeometry( poRecord, poFeature );
-    }
-    else if( nPRIM == PRIM_A )
+    else if( nPRIM == PRIM_L || nPRIM == PRIM_A )
     {
-        AssembleAreaGeometry( poRecord, poFeature );
+/* -------------------------------------------------------------------- */
+/*      Lines and areas are built from the decoded primitives when      */
+/*      possible.  If a job is passed, running it is left to the        */
+/*      caller.                                                         */
+/* -------------------------------------------------------------------- */
+        S57GeometryJob sJob;
+        S57GeometryJob *psTargetJob = psJob != nullptr ? psJob : &sJob;
+
+        if( PrepareGeometryJob( poRecord, poFeature, psTargetJob ) )
+        {
+            if( psJob == nullptr )
+            {
+                GeometryJobFunc( &sJob );
+                FinishGeometryJob( &sJob );
+            }
+        }
+        else if( nPRIM == PRIM_L )
+        {
+            AssembleLineGeometry( poRecord, poFeature );
+        }
+        else
+        {
+            AssembleAreaGeometry( poRecord, poFeature );
+        }
     }
 
     return poFeature;
@@ -1568,6 +1657,22 @@ bool S57Reader::FetchPoint( int nRCNM, int nRCID,
                             double *pdfX, double *pdfY, double *pdfZ )
 
 {
+    if( bPrimitivesDecoded )
+    {
+        const S57DecodedNode *psNode = FindDecodedNode( nRCNM, nRCID );
+        if( psNode == nullptr )
+            return false;
+
+        if( pdfX != nullptr )
+            *pdfX = psNode->dfX;
+        if( pdfY != nullptr )
+            *pdfY = psNode->dfY;
+        if( pdfZ != nullptr )
+            *pdfZ = psNode->dfZ;
+
+        return true;
+    }
+
     DDFRecord *poSRecord = nullptr;
 
     if( nRCNM == RCNM_VI )
@@ -1578,6 +1683,19 @@ bool S57Reader::FetchPoint( int nRCNM, int nRCID,
     if( poSRecord == nullptr )
         return false;
 
+    return DecodePoint( poSRecord, pdfX, pdfY, pdfZ );
+}
+
+/************************************************************************/
+/*                            DecodePoint()                             */
+/*                                                                      */
+/*      Fetch the location of a spatial point record.                   */
+/************************************************************************/
+
+bool S57Reader::DecodePoint( DDFRecord *poSRecord,
+                             double *pdfX, double *pdfY, double *pdfZ )
+
+{
     double dfX = 0.0;
     double dfY = 0.0;
     double dfZ = 0.0;
@@ -2466,6 +2584,572 @@ void S57Reader::AssembleAreaGeometry( DDFRecord * poFRecord,
         poFeature->SetGeometryDirectly( poPolygon );
 }
 
+/************************************************************************/
+/*                          DecodePrimitives()                          */
+/*                                                                      */
+/*      Decode the coordinates of all the nodes and edges into compact  */
+/*      arrays, once the module is ingested and its updates applied.    */
+/*      Edges with arcs or several coordinate fields are left to the    */
+/*      DDF record based code.                                          */
+/************************************************************************/
+
+void S57Reader::DecodePrimitives()
+
+{
+    ClearDecodedPrimitives();
+
+    for( int iPass = 0; iPass < 2; iPass++ )
+    {
+        DDFRecordIndex &oIndex = iPass == 0 ? oVI_Index : oVC_Index;
+        std::vector<S57DecodedNode> &asNodes =
+            iPass == 0 ? asVINodes : asVCNodes;
+
+        asNodes.reserve( oIndex.GetCount() );
+        for( int i = 0; i < oIndex.GetCount(); i++ )
+        {
+            DDFRecord *poSRecord = oIndex.GetByIndex( i );
+            S57DecodedNode sNode;
+            sNode.nRCID = poSRecord->GetIntSubfield( "VRID", 0, "RCID", 0 );
+            if( DecodePoint( poSRecord, &sNode.dfX, &sNode.dfY,
+                             &sNode.dfZ ) )
+                asNodes.push_back( sNode );
+        }
+
+        std::stable_sort( asNodes.begin(), asNodes.end(),
+            [](const S57DecodedNode& a, const S57DecodedNode& b)
+            { return a.nRCID < b.nRCID; } );
+    }
+
+    asEdges.reserve( oVE_Index.GetCount() );
+    for( int i = 0; i < oVE_Index.GetCount(); i++ )
+    {
+        DDFRecord *poSRecord = oVE_Index.GetByIndex( i );
+
+        S57DecodedEdge sEdge;
+        sEdge.nRCID = poSRecord->GetIntSubfield( "VRID", 0, "RCID", 0 );
+        sEdge.nVRPTCount = 0;
+        sEdge.nStartNode = -1;
+        sEdge.nEndNode = -1;
+        sEdge.bSimple = true;
+        sEdge.nFirstVertex = adfEdgeX.size();
+        sEdge.nVertexCount = 0;
+
+/* -------------------------------------------------------------------- */
+/*      The nodes are either two rows of one VRPT field, or single      */
+/*      rows of two VRPT fields.                                        */
+/* -------------------------------------------------------------------- */
+        DDFField *poVRPT = poSRecord->FindField( "VRPT" );
+        if( poVRPT != nullptr && poVRPT->GetRepeatCount() == 1 )
+        {
+            sEdge.nStartNode = ParseName( poVRPT );
+            sEdge.nVRPTCount = 1;
+
+            poVRPT = poSRecord->FindField( "VRPT", 1 );
+            if( poVRPT != nullptr )
+            {
+                sEdge.nEndNode = ParseName( poVRPT );
+                sEdge.nVRPTCount = 2;
+            }
+        }
+        else if( poVRPT != nullptr )
+        {
+            sEdge.nStartNode = ParseName( poVRPT );
+            sEdge.nEndNode = ParseName( poVRPT, 1 );
+            sEdge.nVRPTCount = 2;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Collect the vertices.                                           */
+/* -------------------------------------------------------------------- */
+        int nCoordFields = 0;
+        for( int iField = 0; iField < poSRecord->GetFieldCount(); ++iField )
+        {
+            const char *pszName =
+                poSRecord->GetField( iField )->GetFieldDefn()->GetName();
+            if( EQUAL(pszName, "SG2D") )
+                nCoordFields++;
+            else if( EQUAL(pszName, "AR2D") )
+                sEdge.bSimple = false;
+        }
+        if( nCoordFields > 1 )
+            sEdge.bSimple = false;
+
+        if( sEdge.bSimple && nCoordFields == 1 )
+        {
+            OGRLineString oLine;
+            if( FetchLine( poSRecord, 0, 1, &oLine ) )
+            {
+                sEdge.nVertexCount = oLine.getNumPoints();
+                for( int iVertex = 0; iVertex < sEdge.nVertexCount; iVertex++ )
+                {
+                    adfEdgeX.push_back( oLine.getX(iVertex) );
+                    adfEdgeY.push_back( oLine.getY(iVertex) );
+                }
+            }
+            else
+            {
+                sEdge.bSimple = false;
+            }
+        }
+
+        asEdges.push_back( sEdge );
+    }
+
+    std::stable_sort( asEdges.begin(), asEdges.end(),
+        [](const S57DecodedEdge& a, const S57DecodedEdge& b)
+        { return a.nRCID < b.nRCID; } );
+
+    bPrimitivesDecoded = true;
+}
+
+/************************************************************************/
+/*                       ClearDecodedPrimitives()                       */
+/************************************************************************/
+
+void S57Reader::ClearDecodedPrimitives()
+
+{
+    bPrimitivesDecoded = false;
+    asVINodes.clear();
+    asVCNodes.clear();
+    asEdges.clear();
+    adfEdgeX.clear();
+    adfEdgeY.clear();
+}
+
+/************************************************************************/
+/*                          FindDecodedNode()                           */
+/************************************************************************/
+
+const S57Reader::S57DecodedNode *
+S57Reader::FindDecodedNode( int nRCNM, int nRCID ) const
+
+{
+    const std::vector<S57DecodedNode> &asNodes =
+        nRCNM == RCNM_VI ? asVINodes : asVCNodes;
+
+    auto oIter = std::lower_bound( asNodes.begin(), asNodes.end(), nRCID,
+        [](const S57DecodedNode& sNode, int nKey)
+        { return sNode.nRCID < nKey; } );
+    if( oIter == asNodes.end() || oIter->nRCID != nRCID )
+        return nullptr;
+
+    return &(*oIter);
+}
+
+/************************************************************************/
+/*                          FindDecodedEdge()                           */
+/************************************************************************/
+
+const S57Reader::S57DecodedEdge *S57Reader::FindDecodedEdge( int nRCID ) const
+
+{
+    auto oIter = std::lower_bound( asEdges.begin(), asEdges.end(), nRCID,
+        [](const S57DecodedEdge& sEdge, int nKey)
+        { return sEdge.nRCID < nKey; } );
+    if( oIter == asEdges.end() || oIter->nRCID != nRCID )
+        return nullptr;
+
+    return &(*oIter);
+}
+
+/************************************************************************/
+/*                         PrepareGeometryJob()                         */
+/*                                                                      */
+/*      Collect the edges referenced by the FSPT fields of a line or    */
+/*      area feature record.  Returns false if one of them cannot be    */
+/*      handled from the decoded primitives.                            */
+/************************************************************************/
+
+bool S57Reader::PrepareGeometryJob( DDFRecord *poFRecord,
+                                    OGRFeature *poFeature,
+                                    S57GeometryJob *psJob )
+
+{
+    psJob->poFeature = nullptr;
+    psJob->poGeometry = nullptr;
+    psJob->asEdges.clear();
+    psJob->aosWarnings.clear();
+
+    if( !bPrimitivesDecoded )
+        return false;
+
+    psJob->poReader = this;
+    psJob->nPRIM = poFRecord->GetIntSubfield( "FRID", 0, "PRIM", 0 );
+    psJob->nFeatureRCID = poFRecord->GetIntSubfield( "FRID", 0, "RCID", 0 );
+
+    const int nFieldCount = poFRecord->GetFieldCount();
+    for( int iField = 0; iField < nFieldCount; ++iField )
+    {
+        DDFField *poFSPT = poFRecord->GetField( iField );
+
+        if( !EQUAL(poFSPT->GetFieldDefn()->GetName(), "FSPT") )
+            continue;
+
+        const int nEdgeCount = poFSPT->GetRepeatCount();
+        for( int iEdge = 0; iEdge < nEdgeCount; ++iEdge )
+        {
+            S57GeometryJob::Edge sEdge;
+            sEdge.nRCID = ParseName( poFSPT, iEdge );
+            sEdge.bReverse = psJob->nPRIM == PRIM_L &&
+                GetIntSubfield( poFSPT, "ORNT", iEdge ) == 2;
+            sEdge.bFirstOfField = iEdge == 0;
+
+            const S57DecodedEdge *psEdge = FindDecodedEdge( sEdge.nRCID );
+            if( psEdge != nullptr && !psEdge->bSimple )
+                return false;
+
+            psJob->asEdges.push_back( sEdge );
+        }
+    }
+
+    psJob->poFeature = poFeature;
+    return true;
+}
+
+/************************************************************************/
+/*                      AssembleJobLineGeometry()                       */
+/*                                                                      */
+/*      Same logic as AssembleLineGeometry(), on the decoded edges.     */
+/************************************************************************/
+
+void S57Reader::AssembleJobLineGeometry( S57GeometryJob *psJob ) const
+
+{
+    const char *pszName = psJob->poFeature->GetDefnRef()->GetName();
+    OGRLineString *poLine = new OGRLineString();
+    OGRMultiLineString *poMLS = new OGRMultiLineString();
+
+    double dlastfX = 0.0;
+    double dlastfY = 0.0;
+
+    for( const auto& sJobEdge: psJob->asEdges )
+    {
+        if( sJobEdge.bFirstOfField )
+        {
+            dlastfX = 0.0;
+            dlastfY = 0.0;
+        }
+
+        const S57DecodedEdge *psEdge = FindDecodedEdge( sJobEdge.nRCID );
+        if( psEdge == nullptr )
+        {
+            psJob->aosWarnings.push_back( CPLString().Printf(
+                "Couldn't find spatial record %d.\n"
+                "Feature OBJL=%s, RCID=%d may have corrupt or "
+                "missing geometry.",
+                sJobEdge.nRCID, pszName, psJob->nFeatureRCID ) );
+            continue;
+        }
+
+        if( psEdge->nVRPTCount < 2 )
+        {
+            psJob->aosWarnings.push_back( CPLString().Printf(
+                "Unable to fetch %s node for RCID %d.\n"
+                "Feature OBJL=%s, RCID=%d may have corrupt or "
+                "missing geometry.",
+                psEdge->nVRPTCount == 0 ? "start" : "end",
+                sJobEdge.nRCID, pszName, psJob->nFeatureRCID ) );
+            continue;
+        }
+
+        const bool bReverse = sJobEdge.bReverse;
+        const int nFirstNode =
+            bReverse ? psEdge->nEndNode : psEdge->nStartNode;
+        const int nLastNode =
+            bReverse ? psEdge->nStartNode : psEdge->nEndNode;
+
+        const S57DecodedNode *psNode = nFirstNode == -1 ? nullptr :
+            FindDecodedNode( RCNM_VC, nFirstNode );
+        if( psNode == nullptr )
+        {
+            psJob->aosWarnings.push_back( CPLString().Printf(
+                "Unable to fetch start node RCID=%d.\n"
+                "Feature OBJL=%s, RCID=%d may have corrupt or "
+                "missing geometry.",
+                nFirstNode, pszName, psJob->nFeatureRCID ) );
+            continue;
+        }
+
+        double dfX = psNode->dfX;
+        double dfY = psNode->dfY;
+
+/* -------------------------------------------------------------------- */
+/*      Start a new line string if this edge is not connected to the    */
+/*      previous one.                                                   */
+/* -------------------------------------------------------------------- */
+        if( poLine->getNumPoints() == 0 )
+        {
+            poLine->addPoint( dfX, dfY );
+        }
+        else if( std::abs(dlastfX - dfX) > 0.00000001 ||
+                 std::abs(dlastfY - dfY) > 0.00000001 )
+        {
+            poMLS->addGeometryDirectly( poLine );
+            poLine = new OGRLineString();
+            poLine->addPoint( dfX, dfY );
+        }
+
+        const int nVCount = psEdge->nVertexCount;
+        if( nVCount > 0 )
+        {
+            int nVBase = poLine->getNumPoints();
+            poLine->setNumPoints( nVBase + nVCount );
+
+            for( int i = 0; i < nVCount; i++ )
+            {
+                const size_t iVertex = psEdge->nFirstVertex +
+                    ( bReverse ? nVCount - 1 - i : i );
+                dfX = adfEdgeX[iVertex];
+                dfY = adfEdgeY[iVertex];
+                poLine->setPoint( nVBase++, dfX, dfY );
+            }
+        }
+
+        dlastfX = dfX;
+        dlastfY = dfY;
+
+        psNode = nLastNode == -1 ? nullptr :
+            FindDecodedNode( RCNM_VC, nLastNode );
+        if( psNode != nullptr )
+        {
+            poLine->addPoint( psNode->dfX, psNode->dfY );
+            dlastfX = psNode->dfX;
+            dlastfY = psNode->dfY;
+        }
+        else
+        {
+            psJob->aosWarnings.push_back( CPLString().Printf(
+                "Unable to fetch end node RCID=%d.\n"
+                "Feature OBJL=%s, RCID=%d may have corrupt or "
+                "missing geometry.",
+                nLastNode, pszName, psJob->nFeatureRCID ) );
+        }
+    }
+
+    if( poMLS->getNumGeometries() > 0 )
+    {
+        poMLS->addGeometryDirectly( poLine );
+        psJob->poGeometry = poMLS;
+    }
+    else if( poLine->getNumPoints() >= 2 )
+    {
+        psJob->poGeometry = poLine;
+        delete poMLS;
+    }
+    else
+    {
+        delete poLine;
+        delete poMLS;
+    }
+}
+
+/************************************************************************/
+/*                      AssembleJobAreaGeometry()                       */
+/*                                                                      */
+/*      Same logic as AssembleAreaGeometry(), on the decoded edges.     */
+/************************************************************************/
+
+void S57Reader::AssembleJobAreaGeometry( S57GeometryJob *psJob ) const
+
+{
+    OGRGeometryCollection * const poLines = new OGRGeometryCollection();
+
+    for( const auto& sJobEdge: psJob->asEdges )
+    {
+        const S57DecodedEdge *psEdge = FindDecodedEdge( sJobEdge.nRCID );
+        if( psEdge == nullptr )
+        {
+            psJob->aosWarnings.push_back( CPLString().Printf(
+                "Couldn't find spatial record %d.\n"
+                "Feature OBJL=%s, RCID=%d may have corrupt or "
+                "missing geometry.",
+                sJobEdge.nRCID,
+                psJob->poFeature->GetDefnRef()->GetName(),
+                psJob->nFeatureRCID ) );
+            continue;
+        }
+
+        OGRLineString *poLine = new OGRLineString();
+
+        const S57DecodedNode *psNode = nullptr;
+        if( psEdge->nVRPTCount >= 1 && psEdge->nStartNode != -1 &&
+            (psNode = FindDecodedNode( RCNM_VC, psEdge->nStartNode ))
+                                                            != nullptr )
+            poLine->addPoint( psNode->dfX, psNode->dfY );
+
+        const int nVCount = psEdge->nVertexCount;
+        if( nVCount > 0 )
+        {
+            int nVBase = poLine->getNumPoints();
+            poLine->setNumPoints( nVBase + nVCount );
+
+            for( int i = 0; i < nVCount; i++ )
+            {
+                const size_t iVertex = psEdge->nFirstVertex + i;
+                poLine->setPoint( nVBase++, adfEdgeX[iVertex],
+                                  adfEdgeY[iVertex] );
+            }
+        }
+
+        if( psEdge->nVRPTCount == 2 && psEdge->nEndNode != -1 &&
+            (psNode = FindDecodedNode( RCNM_VC, psEdge->nEndNode ))
+                                                            != nullptr )
+            poLine->addPoint( psNode->dfX, psNode->dfY );
+
+        poLines->addGeometryDirectly( poLine );
+    }
+
+    OGRErr eErr;
+
+    psJob->poGeometry = reinterpret_cast<OGRGeometry *>(
+        OGRBuildPolygonFromEdges( reinterpret_cast<OGRGeometryH>( poLines ),
+                                  TRUE, FALSE, 0.0, &eErr ) );
+    if( eErr != OGRERR_NONE )
+    {
+        psJob->aosWarnings.push_back( CPLString().Printf(
+            "Polygon assembly has failed for feature FIDN=%d,FIDS=%d.\n"
+            "Geometry may be missing or incomplete.",
+            psJob->poFeature->GetFieldAsInteger( "FIDN" ),
+            psJob->poFeature->GetFieldAsInteger( "FIDS" ) ) );
+    }
+
+    delete poLines;
+}
+
+/************************************************************************/
+/*                          GeometryJobFunc()                           */
+/************************************************************************/
+
+void S57Reader::GeometryJobFunc( void *pData )
+
+{
+    S57GeometryJob *psJob = static_cast<S57GeometryJob *>( pData );
+
+    if( psJob->nPRIM == PRIM_L )
+        psJob->poReader->AssembleJobLineGeometry( psJob );
+    else
+        psJob->poReader->AssembleJobAreaGeometry( psJob );
+}
+
+/************************************************************************/
+/*                         FinishGeometryJob()                          */
+/*                                                                      */
+/*      Issue the warnings of a job, and assign its geometry.           */
+/************************************************************************/
+
+void S57Reader::FinishGeometryJob( S57GeometryJob *psJob )
+
+{
+    for( const auto& osWarning: psJob->aosWarnings )
+        CPLError( CE_Warning, CPLE_AppDefined, "%s", osWarning.c_str() );
+
+    if( psJob->poGeometry != nullptr )
+        psJob->poFeature->SetGeometryDirectly( psJob->poGeometry );
+
+    psJob->poGeometry = nullptr;
+    psJob->aosWarnings.clear();
+}
+
+/************************************************************************/
+/*                          PrefetchFeatures()                          */
+/*                                                                      */
+/*      Assemble the next batch of features of the target definition,   */
+/*      building their line and area geometries with the worker         */
+/*      threads.  The attributes are still read by this thread, as the  */
+/*      DDF records are not safe for concurrent access.                 */
+/************************************************************************/
+
+void S57Reader::PrefetchFeatures( OGRFeatureDefn *poTarget )
+
+{
+    // Features skipped by the layer reading them are eventually dropped.
+    if( oMapPreparedFeatures.size() > 1024 )
+        ClearPreparedFeatures();
+
+    const int nMaxFeatures = 16 * nNumThreads;
+    std::vector<S57GeometryJob> asJobs( nMaxFeatures );
+    int nPrepared = 0;
+
+    for( int iFeature = nNextFEIndex;
+         iFeature < oFE_Index.GetCount() && nPrepared < nMaxFeatures;
+         iFeature++ )
+    {
+        // ReadFeature() returns the DSID feature for index 0.
+        if( ((nOptionFlags & S57M_RETURN_DSID) && iFeature == 0) ||
+            oMapPreparedFeatures.find( iFeature ) !=
+                                            oMapPreparedFeatures.end() )
+            continue;
+
+        OGRFeatureDefn *poFeatureDefn = static_cast<OGRFeatureDefn *>(
+            oFE_Index.GetClientInfoByIndex( iFeature ) );
+        if( poFeatureDefn == nullptr )
+        {
+            poFeatureDefn = FindFDefn( oFE_Index.GetByIndex( iFeature ) );
+            oFE_Index.SetClientInfoByIndex( iFeature, poFeatureDefn );
+        }
+
+        if( poFeatureDefn != poTarget && poTarget != nullptr )
+            continue;
+
+        OGRFeature *poFeature =
+            AssembleFeature( oFE_Index.GetByIndex( iFeature ), poTarget,
+                             &asJobs[nPrepared] );
+        if( poFeature != nullptr )
+            poFeature->SetFID( iFeature );
+        oMapPreparedFeatures[iFeature] = poFeature;
+        nPrepared++;
+    }
+
+    std::vector<S57GeometryJob *> apsJobs;
+    for( int i = 0; i < nPrepared; i++ )
+    {
+        if( asJobs[i].poFeature != nullptr )
+            apsJobs.push_back( &asJobs[i] );
+    }
+
+    if( apsJobs.size() > 1 && poJobQueue == nullptr )
+    {
+        CPLWorkerThreadPool *poPool =
+            CPLGetGlobalWorkerThreadPool( nNumThreads );
+        if( poPool != nullptr )
+            poJobQueue = poPool->CreateJobQueue().release();
+        else
+            nNumThreads = 1;
+    }
+
+    if( poJobQueue != nullptr && apsJobs.size() > 1 )
+    {
+        for( size_t i = 1; i < apsJobs.size(); i++ )
+        {
+            if( !poJobQueue->SubmitJob( GeometryJobFunc, apsJobs[i] ) )
+                GeometryJobFunc( apsJobs[i] );
+        }
+        GeometryJobFunc( apsJobs[0] );
+        poJobQueue->WaitCompletion();
+    }
+    else
+    {
+        for( auto psJob: apsJobs )
+            GeometryJobFunc( psJob );
+    }
+
+    for( auto psJob: apsJobs )
+        FinishGeometryJob( psJob );
+}
+
+/************************************************************************/
+/*                       ClearPreparedFeatures()                        */
+/************************************************************************/
+
+void S57Reader::ClearPreparedFeatures()
+
+{
+    for( auto& oIter: oMapPreparedFeatures )
+        delete oIter.second;
+    oMapPreparedFeatures.clear();
+}
+
 /************************************************************************/
 /*                             FindFDefn()                              */
 /*                                                                      */
@@ -3157,6 +3841,10 @@ bool S57Reader::ApplyUpdates( DDFModule *poUpdateModule )
     if( !bFileIngested && !Ingest() )
         return false;
 
+    // The primitives will be decoded again from the updated records.
+    ClearPreparedFeatures();
+    ClearDecodedPrimitives();
+
 /* -------------------------------------------------------------------- */
 /*      Read records, and apply as updates.                             */
 /* -------------------------------------------------------------------- */
@@ -55,6 +55,10 @@
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
                                SHPObject *psShape, const char *pszSHPEncoding );
+bool SHPReadOGRFeatureInto( SHPHandle hSHP, DBFHandle hDBF,
+                            OGRFeatureDefn * poDefn, int iShape,
+                            SHPObject *psShape, const char *pszSHPEncoding,
+                            OGRFeature *poFeature );
 OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape );
 OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
                                        SHPHandle hSHP, DBFHandle hDBF,
@@ -191,6 +195,9 @@ class OGRShapeLayer final: public OGRAbstractProxiedLayer
 
     virtual void        CloseUnderlyingLayer() override;
 
+    virtual int         GetNextArrowArray(struct ArrowArrayStream*,
+                                          struct ArrowArray* out_array) override;
+
 // WARNING: Each of the below public methods should start with a call to
 // TouchLayer() and test its return value, so as to make sure that
 // the layer is properly re-opened if necessary.
@@ -208,6 +215,7 @@ class OGRShapeLayer final: public OGRAbstractProxiedLayer
     const char         *GetFullName() { return pszFullName; }
 
     OGRFeature *        FetchShape( int iShapeId );
+    bool                FetchShapeInto( int iShapeId, OGRFeature *poFeature );
     int                 GetFeatureCountWithSpatialFilterOnly();
 
   public:
@@ -222,6 +230,7 @@ class OGRShapeLayer final: public OGRAbstractProxiedLayer
 
     void                ResetReading() override;
     OGRFeature *        GetNextFeature() override;
+    bool                GetNextFeatureInto( OGRFeature *poFeature ) override;
     virtual OGRErr      SetNextByIndex( GIntBig nIndex ) override;
 
     OGRFeature         *GetFeature( GIntBig nFeatureId ) override;
@@ -1188,7 +1188,7 @@ const char* const* OGRShapeDataSource::GetExtensionsForDeletion()
 {
     static const char * const apszExtensions[] =
         { "shp", "shx", "dbf", "sbn", "sbx", "prj", "idm", "ind",
-          "qix", "cpg",
+          "obi", "qix", "cpg",
           "qpj", // QGIS projection file
           nullptr };
     return apszExtensions;
@@ -36,6 +36,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <new>
 #include <algorithm>
 #include <string>
 
@@ -52,6 +53,7 @@
 #include "ogr_p.h"
 #include "ogr_spatialref.h"
 #include "ogr_srs_api.h"
+#include "ogrlayerarrow.h"
 #include "ogrlayerpool.h"
 #include "ogrsf_frmts.h"
 #include "shapefil.h"
@@ -770,7 +772,23 @@ OGRErr OGRShapeLayer::SetNextByIndex( GIntBig nIndex )
 OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
 
 {
-    OGRFeature *poFeature = nullptr;
+    OGRFeature *poFeature = new OGRFeature( poFeatureDefn );
+    if( FetchShapeInto( iShapeId, poFeature ) )
+        return poFeature;
+    delete poFeature;
+    return nullptr;
+}
+
+/************************************************************************/
+/*                           FetchShapeInto()                           */
+/*                                                                      */
+/*      Same as FetchShape(), but fill an existing feature.             */
+/************************************************************************/
+
+bool OGRShapeLayer::FetchShapeInto( int iShapeId, OGRFeature *poFeature )
+
+{
+    bool bRet = false;
 
     if( m_poFilterGeom != nullptr && hSHP != nullptr )
     {
@@ -786,8 +804,9 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
                     || psShape->dfYMin == psShape->dfYMax))
             || psShape->nSHPType == SHPT_NULL )
         {
-            poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+            bRet = SHPReadOGRFeatureInto( hSHP, hDBF, poFeatureDefn,
+                                          iShapeId, psShape, osEncoding,
+                                          poFeature );
         }
         else if( m_sFilterEnvelope.MaxX < psShape->dfXMin
                  || m_sFilterEnvelope.MaxY < psShape->dfYMin
@@ -795,21 +814,200 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
                  || psShape->dfYMax < m_sFilterEnvelope.MinY )
         {
             SHPDestroyObject(psShape);
-            poFeature = nullptr;
+            bRet = false;
         }
         else
         {
-            poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+            bRet = SHPReadOGRFeatureInto( hSHP, hDBF, poFeatureDefn,
+                                          iShapeId, psShape, osEncoding,
+                                          poFeature );
         }
     }
     else
     {
-        poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                       iShapeId, nullptr, osEncoding );
+        bRet = SHPReadOGRFeatureInto( hSHP, hDBF, poFeatureDefn,
+                                      iShapeId, nullptr, osEncoding,
+                                      poFeature );
     }
 
-    return poFeature;
+    return bRet;
+}
+
+/************************************************************************/
+/*                         GetNextArrowArray()                          */
+/*                                                                      */
+/*      Sequential read of the .dbf attributes straight into the        */
+/*      columns of the batch, without building an OGRFeature.           */
+/************************************************************************/
+
+int OGRShapeLayer::GetNextArrowArray( struct ArrowArrayStream* stream,
+                                      struct ArrowArray* out_array )
+
+{
+    if( !TouchLayer() )
+    {
+        memset(out_array, 0, sizeof(*out_array));
+        return EIO;
+    }
+
+    // Filters may use indices, and need the full feature to be evaluated.
+    if( m_poAttrQuery != nullptr || m_poFilterGeom != nullptr )
+        return OGRLayer::GetNextArrowArray(stream, out_array);
+
+    memset(out_array, 0, sizeof(*out_array));
+    CSLConstList papszOptions = m_aosArrowArrayStreamOptions.List();
+    const int nMaxBatchSize =
+        OGRArrowArrayBuilder::GetMaxFeaturesInBatch(papszOptions);
+    const bool bReadGeometry =
+        hSHP != nullptr && !poFeatureDefn->IsGeometryIgnored();
+    const OGRwkbGeometryType eLayerGeomType =
+        poFeatureDefn->GetGeomFieldCount() ?
+            poFeatureDefn->GetGeomFieldDefn(0)->GetType() : wkbNone;
+    const int nFieldCount = hDBF ? poFeatureDefn->GetFieldCount() : 0;
+
+    try
+    {
+        OGRArrowArrayBuilder oBuilder(
+            poFeatureDefn, OGRArrowArrayBuilder::IncludeFID(papszOptions));
+        while( oBuilder.GetRowCount() < nMaxBatchSize )
+        {
+            if( iNextShapeId >= nTotalShapeCount )
+            {
+                m_bArrowArrayStreamEOF = true;
+                break;
+            }
+
+            const int iShape = iNextShapeId;
+            if( hDBF )
+            {
+                if( DBFIsRecordDeleted( hDBF, iShape ) )
+                {
+                    iNextShapeId++;
+                    continue;
+                }
+                if( VSI_SHP_IsEOF(hDBF->fp) )
+                {
+                    // I/O error.
+                    m_bArrowArrayStreamEOF = true;
+                    break;
+                }
+            }
+            iNextShapeId++;
+
+            oBuilder.SetFID( iShape );
+
+            if( bReadGeometry )
+            {
+                OGRGeometry* poGeom =
+                    SHPReadOGRObject( hSHP, iShape, nullptr );
+                if( poGeom && eLayerGeomType != wkbUnknown )
+                {
+                    poGeom->set3D( wkbHasZ(eLayerGeomType) );
+                    poGeom->setMeasured( wkbHasM(eLayerGeomType) );
+                }
+                oBuilder.SetGeometry( 0, poGeom );
+                delete poGeom;
+            }
+
+            for( int iField = 0; iField < nFieldCount; iField++ )
+            {
+                const OGRFieldDefn * const poFieldDefn =
+                    poFeatureDefn->GetFieldDefn(iField);
+                if( poFieldDefn->IsIgnored() )
+                    continue;
+
+                const OGRFieldType eType = poFieldDefn->GetType();
+                if( eType != OFTString &&
+                    DBFIsAttributeNULL( hDBF, iShape, iField ) )
+                {
+                    continue;
+                }
+
+                const char * const pszFieldVal =
+                    DBFReadStringAttribute( hDBF, iShape, iField );
+                if( pszFieldVal == nullptr || pszFieldVal[0] == '\0' )
+                    continue;
+
+                switch( eType )
+                {
+                    case OFTString:
+                    {
+                        if( !osEncoding.empty() )
+                        {
+                            char * const pszUTF8Field =
+                                CPLRecode( pszFieldVal, osEncoding,
+                                           CPL_ENC_UTF8 );
+                            oBuilder.SetString( iField, pszUTF8Field );
+                            CPLFree( pszUTF8Field );
+                        }
+                        else
+                        {
+                            oBuilder.SetString( iField, pszFieldVal );
+                        }
+                        break;
+                    }
+
+                    case OFTInteger:
+                        oBuilder.SetInteger( iField, atoi(pszFieldVal) );
+                        break;
+
+                    case OFTInteger64:
+                        oBuilder.SetInteger64( iField,
+                                               CPLAtoGIntBig(pszFieldVal) );
+                        break;
+
+                    case OFTReal:
+                        oBuilder.SetReal( iField, CPLAtof(pszFieldVal) );
+                        break;
+
+                    case OFTDate:
+                    {
+                        OGRField sFld;
+                        memset( &sFld, 0, sizeof(sFld) );
+
+                        if( strlen(pszFieldVal) >= 10 &&
+                            pszFieldVal[2] == '/' && pszFieldVal[5] == '/' )
+                        {
+                            sFld.Date.Month =
+                                static_cast<GByte>(atoi(pszFieldVal + 0));
+                            sFld.Date.Day =
+                                static_cast<GByte>(atoi(pszFieldVal + 3));
+                            sFld.Date.Year =
+                                static_cast<GInt16>(atoi(pszFieldVal + 6));
+                        }
+                        else
+                        {
+                            const int nFullDate = atoi(pszFieldVal);
+                            sFld.Date.Year =
+                                static_cast<GInt16>(nFullDate / 10000);
+                            sFld.Date.Month =
+                                static_cast<GByte>((nFullDate / 100) % 100);
+                            sFld.Date.Day =
+                                static_cast<GByte>(nFullDate % 100);
+                        }
+                        oBuilder.SetField( iField, &sFld );
+                        break;
+                    }
+
+                    default:
+                        break;
+                }
+            }
+
+            oBuilder.EndRow();
+            m_nFeaturesRead++;
+        }
+
+        if( oBuilder.GetRowCount() == 0 )
+            return 0;
+        return oBuilder.Finish(out_array) ? 0 : EOVERFLOW;
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory in GetNextArrowArray()");
+        return ENOMEM;
+    }
 }
 
 /************************************************************************/
@@ -822,6 +1020,26 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
     if( !TouchLayer() )
         return nullptr;
 
+    OGRFeature *poFeature = new OGRFeature( poFeatureDefn );
+    if( GetNextFeatureInto( poFeature ) )
+        return poFeature;
+    delete poFeature;
+    return nullptr;
+}
+
+/************************************************************************/
+/*                         GetNextFeatureInto()                         */
+/************************************************************************/
+
+bool OGRShapeLayer::GetNextFeatureInto( OGRFeature *poFeature )
+
+{
+    if( !TouchLayer() )
+        return false;
+
+    if( poFeature->GetDefnRef() != poFeatureDefn )
+        return OGRLayer::GetNextFeatureInto( poFeature );
+
 /* -------------------------------------------------------------------- */
 /*      Collect a matching list if we have attribute or spatial         */
 /*      indices.  Only do this on the first request for a given pass    */
@@ -836,21 +1054,21 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
 /* -------------------------------------------------------------------- */
 /*      Loop till we find a feature matching our criteria.              */
 /* -------------------------------------------------------------------- */
-    OGRFeature *poFeature = nullptr;
-
     while( true )
     {
+        bool bGotShape = false;
+
         if( panMatchingFIDs != nullptr )
         {
             if( panMatchingFIDs[iMatchingFID] == OGRNullFID )
             {
-                return nullptr;
+                return false;
             }
 
             // Check the shape object's geometry, and if it matches
             // any spatial filter, return it.
-            poFeature =
-                FetchShape(static_cast<int>(panMatchingFIDs[iMatchingFID]));
+            bGotShape = FetchShapeInto(
+                static_cast<int>(panMatchingFIDs[iMatchingFID]), poFeature);
 
             iMatchingFID++;
         }
@@ -858,25 +1076,25 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
         {
             if( iNextShapeId >= nTotalShapeCount )
             {
-                return nullptr;
+                return false;
             }
 
             if( hDBF )
             {
                 if( DBFIsRecordDeleted( hDBF, iNextShapeId ) )
-                    poFeature = nullptr;
-                else if( VSIFEofL(VSI_SHP_GetVSIL(hDBF->fp)) )
-                    return nullptr;  //* I/O error.
+                    bGotShape = false;
+                else if( VSI_SHP_IsEOF(hDBF->fp) )
+                    return false;  //* I/O error.
                 else
-                    poFeature = FetchShape(iNextShapeId);
+                    bGotShape = FetchShapeInto(iNextShapeId, poFeature);
             }
             else
-                poFeature = FetchShape(iNextShapeId);
+                bGotShape = FetchShapeInto(iNextShapeId, poFeature);
 
             iNextShapeId++;
         }
 
-        if( poFeature != nullptr )
+        if( bGotShape )
         {
             OGRGeometry* poGeom = poFeature->GetGeometryRef();
             if( poGeom != nullptr )
@@ -890,10 +1108,8 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
                 && (m_poAttrQuery == nullptr ||
                     m_poAttrQuery->Evaluate( poFeature )) )
             {
-                return poFeature;
+                return true;
             }
-
-            delete poFeature;
         }
     }
 }
@@ -1299,7 +1515,7 @@ int OGRShapeLayer::GetFeatureCountWithSpatialFilterOnly()
                 if( DBFIsRecordDeleted( hDBF, iShape ) )
                     continue;
 
-                if( VSIFEofL(VSI_SHP_GetVSIL(hDBF->fp)) )
+                if( VSI_SHP_IsEOF(hDBF->fp) )
                     break;
             }
         }
@@ -2416,6 +2632,101 @@ OGRErr OGRShapeLayer::DropSpatialIndex()
     return OGRERR_NONE;
 }
 
+/************************************************************************/
+/*                        CreateTreeFromBounds()                        */
+/************************************************************************/
+
+// Equivalent of SHPCreateTree( hSHP, 2, nMaxDepth, nullptr, nullptr ),
+// except that, for shape types that have a bounding box in their record
+// header, only that header is read instead of the whole shape.
+static SHPTree* CreateTreeFromBounds( SHPHandle hSHP, int nMaxDepth )
+{
+    int nShapeCount = 0;
+    double adfBoundsMin[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double adfBoundsMax[4] = { 0.0, 0.0, 0.0, 0.0 };
+    SHPGetInfo( hSHP, &nShapeCount, nullptr, adfBoundsMin, adfBoundsMax );
+
+    // Same estimation as in SHPCreateTree(): approximately 8 shapes per
+    // node, and at most 12 levels.
+    if( nMaxDepth == 0 )
+    {
+        int nMaxNodeCount = 1;
+        while( nMaxNodeCount * 4 < nShapeCount )
+        {
+            nMaxDepth += 1;
+            nMaxNodeCount = nMaxNodeCount * 2;
+        }
+        CPLDebug( "Shape", "Estimated spatial index tree depth: %d",
+                  nMaxDepth );
+        nMaxDepth = std::min(nMaxDepth, 12);
+    }
+
+    SHPTree *psTree = SHPCreateTree( nullptr, 2, nMaxDepth,
+                                     adfBoundsMin, adfBoundsMax );
+    if( psTree == nullptr )
+        return nullptr;
+    psTree->hSHP = hSHP;
+
+    for( int iShape = 0; iShape < nShapeCount; iShape++ )
+    {
+        SHPObject sShape;
+        memset(&sShape, 0, sizeof(sShape));
+        sShape.nShapeId = iShape;
+
+        bool bBoundsRead = false;
+        if( hSHP->panRecOffset[iShape] != 0 /* lazy shx loading case */ &&
+            hSHP->panRecSize[iShape] >= 40 + 4 )
+        {
+            GByte abyBuf[4 + 8 * 4] = {};
+            if( hSHP->sHooks.FSeek( hSHP->fpSHP,
+                                    hSHP->panRecOffset[iShape] + 8, 0 ) == 0 &&
+                hSHP->sHooks.FRead( abyBuf, sizeof(abyBuf),
+                                    1, hSHP->fpSHP ) == 1 )
+            {
+                memcpy(&(sShape.nSHPType), abyBuf, 4);
+                CPL_LSBPTR32(&(sShape.nSHPType));
+                if( sShape.nSHPType == SHPT_POLYGON ||
+                    sShape.nSHPType == SHPT_POLYGONZ ||
+                    sShape.nSHPType == SHPT_POLYGONM ||
+                    sShape.nSHPType == SHPT_ARC ||
+                    sShape.nSHPType == SHPT_ARCZ ||
+                    sShape.nSHPType == SHPT_ARCM ||
+                    sShape.nSHPType == SHPT_MULTIPOINT ||
+                    sShape.nSHPType == SHPT_MULTIPOINTZ ||
+                    sShape.nSHPType == SHPT_MULTIPOINTM ||
+                    sShape.nSHPType == SHPT_MULTIPATCH )
+                {
+                    memcpy(&(sShape.dfXMin), abyBuf + 4, 8);
+                    memcpy(&(sShape.dfYMin), abyBuf + 12, 8);
+                    memcpy(&(sShape.dfXMax), abyBuf + 20, 8);
+                    memcpy(&(sShape.dfYMax), abyBuf + 28, 8);
+                    CPL_LSBPTR64(&(sShape.dfXMin));
+                    CPL_LSBPTR64(&(sShape.dfYMin));
+                    CPL_LSBPTR64(&(sShape.dfXMax));
+                    CPL_LSBPTR64(&(sShape.dfYMax));
+                    bBoundsRead = true;
+                }
+            }
+        }
+
+        if( bBoundsRead )
+        {
+            SHPTreeAddShapeId( psTree, &sShape );
+        }
+        else
+        {
+            SHPObject *psShape = SHPReadObject( hSHP, iShape );
+            if( psShape != nullptr )
+            {
+                SHPTreeAddShapeId( psTree, psShape );
+                SHPDestroyObject( psShape );
+            }
+        }
+    }
+
+    return psTree;
+}
+
 /************************************************************************/
 /*                         CreateSpatialIndex()                         */
 /************************************************************************/
@@ -2438,7 +2749,7 @@ OGRErr OGRShapeLayer::CreateSpatialIndex( int nMaxDepth )
 /*      Build a quadtree structure for this file.                       */
 /* -------------------------------------------------------------------- */
     SyncToDisk();
-    SHPTree *psTree = SHPCreateTree( hSHP, 2, nMaxDepth, nullptr, nullptr );
+    SHPTree *psTree = CreateTreeFromBounds( hSHP, nMaxDepth );
 
     if( nullptr == psTree )
     {
@@ -2593,7 +2904,7 @@ OGRErr OGRShapeLayer::Repack()
                 }
                 panRecordsToDelete[nDeleteCount++] = iShape;
             }
-            if( VSIFEofL(VSI_SHP_GetVSIL(hDBF->fp)) )
+            if( VSI_SHP_IsEOF(hDBF->fp) )
             {
                 CPLFree( panRecordsToDelete );
                 return OGRERR_FAILURE;  //I/O error.
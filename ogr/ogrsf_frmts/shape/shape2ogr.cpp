@@ -1144,6 +1144,30 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
                                SHPObject *psShape, const char *pszSHPEncoding )
 
+{
+    OGRFeature *poFeature = new OGRFeature( poDefn );
+    if( !SHPReadOGRFeatureInto( hSHP, hDBF, poDefn, iShape, psShape,
+                                pszSHPEncoding, poFeature ) )
+    {
+        delete poFeature;
+        return nullptr;
+    }
+    return poFeature;
+}
+
+/************************************************************************/
+/*                       SHPReadOGRFeatureInto()                        */
+/*                                                                      */
+/*      Same as SHPReadOGRFeature(), but fill an existing feature,      */
+/*      possibly recycled from a previous shape, so every field is      */
+/*      overwritten.                                                    */
+/************************************************************************/
+
+bool SHPReadOGRFeatureInto( SHPHandle hSHP, DBFHandle hDBF,
+                            OGRFeatureDefn * poDefn, int iShape,
+                            SHPObject *psShape, const char *pszSHPEncoding,
+                            OGRFeature *poFeature )
+
 {
     if( iShape < 0
         || (hSHP != nullptr && iShape >= hSHP->nRecords)
@@ -1152,7 +1176,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Attempt to read shape with feature id (%d) out of available"
                   " range.", iShape );
-        return nullptr;
+        return false;
     }
 
     if( hDBF && DBFIsRecordDeleted( hDBF, iShape ) )
@@ -1163,11 +1187,9 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                   iShape );
         if( psShape != nullptr )
             SHPDestroyObject(psShape);
-        return nullptr;
+        return false;
     }
 
-    OGRFeature  *poFeature = new OGRFeature( poDefn );
-
 /* -------------------------------------------------------------------- */
 /*      Fetch geometry from Shapefile to OGRFeature.                    */
 /* -------------------------------------------------------------------- */
@@ -1217,9 +1239,11 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
 
             poFeature->SetGeometryDirectly( poGeometry );
         }
-        else if( psShape != nullptr )
+        else
         {
-            SHPDestroyObject( psShape );
+            if( psShape != nullptr )
+                SHPDestroyObject( psShape );
+            poFeature->SetGeometryDirectly( nullptr );
         }
     }
 
@@ -1233,7 +1257,10 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
     {
         const OGRFieldDefn * const poFieldDefn = poDefn->GetFieldDefn(iField);
         if( poFieldDefn->IsIgnored() )
+        {
+            poFeature->UnsetField(iField);
             continue;
+        }
 
         switch( poFieldDefn->GetType() )
         {
@@ -1290,7 +1317,10 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
               // (trimmed by DBFReadStringAttribute) to indicate null
               // values for dates (#4265).
               if( pszDateValue[0] == '\0' )
+              {
+                  poFeature->UnsetField(iField);
                   continue;
+              }
 
               OGRField sFld;
               memset( &sFld, 0, sizeof(sFld) );
@@ -1319,10 +1349,9 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         }
     }
 
-    if( poFeature != nullptr )
-        poFeature->SetFID( iShape );
+    poFeature->SetFID( iShape );
 
-    return poFeature;
+    return true;
 }
 
 /************************************************************************/
@@ -31,11 +31,19 @@
 #include "shp_vsi.h"
 #include "cpl_error.h"
 #include "cpl_conv.h"
+#include "cpl_string.h"
 #include "cpl_vsi_error.h"
 #include <limits.h>
+#include <string.h>
 
 CPL_CVSID("$Id: shp_vsi.c dae19934cb8852265339c697a23f82b0d59f7976 2017-07-05 13:27:02Z Even Rouault $")
 
+/* Read buffer of files opened in read-only mode. Its size starts small, */
+/* so that random access is not penalized, and grows as long as reads */
+/* are sequential, so that full scans are done with few large reads. */
+#define SHP_VSI_MIN_BUFFER_SIZE   4096
+#define SHP_VSI_MAX_BUFFER_SIZE   (1024 * 1024)
+
 typedef struct
 {
     VSILFILE *fp;
@@ -43,6 +51,13 @@ typedef struct
     int       bEnforce2GBLimit;
     int       bHasWarned2GB;
     SAOffset  nCurOffset;
+
+    int       bBuffered;
+    int       bEOF;
+    GByte    *pabyBuffer;
+    size_t    nBufferAlloc;
+    size_t    nBufferValid;
+    SAOffset  nBufferOffset;
 } OGRSHPDBFFile;
 
 /************************************************************************/
@@ -83,6 +98,8 @@ SAFile VSI_SHP_OpenInternal( const char *pszFilename, const char *pszAccess,
     pFile->pszFilename = CPLStrdup(pszFilename);
     pFile->bEnforce2GBLimit = bEnforce2GBLimit;
     pFile->nCurOffset = 0;
+    pFile->bBuffered = strcmp(pszAccess, "rb") == 0 &&
+        CPLTestBoolean(CPLGetConfigOption("SHAPE_BUFFERED_READ", "YES"));
     return (SAFile) pFile;
 }
 
@@ -108,6 +125,88 @@ SAFile VSI_SHP_Open2GBLimit( const char *pszFilename, const char *pszAccess )
     return VSI_SHP_OpenInternal(pszFilename, pszAccess, TRUE);
 }
 
+/************************************************************************/
+/*                        VSI_SHP_ReadBuffered()                        */
+/************************************************************************/
+
+static
+size_t VSI_SHP_ReadBuffered( GByte *pabyOut, size_t nToRead,
+                             OGRSHPDBFFile* pFile )
+
+{
+    size_t nRead = 0;
+    while( nRead < nToRead )
+    {
+        size_t nNewSize;
+        GByte* pabyNewBuffer;
+
+        /* Serve from the buffer what can be */
+        if( pFile->nCurOffset >= pFile->nBufferOffset &&
+            pFile->nCurOffset < pFile->nBufferOffset +
+                                        (SAOffset)pFile->nBufferValid )
+        {
+            const size_t nPosInBuffer =
+                (size_t)(pFile->nCurOffset - pFile->nBufferOffset);
+            size_t nAvail = pFile->nBufferValid - nPosInBuffer;
+            if( nAvail > nToRead - nRead )
+                nAvail = nToRead - nRead;
+            memcpy(pabyOut + nRead, pFile->pabyBuffer + nPosInBuffer, nAvail);
+            nRead += nAvail;
+            pFile->nCurOffset += nAvail;
+            continue;
+        }
+
+        /* Grow the buffer if continuing a sequential read, or go back to */
+        /* a small one otherwise */
+        if( pFile->pabyBuffer != NULL &&
+            pFile->nCurOffset == pFile->nBufferOffset +
+                                        (SAOffset)pFile->nBufferValid )
+        {
+            nNewSize = pFile->nBufferAlloc * 2;
+            if( nNewSize > SHP_VSI_MAX_BUFFER_SIZE )
+                nNewSize = SHP_VSI_MAX_BUFFER_SIZE;
+        }
+        else
+        {
+            nNewSize = SHP_VSI_MIN_BUFFER_SIZE;
+        }
+
+        /* Large requests go directly to the file */
+        if( nToRead - nRead >= nNewSize )
+        {
+            size_t nDirect;
+            if( VSIFSeekL(pFile->fp, (vsi_l_offset)pFile->nCurOffset,
+                          SEEK_SET) != 0 )
+                break;
+            nDirect = VSIFReadL(pabyOut + nRead, 1, nToRead - nRead,
+                                pFile->fp);
+            nRead += nDirect;
+            pFile->nCurOffset += nDirect;
+            break;
+        }
+
+        if( nNewSize != pFile->nBufferAlloc )
+        {
+            pabyNewBuffer = (GByte*) VSI_REALLOC_VERBOSE(pFile->pabyBuffer,
+                                                         nNewSize);
+            if( pabyNewBuffer == NULL )
+                break;
+            pFile->pabyBuffer = pabyNewBuffer;
+            pFile->nBufferAlloc = nNewSize;
+        }
+        pFile->nBufferOffset = pFile->nCurOffset;
+        pFile->nBufferValid = 0;
+        if( VSIFSeekL(pFile->fp, (vsi_l_offset)pFile->nCurOffset,
+                      SEEK_SET) != 0 )
+            break;
+        pFile->nBufferValid = VSIFReadL(pFile->pabyBuffer, 1,
+                                        pFile->nBufferAlloc, pFile->fp);
+        if( pFile->nBufferValid == 0 )
+            break;
+    }
+    return nRead;
+}
+
 /************************************************************************/
 /*                            VSI_SHP_Read()                            */
 /************************************************************************/
@@ -117,12 +216,38 @@ SAOffset VSI_SHP_Read( void *p, SAOffset size, SAOffset nmemb, SAFile file )
 
 {
     OGRSHPDBFFile* pFile = (OGRSHPDBFFile*) file;
-    SAOffset ret = (SAOffset) VSIFReadL( p, (size_t) size, (size_t) nmemb,
+    SAOffset ret;
+    if( pFile->bBuffered )
+    {
+        const size_t nToRead = (size_t)size * (size_t)nmemb;
+        size_t nRead;
+        if( nToRead == 0 )
+            return 0;
+        nRead = VSI_SHP_ReadBuffered( (GByte*)p, nToRead, pFile );
+        pFile->bEOF = nRead < nToRead;
+        /* Only complete members are reported, as VSIFReadL() does */
+        ret = (SAOffset)(nRead / (size_t)size);
+        pFile->nCurOffset -= (SAOffset)(nRead - (size_t)ret * (size_t)size);
+        return ret;
+    }
+    ret = (SAOffset) VSIFReadL( p, (size_t) size, (size_t) nmemb,
                                  pFile->fp );
     pFile->nCurOffset += ret * size;
     return ret;
 }
 
+/************************************************************************/
+/*                            VSI_SHP_IsEOF()                           */
+/************************************************************************/
+
+int VSI_SHP_IsEOF( SAFile file )
+{
+    OGRSHPDBFFile* pFile = (OGRSHPDBFFile*) file;
+    if( pFile->bBuffered )
+        return pFile->bEOF;
+    return VSIFEofL( pFile->fp );
+}
+
 /************************************************************************/
 /*                      VSI_SHP_WriteMoreDataOK()                       */
 /************************************************************************/
@@ -177,7 +302,24 @@ SAOffset VSI_SHP_Seek( SAFile file, SAOffset offset, int whence )
 
 {
     OGRSHPDBFFile* pFile = (OGRSHPDBFFile*) file;
-    SAOffset ret = (SAOffset) VSIFSeekL( pFile->fp, (vsi_l_offset) offset, whence );
+    SAOffset ret;
+    if( pFile->bBuffered )
+    {
+        /* The actual seek is deferred to the next read that is not served */
+        /* by the buffer */
+        pFile->bEOF = FALSE;
+        if( whence == SEEK_SET )
+        {
+            pFile->nCurOffset = offset;
+            return 0;
+        }
+        if( whence == SEEK_CUR )
+        {
+            pFile->nCurOffset += offset;
+            return 0;
+        }
+    }
+    ret = (SAOffset) VSIFSeekL( pFile->fp, (vsi_l_offset) offset, whence );
     if( whence == 0 && ret == 0)
         pFile->nCurOffset = offset;
     else
@@ -219,6 +361,7 @@ int VSI_SHP_Close( SAFile file )
 {
     OGRSHPDBFFile* pFile = (OGRSHPDBFFile*) file;
     int ret = VSIFCloseL( pFile->fp );
+    CPLFree(pFile->pabyBuffer);
     CPLFree(pFile->pszFilename);
     CPLFree(pFile);
     return ret;
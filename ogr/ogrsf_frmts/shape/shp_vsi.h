@@ -41,6 +41,7 @@ const SAHooks* VSI_SHP_GetHook(int b2GBLimit);
 VSILFILE* VSI_SHP_GetVSIL( SAFile file );
 const char* VSI_SHP_GetFilename( SAFile file );
 int VSI_SHP_WriteMoreDataOK( SAFile file, SAOffset nExtraBytes );
+int VSI_SHP_IsEOF( SAFile file );
 
 CPL_C_END
 
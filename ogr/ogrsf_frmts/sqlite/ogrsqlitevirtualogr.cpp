@@ -300,6 +300,38 @@ OGRLayer* OGR2SQLITEModule::GetLayerForVTable(const char* pszVTableName)
 /* See http://www.sqlite.org/vtab.html for the documentation on how to
    implement a new module for the Virtual Table mechanism. */
 
+#ifdef SQLITE_INDEX_CONSTRAINT_FUNCTION
+/* SQLite >= 3.25 */
+
+/************************************************************************/
+/*                    OGR2SQLITE_SpatialPredicate                       */
+/************************************************************************/
+
+/* Binary spatial predicates that can only be true if both geometries
+   intersect, so that the envelope of the second argument can be used
+   as a spatial filter on the layer of the first one. */
+static const char* const apszOGR2SQLITESpatialPredicates[] =
+{
+    "ST_Intersects", "Intersects",
+    "ST_Within", "Within",
+    "ST_Contains", "Contains",
+    "ST_Equals", "Equals",
+    "ST_Touches", "Touches",
+    "ST_Crosses", "Crosses",
+    "ST_Overlaps", "Overlaps"
+};
+
+#define OGR2SQLITE_SPATIAL_PREDICATE_COUNT \
+    (int)(sizeof(apszOGR2SQLITESpatialPredicates) / \
+          sizeof(apszOGR2SQLITESpatialPredicates[0]))
+
+typedef struct
+{
+    const char           *pszName;
+    sqlite3_stmt         *hStmt;
+} OGR2SQLITE_SpatialPredicate;
+#endif
+
 /************************************************************************/
 /*                            OGR2SQLITE_vtab                           */
 /************************************************************************/
@@ -318,6 +350,10 @@ typedef struct
     int                   bCloseDS;
     OGRLayer             *poLayer;
     int                   nMyRef;
+#ifdef SQLITE_INDEX_CONSTRAINT_FUNCTION
+    OGR2SQLITE_SpatialPredicate asSpatialPredicates[
+                                OGR2SQLITE_SPATIAL_PREDICATE_COUNT];
+#endif
 } OGR2SQLITE_vtab;
 
 /************************************************************************/
@@ -344,6 +380,10 @@ typedef struct
 
     GByte         *pabyGeomBLOB;
     int            nGeomBLOBLen;
+
+    /* Index of the geometry field on which a spatial filter has been set */
+    /* by OGR2SQLITE_Filter(), or -1 */
+    int            iSpatialFilterGeomField;
 } OGR2SQLITE_vtab_cursor;
 
 /************************************************************************/
@@ -802,13 +842,14 @@ int OGR2SQLITE_BestIndex(sqlite3_vtab *pVTab, sqlite3_index_info* pIndex)
              osQueryPatternUsable.c_str(), osQueryPatternNotUsable.c_str());
 #endif
 
+    const int nFieldCount = poFDefn->GetFieldCount();
     int nConstraints = 0;
     for( int i = 0; i < pIndex->nConstraint; i++ )
     {
         int iCol = pIndex->aConstraint[i].iColumn;
         if (pIndex->aConstraint[i].usable &&
             OGR2SQLITE_IsHandledOp(pIndex->aConstraint[i].op) &&
-            iCol < poFDefn->GetFieldCount() &&
+            iCol < nFieldCount &&
             (iCol < 0 || poFDefn->GetFieldDefn(iCol)->GetType() != OFTBinary))
         {
             pIndex->aConstraintUsage[i].argvIndex = nConstraints + 1;
@@ -816,6 +857,23 @@ int OGR2SQLITE_BestIndex(sqlite3_vtab *pVTab, sqlite3_index_info* pIndex)
 
             nConstraints ++;
         }
+#ifdef SQLITE_INDEX_CONSTRAINT_FUNCTION
+        else if (pIndex->aConstraint[i].usable &&
+                 pIndex->aConstraint[i].op >=
+                                    SQLITE_INDEX_CONSTRAINT_FUNCTION &&
+                 iCol > nFieldCount &&
+                 iCol - (nFieldCount + 1) < poFDefn->GetGeomFieldCount())
+        {
+            /* Spatial predicate overloaded by OGR2SQLITE_FindFunction() */
+            /* on a geometry column: the envelope of its second argument */
+            /* is used as a spatial filter, but SQLite must still */
+            /* evaluate the predicate itself. */
+            pIndex->aConstraintUsage[i].argvIndex = nConstraints + 1;
+            pIndex->aConstraintUsage[i].omit = FALSE;
+
+            nConstraints ++;
+        }
+#endif
         else
         {
             pIndex->aConstraintUsage[i].argvIndex = 0;
@@ -835,7 +893,7 @@ int OGR2SQLITE_BestIndex(sqlite3_vtab *pVTab, sqlite3_index_info* pIndex)
 
         for( int i = 0; i < pIndex->nConstraint; i++ )
         {
-            if (pIndex->aConstraintUsage[i].omit)
+            if (pIndex->aConstraintUsage[i].argvIndex > 0)
             {
                 panConstraints[2 * nConstraints + 1] =
                                             pIndex->aConstraint[i].iColumn;
@@ -878,6 +936,13 @@ int OGR2SQLITE_DisconnectDestroy(sqlite3_vtab *pVTab)
 #endif
 
     sqlite3_free(pMyVTab->zErrMsg);
+#ifdef SQLITE_INDEX_CONSTRAINT_FUNCTION
+    for( int i = 0; i < OGR2SQLITE_SPATIAL_PREDICATE_COUNT; i++ )
+    {
+        if( pMyVTab->asSpatialPredicates[i].hStmt )
+            sqlite3_finalize(pMyVTab->asSpatialPredicates[i].hStmt);
+    }
+#endif
     if( pMyVTab->bCloseDS )
         pMyVTab->poDS->Release();
     pMyVTab->poModule->UnregisterVTable(pMyVTab->pszVTableName);
@@ -944,6 +1009,7 @@ int OGR2SQLITE_Open(sqlite3_vtab *pVTab, sqlite3_vtab_cursor **ppCursor)
 
     pCursor->pabyGeomBLOB = nullptr;
     pCursor->nGeomBLOBLen = -1;
+    pCursor->iSpatialFilterGeomField = -1;
 
     return SQLITE_OK;
 }
@@ -963,6 +1029,10 @@ int OGR2SQLITE_Close(sqlite3_vtab_cursor* pCursor)
 #endif
     pMyVTab->nMyRef --;
 
+    if( pMyCursor->iSpatialFilterGeomField >= 0 )
+        pMyCursor->poLayer->SetSpatialFilter(
+                            pMyCursor->iSpatialFilterGeomField, nullptr);
+
     delete pMyCursor->poFeature;
     delete pMyCursor->poDupDataSource;
 
@@ -996,12 +1066,45 @@ int OGR2SQLITE_Filter(sqlite3_vtab_cursor* pCursor,
         return SQLITE_ERROR;
 
     CPLString osAttributeFilter;
+    int iSpatialFilterGeomField = -1;
+    OGREnvelope sSpatialFilterEnvelope;
 
     OGRFeatureDefn* poFDefn = pMyCursor->poLayer->GetLayerDefn();
 
     for( int i = 0; i < argc; i++ )
     {
         int nCol = panConstraints[2 * i + 1];
+
+#ifdef SQLITE_INDEX_CONSTRAINT_FUNCTION
+        if( panConstraints[2 * i + 2] >= SQLITE_INDEX_CONSTRAINT_FUNCTION )
+        {
+            /* Spatial predicate: only one geometry field can be filtered */
+            const int iGeomField = nCol - (poFDefn->GetFieldCount() + 1);
+            int nSRID = 0;
+            OGRwkbGeometryType eType = wkbUnknown;
+            bool bIsEmpty = false;
+            OGREnvelope sEnvelope;
+            if( sqlite3_value_type(argv[i]) == SQLITE_BLOB &&
+                (iSpatialFilterGeomField < 0 ||
+                 iSpatialFilterGeomField == iGeomField) &&
+                OGRSQLiteLayer::GetSpatialiteGeometryHeader(
+                    static_cast<const GByte*>(sqlite3_value_blob(argv[i])),
+                    sqlite3_value_bytes(argv[i]),
+                    &nSRID, &eType, &bIsEmpty,
+                    &sEnvelope.MinX, &sEnvelope.MinY,
+                    &sEnvelope.MaxX, &sEnvelope.MaxY) == OGRERR_NONE &&
+                !bIsEmpty )
+            {
+                if( iSpatialFilterGeomField < 0 )
+                    sSpatialFilterEnvelope = sEnvelope;
+                else
+                    sSpatialFilterEnvelope.Intersect(sEnvelope);
+                iSpatialFilterGeomField = iGeomField;
+            }
+            continue;
+        }
+#endif
+
         OGRFieldDefn* poFieldDefn = nullptr;
         if( nCol >= 0 )
         {
@@ -1010,7 +1113,7 @@ int OGR2SQLITE_Filter(sqlite3_vtab_cursor* pCursor,
                 return SQLITE_ERROR;
         }
 
-        if( i != 0 )
+        if( !osAttributeFilter.empty() )
             osAttributeFilter += " AND ";
 
         if( poFieldDefn != nullptr )
@@ -1128,6 +1231,33 @@ int OGR2SQLITE_Filter(sqlite3_vtab_cursor* pCursor,
         return SQLITE_ERROR;
     }
 
+    if( iSpatialFilterGeomField >= 0 )
+    {
+#ifdef DEBUG_OGR2SQLITE
+        CPLDebug("OGR2SQLITE", "Spatial filter : %.18g %.18g %.18g %.18g",
+                 sSpatialFilterEnvelope.MinX, sSpatialFilterEnvelope.MinY,
+                 sSpatialFilterEnvelope.MaxX, sSpatialFilterEnvelope.MaxY);
+#endif
+        if( pMyCursor->iSpatialFilterGeomField >= 0 &&
+            pMyCursor->iSpatialFilterGeomField != iSpatialFilterGeomField )
+        {
+            pMyCursor->poLayer->SetSpatialFilter(
+                            pMyCursor->iSpatialFilterGeomField, nullptr);
+        }
+        pMyCursor->poLayer->SetSpatialFilterRect(iSpatialFilterGeomField,
+                                                 sSpatialFilterEnvelope.MinX,
+                                                 sSpatialFilterEnvelope.MinY,
+                                                 sSpatialFilterEnvelope.MaxX,
+                                                 sSpatialFilterEnvelope.MaxY);
+        pMyCursor->iSpatialFilterGeomField = iSpatialFilterGeomField;
+    }
+    else if( pMyCursor->iSpatialFilterGeomField >= 0 )
+    {
+        pMyCursor->poLayer->SetSpatialFilter(
+                            pMyCursor->iSpatialFilterGeomField, nullptr);
+        pMyCursor->iSpatialFilterGeomField = -1;
+    }
+
     if( pMyCursor->poLayer->TestCapability(OLCFastFeatureCount) )
         pMyCursor->nFeatureCount = pMyCursor->poLayer->GetFeatureCount();
     else
@@ -1494,11 +1624,60 @@ int OGR2SQLITE_Rename(CPL_UNUSED sqlite3_vtab *pVtab, CPL_UNUSED const char *zNe
     return SQLITE_ERROR;
 }
 
-#if 0
+#ifdef SQLITE_INDEX_CONSTRAINT_FUNCTION
+
+/************************************************************************/
+/*                    OGR2SQLITE_SpatialPredicateFunc()                 */
+/************************************************************************/
+
+/* Implementation of the spatial predicates overloaded by
+   OGR2SQLITE_FindFunction(). The original function (from Spatialite, or
+   from ogrsqlitesqlfunctions.cpp) is evaluated through a statement, in
+   which it is not overloaded since its first argument is not a column of
+   the virtual table. */
+static
+void OGR2SQLITE_SpatialPredicateFunc(sqlite3_context* pContext,
+                                     int argc, sqlite3_value** argv)
+{
+    OGR2SQLITE_SpatialPredicate* psPredicate =
+        static_cast<OGR2SQLITE_SpatialPredicate*>(sqlite3_user_data(pContext));
+    sqlite3* hDB = sqlite3_context_db_handle(pContext);
+
+    if( psPredicate->hStmt == nullptr )
+    {
+        CPLString osSQL;
+        osSQL.Printf("SELECT %s(?, ?)", psPredicate->pszName);
+        if( sqlite3_prepare_v2(hDB, osSQL, -1,
+                               &psPredicate->hStmt, nullptr) != SQLITE_OK )
+        {
+            psPredicate->hStmt = nullptr;
+            sqlite3_result_error(pContext, sqlite3_errmsg(hDB), -1);
+            return;
+        }
+    }
+
+    sqlite3_reset(psPredicate->hStmt);
+    for( int i = 0; i < argc; i++ )
+        sqlite3_bind_value(psPredicate->hStmt, i + 1, argv[i]);
+    if( sqlite3_step(psPredicate->hStmt) == SQLITE_ROW )
+    {
+        sqlite3_result_value(pContext,
+                             sqlite3_column_value(psPredicate->hStmt, 0));
+    }
+    else
+    {
+        sqlite3_result_error(pContext, sqlite3_errmsg(hDB), -1);
+    }
+    sqlite3_reset(psPredicate->hStmt);
+}
+
 /************************************************************************/
 /*                        OGR2SQLITE_FindFunction()                     */
 /************************************************************************/
 
+/* Called by SQLite for functions whose first argument is a column of the
+   virtual table. Overloading the spatial predicates makes them available
+   as constraints to OGR2SQLITE_BestIndex(). */
 static
 int OGR2SQLITE_FindFunction(sqlite3_vtab *pVtab,
                             int nArg,
@@ -1506,11 +1685,30 @@ int OGR2SQLITE_FindFunction(sqlite3_vtab *pVtab,
                             void (**pxFunc)(sqlite3_context*,int,sqlite3_value**),
                             void **ppArg)
 {
+    OGR2SQLITE_vtab* pMyVTab = (OGR2SQLITE_vtab*) pVtab;
+#ifdef DEBUG_OGR2SQLITE
     CPLDebug("OGR2SQLITE", "FindFunction %s", zName);
+#endif
+
+    if( nArg != 2 )
+        return 0;
+
+    for( int i = 0; i < OGR2SQLITE_SPATIAL_PREDICATE_COUNT; i++ )
+    {
+        if( EQUAL(zName, apszOGR2SQLITESpatialPredicates[i]) )
+        {
+            pMyVTab->asSpatialPredicates[i].pszName =
+                                        apszOGR2SQLITESpatialPredicates[i];
+            *pxFunc = OGR2SQLITE_SpatialPredicateFunc;
+            *ppArg = &(pMyVTab->asSpatialPredicates[i]);
+            return SQLITE_INDEX_CONSTRAINT_FUNCTION;
+        }
+    }
 
     return 0;
 }
-#endif
+
+#endif // SQLITE_INDEX_CONSTRAINT_FUNCTION
 
 /************************************************************************/
 /*                     OGR2SQLITE_FeatureFromArgs()                     */
@@ -1705,7 +1903,11 @@ static const struct sqlite3_module sOGR2SQLITEModule =
     nullptr, /* xSync */
     nullptr, /* xCommit */
     nullptr, /* xFindFunctionRollback */
-    nullptr, /* xFindFunction */  // OGR2SQLITE_FindFunction;
+#ifdef SQLITE_INDEX_CONSTRAINT_FUNCTION
+    OGR2SQLITE_FindFunction,
+#else
+    nullptr, /* xFindFunction */
+#endif
     OGR2SQLITE_Rename,
 #if SQLITE_VERSION_NUMBER >= 3007007L /* should be the first version with the below symbols */
     nullptr,  // xSavepoint
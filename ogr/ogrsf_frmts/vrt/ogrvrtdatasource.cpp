@@ -670,6 +670,12 @@ OGRLayer *OGRVRTDataSource::InstantiateUnionLayer(
         bPreserveSrcFID = CPLTestBool(pszPreserveFID);
     poLayer->SetPreserveSrcFID(bPreserveSrcFID);
 
+    // Set the ParallelReading attribute.
+    const char *pszParallelReading =
+        CPLGetXMLValue(psLTree, "ParallelReading", nullptr);
+    if( pszParallelReading != nullptr && CPLTestBool(pszParallelReading) )
+        poLayer->SetParallelReading(CPLGetNumCPUs());
+
     // Set fields.
     FieldUnionStrategy eFieldStrategy = FIELD_UNION_ALL_LAYERS;
     const char *pszFieldStrategy =
@@ -1602,15 +1602,16 @@ retry:
     ClipAndAssignSRS(poDstFeat);
 
     // Copy fields.
-    for( int iVRTField = 0; iVRTField < poFeatureDefn->GetFieldCount();
-         iVRTField++ )
+    OGRFeatureDefn *poSrcFeatDefn = poSrcFeat->GetDefnRef();
+    const int nVRTFieldCount = poFeatureDefn->GetFieldCount();
+    for( int iVRTField = 0; iVRTField < nVRTFieldCount; iVRTField++ )
     {
         if( anSrcField[iVRTField] == -1 )
             continue;
 
         OGRFieldDefn *poDstDefn = poFeatureDefn->GetFieldDefn(iVRTField);
         OGRFieldDefn *poSrcDefn =
-            poSrcLayer->GetLayerDefn()->GetFieldDefn(anSrcField[iVRTField]);
+            poSrcFeatDefn->GetFieldDefn(anSrcField[iVRTField]);
 
         if( !poSrcFeat->IsFieldSetAndNotNull(anSrcField[iVRTField]) ||
             poDstDefn->IsIgnored() )
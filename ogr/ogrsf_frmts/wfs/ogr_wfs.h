@@ -30,6 +30,9 @@
 #ifndef OGR_WFS_H_INCLUDED
 #define OGR_WFS_H_INCLUDED
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <set>
 #include <map>
@@ -38,6 +41,7 @@
 #include "ogrsf_frmts.h"
 #include "gmlreader.h"
 #include "cpl_http.h"
+#include "cpl_worker_thread_pool.h"
 #include "swq.h"
 
 CPLXMLNode* WFSFindNode(CPLXMLNode* psXML, const char* pszRootName);
@@ -80,6 +84,19 @@ class OGRWFSSortDesc
 
 class OGRWFSDataSource;
 
+/************************************************************************/
+/*                        OGRWFSPrefetchedPage                          */
+/************************************************************************/
+
+/* GetFeature request of a page emitted ahead of time by a worker thread */
+struct OGRWFSPrefetchedPage
+{
+    CPLString           osURL{};
+    char              **papszOptions = nullptr;
+    CPLHTTPResult      *psResult = nullptr;
+    std::atomic<bool>   bDone{false};
+};
+
 class OGRWFSLayer final: public OGRLayer
 {
     OGRWFSDataSource*   poDS;
@@ -144,6 +161,15 @@ class OGRWFSLayer final: public OGRLayer
     int                 nFeatureRead;
     int                 nFeatureCountRequested;
 
+    std::unique_ptr<CPLWorkerThreadPool> poPrefetchPool{};
+    std::deque<std::unique_ptr<OGRWFSPrefetchedPage>> aoPrefetchedPages{};
+    int                 nNextPrefetchStartIndex = 0;
+
+    void                SubmitPagePrefetch(const CPLString& osURL);
+    void                DiscardPrefetchedPages();
+    CPLHTTPResult*      FetchPage(const CPLString& osURL);
+    static void         PrefetchPageFunc(void* pData);
+
     OGRFeatureDefn*     BuildLayerDefnFromFeatureClass(GMLFeatureClass* poClass);
 
     char                *pszRequiredOutputFormat;
@@ -321,6 +347,7 @@ class OGRWFSDataSource final: public OGRDataSource
     bool                bPagingAllowed;
     int                 nPageSize;
     int                 nBaseStartIndex;
+    int                 nPagingPrefetch;
     bool                DetectSupportPagingWFS2(CPLXMLNode* psRoot);
 
     bool                bStandardJoinsWFS2;
@@ -401,10 +428,15 @@ class OGRWFSDataSource final: public OGRDataSource
     void                        SaveLayerSchema(const char* pszLayerName, CPLXMLNode* psSchema);
 
     CPLHTTPResult*              HTTPFetch( const char* pszURL, char** papszOptions );
+    char**                      BuildHTTPOptions( char** papszOptions );
+    CPLHTTPResult*              CheckHTTPResult( CPLHTTPResult* psResult,
+                                                 const char* pszURL,
+                                                 char** papszOptions );
 
     bool                        IsPagingAllowed() const { return bPagingAllowed; }
     int                         GetPageSize() const { return nPageSize; }
     int                         GetBaseStartIndex() const { return nBaseStartIndex; }
+    int                         GetPagingPrefetch() const { return nPagingPrefetch; }
 
     void                        LoadMultipleLayerDefn(const char* pszLayerName,
                                                       char* pszNS, char* pszNSVal);
@@ -30,6 +30,7 @@
 #include "cpl_conv.h"
 #include "cpl_minixml.h"
 #include "cpl_http.h"
+#include "cpl_worker_thread_pool.h"
 #include "swq.h"
 
 #include <algorithm>
@@ -76,6 +77,17 @@ class OGROAPIFDataset final: public GDALDataset
             CPLString& osContentType,
             CPLStringList* paosHeaders = nullptr );
 
+        char**                  GetHTTPOptions(const char* pszAccept,
+                                               const char* pszPersistentId);
+        CPLString               AddUserQueryParams(const CPLString& osURL) const;
+        static bool             CheckDownloadResult(
+            CPLHTTPResult* psResult,
+            const CPLString& osURL,
+            const char* pszAccept,
+            CPLString& osResult,
+            CPLString& osContentType,
+            CPLStringList* paosHeaders );
+
         bool                    DownloadJSon(
             const CPLString& osURL,
             CPLJSONDocument& oDoc,
@@ -126,6 +138,27 @@ class OGROAPIFLayer final: public OGRLayer
         bool            m_bHasIntIdMember = false;
         bool            m_bHasStringIdMember = false;
 
+        // Download of the page pointed by the "next" link, done while the
+        // current page is consumed
+        struct PrefetchedPage
+        {
+            CPLString       osURL{};
+            CPLString       osURLWithQueryParameters{};
+            char          **papszOptions = nullptr;
+            CPLHTTPResult  *psResult = nullptr;
+        };
+        bool            m_bPrefetchNextPage = true;
+        bool            m_bMustCleanPersistent = false;
+        std::unique_ptr<CPLWorkerThreadPool> m_poPrefetchPool;
+        std::unique_ptr<PrefetchedPage> m_poPrefetchedPage;
+
+        static void     PrefetchPageFunc(void* pData);
+        void            PrefetchPage(const CPLString& osURL);
+        void            DiscardPrefetchedPage();
+        bool            DownloadPage(const CPLString& osURL,
+                                     CPLJSONDocument& oDoc,
+                                     CPLStringList* paosHeaders);
+
         void            EstablishFeatureDefn();
         OGRFeature     *GetNextRawFeature();
         CPLString       AddFilters(const CPLString& osURL);
@@ -266,6 +299,23 @@ bool OGROAPIFDataset::Download(
         return false;
     }
 #endif
+    m_bMustCleanPersistent = true;
+    char** papszOptions =
+        GetHTTPOptions(pszAccept, CPLSPrintf("OAPIF:%p", this));
+    CPLHTTPResult* psResult =
+        CPLHTTPFetch(AddUserQueryParams(osURL), papszOptions);
+    CSLDestroy(papszOptions);
+    return CheckDownloadResult(psResult, osURL, pszAccept,
+                               osResult, osContentType, paosHeaders);
+}
+
+/************************************************************************/
+/*                           GetHTTPOptions()                           */
+/************************************************************************/
+
+char** OGROAPIFDataset::GetHTTPOptions(const char* pszAccept,
+                                       const char* pszPersistentId)
+{
     char** papszOptions = CSLSetNameValue(nullptr,
             "HEADERS", (CPLString("Accept: ") + pszAccept).c_str());
     if( !m_osUserPwd.empty() )
@@ -273,9 +323,18 @@ bool OGROAPIFDataset::Download(
         papszOptions = CSLSetNameValue(papszOptions,
                                        "USERPWD", m_osUserPwd.c_str());
     }
-    m_bMustCleanPersistent = true;
     papszOptions =
-        CSLAddString(papszOptions, CPLSPrintf("PERSISTENT=OAPIF:%p", this));
+        CSLAddString(papszOptions,
+                     CPLSPrintf("PERSISTENT=%s", pszPersistentId));
+    return papszOptions;
+}
+
+/************************************************************************/
+/*                         AddUserQueryParams()                         */
+/************************************************************************/
+
+CPLString OGROAPIFDataset::AddUserQueryParams(const CPLString& osURL) const
+{
     CPLString osURLWithQueryParameters(osURL);
     if( !m_osUserQueryParams.empty() )
     {
@@ -289,8 +348,22 @@ bool OGROAPIFDataset::Download(
         }
         osURLWithQueryParameters += m_osUserQueryParams;
     }
-    CPLHTTPResult* psResult = CPLHTTPFetch(osURLWithQueryParameters, papszOptions);
-    CSLDestroy(papszOptions);
+    return osURLWithQueryParameters;
+}
+
+/************************************************************************/
+/*                        CheckDownloadResult()                         */
+/************************************************************************/
+
+// Takes ownership of psResult
+bool OGROAPIFDataset::CheckDownloadResult(
+            CPLHTTPResult* psResult,
+            const CPLString& osURL,
+            const char* pszAccept,
+            CPLString& osResult,
+            CPLString& osContentType,
+            CPLStringList* paosHeaders )
+{
     if( !psResult )
         return false;
 
@@ -741,7 +814,9 @@ OGROAPIFLayer::OGROAPIFLayer(OGROAPIFDataset* poDS,
                            const CPLString& osName,
                            const CPLJSONArray& oBBOX,
                            const CPLJSONArray& /* oCRS */) :
-    m_poDS(poDS)
+    m_poDS(poDS),
+    m_bPrefetchNextPage(CPLTestBool(
+        CPLGetConfigOption("OGR_OAPIF_PREFETCH_NEXT_PAGE", "YES")))
 {
     m_poFeatureDefn = new OGRFeatureDefn(osName);
     m_poFeatureDefn->Reference();
@@ -801,6 +876,15 @@ OGROAPIFLayer::OGROAPIFLayer(OGROAPIFDataset* poDS,
 
 OGROAPIFLayer::~OGROAPIFLayer()
 {
+    DiscardPrefetchedPage();
+    if( m_bMustCleanPersistent )
+    {
+        char **papszOptions =
+            CSLSetNameValue(
+                nullptr, "CLOSE_PERSISTENT", CPLSPrintf("OAPIF:%p", this));
+        CPLHTTPDestroyResult(CPLHTTPFetch(m_osURL, papszOptions));
+        CSLDestroy(papszOptions);
+    }
     m_poFeatureDefn->Release();
 }
 
@@ -883,6 +967,7 @@ void OGROAPIFLayer::EstablishFeatureDefn()
 
 void OGROAPIFLayer::ResetReading()
 {
+    DiscardPrefetchedPage();
     m_poUnderlyingDS.reset();
     m_poUnderlyingLayer = nullptr;
     m_nFID = 1;
@@ -943,6 +1028,104 @@ CPLString OGROAPIFLayer::AddFilters(const CPLString& osURL)
     return osURLNew;
 }
 
+/************************************************************************/
+/*                          PrefetchPageFunc()                          */
+/************************************************************************/
+
+void OGROAPIFLayer::PrefetchPageFunc(void* pData)
+{
+    PrefetchedPage* psPage = static_cast<PrefetchedPage*>(pData);
+    psPage->psResult = CPLHTTPFetch(psPage->osURLWithQueryParameters,
+                                    psPage->papszOptions);
+}
+
+/************************************************************************/
+/*                            PrefetchPage()                            */
+/************************************************************************/
+
+// Start downloading osURL in a worker thread. The layer uses its own
+// persistent connection, as the one of the dataset may be used meanwhile
+// by the main thread.
+void OGROAPIFLayer::PrefetchPage(const CPLString& osURL)
+{
+    DiscardPrefetchedPage();
+#ifndef REMOVE_HACK
+    VSIStatBufL sStatBuf;
+    if( VSIStatL(osURL, &sStatBuf) == 0 )
+        return;
+#endif
+    if( !m_poPrefetchPool )
+    {
+        m_poPrefetchPool.reset(new CPLWorkerThreadPool());
+        if( !m_poPrefetchPool->Setup(1, nullptr, nullptr) )
+        {
+            m_poPrefetchPool.reset();
+            m_bPrefetchNextPage = false;
+            return;
+        }
+    }
+
+    m_bMustCleanPersistent = true;
+    std::unique_ptr<PrefetchedPage> poPage(new PrefetchedPage());
+    poPage->osURL = osURL;
+    poPage->osURLWithQueryParameters = m_poDS->AddUserQueryParams(osURL);
+    poPage->papszOptions = m_poDS->GetHTTPOptions(
+        MEDIA_TYPE_GEOJSON ", " MEDIA_TYPE_JSON,
+        CPLSPrintf("OAPIF:%p", this));
+    if( !m_poPrefetchPool->SubmitJob(PrefetchPageFunc, poPage.get()) )
+    {
+        CSLDestroy(poPage->papszOptions);
+        return;
+    }
+    m_poPrefetchedPage = std::move(poPage);
+}
+
+/************************************************************************/
+/*                        DiscardPrefetchedPage()                       */
+/************************************************************************/
+
+void OGROAPIFLayer::DiscardPrefetchedPage()
+{
+    if( !m_poPrefetchedPage )
+        return;
+    m_poPrefetchPool->WaitCompletion();
+    CSLDestroy(m_poPrefetchedPage->papszOptions);
+    if( m_poPrefetchedPage->psResult )
+        CPLHTTPDestroyResult(m_poPrefetchedPage->psResult);
+    m_poPrefetchedPage.reset();
+}
+
+/************************************************************************/
+/*                            DownloadPage()                            */
+/************************************************************************/
+
+bool OGROAPIFLayer::DownloadPage(const CPLString& osURL,
+                                 CPLJSONDocument& oDoc,
+                                 CPLStringList* paosHeaders)
+{
+    const char* pszAccept = MEDIA_TYPE_GEOJSON ", " MEDIA_TYPE_JSON;
+    if( m_poPrefetchedPage && m_poPrefetchedPage->osURL == osURL )
+    {
+        m_poPrefetchPool->WaitCompletion();
+        CPLHTTPResult* psResult = m_poPrefetchedPage->psResult;
+        CSLDestroy(m_poPrefetchedPage->papszOptions);
+        m_poPrefetchedPage.reset();
+
+        CPLString osResult;
+        CPLString osContentType;
+        if( !OGROAPIFDataset::CheckDownloadResult(psResult, osURL, pszAccept,
+                                                  osResult, osContentType,
+                                                  paosHeaders) )
+        {
+            return false;
+        }
+        return oDoc.LoadMemory( osResult );
+    }
+
+    DiscardPrefetchedPage();
+    return m_poDS->DownloadJSon(osURL, oDoc, pszAccept, paosHeaders);
+}
+
 /************************************************************************/
 /*                         GetNextRawFeature()                          */
 /************************************************************************/
@@ -965,9 +1148,7 @@ OGRFeature* OGROAPIFLayer::GetNextRawFeature()
             CPLString osURL(m_osGetURL);
             m_osGetURL.clear();
             CPLStringList aosHeaders;
-            if( !m_poDS->DownloadJSon(osURL, oDoc,
-                                      MEDIA_TYPE_GEOJSON ", " MEDIA_TYPE_JSON,
-                                      &aosHeaders) )
+            if( !DownloadPage(osURL, oDoc, &aosHeaders) )
             {
                 return nullptr;
             }
@@ -1064,6 +1245,13 @@ OGRFeature* OGROAPIFLayer::GetNextRawFeature()
                     m_osGetURL = m_poDS->ReinjectAuthInURL(m_osGetURL);
                 }
             }
+
+            // Overlap the download of the next page with the reading of
+            // the current one
+            if( !m_osGetURL.empty() && m_bPrefetchNextPage )
+            {
+                PrefetchPage(m_osGetURL);
+            }
         }
 
         poSrcFeature = m_poUnderlyingLayer->GetNextFeature();
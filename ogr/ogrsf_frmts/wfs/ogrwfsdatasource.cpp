@@ -42,6 +42,7 @@ CPL_CVSID("$Id: ogrwfsdatasource.cpp 39380a6be4086d4bec50dcb6c58eac748304afde 20
 
 constexpr int DEFAULT_BASE_START_INDEX = 0;
 constexpr int DEFAULT_PAGE_SIZE = 100;
+constexpr int DEFAULT_PAGING_PREFETCH = 2;
 
 typedef struct
 {
@@ -156,6 +157,7 @@ OGRWFSDataSource::OGRWFSDataSource() :
         CPLGetConfigOption("OGR_WFS_PAGING_ALLOWED", "OFF"))),
     nPageSize(DEFAULT_PAGE_SIZE),
     nBaseStartIndex(DEFAULT_BASE_START_INDEX),
+    nPagingPrefetch(DEFAULT_PAGING_PREFETCH),
     bStandardJoinsWFS2(false),
     bLoadMultipleLayerDefn(CPLTestBool(
         CPLGetConfigOption("OGR_WFS_LOAD_MULTIPLE_LAYER_DEFN", "TRUE"))),
@@ -181,6 +183,10 @@ OGRWFSDataSource::OGRWFSDataSource() :
         pszOption = CPLGetConfigOption("OGR_WFS_BASE_START_INDEX", nullptr);
         if( pszOption != nullptr )
             nBaseStartIndex = atoi(pszOption);
+
+        pszOption = CPLGetConfigOption("OGR_WFS_PAGING_PREFETCH", nullptr);
+        if( pszOption != nullptr )
+            nPagingPrefetch = std::max(0, atoi(pszOption));
     }
 
     apszGetCapabilities[0] = nullptr;
@@ -1015,6 +1021,10 @@ int OGRWFSDataSource::Open( const char * pszFilename, int bUpdateIn,
         if( pszParm )
             nBaseStartIndex = atoi(pszParm);
 
+        pszParm = CPLGetXMLValue( psRoot, "PagingPrefetch", nullptr );
+        if( pszParm )
+            nPagingPrefetch = std::max(0, atoi(pszParm));
+
         CPLString strOriginalTypeName = CPLURLGetValue(pszBaseURL, "TYPENAME");
         if( strOriginalTypeName.empty() )
             strOriginalTypeName = CPLURLGetValue(pszBaseURL, "TYPENAMES");
@@ -2042,15 +2052,39 @@ CPLString WFS_DecodeURL(const CPLString &osSrc)
 /************************************************************************/
 
 CPLHTTPResult* OGRWFSDataSource::HTTPFetch( const char* pszURL, char** papszOptions )
+{
+    char** papszNewOptions = BuildHTTPOptions(papszOptions);
+    CPLHTTPResult* psResult = CPLHTTPFetch( pszURL, papszNewOptions );
+    CSLDestroy(papszNewOptions);
+
+    return CheckHTTPResult(psResult, pszURL, papszOptions);
+}
+
+/************************************************************************/
+/*                         BuildHTTPOptions()                           */
+/************************************************************************/
+
+/* Return the options to pass to CPLHTTPFetch(), to be freed with CSLDestroy() */
+char** OGRWFSDataSource::BuildHTTPOptions( char** papszOptions )
 {
     char** papszNewOptions = CSLDuplicate(papszOptions);
     if( bUseHttp10 )
         papszNewOptions = CSLAddNameValue(papszNewOptions, "HTTP_VERSION", "1.0");
     if (papszHttpOptions)
         papszNewOptions = CSLMerge(papszNewOptions, papszHttpOptions);
-    CPLHTTPResult* psResult = CPLHTTPFetch( pszURL, papszNewOptions );
-    CSLDestroy(papszNewOptions);
+    return papszNewOptions;
+}
 
+/************************************************************************/
+/*                          CheckHTTPResult()                           */
+/************************************************************************/
+
+/* Validate the result of a CPLHTTPFetch() call issued with the options */
+/* returned by BuildHTTPOptions(). psResult is taken ownership of. */
+CPLHTTPResult* OGRWFSDataSource::CheckHTTPResult( CPLHTTPResult* psResult,
+                                                  const char* pszURL,
+                                                  char** papszOptions )
+{
     if (psResult == nullptr)
     {
         return nullptr;
@@ -153,6 +153,8 @@ OGRWFSLayer::~OGRWFSLayer()
     if( bInTransaction )
         OGRWFSLayer::CommitTransaction();
 
+    DiscardPrefetchedPages();
+
     if( poSRS != nullptr )
         poSRS->Release();
 
@@ -706,7 +708,10 @@ GDALDataset* OGRWFSLayer::FetchGetFeature(int nRequestMaxFeatures)
     /* that we are able to understand */
     CPLString osXSDFileName = CPLSPrintf("/vsimem/tempwfs_%p/file.xsd", this);
     VSIStatBufL sBuf;
-    if (CPLTestBool(CPLGetConfigOption("OGR_WFS_USE_STREAMING", "YES")) &&
+    /* unless pages are downloaded ahead of time */
+    const bool bPrefetchPages = bPagingActive && poDS->GetPagingPrefetch() > 0;
+    if (!bPrefetchPages &&
+        CPLTestBool(CPLGetConfigOption("OGR_WFS_USE_STREAMING", "YES")) &&
         (osOutputFormat.empty() || osOutputFormat.ifind("GML") != std::string::npos) &&
         VSIStatL(osXSDFileName, &sBuf) == 0 && GDALGetDriverByName("GML") != nullptr)
     {
@@ -785,7 +790,10 @@ GDALDataset* OGRWFSLayer::FetchGetFeature(int nRequestMaxFeatures)
     }
 
     bStreamingDS = false;
-    psResult = poDS->HTTPFetch( osURL, nullptr);
+    if( bPrefetchPages )
+        psResult = FetchPage(osURL);
+    else
+        psResult = poDS->HTTPFetch( osURL, nullptr);
     if (psResult == nullptr)
     {
         return nullptr;
@@ -1107,6 +1115,122 @@ OGRFeatureDefn * OGRWFSLayer::BuildLayerDefn(OGRFeatureDefn* poSrcFDefn)
     return poFeatureDefn;
 }
 
+/************************************************************************/
+/*                          PrefetchPageFunc()                          */
+/************************************************************************/
+
+void OGRWFSLayer::PrefetchPageFunc(void* pData)
+{
+    OGRWFSPrefetchedPage* psPage = static_cast<OGRWFSPrefetchedPage*>(pData);
+    psPage->psResult = CPLHTTPFetch(psPage->osURL, psPage->papszOptions);
+    psPage->bDone = true;
+}
+
+/************************************************************************/
+/*                         SubmitPagePrefetch()                         */
+/************************************************************************/
+
+void OGRWFSLayer::SubmitPagePrefetch(const CPLString& osURL)
+{
+    if( poPrefetchPool == nullptr )
+    {
+        poPrefetchPool.reset(new CPLWorkerThreadPool());
+        if( !poPrefetchPool->Setup(poDS->GetPagingPrefetch() + 1,
+                                   nullptr, nullptr) )
+        {
+            poPrefetchPool.reset();
+            return;
+        }
+    }
+
+    CPLDebug("WFS", "Prefetching %s", osURL.c_str());
+    std::unique_ptr<OGRWFSPrefetchedPage> poPage(new OGRWFSPrefetchedPage());
+    poPage->osURL = osURL;
+    /* Options are built on the calling thread, as they depend on the */
+    /* state of the data source */
+    poPage->papszOptions = poDS->BuildHTTPOptions(nullptr);
+    if( !poPrefetchPool->SubmitJob(PrefetchPageFunc, poPage.get()) )
+    {
+        CSLDestroy(poPage->papszOptions);
+        return;
+    }
+    aoPrefetchedPages.push_back(std::move(poPage));
+}
+
+/************************************************************************/
+/*                       DiscardPrefetchedPages()                       */
+/************************************************************************/
+
+void OGRWFSLayer::DiscardPrefetchedPages()
+{
+    if( aoPrefetchedPages.empty() )
+        return;
+
+    /* Requests cannot be cancelled, so wait for the in-flight ones */
+    poPrefetchPool->WaitCompletion();
+    for( auto& poPage: aoPrefetchedPages )
+    {
+        CSLDestroy(poPage->papszOptions);
+        if( poPage->psResult )
+            CPLHTTPDestroyResult(poPage->psResult);
+    }
+    aoPrefetchedPages.clear();
+}
+
+/************************************************************************/
+/*                             FetchPage()                              */
+/************************************************************************/
+
+/* Return the result of the GetFeature request of the current page, while */
+/* keeping the requests of the next pages in flight, so that the server */
+/* and the network work while we are parsing. */
+CPLHTTPResult* OGRWFSLayer::FetchPage(const CPLString& osURL)
+{
+    /* The pages downloaded ahead are only valid if they follow the page */
+    /* we are asked for (the filter, or the request itself after a retry, */
+    /* may have changed in between) */
+    if( !aoPrefetchedPages.empty() &&
+        aoPrefetchedPages.front()->osURL != osURL )
+    {
+        CPLDebug("WFS", "Discarding prefetched pages");
+        DiscardPrefetchedPages();
+    }
+    if( aoPrefetchedPages.empty() )
+    {
+        SubmitPagePrefetch(osURL);
+        if( aoPrefetchedPages.empty() )
+            return poDS->HTTPFetch( osURL, nullptr );
+        nNextPrefetchStartIndex = nPagingStartIndex + nFeatureCountRequested;
+    }
+
+    /* Top up the queue of requests. MakeGetFeatureURL() builds the URL */
+    /* of the page at nPagingStartIndex */
+    const int nCurPagingStartIndex = nPagingStartIndex;
+    const int nCurFeatureCountRequested = nFeatureCountRequested;
+    while( static_cast<int>(aoPrefetchedPages.size()) <=
+                                            poDS->GetPagingPrefetch() &&
+           nNextPrefetchStartIndex <= INT_MAX - nCurFeatureCountRequested )
+    {
+        nPagingStartIndex = nNextPrefetchStartIndex;
+        const size_t nQueued = aoPrefetchedPages.size();
+        SubmitPagePrefetch(MakeGetFeatureURL(0, FALSE));
+        if( aoPrefetchedPages.size() == nQueued )
+            break;
+        nNextPrefetchStartIndex += nCurFeatureCountRequested;
+    }
+    nPagingStartIndex = nCurPagingStartIndex;
+    nFeatureCountRequested = nCurFeatureCountRequested;
+
+    std::unique_ptr<OGRWFSPrefetchedPage> poPage(
+                                    std::move(aoPrefetchedPages.front()));
+    aoPrefetchedPages.pop_front();
+    while( !poPage->bDone )
+        poPrefetchPool->WaitEvent();
+
+    CSLDestroy(poPage->papszOptions);
+    return poDS->CheckHTTPResult(poPage->psResult, osURL, nullptr);
+}
+
 /************************************************************************/
 /*                            ResetReading()                            */
 /************************************************************************/
@@ -1115,6 +1239,7 @@ void OGRWFSLayer::ResetReading()
 
 {
     GetLayerDefn();
+    DiscardPrefetchedPages();
     if( bPagingActive )
         bReloadNeeded = true;
     nPagingStartIndex = 0;
@@ -60,6 +60,13 @@ class OGRXLSXLayer final: public OGRMemLayer
     bool               bHasHeaderLine;
     std::set<int>      oSetFieldsOfUnknownType{};
 
+    /* In streaming mode, features are not kept in the OGRMemLayer but */
+    /* produced by the datasource while the sheet is parsed. */
+    bool               bStreaming;
+    GIntBig            nStreamingFeatureCount;
+    GIntBig            nNextStreamedFeature;
+    void               Materialize();
+
   public:
         OGRXLSXLayer( OGRXLSXDataSource* poDSIn,
                       const char * pszFilename,
@@ -76,8 +83,7 @@ class OGRXLSXLayer final: public OGRMemLayer
     OGRwkbGeometryType  GetGeomType() override { return wkbNone; }
     virtual OGRSpatialReference *GetSpatialRef() override { return nullptr; }
 
-    void                ResetReading() override
-    { Init(); OGRMemLayer::ResetReading(); }
+    void                ResetReading() override;
 
     const CPLString&    GetFilename() const { return osFilename; }
 
@@ -87,16 +93,14 @@ class OGRXLSXLayer final: public OGRMemLayer
     virtual OGRErr              ISetFeature( OGRFeature *poFeature ) override;
     virtual OGRErr              DeleteFeature( GIntBig nFID ) override;
 
-    virtual OGRErr      SetNextByIndex( GIntBig nIndex ) override
-    { Init(); return OGRMemLayer::SetNextByIndex(nIndex); }
+    virtual OGRErr      SetNextByIndex( GIntBig nIndex ) override;
 
     virtual OGRErr              ICreateFeature( OGRFeature *poFeature ) override;
 
     OGRFeatureDefn *    GetLayerDefn() override
     { Init(); return OGRMemLayer::GetLayerDefn(); }
 
-    GIntBig                 GetFeatureCount( int bForce ) override
-    { Init(); return OGRMemLayer::GetFeatureCount(bForce); }
+    GIntBig                 GetFeatureCount( int bForce ) override;
 
     virtual OGRErr      CreateField( OGRFieldDefn *poField,
                                      int bApproxOK = TRUE ) override;
@@ -110,8 +114,7 @@ class OGRXLSXLayer final: public OGRMemLayer
     virtual OGRErr      AlterFieldDefn( int iField, OGRFieldDefn* poNewFieldDefn, int nFlagsIn ) override
     { Init(); SetUpdated(); return OGRMemLayer::AlterFieldDefn(iField, poNewFieldDefn, nFlagsIn); }
 
-    int                 TestCapability( const char * pszCap ) override
-    { Init(); return OGRMemLayer::TestCapability(pszCap); }
+    int                 TestCapability( const char * pszCap ) override;
 
     virtual OGRErr      SyncToDisk() override;
 };
@@ -135,6 +138,16 @@ typedef enum
     STATE_TEXTV,
 } HandlerStateEnum;
 
+typedef enum
+{
+    /* Features are stored in the OGRMemLayer */
+    BUILD_IN_MEMORY,
+    /* Only the layer definition and feature count are established */
+    BUILD_SCHEMA_ONLY,
+    /* Features are queued for OGRXLSXLayer::GetNextFeature() */
+    BUILD_STREAMING,
+} XLSXBuildMode;
+
 typedef struct
 {
     HandlerStateEnum  eVal;
@@ -171,8 +184,10 @@ class OGRXLSXDataSource final: public GDALDataset
     void                AnalyseWorkbookRels(VSILFILE* fpWorkbookRels);
     void                AnalyseStyles(VSILFILE* fpStyles);
 
-    std::vector<std::string>  apoSharedStrings;
-    std::string         osCurrentString;
+    /* All shared strings are concatenated in a single arena, and */
+    /* indexed by their start offset, to avoid per-string allocations. */
+    std::string         osSharedStringsArena;
+    std::vector<size_t> anSharedStringsOffsets;
 
     bool                bFirstLineIsHeaders;
     int                 bAutodetectTypes;
@@ -186,6 +201,14 @@ class OGRXLSXDataSource final: public GDALDataset
 
     OGRXLSXLayer       *poCurLayer;
 
+    XLSXBuildMode       eBuildMode;
+    OGRXLSXLayer       *poStreamingLayer;
+    VSILFILE           *fpStreaming;
+    bool                bStreamingEOF;
+    GIntBig             nStreamedFeatures;
+    std::vector<OGRFeature*> apoStreamedFeatures;
+    size_t              nStreamedFeatureIdx;
+
     int                 nStackDepth;
     int                 nDepth;
     HandlerState        stateStack[STACK_SIZE];
@@ -213,6 +236,12 @@ class OGRXLSXDataSource final: public GDALDataset
     void                dataHandlerTextV(const char *data, int nLen);
 
     void                DetectHeaderLine();
+    void                AddFeature(OGRFeature* poFeature);
+
+    void                CreateSheetParser();
+    bool                ParseSheetChunk(VSILFILE* fp,
+                                        const char* pszSheetFilename);
+    bool                StartStreaming(OGRXLSXLayer* poLayer);
 
     OGRFieldType        GetOGRFieldType(const char* pszValue,
                                         const char* pszValueType,
@@ -262,6 +291,8 @@ class OGRXLSXDataSource final: public GDALDataset
     void                endElementStylesCbk(const char *pszName);
 
     void                BuildLayer(OGRXLSXLayer* poLayer);
+    OGRFeature*         GetNextStreamedFeature(OGRXLSXLayer* poLayer);
+    void                StopStreaming(OGRXLSXLayer* poLayer = nullptr);
 
     bool                GetUpdatable() { return bUpdatable; }
     void                SetUpdated() { bUpdated = true; }
@@ -54,7 +54,11 @@ OGRXLSXLayer::OGRXLSXLayer( OGRXLSXDataSource* poDSIn,
     poDS(poDSIn),
     osFilename(pszFilename),
     bUpdated(CPL_TO_BOOL(bUpdatedIn)),
-    bHasHeaderLine(false)
+    bHasHeaderLine(false),
+    bStreaming(!bUpdatedIn && !poDSIn->GetUpdatable() &&
+               CPLTestBool(CPLGetConfigOption("OGR_XLSX_STREAMING", "YES"))),
+    nStreamingFeatureCount(0),
+    nNextStreamedFeature(0)
 {}
 
 /************************************************************************/
@@ -71,6 +75,55 @@ void OGRXLSXLayer::Init()
     }
 }
 
+/************************************************************************/
+/*                            Materialize()                             */
+/*                                                                      */
+/*      Load all the features of a streamed layer in the OGRMemLayer,   */
+/*      for the operations that need random access.                     */
+/************************************************************************/
+
+void OGRXLSXLayer::Materialize()
+{
+    Init();
+    if( !bStreaming )
+        return;
+
+    CPLDebug("XLSX", "Loading %s in memory", GetName());
+
+    const GIntBig nNextStreamedFeatureBackup = nNextStreamedFeature;
+    poDS->StopStreaming(this);
+    nNextStreamedFeature = 0;
+
+    SetUpdatable(true);
+    OGRFeature* poFeature = nullptr;
+    while( (poFeature = poDS->GetNextStreamedFeature(this)) != nullptr )
+    {
+        poFeature->SetFID(OGRNullFID);
+        CPL_IGNORE_RET_VAL(OGRMemLayer::ICreateFeature(poFeature));
+        delete poFeature;
+    }
+    poDS->StopStreaming(this);
+    SetUpdatable(poDS->GetUpdatable());
+    bStreaming = false;
+
+    /* Restore the reading position, which is not affected by filters */
+    OGRMemLayer::ResetReading();
+    if( nNextStreamedFeatureBackup > 0 )
+    {
+        OGRFeatureQuery* poAttrQuery = m_poAttrQuery;
+        OGRGeometry* poFilterGeom = m_poFilterGeom;
+        m_poAttrQuery = nullptr;
+        m_poFilterGeom = nullptr;
+        if( OGRMemLayer::SetNextByIndex(nNextStreamedFeatureBackup - 1) ==
+                                                                OGRERR_NONE )
+        {
+            delete OGRMemLayer::GetNextFeature();
+        }
+        m_poAttrQuery = poAttrQuery;
+        m_poFilterGeom = poFilterGeom;
+    }
+}
+
 /************************************************************************/
 /*                             Updated()                                */
 /************************************************************************/
@@ -105,6 +158,25 @@ OGRErr OGRXLSXLayer::SyncToDisk()
 OGRFeature* OGRXLSXLayer::GetNextFeature()
 {
     Init();
+    if( bStreaming )
+    {
+        while( true )
+        {
+            OGRFeature* poFeature = poDS->GetNextStreamedFeature(this);
+            if( poFeature == nullptr )
+                return nullptr;
+
+            if( (m_poFilterGeom == nullptr ||
+                 FilterGeometry(poFeature->GetGeometryRef())) &&
+                (m_poAttrQuery == nullptr ||
+                 m_poAttrQuery->Evaluate(poFeature)) )
+            {
+                return poFeature;
+            }
+            delete poFeature;
+        }
+    }
+
     OGRFeature* poFeature = OGRMemLayer::GetNextFeature();
     if (poFeature)
         poFeature->SetFID(poFeature->GetFID() +
@@ -112,6 +184,65 @@ OGRFeature* OGRXLSXLayer::GetNextFeature()
     return poFeature;
 }
 
+/************************************************************************/
+/*                           ResetReading()                             */
+/************************************************************************/
+
+void OGRXLSXLayer::ResetReading()
+{
+    Init();
+    if( bStreaming )
+    {
+        nNextStreamedFeature = 0;
+        poDS->StopStreaming(this);
+    }
+    OGRMemLayer::ResetReading();
+}
+
+/************************************************************************/
+/*                          SetNextByIndex()                            */
+/************************************************************************/
+
+OGRErr OGRXLSXLayer::SetNextByIndex( GIntBig nIndex )
+{
+    Init();
+    if( bStreaming )
+        return OGRLayer::SetNextByIndex(nIndex);
+    return OGRMemLayer::SetNextByIndex(nIndex);
+}
+
+/************************************************************************/
+/*                          GetFeatureCount()                           */
+/************************************************************************/
+
+GIntBig OGRXLSXLayer::GetFeatureCount( int bForce )
+{
+    Init();
+    if( bStreaming )
+    {
+        if( m_poFilterGeom == nullptr && m_poAttrQuery == nullptr )
+            return nStreamingFeatureCount;
+        return OGRLayer::GetFeatureCount(bForce);
+    }
+    return OGRMemLayer::GetFeatureCount(bForce);
+}
+
+/************************************************************************/
+/*                          TestCapability()                            */
+/************************************************************************/
+
+int OGRXLSXLayer::TestCapability( const char * pszCap )
+{
+    Init();
+    if( bStreaming && EQUAL(pszCap, OLCFastSetNextByIndex) )
+        return FALSE;
+    return OGRMemLayer::TestCapability(pszCap);
+}
+
+/************************************************************************/
+/*                           CreateField()                              */
+/************************************************************************/
+
 OGRErr OGRXLSXLayer::CreateField( OGRFieldDefn *poField, int bApproxOK )
 {
     Init();
@@ -131,7 +262,7 @@ OGRErr OGRXLSXLayer::CreateField( OGRFieldDefn *poField, int bApproxOK )
 
 OGRFeature* OGRXLSXLayer::GetFeature( GIntBig nFeatureId )
 {
-    Init();
+    Materialize();
     OGRFeature* poFeature =
         OGRMemLayer::GetFeature(nFeatureId -
                                 (1 + static_cast<int>(bHasHeaderLine)));
@@ -212,6 +343,12 @@ OGRXLSXDataSource::OGRXLSXDataSource() :
     nCurLine(0),
     nCurCol(0),
     poCurLayer(nullptr),
+    eBuildMode(BUILD_IN_MEMORY),
+    poStreamingLayer(nullptr),
+    fpStreaming(nullptr),
+    bStreamingEOF(false),
+    nStreamedFeatures(0),
+    nStreamedFeatureIdx(0),
     nStackDepth(0),
     nDepth(0),
     bInCellXFS(false)
@@ -229,6 +366,8 @@ OGRXLSXDataSource::~OGRXLSXDataSource()
 {
     OGRXLSXDataSource::FlushCache();
 
+    StopStreaming();
+
     CPLFree( pszName );
 
     for( int i = 0; i < nLayers; i++ )
@@ -697,7 +836,11 @@ void OGRXLSXDataSource::endElementTable(CPL_UNUSED const char *pszNameIn)
     {
         CPLAssert(strcmp(pszNameIn, "sheetData") == 0);
 
-        if (nCurLine == 0 ||
+        if (eBuildMode == BUILD_STREAMING)
+        {
+            /* The layer definition is already established */
+        }
+        else if (nCurLine == 0 ||
             (nCurLine == 1 && apoFirstLineValues.empty()))
         {
             /* We could remove empty sheet, but too late now */
@@ -726,8 +869,7 @@ void OGRXLSXDataSource::endElementTable(CPL_UNUSED const char *pszNameIn)
                 SetField(poFeature, static_cast<int>(i), apoFirstLineValues[i].c_str(),
                          apoFirstLineTypes[i].c_str());
             }
-            CPL_IGNORE_RET_VAL(poCurLayer->CreateFeature(poFeature));
-            delete poFeature;
+            AddFeature(poFeature);
         }
 
         if (poCurLayer)
@@ -825,6 +967,32 @@ void OGRXLSXDataSource::endElementRow(CPL_UNUSED const char *pszNameIn)
     {
         CPLAssert(strcmp(pszNameIn, "row") == 0);
 
+        /* When streaming, the layer definition is already established, */
+        /* so just emit the row, unless it is the header line. */
+        if (eBuildMode == BUILD_STREAMING)
+        {
+            if (nCurLine > 0 || !poCurLayer->GetHasHeaderLine())
+            {
+                OGRFeature* poFeature =
+                    new OGRFeature(poCurLayer->GetLayerDefn());
+                const size_t nFieldCount =
+                    static_cast<size_t>(poFeature->GetFieldCount());
+                for( size_t i = 0;
+                     i < apoCurLineValues.size() && i < nFieldCount; i++ )
+                {
+                    if (!apoCurLineValues[i].empty())
+                    {
+                        SetField(poFeature, static_cast<int>(i),
+                                 apoCurLineValues[i].c_str(),
+                                 apoCurLineTypes[i].c_str());
+                    }
+                }
+                AddFeature(poFeature);
+            }
+            nCurLine++;
+            return;
+        }
+
         /* Backup first line values and types in special arrays */
         if (nCurLine == 0)
         {
@@ -903,8 +1071,7 @@ void OGRXLSXDataSource::endElementRow(CPL_UNUSED const char *pszNameIn)
                     SetField(poFeature, static_cast<int>(i), apoFirstLineValues[i].c_str(),
                              apoFirstLineTypes[i].c_str());
                 }
-                CPL_IGNORE_RET_VAL(poCurLayer->CreateFeature(poFeature));
-                delete poFeature;
+                AddFeature(poFeature);
             }
         }
 
@@ -1019,8 +1186,7 @@ void OGRXLSXDataSource::endElementRow(CPL_UNUSED const char *pszNameIn)
                           apoCurLineTypes[i].c_str());
                 }
             }
-            CPL_IGNORE_RET_VAL(poCurLayer->CreateFeature(poFeature));
-            delete poFeature;
+            AddFeature(poFeature);
        }
 
         nCurLine++;
@@ -1057,8 +1223,17 @@ void OGRXLSXDataSource::endElementCell(CPL_UNUSED const char *pszNameIn)
         if (osValueType == "stringLookup")
         {
             int nIndex = atoi(osValue);
-            if (nIndex >= 0 && nIndex < (int)(apoSharedStrings.size()))
-                osValue = apoSharedStrings[nIndex];
+            if (nIndex >= 0 &&
+                nIndex < static_cast<int>(anSharedStringsOffsets.size()))
+            {
+                const size_t nStart = anSharedStringsOffsets[nIndex];
+                const size_t nEnd =
+                    static_cast<size_t>(nIndex + 1) <
+                                        anSharedStringsOffsets.size() ?
+                        anSharedStringsOffsets[nIndex + 1] :
+                        osSharedStringsArena.size();
+                osValue.assign(osSharedStringsArena, nStart, nEnd - nStart);
+            }
             else
                 CPLDebug("XLSX", "Cannot find string %d", nIndex);
             osValueType = "string";
@@ -1081,31 +1256,48 @@ void OGRXLSXDataSource::dataHandlerTextV(const char *data, int nLen)
 }
 
 /************************************************************************/
-/*                              BuildLayer()                            */
+/*                              AddFeature()                            */
 /************************************************************************/
 
-void OGRXLSXDataSource::BuildLayer( OGRXLSXLayer* poLayer )
+void OGRXLSXDataSource::AddFeature( OGRFeature* poFeature )
 {
-    poCurLayer = poLayer;
-
-    const char* pszSheetFilename = poLayer->GetFilename().c_str();
-    VSILFILE* fp = VSIFOpenL(pszSheetFilename, "rb");
-    if (fp == nullptr)
+    if( eBuildMode == BUILD_SCHEMA_ONLY )
     {
-        CPLDebug("XLSX", "Cannot open file %s for sheet %s",
-                 pszSheetFilename, poLayer->GetName());
-        return;
+        poCurLayer->nStreamingFeatureCount ++;
+        delete poFeature;
     }
+    else if( eBuildMode == BUILD_STREAMING )
+    {
+        if( nStreamedFeatures < poCurLayer->nStreamingFeatureCount )
+        {
+            poFeature->SetFID(nStreamedFeatures + 1 +
+                    static_cast<int>(poCurLayer->GetHasHeaderLine()));
+            nStreamedFeatures ++;
+            apoStreamedFeatures.push_back(poFeature);
+        }
+        else
+        {
+            delete poFeature;
+        }
+    }
+    else
+    {
+        CPL_IGNORE_RET_VAL(poCurLayer->CreateFeature(poFeature));
+        delete poFeature;
+    }
+}
 
-    const bool bUpdatedBackup = bUpdated;
+/************************************************************************/
+/*                          CreateSheetParser()                         */
+/************************************************************************/
 
+void OGRXLSXDataSource::CreateSheetParser()
+{
     oParser = OGRCreateExpatXMLParser();
     XML_SetElementHandler(oParser, OGRXLSX::startElementCbk, OGRXLSX::endElementCbk);
     XML_SetCharacterDataHandler(oParser, OGRXLSX::dataHandlerCbk);
     XML_SetUserData(oParser, this);
 
-    VSIFSeekL( fp, 0, SEEK_SET );
-
     bStopParsing = false;
     nWithoutEventCounter = 0;
     nDataHandlerCounter = 0;
@@ -1113,30 +1305,34 @@ void OGRXLSXDataSource::BuildLayer( OGRXLSXLayer* poLayer )
     nDepth = 0;
     stateStack[0].eVal = STATE_DEFAULT;
     stateStack[0].nBeginDepth = 0;
+}
+
+/************************************************************************/
+/*                           ParseSheetChunk()                          */
+/*                                                                      */
+/*      Returns false once the end of the sheet has been reached or     */
+/*      parsing has failed.                                             */
+/************************************************************************/
 
+bool OGRXLSXDataSource::ParseSheetChunk( VSILFILE* fp,
+                                         const char* pszSheetFilename )
+{
     char aBuf[BUFSIZ];
-    int nDone = 0;
-    do
+    nDataHandlerCounter = 0;
+    unsigned int nLen =
+        (unsigned int)VSIFReadL( aBuf, 1, sizeof(aBuf), fp );
+    const int nDone = VSIFEofL(fp);
+    if (XML_Parse(oParser, aBuf, nLen, nDone) == XML_STATUS_ERROR)
     {
-        nDataHandlerCounter = 0;
-        unsigned int nLen =
-            (unsigned int)VSIFReadL( aBuf, 1, sizeof(aBuf), fp );
-        nDone = VSIFEofL(fp);
-        if (XML_Parse(oParser, aBuf, nLen, nDone) == XML_STATUS_ERROR)
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                     "XML parsing of %s file failed : %s at line %d, column %d",
-                     pszSheetFilename,
-                     XML_ErrorString(XML_GetErrorCode(oParser)),
-                     (int)XML_GetCurrentLineNumber(oParser),
-                     (int)XML_GetCurrentColumnNumber(oParser));
-            bStopParsing = true;
-        }
-        nWithoutEventCounter ++;
-    } while( !nDone && !bStopParsing && nWithoutEventCounter < 10 );
-
-    XML_ParserFree(oParser);
-    oParser = nullptr;
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "XML parsing of %s file failed : %s at line %d, column %d",
+                 pszSheetFilename,
+                 XML_ErrorString(XML_GetErrorCode(oParser)),
+                 (int)XML_GetCurrentLineNumber(oParser),
+                 (int)XML_GetCurrentColumnNumber(oParser));
+        bStopParsing = true;
+    }
+    nWithoutEventCounter ++;
 
     if (nWithoutEventCounter == 10)
     {
@@ -1145,11 +1341,139 @@ void OGRXLSXDataSource::BuildLayer( OGRXLSXLayer* poLayer )
         bStopParsing = true;
     }
 
+    return !nDone && !bStopParsing;
+}
+
+/************************************************************************/
+/*                              BuildLayer()                            */
+/*                                                                      */
+/*      For a streamed layer, only establish the layer definition and   */
+/*      the feature count.                                              */
+/************************************************************************/
+
+void OGRXLSXDataSource::BuildLayer( OGRXLSXLayer* poLayer )
+{
+    /* The parser state is shared by all layers */
+    StopStreaming();
+
+    poCurLayer = poLayer;
+
+    const char* pszSheetFilename = poLayer->GetFilename().c_str();
+    VSILFILE* fp = VSIFOpenL(pszSheetFilename, "rb");
+    if (fp == nullptr)
+    {
+        CPLDebug("XLSX", "Cannot open file %s for sheet %s",
+                 pszSheetFilename, poLayer->GetName());
+        poCurLayer = nullptr;
+        return;
+    }
+
+    const bool bUpdatedBackup = bUpdated;
+
+    eBuildMode = poLayer->bStreaming ? BUILD_SCHEMA_ONLY : BUILD_IN_MEMORY;
+    CreateSheetParser();
+
+    VSIFSeekL( fp, 0, SEEK_SET );
+
+    while( ParseSheetChunk(fp, pszSheetFilename) ) {}
+
+    XML_ParserFree(oParser);
+    oParser = nullptr;
+    eBuildMode = BUILD_IN_MEMORY;
+    poCurLayer = nullptr;
+
     VSIFCloseL(fp);
 
     bUpdated = bUpdatedBackup;
 }
 
+/************************************************************************/
+/*                           StartStreaming()                           */
+/************************************************************************/
+
+bool OGRXLSXDataSource::StartStreaming( OGRXLSXLayer* poLayer )
+{
+    StopStreaming();
+
+    const char* pszSheetFilename = poLayer->GetFilename().c_str();
+    fpStreaming = VSIFOpenL(pszSheetFilename, "rb");
+    if (fpStreaming == nullptr)
+    {
+        CPLDebug("XLSX", "Cannot open file %s for sheet %s",
+                 pszSheetFilename, poLayer->GetName());
+        return false;
+    }
+
+    poStreamingLayer = poLayer;
+    poCurLayer = poLayer;
+    eBuildMode = BUILD_STREAMING;
+    bStreamingEOF = false;
+    nStreamedFeatures = 0;
+    CreateSheetParser();
+
+    /* If the stream of this layer has been interrupted by the reading */
+    /* of another layer, skip the features already returned. */
+    const GIntBig nToSkip = poLayer->nNextStreamedFeature;
+    poLayer->nNextStreamedFeature = 0;
+    for( GIntBig i = 0; i < nToSkip; i++ )
+    {
+        OGRFeature* poFeature = GetNextStreamedFeature(poLayer);
+        if( poFeature == nullptr )
+            break;
+        delete poFeature;
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                           StopStreaming()                            */
+/************************************************************************/
+
+void OGRXLSXDataSource::StopStreaming( OGRXLSXLayer* poLayer )
+{
+    if( poStreamingLayer == nullptr ||
+        (poLayer != nullptr && poLayer != poStreamingLayer) )
+        return;
+
+    XML_ParserFree(oParser);
+    oParser = nullptr;
+    VSIFCloseL(fpStreaming);
+    fpStreaming = nullptr;
+
+    for( size_t i = nStreamedFeatureIdx; i < apoStreamedFeatures.size(); i++ )
+        delete apoStreamedFeatures[i];
+    apoStreamedFeatures.clear();
+    nStreamedFeatureIdx = 0;
+
+    poStreamingLayer = nullptr;
+    poCurLayer = nullptr;
+    eBuildMode = BUILD_IN_MEMORY;
+}
+
+/************************************************************************/
+/*                       GetNextStreamedFeature()                       */
+/************************************************************************/
+
+OGRFeature* OGRXLSXDataSource::GetNextStreamedFeature( OGRXLSXLayer* poLayer )
+{
+    if( poStreamingLayer != poLayer && !StartStreaming(poLayer) )
+        return nullptr;
+
+    while( nStreamedFeatureIdx == apoStreamedFeatures.size() )
+    {
+        apoStreamedFeatures.clear();
+        nStreamedFeatureIdx = 0;
+        if( bStreamingEOF )
+            return nullptr;
+        if( !ParseSheetChunk(fpStreaming, poLayer->GetFilename()) )
+            bStreamingEOF = true;
+    }
+
+    poLayer->nNextStreamedFeature ++;
+    return apoStreamedFeatures[nStreamedFeatureIdx++];
+}
+
 /************************************************************************/
 /*                          startElementSSCbk()                         */
 /************************************************************************/
@@ -1173,7 +1497,7 @@ void OGRXLSXDataSource::startElementSSCbk(const char *pszNameIn,
             if (strcmp(pszNameIn,"t") == 0)
             {
                 PushState(STATE_T);
-                osCurrentString = "";
+                anSharedStringsOffsets.push_back(osSharedStringsArena.size());
             }
             break;
         }
@@ -1202,14 +1526,6 @@ void OGRXLSXDataSource::endElementSSCbk(CPL_UNUSED const char *pszNameIn)
     switch(stateStack[nStackDepth].eVal)
     {
         case STATE_DEFAULT: break;
-        case STATE_T:
-        {
-            if (stateStack[nStackDepth].nBeginDepth == nDepth)
-            {
-                apoSharedStrings.push_back(osCurrentString);
-            }
-            break;
-        }
         default:            break;
     }
 
@@ -1245,7 +1561,7 @@ void OGRXLSXDataSource::dataHandlerSSCbk(const char *data, int nLen)
     switch(stateStack[nStackDepth].eVal)
     {
         case STATE_DEFAULT: break;
-        case STATE_T:       osCurrentString.append(data, nLen); break;
+        case STATE_T:       osSharedStringsArena.append(data, nLen); break;
         default:            break;
     }
 }
@@ -114,6 +114,11 @@ struct OGRSpatialReference::Private
     bool                m_bMorphToESRI = false;
     bool                m_bHasCenterLong = false;
 
+    // Key identifying m_pj_crs when it has been built from a definition
+    // that is cached in the per-thread OSRProjTLSCache, so that IsSame()
+    // results between such objects can be memoized. Empty otherwise.
+    CPLString           m_osCacheKey{};
+
     std::shared_ptr<Listener> m_poListener{};
 
     std::mutex          m_mutex{};
@@ -213,6 +218,7 @@ void OGRSpatialReference::Private::clear()
 
     m_bMorphToESRI = false;
     m_bHasCenterLong = false;
+    m_osCacheKey.clear();
 }
 
 void OGRSpatialReference::Private::setRoot(OGR_SRSNode* poRoot)
@@ -235,6 +241,7 @@ void OGRSpatialReference::Private::setPjCRS(PJ* pj_crsIn,
     {
         m_pjType = proj_get_type(m_pj_crs);
     }
+    m_osCacheKey.clear();
     if( m_pj_crs_backup )
     {
         m_pj_crs_modified_during_demote = true;
@@ -815,8 +822,11 @@ OGRSpatialReference::operator=(const OGRSpatialReference &oSource)
 
         oSource.d->refreshProjObj();
         if( oSource.d->m_pj_crs )
+        {
             d->setPjCRS(proj_clone(
                 d->getPROJContext(), oSource.d->m_pj_crs));
+            d->m_osCacheKey = oSource.d->m_osCacheKey;
+        }
         if( oSource.d->m_axisMappingStrategy == OAMS_TRADITIONAL_GIS_ORDER )
             SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
         else if ( oSource.d->m_axisMappingStrategy == OAMS_CUSTOM )
@@ -1191,7 +1201,10 @@ OGRSpatialReference *OGRSpatialReference::Clone() const
 
     d->refreshProjObj();
     if( d->m_pj_crs != nullptr )
+    {
         poNewRef->d->setPjCRS(proj_clone(d->getPROJContext(), d->m_pj_crs));
+        poNewRef->d->m_osCacheKey = d->m_osCacheKey;
+    }
     if( d->m_bHasCenterLong && d->m_poRoot )
     {
         poNewRef->d->setRoot(d->m_poRoot->Clone());
@@ -1606,6 +1619,23 @@ OGRErr OGRSpatialReference::importFromWkt( const char ** ppszInput )
 
     Clear();
 
+    // Definitions with CENTER_LONG also need the node tree, so they are
+    // not cached.
+    auto tlsCache = strstr(*ppszInput, "CENTER_LONG") == nullptr ?
+                                        OSRGetProjTLSCache() : nullptr;
+    if( tlsCache && **ppszInput )
+    {
+        auto cachedObj = tlsCache->GetPJForWKT(*ppszInput);
+        if( cachedObj )
+        {
+            d->setPjCRS(cachedObj);
+            d->m_osCacheKey = "WKT:";
+            d->m_osCacheKey += *ppszInput;
+            *ppszInput += strlen(*ppszInput);
+            return OGRERR_NONE;
+        }
+    }
+
     if( **ppszInput )
     {
         const char* const options[] = { "STRICT=NO", nullptr };
@@ -1655,6 +1685,16 @@ OGRErr OGRSpatialReference::importFromWkt( const char ** ppszInput )
         d->m_bHasCenterLong = true;
     }
 
+    // Only cache clean imports, as Validate() reports the import warnings
+    // and errors.
+    if( tlsCache && d->m_wktImportWarnings.empty() &&
+        d->m_wktImportErrors.empty() )
+    {
+        tlsCache->CachePJForWKT(*ppszInput, d->m_pj_crs);
+        d->m_osCacheKey = "WKT:";
+        d->m_osCacheKey += *ppszInput;
+    }
+
     // TODO? we don't really update correctly since we assume that the
     // passed string is only WKT.
     *ppszInput += strlen(*ppszInput);
@@ -3204,6 +3244,10 @@ OGRErr OSRCopyGeogCSFrom( OGRSpatialReferenceH hSRS,
  * possible applications should call the specific method appropriate if the
  * input is known to be in a particular format.
  *
+ * Starting with GDAL 3.1, the CRS built from definitions that do not come
+ * from a file or a URL is cached per thread, keyed by the definition, so that
+ * repeated calls with the same string do not query the PROJ database again.
+ *
  * This method does the same thing as the OSRSetFromUserInput() function.
  *
  * @param pszDefinition text definition to try to deduce SRS from.
@@ -3215,6 +3259,54 @@ OGRErr OSRCopyGeogCSFrom( OGRSpatialReferenceH hSRS,
 
 OGRErr OGRSpatialReference::SetFromUserInput( const char * pszDefinition )
 
+{
+    // The options read by importFromEPSG() are part of the key.
+    CPLString osCacheKey;
+    osCacheKey.Printf("USER:%d:%d:",
+        CPLTestBool(CPLGetConfigOption("OSR_USE_NON_DEPRECATED", "YES")) ? 1 : 0,
+        CPLTestBool(CPLGetConfigOption(
+            "OSR_ADD_TOWGS84_ON_IMPORT_FROM_EPSG", "NO")) ? 1 : 0);
+    osCacheKey += pszDefinition;
+
+    auto tlsCache = OSRGetProjTLSCache();
+    if( tlsCache && IsEmpty() )
+    {
+        auto cachedObj = tlsCache->GetPJForUserInput(osCacheKey);
+        if( cachedObj )
+        {
+            d->setPjCRS(cachedObj);
+            d->m_osCacheKey = osCacheKey;
+            return OGRERR_NONE;
+        }
+    }
+
+    bool bCacheable = true;
+    const OGRErr eErr = SetFromUserInputInternal(pszDefinition, &bCacheable);
+    if( eErr == OGRERR_NONE && bCacheable && tlsCache )
+    {
+        d->refreshProjObj();
+        if( d->m_pj_crs && !d->m_bHasCenterLong )
+        {
+            tlsCache->CachePJForUserInput(osCacheKey, d->m_pj_crs);
+            d->m_osCacheKey = osCacheKey;
+        }
+    }
+    return eErr;
+}
+
+/************************************************************************/
+/*                      SetFromUserInputInternal()                      */
+/************************************************************************/
+
+/*! @cond Doxygen_Suppress */
+
+// *pbCacheable is set to false when the result does not only depend on
+// pszDefinition (files, URLs, WKT which has its own cache, or definitions
+// merged into the current content of the object).
+OGRErr OGRSpatialReference::SetFromUserInputInternal(
+                                            const char * pszDefinition,
+                                            bool* pbCacheable )
+
 {
     if( STARTS_WITH_CI(pszDefinition, "ESRI::") )
     {
@@ -3236,6 +3328,7 @@ OGRErr OGRSpatialReference::SetFromUserInput( const char * pszDefinition )
     {
         if( STARTS_WITH_CI(pszDefinition, keyword) )
         {
+            *pbCacheable = false;
             return importFromWkt( pszDefinition );
         }
     }
@@ -3301,14 +3394,21 @@ OGRErr OGRSpatialReference::SetFromUserInput( const char * pszDefinition )
 
     // WMS/WCS OGC codes like OGC:CRS84.
     if( STARTS_WITH_CI(pszDefinition, "OGC:") )
+    {
+        *pbCacheable = IsEmpty();
         return SetWellKnownGeogCS( pszDefinition+4 );
+    }
 
     if( STARTS_WITH_CI(pszDefinition, "CRS:") )
+    {
+        *pbCacheable = IsEmpty();
         return SetWellKnownGeogCS( pszDefinition );
+    }
 
     if( STARTS_WITH_CI(pszDefinition, "DICT:")
         && strstr(pszDefinition, ",") )
     {
+        *pbCacheable = false;
         char *pszFile = CPLStrdup(pszDefinition+5);
         char *pszCode = strstr(pszFile, ",") + 1;
 
@@ -3335,6 +3435,7 @@ OGRErr OGRSpatialReference::SetFromUserInput( const char * pszDefinition )
 
     if( STARTS_WITH_CI(pszDefinition, "http://") )
     {
+        *pbCacheable = false;
         return importFromUrl (pszDefinition);
     }
 
@@ -3377,6 +3478,7 @@ OGRErr OGRSpatialReference::SetFromUserInput( const char * pszDefinition )
 /* -------------------------------------------------------------------- */
 /*      Try to open it as a file.                                       */
 /* -------------------------------------------------------------------- */
+    *pbCacheable = false;
     CPLConfigOptionSetter oSetter("CPL_ALLOW_VSISTDIN", "NO", true);
     VSILFILE * const fp = VSIFOpenL( pszDefinition, "rt" );
     if( fp == nullptr )
@@ -3427,6 +3529,8 @@ OGRErr OGRSpatialReference::SetFromUserInput( const char * pszDefinition )
     return err;
 }
 
+/*! @endcond */
+
 /************************************************************************/
 /*                        OSRSetFromUserInput()                         */
 /************************************************************************/
@@ -8175,6 +8279,10 @@ int OGRSpatialReference::IsSame( const OGRSpatialReference * poOtherSRS ) const
  *     Defaults to EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS.</li>
  * </ul>
  *
+ * Starting with GDAL 3.1, the result of the comparison between two objects
+ * built by importFromEPSG(), importFromWkt() or SetFromUserInput() from a
+ * cached definition, and not modified since, is memoized per thread.
+ *
  * @return TRUE if equivalent or FALSE otherwise.
  */
 
@@ -8193,6 +8301,29 @@ int OGRSpatialReference::IsSame( const OGRSpatialReference * poOtherSRS,
             return false;
     }
 
+    const char* pszCriterion = CSLFetchNameValueDef(
+        papszOptions, "CRITERION", "EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS");
+
+    // Objects built from cached definitions are identified by their cache
+    // key, so the result of the comparison between them can be memoized.
+    OSRProjTLSCache* tlsCache = nullptr;
+    CPLString osIsSameKey;
+    if( !d->m_osCacheKey.empty() && !poOtherSRS->d->m_osCacheKey.empty() )
+    {
+        tlsCache = OSRGetProjTLSCache();
+        if( tlsCache )
+        {
+            osIsSameKey = pszCriterion;
+            osIsSameKey += '\n';
+            osIsSameKey += d->m_osCacheKey;
+            osIsSameKey += '\n';
+            osIsSameKey += poOtherSRS->d->m_osCacheKey;
+            bool bIsSame = false;
+            if( tlsCache->GetIsSame(osIsSameKey, bIsSame) )
+                return bIsSame;
+        }
+    }
+
     bool reboundSelf = false;
     bool reboundOther = false;
     if( d->m_pjType == PJ_TYPE_BOUND_CRS &&
@@ -8210,8 +8341,6 @@ int OGRSpatialReference::IsSame( const OGRSpatialReference * poOtherSRS,
 
     PJ_COMPARISON_CRITERION criterion =
         PJ_COMP_EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS;
-    const char* pszCriterion = CSLFetchNameValueDef(
-        papszOptions, "CRITERION", "EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS");
     if( EQUAL(pszCriterion, "STRICT") )
         criterion = PJ_COMP_STRICT;
     else if( EQUAL(pszCriterion, "EQUIVALENT") )
@@ -8228,6 +8357,9 @@ int OGRSpatialReference::IsSame( const OGRSpatialReference * poOtherSRS,
     if( reboundOther )
         poOtherSRS->d->undoDemoteFromBoundCRS();
 
+    if( tlsCache )
+        tlsCache->CacheIsSame(osIsSameKey, ret != FALSE);
+
     return ret;
 }
 
@@ -8945,6 +9077,7 @@ void OSRCleanup( void )
 {
     CSVDeaccess( nullptr );
     CleanupSRSWGS84Mutex();
+    OSRCTCleanCache();
     OSRCleanupTLSContext();
 }
 
@@ -10058,6 +10191,9 @@ OGRErr OGRSpatialReference::importFromEPSGA( int nCode )
                 CPLGetConfigOption("OSR_USE_NON_DEPRECATED", "YES"));
     const bool bAddTOWGS84 = CPLTestBool(
             CPLGetConfigOption("OSR_ADD_TOWGS84_ON_IMPORT_FROM_EPSG", "NO"));
+    CPLString osCacheKey;
+    osCacheKey.Printf("EPSG:%d:%d:%d", nCode,
+                      bUseNonDeprecated ? 1 : 0, bAddTOWGS84 ? 1 : 0);
     auto tlsCache = OSRGetProjTLSCache();
     if( tlsCache )
     {
@@ -10065,6 +10201,7 @@ OGRErr OGRSpatialReference::importFromEPSGA( int nCode )
         if( cachedObj )
         {
             d->setPjCRS(cachedObj);
+            d->m_osCacheKey = osCacheKey;
             return OGRERR_NONE;
         }
     }
@@ -10115,6 +10252,7 @@ OGRErr OGRSpatialReference::importFromEPSGA( int nCode )
     if( tlsCache )
     {
         tlsCache->CachePJForEPSGCode(nCode, bUseNonDeprecated, bAddTOWGS84, obj);
+        d->m_osCacheKey = osCacheKey;
     }
 
     return OGRERR_NONE;
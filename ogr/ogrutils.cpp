@@ -64,13 +64,43 @@ inline bool CPLIsDoubleAnInt(double d)
     return d == static_cast<double>(static_cast<int>(d));
 }
 
+/************************************************************************/
+/*                            OGRFormatInt()                            */
+/************************************************************************/
+
+// Same as snprintf(pszBuffer, nBufferLen, "%d", nVal) with a large enough
+// buffer (12 bytes), but much faster. Returns the length of the string.
+static int OGRFormatInt( char *pszBuffer, int nVal )
+{
+    char szTmp[12];
+    int nLen = 0;
+    unsigned nAbs = nVal < 0 ? 0U - static_cast<unsigned>(nVal) :
+                               static_cast<unsigned>(nVal);
+    do
+    {
+        szTmp[nLen++] = static_cast<char>('0' + nAbs % 10);
+        nAbs /= 10;
+    } while( nAbs != 0 );
+
+    int iOut = 0;
+    if( nVal < 0 )
+        pszBuffer[iOut++] = '-';
+    while( nLen > 0 )
+        pszBuffer[iOut++] = szTmp[--nLen];
+    pszBuffer[iOut] = '\0';
+    return iOut;
+}
+
 /************************************************************************/
 /*                        OGRFormatDouble()                             */
 /************************************************************************/
 
-void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
-                      char chDecimalSep, int nPrecision,
-                      char chConversionSpecifier )
+// nRound is the value of OGR_WKT_ROUND, or -1 to fetch it when needed.
+static void OGRFormatDoubleInternal( char *pszBuffer, int nBufferLen,
+                                     double dfVal, char chDecimalSep,
+                                     int nPrecision,
+                                     char chConversionSpecifier,
+                                     int nRound )
 {
     // So to have identical cross platform representation.
     if( CPLIsInf(dfVal) )
@@ -87,11 +117,8 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
         return;
     }
 
-    char szFormat[16] = {};
-    snprintf(szFormat, sizeof(szFormat),
-             "%%.%d%c", nPrecision, chConversionSpecifier);
-
-    int ret = CPLsnprintf(pszBuffer, nBufferLen, szFormat, dfVal);
+    int ret = CPLFormatDouble(pszBuffer, nBufferLen, dfVal,
+                              chConversionSpecifier, nPrecision);
     // Windows CRT does not conform with C99 and returns -1 when buffer is
     // truncated.
     if( ret >= nBufferLen || ret == -1 )
@@ -103,7 +130,7 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
     if( chConversionSpecifier == 'g' && strchr(pszBuffer, 'e') )
         return;
 
-    const bool bRound =
+    const bool bRound = nRound >= 0 ? nRound != 0 :
         CPLTestBool(CPLGetConfigOption("OGR_WKT_ROUND", "TRUE"));
 
     int nTruncations = 0;
@@ -181,9 +208,8 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
             {
                 --nPrecision;
                 ++nTruncations;
-                snprintf(szFormat, sizeof(szFormat),
-                         "%%.%d%c", nPrecision, chConversionSpecifier);
-                CPLsnprintf(pszBuffer, nBufferLen, szFormat, dfVal);
+                CPLFormatDouble(pszBuffer, nBufferLen, dfVal,
+                                chConversionSpecifier, nPrecision);
                 if( chConversionSpecifier == 'g' && strchr(pszBuffer, 'e') )
                     return;
                 continue;
@@ -201,9 +227,8 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
             {
                 --nPrecision;
                 ++nTruncations;
-                snprintf(szFormat, sizeof(szFormat),
-                         "%%.%d%c", nPrecision, chConversionSpecifier);
-                CPLsnprintf(pszBuffer, nBufferLen, szFormat, dfVal);
+                CPLFormatDouble(pszBuffer, nBufferLen, dfVal,
+                                chConversionSpecifier, nPrecision);
                 if( chConversionSpecifier == 'g' && strchr(pszBuffer, 'e') )
                     return;
                 continue;
@@ -214,109 +239,77 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
     }
 }
 
+void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
+                      char chDecimalSep, int nPrecision,
+                      char chConversionSpecifier )
+{
+    OGRFormatDoubleInternal( pszBuffer, nBufferLen, dfVal, chDecimalSep,
+                             nPrecision, chConversionSpecifier, -1 );
+}
+
 /************************************************************************/
-/*                        OGRMakeWktCoordinate()                        */
-/*                                                                      */
-/*      Format a well known text coordinate, trying to keep the         */
-/*      ASCII representation compact, but accurate.  These rules        */
-/*      will have to tighten up in the future.                          */
-/*                                                                      */
-/*      Currently a new point should require no more than 64            */
-/*      characters barring the X or Y value being extremely large.      */
+/*                         OGRWktRoundEnabled()                         */
 /************************************************************************/
 
-void OGRMakeWktCoordinate( char *pszTarget, double x, double y, double z,
-                           int nDimension )
+/*! @cond Doxygen_Suppress */
+bool OGRWktRoundEnabled()
+{
+    return CPLTestBool(CPLGetConfigOption("OGR_WKT_ROUND", "TRUE"));
+}
+/*! @endcond */
+
+/************************************************************************/
+/*                          OGRGetWktPrecision()                        */
+/************************************************************************/
 
+static int OGRGetWktPrecision()
 {
-    const size_t bufSize = 75;
-    // Assumed max length of the target buffer.
-    const size_t maxTargetSize = 75;
-    const char chDecimalSep = '.';
     static int nPrecision = -1;
     if( nPrecision < 0 )
         nPrecision = atoi(CPLGetConfigOption("OGR_WKT_PRECISION", "15"));
+    return nPrecision;
+}
 
-    char szX[bufSize] = {};
-    char szY[bufSize] = {};
-    char szZ[bufSize] = {};
-
-    szZ[0] = '\0';
+/************************************************************************/
+/*                          OGRFormatWktXY()                            */
+/************************************************************************/
 
-    size_t nLenX = 0;
-    size_t nLenY = 0;
+static const size_t WKT_VALUE_BUF_SIZE = 75;
 
-    if( CPLIsDoubleAnInt(x) && CPLIsDoubleAnInt(y) )
-    {
-        snprintf( szX, bufSize, "%d", static_cast<int>(x) );
-        snprintf( szY, bufSize, "%d", static_cast<int>(y) );
-    }
-    else
+// Formats a non-integral X or Y value into a buffer of WKT_VALUE_BUF_SIZE
+// bytes, and returns its length.
+static size_t OGRFormatWktXY( char *pszBuffer, double dfVal, int nRound )
+{
+    OGRFormatDoubleInternal( pszBuffer, static_cast<int>(WKT_VALUE_BUF_SIZE),
+                             dfVal, '.', OGRGetWktPrecision(),
+                             fabs(dfVal) < 1 ? 'f' : 'g', nRound );
+    size_t nLen = strlen(pszBuffer);
+    if( CPLIsFinite(dfVal) && strchr(pszBuffer, '.') == nullptr &&
+        strchr(pszBuffer, 'e') == nullptr && nLen < WKT_VALUE_BUF_SIZE - 2 )
     {
-        OGRFormatDouble( szX, bufSize, x, chDecimalSep, nPrecision,
-                         fabs(x) < 1 ? 'f' : 'g' );
-        if( CPLIsFinite(x) && strchr(szX, '.') == nullptr &&
-            strchr(szX, 'e') == nullptr && strlen(szX) < bufSize - 2 )
-        {
-            strcat(szX, ".0");
-        }
-        OGRFormatDouble( szY, bufSize, y, chDecimalSep, nPrecision,
-                         fabs(y) < 1 ? 'f' : 'g' );
-        if( CPLIsFinite(y) && strchr(szY, '.') == nullptr &&
-            strchr(szY, 'e') == nullptr && strlen(szY) < bufSize - 2 )
-        {
-            strcat(szY, ".0");
-        }
+        memcpy(pszBuffer + nLen, ".0", 3);
+        nLen += 2;
     }
+    return nLen;
+}
 
-    nLenX = strlen(szX);
-    nLenY = strlen(szY);
-
-    if( nDimension == 3 )
-    {
-        if( CPLIsDoubleAnInt(z) )
-        {
-            snprintf( szZ, bufSize, "%d", static_cast<int>(z) );
-        }
-        else
-        {
-            OGRFormatDouble( szZ, bufSize, z, chDecimalSep, nPrecision, 'g' );
-        }
-    }
+/************************************************************************/
+/*                        OGRFormatWktOrdinate()                        */
+/************************************************************************/
 
-    if( nLenX + 1 + nLenY + ((nDimension == 3) ? (1 + strlen(szZ)) : 0) >=
-        maxTargetSize )
-    {
-#ifdef DEBUG
-        CPLDebug( "OGR",
-                  "Yow!  Got this big result in OGRMakeWktCoordinate(): "
-                  "%s %s %s",
-                  szX, szY, szZ );
-#endif
-        if( nDimension == 3 )
-            strcpy( pszTarget, "0 0 0");
-        else
-            strcpy( pszTarget, "0 0");
-    }
-    else
-    {
-        memcpy( pszTarget, szX, nLenX );
-        pszTarget[nLenX] = ' ';
-        memcpy( pszTarget + nLenX + 1, szY, nLenY );
-        if( nDimension == 3 )
-        {
-            pszTarget[nLenX + 1 + nLenY] = ' ';
-            strcpy( pszTarget + nLenX + 1 + nLenY + 1, szZ );
-        }
-        else
-        {
-            pszTarget[nLenX + 1 + nLenY] = '\0';
-        }
-    }
+// Formats a Z or M value into a buffer of WKT_VALUE_BUF_SIZE bytes, and
+// returns its length.
+static size_t OGRFormatWktOrdinate( char *pszBuffer, double dfVal, int nRound )
+{
+    if( CPLIsDoubleAnInt(dfVal) )
+        return OGRFormatInt(pszBuffer, static_cast<int>(dfVal));
+    OGRFormatDoubleInternal( pszBuffer, static_cast<int>(WKT_VALUE_BUF_SIZE),
+                             dfVal, '.', OGRGetWktPrecision(), 'g', nRound );
+    return strlen(pszBuffer);
 }
 
 /************************************************************************/
-/*                        OGRMakeWktCoordinateM()                       */
+/*                    OGRMakeWktCoordinateMCommon()                     */
 /*                                                                      */
 /*      Format a well known text coordinate, trying to keep the         */
 /*      ASCII representation compact, but accurate.  These rules        */
@@ -324,81 +317,54 @@ void OGRMakeWktCoordinate( char *pszTarget, double x, double y, double z,
 /*                                                                      */
 /*      Currently a new point should require no more than 64            */
 /*      characters barring the X or Y value being extremely large.      */
+/*      Returns the length of the string written in pszTarget.          */
 /************************************************************************/
 
-void OGRMakeWktCoordinateM( char *pszTarget,
-                            double x, double y, double z, double m,
-                            OGRBoolean hasZ, OGRBoolean hasM )
+static size_t OGRMakeWktCoordinateMCommon( char *pszTarget,
+                                           double x, double y,
+                                           double z, double m,
+                                           bool hasZ, bool hasM,
+                                           int nRound )
 
 {
-    const size_t bufSize = 75;
     // Assumed max length of the target buffer.
     const size_t maxTargetSize = 75;
-    const char chDecimalSep = '.';
-    static int nPrecision = -1;
-    if( nPrecision < 0 )
-        nPrecision = atoi(CPLGetConfigOption("OGR_WKT_PRECISION", "15"));
 
-    char szX[bufSize] = {};
-    char szY[bufSize] = {};
-    char szZ[bufSize] = {};
-    char szM[bufSize] = {};
+    char szX[WKT_VALUE_BUF_SIZE];
+    char szY[WKT_VALUE_BUF_SIZE];
+    char szZ[WKT_VALUE_BUF_SIZE];
+    char szM[WKT_VALUE_BUF_SIZE];
+    szZ[0] = '\0';
+    szM[0] = '\0';
 
-    size_t nLen = 0;
     size_t nLenX = 0;
     size_t nLenY = 0;
+    size_t nLenZ = 0;
+    size_t nLenM = 0;
 
     if( CPLIsDoubleAnInt(x) && CPLIsDoubleAnInt(y) )
     {
-        snprintf( szX, bufSize, "%d", static_cast<int>(x) );
-        snprintf( szY, bufSize, "%d", static_cast<int>(y) );
+        nLenX = OGRFormatInt( szX, static_cast<int>(x) );
+        nLenY = OGRFormatInt( szY, static_cast<int>(y) );
     }
     else
     {
-        OGRFormatDouble( szX, bufSize, x, chDecimalSep, nPrecision,
-                         fabs(x) < 1 ? 'f' : 'g' );
-        if( CPLIsFinite(x) && strchr(szX, '.') == nullptr &&
-            strchr(szX, 'e') == nullptr && strlen(szX) < bufSize - 2 )
-        {
-            strcat(szX, ".0");
-        }
-        OGRFormatDouble( szY, bufSize, y, chDecimalSep, nPrecision,
-                         fabs(y) < 1 ? 'f' : 'g' );
-        if( CPLIsFinite(y) && strchr(szY, '.') == nullptr &&
-            strchr(szY, 'e') == nullptr && strlen(szY) < bufSize - 2 )
-        {
-            strcat(szY, ".0");
-        }
+        nLenX = OGRFormatWktXY( szX, x, nRound );
+        nLenY = OGRFormatWktXY( szY, y, nRound );
     }
 
-    nLenX = strlen(szX);
-    nLenY = strlen(szY);
-    nLen = nLenX + nLenY + 1;
+    size_t nLen = nLenX + nLenY + 1;
 
     if( hasZ )
     {
-        if( CPLIsDoubleAnInt(z) )
-        {
-            snprintf( szZ, bufSize, "%d", static_cast<int>(z) );
-        }
-        else
-        {
-            OGRFormatDouble( szZ, bufSize, z, chDecimalSep, nPrecision, 'g' );
-        }
-        nLen += strlen(szZ) + 1;
+        nLenZ = OGRFormatWktOrdinate( szZ, z, nRound );
+        nLen += nLenZ + 1;
     }
 
     if( hasM )
     {
-        if( CPLIsDoubleAnInt(m) )
-        {
-            snprintf( szM, bufSize, "%d", static_cast<int>(m) );
-        }
-        else
-        {
-            OGRFormatDouble( szM, bufSize, m, chDecimalSep, nPrecision, 'g' );
-        }
-        nLen += strlen(szM) + 1;
+        nLenM = OGRFormatWktOrdinate( szM, m, nRound );
+        nLen += nLenM + 1;
     }
 
     if( nLen >= maxTargetSize )
@@ -415,33 +381,74 @@ void OGRMakeWktCoordinateM( char *pszTarget,
             strcpy( pszTarget, "0 0 0");
         else
             strcpy( pszTarget, "0 0");
+        return strlen(pszTarget);
     }
-    else
+
+    char *target = pszTarget;
+    memcpy( target, szX, nLenX );
+    target += nLenX;
+    *target = ' ';
+    ++target;
+    memcpy( target, szY, nLenY );
+    target += nLenY;
+    if( hasZ )
     {
-        char *target = pszTarget;
-        strcpy( target, szX );
-        target += nLenX;
         *target = ' ';
         ++target;
-        strcpy( target, szY );
-        target += nLenY;
-        if( hasZ )
-        {
-            *target = ' ';
-            ++target;
-            strcpy( target, szZ );
-            target += strlen(szZ);
-        }
-        if( hasM )
-        {
-            *target = ' ';
-            ++target;
-            strcpy( target, szM );
-            target += strlen(szM);
-        }
-        *target = '\0';
+        memcpy( target, szZ, nLenZ );
+        target += nLenZ;
     }
+    if( hasM )
+    {
+        *target = ' ';
+        ++target;
+        memcpy( target, szM, nLenM );
+        target += nLenM;
+    }
+    *target = '\0';
+    return static_cast<size_t>(target - pszTarget);
+}
+
+/************************************************************************/
+/*                        OGRMakeWktCoordinate()                        */
+/************************************************************************/
+
+void OGRMakeWktCoordinate( char *pszTarget, double x, double y, double z,
+                           int nDimension )
+
+{
+    OGRMakeWktCoordinateMCommon( pszTarget, x, y, z, 0.0,
+                                 nDimension == 3, false, -1 );
+}
+
+/************************************************************************/
+/*                        OGRMakeWktCoordinateM()                       */
+/************************************************************************/
+
+void OGRMakeWktCoordinateM( char *pszTarget,
+                            double x, double y, double z, double m,
+                            OGRBoolean hasZ, OGRBoolean hasM )
+
+{
+    OGRMakeWktCoordinateMCommon( pszTarget, x, y, z, m,
+                                 CPL_TO_BOOL(hasZ), CPL_TO_BOOL(hasM), -1 );
+}
+
+/************************************************************************/
+/*                    OGRMakeWktCoordinateMInternal()                   */
+/************************************************************************/
+
+/*! @cond Doxygen_Suppress */
+size_t OGRMakeWktCoordinateMInternal( char *pszTarget,
+                                      double x, double y, double z, double m,
+                                      OGRBoolean hasZ, OGRBoolean hasM,
+                                      bool bRound )
+{
+    return OGRMakeWktCoordinateMCommon( pszTarget, x, y, z, m,
+                                        CPL_TO_BOOL(hasZ), CPL_TO_BOOL(hasM),
+                                        bRound ? 1 : 0 );
 }
+/*! @endcond */
 
 /************************************************************************/
 /*                          OGRWktReadToken()                           */
@@ -53,8 +53,8 @@ CPL_CVSID("$Id: swq_op_general.cpp ff06f5356dd71dedba7ba941221ae03688982b69 2018
 /*      Does input match pattern?                                       */
 /************************************************************************/
 
-static int swq_test_like( const char *input, const char *pattern,
-                          char chEscape )
+int swq_test_like( const char *input, const char *pattern,
+                   char chEscape )
 
 {
     if( input == nullptr || pattern == nullptr )
@@ -54,6 +54,7 @@
 #include "cpl_conv.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
 #include <climits>
@@ -95,6 +96,9 @@ CPL_CVSID("$Id: cpl_conv.cpp 5318f6d39d2006a10cb6c1410334c56d76a74aa6 2018-06-20
 
 static CPLMutex *hConfigMutex = nullptr;
 static volatile char **g_papszConfigOptions = nullptr;
+// Incremented each time g_papszConfigOptions changes, for the users of
+// CPLCachedConfigOption.
+static std::atomic<unsigned> g_nConfigOptionsGeneration{1};
 
 // Used by CPLOpenShared() and friends.
 static CPLMutex *hSharedFileMutex = nullptr;
@@ -1768,6 +1772,7 @@ void CPLSetConfigOptions(const char* const * papszConfigOptions)
     CSLDestroy(const_cast<char**>(g_papszConfigOptions));
     g_papszConfigOptions = const_cast<volatile char**>(
             CSLDuplicate(const_cast<char**>(papszConfigOptions)));
+    g_nConfigOptionsGeneration++;
 }
 
 /************************************************************************/
@@ -1844,6 +1849,7 @@ CPLSetConfigOption( const char *pszKey, const char *pszValue )
     g_papszConfigOptions = const_cast<volatile char **>(
         CSLSetNameValue(
             const_cast<char **>(g_papszConfigOptions), pszKey, pszValue));
+    g_nConfigOptionsGeneration++;
 }
 
 /************************************************************************/
@@ -1962,6 +1968,92 @@ void CPLSetThreadLocalConfigOptions(const char* const * papszConfigOptions)
                           CPLSetThreadLocalTLSFreeFunc);
 }
 
+/************************************************************************/
+/*                        CPLCachedConfigOption                         */
+/************************************************************************/
+
+/* Returns whether the cached values can be used, after refreshing them if */
+/* the configuration options have changed since they were read. */
+bool CPLCachedConfigOption::UseCache() const
+{
+    char **papszTLConfigOptions = reinterpret_cast<char **>(
+        CPLGetTLS(CTLS_CONFIGOPTIONS));
+    if( papszTLConfigOptions != nullptr && papszTLConfigOptions[0] != nullptr )
+        return false;
+
+    const unsigned nGeneration =
+        g_nConfigOptionsGeneration.load(std::memory_order_acquire);
+    if( m_nGeneration.load(std::memory_order_acquire) != nGeneration )
+    {
+        const char* pszValue = CPLGetConfigOption(m_pszKey, nullptr);
+        m_bDefined.store(pszValue != nullptr, std::memory_order_relaxed);
+        if( pszValue == nullptr )
+            pszValue = m_pszDefault;
+        m_bValue.store(pszValue != nullptr && CPLTestBool(pszValue),
+                       std::memory_order_relaxed);
+        m_nValue.store(pszValue ? CPLAtoGIntBig(pszValue) : 0,
+                       std::memory_order_relaxed);
+        m_dfValue.store(pszValue ? CPLAtof(pszValue) : 0.0,
+                        std::memory_order_relaxed);
+        m_nGeneration.store(nGeneration, std::memory_order_release);
+    }
+    return true;
+}
+
+/** Return whether the option is set, that is if the default value is not
+ * used.
+ */
+bool CPLCachedConfigOption::IsDefined() const
+{
+    if( UseCache() )
+        return m_bDefined.load(std::memory_order_relaxed);
+    return CPLGetConfigOption(m_pszKey, nullptr) != nullptr;
+}
+
+/** Return the value of the option, or its default, evaluated with
+ * CPLTestBool(). False if there is no value at all.
+ */
+bool CPLCachedConfigOption::GetBool() const
+{
+    if( UseCache() )
+        return m_bValue.load(std::memory_order_relaxed);
+    const char* pszValue = CPLGetConfigOption(m_pszKey, m_pszDefault);
+    return pszValue != nullptr && CPLTestBool(pszValue);
+}
+
+/** Return the value of the option, or its default, as an integer, as
+ * atoi() would. 0 if there is no value at all.
+ */
+int CPLCachedConfigOption::GetInt() const
+{
+    const GIntBig nValue = GetBigInt();
+    return static_cast<int>(
+        std::max(static_cast<GIntBig>(INT_MIN),
+                 std::min(static_cast<GIntBig>(INT_MAX), nValue)));
+}
+
+/** Return the value of the option, or its default, as a 64 bit integer,
+ * as CPLAtoGIntBig() would. 0 if there is no value at all.
+ */
+GIntBig CPLCachedConfigOption::GetBigInt() const
+{
+    if( UseCache() )
+        return m_nValue.load(std::memory_order_relaxed);
+    const char* pszValue = CPLGetConfigOption(m_pszKey, m_pszDefault);
+    return pszValue ? CPLAtoGIntBig(pszValue) : 0;
+}
+
+/** Return the value of the option, or its default, as a double, as
+ * CPLAtof() would. 0 if there is no value at all.
+ */
+double CPLCachedConfigOption::GetDouble() const
+{
+    if( UseCache() )
+        return m_dfValue.load(std::memory_order_relaxed);
+    const char* pszValue = CPLGetConfigOption(m_pszKey, m_pszDefault);
+    return pszValue ? CPLAtof(pszValue) : 0.0;
+}
+
 /************************************************************************/
 /*                           CPLFreeConfig()                            */
 /************************************************************************/
@@ -1974,6 +2066,7 @@ void CPL_STDCALL CPLFreeConfig()
 
         CSLDestroy(const_cast<char **>(g_papszConfigOptions));
         g_papszConfigOptions = nullptr;
+        g_nConfigOptionsGeneration++;
 
         int bMemoryError = FALSE;
         char **papszTLConfigOptions = reinterpret_cast<char **>(
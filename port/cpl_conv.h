@@ -100,6 +100,13 @@ double CPL_DLL CPLStrtodDelim(const char *, char **, char);
 float CPL_DLL CPLStrtof(const char *, char **);
 float CPL_DLL CPLStrtofDelim(const char *, char **, char);
 
+/* -------------------------------------------------------------------- */
+/*      Convert floating point number to ASCII string                   */
+/*      (THESE FUNCTIONS ARE NOT LOCALE AWARE!).                        */
+/* -------------------------------------------------------------------- */
+int CPL_DLL CPLFormatDouble(char *, size_t, double, char, int);
+int CPL_DLL CPLFormatDoubleShortest(char *, size_t, double);
+
 /* -------------------------------------------------------------------- */
 /*      Convert number to string.  This function is locale agnostic     */
 /*      (i.e. it will support "," or "." regardless of current locale)  */
@@ -361,9 +368,55 @@ extern "C++"
 {
 
 #ifndef DOXYGEN_SKIP
+#include <atomic>
 #include <type_traits> // for std::is_base_of
 #endif
 
+/** Cached and typed access to a configuration option, for hot paths.
+ *
+ * The value of the option is only looked up again, with
+ * CPLGetConfigOption(), once CPLSetConfigOption() or CPLSetConfigOptions()
+ * has been called, which makes reading it nearly free otherwise.  Options
+ * set with CPLSetThreadLocalConfigOption() are honoured, but the cache is
+ * bypassed in threads that have some.  Changes of the environment made
+ * after the value has been read are not seen until another configuration
+ * option is set.
+ *
+ * Instances are meant to be static objects:
+ * <pre>
+ *     static CPLCachedConfigOption oOpt("GDAL_FOO", "YES");
+ *     if( oOpt.GetBool() ) ...
+ * </pre>
+ *
+ * @since GDAL 3.1
+ */
+class CPL_DLL CPLCachedConfigOption
+{
+    CPL_DISALLOW_COPY_ASSIGN(CPLCachedConfigOption)
+public:
+    /** Constructor. pszKey and pszDefault (which may be NULL) must remain
+     * valid during the lifetime of the object, as string literals do. */
+    CPLCachedConfigOption(const char* pszKey, const char* pszDefault):
+        m_pszKey(pszKey), m_pszDefault(pszDefault) {}
+
+    bool        IsDefined() const;
+    bool        GetBool() const;
+    int         GetInt() const;
+    GIntBig     GetBigInt() const;
+    double      GetDouble() const;
+
+private:
+    const char*                     m_pszKey;
+    const char*                     m_pszDefault;
+    mutable std::atomic<unsigned>   m_nGeneration{0};
+    mutable std::atomic<bool>       m_bDefined{false};
+    mutable std::atomic<bool>       m_bValue{false};
+    mutable std::atomic<GIntBig>    m_nValue{0};
+    mutable std::atomic<double>     m_dfValue{0.0};
+
+    bool        UseCache() const;
+};
+
 namespace cpl
 {
     /** Use cpl::down_cast<Derived*>(pointer_to_base) as equivalent of
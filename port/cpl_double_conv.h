@@ -0,0 +1,52 @@
+/******************************************************************************
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Private declarations of the fast conversions between decimal
+ *           strings and doubles.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef CPL_DOUBLE_CONV_H_INCLUDED
+#define CPL_DOUBLE_CONV_H_INCLUDED
+
+#include "cpl_port.h"
+
+//! @cond Doxygen_Suppress
+
+// Parses a decimal number with chPoint as decimal delimiter, without
+// leading spaces. Returns false if the string is not handled by the fast
+// path (hexadecimal, infinity or NaN, more than 19 significant digits,
+// results outside of the range of normal doubles, ...), in which case
+// strtod() must be used.
+bool CPLStrtodFast( const char* pszStr, char chPoint,
+                    double* pdfValue, const char** ppszEnd );
+
+// Generates the decimal digits of a finite strictly positive value, such
+// that pszDigits * 10^nExp10 converts back to dfValue. The digits are not
+// always the shortest ones. Returns the number of digits, without trailing
+// zeros. pszDigits must have room for 18 characters.
+int CPLDoubleToDigits( double dfValue, char* pszDigits, int* pnExp10 );
+
+//! @endcond
+
+#endif /* ndef CPL_DOUBLE_CONV_H_INCLUDED */
@@ -30,38 +30,86 @@
 #include "cpl_hash_set.h"
 
 #include <cstring>
+#include <utility>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
-#include "cpl_list.h"
 
 CPL_CVSID("$Id: cpl_hash_set.cpp 0846c4df38348216396587449b9cef818856b36c 2018-01-10 16:19:40Z Kurt Schwehr $")
 
+/* -------------------------------------------------------------------- */
+/*      The elements are stored in a single array of slots, with a      */
+/*      power of two size, using open addressing with linear probing    */
+/*      and Robin Hood hashing: an element being inserted takes the     */
+/*      slot of an element closer to its own home slot, which keeps the */
+/*      probe sequences short and allows to stop a lookup early.        */
+/*      Removal shifts the following elements backwards, so there are   */
+/*      no tombstones. Inserting only allocates when the array grows.   */
+/* -------------------------------------------------------------------- */
+
+namespace {
+struct CPLHashSetSlot
+{
+    void   *pData;
+    GUInt32 nHash;  // mixed hash of the element
+    GUInt32 nDist;  // 1 + distance to the home slot, 0 if the slot is empty
+};
+} // namespace
+
 struct _CPLHashSet
 {
     CPLHashSetHashFunc    fnHashFunc;
     CPLHashSetEqualFunc   fnEqualFunc;
     CPLHashSetFreeEltFunc fnFreeEltFunc;
-    CPLList**             tabList;
+    CPLHashSetSlot       *pasSlots;
     int                   nSize;
-    int                   nIndiceAllocatedSize;
-    int                   nAllocatedSize;
-    CPLList              *psRecyclingList;
-    int                   nRecyclingListSize;
+    int                   nShift;  // 32 - log2(number of slots)
+    GUInt32               nAllocatedSize;
     bool                  bRehash;
-#ifdef HASH_DEBUG
-    int                   nCollisions;
-#endif
 };
 
-constexpr int anPrimes[] =
+constexpr int knMinShift = 32 - 6;  // 64 slots
+constexpr int knMaxShift = 32 - 30;
+
+// Grow above 3/4 of occupancy, shrink below 1/8.
+static bool CPLHashSetNeedsGrow( const CPLHashSet* set )
 {
-    53, 97, 193, 389, 769, 1543, 3079, 6151,
-    12289, 24593, 49157, 98317, 196613, 393241,
-    786433, 1572869, 3145739, 6291469, 12582917,
-    25165843, 50331653, 100663319, 201326611,
-    402653189, 805306457, 1610612741
-};
+    return static_cast<GUInt32>(set->nSize) >= set->nAllocatedSize / 4 * 3 &&
+           set->nShift > knMaxShift;
+}
+
+static bool CPLHashSetNeedsShrink( const CPLHashSet* set )
+{
+    return set->nShift < knMinShift &&
+           static_cast<GUInt32>(set->nSize) <= set->nAllocatedSize / 8;
+}
+
+/************************************************************************/
+/*                        CPLHashSetMixHash()                           */
+/************************************************************************/
+
+// The provided hash functions may be weak in their low bits, like
+// CPLHashSetHashPointer() with aligned pointers, so spread them with a
+// multiplicative hash, from which the home slot is taken in the top bits.
+CPL_NOSANITIZE_UNSIGNED_INT_OVERFLOW
+static GUInt32 CPLHashSetMixHash( const CPLHashSet* set, const void* elt )
+{
+    const GUInt64 nHash = static_cast<GUInt64>(set->fnHashFunc(elt)) *
+                                    static_cast<GUInt64>(0x9E3779B97F4A7C15ULL);
+    return static_cast<GUInt32>(nHash >> 32);
+}
+
+/************************************************************************/
+/*                       CPLHashSetAllocSlots()                         */
+/************************************************************************/
+
+static void CPLHashSetAllocSlots( CPLHashSet* set, int nShift )
+{
+    set->nShift = nShift;
+    set->nAllocatedSize = static_cast<GUInt32>(1) << (32 - nShift);
+    set->pasSlots = static_cast<CPLHashSetSlot *>(
+        CPLCalloc(sizeof(CPLHashSetSlot), set->nAllocatedSize));
+}
 
 /************************************************************************/
 /*                          CPLHashSetNew()                             */
@@ -97,15 +145,8 @@ CPLHashSet* CPLHashSetNew( CPLHashSetHashFunc fnHashFunc,
     set->fnEqualFunc = fnEqualFunc ? fnEqualFunc : CPLHashSetEqualPointer;
     set->fnFreeEltFunc = fnFreeEltFunc;
     set->nSize = 0;
-    set->tabList = static_cast<CPLList**>(CPLCalloc(sizeof(CPLList*), 53));
-    set->nIndiceAllocatedSize = 0;
-    set->nAllocatedSize = 53;
-    set->psRecyclingList = nullptr;
-    set->nRecyclingListSize = 0;
+    CPLHashSetAllocSlots(set, knMinShift);
     set->bRehash = false;
-#ifdef HASH_DEBUG
-    set->nCollisions = 0;
-#endif
     return set;
 }
 
@@ -129,64 +170,20 @@ int CPLHashSetSize( const CPLHashSet* set )
     return set->nSize;
 }
 
-/************************************************************************/
-/*                       CPLHashSetGetNewListElt()                      */
-/************************************************************************/
-
-static CPLList* CPLHashSetGetNewListElt( CPLHashSet* set )
-{
-    if( set->psRecyclingList )
-    {
-        CPLList* psRet = set->psRecyclingList;
-        psRet->pData = nullptr;
-        set->nRecyclingListSize--;
-        set->psRecyclingList = psRet->psNext;
-        return psRet;
-    }
-
-    return static_cast<CPLList *>(CPLMalloc(sizeof(CPLList)));
-}
-
-/************************************************************************/
-/*                       CPLHashSetReturnListElt()                      */
-/************************************************************************/
-
-static void CPLHashSetReturnListElt( CPLHashSet* set, CPLList* psList )
-{
-    if( set->nRecyclingListSize < 128 )
-    {
-        psList->psNext = set->psRecyclingList;
-        set->psRecyclingList = psList;
-        set->nRecyclingListSize++;
-    }
-    else
-    {
-        CPLFree(psList);
-    }
-}
-
 /************************************************************************/
 /*                   CPLHashSetClearInternal()                          */
 /************************************************************************/
 
-static void CPLHashSetClearInternal( CPLHashSet* set, bool bFinalize )
+static void CPLHashSetClearInternal( CPLHashSet* set )
 {
     CPLAssert(set != nullptr);
-    for( int i = 0; i < set->nAllocatedSize; i++ )
+    if( set->fnFreeEltFunc )
     {
-        CPLList* cur = set->tabList[i];
-        while( cur )
+        for( GUInt32 i = 0; i < set->nAllocatedSize; i++ )
         {
-            if( set->fnFreeEltFunc )
-                set->fnFreeEltFunc(cur->pData);
-            CPLList* psNext = cur->psNext;
-            if( bFinalize )
-                CPLFree(cur);
-            else
-                CPLHashSetReturnListElt(set, cur);
-            cur = psNext;
+            if( set->pasSlots[i].nDist != 0 )
+                set->fnFreeEltFunc(set->pasSlots[i].pData);
         }
-        set->tabList[i] = nullptr;
     }
     set->bRehash = false;
 }
@@ -206,9 +203,8 @@ static void CPLHashSetClearInternal( CPLHashSet* set, bool bFinalize )
 
 void CPLHashSetDestroy( CPLHashSet* set )
 {
-    CPLHashSetClearInternal(set, true);
-    CPLFree(set->tabList);
-    CPLListDestroy(set->psRecyclingList);
+    CPLHashSetClearInternal(set);
+    CPLFree(set->pasSlots);
     CPLFree(set);
 }
 
@@ -228,14 +224,16 @@ void CPLHashSetDestroy( CPLHashSet* set )
 
 void CPLHashSetClear( CPLHashSet* set )
 {
-    CPLHashSetClearInternal(set, false);
-    set->tabList = static_cast<CPLList**>(
-        CPLRealloc(set->tabList, sizeof(CPLList*) * 53));
-    set->nIndiceAllocatedSize = 0;
-    set->nAllocatedSize = 53;
-#ifdef HASH_DEBUG
-    set->nCollisions = 0;
-#endif
+    CPLHashSetClearInternal(set);
+    if( set->nShift != knMinShift )
+    {
+        CPLFree(set->pasSlots);
+        CPLHashSetAllocSlots(set, knMinShift);
+    }
+    else
+    {
+        memset(set->pasSlots, 0, sizeof(CPLHashSetSlot) * set->nAllocatedSize);
+    }
     set->nSize = 0;
 }
 
@@ -266,16 +264,36 @@ void CPLHashSetForeach( CPLHashSet* set,
     CPLAssert(set != nullptr);
     if( !fnIterFunc ) return;
 
-    for( int i = 0; i < set->nAllocatedSize; i++ )
+    for( GUInt32 i = 0; i < set->nAllocatedSize; i++ )
     {
-        CPLList* cur = set->tabList[i];
-        while( cur )
-        {
-            if( !fnIterFunc(cur->pData, user_data) )
-                return;
+        if( set->pasSlots[i].nDist != 0 &&
+            !fnIterFunc(set->pasSlots[i].pData, user_data) )
+            return;
+    }
+}
 
-            cur = cur->psNext;
+/************************************************************************/
+/*                      CPLHashSetInsertSlot()                          */
+/************************************************************************/
+
+// Inserts an element known not to be in the set.
+static void CPLHashSetInsertSlot( CPLHashSet* set, CPLHashSetSlot sSlot )
+{
+    const GUInt32 nMask = set->nAllocatedSize - 1;
+    GUInt32 i = sSlot.nHash >> set->nShift;
+    sSlot.nDist = 1;
+    while( true )
+    {
+        CPLHashSetSlot& sCur = set->pasSlots[i];
+        if( sCur.nDist == 0 )
+        {
+            sCur = sSlot;
+            return;
         }
+        if( sCur.nDist < sSlot.nDist )
+            std::swap(sCur, sSlot);
+        sSlot.nDist++;
+        i = (i + 1) & nMask;
     }
 }
 
@@ -283,56 +301,41 @@ void CPLHashSetForeach( CPLHashSet* set,
 /*                        CPLHashSetRehash()                            */
 /************************************************************************/
 
-static void CPLHashSetRehash( CPLHashSet* set )
+static void CPLHashSetRehash( CPLHashSet* set, int nNewShift )
 {
-    int nNewAllocatedSize = anPrimes[set->nIndiceAllocatedSize];
-    CPLList** newTabList = static_cast<CPLList **>(
-        CPLCalloc(sizeof(CPLList*), nNewAllocatedSize));
-#ifdef HASH_DEBUG
-    CPLDebug("CPLHASH", "hashSet=%p, nSize=%d, nCollisions=%d, "
-             "fCollisionRate=%.02f",
-             set, set->nSize, set->nCollisions,
-             set->nCollisions * 100.0 / set->nSize);
-    set->nCollisions = 0;
-#endif
-    for( int i = 0; i < set->nAllocatedSize; i++ )
+    CPLHashSetSlot* pasOldSlots = set->pasSlots;
+    const GUInt32 nOldAllocatedSize = set->nAllocatedSize;
+    CPLHashSetAllocSlots(set, nNewShift);
+    for( GUInt32 i = 0; i < nOldAllocatedSize; i++ )
     {
-        CPLList* cur = set->tabList[i];
-        while( cur )
-        {
-            const unsigned long nNewHashVal =
-                set->fnHashFunc(cur->pData) % nNewAllocatedSize;
-#ifdef HASH_DEBUG
-            if( newTabList[nNewHashVal] )
-                set->nCollisions++;
-#endif
-            CPLList* psNext = cur->psNext;
-            cur->psNext = newTabList[nNewHashVal];
-            newTabList[nNewHashVal] = cur;
-            cur = psNext;
-        }
+        if( pasOldSlots[i].nDist != 0 )
+            CPLHashSetInsertSlot(set, pasOldSlots[i]);
     }
-    CPLFree(set->tabList);
-    set->tabList = newTabList;
-    set->nAllocatedSize = nNewAllocatedSize;
+    CPLFree(pasOldSlots);
     set->bRehash = false;
 }
 
 /************************************************************************/
-/*                        CPLHashSetFindPtr()                           */
+/*                        CPLHashSetFindSlot()                          */
 /************************************************************************/
 
-static void** CPLHashSetFindPtr( CPLHashSet* set, const void* elt )
+// Returns the index of the slot of the element, or -1.
+static GIntBig CPLHashSetFindSlot( const CPLHashSet* set, const void* elt,
+                                   GUInt32 nHash )
 {
-    const unsigned long nHashVal = set->fnHashFunc(elt) % set->nAllocatedSize;
-    CPLList* cur = set->tabList[nHashVal];
-    while( cur )
+    const GUInt32 nMask = set->nAllocatedSize - 1;
+    GUInt32 i = nHash >> set->nShift;
+    // An element further than its own home slot than the current one
+    // would have taken the slot of the current one when inserted.
+    for( GUInt32 nDist = 1; ; nDist++ )
     {
-        if( set->fnEqualFunc(cur->pData, elt) )
-            return &cur->pData;
-        cur = cur->psNext;
+        const CPLHashSetSlot& sCur = set->pasSlots[i];
+        if( sCur.nDist < nDist )
+            return -1;
+        if( sCur.nHash == nHash && set->fnEqualFunc(sCur.pData, elt) )
+            return i;
+        i = (i + 1) & nMask;
     }
-    return nullptr;
 }
 
 /************************************************************************/
@@ -355,34 +358,28 @@ static void** CPLHashSetFindPtr( CPLHashSet* set, const void* elt )
 int CPLHashSetInsert( CPLHashSet* set, void* elt )
 {
     CPLAssert(set != nullptr);
-    void** pElt = CPLHashSetFindPtr(set, elt);
-    if( pElt )
+    const GUInt32 nHash = CPLHashSetMixHash(set, elt);
+    const GIntBig nIdx = CPLHashSetFindSlot(set, elt, nHash);
+    if( nIdx >= 0 )
     {
+        void*& pData = set->pasSlots[nIdx].pData;
         if( set->fnFreeEltFunc )
-            set->fnFreeEltFunc(*pElt);
+            set->fnFreeEltFunc(pData);
 
-        *pElt = elt;
+        pData = elt;
         return FALSE;
     }
 
-    if( set->nSize >= 2 * set->nAllocatedSize / 3 ||
-        (set->bRehash && set->nIndiceAllocatedSize > 0 &&
-         set->nSize <= set->nAllocatedSize / 2) )
-    {
-        set->nIndiceAllocatedSize++;
-        CPLHashSetRehash(set);
-    }
-
-    const unsigned long nHashVal = set->fnHashFunc(elt) % set->nAllocatedSize;
-#ifdef HASH_DEBUG
-    if( set->tabList[nHashVal] )
-        set->nCollisions++;
-#endif
+    if( CPLHashSetNeedsGrow(set) )
+        CPLHashSetRehash(set, set->nShift - 1);
+    else if( set->bRehash && CPLHashSetNeedsShrink(set) )
+        CPLHashSetRehash(set, set->nShift + 1);
 
-    CPLList* new_elt = CPLHashSetGetNewListElt(set);
-    new_elt->pData = elt;
-    new_elt->psNext = set->tabList[nHashVal];
-    set->tabList[nHashVal] = new_elt;
+    CPLHashSetSlot sSlot;
+    sSlot.pData = elt;
+    sSlot.nHash = nHash;
+    sSlot.nDist = 0;
+    CPLHashSetInsertSlot(set, sSlot);
     set->nSize++;
 
     return TRUE;
@@ -405,9 +402,10 @@ int CPLHashSetInsert( CPLHashSet* set, void* elt )
 void* CPLHashSetLookup( CPLHashSet* set, const void* elt )
 {
     CPLAssert(set != nullptr);
-    void** pElt = CPLHashSetFindPtr(set, elt);
-    if( pElt )
-        return *pElt;
+    const GIntBig nIdx =
+        CPLHashSetFindSlot(set, elt, CPLHashSetMixHash(set, elt));
+    if( nIdx >= 0 )
+        return set->pasSlots[nIdx].pData;
 
     return nullptr;
 }
@@ -421,42 +419,39 @@ bool CPLHashSetRemoveInternal( CPLHashSet* set, const void* elt,
                                bool bDeferRehash )
 {
     CPLAssert(set != nullptr);
-    if( set->nIndiceAllocatedSize > 0 && set->nSize <= set->nAllocatedSize / 2 )
+    if( CPLHashSetNeedsShrink(set) )
     {
-        set->nIndiceAllocatedSize--;
         if( bDeferRehash )
             set->bRehash = true;
         else
-            CPLHashSetRehash(set);
+            CPLHashSetRehash(set, set->nShift + 1);
     }
 
-    int nHashVal = static_cast<int>(set->fnHashFunc(elt) % set->nAllocatedSize);
-    CPLList* cur = set->tabList[nHashVal];
-    CPLList* prev = nullptr;
-    while( cur )
+    const GIntBig nIdx =
+        CPLHashSetFindSlot(set, elt, CPLHashSetMixHash(set, elt));
+    if( nIdx < 0 )
+        return false;
+
+    const GUInt32 nMask = set->nAllocatedSize - 1;
+    GUInt32 i = static_cast<GUInt32>(nIdx);
+    if( set->fnFreeEltFunc )
+        set->fnFreeEltFunc(set->pasSlots[i].pData);
+
+    // Shift backwards the following elements that are not in their home
+    // slot.
+    GUInt32 iNext = (i + 1) & nMask;
+    while( set->pasSlots[iNext].nDist > 1 )
     {
-        if( set->fnEqualFunc(cur->pData, elt) )
-        {
-            if( prev )
-                prev->psNext = cur->psNext;
-            else
-                set->tabList[nHashVal] = cur->psNext;
-
-            if( set->fnFreeEltFunc )
-                set->fnFreeEltFunc(cur->pData);
-
-            CPLHashSetReturnListElt(set, cur);
-#ifdef HASH_DEBUG
-            if( set->tabList[nHashVal] )
-                set->nCollisions--;
-#endif
-            set->nSize--;
-            return true;
-        }
-        prev = cur;
-        cur = cur->psNext;
+        set->pasSlots[i] = set->pasSlots[iNext];
+        set->pasSlots[i].nDist--;
+        i = iNext;
+        iNext = (iNext + 1) & nMask;
     }
-    return false;
+    set->pasSlots[i].pData = nullptr;
+    set->pasSlots[i].nHash = 0;
+    set->pasSlots[i].nDist = 0;
+    set->nSize--;
+    return true;
 }
 
 /************************************************************************/
@@ -43,6 +43,7 @@
 #include "cpl_http.h"
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
+#include "cpl_trace.h"
 
 #ifdef HAVE_CURL
 #  include <curl/curl.h>
@@ -1004,7 +1005,11 @@ CPLHTTPResult *CPLHTTPFetchEx( const char *pszURL, CSLConstList papszOptions,
 /*      Execute the request, waiting for results.                       */
 /* -------------------------------------------------------------------- */
         void* old_handler = CPLHTTPIgnoreSigPipe();
-        psResult->nStatus = static_cast<int>(curl_easy_perform(http_handle));
+        {
+            CPL_TRACE_SCOPE("http", "HTTPRequest");
+            psResult->nStatus =
+                static_cast<int>(curl_easy_perform(http_handle));
+        }
         CPLHTTPRestoreSigPipeHandler(old_handler);
 
 /* -------------------------------------------------------------------- */
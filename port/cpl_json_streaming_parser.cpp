@@ -39,6 +39,10 @@
 #include "cpl_string.h"
 #include "cpl_json_streaming_parser.h"
 
+#if (defined(__x86_64) || defined(_M_X64))
+#include <emmintrin.h>
+#endif
+
 /************************************************************************/
 /*                       CPLJSonStreamingParser()                       */
 /************************************************************************/
@@ -92,6 +96,10 @@ void CPLJSonStreamingParser::Reset()
     m_bInStringEscape = false;
     m_bInUnicode = false;
     m_osUnicodeHex.clear();
+    m_pszParseBuffer = nullptr;
+    m_nParseBufferSize = 0;
+    m_nParsedBytes = 0;
+    m_nCurObjectCharOffset = 0;
 }
 
 /************************************************************************/
@@ -165,6 +173,49 @@ bool CPLJSonStreamingParser::EmitUnexpectedChar(char ch,
     return EmitException(szMessage);
 }
 
+/************************************************************************/
+/*                        GetPlainStringCharCount()                     */
+/************************************************************************/
+
+// Returns the number of characters at the start of pStr that, within a
+// string, need no special processing: that is, neither a quote, a
+// backslash or a line break.
+static size_t GetPlainStringCharCount(const char* pStr, size_t nLength)
+{
+    size_t i = 0;
+#if (defined(__x86_64) || defined(_M_X64))
+    const __m128i xmmQuote = _mm_set1_epi8('"');
+    const __m128i xmmBackslash = _mm_set1_epi8('\\');
+    const __m128i xmmCR = _mm_set1_epi8(13);
+    const __m128i xmmLF = _mm_set1_epi8(10);
+    for( ; i + 16 <= nLength; i += 16 )
+    {
+        const __m128i xmmChars = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pStr + i));
+        const __m128i xmmSpecial = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(xmmChars, xmmQuote),
+                         _mm_cmpeq_epi8(xmmChars, xmmBackslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(xmmChars, xmmCR),
+                         _mm_cmpeq_epi8(xmmChars, xmmLF)));
+        const int nMask = _mm_movemask_epi8(xmmSpecial);
+        if( nMask != 0 )
+        {
+            int nFirst = 0;
+            while( ((nMask >> nFirst) & 1) == 0 )
+                nFirst ++;
+            return i + nFirst;
+        }
+    }
+#endif
+    for( ; i < nLength; i++ )
+    {
+        const char ch = pStr[i];
+        if( ch == '"' || ch == '\\' || ch == 13 || ch == 10 )
+            break;
+    }
+    return i;
+}
+
 /************************************************************************/
 /*                            IsValidNewToken()                         */
 /************************************************************************/
@@ -189,6 +240,8 @@ bool CPLJSonStreamingParser::StartNewToken(const char*& pStr, size_t& nLength)
         {
             return EmitException("Too many nested objects and/or arrays");
         }
+        m_nCurObjectCharOffset = m_nParsedBytes +
+            static_cast<GUIntBig>(pStr - m_pszParseBuffer);
         StartObject();
         m_aeObjectState.push_back(WAITING_KEY);
         m_aState.push_back(OBJECT);
@@ -438,6 +491,10 @@ bool CPLJSonStreamingParser::Parse(const char* pStr, size_t nLength,
     if( m_bExceptionOccurred )
         return false;
 
+    m_nParsedBytes += m_nParseBufferSize;
+    m_pszParseBuffer = pStr;
+    m_nParseBufferSize = nLength;
+
     while( true )
     {
         State eCurState = currentState();
@@ -682,8 +739,24 @@ bool CPLJSonStreamingParser::Parse(const char* pStr, size_t nLength,
                     break;
                 }
 
-                m_osToken += ch;
-                AdvanceChar(pStr, nLength);
+                // Copy at once the characters up to the next one that needs
+                // special processing.
+                size_t nCount = GetPlainStringCharCount(pStr, nLength);
+                if( nCount > m_nMaxStringSize - m_osToken.size() )
+                    nCount = m_nMaxStringSize - m_osToken.size();
+                if( nCount <= 1 )
+                {
+                    m_osToken += ch;
+                    AdvanceChar(pStr, nLength);
+                }
+                else
+                {
+                    m_osToken.append(pStr, nCount);
+                    m_nLastChar = pStr[nCount - 1];
+                    m_nCharCounter += static_cast<int>(nCount);
+                    pStr += nCount;
+                    nLength -= nCount;
+                }
             }
 
             if( nLength == 0 )
@@ -796,6 +869,8 @@ bool CPLJSonStreamingParser::Parse(const char* pStr, size_t nLength,
                     return EmitException("Missing value");
                 }
 
+                m_nCurObjectCharOffset = m_nParsedBytes +
+                    static_cast<GUIntBig>(pStr - m_pszParseBuffer);
                 EndObject();
                 AdvanceChar(pStr, nLength);
                 m_aeObjectState.pop_back();
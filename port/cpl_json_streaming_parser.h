@@ -82,6 +82,12 @@ class CPL_DLL CPLJSonStreamingParser
         };
         std::vector<MemberState> m_aeObjectState{};
 
+        // To compute the offset of the current character in the stream
+        const char* m_pszParseBuffer = nullptr;
+        size_t m_nParseBufferSize = 0;
+        GUIntBig m_nParsedBytes = 0;
+        GUIntBig m_nCurObjectCharOffset = 0;
+
         enum State currentState() { return m_aState.back(); }
         void SkipSpace(const char*& pStr, size_t& nLength);
         void AdvanceChar(const char*& pStr, size_t& nLength);
@@ -100,6 +106,12 @@ class CPL_DLL CPLJSonStreamingParser
         void SetMaxStringSize(size_t nVal);
         bool ExceptionOccurred() const { return m_bExceptionOccurred; }
 
+        // Offset, in the concatenation of the buffers passed to Parse()
+        // since the last Reset(), of the '{' or '}' character being processed.
+        // Only meaningful within StartObject() and EndObject().
+        GUIntBig GetCurrentObjectCharOffset() const
+                                        { return m_nCurObjectCharOffset; }
+
         static std::string GetSerializedString(const char* pszStr);
 
         virtual void Reset();
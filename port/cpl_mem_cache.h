@@ -33,7 +33,9 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <mutex>
 #include <stdexcept>
@@ -218,6 +220,163 @@ class Cache {
   size_t elasticity_;
 };
 
+/**
+ *	A thread-safe cache split into NShards shards, selected by the hash of
+ *	the keys, each with its own lock, map and list, so that threads
+ *	accessing different keys rarely contend.
+ *
+ *	The eviction is an approximate LRU (CLOCK): a hit only sets the
+ *	reference flag of the entry, without modifying the list, and the
+ *	pruning gives a second chance to the referenced entries of the tail of
+ *	the list. Reads thus only hold the shard lock for the duration of the
+ *	map lookup and value copy.
+ *
+ *	Each shard holds up to maxSize / NShards entries, plus a quarter, so
+ *	that an uneven distribution of the keys does not evict entries much
+ *	before the cache holds maxSize entries.
+ */
+template <class Key, class Value, class Hash = std::hash<Key>,
+          size_t NShards = 16>
+class ShardedCache {
+ public:
+  typedef KeyValuePair<Key, Value> node_type;
+
+  explicit ShardedCache(size_t maxSize = 64)
+      : maxSize_(maxSize),
+        maxShardSize_(std::max<size_t>(1, (maxSize + NShards - 1) / NShards +
+                                              maxSize / NShards / 4)) {}
+
+  size_t size() const {
+    size_t n = 0;
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> g(shard.lock_);
+      n += shard.cache_.size();
+    }
+    return n;
+  }
+  bool empty() const { return size() == 0; }
+  void clear() {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> g(shard.lock_);
+      shard.cache_.clear();
+      shard.keys_.clear();
+    }
+  }
+  void insert(const Key& k, const Value& v) {
+    Shard& shard = getShard(k);
+    std::lock_guard<std::mutex> g(shard.lock_);
+    const auto iter = shard.cache_.find(k);
+    if (iter != shard.cache_.end()) {
+      iter->second->value = v;
+      iter->second->referenced_.store(true, std::memory_order_relaxed);
+      return;
+    }
+    shard.keys_.emplace_front(k, v);
+    shard.cache_[k] = shard.keys_.begin();
+    prune(shard);
+  }
+  bool tryGet(const Key& kIn, Value& vOut) {
+    Shard& shard = getShard(kIn);
+    std::lock_guard<std::mutex> g(shard.lock_);
+    const auto iter = shard.cache_.find(kIn);
+    if (iter == shard.cache_.end()) {
+      return false;
+    }
+    iter->second->referenced_.store(true, std::memory_order_relaxed);
+    vOut = iter->second->value;
+    return true;
+  }
+  bool remove(const Key& k) {
+    Shard& shard = getShard(k);
+    std::lock_guard<std::mutex> g(shard.lock_);
+    auto iter = shard.cache_.find(k);
+    if (iter == shard.cache_.end()) {
+      return false;
+    }
+    shard.keys_.erase(iter->second);
+    shard.cache_.erase(iter);
+    return true;
+  }
+  bool contains(const Key& k) {
+    Shard& shard = getShard(k);
+    std::lock_guard<std::mutex> g(shard.lock_);
+    return shard.cache_.find(k) != shard.cache_.end();
+  }
+  /**
+   * removes the entries for which f(const node_type&) returns true, and
+   * returns their number
+   */
+  template <typename F>
+  size_t removeIf(F& f) {
+    size_t count = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> g(shard.lock_);
+      for (auto iter = shard.keys_.begin(); iter != shard.keys_.end();) {
+        if (f(static_cast<const node_type&>(*iter))) {
+          shard.cache_.erase(iter->key);
+          iter = shard.keys_.erase(iter);
+          ++count;
+        } else {
+          ++iter;
+        }
+      }
+    }
+    return count;
+  }
+  template <typename F>
+  void cwalk(F& f) const {
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> g(shard.lock_);
+      for (const auto& node : shard.keys_) {
+        f(static_cast<const node_type&>(node));
+      }
+    }
+  }
+
+  size_t getMaxSize() const { return maxSize_; }
+
+ private:
+  struct Node : public node_type {
+    std::atomic<bool> referenced_{false};
+    Node(const Key& k, const Value& v) : node_type(k, v) {}
+  };
+  typedef std::list<Node> list_type;
+
+  struct Shard {
+    mutable std::mutex lock_{};
+    std::unordered_map<Key, typename list_type::iterator, Hash> cache_{};
+    list_type keys_{};
+  };
+
+  // Dissallow copying.
+  ShardedCache(const ShardedCache&) = delete;
+  ShardedCache& operator=(const ShardedCache&) = delete;
+
+  Shard& getShard(const Key& k) {
+    // Mix the hash, whose low bits are also used by the maps of the shards.
+    const uint64_t h = static_cast<uint64_t>(Hash()(k)) *
+                       UINT64_C(0x9E3779B97F4A7C15);
+    return shards_[static_cast<size_t>(h >> 32) % NShards];
+  }
+
+  void prune(Shard& shard) {
+    // Each entry gets at most one second chance, so this terminates.
+    while (shard.cache_.size() > maxShardSize_) {
+      auto last = std::prev(shard.keys_.end());
+      if (last->referenced_.exchange(false, std::memory_order_relaxed)) {
+        shard.keys_.splice(shard.keys_.begin(), shard.keys_, last);
+      } else {
+        shard.cache_.erase(last->key);
+        shard.keys_.pop_back();
+      }
+    }
+  }
+
+  Shard shards_[NShards];
+  size_t maxSize_;
+  size_t maxShardSize_;
+};
+
 } // namespace LRUCache11
 
 /*! @endcond */
@@ -74,6 +74,24 @@ typedef struct
     CPLXMLNode *psLastChild;
 } StackContext;
 
+/* -------------------------------------------------------------------- */
+/*      Memory pool of the trees parsed by CPLParseXMLStringInArena().  */
+/*      Nodes and strings are carved sequentially out of large blocks,  */
+/*      which are all freed at once by CPLDestroyXMLArena().            */
+/* -------------------------------------------------------------------- */
+typedef struct _CPLXMLArenaBlock
+{
+    struct _CPLXMLArenaBlock *psPrev;
+    size_t      nSize;
+    size_t      nUsed;
+} CPLXMLArenaBlock;
+
+struct _CPLXMLArena
+{
+    CPLXMLArenaBlock *psBlock;
+    size_t      nBlockSize;
+};
+
 typedef struct {
     const char *pszInput;
     int        nInputOffset;
@@ -90,6 +108,8 @@ typedef struct {
 
     CPLXMLNode *psFirstNode;
     CPLXMLNode *psLastNode;
+
+    CPLXMLArena *psArena;
 } ParseContext;
 
 static CPLXMLNode *_CPLCreateXMLNode( CPLXMLNode *poParent,
@@ -113,25 +133,6 @@ static CPL_INLINE char ReadChar( ParseContext *psContext )
     return chReturn;
 }
 
-/************************************************************************/
-/*                             UnreadChar()                             */
-/************************************************************************/
-
-static CPL_INLINE void UnreadChar( ParseContext *psContext, char chToUnread )
-
-{
-    if( chToUnread == '\0' )
-        return;
-
-    CPLAssert( chToUnread
-               == psContext->pszInput[psContext->nInputOffset-1] );
-
-    psContext->nInputOffset--;
-
-    if( chToUnread == 10 )
-        psContext->nInputLine--;
-}
-
 /************************************************************************/
 /*                           ReallocToken()                             */
 /************************************************************************/
@@ -186,6 +187,63 @@ static CPL_INLINE bool _AddToToken( ParseContext *psContext, char chNewChar )
 #define AddToToken(psContext, chNewChar) \
     if( !_AddToToken(psContext, chNewChar)) goto fail;
 
+/************************************************************************/
+/*                            ConsumeUntil()                            */
+/*                                                                      */
+/*      Add the input characters up to pszEnd, that must be within     */
+/*      the current input string, to the token in one go.               */
+/************************************************************************/
+
+static bool ConsumeUntil( ParseContext *psContext, const char *pszEnd )
+
+{
+    const char *pszStart = psContext->pszInput + psContext->nInputOffset;
+    const size_t nLen = static_cast<size_t>(pszEnd - pszStart);
+
+    while( psContext->nTokenSize + nLen + 2 > psContext->nTokenMaxSize )
+    {
+        if( !ReallocToken(psContext) )
+            return false;
+    }
+
+    memcpy( psContext->pszToken + psContext->nTokenSize, pszStart, nLen );
+    psContext->nTokenSize += nLen;
+    psContext->pszToken[psContext->nTokenSize] = '\0';
+
+    for( const char *pszIter = pszStart;
+         (pszIter = static_cast<const char *>(
+             memchr(pszIter, 10, pszEnd - pszIter))) != nullptr;
+         ++pszIter )
+    {
+        psContext->nInputLine++;
+    }
+
+    psContext->nInputOffset += static_cast<int>(nLen);
+    return true;
+}
+
+/************************************************************************/
+/*                       ConsumeUntilDelimiter()                        */
+/*                                                                      */
+/*      Add the input characters up to the next occurrence of           */
+/*      pszDelimiter, or to the end of the input, to the token.         */
+/************************************************************************/
+
+static bool ConsumeUntilDelimiter( ParseContext *psContext,
+                                   const char *pszDelimiter )
+
+{
+    const char *pszStart = psContext->pszInput + psContext->nInputOffset;
+    const char *pszEnd = pszDelimiter[1] == '\0' ?
+        strchr(pszStart, pszDelimiter[0]) : strstr(pszStart, pszDelimiter);
+    if( pszEnd == nullptr )
+        pszEnd = pszStart + strlen(pszStart);
+    return ConsumeUntil( psContext, pszEnd );
+}
+
+#define AddInputUntil(psContext, pszDelimiter) \
+    if( !ConsumeUntilDelimiter(psContext, pszDelimiter)) goto fail;
+
 /************************************************************************/
 /*                             ReadToken()                              */
 /************************************************************************/
@@ -196,9 +254,17 @@ static XMLTokenType ReadToken( ParseContext *psContext, CPLErr& eLastErrorType )
     psContext->nTokenSize = 0;
     psContext->pszToken[0] = '\0';
 
+    // Skip white space.
+    const char *pszIter = psContext->pszInput + psContext->nInputOffset;
+    while( isspace(static_cast<unsigned char>(*pszIter)) )
+    {
+        if( *pszIter == 10 )
+            psContext->nInputLine++;
+        ++pszIter;
+    }
+    psContext->nInputOffset =
+        static_cast<int>(pszIter - psContext->pszInput);
     char chNext = ReadChar( psContext );
-    while( isspace(static_cast<unsigned char>(chNext)) )
-        chNext = ReadChar( psContext );
 
 /* -------------------------------------------------------------------- */
 /*      Handle comments.                                                */
@@ -213,10 +279,7 @@ static XMLTokenType ReadToken( ParseContext *psContext, CPLErr& eLastErrorType )
         ReadChar(psContext);
         ReadChar(psContext);
 
-        while( !STARTS_WITH_CI(psContext->pszInput+psContext->nInputOffset,
-                               "-->")
-               && (chNext = ReadChar(psContext)) != '\0' )
-            AddToToken( psContext, chNext );
+        AddInputUntil( psContext, "-->" );
 
         // Skip "-->" characters.
         ReadChar(psContext);
@@ -320,10 +383,7 @@ static XMLTokenType ReadToken( ParseContext *psContext, CPLErr& eLastErrorType )
         ReadChar( psContext );
         ReadChar( psContext );
 
-        while( !STARTS_WITH_CI(psContext->pszInput+psContext->nInputOffset,
-                               "]]>")
-               && (chNext = ReadChar(psContext)) != '\0' )
-            AddToToken( psContext, chNext );
+        AddInputUntil( psContext, "]]>" );
 
         // Skip "]]>" characters.
         ReadChar(psContext);
@@ -383,9 +443,8 @@ static XMLTokenType ReadToken( ParseContext *psContext, CPLErr& eLastErrorType )
     {
         psContext->eTokenType = TString;
 
-        while( (chNext = ReadChar(psContext)) != '"'
-               && chNext != '\0' )
-            AddToToken( psContext, chNext );
+        AddInputUntil( psContext, "\"" );
+        chNext = ReadChar( psContext );
 
         if( chNext != '"' )
         {
@@ -411,9 +470,8 @@ static XMLTokenType ReadToken( ParseContext *psContext, CPLErr& eLastErrorType )
     {
         psContext->eTokenType = TString;
 
-        while( (chNext = ReadChar(psContext)) != '\''
-               && chNext != '\0' )
-            AddToToken( psContext, chNext );
+        AddInputUntil( psContext, "'" );
+        chNext = ReadChar( psContext );
 
         if( chNext != '\'' )
         {
@@ -444,10 +502,7 @@ static XMLTokenType ReadToken( ParseContext *psContext, CPLErr& eLastErrorType )
         psContext->eTokenType = TString;
 
         AddToToken( psContext, chNext );
-        while( (chNext = ReadChar(psContext)) != '<'
-               && chNext != '\0' )
-            AddToToken( psContext, chNext );
-        UnreadChar( psContext, chNext );
+        AddInputUntil( psContext, "<" );
 
         // Do we need to unescape it?
         if( strchr(psContext->pszToken, '&') != nullptr )
@@ -472,20 +527,20 @@ static XMLTokenType ReadToken( ParseContext *psContext, CPLErr& eLastErrorType )
         // Add the first character to the token regardless of what it is.
         AddToToken( psContext, chNext );
 
-        for( chNext = ReadChar(psContext);
-             (chNext >= 'A' && chNext <= 'Z')
-                 || (chNext >= 'a' && chNext <= 'z')
-                 || chNext == '-'
-                 || chNext == '_'
-                 || chNext == '.'
-                 || chNext == ':'
-                 || (chNext >= '0' && chNext <= '9');
-             chNext = ReadChar(psContext) )
+        const char *pszEnd = psContext->pszInput + psContext->nInputOffset;
+        for( ; (*pszEnd >= 'A' && *pszEnd <= 'Z')
+                 || (*pszEnd >= 'a' && *pszEnd <= 'z')
+                 || *pszEnd == '-'
+                 || *pszEnd == '_'
+                 || *pszEnd == '.'
+                 || *pszEnd == ':'
+                 || (*pszEnd >= '0' && *pszEnd <= '9');
+             ++pszEnd )
         {
-            AddToToken( psContext, chNext );
         }
 
-        UnreadChar(psContext, chNext);
+        if( !ConsumeUntil(psContext, pszEnd) )
+            goto fail;
     }
 
     return psContext->eTokenType;
@@ -585,33 +640,88 @@ static void AttachNode( ParseContext *psContext, CPLXMLNode *psNode )
 }
 
 /************************************************************************/
-/*                         CPLParseXMLString()                          */
+/*                          CPLXMLArenaAlloc()                          */
 /************************************************************************/
 
-/**
- * \brief Parse an XML string into tree form.
- *
- * The passed document is parsed into a CPLXMLNode tree representation.
- * If the document is not well formed XML then NULL is returned, and errors
- * are reported via CPLError().  No validation beyond wellformedness is
- * done.  The CPLParseXMLFile() convenience function can be used to parse
- * from a file.
- *
- * The returned document tree is owned by the caller and should be freed
- * with CPLDestroyXMLNode() when no longer needed.
- *
- * If the document has more than one "root level" element then those after the
- * first will be attached to the first as siblings (via the psNext pointers)
- * even though there is no common parent.  A document with no XML structure
- * (no angle brackets for instance) would be considered well formed, and
- * returned as a single CXT_Text node.
- *
- * @param pszString the document to parse.
- *
- * @return parsed tree or NULL on error.
- */
+static void *CPLXMLArenaAlloc( CPLXMLArena *psArena, size_t nSize )
 
-CPLXMLNode *CPLParseXMLString( const char *pszString )
+{
+    // Keep all allocations pointer aligned, for the nodes following strings.
+    constexpr size_t nAlign = sizeof(void *);
+    nSize = (nSize + nAlign - 1) & ~(nAlign - 1);
+
+    CPLXMLArenaBlock *psBlock = psArena->psBlock;
+    if( psBlock == nullptr || psBlock->nSize - psBlock->nUsed < nSize )
+    {
+        const size_t nBlockSize = std::max(psArena->nBlockSize, nSize);
+        psBlock = static_cast<CPLXMLArenaBlock *>(
+            VSIMalloc(sizeof(CPLXMLArenaBlock) + nBlockSize));
+        if( psBlock == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate " CPL_FRMT_GUIB " bytes",
+                     static_cast<GUIntBig>(nBlockSize));
+            return nullptr;
+        }
+        psBlock->psPrev = psArena->psBlock;
+        psBlock->nSize = nBlockSize;
+        psBlock->nUsed = 0;
+        psArena->psBlock = psBlock;
+    }
+
+    void *pRet = reinterpret_cast<GByte *>(psBlock + 1) + psBlock->nUsed;
+    psBlock->nUsed += nSize;
+    return pRet;
+}
+
+/************************************************************************/
+/*                          ParserCreateNode()                          */
+/*                                                                      */
+/*      Create a node with the current token as value, from the         */
+/*      arena if there is one.                                          */
+/************************************************************************/
+
+static CPLXMLNode *ParserCreateNode( ParseContext *psContext,
+                                     CPLXMLNode *poParent,
+                                     CPLXMLNodeType eType )
+
+{
+    if( psContext->psArena == nullptr )
+        return _CPLCreateXMLNode( poParent, eType, psContext->pszToken );
+
+    // The token length is known, so the value goes in the same allocation.
+    const size_t nNodeSize =
+        (sizeof(CPLXMLNode) + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    GByte *pabyData = static_cast<GByte *>(
+        CPLXMLArenaAlloc(psContext->psArena,
+                         nNodeSize + psContext->nTokenSize + 1));
+    if( pabyData == nullptr )
+        return nullptr;
+
+    CPLXMLNode *psNode = reinterpret_cast<CPLXMLNode *>(pabyData);
+    psNode->eType = eType;
+    psNode->pszValue = reinterpret_cast<char *>(pabyData + nNodeSize);
+    memcpy( psNode->pszValue, psContext->pszToken, psContext->nTokenSize );
+    psNode->pszValue[psContext->nTokenSize] = '\0';
+    psNode->psNext = nullptr;
+    psNode->psChild = nullptr;
+
+    // Only used for the text of a new attribute node.
+    if( poParent != nullptr )
+    {
+        CPLAssert( poParent->psChild == nullptr );
+        poParent->psChild = psNode;
+    }
+
+    return psNode;
+}
+
+/************************************************************************/
+/*                      CPLParseXMLStringInternal()                     */
+/************************************************************************/
+
+static CPLXMLNode *CPLParseXMLStringInternal( const char *pszString,
+                                              CPLXMLArena *psArena )
 
 {
     if( pszString == nullptr )
@@ -663,6 +773,7 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
     sContext.papsStack = nullptr;
     sContext.psFirstNode = nullptr;
     sContext.psLastNode = nullptr;
+    sContext.psArena = psArena;
 
 #ifdef DEBUG
     bool bRecoverableError = true;
@@ -692,8 +803,8 @@ CPLXMLNode *CPLParseXMLString( const char *pszString )
             CPLXMLNode *psElement = nullptr;
             if( sContext.pszToken[0] != '/' )
             {
-                psElement = _CPLCreateXMLNode( nullptr, CXT_Element,
-                                              sContext.pszToken );
+                psElement = ParserCreateNode( &sContext, nullptr,
+                                              CXT_Element );
                 if( !psElement ) break;
                 AttachNode( &sContext, psElement );
                 if( !PushNode( &sContext, psElement, eLastErrorType ) )
@@ -779,7 +890,7 @@ end_processing_close:
         else if( sContext.eTokenType == TToken )
         {
             CPLXMLNode *psAttr =
-                _CPLCreateXMLNode(nullptr, CXT_Attribute, sContext.pszToken);
+                ParserCreateNode(&sContext, nullptr, CXT_Attribute);
             if( !psAttr ) break;
             AttachNode( &sContext, psAttr );
 
@@ -793,19 +904,39 @@ end_processing_close:
                       sContext.papsStack[sContext.nStackSize - 1]
                               .psFirstNode->psChild == psAttr )
                 {
-                    CPLDestroyXMLNode(psAttr);
+                    if( psArena == nullptr )
+                        CPLDestroyXMLNode(psAttr);
                     sContext.papsStack[sContext.nStackSize - 1]
                         .psFirstNode->psChild = nullptr;
                     sContext.papsStack[sContext.nStackSize - 1].psLastChild =
                         nullptr;
 
-                    sContext.papsStack[sContext.nStackSize - 1]
-                        .psFirstNode->pszValue = static_cast<char *>(CPLRealloc(
-                        sContext.papsStack[sContext.nStackSize - 1]
-                            .psFirstNode->pszValue,
+                    const size_t nNewSize =
                         strlen(sContext.papsStack[sContext.nStackSize - 1]
                                    .psFirstNode->pszValue) +
-                            1 + strlen(sContext.pszToken) + 1));
+                            1 + strlen(sContext.pszToken) + 1;
+                    if( psArena == nullptr )
+                    {
+                        sContext.papsStack[sContext.nStackSize - 1]
+                            .psFirstNode->pszValue = static_cast<char *>(
+                            CPLRealloc(sContext.papsStack[sContext.nStackSize - 1]
+                                           .psFirstNode->pszValue, nNewSize));
+                    }
+                    else
+                    {
+                        char *pszNewValue = static_cast<char *>(
+                            CPLXMLArenaAlloc(psArena, nNewSize));
+                        if( pszNewValue == nullptr )
+                        {
+                            eLastErrorType = CE_Failure;
+                            break;
+                        }
+                        strcpy(pszNewValue,
+                               sContext.papsStack[sContext.nStackSize - 1]
+                                   .psFirstNode->pszValue);
+                        sContext.papsStack[sContext.nStackSize - 1]
+                            .psFirstNode->pszValue = pszNewValue;
+                    }
                     strcat(sContext.papsStack[sContext.nStackSize - 1]
                                .psFirstNode->pszValue,
                            " ");
@@ -853,7 +984,7 @@ end_processing_close:
                 break;
             }
 
-            if( !_CPLCreateXMLNode( psAttr, CXT_Text, sContext.pszToken ) )
+            if( !ParserCreateNode( &sContext, psAttr, CXT_Text ) )
                 break;
         }
 
@@ -923,7 +1054,7 @@ end_processing_close:
         else if( sContext.eTokenType == TComment )
         {
             CPLXMLNode *psValue =
-                _CPLCreateXMLNode(nullptr, CXT_Comment, sContext.pszToken);
+                ParserCreateNode(&sContext, nullptr, CXT_Comment);
             if( !psValue ) break;
             AttachNode( &sContext, psValue );
         }
@@ -933,7 +1064,7 @@ end_processing_close:
         else if( sContext.eTokenType == TLiteral )
         {
             CPLXMLNode *psValue =
-                _CPLCreateXMLNode(nullptr, CXT_Literal, sContext.pszToken);
+                ParserCreateNode(&sContext, nullptr, CXT_Literal);
             if( !psValue ) break;
             AttachNode( &sContext, psValue );
         }
@@ -943,7 +1074,7 @@ end_processing_close:
         else if( sContext.eTokenType == TString && !sContext.bInElement )
         {
             CPLXMLNode *psValue =
-                _CPLCreateXMLNode(nullptr, CXT_Text, sContext.pszToken);
+                ParserCreateNode(&sContext, nullptr, CXT_Text);
             if( !psValue ) break;
             AttachNode( &sContext, psValue );
         }
@@ -997,7 +1128,9 @@ end_processing_close:
     // has been set we would never get failures
     if( eLastErrorType == CE_Failure )
     {
-        CPLDestroyXMLNode( sContext.psFirstNode );
+        // Nodes from an arena are freed with it by the caller.
+        if( psArena == nullptr )
+            CPLDestroyXMLNode( sContext.psFirstNode );
         sContext.psFirstNode = nullptr;
         sContext.psLastNode = nullptr;
     }
@@ -1011,6 +1144,130 @@ end_processing_close:
     return sContext.psFirstNode;
 }
 
+/************************************************************************/
+/*                         CPLParseXMLString()                          */
+/************************************************************************/
+
+/**
+ * \brief Parse an XML string into tree form.
+ *
+ * The passed document is parsed into a CPLXMLNode tree representation.
+ * If the document is not well formed XML then NULL is returned, and errors
+ * are reported via CPLError().  No validation beyond wellformedness is
+ * done.  The CPLParseXMLFile() convenience function can be used to parse
+ * from a file.
+ *
+ * The returned document tree is owned by the caller and should be freed
+ * with CPLDestroyXMLNode() when no longer needed.
+ *
+ * If the document has more than one "root level" element then those after the
+ * first will be attached to the first as siblings (via the psNext pointers)
+ * even though there is no common parent.  A document with no XML structure
+ * (no angle brackets for instance) would be considered well formed, and
+ * returned as a single CXT_Text node.
+ *
+ * @param pszString the document to parse.
+ *
+ * @return parsed tree or NULL on error.
+ */
+
+CPLXMLNode *CPLParseXMLString( const char *pszString )
+
+{
+    return CPLParseXMLStringInternal( pszString, nullptr );
+}
+
+/************************************************************************/
+/*                      CPLParseXMLStringInArena()                      */
+/************************************************************************/
+
+/**
+ * \brief Parse an XML string into a tree allocated from a memory pool.
+ *
+ * This is the same as CPLParseXMLString(), except that the nodes and their
+ * values are carved out of a few large blocks instead of being allocated
+ * one by one, which makes parsing and freeing large documents much faster.
+ *
+ * The returned tree belongs to the arena returned in *phArena and is freed,
+ * all at once, by CPLDestroyXMLArena(), not by CPLDestroyXMLNode().  It must
+ * be treated as read-only: functions that free, reallocate or unlink nodes or
+ * values, like CPLDestroyXMLNode(), CPLRemoveXMLChild(), CPLSetXMLValue() or
+ * CPLStripXMLNamespace(), must not be applied to it.  CPLCloneXMLTree() can
+ * be used to get a regular, modifiable, copy of some of it.
+ *
+ * @param pszString the document to parse.
+ * @param phArena pointer to the location where the arena is returned.  Set
+ * to NULL on error.
+ *
+ * @return parsed tree or NULL on error.
+ *
+ * @since GDAL 3.1
+ */
+
+CPLXMLNode *CPLParseXMLStringInArena( const char *pszString,
+                                      CPLXMLArena **phArena )
+
+{
+    *phArena = nullptr;
+    if( pszString == nullptr )
+        return CPLParseXMLStringInternal( pszString, nullptr );
+
+    CPLXMLArena *psArena =
+        static_cast<CPLXMLArena *>(VSICalloc(1, sizeof(CPLXMLArena)));
+    if( psArena == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Cannot allocate CPLXMLArena");
+        return nullptr;
+    }
+
+    // The tree of a typical document takes two to three times its size, so
+    // most documents fit in one or two blocks.
+    const size_t nLen = strlen(pszString);
+    psArena->nBlockSize =
+        std::max(static_cast<size_t>(4096),
+                 std::min(nLen * 2, static_cast<size_t>(64 * 1024 * 1024)));
+
+    CPLXMLNode *psTree = CPLParseXMLStringInternal( pszString, psArena );
+    if( psTree == nullptr )
+    {
+        CPLDestroyXMLArena( psArena );
+        return nullptr;
+    }
+
+    *phArena = psArena;
+    return psTree;
+}
+
+/************************************************************************/
+/*                         CPLDestroyXMLArena()                         */
+/************************************************************************/
+
+/**
+ * \brief Free a tree returned by CPLParseXMLStringInArena().
+ *
+ * All the nodes of the tree, and their values, are freed.
+ *
+ * @param hArena the arena returned by CPLParseXMLStringInArena(), or NULL.
+ *
+ * @since GDAL 3.1
+ */
+
+void CPLDestroyXMLArena( CPLXMLArena *hArena )
+
+{
+    if( hArena == nullptr )
+        return;
+
+    CPLXMLArenaBlock *psBlock = hArena->psBlock;
+    while( psBlock != nullptr )
+    {
+        CPLXMLArenaBlock *psPrev = psBlock->psPrev;
+        VSIFree( psBlock );
+        psBlock = psPrev;
+    }
+    VSIFree( hArena );
+}
+
 /************************************************************************/
 /*                            _GrowBuffer()                             */
 /************************************************************************/
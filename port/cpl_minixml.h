@@ -179,6 +179,14 @@ CPLXMLNode CPL_DLL *CPLParseXMLFile( const char *pszFilename );
 int        CPL_DLL CPLSerializeXMLTreeToFile( const CPLXMLNode *psTree,
                                               const char *pszFilename );
 
+/** Opaque type for the memory pool of a tree parsed with
+ * CPLParseXMLStringInArena() */
+typedef struct _CPLXMLArena CPLXMLArena;
+
+CPLXMLNode CPL_DLL *CPLParseXMLStringInArena( const char *pszString,
+                                              CPLXMLArena **phArena );
+void       CPL_DLL CPLDestroyXMLArena( CPLXMLArena *hArena );
+
 CPL_C_END
 
 #if defined(__cplusplus) && !defined(CPL_SUPRESS_CPLUSPLUS)
@@ -211,6 +219,18 @@ class CPLXMLTreeCloser: public std::unique_ptr<CPLXMLNode, CPLXMLTreeCloserDelet
   CPLXMLNode* getDocumentElement();
 };
 
+/*! @cond Doxygen_Suppress */
+struct CPLXMLArenaDeleter
+{
+    void operator()(CPLXMLArena* hArena) const { CPLDestroyXMLArena(hArena); }
+};
+/*! @endcond */
+
+/** Unique pointer type for a CPLXMLArena.
+ * @since GDAL 3.1
+ */
+typedef std::unique_ptr<CPLXMLArena, CPLXMLArenaDeleter> CPLXMLArenaUniquePtr;
+
 } // extern "C++"
 
 #endif /* __cplusplus */
@@ -220,6 +220,7 @@ class CPL_DLL CPLLockHolder
 #define CTLS_VSIERRORCONTEXT            16         /* cpl_vsi_error.cpp */
 #define CTLS_ERRORHANDLERACTIVEDATA     17         /* cpl_error.cpp */
 #define CTLS_PROJCONTEXTHOLDER          18         /* ogr_proj_p.cpp */
+#define CTLS_TRACEBUFFER                19         /* cpl_trace.cpp */
 
 #define CTLS_MAX                        32
 
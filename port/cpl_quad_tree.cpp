@@ -33,8 +33,11 @@
 #include "cpl_port.h"
 #include "cpl_quad_tree.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -881,3 +884,478 @@ void CPLQuadTreeGetStats( const CPLQuadTree *hQuadTree,
     // TODO(schwehr): If any of the pointers were set to local vars,
     // do they need to be reset to a nullptr?
 }
+
+/************************************************************************/
+/* ==================================================================== */
+/*                           CPLPackedRTree                             */
+/* ==================================================================== */
+/************************************************************************/
+
+/* -------------------------------------------------------------------- */
+/*      The elements are sorted along a Hilbert curve of the centers of */
+/*      their bounding boxes, and grouped by nNodeCapacity into leaf    */
+/*      nodes, which are in turn grouped into the nodes of the upper    */
+/*      level, until a single root node. The bounding boxes of all the  */
+/*      nodes, level after level from the leaves to the root, and the   */
+/*      sorted elements are stored in one buffer. The children of the   */
+/*      i-th node of a level are implicitly the nodes (or elements)     */
+/*      i * nNodeCapacity to (i + 1) * nNodeCapacity - 1 of the level   */
+/*      below.                                                          */
+/* -------------------------------------------------------------------- */
+
+constexpr int DEFAULT_PACKED_NODE_CAPACITY = 16;
+constexpr int MAX_PACKED_LEVELS = 32;
+
+struct _CPLPackedRTree
+{
+    int           nFeatures;
+    int           nNodeCapacity;
+    int           nLevels;
+    // Index in pasBoxes of the first box of each level. Level 0 holds the
+    // bounds of the elements. The last value is the total number of boxes.
+    size_t        anLevelStart[MAX_PACKED_LEVELS + 1];
+    CPLRectObj   *pasBoxes;
+    void        **pahFeatures;
+    GByte        *pabyBuffer;
+};
+
+/************************************************************************/
+/*                        CPLPackedRTreeHilbert()                       */
+/************************************************************************/
+
+// Index of (x, y), in [0, 65535], along a Hilbert curve, from
+// "Fast Hilbert curve generation, sorting, and range queries" by
+// rawrunprotected (public domain).
+static GUInt32 CPLPackedRTreeHilbert( GUInt32 x, GUInt32 y )
+{
+    GUInt32 a = x ^ y;
+    GUInt32 b = 0xFFFF ^ a;
+    GUInt32 c = 0xFFFF ^ (x | y);
+    GUInt32 d = x & (y ^ 0xFFFF);
+
+    GUInt32 A = a | (b >> 1);
+    GUInt32 B = (a >> 1) ^ a;
+    GUInt32 C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    GUInt32 D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+    B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+    C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+    D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+    B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+    C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+    D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+    a = A; b = B; c = C; d = D;
+    C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+    D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+    a = C ^ (C >> 1);
+    b = D ^ (D >> 1);
+
+    GUInt32 i0 = x ^ y;
+    GUInt32 i1 = b | (0xFFFF ^ (i0 | a));
+
+    i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+    i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+    i0 = (i0 | (i0 << 2)) & 0x33333333;
+    i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+    i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+    i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+    i1 = (i1 | (i1 << 2)) & 0x33333333;
+    i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+    return (i1 << 1) | i0;
+}
+
+/************************************************************************/
+/*                        CPLPackedRTreeCreate()                        */
+/************************************************************************/
+
+/**
+ * Create a packed R-tree from a set of elements
+ *
+ * The tree cannot be modified once created, but it is more compact than
+ * a quadtree, and CPLPackedRTreeVisit() does not allocate memory.
+ * The arrays and pfnGetBounds may be NULL if nFeatures is 0.
+ *
+ * @param nFeatures number of elements
+ * @param pahFeatures array of nFeatures elements. The array is copied, but
+ *                    the elements are not, and must outlive the tree.
+ * @param pasBounds array of the nFeatures bounding boxes of the elements,
+ *                  or NULL to use pfnGetBounds.
+ * @param pfnGetBounds function returning the bounding box of an element,
+ *                     used if pasBounds is NULL.
+ * @param nNodeCapacity maximum number of children of a node, or 0 for the
+ *                      default (16).
+ *
+ * @return a newly allocated tree to free with CPLPackedRTreeDestroy(), or
+ *         NULL in case of error.
+ * @since GDAL 3.1
+ */
+
+CPLPackedRTree *CPLPackedRTreeCreate( int nFeatures,
+                                      void* const* pahFeatures,
+                                      const CPLRectObj* pasBounds,
+                                      CPLQuadTreeGetBoundsFunc pfnGetBounds,
+                                      int nNodeCapacity )
+{
+    if( nFeatures < 0 ||
+        (nFeatures > 0 && (pahFeatures == nullptr ||
+                           (pasBounds == nullptr && pfnGetBounds == nullptr))) )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "CPLPackedRTreeCreate(): invalid arguments");
+        return nullptr;
+    }
+    if( nNodeCapacity <= 0 )
+        nNodeCapacity = DEFAULT_PACKED_NODE_CAPACITY;
+    else if( nNodeCapacity < 2 )
+        nNodeCapacity = 2;
+
+    CPLPackedRTree* hTree = static_cast<CPLPackedRTree *>(
+        CPLCalloc(1, sizeof(CPLPackedRTree)));
+    hTree->nFeatures = nFeatures;
+    hTree->nNodeCapacity = nNodeCapacity;
+
+/* -------------------------------------------------------------------- */
+/*      Compute the layout of the levels.                               */
+/* -------------------------------------------------------------------- */
+    size_t nCount = static_cast<size_t>(nFeatures);
+    size_t nTotal = 0;
+    if( nCount > 0 )
+    {
+        while( true )
+        {
+            hTree->anLevelStart[hTree->nLevels] = nTotal;
+            nTotal += nCount;
+            hTree->nLevels++;
+            if( nCount == 1 )
+                break;
+            nCount = (nCount + nNodeCapacity - 1) / nNodeCapacity;
+        }
+    }
+    hTree->anLevelStart[hTree->nLevels] = nTotal;
+
+    hTree->pabyBuffer = static_cast<GByte *>(VSI_MALLOC_VERBOSE(
+        std::max<size_t>(1, nTotal * sizeof(CPLRectObj) +
+                            static_cast<size_t>(nFeatures) * sizeof(void*))));
+    if( hTree->pabyBuffer == nullptr )
+    {
+        CPLFree(hTree);
+        return nullptr;
+    }
+    hTree->pasBoxes = reinterpret_cast<CPLRectObj *>(hTree->pabyBuffer);
+    hTree->pahFeatures = reinterpret_cast<void **>(
+        hTree->pabyBuffer + nTotal * sizeof(CPLRectObj));
+    if( nFeatures == 0 )
+        return hTree;
+
+/* -------------------------------------------------------------------- */
+/*      Sort the elements along the Hilbert curve of the global extent. */
+/* -------------------------------------------------------------------- */
+    std::vector<CPLRectObj> asBounds;
+    if( pasBounds == nullptr )
+    {
+        asBounds.resize(nFeatures);
+        for( int i = 0; i < nFeatures; i++ )
+            pfnGetBounds(pahFeatures[i], &asBounds[i]);
+        pasBounds = asBounds.data();
+    }
+
+    CPLRectObj sExtent = pasBounds[0];
+    for( int i = 1; i < nFeatures; i++ )
+    {
+        sExtent.minx = std::min(sExtent.minx, pasBounds[i].minx);
+        sExtent.miny = std::min(sExtent.miny, pasBounds[i].miny);
+        sExtent.maxx = std::max(sExtent.maxx, pasBounds[i].maxx);
+        sExtent.maxy = std::max(sExtent.maxy, pasBounds[i].maxy);
+    }
+    const double dfWidth = sExtent.maxx - sExtent.minx;
+    const double dfHeight = sExtent.maxy - sExtent.miny;
+
+    std::vector<std::pair<GUInt32, int>> aoOrder(nFeatures);
+    for( int i = 0; i < nFeatures; i++ )
+    {
+        const double dfX = (pasBounds[i].minx + pasBounds[i].maxx) / 2;
+        const double dfY = (pasBounds[i].miny + pasBounds[i].maxy) / 2;
+        const GUInt32 nX = dfWidth > 0 ? static_cast<GUInt32>(
+            65535 * ((dfX - sExtent.minx) / dfWidth)) : 0;
+        const GUInt32 nY = dfHeight > 0 ? static_cast<GUInt32>(
+            65535 * ((dfY - sExtent.miny) / dfHeight)) : 0;
+        aoOrder[i] = std::make_pair(CPLPackedRTreeHilbert(nX, nY), i);
+    }
+    std::sort(aoOrder.begin(), aoOrder.end());
+
+    for( int i = 0; i < nFeatures; i++ )
+    {
+        hTree->pasBoxes[i] = pasBounds[aoOrder[i].second];
+        hTree->pahFeatures[i] = pahFeatures[aoOrder[i].second];
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Compute the bounding boxes of the nodes.                        */
+/* -------------------------------------------------------------------- */
+    for( int iLevel = 1; iLevel < hTree->nLevels; iLevel++ )
+    {
+        const size_t nChildStart = hTree->anLevelStart[iLevel - 1];
+        const size_t nChildEnd = hTree->anLevelStart[iLevel];
+        size_t iNode = nChildEnd;
+        for( size_t i = nChildStart; i < nChildEnd; i += nNodeCapacity, iNode++ )
+        {
+            const size_t nEnd = std::min(nChildEnd, i + nNodeCapacity);
+            CPLRectObj sBox = hTree->pasBoxes[i];
+            for( size_t j = i + 1; j < nEnd; j++ )
+            {
+                const CPLRectObj& sChild = hTree->pasBoxes[j];
+                sBox.minx = std::min(sBox.minx, sChild.minx);
+                sBox.miny = std::min(sBox.miny, sChild.miny);
+                sBox.maxx = std::max(sBox.maxx, sChild.maxx);
+                sBox.maxy = std::max(sBox.maxy, sChild.maxy);
+            }
+            hTree->pasBoxes[iNode] = sBox;
+        }
+    }
+
+    return hTree;
+}
+
+/************************************************************************/
+/*                  CPLPackedRTreeCreateFromQuadTree()                  */
+/************************************************************************/
+
+namespace {
+struct CPLPackedRTreeCollector
+{
+    std::vector<void*> ahFeatures{};
+    std::vector<CPLRectObj> asBounds{};
+};
+} // namespace
+
+static void CPLPackedRTreeCollectNode( const CPLQuadTree* hQuadTree,
+                                       const QuadTreeNode *psNode,
+                                       CPLPackedRTreeCollector& oCollector )
+{
+    for( int i = 0; i < psNode->nNumSubNodes; i++ )
+        CPLPackedRTreeCollectNode(hQuadTree, psNode->apSubNode[i], oCollector);
+
+    for( int i = 0; i < psNode->nFeatures; i++ )
+    {
+        oCollector.ahFeatures.push_back(psNode->pahFeatures[i]);
+        if( hQuadTree->pfnGetBounds == nullptr )
+        {
+            oCollector.asBounds.push_back(psNode->pasBounds[i]);
+        }
+        else
+        {
+            CPLRectObj sBounds;
+            hQuadTree->pfnGetBounds(psNode->pahFeatures[i], &sBounds);
+            oCollector.asBounds.push_back(sBounds);
+        }
+    }
+}
+
+/**
+ * Create a packed R-tree with the elements of a quadtree
+ *
+ * This is useful when a quadtree has been incrementally filled and is
+ * then only searched.
+ *
+ * @param hQuadTree the quad tree, which may be destroyed afterwards.
+ * @param nNodeCapacity maximum number of children of a node, or 0 for the
+ *                      default (16).
+ *
+ * @return a newly allocated tree to free with CPLPackedRTreeDestroy(), or
+ *         NULL in case of error.
+ * @since GDAL 3.1
+ */
+
+CPLPackedRTree *CPLPackedRTreeCreateFromQuadTree( const CPLQuadTree *hQuadTree,
+                                                  int nNodeCapacity )
+{
+    CPLAssert(hQuadTree);
+
+    CPLPackedRTreeCollector oCollector;
+    oCollector.ahFeatures.reserve(hQuadTree->nFeatures);
+    oCollector.asBounds.reserve(hQuadTree->nFeatures);
+    CPLPackedRTreeCollectNode(hQuadTree, hQuadTree->psRoot, oCollector);
+
+    return CPLPackedRTreeCreate(static_cast<int>(oCollector.ahFeatures.size()),
+                                oCollector.ahFeatures.data(),
+                                oCollector.asBounds.data(), nullptr,
+                                nNodeCapacity);
+}
+
+/************************************************************************/
+/*                       CPLPackedRTreeDestroy()                        */
+/************************************************************************/
+
+/**
+ * Destroy a packed R-tree.
+ *
+ * The elements are not freed.
+ *
+ * @param hTree the tree, or NULL.
+ * @since GDAL 3.1
+ */
+
+void CPLPackedRTreeDestroy( CPLPackedRTree *hTree )
+{
+    if( hTree == nullptr )
+        return;
+    VSIFree(hTree->pabyBuffer);
+    CPLFree(hTree);
+}
+
+/************************************************************************/
+/*                   CPLPackedRTreeGetFeatureCount()                    */
+/************************************************************************/
+
+/**
+ * Return the number of elements of a packed R-tree.
+ *
+ * @param hTree the tree
+ * @return the number of elements
+ * @since GDAL 3.1
+ */
+
+int CPLPackedRTreeGetFeatureCount( const CPLPackedRTree *hTree )
+{
+    CPLAssert(hTree);
+    return hTree->nFeatures;
+}
+
+/************************************************************************/
+/*                        CPLPackedRTreeVisitNode()                     */
+/************************************************************************/
+
+// Visits the children of the iNode-th node of level iLevel. The recursion
+// depth is the number of levels, so no stack needs to be allocated.
+static bool CPLPackedRTreeVisitNode( const CPLPackedRTree *hTree,
+                                     int iLevel, size_t iNode,
+                                     const CPLRectObj* pAoi,
+                                     CPLQuadTreeForeachFunc pfnVisit,
+                                     void* pUserData )
+{
+    const size_t nChildLevelStart = hTree->anLevelStart[iLevel - 1];
+    const size_t nChildLevelEnd = hTree->anLevelStart[iLevel];
+    const size_t nStart = nChildLevelStart + iNode * hTree->nNodeCapacity;
+    const size_t nEnd = std::min(nChildLevelEnd,
+                                 nStart + hTree->nNodeCapacity);
+    for( size_t i = nStart; i < nEnd; i++ )
+    {
+        if( !CPL_RectOverlap(&hTree->pasBoxes[i], pAoi) )
+            continue;
+        if( iLevel == 1 )
+        {
+            if( pfnVisit(hTree->pahFeatures[i], pUserData) == FALSE )
+                return false;
+        }
+        else if( !CPLPackedRTreeVisitNode(hTree, iLevel - 1,
+                                          i - nChildLevelStart, pAoi,
+                                          pfnVisit, pUserData) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                        CPLPackedRTreeVisit()                         */
+/************************************************************************/
+
+/**
+ * Run a function on the elements whose bounding box intersects an area of
+ * interest
+ *
+ * The function must return TRUE to go on with the next elements, or FALSE
+ * to stop. This function does not allocate memory, and may be called
+ * from several threads at the same time on the same tree.
+ *
+ * @param hTree the tree
+ * @param pAoi the area of interest
+ * @param pfnVisit the function called on each element.
+ * @param pUserData the user data provided to the function.
+ *
+ * @return FALSE if the visit was stopped by pfnVisit, TRUE otherwise.
+ * @since GDAL 3.1
+ */
+
+int CPLPackedRTreeVisit( const CPLPackedRTree *hTree,
+                         const CPLRectObj* pAoi,
+                         CPLQuadTreeForeachFunc pfnVisit,
+                         void* pUserData )
+{
+    CPLAssert(hTree);
+    CPLAssert(pAoi);
+    CPLAssert(pfnVisit);
+
+    if( hTree->nLevels == 0 )
+        return TRUE;
+    const size_t nRoot = hTree->anLevelStart[hTree->nLevels - 1];
+    if( !CPL_RectOverlap(&hTree->pasBoxes[nRoot], pAoi) )
+        return TRUE;
+    if( hTree->nLevels == 1 )
+        return pfnVisit(hTree->pahFeatures[0], pUserData) != FALSE;
+    return CPLPackedRTreeVisitNode(hTree, hTree->nLevels - 1, 0, pAoi,
+                                   pfnVisit, pUserData);
+}
+
+/************************************************************************/
+/*                        CPLPackedRTreeSearch()                        */
+/************************************************************************/
+
+namespace {
+struct CPLPackedRTreeSearchResult
+{
+    int     nCount;
+    int     nMaxCount;
+    void  **pahFeatures;
+};
+} // namespace
+
+static int CPLPackedRTreeAppendFeature( void* pElt, void* pUserData )
+{
+    CPLPackedRTreeSearchResult* psResult =
+        static_cast<CPLPackedRTreeSearchResult *>(pUserData);
+    if( psResult->nCount == psResult->nMaxCount )
+    {
+        psResult->nMaxCount = psResult->nMaxCount * 2 + 20;
+        psResult->pahFeatures = static_cast<void **>(
+            CPLRealloc(psResult->pahFeatures,
+                       sizeof(void*) * psResult->nMaxCount));
+    }
+    psResult->pahFeatures[psResult->nCount++] = pElt;
+    return TRUE;
+}
+
+/**
+ * Returns all the elements whose bounding box intersects the provided
+ * area of interest
+ *
+ * Use CPLPackedRTreeVisit() to avoid the allocation of the returned array.
+ *
+ * @param hTree the tree
+ * @param pAoi the pointer to the area of interest
+ * @param pnFeatureCount pointer to the number of returned elements.
+ *
+ * @return an array of features that must be freed with CPLFree
+ * @since GDAL 3.1
+ */
+
+void** CPLPackedRTreeSearch( const CPLPackedRTree *hTree,
+                             const CPLRectObj* pAoi,
+                             int* pnFeatureCount )
+{
+    CPLPackedRTreeSearchResult sResult = { 0, 0, nullptr };
+    CPLPackedRTreeVisit(hTree, pAoi, CPLPackedRTreeAppendFeature, &sResult);
+    if( pnFeatureCount )
+        *pnFeatureCount = sResult.nCount;
+    return sResult.pahFeatures;
+}
@@ -44,6 +44,9 @@
  * has up to four children. Quadtrees are most often used to partition
  * a two dimensional space by recursively subdividing it into four
  * quadrants or regions
+ *
+ * This file also declares a packed R-tree, built once from all its
+ * elements, and stored in a single buffer.
  */
 
 CPL_C_START
@@ -103,6 +106,28 @@ void        CPL_DLL   CPLQuadTreeGetStats(const CPLQuadTree *hQuadtree,
                                           int* pnMaxDepth,
                                           int* pnMaxBucketCapacity);
 
+/** Opaque type for a packed R-tree */
+typedef struct _CPLPackedRTree CPLPackedRTree;
+
+CPLPackedRTree CPL_DLL *CPLPackedRTreeCreate(int nFeatures,
+                                             void* const* pahFeatures,
+                                             const CPLRectObj* pasBounds,
+                                             CPLQuadTreeGetBoundsFunc pfnGetBounds,
+                                             int nNodeCapacity);
+CPLPackedRTree CPL_DLL *CPLPackedRTreeCreateFromQuadTree(const CPLQuadTree *hQuadTree,
+                                                         int nNodeCapacity);
+void        CPL_DLL   CPLPackedRTreeDestroy(CPLPackedRTree *hTree);
+
+int         CPL_DLL   CPLPackedRTreeGetFeatureCount(const CPLPackedRTree *hTree);
+
+void        CPL_DLL **CPLPackedRTreeSearch(const CPLPackedRTree *hTree,
+                                           const CPLRectObj* pAoi,
+                                           int* pnFeatureCount);
+int         CPL_DLL   CPLPackedRTreeVisit(const CPLPackedRTree *hTree,
+                                          const CPLRectObj* pAoi,
+                                          CPLQuadTreeForeachFunc pfnVisit,
+                                          void* pUserData);
+
 CPL_C_END
 
 #endif
@@ -29,6 +29,7 @@
 
 #include "cpl_port.h"
 #include "cpl_conv.h"
+#include "cpl_double_conv.h"
 
 #include <cerrno>
 #include <clocale>
@@ -276,6 +277,19 @@ double CPLStrtodDelim(const char *nptr, char **endptr, char point)
         return std::numeric_limits<double>::quiet_NaN();
     }
 
+/* -------------------------------------------------------------------- */
+/*      Most numbers are converted without the C library.               */
+/* -------------------------------------------------------------------- */
+    {
+        double dfValue = 0.0;
+        const char* pszEnd = nullptr;
+        if( CPLStrtodFast(nptr, point, &dfValue, &pszEnd) )
+        {
+            if( endptr ) *endptr = const_cast<char *>(pszEnd);
+            return dfValue;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*  We are implementing a simple method here: copy the input string     */
 /*  into the temporary buffer, replace the specified decimal delimiter  */
@@ -0,0 +1,468 @@
+/******************************************************************************
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Low overhead tracing of scoped spans and counters, written in
+ *           the Chrome trace event format.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "cpl_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_multiproc.h"
+#include "cpl_spawn.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+CPL_CVSID("$Id$")
+
+namespace {
+
+/************************************************************************/
+/*                             TraceEvent                               */
+/************************************************************************/
+
+struct TraceEvent
+{
+    const char *pszCategory;
+    const char *pszName;
+    const char *pszArgName;
+    GIntBig     nArgValue;
+    double      dfTimestamp;    // in microseconds
+    double      dfDuration;     // in microseconds, negative for a counter
+};
+
+/************************************************************************/
+/*                             TraceBuffer                              */
+/*                                                                      */
+/*      Ring buffer of the events of a thread. Only the thread writes   */
+/*      into it. CPLTraceFlush() reads it concurrently, and discards    */
+/*      the events that were overwritten while it was copying them.     */
+/************************************************************************/
+
+struct TraceBuffer
+{
+    const int               nThreadIndex;
+    std::vector<TraceEvent> asEvents;
+    std::atomic<GUIntBig>   nWritten{0};
+
+    TraceBuffer( int nThreadIndexIn, size_t nEvents ) :
+        nThreadIndex(nThreadIndexIn), asEvents(nEvents) {}
+
+    void Add( const TraceEvent& sEvent )
+    {
+        const GUIntBig nIdx = nWritten.load(std::memory_order_relaxed);
+        asEvents[static_cast<size_t>(nIdx % asEvents.size())] = sEvent;
+        nWritten.store(nIdx + 1, std::memory_order_release);
+    }
+
+    void Copy( std::vector<TraceEvent>& asOut ) const
+    {
+        const GUIntBig nCapacity = asEvents.size();
+        const GUIntBig nEnd = nWritten.load(std::memory_order_acquire);
+        const GUIntBig nStart = nEnd > nCapacity ? nEnd - nCapacity : 0;
+        std::vector<TraceEvent> asCopy;
+        asCopy.reserve(static_cast<size_t>(nEnd - nStart));
+        for( GUIntBig i = nStart; i < nEnd; i++ )
+            asCopy.push_back(asEvents[static_cast<size_t>(i % nCapacity)]);
+        const GUIntBig nEndAfter = nWritten.load(std::memory_order_acquire);
+        const GUIntBig nFirstValid =
+            nEndAfter > nCapacity ? nEndAfter - nCapacity : 0;
+        const size_t nSkip = static_cast<size_t>(
+            std::min(nEnd, std::max(nFirstValid, nStart)) - nStart);
+        asOut.insert(asOut.end(), asCopy.begin() + nSkip, asCopy.end());
+    }
+
+    CPL_DISALLOW_COPY_ASSIGN(TraceBuffer)
+};
+
+struct ThreadTraceBuffer
+{
+    std::shared_ptr<TraceBuffer> poBuffer{};
+    int                          nGeneration = 0;
+};
+
+// -1: GDAL_TRACE_FILE not read yet, 0: disabled, 1: enabled.
+std::atomic<int> gnTraceState(-1);
+// Incremented by CPLTraceStart() and CPLTraceStop(), so that threads
+// allocate a new buffer.
+std::atomic<int> gnTraceGeneration(0);
+
+std::mutex gTraceMutex;
+std::string gosTraceFilename{};
+std::vector<std::shared_ptr<TraceBuffer>> gapoTraceBuffers{};
+std::set<std::string> goTraceStrings{};
+int gnTraceThreadCount = 0;
+size_t gnTraceBufferEvents = 65536;
+
+const std::chrono::steady_clock::time_point goTraceOrigin =
+    std::chrono::steady_clock::now();
+
+/************************************************************************/
+/*                          GetThreadBuffer()                           */
+/************************************************************************/
+
+void FreeThreadTraceBuffer( void* pData )
+{
+    delete static_cast<ThreadTraceBuffer*>(pData);
+}
+
+TraceBuffer* GetThreadBuffer()
+{
+    int bMemoryErrorOccurred = FALSE;
+    ThreadTraceBuffer* psTLS = static_cast<ThreadTraceBuffer*>(
+        CPLGetTLSEx(CTLS_TRACEBUFFER, &bMemoryErrorOccurred));
+    if( bMemoryErrorOccurred )
+        return nullptr;
+    if( psTLS != nullptr && psTLS->poBuffer &&
+        psTLS->nGeneration == gnTraceGeneration.load() )
+    {
+        return psTLS->poBuffer.get();
+    }
+
+    std::lock_guard<std::mutex> oLock(gTraceMutex);
+    if( gnTraceState.load() != 1 )
+        return nullptr;
+    if( psTLS == nullptr )
+    {
+        psTLS = new ThreadTraceBuffer();
+        CPLSetTLSWithFreeFuncEx(CTLS_TRACEBUFFER, psTLS,
+                                FreeThreadTraceBuffer,
+                                &bMemoryErrorOccurred);
+        if( bMemoryErrorOccurred )
+        {
+            delete psTLS;
+            return nullptr;
+        }
+    }
+    psTLS->poBuffer = std::make_shared<TraceBuffer>(++gnTraceThreadCount,
+                                                    gnTraceBufferEvents);
+    psTLS->nGeneration = gnTraceGeneration.load();
+    gapoTraceBuffers.push_back(psTLS->poBuffer);
+    return psTLS->poBuffer.get();
+}
+
+/************************************************************************/
+/*                          AppendJSONString()                          */
+/************************************************************************/
+
+void AppendJSONString( std::string& osOut, const char* pszStr )
+{
+    osOut += '"';
+    for( ; *pszStr; ++pszStr )
+    {
+        const unsigned char ch = static_cast<unsigned char>(*pszStr);
+        if( ch == '"' || ch == '\\' )
+        {
+            osOut += '\\';
+            osOut += static_cast<char>(ch);
+        }
+        else if( ch < 0x20 )
+            osOut += CPLSPrintf("\\u%04X", ch);
+        else
+            osOut += static_cast<char>(ch);
+    }
+    osOut += '"';
+}
+
+/************************************************************************/
+/*                          WriteTraceFile()                            */
+/*                                                                      */
+/*      Must be called with gTraceMutex held.                           */
+/************************************************************************/
+
+bool WriteTraceFile()
+{
+    VSILFILE* fp = VSIFOpenL(gosTraceFilename.c_str(), "wb");
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot create %s",
+                 gosTraceFilename.c_str());
+        return false;
+    }
+
+    const int nPID = CPLGetCurrentProcessID();
+    bool bOK = true;
+    std::string osOut("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool bFirst = true;
+    std::vector<TraceEvent> asEvents;
+    for( const auto& poBuffer : gapoTraceBuffers )
+    {
+        if( !bFirst )
+            osOut += ",\n";
+        bFirst = false;
+        osOut += CPLSPrintf("{\"name\":\"thread_name\",\"ph\":\"M\","
+                            "\"pid\":%d,\"tid\":%d,"
+                            "\"args\":{\"name\":\"GDAL thread %d\"}}",
+                            nPID, poBuffer->nThreadIndex,
+                            poBuffer->nThreadIndex);
+
+        asEvents.clear();
+        poBuffer->Copy(asEvents);
+        for( const TraceEvent& sEvent : asEvents )
+        {
+            osOut += ",\n{\"name\":";
+            AppendJSONString(osOut, sEvent.pszName);
+            osOut += ",\"cat\":";
+            AppendJSONString(osOut, sEvent.pszCategory);
+            if( sEvent.dfDuration >= 0 )
+            {
+                osOut += CPLSPrintf(",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+                                    sEvent.dfTimestamp, sEvent.dfDuration);
+            }
+            else
+            {
+                osOut += CPLSPrintf(",\"ph\":\"C\",\"ts\":%.3f",
+                                    sEvent.dfTimestamp);
+            }
+            osOut += CPLSPrintf(",\"pid\":%d,\"tid\":%d", nPID,
+                                poBuffer->nThreadIndex);
+            if( sEvent.pszArgName )
+            {
+                osOut += ",\"args\":{";
+                AppendJSONString(osOut, sEvent.pszArgName);
+                osOut += CPLSPrintf(":" CPL_FRMT_GIB "}}", sEvent.nArgValue);
+            }
+            else
+            {
+                osOut += '}';
+            }
+
+            if( osOut.size() > 1024 * 1024 )
+            {
+                bOK &= VSIFWriteL(osOut.data(), 1, osOut.size(), fp) ==
+                                                            osOut.size();
+                osOut.clear();
+            }
+        }
+    }
+    osOut += "\n]}\n";
+    bOK &= VSIFWriteL(osOut.data(), 1, osOut.size(), fp) == osOut.size();
+    bOK &= VSIFCloseL(fp) == 0;
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Error while writing %s",
+                 gosTraceFilename.c_str());
+    }
+    return bOK;
+}
+
+} // namespace
+
+/************************************************************************/
+/*                         CPLTraceIsEnabled()                          */
+/************************************************************************/
+
+/** Returns whether tracing is enabled.
+ *
+ * The first call starts tracing if the GDAL_TRACE_FILE configuration
+ * option is set.
+ *
+ * @since GDAL 3.1
+ */
+int CPLTraceIsEnabled()
+{
+    const int nState = gnTraceState.load(std::memory_order_relaxed);
+    if( nState >= 0 )
+        return nState;
+
+    const char* pszFilename = CPLGetConfigOption("GDAL_TRACE_FILE", nullptr);
+    if( pszFilename != nullptr && pszFilename[0] != '\0' )
+        return CPLTraceStart(pszFilename);
+    int nExpected = -1;
+    gnTraceState.compare_exchange_strong(nExpected, 0);
+    return gnTraceState.load();
+}
+
+/************************************************************************/
+/*                           CPLTraceStart()                            */
+/************************************************************************/
+
+/** Starts tracing into the specified file.
+ *
+ * Previously recorded events are discarded. The file is created here, and
+ * written by CPLTraceFlush() and CPLTraceStop().
+ *
+ * @param pszFilename output filename.
+ * @return TRUE in case of success.
+ * @since GDAL 3.1
+ */
+int CPLTraceStart( const char* pszFilename )
+{
+    std::lock_guard<std::mutex> oLock(gTraceMutex);
+    if( gnTraceState.load() == 1 && gosTraceFilename == pszFilename )
+        return TRUE;
+
+    VSILFILE* fp = VSIFOpenL(pszFilename, "wb");
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot create %s", pszFilename);
+        gnTraceState.store(0);
+        return FALSE;
+    }
+    VSIFCloseL(fp);
+
+    gosTraceFilename = pszFilename;
+    gnTraceBufferEvents = static_cast<size_t>(std::max(1024, std::min(
+        16 * 1024 * 1024,
+        atoi(CPLGetConfigOption("GDAL_TRACE_BUFFER_EVENTS", "65536")))));
+    gapoTraceBuffers.clear();
+    gnTraceThreadCount = 0;
+    gnTraceGeneration++;
+    gnTraceState.store(1);
+    return TRUE;
+}
+
+/************************************************************************/
+/*                           CPLTraceFlush()                            */
+/************************************************************************/
+
+/** Writes the events recorded so far into the trace file.
+ *
+ * Events are kept, so that the file can be rewritten later with more
+ * events.
+ *
+ * @return TRUE in case of success, FALSE if an error occurred or tracing
+ * is not enabled.
+ * @since GDAL 3.1
+ */
+int CPLTraceFlush()
+{
+    std::lock_guard<std::mutex> oLock(gTraceMutex);
+    if( gnTraceState.load() != 1 )
+        return FALSE;
+    return WriteTraceFile();
+}
+
+/************************************************************************/
+/*                            CPLTraceStop()                            */
+/************************************************************************/
+
+/** Writes the trace file and stops tracing.
+ *
+ * @since GDAL 3.1
+ */
+void CPLTraceStop()
+{
+    std::lock_guard<std::mutex> oLock(gTraceMutex);
+    if( gnTraceState.load() == 1 )
+        WriteTraceFile();
+    gnTraceState.store(0);
+    gnTraceGeneration++;
+    gapoTraceBuffers.clear();
+    gosTraceFilename.clear();
+}
+
+/************************************************************************/
+/*                        CPLTraceGetTimestamp()                        */
+/************************************************************************/
+
+/** Returns the number of microseconds elapsed since an arbitrary origin.
+ *
+ * @since GDAL 3.1
+ */
+double CPLTraceGetTimestamp()
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - goTraceOrigin).count();
+}
+
+/************************************************************************/
+/*                        CPLTraceInternString()                        */
+/************************************************************************/
+
+/** Returns a copy of a string that remains valid until the process ends,
+ * to be used as the name or category of an event.
+ *
+ * @since GDAL 3.1
+ */
+const char* CPLTraceInternString( const char* pszStr )
+{
+    std::lock_guard<std::mutex> oLock(gTraceMutex);
+    return goTraceStrings.insert(pszStr).first->c_str();
+}
+
+/************************************************************************/
+/*                          CPLTraceAddSpan()                           */
+/************************************************************************/
+
+/** Records a span.
+ *
+ * The strings must remain valid until the trace is written.
+ *
+ * @param pszCategory category of the span.
+ * @param pszName name of the span.
+ * @param dfStart start time, as returned by CPLTraceGetTimestamp().
+ * @param dfDuration duration in microseconds.
+ * @param pszArgName name of the argument of the span, or nullptr.
+ * @param nArgValue value of the argument.
+ * @since GDAL 3.1
+ */
+void CPLTraceAddSpan( const char* pszCategory, const char* pszName,
+                      double dfStart, double dfDuration,
+                      const char* pszArgName, GIntBig nArgValue )
+{
+    if( gnTraceState.load(std::memory_order_relaxed) != 1 )
+        return;
+    TraceBuffer* poBuffer = GetThreadBuffer();
+    if( poBuffer == nullptr )
+        return;
+    const TraceEvent sEvent = { pszCategory, pszName, pszArgName, nArgValue,
+                                dfStart, std::max(0.0, dfDuration) };
+    poBuffer->Add(sEvent);
+}
+
+/************************************************************************/
+/*                         CPLTraceAddCounter()                         */
+/************************************************************************/
+
+/** Records the current value of a counter.
+ *
+ * @param pszCategory category of the counter.
+ * @param pszName name of the counter.
+ * @param nValue value.
+ * @since GDAL 3.1
+ */
+void CPLTraceAddCounter( const char* pszCategory, const char* pszName,
+                         GIntBig nValue )
+{
+    if( gnTraceState.load(std::memory_order_relaxed) != 1 )
+        return;
+    TraceBuffer* poBuffer = GetThreadBuffer();
+    if( poBuffer == nullptr )
+        return;
+    const TraceEvent sEvent = { pszCategory, pszName, "value", nValue,
+                                CPLTraceGetTimestamp(), -1.0 };
+    poBuffer->Add(sEvent);
+}
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Low overhead tracing of scoped spans and counters, written in
+ *           the Chrome trace event format.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL project contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef CPL_TRACE_H_INCLUDED
+#define CPL_TRACE_H_INCLUDED
+
+#include "cpl_port.h"
+
+/**
+ * \file cpl_trace.h
+ *
+ * Tracing of spans and counters into per-thread ring buffers, written as a
+ * Chrome trace event JSON file, that can be loaded in chrome://tracing or
+ * https://ui.perfetto.dev .
+ *
+ * Tracing is started by setting the GDAL_TRACE_FILE configuration option
+ * to the output filename, or with CPLTraceStart(). The file is written by
+ * CPLTraceFlush(), CPLTraceStop() and GDALDestroyDriverManager(). Each
+ * thread keeps its last GDAL_TRACE_BUFFER_EVENTS events (65536 by default).
+ *
+ * When tracing is disabled, the cost of a span is a call to
+ * CPLTraceIsEnabled().
+ *
+ * @since GDAL 3.1
+ */
+
+CPL_C_START
+
+int CPL_DLL CPLTraceIsEnabled( void );
+int CPL_DLL CPLTraceStart( const char* pszFilename );
+int CPL_DLL CPLTraceFlush( void );
+void CPL_DLL CPLTraceStop( void );
+
+double CPL_DLL CPLTraceGetTimestamp( void );
+const char CPL_DLL *CPLTraceInternString( const char* pszStr );
+
+void CPL_DLL CPLTraceAddSpan( const char* pszCategory, const char* pszName,
+                              double dfStart, double dfDuration,
+                              const char* pszArgName, GIntBig nArgValue );
+void CPL_DLL CPLTraceAddCounter( const char* pszCategory,
+                                 const char* pszName, GIntBig nValue );
+
+CPL_C_END
+
+#if defined(__cplusplus) && !defined(CPL_SUPRESS_CPLUSPLUS)
+
+/** Records a span from its construction to its destruction.
+ *
+ * The strings must remain valid until the trace is written: use string
+ * literals, or CPLTraceInternString() for other strings.
+ *
+ * @since GDAL 3.1
+ */
+class CPLTraceScope
+{
+    const char *m_pszName = nullptr; // nullptr if tracing is disabled
+    const char *m_pszCategory = nullptr;
+    const char *m_pszArgName = nullptr;
+    GIntBig     m_nArgValue = 0;
+    double      m_dfStart = 0.0;
+
+    CPL_DISALLOW_COPY_ASSIGN(CPLTraceScope)
+
+  public:
+    CPLTraceScope( const char* pszCategory, const char* pszName,
+                   const char* pszArgName = nullptr, GIntBig nArgValue = 0 )
+    {
+        if( CPLTraceIsEnabled() )
+        {
+            m_pszName = pszName;
+            m_pszCategory = pszCategory;
+            m_pszArgName = pszArgName;
+            m_nArgValue = nArgValue;
+            m_dfStart = CPLTraceGetTimestamp();
+        }
+    }
+
+    ~CPLTraceScope()
+    {
+        if( m_pszName )
+            CPLTraceAddSpan( m_pszCategory, m_pszName, m_dfStart,
+                             CPLTraceGetTimestamp() - m_dfStart,
+                             m_pszArgName, m_nArgValue );
+    }
+
+    /** Whether the span is recorded. */
+    bool IsEnabled() const { return m_pszName != nullptr; }
+
+    /** Sets the argument of the span, e.g. a number of bytes known at
+     * the end of the span. */
+    void SetArg( const char* pszArgName, GIntBig nArgValue )
+    {
+        m_pszArgName = pszArgName;
+        m_nArgValue = nArgValue;
+    }
+};
+
+#ifndef DOXYGEN_SKIP
+#define CPL_TRACE_CONCAT_(a, b) a##b
+#define CPL_TRACE_CONCAT(a, b) CPL_TRACE_CONCAT_(a, b)
+#endif
+
+/** Declares a CPLTraceScope spanning until the end of the current block. */
+#define CPL_TRACE_SCOPE(category, name) \
+    CPLTraceScope CPL_TRACE_CONCAT(oTraceScope, __LINE__)(category, name)
+
+#endif /* __cplusplus */
+
+#endif /* CPL_TRACE_H_INCLUDED */
@@ -39,6 +39,8 @@
 #include "cpl_virtualmem.h"
 
 #include <cassert>
+
+#include <algorithm>
 // TODO(schwehr): Should ucontext.h be included?
 // #include <ucontext.h>
 
@@ -182,6 +184,8 @@ typedef struct
                                                    // mapped.
     CPLVirtualMemUnCachePageCbk   pfnUnCachePage;  // Called when a (writable)
                                                    // page is unmapped.
+    CPLVirtualMemGetClusterCbk    pfnGetCluster;   // Range of pages to fill
+                                                   // at once. Might be NULL.
 
 #ifndef HAVE_5ARGS_MREMAP
     CPLMutex               *hMutexThreadArray;
@@ -817,6 +821,96 @@ void CPLVirtualMemAddPage( CPLVirtualMemVMA* ctxt, void* target_addr,
     }
 }
 
+/************************************************************************/
+/*                      CPLVirtualMemFillCluster()                      */
+/************************************************************************/
+
+// Fill the not yet mapped pages of the range returned by pfnGetCluster for
+// the faulting page with a single call to pfnCachePage. Returns false if
+// only the faulting page must be filled.
+static
+bool CPLVirtualMemFillCluster( CPLVirtualMemVMA* ctxt, char* start_page_addr,
+                               const CPLVirtualMemMsgToWorkerThread* msg )
+{
+    const size_t nPageSize = ctxt->sBase.nPageSize;
+    const size_t nPageOffset =
+        start_page_addr - static_cast<char*>(ctxt->sBase.pData);
+    size_t nClusterOffset = nPageOffset;
+    size_t nClusterSize = nPageSize;
+    ctxt->pfnGetCluster(reinterpret_cast<CPLVirtualMem*>(ctxt),
+                        nPageOffset, &nClusterOffset, &nClusterSize,
+                        ctxt->sBase.pCbkUserData);
+
+    const size_t iPage = nPageOffset / nPageSize;
+    size_t iFirstPage = std::min(nClusterOffset, nPageOffset) / nPageSize;
+    size_t nClusterEnd = ctxt->sBase.nSize;
+    if( nClusterOffset < ctxt->sBase.nSize &&
+        nClusterSize < ctxt->sBase.nSize - nClusterOffset )
+        nClusterEnd = nClusterOffset + nClusterSize;
+    size_t iEndPage = std::max( (nClusterEnd + nPageSize - 1) / nPageSize,
+                                iPage + 1 );
+
+    // Leave room in the LRU for the pages of the previous accesses, a rep movs
+    // instruction needing two pages.
+    const size_t nMaxPages =
+        static_cast<size_t>(std::max(1, ctxt->nCacheMaxSizeInPages / 2));
+    if( iEndPage - iFirstPage > nMaxPages )
+    {
+        iFirstPage = iPage;
+        iEndPage = std::min(iEndPage, iPage + nMaxPages);
+    }
+    // Do not fill again the pages still mapped at both ends.
+    while( iFirstPage < iPage &&
+           TEST_BIT(ctxt->pabitMappedPages, static_cast<int>(iFirstPage)) )
+        iFirstPage++;
+    while( iEndPage > iPage + 1 &&
+           TEST_BIT(ctxt->pabitMappedPages, static_cast<int>(iEndPage - 1)) )
+        iEndPage--;
+    if( iEndPage - iFirstPage <= 1 )
+        return false;
+
+    const size_t nFillOffset = iFirstPage * nPageSize;
+    const size_t nToFill =
+        std::min( (iEndPage - iFirstPage) * nPageSize,
+                  ctxt->sBase.nSize - nFillOffset );
+    GByte* pabyCluster = static_cast<GByte*>(VSI_MALLOC_VERBOSE(nToFill));
+    if( pabyCluster == nullptr )
+        return false;
+
+#if defined DEBUG_VIRTUALMEM && defined DEBUG_VERBOSE
+    fprintfstderr("filling pages %d to %d\n",
+                  static_cast<int>(iFirstPage),
+                  static_cast<int>(iEndPage - 1));
+#endif
+    ctxt->pfnCachePage(reinterpret_cast<CPLVirtualMem*>(ctxt),
+                       nFillOffset, pabyCluster, nToFill,
+                       ctxt->sBase.pCbkUserData);
+
+    // The faulting page is added last, so as to be the most recently used.
+    for( size_t i = iFirstPage; i <= iEndPage; i++ )
+    {
+        size_t iCur = i;
+        if( i == iEndPage )
+            iCur = iPage;
+        else if( i == iPage ||
+                 TEST_BIT(ctxt->pabitMappedPages, static_cast<int>(i)) )
+            continue;
+
+        char* const addr = static_cast<char*>(ctxt->sBase.pData) +
+                           iCur * nPageSize;
+        void * const pPageToFill = CPLVirtualMemGetPageToFill(ctxt, addr);
+        const size_t nPos = (iCur - iFirstPage) * nPageSize;
+        memcpy(pPageToFill, pabyCluster + nPos,
+               std::min(nPageSize, nToFill - nPos));
+        CPLVirtualMemAddPage(ctxt, addr, pPageToFill,
+                             iCur == iPage ? msg->opType : OP_LOAD,
+                             msg->hRequesterThread);
+    }
+
+    VSIFree(pabyCluster);
+    return true;
+}
+
 /************************************************************************/
 /*                    CPLVirtualMemGetOpTypeImm()                       */
 /************************************************************************/
@@ -1593,6 +1687,19 @@ void CPLVirtualMemPin( CPLVirtualMem* ctxt,
     }
 }
 
+/************************************************************************/
+/*                  CPLVirtualMemSetClusterCallback()                   */
+/************************************************************************/
+
+void CPLVirtualMemSetClusterCallback( CPLVirtualMem* ctxt,
+                                      CPLVirtualMemGetClusterCbk pfnGetCluster )
+{
+    // Derived mappings share the pages of their base mapping.
+    if( ctxt->eType != VIRTUAL_MEM_TYPE_VMA || ctxt->pVMemBase != nullptr )
+        return;
+    reinterpret_cast<CPLVirtualMemVMA*>(ctxt)->pfnGetCluster = pfnGetCluster;
+}
+
 /************************************************************************/
 /*                   CPLVirtualMemManagerSIGSEGVHandler()               */
 /************************************************************************/
@@ -1813,7 +1920,9 @@ static void CPLVirtualMemManagerThread( void* /* unused_param */ )
 #endif
                     }
                 }
-                else
+                else if( ctxt->pfnGetCluster == nullptr ||
+                         !CPLVirtualMemFillCluster(ctxt, start_page_addr,
+                                                   &msg) )
                 {
                     void * const pPageToFill =
                         CPLVirtualMemGetPageToFill(ctxt, start_page_addr);
@@ -1984,6 +2093,11 @@ void CPLVirtualMemPin( CPLVirtualMem* /* ctxt */,
                        int /* bWriteOp */)
 {}
 
+void CPLVirtualMemSetClusterCallback(
+    CPLVirtualMem* /* ctxt */,
+    CPLVirtualMemGetClusterCbk /* pfnGetCluster */ )
+{}
+
 void CPLVirtualMemManagerTerminate( void ) {}
 
 #endif  // HAVE_VIRTUAL_MEM_VMA
@@ -93,6 +93,30 @@ typedef void (*CPLVirtualMemUnCachePageCbk)(CPLVirtualMem* ctxt,
                                       size_t nToBeEvicted,
                                       void* pUserData);
 
+/** Callback triggered when a still unmapped page of virtual memory is
+  * accessed, before pfnCachePage, to extend the range of bytes that will be
+  * filled at once.
+  *
+  * The range is rounded to whole pages, and only its pages that are not
+  * already mapped are mapped. It is typically set to the scanlines of the
+  * row of tiles of the faulting page, so that compressed tiles are decoded
+  * only once.
+  *
+  * @param ctxt virtual memory handle.
+  * @param nOffset offset of the page in the memory mapping.
+  * @param pnClusterOffset pointer to the offset of the range, initialized to
+  *                        nOffset.
+  * @param pnClusterSize pointer to the size of the range, initialized to the
+  *                      page size.
+  * @param pUserData user data that was passed to CPLVirtualMemNew().
+  * @since GDAL 3.1
+  */
+typedef void (*CPLVirtualMemGetClusterCbk)(CPLVirtualMem* ctxt,
+                                           size_t nOffset,
+                                           size_t* pnClusterOffset,
+                                           size_t* pnClusterSize,
+                                           void* pUserData);
+
 /** Callback triggered when a virtual memory mapping is destroyed.
   * @param pUserData user data that was passed to CPLVirtualMemNew().
  */
@@ -375,6 +399,24 @@ void CPL_DLL CPLVirtualMemUnDeclareThread(CPLVirtualMem* ctxt);
 void CPL_DLL CPLVirtualMemPin(CPLVirtualMem* ctxt,
                               void* pAddr, size_t nSize, int bWriteOp);
 
+/** Install a callback that extends the range of memory filled when a page
+ * is accessed.
+ *
+ * pfnCachePage is then called once for the whole range, rounded to pages,
+ * and the pages of the range that are not yet mapped are mapped as if they
+ * had been read. Their number is limited to half of the cache size.
+ *
+ * This function must be called before the mapping is accessed.
+ *
+ * @param ctxt context returned by CPLVirtualMemNew().
+ * @param pfnGetCluster the callback, or NULL to fill one page at a time.
+ *
+ * @since GDAL 3.1
+ */
+void CPL_DLL CPLVirtualMemSetClusterCallback(
+                                CPLVirtualMem* ctxt,
+                                CPLVirtualMemGetClusterCbk pfnGetCluster);
+
 /** Cleanup any resource and handlers related to virtual memory.
  *
  * This function must be called after the last CPLVirtualMem object has
@@ -224,6 +224,41 @@ const char CPL_DLL *VSIGetFileSystemOptions( const char* pszFilename );
 
 char CPL_DLL **VSIGetFileSystemsPrefixes( void );
 
+/** Number of buckets of VSIIOStatistics::anHTTPLatencyHistogram.
+ *
+ * The upper bounds of the buckets are 1, 2, 5, 10, 20, 50, 100, 200, 500,
+ * 1000, 2000, 5000 and 10000 milliseconds; the last bucket collects the
+ * requests that took longer.
+ * @since GDAL 3.1
+ */
+#define VSI_HTTP_LATENCY_BUCKET_COUNT 14
+
+/** Cumulative I/O statistics returned by VSIGetIOStatistics() and
+ * VSIFGetIOStatisticsL().
+ * @since GDAL 3.1
+ */
+typedef struct
+{
+    GUIntBig nOpens;                /**< Number of successful opens */
+    GUIntBig nReads;                /**< Number of read requests */
+    GUIntBig nBytesRead;            /**< Number of bytes returned by reads */
+    GUIntBig nWrites;               /**< Number of write requests */
+    GUIntBig nBytesWritten;         /**< Number of bytes written */
+    GUIntBig nSeeks;                /**< Number of seeks */
+    GUIntBig nHTTPRequests;         /**< Number of HTTP requests */
+    GUIntBig nHTTPErrors;           /**< Number of failed HTTP requests */
+    GUIntBig nHTTPBytesDownloaded;  /**< Bytes received by HTTP requests */
+    GUIntBig nHTTPBytesUploaded;    /**< Bytes sent by HTTP requests */
+    double   dfHTTPTotalTime;       /**< Cumulated HTTP time, in seconds */
+    /** Number of HTTP requests per latency bucket */
+    GUIntBig anHTTPLatencyHistogram[VSI_HTTP_LATENCY_BUCKET_COUNT];
+} VSIIOStatistics;
+
+int CPL_DLL     VSIGetIOStatistics( const char* pszPrefix,
+                                    VSIIOStatistics* psStats );
+int CPL_DLL     VSIFGetIOStatisticsL( VSILFILE* fp, VSIIOStatistics* psStats );
+void CPL_DLL    VSIResetIOStatistics( void );
+
 void CPL_DLL   *VSIFGetNativeFileDescriptorL( VSILFILE* );
 
 /* ==================================================================== */
@@ -304,6 +339,9 @@ GIntBig CPL_DLL CPLGetUsablePhysicalRAM(void);
 char CPL_DLL **VSIReadDir( const char * );
 char CPL_DLL **VSIReadDirRecursive( const char *pszPath );
 char CPL_DLL **VSIReadDirEx( const char *pszPath, int nMaxFiles );
+char CPL_DLL **VSIReadDirCached( const char *pszPath, int nMaxFiles );
+char CPL_DLL **VSIGetCachedDirListing( const char *pszPath );
+void CPL_DLL VSIClearDirListingCache( const char *pszPath );
 
 /** Opaque type for a directory iterator */
 typedef struct VSIDIR VSIDIR;
@@ -404,6 +442,27 @@ GByte CPL_DLL *VSIGetMemFileBuffer( const char *pszFilename,
                                     vsi_l_offset *pnDataLength,
                                     int bUnlinkAndSeize );
 
+/** Callback releasing a buffer adopted by VSIFileFromMemBufferEx().
+ * @since GDAL 3.1
+ */
+typedef void (*VSIMemBufferFreeFunc)( void* pUserData, GByte* pabyData );
+
+/** Flag of VSIFileFromMemBufferEx() to create a read-only file.
+ * @since GDAL 3.1
+ */
+#define VSI_MEM_BUFFER_READ_ONLY 0x1
+
+VSILFILE CPL_DLL *VSIFileFromMemBufferEx( const char *pszFilename,
+                                    GByte *pabyData,
+                                    vsi_l_offset nDataLength,
+                                    int nFlags,
+                                    VSIMemBufferFreeFunc pfnFree,
+                                    void *pFreeUserData ) CPL_WARN_UNUSED_RESULT;
+const GByte CPL_DLL *VSIGetMemFileView( const char *pszFilename,
+                                    vsi_l_offset *pnDataLength,
+                                    void **phView );
+void CPL_DLL VSIReleaseMemFileView( void *hView );
+
 /** Callback used by VSIStdoutSetRedirection() */
 typedef size_t (*VSIWriteFunction)(const void* ptr, size_t size, size_t nmemb, FILE* stream);
 void CPL_DLL VSIStdoutSetRedirection( VSIWriteFunction pFct, FILE* stream );
@@ -41,6 +41,10 @@
 #if HAVE_SYS_STAT_H
 #  include <sys/stat.h>
 #endif
+#if defined(HAVE_MMAP) && defined(HAVE_5ARGS_MREMAP)
+#  include <sys/mman.h>
+#  define VSIMEM_USE_MREMAP
+#endif
 
 #include <algorithm>
 #include <map>
@@ -71,6 +75,11 @@ CPL_CVSID("$Id: cpl_vsi_mem.cpp cc40f285204d363d762804d7b9b4cd136384e85a 2018-11
 ** multiple reader as an expectation on the application code (not enforced
 ** here), which means we don't need to do any protection of this class.
 **
+**
+** Views returned by VSIGetMemFileView() hold a reference on the VSIMemFile
+** and pin its buffer: the file cannot be extended beyond its allocation
+** while views exist, since this could move the buffer.
+**
 ** VSIMemHandle: This is essentially a "current location" representing
 ** on accessor to a file, and is inherently intended only to be used in
 ** a single thread.
@@ -106,12 +115,27 @@ public:
     vsi_l_offset  nAllocLength = 0;
     vsi_l_offset  nMaxLength = GUINTBIG_MAX;
 
+    // Owned buffers are allocated with VSIMalloc(), or with mmap() once
+    // they are large enough, so that they grow with mremap() rather than
+    // with copies. Adopted buffers are released with pfnFree.
+    bool          bMMap = false;
+    VSIMemBufferFreeFunc pfnFree = nullptr;
+    void         *pFreeUserData = nullptr;
+
+    bool          bReadOnly = false;
+    volatile int  nViewCount = 0;
+
     time_t        mTime = 0;
 
     VSIMemFile();
     virtual ~VSIMemFile();
 
     bool          SetLength( vsi_l_offset nNewSize );
+    void          ReleaseData();
+    GByte        *SeizeData();
+
+  private:
+    bool          Reallocate( vsi_l_offset nNewAlloc );
 };
 
 /************************************************************************/
@@ -211,8 +235,140 @@ VSIMemFile::~VSIMemFile()
                   "Memory file %s deleted with %d references.",
                   osFilename.c_str(), nRefCount );
 
+    ReleaseData();
+}
+
+/************************************************************************/
+/*                            ReleaseData()                             */
+/************************************************************************/
+
+void VSIMemFile::ReleaseData()
+
+{
     if( bOwnData && pabyData )
-        CPLFree( pabyData );
+    {
+        if( pfnFree )
+            pfnFree( pFreeUserData, pabyData );
+#ifdef VSIMEM_USE_MREMAP
+        else if( bMMap )
+            munmap( pabyData, static_cast<size_t>(nAllocLength) );
+#endif
+        else
+            CPLFree( pabyData );
+    }
+    pabyData = nullptr;
+    nAllocLength = 0;
+    bMMap = false;
+    pfnFree = nullptr;
+    pFreeUserData = nullptr;
+}
+
+/************************************************************************/
+/*                             SeizeData()                              */
+/*                                                                      */
+/*      Return the data as a buffer to be freed with VSIFree(), after   */
+/*      copying it if it was not allocated with VSIMalloc().            */
+/************************************************************************/
+
+GByte *VSIMemFile::SeizeData()
+
+{
+    if( !bOwnData )
+    {
+        CPLDebug( "VSIMemFile",
+                  "File doesn't own data in VSIGetMemFileBuffer!" );
+        return pabyData;
+    }
+
+    GByte *pabyRet = pabyData;
+    if( bMMap || pfnFree )
+    {
+        pabyRet = static_cast<GByte *>(VSI_MALLOC_VERBOSE(
+            static_cast<size_t>(std::max(nLength,
+                                         static_cast<vsi_l_offset>(1)))));
+        if( pabyRet != nullptr && nLength )
+            memcpy( pabyRet, pabyData, static_cast<size_t>(nLength) );
+        ReleaseData();
+    }
+    bOwnData = false;
+    pabyData = nullptr;
+    nLength = 0;
+    return pabyRet;
+}
+
+/************************************************************************/
+/*                             Reallocate()                             */
+/************************************************************************/
+
+bool VSIMemFile::Reallocate( vsi_l_offset nNewAlloc )
+
+{
+    if( static_cast<vsi_l_offset>(static_cast<size_t>(nNewAlloc))
+        != nNewAlloc )
+        return false;
+
+#ifdef VSIMEM_USE_MREMAP
+    constexpr vsi_l_offset MMAP_THRESHOLD = 1024 * 1024;
+    if( bMMap )
+    {
+        void* pNewData = mremap( pabyData, static_cast<size_t>(nAllocLength),
+                                 static_cast<size_t>(nNewAlloc),
+                                 MREMAP_MAYMOVE );
+        if( pNewData == MAP_FAILED )
+            return false;
+        // Anonymous mappings are zero initialized.
+        pabyData = static_cast<GByte *>(pNewData);
+        nAllocLength = nNewAlloc;
+        return true;
+    }
+    if( nNewAlloc >= MMAP_THRESHOLD )
+    {
+        void* pNewData = mmap( nullptr, static_cast<size_t>(nNewAlloc),
+                               PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if( pNewData != MAP_FAILED )
+        {
+            GByte *pabyNewData = static_cast<GByte *>(pNewData);
+            if( nLength )
+                memcpy( pabyNewData, pabyData, static_cast<size_t>(nLength) );
+            ReleaseData();
+            pabyData = pabyNewData;
+            nAllocLength = nNewAlloc;
+            bMMap = true;
+            return true;
+        }
+        // Fallback to the heap.
+    }
+#endif
+
+    if( pfnFree )
+    {
+        // Adopted buffers are released by their own allocator, so the
+        // data must be copied once into a buffer of ours.
+        GByte *pabyNewData = static_cast<GByte *>(
+            VSICalloc(1, static_cast<size_t>(nNewAlloc)));
+        if( pabyNewData == nullptr )
+            return false;
+        if( nLength )
+            memcpy( pabyNewData, pabyData, static_cast<size_t>(nLength) );
+        ReleaseData();
+        pabyData = pabyNewData;
+        nAllocLength = nNewAlloc;
+        return true;
+    }
+
+    GByte *pabyNewData = static_cast<GByte *>(
+        VSIRealloc(pabyData, static_cast<size_t>(nNewAlloc) ));
+    if( pabyNewData == nullptr )
+        return false;
+
+    // Clear the new allocated part of the buffer.
+    memset(pabyNewData + nAllocLength, 0,
+           static_cast<size_t>(nNewAlloc - nAllocLength));
+
+    pabyData = pabyNewData;
+    nAllocLength = nNewAlloc;
+    return true;
 }
 
 /************************************************************************/
@@ -247,15 +403,19 @@ bool VSIMemFile::SetLength( vsi_l_offset nNewLength )
             return false;
         }
 
-        const vsi_l_offset nNewAlloc = (nNewLength + nNewLength / 10) + 5000;
-        GByte *pabyNewData = nullptr;
-        if( static_cast<vsi_l_offset>(static_cast<size_t>(nNewAlloc))
-            == nNewAlloc )
+        if( nViewCount > 0 )
         {
-            pabyNewData = static_cast<GByte *>(
-                VSIRealloc(pabyData, static_cast<size_t>(nNewAlloc) ));
+            CPLError(
+                CE_Failure, CPLE_NotSupported,
+                "Cannot extend in-memory file %s while views of its buffer "
+                "exist", osFilename.c_str() );
+            return false;
         }
-        if( pabyNewData == nullptr )
+
+        // Mappings can grow without copies, so a larger headroom is not
+        // needed for them.
+        const vsi_l_offset nNewAlloc = (nNewLength + nNewLength / 10) + 5000;
+        if( !Reallocate( nNewAlloc ) )
         {
             CPLError(
                 CE_Failure, CPLE_OutOfMemory,
@@ -264,13 +424,6 @@ bool VSIMemFile::SetLength( vsi_l_offset nNewLength )
                 nNewAlloc);
             return false;
         }
-
-        // Clear the new allocated part of the buffer.
-        memset(pabyNewData + nAllocLength, 0,
-               static_cast<size_t>(nNewAlloc - nAllocLength));
-
-        pabyData = pabyNewData;
-        nAllocLength = nNewAlloc;
     }
 
     nLength = nNewLength;
@@ -528,6 +681,19 @@ VSIMemFilesystemHandler::Open( const char *pszFilename,
         return nullptr;
     }
 
+    if( poFile != nullptr && poFile->bReadOnly &&
+        (strstr(pszAccess, "w") || strstr(pszAccess, "+") ||
+         strstr(pszAccess, "a")) )
+    {
+        if( bSetError )
+        {
+            VSIError(VSIE_FileError, "%s: Read-only in-memory file",
+                     pszFilename);
+        }
+        errno = EACCES;
+        return nullptr;
+    }
+
     // Create.
     if( poFile == nullptr )
     {
@@ -870,6 +1036,14 @@ void VSIInstallMemFileHandler()
     VSIFileManager::InstallHandler( "/vsimem/", new VSIMemFilesystemHandler );
 }
 
+static VSILFILE *VSIFileFromMemBufferInternal( const char *pszFilename,
+                                               GByte *pabyData,
+                                               vsi_l_offset nDataLength,
+                                               bool bTakeOwnership,
+                                               int nFlags,
+                                               VSIMemBufferFreeFunc pfnFree,
+                                               void *pFreeUserData );
+
 /************************************************************************/
 /*                        VSIFileFromMemBuffer()                        */
 /************************************************************************/
@@ -900,6 +1074,72 @@ VSILFILE *VSIFileFromMemBuffer( const char *pszFilename,
                                 vsi_l_offset nDataLength,
                                 int bTakeOwnership )
 
+{
+    return VSIFileFromMemBufferInternal( pszFilename, pabyData, nDataLength,
+                                         CPL_TO_BOOL(bTakeOwnership), 0,
+                                         nullptr, nullptr );
+}
+
+/************************************************************************/
+/*                       VSIFileFromMemBufferEx()                       */
+/************************************************************************/
+
+/**
+ * \brief Create memory "file" from a buffer, with control on its release.
+ *
+ * Like VSIFileFromMemBuffer(), this function adopts the passed buffer
+ * without copying it. If pfnFree is not NULL, the memory file system
+ * handler takes ownership of the buffer and calls pfnFree(pFreeUserData,
+ * pabyData) when the file is deleted, so that buffers coming from any
+ * allocator can be adopted. If it is NULL, the buffer remains the
+ * responsibility of the caller, but should not be freed as long as it
+ * might be accessed as a file.
+ *
+ * With the VSI_MEM_BUFFER_READ_ONLY flag, the file cannot be opened in
+ * update mode, and the returned handle is read-only.
+ *
+ * A writable adopted file that is extended beyond the size of the buffer is
+ * copied once into a buffer allocated by GDAL, and pfnFree is called on the
+ * original buffer at that time. VSIGetMemFileBuffer() with bUnlinkAndSeize
+ * also returns a copy for such files, since its result must be freed with
+ * VSIFree(); VSIGetMemFileView() gives access to the buffer without copy.
+ *
+ * @param pszFilename the filename to be created.
+ * @param pabyData the data buffer for the file.
+ * @param nDataLength the length of buffer in bytes.
+ * @param nFlags 0 or VSI_MEM_BUFFER_READ_ONLY.
+ * @param pfnFree function releasing the buffer, or NULL.
+ * @param pFreeUserData user data passed to pfnFree.
+ *
+ * @return open file handle on created file (see VSIFOpenL()).
+ * @since GDAL 3.1
+ */
+
+VSILFILE *VSIFileFromMemBufferEx( const char *pszFilename,
+                                  GByte *pabyData,
+                                  vsi_l_offset nDataLength,
+                                  int nFlags,
+                                  VSIMemBufferFreeFunc pfnFree,
+                                  void *pFreeUserData )
+
+{
+    return VSIFileFromMemBufferInternal( pszFilename, pabyData, nDataLength,
+                                         pfnFree != nullptr, nFlags,
+                                         pfnFree, pFreeUserData );
+}
+
+/************************************************************************/
+/*                    VSIFileFromMemBufferInternal()                    */
+/************************************************************************/
+
+static VSILFILE *VSIFileFromMemBufferInternal( const char *pszFilename,
+                                               GByte *pabyData,
+                                               vsi_l_offset nDataLength,
+                                               bool bTakeOwnership,
+                                               int nFlags,
+                                               VSIMemBufferFreeFunc pfnFree,
+                                               void *pFreeUserData )
+
 {
     if( VSIFileManager::GetHandler("")
         == VSIFileManager::GetHandler("/vsimem/") )
@@ -920,10 +1160,13 @@ VSILFILE *VSIFileFromMemBuffer( const char *pszFilename,
     VSIMemFile *poFile = new VSIMemFile;
 
     poFile->osFilename = osFilename;
-    poFile->bOwnData = CPL_TO_BOOL(bTakeOwnership);
+    poFile->bOwnData = bTakeOwnership;
     poFile->pabyData = pabyData;
     poFile->nLength = nDataLength;
     poFile->nAllocLength = nDataLength;
+    poFile->pfnFree = pfnFree;
+    poFile->pFreeUserData = pFreeUserData;
+    poFile->bReadOnly = (nFlags & VSI_MEM_BUFFER_READ_ONLY) != 0;
 
     {
         CPLMutexHolder oHolder( &poHandler->hMutex );
@@ -934,7 +1177,8 @@ VSILFILE *VSIFileFromMemBuffer( const char *pszFilename,
 
     // TODO(schwehr): Fix this so that the using statement is not needed.
     // Will just adding the bool for bSetError be okay?
-    return reinterpret_cast<VSILFILE *>( poHandler->Open( osFilename, "r+" ) );
+    return reinterpret_cast<VSILFILE *>(
+        poHandler->Open( osFilename, poFile->bReadOnly ? "r" : "r+" ) );
 }
 
 /************************************************************************/
@@ -949,6 +1193,11 @@ VSILFILE *VSIFileFromMemBuffer( const char *pszFilename,
  * object will be deleted, and ownership of the buffer will pass to the
  * caller otherwise the underlying file will remain in existence.
  *
+ * When seizing the buffer of a file that was not created from a buffer
+ * allocated with VSIMalloc(), i.e. large files whose storage is mapped
+ * memory or files created with VSIFileFromMemBufferEx(), a copy of the data
+ * is returned. VSIGetMemFileView() gives a zero-copy access in all cases.
+ *
  * @param pszFilename the name of the file to grab the buffer of.
  * @param pnDataLength (file) length returned in this variable.
  * @param bUnlinkAndSeize TRUE to remove the file, or FALSE to leave unaltered.
@@ -983,16 +1232,108 @@ GByte *VSIGetMemFileBuffer( const char *pszFilename,
 
     if( bUnlinkAndSeize )
     {
-        if( !poFile->bOwnData )
-            CPLDebug( "VSIMemFile",
-                      "File doesn't own data in VSIGetMemFileBuffer!" );
-        else
-            poFile->bOwnData = false;
+        if( poFile->nViewCount > 0 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot seize the buffer of %s while views of it exist",
+                      osFilename.c_str() );
+            return nullptr;
+        }
+        pabyData = poFile->SeizeData();
 
         poHandler->oFileList.erase( poHandler->oFileList.find(osFilename) );
         CPLAtomicDec(&(poFile->nRefCount));
-        delete poFile;
+        if( poFile->nRefCount == 0 )
+            delete poFile;
     }
 
     return pabyData;
 }
+
+/************************************************************************/
+/*                         VSIGetMemFileView()                          */
+/************************************************************************/
+
+/**
+ * \brief Get a zero-copy view of the buffer underlying a memory file.
+ *
+ * The returned pointer remains valid until VSIReleaseMemFileView() is
+ * called, even if the file is deleted in the meantime. While views exist,
+ * the file cannot grow beyond its current allocation, and its buffer
+ * cannot be seized, but in-place writes through open handles are visible
+ * through the view.
+ *
+ * A typical use is to send the output of a driver written in /vsimem/
+ * without the copy that VSIGetMemFileBuffer() could involve:
+ *
+ * \code
+ *     void* hView = nullptr;
+ *     vsi_l_offset nLength = 0;
+ *     const GByte* pabyData =
+ *         VSIGetMemFileView("/vsimem/out.png", &nLength, &hView);
+ *     VSIUnlink("/vsimem/out.png");
+ *     Send(pabyData, nLength);
+ *     VSIReleaseMemFileView(hView);
+ * \endcode
+ *
+ * @param pszFilename the name of the file.
+ * @param pnDataLength (file) length returned in this variable.
+ * @param phView handle to pass to VSIReleaseMemFileView(), returned in this
+ * variable.
+ *
+ * @return pointer to memory buffer or NULL on failure.
+ * @since GDAL 3.1
+ */
+
+const GByte *VSIGetMemFileView( const char *pszFilename,
+                                vsi_l_offset *pnDataLength,
+                                void **phView )
+
+{
+    VSIMemFilesystemHandler *poHandler =
+        static_cast<VSIMemFilesystemHandler *>(
+            VSIFileManager::GetHandler("/vsimem/"));
+
+    if( pszFilename == nullptr || phView == nullptr )
+        return nullptr;
+    *phView = nullptr;
+
+    const CPLString osFilename =
+        VSIMemFilesystemHandler::NormalizePath(pszFilename);
+
+    CPLMutexHolder oHolder( &poHandler->hMutex );
+
+    const auto oIter = poHandler->oFileList.find(osFilename);
+    if( oIter == poHandler->oFileList.end() || oIter->second->bIsDirectory )
+        return nullptr;
+
+    VSIMemFile *poFile = oIter->second;
+    CPLAtomicInc(&(poFile->nRefCount));
+    CPLAtomicInc(&(poFile->nViewCount));
+    *phView = poFile;
+    if( pnDataLength != nullptr )
+        *pnDataLength = poFile->nLength;
+    return poFile->pabyData;
+}
+
+/************************************************************************/
+/*                       VSIReleaseMemFileView()                        */
+/************************************************************************/
+
+/**
+ * \brief Release a view returned by VSIGetMemFileView().
+ *
+ * @param hView the view handle, or NULL.
+ * @since GDAL 3.1
+ */
+
+void VSIReleaseMemFileView( void *hView )
+
+{
+    if( hView == nullptr )
+        return;
+    VSIMemFile *poFile = static_cast<VSIMemFile *>(hView);
+    CPLAtomicDec(&(poFile->nViewCount));
+    if( CPLAtomicDec(&(poFile->nRefCount)) == 0 )
+        delete poFile;
+}
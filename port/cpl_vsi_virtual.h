@@ -39,15 +39,55 @@
 #include "cpl_string.h"
 #include "cpl_multiproc.h"
 
+#include <atomic>
 #include <map>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 // To avoid aliasing to GetDiskFreeSpace to GetDiskFreeSpaceA on Windows
 #ifdef GetDiskFreeSpace
 #undef GetDiskFreeSpace
 #endif
 
+/************************************************************************/
+/*                            VSIIOCounters                             */
+/************************************************************************/
+
+#ifndef DOXYGEN_SKIP
+// Cumulative I/O counters of a filesystem handler, updated concurrently by
+// all the threads using it. See VSIGetIOStatistics().
+struct CPL_DLL VSIIOCounters
+{
+    std::atomic<GUIntBig> nOpens{0};
+    std::atomic<GUIntBig> nReads{0};
+    std::atomic<GUIntBig> nBytesRead{0};
+    std::atomic<GUIntBig> nWrites{0};
+    std::atomic<GUIntBig> nBytesWritten{0};
+    std::atomic<GUIntBig> nSeeks{0};
+    std::atomic<GUIntBig> nHTTPRequests{0};
+    std::atomic<GUIntBig> nHTTPErrors{0};
+    std::atomic<GUIntBig> nHTTPBytesDownloaded{0};
+    std::atomic<GUIntBig> nHTTPBytesUploaded{0};
+    std::atomic<GUIntBig> nHTTPTimeMicroSec{0};
+    std::atomic<GUIntBig> anHTTPLatencyHistogram[VSI_HTTP_LATENCY_BUCKET_COUNT];
+
+    VSIIOCounters() { Reset(); }
+
+    void Reset();
+    void AddTo( VSIIOStatistics* psStats ) const;
+
+    CPL_DISALLOW_COPY_ASSIGN(VSIIOCounters)
+};
+
+// Records a completed HTTP request against the handler and the file handle
+// on behalf of which the current thread is doing I/O, or against the
+// unattributed counters of VSIGetIOStatistics(NULL) otherwise.
+void CPL_DLL VSIIOStatsAddHTTPRequest( bool bError, double dfSeconds,
+                                       GUIntBig nBytesDownloaded,
+                                       GUIntBig nBytesUploaded );
+#endif /* #ifndef DOXYGEN_SKIP */
+
 /************************************************************************/
 /*                           VSIVirtualHandle                           */
 /************************************************************************/
@@ -55,6 +95,12 @@
 /** Virtual file handle */
 class CPL_DLL VSIVirtualHandle {
   public:
+#ifndef DOXYGEN_SKIP
+    // I/O statistics, maintained by the VSIF*L() functions.
+    VSIIOCounters    *m_poIOCounters = nullptr;
+    VSIIOStatistics   m_sIOStats{};
+#endif
+
     virtual int       Seek( vsi_l_offset nOffset, int nWhence ) = 0;
     virtual vsi_l_offset Tell() = 0;
     virtual size_t    Read( void *pBuffer, size_t nSize, size_t nCount ) = 0;
@@ -83,6 +129,9 @@ class CPL_DLL VSIVirtualHandle {
 class CPL_DLL VSIFilesystemHandler {
 
 public:
+    // I/O statistics of the files of this handler. See VSIGetIOStatistics().
+    VSIIOCounters m_oIOCounters{};
+
 
     virtual ~VSIFilesystemHandler() {}
 
@@ -151,6 +200,10 @@ public:
     /* static void RemoveHandler( const std::string& osPrefix ); */
 
     static char** GetPrefixes();
+
+    static bool GetIOStatistics( const char* pszPrefix,
+                                 VSIIOStatistics* psStats );
+    static void ResetIOStatistics();
 };
 #endif /* #ifndef DOXYGEN_SKIP */
 
@@ -179,13 +232,29 @@ typedef struct
 
 class VSIArchiveContent
 {
+    CPL_DISALLOW_COPY_ASSIGN(VSIArchiveContent)
+
+    int nEntriesAlloc = 0;
+
 public:
     time_t       mTime = 0;
     vsi_l_offset nFileSize = 0;
     int nEntries = 0;
     VSIArchiveEntry* entries = nullptr;
 
+    /* Indices in entries[] of the entries by name, and of the children of */
+    /* each directory ("" for the top level one), in archive order. */
+    std::unordered_map<std::string, int> oMapNameToEntry{};
+    std::unordered_map<std::string, std::vector<int>> oMapDirToEntries{};
+
+    VSIArchiveContent() = default;
     ~VSIArchiveContent();
+
+    /* Takes ownership of pszFileName and poFilePos. */
+    void AddEntry( char* pszFileName, vsi_l_offset nUncompressedSize,
+                   GIntBig nModifiedTime, bool bIsDir,
+                   VSIArchiveEntryFileOffset* poFilePos );
+    const VSIArchiveEntry* FindEntry( const char* pszFileName ) const;
 };
 
 class VSIArchiveReader
@@ -217,6 +286,18 @@ protected:
     virtual std::vector<CPLString> GetExtensions() = 0;
     virtual VSIArchiveReader* CreateReader(const char* pszArchiveFileName) = 0;
 
+    /* Conversion of the file offsets to and from the archive index files */
+    /* written in VSI_ARCHIVE_INDEX_DIR. Not supported by default. */
+    virtual bool SerializeFileOffset( const VSIArchiveEntryFileOffset* /* poOffset */,
+                                      GUIntBig /* anValues */ [2] ) { return false; }
+    virtual VSIArchiveEntryFileOffset* DeserializeFileOffset(
+                                      const GUIntBig /* anValues */ [2] ) { return nullptr; }
+
+    VSIArchiveContent* LoadArchiveIndex( const char* archiveFilename,
+                                         const VSIStatBufL& sStat );
+    void SaveArchiveIndex( const char* archiveFilename,
+                           const VSIArchiveContent* content );
+
 public:
     VSIArchiveFilesystemHandler();
     virtual ~VSIArchiveFilesystemHandler();
@@ -258,6 +339,7 @@ VSIVirtualHandle* VSICreateBufferedReaderHandle(VSIVirtualHandle* poBaseHandle,
                                                 const GByte* pabyBeginningContent,
                                                 vsi_l_offset nCheatFileSize);
 VSIVirtualHandle CPL_DLL *VSICreateCachedFile( VSIVirtualHandle* poBaseHandle, size_t nChunkSize = 32768, size_t nCacheSize = 0 );
+VSIVirtualHandle CPL_DLL *VSICreateSharedCachedFile( VSIFilesystemHandler* poFS, const char* pszFilename, VSIVirtualHandle* poBaseHandle, bool bWriteBack );
 
 const int CPL_DEFLATE_TYPE_GZIP = 0;
 const int CPL_DEFLATE_TYPE_ZLIB = 1;
@@ -40,6 +40,10 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <iterator>
+#include <list>
 #include <map>
 #include <memory>
 #include <set>
@@ -51,11 +55,203 @@
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
+#include "cpl_trace.h"
 #include "cpl_vsi_virtual.h"
 
 
 CPL_CVSID("$Id: cpl_vsil.cpp 22d95175f375d90d8f598436d1187fd143e00b67 2019-09-17 23:06:11 +0200 Even Rouault $")
 
+/************************************************************************/
+/*                       I/O statistics helpers                         */
+/************************************************************************/
+
+#ifndef DOXYGEN_SKIP
+
+// Counters of the I/O done by handles that were not opened through
+// VSIFOpenExL(), and of the HTTP requests issued outside of a VSI call.
+static VSIIOCounters& VSIGetUnattributedIOCounters()
+{
+    static VSIIOCounters oCounters;
+    return oCounters;
+}
+
+namespace {
+
+// Handler and file handle on behalf of which the current thread is doing
+// I/O. Nested calls, for example a /vsizip/ read that reads from a /vsis3/
+// file, stack their contexts, so that HTTP requests are charged to the
+// innermost handler and handle.
+struct VSIIOStatsContext
+{
+    VSIIOCounters   *poCounters;
+    VSIIOStatistics *psHandleStats;
+};
+
+thread_local VSIIOStatsContext* tls_psIOStatsContext = nullptr;
+
+class VSIIOStatsScope
+{
+    VSIIOStatsContext  m_sContext;
+    VSIIOStatsContext *m_psPrevious;
+
+    CPL_DISALLOW_COPY_ASSIGN(VSIIOStatsScope)
+
+  public:
+    VSIIOStatsScope( VSIIOCounters* poCounters,
+                     VSIIOStatistics* psHandleStats ) :
+        m_sContext{poCounters, psHandleStats},
+        m_psPrevious(tls_psIOStatsContext)
+    {
+        tls_psIOStatsContext = &m_sContext;
+    }
+
+    explicit VSIIOStatsScope( VSIVirtualHandle* poHandle ) :
+        VSIIOStatsScope(poHandle->m_poIOCounters, &poHandle->m_sIOStats) {}
+
+    ~VSIIOStatsScope() { tls_psIOStatsContext = m_psPrevious; }
+};
+
+} // namespace
+
+static VSIIOCounters& VSIGetIOCounters( VSIVirtualHandle* poHandle )
+{
+    return poHandle->m_poIOCounters ? *(poHandle->m_poIOCounters) :
+                                      VSIGetUnattributedIOCounters();
+}
+
+static void VSIIOStatsAddRead( VSIVirtualHandle* poHandle, GUIntBig nBytes )
+{
+    poHandle->m_sIOStats.nReads ++;
+    poHandle->m_sIOStats.nBytesRead += nBytes;
+    VSIIOCounters& oCounters = VSIGetIOCounters(poHandle);
+    oCounters.nReads.fetch_add(1, std::memory_order_relaxed);
+    oCounters.nBytesRead.fetch_add(nBytes, std::memory_order_relaxed);
+}
+
+static void VSIIOStatsAddWrite( VSIVirtualHandle* poHandle, GUIntBig nBytes )
+{
+    poHandle->m_sIOStats.nWrites ++;
+    poHandle->m_sIOStats.nBytesWritten += nBytes;
+    VSIIOCounters& oCounters = VSIGetIOCounters(poHandle);
+    oCounters.nWrites.fetch_add(1, std::memory_order_relaxed);
+    oCounters.nBytesWritten.fetch_add(nBytes, std::memory_order_relaxed);
+}
+
+static int VSIGetHTTPLatencyBucket( double dfSeconds )
+{
+    static const double adfUpperBoundsMS[VSI_HTTP_LATENCY_BUCKET_COUNT - 1] =
+        { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000 };
+    const double dfMS = dfSeconds * 1000.0;
+    int i = 0;
+    while( i < VSI_HTTP_LATENCY_BUCKET_COUNT - 1 &&
+           !(dfMS <= adfUpperBoundsMS[i]) )
+    {
+        i++;
+    }
+    return i;
+}
+
+static void AddIOStatistics( VSIIOStatistics* psStats,
+                             const VSIIOStatistics& sOther )
+{
+    psStats->nOpens += sOther.nOpens;
+    psStats->nReads += sOther.nReads;
+    psStats->nBytesRead += sOther.nBytesRead;
+    psStats->nWrites += sOther.nWrites;
+    psStats->nBytesWritten += sOther.nBytesWritten;
+    psStats->nSeeks += sOther.nSeeks;
+    psStats->nHTTPRequests += sOther.nHTTPRequests;
+    psStats->nHTTPErrors += sOther.nHTTPErrors;
+    psStats->nHTTPBytesDownloaded += sOther.nHTTPBytesDownloaded;
+    psStats->nHTTPBytesUploaded += sOther.nHTTPBytesUploaded;
+    psStats->dfHTTPTotalTime += sOther.dfHTTPTotalTime;
+    for( int i = 0; i < VSI_HTTP_LATENCY_BUCKET_COUNT; i++ )
+        psStats->anHTTPLatencyHistogram[i] += sOther.anHTTPLatencyHistogram[i];
+}
+
+/************************************************************************/
+/*                            VSIIOCounters                             */
+/************************************************************************/
+
+void VSIIOCounters::Reset()
+{
+    nOpens = 0;
+    nReads = 0;
+    nBytesRead = 0;
+    nWrites = 0;
+    nBytesWritten = 0;
+    nSeeks = 0;
+    nHTTPRequests = 0;
+    nHTTPErrors = 0;
+    nHTTPBytesDownloaded = 0;
+    nHTTPBytesUploaded = 0;
+    nHTTPTimeMicroSec = 0;
+    for( auto& nCount: anHTTPLatencyHistogram )
+        nCount = 0;
+}
+
+void VSIIOCounters::AddTo( VSIIOStatistics* psStats ) const
+{
+    psStats->nOpens += nOpens.load();
+    psStats->nReads += nReads.load();
+    psStats->nBytesRead += nBytesRead.load();
+    psStats->nWrites += nWrites.load();
+    psStats->nBytesWritten += nBytesWritten.load();
+    psStats->nSeeks += nSeeks.load();
+    psStats->nHTTPRequests += nHTTPRequests.load();
+    psStats->nHTTPErrors += nHTTPErrors.load();
+    psStats->nHTTPBytesDownloaded += nHTTPBytesDownloaded.load();
+    psStats->nHTTPBytesUploaded += nHTTPBytesUploaded.load();
+    psStats->dfHTTPTotalTime +=
+        static_cast<double>(nHTTPTimeMicroSec.load()) * 1e-6;
+    for( int i = 0; i < VSI_HTTP_LATENCY_BUCKET_COUNT; i++ )
+        psStats->anHTTPLatencyHistogram[i] += anHTTPLatencyHistogram[i].load();
+}
+
+/************************************************************************/
+/*                      VSIIOStatsAddHTTPRequest()                      */
+/************************************************************************/
+
+void VSIIOStatsAddHTTPRequest( bool bError, double dfSeconds,
+                               GUIntBig nBytesDownloaded,
+                               GUIntBig nBytesUploaded )
+{
+    if( !(dfSeconds >= 0) )
+        dfSeconds = 0;
+    const int iBucket = VSIGetHTTPLatencyBucket(dfSeconds);
+
+    VSIIOStatsContext* psContext = tls_psIOStatsContext;
+    VSIIOCounters& oCounters =
+        psContext && psContext->poCounters ? *(psContext->poCounters) :
+                                             VSIGetUnattributedIOCounters();
+    oCounters.nHTTPRequests.fetch_add(1, std::memory_order_relaxed);
+    if( bError )
+        oCounters.nHTTPErrors.fetch_add(1, std::memory_order_relaxed);
+    oCounters.nHTTPBytesDownloaded.fetch_add(nBytesDownloaded,
+                                             std::memory_order_relaxed);
+    oCounters.nHTTPBytesUploaded.fetch_add(nBytesUploaded,
+                                           std::memory_order_relaxed);
+    oCounters.nHTTPTimeMicroSec.fetch_add(
+        static_cast<GUIntBig>(dfSeconds * 1e6 + 0.5),
+        std::memory_order_relaxed);
+    oCounters.anHTTPLatencyHistogram[iBucket].fetch_add(
+        1, std::memory_order_relaxed);
+
+    if( psContext && psContext->psHandleStats )
+    {
+        VSIIOStatistics* psStats = psContext->psHandleStats;
+        psStats->nHTTPRequests ++;
+        if( bError )
+            psStats->nHTTPErrors ++;
+        psStats->nHTTPBytesDownloaded += nBytesDownloaded;
+        psStats->nHTTPBytesUploaded += nBytesUploaded;
+        psStats->dfHTTPTotalTime += dfSeconds;
+        psStats->anHTTPLatencyHistogram[iBucket] ++;
+    }
+}
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
 /************************************************************************/
 /*                             VSIReadDir()                             */
 /************************************************************************/
@@ -119,9 +315,278 @@ char **VSIReadDirEx( const char *pszPath, int nMaxFiles )
     VSIFilesystemHandler *poFSHandler =
         VSIFileManager::GetHandler( pszPath );
 
+    VSIIOStatsScope oIOStatsScope(&poFSHandler->m_oIOCounters, nullptr);
     return poFSHandler->ReadDirEx( pszPath, nMaxFiles );
 }
 
+/************************************************************************/
+/*                        Directory listing cache                       */
+/************************************************************************/
+
+namespace {
+
+struct VSIDirListingCacheEntry
+{
+    CPLString       osDir{};
+    char          **papszFiles = nullptr;
+    int             nMaxFiles = 0;
+    bool            bTruncated = false;
+    GIntBig         nListingTime = 0;
+    // Modification time of a directory of the local file system, when
+    // listed, or -1.
+    GIntBig         nDirMTime = -1;
+};
+
+}  // namespace
+
+static CPLMutex *hDirListingCacheMutex = nullptr;
+static std::list<VSIDirListingCacheEntry> *poDirListingCache = nullptr;
+static std::atomic<size_t> nDirListingCacheEntries{0};
+// Incremented by each invalidation, so that a listing made concurrently
+// with a modification is not cached.
+static GUIntBig nDirListingCacheGeneration = 0;
+
+static int VSIGetDirListingCacheSize()
+{
+    return atoi(CPLGetConfigOption("GDAL_READDIR_CACHE_SIZE", "100"));
+}
+
+static bool VSIIsLocalPath( const char* pszPath )
+{
+    return !STARTS_WITH(pszPath, "/vsi");
+}
+
+// Returns the modification time of a local directory, or -1.
+static GIntBig VSIGetDirMTime( const char* pszPath )
+{
+    VSIStatBufL sStat;
+    if( !VSIIsLocalPath(pszPath) || VSIStatL(pszPath, &sStat) != 0 )
+        return -1;
+    return static_cast<GIntBig>(sStat.st_mtime);
+}
+
+static void VSIRemoveDirListingCacheEntry(
+                    std::list<VSIDirListingCacheEntry>::iterator& oIter )
+{
+    CSLDestroy(oIter->papszFiles);
+    oIter = poDirListingCache->erase(oIter);
+    --nDirListingCacheEntries;
+}
+
+// Must be called with hDirListingCacheMutex held. Moves the found entry
+// at the front of the list.
+static VSIDirListingCacheEntry *
+VSIFindDirListingCacheEntry( const char* pszPath, GIntBig nDirMTime )
+{
+    if( poDirListingCache == nullptr )
+        return nullptr;
+    for( auto oIter = poDirListingCache->begin();
+         oIter != poDirListingCache->end(); ++oIter )
+    {
+        if( oIter->osDir != pszPath )
+            continue;
+
+        bool bValid;
+        if( VSIIsLocalPath(pszPath) )
+        {
+            // A modification of the directory after the listing started
+            // gives it a modification time at least equal to the listing
+            // time, so unless it was modified in the second before, its
+            // unchanged modification time guarantees the listing is up to
+            // date.
+            bValid = nDirMTime >= 0 && nDirMTime == oIter->nDirMTime &&
+                     oIter->nDirMTime < oIter->nListingTime;
+        }
+        else
+        {
+            const GIntBig nMaxAge = CPLAtoGIntBig(
+                CPLGetConfigOption("GDAL_READDIR_CACHE_MAX_AGE", "600"));
+            bValid = static_cast<GIntBig>(time(nullptr)) -
+                                        oIter->nListingTime <= nMaxAge;
+        }
+        if( !bValid )
+        {
+            VSIRemoveDirListingCacheEntry(oIter);
+            return nullptr;
+        }
+        if( oIter != poDirListingCache->begin() )
+            poDirListingCache->splice(poDirListingCache->begin(),
+                                      *poDirListingCache, oIter);
+        return &(poDirListingCache->front());
+    }
+    return nullptr;
+}
+
+/************************************************************************/
+/*                          VSIReadDirCached()                          */
+/************************************************************************/
+
+/**
+ * \brief Read names in a directory, using a process-wide cache of
+ * directory listings.
+ *
+ * This function behaves as VSIReadDirEx(), except that the listings are
+ * kept in a cache of at most GDAL_READDIR_CACHE_SIZE directories (100 by
+ * default, 0 to disable the cache). It is meant for the lookup of sibling
+ * files done when opening many files of the same directory.
+ *
+ * Cached listings are invalidated by the creation, renaming and deletion of
+ * files and directories through the VSI API. Listings of directories of the
+ * local file system are also checked against the modification time of the
+ * directory. Listings of virtual file systems, whose content may be
+ * modified by other processes, are kept at most GDAL_READDIR_CACHE_MAX_AGE
+ * seconds (600 by default).
+ *
+ * @param pszPath the relative, or absolute path of a directory to read.
+ * UTF-8 encoded.
+ * @param nMaxFiles maximum number of files after which to stop, or 0 for no
+ * limit.
+ * @return The list of entries in the directory, or NULL if the directory
+ * doesn't exist, to free with CSLDestroy().
+ * @since GDAL 3.1
+ */
+
+char **VSIReadDirCached( const char *pszPath, int nMaxFiles )
+{
+    const int nCacheSize = VSIGetDirListingCacheSize();
+    if( nCacheSize <= 0 )
+        return VSIReadDirEx(pszPath, nMaxFiles);
+
+    const GIntBig nListingTime = static_cast<GIntBig>(time(nullptr));
+    const GIntBig nDirMTime = VSIGetDirMTime(pszPath);
+    GUIntBig nGeneration = 0;
+    {
+        CPLMutexHolderD(&hDirListingCacheMutex);
+        nGeneration = nDirListingCacheGeneration;
+        VSIDirListingCacheEntry *psEntry =
+            VSIFindDirListingCacheEntry(pszPath, nDirMTime);
+        // A truncated listing can only be used if it exceeds the limit.
+        if( psEntry != nullptr &&
+            (!psEntry->bTruncated ||
+             (nMaxFiles > 0 && nMaxFiles <= psEntry->nMaxFiles)) )
+        {
+            return CSLDuplicate(psEntry->papszFiles);
+        }
+    }
+
+    char **papszFiles = VSIReadDirEx(pszPath, nMaxFiles);
+
+    CPLMutexHolderD(&hDirListingCacheMutex);
+    if( nGeneration != nDirListingCacheGeneration )
+        return papszFiles;
+    if( poDirListingCache == nullptr )
+        poDirListingCache = new std::list<VSIDirListingCacheEntry>();
+    auto oIter = poDirListingCache->begin();
+    while( oIter != poDirListingCache->end() )
+    {
+        if( oIter->osDir == pszPath )
+            VSIRemoveDirListingCacheEntry(oIter);
+        else
+            ++oIter;
+    }
+    while( poDirListingCache->size() >= static_cast<size_t>(nCacheSize) )
+    {
+        auto oLast = std::prev(poDirListingCache->end());
+        VSIRemoveDirListingCacheEntry(oLast);
+    }
+
+    VSIDirListingCacheEntry oEntry;
+    oEntry.osDir = pszPath;
+    oEntry.papszFiles = CSLDuplicate(papszFiles);
+    oEntry.nMaxFiles = nMaxFiles;
+    oEntry.bTruncated = nMaxFiles > 0 && CSLCount(papszFiles) > nMaxFiles;
+    oEntry.nListingTime = nListingTime;
+    oEntry.nDirMTime = nDirMTime;
+    poDirListingCache->push_front(oEntry);
+    ++nDirListingCacheEntries;
+
+    return papszFiles;
+}
+
+/************************************************************************/
+/*                       VSIGetCachedDirListing()                       */
+/************************************************************************/
+
+/**
+ * \brief Return the complete listing of a directory if it is in the cache
+ * of VSIReadDirCached().
+ *
+ * The directory is not read if its listing is not cached.
+ *
+ * @param pszPath the relative, or absolute path of a directory.
+ * UTF-8 encoded.
+ * @return The list of entries in the directory, to free with CSLDestroy(),
+ * or NULL if no complete listing of the directory is cached.
+ * @since GDAL 3.1
+ */
+
+char **VSIGetCachedDirListing( const char *pszPath )
+{
+    if( nDirListingCacheEntries.load() == 0 )
+        return nullptr;
+
+    const GIntBig nDirMTime = VSIGetDirMTime(pszPath);
+    CPLMutexHolderD(&hDirListingCacheMutex);
+    VSIDirListingCacheEntry *psEntry =
+        VSIFindDirListingCacheEntry(pszPath, nDirMTime);
+    if( psEntry == nullptr || psEntry->bTruncated ||
+        psEntry->papszFiles == nullptr )
+    {
+        return nullptr;
+    }
+    return CSLDuplicate(psEntry->papszFiles);
+}
+
+/************************************************************************/
+/*                      VSIClearDirListingCache()                       */
+/************************************************************************/
+
+/**
+ * \brief Invalidate cached directory listings of VSIReadDirCached().
+ *
+ * This is done automatically for files and directories created, renamed or
+ * deleted through the VSI API. This function may be used when they are
+ * modified by other means.
+ *
+ * @param pszPath the path of a file or directory, whose parent directory
+ * listing and, for a directory, own listing and the ones of its
+ * subdirectories are invalidated. If NULL, the whole cache is cleared.
+ * @since GDAL 3.1
+ */
+
+void VSIClearDirListingCache( const char *pszPath )
+{
+    // Only the listings made concurrently must be prevented from being
+    // cached when the cache is empty.
+    if( nDirListingCacheEntries.load() == 0 && hDirListingCacheMutex == nullptr )
+        return;
+
+    CPLString osPath(pszPath ? pszPath : "");
+    while( osPath.size() > 1 && osPath.back() == '/' )
+        osPath.resize(osPath.size() - 1);
+    const CPLString osParent(CPLGetDirname(osPath));
+
+    CPLMutexHolderD(&hDirListingCacheMutex);
+    ++nDirListingCacheGeneration;
+    if( poDirListingCache == nullptr )
+        return;
+    auto oIter = poDirListingCache->begin();
+    while( oIter != poDirListingCache->end() )
+    {
+        const CPLString& osDir = oIter->osDir;
+        if( pszPath == nullptr || osDir == osParent || osDir == osPath ||
+            (STARTS_WITH(osDir, osPath) &&
+             (osDir[osPath.size()] == '/' || osDir[osPath.size()] == '\\')) )
+        {
+            VSIRemoveDirListingCacheEntry(oIter);
+        }
+        else
+        {
+            ++oIter;
+        }
+    }
+}
+
 /************************************************************************/
 /*                             VSIReadRecursive()                       */
 /************************************************************************/
@@ -426,7 +891,10 @@ int VSIMkdir( const char *pszPathname, long mode )
     VSIFilesystemHandler *poFSHandler =
         VSIFileManager::GetHandler( pszPathname );
 
-    return poFSHandler->Mkdir( pszPathname, mode );
+    VSIIOStatsScope oIOStatsScope(&poFSHandler->m_oIOCounters, nullptr);
+    const int nRet = poFSHandler->Mkdir( pszPathname, mode );
+    VSIClearDirListingCache( pszPathname );
+    return nRet;
 }
 
 /************************************************************************/
@@ -501,7 +969,10 @@ int VSIUnlink( const char * pszFilename )
     VSIFilesystemHandler *poFSHandler =
         VSIFileManager::GetHandler( pszFilename );
 
-    return poFSHandler->Unlink( pszFilename );
+    VSIIOStatsScope oIOStatsScope(&poFSHandler->m_oIOCounters, nullptr);
+    const int nRet = poFSHandler->Unlink( pszFilename );
+    VSIClearDirListingCache( pszFilename );
+    return nRet;
 }
 
 /************************************************************************/
@@ -532,7 +1003,11 @@ int VSIRename( const char * oldpath, const char * newpath )
     VSIFilesystemHandler *poFSHandler =
         VSIFileManager::GetHandler( oldpath );
 
-    return poFSHandler->Rename( oldpath, newpath );
+    VSIIOStatsScope oIOStatsScope(&poFSHandler->m_oIOCounters, nullptr);
+    const int nRet = poFSHandler->Rename( oldpath, newpath );
+    VSIClearDirListingCache( oldpath );
+    VSIClearDirListingCache( newpath );
+    return nRet;
 }
 
 /************************************************************************/
@@ -619,9 +1094,11 @@ int VSISync( const char* pszSource, const char* pszTarget,
         poFSHandler = poFSHandlerTarget;
     }
 
-    return poFSHandler->Sync( pszSource, pszTarget, papszOptions,
+    const int nRet = poFSHandler->Sync( pszSource, pszTarget, papszOptions,
                                pProgressFunc, pProgressData, ppapszOutputs ) ?
                 TRUE : FALSE;
+    VSIClearDirListingCache( pszTarget );
+    return nRet;
 }
 
 /************************************************************************/
@@ -650,7 +1127,10 @@ int VSIRmdir( const char * pszDirname )
     VSIFilesystemHandler *poFSHandler =
         VSIFileManager::GetHandler( pszDirname );
 
-    return poFSHandler->Rmdir( pszDirname );
+    VSIIOStatsScope oIOStatsScope(&poFSHandler->m_oIOCounters, nullptr);
+    const int nRet = poFSHandler->Rmdir( pszDirname );
+    VSIClearDirListingCache( pszDirname );
+    return nRet;
 }
 
 /************************************************************************/
@@ -796,6 +1276,7 @@ int VSIStatExL( const char * pszFilename, VSIStatBufL *psStatBuf, int nFlags )
         nFlags = VSI_STAT_EXISTS_FLAG | VSI_STAT_NATURE_FLAG |
             VSI_STAT_SIZE_FLAG;
 
+    VSIIOStatsScope oIOStatsScope(&poFSHandler->m_oIOCounters, nullptr);
     return poFSHandler->Stat( pszFilename, psStatBuf, nFlags );
 }
 
@@ -1426,8 +1907,33 @@ VSILFILE *VSIFOpenExL( const char * pszFilename, const char * pszAccess,
     VSIFilesystemHandler *poFSHandler =
         VSIFileManager::GetHandler( pszFilename );
 
-    VSILFILE* fp = reinterpret_cast<VSILFILE *>(
-        poFSHandler->Open( pszFilename, pszAccess, CPL_TO_BOOL(bSetError) ) );
+    // HTTP requests done while opening are charged to the new handle.
+    VSIIOStatistics sOpenStats;
+    memset(&sOpenStats, 0, sizeof(sOpenStats));
+    VSIVirtualHandle* poHandle;
+    {
+        VSIIOStatsScope oIOStatsScope(&poFSHandler->m_oIOCounters,
+                                      &sOpenStats);
+        poHandle = poFSHandler->Open( pszFilename, pszAccess,
+                                      CPL_TO_BOOL(bSetError) );
+    }
+    if( poHandle != nullptr )
+    {
+        poFSHandler->m_oIOCounters.nOpens.fetch_add(
+            1, std::memory_order_relaxed);
+        sOpenStats.nOpens = 1;
+        AddIOStatistics(&(poHandle->m_sIOStats), sOpenStats);
+        poHandle->m_poIOCounters = &poFSHandler->m_oIOCounters;
+    }
+    VSILFILE* fp = reinterpret_cast<VSILFILE *>(poHandle);
+
+    // Opening in write mode may create the file.
+    if( strchr(pszAccess, 'w') != nullptr ||
+        strchr(pszAccess, 'a') != nullptr ||
+        strchr(pszAccess, '+') != nullptr )
+    {
+        VSIClearDirListingCache( pszFilename );
+    }
 
     VSIDebug4( "VSIFOpenExL(%s,%s,%d) = %p",
                pszFilename, pszAccess, bSetError, fp );
@@ -1476,7 +1982,11 @@ int VSIFCloseL( VSILFILE * fp )
 
     VSIDebug1( "VSIFCloseL(%p)", fp );
 
-    const int nResult = poFileHandle->Close();
+    int nResult;
+    {
+        VSIIOStatsScope oIOStatsScope(poFileHandle);
+        nResult = poFileHandle->Close();
+    }
 
     delete poFileHandle;
 
@@ -1534,6 +2044,9 @@ int VSIFSeekL( VSILFILE * fp, vsi_l_offset nOffset, int nWhence )
 {
     VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>(fp);
 
+    poFileHandle->m_sIOStats.nSeeks ++;
+    VSIGetIOCounters(poFileHandle).nSeeks.fetch_add(
+        1, std::memory_order_relaxed);
     return poFileHandle->Seek( nOffset, nWhence );
 }
 
@@ -1640,6 +2153,7 @@ int VSIFFlushL( VSILFILE * fp )
 {
     VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>( fp );
 
+    VSIIOStatsScope oIOStatsScope(poFileHandle);
     return poFileHandle->Flush();
 }
 
@@ -1692,7 +2206,13 @@ size_t VSIFReadL( void * pBuffer, size_t nSize, size_t nCount, VSILFILE * fp )
 {
     VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>( fp );
 
-    return poFileHandle->Read( pBuffer, nSize, nCount );
+    CPLTraceScope oTrace("vsi", "VSIFReadL");
+    VSIIOStatsScope oIOStatsScope(poFileHandle);
+    const size_t nRet = poFileHandle->Read( pBuffer, nSize, nCount );
+    VSIIOStatsAddRead(poFileHandle, static_cast<GUIntBig>(nRet) * nSize);
+    if( oTrace.IsEnabled() )
+        oTrace.SetArg("bytes", static_cast<GIntBig>(nRet * nSize));
+    return nRet;
 }
 
 /************************************************************************/
@@ -1753,7 +2273,17 @@ int VSIFReadMultiRangeL( int nRanges, void ** ppData,
 {
     VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>(fp);
 
-    return poFileHandle->ReadMultiRange(nRanges, ppData, panOffsets, panSizes);
+    VSIIOStatsScope oIOStatsScope(poFileHandle);
+    const int nRet =
+        poFileHandle->ReadMultiRange(nRanges, ppData, panOffsets, panSizes);
+    if( nRet == 0 )
+    {
+        GUIntBig nBytes = 0;
+        for( int i = 0; i < nRanges; i++ )
+            nBytes += panSizes[i];
+        VSIIOStatsAddRead(poFileHandle, nBytes);
+    }
+    return nRet;
 }
 
 /************************************************************************/
@@ -1807,7 +2337,10 @@ size_t VSIFWriteL( const void *pBuffer, size_t nSize, size_t nCount,
 {
     VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>( fp );
 
-    return poFileHandle->Write( pBuffer, nSize, nCount );
+    VSIIOStatsScope oIOStatsScope(poFileHandle);
+    const size_t nRet = poFileHandle->Write( pBuffer, nSize, nCount );
+    VSIIOStatsAddWrite(poFileHandle, static_cast<GUIntBig>(nRet) * nSize);
+    return nRet;
 }
 
 /************************************************************************/
@@ -2342,6 +2875,83 @@ char **VSIGetFileSystemsPrefixes( void )
     return VSIFileManager::GetPrefixes();
 }
 
+/************************************************************************/
+/*                         VSIGetIOStatistics()                         */
+/************************************************************************/
+
+/**
+ * \brief Return the cumulative I/O statistics of a virtual file system
+ * handler, or of all of them.
+ *
+ * The statistics count the operations done through the VSIF*L() API (opens,
+ * reads, writes, seeks), and the HTTP requests issued by the network based
+ * file systems, with a histogram of their latencies.
+ *
+ * When file systems are stacked, for example with /vsizip/ over /vsis3/,
+ * reads are counted by each handler they go through, whereas HTTP requests
+ * are only counted by the handler that issued them. The aggregate returned
+ * for a NULL prefix also includes the I/O of file handles that were not
+ * opened by VSIFOpenL(), and HTTP requests that are not related to a VSI
+ * call.
+ *
+ * @param pszPrefix prefix of a handler, as returned by
+ * VSIGetFileSystemsPrefixes() (e.g. "/vsis3/"), "" for the default local
+ * file system handler, or NULL to get the sum over all handlers.
+ * @param psStats structure filled with the statistics.
+ * @return TRUE in case of success, or FALSE if there is no handler for this
+ * prefix.
+ * @since GDAL 3.1
+ */
+
+int VSIGetIOStatistics( const char* pszPrefix, VSIIOStatistics* psStats )
+{
+    return VSIFileManager::GetIOStatistics(pszPrefix, psStats);
+}
+
+/************************************************************************/
+/*                        VSIFGetIOStatisticsL()                        */
+/************************************************************************/
+
+/**
+ * \brief Return the I/O statistics of a file handle.
+ *
+ * The statistics are collected since the file was opened, and are not
+ * affected by VSIResetIOStatistics(). They include the HTTP requests issued
+ * while opening the file.
+ *
+ * @param fp file handle opened with VSIFOpenL().
+ * @param psStats structure filled with the statistics.
+ * @return TRUE in case of success.
+ * @since GDAL 3.1
+ */
+
+int VSIFGetIOStatisticsL( VSILFILE* fp, VSIIOStatistics* psStats )
+{
+    VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>(fp);
+    if( poFileHandle == nullptr || psStats == nullptr )
+        return FALSE;
+
+    *psStats = poFileHandle->m_sIOStats;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                        VSIResetIOStatistics()                        */
+/************************************************************************/
+
+/**
+ * \brief Reset the I/O statistics of all virtual file system handlers.
+ *
+ * The statistics of the file handles are not reset.
+ *
+ * @since GDAL 3.1
+ */
+
+void VSIResetIOStatistics( void )
+{
+    VSIFileManager::ResetIOStatistics();
+}
+
 /************************************************************************/
 /*                     VSIGetFileSystemOptions()                        */
 /************************************************************************/
@@ -2476,6 +3086,67 @@ char ** VSIFileManager::GetPrefixes()
     return aosList.StealList();
 }
 
+/************************************************************************/
+/*                          GetIOStatistics()                           */
+/************************************************************************/
+
+bool VSIFileManager::GetIOStatistics( const char* pszPrefix,
+                                      VSIIOStatistics* psStats )
+{
+    if( psStats == nullptr )
+        return false;
+    memset(psStats, 0, sizeof(VSIIOStatistics));
+
+    CPLMutexHolder oHolder( &hVSIFileManagerMutex );
+    VSIFileManager *poThis = Get();
+    if( pszPrefix == nullptr )
+    {
+        // The same handler may be installed under several prefixes.
+        std::set<VSIFilesystemHandler*> oSetHandlers;
+        for( const auto& oIter: poThis->oHandlers )
+            oSetHandlers.insert(oIter.second);
+        oSetHandlers.insert(poThis->poDefaultHandler);
+        for( auto poHandler: oSetHandlers )
+        {
+            if( poHandler )
+                poHandler->m_oIOCounters.AddTo(psStats);
+        }
+        VSIGetUnattributedIOCounters().AddTo(psStats);
+        return true;
+    }
+
+    VSIFilesystemHandler* poHandler = nullptr;
+    if( pszPrefix[0] == '\0' )
+    {
+        poHandler = poThis->poDefaultHandler;
+    }
+    else
+    {
+        const auto oIter = poThis->oHandlers.find(pszPrefix);
+        if( oIter != poThis->oHandlers.end() )
+            poHandler = oIter->second;
+    }
+    if( poHandler == nullptr )
+        return false;
+    poHandler->m_oIOCounters.AddTo(psStats);
+    return true;
+}
+
+/************************************************************************/
+/*                         ResetIOStatistics()                          */
+/************************************************************************/
+
+void VSIFileManager::ResetIOStatistics()
+{
+    CPLMutexHolder oHolder( &hVSIFileManagerMutex );
+    VSIFileManager *poThis = Get();
+    for( const auto& oIter: poThis->oHandlers )
+        oIter.second->m_oIOCounters.Reset();
+    if( poThis->poDefaultHandler )
+        poThis->poDefaultHandler->m_oIOCounters.Reset();
+    VSIGetUnattributedIOCounters().Reset();
+}
+
 /************************************************************************/
 /*                             GetHandler()                             */
 /************************************************************************/
@@ -2544,6 +3215,15 @@ void VSICleanupFileManager()
         CPLDestroyMutex(hVSIFileManagerMutex);
         hVSIFileManagerMutex = nullptr;
     }
+
+    VSIClearDirListingCache( nullptr );
+    delete poDirListingCache;
+    poDirListingCache = nullptr;
+    if( hDirListingCacheMutex != nullptr )
+    {
+        CPLDestroyMutex(hDirListingCacheMutex);
+        hDirListingCacheMutex = nullptr;
+    }
 }
 
 /************************************************************************/
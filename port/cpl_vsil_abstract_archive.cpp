@@ -35,7 +35,7 @@
 #endif
 #include <ctime>
 #include <map>
-#include <set>
+#include <unordered_map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -81,6 +81,55 @@ VSIArchiveContent::~VSIArchiveContent()
     CPLFree(entries);
 }
 
+/************************************************************************/
+/*                             AddEntry()                               */
+/************************************************************************/
+
+void VSIArchiveContent::AddEntry( char* pszFileName,
+                                  vsi_l_offset nUncompressedSize,
+                                  GIntBig nModifiedTime, bool bIsDir,
+                                  VSIArchiveEntryFileOffset* poFilePos )
+{
+    if( nEntries == nEntriesAlloc )
+    {
+        nEntriesAlloc = nEntriesAlloc < 16 ? 16 :
+                                             nEntriesAlloc + nEntriesAlloc / 2;
+        entries = static_cast<VSIArchiveEntry *>(
+            CPLRealloc(entries, sizeof(VSIArchiveEntry) * nEntriesAlloc));
+    }
+
+    VSIArchiveEntry& entry = entries[nEntries];
+    entry.fileName = pszFileName;
+    entry.uncompressed_size = nUncompressedSize;
+    entry.nModifiedTime = nModifiedTime;
+    entry.bIsDir = bIsDir;
+    entry.file_pos = poFilePos;
+#ifdef DEBUG_VERBOSE
+    CPLDebug("VSIArchive", "[%d] %s : " CPL_FRMT_GUIB " bytes",
+             nEntries + 1, entry.fileName, entry.uncompressed_size);
+#endif
+
+    oMapNameToEntry[pszFileName] = nEntries;
+    const char* pszLastSlash = strrchr(pszFileName, '/');
+    oMapDirToEntries[pszLastSlash ?
+                        std::string(pszFileName, pszLastSlash - pszFileName) :
+                        std::string()].push_back(nEntries);
+    nEntries++;
+}
+
+/************************************************************************/
+/*                             FindEntry()                              */
+/************************************************************************/
+
+const VSIArchiveEntry*
+VSIArchiveContent::FindEntry( const char* pszFileName ) const
+{
+    const auto oIter = oMapNameToEntry.find(pszFileName);
+    if( oIter == oMapNameToEntry.end() )
+        return nullptr;
+    return &entries[oIter->second];
+}
+
 /************************************************************************/
 /*                   VSIArchiveFilesystemHandler()                      */
 /************************************************************************/
@@ -177,6 +226,14 @@ const VSIArchiveContent* VSIArchiveFilesystemHandler::GetContentOfArchive(
         }
     }
 
+    VSIArchiveContent* poIndexedContent =
+        LoadArchiveIndex(archiveFilename, sStat);
+    if( poIndexedContent )
+    {
+        oFileList[archiveFilename] = poIndexedContent;
+        return poIndexedContent;
+    }
+
     bool bMustClose = poReader == nullptr;
     if( poReader == nullptr )
     {
@@ -195,93 +252,294 @@ const VSIArchiveContent* VSIArchiveFilesystemHandler::GetContentOfArchive(
     VSIArchiveContent* content = new VSIArchiveContent;
     content->mTime = sStat.st_mtime;
     content->nFileSize = static_cast<vsi_l_offset>(sStat.st_size);
-    content->nEntries = 0;
-    content->entries = nullptr;
     oFileList[archiveFilename] = content;
 
-    std::set<CPLString> oSet;
-
     do
     {
         const CPLString osFileName = poReader->GetFileName();
         bool bIsDir = false;
         const CPLString osStrippedFilename =
                                 GetStrippedFilename(osFileName, bIsDir);
-        if( osStrippedFilename.empty() )
+        if( osStrippedFilename.empty() ||
+            content->oMapNameToEntry.find(osStrippedFilename) !=
+                                            content->oMapNameToEntry.end() )
             continue;
 
-        if( oSet.find(osStrippedFilename) == oSet.end() )
+        // Add intermediate directory structure.
+        const char* pszBegin = osStrippedFilename.c_str();
+        for( const char* pszIter = pszBegin; *pszIter; pszIter++ )
         {
-            oSet.insert(osStrippedFilename);
-
-            // Add intermediate directory structure.
-            const char* pszBegin = osStrippedFilename.c_str();
-            for( const char* pszIter = pszBegin; *pszIter; pszIter++ )
+            if( *pszIter == '/' )
             {
-                if( *pszIter == '/' )
+                const std::string osDir(pszBegin, pszIter - pszBegin);
+                if( content->oMapNameToEntry.find(osDir) ==
+                                            content->oMapNameToEntry.end() )
                 {
-                    char* pszStrippedFileName2 = CPLStrdup(osStrippedFilename);
-                    pszStrippedFileName2[pszIter - pszBegin] = 0;
-                    if( oSet.find(pszStrippedFileName2) == oSet.end() )
-                    {
-                        oSet.insert(pszStrippedFileName2);
-
-                        content->entries = static_cast<VSIArchiveEntry *>(
-                            CPLRealloc(
-                                content->entries,
-                                sizeof(VSIArchiveEntry) *
-                                (content->nEntries + 1)));
-                        content->entries[content->nEntries].fileName =
-                            pszStrippedFileName2;
-                        content->entries[content->nEntries].nModifiedTime =
-                            poReader->GetModifiedTime();
-                        content->entries[content->nEntries].uncompressed_size =
-                            0;
-                        content->entries[content->nEntries].bIsDir = TRUE;
-                        content->entries[content->nEntries].file_pos = nullptr;
-#ifdef DEBUG_VERBOSE
-                        const int nEntries = content->nEntries;
-                        CPLDebug(
-                            "VSIArchive", "[%d] %s : " CPL_FRMT_GUIB " bytes",
-                            content->nEntries + 1,
-                            content->entries[nEntries].fileName,
-                            content->entries[nEntries].uncompressed_size);
-#endif
-                        content->nEntries++;
-                    }
-                    else
-                    {
-                        CPLFree(pszStrippedFileName2);
-                    }
+                    content->AddEntry( CPLStrdup(osDir.c_str()), 0,
+                                       poReader->GetModifiedTime(), true,
+                                       nullptr );
                 }
             }
-
-            content->entries = static_cast<VSIArchiveEntry *>(
-                CPLRealloc(content->entries,
-                           sizeof(VSIArchiveEntry) * (content->nEntries + 1)));
-            content->entries[content->nEntries].fileName =
-                CPLStrdup(osStrippedFilename);
-            content->entries[content->nEntries].nModifiedTime =
-                poReader->GetModifiedTime();
-            content->entries[content->nEntries].uncompressed_size =
-                poReader->GetFileSize();
-            content->entries[content->nEntries].bIsDir = bIsDir;
-            content->entries[content->nEntries].file_pos =
-                poReader->GetFileOffset();
-#ifdef DEBUG_VERBOSE
-            CPLDebug("VSIArchive", "[%d] %s : " CPL_FRMT_GUIB " bytes",
-                     content->nEntries+1,
-                     content->entries[content->nEntries].fileName,
-                     content->entries[content->nEntries].uncompressed_size);
-#endif
-            content->nEntries++;
         }
 
+        content->AddEntry( CPLStrdup(osStrippedFilename),
+                           poReader->GetFileSize(),
+                           poReader->GetModifiedTime(), bIsDir,
+                           poReader->GetFileOffset() );
+
     } while( poReader->GotoNextFile() );
 
     if( bMustClose )
         delete(poReader);
 
+    SaveArchiveIndex(archiveFilename, content);
+
+    return content;
+}
+
+/************************************************************************/
+/*                      GetArchiveIndexFilename()                       */
+/************************************************************************/
+
+static CPLString GetArchiveIndexFilename( const char* pszPrefix,
+                                          const char* archiveFilename )
+{
+    const char* pszDir = CPLGetConfigOption("VSI_ARCHIVE_INDEX_DIR", nullptr);
+    if( pszDir == nullptr || pszDir[0] == '\0' )
+        return CPLString();
+
+    // FNV-1a hash of the handler prefix and archive name, so that archives
+    // with the same basename do not collide.
+    GUIntBig nHash = 14695981039346656037ULL;
+    for( const char* pszIter : { pszPrefix, archiveFilename } )
+    {
+        for( ; *pszIter; pszIter++ )
+        {
+            nHash ^= static_cast<GByte>(*pszIter);
+            nHash *= 1099511628211ULL;
+        }
+    }
+    return CPLFormFilename(
+        pszDir,
+        CPLSPrintf("%s_%08X%08X", CPLGetFilename(archiveFilename),
+                   static_cast<unsigned>(nHash >> 32),
+                   static_cast<unsigned>(nHash & 0xFFFFFFFFU)),
+        "vsiidx");
+}
+
+/* -------------------------------------------------------------------- */
+/*      Index file layout, little endian: the magic bytes, the archive  */
+/*      size and modification time, the number of entries, then for    */
+/*      each entry the name length and bytes, the uncompressed size,    */
+/*      the modification time, the directory and file offset flags,     */
+/*      and the two values of the serialized file offset.               */
+/* -------------------------------------------------------------------- */
+static const char szArchiveIndexMagic[] = "GDALVSIARCHIDX01";
+constexpr size_t nArchiveIndexMagicSize = sizeof(szArchiveIndexMagic) - 1;
+
+static void AppendUInt32( std::string& osBuffer, GUInt32 nVal )
+{
+    CPL_LSBPTR32(&nVal);
+    osBuffer.append(reinterpret_cast<const char*>(&nVal), sizeof(nVal));
+}
+
+static void AppendUInt64( std::string& osBuffer, GUIntBig nVal )
+{
+    CPL_LSBPTR64(&nVal);
+    osBuffer.append(reinterpret_cast<const char*>(&nVal), sizeof(nVal));
+}
+
+namespace {
+struct IndexReader
+{
+    const GByte* pabyCur;
+    const GByte* pabyEnd;
+
+    bool ReadUInt32( GUInt32& nVal )
+    {
+        if( pabyEnd - pabyCur < 4 )
+            return false;
+        memcpy(&nVal, pabyCur, 4);
+        CPL_LSBPTR32(&nVal);
+        pabyCur += 4;
+        return true;
+    }
+
+    bool ReadUInt64( GUIntBig& nVal )
+    {
+        if( pabyEnd - pabyCur < 8 )
+            return false;
+        memcpy(&nVal, pabyCur, 8);
+        CPL_LSBPTR64(&nVal);
+        pabyCur += 8;
+        return true;
+    }
+};
+} // namespace
+
+/************************************************************************/
+/*                          SaveArchiveIndex()                          */
+/************************************************************************/
+
+void VSIArchiveFilesystemHandler::SaveArchiveIndex(
+    const char* archiveFilename, const VSIArchiveContent* content )
+{
+    const CPLString osIndexFilename =
+        GetArchiveIndexFilename(GetPrefix(), archiveFilename);
+    if( osIndexFilename.empty() )
+        return;
+
+    std::string osBuffer(szArchiveIndexMagic, nArchiveIndexMagicSize);
+    AppendUInt64(osBuffer, content->nFileSize);
+    AppendUInt64(osBuffer, static_cast<GUIntBig>(content->mTime));
+    AppendUInt32(osBuffer, static_cast<GUInt32>(content->nEntries));
+    for( int i = 0; i < content->nEntries; i++ )
+    {
+        const VSIArchiveEntry& entry = content->entries[i];
+        GUIntBig anValues[2] = { 0, 0 };
+        if( entry.file_pos != nullptr &&
+            !SerializeFileOffset(entry.file_pos, anValues) )
+        {
+            return;
+        }
+        const size_t nNameLen = strlen(entry.fileName);
+        AppendUInt32(osBuffer, static_cast<GUInt32>(nNameLen));
+        osBuffer.append(entry.fileName, nNameLen);
+        AppendUInt64(osBuffer, entry.uncompressed_size);
+        AppendUInt64(osBuffer, static_cast<GUIntBig>(entry.nModifiedTime));
+        osBuffer += static_cast<char>(entry.bIsDir ? 1 : 0);
+        osBuffer += static_cast<char>(entry.file_pos != nullptr ? 1 : 0);
+        AppendUInt64(osBuffer, anValues[0]);
+        AppendUInt64(osBuffer, anValues[1]);
+    }
+
+    // Write to a temporary file first, so that concurrent readers never
+    // see a partial index.
+    const CPLString osTmpFilename(
+        CPLSPrintf("%s." CPL_FRMT_GIB ".tmp", osIndexFilename.c_str(),
+                   CPLGetPID()));
+    VSILFILE* fp = VSIFOpenL(osTmpFilename, "wb");
+    if( fp == nullptr )
+    {
+        CPLDebug("VSIArchive", "Cannot create %s", osTmpFilename.c_str());
+        return;
+    }
+    const bool bOK =
+        VSIFWriteL(osBuffer.data(), 1, osBuffer.size(), fp) == osBuffer.size();
+    if( VSIFCloseL(fp) != 0 || !bOK ||
+        VSIRename(osTmpFilename, osIndexFilename) != 0 )
+    {
+        CPLDebug("VSIArchive", "Cannot write %s", osIndexFilename.c_str());
+        VSIUnlink(osTmpFilename);
+    }
+}
+
+/************************************************************************/
+/*                          LoadArchiveIndex()                          */
+/************************************************************************/
+
+VSIArchiveContent* VSIArchiveFilesystemHandler::LoadArchiveIndex(
+    const char* archiveFilename, const VSIStatBufL& sStat )
+{
+    const CPLString osIndexFilename =
+        GetArchiveIndexFilename(GetPrefix(), archiveFilename);
+    if( osIndexFilename.empty() )
+        return nullptr;
+
+    VSILFILE* fp = VSIFOpenL(osIndexFilename, "rb");
+    if( fp == nullptr )
+        return nullptr;
+    GByte* pabyData = nullptr;
+    vsi_l_offset nDataSize = 0;
+    const bool bIngested = CPL_TO_BOOL(
+        VSIIngestFile(fp, osIndexFilename, &pabyData, &nDataSize,
+                      static_cast<GIntBig>(1024) * 1024 * 1024));
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+    if( !bIngested )
+        return nullptr;
+
+    if( nDataSize < nArchiveIndexMagicSize ||
+        memcmp(pabyData, szArchiveIndexMagic, nArchiveIndexMagicSize) != 0 )
+    {
+        CPLFree(pabyData);
+        return nullptr;
+    }
+
+    IndexReader oReader{ pabyData + nArchiveIndexMagicSize,
+                         pabyData + nDataSize };
+    GUIntBig nArchiveSize = 0;
+    GUIntBig nMTime = 0;
+    GUInt32 nEntries = 0;
+    if( !oReader.ReadUInt64(nArchiveSize) ||
+        !oReader.ReadUInt64(nMTime) ||
+        !oReader.ReadUInt32(nEntries) ||
+        nArchiveSize != static_cast<GUIntBig>(sStat.st_size) ||
+        static_cast<time_t>(nMTime) != static_cast<time_t>(sStat.st_mtime) )
+    {
+        CPLFree(pabyData);
+        return nullptr;
+    }
+
+    VSIArchiveContent* content = new VSIArchiveContent;
+    content->mTime = sStat.st_mtime;
+    content->nFileSize = static_cast<vsi_l_offset>(sStat.st_size);
+
+    bool bOK = true;
+    for( GUInt32 i = 0; bOK && i < nEntries; i++ )
+    {
+        GUInt32 nNameLen = 0;
+        GUIntBig nSize = 0;
+        GUIntBig nEntryMTime = 0;
+        GUIntBig anValues[2] = { 0, 0 };
+        if( !oReader.ReadUInt32(nNameLen) || nNameLen == 0 ||
+            static_cast<size_t>(oReader.pabyEnd - oReader.pabyCur) <
+                                                static_cast<size_t>(nNameLen) )
+        {
+            bOK = false;
+            break;
+        }
+        const std::string osName(
+            reinterpret_cast<const char*>(oReader.pabyCur), nNameLen);
+        oReader.pabyCur += nNameLen;
+        if( !oReader.ReadUInt64(nSize) ||
+            !oReader.ReadUInt64(nEntryMTime) ||
+            oReader.pabyEnd - oReader.pabyCur < 2 )
+        {
+            bOK = false;
+            break;
+        }
+        const bool bIsDir = oReader.pabyCur[0] != 0;
+        const bool bHasPos = oReader.pabyCur[1] != 0;
+        oReader.pabyCur += 2;
+        if( !oReader.ReadUInt64(anValues[0]) ||
+            !oReader.ReadUInt64(anValues[1]) ||
+            osName.find('\0') != std::string::npos )
+        {
+            bOK = false;
+            break;
+        }
+        VSIArchiveEntryFileOffset* poPos = nullptr;
+        if( bHasPos )
+        {
+            poPos = DeserializeFileOffset(anValues);
+            if( poPos == nullptr )
+            {
+                bOK = false;
+                break;
+            }
+        }
+        content->AddEntry( CPLStrdup(osName.c_str()), nSize,
+                           static_cast<GIntBig>(nEntryMTime), bIsDir, poPos );
+    }
+    CPLFree(pabyData);
+
+    if( !bOK || content->nEntries == 0 )
+    {
+        CPLDebug("VSIArchive", "Ignoring invalid index %s",
+                 osIndexFilename.c_str());
+        delete content;
+        return nullptr;
+    }
     return content;
 }
 
@@ -301,14 +559,12 @@ VSIArchiveFilesystemHandler::FindFileInArchive(
     const VSIArchiveContent* content = GetContentOfArchive(archiveFilename);
     if( content )
     {
-        for( int i = 0; i < content->nEntries; i++ )
+        const VSIArchiveEntry* entry = content->FindEntry(fileInArchiveName);
+        if( entry )
         {
-            if( strcmp(fileInArchiveName, content->entries[i].fileName) == 0)
-            {
-                if( archiveEntry )
-                    *archiveEntry = &content->entries[i];
-                return TRUE;
-            }
+            if( archiveEntry )
+                *archiveEntry = entry;
+            return TRUE;
         }
     }
     return FALSE;
@@ -820,7 +1076,7 @@ char** VSIArchiveFilesystemHandler::ReadDirEx( const char *pszDirname,
     if( archiveFilename == nullptr )
         return nullptr;
 
-    const int lenInArchiveSubDir = static_cast<int>(osInArchiveSubDir.size());
+    const size_t lenInArchiveSubDir = osInArchiveSubDir.size();
 
     CPLStringList oDir;
 
@@ -834,47 +1090,23 @@ char** VSIArchiveFilesystemHandler::ReadDirEx( const char *pszDirname,
 #ifdef DEBUG_VERBOSE
     CPLDebug("VSIArchive", "Read dir %s", pszDirname);
 #endif
-    for( int i = 0; i < content->nEntries; i++ )
+    const auto oIter = content->oMapDirToEntries.find(osInArchiveSubDir);
+    if( oIter != content->oMapDirToEntries.end() )
     {
-        const char* fileName = content->entries[i].fileName;
-        /* Only list entries at the same level of inArchiveSubDir */
-        if( lenInArchiveSubDir != 0 &&
-            strncmp(fileName, osInArchiveSubDir, lenInArchiveSubDir) == 0 &&
-            IsEitherSlash(fileName[lenInArchiveSubDir]) &&
-            fileName[lenInArchiveSubDir + 1] != 0 )
-        {
-            const char* slash = strchr(fileName + lenInArchiveSubDir + 1, '/');
-            if( slash == nullptr )
-                slash = strchr(fileName + lenInArchiveSubDir + 1, '\\');
-            if( slash == nullptr || slash[1] == 0 )
-            {
-                char* tmpFileName = CPLStrdup(fileName);
-                if( slash != nullptr )
-                {
-                    tmpFileName[strlen(tmpFileName)-1] = 0;
-                }
-#ifdef DEBUG_VERBOSE
-                CPLDebug("VSIArchive", "Add %s as in directory %s",
-                         tmpFileName + lenInArchiveSubDir + 1, pszDirname);
-#endif
-                oDir.AddString(tmpFileName + lenInArchiveSubDir + 1);
-                CPLFree(tmpFileName);
-            }
-        }
-        else if( lenInArchiveSubDir == 0 &&
-                 strchr(fileName, '/') == nullptr &&
-                 strchr(fileName, '\\') == nullptr )
+        for( const int i : oIter->second )
         {
-            // Only list toplevel files and directories.
+            const char* fileName = content->entries[i].fileName;
+            if( lenInArchiveSubDir != 0 )
+                fileName += lenInArchiveSubDir + 1;
 #ifdef DEBUG_VERBOSE
             CPLDebug("VSIArchive", "Add %s as in directory %s",
                      fileName, pszDirname);
 #endif
             oDir.AddString(fileName);
-        }
 
-        if( nMaxFiles > 0 && oDir.Count() > nMaxFiles )
-            break;
+            if( nMaxFiles > 0 && oDir.Count() > nMaxFiles )
+                break;
+        }
     }
 
     CPLFree(archiveFilename);
@@ -37,8 +37,13 @@
 #endif
 
 #include <algorithm>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -51,37 +56,162 @@ CPL_CVSID("$Id: cpl_vsil_cache.cpp c39d156816d937c3139360b11786c769aeabd21e 2018
 
 /************************************************************************/
 /* ==================================================================== */
-/*                             VSICacheChunk                            */
+/*                             VSICachePool                             */
 /* ==================================================================== */
 /************************************************************************/
 
-class VSICacheChunk
+// Chunks are immutable once loaded, so that readers can keep using a chunk
+// that another handle evicts from the pool.
+typedef std::shared_ptr<const std::vector<GByte>> VSICacheChunkPtr;
+
+class VSICachePool
+{
+    CPL_DISALLOW_COPY_ASSIGN(VSICachePool)
+
+    typedef std::pair<GUIntBig, vsi_l_offset> Key;  // file id, block
+    typedef std::list<std::pair<Key, VSICacheChunkPtr>> LRUList;
+
+    std::mutex     m_oMutex{};
+    LRUList        m_oLRU{};  // Most recently used first.
+    std::map<Key, LRUList::iterator> m_oMapChunks{};
+    std::map<std::string, GUIntBig> m_oMapFileIds{};
+    GUIntBig       m_nNextFileId = 1;
+    GUIntBig       m_nCacheUsed = 0;
+    GUIntBig       m_nCacheMax = 0;
+
+    void          Evict();
+
+  public:
+    explicit VSICachePool( GUIntBig nCacheMax ) : m_nCacheMax(nCacheMax) {}
+
+    void          SetMaxSize( GUIntBig nCacheMax );
+    GUIntBig      GetFileId( const std::string& osFileKey );
+
+    VSICacheChunkPtr Get( GUIntBig nFileId, vsi_l_offset iBlock );
+    bool          Contains( GUIntBig nFileId, vsi_l_offset iBlock );
+    void          Put( GUIntBig nFileId, vsi_l_offset iBlock,
+                       const VSICacheChunkPtr& poChunk );
+    void          Invalidate( GUIntBig nFileId, vsi_l_offset iFirstBlock,
+                              vsi_l_offset iLastBlock );
+};
+
+/************************************************************************/
+/*                           GetSharedPool()                            */
+/************************************************************************/
+
+static std::shared_ptr<VSICachePool> GetSharedPool()
 {
-    CPL_DISALLOW_COPY_ASSIGN(VSICacheChunk)
+    static std::shared_ptr<VSICachePool> poPool =
+        std::make_shared<VSICachePool>(0);
+    return poPool;
+}
 
-public:
-    VSICacheChunk() = default;
+/************************************************************************/
+/*                               Evict()                                */
+/************************************************************************/
 
-    virtual ~VSICacheChunk()
+void VSICachePool::Evict()
+{
+    while( m_nCacheUsed > m_nCacheMax && !m_oLRU.empty() )
     {
-        VSIFree( pabyData );
+        const auto& oLast = m_oLRU.back();
+        m_nCacheUsed -= oLast.second->size();
+        m_oMapChunks.erase(oLast.first);
+        m_oLRU.pop_back();
     }
+}
+
+/************************************************************************/
+/*                             SetMaxSize()                             */
+/************************************************************************/
+
+void VSICachePool::SetMaxSize( GUIntBig nCacheMax )
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    m_nCacheMax = nCacheMax;
+    Evict();
+}
+
+/************************************************************************/
+/*                             GetFileId()                              */
+/************************************************************************/
 
-    bool Allocate( size_t nChunkSize )
+GUIntBig VSICachePool::GetFileId( const std::string& osFileKey )
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    auto oIter = m_oMapFileIds.find(osFileKey);
+    if( oIter != m_oMapFileIds.end() )
+        return oIter->second;
+    const GUIntBig nFileId = m_nNextFileId++;
+    m_oMapFileIds[osFileKey] = nFileId;
+    return nFileId;
+}
+
+/************************************************************************/
+/*                                Get()                                 */
+/************************************************************************/
+
+VSICacheChunkPtr VSICachePool::Get( GUIntBig nFileId, vsi_l_offset iBlock )
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    auto oIter = m_oMapChunks.find(Key(nFileId, iBlock));
+    if( oIter == m_oMapChunks.end() )
+        return VSICacheChunkPtr();
+    m_oLRU.splice(m_oLRU.begin(), m_oLRU, oIter->second);
+    return oIter->second->second;
+}
+
+/************************************************************************/
+/*                              Contains()                              */
+/************************************************************************/
+
+bool VSICachePool::Contains( GUIntBig nFileId, vsi_l_offset iBlock )
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    return m_oMapChunks.find(Key(nFileId, iBlock)) != m_oMapChunks.end();
+}
+
+/************************************************************************/
+/*                                Put()                                 */
+/************************************************************************/
+
+void VSICachePool::Put( GUIntBig nFileId, vsi_l_offset iBlock,
+                        const VSICacheChunkPtr& poChunk )
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    const Key oKey(nFileId, iBlock);
+    auto oIter = m_oMapChunks.find(oKey);
+    if( oIter != m_oMapChunks.end() )
     {
-        CPLAssert( pabyData == nullptr );
-        pabyData = static_cast<GByte *>(VSIMalloc( nChunkSize ));
-        return (pabyData != nullptr);
+        // Another handle loaded it in the meantime.
+        m_nCacheUsed -= oIter->second->second->size();
+        m_oLRU.erase(oIter->second);
+        m_oMapChunks.erase(oIter);
     }
+    m_oLRU.emplace_front(oKey, poChunk);
+    m_oMapChunks[oKey] = m_oLRU.begin();
+    m_nCacheUsed += poChunk->size();
+    Evict();
+}
 
-    vsi_l_offset   iBlock = 0;
-
-    VSICacheChunk *poLRUPrev = nullptr;
-    VSICacheChunk *poLRUNext = nullptr;
+/************************************************************************/
+/*                             Invalidate()                             */
+/************************************************************************/
 
-    vsi_l_offset   nDataFilled = 0;
-    GByte          *pabyData = nullptr;
-};
+void VSICachePool::Invalidate( GUIntBig nFileId, vsi_l_offset iFirstBlock,
+                               vsi_l_offset iLastBlock )
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    auto oIter = m_oMapChunks.lower_bound(Key(nFileId, iFirstBlock));
+    while( oIter != m_oMapChunks.end() &&
+           oIter->first.first == nFileId &&
+           oIter->first.second <= iLastBlock )
+    {
+        m_nCacheUsed -= oIter->second->second->size();
+        m_oLRU.erase(oIter->second);
+        oIter = m_oMapChunks.erase(oIter);
+    }
+}
 
 /************************************************************************/
 /* ==================================================================== */
@@ -93,33 +223,42 @@ class VSICachedFile final : public VSIVirtualHandle
 {
     CPL_DISALLOW_COPY_ASSIGN(VSICachedFile)
 
-  public:
-    VSICachedFile( VSIVirtualHandle *poBaseHandle,
-                   size_t nChunkSize,
-                   size_t nCacheSize );
-    ~VSICachedFile() override { Close(); }
-
-    void          FlushLRU();
-    int           LoadBlocks( vsi_l_offset nStartBlock, size_t nBlockCount,
-                              void *pBuffer, size_t nBufferSize );
-    void          Demote( VSICacheChunk * );
-
     VSIVirtualHandle *poBase = nullptr;
 
     vsi_l_offset  nOffset = 0;
     vsi_l_offset  nFileSize = 0;
 
-    GUIntBig      nCacheUsed = 0;
-    GUIntBig      nCacheMax = 0;
-
     size_t        m_nChunkSize = 0;
+    size_t        m_nReadAheadChunks = 0;
 
-    VSICacheChunk *poLRUStart = nullptr;
-    VSICacheChunk *poLRUEnd = nullptr;
+    std::shared_ptr<VSICachePool> m_poPool{};
+    GUIntBig      m_nFileId = 0;
 
-    std::map<vsi_l_offset, VSICacheChunk*> oMapOffsetToCache{};
+    bool          bEOF = false;
 
-    bool           bEOF = false;
+    // Write-back buffer: pending bytes to write at m_nWriteBufferOffset.
+    bool          m_bWriteBack = false;
+    size_t        m_nWriteBufferMax = 0;
+    std::vector<GByte> m_abyWriteBuffer{};
+    vsi_l_offset  m_nWriteBufferOffset = 0;
+    bool          m_bWriteError = false;
+
+    bool          LoadBlocks( vsi_l_offset nStartBlock, size_t nBlockCount,
+                              VSICacheChunkPtr* papoChunks,
+                              size_t nChunksWanted );
+    bool          WriteToBase( vsi_l_offset nWriteOffset,
+                               const GByte* pabyData, size_t nBytes );
+    bool          FlushWriteBuffer( bool bKeepUnalignedTail = false );
+    bool          OverlapsWriteBuffer( vsi_l_offset nStart,
+                                       vsi_l_offset nLength ) const;
+
+  public:
+    VSICachedFile( VSIVirtualHandle *poBaseHandle,
+                   size_t nChunkSize,
+                   const std::shared_ptr<VSICachePool>& poPool,
+                   GUIntBig nFileId,
+                   bool bWriteBack );
+    ~VSICachedFile() override { Close(); }
 
     int Seek( vsi_l_offset nOffset, int nWhence ) override;
     vsi_l_offset Tell() override;
@@ -134,6 +273,7 @@ class VSICachedFile final : public VSIVirtualHandle
     int Eof() override;
     int Flush() override;
     int Close() override;
+    int Truncate( vsi_l_offset nNewSize ) override;
     void *GetNativeFileDescriptor() override
         { return poBase->GetNativeFileDescriptor(); }
 };
@@ -143,14 +283,30 @@ class VSICachedFile final : public VSIVirtualHandle
 /************************************************************************/
 
 VSICachedFile::VSICachedFile( VSIVirtualHandle *poBaseHandle, size_t nChunkSize,
-                              size_t nCacheSize ) :
+                              const std::shared_ptr<VSICachePool>& poPool,
+                              GUIntBig nFileId, bool bWriteBack ) :
     poBase(poBaseHandle),
-    nCacheMax(nCacheSize),
-    m_nChunkSize(nChunkSize)
+    m_nChunkSize(nChunkSize),
+    m_poPool(poPool),
+    m_nFileId(nFileId),
+    m_bWriteBack(bWriteBack)
 {
-    if( nCacheSize == 0 )
-        nCacheMax = CPLScanUIntBig(
-             CPLGetConfigOption( "VSI_CACHE_SIZE", "25000000" ), 40 );
+    const GUIntBig nReadAhead = CPLScanUIntBig(
+        CPLGetConfigOption( "VSI_CACHE_READAHEAD", "0" ), 40 );
+    m_nReadAheadChunks = static_cast<size_t>(
+        std::min(static_cast<GUIntBig>(1024),
+                 (nReadAhead + m_nChunkSize - 1) / m_nChunkSize));
+
+    if( m_bWriteBack )
+    {
+        const GUIntBig nWriteBufferSize = CPLScanUIntBig(
+            CPLGetConfigOption( "VSI_CACHE_WRITE_BUFFER_SIZE", "1048576" ),
+            40 );
+        m_nWriteBufferMax = static_cast<size_t>(
+            std::max(static_cast<GUIntBig>(m_nChunkSize),
+                     std::min(nWriteBufferSize,
+                              static_cast<GUIntBig>(256 * 1024 * 1024))));
+    }
 
     poBase->Seek( 0, SEEK_END );
     nFileSize = poBase->Tell();
@@ -163,28 +319,18 @@ VSICachedFile::VSICachedFile( VSIVirtualHandle *poBaseHandle, size_t nChunkSize,
 int VSICachedFile::Close()
 
 {
-    for( std::map<vsi_l_offset, VSICacheChunk*>::iterator oIter =
-             oMapOffsetToCache.begin();
-         oIter != oMapOffsetToCache.end();
-         ++oIter )
-    {
-        delete oIter->second;
-    }
-    oMapOffsetToCache.clear();
-
-    poLRUStart = nullptr;
-    poLRUEnd = nullptr;
-
-    nCacheUsed = 0;
-
+    int nRet = 0;
     if( poBase )
     {
-        poBase->Close();
+        if( !FlushWriteBuffer() || m_bWriteError )
+            nRet = -1;
+        if( poBase->Close() != 0 )
+            nRet = -1;
         delete poBase;
         poBase = nullptr;
     }
 
-    return 0;
+    return nRet;
 }
 
 /************************************************************************/
@@ -224,185 +370,73 @@ vsi_l_offset VSICachedFile::Tell()
     return nOffset;
 }
 
-/************************************************************************/
-/*                              FlushLRU()                              */
-/************************************************************************/
-
-void VSICachedFile::FlushLRU()
-
-{
-    CPLAssert( poLRUStart != nullptr );
-
-    VSICacheChunk *poBlock = poLRUStart;
-
-    CPLAssert( nCacheUsed >= poBlock->nDataFilled );
-
-    nCacheUsed -= poBlock->nDataFilled;
-
-    poLRUStart = poBlock->poLRUNext;
-    if( poLRUEnd == poBlock )
-        poLRUEnd = nullptr;
-
-    if( poBlock->poLRUNext != nullptr )
-        poBlock->poLRUNext->poLRUPrev = nullptr;
-
-    oMapOffsetToCache[poBlock->iBlock] = nullptr;
-
-    delete poBlock;
-}
-
-/************************************************************************/
-/*                               Demote()                               */
-/*                                                                      */
-/*      Demote the indicated block to the end of the LRU list.          */
-/*      Potentially integrate the link into the list if it is not       */
-/*      already there.                                                  */
-/************************************************************************/
-
-void VSICachedFile::Demote( VSICacheChunk *poBlock )
-
-{
-    // Already at end?
-    if( poLRUEnd == poBlock )
-        return;
-
-    if( poLRUStart == poBlock )
-        poLRUStart = poBlock->poLRUNext;
-
-    if( poBlock->poLRUPrev != nullptr )
-        poBlock->poLRUPrev->poLRUNext = poBlock->poLRUNext;
-
-    if( poBlock->poLRUNext != nullptr )
-        poBlock->poLRUNext->poLRUPrev = poBlock->poLRUPrev;
-
-    poBlock->poLRUNext = nullptr;
-    poBlock->poLRUPrev = nullptr;
-
-    if( poLRUEnd != nullptr )
-        poLRUEnd->poLRUNext = poBlock;
-
-    poLRUEnd = poBlock;
-
-    if( poLRUStart == nullptr )
-        poLRUStart = poBlock;
-}
-
 /************************************************************************/
 /*                             LoadBlocks()                             */
 /*                                                                      */
-/*      Load the desired set of blocks.  Use pBuffer as a temporary     */
-/*      buffer if it would be helpful.                                  */
+/*      Load the desired set of blocks with a single read of the base   */
+/*      handle, add them to the pool, and return the first              */
+/*      nChunksWanted ones.                                             */
 /*                                                                      */
-/*  RETURNS: TRUE on success; FALSE on failure.                         */
+/*      As the pool outlives the handle, only complete chunks, or the   */
+/*      one ending exactly at the end of file, are cached: a short      */
+/*      read, for example a transient error, is not stored and returns  */
+/*      false if it affects one of the wanted chunks. The chunks        */
+/*      returned up to the short one, included, are still valid for     */
+/*      this read.                                                      */
 /************************************************************************/
 
-int VSICachedFile::LoadBlocks( vsi_l_offset nStartBlock, size_t nBlockCount,
-                               void *pBuffer, size_t nBufferSize )
+bool VSICachedFile::LoadBlocks( vsi_l_offset nStartBlock, size_t nBlockCount,
+                                VSICacheChunkPtr* papoChunks,
+                                size_t nChunksWanted )
 
 {
-    if( nBlockCount == 0 )
-        return TRUE;
-
-/* -------------------------------------------------------------------- */
-/*      When we want to load only one block, we can directly load it    */
-/*      into the target buffer with no concern about intermediaries.    */
-/* -------------------------------------------------------------------- */
-    if( nBlockCount == 1 )
-    {
-        poBase->Seek( static_cast<vsi_l_offset>(nStartBlock) * m_nChunkSize,
-                      SEEK_SET );
+    if( poBase->Seek( nStartBlock * m_nChunkSize, SEEK_SET ) != 0 )
+        return false;
 
-        VSICacheChunk *poBlock = new VSICacheChunk();
-        if( !poBlock || !poBlock->Allocate( m_nChunkSize ) )
-        {
-            delete poBlock;
-            return FALSE;
-        }
-
-        oMapOffsetToCache[nStartBlock] = poBlock;
-
-        poBlock->iBlock = nStartBlock;
-        poBlock->nDataFilled =
-            poBase->Read( poBlock->pabyData, 1, m_nChunkSize );
-        nCacheUsed += poBlock->nDataFilled;
-
-        // Merges into the LRU list.
-        Demote( poBlock );
-
-        return TRUE;
+    std::vector<GByte> abyWorkBuffer;
+    try
+    {
+        abyWorkBuffer.resize(nBlockCount * m_nChunkSize);
     }
-
-/* -------------------------------------------------------------------- */
-/*      If the buffer is quite large but not quite large enough to      */
-/*      hold all the blocks we will take the pain of splitting the      */
-/*      io request in two in order to avoid allocating a large          */
-/*      temporary buffer.                                               */
-/* -------------------------------------------------------------------- */
-    if( nBufferSize > m_nChunkSize * 20
-        && nBufferSize < nBlockCount * m_nChunkSize )
+    catch( const std::exception& )
     {
-        if( !LoadBlocks( nStartBlock, 2, pBuffer, nBufferSize ) )
-            return FALSE;
-
-        return LoadBlocks( nStartBlock+2, nBlockCount-2, pBuffer, nBufferSize );
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate " CPL_FRMT_GUIB " bytes",
+                 static_cast<GUIntBig>(nBlockCount) * m_nChunkSize);
+        return false;
     }
 
-    if( poBase->Seek( static_cast<vsi_l_offset>(nStartBlock) * m_nChunkSize,
-                      SEEK_SET ) != 0 )
-        return FALSE;
-
-/* -------------------------------------------------------------------- */
-/*      Do we need to allocate our own buffer?                          */
-/* -------------------------------------------------------------------- */
-    GByte *pabyWorkBuffer = static_cast<GByte *>(pBuffer);
-
-    if( nBufferSize < m_nChunkSize * nBlockCount )
-        pabyWorkBuffer =
-            static_cast<GByte *>( CPLMalloc(m_nChunkSize * nBlockCount) );
-
-/* -------------------------------------------------------------------- */
-/*      Read the whole request into the working buffer.                 */
-/* -------------------------------------------------------------------- */
-
     const size_t nDataRead =
-        poBase->Read( pabyWorkBuffer, 1, nBlockCount*m_nChunkSize);
-
-    if( nBlockCount * m_nChunkSize > nDataRead + m_nChunkSize - 1 )
-        nBlockCount = (nDataRead + m_nChunkSize - 1) / m_nChunkSize;
+        poBase->Read( &abyWorkBuffer[0], 1, abyWorkBuffer.size() );
 
     for( size_t i = 0; i < nBlockCount; i++ )
     {
-        VSICacheChunk *poBlock = new VSICacheChunk();
-        if( !poBlock || !poBlock->Allocate( m_nChunkSize ) )
+        const size_t nChunkStart = i * m_nChunkSize;
+        const vsi_l_offset nChunkOffset =
+            (nStartBlock + i) * m_nChunkSize;
+        if( nChunkOffset >= nFileSize )
+            break;
+        const size_t nChunkBytes =
+            std::min(m_nChunkSize, nDataRead - std::min(nDataRead,
+                                                          nChunkStart));
+        VSICacheChunkPtr poChunk = std::make_shared<const std::vector<GByte>>(
+            abyWorkBuffer.begin() + nChunkStart,
+            abyWorkBuffer.begin() + nChunkStart + nChunkBytes);
+        if( nChunkBytes < m_nChunkSize &&
+            nChunkOffset + nChunkBytes != nFileSize )
         {
-            delete poBlock;
-            return FALSE;
+            if( i >= nChunksWanted )
+                return true;
+            // Returned to the caller for this read only.
+            papoChunks[i] = poChunk;
+            return false;
         }
-
-        poBlock->iBlock = nStartBlock + i;
-
-        CPLAssert( oMapOffsetToCache[i+nStartBlock] == nullptr );
-
-        oMapOffsetToCache[i + nStartBlock] = poBlock;
-
-        if( nDataRead >= (i+1) * m_nChunkSize )
-            poBlock->nDataFilled = m_nChunkSize;
-        else
-            poBlock->nDataFilled = nDataRead - i*m_nChunkSize;
-
-        memcpy( poBlock->pabyData, pabyWorkBuffer + i*m_nChunkSize,
-                static_cast<size_t>(poBlock->nDataFilled) );
-
-        nCacheUsed += poBlock->nDataFilled;
-
-        // Merges into the LRU list.
-        Demote( poBlock );
+        m_poPool->Put( m_nFileId, nStartBlock + i, poChunk );
+        if( i < nChunksWanted )
+            papoChunks[i] = poChunk;
     }
 
-    if( pabyWorkBuffer != pBuffer )
-        CPLFree( pabyWorkBuffer );
-
-    return TRUE;
+    return true;
 }
 
 /************************************************************************/
@@ -412,30 +446,66 @@ int VSICachedFile::LoadBlocks( vsi_l_offset nStartBlock, size_t nBlockCount,
 size_t VSICachedFile::Read( void * pBuffer, size_t nSize, size_t nCount )
 
 {
+    if( nSize == 0 || nCount == 0 )
+        return 0;
+
     if( nOffset >= nFileSize )
     {
         bEOF = true;
         return 0;
     }
 
+    const size_t nToRead = static_cast<size_t>(
+        std::min(static_cast<vsi_l_offset>(nSize) * nCount,
+                 nFileSize - nOffset));
+
+    if( OverlapsWriteBuffer(nOffset, nToRead) && !FlushWriteBuffer() )
+        return 0;
+
 /* ==================================================================== */
-/*      Make sure the cache is loaded for the whole request region.     */
+/*      Collect the chunks of the request region, loading the runs of   */
+/*      missing ones, extended by the readahead, with a single read.    */
 /* ==================================================================== */
     const vsi_l_offset nStartBlock = nOffset / m_nChunkSize;
-    const vsi_l_offset nEndBlock =
-        (nOffset + nSize * nCount - 1) / m_nChunkSize;
+    const vsi_l_offset nEndBlock = (nOffset + nToRead - 1) / m_nChunkSize;
+    const vsi_l_offset nLastFileBlock = (nFileSize - 1) / m_nChunkSize;
+    const size_t nBlocks = static_cast<size_t>(nEndBlock - nStartBlock + 1);
+
+    std::vector<VSICacheChunkPtr> apoChunks(nBlocks);
+    for( size_t i = 0; i < nBlocks; i++ )
+        apoChunks[i] = m_poPool->Get( m_nFileId, nStartBlock + i );
 
-    for( vsi_l_offset iBlock = nStartBlock; iBlock <= nEndBlock; iBlock++ )
+    size_t nBlocksAvailable = nBlocks;
+    for( size_t i = 0; i < nBlocks; i++ )
     {
-        if( oMapOffsetToCache[iBlock] == nullptr )
+        if( apoChunks[i] )
+            continue;
+
+        size_t nWanted = 1;
+        while( i + nWanted < nBlocks && !apoChunks[i + nWanted] )
+            nWanted++;
+
+        size_t nToLoad = nWanted;
+        while( nToLoad < nWanted + m_nReadAheadChunks &&
+               nStartBlock + i + nToLoad <= nLastFileBlock &&
+               (i + nToLoad < nBlocks ||
+                !m_poPool->Contains( m_nFileId, nStartBlock + i + nToLoad )) )
         {
-            size_t nBlocksToLoad = 1;
-            while( iBlock + nBlocksToLoad <= nEndBlock
-                   && (oMapOffsetToCache[iBlock+nBlocksToLoad] == nullptr) )
-                nBlocksToLoad++;
+            // Chunks of the request that are already cached get reloaded
+            // with the run: this is cheaper than splitting the read.
+            nToLoad++;
+        }
 
-            LoadBlocks( iBlock, nBlocksToLoad, pBuffer, nSize * nCount );
+        if( !LoadBlocks( nStartBlock + i, nToLoad, &apoChunks[i],
+                         std::min(nToLoad, nBlocks - i) ) )
+        {
+            // Keep the chunks loaded up to the short read.
+            nBlocksAvailable = i;
+            while( nBlocksAvailable < nBlocks && apoChunks[nBlocksAvailable] )
+                nBlocksAvailable++;
+            break;
         }
+        i += nWanted - 1;
     }
 
 /* ==================================================================== */
@@ -443,49 +513,28 @@ size_t VSICachedFile::Read( void * pBuffer, size_t nSize, size_t nCount )
 /* ==================================================================== */
     size_t nAmountCopied = 0;
 
-    while( nAmountCopied < nSize * nCount )
+    for( size_t i = 0; i < nBlocksAvailable && nAmountCopied < nToRead; i++ )
     {
-        const vsi_l_offset iBlock = (nOffset + nAmountCopied) / m_nChunkSize;
-        VSICacheChunk * poBlock = oMapOffsetToCache[iBlock];
-        if( poBlock == nullptr )
-        {
-            // We can reach that point when the amount to read exceeds
-            // the cache size.
-            LoadBlocks(iBlock, 1,
-                       static_cast<GByte *>(pBuffer) + nAmountCopied,
-                       std::min(nSize * nCount - nAmountCopied, m_nChunkSize));
-            poBlock = oMapOffsetToCache[iBlock];
-            CPLAssert(poBlock != nullptr);
-        }
-
-        const vsi_l_offset nStartOffset =
-            static_cast<vsi_l_offset>(iBlock) * m_nChunkSize;
-        size_t nThisCopy = static_cast<size_t>(
-            ((nStartOffset + poBlock->nDataFilled)
-             - nAmountCopied - nOffset));
-
-        if( nThisCopy > nSize * nCount - nAmountCopied )
-            nThisCopy = nSize * nCount - nAmountCopied;
-
-        if( nThisCopy == 0 )
+        const std::vector<GByte>& abyChunk = *apoChunks[i];
+        const vsi_l_offset nChunkOffset = (nStartBlock + i) * m_nChunkSize;
+        const size_t nInChunk =
+            static_cast<size_t>(nOffset + nAmountCopied - nChunkOffset);
+        if( nInChunk >= abyChunk.size() )
             break;
 
+        const size_t nThisCopy = std::min(abyChunk.size() - nInChunk,
+                                          nToRead - nAmountCopied);
         memcpy( static_cast<GByte *>(pBuffer) + nAmountCopied,
-                poBlock->pabyData
-                + (nOffset + nAmountCopied) - nStartOffset,
-                nThisCopy );
-
+                abyChunk.data() + nInChunk, nThisCopy );
         nAmountCopied += nThisCopy;
+
+        // A short chunk means that the file ended earlier than expected.
+        if( abyChunk.size() < m_nChunkSize )
+            break;
     }
 
     nOffset += nAmountCopied;
 
-/* -------------------------------------------------------------------- */
-/*      Ensure the cache is reduced to our limit.                       */
-/* -------------------------------------------------------------------- */
-    while( nCacheUsed > nCacheMax )
-        FlushLRU();
-
     const size_t nRet = nAmountCopied / nSize;
     if( nRet != nCount )
         bEOF = true;
@@ -500,19 +549,153 @@ int VSICachedFile::ReadMultiRange( int const nRanges, void ** const ppData,
                                    const vsi_l_offset* const panOffsets,
                                    const size_t* const panSizes )
 {
+    if( !FlushWriteBuffer() )
+        return -1;
+
     // If the base is /vsicurl/
     return poBase->ReadMultiRange( nRanges, ppData, panOffsets, panSizes );
 }
 
+/************************************************************************/
+/*                        OverlapsWriteBuffer()                         */
+/************************************************************************/
+
+bool VSICachedFile::OverlapsWriteBuffer( vsi_l_offset nStart,
+                                         vsi_l_offset nLength ) const
+{
+    return !m_abyWriteBuffer.empty() &&
+           nStart < m_nWriteBufferOffset + m_abyWriteBuffer.size() &&
+           m_nWriteBufferOffset < nStart + nLength;
+}
+
+/************************************************************************/
+/*                            WriteToBase()                             */
+/************************************************************************/
+
+bool VSICachedFile::WriteToBase( vsi_l_offset nWriteOffset,
+                                 const GByte* pabyData, size_t nBytes )
+{
+    if( nBytes == 0 )
+        return true;
+
+    // Cached chunks of the written region, including the trailing short
+    // chunk whose size changes when the file grows, are now stale.
+    m_poPool->Invalidate( m_nFileId, nWriteOffset / m_nChunkSize,
+                          (nWriteOffset + nBytes - 1) / m_nChunkSize );
+
+    if( poBase->Seek( nWriteOffset, SEEK_SET ) != 0 ||
+        poBase->Write( pabyData, 1, nBytes ) != nBytes )
+    {
+        m_bWriteError = true;
+        return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          FlushWriteBuffer()                          */
+/*                                                                      */
+/*      Write the pending bytes. With bKeepUnalignedTail, only write    */
+/*      up to the last chunk boundary, so that sequential writers       */
+/*      issue chunk aligned writes.                                     */
+/************************************************************************/
+
+bool VSICachedFile::FlushWriteBuffer( bool bKeepUnalignedTail )
+{
+    if( m_abyWriteBuffer.empty() )
+        return true;
+
+    size_t nToFlush = m_abyWriteBuffer.size();
+    if( bKeepUnalignedTail )
+    {
+        const vsi_l_offset nAlignedEnd =
+            (m_nWriteBufferOffset + nToFlush) / m_nChunkSize * m_nChunkSize;
+        if( nAlignedEnd > m_nWriteBufferOffset )
+            nToFlush = static_cast<size_t>(nAlignedEnd - m_nWriteBufferOffset);
+    }
+
+    const bool bRet = WriteToBase( m_nWriteBufferOffset,
+                                   m_abyWriteBuffer.data(), nToFlush );
+    m_abyWriteBuffer.erase( m_abyWriteBuffer.begin(),
+                            m_abyWriteBuffer.begin() + nToFlush );
+    m_nWriteBufferOffset += nToFlush;
+    return bRet;
+}
+
 /************************************************************************/
 /*                               Write()                                */
 /************************************************************************/
 
-size_t VSICachedFile::Write( const void * /* pBuffer */,
-                             size_t /*nSize */ ,
-                             size_t /* nCount */ )
+size_t VSICachedFile::Write( const void * pBuffer,
+                             size_t nSize,
+                             size_t nCount )
 {
-    return 0;
+    if( !m_bWriteBack || nSize == 0 || nCount == 0 )
+        return 0;
+
+    const size_t nBytes = nSize * nCount;
+    const GByte* pabyData = static_cast<const GByte*>(pBuffer);
+
+    if( !m_abyWriteBuffer.empty() &&
+        nOffset >= m_nWriteBufferOffset &&
+        nOffset + nBytes <= m_nWriteBufferOffset + m_abyWriteBuffer.size() )
+    {
+        // Rewrite of pending bytes.
+        memcpy( &m_abyWriteBuffer[
+                    static_cast<size_t>(nOffset - m_nWriteBufferOffset)],
+                pabyData, nBytes );
+    }
+    else
+    {
+        const bool bAppend = !m_abyWriteBuffer.empty() &&
+            nOffset == m_nWriteBufferOffset + m_abyWriteBuffer.size();
+        if( !bAppend && !FlushWriteBuffer() )
+            return 0;
+        if( bAppend &&
+            m_abyWriteBuffer.size() + nBytes > m_nWriteBufferMax &&
+            !FlushWriteBuffer(true) )
+        {
+            return 0;
+        }
+        if( m_abyWriteBuffer.size() + nBytes > m_nWriteBufferMax )
+        {
+            // Large write: not worth buffering.
+            if( !FlushWriteBuffer() ||
+                !WriteToBase( nOffset, pabyData, nBytes ) )
+                return 0;
+        }
+        else
+        {
+            if( m_abyWriteBuffer.empty() )
+            {
+                m_abyWriteBuffer.reserve( m_nWriteBufferMax );
+                m_nWriteBufferOffset = nOffset;
+            }
+            m_abyWriteBuffer.insert( m_abyWriteBuffer.end(),
+                                     pabyData, pabyData + nBytes );
+        }
+    }
+
+    nOffset += nBytes;
+    nFileSize = std::max(nFileSize, nOffset);
+    return nCount;
+}
+
+/************************************************************************/
+/*                              Truncate()                              */
+/************************************************************************/
+
+int VSICachedFile::Truncate( vsi_l_offset nNewSize )
+{
+    if( !m_bWriteBack || !FlushWriteBuffer() )
+        return -1;
+
+    m_poPool->Invalidate( m_nFileId, nNewSize / m_nChunkSize,
+                          ~static_cast<vsi_l_offset>(0) );
+    const int nRet = poBase->Truncate( nNewSize );
+    if( nRet == 0 )
+        nFileSize = nNewSize;
+    return nRet;
 }
 
 /************************************************************************/
@@ -532,7 +715,11 @@ int VSICachedFile::Eof()
 int VSICachedFile::Flush()
 
 {
-    return 0;
+    if( !m_bWriteBack )
+        return 0;
+    if( !FlushWriteBuffer() )
+        return -1;
+    return poBase->Flush();
 }
 
 //! @endcond
@@ -541,10 +728,93 @@ int VSICachedFile::Flush()
 /*                        VSICreateCachedFile()                         */
 /************************************************************************/
 
+/**
+ * \brief Wrap a file handle in a read cache private to the new handle.
+ *
+ * @param poBaseHandle handle to wrap, owned by the returned handle.
+ * @param nChunkSize size of the cached chunks.
+ * @param nCacheSize maximum size of the cache, or 0 to use the VSI_CACHE_SIZE
+ * configuration option (25 MB by default).
+ */
+
 VSIVirtualHandle *
 VSICreateCachedFile( VSIVirtualHandle *poBaseHandle,
                      size_t nChunkSize, size_t nCacheSize )
 
 {
-    return new VSICachedFile( poBaseHandle, nChunkSize, nCacheSize );
+    const GUIntBig nCacheMax = nCacheSize != 0 ? nCacheSize :
+        CPLScanUIntBig(
+            CPLGetConfigOption( "VSI_CACHE_SIZE", "25000000" ), 40 );
+    auto poPool = std::make_shared<VSICachePool>(nCacheMax);
+    const GUIntBig nFileId = poPool->GetFileId(std::string());
+    return new VSICachedFile( poBaseHandle, nChunkSize, poPool, nFileId,
+                              false );
+}
+
+/************************************************************************/
+/*                     VSICreateSharedCachedFile()                      */
+/************************************************************************/
+
+/**
+ * \brief Wrap a file handle in the cache shared by all handles.
+ *
+ * Chunks are shared by the handles of the same file, identified by its
+ * name, size and modification time, and persist after the handle is
+ * closed, within the limit of the VSI_CACHE_SIZE configuration option
+ * (25 MB by default) for the whole process. VSI_CACHE_CHUNK_SIZE sets the
+ * chunk size (32 KB by default), and VSI_CACHE_READAHEAD the number of
+ * bytes loaded beyond the requested range on a cache miss.
+ *
+ * The modification time has a resolution of one second: a file rewritten
+ * in place, without changing its size, within the same second as it was
+ * cached, and not through a cached handle, is served stale chunks.
+ *
+ * With bWriteBack, the handle also accepts writes, and coalesces them in a
+ * buffer of VSI_CACHE_WRITE_BUFFER_SIZE bytes (1 MB by default) that is
+ * written to the base handle when a non contiguous region is written, on
+ * reads of the pending region, and on Flush() and Close().
+ *
+ * @param poFS handler of pszFilename, used to stat it.
+ * @param pszFilename name of the file.
+ * @param poBaseHandle handle to wrap, owned by the returned handle.
+ * @param bWriteBack whether the handle is writable.
+ */
+
+VSIVirtualHandle *
+VSICreateSharedCachedFile( VSIFilesystemHandler* poFS,
+                           const char* pszFilename,
+                           VSIVirtualHandle *poBaseHandle,
+                           bool bWriteBack )
+{
+    const size_t nChunkSize = static_cast<size_t>(
+        std::max(static_cast<GUIntBig>(512),
+                 std::min(static_cast<GUIntBig>(16 * 1024 * 1024),
+                          CPLScanUIntBig(CPLGetConfigOption(
+                              "VSI_CACHE_CHUNK_SIZE", "32768"), 40))));
+
+    VSIStatBufL sStat;
+    if( poFS->Stat( pszFilename, &sStat,
+                    VSI_STAT_EXISTS_FLAG | VSI_STAT_SIZE_FLAG ) != 0 )
+    {
+        // Without a reliable identity, do not share the chunks.
+        auto poPool = std::make_shared<VSICachePool>(CPLScanUIntBig(
+            CPLGetConfigOption( "VSI_CACHE_SIZE", "25000000" ), 40 ));
+        return new VSICachedFile( poBaseHandle, nChunkSize, poPool,
+                                  poPool->GetFileId(std::string()),
+                                  bWriteBack );
+    }
+
+    // Identity of the file content. st_mtime only has a one second
+    // resolution, so this does not detect an in-place rewrite of the same
+    // size within the second (see above).
+    auto poPool = GetSharedPool();
+    poPool->SetMaxSize( CPLScanUIntBig(
+        CPLGetConfigOption( "VSI_CACHE_SIZE", "25000000" ), 40 ) );
+    const std::string osKey(
+        CPLSPrintf( "%s|" CPL_FRMT_GUIB "|" CPL_FRMT_GIB "|%u",
+                    pszFilename, static_cast<GUIntBig>(sStat.st_size),
+                    static_cast<GIntBig>(sStat.st_mtime),
+                    static_cast<unsigned>(nChunkSize) ) );
+    return new VSICachedFile( poBaseHandle, nChunkSize, poPool,
+                              poPool->GetFileId(osKey), bWriteBack );
 }
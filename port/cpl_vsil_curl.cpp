@@ -35,11 +35,20 @@
 #include <map>
 #include <memory>
 
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#include "cpl_atomic_ops.h"
 #include "cpl_aws.h"
+#include "cpl_md5.h"
 #include "cpl_minixml.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "cpl_time.h"
+#include "cpl_trace.h"
 #include "cpl_vsi.h"
 #include "cpl_vsi_virtual.h"
 #include "cpl_http.h"
@@ -96,6 +105,11 @@ int VSICurlUninstallReadCbk( VSILFILE* /* fp */ )
 static int N_MAX_REGIONS = 1000;
 static int DOWNLOAD_CHUNK_SIZE = 16384;
 
+// Options read for each request.
+static const CPLCachedConfigOption oHTTPMultiplex("GDAL_HTTP_MULTIPLEX", "YES");
+static const CPLCachedConfigOption oUseS3Redirect(
+    "CPL_VSIL_CURL_USE_S3_REDIRECT", "TRUE");
+
 namespace cpl {
 
 /************************************************************************/
@@ -675,12 +689,46 @@ static GIntBig VSICurlGetExpiresFromS3LikeSignedURL( const char* pszURL )
     return 0;
 }
 
+/************************************************************************/
+/*                      RecordCompletedRequests()                       */
+/************************************************************************/
+
+// Feeds the I/O statistics with the transfers of the multi handle that
+// have completed.
+static void RecordCompletedRequests(CURLM* hCurlMultiHandle)
+{
+    CURLMsg *msg;
+    do {
+        int msgq = 0;
+        msg = curl_multi_info_read(hCurlMultiHandle, &msgq);
+        if(msg && (msg->msg == CURLMSG_DONE))
+        {
+            CURL *e = msg->easy_handle;
+            double dfTotalTime = 0.0;
+            double dfDownloaded = 0.0;
+            double dfUploaded = 0.0;
+            long response_code = 0;
+            curl_easy_getinfo(e, CURLINFO_TOTAL_TIME, &dfTotalTime);
+            curl_easy_getinfo(e, CURLINFO_SIZE_DOWNLOAD, &dfDownloaded);
+            curl_easy_getinfo(e, CURLINFO_SIZE_UPLOAD, &dfUploaded);
+            curl_easy_getinfo(e, CURLINFO_RESPONSE_CODE, &response_code);
+            const bool bError =
+                msg->data.result != CURLE_OK || response_code >= 400;
+            VSIIOStatsAddHTTPRequest(
+                bError, dfTotalTime,
+                dfDownloaded > 0 ? static_cast<GUIntBig>(dfDownloaded) : 0,
+                dfUploaded > 0 ? static_cast<GUIntBig>(dfUploaded) : 0);
+        }
+    } while(msg);
+}
+
 /************************************************************************/
 /*                           MultiPerform()                             */
 /************************************************************************/
 
 void MultiPerform(CURLM* hCurlMultiHandle, CURL* hEasyHandle)
 {
+    CPL_TRACE_SCOPE("http", "HTTPRequest");
     int repeats = 0;
 
     if( hEasyHandle )
@@ -700,22 +748,14 @@ void MultiPerform(CURLM* hCurlMultiHandle, CURL* hEasyHandle)
             break;
         }
 
-#ifdef undef
-        CURLMsg *msg;
-        do {
-            int msgq = 0;
-            msg = curl_multi_info_read(hCurlMultiHandle, &msgq);
-            if(msg && (msg->msg == CURLMSG_DONE))
-            {
-                CURL *e = msg->easy_handle;
-            }
-        } while(msg);
-#endif
+        RecordCompletedRequests(hCurlMultiHandle);
 
         CPLMultiPerformWait(hCurlMultiHandle, repeats);
     }
     CPLHTTPRestoreSigPipeHandler(old_handler);
 
+    RecordCompletedRequests(hCurlMultiHandle);
+
     if( hEasyHandle )
         curl_multi_remove_handle(hCurlMultiHandle, hEasyHandle);
 }
@@ -750,6 +790,13 @@ vsi_l_offset VSICurlHandle::GetFileSize( bool bSetError )
     if( oFileProp.bHasComputedFileSize )
         return oFileProp.fileSize;
 
+    if( m_bCached &&
+        poFS->GetFilePropFromPersistentCache(m_pszURL, oFileProp) )
+    {
+        poFS->SetCachedFileProp(m_pszURL, oFileProp);
+        return oFileProp.fileSize;
+    }
+
     oFileProp.bHasComputedFileSize = true;
 
     CURLM* hCurlMultiHandle = poFS->GetCurlMultiHandleFor(m_pszURL);
@@ -1154,6 +1201,8 @@ retry:
     if( mtime > 0 )
         oFileProp.mTime = mtime;
     poFS->SetCachedFileProp(m_pszURL, oFileProp);
+    if( m_bCached )
+        poFS->SetFilePropToPersistentCache(m_pszURL, oFileProp);
 
     return oFileProp.fileSize;
 }
@@ -1362,8 +1411,7 @@ retry:
             sWriteFuncHeaderData.nTimestampDate > 0 &&
             VSICurlIsS3LikeSignedURL(osEffectiveURL) &&
             !VSICurlIsS3LikeSignedURL(m_pszURL) &&
-            CPLTestBool(CPLGetConfigOption("CPL_VSIL_CURL_USE_S3_REDIRECT",
-                                           "TRUE")) )
+            oUseS3Redirect.GetBool() )
         {
             GIntBig nExpireTimestamp =
                 VSICurlGetExpiresFromS3LikeSignedURL(osEffectiveURL);
@@ -1523,6 +1571,170 @@ retry:
     return osRet;
 }
 
+/************************************************************************/
+/*                      DownloadRegionsParallel()                       */
+/************************************************************************/
+
+// Download, with parallel requests, nMaxRequests consecutive regions of
+// nBlocks blocks each, starting at startOffset, and put them in the region
+// cache. Returns the content of the first region, or an empty string if
+// it could not be downloaded this way.
+
+std::string VSICurlHandle::DownloadRegionsParallel(
+                                        const vsi_l_offset startOffset,
+                                        const int nBlocks,
+                                        const int nMaxRequests )
+{
+    if( bInterrupted && bStopOnInterruptUntilUninstall )
+        return std::string();
+
+    if( oFileProp.eExists == EXIST_NO || !oFileProp.bHasComputedFileSize )
+        return std::string();
+
+    const vsi_l_offset nRequestSize =
+        static_cast<vsi_l_offset>(nBlocks) * DOWNLOAD_CHUNK_SIZE;
+    int nRequests = 1;
+    while( nRequests < nMaxRequests &&
+           // Do not request more than the region cache can hold.
+           (nRequests + 1) * nBlocks <= N_MAX_REGIONS &&
+           // Some servers don't like we try to read after end-of-file
+           startOffset + nRequests * nRequestSize < oFileProp.fileSize &&
+           poFS->GetRegion(m_pszURL,
+                           startOffset + nRequests * nRequestSize) == nullptr )
+    {
+        nRequests++;
+    }
+    if( nRequests == 1 )
+        return std::string();
+
+    bool bHasExpired = false;
+    CPLString osURL(GetRedirectURLIfValid(bHasExpired));
+    if( bHasExpired )
+        return std::string();
+
+    CURLM * hMultiHandle = poFS->GetCurlMultiHandleFor(osURL);
+#ifdef CURLPIPE_MULTIPLEX
+    // Enable HTTP/2 multiplexing (ignored if an older version of HTTP is
+    // used)
+    if( oHTTPMultiplex.GetBool() )
+    {
+        curl_multi_setopt(hMultiHandle, CURLMOPT_PIPELINING,
+                          CURLPIPE_MULTIPLEX);
+    }
+#endif
+
+    std::vector<CURL*> aHandles;
+    std::vector<WriteFuncStruct> asWriteFuncData(nRequests);
+    std::vector<WriteFuncStruct> asWriteFuncHeaderData(nRequests);
+    std::vector<CPLString> aosRanges(nRequests);
+    std::vector<struct curl_slist*> aHeaders;
+
+    for( int i = 0; i < nRequests; i++ )
+    {
+        CURL* hCurlHandle = curl_easy_init();
+        aHandles.push_back(hCurlHandle);
+
+        struct curl_slist* headers =
+            VSICurlSetOptions(hCurlHandle, osURL, m_papszHTTPOptions);
+
+        VSICURLInitWriteFuncStruct(&asWriteFuncData[i],
+                                   reinterpret_cast<VSILFILE *>(this),
+                                   pfnReadCbk, pReadCbkUserData);
+        curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA,
+                         &asWriteFuncData[i]);
+        curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION,
+                         VSICurlHandleWriteFunc);
+
+        VSICURLInitWriteFuncStruct(&asWriteFuncHeaderData[i],
+                                   nullptr, nullptr, nullptr);
+        curl_easy_setopt(hCurlHandle, CURLOPT_HEADERDATA,
+                         &asWriteFuncHeaderData[i]);
+        curl_easy_setopt(hCurlHandle, CURLOPT_HEADERFUNCTION,
+                         VSICurlHandleWriteFunc);
+        asWriteFuncHeaderData[i].bIsHTTP = STARTS_WITH(m_pszURL, "http");
+        asWriteFuncHeaderData[i].nStartOffset = startOffset + i * nRequestSize;
+        asWriteFuncHeaderData[i].nEndOffset =
+            std::min(asWriteFuncHeaderData[i].nStartOffset + nRequestSize,
+                     oFileProp.fileSize) - 1;
+
+        char rangeStr[512] = {};
+        snprintf(rangeStr, sizeof(rangeStr),
+                CPL_FRMT_GUIB "-" CPL_FRMT_GUIB,
+                asWriteFuncHeaderData[i].nStartOffset,
+                asWriteFuncHeaderData[i].nEndOffset);
+
+        if( ENABLE_DEBUG )
+            CPLDebug("VSICURL", "Downloading %s (%s)...", rangeStr, osURL.c_str());
+
+        if( asWriteFuncHeaderData[i].bIsHTTP )
+        {
+            // So it gets included in Azure signature
+            aosRanges[i].Printf("Range: bytes=%s", rangeStr);
+            headers = curl_slist_append(headers, aosRanges[i].c_str());
+            curl_easy_setopt(hCurlHandle, CURLOPT_RANGE, nullptr);
+        }
+        else
+        {
+            curl_easy_setopt(hCurlHandle, CURLOPT_RANGE, rangeStr);
+        }
+
+        headers = VSICurlMergeHeaders(headers, GetCurlHeaders("GET", headers));
+        curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
+        aHeaders.push_back(headers);
+        curl_multi_add_handle(hMultiHandle, hCurlHandle);
+    }
+
+    MultiPerform(hMultiHandle);
+
+    std::string osRet;
+    for( int i = 0; i < nRequests; i++ )
+    {
+        long response_code = 0;
+        curl_easy_getinfo(aHandles[i], CURLINFO_HTTP_CODE, &response_code);
+
+        if( asWriteFuncData[i].bInterrupted )
+        {
+            bInterrupted = true;
+        }
+        // Errors are not reported: the caller will fall back to
+        // DownloadRegion() for the first region, and the other ones will
+        // just be downloaded again later.
+        else if( (response_code == 206 || response_code == 225) &&
+                 asWriteFuncHeaderData[i].nEndOffset + 1 ==
+                    asWriteFuncHeaderData[i].nStartOffset +
+                        asWriteFuncData[i].nSize )
+        {
+            DownloadRegionPostProcess(asWriteFuncHeaderData[i].nStartOffset,
+                                      nBlocks,
+                                      asWriteFuncData[i].pBuffer,
+                                      asWriteFuncData[i].nSize);
+            if( i == 0 )
+            {
+                osRet.assign(asWriteFuncData[i].pBuffer,
+                             asWriteFuncData[i].nSize);
+            }
+        }
+        else if( ENABLE_DEBUG )
+        {
+            CPLDebug("VSICURL", "DownloadRegionsParallel(%s): "
+                     "response_code=%d for range " CPL_FRMT_GUIB "-"
+                     CPL_FRMT_GUIB,
+                     osURL.c_str(), static_cast<int>(response_code),
+                     asWriteFuncHeaderData[i].nStartOffset,
+                     asWriteFuncHeaderData[i].nEndOffset);
+        }
+
+        curl_multi_remove_handle(hMultiHandle, aHandles[i]);
+        VSICURLResetHeaderAndWriterFunctions(aHandles[i]);
+        curl_easy_cleanup(aHandles[i]);
+        CPLFree(asWriteFuncData[i].pBuffer);
+        CPLFree(asWriteFuncHeaderData[i].pBuffer);
+        curl_slist_free_all(aHeaders[i]);
+    }
+
+    return osRet;
+}
+
 /************************************************************************/
 /*                      DownloadRegionPostProcess()                     */
 /************************************************************************/
@@ -1558,6 +1770,12 @@ void VSICurlHandle::DownloadRegionPostProcess( const vsi_l_offset startOffset,
         const size_t nChunkSize =
             std::min(static_cast<size_t>(DOWNLOAD_CHUNK_SIZE), nSize);
         poFS->AddRegion(m_pszURL, l_startOffset, nChunkSize, pBuffer);
+        if( m_bCached )
+        {
+            poFS->AddRegionToPersistentCache(m_pszURL, oFileProp,
+                                             l_startOffset, nChunkSize,
+                                             pBuffer);
+        }
         l_startOffset += nChunkSize;
         pBuffer += nChunkSize;
         nSize -= nChunkSize;
@@ -1607,9 +1825,20 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const nSize,
         {
             osRegion = *psRegion;
         }
+        else if( m_bCached &&
+                 poFS->GetRegionFromPersistentCache(m_pszURL, oFileProp,
+                                                    nOffsetToDownload,
+                                                    osRegion) )
+        {
+            poFS->AddRegion(m_pszURL, nOffsetToDownload,
+                            osRegion.size(), osRegion.data());
+            lastDownloadedOffset = nOffsetToDownload + DOWNLOAD_CHUNK_SIZE;
+        }
         else
         {
-            if( nOffsetToDownload == lastDownloadedOffset )
+            const bool bSequentialRead =
+                nOffsetToDownload == lastDownloadedOffset;
+            if( bSequentialRead )
             {
                 // In case of consecutive reads (of small size), we use a
                 // heuristic that we will read the file sequentially, so
@@ -1654,7 +1883,22 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const nSize,
             if( nBlocksToDownload > N_MAX_REGIONS )
                 nBlocksToDownload = N_MAX_REGIONS;
 
-            osRegion = DownloadRegion(nOffsetToDownload, nBlocksToDownload);
+            // For sequential reads, also fetch the next regions in
+            // parallel, so that the download is not bound by latency.
+            if( bSequentialRead && CanDownloadRegionsInParallel() )
+            {
+                static const CPLCachedConfigOption oParallelReadAhead(
+                    "CPL_VSIL_CURL_PARALLEL_READAHEAD", "1");
+                const int nParallelRequests = oParallelReadAhead.GetInt();
+                if( nParallelRequests > 1 )
+                {
+                    osRegion = DownloadRegionsParallel(nOffsetToDownload,
+                                                       nBlocksToDownload,
+                                                       nParallelRequests);
+                }
+            }
+            if( osRegion.empty() && !bInterrupted )
+                osRegion = DownloadRegion(nOffsetToDownload, nBlocksToDownload);
             if( osRegion.empty() )
             {
                 if( !bInterrupted )
@@ -1733,7 +1977,7 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     // recommended for example by Google Cloud Storage.
     // For HTTP/1.1, parallel connections work better since you can get
     // results out of order.
-    if( CPLTestBool(CPLGetConfigOption("GDAL_HTTP_MULTIPLEX", "YES")) )
+    if( oHTTPMultiplex.GetBool() )
     {
         curl_multi_setopt(hMultiHandle, CURLMOPT_PIPELINING,
                           CURLPIPE_MULTIPLEX);
@@ -1756,8 +2000,9 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     asWriteFuncHeaderData.resize(nRanges);
     asCurlErrors.resize(nRanges);
 
-    const bool bMergeConsecutiveRanges = CPLTestBool(CPLGetConfigOption(
-        "GDAL_HTTP_MERGE_CONSECUTIVE_RANGES", "TRUE"));
+    static const CPLCachedConfigOption oMergeConsecutiveRanges(
+        "GDAL_HTTP_MERGE_CONSECUTIVE_RANGES", "TRUE");
+    const bool bMergeConsecutiveRanges = oMergeConsecutiveRanges.GetBool();
 
     for( int i = 0, iRequest = 0; i < nRanges; )
     {
@@ -1983,9 +2228,9 @@ int VSICurlHandle::ReadMultiRangeSingleGet(
         osLastRange = osCurRange;
     }
 
-    const char* pszMaxRanges =
-        CPLGetConfigOption("CPL_VSIL_CURL_MAX_RANGES", "250");
-    int nMaxRanges = atoi(pszMaxRanges);
+    static const CPLCachedConfigOption oMaxRanges(
+        "CPL_VSIL_CURL_MAX_RANGES", "250");
+    int nMaxRanges = oMaxRanges.GetInt();
     if( nMaxRanges <= 0 )
         nMaxRanges = 250;
     if( nMergedRanges > nMaxRanges )
@@ -2497,8 +2742,6 @@ std::shared_ptr<std::string>
 VSICurlFilesystemHandler::GetRegion( const char* pszURL,
                                      vsi_l_offset nFileOffsetStart )
 {
-    CPLMutexHolder oHolder( &hMutex );
-
     nFileOffsetStart =
         (nFileOffsetStart / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
 
@@ -2521,8 +2764,6 @@ void VSICurlFilesystemHandler::AddRegion( const char* pszURL,
                                           size_t nSize,
                                           const char *pData )
 {
-    CPLMutexHolder oHolder( &hMutex );
-
     std::shared_ptr<std::string> value(new std::string());
     value->assign(pData, nSize);
     oRegionCache.insert(
@@ -2538,8 +2779,6 @@ bool
 VSICurlFilesystemHandler::GetCachedFileProp( const char* pszURL,
                                              FileProp& oFileProp )
 {
-    CPLMutexHolder oHolder( &hMutex );
-
     return oCacheFileProp.tryGet(std::string(pszURL), oFileProp);
 }
 
@@ -2551,11 +2790,360 @@ void
 VSICurlFilesystemHandler::SetCachedFileProp( const char* pszURL,
                                              const FileProp& oFileProp )
 {
-    CPLMutexHolder oHolder( &hMutex );
-
     oCacheFileProp.insert(std::string(pszURL), oFileProp);
 }
 
+/************************************************************************/
+/*                       GetPersistentCacheDir()                        */
+/************************************************************************/
+
+CPLString VSICurlFilesystemHandler::GetPersistentCacheDir()
+{
+    return CPLGetConfigOption("CPL_VSIL_CURL_PERSISTENT_CACHE_DIR", "");
+}
+
+/************************************************************************/
+/*                      GetPersistentCacheURLDir()                      */
+/************************************************************************/
+
+CPLString VSICurlFilesystemHandler::GetPersistentCacheURLDir(
+                                            const CPLString& osCacheDir,
+                                            const char* pszURL )
+{
+    return CPLFormFilename(osCacheDir, CPLMD5String(pszURL), nullptr);
+}
+
+/************************************************************************/
+/*                    GetPersistentCacheValidator()                     */
+/************************************************************************/
+
+// Returns a short string identifying the version of the remote file (from
+// its ETag or Last-Modified date and its size) and the chunk size, or an
+// empty string if cached content cannot be revalidated.
+CPLString VSICurlFilesystemHandler::GetPersistentCacheValidator(
+                                            const FileProp& oFileProp )
+{
+    if( !oFileProp.bHasComputedFileSize ||
+        oFileProp.eExists != EXIST_YES ||
+        oFileProp.bIsDirectory )
+    {
+        return CPLString();
+    }
+
+    CPLString osValidator;
+    if( !oFileProp.ETag.empty() )
+        osValidator = "etag:" + oFileProp.ETag;
+    else if( oFileProp.mTime > 0 )
+        osValidator.Printf("mtime:" CPL_FRMT_GIB,
+                           static_cast<GIntBig>(oFileProp.mTime));
+    else
+        return CPLString();
+    osValidator += CPLSPrintf(",size:" CPL_FRMT_GUIB ",chunk:%d",
+                              static_cast<GUIntBig>(oFileProp.fileSize),
+                              DOWNLOAD_CHUNK_SIZE);
+    return CPLString(CPLMD5String(osValidator)).substr(0, 16);
+}
+
+/************************************************************************/
+/*                  VSICurlPersistentCacheWriteFile()                   */
+/************************************************************************/
+
+// Write to a temporary file and rename it, so that other processes never
+// see a partially written file.
+static bool VSICurlPersistentCacheWriteFile( const CPLString& osFilename,
+                                             const void* pData,
+                                             size_t nSize )
+{
+    static int nCounter = 0;
+    const CPLString osTmpFilename(
+        osFilename + CPLSPrintf(".tmp.%d_%d", CPLGetCurrentProcessID(),
+                                CPLAtomicInc(&nCounter)));
+    VSILFILE* fp = VSIFOpenL(osTmpFilename, "wb");
+    if( fp == nullptr )
+        return false;
+    bool bOK = VSIFWriteL(pData, 1, nSize, fp) == nSize;
+    bOK &= VSIFCloseL(fp) == 0;
+    if( bOK )
+        bOK = VSIRename(osTmpFilename, osFilename) == 0;
+    if( !bOK )
+        VSIUnlink(osTmpFilename);
+    return bOK;
+}
+
+/************************************************************************/
+/*                    GetRegionFromPersistentCache()                    */
+/************************************************************************/
+
+bool VSICurlFilesystemHandler::GetRegionFromPersistentCache(
+                                            const char* pszURL,
+                                            const FileProp& oFileProp,
+                                            vsi_l_offset nFileOffsetStart,
+                                            std::string& osData )
+{
+    const CPLString osCacheDir(GetPersistentCacheDir());
+    if( osCacheDir.empty() )
+        return false;
+    const CPLString osValidator(GetPersistentCacheValidator(oFileProp));
+    if( osValidator.empty() )
+        return false;
+
+    nFileOffsetStart =
+        (nFileOffsetStart / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+    if( nFileOffsetStart >= oFileProp.fileSize )
+        return false;
+    const size_t nExpectedSize = static_cast<size_t>(
+        std::min(static_cast<vsi_l_offset>(DOWNLOAD_CHUNK_SIZE),
+                 oFileProp.fileSize - nFileOffsetStart));
+
+    const CPLString osFilename(CPLFormFilename(
+        GetPersistentCacheURLDir(osCacheDir, pszURL),
+        CPLSPrintf("%s_" CPL_FRMT_GUIB, osValidator.c_str(),
+                   static_cast<GUIntBig>(nFileOffsetStart)),
+        nullptr));
+    VSILFILE* fp = VSIFOpenL(osFilename, "rb");
+    if( fp == nullptr )
+        return false;
+    osData.resize(nExpectedSize + 1);
+    const size_t nRead = VSIFReadL(&osData[0], 1, osData.size(), fp);
+    VSIFCloseL(fp);
+    if( nRead != nExpectedSize )
+    {
+        osData.clear();
+        return false;
+    }
+    osData.resize(nRead);
+
+    // Update the modification time, which is used for LRU eviction.
+    utime(osFilename, nullptr);
+    return true;
+}
+
+/************************************************************************/
+/*                     AddRegionToPersistentCache()                     */
+/************************************************************************/
+
+void VSICurlFilesystemHandler::AddRegionToPersistentCache(
+                                            const char* pszURL,
+                                            const FileProp& oFileProp,
+                                            vsi_l_offset nFileOffsetStart,
+                                            size_t nSize,
+                                            const char *pData )
+{
+    const CPLString osCacheDir(GetPersistentCacheDir());
+    if( osCacheDir.empty() )
+        return;
+    const CPLString osValidator(GetPersistentCacheValidator(oFileProp));
+    if( osValidator.empty() )
+        return;
+
+    // Only store full chunks, or the last chunk of the file.
+    if( (nFileOffsetStart % DOWNLOAD_CHUNK_SIZE) != 0 ||
+        nFileOffsetStart >= oFileProp.fileSize ||
+        nSize != std::min(static_cast<vsi_l_offset>(DOWNLOAD_CHUNK_SIZE),
+                          oFileProp.fileSize - nFileOffsetStart) )
+    {
+        return;
+    }
+
+    const CPLString osURLDir(GetPersistentCacheURLDir(osCacheDir, pszURL));
+    VSIStatBufL sStat;
+    if( VSIStatL(osURLDir, &sStat) != 0 )
+        VSIMkdirRecursive(osURLDir, 0755);
+    const CPLString osFilename(CPLFormFilename(
+        osURLDir,
+        CPLSPrintf("%s_" CPL_FRMT_GUIB, osValidator.c_str(),
+                   static_cast<GUIntBig>(nFileOffsetStart)),
+        nullptr));
+    if( !VSICurlPersistentCacheWriteFile(osFilename, pData, nSize) )
+        return;
+
+    // Prune the cache at the first write of the process, and then each
+    // time a tenth of its maximum size has been written.
+    const GIntBig nMaxSize = CPLAtoGIntBig(CPLGetConfigOption(
+        "CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE", "1073741824"));
+    bool bPrune = false;
+    {
+        CPLMutexHolder oHolder( &hMutex );
+        if( m_nPersistentCacheBytesSincePrune >= 0 )
+            m_nPersistentCacheBytesSincePrune += nSize;
+        if( !m_bPersistentCachePruning &&
+            (m_nPersistentCacheBytesSincePrune < 0 ||
+             m_nPersistentCacheBytesSincePrune > nMaxSize / 10) )
+        {
+            m_bPersistentCachePruning = true;
+            m_nPersistentCacheBytesSincePrune = 0;
+            bPrune = true;
+        }
+    }
+    if( bPrune )
+    {
+        PrunePersistentCache(osCacheDir);
+
+        CPLMutexHolder oHolder( &hMutex );
+        m_bPersistentCachePruning = false;
+    }
+}
+
+/************************************************************************/
+/*                        PrunePersistentCache()                        */
+/************************************************************************/
+
+void VSICurlFilesystemHandler::PrunePersistentCache(
+                                            const CPLString& osCacheDir )
+{
+    const GIntBig nMaxSize = CPLAtoGIntBig(CPLGetConfigOption(
+        "CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE", "1073741824"));
+
+    struct CachedFile
+    {
+        CPLString osFilename{};
+        time_t    nMTime = 0;
+        GIntBig   nSize = 0;
+    };
+    std::vector<CachedFile> aoFiles;
+    GIntBig nTotalSize = 0;
+    const time_t nNow = time(nullptr);
+
+    const CPLStringList aosDirs(VSIReadDir(osCacheDir));
+    for( int i = 0; i < aosDirs.size(); i++ )
+    {
+        if( aosDirs[i][0] == '.' )
+            continue;
+        const CPLString osDir(CPLFormFilename(osCacheDir, aosDirs[i],
+                                              nullptr));
+        const CPLStringList aosFiles(VSIReadDir(osDir));
+        for( int j = 0; j < aosFiles.size(); j++ )
+        {
+            if( aosFiles[j][0] == '.' )
+                continue;
+            CachedFile oFile;
+            oFile.osFilename = CPLFormFilename(osDir, aosFiles[j], nullptr);
+            VSIStatBufL sStat;
+            if( VSIStatL(oFile.osFilename, &sStat) != 0 ||
+                !VSI_ISREG(sStat.st_mode) )
+            {
+                continue;
+            }
+            if( strstr(aosFiles[j], ".tmp.") != nullptr )
+            {
+                // Leftover of an interrupted write.
+                if( nNow - sStat.st_mtime > 3600 )
+                    VSIUnlink(oFile.osFilename);
+                continue;
+            }
+            oFile.nMTime = sStat.st_mtime;
+            oFile.nSize = static_cast<GIntBig>(sStat.st_size);
+            nTotalSize += oFile.nSize;
+            aoFiles.push_back(oFile);
+        }
+    }
+
+    if( nTotalSize <= nMaxSize )
+        return;
+
+    std::sort(aoFiles.begin(), aoFiles.end(),
+              [](const CachedFile& a, const CachedFile& b)
+              { return a.nMTime < b.nMTime; });
+
+    // Evict down to 90% of the maximum size, so that the next writes do
+    // not immediately trigger a new pruning.
+    const GIntBig nTargetSize = nMaxSize / 10 * 9;
+    std::set<CPLString> oSetDirs;
+    for( const auto& oFile: aoFiles )
+    {
+        if( nTotalSize <= nTargetSize )
+            break;
+        if( VSIUnlink(oFile.osFilename) == 0 )
+        {
+            nTotalSize -= oFile.nSize;
+            oSetDirs.insert(CPLGetPath(oFile.osFilename));
+        }
+    }
+    CPLDebug("VSICURL", "Pruned persistent cache %s to " CPL_FRMT_GIB
+             " bytes", osCacheDir.c_str(), nTotalSize);
+
+    // Fails, as expected, on directories that are not empty.
+    for( const auto& osDir: oSetDirs )
+        VSIRmdir(osDir);
+}
+
+/************************************************************************/
+/*                   GetFilePropFromPersistentCache()                   */
+/************************************************************************/
+
+bool VSICurlFilesystemHandler::GetFilePropFromPersistentCache(
+                                            const char* pszURL,
+                                            FileProp& oFileProp )
+{
+    const CPLString osCacheDir(GetPersistentCacheDir());
+    if( osCacheDir.empty() )
+        return false;
+
+    // Properties are only reused without revalidation during that delay.
+    const double dfTTL = CPLAtof(CPLGetConfigOption(
+        "CPL_VSIL_CURL_PERSISTENT_CACHE_PROPS_TTL", "0"));
+    if( dfTTL <= 0 )
+        return false;
+
+    const char* const apszOptions[] = {
+        "EMIT_ERROR_IF_CANNOT_OPEN_FILE=NO", nullptr };
+    const CPLStringList aosProps(CSLLoad2(
+        CPLFormFilename(GetPersistentCacheURLDir(osCacheDir, pszURL),
+                        "props", nullptr),
+        100, 10000, apszOptions));
+    if( strcmp(aosProps.FetchNameValueDef("URL", ""), pszURL) != 0 )
+        return false;
+
+    const GIntBig nAge = static_cast<GIntBig>(time(nullptr)) -
+        CPLAtoGIntBig(aosProps.FetchNameValueDef("TIMESTAMP", "0"));
+    if( nAge < 0 || nAge > dfTTL )
+        return false;
+
+    FileProp oProp;
+    oProp.eExists = EXIST_YES;
+    oProp.bHasComputedFileSize = true;
+    oProp.fileSize = static_cast<vsi_l_offset>(
+        CPLAtoGIntBig(aosProps.FetchNameValueDef("SIZE", "0")));
+    oProp.mTime = static_cast<time_t>(
+        CPLAtoGIntBig(aosProps.FetchNameValueDef("MTIME", "0")));
+    oProp.ETag = aosProps.FetchNameValueDef("ETAG", "");
+    if( GetPersistentCacheValidator(oProp).empty() )
+        return false;
+    oFileProp = oProp;
+    return true;
+}
+
+/************************************************************************/
+/*                    SetFilePropToPersistentCache()                    */
+/************************************************************************/
+
+void VSICurlFilesystemHandler::SetFilePropToPersistentCache(
+                                            const char* pszURL,
+                                            const FileProp& oFileProp )
+{
+    const CPLString osCacheDir(GetPersistentCacheDir());
+    if( osCacheDir.empty() || GetPersistentCacheValidator(oFileProp).empty() )
+        return;
+
+    CPLString osContent;
+    osContent += CPLSPrintf("URL=%s\n", pszURL);
+    osContent += CPLSPrintf("TIMESTAMP=" CPL_FRMT_GIB "\n",
+                            static_cast<GIntBig>(time(nullptr)));
+    osContent += CPLSPrintf("SIZE=" CPL_FRMT_GUIB "\n",
+                            static_cast<GUIntBig>(oFileProp.fileSize));
+    osContent += CPLSPrintf("MTIME=" CPL_FRMT_GIB "\n",
+                            static_cast<GIntBig>(oFileProp.mTime));
+    osContent += "ETAG=" + oFileProp.ETag + "\n";
+
+    const CPLString osURLDir(GetPersistentCacheURLDir(osCacheDir, pszURL));
+    VSIStatBufL sStat;
+    if( VSIStatL(osURLDir, &sStat) != 0 )
+        VSIMkdirRecursive(osURLDir, 0755);
+    VSICurlPersistentCacheWriteFile(
+        CPLFormFilename(osURLDir, "props", nullptr),
+        osContent.data(), osContent.size());
+}
+
 /************************************************************************/
 /*                         GetCachedDirList()                           */
 /************************************************************************/
@@ -2629,23 +3217,26 @@ bool VSICurlFilesystemHandler::ExistsInCacheDirList(
 
 void VSICurlFilesystemHandler::InvalidateCachedData( const char* pszURL )
 {
-    CPLMutexHolder oHolder( &hMutex );
-
     oCacheFileProp.remove(std::string(pszURL));
 
+    // Cached chunks in the persistent cache are tied to the properties
+    // of the file, so only those need to be discarded.
+    const CPLString osCacheDir(GetPersistentCacheDir());
+    if( !osCacheDir.empty() )
+    {
+        VSIUnlink(CPLFormFilename(GetPersistentCacheURLDir(osCacheDir, pszURL),
+                                  "props", nullptr));
+    }
+
     // Invalidate all cached regions for this URL
-    std::list<FilenameOffsetPair> keysToRemove;
     std::string osURL(pszURL);
-    auto lambda = [&keysToRemove, &osURL](
+    auto lambda = [&osURL](
         const lru11::KeyValuePair<FilenameOffsetPair,
                                   std::shared_ptr<std::string>>& kv)
     {
-        if( kv.key.filename_ == osURL )
-            keysToRemove.push_back(kv.key);
+        return kv.key.filename_ == osURL;
     };
-    oRegionCache.cwalk(lambda);
-    for( auto& key: keysToRemove )
-        oRegionCache.remove(key);
+    oRegionCache.removeIf(lambda);
 }
 
 /************************************************************************/
@@ -2679,30 +3270,22 @@ void VSICurlFilesystemHandler::PartialClearCache(const char* pszFilenamePrefix)
 
     CPLString osURL = GetURLFromFilename(pszFilenamePrefix);
     {
-        std::list<FilenameOffsetPair> keysToRemove;
-        auto lambda = [&keysToRemove, &osURL](
+        auto lambda = [&osURL](
             const lru11::KeyValuePair<FilenameOffsetPair,
                                                 std::shared_ptr<std::string>>& kv)
         {
-            if( strncmp(kv.key.filename_.c_str(), osURL, osURL.size()) == 0 )
-                keysToRemove.push_back(kv.key);
+            return strncmp(kv.key.filename_.c_str(), osURL, osURL.size()) == 0;
         };
-        oRegionCache.cwalk(lambda);
-        for( auto& key: keysToRemove )
-            oRegionCache.remove(key);
+        oRegionCache.removeIf(lambda);
     }
 
     {
-        std::list<std::string> keysToRemove;
-        auto lambda = [&keysToRemove, &osURL](
+        auto lambda = [&osURL](
             const lru11::KeyValuePair<std::string, FileProp>& kv)
         {
-            if( strncmp(kv.key.c_str(), osURL, osURL.size()) == 0 )
-                keysToRemove.push_back(kv.key);
+            return strncmp(kv.key.c_str(), osURL, osURL.size()) == 0;
         };
-        oCacheFileProp.cwalk(lambda);
-        for( auto& key: keysToRemove )
-            oCacheFileProp.remove(key);
+        oCacheFileProp.removeIf(lambda);
     }
 
     {
@@ -2773,6 +3356,12 @@ const char* VSICurlFilesystemHandler::GetActualURL(const char* pszFilename)
     "  <Option name='GDAL_HTTP_MERGE_CONSECUTIVE_RANGES' type='boolean' " \
         "description='Whether to merge consecutive ranges in multirange " \
         "requests' default='YES'/>" \
+    "  <Option name='CPL_VSIL_CURL_PARALLEL_READAHEAD' type='integer' " \
+        "description='Number of parallel requests used to download ahead " \
+        "when a file is read sequentially' default='1'/>" \
+    "  <Option name='CPL_VSIL_CURL_UPLOAD_PARALLEL_PARTS' type='integer' " \
+        "description='Number of parts that may be uploaded at the same time " \
+        "when writing a file' default='1'/>" \
     "  <Option name='CPL_VSIL_CURL_NON_CACHED' type='string' " \
         "description='Colon-separated list of filenames whose content" \
         "must not be cached across open attempts'/>" \
@@ -2797,6 +3386,15 @@ const char* VSICurlFilesystemHandler::GetActualURL(const char* pszFilename)
     "  <Option name='CPL_VSIL_CURL_CACHE_SIZE' type='integer' " \
         "description='Size in bytes of the global /vsicurl/ cache' " \
         "default='16384000'/>" \
+    "  <Option name='CPL_VSIL_CURL_PERSISTENT_CACHE_DIR' type='string' " \
+        "description='Directory where downloaded chunks and file properties " \
+        "are cached across processes'/>" \
+    "  <Option name='CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE' type='integer' " \
+        "description='Maximum size in bytes of the persistent cache' " \
+        "default='1073741824'/>" \
+    "  <Option name='CPL_VSIL_CURL_PERSISTENT_CACHE_PROPS_TTL' type='int' " \
+        "description='Delay in seconds during which file properties of the " \
+        "persistent cache are used without revalidation' default='0'/>" \
     "  <Option name='CPL_VSIL_CURL_IGNORE_GLACIER_STORAGE' type='boolean' " \
         "description='Whether to skip files with Glacier storage class in " \
         "directory listing.' default='YES'/>"
@@ -2963,7 +3561,8 @@ VSIVirtualHandle* VSICurlFilesystemHandler::Open( const char *pszFilename,
     }
 
     if( CPLTestBool( CPLGetConfigOption( "VSI_CACHE", "FALSE" ) ) )
-        return VSICreateCachedFile( poHandle );
+        return VSICreateSharedCachedFile( this, pszFilename, poHandle,
+                                          false );
     else
         return poHandle;
 }
@@ -4076,6 +4675,13 @@ VSIAppendWriteHandle::VSIAppendWriteHandle( VSICurlFilesystemHandler* poFS,
                 "Cannot allocate working buffer for %s writing",
                  m_osFSPrefix.c_str());
     }
+    // Blocks must be appended in order, so at most one is sent at a time,
+    // but this can still be done while the next one is being filled.
+    else if( atoi(CPLGetConfigOption("CPL_VSIL_CURL_UPLOAD_PARALLEL_PARTS",
+                                     "1")) > 1 )
+    {
+        m_pabyFillBuffer = static_cast<GByte *>(VSIMalloc(m_nBufferSize));
+    }
 }
 
 /************************************************************************/
@@ -4086,7 +4692,9 @@ VSIAppendWriteHandle::~VSIAppendWriteHandle()
 {
     /* WARNING: implementation should call Close() themselves */
     /* cannot be done safely from here, since Send() can be called. */
+    CPLAssert( m_hSendThread == nullptr );
     CPLFree(m_pabyBuffer);
+    CPLFree(m_pabyFillBuffer);
 }
 
 /************************************************************************/
@@ -4114,7 +4722,7 @@ int VSIAppendWriteHandle::Seek( vsi_l_offset nOffset, int nWhence )
 
 vsi_l_offset VSIAppendWriteHandle::Tell()
 {
-    return m_nCurOffset;
+    return m_pabyFillBuffer ? m_nFillCurOffset : m_nCurOffset;
 }
 
 /************************************************************************/
@@ -4149,6 +4757,43 @@ size_t VSIAppendWriteHandle::ReadCallBackBuffer( char *buffer, size_t size,
     return nSizeToWrite;
 }
 
+/************************************************************************/
+/*                           SendThreadFunc()                           */
+/************************************************************************/
+
+void VSIAppendWriteHandle::SendThreadFunc( void* pData )
+{
+    VSIAppendWriteHandle* poThis = static_cast<VSIAppendWriteHandle *>(pData);
+    poThis->m_bSendSuccess = poThis->Send(false);
+}
+
+/************************************************************************/
+/*                        WaitForBackgroundSend()                       */
+/************************************************************************/
+
+bool VSIAppendWriteHandle::WaitForBackgroundSend()
+{
+    if( m_hSendThread )
+    {
+        CPLJoinThread(m_hSendThread);
+        m_hSendThread = nullptr;
+    }
+    return m_bSendSuccess;
+}
+
+/************************************************************************/
+/*                           SwapFillBuffer()                           */
+/************************************************************************/
+
+// Make the content of the fill buffer the one that Send() will transmit.
+void VSIAppendWriteHandle::SwapFillBuffer()
+{
+    std::swap(m_pabyBuffer, m_pabyFillBuffer);
+    m_nBufferOff = m_nFillBufferOff;
+    m_nCurOffset = m_nFillCurOffset;
+    m_nFillBufferOff = 0;
+}
+
 /************************************************************************/
 /*                               Write()                                */
 /************************************************************************/
@@ -4164,6 +4809,36 @@ VSIAppendWriteHandle::Write( const void *pBuffer, size_t nSize, size_t nMemb )
         return 0;
 
     const GByte* pabySrcBuffer = reinterpret_cast<const GByte*>(pBuffer);
+    if( m_pabyFillBuffer )
+    {
+        while( nBytesToWrite > 0 )
+        {
+            if( m_nFillBufferOff == m_nBufferSize )
+            {
+                if( !WaitForBackgroundSend() )
+                {
+                    m_bError = true;
+                    return 0;
+                }
+                SwapFillBuffer();
+                m_hSendThread = CPLCreateJoinableThread(SendThreadFunc, this);
+                if( m_hSendThread == nullptr )
+                    SendThreadFunc(this);
+            }
+
+            const int nToWriteInBuffer = static_cast<int>(
+                std::min(static_cast<size_t>(m_nBufferSize - m_nFillBufferOff),
+                         nBytesToWrite));
+            memcpy(m_pabyFillBuffer + m_nFillBufferOff, pabySrcBuffer,
+                   nToWriteInBuffer);
+            pabySrcBuffer += nToWriteInBuffer;
+            m_nFillBufferOff += nToWriteInBuffer;
+            m_nFillCurOffset += nToWriteInBuffer;
+            nBytesToWrite -= nToWriteInBuffer;
+        }
+        return nMemb;
+    }
+
     while( nBytesToWrite > 0 )
     {
         if( m_nBufferOff == m_nBufferSize )
@@ -4207,6 +4882,12 @@ int VSIAppendWriteHandle::Close()
     if( !m_bClosed )
     {
         m_bClosed = true;
+        if( m_pabyFillBuffer )
+        {
+            if( !WaitForBackgroundSend() )
+                m_bError = true;
+            SwapFillBuffer();
+        }
         if( !m_bError && !Send(true) )
             nRet = -1;
     }
@@ -4354,6 +5035,8 @@ void VSICurlClearCache( void )
     }
 
     VSICurlStreamingClearCache();
+
+    VSIClearDirListingCache( nullptr );
 }
 
 /************************************************************************/
@@ -4383,6 +5066,8 @@ void VSICurlPartialClearCache(const char* pszFilenamePrefix)
 
     if( poFSHandler )
         poFSHandler->PartialClearCache(pszFilenamePrefix);
+
+    VSIClearDirListingCache( pszFilenamePrefix );
 }
 
 #endif /* HAVE_CURL */
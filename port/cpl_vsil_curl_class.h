@@ -33,15 +33,19 @@
 
 #include "cpl_aws.h"
 #include "cpl_port.h"
+#include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "cpl_vsil_curl_priv.h"
 #include "cpl_mem_cache.h"
+#include "cpl_worker_thread_pool.h"
 
 #include <curl/curl.h>
 
+#include <atomic>
 #include <set>
 #include <map>
 #include <memory>
+#include <mutex>
 
 //! @cond Doxygen_Suppress
 
@@ -150,22 +154,28 @@ class VSICurlFilesystemHandler : public VSIFilesystemHandler
         }
     };
 
+    // Thread-safe by themselves: these are accessed for each read.
     using RegionCacheType =
-        lru11::Cache<FilenameOffsetPair, std::shared_ptr<std::string>,
-            lru11::NullLock,
-            std::unordered_map<
-                FilenameOffsetPair,
-                typename std::list<lru11::KeyValuePair<FilenameOffsetPair,
-                    std::shared_ptr<std::string>>>::iterator,
-                    FilenameOffsetPairHasher>>;
+        lru11::ShardedCache<FilenameOffsetPair, std::shared_ptr<std::string>,
+                            FilenameOffsetPairHasher>;
 
     RegionCacheType oRegionCache;
 
-    lru11::Cache<std::string, FileProp>  oCacheFileProp;
+    lru11::ShardedCache<std::string, FileProp>  oCacheFileProp;
 
     int                                       nCachedFilesInDirList = 0;
     lru11::Cache<std::string, CachedDirList>  oCacheDirList;
 
+    // Persistent on-disk cache (CPL_VSIL_CURL_PERSISTENT_CACHE_DIR)
+    GIntBig             m_nPersistentCacheBytesSincePrune = -1;
+    bool                m_bPersistentCachePruning = false;
+
+    static CPLString    GetPersistentCacheDir();
+    static CPLString    GetPersistentCacheURLDir( const CPLString& osCacheDir,
+                                                  const char* pszURL );
+    static CPLString    GetPersistentCacheValidator( const FileProp& oFileProp );
+    void                PrunePersistentCache( const CPLString& osCacheDir );
+
     char**              ParseHTMLFileList(const char* pszFilename,
                                           int nMaxFiles,
                                           char* pszData,
@@ -247,6 +257,24 @@ public:
                                            const FileProp& oFileProp );
     void                InvalidateCachedData( const char* pszURL );
 
+    bool                GetRegionFromPersistentCache(
+                                        const char* pszURL,
+                                        const FileProp& oFileProp,
+                                        vsi_l_offset nFileOffsetStart,
+                                        std::string& osData );
+    void                AddRegionToPersistentCache(
+                                        const char* pszURL,
+                                        const FileProp& oFileProp,
+                                        vsi_l_offset nFileOffsetStart,
+                                        size_t nSize,
+                                        const char *pData );
+    bool                GetFilePropFromPersistentCache(
+                                        const char* pszURL,
+                                        FileProp& oFileProp );
+    void                SetFilePropToPersistentCache(
+                                        const char* pszURL,
+                                        const FileProp& oFileProp );
+
     CURLM              *GetCurlMultiHandleFor( const CPLString& osURL );
 
     virtual void        ClearCache();
@@ -305,6 +333,9 @@ class VSICurlHandle : public VSIVirtualHandle
     bool            bEOF = false;
 
     virtual std::string DownloadRegion(vsi_l_offset startOffset, int nBlocks);
+    std::string         DownloadRegionsParallel(vsi_l_offset startOffset,
+                                                int nBlocks,
+                                                int nMaxRequests);
 
     bool                m_bUseHead = false;
 
@@ -318,6 +349,7 @@ class VSICurlHandle : public VSIVirtualHandle
                                 const struct curl_slist* /* psExistingHeaders */)
         { return nullptr; }
     virtual bool AllowAutomaticRedirection() { return true; }
+    virtual bool CanDownloadRegionsInParallel() { return true; }
     virtual bool CanRestartOnError( const char*, const char*, bool ) { return false; }
     virtual bool UseLimitRangeGetInsteadOfHead() { return false; }
     virtual bool IsDirectoryFromExists( const char* /*pszVerb*/, int /*response_code*/ ) { return false; }
@@ -466,10 +498,35 @@ class VSIS3WriteHandle final : public VSIVirtualHandle
     double              m_dfRetryDelay = 0.0;
     WriteFuncStruct     m_sWriteFuncHeaderData{};
 
+    // Parallel upload of parts (CPL_VSIL_CURL_UPLOAD_PARALLEL_PARTS)
+    struct PartUploadJob
+    {
+        VSIS3WriteHandle   *poHandle = nullptr;
+        int                 nPartNumber = 0;
+        GByte              *pabyBuffer = nullptr;
+        int                 nBufferSize = 0;
+        CPLString           osEtag{};
+        bool                bSuccess = false;
+        std::atomic<bool>   bDone{false};
+    };
+    int                 m_nMaxParallelParts = 1;
+    std::unique_ptr<CPLWorkerThreadPool> m_poUploadThreadPool{};
+    std::vector<std::unique_ptr<PartUploadJob>> m_apoPendingJobs{};
+    std::vector<GByte*> m_apabyFreeBuffers{};
+    std::mutex          m_oHelperMutex{};
+
     static size_t       ReadCallBackBuffer( char *buffer, size_t size,
                                             size_t nitems, void *instream );
     bool                InitiateMultipartUpload();
     bool                UploadPart();
+    bool                UploadPartInternal( int nPartNumber,
+                                            const GByte* pabyBuffer,
+                                            int nBufferSize,
+                                            CURLM* hCurlMultiHandle,
+                                            CPLString& osEtag );
+    bool                SubmitPartUpload();
+    bool                CollectFinishedParts( int nMaxRemainingJobs );
+    static void         UploadPartThreadFunc( void* pData );
     static size_t       ReadCallBackXML( char *buffer, size_t size,
                                          size_t nitems, void *instream );
     bool                CompleteMultipart();
@@ -523,10 +580,23 @@ class VSIAppendWriteHandle : public VSIVirtualHandle
     GByte              *m_pabyBuffer = nullptr;
     bool                m_bError = false;
 
+    // When CPL_VSIL_CURL_UPLOAD_PARALLEL_PARTS > 1, the previous block is
+    // sent from m_pabyBuffer in a background thread while the next one is
+    // filled in m_pabyFillBuffer.
+    GByte              *m_pabyFillBuffer = nullptr;
+    int                 m_nFillBufferOff = 0;
+    vsi_l_offset        m_nFillCurOffset = 0;
+    CPLJoinableThread  *m_hSendThread = nullptr;
+    bool                m_bSendSuccess = true;
+
     static size_t       ReadCallBackBuffer( char *buffer, size_t size,
                                             size_t nitems, void *instream );
     virtual bool        Send(bool bIsLastBlock) = 0;
 
+    static void         SendThreadFunc( void* pData );
+    bool                WaitForBackgroundSend();
+    void                SwapFillBuffer();
+
     public:
         VSIAppendWriteHandle( VSICurlFilesystemHandler* poFS,
                               const char* pszFSPrefix,
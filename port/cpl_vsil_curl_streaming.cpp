@@ -1639,7 +1639,8 @@ VSIVirtualHandle* VSICurlStreamingFSHandler::Open( const char *pszFilename,
     }
 
     if( CPLTestBool( CPLGetConfigOption( "VSI_CACHE", "FALSE" ) ) )
-        return VSICreateCachedFile( poHandle );
+        return VSICreateSharedCachedFile( this, pszFilename, poHandle,
+                                          false );
 
     return poHandle;
 }
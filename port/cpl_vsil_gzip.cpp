@@ -64,6 +64,9 @@
    files. Snapshots are created regularly when decompressing the data a snapshot
    of the gzip state.  Later we can seek directly in the compressed data to the
    closest snapshot in order to reduce the amount of data to uncompress again.
+   Optionally (CPL_VSIL_GZIP_INDEX), a finer grained seek index of deflate
+   block boundaries is also built, in the spirit of zlib's examples/zran.c,
+   and can be persisted in a .gz.gzindex file.
 
    For .gz files, an effort is done to cache the size of the uncompressed data
    in a .gz.properties file, so that we don't need to seek at the end of the
@@ -149,6 +152,22 @@ typedef struct
     vsi_l_offset  out;
 } GZipSnapshot;
 
+// Access point of the seek index. Decompression can restart from it by
+// priming the inflate state with the bits of the partial byte and setting
+// the last 32 KB of uncompressed data as dictionary.
+struct GZipIndexPoint
+{
+    vsi_l_offset  posInBaseHandle = 0;  // first complete input byte
+    int           bits = 0;             // bits of the previous byte to prime
+    uLong         crc = 0;
+    vsi_l_offset  in = 0;
+    vsi_l_offset  out = 0;
+    std::string   osWindow{};           // deflate compressed dictionary
+};
+
+constexpr int GZIP_WINDOW_SIZE = 32768;
+constexpr char GZIP_INDEX_MAGIC[] = "GDALGZI1";
+
 class VSIGZipHandle final : public VSIVirtualHandle
 {
     VSIVirtualHandle* m_poBaseHandle = nullptr;
@@ -179,6 +198,24 @@ class VSIGZipHandle final : public VSIVirtualHandle
     GZipSnapshot* snapshots = nullptr;
     vsi_l_offset snapshot_byte_interval = 0; /* number of compressed bytes at which we create a "snapshot" */
 
+    /* Seek index (CPL_VSIL_GZIP_INDEX) */
+    bool              m_bIndex = false;
+    bool              m_bIndexLoaded = false;
+    bool              m_bIndexSaved = false;
+    vsi_l_offset      m_nIndexInterval = 0; /* uncompressed bytes between access points */
+    std::vector<GZipIndexPoint> m_aoIndex{};
+    Byte             *m_pabyWindow = nullptr; /* circular buffer with the last 32 KB of output */
+    size_t            m_nWindowPos = 0;
+    size_t            m_nWindowSize = 0;
+    bool              m_bWindowComplete = true; /* whether the window holds all the history */
+
+    void UpdateIndexWindow( const Byte* pabyData, size_t nSize );
+    void AddIndexPoint( uLong nCurCRC );
+    bool RestoreIndexPoint( const GZipIndexPoint& oPoint );
+    CPLString GetIndexFilename() const;
+    bool LoadIndex();
+    void SaveIndex();
+
     void check_header();
     int get_byte();
     int gzseek( vsi_l_offset nOffset, int nWhence );
@@ -213,6 +250,9 @@ class VSIGZipHandle final : public VSIVirtualHandle
 
     vsi_l_offset      GetLastReadOffset() { return m_nLastReadOffset; }
     const char*       GetBaseFileName() { return m_pszBaseFileName; }
+    vsi_l_offset      GetCompressedDataOffset() const { return startOff; }
+    vsi_l_offset      GetEndCompressedDataOffset() const
+        { return offsetEndCompressedData; }
 
     void              SetUncompressedSize( vsi_l_offset nUncompressedSize )
         { m_uncompressed_size = nUncompressedSize; }
@@ -284,6 +324,12 @@ VSIGZipHandle* VSIGZipHandle::Duplicate()
     }
 
     poHandle->m_nLastReadOffset = m_nLastReadOffset;
+    if( poHandle->m_bIndex )
+    {
+        poHandle->m_aoIndex = m_aoIndex;
+        poHandle->m_bIndexLoaded = m_bIndexLoaded;
+        poHandle->m_bIndexSaved = m_bIndexSaved;
+    }
 
     // Most important: duplicate the snapshots!
 
@@ -397,6 +443,301 @@ VSIGZipHandle::VSIGZipHandle( VSIVirtualHandle* poBaseHandle,
                       static_cast<size_t>(
                           compressed_size / snapshot_byte_interval + 1)));
     }
+
+    if( m_transparent == 0 &&
+        CPLTestBool(CPLGetConfigOption("CPL_VSIL_GZIP_INDEX", "NO")) )
+    {
+        m_nIndexInterval = static_cast<vsi_l_offset>(std::max(
+            static_cast<GIntBig>(Z_BUFSIZE),
+            CPLAtoGIntBig(CPLGetConfigOption("CPL_VSIL_GZIP_INDEX_INTERVAL",
+                                             "1048576"))));
+        m_pabyWindow = static_cast<Byte *>(ALLOC(GZIP_WINDOW_SIZE));
+        m_bIndex = m_pabyWindow != nullptr;
+        if( m_bIndex && offset == 0 && m_pszBaseFileName )
+            m_bIndexLoaded = LoadIndex();
+    }
+}
+
+/************************************************************************/
+/*                         GetIndexFilename()                           */
+/************************************************************************/
+
+CPLString VSIGZipHandle::GetIndexFilename() const
+{
+    return CPLString(m_pszBaseFileName) + ".gzindex";
+}
+
+/************************************************************************/
+/*                         UpdateIndexWindow()                          */
+/************************************************************************/
+
+void VSIGZipHandle::UpdateIndexWindow( const Byte* pabyData, size_t nSize )
+{
+    if( nSize >= static_cast<size_t>(GZIP_WINDOW_SIZE) )
+    {
+        memcpy(m_pabyWindow, pabyData + nSize - GZIP_WINDOW_SIZE,
+               GZIP_WINDOW_SIZE);
+        m_nWindowPos = 0;
+        m_nWindowSize = GZIP_WINDOW_SIZE;
+        return;
+    }
+    const size_t nFirst = std::min(nSize, GZIP_WINDOW_SIZE - m_nWindowPos);
+    memcpy(m_pabyWindow + m_nWindowPos, pabyData, nFirst);
+    memcpy(m_pabyWindow, pabyData + nFirst, nSize - nFirst);
+    m_nWindowPos = (m_nWindowPos + nSize) % GZIP_WINDOW_SIZE;
+    m_nWindowSize = std::min(m_nWindowSize + nSize,
+                             static_cast<size_t>(GZIP_WINDOW_SIZE));
+}
+
+/************************************************************************/
+/*                           AddIndexPoint()                            */
+/************************************************************************/
+
+// Must be called when inflate() has stopped at a deflate block boundary.
+void VSIGZipHandle::AddIndexPoint( uLong nCurCRC )
+{
+    // After a restore from a snapshot, the history is unknown until a full
+    // window has been decompressed.
+    if( m_nWindowSize == static_cast<size_t>(GZIP_WINDOW_SIZE) )
+        m_bWindowComplete = true;
+    if( !m_bWindowComplete )
+        return;
+
+    std::vector<Byte> abyWindow(m_nWindowSize);
+    if( m_nWindowSize == static_cast<size_t>(GZIP_WINDOW_SIZE) )
+    {
+        memcpy(&abyWindow[0], m_pabyWindow + m_nWindowPos,
+               GZIP_WINDOW_SIZE - m_nWindowPos);
+        memcpy(&abyWindow[GZIP_WINDOW_SIZE - m_nWindowPos], m_pabyWindow,
+               m_nWindowPos);
+    }
+    else if( m_nWindowSize )
+    {
+        memcpy(&abyWindow[0], m_pabyWindow, m_nWindowSize);
+    }
+
+    uLongf nCompressedSize = compressBound(static_cast<uLong>(m_nWindowSize));
+    std::string osWindow;
+    osWindow.resize(nCompressedSize);
+    if( compress2(reinterpret_cast<Bytef*>(&osWindow[0]), &nCompressedSize,
+                  abyWindow.data(), static_cast<uLong>(m_nWindowSize),
+                  Z_BEST_SPEED) != Z_OK )
+    {
+        return;
+    }
+    osWindow.resize(nCompressedSize);
+
+    GZipIndexPoint oPoint;
+    oPoint.posInBaseHandle =
+        VSIFTellL(reinterpret_cast<VSILFILE*>(m_poBaseHandle)) -
+        stream.avail_in;
+    oPoint.bits = stream.data_type & 7;
+    oPoint.crc = nCurCRC;
+    oPoint.in = in;
+    oPoint.out = out;
+    oPoint.osWindow = std::move(osWindow);
+    m_aoIndex.push_back(std::move(oPoint));
+}
+
+/************************************************************************/
+/*                         RestoreIndexPoint()                          */
+/************************************************************************/
+
+bool VSIGZipHandle::RestoreIndexPoint( const GZipIndexPoint& oPoint )
+{
+    uLongf nWindowSize = GZIP_WINDOW_SIZE;
+    if( uncompress(m_pabyWindow, &nWindowSize,
+                   reinterpret_cast<const Bytef*>(oPoint.osWindow.data()),
+                   static_cast<uLong>(oPoint.osWindow.size())) != Z_OK )
+    {
+        return false;
+    }
+
+    VSILFILE* fp = reinterpret_cast<VSILFILE*>(m_poBaseHandle);
+    GByte byPrime = 0;
+    if( oPoint.bits )
+    {
+        if( oPoint.posInBaseHandle == 0 ||
+            VSIFSeekL(fp, oPoint.posInBaseHandle - 1, SEEK_SET) != 0 ||
+            VSIFReadL(&byPrime, 1, 1, fp) != 1 )
+        {
+            return false;
+        }
+    }
+    else if( VSIFSeekL(fp, oPoint.posInBaseHandle, SEEK_SET) != 0 )
+    {
+        return false;
+    }
+
+    if( inflateReset(&stream) != Z_OK ||
+        (oPoint.bits &&
+         inflatePrime(&stream, oPoint.bits,
+                      byPrime >> (8 - oPoint.bits)) != Z_OK) ||
+        (nWindowSize &&
+         inflateSetDictionary(&stream, m_pabyWindow,
+                              static_cast<uInt>(nWindowSize)) != Z_OK) )
+    {
+        return false;
+    }
+
+    stream.avail_in = 0;
+    stream.next_in = inbuf;
+    z_err = Z_OK;
+    z_eof = 0;
+    m_transparent = 0;
+    crc = oPoint.crc;
+    in = oPoint.in;
+    out = oPoint.out;
+    m_nWindowPos = nWindowSize % GZIP_WINDOW_SIZE;
+    m_nWindowSize = nWindowSize;
+    m_bWindowComplete = true;
+    return true;
+}
+
+/************************************************************************/
+/*                             LoadIndex()                              */
+/************************************************************************/
+
+bool VSIGZipHandle::LoadIndex()
+{
+    if( STARTS_WITH_CI(m_pszBaseFileName, "/vsicurl/") )
+        return false;
+
+    const CPLString osIndexFilename(GetIndexFilename());
+    VSIStatBufL sStatIndex;
+    VSIStatBufL sStatBase;
+    if( VSIStatL(osIndexFilename, &sStatIndex) != 0 ||
+        VSIStatL(m_pszBaseFileName, &sStatBase) != 0 ||
+        sStatIndex.st_mtime < sStatBase.st_mtime )
+    {
+        return false;
+    }
+
+    VSILFILE* fp = VSIFOpenL(osIndexFilename, "rb");
+    if( fp == nullptr )
+        return false;
+
+    bool bOK = true;
+    auto ReadUInt64 = [fp, &bOK]()
+    {
+        GUInt64 nVal = 0;
+        bOK &= VSIFReadL(&nVal, sizeof(nVal), 1, fp) == 1;
+        CPL_LSBPTR64(&nVal);
+        return nVal;
+    };
+    auto ReadUInt32 = [fp, &bOK]()
+    {
+        GUInt32 nVal = 0;
+        bOK &= VSIFReadL(&nVal, sizeof(nVal), 1, fp) == 1;
+        CPL_LSBPTR32(&nVal);
+        return nVal;
+    };
+
+    char szMagic[8] = {};
+    bOK = VSIFReadL(szMagic, sizeof(szMagic), 1, fp) == 1 &&
+          memcmp(szMagic, GZIP_INDEX_MAGIC, sizeof(szMagic)) == 0;
+    const GUInt64 nCompressedSize = ReadUInt64();
+    const GUInt64 nUncompressedSize = ReadUInt64();
+    const GUInt32 nPoints = ReadUInt32();
+    std::vector<GZipIndexPoint> aoIndex;
+    if( bOK && nCompressedSize == m_compressed_size &&
+        nPoints <= nUncompressedSize / Z_BUFSIZE + 1 )
+    {
+        for( GUInt32 i = 0; bOK && i < nPoints; i++ )
+        {
+            GZipIndexPoint oPoint;
+            oPoint.posInBaseHandle = ReadUInt64();
+            oPoint.in = ReadUInt64();
+            oPoint.out = ReadUInt64();
+            oPoint.crc = ReadUInt32();
+            oPoint.bits = static_cast<int>(ReadUInt32());
+            const GUInt32 nWindowSize = ReadUInt32();
+            if( !bOK || oPoint.bits > 7 ||
+                nWindowSize > 2 * GZIP_WINDOW_SIZE ||
+                (!aoIndex.empty() && oPoint.out <= aoIndex.back().out) )
+            {
+                bOK = false;
+                break;
+            }
+            oPoint.osWindow.resize(nWindowSize);
+            if( nWindowSize )
+                bOK = VSIFReadL(&oPoint.osWindow[0], nWindowSize, 1, fp) == 1;
+            aoIndex.push_back(std::move(oPoint));
+        }
+    }
+    else
+    {
+        bOK = false;
+    }
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+
+    if( !bOK )
+    {
+        CPLDebug("GZIP", "Ignoring invalid %s", osIndexFilename.c_str());
+        return false;
+    }
+
+    CPLDebug("GZIP", "Using %d access points from %s",
+             static_cast<int>(aoIndex.size()), osIndexFilename.c_str());
+    m_aoIndex = std::move(aoIndex);
+    if( m_uncompressed_size == 0 )
+        m_uncompressed_size = nUncompressedSize;
+    return true;
+}
+
+/************************************************************************/
+/*                             SaveIndex()                              */
+/************************************************************************/
+
+// Called once the whole stream has been decompressed from the start, so
+// that the index covers it entirely.
+void VSIGZipHandle::SaveIndex()
+{
+    m_bIndexSaved = true;
+    if( m_bIndexLoaded || m_pszBaseFileName == nullptr ||
+        STARTS_WITH_CI(m_pszBaseFileName, "/vsicurl/") ||
+        !m_bWriteProperties )
+    {
+        return;
+    }
+
+    VSILFILE* fp = VSIFOpenL(GetIndexFilename(), "wb");
+    if( fp == nullptr )
+        return;
+
+    bool bOK = true;
+    auto WriteUInt64 = [fp, &bOK](GUInt64 nVal)
+    {
+        CPL_LSBPTR64(&nVal);
+        bOK &= VSIFWriteL(&nVal, sizeof(nVal), 1, fp) == 1;
+    };
+    auto WriteUInt32 = [fp, &bOK](GUInt32 nVal)
+    {
+        CPL_LSBPTR32(&nVal);
+        bOK &= VSIFWriteL(&nVal, sizeof(nVal), 1, fp) == 1;
+    };
+
+    bOK &= VSIFWriteL(GZIP_INDEX_MAGIC, 8, 1, fp) == 1;
+    WriteUInt64(m_compressed_size);
+    WriteUInt64(out);
+    WriteUInt32(static_cast<GUInt32>(m_aoIndex.size()));
+    for( const auto& oPoint: m_aoIndex )
+    {
+        WriteUInt64(oPoint.posInBaseHandle);
+        WriteUInt64(oPoint.in);
+        WriteUInt64(oPoint.out);
+        WriteUInt32(static_cast<GUInt32>(oPoint.crc));
+        WriteUInt32(static_cast<GUInt32>(oPoint.bits));
+        WriteUInt32(static_cast<GUInt32>(oPoint.osWindow.size()));
+        if( !oPoint.osWindow.empty() )
+        {
+            bOK &= VSIFWriteL(oPoint.osWindow.data(),
+                              oPoint.osWindow.size(), 1, fp) == 1;
+        }
+    }
+    bOK &= VSIFCloseL(fp) == 0;
+    if( !bOK )
+        VSIUnlink(GetIndexFilename());
 }
 
 /************************************************************************/
@@ -436,6 +777,7 @@ VSIGZipHandle::~VSIGZipHandle()
 
     TRYFREE(inbuf);
     TRYFREE(outbuf);
+    TRYFREE(m_pabyWindow);
 
     if( snapshots != nullptr )
     {
@@ -610,6 +952,9 @@ int VSIGZipHandle::gzrewind ()
         CPL_IGNORE_RET_VAL(inflateReset(&stream));
     in = 0;
     out = 0;
+    m_nWindowPos = 0;
+    m_nWindowSize = 0;
+    m_bWindowComplete = true;
     return VSIFSeekL(reinterpret_cast<VSILFILE*>(m_poBaseHandle), startOff, SEEK_SET);
 }
 
@@ -748,6 +1093,36 @@ int VSIGZipHandle::gzseek( vsi_l_offset offset, int whence )
         return -1L;
     }
 
+    if( m_bIndex && !m_aoIndex.empty() )
+    {
+        // Last access point before the target offset.
+        const vsi_l_offset nTarget = out + offset;
+        auto oIter = std::upper_bound(
+            m_aoIndex.begin(), m_aoIndex.end(), nTarget,
+            [](vsi_l_offset nVal, const GZipIndexPoint& oPoint)
+            { return nVal < oPoint.out; });
+        if( oIter != m_aoIndex.begin() )
+        {
+            --oIter;
+            if( oIter->out > out )
+            {
+                if( RestoreIndexPoint(*oIter) )
+                {
+                    offset = nTarget - out;
+                }
+                else if( gzrewind() < 0 )
+                {
+                    CPL_VSIL_GZ_RETURN(-1);
+                    return -1L;
+                }
+                else
+                {
+                    offset = nTarget;
+                }
+            }
+        }
+    }
+
     for( unsigned int i = 0;
          i < m_compressed_size / snapshot_byte_interval + 1;
          i++ )
@@ -783,6 +1158,9 @@ int VSIGZipHandle::gzseek( vsi_l_offset offset, int whence )
             m_transparent = snapshots[i].transparent;
             in = snapshots[i].in;
             out = snapshots[i].out;
+            m_nWindowPos = 0;
+            m_nWindowSize = 0;
+            m_bWindowComplete = false;
             break;
         }
     }
@@ -1041,10 +1419,29 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize,
         }
         in += stream.avail_in;
         out += stream.avail_out;
-        z_err = inflate(& (stream), Z_NO_FLUSH);
+        Bytef* const pBeforeInflate = stream.next_out;
+        // With Z_BLOCK, inflate() also returns at deflate block boundaries.
+        z_err = inflate(& (stream), m_bIndex ? Z_BLOCK : Z_NO_FLUSH);
         in -= stream.avail_in;
         out -= stream.avail_out;
 
+        if( m_bIndex )
+        {
+            UpdateIndexWindow(pBeforeInflate,
+                              static_cast<size_t>(stream.next_out -
+                                                  pBeforeInflate));
+            const vsi_l_offset nLastIndexedOut =
+                m_aoIndex.empty() ? 0 : m_aoIndex.back().out;
+            if( z_err == Z_OK && (stream.data_type & 128) != 0 &&
+                (stream.data_type & 64) == 0 &&
+                out >= nLastIndexedOut + m_nIndexInterval )
+            {
+                AddIndexPoint(
+                    crc32(crc, pStart,
+                          static_cast<uInt>(stream.next_out - pStart)));
+            }
+        }
+
         if( z_err == Z_STREAM_END && m_compressed_size != 2 )
         {
             // Check CRC and original size.
@@ -1101,6 +1498,13 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize,
     }
     crc = crc32(crc, pStart, static_cast<uInt>(stream.next_out - pStart));
 
+    if( m_bIndex && z_err == Z_STREAM_END && !m_bIndexSaved )
+    {
+        if( m_uncompressed_size == 0 )
+            m_uncompressed_size = out;
+        SaveIndex();
+    }
+
     size_t ret = (len - stream.avail_out) / nSize;
     if( z_err != Z_OK && z_err != Z_STREAM_END )
     {
@@ -1183,6 +1587,634 @@ int VSIGZipHandle::Close()
     return 0;
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*                       VSIDeflateReadHandleMT                         */
+/* ==================================================================== */
+/************************************************************************/
+
+// Sequence found in streams written by VSIGZipWriteHandleMT (or pigz -i)
+// between chunks: a Z_SYNC_FLUSH empty stored block followed by a
+// Z_FULL_FLUSH one. The deflate data after it does not reference earlier
+// data, so it can be inflated independently.
+constexpr GByte DEFLATE_MT_MARKER[] =
+    { 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00, 0xff, 0xff };
+constexpr size_t DEFLATE_MT_MARKER_SIZE = sizeof(DEFLATE_MT_MARKER);
+
+// Compressed bytes in which the first marker must be found for the
+// parallel path to be used, and maximum compressed size of a segment.
+constexpr size_t DEFLATE_MT_PROBE_SIZE = 4 * 1024 * 1024;
+constexpr size_t DEFLATE_MT_MAX_SEGMENT_SIZE = 64 * 1024 * 1024;
+constexpr size_t DEFLATE_MT_READ_SIZE = 1024 * 1024;
+
+class VSIDeflateReadHandleMT final : public VSIVirtualHandle
+{
+    CPL_DISALLOW_COPY_ASSIGN(VSIDeflateReadHandleMT)
+
+    struct Job
+    {
+        VSIDeflateReadHandleMT *pParent_ = nullptr;
+        vsi_l_offset       nCompressedOffset_ = 0;
+        bool               bLast_ = false;
+        std::string        sCompressedData_{};
+
+        std::string        sUncompressedData_{};
+        uLong              nCRC_ = 0;
+        bool               bOK_ = false;
+        bool               bStreamEnd_ = false;
+        size_t             nRemainingIn_ = 0;
+        bool               bDone_ = false;
+    };
+
+    VSIVirtualHandle*  poFallbackHandle_ = nullptr;
+    VSIVirtualHandle*  poBaseHandle_ = nullptr;
+    bool               bGZip_ = false;
+    vsi_l_offset       nStartOff_ = 0;
+    vsi_l_offset       nEndOff_ = 0;
+    uLong              nExpectedCRC_ = 0;
+    int                nThreads_ = 0;
+    std::unique_ptr<CPLJobQueue> poJobQueue_{};
+    std::mutex         sMutex_{};
+
+    // Scanning of the compressed stream
+    std::list<Job*>    apoJobs_{};
+    std::string        sPending_{};
+    vsi_l_offset       nPendingOffset_ = 0;
+    size_t             nSearchPos_ = 0;
+    bool               bScanEOF_ = false;
+    bool               bScanError_ = false;
+
+    Job*               poCurJob_ = nullptr;
+    vsi_l_offset       nCurJobStart_ = 0;
+    bool               bAfterStreamEnd_ = false;
+    bool               bCRCError_ = false;
+    uLong              nCRC_ = 0;
+
+    vsi_l_offset       nCurOffset_ = 0;
+    bool               bEOF_ = false;
+    bool               bFallback_ = false;
+
+    static void Inflate(void* inData);
+    bool FindNextSegment(Job* psJob);
+    void ScheduleJobs();
+    void CancelJobs();
+    void Restart();
+    bool AdvanceSegment();
+    void StartFallback();
+
+  public:
+    VSIDeflateReadHandleMT( VSIVirtualHandle* poFallbackHandle,
+                            VSIVirtualHandle* poBaseHandle,
+                            int nThreads,
+                            bool bGZip,
+                            vsi_l_offset nStartOff,
+                            vsi_l_offset nEndOff,
+                            uLong nExpectedCRC );
+    ~VSIDeflateReadHandleMT() override;
+
+    int Seek( vsi_l_offset nOffset, int nWhence ) override;
+    vsi_l_offset Tell() override;
+    size_t Read( void *pBuffer, size_t nSize, size_t nMemb ) override;
+    size_t Write( const void *pBuffer, size_t nSize, size_t nMemb ) override;
+    int Eof() override;
+    int Flush() override;
+    int Close() override;
+};
+
+/************************************************************************/
+/*                      VSIDeflateReadHandleMT()                        */
+/************************************************************************/
+
+VSIDeflateReadHandleMT::VSIDeflateReadHandleMT(
+                            VSIVirtualHandle* poFallbackHandle,
+                            VSIVirtualHandle* poBaseHandle,
+                            int nThreads,
+                            bool bGZip,
+                            vsi_l_offset nStartOff,
+                            vsi_l_offset nEndOff,
+                            uLong nExpectedCRC ) :
+    poFallbackHandle_(poFallbackHandle),
+    poBaseHandle_(poBaseHandle),
+    bGZip_(bGZip),
+    nStartOff_(nStartOff),
+    nEndOff_(nEndOff),
+    nExpectedCRC_(nExpectedCRC),
+    nThreads_(nThreads)
+{
+    Restart();
+}
+
+/************************************************************************/
+/*                     ~VSIDeflateReadHandleMT()                        */
+/************************************************************************/
+
+VSIDeflateReadHandleMT::~VSIDeflateReadHandleMT()
+{
+    CancelJobs();
+    delete poFallbackHandle_;
+    poBaseHandle_->Close();
+    delete poBaseHandle_;
+}
+
+/************************************************************************/
+/*                              Inflate()                               */
+/************************************************************************/
+
+void VSIDeflateReadHandleMT::Inflate(void* inData)
+{
+    Job* psJob = static_cast<Job*>(inData);
+
+    z_stream sStream;
+    memset(&sStream, 0, sizeof(sStream));
+    if( inflateInit2( &sStream, -MAX_WBITS ) == Z_OK )
+    {
+        sStream.avail_in = static_cast<uInt>(psJob->sCompressedData_.size());
+        sStream.next_in = reinterpret_cast<Bytef*>(
+            &psJob->sCompressedData_[0]);
+
+        size_t nRealSize = 0;
+        psJob->sUncompressedData_.resize(
+            std::max(static_cast<size_t>(Z_BUFSIZE),
+                     4 * psJob->sCompressedData_.size()));
+        bool bError = false;
+        while( true )
+        {
+            if( nRealSize == psJob->sUncompressedData_.size() )
+                psJob->sUncompressedData_.resize(2 * nRealSize);
+            const size_t nAvailOut = std::min(
+                static_cast<size_t>(UINT_MAX),
+                psJob->sUncompressedData_.size() - nRealSize);
+            sStream.avail_out = static_cast<uInt>(nAvailOut);
+            sStream.next_out = reinterpret_cast<Bytef*>(
+                &psJob->sUncompressedData_[0]) + nRealSize;
+
+            const int zlibRet = inflate( &sStream, Z_NO_FLUSH );
+            nRealSize += nAvailOut - sStream.avail_out;
+            if( zlibRet == Z_STREAM_END )
+            {
+                psJob->bStreamEnd_ = true;
+                break;
+            }
+            if( zlibRet != Z_OK && zlibRet != Z_BUF_ERROR )
+            {
+                bError = true;
+                break;
+            }
+            if( sStream.avail_in == 0 && sStream.avail_out != 0 )
+                break;
+        }
+        psJob->sUncompressedData_.resize(nRealSize);
+        psJob->nRemainingIn_ = sStream.avail_in;
+
+        // Unless the end of the deflate stream is reached, all the input
+        // must have been consumed and inflate must be waiting for a new
+        // block header at a byte boundary. Otherwise, the marker was a
+        // false positive, for example inside the data of a stored block.
+        psJob->bOK_ = !bError &&
+            (psJob->bStreamEnd_ ||
+             (sStream.avail_in == 0 &&
+              (sStream.data_type & 128) != 0 &&
+              (sStream.data_type & 63) == 0));
+        if( psJob->bOK_ )
+        {
+            psJob->nCRC_ = crc32(0U,
+                reinterpret_cast<const Bytef*>(
+                    psJob->sUncompressedData_.data()),
+                static_cast<uInt>(psJob->sUncompressedData_.size()));
+        }
+        inflateEnd( &sStream );
+    }
+
+    std::lock_guard<std::mutex> oLock(psJob->pParent_->sMutex_);
+    psJob->bDone_ = true;
+}
+
+/************************************************************************/
+/*                          FindNextSegment()                           */
+/************************************************************************/
+
+bool VSIDeflateReadHandleMT::FindNextSegment(Job* psJob)
+{
+    const std::string osMarker(reinterpret_cast<const char*>(
+        DEFLATE_MT_MARKER), DEFLATE_MT_MARKER_SIZE);
+    // Do not read too much of a stream that was not written by chunks.
+    const size_t nMaxSize = nPendingOffset_ == nStartOff_ ?
+        DEFLATE_MT_PROBE_SIZE : DEFLATE_MT_MAX_SEGMENT_SIZE;
+
+    while( true )
+    {
+        const size_t nPos = sPending_.find(osMarker, nSearchPos_);
+        if( nPos != std::string::npos )
+        {
+            const size_t nSegmentSize = nPos + DEFLATE_MT_MARKER_SIZE;
+            psJob->nCompressedOffset_ = nPendingOffset_;
+            psJob->sCompressedData_.assign(sPending_, 0, nSegmentSize);
+            sPending_.erase(0, nSegmentSize);
+            nPendingOffset_ += nSegmentSize;
+            nSearchPos_ = 0;
+            return true;
+        }
+
+        const vsi_l_offset nCurReadOffset = nPendingOffset_ + sPending_.size();
+        if( nCurReadOffset >= nEndOff_ )
+        {
+            bScanEOF_ = true;
+            if( sPending_.empty() )
+                return false;
+            if( nMaxSize == DEFLATE_MT_PROBE_SIZE )
+            {
+                // No marker at all: nothing to parallelize.
+                bScanError_ = true;
+                return false;
+            }
+            psJob->nCompressedOffset_ = nPendingOffset_;
+            psJob->bLast_ = true;
+            psJob->sCompressedData_.swap(sPending_);
+            sPending_.clear();
+            nPendingOffset_ = nEndOff_;
+            nSearchPos_ = 0;
+            return true;
+        }
+
+        if( sPending_.size() >= nMaxSize )
+        {
+            bScanError_ = true;
+            return false;
+        }
+
+        nSearchPos_ = sPending_.size() >= DEFLATE_MT_MARKER_SIZE ?
+            sPending_.size() - (DEFLATE_MT_MARKER_SIZE - 1) : 0;
+        const size_t nToRead = static_cast<size_t>(std::min(
+            static_cast<vsi_l_offset>(DEFLATE_MT_READ_SIZE),
+            nEndOff_ - nCurReadOffset));
+        const size_t nOldSize = sPending_.size();
+        sPending_.resize(nOldSize + nToRead);
+        if( poBaseHandle_->Read(&sPending_[nOldSize], 1, nToRead) != nToRead )
+        {
+            bScanError_ = true;
+            return false;
+        }
+    }
+}
+
+/************************************************************************/
+/*                            ScheduleJobs()                            */
+/************************************************************************/
+
+void VSIDeflateReadHandleMT::ScheduleJobs()
+{
+    while( !bScanEOF_ && !bScanError_ &&
+           static_cast<int>(apoJobs_.size()) < 2 * nThreads_ )
+    {
+        if( poJobQueue_ == nullptr )
+        {
+            CPLWorkerThreadPool* poPool =
+                CPLGetGlobalWorkerThreadPool(nThreads_);
+            if( poPool == nullptr )
+            {
+                bScanError_ = true;
+                return;
+            }
+            poJobQueue_ = poPool->CreateJobQueue();
+        }
+
+        Job* psJob = new Job();
+        psJob->pParent_ = this;
+        if( !FindNextSegment(psJob) )
+        {
+            delete psJob;
+            return;
+        }
+        apoJobs_.push_back(psJob);
+        if( !poJobQueue_->SubmitJob(VSIDeflateReadHandleMT::Inflate, psJob) )
+            VSIDeflateReadHandleMT::Inflate(psJob);
+    }
+}
+
+/************************************************************************/
+/*                             CancelJobs()                             */
+/************************************************************************/
+
+void VSIDeflateReadHandleMT::CancelJobs()
+{
+    if( poJobQueue_ )
+        poJobQueue_->WaitCompletion(0);
+    for( auto& psJob: apoJobs_ )
+        delete psJob;
+    apoJobs_.clear();
+    delete poCurJob_;
+    poCurJob_ = nullptr;
+}
+
+/************************************************************************/
+/*                              Restart()                               */
+/************************************************************************/
+
+void VSIDeflateReadHandleMT::Restart()
+{
+    CancelJobs();
+
+    nCurJobStart_ = 0;
+    nPendingOffset_ = nStartOff_;
+    sPending_.clear();
+    nSearchPos_ = 0;
+    bScanEOF_ = false;
+    bScanError_ = false;
+    bAfterStreamEnd_ = false;
+    bCRCError_ = false;
+    nCRC_ = 0;
+
+    if( poBaseHandle_->Seek(nPendingOffset_, SEEK_SET) != 0 )
+        bScanError_ = true;
+}
+
+/************************************************************************/
+/*                           StartFallback()                            */
+/************************************************************************/
+
+void VSIDeflateReadHandleMT::StartFallback()
+{
+    CPLDebug("GZIP", "Falling back to sequential decompression at "
+             CPL_FRMT_GUIB, static_cast<GUIntBig>(nCurOffset_));
+    CancelJobs();
+    bFallback_ = true;
+    poFallbackHandle_->Seek(nCurOffset_, SEEK_SET);
+}
+
+/************************************************************************/
+/*                           AdvanceSegment()                           */
+/************************************************************************/
+
+// Make the next decoded segment the current one. Returns false at the end
+// of the stream, or when switching to the fallback handle or on error.
+bool VSIDeflateReadHandleMT::AdvanceSegment()
+{
+    if( bCRCError_ )
+        return false;
+
+    vsi_l_offset nNextStart = nCurJobStart_;
+    if( poCurJob_ )
+    {
+        nNextStart += poCurJob_->sUncompressedData_.size();
+        if( bAfterStreamEnd_ )
+        {
+            if( poCurJob_->bLast_ &&
+                poCurJob_->nRemainingIn_ == (bGZip_ ? 8U : 0U) )
+            {
+                return false;
+            }
+            // Concatenated .gz members or trailing data.
+            StartFallback();
+            return false;
+        }
+    }
+
+    ScheduleJobs();
+    if( apoJobs_.empty() )
+    {
+        // Truncated stream, or not a stream written by chunks.
+        StartFallback();
+        return false;
+    }
+
+    Job* psJob = apoJobs_.front();
+    {
+        // Waiting on the job queue, instead of the condition, runs queued
+        // jobs meanwhile when called from a worker thread
+        std::unique_lock<std::mutex> oLock(sMutex_);
+        while( !psJob->bDone_ )
+        {
+            int nLater = 0;
+            for( const Job* psOther: apoJobs_ )
+            {
+                if( psOther != psJob && !psOther->bDone_ )
+                    nLater++;
+            }
+            oLock.unlock();
+            poJobQueue_->WaitCompletion(nLater);
+            oLock.lock();
+        }
+    }
+    apoJobs_.pop_front();
+    ScheduleJobs();
+
+    if( !psJob->bOK_ || (psJob->bLast_ && !psJob->bStreamEnd_) )
+    {
+        delete psJob;
+        StartFallback();
+        return false;
+    }
+
+    nCRC_ = crc32_combine(nCRC_, psJob->nCRC_,
+        static_cast<z_off_t>(psJob->sUncompressedData_.size()));
+    if( psJob->bStreamEnd_ )
+    {
+        bAfterStreamEnd_ = true;
+        uLong nExpectedCRC = nExpectedCRC_;
+        if( bGZip_ && psJob->nRemainingIn_ >= 4 )
+        {
+            const GByte* pabyTrailer = reinterpret_cast<const GByte*>(
+                psJob->sCompressedData_.data()) +
+                psJob->sCompressedData_.size() - psJob->nRemainingIn_;
+            nExpectedCRC = static_cast<uLong>(pabyTrailer[0]) |
+                           (static_cast<uLong>(pabyTrailer[1]) << 8) |
+                           (static_cast<uLong>(pabyTrailer[2]) << 16) |
+                           (static_cast<uLong>(pabyTrailer[3]) << 24);
+        }
+        if( nExpectedCRC != nCRC_ )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "CRC error. Got %X instead of %X",
+                     static_cast<unsigned int>(nCRC_),
+                     static_cast<unsigned int>(nExpectedCRC));
+            delete psJob;
+            bCRCError_ = true;
+            return false;
+        }
+    }
+
+    delete poCurJob_;
+    poCurJob_ = psJob;
+    nCurJobStart_ = nNextStart;
+    return true;
+}
+
+/************************************************************************/
+/*                                Seek()                                */
+/************************************************************************/
+
+int VSIDeflateReadHandleMT::Seek( vsi_l_offset nOffset, int nWhence )
+{
+    if( bFallback_ )
+        return poFallbackHandle_->Seek(nOffset, nWhence);
+
+    bEOF_ = false;
+    if( nWhence == SEEK_SET )
+        nCurOffset_ = nOffset;
+    else if( nWhence == SEEK_CUR )
+        nCurOffset_ += nOffset;
+    else
+    {
+        // The uncompressed size is only known by decoding the whole stream,
+        // which is cached by the /vsigzip/ handler.
+        if( poFallbackHandle_->Seek(nOffset, SEEK_END) != 0 )
+            return -1;
+        nCurOffset_ = poFallbackHandle_->Tell();
+    }
+    return 0;
+}
+
+/************************************************************************/
+/*                                Tell()                                */
+/************************************************************************/
+
+vsi_l_offset VSIDeflateReadHandleMT::Tell()
+{
+    if( bFallback_ )
+        return poFallbackHandle_->Tell();
+    return nCurOffset_;
+}
+
+/************************************************************************/
+/*                                Read()                                */
+/************************************************************************/
+
+size_t VSIDeflateReadHandleMT::Read( void *pBuffer, size_t nSize,
+                                     size_t nMemb )
+{
+    if( bFallback_ )
+        return poFallbackHandle_->Read(pBuffer, nSize, nMemb);
+    if( nSize == 0 || nMemb == 0 )
+        return 0;
+
+    if( nCurOffset_ < nCurJobStart_ )
+    {
+        // Rewinding is common, e.g. after a driver identification, but
+        // other backward seeks denote random access, for which the
+        // sequential handle and its snapshots are better suited.
+        if( nCurOffset_ != 0 )
+        {
+            StartFallback();
+            return poFallbackHandle_->Read(pBuffer, nSize, nMemb);
+        }
+        Restart();
+    }
+
+    const size_t nToRead = nSize * nMemb;
+    size_t nRead = 0;
+    GByte* pabyDst = static_cast<GByte*>(pBuffer);
+    while( nRead < nToRead )
+    {
+        if( poCurJob_ && nCurOffset_ >= nCurJobStart_ &&
+            nCurOffset_ < nCurJobStart_ + poCurJob_->sUncompressedData_.size() )
+        {
+            const size_t nOffInJob =
+                static_cast<size_t>(nCurOffset_ - nCurJobStart_);
+            const size_t nToCopy = std::min(nToRead - nRead,
+                poCurJob_->sUncompressedData_.size() - nOffInJob);
+            memcpy(pabyDst + nRead,
+                   poCurJob_->sUncompressedData_.data() + nOffInJob, nToCopy);
+            nRead += nToCopy;
+            nCurOffset_ += nToCopy;
+        }
+        else if( !AdvanceSegment() )
+        {
+            if( bFallback_ )
+            {
+                nRead += poFallbackHandle_->Read(pabyDst + nRead, 1,
+                                                 nToRead - nRead);
+            }
+            else
+            {
+                bEOF_ = true;
+            }
+            break;
+        }
+    }
+    return nRead / nSize;
+}
+
+/************************************************************************/
+/*                               Write()                                */
+/************************************************************************/
+
+size_t VSIDeflateReadHandleMT::Write( const void * /* pBuffer */,
+                                      size_t /* nSize */,
+                                      size_t /* nMemb */ )
+{
+    CPLError(CE_Failure, CPLE_NotSupported,
+             "VSIFWriteL is not supported on GZip streams");
+    return 0;
+}
+
+/************************************************************************/
+/*                                Eof()                                 */
+/************************************************************************/
+
+int VSIDeflateReadHandleMT::Eof()
+{
+    if( bFallback_ )
+        return poFallbackHandle_->Eof();
+    return bEOF_;
+}
+
+/************************************************************************/
+/*                               Flush()                                */
+/************************************************************************/
+
+int VSIDeflateReadHandleMT::Flush()
+{
+    return 0;
+}
+
+/************************************************************************/
+/*                               Close()                                */
+/************************************************************************/
+
+int VSIDeflateReadHandleMT::Close()
+{
+    return 0;
+}
+
+/************************************************************************/
+/*                    VSICreateDeflateReadHandle()                      */
+/************************************************************************/
+
+// Return a reading handle for a deflate stream starting at nStartOff in
+// pszBaseFilename. When GDAL_NUM_THREADS is set, streams made of
+// independently compressed chunks are decoded in parallel ahead of
+// sequential reads, non-sequential accesses being forwarded to the
+// regular handle. Takes ownership of poGZIPHandle.
+static VSIVirtualHandle* VSICreateDeflateReadHandle(
+                                            VSIGZipHandle* poGZIPHandle,
+                                            const char* pszBaseFilename,
+                                            bool bGZip,
+                                            vsi_l_offset nStartOff,
+                                            vsi_l_offset nEndOff,
+                                            uLong nExpectedCRC )
+{
+    const int nThreads = CPLGetNumThreads();
+    if( nThreads > 1 && nEndOff > nStartOff &&
+        nEndOff - nStartOff > DEFLATE_MT_READ_SIZE )
+    {
+        VSIFilesystemHandler *poFSHandler =
+            VSIFileManager::GetHandler( pszBaseFilename );
+        VSIVirtualHandle* poBaseHandle =
+            poFSHandler->Open( pszBaseFilename, "rb" );
+        if( poBaseHandle )
+        {
+            return new VSIDeflateReadHandleMT(
+                VSICreateBufferedReaderHandle(poGZIPHandle), poBaseHandle,
+                nThreads, bGZip, nStartOff, nEndOff, nExpectedCRC);
+        }
+    }
+
+    // Wrap the VSIGZipHandle inside a buffered reader that will
+    // improve dramatically performance when doing small backward
+    // seeks.
+    return VSICreateBufferedReaderHandle(poGZIPHandle);
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*                       VSIGZipWriteHandleMT                           */
@@ -1199,7 +2231,7 @@ class VSIGZipWriteHandleMT final : public VSIVirtualHandle
     int                nDeflateType_ = CPL_DEFLATE_TYPE_GZIP;
     bool               bAutoCloseBaseHandle_ = false;
     int                nThreads_ = 0;
-    std::unique_ptr<CPLWorkerThreadPool> poPool_{};
+    std::unique_ptr<CPLJobQueue> poJobQueue_{};
     std::list<std::string*> aposBuffers_{};
     std::string*       pCurBuffer_ = nullptr;
     std::mutex         sMutex_{};
@@ -1343,9 +2375,9 @@ int VSIGZipWriteHandleMT::Close()
         VSIGZipWriteHandleMT::DeflateCompress( psJob );
     }
 
-    if( poPool_ )
+    if( poJobQueue_ )
     {
-        poPool_->WaitCompletion(0);
+        poJobQueue_->WaitCompletion(0);
     }
     if( !ProcessCompletedJobs() )
     {
@@ -1356,9 +2388,9 @@ int VSIGZipWriteHandleMT::Close()
         CPLAssert(apoFinishedJobs_.empty());
         if( nDeflateType_ == CPL_DEFLATE_TYPE_GZIP )
         {
-            if( poPool_ )
+            if( poJobQueue_ )
             {
-                poPool_->WaitCompletion(0);
+                poJobQueue_->WaitCompletion(0);
             }
             ProcessCompletedJobs();
         }
@@ -1549,12 +2581,9 @@ bool VSIGZipWriteHandleMT::ProcessCompletedJobs()
                 {
                     psJob->bInCRCComputation_ = true;
                     sMutex_.unlock();
-                    if( poPool_ )
-                    {
-                        poPool_->SubmitJob( VSIGZipWriteHandleMT::CRCCompute,
-                                            psJob );
-                    }
-                    else
+                    if( !poJobQueue_ ||
+                        !poJobQueue_->SubmitJob(
+                            VSIGZipWriteHandleMT::CRCCompute, psJob ) )
                     {
                         CRCCompute(psJob);
                     }
@@ -1674,9 +2703,9 @@ size_t VSIGZipWriteHandleMT::Write( const void * const pBuffer,
                         break;
                     }
                 }
-                if( poPool_ )
+                if( poJobQueue_ )
                 {
-                    poPool_->WaitEvent();
+                    poJobQueue_->WaitEvent();
                 }
                 if( !ProcessCompletedJobs() )
                 {
@@ -1694,15 +2723,16 @@ size_t VSIGZipWriteHandleMT::Write( const void * const pBuffer,
         nBytesToWrite -= nConsumed;
         if( pCurBuffer_->size() == nChunkSize_ )
         {
-            if( poPool_ == nullptr )
+            if( poJobQueue_ == nullptr )
             {
-                poPool_.reset(new CPLWorkerThreadPool());
-                if( !poPool_->Setup(nThreads_, nullptr, nullptr, false) )
+                CPLWorkerThreadPool* poPool =
+                    CPLGetGlobalWorkerThreadPool(nThreads_);
+                if( poPool == nullptr )
                 {
                     bHasErrored_ = true;
-                    poPool_.reset();
                     return 0;
                 }
+                poJobQueue_ = poPool->CreateJobQueue();
             }
 
             auto psJob = GetJobObject();
@@ -1711,7 +2741,11 @@ size_t VSIGZipWriteHandleMT::Write( const void * const pBuffer,
             psJob->nSeqNumber_ = nSeqNumberGenerated_;
             nSeqNumberGenerated_ ++;
             pCurBuffer_ = nullptr;
-            poPool_->SubmitJob( VSIGZipWriteHandleMT::DeflateCompress, psJob );
+            if( !poJobQueue_->SubmitJob(
+                    VSIGZipWriteHandleMT::DeflateCompress, psJob ) )
+            {
+                VSIGZipWriteHandleMT::DeflateCompress( psJob );
+            }
         }
     }
 
@@ -1863,22 +2897,13 @@ VSIVirtualHandle* VSICreateGZipWritable( VSIVirtualHandle* poBaseHandle,
                                          int nDeflateTypeIn,
                                          int bAutoCloseBaseHandle )
 {
-    const char* pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", nullptr);
-    if( pszThreads )
+    const int nThreads = CPLGetNumThreads();
+    if( nThreads > 1 )
     {
-        int nThreads = 0;
-        if( EQUAL(pszThreads, "ALL_CPUS") )
-            nThreads = CPLGetNumCPUs();
-        else
-            nThreads = atoi(pszThreads);
-        nThreads = std::max(1, std::min(128, nThreads));
-        if( nThreads > 1 )
-        {
-            return new VSIGZipWriteHandleMT( poBaseHandle,
-                                                nThreads,
-                                                nDeflateTypeIn,
-                                                CPL_TO_BOOL(bAutoCloseBaseHandle) );
-        }
+        return new VSIGZipWriteHandleMT( poBaseHandle,
+                                            nThreads,
+                                            nDeflateTypeIn,
+                                            CPL_TO_BOOL(bAutoCloseBaseHandle) );
     }
     return new VSIGZipWriteHandle( poBaseHandle,
                                    nDeflateTypeIn,
@@ -2185,10 +3210,10 @@ VSIVirtualHandle* VSIGZipFilesystemHandler::Open( const char *pszFilename,
 
     VSIGZipHandle* poGZIPHandle = OpenGZipReadOnly(pszFilename, pszAccess);
     if( poGZIPHandle )
-        // Wrap the VSIGZipHandle inside a buffered reader that will
-        // improve dramatically performance when doing small backward
-        // seeks.
-        return VSICreateBufferedReaderHandle(poGZIPHandle);
+        return VSICreateDeflateReadHandle(
+            poGZIPHandle, pszFilename + strlen("/vsigzip/"), true,
+            poGZIPHandle->GetCompressedDataOffset(),
+            poGZIPHandle->GetEndCompressedDataOffset(), 0);
 
     return nullptr;
 }
@@ -2418,10 +3443,16 @@ const char* VSIGZipFilesystemHandler::GetOptions()
     return
     "<Options>"
     "  <Option name='GDAL_NUM_THREADS' type='string' "
-        "description='Number of threads for compression. Either a integer or ALL_CPUS'/>"
+        "description='Number of threads for compression and decompression. "
+        "Either a integer or ALL_CPUS'/>"
     "  <Option name='CPL_VSIL_DEFLATE_CHUNK_SIZE' type='string' "
         "description='Chunk of uncompressed data for parallelization. "
         "Use K(ilobytes) or M(egabytes) suffix' default='1M'/>"
+    "  <Option name='CPL_VSIL_GZIP_INDEX' type='boolean' "
+        "description='Whether to build and use a seek index' default='NO'/>"
+    "  <Option name='CPL_VSIL_GZIP_INDEX_INTERVAL' type='integer' "
+        "description='Number of uncompressed bytes between access points of "
+        "the seek index' default='1048576'/>"
     "</Options>";
 }
 
@@ -2817,6 +3848,7 @@ VSIVirtualHandle* VSIZipFilesystemHandler::Open( const char *pszFilename,
     VSIVirtualHandle* poVirtualHandle =
         poFSHandler->Open( zipFilename, "rb" );
 
+    const CPLString osZipFilename(zipFilename);
     CPLFree(zipFilename);
     zipFilename = nullptr;
 
@@ -2870,10 +3902,16 @@ VSIVirtualHandle* VSIZipFilesystemHandler::Open( const char *pszFilename,
         return nullptr;
     }
 
-    // Wrap the VSIGZipHandle inside a buffered reader that will
-    // improve dramatically performance when doing small backward
-    // seeks.
-    return VSICreateBufferedReaderHandle(poGZIPHandle);
+    if( file_info.compression_method == 0 )
+    {
+        // Wrap the VSIGZipHandle inside a buffered reader that will
+        // improve dramatically performance when doing small backward
+        // seeks.
+        return VSICreateBufferedReaderHandle(poGZIPHandle);
+    }
+    return VSICreateDeflateReadHandle(poGZIPHandle, osZipFilename, false,
+                                      pos, pos + file_info.compressed_size,
+                                      file_info.crc);
 }
 
 /************************************************************************/
@@ -3095,7 +4133,8 @@ const char* VSIZipFilesystemHandler::GetOptions()
     return
     "<Options>"
     "  <Option name='GDAL_NUM_THREADS' type='string' "
-        "description='Number of threads for compression. Either a integer or ALL_CPUS'/>"
+        "description='Number of threads for compression and decompression. "
+        "Either a integer or ALL_CPUS'/>"
     "  <Option name='CPL_VSIL_DEFLATE_CHUNK_SIZE' type='string' "
         "description='Chunk of uncompressed data for parallelization. "
         "Use K(ilobytes) or M(egabytes) suffix' default='1M'/>"
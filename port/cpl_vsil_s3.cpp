@@ -657,6 +657,9 @@ VSIS3WriteHandle::VSIS3WriteHandle( IVSIS3LikeFSHandler* poFS,
         if( m_nBufferSize <= 0 || m_nBufferSize > 1000 * 1024 * 1024 )
             m_nBufferSize = 50 * 1024 * 1024;
 
+        m_nMaxParallelParts = std::max(1, std::min(64, atoi(
+            CPLGetConfigOption("CPL_VSIL_CURL_UPLOAD_PARALLEL_PARTS", "1"))));
+
         m_pabyBuffer = static_cast<GByte *>(VSIMalloc(m_nBufferSize));
         if( m_pabyBuffer == nullptr )
         {
@@ -676,6 +679,8 @@ VSIS3WriteHandle::~VSIS3WriteHandle()
     Close();
     delete m_poS3HandleHelper;
     CPLFree(m_pabyBuffer);
+    for( GByte* pabyBuffer: m_apabyFreeBuffers )
+        CPLFree(pabyBuffer);
     if( m_hCurlMulti )
     {
         if( m_hCurl )
@@ -895,6 +900,57 @@ bool VSIS3WriteHandle::UploadPart()
         return false;
     }
 
+    if( m_nMaxParallelParts > 1 )
+        return SubmitPartUpload();
+
+    CPLString osEtag;
+    if( !UploadPartInternal(
+            m_nPartNumber, m_pabyBuffer, m_nBufferOff,
+            m_poFS->GetCurlMultiHandleFor(m_poS3HandleHelper->GetURL()),
+            osEtag) )
+    {
+        return false;
+    }
+    m_aosEtags.push_back(osEtag);
+    return true;
+}
+
+/************************************************************************/
+/*                         VSIS3PartReadData                            */
+/************************************************************************/
+
+namespace {
+typedef struct
+{
+    const GByte *pabyData;
+    size_t       nSize;
+    size_t       nOff;
+} VSIS3PartReadData;
+
+static size_t VSIS3PartReadCallBack( char *buffer, size_t size,
+                                     size_t nitems, void *instream )
+{
+    VSIS3PartReadData* psData = static_cast<VSIS3PartReadData *>(instream);
+    const size_t nSizeToWrite =
+        std::min(size * nitems, psData->nSize - psData->nOff);
+    memcpy(buffer, psData->pabyData + psData->nOff, nSizeToWrite);
+    psData->nOff += nSizeToWrite;
+    return nSizeToWrite;
+}
+} // namespace
+
+/************************************************************************/
+/*                        UploadPartInternal()                          */
+/************************************************************************/
+
+// May be called from several threads at once: the handle helper is only
+// accessed with m_oHelperMutex held.
+bool VSIS3WriteHandle::UploadPartInternal( int nPartNumber,
+                                           const GByte* pabyBuffer,
+                                           int nBufferSize,
+                                           CURLM* hCurlMultiHandle,
+                                           CPLString& osEtagOut )
+{
     bool bRetry;
     double dfRetryDelay = m_dfRetryDelay;
     int nRetryCount = 0;
@@ -903,28 +959,36 @@ bool VSIS3WriteHandle::UploadPart()
     {
         bRetry = false;
 
-        m_nBufferOffReadCallback = 0;
+        VSIS3PartReadData sReadData;
+        sReadData.pabyData = pabyBuffer;
+        sReadData.nSize = static_cast<size_t>(nBufferSize);
+        sReadData.nOff = 0;
+
         CURL* hCurlHandle = curl_easy_init();
-        m_poS3HandleHelper->AddQueryParameter("partNumber",
-                                            CPLSPrintf("%d", m_nPartNumber));
-        m_poS3HandleHelper->AddQueryParameter("uploadId", m_osUploadID);
         curl_easy_setopt(hCurlHandle, CURLOPT_UPLOAD, 1L);
-        curl_easy_setopt(hCurlHandle, CURLOPT_READFUNCTION, ReadCallBackBuffer);
-        curl_easy_setopt(hCurlHandle, CURLOPT_READDATA, this);
-        curl_easy_setopt(hCurlHandle, CURLOPT_INFILESIZE, m_nBufferOff);
+        curl_easy_setopt(hCurlHandle, CURLOPT_READFUNCTION,
+                         VSIS3PartReadCallBack);
+        curl_easy_setopt(hCurlHandle, CURLOPT_READDATA, &sReadData);
+        curl_easy_setopt(hCurlHandle, CURLOPT_INFILESIZE, nBufferSize);
 
-        struct curl_slist* headers = static_cast<struct curl_slist*>(
-            CPLHTTPSetOptions(hCurlHandle,
-                            m_poS3HandleHelper->GetURL().c_str(),
-                            nullptr));
-        headers = VSICurlMergeHeaders(headers,
+        CPLString osURL;
+        struct curl_slist* headers = nullptr;
+        {
+            std::lock_guard<std::mutex> oLock(m_oHelperMutex);
+            m_poS3HandleHelper->AddQueryParameter("partNumber",
+                                            CPLSPrintf("%d", nPartNumber));
+            m_poS3HandleHelper->AddQueryParameter("uploadId", m_osUploadID);
+            osURL = m_poS3HandleHelper->GetURL();
+            headers = static_cast<struct curl_slist*>(
+                CPLHTTPSetOptions(hCurlHandle, osURL.c_str(), nullptr));
+            headers = VSICurlMergeHeaders(headers,
                         m_poS3HandleHelper->GetCurlHeaders("PUT", headers,
-                                                            m_pabyBuffer,
-                                                            m_nBufferOff));
+                                                           pabyBuffer,
+                                                           nBufferSize));
+            m_poS3HandleHelper->ResetQueryParameters();
+        }
         curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
 
-        m_poS3HandleHelper->ResetQueryParameters();
-
         WriteFuncStruct sWriteFuncData;
         VSICURLInitWriteFuncStruct(&sWriteFuncData, nullptr, nullptr, nullptr);
         curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA, &sWriteFuncData);
@@ -941,8 +1005,7 @@ bool VSIS3WriteHandle::UploadPart()
         szCurlErrBuf[0] = '\0';
         curl_easy_setopt(hCurlHandle, CURLOPT_ERRORBUFFER, szCurlErrBuf );
 
-        MultiPerform(m_poFS->GetCurlMultiHandleFor(m_poS3HandleHelper->GetURL()),
-                        hCurlHandle);
+        MultiPerform(hCurlMultiHandle, hCurlHandle);
 
         VSICURLResetHeaderAndWriterFunctions(hCurlHandle);
 
@@ -963,7 +1026,7 @@ bool VSIS3WriteHandle::UploadPart()
                             "HTTP error code: %d - %s. "
                             "Retrying again in %.1f secs",
                             static_cast<int>(response_code),
-                            m_poS3HandleHelper->GetURL().c_str(),
+                            osURL.c_str(),
                             dfRetryDelay);
                 CPLSleep(dfRetryDelay);
                 dfRetryDelay = dfNewRetryDelay;
@@ -975,7 +1038,7 @@ bool VSIS3WriteHandle::UploadPart()
                 CPLDebug(m_poFS->GetDebugKey(), "%s",
                         sWriteFuncData.pBuffer ? sWriteFuncData.pBuffer : "(null)");
                 CPLError(CE_Failure, CPLE_AppDefined, "UploadPart(%d) of %s failed",
-                            m_nPartNumber, m_osFilename.c_str());
+                            nPartNumber, m_osFilename.c_str());
                 bSuccess = false;
             }
         }
@@ -990,14 +1053,14 @@ bool VSIS3WriteHandle::UploadPart()
                 if( nPosEOL != std::string::npos )
                     osEtag.resize(nPosEOL);
                 CPLDebug(m_poFS->GetDebugKey(), "Etag for part %d is %s",
-                        m_nPartNumber, osEtag.c_str());
-                m_aosEtags.push_back(osEtag);
+                        nPartNumber, osEtag.c_str());
+                osEtagOut = osEtag;
             }
             else
             {
                 CPLError(CE_Failure, CPLE_AppDefined,
                         "UploadPart(%d) of %s (uploadId = %s) failed",
-                        m_nPartNumber, m_osFilename.c_str(), m_osUploadID.c_str());
+                        nPartNumber, m_osFilename.c_str(), m_osUploadID.c_str());
                 bSuccess = false;
             }
         }
@@ -1012,6 +1075,117 @@ bool VSIS3WriteHandle::UploadPart()
     return bSuccess;
 }
 
+/************************************************************************/
+/*                        UploadPartThreadFunc()                        */
+/************************************************************************/
+
+void VSIS3WriteHandle::UploadPartThreadFunc( void* pData )
+{
+    PartUploadJob* psJob = static_cast<PartUploadJob*>(pData);
+
+    VSIS3WriteHandle* poThis = psJob->poHandle;
+
+    // The connection cache is per-thread, so each upload thread gets its
+    // own multi handle, which is reused for the parts it uploads.
+    psJob->bSuccess = poThis->UploadPartInternal(
+        psJob->nPartNumber, psJob->pabyBuffer, psJob->nBufferSize,
+        poThis->m_poFS->GetCurlMultiHandleFor(CPLString()), psJob->osEtag);
+    psJob->bDone = true;
+}
+
+/************************************************************************/
+/*                          SubmitPartUpload()                          */
+/************************************************************************/
+
+bool VSIS3WriteHandle::SubmitPartUpload()
+{
+    if( !m_poUploadThreadPool )
+    {
+        m_poUploadThreadPool.reset(new CPLWorkerThreadPool());
+        if( !m_poUploadThreadPool->Setup(m_nMaxParallelParts,
+                                         nullptr, nullptr) )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot create upload threads for %s",
+                     m_osFilename.c_str());
+            m_poUploadThreadPool.reset();
+            return false;
+        }
+    }
+
+    // Bound the number of parts in flight, and thus the memory used.
+    if( !CollectFinishedParts(m_nMaxParallelParts - 1) )
+        return false;
+
+    GByte* pabyNextBuffer = nullptr;
+    if( !m_apabyFreeBuffers.empty() )
+    {
+        pabyNextBuffer = m_apabyFreeBuffers.back();
+        m_apabyFreeBuffers.pop_back();
+    }
+    else
+    {
+        pabyNextBuffer = static_cast<GByte *>(VSIMalloc(m_nBufferSize));
+        if( pabyNextBuffer == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate working buffer for %s",
+                     m_poFS->GetFSPrefix().c_str());
+            return false;
+        }
+    }
+
+    PartUploadJob* psJob = new PartUploadJob();
+    m_apoPendingJobs.push_back(std::unique_ptr<PartUploadJob>(psJob));
+    psJob->poHandle = this;
+    psJob->nPartNumber = m_nPartNumber;
+    psJob->pabyBuffer = m_pabyBuffer;
+    psJob->nBufferSize = m_nBufferOff;
+
+    // The next part is filled while this one is uploaded.
+    m_pabyBuffer = pabyNextBuffer;
+
+    if( !m_poUploadThreadPool->SubmitJob(UploadPartThreadFunc, psJob) )
+        UploadPartThreadFunc(psJob);
+    return true;
+}
+
+/************************************************************************/
+/*                        CollectFinishedParts()                        */
+/************************************************************************/
+
+bool VSIS3WriteHandle::CollectFinishedParts( int nMaxRemainingJobs )
+{
+    if( m_poUploadThreadPool )
+        m_poUploadThreadPool->WaitCompletion(nMaxRemainingJobs);
+
+    bool bSuccess = true;
+    for( auto oIter = m_apoPendingJobs.begin();
+         oIter != m_apoPendingJobs.end(); )
+    {
+        PartUploadJob* psJob = oIter->get();
+        if( !psJob->bDone )
+        {
+            ++oIter;
+            continue;
+        }
+        if( psJob->bSuccess )
+        {
+            // Parts may complete out of order.
+            if( m_aosEtags.size() < static_cast<size_t>(psJob->nPartNumber) )
+                m_aosEtags.resize(psJob->nPartNumber);
+            m_aosEtags[psJob->nPartNumber - 1] = psJob->osEtag;
+        }
+        else
+        {
+            bSuccess = false;
+        }
+        m_apabyFreeBuffers.push_back(psJob->pabyBuffer);
+        oIter = m_apoPendingJobs.erase(oIter);
+    }
+    return bSuccess;
+}
+
 /************************************************************************/
 /*                      ReadCallBackBufferChunked()                     */
 /************************************************************************/
@@ -1708,13 +1882,17 @@ int VSIS3WriteHandle::Close()
         }
         else
         {
-            if( m_bError )
+            bool bCloseError = false;
+            if( !m_bError && m_nBufferOff > 0 && !UploadPart() )
+                bCloseError = true;
+            // Wait for the parts still being uploaded.
+            if( !CollectFinishedParts(0) )
+                bCloseError = true;
+            if( m_bError || bCloseError )
             {
-                if( !AbortMultipart() )
+                if( !AbortMultipart() || bCloseError )
                     nRet = -1;
             }
-            else if( m_nBufferOff > 0 && !UploadPart() )
-                nRet = -1;
             else if( !CompleteMultipart() )
                 nRet = -1;
         }
@@ -470,6 +470,10 @@ public:
     const char* GetPrefix() override { return "/vsitar"; }
     std::vector<CPLString> GetExtensions() override;
     VSIArchiveReader* CreateReader(const char* pszTarFileName) override;
+    bool SerializeFileOffset( const VSIArchiveEntryFileOffset* poOffset,
+                              GUIntBig anValues[2] ) override;
+    VSIArchiveEntryFileOffset* DeserializeFileOffset(
+                              const GUIntBig anValues[2] ) override;
 
     VSIVirtualHandle *Open( const char *pszFilename,
                             const char *pszAccess,
@@ -522,6 +526,38 @@ VSIArchiveReader* VSITarFilesystemHandler::CreateReader(const char* pszTarFileNa
     return poReader;
 }
 
+/************************************************************************/
+/*                        SerializeFileOffset()                         */
+/************************************************************************/
+
+bool VSITarFilesystemHandler::SerializeFileOffset(
+    const VSIArchiveEntryFileOffset* poOffset, GUIntBig anValues[2] )
+{
+    const VSITarEntryFileOffset* poTarOffset =
+        static_cast<const VSITarEntryFileOffset*>(poOffset);
+#ifdef HAVE_FUZZER_FRIENDLY_ARCHIVE
+    // The offsets of fuzzer friendly archives carry the member name.
+    if( !poTarOffset->m_osFileName.empty() )
+        return false;
+#endif
+    anValues[0] = poTarOffset->m_nOffset;
+    anValues[1] = 0;
+    return true;
+}
+
+/************************************************************************/
+/*                       DeserializeFileOffset()                        */
+/************************************************************************/
+
+VSIArchiveEntryFileOffset* VSITarFilesystemHandler::DeserializeFileOffset(
+    const GUIntBig anValues[2] )
+{
+    // GotoFileOffset() reads the header block preceding the data.
+    if( anValues[0] < 512 )
+        return nullptr;
+    return new VSITarEntryFileOffset(anValues[0]);
+}
+
 /************************************************************************/
 /*                                 Open()                               */
 /************************************************************************/
@@ -109,6 +109,12 @@ CPL_CVSID("$Id: cpl_vsil_unix_stdio_64.cpp e6801fa6bc6733ad029a6a278ef8171aef997
 #ifndef VSI_FTRUNCATE64
 #define VSI_FTRUNCATE64 ftruncate64
 #endif
+#ifndef VSI_PREAD64
+#define VSI_PREAD64 pread64
+#endif
+#ifndef VSI_POSIX_FADVISE64
+#define VSI_POSIX_FADVISE64 posix_fadvise64
+#endif
 
 #else /* not UNIX_STDIO_64 */
 
@@ -130,6 +136,12 @@ CPL_CVSID("$Id: cpl_vsil_unix_stdio_64.cpp e6801fa6bc6733ad029a6a278ef8171aef997
 #ifndef VSI_FTRUNCATE64
 #define VSI_FTRUNCATE64 ftruncate
 #endif
+#ifndef VSI_PREAD64
+#define VSI_PREAD64 pread
+#endif
+#ifndef VSI_POSIX_FADVISE64
+#define VSI_POSIX_FADVISE64 posix_fadvise
+#endif
 
 #endif /* ndef UNIX_STDIO_64 */
 
@@ -166,6 +178,7 @@ public:
     char **ReadDirEx( const char *pszDirname, int nMaxFiles ) override;
     GIntBig GetDiskFreeSpace( const char* pszDirname ) override;
     int SupportsSparseFiles( const char* pszPath ) override;
+    int HasOptimizedReadMultiRange( const char* pszPath ) override;
 
 #ifdef VSI_COUNT_BYTES_READ
     void             AddToTotal(vsi_l_offset nBytes);
@@ -205,6 +218,9 @@ class VSIUnixStdioHandle final : public VSIVirtualHandle
     int Seek( vsi_l_offset nOffsetIn, int nWhence ) override;
     vsi_l_offset Tell() override;
     size_t Read( void *pBuffer, size_t nSize, size_t nMemb ) override;
+    int ReadMultiRange( int nRanges, void ** ppData,
+                        const vsi_l_offset* panOffsets,
+                        const size_t* panSizes ) override;
     size_t Write( const void *pBuffer, size_t nSize, size_t nMemb ) override;
     int Eof() override;
     int Flush() override;
@@ -438,6 +454,72 @@ size_t VSIUnixStdioHandle::Read( void * pBuffer, size_t nSize, size_t nCount )
     return nResult;
 }
 
+/************************************************************************/
+/*                     VSIUnixStdioUseMultiRange()                      */
+/************************************************************************/
+
+static bool VSIUnixStdioUseMultiRange()
+{
+    return CPLTestBool(
+        CPLGetConfigOption("CPL_VSIL_UNIX_STDIO_READ_MULTI_RANGE", "NO"));
+}
+
+/************************************************************************/
+/*                          ReadMultiRange()                            */
+/************************************************************************/
+
+int VSIUnixStdioHandle::ReadMultiRange( int nRanges, void ** ppData,
+                                        const vsi_l_offset* panOffsets,
+                                        const size_t* panSizes )
+{
+    // pread() bypasses the stdio buffer, which is only safe to do if there
+    // are no pending writes.
+    if( !bReadOnly || !VSIUnixStdioUseMultiRange() )
+        return VSIVirtualHandle::ReadMultiRange(nRanges, ppData,
+                                                panOffsets, panSizes);
+
+    const int fd = fileno(fp);
+
+#ifdef POSIX_FADV_WILLNEED
+    // Tell the kernel about all the ranges first, so that it can issue
+    // the reads asynchronously and keep the device queue busy, instead of
+    // waiting for each range in turn.
+    for( int i = 0; i < nRanges; i++ )
+    {
+        CPL_IGNORE_RET_VAL(VSI_POSIX_FADVISE64(fd, panOffsets[i], panSizes[i],
+                                               POSIX_FADV_WILLNEED));
+    }
+#endif
+
+    for( int i = 0; i < nRanges; i++ )
+    {
+        char* pabyData = static_cast<char*>(ppData[i]);
+        size_t nRead = 0;
+        while( nRead < panSizes[i] )
+        {
+            const ssize_t nRet = VSI_PREAD64(fd, pabyData + nRead,
+                                             panSizes[i] - nRead,
+                                             panOffsets[i] + nRead);
+            if( nRet < 0 && errno == EINTR )
+                continue;
+            if( nRet <= 0 )
+            {
+                CPLDebug("VSI", "ReadMultiRange(): pread() at "
+                         CPL_FRMT_GUIB " failed: %s",
+                         static_cast<GUIntBig>(panOffsets[i] + nRead),
+                         nRet < 0 ? VSIStrerror(errno) : "end of file");
+                return -1;
+            }
+            nRead += static_cast<size_t>(nRet);
+        }
+#ifdef VSI_COUNT_BYTES_READ
+        nTotalBytesRead += nRead;
+#endif
+    }
+
+    return 0;
+}
+
 /************************************************************************/
 /*                               Write()                                */
 /************************************************************************/
@@ -648,12 +730,22 @@ VSIUnixStdioFilesystemHandler::Open( const char *pszFilename,
 
 /* -------------------------------------------------------------------- */
 /*      If VSI_CACHE is set we want to use a cached reader instead      */
-/*      of more direct io on the underlying file.                       */
+/*      of more direct io on the underlying file. Files opened in       */
+/*      update mode, except in append mode, can also use it to          */
+/*      coalesce small writes if VSI_CACHE_WRITE_BACK is set.           */
 /* -------------------------------------------------------------------- */
-    if( bReadOnly &&
-        CPLTestBool( CPLGetConfigOption( "VSI_CACHE", "FALSE" ) ) )
+    if( CPLTestBool( CPLGetConfigOption( "VSI_CACHE", "FALSE" ) ) )
     {
-        return VSICreateCachedFile( poHandle );
+        if( bReadOnly )
+            return VSICreateSharedCachedFile( this, pszFilename, poHandle,
+                                              false );
+        if( strchr(pszAccess, 'a') == nullptr &&
+            CPLTestBool(
+                CPLGetConfigOption( "VSI_CACHE_WRITE_BACK", "FALSE" ) ) )
+        {
+            return VSICreateSharedCachedFile( this, pszFilename, poHandle,
+                                              true );
+        }
     }
 
     return poHandle;
@@ -861,6 +953,16 @@ int VSIUnixStdioFilesystemHandler::SupportsSparseFiles( const char*
 #endif
 }
 
+/************************************************************************/
+/*                     HasOptimizedReadMultiRange()                     */
+/************************************************************************/
+
+int VSIUnixStdioFilesystemHandler::HasOptimizedReadMultiRange(
+                                            const char* /* pszPath */ )
+{
+    return VSIUnixStdioUseMultiRange();
+}
+
 #ifdef VSI_COUNT_BYTES_READ
 /************************************************************************/
 /*                            AddToTotal()                              */
@@ -109,6 +109,7 @@ class VSIWebHDFSHandle final : public VSICurlHandle
     CPLString       m_osDelegationParam{};
 
    std::string      DownloadRegion(vsi_l_offset startOffset, int nBlocks) override;
+   bool             CanDownloadRegionsInParallel() override { return false; }
 
   public:
     VSIWebHDFSHandle( VSIWebHDFSFSHandler* poFS,
@@ -691,10 +691,18 @@ VSIVirtualHandle *VSIWin32FilesystemHandler::Open( const char *pszFilename,
 /*      If VSI_CACHE is set we want to use a cached reader instead      */
 /*      of more direct io on the underlying file.                       */
 /* -------------------------------------------------------------------- */
-    if( (EQUAL(pszAccess,"r") || EQUAL(pszAccess,"rb"))
-        && CPLTestBool( CPLGetConfigOption( "VSI_CACHE", "FALSE" ) ) )
+    if( CPLTestBool( CPLGetConfigOption( "VSI_CACHE", "FALSE" ) ) )
     {
-        return VSICreateCachedFile( poHandle );
+        if( EQUAL(pszAccess,"r") || EQUAL(pszAccess,"rb") )
+            return VSICreateSharedCachedFile( this, pszFilename, poHandle,
+                                              false );
+        if( strchr(pszAccess, 'a') == nullptr &&
+            CPLTestBool(
+                CPLGetConfigOption( "VSI_CACHE_WRITE_BACK", "FALSE" ) ) )
+        {
+            return VSICreateSharedCachedFile( this, pszFilename, poHandle,
+                                              true );
+        }
     }
     else
     {
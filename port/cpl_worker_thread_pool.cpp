@@ -29,16 +29,28 @@
 #include "cpl_port.h"
 #include "cpl_worker_thread_pool.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <memory>
+#include <new>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_string.h"
 #include "cpl_vsi.h"
 
 
 CPL_CVSID("$Id: cpl_worker_thread_pool.cpp 9b93d5aaef0e512d52da849390cb72856db540b6 2018-07-01 22:10:36 +0200 Even Rouault $")
 
+// Worker thread running the calling code, if any. A plain pointer, so
+// thread_local is safe even in DLLs on Windows.
+static thread_local CPLWorkerThread* tls_psCurrentWorkerThread = nullptr;
+
+// Delay after which a worker thread waiting for the completion of jobs
+// looks again for queued jobs it could run.
+static const std::chrono::milliseconds oHelpDelay(10);
+
 /************************************************************************/
 /*                         CPLWorkerThreadPool()                        */
 /************************************************************************/
@@ -48,11 +60,7 @@ CPL_CVSID("$Id: cpl_worker_thread_pool.cpp 9b93d5aaef0e512d52da849390cb72856db54
  * The pool is in an uninitialized state after this call. The Setup() method
  * must be called.
  */
-CPLWorkerThreadPool::CPLWorkerThreadPool() :
-    hMutex( CPLCreateMutexEx(CPL_MUTEX_REGULAR) )
-{
-    CPLReleaseMutex(hMutex);
-}
+CPLWorkerThreadPool::CPLWorkerThreadPool() = default;
 
 /************************************************************************/
 /*                          ~CPLWorkerThreadPool()                      */
@@ -64,29 +72,19 @@ CPLWorkerThreadPool::CPLWorkerThreadPool() :
  */
 CPLWorkerThreadPool::~CPLWorkerThreadPool()
 {
-    if( hCond )
+    if( !aWT.empty() )
     {
         WaitCompletion();
 
-        CPLAcquireMutex(hMutex, 1000.0);
-        eState = CPLWTS_STOP;
-        CPLReleaseMutex(hMutex);
-
-        for(size_t i=0;i<aWT.size();i++)
         {
-            CPLAcquireMutex(aWT[i].hMutex, 1000.0);
-            CPLCondSignal(aWT[i].hCond);
-            CPLReleaseMutex(aWT[i].hMutex);
-            CPLJoinThread(aWT[i].hThread);
-            CPLDestroyCond(aWT[i].hCond);
-            CPLDestroyMutex(aWT[i].hMutex);
+            std::lock_guard<std::mutex> oLock(m_mutex);
+            eState = CPLWTS_STOP;
+            m_cvWorkers.notify_all();
         }
 
-        CPLListDestroy(psWaitingWorkerThreadsList);
-
-        CPLDestroyCond(hCond);
+        for( auto& psWT: aWT )
+            CPLJoinThread(psWT->hThread);
     }
-    CPLDestroyMutex(hMutex);
 }
 
 /************************************************************************/
@@ -98,97 +96,117 @@ void CPLWorkerThreadPool::WorkerThreadFunction(void* user_data)
     CPLWorkerThread* psWT = static_cast<CPLWorkerThread*>(user_data);
     CPLWorkerThreadPool* poTP = psWT->poTP;
 
+    tls_psCurrentWorkerThread = psWT;
+
     if( psWT->pfnInitFunc )
         psWT->pfnInitFunc( psWT->pInitData );
 
-    while( true )
     {
-        CPLWorkerThreadJob* psJob = poTP->GetNextJob(psWT);
-        if( psJob == nullptr )
-            break;
+        std::lock_guard<std::mutex> oLock(poTP->m_mutex);
+        poTP->nStartedThreads++;
+        poTP->m_cvEvent.notify_all();
+    }
 
-        if( psJob->pfnFunc )
-        {
-            psJob->pfnFunc(psJob->pData);
-        }
-        CPLFree(psJob);
+    CPLWorkerThreadJob sJob;
+    while( poTP->GetNextJob(psWT, sJob) )
+    {
+        poTP->RunJob(sJob);
 #if DEBUG_VERBOSE
         CPLDebug("JOB", "%p finished a job", psWT);
 #endif
-        poTP->DeclareJobFinished();
     }
+
+    tls_psCurrentWorkerThread = nullptr;
 }
 
 /************************************************************************/
-/*                             SubmitJob()                              */
+/*                       GetCurrentWorkerThread()                       */
 /************************************************************************/
 
-/** Queue a new job.
- *
- * @param pfnFunc Function to run for the job.
- * @param pData User data to pass to the job function.
- * @return true in case of success.
- */
-bool CPLWorkerThreadPool::SubmitJob( CPLThreadFunc pfnFunc, void* pData )
+CPLWorkerThread* CPLWorkerThreadPool::GetCurrentWorkerThread() const
 {
-    CPLAssert( !aWT.empty() );
+    CPLWorkerThread* psWT = tls_psCurrentWorkerThread;
+    return (psWT != nullptr && psWT->poTP == this) ? psWT : nullptr;
+}
 
-    CPLWorkerThreadJob* psJob = static_cast<CPLWorkerThreadJob *>(
-        VSI_MALLOC_VERBOSE(sizeof(CPLWorkerThreadJob)));
-    if( psJob == nullptr )
-        return false;
-    psJob->pfnFunc = pfnFunc;
-    psJob->pData = pData;
+/************************************************************************/
+/*                              PushJob()                               */
+/************************************************************************/
+
+// Jobs submitted from a worker thread go to its own queue, the other ones
+// to the queue of the pool.
+bool CPLWorkerThreadPool::PushJob( CPLThreadFunc pfnFunc, void* pData,
+                                   CPLJobQueue* poQueue )
+{
+    CPLWorkerThreadJob sJob;
+    sJob.pfnFunc = pfnFunc;
+    sJob.pData = pData;
+    sJob.poQueue = poQueue;
 
-    CPLList* psItem =
-        static_cast<CPLList *>(VSI_MALLOC_VERBOSE(sizeof(CPLList)));
-    if( psItem == nullptr )
+    if( poQueue )
     {
-        VSIFree(psJob);
-        return false;
+        std::lock_guard<std::mutex> oLock(poQueue->m_mutex);
+        poQueue->m_nPendingJobs++;
     }
-    psItem->pData = psJob;
 
-    CPLAcquireMutex(hMutex, 1000.0);
+    CPLWorkerThread* psWT = GetCurrentWorkerThread();
 
-    psItem->psNext = psJobQueue;
-    psJobQueue = psItem;
+    // The pending job count is updated while the job is queued, so that
+    // the job cannot finish before.
+    std::lock_guard<std::mutex> oLock(m_mutex);
+    try
+    {
+        if( psWT )
+        {
+            std::lock_guard<std::mutex> oLockWT(psWT->oMutex);
+            psWT->aoJobs.push_back(sJob);
+        }
+        else
+        {
+            m_aoJobs.push_back(sJob);
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Cannot queue job");
+        if( poQueue )
+            poQueue->DeclareJobFinished();
+        return false;
+    }
     nPendingJobs++;
+    m_nQueuedJobs++;
 
-    if( psWaitingWorkerThreadsList )
+    if( nWaitingWorkerThreads > 0 )
     {
-        CPLWorkerThread* psWorkerThread =
-            static_cast<CPLWorkerThread *>(psWaitingWorkerThreadsList->pData);
-
-        CPLAssert( psWorkerThread->bMarkedAsWaiting );
-        psWorkerThread->bMarkedAsWaiting = FALSE;
-
-        CPLList* psNext = psWaitingWorkerThreadsList->psNext;
-        CPLList* psToFree = psWaitingWorkerThreadsList;
-        psWaitingWorkerThreadsList = psNext;
-        nWaitingWorkerThreads--;
-
-        // CPLAssert(
-        //   CPLListCount(psWaitingWorkerThreadsList) == nWaitingWorkerThreads);
-
 #if DEBUG_VERBOSE
-        CPLDebug("JOB", "Waking up %p", psWorkerThread);
+        CPLDebug("JOB", "Waking up a worker thread");
 #endif
-        CPLAcquireMutex(psWorkerThread->hMutex, 1000.0);
-        CPLReleaseMutex(hMutex);
-        CPLCondSignal(psWorkerThread->hCond);
-        CPLReleaseMutex(psWorkerThread->hMutex);
-
-        CPLFree(psToFree);
-    }
-    else
-    {
-        CPLReleaseMutex(hMutex);
+        m_cvWorkers.notify_one();
     }
 
     return true;
 }
 
+/************************************************************************/
+/*                             SubmitJob()                              */
+/************************************************************************/
+
+/** Queue a new job.
+ *
+ * When called from a job run by the pool, the job is queued in the queue
+ * of the worker thread, from which idle threads steal jobs.
+ *
+ * @param pfnFunc Function to run for the job.
+ * @param pData User data to pass to the job function.
+ * @return true in case of success.
+ */
+bool CPLWorkerThreadPool::SubmitJob( CPLThreadFunc pfnFunc, void* pData )
+{
+    CPLAssert( !aWT.empty() );
+
+    return PushJob(pfnFunc, pData, nullptr);
+}
+
 /************************************************************************/
 /*                             SubmitJobs()                              */
 /************************************************************************/
@@ -204,103 +222,163 @@ bool CPLWorkerThreadPool::SubmitJobs(CPLThreadFunc pfnFunc,
 {
     CPLAssert( !aWT.empty() );
 
-    CPLAcquireMutex(hMutex, 1000.0);
-
-    CPLList* psJobQueueInit = psJobQueue;
-    bool bRet = true;
+    CPLWorkerThread* psWT = GetCurrentWorkerThread();
 
-    for(size_t i=0;i<apData.size();i++)
+    std::lock_guard<std::mutex> oLock(m_mutex);
     {
-        CPLWorkerThreadJob* psJob = static_cast<CPLWorkerThreadJob*>(
-            VSI_MALLOC_VERBOSE(sizeof(CPLWorkerThreadJob)));
-        if( psJob == nullptr )
+        std::unique_lock<std::mutex> oLockWT;
+        if( psWT )
+            oLockWT = std::unique_lock<std::mutex>(psWT->oMutex);
+        std::deque<CPLWorkerThreadJob>& aoJobs =
+            psWT ? psWT->aoJobs : m_aoJobs;
+        size_t nPushed = 0;
+        try
         {
-            bRet = false;
-            break;
+            for( void* pData: apData )
+            {
+                CPLWorkerThreadJob sJob;
+                sJob.pfnFunc = pfnFunc;
+                sJob.pData = pData;
+                sJob.poQueue = nullptr;
+                aoJobs.push_back(sJob);
+                nPushed++;
+            }
         }
-        psJob->pfnFunc = pfnFunc;
-        psJob->pData = apData[i];
-
-        CPLList* psItem =
-            static_cast<CPLList *>(VSI_MALLOC_VERBOSE(sizeof(CPLList)));
-        if( psItem == nullptr )
+        catch( const std::bad_alloc& )
         {
-            VSIFree(psJob);
-            bRet = false;
-            break;
+            CPLError(CE_Failure, CPLE_OutOfMemory, "Cannot queue jobs");
+            aoJobs.resize(aoJobs.size() - nPushed);
+            return false;
         }
-        psItem->pData = psJob;
-
-        psItem->psNext = psJobQueue;
-        psJobQueue = psItem;
-        nPendingJobs++;
     }
+    const int nJobs = static_cast<int>(apData.size());
+    nPendingJobs += nJobs;
+    m_nQueuedJobs += nJobs;
 
-    if( !bRet )
+    if( nWaitingWorkerThreads > 0 )
     {
-        for( CPLList* psIter = psJobQueue; psIter != psJobQueueInit; )
+        if( nJobs >= nWaitingWorkerThreads )
         {
-            CPLList* psNext = psIter->psNext;
-            VSIFree(psIter->pData);
-            VSIFree(psIter);
-            nPendingJobs--;
-            psIter = psNext;
+            m_cvWorkers.notify_all();
+        }
+        else
+        {
+            for( int i = 0; i < nJobs; i++ )
+                m_cvWorkers.notify_one();
         }
     }
 
-    CPLReleaseMutex(hMutex);
+    return true;
+}
+
+/************************************************************************/
+/*                             TryGetJob()                              */
+/************************************************************************/
 
-    if( !bRet )
+// Takes the most recent job of the queue of the worker thread, or else the
+// oldest job of the pool queue, or else steals the oldest job of another
+// worker thread.
+bool CPLWorkerThreadPool::TryGetJob( CPLWorkerThread* psWorkerThread,
+                                     CPLWorkerThreadJob& sJob )
+{
+    if( m_nQueuedJobs.load() <= 0 )
         return false;
 
-    for(size_t i=0;i<apData.size();i++)
+    if( psWorkerThread )
     {
-        CPLAcquireMutex(hMutex, 1000.0);
+        std::lock_guard<std::mutex> oLock(psWorkerThread->oMutex);
+        if( !psWorkerThread->aoJobs.empty() )
+        {
+            sJob = psWorkerThread->aoJobs.back();
+            psWorkerThread->aoJobs.pop_back();
+            m_nQueuedJobs--;
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+        if( !m_aoJobs.empty() )
+        {
+            sJob = m_aoJobs.front();
+            m_aoJobs.pop_front();
+            m_nQueuedJobs--;
+            return true;
+        }
+    }
 
-        if( psWaitingWorkerThreadsList && psJobQueue )
+    const size_t nThreads = aWT.size();
+    const size_t iStart = psWorkerThread ? psWorkerThread->iIndex + 1 : 0;
+    for( size_t i = 0; i < nThreads; i++ )
+    {
+        CPLWorkerThread* psOther = aWT[(iStart + i) % nThreads].get();
+        if( psOther == psWorkerThread )
+            continue;
+        std::lock_guard<std::mutex> oLock(psOther->oMutex);
+        if( !psOther->aoJobs.empty() )
         {
-            CPLWorkerThread* psWorkerThread;
+#if DEBUG_VERBOSE
+            CPLDebug("JOB", "%p steals a job from %p",
+                     psWorkerThread, psOther);
+#endif
+            sJob = psOther->aoJobs.front();
+            psOther->aoJobs.pop_front();
+            m_nQueuedJobs--;
+            return true;
+        }
+    }
 
-            psWorkerThread = static_cast<CPLWorkerThread*>(psWaitingWorkerThreadsList->pData);
+    return false;
+}
 
-            CPLAssert( psWorkerThread->bMarkedAsWaiting );
-            psWorkerThread->bMarkedAsWaiting = FALSE;
+/************************************************************************/
+/*                             GetNextJob()                             */
+/************************************************************************/
 
-            CPLList* psNext = psWaitingWorkerThreadsList->psNext;
-            CPLList* psToFree = psWaitingWorkerThreadsList;
-            psWaitingWorkerThreadsList = psNext;
-            nWaitingWorkerThreads--;
+// Returns false when the pool is stopped.
+bool CPLWorkerThreadPool::GetNextJob( CPLWorkerThread* psWorkerThread,
+                                      CPLWorkerThreadJob& sJob )
+{
+    while( true )
+    {
+        if( TryGetJob(psWorkerThread, sJob) )
+            return true;
 
-            // CPLAssert(
-            //    CPLListCount(psWaitingWorkerThreadsList) ==
-            //    nWaitingWorkerThreads);
+        std::unique_lock<std::mutex> oLock(m_mutex);
+        if( eState == CPLWTS_STOP )
+            return false;
+        // Jobs are counted by PushJob() with m_mutex held, so that a job
+        // queued after this check wakes us up.
+        if( m_nQueuedJobs.load() > 0 )
+            continue;
 
 #if DEBUG_VERBOSE
-            CPLDebug("JOB", "Waking up %p", psWorkerThread);
+        CPLDebug("JOB", "%p sleeping", psWorkerThread);
 #endif
-            CPLAcquireMutex(psWorkerThread->hMutex, 1000.0);
+        nWaitingWorkerThreads++;
+        m_cvWorkers.wait(oLock);
+        nWaitingWorkerThreads--;
+    }
+}
 
-            // CPLAssert(psWorkerThread->psNextJob == nullptr);
-            // psWorkerThread->psNextJob =
-            //     (CPLWorkerThreadJob*)psJobQueue->pData;
-            // psNext = psJobQueue->psNext;
-            // CPLFree(psJobQueue);
-            // psJobQueue = psNext;
+/************************************************************************/
+/*                               RunJob()                               */
+/************************************************************************/
 
-            CPLReleaseMutex(hMutex);
-            CPLCondSignal(psWorkerThread->hCond);
-            CPLReleaseMutex(psWorkerThread->hMutex);
+void CPLWorkerThreadPool::RunJob( const CPLWorkerThreadJob& sJob )
+{
+    if( sJob.pfnFunc )
+        sJob.pfnFunc(sJob.pData);
 
-            CPLFree(psToFree);
-        }
-        else
-        {
-            CPLReleaseMutex(hMutex);
-            break;
-        }
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+        nPendingJobs--;
+        m_cvEvent.notify_all();
     }
 
-    return true;
+    // Last, since the queue may be destroyed as soon as it is notified.
+    if( sJob.poQueue )
+        sJob.poQueue->DeclareJobFinished();
 }
 
 /************************************************************************/
@@ -308,6 +386,11 @@ bool CPLWorkerThreadPool::SubmitJobs(CPLThreadFunc pfnFunc,
 /************************************************************************/
 
 /** Wait for completion of part or whole jobs.
+ *
+ * When called from a job run by the pool, queued jobs are run by the
+ * calling thread while waiting. Note that the job of the caller is one of
+ * the pending jobs: CPLJobQueue::WaitCompletion() is generally more
+ * appropriate from jobs.
  *
  * @param nMaxRemainingJobs Maximum number of pendings jobs that are allowed
  *                          in the queue after this method has completed. Might be
@@ -317,16 +400,24 @@ void CPLWorkerThreadPool::WaitCompletion(int nMaxRemainingJobs)
 {
     if( nMaxRemainingJobs < 0 )
         nMaxRemainingJobs = 0;
-    CPLAcquireMutex(hMutex, 1000.0);
-    while( true )
+    CPLWorkerThread* psWT = GetCurrentWorkerThread();
+    std::unique_lock<std::mutex> oLock(m_mutex);
+    while( nPendingJobs > nMaxRemainingJobs )
     {
-        int nPendingJobsLocal = nPendingJobs;
-        if( nPendingJobsLocal > nMaxRemainingJobs )
-            CPLCondWait(hCond, hMutex);
-        if( nPendingJobsLocal <= nMaxRemainingJobs )
-            break;
+        if( psWT == nullptr )
+        {
+            m_cvEvent.wait(oLock);
+            continue;
+        }
+        oLock.unlock();
+        CPLWorkerThreadJob sJob;
+        const bool bGotJob = TryGetJob(psWT, sJob);
+        if( bGotJob )
+            RunJob(sJob);
+        oLock.lock();
+        if( !bGotJob && nPendingJobs > nMaxRemainingJobs )
+            m_cvEvent.wait_for(oLock, oHelpDelay);
     }
-    CPLReleaseMutex(hMutex);
 }
 
 /************************************************************************/
@@ -337,7 +428,7 @@ void CPLWorkerThreadPool::WaitCompletion(int nMaxRemainingJobs)
  */
 void CPLWorkerThreadPool::WaitEvent()
 {
-    CPLAcquireMutex(hMutex, 1000.0);
+    std::unique_lock<std::mutex> oLock(m_mutex);
     while( true )
     {
         int nPendingJobsLocal = nPendingJobs;
@@ -345,13 +436,12 @@ void CPLWorkerThreadPool::WaitEvent()
         {
             break;
         }
-        CPLCondWait(hCond, hMutex);
+        m_cvEvent.wait(oLock);
         if( nPendingJobs < nPendingJobsLocal )
         {
             break;
         }
     }
-    CPLReleaseMutex(hMutex);
 }
 
 /************************************************************************/
@@ -388,160 +478,261 @@ bool CPLWorkerThreadPool::Setup(int nThreads,
                             bool bWaitallStarted)
 {
     CPLAssert( nThreads > 0 );
+    CPLAssert( aWT.empty() );
 
-    hCond = CPLCreateCond();
-    if( hCond == nullptr )
-        return false;
-
-    bool bRet = true;
-    aWT.resize(nThreads);
-    for(int i=0;i<nThreads;i++)
+    // All the threads are created before starting them, since they steal
+    // jobs from each other.
+    try
     {
-        aWT[i].pfnInitFunc = pfnInitFunc;
-        aWT[i].pInitData = pasInitData ? pasInitData[i] : nullptr;
-        aWT[i].poTP = this;
-
-        aWT[i].hMutex = CPLCreateMutexEx(CPL_MUTEX_REGULAR);
-        if( aWT[i].hMutex == nullptr )
+        for( int i = 0; i < nThreads; i++ )
         {
-            nThreads = i;
-            aWT.resize(nThreads);
-            bRet = false;
-            break;
+            std::unique_ptr<CPLWorkerThread> psWT(new CPLWorkerThread());
+            psWT->pfnInitFunc = pfnInitFunc;
+            psWT->pInitData = pasInitData ? pasInitData[i] : nullptr;
+            psWT->poTP = this;
+            psWT->iIndex = static_cast<size_t>(i);
+            aWT.push_back(std::move(psWT));
         }
-        CPLReleaseMutex(aWT[i].hMutex);
-        aWT[i].hCond = CPLCreateCond();
-        if( aWT[i].hCond == nullptr )
-        {
-            CPLDestroyMutex(aWT[i].hMutex);
-            nThreads = i;
-            aWT.resize(nThreads);
-            bRet = false;
-            break;
-        }
-
-        aWT[i].bMarkedAsWaiting = FALSE;
-        // aWT[i].psNextJob = nullptr;
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Cannot allocate threads");
+        aWT.clear();
+        return false;
+    }
 
-        aWT[i].hThread =
-            CPLCreateJoinableThread(WorkerThreadFunction, &(aWT[i]));
-        if( aWT[i].hThread == nullptr )
+    for( int i = 0; i < nThreads; i++ )
+    {
+        aWT[i]->hThread =
+            CPLCreateJoinableThread(WorkerThreadFunction, aWT[i].get());
+        if( aWT[i]->hThread == nullptr )
         {
-            nThreads = i;
-            aWT.resize(nThreads);
-            bRet = false;
-            break;
+            {
+                std::lock_guard<std::mutex> oLock(m_mutex);
+                eState = CPLWTS_STOP;
+                m_cvWorkers.notify_all();
+            }
+            for( int j = 0; j < i; j++ )
+                CPLJoinThread(aWT[j]->hThread);
+            aWT.clear();
+            eState = CPLWTS_OK;
+            nStartedThreads = 0;
+            return false;
         }
     }
 
     if( bWaitallStarted )
     {
         // Wait all threads to be started
-        while( true )
-        {
-            CPLAcquireMutex(hMutex, 1000.0);
-            int nWaitingWorkerThreadsLocal = nWaitingWorkerThreads;
-            if( nWaitingWorkerThreadsLocal < nThreads )
-                CPLCondWait(hCond, hMutex);
-            CPLReleaseMutex(hMutex);
-            if( nWaitingWorkerThreadsLocal == nThreads )
-                break;
-        }
+        std::unique_lock<std::mutex> oLock(m_mutex);
+        while( nStartedThreads < nThreads )
+            m_cvEvent.wait(oLock);
     }
 
-    if( eState == CPLWTS_ERROR )
-        bRet = false;
+    return true;
+}
+
+/************************************************************************/
+/*                           CreateJobQueue()                           */
+/************************************************************************/
 
-    return bRet;
+/** Create a new job queue, whose jobs are run by this pool.
+ *
+ * The queue must be destroyed before the pool.
+ *
+ * @since GDAL 3.1
+ */
+std::unique_ptr<CPLJobQueue> CPLWorkerThreadPool::CreateJobQueue()
+{
+    return std::unique_ptr<CPLJobQueue>(new CPLJobQueue(this));
 }
 
 /************************************************************************/
-/*                          DeclareJobFinished()                        */
+/*                            CPLJobQueue()                             */
 /************************************************************************/
 
-void CPLWorkerThreadPool::DeclareJobFinished()
+//! @cond Doxygen_Suppress
+CPLJobQueue::CPLJobQueue(CPLWorkerThreadPool* poPool) : m_poPool(poPool)
 {
-    CPLAcquireMutex(hMutex, 1000.0);
-    nPendingJobs--;
-    CPLCondSignal(hCond);
-    CPLReleaseMutex(hMutex);
 }
+//! @endcond
 
 /************************************************************************/
-/*                             GetNextJob()                             */
+/*                           ~CPLJobQueue()                             */
 /************************************************************************/
 
-CPLWorkerThreadJob *
-CPLWorkerThreadPool::GetNextJob( CPLWorkerThread* psWorkerThread )
+/** Destroys the queue, once its pending jobs are completed. */
+CPLJobQueue::~CPLJobQueue()
 {
-    while(true)
-    {
-        CPLAcquireMutex(hMutex, 1000.0);
-        if( eState == CPLWTS_STOP )
-        {
-            CPLReleaseMutex(hMutex);
-            return nullptr;
-        }
-        CPLList* psTopJobIter = psJobQueue;
-        if( psTopJobIter )
-        {
-            psJobQueue = psTopJobIter->psNext;
+    WaitCompletion();
+}
 
-#if DEBUG_VERBOSE
-            CPLDebug("JOB", "%p got a job", psWorkerThread);
-#endif
-            CPLWorkerThreadJob* psJob =
-                static_cast<CPLWorkerThreadJob*>(psTopJobIter->pData);
-            CPLReleaseMutex(hMutex);
-            CPLFree(psTopJobIter);
-            return psJob;
-        }
+/************************************************************************/
+/*                         DeclareJobFinished()                         */
+/************************************************************************/
 
-        if( !psWorkerThread->bMarkedAsWaiting )
-        {
-            psWorkerThread->bMarkedAsWaiting = TRUE;
-            nWaitingWorkerThreads++;
-            CPLAssert(nWaitingWorkerThreads <= static_cast<int>(aWT.size()));
+void CPLJobQueue::DeclareJobFinished()
+{
+    std::lock_guard<std::mutex> oLock(m_mutex);
+    m_nPendingJobs--;
+    m_cv.notify_all();
+}
 
-            CPLList* psItem =
-                static_cast<CPLList *>(VSI_MALLOC_VERBOSE(sizeof(CPLList)));
-            if( psItem == nullptr )
-            {
-                eState = CPLWTS_ERROR;
-                CPLCondSignal(hCond);
+/************************************************************************/
+/*                             SubmitJob()                              */
+/************************************************************************/
 
-                CPLReleaseMutex(hMutex);
-                return nullptr;
-            }
+/** Queue a new job.
+ *
+ * @param pfnFunc Function to run for the job.
+ * @param pData User data to pass to the job function.
+ * @return true in case of success.
+ */
+bool CPLJobQueue::SubmitJob( CPLThreadFunc pfnFunc, void* pData )
+{
+    return m_poPool->PushJob(pfnFunc, pData, this);
+}
 
-            psItem->pData = psWorkerThread;
-            psItem->psNext = psWaitingWorkerThreadsList;
-            psWaitingWorkerThreadsList = psItem;
+/************************************************************************/
+/*                           WaitCompletion()                           */
+/************************************************************************/
 
-#if DEBUG_VERBOSE
-            CPLAssert(CPLListCount(psWaitingWorkerThreadsList) ==
-                      nWaitingWorkerThreads);
-#endif
+/** Wait for completion of part or whole jobs of the queue.
+ *
+ * When called from a job run by the pool, queued jobs of the pool are run
+ * by the calling thread while waiting, so that nested submissions cannot
+ * exhaust the worker threads.
+ *
+ * @param nMaxRemainingJobs Maximum number of pending jobs that are allowed
+ *                          in the queue after this method has completed.
+ *                          Might be 0 to wait for all jobs.
+ */
+void CPLJobQueue::WaitCompletion( int nMaxRemainingJobs )
+{
+    if( nMaxRemainingJobs < 0 )
+        nMaxRemainingJobs = 0;
+    CPLWorkerThread* psWT = m_poPool->GetCurrentWorkerThread();
+    std::unique_lock<std::mutex> oLock(m_mutex);
+    while( m_nPendingJobs > nMaxRemainingJobs )
+    {
+        if( psWT == nullptr )
+        {
+            m_cv.wait(oLock);
+            continue;
         }
+        oLock.unlock();
+        CPLWorkerThreadJob sJob;
+        const bool bGotJob = m_poPool->TryGetJob(psWT, sJob);
+        if( bGotJob )
+            m_poPool->RunJob(sJob);
+        oLock.lock();
+        if( !bGotJob && m_nPendingJobs > nMaxRemainingJobs )
+            m_cv.wait_for(oLock, oHelpDelay);
+    }
+}
 
-        CPLCondSignal(hCond);
-
-        CPLAcquireMutex(psWorkerThread->hMutex, 1000.0);
-#if DEBUG_VERBOSE
-        CPLDebug("JOB", "%p sleeping", psWorkerThread);
-#endif
-        CPLReleaseMutex(hMutex);
+/************************************************************************/
+/*                             WaitEvent()                              */
+/************************************************************************/
 
-        CPLCondWait( psWorkerThread->hCond, psWorkerThread->hMutex );
+/** Wait for completion of at least one job of the queue, if there are any
+ * remaining.
+ *
+ * The jobs are supposed to be submitted by the calling thread only.
+ */
+void CPLJobQueue::WaitEvent()
+{
+    int nPendingJobs = 0;
+    {
+        std::lock_guard<std::mutex> oLock(m_mutex);
+        nPendingJobs = m_nPendingJobs;
+    }
+    if( nPendingJobs > 0 )
+        WaitCompletion(nPendingJobs - 1);
+}
 
-        // TODO(rouault): Explain or delete.
-        // CPLWorkerThreadJob* psJob = psWorkerThread->psNextJob;
-        // psWorkerThread->psNextJob = nullptr;
+/************************************************************************/
+/*                    CPLGetGlobalWorkerThreadPool()                    */
+/************************************************************************/
 
-        CPLReleaseMutex(psWorkerThread->hMutex);
+static std::mutex gMutexGlobalThreadPool;
+static CPLWorkerThreadPool* gpoGlobalThreadPool = nullptr;
 
-        // TODO(rouault): Explain or delete.
-        // if( psJob )
-        //    return psJob;
+/** Return the process-wide pool of worker threads.
+ *
+ * The pool is created by the first call, with as many threads as CPUs, or
+ * nThreads if it is larger, so that the users of several threads share
+ * the cores. Callers should create their own CPLJobQueue, and limit the
+ * number of their jobs running at the same time if they need to.
+ *
+ * @param nThreads Number of threads wished by the caller.
+ * @return the pool, or NULL if it cannot be created.
+ * @since GDAL 3.1
+ */
+CPLWorkerThreadPool *CPLGetGlobalWorkerThreadPool( int nThreads )
+{
+    std::lock_guard<std::mutex> oLock(gMutexGlobalThreadPool);
+    if( gpoGlobalThreadPool == nullptr )
+    {
+        const int nPoolThreads =
+            std::min(128, std::max(nThreads, CPLGetNumCPUs()));
+        gpoGlobalThreadPool = new CPLWorkerThreadPool();
+        if( !gpoGlobalThreadPool->Setup(nPoolThreads, nullptr, nullptr,
+                                        false) )
+        {
+            delete gpoGlobalThreadPool;
+            gpoGlobalThreadPool = nullptr;
+        }
+    }
+    else if( nThreads > gpoGlobalThreadPool->GetThreadCount() )
+    {
+        CPLDebug("CPL", "Global thread pool has %d threads, less than the "
+                 "%d requested",
+                 gpoGlobalThreadPool->GetThreadCount(), nThreads);
     }
+    return gpoGlobalThreadPool;
+}
+
+/************************************************************************/
+/*                  CPLDestroyGlobalWorkerThreadPool()                  */
+/************************************************************************/
+
+/** Destroy the pool returned by CPLGetGlobalWorkerThreadPool().
+ *
+ * The job queues created from it must have been destroyed before.
+ *
+ * @since GDAL 3.1
+ */
+void CPLDestroyGlobalWorkerThreadPool()
+{
+    std::lock_guard<std::mutex> oLock(gMutexGlobalThreadPool);
+    delete gpoGlobalThreadPool;
+    gpoGlobalThreadPool = nullptr;
+}
+
+/************************************************************************/
+/*                          CPLGetNumThreads()                          */
+/************************************************************************/
+
+/** Return the number of threads requested for an operation.
+ *
+ * The value is the NUM_THREADS option of papszOptions, or else the
+ * GDAL_NUM_THREADS configuration option, or else pszDefault. It is either
+ * an integer or ALL_CPUS for the number of CPUs. The result is in the
+ * [1, 128] range.
+ *
+ * @param papszOptions Options with a NUM_THREADS item, or NULL.
+ * @param pszDefault Value used when no option is set.
+ * @return the number of threads.
+ * @since GDAL 3.1
+ */
+int CPLGetNumThreads( CSLConstList papszOptions, const char* pszDefault )
+{
+    const char* pszThreads = CSLFetchNameValueDef(papszOptions, "NUM_THREADS",
+        CPLGetConfigOption("GDAL_NUM_THREADS", pszDefault));
+    if( pszThreads == nullptr )
+        return 1;
+    const int nThreads = EQUAL(pszThreads, "ALL_CPUS") ? CPLGetNumCPUs() :
+                                                         atoi(pszThreads);
+    return std::max(1, std::min(128, nThreads));
 }
@@ -32,6 +32,12 @@
 
 #include "cpl_multiproc.h"
 #include "cpl_list.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 /**
@@ -43,25 +49,28 @@
 
 #ifndef DOXYGEN_SKIP
 class CPLWorkerThreadPool;
+class CPLJobQueue;
 
 typedef struct
 {
     CPLThreadFunc  pfnFunc;
     void          *pData;
+    CPLJobQueue   *poQueue;
 } CPLWorkerThreadJob;
 
-typedef struct
+struct CPLWorkerThread
 {
-    CPLThreadFunc        pfnInitFunc;
-    void                *pInitData;
-    CPLWorkerThreadPool *poTP;
-    CPLJoinableThread   *hThread;
-    int                  bMarkedAsWaiting;
-    // CPLWorkerThreadJob  *psNextJob;
-
-    CPLMutex            *hMutex;
-    CPLCond             *hCond;
-} CPLWorkerThread;
+    CPLThreadFunc        pfnInitFunc = nullptr;
+    void                *pInitData = nullptr;
+    CPLWorkerThreadPool *poTP = nullptr;
+    CPLJoinableThread   *hThread = nullptr;
+    size_t               iIndex = 0;
+
+    // Jobs submitted by the jobs run in this thread. The thread takes the
+    // most recent one, and other threads steal the oldest one.
+    std::mutex           oMutex{};
+    std::deque<CPLWorkerThreadJob> aoJobs{};
+};
 
 typedef enum
 {
@@ -76,20 +85,32 @@ class CPL_DLL CPLWorkerThreadPool
 {
         CPL_DISALLOW_COPY_ASSIGN(CPLWorkerThreadPool)
 
-        std::vector<CPLWorkerThread> aWT{};
-        CPLCond* hCond = nullptr;
-        CPLMutex* hMutex = nullptr;
-        volatile CPLWorkerThreadState eState = CPLWTS_OK;
-        CPLList* psJobQueue = nullptr;
-        volatile int nPendingJobs = 0;
-
-        CPLList* psWaitingWorkerThreadsList = nullptr;
+        std::vector<std::unique_ptr<CPLWorkerThread>> aWT{};
+        std::mutex m_mutex{};
+        // Signaled to idle worker threads when jobs are queued.
+        std::condition_variable m_cvWorkers{};
+        // Signaled when a job is finished or a thread started.
+        std::condition_variable m_cvEvent{};
+        CPLWorkerThreadState eState = CPLWTS_OK;
+        // Jobs submitted by threads that are not workers of the pool.
+        std::deque<CPLWorkerThreadJob> m_aoJobs{};
+        // Number of jobs in m_aoJobs and the queues of the workers.
+        std::atomic<int> m_nQueuedJobs{0};
+        int nPendingJobs = 0;
         int nWaitingWorkerThreads = 0;
+        int nStartedThreads = 0;
 
         static void WorkerThreadFunction(void* user_data);
 
-        void DeclareJobFinished();
-        CPLWorkerThreadJob* GetNextJob(CPLWorkerThread* psWorkerThread);
+        CPLWorkerThread* GetCurrentWorkerThread() const;
+        bool PushJob(CPLThreadFunc pfnFunc, void* pData, CPLJobQueue* poQueue);
+        bool TryGetJob(CPLWorkerThread* psWorkerThread,
+                       CPLWorkerThreadJob& sJob);
+        bool GetNextJob(CPLWorkerThread* psWorkerThread,
+                        CPLWorkerThreadJob& sJob);
+        void RunJob(const CPLWorkerThreadJob& sJob);
+
+        friend class CPLJobQueue;
 
     public:
         CPLWorkerThreadPool();
@@ -107,8 +128,53 @@ class CPL_DLL CPLWorkerThreadPool
         void WaitCompletion(int nMaxRemainingJobs = 0);
         void WaitEvent();
 
+        std::unique_ptr<CPLJobQueue> CreateJobQueue();
+
+        /** Return whether the calling thread is a worker of this pool */
+        bool IsWorkerThread() const { return GetCurrentWorkerThread() != nullptr; }
+
         /** Return the number of threads setup */
         int GetThreadCount() const { return static_cast<int>(aWT.size()); }
 };
 
+/** Group of jobs run by a CPLWorkerThreadPool, whose completion can be
+ * waited for independently of the other jobs of the pool.
+ *
+ * Jobs of a queue may submit jobs, to the same or another queue, and wait
+ * for them: a worker thread waiting for the completion of a queue runs
+ * queued jobs in the meantime.
+ *
+ * Instances are created with CPLWorkerThreadPool::CreateJobQueue().
+ * @since GDAL 3.1
+ */
+class CPL_DLL CPLJobQueue
+{
+        CPL_DISALLOW_COPY_ASSIGN(CPLJobQueue)
+
+        CPLWorkerThreadPool* m_poPool = nullptr;
+        std::mutex m_mutex{};
+        std::condition_variable m_cv{};
+        int m_nPendingJobs = 0;
+
+        explicit CPLJobQueue(CPLWorkerThreadPool* poPool);
+        void DeclareJobFinished();
+
+        friend class CPLWorkerThreadPool;
+
+    public:
+       ~CPLJobQueue();
+
+        /** Return the pool running the jobs of the queue */
+        CPLWorkerThreadPool* GetPool() { return m_poPool; }
+
+        bool SubmitJob(CPLThreadFunc pfnFunc, void* pData);
+        void WaitCompletion(int nMaxRemainingJobs = 0);
+        void WaitEvent();
+};
+
+CPLWorkerThreadPool CPL_DLL *CPLGetGlobalWorkerThreadPool( int nThreads );
+void CPL_DLL CPLDestroyGlobalWorkerThreadPool();
+int CPL_DLL CPLGetNumThreads( CSLConstList papszOptions = nullptr,
+                              const char* pszDefault = "1" );
+
 #endif // CPL_WORKER_THREAD_POOL_H_INCLUDED_
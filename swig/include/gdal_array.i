@@ -1116,6 +1116,313 @@ retStringAndCPLFree* GetArrayFilename(PyArrayObject *psArray)
   }
 %}
 
+%{
+#include "ogr_recordbatch.h"
+
+static void ReleaseArrowArrayCapsule(PyObject* capsule)
+{
+    struct ArrowArray* array = static_cast<struct ArrowArray*>(
+        PyCapsule_GetPointer(capsule, "arrow_array"));
+    if( array == NULL )
+        return;
+    if( array->release != NULL )
+        array->release(array);
+    CPLFree(array);
+}
+
+static bool ArrowIsNull(const struct ArrowArray* array, int64_t i)
+{
+    const GByte* pabyValidity = static_cast<const GByte*>(array->buffers[0]);
+    if( array->null_count == 0 || pabyValidity == NULL )
+        return false;
+    i += array->offset;
+    return (pabyValidity[i >> 3] & (1 << (i & 7))) == 0;
+}
+
+/* Wraps the values buffer of a fixed width column without copy. owner */
+/* keeps the ArrowArray alive as long as the NumPy array exists. */
+static PyObject* ArrowFixedWidthToNumPy(const struct ArrowArray* array,
+                                        PyArray_Descr* pDescr, PyObject* owner)
+{
+    npy_intp dims = static_cast<npy_intp>(array->length);
+    const GByte* pabyValues = static_cast<const GByte*>(array->buffers[1]);
+    if( pabyValues == NULL )
+    {
+        return PyArray_Zeros(1, &dims, pDescr, 0);
+    }
+    void* pData = const_cast<GByte*>(pabyValues) +
+                  static_cast<size_t>(array->offset) * pDescr->elsize;
+    PyObject* ar = PyArray_NewFromDescr(&PyArray_Type, pDescr, 1, &dims,
+                                        NULL, pData, 0, NULL);
+    if( ar == NULL )
+        return NULL;
+    Py_INCREF(owner);
+    PyArray_SetBaseObject((PyArrayObject *) ar, owner);
+    return ar;
+}
+
+static PyObject* ArrowColumnToNumPy(const struct ArrowSchema* schema,
+                                    const struct ArrowArray* array,
+                                    PyObject* owner);
+
+/* Copies integer values to a datetime64 or timedelta64 array. */
+static PyObject* ArrowTemporalToNumPy(const struct ArrowArray* array,
+                                      const char* pszDType, int nSrcSize)
+{
+    PyObject *pDTypeString = PyUnicode_FromString(pszDType);
+    PyArray_Descr *pDescr = NULL;
+    PyArray_DescrConverter(pDTypeString, &pDescr);
+    Py_DECREF(pDTypeString);
+    if( pDescr == NULL )
+        return NULL;
+    npy_intp dims = static_cast<npy_intp>(array->length);
+    PyObject* ar = PyArray_Zeros(1, &dims, pDescr, 0);
+    if( ar == NULL || array->buffers[1] == NULL )
+        return ar;
+    int64_t* panOut = static_cast<int64_t*>(PyArray_DATA((PyArrayObject *) ar));
+    for( int64_t i = 0; i < array->length; i++ )
+    {
+        if( nSrcSize == 4 )
+            panOut[i] = static_cast<const int32_t*>(array->buffers[1])[array->offset + i];
+        else
+            panOut[i] = static_cast<const int64_t*>(array->buffers[1])[array->offset + i];
+    }
+    return ar;
+}
+
+static PyObject* ArrowStringToNumPy(const struct ArrowArray* array,
+                                    bool bUnicode)
+{
+    npy_intp dims = static_cast<npy_intp>(array->length);
+    PyObject* ar = PyArray_Empty(1, &dims, PyArray_DescrFromType(NPY_OBJECT), 0);
+    if( ar == NULL )
+        return NULL;
+    const int32_t* panOffsets = static_cast<const int32_t*>(array->buffers[1]);
+    const char* pszData = static_cast<const char*>(array->buffers[2]);
+    for( int64_t i = 0; i < array->length; i++ )
+    {
+        PyObject* pyVal;
+        if( ArrowIsNull(array, i) || panOffsets == NULL )
+        {
+            Py_INCREF(Py_None);
+            pyVal = Py_None;
+        }
+        else
+        {
+            const int32_t nStart = panOffsets[array->offset + i];
+            const int32_t nLen = panOffsets[array->offset + i + 1] - nStart;
+            if( bUnicode )
+                pyVal = PyUnicode_DecodeUTF8(pszData + nStart, nLen, "replace");
+            else
+                pyVal = PyBytes_FromStringAndSize(pszData + nStart, nLen);
+            if( pyVal == NULL )
+            {
+                Py_DECREF(ar);
+                return NULL;
+            }
+        }
+        /* PyArray_Empty() fills object arrays with None */
+        PyObject** ppItem = static_cast<PyObject**>(
+                PyArray_GETPTR1((PyArrayObject *) ar, i));
+        Py_XDECREF(*ppItem);
+        *ppItem = pyVal;
+    }
+    return ar;
+}
+
+static PyObject* ArrowListToNumPy(const struct ArrowSchema* schema,
+                                  const struct ArrowArray* array,
+                                  PyObject* owner)
+{
+    if( schema->n_children != 1 || array->n_children != 1 )
+        Py_RETURN_NONE;
+    PyObject* child = ArrowColumnToNumPy(schema->children[0],
+                                         array->children[0], owner);
+    if( child == NULL || child == Py_None )
+        return child;
+    npy_intp dims = static_cast<npy_intp>(array->length);
+    PyObject* ar = PyArray_Empty(1, &dims, PyArray_DescrFromType(NPY_OBJECT), 0);
+    if( ar == NULL )
+    {
+        Py_DECREF(child);
+        return NULL;
+    }
+    const int32_t* panOffsets = static_cast<const int32_t*>(array->buffers[1]);
+    for( int64_t i = 0; panOffsets != NULL && i < array->length; i++ )
+    {
+        if( ArrowIsNull(array, i) )
+            continue;
+        PyObject* pyVal = PySequence_GetSlice(child,
+                                panOffsets[array->offset + i],
+                                panOffsets[array->offset + i + 1]);
+        if( pyVal == NULL )
+        {
+            Py_DECREF(ar);
+            Py_DECREF(child);
+            return NULL;
+        }
+        PyObject** ppItem = static_cast<PyObject**>(
+                PyArray_GETPTR1((PyArrayObject *) ar, i));
+        Py_XDECREF(*ppItem);
+        *ppItem = pyVal;
+    }
+    Py_DECREF(child);
+    return ar;
+}
+
+/* Returns a new reference, or None if the Arrow format is not handled. */
+static PyObject* ArrowColumnToNumPy(const struct ArrowSchema* schema,
+                                    const struct ArrowArray* array,
+                                    PyObject* owner)
+{
+    const char* pszFormat = schema->format;
+    int nTypeNum = -1;
+    switch( pszFormat[0] != '\0' && pszFormat[1] == '\0' ? pszFormat[0] : 0 )
+    {
+        case 'c': nTypeNum = NPY_INT8; break;
+        case 'C': nTypeNum = NPY_UINT8; break;
+        case 's': nTypeNum = NPY_INT16; break;
+        case 'S': nTypeNum = NPY_UINT16; break;
+        case 'i': nTypeNum = NPY_INT32; break;
+        case 'I': nTypeNum = NPY_UINT32; break;
+        case 'l': nTypeNum = NPY_INT64; break;
+        case 'L': nTypeNum = NPY_UINT64; break;
+        case 'f': nTypeNum = NPY_FLOAT32; break;
+        case 'g': nTypeNum = NPY_FLOAT64; break;
+        case 'u': return ArrowStringToNumPy(array, true);
+        case 'z': return ArrowStringToNumPy(array, false);
+        case 'b':
+        {
+            npy_intp dims = static_cast<npy_intp>(array->length);
+            PyObject* ar = PyArray_ZEROS(1, &dims, NPY_BOOL, 0);
+            const GByte* pabyValues = static_cast<const GByte*>(array->buffers[1]);
+            if( ar == NULL || pabyValues == NULL )
+                return ar;
+            npy_bool* pabyOut = static_cast<npy_bool*>(
+                        PyArray_DATA((PyArrayObject *) ar));
+            for( int64_t i = 0; i < array->length; i++ )
+            {
+                const int64_t j = array->offset + i;
+                pabyOut[i] = (pabyValues[j >> 3] & (1 << (j & 7))) != 0;
+            }
+            return ar;
+        }
+        default: break;
+    }
+    if( nTypeNum >= 0 )
+        return ArrowFixedWidthToNumPy(array, PyArray_DescrFromType(nTypeNum),
+                                      owner);
+    if( strcmp(pszFormat, "tdD") == 0 )
+        return ArrowTemporalToNumPy(array, "datetime64[D]", 4);
+    if( strcmp(pszFormat, "ttm") == 0 )
+        return ArrowTemporalToNumPy(array, "timedelta64[ms]", 4);
+    if( strncmp(pszFormat, "ts", 2) == 0 && pszFormat[2] != '\0' &&
+        pszFormat[3] == ':' )
+    {
+        /* Timezones are ignored: values are UTC based in Arrow */
+        const char* pszUnit = pszFormat[2] == 's' ? "s" :
+                              pszFormat[2] == 'm' ? "ms" :
+                              pszFormat[2] == 'u' ? "us" : "ns";
+        PyObject *pDTypeString = PyUnicode_FromFormat("datetime64[%s]", pszUnit);
+        PyArray_Descr *pDescr = NULL;
+        PyArray_DescrConverter(pDTypeString, &pDescr);
+        Py_DECREF(pDTypeString);
+        if( pDescr == NULL )
+            return NULL;
+        return ArrowFixedWidthToNumPy(array, pDescr, owner);
+    }
+    if( strcmp(pszFormat, "+l") == 0 )
+        return ArrowListToNumPy(schema, array, owner);
+    Py_RETURN_NONE;
+}
+%}
+
+%inline %{
+  /* Reads the next record batch of an ArrowArrayStream capsule, as */
+  /* returned by ogr.Layer.__arrow_c_stream__(), as a dictionary of NumPy */
+  /* arrays. Returns None at the end of the stream. */
+  PyObject *_ArrowStreamNextBatchAsNumPy( PyObject* stream_capsule ) {
+
+    struct ArrowArrayStream* stream = static_cast<struct ArrowArrayStream*>(
+        PyCapsule_GetPointer(stream_capsule, "arrow_array_stream"));
+    if( stream == NULL )
+        return NULL;
+    if( stream->release == NULL )
+    {
+        PyErr_SetString(PyExc_RuntimeError, "Arrow stream has been released");
+        return NULL;
+    }
+
+    struct ArrowSchema schema;
+    struct ArrowArray* array = static_cast<struct ArrowArray*>(
+        CPLCalloc(1, sizeof(struct ArrowArray)));
+    int nRet;
+    Py_BEGIN_ALLOW_THREADS
+    nRet = stream->get_schema(stream, &schema);
+    if( nRet == 0 )
+    {
+        nRet = stream->get_next(stream, array);
+        if( nRet != 0 )
+            schema.release(&schema);
+    }
+    Py_END_ALLOW_THREADS
+    if( nRet != 0 )
+    {
+        CPLFree(array);
+        const char* pszError = stream->get_last_error(stream);
+        PyErr_SetString(PyExc_RuntimeError,
+                        pszError ? pszError : "Arrow stream error");
+        return NULL;
+    }
+    if( array->release == NULL )
+    {
+        schema.release(&schema);
+        CPLFree(array);
+        Py_RETURN_NONE;
+    }
+
+    /* The ArrowArray is only released once all zero-copy views are gone */
+    PyObject* owner = PyCapsule_New(array, "arrow_array",
+                                    ReleaseArrowArrayCapsule);
+    if( owner == NULL )
+    {
+        array->release(array);
+        CPLFree(array);
+        schema.release(&schema);
+        return NULL;
+    }
+
+    PyObject* dict = PyDict_New();
+    for( int64_t i = 0; dict != NULL && i < schema.n_children &&
+                        i < array->n_children; i++ )
+    {
+        const struct ArrowSchema* psChildSchema = schema.children[i];
+        PyObject* col = ArrowColumnToNumPy(psChildSchema,
+                                           array->children[i], owner);
+        if( col == NULL )
+        {
+            Py_DECREF(dict);
+            dict = NULL;
+        }
+        else if( col == Py_None )
+        {
+            Py_DECREF(col);
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "Column %s of Arrow format %s ignored",
+                     psChildSchema->name, psChildSchema->format);
+        }
+        else
+        {
+            PyDict_SetItemString(dict, psChildSchema->name, col);
+            Py_DECREF(col);
+        }
+    }
+    Py_DECREF(owner);
+    schema.release(&schema);
+    return dict;
+  }
+%}
+
 %pythoncode %{
 import numpy
 
@@ -1210,12 +1517,35 @@ def SaveArray(src_array, filename, format="GTiff", prototype=None, interleave='b
     return driver.CreateCopy(filename, OpenArray(src_array, prototype, interleave))
 
 
+def _BufferAsArray(buf_obj, shape, buf_type):
+    """Return a numpy array of the given shape and GDAL data type sharing the
+    memory of buf_obj, an object supporting the writable buffer protocol
+    (bytearray, memoryview, mmap, ...). numpy arrays are returned as they are."""
+
+    if isinstance(buf_obj, numpy.ndarray):
+        return buf_obj
+
+    typecode = GDALTypeCodeToNumericTypeCode(buf_type)
+    if typecode is None:
+        raise ValueError("buf_type has no corresponding numpy type")
+    array = numpy.frombuffer(buf_obj, dtype=typecode)
+    if not array.flags.writeable:
+        raise ValueError("buf_obj should be a writable buffer")
+    count = 1
+    for dim in shape:
+        count *= dim
+    if array.size != count:
+        raise ValueError("buf_obj has room for %d values, %d expected" % (array.size, count))
+    return array.reshape(shape)
+
 def DatasetReadAsArray(ds, xoff=0, yoff=0, win_xsize=None, win_ysize=None, buf_obj=None,
                        buf_xsize=None, buf_ysize=None, buf_type=None,
                        resample_alg=gdal.GRIORA_NearestNeighbour,
                        callback=None, callback_data=None, interleave='band'):
     """Pure python implementation of reading a chunk of a GDAL file
-    into a numpy array.  Used by the gdal.Dataset.ReadAsArray method."""
+    into a numpy array.  Used by the gdal.Dataset.ReadAsArray method.
+    buf_obj may be a numpy array, or any object supporting the writable
+    buffer protocol, in which case the values are read into its memory."""
 
     if win_xsize is None:
         win_xsize = ds.RasterXSize
@@ -1237,6 +1567,17 @@ def DatasetReadAsArray(ds, xoff=0, yoff=0, win_xsize=None, win_ysize=None, buf_o
     if ds.RasterCount == 0:
         return None
 
+    if buf_obj is not None and not isinstance(buf_obj, numpy.ndarray) and ds.RasterCount > 1:
+        if buf_type is None:
+            buf_type = ds.GetRasterBand(1).DataType
+            for band_index in range(2, ds.RasterCount + 1):
+                if buf_type != ds.GetRasterBand(band_index).DataType:
+                    buf_type = gdalconst.GDT_Float32
+        shape_buf_xsize = win_xsize if buf_xsize is None else buf_xsize
+        shape_buf_ysize = win_ysize if buf_ysize is None else buf_ysize
+        buf_shape = (ds.RasterCount, shape_buf_ysize, shape_buf_xsize) if interleave else (shape_buf_ysize, shape_buf_xsize, ds.RasterCount)
+        buf_obj = _BufferAsArray(buf_obj, buf_shape, buf_type)
+
     if ds.RasterCount == 1:
         return BandReadAsArray(ds.GetRasterBand(1), xoff, yoff, win_xsize, win_ysize,
                                buf_xsize=buf_xsize, buf_ysize=buf_ysize, buf_type=buf_type,
@@ -1300,13 +1641,21 @@ def BandReadAsArray(band, xoff=0, yoff=0, win_xsize=None, win_ysize=None,
                     resample_alg=gdal.GRIORA_NearestNeighbour,
                     callback=None, callback_data=None):
     """Pure python implementation of reading a chunk of a GDAL file
-    into a numpy array.  Used by the gdal.Band.ReadAsArray method."""
+    into a numpy array.  Used by the gdal.Band.ReadAsArray method.
+    buf_obj may be a numpy array, or any object supporting the writable
+    buffer protocol, in which case the values are read into its memory."""
 
     if win_xsize is None:
         win_xsize = band.XSize
     if win_ysize is None:
         win_ysize = band.YSize
 
+    if buf_obj is not None and not isinstance(buf_obj, numpy.ndarray):
+        buf_obj = _BufferAsArray(buf_obj,
+                                 (win_ysize if buf_ysize is None else buf_ysize,
+                                  win_xsize if buf_xsize is None else buf_xsize),
+                                 band.DataType if buf_type is None else buf_type)
+
     if buf_obj is None:
         if buf_xsize is None:
             buf_xsize = win_xsize
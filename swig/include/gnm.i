@@ -148,7 +148,8 @@ typedef enum
 {
     GATDijkstraShortestPath = 1,
     GATKShortestPath = 2,
-    GATConnectedComponents = 3
+    GATConnectedComponents = 3,
+    GATAStarShortestPath = 4
 } GNMGraphAlgorithmType;
 
 #define GNMGFID GIntBig
@@ -548,7 +548,9 @@ void wrapper_VSIGetMemFileBuffer(const char *utf8_path, GByte **out, vsi_l_offse
                   callback=None,
                   callback_data=None):
       """ Reading a chunk of a GDAL band into a numpy array. The optional (buf_xsize,buf_ysize,buf_type)
-      parameters should generally not be specified if buf_obj is specified. The array is returned"""
+      parameters should generally not be specified if buf_obj is specified. buf_obj can be a
+      numpy array, or any object supporting the writable buffer protocol, that is
+      then filled without copy. The array is returned"""
 
       from osgeo import gdalnumeric
 
@@ -769,7 +771,9 @@ CPLErr ReadRaster1(  int xoff, int yoff, int xsize, int ysize,
                     callback_data=None,
                     interleave='band'):
         """ Reading a chunk of a GDAL band into a numpy array. The optional (buf_xsize,buf_ysize,buf_type)
-        parameters should generally not be specified if buf_obj is specified. The array is returned"""
+        parameters should generally not be specified if buf_obj is specified. buf_obj can be a
+        numpy array, or any object supporting the writable buffer protocol, that is
+        then filled without copy. The array is returned"""
 
         from osgeo import gdalnumeric
         return gdalnumeric.DatasetReadAsArray(self, xoff, yoff, xsize, ysize, buf_obj,
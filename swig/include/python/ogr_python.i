@@ -122,8 +122,76 @@
 #endif
 
 
+%{
+#include "ogr_recordbatch.h"
+
+static void ReleaseArrowArrayStreamCapsule(PyObject* capsule)
+{
+    struct ArrowArrayStream* stream = static_cast<struct ArrowArrayStream*>(
+        PyCapsule_GetPointer(capsule, "arrow_array_stream"));
+    if( stream == NULL )
+        return;
+    if( stream->release != NULL )
+        stream->release(stream);
+    CPLFree(stream);
+}
+%}
+
 %extend OGRLayerShadow {
+
+  /* Returns the ArrowArrayStream of the layer in a PyCapsule following */
+  /* the Arrow PyCapsule interface. The layer must outlive the stream. */
+  PyObject* _GetArrowStreamCapsule(char** options = NULL) {
+    struct ArrowArrayStream* stream = static_cast<struct ArrowArrayStream*>(
+        CPLCalloc(1, sizeof(struct ArrowArrayStream)));
+    if( !OGR_L_GetArrowStream(self, stream, options) )
+    {
+        CPLFree(stream);
+        SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+        if( CPLGetLastErrorType() == CE_None )
+            PyErr_SetString(PyExc_RuntimeError, "OGR_L_GetArrowStream() failed");
+        else
+            PyErr_SetString(PyExc_RuntimeError, CPLGetLastErrorMsg());
+        SWIG_PYTHON_THREAD_END_BLOCK;
+        return NULL;
+    }
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+    PyObject* capsule = PyCapsule_New(stream, "arrow_array_stream",
+                                      ReleaseArrowArrayStreamCapsule);
+    SWIG_PYTHON_THREAD_END_BLOCK;
+    if( capsule == NULL )
+    {
+        stream->release(stream);
+        CPLFree(stream);
+    }
+    return capsule;
+  }
+
   %pythoncode %{
+    def __arrow_c_stream__(self, requested_schema=None):
+        """Export the layer as an Arrow C stream (PyCapsule interface).
+
+        requested_schema is not supported and must be None. The layer
+        must remain alive while the stream is consumed."""
+        if requested_schema is not None:
+            raise NotImplementedError("requested_schema != None not supported")
+        return self._GetArrowStreamCapsule()
+
+    def GetArrowStreamAsNumPy(self, options=[]):
+        """Iterate over the layer by record batches.
+
+        Each batch is returned as a dictionary mapping column names to
+        NumPy arrays. Fixed width numeric columns are views on the Arrow
+        buffers, without copy. The value of a null entry in a numeric
+        column is undefined. The layer must remain alive while iterating."""
+        from osgeo import gdal_array
+        stream = self._GetArrowStreamCapsule(options)
+        while True:
+            batch = gdal_array._ArrowStreamNextBatchAsNumPy(stream)
+            if batch is None:
+                break
+            yield batch
+
     def Reference(self):
       "For backwards compatibility only."
       pass
@@ -4031,6 +4031,17 @@ SWIGINTERN PyObject *GATConnectedComponents_swigconstant(PyObject *SWIGUNUSEDPAR
 }
 
 
+SWIGINTERN PyObject *GATAStarShortestPath_swigconstant(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
+  PyObject *module;
+  PyObject *d;
+  if (!PyArg_ParseTuple(args,(char*)"O:swigconstant", &module)) return NULL;
+  d = PyModule_GetDict(module);
+  if (!d) return NULL;
+  SWIG_Python_SetConstant(d, "GATAStarShortestPath",SWIG_From_int(static_cast< int >(GATAStarShortestPath)));
+  return SWIG_Py_Void();
+}
+
+
 SWIGINTERN PyObject *GNM_EDGE_DIR_BOTH_swigconstant(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
   PyObject *module;
   PyObject *d;
@@ -6241,6 +6252,7 @@ static PyMethodDef SwigMethods[] = {
 	 { (char *)"GATDijkstraShortestPath_swigconstant", GATDijkstraShortestPath_swigconstant, METH_VARARGS, NULL},
 	 { (char *)"GATKShortestPath_swigconstant", GATKShortestPath_swigconstant, METH_VARARGS, NULL},
 	 { (char *)"GATConnectedComponents_swigconstant", GATConnectedComponents_swigconstant, METH_VARARGS, NULL},
+	 { (char *)"GATAStarShortestPath_swigconstant", GATAStarShortestPath_swigconstant, METH_VARARGS, NULL},
 	 { (char *)"GNM_EDGE_DIR_BOTH_swigconstant", GNM_EDGE_DIR_BOTH_swigconstant, METH_VARARGS, NULL},
 	 { (char *)"GNM_EDGE_DIR_SRCTOTGT_swigconstant", GNM_EDGE_DIR_SRCTOTGT_swigconstant, METH_VARARGS, NULL},
 	 { (char *)"GNM_EDGE_DIR_TGTTOSRC_swigconstant", GNM_EDGE_DIR_TGTTOSRC_swigconstant, METH_VARARGS, NULL},
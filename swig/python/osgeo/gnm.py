@@ -114,6 +114,9 @@ GATKShortestPath = _gnm.GATKShortestPath
 _gnm.GATConnectedComponents_swigconstant(_gnm)
 GATConnectedComponents = _gnm.GATConnectedComponents
 
+_gnm.GATAStarShortestPath_swigconstant(_gnm)
+GATAStarShortestPath = _gnm.GATAStarShortestPath
+
 _gnm.GNM_EDGE_DIR_BOTH_swigconstant(_gnm)
 GNM_EDGE_DIR_BOTH = _gnm.GNM_EDGE_DIR_BOTH
 
@@ -445,33 +445,28 @@ void BitStuffer2::BitStuff(Byte** ppByte, const vector<unsigned int>& dataVec, i
   m_tmpBitStuffVec.resize(numUInts);
   unsigned int* dstPtr = &m_tmpBitStuffVec[0];
 
-  memset(dstPtr, 0, numBytes);
-
-  // do the stuffing
+  // do the stuffing, through a 64 bit accumulator so each uint is only written once
   const unsigned int* srcPtr = &dataVec[0];
-  int bitPos = 0;
-  assert(numBits <= 32); // to avoid coverity warning about large shift a bit later, when doing (*srcPtr++) >> (32 - bitPos)
+  assert(numBits <= 32);
+
+  unsigned long long acc = 0;
+  int accBits = 0;
 
   for (unsigned int i = 0; i < numElements; i++)
   {
-    if (32 - bitPos >= numBits)
+    acc |= (unsigned long long)srcPtr[i] << accBits;
+    accBits += numBits;
+    if (accBits >= 32)
     {
-      *dstPtr |= (*srcPtr++) << bitPos;
-      bitPos += numBits;
-      if (bitPos == 32)    // shift >= 32 is undefined
-      {
-        dstPtr++;
-        bitPos = 0;
-      }
-    }
-    else
-    {
-      *dstPtr++ |= (*srcPtr) << bitPos;
-      *dstPtr |= (*srcPtr++) >> (32 - bitPos);
-      bitPos += numBits - 32;
+      *dstPtr++ = (unsigned int)acc;
+      acc >>= 32;
+      accBits -= 32;
     }
   }
 
+  if (accBits > 0)
+    *dstPtr = (unsigned int)acc;
+
   // copy the bytes to the outgoing byte stream
   int numBytesUsed = numBytes - NumTailBytesNotNeeded(numElements, numBits);
   memcpy(*ppByte, &m_tmpBitStuffVec[0], numBytesUsed);
@@ -501,7 +496,8 @@ bool BitStuffer2::BitUnStuff(const Byte** ppByte, size_t& nBytesRemaining, vecto
 
   try
   {
-    m_tmpBitStuffVec.resize(numUInts);
+    // one extra uint, so every value can be read from a 64 bit window
+    m_tmpBitStuffVec.resize(numUInts + 1);
   }
   catch( const std::exception& )
   {
@@ -509,6 +505,7 @@ bool BitStuffer2::BitUnStuff(const Byte** ppByte, size_t& nBytesRemaining, vecto
   }
 
   m_tmpBitStuffVec[numUInts - 1] = 0;    // set last uint to 0
+  m_tmpBitStuffVec[numUInts] = 0;
 
   // copy the bytes from the incoming byte stream
   int numBytesUsed = numBytes - NumTailBytesNotNeeded(numElements, numBits);
@@ -517,28 +514,30 @@ bool BitStuffer2::BitUnStuff(const Byte** ppByte, size_t& nBytesRemaining, vecto
     return false;
 
   // do the un-stuffing
-  unsigned int* srcPtr = &m_tmpBitStuffVec[0];
+  // each value is extracted independently of the previous one, which lets
+  // the compiler unroll and vectorize the loop
+  const unsigned int* srcPtr = &m_tmpBitStuffVec[0];
   unsigned int* dstPtr = &dataVec[0];
-  int bitPos = 0;
-  int nb = 32 - numBits;
+  const unsigned long long mask = (1ULL << numBits) - 1;
 
-  for (unsigned int i = 0; i < numElements; i++)
+  if (numBits == 8 || numBits == 16)    // byte aligned, no straddling values
   {
-    if (nb - bitPos >= 0)
-    {
-      *dstPtr++ = ((*srcPtr) << (nb - bitPos)) >> nb;
-      bitPos += numBits;
-      if (bitPos == 32)    // shift >= 32 is undefined
-      {
-        srcPtr++;
-        bitPos = 0;
-      }
-    }
+    const Byte* bytePtr = (const Byte*)srcPtr;
+    if (numBits == 8)
+      for (unsigned int i = 0; i < numElements; i++)
+        dstPtr[i] = bytePtr[i];
     else
+      for (unsigned int i = 0; i < numElements; i++)
+        dstPtr[i] = bytePtr[2 * i] | ((unsigned int)bytePtr[2 * i + 1] << 8);
+  }
+  else
+  {
+    for (unsigned int i = 0; i < numElements; i++)
     {
-      *dstPtr = (*srcPtr++) >> bitPos;
-      *dstPtr++ |= ((*srcPtr) << (64 - numBits - bitPos)) >> nb;
-      bitPos -= nb;
+      const size_t bitPos = (size_t)i * numBits;
+      const size_t k = bitPos >> 5;
+      const unsigned long long val = srcPtr[k] | ((unsigned long long)srcPtr[k + 1] << 32);
+      dstPtr[i] = (unsigned int)((val >> (bitPos & 31)) & mask);
     }
   }
 
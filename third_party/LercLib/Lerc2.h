@@ -979,32 +979,36 @@ bool Lerc2::GetValidDataAndStats(const T* data, int i0, int i1, int j0, int j1,
 
   if (hd.numValidPixel == hd.nCols * hd.nRows)    // all valid, no mask
   {
+    // gather the tile first, then scan it in loops without dependencies
+    // between the iterations, so the compiler can vectorize them
     for (int i = i0; i < i1; i++)
     {
       int k = i * hd.nCols + j0;
       int m = k * nDim + iDim;
 
-      for (int j = j0; j < j1; j++, k++, m += nDim)
+      if (nDim == 1)
       {
-        T val = data[m];
-        dataBuf[cnt] = val;
-
-        if (cnt > 0)
-        {
-          if (val < zMin)
-            zMin = val;
-          else if (val > zMax)
-            zMax = val;
+        memcpy(&dataBuf[cnt], &data[m], (j1 - j0) * sizeof(T));
+        cnt += j1 - j0;
+      }
+      else
+        for (int j = j0; j < j1; j++, m += nDim)
+          dataBuf[cnt++] = data[m];
+    }
 
-          if (val == prevVal)
-            cntSameVal++;
-        }
-        else
-          zMin = zMax = val;    // init
+    if (cnt > 0)
+    {
+      zMin = zMax = dataBuf[0];    // init
 
-        prevVal = val;
-        cnt++;
+      for (int n = 1; n < cnt; n++)
+      {
+        T val = dataBuf[n];
+        zMin = (val < zMin) ? val : zMin;
+        zMax = (val > zMax) ? val : zMax;
       }
+
+      for (int n = 1; n < cnt; n++)
+        cntSameVal += (dataBuf[n] == dataBuf[n - 1]) ? 1 : 0;
     }
   }
   else    // not all valid, use mask